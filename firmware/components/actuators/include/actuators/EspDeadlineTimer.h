@@ -0,0 +1,92 @@
+// SPDX-FileCopyrightText: 2026 Cryptotomte
+// SPDX-License-Identifier: AGPL-3.0-or-later
+/**
+ * @file EspDeadlineTimer.h
+ * @brief Target (esp32) one-shot deadline timer backed by esp_timer.
+ *
+ * ESP32-ONLY, like EspTimeProvider.h: never include it from host-tested
+ * code; host tests use actuators/testing/FakeDeadlineTimer.h. The
+ * callback runs on the esp_timer task (ESP_TIMER_TASK dispatch), not in
+ * an ISR, so it may take the LockedWaterPump mutex; it must stay short.
+ */
+
+#ifndef WATERINGSYSTEM_ACTUATORS_ESPDEADLINETIMER_H
+#define WATERINGSYSTEM_ACTUATORS_ESPDEADLINETIMER_H
+
+#include <cstdint>
+
+#include "esp_log.h"
+#include "esp_timer.h"
+#include "interfaces/IDeadlineTimer.h"
+
+/**
+ * @brief IDeadlineTimer over one esp_timer one-shot.
+ */
+class EspDeadlineTimer : public IDeadlineTimer {
+public:
+    using Callback = void (*)(void* arg);
+
+    /// @p name must be a string literal (esp_timer keeps the pointer).
+    EspDeadlineTimer(const char* name, Callback callback, void* arg)
+        : name_(name), callback_(callback), arg_(arg)
+    {
+    }
+
+    ~EspDeadlineTimer() override
+    {
+        if (handle_ != nullptr) {
+            esp_timer_stop(handle_);
+            esp_timer_delete(handle_);
+        }
+    }
+
+    EspDeadlineTimer(const EspDeadlineTimer&) = delete;
+    EspDeadlineTimer& operator=(const EspDeadlineTimer&) = delete;
+
+    /// Create the esp_timer; false leaves arm() failing (polling only).
+    bool initialize()
+    {
+        const esp_timer_create_args_t args = {
+            .callback = callback_,
+            .arg = arg_,
+            .dispatch_method = ESP_TIMER_TASK,
+            .name = name_,
+            .skip_unhandled_events = true,
+        };
+        const esp_err_t err = esp_timer_create(&args, &handle_);
+        if (err != ESP_OK) {
+            ESP_LOGE("deadlinetimer", "%s: esp_timer_create failed: %s", name_,
+                     esp_err_to_name(err));
+            handle_ = nullptr;
+            return false;
+        }
+        return true;
+    }
+
+    bool arm(int64_t delayMs) override
+    {
+        if (handle_ == nullptr || delayMs < 0) {
+            return false;
+        }
+        // esp_timer_start_once() refuses a running timer; a stop of an
+        // idle one is a harmless ESP_ERR_INVALID_STATE.
+        esp_timer_stop(handle_);
+        return esp_timer_start_once(handle_, static_cast<uint64_t>(delayMs) * 1000) ==
+               ESP_OK;
+    }
+
+    void cancel() override
+    {
+        if (handle_ != nullptr) {
+            esp_timer_stop(handle_);
+        }
+    }
+
+private:
+    const char* name_;
+    Callback callback_;
+    void* arg_;
+    esp_timer_handle_t handle_ = nullptr;
+};
+
+#endif /* WATERINGSYSTEM_ACTUATORS_ESPDEADLINETIMER_H */
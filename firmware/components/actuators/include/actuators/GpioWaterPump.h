@@ -46,6 +46,18 @@ public:
      */
     bool initialize() override;
 
+    /**
+     * @brief Drive the output LOW from an interrupt handler (IRAM, no lock,
+     * no logging): one GPIO register write.
+     *
+     * For the over-current trip only (main/overcurrent_trip.cpp). The base
+     * class state is NOT touched — the pump still reports running until
+     * the deferred handler calls stop() through the LockedWaterPump, which
+     * re-asserts OFF and records the stop. Nothing drives the pin HIGH in
+     * between unless a start() is commanded.
+     */
+    void forceOffFromIsr();
+
 protected:
     bool applyOutput(bool on) override;
 
@@ -20,8 +20,17 @@
  * console registration, ...) goes through the LockedWaterPump, never
  * through the wrapped object directly.
  *
- * Pure C++ (<mutex> is available via pthread on ESP-IDF and on the linux
- * preview target), so the decorator is host-testable.
+ * LOCK-FREE READS: every call that can change the pump (initialize,
+ * runFor, runForVolume, stop, update) republishes its PumpStatus before
+ * releasing the mutex (interfaces/SnapshotPublisher.h). isRunning(),
+ * isAvailable(), the last error, stop reason and volume and the
+ * accumulated run time are copied from there, so the API, console and
+ * power tasks never queue behind the 10 Hz update(). getCurrentRunTimeMs()
+ * reads the clock and getName() returns a reference: both stay locked.
+ *
+ * Pure C++: the lock is a StaticMutex (a static FreeRTOS mutex on target,
+ * std::mutex on the host), so the decorator is host-testable; with
+ * WS_LOCK_STATS it is instrumented for contention (LockStats.h).
  */
 
 #ifndef WATERINGSYSTEM_ACTUATORS_LOCKEDWATERPUMP_H
@@ -32,18 +41,32 @@
 #include <string>
 
 #include "interfaces/IWaterPump.h"
+#include "interfaces/LockStats.h"
+#include "interfaces/SnapshotPublisher.h"
+
+/// What LockedWaterPump::status() copies out: the pump as of its last
+/// call through the wrapper.
+struct PumpStatus {
+    bool available = false;
+    bool running = false;
+    StopReason lastStopReason = StopReason::None;
+    int lastError = 0;
+    int64_t accumulatedRunTimeMs = 0;
+    PumpRunVolume lastRunVolume;
+};
 
 /**
  * @brief IWaterPump decorator that serializes every call with a mutex.
  *
  * Composition, not inheritance from WaterPump: the base class stays pure
  * (no locking) and the existing host tests are unchanged. The wrapped pump
- * must outlive this object.
+ * must outlive this object. Final, so a call through a LockedWaterPump& —
+ * the 10 Hz loop, the static-dispatch reservoir wiring — is direct.
  */
-class LockedWaterPump : public IWaterPump {
+class LockedWaterPump final : public IWaterPump {
 public:
     /// Wrap @p pump; the wrapped pump must outlive this object.
-    explicit LockedWaterPump(IWaterPump& pump) : pump_(pump) {}
+    explicit LockedWaterPump(IWaterPump& pump) : pump_(pump), published_(statusOf(pump)) {}
 
     LockedWaterPump(const LockedWaterPump&) = delete;
     LockedWaterPump& operator=(const LockedWaterPump&) = delete;
@@ -51,74 +74,95 @@ public:
     // IActuator
     bool initialize() override
     {
-        std::lock_guard<std::mutex> lock(mutex_);
-        return pump_.initialize();
+        std::lock_guard<DecoratorMutex> lock(mutex_);
+        const bool ok = pump_.initialize();
+        published_.publish(statusOf(pump_));
+        return ok;
     }
 
-    bool isAvailable() const override
-    {
-        std::lock_guard<std::mutex> lock(mutex_);
-        return pump_.isAvailable();
-    }
+    bool isAvailable() const override { return published_.load().available; }
 
     const std::string& getName() const override
     {
-        std::lock_guard<std::mutex> lock(mutex_);
+        std::lock_guard<DecoratorMutex> lock(mutex_);
         return pump_.getName();
     }
 
-    int getLastError() const override
-    {
-        std::lock_guard<std::mutex> lock(mutex_);
-        return pump_.getLastError();
-    }
+    int getLastError() const override { return published_.load().lastError; }
 
     // IWaterPump
     bool runFor(int durationS) override
     {
-        std::lock_guard<std::mutex> lock(mutex_);
-        return pump_.runFor(durationS);
+        std::lock_guard<DecoratorMutex> lock(mutex_);
+        const bool ok = pump_.runFor(durationS);
+        published_.publish(statusOf(pump_));
+        return ok;
     }
 
-    bool stop() override
+    bool runForVolume(int volumeMl, int maxDurationS) override
     {
-        std::lock_guard<std::mutex> lock(mutex_);
-        return pump_.stop();
+        std::lock_guard<DecoratorMutex> lock(mutex_);
+        const bool ok = pump_.runForVolume(volumeMl, maxDurationS);
+        published_.publish(statusOf(pump_));
+        return ok;
     }
 
-    bool isRunning() const override
+    bool stop() override
     {
-        std::lock_guard<std::mutex> lock(mutex_);
-        return pump_.isRunning();
+        std::lock_guard<DecoratorMutex> lock(mutex_);
+        const bool ok = pump_.stop();
+        published_.publish(statusOf(pump_));
+        return ok;
     }
 
+    bool isRunning() const override { return published_.load().running; }
+
     void update() override
     {
-        std::lock_guard<std::mutex> lock(mutex_);
+        std::lock_guard<DecoratorMutex> lock(mutex_);
         pump_.update();
+        published_.publish(statusOf(pump_));
     }
 
     int64_t getCurrentRunTimeMs() const override
     {
-        std::lock_guard<std::mutex> lock(mutex_);
+        std::lock_guard<DecoratorMutex> lock(mutex_);
         return pump_.getCurrentRunTimeMs();
     }
 
-    int64_t getAccumulatedRunTimeMs() const override
-    {
-        std::lock_guard<std::mutex> lock(mutex_);
-        return pump_.getAccumulatedRunTimeMs();
-    }
+    int64_t getAccumulatedRunTimeMs() const override { return published_.load().accumulatedRunTimeMs; }
+
+    StopReason getLastStopReason() const override { return published_.load().lastStopReason; }
+
+    PumpRunVolume getLastRunVolume() const override { return published_.load().lastRunVolume; }
+
+    /// Every published field as one consistent copy. Any task; never blocks.
+    PumpStatus status() const { return published_.load(); }
 
-    StopReason getLastStopReason() const override
+    /// Changes of status() so far, for a poller to skip an unchanged one.
+    uint32_t statusVersion() const { return published_.version(); }
+
+    /// The lock, for the LockRegistry (LockStats.h, WS_LOCK_STATS).
+    const DecoratorMutex& mutex() const { return mutex_; }
+
+private:
+    static PumpStatus statusOf(const IWaterPump& pump)
     {
-        std::lock_guard<std::mutex> lock(mutex_);
-        return pump_.getLastStopReason();
+        // Value-initialized, so the padding compares equal across publishes.
+        PumpStatus s{};
+        s.available = pump.isAvailable();
+        s.running = pump.isRunning();
+        s.lastStopReason = pump.getLastStopReason();
+        s.lastError = pump.getLastError();
+        s.accumulatedRunTimeMs = pump.getAccumulatedRunTimeMs();
+        s.lastRunVolume = pump.getLastRunVolume();
+        return s;
     }
 
-private:
     IWaterPump& pump_;
-    mutable std::mutex mutex_;
+    mutable DecoratorMutex mutex_;
+    /// statusOf(pump_) as of the last call that could change it.
+    SnapshotPublisher<PumpStatus> published_;
 };
 
 #endif /* WATERINGSYSTEM_ACTUATORS_LOCKEDWATERPUMP_H */
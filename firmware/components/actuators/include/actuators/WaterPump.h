@@ -11,6 +11,19 @@
  * REAL enforcement logic is exercised on the host via MockWaterPump +
  * FakeTimeProvider.
  *
+ * An optional IDeadlineTimer (setDeadlineTimer()) is armed for each run's
+ * end in runFor() and cancelled on every stop, so the timed stop lands on
+ * time instead of at the next poll; update() stays the backstop and the
+ * only place a stop is decided.
+ *
+ * An optional IPumpObserver (setObserver()) is told of every switch on and
+ * off as it happens, so no consumer has to poll isRunning() for the edges.
+ *
+ * An optional IFlowMeter (setFlowMeter()) adds volume runs: runForVolume()
+ * runs under a time cap like runFor(), and update() also stops it once the
+ * meter has counted the target since the switch on. Every run of a metered
+ * pump records its delivered volume (getLastRunVolume()).
+ *
  * This class MUST NOT call esp_timer or any hardware API directly — it is
  * compiled and tested on the IDF linux preview target.
  */
@@ -18,9 +31,13 @@
 #ifndef WATERINGSYSTEM_ACTUATORS_WATERPUMP_H
 #define WATERINGSYSTEM_ACTUATORS_WATERPUMP_H
 
+#include <atomic>
 #include <cstdint>
 #include <string>
 
+#include "interfaces/IDeadlineTimer.h"
+#include "interfaces/IFlowMeter.h"
+#include "interfaces/IPumpObserver.h"
 #include "interfaces/ITimeProvider.h"
 #include "interfaces/IWaterPump.h"
 
@@ -63,16 +80,48 @@ public:
 
     // IWaterPump
     bool runFor(int durationS) override;
+    bool runForVolume(int volumeMl, int maxDurationS) override;
     bool stop() override;
     bool isRunning() const override;
     void update() override;
     int64_t getCurrentRunTimeMs() const override;
     int64_t getAccumulatedRunTimeMs() const override;
     StopReason getLastStopReason() const override;
+    PumpRunVolume getLastRunVolume() const override;
 
     /// Hard cap for this instance (for diagnostics/error messages).
     int64_t getMaxRunTimeMs() const { return maxRunTimeMs_; }
 
+    /**
+     * @brief Arm @p timer at each run's end (nullptr: polling only).
+     *
+     * Its callback must call update() — through the LockedWaterPump when
+     * the pump is wrapped. A stale firing (the run was stopped or
+     * restarted meanwhile) finds nothing due. Set before the first run;
+     * the timer must outlive this object.
+     */
+    void setDeadlineTimer(IDeadlineTimer* timer) { deadlineTimer_ = timer; }
+
+    /**
+     * @brief Call @p observer at every switch on (runFor()) and off (any
+     * stop), after the output changed (nullptr = none).
+     *
+     * An atomic pointer, so the wiring may install it while other tasks
+     * already run the pump; @p observer must outlive this object or be
+     * removed first.
+     */
+    void setObserver(IPumpObserver* observer)
+    {
+        observer_.store(observer, std::memory_order_release);
+    }
+
+    /**
+     * @brief Meter this pump's runs with @p meter (nullptr: none, the
+     * default; runForVolume() is then rejected). Set before the first run;
+     * the meter must outlive this object.
+     */
+    void setFlowMeter(IFlowMeter* meter) { flowMeter_ = meter; }
+
 protected:
     /**
      * @brief Drive the physical output. The ONLY hardware touchpoint.
@@ -86,12 +135,22 @@ protected:
     void setLastError(int error) { lastError_ = error; }
 
 private:
+    /// Validate and switch on for @p durationS, stopping early once
+    /// @p targetMl is delivered (0: a timed run). Shared by both run kinds.
+    bool start(int durationS, uint32_t targetMl);
+
     /// Transition Running -> Stopped: paired applyOutput(false), statistics.
     void stopWith(StopReason reason);
 
+    /// Tell the observer, if any, that isRunning() is now @p running.
+    void notify(bool running);
+
     std::string name_;
     ITimeProvider& timeProvider_;
     int64_t maxRunTimeMs_;
+    IDeadlineTimer* deadlineTimer_ = nullptr;
+    std::atomic<IPumpObserver*> observer_{nullptr};
+    IFlowMeter* flowMeter_ = nullptr;
 
     bool initialized_ = false;
     bool running_ = false;
@@ -99,6 +158,9 @@ private:
     int64_t runDurationMs_ = 0;
     int64_t accumulatedRunTimeMs_ = 0;
     StopReason lastStopReason_ = StopReason::None;
+    uint32_t runStartMl_ = 0;     ///< meter reading at the switch on
+    uint32_t runTargetMl_ = 0;    ///< volume run target; 0 = timed run
+    PumpRunVolume lastRunVolume_;
     int lastError_ = 0;
 };
 
@@ -0,0 +1,46 @@
+// SPDX-FileCopyrightText: 2026 Cryptotomte
+// SPDX-License-Identifier: AGPL-3.0-or-later
+/**
+ * @file FakeDeadlineTimer.h
+ * @brief Host-test deadline timer: records arm()/cancel() (header-only).
+ *
+ * Never fires by itself — a test fires the deadline by advancing its
+ * FakeTimeProvider and calling the pump's update(), as the target timer's
+ * callback does. Never compiled into target builds (only included from
+ * test code).
+ */
+
+#ifndef WATERINGSYSTEM_ACTUATORS_TESTING_FAKEDEADLINETIMER_H
+#define WATERINGSYSTEM_ACTUATORS_TESTING_FAKEDEADLINETIMER_H
+
+#include <cstdint>
+
+#include "interfaces/IDeadlineTimer.h"
+
+/**
+ * @brief IDeadlineTimer that only records what it was asked.
+ */
+class FakeDeadlineTimer : public IDeadlineTimer {
+public:
+    bool armed = false;        ///< a deadline is pending
+    int64_t delayMs = 0;       ///< the last arm() delay
+    int armCalls = 0;
+    int cancelCalls = 0;
+    bool armResult = true;     ///< what arm() returns
+
+    bool arm(int64_t delay) override
+    {
+        ++armCalls;
+        delayMs = delay;
+        armed = armResult;
+        return armResult;
+    }
+
+    void cancel() override
+    {
+        ++cancelCalls;
+        armed = false;
+    }
+};
+
+#endif /* WATERINGSYSTEM_ACTUATORS_TESTING_FAKEDEADLINETIMER_H */
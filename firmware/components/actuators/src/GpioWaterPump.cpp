@@ -13,7 +13,9 @@
 
 #include <utility>
 
+#include "esp_attr.h"
 #include "esp_log.h"
+#include "hal/gpio_ll.h"
 
 static const char *TAG = "gpiowaterpump";
 
@@ -73,3 +75,10 @@ bool GpioWaterPump::applyOutput(bool on)
     }
     return true;
 }
+
+void IRAM_ATTR GpioWaterPump::forceOffFromIsr()
+{
+    // gpio_set_level() lives in flash unless CONFIG_GPIO_CTRL_FUNC_IN_IRAM;
+    // the inline LL write is one register store, safe with the cache off.
+    gpio_ll_set_level(GPIO_LL_GET_HW(GPIO_PORT_0), pin_, 0);
+}
@@ -29,7 +29,11 @@ bool WaterPump::initialize()
     // Boot fail-safe chain: drive the output OFF before anything else.
     // Idempotent — safe to call again at any time.
     const bool ok = applyOutput(false);
+    const bool wasRunning = running_;
     running_ = false;
+    if (wasRunning) {
+        notify(false);
+    }
     if (!ok) {
         ESP_LOGE(TAG, "%s: initialize failed to drive output OFF",
                  name_.c_str());
@@ -56,6 +60,26 @@ int WaterPump::getLastError() const
 }
 
 bool WaterPump::runFor(int durationS)
+{
+    return start(durationS, 0);
+}
+
+bool WaterPump::runForVolume(int volumeMl, int maxDurationS)
+{
+    if (flowMeter_ == nullptr) {
+        ESP_LOGW(TAG, "%s: runForVolume rejected: no flow meter",
+                 name_.c_str());
+        return false;
+    }
+    if (volumeMl <= 0) {
+        ESP_LOGW(TAG, "%s: runForVolume rejected: volume %d ml <= 0",
+                 name_.c_str(), volumeMl);
+        return false;
+    }
+    return start(maxDurationS, static_cast<uint32_t>(volumeMl));
+}
+
+bool WaterPump::start(int durationS, uint32_t targetMl)
 {
     // Rejections cause no output change and no state change (invariant 4).
     if (durationS <= 0) {
@@ -86,7 +110,21 @@ bool WaterPump::runFor(int durationS)
     running_ = true;
     runStartedAtMs_ = timeProvider_.nowMs();
     runDurationMs_ = durationMs;
-    ESP_LOGI(TAG, "%s: running for %d s", name_.c_str(), durationS);
+    runStartMl_ = flowMeter_ != nullptr ? flowMeter_->deliveredMl() : 0;
+    runTargetMl_ = targetMl;
+    // runDurationMs_ <= maxRunTimeMs_, so this one deadline covers both
+    // stops; update() picks the reason.
+    if (deadlineTimer_ != nullptr && !deadlineTimer_->arm(durationMs)) {
+        ESP_LOGW(TAG, "%s: deadline timer not armed — stop falls to the poll",
+                 name_.c_str());
+    }
+    if (targetMl != 0) {
+        ESP_LOGI(TAG, "%s: running for %u ml (at most %d s)", name_.c_str(),
+                 static_cast<unsigned>(targetMl), durationS);
+    } else {
+        ESP_LOGI(TAG, "%s: running for %d s", name_.c_str(), durationS);
+    }
+    notify(true);
     return true;
 }
 
@@ -121,6 +159,13 @@ void WaterPump::update()
         stopWith(StopReason::MaxRuntimeForced);
         return;
     }
+    // Volume before duration: a run that reached both in one poll delivered
+    // what was asked.
+    if (runTargetMl_ != 0 &&
+        flowMeter_->deliveredMl() - runStartMl_ >= runTargetMl_) {
+        stopWith(StopReason::VolumeReached);
+        return;
+    }
     if (elapsedMs >= runDurationMs_) {
         stopWith(StopReason::DurationElapsed);
     }
@@ -144,6 +189,11 @@ StopReason WaterPump::getLastStopReason() const
     return lastStopReason_;
 }
 
+PumpRunVolume WaterPump::getLastRunVolume() const
+{
+    return lastRunVolume_;
+}
+
 void WaterPump::stopWith(StopReason reason)
 {
     // Paired transition (invariant 1): exactly one OFF per ON. Even if the
@@ -152,10 +202,30 @@ void WaterPump::stopWith(StopReason reason)
     if (!applyOutput(false)) {
         ESP_LOGE(TAG, "%s: failed to switch output OFF", name_.c_str());
     }
+    if (deadlineTimer_ != nullptr) {
+        deadlineTimer_->cancel();
+    }
     const int64_t ranMs = timeProvider_.nowMs() - runStartedAtMs_;
     accumulatedRunTimeMs_ += ranMs;
     running_ = false;
     lastStopReason_ = reason;
-    ESP_LOGI(TAG, "%s: stopped after %lld ms", name_.c_str(),
-             static_cast<long long>(ranMs));
+    runTargetMl_ = 0;
+    if (flowMeter_ != nullptr) {
+        lastRunVolume_ = PumpRunVolume{true, flowMeter_->deliveredMl() - runStartMl_, ranMs};
+        ESP_LOGI(TAG, "%s: stopped after %lld ms, %u ml", name_.c_str(),
+                 static_cast<long long>(ranMs),
+                 static_cast<unsigned>(lastRunVolume_.volumeMl));
+    } else {
+        ESP_LOGI(TAG, "%s: stopped after %lld ms", name_.c_str(),
+                 static_cast<long long>(ranMs));
+    }
+    notify(false);
+}
+
+void WaterPump::notify(bool running)
+{
+    IPumpObserver* observer = observer_.load(std::memory_order_acquire);
+    if (observer != nullptr) {
+        observer->onRunningChanged(running);
+    }
 }
@@ -0,0 +1,54 @@
+// SPDX-FileCopyrightText: 2026 Cryptotomte
+// SPDX-License-Identifier: AGPL-3.0-or-later
+/**
+ * @file ApiDownsample.h
+ * @brief Point-budget reducers for GET /api/v1/history (host+target).
+ *
+ * A chart is a few hundred pixels wide; a 30-day window at a 60 s log
+ * cadence is 43 200 readings. The default `agg=avg` answers such a window
+ * per rollup bucket (mean/min/max), which flattens the spikes a chart is
+ * often looked at for. The two reducers here instead keep REAL readings —
+ * the output is a raw series (bucket 0) of at most `maxPoints` points:
+ *   - MinMax: the window is cut into maxPoints / 2 equal time buckets and
+ *     each keeps its lowest and highest reading, in time order, so every
+ *     excursion survives.
+ *   - Lttb: Largest-Triangle-Three-Buckets over maxPoints - 2 equal time
+ *     buckets between the first and last reading (both always kept): each
+ *     bucket keeps the reading that spans the largest triangle with the
+ *     previous pick and the next bucket's mean — the usual choice for a
+ *     visually faithful line.
+ *
+ * Both are streaming folds over IDataStorage::forEachReading(): MinMax is
+ * one pass; Lttb is two (bucket means, then picks), holding one small
+ * record per bucket and never the readings. Time buckets rather than
+ * index buckets, so logging gaps stay gaps on the chart. The change-only
+ * step fill is not applied to a reduced series (its hold points are
+ * sub-bucket detail). PURE C++, host-tested against MockDataStorage.
+ */
+
+#ifndef WATERINGSYSTEM_API_APIDOWNSAMPLE_H
+#define WATERINGSYSTEM_API_APIDOWNSAMPLE_H
+
+#include <cstddef>
+
+#include "api/ApiDtos.h"
+#include "interfaces/IDataStorage.h"
+
+namespace api {
+
+/**
+ * @brief Reduce series.metric over [series.start, series.end] to at most
+ * @p maxPoints readings with @p aggregate (MinMax or Lttb).
+ *
+ * On success fills series.timestamps/values (bucketS 0, mins/maxs empty,
+ * filled 0) and returns true. Returns false with @p series untouched when
+ * the window holds no more than @p maxPoints readings — the caller serves
+ * it raw — for HistoryAggregate::Avg, and for a @p maxPoints below
+ * kHistoryMinPoints (ApiRequests.h).
+ */
+bool downsampleHistory(const IDataStorage& storage, HistorySeries& series,
+                       HistoryAggregate aggregate, std::size_t maxPoints);
+
+}  // namespace api
+
+#endif /* WATERINGSYSTEM_API_APIDOWNSAMPLE_H */
@@ -20,6 +20,7 @@
 #ifndef WATERINGSYSTEM_API_APIDTOS_H
 #define WATERINGSYSTEM_API_APIDTOS_H
 
+#include <array>
 #include <cstdint>
 #include <optional>
 #include <string>
@@ -27,6 +28,25 @@
 
 namespace api {
 
+// ---------------------------------------------------------------------------
+// Field projection (`fields` on GET /api/v1/status and /sensors)
+// ---------------------------------------------------------------------------
+
+/// One `member.key` item of a projection: inside top-level @p member, only
+/// the keys listed for it are kept.
+struct FieldKey {
+    std::string member;
+    std::string key;
+};
+
+/// A parsed `fields` projection (parseStatusFields / parseSensorsFields):
+/// the top-level members to read and render, as the endpoint's k<Endpoint>*
+/// bits, and the keys kept inside the members only named by their keys.
+struct FieldSelection {
+    uint32_t members = 0;
+    std::vector<FieldKey> keys;  ///< empty: every selected member whole
+};
+
 // ---------------------------------------------------------------------------
 // System status (GET /api/v1/status)
 // ---------------------------------------------------------------------------
@@ -39,6 +59,7 @@ struct WifiStatusDto {
     bool connected = false;     ///< true in the Connected state
     bool ipAcquired = false;    ///< true after GotIp
     std::string ip;             ///< device IP (from esp_netif); empty if none
+    std::string powerSave;      ///< modem sleep in effect ("none", "min_modem", "max_modem")
 };
 
 /// Wall-clock/time-sync block. Reflects the not-set state per PR-08.
@@ -55,11 +76,41 @@ struct FirmwareDto {
     std::string project;        ///< project name
 };
 
+/// Storage write accounting since boot (IDataStorage StorageWriteStats).
+struct StorageWritesDto {
+    uint64_t bytesAppended = 0;
+    uint32_t syncs = 0;
+    uint32_t filesCreated = 0;
+    uint32_t filesRemoved = 0;
+    uint32_t tornRepairs = 0;
+    uint32_t rotations = 0;
+    uint64_t appendUs = 0;
+};
+
 /// Filesystem usage block (from IDataStorage stats).
 struct StorageStatsDto {
     uint64_t totalBytes = 0;
     uint64_t usedBytes = 0;
     float percentUsed = 0.0f;
+    StorageWritesDto writes;
+};
+
+/// Energy integrated on the node (sensors/EnergyMeter.h). Epochs of 0
+/// serialize as null (clock not set, nothing closed yet).
+struct EnergyDto {
+    double totalWh = 0.0;
+    double dayWh = 0.0;
+    uint32_t dayStart = 0;
+    double previousDayWh = 0.0;
+    uint32_t previousDayStart = 0;
+    bool runActive = false;
+    double runWh = 0.0;
+    uint32_t runMs = 0;
+    double lastRunWh = 0.0;
+    uint32_t lastRunMs = 0;
+    uint32_t lastRunStart = 0;
+    uint32_t runs = 0;
+    uint64_t uncoveredMs = 0;
 };
 
 /// Pump power telemetry (rev2 INA226). Absent (serialized null) on rev1.
@@ -68,10 +119,33 @@ struct PowerDto {
     float busVoltage = 0.0f;    ///< volts
     float current = 0.0f;       ///< amps (signed)
     float power = 0.0f;         ///< watts
+    bool hasEnergy = false;     ///< GET /power with the sampling task only
+    EnergyDto energy{};
+};
+
+/// One boot phase (interfaces/BootProfile.h).
+struct BootPhaseDto {
+    std::string name;           ///< bootPhaseName(): the `bootUs` key
+    uint32_t atUs = 0;          ///< us after reset; 0 = not reached (null)
 };
 
-/// Full system status DTO. `power` present only when `hasPower` (rev2).
+/// Top-level members of a status body, as `fields` bits (parseStatusFields).
+constexpr uint32_t kStatusMode = 1u << 0;
+constexpr uint32_t kStatusWifi = 1u << 1;
+constexpr uint32_t kStatusTime = 1u << 2;
+constexpr uint32_t kStatusUptime = 1u << 3;
+constexpr uint32_t kStatusResetReason = 1u << 4;
+constexpr uint32_t kStatusFirmware = 1u << 5;
+constexpr uint32_t kStatusStorage = 1u << 6;
+constexpr uint32_t kStatusBoot = 1u << 7;
+constexpr uint32_t kStatusPower = 1u << 8;
+constexpr uint32_t kStatusAll = (1u << 9) - 1;
+
+/// Full system status DTO. `power` present only when `hasPower` (rev2);
+/// `bootUs` is null while `boot` is empty (no profile wired). Only the
+/// members in `fields` are read and rendered.
 struct SystemStatusDto {
+    uint32_t fields = kStatusAll;
     std::string mode;           ///< "manual"|"automatic" (from wateringEnabled)
     WifiStatusDto wifi;
     TimeStatusDto time;
@@ -81,6 +155,7 @@ struct SystemStatusDto {
     StorageStatsDto storage;
     bool hasPower = false;      ///< true on rev2 (power block present)
     PowerDto power;
+    std::vector<BootPhaseDto> boot;  ///< every phase, in BootPhase order
 };
 
 // ---------------------------------------------------------------------------
@@ -112,6 +187,23 @@ struct SoilDto {
     float potassium = 0.0f;
 };
 
+/// One probe of a multi-drop soil segment, by its Modbus slave address.
+struct SoilProbeDto {
+    uint8_t address = 0;
+    SoilDto soil;
+};
+
+/// What the soil poll rounds cost the RS485 bus (sensors/SoilPollScheduler.h).
+struct SoilBusDto {
+    uint32_t periodMs = 0;          ///< interval the probes are spread over
+    uint32_t readAirtimeUs = 0;     ///< wire time of one probe read
+    uint32_t budgetPermille = 0;    ///< every probe's airtime over the period
+    uint32_t measuredPermille = 0;  ///< bus busy time over the last period
+    uint32_t polls = 0;
+    uint32_t failures = 0;
+    uint32_t missed = 0;            ///< slots a new period cut off
+};
+
 /// One reservoir level mark (low or high); `waterPresent` valid only if `valid`.
 struct LevelMarkDto {
     bool valid = false;
@@ -124,10 +216,25 @@ struct LevelDto {
     LevelMarkDto high;
 };
 
+/// Top-level members of a sensors body, as `fields` bits
+/// (parseSensorsFields); kSensorsSoilProbes covers soilBus too.
+constexpr uint32_t kSensorsEnvironmental = 1u << 0;
+constexpr uint32_t kSensorsSoil = 1u << 1;
+constexpr uint32_t kSensorsSoilProbes = 1u << 2;
+constexpr uint32_t kSensorsLevel = 1u << 3;
+constexpr uint32_t kSensorsPower = 1u << 4;
+constexpr uint32_t kSensorsTimestamp = 1u << 5;
+constexpr uint32_t kSensorsAll = (1u << 6) - 1;
+
 /// Full sensor-readings DTO. `power` present only when `hasPower` (rev2).
+/// Only the members in `fields` are read and rendered.
 struct SensorReadingsDto {
+    uint32_t fields = kSensorsAll;
     EnvironmentalDto environmental;
-    SoilDto soil;
+    SoilDto soil;                          ///< the primary probe
+    std::vector<SoilProbeDto> soilProbes;  ///< every probe, primary first;
+                                           ///< empty on a one-probe bus
+    SoilBusDto soilBus;                    ///< meaningful with soilProbes
     LevelDto level;
     bool hasPower = false;      ///< true on rev2 (power block present)
     PowerDto power;
@@ -141,13 +248,29 @@ struct SensorReadingsDto {
 
 /// One pump's status. The list is capability-enumerated (BOARD_HAS_RESERVOIR_PUMP).
 struct PumpDto {
-    std::string name;                   ///< "plant"|"reservoir"
+    std::string name;                   ///< "plant"|"reservoir"|a zone's
     bool running = false;
     uint32_t currentRunTimeMs = 0;      ///< elapsed in the current run
     uint32_t accumulatedRunTimeMs = 0;  ///< lifetime total
     std::string lastStopReason;         ///< reason string of the last stop
 };
 
+/// Runtime and starts of one pump over one hour or one day.
+struct PumpUsageBucketDto {
+    uint32_t start = 0;   ///< epoch of the bucket's first second (UTC)
+    uint32_t runMs = 0;   ///< runtime of the runs that started in it
+    uint32_t starts = 0;  ///< runs that started in it
+};
+
+/// One pump's recent usage (control/PumpUsage.h), oldest bucket first.
+struct PumpUsageDto {
+    std::string name;
+    bool timed = false;          ///< false: clock not set, both lists empty
+    uint32_t untimedRuns = 0;    ///< runs this boot before the clock was set
+    std::vector<PumpUsageBucketDto> hours;
+    std::vector<PumpUsageBucketDto> days;
+};
+
 /// Pump command action parsed from a request body.
 enum class PumpAction {
     Start,  ///< begin a timed run of durationS (rejected if already running)
@@ -166,6 +289,15 @@ struct PumpCommand {
 // Config (GET/POST /api/v1/config)
 // ---------------------------------------------------------------------------
 
+/// One metric's change-only log policy (IConfigStore MetricLogPolicy),
+/// keyed by metric name on the wire.
+struct LogPolicyDto {
+    std::string metric;
+    float deadbandAbs = 0.0f;
+    float deadbandRel = 0.0f;
+    uint32_t heartbeatS = 0;  ///< 0 = policy off
+};
+
 /// Current configuration (GET). NEVER carries the wifi password.
 struct ConfigDto {
     float moistureThresholdLow = 0.0f;
@@ -175,6 +307,7 @@ struct ConfigDto {
     bool wateringEnabled = false;
     uint32_t sensorReadIntervalMs = 0;
     uint32_t dataLogIntervalMs = 0;
+    std::vector<LogPolicyDto> logPolicies;  ///< every known metric, id order
 };
 
 /// Parsed config-set body (POST): any subset of settable fields. Validation is
@@ -187,12 +320,26 @@ struct ConfigSetRequest {
     std::optional<bool> wateringEnabled;
     std::optional<uint32_t> sensorReadIntervalMs;
     std::optional<uint32_t> dataLogIntervalMs;
+    std::vector<LogPolicyDto> logPolicies;  ///< whole policies; empty = none
 };
 
 // ---------------------------------------------------------------------------
 // History (GET /api/v1/history)
 // ---------------------------------------------------------------------------
 
+/// GET /api/v1/history body representation (selectHistoryFormat()).
+enum class HistoryFormat {
+    Json,    ///< the JSON envelope (default)
+    Binary,  ///< packed little-endian records (ApiStream.h)
+};
+
+/// How a /history window over its point budget is reduced (`agg`).
+enum class HistoryAggregate {
+    Avg,     ///< per-bucket mean/min/max at a rollup tier width (default)
+    MinMax,  ///< each time bucket's lowest and highest reading (ApiDownsample.h)
+    Lttb,    ///< Largest-Triangle-Three-Buckets picks (ApiDownsample.h)
+};
+
 /// Parsed history query. Either a named `range` OR explicit `start`/`end`;
 /// default window is the last 24 h when none is given.
 struct HistoryQuery {
@@ -201,17 +348,59 @@ struct HistoryQuery {
     std::optional<std::string> range;  ///< named: 1h/6h/24h/7d/30d
     std::optional<int64_t> start;      ///< explicit window start (epoch)
     std::optional<int64_t> end;        ///< explicit window end (epoch)
+    HistoryFormat format = HistoryFormat::Json;  ///< /history only
+    std::optional<uint32_t> maxPoints;           ///< /history only; absent = kHistoryMaxPoints
+    HistoryAggregate aggregate = HistoryAggregate::Avg;  ///< /history only
+    /// /history paging (either one selects it): raw readings per page, and
+    /// the `next` of the previous page as given (parseReadingCursor).
+    std::optional<uint32_t> limit;
+    std::optional<std::string> cursor;
+    /// /history only: the newest this many readings instead of a window
+    /// (IDataStorage::getLatestReadings).
+    std::optional<uint32_t> last;
+    /// /history only: a leaf's series from the ESP-NOW gateway's table
+    /// (NodeGateway.h) instead of this node's store.
+    std::optional<std::string> node;
 };
 
 /// History result: aligned timestamps[]/values[] plus an echo of the query.
-/// Empty arrays for a range with no data (not an error).
+/// Empty arrays for a range with no data (not an error). When `bucketS` is
+/// non-zero each point is one bucket: timestamp = bucket start, value = the
+/// bucket mean, with the bucket min/max in mins[]/maxs[].
 struct HistorySeries {
     std::string metric;
     std::optional<std::string> reading;
     int64_t start = 0;                 ///< resolved window start (epoch)
     int64_t end = 0;                   ///< resolved window end (epoch)
+    uint32_t bucketS = 0;              ///< 0 = raw readings
     std::vector<int64_t> timestamps;
     std::vector<float> values;         ///< aligned 1:1 with timestamps
+    std::vector<float> mins;           ///< bucketed series only, aligned
+    std::vector<float> maxs;           ///< bucketed series only, aligned
+    uint32_t filled = 0;               ///< points held over (stepFillHistory)
+    std::optional<std::string> next;   ///< paged series only: resume cursor
+                                       ///< while more readings remain
+};
+
+/// History window summary (GET /api/v1/history/stats): the /history window
+/// reduced to count/min/max/mean/last plus estimated p5/p50/p95. The value
+/// fields are meaningful only when count > 0, the percentiles only when
+/// `percentiles` is set (serialized as null otherwise).
+struct HistoryStatsDto {
+    std::string metric;
+    std::optional<std::string> reading;
+    int64_t start = 0;                 ///< resolved window start (epoch)
+    int64_t end = 0;                   ///< resolved window end (epoch)
+    uint32_t count = 0;
+    float min = 0.0f;
+    float max = 0.0f;
+    float mean = 0.0f;
+    float last = 0.0f;                 ///< newest reading in the window
+    int64_t lastTimestamp = 0;         ///< its epoch
+    bool percentiles = false;          ///< p5/p50/p95 hold an estimate
+    float p5 = 0.0f;                   ///< from IDataStorage::getSensorQuantiles
+    float p50 = 0.0f;
+    float p95 = 0.0f;
 };
 
 // ---------------------------------------------------------------------------
@@ -226,6 +415,20 @@ struct EventDto {
     std::string detail;
 };
 
+/// Events of one category over the summary window.
+struct EventCategoryCountDto {
+    int category = 0;
+    std::optional<std::string> categoryName;  ///< human name, when known
+    uint32_t count = 0;
+};
+
+/// Per-category event counts of the last hours (GET /api/v1/events/summary).
+struct EventSummaryDto {
+    uint32_t hours = 0;   ///< window length
+    int64_t since = 0;    ///< start of the oldest hour in the window
+    std::vector<EventCategoryCountDto> categories;  ///< ascending category
+};
+
 // ---------------------------------------------------------------------------
 // Self-test (POST /api/v1/selftest)
 // ---------------------------------------------------------------------------
@@ -243,6 +446,276 @@ struct SelfTestResultDto {
     std::vector<SelfTestCheckDto> checks;
 };
 
+// ---------------------------------------------------------------------------
+// Device metrics (GET /api/v1/metrics)
+// ---------------------------------------------------------------------------
+
+/// One slave-and-function row of the RS485 statistics
+/// (sensors/ModbusLinkStats.h).
+struct ModbusLinkDto {
+    uint8_t address = 0;
+    uint8_t function = 0;              ///< Modbus function code (0x03, 0x06)
+    uint32_t ok = 0;
+    uint32_t timeouts = 0;
+    uint32_t frameErrors = 0;          ///< CRC, framing, bad response
+    uint32_t exceptions = 0;
+    uint32_t otherErrors = 0;
+    /// Per-bucket (not cumulative) counts; bucket i ends at
+    /// SystemMetricsDto::modbusLatencyBaseUs << i, the last is +Inf.
+    std::vector<uint32_t> latency;
+    uint64_t latencySumUs = 0;
+    int64_t lastSuccessMs = -1;        ///< uptime; -1 = never
+};
+
+/// One task of the task telemetry (interfaces/TaskTelemetry.h).
+struct TaskMetricsDto {
+    std::string name;
+    uint32_t cpuPermille = 0;          ///< of one core over the last window
+    uint32_t stackFreeBytes = 0;       ///< stack high-water mark
+    uint32_t priority = 0;
+    int core = -1;                     ///< -1 = not pinned
+};
+
+/// Heap of one capability ("internal", "dma", "psram").
+struct HeapCapsDto {
+    std::string caps;
+    uint32_t totalBytes = 0;
+    uint32_t freeBytes = 0;
+    uint32_t minFreeBytes = 0;
+    uint32_t largestBlockBytes = 0;
+};
+
+/// One budgeted buffer pool (interfaces/BufferBudget.h).
+struct BufferPoolDto {
+    std::string pool;
+    uint32_t budgetBytes = 0;        ///< granted for this board
+    uint32_t internalBytes = 0;      ///< held in internal RAM
+    uint32_t psramBytes = 0;         ///< held in PSRAM
+    uint32_t peakBytes = 0;
+    uint32_t failures = 0;           ///< allocations neither placement had
+};
+
+/// One decorator mutex's contention counters (interfaces/LockStats.h).
+struct LockMetricsDto {
+    std::string name;
+    uint32_t acquisitions = 0;
+    uint32_t contended = 0;            ///< acquisitions that waited
+    uint32_t waitUs = 0;               ///< summed over the contended ones
+    uint32_t maxWaitUs = 0;
+    uint32_t maxHoldUs = 0;
+};
+
+/// One watchdog-subscribed task's feed intervals (interfaces/WatchdogFeeds.h).
+struct WatchdogFeedDto {
+    std::string task;
+    /// Per-bucket (not cumulative) counts; bucket i ends at
+    /// SystemMetricsDto::watchdogBucketBaseUs << i, the last is +Inf.
+    std::vector<uint32_t> intervals;
+    uint64_t sumUs = 0;
+    uint32_t maxIntervalUs = 0;
+};
+
+/// Durations of one watering-tick phase, or of whole ticks
+/// (interfaces/TickLatency.h).
+struct TickDurationDto {
+    std::string phase;  ///< tickPhaseName(); empty for the whole tick
+    /// Per-bucket (not cumulative) counts; bucket i ends at
+    /// SystemMetricsDto::tickBucketBaseUs << i, the last is +Inf.
+    std::vector<uint32_t> durations;
+    uint64_t sumUs = 0;
+    uint32_t maxUs = 0;
+};
+
+/// One counter kept across resets (interfaces/LifetimeCounters.h).
+struct LifetimeCounterDto {
+    std::string name;
+    uint64_t value = 0;
+};
+
+/// Time since boot in one power state (interfaces/PowerLocks.h).
+struct PowerStateDto {
+    std::string state;  ///< powerStateName()
+    uint64_t us = 0;
+};
+
+/// Acquisitions of one power-management lock kind since boot.
+struct PowerLockDto {
+    std::string lock;   ///< powerLockKindName()
+    uint32_t acquisitions = 0;
+};
+
+/// MQTT uplink state and counters since boot (api/MqttUplink.h).
+struct MqttUplinkStats {
+    bool connected = false;
+    bool replaying = false;
+    uint32_t watermark = 0;         ///< acknowledged through (epoch), 0 = never
+    uint32_t inflight = 0;          ///< messages awaiting their PUBACK
+    uint32_t connects = 0;
+    uint32_t batches = 0;           ///< live batches taken by the client
+    uint32_t replayPages = 0;       ///< replay pages taken by the client
+    uint32_t acked = 0;             ///< PUBACKs of either
+    uint32_t spooled = 0;           ///< live batches left to the history store
+    uint32_t rejected = 0;          ///< publishes the client refused
+    uint32_t droppedMessages = 0;   ///< pending messages lost to a full queue
+};
+
+/// HTTPS handshakes of one kind since boot (api/ApiMetrics.h, TlsMetrics).
+struct TlsHandshakeDto {
+    uint32_t count = 0;
+    uint64_t sumUs = 0;             ///< ClientHello read to session up
+    /// Per-bucket (not cumulative) durations on the route latency bounds
+    /// (kLatencyBucketBaseUs << i); the last entry is +Inf.
+    std::array<uint32_t, 14> durations{};
+};
+
+/// HTTPS sessions and handshakes since boot.
+struct TlsStats {
+    uint32_t sessionsOpen = 0;      ///< TLS sessions held now
+    uint32_t failed = 0;            ///< handshakes begun that never completed
+    TlsHandshakeDto full;           ///< key exchange and server signature
+    TlsHandshakeDto resumed;        ///< from a session ticket, no asymmetric work
+};
+
+/// One open HTTP session (api/ApiMetrics.h SocketMetrics).
+struct HttpSessionDto {
+    int fd = -1;
+    uint64_t ageUs = 0;             ///< since it was accepted
+    uint64_t idleUs = 0;            ///< since its last request (or accept)
+    uint32_t requests = 0;          ///< answered on it
+    uint64_t bytesSent = 0;         ///< body bytes of those answers
+};
+
+/// HTTP sessions since boot: how full the server is and how often clients
+/// reconnect (every session opened is a TCP handshake).
+struct HttpSessionStats {
+    uint32_t maxOpen = 0;           ///< the server's session cap
+    uint32_t open = 0;
+    uint32_t peakOpen = 0;
+    uint32_t opened = 0;
+    uint32_t closed = 0;
+    uint32_t untracked = 0;         ///< opened while the session table was full
+    std::vector<HttpSessionDto> sessions;
+};
+
+/// ESP-NOW leaf link counters since boot (api/NodeLeaf.h).
+struct NodeLeafStats {
+    uint32_t reports = 0;           ///< reports sent (first attempts)
+    uint32_t acked = 0;             ///< reports the gateway acknowledged
+    uint32_t retries = 0;           ///< resends after an ACK timeout
+    uint32_t lost = 0;              ///< reports given up after the last retry
+    uint32_t rejected = 0;          ///< sends the driver refused
+};
+
+/// ESP-NOW gateway counters since boot (api/NodeGateway.h).
+struct NodeGatewayStats {
+    uint32_t nodes = 0;             ///< leaves in the table now
+    uint32_t reports = 0;           ///< new reports stored
+    uint32_t duplicates = 0;        ///< resent reports (their ACK was lost)
+    uint32_t missed = 0;            ///< sequence gaps: reports never received
+    uint32_t malformed = 0;         ///< frames decodeNodeFrame rejected
+    uint32_t refused = 0;           ///< reports from a leaf the full table left out
+};
+
+/// Process-level gauges and counters exported next to the per-route HTTP
+/// metrics (api/ApiMetrics.h).
+struct SystemMetricsDto {
+    uint64_t uptimeMs = 0;
+    uint32_t heapFreeBytes = 0;
+    uint32_t heapMinFreeBytes = 0;       ///< low-water mark since boot
+    uint32_t heapLargestBlockBytes = 0;  ///< largest allocatable block
+    uint32_t taskCount = 0;
+    uint32_t httpdStackFreeBytes = 0;    ///< httpd task stack high-water mark
+    StorageStatsDto storage;             ///< percentUsed is not exported
+    uint32_t storageQueueDepth = 0;
+    uint32_t storageQueueDropped = 0;
+    uint32_t storageQueueCoalesced = 0;
+    uint32_t storageWriterWaits = 0;
+    uint32_t responseCacheHits = 0;
+    uint32_t responseCacheMisses = 0;
+    uint32_t streamClients = 0;
+    uint32_t arenaCapacityBytes = 0;     ///< RequestArena block size
+    uint32_t arenaHighWaterBytes = 0;    ///< most of it one request used
+    uint32_t arenaFallbacks = 0;         ///< cJSON allocations that spilled
+                                         ///< to the heap
+    uint32_t throttledRequests = 0;      ///< refused by the rate limiter
+    bool hasModbus = false;              ///< the RS485 block below is set
+    std::vector<ModbusLinkDto> modbusLinks;
+    uint32_t modbusLatencyBaseUs = 0;
+    uint32_t modbusUntracked = 0;        ///< transfers the link table missed
+    uint64_t modbusBusyUs = 0;           ///< bus time in transfers since boot
+    bool hasTasks = false;               ///< the task telemetry below is set
+    uint32_t taskWindowUs = 0;           ///< span the CPU shares cover
+    std::vector<TaskMetricsDto> tasks;
+    std::vector<HeapCapsDto> heaps;      ///< capabilities the board has
+    std::vector<BufferPoolDto> buffers;  ///< declared pools; empty: none
+    std::vector<LockMetricsDto> locks;   ///< empty without lock statistics
+    std::vector<WatchdogFeedDto> watchdogFeeds;  ///< empty: none tracked
+    uint32_t watchdogBucketBaseUs = 0;
+    bool hasTicks = false;               ///< the watering-tick block below is set
+    TickDurationDto tick;                ///< whole ticks
+    std::vector<TickDurationDto> tickPhases;
+    uint32_t tickBucketBaseUs = 0;
+    uint32_t tickBudgetUs = 0;           ///< 0: no budget
+    uint32_t ticksOverBudget = 0;
+    std::vector<LifetimeCounterDto> lifetime;  ///< empty: not registered
+    std::vector<PowerStateDto> powerStates;  ///< empty: no power management
+    std::vector<PowerLockDto> powerLocks;
+    std::string wifiPowerSave;           ///< wifiPowerSaveName(); empty: no station
+    std::optional<MqttUplinkStats> mqtt; ///< empty: no uplink
+    std::optional<TlsStats> tls;         ///< empty: plain HTTP
+    std::optional<HttpSessionStats> sessions;  ///< empty: not tracked
+};
+
+// ---------------------------------------------------------------------------
+// Nodes (GET /api/v1/nodes, ESP-NOW gateway role)
+// ---------------------------------------------------------------------------
+
+/// One leaf's latest report as the gateway holds it (api/NodeGateway.h).
+/// `sensors` carries the primary soil probe only (api/NodeFrame.h).
+struct NodeDto {
+    std::string node;               ///< station MAC, 12 lowercase hex digits
+    uint32_t lastSeenS = 0;         ///< since the last report arrived
+    int rssi = 0;                   ///< dBm of that report
+    uint32_t reports = 0;
+    uint32_t duplicates = 0;
+    uint32_t missed = 0;
+    SensorReadingsDto sensors;
+    std::vector<PumpDto> pumps;     ///< lastStopReason stays on the leaf
+};
+
+// ---------------------------------------------------------------------------
+// Logs (GET /api/v1/logs)
+// ---------------------------------------------------------------------------
+
+/// The newest log lines the background sink wrote out (interfaces/LogRing.h).
+struct LogsDto {
+    uint32_t dropped = 0;            ///< lines lost to a full ring since boot
+    std::vector<std::string> lines;  ///< oldest first, without line breaks
+};
+
+// ---------------------------------------------------------------------------
+// Dashboard snapshot (GET /api/v1/snapshot)
+// ---------------------------------------------------------------------------
+
+/// Sections of a snapshot body, as `fields` bits (parseSnapshotFields).
+constexpr uint32_t kSnapshotStatus = 1u << 0;
+constexpr uint32_t kSnapshotSensors = 1u << 1;
+constexpr uint32_t kSnapshotPumps = 1u << 2;
+constexpr uint32_t kSnapshotPower = 1u << 3;
+constexpr uint32_t kSnapshotAll =
+    kSnapshotStatus | kSnapshotSensors | kSnapshotPumps | kSnapshotPower;
+
+/// One dashboard refresh: the selected sections, each the DTO of its own
+/// endpoint, read in one pass (the power block is read once and shared).
+struct SnapshotDto {
+    uint32_t fields = kSnapshotAll;  ///< sections present in the body
+    SystemStatusDto status;
+    SensorReadingsDto sensors;
+    std::vector<PumpDto> pumps;
+    bool hasPower = false;           ///< true on rev2 (power block present)
+    PowerDto power;
+};
+
 }  // namespace api
 
 #endif /* WATERINGSYSTEM_API_APIDTOS_H */
@@ -0,0 +1,108 @@
+// SPDX-FileCopyrightText: 2026 Cryptotomte
+// SPDX-License-Identifier: AGPL-3.0-or-later
+/**
+ * @file ApiETag.h
+ * @brief Entity tags and If-None-Match for the polled GET endpoints
+ *        (host+target).
+ *
+ * The dashboard polls /sensors, /pumps and /config every few seconds and
+ * most polls return the bytes it already holds. Each of those responses
+ * carries an ETag; a poll that sends it back in If-None-Match gets a
+ * bodiless 304 and the server skips the cJSON build and print entirely.
+ *
+ * Where the tag comes from:
+ *  - /config: IConfigStore::generation(), which moves on every persisted
+ *    write — no config read at all for the tag.
+ *  - /pumps: a fingerprint of the pump DTOs (a stopped pump's status is
+ *    static; a running one changes every poll, as its body does).
+ *  - /sensors: a fingerprint of the readings, WITHOUT the top-level
+ *    `timestamp` (the response time, which would defeat every match). The
+ *    tag is therefore weak (`W/`): a 304 hands back a body whose readings
+ *    are current but whose timestamp is that of the copy the client holds.
+ * The sensor interfaces expose no publish counter, and the fingerprint
+ * costs the same cached-getter reads the body does, so none was added.
+ *
+ * /status is not tagged: its uptime and clock fields change every call.
+ *
+ * Every tag also carries a per-boot salt, so a counter that restarts at 0
+ * after a reboot or an OTA (new body format) never matches a stale copy.
+ * PURE C++ (no esp_http_server), host-tested.
+ */
+
+#ifndef WATERINGSYSTEM_API_APIETAG_H
+#define WATERINGSYSTEM_API_APIETAG_H
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include "api/ApiDtos.h"
+
+namespace api {
+
+/**
+ * @brief 32-bit FNV-1a over the fields fed in, in order.
+ *
+ * Floats hash by value: every NaN hashes the same (the getters' "no
+ * reading" placeholder) and -0 equals +0, so equal-looking bodies hash
+ * equal.
+ */
+class ETagHash {
+public:
+    ETagHash& add(uint32_t value);
+    ETagHash& add(bool value);
+    ETagHash& add(float value);
+    ETagHash& add(const std::string& text);
+
+    uint32_t value() const { return hash_; }
+
+private:
+    void addByte(uint8_t byte);
+
+    uint32_t hash_ = 2166136261u;
+};
+
+/// `"<salt><value>"` as 16 hex digits, prefixed `W/` when @p weak.
+std::string formatETag(uint32_t salt, uint32_t value, bool weak = false);
+
+/// Per-section fingerprints: sensorsFingerprint() combines them, and the
+/// live stream (api/LiveStream.h) diffs on them.
+uint32_t fingerprint(const EnvironmentalDto& env);
+uint32_t fingerprint(const SoilDto& soil);
+uint32_t fingerprint(const LevelDto& level);
+uint32_t fingerprint(const PowerDto& power);
+uint32_t fingerprint(const PumpDto& pump);
+
+/// What the pushers (live stream, MQTT uplink) send a `pump` message on: a
+/// start/stop, never a run-time tick.
+uint32_t pumpStateFingerprint(const PumpDto& pump);
+
+/// Fingerprint of the /sensors readings; the top-level timestamp is left out.
+uint32_t sensorsFingerprint(const SensorReadingsDto& dto);
+
+/// Fingerprint of the /pumps list, every field of every pump.
+uint32_t pumpsFingerprint(const std::vector<PumpDto>& pumps);
+
+/**
+ * @brief Does an If-None-Match header value name @p etag?
+ *
+ * @p header is `*` or a comma-separated list of entity tags. Comparison is
+ * the weak one RFC 9110 prescribes for If-None-Match: a `W/` prefix on
+ * either side is ignored. A malformed list simply does not match (the
+ * client gets the full body).
+ */
+bool ifNoneMatchHits(const std::string& header, const std::string& etag);
+
+/**
+ * @brief May a Range request with this If-Range value be served partially?
+ *
+ * True when @p header is @p etag under the strong comparison RFC 9110
+ * prescribes for If-Range: a weak tag on either side never matches, and
+ * neither does a date (no Last-Modified is sent). On false the client gets
+ * the whole body, which replaces what it resumed from.
+ */
+bool ifRangeHolds(const std::string& header, const std::string& etag);
+
+}  // namespace api
+
+#endif /* WATERINGSYSTEM_API_APIETAG_H */
@@ -33,12 +33,16 @@ namespace api {
  * in esp_http_server's httpd status constants.
  */
 enum class ApiStatus {
-    Ok = 200,             ///< successful request
-    BadRequest = 400,     ///< malformed JSON or failed validation
-    NotFound = 404,       ///< unknown `/api/<path>` route or unknown resource name
-    Conflict = 409,       ///< command rejected by state (e.g. pump already running)
-    InternalError = 500,  ///< unexpected server-side failure (e.g. persist error)
-    NotImplemented = 501  ///< contract stub (e.g. OTA — PR-13)
+    Ok = 200,               ///< successful request
+    PartialContent = 206,   ///< the one byte range a Range header asked for
+    NotModified = 304,      ///< If-None-Match named the current ETag (no body)
+    BadRequest = 400,       ///< malformed JSON or failed validation
+    NotFound = 404,         ///< unknown `/api/<path>` route or unknown resource name
+    Conflict = 409,         ///< command rejected by state (e.g. pump already running)
+    RangeNotSatisfiable = 416,  ///< Range starts past the end of the body
+    TooManyRequests = 429,  ///< client over its request rate (RateLimiter.h)
+    InternalError = 500,    ///< unexpected server-side failure (e.g. persist error)
+    NotImplemented = 501    ///< feature not built in (e.g. OTA without CONFIG_WS_OTA)
 };
 
 /**
@@ -0,0 +1,207 @@
+// SPDX-FileCopyrightText: 2026 Cryptotomte
+// SPDX-License-Identifier: AGPL-3.0-or-later
+/**
+ * @file ApiMetrics.h
+ * @brief Per-route HTTP counters and the GET /api/v1/metrics text body
+ *        (host+target).
+ *
+ * Every answered request is recorded once against its route slot: the
+ * request count, the status class, the body bytes sent and the handler time
+ * (first byte in to last byte out, from esp_timer) in a log-bucketed
+ * histogram — 1 ms doubling to 4.096 s, then +Inf — so a slow /history
+ * query or a starving httpd task shows up in the upper buckets. A request
+ * whose handler failed — before answering, or by cutting a stream short —
+ * counts as 5xx.
+ *
+ * The body is the Prometheus text exposition format (version 0.0.4): the
+ * route metrics (routes never hit are left out), then the process gauges of
+ * a SystemMetricsDto and, when set, its RS485 block: per slave and
+ * function the outcome counts (ok, timeout, frame error, exception) and a
+ * transfer-time histogram, the last good transfer and the bus busy time —
+ * and, when set, its task telemetry: each task's share of one core and its
+ * stack high-water mark, and the heap of each capability — and, when
+ * declared, each buffer pool's budget, bytes by placement, peak and failed
+ * allocations — and, when set, the watering task's tick durations, whole
+ * and per phase, their worst and the ticks over budget — and, over
+ * HTTPS, the open TLS sessions and the full and resumed handshakes with
+ * their durations on the route buckets — and, when tracked, the HTTP
+ * sessions: the cap, open and peak counts, sessions opened and closed (the
+ * reconnect churn) and each open session's age, idle time, requests and
+ * bytes. It is streamed
+ * through a ChunkWriter, so its size costs one buffer. PURE C++, host-tested; ApiServer.cpp does the timing.
+ */
+
+#ifndef WATERINGSYSTEM_API_APIMETRICS_H
+#define WATERINGSYSTEM_API_APIMETRICS_H
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <mutex>
+#include <tuple>
+#include <vector>
+
+#include "api/ApiDtos.h"
+#include "api/ApiRoutes.h"
+#include "api/ApiStream.h"
+#include "interfaces/StaticMutex.h"
+
+namespace api {
+
+/// Finite latency buckets; bucket i ends at kLatencyBucketBaseUs << i.
+constexpr std::size_t kLatencyBuckets = 13;
+constexpr uint32_t kLatencyBucketBaseUs = 1000;
+
+/// Status classes 1xx .. 5xx.
+constexpr std::size_t kStatusClasses = 5;
+
+/// Metric slots: one per HandlerId (NotFound collects the 404/405 error
+/// handlers), then the static asset catch-all.
+constexpr std::size_t kStaticAssetsSlot =
+    static_cast<std::size_t>(HandlerId::NotFound) + 1;
+constexpr std::size_t kMetricSlots = kStaticAssetsSlot + 1;
+
+/// The slot of an API route.
+constexpr std::size_t metricSlot(HandlerId id)
+{
+    return static_cast<std::size_t>(id);
+}
+
+/// Counters of one route since boot.
+struct RouteMetrics {
+    uint32_t requests = 0;
+    std::array<uint32_t, kStatusClasses> statusClasses{};
+    uint64_t bytesSent = 0;
+    /// Per-bucket (not cumulative) counts; the last entry is +Inf.
+    std::array<uint32_t, kLatencyBuckets + 1> latency{};
+    uint64_t latencySumUs = 0;
+};
+
+/// A copy of every slot, indexed like record() (on the heap: the httpd
+/// task's stack is small).
+using HttpMetricsSnapshot = std::vector<RouteMetrics>;
+
+class HttpMetrics {
+public:
+    HttpMetrics() = default;
+
+    HttpMetrics(const HttpMetrics&) = delete;
+    HttpMetrics& operator=(const HttpMetrics&) = delete;
+
+    /**
+     * @brief Count one answered request.
+     *
+     * @param slot      metricSlot() or kStaticAssetsSlot; out of range is
+     *                  ignored
+     * @param status    HTTP status code; outside 100..599 counts as 5xx
+     * @param bytes     body bytes sent
+     * @param latencyUs handler time; negative counts as 0
+     */
+    void record(std::size_t slot, int status, uint64_t bytes, int64_t latencyUs);
+
+    HttpMetricsSnapshot snapshot() const;
+
+private:
+    mutable StaticMutex mutex_;
+    std::array<RouteMetrics, kMetricSlots> slots_{};
+};
+
+static_assert(std::tuple_size<decltype(TlsHandshakeDto::durations)>::value ==
+                  kLatencyBuckets + 1,
+              "TLS handshakes use the route latency buckets");
+
+/**
+ * @brief HTTPS session and handshake counters (ApiServer::setTls()).
+ *
+ * The server calls began() once a ClientHello is read and completed() when
+ * the session is up, both on the httpd task. A handshake that fails leaves
+ * nothing to hook, so the next began() finds the previous one still open
+ * and counts it as failed.
+ */
+class TlsMetrics {
+public:
+    TlsMetrics() = default;
+
+    TlsMetrics(const TlsMetrics&) = delete;
+    TlsMetrics& operator=(const TlsMetrics&) = delete;
+
+    void began();
+
+    /// A session is up after @p durationUs (negative counts as 0);
+    /// @p resumed when a session ticket spared the key exchange.
+    void completed(bool resumed, int64_t durationUs);
+
+    /// A session ended (never below zero open).
+    void closed();
+
+    TlsStats snapshot() const;
+
+private:
+    mutable StaticMutex mutex_;
+    TlsStats stats_;
+    bool pending_ = false;
+};
+
+/**
+ * @brief Per-session HTTP utilization (ApiServer's open and close hooks).
+ *
+ * opened() and closed() run on the httpd task from its session hooks,
+ * request() when an answer is counted; snapshot() from any task. A fixed
+ * table of kMaxSessions: sessions past it are counted, not tracked.
+ */
+class SocketMetrics {
+public:
+    static constexpr std::size_t kMaxSessions = 16;
+
+    SocketMetrics() = default;
+
+    SocketMetrics(const SocketMetrics&) = delete;
+    SocketMetrics& operator=(const SocketMetrics&) = delete;
+
+    /// The server's session cap, for the gauge.
+    void setCapacity(uint32_t maxOpen);
+
+    void opened(int fd, int64_t nowUs);
+
+    /// An answer of @p bytes on @p fd; an untracked fd is ignored.
+    void request(int fd, uint64_t bytes, int64_t nowUs);
+
+    void closed(int fd);
+
+    /// The counters, and the open sessions as of @p nowUs.
+    HttpSessionStats snapshot(int64_t nowUs) const;
+
+private:
+    struct Slot {
+        int fd = -1;
+        int64_t openedUs = 0;
+        int64_t lastUs = 0;
+        uint32_t requests = 0;
+        uint64_t bytesSent = 0;
+    };
+
+    mutable StaticMutex mutex_;
+    std::array<Slot, kMaxSessions> slots_{};
+    uint32_t maxOpen_ = 0;
+    uint32_t open_ = 0;
+    uint32_t peakOpen_ = 0;
+    uint32_t opened_ = 0;
+    uint32_t closed_ = 0;
+    uint32_t untracked_ = 0;
+};
+
+/// Content-Type of the metrics body.
+constexpr const char* kMetricsContentType = "text/plain; version=0.0.4; charset=utf-8";
+
+/**
+ * @brief Stream the GET /api/v1/metrics body.
+ *
+ * Slots past the end of a short @p http are treated as never hit.
+ * @return false when the sink failed (the body is incomplete)
+ */
+bool streamMetrics(const HttpMetricsSnapshot& http, const SystemMetricsDto& system,
+                   IChunkSink& sink);
+
+}  // namespace api
+
+#endif /* WATERINGSYSTEM_API_APIMETRICS_H */
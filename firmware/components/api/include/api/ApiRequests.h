@@ -7,29 +7,40 @@
  * These functions parse a raw JSON request body into the *Request / *Command
  * DTOs from ApiDtos.h, validating each field against the IConfigStore range
  * constants (the single source of truth for the settable ranges). They are
- * PURE C++ over cJSON (the espressif/cjson managed component, which links on the
- * linux preview target) — NO esp_http_server / esp_* dependency — so parsing and
+ * PURE C++ — NO esp_http_server / esp_* dependency — so parsing and
  * validation are deterministic and host-tested (T012). The thin target ApiServer
  * only forwards the request body here, then applies the result via the Locked*
  * interfaces.
  *
+ * Bodies and query values are taken as std::string_view over the buffer the
+ * server received them in, and bodies are read with the fixed-token
+ * JsonScanner rather than a cJSON tree: a valid request is parsed without a
+ * heap allocation (the DTOs' own strings and an error message aside).
+ *
  * Validation conventions (data-model.md):
  *   - Config-set is ALL-OR-NOTHING: any present field that is out of range or the
  *     wrong type fails the whole request (ok=false, an error naming the field)
  *     and NO field is marked to apply. Absent fields stay absent (std::optional).
- *   - Malformed JSON (cJSON_Parse returns NULL) is a rejection, never a crash.
+ *   - Malformed JSON (JsonScanner::parse fails, trailing bytes included) is a
+ *     rejection, never a crash.
  *   - No function throws: every outcome is reported through the result struct.
  */
 
 #ifndef WATERINGSYSTEM_API_APIREQUESTS_H
 #define WATERINGSYSTEM_API_APIREQUESTS_H
 
+#include <array>
 #include <cstddef>
 #include <cstdint>
 #include <optional>
 #include <string>
+#include <string_view>
+#include <vector>
 
 #include "api/ApiDtos.h"
+#include "interfaces/IConfigStore.h"
+#include "interfaces/IDataStorage.h"
+#include "interfaces/MetricRegistry.h"
 
 namespace api {
 
@@ -55,13 +66,19 @@ struct PumpCommandResult {
  *
  * Accepts any subset of the settable config fields
  * (moistureThresholdLow/High, wateringDurationS, minWateringIntervalS,
- * wateringEnabled, sensorReadIntervalMs, dataLogIntervalMs). Each PRESENT field
+ * wateringEnabled, sensorReadIntervalMs, dataLogIntervalMs, logPolicies). Each PRESENT field
  * is range-/type-checked against the IConfigStore constants. All-or-nothing: if
  * any present field is out of range or the wrong type, ok is false, error names
  * the field, and the returned request marks nothing to apply. Malformed JSON is
- * a rejection.
+ * a rejection. `logPolicies` maps known metric names to whole policies
+ * ({deadbandAbs, deadbandRel, heartbeatS}, all required; heartbeatS an
+ * integer, 0 or kLogHeartbeatMinS..kLogHeartbeatMaxS).
  */
-ConfigSetResult parseConfigSet(const std::string& body);
+ConfigSetResult parseConfigSet(std::string_view body);
+
+/// The IConfigStore::apply() patch of a validated request: the same set
+/// fields, log policies moved to their metric id's slot.
+ConfigPatch toConfigPatch(const ConfigSetRequest& request);
 
 /**
  * @brief Parse a POST pump-command body into a validated PumpCommand.
@@ -71,7 +88,18 @@ ConfigSetResult parseConfigSet(const std::string& body);
  * needs no duration. A bad action, an out-of-range/missing duration, a wrong
  * type or malformed JSON is a rejection with an explanatory error.
  */
-PumpCommandResult parsePumpCommand(const std::string& body);
+PumpCommandResult parsePumpCommand(std::string_view body);
+
+/**
+ * @brief Find @p key in a raw URL query string ("a=1&b=2"), without copying.
+ *
+ * Pairs are split on '&' and a key ends at its '='; the first pair whose key
+ * equals @p key wins and @p value views the rest of that pair (still
+ * percent-encoded, as httpd_query_key_value returns it). A pair without
+ * '=' never matches. False when the key is absent, @p value untouched.
+ */
+bool findQueryValue(std::string_view query, std::string_view key,
+                    std::string_view& value);
 
 /**
  * @brief Resolve a named history range into an absolute [t0, t1] epoch window.
@@ -89,7 +117,7 @@ PumpCommandResult parsePumpCommand(const std::string& body);
  * false (the handler then falls back to explicit start/end or the default 24 h
  * window). Pure and total: no throw, no allocation beyond the comparison.
  */
-bool namedRangeToWindow(const std::string& range, uint32_t now, uint32_t& t0,
+bool namedRangeToWindow(std::string_view range, uint32_t now, uint32_t& t0,
                         uint32_t& t1);
 
 /**
@@ -100,6 +128,102 @@ bool namedRangeToWindow(const std::string& range, uint32_t now, uint32_t& t0,
  */
 std::size_t resolveEventCount(std::optional<int> requested);
 
+/**
+ * @brief Parse a GET /api/v1/events `category` filter into a category mask.
+ *
+ * Comma-separated list of category names (pump, failsafe, connectivity, ota,
+ * reset — the serialized categoryName vocabulary) and/or raw ids 0..31, e.g.
+ * "failsafe,pump" or "1,4". On success writes the EventQuery::categoryMask
+ * bits to @p mask and returns true; an empty list, an empty item or an
+ * unknown name / id leaves @p mask untouched and returns false (400).
+ */
+bool parseEventCategories(std::string_view list, uint32_t& mask);
+
+/**
+ * @brief Parse a GET /api/v1/snapshot `fields` selector into section bits.
+ *
+ * Comma-separated section names — status, sensors, pumps, power — in any
+ * order, e.g. "sensors,pumps". On success writes the kSnapshot* bits to
+ * @p fields; an empty list, an empty item or an unknown name leaves
+ * @p fields untouched and returns false (400). A repeated name is allowed.
+ */
+bool parseSnapshotFields(std::string_view list, uint32_t& fields);
+
+/**
+ * @brief Parse a GET /api/v1/status `fields` projection.
+ *
+ * Comma-separated top-level member names — mode, wifi, time, uptimeMs,
+ * resetReason, firmware, storage, bootUs, power — each optionally narrowed
+ * to one key inside it as `member.key`, e.g. "wifi.rssi,mode". A member
+ * named both ways is kept whole. On success writes @p out; an empty list,
+ * an empty item or key, a nested path or an unknown member leaves @p out
+ * untouched and returns false (400). A key the member lacks is not an
+ * error: it just renders nothing.
+ */
+bool parseStatusFields(std::string_view list, FieldSelection& out);
+
+/**
+ * @brief parseStatusFields() for GET /api/v1/sensors: environmental, soil,
+ * soilProbes (with soilBus), level, power, timestamp.
+ */
+bool parseSensorsFields(std::string_view list, FieldSelection& out);
+
+/**
+ * @brief Render an EventCursor as the opaque `cursor` query value
+ *        ("<epoch>.<skip>") echoed as `next` in a paged events body.
+ */
+std::string formatEventCursor(const EventCursor& cursor);
+
+/**
+ * @brief Parse a `cursor` query value produced by formatEventCursor().
+ *
+ * Returns false (cursor untouched) for anything that is not two decimal
+ * uint32 fields joined by one '.'.
+ */
+bool parseEventCursor(std::string_view text, EventCursor& cursor);
+
+/**
+ * @brief Render a ReadingCursor as the /history `cursor` value echoed as
+ *        `next` in a paged series (same "<epoch>.<skip>" form as events).
+ */
+std::string formatReadingCursor(const ReadingCursor& cursor);
+
+/// Parse a /history `cursor` value; the same rules as parseEventCursor().
+bool parseReadingCursor(std::string_view text, ReadingCursor& cursor);
+
+/**
+ * @brief Per-metric marks of GET /api/v1/history/sync, indexed by the known
+ * MetricId (MetricRegistry.h): where the collector's copy of each metric
+ * ends, as a ReadingCursor. {0, 0} = nothing yet (sync from the oldest
+ * retained reading).
+ */
+using HistorySyncMarks = std::array<ReadingCursor, metric::kKnownCount>;
+
+/// Characters of every formatSyncToken() value.
+constexpr std::size_t kSyncTokenLen = ((1 + 6 * metric::kKnownCount) * 4 + 2) / 3;
+
+/**
+ * @brief Render @p marks as the opaque /history/sync `since` token.
+ *
+ * A version byte (1), then per known metric {uint32 epoch, uint16 skip}
+ * little-endian, base64url without padding: kSyncTokenLen characters
+ * whatever the marks, so it always fits a query value. A skip past 65535
+ * saturates — the collector then gets a few readings twice, never misses one.
+ */
+std::string formatSyncToken(const HistorySyncMarks& marks);
+
+/// Parse a formatSyncToken() value; false (marks untouched) for anything
+/// else, a different version included.
+bool parseSyncToken(std::string_view text, HistorySyncMarks& marks);
+
+/// Most readings one GET /api/v1/history/sync body carries: nothing is
+/// collected, so this bounds the storage reads per request, not the heap.
+constexpr std::size_t kHistorySyncMaxRecords = 8192;
+
+/// Resolve /history/sync `limit`: absent -> kHistorySyncMaxRecords,
+/// otherwise clamped to 1..kHistorySyncMaxRecords.
+std::size_t resolveHistorySyncLimit(std::optional<uint32_t> requested);
+
 /// Result of resolving a GET /api/v1/history time window.
 struct WindowResult {
     uint32_t t0 = 0;  ///< resolved window start (epoch), clamped to >= 0
@@ -120,6 +244,89 @@ WindowResult resolveWindow(std::optional<std::string> range,
                            std::optional<uint32_t> start,
                            std::optional<uint32_t> end, uint32_t now);
 
+/// Most metrics one GET /api/v1/history request may name (a whole panel).
+constexpr std::size_t kHistoryMaxMetrics = 8;
+
+/**
+ * @brief Split a /history `metric` value into the metric names it lists.
+ *
+ * One name, or up to kHistoryMaxMetrics comma-separated ones
+ * ("env_temperature,env_humidity"). False (400) with @p out untouched for
+ * an empty item, a repeated name or too many names.
+ */
+bool splitHistoryMetrics(const std::string& list, std::vector<std::string>& out);
+
+/// Point budget of one GET /api/v1/history series: above it the window is
+/// answered as per-bucket aggregates instead of raw readings.
+constexpr std::size_t kHistoryMaxPoints = 1000;
+/// Smallest `maxPoints` honoured: first, last and one LTTB pick.
+constexpr std::size_t kHistoryMinPoints = 3;
+
+/**
+ * @brief Resolve the effective /history point budget from `maxPoints`.
+ *
+ * Absent -> kHistoryMaxPoints; otherwise clamped to
+ * kHistoryMinPoints..kHistoryMaxPoints (a budget is a ceiling, so an
+ * oversized request simply gets the server's).
+ */
+std::size_t resolveHistoryMaxPoints(std::optional<uint32_t> requested);
+
+/**
+ * @brief Resolve the readings per page of a paged /history from `limit`
+ * (and the readings of a `last` query).
+ *
+ * Absent -> kHistoryMaxPoints; otherwise clamped to 1..kHistoryMaxPoints,
+ * the page being collected before it is sent.
+ */
+std::size_t resolveHistoryPageLimit(std::optional<uint32_t> requested);
+
+/**
+ * @brief Parse a /history `agg` value: "avg", "minmax" or "lttb".
+ *
+ * False (400) for anything else, @p out untouched.
+ */
+bool parseHistoryAggregate(std::string_view text, HistoryAggregate& out);
+
+/**
+ * @brief Pick the history resolution for a resolved window.
+ *
+ * Returns 0 (raw readings) when the window at @p logIntervalS — the data
+ * log cadence, i.e. the expected raw density — fits @p maxPoints; else
+ * the finest IDataStorage::kAggregateBucketsS width whose bucket count
+ * over [t0, t1] fits; else the coarsest width. Coarse tiers are cheap to
+ * read, so the choice only trades resolution for the point budget. Pure
+ * and total; a zero @p logIntervalS counts as 1 s.
+ */
+uint32_t selectHistoryBucket(uint32_t t0, uint32_t t1, uint32_t logIntervalS,
+                             std::size_t maxPoints);
+
+/**
+ * @brief Pick the GET /api/v1/history body format.
+ *
+ * An explicit `format` query value wins: "json" or "bin". Without one, an
+ * @p accept header naming application/octet-stream selects Binary; any
+ * other or no Accept header keeps Json. False (400) for any other
+ * `format` value — "cbor" included, there is no CBOR encoder in the tree.
+ */
+bool selectHistoryFormat(const std::optional<std::string>& format,
+                         const std::optional<std::string>& accept,
+                         HistoryFormat& out);
+
+/**
+ * @brief Re-insert the points a change-only log policy skipped.
+ *
+ * Under a MetricLogPolicy a metric is logged only on change or after
+ * @p heartbeatS, so a steady value leaves gaps a chart would interpolate
+ * across. Each gap no longer than the heartbeat (plus one interval) gets
+ * its earlier value held: in a raw series (bucketS 0) one point one
+ * @p logIntervalS before the next reading, in a bucketed series every
+ * empty bucket with value = min = max = the earlier mean. Longer gaps are
+ * real outages and stay gaps. Sets and returns series.filled. Pure; a zero
+ * @p logIntervalS counts as 1 s, a zero @p heartbeatS fills nothing.
+ */
+uint32_t stepFillHistory(HistorySeries& series, uint32_t logIntervalS,
+                         uint32_t heartbeatS);
+
 }  // namespace api
 
 #endif /* WATERINGSYSTEM_API_APIREQUESTS_H */
@@ -4,13 +4,21 @@
  * @file ApiRoutes.h
  * @brief Pure /api/v1/ route table + matcher (host+target).
  *
- * The route table is plain data (path, method, handler id). The target
- * ApiServer registers its OWN httpd_uri_t[] (in ApiServer.cpp); this table and
- * its `matchRoute` matcher are host-test / documentation artifacts, kept in
- * lockstep with that registration and with `docs/api/openapi.yaml` BY HAND.
- * `matchRoute` is a small pure matcher (exact match, plus a prefix rule for the
- * per-pump command route) so routing is host-testable with NO esp_http_server
- * dependency; the host route test asserts `matchRoute`, not the YAML.
+ * The route table is plain data (path, method, handler id) and the single
+ * source of the /api/v1/ surface: the target ApiServer registers one httpd
+ * handler per method for the `/api/v1/` prefix and dispatches on `matchRoute`'s
+ * HandlerId, so adding an endpoint costs a table row and a handler, never an
+ * httpd handler slot (the websocket stream keeps a registration of its own:
+ * httpd upgrades it before any handler runs). The table is kept in lockstep with
+ * `docs/api/openapi.yaml` BY HAND; the host route test asserts `matchRoute`,
+ * not the YAML.
+ *
+ * `matchRoute` is a perfect hash over (method, path), built at compile time
+ * from the constexpr table (a seed under which every exact route lands in its
+ * own slot; a duplicate route fails the build), then one string compare: the
+ * cost is the path's length, not the route count, and nothing is allocated.
+ * The per-pump command and usage routes are prefix rules, checked after the
+ * hash.
  *
  * Contract: contracts/api-envelope-and-routes.md; data-model.md §Route table.
  */
@@ -19,6 +27,7 @@
 #define WATERINGSYSTEM_API_APIROUTES_H
 
 #include <cstddef>
+#include <string_view>
 
 namespace api {
 
@@ -38,14 +47,32 @@ enum class HandlerId {
     Status,      ///< GET  /api/v1/status
     Sensors,     ///< GET  /api/v1/sensors
     History,     ///< GET  /api/v1/history
+    HistoryStats,///< GET  /api/v1/history/stats
+    HistorySync, ///< GET  /api/v1/history/sync (binary, incremental)
     PumpsList,   ///< GET  /api/v1/pumps
     PumpCmd,     ///< POST /api/v1/pumps/{name}
+    PumpUsage,   ///< GET  /api/v1/pumps/{name}/usage
     ConfigGet,   ///< GET  /api/v1/config
     ConfigSet,   ///< POST /api/v1/config
     Power,       ///< GET  /api/v1/power (rev2)
+    PowerCapture,///< GET  /api/v1/power/capture (rev2, binary)
     Events,      ///< GET  /api/v1/events
+    Stream,      ///< GET  /api/v1/stream (WebSocket upgrade)
     SelfTest,    ///< POST /api/v1/selftest
-    OtaStub,     ///< POST /api/v1/ota (contract stub, PR-13)
+    Ota,         ///< POST /api/v1/ota (streamed firmware image)
+    Metrics,     ///< GET  /api/v1/metrics (Prometheus text)
+    Snapshot,    ///< GET  /api/v1/snapshot (status+sensors+pumps+power)
+    ControlTrace,///< GET  /api/v1/control/trace (decision records)
+    Trace,       ///< GET  /api/v1/trace (system trace, binary)
+    Nodes,       ///< GET  /api/v1/nodes (ESP-NOW gateway leaf table)
+    Logs,        ///< GET  /api/v1/logs (newest log lines)
+    EventsSummary,///< GET /api/v1/events/summary (hourly counts)
+    ModbusCapture,///< GET /api/v1/modbus/capture (RS485 frames, binary)
+    Backup,      ///< GET  /api/v1/backup (storage archive, binary)
+    Restore,     ///< POST /api/v1/restore (storage archive upload)
+    Recording,   ///< GET  /api/v1/recording (watering inputs, binary)
+    SupportBundle,///< GET /api/v1/support-bundle (diagnostics, gzip)
+    ExportCsv,   ///< GET  /api/v1/export.csv (history spreadsheet)
     NotFound     ///< sentinel: unknown /api/<path> route
 };
 
@@ -65,6 +92,10 @@ struct ApiRoute {
  */
 extern const char kPumpCommandPrefix[];
 
+/// The `/usage` suffix of the PumpUsage route (kPumpCommandPrefix, a
+/// non-empty name without '/', then this).
+extern const char kPumpUsageSuffix[];
+
 /// Pointer to the first element of the static route table.
 const ApiRoute* apiRoutes();
 
@@ -76,10 +107,23 @@ std::size_t apiRouteCount();
  *
  * Exact match against the route table for every route except PumpCmd, which
  * matches when @p path begins with `/api/v1/pumps/` and a non-empty name
- * follows. Any other `/api/<path>` path (or a null path) returns HandlerId::NotFound.
+ * follows, and PumpUsage, a GET of such a path whose name has no '/' and is
+ * followed by `/usage`. Any other `/api/<path>` path (or a null path) returns
+ * HandlerId::NotFound. @p path has no query string (cut it at the '?').
  */
+HandlerId matchRoute(HttpMethod method, std::string_view path);
+
+/// As above for a NUL-terminated path; null is NotFound.
 HandlerId matchRoute(HttpMethod method, const char* path);
 
+/**
+ * @brief Does any method have a route at @p path?
+ *
+ * Tells a method mismatch (405) from an unknown path (404) once matchRoute()
+ * has returned NotFound for the request's own method.
+ */
+bool routePathKnown(std::string_view path);
+
 }  // namespace api
 
 #endif /* WATERINGSYSTEM_API_APIROUTES_H */
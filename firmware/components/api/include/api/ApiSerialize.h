@@ -18,6 +18,9 @@
  *     bogus value.
  *   - Non-finite floats (NaN/Inf — e.g. a last-good placeholder before the
  *     first read) are emitted as JSON `null`, never a misleading 0.
+ *   - Readings go out with a set number of decimals per quantity (the
+ *     `decimals` table below), so a float's binary tail never does:
+ *     23.4f is `23.4`, not `23.399999618530273`.
  *   - NPK channels are emitted only when their `has*` flag is set (the sensor
  *     reports them only when non-negative).
  *   - The wifi password is never represented in any DTO or serialized field.
@@ -26,32 +29,72 @@
 #ifndef WATERINGSYSTEM_API_APISERIALIZE_H
 #define WATERINGSYSTEM_API_APISERIALIZE_H
 
+#include <cstddef>
+#include <optional>
 #include <string>
+#include <string_view>
 #include <vector>
 
 #include "api/ApiDtos.h"
+#include "api/OtaPipeline.h"
+#include "api/StorageArchive.h"
 
 namespace api {
 
+/// Fraction digits per quantity: about what the sensor resolves. Shared by
+/// the cJSON serializers, the fixed-buffer shapes and the streamed bodies,
+/// which keeps them byte-identical.
+namespace decimals {
+constexpr int kTemperature = 1;  ///< degrees Celsius
+constexpr int kHumidity = 1;     ///< %RH
+constexpr int kPressure = 2;     ///< hPa
+constexpr int kMoisture = 1;     ///< %
+constexpr int kPh = 2;
+constexpr int kEc = 0;           ///< the probe reports whole units
+constexpr int kNutrient = 0;     ///< N/P/K, whole mg/kg
+constexpr int kBusVoltage = 3;   ///< volts (INA226 LSB 1.25 mV)
+constexpr int kCurrent = 3;      ///< amps
+constexpr int kPower = 3;        ///< watts
+constexpr int kEnergy = 4;       ///< watt-hours
+constexpr int kShortest = -1;    ///< unknown quantity: cJSON's full form
+}  // namespace decimals
+
+/// Decimals of @p metric's values (the known metric table); kShortest for
+/// a metric outside it.
+int metricDecimals(std::string_view metric);
+
 /**
  * @brief Serialize a SystemStatusDto to the GET /api/v1/status success body.
  *
  * Emits `mode`, `wifi`, `time`, `uptimeMs`, `resetReason`, `firmware`,
  * `storage`, and `power` (the power object on rev2 when `hasPower`, otherwise
- * JSON null). Key order is deterministic.
+ * JSON null). Key order is deterministic. Only the members in
+ * `status.fields` are emitted.
  */
 std::string serializeStatus(const SystemStatusDto& status);
 
+/**
+ * @brief serializeStatus() cut down to a `fields` projection: each member
+ * @p keys names keeps only the keys named for it (in an array, inside
+ * each element). The members themselves come from `status.fields`.
+ */
+std::string serializeStatus(const SystemStatusDto& status, const std::vector<FieldKey>& keys);
+
 /**
  * @brief Serialize a SensorReadingsDto to the GET /api/v1/sensors success body.
  *
  * Emits `environmental`, `soil` (NPK channels only when their has-flag is set),
  * `level` (two independent marks), `power` (rev2 object when `hasPower`, else
  * JSON null), and a top-level `timestamp` (JSON null when the clock is not set,
- * so no bogus 1970 epoch). Key order is deterministic.
+ * so no bogus 1970 epoch). Key order is deterministic. Only the members in
+ * `sensors.fields` are emitted.
  */
 std::string serializeSensors(const SensorReadingsDto& sensors);
 
+/// serializeStatus(status, keys) for a sensors body.
+std::string serializeSensors(const SensorReadingsDto& sensors,
+                             const std::vector<FieldKey>& keys);
+
 /**
  * @brief Serialize a PowerDto to the GET /api/v1/power success body (rev2).
  *
@@ -86,6 +129,16 @@ std::string serializePump(const PumpDto& pump);
  */
 std::string serializePumpList(const std::vector<PumpDto>& pumps);
 
+/**
+ * @brief Serialize one pump's usage to the GET pumps/{name}/usage success
+ * body.
+ *
+ * Emits `{ success, name, timed, untimedRuns, hours:[ { start, runMs,
+ * starts }, ... ], days:[ ... ] }`, oldest bucket first; both lists are
+ * empty while the wall clock is not set.
+ */
+std::string serializePumpUsage(const PumpUsageDto& usage);
+
 /**
  * @brief Serialize a ConfigDto to the GET config success body.
  *
@@ -107,15 +160,91 @@ std::string serializeConfig(const ConfigDto& config);
  */
 std::string serializeHistory(const HistorySeries& series);
 
+/**
+ * @brief Serialize a HistoryStatsDto to the GET history/stats success body.
+ *
+ * Emits `{ success, count, min, max, mean, last, lastTimestamp, metric,
+ * reading, start, end }`. With `count: 0` the five value keys are JSON null
+ * (an empty window is a success, like an empty series); `reading` echoes as
+ * in serializeHistory.
+ */
+std::string serializeHistoryStats(const HistoryStatsDto& stats);
+
 /**
  * @brief Serialize a list of EventDto to the GET events success body.
  *
  * Emits `{ success, events:[ { epoch, category, detail }, ... ] }`. Order is
  * preserved exactly as given (the caller supplies them newest-first from
- * IDataStorage::getEvents). `categoryName` is emitted only when the DTO carries
- * a known human name (optional set).
+ * IDataStorage::queryEvents). `categoryName` is emitted only when the DTO
+ * carries a known human name (optional set). `next` — the cursor of the
+ * following page — is emitted only when @p next is set (more events match).
  */
-std::string serializeEvents(const std::vector<EventDto>& events);
+std::string serializeEvents(const std::vector<EventDto>& events,
+                            const std::optional<std::string>& next = std::nullopt);
+
+/**
+ * @brief Serialize the events past a tail cursor (api/EventTail.h) to the
+ * GET events?after= success body.
+ *
+ * Emits `{ success, events, tail, truncated }`: `events` as in
+ * serializeEvents() (newest-first, possibly empty), `tail` the cursor of
+ * the next call, `truncated` true when older new events were left out.
+ */
+std::string serializeEventTail(const std::vector<EventDto>& events,
+                               const std::string& tail, bool truncated);
+
+/**
+ * @brief Serialize the hourly event counts to the GET events/summary success
+ * body.
+ *
+ * Emits `{ success, hours, since, categories:[ { category, categoryName?,
+ * count }, ... ] }`; `categoryName` as in serializeEvents().
+ */
+std::string serializeEventSummary(const EventSummaryDto& summary);
+
+/**
+ * @brief Serialize a SnapshotDto to the GET snapshot success body.
+ *
+ * Emits `{ success, status, sensors, pumps, power }` with only the sections
+ * in `fields`, in that order: `status` and `sensors` are the bodies of
+ * their own endpoints minus `success`, `pumps` the list array, `power` the
+ * telemetry object (JSON null on rev1, as inside /status).
+ */
+std::string serializeSnapshot(const SnapshotDto& snapshot);
+
+/**
+ * @brief Serialize the gateway's leaf table to the GET nodes success body.
+ *
+ * Emits `{ success, nodes:[ { node, lastSeenS, rssi, reports, duplicates,
+ * missed, sensors, pumps }, ... ] }` in the given order; `sensors` is the
+ * /sensors body minus `success`, `pumps` the /pumps array.
+ */
+std::string serializeNodes(const std::vector<NodeDto>& nodes);
+
+/**
+ * @brief Serialize the log tail to the GET logs success body.
+ *
+ * Emits `{ success, dropped, lines:[ "...", ... ] }`, oldest line first.
+ */
+std::string serializeLogs(const LogsDto& logs);
+
+/**
+ * @brief Serialize a committed upload to the POST ota success body.
+ *
+ * Emits `{ success, bytes, transferBytes, delta, sha256, elapsedMs,
+ * rebooting:true }`; `bytes` is the image as written, `transferBytes` the
+ * body that carried it (smaller for a delta patch), `sha256` the
+ * lowercase hex digest of the image.
+ */
+std::string serializeOtaReport(const OtaReport& report);
+
+/**
+ * @brief Serialize a swapped-in restore to the POST restore success body.
+ *
+ * Emits `{ success, files, bytes, configApplied }`; `configApplied` is
+ * false when the archive had no config or the config was rejected.
+ */
+std::string serializeRestoreReport(const RestoreReport& report, bool configApplied);
 
 /**
  * @brief Serialize a SelfTestResultDto to the POST selftest success body.
@@ -124,6 +253,62 @@ std::string serializeEvents(const std::vector<EventDto>& events);
  */
 std::string serializeSelfTest(const SelfTestResultDto& result);
 
+/**
+ * @brief Map a stored event category id to its stable lowercase name, or
+ * nullptr for an unknown category (the DTO then omits `categoryName`).
+ *
+ * Mirrors the IDataStorage category constants (same vocabulary as the event
+ * logger).
+ */
+const char* eventCategoryName(int category);
+
+// ---------------------------------------------------------------------------
+// Fixed-buffer backend (api/JsonTemplate.h)
+// ---------------------------------------------------------------------------
+// The same bodies as serializeStatus / Sensors / Power / Pump / PumpList,
+// byte for byte, written into @p buf (@p cap bytes, no terminator) from a
+// compile-time field list instead of a cJSON tree: no heap at all. Each
+// returns the body length, or 0 when it does not fit — the caller then
+// falls back to the cJSON serializer.
+
+std::size_t serializeStatusInto(const SystemStatusDto& status, char* buf, std::size_t cap);
+std::size_t serializeSensorsInto(const SensorReadingsDto& sensors, char* buf,
+                                 std::size_t cap);
+std::size_t serializePowerInto(const PowerDto& power, char* buf, std::size_t cap);
+std::size_t serializePumpInto(const PumpDto& pump, char* buf, std::size_t cap);
+std::size_t serializePumpListInto(const std::vector<PumpDto>& pumps, char* buf,
+                                  std::size_t cap);
+
+// ---------------------------------------------------------------------------
+// Live stream messages (GET /api/v1/stream, api/LiveStream.h)
+// ---------------------------------------------------------------------------
+// One compact JSON object per WebSocket text frame, tagged by `type`. No
+// success envelope: a message is a delta, not a response.
+
+/// The sections a `sensors` stream message carries.
+struct SensorSections {
+    bool environmental = false;
+    bool soil = false;
+    bool level = false;
+    bool power = false;   ///< ignored unless the DTO `hasPower`
+};
+
+/**
+ * @brief `{ type:"sensors", [full:true,] [environmental], [soil], [level],
+ * [power], timestamp }` — only the selected sections, each shaped as in
+ * serializeSensors(). `full` marks a snapshot carrying every section (sent
+ * on join and after a client's queue overflowed). "" on OOM.
+ */
+std::string serializeStreamSensors(const SensorReadingsDto& sensors,
+                                   const SensorSections& sections, bool full);
+
+/// `{ type:"pump", name, running, currentRunTimeMs, accumulatedRunTimeMs,
+/// lastStopReason }`. "" on OOM.
+std::string serializeStreamPump(const PumpDto& pump);
+
+/// `{ type:"event", epoch, category, [categoryName], detail }`. "" on OOM.
+std::string serializeStreamEvent(const EventDto& event);
+
 }  // namespace api
 
 #endif /* WATERINGSYSTEM_API_APISERIALIZE_H */
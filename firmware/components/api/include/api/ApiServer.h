@@ -16,15 +16,36 @@
  *                          [+power on rev2])
  *   GET /api/v1/sensors  — cached environmental/soil/level [+power] readings
  *   GET /api/v1/power     — INA226 telemetry (rev2); not-available shape on rev1
+ *   GET /api/v1/power/capture — pump current samples, binary (ApiStream.h);
+ *                               404 without a capture
  *   GET  /api/v1/pumps        — every pump's status (capability-enumerated)
  *   POST /api/v1/pumps/{name} — start/run/stop a pump (cap+rules in the pump)
  *   GET  /api/v1/config       — current config (never the wifi password)
  *   POST /api/v1/config       — apply a validated config subset (persisted)
  *   GET  /api/v1/history      — bounded sensor-history series (query-windowed)
- *   GET  /api/v1/events       — newest-first event log (count-bounded)
- *   POST /api/v1/selftest     — bounded sensor/RS485 diagnostic (see below)
- *   POST /api/v1/ota          — contract stub, 501 until PR-13 implements it
- * Unknown routes answer the JSON 404 envelope.
+ *   GET  /api/v1/history/stats — count/min/max/mean/last/percentiles over
+ *                                the same window
+ *   GET  /api/v1/history/sync — every metric's readings past per-metric marks,
+ *                               binary and resumable (ApiStream.h)
+ *   GET  /api/v1/events       — newest-first event log (count-bounded,
+ *                               category/since/until filters, cursor); with
+ *                               `after` the events past a tail cursor, held
+ *                               up to `wait` s by the event-wait worker
+ *   GET  /api/v1/stream       — WebSocket: live sensor/pump/event deltas
+ *                               (api/LiveStream.h)
+ *   POST /api/v1/selftest     — bounded sensor/RS485 diagnostic, answered
+ *                               from the selftest worker (see below)
+ *   POST /api/v1/ota          — firmware image streamed into the inactive
+ *                               slot (api/OtaPipeline.h); 501 without one
+ *   GET  /api/v1/metrics      — Prometheus text: per-route counters and
+ *                               latency histograms, heap/task/storage gauges
+ *   GET  /api/v1/snapshot     — status+sensors+pumps+power in one body
+ *                               (`fields` selects sections)
+ * /status and /sensors take a `fields` projection too (`wifi.rssi,mode`):
+ * only the named members are read and rendered.
+ * Unknown routes answer the JSON 404 envelope. /sensors, /pumps and /config
+ * carry an ETag and answer a matching If-None-Match with a bodiless 304
+ * (api/ApiETag.h).
  *
  * PRIV rule (same as ProvisioningPortal / EspI2cBus): esp_http_server.h appears
  * ONLY in the .cpp; the server handle is held here as an opaque void* and the
@@ -42,11 +63,26 @@
 #ifndef WATERINGSYSTEM_API_APISERVER_H
 #define WATERINGSYSTEM_API_APISERVER_H
 
+#include <array>
+#include <atomic>
 #include <cstddef>
+#include <cstdint>
+#include <optional>
 #include <string>
+#include <string_view>
+#include <vector>
 
 #include "api/ApiDtos.h"
 #include "api/ApiEnvelope.h"
+#include "api/ApiMetrics.h"
+#include "api/ApiStream.h"
+#include "api/AssetStore.h"
+#include "api/DerivedMetrics.h"
+#include "api/LiveStream.h"
+#include "api/RateLimiter.h"
+#include "api/RequestArena.h"
+#include "api/ResponseCache.h"
+#include "api/SelfTestRunner.h"
 #include "board/board.h"
 #include "interfaces/IConfigStore.h"
 #include "interfaces/IDataStorage.h"
@@ -56,14 +92,55 @@
 #include "interfaces/ITimeProvider.h"
 #include "interfaces/IWallClock.h"
 #include "interfaces/IWaterPump.h"
+#include "interfaces/MetricRegistry.h"
 #if BOARD_HAS_INA226
 #include "interfaces/IPowerSensor.h"
 #endif
 #include "network/WifiManager.h"
 #include "time/SntpClient.h"
 
+class BlockRingFile;
+class DecisionTrace;
+class EventCounts;
+class EventNotifier;
+class InputRecorder;
+class IPowerLock;
+class EnergyMeter;
+class LogTail;
+class LifetimeCounters;
+class LockRegistry;
+class ModbusBusMaster;
+class ModbusFrameCapture;
+class PowerResidency;
+class PumpCurrentCapture;
+class PumpUsage;
+class BootProfile;
+class SoilPollScheduler;
+class TaskTelemetry;
+class WatchdogFeeds;
+class TickLatency;
+
 namespace api {
 
+class IStorageHold;
+class MqttUplink;
+class NodeGateway;
+class OtaPipeline;
+class ReadAheadPipe;
+
+/**
+ * @brief A GET /api/v1/events?after= read (api/EventTail.h) and, while it
+ * is held for new events, its detached request and deadline.
+ */
+struct EventWait {
+    void* asyncReq = nullptr;  ///< opaque httpd_req_t* copy; null: not held
+    EventCursor after;
+    uint32_t categoryMask = EventQuery::kAllCategories;
+    uint32_t count = 0;
+    uint32_t generation = 0;   ///< EventNotifier::generation() before the last read
+    int64_t deadlineUs = 0;    ///< esp_timer time it is answered, new events or not
+};
+
 /**
  * @brief A ready-to-send response: an HTTP status line plus a JSON body.
  *
@@ -91,6 +168,11 @@ struct ApiResponse {
  */
 class ApiServer {
 public:
+    /// Oldest cached /status body served (uptime and clock as of the build).
+    static constexpr uint32_t kStatusMaxAgeMs = 1000;
+    /// Oldest cached /sensors body served; well under any sensor cadence.
+    static constexpr uint32_t kSensorsMaxAgeMs = 1000;
+
     /**
      * @brief Inject the Locked* read decorators + status sources.
      *
@@ -109,8 +191,8 @@ public:
      * @param levelLow    Reservoir low-mark level sensor (cached, 10 Hz loop).
      * @param levelHigh   Reservoir high-mark level sensor (cached, 10 Hz loop).
      * @param wifi        WifiManager, read via its by-value snapshot()
-     *                    (state/rssi/ip-acquired); an unsynchronized single-
-     *                    writer read, acceptable for status display (WifiState.h).
+     *                    (state/rssi/ip-acquired); a lock-free SnapshotPublisher
+     *                    load, consistent and up to one tick old (WifiState.h).
      * @param wallClock   Wall clock (epoch + is-set) for time + timestamps.
      * @param sntp        SNTP client (last-sync epoch); status only.
      * @param uptime      Monotonic clock for uptimeMs.
@@ -151,6 +233,8 @@ public:
           power_(power)
 #endif
     {
+        cache_.setMaxAge(ResponseCache::Slot::Status, kStatusMaxAgeMs);
+        cache_.setMaxAge(ResponseCache::Slot::Sensors, kSensorsMaxAgeMs);
     }
 
     ~ApiServer();
@@ -163,7 +247,9 @@ public:
      *
      * Idempotent (an already-started server is a successful no-op) and non-fatal
      * on failure: the caller logs and keeps running — the watering path never
-     * depends on the API (FR-015).
+     * depends on the API (FR-015). The sessions, backlog, stack, timeouts
+     * and idle purge come from IConfigStore::getHttpdSettings() when set
+     * (api/HttpdPresets.h), the build's defaults otherwise.
      *
      * @return true when the server is running (started or already up); false on
      *         a server-start / route-registration failure.
@@ -173,6 +259,259 @@ public:
     /// Stop the HTTP server. Idempotent.
     void stop();
 
+    /**
+     * @brief Limit each client address to @p perSecond requests a second,
+     * in bursts of up to @p burst (api/RateLimiter.h); 0 turns it off.
+     *
+     * Call before start(); app_main passes CONFIG_WS_API_RATE_LIMIT_*. An
+     * over-limit request is answered with a fixed 429 body before its
+     * handler runs. The live stream's frames are exempt once connected.
+     */
+    void setRateLimit(uint32_t perSecond, uint32_t burst);
+
+    /**
+     * @brief Serve the frontend from @p assets (api/AssetStore.h).
+     *
+     * Call before start(); @p assets must outlive the server. app_main
+     * shares one store with the provisioning portal's pages. Without it
+     * every static GET answers 404.
+     */
+    void setAssets(AssetStore& assets);
+
+    /**
+     * @brief Report every probe of a multi-drop soil segment in /sensors
+     * (`soilProbes`, primary first) with the poll rounds' bus usage
+     * (`soilBus`). Ignored while it holds a single probe; call before
+     * start(). @p probes must outlive the server.
+     */
+    void setSoilProbes(const SoilPollScheduler& probes);
+
+    /// Zone pumps beyond the plant pump (one soil probe per zone).
+    static constexpr std::size_t kMaxZonePumps = metric::kSoilProbes - 1;
+
+    /**
+     * @brief Serve a further watering zone's pump (board.h kBoardZones) in
+     * /pumps and at /pumps/{name}, under its getName(). Pass its
+     * LockedWaterPump wrapper. Call before start(); false once
+     * kMaxZonePumps are in. @p pump must outlive the server.
+     */
+    bool addZonePump(IWaterPump& pump);
+
+    /**
+     * @brief Export the RS485 bus statistics in /metrics: per slave and
+     * function, outcome counts and a transfer-time histogram, plus the bus
+     * busy time. Call before start(); @p bus must outlive the server.
+     */
+    void setModbusBus(const ModbusBusMaster& bus);
+
+    /**
+     * @brief Serve @p capture's sample ring at /api/v1/power/capture (each
+     * request drains what it sends). Call before start(); @p capture must
+     * outlive the server. Without it the route answers 404.
+     */
+    void setPowerCapture(PumpCurrentCapture& capture);
+
+    /// The capture set by setPowerCapture(), or nullptr.
+    PumpCurrentCapture* powerCapture() { return powerCapture_; }
+
+    /**
+     * @brief Report @p meter's totals as the `energy` object of GET
+     * /api/v1/power. Call before start(); @p meter must outlive the server.
+     * Without it the body has no `energy`.
+     */
+    void setEnergyMeter(const EnergyMeter& meter);
+
+    /**
+     * @brief Serve @p trace's decision records at /api/v1/control/trace.
+     * Call before start(); @p trace must outlive the server. Without it the
+     * route answers 404.
+     */
+    void setDecisionTrace(const DecisionTrace& trace);
+
+    /// The trace set by setDecisionTrace(), or nullptr.
+    const DecisionTrace* decisionTrace() const { return decisionTrace_; }
+
+    /**
+     * @brief Run the httpd task at @p priority on @p core (-1: either
+     * core) instead of the IDF defaults. Call before start().
+     */
+    void setHttpdPlacement(unsigned priority, int core);
+
+    /**
+     * @brief Export @p telemetry's per-task CPU share and stack margin and
+     * the heap per capability in /api/v1/metrics. Call before start();
+     * @p telemetry must outlive the server. Without it they are left out.
+     */
+    void setTaskTelemetry(const TaskTelemetry& telemetry);
+
+    /**
+     * @brief Export the contention counters of @p locks' decorator mutexes
+     * in /api/v1/metrics. Call before start(); @p locks must outlive the
+     * server. Without it (or with it empty) they are left out.
+     */
+    void setLockRegistry(const LockRegistry& locks);
+
+    /**
+     * @brief Report @p profile's boot-phase marks as `bootUs` in
+     * /api/v1/status. Call before start(); @p profile must outlive the
+     * server. Without it `bootUs` is null.
+     */
+    void setBootProfile(const BootProfile& profile);
+
+    /**
+     * @brief Export @p feeds' per-task watchdog feed-interval histograms in
+     * /api/v1/metrics. Call before start(); @p feeds must outlive the
+     * server. Without it they are left out.
+     */
+    void setWatchdogFeeds(const WatchdogFeeds& feeds);
+
+    /**
+     * @brief Export @p latency's watering-tick durations, whole and per
+     * phase, in /api/v1/metrics. Call before start(); @p latency must
+     * outlive the server. Without it they are left out.
+     */
+    void setTickLatency(const TickLatency& latency);
+
+    /**
+     * @brief Export @p counters' totals across resets in /api/v1/metrics.
+     * Call before start(); @p counters must outlive the server. Without it
+     * they are left out.
+     */
+    void setLifetimeCounters(const LifetimeCounters& counters);
+
+    /**
+     * @brief Hold @p lock (CpuMax, interfaces/PowerLocks.h) across every
+     * request's handler, and export @p residency's time per power state in
+     * /api/v1/metrics. Call before start(); both must outlive the server.
+     * Without it (CONFIG_WS_POWER_MANAGEMENT off) requests take no lock and
+     * the residency is left out.
+     */
+    void setPowerManagement(IPowerLock& lock, const PowerResidency& residency);
+
+    /**
+     * @brief Export @p uplink's broker session state and counters in
+     * /api/v1/metrics. Call before start(); @p uplink must outlive the
+     * server. Without it (CONFIG_WS_MQTT off) they are left out.
+     */
+    void setMqttUplink(const MqttUplink& uplink);
+
+    /**
+     * @brief Answer for @p gateway's leaves: GET /api/v1/nodes and
+     * /api/v1/history?node=. Call before start(); @p gateway must outlive
+     * the server. Without it (not the gateway role) both answer 404.
+     */
+    void setNodeGateway(const NodeGateway& gateway);
+
+    /**
+     * @brief Answer GET /api/v1/pumps/{name}/usage from @p usage's hourly
+     * and daily buckets. Call before start(); @p usage must outlive the
+     * server. Without it the route answers 404.
+     */
+    void setPumpUsage(PumpUsage& usage);
+
+    /**
+     * @brief Serve @p tail's lines at GET /api/v1/logs. Call before
+     * start(); @p tail must outlive the server. Without it (CONFIG_WS_LOG_SINK
+     * off) the route answers 404.
+     */
+    void setLogTail(const LogTail& tail);
+
+    /**
+     * @brief Serve @p counts at GET /api/v1/events/summary (the event
+     * logger's hourly buckets). Call before start(); @p counts must outlive
+     * the server. Without it the route answers 404.
+     */
+    void setEventCounts(const EventCounts& counts);
+
+    /**
+     * @brief Hold GET /api/v1/events?after=&wait= requests until @p notifier
+     * signals a new event (the EventLogger's), each for up to @p maxWaitS
+     * seconds (a longer `wait` is clamped). Call before start(); @p notifier
+     * must outlive the server. Without it `wait` is ignored and a tail read
+     * answers at once.
+     */
+    void setEventWait(EventNotifier& notifier, uint32_t maxWaitS);
+
+    /// Longest `wait` honoured, seconds; 0 without setEventWait().
+    uint32_t eventWaitMaxS() const { return eventNotifier_ != nullptr ? eventWaitMaxS_ : 0; }
+
+    /// The notifier's generation (0 without setEventWait()); noted before a
+    /// tail read.
+    uint32_t eventGeneration() const;
+
+    /**
+     * @brief Serve @p capture's RS485 frames at GET /api/v1/modbus/capture.
+     * Call before start(); @p capture must outlive the server. Without it
+     * (the esp-modbus client) the route answers 404.
+     */
+    void setModbusCapture(const ModbusFrameCapture& capture);
+
+    /// The capture set by setModbusCapture(), or nullptr.
+    const ModbusFrameCapture* modbusCapture() const { return modbusCapture_; }
+
+    /**
+     * @brief Serve the watering input recording at GET /api/v1/recording:
+     * @p file's blocks (null: RAM only), then @p recorder's. Call before
+     * start(); both must outlive the server. Without it the route answers
+     * 404.
+     */
+    void setInputRecording(const InputRecorder& recorder, const BlockRingFile* file);
+
+    /// The recorder set by setInputRecording(), or nullptr.
+    const InputRecorder* inputRecorder() const { return inputRecorder_; }
+    const BlockRingFile* recordingFile() const { return recordingFile_; }
+
+    /**
+     * @brief Accept firmware images at POST /api/v1/ota through @p ota.
+     * Call before start(); @p ota must outlive the server. Without it
+     * (CONFIG_WS_OTA off) the route answers 501.
+     */
+    void setOtaPipeline(OtaPipeline& ota);
+
+    /// The pipeline set by setOtaPipeline(), or nullptr.
+    OtaPipeline* otaPipeline() { return ota_; }
+
+    /**
+     * @brief Stream large static assets through @p pipe, the flash reads
+     * overlapping the sends. Call before start(); @p pipe must outlive the
+     * server. Without it each chunk is read, then sent, on the httpd task.
+     */
+    void setReadAhead(ReadAheadPipe& pipe);
+
+    /// The pipe set by setReadAhead(), or nullptr.
+    ReadAheadPipe* readAhead() { return readAhead_; }
+
+    /**
+     * @brief Serve GET /api/v1/backup and POST /api/v1/restore: the data
+     * store under @p basePath as one archive (api/StorageArchive.h), each
+     * run inside @p hold. Call before start(); @p hold must outlive the
+     * server. Without it (the ring-log backend) both routes answer 501.
+     */
+    void setStorageArchive(IStorageHold& hold, std::string basePath);
+
+    /// The hold set by setStorageArchive(), or nullptr.
+    IStorageHold* storageHold() { return archiveHold_; }
+
+    /// The store's base path set by setStorageArchive().
+    const std::string& archiveBasePath() const { return archiveBase_; }
+
+    /**
+     * @brief Serve HTTPS on port 443 instead of HTTP on 80, with @p certPem
+     * and @p keyPem (PEM text; an ECDSA P-256 key, the only kind the offered
+     * ECDHE-ECDSA suites sign with). Up to @p maxSessions TLS sessions stay
+     * open between requests; a returning client that lost its session
+     * resumes from a ticket without the key exchange. Call before start().
+     * Without it (CONFIG_WS_HTTPS off, or no credentials on the storage) the
+     * server speaks plain HTTP; ignored in a build without the HTTPS server.
+     */
+    void setTls(std::string certPem, std::string keyPem, unsigned maxSessions);
+
+    /// The HTTPS handshake counters; the httpd task's TLS hooks feed them.
+    TlsMetrics& tlsMetrics() { return tls_; }
+
+    /// The per-session utilization; the httpd task's session hooks feed it.
+    SocketMetrics& socketMetrics() { return sockets_; }
+
     // -- Response builders invoked by the file-local HTTP handlers (.cpp) -----
     // Public so the anonymous-namespace httpd handlers (which recover the
     // instance from req->user_ctx) can call them without exposing httpd types
@@ -183,19 +522,51 @@ public:
     /// Build the GET /api/v1/status success body.
     std::string buildStatusBody();
 
-    /// Build the GET /api/v1/sensors success body.
-    std::string buildSensorsBody();
+    /// buildStatusBody() through the response cache (ResponseCache.h): at
+    /// most one build per config generation and kStatusMaxAgeMs.
+    std::string statusBody();
+
+    /// A GET /api/v1/status `fields` projection: reads only the members
+    /// @p selection names, uncached.
+    std::string statusBody(const FieldSelection& selection);
+
+    /// Read the GET /api/v1/sensors readings (the handler serializes them).
+    SensorReadingsDto readSensors();
+
+    /// Weak ETag of @p readings (see api/ApiETag.h).
+    std::string sensorsETag(const SensorReadingsDto& readings) const;
+
+    /// The cached /sensors body and ETag, if younger than kSensorsMaxAgeMs.
+    bool cachedSensors(std::string& body, std::string& etag) const;
+
+    /// Cache a freshly serialized /sensors body with its ETag.
+    void cacheSensors(const std::string& body, const std::string& etag);
+
+    /// statusBody(selection) for GET /api/v1/sensors (no ETag).
+    std::string sensorsBody(const FieldSelection& selection);
 
     /// Build the GET /api/v1/power body (telemetry on rev2, not-available on rev1).
     std::string buildPowerBody();
 
     /**
-     * @brief Build the GET /api/v1/pumps success body (list of every pump).
+     * @brief Read the GET /api/v1/pumps list (every pump's status).
      *
      * Capability-enumerated (rev1 plant+reservoir, rev2 plant only,
      * BOARD_HAS_RESERVOIR_PUMP) from the pumps' non-blocking status getters.
      */
-    std::string buildPumpsBody();
+    std::vector<PumpDto> readPumps();
+
+    /// ETag of a readPumps() result.
+    std::string pumpsETag(const std::vector<PumpDto>& pumps) const;
+
+    /**
+     * @brief Read a GET /api/v1/snapshot body's sections (kSnapshot* bits).
+     *
+     * The /status, /sensors, /pumps and /power DTOs of one dashboard refresh
+     * from a single pass over the same cached getters, the power telemetry
+     * read once for every section that carries it.
+     */
+    SnapshotDto readSnapshot(uint32_t fields);
 
     /**
      * @brief Apply a POST /api/v1/pumps/{name} command and report the outcome.
@@ -210,12 +581,28 @@ public:
      * The server makes NO watering decision: the duration cap and the
      * no-restart rule live entirely in the pump's own runFor()/stop().
      */
-    ApiResponse applyPumpCommand(const std::string& name,
-                                 const std::string& body);
+    ApiResponse applyPumpCommand(const std::string& name, std::string_view body);
+
+    /**
+     * @brief Build the GET /api/v1/pumps/{name}/usage response: @p name's
+     * hourly and daily runtime and starts (PumpUsage::report), a fixed-size
+     * copy whatever the history holds. 404 for a pump usage does not watch
+     * or without setPumpUsage().
+     */
+    ApiResponse buildPumpUsageResponse(std::string_view name);
 
     /// Build the GET /api/v1/config success body (never the wifi password).
     std::string buildConfigBody();
 
+    /// buildConfigBody() through the response cache: rebuilt only when the
+    /// config generation moves.
+    std::string configBody();
+
+    /// ETag of the current config, from its generation (no config read).
+    /// Taken BEFORE the body is built, so a racing write can only make the
+    /// tag older than the body — the next poll then misses, never hits stale.
+    std::string configETag() const;
+
     /**
      * @brief Apply a POST /api/v1/config set request and report the outcome.
      *
@@ -227,32 +614,154 @@ public:
      *         malformed/out-of-range body; a 500 error envelope if a setter
      *         unexpectedly fails to persist an already-validated value.
      */
-    ApiResponse applyConfigSet(const std::string& body);
+    ApiResponse applyConfigSet(std::string_view body);
 
     /**
-     * @brief Resolve a GET /api/v1/history query and build the response.
+     * @brief Resolve a GET /api/v1/history query and stream the body.
      *
-     * @param query  the parsed query (metric [required], optional reading, and
-     *               either a named range or explicit start/end epochs). The
-     *               file-local handler extracts these from the URL query string.
-     * @return the history series (200) on success; a 400 error envelope when the
-     *         metric is missing or a named range is unknown. An in-range window
-     *         with no stored data is a success with empty arrays, not an error.
+     * @param query  the parsed query (metric [required; a comma list of up to
+     *               kHistoryMaxMetrics names answers `{success, series:[...]}`
+     *               with one single-metric body per name, JSON only], optional
+     *               reading, and either a named range or explicit start/end
+     *               epochs). The file-local handler extracts these from the URL
+     *               query string.
+     * @param sink   receives the 200 body (ApiStream.h) as it is produced
+     * @return {Ok, ""} once the series is streamed; a 400 error envelope, with
+     *         nothing sent, when the metric is missing, the metric list is
+     *         malformed (or asks format=bin), a paged query names several
+     *         metrics, asks format=bin or has a bad cursor, or a named range
+     *         is unknown; a 500 envelope when the stream broke (the sink failed
+     *         or the readings changed between passes) — if part of the body
+     *         already went out, the handler aborts the response instead. An
+     *         in-range window with no stored data is a success with empty
+     *         arrays, not an error.
      *
      * Resolves the window from `range` (via namedRangeToWindow against the wall
-     * clock), else from explicit start/end, else the last 24 h, then reads it
-     * with IDataStorage::getSensorReadings — a NON-BLOCKING filesystem read, no
+     * clock), else from explicit start/end, else the last 24 h, then streams it
+     * from IDataStorage::forEachReading (streamRawHistory: no reading is
+     * collected) — or, when the window exceeds the point budget (`maxPoints`,
+     * resolveHistoryMaxPoints) at the data-log interval, from
+     * getSensorAggregates at the width selectHistoryBucket picks, or for
+     * agg=minmax/lttb from downsampleHistory (streamHistory). With `limit`
+     * or `cursor` the window is paged instead: stored readings verbatim,
+     * resumed from the cursor epoch (streamHistoryPage). With `last` the
+     * window is dropped: the metric's newest `last` readings (clamped as
+     * `limit`), raw, from IDataStorage::getLatestReadings, `start`/`end`
+     * echoing the first and last of them; one metric, and any window,
+     * paging or `node` parameter is a 400. With `node` the
+     * series is a leaf's raw readings from the gateway's RAM table
+     * (NodeGateway::history): one metric, no pages; 404 for a node not in
+     * the table or without a gateway. A NON-BLOCKING filesystem read, no
      * bus access.
      */
-    ApiResponse buildHistoryResponse(const HistoryQuery& query);
+    ApiResponse streamHistoryResponse(const HistoryQuery& query, IChunkSink& sink);
+
+    /**
+     * @brief Resolve a GET /api/v1/history/stats query and build the response.
+     *
+     * Same query, window resolution and 400 cases as streamHistoryResponse,
+     * but answers only count/min/max/mean/last — one
+     * IDataStorage::getSensorWindowStats pass, no series materialized, so
+     * "mean over the last 24 h" is a body of a few dozen bytes — plus
+     * p5/p50/p95 estimated from IDataStorage::getSensorQuantiles. An empty
+     * window is a success with `count: 0`. A leaf's (`node`) window has no
+     * summary: 400.
+     */
+    ApiResponse buildHistoryStatsResponse(const HistoryQuery& query);
+
+    /**
+     * @brief Stream a GET /api/v1/history/sync body.
+     *
+     * @p since is the token of the previous body as given (absent: every
+     * metric from its oldest retained reading) and @p limit the readings
+     * cap (resolveHistorySyncLimit). 400 for a token parseSyncToken()
+     * rejects, before anything is streamed. streamHistorySync seeks each
+     * metric to its mark, so a sync reads and sends only readings appended
+     * since the last one. A NON-BLOCKING filesystem read, no bus access.
+     */
+    ApiResponse streamHistorySyncResponse(const std::optional<std::string>& since,
+                                          std::optional<uint32_t> limit,
+                                          IChunkSink& sink);
+
+    /**
+     * @brief Stream a GET /api/v1/export.csv body (api/CsvExport.h).
+     *
+     * Same metric list, window resolution and 400 cases as a multi-metric
+     * /history, all before anything is streamed. The metrics are merged by
+     * epoch a batch at a time through the ReadAheadPipe when one is set, so
+     * RAM stays constant whatever the window. @p rows receives the data
+     * rows sent. A 500 envelope when the client went away mid-body.
+     */
+    ApiResponse streamCsvExportResponse(const HistoryQuery& query, IChunkSink& sink,
+                                        uint32_t& rows);
+
+    /**
+     * @brief Build the GET /api/v1/nodes response: every leaf's latest
+     * report (NodeGateway::nodes), or 404 without a gateway.
+     */
+    ApiResponse buildNodesResponse();
+
+    /**
+     * @brief Build the GET /api/v1/logs response: the newest lines of the
+     * log tail and the drop count, or 404 without setLogTail().
+     */
+    ApiResponse buildLogsResponse();
+
+    /**
+     * @brief Build the GET /api/v1/events/summary response: per-category
+     * event counts of the last @p hours hours (1..24) from the hourly
+     * buckets — no log read — or 404 without setEventCounts().
+     */
+    ApiResponse buildEventSummaryResponse(uint32_t hours);
 
     /**
      * @brief Build the GET /api/v1/events success body (newest-first).
      *
-     * @param count  maximum number of events to return (already bounded by the
-     *               handler). Reads IDataStorage::getEvents (non-blocking).
+     * @param query  category / since / until filter, page size (already
+     *               bounded by the handler) and resume cursor. Reads
+     *               IDataStorage::queryEvents (non-blocking); a further page
+     *               is announced as the body's `next` cursor.
      */
-    std::string buildEventsBody(std::size_t count);
+    std::string buildEventsBody(const EventQuery& query);
+
+    /**
+     * @brief Build the GET /api/v1/events?after= body: the events past
+     * @p wait's cursor, newest-first, at most its count, and the next
+     * cursor as `tail`.
+     *
+     * @return nullopt when nothing is new and @p always is false (the
+     *         caller may hold the request then)
+     */
+    std::optional<std::string> buildEventTailBody(const EventWait& wait, bool always);
+
+    /// Requests held for new events at once; the next tail read that finds
+    /// nothing answers empty rather than wait.
+    static constexpr std::size_t kEventWaiters = 4;
+
+    /// Claim one of the kEventWaiters slots; false when all are taken.
+    bool claimEventWait();
+
+    /// Release a slot once its request has been answered.
+    void releaseEventWait();
+
+    /**
+     * @brief Hand a claimed, detached tail read to the event-wait worker.
+     *
+     * False when the worker queue is missing — the caller still owns the
+     * request then.
+     */
+    bool deferEventWait(const EventWait& wait);
+
+    /**
+     * @brief Worker side: take the deferred tail reads, answer each one
+     * whose cursor has new events or whose deadline passed, and sleep on
+     * the notifier until the next event, deadline or poll of the queue.
+     *
+     * Called in a loop by main/event_wait_task.cpp; blocks up to @p waitMs
+     * on the queue while nothing is held.
+     * @return true while requests are held
+     */
+    bool serveEventWaits(uint32_t waitMs);
 
     /**
      * @brief Run the bounded sensor/RS485 self-test and build its result body.
@@ -260,19 +769,127 @@ public:
      * This is the ONE documented exception to QUIRK 5: an on-demand diagnostic
      * that issues a real, bounded read() on the environmental and soil sensors
      * (through their Locked* wrappers, so it is serialized with the other bus
-     * users). It runs on the httpd task, off the 10 Hz watering loop, and makes
-     * no watering decision. Every other handler stays non-blocking.
+     * users). It runs on the selftest worker (serveSelfTest()), off both the
+     * 10 Hz watering loop and the httpd task, and makes no watering decision.
+     * Every other handler stays non-blocking.
      */
     std::string buildSelfTestBody();
 
+    /// Claim the single self-test slot; false while a run is in progress
+    /// (the handler then answers 409).
+    bool claimSelfTest();
+
+    /// Release the slot once the claimed run has been answered.
+    void releaseSelfTest();
+
+    /**
+     * @brief Hand a detached request (httpd_req_async_handler_begin) to the
+     * selftest worker.
+     *
+     * @param asyncReq the opaque httpd_req_t* copy; the worker answers and
+     *                 completes it. False when the worker queue is missing
+     *                 or full — the caller still owns the request then.
+     */
+    bool deferSelfTest(void* asyncReq);
+
+    /**
+     * @brief Worker side: wait up to @p waitMs for a deferred self-test,
+     * run it, answer and complete the request, and release the slot.
+     *
+     * Called in a loop by main/selftest_task.cpp, so the bus reads (the soil
+     * round trip can take the full Modbus timeout) never hold the httpd task
+     * and the other routes keep answering meanwhile.
+     * @return true when a request was served
+     */
+    bool serveSelfTest(uint32_t waitMs);
+
+    /**
+     * @brief The self-test checks' hand-over: the selftest helper task
+     * calls serveCheck() on it in a loop (main/selftest_task.cpp), so the
+     * environmental and soil reads of one run overlap.
+     */
+    SelfTestRunner& selfTestRunner() { return selfTestRunner_; }
+
+    // -- Live stream (GET /api/v1/stream) -------------------------------------
+
+    /// The stream clients and their queues; also the EventLogger tap.
+    LiveStream& liveStream() { return live_; }
+
+    /// Per-route request counters, fed by the handlers' timing wrappers.
+    HttpMetrics& httpMetrics() { return metrics_; }
+
+    /// The httpd task's cJSON arena, opened around every handler by the
+    /// same wrappers (api/RequestArena.h).
+    RequestArena& requestArena() { return arena_; }
+
+    /// The per-client admission buckets, checked by the same wrappers.
+    RateLimiter& rateLimiter() { return limiter_; }
+
+    /// Held by the same wrappers around each handler; null without power
+    /// management.
+    IPowerLock* powerLock() { return powerLock_; }
+
+    /// Read the process gauges for GET /api/v1/metrics. Call on the httpd
+    /// task: the stack figure is the calling task's.
+    SystemMetricsDto readSystemMetrics();
+
+    /// The static asset store (AssetStore.h), or nullptr before
+    /// setAssets().
+    AssetStore* assets() { return assets_; }
+
+    /**
+     * @brief Queue what changed for the stream clients and hand the send to
+     * the httpd task.
+     *
+     * Called periodically by the stream task (main/stream_task.cpp), never
+     * from the 10 Hz loop: the soil getters can wait behind a Modbus read.
+     * No-op without clients, so an idle server reads nothing.
+     */
+    void pollStream();
+
+    /// Send every queued stream frame. Runs on the httpd task (queued work).
+    void drainStream();
+
 private:
     /// Current device IPv4 address on the STA interface ("" when none).
     std::string deviceIp() const;
 
-    /// Resolve a pump name ("plant"/"reservoir") to its wrapper, or nullptr for
-    /// an unknown name (capability-aware: "reservoir" exists on rev1 only).
+    /// Resolve a pump name ("plant"/"reservoir"/a zone's) to its wrapper, or
+    /// nullptr for an unknown name (capability-aware: "reservoir" exists on
+    /// rev1 only).
     IWaterPump* pumpByName(const std::string& name);
 
+    /// The INA226 telemetry (cached getters), or nullopt on a board without one.
+    std::optional<PowerDto> readPower();
+
+    /// The status / sensor DTOs around an already-read power block, with
+    /// only the members in @p fields read.
+    SystemStatusDto readStatus(const std::optional<PowerDto>& power,
+                               uint32_t fields = kStatusAll);
+    SensorReadingsDto readSensors(const std::optional<PowerDto>& power,
+                                  uint32_t fields = kSensorsAll);
+
+    /// Longest a metric's history goes without a reading beyond the data-log
+    /// cadence: its change-only heartbeat (0: every pass logs it); for a
+    /// derived metric, the longer of its inputs'.
+    uint32_t logHeartbeatS(const std::string& metricName);
+
+    /// The storage as /history, /history/stats and the CSV export read it:
+    /// with the derived metrics (api/DerivedMetrics.h) joined from theirs.
+    DerivedMetricStorage historyStorage();
+
+    /// One metric's /history series over [t0, t1], streamed to @p sink as a
+    /// whole body or, with @p member, as one `series` element. False when
+    /// the stream broke.
+    bool streamHistorySeries(const HistoryQuery& query, const std::string& metricName,
+                             uint32_t t0, uint32_t t1, IChunkSink& sink,
+                             bool member);
+
+    /// The window shared by /history and /history/stats. False with the 400
+    /// response in @p error on a missing metric or an unknown range.
+    bool resolveHistoryQuery(const HistoryQuery& query, uint32_t& t0,
+                             uint32_t& t1, ApiResponse& error);
+
     IConfigStore& config_;
     IDataStorage& storage_;
     IEnvironmentalSensor& env_;
@@ -292,6 +909,62 @@ private:
 #endif
 
     void* server_ = nullptr;  ///< opaque httpd_handle_t (see .cpp)
+    uint32_t etagSalt_ = 0;   ///< per-boot ETag salt, drawn in start()
+    LiveStream live_;
+    std::atomic<bool> drainQueued_{false};  ///< a drainStream() is queued
+    ResponseCache cache_;                    ///< max ages set in the constructor
+    AssetStore* assets_ = nullptr;           ///< set before start()
+    HttpMetrics metrics_;
+    /// httpd task only; sized by its budget for this board.
+    RequestArena arena_{bufferBudgets().declare(BufferPool::RequestArena, RequestArena::kBudget)};
+    RateLimiter limiter_;                    ///< httpd task only; off by default
+    const SoilPollScheduler* soilProbes_ = nullptr;  ///< multi-drop only
+    std::array<IWaterPump*, kMaxZonePumps> zonePumps_{};  ///< set before start()
+    std::size_t zonePumpCount_ = 0;
+    const ModbusBusMaster* modbusBus_ = nullptr;
+    PumpCurrentCapture* powerCapture_ = nullptr;     ///< httpd task drains it
+    const EnergyMeter* energyMeter_ = nullptr;       ///< load() only
+    const DecisionTrace* decisionTrace_ = nullptr;   ///< read-only, any task
+    const TaskTelemetry* taskTelemetry_ = nullptr;   ///< read-only, any task
+    const LockRegistry* locks_ = nullptr;            ///< read-only, any task
+    const BootProfile* bootProfile_ = nullptr;       ///< read-only, any task
+    const WatchdogFeeds* watchdogFeeds_ = nullptr;   ///< read-only, any task
+    const TickLatency* tickLatency_ = nullptr;       ///< read-only, any task
+    const LifetimeCounters* lifetime_ = nullptr;     ///< read-only, any task
+    IPowerLock* powerLock_ = nullptr;                ///< counted, any task
+    const PowerResidency* powerResidency_ = nullptr; ///< locks its own totals
+    const MqttUplink* mqtt_ = nullptr;               ///< stats() from any task
+    const NodeGateway* nodeGateway_ = nullptr;       ///< locks its own table
+    PumpUsage* pumpUsage_ = nullptr;                 ///< locks its own rings
+    const LogTail* logTail_ = nullptr;               ///< locks its own lines
+    const EventCounts* eventCounts_ = nullptr;       ///< locks its own buckets
+    EventNotifier* eventNotifier_ = nullptr;         ///< locks its own generation
+    uint32_t eventWaitMaxS_ = 0;
+    const ModbusFrameCapture* modbusCapture_ = nullptr;  ///< read-only, any task
+    const InputRecorder* inputRecorder_ = nullptr;        ///< read-only, any task
+    const BlockRingFile* recordingFile_ = nullptr;
+    OtaPipeline* ota_ = nullptr;                     ///< locks its own hand-over
+    ReadAheadPipe* readAhead_ = nullptr;             ///< locks its own hand-over
+    IStorageHold* archiveHold_ = nullptr;            ///< serializes its own jobs
+    std::string archiveBase_;                        ///< set before start()
+    std::string tlsCert_;                    ///< set before start(); empty = HTTP
+    std::string tlsKey_;
+    unsigned tlsMaxSessions_ = 0;
+    bool https_ = false;                     ///< start() brought up HTTPS
+    TlsMetrics tls_;
+    SocketMetrics sockets_;
+    int httpdPriority_ = -1;                 ///< -1 = IDF default
+    int httpdCore_ = -1;                     ///< -1 = either core
+    void* selfTestQueue_ = nullptr;          ///< opaque QueueHandle_t (see .cpp)
+    std::atomic<bool> selfTestBusy_{false};  ///< a self-test is claimed
+    void* eventWaitQueue_ = nullptr;         ///< opaque QueueHandle_t (see .cpp)
+    std::atomic<uint32_t> eventWaitsHeld_{0};  ///< claimed event-wait slots
+    std::array<EventWait, kEventWaiters> eventWaits_{};  ///< the worker's alone
+    // Members, not locals of buildSelfTestBody(): a check past the
+    // deadline is still in a helper's hands after the run returns.
+    SensorReadCheck<IEnvironmentalSensor> envCheck_{"environmental", env_};
+    SensorReadCheck<ISoilSensor> soilCheck_{"soil", soil_};  ///< the RS485 round trip
+    SelfTestRunner selfTestRunner_;
 };
 
 }  // namespace api
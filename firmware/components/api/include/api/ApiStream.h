@@ -0,0 +1,381 @@
+// SPDX-FileCopyrightText: 2026 Cryptotomte
+// SPDX-License-Identifier: AGPL-3.0-or-later
+/**
+ * @file ApiStream.h
+ * @brief Streaming JSON body writer for GET /api/v1/history (host+target).
+ *
+ * serializeHistory() builds a cJSON node per timestamp and per value and
+ * prints the whole tree to one string: for a 1000-point series that is
+ * tens of KiB of transient heap in small blocks, on the httpd task. The
+ * writer here emits the same bytes through a fixed buffer handed to an
+ * IChunkSink (httpd_resp_send_chunk on target) whenever it fills, so the
+ * body costs one buffer whatever the series length.
+ *
+ * streamRawHistory() goes one step further for a raw series: it never
+ * collects the readings at all but replays IDataStorage::forEachReading()
+ * twice — once for timestamps[], once for values[] — step-filling on the
+ * fly. PURE C++ (no esp_http_server), so the byte output is host-tested
+ * against serializeHistory().
+ *
+ * BINARY FORMAT (HistoryFormat::Binary, `application/octet-stream`): an
+ * 8-byte header — the magic "WSH1", then the bucket width as uint32 (0 =
+ * raw) — followed by one record per point until the end of the body, all
+ * little-endian: raw `{uint32 epoch, float value}` (8 bytes, the on-disk
+ * row layout), bucketed `{uint32 epoch, float mean, float min, float max}`
+ * (16 bytes). Points are the same as in the JSON arrays, held points
+ * included; the query echo and `count`/`filled` are left out (the client
+ * sent the query; count = body length / record size). Records interleave,
+ * so a raw binary series is one storage pass.
+ *
+ * SYNC FORMAT (GET /api/v1/history/sync, streamHistorySync()): an 8-byte
+ * header — the magic "WSY1", then the device's wall-clock epoch (uint32,
+ * 0 = not set) — followed by blocks {uint8 name length (1..255), metric
+ * name, uint16 count, count x {uint32 epoch, float value}}, a metric's
+ * readings chronological across its blocks; a zero name length ends the
+ * blocks. Then {uint8 more, uint16 token length, token}: pass the token
+ * (formatSyncToken(), ASCII) as the next `since`; more = 1 means the
+ * record limit cut the sync short and the next call continues at once.
+ * A body without its trailer is incomplete: retry with the previous token.
+ *
+ * The same writer drains the pump current capture ring for
+ * GET /api/v1/power/capture (streamPowerCapture(), format below), the
+ * controller decision trace into GET /api/v1/control/trace, and the
+ * system trace rings into GET /api/v1/trace (binary, format below).
+ *
+ * RANGES: a download cut short by the Wi-Fi resumes with a single
+ * `Range: bytes=` request (resolveByteRange()). A file maps the range onto
+ * its own offsets; a generated body is produced again and RangeSink lets
+ * only the asked-for bytes reach the client, its length measured first by
+ * a pass through CountingSink.
+ */
+
+#ifndef WATERINGSYSTEM_API_APISTREAM_H
+#define WATERINGSYSTEM_API_APISTREAM_H
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <string_view>
+
+#include "api/ApiDtos.h"
+#include "api/ApiRequests.h"
+#include "interfaces/IDataStorage.h"
+
+class BlockRingFile;
+class DecisionTrace;
+class InputRecorder;
+class ModbusFrameCapture;
+class PumpCurrentCapture;
+class TraceBuffer;
+
+namespace api {
+
+/**
+ * @brief Receives a streamed body in pieces, in order.
+ *
+ * A tiny interface rather than std::function, like IReadingVisitor.
+ */
+class IChunkSink {
+public:
+    virtual ~IChunkSink() = default;
+
+    /// Send @p len bytes; false = the client is gone, stop producing.
+    virtual bool send(const char* data, std::size_t len) = 0;
+};
+
+/**
+ * @brief Bytes into a fixed buffer, sent to an IChunkSink each time it
+ * fills. A failed send sticks: later output is dropped and ok() stays false.
+ */
+class ChunkWriter {
+public:
+    static constexpr std::size_t kBufferBytes = 512;
+
+    explicit ChunkWriter(IChunkSink& sink) : sink_(sink) {}
+
+    ChunkWriter(const ChunkWriter&) = delete;
+    ChunkWriter& operator=(const ChunkWriter&) = delete;
+
+    /// Append @p len bytes verbatim.
+    void put(const void* data, std::size_t len);
+    /// Append @p value as 4 little-endian bytes.
+    void u32le(uint32_t value);
+    /// Append @p value's IEEE-754 bits as 4 little-endian bytes.
+    void f32le(float value);
+
+    /// Send whatever is buffered; returns ok().
+    bool flush();
+    bool ok() const { return ok_; }
+
+private:
+    IChunkSink& sink_;
+    char buf_[kBufferBytes];
+    std::size_t used_ = 0;
+    bool ok_ = true;
+};
+
+/**
+ * @brief JSON tokens over a ChunkWriter.
+ *
+ * The caller places the structure (braces, commas, keys) with raw(); the
+ * writer formats scalars exactly as cJSON prints them.
+ */
+class JsonStreamWriter : public ChunkWriter {
+public:
+    using ChunkWriter::ChunkWriter;
+
+    /// Append @p text verbatim.
+    void raw(const char* text);
+    /// Append @p text as a quoted, escaped JSON string.
+    void string(const std::string& text);
+    /// Append a number as cJSON prints it; non-finite becomes null.
+    void number(double value);
+    /// Append a number with at most @p decimals fraction digits
+    /// (formatJsonFixed()).
+    void fixed(double value, int decimals);
+    /// Append an integer.
+    void integer(int64_t value);
+};
+
+/// The bytes [first, first + length) of a body.
+struct ByteRange {
+    uint64_t first = 0;
+    uint64_t length = 0;
+};
+
+/// How a request's Range header applies to a body.
+enum class RangeRequest : uint8_t {
+    Whole,          ///< no Range, or one served whole (several ranges, another unit, malformed)
+    Partial,        ///< 206 with the resolved range
+    Unsatisfiable,  ///< 416: the range starts at or past the end
+};
+
+/**
+ * @brief Resolve a Range header value against a body of @p size bytes.
+ *
+ * One range of the `bytes` unit: `first-last` (clamped to the body),
+ * `first-` or the suffix `-n` (the last n bytes). A list of ranges is
+ * served whole — they would cost a multipart body, and a resuming client
+ * asks for one — and so is anything malformed, as RFC 9110 allows.
+ * @param out the range on Partial; untouched otherwise
+ */
+RangeRequest resolveByteRange(std::string_view header, uint64_t size, ByteRange& out);
+
+/// Content-Range of a 206: `bytes first-last/size`.
+std::string contentRange(const ByteRange& range, uint64_t size);
+
+/// Content-Range of a 416: `bytes */size`.
+std::string unsatisfiedRange(uint64_t size);
+
+/**
+ * @brief Forwards to @p out only the bytes of @p range of what it is sent
+ * (offsets counted from the first send), and drops the rest.
+ *
+ * Once the last byte of the range is out, send() returns false so the
+ * producer stops early; complete() then tells that stop from a client
+ * that went away.
+ */
+class RangeSink final : public IChunkSink {
+public:
+    RangeSink(IChunkSink& out, const ByteRange& range) : out_(out), range_(range) {}
+
+    bool send(const char* data, std::size_t len) override;
+
+    /// Every byte of the range went out.
+    bool complete() const { return sent_ == range_.length; }
+
+private:
+    IChunkSink& out_;
+    ByteRange range_;
+    uint64_t offset_ = 0;  ///< body bytes seen so far
+    uint64_t sent_ = 0;
+};
+
+/// Counts a body without sending it: the Content-Length of a generated
+/// body, for HEAD and for resolving a Range.
+class CountingSink final : public IChunkSink {
+public:
+    bool send(const char* /*data*/, std::size_t len) override
+    {
+        bytes_ += len;
+        return true;
+    }
+
+    uint64_t bytes() const { return bytes_; }
+
+private:
+    uint64_t bytes_ = 0;
+};
+
+/// First four bytes of a binary history body ("WSH1": format version 1).
+constexpr char kHistoryBinaryMagic[4] = {'W', 'S', 'H', '1'};
+
+/**
+ * @brief Stream @p series as the serializeHistory() body, byte for byte, or
+ * in the binary format.
+ *
+ * With @p member the JSON object leaves out its `success` key: one element
+ * of a multi-metric body's `series` array (the caller writes the rest).
+ * @return false when the sink failed (the body is incomplete)
+ */
+bool streamHistory(const HistorySeries& series, IChunkSink& sink,
+                   HistoryFormat format = HistoryFormat::Json,
+                   bool member = false);
+
+/**
+ * @brief Stream a raw (bucket 0) history body straight from @p storage.
+ *
+ * @p echo supplies the metric, reading and resolved [start, end]; its
+ * arrays are ignored. Pass one emits timestamps[] from
+ * forEachReading(start, end), pass two values[] from the same readings
+ * (up to the last epoch and count pass one saw, so appends in between are
+ * excluded), both step-filled under @p heartbeatS exactly like
+ * stepFillHistory(). Output equals serializeHistory() of the collected and
+ * filled series. The storage read lock is held while each pass streams;
+ * LockedDataStorage's write-behind queue keeps appends from waiting on it.
+ * The binary format needs one pass only (records carry both fields);
+ * @p member is as for streamHistory().
+ *
+ * @return false when the sink failed or the readings changed between the
+ * passes (ring eviction): the body is then incomplete and the caller must
+ * end the response without its final chunk so the client sees an error.
+ */
+bool streamRawHistory(const IDataStorage& storage, const HistorySeries& echo,
+                      uint32_t logIntervalS, uint32_t heartbeatS,
+                      IChunkSink& sink,
+                      HistoryFormat format = HistoryFormat::Json,
+                      bool member = false);
+
+/**
+ * @brief Stream one page of a paged /history series.
+ *
+ * Collects at most @p limit stored readings of @p echo's metric past
+ * @p cursor in [start, end] — verbatim: no step fill, no bucketing, so
+ * consecutive pages concatenate to exactly what storage holds — and
+ * streams them as a raw JSON series whose `next` is the resume cursor
+ * when readings remain (absent on the last page). The walk starts at
+ * max(start, cursor.epoch) through IDataStorage::forEachReading, which
+ * seeks by epoch, so a late page costs no more than the first.
+ *
+ * @return false when the sink failed (the body is incomplete)
+ */
+bool streamHistoryPage(const IDataStorage& storage, const HistorySeries& echo,
+                       const ReadingCursor& cursor, std::size_t limit,
+                       IChunkSink& sink);
+
+/// First four bytes of a history sync body ("WSY1": format version 1).
+constexpr char kHistorySyncMagic[4] = {'W', 'S', 'Y', '1'};
+
+/**
+ * @brief Stream every known metric's readings past its mark in @p since as
+ * a GET /api/v1/history/sync body (format above), at most @p limit in all.
+ *
+ * Metrics go in MetricId order, each walked with forEachReading from its
+ * mark's epoch through a ReadingPager, so only readings the collector does
+ * not hold are read and sent: the cost is the new data, not a window. The
+ * trailer's token carries the updated marks; a metric the limit did not
+ * reach keeps its old mark. @p now is echoed in the header. The storage
+ * read lock is held while each metric streams, as in streamRawHistory().
+ *
+ * @return false when the sink failed (the body is incomplete)
+ */
+bool streamHistorySync(const IDataStorage& storage, const HistorySyncMarks& since,
+                       std::size_t limit, uint32_t now, IChunkSink& sink);
+
+/// First four bytes of a pump current capture body ("WSC1": version 1).
+constexpr char kPowerCaptureMagic[4] = {'W', 'S', 'C', '1'};
+
+/**
+ * @brief Drain @p capture's sample ring into a GET /api/v1/power/capture
+ * body.
+ *
+ * Format, all little-endian: a 16-byte header — the magic "WSC1", the
+ * sample period in µs (uint32), the run in progress (uint32, 0 = none)
+ * and the samples dropped on a full ring since boot (uint32) — then one
+ * 4-byte record per sample until the end of the body: the run's low 16
+ * bits (uint16) and the current in mA (int16, INT16_MIN = no reading).
+ * Samples leave the ring as they are sent, so consecutive polls return
+ * consecutive samples; one body carries at most one ring's worth.
+ *
+ * The ring has ONE consumer: call from the httpd task only.
+ * @return false when the sink failed (the drained samples are lost)
+ */
+bool streamPowerCapture(PumpCurrentCapture& capture, IChunkSink& sink);
+
+/**
+ * @brief Stream the records of @p trace past sequence @p after as a
+ * GET /api/v1/control/trace body, oldest first.
+ *
+ * `{"success":true,"written":N,"records":[...],"next":S}`: `written` is the
+ * newest sequence, each record carries its fields with the gate and action
+ * by name and the flags as booleans, and `next` is the last sequence sent
+ * (@p after when none), to pass back as `after` on the next poll. A gap in
+ * `seq` means records were overwritten before they were read. The ring is
+ * only read, so any number of readers may poll it.
+ * @return false when the sink failed (the body is incomplete)
+ */
+bool streamDecisionTrace(const DecisionTrace& trace, uint32_t after,
+                         IChunkSink& sink);
+
+/// First four bytes of a system trace body ("WST1": version 1).
+constexpr char kTraceMagic[4] = {'W', 'S', 'T', '1'};
+
+/// Bytes of one record in a system trace body.
+constexpr std::size_t kTraceRecordBytes = 20;
+
+/**
+ * @brief Dump every record of @p trace's rings as a GET /api/v1/trace
+ * body, for offline decoding.
+ *
+ * Format, all little-endian: a header — the magic "WST1", @p nowUs (uint32,
+ * the clock the records are stamped with, so their ages can be taken), the
+ * core count (uint32) and each core's `written` when the dump began
+ * (uint32 each) — then one 20-byte record until the end of the body: the
+ * sequence (uint32, per core), the time in µs (uint32), the TraceId
+ * (uint16), the core (uint8), the TraceLevel (uint8) and the two arguments
+ * (uint32 each; their meaning per id is in TraceBuffer.h). Core 0's records
+ * come first, each core oldest first. The rings are only read, so any
+ * number of readers may dump them.
+ * @return false when the sink failed (the body is incomplete)
+ */
+bool streamTraceBuffer(const TraceBuffer& trace, uint32_t nowUs, IChunkSink& sink);
+
+/// First four bytes of an RS485 frame capture body ("WSF1": version 1).
+constexpr char kModbusCaptureMagic[4] = {'W', 'S', 'F', '1'};
+
+/**
+ * @brief Dump @p capture's frames past sequence @p after as a
+ * GET /api/v1/modbus/capture body, oldest first.
+ *
+ * Format, all little-endian: a 16-byte header — the magic "WSF1", the time
+ * of the dump in µs (uint32, the clock of the frame stamps), the newest
+ * sequence (uint32) and flags (uint32, bit 0 = capture running) — then one
+ * record per frame until the end of the body: the sequence (uint32), the
+ * time in µs (uint32), the ModbusFrameDir (uint8), 1 when the CRC checks
+ * out (uint8), the length on the wire (uint16) and the first
+ * min(length, ModbusFrame::kMaxBytes) bytes of the frame. A gap in the
+ * sequence means frames were overwritten before they were read. The ring is
+ * only read, so any number of readers may dump it.
+ * @return false when the sink failed (the body is incomplete)
+ */
+bool streamModbusCapture(const ModbusFrameCapture& capture, uint32_t nowUs,
+                         uint32_t after, IChunkSink& sink);
+
+/**
+ * @brief Dump the watering input recording as a GET /api/v1/recording
+ * body: the blocks in @p file (null: none), oldest first, then the blocks
+ * of @p recorder's RAM ring it has not taken yet, the one being written
+ * last.
+ *
+ * The body is the blocks back to back, each with its own header (format in
+ * control/InputRecord.h); test_apps/replay reads it as it is. The file is
+ * held for its part of the walk, so the recorder task's next flush waits
+ * for a slow client rather than a block being sent twice or not at all.
+ * @return false when the sink failed (the body is incomplete)
+ */
+bool streamInputRecording(const InputRecorder& recorder, const BlockRingFile* file,
+                          IChunkSink& sink);
+
+}  // namespace api
+
+#endif /* WATERINGSYSTEM_API_APISTREAM_H */
@@ -0,0 +1,116 @@
+// SPDX-FileCopyrightText: 2026 Cryptotomte
+// SPDX-License-Identifier: AGPL-3.0-or-later
+/**
+ * @file AssetCache.h
+ * @brief Validators and a RAM cache for the gzipped frontend assets
+ *        (host+target).
+ *
+ * tools/gzip_assets.py writes, next to the <path>.gz files, a manifest
+ * (kAssetManifestName) with one "<path> <hash>" line per asset: the first
+ * 16 hex digits of the SHA-256 of the .gz bytes. Those are the strong ETags
+ * staticFileHandler sends, so a repeat visit revalidates each asset with a
+ * bodiless 304 and reads no flash. The hashes are made at build time, so
+ * they change exactly when a new storage image changes the bytes.
+ *
+ * Bodies read from flash are kept in RAM when they fit: kMaxEntryBytes per
+ * asset and kBudgetBytes in all on these boards, which have no PSRAM. That
+ * is BufferPool::AssetCache's internal budget (interfaces/BufferBudget.h);
+ * with PSRAM the grant is kBudget.psramBytes, an entry up to a third of it,
+ * and chart.min.js fits too. The bodies are std::strings, so the pool
+ * counts them through account() and malloc places them (in PSRAM with
+ * CONFIG_SPIRAM_USE_MALLOC). That covers
+ * the SPA shell, the app script, the stylesheets and the smaller vendor
+ * bundles; chart.min.js (~70 KB gzipped) keeps streaming from littlefs and
+ * is revalidated by its ETag like the rest. Nothing is evicted — the asset
+ * set is fixed for the image's lifetime. Loaded lazily: the manifest on the
+ * first static request, each body on its own first request.
+ *
+ * PURE C++ (no esp_http_server, no filesystem), host-tested; ApiServer.cpp
+ * does the file I/O.
+ */
+
+#ifndef WATERINGSYSTEM_API_ASSETCACHE_H
+#define WATERINGSYSTEM_API_ASSETCACHE_H
+
+#include <cstddef>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+
+#include "interfaces/BufferBudget.h"
+#include "interfaces/StaticMutex.h"
+
+namespace api {
+
+/// Manifest file name, relative to the storage base path.
+constexpr const char* kAssetManifestName = "assets.etag";
+
+class AssetCache {
+public:
+    static constexpr std::size_t kMaxEntryBytes = 16 * 1024;
+    static constexpr std::size_t kBudgetBytes = 48 * 1024;
+    static constexpr BufferBudget kBudget{256 * 1024, kBudgetBytes};
+    /// Hex digits of one manifest hash.
+    static constexpr std::size_t kHashLen = 16;
+
+    /// Keep up to @p budgetBytes of bodies, each up to a third of that
+    /// (kMaxEntryBytes for the default).
+    explicit AssetCache(std::size_t budgetBytes = kBudgetBytes)
+        : budgetBytes_(budgetBytes), maxEntryBytes_(budgetBytes / 3)
+    {
+    }
+    ~AssetCache();
+
+    AssetCache(const AssetCache&) = delete;
+    AssetCache& operator=(const AssetCache&) = delete;
+
+    /**
+     * @brief Replace the tags with those in manifest @p text.
+     *
+     * Lines that are not "<path> <16 lowercase hex digits>" are skipped; an
+     * empty text (no manifest on the volume) leaves every asset untagged.
+     * Marks the manifest loaded either way, so a missing file is not
+     * retried on every request.
+     */
+    void loadManifest(const std::string& text);
+    bool manifestLoaded() const;
+
+    /// Quoted strong ETag of relative asset @p path, or "" when untagged.
+    std::string etagFor(const std::string& path) const;
+
+    /// The cached .gz body of @p path, or null.
+    std::shared_ptr<const std::string> find(const std::string& path) const;
+
+    /// Would a @p size byte body for a new entry fit the budgets?
+    bool fits(std::size_t size) const;
+
+    /// Keep @p body for @p path if it fits; false when it does not (or the
+    /// path is already cached).
+    bool insert(const std::string& path, std::string body);
+
+    std::size_t bytesUsed() const;
+    std::size_t budgetBytes() const { return budgetBytes_; }
+
+private:
+    struct Tag {
+        std::string path;
+        std::string etag;
+    };
+    struct Entry {
+        std::string path;
+        std::shared_ptr<const std::string> body;
+    };
+
+    const std::size_t budgetBytes_;
+    const std::size_t maxEntryBytes_;
+    mutable StaticMutex mutex_;
+    bool manifestLoaded_ = false;
+    std::vector<Tag> tags_;
+    std::vector<Entry> entries_;
+    std::size_t bytesUsed_ = 0;
+};
+
+}  // namespace api
+
+#endif /* WATERINGSYSTEM_API_ASSETCACHE_H */
@@ -0,0 +1,49 @@
+// SPDX-FileCopyrightText: 2026 Cryptotomte
+// SPDX-License-Identifier: AGPL-3.0-or-later
+/**
+ * @file AssetStore.h
+ * @brief The AssetCache over the <base>/<path>.gz files (host+target).
+ *
+ * Owns the validators and RAM cache and the file reads behind them: the
+ * manifest on first use of cache(), a whole body on the first fetch() of
+ * a path that fits the cache budgets. ApiServer's static handler uses
+ * cache() and streams what does not fit itself; the provisioning portal
+ * uses fetch() (IStaticAssets) for its small pages.
+ *
+ * Plain stdio, so the host tests run it over a temporary directory.
+ */
+
+#ifndef WATERINGSYSTEM_API_ASSETSTORE_H
+#define WATERINGSYSTEM_API_ASSETSTORE_H
+
+#include <string>
+
+#include "api/AssetCache.h"
+#include "interfaces/IStaticAssets.h"
+
+namespace api {
+
+class AssetStore : public IStaticAssets {
+public:
+    /// Assets live under @p basePath (the storage mount point); the cache
+    /// is sized by BufferPool::AssetCache's grant for this board.
+    explicit AssetStore(std::string basePath);
+
+    AssetStore(const AssetStore&) = delete;
+    AssetStore& operator=(const AssetStore&) = delete;
+
+    /// The cache, with the manifest loaded.
+    AssetCache& cache();
+
+    bool fetch(const std::string& path, StaticAsset& out) override;
+
+    const std::string& basePath() const { return basePath_; }
+
+private:
+    const std::string basePath_;
+    AssetCache cache_;
+};
+
+}  // namespace api
+
+#endif /* WATERINGSYSTEM_API_ASSETSTORE_H */
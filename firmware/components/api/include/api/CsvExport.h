@@ -0,0 +1,89 @@
+// SPDX-FileCopyrightText: 2026 Cryptotomte
+// SPDX-License-Identifier: AGPL-3.0-or-later
+/**
+ * @file CsvExport.h
+ * @brief GET /api/v1/export.csv: several metrics' history as one
+ *        spreadsheet, merged by epoch (host+target).
+ *
+ * FORMAT (RFC 4180, `text/csv`, CRLF line ends): a header row
+ * `epoch,time,<metric>,...` in request order, then one row per distinct
+ * epoch in the window, oldest first: the epoch, the same instant as
+ * ISO-8601 UTC, and each metric's reading stamped then (`%.7g`, a float's
+ * precision) or an empty cell when it has none. A metric with two readings
+ * at one epoch fills a second row with that epoch.
+ *
+ * MERGE: each metric is a stream of at most kBatchReadings readings at a
+ * time, refilled by one forEachReading() pass through a ReadingPager from
+ * its cursor — the same epoch seek a /history page does, so a refill deep
+ * into a month costs what the first does. Each row takes the smallest
+ * head epoch among the streams. RAM is the streams' batches and one row,
+ * whatever the window: nothing is collected per reading or per row.
+ *
+ * CsvExportSource is an IChunkSource, so the handler pumps it through the
+ * ReadAheadPipe: the reader task reads the chunks and formats the rows
+ * while the httpd task sends the previous buffer.
+ */
+
+#ifndef WATERINGSYSTEM_API_CSVEXPORT_H
+#define WATERINGSYSTEM_API_CSVEXPORT_H
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include "api/OtaPipeline.h"
+#include "interfaces/IDataStorage.h"
+
+namespace api {
+
+class CsvExportSource final : public IChunkSource {
+public:
+    /// Readings held per metric between storage passes (8 bytes each).
+    static constexpr std::size_t kBatchReadings = 64;
+
+    /// @p storage must outlive the source; @p metrics are valid
+    /// (splitHistoryMetrics()) and @p t0 <= @p t1.
+    CsvExportSource(const IDataStorage& storage, const std::vector<std::string>& metrics,
+                    uint32_t t0, uint32_t t1);
+
+    /// The next bytes of the body; 0 once the last row is out.
+    int receive(uint8_t* dst, std::size_t len) override;
+
+    /// Data rows produced so far (the header not counted).
+    uint32_t rows() const { return rows_; }
+
+private:
+    struct Reading {
+        uint32_t epoch;
+        float value;
+    };
+
+    /// One metric's readings, a batch at a time.
+    struct Stream {
+        std::string metric;
+        ReadingCursor cursor;  ///< where the next batch starts
+        bool more = true;      ///< the storage may hold readings past cursor
+        std::size_t head = 0;
+        std::size_t count = 0;
+        std::array<Reading, kBatchReadings> batch;
+    };
+
+    /// Whether @p s has a head reading, reading its next batch if needed.
+    bool ready(Stream& s);
+    /// Format the next row into line_; false when every stream is done.
+    bool nextRow();
+
+    const IDataStorage& storage_;
+    uint32_t t0_;
+    uint32_t t1_;
+    std::vector<Stream> streams_;
+    std::string line_;  ///< the header, then one row at a time
+    std::size_t sent_ = 0;
+    uint32_t rows_ = 0;
+};
+
+}  // namespace api
+
+#endif /* WATERINGSYSTEM_API_CSVEXPORT_H */
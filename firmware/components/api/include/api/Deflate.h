@@ -0,0 +1,122 @@
+// SPDX-FileCopyrightText: 2026 Cryptotomte
+// SPDX-License-Identifier: AGPL-3.0-or-later
+/**
+ * @file Deflate.h
+ * @brief Streaming gzip/deflate encoder for dynamic responses (host+target).
+ *
+ * The static assets go out pre-gzipped; the JSON bodies do not, although a
+ * /history series or an /events page is mostly the same keys and digits
+ * over and over. On the greenhouse Wi-Fi, airtime is what a dashboard
+ * waits on, so the server compresses the larger bodies for a client whose
+ * Accept-Encoding allows it.
+ *
+ * DeflateSink is an IChunkSink in front of another: bytes sent to it come
+ * out of the inner sink as a gzip (RFC 1952) or zlib (RFC 1951 in RFC 1950,
+ * which is what HTTP calls "deflate") stream. LZ77 runs over a
+ * kWindowBytes history with a short hash chain, and everything is coded
+ * with the fixed Huffman tables, so there is no per-block tree to build or
+ * buffer. All state — history, hash tables, a ChunkWriter for the output —
+ * lives in the object, a little under 6 KiB whatever the body length. It
+ * compresses less than zlib's default level, but the repetitive JSON
+ * bodies still shrink several times over.
+ *
+ * PURE C++ (no esp_http_server), host-tested by inflating the output.
+ */
+
+#ifndef WATERINGSYSTEM_API_DEFLATE_H
+#define WATERINGSYSTEM_API_DEFLATE_H
+
+#include <cstddef>
+#include <cstdint>
+#include <string_view>
+
+#include "api/ApiStream.h"
+
+namespace api {
+
+/// A response body's Content-Encoding.
+enum class ContentEncoding : uint8_t {
+    Identity,  ///< sent as is
+    Gzip,      ///< "gzip"
+    Deflate,   ///< "deflate" (zlib-wrapped)
+};
+
+/// The Content-Encoding header value of @p encoding; null for Identity.
+const char* contentEncodingName(ContentEncoding encoding);
+
+/**
+ * @brief Pick the response coding from an Accept-Encoding header value.
+ *
+ * Gzip or Deflate when the list names it (or `*`) with a non-zero q, the
+ * higher q winning and gzip taking a tie; Identity otherwise, including for
+ * an empty header. Names are case-insensitive; a malformed q counts as 1.
+ */
+ContentEncoding selectContentEncoding(std::string_view acceptEncoding);
+
+/// CRC-32 (the gzip trailer's) of @p len bytes, continued from @p crc.
+uint32_t crc32Update(uint32_t crc, const void* data, std::size_t len);
+
+/// Adler-32 (the zlib trailer's) of @p len bytes, continued from @p adler.
+uint32_t adler32Update(uint32_t adler, const void* data, std::size_t len);
+
+class DeflateSink final : public IChunkSink {
+public:
+    /// How far back a match may reach (also the zlib header's window).
+    static constexpr std::size_t kWindowBytes = 1024;
+
+    /// @p encoding must be Gzip or Deflate.
+    DeflateSink(IChunkSink& out, ContentEncoding encoding);
+
+    DeflateSink(const DeflateSink&) = delete;
+    DeflateSink& operator=(const DeflateSink&) = delete;
+
+    /// Compress @p len bytes; false once the inner sink has failed.
+    bool send(const char* data, std::size_t len) override;
+
+    /// Encode what is still buffered and write the trailer; the stream is
+    /// complete when this returns true. Call once, after the last send().
+    bool finish();
+
+    /// Bytes of the input seen so far (before compression).
+    uint32_t inputBytes() const { return inputBytes_; }
+
+private:
+    static constexpr std::size_t kHashBits = 9;
+    static constexpr std::size_t kMinMatch = 3;
+    static constexpr std::size_t kMaxMatch = 258;
+    static constexpr std::size_t kMaxChain = 16;
+    /// Two windows plus a match of lookahead: sliding by one window then
+    /// always keeps a whole window of history.
+    static constexpr std::size_t kBufferBytes = 2 * kWindowBytes + kMaxMatch;
+
+    void start();
+    void compress(bool flush);
+    void slide();
+    std::size_t hashAt(std::size_t pos) const;
+    void insert(std::size_t pos);
+    std::size_t longestMatch(std::size_t pos, std::size_t& distance) const;
+
+    void putBits(uint32_t value, unsigned count);
+    void putCode(uint32_t code, unsigned count);  ///< a Huffman code, MSB first
+    void literal(uint8_t byte);
+    void match(std::size_t length, std::size_t distance);
+    void put32be(uint32_t value);
+    void put32le(uint32_t value);
+
+    ChunkWriter out_;
+    ContentEncoding encoding_;
+    uint8_t buf_[kBufferBytes];
+    uint16_t head_[std::size_t{1} << kHashBits];  ///< last position + 1 per hash, 0 = none
+    uint16_t prev_[kWindowBytes];                  ///< earlier position + 1, by pos % window
+    std::size_t pos_ = 0;                          ///< next byte to encode
+    std::size_t end_ = 0;                          ///< bytes held in buf_
+    uint32_t bits_ = 0;
+    unsigned bitCount_ = 0;
+    uint32_t check_;                               ///< CRC-32 or Adler-32 so far
+    uint32_t inputBytes_ = 0;
+    bool started_ = false;
+};
+
+}  // namespace api
+
+#endif /* WATERINGSYSTEM_API_DEFLATE_H */
@@ -0,0 +1,118 @@
+// SPDX-FileCopyrightText: 2026 Cryptotomte
+// SPDX-License-Identifier: AGPL-3.0-or-later
+/**
+ * @file DeltaPatch.h
+ * @brief Delta OTA patch format and its streaming applier (host+target).
+ *
+ * A patch rebuilds a new app image from the running one, so a release
+ * that changes a few functions ships a fraction of the ~1.5 MiB image.
+ * tools/make_delta.py writes it; OtaPipeline recognises it by its magic on
+ * the same POST /api/v1/ota and applies it on the way into the slot.
+ *
+ * FORMAT (little-endian): a kDeltaHeaderBytes header
+ *   "WSDP", version (1), 3 zero bytes, target size (u32), base size (u32),
+ *   base SHA-256 (32), target SHA-256 (32)
+ * then ops until the target size is produced, each an op byte and LEB128
+ * varints:
+ *   0x00 DATA  n, then n literal bytes
+ *   0x01 DIFF  seek (zigzag), n, then runs covering n bytes: zeros, lits,
+ *              then lits bytes. Output byte i is base[pos + i] plus the
+ *              run byte (0 inside a zero run), mod 256; the base position
+ *              starts at 0, moves by seek before the op and by n after it.
+ * DIFF is the bsdiff idea: code that moved keeps its bytes but shifts its
+ * addresses, and the byte-wise difference to the old code is mostly zero
+ * runs with a few literal bytes.
+ *
+ * The applier never holds more than one patch read buffer: DeltaSource is
+ * an IChunkSource that produces target bytes from the patch body and
+ * IRunningImage reads, so the pipeline writes (and hashes) them exactly as
+ * it would a full image. The base's size and SHA-256 are checked before
+ * the slot is opened and the target's SHA-256 before it is selected, so a
+ * patch made against another build never boots.
+ */
+
+#ifndef WATERINGSYSTEM_API_DELTAPATCH_H
+#define WATERINGSYSTEM_API_DELTAPATCH_H
+
+#include <cstddef>
+#include <cstdint>
+
+#include "api/OtaPipeline.h"
+#include "api/Sha256.h"
+#include "interfaces/IRunningImage.h"
+
+namespace api {
+
+/// Fixed header ahead of the ops.
+constexpr std::size_t kDeltaHeaderBytes = 80;
+
+struct DeltaHeader {
+    uint32_t targetBytes = 0;
+    uint32_t baseBytes = 0;
+    Sha256::Digest baseSha256{};
+    Sha256::Digest targetSha256{};
+};
+
+/// True when @p data (@p len bytes) starts with the patch magic.
+bool isDeltaPatch(const uint8_t* data, std::size_t len);
+
+/// Parse a complete header; false on a short buffer, a wrong magic or
+/// version, or a zero size.
+bool parseDeltaHeader(const uint8_t* data, std::size_t len, DeltaHeader& out);
+
+/**
+ * @brief The target image, produced from a patch body and the base.
+ *
+ * receive() fills exactly what it is asked for (the pipeline never asks
+ * past the target size) and returns -1 on a malformed patch — malformed()
+ * is then true — or when the patch source or a base read fails.
+ */
+class DeltaSource final : public IChunkSource {
+public:
+    /// Ops follow in @p patch (@p patchBytes of them, header excluded);
+    /// base reads stay within @p baseBytes.
+    DeltaSource(IChunkSource& patch, std::size_t patchBytes, IRunningImage& base,
+                std::size_t baseBytes);
+
+    DeltaSource(const DeltaSource&) = delete;
+    DeltaSource& operator=(const DeltaSource&) = delete;
+
+    int receive(uint8_t* dst, std::size_t len) override;
+
+    bool malformed() const { return malformed_; }
+
+    /// Patch bytes taken from the source so far.
+    std::size_t received() const { return patchBytes_ - patchLeft_; }
+
+private:
+    enum class Op : uint8_t { Data, Diff };
+
+    bool fill();
+    bool byte(uint8_t& out);
+    bool take(uint8_t* dst, std::size_t len);
+    bool varint(uint32_t& out);
+    bool startOp();
+    bool applyDiff(uint8_t* out, std::size_t len);
+    bool bad();
+
+    IChunkSource& patch_;
+    const std::size_t patchBytes_;
+    std::size_t patchLeft_;
+    IRunningImage& base_;
+    const std::size_t baseBytes_;
+
+    uint8_t buf_[256];
+    std::size_t bufPos_ = 0;
+    std::size_t bufLen_ = 0;
+
+    Op op_ = Op::Data;
+    std::size_t opLeft_ = 0;
+    std::size_t basePos_ = 0;
+    uint32_t zeros_ = 0;  ///< of the current DIFF run, still to skip
+    uint32_t lits_ = 0;   ///< of the current DIFF run, still to add
+    bool malformed_ = false;
+};
+
+}  // namespace api
+
+#endif /* WATERINGSYSTEM_API_DELTAPATCH_H */
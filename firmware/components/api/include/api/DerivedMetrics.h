@@ -0,0 +1,156 @@
+// SPDX-FileCopyrightText: 2026 Cryptotomte
+// SPDX-License-Identifier: AGPL-3.0-or-later
+/**
+ * @file DerivedMetrics.h
+ * @brief Virtual /history metrics computed on device from two logged ones
+ *        (host+target).
+ *
+ * METRICS: `env_vpd` (vapour-pressure deficit, kPa) and `env_dew_point`
+ * (degC), both from env_temperature and env_humidity (Magnus-Tetens).
+ * Nothing is stored for them: a chart asks for one series instead of
+ * downloading both inputs and joining them itself.
+ *
+ * JOIN: the inputs are merged by epoch, each a stream of at most
+ * kBatchReadings readings refilled by one forEachReading() pass through a
+ * ReadingPager from its cursor (the CsvExport merge). Every epoch at which
+ * either input has a reading yields one derived reading from the newest
+ * value of each, provided neither is more than `holdS` older — so a
+ * change-only input is held across its silent stretch, but a gap in the
+ * log (the device was off) is a gap in the derived series too. Two
+ * readings of one input at one epoch count as the later. The streams
+ * start holdS before the window so its first readings have partners. RAM
+ * is the two batches, whatever the window.
+ *
+ * DerivedMetricStorage is an IDataStorage view for the API's reads: a
+ * derived name is answered by the join (aggregates, stats, percentiles and
+ * the newest-N read folded from it by the IDataStorage defaults); every
+ * other name, and every write, goes straight to the wrapped storage. A
+ * derived name shadows a stored metric of the same name.
+ */
+
+#ifndef WATERINGSYSTEM_API_DERIVEDMETRICS_H
+#define WATERINGSYSTEM_API_DERIVEDMETRICS_H
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "interfaces/IDataStorage.h"
+
+namespace api {
+
+/// A metric computed from two logged ones.
+struct DerivedMetric {
+    const char* name;
+    const char* a;  ///< first input (compute()'s first argument)
+    const char* b;
+    /// False when the inputs give no value (out of the formula's range).
+    bool (*compute)(float a, float b, float& out);
+};
+
+constexpr std::size_t kDerivedMetricCount = 2;
+extern const DerivedMetric kDerivedMetrics[kDerivedMetricCount];
+
+/// The derived metric named @p name; nullptr for a logged (or unknown) one.
+const DerivedMetric* findDerivedMetric(std::string_view name);
+
+/// Vapour-pressure deficit in kPa at @p tempC and @p rhPct (clamped to
+/// 0..100 %RH).
+float vaporPressureDeficitKpa(float tempC, float rhPct);
+
+/// Dew point in degC; false at 0 %RH or below.
+bool dewPointC(float tempC, float rhPct, float& out);
+
+class DerivedMetricStorage final : public IDataStorage {
+public:
+    /// Readings held per input between storage passes (8 bytes each).
+    static constexpr std::size_t kBatchReadings = 64;
+
+    /// @p storage must outlive the view; @p holdS is the oldest an input's
+    /// value may be and still join (its longest logging gap).
+    DerivedMetricStorage(IDataStorage& storage, uint32_t holdS)
+        : storage_(storage), holdS_(holdS)
+    {
+    }
+
+    std::size_t forEachReading(const std::string& metric, uint32_t t0, uint32_t t1,
+                               IReadingVisitor& visitor) const override;
+    std::vector<SensorReading> getSensorReadings(const std::string& metric, uint32_t t0,
+                                                 uint32_t t1) const override;
+    std::vector<SensorAggregate> getSensorAggregates(const std::string& metric, uint32_t t0,
+                                                     uint32_t t1,
+                                                     uint32_t bucketS) const override;
+    SensorWindowStats getSensorWindowStats(const std::string& metric, uint32_t t0,
+                                           uint32_t t1) const override;
+    QuantileSketch getSensorQuantiles(const std::string& metric, uint32_t t0,
+                                      uint32_t t1) const override;
+    LatestReading latestReading(const std::string& metric) const override;
+    std::vector<SensorReading> getLatestReadings(const std::string& metric,
+                                                 std::size_t n) const override;
+
+    // Writes, events and stats: the wrapped storage's.
+    bool storeSensorReading(const std::string& metric, uint32_t epoch, float value) override
+    {
+        return storage_.storeSensorReading(metric, epoch, value);
+    }
+    std::size_t storeSensorReadings(const SensorReading* readings, std::size_t count) override
+    {
+        return storage_.storeSensorReadings(readings, count);
+    }
+    std::size_t storeSamples(const MetricSample* samples, std::size_t count) override
+    {
+        return storage_.storeSamples(samples, count);
+    }
+    bool storeEvent(uint32_t epoch, uint8_t category, std::string_view detail) override
+    {
+        return storage_.storeEvent(epoch, category, detail);
+    }
+    std::vector<EventRecord> getEvents(std::size_t maxCount) const override
+    {
+        return storage_.getEvents(maxCount);
+    }
+    EventPage queryEvents(const EventQuery& query) const override
+    {
+        return storage_.queryEvents(query);
+    }
+    StorageStats getStorageStats() const override { return storage_.getStorageStats(); }
+    bool flush() override { return storage_.flush(); }
+    bool flushIfDue() override { return storage_.flushIfDue(); }
+    bool maintain() override { return storage_.maintain(); }
+
+private:
+    struct Reading {
+        uint32_t epoch;
+        float value;
+    };
+
+    /// One input's readings, a batch at a time.
+    struct Stream {
+        const char* metric = nullptr;
+        ReadingCursor cursor;  ///< where the next batch starts
+        bool more = true;      ///< the storage may hold readings past cursor
+        std::size_t head = 0;
+        std::size_t count = 0;
+        std::array<Reading, kBatchReadings> batch;
+        bool have = false;  ///< `last` holds a reading
+        Reading last{};     ///< newest reading taken
+    };
+
+    /// Whether @p s has a head reading, reading its next batch if needed.
+    bool ready(Stream& s, uint32_t t1) const;
+    /// Take @p s's readings stamped @p epoch into its `last`.
+    static void take(Stream& s, uint32_t epoch);
+    /// The join of @p derived over [t0, t1] into @p visitor.
+    std::size_t join(const DerivedMetric& derived, uint32_t t0, uint32_t t1,
+                     IReadingVisitor& visitor) const;
+
+    IDataStorage& storage_;
+    uint32_t holdS_;
+};
+
+}  // namespace api
+
+#endif /* WATERINGSYSTEM_API_DERIVEDMETRICS_H */
@@ -0,0 +1,53 @@
+// SPDX-FileCopyrightText: 2026 Cryptotomte
+// SPDX-License-Identifier: AGPL-3.0-or-later
+/**
+ * @file EspFirmwareSlot.h
+ * @brief Target-only IFirmwareSlot over esp_ota_ops.
+ *
+ * The only esp_ota code behind OtaPipeline: the slot is the app partition
+ * esp_ota_get_next_update_partition() names (ota_0/ota_1,
+ * firmware/partitions.csv, whichever is not running). begin() opens it
+ * with OTA_WITH_SEQUENTIAL_WRITES, so esp_ota_write() erases each sector
+ * just before it programs it instead of erasing the whole slot up front;
+ * commit() is esp_ota_end() (image validation) plus
+ * esp_ota_set_boot_partition().
+ *
+ * PRIV rule (same as ApiServer): esp_ota_ops.h appears only in the .cpp;
+ * the partition and handle are held here as opaque values. NOT built for
+ * the linux preview target — the host tests run the pipeline over a fake
+ * slot. Contains no logic beyond the IDF calls.
+ */
+
+#ifndef WATERINGSYSTEM_API_ESPFIRMWARESLOT_H
+#define WATERINGSYSTEM_API_ESPFIRMWARESLOT_H
+
+#include <cstddef>
+#include <cstdint>
+
+#include "interfaces/IFirmwareSlot.h"
+
+namespace api {
+
+class EspFirmwareSlot : public IFirmwareSlot {
+public:
+    /// Finds the update partition; capacity() is 0 without one.
+    EspFirmwareSlot();
+
+    EspFirmwareSlot(const EspFirmwareSlot&) = delete;
+    EspFirmwareSlot& operator=(const EspFirmwareSlot&) = delete;
+
+    std::size_t capacity() const override;
+    bool begin(std::size_t imageBytes) override;
+    bool write(const uint8_t* data, std::size_t len) override;
+    bool commit() override;
+    void abort() override;
+
+private:
+    const void* partition_ = nullptr;  ///< esp_partition_t
+    uint32_t handle_ = 0;              ///< esp_ota_handle_t
+    bool open_ = false;
+};
+
+}  // namespace api
+
+#endif /* WATERINGSYSTEM_API_ESPFIRMWARESLOT_H */
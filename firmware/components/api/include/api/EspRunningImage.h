@@ -0,0 +1,52 @@
+// SPDX-FileCopyrightText: 2026 Cryptotomte
+// SPDX-License-Identifier: AGPL-3.0-or-later
+/**
+ * @file EspRunningImage.h
+ * @brief Target-only IRunningImage over the running app partition.
+ *
+ * The base of a delta OTA patch (api/DeltaPatch.h). size() is the image
+ * length esp_image_get_metadata() reports — header, segments, checksum
+ * padding and appended digest, i.e. the .bin as built — and sha256() is
+ * api::Sha256 over those bytes, so it equals a plain SHA-256 of the .bin
+ * that tools/make_delta.py was given. Both are worked out on first use
+ * (one pass over the image, ~1.5 MiB of flash reads) and kept.
+ *
+ * PRIV rule (same as EspFirmwareSlot): the partition is an opaque pointer
+ * here. NOT built for the linux preview target. Contains no logic beyond
+ * the IDF calls.
+ */
+
+#ifndef WATERINGSYSTEM_API_ESPRUNNINGIMAGE_H
+#define WATERINGSYSTEM_API_ESPRUNNINGIMAGE_H
+
+#include <cstddef>
+#include <cstdint>
+
+#include "api/Sha256.h"
+#include "interfaces/IRunningImage.h"
+
+namespace api {
+
+class EspRunningImage : public IRunningImage {
+public:
+    /// The partition esp_ota_get_running_partition() names.
+    EspRunningImage();
+
+    EspRunningImage(const EspRunningImage&) = delete;
+    EspRunningImage& operator=(const EspRunningImage&) = delete;
+
+    std::size_t size() override;
+    bool sha256(uint8_t out[32]) override;
+    bool read(std::size_t offset, uint8_t* dst, std::size_t len) override;
+
+private:
+    const void* partition_ = nullptr;  ///< esp_partition_t
+    std::size_t size_ = 0;
+    bool measured_ = false;
+    bool hashed_ = false;
+    Sha256::Digest digest_{};
+};
+
+}  // namespace api
+
+#endif /* WATERINGSYSTEM_API_ESPRUNNINGIMAGE_H */
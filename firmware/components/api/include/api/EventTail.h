@@ -0,0 +1,59 @@
+// SPDX-FileCopyrightText: 2026 Cryptotomte
+// SPDX-License-Identifier: AGPL-3.0-or-later
+/**
+ * @file EventTail.h
+ * @brief The events past a client's tail cursor: GET /api/v1/events?after=
+ *        (host+target).
+ *
+ * WHY THIS EXISTS: an alerting client polled /api/v1/events?count= every
+ * few seconds and mostly got back what it already had. With `after` it
+ * names where its copy ends and gets only what came since; with `wait` the
+ * server holds the request (ApiServer's event-wait worker, woken by
+ * EventNotifier) until something does.
+ *
+ * CURSOR: the same "<epoch>.<skip>" text as the paging cursor
+ * (formatEventCursor()), read the other way: the client has every event
+ * up to `epoch`, the first `skip` of those stamped exactly `epoch`
+ * included. Each response carries the next one as `tail`; "0.0" starts
+ * from nothing (the newest `count` events). The skip counts the events the
+ * request's category filter selects, so keep the filter across calls.
+ *
+ * ONE QUERY: eventTailQuery() asks for the events at or after the cursor's
+ * epoch, `count` plus the already-seen ones; resolveEventTail() drops the
+ * seen ones off the old end. More than `count` new events is reported as
+ * `truncated`: the newest `count` are returned and the older new ones are
+ * left to a since/until query.
+ */
+
+#ifndef WATERINGSYSTEM_API_EVENTTAIL_H
+#define WATERINGSYSTEM_API_EVENTTAIL_H
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+#include "interfaces/IDataStorage.h"
+
+namespace api {
+
+/// Seen events at the cursor's epoch a query makes room for; a larger skip
+/// (a clock stuck on one second) may return a few of them again.
+constexpr uint32_t kEventTailMaxSkip = 256;
+
+/// What a tail query returns.
+struct EventTail {
+    std::vector<EventRecord> events;  ///< newest first, all past the cursor
+    EventCursor tail;                 ///< the `after` of the next call
+    bool truncated = false;           ///< older new events were left out
+};
+
+/// The query behind a tail read past @p after, @p count events at most.
+EventQuery eventTailQuery(const EventCursor& after, uint32_t categoryMask,
+                          std::size_t count);
+
+/// Fold the page of eventTailQuery(@p after, ..., @p count) into the tail.
+EventTail resolveEventTail(EventPage page, const EventCursor& after, std::size_t count);
+
+}  // namespace api
+
+#endif /* WATERINGSYSTEM_API_EVENTTAIL_H */
@@ -0,0 +1,103 @@
+// SPDX-FileCopyrightText: 2026 Cryptotomte
+// SPDX-License-Identifier: AGPL-3.0-or-later
+/**
+ * @file HttpdPresets.h
+ * @brief Named HttpdSettings for the ways the API is used (header-only,
+ *        host+target).
+ *
+ * The build's httpd defaults hold seven sessions and purge the idlest for
+ * a new one. That fits one dashboard; with the live stream and several
+ * dashboards open — a browser keeps up to six connections per host — the
+ * purge closes sessions that are about to be reused and each comes back
+ * with a new TCP (and TLS) handshake. A preset sizes the server for its
+ * load instead:
+ *
+ *  - single: one dashboard (its stream and a few fetches); small, purge on.
+ *  - multi: several dashboards and streams; every socket the build allows,
+ *    a deeper backlog for page-load bursts, purge on as the last resort,
+ *    a longer send timeout for a stream client on a slow link.
+ *  - collector: a few long-lived keep-alive pollers (Prometheus, a
+ *    bridge); purge off, so a burst past the cap is refused instead of
+ *    closing a collector's session, and long timeouts.
+ *
+ * The stack does not grow with the clients — one httpd task serves them
+ * all — so every preset keeps the 4 KiB the handlers are sized for (start()
+ * raises it to the TLS default under HTTPS). Stored through
+ * IConfigStore::setHttpdSettings() (`config httpd <preset>`), applied at
+ * the next server start; wateringsystem_http_sessions_opened_total shows
+ * the churn.
+ */
+
+#ifndef WATERINGSYSTEM_API_HTTPDPRESETS_H
+#define WATERINGSYSTEM_API_HTTPDPRESETS_H
+
+#include <cstring>
+#include <initializer_list>
+
+#include "interfaces/IConfigStore.h"
+
+namespace api {
+
+enum class HttpdPreset {
+    Single,
+    Multi,
+    Collector,
+};
+
+/// The settings of @p preset (valid: IConfigStore::isValidHttpdSettings()).
+constexpr HttpdSettings httpdPresetSettings(HttpdPreset preset)
+{
+    HttpdSettings h;
+    h.stackBytes = IConfigStore::kHttpdStackMinBytes;
+    switch (preset) {
+    case HttpdPreset::Single:
+        h.maxOpenSockets = 4;
+        h.backlog = 2;
+        h.recvTimeoutS = 5;
+        h.sendTimeoutS = 5;
+        h.lruPurge = true;
+        break;
+    case HttpdPreset::Multi:
+        h.maxOpenSockets = IConfigStore::kHttpdSocketsMax;
+        h.backlog = 8;
+        h.recvTimeoutS = 5;
+        h.sendTimeoutS = 15;
+        h.lruPurge = true;
+        break;
+    case HttpdPreset::Collector:
+        h.maxOpenSockets = 8;
+        h.backlog = 4;
+        h.recvTimeoutS = 30;
+        h.sendTimeoutS = 30;
+        h.lruPurge = false;
+        break;
+    }
+    return h;
+}
+
+/// Lower-case name of @p preset (console and status).
+constexpr const char* httpdPresetName(HttpdPreset preset)
+{
+    switch (preset) {
+    case HttpdPreset::Single:    return "single";
+    case HttpdPreset::Multi:     return "multi";
+    case HttpdPreset::Collector: return "collector";
+    }
+    return "?";
+}
+
+/// The preset called @p name; false for none.
+inline bool parseHttpdPreset(const char* name, HttpdPreset& out)
+{
+    for (HttpdPreset p : {HttpdPreset::Single, HttpdPreset::Multi, HttpdPreset::Collector}) {
+        if (std::strcmp(name, httpdPresetName(p)) == 0) {
+            out = p;
+            return true;
+        }
+    }
+    return false;
+}
+
+}  // namespace api
+
+#endif /* WATERINGSYSTEM_API_HTTPDPRESETS_H */
@@ -0,0 +1,114 @@
+// SPDX-FileCopyrightText: 2026 Cryptotomte
+// SPDX-License-Identifier: AGPL-3.0-or-later
+/**
+ * @file JsonScanner.h
+ * @brief Fixed-token, zero-copy JSON scanner for request bodies (host+target).
+ *
+ * The POST bodies (pump commands, config sets) are a few hundred bytes and
+ * the parsers read a handful of fields from them, so building a cJSON tree
+ * — a heap block per value and per key — is all overhead. JsonScanner
+ * validates the whole text (RFC 8259 grammar, nothing trailing) and records
+ * one Token per value in an array it owns: no allocation, and the text is
+ * referenced, never copied. Strings keep their escaped form; equals() and
+ * copyString() decode on the fly.
+ *
+ * Tokens are stored in document order with an object's key and value as
+ * consecutive tokens, so a container's children are the tokens between it
+ * and its `next`. More than kMaxTokens values or nesting past kMaxDepth is
+ * a failed parse (full() tells the two failures apart) — the request body
+ * cap keeps real bodies far below both.
+ *
+ * The scanned text must outlive the scanner. PURE C++, host-tested.
+ */
+
+#ifndef WATERINGSYSTEM_API_JSONSCANNER_H
+#define WATERINGSYSTEM_API_JSONSCANNER_H
+
+#include <cstddef>
+#include <cstdint>
+#include <string_view>
+
+namespace api {
+
+class JsonScanner {
+public:
+    enum class Type : uint8_t { Object, Array, String, Number, True, False, Null };
+
+    /// Values one body may hold (a key counts as one).
+    static constexpr std::size_t kMaxTokens = 64;
+    /// Containers one body may nest.
+    static constexpr std::size_t kMaxDepth = 8;
+    /// "No such token" from the lookups.
+    static constexpr std::size_t kNone = SIZE_MAX;
+
+    /**
+     * @brief Tokenize @p text; true when it is exactly one JSON value.
+     *
+     * On false the tokens are unusable; full() says whether the text ran
+     * out of tokens (or was longer than 64 KiB) rather than being malformed.
+     */
+    bool parse(std::string_view text);
+
+    /// Did the last parse() fail on a size limit, not on the grammar?
+    bool full() const { return full_; }
+
+    /// The top-level value (after a successful parse()).
+    static constexpr std::size_t root() { return 0; }
+
+    Type type(std::size_t token) const { return tokens_[token].type; }
+    bool isBool(std::size_t token) const
+    {
+        return type(token) == Type::True || type(token) == Type::False;
+    }
+
+    /// The value of the first member of @p object named @p key, or kNone
+    /// (also when @p object is not an object).
+    std::size_t member(std::size_t object, std::string_view key) const;
+
+    /// Key token of the first member of @p object, or kNone. Its value is
+    /// the next token.
+    std::size_t firstMember(std::size_t object) const;
+    /// Key token of the member after @p key in @p object, or kNone.
+    std::size_t nextMember(std::size_t object, std::size_t key) const;
+
+    /// A Number token as a double; false for another type or a literal
+    /// longer than this scanner reads (kMaxNumberLen).
+    bool number(std::size_t token, double& out) const;
+
+    /// Does the String token @p token decode to exactly @p text?
+    bool equals(std::size_t token, std::string_view text) const;
+
+    /// Decode the String token @p token into @p out (NUL-terminated);
+    /// false when it is not a string or needs @p cap bytes or more.
+    bool copyString(std::size_t token, char* out, std::size_t cap,
+                    std::size_t& len) const;
+
+private:
+    static constexpr std::size_t kMaxNumberLen = 40;
+
+    struct Token {
+        uint16_t begin;  ///< first byte (a string: after the quote)
+        uint16_t end;    ///< one past the last (a string: the closing quote)
+        uint16_t next;   ///< index of the first token after this subtree
+        Type type;
+    };
+
+    bool value(std::size_t& pos, std::size_t depth);
+    bool container(std::size_t& pos, std::size_t depth, Type type);
+    bool stringToken(std::size_t& pos);
+    bool numberToken(std::size_t& pos);
+    bool literal(std::size_t& pos, std::string_view word, Type type);
+    void skipSpace(std::size_t& pos) const;
+    std::size_t push(Type type, std::size_t begin);
+    void finish(std::size_t token, std::size_t end);
+    std::string_view raw(std::size_t token) const;
+
+    std::string_view text_;
+    Token tokens_[kMaxTokens] = {};
+    std::size_t count_ = 0;
+    bool full_ = false;
+};
+
+}  // namespace api
+
+#endif /* WATERINGSYSTEM_API_JSONSCANNER_H */
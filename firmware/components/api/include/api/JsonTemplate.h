@@ -0,0 +1,487 @@
+// SPDX-FileCopyrightText: 2026 Cryptotomte
+// SPDX-License-Identifier: AGPL-3.0-or-later
+/**
+ * @file JsonTemplate.h
+ * @brief Compile-time JSON templates over a caller-supplied buffer
+ *        (host+target).
+ *
+ * The small read bodies (/status, /sensors, /pumps, /power) have a fixed
+ * shape: the same keys in the same order every time, only the values move.
+ * Building them through cJSON costs a node and a key copy per field plus the
+ * printed string — dozens of small heap blocks on the httpd task for a body
+ * of a few hundred bytes. Here the shape is a `constexpr` list of typed
+ * fields (key + member pointer or getter), and emitting it walks that list
+ * into a stack buffer: no allocation, no tree.
+ *
+ * Scalars are formatted exactly as cJSON prints them (formatJsonNumber(),
+ * escapeJsonString()), non-finite numbers as `null`; a reading with a set
+ * number of decimals (formatJsonFixed()) exactly as cJSON prints the same
+ * value rounded by roundJsonDecimals(). So a template body is
+ * byte-identical to its cJSON serializer (host-tested in
+ * test_api_serialize.cpp); JsonStreamWriter shares the same two helpers.
+ * A body that does not fit the buffer reports 0 and the caller falls back
+ * to the cJSON serializer.
+ *
+ * Field kinds (all aggregates, so a shape is a constant expression):
+ *   field(key, get)            scalar: bool, arithmetic, std::string,
+ *                              std::optional<scalar> (empty = null)
+ *   fixed(key, get, decimals)  number with at most @p decimals fraction
+ *                              digits (formatJsonFixed())
+ *   object(key, get, shape)    nested object
+ *   array(key, get, shape)     array of objects
+ *   custom(key, write)         value written by write(out, dto)
+ *   spread(get, shape)         @p shape's members inline, no key
+ *   when(pred, f)              @p f only when pred(dto) holds
+ *   orNull(pred, f)            @p f's value, or null when pred(dto) fails
+ * `get` is a data member pointer or a callable taking the DTO.
+ */
+
+#ifndef WATERINGSYSTEM_API_JSONTEMPLATE_H
+#define WATERINGSYSTEM_API_JSONTEMPLATE_H
+
+#include <cstddef>
+#include <cstdio>
+#include <cstring>
+#include <functional>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <tuple>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+namespace api {
+
+/// Buffer size formatJsonNumber() needs, terminator included.
+constexpr std::size_t kJsonNumberChars = 32;
+
+/**
+ * @brief Format @p value as cJSON's printer does: an integral value that
+ * fits an int as %d, anything else as the shortest of %1.15g / %1.17g that
+ * reads back exactly, a non-finite value as `null`.
+ * @return characters written to @p out (kJsonNumberChars bytes)
+ */
+std::size_t formatJsonNumber(double value, char* out);
+
+/// Most fraction digits roundJsonDecimals() / formatJsonFixed() apply.
+/// Up to here a rounded value never takes %g's exponent form, which is
+/// what keeps the two byte-identical.
+constexpr int kMaxJsonDecimals = 4;
+
+/**
+ * @brief @p value rounded half away from zero to @p decimals fraction
+ * digits: the double nearest that decimal, which cJSON then prints short
+ * (23.4f as `23.4`, not `23.399999618530273`).
+ *
+ * A negative @p decimals, a non-finite value or one too large to scale
+ * (|value| * 10^decimals >= 1e15) comes back unchanged.
+ */
+double roundJsonDecimals(double value, int decimals);
+
+/**
+ * @brief formatJsonNumber(roundJsonDecimals(@p value, @p decimals)),
+ * byte for byte, by integer arithmetic instead of printf/sscanf.
+ *
+ * Trailing zeros of the fraction are dropped, as cJSON drops them
+ * (21.50 at 2 decimals is `21.5`, 12.0 is `12`). What roundJsonDecimals()
+ * leaves unchanged goes through formatJsonNumber().
+ * @return characters written to @p out (kJsonNumberChars bytes)
+ */
+std::size_t formatJsonFixed(double value, int decimals, char* out);
+
+/// Emit @p text as a quoted JSON string with cJSON's escapes, in pieces
+/// through @p put(const char*, std::size_t).
+template <typename Put>
+void escapeJsonString(std::string_view text, Put&& put)
+{
+    put("\"", 1);
+    std::size_t run = 0;  // start of the pending unescaped run
+    for (std::size_t i = 0; i < text.size(); ++i) {
+        const unsigned char c = static_cast<unsigned char>(text[i]);
+        const char* esc = nullptr;
+        switch (c) {
+        case '"':
+            esc = "\\\"";
+            break;
+        case '\\':
+            esc = "\\\\";
+            break;
+        case '\b':
+            esc = "\\b";
+            break;
+        case '\f':
+            esc = "\\f";
+            break;
+        case '\n':
+            esc = "\\n";
+            break;
+        case '\r':
+            esc = "\\r";
+            break;
+        case '\t':
+            esc = "\\t";
+            break;
+        default:
+            if (c >= 32) {
+                continue;
+            }
+        }
+        if (i > run) {
+            put(text.data() + run, i - run);
+        }
+        if (esc != nullptr) {
+            put(esc, 2);
+        } else {
+            char hex[8];
+            std::snprintf(hex, sizeof(hex), "\\u%04x", c);
+            put(hex, 6);
+        }
+        run = i + 1;
+    }
+    if (text.size() > run) {
+        put(text.data() + run, text.size() - run);
+    }
+    put("\"", 1);
+}
+
+/**
+ * @brief JSON tokens into a fixed, caller-owned buffer.
+ *
+ * Past the end of the buffer nothing more is written and size() reports 0
+ * for good: a truncated body is never sent.
+ */
+class FixedJsonWriter {
+public:
+    FixedJsonWriter(char* buf, std::size_t cap) : buf_(buf), cap_(cap) {}
+
+    FixedJsonWriter(const FixedJsonWriter&) = delete;
+    FixedJsonWriter& operator=(const FixedJsonWriter&) = delete;
+
+    /// Append @p text verbatim.
+    void raw(std::string_view text) { put(text.data(), text.size()); }
+    /// Append @p text as a quoted, escaped JSON string.
+    void string(std::string_view text)
+    {
+        escapeJsonString(text, [this](const char* p, std::size_t n) { put(p, n); });
+    }
+    /// Append a number as cJSON prints it; non-finite becomes null.
+    void number(double value)
+    {
+        char text[kJsonNumberChars];
+        put(text, formatJsonNumber(value, text));
+    }
+    /// Append a number with at most @p decimals fraction digits
+    /// (formatJsonFixed()).
+    void fixed(double value, int decimals)
+    {
+        char text[kJsonNumberChars];
+        put(text, formatJsonFixed(value, decimals, text));
+    }
+    void boolean(bool value) { raw(value ? "true" : "false"); }
+    void null() { raw("null"); }
+
+    /// `,"key":` — the comma unless this is the object's @p first member.
+    void key(std::string_view name, bool& first)
+    {
+        if (!first) {
+            raw(",");
+        }
+        first = false;
+        string(name);
+        raw(":");
+    }
+
+    /// Bytes written; 0 once anything did not fit.
+    std::size_t size() const { return ok_ ? used_ : 0; }
+
+private:
+    void put(const char* data, std::size_t len)
+    {
+        if (!ok_ || len > cap_ - used_) {
+            ok_ = false;
+            return;
+        }
+        std::memcpy(buf_ + used_, data, len);
+        used_ += len;
+    }
+
+    char* buf_;
+    std::size_t cap_;
+    std::size_t used_ = 0;
+    bool ok_ = true;
+};
+
+namespace json {
+
+/// An ordered, typed field list: the compile-time shape of one object.
+template <typename... Fields>
+struct Shape {
+    std::tuple<Fields...> fields;
+};
+
+template <typename... Fields>
+constexpr Shape<Fields...> shape(Fields... fields)
+{
+    return Shape<Fields...>{std::tuple<Fields...>(fields...)};
+}
+
+template <typename Dto, typename... Fields>
+void writeObject(FixedJsonWriter& out, const Dto& dto, const Shape<Fields...>& s);
+template <typename Dto, typename... Fields>
+void writeMembers(FixedJsonWriter& out, const Dto& dto, const Shape<Fields...>& s,
+                  bool& first);
+
+// -- Scalars ------------------------------------------------------------------
+
+inline void writeScalar(FixedJsonWriter& out, bool value) { out.boolean(value); }
+inline void writeScalar(FixedJsonWriter& out, const std::string& value) { out.string(value); }
+inline void writeScalar(FixedJsonWriter& out, std::nullptr_t) { out.null(); }
+
+template <typename T,
+          std::enable_if_t<std::is_arithmetic_v<T> && !std::is_same_v<T, bool>, int> = 0>
+void writeScalar(FixedJsonWriter& out, T value)
+{
+    out.number(static_cast<double>(value));
+}
+
+template <typename T>
+void writeScalar(FixedJsonWriter& out, const std::optional<T>& value)
+{
+    if (value.has_value()) {
+        writeScalar(out, *value);
+    } else {
+        out.null();
+    }
+}
+
+// -- Field kinds --------------------------------------------------------------
+
+template <typename Get>
+struct ScalarField {
+    std::string_view key;
+    Get get;
+
+    template <typename Dto>
+    bool present(const Dto&) const { return true; }
+    template <typename Dto>
+    void write(FixedJsonWriter& out, const Dto& dto) const
+    {
+        writeScalar(out, std::invoke(get, dto));
+    }
+};
+
+template <typename Get>
+struct FixedField {
+    std::string_view key;
+    Get get;
+    int decimals;
+
+    template <typename Dto>
+    bool present(const Dto&) const { return true; }
+    template <typename Dto>
+    void write(FixedJsonWriter& out, const Dto& dto) const
+    {
+        out.fixed(static_cast<double>(std::invoke(get, dto)), decimals);
+    }
+};
+
+template <typename Get, typename S>
+struct ObjectField {
+    std::string_view key;
+    Get get;
+    S shape;
+
+    template <typename Dto>
+    bool present(const Dto&) const { return true; }
+    template <typename Dto>
+    void write(FixedJsonWriter& out, const Dto& dto) const
+    {
+        writeObject(out, std::invoke(get, dto), shape);
+    }
+};
+
+template <typename Get, typename S>
+struct ArrayField {
+    std::string_view key;
+    Get get;
+    S shape;
+
+    template <typename Dto>
+    bool present(const Dto&) const { return true; }
+    template <typename Dto>
+    void write(FixedJsonWriter& out, const Dto& dto) const
+    {
+        out.raw("[");
+        bool first = true;
+        for (const auto& item : std::invoke(get, dto)) {
+            if (!first) {
+                out.raw(",");
+            }
+            first = false;
+            writeObject(out, item, shape);
+        }
+        out.raw("]");
+    }
+};
+
+template <typename Write>
+struct CustomField {
+    std::string_view key;
+    Write writeValue;
+
+    template <typename Dto>
+    bool present(const Dto&) const { return true; }
+    template <typename Dto>
+    void write(FixedJsonWriter& out, const Dto& dto) const
+    {
+        writeValue(out, dto);
+    }
+};
+
+template <typename Pred, typename Field>
+struct WhenField {
+    std::string_view key;
+    Pred pred;
+    Field field;
+
+    template <typename Dto>
+    bool present(const Dto& dto) const { return pred(dto) && field.present(dto); }
+    template <typename Dto>
+    void write(FixedJsonWriter& out, const Dto& dto) const
+    {
+        field.write(out, dto);
+    }
+};
+
+template <typename Pred, typename Field>
+struct OrNullField {
+    std::string_view key;
+    Pred pred;
+    Field field;
+
+    template <typename Dto>
+    bool present(const Dto& dto) const { return field.present(dto); }
+    template <typename Dto>
+    void write(FixedJsonWriter& out, const Dto& dto) const
+    {
+        if (pred(dto)) {
+            field.write(out, dto);
+        } else {
+            out.null();
+        }
+    }
+};
+
+template <typename Get, typename S>
+struct SpreadField {
+    Get get;
+    S shape;
+};
+
+template <typename Get>
+constexpr ScalarField<Get> field(std::string_view key, Get get)
+{
+    return {key, get};
+}
+
+template <typename Get>
+constexpr FixedField<Get> fixed(std::string_view key, Get get, int decimals)
+{
+    return {key, get, decimals};
+}
+
+template <typename Get, typename S>
+constexpr ObjectField<Get, S> object(std::string_view key, Get get, S s)
+{
+    return {key, get, s};
+}
+
+template <typename Get, typename S>
+constexpr ArrayField<Get, S> array(std::string_view key, Get get, S s)
+{
+    return {key, get, s};
+}
+
+template <typename Write>
+constexpr CustomField<Write> custom(std::string_view key, Write write)
+{
+    return {key, write};
+}
+
+template <typename Get, typename S>
+constexpr SpreadField<Get, S> spread(Get get, S s)
+{
+    return {get, s};
+}
+
+template <typename Pred, typename Field>
+constexpr WhenField<Pred, Field> when(Pred pred, Field f)
+{
+    return {f.key, pred, f};
+}
+
+template <typename Pred, typename Field>
+constexpr OrNullField<Pred, Field> orNull(Pred pred, Field f)
+{
+    return {f.key, pred, f};
+}
+
+// -- Emission -----------------------------------------------------------------
+
+template <typename Dto, typename Field>
+void writeMember(FixedJsonWriter& out, const Dto& dto, const Field& f, bool& first)
+{
+    if (f.present(dto)) {
+        out.key(f.key, first);
+        f.write(out, dto);
+    }
+}
+
+template <typename Dto, typename Get, typename S>
+void writeMember(FixedJsonWriter& out, const Dto& dto, const SpreadField<Get, S>& f,
+                 bool& first)
+{
+    writeMembers(out, std::invoke(f.get, dto), f.shape, first);
+}
+
+/// @p s's members of @p dto, comma-placed after any already written.
+template <typename Dto, typename... Fields>
+void writeMembers(FixedJsonWriter& out, const Dto& dto, const Shape<Fields...>& s,
+                  bool& first)
+{
+    std::apply([&](const Fields&... f) { (writeMember(out, dto, f, first), ...); },
+               s.fields);
+}
+
+template <typename Dto, typename... Fields>
+void writeObject(FixedJsonWriter& out, const Dto& dto, const Shape<Fields...>& s)
+{
+    out.raw("{");
+    bool first = true;
+    writeMembers(out, dto, s, first);
+    out.raw("}");
+}
+
+/**
+ * @brief Render @p dto as a success envelope body: `{"success":true,` then
+ * @p s's members — what successBody() makes of the same payload object.
+ * @return bytes written to @p buf; 0 when the body does not fit @p cap
+ */
+template <typename Dto, typename... Fields>
+std::size_t renderEnvelope(const Dto& dto, const Shape<Fields...>& s, char* buf,
+                           std::size_t cap)
+{
+    FixedJsonWriter out(buf, cap);
+    out.raw("{\"success\":true");
+    bool first = false;
+    writeMembers(out, dto, s, first);
+    out.raw("}");
+    return out.size();
+}
+
+}  // namespace json
+
+}  // namespace api
+
+#endif /* WATERINGSYSTEM_API_JSONTEMPLATE_H */
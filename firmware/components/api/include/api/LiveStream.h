@@ -0,0 +1,134 @@
+// SPDX-FileCopyrightText: 2026 Cryptotomte
+// SPDX-License-Identifier: AGPL-3.0-or-later
+/**
+ * @file LiveStream.h
+ * @brief Live telemetry push for GET /api/v1/stream (host+target).
+ *
+ * A dashboard tab polling /status, /sensors and /pumps every few seconds
+ * costs several requests per tab per poll. /api/v1/stream is one WebSocket
+ * per tab instead, carrying compact delta messages (ApiSerialize.h):
+ *   - `sensors`: the sections (environmental/soil/level/power) whose values
+ *     changed — so a level mark flip is one small frame;
+ *   - `pump`: a pump started or stopped (run-time ticks are not pushed; the
+ *     client extrapolates currentRunTimeMs while `running`);
+ *   - `event`: each event the EventLogger stores (this class is its tap).
+ * A joining client first gets a full snapshot (`sensors` with `full:true`
+ * plus every pump).
+ *
+ * BACK-PRESSURE: every client has its own queue of kQueueDepth messages.
+ * Producers never wait: a full queue drops its OLDEST message, and the
+ * client is marked for a full snapshot at the next publish(), so deltas it
+ * missed are repaired rather than silently lost. A snapshot pushed into a
+ * full queue drops older messages too, but only states it restates, so it
+ * does not mark the client again.
+ *
+ * THREADS: publish() is driven by one task (the target stream task);
+ * onEvent() runs on whichever task logged the event; the transport adds,
+ * removes and drains clients on the httpd task. All hub state is behind one
+ * mutex; message building happens outside it. PURE C++ (no esp_http_server),
+ * host-tested — ApiServer.cpp owns the WebSocket plumbing.
+ */
+
+#ifndef WATERINGSYSTEM_API_LIVESTREAM_H
+#define WATERINGSYSTEM_API_LIVESTREAM_H
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <mutex>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "api/ApiDtos.h"
+#include "events/EventLogger.h"
+#include "interfaces/StaticMutex.h"
+
+namespace api {
+
+class LiveStream final : public IEventTap {
+public:
+    /// Concurrent stream clients (each one also holds an httpd socket).
+    static constexpr std::size_t kMaxClients = 3;
+    /// Messages queued per client before the oldest is dropped.
+    static constexpr std::size_t kQueueDepth = 8;
+
+    LiveStream() = default;
+
+    LiveStream(const LiveStream&) = delete;
+    LiveStream& operator=(const LiveStream&) = delete;
+
+    // -- Transport side (httpd task) -----------------------------------------
+
+    /// Register client @p id (the socket fd). False when all slots are taken
+    /// or @p id is already registered.
+    bool addClient(int id);
+    /// Forget client @p id and its queue; unknown ids are ignored.
+    void removeClient(int id);
+    std::size_t clientCount() const;
+    /// Ids of the registered clients, for a drain pass.
+    std::vector<int> clients() const;
+    /// Move the next queued message for @p id into @p out; false when none.
+    bool pop(int id, std::string& out);
+    /// True while any client has a queued message.
+    bool pending() const;
+
+    // -- Producer side --------------------------------------------------------
+
+    /**
+     * @brief Queue what changed since the previous call.
+     *
+     * Compares section and pump fingerprints (api/ApiETag.h) with the last
+     * published ones and queues the differences; a client that joined or
+     * overflowed since the last call gets a full snapshot instead. Without
+     * clients nothing is built and the baseline is dropped, so the next
+     * client starts full.
+     *
+     * @return true when anything was queued
+     */
+    bool publish(const SensorReadingsDto& sensors,
+                 const std::vector<PumpDto>& pumps);
+
+    /// IEventTap: queue an `event` message for every client.
+    void onEvent(uint32_t epoch, uint8_t category,
+                 std::string_view detail) override;
+
+    /// Messages dropped by full queues since boot, all clients together.
+    uint32_t droppedMessages() const;
+
+private:
+    struct Client {
+        int id = -1;                                 ///< -1 = free slot
+        std::array<std::string, kQueueDepth> queue;  ///< ring
+        std::size_t head = 0;
+        std::size_t size = 0;
+        bool needsFull = false;  ///< joined or overflowed since last publish
+    };
+
+    /**
+     * Queue @p message (drop-oldest) for the clients in @p ids, or for every
+     * client when @p ids is null. An overflow marks the client for a full
+     * snapshot unless @p snapshot (the message restates what was dropped).
+     * Takes the mutex.
+     */
+    void deliver(const std::string& message, const std::vector<int>* ids,
+                 bool snapshot);
+    Client* find(int id);
+    const Client* find(int id) const;
+
+    mutable StaticMutex mutex_;
+    std::array<Client, kMaxClients> clients_{};
+    uint32_t dropped_ = 0;
+
+    // Baseline of the last publish() (publisher task only, no lock).
+    bool haveBaseline_ = false;
+    uint32_t envFp_ = 0;
+    uint32_t soilFp_ = 0;
+    uint32_t levelFp_ = 0;
+    uint32_t powerFp_ = 0;
+    std::vector<uint32_t> pumpFps_;
+};
+
+}  // namespace api
+
+#endif /* WATERINGSYSTEM_API_LIVESTREAM_H */
@@ -0,0 +1,159 @@
+// SPDX-FileCopyrightText: 2026 Cryptotomte
+// SPDX-License-Identifier: AGPL-3.0-or-later
+/**
+ * @file MqttUplink.h
+ * @brief Batched MQTT telemetry publisher with history replay (host+target).
+ *
+ * A central broker collecting dozens of nodes should not poll each one's
+ * /api/v1/sensors: every node keeps one MQTT session instead and pushes.
+ * The payloads reuse the /api/v1/stream messages (ApiSerialize.h), so a
+ * consumer parses one vocabulary, wrapped in a batch envelope:
+ *   `{ type:"batch", epoch, messages:[ ... ] }`
+ * published at QoS 1 on two topics under MqttUplinkConfig::topicBase:
+ *   - `<base>/telemetry`: every batchMs a full `sensors` snapshot, preceded
+ *     by the `pump` starts/stops and `event`s seen since the last batch;
+ *   - `<base>/replay`: history read back after an outage — `readings`
+ *     pages `{ type:"readings", metric, readings:[[epoch, value], ...] }`
+ *     per metric, then `event` pages (newest first).
+ *
+ * SPOOL: the history store already keeps every data-log reading and every
+ * event, so nothing is copied while the broker is away. The uplink keeps
+ * one WATERMARK instead — the epoch through which the broker has
+ * acknowledged everything — and on the next session (with the wall clock
+ * set) replays (watermark, reconnect] from the store before moving the
+ * mark. Replayed readings have the data-log resolution, not the batch
+ * cadence. Live batches that fall due while disconnected are dropped
+ * (counted as spooled). Delivery is at-least-once: a batch whose PUBACK
+ * was lost is replayed again.
+ *
+ * BACK-PRESSURE: at most maxInflight messages await their PUBACK; a full
+ * window publishes nothing, and a replay page is read from the store only
+ * when a slot is free, so a long outage is drained at the broker's pace
+ * without holding more than one page in RAM. A live batch goes first.
+ *
+ * THREADS: tick() is driven by one task (the target mqtt task); onEvent()
+ * runs on whichever task logged the event and only queues under the mutex.
+ * PURE C++ over IMqttClient (EspMqttClient on target), host-tested against
+ * MockMqttClient + MockDataStorage.
+ */
+
+#ifndef WATERINGSYSTEM_API_MQTTUPLINK_H
+#define WATERINGSYSTEM_API_MQTTUPLINK_H
+
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "api/ApiDtos.h"
+#include "events/EventLogger.h"
+#include "interfaces/IDataStorage.h"
+#include "interfaces/IMqttClient.h"
+#include "interfaces/IWallClock.h"
+#include "interfaces/StaticMutex.h"
+
+namespace api {
+
+struct MqttUplinkConfig {
+    std::string topicBase = "wateringsystem";  ///< "<prefix>/<node>"
+    uint32_t batchMs = 10000;                  ///< live batch cadence
+    std::size_t maxInflight = 4;               ///< unacknowledged messages
+    std::size_t replayReadings = 64;           ///< readings per replay page
+    std::size_t replayEvents = 16;             ///< events per replay page
+};
+
+class MqttUplink final : public IEventTap {
+public:
+    /// Pump and event messages held for the next live batch.
+    static constexpr std::size_t kMaxPending = 32;
+
+    /// Holds references; all must outlive the uplink. Pass the cross-task
+    /// LockedDataStorage as @p history.
+    MqttUplink(IMqttClient& client, const IDataStorage& history,
+               const IWallClock& clock)
+        : client_(client), history_(history), clock_(clock) {}
+
+    MqttUplink(const MqttUplink&) = delete;
+    MqttUplink& operator=(const MqttUplink&) = delete;
+
+    /// Before the first tick().
+    void configure(const MqttUplinkConfig& config) { config_ = config; }
+
+    /// The watermark a previous boot persisted; before the first tick().
+    void restoreWatermark(uint32_t epoch) { watermark_ = epoch; }
+    /// Acknowledged-through epoch to persist (changes only on PUBACKs).
+    /// Tick task only; other tasks read stats().
+    uint32_t watermark() const { return watermark_; }
+
+    /**
+     * @brief Drain the client's events, then publish what is due.
+     *
+     * Call on a steady cadence (finer than batchMs) with the current
+     * readings and pumps: pump starts/stops are detected here, and a live
+     * batch or the next replay pages go out while the window has room.
+     */
+    void tick(uint32_t nowMs, const SensorReadingsDto& sensors,
+              const std::vector<PumpDto>& pumps);
+
+    /// IEventTap: queue an `event` message for the next live batch.
+    void onEvent(uint32_t epoch, uint8_t category,
+                 std::string_view detail) override;
+
+    /// As of the end of the last tick(); any task.
+    MqttUplinkStats stats() const;
+
+private:
+    enum class ReplayStage : uint8_t { Idle, Readings, Events, Draining };
+
+    struct Inflight {
+        int msgId = -1;
+        bool replay = false;
+        uint32_t epoch = 0;  ///< batch epoch of a live message
+    };
+
+    void handle(const MqttEvent& event);
+    void beginReplay(uint32_t now);
+    /// Publish the next replay page; false when nothing was published.
+    bool replayStep();
+    /// Move the watermark once every replay page is acknowledged.
+    void finishReplayIfDrained();
+    bool publish(const char* topic, const std::string& payload, bool replay,
+                 uint32_t epoch);
+    void queue(std::string message);
+
+    IMqttClient& client_;
+    const IDataStorage& history_;
+    const IWallClock& clock_;
+    MqttUplinkConfig config_;
+
+    // Producer queue and published stats (any task, under the mutex).
+    mutable StaticMutex mutex_;
+    std::deque<std::string> pending_;
+    uint32_t dropped_ = 0;
+    MqttUplinkStats published_;
+
+    // Tick task only below.
+    bool connected_ = false;
+    bool haveBatch_ = false;  ///< a live batch went out this session
+    uint32_t lastBatchMs_ = 0;
+    std::vector<Inflight> inflight_;
+    std::vector<uint32_t> pumpFps_;
+
+    uint32_t watermark_ = 0;
+    uint32_t liveMark_ = 0;   ///< newest acked live batch during a replay
+    bool replayChecked_ = false;
+    ReplayStage stage_ = ReplayStage::Idle;
+    uint32_t replayFrom_ = 0;
+    uint32_t replayUntil_ = 0;
+    std::size_t replayMetric_ = 0;
+    ReadingCursor readingCursor_;
+    EventCursor eventCursor_;
+
+    MqttUplinkStats counters_;
+};
+
+}  // namespace api
+
+#endif /* WATERINGSYSTEM_API_MQTTUPLINK_H */
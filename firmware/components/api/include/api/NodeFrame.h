@@ -0,0 +1,77 @@
+// SPDX-FileCopyrightText: 2026 Cryptotomte
+// SPDX-License-Identifier: AGPL-3.0-or-later
+/**
+ * @file NodeFrame.h
+ * @brief Compact binary frames between leaf and gateway nodes (host+target).
+ *
+ * A leaf's report is the same SensorReadingsDto + PumpDto list its own
+ * /api/v1/sensors and /pumps serve, packed to fit one ESP-NOW datagram
+ * (kEspNowMaxPayload). All fields little-endian:
+ *
+ *   header   u8 'W', u8 'N', u8 version (1), u8 type, u16 seq
+ *   Report   u32 timestamp (0 = clock not set)
+ *            u8 flags   bit0 environmental valid, bit1 soil valid,
+ *                       bit2/3/4 soil nitrogen/phosphorus/potassium present,
+ *                       bit5 power block present, bit6 power valid
+ *            u8 level   bit0 low valid, bit1 low wet, bit2 high valid,
+ *                       bit3 high wet
+ *            f32 x3     environmental temperature/humidity/pressure (bit0)
+ *            f32 x5     soil moisture/temperature/humidity/ph/ec (bit1),
+ *                       then one f32 per present NPK channel
+ *            f32 x3     power busVoltage/current/power (bit5)
+ *            u8 pumps, then per pump: u8 nameLen, name, u8 running,
+ *                       u32 currentRunTimeMs, u32 accumulatedRunTimeMs
+ *   Ack      (header only: the seq being acknowledged)
+ *
+ * Only the primary soil probe travels (no soilProbes/soilBus), and a
+ * pump's lastStopReason stays on the leaf. At most kNodeMaxPumps pumps with
+ * names cut at kNodeNameMax bytes, so the largest report is 245 bytes.
+ *
+ * PURE C++, host-tested.
+ */
+
+#ifndef WATERINGSYSTEM_API_NODEFRAME_H
+#define WATERINGSYSTEM_API_NODEFRAME_H
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+#include "api/ApiDtos.h"
+
+namespace api {
+
+constexpr uint8_t kNodeFrameVersion = 1;
+constexpr std::size_t kNodeFrameHeader = 6;
+constexpr std::size_t kNodeMaxPumps = 8;
+constexpr std::size_t kNodeNameMax = 12;
+/// Largest encodeNodeReport() result.
+constexpr std::size_t kNodeMaxFrame = 245;
+
+enum class NodeFrameType : uint8_t { Report = 1, Ack = 2 };
+
+/// A decoded frame; `sensors`/`pumps` meaningful for a Report only.
+struct NodeFrame {
+    NodeFrameType type = NodeFrameType::Report;
+    uint16_t seq = 0;
+    SensorReadingsDto sensors;
+    std::vector<PumpDto> pumps;
+};
+
+/**
+ * @brief Pack a Report into @p out (at least kNodeMaxFrame bytes).
+ * @return the frame length. Pumps past kNodeMaxPumps are left out.
+ */
+std::size_t encodeNodeReport(uint16_t seq, const SensorReadingsDto& sensors,
+                             const std::vector<PumpDto>& pumps, uint8_t* out);
+
+/// Pack the Ack of @p seq into @p out (kNodeFrameHeader bytes); its length.
+std::size_t encodeNodeAck(uint16_t seq, uint8_t* out);
+
+/// Unpack @p len bytes. False for a foreign magic, another version, an
+/// unknown type or a length that does not match the flags.
+bool decodeNodeFrame(const uint8_t* data, std::size_t len, NodeFrame& out);
+
+}  // namespace api
+
+#endif /* WATERINGSYSTEM_API_NODEFRAME_H */
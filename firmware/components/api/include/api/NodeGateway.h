@@ -0,0 +1,131 @@
+// SPDX-FileCopyrightText: 2026 Cryptotomte
+// SPDX-License-Identifier: AGPL-3.0-or-later
+/**
+ * @file NodeGateway.h
+ * @brief ESP-NOW gateway: acknowledges leaf reports and keeps per-node
+ *        state and history (host+target).
+ *
+ * The gateway is an ordinary station node whose ApiServer also answers for
+ * its leaves (NodeLeaf.h): GET /api/v1/nodes lists each leaf's latest
+ * report, and /api/v1/history?node=<mac> reads a leaf's series.
+ *
+ * ACK/DEDUP: every Report is acknowledged, a resent one too — its first
+ * Ack was lost. A Report whose seq equals the leaf's last one is such a
+ * resend: acknowledged and counted as a duplicate, not stored again. A
+ * seq that skips ahead counts the skipped reports as missed; one that
+ * goes back (the leaf rebooted with a new random seq) starts over.
+ *
+ * TABLE: kMaxNodes leaves, keyed by station MAC. A new leaf takes a free
+ * slot, else the slot of the leaf unheard for longest if that is over
+ * kStaleMs; otherwise it is refused (no Ack, so it keeps retrying and
+ * shows up in its own lost count).
+ *
+ * HISTORY: the flash store keeps one series per metric name and caps the
+ * number of names (IDataStorage kMaxMetrics), so leaf history stays in
+ * RAM: the last kHistoryDepth reports per leaf, each the values of the
+ * environmental and primary-soil metrics (ids below kNodeMetrics). A
+ * report is stamped with the leaf's own timestamp, else the gateway's
+ * clock; without either it updates the table but not the history. A
+ * gateway reboot starts the history over.
+ *
+ * THREADS: tick() runs on one task (the target node task); nodes(),
+ * history() and stats() are read by the httpd task and the console, all
+ * under the mutex. PURE C++ over IEspNowLink, host-tested against
+ * MockEspNowLink.
+ */
+
+#ifndef WATERINGSYSTEM_API_NODEGATEWAY_H
+#define WATERINGSYSTEM_API_NODEGATEWAY_H
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "api/ApiDtos.h"
+#include "api/NodeFrame.h"
+#include "interfaces/IEspNowLink.h"
+#include "interfaces/IWallClock.h"
+#include "interfaces/MetricRegistry.h"
+#include "interfaces/StaticMutex.h"
+
+namespace api {
+
+class NodeGateway {
+public:
+    static constexpr std::size_t kMaxNodes = 8;
+    static constexpr std::size_t kHistoryDepth = 48;
+    /// Metric ids a leaf's history keeps: environmental + primary soil.
+    static constexpr std::size_t kNodeMetrics = metric::kSoilPotassium + 1;
+    static constexpr uint32_t kStaleMs = 60 * 60 * 1000;
+
+    /// Holds references; both must outlive the gateway.
+    NodeGateway(IEspNowLink& link, const IWallClock& clock)
+        : link_(link), clock_(clock) {}
+
+    NodeGateway(const NodeGateway&) = delete;
+    NodeGateway& operator=(const NodeGateway&) = delete;
+
+    /// Drain the link: acknowledge and store every Report.
+    void tick(uint32_t nowMs);
+
+    /// Every leaf in the table, in arrival order; @p nowMs on tick()'s clock.
+    std::vector<NodeDto> nodes(uint32_t nowMs) const;
+
+    /**
+     * @brief @p node's readings of @p id within [t0, t1] into @p out's
+     * timestamps/values (oldest first).
+     * @return false when no leaf @p node (12 hex digits) is in the table
+     */
+    bool history(std::string_view node, MetricId id, uint32_t t0, uint32_t t1,
+                 HistorySeries& out) const;
+
+    /// Any task.
+    NodeGatewayStats stats() const;
+
+    /// `aabbccddeeff` of @p mac.
+    static std::string formatNode(const EspNowMac& mac);
+
+    /// Parse formatNode()'s form (either case); false otherwise.
+    static bool parseNode(std::string_view text, EspNowMac& mac);
+
+private:
+    struct Sample {
+        uint32_t epoch = 0;
+        uint16_t valid = 0;  ///< bit per metric id
+        std::array<float, kNodeMetrics> values{};
+    };
+
+    struct Node {
+        EspNowMac mac{};
+        uint16_t seq = 0;
+        uint32_t lastSeenMs = 0;
+        int8_t rssi = 0;
+        uint32_t reports = 0;
+        uint32_t duplicates = 0;
+        uint32_t missed = 0;
+        SensorReadingsDto sensors;
+        std::vector<PumpDto> pumps;
+        std::vector<Sample> history;  ///< ring, kHistoryDepth once full
+        std::size_t head = 0;         ///< next slot once full
+    };
+
+    /// The slot for @p mac, a new or reclaimed one, or nullptr (full).
+    Node* slotFor(const EspNowMac& mac, uint32_t nowMs);
+    void store(Node& node, const EspNowPacket& packet, NodeFrame& frame,
+               uint32_t nowMs);
+    void ack(const EspNowMac& to, uint16_t seq);
+
+    IEspNowLink& link_;
+    const IWallClock& clock_;
+
+    mutable StaticMutex mutex_;
+    std::vector<Node> nodes_;  ///< at most kMaxNodes
+    NodeGatewayStats counters_;
+};
+
+}  // namespace api
+
+#endif /* WATERINGSYSTEM_API_NODEGATEWAY_H */
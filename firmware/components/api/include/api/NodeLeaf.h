@@ -0,0 +1,103 @@
+// SPDX-FileCopyrightText: 2026 Cryptotomte
+// SPDX-License-Identifier: AGPL-3.0-or-later
+/**
+ * @file NodeLeaf.h
+ * @brief Duty-cycled report sender of an ESP-NOW leaf node (host+target).
+ *
+ * A leaf in a multi-node greenhouse pushes its readings to one gateway
+ * instead of serving them: every periodMs (the first one phaseMs after
+ * boot, so leaves powered up together do not all talk at once) it packs
+ * its sensor and pump DTOs into a NodeFrame Report and sends it.
+ *
+ * ACK/RETRY: the gateway answers each Report with an Ack of its seq. A
+ * Report unanswered after ackTimeoutMs is resent with the same seq and
+ * bytes, the timeout doubling each time; after maxRetries resends it is
+ * counted lost and the leaf waits for the next period — the gateway sees
+ * the gap in seq. The schedule runs from the first attempt, so retries
+ * never push the next report later.
+ *
+ * THREADS: poll()/report() run on one task (the target node task);
+ * stats() from any. PURE C++ over IEspNowLink, host-tested against
+ * MockEspNowLink.
+ */
+
+#ifndef WATERINGSYSTEM_API_NODELEAF_H
+#define WATERINGSYSTEM_API_NODELEAF_H
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+#include "api/ApiDtos.h"
+#include "api/NodeFrame.h"
+#include "interfaces/IEspNowLink.h"
+#include "interfaces/StaticMutex.h"
+
+namespace api {
+
+struct NodeLeafConfig {
+    uint32_t periodMs = 60000;     ///< report cadence
+    uint32_t phaseMs = 0;          ///< first report this long after boot
+    uint32_t ackTimeoutMs = 200;   ///< first wait; doubles per resend
+    uint8_t maxRetries = 3;        ///< resends before a report is lost
+    uint16_t firstSeq = 0;         ///< random per boot: no false duplicate
+};
+
+class NodeLeaf {
+public:
+    /// Holds @p link, which must outlive the leaf.
+    NodeLeaf(IEspNowLink& link, const EspNowMac& gateway)
+        : link_(link), gateway_(gateway) {}
+
+    NodeLeaf(const NodeLeaf&) = delete;
+    NodeLeaf& operator=(const NodeLeaf&) = delete;
+
+    /// Before the first poll().
+    void configure(const NodeLeafConfig& config)
+    {
+        config_ = config;
+        seq_ = config.firstSeq;
+    }
+
+    /// Drain the link for the gateway's Ack, resend on timeout.
+    void poll(uint32_t nowMs);
+
+    /// A new report is due (none awaits its Ack and the period elapsed).
+    bool reportDue(uint32_t nowMs) const;
+
+    /// Pack and send a new report; call when reportDue().
+    void report(uint32_t nowMs, const SensorReadingsDto& sensors,
+                const std::vector<PumpDto>& pumps);
+
+    /// A report awaits its Ack.
+    bool awaitingAck() const { return awaiting_; }
+
+    /// As of the end of the last poll()/report(); any task.
+    NodeLeafStats stats() const;
+
+private:
+    void transmit(uint32_t nowMs);
+    void publish();
+
+    IEspNowLink& link_;
+    const EspNowMac gateway_;
+    NodeLeafConfig config_;
+
+    // Node task only below.
+    bool started_ = false;        ///< the first report went out
+    uint32_t periodStartMs_ = 0;  ///< first attempt of the last report
+    bool awaiting_ = false;
+    uint16_t seq_ = 0;            ///< of the report in flight / last sent
+    uint8_t attempt_ = 0;         ///< resends of the report in flight
+    uint32_t sentMs_ = 0;         ///< of the last (re)send
+    uint8_t frame_[kNodeMaxFrame] = {};
+    std::size_t frameLen_ = 0;
+    NodeLeafStats counters_;
+
+    mutable StaticMutex mutex_;
+    NodeLeafStats published_;
+};
+
+}  // namespace api
+
+#endif /* WATERINGSYSTEM_API_NODELEAF_H */
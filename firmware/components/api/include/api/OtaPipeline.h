@@ -0,0 +1,185 @@
+// SPDX-FileCopyrightText: 2026 Cryptotomte
+// SPDX-License-Identifier: AGPL-3.0-or-later
+/**
+ * @file OtaPipeline.h
+ * @brief Streaming firmware upload: socket receive and flash write
+ *        overlapped through two chunk buffers (host+target).
+ *
+ * POST /api/v1/ota hands its body here chunk by chunk; the image is never
+ * held in RAM. Two fixed kChunkBytes buffers alternate: the httpd task
+ * (receive()) fills one from the socket while the OTA writer task
+ * (serveWrite(), main/ota_task.cpp) writes the other to the inactive app
+ * slot and folds it into the running SHA-256. A receive only waits when
+ * both buffers are still queued for the flash, so the upload runs at the
+ * slower of the two rates instead of their sum. Without an attached
+ * writer the receiving task writes each chunk itself, one after the
+ * other.
+ *
+ * VERIFY: the digest is complete when the last chunk is written. A
+ * caller-supplied expected digest that does not match, a short body, or
+ * a failed write aborts the slot; only a matching, complete image goes
+ * on to IFirmwareSlot::commit() (image validation, boot selection). The
+ * running app and the boot selection are untouched until then.
+ *
+ * DELTA: a body that starts with the api/DeltaPatch.h magic is a patch
+ * against the running image (setBaseImage()): it must name that image's
+ * size and SHA-256 (else BaseMismatch, and the client sends the full
+ * image instead), and a DeltaSource rebuilds the new image from it on the
+ * receiving side, so the writer, the hash and the commit are the same as
+ * for a full image. Any other body is a full image.
+ *
+ * ONE AT A TIME: a second upload while one runs is refused (Busy).
+ *
+ * THREADS: receive() on one task at a time (the httpd task), serveWrite()
+ * on the writer task; the buffers are handed over under a mutex and
+ * condition variable (pthread-backed on ESP-IDF). Pure C++ over
+ * IFirmwareSlot (EspFirmwareSlot on target), host-tested.
+ */
+
+#ifndef WATERINGSYSTEM_API_OTAPIPELINE_H
+#define WATERINGSYSTEM_API_OTAPIPELINE_H
+
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <mutex>
+
+#include "api/Sha256.h"
+#include "interfaces/IFirmwareSlot.h"
+#include "interfaces/IRunningImage.h"
+#include "interfaces/ITimeProvider.h"
+
+namespace api {
+
+struct DeltaHeader;
+
+/// How an upload ended.
+enum class OtaOutcome : uint8_t {
+    Ok,             ///< written, verified and selected for the next boot
+    Busy,           ///< another upload is running
+    NoLength,       ///< no (or a zero) Content-Length
+    TooLarge,       ///< larger than the slot
+    ReceiveFailed,  ///< the client stopped sending before the end
+    WriteFailed,    ///< the slot refused to open or a chunk write failed
+    HashMismatch,   ///< the image's SHA-256 differs from the expected one
+    Rejected,       ///< complete, but not a valid app image
+    BaseMismatch,   ///< a delta patch made against another running image
+    BadPatch        ///< a delta patch that does not decode
+};
+
+/// Stable lower-case name of @p outcome ("ok", "hash-mismatch", ...).
+const char* otaOutcomeName(OtaOutcome outcome);
+
+/// One finished upload.
+struct OtaReport {
+    OtaOutcome outcome = OtaOutcome::Ok;
+    uint32_t bytes = 0;          ///< image bytes produced (all of it, when Ok)
+    uint32_t transferBytes = 0;  ///< body bytes received (bytes, for a full image)
+    uint32_t elapsedMs = 0;      ///< first receive to commit/abort
+    bool delta = false;          ///< the body was a delta patch
+    Sha256::Digest sha256{};     ///< of the written bytes (complete uploads)
+};
+
+/// Counters since boot.
+struct OtaStats {
+    uint32_t uploads = 0;      ///< finished with Ok
+    uint32_t failures = 0;     ///< ended otherwise (Busy included)
+    uint32_t receiveWaits = 0; ///< receives that waited for a free buffer
+};
+
+/**
+ * @brief Where receive() reads the body from (httpd_req_recv on target).
+ *
+ * A tiny interface rather than std::function, like IChunkSink.
+ */
+class IChunkSource {
+public:
+    virtual ~IChunkSource() = default;
+
+    /// Up to @p len bytes into @p dst; the count, 0 at the end of the
+    /// body, negative on an error.
+    virtual int receive(uint8_t* dst, std::size_t len) = 0;
+};
+
+class OtaPipeline {
+public:
+    /// One flash sector: each write lands on a freshly erased sector.
+    static constexpr std::size_t kChunkBytes = 4096;
+
+    /// @p slot and @p clock must outlive the pipeline.
+    OtaPipeline(IFirmwareSlot& slot, ITimeProvider& clock);
+
+    OtaPipeline(const OtaPipeline&) = delete;
+    OtaPipeline& operator=(const OtaPipeline&) = delete;
+
+    /**
+     * @brief A writer task now calls serveWrite(); receive() hands chunks
+     * to it from here on. Call once, before the first upload.
+     */
+    void attachWriter();
+
+    /**
+     * @brief Accept delta patches against @p base (must outlive the
+     * pipeline). Without one every patch is a BaseMismatch. Call before
+     * the first upload.
+     */
+    void setBaseImage(IRunningImage& base);
+
+    /**
+     * @brief Stream a body of @p bodyBytes — a full image or a delta
+     * patch — from @p source into the slot.
+     *
+     * Blocks until the image is committed or abandoned.
+     * @param expected SHA-256 the (resulting) image must have, or nullptr
+     *        to accept what arrives (the slot still validates the image; a
+     *        patch always carries the target's digest).
+     */
+    OtaReport receive(std::size_t bodyBytes, const Sha256::Digest* expected,
+                      IChunkSource& source);
+
+    /**
+     * @brief Writer task loop body: write the next queued chunk, waiting up
+     * to @p waitMs for one.
+     * @return true when a chunk was taken
+     */
+    bool serveWrite(uint32_t waitMs);
+
+    /// The newest finished upload, once: true when @p out is new since the
+    /// last call.
+    bool takeReport(OtaReport& out);
+
+    bool busy() const;
+    OtaStats stats() const;
+
+private:
+    OtaReport receiveDelta(const uint8_t* head, std::size_t bodyBytes,
+                           const Sha256::Digest* expected, IChunkSource& source);
+    bool baseMatches(const DeltaHeader& header);
+    OtaReport stream(std::size_t imageBytes, const Sha256::Digest* expected,
+                     IChunkSource& source);
+    bool writeChunk(std::size_t index, std::size_t len);
+    OtaReport finish(OtaReport report);
+
+    IFirmwareSlot& slot_;
+    ITimeProvider& clock_;
+    IRunningImage* base_ = nullptr;
+
+    mutable std::mutex mutex_;
+    std::condition_variable changed_;
+    bool writerAttached_ = false;
+    bool busy_ = false;
+    bool discard_ = false;       ///< upload abandoned: drop queued chunks
+    bool writeFailed_ = false;
+    std::size_t queued_[2] = {};  ///< bytes awaiting the writer, 0 = free
+    std::size_t writeNext_ = 0;
+    bool haveReport_ = false;
+    OtaReport report_;
+    OtaStats stats_;
+
+    Sha256 hash_;  ///< writer side only
+    uint8_t buffers_[2][kChunkBytes];
+};
+
+}  // namespace api
+
+#endif /* WATERINGSYSTEM_API_OTAPIPELINE_H */
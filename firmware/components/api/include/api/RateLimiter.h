@@ -0,0 +1,91 @@
+// SPDX-FileCopyrightText: 2026 Cryptotomte
+// SPDX-License-Identifier: AGPL-3.0-or-later
+/**
+ * @file RateLimiter.h
+ * @brief Per-client token-bucket admission for the API server (host+target).
+ *
+ * The server answers on one httpd task, in arrival order. A client polling
+ * in a tight loop — a stuck script, a browser tab left on a reload
+ * extension — keeps that task busy and the dashboard's own requests queue
+ * behind it. RateLimiter gives each client address a bucket of `burst`
+ * tokens refilled at `perSecond`; a request that finds its bucket empty is
+ * turned away with a preformatted 429 before any handler runs, so the
+ * offender costs one short write and everyone else keeps their share.
+ *
+ * The table holds kClients addresses; a new address takes a free slot or
+ * the least recently seen one, starting with a full bucket. A LAN device
+ * has a handful of clients, and a flooding one is always the most recent,
+ * so it is never the one evicted. Tokens are kept in thousandths so a
+ * rate below one per millisecond refills without drift.
+ *
+ * Not synchronized: the httpd task is the only caller (the timing
+ * wrappers), and /metrics reads throttled() on that same task.
+ *
+ * PURE C++ (no esp_http_server), host-tested.
+ */
+
+#ifndef WATERINGSYSTEM_API_RATELIMITER_H
+#define WATERINGSYSTEM_API_RATELIMITER_H
+
+#include <cstddef>
+#include <cstdint>
+
+namespace api {
+
+/// A client's address as IPv6 bytes (IPv4 as ::ffff:a.b.c.d).
+struct ClientAddress {
+    uint8_t bytes[16] = {};
+
+    /// @p ipv4 in network byte order, mapped into ::ffff:0:0/96.
+    static ClientAddress fromIpv4(uint32_t ipv4);
+};
+
+bool operator==(const ClientAddress& a, const ClientAddress& b);
+
+class RateLimiter {
+public:
+    /// Distinct clients tracked at once.
+    static constexpr std::size_t kClients = 8;
+
+    /// Off (admit() always true) until configured with a non-zero rate.
+    RateLimiter() = default;
+
+    /**
+     * @brief Set the refill rate and bucket size; forgets every client.
+     * @param perSecond Tokens added per second per client; 0 turns the
+     *                  limiter off.
+     * @param burst     Bucket size: requests a fresh client may make back to
+     *                  back. Raised to 1 when 0.
+     */
+    void configure(uint32_t perSecond, uint32_t burst);
+
+    bool enabled() const { return perSecond_ != 0; }
+
+    /// Take a token from @p client's bucket at @p nowMs (a monotonic clock;
+    /// wrap-safe). False, counted in throttled(), when it is empty.
+    bool admit(const ClientAddress& client, uint32_t nowMs);
+
+    /// Requests refused since boot.
+    uint32_t throttled() const { return throttled_; }
+
+private:
+    static constexpr uint32_t kScale = 1000;  ///< tokens are kept in thousandths
+
+    struct Slot {
+        ClientAddress address;
+        uint32_t tokens = 0;  ///< thousandths
+        uint32_t lastMs = 0;  ///< last refill (and last seen)
+        bool used = false;
+    };
+
+    Slot& slotFor(const ClientAddress& client, uint32_t nowMs);
+
+    Slot slots_[kClients];
+    uint32_t perSecond_ = 0;
+    uint32_t capacity_ = 0;  ///< burst, in thousandths
+    uint32_t throttled_ = 0;
+};
+
+}  // namespace api
+
+#endif /* WATERINGSYSTEM_API_RATELIMITER_H */
@@ -0,0 +1,137 @@
+// SPDX-FileCopyrightText: 2026 Cryptotomte
+// SPDX-License-Identifier: AGPL-3.0-or-later
+/**
+ * @file ReadAheadPipe.h
+ * @brief Large response bodies: flash read and socket send overlapped
+ *        through two chunk buffers (host+target).
+ *
+ * OtaPipeline's hand-over, run the other way. Copying a file to the client
+ * on one task alternates a read into a buffer with a blocking send of it,
+ * so flash and Wi-Fi are never busy at the same time and a transfer takes
+ * the sum of both. Here two fixed kChunkBytes buffers alternate: the
+ * reader task (serveRead(), main/read_ahead_task.cpp) fills one from the
+ * IChunkSource while the caller of pump() — the httpd task — sends the
+ * other to the IChunkSink, so a large body goes at the slower of the two
+ * rates. Without an attached reader, or while another pump() holds the
+ * buffers, pump() copies on the calling task through a buffer of the
+ * caller's, one chunk after the other (copyChunks()).
+ *
+ * The source is read to its end (receive() returns 0) or its first error
+ * (negative); a failed send stops the reader after the chunk in hand.
+ * pump() returns only once the reader has let go of the source.
+ *
+ * THREADS: pump() on any task, serveRead() on the reader task; the
+ * buffers are handed over under a mutex and condition variable
+ * (pthread-backed on ESP-IDF). Pure C++, host-tested.
+ */
+
+#ifndef WATERINGSYSTEM_API_READAHEADPIPE_H
+#define WATERINGSYSTEM_API_READAHEADPIPE_H
+
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <mutex>
+
+#include "api/ApiStream.h"
+#include "api/OtaPipeline.h"
+
+namespace api {
+
+/// How a copy ended.
+enum class PumpOutcome : uint8_t {
+    Ok,          ///< the source ended and every byte was sent
+    ReadFailed,  ///< the source failed; what came before it was sent
+    SendFailed   ///< the client is gone
+};
+
+/// An open stdio file as a chunk source (the caller keeps and closes it),
+/// from where it stands to its end or for at most @p limit bytes: a byte
+/// range is an fseek() to its first byte and its length here.
+class FileChunkSource final : public IChunkSource {
+public:
+    explicit FileChunkSource(FILE* file, uint64_t limit = UINT64_MAX)
+        : file_(file), left_(limit)
+    {
+    }
+
+    int receive(uint8_t* dst, std::size_t len) override;
+
+private:
+    FILE* file_;
+    uint64_t left_;
+};
+
+/**
+ * @brief @p source to @p sink on the calling task through @p buf
+ * (@p cap bytes), a read then a send per chunk.
+ */
+PumpOutcome copyChunks(IChunkSource& source, IChunkSink& sink, uint8_t* buf,
+                       std::size_t cap);
+
+/// Counters since boot.
+struct ReadAheadStats {
+    uint32_t pumps = 0;      ///< through the reader task
+    uint32_t inlined = 0;    ///< copied on the caller (no reader, or busy)
+    uint32_t sendWaits = 0;  ///< sends that waited for the reader (flash-bound)
+};
+
+class ReadAheadPipe {
+public:
+    /// Two of these: each send is a couple of TCP segments' worth, twice
+    /// the single-task copy's 1 KiB.
+    static constexpr std::size_t kChunkBytes = 2048;
+
+    ReadAheadPipe() = default;
+
+    ReadAheadPipe(const ReadAheadPipe&) = delete;
+    ReadAheadPipe& operator=(const ReadAheadPipe&) = delete;
+
+    /**
+     * @brief A reader task now calls serveRead(); pump() hands reads to it
+     * from here on. Call once, before the first pump().
+     */
+    void attachReader();
+
+    /**
+     * @brief Copy @p source to @p sink until the source ends or fails or
+     * a send fails.
+     *
+     * Blocks until done. Without a reader, or while another pump() runs,
+     * the copy is copyChunks() through @p spare (@p spareBytes).
+     */
+    PumpOutcome pump(IChunkSource& source, IChunkSink& sink, uint8_t* spare,
+                     std::size_t spareBytes);
+
+    /**
+     * @brief Reader task loop body: fill the next free buffer, waiting up
+     * to @p waitMs for a pump() to need one.
+     * @return true when a chunk was read
+     */
+    bool serveRead(uint32_t waitMs);
+
+    ReadAheadStats stats() const;
+
+private:
+    PumpOutcome drain(IChunkSink& sink);
+
+    mutable std::mutex mutex_;
+    std::condition_variable changed_;
+    bool readerAttached_ = false;
+    bool busy_ = false;
+    IChunkSource* source_ = nullptr;  ///< of the running pump()
+    bool reading_ = false;            ///< the reader holds source_ and a buffer
+    bool ended_ = false;              ///< the source ended (or failed)
+    bool readFailed_ = false;
+    bool stop_ = false;               ///< a send failed: read no more
+    std::size_t filled_[2] = {};      ///< bytes awaiting the send, 0 = free
+    std::size_t readNext_ = 0;
+    ReadAheadStats stats_;
+
+    uint8_t buffers_[2][kChunkBytes];
+};
+
+}  // namespace api
+
+#endif /* WATERINGSYSTEM_API_READAHEADPIPE_H */
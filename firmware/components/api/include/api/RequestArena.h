@@ -0,0 +1,113 @@
+// SPDX-FileCopyrightText: 2026 Cryptotomte
+// SPDX-License-Identifier: AGPL-3.0-or-later
+/**
+ * @file RequestArena.h
+ * @brief Per-request bump allocator behind cJSON (host+target).
+ *
+ * A JSON response is built as a cJSON tree — a small block per node and
+ * per key/value string — then printed into a growing buffer, then copied
+ * into the std::string the handler sends. Each request leaves tens of
+ * short-lived blocks on the general heap; over days of dashboard polling
+ * that churn is what fragments the ESP32's internal RAM.
+ *
+ * installArenaHooks() routes every cJSON allocation through hooks that,
+ * while an ArenaScope is open on the calling task, bump-allocate from that
+ * scope's RequestArena and treat cJSON's frees as no-ops; the whole arena
+ * is reclaimed at once when the scope closes. ApiServer opens one around
+ * every handler (the timing wrappers), so the httpd task parses and
+ * serializes in one block allocated at construction. Outside a scope —
+ * another task, the selftest worker, the stream pushes — the hooks are
+ * plain malloc/free. An allocation that does not fit the arena also goes
+ * to the heap (counted in fallbacks()), so an undersized arena costs
+ * churn, never a failed response; highWater() is exported by /metrics to
+ * size it.
+ *
+ * The block is BufferPool::RequestArena's (interfaces/BufferBudget.h):
+ * PSRAM first when the board has it, with kBudget's larger size there.
+ *
+ * Invariant: no cJSON allocation made inside a scope outlives it. The
+ * serializers print and delete their tree before returning, and the
+ * printed text is copied into a std::string (operator new, not cJSON).
+ *
+ * PURE C++ (no esp_http_server), host-tested.
+ */
+
+#ifndef WATERINGSYSTEM_API_REQUESTARENA_H
+#define WATERINGSYSTEM_API_REQUESTARENA_H
+
+#include <cstddef>
+#include <cstdint>
+
+#include "interfaces/BufferBudget.h"
+
+namespace api {
+
+class RequestArena {
+public:
+    /// Holds the common bodies (/status, /sensors, /pumps, /snapshot) —
+    /// tree and print buffers together; a larger one spills to the heap.
+    static constexpr std::size_t kDefaultBytes = 12 * 1024;
+    /// With PSRAM the large bodies (/history, /config) fit as well.
+    static constexpr BufferBudget kBudget{32 * 1024, kDefaultBytes};
+
+    /// Allocates the @p capacity byte block once; a failed allocation
+    /// leaves a zero-capacity arena (everything falls back to the heap).
+    explicit RequestArena(std::size_t capacity = kDefaultBytes);
+    ~RequestArena();
+
+    RequestArena(const RequestArena&) = delete;
+    RequestArena& operator=(const RequestArena&) = delete;
+
+    /// @p size bytes, max_align_t aligned, or nullptr when they do not fit.
+    void* allocate(std::size_t size);
+
+    /// Is @p p inside this arena's block?
+    bool owns(const void* p) const;
+
+    /// Reclaim everything (the end of a request).
+    void reset();
+
+    std::size_t capacity() const { return capacity_; }
+    std::size_t used() const { return used_; }
+    /// Most bytes in use at once since construction.
+    std::size_t highWater() const { return highWater_; }
+    /// Allocations inside a scope that did not fit and went to the heap.
+    uint32_t fallbacks() const { return fallbacks_; }
+
+    /// Called by the hooks when an allocation falls back to the heap.
+    void noteFallback() { ++fallbacks_; }
+
+private:
+    unsigned char* base_;
+    std::size_t capacity_;
+    std::size_t used_ = 0;
+    std::size_t highWater_ = 0;
+    uint32_t fallbacks_ = 0;
+};
+
+/**
+ * @brief Makes @p arena the calling task's cJSON allocator until destroyed.
+ *
+ * Restores the previous one (scopes nest) and resets the arena when it
+ * closes. A null arena opens an empty scope: the heap stays in use.
+ */
+class ArenaScope {
+public:
+    explicit ArenaScope(RequestArena* arena);
+    ~ArenaScope();
+
+    ArenaScope(const ArenaScope&) = delete;
+    ArenaScope& operator=(const ArenaScope&) = delete;
+
+private:
+    RequestArena* arena_;
+    RequestArena* previous_;
+};
+
+/// Install the arena-aware cJSON hooks (cJSON_InitHooks). Idempotent; call
+/// before the first request is served.
+void installArenaHooks();
+
+}  // namespace api
+
+#endif /* WATERINGSYSTEM_API_REQUESTARENA_H */
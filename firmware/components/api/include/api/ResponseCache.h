@@ -0,0 +1,98 @@
+// SPDX-FileCopyrightText: 2026 Cryptotomte
+// SPDX-License-Identifier: AGPL-3.0-or-later
+/**
+ * @file ResponseCache.h
+ * @brief Prebuilt bodies for the hot GET endpoints (host+target).
+ *
+ * A dashboard opening several tabs at once fires bursts of /status,
+ * /sensors and /config requests, and each one rebuilt its DTO (several
+ * Locked* acquisitions, getStorageStats(), esp_reset_reason()) and printed
+ * a fresh cJSON tree. The cache keeps the last printed body per endpoint,
+ * keyed by the generation of its source and, where the source has no
+ * generation, bounded by a maximum age:
+ *   - /config: IConfigStore::generation(), no age limit — the body changes
+ *     only with a persisted write.
+ *   - /status: the config generation (mode, SSID) AND a short max age (its
+ *     uptime, clock, wifi and storage figures move without a counter).
+ *   - /sensors: max age only (the sensors expose no publish counter); the
+ *     weak ETag is cached with the body, so a conditional hit reads nothing.
+ * A hit returns the exact bytes of the miss that built it, so within the
+ * max age every response is identical, timestamps included.
+ *
+ * One mutex over the table, so no caller has to know which task serves a
+ * request. PURE C++, host-tested.
+ */
+
+#ifndef WATERINGSYSTEM_API_RESPONSECACHE_H
+#define WATERINGSYSTEM_API_RESPONSECACHE_H
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <mutex>
+#include <string>
+
+#include "interfaces/StaticMutex.h"
+
+namespace api {
+
+class ResponseCache {
+public:
+    /// The cached endpoints.
+    enum class Slot : uint8_t {
+        Status,
+        Sensors,
+        Config,
+    };
+    static constexpr std::size_t kSlots = 3;
+
+    ResponseCache() = default;
+
+    ResponseCache(const ResponseCache&) = delete;
+    ResponseCache& operator=(const ResponseCache&) = delete;
+
+    /// Entries of @p slot expire @p maxAgeMs after they were built; 0 (the
+    /// default) means they live until the generation moves.
+    void setMaxAge(Slot slot, uint32_t maxAgeMs);
+
+    /**
+     * @brief Copy out the entry for @p slot if it is still current.
+     *
+     * Current = built under @p generation, and no more than the slot's max
+     * age before @p nowMs (a clock that went backwards also expires it).
+     * @return false on a miss; @p body / @p etag are then untouched
+     */
+    bool get(Slot slot, uint32_t generation, int64_t nowMs, std::string& body,
+             std::string& etag) const;
+
+    /// Store the body (and its ETag, empty if untagged) built at @p nowMs
+    /// under @p generation. An empty @p body is not cached (the serializer
+    /// ran out of memory).
+    void put(Slot slot, uint32_t generation, int64_t nowMs,
+             const std::string& body, const std::string& etag);
+
+    /// Drop the entry for @p slot.
+    void invalidate(Slot slot);
+
+    uint32_t hits() const;
+    uint32_t misses() const;
+
+private:
+    struct Entry {
+        bool valid = false;
+        uint32_t generation = 0;
+        int64_t builtMs = 0;
+        uint32_t maxAgeMs = 0;
+        std::string body;
+        std::string etag;
+    };
+
+    mutable StaticMutex mutex_;
+    std::array<Entry, kSlots> entries_{};
+    mutable uint32_t hits_ = 0;
+    mutable uint32_t misses_ = 0;
+};
+
+}  // namespace api
+
+#endif /* WATERINGSYSTEM_API_RESPONSECACHE_H */
@@ -0,0 +1,134 @@
+// SPDX-FileCopyrightText: 2026 Cryptotomte
+// SPDX-License-Identifier: AGPL-3.0-or-later
+/**
+ * @file SelfTestRunner.h
+ * @brief POST /api/v1/selftest checks run side by side, under one deadline
+ *        (host+target).
+ *
+ * Each self-test check is one bounded read() on its own bus: the BME280 on
+ * I2C, the soil probe on RS485. One after the other, a run takes the sum
+ * of their timeouts. Here the caller of run() (the selftest worker) hands
+ * every check but the first to a helper task (serveCheck(),
+ * main/selftest_task.cpp) and runs the first itself, so a run takes about
+ * the slowest check.
+ *
+ * The caller also runs any check no helper has picked up — no helper
+ * task, or fewer helpers than checks — so run() always ends with every
+ * check started. It then waits for the helpers' checks until
+ * @p deadlineMs after the start: one still running is reported failed
+ * ("timed out") and stays with its helper; until it returns, a later run
+ * reports that check failed without starting it again. A check the caller
+ * runs itself cannot be cut short, so the first check should be the one
+ * with the tighter bound of its own.
+ *
+ * THREADS: run() on the selftest worker, serveCheck() on the helpers;
+ * the slots are handed over under a mutex and condition variable
+ * (pthread-backed on ESP-IDF), as in ReadAheadPipe. Pure C++, host-tested.
+ */
+
+#ifndef WATERINGSYSTEM_API_SELFTESTRUNNER_H
+#define WATERINGSYSTEM_API_SELFTESTRUNNER_H
+
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <mutex>
+#include <string>
+
+#include "api/ApiDtos.h"
+
+namespace api {
+
+/// One self-test check: a bounded read on one bus.
+class ISelfTestCheck {
+public:
+    virtual ~ISelfTestCheck() = default;
+
+    /// The check's `name` in the body.
+    virtual const char* name() const = 0;
+
+    /// Run the check; @p detail is "ok" or why it failed.
+    virtual bool run(std::string& detail) = 0;
+};
+
+/// A check that is one read() of a sensor with getLastError() (the
+/// environmental and soil interfaces).
+template <typename Sensor>
+class SensorReadCheck final : public ISelfTestCheck {
+public:
+    SensorReadCheck(const char* name, Sensor& sensor) : name_(name), sensor_(sensor) {}
+
+    const char* name() const override { return name_; }
+
+    bool run(std::string& detail) override
+    {
+        if (sensor_.read()) {
+            detail = "ok";
+            return true;
+        }
+        detail = "read failed, error " + std::to_string(sensor_.getLastError());
+        return false;
+    }
+
+private:
+    const char* name_;
+    Sensor& sensor_;
+};
+
+class SelfTestRunner {
+public:
+    /// Checks per run: the two buses today, room for the INA226 and levels.
+    static constexpr std::size_t kMaxChecks = 4;
+
+    SelfTestRunner() = default;
+
+    SelfTestRunner(const SelfTestRunner&) = delete;
+    SelfTestRunner& operator=(const SelfTestRunner&) = delete;
+
+    /**
+     * @brief Run @p count checks (at most kMaxChecks, the rest are left
+     * out) concurrently and collect their results in order.
+     *
+     * The checks must outlive the runner: a timed-out one is still in a
+     * helper's hands when run() returns. `overall` is true when every
+     * check passed.
+     */
+    SelfTestResultDto run(ISelfTestCheck* const* checks, std::size_t count,
+                          uint32_t deadlineMs);
+
+    /**
+     * @brief Helper side: wait up to @p waitMs for a queued check and run
+     * it.
+     * @return true when a check was run
+     */
+    bool serveCheck(uint32_t waitMs);
+
+private:
+    enum class SlotState : uint8_t {
+        Idle,
+        Queued,   ///< waiting for a helper or the caller
+        Running,
+        Done,     ///< result ready for run()
+    };
+
+    struct Slot {
+        ISelfTestCheck* check = nullptr;
+        SlotState state = SlotState::Idle;
+        bool abandoned = false;  ///< run() gave up on it (deadline)
+        bool ok = false;
+        std::string detail;
+    };
+
+    /// The first queued slot, or kMaxChecks.
+    std::size_t firstQueued() const;
+    /// Run slot @p index with the lock released around the check.
+    void runSlot(std::unique_lock<std::mutex>& lock, std::size_t index);
+
+    std::mutex mutex_;
+    std::condition_variable changed_;
+    Slot slots_[kMaxChecks];
+};
+
+}  // namespace api
+
+#endif /* WATERINGSYSTEM_API_SELFTESTRUNNER_H */
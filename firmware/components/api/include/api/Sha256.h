@@ -0,0 +1,56 @@
+// SPDX-FileCopyrightText: 2026 Cryptotomte
+// SPDX-License-Identifier: AGPL-3.0-or-later
+/**
+ * @file Sha256.h
+ * @brief Incremental SHA-256 (FIPS 180-4), pure.
+ *
+ * Hashes an OTA image chunk by chunk as it is written (OtaPipeline), so
+ * the digest is ready the moment the last chunk lands and the image is
+ * never read back or held whole. Portable C++ with no IDF dependency, so
+ * the same code is host-tested against the FIPS vectors.
+ */
+
+#ifndef WATERINGSYSTEM_API_SHA256_H
+#define WATERINGSYSTEM_API_SHA256_H
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <string_view>
+
+namespace api {
+
+class Sha256 {
+public:
+    static constexpr std::size_t kDigestBytes = 32;
+    using Digest = std::array<uint8_t, kDigestBytes>;
+
+    Sha256() { reset(); }
+
+    void reset();
+
+    /// Hash @p len more bytes.
+    void update(const uint8_t* data, std::size_t len);
+
+    /// The digest of everything updated since reset(); resets.
+    Digest finish();
+
+    /// @p digest as 64 lowercase hex digits.
+    static std::string toHex(const Digest& digest);
+
+    /// Parse 64 hex digits (either case); false on anything else.
+    static bool fromHex(std::string_view hex, Digest& out);
+
+private:
+    void block(const uint8_t* p);
+
+    uint32_t state_[8];
+    uint8_t buffer_[64];
+    std::size_t buffered_ = 0;
+    uint64_t totalBytes_ = 0;
+};
+
+}  // namespace api
+
+#endif /* WATERINGSYSTEM_API_SHA256_H */
@@ -0,0 +1,188 @@
+// SPDX-FileCopyrightText: 2026 Cryptotomte
+// SPDX-License-Identifier: AGPL-3.0-or-later
+/**
+ * @file StorageArchive.h
+ * @brief The whole data store as one stream: GET /api/v1/backup writes
+ *        it, POST /api/v1/restore reads it back (host+target).
+ *
+ * WHY THIS EXISTS: a node's backup was one /history call per metric and
+ * range plus /events, each a query of its own, and nothing brought it
+ * back. The archive instead carries the store's FILES — every history
+ * chunk of every layout, the rollups and chunk summaries, both event
+ * files — plus the GET /api/v1/config body, so one transfer backs a node
+ * up and a restore of it clones the node.
+ *
+ * FORMAT (little-endian): the magic "WSA1", then entries
+ *   {uint8 kind, uint16 path_len, path, uint32 length, data, uint32 crc}
+ * with kind 'F' (a file; path relative to the base, e.g.
+ * "hist/moisture/1700000000.dat") or 'C' (the config JSON, path empty),
+ * crc the CRC-32 of data; closed by {'Z', uint32 entry count}. Only the
+ * data trees in kArchiveTrees are walked: the web assets, the TLS key pair
+ * and any legacy import stay out of it (and the config body never carries
+ * the Wi-Fi password).
+ *
+ * CONSISTENCY: both directions run inside an IStorageHold, which commits
+ * what the storage buffers and keeps its writes out for the duration
+ * (LockedDataStorage::runOffline() on target), so the files do not change
+ * under the walk.
+ *
+ * BACKUP: ArchiveSource lists the files once, then reads each straight
+ * into the caller's buffer — through ReadAheadPipe, the reader task's
+ * kChunkBytes blocks — with only the entry framing in between.
+ *
+ * RESTORE: ArchiveRestore stages every file whole (written, fsynced,
+ * closed) under kStagingDir and, only once the end entry checks out,
+ * swaps each staged tree in for the live one. A torn upload, a bad CRC
+ * or a full volume removes the staging and leaves the store as it was;
+ * the volume needs room for the archive beside the live data.
+ *
+ * Pure C++ over stdio and POSIX directories, host-tested.
+ */
+
+#ifndef WATERINGSYSTEM_API_STORAGEARCHIVE_H
+#define WATERINGSYSTEM_API_STORAGEARCHIVE_H
+
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <string>
+#include <vector>
+
+#include "api/OtaPipeline.h"
+
+namespace api {
+
+/// The data trees of the store, relative to its base path.
+constexpr const char* kArchiveTrees[] = {"hist", "rows", "mux", "sum", "rollup", "events"};
+
+/// Where a restore stages the archive, relative to the base path.
+constexpr char kArchiveStagingDir[] = "restore.tmp";
+
+/// Longest relative path an entry may carry.
+constexpr std::size_t kArchiveMaxPath = 96;
+
+/// Largest config entry a restore accepts (the config GET body is ~1 KiB).
+constexpr std::size_t kArchiveMaxConfig = 4096;
+
+/// Runs an archive step while the store is held (see IStorageHold).
+class IStorageJob {
+public:
+    virtual ~IStorageJob() = default;
+
+    /// Do the work; true when it replaced files under the storage.
+    virtual bool run() = 0;
+};
+
+/**
+ * @brief The store quiesced for an archive step: buffered writes
+ * committed first, writes kept out until the job returns, and the
+ * storage's own caches dropped afterwards when the job replaced files.
+ */
+class IStorageHold {
+public:
+    virtual ~IStorageHold() = default;
+
+    virtual void runHeld(IStorageJob& job) = 0;
+};
+
+/**
+ * @brief The archive of the store at @p basePath as a chunk source.
+ *
+ * The file list is taken at construction; receive() then produces the
+ * stream in order, file data read straight into the destination. A file
+ * that vanished or shrank since the listing fails the read (-1).
+ */
+class ArchiveSource final : public IChunkSource {
+public:
+    ArchiveSource(std::string basePath, std::string configJson);
+    ~ArchiveSource() override;
+
+    ArchiveSource(const ArchiveSource&) = delete;
+    ArchiveSource& operator=(const ArchiveSource&) = delete;
+
+    int receive(uint8_t* dst, std::size_t len) override;
+
+    /// Files listed for the archive.
+    std::size_t files() const { return files_.size(); }
+
+    /// Their bytes (framing not included).
+    uint64_t fileBytes() const { return fileBytes_; }
+
+private:
+    struct FileEntry {
+        std::string path;  ///< relative to basePath_
+        uint32_t size = 0;
+    };
+
+    /// Frame the next entry (or the end) into head_; false once done.
+    bool nextEntry();
+
+    void collect(const std::string& rel);
+
+    std::string basePath_;
+    std::string config_;
+    std::vector<FileEntry> files_;
+    uint64_t fileBytes_ = 0;
+
+    std::size_t next_ = 0;        ///< files_ index of the next file entry
+    bool configSent_ = false;
+    bool ended_ = false;
+    std::vector<uint8_t> head_;   ///< framing waiting to go out
+    std::size_t headPos_ = 0;
+    FILE* file_ = nullptr;        ///< the entry being read
+    const char* inline_ = nullptr;  ///< or the config bytes
+    uint32_t left_ = 0;           ///< data bytes still to produce
+    uint32_t crc_ = 0;
+    bool dataDone_ = true;        ///< the entry's crc is queued
+};
+
+/// How a restore ended.
+enum class RestoreOutcome : uint8_t {
+    Ok,
+    ReceiveFailed,  ///< the body was cut off or unreadable
+    BadArchive,     ///< wrong magic, framing, path, CRC or count
+    WriteFailed,    ///< staging or swapping failed (a full volume)
+};
+
+/// Name of @p outcome for logs and error bodies ("bad archive", ...).
+const char* restoreOutcomeName(RestoreOutcome outcome);
+
+/// What a restore did.
+struct RestoreReport {
+    RestoreOutcome outcome = RestoreOutcome::BadArchive;
+    uint32_t files = 0;      ///< file entries staged
+    uint64_t bytes = 0;      ///< their data bytes
+    std::string config;      ///< the config entry, empty when none
+};
+
+class ArchiveRestore {
+public:
+    explicit ArchiveRestore(std::string basePath);
+
+    /**
+     * @brief Stage the archive read from @p source and, when all of it
+     * checks out, swap the staged trees in; anything else leaves the store
+     * untouched. A tree the archive does not carry is removed on the swap:
+     * the store becomes the archive's.
+     */
+    RestoreReport run(IChunkSource& source);
+
+private:
+    bool readExact(IChunkSource& source, uint8_t* dst, std::size_t len);
+    RestoreOutcome stageFile(IChunkSource& source, const std::string& rel, uint32_t length,
+                             uint32_t& crc);
+    bool swapIn();
+
+    std::string basePath_;
+    std::string staging_;
+    bool cutOff_ = false;  ///< the source ended early or failed
+    std::vector<uint8_t> block_;
+};
+
+/// True for a relative entry path under one of kArchiveTrees: no "..",
+/// no empty segment, at most kArchiveMaxPath bytes.
+bool archivePathValid(const std::string& path);
+
+}  // namespace api
+
+#endif /* WATERINGSYSTEM_API_STORAGEARCHIVE_H */
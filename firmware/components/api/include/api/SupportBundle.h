@@ -0,0 +1,102 @@
+// SPDX-FileCopyrightText: 2026 Cryptotomte
+// SPDX-License-Identifier: AGPL-3.0-or-later
+/**
+ * @file SupportBundle.h
+ * @brief GET /api/v1/support-bundle framing: every diagnostic body of the
+ *        API as sections of one text stream (host+target).
+ *
+ * WHY THIS EXISTS: a support case used to start with half a dozen calls —
+ * /status, /config, /metrics (heap and per-task telemetry included),
+ * /events, /logs, /control/trace — plus lines pasted off the UART. The
+ * bundle is all of them in one download, gzipped as it is produced, so it
+ * is one small file whatever the node has been through.
+ *
+ * FORMAT (text, UTF-8): the line kSupportBundleMagic, then per section a
+ * header line `=== <name> <content type>` and the body exactly as its own
+ * endpoint sends it, with a newline added when the body lacks a final one.
+ * A section the node does not have is the line `=== <name> absent: <why>`.
+ * The last line is `=== end <sections>`; a file without it was cut off.
+ * No body starts a line with "=== " (JSON bodies are one line, the
+ * Prometheus text starts its lines with '#' or a metric name), so a reader
+ * splits on header lines.
+ *
+ * MEMORY: the writer holds no body. Streamed sections (metrics, the
+ * decision trace) go through section by section as they are produced;
+ * the others are one endpoint body at a time. On the server the stream
+ * runs through a DeflateSink (~6 KiB) into the chunked sender, so the
+ * bundle is never whole in RAM, compressed or not.
+ *
+ * Pure C++, host-tested.
+ */
+
+#ifndef WATERINGSYSTEM_API_SUPPORTBUNDLE_H
+#define WATERINGSYSTEM_API_SUPPORTBUNDLE_H
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+#include "api/ApiStream.h"
+
+namespace api {
+
+/// The bundle's first line (format version 1), newline included.
+constexpr char kSupportBundleMagic[] = "WateringSystem support bundle 1\n";
+
+/// Events the bundle carries, newest first (an /events page of them).
+constexpr int kSupportBundleEvents = 100;
+
+/**
+ * @brief Frames the bundle's sections onto @p out.
+ *
+ * Open a section with section(), then send() its body to this object (or
+ * hand it to a body streamer as its sink); the next section() or finish()
+ * closes it. A failed send sticks, as in ChunkWriter: everything after it
+ * is dropped and ok() stays false.
+ */
+class SupportBundleWriter final : public IChunkSink {
+public:
+    /// Writes kSupportBundleMagic at once.
+    explicit SupportBundleWriter(IChunkSink& out);
+
+    SupportBundleWriter(const SupportBundleWriter&) = delete;
+    SupportBundleWriter& operator=(const SupportBundleWriter&) = delete;
+
+    /// Close the open section and start @p name, a body of @p contentType.
+    bool section(const char* name, const char* contentType);
+
+    /// A whole section: header and @p body.
+    bool section(const char* name, const char* contentType, const std::string& body);
+
+    /// A section this node does not have, and @p why.
+    bool absent(const char* name, const char* why);
+
+    /// Body bytes of the open section.
+    bool send(const char* data, std::size_t len) override;
+
+    /// Close the open section and write the end line. Call once, last.
+    bool finish();
+
+    bool ok() const { return ok_; }
+
+    /// Sections written, absent ones included.
+    uint32_t sections() const { return sections_; }
+
+    /// Everything written so far, framing included.
+    uint64_t bytes() const { return bytes_; }
+
+private:
+    bool put(const char* data, std::size_t len);
+    bool closeSection();
+
+    IChunkSink& out_;
+    bool ok_ = true;
+    bool open_ = false;      ///< a section's body is being sent
+    bool lineOpen_ = false;  ///< its last byte was not a newline
+    uint32_t sections_ = 0;
+    uint64_t bytes_ = 0;
+};
+
+}  // namespace api
+
+#endif /* WATERINGSYSTEM_API_SUPPORTBUNDLE_H */
@@ -0,0 +1,95 @@
+// SPDX-FileCopyrightText: 2026 Cryptotomte
+// SPDX-License-Identifier: AGPL-3.0-or-later
+/**
+ * @file MockFirmwareSlot.h
+ * @brief In-memory IFirmwareSlot test double (header-only).
+ *
+ * Keeps the written image and the call sequence, and fails on request: a
+ * write once `failWriteAt` bytes are in, or the commit (an image the
+ * bootloader would not accept). Never compiled into target builds (only
+ * included from test code). No IDF includes.
+ */
+
+#ifndef WATERINGSYSTEM_API_TESTING_MOCKFIRMWARESLOT_H
+#define WATERINGSYSTEM_API_TESTING_MOCKFIRMWARESLOT_H
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+#include "interfaces/IFirmwareSlot.h"
+
+/**
+ * @brief IFirmwareSlot over a byte vector, instrumented for tests.
+ */
+class MockFirmwareSlot : public IFirmwareSlot {
+public:
+    explicit MockFirmwareSlot(std::size_t capacityBytes) : capacityBytes_(capacityBytes) {}
+
+    /// The image as written since the last begin().
+    std::vector<uint8_t> image;
+
+    /// Fail the write that would take the image past this many bytes.
+    /// -1 = never.
+    long failWriteAt = -1;
+    bool failCommit = false;
+
+    // Instrumentation.
+    std::size_t begins = 0;
+    std::size_t writeCalls = 0;
+    std::size_t largestWrite = 0;
+    std::size_t commits = 0;   ///< successful
+    std::size_t aborts = 0;    ///< while open
+    bool open = false;
+
+    std::size_t capacity() const override { return capacityBytes_; }
+
+    bool begin(std::size_t imageBytes) override
+    {
+        if (open || imageBytes > capacityBytes_) {
+            return false;
+        }
+        ++begins;
+        image.clear();
+        open = true;
+        return true;
+    }
+
+    bool write(const uint8_t* data, std::size_t len) override
+    {
+        ++writeCalls;
+        if (!open ||
+            (failWriteAt >= 0 && image.size() + len > static_cast<std::size_t>(failWriteAt))) {
+            return false;
+        }
+        image.insert(image.end(), data, data + len);
+        largestWrite = len > largestWrite ? len : largestWrite;
+        return true;
+    }
+
+    bool commit() override
+    {
+        if (!open) {
+            return false;
+        }
+        open = false;
+        if (failCommit) {
+            return false;
+        }
+        ++commits;
+        return true;
+    }
+
+    void abort() override
+    {
+        if (open) {
+            ++aborts;
+            open = false;
+        }
+    }
+
+private:
+    std::size_t capacityBytes_;
+};
+
+#endif /* WATERINGSYSTEM_API_TESTING_MOCKFIRMWARESLOT_H */
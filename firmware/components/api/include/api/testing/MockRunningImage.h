@@ -0,0 +1,61 @@
+// SPDX-FileCopyrightText: 2026 Cryptotomte
+// SPDX-License-Identifier: AGPL-3.0-or-later
+/**
+ * @file MockRunningImage.h
+ * @brief In-memory IRunningImage test double (header-only).
+ *
+ * Serves a byte vector as the running image, its digest computed with
+ * api::Sha256 as EspRunningImage does, and counts the reads. Never
+ * compiled into target builds (only included from test code). No IDF
+ * includes.
+ */
+
+#ifndef WATERINGSYSTEM_API_TESTING_MOCKRUNNINGIMAGE_H
+#define WATERINGSYSTEM_API_TESTING_MOCKRUNNINGIMAGE_H
+
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <utility>
+#include <vector>
+
+#include "api/Sha256.h"
+#include "interfaces/IRunningImage.h"
+
+/**
+ * @brief IRunningImage over a byte vector, instrumented for tests.
+ */
+class MockRunningImage : public IRunningImage {
+public:
+    explicit MockRunningImage(std::vector<uint8_t> bytes) : image(std::move(bytes)) {}
+
+    std::vector<uint8_t> image;
+
+    // Instrumentation.
+    std::size_t reads = 0;
+    std::size_t bytesRead = 0;
+
+    std::size_t size() override { return image.size(); }
+
+    bool sha256(uint8_t out[32]) override
+    {
+        api::Sha256 hash;
+        hash.update(image.data(), image.size());
+        const api::Sha256::Digest digest = hash.finish();
+        std::memcpy(out, digest.data(), digest.size());
+        return true;
+    }
+
+    bool read(std::size_t offset, uint8_t* dst, std::size_t len) override
+    {
+        ++reads;
+        if (offset > image.size() || len > image.size() - offset) {
+            return false;
+        }
+        std::memcpy(dst, image.data() + offset, len);
+        bytesRead += len;
+        return true;
+    }
+};
+
+#endif /* WATERINGSYSTEM_API_TESTING_MOCKRUNNINGIMAGE_H */
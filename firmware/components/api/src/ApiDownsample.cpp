@@ -0,0 +1,310 @@
+// SPDX-FileCopyrightText: 2026 Cryptotomte
+// SPDX-License-Identifier: AGPL-3.0-or-later
+/**
+ * @file ApiDownsample.cpp
+ * @brief Implementation of the MinMax and LTTB history reducers.
+ */
+
+#include "api/ApiDownsample.h"
+
+#include <cmath>
+#include <cstdint>
+#include <utility>
+#include <vector>
+
+#include "api/ApiRequests.h"
+
+namespace api {
+
+namespace {
+
+struct Point {
+    uint32_t epoch = 0;
+    float value = 0.0f;
+};
+
+/// [t0, t1] cut into @p buckets equal time buckets (the last may be short).
+class TimeBuckets {
+public:
+    TimeBuckets(uint32_t t0, uint32_t t1, std::size_t buckets)
+        : t0_(t0), count_(buckets == 0 ? 1 : buckets)
+    {
+        const uint64_t span = (t1 >= t0 ? static_cast<uint64_t>(t1 - t0) : 0u) + 1;
+        width_ = (span + count_ - 1) / count_;
+    }
+
+    std::size_t count() const { return count_; }
+
+    std::size_t of(uint32_t epoch) const
+    {
+        const uint64_t offset = epoch > t0_ ? epoch - t0_ : 0u;
+        const uint64_t index = offset / width_;
+        return index < count_ ? static_cast<std::size_t>(index) : count_ - 1;
+    }
+
+private:
+    uint32_t t0_;
+    std::size_t count_;
+    uint64_t width_ = 1;
+};
+
+void append(HistorySeries& series, const Point& p)
+{
+    series.timestamps.push_back(static_cast<int64_t>(p.epoch));
+    series.values.push_back(p.value);
+}
+
+/// One pass: per bucket the lowest and highest reading, flushed in time
+/// order when the bucket changes. Counts every reading it sees.
+class MinMaxFold final : public IReadingVisitor {
+public:
+    MinMaxFold(HistorySeries& out, const TimeBuckets& buckets)
+        : out_(out), buckets_(buckets)
+    {
+    }
+
+    bool onReading(uint32_t epoch, float value) override
+    {
+        const std::size_t b = buckets_.of(epoch);
+        if (readings_ == 0 || b != bucket_) {
+            flush();
+            bucket_ = b;
+            minIndex_ = maxIndex_ = readings_;
+            min_ = max_ = Point{epoch, value};
+        } else if (value < min_.value) {
+            min_ = Point{epoch, value};
+            minIndex_ = readings_;
+        } else if (value > max_.value) {
+            max_ = Point{epoch, value};
+            maxIndex_ = readings_;
+        }
+        ++readings_;
+        return true;
+    }
+
+    /// Emit the open bucket (call once more after the pass).
+    void flush()
+    {
+        if (readings_ == 0 || flushed_ == readings_) {
+            return;
+        }
+        if (minIndex_ == maxIndex_) {
+            append(out_, min_);
+        } else if (minIndex_ < maxIndex_) {
+            append(out_, min_);
+            append(out_, max_);
+        } else {
+            append(out_, max_);
+            append(out_, min_);
+        }
+        flushed_ = readings_;
+    }
+
+    std::size_t readings() const { return readings_; }
+
+private:
+    HistorySeries& out_;
+    const TimeBuckets& buckets_;
+    std::size_t readings_ = 0;
+    std::size_t flushed_ = 0;
+    std::size_t bucket_ = 0;
+    Point min_;
+    Point max_;
+    std::size_t minIndex_ = 0;
+    std::size_t maxIndex_ = 0;
+};
+
+/// Per-bucket running mean, relative to the window start.
+struct BucketMean {
+    uint64_t epochSum = 0;  ///< sum of (epoch - t0)
+    double valueSum = 0.0;
+    uint32_t count = 0;
+};
+
+/// LTTB pass one: reading count, last reading and the bucket means.
+class LttbMeans final : public IReadingVisitor {
+public:
+    LttbMeans(std::vector<BucketMean>& means, const TimeBuckets& buckets,
+              uint32_t t0)
+        : means_(means), buckets_(buckets), t0_(t0)
+    {
+    }
+
+    bool onReading(uint32_t epoch, float value) override
+    {
+        last_ = Point{epoch, value};
+        ++readings_;
+        BucketMean& m = means_[buckets_.of(epoch)];
+        m.epochSum += epoch - t0_;
+        m.valueSum += value;
+        ++m.count;
+        return true;
+    }
+
+    std::size_t readings() const { return readings_; }
+    Point last() const { return last_; }
+
+private:
+    std::vector<BucketMean>& means_;
+    const TimeBuckets& buckets_;
+    const uint32_t t0_;
+    std::size_t readings_ = 0;
+    Point last_;
+};
+
+/**
+ * LTTB pass two: readings 1 .. n-2 compete per bucket for the largest
+ * triangle with the previous pick and the mean of the next non-empty
+ * bucket (the last reading when there is none). Emits the first reading,
+ * one pick per non-empty bucket, then the last reading.
+ */
+class LttbPicks final : public IReadingVisitor {
+public:
+    LttbPicks(HistorySeries& out, const std::vector<BucketMean>& means,
+              const TimeBuckets& buckets, uint32_t t0, std::size_t readings,
+              Point last)
+        : out_(out),
+          means_(means),
+          buckets_(buckets),
+          t0_(t0),
+          readings_(readings),
+          last_(last)
+    {
+    }
+
+    bool onReading(uint32_t epoch, float value) override
+    {
+        const Point p{epoch, value};
+        if (index_ == 0) {
+            append(out_, p);
+            picked_ = p;
+        } else if (index_ + 1 < readings_) {
+            const std::size_t b = buckets_.of(epoch);
+            if (!open_ || b != bucket_) {
+                commit();
+                openBucket(b);
+            }
+            double area = triangle(picked_, p);
+            if (std::isnan(area)) {
+                area = 0.0;  // still a candidate, never a preferred one
+            }
+            if (area > bestArea_) {
+                best_ = p;
+                bestArea_ = area;
+            }
+        }
+        ++index_;
+        return index_ < readings_;
+    }
+
+    /// Commit the open bucket and emit the last reading.
+    void finish()
+    {
+        commit();
+        if (readings_ > 1) {
+            append(out_, last_);
+        }
+    }
+
+private:
+    void openBucket(std::size_t b)
+    {
+        bucket_ = b;
+        open_ = true;
+        bestArea_ = -1.0;
+        // The next non-empty bucket's mean; buckets only move forward, so
+        // the scans add up to one sweep of the table.
+        std::size_t next = b + 1;
+        while (next < means_.size() && means_[next].count == 0) {
+            ++next;
+        }
+        if (next < means_.size()) {
+            const BucketMean& m = means_[next];
+            cx_ = static_cast<double>(m.epochSum) / m.count;
+            cy_ = m.valueSum / m.count;
+        } else {
+            cx_ = static_cast<double>(last_.epoch - t0_);
+            cy_ = last_.value;
+        }
+    }
+
+    void commit()
+    {
+        if (open_) {
+            append(out_, best_);
+            picked_ = best_;
+            open_ = false;
+        }
+    }
+
+    /// Twice the area of (a, p, c); the factor does not change the winner.
+    double triangle(const Point& a, const Point& p) const
+    {
+        const double ax = static_cast<double>(a.epoch - t0_);
+        const double ay = a.value;
+        const double px = static_cast<double>(p.epoch - t0_);
+        const double py = p.value;
+        return std::fabs((ax - cx_) * (py - ay) - (ax - px) * (cy_ - ay));
+    }
+
+    HistorySeries& out_;
+    const std::vector<BucketMean>& means_;
+    const TimeBuckets& buckets_;
+    const uint32_t t0_;
+    const std::size_t readings_;
+    const Point last_;
+    std::size_t index_ = 0;
+    Point picked_;
+    bool open_ = false;
+    std::size_t bucket_ = 0;
+    Point best_;
+    double bestArea_ = -1.0;
+    double cx_ = 0.0;
+    double cy_ = 0.0;
+};
+
+}  // namespace
+
+bool downsampleHistory(const IDataStorage& storage, HistorySeries& series,
+                       HistoryAggregate aggregate, std::size_t maxPoints)
+{
+    if (aggregate == HistoryAggregate::Avg || maxPoints < kHistoryMinPoints) {
+        return false;
+    }
+    const uint32_t t0 = static_cast<uint32_t>(series.start);
+    const uint32_t t1 = static_cast<uint32_t>(series.end);
+    HistorySeries out;
+
+    if (aggregate == HistoryAggregate::MinMax) {
+        const TimeBuckets buckets(t0, t1, maxPoints / 2);
+        MinMaxFold fold(out, buckets);
+        storage.forEachReading(series.metric, t0, t1, fold);
+        fold.flush();
+        if (fold.readings() <= maxPoints) {
+            return false;
+        }
+    } else {
+        const TimeBuckets buckets(t0, t1, maxPoints - 2);
+        std::vector<BucketMean> means(buckets.count());
+        LttbMeans pass1(means, buckets, t0);
+        storage.forEachReading(series.metric, t0, t1, pass1);
+        if (pass1.readings() <= maxPoints) {
+            return false;
+        }
+        // Up to the last reading pass one saw: later appends are excluded,
+        // and the index bound keeps a ring eviction in between harmless.
+        LttbPicks pass2(out, means, buckets, t0, pass1.readings(), pass1.last());
+        storage.forEachReading(series.metric, t0, pass1.last().epoch, pass2);
+        pass2.finish();
+    }
+
+    series.bucketS = 0;
+    series.timestamps = std::move(out.timestamps);
+    series.values = std::move(out.values);
+    series.mins.clear();
+    series.maxs.clear();
+    series.filled = 0;
+    return true;
+}
+
+}  // namespace api
@@ -0,0 +1,204 @@
+// SPDX-FileCopyrightText: 2026 Cryptotomte
+// SPDX-License-Identifier: AGPL-3.0-or-later
+/**
+ * @file ApiETag.cpp
+ * @brief Implementation of the entity-tag helpers.
+ */
+
+#include "api/ApiETag.h"
+
+#include <cmath>
+#include <cstdio>
+#include <cstring>
+
+namespace api {
+
+void ETagHash::addByte(uint8_t byte)
+{
+    hash_ ^= byte;
+    hash_ *= 16777619u;
+}
+
+ETagHash& ETagHash::add(uint32_t value)
+{
+    for (int shift = 0; shift < 32; shift += 8) {
+        addByte(static_cast<uint8_t>(value >> shift));
+    }
+    return *this;
+}
+
+ETagHash& ETagHash::add(bool value)
+{
+    addByte(value ? 1 : 0);
+    return *this;
+}
+
+ETagHash& ETagHash::add(float value)
+{
+    if (std::isnan(value)) {
+        return add(0x7fc00000u);  // one canonical NaN
+    }
+    if (value == 0.0f) {
+        value = 0.0f;             // -0 prints as 0 too
+    }
+    uint32_t bits = 0;
+    std::memcpy(&bits, &value, sizeof(bits));
+    return add(bits);
+}
+
+ETagHash& ETagHash::add(const std::string& text)
+{
+    // Length first, so "ab"+"c" and "a"+"bc" differ.
+    add(static_cast<uint32_t>(text.size()));
+    for (const char ch : text) {
+        addByte(static_cast<uint8_t>(ch));
+    }
+    return *this;
+}
+
+std::string formatETag(uint32_t salt, uint32_t value, bool weak)
+{
+    char text[24];
+    std::snprintf(text, sizeof(text), "%s\"%08x%08x\"", weak ? "W/" : "",
+                  static_cast<unsigned>(salt), static_cast<unsigned>(value));
+    return text;
+}
+
+uint32_t fingerprint(const EnvironmentalDto& env)
+{
+    return ETagHash().add(env.valid).add(env.temperature).add(env.humidity)
+        .add(env.pressure).value();
+}
+
+uint32_t fingerprint(const SoilDto& soil)
+{
+    return ETagHash().add(soil.valid).add(soil.moisture).add(soil.temperature)
+        .add(soil.humidity).add(soil.ph).add(soil.ec)
+        .add(soil.hasNitrogen).add(soil.nitrogen)
+        .add(soil.hasPhosphorus).add(soil.phosphorus)
+        .add(soil.hasPotassium).add(soil.potassium).value();
+}
+
+uint32_t fingerprint(const LevelDto& level)
+{
+    return ETagHash().add(level.low.valid).add(level.low.waterPresent)
+        .add(level.high.valid).add(level.high.waterPresent).value();
+}
+
+uint32_t fingerprint(const PowerDto& power)
+{
+    return ETagHash().add(power.valid).add(power.busVoltage)
+        .add(power.current).add(power.power).value();
+}
+
+uint32_t fingerprint(const PumpDto& pump)
+{
+    return ETagHash().add(pump.name).add(pump.running)
+        .add(pump.currentRunTimeMs).add(pump.accumulatedRunTimeMs)
+        .add(pump.lastStopReason).value();
+}
+
+uint32_t pumpStateFingerprint(const PumpDto& pump)
+{
+    return ETagHash().add(pump.name).add(pump.running).add(pump.lastStopReason)
+        .value();
+}
+
+uint32_t sensorsFingerprint(const SensorReadingsDto& dto)
+{
+    ETagHash h;
+    h.add(fingerprint(dto.environmental)).add(fingerprint(dto.soil))
+        .add(fingerprint(dto.level)).add(dto.hasPower);
+    h.add(static_cast<uint32_t>(dto.soilProbes.size()));
+    for (const SoilProbeDto& probe : dto.soilProbes) {
+        h.add(static_cast<uint32_t>(probe.address)).add(fingerprint(probe.soil));
+    }
+    if (!dto.soilProbes.empty()) {
+        const SoilBusDto& bus = dto.soilBus;
+        h.add(bus.periodMs).add(bus.readAirtimeUs).add(bus.budgetPermille)
+            .add(bus.measuredPermille).add(bus.polls).add(bus.failures)
+            .add(bus.missed);
+    }
+    if (dto.hasPower) {
+        h.add(fingerprint(dto.power));
+    }
+    // The clock being set or not changes the body shape (null vs number).
+    h.add(dto.hasTimestamp);
+    return h.value();
+}
+
+uint32_t pumpsFingerprint(const std::vector<PumpDto>& pumps)
+{
+    ETagHash h;
+    h.add(static_cast<uint32_t>(pumps.size()));
+    for (const PumpDto& pump : pumps) {
+        h.add(fingerprint(pump));
+    }
+    return h.value();
+}
+
+namespace {
+
+bool isSpace(char c)
+{
+    return c == ' ' || c == '\t';
+}
+
+/// @p tag without a leading `W/`.
+std::string opaquePart(const std::string& tag)
+{
+    return tag.compare(0, 2, "W/") == 0 ? tag.substr(2) : tag;
+}
+
+}  // namespace
+
+bool ifNoneMatchHits(const std::string& header, const std::string& etag)
+{
+    const std::string wanted = opaquePart(etag);
+    std::size_t pos = 0;
+    while (pos < header.size()) {
+        while (pos < header.size() && (isSpace(header[pos]) || header[pos] == ',')) {
+            ++pos;
+        }
+        if (pos == header.size()) {
+            break;
+        }
+        if (header[pos] == '*') {
+            return true;  // any current representation
+        }
+        std::size_t start = pos;
+        if (header.compare(pos, 2, "W/") == 0) {
+            start = pos += 2;
+        }
+        if (pos == header.size() || header[pos] != '"') {
+            return false;
+        }
+        const std::size_t close = header.find('"', pos + 1);
+        if (close == std::string::npos) {
+            return false;
+        }
+        if (header.compare(start, close + 1 - start, wanted) == 0) {
+            return true;
+        }
+        pos = close + 1;
+    }
+    return false;
+}
+
+bool ifRangeHolds(const std::string& header, const std::string& etag)
+{
+    if (etag.empty() || etag.compare(0, 2, "W/") == 0) {
+        return false;
+    }
+    std::size_t first = 0;
+    std::size_t last = header.size();
+    while (first < last && isSpace(header[first])) {
+        ++first;
+    }
+    while (last > first && isSpace(header[last - 1])) {
+        --last;
+    }
+    return header.compare(first, last - first, etag) == 0;
+}
+
+}  // namespace api
@@ -36,12 +36,20 @@ const char* statusLine(ApiStatus status)
     switch (status) {
     case ApiStatus::Ok:
         return "200 OK";
+    case ApiStatus::PartialContent:
+        return "206 Partial Content";
+    case ApiStatus::NotModified:
+        return "304 Not Modified";
     case ApiStatus::BadRequest:
         return "400 Bad Request";
     case ApiStatus::NotFound:
         return "404 Not Found";
     case ApiStatus::Conflict:
         return "409 Conflict";
+    case ApiStatus::RangeNotSatisfiable:
+        return "416 Range Not Satisfiable";
+    case ApiStatus::TooManyRequests:
+        return "429 Too Many Requests";
     case ApiStatus::InternalError:
         return "500 Internal Server Error";
     case ApiStatus::NotImplemented:
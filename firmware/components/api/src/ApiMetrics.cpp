@@ -0,0 +1,822 @@
+// SPDX-FileCopyrightText: 2026 Cryptotomte
+// SPDX-License-Identifier: AGPL-3.0-or-later
+/**
+ * @file ApiMetrics.cpp
+ * @brief Implementation of the HTTP route metrics and the Prometheus body.
+ */
+
+#include "api/ApiMetrics.h"
+
+#include <cinttypes>
+#include <cstdarg>
+#include <cstdio>
+
+#include "network/WifiState.h"
+
+namespace api {
+
+namespace {
+
+constexpr const char* kPrefix = "wateringsystem_";
+
+std::size_t statusClass(int status)
+{
+    if (status < 100 || status > 599) {
+        return kStatusClasses - 1;
+    }
+    return static_cast<std::size_t>(status / 100 - 1);
+}
+
+std::size_t latencyBucket(uint64_t latencyUs)
+{
+    for (std::size_t i = 0; i < kLatencyBuckets; ++i) {
+        if (latencyUs <= (static_cast<uint64_t>(kLatencyBucketBaseUs) << i)) {
+            return i;
+        }
+    }
+    return kLatencyBuckets;
+}
+
+/// Route label pair of @p slot: the route table's path and verb.
+void routeLabels(std::size_t slot, const char*& route, const char*& method)
+{
+    if (slot == kStaticAssetsSlot) {
+        route = "/*";
+        method = "GET";
+        return;
+    }
+    route = "unmatched";
+    method = "ANY";
+    const ApiRoute* routes = apiRoutes();
+    for (std::size_t i = 0; i < apiRouteCount(); ++i) {
+        if (metricSlot(routes[i].id) == slot) {
+            route = routes[i].path;
+            method = routes[i].method == HttpMethod::Get ? "GET" : "POST";
+            return;
+        }
+    }
+}
+
+/// Text lines over a ChunkWriter.
+class MetricsWriter {
+public:
+    explicit MetricsWriter(IChunkSink& sink) : out_(sink) {}
+
+    void family(const char* name, const char* type, const char* help)
+    {
+        line("# HELP %s%s %s\n", kPrefix, name, help);
+        line("# TYPE %s%s %s\n", kPrefix, name, type);
+    }
+
+    /// One unlabelled sample.
+    void sample(const char* name, uint64_t value)
+    {
+        line("%s%s %" PRIu64 "\n", kPrefix, name, value);
+    }
+
+    /// A gauge or counter family with its single sample.
+    void scalar(const char* name, const char* type, const char* help, uint64_t value)
+    {
+        family(name, type, help);
+        sample(name, value);
+    }
+
+    /// Microseconds as seconds, exactly.
+    void seconds(const char* name, const char* labels, uint64_t us)
+    {
+        line("%s%s%s %" PRIu64 ".%06" PRIu64 "\n", kPrefix, name, labels,
+             us / 1000000u, us % 1000000u);
+    }
+
+    __attribute__((format(printf, 2, 3))) void line(const char* fmt, ...)
+    {
+        char buf[192];
+        va_list args;
+        va_start(args, fmt);
+        const int n = std::vsnprintf(buf, sizeof buf, fmt, args);
+        va_end(args);
+        if (n > 0) {
+            out_.put(buf, static_cast<std::size_t>(n) < sizeof buf
+                              ? static_cast<std::size_t>(n)
+                              : sizeof buf - 1);
+        }
+    }
+
+    bool finish() { return out_.flush(); }
+
+private:
+    ChunkWriter out_;
+};
+
+void writeRoutes(MetricsWriter& w, const HttpMetricsSnapshot& http)
+{
+    static const char* const kClassNames[kStatusClasses] = {"1xx", "2xx", "3xx",
+                                                            "4xx", "5xx"};
+    const std::size_t slots = http.size() < kMetricSlots ? http.size() : kMetricSlots;
+    const char* route = nullptr;
+    const char* method = nullptr;
+
+    w.family("http_requests_total", "counter",
+             "HTTP requests answered, by route and status class.");
+    for (std::size_t s = 0; s < slots; ++s) {
+        routeLabels(s, route, method);
+        for (std::size_t c = 0; c < kStatusClasses; ++c) {
+            if (http[s].statusClasses[c] != 0) {
+                w.line("%shttp_requests_total{route=\"%s\",method=\"%s\",code=\"%s\"} %" PRIu32 "\n",
+                       kPrefix, route, method, kClassNames[c], http[s].statusClasses[c]);
+            }
+        }
+    }
+
+    w.family("http_response_bytes_total", "counter", "Response body bytes sent.");
+    for (std::size_t s = 0; s < slots; ++s) {
+        if (http[s].requests == 0) {
+            continue;
+        }
+        routeLabels(s, route, method);
+        w.line("%shttp_response_bytes_total{route=\"%s\",method=\"%s\"} %" PRIu64 "\n",
+               kPrefix, route, method, http[s].bytesSent);
+    }
+
+    w.family("http_request_duration_seconds", "histogram",
+             "Handler time from request to last byte.");
+    for (std::size_t s = 0; s < slots; ++s) {
+        const RouteMetrics& m = http[s];
+        if (m.requests == 0) {
+            continue;
+        }
+        routeLabels(s, route, method);
+        uint64_t cumulative = 0;
+        for (std::size_t b = 0; b < kLatencyBuckets; ++b) {
+            cumulative += m.latency[b];
+            const double le =
+                static_cast<double>(static_cast<uint64_t>(kLatencyBucketBaseUs) << b) / 1e6;
+            w.line("%shttp_request_duration_seconds_bucket{route=\"%s\",method=\"%s\",le=\"%g\"} %" PRIu64 "\n",
+                   kPrefix, route, method, le, cumulative);
+        }
+        cumulative += m.latency[kLatencyBuckets];
+        w.line("%shttp_request_duration_seconds_bucket{route=\"%s\",method=\"%s\",le=\"+Inf\"} %" PRIu64 "\n",
+               kPrefix, route, method, cumulative);
+        char labels[96];
+        std::snprintf(labels, sizeof labels, "{route=\"%s\",method=\"%s\"}", route, method);
+        w.seconds("http_request_duration_seconds_sum", labels, m.latencySumUs);
+        w.line("%shttp_request_duration_seconds_count%s %" PRIu32 "\n", kPrefix,
+               labels, m.requests);
+    }
+}
+
+void writeSystem(MetricsWriter& w, const SystemMetricsDto& sys)
+{
+    w.family("uptime_seconds", "gauge", "Time since boot.");
+    w.seconds("uptime_seconds", "", sys.uptimeMs * 1000u);
+    w.scalar("heap_free_bytes", "gauge", "Free heap.", sys.heapFreeBytes);
+    w.scalar("heap_min_free_bytes", "gauge", "Lowest free heap since boot.",
+             sys.heapMinFreeBytes);
+    w.scalar("heap_largest_free_block_bytes", "gauge",
+             "Largest allocatable heap block.", sys.heapLargestBlockBytes);
+    w.scalar("tasks", "gauge", "FreeRTOS tasks.", sys.taskCount);
+    w.scalar("httpd_stack_free_bytes", "gauge",
+             "Unused httpd task stack at its deepest point.", sys.httpdStackFreeBytes);
+    w.scalar("storage_total_bytes", "gauge", "Data filesystem size.",
+             sys.storage.totalBytes);
+    w.scalar("storage_used_bytes", "gauge", "Data filesystem bytes in use.",
+             sys.storage.usedBytes);
+    w.scalar("storage_appended_bytes_total", "counter",
+             "Record bytes appended to storage.", sys.storage.writes.bytesAppended);
+    w.scalar("storage_syncs_total", "counter", "Storage durability points.",
+             sys.storage.writes.syncs);
+    w.family("storage_append_seconds_total", "counter",
+             "Time spent in storage appends and flushes.");
+    w.seconds("storage_append_seconds_total", "", sys.storage.writes.appendUs);
+    w.scalar("storage_queue_depth", "gauge", "Storage writes waiting.",
+             sys.storageQueueDepth);
+    w.scalar("storage_queue_dropped_total", "counter",
+             "Storage writes refused by a full queue.", sys.storageQueueDropped);
+    w.scalar("storage_queue_coalesced_total", "counter",
+             "Repeated events folded into a queued one.", sys.storageQueueCoalesced);
+    w.scalar("storage_writer_waits_total", "counter",
+             "Storage writes that blocked on the lock.", sys.storageWriterWaits);
+    w.scalar("response_cache_hits_total", "counter", "Cached API bodies served.",
+             sys.responseCacheHits);
+    w.scalar("response_cache_misses_total", "counter", "API bodies rebuilt.",
+             sys.responseCacheMisses);
+    w.scalar("stream_clients", "gauge", "Connected /api/v1/stream clients.",
+             sys.streamClients);
+    w.scalar("api_arena_bytes", "gauge", "Per-request JSON arena size.",
+             sys.arenaCapacityBytes);
+    w.scalar("api_arena_high_water_bytes", "gauge",
+             "Most of the JSON arena one request used.", sys.arenaHighWaterBytes);
+    w.scalar("api_arena_fallbacks_total", "counter",
+             "JSON allocations that did not fit the arena.", sys.arenaFallbacks);
+    w.scalar("api_throttled_requests_total", "counter",
+             "Requests refused by the per-client rate limit.", sys.throttledRequests);
+}
+
+void writeModbus(MetricsWriter& w, const SystemMetricsDto& sys)
+{
+    static const struct {
+        const char* name;
+        uint32_t ModbusLinkDto::*count;
+    } kResults[] = {
+        {"ok", &ModbusLinkDto::ok},
+        {"timeout", &ModbusLinkDto::timeouts},
+        {"frame_error", &ModbusLinkDto::frameErrors},
+        {"exception", &ModbusLinkDto::exceptions},
+        {"other", &ModbusLinkDto::otherErrors},
+    };
+    char labels[48];
+
+    w.family("modbus_requests_total", "counter",
+             "RS485 register transfers, by slave, function and outcome.");
+    for (const ModbusLinkDto& link : sys.modbusLinks) {
+        for (const auto& r : kResults) {
+            w.line("%smodbus_requests_total{slave=\"%u\",function=\"%u\",result=\"%s\"} %" PRIu32 "\n",
+                   kPrefix, static_cast<unsigned>(link.address),
+                   static_cast<unsigned>(link.function), r.name, link.*r.count);
+        }
+    }
+
+    w.family("modbus_request_duration_seconds", "histogram",
+             "RS485 transfer time, request out to response in or timeout.");
+    for (const ModbusLinkDto& link : sys.modbusLinks) {
+        std::snprintf(labels, sizeof labels, "slave=\"%u\",function=\"%u\"",
+                      static_cast<unsigned>(link.address),
+                      static_cast<unsigned>(link.function));
+        uint64_t cumulative = 0;
+        for (std::size_t b = 0; b + 1 < link.latency.size(); ++b) {
+            cumulative += link.latency[b];
+            const double le =
+                static_cast<double>(static_cast<uint64_t>(sys.modbusLatencyBaseUs) << b) / 1e6;
+            w.line("%smodbus_request_duration_seconds_bucket{%s,le=\"%g\"} %" PRIu64 "\n",
+                   kPrefix, labels, le, cumulative);
+        }
+        if (!link.latency.empty()) {
+            cumulative += link.latency.back();
+        }
+        w.line("%smodbus_request_duration_seconds_bucket{%s,le=\"+Inf\"} %" PRIu64 "\n",
+               kPrefix, labels, cumulative);
+        char braced[52];
+        std::snprintf(braced, sizeof braced, "{%s}", labels);
+        w.seconds("modbus_request_duration_seconds_sum", braced, link.latencySumUs);
+        w.line("%smodbus_request_duration_seconds_count%s %" PRIu64 "\n", kPrefix,
+               braced, cumulative);
+    }
+
+    w.family("modbus_last_success_seconds", "gauge",
+             "Uptime at the last good transfer (slaves never answered are left out).");
+    for (const ModbusLinkDto& link : sys.modbusLinks) {
+        if (link.lastSuccessMs < 0) {
+            continue;
+        }
+        char braced[52];
+        std::snprintf(braced, sizeof braced, "{slave=\"%u\",function=\"%u\"}",
+                      static_cast<unsigned>(link.address),
+                      static_cast<unsigned>(link.function));
+        w.seconds("modbus_last_success_seconds", braced,
+                  static_cast<uint64_t>(link.lastSuccessMs) * 1000u);
+    }
+
+    w.scalar("modbus_untracked_requests_total", "counter",
+             "RS485 transfers past the per-link table.", sys.modbusUntracked);
+    w.family("modbus_bus_busy_seconds_total", "counter",
+             "Time the RS485 bus spent in transfers (rate() is the utilization).");
+    w.seconds("modbus_bus_busy_seconds_total", "", sys.modbusBusyUs);
+}
+
+void writeTasks(MetricsWriter& w, const SystemMetricsDto& sys)
+{
+    w.family("task_cpu_ratio", "gauge",
+             "Share of one core each task ran in the last telemetry window.");
+    for (const TaskMetricsDto& t : sys.tasks) {
+        char core[12];  // any int: "-2147483648" plus the NUL
+        if (t.core < 0) {
+            std::snprintf(core, sizeof core, "any");
+        } else {
+            std::snprintf(core, sizeof core, "%d", t.core);
+        }
+        w.line("%stask_cpu_ratio{task=\"%s\",core=\"%s\"} %" PRIu32 ".%03" PRIu32 "\n",
+               kPrefix, t.name.c_str(), core, t.cpuPermille / 1000u, t.cpuPermille % 1000u);
+    }
+    w.family("task_stack_free_bytes", "gauge",
+             "Unused task stack at its deepest point.");
+    for (const TaskMetricsDto& t : sys.tasks) {
+        w.line("%stask_stack_free_bytes{task=\"%s\"} %" PRIu32 "\n", kPrefix,
+               t.name.c_str(), t.stackFreeBytes);
+    }
+    w.family("task_telemetry_window_seconds", "gauge",
+             "Span the task CPU shares cover.");
+    w.seconds("task_telemetry_window_seconds", "", sys.taskWindowUs);
+
+    static const struct {
+        const char* name;
+        const char* help;
+        uint32_t HeapCapsDto::*bytes;
+    } kHeapGauges[] = {
+        {"heap_caps_total_bytes", "Heap size, by capability.", &HeapCapsDto::totalBytes},
+        {"heap_caps_free_bytes", "Free heap, by capability.", &HeapCapsDto::freeBytes},
+        {"heap_caps_min_free_bytes", "Lowest free heap since boot, by capability.",
+         &HeapCapsDto::minFreeBytes},
+        {"heap_caps_largest_free_block_bytes",
+         "Largest allocatable heap block, by capability.", &HeapCapsDto::largestBlockBytes},
+    };
+    for (const auto& g : kHeapGauges) {
+        w.family(g.name, "gauge", g.help);
+        for (const HeapCapsDto& heap : sys.heaps) {
+            w.line("%s%s{caps=\"%s\"} %" PRIu32 "\n", kPrefix, g.name,
+                   heap.caps.c_str(), heap.*g.bytes);
+        }
+    }
+}
+
+void writeBuffers(MetricsWriter& w, const SystemMetricsDto& sys)
+{
+    w.family("buffer_budget_bytes", "gauge",
+             "RAM granted to each cache or ring for this board.");
+    for (const BufferPoolDto& b : sys.buffers) {
+        w.line("%sbuffer_budget_bytes{pool=\"%s\"} %" PRIu32 "\n", kPrefix, b.pool.c_str(),
+               b.budgetBytes);
+    }
+    w.family("buffer_used_bytes", "gauge", "RAM each cache or ring holds, by placement.");
+    for (const BufferPoolDto& b : sys.buffers) {
+        w.line("%sbuffer_used_bytes{pool=\"%s\",placement=\"internal\"} %" PRIu32 "\n",
+               kPrefix, b.pool.c_str(), b.internalBytes);
+        w.line("%sbuffer_used_bytes{pool=\"%s\",placement=\"psram\"} %" PRIu32 "\n",
+               kPrefix, b.pool.c_str(), b.psramBytes);
+    }
+    w.family("buffer_peak_bytes", "gauge", "Most RAM each cache or ring held at once.");
+    for (const BufferPoolDto& b : sys.buffers) {
+        w.line("%sbuffer_peak_bytes{pool=\"%s\"} %" PRIu32 "\n", kPrefix, b.pool.c_str(),
+               b.peakBytes);
+    }
+    w.family("buffer_alloc_failures_total", "counter",
+             "Buffer allocations neither PSRAM nor internal RAM could serve.");
+    for (const BufferPoolDto& b : sys.buffers) {
+        w.line("%sbuffer_alloc_failures_total{pool=\"%s\"} %" PRIu32 "\n", kPrefix,
+               b.pool.c_str(), b.failures);
+    }
+}
+
+void writeLocks(MetricsWriter& w, const SystemMetricsDto& sys)
+{
+    static const struct {
+        const char* name;
+        const char* help;
+        uint32_t LockMetricsDto::*count;
+    } kLockCounters[] = {
+        {"lock_acquisitions_total", "Decorator mutex acquisitions.",
+         &LockMetricsDto::acquisitions},
+        {"lock_contended_total", "Decorator mutex acquisitions that had to wait.",
+         &LockMetricsDto::contended},
+    };
+    for (const auto& c : kLockCounters) {
+        w.family(c.name, "counter", c.help);
+        for (const LockMetricsDto& l : sys.locks) {
+            w.line("%s%s{lock=\"%s\"} %" PRIu32 "\n", kPrefix, c.name, l.name.c_str(),
+                   l.*c.count);
+        }
+    }
+
+    static const struct {
+        const char* name;
+        const char* type;
+        const char* help;
+        uint32_t LockMetricsDto::*us;
+    } kLockTimes[] = {
+        {"lock_wait_seconds_total", "counter",
+         "Time spent waiting for a decorator mutex (over contended_total: the mean).",
+         &LockMetricsDto::waitUs},
+        {"lock_wait_max_seconds", "gauge", "Longest wait for a decorator mutex.",
+         &LockMetricsDto::maxWaitUs},
+        {"lock_hold_max_seconds", "gauge", "Longest a decorator mutex was held.",
+         &LockMetricsDto::maxHoldUs},
+    };
+    for (const auto& t : kLockTimes) {
+        w.family(t.name, t.type, t.help);
+        for (const LockMetricsDto& l : sys.locks) {
+            char braced[40];
+            std::snprintf(braced, sizeof braced, "{lock=\"%s\"}", l.name.c_str());
+            w.seconds(t.name, braced, l.*t.us);
+        }
+    }
+}
+
+void writeWatchdog(MetricsWriter& w, const SystemMetricsDto& sys)
+{
+    w.family("watchdog_feed_interval_seconds", "histogram",
+             "Time between task watchdog feeds, per subscribed task.");
+    for (const WatchdogFeedDto& feed : sys.watchdogFeeds) {
+        char labels[40];
+        std::snprintf(labels, sizeof labels, "task=\"%s\"", feed.task.c_str());
+        uint64_t cumulative = 0;
+        for (std::size_t b = 0; b + 1 < feed.intervals.size(); ++b) {
+            cumulative += feed.intervals[b];
+            const double le =
+                static_cast<double>(static_cast<uint64_t>(sys.watchdogBucketBaseUs) << b) / 1e6;
+            w.line("%swatchdog_feed_interval_seconds_bucket{%s,le=\"%g\"} %" PRIu64 "\n",
+                   kPrefix, labels, le, cumulative);
+        }
+        if (!feed.intervals.empty()) {
+            cumulative += feed.intervals.back();
+        }
+        w.line("%swatchdog_feed_interval_seconds_bucket{%s,le=\"+Inf\"} %" PRIu64 "\n",
+               kPrefix, labels, cumulative);
+        char braced[44];
+        std::snprintf(braced, sizeof braced, "{%s}", labels);
+        w.seconds("watchdog_feed_interval_seconds_sum", braced, feed.sumUs);
+        w.line("%swatchdog_feed_interval_seconds_count%s %" PRIu64 "\n", kPrefix, braced,
+               cumulative);
+    }
+
+    w.family("watchdog_feed_interval_max_seconds", "gauge",
+             "Longest time between task watchdog feeds since boot.");
+    for (const WatchdogFeedDto& feed : sys.watchdogFeeds) {
+        char braced[44];
+        std::snprintf(braced, sizeof braced, "{task=\"%s\"}", feed.task.c_str());
+        w.seconds("watchdog_feed_interval_max_seconds", braced, feed.maxIntervalUs);
+    }
+}
+
+/// @p d's histogram samples in family @p name; @p labels are "" or
+/// `key="value"`.
+void writeTickHistogram(MetricsWriter& w, const char* name, const char* labels,
+                        const TickDurationDto& d, uint32_t baseUs)
+{
+    const char* comma = labels[0] != '\0' ? "," : "";
+    uint64_t cumulative = 0;
+    for (std::size_t b = 0; b + 1 < d.durations.size(); ++b) {
+        cumulative += d.durations[b];
+        const double le = static_cast<double>(static_cast<uint64_t>(baseUs) << b) / 1e6;
+        w.line("%s%s_bucket{%s%sle=\"%g\"} %" PRIu64 "\n", kPrefix, name, labels, comma, le,
+               cumulative);
+    }
+    if (!d.durations.empty()) {
+        cumulative += d.durations.back();
+    }
+    w.line("%s%s_bucket{%s%sle=\"+Inf\"} %" PRIu64 "\n", kPrefix, name, labels, comma,
+           cumulative);
+    char braced[40] = "";
+    if (labels[0] != '\0') {
+        std::snprintf(braced, sizeof braced, "{%s}", labels);
+    }
+    char sample[64];
+    std::snprintf(sample, sizeof sample, "%s_sum", name);
+    w.seconds(sample, braced, d.sumUs);
+    w.line("%s%s_count%s %" PRIu64 "\n", kPrefix, name, braced, cumulative);
+}
+
+void writeTicks(MetricsWriter& w, const SystemMetricsDto& sys)
+{
+    w.family("watering_tick_duration_seconds", "histogram",
+             "Time the watering task spends on one decision tick.");
+    writeTickHistogram(w, "watering_tick_duration_seconds", "", sys.tick,
+                       sys.tickBucketBaseUs);
+
+    w.family("watering_tick_phase_duration_seconds", "histogram",
+             "Time one watering tick spends in each phase.");
+    for (const TickDurationDto& phase : sys.tickPhases) {
+        char labels[40];
+        std::snprintf(labels, sizeof labels, "phase=\"%s\"", phase.phase.c_str());
+        writeTickHistogram(w, "watering_tick_phase_duration_seconds", labels, phase,
+                           sys.tickBucketBaseUs);
+    }
+
+    w.family("watering_tick_max_seconds", "gauge", "Longest watering tick since boot.");
+    w.seconds("watering_tick_max_seconds", "", sys.tick.maxUs);
+    w.family("watering_tick_phase_max_seconds", "gauge",
+             "Longest time one watering tick spent in each phase since boot.");
+    for (const TickDurationDto& phase : sys.tickPhases) {
+        char braced[44];
+        std::snprintf(braced, sizeof braced, "{phase=\"%s\"}", phase.phase.c_str());
+        w.seconds("watering_tick_phase_max_seconds", braced, phase.maxUs);
+    }
+
+    if (sys.tickBudgetUs != 0) {
+        w.family("watering_tick_budget_seconds", "gauge",
+                 "Watering tick duration past which a tick is over budget.");
+        w.seconds("watering_tick_budget_seconds", "", sys.tickBudgetUs);
+    }
+    w.scalar("watering_tick_over_budget_total", "counter",
+             "Watering ticks that took longer than the budget.", sys.ticksOverBudget);
+}
+
+void writeLifetime(MetricsWriter& w, const SystemMetricsDto& sys)
+{
+    w.family("lifetime_total", "counter",
+             "Totals kept across resets and power cycles (run times in ms).");
+    for (const LifetimeCounterDto& c : sys.lifetime) {
+        w.line("%slifetime_total{counter=\"%s\"} %" PRIu64 "\n", kPrefix, c.name.c_str(),
+               c.value);
+    }
+}
+
+void writeWifi(MetricsWriter& w, const SystemMetricsDto& sys)
+{
+    w.family("wifi_power_save", "gauge",
+             "Station modem sleep in effect (1 for the active mode).");
+    for (WifiPowerSave mode : {WifiPowerSave::None, WifiPowerSave::MinModem,
+                               WifiPowerSave::MaxModem}) {
+        const char* name = wifiPowerSaveName(mode);
+        w.line("%swifi_power_save{mode=\"%s\"} %d\n", kPrefix, name,
+               sys.wifiPowerSave == name ? 1 : 0);
+    }
+}
+
+void writePower(MetricsWriter& w, const SystemMetricsDto& sys)
+{
+    w.family("pm_state_seconds_total", "counter",
+             "Time in each power state the firmware's locks demanded (idle: light "
+             "sleep allowed).");
+    for (const PowerStateDto& s : sys.powerStates) {
+        char braced[40];
+        std::snprintf(braced, sizeof braced, "{state=\"%s\"}", s.state.c_str());
+        w.seconds("pm_state_seconds_total", braced, s.us);
+    }
+    w.family("pm_lock_acquisitions_total", "counter",
+             "Power-management lock acquisitions, per lock kind.");
+    for (const PowerLockDto& l : sys.powerLocks) {
+        w.line("%spm_lock_acquisitions_total{lock=\"%s\"} %" PRIu32 "\n", kPrefix,
+               l.lock.c_str(), l.acquisitions);
+    }
+}
+
+void writeMqtt(MetricsWriter& w, const MqttUplinkStats& m)
+{
+    w.scalar("mqtt_connected", "gauge", "1 while the broker session is up.",
+             m.connected ? 1 : 0);
+    w.scalar("mqtt_replaying", "gauge",
+             "1 while history from an outage is being replayed.", m.replaying ? 1 : 0);
+    w.scalar("mqtt_inflight_messages", "gauge",
+             "QoS 1 messages awaiting their PUBACK.", m.inflight);
+    w.scalar("mqtt_acked_through_epoch_seconds", "gauge",
+             "Epoch through which the broker acknowledged everything (0 = never).",
+             m.watermark);
+    w.scalar("mqtt_connects_total", "counter", "Broker sessions established.",
+             m.connects);
+    w.family("mqtt_published_total", "counter",
+             "Messages taken by the client, live batches and replay pages.");
+    w.line("%smqtt_published_total{kind=\"batch\"} %" PRIu32 "\n", kPrefix, m.batches);
+    w.line("%smqtt_published_total{kind=\"replay\"} %" PRIu32 "\n", kPrefix,
+           m.replayPages);
+    w.scalar("mqtt_acked_total", "counter", "PUBACKs received.", m.acked);
+    w.scalar("mqtt_spooled_batches_total", "counter",
+             "Live batches that fell due offline, left to the history replay.", m.spooled);
+    w.scalar("mqtt_rejected_publishes_total", "counter",
+             "Publishes the client refused (outbox full), retried later.", m.rejected);
+    w.scalar("mqtt_dropped_messages_total", "counter",
+             "Pump and event messages lost to a full batch queue.", m.droppedMessages);
+}
+
+void writeTlsHandshakes(MetricsWriter& w, const char* kind, const TlsHandshakeDto& h)
+{
+    uint64_t cumulative = 0;
+    for (std::size_t b = 0; b < kLatencyBuckets; ++b) {
+        cumulative += h.durations[b];
+        const double le =
+            static_cast<double>(static_cast<uint64_t>(kLatencyBucketBaseUs) << b) / 1e6;
+        w.line("%stls_handshake_duration_seconds_bucket{kind=\"%s\",le=\"%g\"} %" PRIu64 "\n",
+               kPrefix, kind, le, cumulative);
+    }
+    cumulative += h.durations[kLatencyBuckets];
+    w.line("%stls_handshake_duration_seconds_bucket{kind=\"%s\",le=\"+Inf\"} %" PRIu64 "\n",
+           kPrefix, kind, cumulative);
+    char braced[24];
+    std::snprintf(braced, sizeof braced, "{kind=\"%s\"}", kind);
+    w.seconds("tls_handshake_duration_seconds_sum", braced, h.sumUs);
+    w.line("%stls_handshake_duration_seconds_count%s %" PRIu32 "\n", kPrefix, braced,
+           h.count);
+}
+
+void writeTls(MetricsWriter& w, const TlsStats& t)
+{
+    w.scalar("tls_sessions_open", "gauge", "TLS sessions the HTTPS server holds.",
+             t.sessionsOpen);
+    w.family("tls_handshakes_total", "counter",
+             "TLS handshakes completed: full (key exchange and signature) or "
+             "resumed from a session ticket.");
+    w.line("%stls_handshakes_total{kind=\"full\"} %" PRIu32 "\n", kPrefix, t.full.count);
+    w.line("%stls_handshakes_total{kind=\"resumed\"} %" PRIu32 "\n", kPrefix,
+           t.resumed.count);
+    w.scalar("tls_handshake_failures_total", "counter",
+             "TLS handshakes begun that never completed.", t.failed);
+    w.family("tls_handshake_duration_seconds", "histogram",
+             "Time from the ClientHello to the session being up.");
+    writeTlsHandshakes(w, "full", t.full);
+    writeTlsHandshakes(w, "resumed", t.resumed);
+}
+
+void writeSessions(MetricsWriter& w, const HttpSessionStats& h)
+{
+    w.scalar("http_sessions_max", "gauge", "HTTP sessions the server holds open at most.",
+             h.maxOpen);
+    w.scalar("http_sessions_open", "gauge", "HTTP sessions open now.", h.open);
+    w.scalar("http_sessions_open_peak", "gauge", "Most HTTP sessions open at once since boot.",
+             h.peakOpen);
+    w.scalar("http_sessions_opened_total", "counter",
+             "HTTP sessions accepted, one TCP handshake each: reconnect churn.", h.opened);
+    w.scalar("http_sessions_closed_total", "counter",
+             "HTTP sessions closed, by either end or the idle purge.", h.closed);
+    w.scalar("http_sessions_untracked_total", "counter",
+             "HTTP sessions opened while the session table was full.", h.untracked);
+    w.family("http_session_requests", "gauge", "Requests answered on each open session.");
+    for (const HttpSessionDto& s : h.sessions) {
+        w.line("%shttp_session_requests{fd=\"%d\"} %" PRIu32 "\n", kPrefix, s.fd,
+               s.requests);
+    }
+    w.family("http_session_sent_bytes", "gauge", "Body bytes sent on each open session.");
+    for (const HttpSessionDto& s : h.sessions) {
+        w.line("%shttp_session_sent_bytes{fd=\"%d\"} %" PRIu64 "\n", kPrefix, s.fd,
+               s.bytesSent);
+    }
+    w.family("http_session_age_seconds", "gauge", "Time each open session has been open.");
+    for (const HttpSessionDto& s : h.sessions) {
+        char braced[24];
+        std::snprintf(braced, sizeof braced, "{fd=\"%d\"}", s.fd);
+        w.seconds("http_session_age_seconds", braced, s.ageUs);
+    }
+    w.family("http_session_idle_seconds", "gauge",
+             "Time since each open session's last request.");
+    for (const HttpSessionDto& s : h.sessions) {
+        char braced[24];
+        std::snprintf(braced, sizeof braced, "{fd=\"%d\"}", s.fd);
+        w.seconds("http_session_idle_seconds", braced, s.idleUs);
+    }
+}
+
+}  // namespace
+
+void HttpMetrics::record(std::size_t slot, int status, uint64_t bytes,
+                         int64_t latencyUs)
+{
+    if (slot >= kMetricSlots) {
+        return;
+    }
+    const uint64_t us = latencyUs > 0 ? static_cast<uint64_t>(latencyUs) : 0u;
+    std::lock_guard<StaticMutex> lock(mutex_);
+    RouteMetrics& m = slots_[slot];
+    ++m.requests;
+    ++m.statusClasses[statusClass(status)];
+    m.bytesSent += bytes;
+    ++m.latency[latencyBucket(us)];
+    m.latencySumUs += us;
+}
+
+HttpMetricsSnapshot HttpMetrics::snapshot() const
+{
+    std::lock_guard<StaticMutex> lock(mutex_);
+    return HttpMetricsSnapshot(slots_.begin(), slots_.end());
+}
+
+void TlsMetrics::began()
+{
+    std::lock_guard<StaticMutex> lock(mutex_);
+    if (pending_) {
+        ++stats_.failed;
+    }
+    pending_ = true;
+}
+
+void TlsMetrics::completed(bool resumed, int64_t durationUs)
+{
+    const uint64_t us = durationUs > 0 ? static_cast<uint64_t>(durationUs) : 0u;
+    std::lock_guard<StaticMutex> lock(mutex_);
+    pending_ = false;
+    TlsHandshakeDto& h = resumed ? stats_.resumed : stats_.full;
+    ++h.count;
+    h.sumUs += us;
+    ++h.durations[latencyBucket(us)];
+    ++stats_.sessionsOpen;
+}
+
+void TlsMetrics::closed()
+{
+    std::lock_guard<StaticMutex> lock(mutex_);
+    if (stats_.sessionsOpen > 0) {
+        --stats_.sessionsOpen;
+    }
+}
+
+TlsStats TlsMetrics::snapshot() const
+{
+    std::lock_guard<StaticMutex> lock(mutex_);
+    return stats_;
+}
+
+void SocketMetrics::setCapacity(uint32_t maxOpen)
+{
+    std::lock_guard<StaticMutex> lock(mutex_);
+    maxOpen_ = maxOpen;
+}
+
+void SocketMetrics::opened(int fd, int64_t nowUs)
+{
+    std::lock_guard<StaticMutex> lock(mutex_);
+    ++opened_;
+    ++open_;
+    peakOpen_ = open_ > peakOpen_ ? open_ : peakOpen_;
+    for (Slot& slot : slots_) {
+        if (slot.fd < 0) {
+            slot = Slot{fd, nowUs, nowUs, 0, 0};
+            return;
+        }
+    }
+    ++untracked_;
+}
+
+void SocketMetrics::request(int fd, uint64_t bytes, int64_t nowUs)
+{
+    std::lock_guard<StaticMutex> lock(mutex_);
+    for (Slot& slot : slots_) {
+        if (slot.fd == fd) {
+            ++slot.requests;
+            slot.bytesSent += bytes;
+            slot.lastUs = nowUs;
+            return;
+        }
+    }
+}
+
+void SocketMetrics::closed(int fd)
+{
+    std::lock_guard<StaticMutex> lock(mutex_);
+    ++closed_;
+    if (open_ > 0) {
+        --open_;
+    }
+    for (Slot& slot : slots_) {
+        if (slot.fd == fd) {
+            slot = Slot{};
+            return;
+        }
+    }
+}
+
+HttpSessionStats SocketMetrics::snapshot(int64_t nowUs) const
+{
+    HttpSessionStats stats;
+    stats.sessions.reserve(kMaxSessions);
+    auto since = [nowUs](int64_t atUs) {
+        return nowUs > atUs ? static_cast<uint64_t>(nowUs - atUs) : 0u;
+    };
+    std::lock_guard<StaticMutex> lock(mutex_);
+    stats.maxOpen = maxOpen_;
+    stats.open = open_;
+    stats.peakOpen = peakOpen_;
+    stats.opened = opened_;
+    stats.closed = closed_;
+    stats.untracked = untracked_;
+    for (const Slot& slot : slots_) {
+        if (slot.fd >= 0) {
+            stats.sessions.push_back(HttpSessionDto{slot.fd, since(slot.openedUs),
+                                                    since(slot.lastUs), slot.requests,
+                                                    slot.bytesSent});
+        }
+    }
+    return stats;
+}
+
+bool streamMetrics(const HttpMetricsSnapshot& http, const SystemMetricsDto& system,
+                   IChunkSink& sink)
+{
+    MetricsWriter w(sink);
+    writeRoutes(w, http);
+    writeSystem(w, system);
+    if (system.hasModbus) {
+        writeModbus(w, system);
+    }
+    if (system.hasTasks) {
+        writeTasks(w, system);
+    }
+    if (!system.buffers.empty()) {
+        writeBuffers(w, system);
+    }
+    if (!system.locks.empty()) {
+        writeLocks(w, system);
+    }
+    if (!system.watchdogFeeds.empty()) {
+        writeWatchdog(w, system);
+    }
+    if (system.hasTicks) {
+        writeTicks(w, system);
+    }
+    if (!system.lifetime.empty()) {
+        writeLifetime(w, system);
+    }
+    if (!system.wifiPowerSave.empty()) {
+        writeWifi(w, system);
+    }
+    if (!system.powerStates.empty()) {
+        writePower(w, system);
+    }
+    if (system.mqtt.has_value()) {
+        writeMqtt(w, *system.mqtt);
+    }
+    if (system.tls.has_value()) {
+        writeTls(w, *system.tls);
+    }
+    if (system.sessions.has_value()) {
+        writeSessions(w, *system.sessions);
+    }
+    return w.finish();
+}
+
+}  // namespace api
@@ -9,11 +9,17 @@
 
 #include <cstddef>
 #include <cstdint>
+#include <iterator>
 #include <optional>
+#include <string>
+#include <string_view>
+#include <utility>
+#include <vector>
 
-#include "cJSON.h"
-
+#include "api/JsonScanner.h"
 #include "interfaces/IConfigStore.h"
+#include "interfaces/IDataStorage.h"
+#include "interfaces/MetricRegistry.h"
 
 namespace api {
 
@@ -29,19 +35,19 @@ enum class FieldCheck {
 /// Validate an optional numeric field against [minV, maxV] and store it as a
 /// float optional. Absent keys are Ok-to-skip; a non-number or out-of-range
 /// value is Invalid with a field-naming error.
-FieldCheck checkFloatField(const cJSON* root, const char* key, float minV,
+FieldCheck checkFloatField(const JsonScanner& json, const char* key, float minV,
                            float maxV, std::optional<float>& out,
                            std::string& err)
 {
-    const cJSON* f = cJSON_GetObjectItemCaseSensitive(root, key);
-    if (f == nullptr) {
+    const std::size_t f = json.member(JsonScanner::root(), key);
+    if (f == JsonScanner::kNone) {
         return FieldCheck::Absent;
     }
-    if (!cJSON_IsNumber(f)) {
+    double v = 0.0;
+    if (!json.number(f, v)) {
         err = std::string(key) + " must be a number";
         return FieldCheck::Invalid;
     }
-    double v = f->valuedouble;
     if (v < static_cast<double>(minV) || v > static_cast<double>(maxV)) {
         err = std::string(key) + " out of range";
         return FieldCheck::Invalid;
@@ -52,19 +58,19 @@ FieldCheck checkFloatField(const cJSON* root, const char* key, float minV,
 
 /// Validate an optional numeric field against [minV, maxV] and store it as a
 /// uint32 optional. Same conventions as checkFloatField.
-FieldCheck checkUintField(const cJSON* root, const char* key, uint32_t minV,
+FieldCheck checkUintField(const JsonScanner& json, const char* key, uint32_t minV,
                           uint32_t maxV, std::optional<uint32_t>& out,
                           std::string& err)
 {
-    const cJSON* f = cJSON_GetObjectItemCaseSensitive(root, key);
-    if (f == nullptr) {
+    const std::size_t f = json.member(JsonScanner::root(), key);
+    if (f == JsonScanner::kNone) {
         return FieldCheck::Absent;
     }
-    if (!cJSON_IsNumber(f)) {
+    double v = 0.0;
+    if (!json.number(f, v)) {
         err = std::string(key) + " must be a number";
         return FieldCheck::Invalid;
     }
-    double v = f->valuedouble;
     if (v < static_cast<double>(minV) || v > static_cast<double>(maxV)) {
         err = std::string(key) + " out of range";
         return FieldCheck::Invalid;
@@ -75,35 +81,215 @@ FieldCheck checkUintField(const cJSON* root, const char* key, uint32_t minV,
 
 /// Validate an optional boolean field. Absent is Ok-to-skip; a non-bool is
 /// Invalid with a field-naming error.
-FieldCheck checkBoolField(const cJSON* root, const char* key,
+FieldCheck checkBoolField(const JsonScanner& json, const char* key,
                           std::optional<bool>& out, std::string& err)
 {
-    const cJSON* f = cJSON_GetObjectItemCaseSensitive(root, key);
-    if (f == nullptr) {
+    const std::size_t f = json.member(JsonScanner::root(), key);
+    if (f == JsonScanner::kNone) {
         return FieldCheck::Absent;
     }
-    if (!cJSON_IsBool(f)) {
+    if (!json.isBool(f)) {
         err = std::string(key) + " must be a boolean";
         return FieldCheck::Invalid;
     }
-    out = cJSON_IsTrue(f);
+    out = json.type(f) == JsonScanner::Type::True;
     return FieldCheck::Ok;
 }
 
+/// Validate the optional `logPolicies` object: known metric names, each
+/// mapped to a whole policy (all three fields required) that
+/// IConfigStore::isValidLogPolicy accepts. Errors name the metric.
+FieldCheck checkLogPolicies(const JsonScanner& json, std::vector<LogPolicyDto>& out,
+                            std::string& err)
+{
+    const std::size_t policies = json.member(JsonScanner::root(), "logPolicies");
+    if (policies == JsonScanner::kNone) {
+        return FieldCheck::Absent;
+    }
+    if (json.type(policies) != JsonScanner::Type::Object) {
+        err = "logPolicies must be an object";
+        return FieldCheck::Invalid;
+    }
+    for (std::size_t key = json.firstMember(policies); key != JsonScanner::kNone;
+         key = json.nextMember(policies, key)) {
+        // Known names are short; a longer key cannot be one of them.
+        char nameBuf[32];
+        std::size_t nameLen = 0;
+        const std::string_view name =
+            json.copyString(key, nameBuf, sizeof nameBuf, nameLen)
+                ? std::string_view(nameBuf, nameLen)
+                : std::string_view();
+        // The error names are only built on the way out.
+        const auto field = [&name] { return "logPolicies." + std::string(name); };
+        if (metric::findKnown(name) == metric::kInvalid) {
+            err = field() + " is not a known metric";
+            return FieldCheck::Invalid;
+        }
+        const std::size_t entry = key + 1;
+        if (json.type(entry) != JsonScanner::Type::Object) {
+            err = field() + " must be an object";
+            return FieldCheck::Invalid;
+        }
+        const char* const keys[] = {"deadbandAbs", "deadbandRel", "heartbeatS"};
+        double values[3] = {};
+        for (std::size_t i = 0; i < 3; ++i) {
+            if (!json.number(json.member(entry, keys[i]), values[i])) {
+                err = field() + "." + keys[i] + " must be a number";
+                return FieldCheck::Invalid;
+            }
+        }
+        const double hb = values[2];
+        MetricLogPolicy policy;
+        policy.deadbandAbs = static_cast<float>(values[0]);
+        policy.deadbandRel = static_cast<float>(values[1]);
+        // Range-check before the cast so a huge or negative heartbeat
+        // cannot wrap into the valid span.
+        policy.heartbeatS = hb >= 0.0 && hb <= static_cast<double>(UINT32_MAX)
+                                ? static_cast<uint32_t>(hb)
+                                : IConfigStore::kLogHeartbeatMaxS + 1;
+        if (!IConfigStore::isValidLogPolicy(policy) ||
+            static_cast<double>(policy.heartbeatS) != hb) {
+            err = field() + " out of range";
+            return FieldCheck::Invalid;
+        }
+        out.push_back(LogPolicyDto{std::string(name), policy.deadbandAbs,
+                                   policy.deadbandRel, policy.heartbeatS});
+    }
+    return FieldCheck::Ok;
+}
+
+/// Scan @p body as one JSON object; false with the 400 reason in @p err.
+bool scanObject(JsonScanner& json, std::string_view body, std::string& err)
+{
+    if (!json.parse(body)) {
+        err = json.full() ? "body too complex" : "malformed JSON";
+        return false;
+    }
+    if (json.type(JsonScanner::root()) != JsonScanner::Type::Object) {
+        err = "body must be a JSON object";
+        return false;
+    }
+    return true;
+}
+
+/// A decimal uint32 of 1..10 digits, nothing else.
+bool parseDecimal(std::string_view text, uint32_t& out)
+{
+    if (text.empty() || text.size() > 10) {
+        return false;
+    }
+    uint64_t v = 0;
+    for (const char c : text) {
+        if (c < '0' || c > '9') {
+            return false;
+        }
+        v = v * 10 + static_cast<uint64_t>(c - '0');
+    }
+    if (v > UINT32_MAX) {
+        return false;
+    }
+    out = static_cast<uint32_t>(v);
+    return true;
+}
+
+/// "<epoch>.<skip>": two decimal uint32 fields joined by one '.'.
+bool parseCursorFields(std::string_view text, uint32_t (&fields)[2])
+{
+    const std::size_t dot = text.find('.');
+    if (dot == std::string_view::npos) {
+        return false;
+    }
+    return parseDecimal(text.substr(0, dot), fields[0]) &&
+           parseDecimal(text.substr(dot + 1), fields[1]);
+}
+
+/// Version byte leading a /history/sync token's bytes.
+constexpr uint8_t kSyncTokenVersion = 1;
+/// Token bytes before base64url: the version, then {epoch, skip} per metric.
+constexpr std::size_t kSyncTokenBytes = 1 + 6 * metric::kKnownCount;
+
+constexpr char kBase64Url[] =
+    "ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz0123456789-_";
+
+/// The 6-bit value of base64url character @p c, or -1.
+int base64UrlValue(char c)
+{
+    if (c >= 'A' && c <= 'Z') {
+        return c - 'A';
+    }
+    if (c >= 'a' && c <= 'z') {
+        return c - 'a' + 26;
+    }
+    if (c >= '0' && c <= '9') {
+        return c - '0' + 52;
+    }
+    return c == '-' ? 62 : c == '_' ? 63 : -1;
+}
+
+/// A top-level member a `fields` projection may name.
+struct FieldName {
+    const char* name;
+    uint32_t bit;
+};
+
+template <std::size_t N>
+bool parseFields(std::string_view list, const FieldName (&names)[N], FieldSelection& out)
+{
+    FieldSelection selection;
+    uint32_t whole = 0;
+    std::size_t begin = 0;
+    for (;;) {
+        const std::size_t comma = list.find(',', begin);
+        const std::string_view item = list.substr(
+            begin, comma == std::string_view::npos ? std::string_view::npos : comma - begin);
+        const std::size_t dot = item.find('.');
+        const std::string_view member = item.substr(0, dot);
+        uint32_t bit = 0;
+        for (const FieldName& entry : names) {
+            if (member == entry.name) {
+                bit = entry.bit;
+            }
+        }
+        if (bit == 0) {
+            return false;  // empty item or unknown member
+        }
+        selection.members |= bit;
+        if (dot == std::string_view::npos) {
+            whole |= bit;
+        } else {
+            const std::string_view key = item.substr(dot + 1);
+            if (key.empty() || key.find('.') != std::string_view::npos) {
+                return false;
+            }
+            selection.keys.push_back(FieldKey{std::string(member), std::string(key)});
+        }
+        if (comma == std::string_view::npos) {
+            break;
+        }
+        begin = comma + 1;
+    }
+    // A member also named whole keeps every key.
+    std::vector<FieldKey> narrowed;
+    for (FieldKey& key : selection.keys) {
+        for (const FieldName& entry : names) {
+            if (key.member == entry.name && (whole & entry.bit) == 0) {
+                narrowed.push_back(std::move(key));
+            }
+        }
+    }
+    selection.keys = std::move(narrowed);
+    out = std::move(selection);
+    return true;
+}
+
 }  // namespace
 
-ConfigSetResult parseConfigSet(const std::string& body)
+ConfigSetResult parseConfigSet(std::string_view body)
 {
     ConfigSetResult result;
 
-    cJSON* root = cJSON_Parse(body.c_str());
-    if (root == nullptr) {
-        result.error = "malformed JSON";
-        return result;
-    }
-    if (!cJSON_IsObject(root)) {
-        cJSON_Delete(root);
-        result.error = "body must be a JSON object";
+    JsonScanner json;
+    if (!scanObject(json, body, result.error)) {
         return result;
     }
 
@@ -116,51 +302,53 @@ ConfigSetResult parseConfigSet(const std::string& body)
 
     // Each check returns Invalid on a present-but-wrong field; we stop on the
     // first failure so the error names that field.
-    if (!bad && checkFloatField(root, "moistureThresholdLow",
+    if (!bad && checkFloatField(json, "moistureThresholdLow",
                                 IConfigStore::kMoistureThresholdMin,
                                 IConfigStore::kMoistureThresholdMax,
                                 req.moistureThresholdLow, err) ==
                     FieldCheck::Invalid) {
         bad = true;
     }
-    if (!bad && checkFloatField(root, "moistureThresholdHigh",
+    if (!bad && checkFloatField(json, "moistureThresholdHigh",
                                 IConfigStore::kMoistureThresholdMin,
                                 IConfigStore::kMoistureThresholdMax,
                                 req.moistureThresholdHigh, err) ==
                     FieldCheck::Invalid) {
         bad = true;
     }
-    if (!bad && checkUintField(root, "wateringDurationS",
+    if (!bad && checkUintField(json, "wateringDurationS",
                                IConfigStore::kWateringDurationMinS,
                                IConfigStore::kWateringDurationMaxS,
                                req.wateringDurationS, err) ==
                     FieldCheck::Invalid) {
         bad = true;
     }
-    if (!bad && checkUintField(root, "minWateringIntervalS",
+    if (!bad && checkUintField(json, "minWateringIntervalS",
                                IConfigStore::kMinWateringIntervalFloorS,
                                UINT32_MAX, req.minWateringIntervalS, err) ==
                     FieldCheck::Invalid) {
         bad = true;
     }
-    if (!bad && checkBoolField(root, "wateringEnabled", req.wateringEnabled,
+    if (!bad && checkBoolField(json, "wateringEnabled", req.wateringEnabled,
                                err) == FieldCheck::Invalid) {
         bad = true;
     }
-    if (!bad && checkUintField(root, "sensorReadIntervalMs",
+    if (!bad && checkUintField(json, "sensorReadIntervalMs",
                                IConfigStore::kSensorReadIntervalFloorMs,
                                UINT32_MAX, req.sensorReadIntervalMs, err) ==
                     FieldCheck::Invalid) {
         bad = true;
     }
-    if (!bad && checkUintField(root, "dataLogIntervalMs",
+    if (!bad && checkUintField(json, "dataLogIntervalMs",
                                IConfigStore::kDataLogIntervalFloorMs,
                                UINT32_MAX, req.dataLogIntervalMs, err) ==
                     FieldCheck::Invalid) {
         bad = true;
     }
-
-    cJSON_Delete(root);
+    if (!bad && checkLogPolicies(json, req.logPolicies, err) ==
+                    FieldCheck::Invalid) {
+        bad = true;
+    }
 
     if (bad) {
         // Discard the partially-populated request: nothing is applied.
@@ -168,75 +356,100 @@ ConfigSetResult parseConfigSet(const std::string& body)
         return result;
     }
 
-    result.request = req;
+    result.request = std::move(req);
     result.ok = true;
     return result;
 }
 
-PumpCommandResult parsePumpCommand(const std::string& body)
+ConfigPatch toConfigPatch(const ConfigSetRequest& request)
+{
+    ConfigPatch patch;
+    patch.moistureThresholdLow = request.moistureThresholdLow;
+    patch.moistureThresholdHigh = request.moistureThresholdHigh;
+    patch.wateringDurationS = request.wateringDurationS;
+    patch.minWateringIntervalS = request.minWateringIntervalS;
+    patch.wateringEnabled = request.wateringEnabled;
+    patch.sensorReadIntervalMs = request.sensorReadIntervalMs;
+    patch.dataLogIntervalMs = request.dataLogIntervalMs;
+    for (const LogPolicyDto& dto : request.logPolicies) {
+        const MetricId id = metric::findKnown(dto.metric);
+        if (id != metric::kInvalid) {
+            patch.logPolicies[id] = MetricLogPolicy{dto.deadbandAbs, dto.deadbandRel,
+                                                    dto.heartbeatS};
+        }
+    }
+    return patch;
+}
+
+PumpCommandResult parsePumpCommand(std::string_view body)
 {
     PumpCommandResult result;
 
-    cJSON* root = cJSON_Parse(body.c_str());
-    if (root == nullptr) {
-        result.error = "malformed JSON";
-        return result;
-    }
-    if (!cJSON_IsObject(root)) {
-        cJSON_Delete(root);
-        result.error = "body must be a JSON object";
+    JsonScanner json;
+    if (!scanObject(json, body, result.error)) {
         return result;
     }
 
-    const cJSON* action = cJSON_GetObjectItemCaseSensitive(root, "action");
-    if (!cJSON_IsString(action) || action->valuestring == nullptr) {
-        cJSON_Delete(root);
+    const std::size_t action = json.member(JsonScanner::root(), "action");
+    if (action == JsonScanner::kNone || json.type(action) != JsonScanner::Type::String) {
         result.error = "action must be a string";
         return result;
     }
 
-    std::string verb = action->valuestring;
     PumpCommand cmd;
 
-    if (verb == "stop") {
+    if (json.equals(action, "stop")) {
         cmd.action = PumpAction::Stop;
         // Stop needs no duration; any durationS present is ignored.
-        cJSON_Delete(root);
         result.command = cmd;
         result.ok = true;
         return result;
     }
 
-    if (verb == "start" || verb == "run") {
-        cmd.action = (verb == "start") ? PumpAction::Start : PumpAction::Run;
+    const bool start = json.equals(action, "start");
+    if (start || json.equals(action, "run")) {
+        cmd.action = start ? PumpAction::Start : PumpAction::Run;
 
-        const cJSON* dur = cJSON_GetObjectItemCaseSensitive(root, "durationS");
-        if (!cJSON_IsNumber(dur)) {
-            cJSON_Delete(root);
+        double v = 0.0;
+        if (!json.number(json.member(JsonScanner::root(), "durationS"), v)) {
             result.error = "durationS must be a number";
             return result;
         }
-        double v = dur->valuedouble;
         if (v < static_cast<double>(IConfigStore::kWateringDurationMinS) ||
             v > static_cast<double>(IConfigStore::kWateringDurationMaxS)) {
-            cJSON_Delete(root);
             result.error = "durationS out of range";
             return result;
         }
         cmd.durationS = static_cast<uint32_t>(v);
 
-        cJSON_Delete(root);
         result.command = cmd;
         result.ok = true;
         return result;
     }
 
-    cJSON_Delete(root);
     result.error = "unknown action";
     return result;
 }
 
-bool namedRangeToWindow(const std::string& range, uint32_t now, uint32_t& t0,
+bool findQueryValue(std::string_view query, std::string_view key,
+                    std::string_view& value)
+{
+    std::size_t begin = 0;
+    while (begin <= query.size()) {
+        const std::size_t amp = query.find('&', begin);
+        const std::size_t end = amp == std::string_view::npos ? query.size() : amp;
+        const std::string_view pair = query.substr(begin, end - begin);
+        const std::size_t eq = pair.find('=');
+        if (eq != std::string_view::npos && pair.substr(0, eq) == key) {
+            value = pair.substr(eq + 1);
+            return true;
+        }
+        begin = end + 1;
+    }
+    return false;
+}
+
+bool namedRangeToWindow(std::string_view range, uint32_t now, uint32_t& t0,
                         uint32_t& t1)
 {
     uint32_t span = 0;
@@ -271,6 +484,220 @@ std::size_t resolveEventCount(std::optional<int> requested)
     return v > kMax ? kMax : v;
 }
 
+bool parseEventCategories(std::string_view list, uint32_t& mask)
+{
+    // Same vocabulary as the serialized categoryName (IDataStorage ids).
+    static const struct {
+        const char* name;
+        uint8_t id;
+    } kNames[] = {
+        {"pump", IDataStorage::kCategoryPump},
+        {"failsafe", IDataStorage::kCategoryFailsafe},
+        {"connectivity", IDataStorage::kCategoryConnectivity},
+        {"ota", IDataStorage::kCategoryOta},
+        {"reset", IDataStorage::kCategoryReset},
+    };
+    uint32_t bits = 0;
+    std::size_t begin = 0;
+    for (;;) {
+        const std::size_t comma = list.find(',', begin);
+        const std::string_view item = list.substr(
+            begin, comma == std::string_view::npos ? std::string_view::npos : comma - begin);
+        uint32_t bit = 0;
+        for (const auto& entry : kNames) {
+            if (item == entry.name) {
+                bit = EventQuery::categoryBit(entry.id);
+            }
+        }
+        uint32_t id = 0;
+        if (bit == 0 && item.size() <= 2 && parseDecimal(item, id)) {
+            bit = EventQuery::categoryBit(static_cast<uint8_t>(id));
+        }
+        if (bit == 0) {
+            return false;  // empty item, unknown name, id >= 32
+        }
+        bits |= bit;
+        if (comma == std::string_view::npos) {
+            break;
+        }
+        begin = comma + 1;
+    }
+    mask = bits;
+    return true;
+}
+
+bool parseSnapshotFields(std::string_view list, uint32_t& fields)
+{
+    static const struct {
+        const char* name;
+        uint32_t bit;
+    } kNames[] = {
+        {"status", kSnapshotStatus},
+        {"sensors", kSnapshotSensors},
+        {"pumps", kSnapshotPumps},
+        {"power", kSnapshotPower},
+    };
+    uint32_t bits = 0;
+    std::size_t begin = 0;
+    for (;;) {
+        const std::size_t comma = list.find(',', begin);
+        const std::string_view item = list.substr(
+            begin, comma == std::string_view::npos ? std::string_view::npos : comma - begin);
+        uint32_t bit = 0;
+        for (const auto& entry : kNames) {
+            if (item == entry.name) {
+                bit = entry.bit;
+            }
+        }
+        if (bit == 0) {
+            return false;  // empty item or unknown name
+        }
+        bits |= bit;
+        if (comma == std::string_view::npos) {
+            break;
+        }
+        begin = comma + 1;
+    }
+    fields = bits;
+    return true;
+}
+
+bool parseStatusFields(std::string_view list, FieldSelection& out)
+{
+    static const FieldName kNames[] = {
+        {"mode", kStatusMode},
+        {"wifi", kStatusWifi},
+        {"time", kStatusTime},
+        {"uptimeMs", kStatusUptime},
+        {"resetReason", kStatusResetReason},
+        {"firmware", kStatusFirmware},
+        {"storage", kStatusStorage},
+        {"bootUs", kStatusBoot},
+        {"power", kStatusPower},
+    };
+    return parseFields(list, kNames, out);
+}
+
+bool parseSensorsFields(std::string_view list, FieldSelection& out)
+{
+    static const FieldName kNames[] = {
+        {"environmental", kSensorsEnvironmental},
+        {"soil", kSensorsSoil},
+        {"soilProbes", kSensorsSoilProbes},
+        {"soilBus", kSensorsSoilProbes},
+        {"level", kSensorsLevel},
+        {"power", kSensorsPower},
+        {"timestamp", kSensorsTimestamp},
+    };
+    return parseFields(list, kNames, out);
+}
+
+std::string formatEventCursor(const EventCursor& cursor)
+{
+    return std::to_string(cursor.epoch) + "." + std::to_string(cursor.skip);
+}
+
+bool parseEventCursor(std::string_view text, EventCursor& cursor)
+{
+    uint32_t fields[2] = {};
+    if (!parseCursorFields(text, fields)) {
+        return false;
+    }
+    cursor = EventCursor{fields[0], fields[1]};
+    return true;
+}
+
+std::string formatReadingCursor(const ReadingCursor& cursor)
+{
+    return std::to_string(cursor.epoch) + "." + std::to_string(cursor.skip);
+}
+
+bool parseReadingCursor(std::string_view text, ReadingCursor& cursor)
+{
+    uint32_t fields[2] = {};
+    if (!parseCursorFields(text, fields)) {
+        return false;
+    }
+    cursor = ReadingCursor{fields[0], fields[1]};
+    return true;
+}
+
+std::string formatSyncToken(const HistorySyncMarks& marks)
+{
+    uint8_t bytes[kSyncTokenBytes] = {kSyncTokenVersion};
+    uint8_t* p = bytes + 1;
+    for (const ReadingCursor& mark : marks) {
+        const uint32_t skip = mark.skip > 0xFFFFu ? 0xFFFFu : mark.skip;
+        for (int shift = 0; shift < 32; shift += 8) {
+            *p++ = static_cast<uint8_t>(mark.epoch >> shift);
+        }
+        *p++ = static_cast<uint8_t>(skip);
+        *p++ = static_cast<uint8_t>(skip >> 8);
+    }
+    std::string out;
+    out.reserve(kSyncTokenLen);
+    uint32_t acc = 0;
+    int bits = 0;
+    for (const uint8_t b : bytes) {
+        acc = (acc << 8) | b;
+        bits += 8;
+        while (bits >= 6) {
+            bits -= 6;
+            out += kBase64Url[(acc >> bits) & 0x3F];
+        }
+    }
+    if (bits > 0) {
+        out += kBase64Url[(acc << (6 - bits)) & 0x3F];
+    }
+    return out;
+}
+
+bool parseSyncToken(std::string_view text, HistorySyncMarks& marks)
+{
+    if (text.size() != kSyncTokenLen) {
+        return false;
+    }
+    uint8_t bytes[kSyncTokenBytes] = {};
+    std::size_t n = 0;
+    uint32_t acc = 0;
+    int bits = 0;
+    for (const char c : text) {
+        const int v = base64UrlValue(c);
+        if (v < 0) {
+            return false;
+        }
+        acc = (acc << 6) | static_cast<uint32_t>(v);
+        bits += 6;
+        if (bits >= 8) {
+            bits -= 8;
+            bytes[n++] = static_cast<uint8_t>(acc >> bits);
+        }
+    }
+    if (n != kSyncTokenBytes || bytes[0] != kSyncTokenVersion) {
+        return false;
+    }
+    const uint8_t* p = bytes + 1;
+    for (ReadingCursor& mark : marks) {
+        mark.epoch = static_cast<uint32_t>(p[0]) | static_cast<uint32_t>(p[1]) << 8 |
+                     static_cast<uint32_t>(p[2]) << 16 | static_cast<uint32_t>(p[3]) << 24;
+        mark.skip = static_cast<uint32_t>(p[4]) | static_cast<uint32_t>(p[5]) << 8;
+        p += 6;
+    }
+    return true;
+}
+
+std::size_t resolveHistorySyncLimit(std::optional<uint32_t> requested)
+{
+    if (!requested.has_value()) {
+        return kHistorySyncMaxRecords;
+    }
+    const std::size_t n = *requested;
+    if (n < 1) {
+        return 1;
+    }
+    return n > kHistorySyncMaxRecords ? kHistorySyncMaxRecords : n;
+}
+
 WindowResult resolveWindow(std::optional<std::string> range,
                            std::optional<uint32_t> start,
                            std::optional<uint32_t> end, uint32_t now)
@@ -305,4 +732,161 @@ WindowResult resolveWindow(std::optional<std::string> range,
     return out;
 }
 
+uint32_t selectHistoryBucket(uint32_t t0, uint32_t t1, uint32_t logIntervalS,
+                             std::size_t maxPoints)
+{
+    const uint64_t span = t1 >= t0 ? static_cast<uint64_t>(t1 - t0) : 0u;
+    const uint64_t interval = logIntervalS == 0 ? 1u : logIntervalS;
+    if (span / interval + 1 <= maxPoints) {
+        return 0;  // raw readings fit the budget
+    }
+    const auto& widths = IDataStorage::kAggregateBucketsS;
+    for (uint32_t bucketS : widths) {
+        // Buckets touched by the window, first one aligned down.
+        const uint64_t buckets = (span + t0 % bucketS) / bucketS + 1;
+        if (buckets <= maxPoints) {
+            return bucketS;
+        }
+    }
+    return widths[std::size(widths) - 1];
+}
+
+bool splitHistoryMetrics(const std::string& list, std::vector<std::string>& out)
+{
+    std::vector<std::string> names;
+    std::size_t pos = 0;
+    while (true) {
+        const std::size_t comma = list.find(',', pos);
+        const std::size_t len = (comma == std::string::npos ? list.size() : comma) - pos;
+        if (len == 0 || names.size() == kHistoryMaxMetrics) {
+            return false;
+        }
+        std::string name = list.substr(pos, len);
+        for (const std::string& seen : names) {
+            if (seen == name) {
+                return false;
+            }
+        }
+        names.push_back(std::move(name));
+        if (comma == std::string::npos) {
+            break;
+        }
+        pos = comma + 1;
+    }
+    out = std::move(names);
+    return true;
+}
+
+std::size_t resolveHistoryMaxPoints(std::optional<uint32_t> requested)
+{
+    if (!requested.has_value()) {
+        return kHistoryMaxPoints;
+    }
+    const std::size_t n = *requested;
+    if (n < kHistoryMinPoints) {
+        return kHistoryMinPoints;
+    }
+    return n > kHistoryMaxPoints ? kHistoryMaxPoints : n;
+}
+
+std::size_t resolveHistoryPageLimit(std::optional<uint32_t> requested)
+{
+    if (!requested.has_value()) {
+        return kHistoryMaxPoints;
+    }
+    const std::size_t n = *requested;
+    if (n < 1) {
+        return 1;
+    }
+    return n > kHistoryMaxPoints ? kHistoryMaxPoints : n;
+}
+
+bool parseHistoryAggregate(std::string_view text, HistoryAggregate& out)
+{
+    if (text == "avg") {
+        out = HistoryAggregate::Avg;
+    } else if (text == "minmax") {
+        out = HistoryAggregate::MinMax;
+    } else if (text == "lttb") {
+        out = HistoryAggregate::Lttb;
+    } else {
+        return false;
+    }
+    return true;
+}
+
+bool selectHistoryFormat(const std::optional<std::string>& format,
+                         const std::optional<std::string>& accept,
+                         HistoryFormat& out)
+{
+    if (format.has_value()) {
+        if (*format == "json") {
+            out = HistoryFormat::Json;
+            return true;
+        }
+        if (*format == "bin") {
+            out = HistoryFormat::Binary;
+            return true;
+        }
+        return false;
+    }
+    const bool wantsBinary =
+        accept.has_value() &&
+        accept->find("application/octet-stream") != std::string::npos;
+    out = wantsBinary ? HistoryFormat::Binary : HistoryFormat::Json;
+    return true;
+}
+
+uint32_t stepFillHistory(HistorySeries& series, uint32_t logIntervalS,
+                         uint32_t heartbeatS)
+{
+    series.filled = 0;
+    const std::size_t n = series.timestamps.size();
+    if (heartbeatS == 0 || n < 2) {
+        return 0;
+    }
+    const bool bucketed = series.bucketS != 0;
+    if (bucketed && (series.mins.size() != n || series.maxs.size() != n)) {
+        return 0;  // not an aligned aggregate series
+    }
+    const int64_t step = bucketed ? series.bucketS
+                                  : (logIntervalS == 0 ? 1 : logIntervalS);
+    const int64_t maxGap = static_cast<int64_t>(heartbeatS) + step;
+
+    HistorySeries out = series;
+    out.timestamps.clear();
+    out.values.clear();
+    out.mins.clear();
+    out.maxs.clear();
+    auto push = [&](std::size_t from, int64_t ts, bool held) {
+        out.timestamps.push_back(ts);
+        out.values.push_back(series.values[from]);
+        if (bucketed) {
+            out.mins.push_back(held ? series.values[from] : series.mins[from]);
+            out.maxs.push_back(held ? series.values[from] : series.maxs[from]);
+        }
+    };
+    push(0, series.timestamps[0], false);
+    for (std::size_t i = 1; i < n; ++i) {
+        const int64_t prev = series.timestamps[i - 1];
+        const int64_t gap = series.timestamps[i] - prev;
+        if (gap <= maxGap) {
+            if (bucketed) {
+                for (int64_t ts = prev + step; ts < series.timestamps[i]; ts += step) {
+                    push(i - 1, ts, true);
+                    ++out.filled;
+                }
+            } else if (gap * 2 > step * 3) {
+                // More than 1.5 intervals apart: a skipped reading, held
+                // until just before the next one.
+                push(i - 1, series.timestamps[i] - step, true);
+                ++out.filled;
+            }
+        }
+        push(i, series.timestamps[i], false);
+    }
+    series = std::move(out);
+    return series.filled;
+}
+
 }  // namespace api
@@ -7,31 +7,131 @@
 
 #include "api/ApiRoutes.h"
 
+#include <array>
+#include <cstdint>
 #include <cstring>
 
 namespace api {
 
 const char kPumpCommandPrefix[] = "/api/v1/pumps/";
+const char kPumpUsageSuffix[] = "/usage";
 
 namespace {
 
 // The route table (data-model.md §Route table / contracts path set). The
-// PumpCmd row stores the templated path for documentation and enumeration; the
-// matcher resolves it by kPumpCommandPrefix rather than by exact string.
+// PumpCmd and PumpUsage rows store the templated path for documentation and
+// enumeration; the matcher resolves them by kPumpCommandPrefix (and
+// kPumpUsageSuffix) rather than by exact string.
 constexpr ApiRoute kRoutes[] = {
     {"/api/v1/status",       HttpMethod::Get,  HandlerId::Status},
     {"/api/v1/sensors",      HttpMethod::Get,  HandlerId::Sensors},
     {"/api/v1/history",      HttpMethod::Get,  HandlerId::History},
+    {"/api/v1/history/stats", HttpMethod::Get, HandlerId::HistoryStats},
+    {"/api/v1/history/sync", HttpMethod::Get,  HandlerId::HistorySync},
     {"/api/v1/pumps",        HttpMethod::Get,  HandlerId::PumpsList},
     {"/api/v1/pumps/{name}", HttpMethod::Post, HandlerId::PumpCmd},
+    {"/api/v1/pumps/{name}/usage", HttpMethod::Get, HandlerId::PumpUsage},
     {"/api/v1/config",       HttpMethod::Get,  HandlerId::ConfigGet},
     {"/api/v1/config",       HttpMethod::Post, HandlerId::ConfigSet},
     {"/api/v1/power",        HttpMethod::Get,  HandlerId::Power},
+    {"/api/v1/power/capture", HttpMethod::Get, HandlerId::PowerCapture},
     {"/api/v1/events",       HttpMethod::Get,  HandlerId::Events},
+    {"/api/v1/stream",       HttpMethod::Get,  HandlerId::Stream},
     {"/api/v1/selftest",     HttpMethod::Post, HandlerId::SelfTest},
-    {"/api/v1/ota",          HttpMethod::Post, HandlerId::OtaStub},
+    {"/api/v1/ota",          HttpMethod::Post, HandlerId::Ota},
+    {"/api/v1/metrics",      HttpMethod::Get,  HandlerId::Metrics},
+    {"/api/v1/snapshot",     HttpMethod::Get,  HandlerId::Snapshot},
+    {"/api/v1/control/trace", HttpMethod::Get, HandlerId::ControlTrace},
+    {"/api/v1/trace",        HttpMethod::Get,  HandlerId::Trace},
+    {"/api/v1/nodes",        HttpMethod::Get,  HandlerId::Nodes},
+    {"/api/v1/logs",         HttpMethod::Get,  HandlerId::Logs},
+    {"/api/v1/events/summary", HttpMethod::Get, HandlerId::EventsSummary},
+    {"/api/v1/modbus/capture", HttpMethod::Get, HandlerId::ModbusCapture},
+    {"/api/v1/backup",       HttpMethod::Get,  HandlerId::Backup},
+    {"/api/v1/restore",      HttpMethod::Post, HandlerId::Restore},
+    {"/api/v1/recording",    HttpMethod::Get,  HandlerId::Recording},
+    {"/api/v1/support-bundle", HttpMethod::Get, HandlerId::SupportBundle},
+    {"/api/v1/export.csv",   HttpMethod::Get,  HandlerId::ExportCsv},
 };
 
+constexpr std::size_t kRouteCount = sizeof(kRoutes) / sizeof(kRoutes[0]);
+
+// -- Perfect hash -------------------------------------------------------------
+// FNV-1a over the path, then the method, from a seed. buildIndex() tries
+// seeds until every exact route has a slot of its own; matchRoute() then
+// hashes once and compares one row.
+
+/// Slots of the index: a power of two, about three per exact route.
+constexpr std::size_t kSlots = 64;
+constexpr uint8_t kEmpty = 0xFF;
+constexpr uint32_t kMaxSeed = 4096;
+
+static_assert(kRouteCount < kEmpty, "route ids must fit a slot byte");
+
+constexpr uint32_t routeHash(HttpMethod method, std::string_view path, uint32_t seed)
+{
+    uint32_t h = 2166136261u ^ seed;
+    for (char c : path) {
+        h = (h ^ static_cast<uint8_t>(c)) * 16777619u;
+    }
+    h = (h ^ static_cast<uint32_t>(method)) * 16777619u;
+    return h ^ (h >> 16);
+}
+
+struct RouteIndex {
+    uint32_t seed = kMaxSeed;  ///< kMaxSeed: no seed found
+    std::array<uint8_t, kSlots> slots{};
+};
+
+constexpr RouteIndex buildIndex()
+{
+    for (uint32_t seed = 0; seed < kMaxSeed; ++seed) {
+        RouteIndex index;
+        index.seed = seed;
+        for (uint8_t& slot : index.slots) {
+            slot = kEmpty;
+        }
+        bool clash = false;
+        for (std::size_t i = 0; i < kRouteCount && !clash; ++i) {
+            if (kRoutes[i].id == HandlerId::PumpCmd || kRoutes[i].id == HandlerId::PumpUsage) {
+                continue;
+            }
+            uint8_t& slot =
+                index.slots[routeHash(kRoutes[i].method, kRoutes[i].path, seed) % kSlots];
+            clash = slot != kEmpty;
+            slot = static_cast<uint8_t>(i);
+        }
+        if (!clash) {
+            return index;
+        }
+    }
+    return RouteIndex{};
+}
+
+constexpr RouteIndex kIndex = buildIndex();
+static_assert(kIndex.seed != kMaxSeed,
+              "no perfect hash for the route table (a duplicate route?)");
+
+constexpr bool startsWithPumpPrefix(std::string_view path)
+{
+    const std::string_view prefix(kPumpCommandPrefix, sizeof(kPumpCommandPrefix) - 1);
+    return path.size() > prefix.size() && path.substr(0, prefix.size()) == prefix;
+}
+
+/// `/api/v1/pumps/<name>/usage` with a non-empty name free of '/'.
+constexpr bool isPumpUsagePath(std::string_view path)
+{
+    const std::string_view prefix(kPumpCommandPrefix, sizeof(kPumpCommandPrefix) - 1);
+    const std::string_view suffix(kPumpUsageSuffix, sizeof(kPumpUsageSuffix) - 1);
+    if (!startsWithPumpPrefix(path) || path.size() <= prefix.size() + suffix.size() ||
+        path.substr(path.size() - suffix.size()) != suffix) {
+        return false;
+    }
+    const std::string_view name =
+        path.substr(prefix.size(), path.size() - prefix.size() - suffix.size());
+    return name.find('/') == std::string_view::npos;
+}
+
 }  // namespace
 
 const ApiRoute* apiRoutes()
@@ -41,36 +141,41 @@ const ApiRoute* apiRoutes()
 
 std::size_t apiRouteCount()
 {
-    return sizeof(kRoutes) / sizeof(kRoutes[0]);
+    return kRouteCount;
 }
 
-HandlerId matchRoute(HttpMethod method, const char* path)
+HandlerId matchRoute(HttpMethod method, std::string_view path)
 {
-    if (path == nullptr) {
-        return HandlerId::NotFound;
-    }
-
-    // Exact match for every route except the per-pump command (prefix rule).
-    for (const ApiRoute& route : kRoutes) {
-        if (route.id == HandlerId::PumpCmd) {
-            continue;
-        }
-        if (route.method == method && std::strcmp(route.path, path) == 0) {
-            return route.id;
-        }
+    // Exact match for every route except the per-pump ones (prefix rules).
+    const uint8_t slot = kIndex.slots[routeHash(method, path, kIndex.seed) % kSlots];
+    if (slot != kEmpty && kRoutes[slot].method == method && path == kRoutes[slot].path) {
+        return kRoutes[slot].id;
     }
 
     // POST /api/v1/pumps/{name} — the prefix must be followed by a non-empty
     // name (a bare "/api/v1/pumps" GET is PumpsList, matched exactly above).
-    if (method == HttpMethod::Post) {
-        const std::size_t prefixLen = std::strlen(kPumpCommandPrefix);
-        if (std::strncmp(path, kPumpCommandPrefix, prefixLen) == 0 &&
-            path[prefixLen] != '\0') {
-            return HandlerId::PumpCmd;
-        }
+    if (method == HttpMethod::Post && startsWithPumpPrefix(path)) {
+        return HandlerId::PumpCmd;
+    }
+    if (method == HttpMethod::Get && isPumpUsagePath(path)) {
+        return HandlerId::PumpUsage;
     }
 
     return HandlerId::NotFound;
 }
 
+HandlerId matchRoute(HttpMethod method, const char* path)
+{
+    if (path == nullptr) {
+        return HandlerId::NotFound;
+    }
+    return matchRoute(method, std::string_view(path));
+}
+
+bool routePathKnown(std::string_view path)
+{
+    return matchRoute(HttpMethod::Get, path) != HandlerId::NotFound ||
+           matchRoute(HttpMethod::Post, path) != HandlerId::NotFound;
+}
+
 }  // namespace api
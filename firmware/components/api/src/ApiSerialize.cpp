@@ -12,6 +12,9 @@
 #include "cJSON.h"
 
 #include "api/ApiEnvelope.h"
+#include "api/JsonTemplate.h"
+#include "interfaces/IDataStorage.h"
+#include "interfaces/MetricRegistry.h"
 
 namespace api {
 
@@ -29,15 +32,62 @@ void addFiniteNumber(cJSON* obj, const char* key, double value)
     }
 }
 
-/// Build the power telemetry object `{ valid, busVoltage, current, power }`.
-/// Ownership transfers to the caller (who attaches or spreads it).
+/// addFiniteNumber() of a reading with @p decimals fraction digits
+/// (roundJsonDecimals()).
+void addReading(cJSON* obj, const char* key, double value, int decimals)
+{
+    addFiniteNumber(obj, key, roundJsonDecimals(value, decimals));
+}
+
+/// A reading array item, rounded as addReading() rounds.
+cJSON* createReading(float value, int decimals)
+{
+    return cJSON_CreateNumber(roundJsonDecimals(static_cast<double>(value), decimals));
+}
+
+/// An epoch, or null for 0 (not set).
+void addEpochOrNull(cJSON* obj, const char* key, uint32_t epoch)
+{
+    if (epoch != 0) {
+        cJSON_AddNumberToObject(obj, key, static_cast<double>(epoch));
+    } else {
+        cJSON_AddNullToObject(obj, key);
+    }
+}
+
+/// Build the energy object of GET /power.
+cJSON* buildEnergyObject(const EnergyDto& energy)
+{
+    cJSON* obj = cJSON_CreateObject();
+    addReading(obj, "totalWh", energy.totalWh, decimals::kEnergy);
+    addReading(obj, "dayWh", energy.dayWh, decimals::kEnergy);
+    addEpochOrNull(obj, "dayStart", energy.dayStart);
+    addReading(obj, "previousDayWh", energy.previousDayWh, decimals::kEnergy);
+    addEpochOrNull(obj, "previousDayStart", energy.previousDayStart);
+    cJSON_AddBoolToObject(obj, "runActive", energy.runActive);
+    addReading(obj, "runWh", energy.runWh, decimals::kEnergy);
+    cJSON_AddNumberToObject(obj, "runMs", static_cast<double>(energy.runMs));
+    addReading(obj, "lastRunWh", energy.lastRunWh, decimals::kEnergy);
+    cJSON_AddNumberToObject(obj, "lastRunMs", static_cast<double>(energy.lastRunMs));
+    addEpochOrNull(obj, "lastRunStart", energy.lastRunStart);
+    cJSON_AddNumberToObject(obj, "runs", static_cast<double>(energy.runs));
+    cJSON_AddNumberToObject(obj, "uncoveredMs", static_cast<double>(energy.uncoveredMs));
+    return obj;
+}
+
+/// Build the power telemetry object `{ valid, busVoltage, current, power }`,
+/// plus `energy` when the DTO has it. Ownership transfers to the caller
+/// (who attaches or spreads it).
 cJSON* buildPowerObject(const PowerDto& power)
 {
     cJSON* obj = cJSON_CreateObject();
     cJSON_AddBoolToObject(obj, "valid", power.valid);
-    addFiniteNumber(obj, "busVoltage", power.busVoltage);
-    addFiniteNumber(obj, "current", power.current);
-    addFiniteNumber(obj, "power", power.power);
+    addReading(obj, "busVoltage", power.busVoltage, decimals::kBusVoltage);
+    addReading(obj, "current", power.current, decimals::kCurrent);
+    addReading(obj, "power", power.power, decimals::kPower);
+    if (power.hasEnergy) {
+        cJSON_AddItemToObject(obj, "energy", buildEnergyObject(power.energy));
+    }
     return obj;
 }
 
@@ -52,6 +102,114 @@ void attachPower(cJSON* root, bool hasPower, const PowerDto& power)
     }
 }
 
+/// Build the environmental object `{ valid, temperature, humidity, pressure }`.
+/// Ownership transfers to the caller.
+cJSON* buildEnvironmentalObject(const EnvironmentalDto& env)
+{
+    cJSON* obj = cJSON_CreateObject();
+    cJSON_AddBoolToObject(obj, "valid", env.valid);
+    addReading(obj, "temperature", env.temperature, decimals::kTemperature);
+    addReading(obj, "humidity", env.humidity, decimals::kHumidity);
+    addReading(obj, "pressure", env.pressure, decimals::kPressure);
+    return obj;
+}
+
+/// Add the soil fields to @p obj. NPK channels are present only when the
+/// sensor reported them (has-flag).
+void addSoilFields(cJSON* obj, const SoilDto& soil)
+{
+    cJSON_AddBoolToObject(obj, "valid", soil.valid);
+    addReading(obj, "moisture", soil.moisture, decimals::kMoisture);
+    addReading(obj, "temperature", soil.temperature, decimals::kTemperature);
+    addReading(obj, "humidity", soil.humidity, decimals::kHumidity);
+    addReading(obj, "ph", soil.ph, decimals::kPh);
+    addReading(obj, "ec", soil.ec, decimals::kEc);
+    if (soil.hasNitrogen) {
+        addReading(obj, "nitrogen", soil.nitrogen, decimals::kNutrient);
+    }
+    if (soil.hasPhosphorus) {
+        addReading(obj, "phosphorus", soil.phosphorus, decimals::kNutrient);
+    }
+    if (soil.hasPotassium) {
+        addReading(obj, "potassium", soil.potassium, decimals::kNutrient);
+    }
+}
+
+/// Build the soil object. Ownership transfers to the caller.
+cJSON* buildSoilObject(const SoilDto& soil)
+{
+    cJSON* obj = cJSON_CreateObject();
+    addSoilFields(obj, soil);
+    return obj;
+}
+
+/// Build the `soilProbes` array: each probe's soil fields after its
+/// address. Ownership transfers to the caller.
+cJSON* buildSoilProbesArray(const std::vector<SoilProbeDto>& probes)
+{
+    cJSON* arr = cJSON_CreateArray();
+    for (const SoilProbeDto& probe : probes) {
+        cJSON* obj = cJSON_CreateObject();
+        cJSON_AddNumberToObject(obj, "address", probe.address);
+        addSoilFields(obj, probe.soil);
+        cJSON_AddItemToArray(arr, obj);
+    }
+    return arr;
+}
+
+/// Build the `soilBus` object; shares are reported in percent.
+/// Ownership transfers to the caller.
+cJSON* buildSoilBusObject(const SoilBusDto& bus)
+{
+    cJSON* obj = cJSON_CreateObject();
+    cJSON_AddNumberToObject(obj, "periodMs", static_cast<double>(bus.periodMs));
+    cJSON_AddNumberToObject(obj, "readAirtimeMs", bus.readAirtimeUs / 1000.0);
+    cJSON_AddNumberToObject(obj, "budgetPercent", bus.budgetPermille / 10.0);
+    cJSON_AddNumberToObject(obj, "measuredPercent", bus.measuredPermille / 10.0);
+    cJSON_AddNumberToObject(obj, "polls", static_cast<double>(bus.polls));
+    cJSON_AddNumberToObject(obj, "failures", static_cast<double>(bus.failures));
+    cJSON_AddNumberToObject(obj, "missedSlots", static_cast<double>(bus.missed));
+    return obj;
+}
+
+/// Build the level object `{ low:{valid,waterPresent}, high:{...} }`.
+/// Ownership transfers to the caller.
+cJSON* buildLevelObject(const LevelDto& level)
+{
+    cJSON* obj = cJSON_CreateObject();
+    cJSON* low = cJSON_CreateObject();
+    cJSON_AddBoolToObject(low, "valid", level.low.valid);
+    cJSON_AddBoolToObject(low, "waterPresent", level.low.waterPresent);
+    cJSON_AddItemToObject(obj, "low", low);
+    cJSON* high = cJSON_CreateObject();
+    cJSON_AddBoolToObject(high, "valid", level.high.valid);
+    cJSON_AddBoolToObject(high, "waterPresent", level.high.waterPresent);
+    cJSON_AddItemToObject(obj, "high", high);
+    return obj;
+}
+
+/// Add the top-level `timestamp`: JSON null when the clock is not set (no
+/// bogus 1970).
+void addTimestamp(cJSON* root, bool hasTimestamp, int64_t timestamp)
+{
+    if (hasTimestamp) {
+        cJSON_AddNumberToObject(root, "timestamp", static_cast<double>(timestamp));
+    } else {
+        cJSON_AddNullToObject(root, "timestamp");
+    }
+}
+
+/// Print a live-stream message (no success envelope) and free it; "" when
+/// cJSON cannot allocate (the stream drops it).
+std::string printMessage(cJSON* root)
+{
+    char* text = cJSON_PrintUnformatted(root);
+    std::string out = (text != nullptr) ? std::string(text) : std::string();
+    cJSON_free(text);
+    cJSON_Delete(root);
+    return out;
+}
+
 /// Build one pump object `{ name, running, currentRunTimeMs,
 /// accumulatedRunTimeMs, lastStopReason }`. Ownership transfers to the caller.
 cJSON* buildPumpObject(const PumpDto& pump)
@@ -67,113 +225,251 @@ cJSON* buildPumpObject(const PumpDto& pump)
     return obj;
 }
 
-}  // namespace
-
-std::string serializeStatus(const SystemStatusDto& status)
+/// Build the /status object (everything but `success`). Ownership transfers
+/// to the caller.
+cJSON* buildStatusObject(const SystemStatusDto& status)
 {
     cJSON* root = cJSON_CreateObject();
+    const auto selected = [&status](uint32_t bit) { return (status.fields & bit) != 0; };
 
-    cJSON_AddStringToObject(root, "mode", status.mode.c_str());
+    if (selected(kStatusMode)) {
+        cJSON_AddStringToObject(root, "mode", status.mode.c_str());
+    }
 
     // The wifi block never carries the password (there is no such field).
-    cJSON* wifi = cJSON_CreateObject();
-    cJSON_AddStringToObject(wifi, "state", status.wifi.state.c_str());
-    cJSON_AddNumberToObject(wifi, "rssi", status.wifi.rssi);
-    cJSON_AddStringToObject(wifi, "ssid", status.wifi.ssid.c_str());
-    cJSON_AddBoolToObject(wifi, "connected", status.wifi.connected);
-    cJSON_AddBoolToObject(wifi, "ipAcquired", status.wifi.ipAcquired);
-    cJSON_AddStringToObject(wifi, "ip", status.wifi.ip.c_str());
-    cJSON_AddItemToObject(root, "wifi", wifi);
-
-    cJSON* time = cJSON_CreateObject();
-    cJSON_AddBoolToObject(time, "synced", status.time.synced);
-    if (status.time.synced) {
-        cJSON_AddNumberToObject(time, "epoch",
-                                static_cast<double>(status.time.epoch));
-    } else {
-        // Clock not set: JSON null epoch (no bogus 1970), mirroring the not-set
-        // top-level timestamp in serializeSensors.
-        cJSON_AddNullToObject(time, "epoch");
-    }
-    cJSON_AddStringToObject(time, "local", status.time.local.c_str());
-    cJSON_AddNumberToObject(time, "lastSync",
-                            static_cast<double>(status.time.lastSync));
-    cJSON_AddItemToObject(root, "time", time);
-
-    cJSON_AddNumberToObject(root, "uptimeMs",
-                            static_cast<double>(status.uptimeMs));
-    cJSON_AddStringToObject(root, "resetReason", status.resetReason.c_str());
-
-    cJSON* firmware = cJSON_CreateObject();
-    cJSON_AddStringToObject(firmware, "version", status.firmware.version.c_str());
-    cJSON_AddStringToObject(firmware, "project", status.firmware.project.c_str());
-    cJSON_AddItemToObject(root, "firmware", firmware);
-
-    cJSON* storage = cJSON_CreateObject();
-    cJSON_AddNumberToObject(storage, "totalBytes",
-                            static_cast<double>(status.storage.totalBytes));
-    cJSON_AddNumberToObject(storage, "usedBytes",
-                            static_cast<double>(status.storage.usedBytes));
-    addFiniteNumber(storage, "percentUsed", status.storage.percentUsed);
-    cJSON_AddItemToObject(root, "storage", storage);
-
-    attachPower(root, status.hasPower, status.power);
+    if (selected(kStatusWifi)) {
+        cJSON* wifi = cJSON_CreateObject();
+        cJSON_AddStringToObject(wifi, "state", status.wifi.state.c_str());
+        cJSON_AddNumberToObject(wifi, "rssi", status.wifi.rssi);
+        cJSON_AddStringToObject(wifi, "ssid", status.wifi.ssid.c_str());
+        cJSON_AddBoolToObject(wifi, "connected", status.wifi.connected);
+        cJSON_AddBoolToObject(wifi, "ipAcquired", status.wifi.ipAcquired);
+        cJSON_AddStringToObject(wifi, "ip", status.wifi.ip.c_str());
+        cJSON_AddStringToObject(wifi, "powerSave", status.wifi.powerSave.c_str());
+        cJSON_AddItemToObject(root, "wifi", wifi);
+    }
 
-    return successBody(root);
+    if (selected(kStatusTime)) {
+        cJSON* time = cJSON_CreateObject();
+        cJSON_AddBoolToObject(time, "synced", status.time.synced);
+        if (status.time.synced) {
+            cJSON_AddNumberToObject(time, "epoch",
+                                    static_cast<double>(status.time.epoch));
+        } else {
+            // Clock not set: JSON null epoch (no bogus 1970), mirroring the
+            // not-set top-level timestamp in serializeSensors.
+            cJSON_AddNullToObject(time, "epoch");
+        }
+        cJSON_AddStringToObject(time, "local", status.time.local.c_str());
+        cJSON_AddNumberToObject(time, "lastSync",
+                                static_cast<double>(status.time.lastSync));
+        cJSON_AddItemToObject(root, "time", time);
+    }
+
+    if (selected(kStatusUptime)) {
+        cJSON_AddNumberToObject(root, "uptimeMs",
+                                static_cast<double>(status.uptimeMs));
+    }
+    if (selected(kStatusResetReason)) {
+        cJSON_AddStringToObject(root, "resetReason", status.resetReason.c_str());
+    }
+
+    if (selected(kStatusFirmware)) {
+        cJSON* firmware = cJSON_CreateObject();
+        cJSON_AddStringToObject(firmware, "version", status.firmware.version.c_str());
+        cJSON_AddStringToObject(firmware, "project", status.firmware.project.c_str());
+        cJSON_AddItemToObject(root, "firmware", firmware);
+    }
+
+    if (selected(kStatusStorage)) {
+        cJSON* storage = cJSON_CreateObject();
+        cJSON_AddNumberToObject(storage, "totalBytes",
+                                static_cast<double>(status.storage.totalBytes));
+        cJSON_AddNumberToObject(storage, "usedBytes",
+                                static_cast<double>(status.storage.usedBytes));
+        addFiniteNumber(storage, "percentUsed", status.storage.percentUsed);
+        const StorageWritesDto& w = status.storage.writes;
+        cJSON* writes = cJSON_CreateObject();
+        cJSON_AddNumberToObject(writes, "bytesAppended", static_cast<double>(w.bytesAppended));
+        cJSON_AddNumberToObject(writes, "syncs", static_cast<double>(w.syncs));
+        cJSON_AddNumberToObject(writes, "filesCreated", static_cast<double>(w.filesCreated));
+        cJSON_AddNumberToObject(writes, "filesRemoved", static_cast<double>(w.filesRemoved));
+        cJSON_AddNumberToObject(writes, "tornRepairs", static_cast<double>(w.tornRepairs));
+        cJSON_AddNumberToObject(writes, "rotations", static_cast<double>(w.rotations));
+        cJSON_AddNumberToObject(writes, "appendUs", static_cast<double>(w.appendUs));
+        cJSON_AddItemToObject(storage, "writes", writes);
+        cJSON_AddItemToObject(root, "storage", storage);
+    }
+
+    // Boot phases as microseconds after reset; a phase not reached is null.
+    if (selected(kStatusBoot) && status.boot.empty()) {
+        cJSON_AddNullToObject(root, "bootUs");
+    } else if (selected(kStatusBoot)) {
+        cJSON* boot = cJSON_CreateObject();
+        for (const BootPhaseDto& phase : status.boot) {
+            if (phase.atUs == 0) {
+                cJSON_AddNullToObject(boot, phase.name.c_str());
+            } else {
+                cJSON_AddNumberToObject(boot, phase.name.c_str(),
+                                        static_cast<double>(phase.atUs));
+            }
+        }
+        cJSON_AddItemToObject(root, "bootUs", boot);
+    }
+
+    if (selected(kStatusPower)) {
+        attachPower(root, status.hasPower, status.power);
+    }
+    return root;
 }
 
-std::string serializeSensors(const SensorReadingsDto& sensors)
+/// Build the /sensors object (everything but `success`). Ownership
+/// transfers to the caller.
+cJSON* buildSensorsObject(const SensorReadingsDto& sensors)
 {
     cJSON* root = cJSON_CreateObject();
+    const auto selected = [&sensors](uint32_t bit) { return (sensors.fields & bit) != 0; };
+    if (selected(kSensorsEnvironmental)) {
+        cJSON_AddItemToObject(root, "environmental",
+                              buildEnvironmentalObject(sensors.environmental));
+    }
+    if (selected(kSensorsSoil)) {
+        cJSON_AddItemToObject(root, "soil", buildSoilObject(sensors.soil));
+    }
+    if (selected(kSensorsSoilProbes) && !sensors.soilProbes.empty()) {
+        cJSON_AddItemToObject(root, "soilProbes",
+                              buildSoilProbesArray(sensors.soilProbes));
+        cJSON_AddItemToObject(root, "soilBus", buildSoilBusObject(sensors.soilBus));
+    }
+    if (selected(kSensorsLevel)) {
+        cJSON_AddItemToObject(root, "level", buildLevelObject(sensors.level));
+    }
 
-    cJSON* env = cJSON_CreateObject();
-    cJSON_AddBoolToObject(env, "valid", sensors.environmental.valid);
-    addFiniteNumber(env, "temperature", sensors.environmental.temperature);
-    addFiniteNumber(env, "humidity", sensors.environmental.humidity);
-    addFiniteNumber(env, "pressure", sensors.environmental.pressure);
-    cJSON_AddItemToObject(root, "environmental", env);
-
-    cJSON* soil = cJSON_CreateObject();
-    cJSON_AddBoolToObject(soil, "valid", sensors.soil.valid);
-    addFiniteNumber(soil, "moisture", sensors.soil.moisture);
-    addFiniteNumber(soil, "temperature", sensors.soil.temperature);
-    addFiniteNumber(soil, "humidity", sensors.soil.humidity);
-    addFiniteNumber(soil, "ph", sensors.soil.ph);
-    addFiniteNumber(soil, "ec", sensors.soil.ec);
-    // NPK channels are present only when the sensor reported them (has-flag).
-    if (sensors.soil.hasNitrogen) {
-        addFiniteNumber(soil, "nitrogen", sensors.soil.nitrogen);
-    }
-    if (sensors.soil.hasPhosphorus) {
-        addFiniteNumber(soil, "phosphorus", sensors.soil.phosphorus);
-    }
-    if (sensors.soil.hasPotassium) {
-        addFiniteNumber(soil, "potassium", sensors.soil.potassium);
-    }
-    cJSON_AddItemToObject(root, "soil", soil);
-
-    cJSON* level = cJSON_CreateObject();
-    cJSON* low = cJSON_CreateObject();
-    cJSON_AddBoolToObject(low, "valid", sensors.level.low.valid);
-    cJSON_AddBoolToObject(low, "waterPresent", sensors.level.low.waterPresent);
-    cJSON_AddItemToObject(level, "low", low);
-    cJSON* high = cJSON_CreateObject();
-    cJSON_AddBoolToObject(high, "valid", sensors.level.high.valid);
-    cJSON_AddBoolToObject(high, "waterPresent", sensors.level.high.waterPresent);
-    cJSON_AddItemToObject(level, "high", high);
-    cJSON_AddItemToObject(root, "level", level);
+    if (selected(kSensorsPower)) {
+        attachPower(root, sensors.hasPower, sensors.power);
+    }
+    if (selected(kSensorsTimestamp)) {
+        addTimestamp(root, sensors.hasTimestamp, sensors.timestamp);
+    }
+    return root;
+}
 
-    attachPower(root, sensors.hasPower, sensors.power);
+/// Keep only the keys @p keys names for @p member in @p obj.
+void keepKeys(cJSON* obj, const std::string& member, const std::vector<FieldKey>& keys)
+{
+    cJSON* item = obj->child;
+    while (item != nullptr) {
+        cJSON* next = item->next;
+        bool named = false;
+        for (const FieldKey& key : keys) {
+            named = named || (key.member == member && key.key == item->string);
+        }
+        if (!named) {
+            cJSON_Delete(cJSON_DetachItemViaPointer(obj, item));
+        }
+        item = next;
+    }
+}
 
-    // Top-level timestamp: JSON null when the clock is not set (no bogus 1970).
-    if (sensors.hasTimestamp) {
-        cJSON_AddNumberToObject(root, "timestamp",
-                                static_cast<double>(sensors.timestamp));
-    } else {
-        cJSON_AddNullToObject(root, "timestamp");
+/// Cut the members of @p root that @p keys names down to their keys. A
+/// null member (power on rev1) stays null.
+cJSON* projectKeys(cJSON* root, const std::vector<FieldKey>& keys)
+{
+    if (root == nullptr) {
+        return root;  // successBody() reports the allocation failure
+    }
+    for (cJSON* member = root->child; member != nullptr; member = member->next) {
+        bool narrowed = false;
+        for (const FieldKey& key : keys) {
+            narrowed = narrowed || key.member == member->string;
+        }
+        if (!narrowed) {
+            continue;
+        }
+        if (cJSON_IsObject(member)) {
+            keepKeys(member, member->string, keys);
+        } else if (cJSON_IsArray(member)) {
+            for (cJSON* element = member->child; element != nullptr; element = element->next) {
+                if (cJSON_IsObject(element)) {
+                    keepKeys(element, member->string, keys);
+                }
+            }
+        }
     }
+    return root;
+}
 
-    return successBody(root);
+/// The `events` array shared by the paged and the tail bodies. Ownership
+/// transfers to the caller.
+cJSON* eventsArray(const std::vector<EventDto>& events)
+{
+    cJSON* arr = cJSON_CreateArray();
+    // Order is preserved as given (caller supplies newest-first).
+    for (const EventDto& ev : events) {
+        cJSON* obj = cJSON_CreateObject();
+        cJSON_AddNumberToObject(obj, "epoch", static_cast<double>(ev.epoch));
+        cJSON_AddNumberToObject(obj, "category",
+                                static_cast<double>(ev.category));
+        if (ev.categoryName.has_value()) {
+            cJSON_AddStringToObject(obj, "categoryName",
+                                    ev.categoryName->c_str());
+        }
+        cJSON_AddStringToObject(obj, "detail", ev.detail.c_str());
+        cJSON_AddItemToArray(arr, obj);
+    }
+    return arr;
+}
+
+}  // namespace
+
+int metricDecimals(std::string_view name)
+{
+    const MetricId id = metric::findKnown(name);
+    if (id >= metric::kSoilMoisture2 && id < metric::kKnownCount) {
+        return decimals::kMoisture;  // the further probes' moisture
+    }
+    switch (id) {
+    case metric::kEnvTemperature:
+    case metric::kSoilTemperature:
+        return decimals::kTemperature;
+    case metric::kEnvHumidity:
+        return decimals::kHumidity;
+    case metric::kEnvPressure:
+        return decimals::kPressure;
+    case metric::kSoilMoisture:
+        return decimals::kMoisture;
+    case metric::kSoilPh:
+        return decimals::kPh;
+    case metric::kSoilEc:
+        return decimals::kEc;
+    case metric::kSoilNitrogen:
+    case metric::kSoilPhosphorus:
+    case metric::kSoilPotassium:
+        return decimals::kNutrient;
+    default:
+        return decimals::kShortest;
+    }
+}
+
+std::string serializeStatus(const SystemStatusDto& status)
+{
+    return successBody(buildStatusObject(status));
+}
+
+std::string serializeStatus(const SystemStatusDto& status, const std::vector<FieldKey>& keys)
+{
+    return successBody(projectKeys(buildStatusObject(status), keys));
+}
+
+std::string serializeSensors(const SensorReadingsDto& sensors)
+{
+    return successBody(buildSensorsObject(sensors));
+}
+
+std::string serializeSensors(const SensorReadingsDto& sensors,
+                             const std::vector<FieldKey>& keys)
+{
+    return successBody(projectKeys(buildSensorsObject(sensors), keys));
 }
 
 std::string serializePower(const PowerDto& power)
@@ -208,6 +504,109 @@ std::string serializePumpList(const std::vector<PumpDto>& pumps)
     return successBody(root);
 }
 
+std::string serializePumpUsage(const PumpUsageDto& usage)
+{
+    const auto buckets = [](const std::vector<PumpUsageBucketDto>& list) {
+        cJSON* arr = cJSON_CreateArray();
+        for (const PumpUsageBucketDto& b : list) {
+            cJSON* obj = cJSON_CreateObject();
+            cJSON_AddNumberToObject(obj, "start", static_cast<double>(b.start));
+            cJSON_AddNumberToObject(obj, "runMs", static_cast<double>(b.runMs));
+            cJSON_AddNumberToObject(obj, "starts", static_cast<double>(b.starts));
+            cJSON_AddItemToArray(arr, obj);
+        }
+        return arr;
+    };
+    cJSON* root = cJSON_CreateObject();
+    cJSON_AddStringToObject(root, "name", usage.name.c_str());
+    cJSON_AddBoolToObject(root, "timed", usage.timed);
+    cJSON_AddNumberToObject(root, "untimedRuns", static_cast<double>(usage.untimedRuns));
+    cJSON_AddItemToObject(root, "hours", buckets(usage.hours));
+    cJSON_AddItemToObject(root, "days", buckets(usage.days));
+    return successBody(root);
+}
+
+std::string serializeSnapshot(const SnapshotDto& snapshot)
+{
+    // One tree, one print: the sections are the same objects the single
+    // endpoints spread, nested under their own keys.
+    cJSON* root = cJSON_CreateObject();
+    if ((snapshot.fields & kSnapshotStatus) != 0) {
+        cJSON_AddItemToObject(root, "status", buildStatusObject(snapshot.status));
+    }
+    if ((snapshot.fields & kSnapshotSensors) != 0) {
+        cJSON_AddItemToObject(root, "sensors", buildSensorsObject(snapshot.sensors));
+    }
+    if ((snapshot.fields & kSnapshotPumps) != 0) {
+        cJSON* arr = cJSON_CreateArray();
+        for (const PumpDto& pump : snapshot.pumps) {
+            cJSON_AddItemToArray(arr, buildPumpObject(pump));
+        }
+        cJSON_AddItemToObject(root, "pumps", arr);
+    }
+    if ((snapshot.fields & kSnapshotPower) != 0) {
+        attachPower(root, snapshot.hasPower, snapshot.power);
+    }
+    return successBody(root);
+}
+
+std::string serializeNodes(const std::vector<NodeDto>& nodes)
+{
+    cJSON* root = cJSON_CreateObject();
+    cJSON* arr = cJSON_CreateArray();
+    for (const NodeDto& node : nodes) {
+        cJSON* obj = cJSON_CreateObject();
+        cJSON_AddStringToObject(obj, "node", node.node.c_str());
+        cJSON_AddNumberToObject(obj, "lastSeenS", static_cast<double>(node.lastSeenS));
+        cJSON_AddNumberToObject(obj, "rssi", node.rssi);
+        cJSON_AddNumberToObject(obj, "reports", static_cast<double>(node.reports));
+        cJSON_AddNumberToObject(obj, "duplicates", static_cast<double>(node.duplicates));
+        cJSON_AddNumberToObject(obj, "missed", static_cast<double>(node.missed));
+        cJSON_AddItemToObject(obj, "sensors", buildSensorsObject(node.sensors));
+        cJSON* pumps = cJSON_CreateArray();
+        for (const PumpDto& pump : node.pumps) {
+            cJSON_AddItemToArray(pumps, buildPumpObject(pump));
+        }
+        cJSON_AddItemToObject(obj, "pumps", pumps);
+        cJSON_AddItemToArray(arr, obj);
+    }
+    cJSON_AddItemToObject(root, "nodes", arr);
+    return successBody(root);
+}
+
+std::string serializeLogs(const LogsDto& logs)
+{
+    cJSON* root = cJSON_CreateObject();
+    cJSON_AddNumberToObject(root, "dropped", static_cast<double>(logs.dropped));
+    cJSON* arr = cJSON_CreateArray();
+    for (const std::string& line : logs.lines) {
+        cJSON_AddItemToArray(arr, cJSON_CreateString(line.c_str()));
+    }
+    cJSON_AddItemToObject(root, "lines", arr);
+    return successBody(root);
+}
+
+std::string serializeOtaReport(const OtaReport& report)
+{
+    cJSON* root = cJSON_CreateObject();
+    cJSON_AddNumberToObject(root, "bytes", static_cast<double>(report.bytes));
+    cJSON_AddNumberToObject(root, "transferBytes", static_cast<double>(report.transferBytes));
+    cJSON_AddBoolToObject(root, "delta", report.delta);
+    cJSON_AddStringToObject(root, "sha256", Sha256::toHex(report.sha256).c_str());
+    cJSON_AddNumberToObject(root, "elapsedMs", static_cast<double>(report.elapsedMs));
+    cJSON_AddBoolToObject(root, "rebooting", true);
+    return successBody(root);
+}
+
+std::string serializeRestoreReport(const RestoreReport& report, bool configApplied)
+{
+    cJSON* root = cJSON_CreateObject();
+    cJSON_AddNumberToObject(root, "files", static_cast<double>(report.files));
+    cJSON_AddNumberToObject(root, "bytes", static_cast<double>(report.bytes));
+    cJSON_AddBoolToObject(root, "configApplied", configApplied);
+    return successBody(root);
+}
+
 std::string serializeConfig(const ConfigDto& config)
 {
     cJSON* root = cJSON_CreateObject();
@@ -222,6 +621,16 @@ std::string serializeConfig(const ConfigDto& config)
                             static_cast<double>(config.sensorReadIntervalMs));
     cJSON_AddNumberToObject(root, "dataLogIntervalMs",
                             static_cast<double>(config.dataLogIntervalMs));
+    // Keyed by metric name, so a client can round-trip it into a POST as is.
+    cJSON* policies = cJSON_CreateObject();
+    for (const LogPolicyDto& p : config.logPolicies) {
+        cJSON* policy = cJSON_CreateObject();
+        addFiniteNumber(policy, "deadbandAbs", p.deadbandAbs);
+        addFiniteNumber(policy, "deadbandRel", p.deadbandRel);
+        cJSON_AddNumberToObject(policy, "heartbeatS", static_cast<double>(p.heartbeatS));
+        cJSON_AddItemToObject(policies, p.metric.c_str(), policy);
+    }
+    cJSON_AddItemToObject(root, "logPolicies", policies);
     // No wifi password: the ConfigDto carries no such field by design.
     return successBody(root);
 }
@@ -239,13 +648,29 @@ std::string serializeHistory(const HistorySeries& series)
     }
     cJSON_AddItemToObject(root, "timestamps", timestamps);
 
+    const int places = metricDecimals(series.metric);
     cJSON* values = cJSON_CreateArray();
     for (float v : series.values) {
-        cJSON_AddItemToArray(values,
-                             cJSON_CreateNumber(static_cast<double>(v)));
+        cJSON_AddItemToArray(values, createReading(v, places));
     }
     cJSON_AddItemToObject(root, "values", values);
 
+    // Resolution: 0 for raw readings; a bucketed series adds the per-bucket
+    // extremes, aligned like values[].
+    cJSON_AddNumberToObject(root, "bucket", static_cast<double>(series.bucketS));
+    if (series.bucketS != 0) {
+        cJSON* mins = cJSON_CreateArray();
+        for (float v : series.mins) {
+            cJSON_AddItemToArray(mins, createReading(v, places));
+        }
+        cJSON_AddItemToObject(root, "min", mins);
+        cJSON* maxs = cJSON_CreateArray();
+        for (float v : series.maxs) {
+            cJSON_AddItemToArray(maxs, createReading(v, places));
+        }
+        cJSON_AddItemToObject(root, "max", maxs);
+    }
+
     // Echo of the resolved query.
     cJSON_AddStringToObject(root, "metric", series.metric.c_str());
     if (series.reading.has_value()) {
@@ -257,28 +682,96 @@ std::string serializeHistory(const HistorySeries& series)
     cJSON_AddNumberToObject(root, "end", static_cast<double>(series.end));
     cJSON_AddNumberToObject(root, "count",
                             static_cast<double>(series.timestamps.size()));
+    // Points in the arrays that were held over, not logged (step fill).
+    cJSON_AddNumberToObject(root, "filled", static_cast<double>(series.filled));
+    if (series.next.has_value()) {
+        cJSON_AddStringToObject(root, "next", series.next->c_str());
+    }
 
     return successBody(root);
 }
 
-std::string serializeEvents(const std::vector<EventDto>& events)
+std::string serializeHistoryStats(const HistoryStatsDto& stats)
 {
+    const int places = metricDecimals(stats.metric);
     cJSON* root = cJSON_CreateObject();
+    cJSON_AddNumberToObject(root, "count", static_cast<double>(stats.count));
+    if (stats.count != 0) {
+        addReading(root, "min", stats.min, places);
+        addReading(root, "max", stats.max, places);
+        addReading(root, "mean", stats.mean, places);
+        addReading(root, "last", stats.last, places);
+        cJSON_AddNumberToObject(root, "lastTimestamp",
+                                static_cast<double>(stats.lastTimestamp));
+    } else {
+        cJSON_AddNullToObject(root, "min");
+        cJSON_AddNullToObject(root, "max");
+        cJSON_AddNullToObject(root, "mean");
+        cJSON_AddNullToObject(root, "last");
+        cJSON_AddNullToObject(root, "lastTimestamp");
+    }
+    // Estimates from a quantile sketch; null without one (empty window,
+    // or nothing finite to rank).
+    if (stats.count != 0 && stats.percentiles) {
+        addReading(root, "p5", stats.p5, places);
+        addReading(root, "p50", stats.p50, places);
+        addReading(root, "p95", stats.p95, places);
+    } else {
+        cJSON_AddNullToObject(root, "p5");
+        cJSON_AddNullToObject(root, "p50");
+        cJSON_AddNullToObject(root, "p95");
+    }
+
+    // Echo of the resolved query, as in serializeHistory.
+    cJSON_AddStringToObject(root, "metric", stats.metric.c_str());
+    if (stats.reading.has_value()) {
+        cJSON_AddStringToObject(root, "reading", stats.reading->c_str());
+    } else {
+        cJSON_AddNullToObject(root, "reading");
+    }
+    cJSON_AddNumberToObject(root, "start", static_cast<double>(stats.start));
+    cJSON_AddNumberToObject(root, "end", static_cast<double>(stats.end));
+
+    return successBody(root);
+}
+
+std::string serializeEvents(const std::vector<EventDto>& events,
+                            const std::optional<std::string>& next)
+{
+    cJSON* root = cJSON_CreateObject();
+    cJSON_AddItemToObject(root, "events", eventsArray(events));
+    if (next.has_value()) {
+        cJSON_AddStringToObject(root, "next", next->c_str());
+    }
+    return successBody(root);
+}
+
+std::string serializeEventTail(const std::vector<EventDto>& events,
+                               const std::string& tail, bool truncated)
+{
+    cJSON* root = cJSON_CreateObject();
+    cJSON_AddItemToObject(root, "events", eventsArray(events));
+    cJSON_AddStringToObject(root, "tail", tail.c_str());
+    cJSON_AddBoolToObject(root, "truncated", truncated);
+    return successBody(root);
+}
+
+std::string serializeEventSummary(const EventSummaryDto& summary)
+{
+    cJSON* root = cJSON_CreateObject();
+    cJSON_AddNumberToObject(root, "hours", static_cast<double>(summary.hours));
+    cJSON_AddNumberToObject(root, "since", static_cast<double>(summary.since));
     cJSON* arr = cJSON_CreateArray();
-    // Order is preserved as given (caller supplies newest-first).
-    for (const EventDto& ev : events) {
+    for (const EventCategoryCountDto& c : summary.categories) {
         cJSON* obj = cJSON_CreateObject();
-        cJSON_AddNumberToObject(obj, "epoch", static_cast<double>(ev.epoch));
-        cJSON_AddNumberToObject(obj, "category",
-                                static_cast<double>(ev.category));
-        if (ev.categoryName.has_value()) {
-            cJSON_AddStringToObject(obj, "categoryName",
-                                    ev.categoryName->c_str());
+        cJSON_AddNumberToObject(obj, "category", static_cast<double>(c.category));
+        if (c.categoryName.has_value()) {
+            cJSON_AddStringToObject(obj, "categoryName", c.categoryName->c_str());
         }
-        cJSON_AddStringToObject(obj, "detail", ev.detail.c_str());
+        cJSON_AddNumberToObject(obj, "count", static_cast<double>(c.count));
         cJSON_AddItemToArray(arr, obj);
     }
-    cJSON_AddItemToObject(root, "events", arr);
+    cJSON_AddItemToObject(root, "categories", arr);
     return successBody(root);
 }
 
@@ -299,4 +792,74 @@ std::string serializeSelfTest(const SelfTestResultDto& result)
     return successBody(root);
 }
 
+const char* eventCategoryName(int category)
+{
+    switch (category) {
+    case IDataStorage::kCategoryPump:
+        return "pump";
+    case IDataStorage::kCategoryFailsafe:
+        return "failsafe";
+    case IDataStorage::kCategoryConnectivity:
+        return "connectivity";
+    case IDataStorage::kCategoryOta:
+        return "ota";
+    case IDataStorage::kCategoryReset:
+        return "reset";
+    default:
+        return nullptr;
+    }
+}
+
+std::string serializeStreamSensors(const SensorReadingsDto& sensors,
+                                   const SensorSections& sections, bool full)
+{
+    cJSON* root = cJSON_CreateObject();
+    cJSON_AddStringToObject(root, "type", "sensors");
+    if (full) {
+        cJSON_AddBoolToObject(root, "full", true);
+    }
+    if (sections.environmental) {
+        cJSON_AddItemToObject(root, "environmental",
+                              buildEnvironmentalObject(sensors.environmental));
+    }
+    if (sections.soil) {
+        cJSON_AddItemToObject(root, "soil", buildSoilObject(sensors.soil));
+    }
+    if (sections.level) {
+        cJSON_AddItemToObject(root, "level", buildLevelObject(sensors.level));
+    }
+    if (sections.power && sensors.hasPower) {
+        cJSON_AddItemToObject(root, "power", buildPowerObject(sensors.power));
+    }
+    addTimestamp(root, sensors.hasTimestamp, sensors.timestamp);
+    return printMessage(root);
+}
+
+std::string serializeStreamPump(const PumpDto& pump)
+{
+    cJSON* root = cJSON_CreateObject();
+    cJSON_AddStringToObject(root, "type", "pump");
+    cJSON* obj = buildPumpObject(pump);
+    // Spread the pump fields after `type` (the pump object is then empty).
+    while (obj->child != nullptr) {
+        cJSON* child = cJSON_DetachItemViaPointer(obj, obj->child);
+        cJSON_AddItemToObject(root, child->string, child);
+    }
+    cJSON_Delete(obj);
+    return printMessage(root);
+}
+
+std::string serializeStreamEvent(const EventDto& event)
+{
+    cJSON* root = cJSON_CreateObject();
+    cJSON_AddStringToObject(root, "type", "event");
+    cJSON_AddNumberToObject(root, "epoch", static_cast<double>(event.epoch));
+    cJSON_AddNumberToObject(root, "category", static_cast<double>(event.category));
+    if (event.categoryName.has_value()) {
+        cJSON_AddStringToObject(root, "categoryName", event.categoryName->c_str());
+    }
+    cJSON_AddStringToObject(root, "detail", event.detail.c_str());
+    return printMessage(root);
+}
+
 }  // namespace api
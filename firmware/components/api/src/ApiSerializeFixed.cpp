@@ -0,0 +1,242 @@
+// SPDX-FileCopyrightText: 2026 Cryptotomte
+// SPDX-License-Identifier: AGPL-3.0-or-later
+/**
+ * @file ApiSerializeFixed.cpp
+ * @brief Fixed-buffer backend of the small read serializers: the
+ *        ApiSerialize.cpp object shapes as JsonTemplate.h field lists.
+ *
+ * Every shape here must follow its build*Object() twin key for key; the
+ * byte-identity tests in test_api_serialize.cpp hold them together.
+ */
+
+#include "api/ApiSerialize.h"
+
+#include <optional>
+
+#include "api/JsonTemplate.h"
+
+namespace api {
+
+namespace {
+
+using json::array;
+using json::custom;
+using json::field;
+using json::fixed;
+using json::object;
+using json::orNull;
+using json::shape;
+using json::spread;
+using json::when;
+
+/// An epoch, or null for 0 (not set).
+constexpr auto epochOrNull(uint32_t EnergyDto::*epoch)
+{
+    return [epoch](const EnergyDto& e) {
+        return e.*epoch != 0 ? std::optional<int64_t>(e.*epoch) : std::nullopt;
+    };
+}
+
+constexpr auto kEnergyShape = shape(
+    fixed("totalWh", &EnergyDto::totalWh, decimals::kEnergy),
+    fixed("dayWh", &EnergyDto::dayWh, decimals::kEnergy),
+    field("dayStart", epochOrNull(&EnergyDto::dayStart)),
+    fixed("previousDayWh", &EnergyDto::previousDayWh, decimals::kEnergy),
+    field("previousDayStart", epochOrNull(&EnergyDto::previousDayStart)),
+    field("runActive", &EnergyDto::runActive),
+    fixed("runWh", &EnergyDto::runWh, decimals::kEnergy),
+    field("runMs", &EnergyDto::runMs),
+    fixed("lastRunWh", &EnergyDto::lastRunWh, decimals::kEnergy),
+    field("lastRunMs", &EnergyDto::lastRunMs),
+    field("lastRunStart", epochOrNull(&EnergyDto::lastRunStart)),
+    field("runs", &EnergyDto::runs),
+    field("uncoveredMs", &EnergyDto::uncoveredMs));
+
+constexpr auto kPowerShape = shape(
+    field("valid", &PowerDto::valid),
+    fixed("busVoltage", &PowerDto::busVoltage, decimals::kBusVoltage),
+    fixed("current", &PowerDto::current, decimals::kCurrent),
+    fixed("power", &PowerDto::power, decimals::kPower),
+    when([](const PowerDto& p) { return p.hasEnergy; },
+         object("energy", &PowerDto::energy, kEnergyShape)));
+
+constexpr auto kEnvironmentalShape = shape(
+    field("valid", &EnvironmentalDto::valid),
+    fixed("temperature", &EnvironmentalDto::temperature, decimals::kTemperature),
+    fixed("humidity", &EnvironmentalDto::humidity, decimals::kHumidity),
+    fixed("pressure", &EnvironmentalDto::pressure, decimals::kPressure));
+
+constexpr auto kSoilShape = shape(
+    field("valid", &SoilDto::valid),
+    fixed("moisture", &SoilDto::moisture, decimals::kMoisture),
+    fixed("temperature", &SoilDto::temperature, decimals::kTemperature),
+    fixed("humidity", &SoilDto::humidity, decimals::kHumidity),
+    fixed("ph", &SoilDto::ph, decimals::kPh),
+    fixed("ec", &SoilDto::ec, decimals::kEc),
+    when([](const SoilDto& s) { return s.hasNitrogen; },
+         fixed("nitrogen", &SoilDto::nitrogen, decimals::kNutrient)),
+    when([](const SoilDto& s) { return s.hasPhosphorus; },
+         fixed("phosphorus", &SoilDto::phosphorus, decimals::kNutrient)),
+    when([](const SoilDto& s) { return s.hasPotassium; },
+         fixed("potassium", &SoilDto::potassium, decimals::kNutrient)));
+
+constexpr auto kSoilProbeShape = shape(
+    field("address", &SoilProbeDto::address),
+    spread(&SoilProbeDto::soil, kSoilShape));
+
+constexpr auto kSoilBusShape = shape(
+    field("periodMs", &SoilBusDto::periodMs),
+    field("readAirtimeMs", [](const SoilBusDto& b) { return b.readAirtimeUs / 1000.0; }),
+    field("budgetPercent", [](const SoilBusDto& b) { return b.budgetPermille / 10.0; }),
+    field("measuredPercent", [](const SoilBusDto& b) { return b.measuredPermille / 10.0; }),
+    field("polls", &SoilBusDto::polls),
+    field("failures", &SoilBusDto::failures),
+    field("missedSlots", &SoilBusDto::missed));
+
+constexpr auto kLevelMarkShape = shape(
+    field("valid", &LevelMarkDto::valid),
+    field("waterPresent", &LevelMarkDto::waterPresent));
+
+constexpr auto kLevelShape = shape(
+    object("low", &LevelDto::low, kLevelMarkShape),
+    object("high", &LevelDto::high, kLevelMarkShape));
+
+/// @p f while the DTO's `fields` projection selects @p Bit.
+template <uint32_t Bit, typename Field>
+constexpr auto selected(Field f)
+{
+    return when([](const auto& dto) { return (dto.fields & Bit) != 0; }, f);
+}
+
+constexpr auto kSensorsShape = shape(
+    selected<kSensorsEnvironmental>(
+        object("environmental", &SensorReadingsDto::environmental, kEnvironmentalShape)),
+    selected<kSensorsSoil>(object("soil", &SensorReadingsDto::soil, kSoilShape)),
+    selected<kSensorsSoilProbes>(
+        when([](const SensorReadingsDto& d) { return !d.soilProbes.empty(); },
+             array("soilProbes", &SensorReadingsDto::soilProbes, kSoilProbeShape))),
+    selected<kSensorsSoilProbes>(
+        when([](const SensorReadingsDto& d) { return !d.soilProbes.empty(); },
+             object("soilBus", &SensorReadingsDto::soilBus, kSoilBusShape))),
+    selected<kSensorsLevel>(object("level", &SensorReadingsDto::level, kLevelShape)),
+    selected<kSensorsPower>(
+        orNull([](const SensorReadingsDto& d) { return d.hasPower; },
+               object("power", &SensorReadingsDto::power, kPowerShape))),
+    // Clock not set: null, no bogus 1970.
+    selected<kSensorsTimestamp>(field("timestamp", [](const SensorReadingsDto& d) {
+        return d.hasTimestamp ? std::optional<int64_t>(d.timestamp) : std::nullopt;
+    })));
+
+constexpr auto kWifiShape = shape(
+    field("state", &WifiStatusDto::state),
+    field("rssi", &WifiStatusDto::rssi),
+    field("ssid", &WifiStatusDto::ssid),
+    field("connected", &WifiStatusDto::connected),
+    field("ipAcquired", &WifiStatusDto::ipAcquired),
+    field("ip", &WifiStatusDto::ip),
+    field("powerSave", &WifiStatusDto::powerSave));
+
+constexpr auto kTimeShape = shape(
+    field("synced", &TimeStatusDto::synced),
+    field("epoch", [](const TimeStatusDto& t) {
+        return t.synced ? std::optional<int64_t>(t.epoch) : std::nullopt;
+    }),
+    field("local", &TimeStatusDto::local),
+    field("lastSync", &TimeStatusDto::lastSync));
+
+constexpr auto kFirmwareShape = shape(
+    field("version", &FirmwareDto::version),
+    field("project", &FirmwareDto::project));
+
+constexpr auto kStorageWritesShape = shape(
+    field("bytesAppended", &StorageWritesDto::bytesAppended),
+    field("syncs", &StorageWritesDto::syncs),
+    field("filesCreated", &StorageWritesDto::filesCreated),
+    field("filesRemoved", &StorageWritesDto::filesRemoved),
+    field("tornRepairs", &StorageWritesDto::tornRepairs),
+    field("rotations", &StorageWritesDto::rotations),
+    field("appendUs", &StorageWritesDto::appendUs));
+
+constexpr auto kStorageShape = shape(
+    field("totalBytes", &StorageStatsDto::totalBytes),
+    field("usedBytes", &StorageStatsDto::usedBytes),
+    field("percentUsed", &StorageStatsDto::percentUsed),
+    object("writes", &StorageStatsDto::writes, kStorageWritesShape));
+
+/// `bootUs`: one key per phase (not reached = null), or null without a
+/// profile. The only member whose keys come from the data.
+void writeBootPhases(FixedJsonWriter& out, const SystemStatusDto& status)
+{
+    if (status.boot.empty()) {
+        out.null();
+        return;
+    }
+    out.raw("{");
+    bool first = true;
+    for (const BootPhaseDto& phase : status.boot) {
+        out.key(phase.name, first);
+        if (phase.atUs == 0) {
+            out.null();
+        } else {
+            out.number(phase.atUs);
+        }
+    }
+    out.raw("}");
+}
+
+constexpr auto kStatusShape = shape(
+    selected<kStatusMode>(field("mode", &SystemStatusDto::mode)),
+    selected<kStatusWifi>(object("wifi", &SystemStatusDto::wifi, kWifiShape)),
+    selected<kStatusTime>(object("time", &SystemStatusDto::time, kTimeShape)),
+    selected<kStatusUptime>(field("uptimeMs", &SystemStatusDto::uptimeMs)),
+    selected<kStatusResetReason>(field("resetReason", &SystemStatusDto::resetReason)),
+    selected<kStatusFirmware>(object("firmware", &SystemStatusDto::firmware, kFirmwareShape)),
+    selected<kStatusStorage>(object("storage", &SystemStatusDto::storage, kStorageShape)),
+    selected<kStatusBoot>(custom("bootUs", &writeBootPhases)),
+    selected<kStatusPower>(orNull([](const SystemStatusDto& s) { return s.hasPower; },
+                                  object("power", &SystemStatusDto::power, kPowerShape))));
+
+constexpr auto kPumpShape = shape(
+    field("name", &PumpDto::name),
+    field("running", &PumpDto::running),
+    field("currentRunTimeMs", &PumpDto::currentRunTimeMs),
+    field("accumulatedRunTimeMs", &PumpDto::accumulatedRunTimeMs),
+    field("lastStopReason", &PumpDto::lastStopReason));
+
+constexpr auto kPumpListShape = shape(
+    array("pumps",
+          [](const std::vector<PumpDto>& pumps) -> const std::vector<PumpDto>& {
+              return pumps;
+          },
+          kPumpShape));
+
+}  // namespace
+
+std::size_t serializeStatusInto(const SystemStatusDto& status, char* buf, std::size_t cap)
+{
+    return json::renderEnvelope(status, kStatusShape, buf, cap);
+}
+
+std::size_t serializeSensorsInto(const SensorReadingsDto& sensors, char* buf,
+                                 std::size_t cap)
+{
+    return json::renderEnvelope(sensors, kSensorsShape, buf, cap);
+}
+
+std::size_t serializePowerInto(const PowerDto& power, char* buf, std::size_t cap)
+{
+    return json::renderEnvelope(power, kPowerShape, buf, cap);
+}
+
+std::size_t serializePumpInto(const PumpDto& pump, char* buf, std::size_t cap)
+{
+    return json::renderEnvelope(pump, kPumpShape, buf, cap);
+}
+
+std::size_t serializePumpListInto(const std::vector<PumpDto>& pumps, char* buf,
+                                  std::size_t cap)
+{
+    return json::renderEnvelope(pumps, kPumpListShape, buf, cap);
+}
+
+}  // namespace api
@@ -21,41 +21,205 @@
 
 #include "api/ApiServer.h"
 
+#include <algorithm>
+#include <array>
+#include <climits>
 #include <cmath>
 #include <cstddef>
 #include <cstdint>
 #include <cstdio>
 #include <cstdlib>
 #include <cstring>
+#include <initializer_list>
+#include <memory>
+#include <new>
 #include <optional>
 #include <string>
+#include <string_view>
+#include <utility>
 #include <vector>
 
+#include <unistd.h>
+
 #include "esp_app_desc.h"
+#include "esp_heap_caps.h"
 #include "esp_http_server.h"
 #include "esp_log.h"
 #include "esp_netif.h"
+#include "esp_random.h"
 #include "esp_system.h"
+#include "esp_timer.h"
+#include "freertos/FreeRTOS.h"
+#include "freertos/queue.h"
+#include "freertos/task.h"
+#include "lwip/sockets.h"
 
+#include "api/ApiDownsample.h"
 #include "api/ApiDtos.h"
+#include "api/ApiETag.h"
 #include "api/ApiEnvelope.h"
+#include "api/ApiMetrics.h"
 #include "api/ApiRequests.h"
 #include "api/ApiRoutes.h"
 #include "api/ApiSerialize.h"
 #include "api/ApiStatic.h"
+#include "api/ApiStream.h"
+#include "api/AssetStore.h"
+#include "api/CsvExport.h"
+#include "api/Deflate.h"
+#include "api/DerivedMetrics.h"
+#include "api/EventTail.h"
+#include "api/MqttUplink.h"
+#include "api/NodeGateway.h"
+#include "api/OtaPipeline.h"
+#include "api/ReadAheadPipe.h"
+#include "api/Sha256.h"
+#include "api/StorageArchive.h"
+#include "api/SupportBundle.h"
+#include "control/PumpUsage.h"
 #include "events/EventLogger.h"
+#include "interfaces/BootProfile.h"
+#include "interfaces/EventCodec.h"
+#include "interfaces/LifetimeCounters.h"
+#include "interfaces/LogRing.h"
+#include "interfaces/MetricRegistry.h"
+#include "interfaces/LockStats.h"
+#include "interfaces/PowerLocks.h"
+#include "interfaces/TaskTelemetry.h"
+#include "interfaces/TickLatency.h"
+#include "interfaces/WatchdogFeeds.h"
+#include "interfaces/TraceBuffer.h"
 #include "network/WifiState.h"
-#include "storage/StorageMount.h"
+#include "sensors/EnergyMeter.h"
+#include "sensors/ModbusBusMaster.h"
+#include "sensors/ModbusFrameCapture.h"
+#include "sensors/PumpCurrentCapture.h"
+#include "sensors/SoilPollScheduler.h"
 #include "time/TimeService.h"
 
+// HTTPS needs the server, its session tickets and the ClientHello hook
+// (sdkconfig.net.https); a build without them ignores setTls().
+#if CONFIG_ESP_HTTPS_SERVER_ENABLE && CONFIG_ESP_TLS_SERVER_SESSION_TICKETS && \
+    CONFIG_ESP_TLS_SERVER_CERT_SELECT_HOOK
+#define WS_API_HTTPS 1
+#include "esp_https_server.h"
+#include "esp_tls.h"
+#include "mbedtls/ssl.h"
+#include "mbedtls/ssl_ciphersuites.h"
+#else
+#define WS_API_HTTPS 0
+#endif
+
 namespace api {
 
 namespace {
 
 const char* TAG = "api_server";
 
-/// Handler cap: the full /api/v1/ route set (registered below) plus headroom.
-constexpr uint16_t kMaxUriHandlers = 16;
+/// Handler cap: the six registrations in start() plus headroom. Routes
+/// are rows of the ApiRoutes table, not httpd handlers.
+constexpr uint16_t kMaxUriHandlers = 8;
+
+/// Static storage of the selftest queue (one server per firmware).
+StaticQueue_t s_selfTestQueue;
+uint8_t s_selfTestQueueStorage[sizeof(httpd_req_t*)];
+
+/// Static storage of the event-wait queue: one entry per slot, so a
+/// claimed hold always fits.
+StaticQueue_t s_eventWaitQueue;
+uint8_t s_eventWaitQueueStorage[ApiServer::kEventWaiters * sizeof(EventWait)];
+
+/// Longest the event-wait worker sleeps on the notifier while it holds
+/// requests: how soon it takes a new hold (whose read already missed any
+/// event before it) and notices the nearest deadline.
+constexpr uint32_t kEventWaitPollMs = 250;
+
+/// Bound on one self-test run: the Modbus response timeout (3 s by
+/// default) plus margin. A check still running then is reported failed.
+constexpr uint32_t kSelfTestDeadlineMs = 3500;
+
+#if WS_API_HTTPS
+/// ECDHE-ECDSA with AES-GCM only: with a P-256 key the signature's bignum
+/// work runs on the MPI engine and the record layer on the AES and SHA
+/// engines, and a browser finds a suite it offers.
+constexpr int kTlsCiphersuites[] = {
+    MBEDTLS_TLS_ECDHE_ECDSA_WITH_AES_128_GCM_SHA256,
+    MBEDTLS_TLS_ECDHE_ECDSA_WITH_AES_256_GCM_SHA384,
+    0,
+};
+
+/// TCP keep-alive of a TLS session: a peer gone without a FIN frees its
+/// session after about a minute instead of at the next LRU purge.
+constexpr int kTlsKeepAliveIdleS = 30;
+constexpr int kTlsKeepAliveIntervalS = 10;
+constexpr int kTlsKeepAliveCount = 3;
+
+/// The handshake in progress. httpd runs them one at a time on its task:
+/// the context, when its ClientHello was read, and the session ID the
+/// client offered — a resumed session echoes it, a full one does not.
+struct PendingHandshake {
+    const mbedtls_ssl_context* ssl = nullptr;
+    int64_t startUs = 0;
+    std::array<unsigned char, 32> offeredId{};
+    std::size_t offeredIdLen = 0;
+};
+PendingHandshake s_handshake;
+
+/// The HTTPS server's counters (one server per firmware), set in start().
+TlsMetrics* s_tlsMetrics = nullptr;
+
+/// esp-tls ClientHello hook: mark the start. Returns 0 to keep the
+/// configured certificate.
+int onClientHello(mbedtls_ssl_context* ssl)
+{
+    if (s_tlsMetrics == nullptr) {
+        return 0;
+    }
+    s_tlsMetrics->began();
+    s_handshake.ssl = ssl;
+    s_handshake.startUs = esp_timer_get_time();
+    const mbedtls_ssl_session* offered = ssl->MBEDTLS_PRIVATE(session_negotiate);
+    std::size_t len = offered != nullptr ? mbedtls_ssl_session_get_id_len(offered) : 0;
+    len = len < s_handshake.offeredId.size() ? len : s_handshake.offeredId.size();
+    if (len > 0) {
+        std::memcpy(s_handshake.offeredId.data(), mbedtls_ssl_session_get_id(offered), len);
+    }
+    s_handshake.offeredIdLen = len;
+    return 0;
+}
+
+/// esp_https_server session hook: a session is up (after its handshake) or
+/// closed.
+void onTlsSession(esp_https_server_user_cb_arg_t* arg)
+{
+    if (s_tlsMetrics == nullptr || arg == nullptr) {
+        return;
+    }
+    if (arg->user_cb_state == HTTPD_SSL_USER_CB_SESS_CLOSE) {
+        s_tlsMetrics->closed();
+        return;
+    }
+    if (arg->user_cb_state != HTTPD_SSL_USER_CB_SESS_CREATE) {
+        return;
+    }
+    const auto* ssl = static_cast<const mbedtls_ssl_context*>(
+        esp_tls_get_ssl_context(const_cast<esp_tls_t*>(arg->tls)));
+    bool resumed = false;
+    int64_t us = 0;
+    if (ssl != nullptr && ssl == s_handshake.ssl) {
+        // A full handshake answers with an empty ID (a new ticket follows)
+        // or a fresh random one; a resumed one echoes the client's.
+        const mbedtls_ssl_session* session = ssl->MBEDTLS_PRIVATE(session);
+        resumed = session != nullptr && s_handshake.offeredIdLen > 0 &&
+                  mbedtls_ssl_session_get_id_len(session) == s_handshake.offeredIdLen &&
+                  std::memcmp(mbedtls_ssl_session_get_id(session),
+                              s_handshake.offeredId.data(), s_handshake.offeredIdLen) == 0;
+        us = esp_timer_get_time() - s_handshake.startUs;
+    }
+    s_handshake.ssl = nullptr;
+    s_tlsMetrics->completed(resumed, us);
+}
+#endif
 
 /// WifiState -> stable lowercase word for the status DTO (matches the diag
 /// console `wifi` vocabulary). Total over the enum.
@@ -87,14 +251,338 @@ bool cachedValid(int lastError, float primaryValue)
     return lastError == 0 && std::isfinite(primaryValue);
 }
 
-/// Send a ready JSON body with the HTTP status line mapped from @p status.
+/// One soil sensor's cached reading. Until its first good read the values
+/// are NaN placeholders and `valid` is false. NPK channels are
+/// present-flagged: emitted only when the sensor reported a non-negative
+/// value.
+SoilDto soilDto(ISoilSensor& soil)
+{
+    // One snapshot(): all fields from the same read, no per-getter lock.
+    const SoilSnapshot snap = soil.snapshot();
+    SoilDto dto;
+    dto.moisture = snap.moisture;
+    dto.temperature = snap.temperature;
+    dto.humidity = snap.humidity;
+    dto.ph = snap.ph;
+    dto.ec = snap.ec;
+    dto.valid = cachedValid(snap.lastError, dto.moisture);
+    dto.hasNitrogen = std::isfinite(snap.nitrogen) && snap.nitrogen >= 0.0f;
+    dto.nitrogen = snap.nitrogen;
+    dto.hasPhosphorus =
+        std::isfinite(snap.phosphorus) && snap.phosphorus >= 0.0f;
+    dto.phosphorus = snap.phosphorus;
+    dto.hasPotassium = std::isfinite(snap.potassium) && snap.potassium >= 0.0f;
+    dto.potassium = snap.potassium;
+    return dto;
+}
+
+/// What the request being answered has sent, for the route metrics
+/// (ApiMetrics.h). Per task: the httpd task and the selftest worker each
+/// answer one request at a time, and only the timing wrappers set it.
+struct RequestTally {
+    int status = 0;  ///< 0 until a status line is chosen
+    uint64_t bytes = 0;
+};
+thread_local RequestTally* tTally = nullptr;
+
+void noteStatus(int status)
+{
+    if (tTally != nullptr) {
+        tTally->status = status;
+    }
+}
+
+void noteBytes(size_t bytes)
+{
+    if (tTally != nullptr) {
+        tTally->bytes += bytes;
+    }
+}
+
+/// Smallest ready body worth compressing: below it the gzip framing and
+/// the encoder's setup cost more airtime and CPU than they save.
+constexpr size_t kCompressMinBytes = 1024;
+
+/// Accept-Encoding cap; the codings we know come first in every browser.
+constexpr size_t kMaxAcceptEncodingLen = 96;
+
+/// What the request's Accept-Encoding lets us compress with (Deflate.h).
+ContentEncoding acceptedEncoding(httpd_req_t* req)
+{
+    if (httpd_req_get_hdr_value_len(req, "Accept-Encoding") == 0) {
+        return ContentEncoding::Identity;
+    }
+    char buf[kMaxAcceptEncodingLen];
+    const esp_err_t err = httpd_req_get_hdr_value_str(req, "Accept-Encoding", buf, sizeof buf);
+    if (err != ESP_OK && err != ESP_ERR_HTTPD_RESULT_TRUNC) {
+        return ContentEncoding::Identity;
+    }
+    return selectContentEncoding(buf);
+}
+
+/// Chunked-transfer sink over one request. The content type, the status
+/// line and any Content-Encoding go out with the first chunk, so a response
+/// that fails before producing any byte can still be sent as a plain JSON
+/// error.
+class HttpdChunkSink final : public IChunkSink {
+public:
+    HttpdChunkSink(httpd_req_t* req, const char* contentType,
+                   ContentEncoding encoding = ContentEncoding::Identity,
+                   ApiStatus status = ApiStatus::Ok)
+        : req_(req), contentType_(contentType), encoding_(encoding), status_(status)
+    {
+    }
+
+    bool send(const char* data, std::size_t len) override
+    {
+        if (!started_) {
+            httpd_resp_set_type(req_, contentType_);
+            httpd_resp_set_status(req_, statusLine(status_));
+            if (encoding_ != ContentEncoding::Identity) {
+                httpd_resp_set_hdr(req_, "Content-Encoding", contentEncodingName(encoding_));
+                httpd_resp_set_hdr(req_, "Vary", "Accept-Encoding");
+            }
+            noteStatus(static_cast<int>(status_));
+            started_ = true;
+        }
+        if (httpd_resp_send_chunk(req_, data, static_cast<ssize_t>(len)) != ESP_OK) {
+            return false;
+        }
+        noteBytes(len);
+        return true;
+    }
+
+    bool started() const { return started_; }
+
+private:
+    httpd_req_t* req_;
+    const char* contentType_;
+    ContentEncoding encoding_;
+    ApiStatus status_;
+    bool started_ = false;
+};
+
+/// A DeflateSink for @p out when the client takes @p encoding, else null
+/// (identity asked for, or no heap for the encoder — the body then goes
+/// out uncompressed). Heap, not stack: the encoder is bigger than the
+/// httpd task's stack allows.
+std::unique_ptr<DeflateSink> makeDeflate(IChunkSink& out, ContentEncoding encoding)
+{
+    if (encoding == ContentEncoding::Identity) {
+        return nullptr;
+    }
+    return std::unique_ptr<DeflateSink>(new (std::nothrow) DeflateSink(out, encoding));
+}
+
+/// Stack buffer for the fixed-shape bodies (api/JsonTemplate.h): a
+/// worst-case /status (every boot phase, a 32-byte SSID) is about 1 KiB.
+constexpr std::size_t kFixedBodyBytes = 1280;
+
+/// @p dto rendered by its compile-time template (no cJSON tree, no heap
+/// but the returned string), or by the cJSON serializer when it outgrew
+/// the buffer. Both give the same bytes.
+template <typename Dto>
+std::string renderBody(const Dto& dto, std::size_t (*into)(const Dto&, char*, std::size_t),
+                       std::string (*fallback)(const Dto&))
+{
+    char buf[kFixedBodyBytes];
+    const std::size_t n = into(dto, buf, sizeof(buf));
+    return n > 0 ? std::string(buf, n) : fallback(dto);
+}
+
+/// One response header of sendHead(); a null value is left out.
+struct HeaderField {
+    const char* name;
+    const char* value;
+};
+
+/// The answer to a HEAD: the status line and the headers the GET would
+/// carry, its Content-Length of @p length included, and no body.
+/// httpd_resp_send() writes a Content-Length of its own buffer and the
+/// buffer with it, so the head goes out raw; headers queued with
+/// httpd_resp_set_hdr() are not in it, which is why @p fields repeats them.
+esp_err_t sendHead(httpd_req_t* req, ApiStatus status, const char* contentType,
+                   uint64_t length, std::initializer_list<HeaderField> fields = {})
+{
+    std::string head = "HTTP/1.1 ";
+    head += statusLine(status);
+    head += "\r\nContent-Type: ";
+    head += contentType;
+    head += "\r\n";
+    for (const HeaderField& field : fields) {
+        if (field.value != nullptr) {
+            head += field.name;
+            head += ": ";
+            head += field.value;
+            head += "\r\n";
+        }
+    }
+    char line[40];
+    std::snprintf(line, sizeof(line), "Content-Length: %llu\r\n\r\n",
+                  static_cast<unsigned long long>(length));
+    head += line;
+    noteStatus(static_cast<int>(status));
+    const int sent = httpd_send(req, head.data(), head.size());
+    return sent == static_cast<int>(head.size()) ? ESP_OK : ESP_FAIL;
+}
+
+/// Send a ready JSON body with the HTTP status line mapped from @p status,
+/// compressed (chunked) when it is large and the client accepts a coding.
+/// A HEAD gets the head of the identity body.
 esp_err_t sendJson(httpd_req_t* req, ApiStatus status, const std::string& body)
 {
+    if (req->method == HTTP_HEAD) {
+        return sendHead(req, status, "application/json", body.size());
+    }
+    const ContentEncoding encoding =
+        body.size() >= kCompressMinBytes ? acceptedEncoding(req) : ContentEncoding::Identity;
+    if (encoding != ContentEncoding::Identity) {
+        HttpdChunkSink sink(req, "application/json", encoding, status);
+        if (std::unique_ptr<DeflateSink> deflate = makeDeflate(sink, encoding)) {
+            if (!deflate->send(body.data(), body.size()) || !deflate->finish()) {
+                return ESP_FAIL;
+            }
+            return httpd_resp_send_chunk(req, nullptr, 0);
+        }
+    }
     httpd_resp_set_type(req, "application/json");
     httpd_resp_set_status(req, statusLine(status));
+    noteStatus(static_cast<int>(status));
+    noteBytes(body.size());
     return httpd_resp_sendstr(req, body.c_str());
 }
 
+/// If-None-Match cap: one or two of our 18-byte tags plus slack. A longer
+/// value is not parsed — the client just gets the full body.
+constexpr size_t kMaxIfNoneMatchLen = 96;
+
+/// True when the request's If-None-Match names @p etag.
+bool clientHoldsETag(httpd_req_t* req, const std::string& etag)
+{
+    const size_t len = httpd_req_get_hdr_value_len(req, "If-None-Match");
+    if (len == 0 || len >= kMaxIfNoneMatchLen) {
+        return false;
+    }
+    char buf[kMaxIfNoneMatchLen];
+    if (httpd_req_get_hdr_value_str(req, "If-None-Match", buf, sizeof buf) != ESP_OK) {
+        return false;
+    }
+    return ifNoneMatchHits(buf, etag);
+}
+
+/// Attach @p etag to the response; no-cache makes the browser revalidate
+/// every poll instead of reusing its copy heuristically. httpd keeps the
+/// pointer, so @p etag must outlive the send.
+void setETag(httpd_req_t* req, const std::string& etag)
+{
+    httpd_resp_set_hdr(req, "ETag", etag.c_str());
+    httpd_resp_set_hdr(req, "Cache-Control", "no-cache");
+}
+
+/// Range header cap: one `bytes=first-last` fits with room to spare; a
+/// longer value (a list of ranges) is served whole anyway.
+constexpr size_t kMaxRangeLen = 64;
+
+/**
+ * How the request's Range header applies to a @p size-byte body whose
+ * validator is @p etag (empty for a generated body, which has none). An
+ * If-Range that does not hold — any If-Range without a validator — asks
+ * for the whole body.
+ */
+RangeRequest requestedRange(httpd_req_t* req, uint64_t size, const std::string& etag,
+                            ByteRange& range)
+{
+    const size_t len = httpd_req_get_hdr_value_len(req, "Range");
+    if (len == 0 || len >= kMaxRangeLen) {
+        return RangeRequest::Whole;
+    }
+    char buf[kMaxRangeLen];
+    if (httpd_req_get_hdr_value_str(req, "Range", buf, sizeof buf) != ESP_OK) {
+        return RangeRequest::Whole;
+    }
+    const size_t condLen = httpd_req_get_hdr_value_len(req, "If-Range");
+    if (condLen > 0) {
+        char cond[kMaxIfNoneMatchLen];
+        if (condLen >= sizeof cond ||
+            httpd_req_get_hdr_value_str(req, "If-Range", cond, sizeof cond) != ESP_OK ||
+            !ifRangeHolds(cond, etag)) {
+            return RangeRequest::Whole;
+        }
+    }
+    return resolveByteRange(buf, size, range);
+}
+
+/// The 416 for a Range past the end of a @p size-byte body: the JSON
+/// error, with the size in Content-Range so the client can start over.
+esp_err_t sendRangeNotSatisfiable(httpd_req_t* req, uint64_t size)
+{
+    const std::string range = unsatisfiedRange(size);
+    const std::string body = errorBody("range not satisfiable");
+    if (req->method == HTTP_HEAD) {
+        return sendHead(req, ApiStatus::RangeNotSatisfiable, "application/json",
+                        body.size(), {{"Content-Range", range.c_str()}});
+    }
+    httpd_resp_set_hdr(req, "Content-Range", range.c_str());
+    return sendJson(req, ApiStatus::RangeNotSatisfiable, body);
+}
+
+/// The bodiless 304 for a client that already holds @p etag.
+esp_err_t sendNotModified(httpd_req_t* req, const std::string& etag)
+{
+    setETag(req, etag);
+    httpd_resp_set_status(req, statusLine(ApiStatus::NotModified));
+    noteStatus(static_cast<int>(ApiStatus::NotModified));
+    return httpd_resp_send(req, nullptr, 0);
+}
+
+/// URL-query buffer cap: the v1 query strings are a few short key=value pairs;
+/// a longer query is truncated to this bound (no unbounded stack allocation).
+constexpr size_t kMaxQueryLen = 256;
+
+/// Per-value cap for a single query parameter (metric names / short ints;
+/// a /history `metric` list of up to kHistoryMaxMetrics names).
+constexpr size_t kMaxQueryValueLen = 160;
+
+/// Accept header cap for the /history format negotiation (the head is kept).
+constexpr size_t kMaxAcceptLen = 128;
+
+/// The request's URL query, fetched once into a stack buffer; each lookup
+/// views into it (findQueryValue) instead of copying the value out.
+class RequestQuery {
+public:
+    explicit RequestQuery(httpd_req_t* req)
+    {
+        size_t qlen = httpd_req_get_url_query_len(req) + 1;
+        if (qlen <= 1) {
+            return;  // no query string
+        }
+        if (qlen > kMaxQueryLen) {
+            qlen = kMaxQueryLen;
+        }
+        if (httpd_req_get_url_query_str(req, buf_, qlen) == ESP_OK) {
+            len_ = std::strlen(buf_);
+        }
+    }
+
+    /// True when @p key is present, @p out viewing its value; false when
+    /// there is no query string, the key is absent, or the value is longer
+    /// than kMaxQueryValueLen allows.
+    bool get(const char* key, std::string_view& out) const
+    {
+        std::string_view value;
+        if (!findQueryValue(std::string_view(buf_, len_), key, value) ||
+            value.size() >= kMaxQueryValueLen) {
+            return false;
+        }
+        out = value;
+        return true;
+    }
+
+private:
+    char buf_[kMaxQueryLen] = {};
+    size_t len_ = 0;
+};
+
 /// Recover the ApiServer from the request; null-guarded (500 on misconfig).
 ApiServer* self(httpd_req_t* req)
 {
@@ -108,7 +596,18 @@ esp_err_t statusHandler(httpd_req_t* req)
         return sendJson(req, ApiStatus::InternalError,
                         errorBody("server misconfigured"));
     }
-    return sendJson(req, ApiStatus::Ok, server->buildStatusBody());
+    // `fields` reads and renders only the members it names; a malformed
+    // one is a 400.
+    const RequestQuery params(req);
+    std::string_view value;
+    if (params.get("fields", value)) {
+        FieldSelection selection;
+        if (!parseStatusFields(value, selection)) {
+            return sendJson(req, ApiStatus::BadRequest, errorBody("invalid fields"));
+        }
+        return sendJson(req, ApiStatus::Ok, server->statusBody(selection));
+    }
+    return sendJson(req, ApiStatus::Ok, server->statusBody());
 }
 
 esp_err_t sensorsHandler(httpd_req_t* req)
@@ -118,7 +617,36 @@ esp_err_t sensorsHandler(httpd_req_t* req)
         return sendJson(req, ApiStatus::InternalError,
                         errorBody("server misconfigured"));
     }
-    return sendJson(req, ApiStatus::Ok, server->buildSensorsBody());
+    // A projection skips the cache and the ETag: it is small, and reads
+    // only the getters it names.
+    const RequestQuery params(req);
+    std::string_view value;
+    if (params.get("fields", value)) {
+        FieldSelection selection;
+        if (!parseSensorsFields(value, selection)) {
+            return sendJson(req, ApiStatus::BadRequest, errorBody("invalid fields"));
+        }
+        return sendJson(req, ApiStatus::Ok, server->sensorsBody(selection));
+    }
+    // A cached body brings its tag, so a burst (or a conditional poll) in
+    // the max age touches no sensor getter.
+    std::string body;
+    std::string etag;
+    const bool cached = server->cachedSensors(body, etag);
+    SensorReadingsDto readings;
+    if (!cached) {
+        readings = server->readSensors();
+        etag = server->sensorsETag(readings);
+    }
+    if (clientHoldsETag(req, etag)) {
+        return sendNotModified(req, etag);
+    }
+    if (!cached) {
+        body = renderBody(readings, &serializeSensorsInto, &serializeSensors);
+        server->cacheSensors(body, etag);
+    }
+    setETag(req, etag);
+    return sendJson(req, ApiStatus::Ok, body);
 }
 
 esp_err_t powerHandler(httpd_req_t* req)
@@ -131,53 +659,188 @@ esp_err_t powerHandler(httpd_req_t* req)
     return sendJson(req, ApiStatus::Ok, server->buildPowerBody());
 }
 
+// Drain the pump current ring as the binary capture body (ApiStream.h). The
+// httpd task is the ring's only consumer; 404 where no capture is wired
+// (rev1, or CONFIG_WS_INA226_CAPTURE off).
+esp_err_t powerCaptureHandler(httpd_req_t* req)
+{
+    ApiServer* server = self(req);
+    if (server == nullptr) {
+        return sendJson(req, ApiStatus::InternalError,
+                        errorBody("server misconfigured"));
+    }
+    PumpCurrentCapture* capture = server->powerCapture();
+    if (capture == nullptr) {
+        return sendJson(req, ApiStatus::NotFound,
+                        errorBody("power capture not enabled"));
+    }
+    HttpdChunkSink sink(req, "application/octet-stream");
+    if (!streamPowerCapture(*capture, sink)) {
+        ESP_LOGE(TAG, "power capture stream aborted");
+        return ESP_FAIL;
+    }
+    return httpd_resp_send_chunk(req, nullptr, 0);
+}
+
 // Serve a gzipped static asset from littlefs. Registered as the GET /* catch-all
 // AFTER the exact /api/v1/ routes, so those match first; any other GET falls
 // here. Assets are stored pre-gzipped at <base>/<path>.gz (feature 010). File
 // I/O only, off the watering buses (same isolation class as history/events).
+// Each asset carries its build-time ETag (AssetCache.h): a revalidation is a
+// bodiless 304, and a small asset is read from flash once, then sent from RAM.
+// HEAD /* lands here too. The length is the file's (or the cached body's),
+// never read for it, and a Range maps straight onto file offsets: a resumed
+// download sends only the bytes it is missing.
 esp_err_t staticFileHandler(httpd_req_t* req)
 {
+    ApiServer* server = self(req);
+    if (server == nullptr) {
+        return sendJson(req, ApiStatus::InternalError,
+                        errorBody("server misconfigured"));
+    }
     const std::optional<std::string> rel = sanitizeAssetPath(req->uri);
-    if (!rel.has_value()) {
+    if (!rel.has_value() || server->assets() == nullptr) {
         return sendJson(req, ApiStatus::NotFound, errorBody("not found"));
     }
-    const std::string full =
-        std::string(StorageMount::kBasePath) + "/" + *rel + ".gz";
-    FILE* f = std::fopen(full.c_str(), "rb");
-    if (f == nullptr) {
-        return sendJson(req, ApiStatus::NotFound, errorBody("not found"));
+    AssetCache& assets = server->assets()->cache();
+    const std::string etag = assets.etagFor(*rel);
+    std::shared_ptr<const std::string> cached = assets.find(*rel);
+    const std::string full = server->assets()->basePath() + "/" + *rel + ".gz";
+    FILE* f = nullptr;
+    if (cached == nullptr) {
+        f = std::fopen(full.c_str(), "rb");
+        if (f == nullptr) {
+            return sendJson(req, ApiStatus::NotFound, errorBody("not found"));
+        }
+        // Reads are whole-body or chunk-sized: straight from the VFS into
+        // the caller's buffer, not through stdio's.
+        std::setvbuf(f, nullptr, _IONBF, 0);
     }
-    httpd_resp_set_type(req, contentTypeForPath(*rel));
-    httpd_resp_set_hdr(req, "Content-Encoding", "gzip");
     // The HTML shell must always revalidate so a frontend-changing OTA (PR-13)
-    // is picked up immediately; static libs stay cached for an hour.
+    // is picked up immediately; static libs stay cached for an hour. A 304
+    // repeats both headers, so it does not go through setETag (no-cache).
     const bool isHtml =
         rel->size() >= 5 && rel->compare(rel->size() - 5, 5, ".html") == 0;
-    httpd_resp_set_hdr(req, "Cache-Control",
-                       isHtml ? "no-cache" : "max-age=3600");
-    char buf[1024];
-    size_t n;
-    esp_err_t sendErr = ESP_OK;
-    while ((n = std::fread(buf, 1, sizeof(buf), f)) > 0) {
-        sendErr = httpd_resp_send_chunk(req, buf, n);
-        if (sendErr != ESP_OK) {
-            break;
-        }
-    }
-    // std::fread returns 0 on BOTH EOF and a read error, so a mid-file
-    // littlefs failure would otherwise exit the loop with sendErr == ESP_OK.
-    // Capture ferror before fclose; on a read error return ESP_FAIL WITHOUT
-    // the terminating empty chunk, so the client sees a broken connection
-    // rather than a bogus "complete" (truncated) gzip body.
-    const bool readError = (std::ferror(f) != 0);
+    const char* cacheControl = isHtml ? "no-cache" : "max-age=3600";
+    httpd_resp_set_hdr(req, "Cache-Control", cacheControl);
+    if (!etag.empty()) {
+        httpd_resp_set_hdr(req, "ETag", etag.c_str());
+        if (clientHoldsETag(req, etag)) {
+            if (f != nullptr) {
+                std::fclose(f);
+            }
+            httpd_resp_set_status(req, statusLine(ApiStatus::NotModified));
+            noteStatus(static_cast<int>(ApiStatus::NotModified));
+            return httpd_resp_send(req, nullptr, 0);
+        }
+    }
+
+    // The length from the directory entry, not from reading the file.
+    uint64_t size = 0;
+    if (cached != nullptr) {
+        size = cached->size();
+    } else {
+        const long end = std::fseek(f, 0, SEEK_END) == 0 ? std::ftell(f) : -1L;
+        if (end < 0) {
+            std::fclose(f);
+            ESP_LOGE(TAG, "cannot size %s", full.c_str());
+            return sendJson(req, ApiStatus::InternalError,
+                            errorBody("asset read failed"));
+        }
+        size = static_cast<uint64_t>(end);
+        std::rewind(f);
+    }
+    ByteRange range{0, size};
+    const RangeRequest ranged = requestedRange(req, size, etag, range);
+    if (ranged == RangeRequest::Unsatisfiable) {
+        if (f != nullptr) {
+            std::fclose(f);
+        }
+        return sendRangeNotSatisfiable(req, size);
+    }
+    const bool partial = ranged == RangeRequest::Partial;
+    const ApiStatus status = partial ? ApiStatus::PartialContent : ApiStatus::Ok;
+    const std::string contentRangeValue = partial ? contentRange(range, size) : std::string();
+    const char* type = contentTypeForPath(*rel);
+    if (req->method == HTTP_HEAD) {
+        if (f != nullptr) {
+            std::fclose(f);
+        }
+        return sendHead(req, status, type, range.length,
+                        {{"Content-Encoding", "gzip"},
+                         {"Accept-Ranges", "bytes"},
+                         {"Cache-Control", cacheControl},
+                         {"ETag", etag.empty() ? nullptr : etag.c_str()},
+                         {"Content-Range", partial ? contentRangeValue.c_str() : nullptr}});
+    }
+    httpd_resp_set_type(req, type);
+    httpd_resp_set_hdr(req, "Content-Encoding", "gzip");
+    httpd_resp_set_hdr(req, "Accept-Ranges", "bytes");
+    if (partial) {
+        httpd_resp_set_hdr(req, "Content-Range", contentRangeValue.c_str());
+    }
+    if (cached != nullptr) {
+        httpd_resp_set_status(req, statusLine(status));
+        noteStatus(static_cast<int>(status));
+        noteBytes(range.length);
+        return httpd_resp_send(req, cached->data() + range.first,
+                               static_cast<ssize_t>(range.length));
+    }
+
+    // A file that fits the cache budget is read whole, kept and sent (the
+    // range of it) in one go; a larger one streams in chunks.
+    if (size > 0 && assets.fits(static_cast<size_t>(size))) {
+        std::string body(static_cast<size_t>(size), '\0');
+        const size_t got = std::fread(&body[0], 1, body.size(), f);
+        std::fclose(f);
+        if (got != body.size()) {
+            // Nothing is sent yet, so the client can still get a proper error.
+            ESP_LOGE(TAG, "read error loading %s", full.c_str());
+            return sendJson(req, ApiStatus::InternalError,
+                            errorBody("asset read failed"));
+        }
+        httpd_resp_set_status(req, statusLine(status));
+        noteStatus(static_cast<int>(status));
+        noteBytes(range.length);
+        const esp_err_t err = httpd_resp_send(req, body.data() + range.first,
+                                              static_cast<ssize_t>(range.length));
+        assets.insert(*rel, std::move(body));
+        return err;
+    }
+
+    // Chunked, from the range's first byte for its length. With the
+    // read-ahead pipe its reader task reads the next chunk while this one
+    // goes out, so the transfer runs at the slower of flash and Wi-Fi;
+    // without it (or while it serves another body) each chunk is read,
+    // then sent, here.
+    if (range.first > 0 &&
+        std::fseek(f, static_cast<long>(range.first), SEEK_SET) != 0) {
+        std::fclose(f);
+        ESP_LOGE(TAG, "cannot seek %s", full.c_str());
+        return sendJson(req, ApiStatus::InternalError, errorBody("asset read failed"));
+    }
+    HttpdChunkSink sink(req, type, ContentEncoding::Identity, status);
+    FileChunkSource source(f, range.length);
+    uint8_t buf[1024];
+    ReadAheadPipe* pipe = server->readAhead();
+    const PumpOutcome outcome = pipe != nullptr
+                                    ? pipe->pump(source, sink, buf, sizeof(buf))
+                                    : copyChunks(source, sink, buf, sizeof(buf));
     std::fclose(f);
-    if (sendErr != ESP_OK) {
-        return sendErr;
+    // On a read error (fread's 0 at EOF and on failure told apart by
+    // ferror) end WITHOUT the terminating empty chunk, so the client sees
+    // a broken connection rather than a bogus "complete" (truncated) gzip
+    // body.
+    if (outcome == PumpOutcome::SendFailed) {
+        return ESP_FAIL;
     }
-    if (readError) {
+    if (outcome == PumpOutcome::ReadFailed) {
         ESP_LOGE(TAG, "read error streaming %s (truncated)", full.c_str());
         return ESP_FAIL;
     }
+    if (!sink.started()) {
+        noteStatus(static_cast<int>(status));  // an empty asset
+    }
     return httpd_resp_send_chunk(req, nullptr, 0);
 }
 
@@ -199,7 +862,10 @@ esp_err_t methodNotAllowedHandler(httpd_req_t* req, httpd_err_code_t /*error*/)
 {
     httpd_resp_set_type(req, "application/json");
     httpd_resp_set_status(req, "405 Method Not Allowed");
-    return httpd_resp_sendstr(req, errorBody("method not allowed").c_str());
+    const std::string body = errorBody("method not allowed");
+    noteStatus(405);
+    noteBytes(body.size());
+    return httpd_resp_sendstr(req, body.c_str());
 }
 
 /// POST body cap: pump/config bodies are a handful of small fields; anything
@@ -218,6 +884,8 @@ const char* stopReasonName(StopReason reason)
         return "duration_elapsed";
     case StopReason::MaxRuntimeForced:
         return "max_runtime_forced";
+    case StopReason::VolumeReached:
+        return "volume_reached";
     case StopReason::None:
         return "none";
     }
@@ -239,16 +907,18 @@ PumpDto makePumpDto(IWaterPump& pump)
     return dto;
 }
 
-/// Read the whole request body into @p out with a hard cap (kMaxBodyLen).
-/// Returns true on success; on false, @p err carries the reason (an over-cap
-/// body or a socket receive error) — both map to a 400 by the caller.
-bool readRequestBody(httpd_req_t* req, std::string& out, std::string& err)
+/// Receive the whole request body into the caller's @p buf (kMaxBodyLen
+/// bytes, on the handler's stack) and view it through @p out — the parsers
+/// read it in place. Returns true on success; on false, @p err carries the
+/// reason (an over-cap body or a socket receive error) — both map to a 400 by
+/// the caller.
+bool readRequestBody(httpd_req_t* req, char (&buf)[kMaxBodyLen], std::string_view& out,
+                     const char*& err)
 {
     if (req->content_len >= kMaxBodyLen) {
         err = "request body too large";
         return false;
     }
-    char buf[kMaxBodyLen];
     int total = 0;
     int r;
     while ((r = httpd_req_recv(req, buf + total, sizeof(buf) - 1 - total)) > 0) {
@@ -258,8 +928,7 @@ bool readRequestBody(httpd_req_t* req, std::string& out, std::string& err)
         err = "request body read error";
         return false;
     }
-    buf[total] = '\0';
-    out.assign(buf, static_cast<size_t>(total));
+    out = std::string_view(buf, static_cast<size_t>(total));
     return true;
 }
 
@@ -270,7 +939,14 @@ esp_err_t pumpsListHandler(httpd_req_t* req)
         return sendJson(req, ApiStatus::InternalError,
                         errorBody("server misconfigured"));
     }
-    return sendJson(req, ApiStatus::Ok, server->buildPumpsBody());
+    const std::vector<PumpDto> pumps = server->readPumps();
+    const std::string etag = server->pumpsETag(pumps);
+    if (clientHoldsETag(req, etag)) {
+        return sendNotModified(req, etag);
+    }
+    setETag(req, etag);
+    return sendJson(req, ApiStatus::Ok,
+                    renderBody(pumps, &serializePumpListInto, &serializePumpList));
 }
 
 esp_err_t pumpCommandHandler(httpd_req_t* req)
@@ -296,9 +972,10 @@ esp_err_t pumpCommandHandler(httpd_req_t* req)
         name = uri.substr(prefixLen);
     }
 
-    std::string body;
-    std::string readErr;
-    if (!readRequestBody(req, body, readErr)) {
+    char buf[kMaxBodyLen];
+    std::string_view body;
+    const char* readErr = nullptr;
+    if (!readRequestBody(req, buf, body, readErr)) {
         return sendJson(req, ApiStatus::BadRequest, errorBody(readErr));
     }
 
@@ -306,6 +983,27 @@ esp_err_t pumpCommandHandler(httpd_req_t* req)
     return sendJson(req, resp.status, resp.body);
 }
 
+esp_err_t pumpUsageHandler(httpd_req_t* req)
+{
+    ApiServer* server = self(req);
+    if (server == nullptr) {
+        return sendJson(req, ApiStatus::InternalError,
+                        errorBody("server misconfigured"));
+    }
+    // The route matched `<prefix><name>/usage`, so the name is what lies
+    // between the two (query string dropped first).
+    std::string_view uri(req->uri);
+    uri = uri.substr(0, uri.find('?'));
+    const std::size_t prefixLen = std::strlen(kPumpCommandPrefix);
+    const std::size_t suffixLen = std::strlen(kPumpUsageSuffix);
+    std::string_view name;
+    if (uri.size() > prefixLen + suffixLen) {
+        name = uri.substr(prefixLen, uri.size() - prefixLen - suffixLen);
+    }
+    const ApiResponse resp = server->buildPumpUsageResponse(name);
+    return sendJson(req, resp.status, resp.body);
+}
+
 esp_err_t configGetHandler(httpd_req_t* req)
 {
     ApiServer* server = self(req);
@@ -313,7 +1011,12 @@ esp_err_t configGetHandler(httpd_req_t* req)
         return sendJson(req, ApiStatus::InternalError,
                         errorBody("server misconfigured"));
     }
-    return sendJson(req, ApiStatus::Ok, server->buildConfigBody());
+    const std::string etag = server->configETag();
+    if (clientHoldsETag(req, etag)) {
+        return sendNotModified(req, etag);
+    }
+    setETag(req, etag);
+    return sendJson(req, ApiStatus::Ok, server->configBody());
 }
 
 esp_err_t configSetHandler(httpd_req_t* req)
@@ -324,9 +1027,10 @@ esp_err_t configSetHandler(httpd_req_t* req)
                         errorBody("server misconfigured"));
     }
 
-    std::string body;
-    std::string readErr;
-    if (!readRequestBody(req, body, readErr)) {
+    char buf[kMaxBodyLen];
+    std::string_view body;
+    const char* readErr = nullptr;
+    if (!readRequestBody(req, buf, body, readErr)) {
         return sendJson(req, ApiStatus::BadRequest, errorBody(readErr));
     }
 
@@ -334,72 +1038,113 @@ esp_err_t configSetHandler(httpd_req_t* req)
     return sendJson(req, resp.status, resp.body);
 }
 
-/// URL-query buffer cap: the v1 query strings are a few short key=value pairs;
-/// a longer query is truncated to this bound (no unbounded stack allocation).
-constexpr size_t kMaxQueryLen = 256;
-
-/// Per-value cap for a single query parameter (metric names / short ints).
-constexpr size_t kMaxQueryValueLen = 64;
-
-/// Read one URL query parameter into @p out. Returns true when @p key is
-/// present (its decoded value copied to @p out), false when there is no query
-/// string, the key is absent, or the value overflows the value buffer.
-bool queryParam(httpd_req_t* req, const char* key, std::string& out)
+/// Parse a base-10 epoch string into @p out; returns true only on a fully
+/// consumed, non-negative value (a malformed value leaves @p out untouched).
+bool parseEpoch(std::string_view s, int64_t& out)
 {
-    size_t qlen = httpd_req_get_url_query_len(req) + 1;
-    if (qlen <= 1) {
-        return false;  // no query string
-    }
-    if (qlen > kMaxQueryLen) {
-        qlen = kMaxQueryLen;
-    }
-    char q[kMaxQueryLen];
-    if (httpd_req_get_url_query_str(req, q, qlen) != ESP_OK) {
+    // 18 digits cannot overflow int64.
+    if (s.empty() || s.size() > 18) {
         return false;
     }
-    char val[kMaxQueryValueLen];
-    if (httpd_query_key_value(q, key, val, sizeof val) != ESP_OK) {
-        return false;
+    int64_t v = 0;
+    for (const char c : s) {
+        if (c < '0' || c > '9') {
+            return false;
+        }
+        v = v * 10 + (c - '0');
     }
-    out.assign(val);
+    out = v;
     return true;
 }
 
-/// Parse a base-10 epoch string into @p out; returns true only on a fully
-/// consumed, non-negative value (a malformed value leaves @p out untouched).
-bool parseEpoch(const std::string& s, int64_t& out)
+/// Extract the /history and /history/stats query parameters; validation and
+/// window resolution live in the builders so the handlers stay thin. False
+/// with the 400 message in @p error for a present-but-unparseable start/end.
+bool readHistoryQuery(httpd_req_t* req, HistoryQuery& query, const char*& error)
 {
-    if (s.empty()) {
+    const RequestQuery params(req);
+    std::string_view value;
+    if (params.get("metric", value)) {
+        query.metric = std::string(value);
+    }
+    if (params.get("reading", value)) {
+        query.reading = std::string(value);
+    }
+    if (params.get("range", value)) {
+        query.range = std::string(value);
+    }
+    // A present-but-unparseable start/end is a client error (400), not a silent
+    // default; an absent parameter simply stays unset (default window).
+    int64_t epoch = 0;
+    if (params.get("start", value)) {
+        if (!parseEpoch(value, epoch)) {
+            error = "invalid start";
+            return false;
+        }
+        query.start = epoch;
+    }
+    if (params.get("end", value)) {
+        if (!parseEpoch(value, epoch)) {
+            error = "invalid end";
+            return false;
+        }
+        query.end = epoch;
+    }
+    // Body format (/history only): `format=` wins over the Accept header.
+    std::optional<std::string> format;
+    if (params.get("format", value)) {
+        format = std::string(value);
+    }
+    // A browser Accept line can be long; its head is enough to spot
+    // application/octet-stream from a scraper (a truncated copy is kept).
+    std::optional<std::string> accept;
+    if (httpd_req_get_hdr_value_len(req, "Accept") > 0) {
+        char buf[kMaxAcceptLen];
+        const esp_err_t err =
+            httpd_req_get_hdr_value_str(req, "Accept", buf, sizeof buf);
+        if (err == ESP_OK || err == ESP_ERR_HTTPD_RESULT_TRUNC) {
+            accept = std::string(buf);
+        }
+    }
+    if (!selectHistoryFormat(format, accept, query.format)) {
+        error = "unknown format";
         return false;
     }
-    char* end = nullptr;
-    const long long v = std::strtoll(s.c_str(), &end, 10);
-    if (end == s.c_str() || *end != '\0' || v < 0) {
+    // Point budget and reducer (/history only).
+    if (params.get("maxPoints", value)) {
+        if (!parseEpoch(value, epoch) || epoch > UINT32_MAX) {
+            error = "invalid maxPoints";
+            return false;
+        }
+        query.maxPoints = static_cast<uint32_t>(epoch);
+    }
+    if (params.get("agg", value) &&
+        !parseHistoryAggregate(value, query.aggregate)) {
+        error = "unknown agg";
         return false;
     }
-    out = static_cast<int64_t>(v);
-    return true;
-}
-
-/// Map a stored event category id to its stable lowercase name, or nullptr for
-/// an unknown category (the DTO then omits the categoryName echo). Mirrors the
-/// IDataStorage category constants (same vocabulary as the event logger).
-const char* eventCategoryName(int category)
-{
-    switch (category) {
-    case IDataStorage::kCategoryPump:
-        return "pump";
-    case IDataStorage::kCategoryFailsafe:
-        return "failsafe";
-    case IDataStorage::kCategoryConnectivity:
-        return "connectivity";
-    case IDataStorage::kCategoryOta:
-        return "ota";
-    case IDataStorage::kCategoryReset:
-        return "reset";
-    default:
-        return nullptr;
+    // Paging (/history only); the cursor is checked with the metric list.
+    if (params.get("limit", value)) {
+        if (!parseEpoch(value, epoch) || epoch > UINT32_MAX) {
+            error = "invalid limit";
+            return false;
+        }
+        query.limit = static_cast<uint32_t>(epoch);
+    }
+    if (params.get("cursor", value)) {
+        query.cursor = std::string(value);
+    }
+    if (params.get("last", value)) {
+        if (!parseEpoch(value, epoch) || epoch > UINT32_MAX) {
+            error = "invalid last";
+            return false;
+        }
+        query.last = static_cast<uint32_t>(epoch);
+    }
+    if (params.get("node", value)) {
+        query.node = std::string(value);
     }
+    return true;
 }
 
 esp_err_t historyHandler(httpd_req_t* req)
@@ -409,563 +1154,2574 @@ esp_err_t historyHandler(httpd_req_t* req)
         return sendJson(req, ApiStatus::InternalError,
                         errorBody("server misconfigured"));
     }
-
-    // Extract the query parameters; validation + window resolution live in the
-    // pure-ish builder (buildHistoryResponse) so the handler is thin.
     HistoryQuery query;
-    std::string value;
-    if (queryParam(req, "metric", value)) {
-        query.metric = value;
-    }
-    if (queryParam(req, "reading", value)) {
-        query.reading = value;
-    }
-    if (queryParam(req, "range", value)) {
-        query.range = value;
-    }
-    // A present-but-unparseable start/end is a client error (400), not a silent
-    // default; an absent parameter simply stays unset (default window).
-    int64_t epoch = 0;
-    if (queryParam(req, "start", value)) {
-        if (!parseEpoch(value, epoch)) {
-            return sendJson(req, ApiStatus::BadRequest, errorBody("invalid start"));
+    const char* error = nullptr;
+    if (!readHistoryQuery(req, query, error)) {
+        return sendJson(req, ApiStatus::BadRequest, errorBody(error));
+    }
+    // The JSON form is compressed when the client allows it; the binary one
+    // is already dense.
+    const bool binary = query.format == HistoryFormat::Binary;
+    const ContentEncoding encoding =
+        binary ? ContentEncoding::Identity : acceptedEncoding(req);
+    const char* type = binary ? "application/octet-stream" : "application/json";
+
+    // A HEAD, and a Range on the binary form (the download; its bytes do
+    // not depend on the client's codings), need the body's length first:
+    // one pass into a counter, reading storage but sending nothing. The
+    // range then holds as long as the window does, so a resuming client
+    // pins `end`.
+    const bool head = req->method == HTTP_HEAD;
+    ByteRange range;
+    RangeRequest ranged = RangeRequest::Whole;
+    std::string contentRangeValue;
+    if (head || (binary && httpd_req_get_hdr_value_len(req, "Range") > 0)) {
+        CountingSink counter;
+        const std::unique_ptr<DeflateSink> deflate = makeDeflate(counter, encoding);
+        ApiResponse resp = deflate != nullptr
+                               ? server->streamHistoryResponse(query, *deflate)
+                               : server->streamHistoryResponse(query, counter);
+        if (resp.status == ApiStatus::Ok && deflate != nullptr && !deflate->finish()) {
+            resp = {ApiStatus::InternalError, errorBody("history read interrupted")};
+        }
+        if (resp.status != ApiStatus::Ok) {
+            return sendJson(req, resp.status, resp.body);
+        }
+        if (head) {
+            const bool coded = deflate != nullptr;
+            return sendHead(req, ApiStatus::Ok, type, counter.bytes(),
+                            {{"Content-Encoding", coded ? contentEncodingName(encoding) : nullptr},
+                             {"Vary", coded ? "Accept-Encoding" : nullptr},
+                             {"Accept-Ranges", binary ? "bytes" : nullptr}});
+        }
+        ranged = requestedRange(req, counter.bytes(), std::string(), range);
+        if (ranged == RangeRequest::Unsatisfiable) {
+            return sendRangeNotSatisfiable(req, counter.bytes());
+        }
+        if (ranged == RangeRequest::Partial) {
+            contentRangeValue = contentRange(range, counter.bytes());
+            httpd_resp_set_hdr(req, "Content-Range", contentRangeValue.c_str());
         }
-        query.start = epoch;
     }
-    if (queryParam(req, "end", value)) {
-        if (!parseEpoch(value, epoch)) {
-            return sendJson(req, ApiStatus::BadRequest, errorBody("invalid end"));
+    if (binary) {
+        httpd_resp_set_hdr(req, "Accept-Ranges", "bytes");
+    }
+    if (ranged == RangeRequest::Partial) {
+        // The body is produced again and only the range reaches the
+        // client; the stream stops once the range is out.
+        HttpdChunkSink sink(req, type, ContentEncoding::Identity, ApiStatus::PartialContent);
+        RangeSink part(sink, range);
+        const ApiResponse resp = server->streamHistoryResponse(query, part);
+        if (part.complete()) {
+            return httpd_resp_send_chunk(req, nullptr, 0);
         }
-        query.end = epoch;
+        if (!sink.started()) {
+            return sendJson(req, ApiStatus::InternalError,
+                            errorBody("history read interrupted"));
+        }
+        // Short: the window shrank since it was measured, or the client left.
+        ESP_LOGE(TAG, "history range aborted (%d)", static_cast<int>(resp.status));
+        return ESP_FAIL;
     }
 
-    const ApiResponse resp = server->buildHistoryResponse(query);
-    return sendJson(req, resp.status, resp.body);
+    HttpdChunkSink sink(req, type, encoding);
+    const std::unique_ptr<DeflateSink> deflate = makeDeflate(sink, encoding);
+    const ApiResponse resp = deflate != nullptr
+                                 ? server->streamHistoryResponse(query, *deflate)
+                                 : server->streamHistoryResponse(query, sink);
+    if (resp.status == ApiStatus::Ok && deflate != nullptr && !deflate->finish()) {
+        ESP_LOGE(TAG, "history stream aborted");
+        return ESP_FAIL;
+    }
+    if (!sink.started()) {
+        // Nothing reached the wire (a compressed prefix may sit unsent in
+        // the encoder): the error still goes out as a plain JSON body.
+        return sendJson(req, resp.status, resp.body);
+    }
+    if (resp.status != ApiStatus::Ok) {
+        // Part of the body is out: end without the terminating chunk so the
+        // client sees a broken response, not a truncated "complete" one
+        // (same rule as staticFileHandler's read error).
+        ESP_LOGE(TAG, "history stream aborted");
+        return ESP_FAIL;
+    }
+    return httpd_resp_send_chunk(req, nullptr, 0);
 }
 
-esp_err_t eventsHandler(httpd_req_t* req)
+esp_err_t historyStatsHandler(httpd_req_t* req)
 {
     ApiServer* server = self(req);
     if (server == nullptr) {
         return sendJson(req, ApiStatus::InternalError,
                         errorBody("server misconfigured"));
     }
-
-    // A present-but-unparseable count is a client error (400); a parseable but
-    // non-positive count defaults (resolveEventCount clamps 1..200, absent->50).
-    std::optional<int> requestedCount;
-    std::string value;
-    if (queryParam(req, "count", value)) {
-        char* end = nullptr;
-        const long v = std::strtol(value.c_str(), &end, 10);
-        if (end == value.c_str() || *end != '\0') {
-            return sendJson(req, ApiStatus::BadRequest, errorBody("invalid count"));
-        }
-        requestedCount = static_cast<int>(v);
+    HistoryQuery query;
+    const char* error = nullptr;
+    if (!readHistoryQuery(req, query, error)) {
+        return sendJson(req, ApiStatus::BadRequest, errorBody(error));
     }
-    const std::size_t count = resolveEventCount(requestedCount);
-    return sendJson(req, ApiStatus::Ok, server->buildEventsBody(count));
+    const ApiResponse resp = server->buildHistoryStatsResponse(query);
+    return sendJson(req, resp.status, resp.body);
 }
 
-esp_err_t selfTestHandler(httpd_req_t* req)
+esp_err_t nodesHandler(httpd_req_t* req)
 {
     ApiServer* server = self(req);
     if (server == nullptr) {
         return sendJson(req, ApiStatus::InternalError,
                         errorBody("server misconfigured"));
     }
-    // The one handler that performs a real (bounded) bus read — see
-    // buildSelfTestBody: an explicit diagnostic, off the watering critical path.
-    return sendJson(req, ApiStatus::Ok, server->buildSelfTestBody());
+    const ApiResponse resp = server->buildNodesResponse();
+    return sendJson(req, resp.status, resp.body);
 }
 
-esp_err_t otaHandler(httpd_req_t* req)
+esp_err_t logsHandler(httpd_req_t* req)
 {
-    // Contract stub: PR-13 implements the OTA execution. Until then the route
-    // exists (so it is documented/enumerable) but answers a fixed 501.
-    return sendJson(req, ApiStatus::NotImplemented,
-                    errorBody("OTA not implemented"));
+    ApiServer* server = self(req);
+    if (server == nullptr) {
+        return sendJson(req, ApiStatus::InternalError,
+                        errorBody("server misconfigured"));
+    }
+    const ApiResponse resp = server->buildLogsResponse();
+    return sendJson(req, resp.status, resp.body);
 }
 
-}  // namespace
-
-ApiServer::~ApiServer()
+esp_err_t eventsSummaryHandler(httpd_req_t* req)
 {
-    stop();
+    ApiServer* server = self(req);
+    if (server == nullptr) {
+        return sendJson(req, ApiStatus::InternalError,
+                        errorBody("server misconfigured"));
+    }
+    // Optional window; absent means the whole day, anything but 1..24 is a 400.
+    const RequestQuery params(req);
+    uint32_t hours = EventCounts::kHours;
+    std::string_view value;
+    if (params.get("hours", value)) {
+        int64_t v = 0;
+        if (!parseEpoch(value, v) || v < 1 || v > static_cast<int64_t>(EventCounts::kHours)) {
+            return sendJson(req, ApiStatus::BadRequest, errorBody("invalid hours"));
+        }
+        hours = static_cast<uint32_t>(v);
+    }
+    const ApiResponse resp = server->buildEventSummaryResponse(hours);
+    return sendJson(req, resp.status, resp.body);
 }
 
-std::string ApiServer::deviceIp() const
+esp_err_t historySyncHandler(httpd_req_t* req)
 {
-    esp_netif_t* nif = esp_netif_get_handle_from_ifkey("WIFI_STA_DEF");
+    ApiServer* server = self(req);
+    if (server == nullptr) {
+        return sendJson(req, ApiStatus::InternalError,
+                        errorBody("server misconfigured"));
+    }
+    const RequestQuery params(req);
+    std::string_view value;
+    std::optional<std::string> since;
+    if (params.get("since", value)) {
+        since = std::string(value);
+    }
+    std::optional<uint32_t> limit;
+    int64_t n = 0;
+    if (params.get("limit", value)) {
+        if (!parseEpoch(value, n) || n > UINT32_MAX) {
+            return sendJson(req, ApiStatus::BadRequest, errorBody("invalid limit"));
+        }
+        limit = static_cast<uint32_t>(n);
+    }
+    // Packed records: no compression, like the binary /history.
+    HttpdChunkSink sink(req, "application/octet-stream");
+    const ApiResponse resp = server->streamHistorySyncResponse(since, limit, sink);
+    if (!sink.started()) {
+        return sendJson(req, resp.status, resp.body);
+    }
+    if (resp.status != ApiStatus::Ok) {
+        // No terminating chunk: the collector sees a broken body and
+        // retries with its previous token.
+        ESP_LOGE(TAG, "history sync aborted");
+        return ESP_FAIL;
+    }
+    return httpd_resp_send_chunk(req, nullptr, 0);
+}
+
+// Several metrics' history as one spreadsheet (api/CsvExport.h): the
+// /history window parameters, the metric list in `metrics` (`metric` is
+// taken too). Like the sync body, a cut-off export has no terminating
+// chunk.
+esp_err_t exportCsvHandler(httpd_req_t* req)
+{
+    ApiServer* server = self(req);
+    if (server == nullptr) {
+        return sendJson(req, ApiStatus::InternalError,
+                        errorBody("server misconfigured"));
+    }
+    HistoryQuery query;
+    const char* error = nullptr;
+    if (!readHistoryQuery(req, query, error)) {
+        return sendJson(req, ApiStatus::BadRequest, errorBody(error));
+    }
+    const RequestQuery params(req);
+    std::string_view value;
+    if (params.get("metrics", value)) {
+        query.metric = std::string(value);
+    }
+    const int64_t startUs = esp_timer_get_time();
+    httpd_resp_set_hdr(req, "Content-Disposition", "attachment; filename=\"ws-export.csv\"");
+    HttpdChunkSink sink(req, "text/csv");
+    uint32_t rows = 0;
+    const ApiResponse resp = server->streamCsvExportResponse(query, sink, rows);
+    if (!sink.started()) {
+        return sendJson(req, resp.status, resp.body);
+    }
+    if (resp.status != ApiStatus::Ok) {
+        ESP_LOGE(TAG, "csv export aborted after %u rows", static_cast<unsigned>(rows));
+        return ESP_FAIL;
+    }
+    ESP_LOGI(TAG, "csv export: %u rows in %lld ms", static_cast<unsigned>(rows),
+             static_cast<long long>((esp_timer_get_time() - startUs) / 1000));
+    return httpd_resp_send_chunk(req, nullptr, 0);
+}
+
+/// The DTOs of @p records: a human category name when the id is known and
+/// the detail's text (compact details are rendered only here and in the
+/// other readers, interfaces/EventCodec.h).
+std::vector<EventDto> eventDtos(const std::vector<EventRecord>& records)
+{
+    std::vector<EventDto> events;
+    events.reserve(records.size());
+    for (const EventRecord& r : records) {
+        EventDto dto;
+        dto.epoch = static_cast<int64_t>(r.epoch);
+        dto.category = static_cast<int>(r.category);
+        const char* name = eventCategoryName(dto.category);
+        if (name != nullptr) {
+            dto.categoryName = name;
+        }
+        dto.detail = renderEventDetail(r.detail);
+        events.push_back(std::move(dto));
+    }
+    return events;
+}
+
+/// Answer a held tail read with @p body, hand the request back to httpd
+/// and free its slot.
+void finishEventWait(ApiServer& server, EventWait& wait, const std::string& body)
+{
+    httpd_req_t* asyncReq = static_cast<httpd_req_t*>(wait.asyncReq);
+    sendJson(asyncReq, ApiStatus::Ok, body);
+    httpd_req_async_handler_complete(asyncReq);
+    wait.asyncReq = nullptr;
+    server.releaseEventWait();
+}
+
+/// GET /api/v1/events?after=: answered at once when something is past the
+/// cursor or @p waitS is 0, else held for the event-wait worker, which
+/// answers it on the next event or after @p waitS seconds.
+esp_err_t eventTail(httpd_req_t* req, ApiServer& server, EventWait& wait, uint32_t waitS)
+{
+    // Noted before the read: an event stored after it moves the generation
+    // and the worker reads again.
+    wait.generation = server.eventGeneration();
+    const std::optional<std::string> body = server.buildEventTailBody(wait, waitS == 0);
+    if (body.has_value()) {
+        return sendJson(req, ApiStatus::Ok, *body);
+    }
+    if (!server.claimEventWait()) {
+        // Every slot holds a request: nothing new yet, the client asks again.
+        return sendJson(req, ApiStatus::Ok, *server.buildEventTailBody(wait, true));
+    }
+    // Detached, the request no longer holds the httpd task: the other
+    // clients are served while it waits.
+    httpd_req_t* asyncReq = nullptr;
+    if (httpd_req_async_handler_begin(req, &asyncReq) != ESP_OK) {
+        server.releaseEventWait();
+        return sendJson(req, ApiStatus::Ok, *server.buildEventTailBody(wait, true));
+    }
+    wait.asyncReq = asyncReq;
+    wait.deadlineUs = esp_timer_get_time() + static_cast<int64_t>(waitS) * 1000000;
+    if (!server.deferEventWait(wait)) {
+        ESP_LOGW(TAG, "event-wait worker unavailable, answering now");
+        finishEventWait(server, wait, *server.buildEventTailBody(wait, true));
+    }
+    return ESP_OK;
+}
+
+esp_err_t eventsHandler(httpd_req_t* req)
+{
+    ApiServer* server = self(req);
+    if (server == nullptr) {
+        return sendJson(req, ApiStatus::InternalError,
+                        errorBody("server misconfigured"));
+    }
+
+    // A present-but-unparseable count is a client error (400); a parseable but
+    // non-positive count defaults (resolveEventCount clamps 1..200, absent->50).
+    const RequestQuery params(req);
+    std::optional<int> requestedCount;
+    std::string_view value;
+    if (params.get("count", value)) {
+        const bool negative = !value.empty() && value.front() == '-';
+        int64_t v = 0;
+        if (!parseEpoch(negative ? value.substr(1) : value, v)) {
+            return sendJson(req, ApiStatus::BadRequest, errorBody("invalid count"));
+        }
+        requestedCount = negative ? 0 : static_cast<int>(v > INT_MAX ? INT_MAX : v);
+    }
+    EventQuery query;
+    query.limit = resolveEventCount(requestedCount);
+    // Triage filters: all optional, any present-but-malformed value is a 400.
+    if (params.get("category", value) &&
+        !parseEventCategories(value, query.categoryMask)) {
+        return sendJson(req, ApiStatus::BadRequest, errorBody("invalid category"));
+    }
+    int64_t epoch = 0;
+    if (params.get("after", value)) {
+        // A tail read (api/EventTail.h): count and category only.
+        std::string_view other;
+        if (params.get("since", other) || params.get("until", other) ||
+            params.get("cursor", other)) {
+            return sendJson(req, ApiStatus::BadRequest,
+                            errorBody("after excludes since, until and cursor"));
+        }
+        EventWait wait;
+        if (!parseEventCursor(value, wait.after)) {
+            return sendJson(req, ApiStatus::BadRequest, errorBody("invalid after"));
+        }
+        wait.categoryMask = query.categoryMask;
+        wait.count = static_cast<uint32_t>(query.limit);
+        uint32_t waitS = 0;
+        if (params.get("wait", value)) {
+            if (!parseEpoch(value, epoch)) {
+                return sendJson(req, ApiStatus::BadRequest, errorBody("invalid wait"));
+            }
+            // Clamped, not refused: the server's limit is not the client's
+            // to know.
+            waitS = static_cast<uint32_t>(
+                std::min<int64_t>(epoch, server->eventWaitMaxS()));
+        }
+        return eventTail(req, *server, wait, waitS);
+    }
+    if (params.get("wait", value)) {
+        return sendJson(req, ApiStatus::BadRequest, errorBody("wait needs after"));
+    }
+    if (params.get("since", value)) {
+        if (!parseEpoch(value, epoch) || epoch > UINT32_MAX) {
+            return sendJson(req, ApiStatus::BadRequest, errorBody("invalid since"));
+        }
+        query.since = static_cast<uint32_t>(epoch);
+    }
+    if (params.get("until", value)) {
+        if (!parseEpoch(value, epoch) || epoch > UINT32_MAX) {
+            return sendJson(req, ApiStatus::BadRequest, errorBody("invalid until"));
+        }
+        query.until = static_cast<uint32_t>(epoch);
+    }
+    if (params.get("cursor", value) &&
+        !parseEventCursor(value, query.cursor)) {
+        return sendJson(req, ApiStatus::BadRequest, errorBody("invalid cursor"));
+    }
+    return sendJson(req, ApiStatus::Ok, server->buildEventsBody(query));
+}
+
+// The watering controller's decision records past ?after= (ApiStream.h),
+// streamed off the trace ring without stopping the watering task; 404 where
+// no trace is wired (CONFIG_WS_DECISION_TRACE off).
+esp_err_t controlTraceHandler(httpd_req_t* req)
+{
+    ApiServer* server = self(req);
+    if (server == nullptr) {
+        return sendJson(req, ApiStatus::InternalError,
+                        errorBody("server misconfigured"));
+    }
+    const DecisionTrace* trace = server->decisionTrace();
+    if (trace == nullptr) {
+        return sendJson(req, ApiStatus::NotFound,
+                        errorBody("decision trace not enabled"));
+    }
+    const RequestQuery params(req);
+    std::string_view value;
+    int64_t after = 0;
+    if (params.get("after", value) && (!parseEpoch(value, after) || after > UINT32_MAX)) {
+        return sendJson(req, ApiStatus::BadRequest, errorBody("invalid after"));
+    }
+    HttpdChunkSink sink(req, "application/json");
+    if (!streamDecisionTrace(*trace, static_cast<uint32_t>(after), sink)) {
+        ESP_LOGE(TAG, "decision trace stream aborted");
+        return ESP_FAIL;
+    }
+    return httpd_resp_send_chunk(req, nullptr, 0);
+}
+
+// Every record of the system trace rings as a binary dump (ApiStream.h);
+// 404 where tracing is compiled out (CONFIG_WS_TRACE_LEVEL 0).
+esp_err_t traceHandler(httpd_req_t* req)
+{
+#if WS_TRACE_LEVEL > 0
+    HttpdChunkSink sink(req, "application/octet-stream");
+    if (!streamTraceBuffer(traceBuffer(), static_cast<uint32_t>(esp_timer_get_time()),
+                           sink)) {
+        ESP_LOGE(TAG, "trace stream aborted");
+        return ESP_FAIL;
+    }
+    return httpd_resp_send_chunk(req, nullptr, 0);
+#else
+    return sendJson(req, ApiStatus::NotFound, errorBody("trace not enabled"));
+#endif
+}
+
+// The RS485 frame ring past ?after= as a binary dump (ApiStream.h); 404
+// where no capture is wired (the esp-modbus client).
+esp_err_t modbusCaptureHandler(httpd_req_t* req)
+{
+    ApiServer* server = self(req);
+    if (server == nullptr) {
+        return sendJson(req, ApiStatus::InternalError,
+                        errorBody("server misconfigured"));
+    }
+    const ModbusFrameCapture* capture = server->modbusCapture();
+    if (capture == nullptr) {
+        return sendJson(req, ApiStatus::NotFound,
+                        errorBody("modbus capture not enabled"));
+    }
+    const RequestQuery params(req);
+    std::string_view value;
+    int64_t after = 0;
+    if (params.get("after", value) && (!parseEpoch(value, after) || after > UINT32_MAX)) {
+        return sendJson(req, ApiStatus::BadRequest, errorBody("invalid after"));
+    }
+    HttpdChunkSink sink(req, "application/octet-stream");
+    if (!streamModbusCapture(*capture, static_cast<uint32_t>(esp_timer_get_time()),
+                             static_cast<uint32_t>(after), sink)) {
+        ESP_LOGE(TAG, "modbus capture stream aborted");
+        return ESP_FAIL;
+    }
+    return httpd_resp_send_chunk(req, nullptr, 0);
+}
+
+// The watering input recording (ApiStream.h, control/InputRecord.h); 404
+// without CONFIG_WS_INPUT_RECORDER.
+esp_err_t recordingHandler(httpd_req_t* req)
+{
+    ApiServer* server = self(req);
+    if (server == nullptr) {
+        return sendJson(req, ApiStatus::InternalError,
+                        errorBody("server misconfigured"));
+    }
+    const InputRecorder* recorder = server->inputRecorder();
+    if (recorder == nullptr) {
+        return sendJson(req, ApiStatus::NotFound,
+                        errorBody("input recording not enabled"));
+    }
+    HttpdChunkSink sink(req, "application/octet-stream");
+    if (!streamInputRecording(*recorder, server->recordingFile(), sink)) {
+        ESP_LOGE(TAG, "recording stream aborted");
+        return ESP_FAIL;
+    }
+    return httpd_resp_send_chunk(req, nullptr, 0);
+}
+
+/// Every diagnostic section of @p server into @p bundle, in bundle order
+/// (api/SupportBundle.h); false once the client is gone.
+bool writeSupportBundle(ApiServer& server, SupportBundleWriter& bundle)
+{
+    bundle.section("status", "application/json", server.statusBody());
+    bundle.section("config", "application/json", server.configBody());
+    bundle.section("metrics", kMetricsContentType);
+    const HttpMetricsSnapshot http = server.httpMetrics().snapshot();
+    streamMetrics(http, server.readSystemMetrics(), bundle);
+
+    EventQuery query;
+    query.limit = kSupportBundleEvents;
+    bundle.section("events", "application/json", server.buildEventsBody(query));
+    const auto optional = [&bundle](const char* name, const ApiResponse& resp) {
+        if (resp.status == ApiStatus::Ok) {
+            bundle.section(name, "application/json", resp.body);
+        } else {
+            bundle.absent(name, "not enabled");
+        }
+    };
+    optional("events-summary", server.buildEventSummaryResponse(EventCounts::kHours));
+    optional("logs", server.buildLogsResponse());
+
+    if (const DecisionTrace* trace = server.decisionTrace()) {
+        bundle.section("control-trace", "application/json");
+        streamDecisionTrace(*trace, 0, bundle);
+    } else {
+        bundle.absent("control-trace", "not enabled");
+    }
+    return bundle.finish();
+}
+
+// Every diagnostic body in one gzip download (api/SupportBundle.h). The
+// sections are produced one after the other into the encoder and out
+// through the chunked sender, so RAM holds the encoder and one section's
+// body, never the bundle. A cut-off body has no terminating chunk.
+esp_err_t supportBundleHandler(httpd_req_t* req)
+{
+    ApiServer* server = self(req);
+    if (server == nullptr) {
+        return sendJson(req, ApiStatus::InternalError,
+                        errorBody("server misconfigured"));
+    }
+    const int64_t startUs = esp_timer_get_time();
+    HttpdChunkSink sink(req, "application/gzip");
+    const std::unique_ptr<DeflateSink> gzip = makeDeflate(sink, ContentEncoding::Gzip);
+    if (gzip == nullptr) {
+        return sendJson(req, ApiStatus::InternalError, errorBody("out of memory"));
+    }
+    httpd_resp_set_hdr(req, "Content-Disposition",
+                       "attachment; filename=\"ws-support.txt.gz\"");
+    SupportBundleWriter bundle(*gzip);
+    if (!writeSupportBundle(*server, bundle) || !gzip->finish()) {
+        ESP_LOGE(TAG, "support bundle stream aborted");
+        return ESP_FAIL;
+    }
+    ESP_LOGI(TAG, "support bundle: %u sections, %llu bytes in %lld ms",
+             static_cast<unsigned>(bundle.sections()),
+             static_cast<unsigned long long>(bundle.bytes()),
+             static_cast<long long>((esp_timer_get_time() - startUs) / 1000));
+    return httpd_resp_send_chunk(req, nullptr, 0);
+}
+
+esp_err_t snapshotHandler(httpd_req_t* req)
+{
+    ApiServer* server = self(req);
+    if (server == nullptr) {
+        return sendJson(req, ApiStatus::InternalError,
+                        errorBody("server misconfigured"));
+    }
+    // Absent `fields` = every section; a present-but-malformed one is a 400.
+    uint32_t fields = kSnapshotAll;
+    const RequestQuery params(req);
+    std::string_view value;
+    if (params.get("fields", value) && !parseSnapshotFields(value, fields)) {
+        return sendJson(req, ApiStatus::BadRequest, errorBody("invalid fields"));
+    }
+    return sendJson(req, ApiStatus::Ok,
+                    serializeSnapshot(server->readSnapshot(fields)));
+}
+
+/// Run the self-test for a claimed, detached request: answer it, hand it
+/// back to httpd and free the slot.
+void answerSelfTest(ApiServer& server, httpd_req_t* asyncReq)
+{
+    sendJson(asyncReq, ApiStatus::Ok, server.buildSelfTestBody());
+    httpd_req_async_handler_complete(asyncReq);
+    server.releaseSelfTest();
+}
+
+esp_err_t selfTestHandler(httpd_req_t* req)
+{
+    ApiServer* server = self(req);
+    if (server == nullptr) {
+        return sendJson(req, ApiStatus::InternalError,
+                        errorBody("server misconfigured"));
+    }
+    if (!server->claimSelfTest()) {
+        return sendJson(req, ApiStatus::Conflict,
+                        errorBody("selftest already running"));
+    }
+    // The one handler that performs a real (bounded) bus read — see
+    // buildSelfTestBody. The soil round trip can take the whole Modbus
+    // timeout, so the request is detached and answered by the selftest
+    // worker; this task goes straight back to the other clients.
+    httpd_req_t* asyncReq = nullptr;
+    if (httpd_req_async_handler_begin(req, &asyncReq) != ESP_OK) {
+        // No memory for the copy: answer inline, as before the worker.
+        const esp_err_t err =
+            sendJson(req, ApiStatus::Ok, server->buildSelfTestBody());
+        server->releaseSelfTest();
+        return err;
+    }
+    if (!server->deferSelfTest(asyncReq)) {
+        ESP_LOGW(TAG, "selftest worker unavailable, running inline");
+        answerSelfTest(*server, asyncReq);
+    }
+    return ESP_OK;
+}
+
+/// Largest client->server frame read (clients send nothing meaningful).
+constexpr size_t kMaxInboundFrameLen = 64;
+
+// GET /api/v1/stream. httpd completes the WebSocket handshake and calls this
+// once with HTTP_GET (the socket is then registered for pushes), and again
+// for every data frame the client sends, which are read and discarded.
+// PING/PONG/CLOSE are answered by httpd itself; a closed socket leaves the
+// stream through the session close hook below.
+esp_err_t streamHandler(httpd_req_t* req)
+{
+    ApiServer* server = self(req);
+    if (server == nullptr) {
+        return ESP_FAIL;
+    }
+    if (req->method == HTTP_GET) {
+        if (!server->liveStream().addClient(httpd_req_to_sockfd(req))) {
+            ESP_LOGW(TAG, "stream: all %u client slots in use",
+                     static_cast<unsigned>(LiveStream::kMaxClients));
+            return ESP_FAIL;  // httpd closes the session
+        }
+        noteStatus(101);  // the handshake httpd answered
+        return ESP_OK;
+    }
+    httpd_ws_frame_t frame = {};
+    esp_err_t err = httpd_ws_recv_frame(req, &frame, 0);  // length only
+    if (err != ESP_OK || frame.len == 0) {
+        return err;
+    }
+    if (frame.len > kMaxInboundFrameLen) {
+        return ESP_FAIL;  // not a client of ours: drop the session
+    }
+    uint8_t buf[kMaxInboundFrameLen];
+    frame.payload = buf;
+    return httpd_ws_recv_frame(req, &frame, sizeof buf);
+}
+
+/// Session open hook: count the session for the utilization metrics.
+esp_err_t onSessionOpen(httpd_handle_t hd, int sockfd)
+{
+    ApiServer* server = static_cast<ApiServer*>(httpd_get_global_user_ctx(hd));
+    if (server != nullptr) {
+        server->socketMetrics().opened(sockfd, esp_timer_get_time());
+    }
+    return ESP_OK;
+}
+
+/// Session close hook (every session, not only the stream ones): forget a
+/// stream client, then close the socket — with a close_fn set, httpd leaves
+/// that to us.
+void onSessionClose(httpd_handle_t hd, int sockfd)
+{
+    ApiServer* server = static_cast<ApiServer*>(httpd_get_global_user_ctx(hd));
+    if (server != nullptr) {
+        server->liveStream().removeClient(sockfd);
+        server->socketMetrics().closed(sockfd);
+    }
+    close(sockfd);
+}
+
+/// httpd frees global_user_ctx on stop unless told otherwise; the
+/// ApiServer is not heap-owned by it.
+void keepGlobalContext(void* /*ctx*/) {}
+
+/// httpd_queue_work trampoline for ApiServer::drainStream().
+void drainStreamWork(void* arg)
+{
+    static_cast<ApiServer*>(arg)->drainStream();
+}
+
+/// Optional header carrying the image's expected SHA-256 (64 hex digits).
+constexpr const char* kOtaHashHeader = "X-Image-SHA256";
+
+/// Socket receive timeouts (httpd's recv_wait_timeout each) tolerated in a
+/// row before an upload counts as cut off.
+constexpr int kOtaRecvTimeouts = 3;
+
+/// The request body as an OtaPipeline chunk source.
+class RequestBodySource : public IChunkSource {
+public:
+    explicit RequestBodySource(httpd_req_t* req) : req_(req) {}
+
+    int receive(uint8_t* dst, std::size_t len) override
+    {
+        for (int timeouts = 0; timeouts < kOtaRecvTimeouts; ++timeouts) {
+            const int r = httpd_req_recv(req_, reinterpret_cast<char*>(dst), len);
+            if (r != HTTPD_SOCK_ERR_TIMEOUT) {
+                return r;
+            }
+        }
+        return -1;
+    }
+
+private:
+    httpd_req_t* req_;
+};
+
+/// The status an upload's outcome answers with. Total over the enum.
+ApiStatus otaStatus(OtaOutcome outcome)
+{
+    switch (outcome) {
+    case OtaOutcome::Ok:
+        return ApiStatus::Ok;
+    case OtaOutcome::Busy:
+    case OtaOutcome::BaseMismatch:  // the client falls back to the full image
+        return ApiStatus::Conflict;
+    case OtaOutcome::WriteFailed:
+        return ApiStatus::InternalError;
+    case OtaOutcome::NoLength:
+    case OtaOutcome::TooLarge:
+    case OtaOutcome::ReceiveFailed:
+    case OtaOutcome::HashMismatch:
+    case OtaOutcome::Rejected:
+    case OtaOutcome::BadPatch:
+        return ApiStatus::BadRequest;
+    }
+    return ApiStatus::InternalError;
+}
+
+esp_err_t otaHandler(httpd_req_t* req)
+{
+    ApiServer* server = self(req);
+    if (server == nullptr) {
+        return sendJson(req, ApiStatus::InternalError,
+                        errorBody("server misconfigured"));
+    }
+    OtaPipeline* ota = server->otaPipeline();
+    if (ota == nullptr) {
+        return sendJson(req, ApiStatus::NotImplemented, errorBody("OTA not enabled"));
+    }
+
+    Sha256::Digest expected{};
+    const bool haveExpected = httpd_req_get_hdr_value_len(req, kOtaHashHeader) > 0;
+    if (haveExpected) {
+        char hex[2 * Sha256::kDigestBytes + 1] = {};
+        if (httpd_req_get_hdr_value_str(req, kOtaHashHeader, hex, sizeof hex) != ESP_OK ||
+            !Sha256::fromHex(hex, expected)) {
+            return sendJson(req, ApiStatus::BadRequest,
+                            errorBody("invalid X-Image-SHA256"));
+        }
+    }
+
+    // Streams straight into the slot: the body is never buffered whole.
+    RequestBodySource source(req);
+    const OtaReport report =
+        ota->receive(req->content_len, haveExpected ? &expected : nullptr, source);
+    if (report.outcome != OtaOutcome::Ok) {
+        ESP_LOGW(TAG, "OTA %s after %lu bytes", otaOutcomeName(report.outcome),
+                 static_cast<unsigned long>(report.bytes));
+        return sendJson(req, otaStatus(report.outcome),
+                        errorBody(std::string("OTA ") + otaOutcomeName(report.outcome)));
+    }
+    ESP_LOGI(TAG, "OTA image of %lu bytes (%lu sent%s) in %lu ms",
+             static_cast<unsigned long>(report.bytes),
+             static_cast<unsigned long>(report.transferBytes), report.delta ? ", delta" : "",
+             static_cast<unsigned long>(report.elapsedMs));
+    return sendJson(req, ApiStatus::Ok, serializeOtaReport(report));
+}
+
+/// GET /api/v1/backup's work under the hold: the archive streamed while
+/// no write can land, so it is one instant's files. Nothing is replaced.
+class BackupJob final : public IStorageJob {
+public:
+    BackupJob(ApiServer& server, httpd_req_t* req, std::string config)
+        : server_(server), req_(req), config_(std::move(config))
+    {
+    }
+
+    bool run() override
+    {
+        ArchiveSource source(server_.archiveBasePath(), std::move(config_));
+        files = source.files();
+        bytes = source.fileBytes();
+        HttpdChunkSink sink(req_, "application/octet-stream");
+        uint8_t buf[1024];
+        ReadAheadPipe* pipe = server_.readAhead();
+        outcome = pipe != nullptr ? pipe->pump(source, sink, buf, sizeof(buf))
+                                  : copyChunks(source, sink, buf, sizeof(buf));
+        return false;
+    }
+
+    PumpOutcome outcome = PumpOutcome::ReadFailed;
+    std::size_t files = 0;
+    uint64_t bytes = 0;
+
+private:
+    ApiServer& server_;
+    httpd_req_t* req_;
+    std::string config_;
+};
+
+esp_err_t backupHandler(httpd_req_t* req)
+{
+    ApiServer* server = self(req);
+    if (server == nullptr) {
+        return sendJson(req, ApiStatus::InternalError,
+                        errorBody("server misconfigured"));
+    }
+    IStorageHold* hold = server->storageHold();
+    if (hold == nullptr) {
+        return sendJson(req, ApiStatus::NotImplemented, errorBody("backup not available"));
+    }
+    const int64_t startUs = esp_timer_get_time();
+    httpd_resp_set_hdr(req, "Content-Disposition", "attachment; filename=\"ws-backup.wsa\"");
+    BackupJob job(*server, req, server->configBody());
+    hold->runHeld(job);
+    // As for a large asset: a read error ends the body without its
+    // terminating chunk, so the client never keeps a truncated archive.
+    if (job.outcome == PumpOutcome::SendFailed) {
+        return ESP_FAIL;
+    }
+    if (job.outcome == PumpOutcome::ReadFailed) {
+        ESP_LOGE(TAG, "backup: read error after the listing (truncated)");
+        return ESP_FAIL;
+    }
+    ESP_LOGI(TAG, "backup: %u files, %llu bytes in %lld ms", static_cast<unsigned>(job.files),
+             static_cast<unsigned long long>(job.bytes),
+             static_cast<long long>((esp_timer_get_time() - startUs) / 1000));
+    return httpd_resp_send_chunk(req, nullptr, 0);
+}
+
+/// POST /api/v1/restore's work under the hold: the uploaded archive
+/// staged and swapped in.
+class RestoreJob final : public IStorageJob {
+public:
+    RestoreJob(const std::string& basePath, httpd_req_t* req) : basePath_(basePath), req_(req) {}
+
+    bool run() override
+    {
+        RequestBodySource source(req_);
+        report = ArchiveRestore(basePath_).run(source);
+        return report.outcome == RestoreOutcome::Ok;
+    }
+
+    RestoreReport report;
+
+private:
+    const std::string& basePath_;
+    httpd_req_t* req_;
+};
+
+/// The status a restore's outcome answers with. Total over the enum.
+ApiStatus restoreStatus(RestoreOutcome outcome)
+{
+    switch (outcome) {
+    case RestoreOutcome::Ok:
+        return ApiStatus::Ok;
+    case RestoreOutcome::ReceiveFailed:
+    case RestoreOutcome::BadArchive:
+        return ApiStatus::BadRequest;
+    case RestoreOutcome::WriteFailed:
+        return ApiStatus::InternalError;
+    }
+    return ApiStatus::InternalError;
+}
+
+esp_err_t restoreHandler(httpd_req_t* req)
+{
+    ApiServer* server = self(req);
+    if (server == nullptr) {
+        return sendJson(req, ApiStatus::InternalError,
+                        errorBody("server misconfigured"));
+    }
+    IStorageHold* hold = server->storageHold();
+    if (hold == nullptr) {
+        return sendJson(req, ApiStatus::NotImplemented, errorBody("restore not available"));
+    }
+    RestoreJob job(server->archiveBasePath(), req);
+    hold->runHeld(job);
+    const RestoreReport& report = job.report;
+    if (report.outcome != RestoreOutcome::Ok) {
+        ESP_LOGW(TAG, "restore %s after %lu files; store unchanged",
+                 restoreOutcomeName(report.outcome), static_cast<unsigned long>(report.files));
+        return sendJson(req, restoreStatus(report.outcome),
+                        errorBody(std::string("restore ") + restoreOutcomeName(report.outcome)));
+    }
+    // The files are in; the config goes through the POST /config path, so
+    // an archive from another build only sets what this one validates.
+    bool configApplied = false;
+    if (!report.config.empty()) {
+        configApplied = server->applyConfigSet(report.config).status == ApiStatus::Ok;
+        if (!configApplied) {
+            ESP_LOGW(TAG, "restore: archived config rejected; current config kept");
+        }
+    }
+    ESP_LOGI(TAG, "restore: %lu files, %llu bytes%s", static_cast<unsigned long>(report.files),
+             static_cast<unsigned long long>(report.bytes), configApplied ? ", config" : "");
+    return sendJson(req, ApiStatus::Ok, serializeRestoreReport(report, configApplied));
+}
+
+esp_err_t metricsHandler(httpd_req_t* req)
+{
+    ApiServer* server = self(req);
+    if (server == nullptr) {
+        return sendJson(req, ApiStatus::InternalError,
+                        errorBody("server misconfigured"));
+    }
+    const HttpMetricsSnapshot http = server->httpMetrics().snapshot();
+    const SystemMetricsDto system = server->readSystemMetrics();
+    const ContentEncoding encoding = acceptedEncoding(req);
+    HttpdChunkSink sink(req, kMetricsContentType, encoding);
+    const std::unique_ptr<DeflateSink> deflate = makeDeflate(sink, encoding);
+    const bool sent = deflate != nullptr
+                          ? streamMetrics(http, system, *deflate) && deflate->finish()
+                          : streamMetrics(http, system, sink);
+    if (!sent) {
+        ESP_LOGE(TAG, "metrics stream aborted");
+        return ESP_FAIL;  // no terminating chunk: the client sees the break
+    }
+    return httpd_resp_send_chunk(req, nullptr, 0);
+}
+
+/// Record one answered request against @p slot, and against its session
+/// when @p sockfd is known (not for answers finished off the httpd task). A
+/// handler that answered nothing (a deferred self-test, a stream data
+/// frame) is not counted; one that failed counts as a 500, whatever status
+/// line it had chosen.
+void recordRequest(ApiServer* server, std::size_t slot, const RequestTally& tally,
+                   esp_err_t err, int64_t startUs, int sockfd = -1)
+{
+    if (server == nullptr || (tally.status == 0 && err == ESP_OK)) {
+        return;
+    }
+    const int64_t nowUs = esp_timer_get_time();
+    server->httpMetrics().record(slot, err == ESP_OK ? tally.status : 500,
+                                 tally.bytes, nowUs - startUs);
+    if (sockfd >= 0) {
+        server->socketMetrics().request(sockfd, tally.bytes, nowUs);
+    }
+}
+
+/// The over-limit answer, fixed so a flooding client costs one write: no
+/// DTO, no cJSON, no arena.
+constexpr char kThrottledBody[] = "{\"success\":false,\"error\":\"too many requests\"}";
+
+/// The address at the other end of @p req's socket; false when unknown.
+bool peerAddress(httpd_req_t* req, ClientAddress& out)
+{
+    sockaddr_storage addr = {};
+    socklen_t len = sizeof addr;
+    if (getpeername(httpd_req_to_sockfd(req), reinterpret_cast<sockaddr*>(&addr), &len) != 0) {
+        return false;
+    }
+    if (addr.ss_family == AF_INET) {
+        out = ClientAddress::fromIpv4(reinterpret_cast<const sockaddr_in&>(addr).sin_addr.s_addr);
+        return true;
+    }
+#if CONFIG_LWIP_IPV6
+    if (addr.ss_family == AF_INET6) {
+        std::memcpy(out.bytes, &reinterpret_cast<const sockaddr_in6&>(addr).sin6_addr,
+                    sizeof out.bytes);
+        return true;
+    }
+#endif
+    return false;
+}
+
+/// Does @p req's client have a token (RateLimiter.h)? A peer whose
+/// address cannot be read is let through.
+bool admitted(ApiServer* server, httpd_req_t* req)
+{
+    if (server == nullptr || !server->rateLimiter().enabled()) {
+        return true;
+    }
+    ClientAddress client;
+    if (!peerAddress(req, client)) {
+        return true;
+    }
+    const auto nowMs = static_cast<uint32_t>(esp_timer_get_time() / 1000);
+    return server->rateLimiter().admit(client, nowMs);
+}
+
+/// Refuse @p req with the preformatted 429. With whole tokens a second,
+/// the next one is never more than a second away.
+esp_err_t sendThrottled(httpd_req_t* req)
+{
+    httpd_resp_set_type(req, "application/json");
+    httpd_resp_set_status(req, statusLine(ApiStatus::TooManyRequests));
+    httpd_resp_set_hdr(req, "Retry-After", "1");
+    noteStatus(static_cast<int>(ApiStatus::TooManyRequests));
+    noteBytes(sizeof kThrottledBody - 1);
+    return httpd_resp_send(req, kThrottledBody, sizeof kThrottledBody - 1);
+}
+
+/// @p Handler, timed and counted under @p Slot (ApiMetrics.h), behind the
+/// per-client rate limit. Its cJSON trees live in the server's arena,
+/// reclaimed on return. The stream route is not limited: after the
+/// handshake each websocket frame calls its handler too.
+template <esp_err_t (*Handler)(httpd_req_t*), std::size_t Slot>
+esp_err_t timed(httpd_req_t* req)
+{
+    ApiServer* server = self(req);
+    PowerLockGuard fast(server != nullptr ? server->powerLock() : nullptr);
+    RequestTally tally;
+    tTally = &tally;
+    const int64_t startUs = esp_timer_get_time();
+    WS_TRACE(Info, HttpBegin, Slot, 0);
+    esp_err_t err;
+    if (Slot != metricSlot(HandlerId::Stream) && !admitted(server, req)) {
+        err = sendThrottled(req);
+    } else {
+        ArenaScope arena(server != nullptr ? &server->requestArena() : nullptr);
+        err = Handler(req);
+    }
+    tTally = nullptr;
+    WS_TRACE(Info, HttpEnd, Slot | (static_cast<uint32_t>(tally.status) << 16),
+             esp_timer_get_time() - startUs);
+    recordRequest(server, Slot, tally, err, startUs, httpd_req_to_sockfd(req));
+    return err;
+}
+
+/// The same for the 404/405 error handlers, which get no user_ctx; they
+/// share the unmatched slot.
+template <esp_err_t (*Handler)(httpd_req_t*, httpd_err_code_t)>
+esp_err_t timedError(httpd_req_t* req, httpd_err_code_t error)
+{
+    ApiServer* server = static_cast<ApiServer*>(httpd_get_global_user_ctx(req->handle));
+    PowerLockGuard fast(server != nullptr ? server->powerLock() : nullptr);
+    RequestTally tally;
+    tTally = &tally;
+    const int64_t startUs = esp_timer_get_time();
+    esp_err_t err;
+    if (!admitted(server, req)) {
+        err = sendThrottled(req);
+    } else {
+        ArenaScope arena(server != nullptr ? &server->requestArena() : nullptr);
+        err = Handler(req, error);
+    }
+    tTally = nullptr;
+    recordRequest(server, metricSlot(HandlerId::NotFound), tally, err, startUs,
+                  httpd_req_to_sockfd(req));
+    return err;
+}
+
+/// Every route's timed handler, indexed by HandlerId (the route table's
+/// ids, ApiRoutes.h). Stream is here for completeness: its websocket
+/// registration matches first, so the dispatcher never reaches it.
+using RouteHandler = esp_err_t (*)(httpd_req_t*);
+constexpr RouteHandler kRouteHandlers[] = {
+    &timed<&statusHandler, metricSlot(HandlerId::Status)>,
+    &timed<&sensorsHandler, metricSlot(HandlerId::Sensors)>,
+    &timed<&historyHandler, metricSlot(HandlerId::History)>,
+    &timed<&historyStatsHandler, metricSlot(HandlerId::HistoryStats)>,
+    &timed<&historySyncHandler, metricSlot(HandlerId::HistorySync)>,
+    &timed<&pumpsListHandler, metricSlot(HandlerId::PumpsList)>,
+    &timed<&pumpCommandHandler, metricSlot(HandlerId::PumpCmd)>,
+    &timed<&pumpUsageHandler, metricSlot(HandlerId::PumpUsage)>,
+    &timed<&configGetHandler, metricSlot(HandlerId::ConfigGet)>,
+    &timed<&configSetHandler, metricSlot(HandlerId::ConfigSet)>,
+    &timed<&powerHandler, metricSlot(HandlerId::Power)>,
+    &timed<&powerCaptureHandler, metricSlot(HandlerId::PowerCapture)>,
+    &timed<&eventsHandler, metricSlot(HandlerId::Events)>,
+    &timed<&streamHandler, metricSlot(HandlerId::Stream)>,
+    &timed<&selfTestHandler, metricSlot(HandlerId::SelfTest)>,
+    &timed<&otaHandler, metricSlot(HandlerId::Ota)>,
+    &timed<&metricsHandler, metricSlot(HandlerId::Metrics)>,
+    &timed<&snapshotHandler, metricSlot(HandlerId::Snapshot)>,
+    &timed<&controlTraceHandler, metricSlot(HandlerId::ControlTrace)>,
+    &timed<&traceHandler, metricSlot(HandlerId::Trace)>,
+    &timed<&nodesHandler, metricSlot(HandlerId::Nodes)>,
+    &timed<&logsHandler, metricSlot(HandlerId::Logs)>,
+    &timed<&eventsSummaryHandler, metricSlot(HandlerId::EventsSummary)>,
+    &timed<&modbusCaptureHandler, metricSlot(HandlerId::ModbusCapture)>,
+    &timed<&backupHandler, metricSlot(HandlerId::Backup)>,
+    &timed<&restoreHandler, metricSlot(HandlerId::Restore)>,
+    &timed<&recordingHandler, metricSlot(HandlerId::Recording)>,
+    &timed<&supportBundleHandler, metricSlot(HandlerId::SupportBundle)>,
+    &timed<&exportCsvHandler, metricSlot(HandlerId::ExportCsv)>,
+};
+static_assert(sizeof(kRouteHandlers) / sizeof(kRouteHandlers[0]) ==
+                  static_cast<std::size_t>(HandlerId::NotFound),
+              "one handler per HandlerId, in enum order");
+
+/// The one httpd handler for every `/api/v1/` request of @p Method: the
+/// path (the URI up to its query) through matchRoute(), then the route's
+/// handler; a path only another method serves answers 405, the rest 404.
+template <HttpMethod Method>
+esp_err_t apiDispatch(httpd_req_t* req)
+{
+    std::string_view path(req->uri);
+    path = path.substr(0, path.find('?'));
+    const HandlerId id = matchRoute(Method, path);
+    if (id != HandlerId::NotFound) {
+        return kRouteHandlers[static_cast<std::size_t>(id)](req);
+    }
+    if (routePathKnown(path)) {
+        return timedError<&methodNotAllowedHandler>(req, HTTPD_405_METHOD_NOT_ALLOWED);
+    }
+    return timedError<&notFoundHandler>(req, HTTPD_404_NOT_FOUND);
+}
+
+/// StorageStats -> the storage DTO shared by /status and /metrics.
+StorageStatsDto storageDto(const StorageStats& stats)
+{
+    StorageStatsDto dto;
+    dto.totalBytes = stats.totalBytes;
+    dto.usedBytes = stats.usedBytes;
+    dto.percentUsed =
+        stats.totalBytes != 0
+            ? (100.0f * static_cast<float>(stats.usedBytes) /
+               static_cast<float>(stats.totalBytes))
+            : 0.0f;
+    dto.writes.bytesAppended = stats.writes.bytesAppended;
+    dto.writes.syncs = stats.writes.syncs;
+    dto.writes.filesCreated = stats.writes.filesCreated;
+    dto.writes.filesRemoved = stats.writes.filesRemoved;
+    dto.writes.tornRepairs = stats.writes.tornRepairs;
+    dto.writes.rotations = stats.writes.rotations;
+    dto.writes.appendUs = stats.writes.appendUs;
+    return dto;
+}
+
+}  // namespace
+
+ApiServer::~ApiServer()
+{
+    stop();
+}
+
+std::string ApiServer::deviceIp() const
+{
+    esp_netif_t* nif = esp_netif_get_handle_from_ifkey("WIFI_STA_DEF");
     esp_netif_ip_info_t ip_info;
     if (nif != nullptr && esp_netif_get_ip_info(nif, &ip_info) == ESP_OK) {
         char buf[16];
         esp_ip4addr_ntoa(&ip_info.ip, buf, sizeof buf);
         return std::string(buf);
     }
-    return std::string();
+    return std::string();
+}
+
+std::string ApiServer::statusBody()
+{
+    // Generation first: a write racing the build leaves the entry under the
+    // older key, so the next request misses rather than serving it stale.
+    const uint32_t generation = config_.generation();
+    const int64_t now = uptime_.nowMs();
+    std::string body;
+    std::string etag;
+    if (!cache_.get(ResponseCache::Slot::Status, generation, now, body, etag)) {
+        body = buildStatusBody();
+        cache_.put(ResponseCache::Slot::Status, generation, now, body, "");
+    }
+    return body;
+}
+
+std::string ApiServer::buildStatusBody()
+{
+    return renderBody(readStatus(readPower()), &serializeStatusInto, &serializeStatus);
+}
+
+SystemStatusDto ApiServer::readStatus(const std::optional<PowerDto>& power, uint32_t fields)
+{
+    SystemStatusDto dto;
+    dto.fields = fields;
+    const auto selected = [fields](uint32_t bit) { return (fields & bit) != 0; };
+
+    // Mode is the automatic-watering flag (parity: manual == automatic OFF).
+    if (selected(kStatusMode)) {
+        dto.mode = config_.getWateringEnabled() ? "automatic" : "manual";
+    }
+
+    // Wifi: one consistent snapshot; the SSID is not a secret (the password is
+    // never represented). The IP comes from esp_netif, target-only.
+    if (selected(kStatusWifi)) {
+        const WifiConnectionSnapshot snap = wifi_.snapshot();
+        dto.wifi.state = wifiStateName(snap.state);
+        dto.wifi.rssi = snap.rssi;
+        dto.wifi.ssid = config_.getWifiSsid();
+        dto.wifi.connected = (snap.state == WifiState::Connected);
+        dto.wifi.ipAcquired = snap.ipAcquired;
+        dto.wifi.ip = deviceIp();
+        dto.wifi.powerSave = wifiPowerSaveName(snap.powerSave);
+    }
+
+    // Time: a not-set clock reports synced=false with no bogus 1970 epoch/local.
+    if (selected(kStatusTime)) {
+        const WallTime wall = wallClock_.now();
+        dto.time.synced = wall.set;
+        if (dto.time.synced) {
+            const uint32_t epoch = wall.epoch;
+            dto.time.epoch = static_cast<int64_t>(epoch);
+            dto.time.local = TimeService::formatLocal(epoch);
+        }
+        dto.time.lastSync = static_cast<int64_t>(sntp_.status().lastSyncEpoch);
+    }
+
+    if (selected(kStatusUptime)) {
+        dto.uptimeMs = static_cast<uint64_t>(uptime_.nowMs());
+    }
+    if (selected(kStatusResetReason)) {
+        dto.resetReason = resetReasonName(static_cast<int>(esp_reset_reason()));
+    }
+
+    const esp_app_desc_t* desc = selected(kStatusFirmware) ? esp_app_get_description() : nullptr;
+    if (desc != nullptr) {
+        dto.firmware.version = desc->version;
+        dto.firmware.project = desc->project_name;
+    }
+
+    // The filesystem walk behind the stats is the costly read here.
+    if (selected(kStatusStorage)) {
+        dto.storage = storageDto(storage_.getStorageStats());
+    }
+
+    dto.hasPower = power.has_value();
+    dto.power = power.value_or(PowerDto{});
+
+    if (bootProfile_ != nullptr && selected(kStatusBoot)) {
+        dto.boot.reserve(kBootPhaseCount);
+        for (std::size_t i = 0; i < kBootPhaseCount; ++i) {
+            const BootPhase phase = static_cast<BootPhase>(i);
+            dto.boot.push_back(BootPhaseDto{bootPhaseName(phase),
+                                            bootProfile_->atUs(phase)});
+        }
+    }
+    return dto;
+}
+
+SensorReadingsDto ApiServer::readSensors()
+{
+    return readSensors(readPower());
+}
+
+SensorReadingsDto ApiServer::readSensors(const std::optional<PowerDto>& power,
+                                         uint32_t fields)
+{
+    SensorReadingsDto dto;
+    dto.fields = fields;
+    const auto selected = [fields](uint32_t bit) { return (fields & bit) != 0; };
+
+    // Environmental: kept fresh by the 5 s sensor task's read().
+    if (selected(kSensorsEnvironmental)) {
+        const EnvSnapshot env = env_.snapshot();
+        dto.environmental.temperature = env.temperature;
+        dto.environmental.humidity = env.humidity;
+        dto.environmental.pressure = env.pressure;
+        dto.environmental.valid = cachedValid(env.lastError, env.temperature);
+    }
+
+    // Soil: the cached values of the periodic reader (the soil task).
+    if (selected(kSensorsSoil)) {
+        dto.soil = soilDto(soil_);
+    }
+    if (soilProbes_ != nullptr && selected(kSensorsSoilProbes)) {
+        // Multi-drop: every probe's cache, read by the poll scheduler.
+        for (std::size_t i = 0; i < soilProbes_->size(); ++i) {
+            dto.soilProbes.push_back(SoilProbeDto{soilProbes_->address(i),
+                                                  soilDto(soilProbes_->sensor(i))});
+        }
+        const SoilBusUsage usage = soilProbes_->usage();
+        dto.soilBus = SoilBusDto{usage.periodMs,         usage.readAirtimeUs,
+                                 usage.budgetPermille,   usage.measuredPermille,
+                                 usage.polls,            usage.failures,
+                                 usage.missed};
+    }
+
+    // Level: kept fresh by the 10 Hz main-loop update(); isWaterPresent() is
+    // meaningful only while isValid() (a not-yet-valid mark is never wet/dry).
+    if (selected(kSensorsLevel)) {
+        dto.level.low.valid = levelLow_.isValid();
+        dto.level.low.waterPresent = levelLow_.isWaterPresent();
+        dto.level.high.valid = levelHigh_.isValid();
+        dto.level.high.waterPresent = levelHigh_.isWaterPresent();
+    }
+
+    dto.hasPower = power.has_value();
+    dto.power = power.value_or(PowerDto{});
+
+    // Top-level timestamp: JSON null when the clock is not set (no bogus 1970).
+    const WallTime wall = selected(kSensorsTimestamp) ? wallClock_.now() : WallTime{};
+    if (wall.set) {
+        dto.hasTimestamp = true;
+        dto.timestamp = static_cast<int64_t>(wall.epoch);
+    }
+
+    return dto;
+}
+
+std::string ApiServer::statusBody(const FieldSelection& selection)
+{
+    // A projection is read on demand and never cached: the status cache
+    // holds the one full body.
+    const std::optional<PowerDto> power =
+        (selection.members & kStatusPower) != 0 ? readPower() : std::nullopt;
+    const SystemStatusDto status = readStatus(power, selection.members);
+    if (selection.keys.empty()) {
+        return renderBody(status, &serializeStatusInto, &serializeStatus);
+    }
+    return serializeStatus(status, selection.keys);
+}
+
+std::string ApiServer::sensorsBody(const FieldSelection& selection)
+{
+    const std::optional<PowerDto> power =
+        (selection.members & kSensorsPower) != 0 ? readPower() : std::nullopt;
+    const SensorReadingsDto readings = readSensors(power, selection.members);
+    if (selection.keys.empty()) {
+        return renderBody(readings, &serializeSensorsInto, &serializeSensors);
+    }
+    return serializeSensors(readings, selection.keys);
+}
+
+std::string ApiServer::sensorsETag(const SensorReadingsDto& readings) const
+{
+    return formatETag(etagSalt_, sensorsFingerprint(readings), true);
+}
+
+bool ApiServer::cachedSensors(std::string& body, std::string& etag) const
+{
+    return cache_.get(ResponseCache::Slot::Sensors, 0, uptime_.nowMs(), body,
+                      etag);
+}
+
+void ApiServer::cacheSensors(const std::string& body, const std::string& etag)
+{
+    cache_.put(ResponseCache::Slot::Sensors, 0, uptime_.nowMs(), body, etag);
+}
+
+std::optional<PowerDto> ApiServer::readPower()
+{
+#if BOARD_HAS_INA226
+    PowerDto power;
+    const PowerSnapshot snap = power_.snapshot();
+    power.busVoltage = snap.busVoltage;
+    power.current = snap.current;
+    power.power = snap.power;
+    power.valid = cachedValid(snap.lastError, snap.busVoltage);
+    return power;
+#else
+    // rev1 has no INA226 code at all.
+    return std::nullopt;
+#endif
+}
+
+std::string ApiServer::buildPowerBody()
+{
+    std::optional<PowerDto> power = readPower();
+    if (!power.has_value()) {
+        return serializePowerUnavailable();  // rev1: the not-available shape
+    }
+    if (energyMeter_ != nullptr) {
+        // The dedicated body only: /status, /sensors and /snapshot keep the
+        // bare telemetry object.
+        const EnergyTotals t = energyMeter_->load();
+        EnergyDto& e = power->energy;
+        power->hasEnergy = true;
+        e.totalWh = t.totalWh;
+        e.dayWh = t.dayWh;
+        e.dayStart = t.dayStart;
+        e.previousDayWh = t.previousDayWh;
+        e.previousDayStart = t.previousDayStart;
+        e.runActive = t.runActive;
+        e.runWh = t.runWh;
+        e.runMs = t.runMs;
+        e.lastRunWh = t.lastRunWh;
+        e.lastRunMs = t.lastRunMs;
+        e.lastRunStart = t.lastRunStart;
+        e.runs = t.runs;
+        e.uncoveredMs = t.uncoveredMs;
+    }
+    return renderBody(*power, &serializePowerInto, &serializePower);
+}
+
+IWaterPump* ApiServer::pumpByName(const std::string& name)
+{
+    if (name == "plant") {
+        return &plantPump_;
+    }
+#if BOARD_HAS_RESERVOIR_PUMP
+    if (name == "reservoir") {
+        return &reservoirPump_;
+    }
+#endif
+    for (std::size_t i = 0; i < zonePumpCount_; ++i) {
+        if (name == zonePumps_[i]->getName()) {
+            return zonePumps_[i];
+        }
+    }
+    return nullptr;
+}
+
+std::vector<PumpDto> ApiServer::readPumps()
+{
+    // Capability-enumerated: the reservoir pump exists on rev1 only.
+    std::vector<PumpDto> pumps;
+    pumps.push_back(makePumpDto(plantPump_));
+#if BOARD_HAS_RESERVOIR_PUMP
+    pumps.push_back(makePumpDto(reservoirPump_));
+#endif
+    for (std::size_t i = 0; i < zonePumpCount_; ++i) {
+        pumps.push_back(makePumpDto(*zonePumps_[i]));
+    }
+    return pumps;
+}
+
+SnapshotDto ApiServer::readSnapshot(uint32_t fields)
+{
+    // One getter pass for the whole refresh: the power block, shown in
+    // three sections, is read once, so they can never disagree.
+    SnapshotDto dto;
+    dto.fields = fields;
+    const std::optional<PowerDto> power = readPower();
+    if ((fields & kSnapshotStatus) != 0) {
+        dto.status = readStatus(power);
+    }
+    if ((fields & kSnapshotSensors) != 0) {
+        dto.sensors = readSensors(power);
+    }
+    if ((fields & kSnapshotPumps) != 0) {
+        dto.pumps = readPumps();
+    }
+    dto.hasPower = power.has_value();
+    dto.power = power.value_or(PowerDto{});
+    return dto;
+}
+
+std::string ApiServer::pumpsETag(const std::vector<PumpDto>& pumps) const
+{
+    return formatETag(etagSalt_, pumpsFingerprint(pumps));
+}
+
+ApiResponse ApiServer::applyPumpCommand(const std::string& name, std::string_view body)
+{
+    IWaterPump* pump = pumpByName(name);
+    if (pump == nullptr) {
+        return {ApiStatus::NotFound, errorBody("unknown pump")};
+    }
+
+    const PumpCommandResult parsed = parsePumpCommand(body);
+    if (!parsed.ok) {
+        return {ApiStatus::BadRequest, errorBody(parsed.error)};
+    }
+
+    switch (parsed.command.action) {
+    case PumpAction::Start:
+    case PumpAction::Run: {
+        // durationS is guaranteed present and in 1..300 by the pure parser; the
+        // pump's own runFor() re-enforces the hard cap and the no-restart rule —
+        // the server makes no watering decision. A false result here means the
+        // pump is already running (its clock is NOT restarted): an explicit 409.
+        const int durationS = static_cast<int>(parsed.command.durationS.value());
+        if (!pump->runFor(durationS)) {
+            return {ApiStatus::Conflict, errorBody("pump already running")};
+        }
+        break;
+    }
+    case PumpAction::Stop:
+        // Idempotent: stopping an already-stopped pump is a success no-op.
+        pump->stop();
+        break;
+    }
+
+    return {ApiStatus::Ok, renderBody(makePumpDto(*pump), &serializePumpInto, &serializePump)};
+}
+
+ApiResponse ApiServer::buildPumpUsageResponse(std::string_view name)
+{
+    PumpUsage::Report report;
+    if (pumpUsage_ == nullptr || !pumpUsage_->report(name, report)) {
+        return {ApiStatus::NotFound, errorBody("unknown pump")};
+    }
+    PumpUsageDto dto;
+    dto.name.assign(name.data(), name.size());
+    dto.timed = report.timed;
+    dto.untimedRuns = report.untimedRuns;
+    if (report.timed) {
+        const auto copy = [](const auto& ring, std::vector<PumpUsageBucketDto>& out) {
+            out.reserve(ring.size());
+            for (const PumpUsageBucket& b : ring) {
+                out.push_back(PumpUsageBucketDto{b.start, b.runMs, b.starts});
+            }
+        };
+        copy(report.hours, dto.hours);
+        copy(report.days, dto.days);
+    }
+    return {ApiStatus::Ok, serializePumpUsage(dto)};
+}
+
+std::string ApiServer::buildConfigBody()
+{
+    // One snapshot: the body never mixes items from before and after a
+    // concurrent PUT.
+    const ConfigSnapshot config = config_.snapshot();
+    ConfigDto dto;
+    dto.moistureThresholdLow = config.moistureThresholdLow;
+    dto.moistureThresholdHigh = config.moistureThresholdHigh;
+    dto.wateringDurationS = config.wateringDurationS;
+    dto.minWateringIntervalS = config.minWateringIntervalS;
+    dto.wateringEnabled = config.wateringEnabled;
+    dto.sensorReadIntervalMs = config.sensorReadIntervalMs;
+    dto.dataLogIntervalMs = config.dataLogIntervalMs;
+    for (MetricId id = 0; id < metric::kKnownCount; ++id) {
+        const MetricLogPolicy& policy = config.logPolicies[id];
+        dto.logPolicies.push_back(LogPolicyDto{metric::knownName(id),
+                                               policy.deadbandAbs,
+                                               policy.deadbandRel,
+                                               policy.heartbeatS});
+    }
+    // The wifi password is deliberately absent (ConfigDto carries no such field).
+    return serializeConfig(dto);
+}
+
+std::string ApiServer::configBody()
+{
+    const uint32_t generation = config_.generation();  // before the build
+    std::string body;
+    std::string etag;
+    if (!cache_.get(ResponseCache::Slot::Config, generation, 0, body, etag)) {
+        body = buildConfigBody();
+        cache_.put(ResponseCache::Slot::Config, generation, 0, body, "");
+    }
+    return body;
+}
+
+std::string ApiServer::configETag() const
+{
+    return formatETag(etagSalt_, config_.generation());
+}
+
+ApiResponse ApiServer::applyConfigSet(std::string_view body)
+{
+    const ConfigSetResult parsed = parseConfigSet(body);
+    if (!parsed.ok) {
+        return {ApiStatus::BadRequest, errorBody(parsed.error)};
+    }
+
+    // All-or-nothing was validated in the pure parser (nothing is marked to
+    // apply when it rejects). The accepted fields go to the store as ONE
+    // patch (NvsConfigStore: one handle, one commit); a false here is an
+    // unexpected persistence failure on already-validated values
+    // (out-of-range was ruled out) -> 500.
+    if (!config_.apply(toConfigPatch(parsed.request))) {
+        ESP_LOGE(TAG, "config persist failed");
+        return {ApiStatus::InternalError,
+                errorBody("failed to persist configuration")};
+    }
+
+    return {ApiStatus::Ok, configBody()};
+}
+
+bool ApiServer::resolveHistoryQuery(const HistoryQuery& query, uint32_t& t0,
+                                    uint32_t& t1, ApiResponse& error)
+{
+    // metric is required — the storage layer is keyed by it.
+    if (query.metric.empty()) {
+        error = {ApiStatus::BadRequest, errorBody("metric is required")};
+        return false;
+    }
+
+    const uint32_t now = wallClock_.nowEpoch();
+
+    // Window resolution is pure (range precedence over explicit start/end, else
+    // the last 24 h; underflow-clamped). An unknown named range is a client
+    // error.
+    std::optional<uint32_t> start;
+    std::optional<uint32_t> end;
+    if (query.start.has_value()) {
+        start = static_cast<uint32_t>(*query.start);
+    }
+    if (query.end.has_value()) {
+        end = static_cast<uint32_t>(*query.end);
+    }
+    const WindowResult window = resolveWindow(query.range, start, end, now);
+    if (!window.ok) {
+        error = {ApiStatus::BadRequest, errorBody("unknown range")};
+        return false;
+    }
+    t0 = window.t0;
+    t1 = window.t1;
+    return true;
+}
+
+uint32_t ApiServer::logHeartbeatS(const std::string& metricName)
+{
+    if (const DerivedMetric* derived = findDerivedMetric(metricName)) {
+        return std::max(logHeartbeatS(derived->a), logHeartbeatS(derived->b));
+    }
+    const MetricId id = metric::findKnown(metricName);
+    return id != metric::kInvalid ? config_.getMetricLogPolicy(id).heartbeatS : 0;
+}
+
+DerivedMetricStorage ApiServer::historyStorage()
+{
+    // An input joins for as long as its history may go without a reading:
+    // one data-log interval, or its change-only heartbeat.
+    uint32_t holdS = config_.getDataLogIntervalMs() / 1000;
+    for (const DerivedMetric& derived : kDerivedMetrics) {
+        holdS = std::max(holdS, logHeartbeatS(derived.name));
+    }
+    return DerivedMetricStorage(storage_, holdS);
+}
+
+bool ApiServer::streamHistorySeries(const HistoryQuery& query,
+                                    const std::string& metricName, uint32_t t0,
+                                    uint32_t t1, IChunkSink& sink, bool member)
+{
+    HistorySeries series;
+    series.metric = metricName;
+    series.reading = query.reading;  // echoed only; storage is keyed by metric
+    series.start = static_cast<int64_t>(t0);
+    series.end = static_cast<int64_t>(t1);
+
+    // A change-only metric's steady stretches were never logged; the stream
+    // holds the last value across them rather than let the chart interpolate.
+    const uint32_t heartbeatS = logHeartbeatS(metricName);
+    const DerivedMetricStorage history = historyStorage();
+
+    // Non-blocking filesystem read (no bus access). An empty result is a 200
+    // with empty arrays — a window with no data is a success, not an error.
+    // A window too long for the point budget at the data-log cadence is
+    // answered per bucket (from the storage's rollup tiers when it keeps
+    // them) instead of as every raw reading — or, for agg=minmax/lttb, as
+    // the real readings a reducer keeps.
+    const uint32_t logIntervalS = config_.getDataLogIntervalMs() / 1000;
+    const std::size_t maxPoints = resolveHistoryMaxPoints(query.maxPoints);
+    series.bucketS = selectHistoryBucket(t0, t1, logIntervalS, maxPoints);
+    bool reduced = false;
+    if (series.bucketS != 0 && query.aggregate != HistoryAggregate::Avg) {
+        // The estimate says too many: the reducer counts for real, and a
+        // window that turns out to fit (a change-only metric) goes raw.
+        series.bucketS = 0;
+        reduced = downsampleHistory(history, series, query.aggregate, maxPoints);
+    }
+    if (reduced) {
+        return streamHistory(series, sink, query.format, member);
+    }
+    if (series.bucketS == 0) {
+        // Straight from the chunk files into the response: no reading is
+        // collected, so the window length costs no heap.
+        return streamRawHistory(history, series, logIntervalS, heartbeatS,
+                                sink, query.format, member);
+    }
+    // At most ~maxPoints buckets: collected, then streamed.
+    const std::vector<SensorAggregate> buckets =
+        history.getSensorAggregates(metricName, t0, t1, series.bucketS);
+    series.timestamps.reserve(buckets.size());
+    series.values.reserve(buckets.size());
+    series.mins.reserve(buckets.size());
+    series.maxs.reserve(buckets.size());
+    for (const SensorAggregate& b : buckets) {
+        series.timestamps.push_back(static_cast<int64_t>(b.epoch));
+        series.values.push_back(b.sum / static_cast<float>(b.count));
+        series.mins.push_back(b.min);
+        series.maxs.push_back(b.max);
+    }
+    stepFillHistory(series, logIntervalS, heartbeatS);
+    return streamHistory(series, sink, query.format, member);
+}
+
+ApiResponse ApiServer::streamHistoryResponse(const HistoryQuery& query,
+                                             IChunkSink& sink)
+{
+    uint32_t t0 = 0;
+    uint32_t t1 = 0;
+    ApiResponse error{};
+    if (!resolveHistoryQuery(query, t0, t1, error)) {
+        return error;
+    }
+    std::vector<std::string> metrics;
+    if (!splitHistoryMetrics(query.metric, metrics)) {
+        return {ApiStatus::BadRequest, errorBody("invalid metric list")};
+    }
+
+    bool streamed = false;
+    if (query.last.has_value()) {
+        // The newest readings, however old: no window to guess, and the
+        // storage reads them from the newest chunk back.
+        if (metrics.size() != 1) {
+            return {ApiStatus::BadRequest, errorBody("last takes one metric")};
+        }
+        if (query.range.has_value() || query.start.has_value() || query.end.has_value() ||
+            query.limit.has_value() || query.cursor.has_value() || query.node.has_value()) {
+            return {ApiStatus::BadRequest, errorBody("last takes no window")};
+        }
+        HistorySeries series;
+        series.metric = metrics[0];
+        series.reading = query.reading;
+        for (const SensorReading& r :
+             historyStorage().getLatestReadings(metrics[0],
+                                                resolveHistoryPageLimit(query.last))) {
+            series.timestamps.push_back(static_cast<int64_t>(r.epoch));
+            series.values.push_back(r.value);
+        }
+        if (!series.timestamps.empty()) {
+            series.start = series.timestamps.front();
+            series.end = series.timestamps.back();
+        }
+        streamed = streamHistory(series, sink, query.format);
+    } else if (query.node.has_value()) {
+        // A leaf's readings live in the gateway's RAM ring: a short raw
+        // series, collected then streamed like any other.
+        if (nodeGateway_ == nullptr) {
+            return {ApiStatus::NotFound, errorBody("not a node gateway")};
+        }
+        if (metrics.size() != 1) {
+            return {ApiStatus::BadRequest, errorBody("node history takes one metric")};
+        }
+        if (query.limit.has_value() || query.cursor.has_value()) {
+            return {ApiStatus::BadRequest, errorBody("node history does not page")};
+        }
+        HistorySeries series;
+        series.metric = metrics[0];
+        series.reading = query.reading;
+        series.start = static_cast<int64_t>(t0);
+        series.end = static_cast<int64_t>(t1);
+        if (!nodeGateway_->history(*query.node, metric::findKnown(metrics[0]), t0,
+                                   t1, series)) {
+            return {ApiStatus::NotFound, errorBody("unknown node")};
+        }
+        streamed = streamHistory(series, sink, query.format);
+    } else if (query.limit.has_value() || query.cursor.has_value()) {
+        // A page carries one resume point, in the JSON echo: one metric,
+        // and no binary (its records run to the end of the body).
+        if (metrics.size() != 1) {
+            return {ApiStatus::BadRequest, errorBody("paging takes one metric")};
+        }
+        if (query.format == HistoryFormat::Binary) {
+            return {ApiStatus::BadRequest, errorBody("format=bin does not page")};
+        }
+        ReadingCursor cursor;
+        if (query.cursor.has_value() && !parseReadingCursor(*query.cursor, cursor)) {
+            return {ApiStatus::BadRequest, errorBody("invalid cursor")};
+        }
+        HistorySeries echo;
+        echo.metric = metrics[0];
+        echo.reading = query.reading;
+        echo.start = static_cast<int64_t>(t0);
+        echo.end = static_cast<int64_t>(t1);
+        streamed = streamHistoryPage(historyStorage(), echo, cursor,
+                                     resolveHistoryPageLimit(query.limit), sink);
+    } else if (metrics.size() == 1) {
+        streamed = streamHistorySeries(query, metrics[0], t0, t1, sink, false);
+    } else if (query.format == HistoryFormat::Binary) {
+        // Binary records run to the end of the body: one series per body.
+        return {ApiStatus::BadRequest, errorBody("format=bin takes one metric")};
+    } else {
+        // One window, one envelope: each member is the single-metric body
+        // without its `success` key, streamed the same way in turn.
+        JsonStreamWriter out(sink);
+        out.raw("{\"success\":true,\"series\":[");
+        streamed = out.flush();
+        for (std::size_t i = 0; streamed && i < metrics.size(); ++i) {
+            if (i > 0) {
+                out.raw(",");
+            }
+            streamed = out.flush() &&
+                       streamHistorySeries(query, metrics[i], t0, t1, sink, true);
+        }
+        if (streamed) {
+            out.raw("]}");
+            streamed = out.flush();
+        }
+    }
+
+    if (!streamed) {
+        return {ApiStatus::InternalError, errorBody("history read interrupted")};
+    }
+    return {ApiStatus::Ok, ""};
+}
+
+ApiResponse ApiServer::buildHistoryStatsResponse(const HistoryQuery& query)
+{
+    uint32_t t0 = 0;
+    uint32_t t1 = 0;
+    ApiResponse error{};
+    if (!resolveHistoryQuery(query, t0, t1, error)) {
+        return error;
+    }
+    if (query.node.has_value()) {
+        return {ApiStatus::BadRequest, errorBody("node history has no stats")};
+    }
+
+    // One streaming pass inside the storage (non-blocking filesystem read);
+    // an empty window is a 200 with count 0.
+    const DerivedMetricStorage history = historyStorage();
+    const SensorWindowStats window = history.getSensorWindowStats(query.metric, t0, t1);
+    HistoryStatsDto stats;
+    stats.metric = query.metric;
+    stats.reading = query.reading;  // echoed only, as in /history
+    stats.start = static_cast<int64_t>(t0);
+    stats.end = static_cast<int64_t>(t1);
+    stats.count = window.count;
+    stats.min = window.min;
+    stats.max = window.max;
+    stats.mean = window.mean;
+    stats.last = window.last;
+    stats.lastTimestamp = static_cast<int64_t>(window.lastEpoch);
+    // A second pass for the percentiles: a sketch merge over the rollup
+    // tiers when the storage keeps them, a raw fold otherwise.
+    if (window.count != 0) {
+        const QuantileSketch sketch = history.getSensorQuantiles(query.metric, t0, t1);
+        stats.percentiles = sketch.count() != 0;
+        stats.p5 = sketch.quantile(0.05);
+        stats.p50 = sketch.quantile(0.50);
+        stats.p95 = sketch.quantile(0.95);
+    }
+    return {ApiStatus::Ok, serializeHistoryStats(stats)};
+}
+
+ApiResponse ApiServer::streamHistorySyncResponse(const std::optional<std::string>& since,
+                                                 std::optional<uint32_t> limit,
+                                                 IChunkSink& sink)
+{
+    HistorySyncMarks marks{};
+    if (since.has_value() && !parseSyncToken(*since, marks)) {
+        return {ApiStatus::BadRequest, errorBody("invalid since")};
+    }
+    const WallTime wall = wallClock_.now();
+    const uint32_t now = wall.set ? wall.epoch : 0;
+    if (!streamHistorySync(storage_, marks, resolveHistorySyncLimit(limit), now, sink)) {
+        return {ApiStatus::InternalError, errorBody("history sync interrupted")};
+    }
+    return {ApiStatus::Ok, ""};
+}
+
+ApiResponse ApiServer::streamCsvExportResponse(const HistoryQuery& query,
+                                               IChunkSink& sink, uint32_t& rows)
+{
+    uint32_t t0 = 0;
+    uint32_t t1 = 0;
+    ApiResponse error{};
+    if (!resolveHistoryQuery(query, t0, t1, error)) {
+        return error;
+    }
+    std::vector<std::string> metrics;
+    if (!splitHistoryMetrics(query.metric, metrics)) {
+        return {ApiStatus::BadRequest, errorBody("invalid metric list")};
+    }
+    // Rows are produced on the read-ahead task while the previous buffer
+    // goes out here; without it, one after the other.
+    const DerivedMetricStorage history = historyStorage();
+    CsvExportSource source(history, metrics, t0, t1);
+    uint8_t buf[1024];
+    const PumpOutcome outcome = readAhead_ != nullptr
+                                    ? readAhead_->pump(source, sink, buf, sizeof(buf))
+                                    : copyChunks(source, sink, buf, sizeof(buf));
+    rows = source.rows();
+    if (outcome != PumpOutcome::Ok) {
+        return {ApiStatus::InternalError, errorBody("export interrupted")};
+    }
+    return {ApiStatus::Ok, ""};
+}
+
+ApiResponse ApiServer::buildNodesResponse()
+{
+    if (nodeGateway_ == nullptr) {
+        return {ApiStatus::NotFound, errorBody("not a node gateway")};
+    }
+    // lastSeenS is against the uptime the node task ticks the gateway with.
+    const auto nowMs = static_cast<uint32_t>(uptime_.nowMs());
+    return {ApiStatus::Ok, serializeNodes(nodeGateway_->nodes(nowMs))};
+}
+
+ApiResponse ApiServer::buildLogsResponse()
+{
+    if (logTail_ == nullptr) {
+        return {ApiStatus::NotFound, errorBody("log sink not enabled")};
+    }
+    LogsDto dto;
+    logTail_->copy(dto.lines);
+    dto.dropped = logTail_->dropped();
+    return {ApiStatus::Ok, serializeLogs(dto)};
+}
+
+ApiResponse ApiServer::buildEventSummaryResponse(uint32_t hours)
+{
+    if (eventCounts_ == nullptr) {
+        return {ApiStatus::NotFound, errorBody("event counts not available")};
+    }
+    const EventCountSummary counts = eventCounts_->summary(wallClock_.nowEpoch(), hours);
+    EventSummaryDto dto;
+    dto.hours = counts.hours;
+    dto.since = counts.since;
+    // Every named category, even at zero; others only when they occurred.
+    for (std::size_t c = 0; c < counts.counts.size(); ++c) {
+        const char* name = eventCategoryName(static_cast<int>(c));
+        if (name == nullptr && counts.counts[c] == 0) {
+            continue;
+        }
+        EventCategoryCountDto entry;
+        entry.category = static_cast<int>(c);
+        if (name != nullptr) {
+            entry.categoryName = name;
+        }
+        entry.count = counts.counts[c];
+        dto.categories.push_back(std::move(entry));
+    }
+    return {ApiStatus::Ok, serializeEventSummary(dto)};
+}
+
+std::string ApiServer::buildEventsBody(const EventQuery& query)
+{
+    // Non-blocking: the event log lives on the filesystem. The filter runs
+    // inside the storage (one pass, newest-first, stops at the page size);
+    // eventDtos() adds the category names and renders the details.
+    const EventPage page = storage_.queryEvents(query);
+    std::optional<std::string> next;
+    if (page.more) {
+        next = formatEventCursor(page.next);
+    }
+    return serializeEvents(eventDtos(page.events), next);
+}
+
+std::optional<std::string> ApiServer::buildEventTailBody(const EventWait& wait, bool always)
+{
+    // One query from the cursor's epoch on (api/EventTail.h); the log's
+    // newest end, so it reads the last block or two.
+    EventTail tail = resolveEventTail(
+        storage_.queryEvents(eventTailQuery(wait.after, wait.categoryMask, wait.count)),
+        wait.after, wait.count);
+    if (tail.events.empty() && !always) {
+        return std::nullopt;
+    }
+    return serializeEventTail(eventDtos(tail.events), formatEventCursor(tail.tail),
+                              tail.truncated);
+}
+
+std::string ApiServer::buildSelfTestBody()
+{
+    // DOCUMENTED QUIRK-5 EXCEPTION: unlike every other handler, the self-test
+    // deliberately issues a real bus read() on each sensor. It is bounded (one
+    // attempt per sensor, no retry — the drivers do not loop) and runs on the
+    // selftest worker, off the 10 Hz watering loop and the httpd task; the
+    // injected Locked* wrappers serialize each read() with the other bus
+    // users, so a concurrent console or sensor-task read is never corrupted.
+    // No watering decision is made.
+    //
+    // The checks are on independent buses, so they run side by side
+    // (SelfTestRunner.h): the I2C one on this task, the soil round trip on
+    // the helper; a run takes the slower of the two, not their sum.
+    ISelfTestCheck* checks[] = {&envCheck_, &soilCheck_};
+    const SelfTestResultDto result =
+        selfTestRunner_.run(checks, sizeof(checks) / sizeof(checks[0]),
+                            kSelfTestDeadlineMs);
+    return serializeSelfTest(result);
+}
+
+bool ApiServer::claimSelfTest()
+{
+    return !selfTestBusy_.exchange(true);
+}
+
+void ApiServer::releaseSelfTest()
+{
+    selfTestBusy_.store(false);
+}
+
+bool ApiServer::deferSelfTest(void* asyncReq)
+{
+    QueueHandle_t queue = static_cast<QueueHandle_t>(selfTestQueue_);
+    return queue != nullptr && xQueueSend(queue, &asyncReq, 0) == pdTRUE;
+}
+
+bool ApiServer::serveSelfTest(uint32_t waitMs)
+{
+    QueueHandle_t queue = static_cast<QueueHandle_t>(selfTestQueue_);
+    if (queue == nullptr) {
+        // Not started yet (the server starts on the first WiFi connect).
+        vTaskDelay(pdMS_TO_TICKS(waitMs));
+        return false;
+    }
+    httpd_req_t* asyncReq = nullptr;
+    if (xQueueReceive(queue, &asyncReq, pdMS_TO_TICKS(waitMs)) != pdTRUE) {
+        return false;
+    }
+    // Counted here rather than by the handler's wrapper, which saw it only
+    // detached; the time is the worker's run.
+    RequestTally tally;
+    tTally = &tally;
+    const int64_t startUs = esp_timer_get_time();
+    answerSelfTest(*this, asyncReq);
+    tTally = nullptr;
+    recordRequest(this, metricSlot(HandlerId::SelfTest), tally, ESP_OK, startUs);
+    return true;
+}
+
+uint32_t ApiServer::eventGeneration() const
+{
+    return eventNotifier_ != nullptr ? eventNotifier_->generation() : 0;
+}
+
+bool ApiServer::claimEventWait()
+{
+    uint32_t held = eventWaitsHeld_.load();
+    do {
+        if (held >= kEventWaiters) {
+            return false;
+        }
+    } while (!eventWaitsHeld_.compare_exchange_weak(held, held + 1));
+    return true;
+}
+
+void ApiServer::releaseEventWait()
+{
+    eventWaitsHeld_.fetch_sub(1);
+}
+
+bool ApiServer::deferEventWait(const EventWait& wait)
+{
+    QueueHandle_t queue = static_cast<QueueHandle_t>(eventWaitQueue_);
+    return queue != nullptr && xQueueSend(queue, &wait, 0) == pdTRUE;
+}
+
+bool ApiServer::serveEventWaits(uint32_t waitMs)
+{
+    QueueHandle_t queue = static_cast<QueueHandle_t>(eventWaitQueue_);
+    if (queue == nullptr || eventNotifier_ == nullptr) {
+        // Not started yet (the server starts on the first WiFi connect).
+        vTaskDelay(pdMS_TO_TICKS(waitMs));
+        return false;
+    }
+    // Take the new holds; block on the queue only while nothing is held.
+    // A claim precedes every entry, so a free slot is always there.
+    std::size_t held = 0;
+    for (const EventWait& wait : eventWaits_) {
+        held += wait.asyncReq != nullptr ? 1 : 0;
+    }
+    EventWait incoming;
+    while (xQueueReceive(queue, &incoming, held == 0 ? pdMS_TO_TICKS(waitMs) : 0) == pdTRUE) {
+        for (EventWait& slot : eventWaits_) {
+            if (slot.asyncReq == nullptr) {
+                slot = incoming;
+                ++held;
+                break;
+            }
+        }
+    }
+    if (held == 0) {
+        return false;
+    }
+
+    // Read again only for a hold whose last read predates an event; answer
+    // one with something new, or whose deadline passed.
+    const uint32_t generation = eventNotifier_->generation();
+    const int64_t nowUs = esp_timer_get_time();
+    int64_t nearestUs = INT64_MAX;
+    for (EventWait& wait : eventWaits_) {
+        if (wait.asyncReq == nullptr) {
+            continue;
+        }
+        const bool expired = nowUs >= wait.deadlineUs;
+        if (wait.generation != generation || expired) {
+            wait.generation = generation;
+            const std::optional<std::string> body = buildEventTailBody(wait, expired);
+            if (body.has_value()) {
+                // Counted here, as the self-test is; the time is the answer,
+                // not the hold.
+                RequestTally tally;
+                tTally = &tally;
+                const int64_t startUs = esp_timer_get_time();
+                finishEventWait(*this, wait, *body);
+                tTally = nullptr;
+                recordRequest(this, metricSlot(HandlerId::Events), tally, ESP_OK, startUs);
+                continue;
+            }
+        }
+        nearestUs = std::min(nearestUs, wait.deadlineUs);
+    }
+    if (nearestUs == INT64_MAX) {
+        return false;
+    }
+    const int64_t untilMs = (nearestUs - nowUs + 999) / 1000;
+    eventNotifier_->waitPast(generation, static_cast<uint32_t>(std::clamp<int64_t>(
+                                             untilMs, 1, kEventWaitPollMs)));
+    return true;
 }
 
-std::string ApiServer::buildStatusBody()
+SystemMetricsDto ApiServer::readSystemMetrics()
 {
-    SystemStatusDto dto;
-
-    // Mode is the automatic-watering flag (parity: manual == automatic OFF).
-    dto.mode = config_.getWateringEnabled() ? "automatic" : "manual";
-
-    // Wifi: one consistent snapshot; the SSID is not a secret (the password is
-    // never represented). The IP comes from esp_netif, target-only.
-    const WifiConnectionSnapshot snap = wifi_.snapshot();
-    dto.wifi.state = wifiStateName(snap.state);
-    dto.wifi.rssi = snap.rssi;
-    dto.wifi.ssid = config_.getWifiSsid();
-    dto.wifi.connected = (snap.state == WifiState::Connected);
-    dto.wifi.ipAcquired = snap.ipAcquired;
-    dto.wifi.ip = deviceIp();
-
-    // Time: a not-set clock reports synced=false with no bogus 1970 epoch/local.
-    dto.time.synced = wallClock_.isTimeSet();
-    if (dto.time.synced) {
-        const uint32_t epoch = wallClock_.nowEpoch();
-        dto.time.epoch = static_cast<int64_t>(epoch);
-        dto.time.local = TimeService::formatLocal(epoch);
+    SystemMetricsDto dto;
+    dto.uptimeMs = static_cast<uint64_t>(uptime_.nowMs());
+    dto.heapFreeBytes = heap_caps_get_free_size(MALLOC_CAP_DEFAULT);
+    dto.heapMinFreeBytes = heap_caps_get_minimum_free_size(MALLOC_CAP_DEFAULT);
+    dto.heapLargestBlockBytes = heap_caps_get_largest_free_block(MALLOC_CAP_DEFAULT);
+    dto.taskCount = uxTaskGetNumberOfTasks();
+    // Runs on the httpd task, so this is its own mark (bytes on ESP-IDF).
+    dto.httpdStackFreeBytes = uxTaskGetStackHighWaterMark(nullptr);
+    const StorageStats stats = storage_.getStorageStats();
+    dto.storage = storageDto(stats);
+    dto.storageQueueDepth = stats.queue.depth;
+    dto.storageQueueDropped = stats.queue.dropped;
+    dto.storageQueueCoalesced = stats.queue.coalesced;
+    dto.storageWriterWaits = stats.locks.writerWaits;
+    dto.responseCacheHits = cache_.hits();
+    dto.responseCacheMisses = cache_.misses();
+    dto.streamClients = static_cast<uint32_t>(live_.clientCount());
+    dto.wifiPowerSave = wifiPowerSaveName(wifi_.snapshot().powerSave);
+    dto.arenaCapacityBytes = static_cast<uint32_t>(arena_.capacity());
+    dto.arenaHighWaterBytes = static_cast<uint32_t>(arena_.highWater());
+    dto.arenaFallbacks = arena_.fallbacks();
+    dto.throttledRequests = limiter_.throttled();
+    if (https_) {
+        dto.tls = tls_.snapshot();
+    }
+    dto.sessions = sockets_.snapshot(esp_timer_get_time());
+    if (modbusBus_ != nullptr) {
+        dto.hasModbus = true;
+        dto.modbusLatencyBaseUs = kModbusLatencyBaseUs;
+        dto.modbusUntracked = modbusBus_->untrackedTransfers();
+        dto.modbusBusyUs = modbusBus_->busTimeUs();
+        for (const ModbusLinkStats& s : modbusBus_->linkStats()) {
+            ModbusLinkDto link;
+            link.address = s.address;
+            link.function = s.function;
+            link.ok = s.ok;
+            link.timeouts = s.timeouts;
+            link.frameErrors = s.frameErrors;
+            link.exceptions = s.exceptions;
+            link.otherErrors = s.otherErrors;
+            link.latency.assign(s.latency.begin(), s.latency.end());
+            link.latencySumUs = s.latencySumUs;
+            // The bus master runs on esp_timer, the uptime clock.
+            link.lastSuccessMs = s.lastSuccessUs < 0 ? -1 : s.lastSuccessUs / 1000;
+            dto.modbusLinks.push_back(std::move(link));
+        }
+    }
+    if (taskTelemetry_ != nullptr) {
+        // ~1 KB: on the heap, not the httpd task's stack.
+        auto snap = std::make_unique<TelemetrySnapshot>();
+        taskTelemetry_->snapshot(*snap);
+        dto.hasTasks = snap->samples > 0;
+        dto.taskWindowUs = snap->windowUs;
+        for (std::size_t i = 0; i < snap->taskCount; ++i) {
+            const TaskLoad& t = snap->tasks[i];
+            dto.tasks.push_back(TaskMetricsDto{t.name, t.cpuPermille, t.stackFreeBytes,
+                                               t.priority, t.core});
+        }
+        for (std::size_t c = 0; c < kHeapCapsCount; ++c) {
+            const HeapCapsStats& h = snap->heaps[c];
+            if (h.totalBytes != 0) {
+                dto.heaps.push_back(HeapCapsDto{heapCapsName(static_cast<HeapCaps>(c)),
+                                                h.totalBytes, h.freeBytes, h.minFreeBytes,
+                                                h.largestBlockBytes});
+            }
+        }
+    }
+    const std::array<BufferPoolStats, kBufferPools> pools = bufferBudgets().snapshot();
+    for (std::size_t i = 0; i < kBufferPools; ++i) {
+        const BufferPoolStats& b = pools[i];
+        if (b.declared) {
+            dto.buffers.push_back(BufferPoolDto{
+                bufferPoolName(static_cast<BufferPool>(i)),
+                static_cast<uint32_t>(b.budgetBytes),
+                static_cast<uint32_t>(b.usedBytes[static_cast<std::size_t>(BufferPlacement::Internal)]),
+                static_cast<uint32_t>(b.usedBytes[static_cast<std::size_t>(BufferPlacement::Psram)]),
+                static_cast<uint32_t>(b.peakBytes), b.failures});
+        }
+    }
+    if (locks_ != nullptr) {
+        for (std::size_t i = 0; i < locks_->size(); ++i) {
+            const LockStats s = locks_->stats(i);
+            dto.locks.push_back(LockMetricsDto{locks_->name(i), s.acquisitions, s.contended,
+                                               s.waitUs, s.maxWaitUs, s.maxHoldUs});
+        }
+    }
+    if (watchdogFeeds_ != nullptr) {
+        std::array<WatchdogFeedStats, WatchdogFeeds::kMaxTasks> feeds;
+        const std::size_t n = watchdogFeeds_->copy(feeds.data(), feeds.size());
+        dto.watchdogBucketBaseUs = WatchdogFeedStats::kBucketBaseUs;
+        for (std::size_t i = 0; i < n; ++i) {
+            const WatchdogFeedStats& f = feeds[i];
+            WatchdogFeedDto feed;
+            feed.task = f.name;
+            feed.intervals.assign(f.buckets.begin(), f.buckets.end());
+            feed.sumUs = static_cast<uint64_t>(f.sumMs) * 1000u;
+            feed.maxIntervalUs = f.maxIntervalUs;
+            dto.watchdogFeeds.push_back(std::move(feed));
+        }
+    }
+    if (tickLatency_ != nullptr) {
+        const TickLatencyStats t = tickLatency_->snapshot();
+        const auto toDto = [](const char* phase, const TickDurationStats& d) {
+            TickDurationDto dto;
+            dto.phase = phase;
+            dto.durations.assign(d.buckets.begin(), d.buckets.end());
+            dto.sumUs = d.sumUs;
+            dto.maxUs = d.maxUs;
+            return dto;
+        };
+        dto.hasTicks = true;
+        dto.tick = toDto("", t.tick);
+        for (std::size_t i = 0; i < kTickPhases; ++i) {
+            dto.tickPhases.push_back(
+                toDto(tickPhaseName(static_cast<TickPhase>(i)), t.phases[i]));
+        }
+        dto.tickBucketBaseUs = TickDurationStats::kBucketBaseUs;
+        dto.tickBudgetUs = t.budgetUs;
+        dto.ticksOverBudget = t.overBudget;
+    }
+    LifetimeCounterValues totals;
+    if (lifetime_ != nullptr && lifetime_->load(totals)) {
+        for (std::size_t i = 0; i < kLifetimeCounterCount; ++i) {
+            dto.lifetime.push_back(LifetimeCounterDto{
+                lifetimeCounterName(static_cast<LifetimeCounter>(i)), totals.values[i]});
+        }
+    }
+    if (powerResidency_ != nullptr) {
+        const PowerResidencyStats pm = powerResidency_->snapshot(esp_timer_get_time());
+        for (std::size_t i = 0; i < kPowerStates; ++i) {
+            dto.powerStates.push_back(
+                PowerStateDto{powerStateName(static_cast<PowerState>(i)), pm.us[i]});
+        }
+        for (std::size_t i = 0; i < kPowerLockKinds; ++i) {
+            dto.powerLocks.push_back(PowerLockDto{
+                powerLockKindName(static_cast<PowerLockKind>(i)), pm.acquisitions[i]});
+        }
+    }
+    if (mqtt_ != nullptr) {
+        dto.mqtt = mqtt_->stats();
     }
-    dto.time.lastSync = static_cast<int64_t>(sntp_.status().lastSyncEpoch);
+    return dto;
+}
 
-    dto.uptimeMs = static_cast<uint64_t>(uptime_.nowMs());
-    dto.resetReason = resetReasonName(static_cast<int>(esp_reset_reason()));
+void ApiServer::pollStream()
+{
+    if (server_ == nullptr || live_.clientCount() == 0) {
+        return;
+    }
+    live_.publish(readSensors(), readPumps());
+    // Events reach the queues from any task between polls; they drain here too.
+    if (live_.pending() && !drainQueued_.exchange(true)) {
+        if (httpd_queue_work(static_cast<httpd_handle_t>(server_),
+                             &drainStreamWork, this) != ESP_OK) {
+            drainQueued_.store(false);  // retried on the next poll
+        }
+    }
+}
 
-    const esp_app_desc_t* desc = esp_app_get_description();
-    if (desc != nullptr) {
-        dto.firmware.version = desc->version;
-        dto.firmware.project = desc->project_name;
+void ApiServer::drainStream()
+{
+    // Cleared first: anything queued from here on schedules another drain.
+    drainQueued_.store(false);
+    httpd_handle_t server = static_cast<httpd_handle_t>(server_);
+    if (server == nullptr) {
+        return;
+    }
+    std::string message;
+    for (const int fd : live_.clients()) {
+        while (live_.pop(fd, message)) {
+            httpd_ws_frame_t frame = {};
+            frame.type = HTTPD_WS_TYPE_TEXT;
+            frame.payload = reinterpret_cast<uint8_t*>(message.data());
+            frame.len = message.size();
+            if (httpd_ws_send_frame_async(server, fd, &frame) != ESP_OK) {
+                // Gone, or stuck past the send timeout: stop feeding it.
+                live_.removeClient(fd);
+                httpd_sess_trigger_close(server, fd);
+                break;
+            }
+        }
     }
+}
 
-    const StorageStats stats = storage_.getStorageStats();
-    dto.storage.totalBytes = stats.totalBytes;
-    dto.storage.usedBytes = stats.usedBytes;
-    dto.storage.percentUsed =
-        stats.totalBytes != 0
-            ? (100.0f * static_cast<float>(stats.usedBytes) /
-               static_cast<float>(stats.totalBytes))
-            : 0.0f;
+void ApiServer::setRateLimit(uint32_t perSecond, uint32_t burst)
+{
+    limiter_.configure(perSecond, burst);
+}
 
-#if BOARD_HAS_INA226
-    dto.hasPower = true;
-    dto.power.busVoltage = power_.getBusVoltage();
-    dto.power.current = power_.getCurrent();
-    dto.power.power = power_.getPower();
-    dto.power.valid = cachedValid(power_.getLastError(), dto.power.busVoltage);
-#endif
+void ApiServer::setAssets(AssetStore& assets)
+{
+    assets_ = &assets;
+}
 
-    return serializeStatus(dto);
+void ApiServer::setSoilProbes(const SoilPollScheduler& probes)
+{
+    soilProbes_ = probes.size() > 1 ? &probes : nullptr;
 }
 
-std::string ApiServer::buildSensorsBody()
+bool ApiServer::addZonePump(IWaterPump& pump)
 {
-    SensorReadingsDto dto;
+    if (zonePumpCount_ == zonePumps_.size()) {
+        return false;
+    }
+    zonePumps_[zonePumpCount_++] = &pump;
+    return true;
+}
 
-    // Environmental: kept fresh by the 5 s sensor task's read().
-    dto.environmental.temperature = env_.getTemperature();
-    dto.environmental.humidity = env_.getHumidity();
-    dto.environmental.pressure = env_.getPressure();
-    dto.environmental.valid =
-        cachedValid(env_.getLastError(), dto.environmental.temperature);
-
-    // Soil: no periodic reader lands until PR-11, so the cached values are still
-    // NaN placeholders and `valid` is honestly false (contract: soil valid=false
-    // until PR-11). NPK channels are present-flagged: emitted only when the
-    // sensor reported a non-negative value.
-    dto.soil.moisture = soil_.getMoisture();
-    dto.soil.temperature = soil_.getTemperature();
-    dto.soil.humidity = soil_.getHumidity();
-    dto.soil.ph = soil_.getPH();
-    dto.soil.ec = soil_.getEC();
-    dto.soil.valid = cachedValid(soil_.getLastError(), dto.soil.moisture);
-    const float nitrogen = soil_.getNitrogen();
-    dto.soil.hasNitrogen = std::isfinite(nitrogen) && nitrogen >= 0.0f;
-    dto.soil.nitrogen = nitrogen;
-    const float phosphorus = soil_.getPhosphorus();
-    dto.soil.hasPhosphorus = std::isfinite(phosphorus) && phosphorus >= 0.0f;
-    dto.soil.phosphorus = phosphorus;
-    const float potassium = soil_.getPotassium();
-    dto.soil.hasPotassium = std::isfinite(potassium) && potassium >= 0.0f;
-    dto.soil.potassium = potassium;
+void ApiServer::setModbusBus(const ModbusBusMaster& bus)
+{
+    modbusBus_ = &bus;
+}
 
-    // Level: kept fresh by the 10 Hz main-loop update(); isWaterPresent() is
-    // meaningful only while isValid() (a not-yet-valid mark is never wet/dry).
-    dto.level.low.valid = levelLow_.isValid();
-    dto.level.low.waterPresent = levelLow_.isWaterPresent();
-    dto.level.high.valid = levelHigh_.isValid();
-    dto.level.high.waterPresent = levelHigh_.isWaterPresent();
+void ApiServer::setPowerCapture(PumpCurrentCapture& capture)
+{
+    powerCapture_ = &capture;
+}
 
-#if BOARD_HAS_INA226
-    dto.hasPower = true;
-    dto.power.busVoltage = power_.getBusVoltage();
-    dto.power.current = power_.getCurrent();
-    dto.power.power = power_.getPower();
-    dto.power.valid = cachedValid(power_.getLastError(), dto.power.busVoltage);
-#endif
+void ApiServer::setEnergyMeter(const EnergyMeter& meter)
+{
+    energyMeter_ = &meter;
+}
 
-    // Top-level timestamp: JSON null when the clock is not set (no bogus 1970).
-    if (wallClock_.isTimeSet()) {
-        dto.hasTimestamp = true;
-        dto.timestamp = static_cast<int64_t>(wallClock_.nowEpoch());
-    }
+void ApiServer::setDecisionTrace(const DecisionTrace& trace)
+{
+    decisionTrace_ = &trace;
+}
 
-    return serializeSensors(dto);
+void ApiServer::setTaskTelemetry(const TaskTelemetry& telemetry)
+{
+    taskTelemetry_ = &telemetry;
 }
 
-std::string ApiServer::buildPowerBody()
+void ApiServer::setLockRegistry(const LockRegistry& locks)
 {
-#if BOARD_HAS_INA226
-    PowerDto power;
-    power.busVoltage = power_.getBusVoltage();
-    power.current = power_.getCurrent();
-    power.power = power_.getPower();
-    power.valid = cachedValid(power_.getLastError(), power.busVoltage);
-    return serializePower(power);
-#else
-    // rev1 has no INA226 code at all: the board-capability not-available shape.
-    return serializePowerUnavailable();
-#endif
+    locks_ = &locks;
 }
 
-IWaterPump* ApiServer::pumpByName(const std::string& name)
+void ApiServer::setBootProfile(const BootProfile& profile)
 {
-    if (name == "plant") {
-        return &plantPump_;
-    }
-#if BOARD_HAS_RESERVOIR_PUMP
-    if (name == "reservoir") {
-        return &reservoirPump_;
-    }
-#endif
-    return nullptr;
+    bootProfile_ = &profile;
 }
 
-std::string ApiServer::buildPumpsBody()
+void ApiServer::setWatchdogFeeds(const WatchdogFeeds& feeds)
 {
-    // Capability-enumerated: the reservoir pump exists on rev1 only.
-    std::vector<PumpDto> pumps;
-    pumps.push_back(makePumpDto(plantPump_));
-#if BOARD_HAS_RESERVOIR_PUMP
-    pumps.push_back(makePumpDto(reservoirPump_));
-#endif
-    return serializePumpList(pumps);
+    watchdogFeeds_ = &feeds;
 }
 
-ApiResponse ApiServer::applyPumpCommand(const std::string& name,
-                                        const std::string& body)
+void ApiServer::setTickLatency(const TickLatency& latency)
 {
-    IWaterPump* pump = pumpByName(name);
-    if (pump == nullptr) {
-        return {ApiStatus::NotFound, errorBody("unknown pump")};
-    }
+    tickLatency_ = &latency;
+}
 
-    const PumpCommandResult parsed = parsePumpCommand(body);
-    if (!parsed.ok) {
-        return {ApiStatus::BadRequest, errorBody(parsed.error)};
-    }
+void ApiServer::setLifetimeCounters(const LifetimeCounters& counters)
+{
+    lifetime_ = &counters;
+}
 
-    switch (parsed.command.action) {
-    case PumpAction::Start:
-    case PumpAction::Run: {
-        // durationS is guaranteed present and in 1..300 by the pure parser; the
-        // pump's own runFor() re-enforces the hard cap and the no-restart rule —
-        // the server makes no watering decision. A false result here means the
-        // pump is already running (its clock is NOT restarted): an explicit 409.
-        const int durationS = static_cast<int>(parsed.command.durationS.value());
-        if (!pump->runFor(durationS)) {
-            return {ApiStatus::Conflict, errorBody("pump already running")};
-        }
-        break;
-    }
-    case PumpAction::Stop:
-        // Idempotent: stopping an already-stopped pump is a success no-op.
-        pump->stop();
-        break;
-    }
+void ApiServer::setPowerManagement(IPowerLock& lock, const PowerResidency& residency)
+{
+    powerLock_ = &lock;
+    powerResidency_ = &residency;
+}
 
-    return {ApiStatus::Ok, serializePump(makePumpDto(*pump))};
+void ApiServer::setMqttUplink(const MqttUplink& uplink)
+{
+    mqtt_ = &uplink;
 }
 
-std::string ApiServer::buildConfigBody()
+void ApiServer::setNodeGateway(const NodeGateway& gateway)
 {
-    ConfigDto dto;
-    dto.moistureThresholdLow = config_.getMoistureThresholdLow();
-    dto.moistureThresholdHigh = config_.getMoistureThresholdHigh();
-    dto.wateringDurationS = config_.getWateringDurationS();
-    dto.minWateringIntervalS = config_.getMinWateringIntervalS();
-    dto.wateringEnabled = config_.getWateringEnabled();
-    dto.sensorReadIntervalMs = config_.getSensorReadIntervalMs();
-    dto.dataLogIntervalMs = config_.getDataLogIntervalMs();
-    // The wifi password is deliberately absent (ConfigDto carries no such field).
-    return serializeConfig(dto);
+    nodeGateway_ = &gateway;
 }
 
-ApiResponse ApiServer::applyConfigSet(const std::string& body)
+void ApiServer::setPumpUsage(PumpUsage& usage)
 {
-    const ConfigSetResult parsed = parseConfigSet(body);
-    if (!parsed.ok) {
-        return {ApiStatus::BadRequest, errorBody(parsed.error)};
-    }
+    pumpUsage_ = &usage;
+}
 
-    // All-or-nothing was validated in the pure parser (nothing is marked to
-    // apply when it rejects). Each present field is persisted via its setter; a
-    // setter returning false here is an unexpected persistence failure on an
-    // already-validated value (out-of-range was ruled out) -> 500. The failing
-    // setter is logged (identifying the field) before returning.
-    const ConfigSetRequest& r = parsed.request;
-    bool ok = true;
-    if (ok && r.moistureThresholdLow &&
-        !config_.setMoistureThresholdLow(*r.moistureThresholdLow)) {
-        ESP_LOGE(TAG, "config persist failed for moistureThresholdLow");
-        ok = false;
-    }
-    if (ok && r.moistureThresholdHigh &&
-        !config_.setMoistureThresholdHigh(*r.moistureThresholdHigh)) {
-        ESP_LOGE(TAG, "config persist failed for moistureThresholdHigh");
-        ok = false;
-    }
-    if (ok && r.wateringDurationS &&
-        !config_.setWateringDurationS(*r.wateringDurationS)) {
-        ESP_LOGE(TAG, "config persist failed for wateringDurationS");
-        ok = false;
-    }
-    if (ok && r.minWateringIntervalS &&
-        !config_.setMinWateringIntervalS(*r.minWateringIntervalS)) {
-        ESP_LOGE(TAG, "config persist failed for minWateringIntervalS");
-        ok = false;
-    }
-    if (ok && r.wateringEnabled &&
-        !config_.setWateringEnabled(*r.wateringEnabled)) {
-        ESP_LOGE(TAG, "config persist failed for wateringEnabled");
-        ok = false;
-    }
-    if (ok && r.sensorReadIntervalMs &&
-        !config_.setSensorReadIntervalMs(*r.sensorReadIntervalMs)) {
-        ESP_LOGE(TAG, "config persist failed for sensorReadIntervalMs");
-        ok = false;
-    }
-    if (ok && r.dataLogIntervalMs &&
-        !config_.setDataLogIntervalMs(*r.dataLogIntervalMs)) {
-        ESP_LOGE(TAG, "config persist failed for dataLogIntervalMs");
-        ok = false;
-    }
-
-    if (!ok) {
-        return {ApiStatus::InternalError,
-                errorBody("failed to persist configuration")};
-    }
+void ApiServer::setLogTail(const LogTail& tail)
+{
+    logTail_ = &tail;
+}
 
-    return {ApiStatus::Ok, buildConfigBody()};
+void ApiServer::setEventCounts(const EventCounts& counts)
+{
+    eventCounts_ = &counts;
 }
 
-ApiResponse ApiServer::buildHistoryResponse(const HistoryQuery& query)
+void ApiServer::setEventWait(EventNotifier& notifier, uint32_t maxWaitS)
 {
-    // metric is required — the storage layer is keyed by it.
-    if (query.metric.empty()) {
-        return {ApiStatus::BadRequest, errorBody("metric is required")};
-    }
+    eventNotifier_ = &notifier;
+    eventWaitMaxS_ = maxWaitS;
+}
 
-    const uint32_t now = wallClock_.nowEpoch();
+void ApiServer::setModbusCapture(const ModbusFrameCapture& capture)
+{
+    modbusCapture_ = &capture;
+}
 
-    // Window resolution is pure (range precedence over explicit start/end, else
-    // the last 24 h; underflow-clamped). An unknown named range is a client
-    // error.
-    std::optional<uint32_t> start;
-    std::optional<uint32_t> end;
-    if (query.start.has_value()) {
-        start = static_cast<uint32_t>(*query.start);
-    }
-    if (query.end.has_value()) {
-        end = static_cast<uint32_t>(*query.end);
-    }
-    const WindowResult window = resolveWindow(query.range, start, end, now);
-    if (!window.ok) {
-        return {ApiStatus::BadRequest, errorBody("unknown range")};
-    }
-    const uint32_t t0 = window.t0;
-    const uint32_t t1 = window.t1;
+void ApiServer::setInputRecording(const InputRecorder& recorder, const BlockRingFile* file)
+{
+    inputRecorder_ = &recorder;
+    recordingFile_ = file;
+}
 
-    HistorySeries series;
-    series.metric = query.metric;
-    series.reading = query.reading;  // echoed only; storage is keyed by metric
-    series.start = static_cast<int64_t>(t0);
-    series.end = static_cast<int64_t>(t1);
+void ApiServer::setOtaPipeline(OtaPipeline& ota)
+{
+    ota_ = &ota;
+}
 
-    // Non-blocking filesystem read (no bus access). An empty result is a 200
-    // with empty arrays — a window with no data is a success, not an error.
-    const std::vector<SensorReading> readings =
-        storage_.getSensorReadings(query.metric, t0, t1);
-    series.timestamps.reserve(readings.size());
-    series.values.reserve(readings.size());
-    for (const SensorReading& r : readings) {
-        series.timestamps.push_back(static_cast<int64_t>(r.epoch));
-        series.values.push_back(r.value);
-    }
+void ApiServer::setReadAhead(ReadAheadPipe& pipe)
+{
+    readAhead_ = &pipe;
+}
 
-    return {ApiStatus::Ok, serializeHistory(series)};
+void ApiServer::setStorageArchive(IStorageHold& hold, std::string basePath)
+{
+    archiveHold_ = &hold;
+    archiveBase_ = std::move(basePath);
 }
 
-std::string ApiServer::buildEventsBody(std::size_t count)
+void ApiServer::setTls(std::string certPem, std::string keyPem, unsigned maxSessions)
 {
-    // Non-blocking: the event log lives on the filesystem. getEvents is
-    // newest-first; the DTO adds a human category name when the id is known.
-    const std::vector<EventRecord> records = storage_.getEvents(count);
-    std::vector<EventDto> events;
-    events.reserve(records.size());
-    for (const EventRecord& r : records) {
-        EventDto dto;
-        dto.epoch = static_cast<int64_t>(r.epoch);
-        dto.category = static_cast<int>(r.category);
-        const char* name = eventCategoryName(dto.category);
-        if (name != nullptr) {
-            dto.categoryName = name;
-        }
-        dto.detail = r.detail;
-        events.push_back(std::move(dto));
-    }
-    return serializeEvents(events);
+    tlsCert_ = std::move(certPem);
+    tlsKey_ = std::move(keyPem);
+    tlsMaxSessions_ = maxSessions > 0 ? maxSessions : 1;
 }
 
-std::string ApiServer::buildSelfTestBody()
+void ApiServer::setHttpdPlacement(unsigned priority, int core)
 {
-    // DOCUMENTED QUIRK-5 EXCEPTION: unlike every other handler, the self-test
-    // deliberately issues a real bus read() on each sensor. It is bounded (one
-    // attempt per sensor, no retry — the drivers do not loop) and runs on the
-    // httpd task, off the 10 Hz watering loop; the injected Locked* wrappers
-    // serialize each read() with the other bus users, so a concurrent console
-    // or sensor-task read is never corrupted. No watering decision is made.
-    SelfTestResultDto result;
-    bool overall = true;
+    httpdPriority_ = static_cast<int>(priority);
+    httpdCore_ = core;
+}
 
-    {
-        SelfTestCheckDto check;
-        check.name = "environmental";
-        check.ok = env_.read();
-        check.detail =
-            check.ok ? std::string("ok")
-                     : ("read failed, error " +
-                        std::to_string(env_.getLastError()));
-        overall = overall && check.ok;
-        result.checks.push_back(std::move(check));
-    }
+namespace {
 
-    {
-        // The soil sensor read() is the RS485/Modbus round-trip self-test.
-        SelfTestCheckDto check;
-        check.name = "soil";
-        check.ok = soil_.read();
-        check.detail =
-            check.ok ? std::string("ok")
-                     : ("read failed, error " +
-                        std::to_string(soil_.getLastError()));
-        overall = overall && check.ok;
-        result.checks.push_back(std::move(check));
-    }
-
-    result.overall = overall;
-    return serializeSelfTest(result);
+/// Size @p config by the stored HttpdSettings (api/HttpdPresets.h); all
+/// zero keeps the build's defaults.
+void applyHttpdSettings(httpd_config_t& config, const HttpdSettings& h, bool https)
+{
+    if (!h.enabled()) {
+        return;
+    }
+    // httpd keeps three of lwIP's sockets for itself (listener and control).
+    constexpr uint16_t kSocketCap = CONFIG_LWIP_MAX_SOCKETS - 3;
+    config.max_open_sockets = std::min(h.maxOpenSockets, kSocketCap);
+    if (config.max_open_sockets < h.maxOpenSockets) {
+        ESP_LOGW(TAG, "httpd: %u sessions stored, %u fit CONFIG_LWIP_MAX_SOCKETS",
+                 static_cast<unsigned>(h.maxOpenSockets), static_cast<unsigned>(kSocketCap));
+    }
+    config.backlog_conn = h.backlog;
+    // The TLS default stack is the handshake's floor; a setting only raises it.
+    config.stack_size = https ? std::max<std::size_t>(config.stack_size, h.stackBytes)
+                              : h.stackBytes;
+    config.recv_wait_timeout = h.recvTimeoutS;
+    config.send_wait_timeout = h.sendTimeoutS;
+    config.lru_purge_enable = h.lruPurge;
+    ESP_LOGI(TAG, "httpd: %u sessions, backlog %u, stack %u, timeouts %u/%u s, purge %s",
+             static_cast<unsigned>(config.max_open_sockets),
+             static_cast<unsigned>(config.backlog_conn),
+             static_cast<unsigned>(config.stack_size),
+             static_cast<unsigned>(config.recv_wait_timeout),
+             static_cast<unsigned>(config.send_wait_timeout),
+             config.lru_purge_enable ? "on" : "off");
 }
 
+}  // namespace
+
 bool ApiServer::start()
 {
     if (server_ != nullptr) {
         return true;  // already started (idempotent)
     }
 
+    // Tags from a previous boot must not match: generations restart at 0.
+    etagSalt_ = esp_random();
+
+    // From here on the handlers' cJSON allocations go to arena_.
+    installArenaHooks();
+
+    // Depth 1: claimSelfTest() admits one run at a time.
+    if (selfTestQueue_ == nullptr) {
+        selfTestQueue_ = xQueueCreateStatic(1, sizeof(httpd_req_t*),
+                                            s_selfTestQueueStorage, &s_selfTestQueue);
+        if (selfTestQueue_ == nullptr) {
+            ESP_LOGW(TAG, "no selftest queue; selftest runs on the httpd task");
+        }
+    }
+
+    // One entry per slot: claimEventWait() bounds the holds.
+    if (eventWaitQueue_ == nullptr && eventNotifier_ != nullptr) {
+        eventWaitQueue_ = xQueueCreateStatic(kEventWaiters, sizeof(EventWait),
+                                             s_eventWaitQueueStorage, &s_eventWaitQueue);
+        if (eventWaitQueue_ == nullptr) {
+            ESP_LOGW(TAG, "no event-wait queue; tail reads answer at once");
+        }
+    }
+
     httpd_handle_t server = nullptr;
+#if WS_API_HTTPS
+    // One config for both: the TLS defaults bring the larger task stack the
+    // handshake needs; plain HTTP starts from the httpd ones.
+    httpd_ssl_config_t ssl = HTTPD_SSL_CONFIG_DEFAULT();
+    const bool https = !tlsCert_.empty() && !tlsKey_.empty();
+    if (!https) {
+        ssl.httpd = HTTPD_DEFAULT_CONFIG();
+    }
+    httpd_config_t& config = ssl.httpd;
+#else
+    constexpr bool https = false;
     httpd_config_t config = HTTPD_DEFAULT_CONFIG();
+#endif
     config.max_uri_handlers = kMaxUriHandlers;
     config.lru_purge_enable = true;
-    // Wildcard matching so POST /api/v1/pumps/{name} can be served by one
-    // handler on the pumps command prefix; exact routes still match exactly.
+    // Wildcard matching for the per-method /api/v1/ dispatchers and the
+    // static catch-all.
     config.uri_match_fn = httpd_uri_match_wildcard;
-
-    esp_err_t err = httpd_start(&server, &config);
+    // Stream clients are forgotten when their session closes, however it ends.
+    config.global_user_ctx = this;
+    config.global_user_ctx_free_fn = &keepGlobalContext;
+    config.close_fn = &onSessionClose;
+    if (httpdPriority_ >= 0) {
+        config.task_priority = static_cast<unsigned>(httpdPriority_);
+    }
+    config.core_id = httpdCore_ < 0 ? tskNO_AFFINITY : httpdCore_;
+    config.open_fn = &onSessionOpen;
+    applyHttpdSettings(config, config_.getHttpdSettings(), https);
+
+    https_ = https;  // read by /metrics as soon as the server answers
+    esp_err_t err = ESP_OK;
+#if WS_API_HTTPS
+    if (https) {
+        // PEM lengths count the terminating NUL.
+        ssl.servercert = reinterpret_cast<const uint8_t*>(tlsCert_.c_str());
+        ssl.servercert_len = tlsCert_.size() + 1;
+        ssl.prvtkey_pem = reinterpret_cast<const uint8_t*>(tlsKey_.c_str());
+        ssl.prvtkey_len = tlsKey_.size() + 1;
+        ssl.ciphersuites_list = kTlsCiphersuites;
+        // A client back after its session closed resumes from its ticket:
+        // one round trip and no key exchange or signature.
+        ssl.session_tickets = true;
+        ssl.cert_select_cb = &onClientHello;
+        ssl.user_cb = &onTlsSession;
+        // Each open session holds an mbedtls context; keep-alive reuses
+        // them across requests and the LRU purge frees the oldest for a
+        // new client.
+        config.max_open_sockets = std::min<uint16_t>(
+            config.max_open_sockets, static_cast<uint16_t>(tlsMaxSessions_));
+        config.keep_alive_enable = true;
+        config.keep_alive_idle = kTlsKeepAliveIdleS;
+        config.keep_alive_interval = kTlsKeepAliveIntervalS;
+        config.keep_alive_count = kTlsKeepAliveCount;
+        s_tlsMetrics = &tls_;
+        err = httpd_ssl_start(&server, &ssl);
+    } else {
+        err = httpd_start(&server, &config);
+    }
+#else
+    err = httpd_start(&server, &config);
+#endif
     if (err != ESP_OK) {
-        ESP_LOGE(TAG, "httpd_start failed: %s", esp_err_to_name(err));
+        ESP_LOGE(TAG, "%s failed: %s", https ? "httpd_ssl_start" : "httpd_start",
+                 esp_err_to_name(err));
         return false;
     }
-
-    // One httpd handler per route; user_ctx carries this instance. The full
-    // /api/v1/ route set is registered here. The per-pump command uses a
-    // wildcard pattern (the name is parsed from the URI in the handler); an
-    // unknown pump name answers 404 via applyPumpCommand, and a truly unknown
-    // route is covered by the 404 err_handler below.
+    sockets_.setCapacity(config.max_open_sockets);
+
+    // Six httpd handlers whatever the route count: the websocket stream
+    // (httpd upgrades it itself, so it is registered first and matches
+    // first), one dispatcher per method for everything else under /api/v1/
+    // (apiDispatch: the constexpr route table, ApiRoutes.h), and the static
+    // assets behind them; HEAD reaches the two downloads, /history and the
+    // assets, which size their bodies for it. user_ctx carries this
+    // instance. An unknown pump name answers 404 via applyPumpCommand; a
+    // path outside /api/v1/ that is not a GET or HEAD gets the 404
+    // err_handler below.
     const httpd_uri_t routes[] = {
         {
-            .uri = "/api/v1/status",
-            .method = HTTP_GET,
-            .handler = &statusHandler,
-            .user_ctx = this,
-        },
-        {
-            .uri = "/api/v1/sensors",
-            .method = HTTP_GET,
-            .handler = &sensorsHandler,
-            .user_ctx = this,
-        },
-        {
-            .uri = "/api/v1/power",
-            .method = HTTP_GET,
-            .handler = &powerHandler,
-            .user_ctx = this,
-        },
-        {
-            .uri = "/api/v1/pumps",
+            .uri = "/api/v1/stream",
             .method = HTTP_GET,
-            .handler = &pumpsListHandler,
-            .user_ctx = this,
-        },
-        {
-            .uri = "/api/v1/pumps/*",
-            .method = HTTP_POST,
-            .handler = &pumpCommandHandler,
+            .handler = &timed<&streamHandler, metricSlot(HandlerId::Stream)>,
             .user_ctx = this,
+            .is_websocket = true,
         },
         {
-            .uri = "/api/v1/config",
+            .uri = "/api/v1/*",
             .method = HTTP_GET,
-            .handler = &configGetHandler,
+            .handler = &apiDispatch<HttpMethod::Get>,
             .user_ctx = this,
         },
         {
-            .uri = "/api/v1/config",
+            .uri = "/api/v1/*",
             .method = HTTP_POST,
-            .handler = &configSetHandler,
+            .handler = &apiDispatch<HttpMethod::Post>,
             .user_ctx = this,
         },
         {
             .uri = "/api/v1/history",
-            .method = HTTP_GET,
-            .handler = &historyHandler,
+            .method = HTTP_HEAD,
+            .handler = &timed<&historyHandler, metricSlot(HandlerId::History)>,
             .user_ctx = this,
         },
         {
-            .uri = "/api/v1/events",
+            .uri = "/*",
             .method = HTTP_GET,
-            .handler = &eventsHandler,
-            .user_ctx = this,
-        },
-        {
-            .uri = "/api/v1/selftest",
-            .method = HTTP_POST,
-            .handler = &selfTestHandler,
-            .user_ctx = this,
-        },
-        {
-            .uri = "/api/v1/ota",
-            .method = HTTP_POST,
-            .handler = &otaHandler,
+            .handler = &timed<&staticFileHandler, kStaticAssetsSlot>,
             .user_ctx = this,
         },
         {
             .uri = "/*",
-            .method = HTTP_GET,
-            .handler = &staticFileHandler,
+            .method = HTTP_HEAD,
+            .handler = &timed<&staticFileHandler, kStaticAssetsSlot>,
             .user_ctx = this,
         },
     };
@@ -981,7 +3737,7 @@ bool ApiServer::start()
 
     // Unknown routes answer the JSON 404 envelope, not the default HTML page.
     err = httpd_register_err_handler(server, HTTPD_404_NOT_FOUND,
-                                     &notFoundHandler);
+                                     &timedError<&notFoundHandler>);
     if (err != ESP_OK) {
         ESP_LOGE(TAG, "register 404 handler failed: %s", esp_err_to_name(err));
         httpd_stop(server);
@@ -990,7 +3746,7 @@ bool ApiServer::start()
 
     // A known path with the wrong method answers the JSON 405 envelope too.
     err = httpd_register_err_handler(server, HTTPD_405_METHOD_NOT_ALLOWED,
-                                     &methodNotAllowedHandler);
+                                     &timedError<&methodNotAllowedHandler>);
     if (err != ESP_OK) {
         ESP_LOGE(TAG, "register 405 handler failed: %s", esp_err_to_name(err));
         httpd_stop(server);
@@ -998,14 +3754,22 @@ bool ApiServer::start()
     }
 
     server_ = server;
-    ESP_LOGI(TAG, "API server started (/api/v1/)");
+    ESP_LOGI(TAG, "API server started (%s, /api/v1/)", https ? "https" : "http");
     return true;
 }
 
 void ApiServer::stop()
 {
     if (server_ != nullptr) {
+#if WS_API_HTTPS
+        if (https_) {
+            httpd_ssl_stop(static_cast<httpd_handle_t>(server_));
+        } else {
+            httpd_stop(static_cast<httpd_handle_t>(server_));
+        }
+#else
         httpd_stop(static_cast<httpd_handle_t>(server_));
+#endif
         server_ = nullptr;
         ESP_LOGI(TAG, "API server stopped");
     }
@@ -0,0 +1,735 @@
+// SPDX-FileCopyrightText: 2026 Cryptotomte
+// SPDX-License-Identifier: AGPL-3.0-or-later
+/**
+ * @file ApiStream.cpp
+ * @brief Implementation of the streaming history body writer.
+ */
+
+#include "api/ApiStream.h"
+
+#include <cstdio>
+#include <cstring>
+#include <vector>
+
+#include "api/ApiRequests.h"
+#include "api/ApiSerialize.h"
+#include "api/JsonTemplate.h"
+#include "control/DecisionTrace.h"
+#include "control/InputRecorder.h"
+#include "interfaces/TraceBuffer.h"
+#include "sensors/ModbusFrameCapture.h"
+#include "sensors/PumpCurrentCapture.h"
+#include "storage/BlockRingFile.h"
+
+namespace api {
+
+void ChunkWriter::put(const void* data, std::size_t len)
+{
+    const char* bytes = static_cast<const char*>(data);
+    while (ok_ && len > 0) {
+        if (used_ == kBufferBytes && !flush()) {
+            return;
+        }
+        const std::size_t n =
+            (len < kBufferBytes - used_) ? len : kBufferBytes - used_;
+        std::memcpy(buf_ + used_, bytes, n);
+        used_ += n;
+        bytes += n;
+        len -= n;
+    }
+}
+
+void ChunkWriter::u32le(uint32_t value)
+{
+    const unsigned char bytes[4] = {
+        static_cast<unsigned char>(value),
+        static_cast<unsigned char>(value >> 8),
+        static_cast<unsigned char>(value >> 16),
+        static_cast<unsigned char>(value >> 24),
+    };
+    put(bytes, sizeof(bytes));
+}
+
+void ChunkWriter::f32le(float value)
+{
+    uint32_t bits = 0;
+    std::memcpy(&bits, &value, sizeof(bits));
+    u32le(bits);
+}
+
+bool ChunkWriter::flush()
+{
+    if (ok_ && used_ > 0) {
+        ok_ = sink_.send(buf_, used_);
+    }
+    used_ = 0;
+    return ok_;
+}
+
+void JsonStreamWriter::raw(const char* text)
+{
+    put(text, std::strlen(text));
+}
+
+void JsonStreamWriter::string(const std::string& text)
+{
+    escapeJsonString(text, [this](const char* p, std::size_t n) { put(p, n); });
+}
+
+void JsonStreamWriter::number(double value)
+{
+    char text[kJsonNumberChars];
+    put(text, formatJsonNumber(value, text));
+}
+
+void JsonStreamWriter::fixed(double value, int decimals)
+{
+    char text[kJsonNumberChars];
+    put(text, formatJsonFixed(value, decimals, text));
+}
+
+void JsonStreamWriter::integer(int64_t value)
+{
+    char text[24];
+    std::snprintf(text, sizeof(text), "%lld", static_cast<long long>(value));
+    raw(text);
+}
+
+namespace {
+
+bool isRangeSpace(char c)
+{
+    return c == ' ' || c == '\t';
+}
+
+/// Decimal digits at @p pos into @p value; false when there are none or
+/// they overflow.
+bool rangeDigits(std::string_view text, std::size_t& pos, uint64_t& value)
+{
+    const std::size_t start = pos;
+    value = 0;
+    while (pos < text.size() && text[pos] >= '0' && text[pos] <= '9') {
+        const uint64_t digit = static_cast<uint64_t>(text[pos] - '0');
+        if (value > (UINT64_MAX - digit) / 10) {
+            return false;
+        }
+        value = value * 10 + digit;
+        ++pos;
+    }
+    return pos > start;
+}
+
+}  // namespace
+
+RangeRequest resolveByteRange(std::string_view header, uint64_t size, ByteRange& out)
+{
+    std::size_t pos = 0;
+    while (pos < header.size() && isRangeSpace(header[pos])) {
+        ++pos;
+    }
+    // The unit is case-insensitive.
+    static constexpr char kUnit[] = "bytes=";
+    for (std::size_t i = 0; i + 1 < sizeof(kUnit); ++i, ++pos) {
+        if (pos == header.size() ||
+            (header[pos] | 0x20) != kUnit[i]) {
+            return RangeRequest::Whole;
+        }
+    }
+    std::size_t end = header.size();
+    while (end > pos && isRangeSpace(header[end - 1])) {
+        --end;
+    }
+    const std::string_view spec = header.substr(pos, end - pos);
+    std::size_t at = 0;
+    uint64_t first = 0;
+    uint64_t last = UINT64_MAX;
+    if (!spec.empty() && spec[0] == '-') {
+        uint64_t suffix = 0;
+        at = 1;
+        if (!rangeDigits(spec, at, suffix) || at != spec.size()) {
+            return RangeRequest::Whole;
+        }
+        if (suffix == 0 || size == 0) {
+            return RangeRequest::Unsatisfiable;
+        }
+        out.length = suffix < size ? suffix : size;
+        out.first = size - out.length;
+        return RangeRequest::Partial;
+    }
+    if (!rangeDigits(spec, at, first) || at == spec.size() || spec[at] != '-') {
+        return RangeRequest::Whole;
+    }
+    ++at;
+    if (at < spec.size() && (!rangeDigits(spec, at, last) || last < first)) {
+        return RangeRequest::Whole;
+    }
+    if (at != spec.size()) {
+        return RangeRequest::Whole;  // trailing text, or a second range
+    }
+    if (first >= size) {
+        return RangeRequest::Unsatisfiable;
+    }
+    if (last >= size) {
+        last = size - 1;
+    }
+    out.first = first;
+    out.length = last - first + 1;
+    return RangeRequest::Partial;
+}
+
+std::string contentRange(const ByteRange& range, uint64_t size)
+{
+    char buf[72];
+    std::snprintf(buf, sizeof(buf), "bytes %llu-%llu/%llu",
+                  static_cast<unsigned long long>(range.first),
+                  static_cast<unsigned long long>(range.first + range.length - 1),
+                  static_cast<unsigned long long>(size));
+    return buf;
+}
+
+std::string unsatisfiedRange(uint64_t size)
+{
+    char buf[32];
+    std::snprintf(buf, sizeof(buf), "bytes */%llu", static_cast<unsigned long long>(size));
+    return buf;
+}
+
+bool RangeSink::send(const char* data, std::size_t len)
+{
+    const uint64_t start = offset_;
+    offset_ += len;
+    const uint64_t end = range_.first + range_.length;
+    if (offset_ > range_.first && start < end) {
+        const uint64_t from = start < range_.first ? range_.first - start : 0;
+        const uint64_t to = offset_ < end ? len : end - start;
+        if (!out_.send(data + from, static_cast<std::size_t>(to - from))) {
+            return false;
+        }
+        sent_ += to - from;
+    }
+    return !complete();
+}
+
+namespace {
+
+/// `[a,b,...]` of one array, comma-placed.
+template <typename T, typename Emit>
+void writeArray(JsonStreamWriter& out, const std::vector<T>& items, Emit emit)
+{
+    out.raw("[");
+    for (std::size_t i = 0; i < items.size(); ++i) {
+        if (i > 0) {
+            out.raw(",");
+        }
+        emit(items[i]);
+    }
+    out.raw("]");
+}
+
+/// Everything after the arrays, in serializeHistory() key order.
+void writeEcho(JsonStreamWriter& out, const HistorySeries& echo,
+               std::size_t count, uint32_t filled)
+{
+    out.raw(",\"metric\":");
+    out.string(echo.metric);
+    out.raw(",\"reading\":");
+    if (echo.reading.has_value()) {
+        out.string(*echo.reading);
+    } else {
+        out.raw("null");
+    }
+    out.raw(",\"start\":");
+    out.integer(echo.start);
+    out.raw(",\"end\":");
+    out.integer(echo.end);
+    out.raw(",\"count\":");
+    out.integer(static_cast<int64_t>(count));
+    out.raw(",\"filled\":");
+    out.integer(filled);
+    if (echo.next.has_value()) {
+        out.raw(",\"next\":");
+        out.string(*echo.next);
+    }
+    out.raw("}");
+}
+
+/// What one RawPass emits per point.
+enum class PassOutput {
+    Timestamps,  ///< JSON timestamps[] items
+    Values,      ///< JSON values[] items
+    Records,     ///< binary {epoch, value} records
+};
+
+/**
+ * One pass over the raw readings, emitting @p output per point, with
+ * stepFillHistory()'s raw rule: a gap of more than 1.5 intervals and at
+ * most heartbeat + interval gets the earlier value held one interval
+ * before the later reading.
+ */
+class RawPass final : public IReadingVisitor {
+public:
+    RawPass(JsonStreamWriter& out, PassOutput output, int decimals,
+            uint32_t logIntervalS, uint32_t heartbeatS, std::size_t limit)
+        : out_(out),
+          output_(output),
+          decimals_(decimals),
+          step_(logIntervalS == 0 ? 1 : logIntervalS),
+          maxGap_(static_cast<int64_t>(heartbeatS) + step_),
+          fill_(heartbeatS != 0),
+          limit_(limit)
+    {
+    }
+
+    bool onReading(uint32_t epoch, float value) override
+    {
+        if (readings_ == limit_) {
+            return false;
+        }
+        const int64_t ts = static_cast<int64_t>(epoch);
+        if (readings_ > 0 && fill_) {
+            const int64_t gap = ts - lastEpoch_;
+            if (gap <= maxGap_ && gap * 2 > step_ * 3) {
+                emit(ts - step_, lastValue_);
+                ++filled_;
+            }
+        }
+        emit(ts, value);
+        ++readings_;
+        lastEpoch_ = ts;
+        lastValue_ = value;
+        return out_.ok();
+    }
+
+    std::size_t readings() const { return readings_; }
+    std::size_t points() const { return points_; }
+    uint32_t filled() const { return filled_; }
+    int64_t lastEpoch() const { return lastEpoch_; }
+
+private:
+    void emit(int64_t ts, float value)
+    {
+        switch (output_) {
+        case PassOutput::Records:
+            out_.u32le(static_cast<uint32_t>(ts));
+            out_.f32le(value);
+            break;
+        case PassOutput::Values:
+            out_.raw(points_ > 0 ? "," : "");
+            out_.fixed(static_cast<double>(value), decimals_);
+            break;
+        case PassOutput::Timestamps:
+            out_.raw(points_ > 0 ? "," : "");
+            out_.integer(ts);
+            break;
+        }
+        ++points_;
+    }
+
+    JsonStreamWriter& out_;
+    const PassOutput output_;
+    const int decimals_;  ///< of the values (metricDecimals())
+    const int64_t step_;
+    const int64_t maxGap_;
+    const bool fill_;
+    const std::size_t limit_;
+    std::size_t readings_ = 0;
+    std::size_t points_ = 0;
+    uint32_t filled_ = 0;
+    int64_t lastEpoch_ = 0;
+    float lastValue_ = 0.0f;
+};
+
+/// Keeps the readings a ReadingPager lets through, as series points.
+class PageCollector final : public IReadingVisitor {
+public:
+    explicit PageCollector(HistorySeries& series) : series_(series) {}
+
+    bool onReading(uint32_t epoch, float value) override
+    {
+        series_.timestamps.push_back(static_cast<int64_t>(epoch));
+        series_.values.push_back(value);
+        return true;
+    }
+
+private:
+    HistorySeries& series_;
+};
+
+/// Cuts one metric's readings into /history/sync blocks (see ApiStream.h),
+/// each sent as soon as it fills: a block names its metric, so the body
+/// needs no per-metric count up front and nothing beyond one block is held.
+class SyncBlockWriter final : public IReadingVisitor {
+public:
+    static constexpr std::size_t kBlockRecords = 32;
+
+    SyncBlockWriter(ChunkWriter& out, const char* metric)
+        : out_(out), metric_(metric), nameLen_(std::strlen(metric))
+    {
+    }
+
+    bool onReading(uint32_t epoch, float value) override
+    {
+        epochs_[count_] = epoch;
+        values_[count_] = value;
+        if (++count_ == kBlockRecords) {
+            finish();
+        }
+        return out_.ok();
+    }
+
+    /// Send the partly filled block, if any.
+    void finish()
+    {
+        if (count_ == 0) {
+            return;
+        }
+        const unsigned char head[1] = {static_cast<unsigned char>(nameLen_)};
+        out_.put(head, sizeof(head));
+        out_.put(metric_, nameLen_);
+        const unsigned char count[2] = {
+            static_cast<unsigned char>(count_),
+            static_cast<unsigned char>(count_ >> 8),
+        };
+        out_.put(count, sizeof(count));
+        for (std::size_t i = 0; i < count_; ++i) {
+            out_.u32le(epochs_[i]);
+            out_.f32le(values_[i]);
+        }
+        count_ = 0;
+    }
+
+private:
+    ChunkWriter& out_;
+    const char* metric_;
+    std::size_t nameLen_;
+    uint32_t epochs_[kBlockRecords] = {};
+    float values_[kBlockRecords] = {};
+    std::size_t count_ = 0;
+};
+
+/// The binary body header (see ApiStream.h).
+void writeBinaryHeader(ChunkWriter& out, uint32_t bucketS)
+{
+    out.put(kHistoryBinaryMagic, sizeof(kHistoryBinaryMagic));
+    out.u32le(bucketS);
+}
+
+}  // namespace
+
+bool streamHistory(const HistorySeries& series, IChunkSink& sink,
+                   HistoryFormat format, bool member)
+{
+    JsonStreamWriter out(sink);
+    if (format == HistoryFormat::Binary) {
+        const bool bucketed = series.bucketS != 0;
+        writeBinaryHeader(out, series.bucketS);
+        for (std::size_t i = 0; i < series.timestamps.size(); ++i) {
+            out.u32le(static_cast<uint32_t>(series.timestamps[i]));
+            out.f32le(i < series.values.size() ? series.values[i] : NAN);
+            if (bucketed) {
+                out.f32le(i < series.mins.size() ? series.mins[i] : NAN);
+                out.f32le(i < series.maxs.size() ? series.maxs[i] : NAN);
+            }
+        }
+        return out.flush();
+    }
+
+    auto integer = [&out](int64_t v) { out.integer(v); };
+    const int places = metricDecimals(series.metric);
+    auto number = [&out, places](float v) { out.fixed(static_cast<double>(v), places); };
+    out.raw(member ? "{\"timestamps\":" : "{\"success\":true,\"timestamps\":");
+    writeArray(out, series.timestamps, integer);
+    out.raw(",\"values\":");
+    writeArray(out, series.values, number);
+    out.raw(",\"bucket\":");
+    out.integer(series.bucketS);
+    if (series.bucketS != 0) {
+        out.raw(",\"min\":");
+        writeArray(out, series.mins, number);
+        out.raw(",\"max\":");
+        writeArray(out, series.maxs, number);
+    }
+    writeEcho(out, series, series.timestamps.size(), series.filled);
+    return out.flush();
+}
+
+bool streamRawHistory(const IDataStorage& storage, const HistorySeries& echo,
+                      uint32_t logIntervalS, uint32_t heartbeatS,
+                      IChunkSink& sink, HistoryFormat format, bool member)
+{
+    const uint32_t t0 = static_cast<uint32_t>(echo.start);
+    const uint32_t t1 = static_cast<uint32_t>(echo.end);
+    JsonStreamWriter out(sink);
+
+    if (format == HistoryFormat::Binary) {
+        writeBinaryHeader(out, 0);
+        RawPass records(out, PassOutput::Records, decimals::kShortest, logIntervalS,
+                        heartbeatS, SIZE_MAX);
+        storage.forEachReading(echo.metric, t0, t1, records);
+        return out.flush();
+    }
+
+    out.raw(member ? "{\"timestamps\":[" : "{\"success\":true,\"timestamps\":[");
+    const int places = metricDecimals(echo.metric);
+    RawPass stamps(out, PassOutput::Timestamps, places, logIntervalS, heartbeatS, SIZE_MAX);
+    storage.forEachReading(echo.metric, t0, t1, stamps);
+    out.raw("],\"values\":[");
+    RawPass values(out, PassOutput::Values, places, logIntervalS, heartbeatS,
+                   stamps.readings());
+    if (stamps.readings() > 0) {
+        storage.forEachReading(echo.metric, t0,
+                               static_cast<uint32_t>(stamps.lastEpoch()), values);
+    }
+    if (values.points() != stamps.points() ||
+        values.lastEpoch() != stamps.lastEpoch()) {
+        return false;  // evicted in between; arrays would not align
+    }
+    out.raw("],\"bucket\":0");
+    writeEcho(out, echo, stamps.points(), stamps.filled());
+    return out.flush();
+}
+
+bool streamHistoryPage(const IDataStorage& storage, const HistorySeries& echo,
+                       const ReadingCursor& cursor, std::size_t limit,
+                       IChunkSink& sink)
+{
+    const uint32_t t0 = static_cast<uint32_t>(echo.start);
+    const uint32_t t1 = static_cast<uint32_t>(echo.end);
+    HistorySeries page;
+    page.metric = echo.metric;
+    page.reading = echo.reading;
+    page.start = echo.start;
+    page.end = echo.end;
+
+    PageCollector collect(page);
+    ReadingPager pager(cursor, limit, collect);
+    storage.forEachReading(echo.metric, t0 < cursor.epoch ? cursor.epoch : t0,
+                           t1, pager);
+    if (pager.more()) {
+        page.next = formatReadingCursor(pager.next());
+    }
+    return streamHistory(page, sink);
+}
+
+bool streamHistorySync(const IDataStorage& storage, const HistorySyncMarks& since,
+                       std::size_t limit, uint32_t now, IChunkSink& sink)
+{
+    ChunkWriter out(sink);
+    out.put(kHistorySyncMagic, sizeof(kHistorySyncMagic));
+    out.u32le(now);
+    HistorySyncMarks next = since;
+    std::size_t left = limit;
+    bool more = false;
+    for (std::size_t id = 0; id < metric::kKnownCount && out.ok(); ++id) {
+        if (left == 0) {
+            more = true;
+            break;
+        }
+        // forEachReading seeks to the mark's epoch through the backend's
+        // chunk index (sector summaries on the ring log), so a metric with
+        // nothing new costs an index lookup, not a read of its history.
+        const char* name = metric::kKnownNames[id];
+        SyncBlockWriter blocks(out, name);
+        ReadingPager pager(since[id], left, blocks);
+        storage.forEachReading(name, since[id].epoch, UINT32_MAX, pager);
+        blocks.finish();
+        next[id] = pager.next();
+        left -= pager.taken();
+        if (pager.more()) {
+            more = true;
+            break;
+        }
+    }
+    const std::string token = formatSyncToken(next);
+    const unsigned char tail[4] = {
+        0,  // end of blocks
+        static_cast<unsigned char>(more ? 1 : 0),
+        static_cast<unsigned char>(token.size()),
+        static_cast<unsigned char>(token.size() >> 8),
+    };
+    out.put(tail, sizeof(tail));
+    out.put(token.data(), token.size());
+    return out.flush();
+}
+
+bool streamPowerCapture(PumpCurrentCapture& capture, IChunkSink& sink)
+{
+    ChunkWriter out(sink);
+    out.put(kPowerCaptureMagic, sizeof(kPowerCaptureMagic));
+    out.u32le(capture.periodUs());
+    out.u32le(capture.activeRun());
+    out.u32le(capture.droppedTotal());
+    // Small batches off the ring, so the stack holds one, never the ring.
+    CaptureSample batch[64];
+    std::size_t left = PumpCurrentCapture::kRingSamples;
+    while (left > 0 && out.ok()) {
+        const std::size_t n = capture.drain(
+            batch, left < sizeof(batch) / sizeof(batch[0])
+                       ? left
+                       : sizeof(batch) / sizeof(batch[0]));
+        if (n == 0) {
+            break;
+        }
+        for (std::size_t i = 0; i < n; ++i) {
+            const uint16_t ma = static_cast<uint16_t>(batch[i].milliamps);
+            const unsigned char bytes[4] = {
+                static_cast<unsigned char>(batch[i].run),
+                static_cast<unsigned char>(batch[i].run >> 8),
+                static_cast<unsigned char>(ma),
+                static_cast<unsigned char>(ma >> 8),
+            };
+            out.put(bytes, sizeof(bytes));
+        }
+        left -= n;
+    }
+    return out.flush();
+}
+
+bool streamDecisionTrace(const DecisionTrace& trace, uint32_t after,
+                         IChunkSink& sink)
+{
+    JsonStreamWriter out(sink);
+    out.raw("{\"success\":true,\"written\":");
+    out.integer(trace.written());
+    out.raw(",\"records\":[");
+    // Small batches off the ring, like the capture: the stack holds one.
+    DecisionRecord batch[16];
+    uint32_t next = after;
+    bool first = true;
+    std::size_t n = 0;
+    while (out.ok() &&
+           (n = trace.read(batch, sizeof(batch) / sizeof(batch[0]), next)) > 0) {
+        for (std::size_t i = 0; i < n; ++i) {
+            const DecisionRecord& r = batch[i];
+            out.raw(first ? "{\"seq\":" : ",{\"seq\":");
+            first = false;
+            out.integer(r.sequence);
+            out.raw(",\"atMs\":");
+            out.integer(r.atMs);
+            out.raw(",\"epoch\":");
+            out.integer(r.epoch);
+            out.raw(",\"zone\":");
+            out.integer(r.zone);
+            out.raw(",\"moisture\":");
+            out.fixed(r.moisture, decimals::kMoisture);
+            out.raw(",\"low\":");
+            out.fixed(r.low, decimals::kMoisture);
+            out.raw(",\"high\":");
+            out.fixed(r.high, decimals::kMoisture);
+            out.raw(",\"soakLeftMs\":");
+            out.integer(r.soakLeftMs);
+            out.raw(",\"burstS\":");
+            out.integer(r.burstS);
+            out.raw(",\"gate\":\"");
+            out.raw(decisionGateName(r.gate));
+            out.raw("\",\"action\":\"");
+            out.raw(decisionActionName(r.action));
+            out.raw((r.flags & DecisionRecord::kFresh) != 0 ? "\",\"fresh\":true"
+                                                            : "\",\"fresh\":false");
+            out.raw((r.flags & DecisionRecord::kPumpOn) != 0 ? ",\"pumpOn\":true"
+                                                             : ",\"pumpOn\":false");
+            out.raw((r.flags & DecisionRecord::kBurstEnded) != 0
+                        ? ",\"burstEnded\":true}"
+                        : ",\"burstEnded\":false}");
+            next = r.sequence;
+        }
+    }
+    out.raw("],\"next\":");
+    out.integer(next);
+    out.raw("}");
+    return out.flush();
+}
+
+bool streamTraceBuffer(const TraceBuffer& trace, uint32_t nowUs, IChunkSink& sink)
+{
+    ChunkWriter out(sink);
+    out.put(kTraceMagic, sizeof(kTraceMagic));
+    out.u32le(nowUs);
+    out.u32le(static_cast<uint32_t>(TraceBuffer::kCores));
+    for (std::size_t core = 0; core < TraceBuffer::kCores; ++core) {
+        out.u32le(trace.ring(core).written());
+    }
+    TraceRecord batch[16];
+    for (std::size_t core = 0; core < TraceBuffer::kCores && out.ok(); ++core) {
+        const TraceRing& ring = trace.ring(core);
+        uint32_t after = 0;
+        std::size_t n = 0;
+        while (out.ok() &&
+               (n = ring.read(batch, sizeof(batch) / sizeof(batch[0]), after)) > 0) {
+            for (std::size_t i = 0; i < n; ++i) {
+                const TraceRecord& r = batch[i];
+                const auto id = static_cast<uint16_t>(r.id);
+                const unsigned char tag[4] = {
+                    static_cast<unsigned char>(id),
+                    static_cast<unsigned char>(id >> 8),
+                    static_cast<unsigned char>(core),
+                    static_cast<unsigned char>(r.level),
+                };
+                out.u32le(r.sequence);
+                out.u32le(r.atUs);
+                out.put(tag, sizeof(tag));
+                out.u32le(r.a);
+                out.u32le(r.b);
+                after = r.sequence;
+            }
+        }
+    }
+    return out.flush();
+}
+
+bool streamModbusCapture(const ModbusFrameCapture& capture, uint32_t nowUs,
+                         uint32_t after, IChunkSink& sink)
+{
+    ChunkWriter out(sink);
+    out.put(kModbusCaptureMagic, sizeof(kModbusCaptureMagic));
+    out.u32le(nowUs);
+    out.u32le(capture.written());
+    out.u32le(capture.enabled() ? 1u : 0u);
+    ModbusFrame batch[8];
+    std::size_t n = 0;
+    while (out.ok() &&
+           (n = capture.read(batch, sizeof(batch) / sizeof(batch[0]), after)) > 0) {
+        for (std::size_t i = 0; i < n; ++i) {
+            const ModbusFrame& f = batch[i];
+            const unsigned char tag[4] = {
+                static_cast<unsigned char>(f.dir),
+                static_cast<unsigned char>(f.crcOk ? 1 : 0),
+                static_cast<unsigned char>(f.length),
+                static_cast<unsigned char>(f.length >> 8),
+            };
+            out.u32le(f.sequence);
+            out.u32le(f.atUs);
+            out.put(tag, sizeof(tag));
+            out.put(f.bytes.data(), f.stored());
+            after = f.sequence;
+        }
+    }
+    return out.flush();
+}
+
+bool streamInputRecording(const InputRecorder& recorder, const BlockRingFile* file,
+                          IChunkSink& sink)
+{
+    ChunkWriter out(sink);
+    // The file's mark is the newest RAM block it took this boot.
+    uint32_t flushed = 0;
+    if (file != nullptr) {
+        flushed = file->forEach([&out](const uint8_t* data, std::size_t len) {
+            out.put(data, len);
+            return out.ok();
+        });
+    }
+    std::vector<uint8_t> block(input_record::kBlockBytes);
+    const uint32_t newest = recorder.newest();
+    uint32_t sequence = recorder.oldest();
+    if (sequence <= flushed) {
+        sequence = flushed + 1;
+    }
+    for (; out.ok() && sequence != 0 && sequence <= newest; ++sequence) {
+        // 0 bytes: rolled out of the ring since newest() was read.
+        out.put(block.data(), recorder.copyBlock(sequence, block.data()));
+    }
+    return out.flush();
+}
+
+}  // namespace api
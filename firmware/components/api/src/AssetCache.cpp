@@ -0,0 +1,120 @@
+// SPDX-FileCopyrightText: 2026 Cryptotomte
+// SPDX-License-Identifier: AGPL-3.0-or-later
+/**
+ * @file AssetCache.cpp
+ * @brief Implementation of the static asset validators and RAM cache.
+ */
+
+#include "api/AssetCache.h"
+
+#include <utility>
+
+namespace api {
+
+namespace {
+
+bool isHex(char c)
+{
+    return (c >= '0' && c <= '9') || (c >= 'a' && c <= 'f');
+}
+
+}  // namespace
+
+void AssetCache::loadManifest(const std::string& text)
+{
+    std::vector<Tag> tags;
+    std::size_t pos = 0;
+    while (pos < text.size()) {
+        std::size_t eol = text.find('\n', pos);
+        if (eol == std::string::npos) {
+            eol = text.size();
+        }
+        std::string line = text.substr(pos, eol - pos);
+        pos = eol + 1;
+        if (!line.empty() && line.back() == '\r') {
+            line.pop_back();
+        }
+        const std::size_t space = line.rfind(' ');
+        if (space == std::string::npos || space == 0 ||
+            line.size() - space - 1 != kHashLen) {
+            continue;
+        }
+        bool hex = true;
+        for (std::size_t i = space + 1; i < line.size(); ++i) {
+            hex = hex && isHex(line[i]);
+        }
+        if (!hex) {
+            continue;
+        }
+        tags.push_back(Tag{line.substr(0, space), "\"" + line.substr(space + 1) + "\""});
+    }
+    std::lock_guard<StaticMutex> lock(mutex_);
+    tags_ = std::move(tags);
+    manifestLoaded_ = true;
+}
+
+bool AssetCache::manifestLoaded() const
+{
+    std::lock_guard<StaticMutex> lock(mutex_);
+    return manifestLoaded_;
+}
+
+std::string AssetCache::etagFor(const std::string& path) const
+{
+    std::lock_guard<StaticMutex> lock(mutex_);
+    for (const Tag& t : tags_) {
+        if (t.path == path) {
+            return t.etag;
+        }
+    }
+    return "";
+}
+
+std::shared_ptr<const std::string> AssetCache::find(const std::string& path) const
+{
+    std::lock_guard<StaticMutex> lock(mutex_);
+    for (const Entry& e : entries_) {
+        if (e.path == path) {
+            return e.body;
+        }
+    }
+    return nullptr;
+}
+
+AssetCache::~AssetCache()
+{
+    bufferBudgets().account(BufferPool::AssetCache, bytesUsed_, false);
+}
+
+bool AssetCache::fits(std::size_t size) const
+{
+    std::lock_guard<StaticMutex> lock(mutex_);
+    return size <= maxEntryBytes_ && bytesUsed_ + size <= budgetBytes_;
+}
+
+bool AssetCache::insert(const std::string& path, std::string body)
+{
+    std::lock_guard<StaticMutex> lock(mutex_);
+    const std::size_t size = body.size();
+    if (size > maxEntryBytes_ || bytesUsed_ + size > budgetBytes_) {
+        return false;
+    }
+    for (const Entry& e : entries_) {
+        if (e.path == path) {
+            return false;
+        }
+    }
+    entries_.push_back(
+        Entry{path, std::make_shared<const std::string>(std::move(body))});
+    bytesUsed_ += size;
+    bufferBudgets().account(BufferPool::AssetCache, size, true);
+    return true;
+}
+
+std::size_t AssetCache::bytesUsed() const
+{
+    std::lock_guard<StaticMutex> lock(mutex_);
+    return bytesUsed_;
+}
+
+}  // namespace api
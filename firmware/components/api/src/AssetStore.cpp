@@ -0,0 +1,80 @@
+// SPDX-FileCopyrightText: 2026 Cryptotomte
+// SPDX-License-Identifier: AGPL-3.0-or-later
+/**
+ * @file AssetStore.cpp
+ * @brief Manifest and body reads for the asset cache (see AssetStore.h).
+ */
+
+#include "api/AssetStore.h"
+
+#include <cstdio>
+#include <utility>
+
+namespace api {
+
+AssetStore::AssetStore(std::string basePath)
+    : basePath_(std::move(basePath)),
+      cache_(bufferBudgets().declare(BufferPool::AssetCache, AssetCache::kBudget))
+{
+}
+
+AssetCache& AssetStore::cache()
+{
+    if (!cache_.manifestLoaded()) {
+        // A missing manifest (an image built before the validators) loads as
+        // empty: assets are then served untagged, as before.
+        std::string text;
+        const std::string path = basePath_ + "/" + kAssetManifestName;
+        if (FILE* f = std::fopen(path.c_str(), "rb")) {
+            char buf[256];
+            std::size_t n;
+            while ((n = std::fread(buf, 1, sizeof(buf), f)) > 0) {
+                text.append(buf, n);
+            }
+            std::fclose(f);
+        }
+        cache_.loadManifest(text);
+    }
+    return cache_;
+}
+
+bool AssetStore::fetch(const std::string& path, StaticAsset& out)
+{
+    AssetCache& assets = cache();
+    std::shared_ptr<const std::string> body = assets.find(path);
+    if (body == nullptr) {
+        const std::string full = basePath_ + "/" + path + ".gz";
+        FILE* f = std::fopen(full.c_str(), "rb");
+        if (f == nullptr) {
+            return false;
+        }
+        long size = -1;
+        if (std::fseek(f, 0, SEEK_END) == 0) {
+            size = std::ftell(f);
+            std::rewind(f);
+        }
+        if (size <= 0 || !assets.fits(static_cast<std::size_t>(size))) {
+            std::fclose(f);
+            return false;
+        }
+        std::string bytes(static_cast<std::size_t>(size), '\0');
+        const std::size_t got = std::fread(&bytes[0], 1, bytes.size(), f);
+        std::fclose(f);
+        if (got != bytes.size()) {
+            return false;
+        }
+        // A racing first fetch of the same path is refused here but finds
+        // the other's copy; one that lost the budget to another path is not
+        // served from RAM at all.
+        assets.insert(path, std::move(bytes));
+        body = assets.find(path);
+        if (body == nullptr) {
+            return false;
+        }
+    }
+    out.gz = std::move(body);
+    out.etag = assets.etagFor(path);
+    return true;
+}
+
+}  // namespace api
@@ -0,0 +1,145 @@
+// SPDX-FileCopyrightText: 2026 Cryptotomte
+// SPDX-License-Identifier: AGPL-3.0-or-later
+/**
+ * @file CsvExport.cpp
+ * @brief The epoch merge behind GET /api/v1/export.csv (see CsvExport.h).
+ */
+
+#include "api/CsvExport.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <cstring>
+#include <ctime>
+
+namespace api {
+
+namespace {
+
+/// @p text as one CSV cell: quoted, quotes doubled, when it holds a quote
+/// or a line break.
+void appendCell(std::string& line, const std::string& text)
+{
+    if (text.find_first_of("\"\r\n") == std::string::npos) {
+        line += text;
+        return;
+    }
+    line += '"';
+    for (char c : text) {
+        if (c == '"') {
+            line += '"';
+        }
+        line += c;
+    }
+    line += '"';
+}
+
+}  // namespace
+
+CsvExportSource::CsvExportSource(const IDataStorage& storage,
+                                 const std::vector<std::string>& metrics, uint32_t t0,
+                                 uint32_t t1)
+    : storage_(storage), t0_(t0), t1_(t1), streams_(metrics.size())
+{
+    line_.reserve(32 + metrics.size() * 16);
+    line_ = "epoch,time";
+    for (std::size_t i = 0; i < metrics.size(); ++i) {
+        streams_[i].metric = metrics[i];
+        streams_[i].cursor = ReadingCursor{t0, 0};
+        line_ += ',';
+        appendCell(line_, metrics[i]);
+    }
+    line_ += "\r\n";
+}
+
+bool CsvExportSource::ready(Stream& s)
+{
+    if (s.head < s.count) {
+        return true;
+    }
+    if (!s.more) {
+        return false;
+    }
+    // The pager hands over at most a batch.
+    class Fill final : public IReadingVisitor {
+    public:
+        explicit Fill(Stream& stream) : stream_(stream) {}
+        bool onReading(uint32_t epoch, float value) override
+        {
+            stream_.batch[stream_.count++] = Reading{epoch, value};
+            return true;
+        }
+
+    private:
+        Stream& stream_;
+    } fill(s);
+    s.head = 0;
+    s.count = 0;
+    ReadingPager pager(s.cursor, kBatchReadings, fill);
+    const uint32_t from = s.cursor.epoch > t0_ ? s.cursor.epoch : t0_;
+    storage_.forEachReading(s.metric, from, t1_, pager);
+    s.cursor = pager.next();
+    s.more = pager.more();
+    return s.count != 0;
+}
+
+bool CsvExportSource::nextRow()
+{
+    bool any = false;
+    uint32_t epoch = 0;
+    for (Stream& s : streams_) {
+        if (ready(s) && (!any || s.batch[s.head].epoch < epoch)) {
+            epoch = s.batch[s.head].epoch;
+            any = true;
+        }
+    }
+    if (!any) {
+        return false;
+    }
+
+    char cell[32];
+    std::snprintf(cell, sizeof cell, "%lu,", static_cast<unsigned long>(epoch));
+    line_ = cell;
+    const std::time_t when = static_cast<std::time_t>(epoch);
+    std::tm utc{};
+    gmtime_r(&when, &utc);
+    std::strftime(cell, sizeof cell, "%Y-%m-%dT%H:%M:%SZ", &utc);
+    line_ += cell;
+    for (Stream& s : streams_) {
+        line_ += ',';
+        // ready() was asked above; a stream whose head is this epoch
+        // gives it up.
+        if (s.head < s.count && s.batch[s.head].epoch == epoch) {
+            const float value = s.batch[s.head].value;
+            ++s.head;
+            if (std::isfinite(value)) {
+                std::snprintf(cell, sizeof cell, "%.7g", static_cast<double>(value));
+                line_ += cell;
+            }
+        }
+    }
+    line_ += "\r\n";
+    ++rows_;
+    return true;
+}
+
+int CsvExportSource::receive(uint8_t* dst, std::size_t len)
+{
+    std::size_t out = 0;
+    while (out < len) {
+        if (sent_ == line_.size()) {
+            if (!nextRow()) {
+                break;
+            }
+            sent_ = 0;
+        }
+        const std::size_t n = std::min(len - out, line_.size() - sent_);
+        std::memcpy(dst + out, line_.data() + sent_, n);
+        sent_ += n;
+        out += n;
+    }
+    return static_cast<int>(out);
+}
+
+}  // namespace api
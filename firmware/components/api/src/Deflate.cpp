@@ -0,0 +1,416 @@
+// SPDX-FileCopyrightText: 2026 Cryptotomte
+// SPDX-License-Identifier: AGPL-3.0-or-later
+/**
+ * @file Deflate.cpp
+ * @brief Implementation of the fixed-Huffman streaming deflate encoder.
+ */
+
+#include "api/Deflate.h"
+
+#include <cstring>
+#include <iterator>
+
+namespace api {
+
+namespace {
+
+/// Length symbols 257..285: base length and extra bits (RFC 1951 3.2.5).
+constexpr uint16_t kLengthBase[29] = {3,  4,  5,  6,  7,  8,  9,  10, 11,  13,
+                                      15, 17, 19, 23, 27, 31, 35, 43, 51,  59,
+                                      67, 83, 99, 115, 131, 163, 195, 227, 258};
+constexpr uint8_t kLengthExtra[29] = {0, 0, 0, 0, 0, 0, 0, 0, 1, 1, 1, 1, 2, 2, 2,
+                                      2, 3, 3, 3, 3, 4, 4, 4, 4, 5, 5, 5, 5, 0};
+
+/// Distance codes 0..19 — all a kWindowBytes window can reach.
+constexpr uint16_t kDistanceBase[20] = {1,  2,  3,  4,  5,  7,   9,   13,  17,  25,
+                                        33, 49, 65, 97, 129, 193, 257, 385, 513, 769};
+constexpr uint8_t kDistanceExtra[20] = {0, 0, 0, 0, 1, 1, 2, 2, 3, 3,
+                                        4, 4, 5, 5, 6, 6, 7, 7, 8, 8};
+
+/// CRC-32 (reflected 0xEDB88320) four bits at a time: a 64-byte table.
+constexpr uint32_t kCrcNibble[16] = {
+    0x00000000u, 0x1DB71064u, 0x3B6E20C8u, 0x26D930ACu, 0x76DC4190u, 0x6B6B51F4u,
+    0x4DB26158u, 0x5005713Cu, 0xEDB88320u, 0xF00F9344u, 0xD6D6A3E8u, 0xCB61B38Cu,
+    0x9B64C2B0u, 0x86D3D2D4u, 0xA00AE278u, 0xBDBDF21Cu,
+};
+
+constexpr uint32_t kAdlerModulus = 65521;
+
+/// gzip member header: magic, CM=deflate, no flags, no mtime, OS unknown.
+constexpr uint8_t kGzipHeader[10] = {0x1F, 0x8B, 8, 0, 0, 0, 0, 0, 0, 0xFF};
+/// zlib header: CM=8 with a 1 KiB window (CINFO 2), FLEVEL 0, FCHECK.
+constexpr uint8_t kZlibHeader[2] = {0x28, 0x15};
+
+char lower(char c)
+{
+    return c >= 'A' && c <= 'Z' ? static_cast<char>(c - 'A' + 'a') : c;
+}
+
+bool equalsIgnoreCase(std::string_view a, std::string_view b)
+{
+    if (a.size() != b.size()) {
+        return false;
+    }
+    for (std::size_t i = 0; i < a.size(); ++i) {
+        if (lower(a[i]) != lower(b[i])) {
+            return false;
+        }
+    }
+    return true;
+}
+
+std::string_view trim(std::string_view text)
+{
+    while (!text.empty() && (text.front() == ' ' || text.front() == '\t')) {
+        text.remove_prefix(1);
+    }
+    while (!text.empty() && (text.back() == ' ' || text.back() == '\t')) {
+        text.remove_suffix(1);
+    }
+    return text;
+}
+
+/// A q-value in thousandths: "0", "0.5", "1", "1.000". Malformed -> 1000.
+unsigned parseQuality(std::string_view text)
+{
+    if (text.empty() || (text[0] != '0' && text[0] != '1')) {
+        return 1000;
+    }
+    if (text[0] == '1') {
+        return 1000;
+    }
+    unsigned q = 0;
+    unsigned scale = 100;
+    if (text.size() > 1 && text[1] == '.') {
+        for (std::size_t i = 2; i < text.size() && i < 5; ++i) {
+            if (text[i] < '0' || text[i] > '9') {
+                return 1000;
+            }
+            q += static_cast<unsigned>(text[i] - '0') * scale;
+            scale /= 10;
+        }
+    } else if (text.size() > 1) {
+        return 1000;
+    }
+    return q;
+}
+
+unsigned reverseBits(uint32_t code, unsigned count)
+{
+    unsigned out = 0;
+    for (unsigned i = 0; i < count; ++i) {
+        out = (out << 1) | (code & 1u);
+        code >>= 1;
+    }
+    return out;
+}
+
+}  // namespace
+
+const char* contentEncodingName(ContentEncoding encoding)
+{
+    switch (encoding) {
+    case ContentEncoding::Gzip:
+        return "gzip";
+    case ContentEncoding::Deflate:
+        return "deflate";
+    case ContentEncoding::Identity:
+        break;
+    }
+    return nullptr;
+}
+
+ContentEncoding selectContentEncoding(std::string_view acceptEncoding)
+{
+    // -1 = not named; otherwise the q in thousandths.
+    int gzip = -1;
+    int deflate = -1;
+    int any = -1;
+    std::size_t begin = 0;
+    while (begin < acceptEncoding.size()) {
+        std::size_t comma = acceptEncoding.find(',', begin);
+        if (comma == std::string_view::npos) {
+            comma = acceptEncoding.size();
+        }
+        const std::string_view item = acceptEncoding.substr(begin, comma - begin);
+        begin = comma + 1;
+
+        const std::size_t semi = item.find(';');
+        const std::string_view name = trim(item.substr(0, semi));
+        int q = 1000;
+        if (semi != std::string_view::npos) {
+            const std::string_view param = trim(item.substr(semi + 1));
+            if (param.size() >= 2 && lower(param[0]) == 'q' && param[1] == '=') {
+                q = static_cast<int>(parseQuality(trim(param.substr(2))));
+            }
+        }
+        if (equalsIgnoreCase(name, "gzip") || equalsIgnoreCase(name, "x-gzip")) {
+            gzip = q;
+        } else if (equalsIgnoreCase(name, "deflate")) {
+            deflate = q;
+        } else if (name == "*") {
+            any = q;
+        }
+    }
+    if (gzip < 0) {
+        gzip = any < 0 ? 0 : any;
+    }
+    if (deflate < 0) {
+        deflate = any < 0 ? 0 : any;
+    }
+    if (gzip == 0 && deflate == 0) {
+        return ContentEncoding::Identity;
+    }
+    return gzip >= deflate ? ContentEncoding::Gzip : ContentEncoding::Deflate;
+}
+
+uint32_t crc32Update(uint32_t crc, const void* data, std::size_t len)
+{
+    const uint8_t* p = static_cast<const uint8_t*>(data);
+    crc = ~crc;
+    for (std::size_t i = 0; i < len; ++i) {
+        crc ^= p[i];
+        crc = (crc >> 4) ^ kCrcNibble[crc & 0x0F];
+        crc = (crc >> 4) ^ kCrcNibble[crc & 0x0F];
+    }
+    return ~crc;
+}
+
+uint32_t adler32Update(uint32_t adler, const void* data, std::size_t len)
+{
+    const uint8_t* p = static_cast<const uint8_t*>(data);
+    uint32_t a = adler & 0xFFFF;
+    uint32_t b = adler >> 16;
+    while (len > 0) {
+        // 5552 bytes is the most that cannot overflow b before the modulo.
+        const std::size_t n = len < 5552 ? len : 5552;
+        for (std::size_t i = 0; i < n; ++i) {
+            a += p[i];
+            b += a;
+        }
+        a %= kAdlerModulus;
+        b %= kAdlerModulus;
+        p += n;
+        len -= n;
+    }
+    return (b << 16) | a;
+}
+
+DeflateSink::DeflateSink(IChunkSink& out, ContentEncoding encoding)
+    : out_(out),
+      encoding_(encoding),
+      buf_{},
+      head_{},
+      prev_{},
+      check_(encoding == ContentEncoding::Deflate ? 1u : 0u)
+{
+}
+
+bool DeflateSink::send(const char* data, std::size_t len)
+{
+    if (!started_) {
+        start();
+    }
+    check_ = encoding_ == ContentEncoding::Deflate ? adler32Update(check_, data, len)
+                                                   : crc32Update(check_, data, len);
+    inputBytes_ += static_cast<uint32_t>(len);
+    while (len > 0) {
+        if (end_ == kBufferBytes) {
+            slide();
+        }
+        const std::size_t n = len < kBufferBytes - end_ ? len : kBufferBytes - end_;
+        std::memcpy(buf_ + end_, data, n);
+        end_ += n;
+        data += n;
+        len -= n;
+        compress(false);
+    }
+    return out_.ok();
+}
+
+bool DeflateSink::finish()
+{
+    if (!started_) {
+        start();
+    }
+    compress(true);
+    putCode(0, 7);  // end of block (symbol 256)
+    if (bitCount_ > 0) {
+        putBits(0, 8 - bitCount_);
+    }
+    if (encoding_ == ContentEncoding::Deflate) {
+        put32be(check_);
+    } else {
+        put32le(check_);
+        put32le(inputBytes_);  // ISIZE: the length mod 2^32
+    }
+    return out_.flush();
+}
+
+void DeflateSink::start()
+{
+    started_ = true;
+    if (encoding_ == ContentEncoding::Deflate) {
+        out_.put(kZlibHeader, sizeof kZlibHeader);
+    } else {
+        out_.put(kGzipHeader, sizeof kGzipHeader);
+    }
+    // The whole body is one final block with the fixed codes: nothing to
+    // decide per block, and the header is three bits.
+    putBits(1, 1);  // BFINAL
+    putBits(1, 2);  // BTYPE 01
+}
+
+void DeflateSink::compress(bool flush)
+{
+    // Until the last bytes arrive, keep a whole maximum match of lookahead.
+    const std::size_t lookahead = flush ? 1 : kMaxMatch;
+    while (end_ - pos_ >= lookahead) {
+        std::size_t distance = 0;
+        const std::size_t length = longestMatch(pos_, distance);
+        if (length == 0) {
+            literal(buf_[pos_]);
+            insert(pos_);
+            ++pos_;
+            continue;
+        }
+        match(length, distance);
+        for (std::size_t i = 0; i < length; ++i) {
+            insert(pos_ + i);
+        }
+        pos_ += length;
+    }
+}
+
+void DeflateSink::slide()
+{
+    // Only ever called with pos_ past 2 windows, so one window of history
+    // survives; shifting by a whole window keeps prev_'s indexing valid.
+    std::memmove(buf_, buf_ + kWindowBytes, end_ - kWindowBytes);
+    end_ -= kWindowBytes;
+    pos_ -= kWindowBytes;
+    const auto rebase = [](uint16_t& entry) {
+        entry = entry > kWindowBytes ? static_cast<uint16_t>(entry - kWindowBytes) : 0;
+    };
+    for (uint16_t& entry : head_) {
+        rebase(entry);
+    }
+    for (uint16_t& entry : prev_) {
+        rebase(entry);
+    }
+}
+
+std::size_t DeflateSink::hashAt(std::size_t pos) const
+{
+    const uint32_t v = (static_cast<uint32_t>(buf_[pos]) << 16) |
+                       (static_cast<uint32_t>(buf_[pos + 1]) << 8) | buf_[pos + 2];
+    return (v * 2654435761u) >> (32 - kHashBits);
+}
+
+void DeflateSink::insert(std::size_t pos)
+{
+    if (pos + kMinMatch > end_) {
+        return;  // too close to the end to hash; never a match start
+    }
+    const std::size_t h = hashAt(pos);
+    prev_[pos % kWindowBytes] = head_[h];
+    head_[h] = static_cast<uint16_t>(pos + 1);
+}
+
+std::size_t DeflateSink::longestMatch(std::size_t pos, std::size_t& distance) const
+{
+    const std::size_t avail = end_ - pos;
+    const std::size_t limit = avail < kMaxMatch ? avail : kMaxMatch;
+    if (limit < kMinMatch) {
+        return 0;
+    }
+    std::size_t best = 0;
+    std::size_t candidate = head_[hashAt(pos)];
+    for (std::size_t chain = 0; candidate != 0 && chain < kMaxChain; ++chain) {
+        const std::size_t c = candidate - 1;
+        if (c >= pos || pos - c > kWindowBytes) {
+            break;
+        }
+        if (buf_[c + best] == buf_[pos + best]) {
+            std::size_t len = 0;
+            while (len < limit && buf_[c + len] == buf_[pos + len]) {
+                ++len;
+            }
+            if (len > best) {
+                best = len;
+                distance = pos - c;
+                if (best == limit) {
+                    break;
+                }
+            }
+        }
+        const std::size_t next = prev_[c % kWindowBytes];
+        if (next >= candidate) {
+            break;  // the slot was reused by a newer position
+        }
+        candidate = next;
+    }
+    return best >= kMinMatch ? best : 0;
+}
+
+void DeflateSink::putBits(uint32_t value, unsigned count)
+{
+    bits_ |= value << bitCount_;
+    bitCount_ += count;
+    while (bitCount_ >= 8) {
+        const uint8_t byte = static_cast<uint8_t>(bits_);
+        out_.put(&byte, 1);
+        bits_ >>= 8;
+        bitCount_ -= 8;
+    }
+}
+
+void DeflateSink::putCode(uint32_t code, unsigned count)
+{
+    putBits(reverseBits(code, count), count);
+}
+
+void DeflateSink::literal(uint8_t byte)
+{
+    if (byte < 144) {
+        putCode(0x30u + byte, 8);
+    } else {
+        putCode(0x190u + (byte - 144u), 9);
+    }
+}
+
+void DeflateSink::match(std::size_t length, std::size_t distance)
+{
+    std::size_t i = std::size(kLengthBase) - 1;
+    while (kLengthBase[i] > length) {
+        --i;
+    }
+    const uint32_t symbol = 257 + static_cast<uint32_t>(i);
+    if (symbol < 280) {
+        putCode(symbol - 256, 7);
+    } else {
+        putCode(0xC0u + (symbol - 280), 8);
+    }
+    putBits(static_cast<uint32_t>(length - kLengthBase[i]), kLengthExtra[i]);
+
+    std::size_t d = std::size(kDistanceBase) - 1;
+    while (kDistanceBase[d] > distance) {
+        --d;
+    }
+    putCode(static_cast<uint32_t>(d), 5);
+    putBits(static_cast<uint32_t>(distance - kDistanceBase[d]), kDistanceExtra[d]);
+}
+
+void DeflateSink::put32be(uint32_t value)
+{
+    const uint8_t bytes[4] = {static_cast<uint8_t>(value >> 24), static_cast<uint8_t>(value >> 16),
+                              static_cast<uint8_t>(value >> 8), static_cast<uint8_t>(value)};
+    out_.put(bytes, sizeof bytes);
+}
+
+void DeflateSink::put32le(uint32_t value)
+{
+    out_.u32le(value);
+}
+
+}  // namespace api
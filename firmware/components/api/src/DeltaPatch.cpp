@@ -0,0 +1,226 @@
+// SPDX-FileCopyrightText: 2026 Cryptotomte
+// SPDX-License-Identifier: AGPL-3.0-or-later
+/**
+ * @file DeltaPatch.cpp
+ * @brief Header parsing and the op decoder (see DeltaPatch.h).
+ *
+ * Every length and base position is checked against what the op may
+ * cover before it is used, so a corrupt or hostile patch ends the upload
+ * (malformed) instead of reading past the base or spinning on empty runs.
+ */
+
+#include "api/DeltaPatch.h"
+
+#include <cstring>
+
+namespace api {
+
+namespace {
+
+constexpr uint8_t kMagic[4] = {'W', 'S', 'D', 'P'};
+constexpr uint8_t kVersion = 1;
+constexpr uint8_t kOpData = 0x00;
+constexpr uint8_t kOpDiff = 0x01;
+
+uint32_t le32(const uint8_t* p)
+{
+    return static_cast<uint32_t>(p[0]) | static_cast<uint32_t>(p[1]) << 8 |
+           static_cast<uint32_t>(p[2]) << 16 | static_cast<uint32_t>(p[3]) << 24;
+}
+
+}  // namespace
+
+bool isDeltaPatch(const uint8_t* data, std::size_t len)
+{
+    return len >= sizeof kMagic && std::memcmp(data, kMagic, sizeof kMagic) == 0;
+}
+
+bool parseDeltaHeader(const uint8_t* data, std::size_t len, DeltaHeader& out)
+{
+    if (len < kDeltaHeaderBytes || !isDeltaPatch(data, len) || data[4] != kVersion ||
+        data[5] != 0 || data[6] != 0 || data[7] != 0) {
+        return false;
+    }
+    DeltaHeader h;
+    h.targetBytes = le32(data + 8);
+    h.baseBytes = le32(data + 12);
+    std::memcpy(h.baseSha256.data(), data + 16, h.baseSha256.size());
+    std::memcpy(h.targetSha256.data(), data + 48, h.targetSha256.size());
+    if (h.targetBytes == 0 || h.baseBytes == 0) {
+        return false;
+    }
+    out = h;
+    return true;
+}
+
+DeltaSource::DeltaSource(IChunkSource& patch, std::size_t patchBytes, IRunningImage& base,
+                         std::size_t baseBytes)
+    : patch_(patch), patchBytes_(patchBytes), patchLeft_(patchBytes), base_(base),
+      baseBytes_(baseBytes)
+{
+}
+
+int DeltaSource::receive(uint8_t* dst, std::size_t len)
+{
+    std::size_t done = 0;
+    while (done < len) {
+        if (opLeft_ == 0 && !startOp()) {
+            return -1;
+        }
+        const std::size_t n = opLeft_ < len - done ? opLeft_ : len - done;
+        const bool ok = op_ == Op::Data ? take(dst + done, n) : applyDiff(dst + done, n);
+        if (!ok) {
+            return -1;
+        }
+        opLeft_ -= n;
+        done += n;
+    }
+    return static_cast<int>(done);
+}
+
+bool DeltaSource::bad()
+{
+    malformed_ = true;
+    return false;
+}
+
+bool DeltaSource::fill()
+{
+    if (patchLeft_ == 0) {
+        return bad();  // the ops end before the target does
+    }
+    const std::size_t want = patchLeft_ < sizeof buf_ ? patchLeft_ : sizeof buf_;
+    const int r = patch_.receive(buf_, want);
+    if (r <= 0) {
+        return false;
+    }
+    bufPos_ = 0;
+    bufLen_ = static_cast<std::size_t>(r);
+    patchLeft_ -= bufLen_;
+    return true;
+}
+
+bool DeltaSource::byte(uint8_t& out)
+{
+    if (bufPos_ == bufLen_ && !fill()) {
+        return false;
+    }
+    out = buf_[bufPos_++];
+    return true;
+}
+
+bool DeltaSource::take(uint8_t* dst, std::size_t len)
+{
+    while (len > 0) {
+        if (bufPos_ == bufLen_ && !fill()) {
+            return false;
+        }
+        std::size_t n = bufLen_ - bufPos_;
+        if (n > len) {
+            n = len;
+        }
+        std::memcpy(dst, buf_ + bufPos_, n);
+        bufPos_ += n;
+        dst += n;
+        len -= n;
+    }
+    return true;
+}
+
+bool DeltaSource::varint(uint32_t& out)
+{
+    uint32_t value = 0;
+    for (unsigned shift = 0; shift < 35; shift += 7) {
+        uint8_t b = 0;
+        if (!byte(b)) {
+            return false;
+        }
+        if (shift == 28 && (b & 0x70) != 0) {
+            return bad();  // more than 32 bits
+        }
+        value |= static_cast<uint32_t>(b & 0x7f) << shift;
+        if ((b & 0x80) == 0) {
+            out = value;
+            return true;
+        }
+    }
+    return bad();
+}
+
+bool DeltaSource::startOp()
+{
+    uint8_t code = 0;
+    if (!byte(code)) {
+        return false;
+    }
+    if (code == kOpData) {
+        uint32_t n = 0;
+        if (!varint(n)) {
+            return false;
+        }
+        if (n == 0) {
+            return bad();
+        }
+        op_ = Op::Data;
+        opLeft_ = n;
+        return true;
+    }
+    if (code != kOpDiff) {
+        return bad();
+    }
+    uint32_t zigzag = 0;
+    uint32_t n = 0;
+    if (!varint(zigzag) || !varint(n)) {
+        return false;
+    }
+    const int64_t half = zigzag >> 1;
+    const int64_t seek = (zigzag & 1u) != 0 ? -half - 1 : half;
+    const int64_t pos = static_cast<int64_t>(basePos_) + seek;
+    if (n == 0 || pos < 0 || static_cast<uint64_t>(pos) + n > baseBytes_) {
+        return bad();
+    }
+    op_ = Op::Diff;
+    opLeft_ = n;
+    basePos_ = static_cast<std::size_t>(pos);
+    zeros_ = 0;
+    lits_ = 0;
+    return true;
+}
+
+bool DeltaSource::applyDiff(uint8_t* out, std::size_t len)
+{
+    if (!base_.read(basePos_, out, len)) {
+        return false;
+    }
+    basePos_ += len;
+    std::size_t i = 0;
+    while (i < len) {
+        if (zeros_ == 0 && lits_ == 0) {
+            uint32_t z = 0;
+            uint32_t l = 0;
+            if (!varint(z) || !varint(l)) {
+                return false;
+            }
+            // A run may not be empty or reach past its op.
+            if ((z == 0 && l == 0) || static_cast<uint64_t>(z) + l > opLeft_ - i) {
+                return bad();
+            }
+            zeros_ = z;
+            lits_ = l;
+        }
+        const std::size_t skip = zeros_ < len - i ? zeros_ : len - i;
+        i += skip;
+        zeros_ -= static_cast<uint32_t>(skip);
+        while (zeros_ == 0 && lits_ > 0 && i < len) {
+            uint8_t d = 0;
+            if (!byte(d)) {
+                return false;
+            }
+            out[i++] += d;
+            --lits_;
+        }
+    }
+    return true;
+}
+
+}  // namespace api
@@ -0,0 +1,245 @@
+// SPDX-FileCopyrightText: 2026 Cryptotomte
+// SPDX-License-Identifier: AGPL-3.0-or-later
+/**
+ * @file DerivedMetrics.cpp
+ * @brief The input join behind the virtual /history metrics (see
+ *        DerivedMetrics.h).
+ */
+
+#include "api/DerivedMetrics.h"
+
+#include <cmath>
+
+namespace api {
+
+namespace {
+
+// Magnus-Tetens over water (Alduchov & Eskridge), good to ~0.1 % over
+// -40..50 degC.
+constexpr float kMagnusB = 17.625f;
+constexpr float kMagnusC = 243.04f;  // degC
+constexpr float kMagnusE0 = 0.61094f;  // kPa
+
+float saturationKpa(float tempC)
+{
+    return kMagnusE0 * std::exp(kMagnusB * tempC / (tempC + kMagnusC));
+}
+
+bool computeVpd(float tempC, float rhPct, float& out)
+{
+    out = vaporPressureDeficitKpa(tempC, rhPct);
+    return std::isfinite(out);
+}
+
+bool computeDewPoint(float tempC, float rhPct, float& out)
+{
+    return dewPointC(tempC, rhPct, out);
+}
+
+}  // namespace
+
+const DerivedMetric kDerivedMetrics[kDerivedMetricCount] = {
+    {"env_vpd", "env_temperature", "env_humidity", &computeVpd},
+    {"env_dew_point", "env_temperature", "env_humidity", &computeDewPoint},
+};
+
+const DerivedMetric* findDerivedMetric(std::string_view name)
+{
+    for (const DerivedMetric& derived : kDerivedMetrics) {
+        if (name == derived.name) {
+            return &derived;
+        }
+    }
+    return nullptr;
+}
+
+float vaporPressureDeficitKpa(float tempC, float rhPct)
+{
+    const float rh = rhPct < 0.0f ? 0.0f : (rhPct > 100.0f ? 100.0f : rhPct);
+    return saturationKpa(tempC) * (1.0f - rh / 100.0f);
+}
+
+bool dewPointC(float tempC, float rhPct, float& out)
+{
+    if (!(rhPct > 0.0f)) {
+        return false;
+    }
+    const float rh = rhPct > 100.0f ? 100.0f : rhPct;
+    const float gamma = std::log(rh / 100.0f) + kMagnusB * tempC / (tempC + kMagnusC);
+    out = kMagnusC * gamma / (kMagnusB - gamma);
+    return std::isfinite(out);
+}
+
+bool DerivedMetricStorage::ready(Stream& s, uint32_t t1) const
+{
+    if (s.head < s.count) {
+        return true;
+    }
+    if (!s.more) {
+        return false;
+    }
+    // The pager hands over at most a batch.
+    class Fill final : public IReadingVisitor {
+    public:
+        explicit Fill(Stream& stream) : stream_(stream) {}
+        bool onReading(uint32_t epoch, float value) override
+        {
+            stream_.batch[stream_.count++] = Reading{epoch, value};
+            return true;
+        }
+
+    private:
+        Stream& stream_;
+    } fill(s);
+    s.head = 0;
+    s.count = 0;
+    ReadingPager pager(s.cursor, kBatchReadings, fill);
+    storage_.forEachReading(s.metric, s.cursor.epoch, t1, pager);
+    s.cursor = pager.next();
+    s.more = pager.more();
+    return s.count != 0;
+}
+
+void DerivedMetricStorage::take(Stream& s, uint32_t epoch)
+{
+    while (s.head < s.count && s.batch[s.head].epoch == epoch) {
+        s.last = s.batch[s.head++];
+        s.have = true;
+    }
+}
+
+std::size_t DerivedMetricStorage::join(const DerivedMetric& derived, uint32_t t0,
+                                       uint32_t t1, IReadingVisitor& visitor) const
+{
+    if (t0 > t1) {
+        return 0;
+    }
+    // Two batches: on the heap, not the (httpd) caller's stack.
+    std::vector<Stream> streams(2);
+    Stream& a = streams[0];
+    Stream& b = streams[1];
+    const uint32_t from = t0 > holdS_ ? t0 - holdS_ : 0;
+    a.metric = derived.a;
+    b.metric = derived.b;
+    a.cursor = ReadingCursor{from, 0};
+    b.cursor = ReadingCursor{from, 0};
+
+    std::size_t visited = 0;
+    for (;;) {
+        const bool hasA = ready(a, t1);
+        const bool hasB = ready(b, t1);
+        if (!hasA && !hasB) {
+            break;
+        }
+        uint32_t epoch = hasA ? a.batch[a.head].epoch : b.batch[b.head].epoch;
+        if (hasB && b.batch[b.head].epoch < epoch) {
+            epoch = b.batch[b.head].epoch;
+        }
+        take(a, epoch);
+        take(b, epoch);
+        // A batch may end inside a run of one epoch: the rest is the
+        // next batch's head.
+        while (ready(a, t1) && a.batch[a.head].epoch == epoch) {
+            take(a, epoch);
+        }
+        while (ready(b, t1) && b.batch[b.head].epoch == epoch) {
+            take(b, epoch);
+        }
+        if (epoch < t0 || !a.have || !b.have || epoch - a.last.epoch > holdS_ ||
+            epoch - b.last.epoch > holdS_) {
+            continue;
+        }
+        float value = 0.0f;
+        if (!derived.compute(a.last.value, b.last.value, value)) {
+            continue;
+        }
+        ++visited;
+        if (!visitor.onReading(epoch, value)) {
+            break;
+        }
+    }
+    return visited;
+}
+
+std::size_t DerivedMetricStorage::forEachReading(const std::string& metric, uint32_t t0,
+                                                 uint32_t t1,
+                                                 IReadingVisitor& visitor) const
+{
+    if (const DerivedMetric* derived = findDerivedMetric(metric)) {
+        return join(*derived, t0, t1, visitor);
+    }
+    return storage_.forEachReading(metric, t0, t1, visitor);
+}
+
+std::vector<SensorReading> DerivedMetricStorage::getSensorReadings(const std::string& metric,
+                                                                   uint32_t t0,
+                                                                   uint32_t t1) const
+{
+    const DerivedMetric* derived = findDerivedMetric(metric);
+    if (derived == nullptr) {
+        return storage_.getSensorReadings(metric, t0, t1);
+    }
+    struct Collect final : IReadingVisitor {
+        std::vector<SensorReading> readings;
+        const std::string* metric = nullptr;
+        bool onReading(uint32_t epoch, float value) override
+        {
+            readings.push_back(SensorReading{*metric, epoch, value});
+            return true;
+        }
+    } collect;
+    collect.metric = &metric;
+    join(*derived, t0, t1, collect);
+    return std::move(collect.readings);
+}
+
+// The remaining reads fold the join through the IDataStorage defaults for
+// a derived name; the wrapped storage keeps its rollups, sketches and RAM
+// tail for the rest.
+
+std::vector<SensorAggregate> DerivedMetricStorage::getSensorAggregates(
+    const std::string& metric, uint32_t t0, uint32_t t1, uint32_t bucketS) const
+{
+    if (findDerivedMetric(metric) != nullptr) {
+        return IDataStorage::getSensorAggregates(metric, t0, t1, bucketS);
+    }
+    return storage_.getSensorAggregates(metric, t0, t1, bucketS);
+}
+
+SensorWindowStats DerivedMetricStorage::getSensorWindowStats(const std::string& metric,
+                                                             uint32_t t0,
+                                                             uint32_t t1) const
+{
+    if (findDerivedMetric(metric) != nullptr) {
+        return IDataStorage::getSensorWindowStats(metric, t0, t1);
+    }
+    return storage_.getSensorWindowStats(metric, t0, t1);
+}
+
+QuantileSketch DerivedMetricStorage::getSensorQuantiles(const std::string& metric,
+                                                        uint32_t t0, uint32_t t1) const
+{
+    if (findDerivedMetric(metric) != nullptr) {
+        return IDataStorage::getSensorQuantiles(metric, t0, t1);
+    }
+    return storage_.getSensorQuantiles(metric, t0, t1);
+}
+
+LatestReading DerivedMetricStorage::latestReading(const std::string& metric) const
+{
+    if (findDerivedMetric(metric) != nullptr) {
+        return IDataStorage::latestReading(metric);
+    }
+    return storage_.latestReading(metric);
+}
+
+std::vector<SensorReading> DerivedMetricStorage::getLatestReadings(const std::string& metric,
+                                                                   std::size_t n) const
+{
+    if (findDerivedMetric(metric) != nullptr) {
+        return IDataStorage::getLatestReadings(metric, n);
+    }
+    return storage_.getLatestReadings(metric, n);
+}
+
+}  // namespace api
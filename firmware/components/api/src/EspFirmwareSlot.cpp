@@ -0,0 +1,95 @@
+// SPDX-FileCopyrightText: 2026 Cryptotomte
+// SPDX-License-Identifier: AGPL-3.0-or-later
+/**
+ * @file EspFirmwareSlot.cpp
+ * @brief IFirmwareSlot over esp_ota_ops — target-only (excluded on linux).
+ */
+
+#include "api/EspFirmwareSlot.h"
+
+#include "esp_log.h"
+#include "esp_ota_ops.h"
+
+namespace api {
+
+namespace {
+
+const char* TAG = "ota_slot";
+
+const esp_partition_t* partition(const void* p)
+{
+    return static_cast<const esp_partition_t*>(p);
+}
+
+}  // namespace
+
+EspFirmwareSlot::EspFirmwareSlot()
+    : partition_(esp_ota_get_next_update_partition(nullptr))
+{
+}
+
+std::size_t EspFirmwareSlot::capacity() const
+{
+    return partition_ != nullptr ? partition(partition_)->size : 0;
+}
+
+bool EspFirmwareSlot::begin(std::size_t imageBytes)
+{
+    if (partition_ == nullptr || open_) {
+        return false;
+    }
+    (void)imageBytes;  // sequential writes erase as they go, not by size
+    esp_ota_handle_t handle = 0;
+    const esp_err_t err =
+        esp_ota_begin(partition(partition_), OTA_WITH_SEQUENTIAL_WRITES, &handle);
+    if (err != ESP_OK) {
+        ESP_LOGE(TAG, "esp_ota_begin(%s): %s", partition(partition_)->label,
+                 esp_err_to_name(err));
+        return false;
+    }
+    handle_ = handle;
+    open_ = true;
+    return true;
+}
+
+bool EspFirmwareSlot::write(const uint8_t* data, std::size_t len)
+{
+    if (!open_) {
+        return false;
+    }
+    const esp_err_t err = esp_ota_write(handle_, data, len);
+    if (err != ESP_OK) {
+        ESP_LOGE(TAG, "esp_ota_write: %s", esp_err_to_name(err));
+        return false;
+    }
+    return true;
+}
+
+bool EspFirmwareSlot::commit()
+{
+    if (!open_) {
+        return false;
+    }
+    // esp_ota_end() releases the handle whether or not the image verifies.
+    open_ = false;
+    esp_err_t err = esp_ota_end(handle_);
+    if (err == ESP_OK) {
+        err = esp_ota_set_boot_partition(partition(partition_));
+    }
+    if (err != ESP_OK) {
+        ESP_LOGE(TAG, "image not accepted: %s", esp_err_to_name(err));
+        return false;
+    }
+    ESP_LOGI(TAG, "next boot from %s", partition(partition_)->label);
+    return true;
+}
+
+void EspFirmwareSlot::abort()
+{
+    if (open_) {
+        open_ = false;
+        (void)esp_ota_abort(handle_);
+    }
+}
+
+}  // namespace api
@@ -0,0 +1,86 @@
+// SPDX-FileCopyrightText: 2026 Cryptotomte
+// SPDX-License-Identifier: AGPL-3.0-or-later
+/**
+ * @file EspRunningImage.cpp
+ * @brief IRunningImage over the running partition — target-only (excluded
+ *        on linux).
+ */
+
+#include "api/EspRunningImage.h"
+
+#include <cstring>
+
+#include "esp_image_format.h"
+#include "esp_log.h"
+#include "esp_ota_ops.h"
+#include "esp_partition.h"
+
+namespace api {
+
+namespace {
+
+const char* TAG = "ota_base";
+
+/// Hashing read size; on the calling (httpd) task's stack.
+constexpr std::size_t kHashReadBytes = 512;
+
+const esp_partition_t* partition(const void* p)
+{
+    return static_cast<const esp_partition_t*>(p);
+}
+
+}  // namespace
+
+EspRunningImage::EspRunningImage() : partition_(esp_ota_get_running_partition()) {}
+
+std::size_t EspRunningImage::size()
+{
+    if (!measured_ && partition_ != nullptr) {
+        measured_ = true;
+        const esp_partition_pos_t pos = {partition(partition_)->address,
+                                         partition(partition_)->size};
+        esp_image_metadata_t meta = {};
+        const esp_err_t err = esp_image_get_metadata(&pos, &meta);
+        if (err == ESP_OK) {
+            size_ = meta.image_len;
+        } else {
+            ESP_LOGE(TAG, "running image unreadable: %s", esp_err_to_name(err));
+        }
+    }
+    return size_;
+}
+
+bool EspRunningImage::sha256(uint8_t out[32])
+{
+    if (!hashed_) {
+        const std::size_t len = size();
+        if (len == 0) {
+            return false;
+        }
+        Sha256 hash;
+        uint8_t buf[kHashReadBytes];
+        for (std::size_t at = 0; at < len; at += sizeof buf) {
+            const std::size_t n = len - at < sizeof buf ? len - at : sizeof buf;
+            if (!read(at, buf, n)) {
+                return false;
+            }
+            hash.update(buf, n);
+        }
+        digest_ = hash.finish();
+        hashed_ = true;
+        ESP_LOGI(TAG, "running image %u bytes, sha256 %.16s", static_cast<unsigned>(len),
+                 Sha256::toHex(digest_).c_str());
+    }
+    std::memcpy(out, digest_.data(), digest_.size());
+    return true;
+}
+
+bool EspRunningImage::read(std::size_t offset, uint8_t* dst, std::size_t len)
+{
+    if (partition_ == nullptr || offset > size_ || len > size_ - offset) {
+        return false;
+    }
+    return esp_partition_read(partition(partition_), offset, dst, len) == ESP_OK;
+}
+
+}  // namespace api
@@ -0,0 +1,62 @@
+// SPDX-FileCopyrightText: 2026 Cryptotomte
+// SPDX-License-Identifier: AGPL-3.0-or-later
+/**
+ * @file EventTail.cpp
+ * @brief Tail-cursor reads of the event log (see EventTail.h).
+ */
+
+#include "api/EventTail.h"
+
+#include <algorithm>
+#include <utility>
+
+namespace api {
+
+EventQuery eventTailQuery(const EventCursor& after, uint32_t categoryMask,
+                          std::size_t count)
+{
+    EventQuery query;
+    query.categoryMask = categoryMask;
+    query.since = after.epoch;
+    query.limit = count + std::min(after.skip, kEventTailMaxSkip);
+    return query;
+}
+
+EventTail resolveEventTail(EventPage page, const EventCursor& after, std::size_t count)
+{
+    EventTail out;
+    out.tail = after;
+    std::vector<EventRecord>& events = page.events;
+    if (events.empty()) {
+        return out;
+    }
+    // Counted before anything is dropped: the seen events at the newest
+    // epoch are part of the next cursor's skip.
+    const uint32_t newest = events.front().epoch;
+    uint32_t atNewest = 0;
+    while (atNewest < events.size() && events[atNewest].epoch == newest) {
+        ++atNewest;
+    }
+    if (page.more) {
+        // More matched than count plus the seen ones: the newest count are
+        // all new, and some older new ones did not fit.
+        out.truncated = true;
+        events.resize(std::min(count, events.size()));
+    } else {
+        // Everything from the cursor's epoch on is here; the seen events are
+        // the oldest ones at that epoch, at the end.
+        std::size_t seen = 0;
+        while (seen < after.skip && seen < events.size() &&
+               events[events.size() - 1 - seen].epoch == after.epoch) {
+            ++seen;
+        }
+        events.resize(events.size() - seen);
+    }
+    if (!events.empty()) {
+        out.tail = EventCursor{newest, atNewest};
+        out.events = std::move(events);
+    }
+    return out;
+}
+
+}  // namespace api
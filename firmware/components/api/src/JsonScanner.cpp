@@ -0,0 +1,406 @@
+// SPDX-FileCopyrightText: 2026 Cryptotomte
+// SPDX-License-Identifier: AGPL-3.0-or-later
+/**
+ * @file JsonScanner.cpp
+ * @brief Implementation of the fixed-token request-body JSON scanner.
+ */
+
+#include "api/JsonScanner.h"
+
+#include <cstdlib>
+#include <cstring>
+
+namespace api {
+
+namespace {
+
+int hexDigit(char c)
+{
+    if (c >= '0' && c <= '9') {
+        return c - '0';
+    }
+    if (c >= 'a' && c <= 'f') {
+        return c - 'a' + 10;
+    }
+    if (c >= 'A' && c <= 'F') {
+        return c - 'A' + 10;
+    }
+    return -1;
+}
+
+/// Four hex digits at @p raw[pos]; false when they are not.
+bool hex4(std::string_view raw, std::size_t pos, uint32_t& out)
+{
+    if (pos + 4 > raw.size()) {
+        return false;
+    }
+    out = 0;
+    for (std::size_t i = 0; i < 4; ++i) {
+        const int d = hexDigit(raw[pos + i]);
+        if (d < 0) {
+            return false;
+        }
+        out = (out << 4) | static_cast<uint32_t>(d);
+    }
+    return true;
+}
+
+/**
+ * Decode the character at @p raw[pos] (an escaped string body, already
+ * validated by the scanner) into its UTF-8 bytes; advances @p pos and
+ * returns the byte count.
+ */
+std::size_t decodeNext(std::string_view raw, std::size_t& pos, char (&out)[4])
+{
+    if (raw[pos] != '\\') {
+        out[0] = raw[pos++];
+        return 1;
+    }
+    const char e = raw[pos + 1];
+    pos += 2;
+    switch (e) {
+        case 'b': out[0] = '\b'; return 1;
+        case 'f': out[0] = '\f'; return 1;
+        case 'n': out[0] = '\n'; return 1;
+        case 'r': out[0] = '\r'; return 1;
+        case 't': out[0] = '\t'; return 1;
+        case 'u': break;
+        default: out[0] = e; return 1;  // '"', '\\', '/'
+    }
+    uint32_t cp = 0;
+    hex4(raw, pos, cp);
+    pos += 4;
+    uint32_t low = 0;
+    if (cp >= 0xD800 && cp <= 0xDBFF && pos + 6 <= raw.size() && raw[pos] == '\\' &&
+        raw[pos + 1] == 'u' && hex4(raw, pos + 2, low) && low >= 0xDC00 &&
+        low <= 0xDFFF) {
+        cp = 0x10000 + (((cp & 0x3FF) << 10) | (low & 0x3FF));
+        pos += 6;
+    }
+    if (cp < 0x80) {
+        out[0] = static_cast<char>(cp);
+        return 1;
+    }
+    if (cp < 0x800) {
+        out[0] = static_cast<char>(0xC0 | (cp >> 6));
+        out[1] = static_cast<char>(0x80 | (cp & 0x3F));
+        return 2;
+    }
+    if (cp < 0x10000) {
+        out[0] = static_cast<char>(0xE0 | (cp >> 12));
+        out[1] = static_cast<char>(0x80 | ((cp >> 6) & 0x3F));
+        out[2] = static_cast<char>(0x80 | (cp & 0x3F));
+        return 3;
+    }
+    out[0] = static_cast<char>(0xF0 | (cp >> 18));
+    out[1] = static_cast<char>(0x80 | ((cp >> 12) & 0x3F));
+    out[2] = static_cast<char>(0x80 | ((cp >> 6) & 0x3F));
+    out[3] = static_cast<char>(0x80 | (cp & 0x3F));
+    return 4;
+}
+
+bool isDigit(char c)
+{
+    return c >= '0' && c <= '9';
+}
+
+}  // namespace
+
+bool JsonScanner::parse(std::string_view text)
+{
+    text_ = text;
+    count_ = 0;
+    full_ = false;
+    if (text.size() > UINT16_MAX) {
+        full_ = true;
+        return false;
+    }
+    std::size_t pos = 0;
+    skipSpace(pos);
+    if (!value(pos, 0)) {
+        return false;
+    }
+    skipSpace(pos);
+    return pos == text_.size();  // nothing may trail the value
+}
+
+std::size_t JsonScanner::member(std::size_t object, std::string_view key) const
+{
+    for (std::size_t k = firstMember(object); k != kNone; k = nextMember(object, k)) {
+        if (equals(k, key)) {
+            return k + 1;
+        }
+    }
+    return kNone;
+}
+
+std::size_t JsonScanner::firstMember(std::size_t object) const
+{
+    if (object >= count_ || tokens_[object].type != Type::Object ||
+        tokens_[object].next == object + 1) {
+        return kNone;
+    }
+    return object + 1;
+}
+
+std::size_t JsonScanner::nextMember(std::size_t object, std::size_t key) const
+{
+    const std::size_t after = tokens_[key + 1].next;
+    return after < tokens_[object].next ? after : kNone;
+}
+
+bool JsonScanner::number(std::size_t token, double& out) const
+{
+    if (token >= count_ || tokens_[token].type != Type::Number) {
+        return false;
+    }
+    const std::string_view digits = raw(token);
+    if (digits.size() >= kMaxNumberLen) {
+        return false;
+    }
+    // strtod wants a terminated string; the literal is copied to the stack.
+    char buf[kMaxNumberLen];
+    std::memcpy(buf, digits.data(), digits.size());
+    buf[digits.size()] = '\0';
+    out = std::strtod(buf, nullptr);
+    return true;
+}
+
+bool JsonScanner::equals(std::size_t token, std::string_view text) const
+{
+    if (token >= count_ || tokens_[token].type != Type::String) {
+        return false;
+    }
+    const std::string_view body = raw(token);
+    std::size_t pos = 0;
+    std::size_t matched = 0;
+    while (pos < body.size()) {
+        char bytes[4];
+        const std::size_t n = decodeNext(body, pos, bytes);
+        if (matched + n > text.size() || std::memcmp(bytes, text.data() + matched, n) != 0) {
+            return false;
+        }
+        matched += n;
+    }
+    return matched == text.size();
+}
+
+bool JsonScanner::copyString(std::size_t token, char* out, std::size_t cap,
+                             std::size_t& len) const
+{
+    if (token >= count_ || tokens_[token].type != Type::String) {
+        return false;
+    }
+    const std::string_view body = raw(token);
+    std::size_t pos = 0;
+    std::size_t used = 0;
+    while (pos < body.size()) {
+        char bytes[4];
+        const std::size_t n = decodeNext(body, pos, bytes);
+        if (used + n >= cap) {
+            return false;  // no room for it and the terminator
+        }
+        std::memcpy(out + used, bytes, n);
+        used += n;
+    }
+    if (cap == 0) {
+        return false;
+    }
+    out[used] = '\0';
+    len = used;
+    return true;
+}
+
+bool JsonScanner::value(std::size_t& pos, std::size_t depth)
+{
+    if (pos >= text_.size()) {
+        return false;
+    }
+    switch (text_[pos]) {
+        case '{': return container(pos, depth, Type::Object);
+        case '[': return container(pos, depth, Type::Array);
+        case '"': return stringToken(pos);
+        case 't': return literal(pos, "true", Type::True);
+        case 'f': return literal(pos, "false", Type::False);
+        case 'n': return literal(pos, "null", Type::Null);
+        default: return numberToken(pos);
+    }
+}
+
+bool JsonScanner::container(std::size_t& pos, std::size_t depth, Type type)
+{
+    if (depth == kMaxDepth) {
+        full_ = true;
+        return false;
+    }
+    const std::size_t self = push(type, pos);
+    if (self == kNone) {
+        return false;
+    }
+    const char close = type == Type::Object ? '}' : ']';
+    ++pos;
+    skipSpace(pos);
+    if (pos < text_.size() && text_[pos] == close) {
+        finish(self, ++pos);
+        return true;
+    }
+    for (;;) {
+        if (type == Type::Object) {
+            if (pos >= text_.size() || text_[pos] != '"' || !stringToken(pos)) {
+                return false;
+            }
+            skipSpace(pos);
+            if (pos >= text_.size() || text_[pos] != ':') {
+                return false;
+            }
+            ++pos;
+            skipSpace(pos);
+        }
+        if (!value(pos, depth + 1)) {
+            return false;
+        }
+        skipSpace(pos);
+        if (pos >= text_.size()) {
+            return false;
+        }
+        if (text_[pos] == close) {
+            finish(self, ++pos);
+            return true;
+        }
+        if (text_[pos] != ',') {
+            return false;
+        }
+        ++pos;
+        skipSpace(pos);
+    }
+}
+
+bool JsonScanner::stringToken(std::size_t& pos)
+{
+    const std::size_t self = push(Type::String, pos + 1);
+    if (self == kNone) {
+        return false;
+    }
+    ++pos;
+    while (pos < text_.size()) {
+        const char c = text_[pos];
+        if (c == '"') {
+            finish(self, pos++);
+            return true;
+        }
+        if (static_cast<unsigned char>(c) < 0x20) {
+            return false;  // raw control characters must be escaped
+        }
+        if (c != '\\') {
+            ++pos;
+            continue;
+        }
+        if (pos + 1 >= text_.size()) {
+            return false;
+        }
+        const char e = text_[pos + 1];
+        if (e == 'u') {
+            uint32_t cp = 0;
+            if (!hex4(text_, pos + 2, cp)) {
+                return false;
+            }
+            pos += 6;
+        } else if (std::strchr("\"\\/bfnrt", e) != nullptr && e != '\0') {
+            pos += 2;
+        } else {
+            return false;
+        }
+    }
+    return false;  // unterminated
+}
+
+bool JsonScanner::numberToken(std::size_t& pos)
+{
+    const std::size_t begin = pos;
+    const std::size_t size = text_.size();
+    if (pos < size && text_[pos] == '-') {
+        ++pos;
+    }
+    if (pos < size && text_[pos] == '0') {
+        ++pos;
+    } else if (pos < size && isDigit(text_[pos])) {
+        while (pos < size && isDigit(text_[pos])) {
+            ++pos;
+        }
+    } else {
+        return false;
+    }
+    if (pos < size && text_[pos] == '.') {
+        ++pos;
+        if (pos >= size || !isDigit(text_[pos])) {
+            return false;
+        }
+        while (pos < size && isDigit(text_[pos])) {
+            ++pos;
+        }
+    }
+    if (pos < size && (text_[pos] == 'e' || text_[pos] == 'E')) {
+        ++pos;
+        if (pos < size && (text_[pos] == '+' || text_[pos] == '-')) {
+            ++pos;
+        }
+        if (pos >= size || !isDigit(text_[pos])) {
+            return false;
+        }
+        while (pos < size && isDigit(text_[pos])) {
+            ++pos;
+        }
+    }
+    const std::size_t self = push(Type::Number, begin);
+    if (self == kNone) {
+        return false;
+    }
+    finish(self, pos);
+    return true;
+}
+
+bool JsonScanner::literal(std::size_t& pos, std::string_view word, Type type)
+{
+    if (text_.substr(pos, word.size()) != word) {
+        return false;
+    }
+    const std::size_t self = push(type, pos);
+    if (self == kNone) {
+        return false;
+    }
+    pos += word.size();
+    finish(self, pos);
+    return true;
+}
+
+void JsonScanner::skipSpace(std::size_t& pos) const
+{
+    while (pos < text_.size() && (text_[pos] == ' ' || text_[pos] == '\t' ||
+                                  text_[pos] == '\n' || text_[pos] == '\r')) {
+        ++pos;
+    }
+}
+
+std::size_t JsonScanner::push(Type type, std::size_t begin)
+{
+    if (count_ == kMaxTokens) {
+        full_ = true;
+        return kNone;
+    }
+    tokens_[count_] = Token{static_cast<uint16_t>(begin), static_cast<uint16_t>(begin), 0,
+                            type};
+    return count_++;
+}
+
+void JsonScanner::finish(std::size_t token, std::size_t end)
+{
+    tokens_[token].end = static_cast<uint16_t>(end);
+    tokens_[token].next = static_cast<uint16_t>(count_);
+}
+
+std::string_view JsonScanner::raw(std::size_t token) const
+{
+    return text_.substr(tokens_[token].begin, tokens_[token].end - tokens_[token].begin);
+}
+
+}  // namespace api
@@ -0,0 +1,110 @@
+// SPDX-FileCopyrightText: 2026 Cryptotomte
+// SPDX-License-Identifier: AGPL-3.0-or-later
+/**
+ * @file JsonTemplate.cpp
+ * @brief cJSON-identical number formatting for the fixed JSON writers.
+ *
+ * formatJsonFixed() needs no printf: the rounded value is an integer count
+ * of 10^-decimals units, written out digit by digit with the point placed
+ * in. That is the hot path of a streamed /history body (one call per
+ * value), where %1.15g plus the sscanf read-back dominated.
+ */
+
+#include "api/JsonTemplate.h"
+
+#include <climits>
+#include <cmath>
+#include <cstdint>
+#include <cstdio>
+
+namespace api {
+
+namespace {
+
+constexpr double kPow10[kMaxJsonDecimals + 1] = {1.0, 10.0, 100.0, 1000.0, 10000.0};
+
+/// Past this a scaled value may carry more than the 15 significant digits
+/// cJSON's %1.15g keeps.
+constexpr double kMaxScaled = 1e15;
+
+/// @p value * 10^@p decimals, or false when roundJsonDecimals() leaves
+/// @p value alone.
+bool scaleForDecimals(double value, int decimals, double& scaled)
+{
+    if (decimals < 0 || decimals > kMaxJsonDecimals || !std::isfinite(value)) {
+        return false;
+    }
+    scaled = value * kPow10[decimals];
+    return std::fabs(scaled) < kMaxScaled;
+}
+
+}  // namespace
+
+std::size_t formatJsonNumber(double value, char* out)
+{
+    // cJSON: integral values that fit an int print as %d, anything else as
+    // the shortest of %1.15g / %1.17g that reads back exactly.
+    int len = 0;
+    if (!std::isfinite(value)) {
+        len = std::snprintf(out, kJsonNumberChars, "null");
+    } else if (value > INT_MIN && value < INT_MAX &&
+               value == static_cast<double>(static_cast<int>(value))) {
+        len = std::snprintf(out, kJsonNumberChars, "%d", static_cast<int>(value));
+    } else {
+        len = std::snprintf(out, kJsonNumberChars, "%1.15g", value);
+        double back = 0.0;
+        if (std::sscanf(out, "%lg", &back) != 1 || back != value) {
+            len = std::snprintf(out, kJsonNumberChars, "%1.17g", value);
+        }
+    }
+    return len > 0 ? static_cast<std::size_t>(len) : 0;
+}
+
+double roundJsonDecimals(double value, int decimals)
+{
+    double scaled = 0.0;
+    if (!scaleForDecimals(value, decimals, scaled)) {
+        return value;
+    }
+    return std::round(scaled) / kPow10[decimals];
+}
+
+std::size_t formatJsonFixed(double value, int decimals, char* out)
+{
+    double scaled = 0.0;
+    if (!scaleForDecimals(value, decimals, scaled)) {
+        return formatJsonNumber(value, out);
+    }
+    // std::round's half-away-from-zero, as roundJsonDecimals() rounds.
+    const int64_t units = static_cast<int64_t>(std::round(scaled));
+    uint64_t magnitude = units < 0 ? static_cast<uint64_t>(-units)
+                                   : static_cast<uint64_t>(units);
+    int fraction = decimals;
+    while (fraction > 0 && magnitude % 10 == 0) {
+        magnitude /= 10;
+        --fraction;
+    }
+
+    // Digits least significant first; at least one ahead of the point.
+    char digits[24];
+    int count = 0;
+    do {
+        digits[count++] = static_cast<char>('0' + magnitude % 10);
+        magnitude /= 10;
+    } while (magnitude != 0 || count <= fraction);
+
+    std::size_t len = 0;
+    if (units < 0) {
+        out[len++] = '-';
+    }
+    while (count > 0) {
+        if (count == fraction) {
+            out[len++] = '.';
+        }
+        out[len++] = digits[--count];
+    }
+    out[len] = '\0';
+    return len;
+}
+
+}  // namespace api
@@ -0,0 +1,239 @@
+// SPDX-FileCopyrightText: 2026 Cryptotomte
+// SPDX-License-Identifier: AGPL-3.0-or-later
+/**
+ * @file LiveStream.cpp
+ * @brief Implementation of the live telemetry hub and delta publisher.
+ */
+
+#include "api/LiveStream.h"
+
+#include <algorithm>
+#include <utility>
+
+#include "api/ApiETag.h"
+#include "api/ApiSerialize.h"
+#include "interfaces/EventCodec.h"
+
+namespace api {
+
+LiveStream::Client* LiveStream::find(int id)
+{
+    for (Client& c : clients_) {
+        if (c.id == id) {
+            return &c;
+        }
+    }
+    return nullptr;
+}
+
+const LiveStream::Client* LiveStream::find(int id) const
+{
+    for (const Client& c : clients_) {
+        if (c.id == id) {
+            return &c;
+        }
+    }
+    return nullptr;
+}
+
+bool LiveStream::addClient(int id)
+{
+    std::lock_guard<StaticMutex> lock(mutex_);
+    if (id < 0 || find(id) != nullptr) {
+        return false;
+    }
+    Client* slot = find(-1);
+    if (slot == nullptr) {
+        return false;
+    }
+    slot->id = id;
+    slot->head = 0;
+    slot->size = 0;
+    slot->needsFull = true;  // the newcomer needs the whole picture
+    return true;
+}
+
+void LiveStream::removeClient(int id)
+{
+    std::lock_guard<StaticMutex> lock(mutex_);
+    Client* c = (id < 0) ? nullptr : find(id);
+    if (c == nullptr) {
+        return;
+    }
+    c->id = -1;
+    for (std::string& message : c->queue) {
+        std::string().swap(message);  // give the heap back now
+    }
+    c->head = 0;
+    c->size = 0;
+}
+
+std::size_t LiveStream::clientCount() const
+{
+    std::lock_guard<StaticMutex> lock(mutex_);
+    std::size_t count = 0;
+    for (const Client& c : clients_) {
+        count += (c.id >= 0) ? 1 : 0;
+    }
+    return count;
+}
+
+std::vector<int> LiveStream::clients() const
+{
+    std::lock_guard<StaticMutex> lock(mutex_);
+    std::vector<int> ids;
+    for (const Client& c : clients_) {
+        if (c.id >= 0) {
+            ids.push_back(c.id);
+        }
+    }
+    return ids;
+}
+
+bool LiveStream::pop(int id, std::string& out)
+{
+    std::lock_guard<StaticMutex> lock(mutex_);
+    Client* c = (id < 0) ? nullptr : find(id);
+    if (c == nullptr || c->size == 0) {
+        return false;
+    }
+    out = std::move(c->queue[c->head]);
+    c->queue[c->head].clear();
+    c->head = (c->head + 1) % kQueueDepth;
+    --c->size;
+    return true;
+}
+
+bool LiveStream::pending() const
+{
+    std::lock_guard<StaticMutex> lock(mutex_);
+    for (const Client& c : clients_) {
+        if (c.id >= 0 && c.size > 0) {
+            return true;
+        }
+    }
+    return false;
+}
+
+uint32_t LiveStream::droppedMessages() const
+{
+    std::lock_guard<StaticMutex> lock(mutex_);
+    return dropped_;
+}
+
+void LiveStream::deliver(const std::string& message,
+                         const std::vector<int>* ids, bool snapshot)
+{
+    if (message.empty()) {
+        return;  // the serializer ran out of memory
+    }
+    std::lock_guard<StaticMutex> lock(mutex_);
+    for (Client& c : clients_) {
+        if (c.id < 0) {
+            continue;
+        }
+        if (ids != nullptr &&
+            std::find(ids->begin(), ids->end(), c.id) == ids->end()) {
+            continue;
+        }
+        if (c.size == kQueueDepth) {
+            // Drop-oldest: the producer never waits on a slow client. A lost
+            // delta is repaired by a full snapshot on the next publish.
+            c.head = (c.head + 1) % kQueueDepth;
+            --c.size;
+            ++dropped_;
+            c.needsFull = c.needsFull || !snapshot;
+        }
+        c.queue[(c.head + c.size) % kQueueDepth] = message;
+        ++c.size;
+    }
+}
+
+bool LiveStream::publish(const SensorReadingsDto& sensors,
+                         const std::vector<PumpDto>& pumps)
+{
+    // Split the clients: `fresh` ones get the snapshot, `current` ones the
+    // deltas. Flags are cleared here; an overflow while delivering sets
+    // them again for the next call.
+    std::vector<int> fresh;
+    std::vector<int> current;
+    {
+        std::lock_guard<StaticMutex> lock(mutex_);
+        for (Client& c : clients_) {
+            if (c.id < 0) {
+                continue;
+            }
+            (c.needsFull || !haveBaseline_ ? fresh : current).push_back(c.id);
+            c.needsFull = false;
+        }
+    }
+    if (fresh.empty() && current.empty()) {
+        haveBaseline_ = false;
+        return false;
+    }
+
+    const uint32_t envFp = fingerprint(sensors.environmental);
+    const uint32_t soilFp = fingerprint(sensors.soil);
+    const uint32_t levelFp = fingerprint(sensors.level);
+    const uint32_t powerFp = fingerprint(sensors.power);
+    pumpFps_.resize(pumps.size(), 0);
+
+    bool queued = false;
+    if (!current.empty()) {
+        SensorSections changed;
+        changed.environmental = envFp != envFp_;
+        changed.soil = soilFp != soilFp_;
+        changed.level = levelFp != levelFp_;
+        changed.power = sensors.hasPower && powerFp != powerFp_;
+        if (changed.environmental || changed.soil || changed.level ||
+            changed.power) {
+            deliver(serializeStreamSensors(sensors, changed, false), &current,
+                    false);
+            queued = true;
+        }
+        for (std::size_t i = 0; i < pumps.size(); ++i) {
+            if (pumpStateFingerprint(pumps[i]) != pumpFps_[i]) {
+                deliver(serializeStreamPump(pumps[i]), &current, false);
+                queued = true;
+            }
+        }
+    }
+    if (!fresh.empty()) {
+        SensorSections all;
+        all.environmental = all.soil = all.level = all.power = true;
+        deliver(serializeStreamSensors(sensors, all, true), &fresh, true);
+        for (const PumpDto& pump : pumps) {
+            deliver(serializeStreamPump(pump), &fresh, true);
+        }
+        queued = true;
+    }
+
+    envFp_ = envFp;
+    soilFp_ = soilFp;
+    levelFp_ = levelFp;
+    powerFp_ = powerFp;
+    for (std::size_t i = 0; i < pumps.size(); ++i) {
+        pumpFps_[i] = pumpStateFingerprint(pumps[i]);
+    }
+    haveBaseline_ = true;
+    return queued;
+}
+
+void LiveStream::onEvent(uint32_t epoch, uint8_t category,
+                         std::string_view detail)
+{
+    if (clientCount() == 0) {
+        return;  // nobody listening: skip the cJSON build entirely
+    }
+    EventDto event;
+    event.epoch = static_cast<int64_t>(epoch);
+    event.category = static_cast<int>(category);
+    const char* name = eventCategoryName(event.category);
+    if (name != nullptr) {
+        event.categoryName = name;
+    }
+    event.detail = renderEventDetail(detail);
+    deliver(serializeStreamEvent(event), nullptr, false);
+}
+
+}  // namespace api
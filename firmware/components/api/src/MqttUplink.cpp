@@ -0,0 +1,338 @@
+// SPDX-FileCopyrightText: 2026 Cryptotomte
+// SPDX-License-Identifier: AGPL-3.0-or-later
+/**
+ * @file MqttUplink.cpp
+ * @brief Implementation of the batched MQTT publisher and its replay.
+ */
+
+#include "api/MqttUplink.h"
+
+#include <algorithm>
+#include <mutex>
+#include <utility>
+
+#include "api/ApiETag.h"
+#include "api/ApiSerialize.h"
+#include "api/ApiStream.h"
+#include "interfaces/EventCodec.h"
+
+namespace api {
+
+namespace {
+
+constexpr const char* kTelemetryTopic = "/telemetry";
+constexpr const char* kReplayTopic = "/replay";
+
+struct StringSink final : IChunkSink {
+    std::string body;
+
+    bool send(const char* data, std::size_t len) override
+    {
+        body.append(data, len);
+        return true;
+    }
+};
+
+/// Writes one replay page's readings as `[epoch, value]` pairs, the
+/// values with @p decimals fraction digits (metricDecimals()).
+class ReadingsWriter final : public IReadingVisitor {
+public:
+    ReadingsWriter(JsonStreamWriter& out, int decimals) : out_(out), decimals_(decimals) {}
+
+    bool onReading(uint32_t epoch, float value) override
+    {
+        out_.raw(first_ ? "[" : ",[");
+        first_ = false;
+        out_.integer(epoch);
+        out_.raw(",");
+        out_.fixed(value, decimals_);
+        out_.raw("]");
+        return true;
+    }
+
+private:
+    JsonStreamWriter& out_;
+    const int decimals_;
+    bool first_ = true;
+};
+
+std::string eventMessage(uint32_t epoch, uint8_t category, std::string_view detail)
+{
+    EventDto event;
+    event.epoch = static_cast<int64_t>(epoch);
+    event.category = static_cast<int>(category);
+    const char* name = eventCategoryName(event.category);
+    if (name != nullptr) {
+        event.categoryName = name;
+    }
+    event.detail = renderEventDetail(detail);
+    return serializeStreamEvent(event);
+}
+
+/// `{ type:"batch", epoch, messages:[...] }` around already-serialized
+/// messages.
+std::string batch(uint32_t epoch, const std::vector<std::string>& messages)
+{
+    std::string out = "{\"type\":\"batch\",\"epoch\":";
+    out += std::to_string(epoch);
+    out += ",\"messages\":[";
+    for (std::size_t i = 0; i < messages.size(); ++i) {
+        if (i != 0) {
+            out += ',';
+        }
+        out += messages[i];
+    }
+    out += "]}";
+    return out;
+}
+
+}  // namespace
+
+void MqttUplink::onEvent(uint32_t epoch, uint8_t category,
+                         std::string_view detail)
+{
+    queue(eventMessage(epoch, category, detail));
+}
+
+void MqttUplink::queue(std::string message)
+{
+    if (message.empty()) {
+        return;  // the serializer ran out of memory
+    }
+    std::lock_guard<StaticMutex> lock(mutex_);
+    if (pending_.size() == kMaxPending) {
+        pending_.pop_front();  // drop-oldest, like the live stream queues
+        ++dropped_;
+    }
+    pending_.push_back(std::move(message));
+}
+
+MqttUplinkStats MqttUplink::stats() const
+{
+    std::lock_guard<StaticMutex> lock(mutex_);
+    MqttUplinkStats out = published_;
+    out.droppedMessages = dropped_;
+    return out;
+}
+
+bool MqttUplink::publish(const char* topic, const std::string& payload,
+                         bool replay, uint32_t epoch)
+{
+    const int msgId = client_.publish(config_.topicBase + topic, payload);
+    if (msgId < 0) {
+        ++counters_.rejected;
+        return false;
+    }
+    inflight_.push_back(Inflight{msgId, replay, epoch});
+    return true;
+}
+
+void MqttUplink::handle(const MqttEvent& event)
+{
+    switch (event.type) {
+        case MqttEventType::Connected:
+            connected_ = true;
+            ++counters_.connects;
+            haveBatch_ = false;
+            replayChecked_ = false;
+            stage_ = ReplayStage::Idle;
+            inflight_.clear();
+            pumpFps_.clear();  // the first batch restates every pump
+            break;
+        case MqttEventType::Disconnected:
+            // Whatever was unacknowledged is presumed lost; the watermark has
+            // not moved past it, so the next session replays it.
+            connected_ = false;
+            stage_ = ReplayStage::Idle;
+            inflight_.clear();
+            break;
+        case MqttEventType::Published: {
+            const auto it = std::find_if(
+                inflight_.begin(), inflight_.end(),
+                [&](const Inflight& f) { return f.msgId == event.msgId; });
+            if (it == inflight_.end()) {
+                break;  // from a session already given up on
+            }
+            ++counters_.acked;
+            if (!it->replay && it->epoch != 0) {
+                // During a replay the gap before this batch is not yet
+                // delivered: the mark waits for the replay to finish.
+                uint32_t& mark = (stage_ == ReplayStage::Idle) ? watermark_ : liveMark_;
+                mark = std::max(mark, it->epoch);
+            }
+            inflight_.erase(it);
+            break;
+        }
+        case MqttEventType::None:
+            break;
+    }
+    finishReplayIfDrained();
+}
+
+void MqttUplink::finishReplayIfDrained()
+{
+    if (stage_ == ReplayStage::Draining &&
+        std::none_of(inflight_.begin(), inflight_.end(),
+                     [](const Inflight& f) { return f.replay; })) {
+        watermark_ = std::max({watermark_, replayUntil_, liveMark_});
+        stage_ = ReplayStage::Idle;
+    }
+}
+
+void MqttUplink::beginReplay(uint32_t now)
+{
+    if (watermark_ == 0 || now <= watermark_) {
+        return;  // first session ever (nothing promised), or nothing missed
+    }
+    replayFrom_ = watermark_ + 1;
+    replayUntil_ = now;
+    replayMetric_ = 0;
+    readingCursor_ = ReadingCursor{replayFrom_, 0};
+    eventCursor_ = EventCursor{};
+    liveMark_ = 0;
+    stage_ = ReplayStage::Readings;
+}
+
+bool MqttUplink::replayStep()
+{
+    const uint32_t now = clock_.nowEpoch();
+    while (stage_ == ReplayStage::Readings) {
+        if (replayMetric_ >= metric::kKnownCount) {
+            stage_ = ReplayStage::Events;
+            break;
+        }
+        const char* name = metric::kKnownNames[replayMetric_];
+        StringSink sink;
+        JsonStreamWriter out(sink);
+        out.raw("{\"type\":\"readings\",\"metric\":");
+        out.string(name);
+        out.raw(",\"readings\":[");
+        ReadingsWriter writer(out, metricDecimals(name));
+        ReadingPager pager(readingCursor_, config_.replayReadings, writer);
+        history_.forEachReading(name, readingCursor_.epoch, replayUntil_, pager);
+        out.raw("]}");
+        out.flush();
+        if (pager.taken() == 0) {
+            ++replayMetric_;  // nothing (more) of this metric in the gap
+            readingCursor_ = ReadingCursor{replayFrom_, 0};
+            continue;
+        }
+        if (!publish(kReplayTopic, batch(now, {sink.body}), true, 0)) {
+            return false;  // the same page is read again next tick
+        }
+        ++counters_.replayPages;
+        if (pager.more()) {
+            readingCursor_ = pager.next();
+        } else {
+            ++replayMetric_;
+            readingCursor_ = ReadingCursor{replayFrom_, 0};
+        }
+        return true;
+    }
+    if (stage_ != ReplayStage::Events) {
+        return false;
+    }
+    EventQuery query;
+    query.since = replayFrom_;
+    query.until = replayUntil_;
+    query.limit = config_.replayEvents;
+    query.cursor = eventCursor_;
+    EventPage page = history_.queryEvents(query);
+    if (page.events.empty()) {
+        stage_ = ReplayStage::Draining;
+        return false;
+    }
+    std::vector<std::string> messages;
+    messages.reserve(page.events.size());
+    for (const EventRecord& record : page.events) {
+        messages.push_back(eventMessage(record.epoch, record.category, record.detail));
+    }
+    if (!publish(kReplayTopic, batch(now, messages), true, 0)) {
+        return false;
+    }
+    ++counters_.replayPages;
+    if (page.more) {
+        eventCursor_ = page.next;
+    } else {
+        stage_ = ReplayStage::Draining;
+    }
+    return true;
+}
+
+void MqttUplink::tick(uint32_t nowMs, const SensorReadingsDto& sensors,
+                      const std::vector<PumpDto>& pumps)
+{
+    for (MqttEvent event = client_.pollEvent(); event.type != MqttEventType::None;
+         event = client_.pollEvent()) {
+        handle(event);
+    }
+
+    // Starts and stops only while connected: offline, the event log has
+    // them (logPumpStart/logPumpStop) and the replay carries them.
+    pumpFps_.resize(pumps.size(), 0);
+    for (std::size_t i = 0; i < pumps.size(); ++i) {
+        const uint32_t fp = pumpStateFingerprint(pumps[i]);
+        if (fp != pumpFps_[i] && connected_) {
+            queue(serializeStreamPump(pumps[i]));
+        }
+        pumpFps_[i] = fp;
+    }
+
+    const WallTime wall = clock_.now();
+    if (connected_ && !replayChecked_ && wall.set) {
+        replayChecked_ = true;
+        beginReplay(wall.epoch);
+    }
+
+    const bool due = !haveBatch_ || nowMs - lastBatchMs_ >= config_.batchMs;
+    if (due && !connected_) {
+        // Left to the history store: its readings and events are replayed.
+        lastBatchMs_ = nowMs;
+        haveBatch_ = true;
+        ++counters_.spooled;
+        std::lock_guard<StaticMutex> lock(mutex_);
+        pending_.clear();
+    } else if (due && inflight_.size() < config_.maxInflight) {
+        std::vector<std::string> messages;
+        {
+            std::lock_guard<StaticMutex> lock(mutex_);
+            messages.assign(std::make_move_iterator(pending_.begin()),
+                            std::make_move_iterator(pending_.end()));
+            pending_.clear();
+        }
+        SensorSections all;
+        all.environmental = all.soil = all.level = all.power = true;
+        messages.push_back(serializeStreamSensors(sensors, all, true));
+        const uint32_t epoch = wall.set ? wall.epoch : 0;
+        if (publish(kTelemetryTopic, batch(epoch, messages), false, epoch)) {
+            lastBatchMs_ = nowMs;
+            haveBatch_ = true;
+            ++counters_.batches;
+        } else {
+            // Back to the front for the next tick, oldest dropped if the
+            // queue filled meanwhile. The snapshot is rebuilt then.
+            messages.pop_back();
+            std::lock_guard<StaticMutex> lock(mutex_);
+            for (auto it = messages.rbegin(); it != messages.rend(); ++it) {
+                if (pending_.size() == kMaxPending) {
+                    dropped_ += static_cast<uint32_t>(messages.rend() - it);
+                    break;
+                }
+                pending_.push_front(std::move(*it));
+            }
+        }
+    }
+
+    while (connected_ && inflight_.size() < config_.maxInflight && replayStep()) {
+    }
+    finishReplayIfDrained();  // a gap with nothing stored needs no PUBACK
+
+    counters_.connected = connected_;
+    counters_.replaying = stage_ != ReplayStage::Idle;
+    counters_.watermark = watermark_;
+    counters_.inflight = static_cast<uint32_t>(inflight_.size());
+    std::lock_guard<StaticMutex> lock(mutex_);
+    published_ = counters_;
+}
+
+}  // namespace api
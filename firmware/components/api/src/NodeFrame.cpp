@@ -0,0 +1,310 @@
+// SPDX-FileCopyrightText: 2026 Cryptotomte
+// SPDX-License-Identifier: AGPL-3.0-or-later
+/**
+ * @file NodeFrame.cpp
+ * @brief Implementation of the leaf/gateway frame codec.
+ */
+
+#include "api/NodeFrame.h"
+
+#include <algorithm>
+#include <cstring>
+#include <string>
+
+namespace api {
+
+namespace {
+
+constexpr uint8_t kMagic0 = 'W';
+constexpr uint8_t kMagic1 = 'N';
+
+constexpr uint8_t kFlagEnv = 1u << 0;
+constexpr uint8_t kFlagSoil = 1u << 1;
+constexpr uint8_t kFlagNitrogen = 1u << 2;
+constexpr uint8_t kFlagPhosphorus = 1u << 3;
+constexpr uint8_t kFlagPotassium = 1u << 4;
+constexpr uint8_t kFlagPower = 1u << 5;
+constexpr uint8_t kFlagPowerValid = 1u << 6;
+
+constexpr uint8_t kLowValid = 1u << 0;
+constexpr uint8_t kLowWet = 1u << 1;
+constexpr uint8_t kHighValid = 1u << 2;
+constexpr uint8_t kHighWet = 1u << 3;
+
+class FrameWriter {
+public:
+    explicit FrameWriter(uint8_t* out) : out_(out) {}
+
+    void u8(uint8_t v) { out_[len_++] = v; }
+
+    void u16(uint16_t v)
+    {
+        u8(static_cast<uint8_t>(v));
+        u8(static_cast<uint8_t>(v >> 8));
+    }
+
+    void u32(uint32_t v)
+    {
+        u16(static_cast<uint16_t>(v));
+        u16(static_cast<uint16_t>(v >> 16));
+    }
+
+    void f32(float v)
+    {
+        uint32_t bits = 0;
+        std::memcpy(&bits, &v, sizeof bits);
+        u32(bits);
+    }
+
+    void bytes(const char* data, std::size_t n)
+    {
+        std::memcpy(out_ + len_, data, n);
+        len_ += n;
+    }
+
+    std::size_t size() const { return len_; }
+
+private:
+    uint8_t* out_;
+    std::size_t len_ = 0;
+};
+
+/// Bounds-checked reader: every getter fails (and keeps failing) once the
+/// input runs out.
+class FrameReader {
+public:
+    FrameReader(const uint8_t* data, std::size_t len) : data_(data), len_(len) {}
+
+    bool u8(uint8_t& v)
+    {
+        if (pos_ + 1 > len_) {
+            return false;
+        }
+        v = data_[pos_++];
+        return true;
+    }
+
+    bool u16(uint16_t& v)
+    {
+        if (pos_ + 2 > len_) {
+            return false;
+        }
+        v = static_cast<uint16_t>(data_[pos_] | (data_[pos_ + 1] << 8));
+        pos_ += 2;
+        return true;
+    }
+
+    bool u32(uint32_t& v)
+    {
+        uint16_t lo = 0;
+        uint16_t hi = 0;
+        if (!u16(lo) || !u16(hi)) {
+            return false;
+        }
+        v = static_cast<uint32_t>(lo) | (static_cast<uint32_t>(hi) << 16);
+        return true;
+    }
+
+    bool f32(float& v)
+    {
+        uint32_t bits = 0;
+        if (!u32(bits)) {
+            return false;
+        }
+        std::memcpy(&v, &bits, sizeof v);
+        return true;
+    }
+
+    bool bytes(std::string& out, std::size_t n)
+    {
+        if (pos_ + n > len_) {
+            return false;
+        }
+        out.assign(reinterpret_cast<const char*>(data_ + pos_), n);
+        pos_ += n;
+        return true;
+    }
+
+    bool done() const { return pos_ == len_; }
+
+private:
+    const uint8_t* data_;
+    std::size_t len_;
+    std::size_t pos_ = 0;
+};
+
+void writeHeader(FrameWriter& out, NodeFrameType type, uint16_t seq)
+{
+    out.u8(kMagic0);
+    out.u8(kMagic1);
+    out.u8(kNodeFrameVersion);
+    out.u8(static_cast<uint8_t>(type));
+    out.u16(seq);
+}
+
+bool readReport(FrameReader& in, NodeFrame& out)
+{
+    SensorReadingsDto& s = out.sensors;
+    uint32_t timestamp = 0;
+    uint8_t flags = 0;
+    uint8_t level = 0;
+    if (!in.u32(timestamp) || !in.u8(flags) || !in.u8(level)) {
+        return false;
+    }
+    s.hasTimestamp = timestamp != 0;
+    s.timestamp = static_cast<int64_t>(timestamp);
+    s.level.low.valid = (level & kLowValid) != 0;
+    s.level.low.waterPresent = (level & kLowWet) != 0;
+    s.level.high.valid = (level & kHighValid) != 0;
+    s.level.high.waterPresent = (level & kHighWet) != 0;
+
+    bool ok = true;
+    if ((flags & kFlagEnv) != 0) {
+        EnvironmentalDto& env = s.environmental;
+        env.valid = true;
+        ok = in.f32(env.temperature) && in.f32(env.humidity) && in.f32(env.pressure);
+    }
+    if (ok && (flags & kFlagSoil) != 0) {
+        SoilDto& soil = s.soil;
+        soil.valid = true;
+        ok = in.f32(soil.moisture) && in.f32(soil.temperature) &&
+             in.f32(soil.humidity) && in.f32(soil.ph) && in.f32(soil.ec);
+        soil.hasNitrogen = (flags & kFlagNitrogen) != 0;
+        soil.hasPhosphorus = (flags & kFlagPhosphorus) != 0;
+        soil.hasPotassium = (flags & kFlagPotassium) != 0;
+        ok = ok && (!soil.hasNitrogen || in.f32(soil.nitrogen)) &&
+             (!soil.hasPhosphorus || in.f32(soil.phosphorus)) &&
+             (!soil.hasPotassium || in.f32(soil.potassium));
+    }
+    if (ok && (flags & kFlagPower) != 0) {
+        s.hasPower = true;
+        s.power.valid = (flags & kFlagPowerValid) != 0;
+        ok = in.f32(s.power.busVoltage) && in.f32(s.power.current) &&
+             in.f32(s.power.power);
+    }
+    uint8_t count = 0;
+    if (!ok || !in.u8(count) || count > kNodeMaxPumps) {
+        return false;
+    }
+    out.pumps.resize(count);
+    for (PumpDto& pump : out.pumps) {
+        uint8_t nameLen = 0;
+        uint8_t running = 0;
+        if (!in.u8(nameLen) || nameLen > kNodeNameMax ||
+            !in.bytes(pump.name, nameLen) || !in.u8(running) ||
+            !in.u32(pump.currentRunTimeMs) || !in.u32(pump.accumulatedRunTimeMs)) {
+            return false;
+        }
+        pump.running = running != 0;
+    }
+    return true;
+}
+
+}  // namespace
+
+std::size_t encodeNodeReport(uint16_t seq, const SensorReadingsDto& sensors,
+                             const std::vector<PumpDto>& pumps, uint8_t* out)
+{
+    FrameWriter w(out);
+    writeHeader(w, NodeFrameType::Report, seq);
+    w.u32(sensors.hasTimestamp && sensors.timestamp > 0
+              ? static_cast<uint32_t>(sensors.timestamp)
+              : 0);
+
+    const EnvironmentalDto& env = sensors.environmental;
+    const SoilDto& soil = sensors.soil;
+    uint8_t flags = 0;
+    flags |= env.valid ? kFlagEnv : 0;
+    if (soil.valid) {
+        flags |= kFlagSoil;
+        flags |= soil.hasNitrogen ? kFlagNitrogen : 0;
+        flags |= soil.hasPhosphorus ? kFlagPhosphorus : 0;
+        flags |= soil.hasPotassium ? kFlagPotassium : 0;
+    }
+    if (sensors.hasPower) {
+        flags |= kFlagPower;
+        flags |= sensors.power.valid ? kFlagPowerValid : 0;
+    }
+    const LevelDto& level = sensors.level;
+    uint8_t levelBits = 0;
+    levelBits |= level.low.valid ? kLowValid : 0;
+    levelBits |= level.low.waterPresent ? kLowWet : 0;
+    levelBits |= level.high.valid ? kHighValid : 0;
+    levelBits |= level.high.waterPresent ? kHighWet : 0;
+    w.u8(static_cast<uint8_t>(flags));
+    w.u8(static_cast<uint8_t>(levelBits));
+
+    if (env.valid) {
+        w.f32(env.temperature);
+        w.f32(env.humidity);
+        w.f32(env.pressure);
+    }
+    if (soil.valid) {
+        w.f32(soil.moisture);
+        w.f32(soil.temperature);
+        w.f32(soil.humidity);
+        w.f32(soil.ph);
+        w.f32(soil.ec);
+        if (soil.hasNitrogen) {
+            w.f32(soil.nitrogen);
+        }
+        if (soil.hasPhosphorus) {
+            w.f32(soil.phosphorus);
+        }
+        if (soil.hasPotassium) {
+            w.f32(soil.potassium);
+        }
+    }
+    if (sensors.hasPower) {
+        w.f32(sensors.power.busVoltage);
+        w.f32(sensors.power.current);
+        w.f32(sensors.power.power);
+    }
+
+    const std::size_t count = std::min(pumps.size(), kNodeMaxPumps);
+    w.u8(static_cast<uint8_t>(count));
+    for (std::size_t i = 0; i < count; ++i) {
+        const PumpDto& pump = pumps[i];
+        const std::size_t nameLen = std::min(pump.name.size(), kNodeNameMax);
+        w.u8(static_cast<uint8_t>(nameLen));
+        w.bytes(pump.name.data(), nameLen);
+        w.u8(pump.running ? 1 : 0);
+        w.u32(pump.currentRunTimeMs);
+        w.u32(pump.accumulatedRunTimeMs);
+    }
+    return w.size();
+}
+
+std::size_t encodeNodeAck(uint16_t seq, uint8_t* out)
+{
+    FrameWriter w(out);
+    writeHeader(w, NodeFrameType::Ack, seq);
+    return w.size();
+}
+
+bool decodeNodeFrame(const uint8_t* data, std::size_t len, NodeFrame& out)
+{
+    FrameReader in(data, len);
+    uint8_t magic0 = 0;
+    uint8_t magic1 = 0;
+    uint8_t version = 0;
+    uint8_t type = 0;
+    if (!in.u8(magic0) || !in.u8(magic1) || !in.u8(version) || !in.u8(type) ||
+        !in.u16(out.seq) || magic0 != kMagic0 || magic1 != kMagic1 ||
+        version != kNodeFrameVersion) {
+        return false;
+    }
+    out.sensors = SensorReadingsDto{};
+    out.pumps.clear();
+    switch (static_cast<NodeFrameType>(type)) {
+        case NodeFrameType::Ack:
+            out.type = NodeFrameType::Ack;
+            return in.done();
+        case NodeFrameType::Report:
+            out.type = NodeFrameType::Report;
+            return readReport(in, out) && in.done();
+    }
+    return false;
+}
+
+}  // namespace api
@@ -0,0 +1,249 @@
+// SPDX-FileCopyrightText: 2026 Cryptotomte
+// SPDX-License-Identifier: AGPL-3.0-or-later
+/**
+ * @file NodeGateway.cpp
+ * @brief Implementation of the gateway's leaf table and history.
+ */
+
+#include "api/NodeGateway.h"
+
+#include <mutex>
+#include <utility>
+
+namespace api {
+
+namespace {
+
+/// A seq this far ahead of the last one is a skip; further is a restart.
+constexpr uint16_t kMaxSeqGap = 0x8000;
+
+int hexDigit(char c)
+{
+    if (c >= '0' && c <= '9') {
+        return c - '0';
+    }
+    if (c >= 'a' && c <= 'f') {
+        return c - 'a' + 10;
+    }
+    if (c >= 'A' && c <= 'F') {
+        return c - 'A' + 10;
+    }
+    return -1;
+}
+
+}  // namespace
+
+std::string NodeGateway::formatNode(const EspNowMac& mac)
+{
+    static constexpr char kHex[] = "0123456789abcdef";
+    std::string out;
+    out.reserve(mac.size() * 2);
+    for (const uint8_t b : mac) {
+        out += kHex[b >> 4];
+        out += kHex[b & 0x0F];
+    }
+    return out;
+}
+
+bool NodeGateway::parseNode(std::string_view text, EspNowMac& mac)
+{
+    if (text.size() != mac.size() * 2) {
+        return false;
+    }
+    for (std::size_t i = 0; i < mac.size(); ++i) {
+        const int hi = hexDigit(text[2 * i]);
+        const int lo = hexDigit(text[2 * i + 1]);
+        if (hi < 0 || lo < 0) {
+            return false;
+        }
+        mac[i] = static_cast<uint8_t>((hi << 4) | lo);
+    }
+    return true;
+}
+
+void NodeGateway::tick(uint32_t nowMs)
+{
+    EspNowPacket packet;
+    NodeFrame frame;
+    while (link_.receive(packet)) {
+        if (!decodeNodeFrame(packet.data, packet.len, frame) ||
+            frame.type != NodeFrameType::Report) {
+            std::lock_guard<StaticMutex> lock(mutex_);
+            ++counters_.malformed;
+            continue;
+        }
+        bool accepted = false;
+        {
+            std::lock_guard<StaticMutex> lock(mutex_);
+            Node* node = slotFor(packet.from, nowMs);
+            if (node == nullptr) {
+                ++counters_.refused;
+            } else {
+                store(*node, packet, frame, nowMs);
+                accepted = true;
+            }
+            counters_.nodes = static_cast<uint32_t>(nodes_.size());
+        }
+        if (accepted) {
+            ack(packet.from, frame.seq);  // outside the lock: a radio call
+        }
+    }
+}
+
+NodeGateway::Node* NodeGateway::slotFor(const EspNowMac& mac, uint32_t nowMs)
+{
+    Node* stalest = nullptr;
+    for (Node& node : nodes_) {
+        if (node.mac == mac) {
+            return &node;
+        }
+        if (stalest == nullptr ||
+            nowMs - node.lastSeenMs > nowMs - stalest->lastSeenMs) {
+            stalest = &node;
+        }
+    }
+    Node* fresh = nullptr;
+    if (nodes_.size() < kMaxNodes) {
+        fresh = &nodes_.emplace_back();
+    } else if (stalest != nullptr && nowMs - stalest->lastSeenMs > kStaleMs) {
+        // The stalest slot is reused in place; its leaf starts over if it
+        // ever comes back.
+        *stalest = Node{};
+        fresh = stalest;
+    } else {
+        return nullptr;
+    }
+    fresh->mac = mac;
+    return fresh;
+}
+
+void NodeGateway::store(Node& node, const EspNowPacket& packet, NodeFrame& frame,
+                        uint32_t nowMs)
+{
+    node.lastSeenMs = nowMs;
+    node.rssi = packet.rssi;
+    if (node.reports != 0 && frame.seq == node.seq) {
+        ++node.duplicates;
+        ++counters_.duplicates;
+        return;
+    }
+    if (node.reports != 0) {
+        const uint16_t gap = static_cast<uint16_t>(frame.seq - node.seq);
+        if (gap > 1 && gap < kMaxSeqGap) {
+            node.missed += gap - 1u;
+            counters_.missed += gap - 1u;
+        }
+    }
+    node.seq = frame.seq;
+    ++node.reports;
+    ++counters_.reports;
+
+    Sample sample;
+    if (frame.sensors.hasTimestamp) {
+        sample.epoch = static_cast<uint32_t>(frame.sensors.timestamp);
+    } else {
+        const WallTime wall = clock_.now();
+        sample.epoch = wall.set ? wall.epoch : 0;
+    }
+    const auto put = [&sample](MetricId id, float value) {
+        sample.valid = static_cast<uint16_t>(sample.valid | (1u << id));
+        sample.values[id] = value;
+    };
+    const EnvironmentalDto& env = frame.sensors.environmental;
+    if (env.valid) {
+        put(metric::kEnvTemperature, env.temperature);
+        put(metric::kEnvHumidity, env.humidity);
+        put(metric::kEnvPressure, env.pressure);
+    }
+    const SoilDto& soil = frame.sensors.soil;
+    if (soil.valid) {
+        put(metric::kSoilMoisture, soil.moisture);
+        put(metric::kSoilTemperature, soil.temperature);
+        put(metric::kSoilPh, soil.ph);
+        put(metric::kSoilEc, soil.ec);
+        if (soil.hasNitrogen) {
+            put(metric::kSoilNitrogen, soil.nitrogen);
+        }
+        if (soil.hasPhosphorus) {
+            put(metric::kSoilPhosphorus, soil.phosphorus);
+        }
+        if (soil.hasPotassium) {
+            put(metric::kSoilPotassium, soil.potassium);
+        }
+    }
+    if (sample.epoch != 0 && sample.valid != 0) {
+        if (node.history.size() < kHistoryDepth) {
+            node.history.push_back(sample);
+        } else {
+            node.history[node.head] = sample;
+            node.head = (node.head + 1) % kHistoryDepth;
+        }
+    }
+    node.sensors = std::move(frame.sensors);
+    node.pumps = std::move(frame.pumps);
+}
+
+void NodeGateway::ack(const EspNowMac& to, uint16_t seq)
+{
+    uint8_t out[kNodeFrameHeader];
+    const std::size_t len = encodeNodeAck(seq, out);
+    // A refused Ack looks like one lost on the air: the leaf resends and
+    // the resend is acknowledged as a duplicate.
+    (void)link_.send(to, out, len);
+}
+
+std::vector<NodeDto> NodeGateway::nodes(uint32_t nowMs) const
+{
+    std::lock_guard<StaticMutex> lock(mutex_);
+    std::vector<NodeDto> out;
+    out.reserve(nodes_.size());
+    for (const Node& node : nodes_) {
+        NodeDto dto;
+        dto.node = formatNode(node.mac);
+        dto.lastSeenS = (nowMs - node.lastSeenMs) / 1000;
+        dto.rssi = node.rssi;
+        dto.reports = node.reports;
+        dto.duplicates = node.duplicates;
+        dto.missed = node.missed;
+        dto.sensors = node.sensors;
+        dto.pumps = node.pumps;
+        out.push_back(std::move(dto));
+    }
+    return out;
+}
+
+bool NodeGateway::history(std::string_view node, MetricId id, uint32_t t0,
+                          uint32_t t1, HistorySeries& out) const
+{
+    EspNowMac mac{};
+    if (!parseNode(node, mac)) {
+        return false;
+    }
+    std::lock_guard<StaticMutex> lock(mutex_);
+    for (const Node& n : nodes_) {
+        if (n.mac != mac) {
+            continue;
+        }
+        if (id >= kNodeMetrics) {
+            return true;  // a metric leaves do not report: an empty series
+        }
+        const std::size_t count = n.history.size();
+        for (std::size_t i = 0; i < count; ++i) {
+            const Sample& s = n.history[(n.head + i) % count];
+            if ((s.valid & (1u << id)) != 0 && s.epoch >= t0 && s.epoch <= t1) {
+                out.timestamps.push_back(static_cast<int64_t>(s.epoch));
+                out.values.push_back(s.values[id]);
+            }
+        }
+        return true;
+    }
+    return false;
+}
+
+NodeGatewayStats NodeGateway::stats() const
+{
+    std::lock_guard<StaticMutex> lock(mutex_);
+    return counters_;
+}
+
+}  // namespace api
@@ -0,0 +1,93 @@
+// SPDX-FileCopyrightText: 2026 Cryptotomte
+// SPDX-License-Identifier: AGPL-3.0-or-later
+/**
+ * @file NodeLeaf.cpp
+ * @brief Implementation of the leaf report sender.
+ */
+
+#include "api/NodeLeaf.h"
+
+#include <mutex>
+
+namespace api {
+
+void NodeLeaf::poll(uint32_t nowMs)
+{
+    EspNowPacket packet;
+    NodeFrame frame;
+    while (link_.receive(packet)) {
+        // Anything but the Ack of the report in flight is stale or foreign.
+        if (packet.from != gateway_ || !decodeNodeFrame(packet.data, packet.len, frame) ||
+            frame.type != NodeFrameType::Ack || !awaiting_ || frame.seq != seq_) {
+            continue;
+        }
+        awaiting_ = false;
+        ++counters_.acked;
+    }
+    if (awaiting_ && nowMs - sentMs_ >= (config_.ackTimeoutMs << attempt_)) {
+        if (attempt_ < config_.maxRetries) {
+            ++attempt_;
+            ++counters_.retries;
+            transmit(nowMs);
+        } else {
+            awaiting_ = false;
+            ++counters_.lost;
+        }
+    }
+    publish();
+}
+
+bool NodeLeaf::reportDue(uint32_t nowMs) const
+{
+    if (awaiting_) {
+        return false;
+    }
+    if (!started_) {
+        return nowMs >= config_.phaseMs;
+    }
+    return nowMs - periodStartMs_ >= config_.periodMs;
+}
+
+void NodeLeaf::report(uint32_t nowMs, const SensorReadingsDto& sensors,
+                      const std::vector<PumpDto>& pumps)
+{
+    // A report whose retries are still running is superseded: the newer
+    // readings matter more than the older ones' delivery.
+    if (awaiting_) {
+        ++counters_.lost;
+    }
+    if (started_) {
+        ++seq_;
+    }
+    started_ = true;
+    periodStartMs_ = nowMs;
+    frameLen_ = encodeNodeReport(seq_, sensors, pumps, frame_);
+    attempt_ = 0;
+    awaiting_ = true;
+    ++counters_.reports;
+    transmit(nowMs);
+    publish();
+}
+
+void NodeLeaf::transmit(uint32_t nowMs)
+{
+    sentMs_ = nowMs;
+    if (!link_.send(gateway_, frame_, frameLen_)) {
+        // Treated like a frame lost on the air: the Ack timeout resends it.
+        ++counters_.rejected;
+    }
+}
+
+void NodeLeaf::publish()
+{
+    std::lock_guard<StaticMutex> lock(mutex_);
+    published_ = counters_;
+}
+
+NodeLeafStats NodeLeaf::stats() const
+{
+    std::lock_guard<StaticMutex> lock(mutex_);
+    return published_;
+}
+
+}  // namespace api
@@ -0,0 +1,338 @@
+// SPDX-FileCopyrightText: 2026 Cryptotomte
+// SPDX-License-Identifier: AGPL-3.0-or-later
+/**
+ * @file OtaPipeline.cpp
+ * @brief The two-buffer receive/write hand-over (see OtaPipeline.h).
+ *
+ * A buffer is the receiver's while queued_[i] is 0 and the writer's from
+ * the moment the receiver queues it until the writer frees it; the writer
+ * takes them in order (writeNext_). Neither side touches the other's
+ * buffer, so the bytes themselves are copied without the lock.
+ *
+ * receive() reads the first kDeltaHeaderBytes itself to tell a patch from
+ * a full image; a full image gets them back through ReplaySource ahead of
+ * the rest of the body.
+ */
+
+#include "api/OtaPipeline.h"
+
+#include <chrono>
+#include <cstring>
+
+#include "api/DeltaPatch.h"
+
+namespace api {
+
+namespace {
+
+/// Up to @p len bytes, fewer only when @p source ends or fails.
+std::size_t readFully(IChunkSource& source, uint8_t* dst, std::size_t len)
+{
+    std::size_t have = 0;
+    while (have < len) {
+        const int r = source.receive(dst + have, len - have);
+        if (r <= 0) {
+            break;
+        }
+        have += static_cast<std::size_t>(r);
+    }
+    return have;
+}
+
+/// @p head (already read) and then the rest of @p rest.
+class ReplaySource final : public IChunkSource {
+public:
+    ReplaySource(const uint8_t* head, std::size_t headLen, IChunkSource& rest)
+        : head_(head), headLeft_(headLen), rest_(rest)
+    {
+    }
+
+    int receive(uint8_t* dst, std::size_t len) override
+    {
+        if (headLeft_ == 0) {
+            return rest_.receive(dst, len);
+        }
+        const std::size_t n = headLeft_ < len ? headLeft_ : len;
+        std::memcpy(dst, head_, n);
+        head_ += n;
+        headLeft_ -= n;
+        return static_cast<int>(n);
+    }
+
+private:
+    const uint8_t* head_;
+    std::size_t headLeft_;
+    IChunkSource& rest_;
+};
+
+}  // namespace
+
+const char* otaOutcomeName(OtaOutcome outcome)
+{
+    switch (outcome) {
+    case OtaOutcome::Ok:
+        return "ok";
+    case OtaOutcome::Busy:
+        return "busy";
+    case OtaOutcome::NoLength:
+        return "no-length";
+    case OtaOutcome::TooLarge:
+        return "too-large";
+    case OtaOutcome::ReceiveFailed:
+        return "receive-failed";
+    case OtaOutcome::WriteFailed:
+        return "write-failed";
+    case OtaOutcome::HashMismatch:
+        return "hash-mismatch";
+    case OtaOutcome::Rejected:
+        return "rejected";
+    case OtaOutcome::BaseMismatch:
+        return "base-mismatch";
+    case OtaOutcome::BadPatch:
+        return "bad-patch";
+    }
+    return "unknown";
+}
+
+OtaPipeline::OtaPipeline(IFirmwareSlot& slot, ITimeProvider& clock)
+    : slot_(slot), clock_(clock)
+{
+}
+
+void OtaPipeline::attachWriter()
+{
+    std::lock_guard<std::mutex> lock(mutex_);
+    writerAttached_ = true;
+}
+
+void OtaPipeline::setBaseImage(IRunningImage& base)
+{
+    base_ = &base;
+}
+
+OtaReport OtaPipeline::receive(std::size_t bodyBytes, const Sha256::Digest* expected,
+                               IChunkSource& source)
+{
+    OtaReport report;
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        if (busy_) {
+            ++stats_.failures;
+            report.outcome = OtaOutcome::Busy;
+            return report;
+        }
+        busy_ = true;
+    }
+    const int64_t startMs = clock_.nowMs();
+
+    uint8_t head[kDeltaHeaderBytes];
+    const std::size_t headLen = bodyBytes < sizeof head ? bodyBytes : sizeof head;
+    const std::size_t got = bodyBytes == 0 ? 0 : readFully(source, head, headLen);
+    if (bodyBytes == 0) {
+        report.outcome = OtaOutcome::NoLength;
+    } else if (got < headLen) {
+        report.outcome = OtaOutcome::ReceiveFailed;
+        report.transferBytes = static_cast<uint32_t>(got);
+    } else if (isDeltaPatch(head, headLen)) {
+        report = receiveDelta(head, bodyBytes, expected, source);
+    } else {
+        ReplaySource image(head, headLen, source);
+        report = stream(bodyBytes, expected, image);
+        report.transferBytes = report.bytes;
+    }
+    report.elapsedMs = static_cast<uint32_t>(clock_.nowMs() - startMs);
+    return finish(report);
+}
+
+OtaReport OtaPipeline::receiveDelta(const uint8_t* head, std::size_t bodyBytes,
+                                    const Sha256::Digest* expected, IChunkSource& source)
+{
+    OtaReport report;
+    report.delta = true;
+    const std::size_t headLen = bodyBytes < kDeltaHeaderBytes ? bodyBytes : kDeltaHeaderBytes;
+    report.transferBytes = static_cast<uint32_t>(headLen);
+    DeltaHeader header;
+    if (!parseDeltaHeader(head, headLen, header)) {
+        report.outcome = OtaOutcome::BadPatch;
+        return report;
+    }
+    if (!baseMatches(header)) {
+        report.outcome = OtaOutcome::BaseMismatch;
+        return report;
+    }
+    if (expected != nullptr && *expected != header.targetSha256) {
+        report.outcome = OtaOutcome::HashMismatch;
+        return report;
+    }
+    DeltaSource image(source, bodyBytes - kDeltaHeaderBytes, *base_, header.baseBytes);
+    report = stream(header.targetBytes, &header.targetSha256, image);
+    report.delta = true;
+    report.transferBytes = static_cast<uint32_t>(kDeltaHeaderBytes + image.received());
+    if (image.malformed()) {
+        report.outcome = OtaOutcome::BadPatch;
+    }
+    return report;
+}
+
+bool OtaPipeline::baseMatches(const DeltaHeader& header)
+{
+    Sha256::Digest running{};
+    return base_ != nullptr && base_->size() == header.baseBytes &&
+           base_->sha256(running.data()) && running == header.baseSha256;
+}
+
+OtaReport OtaPipeline::stream(std::size_t imageBytes, const Sha256::Digest* expected,
+                              IChunkSource& source)
+{
+    OtaReport report;
+    bool threaded = false;
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        discard_ = false;
+        writeFailed_ = false;
+        writeNext_ = 0;
+        threaded = writerAttached_;
+    }
+    hash_.reset();
+
+    if (imageBytes > slot_.capacity()) {
+        report.outcome = OtaOutcome::TooLarge;
+        return report;
+    }
+    if (!slot_.begin(imageBytes)) {
+        report.outcome = OtaOutcome::WriteFailed;
+        return report;
+    }
+
+    std::size_t remaining = imageBytes;
+    std::size_t index = 0;
+    while (remaining > 0 && report.outcome == OtaOutcome::Ok) {
+        if (threaded) {
+            std::unique_lock<std::mutex> lock(mutex_);
+            if (queued_[index] != 0) {
+                ++stats_.receiveWaits;
+                changed_.wait(lock, [&] { return queued_[index] == 0; });
+            }
+            if (writeFailed_) {
+                report.outcome = OtaOutcome::WriteFailed;
+                break;
+            }
+        }
+
+        const std::size_t want = remaining < kChunkBytes ? remaining : kChunkBytes;
+        const std::size_t have = readFully(source, buffers_[index], want);
+        if (have < want) {
+            report.outcome = OtaOutcome::ReceiveFailed;
+            break;
+        }
+        remaining -= have;
+
+        if (threaded) {
+            std::lock_guard<std::mutex> lock(mutex_);
+            queued_[index] = have;
+            changed_.notify_all();
+        } else if (!writeChunk(index, have)) {
+            report.outcome = OtaOutcome::WriteFailed;
+        }
+        index ^= 1u;
+    }
+
+    if (threaded) {
+        // The writer may still hold a buffer (and the slot): wait it out,
+        // dropping what is queued once the upload has failed.
+        std::unique_lock<std::mutex> lock(mutex_);
+        discard_ = report.outcome != OtaOutcome::Ok;
+        changed_.wait(lock, [this] { return queued_[0] == 0 && queued_[1] == 0; });
+        if (writeFailed_ && report.outcome == OtaOutcome::Ok) {
+            report.outcome = OtaOutcome::WriteFailed;
+        }
+    }
+
+    report.bytes = static_cast<uint32_t>(imageBytes - remaining);
+    if (report.outcome == OtaOutcome::Ok) {
+        report.sha256 = hash_.finish();
+        if (expected != nullptr && *expected != report.sha256) {
+            report.outcome = OtaOutcome::HashMismatch;
+        } else if (!slot_.commit()) {
+            report.outcome = OtaOutcome::Rejected;
+        }
+    }
+    if (report.outcome != OtaOutcome::Ok) {
+        slot_.abort();
+    }
+    return report;
+}
+
+bool OtaPipeline::serveWrite(uint32_t waitMs)
+{
+    std::size_t index = 0;
+    std::size_t len = 0;
+    bool skip = false;
+    {
+        std::unique_lock<std::mutex> lock(mutex_);
+        if (!changed_.wait_for(lock, std::chrono::milliseconds(waitMs),
+                               [this] { return queued_[writeNext_] != 0; })) {
+            return false;
+        }
+        index = writeNext_;
+        len = queued_[index];
+        skip = discard_ || writeFailed_;
+    }
+    const bool ok = skip || writeChunk(index, len);
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (!ok) {
+        writeFailed_ = true;
+    }
+    queued_[index] = 0;
+    writeNext_ = index ^ 1u;
+    changed_.notify_all();
+    return true;
+}
+
+bool OtaPipeline::writeChunk(std::size_t index, std::size_t len)
+{
+    if (!slot_.write(buffers_[index], len)) {
+        return false;
+    }
+    hash_.update(buffers_[index], len);
+    return true;
+}
+
+OtaReport OtaPipeline::finish(OtaReport report)
+{
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (report.outcome == OtaOutcome::Ok) {
+        ++stats_.uploads;
+    } else {
+        ++stats_.failures;
+    }
+    report_ = report;
+    haveReport_ = true;
+    busy_ = false;
+    return report;
+}
+
+bool OtaPipeline::takeReport(OtaReport& out)
+{
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (!haveReport_) {
+        return false;
+    }
+    haveReport_ = false;
+    out = report_;
+    return true;
+}
+
+bool OtaPipeline::busy() const
+{
+    std::lock_guard<std::mutex> lock(mutex_);
+    return busy_;
+}
+
+OtaStats OtaPipeline::stats() const
+{
+    std::lock_guard<std::mutex> lock(mutex_);
+    return stats_;
+}
+
+}  // namespace api
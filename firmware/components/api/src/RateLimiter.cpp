@@ -0,0 +1,76 @@
+// SPDX-FileCopyrightText: 2026 Cryptotomte
+// SPDX-License-Identifier: AGPL-3.0-or-later
+/**
+ * @file RateLimiter.cpp
+ * @brief Implementation of the per-client token-bucket limiter.
+ */
+
+#include "api/RateLimiter.h"
+
+#include <cstring>
+
+namespace api {
+
+ClientAddress ClientAddress::fromIpv4(uint32_t ipv4)
+{
+    ClientAddress address;
+    address.bytes[10] = 0xFF;
+    address.bytes[11] = 0xFF;
+    std::memcpy(address.bytes + 12, &ipv4, 4);  // already network order
+    return address;
+}
+
+bool operator==(const ClientAddress& a, const ClientAddress& b)
+{
+    return std::memcmp(a.bytes, b.bytes, sizeof a.bytes) == 0;
+}
+
+void RateLimiter::configure(uint32_t perSecond, uint32_t burst)
+{
+    constexpr uint32_t kMaxBurst = UINT32_MAX / kScale;
+    perSecond_ = perSecond;
+    capacity_ = (burst == 0 ? 1 : (burst > kMaxBurst ? kMaxBurst : burst)) * kScale;
+    for (Slot& slot : slots_) {
+        slot = Slot{};
+    }
+}
+
+bool RateLimiter::admit(const ClientAddress& client, uint32_t nowMs)
+{
+    if (!enabled()) {
+        return true;
+    }
+    Slot& slot = slotFor(client, nowMs);
+    // perSecond tokens a second is perSecond thousandths a millisecond.
+    const uint64_t refill = static_cast<uint64_t>(nowMs - slot.lastMs) * perSecond_;
+    const uint64_t tokens = slot.tokens + refill;
+    slot.tokens = tokens > capacity_ ? capacity_ : static_cast<uint32_t>(tokens);
+    slot.lastMs = nowMs;
+    if (slot.tokens < kScale) {
+        ++throttled_;
+        return false;
+    }
+    slot.tokens -= kScale;
+    return true;
+}
+
+RateLimiter::Slot& RateLimiter::slotFor(const ClientAddress& client, uint32_t nowMs)
+{
+    Slot* oldest = &slots_[0];
+    for (Slot& slot : slots_) {
+        if (slot.used && slot.address == client) {
+            return slot;
+        }
+        // A free slot beats any used one; among used, the longest unseen.
+        if (!oldest->used) {
+            continue;
+        }
+        if (!slot.used || nowMs - slot.lastMs > nowMs - oldest->lastMs) {
+            oldest = &slot;
+        }
+    }
+    *oldest = Slot{client, capacity_, nowMs, true};
+    return *oldest;
+}
+
+}  // namespace api
@@ -0,0 +1,181 @@
+// SPDX-FileCopyrightText: 2026 Cryptotomte
+// SPDX-License-Identifier: AGPL-3.0-or-later
+/**
+ * @file ReadAheadPipe.cpp
+ * @brief The two-buffer read/send hand-over (see ReadAheadPipe.h).
+ *
+ * A buffer is the reader's while filled_[i] is 0 and the sender's from the
+ * moment the reader fills it until the sender frees it; the reader takes
+ * them in order (readNext_) and the sender drains them in the same order.
+ * ended_ is set together with the last chunk, so an empty buffer after it
+ * means the body is out. Neither side touches the other's buffer, so the
+ * bytes themselves move without the lock.
+ */
+
+#include "api/ReadAheadPipe.h"
+
+#include <chrono>
+
+namespace api {
+
+namespace {
+
+/// Result of filling one chunk: bytes read, and whether the source ended
+/// (or failed) before the chunk was full.
+struct ChunkRead {
+    std::size_t bytes = 0;
+    bool ended = false;
+    bool failed = false;
+};
+
+ChunkRead readChunk(IChunkSource& source, uint8_t* dst, std::size_t len)
+{
+    ChunkRead read;
+    while (read.bytes < len) {
+        const int r = source.receive(dst + read.bytes, len - read.bytes);
+        if (r <= 0) {
+            read.ended = true;
+            read.failed = r < 0;
+            break;
+        }
+        read.bytes += static_cast<std::size_t>(r);
+    }
+    return read;
+}
+
+}  // namespace
+
+int FileChunkSource::receive(uint8_t* dst, std::size_t len)
+{
+    if (len > left_) {
+        len = static_cast<std::size_t>(left_);
+    }
+    if (len == 0) {
+        return 0;
+    }
+    const std::size_t n = std::fread(dst, 1, len, file_);
+    left_ -= n;
+    // fread returns 0 on both EOF and a read error; ferror tells them apart.
+    if (n == 0 && std::ferror(file_) != 0) {
+        return -1;
+    }
+    return static_cast<int>(n);
+}
+
+PumpOutcome copyChunks(IChunkSource& source, IChunkSink& sink, uint8_t* buf,
+                       std::size_t cap)
+{
+    for (;;) {
+        const ChunkRead read = readChunk(source, buf, cap);
+        if (read.bytes > 0 &&
+            !sink.send(reinterpret_cast<const char*>(buf), read.bytes)) {
+            return PumpOutcome::SendFailed;
+        }
+        if (read.ended) {
+            return read.failed ? PumpOutcome::ReadFailed : PumpOutcome::Ok;
+        }
+    }
+}
+
+void ReadAheadPipe::attachReader()
+{
+    std::lock_guard<std::mutex> lock(mutex_);
+    readerAttached_ = true;
+}
+
+PumpOutcome ReadAheadPipe::pump(IChunkSource& source, IChunkSink& sink, uint8_t* spare,
+                                std::size_t spareBytes)
+{
+    bool threaded = false;
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        threaded = readerAttached_ && !busy_;
+        if (threaded) {
+            ++stats_.pumps;
+            busy_ = true;
+            source_ = &source;
+            ended_ = false;
+            readFailed_ = false;
+            stop_ = false;
+            filled_[0] = filled_[1] = 0;
+            readNext_ = 0;
+            changed_.notify_all();
+        } else {
+            ++stats_.inlined;
+        }
+    }
+    if (!threaded) {
+        return copyChunks(source, sink, spare, spareBytes);
+    }
+    const PumpOutcome outcome = drain(sink);
+
+    // The reader may still be inside the source: wait it out before the
+    // caller closes it.
+    std::unique_lock<std::mutex> lock(mutex_);
+    stop_ = true;
+    changed_.wait(lock, [this] { return !reading_; });
+    source_ = nullptr;
+    busy_ = false;
+    return outcome;
+}
+
+PumpOutcome ReadAheadPipe::drain(IChunkSink& sink)
+{
+    std::size_t index = 0;
+    for (;;) {
+        std::size_t len = 0;
+        {
+            std::unique_lock<std::mutex> lock(mutex_);
+            if (filled_[index] == 0 && !ended_) {
+                ++stats_.sendWaits;
+                changed_.wait(lock, [&] { return filled_[index] != 0 || ended_; });
+            }
+            len = filled_[index];
+            if (len == 0) {
+                return readFailed_ ? PumpOutcome::ReadFailed : PumpOutcome::Ok;
+            }
+        }
+        const bool sent = sink.send(reinterpret_cast<const char*>(buffers_[index]), len);
+        std::lock_guard<std::mutex> lock(mutex_);
+        filled_[index] = 0;
+        changed_.notify_all();
+        if (!sent) {
+            return PumpOutcome::SendFailed;
+        }
+        index ^= 1u;
+    }
+}
+
+bool ReadAheadPipe::serveRead(uint32_t waitMs)
+{
+    std::size_t index = 0;
+    IChunkSource* source = nullptr;
+    {
+        std::unique_lock<std::mutex> lock(mutex_);
+        if (!changed_.wait_for(lock, std::chrono::milliseconds(waitMs), [this] {
+                return source_ != nullptr && !ended_ && !stop_ && filled_[readNext_] == 0;
+            })) {
+            return false;
+        }
+        index = readNext_;
+        source = source_;
+        reading_ = true;
+    }
+    const ChunkRead read = readChunk(*source, buffers_[index], kChunkBytes);
+    std::lock_guard<std::mutex> lock(mutex_);
+    reading_ = false;
+    filled_[index] = read.bytes;
+    ended_ = read.ended;
+    readFailed_ = read.failed;
+    readNext_ = index ^ 1u;
+    changed_.notify_all();
+    return true;
+}
+
+ReadAheadStats ReadAheadPipe::stats() const
+{
+    std::lock_guard<std::mutex> lock(mutex_);
+    return stats_;
+}
+
+}  // namespace api
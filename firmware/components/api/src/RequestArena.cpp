@@ -0,0 +1,107 @@
+// SPDX-FileCopyrightText: 2026 Cryptotomte
+// SPDX-License-Identifier: AGPL-3.0-or-later
+/**
+ * @file RequestArena.cpp
+ * @brief Implementation of the per-request cJSON arena and its hooks.
+ */
+
+#include "api/RequestArena.h"
+
+#include <cstdlib>
+
+#include "cJSON.h"
+
+namespace api {
+
+namespace {
+
+constexpr std::size_t kAlign = alignof(std::max_align_t);
+
+/// The arena of the scope open on this task, if any.
+thread_local RequestArena* tArena = nullptr;
+
+void* arenaMalloc(std::size_t size)
+{
+    if (tArena != nullptr) {
+        if (void* p = tArena->allocate(size)) {
+            return p;
+        }
+        tArena->noteFallback();
+    }
+    return std::malloc(size);
+}
+
+void arenaFree(void* p)
+{
+    // Arena blocks go back all at once, when their scope closes.
+    if (tArena != nullptr && tArena->owns(p)) {
+        return;
+    }
+    std::free(p);
+}
+
+}  // namespace
+
+RequestArena::RequestArena(std::size_t capacity)
+    : base_(static_cast<unsigned char*>(
+          bufferBudgets().allocate(BufferPool::RequestArena, capacity))),
+      capacity_(base_ != nullptr ? capacity : 0)
+{
+}
+
+RequestArena::~RequestArena()
+{
+    bufferBudgets().release(BufferPool::RequestArena, base_, capacity_);
+}
+
+void* RequestArena::allocate(std::size_t size)
+{
+    const std::size_t rounded = (size + kAlign - 1) & ~(kAlign - 1);
+    if (rounded < size || rounded > capacity_ - used_) {
+        return nullptr;
+    }
+    void* p = base_ + used_;
+    used_ += rounded;
+    if (used_ > highWater_) {
+        highWater_ = used_;
+    }
+    return p;
+}
+
+bool RequestArena::owns(const void* p) const
+{
+    const unsigned char* c = static_cast<const unsigned char*>(p);
+    return base_ != nullptr && c >= base_ && c < base_ + capacity_;
+}
+
+void RequestArena::reset()
+{
+    used_ = 0;
+}
+
+ArenaScope::ArenaScope(RequestArena* arena) : arena_(arena), previous_(tArena)
+{
+    if (arena_ != nullptr) {
+        tArena = arena_;
+    }
+}
+
+ArenaScope::~ArenaScope()
+{
+    if (arena_ != nullptr) {
+        tArena = previous_;
+        if (previous_ != arena_) {
+            arena_->reset();
+        }
+    }
+}
+
+void installArenaHooks()
+{
+    cJSON_Hooks hooks = {};
+    hooks.malloc_fn = &arenaMalloc;
+    hooks.free_fn = &arenaFree;
+    cJSON_InitHooks(&hooks);
+}
+
+}  // namespace api
@@ -0,0 +1,70 @@
+// SPDX-FileCopyrightText: 2026 Cryptotomte
+// SPDX-License-Identifier: AGPL-3.0-or-later
+/**
+ * @file ResponseCache.cpp
+ * @brief Implementation of the hot-endpoint body cache.
+ */
+
+#include "api/ResponseCache.h"
+
+namespace api {
+
+void ResponseCache::setMaxAge(Slot slot, uint32_t maxAgeMs)
+{
+    std::lock_guard<StaticMutex> lock(mutex_);
+    entries_[static_cast<std::size_t>(slot)].maxAgeMs = maxAgeMs;
+}
+
+bool ResponseCache::get(Slot slot, uint32_t generation, int64_t nowMs,
+                        std::string& body, std::string& etag) const
+{
+    std::lock_guard<StaticMutex> lock(mutex_);
+    const Entry& e = entries_[static_cast<std::size_t>(slot)];
+    const int64_t age = nowMs - e.builtMs;
+    const bool current =
+        e.valid && e.generation == generation && age >= 0 &&
+        (e.maxAgeMs == 0 || age <= static_cast<int64_t>(e.maxAgeMs));
+    if (!current) {
+        ++misses_;
+        return false;
+    }
+    ++hits_;
+    body = e.body;
+    etag = e.etag;
+    return true;
+}
+
+void ResponseCache::put(Slot slot, uint32_t generation, int64_t nowMs,
+                        const std::string& body, const std::string& etag)
+{
+    if (body.empty()) {
+        return;
+    }
+    std::lock_guard<StaticMutex> lock(mutex_);
+    Entry& e = entries_[static_cast<std::size_t>(slot)];
+    e.valid = true;
+    e.generation = generation;
+    e.builtMs = nowMs;
+    e.body = body;
+    e.etag = etag;
+}
+
+void ResponseCache::invalidate(Slot slot)
+{
+    std::lock_guard<StaticMutex> lock(mutex_);
+    entries_[static_cast<std::size_t>(slot)].valid = false;
+}
+
+uint32_t ResponseCache::hits() const
+{
+    std::lock_guard<StaticMutex> lock(mutex_);
+    return hits_;
+}
+
+uint32_t ResponseCache::misses() const
+{
+    std::lock_guard<StaticMutex> lock(mutex_);
+    return misses_;
+}
+
+}  // namespace api
@@ -0,0 +1,123 @@
+// SPDX-FileCopyrightText: 2026 Cryptotomte
+// SPDX-License-Identifier: AGPL-3.0-or-later
+/**
+ * @file SelfTestRunner.cpp
+ * @brief The concurrent self-test hand-over (see SelfTestRunner.h).
+ *
+ * Slot i carries check i of a run. A slot is the runner's while Idle or
+ * Done, and whoever moved it from Queued to Running owns it until it is
+ * Done again; an abandoned slot goes straight back to Idle when its check
+ * returns, as nobody waits for that result any more.
+ */
+
+#include "api/SelfTestRunner.h"
+
+#include <chrono>
+#include <utility>
+
+namespace api {
+
+std::size_t SelfTestRunner::firstQueued() const
+{
+    for (std::size_t i = 0; i < kMaxChecks; ++i) {
+        if (slots_[i].state == SlotState::Queued) {
+            return i;
+        }
+    }
+    return kMaxChecks;
+}
+
+void SelfTestRunner::runSlot(std::unique_lock<std::mutex>& lock, std::size_t index)
+{
+    Slot& slot = slots_[index];
+    slot.state = SlotState::Running;
+    ISelfTestCheck* check = slot.check;
+    lock.unlock();
+    std::string detail;
+    const bool ok = check->run(detail);
+    lock.lock();
+    if (slot.abandoned) {
+        slot.abandoned = false;
+        slot.state = SlotState::Idle;
+    } else {
+        slot.ok = ok;
+        slot.detail = std::move(detail);
+        slot.state = SlotState::Done;
+    }
+    changed_.notify_all();
+}
+
+SelfTestResultDto SelfTestRunner::run(ISelfTestCheck* const* checks, std::size_t count,
+                                      uint32_t deadlineMs)
+{
+    const auto deadline =
+        std::chrono::steady_clock::now() + std::chrono::milliseconds(deadlineMs);
+    if (count > kMaxChecks) {
+        count = kMaxChecks;
+    }
+    SelfTestResultDto result;
+    result.checks.resize(count);
+
+    std::unique_lock<std::mutex> lock(mutex_);
+    bool started[kMaxChecks] = {};
+    for (std::size_t i = 0; i < count; ++i) {
+        result.checks[i].name = checks[i]->name();
+        Slot& slot = slots_[i];
+        if (slot.state != SlotState::Idle) {
+            // Still with a helper since an earlier run's deadline.
+            result.checks[i].detail = "previous check still running";
+            continue;
+        }
+        slot.check = checks[i];
+        slot.state = SlotState::Queued;
+        started[i] = true;
+    }
+    changed_.notify_all();
+
+    // The first check, and whatever no helper has taken, on this task.
+    for (std::size_t i = firstQueued(); i < kMaxChecks; i = firstQueued()) {
+        runSlot(lock, i);
+    }
+
+    changed_.wait_until(lock, deadline, [&] {
+        for (std::size_t i = 0; i < count; ++i) {
+            if (started[i] && slots_[i].state != SlotState::Done) {
+                return false;
+            }
+        }
+        return true;
+    });
+
+    result.overall = true;
+    for (std::size_t i = 0; i < count; ++i) {
+        SelfTestCheckDto& check = result.checks[i];
+        Slot& slot = slots_[i];
+        if (!started[i]) {
+            result.overall = false;
+            continue;
+        }
+        if (slot.state == SlotState::Done) {
+            check.ok = slot.ok;
+            check.detail = std::move(slot.detail);
+            slot.state = SlotState::Idle;
+        } else {
+            check.detail = "timed out after " + std::to_string(deadlineMs) + " ms";
+            slot.abandoned = true;
+        }
+        result.overall = result.overall && check.ok;
+    }
+    return result;
+}
+
+bool SelfTestRunner::serveCheck(uint32_t waitMs)
+{
+    std::unique_lock<std::mutex> lock(mutex_);
+    if (!changed_.wait_for(lock, std::chrono::milliseconds(waitMs),
+                           [this] { return firstQueued() < kMaxChecks; })) {
+        return false;
+    }
+    runSlot(lock, firstQueued());
+    return true;
+}
+
+}  // namespace api
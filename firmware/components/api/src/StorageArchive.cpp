@@ -0,0 +1,440 @@
+// SPDX-FileCopyrightText: 2026 Cryptotomte
+// SPDX-License-Identifier: AGPL-3.0-or-later
+/**
+ * @file StorageArchive.cpp
+ * @brief The archive stream and its staged restore (see StorageArchive.h).
+ *
+ * ArchiveSource is a small state machine: framing bytes wait in head_,
+ * then the entry's data (left_ bytes, from the open file or the config
+ * string) goes straight into the caller's buffer with its CRC kept
+ * running, then the CRC joins the next framing. ArchiveRestore reads the
+ * same stream with blocking exact reads, since each field must be whole
+ * before the next can be understood.
+ */
+
+#include "api/StorageArchive.h"
+
+#include <algorithm>
+#include <cerrno>
+#include <cstring>
+#include <string_view>
+#include <utility>
+
+#include <dirent.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include "api/Deflate.h"
+
+namespace api {
+
+namespace {
+
+constexpr uint8_t kMagic[4] = {'W', 'S', 'A', '1'};
+constexpr uint8_t kKindFile = 'F';
+constexpr uint8_t kKindConfig = 'C';
+constexpr uint8_t kKindEnd = 'Z';
+
+/// Staging and restore write through blocks of this size.
+constexpr std::size_t kBlockBytes = 4096;
+
+void putU16(std::vector<uint8_t>& out, uint16_t v)
+{
+    out.push_back(static_cast<uint8_t>(v));
+    out.push_back(static_cast<uint8_t>(v >> 8));
+}
+
+void putU32(std::vector<uint8_t>& out, uint32_t v)
+{
+    for (int i = 0; i < 4; ++i) {
+        out.push_back(static_cast<uint8_t>(v >> (8 * i)));
+    }
+}
+
+uint32_t getU32(const uint8_t* p)
+{
+    return static_cast<uint32_t>(p[0]) | (static_cast<uint32_t>(p[1]) << 8) |
+           (static_cast<uint32_t>(p[2]) << 16) | (static_cast<uint32_t>(p[3]) << 24);
+}
+
+bool isDir(const std::string& path)
+{
+    struct stat st;
+    return ::stat(path.c_str(), &st) == 0 && S_ISDIR(st.st_mode);
+}
+
+bool endsWith(const std::string& s, const char* suffix)
+{
+    const std::size_t n = std::strlen(suffix);
+    return s.size() >= n && s.compare(s.size() - n, n, suffix) == 0;
+}
+
+/// Remove @p path and everything under it; true when nothing is left.
+bool removeTree(const std::string& path)
+{
+    if (!isDir(path)) {
+        return std::remove(path.c_str()) == 0 || errno == ENOENT;
+    }
+    if (DIR* dir = ::opendir(path.c_str())) {
+        while (const dirent* entry = ::readdir(dir)) {
+            if (std::strcmp(entry->d_name, ".") != 0 && std::strcmp(entry->d_name, "..") != 0) {
+                removeTree(path + "/" + entry->d_name);
+            }
+        }
+        ::closedir(dir);
+    }
+    return ::rmdir(path.c_str()) == 0;
+}
+
+/// Create every directory of @p path up to (not including) its last
+/// segment.
+bool makeParents(const std::string& path)
+{
+    for (std::size_t slash = path.find('/', 1); slash != std::string::npos;
+         slash = path.find('/', slash + 1)) {
+        const std::string dir = path.substr(0, slash);
+        if (::mkdir(dir.c_str(), 0775) != 0 && errno != EEXIST) {
+            return false;
+        }
+    }
+    return true;
+}
+
+}  // namespace
+
+bool archivePathValid(const std::string& path)
+{
+    if (path.empty() || path.size() > kArchiveMaxPath) {
+        return false;
+    }
+    const std::size_t slash = path.find('/');
+    if (slash == std::string::npos) {
+        return false;  // a file directly in the base
+    }
+    const std::string tree = path.substr(0, slash);
+    if (std::none_of(std::begin(kArchiveTrees), std::end(kArchiveTrees),
+                     [&tree](const char* t) { return tree == t; })) {
+        return false;
+    }
+    std::size_t start = 0;
+    while (start <= path.size()) {
+        std::size_t end = path.find('/', start);
+        if (end == std::string::npos) {
+            end = path.size();
+        }
+        const std::string_view seg(path.data() + start, end - start);
+        if (seg.empty() || seg == "." || seg == "..") {
+            return false;
+        }
+        start = end + 1;
+    }
+    return true;
+}
+
+const char* restoreOutcomeName(RestoreOutcome outcome)
+{
+    switch (outcome) {
+    case RestoreOutcome::Ok:
+        return "ok";
+    case RestoreOutcome::ReceiveFailed:
+        return "receive failed";
+    case RestoreOutcome::BadArchive:
+        return "bad archive";
+    case RestoreOutcome::WriteFailed:
+        return "write failed";
+    }
+    return "unknown";
+}
+
+// -- ArchiveSource ------------------------------------------------------------
+
+ArchiveSource::ArchiveSource(std::string basePath, std::string configJson)
+    : basePath_(std::move(basePath)), config_(std::move(configJson))
+{
+    for (const char* tree : kArchiveTrees) {
+        collect(tree);
+    }
+    // Name order: a metric's chunks go out oldest first, like a query.
+    std::sort(files_.begin(), files_.end(),
+              [](const FileEntry& a, const FileEntry& b) { return a.path < b.path; });
+    head_.assign(std::begin(kMagic), std::end(kMagic));
+}
+
+ArchiveSource::~ArchiveSource()
+{
+    if (file_ != nullptr) {
+        std::fclose(file_);
+    }
+}
+
+void ArchiveSource::collect(const std::string& rel)
+{
+    const std::string full = basePath_ + "/" + rel;
+    DIR* dir = ::opendir(full.c_str());
+    if (dir == nullptr) {
+        return;  // a tree this layout does not use
+    }
+    while (const dirent* entry = ::readdir(dir)) {
+        if (std::strcmp(entry->d_name, ".") == 0 || std::strcmp(entry->d_name, "..") == 0) {
+            continue;
+        }
+        const std::string child = rel + "/" + entry->d_name;
+        struct stat st;
+        if (::stat((basePath_ + "/" + child).c_str(), &st) != 0) {
+            continue;
+        }
+        if (S_ISDIR(st.st_mode)) {
+            collect(child);
+        } else if (!endsWith(child, ".tmp") && child.size() <= kArchiveMaxPath) {
+            // A .tmp is a write the hold interrupted before its rename:
+            // the storage removes it itself, so it has no place in a copy.
+            files_.push_back(FileEntry{child, static_cast<uint32_t>(st.st_size)});
+            fileBytes_ += static_cast<uint64_t>(st.st_size);
+        }
+    }
+    ::closedir(dir);
+}
+
+bool ArchiveSource::nextEntry()
+{
+    head_.clear();
+    headPos_ = 0;
+    if (!configSent_) {
+        configSent_ = true;
+        if (!config_.empty()) {
+            head_.push_back(kKindConfig);
+            putU16(head_, 0);
+            putU32(head_, static_cast<uint32_t>(config_.size()));
+            inline_ = config_.data();
+            left_ = static_cast<uint32_t>(config_.size());
+            crc_ = 0;
+            dataDone_ = false;
+            return true;
+        }
+    }
+    if (next_ < files_.size()) {
+        const FileEntry& entry = files_[next_++];
+        file_ = std::fopen((basePath_ + "/" + entry.path).c_str(), "rb");
+        head_.push_back(kKindFile);
+        putU16(head_, static_cast<uint16_t>(entry.path.size()));
+        head_.insert(head_.end(), entry.path.begin(), entry.path.end());
+        putU32(head_, entry.size);
+        inline_ = nullptr;
+        left_ = entry.size;
+        crc_ = 0;
+        dataDone_ = false;
+        return true;
+    }
+    if (!ended_) {
+        ended_ = true;
+        head_.push_back(kKindEnd);
+        const bool config = !config_.empty();
+        putU32(head_, static_cast<uint32_t>(files_.size() + (config ? 1 : 0)));
+        return true;
+    }
+    return false;
+}
+
+int ArchiveSource::receive(uint8_t* dst, std::size_t len)
+{
+    std::size_t out = 0;
+    while (out < len) {
+        if (headPos_ < head_.size()) {
+            const std::size_t n = std::min(len - out, head_.size() - headPos_);
+            std::memcpy(dst + out, head_.data() + headPos_, n);
+            headPos_ += n;
+            out += n;
+            continue;
+        }
+        if (left_ > 0) {
+            const std::size_t want = std::min<std::size_t>(len - out, left_);
+            std::size_t got = 0;
+            if (inline_ != nullptr) {
+                std::memcpy(dst + out, inline_, want);
+                inline_ += want;
+                got = want;
+            } else if (file_ != nullptr) {
+                got = std::fread(dst + out, 1, want, file_);
+            }
+            if (got == 0) {
+                return -1;  // gone, shrunk or unreadable since the listing
+            }
+            crc_ = crc32Update(crc_, dst + out, got);
+            left_ -= static_cast<uint32_t>(got);
+            out += got;
+            continue;
+        }
+        if (!dataDone_) {
+            if (file_ != nullptr) {
+                std::fclose(file_);
+                file_ = nullptr;
+            }
+            dataDone_ = true;
+            head_.clear();
+            headPos_ = 0;
+            putU32(head_, crc_);
+            continue;
+        }
+        if (!nextEntry()) {
+            break;
+        }
+        if (inline_ == nullptr && file_ == nullptr && left_ > 0) {
+            return -1;  // listed, but no longer opens
+        }
+    }
+    return static_cast<int>(out);
+}
+
+// -- ArchiveRestore -----------------------------------------------------------
+
+ArchiveRestore::ArchiveRestore(std::string basePath)
+    : basePath_(std::move(basePath)), staging_(basePath_ + "/" + kArchiveStagingDir)
+{
+}
+
+bool ArchiveRestore::readExact(IChunkSource& source, uint8_t* dst, std::size_t len)
+{
+    while (len > 0) {
+        const int r = source.receive(dst, len);
+        if (r <= 0) {
+            cutOff_ = true;
+            return false;
+        }
+        dst += r;
+        len -= static_cast<std::size_t>(r);
+    }
+    return true;
+}
+
+RestoreOutcome ArchiveRestore::stageFile(IChunkSource& source, const std::string& rel,
+                                         uint32_t length, uint32_t& crc)
+{
+    const std::string path = staging_ + "/" + rel;
+    if (!makeParents(path)) {
+        return RestoreOutcome::WriteFailed;
+    }
+    FILE* f = std::fopen(path.c_str(), "wb");
+    if (f == nullptr) {
+        return RestoreOutcome::WriteFailed;
+    }
+    crc = 0;
+    RestoreOutcome outcome = RestoreOutcome::Ok;
+    while (length > 0) {
+        const std::size_t n = std::min<std::size_t>(length, block_.size());
+        if (!readExact(source, block_.data(), n)) {
+            outcome = RestoreOutcome::ReceiveFailed;
+            break;
+        }
+        crc = crc32Update(crc, block_.data(), n);
+        if (std::fwrite(block_.data(), 1, n, f) != n) {
+            outcome = RestoreOutcome::WriteFailed;
+            break;
+        }
+        length -= static_cast<uint32_t>(n);
+    }
+    if (outcome == RestoreOutcome::Ok &&
+        (std::fflush(f) != 0 || ::fsync(fileno(f)) != 0)) {
+        outcome = RestoreOutcome::WriteFailed;
+    }
+    if (std::fclose(f) != 0 && outcome == RestoreOutcome::Ok) {
+        outcome = RestoreOutcome::WriteFailed;
+    }
+    return outcome;
+}
+
+bool ArchiveRestore::swapIn()
+{
+    for (const char* tree : kArchiveTrees) {
+        const std::string live = basePath_ + "/" + tree;
+        const std::string staged = staging_ + "/" + tree;
+        if (!removeTree(live)) {
+            return false;
+        }
+        if (isDir(staged) && std::rename(staged.c_str(), live.c_str()) != 0) {
+            return false;
+        }
+    }
+    return removeTree(staging_);
+}
+
+RestoreReport ArchiveRestore::run(IChunkSource& source)
+{
+    RestoreReport report;
+    cutOff_ = false;
+    block_.resize(kBlockBytes);
+    // A staging tree left by a restore a power cut interrupted.
+    removeTree(staging_);
+    if (::mkdir(staging_.c_str(), 0775) != 0) {
+        report.outcome = RestoreOutcome::WriteFailed;
+        return report;
+    }
+    const auto fail = [&](RestoreOutcome outcome) {
+        removeTree(staging_);
+        report.outcome = cutOff_ ? RestoreOutcome::ReceiveFailed : outcome;
+        report.config.clear();
+        return report;
+    };
+
+    uint8_t magic[sizeof(kMagic)];
+    if (!readExact(source, magic, sizeof(magic)) ||
+        std::memcmp(magic, kMagic, sizeof(kMagic)) != 0) {
+        return fail(RestoreOutcome::BadArchive);
+    }
+    uint32_t entries = 0;
+    for (;;) {
+        uint8_t kind = 0;
+        if (!readExact(source, &kind, 1)) {
+            return fail(RestoreOutcome::BadArchive);
+        }
+        uint8_t field[4];
+        if (kind == kKindEnd) {
+            if (!readExact(source, field, 4) || getU32(field) != entries) {
+                return fail(RestoreOutcome::BadArchive);
+            }
+            break;
+        }
+        if ((kind != kKindFile && kind != kKindConfig) || !readExact(source, field, 2)) {
+            return fail(RestoreOutcome::BadArchive);
+        }
+        const std::size_t pathLen = field[0] | (static_cast<std::size_t>(field[1]) << 8);
+        std::string path(pathLen, '\0');
+        if (pathLen > kArchiveMaxPath ||
+            !readExact(source, reinterpret_cast<uint8_t*>(&path[0]), pathLen) ||
+            !readExact(source, field, 4)) {
+            return fail(RestoreOutcome::BadArchive);
+        }
+        const uint32_t length = getU32(field);
+        uint32_t crc = 0;
+        if (kind == kKindConfig) {
+            if (pathLen != 0 || length > kArchiveMaxConfig || !report.config.empty()) {
+                return fail(RestoreOutcome::BadArchive);
+            }
+            report.config.resize(length);
+            if (!readExact(source, reinterpret_cast<uint8_t*>(&report.config[0]), length)) {
+                return fail(RestoreOutcome::BadArchive);
+            }
+            crc = crc32Update(0, report.config.data(), length);
+        } else {
+            if (!archivePathValid(path)) {
+                return fail(RestoreOutcome::BadArchive);
+            }
+            const RestoreOutcome staged = stageFile(source, path, length, crc);
+            if (staged != RestoreOutcome::Ok) {
+                return fail(staged);
+            }
+            ++report.files;
+            report.bytes += length;
+        }
+        if (!readExact(source, field, 4) || getU32(field) != crc) {
+            return fail(RestoreOutcome::BadArchive);
+        }
+        ++entries;
+    }
+    if (!swapIn()) {
+        return fail(RestoreOutcome::WriteFailed);
+    }
+    report.outcome = RestoreOutcome::Ok;
+    return report;
+}
+
+}  // namespace api
@@ -0,0 +1,89 @@
+// SPDX-FileCopyrightText: 2026 Cryptotomte
+// SPDX-License-Identifier: AGPL-3.0-or-later
+/**
+ * @file SupportBundle.cpp
+ * @brief The support bundle's section framing (see SupportBundle.h).
+ */
+
+#include "api/SupportBundle.h"
+
+#include <cinttypes>
+#include <cstdio>
+#include <cstring>
+
+namespace api {
+
+SupportBundleWriter::SupportBundleWriter(IChunkSink& out) : out_(out)
+{
+    put(kSupportBundleMagic, sizeof(kSupportBundleMagic) - 1);
+}
+
+bool SupportBundleWriter::put(const char* data, std::size_t len)
+{
+    if (!ok_ || len == 0) {
+        return ok_;
+    }
+    ok_ = out_.send(data, len);
+    bytes_ += ok_ ? len : 0;
+    return ok_;
+}
+
+bool SupportBundleWriter::closeSection()
+{
+    if (open_ && lineOpen_) {
+        put("\n", 1);
+    }
+    open_ = false;
+    lineOpen_ = false;
+    return ok_;
+}
+
+bool SupportBundleWriter::section(const char* name, const char* contentType)
+{
+    closeSection();
+    put("=== ", 4);
+    put(name, std::strlen(name));
+    put(" ", 1);
+    put(contentType, std::strlen(contentType));
+    put("\n", 1);
+    ++sections_;
+    open_ = true;
+    return ok_;
+}
+
+bool SupportBundleWriter::section(const char* name, const char* contentType,
+                                  const std::string& body)
+{
+    section(name, contentType);
+    return send(body.data(), body.size());
+}
+
+bool SupportBundleWriter::absent(const char* name, const char* why)
+{
+    closeSection();
+    put("=== ", 4);
+    put(name, std::strlen(name));
+    put(" absent: ", 9);
+    put(why, std::strlen(why));
+    put("\n", 1);
+    ++sections_;
+    return ok_;
+}
+
+bool SupportBundleWriter::send(const char* data, std::size_t len)
+{
+    if (len > 0 && put(data, len)) {
+        lineOpen_ = data[len - 1] != '\n';
+    }
+    return ok_;
+}
+
+bool SupportBundleWriter::finish()
+{
+    closeSection();
+    char line[32];
+    const int n = std::snprintf(line, sizeof(line), "=== end %" PRIu32 "\n", sections_);
+    return put(line, static_cast<std::size_t>(n));
+}
+
+}  // namespace api
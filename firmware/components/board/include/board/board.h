@@ -49,6 +49,12 @@
 #define BOARD_HAS_RESERVOIR_PUMP        1
 #define BOARD_PIN_RESERVOIR_PUMP        27
 
+/* Watering zones: one bed, the plant pump on the primary soil probe (see
+ * kBoardZones below). The supply feeds one pump at a time. */
+#define BOARD_ZONE_TABLE \
+    {"plant", BOARD_PIN_MAIN_PUMP, 0, 0.0f, 0.0f, 0}
+#define BOARD_ZONE_PUMP_BUDGET          1
+
 /* Reservoir level sensors (XKC-Y26), low/high mark on 32/33 with internal
  * pull-ups (parity: src/main.cpp:37-38, 231-233; docs/parity-checklist.md
  * line 95).
@@ -113,6 +119,12 @@
 #define BOARD_PIN_MAIN_PUMP             26  // TODO(SYNC1): final rev2 pin map frozen at hardware sync 1
 #define BOARD_HAS_RESERVOIR_PUMP        0
 
+/* Watering zones: one bed, the plant pump on the primary soil probe (see
+ * kBoardZones below). */
+#define BOARD_ZONE_TABLE \
+    {"plant", BOARD_PIN_MAIN_PUMP, 0, 0.0f, 0.0f, 0}
+#define BOARD_ZONE_PUMP_BUDGET          1
+
 /* Reservoir level sensors (XKC-Y26), low/high mark with internal pull-ups
  * (redundant-but-harmless on top of the external 10 kΩ — rev2 design notes
  * §6.3, research.md R4).
@@ -132,7 +144,9 @@
  *   0x40  INA226 pump monitor (A0 = A1 = GND)
  *   0x41  reserved — solar-input INA226 footprint, DNP
  *   0x76 / 0x77  BME280
- * The ALERT pin is not connected — no Mask/Enable/Alert register use. */
+ * The ALERT pin is not routed to the ESP32. The power sampling task polls
+ * the Mask/Enable conversion-ready flag instead, unless
+ * CONFIG_WS_INA226_ALERT_GPIO names a GPIO wired to ALERT. */
 #define BOARD_HAS_INA226                1
 #define BOARD_INA226_ADDR               0x40
 
@@ -225,4 +239,70 @@
 #error "Board sanity: BOARD_INA226_ADDR is defined but BOARD_HAS_INA226 is 0"
 #endif
 
+/* ------------------------------------------------------------------------
+ * Watering zones (C++ only): the board's BOARD_ZONE_TABLE as a constexpr
+ * table. Each zone is one bed with its own pump or valve gate (active high,
+ * forced off at boot like the plant pump), the soil probe it waters to (an
+ * index into CONFIG_WS_SOIL_SENSOR_ADDRESSES) and, optionally, its own
+ * moisture thresholds and burst (0 = the configured values). Zone 0 is the
+ * plant pump. A multi-bed board lists one entry per bed, e.g.
+ *
+ *   #define BOARD_ZONE_TABLE \
+ *       {"plant", BOARD_PIN_MAIN_PUMP, 0, 0.0f, 0.0f, 0}, \
+ *       {"bed2", 13, 1, 35.0f, 60.0f, 30}, ...
+ *
+ * and BOARD_ZONE_PUMP_BUDGET says how many zone pumps the supply feeds at
+ * once; the watering task never runs more automatic bursts than that.
+ * ------------------------------------------------------------------------ */
+#ifdef __cplusplus
+#include <cstddef>
+#include <cstdint>
+
+struct BoardZone {
+    const char* name;        ///< pump name in the API, event log and console
+    int pumpPin;             ///< MOSFET gate, active high
+    uint8_t soilProbe;       ///< index into CONFIG_WS_SOIL_SENSOR_ADDRESSES
+    float thresholdLowPct;   ///< 0 = the configured low threshold
+    float thresholdHighPct;  ///< 0 = the configured high threshold
+    uint32_t burstS;         ///< 0 = the configured burst duration
+};
+
+/* Internal linkage: the board-contract tests compile both boards' tables
+ * into one host binary. */
+static constexpr BoardZone kBoardZones[] = {BOARD_ZONE_TABLE};
+static constexpr std::size_t kBoardZoneCount = sizeof(kBoardZones) / sizeof(kBoardZones[0]);
+
+/* Zone sanity: zone 0 drives the plant pump from the primary probe, no two
+ * zones share a gate or a probe, and no zone gate sits on a level-sensor or reservoir pin. */
+static constexpr bool boardZonesSane()
+{
+    if (kBoardZones[0].pumpPin != BOARD_PIN_MAIN_PUMP || kBoardZones[0].soilProbe != 0) {
+        return false;
+    }
+    for (std::size_t i = 0; i < kBoardZoneCount; ++i) {
+        const BoardZone& zone = kBoardZones[i];
+        if (zone.pumpPin == BOARD_PIN_LEVEL_LOW || zone.pumpPin == BOARD_PIN_LEVEL_HIGH) {
+            return false;
+        }
+#if BOARD_HAS_RESERVOIR_PUMP
+        if (zone.pumpPin == BOARD_PIN_RESERVOIR_PUMP) {
+            return false;
+        }
+#endif
+        for (std::size_t j = i + 1; j < kBoardZoneCount; ++j) {
+            if (zone.pumpPin == kBoardZones[j].pumpPin ||
+                zone.soilProbe == kBoardZones[j].soilProbe) {
+                return false;
+            }
+        }
+    }
+    return true;
+}
+static_assert(boardZonesSane(),
+              "Board sanity: zone 0 must be the plant pump on probe 0; zone pins and probes "
+              "must be distinct and clear of the level and reservoir pins");
+static_assert(BOARD_ZONE_PUMP_BUDGET >= 1,
+              "Board sanity: the supply must feed at least one zone pump");
+#endif /* __cplusplus */
+
 #endif /* WATERINGSYSTEM_BOARD_BOARD_H */
@@ -0,0 +1,163 @@
+// SPDX-FileCopyrightText: 2026 Cryptotomte
+// SPDX-License-Identifier: AGPL-3.0-or-later
+/**
+ * @file DecisionTrace.h
+ * @brief Fixed ring of WateringController decision records (header-only).
+ *
+ * Every tick() of a traced controller leaves one binary DecisionRecord:
+ * when, the moisture and thresholds it saw, the soak pause left, the gate
+ * that decided the tick and the action taken. Writing one is a copy into a
+ * preallocated slot — no allocation and no formatting — so the trace stays
+ * on in production; names are looked up by the readers (the `trace`
+ * console command and GET /api/v1/control/trace) only.
+ *
+ * SINGLE WRITER: every zone ticks on the watering task, which is the only
+ * caller of record(). Each slot is a Seqlock, so readers on other tasks
+ * copy records without a lock and never hold the loop; a record the writer
+ * is storing or has since overwritten is skipped, not waited for.
+ */
+
+#ifndef WATERINGSYSTEM_CONTROL_DECISIONTRACE_H
+#define WATERINGSYSTEM_CONTROL_DECISIONTRACE_H
+
+#include <array>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+
+#include "interfaces/Seqlock.h"
+
+/// The check that decided a tick, in tick() order.
+enum class DecisionGate : uint8_t {
+    Manual,       ///< operator run active: automatic path bypassed
+    Disabled,     ///< automatic watering off
+    Unavailable,  ///< fail-safe: no successful read ever
+    Invalid,      ///< fail-safe: moisture out of range
+    Stale,        ///< fail-safe: no valid read within kStalenessMs
+    Flatline,     ///< fail-safe: the feed flags the moisture as stuck
+    Schedule,     ///< outside the watering windows
+    NoFreshRead,  ///< no new sample this tick: wait for one
+    Running,      ///< burst running below the high threshold
+    High,         ///< high threshold reached
+    NotDry,       ///< idle above the low threshold
+    Soak,         ///< dry, but the soak pause runs
+    Budget,       ///< dry, but no pump-budget slot is free
+    Dry,          ///< dry and clear: a burst was due
+};
+
+/// What the tick did to the pump.
+enum class DecisionAction : uint8_t {
+    None,
+    StartBurst,
+    StartFailed,   ///< runFor() refused the burst
+    StopHigh,
+    StopFailsafe,
+    StopSchedule,
+};
+
+/// Lower-case name of @p gate, for readers.
+inline const char* decisionGateName(DecisionGate gate)
+{
+    switch (gate) {
+    case DecisionGate::Manual:      return "manual";
+    case DecisionGate::Disabled:    return "disabled";
+    case DecisionGate::Unavailable: return "unavailable";
+    case DecisionGate::Invalid:     return "invalid";
+    case DecisionGate::Stale:       return "stale";
+    case DecisionGate::Flatline:    return "flatline";
+    case DecisionGate::Schedule:    return "schedule";
+    case DecisionGate::NoFreshRead: return "no-fresh-read";
+    case DecisionGate::Running:     return "running";
+    case DecisionGate::High:        return "high";
+    case DecisionGate::NotDry:      return "not-dry";
+    case DecisionGate::Soak:        return "soak";
+    case DecisionGate::Budget:      return "budget";
+    case DecisionGate::Dry:         return "dry";
+    }
+    return "?";
+}
+
+/// Lower-case name of @p action, for readers.
+inline const char* decisionActionName(DecisionAction action)
+{
+    switch (action) {
+    case DecisionAction::None:         return "none";
+    case DecisionAction::StartBurst:   return "start";
+    case DecisionAction::StartFailed:  return "start-failed";
+    case DecisionAction::StopHigh:     return "stop-high";
+    case DecisionAction::StopFailsafe: return "stop-failsafe";
+    case DecisionAction::StopSchedule: return "stop-schedule";
+    }
+    return "?";
+}
+
+/// One tick of one zone (40 bytes).
+struct DecisionRecord {
+    static constexpr uint8_t kFresh = 0x01;       ///< decided on a new sample
+    static constexpr uint8_t kPumpOn = 0x02;      ///< pump running after the tick
+    static constexpr uint8_t kBurstEnded = 0x04;  ///< burst self-stopped before it
+
+    uint32_t sequence = 0;     ///< 1-based; set by DecisionTrace::record()
+    uint32_t epoch = 0;        ///< wall clock, 0 while unset
+    int64_t atMs = 0;          ///< monotonic
+    float moisture = 0.0f;     ///< as read (valid or not; see gate)
+    float low = 0.0f;          ///< thresholds in effect
+    float high = 0.0f;
+    uint32_t soakLeftMs = 0;   ///< soak pause left after the tick
+    uint16_t burstS = 0;       ///< burst requested (StartBurst/StartFailed)
+    uint8_t zone = 0;
+    DecisionGate gate = DecisionGate::NoFreshRead;
+    DecisionAction action = DecisionAction::None;
+    uint8_t flags = 0;
+};
+
+class DecisionTrace {
+public:
+    static constexpr std::size_t kCapacity = 128;
+
+    DecisionTrace() = default;
+    DecisionTrace(const DecisionTrace&) = delete;
+    DecisionTrace& operator=(const DecisionTrace&) = delete;
+
+    /// Append @p rec (its sequence is assigned here). Single writer.
+    void record(const DecisionRecord& rec)
+    {
+        DecisionRecord stamped = rec;
+        stamped.sequence = written_.load(std::memory_order_relaxed) + 1;
+        slots_[(stamped.sequence - 1) % kCapacity].store(stamped);
+        written_.store(stamped.sequence, std::memory_order_release);
+    }
+
+    /// Records written since boot (the newest record's sequence).
+    uint32_t written() const { return written_.load(std::memory_order_acquire); }
+
+    /**
+     * @brief Copy up to @p max records with a sequence above @p after into
+     * @p out, oldest first; records already overwritten are skipped.
+     *
+     * Pass the last sequence read as @p after to continue from there.
+     * @return records copied
+     */
+    std::size_t read(DecisionRecord* out, std::size_t max, uint32_t after = 0) const
+    {
+        const uint32_t newest = written();
+        uint32_t seq = after + 1;
+        if (newest > kCapacity && seq <= newest - kCapacity) {
+            seq = newest - kCapacity + 1;
+        }
+        std::size_t n = 0;
+        for (; seq <= newest && n < max; ++seq) {
+            DecisionRecord rec;
+            if (slots_[(seq - 1) % kCapacity].tryLoad(rec) && rec.sequence == seq) {
+                out[n++] = rec;
+            }
+        }
+        return n;
+    }
+
+private:
+    std::array<Seqlock<DecisionRecord>, kCapacity> slots_;
+    std::atomic<uint32_t> written_{0};
+};
+
+#endif /* WATERINGSYSTEM_CONTROL_DECISIONTRACE_H */
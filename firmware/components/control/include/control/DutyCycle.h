@@ -0,0 +1,140 @@
+// SPDX-FileCopyrightText: 2026 Cryptotomte
+// SPDX-License-Identifier: AGPL-3.0-or-later
+/**
+ * @file DutyCycle.h
+ * @brief Wake bookkeeping and sleep planning of a deep-sleep battery node.
+ *
+ * A battery node (CONFIG_WS_DEEP_SLEEP_NODE, main/sleep_node.cpp) does not
+ * run the 10 Hz loop. Each wake reads the sensors, runs one
+ * WateringController decision (and the burst it starts, to its end), logs
+ * and goes back to deep sleep. What must survive the sleep lives in one
+ * DutyCycleState in RTC_NOINIT memory:
+ *
+ *  - the controller's soak origin, data-log cadence and log-policy points
+ *    (WateringControllerState, as ages);
+ *  - the wake counters, and how many wakes since the last Wi-Fi sync;
+ *  - the RTC timer at the seal, which keeps counting through deep sleep,
+ *    so the next wake knows how long it slept.
+ *
+ * The wall clock needs nothing here: the system time is kept by the RTC
+ * timer through deep sleep, and SNTP resets it on a sync wake.
+ *
+ * SYNC: Wi-Fi comes up only every syncEvery-th wake (and on the first,
+ * cold one) to step the clock and drain the MQTT replay in one go. A
+ * failed sync is retried on the next wake, not N wakes later.
+ *
+ * SLEEP: the period, cut short by the end of a running soak pause or the
+ * opening of a watering window (the decision is due then), never below
+ * minSleepMs.
+ *
+ * A block that fails its CRC, or comes from a different layout, is a
+ * cold start: counters from zero, no controller state. Pure C++,
+ * host-tested.
+ */
+
+#ifndef WATERINGSYSTEM_CONTROL_DUTYCYCLE_H
+#define WATERINGSYSTEM_CONTROL_DUTYCYCLE_H
+
+#include <cstdint>
+#include <type_traits>
+
+#include "control/WateringController.h"
+
+/// Counters across wakes (since the last cold start).
+struct DutyCycleCounters {
+    uint32_t wakes;
+    uint32_t syncs;          ///< sync wakes that reached the network
+    uint32_t syncFailures;
+    uint32_t bursts;         ///< wakes that ran a burst
+    uint64_t awakeMs;        ///< time awake, summed at each seal
+};
+
+/// The RTC_NOINIT block. Trivial, like the other retained blocks.
+struct DutyCycleState {
+    static constexpr uint32_t kMagic = 0x43445357u;  ///< "WSDC"
+    static constexpr uint16_t kVersion = 1;
+
+    uint32_t magic;
+    uint16_t version;
+    uint16_t wakesSinceSync;  ///< wakes since the last successful sync, this one included
+    int64_t sealedRtcMs;      ///< RTC timer at seal()
+    DutyCycleCounters counters;
+    WateringControllerState controller;
+    uint32_t crc;             ///< CRC-32 of everything above
+    uint32_t pad;
+};
+static_assert(std::is_trivial<DutyCycleState>::value,
+              "RTC_NOINIT memory is never constructed");
+
+struct DutyCycleSettings {
+    uint32_t periodMs = 15 * 60 * 1000;  ///< sleep between decisions
+    uint32_t minSleepMs = 60 * 1000;     ///< floor of a shortened sleep
+    uint16_t syncEvery = 12;             ///< wakes per Wi-Fi sync (1 = every wake)
+};
+
+class DutyCycle {
+public:
+    /// Over the retained @p block; the caller keeps it alive.
+    DutyCycle(DutyCycleState& block, const DutyCycleSettings& settings)
+        : block_(block), settings_(settings)
+    {
+    }
+
+    DutyCycle(const DutyCycle&) = delete;
+    DutyCycle& operator=(const DutyCycle&) = delete;
+
+    /// True when @p block is intact and of this layout.
+    static bool valid(const DutyCycleState& block);
+
+    /**
+     * @brief Start a wake at RTC time @p rtcNowMs: take the block if
+     * valid (else reset it), count the wake.
+     * @return false on a cold start (no controller state to restore)
+     */
+    bool resume(int64_t rtcNowMs);
+
+    /// How long the node slept before this wake; 0 on a cold start or
+    /// when the RTC timer went back (a power cycle).
+    int64_t sleptMs() const { return sleptMs_; }
+
+    /// The controller state to restore; nullptr on a cold start.
+    const WateringControllerState* controllerState() const
+    {
+        return warm_ ? &block_.controller : nullptr;
+    }
+
+    /// Whether this wake brings Wi-Fi up (cold start, or syncEvery reached).
+    bool syncDue() const;
+
+    /// The sync of this wake reached the network (@p ok) or gave up.
+    void noteSync(bool ok);
+
+    /// This wake ran a burst.
+    void noteBurst() { ++block_.counters.bursts; }
+
+    /**
+     * @brief Milliseconds to sleep, on the controller's clock at @p now:
+     * the period, or less when @p soakEndsAtMs or @p windowOpensAtMs
+     * (0 = none, as the controller reports them) come first; at least
+     * minSleepMs.
+     */
+    uint32_t planSleepMs(int64_t now, int64_t soakEndsAtMs, int64_t windowOpensAtMs) const;
+
+    /**
+     * @brief Store @p controller and the counters, charge @p awakeMs, and
+     * stamp the block at RTC time @p rtcNowMs. Last thing before sleep.
+     */
+    void seal(const WateringControllerState& controller, int64_t rtcNowMs, uint32_t awakeMs);
+
+    const DutyCycleCounters& counters() const { return block_.counters; }
+
+private:
+    static uint32_t crcOf(const DutyCycleState& block);
+
+    DutyCycleState& block_;
+    DutyCycleSettings settings_;
+    bool warm_ = false;
+    int64_t sleptMs_ = 0;
+};
+
+#endif /* WATERINGSYSTEM_CONTROL_DUTYCYCLE_H */
@@ -0,0 +1,69 @@
+// SPDX-FileCopyrightText: 2026 Cryptotomte
+// SPDX-License-Identifier: AGPL-3.0-or-later
+/**
+ * @file FillTimeEstimator.h
+ * @brief Pure online estimate of the reservoir's fill times, and the
+ *        adaptive fill timeout derived from it (header-only).
+ *
+ * An automatic fill starts with both marks dry and runs in two legs: up to
+ * the low mark turning wet, then on to the high mark. Each completed fill
+ * updates an exponentially weighted mean of both legs. Once kMinFills are
+ * on record, a leg running past kBudgetFactor times its mean (at least
+ * kMinBudgetMs) means the inflow has collapsed — a dry source or a clogged
+ * intake — and ReservoirController aborts it long before the pump's 300 s
+ * cap. O(1) per fill, no allocation.
+ */
+
+#ifndef WATERINGSYSTEM_CONTROL_FILLTIMEESTIMATOR_H
+#define WATERINGSYSTEM_CONTROL_FILLTIMEESTIMATOR_H
+
+#include <cstdint>
+
+class FillTimeEstimator {
+public:
+    static constexpr uint32_t kMinFills = 2;        ///< before budgets apply
+    static constexpr float kWeight = 0.3f;          ///< newest fill's share
+    static constexpr float kBudgetFactor = 1.5f;
+    static constexpr int64_t kMinBudgetMs = 20'000; ///< debounce + tick slack
+
+    /// Record a fill that reached the high mark: @p toLowMs from its start
+    /// to the low mark, @p betweenMarksMs from there to the high mark.
+    void fillCompleted(int64_t toLowMs, int64_t betweenMarksMs)
+    {
+        if (fills_ == 0) {
+            toLowMs_ = static_cast<float>(toLowMs);
+            betweenMs_ = static_cast<float>(betweenMarksMs);
+        } else {
+            toLowMs_ += kWeight * (static_cast<float>(toLowMs) - toLowMs_);
+            betweenMs_ += kWeight * (static_cast<float>(betweenMarksMs) - betweenMs_);
+        }
+        ++fills_;
+    }
+
+    bool learnt() const { return fills_ >= kMinFills; }
+    uint32_t fills() const { return fills_; }
+    int64_t expectedToLowMs() const { return static_cast<int64_t>(toLowMs_); }
+    int64_t expectedBetweenMarksMs() const { return static_cast<int64_t>(betweenMs_); }
+
+    /// Longest the leg to the low mark may take; 0 until learnt().
+    int64_t budgetToLowMs() const { return budget(toLowMs_); }
+
+    /// Longest the leg between the marks may take; 0 until learnt().
+    int64_t budgetBetweenMarksMs() const { return budget(betweenMs_); }
+
+private:
+    int64_t budget(float expectedMs) const
+    {
+        if (!learnt()) {
+            return 0;
+        }
+        const auto ms = static_cast<int64_t>(kBudgetFactor * expectedMs);
+        return ms > kMinBudgetMs ? ms : kMinBudgetMs;
+    }
+
+    uint32_t fills_ = 0;
+    float toLowMs_ = 0.0f;
+    float betweenMs_ = 0.0f;
+};
+
+#endif /* WATERINGSYSTEM_CONTROL_FILLTIMEESTIMATOR_H */
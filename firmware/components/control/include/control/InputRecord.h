@@ -0,0 +1,234 @@
+// SPDX-FileCopyrightText: 2026 Cryptotomte
+// SPDX-License-Identifier: AGPL-3.0-or-later
+/**
+ * @file InputRecord.h
+ * @brief Binary format of the watering input recording, and its reader
+ *        (host+target).
+ *
+ * WHY THIS EXISTS: a node that watered (or did not) when nobody expected
+ * it left only the decision trace's newest 128 ticks and the event log.
+ * The recording keeps what the controllers were given instead — every
+ * soil sample they decided on, the level marks, the decision config, the
+ * clocks at each tick — so test_apps/replay can run the same
+ * WateringController and ReservoirController code over it, on fake clocks,
+ * and show each decision again. Written by InputRecorder on the watering
+ * task; served by GET /api/v1/recording.
+ *
+ * BLOCKS: the recording is a run of blocks, each a 12-byte header — the
+ * magic "WSR1", the block sequence (uint32, 1 for the first block after a
+ * boot, +1 per block), the payload length (uint16) and zero (uint16) —
+ * then the payload. Little-endian throughout. A block holds whole ticks
+ * and opens with a keyframe of the state the ticks build on, so a reader
+ * can start at any block; a missing block (rolled out of the RAM ring, or
+ * lost in a reset) costs the ticks in it and nothing more.
+ *
+ * RECORDS: a tag byte, the kind in the high nibble and an argument in the
+ * low one, then the kind's body:
+ *
+ *   Base   0x0-  int64 monotonic ms, uint32 wall-clock epoch (0 = unset):
+ *                the time base of the block's ticks. First in a block.
+ *   Boot   0x1-  the node started recording: controller state is fresh.
+ *   Tick   0x2-  LEB128 ms since the previous tick (or the Base). The
+ *                records up to the next Tick are this tick's.
+ *   Clock  0x3-  uint32 epoch at this tick: the wall clock is not where
+ *                the last Base/Clock and the elapsed ms put it (a sync).
+ *   Soil   0x4z  zone z: flags (kSoil*), float moisture unless
+ *                kSoilSameMoisture, LEB128 ms from the read to the tick.
+ *                A sample the zone's controller took this tick; with
+ *                kSoilKeyframe, the zone's last sample restated.
+ *   Levels 0x5b  b = kLevel* bits of the two reservoir marks.
+ *   Pump   0x6p  p = pump id (0..6 zone, 7 reservoir) | kPumpRunning:
+ *                the pump's state after this tick's decisions changed.
+ *   Config 0x7i  i = ConfigItem: float.
+ *   Setup  0x8f  f = kSetup* flags: uint8 pump budget, uint8 length, the
+ *                watering schedule text (CONFIG_WS_WATERING_SCHEDULE).
+ *   Zone   0x9z  zone z: float low, float high, uint16 burst s
+ *                (ZoneSettings, 0 = the configured value).
+ *
+ * Levels, Pump and Config records are written when the value changes and
+ * in every keyframe. The wall clock between Clock records is the last one
+ * plus the elapsed whole seconds, so a replay's clock may be up to a second
+ * from the node's.
+ */
+
+#ifndef WATERINGSYSTEM_CONTROL_INPUTRECORD_H
+#define WATERINGSYSTEM_CONTROL_INPUTRECORD_H
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+#include "control/WateringController.h"
+#include "interfaces/ISoilFeed.h"
+
+namespace input_record {
+
+/// First four bytes of every block ("WSR1": version 1).
+constexpr char kMagic[4] = {'W', 'S', 'R', '1'};
+constexpr std::size_t kHeaderBytes = 12;
+/// A whole block, header included.
+constexpr std::size_t kBlockBytes = 2048;
+constexpr std::size_t kPayloadBytes = kBlockBytes - kHeaderBytes;
+
+/// Zones a recording can carry (the Soil/Zone argument and pump ids 0..6).
+constexpr std::size_t kMaxZones = 7;
+constexpr uint8_t kReservoirPump = 7;
+constexpr std::size_t kPumps = 8;
+
+enum Kind : uint8_t {
+    kBase = 0x0,
+    kBoot = 0x1,
+    kTick = 0x2,
+    kClock = 0x3,
+    kSoil = 0x4,
+    kLevels = 0x5,
+    kPump = 0x6,
+    kConfig = 0x7,
+    kSetup = 0x8,
+    kZone = 0x9,
+};
+
+// Soil flags.
+constexpr uint8_t kSoilReadOk = 0x01;
+constexpr uint8_t kSoilAvailable = 0x02;
+constexpr uint8_t kSoilSuspect = 0x04;
+constexpr uint8_t kSoilGroupShift = 3;  ///< SoilReadGroup in bits 3-4
+constexpr uint8_t kSoilSameMoisture = 0x20;
+constexpr uint8_t kSoilKeyframe = 0x40;
+
+// Levels bits.
+constexpr uint8_t kLevelLowValid = 0x1;
+constexpr uint8_t kLevelLowWet = 0x2;
+constexpr uint8_t kLevelHighValid = 0x4;
+constexpr uint8_t kLevelHighWet = 0x8;
+
+constexpr uint8_t kPumpRunning = 0x8;
+
+// Setup flags.
+constexpr uint8_t kSetupPredictive = 0x1;  ///< zones size bursts (MoistureResponse)
+
+/// The IConfigStore items the controllers decide on.
+enum class ConfigItem : uint8_t {
+    ThresholdLow,
+    ThresholdHigh,
+    WateringDurationS,
+    MinWateringIntervalS,
+    WateringEnabled,
+    SensorReadIntervalMs,
+};
+constexpr std::size_t kConfigItems = 6;
+
+}  // namespace input_record
+
+/// The decision config at one tick.
+struct RecordedConfig {
+    std::array<float, input_record::kConfigItems> values{};
+
+    float get(input_record::ConfigItem item) const
+    {
+        return values[static_cast<std::size_t>(item)];
+    }
+    void set(input_record::ConfigItem item, float value)
+    {
+        values[static_cast<std::size_t>(item)] = value;
+    }
+
+    /// The items read from @p config.
+    static RecordedConfig from(IConfigStore& config);
+};
+
+/// The two reservoir marks as the reservoir controller reads them.
+struct RecordedLevels {
+    bool lowValid = false;
+    bool lowWet = false;
+    bool highValid = false;
+    bool highWet = false;
+
+    uint8_t bits() const;
+    static RecordedLevels fromBits(uint8_t bits);
+    bool operator==(const RecordedLevels& o) const { return bits() == o.bits(); }
+    bool operator!=(const RecordedLevels& o) const { return !(*this == o); }
+};
+
+/// How the node's controllers were put together (board and build).
+struct RecordedSetup {
+    bool predictive = false;  ///< CONFIG_WS_PREDICTIVE_BURST
+    uint8_t pumpBudget = 0;   ///< BOARD_ZONE_PUMP_BUDGET
+    std::string schedule;     ///< CONFIG_WS_WATERING_SCHEDULE
+    std::size_t zoneCount = 0;
+    std::array<ZoneSettings, input_record::kMaxZones> zones{};
+};
+
+/// One tick as the reader rebuilt it.
+struct RecordedTick {
+    int64_t atMs = 0;
+    uint32_t epoch = 0;
+    bool boot = false;    ///< the node started recording at this tick
+    bool resync = false;  ///< blocks before it are missing: state from a keyframe
+    uint32_t block = 0;   ///< sequence of the block holding it
+};
+
+/**
+ * @brief Walks a recording tick by tick, keeping the state each tick saw.
+ *
+ * Feed it the blocks in order (a GET /api/v1/recording body is that);
+ * next() returns the following tick once all its records are read, with
+ * state() as the tick's inputs and its recorded pump states. A block
+ * whose sequence does not follow the last one, or that opens with a Boot,
+ * sets resync/boot on its first tick.
+ */
+class InputRecordReader {
+public:
+    /// Read from @p data (@p len bytes); not copied, must outlive the reader.
+    InputRecordReader(const uint8_t* data, std::size_t len) : data_(data), len_(len) {}
+
+    /// The next tick; false at the end or on a malformed block (see error()).
+    bool next(RecordedTick& tick);
+
+    /// Non-null after next() stopped on a malformed recording.
+    const char* error() const { return error_; }
+
+    /// The inputs of the last tick next() returned.
+    const RecordedSetup& setup() const { return setup_; }
+    const RecordedConfig& config() const { return config_; }
+    const RecordedLevels& levels() const { return levels_; }
+    /// A Levels record was read: the node has a reservoir.
+    bool hasReservoir() const { return levelsSeen_; }
+    /// Zone @p zone's latest sample; sequence 0 until it has one.
+    const TimedSoilSnapshot& soil(std::size_t zone) const { return soil_[zone]; }
+    /// The recorded state of pump @p id after the tick.
+    bool pumpRunning(std::size_t id) const { return pumps_[id]; }
+
+    /// Blocks read so far.
+    std::size_t blocks() const { return blocks_; }
+
+private:
+    bool openBlock();
+    bool readRecord(bool& tickEnds);
+    bool fail(const char* what);
+
+    const uint8_t* data_;
+    std::size_t len_;
+    std::size_t pos_ = 0;
+    std::size_t blockEnd_ = 0;
+    std::size_t blocks_ = 0;
+    uint32_t sequence_ = 0;
+    bool pendingBoot_ = false;
+    bool pendingResync_ = false;
+    bool haveTick_ = false;
+    const char* error_ = nullptr;
+
+    int64_t tickMs_ = 0;
+    int64_t clockMs_ = 0;
+    uint32_t clockEpoch_ = 0;
+
+    RecordedSetup setup_;
+    RecordedConfig config_;
+    RecordedLevels levels_;
+    bool levelsSeen_ = false;
+    std::array<TimedSoilSnapshot, input_record::kMaxZones> soil_{};
+    std::array<bool, input_record::kPumps> pumps_{};
+};
+
+#endif /* WATERINGSYSTEM_CONTROL_INPUTRECORD_H */
@@ -0,0 +1,146 @@
+// SPDX-FileCopyrightText: 2026 Cryptotomte
+// SPDX-License-Identifier: AGPL-3.0-or-later
+/**
+ * @file InputRecorder.h
+ * @brief Records what the watering controllers are given, tick by tick,
+ *        into a RAM ring of blocks (host+target).
+ *
+ * The format and its reader are in InputRecord.h. The watering task is
+ * the one writer: beginTick() before the zones tick, the zones' soil
+ * samples through RecordedSoilFeed as each controller takes them, pump()
+ * after the ticks. Unchanged inputs cost nothing but the tick itself
+ * (three bytes at a 5 s cadence), a new sample 3 to 7 bytes, so a 2 KiB
+ * block holds from a quarter of an hour (one zone, a moved sample every
+ * tick) to an hour (nothing new).
+ *
+ * READERS (the flash writer, the API) copy whole blocks with copyBlock()
+ * under the ring's lock. The writer appends past the length readers see
+ * without it and takes it only to publish a finished tick or to reuse the
+ * oldest slot, so a reader holds the watering task for one 2 KiB copy at
+ * most. The block being written is readable too, up to its last finished
+ * tick.
+ *
+ * The blocks are BufferPool::InputRecorder's (interfaces/BufferBudget.h);
+ * boot wiring sizes the ring by its grant, so a board with PSRAM keeps
+ * kPsramBlocks.
+ */
+
+#ifndef WATERINGSYSTEM_CONTROL_INPUTRECORDER_H
+#define WATERINGSYSTEM_CONTROL_INPUTRECORDER_H
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+
+#include "control/InputRecord.h"
+#include "interfaces/BufferBudget.h"
+#include "interfaces/ISoilFeed.h"
+#include "interfaces/StaticMutex.h"
+
+class InputRecorder {
+public:
+    /// Room a block keeps for one more tick; a tick never spans blocks.
+    static constexpr std::size_t kTickReserve = 160;
+
+    /// Blocks held on a board with PSRAM; internal RAM keeps the
+    /// configured count.
+    static constexpr std::size_t kPsramBlocks = 32;
+
+    /// Keep the newest @p blocks blocks (at least 2), allocated here once.
+    explicit InputRecorder(std::size_t blocks);
+    ~InputRecorder();
+
+    InputRecorder(const InputRecorder&) = delete;
+    InputRecorder& operator=(const InputRecorder&) = delete;
+
+    /// How the controllers are built (restated in every block). Boot
+    /// wiring, before the first tick.
+    void setSetup(const RecordedSetup& setup);
+
+    /// Open the tick at @p atMs (the controllers' clock) with the wall
+    /// clock, the decision config and, with a reservoir, the level marks.
+    void beginTick(int64_t atMs, uint32_t epoch, const RecordedConfig& config,
+                   const RecordedLevels* levels);
+
+    /// Zone @p zone's controller took @p sample this tick (recorded when new).
+    void soil(std::size_t zone, const TimedSoilSnapshot& sample);
+
+    /// Pump @p id's state after this tick's decisions (recorded on a change).
+    void pump(uint8_t id, bool running);
+
+    /// Sequence of the block being written; 0 before the first tick.
+    uint32_t newest() const;
+
+    /// Sequence of the oldest block still held.
+    uint32_t oldest() const;
+
+    /**
+     * @brief Copy block @p sequence, header included, into @p out
+     * (input_record::kBlockBytes).
+     * @return bytes copied, 0 when the block is not held
+     */
+    std::size_t copyBlock(uint32_t sequence, uint8_t* out) const;
+
+    std::size_t capacity() const { return blocks_; }
+
+private:
+    uint8_t* slot(uint32_t sequence) const
+    {
+        return ram_ + ((sequence - 1) % blocks_) * input_record::kPayloadBytes;
+    }
+    void openBlock(int64_t atMs, uint32_t epoch);
+    void commit();
+    void writeKeyframe();
+    void append(const uint8_t* bytes, std::size_t n);
+    void appendSoil(std::size_t zone, uint8_t flags, const TimedSoilSnapshot& sample,
+                    bool withMoisture);
+
+    const std::size_t blocks_;
+    uint8_t* ram_;                      ///< BufferPool::InputRecorder
+    std::unique_ptr<uint16_t[]> used_;  ///< published payload bytes per slot
+    mutable StaticMutex mutex_;
+    uint32_t open_ = 0;                 ///< guarded by mutex_ (written by the writer)
+
+    // Writer state (watering task only).
+    std::size_t writing_ = 0;           ///< payload bytes in the open block
+    bool booted_ = false;
+    bool inTick_ = false;
+    int64_t tickMs_ = 0;
+    int64_t clockMs_ = 0;
+    uint32_t clockEpoch_ = 0;
+    RecordedSetup setup_;
+    RecordedConfig config_;
+    bool configKnown_ = false;
+    RecordedLevels levels_;
+    bool levelsKnown_ = false;
+    std::array<bool, input_record::kPumps> pumps_{};
+    uint8_t pumpsSeen_ = 0;
+    std::array<TimedSoilSnapshot, input_record::kMaxZones> soil_{};
+};
+
+/**
+ * @brief ISoilFeed decorator that records each new sample a zone's
+ * controller takes. Set it as the controller's feed in place of @p feed.
+ */
+class RecordedSoilFeed : public ISoilFeed {
+public:
+    RecordedSoilFeed(const ISoilFeed& feed, InputRecorder& recorder, uint8_t zone)
+        : feed_(feed), recorder_(recorder), zone_(zone)
+    {
+    }
+
+    TimedSoilSnapshot latest() const override
+    {
+        const TimedSoilSnapshot sample = feed_.latest();
+        recorder_.soil(zone_, sample);
+        return sample;
+    }
+
+private:
+    const ISoilFeed& feed_;
+    InputRecorder& recorder_;
+    const uint8_t zone_;
+};
+
+#endif /* WATERINGSYSTEM_CONTROL_INPUTRECORDER_H */
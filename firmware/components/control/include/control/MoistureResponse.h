@@ -0,0 +1,201 @@
+// SPDX-FileCopyrightText: 2026 Cryptotomte
+// SPDX-License-Identifier: AGPL-3.0-or-later
+/**
+ * @file MoistureResponse.h
+ * @brief Pure online estimate of the bed's moisture response, for sizing
+ *        automatic bursts (header-only).
+ *
+ * A fixed burst overshoots on a bed that soaks up fast (sand) and needs
+ * several burst + soak cycles on one that does not (clay). Two rates are
+ * learnt from the controller's valid soil samples, each by a least-squares
+ * fit through the origin with exponential forgetting (O(1) per sample, no
+ * history kept):
+ *
+ *   gain     — moisture rise per pump-second, %/s: one observation per
+ *              burst, from the moisture before it to the first sample after
+ *              its soak (the rise has settled), plus the dry-down over the
+ *              same interval;
+ *   dry-down — moisture drop per second while idle, %/s: one observation per
+ *              idle window of at least kMinDryWindowMs.
+ *
+ * burstSeconds() then picks the run that brings the bed to the target at the
+ * end of the soak, clamped to the pump's cap. Until kMinBursts bursts are on
+ * record it returns the configured burst. Like PollCadence it only decides;
+ * WateringController feeds it and runs the pump.
+ */
+
+#ifndef WATERINGSYSTEM_CONTROL_MOISTURERESPONSE_H
+#define WATERINGSYSTEM_CONTROL_MOISTURERESPONSE_H
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+
+class MoistureResponse {
+public:
+    /// Weight of the previous estimate per new burst / dry-down observation.
+    static constexpr float kGainForgetting = 0.8f;
+    static constexpr float kDryForgetting = 0.95f;
+
+    /// Bursts on record before burstSeconds() leaves the configured burst.
+    static constexpr uint32_t kMinBursts = 2;
+
+    /// A learnt gain below this (%/s) is treated as not learnt (a probe
+    /// outside the wetted zone, or noise).
+    static constexpr float kMinGainPctPerS = 0.005f;
+
+    /// Shortest idle window fitted for dry-down: long enough that the drift
+    /// outweighs the probe's noise.
+    static constexpr int64_t kMinDryWindowMs = 10 * 60 * 1000;
+
+    /// A burst started at @p atMs with the bed at @p moisture.
+    void burstStarted(int64_t atMs, float moisture)
+    {
+        phase_ = Phase::Burst;
+        burstStartMs_ = atMs;
+        baseline_ = moisture;
+        refValid_ = false;
+    }
+
+    /// The burst stopped at @p atMs; its rise is read on the first sample
+    /// @p settleMs later (the soak pause).
+    void burstEnded(int64_t atMs, int64_t settleMs)
+    {
+        if (phase_ != Phase::Burst) {
+            return;
+        }
+        pumpS_ = static_cast<float>(atMs - burstStartMs_) / 1000.0f;
+        phase_ = pumpS_ > 0.0f ? Phase::Settling : Phase::Idle;
+        settleUntilMs_ = atMs + settleMs;
+    }
+
+    /// Water the estimator did not size (a manual run): drop the pending
+    /// observation and fit nothing before @p untilMs.
+    void disturbed(int64_t untilMs)
+    {
+        phase_ = Phase::Idle;
+        refValid_ = false;
+        holdoffUntilMs_ = std::max(holdoffUntilMs_, untilMs);
+    }
+
+    /**
+     * @brief Record one valid, in-range sample.
+     *
+     * @param pumpRunning Whether the pump runs now; such a sample fits
+     *        nothing and restarts the dry-down window.
+     */
+    void sample(int64_t atMs, float moisture, bool pumpRunning)
+    {
+        if (pumpRunning || atMs < holdoffUntilMs_ || phase_ == Phase::Burst) {
+            refValid_ = false;
+            return;
+        }
+        if (phase_ == Phase::Settling) {
+            if (atMs < settleUntilMs_) {
+                return;
+            }
+            const float elapsedS = static_cast<float>(atMs - burstStartMs_) / 1000.0f;
+            const float rise = moisture - baseline_ + dryRatePctPerS() * elapsedS;
+            gainSxx_ = kGainForgetting * gainSxx_ + pumpS_ * pumpS_;
+            gainSxy_ = kGainForgetting * gainSxy_ + pumpS_ * rise;
+            if (bursts_ < kMinBursts) {
+                ++bursts_;
+            }
+            phase_ = Phase::Idle;
+            setReference(atMs, moisture);
+            return;
+        }
+        if (!refValid_) {
+            setReference(atMs, moisture);
+            return;
+        }
+        const int64_t windowMs = atMs - refMs_;
+        if (windowMs < kMinDryWindowMs) {
+            return;
+        }
+        // A rise while idle (rain, water from elsewhere) is no dry-down
+        // observation; it only moves the window on.
+        const float drop = refMoisture_ - moisture;
+        if (drop >= 0.0f) {
+            const float windowS = static_cast<float>(windowMs) / 1000.0f;
+            drySxx_ = kDryForgetting * drySxx_ + windowS * windowS;
+            drySxy_ = kDryForgetting * drySxy_ + windowS * drop;
+        }
+        setReference(atMs, moisture);
+    }
+
+    /// Whether enough bursts are on record, with a plausible gain.
+    bool learnt() const
+    {
+        return bursts_ >= kMinBursts && gainPctPerS() >= kMinGainPctPerS;
+    }
+
+    /// Learnt moisture rise per pump-second, % (0 before the first burst).
+    float gainPctPerS() const { return gainSxx_ > 0.0f ? gainSxy_ / gainSxx_ : 0.0f; }
+
+    /// Learnt moisture drop per idle second, % (0 before the first window).
+    float dryRatePctPerS() const
+    {
+        return drySxx_ > 0.0f ? std::max(0.0f, drySxy_ / drySxx_) : 0.0f;
+    }
+
+    /**
+     * @brief Burst that takes the bed from @p moisture to @p target by the
+     * end of the following @p settleMs soak, in [1, @p maxS] seconds.
+     *
+     * @p fallbackS (clamped alike) until learnt(). A gain that does not
+     * outrun the dry-down asks for @p maxS.
+     */
+    int burstSeconds(float moisture, float target, int fallbackS, int maxS,
+                     int64_t settleMs) const
+    {
+        if (!learnt()) {
+            return std::clamp(fallbackS, 1, maxS);
+        }
+        const float dry = dryRatePctPerS();
+        const float net = gainPctPerS() - dry;
+        if (net <= 0.0f) {
+            return maxS;
+        }
+        const float deficit =
+            target - moisture + dry * static_cast<float>(settleMs) / 1000.0f;
+        const float seconds = std::ceil(deficit / net);
+        if (!(seconds < static_cast<float>(maxS))) {
+            return maxS;
+        }
+        return std::max(1, static_cast<int>(seconds));
+    }
+
+private:
+    enum class Phase {
+        Idle,      ///< fitting dry-down
+        Burst,     ///< pump running for a sized burst
+        Settling,  ///< burst over, waiting out the soak for its rise
+    };
+
+    void setReference(int64_t atMs, float moisture)
+    {
+        refValid_ = true;
+        refMs_ = atMs;
+        refMoisture_ = moisture;
+    }
+
+    Phase phase_ = Phase::Idle;
+    int64_t burstStartMs_ = 0;
+    float baseline_ = 0.0f;
+    float pumpS_ = 0.0f;
+    int64_t settleUntilMs_ = 0;
+    int64_t holdoffUntilMs_ = 0;
+
+    bool refValid_ = false;  ///< dry-down window origin
+    int64_t refMs_ = 0;
+    float refMoisture_ = 0.0f;
+
+    float gainSxx_ = 0.0f;
+    float gainSxy_ = 0.0f;
+    uint32_t bursts_ = 0;
+    float drySxx_ = 0.0f;
+    float drySxy_ = 0.0f;
+};
+
+#endif /* WATERINGSYSTEM_CONTROL_MOISTURERESPONSE_H */
@@ -0,0 +1,51 @@
+// SPDX-FileCopyrightText: 2026 Cryptotomte
+// SPDX-License-Identifier: AGPL-3.0-or-later
+/**
+ * @file PumpBudget.h
+ * @brief Pure count of the zone pumps the water supply can feed at once
+ *        (header-only).
+ *
+ * Shared by the zone controllers of one WateringZones: an automatic burst
+ * takes a slot when it starts and returns it when it ends, and a zone that
+ * finds no slot free waits for a later tick. Manual runs are an operator
+ * override and take no slot. Single-writer like the controllers (the
+ * watering task), so no lock.
+ */
+
+#ifndef WATERINGSYSTEM_CONTROL_PUMPBUDGET_H
+#define WATERINGSYSTEM_CONTROL_PUMPBUDGET_H
+
+#include <cstdint>
+
+class PumpBudget {
+public:
+    /// @p capacity pumps at once (at least one).
+    explicit PumpBudget(uint32_t capacity) : capacity_(capacity < 1 ? 1 : capacity) {}
+
+    /// Take a slot; false when all are in use.
+    bool tryAcquire()
+    {
+        if (inUse_ >= capacity_) {
+            return false;
+        }
+        ++inUse_;
+        return true;
+    }
+
+    /// Return a slot taken by tryAcquire().
+    void release()
+    {
+        if (inUse_ > 0) {
+            --inUse_;
+        }
+    }
+
+    uint32_t capacity() const { return capacity_; }
+    uint32_t inUse() const { return inUse_; }
+
+private:
+    uint32_t capacity_;
+    uint32_t inUse_ = 0;
+};
+
+#endif /* WATERINGSYSTEM_CONTROL_PUMPBUDGET_H */
@@ -0,0 +1,132 @@
+// SPDX-FileCopyrightText: 2026 Cryptotomte
+// SPDX-License-Identifier: AGPL-3.0-or-later
+/**
+ * @file PumpUsage.h
+ * @brief Per-pump runtime and start counts in hourly and daily buckets,
+ *        kept up to date at every pump stop.
+ *
+ * WHY THIS EXISTS: a pump's DTO carries the current run and the lifetime
+ * total only, so "runtime per day this week" meant scanning pump events.
+ * poll() (SystemObserver's task, woken by every pump switch) watches each
+ * pump's running edge; a stop adds the run to the hour and the day it STARTED in
+ * — one O(1) bucket update each — and appends one record to the history
+ * metric `pump_<name>` (epoch = run start, value = run seconds). Storage
+ * rollups over that metric then give starts (count) and runtime (sum) for
+ * any window past the RAM rings. A pump with a flow meter
+ * (IWaterPump::getLastRunVolume()) adds the run's volume under
+ * `pump_<name>_ml` and its mean flow under `pump_<name>_ml_min`, in the
+ * same storeSensorReadings() batch.
+ *
+ * BUCKETS: kHours hourly and kDays daily slots per pump, UTC, indexed by
+ * hour (day) number modulo the ring size; a slot whose start is not the
+ * one asked for is empty. report() copies a fixed-size window, so a read
+ * costs the same whatever the history holds.
+ *
+ * RESTORE: the rings start empty at boot. The first report() after the
+ * wall clock is set folds the stored runs older than the first run this
+ * boot could time (read outside the lock, merged under it), so the rings
+ * then cover earlier boots too. A run that started before the clock was
+ * set has no bucket; it is counted as untimed and not stored.
+ *
+ * THREADS: poll() on one task, report() on any; a StaticMutex guards the
+ * rings and is never held across a storage read. poll() never allocates;
+ * the one-off restore does (the stored runs of kDays).
+ */
+
+#ifndef WATERINGSYSTEM_CONTROL_PUMPUSAGE_H
+#define WATERINGSYSTEM_CONTROL_PUMPUSAGE_H
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <mutex>
+#include <string>
+#include <string_view>
+
+#include "interfaces/IDataStorage.h"
+#include "interfaces/IWallClock.h"
+#include "interfaces/IWaterPump.h"
+#include "interfaces/StaticMutex.h"
+
+/// Runtime and starts of one pump over one hour or one day.
+struct PumpUsageBucket {
+    uint32_t start = 0;   ///< epoch of the bucket's first second (UTC)
+    uint32_t runMs = 0;   ///< runtime of the runs that started in it
+    uint32_t starts = 0;  ///< runs that started in it
+};
+
+class PumpUsage {
+public:
+    static constexpr std::size_t kHours = 48;
+    static constexpr std::size_t kDays = 14;
+    /// Plant, reservoir and the zone pumps.
+    static constexpr std::size_t kMaxPumps = 8;
+
+    /// One pump's recent usage, oldest bucket first; empty while the wall
+    /// clock is not set.
+    struct Report {
+        bool timed = false;  ///< false: clock not set, no buckets
+        std::array<PumpUsageBucket, kHours> hours{};
+        std::array<PumpUsageBucket, kDays> days{};
+        uint32_t untimedRuns = 0;  ///< runs this boot before the clock was set
+    };
+
+    PumpUsage(IDataStorage& storage, const IWallClock& clock)
+        : storage_(storage), clock_(clock)
+    {
+    }
+
+    PumpUsage(const PumpUsage&) = delete;
+    PumpUsage& operator=(const PumpUsage&) = delete;
+
+    /// Watch @p pump under @p name (history metric "pump_<name>"). Boot
+    /// wiring only; false once kMaxPumps are in.
+    bool addPump(const char* name, const IWaterPump& pump);
+
+    /// Sample every pump once; a stop edge records the run. One task only.
+    void poll();
+
+    /// Fill @p out for the pump called @p name; false for an unknown name.
+    bool report(std::string_view name, Report& out);
+
+    /// History metric of @p name's runs.
+    static std::string metricFor(std::string_view name);
+
+    /// Suffixes of a metered pump's volume (ml) and mean flow (ml/min).
+    static constexpr const char* kVolumeSuffix = "_ml";
+    static constexpr const char* kFlowSuffix = "_ml_min";
+
+private:
+    struct Pump {
+        const char* name = nullptr;
+        const IWaterPump* pump = nullptr;
+        std::string metric;
+        /// A stop's records: the runtime, then volume and flow if metered.
+        /// Named once in addPump(), so a stop never builds a string.
+        std::array<SensorReading, 3> batch{};
+        bool running = false;
+        int64_t startAccumulatedMs = 0;
+        WallTime startedAt;
+        std::array<PumpUsageBucket, kHours> hours{};
+        std::array<PumpUsageBucket, kDays> days{};
+        uint32_t untimedRuns = 0;
+    };
+
+    /// Add a run to its hour and day slot (caller holds mutex_).
+    static void addRun(Pump& pump, uint32_t startEpoch, uint32_t runMs);
+
+    /// Fold the stored runs that predate this boot's first timed run.
+    void restore();
+
+    IDataStorage& storage_;
+    const IWallClock& clock_;
+    std::array<Pump, kMaxPumps> pumps_{};
+    std::size_t count_ = 0;
+
+    mutable StaticMutex mutex_;  ///< guards the rings and the restore state
+    uint32_t timedSince_ = 0;    ///< first epoch poll() saw the clock set
+    bool restoring_ = false;
+    bool restored_ = false;
+};
+
+#endif /* WATERINGSYSTEM_CONTROL_PUMPUSAGE_H */
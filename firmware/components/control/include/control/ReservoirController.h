@@ -23,6 +23,14 @@
  * watchdog-registered task). On-target US3 drives the shared level sensors and
  * pump through the Locked* wrappers; the pure US2 logic drives the injected
  * interfaces directly.
+ *
+ * Static dispatch: the controller is a template over its level-sensor and
+ * pump types. ReservoirController is the interface instantiation (host
+ * tests, explicitly instantiated in ReservoirController.cpp); with
+ * CONFIG_WS_STATIC_DISPATCH app_main wires BasicReservoirController over the
+ * final LevelSensorBank::Mark / LockedWaterPump, so each call on the watering
+ * task is a direct, inlinable call into the mark or decorator instead of a
+ * vtable jump.
  */
 
 #ifndef WATERINGSYSTEM_CONTROL_RESERVOIRCONTROLLER_H
@@ -30,10 +38,15 @@
 
 #include <cstdint>
 
+#include "control/FillTimeEstimator.h"
 #include "events/EventLogger.h"
+#include "interfaces/IDataStorage.h"
+#include "interfaces/ILevelObserver.h"
 #include "interfaces/ILevelSensor.h"
 #include "interfaces/ITimeProvider.h"
+#include "interfaces/IWallClock.h"
 #include "interfaces/IWaterPump.h"
+#include "interfaces/TickLatency.h"
 
 /**
  * @brief Reservoir auto-fill with running safety and a post-abort cooldown.
@@ -52,8 +65,17 @@
  *     high-wet stop does NOT arm the cooldown; a manual fill bypasses it.
  *  4. The feature gate forces the pump OFF and skips all logic when the
  *     reservoir feature is disabled / absent on the board (FR-013).
+ *  5. With a FillTimeEstimator that has learnt the fill, an automatic fill
+ *     whose leg to the low mark or on to the high mark overruns its budget
+ *     is stopped as a fail-safe ("reservoir-fill-stalled") and arms the
+ *     same cooldown as a max-runtime abort.
+ *
+ * Registered as the HIGH mark's ILevelObserver, the running safety of
+ * invariant 2 also fires from the level path itself: the fill pump stops
+ * in the sensor update that reports the mark wet, not at the next tick().
  */
-class ReservoirController {
+template <typename LevelSensor, typename Pump>
+class BasicReservoirController : public ILevelObserver {
 public:
     /// Cooldown after a max-runtime abort before another AUTOMATIC fill may
     /// start (FR-012a). Documented constant, tunable; a manual fill bypasses
@@ -69,6 +91,10 @@ public:
     /// duration + the 300 s cap come from the pump").
     static constexpr int kReservoirFillDurationS = 300;
 
+    /// Metric the time between the marks of each completed automatic fill
+    /// is logged under (setFillLog()), in seconds.
+    static constexpr const char* kFillTimeMetric = "reservoir_fill_s";
+
     /**
      * @brief Construct over injected collaborators (references; must outlive).
      *
@@ -76,9 +102,9 @@ public:
      * in the constructor and tick() simply takes no action while a mark is
      * invalid (FR-012/FR-015).
      */
-    ReservoirController(ILevelSensor& lowMark, ILevelSensor& highMark,
-                        IWaterPump& fillPump, ITimeProvider& clock,
-                        EventLogger& events)
+    BasicReservoirController(LevelSensor& lowMark, LevelSensor& highMark,
+                             Pump& fillPump, ITimeProvider& clock,
+                             EventLogger& events)
         : lowMark_(lowMark),
           highMark_(highMark),
           fillPump_(fillPump),
@@ -87,8 +113,8 @@ public:
     {
     }
 
-    ReservoirController(const ReservoirController&) = delete;
-    ReservoirController& operator=(const ReservoirController&) = delete;
+    BasicReservoirController(const BasicReservoirController&) = delete;
+    BasicReservoirController& operator=(const BasicReservoirController&) = delete;
 
     /**
      * @brief One reservoir evaluation. Non-blocking; call at a fixed cadence.
@@ -121,6 +147,45 @@ public:
     /// Stop the fill pump (any mode).
     void stop();
 
+    /**
+     * @brief Time automatic fills with @p estimator and abort a fill that
+     * overruns what it has learnt (invariant 5). Boot wiring only.
+     *
+     * A fill is learnt when it reaches the high mark after the low mark
+     * turned wet; its legs are timed at tick() resolution. Until the
+     * estimator has learnt, only the 300 s cap bounds a fill.
+     */
+    void setFillEstimator(FillTimeEstimator& estimator) { estimator_ = &estimator; }
+
+    /**
+     * @brief Log each learnt fill's time between the marks to @p storage as
+     * kFillTimeMetric, stamped by @p wallClock once it is set. Boot wiring
+     * only; needs setFillEstimator().
+     */
+    void setFillLog(IDataStorage& storage, IWallClock& wallClock)
+    {
+        storage_ = &storage;
+        wallClock_ = &wallClock;
+    }
+
+    /**
+     * @brief Time the fill-time log and the event writes of each tick() as
+     * those phases of @p latency's current tick (the rest is the
+     * decision; the level marks are cached reads). Boot wiring only.
+     */
+    void setTickLatency(TickLatency& latency) { latency_ = &latency; }
+
+    /**
+     * @brief High-mark hook (ILevelObserver): a mark turning wet stops a
+     * running fill at once.
+     *
+     * Runs on the level sensor's task, not the controller's: it touches
+     * only the fill pump (shared through its LockedWaterPump on target),
+     * never the marks or the controller's own state. tick()'s running
+     * safety stays in place behind it.
+     */
+    void onWaterPresentChanged(bool waterPresent) override;
+
 private:
     /// Arm the post-abort cooldown when the fill pump self-stopped at the hard
     /// max-runtime cap during this tick's update() — a running->stopped edge
@@ -131,9 +196,16 @@ private:
     /// Evaluate the level truth table (auto mode, pump not running).
     void evaluateAuto(int64_t now);
 
-    ILevelSensor& lowMark_;
-    ILevelSensor& highMark_;
-    IWaterPump& fillPump_;
+    /// Time the running automatic fill's legs and stop it past its budget.
+    void superviseFill(int64_t now);
+
+    /// The automatic fill stopped at @p now: learn it if it reached the
+    /// high mark through the low one.
+    void endFill(int64_t now);
+
+    LevelSensor& lowMark_;
+    LevelSensor& highMark_;
+    Pump& fillPump_;
     ITimeProvider& clock_;
     EventLogger& events_;  ///< US3 event-logging seam (unused in US2)
 
@@ -141,6 +213,202 @@ private:
     /// now - lastAbortMs_ < kReservoirRefillCooldownMs, an automatic fill is
     /// suppressed even when the water reads low (FR-012a).
     int64_t lastAbortMs_ = 0;
+
+    /// Fill timing (nullptr = the 300 s cap only) and its optional log.
+    FillTimeEstimator* estimator_ = nullptr;
+    IDataStorage* storage_ = nullptr;
+    IWallClock* wallClock_ = nullptr;
+
+    /// True from an automatic fill's start until the tick that sees it
+    /// stopped; fillStartMs_ and lowWetAtMs_ (0 = not yet) time its legs.
+    bool fillActive_ = false;
+    int64_t fillStartMs_ = 0;
+    int64_t lowWetAtMs_ = 0;
+
+    /// Tick phase timing (nullptr = not timed).
+    TickLatency* latency_ = nullptr;
 };
 
+// -- Implementation (a template: defined here, pure as above) --------------
+
+template <typename LevelSensor, typename Pump>
+void BasicReservoirController<LevelSensor, Pump>::tick(bool enabled, bool autoLevelControl)
+{
+    // Snapshot the running state BEFORE update() so a max-runtime abort that
+    // happens inside update() this tick is observable as a running->stopped
+    // edge (armCooldownOnAbortEdge below).
+    const bool wasRunning = fillPump_.isRunning();
+    const int64_t now = clock_.nowMs();
+
+    // Actuator layer first: enforce the hard 300 s max-fill cap (self-stop).
+    fillPump_.update();
+
+    // Arm the post-abort cooldown on a max-runtime abort edge. This runs before
+    // the high-wet stop below, so a normal Commanded stop never arms it.
+    armCooldownOnAbortEdge(wasRunning, now);
+
+    // Feature gate (FR-013): reservoir disabled / board lacks the pump -> force
+    // the pump OFF and skip ALL reservoir logic.
+    if (!enabled) {
+        fillPump_.stop();
+        fillActive_ = false;
+        return;
+    }
+
+    // An automatic fill stopped since the last tick (high-mark observer,
+    // cap, operator stop): learn it if it completed.
+    if (fillActive_ && !fillPump_.isRunning()) {
+        endFill(now);
+    }
+
+    // Running safety (manual + auto): the high mark reading wet stops the fill
+    // immediately, however it was started. While a fill is in progress (or was
+    // just stopped this tick) the truth table is never evaluated, so nothing
+    // re-starts on the same tick.
+    if (fillPump_.isRunning()) {
+        if (highMark_.isValid() && highMark_.isWaterPresent()) {
+            fillPump_.stop();
+            if (fillActive_) {
+                endFill(now);
+            }
+        } else if (fillActive_) {
+            superviseFill(now);
+        }
+        return;
+    }
+
+    // Automatic level control only (manual mode leaves the reservoir to the
+    // operator via startManualFill()).
+    if (!autoLevelControl) {
+        return;
+    }
+    evaluateAuto(now);
+}
+
+template <typename LevelSensor, typename Pump>
+bool BasicReservoirController<LevelSensor, Pump>::startManualFill(int durationS)
+{
+    // Refuse a manual fill when the reservoir is already full (high mark wet).
+    if (highMark_.isValid() && highMark_.isWaterPresent()) {
+        return false;
+    }
+    // Bypasses the post-abort cooldown; the pump's runFor() enforces the
+    // 1..300 s bound (no silent clamping) and the 300 s cap while it runs.
+    return fillPump_.runFor(durationS);
+}
+
+template <typename LevelSensor, typename Pump>
+void BasicReservoirController<LevelSensor, Pump>::stop()
+{
+    fillPump_.stop();
+}
+
+template <typename LevelSensor, typename Pump>
+void BasicReservoirController<LevelSensor, Pump>::onWaterPresentChanged(bool waterPresent)
+{
+    if (waterPresent && fillPump_.isRunning()) {
+        fillPump_.stop();
+    }
+}
+
+template <typename LevelSensor, typename Pump>
+void BasicReservoirController<LevelSensor, Pump>::armCooldownOnAbortEdge(bool wasRunning, int64_t now)
+{
+    if (wasRunning && !fillPump_.isRunning() &&
+        fillPump_.getLastStopReason() == StopReason::MaxRuntimeForced) {
+        lastAbortMs_ = now;
+    }
+}
+
+template <typename LevelSensor, typename Pump>
+void BasicReservoirController<LevelSensor, Pump>::evaluateAuto(int64_t now)
+{
+    // An invalid mark is NEVER "water absent" (FR-012): take no action while
+    // either mark is not-yet-valid/invalid.
+    if (!lowMark_.isValid() || !highMark_.isValid()) {
+        return;
+    }
+
+    const bool lowWet = lowMark_.isWaterPresent();
+    const bool highWet = highMark_.isWaterPresent();
+
+    if (highWet) {
+        // wet/wet = full -> ensure stopped (a no-op here: the pump is not
+        // running, running safety already handled any in-flight fill).
+        // dry/wet = physically implausible -> no action.
+        if (lowWet) {
+            fillPump_.stop();
+        }
+        return;
+    }
+
+    // High mark dry from here on.
+    if (lowWet) {
+        // wet/dry = sufficient water -> no action.
+        return;
+    }
+
+    // dry/dry = low water -> start a fill, unless the post-abort cooldown is
+    // still active (FR-012a) — do not re-slam the pump after a max-runtime
+    // abort while the water still reads low.
+    if (lastAbortMs_ != 0 &&
+        (now - lastAbortMs_) < kReservoirRefillCooldownMs) {
+        return;
+    }
+    if (fillPump_.runFor(kReservoirFillDurationS)) {
+        fillActive_ = true;
+        fillStartMs_ = now;
+        lowWetAtMs_ = 0;
+    }
+}
+
+template <typename LevelSensor, typename Pump>
+void BasicReservoirController<LevelSensor, Pump>::superviseFill(int64_t now)
+{
+    if (lowWetAtMs_ == 0 && lowMark_.isValid() && lowMark_.isWaterPresent()) {
+        lowWetAtMs_ = now;
+    }
+    if (estimator_ == nullptr) {
+        return;
+    }
+    // Each leg against its own budget: a source that dries up mid-fill is
+    // caught in the leg it happens in.
+    const bool toLow = lowWetAtMs_ == 0;
+    const int64_t budget =
+        toLow ? estimator_->budgetToLowMs() : estimator_->budgetBetweenMarksMs();
+    const int64_t legMs = now - (toLow ? fillStartMs_ : lowWetAtMs_);
+    if (budget != 0 && legMs > budget) {
+        fillPump_.stop();
+        fillActive_ = false;
+        lastAbortMs_ = now;  // same cooldown as a max-runtime abort
+        TickPhaseScope event(latency_, TickPhase::Events);
+        events_.logFailsafe("reservoir-fill-stalled");
+    }
+}
+
+template <typename LevelSensor, typename Pump>
+void BasicReservoirController<LevelSensor, Pump>::endFill(int64_t now)
+{
+    fillActive_ = false;
+    const bool reachedHigh = highMark_.isValid() && highMark_.isWaterPresent();
+    if (estimator_ == nullptr || !reachedHigh || lowWetAtMs_ == 0) {
+        return;
+    }
+    estimator_->fillCompleted(lowWetAtMs_ - fillStartMs_, now - lowWetAtMs_);
+    if (storage_ == nullptr) {
+        return;
+    }
+    const WallTime wall = wallClock_->now();
+    if (wall.set) {
+        TickPhaseScope logging(latency_, TickPhase::Logging);
+        storage_->storeSensorReading(kFillTimeMetric, wall.epoch,
+                                     static_cast<float>(now - lowWetAtMs_) / 1000.0f);
+    }
+}
+
+/// The interface instantiation: host tests and the virtual wiring.
+using ReservoirController = BasicReservoirController<ILevelSensor, IWaterPump>;
+
+extern template class BasicReservoirController<ILevelSensor, IWaterPump>;
+
 #endif /* WATERINGSYSTEM_CONTROL_RESERVOIRCONTROLLER_H */
@@ -21,32 +21,101 @@
  * LockedSoilSensor snapshot; the pure logic drives the injected sensors directly.
  *
  * Concurrency: the controller is unsynchronized and single-writer (its own
- * watchdog-registered task). tick() drives one blocking read() (controller-as-
- * reader) and then consumes one non-blocking snapshot() for the availability +
- * values it decides on — no second bus probe; on-target the sensor is a
- * LockedSoilSensor so that snapshot is copied under a single lock.
+ * watchdog-registered task). Without a soil feed, tick() drives one blocking
+ * read() (controller-as-reader) and then consumes one non-blocking snapshot()
+ * for the availability + values it decides on — no second bus probe; on-target
+ * the sensor is a LockedSoilSensor so that snapshot is copied under a single
+ * lock. With a soil feed (setSoilFeed(), the on-target wiring) tick() never
+ * touches the bus: it takes the feed's latest timestamped snapshot; with
+ * setEnvAcquired() the data log likewise takes the environmental sensor's
+ * snapshot() instead of reading it. Other
+ * tasks read the controller through status() only, a copy tick() publishes
+ * (interfaces/SnapshotPublisher.h).
  */
 
 #ifndef WATERINGSYSTEM_CONTROL_WATERINGCONTROLLER_H
 #define WATERINGSYSTEM_CONTROL_WATERINGCONTROLLER_H
 
+#include <array>
+#include <cstddef>
 #include <cstdint>
+#include <type_traits>
 
+#include "control/DecisionTrace.h"
+#include "control/MoistureResponse.h"
+#include "control/PumpBudget.h"
+#include "control/WateringSchedule.h"
 #include "events/EventLogger.h"
 #include "interfaces/IConfigStore.h"
 #include "interfaces/IDataStorage.h"
 #include "interfaces/IEnvironmentalSensor.h"
+#include "interfaces/ISoilFeed.h"
 #include "interfaces/ISoilSensor.h"
 #include "interfaces/ITimeProvider.h"
 #include "interfaces/IWallClock.h"
 #include "interfaces/IWaterPump.h"
+#include "interfaces/SnapshotPublisher.h"
+#include "interfaces/TickLatency.h"
+
+/**
+ * @brief Per-zone overrides of the configured watering items; 0 keeps the
+ * IConfigStore value (board.h BoardZone).
+ */
+struct ZoneSettings {
+    float moistureThresholdLow = 0.0f;
+    float moistureThresholdHigh = 0.0f;
+    uint32_t wateringDurationS = 0;
+};
+
+/**
+ * @brief What a controller carries across a deep sleep (DutyCycle.h).
+ *
+ * Times are AGES at saveState(), so the state moves between clocks that
+ * restart at every boot: restoreState() places them before its own now.
+ * Trivial (no initializers), so it can sit in RTC_NOINIT memory;
+ * value-initialize it ({}) elsewhere.
+ */
+struct WateringControllerState {
+    /// One metric's last logged point (the deadband/heartbeat origin).
+    struct Point {
+        uint32_t epoch;
+        float value;
+        uint8_t valid;
+        uint8_t reserved[3];
+    };
+
+    int64_t burstEndAgeMs;  ///< since the last automatic burst ended; -1 = none
+    int64_t dataLogAgeMs;   ///< since the last data-log batch; -1 = none
+    Point lastLogged[metric::kKnownCount];
+    uint32_t skippedSamples;
+    uint32_t reserved;
+};
+static_assert(std::is_trivial<WateringControllerState>::value,
+              "RTC_NOINIT memory is never constructed");
+
+/**
+ * @brief What WateringController::status() copies out: the controller as
+ * of its last tick() (or manual start/stop). Monotonic times are the
+ * controller's clock; no field changes from tick to tick on its own, so
+ * the status version moves only when something did.
+ */
+struct WateringControllerStatus {
+    int64_t lastValidSoilMs = 0;  ///< last successful, in-range read; 0 = never
+    int64_t soakEndsAtMs = 0;     ///< end of the last burst's soak pause; 0 = none
+    uint32_t skippedSamples = 0;  ///< left out by a log policy since boot
+    DecisionGate gate = DecisionGate::NoFreshRead;  ///< decided the last tick
+    DecisionAction action = DecisionAction::None;   ///< the last tick's action
+    bool burstActive = false;      ///< automatic burst in progress
+    bool manualRunActive = false;  ///< operator run in progress
+};
 
 /**
  * @brief Pulsed automatic watering with an enforced soak pause and fail-safe.
  *
  * Invariants (host-tested):
- *  1. A fail-safe stop (sensor unavailable / stale / out-of-range moisture) is
- *     applied BEFORE the soak gate and is never delayed by it (FR-005/006).
+ *  1. A fail-safe stop (sensor unavailable / stale / out-of-range / flatlined
+ *     moisture) is applied BEFORE the soak gate and is never delayed by it
+ *     (FR-005/006).
  *  2. Automatic decisions gate on a successful, in-range read result, never on
  *     the sensor's placeholder/last-good values (FR-004).
  *  3. After a burst ends (self-stop at the configured duration or a stop at the
@@ -90,10 +159,13 @@ public:
      * @brief One evaluation. Non-blocking; call at a fixed cadence.
      *
      * Order (safety first, soak gate last): pump self-stop/cap enforcement →
-     * burst-end detection → single soil read → periodic data-log (runs in every
-     * mode, before any early return) → manual-override bypass → enabled gate →
-     * fail-safe (unavailable/stale/invalid) → gate-on-read → watering decision
-     * (stop-at-high / start-burst-if-soak-elapsed).
+     * burst-end detection → single soil read (or the feed's newest sample) →
+     * periodic data-log (runs in every mode, before any early return) →
+     * manual-override bypass → enabled gate → fail-safe
+     * (unavailable/stale/invalid/flatline) → schedule (stop a burst at a window
+     * close) → gate-on-read → watering decision (stop-at-high /
+     * start-burst-if-in-window-and-soak-elapsed). With a trace set, the
+     * gate that decided and the action taken are recorded last.
      */
     void tick();
 
@@ -107,13 +179,190 @@ public:
      */
     bool startManual(int durationS);
 
+    /**
+     * @brief Manual override by volume: run the plant pump until its flow
+     * meter has counted @p volumeMl, capped at 300 s (WaterPump::runForVolume).
+     *
+     * Same manual flag and fail-safe exemption as startManual(). Returns
+     * false when the pump has no flow meter or rejects the run.
+     */
+    bool startManualVolume(int volumeMl);
+
     /**
      * @brief Stop the plant pump and clear any manual override. Works in any
      * mode; a subsequent tick() resumes automatic evaluation (FR-010).
      */
     void stop();
 
+    /**
+     * @brief Log the moisture of a further soil probe on the RS485 segment,
+     * under the next per-probe id (soil_moisture_2, ...). Boot wiring only.
+     *
+     * The controller neither reads nor decides on it: the soil poll
+     * scheduler reads the probe, and the data log takes its snapshot(),
+     * logging the moisture while the last read was ok and in range.
+     * @return false once every per-probe id is taken
+     */
+    bool addSoilProbe(ISoilSensor& probe);
+
+    /**
+     * @brief Decide on @p feed's samples instead of reading the primary
+     * probe in tick(). Boot wiring only.
+     *
+     * tick() then takes latest() and never blocks on the bus. A sample is
+     * decided on and logged once, on the first tick that sees its sequence
+     * number; later ticks still run the pump enforcement and the fail-safe,
+     * with staleness measured from the sample's own timestamp, so a stalled
+     * acquisition fails safe as "soil-stale" after kStalenessMs. A sample
+     * the feed marks suspect fails safe as "soil-flatline" (logged once when
+     * the flag rises, in every mode).
+     */
+    void setSoilFeed(ISoilFeed& feed) { feed_ = &feed; }
+
+    /**
+     * @brief Log the environmental sensor's samples without reading it: the
+     * sensor task already does, at its own cadence. Boot wiring only.
+     *
+     * The data log then takes snapshot() and logs a valid sample once, on
+     * the first log that sees its sequence number, while it is at most
+     * @p maxAgeMs old (an unstamped sample counts as fresh). Without it
+     * the data log reads the sensor itself (host tests, bare wiring).
+     */
+    void setEnvAcquired(uint32_t maxAgeMs) { envMaxAgeMs_ = maxAgeMs; }
+
+    /**
+     * @brief Size automatic bursts from @p response instead of the fixed
+     * wateringDurationS. Boot wiring only.
+     *
+     * tick() feeds it every fresh valid sample and each burst's start and
+     * end, and asks it for the burst that reaches moistureThresholdHigh by
+     * the end of the soak (at most the 300 s cap); it returns the configured
+     * burst until it has learnt the bed. A manual run is reported as a
+     * disturbance. The stop at the high threshold still applies.
+     */
+    void setBurstSizer(MoistureResponse& response) { response_ = &response; }
+
+    /**
+     * @brief Start automatic bursts only inside @p schedule's windows.
+     * Boot wiring only; the zones may share one schedule.
+     *
+     * Outside them a dry soil waits (the soak gate still runs from the
+     * last burst end), and an automatic burst still running when a window
+     * closes or a blackout starts is stopped there, which ends the burst
+     * and arms the soak pause. Manual runs are exempt. Until the wall
+     * clock is set the schedule cannot be placed, so watering is not held
+     * back by it.
+     */
+    void setSchedule(const WateringSchedule& schedule) { schedule_ = &schedule; }
+
+    /**
+     * @brief Leave one DecisionRecord per tick() in @p trace, tagged
+     * @p zone. Boot wiring only; the zones may share one trace (they all
+     * tick on one task, its single writer).
+     */
+    void setTrace(DecisionTrace& trace, uint8_t zone)
+    {
+        trace_ = &trace;
+        traceZone_ = zone;
+    }
+
+    /**
+     * @brief Time the soil read, the data log and the event writes of each
+     * tick() as those phases of @p latency's current tick (the rest is the
+     * decision). Boot wiring only; the zones share the watering task's one.
+     */
+    void setTickLatency(TickLatency& latency) { latency_ = &latency; }
+
+    /**
+     * @brief Zone wiring (WateringZones). Boot wiring only.
+     *
+     * @p overrides replace the configured thresholds/burst where non-zero.
+     * With @p budget an automatic burst starts only while a slot is free,
+     * holding it until the burst ends (a zone that finds none retries on
+     * later ticks; the soak gate is unaffected). With @p logsData false the
+     * zone writes no data log — the first zone logs every probe.
+     */
+    void setZone(const ZoneSettings& overrides, PumpBudget* budget, bool logsData)
+    {
+        zone_ = overrides;
+        budget_ = budget;
+        logsData_ = logsData;
+        settingsLoaded_ = false;
+    }
+
+    /**
+     * @brief Log every @p ms instead of the configured dataLogIntervalMs;
+     * 0 = the configured interval. Boot wiring only.
+     *
+     * The soak mode's accelerated logging (CONFIG_WS_SOAK_MODE): the config
+     * store floors the interval at 60 s, this does not. A sample is still
+     * logged at most once, so the sensor-read interval bounds the rate.
+     */
+    void setDataLogInterval(uint32_t ms)
+    {
+        dataLogOverrideMs_ = ms;
+        settingsLoaded_ = false;
+    }
+
+    /**
+     * @brief Earliest monotonic time after @p now at which tick() acts
+     * without a new sample or event: the last valid sample going stale
+     * (fail-safe stop), the next data-log or the schedule's next edge.
+     *
+     * An event-driven caller ticks no later than this. INT64_MAX when
+     * none is pending (no valid sample yet, already stale, no log yet, no
+     * schedule).
+     */
+    int64_t nextDeadlineMs(int64_t now) const;
+
+    /**
+     * @brief End of the running soak pause, or 0 when none runs at @p now.
+     *
+     * tick() starts a burst only on a sample it has not seen yet, so a
+     * caller that wants the burst at once asks for a fresh read then.
+     */
+    int64_t soakEndsAtMs(int64_t now) const;
+
+    /**
+     * @brief When the schedule next allows automatic bursts, while it does
+     * not at @p now; 0 when it does (or there is none). Like the soak end,
+     * a caller asks for a fresh read then.
+     */
+    int64_t windowOpensAtMs(int64_t now) const;
+
+    /// Samples a metric log policy left out of the data log since boot.
+    uint32_t skippedSamples() const { return skippedSamples_; }
+
+    /// The controller as of its last tick() or manual start/stop, as one
+    /// consistent copy. Any task; never blocks.
+    WateringControllerStatus status() const { return published_.load(); }
+
+    /// Changes of status() so far, for a poller to skip an unchanged one.
+    uint32_t statusVersion() const { return published_.version(); }
+
+    /**
+     * @brief Copy the soak origin, the data-log cadence and the log-policy
+     * points into @p out, as ages at the clock's now.
+     *
+     * For a deep sleep: call with no pump running. A burst still marked
+     * active counts as ended now, so the next wake keeps the soak pause.
+     */
+    void saveState(WateringControllerState& out) const;
+
+    /**
+     * @brief Continue from @p state, saved @p elapsedMs ago (the time
+     * asleep, on a clock that kept running). Boot wiring only, before the
+     * first tick().
+     *
+     * The last valid soil read is not carried: the wake reads afresh.
+     */
+    void restoreState(const WateringControllerState& state, int64_t elapsedMs);
+
 private:
+    /// tick()'s evaluation after the settings refresh; notes the deciding
+    /// gate, the action and the sample in @p rec.
+    void decide(int64_t now, DecisionRecord& rec);
+
     /**
      * @brief Periodic env + soil telemetry log (FR-014). Runs every tick from
      * tick(), before any mode/fail-safe early return, so telemetry is recorded
@@ -122,16 +371,79 @@ private:
      * Gated on IWallClock::isTimeSet() (never logs a bogus 1970 epoch) and on
      * the configured data-log interval (the first eligible log after time is set
      * fires immediately). Env readings are logged on a successful, available
-     * read; soil readings are logged only when @p soilValid (the result of the
+     * read (with setEnvAcquired(), on a fresh sample not logged before);
+     * soil readings are logged only when @p soilValid (the result of the
      * single soil read() this tick), with NPK included only when >= 0. Soil
      * metrics come from @p soil — the same coherent snapshot tick() decided on,
      * so the logged values match the decision values with no second read. All
-     * writes carry IWallClock::nowEpoch(); storage self-bounds, so the store
-     * result is ignored.
+     * readings carry IWallClock::nowEpoch() and go to storage as one
+     * storeSamples() batch keyed by metric id; storage self-bounds, so the
+     * store result is ignored. A metric whose IConfigStore log policy is on
+     * is left out of the batch while it stays inside its deadband and its
+     * heartbeat has not elapsed (see keepSample()).
      */
     void maybeLogData(int64_t now, bool soilValid, const SoilSnapshot& soil);
 
+    /// Whether the schedule lets an automatic burst run now.
+    bool scheduleAllows() const;
+
+    /// Monotonic time of wall-clock @p epoch, from @p now; 0 for epoch 0
+    /// or while the wall clock is unset.
+    int64_t monotonicAt(uint32_t epoch, int64_t now) const;
+
+    /// Soak pause from the cached settings, milliseconds.
+    int64_t soakMs() const;
+
+    /// Record an automatic burst's end at @p now: the soak-gate origin, and
+    /// the rise observation of the burst sizer.
+    void endBurst(int64_t now);
+
+    /// Drop an automatic burst without arming the soak gate (fail-safe).
+    void abandonBurst(int64_t now);
+
+    /// Return the pump-budget slot, if held.
+    void releaseBudget();
+
+    /// Fill status_ from the members and publish it for status().
+    void publishStatus();
+
+    /// Re-read the config items tick() uses when IConfigStore::generation()
+    /// moved since the last read (always on the first tick).
+    void refreshSettings();
+
+    /// Apply @p id's log policy to a candidate sample; true = log it (and
+    /// remember it as the metric's last logged point).
+    bool keepSample(MetricId id, uint32_t epoch, float value);
+
     ISoilSensor& soil_;
+    /// Published samples of soil_ (nullptr = tick() reads soil_ itself).
+    ISoilFeed* feed_ = nullptr;
+    uint32_t feedSequence_ = 0;      ///< last sample tick() took from feed_
+    bool flatlineReported_ = false;  ///< feed_'s suspect flag as last seen
+    /// setEnvAcquired() (0 = the data log reads env_ itself).
+    uint32_t envMaxAgeMs_ = 0;
+    uint32_t envSequence_ = 0;  ///< last env_ sample the data log took
+    /// Burst sizing (nullptr = the fixed wateringDurationS).
+    MoistureResponse* response_ = nullptr;
+    /// Watering windows (nullptr = any time).
+    const WateringSchedule* schedule_ = nullptr;
+    /// Decision trace (nullptr = none) and this controller's zone in it.
+    DecisionTrace* trace_ = nullptr;
+    uint8_t traceZone_ = 0;
+    /// Tick phase timing (nullptr = not timed).
+    TickLatency* latency_ = nullptr;
+    /// Zone overrides, applied by refreshSettings().
+    ZoneSettings zone_;
+    /// setDataLogInterval() (0 = configured), applied by refreshSettings().
+    uint32_t dataLogOverrideMs_ = 0;
+    /// Shared supply slots (nullptr = unlimited); budgetHeld_ while this
+    /// zone's automatic burst holds one.
+    PumpBudget* budget_ = nullptr;
+    bool budgetHeld_ = false;
+    bool logsData_ = true;
+    /// Further probes, data-logged only (probe i + 1 of the segment).
+    std::array<ISoilSensor*, metric::kSoilProbes - 1> probes_{};
+    std::size_t probeCount_ = 0;
     IEnvironmentalSensor& env_;  ///< periodic data-logging source (US3)
     IWaterPump& plant_;
     IConfigStore& config_;
@@ -140,6 +452,11 @@ private:
     IWallClock& wallClock_;
     EventLogger& events_;
 
+    /// Local copy of the config items, refreshed by refreshSettings().
+    ConfigSnapshot settings_;
+    uint32_t settingsGeneration_ = 0;
+    bool settingsLoaded_ = false;
+
     /// Monotonic time the last automatic burst ended — the soak-gate origin
     /// (0 = no burst has ended yet).
     int64_t lastBurstEndMs_ = 0;
@@ -162,6 +479,22 @@ private:
     /// Monotonic time of the last data-log batch (0 = none yet — the first
     /// eligible log after the wall clock is set fires immediately).
     int64_t lastDataLogMs_ = 0;
+
+    /// Last logged point per known metric — the deadband/heartbeat origin.
+    struct LoggedPoint {
+        bool valid = false;
+        uint32_t epoch = 0;
+        float value = 0.0f;
+    };
+    std::array<LoggedPoint, metric::kKnownCount> lastLogged_{};
+
+    /// Samples left out by a log policy since boot.
+    uint32_t skippedSamples_ = 0;
+
+    /// The writer's status (gate and action from the last tick), and its
+    /// published copy.
+    WateringControllerStatus status_{};
+    SnapshotPublisher<WateringControllerStatus> published_;
 };
 
 #endif /* WATERINGSYSTEM_CONTROL_WATERINGCONTROLLER_H */
@@ -0,0 +1,87 @@
+// SPDX-FileCopyrightText: 2026 Cryptotomte
+// SPDX-License-Identifier: AGPL-3.0-or-later
+/**
+ * @file WateringSchedule.h
+ * @brief Pure weekly time-of-day windows and blackouts for automatic
+ *        watering.
+ *
+ * A rule names local weekdays and a local start/end minute; an end at or
+ * before the start runs past midnight into the next day. Automatic watering
+ * may run while inside any window rule (always, when there are none) and
+ * inside no blackout rule. Local time is the process TZ (set by
+ * SntpClient::applyTimezone() on target), so the rules follow DST.
+ *
+ * Evaluating the rules takes a few mktime() calls per rule, so the schedule
+ * does it once per edge: it keeps the answer together with the next window
+ * edge and, while closed, the time it next opens, and answers from that
+ * until the clock passes the edge (or steps backwards). A caller sleeps
+ * until nextEdge() rather than polling. Fixed array of rules, no allocation.
+ */
+
+#ifndef WATERINGSYSTEM_CONTROL_WATERINGSCHEDULE_H
+#define WATERINGSYSTEM_CONTROL_WATERINGSCHEDULE_H
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+
+/// One weekly rule of a WateringSchedule.
+struct ScheduleRule {
+    uint8_t days = 0x7F;    ///< bit d = local weekday d (0 = Sunday) it starts on
+    uint16_t startMin = 0;  ///< local minute of the day, [0, 1440)
+    uint16_t endMin = 0;    ///< at or before startMin = the next day
+    bool blackout = false;  ///< forbids watering instead of allowing it
+};
+
+class WateringSchedule {
+public:
+    static constexpr std::size_t kMaxRules = 8;
+    static constexpr uint16_t kMinutesPerDay = 24 * 60;
+
+    /// Add @p rule. Boot wiring only; false when full, or for no days, a
+    /// minute out of range or an empty window.
+    bool add(const ScheduleRule& rule);
+
+    std::size_t size() const { return count_; }
+    const ScheduleRule& rule(std::size_t i) const { return rules_[i]; }
+
+    /// Whether automatic watering may run at @p epoch.
+    bool allows(uint32_t epoch) const;
+
+    /// First time after @p epoch that allows() may change; 0 = never (no rules).
+    uint32_t nextEdge(uint32_t epoch) const;
+
+    /// When watering is next allowed, while it is not at @p epoch; 0 when
+    /// it is allowed now.
+    uint32_t nextOpening(uint32_t epoch) const;
+
+private:
+    /// Evaluate the rules at @p epoch into the cache.
+    void refresh(uint32_t epoch) const;
+
+    /// allows() and the first edge after @p epoch, from the rules.
+    bool evaluate(uint32_t epoch, uint32_t& nextEdge) const;
+
+    std::array<ScheduleRule, kMaxRules> rules_{};
+    std::size_t count_ = 0;
+
+    /// The answer for [cachedFrom_, cachedUntil_); cachedUntil_ is the next
+    /// edge (0 = none).
+    mutable bool cached_ = false;
+    mutable uint32_t cachedFrom_ = 0;
+    mutable uint32_t cachedUntil_ = 0;
+    mutable bool cachedAllows_ = true;
+    mutable uint32_t cachedOpening_ = 0;
+};
+
+/**
+ * @brief Parse rules from text into @p out: entries separated by ';', each
+ * "[!]DAYS HH:MM-HH:MM" where DAYS is "*" (every day), a day ("Mo") or a
+ * range ("Mo-Fr", "Sa-Mo" wraps) of Mo Tu We Th Fr Sa Su, and '!' makes a
+ * blackout (e.g. "* 05:00-08:00; * 19:00-22:00; !Sa-Su 06:00-07:00").
+ * @return false on a malformed entry or too many (@p out then holds the
+ *         entries before it); an empty text is no rules.
+ */
+bool parseWateringSchedule(const char* text, WateringSchedule& out);
+
+#endif /* WATERINGSYSTEM_CONTROL_WATERINGSCHEDULE_H */
@@ -0,0 +1,101 @@
+// SPDX-FileCopyrightText: 2026 Cryptotomte
+// SPDX-License-Identifier: AGPL-3.0-or-later
+/**
+ * @file WateringZones.h
+ * @brief Pure set of zone controllers ticked together from one task
+ *        (header-only).
+ *
+ * Each zone is a WateringController over its own soil feed, pump, zone
+ * settings and soak state; the zones share one PumpBudget. tick() ticks
+ * every zone once, starting one zone further along each time, so a slot
+ * freed in one tick is not always taken by the same zone. The set is a
+ * fixed array of borrowed pointers: adding zones adds no allocation and a
+ * tick allocates nothing.
+ */
+
+#ifndef WATERINGSYSTEM_CONTROL_WATERINGZONES_H
+#define WATERINGSYSTEM_CONTROL_WATERINGZONES_H
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+
+#include "control/WateringController.h"
+#include "interfaces/MetricRegistry.h"
+
+class WateringZones {
+public:
+    /// One soil probe per zone, so no more zones than probe metric ids.
+    static constexpr std::size_t kMaxZones = metric::kSoilProbes;
+
+    /// Add @p zone (must outlive the set). Boot wiring only; false when full.
+    bool add(WateringController& zone)
+    {
+        if (count_ == zones_.size()) {
+            return false;
+        }
+        zones_[count_++] = &zone;
+        return true;
+    }
+
+    std::size_t size() const { return count_; }
+    WateringController& zone(std::size_t i) const { return *zones_[i]; }
+
+    /// Tick every zone once, rotating which goes first.
+    void tick()
+    {
+        for (std::size_t n = 0; n < count_; ++n) {
+            zones_[(first_ + n) % count_]->tick();
+        }
+        if (count_ != 0) {
+            first_ = (first_ + 1) % count_;
+        }
+    }
+
+    /// Earliest WateringController::nextDeadlineMs() of the zones.
+    int64_t nextDeadlineMs(int64_t now) const
+    {
+        int64_t deadline = INT64_MAX;
+        for (std::size_t i = 0; i < count_; ++i) {
+            const int64_t at = zones_[i]->nextDeadlineMs(now);
+            if (at < deadline) {
+                deadline = at;
+            }
+        }
+        return deadline;
+    }
+
+    /// Earliest soak end still running at @p now, 0 when none.
+    int64_t soakEndsAtMs(int64_t now) const
+    {
+        int64_t earliest = 0;
+        for (std::size_t i = 0; i < count_; ++i) {
+            const int64_t at = zones_[i]->soakEndsAtMs(now);
+            if (at != 0 && (earliest == 0 || at < earliest)) {
+                earliest = at;
+            }
+        }
+        return earliest;
+    }
+
+    /// Earliest WateringController::windowOpensAtMs() of the zones, 0 when
+    /// none waits for a window.
+    int64_t windowOpensAtMs(int64_t now) const
+    {
+        int64_t earliest = 0;
+        for (std::size_t i = 0; i < count_; ++i) {
+            const int64_t at = zones_[i]->windowOpensAtMs(now);
+            if (at != 0 && (earliest == 0 || at < earliest)) {
+                earliest = at;
+            }
+        }
+        return earliest;
+    }
+
+private:
+    std::array<WateringController*, kMaxZones> zones_{};
+    std::size_t count_ = 0;
+    std::size_t first_ = 0;  ///< zone ticked first next time
+};
+
+#endif /* WATERINGSYSTEM_CONTROL_WATERINGZONES_H */
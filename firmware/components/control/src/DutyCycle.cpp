@@ -0,0 +1,92 @@
+// SPDX-FileCopyrightText: 2026 Cryptotomte
+// SPDX-License-Identifier: AGPL-3.0-or-later
+/**
+ * @file DutyCycle.cpp
+ * @brief Retained wake state and the sleep plan (see DutyCycle.h).
+ */
+
+#include "control/DutyCycle.h"
+
+#include <cstddef>
+#include <cstdint>
+#include <initializer_list>
+
+bool DutyCycle::valid(const DutyCycleState& block)
+{
+    return block.magic == DutyCycleState::kMagic &&
+           block.version == DutyCycleState::kVersion && block.crc == crcOf(block);
+}
+
+bool DutyCycle::resume(int64_t rtcNowMs)
+{
+    warm_ = valid(block_);
+    if (!warm_) {
+        block_ = {};
+        block_.magic = DutyCycleState::kMagic;
+        block_.version = DutyCycleState::kVersion;
+        sleptMs_ = 0;
+    } else {
+        // The RTC timer restarts from zero on a power cycle; the soak
+        // state is still the best there is, with no time credited.
+        sleptMs_ = rtcNowMs > block_.sealedRtcMs ? rtcNowMs - block_.sealedRtcMs : 0;
+    }
+    ++block_.counters.wakes;
+    if (block_.wakesSinceSync < UINT16_MAX) {
+        ++block_.wakesSinceSync;
+    }
+    return warm_;
+}
+
+bool DutyCycle::syncDue() const
+{
+    return !warm_ || block_.wakesSinceSync >= settings_.syncEvery;
+}
+
+void DutyCycle::noteSync(bool ok)
+{
+    if (ok) {
+        ++block_.counters.syncs;
+        block_.wakesSinceSync = 0;
+    } else {
+        ++block_.counters.syncFailures;
+    }
+}
+
+uint32_t DutyCycle::planSleepMs(int64_t now, int64_t soakEndsAtMs,
+                                int64_t windowOpensAtMs) const
+{
+    int64_t sleepMs = settings_.periodMs;
+    for (const int64_t at : {soakEndsAtMs, windowOpensAtMs}) {
+        if (at > now && at - now < sleepMs) {
+            sleepMs = at - now;
+        }
+    }
+    if (sleepMs < static_cast<int64_t>(settings_.minSleepMs)) {
+        sleepMs = settings_.minSleepMs;
+    }
+    return static_cast<uint32_t>(sleepMs);
+}
+
+void DutyCycle::seal(const WateringControllerState& controller, int64_t rtcNowMs,
+                     uint32_t awakeMs)
+{
+    block_.controller = controller;
+    block_.counters.awakeMs += awakeMs;
+    block_.sealedRtcMs = rtcNowMs;
+    block_.crc = crcOf(block_);
+}
+
+uint32_t DutyCycle::crcOf(const DutyCycleState& block)
+{
+    // CRC-32 (IEEE, reflected) of the block up to its crc field.
+    const auto* bytes = reinterpret_cast<const uint8_t*>(&block);
+    const std::size_t len = offsetof(DutyCycleState, crc);
+    uint32_t crc = 0xFFFFFFFFu;
+    for (std::size_t i = 0; i < len; ++i) {
+        crc ^= bytes[i];
+        for (int bit = 0; bit < 8; ++bit) {
+            crc = (crc >> 1) ^ (0xEDB88320u & (0u - (crc & 1u)));
+        }
+    }
+    return ~crc;
+}
@@ -0,0 +1,265 @@
+// SPDX-FileCopyrightText: 2026 Cryptotomte
+// SPDX-License-Identifier: AGPL-3.0-or-later
+/**
+ * @file InputRecord.cpp
+ * @brief Watering input recording reader (see InputRecord.h).
+ */
+
+#include "control/InputRecord.h"
+
+#include <cstring>
+
+using namespace input_record;
+
+namespace {
+
+uint32_t u32At(const uint8_t* p)
+{
+    return static_cast<uint32_t>(p[0]) | static_cast<uint32_t>(p[1]) << 8 |
+           static_cast<uint32_t>(p[2]) << 16 | static_cast<uint32_t>(p[3]) << 24;
+}
+
+float f32At(const uint8_t* p)
+{
+    const uint32_t bits = u32At(p);
+    float value;
+    std::memcpy(&value, &bits, sizeof(value));
+    return value;
+}
+
+}  // namespace
+
+RecordedConfig RecordedConfig::from(IConfigStore& config)
+{
+    RecordedConfig out;
+    out.set(ConfigItem::ThresholdLow, config.getMoistureThresholdLow());
+    out.set(ConfigItem::ThresholdHigh, config.getMoistureThresholdHigh());
+    out.set(ConfigItem::WateringDurationS, static_cast<float>(config.getWateringDurationS()));
+    out.set(ConfigItem::MinWateringIntervalS,
+            static_cast<float>(config.getMinWateringIntervalS()));
+    out.set(ConfigItem::WateringEnabled, config.getWateringEnabled() ? 1.0f : 0.0f);
+    out.set(ConfigItem::SensorReadIntervalMs,
+            static_cast<float>(config.getSensorReadIntervalMs()));
+    return out;
+}
+
+uint8_t RecordedLevels::bits() const
+{
+    return static_cast<uint8_t>((lowValid ? kLevelLowValid : 0) | (lowWet ? kLevelLowWet : 0) |
+                                (highValid ? kLevelHighValid : 0) |
+                                (highWet ? kLevelHighWet : 0));
+}
+
+RecordedLevels RecordedLevels::fromBits(uint8_t bits)
+{
+    RecordedLevels out;
+    out.lowValid = (bits & kLevelLowValid) != 0;
+    out.lowWet = (bits & kLevelLowWet) != 0;
+    out.highValid = (bits & kLevelHighValid) != 0;
+    out.highWet = (bits & kLevelHighWet) != 0;
+    return out;
+}
+
+bool InputRecordReader::fail(const char* what)
+{
+    error_ = what;
+    pos_ = len_;
+    return false;
+}
+
+bool InputRecordReader::openBlock()
+{
+    if (len_ - pos_ < kHeaderBytes) {
+        return pos_ == len_ ? false : fail("truncated block header");
+    }
+    const uint8_t* h = data_ + pos_;
+    if (std::memcmp(h, kMagic, sizeof(kMagic)) != 0) {
+        return fail("bad block magic");
+    }
+    const uint32_t sequence = u32At(h + 4);
+    const std::size_t payload = static_cast<std::size_t>(h[8]) | static_cast<std::size_t>(h[9]) << 8;
+    if (payload > kPayloadBytes || len_ - pos_ - kHeaderBytes < payload) {
+        return fail("truncated block");
+    }
+    // The keyframe restates everything else; only a gap loses ticks.
+    if (blocks_ == 0 || sequence != sequence_ + 1) {
+        pendingResync_ = true;
+    }
+    sequence_ = sequence;
+    ++blocks_;
+    pos_ += kHeaderBytes;
+    blockEnd_ = pos_ + payload;
+    return true;
+}
+
+bool InputRecordReader::readRecord(bool& tickEnds)
+{
+    const uint8_t tag = data_[pos_];
+    const uint8_t kind = tag >> 4;
+    const uint8_t arg = tag & 0x0f;
+    if (haveTick_ && (kind == kTick || kind == kBase)) {
+        tickEnds = true;  // the next tick's, left for the next call
+        return true;
+    }
+    std::size_t p = pos_ + 1;
+    auto need = [&](std::size_t n) { return blockEnd_ - p >= n; };
+    auto varint = [&](uint32_t& out) {
+        out = 0;
+        for (int shift = 0; shift < 35; shift += 7) {
+            if (!need(1)) {
+                return false;
+            }
+            const uint8_t b = data_[p++];
+            out |= static_cast<uint32_t>(b & 0x7f) << shift;
+            if ((b & 0x80) == 0) {
+                return true;
+            }
+        }
+        return false;
+    };
+    switch (kind) {
+    case kBase: {
+        if (!need(12)) {
+            return fail("truncated base");
+        }
+        uint64_t ms = 0;
+        for (int i = 7; i >= 0; --i) {
+            ms = ms << 8 | data_[p + static_cast<std::size_t>(i)];
+        }
+        tickMs_ = static_cast<int64_t>(ms);
+        clockMs_ = tickMs_;
+        clockEpoch_ = u32At(data_ + p + 8);
+        p += 12;
+        break;
+    }
+    case kBoot:
+        pendingBoot_ = true;
+        soil_ = {};
+        pumps_ = {};
+        break;
+    case kTick: {
+        uint32_t delta = 0;
+        if (!varint(delta)) {
+            return fail("truncated tick");
+        }
+        tickMs_ += delta;
+        haveTick_ = true;
+        break;
+    }
+    case kClock:
+        if (!need(4)) {
+            return fail("truncated clock");
+        }
+        clockMs_ = tickMs_;
+        clockEpoch_ = u32At(data_ + p);
+        p += 4;
+        break;
+    case kSoil: {
+        if (arg >= kMaxZones || !need(1)) {
+            return fail("bad soil record");
+        }
+        const uint8_t flags = data_[p++];
+        TimedSoilSnapshot& s = soil_[arg];
+        if ((flags & kSoilSameMoisture) == 0) {
+            if (!need(4)) {
+                return fail("truncated soil record");
+            }
+            s.soil.moisture = f32At(data_ + p);
+            p += 4;
+        }
+        uint32_t age = 0;
+        if (!varint(age)) {
+            return fail("truncated soil record");
+        }
+        s.soil.readOk = (flags & kSoilReadOk) != 0;
+        s.soil.available = (flags & kSoilAvailable) != 0;
+        s.suspect = (flags & kSoilSuspect) != 0;
+        s.group = static_cast<SoilReadGroup>((flags >> kSoilGroupShift) & 0x3);
+        s.atMs = tickMs_ - static_cast<int64_t>(age);
+        // A restated sample is not a new one, unless it is all there is.
+        if ((flags & kSoilKeyframe) == 0 || s.sequence == 0) {
+            ++s.sequence;
+        }
+        break;
+    }
+    case kLevels:
+        levels_ = RecordedLevels::fromBits(arg);
+        levelsSeen_ = true;
+        break;
+    case kPump:
+        pumps_[arg & 0x7] = (arg & kPumpRunning) != 0;
+        break;
+    case kConfig:
+        if (arg >= kConfigItems || !need(4)) {
+            return fail("bad config record");
+        }
+        config_.values[arg] = f32At(data_ + p);
+        p += 4;
+        break;
+    case kSetup: {
+        if (!need(2)) {
+            return fail("truncated setup");
+        }
+        setup_.predictive = (arg & kSetupPredictive) != 0;
+        setup_.pumpBudget = data_[p];
+        const std::size_t n = data_[p + 1];
+        p += 2;
+        if (!need(n)) {
+            return fail("truncated setup");
+        }
+        setup_.schedule.assign(reinterpret_cast<const char*>(data_ + p), n);
+        p += n;
+        setup_.zoneCount = 0;
+        break;
+    }
+    case kZone: {
+        if (arg >= kMaxZones || !need(10)) {
+            return fail("bad zone record");
+        }
+        ZoneSettings& z = setup_.zones[arg];
+        z.moistureThresholdLow = f32At(data_ + p);
+        z.moistureThresholdHigh = f32At(data_ + p + 4);
+        z.wateringDurationS = static_cast<uint32_t>(data_[p + 8]) |
+                              static_cast<uint32_t>(data_[p + 9]) << 8;
+        p += 10;
+        if (arg + 1u > setup_.zoneCount) {
+            setup_.zoneCount = arg + 1u;
+        }
+        break;
+    }
+    default:
+        return fail("unknown record");
+    }
+    pos_ = p;
+    return true;
+}
+
+bool InputRecordReader::next(RecordedTick& tick)
+{
+    haveTick_ = false;
+    bool tickEnds = false;
+    while (!tickEnds) {
+        if (pos_ == blockEnd_) {
+            if (haveTick_) {
+                break;  // a block ends with whole ticks
+            }
+            if (!openBlock()) {
+                return false;
+            }
+            continue;
+        }
+        if (!readRecord(tickEnds)) {
+            return false;
+        }
+    }
+    tick.atMs = tickMs_;
+    tick.epoch = clockEpoch_ == 0
+                     ? 0
+                     : clockEpoch_ + static_cast<uint32_t>((tickMs_ - clockMs_) / 1000);
+    tick.boot = pendingBoot_;
+    tick.resync = pendingResync_ && !pendingBoot_;
+    tick.block = sequence_;
+    pendingBoot_ = false;
+    pendingResync_ = false;
+    return true;
+}
@@ -0,0 +1,297 @@
+// SPDX-FileCopyrightText: 2026 Cryptotomte
+// SPDX-License-Identifier: AGPL-3.0-or-later
+/**
+ * @file InputRecorder.cpp
+ * @brief Watering input recorder (see InputRecorder.h).
+ */
+
+#include "control/InputRecorder.h"
+
+#include <algorithm>
+#include <cstdlib>
+#include <cstring>
+#include <mutex>
+
+using namespace input_record;
+
+namespace {
+
+constexpr std::size_t kMaxScheduleBytes = 255;
+
+uint8_t tag(uint8_t kind, uint8_t arg)
+{
+    return static_cast<uint8_t>(kind << 4 | (arg & 0x0f));
+}
+
+void putU32(uint8_t* p, uint32_t v)
+{
+    p[0] = static_cast<uint8_t>(v);
+    p[1] = static_cast<uint8_t>(v >> 8);
+    p[2] = static_cast<uint8_t>(v >> 16);
+    p[3] = static_cast<uint8_t>(v >> 24);
+}
+
+void putF32(uint8_t* p, float v)
+{
+    uint32_t bits;
+    std::memcpy(&bits, &v, sizeof(bits));
+    putU32(p, bits);
+}
+
+/// LEB128 of @p v at @p p; returns the bytes written (at most 5).
+std::size_t putVarint(uint8_t* p, uint32_t v)
+{
+    std::size_t n = 0;
+    do {
+        const uint8_t b = v & 0x7f;
+        v >>= 7;
+        p[n++] = static_cast<uint8_t>(b | (v != 0 ? 0x80 : 0));
+    } while (v != 0);
+    return n;
+}
+
+uint32_t clampedDelta(int64_t ms)
+{
+    return ms <= 0 ? 0u : ms > UINT32_MAX ? UINT32_MAX : static_cast<uint32_t>(ms);
+}
+
+bool sameBits(float a, float b)
+{
+    return std::memcmp(&a, &b, sizeof(a)) == 0;
+}
+
+}  // namespace
+
+InputRecorder::InputRecorder(std::size_t blocks)
+    : blocks_(std::max<std::size_t>(blocks, 2)),
+      ram_(static_cast<uint8_t*>(
+          bufferBudgets().allocate(BufferPool::InputRecorder, blocks_ * kPayloadBytes))),
+      used_(new uint16_t[blocks_]())
+{
+    if (ram_ == nullptr) {
+        std::abort();  // what new[] did: the recorder has no smaller mode
+    }
+}
+
+InputRecorder::~InputRecorder()
+{
+    bufferBudgets().release(BufferPool::InputRecorder, ram_, blocks_ * kPayloadBytes);
+}
+
+void InputRecorder::setSetup(const RecordedSetup& setup)
+{
+    setup_ = setup;
+    if (setup_.schedule.size() > kMaxScheduleBytes) {
+        setup_.schedule.resize(kMaxScheduleBytes);
+    }
+    setup_.zoneCount = std::min(setup_.zoneCount, kMaxZones);
+}
+
+void InputRecorder::append(const uint8_t* bytes, std::size_t n)
+{
+    // kTickReserve keeps a tick's records inside the block; a keyframe
+    // fits an empty one.
+    if (open_ == 0 || writing_ + n > kPayloadBytes) {
+        return;
+    }
+    std::memcpy(slot(open_) + writing_, bytes, n);
+    writing_ += n;
+}
+
+void InputRecorder::commit()
+{
+    std::lock_guard<StaticMutex> lock(mutex_);
+    used_[(open_ - 1) % blocks_] = static_cast<uint16_t>(writing_);
+}
+
+void InputRecorder::openBlock(int64_t atMs, uint32_t epoch)
+{
+    {
+        std::lock_guard<StaticMutex> lock(mutex_);
+        if (open_ != 0) {
+            used_[(open_ - 1) % blocks_] = static_cast<uint16_t>(writing_);
+        }
+        ++open_;
+        used_[(open_ - 1) % blocks_] = 0;  // the oldest block goes here
+    }
+    writing_ = 0;
+    uint8_t base[13];
+    base[0] = tag(kBase, 0);
+    for (int i = 0; i < 8; ++i) {
+        base[1 + i] = static_cast<uint8_t>(static_cast<uint64_t>(atMs) >> (8 * i));
+    }
+    putU32(base + 9, epoch);
+    append(base, sizeof(base));
+    tickMs_ = atMs;
+    clockMs_ = atMs;
+    clockEpoch_ = epoch;
+    if (!booted_) {
+        booted_ = true;
+        const uint8_t boot = tag(kBoot, 0);
+        append(&boot, 1);
+    }
+    writeKeyframe();
+}
+
+void InputRecorder::writeKeyframe()
+{
+    uint8_t buf[2 + kMaxScheduleBytes + 1];
+    buf[0] = tag(kSetup, setup_.predictive ? kSetupPredictive : 0);
+    buf[1] = setup_.pumpBudget;
+    buf[2] = static_cast<uint8_t>(setup_.schedule.size());
+    std::memcpy(buf + 3, setup_.schedule.data(), setup_.schedule.size());
+    append(buf, 3 + setup_.schedule.size());
+    for (std::size_t z = 0; z < setup_.zoneCount; ++z) {
+        const ZoneSettings& zone = setup_.zones[z];
+        buf[0] = tag(kZone, static_cast<uint8_t>(z));
+        putF32(buf + 1, zone.moistureThresholdLow);
+        putF32(buf + 5, zone.moistureThresholdHigh);
+        const uint32_t burst = std::min<uint32_t>(zone.wateringDurationS, UINT16_MAX);
+        buf[9] = static_cast<uint8_t>(burst);
+        buf[10] = static_cast<uint8_t>(burst >> 8);
+        append(buf, 11);
+    }
+    if (configKnown_) {
+        for (std::size_t i = 0; i < kConfigItems; ++i) {
+            buf[0] = tag(kConfig, static_cast<uint8_t>(i));
+            putF32(buf + 1, config_.values[i]);
+            append(buf, 5);
+        }
+    }
+    if (levelsKnown_) {
+        buf[0] = tag(kLevels, levels_.bits());
+        append(buf, 1);
+    }
+    for (uint8_t id = 0; id < kPumps; ++id) {
+        if ((pumpsSeen_ & (1u << id)) != 0) {
+            buf[0] = tag(kPump, static_cast<uint8_t>(id | (pumps_[id] ? kPumpRunning : 0)));
+            append(buf, 1);
+        }
+    }
+    for (std::size_t z = 0; z < kMaxZones; ++z) {
+        if (soil_[z].sequence != 0) {
+            appendSoil(z, kSoilKeyframe, soil_[z], true);
+        }
+    }
+}
+
+void InputRecorder::beginTick(int64_t atMs, uint32_t epoch, const RecordedConfig& config,
+                              const RecordedLevels* levels)
+{
+    if (open_ != 0 && inTick_) {
+        commit();  // the previous tick is whole
+    }
+    inTick_ = true;
+    if (open_ == 0 || writing_ + kTickReserve > kPayloadBytes) {
+        openBlock(atMs, epoch);
+    }
+    uint8_t buf[8];
+    buf[0] = tag(kTick, 0);
+    append(buf, 1 + putVarint(buf + 1, clampedDelta(atMs - tickMs_)));
+    tickMs_ = atMs;
+
+    // The reader's clock: the last one plus whole elapsed seconds, which
+    // lands on the epoch or one short of it.
+    const uint32_t predicted =
+        clockEpoch_ == 0 ? 0
+                         : clockEpoch_ + static_cast<uint32_t>((atMs - clockMs_) / 1000);
+    if (epoch != predicted && !(predicted != 0 && epoch == predicted + 1)) {
+        buf[0] = tag(kClock, 0);
+        putU32(buf + 1, epoch);
+        append(buf, 5);
+        clockMs_ = atMs;
+        clockEpoch_ = epoch;
+    }
+
+    for (std::size_t i = 0; i < kConfigItems; ++i) {
+        if (!configKnown_ || !sameBits(config.values[i], config_.values[i])) {
+            buf[0] = tag(kConfig, static_cast<uint8_t>(i));
+            putF32(buf + 1, config.values[i]);
+            append(buf, 5);
+        }
+    }
+    config_ = config;
+    configKnown_ = true;
+
+    if (levels != nullptr && (!levelsKnown_ || *levels != levels_)) {
+        buf[0] = tag(kLevels, levels->bits());
+        append(buf, 1);
+        levels_ = *levels;
+        levelsKnown_ = true;
+    }
+}
+
+void InputRecorder::appendSoil(std::size_t zone, uint8_t flags, const TimedSoilSnapshot& sample,
+                               bool withMoisture)
+{
+    uint8_t buf[11];
+    std::size_t n = 0;
+    buf[n++] = tag(kSoil, static_cast<uint8_t>(zone));
+    flags |= (sample.soil.readOk ? kSoilReadOk : 0) |
+             (sample.soil.available ? kSoilAvailable : 0) | (sample.suspect ? kSoilSuspect : 0) |
+             static_cast<uint8_t>((static_cast<uint8_t>(sample.group) & 0x3) << kSoilGroupShift) |
+             (withMoisture ? 0 : kSoilSameMoisture);
+    buf[n++] = flags;
+    if (withMoisture) {
+        putF32(buf + n, sample.soil.moisture);
+        n += 4;
+    }
+    n += putVarint(buf + n, clampedDelta(tickMs_ - sample.atMs));
+    append(buf, n);
+}
+
+void InputRecorder::soil(std::size_t zone, const TimedSoilSnapshot& sample)
+{
+    if (!inTick_ || zone >= kMaxZones || sample.sequence == 0 ||
+        sample.sequence == soil_[zone].sequence) {
+        return;
+    }
+    const bool moved = soil_[zone].sequence == 0 ||
+                       !sameBits(sample.soil.moisture, soil_[zone].soil.moisture);
+    appendSoil(zone, 0, sample, moved);
+    soil_[zone] = sample;
+}
+
+void InputRecorder::pump(uint8_t id, bool running)
+{
+    if (!inTick_ || id >= kPumps) {
+        return;
+    }
+    const uint8_t bit = static_cast<uint8_t>(1u << id);
+    if ((pumpsSeen_ & bit) != 0 && pumps_[id] == running) {
+        return;
+    }
+    const uint8_t rec = tag(kPump, static_cast<uint8_t>(id | (running ? kPumpRunning : 0)));
+    append(&rec, 1);
+    pumps_[id] = running;
+    pumpsSeen_ |= bit;
+}
+
+uint32_t InputRecorder::newest() const
+{
+    std::lock_guard<StaticMutex> lock(mutex_);
+    return open_;
+}
+
+uint32_t InputRecorder::oldest() const
+{
+    std::lock_guard<StaticMutex> lock(mutex_);
+    return open_ > blocks_ ? open_ - static_cast<uint32_t>(blocks_) + 1 : (open_ != 0 ? 1 : 0);
+}
+
+std::size_t InputRecorder::copyBlock(uint32_t sequence, uint8_t* out) const
+{
+    std::lock_guard<StaticMutex> lock(mutex_);
+    if (sequence == 0 || sequence > open_ || open_ - sequence >= blocks_) {
+        return 0;
+    }
+    const std::size_t used = used_[(sequence - 1) % blocks_];
+    std::memcpy(out, kMagic, sizeof(kMagic));
+    putU32(out + 4, sequence);
+    out[8] = static_cast<uint8_t>(used);
+    out[9] = static_cast<uint8_t>(used >> 8);
+    out[10] = 0;
+    out[11] = 0;
+    std::memcpy(out + kHeaderBytes, slot(sequence), used);
+    return kHeaderBytes + used;
+}
@@ -0,0 +1,188 @@
+// SPDX-FileCopyrightText: 2026 Cryptotomte
+// SPDX-License-Identifier: AGPL-3.0-or-later
+/**
+ * @file PumpUsage.cpp
+ * @brief Run edges, bucket updates and the lazy history restore (see
+ *        PumpUsage.h).
+ */
+
+#include "control/PumpUsage.h"
+
+#include <cmath>
+#include <vector>
+
+namespace {
+
+constexpr uint32_t kHourS = 3600;
+constexpr uint32_t kDayS = 86400;
+
+/// Add one run to the slot of the @p span-long bucket holding @p epoch; a
+/// run older than the bucket the slot already holds has fallen off the ring.
+template <std::size_t N>
+void addToRing(std::array<PumpUsageBucket, N>& ring, uint32_t span, uint32_t epoch,
+               uint32_t runMs)
+{
+    const uint32_t start = epoch - epoch % span;
+    PumpUsageBucket& slot = ring[(epoch / span) % N];
+    if (slot.starts != 0 && slot.start > start) {
+        return;
+    }
+    if (slot.start != start) {
+        slot = PumpUsageBucket{start, 0, 0};  // an older bucket: reuse it
+    }
+    slot.runMs += runMs;
+    ++slot.starts;
+}
+
+/// Copy the N buckets ending with the one holding @p now, oldest first; a
+/// slot still holding an older bucket reads as empty.
+template <std::size_t N>
+void window(const std::array<PumpUsageBucket, N>& ring, uint32_t span, uint32_t now,
+            std::array<PumpUsageBucket, N>& out)
+{
+    const uint32_t newest = now / span;
+    for (std::size_t i = 0; i < N; ++i) {
+        const uint32_t index = newest - static_cast<uint32_t>(N - 1 - i);
+        const PumpUsageBucket& slot = ring[index % N];
+        out[i] = slot.start == index * span ? slot : PumpUsageBucket{index * span, 0, 0};
+    }
+}
+
+}  // namespace
+
+std::string PumpUsage::metricFor(std::string_view name)
+{
+    std::string metric("pump_");
+    metric.append(name.data(), name.size());
+    return metric;
+}
+
+bool PumpUsage::addPump(const char* name, const IWaterPump& pump)
+{
+    if (name == nullptr || count_ == kMaxPumps) {
+        return false;
+    }
+    Pump& slot = pumps_[count_];
+    slot.name = name;
+    slot.pump = &pump;
+    slot.metric = metricFor(name);
+    slot.batch[0].metric = slot.metric;
+    slot.batch[1].metric = slot.metric + kVolumeSuffix;
+    slot.batch[2].metric = slot.metric + kFlowSuffix;
+    slot.running = pump.isRunning();
+    slot.startAccumulatedMs = pump.getAccumulatedRunTimeMs();
+    ++count_;
+    return true;
+}
+
+void PumpUsage::poll()
+{
+    const WallTime now = clock_.now();
+    if (now.set && timedSince_ == 0) {
+        std::lock_guard<StaticMutex> lock(mutex_);
+        timedSince_ = now.epoch;
+    }
+    for (std::size_t i = 0; i < count_; ++i) {
+        Pump& p = pumps_[i];
+        const bool running = p.pump->isRunning();
+        if (running == p.running) {
+            continue;
+        }
+        p.running = running;
+        if (running) {
+            p.startedAt = now;
+            p.startAccumulatedMs = p.pump->getAccumulatedRunTimeMs();
+            continue;
+        }
+        const int64_t ranMs = p.pump->getAccumulatedRunTimeMs() - p.startAccumulatedMs;
+        const uint32_t runMs = ranMs <= 0 ? 0 : static_cast<uint32_t>(ranMs);
+        if (!p.startedAt.set) {
+            std::lock_guard<StaticMutex> lock(mutex_);
+            ++p.untimedRuns;
+            continue;
+        }
+        {
+            std::lock_guard<StaticMutex> lock(mutex_);
+            addRun(p, p.startedAt.epoch, runMs);
+        }
+        // One batch per stop; the volume's run time is the meter's own.
+        const PumpRunVolume volume = p.pump->getLastRunVolume();
+        for (SensorReading& reading : p.batch) {
+            reading.epoch = p.startedAt.epoch;
+        }
+        p.batch[0].value = static_cast<float>(runMs) / 1000.0f;
+        p.batch[1].value = static_cast<float>(volume.volumeMl);
+        p.batch[2].value = volume.runMs > 0
+                               ? static_cast<float>(volume.volumeMl) * 60000.0f /
+                                     static_cast<float>(volume.runMs)
+                               : 0.0f;
+        storage_.storeSensorReadings(p.batch.data(), volume.metered ? 3 : 1);
+    }
+}
+
+void PumpUsage::addRun(Pump& pump, uint32_t startEpoch, uint32_t runMs)
+{
+    addToRing(pump.hours, kHourS, startEpoch, runMs);
+    addToRing(pump.days, kDayS, startEpoch, runMs);
+}
+
+bool PumpUsage::report(std::string_view name, Report& out)
+{
+    std::size_t index = 0;
+    while (index < count_ && name != pumps_[index].name) {
+        ++index;
+    }
+    if (index == count_) {
+        return false;
+    }
+    restore();
+
+    const WallTime now = clock_.now();
+    std::lock_guard<StaticMutex> lock(mutex_);
+    const Pump& p = pumps_[index];
+    out.timed = now.set;
+    out.untimedRuns = p.untimedRuns;
+    if (now.set) {
+        window(p.hours, kHourS, now.epoch, out.hours);
+        window(p.days, kDayS, now.epoch, out.days);
+    } else {
+        out.hours.fill(PumpUsageBucket{});
+        out.days.fill(PumpUsageBucket{});
+    }
+    return true;
+}
+
+void PumpUsage::restore()
+{
+    uint32_t until = 0;
+    {
+        std::lock_guard<StaticMutex> lock(mutex_);
+        if (restored_ || restoring_ || timedSince_ == 0) {
+            return;
+        }
+        restoring_ = true;
+        until = timedSince_;
+    }
+
+    // Every run stored at or after timedSince_ was timed this boot and is
+    // already in the rings; everything older comes from the history.
+    const uint32_t today = until - until % kDayS;
+    const uint32_t from = today >= (kDays - 1) * kDayS ? today - (kDays - 1) * kDayS : 0;
+    std::vector<std::vector<SensorReading>> stored(count_);
+    for (std::size_t i = 0; i < count_ && until > from; ++i) {
+        stored[i] = storage_.getSensorReadings(pumps_[i].metric, from, until - 1);
+    }
+
+    std::lock_guard<StaticMutex> lock(mutex_);
+    for (std::size_t i = 0; i < count_; ++i) {
+        for (const SensorReading& run : stored[i]) {
+            const float ms = run.value * 1000.0f;
+            if (!std::isfinite(ms) || ms < 0.0f) {
+                continue;
+            }
+            addRun(pumps_[i], run.epoch, static_cast<uint32_t>(std::lround(ms)));
+        }
+    }
+    restoring_ = false;
+    restored_ = true;
+}
@@ -12,9 +12,35 @@
 
 #include "control/WateringController.h"
 
+#include <algorithm>
+#include <cmath>
+
 void WateringController::tick()
 {
     const int64_t now = clock_.nowMs();
+    refreshSettings();
+    DecisionRecord rec;
+    decide(now, rec);
+    status_.gate = rec.gate;
+    status_.action = rec.action;
+    publishStatus();
+    if (trace_ != nullptr) {
+        // Plain stores into a fixed slot: cheap enough for every tick.
+        rec.atMs = now;
+        const WallTime wall = wallClock_.now();
+        rec.epoch = wall.set ? wall.epoch : 0;
+        rec.low = settings_.moistureThresholdLow;
+        rec.high = settings_.moistureThresholdHigh;
+        const int64_t soakEnd = soakEndsAtMs(now);
+        rec.soakLeftMs = soakEnd > 0 ? static_cast<uint32_t>(soakEnd - now) : 0;
+        rec.zone = traceZone_;
+        rec.flags |= plant_.isRunning() ? DecisionRecord::kPumpOn : 0;
+        trace_->record(rec);
+    }
+}
+
+void WateringController::decide(int64_t now, DecisionRecord& rec)
+{
 
     // Actuator layer first: enforce timed self-stop and the hard 300 s cap.
     plant_.update();
@@ -24,8 +50,8 @@ void WateringController::tick()
     // from the pause (FR-003). A stop we command at the high threshold sets the
     // same field inline below.
     if (burstActive_ && !plant_.isRunning()) {
-        lastBurstEndMs_ = now;
-        burstActive_ = false;
+        endBurst(now);
+        rec.flags |= DecisionRecord::kBurstEnded;
     }
 
     // ---- Read the sensor ONCE per tick (controller-as-reader: read() drives
@@ -36,30 +62,68 @@ void WateringController::tick()
     // one successful read on record": a sensor that has NEVER read OK is
     // !available -> "soil-unavailable"; a sensor that worked then stopped
     // responding keeps available true, the read fails, and it fails safe as
-    // "soil-stale". Both stop the pump — only the reason string differs. ------
-    soil_.read();                                // drives the bus, refreshes cache
-    const SoilSnapshot soil = soil_.snapshot();  // one coherent, non-blocking tuple
-    const bool readOk = soil.readOk;
+    // "soil-stale". Both stop the pump — only the reason string differs.
+    // With a feed the read already happened on the soil task: take its newest
+    // sample (non-blocking) and act on it only the first time it is seen. ---
+    SoilSnapshot soil;
+    int64_t readAtMs = now;
+    bool fresh = true;
+    bool suspect = false;
+    {
+        TickPhaseScope reading(latency_, TickPhase::SensorRead);
+        if (feed_ != nullptr) {
+            const TimedSoilSnapshot sample = feed_->latest();
+            soil = sample.soil;
+            readAtMs = sample.atMs;
+            suspect = sample.suspect;
+            // A slow-group-only read refreshed EC/pH/NPK, not the moisture.
+            fresh = sample.sequence != feedSequence_ && readsFastGroup(sample.group);
+            feedSequence_ = sample.sequence;
+        } else {
+            soil_.read();                // drives the bus, refreshes cache
+            soil = soil_.snapshot();     // one coherent, non-blocking tuple
+        }
+    }
+    const bool readOk = fresh && soil.readOk;
     const bool available = soil.available;       // ever-read-ok; no second probe
     const float moisture = soil.moisture;
     const bool inRange =
         moisture >= kMoistureMinPct && moisture <= kMoistureMaxPct;
     const bool invalid = readOk && !inRange;
+    rec.moisture = moisture;
+    rec.flags |= readOk ? DecisionRecord::kFresh : 0;
 
     // A fresh, in-range read is by definition not stale; record it before the
     // staleness test so the FIRST valid read is acted on (a fresh valid read is
-    // never "stale", even when lastValidSoilMs_ was still 0).
+    // never "stale", even when lastValidSoilMs_ was still 0). A fed sample
+    // counts from the time its read finished, not from this tick.
     if (readOk && inRange) {
-        lastValidSoilMs_ = now;
+        lastValidSoilMs_ = readAtMs;
+        if (response_ != nullptr) {
+            response_->sample(readAtMs, moisture, plant_.isRunning());
+        }
     }
     const bool stale =
         (lastValidSoilMs_ == 0) || (now - lastValidSoilMs_ > kStalenessMs);
 
+    // A flatlined probe is reported once, when the feed first flags it and
+    // in every mode: a frozen reading above the low threshold starves the
+    // bed with the pump idle, so nothing else would ever say so.
+    const bool flatlineStarted = suspect && !flatlineReported_;
+    flatlineReported_ = suspect;
+    if (flatlineStarted) {
+        TickPhaseScope event(latency_, TickPhase::Events);
+        events_.logFailsafe("soil-flatline");
+    }
+
     // ---- PERIODIC DATA-LOG (runs in EVERY mode, before any early return) ----
     // Telemetry must be recorded even when automatic watering is disabled, a
     // manual override is active, or a fail-safe is about to fire (FR-014). Soil
     // is logged only when this tick's read was successful and in range.
-    maybeLogData(now, /*soilValid=*/(readOk && inRange), soil);
+    if (logsData_) {
+        TickPhaseScope logging(latency_, TickPhase::Logging);
+        maybeLogData(now, /*soilValid=*/(readOk && inRange), soil);
+    }
 
     // ---- MANUAL OVERRIDE (bypasses fail-safe + soak/decision logic) --------
     // A manual run is an explicit operator override (FR-007/008): it is exempt
@@ -69,12 +133,14 @@ void WateringController::tick()
         if (!plant_.isRunning()) {
             manualRunActive_ = false;
         }
+        rec.gate = DecisionGate::Manual;
         return;
     }
 
     // Automatic path only. When automatic watering is disabled the mode is
     // manual/suspended: take no automatic action.
-    if (!config_.getWateringEnabled()) {
+    if (!settings_.wateringEnabled) {
+        rec.gate = DecisionGate::Disabled;
         return;
     }
 
@@ -83,18 +149,41 @@ void WateringController::tick()
     const char* failsafeReason = nullptr;
     if (!available) {
         failsafeReason = "soil-unavailable";
+        rec.gate = DecisionGate::Unavailable;
     } else if (invalid) {
         failsafeReason = "moisture-invalid";
+        rec.gate = DecisionGate::Invalid;
     } else if (stale) {
         failsafeReason = "soil-stale";
+        rec.gate = DecisionGate::Stale;
+    } else if (suspect) {
+        failsafeReason = "soil-flatline";
+        rec.gate = DecisionGate::Flatline;
     }
     if (failsafeReason != nullptr) {
         if (plant_.isRunning()) {
             plant_.stop();
-            events_.logFailsafe(failsafeReason);
+            // A flatline that starts on this tick was logged above.
+            if (!(flatlineStarted && rec.gate == DecisionGate::Flatline)) {
+                TickPhaseScope event(latency_, TickPhase::Events);
+                events_.logFailsafe(failsafeReason);
+            }
+            rec.action = DecisionAction::StopFailsafe;
         }
         // Abandon any in-flight automatic burst; take no watering decision.
-        burstActive_ = false;
+        abandonBurst(now);
+        return;
+    }
+
+    // ---- SCHEDULE (after the fail-safe, which it never delays) ------------
+    // A window closing or a blackout starting ends the automatic burst
+    // there, like a stop at the high threshold: the soak pause runs from it.
+    const bool inWindow = scheduleAllows();
+    if (!inWindow && burstActive_) {
+        plant_.stop();
+        endBurst(now);
+        rec.gate = DecisionGate::Schedule;
+        rec.action = DecisionAction::StopSchedule;
         return;
     }
 
@@ -102,37 +191,58 @@ void WateringController::tick()
     // valid reading is still within the staleness window is not a fail-safe
     // condition — wait for fresh data rather than act on placeholder values.
     if (!readOk) {
+        rec.gate = DecisionGate::NoFreshRead;
         return;
     }
 
     // ---- WATERING DECISION (soak gate is the LAST thing checked) -----------
-    const float lowThreshold = config_.getMoistureThresholdLow();
-    const float highThreshold = config_.getMoistureThresholdHigh();
+    const float lowThreshold = settings_.moistureThresholdLow;
+    const float highThreshold = settings_.moistureThresholdHigh;
 
     if (plant_.isRunning()) {
+        rec.gate = DecisionGate::Running;
         if (moisture >= highThreshold) {
             // Target reached: stop and arm the soak pause from this burst end.
             plant_.stop();
-            lastBurstEndMs_ = now;
-            burstActive_ = false;
+            endBurst(now);
+            rec.gate = DecisionGate::High;
+            rec.action = DecisionAction::StopHigh;
         }
         // else: keep running within the burst.
         return;
     }
 
-    if (moisture <= lowThreshold) {
-        const int64_t soakMs =
-            static_cast<int64_t>(config_.getMinWateringIntervalS()) * 1000;
+    rec.gate = moisture > lowThreshold ? DecisionGate::NotDry : DecisionGate::Schedule;
+    if (moisture <= lowThreshold && inWindow) {
         const bool soakElapsed =
-            (lastBurstEndMs_ == 0) || (now - lastBurstEndMs_ >= soakMs);
-        if (soakElapsed) {
-            if (plant_.runFor(static_cast<int>(config_.getWateringDurationS()))) {
+            (lastBurstEndMs_ == 0) || (now - lastBurstEndMs_ >= soakMs());
+        rec.gate = soakElapsed ? DecisionGate::Budget : DecisionGate::Soak;
+        // Pump budget last: a zone waiting for a slot keeps asking each tick.
+        if (soakElapsed && (budget_ == nullptr || budget_->tryAcquire())) {
+            budgetHeld_ = budget_ != nullptr;
+            int durationS = static_cast<int>(settings_.wateringDurationS);
+            if (response_ != nullptr) {
+                durationS = response_->burstSeconds(
+                    moisture, highThreshold, durationS,
+                    static_cast<int>(IConfigStore::kWateringDurationMaxS), soakMs());
+            }
+            rec.gate = DecisionGate::Dry;
+            rec.burstS = static_cast<uint16_t>(durationS);
+            if (plant_.runFor(durationS)) {
                 burstActive_ = true;
+                rec.action = DecisionAction::StartBurst;
+                if (response_ != nullptr) {
+                    response_->burstStarted(now, moisture);
+                }
+            } else {
+                releaseBudget();
+                rec.action = DecisionAction::StartFailed;
             }
         }
         // else: soak pause active — do NOT start another burst, even though the
         // soil still reads dry (FR-003).
     }
+    // else if dry: outside the watering windows — wait for the next one.
 }
 
 bool WateringController::startManual(int durationS)
@@ -149,6 +259,26 @@ bool WateringController::startManual(int durationS)
     const bool started = plant_.runFor(clamped);
     if (started) {
         manualRunActive_ = true;
+        // Unsized water: nothing to learn until it has soaked in.
+        if (response_ != nullptr) {
+            response_->disturbed(clock_.nowMs() + clamped * 1000 + soakMs());
+        }
+        publishStatus();
+    }
+    return started;
+}
+
+bool WateringController::startManualVolume(int volumeMl)
+{
+    constexpr int kMaxVolumeRunS = 300;  // the pump's hard cap
+    const bool started = plant_.runForVolume(volumeMl, kMaxVolumeRunS);
+    if (started) {
+        manualRunActive_ = true;
+        // Worst case the cap, as for a timed run.
+        if (response_ != nullptr) {
+            response_->disturbed(clock_.nowMs() + kMaxVolumeRunS * 1000 + soakMs());
+        }
+        publishStatus();
     }
     return started;
 }
@@ -157,19 +287,36 @@ void WateringController::stop()
 {
     plant_.stop();
     manualRunActive_ = false;
+    publishStatus();
+}
+
+bool WateringController::addSoilProbe(ISoilSensor& probe)
+{
+    if (probeCount_ == probes_.size()) {
+        return false;
+    }
+    probes_[probeCount_++] = &probe;
+    return true;
 }
 
 void WateringController::maybeLogData(int64_t now, bool soilValid,
                                      const SoilSnapshot& soil)
 {
+    // Commit write-behind history whose deadline has passed (a no-op for
+    // per-record durable storage). Ahead of every gate below so the
+    // durability window stays bounded by one tick, logging due or not.
+    storage_.flushIfDue();
+
     // No plausible wall-clock timestamp yet — never log a bogus 1970 epoch.
-    if (!wallClock_.isTimeSet()) {
+    // One reading: the epoch below is the one that was checked.
+    const WallTime wall = wallClock_.now();
+    if (!wall.set) {
         return;
     }
 
     // Interval gate: the first eligible log after time is set fires immediately
     // (lastDataLogMs_ == 0 counts as due); otherwise wait out the interval.
-    const int64_t interval = static_cast<int64_t>(config_.getDataLogIntervalMs());
+    const int64_t interval = static_cast<int64_t>(settings_.dataLogIntervalMs);
     const bool due =
         (lastDataLogMs_ == 0) || (now - lastDataLogMs_ >= interval);
     if (!due) {
@@ -177,44 +324,275 @@ void WateringController::maybeLogData(int64_t now, bool soilValid,
     }
     lastDataLogMs_ = now;
 
-    const uint32_t epoch = wallClock_.nowEpoch();
+    const uint32_t epoch = wall.epoch;
 
-    // Environmental telemetry (only on a successful, available read).
-    if (env_.read() && env_.isAvailable()) {
-        storage_.storeSensorReading("env_temperature", epoch,
-                                    env_.getTemperature());
-        storage_.storeSensorReading("env_humidity", epoch, env_.getHumidity());
-        storage_.storeSensorReading("env_pressure", epoch, env_.getPressure());
+    // The whole pass is handed to storage as ONE batch (one lock, one commit
+    // per metric file). At most kMaxMetrics samples — the metric set below
+    // fits that budget — so a fixed array suffices, and samples name their
+    // metric by id (MetricRegistry.h), so no string is built at all.
+    MetricSample batch[IDataStorage::kMaxMetrics];
+    std::size_t count = 0;
+    auto add = [&](MetricId id, float value) {
+        if (keepSample(id, epoch, value)) {
+            batch[count] = MetricSample{id, epoch, value};
+            ++count;
+        }
+    };
+
+    // Environmental telemetry (only on a successful read). The three values
+    // come from one snapshot(), so the logged T/RH/P belong to one sample
+    // even if the sensor task reads in between. With setEnvAcquired() the
+    // sensor task's sample is taken as is — no second bus read — once per
+    // sequence number and only while fresh.
+    EnvSnapshot env;
+    if (envMaxAgeMs_ == 0) {
+        if (env_.read()) {
+            env = env_.snapshot();
+        }
+    } else {
+        env = env_.snapshot();
+        env.valid = env.valid && env.sequence != 0 && env.sequence != envSequence_ &&
+                    (env.atMs == 0 || now - env.atMs <= int64_t{envMaxAgeMs_});
+    }
+    if (env.valid) {
+        envSequence_ = env.sequence;
+        add(metric::kEnvTemperature, env.temperature);
+        add(metric::kEnvHumidity, env.humidity);
+        add(metric::kEnvPressure, env.pressure);
     }
 
     // Soil telemetry (uses the values from this tick's single snapshot(), so
     // the logged values match the values tick() decided on — one read/tick).
     if (soilValid) {
-        storage_.storeSensorReading("soil_moisture", epoch, soil.moisture);
-        storage_.storeSensorReading("soil_temperature", epoch,
-                                    soil.temperature);
+        add(metric::kSoilMoisture, soil.moisture);
+        add(metric::kSoilTemperature, soil.temperature);
         // NOTE: soil humidity is deliberately NOT logged. ISoilSensor's
         // getHumidity() is documented as identical to getMoisture() (a single
         // moisture/humidity quantity in register 0x0000; the legacy driver
         // exposed it under both names), so logging it would be a pure duplicate
-        // of soil_moisture. Dropping it keeps the max distinct metric set at
-        // exactly kMaxMetrics (10): 3 env + 4 soil-base + 3 NPK.
-        storage_.storeSensorReading("soil_ph", epoch, soil.ph);
-        storage_.storeSensorReading("soil_ec", epoch, soil.ec);
-
-        // NPK is only meaningful when >= 0 (the sensor reports -1 when a
-        // channel is unsupported/unavailable); skip a negative channel.
-        const float n = soil.nitrogen;
-        const float p = soil.phosphorus;
-        const float k = soil.potassium;
-        if (n >= 0) {
-            storage_.storeSensorReading("soil_nitrogen", epoch, n);
+        // of soil_moisture. Dropping it keeps the primary probe's metric set
+        // at 3 env + 4 soil-base + 3 NPK.
+        // EC/pH/NPK may come from an earlier (slow-group) read than the
+        // moisture; they are logged once one is on record.
+        if (soil.slowAvailable) {
+            add(metric::kSoilPh, soil.ph);
+            add(metric::kSoilEc, soil.ec);
+
+            // NPK is only meaningful when >= 0 (the sensor reports -1 when a
+            // channel is unsupported/unavailable); skip a negative channel.
+            const float n = soil.nitrogen;
+            const float p = soil.phosphorus;
+            const float k = soil.potassium;
+            if (n >= 0) {
+                add(metric::kSoilNitrogen, n);
+            }
+            if (p >= 0) {
+                add(metric::kSoilPhosphorus, p);
+            }
+            if (k >= 0) {
+                add(metric::kSoilPotassium, k);
+            }
+        }
+    }
+
+    // Further probes: the scheduler's last read of each, moisture only.
+    for (std::size_t i = 0; i < probeCount_; ++i) {
+        const SoilSnapshot probe = probes_[i]->snapshot();
+        if (probe.readOk && probe.moisture >= kMoistureMinPct &&
+            probe.moisture <= kMoistureMaxPct) {
+            add(metric::soilMoisture(i + 1), probe.moisture);
         }
-        if (p >= 0) {
-            storage_.storeSensorReading("soil_phosphorus", epoch, p);
+    }
+
+    if (count > 0) {
+        storage_.storeSamples(batch, count);
+    }
+}
+
+bool WateringController::keepSample(MetricId id, uint32_t epoch, float value)
+{
+    LoggedPoint& last = lastLogged_[id];
+    const MetricLogPolicy& policy = settings_.logPolicies[id];
+    // Skip only inside the heartbeat of the last logged point (a wall-clock
+    // step backwards counts as elapsed) and inside the deadband around it.
+    if (policy.heartbeatS != 0 && last.valid && epoch >= last.epoch &&
+        epoch - last.epoch < policy.heartbeatS) {
+        const float band = std::max(policy.deadbandAbs,
+                                    policy.deadbandRel * std::fabs(last.value));
+        if (std::fabs(value - last.value) <= band) {
+            ++skippedSamples_;
+            return false;
+        }
+    }
+    last = LoggedPoint{true, epoch, value};
+    return true;
+}
+
+int64_t WateringController::nextDeadlineMs(int64_t now) const
+{
+    int64_t deadline = INT64_MAX;
+    // tick() treats the sample as stale once MORE than kStalenessMs old.
+    const int64_t staleAt = lastValidSoilMs_ + kStalenessMs + 1;
+    if (lastValidSoilMs_ != 0 && staleAt > now) {
+        deadline = staleAt;
+    }
+    const int64_t logAt =
+        lastDataLogMs_ + static_cast<int64_t>(settings_.dataLogIntervalMs);
+    if (lastDataLogMs_ != 0 && logAt > now && logAt < deadline) {
+        deadline = logAt;
+    }
+    const WallTime wall = wallClock_.now();
+    if (schedule_ != nullptr && wall.set) {
+        const int64_t edgeAt =
+            monotonicAt(schedule_->nextEdge(wall.epoch), now);
+        if (edgeAt > now && edgeAt < deadline) {
+            deadline = edgeAt;
         }
-        if (k >= 0) {
-            storage_.storeSensorReading("soil_potassium", epoch, k);
+    }
+    return deadline;
+}
+
+int64_t WateringController::soakEndsAtMs(int64_t now) const
+{
+    if (lastBurstEndMs_ == 0) {
+        return 0;
+    }
+    const int64_t endsAt = lastBurstEndMs_ + soakMs();
+    return endsAt > now ? endsAt : 0;
+}
+
+void WateringController::saveState(WateringControllerState& out) const
+{
+    const int64_t now = clock_.nowMs();
+    out = {};
+    if (burstActive_) {
+        out.burstEndAgeMs = 0;
+    } else {
+        out.burstEndAgeMs = lastBurstEndMs_ == 0 ? -1 : now - lastBurstEndMs_;
+    }
+    out.dataLogAgeMs = lastDataLogMs_ == 0 ? -1 : now - lastDataLogMs_;
+    for (std::size_t i = 0; i < lastLogged_.size(); ++i) {
+        out.lastLogged[i].epoch = lastLogged_[i].epoch;
+        out.lastLogged[i].value = lastLogged_[i].value;
+        out.lastLogged[i].valid = lastLogged_[i].valid ? 1 : 0;
+    }
+    out.skippedSamples = skippedSamples_;
+}
+
+void WateringController::restoreState(const WateringControllerState& state,
+                                      int64_t elapsedMs)
+{
+    const int64_t now = clock_.nowMs();
+    // Before this boot's clock started the times come out negative; only
+    // exactly 0 would read as "none", so it is nudged back by 1 ms.
+    auto placed = [&](int64_t ageMs) -> int64_t {
+        if (ageMs < 0) {
+            return 0;
         }
+        const int64_t at = now - ageMs - (elapsedMs > 0 ? elapsedMs : 0);
+        return at == 0 ? -1 : at;
+    };
+    lastBurstEndMs_ = placed(state.burstEndAgeMs);
+    lastDataLogMs_ = placed(state.dataLogAgeMs);
+    for (std::size_t i = 0; i < lastLogged_.size(); ++i) {
+        lastLogged_[i] = LoggedPoint{state.lastLogged[i].valid != 0,
+                                     state.lastLogged[i].epoch,
+                                     state.lastLogged[i].value};
+    }
+    skippedSamples_ = state.skippedSamples;
+    publishStatus();
+}
+
+void WateringController::publishStatus()
+{
+    status_.lastValidSoilMs = lastValidSoilMs_;
+    status_.soakEndsAtMs = lastBurstEndMs_ == 0 ? 0 : lastBurstEndMs_ + soakMs();
+    status_.skippedSamples = skippedSamples_;
+    status_.burstActive = burstActive_;
+    status_.manualRunActive = manualRunActive_;
+    published_.publish(status_);
+}
+
+int64_t WateringController::windowOpensAtMs(int64_t now) const
+{
+    const WallTime wall = wallClock_.now();
+    if (schedule_ == nullptr || !wall.set) {
+        return 0;
+    }
+    return monotonicAt(schedule_->nextOpening(wall.epoch), now);
+}
+
+bool WateringController::scheduleAllows() const
+{
+    if (schedule_ == nullptr) {
+        return true;
+    }
+    const WallTime wall = wallClock_.now();
+    return !wall.set || schedule_->allows(wall.epoch);
+}
+
+int64_t WateringController::monotonicAt(uint32_t epoch, int64_t now) const
+{
+    const WallTime wall = wallClock_.now();
+    if (epoch == 0 || !wall.set) {
+        return 0;
+    }
+    const int64_t aheadS =
+        static_cast<int64_t>(epoch) - static_cast<int64_t>(wall.epoch);
+    return now + aheadS * 1000;
+}
+
+int64_t WateringController::soakMs() const
+{
+    return static_cast<int64_t>(settings_.minWateringIntervalS) * 1000;
+}
+
+void WateringController::endBurst(int64_t now)
+{
+    lastBurstEndMs_ = now;
+    burstActive_ = false;
+    releaseBudget();
+    if (response_ != nullptr) {
+        response_->burstEnded(now, soakMs());
+    }
+}
+
+void WateringController::abandonBurst(int64_t now)
+{
+    if (burstActive_ && response_ != nullptr) {
+        response_->burstEnded(now, soakMs());
+    }
+    burstActive_ = false;
+    releaseBudget();
+}
+
+void WateringController::releaseBudget()
+{
+    if (budgetHeld_) {
+        budget_->release();
+        budgetHeld_ = false;
+    }
+}
+
+void WateringController::refreshSettings()
+{
+    const uint32_t generation = config_.generation();
+    if (settingsLoaded_ && generation == settingsGeneration_) {
+        return;
+    }
+    settings_ = config_.snapshot();
+    if (zone_.moistureThresholdLow > 0.0f) {
+        settings_.moistureThresholdLow = zone_.moistureThresholdLow;
+    }
+    if (zone_.moistureThresholdHigh > 0.0f) {
+        settings_.moistureThresholdHigh = zone_.moistureThresholdHigh;
+    }
+    if (zone_.wateringDurationS != 0) {
+        settings_.wateringDurationS = zone_.wateringDurationS;
+    }
+    if (dataLogOverrideMs_ != 0) {
+        settings_.dataLogIntervalMs = dataLogOverrideMs_;
     }
+    settingsGeneration_ = generation;
+    settingsLoaded_ = true;
 }
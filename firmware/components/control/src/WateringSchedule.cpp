@@ -0,0 +1,245 @@
+// SPDX-FileCopyrightText: 2026 Cryptotomte
+// SPDX-License-Identifier: AGPL-3.0-or-later
+/**
+ * @file WateringSchedule.cpp
+ * @brief Implementation of the weekly watering windows and their parser.
+ */
+
+#include "control/WateringSchedule.h"
+
+#include <cctype>
+#include <cstring>
+#include <ctime>
+
+namespace {
+
+/// Days a rule can start on before @p epoch's day and still cover it (a
+/// past-midnight window), and after it that still hold the next edge.
+constexpr int kDaysBefore = 1;
+constexpr int kDaysAfter = 7;
+
+/// Local midnight @p offset days from @p day (a normalized local tm).
+std::tm dayAt(const std::tm& day, int offset)
+{
+    std::tm t = day;
+    t.tm_mday += offset;
+    t.tm_hour = 12;  // normalize at noon: never in a DST gap
+    t.tm_min = 0;
+    t.tm_sec = 0;
+    t.tm_isdst = -1;
+    std::mktime(&t);
+    return t;
+}
+
+/// Epoch of local minute @p minute of @p day (midnight-relative, may be
+/// >= 1440 for the next day); mktime() resolves DST.
+uint32_t epochAt(const std::tm& day, int minute)
+{
+    std::tm t = day;
+    t.tm_hour = 0;
+    t.tm_min = minute;
+    t.tm_sec = 0;
+    t.tm_isdst = -1;
+    return static_cast<uint32_t>(std::mktime(&t));
+}
+
+constexpr const char* kDayNames[7] = {"Su", "Mo", "Tu", "We", "Th", "Fr", "Sa"};
+
+int parseDay(const char*& p)
+{
+    for (int d = 0; d < 7; ++d) {
+        if (std::strncmp(p, kDayNames[d], 2) == 0) {
+            p += 2;
+            return d;
+        }
+    }
+    return -1;
+}
+
+/// "HH:MM" -> minute of the day, or -1.
+int parseClock(const char*& p)
+{
+    int value[2] = {0, 0};
+    for (int part = 0; part < 2; ++part) {
+        if (part == 1 && *p++ != ':') {
+            return -1;
+        }
+        int digits = 0;
+        for (; std::isdigit(static_cast<unsigned char>(*p)) != 0 && digits < 2; ++p) {
+            value[part] = value[part] * 10 + (*p - '0');
+            ++digits;
+        }
+        if (digits == 0) {
+            return -1;
+        }
+    }
+    if (value[0] > 23 || value[1] > 59) {
+        return -1;
+    }
+    return value[0] * 60 + value[1];
+}
+
+void skipSpaces(const char*& p)
+{
+    while (std::isspace(static_cast<unsigned char>(*p)) != 0) {
+        ++p;
+    }
+}
+
+}  // namespace
+
+bool WateringSchedule::add(const ScheduleRule& rule)
+{
+    if (count_ == rules_.size() || (rule.days & 0x7F) == 0 ||
+        rule.startMin >= kMinutesPerDay || rule.endMin >= kMinutesPerDay ||
+        rule.startMin == rule.endMin) {
+        return false;
+    }
+    rules_[count_++] = rule;
+    cached_ = false;
+    return true;
+}
+
+bool WateringSchedule::allows(uint32_t epoch) const
+{
+    refresh(epoch);
+    return cachedAllows_;
+}
+
+uint32_t WateringSchedule::nextEdge(uint32_t epoch) const
+{
+    refresh(epoch);
+    return cachedUntil_;
+}
+
+uint32_t WateringSchedule::nextOpening(uint32_t epoch) const
+{
+    refresh(epoch);
+    return cachedOpening_;
+}
+
+void WateringSchedule::refresh(uint32_t epoch) const
+{
+    if (cached_ && epoch >= cachedFrom_ && (cachedUntil_ == 0 || epoch < cachedUntil_)) {
+        return;
+    }
+    cachedFrom_ = epoch;
+    cachedAllows_ = evaluate(epoch, cachedUntil_);
+    cachedOpening_ = 0;
+    // Closed: walk the edges to the one that opens (every rule recurs
+    // within a week, so a bounded walk finds it if any does).
+    uint32_t at = cachedUntil_;
+    for (std::size_t n = 0; !cachedAllows_ && at != 0 && n < 2 * kMaxRules * kDaysAfter;
+         ++n) {
+        uint32_t next = 0;
+        if (evaluate(at, next)) {
+            cachedOpening_ = at;
+            break;
+        }
+        at = next;
+    }
+    cached_ = true;
+}
+
+bool WateringSchedule::evaluate(uint32_t epoch, uint32_t& nextEdge) const
+{
+    nextEdge = 0;
+    if (count_ == 0) {
+        return true;
+    }
+    const std::time_t now = static_cast<std::time_t>(epoch);
+    std::tm today{};
+    localtime_r(&now, &today);
+
+    bool anyWindow = false;
+    bool inWindow = false;
+    bool inBlackout = false;
+    auto edge = [&](uint32_t at) {
+        if (at > epoch && (nextEdge == 0 || at < nextEdge)) {
+            nextEdge = at;
+        }
+    };
+    for (int offset = -kDaysBefore; offset <= kDaysAfter; ++offset) {
+        const std::tm day = dayAt(today, offset);
+        for (std::size_t i = 0; i < count_; ++i) {
+            const ScheduleRule& r = rules_[i];
+            anyWindow = anyWindow || !r.blackout;
+            if ((r.days & (1u << day.tm_wday)) == 0) {
+                continue;
+            }
+            const int endMin =
+                r.endMin > r.startMin ? r.endMin : r.endMin + kMinutesPerDay;
+            const uint32_t start = epochAt(day, r.startMin);
+            const uint32_t end = epochAt(day, endMin);
+            if (start <= epoch && epoch < end) {
+                if (r.blackout) {
+                    inBlackout = true;
+                } else {
+                    inWindow = true;
+                }
+            }
+            edge(start);
+            edge(end);
+        }
+    }
+    return (!anyWindow || inWindow) && !inBlackout;
+}
+
+bool parseWateringSchedule(const char* text, WateringSchedule& out)
+{
+    if (text == nullptr) {
+        return true;
+    }
+    const char* p = text;
+    for (;;) {
+        skipSpaces(p);
+        if (*p == '\0') {
+            return true;
+        }
+        ScheduleRule rule;
+        if (*p == '!') {
+            rule.blackout = true;
+            ++p;
+        }
+        if (*p == '*') {
+            ++p;
+        } else {
+            const int first = parseDay(p);
+            int last = first;
+            if (*p == '-') {
+                ++p;
+                last = parseDay(p);
+            }
+            if (first < 0 || last < 0) {
+                return false;
+            }
+            rule.days = 0;
+            for (int d = first;; d = (d + 1) % 7) {
+                rule.days |= static_cast<uint8_t>(1u << d);
+                if (d == last) {
+                    break;
+                }
+            }
+        }
+        skipSpaces(p);
+        const int start = parseClock(p);
+        if (start < 0 || *p++ != '-') {
+            return false;
+        }
+        const int end = parseClock(p);
+        if (end < 0) {
+            return false;
+        }
+        rule.startMin = static_cast<uint16_t>(start);
+        rule.endMin = static_cast<uint16_t>(end);
+        if (!out.add(rule)) {
+            return false;
+        }
+        skipSpaces(p);
+        if (*p == ';') {
+            ++p;
+        } else if (*p != '\0') {
+            return false;
+        }
+    }
+}
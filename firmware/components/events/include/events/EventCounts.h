@@ -0,0 +1,139 @@
+// SPDX-FileCopyrightText: 2026 Cryptotomte
+// SPDX-License-Identifier: AGPL-3.0-or-later
+/**
+ * @file EventCounts.h
+ * @brief Per-category event counts in hourly buckets over the last day,
+ *        answered without reading the log.
+ *
+ * "How many fail-safes / resets / pump events in the last 24 h" used to be a
+ * getEvents() scan over flash. EventLogger now counts every stored event
+ * into one of kHours hourly buckets (slot = epoch hour % kHours), so
+ * summary() is a fixed 24 x kCategories sum under a short lock: no flash,
+ * no heap. A bucket whose hour has passed is reused by the first event of
+ * the new hour; an event older than its slot's hour (the clock stepped
+ * back) is not counted. Categories >= kCategories are not counted.
+ *
+ * PERSISTENCE: seal() writes the buckets into a CRC-checked EventCountBlock.
+ * main/lifetime_counters seals once a second into RTC_NOINIT memory
+ * (alternating two blocks) and copies the newest to NVS on the lifetime
+ * counters' flush cadence. At boot restore() adds a valid RTC block (a warm
+ * reset) to whatever was counted since; when none is valid (a power cycle)
+ * rebuild() recounts the last day from the event log itself and keeps, per
+ * bucket, the larger of that and the NVS checkpoint (events the ring has
+ * since overwritten).
+ *
+ * THREADS: record() from any producer task, summary() from any reader,
+ * seal() from the counters task; all under one StaticMutex held for a
+ * bucket update or one pass over the table. No IDF includes.
+ */
+
+#ifndef WATERINGSYSTEM_EVENTS_EVENTCOUNTS_H
+#define WATERINGSYSTEM_EVENTS_EVENTCOUNTS_H
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <initializer_list>
+#include <type_traits>
+
+#include "interfaces/IDataStorage.h"
+#include "interfaces/StaticMutex.h"
+
+/// The persisted form: fixed layout, checked by magic, version and CRC-32.
+/// Trivial (no initializers), so it can sit in RTC_NOINIT memory; value-
+/// initialize it ({}) elsewhere.
+struct EventCountBlock {
+    static constexpr uint32_t kMagic = 0x43455357u;  ///< "WSEC"
+    static constexpr uint16_t kVersion = 1;
+    static constexpr std::size_t kHours = 24;
+    static constexpr std::size_t kCategories = 8;
+
+    uint32_t magic;
+    uint16_t version;
+    uint16_t reserved;
+    uint32_t sequence;                       ///< bumped by every seal()
+    uint32_t hours[kHours];                  ///< epoch / 3600 of each slot
+    uint16_t counts[kHours][kCategories];
+    uint32_t crc;                            ///< CRC-32 of everything above
+};
+static_assert(std::is_trivial<EventCountBlock>::value,
+              "RTC_NOINIT memory is never constructed");
+
+/// Events of one category over a summary() window.
+struct EventCategoryCount {
+    uint8_t category = 0;
+    uint32_t count = 0;
+};
+
+/// summary() result: one count per counted category, index = category.
+struct EventCountSummary {
+    uint32_t hours = 0;   ///< window actually summed (clamped to kHours)
+    uint32_t since = 0;   ///< epoch of the oldest hour in the window
+    std::array<uint32_t, EventCountBlock::kCategories> counts{};
+};
+
+class EventCounts {
+public:
+    static constexpr std::size_t kHours = EventCountBlock::kHours;
+    static constexpr std::size_t kCategories = EventCountBlock::kCategories;
+    static constexpr uint32_t kSecondsPerHour = 3600;
+
+    EventCounts() = default;
+    EventCounts(const EventCounts&) = delete;
+    EventCounts& operator=(const EventCounts&) = delete;
+
+    /// Count one event of @p category stamped @p epoch. Saturates at
+    /// UINT16_MAX per bucket and category.
+    void record(uint32_t epoch, uint8_t category);
+
+    /**
+     * @brief Per-category counts of the @p hours hours up to and including
+     * the hour of @p nowEpoch (1..kHours; 0 or more than kHours means
+     * kHours). Buckets stamped after @p nowEpoch are left out.
+     */
+    EventCountSummary summary(uint32_t nowEpoch, uint32_t hours = kHours) const;
+
+    /// Write the buckets into @p out (sequence bumped, CRC set).
+    void seal(EventCountBlock& out);
+
+    /// Sequence of the newest seal() (or of the restored block).
+    uint32_t sequence() const;
+
+    /// True when @p block is intact and of this layout.
+    static bool valid(const EventCountBlock& block);
+
+    /**
+     * @brief Add the buckets of the valid candidate with the highest
+     * sequence (null candidates are skipped) onto what record() has counted
+     * since boot. For a warm reset: the block predates this boot's events.
+     * @return the candidate used, or nullptr (nothing changed)
+     */
+    const EventCountBlock* restore(std::initializer_list<const EventCountBlock*> candidates);
+
+    /**
+     * @brief Recount the day before the newest event in @p storage, then
+     * take per bucket the larger of that and @p checkpoint (when valid and
+     * of the same hour). For a cold boot: the log already holds this boot's
+     * events, so the counts since boot are replaced. Reads the log a page
+     * at a time.
+     * @return events read from the log
+     */
+    std::size_t rebuild(const IDataStorage& storage, const EventCountBlock* checkpoint);
+
+private:
+    struct Bucket {
+        uint32_t hour = 0;
+        std::array<uint16_t, kCategories> counts{};
+    };
+
+    /// Count into the bucket of @p hour; caller holds mutex_.
+    void addLocked(uint32_t hour, uint8_t category, uint32_t n);
+
+    static uint32_t crcOf(const EventCountBlock& block);
+
+    mutable StaticMutex mutex_;
+    std::array<Bucket, kHours> buckets_{};
+    uint32_t sequence_ = 0;
+};
+
+#endif /* WATERINGSYSTEM_EVENTS_EVENTCOUNTS_H */
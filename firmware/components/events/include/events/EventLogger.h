@@ -5,9 +5,12 @@
  * @brief Typed producers for the PR-06 persistent event log (feature 008 US2).
  *
  * Composes an IDataStorage& (the cross-task LockedDataStorage when shared) and
- * an IWallClock&; each producer picks the event category, builds a
- * deterministic detail string and calls storage.storeEvent(clock.nowEpoch(),
- * category, detail). Normative contract:
+ * an IWallClock&; each producer picks the event category, encodes a compact
+ * detail (event code plus arguments, interfaces/EventCodec.h) into a fixed
+ * stack buffer and calls storage.storeEvent(clock.nowEpoch(), category,
+ * detail). The documented detail text below is what renderEventDetail()
+ * gives back for it on the read side. No producer allocates, so the
+ * watering task's fail-safe and pump events cost no heap. Normative contract:
  * specs/008-sntp-watchdog-logging/contracts/event-logger.md.
  *
  * PURE by design: no IDF/esp_* includes, no WifiState/esp_reset_reason_t enums
@@ -20,25 +23,59 @@
  * counted (droppedEvents()) and dropped. A pure component cannot ESP_LOGW, so
  * the counter is the surfaced signal — target callers may log it periodically.
  * Credential VALUES are never logged (WiFi events carry the state name only).
+ *
+ * Every stored event is also counted into counts() (EventCounts.h), the
+ * hourly per-category buckets behind /api/v1/events/summary, and signalled
+ * on notifier() (EventNotifier.h), which wakes the held
+ * /api/v1/events?wait= requests.
  */
 
 #ifndef WATERINGSYSTEM_EVENTS_EVENTLOGGER_H
 #define WATERINGSYSTEM_EVENTS_EVENTLOGGER_H
 
+#include <atomic>
 #include <cstdint>
-#include <string>
+#include <string_view>
 
+#include "events/EventCounts.h"
+#include "events/EventNotifier.h"
+#include "interfaces/EventCodec.h"  // resetReasonName()
 #include "interfaces/IDataStorage.h"
 #include "interfaces/IWallClock.h"
 
 /**
- * @brief Map an esp_reset_reason_t integer value to a short name.
- *
- * Pure free function (no IDF include): the caller passes
- * static_cast<int>(esp_reset_reason()). Total over the ESP_RST_* values defined
- * by IDF v6 (0..15); any other value returns "UNKNOWN". Host-tested.
+ * @brief Receives a copy of every event the logger stores (the live
+ * /api/v1/stream push), detail as stored (render it with
+ * renderEventDetail()). Called on the producer's task, after the store;
+ * must not block.
  */
-const char* resetReasonName(int espResetReason);
+class IEventTap {
+public:
+    virtual ~IEventTap() = default;
+    virtual void onEvent(uint32_t epoch, uint8_t category,
+                         std::string_view detail) = 0;
+};
+
+/**
+ * @brief Forwards every event to two taps, in order: the logger has one tap
+ * slot, shared by the live stream and the MQTT uplink.
+ */
+class EventTapPair final : public IEventTap {
+public:
+    EventTapPair(IEventTap& first, IEventTap& second)
+        : first_(first), second_(second) {}
+
+    void onEvent(uint32_t epoch, uint8_t category,
+                 std::string_view detail) override
+    {
+        first_.onEvent(epoch, category, detail);
+        second_.onEvent(epoch, category, detail);
+    }
+
+private:
+    IEventTap& first_;
+    IEventTap& second_;
+};
 
 /**
  * @brief Builds + persists typed events over an injected IDataStorage.
@@ -51,8 +88,8 @@ public:
         : storage_(storage), clock_(clock) {}
 
     /// kCategoryReset, detail "reset=<reasonName>" (e.g. "reset=TASK_WDT").
-    /// `reason` is the raw esp_reset_reason_t int; the detail is built from the
-    /// internal resetReasonName(reason) mapping so the name cannot mismatch.
+    /// `reason` is the raw esp_reset_reason_t int; the stored detail keeps it
+    /// and renders through resetReasonName(reason), so the name cannot mismatch.
     void logReset(int reason);
 
     /// kCategoryConnectivity, detail "wifi=<stateName>" (e.g. "wifi=Connected").
@@ -64,24 +101,57 @@ public:
     /// kCategoryPump, detail "pump=<pump> stop cause=<cause>".
     void logPumpStop(const char* pump, const char* cause);
 
-    /// kCategoryFailsafe, detail passed verbatim (producer is PR-11).
+    /// kCategoryPump, detail "pump=<pump> current peak=<A> mean=<A> rms=<A>
+    /// n=<samples> missed=<periods>" — one captured run's summary
+    /// (PumpCurrentCapture), amps to the milliamp; a run without a valid
+    /// sample prints "nan".
+    void logPumpCurrent(const char* pump, float peakA, float meanA, float rmsA,
+                        uint32_t samples, uint32_t missed);
+
+    /// kCategoryReset, detail "wdt-warn task=<task> interval=<ms>ms
+    /// timeout=<ms>ms" — a subscribed task went that long between watchdog
+    /// feeds, past the warning fraction of the timeout (a near-miss).
+    void logWatchdogWarning(const char* task, uint32_t intervalMs, uint32_t timeoutMs);
+
+    /// kCategoryReset, detail "tick-slow phase=<phase> tick=<ms>ms
+    /// budget=<ms>ms" — a watering tick overran its budget; @p phase took
+    /// the most of it (interfaces/TickLatency.h).
+    void logTickOverBudget(const char* phase, uint32_t tickMs, uint32_t budgetMs);
+
+    /// kCategoryFailsafe, detail passed verbatim as text (producer is PR-11).
     void logFailsafe(const char* detail);
 
-    /// kCategoryOta, detail passed verbatim (producer is PR-13).
+    /// kCategoryOta, detail passed verbatim as text (producer: main/ota_task).
     void logOta(const char* detail);
 
     /// Number of events dropped because storeEvent() returned false. Never
     /// resets; a pure component's only failure signal (no ESP_LOGW here).
     uint32_t droppedEvents() const { return droppedEvents_; }
 
+    /// Hourly per-category counts of the stored events (a dropped event is
+    /// not counted). Restored and sealed by the boot wiring.
+    EventCounts& counts() { return counts_; }
+    const EventCounts& counts() const { return counts_; }
+
+    /// Signalled after every stored event (a dropped one is not).
+    EventNotifier& notifier() { return notifier_; }
+
+    /// Install (or, with nullptr, remove) the tap. An atomic pointer, so it
+    /// can be set after producer tasks already log; @p tap must outlive the
+    /// logger or be removed first.
+    void setTap(IEventTap* tap) { tap_.store(tap, std::memory_order_release); }
+
 private:
     /// Single write path: stamp with the wall clock, store, count a failure.
     /// Never throws.
-    void emit(uint8_t category, const std::string& detail);
+    void emit(uint8_t category, std::string_view detail);
 
     IDataStorage& storage_;
     IWallClock& clock_;
     uint32_t droppedEvents_ = 0;
+    EventCounts counts_;
+    EventNotifier notifier_;
+    std::atomic<IEventTap*> tap_{nullptr};
 };
 
 #endif /* WATERINGSYSTEM_EVENTS_EVENTLOGGER_H */
@@ -0,0 +1,56 @@
+// SPDX-FileCopyrightText: 2026 Cryptotomte
+// SPDX-License-Identifier: AGPL-3.0-or-later
+/**
+ * @file EventNotifier.h
+ * @brief Wakes the waiters of the event log when an event is stored
+ *        (pure, host-tested).
+ *
+ * WHY THIS EXISTS: a client that wants new events used to poll
+ * /api/v1/events; a held GET /api/v1/events?after=&wait= request instead
+ * sleeps on this until EventLogger stores one. The notifier carries no
+ * event, only a generation that every stored event bumps: a waiter notes
+ * the generation before it reads the log, and a later generation means
+ * the log may hold something its read did not see.
+ *
+ * notify() is a counter bump and a condition-variable signal, on the
+ * producer's task; it never blocks past the short internal lock, so the
+ * watering task's events cost it nothing noticeable.
+ *
+ * Pure C++ (std::mutex/condition_variable, pthread-backed on ESP-IDF).
+ */
+
+#ifndef WATERINGSYSTEM_EVENTS_EVENTNOTIFIER_H
+#define WATERINGSYSTEM_EVENTS_EVENTNOTIFIER_H
+
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <mutex>
+
+class EventNotifier {
+public:
+    EventNotifier() = default;
+
+    EventNotifier(const EventNotifier&) = delete;
+    EventNotifier& operator=(const EventNotifier&) = delete;
+
+    /// An event was stored: bump the generation and wake every waiter.
+    void notify();
+
+    /// The current generation (wraps; compare for inequality only).
+    uint32_t generation() const { return generation_.load(std::memory_order_acquire); }
+
+    /**
+     * @brief Wait up to @p timeoutMs for the generation to move past
+     * @p seen; returns at once when it already has.
+     * @return the generation on return (== @p seen on a timeout)
+     */
+    uint32_t waitPast(uint32_t seen, uint32_t timeoutMs);
+
+private:
+    std::mutex mutex_;
+    std::condition_variable changed_;
+    std::atomic<uint32_t> generation_{0};
+};
+
+#endif /* WATERINGSYSTEM_EVENTS_EVENTNOTIFIER_H */
@@ -0,0 +1,198 @@
+// SPDX-FileCopyrightText: 2026 Cryptotomte
+// SPDX-License-Identifier: AGPL-3.0-or-later
+/**
+ * @file EventCounts.cpp
+ * @brief Hourly per-category event buckets (pure; see EventCounts.h).
+ */
+
+#include "events/EventCounts.h"
+
+#include <cstring>
+#include <mutex>
+
+namespace {
+
+/// Events per rebuild() page: bounds the heap of one queryEvents() answer.
+constexpr std::size_t kRebuildPage = 64;
+
+}  // namespace
+
+void EventCounts::addLocked(uint32_t hour, uint8_t category, uint32_t n)
+{
+    Bucket& bucket = buckets_[hour % kHours];
+    if (bucket.hour != hour) {
+        if (hour < bucket.hour) {
+            return;  // older than the slot's hour: outside the window
+        }
+        bucket = Bucket{};
+        bucket.hour = hour;
+    }
+    const uint32_t sum = bucket.counts[category] + n;
+    bucket.counts[category] = static_cast<uint16_t>(sum > UINT16_MAX ? UINT16_MAX : sum);
+}
+
+void EventCounts::record(uint32_t epoch, uint8_t category)
+{
+    if (category >= kCategories) {
+        return;
+    }
+    std::lock_guard<StaticMutex> lock(mutex_);
+    addLocked(epoch / kSecondsPerHour, category, 1);
+}
+
+EventCountSummary EventCounts::summary(uint32_t nowEpoch, uint32_t hours) const
+{
+    if (hours == 0 || hours > kHours) {
+        hours = kHours;
+    }
+    const uint32_t nowHour = nowEpoch / kSecondsPerHour;
+    EventCountSummary out;
+    out.hours = hours;
+    out.since = nowHour + 1 >= hours ? (nowHour + 1 - hours) * kSecondsPerHour : 0;
+    std::lock_guard<StaticMutex> lock(mutex_);
+    for (const Bucket& bucket : buckets_) {
+        if (bucket.hour > nowHour || nowHour - bucket.hour >= hours) {
+            continue;
+        }
+        for (std::size_t c = 0; c < kCategories; ++c) {
+            out.counts[c] += bucket.counts[c];
+        }
+    }
+    return out;
+}
+
+void EventCounts::seal(EventCountBlock& out)
+{
+    EventCountBlock block{};
+    block.magic = EventCountBlock::kMagic;
+    block.version = EventCountBlock::kVersion;
+    {
+        std::lock_guard<StaticMutex> lock(mutex_);
+        block.sequence = ++sequence_;
+        for (std::size_t h = 0; h < kHours; ++h) {
+            block.hours[h] = buckets_[h].hour;
+            std::memcpy(block.counts[h], buckets_[h].counts.data(), sizeof block.counts[h]);
+        }
+    }
+    block.crc = crcOf(block);
+    out = block;
+}
+
+uint32_t EventCounts::sequence() const
+{
+    std::lock_guard<StaticMutex> lock(mutex_);
+    return sequence_;
+}
+
+bool EventCounts::valid(const EventCountBlock& block)
+{
+    return block.magic == EventCountBlock::kMagic &&
+           block.version == EventCountBlock::kVersion && block.crc == crcOf(block);
+}
+
+const EventCountBlock* EventCounts::restore(
+    std::initializer_list<const EventCountBlock*> candidates)
+{
+    const EventCountBlock* best = nullptr;
+    for (const EventCountBlock* block : candidates) {
+        if (block != nullptr && valid(*block) &&
+            (best == nullptr || block->sequence > best->sequence)) {
+            best = block;
+        }
+    }
+    if (best == nullptr) {
+        return nullptr;
+    }
+    std::lock_guard<StaticMutex> lock(mutex_);
+    sequence_ = best->sequence;
+    for (std::size_t h = 0; h < kHours; ++h) {
+        for (std::size_t c = 0; c < kCategories; ++c) {
+            if (best->counts[h][c] != 0) {
+                addLocked(best->hours[h], static_cast<uint8_t>(c), best->counts[h][c]);
+            }
+        }
+    }
+    return best;
+}
+
+std::size_t EventCounts::rebuild(const IDataStorage& storage,
+                                 const EventCountBlock* checkpoint)
+{
+    // The newest event anchors the window, not the wall clock: at a cold
+    // boot it may not be set yet.
+    const std::vector<EventRecord> newest = storage.getEvents(1);
+    std::array<Bucket, kHours> fresh{};
+    std::size_t read = 0;
+    if (!newest.empty()) {
+        const uint32_t newestHour = newest.front().epoch / kSecondsPerHour;
+        EventQuery query;
+        query.since = newestHour + 1 >= kHours
+                          ? (newestHour + 1 - kHours) * kSecondsPerHour
+                          : 0;
+        query.limit = kRebuildPage;
+        while (true) {
+            const EventPage page = storage.queryEvents(query);
+            for (const EventRecord& event : page.events) {
+                const uint32_t hour = event.epoch / kSecondsPerHour;
+                if (event.category >= kCategories || hour > newestHour) {
+                    continue;
+                }
+                Bucket& bucket = fresh[hour % kHours];
+                if (bucket.hour != hour) {
+                    bucket = Bucket{};
+                    bucket.hour = hour;
+                }
+                if (bucket.counts[event.category] != UINT16_MAX) {
+                    ++bucket.counts[event.category];
+                }
+            }
+            read += page.events.size();
+            if (!page.more) {
+                break;
+            }
+            query.cursor = page.next;
+        }
+    }
+
+    if (checkpoint != nullptr && valid(*checkpoint)) {
+        for (std::size_t h = 0; h < kHours; ++h) {
+            // Same hour: the larger count (the ring may have overwritten
+            // some). A newer hour than the log's: the log lost it entirely.
+            Bucket& bucket = fresh[h];
+            if (checkpoint->hours[h] < bucket.hour) {
+                continue;
+            }
+            if (checkpoint->hours[h] > bucket.hour) {
+                bucket = Bucket{};
+                bucket.hour = checkpoint->hours[h];
+            }
+            for (std::size_t c = 0; c < kCategories; ++c) {
+                if (checkpoint->counts[h][c] > bucket.counts[c]) {
+                    bucket.counts[c] = checkpoint->counts[h][c];
+                }
+            }
+        }
+    }
+
+    std::lock_guard<StaticMutex> lock(mutex_);
+    buckets_ = fresh;
+    if (checkpoint != nullptr && valid(*checkpoint)) {
+        sequence_ = checkpoint->sequence;
+    }
+    return read;
+}
+
+uint32_t EventCounts::crcOf(const EventCountBlock& block)
+{
+    // CRC-32 (IEEE, reflected) up to the crc field, as LifetimeCounters.
+    const auto* bytes = reinterpret_cast<const uint8_t*>(&block);
+    const std::size_t len = offsetof(EventCountBlock, crc);
+    uint32_t crc = 0xFFFFFFFFu;
+    for (std::size_t i = 0; i < len; ++i) {
+        crc ^= bytes[i];
+        for (int bit = 0; bit < 8; ++bit) {
+            crc = (crc >> 1) ^ (0xEDB88320u & (0u - (crc & 1u)));
+        }
+    }
+    return ~crc;
+}
@@ -2,77 +2,97 @@
 // SPDX-License-Identifier: AGPL-3.0-or-later
 /**
  * @file EventLogger.cpp
- * @brief Typed event producers + reset-reason name mapping (pure).
+ * @brief Typed event producers (pure).
  *
- * No IDF/esp_* includes: detail strings are built with std::string only and
- * category constants come from IDataStorage. See EventLogger.h for the
- * behavioural contract.
+ * No IDF/esp_* includes: details are encoded by an EventEncoder on the
+ * stack (no heap), and category constants come from IDataStorage. See
+ * EventLogger.h for the behavioural contract.
  */
 
 #include "events/EventLogger.h"
 
-const char* resetReasonName(int espResetReason)
-{
-    // Mirrors esp_reset_reason_t (esp_system.h) by integer value so this stays
-    // pure (no IDF include). Total: any unlisted value maps to "UNKNOWN".
-    switch (espResetReason) {
-        case 0:  return "UNKNOWN";    // ESP_RST_UNKNOWN
-        case 1:  return "POWERON";    // ESP_RST_POWERON
-        case 2:  return "EXT";        // ESP_RST_EXT
-        case 3:  return "SW";         // ESP_RST_SW
-        case 4:  return "PANIC";      // ESP_RST_PANIC
-        case 5:  return "INT_WDT";    // ESP_RST_INT_WDT
-        case 6:  return "TASK_WDT";   // ESP_RST_TASK_WDT
-        case 7:  return "WDT";        // ESP_RST_WDT
-        case 8:  return "DEEPSLEEP";  // ESP_RST_DEEPSLEEP
-        case 9:  return "BROWNOUT";   // ESP_RST_BROWNOUT
-        case 10: return "SDIO";       // ESP_RST_SDIO
-        case 11: return "USB";        // ESP_RST_USB
-        case 12: return "JTAG";       // ESP_RST_JTAG
-        case 13: return "EFUSE";      // ESP_RST_EFUSE
-        case 14: return "PWR_GLITCH"; // ESP_RST_PWR_GLITCH
-        case 15: return "CPU_LOCKUP"; // ESP_RST_CPU_LOCKUP
-        default: return "UNKNOWN";
-    }
-}
-
-void EventLogger::emit(uint8_t category, const std::string& detail)
+void EventLogger::emit(uint8_t category, std::string_view detail)
 {
     // Never throws / never blocks watering: a failed append is counted only
     // (pure component — no ESP_LOGW). The store truncates over-long detail at
     // kEventDetailMaxLen, so producers need not pre-truncate.
-    if (!storage_.storeEvent(clock_.nowEpoch(), category, detail)) {
+    const uint32_t epoch = clock_.nowEpoch();
+    if (!storage_.storeEvent(epoch, category, detail)) {
         ++droppedEvents_;
+        return;  // the tap mirrors the log: a dropped event is not pushed
+    }
+    counts_.record(epoch, category);
+    // After the store: a woken reader finds the event (QueuedDataStorage
+    // applies its queue before every read).
+    notifier_.notify();
+    IEventTap* tap = tap_.load(std::memory_order_acquire);
+    if (tap != nullptr) {
+        tap->onEvent(epoch, category, detail);
     }
 }
 
 void EventLogger::logReset(int reason)
 {
-    // The detail carries the mapped human-readable name only (contract example:
-    // "reset=TASK_WDT"); mapping internally makes a name mismatch unrepresentable.
-    emit(IDataStorage::kCategoryReset,
-         std::string("reset=") + resetReasonName(reason));
+    // The detail carries the raw reason; the renderer maps it with the same
+    // resetReasonName() ("reset=TASK_WDT"), so the name cannot mismatch.
+    const uint32_t raw = reason < 0 ? UINT32_MAX : static_cast<uint32_t>(reason);
+    emit(IDataStorage::kCategoryReset, EventEncoder(EventCode::Reset).u32(raw).view());
 }
 
 void EventLogger::logWifi(const char* stateName)
 {
     // The STATE name only — never the SSID/password (FR-004).
     emit(IDataStorage::kCategoryConnectivity,
-         std::string("wifi=") + (stateName ? stateName : "unknown"));
+         EventEncoder(EventCode::Wifi).str(stateName ? stateName : "unknown").view());
 }
 
 void EventLogger::logPumpStart(const char* pump, const char* cause)
 {
-    emit(IDataStorage::kCategoryPump,
-         std::string("pump=") + (pump ? pump : "?") + " start cause=" +
-             (cause ? cause : "unknown"));
+    emit(IDataStorage::kCategoryPump, EventEncoder(EventCode::PumpStart)
+                                          .str(pump ? pump : "?")
+                                          .str(cause ? cause : "unknown")
+                                          .view());
 }
 
 void EventLogger::logPumpStop(const char* pump, const char* cause)
 {
-    emit(IDataStorage::kCategoryPump,
-         std::string("pump=") + (pump ? pump : "?") + " stop cause=" +
-             (cause ? cause : "unknown"));
+    emit(IDataStorage::kCategoryPump, EventEncoder(EventCode::PumpStop)
+                                          .str(pump ? pump : "?")
+                                          .str(cause ? cause : "unknown")
+                                          .view());
+}
+
+void EventLogger::logPumpCurrent(const char* pump, float peakA, float meanA,
+                                 float rmsA, uint32_t samples, uint32_t missed)
+{
+    // Fixed-point amps to the milliamp.
+    emit(IDataStorage::kCategoryPump, EventEncoder(EventCode::PumpCurrent)
+                                          .str(pump ? pump : "?")
+                                          .milliamps(peakA)
+                                          .milliamps(meanA)
+                                          .milliamps(rmsA)
+                                          .u32(samples)
+                                          .u32(missed)
+                                          .view());
+}
+
+void EventLogger::logWatchdogWarning(const char* task, uint32_t intervalMs,
+                                     uint32_t timeoutMs)
+{
+    emit(IDataStorage::kCategoryReset, EventEncoder(EventCode::WatchdogWarning)
+                                           .str(task ? task : "?")
+                                           .u32(intervalMs)
+                                           .u32(timeoutMs)
+                                           .view());
+}
+
+void EventLogger::logTickOverBudget(const char* phase, uint32_t tickMs, uint32_t budgetMs)
+{
+    emit(IDataStorage::kCategoryReset, EventEncoder(EventCode::TickOverBudget)
+                                           .str(phase ? phase : "?")
+                                           .u32(tickMs)
+                                           .u32(budgetMs)
+                                           .view());
 }
 
 void EventLogger::logFailsafe(const char* detail)
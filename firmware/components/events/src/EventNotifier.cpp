@@ -0,0 +1,29 @@
+// SPDX-FileCopyrightText: 2026 Cryptotomte
+// SPDX-License-Identifier: AGPL-3.0-or-later
+/**
+ * @file EventNotifier.cpp
+ * @brief Event-log wake-up (see EventNotifier.h).
+ */
+
+#include "events/EventNotifier.h"
+
+#include <chrono>
+
+void EventNotifier::notify()
+{
+    {
+        // Bumped under the lock so a waiter between its check and its wait
+        // cannot miss the signal.
+        std::lock_guard<std::mutex> lock(mutex_);
+        generation_.fetch_add(1, std::memory_order_acq_rel);
+    }
+    changed_.notify_all();
+}
+
+uint32_t EventNotifier::waitPast(uint32_t seen, uint32_t timeoutMs)
+{
+    std::unique_lock<std::mutex> lock(mutex_);
+    changed_.wait_for(lock, std::chrono::milliseconds(timeoutMs),
+                      [&] { return generation() != seen; });
+    return generation();
+}
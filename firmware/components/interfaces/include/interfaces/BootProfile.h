@@ -0,0 +1,105 @@
+// SPDX-FileCopyrightText: 2026 Cryptotomte
+// SPDX-License-Identifier: AGPL-3.0-or-later
+/**
+ * @file BootProfile.h
+ * @brief When each boot phase was reached, in microseconds since reset
+ *        (header-only).
+ *
+ * The boot code marks a phase as it completes: app_main (pumps, level
+ * marks, safety loop), the boot task (NVS, storage, Wi-Fi, RS485, the
+ * BME280 and INA226 probes, boot done), the soil task (first valid
+ * reading) and the system observer (API up). The boot task logs the table
+ * once; GET /api/v1/status serves it as `bootUs`.
+ *
+ * Only the first mark of a phase counts, so a phase that retries keeps its
+ * first completion. Each slot is one atomic word, written once from
+ * whichever task reaches the phase and read from any other: no lock, no
+ * allocation, no IDF includes. Times saturate at ~71 min, far past any boot.
+ */
+
+#ifndef WATERINGSYSTEM_INTERFACES_BOOTPROFILE_H
+#define WATERINGSYSTEM_INTERFACES_BOOTPROFILE_H
+
+#include <array>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+
+/// Boot phases, in the order a healthy boot reaches them.
+enum class BootPhase : uint8_t {
+    Pumps,         ///< every pump forced off and armed
+    Levels,        ///< level marks configured
+    SafetyLoop,    ///< 10 Hz loop running
+    Nvs,           ///< NVS initialized (or recovered)
+    Storage,       ///< data storage mounted and opened
+    Wifi,          ///< Wi-Fi driver up, station/provisioning issued
+    Modbus,        ///< RS485 client initialized
+    Bme280,        ///< BME280 probed (up or not)
+    Ina226,        ///< INA226 probed (rev2 only)
+    BootDone,      ///< every task started
+    FirstReading,  ///< first valid soil reading
+    ApiUp,         ///< HTTP API serving
+};
+constexpr std::size_t kBootPhaseCount = 12;
+
+/// camelCase name of @p phase: the `bootUs` key and the log label.
+inline const char* bootPhaseName(BootPhase phase)
+{
+    switch (phase) {
+    case BootPhase::Pumps:        return "pumps";
+    case BootPhase::Levels:       return "levels";
+    case BootPhase::SafetyLoop:   return "safetyLoop";
+    case BootPhase::Nvs:          return "nvs";
+    case BootPhase::Storage:      return "storage";
+    case BootPhase::Wifi:         return "wifi";
+    case BootPhase::Modbus:       return "modbus";
+    case BootPhase::Bme280:       return "bme280";
+    case BootPhase::Ina226:       return "ina226";
+    case BootPhase::BootDone:     return "bootDone";
+    case BootPhase::FirstReading: return "firstReading";
+    case BootPhase::ApiUp:        return "apiUp";
+    }
+    return "?";
+}
+
+class BootProfile {
+public:
+    BootProfile() = default;
+    BootProfile(const BootProfile&) = delete;
+    BootProfile& operator=(const BootProfile&) = delete;
+
+    /**
+     * @brief Record that @p phase was reached @p atUs after reset.
+     * @return true for the first mark of @p phase, false for a repeat
+     */
+    bool mark(BootPhase phase, int64_t atUs)
+    {
+        uint32_t expected = 0;
+        return slots_[index(phase)].compare_exchange_strong(
+            expected, clamp(atUs), std::memory_order_relaxed);
+    }
+
+    /// Microseconds since reset when @p phase was reached; 0 = not yet.
+    uint32_t atUs(BootPhase phase) const
+    {
+        return slots_[index(phase)].load(std::memory_order_relaxed);
+    }
+
+    bool reached(BootPhase phase) const { return atUs(phase) != 0; }
+
+private:
+    static std::size_t index(BootPhase phase) { return static_cast<std::size_t>(phase); }
+
+    /// 0 is "not reached": a mark at reset itself reads as 1 us.
+    static uint32_t clamp(int64_t atUs)
+    {
+        if (atUs < 1) {
+            return 1;
+        }
+        return atUs > int64_t{UINT32_MAX} ? UINT32_MAX : static_cast<uint32_t>(atUs);
+    }
+
+    std::array<std::atomic<uint32_t>, kBootPhaseCount> slots_{};
+};
+
+#endif /* WATERINGSYSTEM_INTERFACES_BOOTPROFILE_H */
@@ -0,0 +1,268 @@
+// SPDX-FileCopyrightText: 2026 Cryptotomte
+// SPDX-License-Identifier: AGPL-3.0-or-later
+/**
+ * @file BufferBudget.h
+ * @brief Where the large RAM buffers come from, and how large they may be
+ *        (header-only).
+ *
+ * WHY THIS EXISTS: the caches and rings (decoded history chunks, the asset
+ * bodies, the request arena, the input recorder's blocks) are large,
+ * long-lived, touched only by tasks — never by an ISR or a DMA engine — and
+ * would otherwise take internal DRAM the Wi-Fi driver and lwIP need. Each
+ * declares a BufferBudget: its capacity on a board with PSRAM and the
+ * smaller one it makes do with in internal RAM. declare() grants one of the
+ * two, once, at wiring time; allocate() then asks the IBufferHeap for PSRAM
+ * first and internal RAM second, so a full PSRAM degrades instead of
+ * failing.
+ *
+ * TELEMETRY: per pool, the granted budget, the bytes held in each placement,
+ * the peak and the failed allocations (GET /api/v1/metrics,
+ * `buffer_*`). A pool whose memory comes from an allocator the registry
+ * does not see (the asset bodies are std::strings) reports it through
+ * account().
+ *
+ * NOT FOR: anything an ISR reads, a DMA buffer, or std::atomic words the
+ * ESP32 cannot operate on in external RAM (the capture rings); those stay
+ * internal and out of the registry.
+ *
+ * The heap is installed once, before the first declare() (app_main:
+ * main/buffer_heap.h, heap_caps on target); without one every buffer is a
+ * plain malloc() in internal RAM, as on the host. A StaticMutex guards the
+ * counters; no IDF includes.
+ */
+
+#ifndef WATERINGSYSTEM_INTERFACES_BUFFERBUDGET_H
+#define WATERINGSYSTEM_INTERFACES_BUFFERBUDGET_H
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <cstdlib>
+#include <mutex>
+
+#include "interfaces/StaticMutex.h"
+
+/// The budgeted buffers, one pool each.
+enum class BufferPool : uint8_t { HistoryChunkCache, AssetCache, RequestArena, InputRecorder };
+constexpr std::size_t kBufferPools = 4;
+
+inline const char* bufferPoolName(BufferPool pool)
+{
+    switch (pool) {
+        case BufferPool::HistoryChunkCache: return "history_chunk_cache";
+        case BufferPool::AssetCache:        return "asset_cache";
+        case BufferPool::RequestArena:      return "request_arena";
+        case BufferPool::InputRecorder:     return "input_recorder";
+    }
+    return "unknown";
+}
+
+enum class BufferPlacement : uint8_t { Internal, Psram };
+constexpr std::size_t kBufferPlacements = 2;
+
+inline const char* bufferPlacementName(BufferPlacement placement)
+{
+    return placement == BufferPlacement::Psram ? "psram" : "internal";
+}
+
+/// A subsystem's capacity with PSRAM, and without.
+struct BufferBudget {
+    std::size_t psramBytes = 0;
+    std::size_t internalBytes = 0;
+};
+
+/// Raw memory by placement: heap_caps on target, malloc on the host.
+class IBufferHeap {
+public:
+    virtual ~IBufferHeap() = default;
+
+    /// Whether the board has PSRAM for allocate() to use.
+    virtual bool hasPsram() const = 0;
+
+    /// @p bytes from @p placement; nullptr when it has none left.
+    virtual void* allocate(std::size_t bytes, BufferPlacement placement) = 0;
+
+    /// Where @p p (from allocate()) lives.
+    virtual BufferPlacement placementOf(const void* p) const = 0;
+
+    virtual void release(void* p) = 0;
+};
+
+/// One pool, as reported.
+struct BufferPoolStats {
+    bool declared = false;
+    std::size_t budgetBytes = 0;                            ///< granted
+    std::array<std::size_t, kBufferPlacements> usedBytes{}; ///< by BufferPlacement
+    std::size_t peakBytes = 0;                              ///< both placements
+    uint32_t failures = 0;                                  ///< allocate() = null
+};
+
+class BufferBudgets {
+public:
+    BufferBudgets() = default;
+    BufferBudgets(const BufferBudgets&) = delete;
+    BufferBudgets& operator=(const BufferBudgets&) = delete;
+
+    /// Install @p heap (nullptr: malloc) before the first declare().
+    void setHeap(IBufferHeap* heap) { heap_ = heap; }
+
+    bool psram() const { return heap_ != nullptr && heap_->hasPsram(); }
+
+    /**
+     * @brief Grant @p pool its budget for this board: psramBytes with
+     * PSRAM, internalBytes without. The caller sizes its buffer by the
+     * result; declaring again replaces the grant.
+     */
+    std::size_t declare(BufferPool pool, const BufferBudget& budget)
+    {
+        const std::size_t granted = psram() ? budget.psramBytes : budget.internalBytes;
+        std::lock_guard<StaticMutex> lock(mutex_);
+        BufferPoolStats& s = pools_[index(pool)];
+        s.declared = true;
+        s.budgetBytes = granted;
+        return granted;
+    }
+
+    /// The grant of @p pool (0 before declare()).
+    std::size_t granted(BufferPool pool) const
+    {
+        std::lock_guard<StaticMutex> lock(mutex_);
+        return pools_[index(pool)].budgetBytes;
+    }
+
+    /// @p bytes for @p pool, PSRAM first when the board has it; nullptr
+    /// (counted) when neither placement has them.
+    void* allocate(BufferPool pool, std::size_t bytes)
+    {
+        void* p = nullptr;
+        BufferPlacement where = BufferPlacement::Internal;
+        if (heap_ == nullptr) {
+            p = std::malloc(bytes);
+        } else {
+            if (heap_->hasPsram()) {
+                p = heap_->allocate(bytes, BufferPlacement::Psram);
+                where = BufferPlacement::Psram;
+            }
+            if (p == nullptr) {
+                p = heap_->allocate(bytes, BufferPlacement::Internal);
+                where = BufferPlacement::Internal;
+            }
+        }
+        std::lock_guard<StaticMutex> lock(mutex_);
+        BufferPoolStats& s = pools_[index(pool)];
+        if (p == nullptr) {
+            ++s.failures;
+            return nullptr;
+        }
+        add(s, where, bytes);
+        return p;
+    }
+
+    /// Give back @p p, @p bytes long, from allocate(@p pool).
+    void release(BufferPool pool, void* p, std::size_t bytes)
+    {
+        if (p == nullptr) {
+            return;
+        }
+        BufferPlacement where = BufferPlacement::Internal;
+        if (heap_ == nullptr) {
+            std::free(p);
+        } else {
+            where = heap_->placementOf(p);
+            heap_->release(p);
+        }
+        std::lock_guard<StaticMutex> lock(mutex_);
+        subtract(pools_[index(pool)], where, bytes);
+    }
+
+    /// @p bytes that @p pool took (@p held) or gave back through another
+    /// allocator; counted as internal.
+    void account(BufferPool pool, std::size_t bytes, bool held)
+    {
+        std::lock_guard<StaticMutex> lock(mutex_);
+        BufferPoolStats& s = pools_[index(pool)];
+        if (held) {
+            add(s, BufferPlacement::Internal, bytes);
+        } else {
+            subtract(s, BufferPlacement::Internal, bytes);
+        }
+    }
+
+    std::array<BufferPoolStats, kBufferPools> snapshot() const
+    {
+        std::lock_guard<StaticMutex> lock(mutex_);
+        return pools_;
+    }
+
+private:
+    static std::size_t index(BufferPool pool) { return static_cast<std::size_t>(pool); }
+
+    static void add(BufferPoolStats& s, BufferPlacement where, std::size_t bytes)
+    {
+        s.usedBytes[static_cast<std::size_t>(where)] += bytes;
+        const std::size_t total = s.usedBytes[0] + s.usedBytes[1];
+        s.peakBytes = total > s.peakBytes ? total : s.peakBytes;
+    }
+
+    static void subtract(BufferPoolStats& s, BufferPlacement where, std::size_t bytes)
+    {
+        std::size_t& used = s.usedBytes[static_cast<std::size_t>(where)];
+        used = bytes < used ? used - bytes : 0;
+    }
+
+    IBufferHeap* heap_ = nullptr;
+    mutable StaticMutex mutex_;
+    std::array<BufferPoolStats, kBufferPools> pools_{};
+};
+
+/// The process-wide registry.
+inline BufferBudgets& bufferBudgets()
+{
+    static BufferBudgets budgets;
+    return budgets;
+}
+
+/**
+ * @brief Standard allocator over bufferBudgets() for @p Pool, for the
+ * containers a pool holds. Out of both placements it aborts, as
+ * std::allocator does in a build without exceptions.
+ */
+template <typename T, BufferPool Pool>
+struct BufferAllocator {
+    using value_type = T;
+
+    template <typename U>
+    struct rebind {
+        using other = BufferAllocator<U, Pool>;
+    };
+
+    BufferAllocator() = default;
+    template <typename U>
+    BufferAllocator(const BufferAllocator<U, Pool>& /*other*/)
+    {
+    }
+
+    T* allocate(std::size_t n)
+    {
+        void* p = bufferBudgets().allocate(Pool, n * sizeof(T));
+        if (p == nullptr) {
+            std::abort();
+        }
+        return static_cast<T*>(p);
+    }
+
+    void deallocate(T* p, std::size_t n) { bufferBudgets().release(Pool, p, n * sizeof(T)); }
+
+    template <typename U>
+    bool operator==(const BufferAllocator<U, Pool>& /*other*/) const
+    {
+        return true;
+    }
+    template <typename U>
+    bool operator!=(const BufferAllocator<U, Pool>& /*other*/) const
+    {
+        return false;
+    }
+};
+
+#endif /* WATERINGSYSTEM_INTERFACES_BUFFERBUDGET_H */
@@ -0,0 +1,319 @@
+// SPDX-FileCopyrightText: 2026 Cryptotomte
+// SPDX-License-Identifier: AGPL-3.0-or-later
+/**
+ * @file EventCodec.h
+ * @brief Compact event details: an event code plus typed arguments
+ *        (header-only).
+ *
+ * EventLogger's typed producers store their detail as a compact record
+ * instead of free text: kCompactEventTag, an EventCode byte, then the
+ * code's arguments (strings length-prefixed and clipped to
+ * kMaxStringArg, integers as LEB128 varints, amps as zigzag-varint
+ * milliamps). "pump=plant start cause=schedule" takes 17 bytes instead of
+ * 31, "reset=TASK_WDT" 3 instead of 14. QueuedDataStorage may append a
+ * repeat trailer (kRepeatMark, count, newest epoch) when it coalesces.
+ *
+ * Text is rendered only where events are read — buildEventsBody(), the
+ * /api/v1/stream push and the `storage events` console command — by
+ * renderEventDetail(), which gives back exactly the text the producers
+ * used to store. A detail that does not start with the tag (every record
+ * written before this encoding, fail-safe/OTA details, console-injected
+ * events) is text and renders verbatim: text details are printable, the
+ * tag is not.
+ *
+ * Pure C++, no allocation on the encoding side; rendering returns a
+ * std::string because every reader builds one anyway.
+ */
+
+#ifndef WATERINGSYSTEM_INTERFACES_EVENTCODEC_H
+#define WATERINGSYSTEM_INTERFACES_EVENTCODEC_H
+
+#include <climits>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <string>
+#include <string_view>
+
+#include "interfaces/IDataStorage.h"
+
+/// First byte of a compact detail (never the first byte of a text one).
+constexpr char kCompactEventTag = '\x01';
+
+/// Marks the optional repeat trailer after a compact detail's arguments.
+constexpr uint8_t kRepeatMark = 0xFE;
+
+/// Event codes; the arguments of each follow it in the listed order.
+enum class EventCode : uint8_t {
+    Reset = 1,        ///< varint reason (esp_reset_reason_t)
+    Wifi = 2,         ///< string state
+    PumpStart = 3,    ///< string pump, string cause
+    PumpStop = 4,     ///< string pump, string cause
+    PumpCurrent = 5,  ///< string pump, milliamps peak/mean/rms, varint n, missed
+    WatchdogWarning = 6,  ///< string task, varint interval ms, timeout ms
+    TickOverBudget = 7,   ///< string phase, varint tick ms, budget ms
+};
+
+/**
+ * @brief Map an esp_reset_reason_t integer value to a short name.
+ *
+ * Pure free function (no IDF include): the caller passes
+ * static_cast<int>(esp_reset_reason()). Total over the ESP_RST_* values defined
+ * by IDF v6 (0..15); any other value returns "UNKNOWN". Host-tested.
+ */
+inline const char* resetReasonName(int espResetReason)
+{
+    // Mirrors esp_reset_reason_t (esp_system.h) by integer value so this stays
+    // pure (no IDF include). Total: any unlisted value maps to "UNKNOWN".
+    switch (espResetReason) {
+        case 0:  return "UNKNOWN";    // ESP_RST_UNKNOWN
+        case 1:  return "POWERON";    // ESP_RST_POWERON
+        case 2:  return "EXT";        // ESP_RST_EXT
+        case 3:  return "SW";         // ESP_RST_SW
+        case 4:  return "PANIC";      // ESP_RST_PANIC
+        case 5:  return "INT_WDT";    // ESP_RST_INT_WDT
+        case 6:  return "TASK_WDT";   // ESP_RST_TASK_WDT
+        case 7:  return "WDT";        // ESP_RST_WDT
+        case 8:  return "DEEPSLEEP";  // ESP_RST_DEEPSLEEP
+        case 9:  return "BROWNOUT";   // ESP_RST_BROWNOUT
+        case 10: return "SDIO";       // ESP_RST_SDIO
+        case 11: return "USB";        // ESP_RST_USB
+        case 12: return "JTAG";       // ESP_RST_JTAG
+        case 13: return "EFUSE";      // ESP_RST_EFUSE
+        case 14: return "PWR_GLITCH"; // ESP_RST_PWR_GLITCH
+        case 15: return "CPU_LOCKUP"; // ESP_RST_CPU_LOCKUP
+        default: return "UNKNOWN";
+    }
+}
+
+/// True when @p detail is a compact record rather than text.
+inline bool isCompactEvent(std::string_view detail)
+{
+    return !detail.empty() && detail[0] == kCompactEventTag;
+}
+
+/**
+ * @brief Builds one compact detail in a fixed buffer.
+ *
+ * Every code's worst case (clipped strings, five-byte varints) fits
+ * kEventDetailMaxLen with room for the repeat trailer.
+ */
+class EventEncoder {
+public:
+    static constexpr std::size_t kMaxStringArg = 31;
+
+    explicit EventEncoder(EventCode code)
+    {
+        buf_[0] = kCompactEventTag;
+        buf_[1] = static_cast<char>(code);
+    }
+
+    EventEncoder& str(const char* s)
+    {
+        std::size_t n = 0;
+        while (s != nullptr && n < kMaxStringArg && s[n] != '\0') {
+            ++n;
+        }
+        buf_[len_++] = static_cast<char>(n);
+        if (n != 0) {
+            std::memcpy(buf_ + len_, s, n);
+            len_ += n;
+        }
+        return *this;
+    }
+
+    EventEncoder& u32(uint32_t v)
+    {
+        len_ = putVarint(buf_, len_, v);
+        return *this;
+    }
+
+    /// Amps as milliamps; NaN (a run without a valid sample) survives.
+    EventEncoder& milliamps(float amps)
+    {
+        int32_t milli = INT32_MIN;  // NaN
+        if (!std::isnan(amps)) {
+            const double m = std::round(static_cast<double>(amps) * 1000.0);
+            milli = m >= 2147483647.0 ? INT32_MAX
+                  : m <= -2147483647.0 ? -INT32_MAX
+                                       : static_cast<int32_t>(m);
+        }
+        return u32((static_cast<uint32_t>(milli) << 1) ^ static_cast<uint32_t>(milli >> 31));
+    }
+
+    std::string_view view() const { return std::string_view(buf_, len_); }
+
+    /// LEB128 @p v at @p at in @p buf; the end position.
+    static std::size_t putVarint(char* buf, std::size_t at, uint32_t v)
+    {
+        while (v >= 0x80) {
+            buf[at++] = static_cast<char>((v & 0x7F) | 0x80);
+            v >>= 7;
+        }
+        buf[at++] = static_cast<char>(v);
+        return at;
+    }
+
+    /// Longest compact detail: tag, code, two strings, five varints.
+    static constexpr std::size_t kMaxBytes = 2 + 2 * (1 + kMaxStringArg) + 5 * 5;
+
+private:
+    char buf_[kMaxBytes] = {};
+    std::size_t len_ = 2;
+};
+
+/// Longest repeat trailer: the mark and two varints.
+constexpr std::size_t kEventRepeatMaxBytes = 1 + 2 * 5;
+static_assert(EventEncoder::kMaxBytes + kEventRepeatMaxBytes <= IDataStorage::kEventDetailMaxLen,
+              "a compact detail and its repeat trailer fit the stored detail");
+
+/**
+ * @brief The repeat trailer for a compact detail folded from @p count
+ * identical events, the newest at @p lastEpoch, into @p buf (at least
+ * kEventRepeatMaxBytes).
+ * @return its length
+ */
+inline std::size_t encodeEventRepeat(char* buf, uint32_t count, uint32_t lastEpoch)
+{
+    buf[0] = static_cast<char>(kRepeatMark);
+    return EventEncoder::putVarint(buf, EventEncoder::putVarint(buf, 1, count), lastEpoch);
+}
+
+namespace event_codec_detail {
+
+/// Sequential argument reader; any read past the end fails it for good.
+struct Reader {
+    std::string_view in;
+    std::size_t at = 2;
+    bool ok = true;
+
+    std::string_view str()
+    {
+        if (!ok || at >= in.size() ||
+            static_cast<uint8_t>(in[at]) > in.size() - at - 1) {
+            ok = false;
+            return {};
+        }
+        const std::size_t n = static_cast<uint8_t>(in[at]);
+        const std::string_view s = in.substr(at + 1, n);
+        at += 1 + n;
+        return s;
+    }
+
+    uint32_t u32()
+    {
+        uint32_t v = 0;
+        for (unsigned shift = 0; ok && shift < 35; shift += 7) {
+            if (at >= in.size()) {
+                break;
+            }
+            const uint8_t b = static_cast<uint8_t>(in[at++]);
+            v |= static_cast<uint32_t>(b & 0x7F) << shift;
+            if ((b & 0x80) == 0) {
+                return v;
+            }
+        }
+        ok = false;
+        return 0;
+    }
+
+    int32_t milli()
+    {
+        const uint32_t z = u32();
+        return static_cast<int32_t>((z >> 1) ^ (~(z & 1) + 1));
+    }
+};
+
+inline void appendAmps(std::string& out, int32_t milli)
+{
+    if (milli == INT32_MIN) {
+        out += "nan";
+        return;
+    }
+    const uint32_t abs = milli < 0 ? 0u - static_cast<uint32_t>(milli)
+                                   : static_cast<uint32_t>(milli);
+    char buf[16];
+    std::snprintf(buf, sizeof buf, "%s%lu.%03lu", milli < 0 ? "-" : "",
+                  static_cast<unsigned long>(abs / 1000),
+                  static_cast<unsigned long>(abs % 1000));
+    out += buf;
+}
+
+}  // namespace event_codec_detail
+
+/**
+ * @brief The text of a stored detail: a compact one rendered as its
+ * producer's documented format, anything else verbatim. A compact detail
+ * that does not decode renders as "event code=<n>".
+ */
+inline std::string renderEventDetail(std::string_view detail)
+{
+    using event_codec_detail::appendAmps;
+    if (!isCompactEvent(detail)) {
+        return std::string(detail);
+    }
+    event_codec_detail::Reader r{detail};
+    const uint8_t code = detail.size() > 1 ? static_cast<uint8_t>(detail[1]) : 0;
+    std::string out;
+    switch (static_cast<EventCode>(code)) {
+        case EventCode::Reset:
+            out = "reset=";
+            out += resetReasonName(static_cast<int>(r.u32()));
+            break;
+        case EventCode::Wifi:
+            out = "wifi=";
+            out += r.str();
+            break;
+        case EventCode::PumpStart:
+        case EventCode::PumpStop:
+            out = "pump=";
+            out += r.str();
+            out += static_cast<EventCode>(code) == EventCode::PumpStart ? " start cause="
+                                                                        : " stop cause=";
+            out += r.str();
+            break;
+        case EventCode::PumpCurrent: {
+            out = "pump=";
+            out += r.str();
+            out += " current peak=";
+            appendAmps(out, r.milli());
+            out += " mean=";
+            appendAmps(out, r.milli());
+            out += " rms=";
+            appendAmps(out, r.milli());
+            out += " n=" + std::to_string(r.u32());
+            out += " missed=" + std::to_string(r.u32());
+            break;
+        }
+        case EventCode::WatchdogWarning: {
+            out = "wdt-warn task=";
+            out += r.str();
+            out += " interval=" + std::to_string(r.u32()) + "ms";
+            out += " timeout=" + std::to_string(r.u32()) + "ms";
+            break;
+        }
+        case EventCode::TickOverBudget: {
+            out = "tick-slow phase=";
+            out += r.str();
+            out += " tick=" + std::to_string(r.u32()) + "ms";
+            out += " budget=" + std::to_string(r.u32()) + "ms";
+            break;
+        }
+        default:
+            r.ok = false;
+            break;
+    }
+    if (r.ok && r.at < detail.size() && static_cast<uint8_t>(detail[r.at]) == kRepeatMark) {
+        ++r.at;
+        out += " count=" + std::to_string(r.u32());
+        out += " last=" + std::to_string(r.u32());
+    }
+    if (!r.ok || r.at != detail.size()) {
+        out = "event code=" + std::to_string(code);
+    }
+    return out;
+}
+
+#endif /* WATERINGSYSTEM_INTERFACES_EVENTCODEC_H */
@@ -26,10 +26,101 @@
 #ifndef WATERINGSYSTEM_INTERFACES_ICONFIGSTORE_H
 #define WATERINGSYSTEM_INTERFACES_ICONFIGSTORE_H
 
+#include <array>
 #include <cstddef>
 #include <cstdint>
+#include <optional>
 #include <string>
 
+#include "interfaces/MetricRegistry.h"
+
+/**
+ * @brief Change-only logging policy of one known metric (data-log pass).
+ *
+ * Off (the factory state) while heartbeatS is 0: every pass logs the
+ * metric. Otherwise a pass skips the metric while its value stays within
+ * max(deadbandAbs, deadbandRel * |last logged value|) of the last logged
+ * value, but never for heartbeatS or longer — so a zero band logs on
+ * change only, and history is never silent for more than a heartbeat.
+ */
+struct MetricLogPolicy {
+    float deadbandAbs = 0.0f;  ///< metric units, >= 0
+    float deadbandRel = 0.0f;  ///< fraction of |last|, 0..1
+    uint32_t heartbeatS = 0;   ///< max silence; 0 = policy off
+};
+
+/**
+ * @brief Static IPv4 settings of the station interface.
+ *
+ * Addresses are host order (a.b.c.d = a << 24 | b << 16 | c << 8 | d).
+ * All zero (the factory state) means DHCP. A zero gateway or DNS server is
+ * simply not set (a link-local-only network).
+ */
+struct StaticIpConfig {
+    uint32_t address = 0;
+    uint32_t netmask = 0;
+    uint32_t gateway = 0;
+    uint32_t dns = 0;
+
+    bool enabled() const { return address != 0; }
+};
+
+/**
+ * @brief Sizing of the API's HTTP server (api/HttpdPresets.h has the
+ * presets).
+ *
+ * All zero (the factory state) keeps the build's httpd defaults; otherwise
+ * every field is set. Applied when the server starts.
+ */
+struct HttpdSettings {
+    uint16_t maxOpenSockets = 0;  ///< client sessions held open at once
+    uint16_t backlog = 0;         ///< connections queued before accept
+    uint32_t stackBytes = 0;      ///< httpd task stack
+    uint16_t recvTimeoutS = 0;    ///< socket receive timeout
+    uint16_t sendTimeoutS = 0;    ///< socket send timeout
+    bool lruPurge = false;        ///< at the limit, close the idlest session
+                                  ///< for a new one (else refuse the new one)
+
+    bool enabled() const { return maxOpenSockets != 0; }
+};
+
+/**
+ * @brief Several config items changed together (IConfigStore::apply()).
+ *
+ * Every set field is written; unset fields keep their stored value. The
+ * credentials are not part of a patch (setWifiCredentials() already
+ * stores its pair as one).
+ */
+struct ConfigPatch {
+    std::optional<float> moistureThresholdLow;
+    std::optional<float> moistureThresholdHigh;
+    std::optional<uint32_t> wateringDurationS;
+    std::optional<uint32_t> minWateringIntervalS;
+    std::optional<bool> wateringEnabled;
+    std::optional<uint32_t> sensorReadIntervalMs;
+    std::optional<uint32_t> dataLogIntervalMs;
+    std::array<std::optional<MetricLogPolicy>, metric::kKnownCount> logPolicies{};
+};
+
+/**
+ * @brief Every non-credential item as the getters return it, copied at once
+ * (IConfigStore::snapshot()).
+ *
+ * Plain trivially-copyable data, so LockedConfigStore can publish it for
+ * lock-free readers; the credentials (strings) are left out.
+ */
+struct ConfigSnapshot {
+    float moistureThresholdLow = 0.0f;
+    float moistureThresholdHigh = 0.0f;
+    uint32_t wateringDurationS = 0;
+    uint32_t minWateringIntervalS = 0;
+    bool wateringEnabled = false;
+    uint32_t sensorReadIntervalMs = 0;
+    uint32_t dataLogIntervalMs = 0;
+    uint32_t modbusBaudRate = 0;
+    std::array<MetricLogPolicy, metric::kKnownCount> logPolicies{};
+};
+
 /**
  * @brief Typed configuration store with compiled-in factory defaults.
  *
@@ -64,9 +155,99 @@ public:
     static constexpr uint32_t kDataLogIntervalFloorMs = 60000;
     static constexpr uint32_t kDefaultDataLogIntervalMs = 300000;
 
+    // Soil bus line rate: one the probe lists (sensors/
+    // ModbusBaudNegotiator.h); the parity 9600 until negotiated.
+    static constexpr uint32_t kDefaultModbusBaudRate = 9600;
+
+    static constexpr bool isValidModbusBaudRate(uint32_t baud)
+    {
+        return baud == 2400 || baud == 4800 || baud == 9600 || baud == 19200;
+    }
+
     static constexpr std::size_t kWifiSsidMaxLen = 32;      ///< bytes
     static constexpr std::size_t kWifiPasswordMaxLen = 64;  ///< bytes
 
+    /// All zero (DHCP), or a usable host address: contiguous non-zero mask,
+    /// neither the subnet nor its broadcast address, gateway 0 or on-link.
+    static constexpr bool isValidStaticIp(const StaticIpConfig& ip)
+    {
+        if (ip.address == 0) {
+            return ip.netmask == 0 && ip.gateway == 0 && ip.dns == 0;
+        }
+        const uint32_t host = ~ip.netmask;
+        const bool contiguous = ip.netmask != 0 && (host & (host + 1)) == 0;
+        return contiguous && host != 0 && (ip.address & host) != 0 &&
+               (ip.address & host) != host &&
+               (ip.gateway == 0 ||
+                ((ip.gateway & ip.netmask) == (ip.address & ip.netmask) &&
+                 ip.gateway != ip.address));
+    }
+
+    // HTTP server sizing bounds. The socket cap is the httpd's own limit at
+    // the largest lwIP socket count the board builds with (16, less the
+    // three httpd keeps for itself); start() clamps to the build's.
+    static constexpr uint16_t kHttpdSocketsMax = 13;
+    static constexpr uint16_t kHttpdBacklogMax = 16;
+    static constexpr uint32_t kHttpdStackMinBytes = 4096;
+    static constexpr uint32_t kHttpdStackMaxBytes = 32768;
+    static constexpr uint16_t kHttpdTimeoutMaxS = 300;
+
+    /// All zero (the build defaults), or every field in range.
+    static constexpr bool isValidHttpdSettings(const HttpdSettings& h)
+    {
+        if (h.maxOpenSockets == 0) {
+            return h.backlog == 0 && h.stackBytes == 0 && h.recvTimeoutS == 0 &&
+                   h.sendTimeoutS == 0 && !h.lruPurge;
+        }
+        return h.maxOpenSockets <= kHttpdSocketsMax && h.backlog >= 1 &&
+               h.backlog <= kHttpdBacklogMax && h.stackBytes >= kHttpdStackMinBytes &&
+               h.stackBytes <= kHttpdStackMaxBytes && h.recvTimeoutS >= 1 &&
+               h.recvTimeoutS <= kHttpdTimeoutMaxS && h.sendTimeoutS >= 1 &&
+               h.sendTimeoutS <= kHttpdTimeoutMaxS;
+    }
+
+    // Per-metric log policy bounds. A heartbeat is 0 (off) or within
+    // [kLogHeartbeatMinS, kLogHeartbeatMaxS]: the floor is the data-log
+    // interval floor, the cap keeps at least one point per day.
+    static constexpr float kLogDeadbandAbsMax = 1.0e6f;
+    static constexpr float kLogDeadbandRelMax = 1.0f;
+    static constexpr uint32_t kLogHeartbeatMinS = kDataLogIntervalFloorMs / 1000;
+    static constexpr uint32_t kLogHeartbeatMaxS = 86400;
+
+    /// Whether every field of @p policy is in range (NaN is not).
+    static constexpr bool isValidLogPolicy(const MetricLogPolicy& policy)
+    {
+        return policy.deadbandAbs >= 0.0f && policy.deadbandAbs <= kLogDeadbandAbsMax &&
+               policy.deadbandRel >= 0.0f && policy.deadbandRel <= kLogDeadbandRelMax &&
+               (policy.heartbeatS == 0 || (policy.heartbeatS >= kLogHeartbeatMinS &&
+                                           policy.heartbeatS <= kLogHeartbeatMaxS));
+    }
+
+    /// Whether every set field of @p patch is in its item's range (the
+    /// same ranges the single-item setters enforce; NaN is not).
+    static constexpr bool isValidPatch(const ConfigPatch& patch)
+    {
+        auto inRange = [](const auto& value, auto minValue, auto maxValue) {
+            return !value.has_value() || (*value >= minValue && *value <= maxValue);
+        };
+        for (const auto& policy : patch.logPolicies) {
+            if (policy.has_value() && !isValidLogPolicy(*policy)) {
+                return false;
+            }
+        }
+        return inRange(patch.moistureThresholdLow, kMoistureThresholdMin,
+                       kMoistureThresholdMax) &&
+               inRange(patch.moistureThresholdHigh, kMoistureThresholdMin,
+                       kMoistureThresholdMax) &&
+               inRange(patch.wateringDurationS, kWateringDurationMinS,
+                       kWateringDurationMaxS) &&
+               inRange(patch.minWateringIntervalS, kMinWateringIntervalFloorS,
+                       UINT32_MAX) &&
+               inRange(patch.sensorReadIntervalMs, kSensorReadIntervalFloorMs,
+                       UINT32_MAX) &&
+               inRange(patch.dataLogIntervalMs, kDataLogIntervalFloorMs, UINT32_MAX);
+    }
+
     virtual ~IConfigStore() = default;
 
     /**
@@ -123,6 +304,61 @@ public:
     /// Set the data log interval; rejects values below 60000 ms.
     virtual bool setDataLogIntervalMs(uint32_t ms) = 0;
 
+    /// RS485 soil bus line rate in baud (one isValidModbusBaudRate() takes).
+    virtual uint32_t getModbusBaudRate() const = 0;
+
+    /// Record the negotiated line rate; rejects a rate the probe does not
+    /// list. Moving the bus is changeSoilBusBaud()'s job, not this one's.
+    virtual bool setModbusBaudRate(uint32_t baud) = 0;
+
+    /**
+     * @brief Log policy of known metric @p id (metric::k*).
+     *
+     * Never fails: the factory default (off) for an unknown id, a missing
+     * policy or one with any field out of range.
+     */
+    virtual MetricLogPolicy getMetricLogPolicy(MetricId id) const = 0;
+
+    /// Set the log policy of known metric @p id; rejects an unknown id or
+    /// a policy failing isValidLogPolicy(). All three fields are stored
+    /// together (one commit).
+    virtual bool setMetricLogPolicy(MetricId id, const MetricLogPolicy& policy) = 0;
+
+    /**
+     * @brief Write every set field of @p patch as one change.
+     *
+     * All-or-nothing on validation: if any set field fails isValidPatch(),
+     * returns false and nothing is written. This default applies the
+     * fields through the single-item setters, so a persistence failure
+     * part-way can leave the earlier fields written; NvsConfigStore
+     * overrides it with one handle and a single commit.
+     * @return false on a rejection or a persistence failure
+     */
+    virtual bool apply(const ConfigPatch& patch)
+    {
+        if (!isValidPatch(patch)) {
+            return false;
+        }
+        bool ok = true;
+        auto put = [&ok](const auto& value, auto setter) {
+            if (ok && value.has_value()) {
+                ok = setter(*value);
+            }
+        };
+        put(patch.moistureThresholdLow, [this](float v) { return setMoistureThresholdLow(v); });
+        put(patch.moistureThresholdHigh, [this](float v) { return setMoistureThresholdHigh(v); });
+        put(patch.wateringDurationS, [this](uint32_t v) { return setWateringDurationS(v); });
+        put(patch.minWateringIntervalS, [this](uint32_t v) { return setMinWateringIntervalS(v); });
+        put(patch.wateringEnabled, [this](bool v) { return setWateringEnabled(v); });
+        put(patch.sensorReadIntervalMs, [this](uint32_t v) { return setSensorReadIntervalMs(v); });
+        put(patch.dataLogIntervalMs, [this](uint32_t v) { return setDataLogIntervalMs(v); });
+        for (MetricId id = 0; id < metric::kKnownCount; ++id) {
+            put(patch.logPolicies[id],
+                [this, id](const MetricLogPolicy& v) { return setMetricLogPolicy(id, v); });
+        }
+        return ok;
+    }
+
     /**
      * @brief Stored WiFi SSID; empty string = unconfigured (factory state).
      *
@@ -147,6 +383,28 @@ public:
     /// Return both credential items to the factory (empty) state.
     virtual bool clearWifiCredentials() = 0;
 
+    /// Station static IPv4 settings; all zero (DHCP) in the factory state
+    /// or when the stored set fails isValidStaticIp().
+    virtual StaticIpConfig getStaticIp() const = 0;
+
+    /**
+     * @brief Store the station static IPv4 settings as one set; all zero
+     * returns to DHCP. Rejected with false (stored set untouched) unless
+     * isValidStaticIp(). Takes effect at the next Wi-Fi start.
+     */
+    virtual bool setStaticIp(const StaticIpConfig& ip) = 0;
+
+    /// API HTTP server sizing; all zero (the build defaults) in the factory
+    /// state or when the stored set fails isValidHttpdSettings().
+    virtual HttpdSettings getHttpdSettings() const = 0;
+
+    /**
+     * @brief Store the API HTTP server sizing as one set; all zero returns
+     * to the build defaults. Rejected with false (stored set untouched)
+     * unless isValidHttpdSettings(). Takes effect at the next server start.
+     */
+    virtual bool setHttpdSettings(const HttpdSettings& settings) = 0;
+
     /**
      * @brief Factory reset: erase the underlying config storage.
      *
@@ -162,6 +420,35 @@ public:
      * (data-model.md "Factory reset"), not an implementation accident.
      */
     virtual bool factoryReset() = 0;
+
+    /**
+     * @brief Change counter: differs after any successful write (setter,
+     * apply(), credentials, factoryReset()).
+     *
+     * Lets a consumer keep its own copy of the items it uses and re-read
+     * them only when the generation moved. Wraps; compare for equality
+     * only. LockedConfigStore::subscribe() is the push variant.
+     */
+    virtual uint32_t generation() const = 0;
+
+    /// Every non-credential item in one copy. This default calls each
+    /// getter; LockedConfigStore serves a published copy without its lock.
+    virtual ConfigSnapshot snapshot() const
+    {
+        ConfigSnapshot s;
+        s.moistureThresholdLow = getMoistureThresholdLow();
+        s.moistureThresholdHigh = getMoistureThresholdHigh();
+        s.wateringDurationS = getWateringDurationS();
+        s.minWateringIntervalS = getMinWateringIntervalS();
+        s.wateringEnabled = getWateringEnabled();
+        s.sensorReadIntervalMs = getSensorReadIntervalMs();
+        s.dataLogIntervalMs = getDataLogIntervalMs();
+        s.modbusBaudRate = getModbusBaudRate();
+        for (MetricId id = 0; id < metric::kKnownCount; ++id) {
+            s.logPolicies[id] = getMetricLogPolicy(id);
+        }
+        return s;
+    }
 };
 
 #endif /* WATERINGSYSTEM_INTERFACES_ICONFIGSTORE_H */
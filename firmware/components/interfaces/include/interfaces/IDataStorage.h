@@ -29,11 +29,17 @@
 #ifndef WATERINGSYSTEM_INTERFACES_IDATASTORAGE_H
 #define WATERINGSYSTEM_INTERFACES_IDATASTORAGE_H
 
+#include <algorithm>
 #include <cstddef>
 #include <cstdint>
 #include <string>
+#include <string_view>
+#include <utility>
 #include <vector>
 
+#include "interfaces/MetricRegistry.h"
+#include "interfaces/QuantileSketch.h"
+
 /// One sensor reading; `metric` follows the legacy naming
 /// (env_temperature, soil_moisture, ...) but the set is open.
 struct SensorReading {
@@ -42,6 +48,49 @@ struct SensorReading {
     float value = 0.0f;
 };
 
+/**
+ * @brief Receives readings streamed by IDataStorage::forEachReading().
+ *
+ * A tiny interface rather than std::function (same choice as
+ * IDigitalInput): no allocation per call, none per reading.
+ */
+class IReadingVisitor {
+public:
+    virtual ~IReadingVisitor() = default;
+
+    /// One reading, in chronological order. Return false to stop early.
+    virtual bool onReading(uint32_t epoch, float value) = 0;
+};
+
+/// Aggregate of one metric's readings over one time bucket
+/// [epoch, epoch + bucket width). Mean = sum / count.
+struct SensorAggregate {
+    uint32_t epoch = 0;  ///< bucket start, a multiple of the bucket width
+    uint32_t count = 0;  ///< readings folded in (>= 1 in any result)
+    float min = 0.0f;
+    float max = 0.0f;
+    float sum = 0.0f;
+};
+
+/// Summary of one metric's readings over a whole window (see
+/// IDataStorage::getSensorWindowStats). Everything but `count` is
+/// meaningless when count == 0.
+struct SensorWindowStats {
+    uint32_t count = 0;
+    float min = 0.0f;
+    float max = 0.0f;
+    float mean = 0.0f;
+    uint32_t lastEpoch = 0;  ///< newest reading in the window
+    float last = 0.0f;       ///< its value
+};
+
+/// Newest reading of one metric (see IDataStorage::latestReading).
+struct LatestReading {
+    bool found = false;  ///< the metric has a reading; the rest is 0 otherwise
+    uint32_t epoch = 0;
+    float value = 0.0f;
+};
+
 /// One persisted safety-relevant event.
 struct EventRecord {
     uint32_t epoch = 0;    ///< epoch seconds, caller-supplied
@@ -49,10 +98,222 @@ struct EventRecord {
     std::string detail;    ///< <= kEventDetailMaxLen bytes
 };
 
-/// Total/used bytes of the data filesystem (FR-008).
+/// Where a paged event query resumes: events at or before `epoch`, past
+/// the first `skip` selected events stamped exactly `epoch` (an earlier
+/// page returned those). The default is the newest end of the log.
+struct EventCursor {
+    uint32_t epoch = UINT32_MAX;
+    uint32_t skip = 0;
+};
+
+/// Filter and page size of IDataStorage::queryEvents().
+struct EventQuery {
+    static constexpr uint32_t kAllCategories = UINT32_MAX;
+
+    /// Bit c selects category c. Categories >= 32 are only selected by
+    /// kAllCategories.
+    uint32_t categoryMask = kAllCategories;
+    uint32_t since = 0;            ///< oldest epoch, inclusive
+    uint32_t until = UINT32_MAX;   ///< newest epoch, inclusive
+    std::size_t limit = SIZE_MAX;  ///< events per page
+    EventCursor cursor;            ///< EventPage::next of the previous page,
+                                   ///< with the same filter
+
+    static constexpr uint32_t categoryBit(uint8_t category)
+    {
+        return category < 32 ? (1u << category) : 0u;
+    }
+};
+
+/// One page of IDataStorage::queryEvents().
+struct EventPage {
+    std::vector<EventRecord> events;  ///< newest first, at most limit
+    bool more = false;                ///< further events match past `next`
+    EventCursor next;                 ///< resume point after `events`
+};
+
+/**
+ * @brief Folds a newest-first event stream into one EventPage.
+ *
+ * The single definition of EventQuery's semantics, shared by the default
+ * IDataStorage::queryEvents() and implementations that read their log
+ * directly. Newest-first means epochs only fall, so the first record
+ * older than `since` ends the stream — under a non-monotonic clock older
+ * files may still hold matches, the same caveat as getEvents().
+ */
+class EventPager {
+public:
+    explicit EventPager(const EventQuery& query)
+        : query_(query),
+          newest_(query.until < query.cursor.epoch ? query.until
+                                                   : query.cursor.epoch)
+    {
+        page_.next = query.cursor;
+    }
+
+    /// Offer the next older record; false once nothing further can join
+    /// the page (stop reading).
+    bool offer(const EventRecord& record)
+    {
+        return offer(record.epoch, record.category, [&] { return record; });
+    }
+
+    /// offer() for a record not built yet: `make()` returns it and runs
+    /// only if it joins the page, so a skipped record costs no copy.
+    template <typename Make>
+    bool offer(uint32_t epoch, uint8_t category, Make&& make)
+    {
+        if (epoch < query_.since) {
+            return false;
+        }
+        if (epoch > newest_ || !selects(category)) {
+            return true;
+        }
+        if (epoch == query_.cursor.epoch && skipped_ < query_.cursor.skip) {
+            ++skipped_;
+            return true;
+        }
+        if (page_.events.size() >= query_.limit) {
+            page_.more = true;
+            return false;
+        }
+        page_.events.push_back(make());
+        if (epoch == page_.next.epoch) {
+            ++page_.next.skip;
+        } else {
+            page_.next = EventCursor{epoch, 1};
+        }
+        return true;
+    }
+
+    EventPage take() { return std::move(page_); }
+
+private:
+    bool selects(uint8_t category) const
+    {
+        return query_.categoryMask == EventQuery::kAllCategories ||
+               (query_.categoryMask & EventQuery::categoryBit(category)) != 0;
+    }
+
+    EventQuery query_;
+    uint32_t newest_;  ///< min(until, cursor.epoch)
+    uint32_t skipped_ = 0;
+    EventPage page_;
+};
+
+/// Where a paged reading walk resumes: readings at or after `epoch`, past
+/// the first `skip` stamped exactly `epoch` (an earlier page returned
+/// those). The default is the start of the window.
+struct ReadingCursor {
+    uint32_t epoch = 0;
+    uint32_t skip = 0;
+};
+
+/**
+ * @brief Cuts one page out of a forEachReading() pass.
+ *
+ * The reading-side twin of EventPager: it forwards at most `limit`
+ * readings past @p cursor to @p out (which keeps them) and tracks where
+ * the next page starts. A cursor is an epoch, not a file position: every
+ * backend seeks forEachReading(t0 = cursor.epoch) through its chunk
+ * index, and an epoch survives the rotation, eviction and write-behind
+ * flushes that would invalidate an offset. Walk from
+ * max(window start, cursor.epoch); the pass stops at the first reading
+ * past a full page.
+ */
+class ReadingPager : public IReadingVisitor {
+public:
+    ReadingPager(const ReadingCursor& cursor, std::size_t limit,
+                 IReadingVisitor& out)
+        : cursor_(cursor), limit_(limit), out_(out), next_(cursor)
+    {
+    }
+
+    bool onReading(uint32_t epoch, float value) override
+    {
+        if (epoch < cursor_.epoch) {
+            return true;
+        }
+        if (epoch == cursor_.epoch && skipped_ < cursor_.skip) {
+            ++skipped_;
+            return true;
+        }
+        if (taken_ >= limit_) {
+            more_ = true;
+            return false;
+        }
+        ++taken_;
+        if (epoch == next_.epoch) {
+            ++next_.skip;
+        } else {
+            next_ = ReadingCursor{epoch, 1};
+        }
+        return out_.onReading(epoch, value);
+    }
+
+    std::size_t taken() const { return taken_; }
+    /// Further readings match past next() (the page was cut short).
+    bool more() const { return more_; }
+    /// Resume point after the readings forwarded so far.
+    const ReadingCursor& next() const { return next_; }
+
+private:
+    ReadingCursor cursor_;
+    std::size_t limit_;
+    IReadingVisitor& out_;
+    ReadingCursor next_;
+    std::size_t taken_ = 0;
+    uint32_t skipped_ = 0;
+    bool more_ = false;
+};
+
+/// Write accounting of one storage instance since boot (RAM counters, not
+/// persisted): what a logging cadence and layout cost the flash. Counters a
+/// backend has no equivalent for stay 0.
+struct StorageWriteStats {
+    uint64_t bytesAppended = 0;  ///< record/frame bytes appended
+    uint32_t syncs = 0;          ///< durability points (fsync, flash program)
+    uint32_t filesCreated = 0;   ///< chunks/sectors started
+    uint32_t filesRemoved = 0;   ///< chunks/sectors evicted
+    uint32_t tornRepairs = 0;    ///< torn tails cut back to the valid prefix
+    uint32_t rotations = 0;      ///< event-log rotations
+    uint64_t appendUs = 0;       ///< time inside append/flush calls
+};
+
+/// Lock contention seen by a cross-task decorator since boot (filled by
+/// LockedDataStorage; 0 from an unwrapped backend). A write that arrives
+/// while a read holds the storage is either deferred (queued, returns at
+/// once) or, with the queue full or off, waits.
+struct StorageLockStats {
+    uint32_t deferredWrites = 0;    ///< writes queued behind a read or the mount
+    uint32_t deferredFailures = 0;  ///< queued writes the backend rejected
+    uint32_t writerWaits = 0;       ///< writes that blocked on the lock
+    uint32_t readerWaits = 0;       ///< reads that blocked on the lock
+    uint64_t writerWaitUs = 0;      ///< total writer blocking time
+    uint32_t maxWriterWaitUs = 0;   ///< longest single writer wait
+    uint32_t offlineDropped = 0;    ///< writes refused during the mount (queue full)
+};
+
+/// Write queue in front of the storage (filled by QueuedDataStorage; 0
+/// when writes go straight to the backend).
+struct StorageQueueStats {
+    uint32_t capacity = 0;   ///< queue slots
+    uint32_t depth = 0;      ///< writes waiting now
+    uint32_t highWater = 0;  ///< deepest the queue has been
+    uint32_t applied = 0;    ///< writes handed to the backend
+    uint32_t failed = 0;     ///< ... of which the backend rejected
+    uint32_t dropped = 0;    ///< writes refused because the queue was full
+    uint32_t coalesced = 0;  ///< repeated events folded into a queued one
+};
+
+/// Total/used bytes of the data filesystem (FR-008), plus the write
+/// accounting of the storage reporting them.
 struct StorageStats {
     uint32_t totalBytes = 0;
     uint32_t usedBytes = 0;
+    StorageWriteStats writes;
+    StorageLockStats locks;
+    StorageQueueStats queue;
 };
 
 /**
@@ -68,13 +329,22 @@ public:
 
     /// Budget guard: at most this many distinct metrics; storing an
     /// extra distinct metric is rejected (prevents a buggy caller from
-    /// silently destroying history or blowing the budget).
-    static constexpr std::size_t kMaxMetrics = 10;
+    /// silently destroying history or blowing the budget). A backend
+    /// may document a larger budget for a layout that affords it (the
+    /// multiplexed history of LittleFsDataStorage); never a smaller one.
+    static constexpr std::size_t kMaxMetrics = 16;
+    static_assert(metric::kKnownCount <= kMaxMetrics,
+                  "the known metric table must fit the metric budget");
 
     /// Longer event details are silently truncated to this many bytes on
     /// store — the event itself is always recorded, never rejected.
     static constexpr std::size_t kEventDetailMaxLen = 120;
 
+    /// Bucket widths (seconds) an implementation may keep precomputed
+    /// rollups for, finest first: minute, hour, day. Any other width is
+    /// still answered by getSensorAggregates(), just from raw history.
+    static constexpr uint32_t kAggregateBucketsS[] = {60, 3600, 86400};
+
     // Event categories (FR-011). PR-08 may extend the set — unknown
     // values are stored and returned verbatim.
     static constexpr uint8_t kCategoryPump = 1;
@@ -88,7 +358,9 @@ public:
     /**
      * @brief Append one sensor reading.
      *
-     * Durable once true is returned (survives power loss). An unknown
+     * Durable once true is returned (survives power loss) — unless the
+     * implementation runs an opt-in, documented write-behind mode, in
+     * which case the record is durable after the next flush(). An unknown
      * metric is accepted up to kMaxMetrics distinct metrics; one more
      * distinct metric is rejected with false. Bounding/eviction is
      * internal: >= 30-day retention at the default log interval,
@@ -97,6 +369,58 @@ public:
     virtual bool storeSensorReading(const std::string& metric,
                                     uint32_t epoch, float value) = 0;
 
+    /**
+     * @brief Append a batch of readings (one logging pass) in one call.
+     *
+     * Each reading carries its own metric, epoch and value and is held to
+     * the storeSensorReading() contract individually: a rejected reading
+     * (unsafe name, 11th distinct metric, write failure) does not reject
+     * the rest. Readings of one metric are appended in array order. The
+     * default loops over storeSensorReading(); implementations override
+     * it to amortize locking, directory and fsync work across the batch.
+     *
+     * @return number of readings stored (== count when all succeeded)
+     */
+    virtual std::size_t storeSensorReadings(const SensorReading* readings,
+                                            std::size_t count)
+    {
+        std::size_t stored = 0;
+        for (std::size_t i = 0; i < count; ++i) {
+            if (storeSensorReading(readings[i].metric, readings[i].epoch,
+                                   readings[i].value)) {
+                ++stored;
+            }
+        }
+        return stored;
+    }
+
+    /**
+     * @brief Append a batch addressed by metric id instead of name.
+     *
+     * The storeSensorReadings() contract per sample, for the known ids of
+     * MetricRegistry.h; any other id is rejected individually. Lets a
+     * producer of the fixed telemetry set log without building a name per
+     * reading. The default resolves the names and forwards one
+     * storeSensorReadings() batch; implementations keyed by id override
+     * it to skip names entirely.
+     *
+     * @return number of samples stored (== count when all succeeded)
+     */
+    virtual std::size_t storeSamples(const MetricSample* samples,
+                                     std::size_t count)
+    {
+        std::vector<SensorReading> readings;
+        readings.reserve(count);
+        for (std::size_t i = 0; i < count; ++i) {
+            const char* name = metric::knownName(samples[i].metric);
+            if (name != nullptr) {
+                readings.push_back(
+                    SensorReading{name, samples[i].epoch, samples[i].value});
+            }
+        }
+        return readings.empty() ? 0 : storeSensorReadings(readings.data(), readings.size());
+    }
+
     /**
      * @brief Readings for `metric` with epoch in [t0, t1] (inclusive).
      *
@@ -106,16 +430,207 @@ public:
     virtual std::vector<SensorReading> getSensorReadings(
         const std::string& metric, uint32_t t0, uint32_t t1) const = 0;
 
+    /**
+     * @brief Stream the readings getSensorReadings() would return.
+     *
+     * Same range, order and empty-on-error semantics, but each reading is
+     * handed to `visitor` as it is decoded instead of being collected, so
+     * a long window costs no heap per reading. The visitor must not call
+     * back into the storage (a Locked* wrapper holds its lock meanwhile).
+     * The default walks getSensorReadings(); file-backed implementations
+     * override it to read straight from their chunks.
+     *
+     * @return number of readings handed to the visitor
+     */
+    virtual std::size_t forEachReading(const std::string& metric, uint32_t t0,
+                                       uint32_t t1,
+                                       IReadingVisitor& visitor) const
+    {
+        std::size_t visited = 0;
+        for (const SensorReading& r : getSensorReadings(metric, t0, t1)) {
+            ++visited;
+            if (!visitor.onReading(r.epoch, r.value)) {
+                break;
+            }
+        }
+        return visited;
+    }
+
+    /**
+     * @brief Per-bucket count/min/max/sum for `metric` over [t0, t1].
+     *
+     * Buckets are aligned to multiples of `bucketS` (epoch seconds, so
+     * hour/day buckets are UTC-aligned). One entry per bucket that holds
+     * a reading and starts within [t0 rounded down to a bucket, t1]; a
+     * bucket aggregates its readings up to t1, so the first bucket may
+     * include readings just before t0. Bucket order, empty on bucketS ==
+     * 0 or anything getSensorReadings() would answer empty for. The
+     * default buckets forEachReading(); implementations with rollup
+     * tiers answer from those instead (same result).
+     */
+    virtual std::vector<SensorAggregate> getSensorAggregates(
+        const std::string& metric, uint32_t t0, uint32_t t1,
+        uint32_t bucketS) const
+    {
+        struct Bucketer final : IReadingVisitor {
+            std::vector<SensorAggregate> buckets;
+            uint32_t bucketS = 0;
+            bool onReading(uint32_t epoch, float value) override
+            {
+                const uint32_t start = epoch - epoch % bucketS;
+                if (buckets.empty() || buckets.back().epoch != start) {
+                    buckets.push_back(SensorAggregate{start, 0, value, value, 0.0f});
+                }
+                SensorAggregate& b = buckets.back();
+                ++b.count;
+                b.min = value < b.min ? value : b.min;
+                b.max = value > b.max ? value : b.max;
+                b.sum += value;
+                return true;
+            }
+        } bucketer;
+        if (bucketS == 0 || t0 > t1) {
+            return bucketer.buckets;
+        }
+        bucketer.bucketS = bucketS;
+        forEachReading(metric, t0 - t0 % bucketS, t1, bucketer);
+        return bucketer.buckets;
+    }
+
+    /**
+     * @brief count/min/max/mean/last of `metric` over [t0, t1].
+     *
+     * One forEachReading() pass, nothing collected: the numbers a
+     * dashboard tile needs without shipping the series. `last` is the
+     * reading with the newest epoch (the later one on a tie). count == 0
+     * for anything getSensorReadings() would answer empty for. The mean is
+     * summed in double so a month of readings does not lose precision.
+     */
+    virtual SensorWindowStats getSensorWindowStats(const std::string& metric,
+                                                   uint32_t t0, uint32_t t1) const
+    {
+        struct Folder final : IReadingVisitor {
+            SensorWindowStats stats;
+            double sum = 0.0;
+            bool onReading(uint32_t epoch, float value) override
+            {
+                if (stats.count == 0) {
+                    stats.min = value;
+                    stats.max = value;
+                }
+                ++stats.count;
+                stats.min = value < stats.min ? value : stats.min;
+                stats.max = value > stats.max ? value : stats.max;
+                sum += value;
+                if (stats.count == 1 || epoch >= stats.lastEpoch) {
+                    stats.lastEpoch = epoch;
+                    stats.last = value;
+                }
+                return true;
+            }
+        } folder;
+        forEachReading(metric, t0, t1, folder);
+        if (folder.stats.count != 0) {
+            folder.stats.mean =
+                static_cast<float>(folder.sum / static_cast<double>(folder.stats.count));
+        }
+        return folder.stats;
+    }
+
+    /**
+     * @brief Quantile sketch of `metric` over [t0, t1] (see
+     * QuantileSketch.h), for percentiles of a window.
+     *
+     * One forEachReading() pass into a fixed-size sketch; implementations
+     * that keep per-bucket sketches with their rollup tiers merge those
+     * for whole hours and days instead. Empty (count() == 0) for anything
+     * getSensorReadings() would answer empty for.
+     */
+    virtual QuantileSketch getSensorQuantiles(const std::string& metric, uint32_t t0,
+                                              uint32_t t1) const
+    {
+        struct Sketcher final : IReadingVisitor {
+            QuantileSketch sketch;
+            bool onReading(uint32_t, float value) override
+            {
+                sketch.add(value);
+                return true;
+            }
+        } sketcher;
+        forEachReading(metric, t0, t1, sketcher);
+        return sketcher.sketch;
+    }
+
+    /**
+     * @brief The reading of `metric` with the newest epoch (the later one
+     * on a tie); found == false when it has none.
+     *
+     * The default folds the whole history; a backend that keeps recent
+     * readings in RAM answers without reading it.
+     */
+    virtual LatestReading latestReading(const std::string& metric) const
+    {
+        const SensorWindowStats stats = getSensorWindowStats(metric, 0, UINT32_MAX);
+        LatestReading latest;
+        latest.found = stats.count != 0;
+        latest.epoch = stats.lastEpoch;
+        latest.value = stats.last;
+        return latest;
+    }
+
+    /**
+     * @brief The newest `n` readings of `metric`, without a window.
+     *
+     * The last `n` readings getSensorReadings(metric, 0, UINT32_MAX) would
+     * return, in the same (chronological) order; fewer when the metric has
+     * fewer, empty on n == 0 or an unknown metric. The default folds the
+     * whole history through an n-slot ring; a backend that can read its
+     * newest records first (or keeps them in RAM) stops after `n` instead.
+     */
+    virtual std::vector<SensorReading> getLatestReadings(const std::string& metric,
+                                                         std::size_t n) const
+    {
+        struct Tail final : IReadingVisitor {
+            std::vector<SensorReading> ring;
+            std::size_t next = 0;  ///< oldest slot once the ring is full
+            std::size_t n = 0;
+            bool onReading(uint32_t epoch, float value) override
+            {
+                if (ring.size() < n) {
+                    ring.push_back(SensorReading{std::string(), epoch, value});
+                } else {
+                    ring[next].epoch = epoch;
+                    ring[next].value = value;
+                    next = (next + 1) % n;
+                }
+                return true;
+            }
+        } tail;
+        if (n == 0) {
+            return tail.ring;
+        }
+        tail.n = n;
+        forEachReading(metric, 0, UINT32_MAX, tail);
+        std::rotate(tail.ring.begin(),
+                    tail.ring.begin() + static_cast<std::ptrdiff_t>(tail.next),
+                    tail.ring.end());
+        for (SensorReading& r : tail.ring) {
+            r.metric = metric;
+        }
+        return tail.ring;
+    }
+
     /**
      * @brief Append one event record.
      *
      * `detail` longer than kEventDetailMaxLen bytes is silently
      * truncated (the event is always recorded, never rejected for
      * length). Rotation keeps total event storage within its budget and
-     * always retains the newest records.
+     * always retains the newest records. A view, so a producer can pass
+     * a fixed buffer without building a string.
      */
     virtual bool storeEvent(uint32_t epoch, uint8_t category,
-                            const std::string& detail) = 0;
+                            std::string_view detail) = 0;
 
     /**
      * @brief Newest-first events, at most maxCount.
@@ -127,8 +642,55 @@ public:
      */
     virtual std::vector<EventRecord> getEvents(std::size_t maxCount) const = 0;
 
+    /**
+     * @brief Newest-first events matching `query`, one page at a time.
+     *
+     * Category mask, inclusive [since, until] epoch window and a page of
+     * at most `limit`; pass the returned `next` cursor (same filter) to
+     * read the following page. Empty page on no match or read error. The
+     * default filters getEvents(); implementations override it to answer
+     * in one pass over their log, stopping once the page is full.
+     */
+    virtual EventPage queryEvents(const EventQuery& query) const
+    {
+        EventPager pager(query);
+        for (const EventRecord& record : getEvents(SIZE_MAX)) {
+            if (!pager.offer(record)) {
+                break;
+            }
+        }
+        return pager.take();
+    }
+
     /// Total/used bytes of the data filesystem.
     virtual StorageStats getStorageStats() const = 0;
+
+    /**
+     * @brief Commit every buffered history append now.
+     *
+     * Only does work in a write-behind mode; a per-record durable store
+     * has nothing buffered, hence the no-op default. False when a
+     * buffered record could not be committed (it is dropped, not
+     * retried — the same outcome as a failed synchronous append).
+     */
+    virtual bool flush() { return true; }
+
+    /**
+     * @brief Commit buffered history appends whose write-behind deadline
+     *        has passed. Cheap when nothing is due, so periodic callers
+     *        (the controller tick) invoke it unconditionally.
+     */
+    virtual bool flushIfDue() { return true; }
+
+    /**
+     * @brief One bounded step of background upkeep (recompaction, deferred
+     *        rollups), for a low-priority maintenance task to call between
+     *        sleeps.
+     *
+     * A store with nothing to tidy keeps the no-op default.
+     * @return true when more work is pending (call again soon)
+     */
+    virtual bool maintain() { return false; }
 };
 
 #endif /* WATERINGSYSTEM_INTERFACES_IDATASTORAGE_H */
@@ -0,0 +1,42 @@
+// SPDX-FileCopyrightText: 2026 Cryptotomte
+// SPDX-License-Identifier: AGPL-3.0-or-later
+/**
+ * @file IDeadlineTimer.h
+ * @brief Injected one-shot deadline timer.
+ *
+ * A pump's timed stop is otherwise only as precise as the loop polling
+ * IWaterPump::update(). A deadline timer calls back once when a run is
+ * due to end; the owner decides what the callback does (the target
+ * implementation calls the pump's update() through its LockedWaterPump).
+ * Like ITimeProvider it is injected, so WaterPump never calls esp_timer
+ * directly and the host tests use a fake.
+ *
+ * Part of the header-only `interfaces` component: no IDF includes allowed.
+ */
+
+#ifndef WATERINGSYSTEM_INTERFACES_IDEADLINETIMER_H
+#define WATERINGSYSTEM_INTERFACES_IDEADLINETIMER_H
+
+#include <cstdint>
+
+/**
+ * @brief One-shot timer, re-armable.
+ */
+class IDeadlineTimer {
+public:
+    virtual ~IDeadlineTimer() = default;
+
+    /**
+     * @brief Fire once @p delayMs from now, replacing any pending deadline.
+     *
+     * @return false when the timer could not be armed; the caller's polled
+     *         path still enforces the deadline.
+     */
+    virtual bool arm(int64_t delayMs) = 0;
+
+    /// Drop the pending deadline (no-op when none). A callback already
+    /// running may still complete; the callback must tolerate that.
+    virtual void cancel() = 0;
+};
+
+#endif /* WATERINGSYSTEM_INTERFACES_IDEADLINETIMER_H */
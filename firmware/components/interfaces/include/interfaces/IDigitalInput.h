@@ -11,6 +11,9 @@
  * gpio_get_level, no logic). A tiny interface was chosen over std::function
  * to match the codebase's interface-injection style (ITimeProvider,
  * IModbusClient, II2cBus) and to avoid std::function's potential allocation.
+ * An interrupt-driven input also queues its edges with their times
+ * (nextEdge()), so the debounce can run on when the level changed instead
+ * of when its owner happened to poll.
  *
  * Part of the header-only `interfaces` component: no IDF includes allowed.
  */
@@ -18,8 +21,17 @@
 #ifndef WATERINGSYSTEM_INTERFACES_IDIGITALINPUT_H
 #define WATERINGSYSTEM_INTERFACES_IDIGITALINPUT_H
 
+#include <cstdint>
+
+/// One recorded level change of an edge-capturing input.
+struct DigitalEdge {
+    int64_t atMs = 0;    ///< ITimeProvider::nowMs() clock at the edge
+    bool level = false;  ///< level right after the edge (true = HIGH)
+};
+
 /**
- * @brief One digital input, read on demand.
+ * @brief One digital input, read on demand; optionally also a queue of
+ * timestamped edges.
  */
 class IDigitalInput {
 public:
@@ -31,6 +43,21 @@ public:
      * No debounce, no polarity mapping — policy belongs to the consumer.
      */
     virtual bool read() = 0;
+
+    /**
+     * @brief Pop the oldest recorded edge, if the input records them.
+     *
+     * Edges come out in the order they happened. A full queue drops the
+     * newest; the consumer's read() afterwards still sees the true level.
+     * The default records none (a polled input).
+     *
+     * @return false when no edge is queued.
+     */
+    virtual bool nextEdge(DigitalEdge& edge)
+    {
+        (void)edge;
+        return false;
+    }
 };
 
 #endif /* WATERINGSYSTEM_INTERFACES_IDIGITALINPUT_H */
@@ -0,0 +1,36 @@
+// SPDX-FileCopyrightText: 2026 Cryptotomte
+// SPDX-License-Identifier: AGPL-3.0-or-later
+/**
+ * @file IDigitalInputBank.h
+ * @brief Injected raw multi-pin input source (one read, every channel).
+ *
+ * The multi-pin sibling of IDigitalInput: LevelSensorBank samples all the
+ * reservoir marks through this seam so that they are read at one instant —
+ * GpioInputBank on target (one GPIO input-register read), a scripted bank
+ * in host tests. Same interface-injection style as IDigitalInput.
+ *
+ * Part of the header-only `interfaces` component: no IDF includes allowed.
+ */
+
+#ifndef WATERINGSYSTEM_INTERFACES_IDIGITALINPUTBANK_H
+#define WATERINGSYSTEM_INTERFACES_IDIGITALINPUTBANK_H
+
+#include <cstdint>
+
+/**
+ * @brief Up to 32 digital inputs, all sampled together on demand.
+ */
+class IDigitalInputBank {
+public:
+    virtual ~IDigitalInputBank() = default;
+
+    /**
+     * @brief Raw electrical levels of every channel, sampled at one instant:
+     * bit i is channel i (1 = HIGH).
+     *
+     * No debounce, no polarity mapping — policy belongs to the consumer.
+     */
+    virtual uint32_t readAll() = 0;
+};
+
+#endif /* WATERINGSYSTEM_INTERFACES_IDIGITALINPUTBANK_H */
@@ -31,6 +31,27 @@
 #ifndef WATERINGSYSTEM_INTERFACES_IENVIRONMENTALSENSOR_H
 #define WATERINGSYSTEM_INTERFACES_IENVIRONMENTALSENSOR_H
 
+#include <cmath>
+#include <cstdint>
+
+/**
+ * @brief Consistent environmental snapshot (PR-11).
+ *
+ * Temperature/humidity/pressure plus the error code, copied out together so
+ * they are mutually consistent. valid = the last operation succeeded and a
+ * reading is on record (finite temperature); when false the values are the
+ * last-good reading (or the NaN placeholders before the first success).
+ */
+struct EnvSnapshot {
+    bool valid = false;
+    int lastError = 0;
+    uint32_t sequence = 0; ///< successful reads so far (0 = none yet)
+    int64_t atMs = 0;      ///< monotonic time of that read; 0 = unstamped
+    float temperature = NAN;
+    float humidity = NAN;
+    float pressure = NAN;
+};
+
 /**
  * @brief Environmental sensor: atomic T/RH/P snapshots with lazy recovery.
  *
@@ -119,6 +140,39 @@ public:
 
     /// Barometric pressure in hPa (parity: legacy converts Pa → hPa).
     virtual float getPressure() = 0;
+
+    /**
+     * @brief The cached reading as one struct. NON-BLOCKING: no read(), no
+     * isAvailable() probe.
+     *
+     * valid = lastError == 0 and a reading is on record. sequence counts
+     * successful read() calls, so a consumer tells a new sample from one it
+     * has seen. atMs is 0 from a bare driver (it has no clock);
+     * LockedEnvironmentalSensor stamps it with the time it first published
+     * that sequence.
+     */
+    virtual EnvSnapshot snapshot() = 0;
+
+    /**
+     * @brief Start a conversion, for sensors that convert on demand.
+     *
+     * Returns the µs until read() sees the new conversion; 0 = the sensor
+     * converts continuously (read() returns the latest one now) or the
+     * trigger failed (getLastError() says which). The default is a
+     * continuously converting sensor.
+     */
+    virtual uint32_t startMeasurement() { return 0; }
+
+    /**
+     * @brief Switch to (true) or from a fast-sampling profile, e.g. to
+     * follow humidity closely while watering. False = not supported or the
+     * switch failed; the sensor keeps working either way.
+     */
+    virtual bool setBurst(bool burst)
+    {
+        (void)burst;
+        return false;
+    }
 };
 
 #endif /* WATERINGSYSTEM_INTERFACES_IENVIRONMENTALSENSOR_H */
@@ -0,0 +1,60 @@
+// SPDX-FileCopyrightText: 2026 Cryptotomte
+// SPDX-License-Identifier: AGPL-3.0-or-later
+/**
+ * @file IEspNowLink.h
+ * @brief ESP-NOW datagram seam (send + non-blocking receive poll).
+ *
+ * The host-test seam of the multi-node link: the pure api::NodeLeaf and
+ * api::NodeGateway hold the framing, acknowledgement, retry and
+ * aggregation logic above this interface and are host-tested against
+ * MockEspNowLink; EspNowLink (esp_now) is the only implementation that
+ * touches the radio and is excluded from the linux build. Same shape as
+ * IMqttClient: send() never waits for the air, received frames are queued
+ * by the driver callback and drained one per receive() call.
+ *
+ * Part of the header-only `interfaces` component: no IDF includes allowed.
+ */
+
+#ifndef WATERINGSYSTEM_INTERFACES_IESPNOWLINK_H
+#define WATERINGSYSTEM_INTERFACES_IESPNOWLINK_H
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+
+/// Largest ESP-NOW v1 payload (ESP_NOW_MAX_DATA_LEN).
+constexpr std::size_t kEspNowMaxPayload = 250;
+
+/// A station MAC address: the ESP-NOW peer identity.
+using EspNowMac = std::array<uint8_t, 6>;
+
+/// One received datagram.
+struct EspNowPacket {
+    EspNowMac from{};
+    int8_t rssi = 0;            ///< dBm, as reported with the frame
+    uint8_t len = 0;
+    uint8_t data[kEspNowMaxPayload] = {};
+};
+
+/**
+ * @brief Unicast datagrams to peers plus a non-blocking receive queue.
+ *
+ * Delivery is best effort: the caller acknowledges at its own layer.
+ */
+class IEspNowLink {
+public:
+    virtual ~IEspNowLink() = default;
+
+    /**
+     * @brief Queue @p len bytes (at most kEspNowMaxPayload) for @p to.
+     * @return false when the driver did not take the frame (not started,
+     *         queue full, oversize)
+     */
+    virtual bool send(const EspNowMac& to, const uint8_t* data, std::size_t len) = 0;
+
+    /// Pop the oldest received datagram into @p out; false when none. Never
+    /// blocks.
+    virtual bool receive(EspNowPacket& out) = 0;
+};
+
+#endif /* WATERINGSYSTEM_INTERFACES_IESPNOWLINK_H */
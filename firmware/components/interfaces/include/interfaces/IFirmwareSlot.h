@@ -0,0 +1,51 @@
+// SPDX-FileCopyrightText: 2026 Cryptotomte
+// SPDX-License-Identifier: AGPL-3.0-or-later
+/**
+ * @file IFirmwareSlot.h
+ * @brief The inactive app partition an OTA image is written to (hardware
+ *        seam).
+ *
+ * The host-test seam for api::OtaPipeline: the receive/write pipeline and
+ * its hash check are pure C++ above this interface; EspFirmwareSlot (api,
+ * target-only) is the only implementation that touches esp_ota_ops.
+ *
+ * One image at a time: begin(), then write() in order, then commit() or
+ * abort(). Nothing is switched until commit() succeeds, so an abandoned
+ * upload leaves the running app and the boot selection as they were.
+ *
+ * Part of the header-only `interfaces` component: no IDF includes allowed.
+ */
+
+#ifndef WATERINGSYSTEM_INTERFACES_IFIRMWARESLOT_H
+#define WATERINGSYSTEM_INTERFACES_IFIRMWARESLOT_H
+
+#include <cstddef>
+#include <cstdint>
+
+/**
+ * @brief Sequential writer for one firmware image.
+ *
+ * Not synchronized: OtaPipeline calls begin()/commit()/abort() from the
+ * receiving task and write() from its writer task, never two at once.
+ */
+class IFirmwareSlot {
+public:
+    virtual ~IFirmwareSlot() = default;
+
+    /// Largest image the slot holds (the partition size), 0 without one.
+    virtual std::size_t capacity() const = 0;
+
+    /// Open the slot for an image of @p imageBytes (<= capacity()).
+    virtual bool begin(std::size_t imageBytes) = 0;
+
+    /// Append @p len bytes; erases ahead of itself as it goes.
+    virtual bool write(const uint8_t* data, std::size_t len) = 0;
+
+    /// Validate the written image and select it for the next boot.
+    virtual bool commit() = 0;
+
+    /// Drop the image; the boot selection is untouched. Safe when not open.
+    virtual void abort() = 0;
+};
+
+#endif /* WATERINGSYSTEM_INTERFACES_IFIRMWARESLOT_H */
@@ -0,0 +1,66 @@
+// SPDX-FileCopyrightText: 2026 Cryptotomte
+// SPDX-License-Identifier: AGPL-3.0-or-later
+/**
+ * @file IFlashPartition.h
+ * @brief Raw NOR-flash data partition interface (hardware seam).
+ *
+ * The host-test seam for RingLogDataStorage: the ring-log format and its
+ * recovery logic are pure C++ above this interface and host-tested
+ * against RamFlashPartition (storage/testing/), which emulates NOR
+ * semantics; EspFlashPartition is the only implementation that touches
+ * esp_partition.
+ *
+ * NOR semantics are part of the contract: an erased byte reads 0xFF, a
+ * write can only clear bits (1 -> 0), and the only way back to 0xFF is
+ * erasing the whole sector. Callers therefore program each byte at most
+ * once between erases.
+ *
+ * Part of the header-only `interfaces` component: no IDF includes allowed.
+ */
+
+#ifndef WATERINGSYSTEM_INTERFACES_IFLASHPARTITION_H
+#define WATERINGSYSTEM_INTERFACES_IFLASHPARTITION_H
+
+#include <cstddef>
+#include <cstdint>
+
+/**
+ * @brief One raw flash partition: byte reads/writes, sector erases and an
+ * optional memory-mapped view.
+ *
+ * Offsets are relative to the partition start. Every method returns false
+ * on an out-of-range request or a driver error; there are NO retries at
+ * this layer. Not synchronized — the owning storage is wrapped in
+ * LockedDataStorage.
+ */
+class IFlashPartition {
+public:
+    /// Erase granularity (SPI NOR flash sector on the ESP32).
+    static constexpr std::size_t kSectorBytes = 4096;
+
+    virtual ~IFlashPartition() = default;
+
+    /// Partition size in bytes (a multiple of kSectorBytes).
+    virtual std::size_t size() const = 0;
+
+    /// Copy @p len bytes at @p offset into @p dst.
+    virtual bool read(std::size_t offset, void* dst, std::size_t len) const = 0;
+
+    /// Program @p len bytes at @p offset (bits can only be cleared).
+    virtual bool write(std::size_t offset, const void* src, std::size_t len) = 0;
+
+    /// Erase sector @p sector (offset sector * kSectorBytes) to 0xFF.
+    virtual bool eraseSector(std::size_t sector) = 0;
+
+    /**
+     * @brief Read-only view of the whole partition, or nullptr.
+     *
+     * When available, readers scan records in place instead of copying
+     * them through read(). The view reflects completed write()/
+     * eraseSector() calls (on target the flash driver invalidates the
+     * cache lines it programs).
+     */
+    virtual const uint8_t* mapped() const { return nullptr; }
+};
+
+#endif /* WATERINGSYSTEM_INTERFACES_IFLASHPARTITION_H */
@@ -0,0 +1,36 @@
+// SPDX-FileCopyrightText: 2026 Cryptotomte
+// SPDX-License-Identifier: AGPL-3.0-or-later
+/**
+ * @file IFlowMeter.h
+ * @brief Delivered volume and flow rate of one pump's line.
+ *
+ * What a WaterPump needs to dose by volume (WaterPump::setFlowMeter(),
+ * IWaterPump::runForVolume()): the running delivered total, read at the
+ * pump's update() cadence. FlowMeter implements it over an IPulseCounter.
+ *
+ * Part of the header-only `interfaces` component: no IDF includes allowed.
+ */
+
+#ifndef WATERINGSYSTEM_INTERFACES_IFLOWMETER_H
+#define WATERINGSYSTEM_INTERFACES_IFLOWMETER_H
+
+#include <cstdint>
+
+/**
+ * @brief A flow meter on one water line.
+ */
+class IFlowMeter {
+public:
+    virtual ~IFlowMeter() = default;
+
+    /**
+     * @brief Millilitres through the meter since it started, modulo 2^32;
+     * read live. Consumers take differences. Callable from any task.
+     */
+    virtual uint32_t deliveredMl() = 0;
+
+    /// Flow rate over the last readout window, in ml/min (0 when idle).
+    virtual float flowMlPerMin() = 0;
+};
+
+#endif /* WATERINGSYSTEM_INTERFACES_IFLOWMETER_H */
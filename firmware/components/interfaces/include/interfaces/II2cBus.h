@@ -98,6 +98,23 @@ public:
     virtual bool writeRegister16(uint8_t address7, uint8_t reg,
                                  uint16_t value) = 0;
 
+    /**
+     * @brief Change the SCL clock for every later transaction (100 kHz
+     * standard mode until called).
+     *
+     * Optional: the default reports "not supported" and the bus keeps its
+     * speed. Call only with no transaction in flight — I2cBusMaster's
+     * fast-mode probe holds its bus lock for exactly that.
+     *
+     * @param hz SCL frequency in Hz.
+     * @return true if the bus now runs at @p hz.
+     */
+    virtual bool setClockSpeed(uint32_t hz)
+    {
+        (void)hz;
+        return false;
+    }
+
     /**
      * @brief Read one 16-bit register value, BIG-ENDIAN decoded.
      *
@@ -0,0 +1,35 @@
+// SPDX-FileCopyrightText: 2026 Cryptotomte
+// SPDX-License-Identifier: AGPL-3.0-or-later
+/**
+ * @file ILevelObserver.h
+ * @brief Callback for a level mark's debounced state changes.
+ *
+ * The push counterpart of polling ILevelSensor::isWaterPresent(): a
+ * DebouncedLevelSensor with an observer calls it from inside update(), the
+ * moment its reported state changes, so a consumer that must react at once
+ * (ReservoirController's high-mark stop) does not wait for its own cadence.
+ *
+ * Part of the header-only `interfaces` component: no IDF includes allowed.
+ */
+
+#ifndef WATERINGSYSTEM_INTERFACES_ILEVELOBSERVER_H
+#define WATERINGSYSTEM_INTERFACES_ILEVELOBSERVER_H
+
+/**
+ * @brief Receives a level mark's isWaterPresent() transitions.
+ */
+class ILevelObserver {
+public:
+    virtual ~ILevelObserver() = default;
+
+    /**
+     * @brief The mark's reported state changed to @p waterPresent.
+     *
+     * Runs on the task that updates the sensor, inside its update() — and
+     * so inside LockedLevelSensor's lock: an implementation must be short
+     * and must not call back into the sensor.
+     */
+    virtual void onWaterPresentChanged(bool waterPresent) = 0;
+};
+
+#endif /* WATERINGSYSTEM_INTERFACES_ILEVELOBSERVER_H */
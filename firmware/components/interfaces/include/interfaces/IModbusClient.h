@@ -22,8 +22,8 @@
  *          interface, never by IModbusClient implementations themselves
  *   100+n  Modbus slave exception n (when the implementation can surface it
  *          — EspModbusClient collapses slave exceptions onto code 2,
- *          research.md R6; only test mocks emit 100+n today; consumers must
- *          not branch on 100+n)
+ *          research.md R6; UartModbusClient and the test mocks emit
+ *          100+n; consumers must not branch on 100+n)
  *
  * Part of the header-only `interfaces` component: no IDF includes allowed.
  */
@@ -84,6 +84,27 @@ public:
     virtual bool writeSingleRegister(uint8_t deviceAddress, uint16_t registerAddress,
                                      uint16_t value) = 0;
 
+    /**
+     * @brief Write consecutive holding registers (Modbus function 0x10).
+     *
+     * One bus attempt for all @p count registers, no retry: the slave
+     * applies the whole block or none of it, so a multi-register setting
+     * is never left half-written by a failure between single writes.
+     * Success means a well-formed FC16 response (address, function and
+     * CRC validated); the echoed start/count need not be compared, as for
+     * writeSingleRegister(). A @p count of 0 or above 123 (the protocol
+     * limit) fails with error 2 without a transfer.
+     *
+     * @param deviceAddress Modbus slave address.
+     * @param startRegister First holding register address.
+     * @param count Number of consecutive registers to write.
+     * @param values Caller-owned array of @p count values.
+     * @return true if the slave acknowledged the write with a well-formed
+     *         response.
+     */
+    virtual bool writeMultipleRegisters(uint8_t deviceAddress, uint16_t startRegister,
+                                        uint16_t count, const uint16_t* values) = 0;
+
     /**
      * @brief Error code of the most recent operation (0 = OK; table above).
      */
@@ -103,14 +124,35 @@ public:
     /**
      * @brief Cumulative transaction statistics.
      *
-     * Every readHoldingRegisters()/writeSingleRegister() call increments
-     * exactly one of the two counters; reading the statistics increments
-     * neither.
+     * Every readHoldingRegisters()/writeSingleRegister()/
+     * writeMultipleRegisters() call increments exactly one of the two
+     * counters; reading the statistics increments neither.
      *
      * @param successCount Out: number of successful transfers.
      * @param errorCount Out: number of failed transfers.
      */
     virtual void getStatistics(uint32_t* successCount, uint32_t* errorCount) = 0;
+
+    /**
+     * @brief Switch the line rate (still 8N1) for subsequent transfers.
+     *
+     * Optional: the default keeps the parity 9600 baud and reports false.
+     * On an uninitialized client the rate is recorded for initialize();
+     * on a failure the previous rate stays in effect. Only the master
+     * side changes — telling the slaves is the caller's job
+     * (sensors/ModbusBaudNegotiator.h).
+     *
+     * @param baud Line rate in baud.
+     * @return true when @p baud is in effect.
+     */
+    virtual bool setBaudRate(uint32_t baud)
+    {
+        (void)baud;
+        return false;
+    }
+
+    /// Line rate of subsequent transfers (parity 9600 unless set).
+    virtual uint32_t baudRate() { return 9600; }
 };
 
 #endif /* WATERINGSYSTEM_INTERFACES_IMODBUSCLIENT_H */
@@ -0,0 +1,59 @@
+// SPDX-FileCopyrightText: 2026 Cryptotomte
+// SPDX-License-Identifier: AGPL-3.0-or-later
+/**
+ * @file IMqttClient.h
+ * @brief MQTT broker seam (publish + non-blocking event poll).
+ *
+ * The host-test seam of the MQTT uplink: the pure api::MqttUplink holds the
+ * batching, in-flight window and replay logic above this interface and is
+ * host-tested against MockMqttClient; EspMqttClient (esp-mqtt) is the only
+ * implementation that touches the network and is excluded from the linux
+ * build. Same shape as IWifiDriver: calls never block on the network, the
+ * outcome arrives later as an event via pollEvent().
+ *
+ * Part of the header-only `interfaces` component: no IDF includes allowed.
+ */
+
+#ifndef WATERINGSYSTEM_INTERFACES_IMQTTCLIENT_H
+#define WATERINGSYSTEM_INTERFACES_IMQTTCLIENT_H
+
+#include <cstdint>
+#include <string>
+
+/**
+ * @brief Broker session events, drained one per call via pollEvent().
+ *
+ * `Connected` = the session is up (CONNACK). `Disconnected` = it dropped;
+ * messages not yet acknowledged are then presumed lost. `Published` = the
+ * broker acknowledged (PUBACK) the QoS 1 message `msgId`. `None` = the
+ * event queue is empty.
+ */
+enum class MqttEventType : uint8_t { None, Connected, Disconnected, Published };
+
+struct MqttEvent {
+    MqttEventType type = MqttEventType::None;
+    int msgId = -1;  ///< Published only
+};
+
+/**
+ * @brief One persistent broker session plus a non-blocking event queue.
+ *
+ * The implementation owns the connection and reconnects on its own; the
+ * caller only publishes while the last event it drained was `Connected`.
+ */
+class IMqttClient {
+public:
+    virtual ~IMqttClient() = default;
+
+    /**
+     * @brief Queue @p payload on @p topic at QoS 1.
+     * @return the message id its `Published` event will carry (> 0), or -1
+     *         when the client did not take it (not connected, outbox full)
+     */
+    virtual int publish(const std::string& topic, const std::string& payload) = 0;
+
+    /// Next queued event, or MqttEventType::None. Never blocks.
+    virtual MqttEvent pollEvent() = 0;
+};
+
+#endif /* WATERINGSYSTEM_INTERFACES_IMQTTCLIENT_H */
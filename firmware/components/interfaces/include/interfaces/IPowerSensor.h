@@ -25,6 +25,24 @@
 #ifndef WATERINGSYSTEM_INTERFACES_IPOWERSENSOR_H
 #define WATERINGSYSTEM_INTERFACES_IPOWERSENSOR_H
 
+#include <cmath>
+#include <cstdint>
+
+/**
+ * @brief Consistent power snapshot: V/I/P plus the error code, copied out
+ * together. valid = the last operation succeeded and a reading is on record
+ * (finite bus voltage).
+ */
+struct PowerSnapshot {
+    bool valid = false;
+    int lastError = 0;
+    uint32_t sequence = 0; ///< successful reads so far (0 = none yet)
+    int64_t atMs = 0;      ///< monotonic time of that read; 0 = unstamped
+    float busVoltage = NAN;
+    float current = NAN;
+    float power = NAN;
+};
+
 /**
  * @brief Power sensor: atomic V/I/P snapshots with lazy recovery.
  *
@@ -102,6 +120,84 @@ public:
 
     /// Power in W.
     virtual float getPower() = 0;
+
+    /**
+     * @brief The cached reading as one struct. NON-BLOCKING: no read(), no
+     * isAvailable() probe.
+     *
+     * valid = lastError == 0 and a reading is on record. sequence counts
+     * successful read() calls, so a consumer tells a new sample from one it
+     * has seen. atMs is 0 from a bare driver (it has no clock);
+     * LockedPowerSensor stamps it with the time it first published that
+     * sequence.
+     */
+    virtual PowerSnapshot snapshot() = 0;
+
+    /**
+     * @brief µs between two new results of a continuously converting
+     * sensor; 0 = unknown (the default): the caller picks its own cadence.
+     */
+    virtual uint32_t conversionPeriodUs() { return 0; }
+
+    /**
+     * @brief Signal each new result on the sensor's alert output (true) or
+     * stop doing so. False = not supported or the write failed; read()
+     * keeps working either way.
+     */
+    virtual bool setConversionReadyAlert(bool enable)
+    {
+        (void)enable;
+        return false;
+    }
+
+    /**
+     * @brief Whether a read() is due: a new result has completed since the
+     * last call, or the sensor needs read() to recover. Consumes the flag
+     * (and clears a pending alert). A sensor without a flag always reports
+     * true (the default).
+     */
+    virtual bool conversionReady() { return true; }
+
+    /**
+     * @brief Assert the sensor's alert output while the current is above
+     * @p amps (<= 0 = no limit). The same output as the conversion-ready
+     * alert: the limit takes precedence while set. False = not supported
+     * or the write failed.
+     */
+    virtual bool setOverCurrentLimit(float amps)
+    {
+        (void)amps;
+        return false;
+    }
+
+    /**
+     * @brief Switch to the sensor's high-rate sampling for current capture
+     * (true), or back to the normal setting. conversionPeriodUs() reports
+     * the rate in effect. False = not supported or the write failed.
+     */
+    virtual bool setHighRateSampling(bool enable)
+    {
+        (void)enable;
+        return false;
+    }
+
+    /**
+     * @brief Read the current alone, for capture at the high rate.
+     *
+     * Leaves the snapshot and the getters alone (the other values are not
+     * refreshed with it); failures follow read(). The default is a full
+     * read().
+     *
+     * @param amps Signed current in A; defined only when true is returned.
+     */
+    virtual bool readCurrent(float& amps)
+    {
+        if (!read()) {
+            return false;
+        }
+        amps = getCurrent();
+        return true;
+    }
 };
 
 #endif /* WATERINGSYSTEM_INTERFACES_IPOWERSENSOR_H */
@@ -0,0 +1,36 @@
+// SPDX-FileCopyrightText: 2026 Cryptotomte
+// SPDX-License-Identifier: AGPL-3.0-or-later
+/**
+ * @file IPulseCounter.h
+ * @brief Injected hardware pulse count (the flow-meter seam).
+ *
+ * FlowMeter turns a count into volume and flow rate above this interface
+ * and is host-tested against a scripted count; PcntPulseCounter is the
+ * target implementation (the ESP32 PCNT peripheral counts in hardware, no
+ * interrupt per pulse). Same interface-injection style as IDigitalInput.
+ *
+ * Part of the header-only `interfaces` component: no IDF includes allowed.
+ */
+
+#ifndef WATERINGSYSTEM_INTERFACES_IPULSECOUNTER_H
+#define WATERINGSYSTEM_INTERFACES_IPULSECOUNTER_H
+
+#include <cstdint>
+
+/**
+ * @brief A running count of input pulses.
+ */
+class IPulseCounter {
+public:
+    virtual ~IPulseCounter() = default;
+
+    /**
+     * @brief Pulses counted since the counter started, modulo 2^32.
+     *
+     * Consumers take differences (unsigned wrap-around arithmetic), never
+     * the absolute value. Callable from any task.
+     */
+    virtual uint32_t pulses() = 0;
+};
+
+#endif /* WATERINGSYSTEM_INTERFACES_IPULSECOUNTER_H */
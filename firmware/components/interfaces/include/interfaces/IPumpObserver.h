@@ -0,0 +1,36 @@
+// SPDX-FileCopyrightText: 2026 Cryptotomte
+// SPDX-License-Identifier: AGPL-3.0-or-later
+/**
+ * @file IPumpObserver.h
+ * @brief Callback for a pump's running-state changes.
+ *
+ * The push counterpart of polling IWaterPump::isRunning(): a WaterPump with
+ * an observer calls it the moment it switches on or off — from runFor(),
+ * stop() or update(), whichever task made the change — so a consumer that
+ * logs or accounts runs (SystemObserver) needs no cadence of its own.
+ *
+ * Part of the header-only `interfaces` component: no IDF includes allowed.
+ */
+
+#ifndef WATERINGSYSTEM_INTERFACES_IPUMPOBSERVER_H
+#define WATERINGSYSTEM_INTERFACES_IPUMPOBSERVER_H
+
+/**
+ * @brief Receives a pump's isRunning() transitions.
+ */
+class IPumpObserver {
+public:
+    virtual ~IPumpObserver() = default;
+
+    /**
+     * @brief The pump's running state changed to @p running.
+     *
+     * Runs on the task that commanded or updated the pump, after the output
+     * was switched — and so inside LockedWaterPump's lock: an
+     * implementation must be short, must not block and must not call back
+     * into the pump.
+     */
+    virtual void onRunningChanged(bool running) = 0;
+};
+
+#endif /* WATERINGSYSTEM_INTERFACES_IPUMPOBSERVER_H */
@@ -0,0 +1,43 @@
+// SPDX-FileCopyrightText: 2026 Cryptotomte
+// SPDX-License-Identifier: AGPL-3.0-or-later
+/**
+ * @file IRunningImage.h
+ * @brief The app image the device is running, as the base of a delta OTA
+ *        patch (hardware seam).
+ *
+ * A delta upload (api/DeltaPatch.h) rebuilds the new image from this one
+ * plus the patch, so the pipeline must know exactly which image it has:
+ * size() and sha256() identify it, read() serves its bytes while the
+ * patch is applied. EspRunningImage (api, target-only) reads the running
+ * app partition; the host tests use a byte vector.
+ *
+ * Part of the header-only `interfaces` component: no IDF includes allowed.
+ */
+
+#ifndef WATERINGSYSTEM_INTERFACES_IRUNNINGIMAGE_H
+#define WATERINGSYSTEM_INTERFACES_IRUNNINGIMAGE_H
+
+#include <cstddef>
+#include <cstdint>
+
+/**
+ * @brief Read-only view of the running image.
+ *
+ * Not synchronized: OtaPipeline calls it from the receiving task only.
+ */
+class IRunningImage {
+public:
+    virtual ~IRunningImage() = default;
+
+    /// Image bytes (the .bin as built, padding and appended digest
+    /// included), 0 when unknown.
+    virtual std::size_t size() = 0;
+
+    /// SHA-256 of those size() bytes into @p out; false when unknown.
+    virtual bool sha256(uint8_t out[32]) = 0;
+
+    /// @p len bytes from @p offset (within size()) into @p dst.
+    virtual bool read(std::size_t offset, uint8_t* dst, std::size_t len) = 0;
+};
+
+#endif /* WATERINGSYSTEM_INTERFACES_IRUNNINGIMAGE_H */
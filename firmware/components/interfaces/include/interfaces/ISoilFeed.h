@@ -0,0 +1,50 @@
+// SPDX-FileCopyrightText: 2026 Cryptotomte
+// SPDX-License-Identifier: AGPL-3.0-or-later
+/**
+ * @file ISoilFeed.h
+ * @brief Latest timestamped soil snapshot, published by an acquisition task.
+ *
+ * Lets the watering decision consume soil data without driving the bus: a
+ * separate task does the blocking read() and publishes the result here;
+ * the consumer takes latest() (non-blocking) and tells a new sample from
+ * one it has already seen by the sequence number.
+ *
+ * Part of the header-only `interfaces` component: no IDF includes allowed.
+ */
+
+#ifndef WATERINGSYSTEM_INTERFACES_ISOILFEED_H
+#define WATERINGSYSTEM_INTERFACES_ISOILFEED_H
+
+#include <cstdint>
+
+#include "interfaces/ISoilSensor.h"
+
+/// One published soil sample.
+///
+/// Each read covers a register group (SoilReadGroup); fastAtMs/slowAtMs
+/// say how fresh each group's values in @c soil are.
+struct TimedSoilSnapshot {
+    SoilSnapshot soil;     ///< snapshot() right after the read
+    int64_t atMs = 0;      ///< monotonic time the read finished
+    uint32_t sequence = 0; ///< 0 = nothing published yet; +1 per read
+    SoilReadGroup group = SoilReadGroup::All;  ///< what this read covered
+    int64_t fastAtMs = 0;  ///< last successful fast-group read; 0 = none
+    int64_t slowAtMs = 0;  ///< last successful slow-group read; 0 = none
+    /// The moisture has not moved for long enough to look stuck (a
+    /// publisher with a flatline detector); the values are still the
+    /// probe's, but not to be decided on.
+    bool suspect = false;
+};
+
+/**
+ * @brief Source of the newest soil sample.
+ */
+class ISoilFeed {
+public:
+    virtual ~ISoilFeed() = default;
+
+    /// The newest published sample; NON-BLOCKING (no bus I/O, a copy only).
+    virtual TimedSoilSnapshot latest() const = 0;
+};
+
+#endif /* WATERINGSYSTEM_INTERFACES_ISOILFEED_H */
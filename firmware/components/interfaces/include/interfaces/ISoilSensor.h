@@ -27,6 +27,33 @@
 #ifndef WATERINGSYSTEM_INTERFACES_ISOILSENSOR_H
 #define WATERINGSYSTEM_INTERFACES_ISOILSENSOR_H
 
+#include <cstdint>
+
+/**
+ * @brief Register groups a read may be limited to (readGroup()).
+ *
+ * The controller decides on moisture alone, while EC/pH/NPK change over
+ * hours and are only logged: the fast group keeps the hot read at two
+ * registers, the slow group is read at the data-log cadence.
+ */
+enum class SoilReadGroup : uint8_t {
+    All,   ///< every quantity: the parity 9-register read()
+    Fast,  ///< moisture/humidity and temperature (0x0000–0x0001)
+    Slow,  ///< EC, pH, N, P, K (0x0002–0x0006)
+};
+
+/// Whether a read of @p group refreshes moisture/humidity and temperature.
+inline bool readsFastGroup(SoilReadGroup group)
+{
+    return group != SoilReadGroup::Slow;
+}
+
+/// Whether a read of @p group refreshes EC, pH and NPK.
+inline bool readsSlowGroup(SoilReadGroup group)
+{
+    return group != SoilReadGroup::Fast;
+}
+
 /**
  * @brief Consistent, non-blocking soil-reading snapshot (PR-11).
  *
@@ -37,10 +64,16 @@
  * values are meaningful even when the latest read failed (stale-but-usable).
  * lastError is the sensor's most recent error code. Default member
  * initializers make a default-constructed snapshot safe (no read yet).
+ *
+ * With group reads, readOk/available follow the reads that covered the fast
+ * group and slowReadOk/slowAvailable the ones that covered the slow group;
+ * after plain read() calls both pairs agree.
  */
 struct SoilSnapshot {
     bool readOk = false;
     bool available = false;
+    bool slowReadOk = false;     ///< last read covering EC/pH/NPK succeeded
+    bool slowAvailable = false;  ///< EC/pH/NPK from a successful read on record
     int lastError = 0;
     float moisture = 0.0f;
     float temperature = 0.0f;
@@ -82,6 +115,22 @@ public:
      */
     virtual bool read() = 0;
 
+    /**
+     * @brief read() limited to the registers of @p group.
+     *
+     * Same single-attempt, all-or-nothing contract as read(), over the
+     * group's registers only: the quantities of the other group keep their
+     * last-good values (and their readOk/available flags). Optional: the
+     * default reads everything, which also satisfies a request for less.
+     *
+     * @return true if every quantity of the group was read and validated.
+     */
+    virtual bool readGroup(SoilReadGroup group)
+    {
+        (void)group;
+        return read();
+    }
+
     /**
      * @brief Coherent, NON-BLOCKING snapshot of the last-good reading.
      *
@@ -0,0 +1,41 @@
+// SPDX-FileCopyrightText: 2026 Cryptotomte
+// SPDX-License-Identifier: AGPL-3.0-or-later
+/**
+ * @file IStaticAssets.h
+ * @brief The gzipped frontend assets on the storage volume (seam).
+ *
+ * The SPA's assets are stored pre-gzipped with build-time ETags and kept
+ * in RAM once read (api/AssetCache.h). The provisioning portal (network)
+ * serves its pages from the same store, but network sits below api, so it
+ * reaches the store through this seam; api::AssetStore implements it.
+ *
+ * Part of the header-only `interfaces` component: no IDF includes allowed.
+ */
+
+#ifndef WATERINGSYSTEM_INTERFACES_ISTATICASSETS_H
+#define WATERINGSYSTEM_INTERFACES_ISTATICASSETS_H
+
+#include <memory>
+#include <string>
+
+/// One asset as stored: gzip bytes and quoted strong ETag ("" untagged).
+struct StaticAsset {
+    std::shared_ptr<const std::string> gz;
+    std::string etag;
+};
+
+/**
+ * @brief Read access to the stored assets.
+ *
+ * Thread-safe: called from any httpd task.
+ */
+class IStaticAssets {
+public:
+    virtual ~IStaticAssets() = default;
+
+    /// The stored @p path (relative, no ".gz") into @p out; false when it
+    /// is missing or too large to hand out whole.
+    virtual bool fetch(const std::string& path, StaticAsset& out) = 0;
+};
+
+#endif /* WATERINGSYSTEM_INTERFACES_ISTATICASSETS_H */
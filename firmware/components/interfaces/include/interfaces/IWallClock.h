@@ -19,6 +19,12 @@
 
 #include <cstdint>
 
+/// One wall-clock reading: the epoch and whether it is set, taken together.
+struct WallTime {
+    uint32_t epoch = 0;
+    bool set = false;  ///< isTimeSet() for this very epoch
+};
+
 /**
  * @brief Wall-clock (calendar) time source in epoch seconds.
  */
@@ -41,6 +47,22 @@ public:
      * False before the wall clock has been set from a trusted source.
      */
     virtual bool isTimeSet() const = 0;
+
+    /**
+     * @brief nowEpoch() and isTimeSet() as one reading.
+     *
+     * Two separate calls can straddle the moment SNTP sets the clock and
+     * pair a boot epoch with "set"; callers that need both use this. The
+     * default makes the two calls; implementations override it with one
+     * read.
+     */
+    virtual WallTime now() const
+    {
+        WallTime t;
+        t.epoch = nowEpoch();
+        t.set = isTimeSet();
+        return t;
+    }
 };
 
 #endif /* WATERINGSYSTEM_INTERFACES_IWALLCLOCK_H */
@@ -27,6 +27,16 @@ enum class StopReason {
     Commanded,        ///< Explicit stop() call
     DurationElapsed,  ///< Timed run completed normally
     MaxRuntimeForced, ///< Hard max-runtime cap enforced (logged as an error)
+    VolumeReached,    ///< Volume run delivered its target (runForVolume())
+};
+
+/**
+ * @brief What a flow meter saw of the most recent completed run.
+ */
+struct PumpRunVolume {
+    bool metered = false;   ///< false: no flow meter on this pump, or no run yet
+    uint32_t volumeMl = 0;  ///< delivered between switch on and switch off
+    int64_t runMs = 0;      ///< the run's length
 };
 
 /**
@@ -50,6 +60,23 @@ public:
      */
     virtual bool runFor(int durationS) = 0;
 
+    /**
+     * @brief Start a run that stops once a flow meter has counted
+     * @p volumeMl, or after @p maxDurationS at the latest.
+     *
+     * The runFor() contract applies to @p maxDurationS (the time cap keeps
+     * a dead meter or a dry line from running forever); @p volumeMl <= 0
+     * and a pump without a flow meter are rejected. A volume stop is
+     * StopReason::VolumeReached, a time stop DurationElapsed. The default
+     * (no flow metering) rejects every request.
+     */
+    virtual bool runForVolume(int volumeMl, int maxDurationS)
+    {
+        (void)volumeMl;
+        (void)maxDurationS;
+        return false;
+    }
+
     /**
      * @brief Stop the pump.
      *
@@ -87,6 +114,12 @@ public:
      * @brief Reason for the most recent stop (StopReason::None if never run).
      */
     virtual StopReason getLastStopReason() const = 0;
+
+    /**
+     * @brief Volume of the most recent completed run (metered = false
+     * without a flow meter, the default).
+     */
+    virtual PumpRunVolume getLastRunVolume() const { return PumpRunVolume{}; }
 };
 
 #endif /* WATERINGSYSTEM_INTERFACES_IWATERPUMP_H */
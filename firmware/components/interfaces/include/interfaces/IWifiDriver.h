@@ -19,6 +19,7 @@
 
 #include <cstdint>
 #include <string>
+#include <vector>
 
 /**
  * @brief WiFi lifecycle events, drained one per tick via pollEvent().
@@ -33,6 +34,35 @@
  */
 enum class WifiEvent { None, Connected, GotIp, Disconnected, ConnectFailed };
 
+/**
+ * @brief How a station attempt finds its AP.
+ *
+ * `Cached` = directed connect to the AP of the last successful association
+ * (its BSSID on its channel, same auth mode): one channel is probed instead
+ * of all of them, a few hundred ms instead of seconds. `FullScan` = look for
+ * the SSID on every channel, as a first-ever connect does.
+ */
+enum class WifiConnectTier { Cached, FullScan };
+
+/**
+ * @brief Station power save (esp_wifi modem sleep).
+ *
+ * `None` = radio always on: lowest latency, highest current. `MinModem` =
+ * wake for every DTIM beacon (the IDF default). `MaxModem` = wake every
+ * listen interval: least current, a request may wait that many beacons.
+ */
+enum class WifiPowerSave : uint8_t { None, MinModem, MaxModem };
+
+/**
+ * @brief One access point seen by a scan.
+ */
+struct WifiNetwork {
+    std::string ssid;  ///< raw bytes as broadcast (not necessarily UTF-8)
+    int8_t rssi = 0;   ///< dBm
+    uint8_t channel = 0;
+    bool open = false;  ///< no password needed
+};
+
 /**
  * @brief STA/AP control plus a non-blocking event queue.
  *
@@ -52,11 +82,20 @@ public:
      *
      * @param ssid Network SSID to join.
      * @param password Network password (empty for an open network).
+     * @param tier Directed connect to the cached AP, or a full scan. A
+     *        Cached request without a cached AP for @p ssid is a full scan.
      * @return false only on a synchronous config error; success/failure of
      *         the attempt itself arrives later as a WifiEvent.
      */
-    virtual bool staConnect(const std::string& ssid,
-                            const std::string& password) = 0;
+    virtual bool staConnect(const std::string& ssid, const std::string& password,
+                            WifiConnectTier tier) = 0;
+
+    /**
+     * @brief True when the AP of an earlier successful association with
+     * @p ssid is remembered (it survives resets), so a Cached attempt can
+     * skip the scan. The driver refreshes it on every GotIp.
+     */
+    virtual bool hasCachedAp(const std::string& ssid) const = 0;
 
     /**
      * @brief Stop STA / disconnect. Idempotent.
@@ -90,6 +129,31 @@ public:
      * @brief Last known RSSI in dBm; unspecified when not connected.
      */
     virtual int8_t rssi() const = 0;
+
+    /**
+     * @brief Switch the station power save mode (non-blocking).
+     *
+     * @param mode Modem sleep mode, effective at once.
+     * @param listenInterval Beacons between wake-ups under MaxModem;
+     *        applies from the next association.
+     * @return false when the radio refused the mode (unchanged).
+     */
+    virtual bool setPowerSave(WifiPowerSave mode, uint8_t listenInterval) = 0;
+
+    /**
+     * @brief Start an all-channel scan (non-blocking); works beside the
+     * SoftAP. Its end is collected with takeScanResults(), not pollEvent().
+     * @return false when a scan could not start (one already running
+     *         included)
+     */
+    virtual bool startScan() = 0;
+
+    /**
+     * @brief The APs of the scan that ended since the last call, in the
+     * radio's order; false (with @p out untouched) while a scan runs or
+     * when none was started. A failed scan ends with an empty list.
+     */
+    virtual bool takeScanResults(std::vector<WifiNetwork>& out) = 0;
 };
 
 #endif /* WATERINGSYSTEM_INTERFACES_IWIFIDRIVER_H */
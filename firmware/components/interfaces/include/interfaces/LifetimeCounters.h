@@ -0,0 +1,227 @@
+// SPDX-FileCopyrightText: 2026 Cryptotomte
+// SPDX-License-Identifier: AGPL-3.0-or-later
+/**
+ * @file LifetimeCounters.h
+ * @brief Counters that survive resets: since-boot figures rebased on what
+ *        earlier boots had counted (header-only).
+ *
+ * The firmware's counters (pump run time, dropped events, storage writes)
+ * start from zero at every boot. LifetimeCounters keeps, per counter, the
+ * total of all earlier boots (the base) and publishes base + since-boot
+ * whenever the owner samples the live figure, so no producer changes and an
+ * increment costs nothing extra.
+ *
+ * PERSISTENCE: seal() writes the totals into a CRC-checked
+ * LifetimeCounterBlock. main/lifetime_counters seals once a second into
+ * RTC_NOINIT memory (alternating two blocks, so a reset mid-write leaves
+ * the other one valid), which survives software, panic, watchdog and
+ * brownout resets but not a power cycle; every
+ * CONFIG_WS_LIFETIME_COUNTERS_NVS_FLUSH_MIN and before esp_restart() it
+ * also copies the newest block to NVS. restore() takes the valid candidate
+ * with the highest sequence: the RTC block after a warm reset, the NVS copy
+ * after a cold one, zeros on a first boot or after a layout change. At most
+ * the last second (warm) or flush interval (cold) is lost.
+ *
+ * THREADS: restore(), add(), sample() and seal() are one writer's (boot
+ * wiring, then the counters task); load() is for any task and never blocks
+ * the writer (Seqlock). No allocation, no IDF includes.
+ */
+
+#ifndef WATERINGSYSTEM_INTERFACES_LIFETIMECOUNTERS_H
+#define WATERINGSYSTEM_INTERFACES_LIFETIMECOUNTERS_H
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <initializer_list>
+#include <type_traits>
+
+#include "interfaces/Seqlock.h"
+
+/// What is counted. Appending keeps stored blocks valid (count is stored);
+/// reordering or removing one needs a LifetimeCounterBlock::kVersion bump.
+enum class LifetimeCounter : uint8_t {
+    Boots,
+    WatchdogResets,   ///< TASK_WDT, INT_WDT and other watchdog resets
+    PanicResets,
+    BrownoutResets,
+    PlantPumpRunMs,
+    ReservoirPumpRunMs,
+    ZonePumpRunMs,    ///< all zone pumps together
+    EventsDropped,
+    StorageQueueDropped,
+    StorageBytesAppended,
+    StorageSyncs,
+    kCount
+};
+
+constexpr std::size_t kLifetimeCounterCount = static_cast<std::size_t>(LifetimeCounter::kCount);
+
+/// Name of @p counter in the console and in /metrics labels.
+inline const char* lifetimeCounterName(LifetimeCounter counter)
+{
+    switch (counter) {
+        case LifetimeCounter::Boots:                return "boots";
+        case LifetimeCounter::WatchdogResets:       return "watchdog_resets";
+        case LifetimeCounter::PanicResets:          return "panic_resets";
+        case LifetimeCounter::BrownoutResets:       return "brownout_resets";
+        case LifetimeCounter::PlantPumpRunMs:       return "plant_pump_run_ms";
+        case LifetimeCounter::ReservoirPumpRunMs:   return "reservoir_pump_run_ms";
+        case LifetimeCounter::ZonePumpRunMs:        return "zone_pump_run_ms";
+        case LifetimeCounter::EventsDropped:        return "events_dropped";
+        case LifetimeCounter::StorageQueueDropped:  return "storage_queue_dropped";
+        case LifetimeCounter::StorageBytesAppended: return "storage_bytes_appended";
+        case LifetimeCounter::StorageSyncs:         return "storage_syncs";
+        case LifetimeCounter::kCount:               break;
+    }
+    return "?";
+}
+
+/// The totals, as load() copies them out.
+struct LifetimeCounterValues {
+    std::array<uint64_t, kLifetimeCounterCount> values{};
+
+    uint64_t operator[](LifetimeCounter c) const { return values[static_cast<std::size_t>(c)]; }
+};
+
+/// The persisted form: fixed layout, checked by magic, version and CRC-32.
+/// Trivial (no initializers), so it can sit in RTC_NOINIT memory; value-
+/// initialize it ({}) elsewhere.
+struct LifetimeCounterBlock {
+    static constexpr uint32_t kMagic = 0x434C5357u;  ///< "WSLC"
+    static constexpr uint16_t kVersion = 1;
+    static constexpr std::size_t kSlots = 16;  ///< room to append counters
+
+    uint32_t magic;
+    uint16_t version;
+    uint16_t count;      ///< counters in use when sealed
+    uint32_t sequence;   ///< bumped by every seal()
+    uint32_t reserved;
+    uint64_t values[kSlots];
+    uint32_t crc;        ///< CRC-32 of everything above
+    uint32_t pad;
+};
+static_assert(kLifetimeCounterCount <= LifetimeCounterBlock::kSlots,
+              "the counters fit the persisted block");
+static_assert(std::is_trivial<LifetimeCounterBlock>::value,
+              "RTC_NOINIT memory is never constructed");
+
+class LifetimeCounters {
+public:
+    LifetimeCounters() = default;
+    LifetimeCounters(const LifetimeCounters&) = delete;
+    LifetimeCounters& operator=(const LifetimeCounters&) = delete;
+
+    /// True when @p block is intact and of this layout.
+    static bool valid(const LifetimeCounterBlock& block)
+    {
+        return block.magic == LifetimeCounterBlock::kMagic &&
+               block.version == LifetimeCounterBlock::kVersion &&
+               block.count <= LifetimeCounterBlock::kSlots && block.crc == crcOf(block);
+    }
+
+    /**
+     * @brief Take the bases from the valid candidate with the highest
+     * sequence (null candidates are skipped); all zero when none is valid.
+     * Counters the chosen block predates start from zero.
+     * @return the candidate used, or nullptr
+     */
+    const LifetimeCounterBlock* restore(std::initializer_list<const LifetimeCounterBlock*> candidates)
+    {
+        const LifetimeCounterBlock* best = nullptr;
+        for (const LifetimeCounterBlock* block : candidates) {
+            if (block != nullptr && valid(*block) &&
+                (best == nullptr || block->sequence > best->sequence)) {
+                best = block;
+            }
+        }
+        base_ = {};
+        sinceBoot_ = {};
+        sequence_ = 0;
+        if (best != nullptr) {
+            sequence_ = best->sequence;
+            for (std::size_t i = 0; i < best->count && i < kLifetimeCounterCount; ++i) {
+                base_[i] = best->values[i];
+            }
+        }
+        publish();
+        return best;
+    }
+
+    /// Count @p n for @p counter on top of its base (boot-time events such
+    /// as the reset reason, which have no since-boot source).
+    void add(LifetimeCounter counter, uint64_t n)
+    {
+        base_[index(counter)] += n;
+        publish();
+    }
+
+    /// Record @p sinceBoot, the live since-boot figure of @p counter. Visible
+    /// to load() after the next seal().
+    void sample(LifetimeCounter counter, uint64_t sinceBoot)
+    {
+        sinceBoot_[index(counter)] = sinceBoot;
+    }
+
+    /// Write the totals into @p out (sequence bumped, CRC set) and publish
+    /// them to load().
+    void seal(LifetimeCounterBlock& out)
+    {
+        const LifetimeCounterValues totals = publish();
+        LifetimeCounterBlock block{};
+        block.magic = LifetimeCounterBlock::kMagic;
+        block.version = LifetimeCounterBlock::kVersion;
+        block.count = static_cast<uint16_t>(kLifetimeCounterCount);
+        block.sequence = ++sequence_;
+        for (std::size_t i = 0; i < kLifetimeCounterCount; ++i) {
+            block.values[i] = totals.values[i];
+        }
+        block.crc = crcOf(block);
+        out = block;
+    }
+
+    /// Sequence of the newest seal() (or of the restored block).
+    uint32_t sequence() const { return sequence_; }
+
+    /// Copy the totals as of the last seal() or add(); false only while
+    /// racing the writer repeatedly (@p out untouched).
+    bool load(LifetimeCounterValues& out) const { return published_.tryLoad(out); }
+
+private:
+    static std::size_t index(LifetimeCounter counter)
+    {
+        return static_cast<std::size_t>(counter);
+    }
+
+    /// CRC-32 (IEEE, reflected) of the block up to its crc field.
+    static uint32_t crcOf(const LifetimeCounterBlock& block)
+    {
+        const auto* bytes = reinterpret_cast<const uint8_t*>(&block);
+        const std::size_t len = offsetof(LifetimeCounterBlock, crc);
+        uint32_t crc = 0xFFFFFFFFu;
+        for (std::size_t i = 0; i < len; ++i) {
+            crc ^= bytes[i];
+            for (int bit = 0; bit < 8; ++bit) {
+                crc = (crc >> 1) ^ (0xEDB88320u & (0u - (crc & 1u)));
+            }
+        }
+        return ~crc;
+    }
+
+    LifetimeCounterValues publish()
+    {
+        LifetimeCounterValues totals;
+        for (std::size_t i = 0; i < kLifetimeCounterCount; ++i) {
+            totals.values[i] = base_[i] + sinceBoot_[i];
+        }
+        published_.store(totals);
+        return totals;
+    }
+
+    std::array<uint64_t, kLifetimeCounterCount> base_{};       ///< earlier boots (+ add())
+    std::array<uint64_t, kLifetimeCounterCount> sinceBoot_{};  ///< last sample()
+    uint32_t sequence_ = 0;
+    Seqlock<LifetimeCounterValues> published_;
+};
+
+#endif /* WATERINGSYSTEM_INTERFACES_LIFETIMECOUNTERS_H */
@@ -0,0 +1,218 @@
+// SPDX-FileCopyrightText: 2026 Cryptotomte
+// SPDX-License-Identifier: AGPL-3.0-or-later
+/**
+ * @file LockStats.h
+ * @brief Contention statistics for the Locked* decorators' mutexes
+ *        (header-only, opt-in).
+ *
+ * Every Locked* decorator (LockedWaterPump, the Locked*Sensor family,
+ * LockedConfigStore, LockedDataStorage) holds a DecoratorMutex. Normally
+ * that is a plain StaticMutex. With WS_LOCK_STATS defined (from
+ * CONFIG_WS_LOCK_STATS, interfaces/CMakeLists.txt) it is an
+ * InstrumentedMutex, which counts acquisitions and the ones that had to
+ * wait, and times the waits and how long the lock was held. Boot wiring
+ * names each decorator's mutex in the LockRegistry; GET /api/v1/metrics
+ * (`lock_*`) and the `top` console command read it from there.
+ *
+ * COST: an uncontended lock() is a try_lock() plus two clock reads (one at
+ * acquisition, one at release) and a few relaxed stores — opt-in because
+ * the clock reads alone double the cost of the cheapest decorator calls.
+ *
+ * The counters are written only by the task holding the lock, so plain
+ * load/store pairs suffice; readers copy them without taking it (a copy may
+ * mix two acquisitions, never tear a word). Times are microseconds and the
+ * wait total wraps after ~71 min of accumulated waiting. Without an
+ * installed clock (host, or before boot wiring) only the counts move. No
+ * allocation; the only IDF reach is StaticMutex's, on target.
+ */
+
+#ifndef WATERINGSYSTEM_INTERFACES_LOCKSTATS_H
+#define WATERINGSYSTEM_INTERFACES_LOCKSTATS_H
+
+#include <array>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+
+#include "interfaces/StaticMutex.h"
+
+/// One mutex's counters since boot.
+struct LockStats {
+    uint32_t acquisitions = 0;  ///< every lock() and successful try_lock()
+    uint32_t contended = 0;     ///< lock() calls that found it held and waited
+    uint32_t waitUs = 0;        ///< summed over the contended acquisitions
+    uint32_t maxWaitUs = 0;
+    uint32_t maxHoldUs = 0;
+
+    /// Mean wait of a contended acquisition; 0 when none waited.
+    uint32_t meanWaitUs() const { return contended == 0 ? 0 : waitUs / contended; }
+};
+
+/**
+ * @brief A StaticMutex that records its own contention (Lockable, so
+ * std::lock_guard and std::unique_lock take it).
+ */
+class InstrumentedMutex {
+public:
+    using Clock = int64_t (*)();  ///< microseconds, monotonic
+
+    InstrumentedMutex() = default;
+    InstrumentedMutex(const InstrumentedMutex&) = delete;
+    InstrumentedMutex& operator=(const InstrumentedMutex&) = delete;
+
+    /// Set the clock every InstrumentedMutex times with. Boot wiring only,
+    /// before any task that takes a decorator's lock is started.
+    static void installClock(Clock clock) { clockSlot() = clock; }
+
+    void lock()
+    {
+        if (mutex_.try_lock()) {
+            acquired(now());
+            return;
+        }
+        const int64_t start = now();
+        mutex_.lock();
+        const int64_t at = now();
+        const uint32_t waited = elapsedUs(start, at);
+        bump(contended_, 1);
+        bump(waitUs_, waited);
+        raise(maxWaitUs_, waited);
+        acquired(at);
+    }
+
+    bool try_lock()
+    {
+        if (!mutex_.try_lock()) {
+            return false;
+        }
+        acquired(now());
+        return true;
+    }
+
+    void unlock()
+    {
+        raise(maxHoldUs_, elapsedUs(heldSinceUs_, now()));
+        mutex_.unlock();
+    }
+
+    /// A copy of the counters, taken without the lock.
+    LockStats stats() const
+    {
+        LockStats s;
+        s.acquisitions = acquisitions_.load(std::memory_order_relaxed);
+        s.contended = contended_.load(std::memory_order_relaxed);
+        s.waitUs = waitUs_.load(std::memory_order_relaxed);
+        s.maxWaitUs = maxWaitUs_.load(std::memory_order_relaxed);
+        s.maxHoldUs = maxHoldUs_.load(std::memory_order_relaxed);
+        return s;
+    }
+
+private:
+    static Clock& clockSlot()
+    {
+        static Clock clock = nullptr;
+        return clock;
+    }
+
+    static int64_t now()
+    {
+        const Clock clock = clockSlot();
+        return clock != nullptr ? clock() : 0;
+    }
+
+    static uint32_t elapsedUs(int64_t from, int64_t to)
+    {
+        const int64_t us = to - from;
+        if (us <= 0) {
+            return 0;
+        }
+        return us > int64_t{UINT32_MAX} ? UINT32_MAX : static_cast<uint32_t>(us);
+    }
+
+    // Only the holder writes, so a load/store pair is not a lost update.
+    static void bump(std::atomic<uint32_t>& counter, uint32_t by)
+    {
+        counter.store(counter.load(std::memory_order_relaxed) + by,
+                      std::memory_order_relaxed);
+    }
+
+    static void raise(std::atomic<uint32_t>& peak, uint32_t value)
+    {
+        if (value > peak.load(std::memory_order_relaxed)) {
+            peak.store(value, std::memory_order_relaxed);
+        }
+    }
+
+    /// Caller holds mutex_.
+    void acquired(int64_t atUs)
+    {
+        bump(acquisitions_, 1);
+        heldSinceUs_ = atUs;
+    }
+
+    StaticMutex mutex_;
+    int64_t heldSinceUs_ = 0;  ///< guarded by mutex_
+    std::atomic<uint32_t> acquisitions_{0};
+    std::atomic<uint32_t> contended_{0};
+    std::atomic<uint32_t> waitUs_{0};
+    std::atomic<uint32_t> maxWaitUs_{0};
+    std::atomic<uint32_t> maxHoldUs_{0};
+};
+
+#if defined(WS_LOCK_STATS)
+using DecoratorMutex = InstrumentedMutex;
+#else
+using DecoratorMutex = StaticMutex;
+#endif
+
+/// The named InstrumentedMutexes the readers report, in registration order.
+class LockRegistry {
+public:
+    static constexpr std::size_t kCapacity = 24;
+
+    LockRegistry() = default;
+    LockRegistry(const LockRegistry&) = delete;
+    LockRegistry& operator=(const LockRegistry&) = delete;
+
+    /**
+     * @brief Report @p mutex as @p name (a string that outlives the
+     * registry). Boot wiring only: one task registers, any task reads.
+     * @return false when the registry is full (the mutex is not reported)
+     */
+    bool add(const char* name, const InstrumentedMutex& mutex)
+    {
+        const std::size_t n = count_.load(std::memory_order_relaxed);
+        if (n >= kCapacity) {
+            return false;
+        }
+        entries_[n] = Entry{name, &mutex};
+        count_.store(n + 1, std::memory_order_release);
+        return true;
+    }
+
+    std::size_t size() const { return count_.load(std::memory_order_acquire); }
+
+    /// Name of entry @p i (< size()).
+    const char* name(std::size_t i) const { return entries_[i].name; }
+
+    /// Counters of entry @p i (< size()).
+    LockStats stats(std::size_t i) const { return entries_[i].mutex->stats(); }
+
+private:
+    struct Entry {
+        const char* name = nullptr;
+        const InstrumentedMutex* mutex = nullptr;
+    };
+
+    std::array<Entry, kCapacity> entries_{};
+    std::atomic<std::size_t> count_{0};
+};
+
+/// The firmware's one LockRegistry (a function-local static).
+inline LockRegistry& lockRegistry()
+{
+    static LockRegistry registry;
+    return registry;
+}
+
+#endif /* WATERINGSYSTEM_INTERFACES_LOCKSTATS_H */
@@ -0,0 +1,200 @@
+// SPDX-FileCopyrightText: 2026 Cryptotomte
+// SPDX-License-Identifier: AGPL-3.0-or-later
+/**
+ * @file LogRing.h
+ * @brief Fixed-size log lines: a lock-free many-writer ring that a drain
+ *        task empties, and the tail of recent lines it keeps for readers
+ *        (header-only).
+ *
+ * WHY THIS EXISTS: ESP_LOG writes each line to the UART on the calling
+ * task, and one INFO line at 115200 baud costs milliseconds of the sensor
+ * or watering task that logged it. The firmware's vprintf hook formats the
+ * line into a LogRing slot instead and returns; a low-priority task pops
+ * the lines, writes them to the UART and appends them to a LogTail for
+ * GET /api/v1/logs.
+ *
+ * MANY WRITERS, ONE READER: every task logs. A writer claims the next slot
+ * with a compare-and-swap on the head, fills it in place and publishes it
+ * by stamping the slot's sequence; the reader takes a slot only once it is
+ * stamped, and hands it back by stamping it one lap ahead (a bounded queue
+ * after D. Vyukov). A writer never waits: a failed CAS means another
+ * writer advanced the head, and a full ring drops the line and counts it.
+ * A writer preempted between claim and stamp only holds the reader back
+ * until it runs again; lines are popped in claim order.
+ *
+ * LINES: at most kLogLineBytes - 1 characters; a longer one is cut and
+ * keeps its trailing newline.
+ *
+ * The tail is written by the drain task only and read from httpd, under a
+ * StaticMutex neither hot task ever takes. No allocation, no IDF includes.
+ */
+
+#ifndef WATERINGSYSTEM_INTERFACES_LOGRING_H
+#define WATERINGSYSTEM_INTERFACES_LOGRING_H
+
+#include <array>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <mutex>
+#include <string>
+#include <vector>
+
+#include "interfaces/StaticMutex.h"
+
+/// Longest line kept, terminator included.
+constexpr std::size_t kLogLineBytes = 160;
+
+/// One formatted log line, NUL-terminated.
+struct LogLine {
+    uint16_t length = 0;  ///< characters, terminator excluded
+    char text[kLogLineBytes]{};
+};
+
+template <std::size_t Lines>
+class LogRing {
+    static_assert(Lines >= 2 && (Lines & (Lines - 1)) == 0,
+                  "line count must be a power of two");
+    static_assert(Lines <= (std::size_t{1} << 30), "free-running uint32_t sequences");
+
+public:
+    static constexpr std::size_t kLines = Lines;
+
+    LogRing()
+    {
+        for (std::size_t i = 0; i < Lines; ++i) {
+            cells_[i].seq.store(static_cast<uint32_t>(i), std::memory_order_relaxed);
+        }
+    }
+
+    LogRing(const LogRing&) = delete;
+    LogRing& operator=(const LogRing&) = delete;
+
+    /**
+     * @brief Writer: claim a slot and let @p fill format into it.
+     *
+     * @p fill(char* buf, std::size_t cap) writes at most cap - 1 characters
+     * plus a terminator and returns the length it WANTED (snprintf's
+     * result); a longer line is cut to fit, ending in '\n' if it did.
+     * @return false (nothing stored, one drop counted) when the ring is full
+     */
+    template <typename Fill>
+    bool emplace(Fill&& fill)
+    {
+        uint32_t pos = head_.load(std::memory_order_relaxed);
+        Cell* cell = nullptr;
+        while (true) {
+            cell = &cells_[pos & kMask];
+            const uint32_t seq = cell->seq.load(std::memory_order_acquire);
+            const auto lead = static_cast<int32_t>(seq - pos);
+            if (lead == 0) {
+                if (head_.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed)) {
+                    break;
+                }
+            } else if (lead < 0) {
+                dropped_.fetch_add(1, std::memory_order_relaxed);
+                return false;
+            } else {
+                pos = head_.load(std::memory_order_relaxed);
+            }
+        }
+        LogLine& line = cell->line;
+        const int wanted = fill(line.text, kLogLineBytes);
+        std::size_t length = wanted < 0 ? 0 : static_cast<std::size_t>(wanted);
+        if (length >= kLogLineBytes) {
+            length = kLogLineBytes - 1;
+            if (line.text[length - 1] != '\n') {
+                line.text[length - 1] = '\n';  // cut: keep the line break
+            }
+        }
+        line.text[length] = '\0';
+        line.length = static_cast<uint16_t>(length);
+        cell->seq.store(pos + 1, std::memory_order_release);
+        return true;
+    }
+
+    /// Writer: store @p length characters of @p text as one line.
+    bool push(const char* text, std::size_t length)
+    {
+        return emplace([text, length](char* buf, std::size_t cap) {
+            const std::size_t n = length < cap - 1 ? length : cap - 1;
+            std::memcpy(buf, text, n);
+            return static_cast<int>(length);
+        });
+    }
+
+    /// Reader: move the oldest published line to @p out; false when none is.
+    bool pop(LogLine& out)
+    {
+        Cell& cell = cells_[tail_ & kMask];
+        if (cell.seq.load(std::memory_order_acquire) != tail_ + 1) {
+            return false;
+        }
+        out.length = cell.line.length;
+        std::memcpy(out.text, cell.line.text, cell.line.length + 1u);
+        cell.seq.store(tail_ + static_cast<uint32_t>(Lines), std::memory_order_release);
+        ++tail_;
+        return true;
+    }
+
+    /// Lines refused because the ring was full, since boot.
+    uint32_t dropped() const { return dropped_.load(std::memory_order_relaxed); }
+
+private:
+    static constexpr uint32_t kMask = static_cast<uint32_t>(Lines - 1);
+
+    struct Cell {
+        std::atomic<uint32_t> seq{0};  ///< == claim: free; claim + 1: published
+        LogLine line;
+    };
+
+    std::array<Cell, Lines> cells_{};
+    std::atomic<uint32_t> head_{0};     ///< next claim (writers)
+    uint32_t tail_ = 0;                 ///< next pop (the reader only)
+    std::atomic<uint32_t> dropped_{0};
+};
+
+/// The newest kLines lines a LogRing's drain wrote out, for readers.
+class LogTail {
+public:
+    static constexpr std::size_t kLines = 32;
+
+    /// Drain task: keep @p line, dropping the oldest when full.
+    void append(const LogLine& line)
+    {
+        std::lock_guard<StaticMutex> lock(mutex_);
+        lines_[next_ % kLines] = line;
+        ++next_;
+    }
+
+    /// Drain task: the ring's drop count, for readers.
+    void setDropped(uint32_t dropped) { dropped_.store(dropped, std::memory_order_relaxed); }
+
+    uint32_t dropped() const { return dropped_.load(std::memory_order_relaxed); }
+
+    /// Copy the kept lines to @p out, oldest first, without their newline.
+    void copy(std::vector<std::string>& out) const
+    {
+        std::lock_guard<StaticMutex> lock(mutex_);
+        const uint32_t count = next_ < kLines ? next_ : static_cast<uint32_t>(kLines);
+        out.clear();
+        out.reserve(count);
+        for (uint32_t i = next_ - count; i != next_; ++i) {
+            const LogLine& line = lines_[i % kLines];
+            std::size_t length = line.length;
+            while (length > 0 && (line.text[length - 1] == '\n' || line.text[length - 1] == '\r')) {
+                --length;
+            }
+            out.emplace_back(line.text, length);
+        }
+    }
+
+private:
+    mutable StaticMutex mutex_;
+    std::array<LogLine, kLines> lines_{};
+    uint32_t next_ = 0;  ///< lines appended since boot
+    std::atomic<uint32_t> dropped_{0};
+};
+
+#endif /* WATERINGSYSTEM_INTERFACES_LOGRING_H */
@@ -0,0 +1,159 @@
+// SPDX-FileCopyrightText: 2026 Cryptotomte
+// SPDX-License-Identifier: AGPL-3.0-or-later
+/**
+ * @file MetricRegistry.h
+ * @brief Compact metric ids: the known-metric table plus a bounded registry.
+ *
+ * Producers that log the fixed telemetry set (WateringController) name a
+ * metric by a MetricId constant instead of a string, and the storage keys
+ * its per-metric state by the same id, so an append carries no name at
+ * all. Names stay the external identity — on-disk directory names, the
+ * API's `metric` parameter, the diag console — and are resolved only
+ * there. Ids of the known table are compile-time constants shared by
+ * every IDataStorage; ids past it are handed out by one MetricRegistry
+ * and only mean something to its owner.
+ *
+ * Part of the header-only `interfaces` component: no IDF includes allowed.
+ */
+
+#ifndef WATERINGSYSTEM_INTERFACES_METRICREGISTRY_H
+#define WATERINGSYSTEM_INTERFACES_METRICREGISTRY_H
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <vector>
+
+using MetricId = uint8_t;
+
+namespace metric {
+
+// The telemetry set logged by WateringController: 3 env + 4 soil-base +
+// 3 NPK from the primary soil probe, then the moisture of each further
+// probe on the RS485 segment (soil_moisture_2 ..). Order is the id; append
+// only.
+constexpr MetricId kEnvTemperature = 0;
+constexpr MetricId kEnvHumidity = 1;
+constexpr MetricId kEnvPressure = 2;
+constexpr MetricId kSoilMoisture = 3;
+constexpr MetricId kSoilTemperature = 4;
+constexpr MetricId kSoilPh = 5;
+constexpr MetricId kSoilEc = 6;
+constexpr MetricId kSoilNitrogen = 7;
+constexpr MetricId kSoilPhosphorus = 8;
+constexpr MetricId kSoilPotassium = 9;
+constexpr MetricId kSoilMoisture2 = 10;  ///< first of kSoilProbes - 1 probe ids
+
+/// Soil probes with a moisture history: the primary plus six more. The
+/// history row masks are 16 bits, which is what bounds the known table.
+constexpr std::size_t kSoilProbes = 7;
+
+constexpr std::size_t kKnownCount = 16;
+constexpr MetricId kInvalid = 0xFF;
+
+constexpr const char* kKnownNames[kKnownCount] = {
+    "env_temperature", "env_humidity",    "env_pressure",  "soil_moisture",
+    "soil_temperature", "soil_ph",        "soil_ec",       "soil_nitrogen",
+    "soil_phosphorus",  "soil_potassium",  "soil_moisture_2", "soil_moisture_3",
+    "soil_moisture_4",  "soil_moisture_5", "soil_moisture_6", "soil_moisture_7",
+};
+
+/// Moisture id of soil probe @p probe (0 = the primary); kInvalid past
+/// kSoilProbes.
+constexpr MetricId soilMoisture(std::size_t probe)
+{
+    if (probe == 0) {
+        return kSoilMoisture;
+    }
+    return probe < kSoilProbes ? static_cast<MetricId>(kSoilMoisture2 + probe - 1)
+                               : kInvalid;
+}
+
+/// Name of a known id; nullptr for any other id.
+constexpr const char* knownName(MetricId id)
+{
+    return id < kKnownCount ? kKnownNames[id] : nullptr;
+}
+
+/// Id of a known name; kInvalid for any other name.
+constexpr MetricId findKnown(std::string_view name)
+{
+    for (std::size_t i = 0; i < kKnownCount; ++i) {
+        if (name == kKnownNames[i]) {
+            return static_cast<MetricId>(i);
+        }
+    }
+    return kInvalid;
+}
+
+}  // namespace metric
+
+/// One reading addressed by id (see IDataStorage::storeSamples()).
+struct MetricSample {
+    MetricId metric = metric::kInvalid;
+    uint32_t epoch = 0;  ///< epoch seconds, caller-supplied
+    float value = 0.0f;
+};
+
+/**
+ * @brief The known table followed by up to kDynamicCapacity interned names.
+ *
+ * Interning allocates the name once; lookups and name() never allocate.
+ * Not synchronized — owned by one (externally locked) storage instance.
+ */
+class MetricRegistry {
+public:
+    /// Room for names outside the known table (diag console, tests, the
+    /// zones and power channels of a larger install). As large as the
+    /// largest storage metric budget (the multiplexed layout's 64), so the
+    /// budget — not the registry — is what rejects an extra metric in
+    /// practice, whatever its names.
+    static constexpr std::size_t kDynamicCapacity = 64;
+    static constexpr std::size_t kCapacity = metric::kKnownCount + kDynamicCapacity;
+
+    MetricRegistry() : names_(metric::kKnownNames, metric::kKnownNames + metric::kKnownCount)
+    {
+        names_.reserve(kCapacity);
+    }
+
+    /// Id of `name`, or metric::kInvalid when it was never interned.
+    MetricId find(std::string_view name) const
+    {
+        const MetricId known = metric::findKnown(name);
+        if (known != metric::kInvalid) {
+            return known;
+        }
+        for (std::size_t i = metric::kKnownCount; i < names_.size(); ++i) {
+            if (names_[i] == name) {
+                return static_cast<MetricId>(i);
+            }
+        }
+        return metric::kInvalid;
+    }
+
+    /// Id of `name`, registering it first if needed; metric::kInvalid once
+    /// the dynamic section is full.
+    MetricId intern(std::string_view name)
+    {
+        const MetricId id = find(name);
+        if (id != metric::kInvalid || names_.size() >= kCapacity) {
+            return id;
+        }
+        names_.emplace_back(name);
+        return static_cast<MetricId>(names_.size() - 1);
+    }
+
+    bool contains(MetricId id) const { return id < names_.size(); }
+
+    /// Name of a registered id (contains(id) must hold).
+    const std::string& name(MetricId id) const { return names_[id]; }
+
+    /// Registered ids are [0, size()).
+    std::size_t size() const { return names_.size(); }
+
+private:
+    std::vector<std::string> names_;
+};
+
+#endif /* WATERINGSYSTEM_INTERFACES_METRICREGISTRY_H */
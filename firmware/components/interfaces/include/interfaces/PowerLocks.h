@@ -0,0 +1,184 @@
+// SPDX-FileCopyrightText: 2026 Cryptotomte
+// SPDX-License-Identifier: AGPL-3.0-or-later
+/**
+ * @file PowerLocks.h
+ * @brief Power-management locks the firmware holds around its busy
+ *        stretches, and the residency they add up to (header-only).
+ *
+ * WHY THIS EXISTS: the CPU is idle almost all the time between 5 s sensor
+ * polls and 100 ms loop ticks. With ESP-IDF power management
+ * (CONFIG_WS_POWER_MANAGEMENT, main/power_mode.cpp) it runs at the minimum
+ * frequency and light-sleeps in tickless idle, except while a lock is held:
+ *
+ *   CpuMax        full CPU clock              HTTP request handling
+ *   ApbMax        full bus clock, no sleep    RS485 and I2C transfers
+ *   NoLightSleep  minimum clock, awake        a pump running
+ *
+ * Components see only IPowerLock; a null lock (host, or power management
+ * off) makes PowerLockGuard a no-op.
+ *
+ * RESIDENCY: PowerResidency is told when each kind goes from free to held
+ * and back, and sums the time spent in each state the held kinds demand
+ * (the highest wins). It counts what THE FIRMWARE asked for: the Wi-Fi
+ * driver keeps its own locks, so Idle is time light sleep was allowed,
+ * not time it happened. The rev2 INA226's supply current is the direct
+ * check. A StaticMutex guards it (a few stores per transition); no
+ * allocation, no IDF includes.
+ */
+
+#ifndef WATERINGSYSTEM_INTERFACES_POWERLOCKS_H
+#define WATERINGSYSTEM_INTERFACES_POWERLOCKS_H
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <mutex>
+
+#include "interfaces/StaticMutex.h"
+
+enum class PowerLockKind : uint8_t { CpuMax, ApbMax, NoLightSleep };
+constexpr std::size_t kPowerLockKinds = 3;
+
+/// Power states, highest demand first; Idle: light sleep allowed.
+enum class PowerState : uint8_t { CpuMax, ApbMax, Awake, Idle };
+constexpr std::size_t kPowerStates = 4;
+
+inline const char* powerLockKindName(PowerLockKind kind)
+{
+    switch (kind) {
+        case PowerLockKind::CpuMax:       return "cpu_max";
+        case PowerLockKind::ApbMax:       return "apb_max";
+        case PowerLockKind::NoLightSleep: return "no_light_sleep";
+    }
+    return "unknown";
+}
+
+inline const char* powerStateName(PowerState state)
+{
+    switch (state) {
+        case PowerState::CpuMax: return "cpu_max";
+        case PowerState::ApbMax: return "apb_max";
+        case PowerState::Awake:  return "awake";
+        case PowerState::Idle:   return "idle";
+    }
+    return "unknown";
+}
+
+/// A counted power-management lock (esp_pm_lock_* on target). Nested
+/// acquires are fine; each needs its release.
+class IPowerLock {
+public:
+    virtual ~IPowerLock() = default;
+    virtual void acquire() = 0;
+    virtual void release() = 0;
+};
+
+/// Holds @p lock for its scope; nothing at all for a null lock.
+class PowerLockGuard {
+public:
+    explicit PowerLockGuard(IPowerLock* lock) : lock_(lock)
+    {
+        if (lock_ != nullptr) {
+            lock_->acquire();
+        }
+    }
+    ~PowerLockGuard()
+    {
+        if (lock_ != nullptr) {
+            lock_->release();
+        }
+    }
+    PowerLockGuard(const PowerLockGuard&) = delete;
+    PowerLockGuard& operator=(const PowerLockGuard&) = delete;
+
+private:
+    IPowerLock* lock_;
+};
+
+/// Time in each state and acquisitions of each kind since start().
+struct PowerResidencyStats {
+    std::array<uint64_t, kPowerStates> us{};
+    std::array<uint32_t, kPowerLockKinds> acquisitions{};
+};
+
+class PowerResidency {
+public:
+    /// Begin accounting at @p nowUs (monotonic microseconds), all locks free.
+    void start(int64_t nowUs)
+    {
+        std::lock_guard<StaticMutex> lock(mutex_);
+        since_ = nowUs;
+        started_ = true;
+    }
+
+    /// @p kind was acquired (once per acquire, nested or not).
+    void acquired(PowerLockKind kind, int64_t nowUs)
+    {
+        std::lock_guard<StaticMutex> lock(mutex_);
+        settle(nowUs);
+        const auto k = static_cast<std::size_t>(kind);
+        ++holders_[k];
+        ++stats_.acquisitions[k];
+    }
+
+    /// @p kind was released; an unmatched release is ignored.
+    void released(PowerLockKind kind, int64_t nowUs)
+    {
+        std::lock_guard<StaticMutex> lock(mutex_);
+        settle(nowUs);
+        const auto k = static_cast<std::size_t>(kind);
+        if (holders_[k] > 0) {
+            --holders_[k];
+        }
+    }
+
+    /// The state the held locks demand now.
+    PowerState state() const
+    {
+        std::lock_guard<StaticMutex> lock(mutex_);
+        return current();
+    }
+
+    /// Totals up to @p nowUs; all zero before start().
+    PowerResidencyStats snapshot(int64_t nowUs) const
+    {
+        std::lock_guard<StaticMutex> lock(mutex_);
+        PowerResidencyStats out = stats_;
+        if (started_ && nowUs > since_) {
+            out.us[static_cast<std::size_t>(current())] += static_cast<uint64_t>(nowUs - since_);
+        }
+        return out;
+    }
+
+private:
+    PowerState current() const
+    {
+        if (holders_[static_cast<std::size_t>(PowerLockKind::CpuMax)] > 0) {
+            return PowerState::CpuMax;
+        }
+        if (holders_[static_cast<std::size_t>(PowerLockKind::ApbMax)] > 0) {
+            return PowerState::ApbMax;
+        }
+        if (holders_[static_cast<std::size_t>(PowerLockKind::NoLightSleep)] > 0) {
+            return PowerState::Awake;
+        }
+        return PowerState::Idle;
+    }
+
+    /// Charge the time since the last transition to the state it was in.
+    void settle(int64_t nowUs)
+    {
+        if (started_ && nowUs > since_) {
+            stats_.us[static_cast<std::size_t>(current())] += static_cast<uint64_t>(nowUs - since_);
+        }
+        since_ = nowUs;
+    }
+
+    mutable StaticMutex mutex_;
+    std::array<uint32_t, kPowerLockKinds> holders_{};
+    PowerResidencyStats stats_;
+    int64_t since_ = 0;
+    bool started_ = false;
+};
+
+#endif /* WATERINGSYSTEM_INTERFACES_POWERLOCKS_H */
@@ -0,0 +1,299 @@
+// SPDX-FileCopyrightText: 2026 Cryptotomte
+// SPDX-License-Identifier: AGPL-3.0-or-later
+/**
+ * @file QuantileSketch.h
+ * @brief Fixed-size mergeable quantile sketch (a small merging t-digest,
+ *        header-only).
+ *
+ * Readings are summarized as at most kCentroids (mean, weight) centroids
+ * plus the exact min and max. A new value lands in a small buffer; a full
+ * buffer is sorted into the centroids and the result squeezed back to
+ * kCentroids on the arcsine (k1) scale, which keeps the centroids near
+ * the ends of the distribution small — so p5/p95 stay much closer to the
+ * truth than the median's neighbourhood needs to. An add is amortized
+ * constant time, the size never grows with the count, and two sketches
+ * merge into one of the same size: per-bucket sketches of a rollup tier
+ * combine into the sketch of a whole window.
+ *
+ * Estimates are interpolated between centroid centres (min and max pin
+ * the ends). Non-finite values are not added (they have no rank), so a
+ * sketch may count fewer readings than the window does. Header-only and
+ * free of IDF includes, so the IDataStorage default can fold with it.
+ */
+
+#ifndef WATERINGSYSTEM_INTERFACES_QUANTILESKETCH_H
+#define WATERINGSYSTEM_INTERFACES_QUANTILESKETCH_H
+
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+
+class QuantileSketch {
+public:
+    /// Centroids kept (and persisted) per sketch.
+    static constexpr std::size_t kCentroids = 16;
+
+    /// Encoded size: LE float min/max, uint8 centroid count, three zero
+    /// bytes, then kCentroids slots of LE float mean + LE uint32 weight
+    /// (unused slots zero).
+    static constexpr std::size_t kEncodedBytes = 12 + 8 * kCentroids;
+
+    /// Fold one value in (amortized O(1); non-finite values are skipped).
+    void add(float value)
+    {
+        if (!std::isfinite(value)) {
+            return;
+        }
+        if (count_ == 0) {
+            min_ = max_ = value;
+        }
+        min_ = std::min(min_, value);
+        max_ = std::max(max_, value);
+        ++count_;
+        buffer_[buffered_++] = value;
+        if (buffered_ == kBuffer) {
+            compress();
+        }
+    }
+
+    /// Fold another sketch in; the result is what one sketch fed both
+    /// value streams would roughly hold.
+    void merge(const QuantileSketch& other)
+    {
+        if (other.count_ == 0) {
+            return;
+        }
+        if (count_ == 0) {
+            *this = other;
+            return;
+        }
+        compress();
+        QuantileSketch flat = other;
+        flat.compress();
+        Work work;
+        std::size_t n = 0;
+        for (std::size_t i = 0; i < centroidCount_; ++i) {
+            work[n++] = centroids_[i];
+        }
+        for (std::size_t i = 0; i < flat.centroidCount_; ++i) {
+            work[n++] = flat.centroids_[i];
+        }
+        centroidCount_ = squeeze(work.data(), n, centroids_.data());
+        count_ += other.count_;
+        min_ = std::min(min_, other.min_);
+        max_ = std::max(max_, other.max_);
+    }
+
+    /// Values folded in.
+    uint32_t count() const { return count_; }
+
+    float min() const { return min_; }
+    float max() const { return max_; }
+
+    /// Estimated value at rank @p q in [0, 1] (clamped); 0 when empty.
+    float quantile(double q) const
+    {
+        if (count_ == 0) {
+            return 0.0f;
+        }
+        QuantileSketch flat = *this;
+        flat.compress();
+        const double target = std::min(1.0, std::max(0.0, q)) * count_;
+        // Centroid i stands at rank (weight before it) + weight / 2.
+        double prevRank = 0.0;
+        double prevValue = min_;
+        double before = 0.0;
+        for (std::size_t i = 0; i < flat.centroidCount_; ++i) {
+            const Centroid& c = flat.centroids_[i];
+            const double rank = before + c.weight / 2.0;
+            if (target <= rank) {
+                return interpolate(prevRank, prevValue, rank, c.mean, target);
+            }
+            prevRank = rank;
+            prevValue = c.mean;
+            before += c.weight;
+        }
+        return interpolate(prevRank, prevValue, count_, max_, target);
+    }
+
+    void encode(uint8_t out[kEncodedBytes]) const
+    {
+        QuantileSketch flat = *this;
+        flat.compress();
+        std::memset(out, 0, kEncodedBytes);
+        putFloat(out, flat.min_);
+        putFloat(out + 4, flat.max_);
+        out[8] = static_cast<uint8_t>(flat.centroidCount_);
+        for (std::size_t i = 0; i < flat.centroidCount_; ++i) {
+            putFloat(out + 12 + 8 * i, flat.centroids_[i].mean);
+            putU32(out + 16 + 8 * i, flat.centroids_[i].weight);
+        }
+    }
+
+    /// False (sketch left empty) on a centroid count over kCentroids or a
+    /// used slot of weight 0.
+    bool decode(const uint8_t in[kEncodedBytes])
+    {
+        *this = QuantileSketch{};
+        const std::size_t n = in[8];
+        if (n > kCentroids) {
+            return false;
+        }
+        uint32_t count = 0;
+        for (std::size_t i = 0; i < n; ++i) {
+            const Centroid c{getFloat(in + 12 + 8 * i), getU32(in + 16 + 8 * i)};
+            if (c.weight == 0) {
+                return false;
+            }
+            centroids_[i] = c;
+            count += c.weight;
+        }
+        centroidCount_ = n;
+        count_ = count;
+        min_ = getFloat(in);
+        max_ = getFloat(in + 4);
+        return true;
+    }
+
+private:
+    static constexpr std::size_t kBuffer = 32;
+
+    struct Centroid {
+        float mean = 0.0f;
+        uint32_t weight = 0;
+    };
+
+    /// Room for the centroids plus a full buffer, or for two sketches'
+    /// centroids (merge).
+    using Work = std::array<Centroid, kCentroids + kBuffer>;
+    static_assert(kBuffer >= kCentroids, "merge() squeezes two sketches in Work");
+
+    /// Sort the buffer into the centroids.
+    void compress()
+    {
+        if (buffered_ == 0) {
+            return;
+        }
+        Work work;
+        std::size_t n = 0;
+        for (std::size_t i = 0; i < centroidCount_; ++i) {
+            work[n++] = centroids_[i];
+        }
+        for (std::size_t i = 0; i < buffered_; ++i) {
+            work[n++] = Centroid{buffer_[i], 1};
+        }
+        buffered_ = 0;
+        centroidCount_ = squeeze(work.data(), n, centroids_.data());
+    }
+
+    /// k1 scale: a centroid may span one unit of it, so there are at most
+    /// about kCentroids of them and the ones near q = 0 and q = 1 hold few
+    /// values.
+    static double scale(double q)
+    {
+        constexpr double kPi = 3.14159265358979323846;
+        return kCentroids / (2.0 * kPi) * std::asin(2.0 * std::min(1.0, q) - 1.0);
+    }
+
+    static void absorb(Centroid& into, const Centroid& c)
+    {
+        const uint32_t weight = into.weight + c.weight;
+        into.mean = static_cast<float>(into.mean + (static_cast<double>(c.mean) - into.mean) *
+                                                       c.weight / weight);
+        into.weight = weight;
+    }
+
+    /// Sort @p n centroids by mean and merge neighbours into at most
+    /// kCentroids in @p out; returns how many.
+    static std::size_t squeeze(Centroid* work, std::size_t n, Centroid* out)
+    {
+        std::sort(work, work + n,
+                  [](const Centroid& a, const Centroid& b) { return a.mean < b.mean; });
+        double total = 0.0;
+        for (std::size_t i = 0; i < n; ++i) {
+            total += work[i].weight;
+        }
+        // Greedy pass: extend the current centroid while it spans at most
+        // one unit of the scale.
+        std::size_t kept = 0;
+        double before = 0.0;
+        Centroid current = work[0];
+        for (std::size_t i = 1; i < n; ++i) {
+            const double right = before + current.weight + work[i].weight;
+            if (scale(right / total) - scale(before / total) <= 1.0) {
+                absorb(current, work[i]);
+            } else {
+                before += current.weight;
+                work[kept++] = current;
+                current = work[i];
+            }
+        }
+        work[kept++] = current;
+        // The greedy pass can leave one or two too many: merge the
+        // lightest neighbouring pair until it fits.
+        while (kept > kCentroids) {
+            std::size_t lightest = 0;
+            for (std::size_t i = 1; i + 1 < kept; ++i) {
+                if (work[i].weight + work[i + 1].weight <
+                    work[lightest].weight + work[lightest + 1].weight) {
+                    lightest = i;
+                }
+            }
+            absorb(work[lightest], work[lightest + 1]);
+            std::copy(work + lightest + 2, work + kept, work + lightest + 1);
+            --kept;
+        }
+        std::copy(work, work + kept, out);
+        return kept;
+    }
+
+    static float interpolate(double r0, double v0, double r1, double v1, double at)
+    {
+        if (r1 <= r0) {
+            return static_cast<float>(v1);
+        }
+        return static_cast<float>(v0 + (v1 - v0) * (at - r0) / (r1 - r0));
+    }
+
+    static void putU32(uint8_t* p, uint32_t v)
+    {
+        p[0] = static_cast<uint8_t>(v);
+        p[1] = static_cast<uint8_t>(v >> 8);
+        p[2] = static_cast<uint8_t>(v >> 16);
+        p[3] = static_cast<uint8_t>(v >> 24);
+    }
+
+    static uint32_t getU32(const uint8_t* p)
+    {
+        return static_cast<uint32_t>(p[0]) | (static_cast<uint32_t>(p[1]) << 8) |
+               (static_cast<uint32_t>(p[2]) << 16) | (static_cast<uint32_t>(p[3]) << 24);
+    }
+
+    static void putFloat(uint8_t* p, float v)
+    {
+        uint32_t bits = 0;
+        std::memcpy(&bits, &v, sizeof(bits));
+        putU32(p, bits);
+    }
+
+    static float getFloat(const uint8_t* p)
+    {
+        const uint32_t bits = getU32(p);
+        float v = 0.0f;
+        std::memcpy(&v, &bits, sizeof(v));
+        return v;
+    }
+
+    std::array<Centroid, kCentroids> centroids_{};
+    std::size_t centroidCount_ = 0;
+    std::array<float, kBuffer> buffer_{};
+    std::size_t buffered_ = 0;
+    uint32_t count_ = 0;
+    float min_ = 0.0f;
+    float max_ = 0.0f;
+};
+
+#endif /* WATERINGSYSTEM_INTERFACES_QUANTILESKETCH_H */
@@ -0,0 +1,94 @@
+// SPDX-FileCopyrightText: 2026 Cryptotomte
+// SPDX-License-Identifier: AGPL-3.0-or-later
+/**
+ * @file Seqlock.h
+ * @brief Single-writer sequence lock over a small trivially-copyable value
+ *        (header-only).
+ *
+ * The writer bumps the sequence to odd, stores the value, and bumps it to
+ * even again; a reader copies the value between two sequence loads and
+ * keeps the copy only if both saw the same even number. Readers never
+ * block the writer and never take a lock. The value is held as relaxed
+ * std::atomic words, so a torn copy is a discarded copy, not a data race.
+ *
+ * SINGLE WRITER: store() must be serialized by the caller (LockedConfigStore
+ * holds its mutex).
+ *
+ * BOUNDED RETRIES: on a single core a reader that preempted the writer
+ * mid-store would spin until the writer runs again, so tryLoad() gives up
+ * after a number of attempts and the caller falls back to the writer's
+ * lock — which, being a FreeRTOS mutex, lends the writer the reader's
+ * priority until the store completes. SnapshotPublisher.h holds the value
+ * twice and needs no such fallback, at twice the memory.
+ *
+ * Header-only and free of IDF includes, so it lives with the interfaces
+ * every publisher already depends on.
+ */
+
+#ifndef WATERINGSYSTEM_INTERFACES_SEQLOCK_H
+#define WATERINGSYSTEM_INTERFACES_SEQLOCK_H
+
+#include <array>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <type_traits>
+
+template <typename T>
+class Seqlock {
+    static_assert(std::is_trivially_copyable<T>::value,
+                  "Seqlock copies the value word by word");
+
+public:
+    explicit Seqlock(const T& initial = T{}) { store(initial); }
+
+    Seqlock(const Seqlock&) = delete;
+    Seqlock& operator=(const Seqlock&) = delete;
+
+    /// Publish @p value. Callers serialize store() among themselves.
+    void store(const T& value)
+    {
+        std::array<uint32_t, kWords> words{};
+        std::memcpy(words.data(), &value, sizeof(T));
+        const uint32_t seq = seq_.load(std::memory_order_relaxed);
+        seq_.store(seq + 1, std::memory_order_relaxed);
+        std::atomic_thread_fence(std::memory_order_release);
+        for (std::size_t i = 0; i < kWords; ++i) {
+            words_[i].store(words[i], std::memory_order_relaxed);
+        }
+        seq_.store(seq + 2, std::memory_order_release);
+    }
+
+    /**
+     * @brief Copy a consistent value into @p out.
+     * @return false after @p attempts copies raced a store (@p out untouched)
+     */
+    bool tryLoad(T& out, int attempts = 8) const
+    {
+        std::array<uint32_t, kWords> words{};
+        for (int attempt = 0; attempt < attempts; ++attempt) {
+            const uint32_t before = seq_.load(std::memory_order_acquire);
+            if ((before & 1u) != 0) {
+                continue;  // store in progress
+            }
+            for (std::size_t i = 0; i < kWords; ++i) {
+                words[i] = words_[i].load(std::memory_order_relaxed);
+            }
+            std::atomic_thread_fence(std::memory_order_acquire);
+            if (seq_.load(std::memory_order_relaxed) == before) {
+                std::memcpy(static_cast<void*>(&out), words.data(), sizeof(T));
+                return true;
+            }
+        }
+        return false;
+    }
+
+private:
+    static constexpr std::size_t kWords = (sizeof(T) + 3) / 4;
+
+    std::atomic<uint32_t> seq_{0};
+    std::array<std::atomic<uint32_t>, kWords> words_{};
+};
+
+#endif /* WATERINGSYSTEM_INTERFACES_SEQLOCK_H */
@@ -0,0 +1,157 @@
+// SPDX-FileCopyrightText: 2026 Cryptotomte
+// SPDX-License-Identifier: AGPL-3.0-or-later
+/**
+ * @file SnapshotPublisher.h
+ * @brief One writer's state, published for any task to copy without a lock
+ *        (header-only).
+ *
+ * The writer (a task's tick(), a decorator under its own mutex) publishes
+ * a small trivially-copyable value; readers on other tasks load() a
+ * consistent copy of the newest one. Unlike a bare Seqlock, load() needs
+ * no fallback lock: the value is held twice, and a publish writes the copy
+ * readers are NOT directed to, then turns them over to it. A reader copies
+ * the current copy and keeps it unless, meanwhile, the writer finished
+ * that publish and started the next one into the very copy being read —
+ * which cannot happen while the reader has preempted the writer, so on
+ * one core load() never retries, and on two it retries only while the
+ * writer publishes faster than a copy takes. Readers never block the
+ * writer. Both copies are relaxed std::atomic words, so a torn copy is a
+ * discarded copy, not a data race.
+ *
+ * VERSION: version() counts the publishes that changed the value, so a
+ * poller can tell "nothing new" from one word. Changed means bytewise:
+ * a T with padding should be built from a value-initialized copy
+ * (`T v{}; v.x = ...`), or uninitialized padding may count as a change.
+ *
+ * CHANGE HOOK: an optional ISnapshotListener hears every changed value, on
+ * the writer's task, after readers can see it — the tiny-interface
+ * convention of IWifiStateObserver and IPumpObserver, not std::function.
+ *
+ * SINGLE WRITER: publish() must be serialized by the caller. No
+ * allocation; free of IDF includes, so it lives with the interfaces.
+ */
+
+#ifndef WATERINGSYSTEM_INTERFACES_SNAPSHOTPUBLISHER_H
+#define WATERINGSYSTEM_INTERFACES_SNAPSHOTPUBLISHER_H
+
+#include <array>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <type_traits>
+
+/**
+ * @brief Hears a SnapshotPublisher's changes.
+ */
+template <typename T>
+class ISnapshotListener {
+public:
+    virtual ~ISnapshotListener() = default;
+
+    /**
+     * @brief The published value is now @p value, at @p version.
+     *
+     * Runs on the writer's task, inside publish(): an implementation must
+     * be short, must not block and must not publish to the same publisher.
+     */
+    virtual void onSnapshotChanged(const T& value, uint32_t version) = 0;
+};
+
+template <typename T>
+class SnapshotPublisher {
+    static_assert(std::is_trivially_copyable<T>::value,
+                  "SnapshotPublisher copies the value word by word");
+
+public:
+    explicit SnapshotPublisher(const T& initial = T{})
+    {
+        std::memcpy(static_cast<void*>(&last_), &initial, sizeof(T));
+        std::array<uint32_t, kWords> words{};
+        std::memcpy(words.data(), &initial, sizeof(T));
+        for (std::size_t i = 0; i < kWords; ++i) {
+            copies_[0][i].store(words[i], std::memory_order_relaxed);
+        }
+    }
+
+    SnapshotPublisher(const SnapshotPublisher&) = delete;
+    SnapshotPublisher& operator=(const SnapshotPublisher&) = delete;
+
+    /**
+     * @brief Publish @p value; callers serialize publish() among themselves.
+     * @return false when it equals the published value (nothing stored,
+     *         version unchanged, listener not called)
+     */
+    bool publish(const T& value)
+    {
+        if (std::memcmp(&last_, &value, sizeof(T)) == 0) {
+            return false;
+        }
+        std::memcpy(static_cast<void*>(&last_), &value, sizeof(T));
+        std::array<uint32_t, kWords> words{};
+        std::memcpy(words.data(), &value, sizeof(T));
+
+        // Odd: the copy after the current one is being written. Readers
+        // stay on the current one.
+        const uint32_t seq = seq_.load(std::memory_order_relaxed);
+        seq_.store(seq + 1, std::memory_order_release);
+        std::atomic_thread_fence(std::memory_order_release);
+        auto& next = copies_[((seq >> 1) + 1) & 1u];
+        for (std::size_t i = 0; i < kWords; ++i) {
+            next[i].store(words[i], std::memory_order_relaxed);
+        }
+        seq_.store(seq + 2, std::memory_order_release);
+
+        ISnapshotListener<T>* listener = listener_.load(std::memory_order_acquire);
+        if (listener != nullptr) {
+            listener->onSnapshotChanged(value, (seq >> 1) + 1);
+        }
+        return true;
+    }
+
+    /// A consistent copy of the newest published value. Any task.
+    T load() const
+    {
+        std::array<uint32_t, kWords> words{};
+        for (;;) {
+            const uint32_t before = seq_.load(std::memory_order_acquire);
+            const auto& current = copies_[(before >> 1) & 1u];
+            for (std::size_t i = 0; i < kWords; ++i) {
+                words[i] = current[i].load(std::memory_order_relaxed);
+            }
+            std::atomic_thread_fence(std::memory_order_acquire);
+            // The copy read is rewritten from sequence (before | 1) + 2 on.
+            const uint32_t after = seq_.load(std::memory_order_relaxed);
+            if (after - before < ((before & 1u) != 0 ? 2u : 3u)) {
+                break;
+            }
+        }
+        T value;
+        std::memcpy(static_cast<void*>(&value), words.data(), sizeof(T));
+        return value;
+    }
+
+    /// Changes published so far (0 = still the initial value). Any task.
+    uint32_t version() const { return seq_.load(std::memory_order_acquire) >> 1; }
+
+    /**
+     * @brief Tell @p listener of every change (nullptr = none). An atomic
+     * pointer, so it may be installed while the writer runs; @p listener
+     * must outlive the publisher or be removed first.
+     */
+    void setListener(ISnapshotListener<T>* listener)
+    {
+        listener_.store(listener, std::memory_order_release);
+    }
+
+private:
+    static constexpr std::size_t kWords = (sizeof(T) + 3) / 4;
+
+    /// Twice the version, plus 1 while a publish writes the other copy.
+    std::atomic<uint32_t> seq_{0};
+    std::array<std::array<std::atomic<uint32_t>, kWords>, 2> copies_{};
+    std::atomic<ISnapshotListener<T>*> listener_{nullptr};
+    T last_;  ///< the writer's own copy, for the change test
+};
+
+#endif /* WATERINGSYSTEM_INTERFACES_SNAPSHOTPUBLISHER_H */
@@ -0,0 +1,94 @@
+// SPDX-FileCopyrightText: 2026 Cryptotomte
+// SPDX-License-Identifier: AGPL-3.0-or-later
+/**
+ * @file SpscRing.h
+ * @brief Fixed-capacity single-producer / single-consumer ring
+ *        (header-only, lock-free).
+ *
+ * The producer owns head_, the consumer owns tail_; each publishes its
+ * index with a release store and reads the other's with an acquire load,
+ * so an element is fully written before the consumer can see it and fully
+ * read before the producer may reuse its slot. Neither side ever waits.
+ * Indices run free (uint32_t wrap is harmless with a power-of-two
+ * capacity) and are masked on access.
+ *
+ * FULL = DROP NEWEST: push() into a full ring fails and the producer
+ * counts the loss; the consumer's data is never overwritten under it.
+ *
+ * ONE OF EACH: exactly one task may push() and exactly one may pop();
+ * two consumers (or two producers) need a lock of their own.
+ *
+ * Header-only and free of IDF includes, like Seqlock.h.
+ */
+
+#ifndef WATERINGSYSTEM_INTERFACES_SPSCRING_H
+#define WATERINGSYSTEM_INTERFACES_SPSCRING_H
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <type_traits>
+
+template <typename T, std::size_t Capacity>
+class SpscRing {
+    static_assert(Capacity >= 2 && (Capacity & (Capacity - 1)) == 0,
+                  "capacity must be a power of two");
+    static_assert(Capacity <= (std::size_t{1} << 31),
+                  "free-running uint32_t indices");
+    static_assert(std::is_trivially_copyable<T>::value,
+                  "elements are copied in and out of the slots");
+
+public:
+    static constexpr std::size_t kCapacity = Capacity;
+
+    SpscRing() = default;
+    SpscRing(const SpscRing&) = delete;
+    SpscRing& operator=(const SpscRing&) = delete;
+
+    /// Producer: append @p value; false (nothing stored) when full.
+    bool push(const T& value)
+    {
+        const uint32_t head = head_.load(std::memory_order_relaxed);
+        const uint32_t tail = tail_.load(std::memory_order_acquire);
+        if (head - tail == Capacity) {
+            return false;
+        }
+        slots_[head & kMask] = value;
+        head_.store(head + 1, std::memory_order_release);
+        return true;
+    }
+
+    /// Consumer: move up to @p max of the oldest elements to @p out.
+    /// @return the number moved (0 = empty)
+    std::size_t pop(T* out, std::size_t max)
+    {
+        const uint32_t tail = tail_.load(std::memory_order_relaxed);
+        const uint32_t head = head_.load(std::memory_order_acquire);
+        std::size_t n = head - tail;
+        if (n > max) {
+            n = max;
+        }
+        for (std::size_t i = 0; i < n; ++i) {
+            out[i] = slots_[(tail + i) & kMask];
+        }
+        tail_.store(tail + static_cast<uint32_t>(n), std::memory_order_release);
+        return n;
+    }
+
+    /// Elements waiting; exact on either side, a snapshot anywhere else.
+    std::size_t size() const
+    {
+        // Tail first: it never passes the head loaded after it.
+        const uint32_t tail = tail_.load(std::memory_order_acquire);
+        return head_.load(std::memory_order_acquire) - tail;
+    }
+
+private:
+    static constexpr uint32_t kMask = static_cast<uint32_t>(Capacity - 1);
+
+    T slots_[Capacity]{};
+    std::atomic<uint32_t> head_{0};  ///< next slot to write (producer)
+    std::atomic<uint32_t> tail_{0};  ///< next slot to read (consumer)
+};
+
+#endif /* WATERINGSYSTEM_INTERFACES_SPSCRING_H */
@@ -0,0 +1,58 @@
+// SPDX-FileCopyrightText: 2026 Cryptotomte
+// SPDX-License-Identifier: AGPL-3.0-or-later
+/**
+ * @file StaticMutex.h
+ * @brief Mutex whose control block lives inside the object (header-only).
+ *
+ * On ESP-IDF a std::mutex is a pthread mutex that allocates its FreeRTOS
+ * semaphore from the heap on first lock — so a decorator built at boot can
+ * still fail to lock for the first time on a fragmented heap, hours later.
+ * StaticMutex is a FreeRTOS mutex made with xSemaphoreCreateMutexStatic()
+ * over a StaticSemaphore_t member: it never touches the heap, and like the
+ * pthread mutex it lends the holder the priority of a waiter. It meets the
+ * Lockable requirements, so std::lock_guard and std::unique_lock (also
+ * std::try_to_lock/std::defer_lock) take it as they took std::mutex.
+ *
+ * Only the firmware build defines WS_STATIC_MUTEX (top-level CMakeLists);
+ * the host test app and plain host compilers get std::mutex, so this stays
+ * the one header of the component that can reach FreeRTOS, and only on
+ * target (FreeRTOS is a common requirement of every IDF component there).
+ *
+ * Not for a std::condition_variable, which needs std::mutex: the bus
+ * masters and QueuedDataStorage keep theirs.
+ */
+
+#ifndef WATERINGSYSTEM_INTERFACES_STATICMUTEX_H
+#define WATERINGSYSTEM_INTERFACES_STATICMUTEX_H
+
+#if defined(WS_STATIC_MUTEX)
+
+#include "freertos/FreeRTOS.h"
+#include "freertos/semphr.h"
+
+class StaticMutex {
+public:
+    StaticMutex() : handle_(xSemaphoreCreateMutexStatic(&storage_)) {}
+    ~StaticMutex() { vSemaphoreDelete(handle_); }
+
+    StaticMutex(const StaticMutex&) = delete;
+    StaticMutex& operator=(const StaticMutex&) = delete;
+
+    void lock() { xSemaphoreTake(handle_, portMAX_DELAY); }
+    bool try_lock() { return xSemaphoreTake(handle_, 0) == pdTRUE; }
+    void unlock() { xSemaphoreGive(handle_); }
+
+private:
+    StaticSemaphore_t storage_;
+    SemaphoreHandle_t handle_;
+};
+
+#else
+
+#include <mutex>
+
+using StaticMutex = std::mutex;
+
+#endif
+
+#endif /* WATERINGSYSTEM_INTERFACES_STATICMUTEX_H */
@@ -0,0 +1,198 @@
+// SPDX-FileCopyrightText: 2026 Cryptotomte
+// SPDX-License-Identifier: AGPL-3.0-or-later
+/**
+ * @file TaskTelemetry.h
+ * @brief Per-task CPU share and stack margin plus heap per capability, as
+ *        one published snapshot (header-only).
+ *
+ * A sampler (main/telemetry_task.cpp) reads the FreeRTOS run-time counters
+ * of every task and the heap of each capability every few seconds and hands
+ * them to update(), which turns the counters into the CPU share each task
+ * had since the previous sample — per mille of ONE core, so a busy task
+ * tops out at 1000 and the two IDLE tasks show the headroom of each core —
+ * sorts the tasks busiest first and publishes the lot. A task or a window
+ * without a previous sample counts from zero, so the first snapshot is the
+ * average since boot. Counters are unsigned and wrap; the differences are
+ * taken modulo 2^32.
+ *
+ * SINGLE WRITER: update() runs on the sampler only. The published
+ * snapshot sits behind a mutex held only for one copy — not a Seqlock,
+ * whose word buffer would put a second snapshot on the httpd task's stack —
+ * and the readers (the `top` console command, GET /api/v1/metrics) copy it
+ * once per request. No allocation, no IDF includes.
+ */
+
+#ifndef WATERINGSYSTEM_INTERFACES_TASKTELEMETRY_H
+#define WATERINGSYSTEM_INTERFACES_TASKTELEMETRY_H
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <mutex>
+
+#include "interfaces/StaticMutex.h"
+
+/// Task name length with the terminator (configMAX_TASK_NAME_LEN).
+constexpr std::size_t kTaskNameLen = 16;
+
+/// One task as sampled.
+struct TaskCounters {
+    uint32_t id = 0;              ///< task number: stable across samples
+    const char* name = "";
+    uint32_t runTime = 0;         ///< run-time counter since creation
+    uint32_t stackFreeBytes = 0;  ///< stack high-water mark
+    uint8_t priority = 0;
+    int8_t core = -1;             ///< -1 = not pinned
+};
+
+/// Heap of one capability (all zero when the board has none of it).
+struct HeapCapsStats {
+    uint32_t totalBytes = 0;
+    uint32_t freeBytes = 0;
+    uint32_t minFreeBytes = 0;      ///< low-water mark since boot
+    uint32_t largestBlockBytes = 0; ///< largest allocatable block
+};
+
+/// The heap capabilities reported, in this order.
+enum class HeapCaps : uint8_t { Internal, Dma, Psram };
+constexpr std::size_t kHeapCapsCount = 3;
+
+/// Lower-case name of @p caps, for readers.
+inline const char* heapCapsName(HeapCaps caps)
+{
+    switch (caps) {
+    case HeapCaps::Internal: return "internal";
+    case HeapCaps::Dma:      return "dma";
+    case HeapCaps::Psram:    return "psram";
+    }
+    return "?";
+}
+
+/// One task over the last window.
+struct TaskLoad {
+    char name[kTaskNameLen] = {};
+    uint32_t stackFreeBytes = 0;
+    uint16_t cpuPermille = 0;     ///< of one core, 0..1000
+    uint8_t priority = 0;
+    int8_t core = -1;
+};
+
+/// What update() publishes.
+struct TelemetrySnapshot {
+    static constexpr std::size_t kMaxTasks = 32;
+
+    uint32_t samples = 0;         ///< updates since boot; 0 = none yet
+    int64_t atMs = 0;             ///< monotonic time of the sample
+    uint32_t windowUs = 0;        ///< run-time counter span of the window
+                                  ///< (esp_timer microseconds on target)
+    uint8_t taskCount = 0;
+    uint8_t tasksDropped = 0;     ///< tasks past kMaxTasks, left out
+    std::array<TaskLoad, kMaxTasks> tasks{};   ///< busiest first
+    std::array<HeapCapsStats, kHeapCapsCount> heaps{};  ///< by HeapCaps
+};
+
+class TaskTelemetry {
+public:
+    TaskTelemetry() = default;
+    TaskTelemetry(const TaskTelemetry&) = delete;
+    TaskTelemetry& operator=(const TaskTelemetry&) = delete;
+
+    /**
+     * @brief Publish a sample: @p count tasks and the total run-time counter
+     *        @p totalRunTime (the span one core runs per window), taken at
+     *        monotonic @p atMs, with the heap of each capability.
+     *
+     * Single writer. Tasks past kMaxTasks are counted, not kept.
+     */
+    void update(const TaskCounters* tasks, std::size_t count, uint32_t totalRunTime,
+                const std::array<HeapCapsStats, kHeapCapsCount>& heaps, int64_t atMs)
+    {
+        const uint32_t window = totalRunTime - lastTotal_;
+        const std::size_t kept =
+            count < TelemetrySnapshot::kMaxTasks ? count : TelemetrySnapshot::kMaxTasks;
+
+        next_.samples = next_.samples + 1;
+        next_.atMs = atMs;
+        next_.windowUs = window;
+        next_.taskCount = static_cast<uint8_t>(kept);
+        next_.tasksDropped = static_cast<uint8_t>(count - kept);
+        next_.heaps = heaps;
+
+        std::array<Previous, TelemetrySnapshot::kMaxTasks> seen{};
+        for (std::size_t i = 0; i < kept; ++i) {
+            const TaskCounters& t = tasks[i];
+            const uint32_t ran = t.runTime - previousRunTime(t.id);
+            uint64_t permille = window == 0 ? 0 : uint64_t{ran} * 1000u / window;
+            permille = permille > 1000 ? 1000 : permille;
+
+            TaskLoad load;
+            copyName(load.name, t.name);
+            load.stackFreeBytes = t.stackFreeBytes;
+            load.cpuPermille = static_cast<uint16_t>(permille);
+            load.priority = t.priority;
+            load.core = t.core;
+            insertByLoad(load, i);
+            seen[i] = Previous{t.id, t.runTime};
+        }
+        previous_ = seen;
+        previousCount_ = kept;
+        lastTotal_ = totalRunTime;
+        std::lock_guard<StaticMutex> lock(mutex_);
+        published_ = next_;
+    }
+
+    /// Copy the newest snapshot into @p out; samples == 0 until the first
+    /// update().
+    void snapshot(TelemetrySnapshot& out) const
+    {
+        std::lock_guard<StaticMutex> lock(mutex_);
+        out = published_;
+    }
+
+private:
+    struct Previous {
+        uint32_t id = 0;
+        uint32_t runTime = 0;
+    };
+
+    uint32_t previousRunTime(uint32_t id) const
+    {
+        for (std::size_t i = 0; i < previousCount_; ++i) {
+            if (previous_[i].id == id) {
+                return previous_[i].runTime;
+            }
+        }
+        return 0;  // new since the last sample
+    }
+
+    /// Names end up in Prometheus label values: no quotes or backslashes.
+    static void copyName(char (&dst)[kTaskNameLen], const char* src)
+    {
+        std::size_t n = 0;
+        for (; src != nullptr && src[n] != '\0' && n + 1 < kTaskNameLen; ++n) {
+            const char c = src[n];
+            dst[n] = (c == '"' || c == '\\' || c < ' ') ? '_' : c;
+        }
+        dst[n] = '\0';
+    }
+
+    /// Place @p load among the first @p filled tasks, busiest first.
+    void insertByLoad(const TaskLoad& load, std::size_t filled)
+    {
+        std::size_t at = filled;
+        while (at > 0 && next_.tasks[at - 1].cpuPermille < load.cpuPermille) {
+            next_.tasks[at] = next_.tasks[at - 1];
+            --at;
+        }
+        next_.tasks[at] = load;
+    }
+
+    TelemetrySnapshot next_;  ///< writer's scratch copy
+    std::array<Previous, TelemetrySnapshot::kMaxTasks> previous_{};
+    std::size_t previousCount_ = 0;
+    uint32_t lastTotal_ = 0;
+    mutable StaticMutex mutex_;
+    TelemetrySnapshot published_;
+};
+
+#endif /* WATERINGSYSTEM_INTERFACES_TASKTELEMETRY_H */
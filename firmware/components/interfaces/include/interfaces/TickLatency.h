@@ -0,0 +1,262 @@
+// SPDX-FileCopyrightText: 2026 Cryptotomte
+// SPDX-License-Identifier: AGPL-3.0-or-later
+/**
+ * @file TickLatency.h
+ * @brief How long the watering task's ticks take, by phase (header-only).
+ *
+ * The watering task brackets each decision tick with begin()/end(); in
+ * between the controllers mark what they are doing with a TickPhaseScope
+ * (the soil read or the feed's sample, the data-log appends, the event
+ * writes), and everything else counts as the decision. Each phase's share
+ * of a tick, and the whole tick, go into a histogram (bucket i ends at
+ * kBucketBaseUs << i, 250 us to 256 ms, the last is open) with their sum
+ * and the worst seen. A tick past the budget
+ * (CONFIG_WS_WATERING_TICK_BUDGET_MS) is counted, and end() reports it once
+ * per histogram bucket it reaches, so a stalling storage or bus shows as a
+ * handful of warnings, not one per tick. GET /api/v1/metrics exports it
+ * (`watering_tick_*`).
+ *
+ * One writer, the watering task; readers copy the atomics without a lock,
+ * so a copy may straddle one tick but never tears a word. The sums wrap
+ * after ~71 min of accumulated time in one phase. Before install() (host
+ * tests without a clock) nothing is recorded. No allocation, no IDF
+ * includes.
+ */
+
+#ifndef WATERINGSYSTEM_INTERFACES_TICKLATENCY_H
+#define WATERINGSYSTEM_INTERFACES_TICKLATENCY_H
+
+#include <array>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+
+/// What a watering tick spends its time on.
+enum class TickPhase : uint8_t { SensorRead, Decision, Logging, Events };
+constexpr std::size_t kTickPhases = 4;
+
+inline const char* tickPhaseName(TickPhase phase)
+{
+    switch (phase) {
+        case TickPhase::SensorRead: return "sensor_read";
+        case TickPhase::Decision:   return "decision";
+        case TickPhase::Logging:    return "logging";
+        case TickPhase::Events:     return "events";
+    }
+    return "unknown";
+}
+
+/// One phase's (or the whole tick's) durations, as copied out.
+struct TickDurationStats {
+    static constexpr std::size_t kBuckets = 12;
+    static constexpr uint32_t kBucketBaseUs = 250;  ///< first bucket ends here
+
+    uint32_t sumUs = 0;
+    uint32_t maxUs = 0;
+    std::array<uint32_t, kBuckets> buckets{};  ///< per bucket, not cumulative
+};
+
+/// The whole monitor, as copied out.
+struct TickLatencyStats {
+    uint32_t ticks = 0;
+    uint32_t overBudget = 0;  ///< ticks longer than budgetUs
+    uint32_t budgetUs = 0;    ///< 0: no budget
+    TickDurationStats tick;
+    std::array<TickDurationStats, kTickPhases> phases;  ///< by TickPhase
+};
+
+class TickLatency {
+public:
+    using Clock = int64_t (*)();  ///< microseconds, monotonic
+
+    TickLatency() = default;
+    TickLatency(const TickLatency&) = delete;
+    TickLatency& operator=(const TickLatency&) = delete;
+
+    /// Set the clock and the budget (0: none). Boot wiring only, before
+    /// the watering task starts.
+    void install(Clock clock, uint32_t budgetUs)
+    {
+        clock_ = clock;
+        budgetUs_.store(budgetUs, std::memory_order_relaxed);
+    }
+
+    /// Start a tick, in the decision phase.
+    void begin()
+    {
+        if (clock_ == nullptr) {
+            return;
+        }
+        startUs_ = clock_();
+        markUs_ = startUs_;
+        phase_ = TickPhase::Decision;
+        spentUs_ = {};
+        open_ = true;
+    }
+
+    /**
+     * @brief Charge the time since the last mark to the current phase and
+     * switch to @p phase. A no-op outside begin()/end().
+     * @return the phase left (restore it when done)
+     */
+    TickPhase enter(TickPhase phase)
+    {
+        const TickPhase left = phase_;
+        if (!open_) {
+            return left;
+        }
+        const int64_t now = clock_();
+        spentUs_[index(left)] += elapsedUs(markUs_, now);
+        markUs_ = now;
+        phase_ = phase;
+        return left;
+    }
+
+    /**
+     * @brief End the tick begun last and record it.
+     *
+     * @param[out] tickUs  the tick's duration (0 without begin())
+     * @param[out] slowest the phase that took the most of it
+     * @return true when the tick is over the budget and in a higher bucket
+     *         than any reported before
+     */
+    bool end(uint32_t& tickUs, TickPhase& slowest)
+    {
+        tickUs = 0;
+        slowest = TickPhase::Decision;
+        if (!open_) {
+            return false;
+        }
+        enter(phase_);
+        open_ = false;
+        tickUs = elapsedUs(startUs_, markUs_);
+        for (std::size_t p = 0; p < kTickPhases; ++p) {
+            record(phases_[p], spentUs_[p]);
+            if (spentUs_[p] > spentUs_[index(slowest)]) {
+                slowest = static_cast<TickPhase>(p);
+            }
+        }
+        record(tick_, tickUs);
+        bump(ticks_, 1);
+        const uint32_t budgetUs = budgetUs_.load(std::memory_order_relaxed);
+        if (budgetUs == 0 || tickUs <= budgetUs) {
+            return false;
+        }
+        bump(overBudget_, 1);
+        const int bucket = static_cast<int>(bucketOf(tickUs));
+        if (bucket <= warnedBucket_) {
+            return false;
+        }
+        warnedBucket_ = bucket;
+        return true;
+    }
+
+    TickLatencyStats snapshot() const
+    {
+        TickLatencyStats s;
+        s.ticks = ticks_.load(std::memory_order_relaxed);
+        s.overBudget = overBudget_.load(std::memory_order_relaxed);
+        s.budgetUs = budgetUs_.load(std::memory_order_relaxed);
+        copy(tick_, s.tick);
+        for (std::size_t p = 0; p < kTickPhases; ++p) {
+            copy(phases_[p], s.phases[p]);
+        }
+        return s;
+    }
+
+    /// The bucket a duration of @p us falls in.
+    static std::size_t bucketOf(uint32_t us)
+    {
+        std::size_t b = 0;
+        while (b + 1 < TickDurationStats::kBuckets &&
+               us >= (TickDurationStats::kBucketBaseUs << b)) {
+            ++b;
+        }
+        return b;
+    }
+
+private:
+    struct Histogram {
+        std::atomic<uint32_t> sumUs{0};
+        std::atomic<uint32_t> maxUs{0};
+        std::array<std::atomic<uint32_t>, TickDurationStats::kBuckets> buckets{};
+    };
+
+    static std::size_t index(TickPhase phase) { return static_cast<std::size_t>(phase); }
+
+    static uint32_t elapsedUs(int64_t from, int64_t to)
+    {
+        const int64_t us = to - from;
+        if (us <= 0) {
+            return 0;
+        }
+        return us > int64_t{UINT32_MAX} ? UINT32_MAX : static_cast<uint32_t>(us);
+    }
+
+    // Only the watering task writes, so a load/store pair loses nothing.
+    static void bump(std::atomic<uint32_t>& counter, uint32_t by)
+    {
+        counter.store(counter.load(std::memory_order_relaxed) + by,
+                      std::memory_order_relaxed);
+    }
+
+    static void record(Histogram& h, uint32_t us)
+    {
+        bump(h.buckets[bucketOf(us)], 1);
+        bump(h.sumUs, us);
+        if (us > h.maxUs.load(std::memory_order_relaxed)) {
+            h.maxUs.store(us, std::memory_order_relaxed);
+        }
+    }
+
+    static void copy(const Histogram& h, TickDurationStats& out)
+    {
+        out.sumUs = h.sumUs.load(std::memory_order_relaxed);
+        out.maxUs = h.maxUs.load(std::memory_order_relaxed);
+        for (std::size_t b = 0; b < TickDurationStats::kBuckets; ++b) {
+            out.buckets[b] = h.buckets[b].load(std::memory_order_relaxed);
+        }
+    }
+
+    Clock clock_ = nullptr;
+    // The tick in progress: the watering task's only.
+    bool open_ = false;
+    TickPhase phase_ = TickPhase::Decision;
+    int64_t startUs_ = 0;
+    int64_t markUs_ = 0;
+    std::array<uint32_t, kTickPhases> spentUs_{};
+    int warnedBucket_ = -1;
+
+    std::atomic<uint32_t> budgetUs_{0};
+    std::atomic<uint32_t> ticks_{0};
+    std::atomic<uint32_t> overBudget_{0};
+    Histogram tick_;
+    std::array<Histogram, kTickPhases> phases_{};
+};
+
+/**
+ * @brief Charge the enclosing block to @p phase of @p latency's tick, then
+ * go back to the phase it interrupted. @p latency may be nullptr (not
+ * monitored).
+ */
+class TickPhaseScope {
+public:
+    TickPhaseScope(TickLatency* latency, TickPhase phase)
+        : latency_(latency), left_(latency != nullptr ? latency->enter(phase) : phase)
+    {
+    }
+    ~TickPhaseScope()
+    {
+        if (latency_ != nullptr) {
+            latency_->enter(left_);
+        }
+    }
+    TickPhaseScope(const TickPhaseScope&) = delete;
+    TickPhaseScope& operator=(const TickPhaseScope&) = delete;
+
+private:
+    TickLatency* latency_;
+    TickPhase left_;
+};
+
+#endif /* WATERINGSYSTEM_INTERFACES_TICKLATENCY_H */
@@ -0,0 +1,251 @@
+// SPDX-FileCopyrightText: 2026 Cryptotomte
+// SPDX-License-Identifier: AGPL-3.0-or-later
+/**
+ * @file TraceBuffer.h
+ * @brief Per-core rings of fixed-size binary trace records, and the
+ *        WS_TRACE() macro that writes them (header-only, lock-free).
+ *
+ * A trace record is a timestamp, an event id and two 32-bit arguments —
+ * no format string, no formatting. WS_TRACE(Info, HttpEnd, a, b) costs a
+ * clock read, one atomic add and five word stores, so the instrumentation
+ * (httpd requests, the RS485 and I2C bus transactions, the sensor
+ * readings) stays built into production firmware. Names and argument
+ * meanings live with the readers: the `trace sys` console command and
+ * GET /api/v1/trace, a binary dump decoded offline (ApiStream.h).
+ *
+ * COMPILE-TIME LEVEL: a WS_TRACE() above WS_TRACE_LEVEL (0 = off, 1 =
+ * Error, 2 = Info, 3 = Debug) is a constant-false branch the compiler
+ * drops. The firmware sets WS_TRACE_LEVEL from CONFIG_WS_TRACE_LEVEL
+ * (interfaces/CMakeLists.txt); the host test app leaves it at 0.
+ *
+ * ONE RING PER CORE, MANY WRITERS: every task on a core, and a task
+ * preempting another mid-record, writes that core's ring. A writer claims
+ * its sequence with an atomic add, then stores the slot between two
+ * sequence stamps (0 while writing); a reader keeps a slot only if both
+ * stamps match the sequence it expects, so a record being written or
+ * since overwritten is skipped, never waited for. Records are never
+ * reordered within a ring, only lost to wrap-around; `written` minus the
+ * newest sequence read tells how many.
+ *
+ * Dropped until install() has set the clock and core source (app_main,
+ * before any other task runs). No allocation, no IDF includes.
+ */
+
+#ifndef WATERINGSYSTEM_INTERFACES_TRACEBUFFER_H
+#define WATERINGSYSTEM_INTERFACES_TRACEBUFFER_H
+
+#include <array>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+
+#if !defined(WS_TRACE_LEVEL)
+#define WS_TRACE_LEVEL 0
+#endif
+
+/// Trace levels; a level above WS_TRACE_LEVEL is compiled out.
+enum class TraceLevel : uint8_t {
+    Error = 1,
+    Info = 2,
+    Debug = 3,
+};
+
+/**
+ * @brief What a record reports, and what its arguments hold.
+ *
+ * The values are the wire format of GET /api/v1/trace: append new ids,
+ * never renumber one.
+ */
+enum class TraceId : uint16_t {
+    HttpBegin = 1,       ///< a: route metric slot
+    HttpEnd = 2,         ///< a: route slot | HTTP status << 16; b: us in the handler
+    ModbusStart = 10,    ///< a: address | op << 8 | priority << 16; b: us queued
+    ModbusDone = 11,     ///< a: client error (0 = ok); b: us on the bus
+    I2cStart = 20,       ///< a: address | op << 8; b: us queued
+    I2cDone = 21,        ///< a: 0 = ok, 1 = failed; b: us on the bus
+    EnvReading = 30,     ///< a: centi-degC (int32); b: 0.1 %RH | 0.1 hPa << 16
+    SoilReadFailed = 31, ///< a: device address; b: client error
+};
+
+/// Name of @p id, for readers.
+inline const char* traceIdName(TraceId id)
+{
+    switch (id) {
+    case TraceId::HttpBegin:      return "http-begin";
+    case TraceId::HttpEnd:        return "http-end";
+    case TraceId::ModbusStart:    return "modbus-start";
+    case TraceId::ModbusDone:     return "modbus-done";
+    case TraceId::I2cStart:       return "i2c-start";
+    case TraceId::I2cDone:        return "i2c-done";
+    case TraceId::EnvReading:     return "env-reading";
+    case TraceId::SoilReadFailed: return "soil-read-failed";
+    }
+    return "?";
+}
+
+/// Lower-case name of @p level, for readers.
+inline const char* traceLevelName(TraceLevel level)
+{
+    switch (level) {
+    case TraceLevel::Error: return "error";
+    case TraceLevel::Info:  return "info";
+    case TraceLevel::Debug: return "debug";
+    }
+    return "?";
+}
+
+/// One record as read back.
+struct TraceRecord {
+    uint32_t sequence = 0;  ///< 1-based, per ring
+    uint32_t atUs = 0;      ///< monotonic, low 32 bits (wraps every ~71 min)
+    TraceId id = TraceId::HttpBegin;
+    uint8_t core = 0;       ///< ring it was read from
+    TraceLevel level = TraceLevel::Info;
+    uint32_t a = 0;
+    uint32_t b = 0;
+};
+
+/// One core's ring of the newest kCapacity records.
+class TraceRing {
+public:
+    static constexpr std::size_t kCapacity = 128;
+
+    TraceRing() = default;
+    TraceRing(const TraceRing&) = delete;
+    TraceRing& operator=(const TraceRing&) = delete;
+
+    /// Append one record. Safe from any number of tasks (not from an ISR).
+    void emit(uint32_t atUs, TraceLevel level, TraceId id, uint32_t a, uint32_t b)
+    {
+        const uint32_t seq = written_.fetch_add(1, std::memory_order_relaxed) + 1;
+        Slot& slot = slots_[(seq - 1) % kCapacity];
+        slot.seq.store(0, std::memory_order_relaxed);
+        std::atomic_thread_fence(std::memory_order_release);
+        slot.atUs.store(atUs, std::memory_order_relaxed);
+        slot.idLevel.store(static_cast<uint32_t>(id) |
+                               (static_cast<uint32_t>(level) << 16),
+                           std::memory_order_relaxed);
+        slot.a.store(a, std::memory_order_relaxed);
+        slot.b.store(b, std::memory_order_relaxed);
+        slot.seq.store(seq, std::memory_order_release);
+    }
+
+    /// Records claimed since boot (the newest sequence).
+    uint32_t written() const { return written_.load(std::memory_order_acquire); }
+
+    /**
+     * @brief Copy up to @p max records with a sequence above @p after into
+     * @p out, oldest first; records being written or overwritten are skipped.
+     *
+     * Pass the last sequence read as @p after to continue from there.
+     * @return records copied (their `core` is left 0)
+     */
+    std::size_t read(TraceRecord* out, std::size_t max, uint32_t after = 0) const
+    {
+        const uint32_t newest = written();
+        uint32_t seq = after + 1;
+        if (newest > kCapacity && seq <= newest - kCapacity) {
+            seq = newest - kCapacity + 1;
+        }
+        std::size_t n = 0;
+        for (; seq <= newest && n < max; ++seq) {
+            const Slot& slot = slots_[(seq - 1) % kCapacity];
+            if (slot.seq.load(std::memory_order_acquire) != seq) {
+                continue;
+            }
+            TraceRecord rec;
+            rec.sequence = seq;
+            rec.atUs = slot.atUs.load(std::memory_order_relaxed);
+            const uint32_t idLevel = slot.idLevel.load(std::memory_order_relaxed);
+            rec.a = slot.a.load(std::memory_order_relaxed);
+            rec.b = slot.b.load(std::memory_order_relaxed);
+            std::atomic_thread_fence(std::memory_order_acquire);
+            if (slot.seq.load(std::memory_order_relaxed) != seq) {
+                continue;  // overwritten while copied
+            }
+            rec.id = static_cast<TraceId>(idLevel & 0xFFFFu);
+            rec.level = static_cast<TraceLevel>(idLevel >> 16);
+            out[n++] = rec;
+        }
+        return n;
+    }
+
+private:
+    struct Slot {
+        std::atomic<uint32_t> seq{0};  ///< sequence stored; 0 = being written
+        std::atomic<uint32_t> atUs{0};
+        std::atomic<uint32_t> idLevel{0};
+        std::atomic<uint32_t> a{0};
+        std::atomic<uint32_t> b{0};
+    };
+
+    std::array<Slot, kCapacity> slots_{};
+    std::atomic<uint32_t> written_{0};
+};
+
+/// The firmware's trace: one ring per core, stamped by the installed clock.
+class TraceBuffer {
+public:
+    static constexpr std::size_t kCores = 2;
+
+    using Clock = int64_t (*)();  ///< microseconds, monotonic
+    using CoreId = int (*)();     ///< the calling task's core
+
+    TraceBuffer() = default;
+    TraceBuffer(const TraceBuffer&) = delete;
+    TraceBuffer& operator=(const TraceBuffer&) = delete;
+
+    /// Set the clock and core source. Boot wiring only, before any task
+    /// that traces is started.
+    void install(Clock clock, CoreId core)
+    {
+        clock_ = clock;
+        core_ = core;
+    }
+
+    /// Append one record to the calling core's ring; dropped before install().
+    void emit(TraceLevel level, TraceId id, uint32_t a, uint32_t b)
+    {
+        if (clock_ == nullptr) {
+            return;
+        }
+        const int core = core_();
+        const std::size_t ring = core > 0 && static_cast<std::size_t>(core) < kCores
+                                     ? static_cast<std::size_t>(core)
+                                     : 0;
+        rings_[ring].emit(static_cast<uint32_t>(clock_()), level, id, a, b);
+    }
+
+    /// The ring of core @p core (< kCores).
+    const TraceRing& ring(std::size_t core) const { return rings_[core]; }
+
+private:
+    Clock clock_ = nullptr;
+    CoreId core_ = nullptr;
+    std::array<TraceRing, kCores> rings_{};
+};
+
+/// The firmware's one TraceBuffer (a function-local static).
+inline TraceBuffer& traceBuffer()
+{
+    static TraceBuffer buffer;
+    return buffer;
+}
+
+/**
+ * @brief Trace event @p id at @p level (the TraceLevel and TraceId
+ * enumerator names) with arguments @p a and @p b.
+ *
+ * Compiled out when @p level is above WS_TRACE_LEVEL; the arguments are
+ * then not evaluated.
+ */
+#define WS_TRACE(level, id, a, b)                                             \
+    do {                                                                      \
+        if (static_cast<int>(TraceLevel::level) <= WS_TRACE_LEVEL) {          \
+            traceBuffer().emit(TraceLevel::level, TraceId::id,                \
+                               static_cast<uint32_t>(a),                      \
+                               static_cast<uint32_t>(b));                     \
+        }                                                                     \
+    } while (0)
+
+#endif /* WATERINGSYSTEM_INTERFACES_TRACEBUFFER_H */
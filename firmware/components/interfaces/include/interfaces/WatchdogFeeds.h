@@ -0,0 +1,187 @@
+// SPDX-FileCopyrightText: 2026 Cryptotomte
+// SPDX-License-Identifier: AGPL-3.0-or-later
+/**
+ * @file WatchdogFeeds.h
+ * @brief Interval between task-watchdog feeds, per subscribed task
+ *        (header-only).
+ *
+ * main/task_watchdog records every watchdog_feed() of a subscribed task
+ * here: a histogram of the intervals (bucket i ends at kBucketBaseUs << i,
+ * 10 ms to 20.48 s, the last is open), their count and sum, and the
+ * longest. An interval past the warning threshold (a fraction of the WDT
+ * timeout, CONFIG_WS_TASK_WDT_WARN_PERCENT) is reported by feed() once per
+ * histogram bucket it reaches, so a task drifting toward a TASK_WDT reset
+ * logs a handful of warnings, not one per feed. GET /api/v1/metrics
+ * exports the histograms (`watchdog_feed_interval_seconds`).
+ *
+ * Each slot is written only by the task it belongs to (subscribe() claims
+ * it, feed() updates it); readers copy the atomics without a lock, so a
+ * copy may straddle one feed but never tears a word. Fixed capacity, no
+ * allocation, no IDF includes.
+ */
+
+#ifndef WATERINGSYSTEM_INTERFACES_WATCHDOGFEEDS_H
+#define WATERINGSYSTEM_INTERFACES_WATCHDOGFEEDS_H
+
+#include <array>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+
+/// One subscribed task's feed intervals, as copied out.
+struct WatchdogFeedStats {
+    static constexpr std::size_t kBuckets = 13;
+    static constexpr uint32_t kBucketBaseUs = 10'000;  ///< first bucket ends here
+
+    char name[16] = {};                        ///< task name, truncated
+    uint32_t intervals = 0;                    ///< feeds after the first
+    uint32_t sumMs = 0;                        ///< of the intervals (wraps ~49 d)
+    uint32_t maxIntervalUs = 0;
+    std::array<uint32_t, kBuckets> buckets{};  ///< per bucket, not cumulative
+};
+
+class WatchdogFeeds {
+public:
+    static constexpr std::size_t kMaxTasks = 8;
+
+    /// @p warnAfterUs: an interval above it is reported; 0 reports none.
+    explicit WatchdogFeeds(uint32_t warnAfterUs = 0) : warnAfterUs_(warnAfterUs) {}
+
+    WatchdogFeeds(const WatchdogFeeds&) = delete;
+    WatchdogFeeds& operator=(const WatchdogFeeds&) = delete;
+
+    /**
+     * @brief Claim a slot for @p owner (the calling task) named @p name,
+     * fed last at @p nowUs. A repeat subscription of the same owner only
+     * restarts its interval.
+     * @return false when every slot is taken (the task's feeds go untracked)
+     */
+    bool subscribe(const void* owner, const char* name, int64_t nowUs)
+    {
+        if (Slot* slot = find(owner)) {
+            slot->lastFeedUs = nowUs;
+            return true;
+        }
+        // Tasks subscribe concurrently at start-up: claim, fill, then publish.
+        const std::size_t n = claimed_.fetch_add(1, std::memory_order_relaxed);
+        if (n >= kMaxTasks) {
+            return false;
+        }
+        Slot& slot = slots_[n];
+        slot.owner = owner;
+        std::strncpy(slot.name, name != nullptr ? name : "?", sizeof slot.name - 1);
+        slot.lastFeedUs = nowUs;
+        slot.ready.store(true, std::memory_order_release);
+        return true;
+    }
+
+    /**
+     * @brief Record a feed by @p owner at @p nowUs.
+     *
+     * @param[out] intervalUs the interval since the previous feed (0 for an
+     *             owner that never subscribed)
+     * @return true when this interval is past the warning threshold and in
+     *         a higher bucket than any reported before for this task
+     */
+    bool feed(const void* owner, int64_t nowUs, uint32_t& intervalUs)
+    {
+        intervalUs = 0;
+        Slot* slot = find(owner);
+        if (slot == nullptr) {
+            return false;
+        }
+        const int64_t us = nowUs - slot->lastFeedUs;
+        slot->lastFeedUs = nowUs;
+        intervalUs = us <= 0 ? 0
+                             : (us > int64_t{UINT32_MAX} ? UINT32_MAX
+                                                         : static_cast<uint32_t>(us));
+        const std::size_t bucket = bucketOf(intervalUs);
+        bump(slot->buckets[bucket], 1);
+        bump(slot->intervals, 1);
+        bump(slot->sumMs, intervalUs / 1000u);
+        if (intervalUs > slot->maxIntervalUs.load(std::memory_order_relaxed)) {
+            slot->maxIntervalUs.store(intervalUs, std::memory_order_relaxed);
+        }
+        if (warnAfterUs_ == 0 || intervalUs <= warnAfterUs_ ||
+            static_cast<int>(bucket) <= slot->warnedBucket) {
+            return false;
+        }
+        slot->warnedBucket = static_cast<int>(bucket);
+        return true;
+    }
+
+    /**
+     * @brief Copy up to @p max subscribed tasks' intervals into @p out, in
+     * subscription order.
+     * @return tasks copied
+     */
+    std::size_t copy(WatchdogFeedStats* out, std::size_t max) const
+    {
+        std::size_t n = 0;
+        for (const Slot& slot : slots_) {
+            if (n == max) {
+                break;
+            }
+            if (!slot.ready.load(std::memory_order_acquire)) {
+                continue;
+            }
+            WatchdogFeedStats& s = out[n++];
+            std::memcpy(s.name, slot.name, sizeof s.name);
+            s.intervals = slot.intervals.load(std::memory_order_relaxed);
+            s.sumMs = slot.sumMs.load(std::memory_order_relaxed);
+            s.maxIntervalUs = slot.maxIntervalUs.load(std::memory_order_relaxed);
+            for (std::size_t b = 0; b < WatchdogFeedStats::kBuckets; ++b) {
+                s.buckets[b] = slot.buckets[b].load(std::memory_order_relaxed);
+            }
+        }
+        return n;
+    }
+
+    /// The bucket an interval of @p us falls in.
+    static std::size_t bucketOf(uint32_t us)
+    {
+        std::size_t b = 0;
+        while (b + 1 < WatchdogFeedStats::kBuckets &&
+               us >= (WatchdogFeedStats::kBucketBaseUs << b)) {
+            ++b;
+        }
+        return b;
+    }
+
+private:
+    struct Slot {
+        std::atomic<bool> ready{false};  ///< owner and name are set
+        const void* owner = nullptr;
+        char name[16] = {};
+        int64_t lastFeedUs = 0;  ///< owner task only
+        int warnedBucket = -1;   ///< owner task only
+        std::atomic<uint32_t> intervals{0};
+        std::atomic<uint32_t> sumMs{0};
+        std::atomic<uint32_t> maxIntervalUs{0};
+        std::array<std::atomic<uint32_t>, WatchdogFeedStats::kBuckets> buckets{};
+    };
+
+    Slot* find(const void* owner)
+    {
+        for (Slot& slot : slots_) {
+            if (slot.ready.load(std::memory_order_acquire) && slot.owner == owner) {
+                return &slot;
+            }
+        }
+        return nullptr;
+    }
+
+    // Only the owner writes its slot, so a load/store pair loses nothing.
+    static void bump(std::atomic<uint32_t>& counter, uint32_t by)
+    {
+        counter.store(counter.load(std::memory_order_relaxed) + by,
+                      std::memory_order_relaxed);
+    }
+
+    const uint32_t warnAfterUs_;
+    std::array<Slot, kMaxTasks> slots_{};
+    std::atomic<std::size_t> claimed_{0};
+};
+
+#endif /* WATERINGSYSTEM_INTERFACES_WATCHDOGFEEDS_H */
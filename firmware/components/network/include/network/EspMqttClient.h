@@ -0,0 +1,83 @@
+// SPDX-FileCopyrightText: 2026 Cryptotomte
+// SPDX-License-Identifier: AGPL-3.0-or-later
+/**
+ * @file EspMqttClient.h
+ * @brief IMqttClient implementation over esp-mqtt (target-only).
+ *
+ * The single network touchpoint of the MQTT uplink: one persistent broker
+ * session (esp-mqtt reconnects on its own), QoS 1 publishes queued into the
+ * esp-mqtt outbox without blocking (esp_mqtt_client_enqueue), and the
+ * CONNECTED / DISCONNECTED / PUBLISHED callbacks translated into a
+ * thread-safe MqttEvent queue drained by pollEvent() — the same hand-off
+ * as EspWifiDriver. No batching, no retry policy: that is api::MqttUplink.
+ *
+ * PRESENCE: the session registers a retained last will "offline" on
+ * `<statusTopic>` and publishes a retained "online" on every connect, so
+ * the broker side sees a node drop without polling it.
+ *
+ * PRIV rule (same as EspWifiDriver): mqtt_client.h and the FreeRTOS queue
+ * appear only in the .cpp; handles are opaque void*. The password is never
+ * logged. Excluded from the linux build (host tests use MockMqttClient).
+ */
+
+#ifndef WATERINGSYSTEM_NETWORK_ESPMQTTCLIENT_H
+#define WATERINGSYSTEM_NETWORK_ESPMQTTCLIENT_H
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+#include "esp_err.h"
+
+#include "interfaces/IMqttClient.h"
+
+/// Broker session settings (app_main fills them from Kconfig).
+struct EspMqttSettings {
+    std::string uri;          ///< "mqtt://host:1883" or "mqtts://..."
+    std::string clientId;     ///< unique per node
+    std::string username;     ///< empty = anonymous
+    std::string password;
+    std::string statusTopic;  ///< retained "online"/"offline"
+    uint16_t keepaliveS = 30;
+    std::size_t outboxBytes = 16 * 1024;  ///< unacknowledged payload bound
+};
+
+/**
+ * @brief esp-mqtt-backed broker session.
+ *
+ * Lifetime: an app_main function-local static (trivial constructor); start()
+ * once, with the station up — esp-mqtt then keeps the session across Wi-Fi
+ * drops by itself.
+ */
+class EspMqttClient : public IMqttClient {
+public:
+    EspMqttClient() = default;
+
+    EspMqttClient(const EspMqttClient&) = delete;
+    EspMqttClient& operator=(const EspMqttClient&) = delete;
+
+    /**
+     * @brief Create the event queue and the esp-mqtt client and start it.
+     * Idempotent. @p settings is copied.
+     * @return ESP_OK, or the first failing esp_err_t (the uplink then just
+     *         never sees `Connected`)
+     */
+    esp_err_t start(const EspMqttSettings& settings);
+
+    int publish(const std::string& topic, const std::string& payload) override;
+    MqttEvent pollEvent() override;
+
+    /// Events lost to a full queue since boot (a lost PUBACK only means the
+    /// message is replayed again).
+    uint32_t droppedEvents() const { return droppedEvents_; }
+
+private:
+    static void onMqttEvent(void* arg, const char* base, int32_t id, void* data);
+
+    EspMqttSettings settings_;
+    void* client_ = nullptr;      ///< esp_mqtt_client_handle_t
+    void* eventQueue_ = nullptr;  ///< QueueHandle_t of MqttEvent
+    uint32_t droppedEvents_ = 0;
+};
+
+#endif /* WATERINGSYSTEM_NETWORK_ESPMQTTCLIENT_H */
@@ -0,0 +1,61 @@
+// SPDX-FileCopyrightText: 2026 Cryptotomte
+// SPDX-License-Identifier: AGPL-3.0-or-later
+/**
+ * @file EspNowLink.h
+ * @brief IEspNowLink implementation over esp_now (target-only).
+ *
+ * The single radio touchpoint of the multi-node link: esp_now_init on the
+ * already-started Wi-Fi driver, peers added on first send (channel 0 = the
+ * station's current channel, so leaf and gateway must share the AP's
+ * channel), and the receive callback copied into a static FreeRTOS queue
+ * drained by receive() — the same hand-off as EspMqttClient. No framing,
+ * no retries: that is api::NodeLeaf / api::NodeGateway.
+ *
+ * PRIV rule (same as EspWifiDriver): esp_now.h and the FreeRTOS queue
+ * appear only in the .cpp. Excluded from the linux build (host tests use
+ * MockEspNowLink).
+ */
+
+#ifndef WATERINGSYSTEM_NETWORK_ESPNOWLINK_H
+#define WATERINGSYSTEM_NETWORK_ESPNOWLINK_H
+
+#include <cstddef>
+#include <cstdint>
+
+#include "esp_err.h"
+
+#include "interfaces/IEspNowLink.h"
+
+/**
+ * @brief esp_now-backed datagram link.
+ *
+ * Lifetime: an app_main function-local static; start() once, after
+ * EspWifiDriver::init() and the station start. esp_now has no callback
+ * argument, so there is at most one instance.
+ */
+class EspNowLink : public IEspNowLink {
+public:
+    EspNowLink() = default;
+
+    EspNowLink(const EspNowLink&) = delete;
+    EspNowLink& operator=(const EspNowLink&) = delete;
+
+    /**
+     * @brief Create the receive queue, init esp_now and register the
+     * callbacks. Idempotent.
+     * @return ESP_OK, or the first failing esp_err_t (send() then refuses
+     *         every frame)
+     */
+    esp_err_t start();
+
+    bool send(const EspNowMac& to, const uint8_t* data, std::size_t len) override;
+    bool receive(EspNowPacket& out) override;
+
+    /// Frames lost to a full receive queue since boot.
+    uint32_t droppedFrames() const;
+
+private:
+    bool started_ = false;
+};
+
+#endif /* WATERINGSYSTEM_NETWORK_ESPNOWLINK_H */
@@ -20,15 +20,25 @@
  * app_main, on target) pulls in no WiFi/netif dependency. Credential values
  * are never logged (FR-004 / PR-06 convention): the SSID may be logged, the
  * password never.
+ *
+ * FAST RECONNECT: on every GotIp the driver reads the joined AP's BSSID,
+ * primary channel and auth mode and, when they changed, stores them with
+ * the SSID in NVS (namespace "ws_wifi", one small blob, so it survives the
+ * brown-outs and power cycles RTC memory would not). A
+ * WifiConnectTier::Cached attempt then sets bssid/channel/auth threshold in
+ * the STA config, so esp_wifi probes one channel instead of scanning all
+ * of them. Which tier to use is WifiManager's decision.
  */
 
 #ifndef WATERINGSYSTEM_NETWORK_ESPWIFIDRIVER_H
 #define WATERINGSYSTEM_NETWORK_ESPWIFIDRIVER_H
 
 #include <string>
+#include <vector>
 
 #include "esp_err.h"
 
+#include "interfaces/IConfigStore.h"
 #include "interfaces/IWifiDriver.h"
 
 /**
@@ -60,16 +70,36 @@ public:
      */
     esp_err_t init();
 
-    bool staConnect(const std::string& ssid,
-                    const std::string& password) override;
+    /**
+     * @brief Configure the STA netif: a static address when @p ip is
+     *        enabled (DHCP client stopped, GOT_IP posted by esp_netif as
+     *        soon as the station associates), else the DHCP client.
+     *
+     * Call after init() and before the first staConnect. @p ip must pass
+     * IConfigStore::isValidStaticIp() (getStaticIp() guarantees it).
+     * @return ESP_OK, or the failing esp_netif error (DHCP then stays on)
+     */
+    esp_err_t setStaticIp(const StaticIpConfig& ip);
+
+    bool staConnect(const std::string& ssid, const std::string& password,
+                    WifiConnectTier tier) override;
+    bool hasCachedAp(const std::string& ssid) const override;
     void staStop() override;
     bool apStart(const std::string& ssid,
                  const std::string& password) override;
     void apStop() override;
     WifiEvent pollEvent() override;
     int8_t rssi() const override;
+    bool setPowerSave(WifiPowerSave mode, uint8_t listenInterval) override;
+    bool startScan() override;
+    bool takeScanResults(std::vector<WifiNetwork>& out) override;
 
 private:
+    /// Remember the AP just joined, writing NVS only when it changed.
+    void refreshCachedAp();
+
+    std::string staSsid_;  ///< SSID of the latest staConnect (cache key)
+    uint8_t listenInterval_ = 0;  ///< sta.listen_interval; 0 = IDF default (3)
     // Held opaque to keep esp_wifi/esp_netif/freertos headers in the .cpp.
     void* eventQueue_ = nullptr;  ///< QueueHandle_t of WifiEvent (thread-safe)
     void* staNetif_ = nullptr;    ///< esp_netif_t* for the STA interface
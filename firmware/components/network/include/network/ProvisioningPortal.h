@@ -8,7 +8,13 @@
  * Provisioning (AP) mode (feature 007, US1). It serves a small self-contained
  * setup page and accepts a POST that validates + persists WiFi credentials,
  * then schedules a restart so the operator's new settings take effect. The
- * full JSON status API and /api/wifi/scan are out of scope (PR-09).
+ * full JSON status API is out of scope (PR-09).
+ *
+ * GET /scan.json lists the networks in range from a WifiScanCache, at once
+ * (the scan task refreshes it in the background; `?refresh=1` asks for a
+ * rescan). The pages come gzipped with their ETags from the same asset
+ * store as the dashboard (setup.html, setup-saved.html; IStaticAssets),
+ * falling back to small embedded copies when the volume lacks them.
  *
  * This is the only HTTP touchpoint of the `network` component and is excluded
  * from the linux build (esp_http_server has no host port); all reusable
@@ -33,6 +39,8 @@
 #include "esp_err.h"
 
 #include "interfaces/IConfigStore.h"
+#include "interfaces/IStaticAssets.h"
+#include "network/WifiScanCache.h"
 
 /**
  * @brief Standalone provisioning HTTP server over IConfigStore.
@@ -77,15 +85,27 @@ public:
      */
     esp_err_t start();
 
+    /// Serve GET /scan.json from @p cache. Call before start(); @p cache
+    /// must outlive the portal. Without it the route answers 404.
+    void setScanCache(WifiScanCache& cache) { scanCache_ = &cache; }
+
+    /// Serve the pages from @p assets when it holds them. Call before
+    /// start(); @p assets must outlive the portal.
+    void setAssets(IStaticAssets& assets) { assets_ = &assets; }
+
+    WifiScanCache* scanCache() { return scanCache_; }
+    IStaticAssets* assets() { return assets_; }
+
     /**
      * @brief Stop the HTTP server. Idempotent.
      */
     void stop();
 
     // -- Submission API used by the POST route handler (.cpp) --------------
-    // Validation happens in the handler via the pure validateWifiCredentials;
-    // these two steps stay on the instance so the handler can interleave them
-    // with the HTTP response (persist, respond 200, then restart).
+    // Validation happens in the handler via the pure validateWifiCredentials
+    // and parseStaticIp; these steps stay on the instance so the handler can
+    // interleave them with the HTTP response (persist, respond 200, then
+    // restart).
 
     /**
      * @brief Persist already-validated credentials.
@@ -95,6 +115,12 @@ public:
     bool persistCredentials(const std::string& ssid,
                             const std::string& password);
 
+    /**
+     * @brief Persist an already-parsed static IP set (all zero = DHCP).
+     * @return false on a persistence failure (handler responds 5xx).
+     */
+    bool persistStaticIp(const StaticIpConfig& ip);
+
     /**
      * @brief Invoke the restart hook (default: schedule a deferred reboot).
      * Called after the success response has been sent.
@@ -104,6 +130,8 @@ public:
 private:
     IConfigStore& configStore_;
     RestartHook restartHook_;
+    WifiScanCache* scanCache_ = nullptr;
+    IStaticAssets* assets_ = nullptr;
     void* server_ = nullptr;  ///< opaque httpd_handle_t (see .cpp)
 };
 
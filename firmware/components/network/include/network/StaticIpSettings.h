@@ -0,0 +1,98 @@
+// SPDX-FileCopyrightText: 2026 Cryptotomte
+// SPDX-License-Identifier: AGPL-3.0-or-later
+/**
+ * @file StaticIpSettings.h
+ * @brief Pure dotted-quad parsing and formatting for the station static IP
+ *        (host + target).
+ *
+ * Shared by the provisioning portal (the optional ip/netmask/gateway/dns
+ * form fields), the `config ip` console item and the host test suite, so
+ * every entry point accepts exactly the same text. Addresses are host order,
+ * as StaticIpConfig stores them. No IDF includes.
+ */
+
+#ifndef WATERINGSYSTEM_NETWORK_STATICIPSETTINGS_H
+#define WATERINGSYSTEM_NETWORK_STATICIPSETTINGS_H
+
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <string>
+
+#include "interfaces/IConfigStore.h"
+
+/**
+ * @brief Parse a strict dotted quad ("192.168.1.20"): four decimal octets
+ * 0..255, one to three digits each, nothing else.
+ * @return false (@p out untouched) on any other text
+ */
+inline bool parseIpv4(const std::string& text, uint32_t& out)
+{
+    uint32_t value = 0;
+    std::size_t pos = 0;
+    for (int octet = 0; octet < 4; ++octet) {
+        if (octet > 0) {
+            if (pos >= text.size() || text[pos] != '.') {
+                return false;
+            }
+            ++pos;
+        }
+        uint32_t part = 0;
+        std::size_t digits = 0;
+        while (pos < text.size() && text[pos] >= '0' && text[pos] <= '9' && digits < 3) {
+            part = part * 10 + static_cast<uint32_t>(text[pos] - '0');
+            ++pos;
+            ++digits;
+        }
+        if (digits == 0 || part > 255) {
+            return false;
+        }
+        value = (value << 8) | part;
+    }
+    if (pos != text.size()) {
+        return false;
+    }
+    out = value;
+    return true;
+}
+
+/// @p address as a dotted quad.
+inline std::string formatIpv4(uint32_t address)
+{
+    char buf[16];
+    std::snprintf(buf, sizeof buf, "%u.%u.%u.%u",
+                  static_cast<unsigned>(address >> 24),
+                  static_cast<unsigned>((address >> 16) & 0xFFu),
+                  static_cast<unsigned>((address >> 8) & 0xFFu),
+                  static_cast<unsigned>(address & 0xFFu));
+    return buf;
+}
+
+/**
+ * @brief Build a StaticIpConfig from its four text fields.
+ *
+ * An empty @p address selects DHCP (the other fields are then ignored); an
+ * empty @p gateway or @p dns is left unset. The result must also pass
+ * IConfigStore::isValidStaticIp().
+ * @return false (@p out untouched) on malformed text or an invalid set
+ */
+inline bool parseStaticIp(const std::string& address, const std::string& netmask,
+                          const std::string& gateway, const std::string& dns,
+                          StaticIpConfig& out)
+{
+    if (address.empty()) {
+        out = StaticIpConfig{};
+        return true;
+    }
+    StaticIpConfig ip;
+    if (!parseIpv4(address, ip.address) || !parseIpv4(netmask, ip.netmask) ||
+        (!gateway.empty() && !parseIpv4(gateway, ip.gateway)) ||
+        (!dns.empty() && !parseIpv4(dns, ip.dns)) ||
+        !IConfigStore::isValidStaticIp(ip)) {
+        return false;
+    }
+    out = ip;
+    return true;
+}
+
+#endif /* WATERINGSYSTEM_NETWORK_STATICIPSETTINGS_H */
@@ -15,6 +15,8 @@
  * tick() is strictly non-blocking: it advances purely from
  * ITimeProvider::nowMs() deltas and drained IWifiDriver::pollEvent()s, never
  * sleeps or waits, and never triggers a restart/reboot (FR-013, no boot loop).
+ * A tick() that changes the state tells the IWifiStateObserver, if any, so
+ * consumers of the transitions need not poll snapshot().
  *
  * Normative contract:
  * specs/007-wifi-provisioning/contracts/wifi-manager-states.md and
@@ -25,22 +27,43 @@
 #ifndef WATERINGSYSTEM_NETWORK_WIFIMANAGER_H
 #define WATERINGSYSTEM_NETWORK_WIFIMANAGER_H
 
+#include <atomic>
 #include <cstdint>
+#include <string>
 
 #include "interfaces/IConfigStore.h"
 #include "interfaces/ITimeProvider.h"
 #include "interfaces/IWifiDriver.h"
+#include "interfaces/SnapshotPublisher.h"
 #include "network/WifiBootMode.h"
 #include "network/WifiState.h"
 
+/**
+ * @brief Receives the WifiManager's state changes.
+ */
+class IWifiStateObserver {
+public:
+    virtual ~IWifiStateObserver() = default;
+
+    /**
+     * @brief The state is now @p state (one call per tick() that changed
+     * it; a tick that passes through several states reports the last).
+     *
+     * Runs on the task that ticks the manager, inside tick(): an
+     * implementation must be short, must not block and must not call back
+     * into the manager.
+     */
+    virtual void onStateChanged(WifiState state) = 0;
+};
+
 /**
  * @brief Station-mode connection lifecycle + reconnect scheduler.
  *
  * Drive it by calling begin() once at boot and tick() at a fixed cadence from
  * the wifi task (T019). All external effects go through the injected
  * IWifiDriver; time comes from ITimeProvider; credentials are read from
- * IConfigStore. Unsynchronized by design — cross-task readers consume the
- * immutable snapshot() (single acquisition at the wiring site).
+ * IConfigStore. Unsynchronized by design — cross-task readers consume
+ * snapshot(), which begin() and tick() publish when they return.
  */
 class WifiManager {
 public:
@@ -68,6 +91,30 @@ public:
      */
     void begin(WifiBootMode mode);
 
+    /**
+     * @brief Set the power save policy (default: WifiPowerSavePolicy{}).
+     * Boot wiring, before begin(); applied by tick() in station mode.
+     */
+    void setPowerSavePolicy(const WifiPowerSavePolicy& policy) { powerSave_ = policy; }
+
+    /**
+     * @brief Report whether latency matters right now (a pump runs, a stream
+     * client is connected). Any task may call it; the next tick() turns
+     * power save off while busy and back on busyLingerMs after the last
+     * busy report.
+     */
+    void setBusy(bool busy) { busy_.store(busy, std::memory_order_relaxed); }
+
+    /**
+     * @brief Tell @p observer of every state change tick() makes (nullptr =
+     * none). An atomic pointer, so the wiring may install it after the wifi
+     * task runs; @p observer must outlive the manager or be removed first.
+     */
+    void setObserver(IWifiStateObserver* observer)
+    {
+        observer_.store(observer, std::memory_order_release);
+    }
+
     /**
      * @brief Advance the state machine once (non-blocking).
      *
@@ -79,36 +126,64 @@ public:
 
     /**
      * @brief Consistent copy of state + counters + rssi for status/LED
-     * consumers (single acquisition at the wiring site).
+     * consumers, as of the last begin() or tick(). Any task; never blocks.
      */
-    WifiConnectionSnapshot snapshot() const;
+    WifiConnectionSnapshot snapshot() const { return published_.load(); }
+
+    /// Changes of snapshot() so far, for a poller to skip an unchanged one.
+    uint32_t snapshotVersion() const { return published_.version(); }
 
 private:
+    /// One tick() step: drain the events, apply the timed transitions.
+    void advance();
+
     /// Read credentials and issue a staConnect, entering Connecting.
     void startConnect();
 
+    /// The members snapshot() reports, as one value.
+    WifiConnectionSnapshot current() const;
+
     /// Apply one drained lifecycle event to the state machine.
     void handleEvent(WifiEvent event);
 
-    /// Handle a ConnectFailed/Disconnected event (schedule retry or pause).
+    /// Handle a ConnectFailed/Disconnected event (fast retry, scheduled
+    /// retry or pause).
     void handleFailure(int64_t now);
 
+    /// True while this round may still make a directed attempt at @p ssid.
+    bool cachedTierLeft(const std::string& ssid) const;
+
+    /// Switch the driver to the mode the policy and busy flag call for.
+    void applyPowerSave(int64_t now);
+
     IWifiDriver& driver_;
     IConfigStore& config_;
     ITimeProvider& time_;
     ReconnectPolicy policy_;
+    WifiPowerSavePolicy powerSave_;
 
     WifiState state_ = WifiState::Connecting;
     int8_t rssi_ = 0;
     uint8_t consecutiveFailures_ = 0;
     uint32_t disconnectCount_ = 0;
     bool ipAcquired_ = false;
+    uint8_t cachedTries_ = 0;      ///< directed attempts made this round
+    bool attemptCached_ = false;   ///< the attempt in flight is directed
+    std::atomic<bool> busy_{false};
+    std::atomic<IWifiStateObserver*> observer_{nullptr};
+    bool powerSaveApplied_ = false;  ///< appliedPowerSave_ is the driver's mode
+    WifiPowerSave appliedPowerSave_ = WifiPowerSave::MinModem;
+    bool everBusy_ = false;
+    int64_t lastBusyMs_ = 0;          ///< nowMs() of the last busy tick
 
     /// Deadline for the next STA attempt (Reconnecting) or pause release
     /// (ReconnectPaused), an absolute nowMs() value.
     int64_t nextAttemptMs_ = 0;
     /// Last time the connected-health monitor refreshed rssi (Connected).
     int64_t lastMonitorMs_ = 0;
+
+    /// current() as of the last begin()/tick(), for the other tasks.
+    SnapshotPublisher<WifiConnectionSnapshot> published_{current()};
 };
 
 #endif /* WATERINGSYSTEM_NETWORK_WIFIMANAGER_H */
@@ -0,0 +1,91 @@
+// SPDX-FileCopyrightText: 2026 Cryptotomte
+// SPDX-License-Identifier: AGPL-3.0-or-later
+/**
+ * @file WifiScanCache.h
+ * @brief Background Wi-Fi scans for the setup portal, served from a cache
+ *        (pure, host + target).
+ *
+ * A scan takes a few seconds (every channel, ~120 ms each), far too long
+ * for a captive-portal page to wait on. The scan task ticks this cache: a
+ * scan starts when the last one is older than the refresh interval (or a
+ * client asked for one) and runs in the background over the non-blocking
+ * IWifiDriver::startScan(); its results are deduplicated by SSID, sorted
+ * strongest first and kept. The portal's GET /scan.json answers at once
+ * from the cache — `"scanning": true` while a newer list is on its way,
+ * for the page to poll — and `?refresh=1` asks for a rescan without
+ * waiting for it. Rescans are at least kMinRescanMs apart, so a phone
+ * hammering refresh does not keep the radio off the AP's channel.
+ *
+ * THREADS: tick() on the scan task; snapshot() and requestRefresh() from
+ * any task (the portal's httpd task) under a StaticMutex.
+ */
+
+#ifndef WATERINGSYSTEM_NETWORK_WIFISCANCACHE_H
+#define WATERINGSYSTEM_NETWORK_WIFISCANCACHE_H
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include "interfaces/ITimeProvider.h"
+#include "interfaces/IWifiDriver.h"
+#include "interfaces/StaticMutex.h"
+
+class WifiScanCache {
+public:
+    /// Networks kept (the strongest); a setup page lists no more.
+    static constexpr std::size_t kMaxNetworks = 20;
+    /// Shortest gap between two scans, requested or not.
+    static constexpr uint32_t kMinRescanMs = 5000;
+    /// A scan that has not reported by then is written off.
+    static constexpr uint32_t kScanTimeoutMs = 15000;
+
+    /// What the portal serves.
+    struct Snapshot {
+        std::vector<WifiNetwork> networks;  ///< strongest first
+        bool scanning = false;              ///< a newer list is on its way
+        bool valid = false;                 ///< a scan has completed
+        uint32_t ageMs = 0;                 ///< since that scan completed
+    };
+
+    /// @p driver and @p clock must outlive the cache; a new scan every
+    /// @p refreshMs (at least kMinRescanMs).
+    WifiScanCache(IWifiDriver& driver, ITimeProvider& clock, uint32_t refreshMs);
+
+    WifiScanCache(const WifiScanCache&) = delete;
+    WifiScanCache& operator=(const WifiScanCache&) = delete;
+
+    /// Scan task cadence: collect a finished scan, start one when due.
+    void tick();
+
+    /// Rescan at the next tick that kMinRescanMs allows.
+    void requestRefresh();
+
+    Snapshot snapshot() const;
+
+    /// Dedupe @p raw by SSID (strongest kept), drop hidden (empty) SSIDs,
+    /// sort by RSSI descending and keep kMaxNetworks.
+    static std::vector<WifiNetwork> normalize(std::vector<WifiNetwork> raw);
+
+    /// `{"scanning":b,"ageS":n,"networks":[{"ssid":s,"rssi":n,"channel":n,
+    /// "open":b}]}`; SSID bytes are JSON-escaped, `ageS` is -1 before the
+    /// first scan.
+    static std::string toJson(const Snapshot& snapshot);
+
+private:
+    IWifiDriver& driver_;
+    ITimeProvider& clock_;
+    const uint32_t refreshMs_;
+
+    mutable StaticMutex mutex_;
+    std::vector<WifiNetwork> networks_;
+    bool valid_ = false;
+    bool scanning_ = false;
+    bool refreshRequested_ = false;
+    int64_t completedAtMs_ = 0;  ///< last scan that reported
+    int64_t startedAtMs_ = 0;    ///< last scan that started
+    bool everStarted_ = false;
+};
+
+#endif /* WATERINGSYSTEM_NETWORK_WIFISCANCACHE_H */
@@ -17,6 +17,8 @@
 
 #include <cstdint>
 
+#include "interfaces/IWifiDriver.h"
+
 /**
  * @brief WifiManager state (data-model.md state machine).
  *
@@ -37,14 +39,11 @@ enum class WifiState {
 /**
  * @brief Point-in-time, by-value status copy for status/LED consumers.
  *
- * Produced by WifiManager::snapshot() as a plain by-value, point-in-time copy
- * of the state + counters. WifiManager is unsynchronized with a single writer
- * (the wifi task's tick()); snapshot() is NOT itself synchronized. A cross-task
- * reader (the diag console, and since feature 009 the HTTP `/api/v1/status`
- * handler) may therefore observe state up to one tick old, or a momentarily
- * torn tuple — acceptable for status display only (the same trade-off as the
- * PR-08 SyncStatus reader). Consistent with WifiManager.h ("Unsynchronized by
- * design").
+ * Produced by WifiManager::snapshot() as a plain by-value copy of the state
+ * + counters. The single writer (the wifi task's begin()/tick()) publishes
+ * it through a SnapshotPublisher at the end of each call, so a cross-task
+ * reader (the diag console, the HTTP `/api/v1/status` handler, MQTT) gets a
+ * consistent tuple, up to one tick old, without a lock.
  */
 struct WifiConnectionSnapshot {
     WifiState state;               ///< current state machine state
@@ -52,6 +51,7 @@ struct WifiConnectionSnapshot {
     uint8_t consecutiveFailures;   ///< 0..failuresBeforePause; drives the pause
     uint32_t disconnectCount;      ///< monotonic drop count, for diagnostics
     bool ipAcquired;               ///< true after GotIp
+    WifiPowerSave powerSave;       ///< mode the driver last accepted
 };
 
 /**
@@ -60,12 +60,44 @@ struct WifiConnectionSnapshot {
  * Kept as a plain struct so the wiring site can override from Kconfig
  * (CONFIG_WS_WIFI_*). Defaults match docs/parity-checklist.md §7:
  * 10 s retry, +60 s pause after 5 consecutive failures, 5 s health monitor.
+ *
+ * Two tiers per round: while the driver remembers the AP, the first
+ * cachedAttempts attempts are directed at it (WifiConnectTier::Cached) and
+ * a failed one falls back to a full scan at once, not after
+ * retryIntervalMs; a link that drops from Connected is retried the same way
+ * at once. Only full-scan failures count toward failuresBeforePause.
  */
 struct ReconnectPolicy {
     uint32_t retryIntervalMs = 10000;   ///< delay between STA attempts
     uint8_t failuresBeforePause = 5;    ///< failures that trigger the pause
     uint32_t pauseMs = 60000;           ///< extra wait before the next round
     uint32_t monitorIntervalMs = 5000;  ///< health-check cadence (Connected)
+    uint8_t cachedAttempts = 1;         ///< directed attempts per round (0 = always scan)
+};
+
+/**
+ * @brief Station power save policy (defaults = the IDF defaults).
+ *
+ * `mode` applies while the link is idle. While busy (WifiManager::setBusy:
+ * a pump runs or a stream client is connected) power save is off, and it
+ * returns only after busyLingerMs without activity, so a stream client that
+ * reconnects does not flip the radio back and forth.
+ */
+struct WifiPowerSavePolicy {
+    WifiPowerSave mode = WifiPowerSave::MinModem;
+    uint8_t listenInterval = 3;      ///< beacons between MaxModem wake-ups
+    uint32_t busyLingerMs = 5000;    ///< idle time before power save returns
 };
 
+/// Stable lowercase name of @p mode (console, status and /metrics).
+inline const char* wifiPowerSaveName(WifiPowerSave mode)
+{
+    switch (mode) {
+        case WifiPowerSave::None:     return "none";
+        case WifiPowerSave::MinModem: return "min_modem";
+        case WifiPowerSave::MaxModem: return "max_modem";
+    }
+    return "unknown";
+}
+
 #endif /* WATERINGSYSTEM_NETWORK_WIFISTATE_H */
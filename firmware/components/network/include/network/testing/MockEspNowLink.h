@@ -0,0 +1,85 @@
+// SPDX-FileCopyrightText: 2026 Cryptotomte
+// SPDX-License-Identifier: AGPL-3.0-or-later
+/**
+ * @file MockEspNowLink.h
+ * @brief Scriptable IEspNowLink test double (header-only).
+ *
+ * Backs the NodeLeaf / NodeGateway host tests: every accepted send() is
+ * recorded, a scripted receive queue is consumed by receive(). No radio.
+ * Never compiled into target builds (only included from test code). No IDF
+ * includes. Mirrors MockMqttClient.
+ */
+
+#ifndef WATERINGSYSTEM_NETWORK_TESTING_MOCKESPNOWLINK_H
+#define WATERINGSYSTEM_NETWORK_TESTING_MOCKESPNOWLINK_H
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <deque>
+#include <vector>
+
+#include "interfaces/IEspNowLink.h"
+
+/**
+ * @brief IEspNowLink over a scripted receive queue, instrumented for tests.
+ */
+class MockEspNowLink : public IEspNowLink {
+public:
+    struct Frame {
+        EspNowMac to{};
+        std::vector<uint8_t> data;
+    };
+
+    // -- Instrumentation (public, MockMqttClient style) -------------------
+    std::vector<Frame> sent;  ///< every accepted send, in order
+    int rejectedSends = 0;
+    bool sendResult = true;   ///< false: the driver refuses the frame
+
+    /// Scripted receive queue (public for direct assertions/manipulation).
+    std::deque<EspNowPacket> inbox;
+
+    // -- Scripting --------------------------------------------------------
+
+    void deliver(const EspNowMac& from, const uint8_t* data, std::size_t len,
+                 int8_t rssi = -50)
+    {
+        EspNowPacket packet;
+        packet.from = from;
+        packet.rssi = rssi;
+        packet.len = static_cast<uint8_t>(std::min(len, kEspNowMaxPayload));
+        std::memcpy(packet.data, data, packet.len);
+        inbox.push_back(packet);
+    }
+
+    void deliver(const EspNowMac& from, const std::vector<uint8_t>& data,
+                 int8_t rssi = -50)
+    {
+        deliver(from, data.data(), data.size(), rssi);
+    }
+
+    // -- IEspNowLink ------------------------------------------------------
+
+    bool send(const EspNowMac& to, const uint8_t* data, std::size_t len) override
+    {
+        if (!sendResult || len > kEspNowMaxPayload) {
+            ++rejectedSends;
+            return false;
+        }
+        sent.push_back(Frame{to, std::vector<uint8_t>(data, data + len)});
+        return true;
+    }
+
+    bool receive(EspNowPacket& out) override
+    {
+        if (inbox.empty()) {
+            return false;
+        }
+        out = inbox.front();
+        inbox.pop_front();
+        return true;
+    }
+};
+
+#endif /* WATERINGSYSTEM_NETWORK_TESTING_MOCKESPNOWLINK_H */
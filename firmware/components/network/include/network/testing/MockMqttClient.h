@@ -0,0 +1,90 @@
+// SPDX-FileCopyrightText: 2026 Cryptotomte
+// SPDX-License-Identifier: AGPL-3.0-or-later
+/**
+ * @file MockMqttClient.h
+ * @brief Scriptable IMqttClient test double (header-only).
+ *
+ * Backs the MqttUplink host tests: every accepted publish() is recorded
+ * with the message id it was given, a scripted event queue is consumed by
+ * pollEvent(), and ack() queues the PUBACK of a recorded message. No real
+ * networking. Never compiled into target builds (only included from test
+ * code). No IDF includes. Mirrors MockWifiDriver.
+ */
+
+#ifndef WATERINGSYSTEM_NETWORK_TESTING_MOCKMQTTCLIENT_H
+#define WATERINGSYSTEM_NETWORK_TESTING_MOCKMQTTCLIENT_H
+
+#include <cstddef>
+#include <deque>
+#include <string>
+#include <vector>
+
+#include "interfaces/IMqttClient.h"
+
+/**
+ * @brief IMqttClient over a scripted event queue, instrumented for tests.
+ */
+class MockMqttClient : public IMqttClient {
+public:
+    struct Message {
+        int msgId = -1;
+        std::string topic;
+        std::string payload;
+    };
+
+    // -- Instrumentation (public, MockWifiDriver style) -------------------
+    std::vector<Message> published;  ///< every accepted publish, in order
+    int rejectedPublishes = 0;
+    bool publishResult = true;  ///< false: the outbox refuses the message
+
+    /// Scripted event queue (public for direct assertions/manipulation).
+    std::deque<MqttEvent> events;
+
+    // -- Scripting --------------------------------------------------------
+
+    void queueEvent(MqttEventType type, int msgId = -1)
+    {
+        events.push_back(MqttEvent{type, msgId});
+    }
+
+    /// Queue the PUBACK of published[@p index].
+    void ack(std::size_t index)
+    {
+        queueEvent(MqttEventType::Published, published.at(index).msgId);
+    }
+
+    /// Queue the PUBACK of every recorded message from @p first on.
+    void ackFrom(std::size_t first)
+    {
+        for (std::size_t i = first; i < published.size(); ++i) {
+            ack(i);
+        }
+    }
+
+    // -- IMqttClient ------------------------------------------------------
+
+    int publish(const std::string& topic, const std::string& payload) override
+    {
+        if (!publishResult) {
+            ++rejectedPublishes;
+            return -1;
+        }
+        published.push_back(Message{nextId_, topic, payload});
+        return nextId_++;
+    }
+
+    MqttEvent pollEvent() override
+    {
+        if (events.empty()) {
+            return MqttEvent{};
+        }
+        const MqttEvent event = events.front();
+        events.pop_front();
+        return event;
+    }
+
+private:
+    int nextId_ = 1;
+};
+
+#endif /* WATERINGSYSTEM_NETWORK_TESTING_MOCKMQTTCLIENT_H */
@@ -7,7 +7,9 @@
  * Backs the WifiManager host tests (feature 007): a scriptable event queue
  * consumed by pollEvent() (queueEvent + scriptConnectSuccess /
  * scriptConnectFailure helpers), call counters for the STA/AP methods, the
- * last ssid/password passed to staConnect/apStart, and a settable rssi().
+ * last ssid/password (and STA connect tier) passed to staConnect/apStart, a
+ * settable cached AP, a settable rssi() and a scan that ends when the test
+ * says so (finishScan).
  * No real networking; deterministic under FakeTimeProvider. Never compiled
  * into target builds (only included from test code). No IDF includes.
  * Mirrors MockConfigStore / MockModbusClient.
@@ -19,6 +21,8 @@
 #include <cstdint>
 #include <deque>
 #include <string>
+#include <utility>
+#include <vector>
 
 #include "interfaces/IWifiDriver.h"
 
@@ -41,6 +45,19 @@ public:
     std::string lastStaPassword;  ///< password of the most recent staConnect
     std::string lastApSsid;       ///< ssid of the most recent apStart
     std::string lastApPassword;   ///< password of the most recent apStart
+    WifiConnectTier lastStaTier = WifiConnectTier::FullScan;  ///< of the most recent staConnect
+    int cachedStaConnects = 0;    ///< staConnect calls with WifiConnectTier::Cached
+
+    bool cachedAp = false;  ///< hasCachedAp() for any ssid
+
+    int powerSaveCalls = 0;
+    WifiPowerSave lastPowerSave = WifiPowerSave::MinModem;  ///< of the last accepted call
+    uint8_t lastListenInterval = 0;
+    bool powerSaveResult = true;   ///< false: the radio refuses the mode
+
+    int startScanCalls = 0;
+    bool scanRunning = false;
+    bool startScanResult = true;   ///< false: the radio refuses the scan
 
     bool staConnectResult = true;  ///< false: synchronous staConnect failure
     bool apStartResult = true;     ///< false: synchronous apStart failure
@@ -71,20 +88,37 @@ public:
      */
     void setRssi(int8_t value) { rssi_ = value; }
 
+    /**
+     * @brief End the running scan with @p found, for the next
+     * takeScanResults().
+     */
+    void finishScan(std::vector<WifiNetwork> found)
+    {
+        scanRunning = false;
+        scanResults_ = std::move(found);
+        scanDone_ = true;
+    }
+
     /// Scripted event queue (public for direct assertions/manipulation).
     std::deque<WifiEvent> events;
 
     // -- IWifiDriver ------------------------------------------------------
 
-    bool staConnect(const std::string& ssid,
-                    const std::string& password) override
+    bool staConnect(const std::string& ssid, const std::string& password,
+                    WifiConnectTier tier) override
     {
         ++staConnectCalls;
         lastStaSsid = ssid;
         lastStaPassword = password;
+        lastStaTier = tier;
+        if (tier == WifiConnectTier::Cached) {
+            ++cachedStaConnects;
+        }
         return staConnectResult;
     }
 
+    bool hasCachedAp(const std::string& /*ssid*/) const override { return cachedAp; }
+
     void staStop() override { ++staStopCalls; }
 
     bool apStart(const std::string& ssid,
@@ -110,8 +144,42 @@ public:
 
     int8_t rssi() const override { return rssi_; }
 
+    bool setPowerSave(WifiPowerSave mode, uint8_t listenInterval) override
+    {
+        ++powerSaveCalls;
+        if (!powerSaveResult) {
+            return false;
+        }
+        lastPowerSave = mode;
+        lastListenInterval = listenInterval;
+        return true;
+    }
+
+    bool startScan() override
+    {
+        ++startScanCalls;
+        if (!startScanResult || scanRunning) {
+            return false;
+        }
+        scanRunning = true;
+        return true;
+    }
+
+    bool takeScanResults(std::vector<WifiNetwork>& out) override
+    {
+        if (!scanDone_) {
+            return false;
+        }
+        scanDone_ = false;
+        out = std::move(scanResults_);
+        scanResults_.clear();
+        return true;
+    }
+
 private:
     int8_t rssi_ = 0;
+    bool scanDone_ = false;
+    std::vector<WifiNetwork> scanResults_;
 };
 
 #endif /* WATERINGSYSTEM_NETWORK_TESTING_MOCKWIFIDRIVER_H */
@@ -0,0 +1,140 @@
+// SPDX-FileCopyrightText: 2026 Cryptotomte
+// SPDX-License-Identifier: AGPL-3.0-or-later
+/**
+ * @file EspMqttClient.cpp
+ * @brief esp-mqtt session and event queue (see EspMqttClient.h).
+ *
+ * The esp-mqtt callbacks run on the esp-mqtt task; they only push an
+ * MqttEvent into a static FreeRTOS queue, drained by the mqtt task through
+ * pollEvent(). A full queue drops the newest event rather than blocking the
+ * esp-mqtt task.
+ */
+
+#include "network/EspMqttClient.h"
+
+#include "esp_log.h"
+#include "freertos/FreeRTOS.h"
+#include "freertos/queue.h"
+#include "mqtt_client.h"
+
+static const char *TAG = "mqtt";
+
+namespace {
+
+constexpr UBaseType_t kEventQueueLen = 16;
+constexpr const char* kOnline = "online";
+constexpr const char* kOffline = "offline";
+
+StaticQueue_t s_eventQueue;
+uint8_t s_eventQueueStorage[kEventQueueLen * sizeof(MqttEvent)];
+
+}  // namespace
+
+void EspMqttClient::onMqttEvent(void* arg, const char* /*base*/, int32_t id,
+                                void* data)
+{
+    EspMqttClient& self = *static_cast<EspMqttClient*>(arg);
+    const auto* mqtt = static_cast<const esp_mqtt_event_t*>(data);
+    MqttEvent event;
+    switch (static_cast<esp_mqtt_event_id_t>(id)) {
+        case MQTT_EVENT_CONNECTED:
+            ESP_LOGI(TAG, "connected to %s", self.settings_.uri.c_str());
+            (void)esp_mqtt_client_enqueue(
+                static_cast<esp_mqtt_client_handle_t>(self.client_),
+                self.settings_.statusTopic.c_str(), kOnline, 0, 1, 1, true);
+            event.type = MqttEventType::Connected;
+            break;
+        case MQTT_EVENT_DISCONNECTED:
+            ESP_LOGW(TAG, "disconnected");
+            event.type = MqttEventType::Disconnected;
+            break;
+        case MQTT_EVENT_PUBLISHED:
+            event.type = MqttEventType::Published;
+            event.msgId = mqtt->msg_id;
+            break;
+        case MQTT_EVENT_ERROR:
+            if (mqtt->error_handle != nullptr &&
+                mqtt->error_handle->error_type == MQTT_ERROR_TYPE_CONNECTION_REFUSED) {
+                ESP_LOGW(TAG, "broker refused the connection (code %d)",
+                         static_cast<int>(mqtt->error_handle->connect_return_code));
+            }
+            return;
+        default:
+            return;
+    }
+    if (xQueueSend(static_cast<QueueHandle_t>(self.eventQueue_), &event, 0) != pdTRUE) {
+        ++self.droppedEvents_;
+    }
+}
+
+esp_err_t EspMqttClient::start(const EspMqttSettings& settings)
+{
+    if (client_ != nullptr) {
+        return ESP_OK;  // idempotent
+    }
+    settings_ = settings;
+    QueueHandle_t queue = xQueueCreateStatic(kEventQueueLen, sizeof(MqttEvent),
+                                             s_eventQueueStorage, &s_eventQueue);
+    if (queue == nullptr) {
+        return ESP_ERR_NO_MEM;
+    }
+    eventQueue_ = queue;
+
+    esp_mqtt_client_config_t cfg = {};
+    cfg.broker.address.uri = settings_.uri.c_str();
+    cfg.credentials.client_id = settings_.clientId.c_str();
+    if (!settings_.username.empty()) {
+        cfg.credentials.username = settings_.username.c_str();
+        cfg.credentials.authentication.password = settings_.password.c_str();
+    }
+    cfg.session.keepalive = settings_.keepaliveS;
+    cfg.session.last_will.topic = settings_.statusTopic.c_str();
+    cfg.session.last_will.msg = kOffline;
+    cfg.session.last_will.qos = 1;
+    cfg.session.last_will.retain = 1;
+    cfg.outbox.limit = static_cast<uint64_t>(settings_.outboxBytes);
+
+    esp_mqtt_client_handle_t client = esp_mqtt_client_init(&cfg);
+    if (client == nullptr) {
+        ESP_LOGE(TAG, "esp_mqtt_client_init failed");
+        return ESP_FAIL;
+    }
+    client_ = client;  // before start: the CONNECTED callback uses it
+    esp_err_t err = esp_mqtt_client_register_event(
+        client, MQTT_EVENT_ANY, &EspMqttClient::onMqttEvent, this);
+    if (err == ESP_OK) {
+        err = esp_mqtt_client_start(client);
+    }
+    if (err != ESP_OK) {
+        ESP_LOGE(TAG, "client start failed: %s", esp_err_to_name(err));
+        esp_mqtt_client_destroy(client);
+        client_ = nullptr;
+        return err;
+    }
+    ESP_LOGI(TAG, "session to %s as %s", settings_.uri.c_str(),
+             settings_.clientId.c_str());
+    return ESP_OK;
+}
+
+int EspMqttClient::publish(const std::string& topic, const std::string& payload)
+{
+    if (client_ == nullptr) {
+        return -1;
+    }
+    // enqueue, not publish: the outbox send happens on the esp-mqtt task, so
+    // the caller never waits on the socket. -2 (outbox full) is "not taken".
+    const int msgId = esp_mqtt_client_enqueue(
+        static_cast<esp_mqtt_client_handle_t>(client_), topic.c_str(),
+        payload.data(), static_cast<int>(payload.size()), 1, 0, true);
+    return msgId > 0 ? msgId : -1;
+}
+
+MqttEvent EspMqttClient::pollEvent()
+{
+    MqttEvent event;
+    if (eventQueue_ != nullptr &&
+        xQueueReceive(static_cast<QueueHandle_t>(eventQueue_), &event, 0) == pdTRUE) {
+        return event;
+    }
+    return MqttEvent{};
+}
@@ -0,0 +1,108 @@
+// SPDX-FileCopyrightText: 2026 Cryptotomte
+// SPDX-License-Identifier: AGPL-3.0-or-later
+/**
+ * @file EspNowLink.cpp
+ * @brief esp_now session and receive queue (see EspNowLink.h).
+ *
+ * The receive callback runs on the Wi-Fi task; it only copies the frame
+ * into a static FreeRTOS queue, drained by the node task through receive().
+ * A full queue drops the newest frame rather than blocking the Wi-Fi task —
+ * the sender's retry covers it.
+ */
+
+#include "network/EspNowLink.h"
+
+#include <atomic>
+#include <cstring>
+
+#include "esp_log.h"
+#include "esp_now.h"
+#include "freertos/FreeRTOS.h"
+#include "freertos/queue.h"
+
+static const char *TAG = "espnow";
+
+namespace {
+
+constexpr UBaseType_t kRxQueueLen = 8;
+
+StaticQueue_t s_rxQueue;
+uint8_t s_rxQueueStorage[kRxQueueLen * sizeof(EspNowPacket)];
+QueueHandle_t s_rx = nullptr;
+std::atomic<uint32_t> s_dropped{0};
+
+void on_receive(const esp_now_recv_info_t* info, const uint8_t* data, int len)
+{
+    if (info == nullptr || data == nullptr || len <= 0 ||
+        static_cast<std::size_t>(len) > kEspNowMaxPayload) {
+        return;
+    }
+    EspNowPacket packet;
+    std::memcpy(packet.from.data(), info->src_addr, packet.from.size());
+    packet.rssi = info->rx_ctrl != nullptr
+                      ? static_cast<int8_t>(info->rx_ctrl->rssi)
+                      : int8_t{0};
+    packet.len = static_cast<uint8_t>(len);
+    std::memcpy(packet.data, data, static_cast<std::size_t>(len));
+    if (xQueueSend(s_rx, &packet, 0) != pdTRUE) {
+        s_dropped.fetch_add(1, std::memory_order_relaxed);
+    }
+}
+
+}  // namespace
+
+esp_err_t EspNowLink::start()
+{
+    if (started_) {
+        return ESP_OK;  // idempotent
+    }
+    s_rx = xQueueCreateStatic(kRxQueueLen, sizeof(EspNowPacket),
+                              s_rxQueueStorage, &s_rxQueue);
+    if (s_rx == nullptr) {
+        return ESP_ERR_NO_MEM;
+    }
+    esp_err_t err = esp_now_init();
+    if (err == ESP_OK) {
+        err = esp_now_register_recv_cb(&on_receive);
+    }
+    if (err != ESP_OK) {
+        ESP_LOGE(TAG, "esp_now start failed: %s", esp_err_to_name(err));
+        (void)esp_now_deinit();
+        return err;
+    }
+    started_ = true;
+    ESP_LOGI(TAG, "esp_now up");
+    return ESP_OK;
+}
+
+bool EspNowLink::send(const EspNowMac& to, const uint8_t* data, std::size_t len)
+{
+    if (!started_ || len == 0 || len > kEspNowMaxPayload) {
+        return false;
+    }
+    if (!esp_now_is_peer_exist(to.data())) {
+        esp_now_peer_info_t peer = {};
+        std::memcpy(peer.peer_addr, to.data(), to.size());
+        peer.channel = 0;  // whatever channel the station is on
+        peer.ifidx = WIFI_IF_STA;
+        peer.encrypt = false;
+        const esp_err_t err = esp_now_add_peer(&peer);
+        if (err != ESP_OK) {
+            // ESP_ERR_ESPNOW_FULL on a gateway past the peer table: the
+            // frame is dropped and the leaf retries later.
+            ESP_LOGW(TAG, "peer not added: %s", esp_err_to_name(err));
+            return false;
+        }
+    }
+    return esp_now_send(to.data(), data, len) == ESP_OK;
+}
+
+bool EspNowLink::receive(EspNowPacket& out)
+{
+    return s_rx != nullptr && xQueueReceive(s_rx, &out, 0) == pdTRUE;
+}
+
+uint32_t EspNowLink::droppedFrames() const
+{
+    return s_dropped.load(std::memory_order_relaxed);
+}
@@ -18,7 +18,9 @@
 #include "network/EspWifiDriver.h"
 
 #include <algorithm>
+#include <atomic>
 #include <cstring>
+#include <utility>
 
 #include "esp_event.h"
 #include "esp_log.h"
@@ -26,6 +28,7 @@
 #include "esp_wifi.h"
 #include "freertos/FreeRTOS.h"
 #include "freertos/queue.h"
+#include "nvs.h"
 
 static const char *TAG = "espwifidriver";
 
@@ -35,11 +38,44 @@ namespace {
 /// is plenty; the manager drains the whole queue every tick (250 ms).
 constexpr UBaseType_t kEventQueueLen = 8;
 
+/// Static storage of the event queue: one driver per firmware, and the
+/// queue is never made from the heap (init() may run after it fragmented).
+StaticQueue_t s_eventQueue;
+uint8_t s_eventQueueStorage[kEventQueueLen * sizeof(WifiEvent)];
+
 /// Diagnostic count of events dropped because the queue was full. Both event
 /// handlers run on the single default event-loop task, so a plain counter is
 /// race-free here.
 uint32_t droppedEvents = 0;
 
+/// The AP of the last successful association, as kept in NVS. Fixed
+/// layout; a blob of another size is ignored.
+struct CachedAp {
+    char ssid[33];      ///< NUL-terminated; the cache only serves this SSID
+    uint8_t bssid[6];
+    uint8_t channel;    ///< primary channel
+    uint8_t authMode;   ///< wifi_auth_mode_t
+};
+constexpr const char *kCacheNamespace = "ws_wifi";
+constexpr const char *kCacheKey = "ap";
+
+/// Loaded by init(), refreshed on GotIp; only the wifi task touches it.
+CachedAp s_cachedAp;
+bool s_haveCachedAp = false;
+
+/// Records fetched per scan; the rest of the radio's list is dropped.
+constexpr uint16_t kMaxScanRecords = 24;
+/// Dwell per channel of an active scan: short, so a portal client on the
+/// SoftAP's channel sees only brief gaps while the radio is away.
+constexpr uint32_t kScanDwellMinMs = 60;
+constexpr uint32_t kScanDwellMaxMs = 120;
+
+/// Set by WIFI_EVENT_SCAN_DONE (event-loop task), cleared by
+/// takeScanResults() (scan task).
+std::atomic<bool> s_scanDone{false};
+/// takeScanResults() buffer: static, not on the scan task's stack.
+wifi_ap_record_t s_scanRecords[kMaxScanRecords];
+
 /// Copy a std::string into a fixed-size, NUL-terminated esp_wifi field
 /// (ssid/password are uint8_t[] arrays in wifi_config_t). Never logs the
 /// content — callers decide what is safe to log.
@@ -71,6 +107,10 @@ WifiEvent translateWifiEvent(int32_t id)
 void wifiEventHandler(void *arg, esp_event_base_t /*base*/, int32_t id,
                       void * /*data*/)
 {
+    if (id == WIFI_EVENT_SCAN_DONE) {
+        s_scanDone.store(true);  // collected by takeScanResults(), not queued
+        return;
+    }
     QueueHandle_t queue = static_cast<QueueHandle_t>(arg);
     const WifiEvent event = translateWifiEvent(id);
     if (event != WifiEvent::None && queue != nullptr) {
@@ -142,7 +182,8 @@ esp_err_t EspWifiDriver::init()
 
     // Thread-safe hand-off between the esp_event task (producer) and the wifi
     // task (consumer, via pollEvent()).
-    QueueHandle_t queue = xQueueCreate(kEventQueueLen, sizeof(WifiEvent));
+    QueueHandle_t queue = xQueueCreateStatic(kEventQueueLen, sizeof(WifiEvent),
+                                             s_eventQueueStorage, &s_eventQueue);
     if (queue == nullptr) {
         ESP_LOGE(TAG, "failed to create WiFi event queue");
         esp_wifi_deinit();
@@ -190,13 +231,64 @@ esp_err_t EspWifiDriver::init()
                  esp_err_to_name(err));
     }
 
+    // The AP remembered from an earlier boot (fast-reconnect tier). Absent
+    // on a first boot or after an NVS erase: every attempt then scans.
+    nvs_handle_t nvs = 0;
+    if (nvs_open(kCacheNamespace, NVS_READONLY, &nvs) == ESP_OK) {
+        std::size_t len = sizeof s_cachedAp;
+        s_haveCachedAp = nvs_get_blob(nvs, kCacheKey, &s_cachedAp, &len) == ESP_OK &&
+                         len == sizeof s_cachedAp && s_cachedAp.channel != 0;
+        s_cachedAp.ssid[sizeof s_cachedAp.ssid - 1] = '\0';
+        nvs_close(nvs);
+    }
+
     initialized_ = true;
-    ESP_LOGI(TAG, "WiFi driver initialized (STA + AP netifs, event queue)");
+    ESP_LOGI(TAG, "WiFi driver initialized (STA + AP netifs, event queue%s)",
+             s_haveCachedAp ? ", cached AP" : "");
+    return ESP_OK;
+}
+
+esp_err_t EspWifiDriver::setStaticIp(const StaticIpConfig &ip)
+{
+    if (!initialized_) {
+        return ESP_ERR_INVALID_STATE;
+    }
+    auto *netif = static_cast<esp_netif_t *>(staNetif_);
+    if (!ip.enabled()) {
+        // DHCP (the netif default). With CONFIG_LWIP_DHCP_RESTORE_LAST_IP the
+        // client first asks for the lease it held before the reset.
+        const esp_err_t err = esp_netif_dhcpc_start(netif);
+        return err == ESP_ERR_ESP_NETIF_DHCP_ALREADY_STARTED ? ESP_OK : err;
+    }
+
+    esp_err_t err = esp_netif_dhcpc_stop(netif);
+    if (err != ESP_OK && err != ESP_ERR_ESP_NETIF_DHCP_ALREADY_STOPPED) {
+        return err;
+    }
+    // StaticIpConfig is host order; esp_ip4_addr_t holds network order.
+    esp_netif_ip_info_t info = {};
+    info.ip.addr = esp_netif_htonl(ip.address);
+    info.netmask.addr = esp_netif_htonl(ip.netmask);
+    info.gw.addr = esp_netif_htonl(ip.gateway);
+    err = esp_netif_set_ip_info(netif, &info);
+    if (err == ESP_OK && ip.dns != 0) {
+        esp_netif_dns_info_t dns = {};
+        dns.ip.type = ESP_IPADDR_TYPE_V4;
+        dns.ip.u_addr.ip4.addr = esp_netif_htonl(ip.dns);
+        err = esp_netif_set_dns_info(netif, ESP_NETIF_DNS_MAIN, &dns);
+    }
+    if (err != ESP_OK) {
+        (void)esp_netif_dhcpc_start(netif);  // back to DHCP, not no address
+        return err;
+    }
+    ESP_LOGI(TAG, "STA static IP " IPSTR " mask " IPSTR,
+             IP2STR(&info.ip), IP2STR(&info.netmask));
     return ESP_OK;
 }
 
 bool EspWifiDriver::staConnect(const std::string &ssid,
-                               const std::string &password)
+                               const std::string &password,
+                               WifiConnectTier tier)
 {
     if (!initialized_) {
         ESP_LOGE(TAG, "staConnect before init — ignored");
@@ -215,6 +307,18 @@ bool EspWifiDriver::staConnect(const std::string &ssid,
     wifi_config_t wc = {};
     copyField(wc.sta.ssid, sizeof(wc.sta.ssid), ssid);
     copyField(wc.sta.password, sizeof(wc.sta.password), password);
+    wc.sta.listen_interval = listenInterval_;
+    // Directed connect: the remembered BSSID on its channel, with its auth
+    // mode as the floor. Otherwise the config leaves both unset and
+    // esp_wifi scans every channel for the SSID.
+    const bool directed = tier == WifiConnectTier::Cached && hasCachedAp(ssid);
+    if (directed) {
+        wc.sta.bssid_set = true;
+        std::memcpy(wc.sta.bssid, s_cachedAp.bssid, sizeof wc.sta.bssid);
+        wc.sta.channel = s_cachedAp.channel;
+        wc.sta.threshold.authmode = static_cast<wifi_auth_mode_t>(s_cachedAp.authMode);
+    }
+    staSsid_ = ssid;
     err = esp_wifi_set_config(WIFI_IF_STA, &wc);
     if (err != ESP_OK) {
         // Password value never logged (PR-06 FR-004).
@@ -239,10 +343,75 @@ bool EspWifiDriver::staConnect(const std::string &ssid,
         ESP_LOGE(TAG, "esp_wifi_connect failed: %s", esp_err_to_name(err));
         return false;
     }
-    ESP_LOGI(TAG, "STA connect requested (ssid=%s)", ssid.c_str());
+    if (directed) {
+        ESP_LOGI(TAG, "STA connect requested (ssid=%s, cached AP on channel %u)",
+                 ssid.c_str(), static_cast<unsigned>(s_cachedAp.channel));
+    } else {
+        ESP_LOGI(TAG, "STA connect requested (ssid=%s, full scan)", ssid.c_str());
+    }
+    return true;
+}
+
+bool EspWifiDriver::setPowerSave(WifiPowerSave mode, uint8_t listenInterval)
+{
+    if (!initialized_) {
+        return false;
+    }
+    listenInterval_ = listenInterval;  // in the next staConnect's config
+    wifi_ps_type_t ps = WIFI_PS_MIN_MODEM;
+    switch (mode) {
+        case WifiPowerSave::None:     ps = WIFI_PS_NONE; break;
+        case WifiPowerSave::MinModem: ps = WIFI_PS_MIN_MODEM; break;
+        case WifiPowerSave::MaxModem: ps = WIFI_PS_MAX_MODEM; break;
+    }
+    const esp_err_t err = esp_wifi_set_ps(ps);
+    if (err != ESP_OK) {
+        ESP_LOGW(TAG, "esp_wifi_set_ps(%d) failed: %s", static_cast<int>(ps),
+                 esp_err_to_name(err));
+        return false;
+    }
     return true;
 }
 
+bool EspWifiDriver::hasCachedAp(const std::string &ssid) const
+{
+    return s_haveCachedAp && ssid == s_cachedAp.ssid;
+}
+
+void EspWifiDriver::refreshCachedAp()
+{
+    wifi_ap_record_t ap = {};
+    if (esp_wifi_sta_get_ap_info(&ap) != ESP_OK || ap.primary == 0) {
+        return;
+    }
+    CachedAp fresh = {};
+    copyField(reinterpret_cast<uint8_t *>(fresh.ssid), sizeof fresh.ssid, staSsid_);
+    std::memcpy(fresh.bssid, ap.bssid, sizeof fresh.bssid);
+    fresh.channel = ap.primary;
+    fresh.authMode = static_cast<uint8_t>(ap.authmode);
+    if (s_haveCachedAp && std::memcmp(&fresh, &s_cachedAp, sizeof fresh) == 0) {
+        return;  // same AP as last time: no flash write
+    }
+    s_cachedAp = fresh;
+    s_haveCachedAp = true;
+
+    nvs_handle_t nvs = 0;
+    esp_err_t err = nvs_open(kCacheNamespace, NVS_READWRITE, &nvs);
+    if (err == ESP_OK) {
+        err = nvs_set_blob(nvs, kCacheKey, &fresh, sizeof fresh);
+        if (err == ESP_OK) {
+            err = nvs_commit(nvs);
+        }
+        nvs_close(nvs);
+    }
+    if (err != ESP_OK) {
+        // Still cached in RAM for this boot's reconnects.
+        ESP_LOGW(TAG, "cached AP not saved: %s", esp_err_to_name(err));
+        return;
+    }
+    ESP_LOGI(TAG, "cached AP updated (channel %u)", static_cast<unsigned>(fresh.channel));
+}
+
 void EspWifiDriver::staStop()
 {
     if (!initialized_) {
@@ -261,9 +430,11 @@ bool EspWifiDriver::apStart(const std::string &ssid,
         return false;
     }
 
-    esp_err_t err = esp_wifi_set_mode(WIFI_MODE_AP);
+    // AP+STA: the station interface stays unconfigured (it never joins
+    // anything here) but lets the setup portal scan beside the SoftAP.
+    esp_err_t err = esp_wifi_set_mode(WIFI_MODE_APSTA);
     if (err != ESP_OK) {
-        ESP_LOGE(TAG, "esp_wifi_set_mode(AP) failed: %s",
+        ESP_LOGE(TAG, "esp_wifi_set_mode(APSTA) failed: %s",
                  esp_err_to_name(err));
         return false;
     }
@@ -319,11 +490,59 @@ WifiEvent EspWifiDriver::pollEvent()
     // Non-blocking (timeout 0): return the next queued event or None.
     if (xQueueReceive(static_cast<QueueHandle_t>(eventQueue_), &event, 0) ==
         pdTRUE) {
+        if (event == WifiEvent::GotIp) {
+            refreshCachedAp();  // on the wifi task, never the event loop
+        }
         return event;
     }
     return WifiEvent::None;
 }
 
+bool EspWifiDriver::startScan()
+{
+    if (!initialized_ || !started_) {
+        return false;
+    }
+    wifi_scan_config_t cfg = {};
+    cfg.show_hidden = false;
+    cfg.scan_type = WIFI_SCAN_TYPE_ACTIVE;
+    cfg.scan_time.active.min = kScanDwellMinMs;
+    cfg.scan_time.active.max = kScanDwellMaxMs;
+    s_scanDone.store(false);
+    const esp_err_t err = esp_wifi_scan_start(&cfg, false);
+    if (err != ESP_OK) {
+        ESP_LOGW(TAG, "esp_wifi_scan_start failed: %s", esp_err_to_name(err));
+        return false;
+    }
+    return true;
+}
+
+bool EspWifiDriver::takeScanResults(std::vector<WifiNetwork> &out)
+{
+    if (!s_scanDone.exchange(false)) {
+        return false;
+    }
+    uint16_t count = kMaxScanRecords;
+    // Also frees the radio's own copy of the list; a failed scan reads as
+    // an empty one.
+    if (esp_wifi_scan_get_ap_records(&count, s_scanRecords) != ESP_OK) {
+        count = 0;
+    }
+    out.clear();
+    out.reserve(count);
+    for (uint16_t i = 0; i < count; ++i) {
+        const wifi_ap_record_t &r = s_scanRecords[i];
+        WifiNetwork n;
+        n.ssid.assign(reinterpret_cast<const char *>(r.ssid),
+                      strnlen(reinterpret_cast<const char *>(r.ssid), sizeof(r.ssid)));
+        n.rssi = r.rssi;
+        n.channel = r.primary;
+        n.open = r.authmode == WIFI_AUTH_OPEN;
+        out.push_back(std::move(n));
+    }
+    return true;
+}
+
 int8_t EspWifiDriver::rssi() const
 {
     wifi_ap_record_t ap = {};
@@ -12,12 +12,18 @@
  * post-save restart scheduling. The server handle is the only IDF type that
  * touches this class and is kept opaque in the header (PRIV rule). Credential
  * VALUES are never logged or echoed (FR-004).
+ *
+ * The pages prefer the stored, gzipped setup.html / setup-saved.html and
+ * fall back to the embedded copies below; both list the networks from GET
+ * /scan.json, which never waits on the radio (WifiScanCache).
  */
 
 #include "network/ProvisioningPortal.h"
 
 #include <cctype>
 #include <cstddef>
+#include <cstdint>
+#include <cstring>
 #include <string>
 #include <utility>
 
@@ -27,13 +33,15 @@
 #include "freertos/FreeRTOS.h"
 #include "freertos/task.h"
 
+#include "network/StaticIpSettings.h"
 #include "network/WifiCredentialValidation.h"
 
 namespace {
 
 const char* TAG = "prov_portal";
 
-/// Cap on the accepted POST body: two short fields plus urlencoding overhead.
+/// Cap on the accepted POST body: the credentials and the four optional
+/// dotted quads, plus urlencoding overhead.
 /// Larger bodies are rejected rather than buffered (the fields are bounded by
 /// the SSID/password max lengths, PR-06).
 constexpr std::size_t kMaxFormBodyLen = 512;
@@ -41,10 +49,17 @@ constexpr std::size_t kMaxFormBodyLen = 512;
 /// Priority for the short-lived restart task (just above idle; it only
 /// sleeps then reboots).
 constexpr UBaseType_t kRestartTaskPriority = tskIDLE_PRIORITY + 1;
+constexpr uint32_t kRestartTaskStackBytes = 2048;
 
 // -- Setup / result pages ----------------------------------------------------
 // Small, self-contained (no external assets) to keep the app within the OTA
-// slot budget (research R2). English only.
+// slot budget (research R2). English only. Fallbacks for web/setup.html and
+// web/setup-saved.html (same form fields), served when the storage volume
+// does not hold those.
+
+/// Stored page names, relative to the asset store.
+constexpr const char* kSetupAsset = "setup.html";
+constexpr const char* kSuccessAsset = "setup-saved.html";
 
 const char* kSetupPage =
     "<!DOCTYPE html><html lang=\"en\"><head><meta charset=\"utf-8\">"
@@ -54,11 +69,32 @@ const char* kSetupPage =
     "<p>Enter the credentials of the WiFi network the device should join.</p>"
     "<form method=\"POST\" action=\"/wifi/config\">"
     "<p><label>Network name (SSID)<br>"
-    "<input name=\"ssid\" type=\"text\" maxlength=\"32\" required></label></p>"
+    "<input name=\"ssid\" type=\"text\" maxlength=\"32\" list=\"nets\" "
+    "autocomplete=\"off\" required></label><datalist id=\"nets\"></datalist></p>"
+    "<p><button type=\"button\" onclick=\"scan(1)\">Rescan</button> "
+    "<span id=\"st\"></span></p>"
     "<p><label>Password<br>"
     "<input name=\"password\" type=\"password\" maxlength=\"64\"></label></p>"
+    "<details><summary>Static IP (optional, leave empty for DHCP)</summary>"
+    "<p><label>Address<br><input name=\"ip\" type=\"text\" maxlength=\"15\" "
+    "placeholder=\"192.168.1.20\"></label></p>"
+    "<p><label>Netmask<br><input name=\"netmask\" type=\"text\" maxlength=\"15\" "
+    "placeholder=\"255.255.255.0\"></label></p>"
+    "<p><label>Gateway<br><input name=\"gateway\" type=\"text\" maxlength=\"15\">"
+    "</label></p>"
+    "<p><label>DNS server<br><input name=\"dns\" type=\"text\" maxlength=\"15\">"
+    "</label></p></details>"
     "<p><button type=\"submit\">Save and restart</button></p>"
-    "</form></body></html>";
+    "</form><script>"
+    "function scan(r){fetch('/scan.json'+(r?'?refresh=1':''))"
+    ".then(function(x){return x.json()}).then(function(d){"
+    "var l=document.getElementById('nets');l.textContent='';"
+    "d.networks.forEach(function(n){var o=document.createElement('option');"
+    "o.value=n.ssid;o.label=n.rssi+' dBm'+(n.open?', open':'');l.appendChild(o)});"
+    "document.getElementById('st').textContent="
+    "d.scanning?'Scanning...':d.networks.length+' networks found';"
+    "if(d.scanning)setTimeout(scan,2000)}).catch(function(){})}scan(0);"
+    "</script></body></html>";
 
 const char* kSuccessPage =
     "<!DOCTYPE html><html lang=\"en\"><head><meta charset=\"utf-8\">"
@@ -132,11 +168,19 @@ bool formField(const std::string& body, const std::string& key,
 
 /// Default restart hook: schedule the deferred reboot on a short-lived task so
 /// the HTTP success response is delivered first (esp_restart stays off the
-/// handler's direct call path).
+/// handler's direct call path). The task is static; a second save while
+/// the reboot is pending only finds it scheduled.
 void scheduleDeferredRestart()
 {
-    if (xTaskCreate(restartTask, "prov_restart", 2048, nullptr,
-                    kRestartTaskPriority, nullptr) != pdPASS) {
+    static StackType_t stack[kRestartTaskStackBytes];
+    static StaticTask_t tcb;
+    static TaskHandle_t task = nullptr;
+    if (task != nullptr) {
+        return;
+    }
+    task = xTaskCreateStatic(restartTask, "prov_restart", kRestartTaskStackBytes, nullptr,
+                             kRestartTaskPriority, stack, &tcb);
+    if (task == nullptr) {
         // The task could not be created: fall back to an immediate restart.
         // The credentials are already persisted, so a reboot is still the
         // correct outcome even without the response-delivery delay.
@@ -153,13 +197,71 @@ esp_err_t sendHtml(httpd_req_t* req, const char* status, const char* body)
     return httpd_resp_sendstr(req, body);
 }
 
+/// Does the request's If-None-Match name @p etag?
+bool clientHoldsETag(httpd_req_t* req, const std::string& etag)
+{
+    char value[64];
+    if (httpd_req_get_hdr_value_str(req, "If-None-Match", value, sizeof(value)) != ESP_OK) {
+        return false;  // absent, or longer than any list naming one tag
+    }
+    return std::strstr(value, etag.c_str()) != nullptr;
+}
+
+/// Send page @p asset from the portal's asset store, gzipped with its ETag
+/// (a bodiless 304 when @p revalidate and the client holds it), else the
+/// embedded @p fallback.
+esp_err_t sendPage(httpd_req_t* req, ProvisioningPortal* portal, const char* status,
+                   const char* asset, const char* fallback, bool revalidate)
+{
+    StaticAsset page;
+    IStaticAssets* assets = portal != nullptr ? portal->assets() : nullptr;
+    if (assets == nullptr || !assets->fetch(asset, page)) {
+        return sendHtml(req, status, fallback);
+    }
+    // no-cache: a device reflashed with new pages is revalidated at once.
+    httpd_resp_set_hdr(req, "Cache-Control", "no-cache");
+    if (!page.etag.empty()) {
+        httpd_resp_set_hdr(req, "ETag", page.etag.c_str());
+        if (revalidate && clientHoldsETag(req, page.etag)) {
+            httpd_resp_set_status(req, "304 Not Modified");
+            return httpd_resp_send(req, nullptr, 0);
+        }
+    }
+    httpd_resp_set_status(req, status);
+    httpd_resp_set_type(req, "text/html");
+    httpd_resp_set_hdr(req, "Content-Encoding", "gzip");
+    return httpd_resp_send(req, page.gz->data(), static_cast<ssize_t>(page.gz->size()));
+}
+
 // -- Route handlers (file-local; recover the portal via req->user_ctx) -------
 
 esp_err_t rootGetHandler(httpd_req_t* req)
 {
     // GET / (and, via wildcard matching, any unknown path) serves the setup
     // page (contracts/provisioning-portal.md).
-    return sendHtml(req, "200 OK", kSetupPage);
+    auto* portal = static_cast<ProvisioningPortal*>(req->user_ctx);
+    return sendPage(req, portal, "200 OK", kSetupAsset, kSetupPage, true);
+}
+
+esp_err_t scanGetHandler(httpd_req_t* req)
+{
+    auto* portal = static_cast<ProvisioningPortal*>(req->user_ctx);
+    WifiScanCache* scan = portal != nullptr ? portal->scanCache() : nullptr;
+    if (scan == nullptr) {
+        return sendHtml(req, "404 Not Found", "No network scan on this device.");
+    }
+    // ?refresh=1 only asks; the answer is the cached list either way.
+    char query[32];
+    char refresh[4];
+    if (httpd_req_get_url_query_str(req, query, sizeof(query)) == ESP_OK &&
+        httpd_query_key_value(query, "refresh", refresh, sizeof(refresh)) == ESP_OK &&
+        std::strcmp(refresh, "1") == 0) {
+        scan->requestRefresh();
+    }
+    const std::string body = WifiScanCache::toJson(scan->snapshot());
+    httpd_resp_set_type(req, "application/json");
+    httpd_resp_set_hdr(req, "Cache-Control", "no-store");
+    return httpd_resp_send(req, body.data(), static_cast<ssize_t>(body.size()));
 }
 
 esp_err_t wifiConfigPostHandler(httpd_req_t* req)
@@ -212,7 +314,26 @@ esp_err_t wifiConfigPostHandler(httpd_req_t* req)
                         "8-64 characters.");
     }
 
-    if (!portal->persistCredentials(ssid, password)) {
+    // Optional static IP: an empty (or absent) address keeps DHCP.
+    std::string ip;
+    std::string netmask;
+    std::string gateway;
+    std::string dns;
+    formField(body, "ip", ip);
+    formField(body, "netmask", netmask);
+    formField(body, "gateway", gateway);
+    formField(body, "dns", dns);
+    StaticIpConfig staticIp;
+    if (!parseStaticIp(ip, netmask, gateway, dns, staticIp)) {
+        ESP_LOGW(TAG, "static IP submission rejected");
+        return sendHtml(req, "400 Bad Request",
+                        "Invalid static IP: enter the address and netmask as "
+                        "dotted quads (gateway on the same subnet), or leave "
+                        "the address empty for DHCP.");
+    }
+
+    if (!portal->persistCredentials(ssid, password) ||
+        !portal->persistStaticIp(staticIp)) {
         ESP_LOGE(TAG, "credential persist failed");
         return sendHtml(req, "500 Internal Server Error",
                         "Could not save the credentials. Please try again.");
@@ -220,7 +341,8 @@ esp_err_t wifiConfigPostHandler(httpd_req_t* req)
 
     // Deliver the success page, THEN schedule the deferred restart so the
     // response reaches the browser before the reboot (FR-007).
-    const esp_err_t sendErr = sendHtml(req, "200 OK", kSuccessPage);
+    const esp_err_t sendErr =
+        sendPage(req, portal, "200 OK", kSuccessAsset, kSuccessPage, false);
     portal->scheduleRestart();
     return sendErr;
 }
@@ -246,6 +368,11 @@ bool ProvisioningPortal::persistCredentials(const std::string& ssid,
     return configStore_.setWifiCredentials(ssid, password);
 }
 
+bool ProvisioningPortal::persistStaticIp(const StaticIpConfig& ip)
+{
+    return configStore_.setStaticIp(ip);
+}
+
 void ProvisioningPortal::scheduleRestart()
 {
     if (restartHook_) {
@@ -285,7 +412,21 @@ esp_err_t ProvisioningPortal::start()
         return err;
     }
 
-    // Registered after the specific POST route above; the GET wildcard only
+    // Before the GET wildcard, which would otherwise answer it with the page.
+    const httpd_uri_t getScan = {
+        .uri = "/scan.json",
+        .method = HTTP_GET,
+        .handler = scanGetHandler,
+        .user_ctx = this,
+    };
+    err = httpd_register_uri_handler(server, &getScan);
+    if (err != ESP_OK) {
+        ESP_LOGE(TAG, "register GET /scan.json failed: %s", esp_err_to_name(err));
+        httpd_stop(server);
+        return err;
+    }
+
+    // Registered after the specific routes above; the GET wildcard only
     // matches GET requests, so it never shadows POST /wifi/config.
     const httpd_uri_t getRoot = {
         .uri = "/*",
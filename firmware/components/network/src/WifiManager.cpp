@@ -20,19 +20,35 @@ void WifiManager::begin(WifiBootMode mode)
     disconnectCount_ = 0;
     consecutiveFailures_ = 0;
     rssi_ = 0;
+    cachedTries_ = 0;
 
     if (mode == WifiBootMode::Provisioning) {
         // SoftAP + portal are brought up at the wiring site (T018); here we
         // only record the mode so tick() suspends all STA monitoring.
         state_ = WifiState::Provisioning;
-        return;
+    } else {
+        // Station: issue the first STA attempt (attempt #1) and wait for
+        // events.
+        startConnect();
     }
-
-    // Station: issue the first STA attempt (attempt #1) and wait for events.
-    startConnect();
+    published_.publish(current());
 }
 
 void WifiManager::tick()
+{
+    const WifiState before = state_;
+    advance();
+    published_.publish(current());
+    if (state_ == before) {
+        return;
+    }
+    IWifiStateObserver* observer = observer_.load(std::memory_order_acquire);
+    if (observer != nullptr) {
+        observer->onStateChanged(state_);
+    }
+}
+
+void WifiManager::advance()
 {
     // AP/provisioning mode suspends STA monitoring and reconnect entirely,
     // regardless of elapsed time (contract §6).
@@ -49,6 +65,7 @@ void WifiManager::tick()
     }
 
     const int64_t now = time_.nowMs();
+    applyPowerSave(now);
 
     switch (state_) {
         case WifiState::Reconnecting:
@@ -64,6 +81,7 @@ void WifiManager::tick()
             // After the long pause, begin a fresh round with failures reset.
             if (now >= nextAttemptMs_) {
                 consecutiveFailures_ = 0;
+                cachedTries_ = 0;
                 startConnect();
             }
             break;
@@ -86,10 +104,17 @@ void WifiManager::tick()
     }
 }
 
-WifiConnectionSnapshot WifiManager::snapshot() const
+WifiConnectionSnapshot WifiManager::current() const
 {
-    return WifiConnectionSnapshot{state_, rssi_, consecutiveFailures_,
-                                  disconnectCount_, ipAcquired_};
+    // Value-initialized, so the padding compares equal from tick to tick.
+    WifiConnectionSnapshot s{};
+    s.state = state_;
+    s.rssi = rssi_;
+    s.consecutiveFailures = consecutiveFailures_;
+    s.disconnectCount = disconnectCount_;
+    s.ipAcquired = ipAcquired_;
+    s.powerSave = appliedPowerSave_;
+    return s;
 }
 
 void WifiManager::startConnect()
@@ -97,13 +122,21 @@ void WifiManager::startConnect()
     const std::string ssid = config_.getWifiSsid();
     const std::string password = config_.getWifiPassword();
     state_ = WifiState::Connecting;
+    // Tier: the remembered AP first (one channel probed), a full scan once
+    // this round's directed attempts are spent or nothing is remembered.
+    attemptCached_ = cachedTierLeft(ssid);
+    if (attemptCached_) {
+        ++cachedTries_;
+    }
+    const WifiConnectTier tier =
+        attemptCached_ ? WifiConnectTier::Cached : WifiConnectTier::FullScan;
     // Non-blocking: on success the outcome arrives later as an event. A
     // synchronous config error (staConnect returns false) never yields an
     // event, so route it straight through the failure path — that advances the
     // reconnect cadence (Connecting → Reconnecting → … → ReconnectPaused) and
     // makes the error visible in consecutiveFailures instead of wedging the
     // machine in Connecting forever. It still never reboots (FR-013).
-    if (!driver_.staConnect(ssid, password)) {
+    if (!driver_.staConnect(ssid, password, tier)) {
         handleFailure(time_.nowMs());
     }
 }
@@ -119,6 +152,8 @@ void WifiManager::handleEvent(WifiEvent event)
             state_ = WifiState::Connected;
             consecutiveFailures_ = 0;
             ipAcquired_ = true;
+            cachedTries_ = 0;  // a later drop starts a fresh round
+            attemptCached_ = false;
             rssi_ = driver_.rssi();
             lastMonitorMs_ = now;
             break;
@@ -150,11 +185,21 @@ void WifiManager::handleFailure(int64_t now)
 
     // A drop from an established connection is a diagnostic disconnect;
     // failures that occur while merely (re)connecting are not counted here.
-    if (state_ == WifiState::Connected || ipAcquired_) {
+    const bool dropped = state_ == WifiState::Connected || ipAcquired_;
+    if (dropped) {
         ++disconnectCount_;
         ipAcquired_ = false;
     }
 
+    // Fast tier: a dropped link retries the remembered AP at once, and a
+    // failed directed attempt falls back to the next tier at once. Neither
+    // counts toward the pause; each directed attempt spends cachedTries_, so
+    // this cannot loop.
+    if ((dropped && cachedTierLeft(config_.getWifiSsid())) || attemptCached_) {
+        startConnect();
+        return;
+    }
+
     if (consecutiveFailures_ < UINT8_MAX) {
         ++consecutiveFailures_;
     }
@@ -169,3 +214,30 @@ void WifiManager::handleFailure(int64_t now)
         nextAttemptMs_ = now + static_cast<int64_t>(policy_.retryIntervalMs);
     }
 }
+
+bool WifiManager::cachedTierLeft(const std::string& ssid) const
+{
+    return cachedTries_ < policy_.cachedAttempts && driver_.hasCachedAp(ssid);
+}
+
+void WifiManager::applyPowerSave(int64_t now)
+{
+    // Busy turns power save off at once; it comes back only after the link
+    // has been idle for busyLingerMs.
+    const bool busy = busy_.load(std::memory_order_relaxed);
+    if (busy) {
+        lastBusyMs_ = now;
+        everBusy_ = true;
+    }
+    const bool lingering =
+        everBusy_ && now - lastBusyMs_ < static_cast<int64_t>(powerSave_.busyLingerMs);
+    const WifiPowerSave wanted = busy || lingering ? WifiPowerSave::None : powerSave_.mode;
+    if (powerSaveApplied_ && wanted == appliedPowerSave_) {
+        return;
+    }
+    // A refused mode is tried again next tick.
+    if (driver_.setPowerSave(wanted, powerSave_.listenInterval)) {
+        appliedPowerSave_ = wanted;
+        powerSaveApplied_ = true;
+    }
+}
@@ -0,0 +1,159 @@
+// SPDX-FileCopyrightText: 2026 Cryptotomte
+// SPDX-License-Identifier: AGPL-3.0-or-later
+/**
+ * @file WifiScanCache.cpp
+ * @brief Scan scheduling, result normalisation and the JSON body (see
+ *        WifiScanCache.h).
+ *
+ * The driver is only called from tick(), outside the lock; the lock guards
+ * the cached list and the flags the portal reads or sets.
+ */
+
+#include "network/WifiScanCache.h"
+
+#include <algorithm>
+#include <cstdio>
+#include <mutex>
+#include <utility>
+
+WifiScanCache::WifiScanCache(IWifiDriver& driver, ITimeProvider& clock, uint32_t refreshMs)
+    : driver_(driver), clock_(clock),
+      refreshMs_(refreshMs > kMinRescanMs ? refreshMs : kMinRescanMs)
+{
+}
+
+void WifiScanCache::tick()
+{
+    const int64_t now = clock_.nowMs();
+    bool scanning = false;
+    bool due = false;
+    {
+        std::lock_guard<StaticMutex> lock(mutex_);
+        scanning = scanning_;
+        const int64_t sinceStart = now - startedAtMs_;
+        due = !scanning_ &&
+              (!everStarted_ ||
+               (sinceStart >= kMinRescanMs &&
+                (refreshRequested_ || !valid_ || sinceStart >= refreshMs_)));
+    }
+
+    if (scanning) {
+        std::vector<WifiNetwork> found;
+        if (driver_.takeScanResults(found)) {
+            std::vector<WifiNetwork> sorted = normalize(std::move(found));
+            std::lock_guard<StaticMutex> lock(mutex_);
+            networks_ = std::move(sorted);
+            valid_ = true;
+            scanning_ = false;
+            completedAtMs_ = now;
+        } else if (now - startedAtMs_ >= kScanTimeoutMs) {
+            // Never reported: give up on it and keep the old list. A scan
+            // still running in the radio makes the next start fail, which
+            // is retried like any other.
+            std::lock_guard<StaticMutex> lock(mutex_);
+            scanning_ = false;
+        }
+        return;
+    }
+    if (!due) {
+        return;
+    }
+
+    const bool started = driver_.startScan();
+    std::lock_guard<StaticMutex> lock(mutex_);
+    everStarted_ = true;
+    startedAtMs_ = now;  // a refused start also waits kMinRescanMs
+    if (started) {
+        scanning_ = true;
+        refreshRequested_ = false;
+    }
+}
+
+void WifiScanCache::requestRefresh()
+{
+    std::lock_guard<StaticMutex> lock(mutex_);
+    refreshRequested_ = true;
+}
+
+WifiScanCache::Snapshot WifiScanCache::snapshot() const
+{
+    const int64_t now = clock_.nowMs();
+    std::lock_guard<StaticMutex> lock(mutex_);
+    Snapshot snap;
+    snap.networks = networks_;
+    snap.scanning = scanning_ || refreshRequested_ || !everStarted_;
+    snap.valid = valid_;
+    snap.ageMs = valid_ ? static_cast<uint32_t>(now - completedAtMs_) : 0;
+    return snap;
+}
+
+std::vector<WifiNetwork> WifiScanCache::normalize(std::vector<WifiNetwork> raw)
+{
+    // Strongest first, so the first of each SSID is the one to keep.
+    std::stable_sort(raw.begin(), raw.end(), [](const WifiNetwork& a, const WifiNetwork& b) {
+        return a.rssi > b.rssi;
+    });
+    std::vector<WifiNetwork> out;
+    for (WifiNetwork& n : raw) {
+        if (out.size() == kMaxNetworks) {
+            break;
+        }
+        if (n.ssid.empty()) {
+            continue;
+        }
+        const bool seen = std::any_of(out.begin(), out.end(), [&n](const WifiNetwork& kept) {
+            return kept.ssid == n.ssid;
+        });
+        if (!seen) {
+            out.push_back(std::move(n));
+        }
+    }
+    return out;
+}
+
+namespace {
+
+void appendJsonString(std::string& out, const std::string& value)
+{
+    out += '"';
+    for (const char c : value) {
+        const auto b = static_cast<unsigned char>(c);
+        if (c == '"' || c == '\\') {
+            out += '\\';
+            out += c;
+        } else if (b < 0x20) {
+            char esc[8];
+            std::snprintf(esc, sizeof esc, "\\u%04x", b);
+            out += esc;
+        } else {
+            out += c;
+        }
+    }
+    out += '"';
+}
+
+}  // namespace
+
+std::string WifiScanCache::toJson(const Snapshot& snapshot)
+{
+    std::string out = "{\"scanning\":";
+    out += snapshot.scanning ? "true" : "false";
+    out += ",\"ageS\":";
+    out += snapshot.valid ? std::to_string(snapshot.ageMs / 1000) : "-1";
+    out += ",\"networks\":[";
+    for (std::size_t i = 0; i < snapshot.networks.size(); ++i) {
+        const WifiNetwork& n = snapshot.networks[i];
+        if (i != 0) {
+            out += ',';
+        }
+        out += "{\"ssid\":";
+        appendJsonString(out, n.ssid);
+        out += ",\"rssi\":" + std::to_string(n.rssi);
+        out += ",\"channel\":" + std::to_string(n.channel);
+        out += ",\"open\":";
+        out += n.open ? "true" : "false";
+        out += '}';
+    }
+    out += "]}";
+    return out;
+}
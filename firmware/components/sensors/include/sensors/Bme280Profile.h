@@ -0,0 +1,118 @@
+// SPDX-FileCopyrightText: 2026 Cryptotomte
+// SPDX-License-Identifier: AGPL-3.0-or-later
+/**
+ * @file Bme280Profile.h
+ * @brief BME280 sampling profiles: mode, per-channel oversampling, IIR
+ * filter and standby, with their register bytes and measurement time
+ * (header-only).
+ *
+ * Field encodings follow the Bosch datasheet register tables (ctrl_hum
+ * 0xF2, ctrl_meas 0xF4, config 0xF5); the measurement time is the
+ * datasheet's maximum ("Measurement time", appendix B), so a caller that
+ * waits this long after a forced-mode trigger reads a completed
+ * conversion.
+ */
+
+#ifndef WATERINGSYSTEM_SENSORS_BME280PROFILE_H
+#define WATERINGSYSTEM_SENSORS_BME280PROFILE_H
+
+#include <cstdint>
+
+/// Power mode (ctrl_meas mode[1:0]). Sleep is only used while reprogramming.
+enum class Bme280Mode : uint8_t {
+    Sleep = 0b00,
+    Forced = 0b01,  ///< one conversion per trigger, then back to sleep
+    Normal = 0b11,  ///< continuous conversions, one per standby period
+};
+
+/// Oversampling of one channel (osrs_x); Skip disables the channel.
+enum class Bme280Oversampling : uint8_t { Skip = 0, X1, X2, X4, X8, X16 };
+
+/// IIR filter coefficient (config filter[4:2]); applies to T and P.
+enum class Bme280Filter : uint8_t { Off = 0, X2, X4, X8, X16 };
+
+/// NORMAL-mode standby between conversions (config t_sb[7:5]).
+enum class Bme280Standby : uint8_t {
+    Ms0_5 = 0, Ms62_5, Ms125, Ms250, Ms500, Ms1000, Ms10, Ms20,
+};
+
+/**
+ * @brief One complete sampling configuration.
+ */
+struct Bme280Profile {
+    Bme280Mode mode;
+    Bme280Oversampling temperature;
+    Bme280Oversampling pressure;
+    Bme280Oversampling humidity;
+    Bme280Filter filter;
+    Bme280Standby standby;
+
+    /// ctrl_hum (0xF2): osrs_h[2:0].
+    constexpr uint8_t ctrlHum() const { return static_cast<uint8_t>(humidity); }
+
+    /// ctrl_meas (0xF4) in @p m: osrs_t[7:5], osrs_p[4:2], mode[1:0].
+    constexpr uint8_t ctrlMeas(Bme280Mode m) const
+    {
+        return static_cast<uint8_t>(static_cast<uint8_t>(temperature) << 5 |
+                                    static_cast<uint8_t>(pressure) << 2 |
+                                    static_cast<uint8_t>(m));
+    }
+
+    /// ctrl_meas (0xF4) in this profile's mode.
+    constexpr uint8_t ctrlMeas() const { return ctrlMeas(mode); }
+
+    /// config (0xF5): t_sb[7:5], filter[4:2], spi3w_en[0] = 0.
+    constexpr uint8_t config() const
+    {
+        return static_cast<uint8_t>(static_cast<uint8_t>(standby) << 5 |
+                                    static_cast<uint8_t>(filter) << 2);
+    }
+
+    /// Samples one channel averages (0 when skipped).
+    static constexpr uint32_t samples(Bme280Oversampling os)
+    {
+        return os == Bme280Oversampling::Skip
+                   ? 0
+                   : 1u << (static_cast<uint8_t>(os) - 1);
+    }
+
+    /**
+     * @brief Maximum time of one conversion in µs: 1.25 ms + 2.3 ms per
+     * temperature sample + (2.3 ms per sample + 0.575 ms) for pressure and
+     * humidity when enabled.
+     */
+    constexpr uint32_t measurementTimeUs() const
+    {
+        const uint32_t p = samples(pressure);
+        const uint32_t h = samples(humidity);
+        return 1250 + 2300 * samples(temperature) +
+               (p == 0 ? 0 : 2300 * p + 575) + (h == 0 ? 0 : 2300 * h + 575);
+    }
+};
+
+namespace bme280_profiles {
+
+/// Legacy parity (docs/parity-checklist.md §5): NORMAL, T×2 / P×16 / H×1,
+/// IIR ×16, standby 500 ms — ctrl_hum 0x01, ctrl_meas 0x57, config 0x90.
+constexpr Bme280Profile kParity{
+    Bme280Mode::Normal,      Bme280Oversampling::X2, Bme280Oversampling::X16,
+    Bme280Oversampling::X1,  Bme280Filter::X16,      Bme280Standby::Ms500,
+};
+
+/// Datasheet "weather monitoring": one forced conversion per poll, ×1
+/// everywhere, no filter. The chip sleeps between polls (~µA).
+constexpr Bme280Profile kForcedLowPower{
+    Bme280Mode::Forced,      Bme280Oversampling::X1, Bme280Oversampling::X1,
+    Bme280Oversampling::X1,  Bme280Filter::Off,      Bme280Standby::Ms0_5,
+};
+
+/// Fast humidity tracking: NORMAL at 125 ms standby, ×1 everywhere and no
+/// filter, so a step in humidity shows within one conversion (~8 ms).
+constexpr Bme280Profile kBurst{
+    Bme280Mode::Normal,      Bme280Oversampling::X1, Bme280Oversampling::X1,
+    Bme280Oversampling::X1,  Bme280Filter::Off,      Bme280Standby::Ms125,
+};
+
+}  // namespace bme280_profiles
+
+#endif /* WATERINGSYSTEM_SENSORS_BME280PROFILE_H */
@@ -33,13 +33,22 @@
 
 #include "interfaces/IEnvironmentalSensor.h"
 #include "interfaces/II2cBus.h"
+#include "sensors/Bme280Profile.h"
+
+/// Which Bosch datasheet compensation routines read() runs
+/// (CONFIG_WS_BME280_COMPENSATION).
+enum class Bme280Compensation : uint8_t {
+    Integer,  ///< int32/int64 routines: exact vectors, no FPU needed (default)
+    Double,   ///< double-precision routines: finer P/H, soft-float on ESP32
+};
 
 /**
  * @brief IEnvironmentalSensor over the BME280 I2C register map.
  *
  * One read() = one 8-byte burst transaction (0xF7–0xFE), compensated
- * T → P → H via t_fine (Bosch int32/int64 reference algorithms) and
- * converted to °C/%RH/hPa atomically: on any failure the last-good getter
+ * T → P → H via t_fine (Bosch int32/int64 reference algorithms, or the
+ * datasheet double-precision ones by choice) and converted to °C/%RH/hPa
+ * atomically: on any failure the last-good getter
  * values remain untouched and getLastError() carries the cause (0/1/2,
  * data-model.md).
  */
@@ -84,14 +93,55 @@ public:
         int8_t digH6;
     };
 
+    /**
+     * @brief Coefficients of the double-precision routines, derived once
+     * from a Calibration when it is read.
+     *
+     * Every datasheet divisor that only involves trimming parameters is
+     * folded in here, so a conversion is multiplies and adds plus the one
+     * data-dependent division of the pressure formula.
+     */
+    struct DoubleTrim {
+        double t1;   ///< dig_T1 / 8192
+        double t2;   ///< dig_T2 / 16384
+        double t12;  ///< dig_T1 / 1024 · dig_T2
+        double t3;   ///< dig_T3
+        double p1;   ///< dig_P1
+        double p1s;  ///< dig_P1 / 32768
+        double p2;   ///< dig_P2 / 2^19
+        double p3;   ///< dig_P3 / 2^38
+        double p4;   ///< dig_P4 · 65536
+        double p5;   ///< dig_P5 / 2
+        double p6;   ///< dig_P6 / 2^17
+        double p7;   ///< dig_P7 / 16
+        double p8;   ///< dig_P8 / 2^19
+        double p9;   ///< dig_P9 / 2^35
+        double h1;   ///< dig_H1 / 2^19
+        double h2;   ///< dig_H2 / 65536
+        double h3;   ///< dig_H3 / 2^26
+        double h4;   ///< dig_H4 · 64
+        double h5;   ///< dig_H5 / 16384
+        double h6;   ///< dig_H6 / 2^26
+    };
+
+    /// One compensated reading in the getters' units.
+    struct Reading {
+        float temperature;  ///< °C
+        float humidity;     ///< %RH
+        float pressure;     ///< hPa
+    };
+
     /**
      * @brief Construct the sensor over an injected I2C bus.
      *
-     * @param bus I2C master used for every transaction; must outlive this
-     *            object (same injection style as ModbusSoilSensor's
-     *            IModbusClient).
+     * @param bus          I2C master used for every transaction; must
+     *                     outlive this object (same injection style as
+     *                     ModbusSoilSensor's IModbusClient).
+     * @param compensation Arithmetic read() compensates with.
      */
-    explicit Bme280Sensor(II2cBus& bus);
+    explicit Bme280Sensor(
+        II2cBus& bus,
+        Bme280Compensation compensation = Bme280Compensation::Integer);
 
     ~Bme280Sensor() override = default;
 
@@ -107,6 +157,36 @@ public:
     float getTemperature() override;
     float getHumidity() override;
     float getPressure() override;
+    EnvSnapshot snapshot() override;
+
+    /**
+     * @brief Trigger a forced-mode conversion; no-op in NORMAL mode.
+     *
+     * Initializes lazily like read(). Returns the profile's maximum
+     * measurement time in µs — read() after that much time returns the new
+     * conversion — or 0 in NORMAL mode or on failure (a failed trigger
+     * write is a bus loss: error 2, back to uninitialized).
+     */
+    uint32_t startMeasurement() override;
+
+    /// Enter (true) or leave the burst profile; see setProfile() on when it
+    /// reaches the device.
+    bool setBurst(bool burst) override;
+
+    /**
+     * @brief Set the profile used outside burst (default: kParity).
+     *
+     * Takes effect at once on an initialized device (false = the write
+     * failed: error 2, back to uninitialized), otherwise at the next
+     * initialization.
+     */
+    bool setProfile(const Bme280Profile& profile);
+
+    /// Set the profile used in burst (default: kBurst); as setProfile().
+    bool setBurstProfile(const Bme280Profile& profile);
+
+    /// The profile setBurst() and setProfile() last put in effect.
+    Bme280Profile profile() const { return activeProfile(); }
 
     // Bosch BME280 datasheet reference compensation (section "Compensation
     // formulas", 32/64-bit integer implementations) — transcribed exactly;
@@ -139,6 +219,22 @@ public:
     static uint32_t compensateHumidity(int32_t adcH, const Calibration& cal,
                                        int32_t tFine);
 
+    /// The integer routines chained T → P → H and scaled to °C/%RH/hPa.
+    static Reading compensateInteger(int32_t adcT, int32_t adcP, int32_t adcH,
+                                     const Calibration& cal);
+
+    /// Fold @p cal into the double-precision routines' coefficients.
+    static DoubleTrim deriveDoubleTrim(const Calibration& cal);
+
+    /**
+     * @brief The datasheet's double-precision routines (BME280_compensate_
+     * T/P/H_double) over pre-derived coefficients, T → P → H via the same
+     * integer t_fine. Pressure is 0 when the calibration would divide by
+     * zero, as in the integer path.
+     */
+    static Reading compensateDouble(int32_t adcT, int32_t adcP, int32_t adcH,
+                                    const DoubleTrim& trim);
+
 private:
     // Register map (used subset, data-model.md).
     static constexpr uint8_t kRegChipId = 0xD0;
@@ -152,23 +248,26 @@ private:
     static constexpr uint8_t kRegData = 0xF7;  ///< press/temp/hum burst start
     static constexpr size_t kDataLen = 8;      ///< 0xF7–0xFE
 
-    // Parity sampling profile (legacy src/sensors/BME280Sensor.cpp:41-46,
-    // docs/parity-checklist.md §5; byte encodings verified against the
-    // Bosch datasheet register tables — field breakdowns at the write site
-    // in Bme280Sensor.cpp).
-    static constexpr uint8_t kCtrlHumValue = 0x01;   ///< osrs_h ×1
-    static constexpr uint8_t kCtrlMeasValue = 0x57;  ///< T×2, P×16, NORMAL
-    static constexpr uint8_t kConfigValue = 0x90;    ///< 500 ms, IIR ×16
-
     /// Probe 0x76 → 0x77 and verify the chip identity; sets address_.
     bool probeAndIdentify();
 
     /// Burst-read and parse both calibration blocks into cal_.
     bool readCalibration();
 
-    /// Write the parity sampling profile (ctrl_hum → ctrl_meas → config).
+    /// Write the active profile (ctrl_hum → ctrl_meas → config).
     bool writeSamplingProfile();
 
+    /// Switch a running device to the active profile: sleep first, so the
+    /// config write is not ignored, then ctrl_hum → config → ctrl_meas.
+    /// A failure drops back to uninitialized (error 2).
+    bool reprogramSamplingProfile();
+
+    /// The profile in effect: the burst one while burst is on.
+    const Bme280Profile& activeProfile() const
+    {
+        return burst_ ? burstProfile_ : profile_;
+    }
+
     II2cBus& bus_;
     uint8_t address_ = 0;  ///< resolved device address (valid when initialized_)
     bool initialized_ = false;
@@ -176,7 +275,12 @@ private:
     /// poll); repeats are demoted to debug. Reset on successful init.
     bool initFailureLogged_ = false;
     int lastError_ = 0;
+    Bme280Compensation compensation_;
+    Bme280Profile profile_ = bme280_profiles::kParity;
+    Bme280Profile burstProfile_ = bme280_profiles::kBurst;
+    bool burst_ = false;
     Calibration cal_{};
+    DoubleTrim trim_{};  ///< derived with cal_ (Double compensation)
 
     // Last-good reading (published only by a fully successful read()).
     // NaN until the first successful read — self-announcing for consumers
@@ -185,6 +289,7 @@ private:
     float temperature_ = std::numeric_limits<float>::quiet_NaN();
     float humidity_ = std::numeric_limits<float>::quiet_NaN();
     float pressure_ = std::numeric_limits<float>::quiet_NaN();
+    uint32_t sequence_ = 0;  ///< successful read() calls
 };
 
 #endif /* WATERINGSYSTEM_SENSORS_BME280SENSOR_H */
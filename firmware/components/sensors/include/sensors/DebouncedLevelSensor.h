@@ -27,6 +27,7 @@
 #include <cstdint>
 
 #include "interfaces/IDigitalInput.h"
+#include "interfaces/ILevelObserver.h"
 #include "interfaces/ILevelSensor.h"
 #include "interfaces/ITimeProvider.h"
 
@@ -58,6 +59,12 @@
  * samples the owner takes — with a starved poll cadence a window can
  * complete from just two samples spanning it, not a continuously observed
  * hold.
+ *
+ * Edge-capturing inputs (IDigitalInput::nextEdge(), GpioLevelSensor's
+ * interrupt mode): update() first replays the queued edges at their
+ * recorded times, then samples read() as before. Windows then open at the
+ * edge, not at the next poll, and a hold between two edges is observed,
+ * not sampled — the reported state still only changes inside update().
  */
 class DebouncedLevelSensor : public ILevelSensor {
 public:
@@ -111,9 +118,22 @@ public:
      */
     void markFaulted();
 
+    /**
+     * @brief Call @p observer from update() whenever isWaterPresent()
+     * changes (nullptr = none).
+     *
+     * A wiring-site hook like markFaulted(), not part of ILevelSensor: set
+     * it before the sensor is shared between tasks. Only update() notifies
+     * — notifyPowerOn() and markFaulted() invalidate silently.
+     */
+    void setObserver(ILevelObserver* observer) { observer_ = observer; }
+
 private:
     enum class State { Settling, Warmup, Tracking, Faulted };
 
+    /// One step of the state machine: the raw level is @p raw at @p now.
+    void sample(bool raw, int64_t now);
+
     /// Sentinel: the settle window has not started yet (armed, waiting for
     /// the first update()).
     static constexpr int64_t kNotStarted = -1;
@@ -123,10 +143,12 @@ private:
     const bool activeLow_;
     const int64_t debounceMs_;
     const int64_t settleMs_;
+    ILevelObserver* observer_ = nullptr;
 
     State state_ = State::Settling;
     int64_t settleStartMs_ = kNotStarted;  ///< first update() after arming
     bool raw_ = false;           ///< last sampled pin level (rawState())
+    int64_t lastSampleMs_ = 0;   ///< time of raw_
     bool candidateRaw_ = false;  ///< value the stability window is timing
     int64_t windowStartMs_ = 0;  ///< when candidateRaw_ last changed
     bool stableRaw_ = false;     ///< debounced pin level (valid iff TRACKING)
@@ -0,0 +1,170 @@
+// SPDX-FileCopyrightText: 2026 Cryptotomte
+// SPDX-License-Identifier: AGPL-3.0-or-later
+/**
+ * @file EnergyMeter.h
+ * @brief INA226 power integrated into energy (Wh): per pump run, per day
+ *        and in total, in a block that survives resets.
+ *
+ * WHY THIS EXISTS: /api/v1/power shows the power of one conversion, so
+ * "what did that run cost" or "how much today" meant a client polling the
+ * endpoint and summing — at the poll's rate, not the chip's, and only
+ * while the client was there. The sampling task (main/power_task.cpp)
+ * hands every conversion-ready result here instead, and the totals are on
+ * the device.
+ *
+ * INTEGRATION: trapezoidal, between consecutive results (one per INA226
+ * conversion period, 35.2 ms by default), in double. An interval longer
+ * than kMaxGapUs, or one across a failed read (gap()), is not integrated —
+ * bridging a sensor outage with a straight line would invent energy — and
+ * its length is counted as uncoveredMs instead.
+ *
+ * RUNS: an interval with the pump running at either end belongs to the
+ * run, so the switch-on and run-down edges are in it. The first sample
+ * with the pump stopped closes the run: it becomes lastRun and
+ * addSample() reports kRunClosed.
+ *
+ * DAYS: UTC days of the wall clock, as in control/PumpUsage.h. Energy
+ * measured before the clock is set goes to the day the clock then shows
+ * (a boot is short of a day); a sample in another day than the open one
+ * closes it into the previous day and reports kDayClosed.
+ *
+ * PERSISTENCE: seal() writes everything into a CRC-checked EnergyBlock;
+ * the power task seals into RTC_NOINIT memory (two alternating blocks, as
+ * main/lifetime_counters does) once a second and at every close, so a
+ * software, panic, watchdog or brownout reset loses at most a second. A
+ * run open in the restored block was cut by the reset (the pump output
+ * drops with it) and is closed at once. What outlives a power cycle is the
+ * history: the task logs each closed run and day to IDataStorage, whose
+ * rollups then give energy per hour, day and beyond.
+ *
+ * THREADS: restore(), addSample(), gap() and seal() are the power task's;
+ * load() is for any task and never blocks it. No allocation.
+ */
+
+#ifndef WATERINGSYSTEM_SENSORS_ENERGYMETER_H
+#define WATERINGSYSTEM_SENSORS_ENERGYMETER_H
+
+#include <cstdint>
+#include <initializer_list>
+#include <type_traits>
+
+#include "interfaces/IWallClock.h"
+#include "sensors/PublishedSnapshot.h"
+
+/// The meter as load() copies it out.
+struct EnergyTotals {
+    uint32_t samples = 0;       ///< results integrated since boot
+    double totalWh = 0.0;       ///< since the RTC blocks were last lost
+    double dayWh = 0.0;         ///< the open day
+    uint32_t dayStart = 0;      ///< its first second (UTC); 0 = clock never set
+    double previousDayWh = 0.0;
+    uint32_t previousDayStart = 0;  ///< 0 = no day closed yet
+    bool runActive = false;
+    double runWh = 0.0;         ///< the open run so far
+    uint32_t runMs = 0;
+    uint32_t runStart = 0;      ///< epoch; 0 = clock not set at its start
+    double lastRunWh = 0.0;
+    uint32_t lastRunMs = 0;
+    uint32_t lastRunStart = 0;  ///< epoch; 0 = untimed
+    uint32_t runs = 0;          ///< runs closed
+    uint64_t uncoveredMs = 0;   ///< time not integrated (gaps, failed reads)
+};
+
+/// The persisted form: fixed layout, checked by magic, version and CRC-32.
+/// Trivial, so it can sit in RTC_NOINIT memory; value-initialize it ({})
+/// elsewhere.
+struct EnergyBlock {
+    static constexpr uint32_t kMagic = 0x4E455357u;  ///< "WSEN"
+    static constexpr uint16_t kVersion = 1;
+    static constexpr uint16_t kRunActive = 1u << 0;  ///< flags bit
+
+    uint32_t magic;
+    uint16_t version;
+    uint16_t flags;
+    uint32_t sequence;   ///< bumped by every seal()
+    uint32_t dayStart;
+    uint32_t previousDayStart;
+    uint32_t runStart;
+    uint32_t runMs;
+    uint32_t lastRunStart;
+    uint32_t lastRunMs;
+    uint32_t runs;
+    double totalWh;
+    double dayWh;
+    double previousDayWh;
+    double runWh;
+    double lastRunWh;
+    uint64_t uncoveredMs;
+    uint32_t crc;        ///< CRC-32 of everything above
+    uint32_t pad;
+};
+static_assert(std::is_trivial<EnergyBlock>::value,
+              "RTC_NOINIT memory is never constructed");
+
+class EnergyMeter {
+public:
+    /// Longest interval integrated: two default conversion periods are
+    /// 70 ms, a failed read's back-off a second.
+    static constexpr int64_t kMaxGapUs = 2000000;
+
+    /// addSample() results, or-ed.
+    static constexpr uint32_t kRunClosed = 1u << 0;  ///< lastRunWh is new
+    static constexpr uint32_t kDayClosed = 1u << 1;  ///< previousDayWh is new
+
+    EnergyMeter() : published_(EnergyTotals{}) {}
+
+    EnergyMeter(const EnergyMeter&) = delete;
+    EnergyMeter& operator=(const EnergyMeter&) = delete;
+
+    /// True when @p block is intact and of this layout.
+    static bool valid(const EnergyBlock& block);
+
+    /**
+     * @brief Take the totals from the valid candidate with the highest
+     * sequence (null candidates are skipped); all zero when none is valid.
+     * A run open in it is closed, and the next addSample() reports it.
+     * @return the candidate used, or nullptr
+     */
+    const EnergyBlock* restore(std::initializer_list<const EnergyBlock*> candidates);
+
+    /**
+     * @brief Integrate up to one conversion result.
+     * @param watts       its power; non-finite counts as gap()
+     * @param atUs        when it was read, monotonic (esp_timer)
+     * @param pumpRunning the measured pump's state at @p atUs
+     * @param now         the wall clock at @p atUs
+     * @return kRunClosed / kDayClosed for what this sample closed
+     */
+    uint32_t addSample(float watts, int64_t atUs, bool pumpRunning, WallTime now);
+
+    /// A read failed: the next sample starts a new series.
+    void gap() { havePrevious_ = false; }
+
+    /// Write the state into @p out (sequence bumped, CRC set). The open
+    /// run's runMs is as of the last sample.
+    void seal(EnergyBlock& out);
+
+    /// Sequence of the newest seal() (or of the restored block).
+    uint32_t sealSequence() const { return sealSequence_; }
+
+    /// The totals as of the last addSample() or restore().
+    EnergyTotals load() const { return published_.load(); }
+
+private:
+    static uint32_t crcOf(const EnergyBlock& block);
+
+    /// Move the open run into lastRun.
+    void closeRun();
+
+    EnergyTotals totals_;
+    PublishedSnapshot<EnergyTotals> published_;
+    uint32_t sealSequence_ = 0;
+    uint32_t pending_ = 0;  ///< closes restore() found, reported next
+    bool havePrevious_ = false;
+    bool previousRunning_ = false;
+    float previousWatts_ = 0.0f;
+    int64_t previousUs_ = 0;
+    int64_t runStartUs_ = 0;
+};
+
+#endif /* WATERINGSYSTEM_SENSORS_ENERGYMETER_H */
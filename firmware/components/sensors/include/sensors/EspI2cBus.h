@@ -15,8 +15,9 @@
  * is never included (FR-002, research.md R2).
  *
  * Bus sharing (FR-003): app_main constructs ONE EspI2cBus (function-local
- * static) and passes it to every I2C driver — PR-05's INA226 receives the
- * same instance. No second bus creation on these pins is permitted. Pins
+ * static) and puts an I2cBusMaster in front of it; every I2C driver
+ * receives that master's port — PR-05's INA226 shares it with the BME280.
+ * No second bus creation on these pins is permitted. Pins
  * come from board/board.h inside the .cpp (BOARD_PIN_I2C_SDA/SCL).
  *
  * Concurrency: transaction-level safety across tasks comes from the
@@ -35,13 +36,15 @@
 #include <mutex>
 
 #include "interfaces/II2cBus.h"
+#include "interfaces/StaticMutex.h"
 
 /**
- * @brief I2C master on the board's SDA/SCL pins (100 kHz standard mode).
+ * @brief I2C master on the board's SDA/SCL pins (100 kHz standard mode
+ * unless setClockSpeed() changes it).
  *
  * The bus handle is created lazily on first use (no work in the
  * constructor — no error path there); per-address device handles are
- * created on first use at 100 kHz (FR-002) and cached. All transactions
+ * created on first use at the current clock (100 kHz, FR-002) and cached. All transactions
  * use finite timeouts; failures are returned as false and logged —
  * transaction failures at debug level (expected NACKs) or warning level
  * (timeouts/unexpected errors); one-time infrastructure failures at error
@@ -49,9 +52,12 @@
  */
 class EspI2cBus : public II2cBus {
 public:
-    /// Standard-mode clock per device (FR-002).
+    /// Standard-mode clock per device (FR-002), the default.
     static constexpr uint32_t kSclSpeedHz = 100000;
 
+    /// Fastest clock setClockSpeed() accepts (fast mode).
+    static constexpr uint32_t kMaxSclSpeedHz = 400000;
+
     /// Finite per-transaction timeout — no infinite waits on a wedged bus.
     static constexpr int kTimeoutMs = 100;
 
@@ -71,6 +77,10 @@ public:
     bool writeRegister16(uint8_t address7, uint8_t reg,
                          uint16_t value) override;
 
+    /// Drops the cached device handles; each is re-created at @p hz on its
+    /// next use (the clock is per handle in i2c_master).
+    bool setClockSpeed(uint32_t hz) override;
+
 private:
     /// Enough for BME280 (one of two addresses) + PR-05's INA226 devices.
     static constexpr size_t kMaxDevices = 8;
@@ -92,9 +102,10 @@ private:
     /// Guards busHandle_/devices_/deviceCount_ (lazy creation from
     /// multiple tasks). Transactions run outside this lock — the
     /// i2c_master driver's bus lock covers them.
-    std::mutex mutex_;
+    StaticMutex mutex_;
 
     void* busHandle_ = nullptr;  ///< opaque i2c_master_bus_handle_t
+    uint32_t sclSpeedHz_ = kSclSpeedHz;  ///< for handles created from now on
     Device devices_[kMaxDevices] = {};
     size_t deviceCount_ = 0;
 };
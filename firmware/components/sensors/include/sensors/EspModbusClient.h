@@ -23,6 +23,19 @@
  * `soil`); a second consumer task would need a locking wrapper. PR-11's
  * main-loop reader adds exactly that second task — `rs485test`'s raw access
  * must be routed through a locked client wrapper (or the sensor) then.
+ * (Since then ModbusBusMaster is that wrapper and the only caller.)
+ *
+ * ADAPTIVE TIMEOUT: each request is timed and fed to a ModbusRttTracker,
+ * and each request runs with the timeout the tracker derives for its slave
+ * (hundreds of ms for a healthy probe, the configured 3000 ms as the
+ * fallback). esp-modbus 2.1.2 reads response_tout_ms only when the master
+ * is created, so changing the timeout means deleting and re-creating the
+ * master stack (applyTimeout()). Timeouts are rounded up to
+ * kTimeoutStepMs so small RTT drift does not trigger a re-create; only a
+ * real change, such as a fallback request, does.
+ *
+ * LINE RATE: kBaudRate (parity) until setBaudRate(); a change re-creates
+ * the stack the same way and drops the round-trip history.
  */
 
 #ifndef WATERINGSYSTEM_SENSORS_ESPMODBUSCLIENT_H
@@ -31,15 +44,22 @@
 #include <cstdint>
 
 #include "interfaces/IModbusClient.h"
+#include "sensors/ModbusRttTracker.h"
 
 /**
- * @brief Modbus RTU master on the board's RS485 UART (9600 8N1, parity).
+ * @brief Modbus RTU master on the board's RS485 UART (9600 8N1 by default).
  */
 class EspModbusClient : public IModbusClient {
 public:
     /// Parity response timeout (docs/parity-checklist.md §5).
     static constexpr uint32_t kDefaultTimeoutMs = 3000;
 
+    /// Boot line rate (8N1, parity: legacy Serial2).
+    static constexpr uint32_t kBaudRate = 9600;
+
+    /// Granularity of the applied response timeout.
+    static constexpr uint32_t kTimeoutStepMs = 50;
+
     EspModbusClient() = default;
 
     /// Tears down the esp-modbus master stack (mbc_master_delete).
@@ -63,22 +83,37 @@ public:
     bool writeSingleRegister(uint8_t deviceAddress, uint16_t registerAddress,
                              uint16_t value) override;
 
+    bool writeMultipleRegisters(uint8_t deviceAddress, uint16_t startRegister,
+                                uint16_t count, const uint16_t* values) override;
+
     int getLastError() override;
 
     /**
-     * @brief Set the response timeout for subsequent transfers.
+     * @brief Set the configured response timeout: the fallback the adaptive
+     * timeout returns to, and its upper bound.
      *
-     * esp-modbus 2.1.2 exposes no documented runtime timeout setter, so the
-     * value is applied at initialize() time only (research.md R5, risk
-     * documented): calls after initialize() are stored but take effect only
-     * on a future re-initialization. No caller changes the timeout at
-     * runtime today.
+     * esp-modbus 2.1.2 exposes no runtime timeout setter (research.md R5).
+     * The value is therefore applied with the request that next needs it,
+     * by re-creating the master stack (applyTimeout()).
      */
     void setTimeout(uint32_t timeoutMs) override;
 
     void getStatistics(uint32_t* successCount, uint32_t* errorCount) override;
 
+    /// Re-creates the master stack at @p baud; a failure restores the
+    /// previous rate.
+    bool setBaudRate(uint32_t baud) override;
+
+    uint32_t baudRate() override { return baud_; }
+
 private:
+    /// create → pins → start → RS485 mode → RX pull-up with @p timeoutMs;
+    /// tears everything down again on failure.
+    bool startStack(uint32_t timeoutMs);
+
+    /// Re-create the stack if @p timeoutMs differs from the applied one.
+    bool applyTimeout(uint32_t timeoutMs);
+
     /// One bus transaction via mbc_master_send_request + bookkeeping.
     bool sendRequest(uint8_t deviceAddress, uint8_t command,
                      uint16_t registerAddress, uint16_t count, void* data);
@@ -86,7 +121,10 @@ private:
     void* mbHandle_ = nullptr;  ///< opaque esp-modbus master handle
     bool initialized_ = false;
     int lastError_ = 0;
-    uint32_t timeoutMs_ = kDefaultTimeoutMs;
+    uint32_t timeoutMs_ = kDefaultTimeoutMs;   ///< configured (fallback)
+    uint32_t appliedTimeoutMs_ = 0;            ///< what the stack runs with
+    uint32_t baud_ = kBaudRate;
+    ModbusRttTracker rtt_{kDefaultTimeoutMs};
     uint32_t successCount_ = 0;
     uint32_t errorCount_ = 0;
 };
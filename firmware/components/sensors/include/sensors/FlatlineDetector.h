@@ -0,0 +1,107 @@
+// SPDX-FileCopyrightText: 2026 Cryptotomte
+// SPDX-License-Identifier: AGPL-3.0-or-later
+/**
+ * @file FlatlineDetector.h
+ * @brief Online stuck-sensor detector for one metric (header-only).
+ *
+ * A probe whose firmware or electrode has frozen keeps answering with the
+ * same in-range value: it passes every range check and the sample filter,
+ * and a moisture reading frozen above the low threshold keeps a bed dry
+ * for as long as nobody looks. Two signals, both O(1) per sample:
+ *
+ *   run      — identical readings in a row (the value compares equal);
+ *   variance — exponentially weighted mean and variance, updated
+ *              Welford-style (West's incremental form), so a probe that
+ *              only dithers by a bit now and then is flat too.
+ *
+ * The metric is flat once either signal has held for minFlatMs — a run of
+ * at least minRunSamples identical readings, or a standard deviation
+ * below minStdDev since then (after minRunSamples readings of warm-up).
+ * Any reading that breaks both clears it at once. Feed only good
+ * readings: a failed read says nothing about the value.
+ *
+ * Fixed-size state, no allocation, no locking (owned by one task).
+ */
+
+#ifndef WATERINGSYSTEM_SENSORS_FLATLINEDETECTOR_H
+#define WATERINGSYSTEM_SENSORS_FLATLINEDETECTOR_H
+
+#include <cmath>
+#include <cstdint>
+
+/// When a metric counts as flat; minFlatMs 0 turns the detector off.
+struct FlatlineSettings {
+    int64_t minFlatMs = 10 * 60 * 1000;  ///< how long either signal must hold
+    uint32_t minRunSamples = 60;         ///< and over at least this many reads
+    float minStdDev = 0.0f;              ///< EW std-dev floor; 0 = run only
+    float alpha = 0.05f;                 ///< EW weight of a new reading
+};
+
+class FlatlineDetector {
+public:
+    explicit FlatlineDetector(const FlatlineSettings& settings = {}) : settings_(settings) {}
+
+    /// Forget every reading (a probe replaced or recalibrated).
+    void reset()
+    {
+        count_ = 0;
+        run_ = 0;
+        flat_ = false;
+    }
+
+    /// Feed one good reading taken at @p atMs; returns flat().
+    bool sample(float value, int64_t atMs)
+    {
+        if (settings_.minFlatMs <= 0 || !std::isfinite(value)) {
+            return flat_;
+        }
+        if (count_ == 0) {
+            mean_ = value;
+            variance_ = 0.0f;
+        } else {
+            const float delta = value - mean_;
+            mean_ += settings_.alpha * delta;
+            variance_ = (1.0f - settings_.alpha) * (variance_ + settings_.alpha * delta * delta);
+        }
+        ++count_;
+
+        if (run_ != 0 && value == last_) {
+            ++run_;
+        } else {
+            run_ = 1;
+            runStartMs_ = atMs;
+        }
+        last_ = value;
+
+        const bool quiet = settings_.minStdDev > 0.0f && count_ > settings_.minRunSamples &&
+                           variance_ < settings_.minStdDev * settings_.minStdDev;
+        if (!quiet) {
+            quietSinceMs_ = atMs;
+        }
+        const bool stuck =
+            run_ >= settings_.minRunSamples && atMs - runStartMs_ >= settings_.minFlatMs;
+        flat_ = stuck || (quiet && atMs - quietSinceMs_ >= settings_.minFlatMs);
+        return flat_;
+    }
+
+    bool flat() const { return flat_; }
+
+    /// Identical readings in a row, the newest included.
+    uint32_t run() const { return run_; }
+
+    /// Exponentially weighted standard deviation of the readings.
+    float stdDev() const { return std::sqrt(variance_); }
+
+private:
+    FlatlineSettings settings_;
+    uint32_t count_ = 0;
+    float mean_ = 0.0f;
+    float variance_ = 0.0f;
+    float last_ = 0.0f;
+    uint32_t run_ = 0;
+    int64_t runStartMs_ = 0;
+    int64_t quietSinceMs_ = 0;
+    bool flat_ = false;
+};
+
+#endif /* WATERINGSYSTEM_SENSORS_FLATLINEDETECTOR_H */
@@ -0,0 +1,67 @@
+// SPDX-FileCopyrightText: 2026 Cryptotomte
+// SPDX-License-Identifier: AGPL-3.0-or-later
+/**
+ * @file FlowMeter.h
+ * @brief Volume and flow rate of a pulse-output flow meter (pure C++).
+ *
+ * WHY THIS EXISTS: a timed run delivers whatever the head and the filter
+ * let through that day. A Hall-effect flow meter on the pump line gives
+ * one pulse per fixed volume (a YF-S201 ~450 per litre); counted in
+ * hardware (PcntPulseCounter, the ESP32 PCNT unit — no interrupt per
+ * pulse) they become the delivered volume the pump doses by
+ * (WaterPump::setFlowMeter(), runForVolume()).
+ *
+ * deliveredMl() converts the live count on every call, so the pump's 10 Hz
+ * update() sees the volume as of that poll; it is exact until the count
+ * wraps at 2^32 pulses (~9500 m3 at 450 pulses/L). The flow rate needs a
+ * time base: update(), from the owner's loop, closes a kRateWindowMs window
+ * and publishes the volume of it as ml/min (an atomic, read from any task).
+ *
+ * Host-tested against a scripted IPulseCounter.
+ */
+
+#ifndef WATERINGSYSTEM_SENSORS_FLOWMETER_H
+#define WATERINGSYSTEM_SENSORS_FLOWMETER_H
+
+#include <atomic>
+#include <cstdint>
+
+#include "interfaces/IFlowMeter.h"
+#include "interfaces/IPulseCounter.h"
+
+class FlowMeter final : public IFlowMeter {
+public:
+    /// Rate window: ~7 pulses at 0.5 L/min on a 450 pulses/L meter.
+    static constexpr int64_t kRateWindowMs = 1000;
+
+    /**
+     * @param counter        The meter's pulse count; must outlive this object.
+     * @param pulsesPerLitre The meter's K factor (0 is taken as 1).
+     */
+    FlowMeter(IPulseCounter& counter, uint32_t pulsesPerLitre);
+
+    FlowMeter(const FlowMeter&) = delete;
+    FlowMeter& operator=(const FlowMeter&) = delete;
+
+    /// Close the rate window once kRateWindowMs have passed. Owner task only.
+    void update(int64_t nowMs);
+
+    uint32_t deliveredMl() override;
+
+    float flowMlPerMin() override { return rate_.load(std::memory_order_relaxed); }
+
+    /// The raw count (diagnostics).
+    uint32_t pulses() { return counter_.pulses(); }
+
+    uint32_t pulsesPerLitre() const { return pulsesPerLitre_; }
+
+private:
+    IPulseCounter& counter_;
+    const uint32_t pulsesPerLitre_;
+    bool started_ = false;
+    int64_t windowStartMs_ = 0;
+    uint32_t windowPulses_ = 0;
+    std::atomic<float> rate_{0.0f};
+};
+
+#endif /* WATERINGSYSTEM_SENSORS_FLOWMETER_H */
@@ -0,0 +1,55 @@
+// SPDX-FileCopyrightText: 2026 Cryptotomte
+// SPDX-License-Identifier: AGPL-3.0-or-later
+/**
+ * @file GpioInputBank.h
+ * @brief Several GPIO inputs sampled by reading the input register once.
+ *
+ * ESP32-ONLY: excluded from the linux-target build (see this component's
+ * CMakeLists.txt). The IDigitalInputBank behind LevelSensorBank: instead of
+ * one gpio_get_level() per mark, readAll() loads the GPIO input register
+ * and picks every channel's bit out of that one value, so the marks are
+ * sampled at the same instant. Pins on both sides of GPIO 31 cost a second
+ * register load (GPIO_IN1); both level pins of both boards (32, 33) are in
+ * GPIO_IN1, so theirs is a single read.
+ *
+ * No configuration here: each pin keeps its GpioLevelSensor for
+ * initialize() (input + pull-up) and, optionally, edge capture.
+ *
+ * PRIV rule (this component's convention): the soc register headers
+ * appear only in the .cpp — the pins are held as plain ints.
+ */
+
+#ifndef WATERINGSYSTEM_SENSORS_GPIOINPUTBANK_H
+#define WATERINGSYSTEM_SENSORS_GPIOINPUTBANK_H
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <initializer_list>
+
+#include "interfaces/IDigitalInputBank.h"
+
+/**
+ * @brief IDigitalInputBank over up to kMaxChannels GPIO pins; channel i is
+ * the i-th pin passed in.
+ */
+class GpioInputBank final : public IDigitalInputBank {
+public:
+    static constexpr std::size_t kMaxChannels = 8;
+
+    /// Pins beyond kMaxChannels are ignored. No hardware access.
+    GpioInputBank(std::initializer_list<int> pins);
+
+    GpioInputBank(const GpioInputBank&) = delete;
+    GpioInputBank& operator=(const GpioInputBank&) = delete;
+
+    /// One load per input register holding a channel, then bit picking.
+    uint32_t readAll() override;
+
+private:
+    std::array<uint8_t, kMaxChannels> pins_{};
+    std::size_t count_ = 0;
+    uint64_t mask_ = 0;  ///< the pins, as GPIO-number bits
+};
+
+#endif /* WATERINGSYSTEM_SENSORS_GPIOINPUTBANK_H */
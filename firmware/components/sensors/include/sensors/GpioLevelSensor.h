@@ -10,6 +10,10 @@
  * DebouncedLevelSensor (research.md R1, same split as EspI2cBus /
  * EspModbusClient).
  *
+ * Optionally interrupt-driven (enableEdgeCapture()): the pin's edges are
+ * queued with their times for DebouncedLevelSensor, which then debounces
+ * on when the level changed rather than on its owner's poll ticks.
+ *
  * PRIV rule (this component's convention): driver/gpio.h appears only in
  * the .cpp, never here — the pin is held as a plain int.
  */
@@ -17,6 +21,9 @@
 #ifndef WATERINGSYSTEM_SENSORS_GPIOLEVELSENSOR_H
 #define WATERINGSYSTEM_SENSORS_GPIOLEVELSENSOR_H
 
+#include <atomic>
+#include <cstdint>
+
 #include "interfaces/IDigitalInput.h"
 
 /**
@@ -55,12 +62,50 @@ public:
      */
     bool initialize();
 
+    /**
+     * @brief Record every edge of the pin from its interrupt (after a
+     * successful initialize()).
+     *
+     * The any-edge ISR stores the esp_timer time (ms, the EspTimeProvider
+     * clock) and the level after the edge into a kEdgeQueueDepth ring that
+     * nextEdge() drains; a full ring drops the edge and counts it. read()
+     * keeps working unchanged.
+     *
+     * @return false (logged) leaves the input polled.
+     */
+    bool enableEdgeCapture();
+
+    /// Edges lost on a full queue since boot.
+    uint32_t droppedEdges() const
+    {
+        return droppedEdges_.load(std::memory_order_relaxed);
+    }
+
     // IDigitalInput
     /// Raw pin level (true = HIGH). One gpio_get_level(), no logic.
     bool read() override;
 
+    /// Oldest queued edge (edge capture only).
+    bool nextEdge(DigitalEdge& edge) override;
+
+    /// Edge ring depth: a float switch bouncing for a few ms, several
+    /// times between two 100 ms updates.
+    static constexpr uint32_t kEdgeQueueDepth = 32;
+
 private:
+    static_assert((kEdgeQueueDepth & (kEdgeQueueDepth - 1)) == 0,
+                  "kEdgeQueueDepth must be a power of two");
+
+    /// The any-edge ISR (IRAM). Single producer; nextEdge() the single
+    /// consumer — the SpscRing index scheme, written out in the ISR so all
+    /// of it is in IRAM.
+    static void onEdge(void* arg);
+
     int pin_;
+    DigitalEdge edges_[kEdgeQueueDepth];
+    std::atomic<uint32_t> edgeHead_{0};  ///< written by the ISR
+    std::atomic<uint32_t> edgeTail_{0};  ///< written by nextEdge()
+    std::atomic<uint32_t> droppedEdges_{0};
 };
 
 #endif /* WATERINGSYSTEM_SENSORS_GPIOLEVELSENSOR_H */
@@ -0,0 +1,227 @@
+// SPDX-FileCopyrightText: 2026 Cryptotomte
+// SPDX-License-Identifier: AGPL-3.0-or-later
+/**
+ * @file I2cBusMaster.h
+ * @brief I2C bus owner: transaction queue in front of an II2cBus, with
+ *        per-device bus time and a fast-mode probe.
+ *
+ * WHY THIS EXISTS: on rev2 the BME280 (sensor task, console) and the
+ * INA226 (console, API, a high-rate capture) share one EspI2cBus, and the
+ * only coordination was the i2c_master driver's per-transaction lock: no
+ * order, and no way to tell whether one device's traffic crowds out the
+ * other's. Here, as on RS485 (ModbusBusMaster.h), every transaction is a
+ * caller-owned I2cTransaction queued in arrival order and run by a single
+ * bus task (main/i2c_task.cpp, looping on serve()).
+ *
+ * COMPLETION: submit() queues and returns; the bus task fills the result
+ * fields, calls onDone (on the bus task), then sets done. execute() is
+ * submit() plus a wait. The queue is intrusive, so it never allocates and
+ * never overflows; a submitted transaction must stay alive and untouched
+ * until it is done.
+ *
+ * BATCHING: serve() takes everything queued at once and runs it back to
+ * back under one hold of the bus mutex — a BME280 burst read and an INA226
+ * register read queued together go out in one pass of the task, with no
+ * wake-up in between.
+ *
+ * PORT: port() is an II2cBus whose calls execute(), so Bme280Sensor and
+ * Ina226Sensor keep their interface.
+ *
+ * BEFORE THE TASK RUNS (boot init, or a task that failed to start) a
+ * transaction runs on the calling task under the bus mutex; the first
+ * serve() switches to the queue.
+ *
+ * TIMING: each transaction records how long it queued (queueUs) apart
+ * from how long it held the bus (busUs); deviceStats() sums both per
+ * device address. A device whose queue wait grows while another's bus time
+ * does is being starved by it.
+ *
+ * USAGE RULE: once wrapped, the bus must ONLY be reached through this
+ * object.
+ *
+ * Pure C++ (std::mutex/condition_variable), host-tested; only the task is
+ * target code.
+ */
+
+#ifndef WATERINGSYSTEM_SENSORS_I2CBUSMASTER_H
+#define WATERINGSYSTEM_SENSORS_I2CBUSMASTER_H
+
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <mutex>
+#include <vector>
+
+#include "interfaces/II2cBus.h"
+#include "interfaces/PowerLocks.h"
+
+/**
+ * @brief One bus transaction and, once done, its result.
+ *
+ * Fill the request fields, then I2cBusMaster::submit() or execute().
+ */
+struct I2cTransaction {
+    enum class Op : uint8_t { Probe, Read, Write, Write16 };
+
+    // -- Request --------------------------------------------------------
+    Op op = Op::Read;
+    uint8_t address = 0;       ///< 7-bit device address
+    uint8_t reg = 0;           ///< start register / register written
+    uint8_t* buffer = nullptr; ///< Read: at least len bytes
+    std::size_t len = 0;       ///< Read: bytes to read
+    uint16_t value = 0;        ///< Write: low byte; Write16: the word
+    /// Called on the bus task once the result is in (may be empty).
+    void (*onDone)(I2cTransaction&, void* context) = nullptr;
+    void* context = nullptr;
+
+    // -- Result (valid once done) ----------------------------------------
+    bool ok = false;
+    int64_t queueUs = 0;  ///< submit() to the start of the transfer
+    int64_t busUs = 0;    ///< the transfer itself
+    std::atomic<bool> done{false};
+
+    // -- Queue link (I2cBusMaster only) -----------------------------------
+    I2cTransaction* next = nullptr;
+    int64_t submittedUs = 0;
+};
+
+/// Transactions addressed to one device since boot.
+struct I2cDeviceStats {
+    uint8_t address = 0;
+    uint32_t transactions = 0;
+    uint32_t errors = 0;
+    uint64_t queueUsTotal = 0;
+    uint32_t queueUsMax = 0;
+    uint64_t busUsTotal = 0;
+    uint32_t busUsMax = 0;
+};
+
+/**
+ * @brief A register that identifies a device, read to validate a clock
+ * speed: @p len (1 or 2) bytes at @p reg must read @p expected (2 bytes
+ * big-endian).
+ */
+struct I2cIdentityCheck {
+    uint8_t address;
+    uint8_t reg;
+    uint8_t len;
+    uint16_t expected;
+};
+
+class I2cBusMaster {
+public:
+    /// I2C standard and fast mode.
+    static constexpr uint32_t kStandardModeHz = 100000;
+    static constexpr uint32_t kFastModeHz = 400000;
+
+    /// Devices deviceStats() tracks; later addresses count as untracked.
+    static constexpr std::size_t kMaxDevices = 8;
+
+    /// Wrap @p bus (must outlive this object). @p clock is a microsecond
+    /// monotonic clock for the timings; without one they read 0.
+    explicit I2cBusMaster(II2cBus& bus, std::function<int64_t()> clock = nullptr);
+
+    I2cBusMaster(const I2cBusMaster&) = delete;
+    I2cBusMaster& operator=(const I2cBusMaster&) = delete;
+
+    /// Hold @p lock (ApbMax: bus clock up, no light sleep) across each
+    /// transfer; null for none. Boot wiring, before the bus task starts.
+    void setPowerLock(IPowerLock* lock) { powerLock_ = lock; }
+
+    /// Queue @p txn; it completes on the bus task. Before the task serves,
+    /// it runs here instead and is done on return.
+    void submit(I2cTransaction& txn);
+
+    /// submit() and wait until @p txn is done; returns its ok.
+    bool execute(I2cTransaction& txn);
+
+    /**
+     * @brief Bus task body: wait up to @p timeoutMs for a transaction, then
+     * run every one queued, back to back.
+     * @return the number served (0 = the wait timed out)
+     */
+    std::size_t serve(uint32_t timeoutMs);
+
+    /**
+     * @brief Switch to fast mode if every device still identifies there.
+     *
+     * Runs @p checks at the current speed, switches the bus to 400 kHz and
+     * runs them again; any check that passed before and fails now (or a
+     * bus that cannot switch) puts the bus back to 100 kHz. With no check
+     * passing at the current speed there is nothing to validate and the
+     * bus stays where it is. Absent devices therefore never block fast
+     * mode, and a device that drops out at 400 kHz always forces the
+     * fallback. Serialized with the queue; meant for boot.
+     *
+     * @return the clock speed in effect afterwards
+     */
+    uint32_t negotiateFastMode(const I2cIdentityCheck* checks, std::size_t count);
+
+    /// Clock speed in effect (kStandardModeHz until negotiated).
+    uint32_t clockSpeedHz() const { return clockHz_.load(); }
+
+    /// The II2cBus view whose transactions run through this queue.
+    II2cBus& port() { return port_; }
+
+    /// Transactions queued right now.
+    std::size_t depth() const;
+
+    /// serve() passes that ran at least one transaction.
+    uint32_t batches() const;
+
+    /// Time the bus has spent in transfers since boot, all devices.
+    uint64_t busTimeUs() const;
+
+    /// Per device address, in order of first use.
+    std::vector<I2cDeviceStats> deviceStats() const;
+
+    /// Transactions left out of deviceStats() (its table was full).
+    uint32_t untrackedTransactions() const;
+
+private:
+    class Port final : public II2cBus {
+    public:
+        explicit Port(I2cBusMaster& bus) : bus_(bus) {}
+
+        bool probe(uint8_t address7) override;
+        bool readRegisters(uint8_t address7, uint8_t startReg, uint8_t* buf,
+                           size_t len) override;
+        bool writeRegister(uint8_t address7, uint8_t reg, uint8_t value) override;
+        bool writeRegister16(uint8_t address7, uint8_t reg,
+                             uint16_t value) override;
+
+    private:
+        I2cBusMaster& bus_;
+    };
+
+    int64_t now() const { return clock_ ? clock_() : 0; }
+
+    /// Run @p txn on the bus; the caller holds busMutex_.
+    void transfer(I2cTransaction& txn);
+
+    /// Which of @p checks pass at the current speed; the caller holds
+    /// busMutex_.
+    std::vector<bool> runChecks(const I2cIdentityCheck* checks, std::size_t count);
+
+    II2cBus& bus_;
+    std::function<int64_t()> clock_;
+    IPowerLock* powerLock_ = nullptr;
+    Port port_;
+    std::mutex busMutex_;                ///< held across a transfer or batch
+    mutable std::mutex queueMutex_;      ///< guards the queue and stats (short)
+    std::condition_variable queued_;     ///< the bus task waits here
+    std::condition_variable completed_;  ///< execute() waits here
+    I2cTransaction* head_ = nullptr;
+    I2cTransaction* tail_ = nullptr;
+    std::size_t depth_ = 0;
+    uint32_t batches_ = 0;
+    I2cDeviceStats devices_[kMaxDevices];
+    std::size_t deviceCount_ = 0;
+    uint32_t untracked_ = 0;
+    std::atomic<uint32_t> clockHz_{kStandardModeHz};
+    std::atomic<bool> serving_{false};   ///< a bus task has called serve()
+};
+
+#endif /* WATERINGSYSTEM_SENSORS_I2CBUSMASTER_H */
@@ -0,0 +1,88 @@
+// SPDX-FileCopyrightText: 2026 Cryptotomte
+// SPDX-License-Identifier: AGPL-3.0-or-later
+/**
+ * @file Ina226Sampling.h
+ * @brief INA226 averaging and conversion times, with their configuration
+ * register value and result period (header-only).
+ *
+ * Field encodings follow TI SBOS547, Configuration Register (00h). The
+ * mode is always continuous shunt + bus: the conversion-ready flag and the
+ * reader task both assume a new result every period().
+ */
+
+#ifndef WATERINGSYSTEM_SENSORS_INA226SAMPLING_H
+#define WATERINGSYSTEM_SENSORS_INA226SAMPLING_H
+
+#include <cstdint>
+
+/// Samples averaged per result (AVG[11:9]).
+enum class Ina226Averaging : uint8_t {
+    X1 = 0, X4, X16, X64, X128, X256, X512, X1024,
+};
+
+/// Conversion time of one bus or shunt sample (VBUSCT[8:6], VSHCT[5:3]).
+enum class Ina226ConversionTime : uint8_t {
+    Us140 = 0, Us204, Us332, Us588, Us1100, Us2116, Us4156, Us8244,
+};
+
+/**
+ * @brief One averaging / conversion-time setting.
+ */
+struct Ina226Sampling {
+    Ina226Averaging averaging;
+    Ina226ConversionTime busConversion;
+    Ina226ConversionTime shuntConversion;
+
+    /// Configuration register: reserved bit 14 as at POR, the three
+    /// fields, MODE = 111 (shunt and bus, continuous).
+    constexpr uint16_t configValue() const
+    {
+        return static_cast<uint16_t>(0x4000 |
+                                     static_cast<uint16_t>(averaging) << 9 |
+                                     static_cast<uint16_t>(busConversion) << 6 |
+                                     static_cast<uint16_t>(shuntConversion) << 3 |
+                                     0b111);
+    }
+
+    /// Samples one result averages.
+    static constexpr uint32_t samples(Ina226Averaging a)
+    {
+        constexpr uint16_t kSamples[] = {1, 4, 16, 64, 128, 256, 512, 1024};
+        return kSamples[static_cast<uint8_t>(a)];
+    }
+
+    /// Nominal conversion time in µs.
+    static constexpr uint32_t conversionUs(Ina226ConversionTime t)
+    {
+        constexpr uint16_t kUs[] = {140, 204, 332, 588, 1100, 2116, 4156, 8244};
+        return kUs[static_cast<uint8_t>(t)];
+    }
+
+    /// Time between two results in µs: every averaged sample converts the
+    /// shunt and then the bus voltage.
+    constexpr uint32_t periodUs() const
+    {
+        return samples(averaging) *
+               (conversionUs(busConversion) + conversionUs(shuntConversion));
+    }
+};
+
+namespace ina226_sampling {
+
+/// The feature 006 setting: AVG ×16, 1.1 ms conversions — config 0x4527,
+/// one result every 35.2 ms.
+constexpr Ina226Sampling kDefault{
+    Ina226Averaging::X16, Ina226ConversionTime::Us1100,
+    Ina226ConversionTime::Us1100,
+};
+
+/// Pump current capture (PumpCurrentCapture.h): AVG ×4 of the shortest
+/// conversions — config 0x4207, one result every 1.12 ms (~890 Hz).
+constexpr Ina226Sampling kCapture{
+    Ina226Averaging::X4, Ina226ConversionTime::Us140,
+    Ina226ConversionTime::Us140,
+};
+
+}  // namespace ina226_sampling
+
+#endif /* WATERINGSYSTEM_SENSORS_INA226SAMPLING_H */
@@ -34,12 +34,14 @@
 
 #include "interfaces/II2cBus.h"
 #include "interfaces/IPowerSensor.h"
+#include "sensors/Ina226Sampling.h"
 
 /**
  * @brief IPowerSensor over the INA226 register map.
  *
  * One read() = one snapshot: bus voltage, power and current registers are
- * fetched together (the device converts continuously — MODE 0b111) and
+ * fetched together (the device converts continuously — MODE 0b111, at the
+ * setSampling() averaging and conversion times) and
  * published atomically w.r.t. this object: on any failure the last-good
  * getter values remain untouched and getLastError() carries the cause
  * (0/1/2, data-model.md).
@@ -87,6 +89,32 @@ public:
             10240u / (shuntMilliOhm == 0 ? 1u : shuntMilliOhm));
     }
 
+    /// Shunt-voltage resolution, fixed by the device: 2.5 µV/LSB (SBOS547,
+    /// Shunt Voltage Register). The Alert Limit register compares at it.
+    static constexpr float kShuntVoltageLsbV = 0.0000025f;
+
+    /**
+     * @brief Alert Limit register value for a shunt over-voltage (SOL) trip
+     * at @p amps.
+     *
+     * LIMIT = I × R_shunt / 2.5 µV = A × R_mΩ × 400
+     *
+     * = 16000 for 8 A on the default 5 mΩ. Rounded to the nearest LSB and
+     * clamped to 1..0x7FFF (the register is compared as a signed shunt
+     * voltage; ≈16.4 A is the full scale at 5 mΩ). @p amps <= 0 gives 0,
+     * "no limit".
+     */
+    static constexpr uint16_t alertLimitFor(float amps, uint32_t shuntMilliOhm)
+    {
+        if (!(amps > 0.0f)) {
+            return 0;
+        }
+        const float raw = amps * static_cast<float>(shuntMilliOhm) * 400.0f + 0.5f;
+        return raw >= 32767.0f ? 0x7FFF
+               : raw < 1.0f    ? 1
+                               : static_cast<uint16_t>(raw);
+    }
+
     /**
      * @brief Construct the sensor over an injected I2C bus.
      *
@@ -115,36 +143,117 @@ public:
     float getBusVoltage() override;
     float getCurrent() override;
     float getPower() override;
+    PowerSnapshot snapshot() override;
+
+    /// sampling().periodUs().
+    uint32_t conversionPeriodUs() override;
+
+    /**
+     * @brief Set CNVR in Mask/Enable, so ALERT (open drain, active low)
+     * asserts at every completed result until conversionReady() reads the
+     * register. Written at once when initialized (false = the write failed:
+     * error 2, back to uninitialized) and again by every initialization.
+     */
+    bool setConversionReadyAlert(bool enable) override;
+
+    /**
+     * @brief Read Mask/Enable and consume its conversion-ready flag (CVRF),
+     * which also releases ALERT.
+     *
+     * True when CVRF was set, and when the driver is uninitialized or the
+     * read failed (then back to uninitialized, error untouched) — the
+     * following read() owns re-probing and error reporting.
+     */
+    bool conversionReady() override;
+
+    /**
+     * @brief Compare every averaged shunt voltage against
+     * alertLimitFor(@p amps) (SOL in Mask/Enable), so ALERT follows an
+     * over-current: asserted while a result is above the limit, released
+     * by the first one below (transparent, not latched). Takes the place
+     * of the conversion-ready alert while set. Written at once when
+     * initialized (false = the write failed: error 2, back to
+     * uninitialized) and again by every initialization.
+     */
+    bool setOverCurrentLimit(float amps) override;
+
+    /// The Alert Limit value in effect; 0 = no over-current alert.
+    uint16_t overCurrentLimitRaw() const { return alertLimit_; }
+
+    /**
+     * @brief Switch between ina226_sampling::kCapture (true) and the
+     * setSampling() choice it replaced (false); written like setSampling().
+     */
+    bool setHighRateSampling(bool enable) override;
+
+    /**
+     * @brief One Current-register read (0x04), scaled like read()'s.
+     *
+     * The last-good triple and the sequence stay as they are. Lazy init,
+     * error 2 and the drop to uninitialized as in read().
+     */
+    bool readCurrent(float& amps) override;
+
+    /**
+     * @brief Set averaging and conversion times (default:
+     * ina226_sampling::kDefault).
+     *
+     * Takes effect at once on an initialized device (false = the write
+     * failed: error 2, back to uninitialized), otherwise at the next
+     * initialization. The write restarts the conversion in progress.
+     */
+    bool setSampling(const Ina226Sampling& sampling);
+
+    /// The averaging and conversion times in effect.
+    Ina226Sampling sampling() const { return sampling_; }
 
 private:
-    // Register map (used subset, data-model.md). 0x01 (shunt voltage) and
-    // 0x06/0x07 (Mask/Enable, Alert) are unused — the ALERT pin is not
-    // connected on rev2.
+    // Register map (used subset, data-model.md). 0x01 (shunt voltage) is
+    // unused; Mask/Enable signals conversion ready
+    // (setConversionReadyAlert()) or a shunt over-voltage against 0x07
+    // (setOverCurrentLimit()).
     static constexpr uint8_t kRegConfig = 0x00;
     static constexpr uint8_t kRegBusVoltage = 0x02;
     static constexpr uint8_t kRegPower = 0x03;
     static constexpr uint8_t kRegCurrent = 0x04;
     static constexpr uint8_t kRegCalibration = 0x05;
+    static constexpr uint8_t kRegMaskEnable = 0x06;
+    static constexpr uint8_t kRegAlertLimit = 0x07;
     static constexpr uint8_t kRegManufacturerId = 0xFE;
     static constexpr uint8_t kRegDieId = 0xFF;
 
-    /// Configuration register value: AVG ×16, VBUSCT = VSHCT = 1.1 ms,
-    /// MODE = continuous shunt + bus. Bit-field derivation at the top of
-    /// Ina226Sensor.cpp; asserted byte-exact by host tests.
-    static constexpr uint16_t kConfigValue = 0x4527;
+    /// Mask/Enable bits: SOL routes a shunt over-voltage and CNVR
+    /// conversion ready to ALERT (only one at a time — the chip honours
+    /// the most significant); CVRF is the conversion-ready flag itself
+    /// (cleared by reading the register).
+    static constexpr uint16_t kMaskSol = 0x8000;
+    static constexpr uint16_t kMaskCnvr = 0x0400;
+    static constexpr uint16_t kMaskCvrf = 0x0008;
 
     /// Probe the address and verify manufacturer + die ID.
     bool probeAndIdentify();
 
+    /// Mask/Enable for the alerts requested: SOL over CNVR, or none.
+    uint16_t maskValue() const
+    {
+        return alertLimit_ != 0 ? kMaskSol : readyAlert_ ? kMaskCnvr : 0;
+    }
+
     II2cBus& bus_;
     const uint8_t address_;
     const uint16_t calibration_;  ///< calibrationFor(shunt) from the ctor
+    const uint32_t shuntMilliOhm_;
     bool initialized_ = false;
     /// WARN once per consecutive not-found run (lazy re-init retries on
     /// every consumer attempt); repeats are demoted to debug. Reset on
     /// successful init. Same policy as Bme280Sensor.
     bool initFailureLogged_ = false;
     int lastError_ = 0;
+    Ina226Sampling sampling_ = ina226_sampling::kDefault;
+    bool readyAlert_ = false;  ///< CNVR, re-written by every initialization
+    uint16_t alertLimit_ = 0;  ///< SOL limit, re-written likewise; 0 = off
+    bool highRate_ = false;
+    Ina226Sampling normalSampling_ = ina226_sampling::kDefault;  ///< while highRate_
 
     // Last-good reading (published only by a fully successful read()).
     // NaN until the first successful read — self-announcing for consumers
@@ -153,6 +262,7 @@ private:
     float busVoltage_ = std::numeric_limits<float>::quiet_NaN();
     float current_ = std::numeric_limits<float>::quiet_NaN();
     float power_ = std::numeric_limits<float>::quiet_NaN();
+    uint32_t sequence_ = 0;  ///< successful read() calls
 };
 
 #endif /* WATERINGSYSTEM_SENSORS_INA226SENSOR_H */
@@ -0,0 +1,194 @@
+// SPDX-FileCopyrightText: 2026 Cryptotomte
+// SPDX-License-Identifier: AGPL-3.0-or-later
+/**
+ * @file LevelSensorBank.h
+ * @brief The reservoir level marks sampled, debounced and published as one.
+ *
+ * WHY THIS EXISTS: with one LockedLevelSensor per mark the 10 Hz loop
+ * updated the low mark and then the high mark — two pin reads, two locks,
+ * two clock reads — and a reader between the two saw one mark already
+ * advanced and the other not yet: for a poll, "high wet while low dry", a
+ * combination no real water level produces. The bank instead
+ *   - reads every mark's pin in ONE IDigitalInputBank::readAll() (one GPIO
+ *     input-register read on target, GpioInputBank),
+ *   - runs every mark's DebouncedLevelSensor in one pass, under one lock,
+ *     at one sample time,
+ *   - publishes the outcome as ONE atomic word, which every reader — the
+ *     per-mark Mark views, the loop's state() — loads without a lock.
+ * A dry/wet combination that still shows up is then the sensors' own (a
+ * stuck float), not an artefact of when they were read.
+ *
+ * POLICY UNCHANGED: each mark is still a DebouncedLevelSensor (settle,
+ * warm-up, debounce, polarity, latched fault, edge replay), fed from the
+ * shared sample through a per-mark IDigitalInput channel. A mark with an
+ * edge source (GpioLevelSensor in interrupt mode) replays its edges as
+ * before; an edge newer than the sample waits for the next update(), so
+ * the replay never contradicts the level just read.
+ *
+ * Concurrency: update() belongs to the owner task (the 10 Hz loop); every
+ * other call may come from any task. The Mark views are final, so the
+ * static-dispatch reservoir wiring calls them directly. Pure C++,
+ * host-tested.
+ */
+
+#ifndef WATERINGSYSTEM_SENSORS_LEVELSENSORBANK_H
+#define WATERINGSYSTEM_SENSORS_LEVELSENSORBANK_H
+
+#include <array>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+
+#include "interfaces/IDigitalInput.h"
+#include "interfaces/IDigitalInputBank.h"
+#include "interfaces/ILevelObserver.h"
+#include "interfaces/ILevelSensor.h"
+#include "interfaces/ITimeProvider.h"
+#include "interfaces/LockStats.h"
+#include "sensors/DebouncedLevelSensor.h"
+
+/// A reservoir mark; also its IDigitalInputBank channel (bit) number.
+enum class LevelMarkId : uint8_t {
+    Low = 0,
+    High = 1,
+};
+
+/// Every mark's state from one update(), loaded in one atomic read.
+struct LevelBankState {
+    uint32_t bits = 0;  ///< valid << m | present << (8 + m) | raw << (16 + m)
+
+    bool valid(LevelMarkId m) const { return bit(m, 0); }
+    /// False whenever invalid (the ILevelSensor contract).
+    bool waterPresent(LevelMarkId m) const { return bit(m, 8); }
+    /// Undebounced pin level of the last sample (diagnostics only).
+    bool raw(LevelMarkId m) const { return bit(m, 16); }
+
+private:
+    bool bit(LevelMarkId m, unsigned base) const
+    {
+        return ((bits >> (base + static_cast<unsigned>(m))) & 1u) != 0;
+    }
+};
+
+class LevelSensorBank {
+public:
+    static constexpr std::size_t kMarks = 2;
+
+    /**
+     * @brief One mark's ILevelSensor view of the bank's published state.
+     *
+     * update() is a no-op — the bank's update() samples every mark at
+     * once — and notifyPowerOn() re-arms the whole bank: the marks share
+     * one sensor rail.
+     */
+    class Mark final : public ILevelSensor {
+    public:
+        Mark(const Mark&) = delete;
+        Mark& operator=(const Mark&) = delete;
+
+        void update() override {}
+        bool isValid() override { return bank_.state().valid(id_); }
+        bool isWaterPresent() override { return bank_.state().waterPresent(id_); }
+        bool rawState() override { return bank_.state().raw(id_); }
+        void notifyPowerOn() override { bank_.notifyPowerOn(); }
+
+    private:
+        friend class LevelSensorBank;
+
+        Mark(LevelSensorBank& bank, LevelMarkId id) : bank_(bank), id_(id) {}
+
+        LevelSensorBank& bank_;
+        const LevelMarkId id_;
+    };
+
+    /**
+     * @brief Construct over the multi-pin input (channel m = mark m) and
+     * the clock; the policy arguments are DebouncedLevelSensor's, shared
+     * by every mark. Starts settling, like each mark alone.
+     */
+    LevelSensorBank(IDigitalInputBank& pins, ITimeProvider& time, bool activeLow,
+                    int64_t debounceMs, int64_t settleMs);
+
+    LevelSensorBank(const LevelSensorBank&) = delete;
+    LevelSensorBank& operator=(const LevelSensorBank&) = delete;
+
+    /**
+     * @brief Sample every pin once, advance every mark, publish, then call
+     * the observers of the marks whose water state changed. Owner task only.
+     */
+    void update();
+
+    /// The last published state (lock-free; any task).
+    LevelBankState state() const
+    {
+        return LevelBankState{published_.load(std::memory_order_acquire)};
+    }
+
+    /// The ILevelSensor view of mark @p m.
+    Mark& mark(LevelMarkId m) { return marks_[index(m)]; }
+
+    /// Re-arm settle gating on every mark (DebouncedLevelSensor::notifyPowerOn).
+    void notifyPowerOn();
+
+    /// Latch mark @p m Faulted (DebouncedLevelSensor::markFaulted); a
+    /// wiring-site call after its pin failed to initialize.
+    void markFaulted(LevelMarkId m);
+
+    /// Replay @p edges (nullptr = none) into mark @p m from the next update().
+    void setEdgeSource(LevelMarkId m, IDigitalInput* edges);
+
+    /// Call @p observer after an update() that changed mark @p m's water
+    /// state (nullptr = none); it sees the new state already published.
+    void setObserver(LevelMarkId m, ILevelObserver* observer);
+
+    /// The lock, for the LockRegistry (LockStats.h, WS_LOCK_STATS).
+    const DecoratorMutex& mutex() const { return mutex_; }
+
+private:
+    /// Mark m's raw input: bit m of the shared sample, plus its edges.
+    class Channel final : public IDigitalInput {
+    public:
+        Channel(const LevelSensorBank& bank, unsigned bit) : bank_(bank), bit_(bit) {}
+
+        bool read() override { return ((bank_.sample_ >> bit_) & 1u) != 0; }
+        bool nextEdge(DigitalEdge& edge) override;
+
+        IDigitalInput* edges = nullptr;
+
+    private:
+        const LevelSensorBank& bank_;
+        const unsigned bit_;
+        DigitalEdge held_;         ///< popped, but newer than the sample
+        bool holding_ = false;
+    };
+
+    /// The marks' clock: the sample time, so every mark steps at one instant.
+    class SampleClock final : public ITimeProvider {
+    public:
+        explicit SampleClock(const LevelSensorBank& bank) : bank_(bank) {}
+
+        int64_t nowMs() override { return bank_.sampleMs_; }
+
+    private:
+        const LevelSensorBank& bank_;
+    };
+
+    static std::size_t index(LevelMarkId m) { return static_cast<std::size_t>(m); }
+
+    /// Store the marks' state into published_ (mutex_ held).
+    void publishLocked();
+
+    IDigitalInputBank& pins_;
+    ITimeProvider& time_;
+    int64_t sampleMs_ = 0;  ///< time of sample_ (mutex_ held)
+    uint32_t sample_ = 0;   ///< the last readAll() (mutex_ held)
+    SampleClock clock_{*this};
+    std::array<Channel, kMarks> channels_;
+    std::array<DebouncedLevelSensor, kMarks> sensors_;
+    std::array<ILevelObserver*, kMarks> observers_{};
+    std::array<Mark, kMarks> marks_;
+    std::atomic<uint32_t> published_{0};
+    mutable DecoratorMutex mutex_;
+};
+
+#endif /* WATERINGSYSTEM_SENSORS_LEVELSENSORBANK_H */
@@ -29,35 +29,33 @@
  * calls (read() then getTemperature()/getHumidity()/getPressure()) is NOT
  * protected against an interleaving read() from another task in between.
  * snapshot() (PR-11) CLOSES that gap: it copies all three values + validity
- * out under a SINGLE lock, so a reader (controller / API status / console)
- * never observes a torn read/getter tuple. Any other multi-call sequence
- * still needs higher-level coordination.
+ * out as ONE struct, so a reader (controller / API status / console) never
+ * observes a torn read/getter tuple. Any other multi-call sequence still
+ * needs higher-level coordination.
  *
- * Pure C++ (<mutex> is available via pthread on ESP-IDF and on the linux
- * preview target), so the decorator is host-testable.
+ * LOCK-FREE READS: every call that reaches the bus republishes the
+ * wrapped sensor's snapshot() before releasing the mutex
+ * (PublishedSnapshot.h); the getters and snapshot() copy from there without
+ * it, so no reader waits behind an I2C transaction.
+ *
+ * Pure C++: the lock is a StaticMutex (a static FreeRTOS mutex on target,
+ * std::mutex on the host), so the decorator is host-testable; with
+ * WS_LOCK_STATS it is instrumented for contention (LockStats.h).
  */
 
 #ifndef WATERINGSYSTEM_SENSORS_LOCKEDENVIRONMENTALSENSOR_H
 #define WATERINGSYSTEM_SENSORS_LOCKEDENVIRONMENTALSENSOR_H
 
+#include <cstdint>
 #include <mutex>
 
 #include "interfaces/IEnvironmentalSensor.h"
+#include "interfaces/ITimeProvider.h"
+#include "interfaces/LockStats.h"
+#include "sensors/PublishedSnapshot.h"
 
-/**
- * @brief Consistent, non-blocking environmental snapshot (PR-11).
- *
- * Temperature/humidity/pressure plus validity, copied out under one lock so
- * they are mutually consistent. valid reports whether the most recent read()
- * through the wrapper succeeded (fresh data); when false the values are the
- * last-good reading (or the NaN placeholders before the first success).
- */
-struct EnvSnapshot {
-    bool valid;
-    float temperature;
-    float humidity;
-    float pressure;
-};
+// EnvSnapshot is defined in interfaces/IEnvironmentalSensor.h, next to
+// snapshot().
 
 /**
  * @brief IEnvironmentalSensor decorator that serializes every call with a
@@ -69,9 +67,10 @@ struct EnvSnapshot {
  */
 class LockedEnvironmentalSensor : public IEnvironmentalSensor {
 public:
-    /// Wrap @p sensor; the wrapped sensor must outlive this object.
-    explicit LockedEnvironmentalSensor(IEnvironmentalSensor& sensor)
-        : sensor_(sensor)
+    /// Wrap @p sensor; @p clock stamps each new sample's atMs. Both must
+    /// outlive this object.
+    LockedEnvironmentalSensor(IEnvironmentalSensor& sensor, ITimeProvider& clock)
+        : sensor_(sensor), clock_(clock), published_(sensor.snapshot())
     {
     }
 
@@ -81,75 +80,99 @@ public:
 
     bool initialize() override
     {
-        std::lock_guard<std::mutex> lock(mutex_);
-        return sensor_.initialize();
+        std::lock_guard<DecoratorMutex> lock(mutex_);
+        const bool ok = sensor_.initialize();
+        publishLocked();
+        return ok;
     }
 
     bool read() override
     {
-        std::lock_guard<std::mutex> lock(mutex_);
+        std::lock_guard<DecoratorMutex> lock(mutex_);
         const bool ok = sensor_.read();
-        // Cache the outcome so snapshot() can report validity without a
-        // fresh (blocking) bus transaction.
-        lastReadOk_ = ok;
+        publishLocked();
         return ok;
     }
 
     bool isAvailable() override
     {
-        std::lock_guard<std::mutex> lock(mutex_);
-        return sensor_.isAvailable();
+        std::lock_guard<DecoratorMutex> lock(mutex_);
+        const bool ok = sensor_.isAvailable();
+        publishLocked();
+        return ok;
+    }
+
+    uint32_t startMeasurement() override
+    {
+        std::lock_guard<DecoratorMutex> lock(mutex_);
+        const uint32_t waitUs = sensor_.startMeasurement();
+        publishLocked();
+        return waitUs;
+    }
+
+    bool setBurst(bool burst) override
+    {
+        std::lock_guard<DecoratorMutex> lock(mutex_);
+        const bool ok = sensor_.setBurst(burst);
+        publishLocked();
+        return ok;
     }
 
     int getLastError() override
     {
-        std::lock_guard<std::mutex> lock(mutex_);
-        return sensor_.getLastError();
+        return published_.load().lastError;
     }
 
     float getTemperature() override
     {
-        std::lock_guard<std::mutex> lock(mutex_);
-        return sensor_.getTemperature();
+        return published_.load().temperature;
     }
 
     float getHumidity() override
     {
-        std::lock_guard<std::mutex> lock(mutex_);
-        return sensor_.getHumidity();
+        return published_.load().humidity;
     }
 
     float getPressure() override
     {
-        std::lock_guard<std::mutex> lock(mutex_);
-        return sensor_.getPressure();
+        return published_.load().pressure;
     }
 
     /**
-     * @brief Copy the last-good T/RH/P + validity out under one lock (PR-11),
-     * closing the read-then-getter cross-call gap.
+     * @brief The last-good T/RH/P + validity + error as one coherent copy
+     * (PR-11), closing the read-then-getter cross-call gap.
      *
      * NON-BLOCKING by contract: it performs NO fresh read() and NO
      * isAvailable() probe — both are I2C bus I/O and must never run in a
      * status/API/controller path (QUIRK 5). The sensor task owns the read()
-     * cadence; this returns the current cached values. valid = the most
-     * recent read() through this wrapper succeeded.
+     * cadence; this returns the copy published after the last call through
+     * this wrapper, without taking the mutex.
      */
-    EnvSnapshot snapshot()
+    EnvSnapshot snapshot() override { return published_.load(); }
+
+    /// The lock, for the LockRegistry (LockStats.h, WS_LOCK_STATS).
+    const DecoratorMutex& mutex() const { return mutex_; }
+
+private:
+    /// Republish the wrapped sensor's snapshot; caller holds mutex_. A new
+    /// sequence is stamped now, a repeated one keeps its first stamp.
+    void publishLocked()
     {
-        std::lock_guard<std::mutex> lock(mutex_);
-        EnvSnapshot s;
-        s.valid = lastReadOk_;
-        s.temperature = sensor_.getTemperature();
-        s.humidity = sensor_.getHumidity();
-        s.pressure = sensor_.getPressure();
-        return s;
+        EnvSnapshot snap = sensor_.snapshot();
+        if (snap.sequence != stampedSequence_) {
+            stampedSequence_ = snap.sequence;
+            stampedAtMs_ = snap.sequence == 0 ? 0 : clock_.nowMs();
+        }
+        snap.atMs = stampedAtMs_;
+        published_.publish(snap);
     }
 
-private:
     IEnvironmentalSensor& sensor_;
-    mutable std::mutex mutex_;
-    bool lastReadOk_ = false; ///< result of the most recent read()
+    ITimeProvider& clock_;
+    mutable DecoratorMutex mutex_;
+    PublishedSnapshot<EnvSnapshot> published_;
+    uint32_t stampedSequence_ = 0;  ///< guarded by mutex_
+    int64_t stampedAtMs_ = 0;       ///< guarded by mutex_
 };
 
 #endif /* WATERINGSYSTEM_SENSORS_LOCKEDENVIRONMENTALSENSOR_H */
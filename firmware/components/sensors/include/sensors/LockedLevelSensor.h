@@ -28,8 +28,9 @@
  * observes a torn validity/state tuple. Any other multi-call sequence still
  * needs higher-level coordination.
  *
- * Pure C++ (<mutex> is available via pthread on ESP-IDF and on the linux
- * preview target), so the decorator is host-testable.
+ * Pure C++: the lock is a StaticMutex (a static FreeRTOS mutex on target,
+ * std::mutex on the host), so the decorator is host-testable; with
+ * WS_LOCK_STATS it is instrumented for contention (LockStats.h).
  */
 
 #ifndef WATERINGSYSTEM_SENSORS_LOCKEDLEVELSENSOR_H
@@ -38,6 +39,7 @@
 #include <mutex>
 
 #include "interfaces/ILevelSensor.h"
+#include "interfaces/LockStats.h"
 
 /**
  * @brief Consistent level snapshot (PR-11): validity + logical state copied
@@ -58,9 +60,11 @@ struct LevelSnapshot {
  *
  * Composition, not inheritance from a concrete sensor: the base class
  * stays pure (no locking) and the host tests are unchanged. The wrapped
- * sensor must outlive this object.
+ * sensor must outlive this object. Final, so a call through a
+ * LockedLevelSensor& — the 10 Hz loop, the static-dispatch reservoir
+ * wiring — is direct.
  */
-class LockedLevelSensor : public ILevelSensor {
+class LockedLevelSensor final : public ILevelSensor {
 public:
     /// Wrap @p sensor; the wrapped sensor must outlive this object.
     explicit LockedLevelSensor(ILevelSensor& sensor) : sensor_(sensor) {}
@@ -70,31 +74,31 @@ public:
 
     void update() override
     {
-        std::lock_guard<std::mutex> lock(mutex_);
+        std::lock_guard<DecoratorMutex> lock(mutex_);
         sensor_.update();
     }
 
     bool isValid() override
     {
-        std::lock_guard<std::mutex> lock(mutex_);
+        std::lock_guard<DecoratorMutex> lock(mutex_);
         return sensor_.isValid();
     }
 
     bool isWaterPresent() override
     {
-        std::lock_guard<std::mutex> lock(mutex_);
+        std::lock_guard<DecoratorMutex> lock(mutex_);
         return sensor_.isWaterPresent();
     }
 
     bool rawState() override
     {
-        std::lock_guard<std::mutex> lock(mutex_);
+        std::lock_guard<DecoratorMutex> lock(mutex_);
         return sensor_.rawState();
     }
 
     void notifyPowerOn() override
     {
-        std::lock_guard<std::mutex> lock(mutex_);
+        std::lock_guard<DecoratorMutex> lock(mutex_);
         sensor_.notifyPowerOn();
     }
 
@@ -108,16 +112,19 @@ public:
      */
     LevelSnapshot snapshot()
     {
-        std::lock_guard<std::mutex> lock(mutex_);
+        std::lock_guard<DecoratorMutex> lock(mutex_);
         LevelSnapshot s;
         s.valid = sensor_.isValid();
         s.waterPresent = sensor_.isWaterPresent();
         return s;
     }
 
+    /// The lock, for the LockRegistry (LockStats.h, WS_LOCK_STATS).
+    const DecoratorMutex& mutex() const { return mutex_; }
+
 private:
     ILevelSensor& sensor_;
-    mutable std::mutex mutex_;
+    mutable DecoratorMutex mutex_;
 };
 
 #endif /* WATERINGSYSTEM_SENSORS_LOCKEDLEVELSENSOR_H */
@@ -30,21 +30,28 @@
  * getBusVoltage()/getCurrent()/getPower()) is NOT protected against an
  * interleaving read() from another task in between — another task may
  * refresh (or invalidate) the values first. Such sequences need
- * higher-level coordination.
- * TODO(PR-14): add a consistent-snapshot helper (one locked call returning
- * all three values + validity) when a second periodic reader appears — the
- * sibling Soil/Env/Level snapshots landed in PR-11; power's is deferred.
+ * higher-level coordination; snapshot() closes the read-then-getters gap
+ * for readers that only need the values.
  *
- * Pure C++ (<mutex> is available via pthread on ESP-IDF and on the linux
- * preview target), so the decorator is host-testable.
+ * LOCK-FREE READS: initialize(), read() and isAvailable() republish the
+ * wrapped sensor's snapshot() before releasing the mutex; the getters and
+ * snapshot() copy from the PublishedSnapshot without taking it.
+ *
+ * Pure C++: the lock is a StaticMutex (a static FreeRTOS mutex on target,
+ * std::mutex on the host), so the decorator is host-testable; with
+ * WS_LOCK_STATS it is instrumented for contention (LockStats.h).
  */
 
 #ifndef WATERINGSYSTEM_SENSORS_LOCKEDPOWERSENSOR_H
 #define WATERINGSYSTEM_SENSORS_LOCKEDPOWERSENSOR_H
 
+#include <cstdint>
 #include <mutex>
 
 #include "interfaces/IPowerSensor.h"
+#include "interfaces/ITimeProvider.h"
+#include "interfaces/LockStats.h"
+#include "sensors/PublishedSnapshot.h"
 
 /**
  * @brief IPowerSensor decorator that serializes every call with a mutex.
@@ -55,57 +62,138 @@
  */
 class LockedPowerSensor : public IPowerSensor {
 public:
-    /// Wrap @p sensor; the wrapped sensor must outlive this object.
-    explicit LockedPowerSensor(IPowerSensor& sensor) : sensor_(sensor) {}
+    /// Wrap @p sensor; @p clock stamps each new sample's atMs. Both must
+    /// outlive this object.
+    LockedPowerSensor(IPowerSensor& sensor, ITimeProvider& clock)
+        : sensor_(sensor), clock_(clock), published_(sensor.snapshot())
+    {
+    }
 
     LockedPowerSensor(const LockedPowerSensor&) = delete;
     LockedPowerSensor& operator=(const LockedPowerSensor&) = delete;
 
     bool initialize() override
     {
-        std::lock_guard<std::mutex> lock(mutex_);
-        return sensor_.initialize();
+        std::lock_guard<DecoratorMutex> lock(mutex_);
+        const bool ok = sensor_.initialize();
+        publishLocked();
+        return ok;
     }
 
     bool read() override
     {
-        std::lock_guard<std::mutex> lock(mutex_);
-        return sensor_.read();
+        std::lock_guard<DecoratorMutex> lock(mutex_);
+        const bool ok = sensor_.read();
+        publishLocked();
+        return ok;
     }
 
     bool isAvailable() override
     {
-        std::lock_guard<std::mutex> lock(mutex_);
-        return sensor_.isAvailable();
+        std::lock_guard<DecoratorMutex> lock(mutex_);
+        const bool ok = sensor_.isAvailable();
+        publishLocked();
+        return ok;
     }
 
     int getLastError() override
     {
-        std::lock_guard<std::mutex> lock(mutex_);
-        return sensor_.getLastError();
+        return published_.load().lastError;
     }
 
     float getBusVoltage() override
     {
-        std::lock_guard<std::mutex> lock(mutex_);
-        return sensor_.getBusVoltage();
+        return published_.load().busVoltage;
     }
 
     float getCurrent() override
     {
-        std::lock_guard<std::mutex> lock(mutex_);
-        return sensor_.getCurrent();
+        return published_.load().current;
     }
 
     float getPower() override
     {
-        std::lock_guard<std::mutex> lock(mutex_);
-        return sensor_.getPower();
+        return published_.load().power;
+    }
+
+    /**
+     * @brief The last reading + validity + error as one coherent copy.
+     *
+     * NON-BLOCKING: no read(), no isAvailable() probe. Returns the copy
+     * published after the last call through this wrapper, without taking
+     * the mutex.
+     */
+    PowerSnapshot snapshot() override { return published_.load(); }
+
+    uint32_t conversionPeriodUs() override
+    {
+        std::lock_guard<DecoratorMutex> lock(mutex_);
+        return sensor_.conversionPeriodUs();
+    }
+
+    bool setConversionReadyAlert(bool enable) override
+    {
+        std::lock_guard<DecoratorMutex> lock(mutex_);
+        const bool ok = sensor_.setConversionReadyAlert(enable);
+        publishLocked();
+        return ok;
+    }
+
+    bool conversionReady() override
+    {
+        std::lock_guard<DecoratorMutex> lock(mutex_);
+        const bool ready = sensor_.conversionReady();
+        publishLocked();
+        return ready;
     }
 
+    bool setOverCurrentLimit(float amps) override
+    {
+        std::lock_guard<DecoratorMutex> lock(mutex_);
+        const bool ok = sensor_.setOverCurrentLimit(amps);
+        publishLocked();
+        return ok;
+    }
+
+    bool setHighRateSampling(bool enable) override
+    {
+        std::lock_guard<DecoratorMutex> lock(mutex_);
+        const bool ok = sensor_.setHighRateSampling(enable);
+        publishLocked();
+        return ok;
+    }
+
+    bool readCurrent(float& amps) override
+    {
+        std::lock_guard<DecoratorMutex> lock(mutex_);
+        const bool ok = sensor_.readCurrent(amps);
+        publishLocked();
+        return ok;
+    }
+
+    /// The lock, for the LockRegistry (LockStats.h, WS_LOCK_STATS).
+    const DecoratorMutex& mutex() const { return mutex_; }
+
 private:
+    /// Republish the wrapped sensor's snapshot; caller holds mutex_. A new
+    /// sequence is stamped now, a repeated one keeps its first stamp.
+    void publishLocked()
+    {
+        PowerSnapshot snap = sensor_.snapshot();
+        if (snap.sequence != stampedSequence_) {
+            stampedSequence_ = snap.sequence;
+            stampedAtMs_ = snap.sequence == 0 ? 0 : clock_.nowMs();
+        }
+        snap.atMs = stampedAtMs_;
+        published_.publish(snap);
+    }
+
     IPowerSensor& sensor_;
-    mutable std::mutex mutex_;
+    ITimeProvider& clock_;
+    mutable DecoratorMutex mutex_;
+    PublishedSnapshot<PowerSnapshot> published_;
+    uint32_t stampedSequence_ = 0;  ///< guarded by mutex_
+    int64_t stampedAtMs_ = 0;       ///< guarded by mutex_
 };
 
 #endif /* WATERINGSYSTEM_SENSORS_LOCKEDPOWERSENSOR_H */
@@ -26,13 +26,20 @@
  * read() from another task in between — another task may refresh (or
  * invalidate) the values first. snapshot() (PR-11) CLOSES that gap for the
  * common consumer case: it copies the last-good values + validity + error
- * out under a SINGLE lock, so a reader (controller / API status / console)
- * never observes a torn read/getter tuple. Any other multi-call sequence
- * still needs higher-level coordination (a caller-held lock or single-owner
- * task).
+ * out as ONE struct, so a reader (controller / API status / console) never
+ * observes a torn read/getter tuple. Any other multi-call sequence still
+ * needs higher-level coordination (a caller-held lock or single-owner task).
  *
- * Pure C++ (<mutex> is available via pthread on ESP-IDF and on the linux
- * preview target), so the decorator is host-testable.
+ * LOCK-FREE READS: every call that can change the reading (initialize,
+ * read, isAvailable's lazy init, calibrate*) republishes the wrapped
+ * sensor's snapshot() before releasing the mutex, in call order
+ * (PublishedSnapshot.h). The getters and snapshot() copy from there without
+ * the mutex, so the API and console never queue behind a Modbus read; as
+ * with LockedConfigStore, a change that bypasses the wrapper is not seen.
+ *
+ * Pure C++: the lock is a StaticMutex (a static FreeRTOS mutex on target,
+ * std::mutex on the host), so the decorator is host-testable; with
+ * WS_LOCK_STATS it is instrumented for contention (LockStats.h).
  */
 
 #ifndef WATERINGSYSTEM_SENSORS_LOCKEDSOILSENSOR_H
@@ -41,6 +48,8 @@
 #include <mutex>
 
 #include "interfaces/ISoilSensor.h"
+#include "interfaces/LockStats.h"
+#include "sensors/PublishedSnapshot.h"
 
 // SoilSnapshot is defined in interfaces/ISoilSensor.h (owned by the interface
 // so the pure controller can consume snapshot() through ISoilSensor).
@@ -55,124 +64,138 @@
 class LockedSoilSensor : public ISoilSensor {
 public:
     /// Wrap @p sensor; the wrapped sensor must outlive this object.
-    explicit LockedSoilSensor(ISoilSensor& sensor) : sensor_(sensor) {}
+    explicit LockedSoilSensor(ISoilSensor& sensor)
+        : sensor_(sensor), published_(sensor.snapshot())
+    {
+    }
 
     LockedSoilSensor(const LockedSoilSensor&) = delete;
     LockedSoilSensor& operator=(const LockedSoilSensor&) = delete;
 
     bool initialize() override
     {
-        std::lock_guard<std::mutex> lock(mutex_);
-        return sensor_.initialize();
+        std::lock_guard<DecoratorMutex> lock(mutex_);
+        const bool ok = sensor_.initialize();
+        published_.publish(sensor_.snapshot());
+        return ok;
     }
 
     bool read() override
     {
-        std::lock_guard<std::mutex> lock(mutex_);
-        return sensor_.read();
+        std::lock_guard<DecoratorMutex> lock(mutex_);
+        const bool ok = sensor_.read();
+        published_.publish(sensor_.snapshot());
+        return ok;
+    }
+
+    bool readGroup(SoilReadGroup group) override
+    {
+        std::lock_guard<DecoratorMutex> lock(mutex_);
+        const bool ok = sensor_.readGroup(group);
+        published_.publish(sensor_.snapshot());
+        return ok;
     }
 
     bool isAvailable() override
     {
-        std::lock_guard<std::mutex> lock(mutex_);
-        return sensor_.isAvailable();
+        std::lock_guard<DecoratorMutex> lock(mutex_);
+        const bool ok = sensor_.isAvailable();
+        published_.publish(sensor_.snapshot());
+        return ok;
     }
 
     int getLastError() override
     {
-        std::lock_guard<std::mutex> lock(mutex_);
-        return sensor_.getLastError();
+        return published_.load().lastError;
     }
 
     float getMoisture() override
     {
-        std::lock_guard<std::mutex> lock(mutex_);
-        return sensor_.getMoisture();
+        return published_.load().moisture;
     }
 
     float getTemperature() override
     {
-        std::lock_guard<std::mutex> lock(mutex_);
-        return sensor_.getTemperature();
+        return published_.load().temperature;
     }
 
     float getHumidity() override
     {
-        std::lock_guard<std::mutex> lock(mutex_);
-        return sensor_.getHumidity();
+        return published_.load().humidity;
     }
 
     float getPH() override
     {
-        std::lock_guard<std::mutex> lock(mutex_);
-        return sensor_.getPH();
+        return published_.load().ph;
     }
 
     float getEC() override
     {
-        std::lock_guard<std::mutex> lock(mutex_);
-        return sensor_.getEC();
+        return published_.load().ec;
     }
 
     float getNitrogen() override
     {
-        std::lock_guard<std::mutex> lock(mutex_);
-        return sensor_.getNitrogen();
+        return published_.load().nitrogen;
     }
 
     float getPhosphorus() override
     {
-        std::lock_guard<std::mutex> lock(mutex_);
-        return sensor_.getPhosphorus();
+        return published_.load().phosphorus;
     }
 
     float getPotassium() override
     {
-        std::lock_guard<std::mutex> lock(mutex_);
-        return sensor_.getPotassium();
+        return published_.load().potassium;
     }
 
     bool calibrateMoisture(float referenceValue) override
     {
-        std::lock_guard<std::mutex> lock(mutex_);
-        return sensor_.calibrateMoisture(referenceValue);
+        std::lock_guard<DecoratorMutex> lock(mutex_);
+        const bool ok = sensor_.calibrateMoisture(referenceValue);
+        published_.publish(sensor_.snapshot());
+        return ok;
     }
 
     bool calibratePH(float referenceValue) override
     {
-        std::lock_guard<std::mutex> lock(mutex_);
-        return sensor_.calibratePH(referenceValue);
+        std::lock_guard<DecoratorMutex> lock(mutex_);
+        const bool ok = sensor_.calibratePH(referenceValue);
+        published_.publish(sensor_.snapshot());
+        return ok;
     }
 
     bool calibrateEC(float referenceValue) override
     {
-        std::lock_guard<std::mutex> lock(mutex_);
-        return sensor_.calibrateEC(referenceValue);
+        std::lock_guard<DecoratorMutex> lock(mutex_);
+        const bool ok = sensor_.calibrateEC(referenceValue);
+        published_.publish(sensor_.snapshot());
+        return ok;
     }
 
     /**
-     * @brief Copy the last-good reading + validity + error out under one
-     * lock (PR-11), closing the read-then-getter cross-call gap.
+     * @brief The last-good reading + validity + error as one coherent copy
+     * (PR-11), closing the read-then-getter cross-call gap.
      *
-     * Locks and delegates to the wrapped sensor's snapshot(): the base tracks
-     * the read history (readOk / ever-read-ok) and holds the last-good values,
-     * and the lock makes that member-read atomic vs a concurrent read() on
-     * another task.
+     * The wrapped sensor's snapshot() (the base tracks the read history —
+     * readOk / ever-read-ok — and holds the last-good values) as published
+     * after the last call through this wrapper; copied lock-free, so it
+     * never waits for a read() in progress on another task.
      *
      * NON-BLOCKING by contract: the base's snapshot() performs NO fresh read()
      * and NO isAvailable() probe — both are RS485/Modbus bus I/O and must never
      * run in a status/API/controller path (QUIRK 5). The periodic soil reader
      * owns the read() cadence; this returns the current cached values.
      */
-    SoilSnapshot snapshot() override
-    {
-        std::lock_guard<std::mutex> lock(mutex_);
-        return sensor_.snapshot();
-    }
+    SoilSnapshot snapshot() override { return published_.load(); }
+
+    /// The lock, for the LockRegistry (LockStats.h, WS_LOCK_STATS).
+    const DecoratorMutex& mutex() const { return mutex_; }
 
 private:
     ISoilSensor& sensor_;
-    mutable std::mutex mutex_;
+    mutable DecoratorMutex mutex_;
+    PublishedSnapshot<SoilSnapshot> published_;
 };
 
 #endif /* WATERINGSYSTEM_SENSORS_LOCKEDSOILSENSOR_H */
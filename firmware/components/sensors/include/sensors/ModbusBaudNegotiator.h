@@ -0,0 +1,82 @@
+// SPDX-FileCopyrightText: 2026 Cryptotomte
+// SPDX-License-Identifier: AGPL-3.0-or-later
+/**
+ * @file ModbusBaudNegotiator.h
+ * @brief Move the soil probes and the Modbus master to another line rate
+ *        together, verified, with rollback.
+ *
+ * At the parity 9600 baud the 9-register soil read spends most of its
+ * round trip on the wire (SoilPollScheduler.h). The probe keeps its line
+ * rate in a holding register (kSoilRegBaudRate, codes in soilBaudCode());
+ * it acknowledges the write at the old rate and answers at the new one
+ * afterwards. Every probe on the segment must move, since the master
+ * talks to all of them at one rate:
+ *
+ *   1. every probe must answer at the current rate;
+ *   2. write the new code to each;
+ *   3. switch the master (IModbusClient::setBaudRate());
+ *   4. read the register back from each at the new rate.
+ *
+ * A failure in step 2–4 rolls back: the old code is written at the new
+ * rate (probes that switched), the master returns to the old rate, and any
+ * probe still holding the new code there (it applies on power-up only) is
+ * written back too. Persisting the rate is the caller's job; at boot,
+ * confirmSoilBusBaud() checks that the primary probe still answers at the
+ * stored rate.
+ *
+ * Runs on the calling task through a bus port; soil reads queued between
+ * the steps may fail once while the rates disagree. Pure C++ over
+ * IModbusClient, host-tested.
+ */
+
+#ifndef WATERINGSYSTEM_SENSORS_MODBUSBAUDNEGOTIATOR_H
+#define WATERINGSYSTEM_SENSORS_MODBUSBAUDNEGOTIATOR_H
+
+#include <cstddef>
+#include <cstdint>
+
+#include "interfaces/IModbusClient.h"
+
+/// Probe holding register with the line-rate code (probe manual).
+constexpr uint16_t kSoilRegBaudRate = 0x07D1;
+
+/// Probe code for @p baud (2400, 4800, 9600 or 19200); false for a rate
+/// the probe does not list.
+bool soilBaudCode(uint32_t baud, uint16_t& code);
+
+/// Outcome of changeSoilBusBaud().
+enum class BaudChange : uint8_t {
+    Changed,      ///< every probe and the master run at the new rate
+    Unchanged,    ///< already at that rate
+    Unsupported,  ///< a rate the probe (or the master) cannot run
+    NoAnswer,     ///< a probe did not answer at the current rate; untouched
+    RolledBack,   ///< a step failed; everything is back at the old rate
+    Stranded,     ///< a step failed and a probe did not come back
+};
+
+/// Stable lower-case name of @p result (console output).
+const char* baudChangeName(BaudChange result);
+
+/**
+ * @brief Move the probes at @p addresses (@p count of them) and @p bus to
+ *        @p baud.
+ *
+ * @param bus The bus port the probes are read through.
+ */
+BaudChange changeSoilBusBaud(IModbusClient& bus, const uint8_t* addresses,
+                             std::size_t count, uint32_t baud);
+
+/**
+ * @brief Boot check of a stored rate already set on @p bus.
+ *
+ * When the probe at @p address does not answer at bus.baudRate() but does
+ * at @p fallbackBaud (it was reset to its factory rate), @p bus stays at
+ * @p fallbackBaud. When it answers at neither, @p bus returns to the
+ * stored rate (the probe is absent, not reset).
+ *
+ * @return the rate @p bus runs at afterwards.
+ */
+uint32_t confirmSoilBusBaud(IModbusClient& bus, uint8_t address,
+                            uint32_t fallbackBaud);
+
+#endif /* WATERINGSYSTEM_SENSORS_MODBUSBAUDNEGOTIATOR_H */
@@ -0,0 +1,218 @@
+// SPDX-FileCopyrightText: 2026 Cryptotomte
+// SPDX-License-Identifier: AGPL-3.0-or-later
+/**
+ * @file ModbusBusMaster.h
+ * @brief RS485 bus owner: prioritized transaction queue in front of an
+ *        IModbusClient.
+ *
+ * WHY THIS EXISTS: the LockedModbusClient this replaces serialized the
+ * bus with one mutex, so whoever got there first held the bus for a whole
+ * transaction — up to the 3 s response timeout against an absent slave —
+ * and a console `rs485test` waiting on it ranked the same as the watering
+ * task's soil read. Here every transaction is a caller-owned ModbusTransaction queued
+ * by priority (Control before Diagnostic, arrival order within one) and
+ * run by a single bus task (main/modbus_task.cpp, looping on serve()).
+ * Callers hold no lock while they wait, and a high-priority read queued
+ * behind a diagnostic probe runs next, not after every probe queued since.
+ *
+ * COMPLETION: submit() queues and returns; the bus task fills the result
+ * fields, calls the transaction's onDone callback (on the bus task), then
+ * sets done. execute() is submit() plus a wait — the future's get(). The
+ * queue is intrusive (the transactions link themselves in), so queueing
+ * never allocates and never overflows. A submitted transaction must stay
+ * alive and untouched until it is done.
+ *
+ * PORTS: port(priority) is an IModbusClient whose calls execute() at that
+ * priority, so ModbusSoilSensor and the console keep their interface and
+ * each wiring site picks its class. getLastError() is per port: one
+ * caller's failure can no longer overwrite the code another is reading.
+ *
+ * BEFORE THE TASK RUNS (boot init, or a task that failed to start) a
+ * transaction runs on the calling task under the bus mutex, as the old
+ * locked client did; the first serve() switches to the queue.
+ *
+ * TIMING: each transaction records how long it queued (queueUs) apart
+ * from how long it held the bus (busUs); stats() sums both per priority.
+ * Register transfers are also tallied per slave and function, with a
+ * latency histogram and the error split (linkStats(), ModbusLinkStats.h).
+ *
+ * USAGE RULE: once wrapped, the client must ONLY be reached through this
+ * object — two paths to the UART could overlap on the wire.
+ *
+ * Pure C++ (std::mutex/condition_variable, pthread-backed on ESP-IDF), so
+ * the queue is host-tested; only the task is target code.
+ */
+
+#ifndef WATERINGSYSTEM_SENSORS_MODBUSBUSMASTER_H
+#define WATERINGSYSTEM_SENSORS_MODBUSBUSMASTER_H
+
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <mutex>
+#include <vector>
+
+#include "interfaces/IModbusClient.h"
+#include "interfaces/PowerLocks.h"
+#include "sensors/ModbusLinkStats.h"
+
+/// Queue class of a bus transaction; lower values are served first.
+enum class ModbusPriority : uint8_t {
+    Control = 0,     ///< the watering controller's soil reads (and selftest)
+    Diagnostic = 1,  ///< console probes
+};
+
+/// Number of ModbusPriority classes.
+constexpr std::size_t kModbusPriorities = 2;
+
+/**
+ * @brief One bus transaction and, once done, its result (the future).
+ *
+ * Fill the request fields, then ModbusBusMaster::submit() or execute().
+ */
+struct ModbusTransaction {
+    enum class Op : uint8_t {
+        Initialize,
+        ReadHolding,
+        WriteSingle,
+        SetTimeout,
+        SetBaudRate,
+        WriteMultiple,
+    };
+
+    // -- Request --------------------------------------------------------
+    Op op = Op::ReadHolding;
+    ModbusPriority priority = ModbusPriority::Control;
+    uint8_t deviceAddress = 0;
+    uint16_t reg = 0;           ///< start register / register written
+    uint16_t count = 0;         ///< ReadHolding / WriteMultiple: registers
+    uint16_t value = 0;         ///< WriteSingle: value to write
+    uint16_t* buffer = nullptr; ///< ReadHolding: at least count elements
+    const uint16_t* values = nullptr;  ///< WriteMultiple: count values
+    uint32_t timeoutMs = 0;     ///< SetTimeout
+    uint32_t baud = 0;          ///< SetBaudRate
+    /// Called on the bus task once the result is in (may be empty).
+    void (*onDone)(ModbusTransaction&, void* context) = nullptr;
+    void* context = nullptr;
+
+    // -- Result (valid once done) ----------------------------------------
+    bool ok = false;
+    int error = 0;          ///< the client's getLastError() after the call
+    int64_t queueUs = 0;    ///< submit() to the start of the transfer
+    int64_t busUs = 0;      ///< the transfer itself
+    std::atomic<bool> done{false};
+
+    // -- Queue link (ModbusBusMaster only) --------------------------------
+    ModbusTransaction* next = nullptr;
+    int64_t submittedUs = 0;
+};
+
+/// Timing of the transactions served at one priority since boot.
+struct ModbusQueueStats {
+    uint32_t transactions = 0;
+    uint64_t queueUsTotal = 0;
+    uint32_t queueUsMax = 0;
+    uint64_t busUsTotal = 0;
+    uint32_t busUsMax = 0;
+};
+
+class ModbusBusMaster {
+public:
+    /// Wrap @p client (must outlive this object). @p clock is a
+    /// microsecond monotonic clock for the timings; without one they read 0.
+    explicit ModbusBusMaster(IModbusClient& client,
+                             std::function<int64_t()> clock = nullptr);
+
+    ModbusBusMaster(const ModbusBusMaster&) = delete;
+    ModbusBusMaster& operator=(const ModbusBusMaster&) = delete;
+
+    /// Hold @p lock (ApbMax: bus clock up, no light sleep) across each
+    /// transfer; null for none. Boot wiring, before the bus task starts.
+    void setPowerLock(IPowerLock* lock) { powerLock_ = lock; }
+
+    /// Queue @p txn; it completes on the bus task. Before the task serves,
+    /// it runs here instead and is done on return.
+    void submit(ModbusTransaction& txn);
+
+    /// submit() and wait until @p txn is done; returns its ok.
+    bool execute(ModbusTransaction& txn);
+
+    /**
+     * @brief Bus task body: wait up to @p timeoutMs for a transaction, then
+     * run the most urgent one queued.
+     * @return true when one was served
+     */
+    bool serve(uint32_t timeoutMs);
+
+    /// The IModbusClient view whose transfers run at @p priority.
+    IModbusClient& port(ModbusPriority priority);
+
+    /// Transactions queued right now.
+    std::size_t depth() const;
+
+    ModbusQueueStats stats(ModbusPriority priority) const;
+
+    /// Time the bus has spent in transfers since boot, all priorities.
+    uint64_t busTimeUs() const;
+
+    /// Register transfers per slave and function since boot.
+    std::vector<ModbusLinkStats> linkStats() const;
+
+    /// Register transfers left out of linkStats() (its table was full).
+    uint32_t untrackedTransfers() const;
+
+private:
+    class Port final : public IModbusClient {
+    public:
+        Port() = default;
+        void bind(ModbusBusMaster& bus, ModbusPriority priority);
+
+        bool initialize() override;
+        bool readHoldingRegisters(uint8_t deviceAddress, uint16_t startRegister,
+                                  uint16_t count, uint16_t* buffer) override;
+        bool writeSingleRegister(uint8_t deviceAddress, uint16_t registerAddress,
+                                 uint16_t value) override;
+        bool writeMultipleRegisters(uint8_t deviceAddress, uint16_t startRegister,
+                                    uint16_t count, const uint16_t* values) override;
+        int getLastError() override { return lastError_.load(); }
+        void setTimeout(uint32_t timeoutMs) override;
+        void getStatistics(uint32_t* successCount, uint32_t* errorCount) override;
+        /// Queued like a transfer, so the rate changes between frames.
+        bool setBaudRate(uint32_t baud) override;
+        uint32_t baudRate() override { return bus_->baud_.load(); }
+
+    private:
+        bool run(ModbusTransaction& txn);
+
+        ModbusBusMaster* bus_ = nullptr;
+        ModbusPriority priority_ = ModbusPriority::Control;
+        std::atomic<int> lastError_{0};
+    };
+
+    int64_t now() const { return clock_ ? clock_() : 0; }
+
+    /// Run @p txn on the client; the caller holds busMutex_.
+    void transfer(ModbusTransaction& txn);
+
+    IModbusClient& client_;
+    std::function<int64_t()> clock_;
+    IPowerLock* powerLock_ = nullptr;
+    Port ports_[kModbusPriorities];
+    std::mutex busMutex_;                ///< held across a transfer
+    mutable std::mutex queueMutex_;      ///< guards the queues and stats (short)
+    std::condition_variable queued_;     ///< the bus task waits here
+    std::condition_variable completed_;  ///< execute() waits here
+    ModbusTransaction* head_[kModbusPriorities] = {};
+    ModbusTransaction* tail_[kModbusPriorities] = {};
+    std::size_t depth_ = 0;
+    ModbusQueueStats stats_[kModbusPriorities];
+    ModbusLinkTable links_;
+    uint32_t successes_ = 0;             ///< every transfer, all priorities
+    uint32_t errors_ = 0;
+    std::atomic<bool> serving_{false};   ///< a bus task has called serve()
+    std::atomic<uint32_t> baud_;         ///< client_.baudRate(), kept on change
+};
+
+#endif /* WATERINGSYSTEM_SENSORS_MODBUSBUSMASTER_H */
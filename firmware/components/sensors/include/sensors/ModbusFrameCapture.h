@@ -0,0 +1,115 @@
+// SPDX-FileCopyrightText: 2026 Cryptotomte
+// SPDX-License-Identifier: AGPL-3.0-or-later
+/**
+ * @file ModbusFrameCapture.h
+ * @brief Passive capture of the raw RS485 frames: a lock-free ring of the
+ *        newest kCapacity requests and responses, µs-stamped.
+ *
+ * WHY THIS EXISTS: `rs485test` sends one probe and `rs485test stats` counts
+ * outcomes, but neither shows what was actually on the wire when a field
+ * sensor misbehaves. UartModbusClient hands every frame it writes or reads
+ * to record(): the bytes (the first kMaxBytes of them), the length on the
+ * wire, whether the CRC checks out and when it happened. Late responses and
+ * gap violations then show in the time between a request and its answer,
+ * or between an answer and the next request, without a logic analyzer.
+ *
+ * WHAT A FRAME IS:
+ *   - Tx: a request, stamped when the write began;
+ *   - Rx: a response, stamped when its last byte was read (it started
+ *     `length` character times earlier). A response that never came is an
+ *     Rx frame of length 0, stamped when the wait gave up; bytes still
+ *     arriving after that are an Rx frame of their own, read just before
+ *     the next request.
+ *
+ * ONE WRITER, ANY READERS: record() runs on the bus task only (the client
+ * is ModbusBusMaster's). A slot is stored between two sequence stamps, as
+ * in TraceRing, so the console and GET /api/v1/modbus/capture read it
+ * without a lock and skip a slot being overwritten. setEnabled(false)
+ * freezes the ring (record() becomes one atomic load) so the frames around
+ * a failure are kept for reading.
+ *
+ * Target wiring only with CONFIG_WS_MODBUS_CLIENT_UART: the esp-modbus
+ * controller never exposes its raw frames. Pure C++, host-tested.
+ */
+
+#ifndef WATERINGSYSTEM_SENSORS_MODBUSFRAMECAPTURE_H
+#define WATERINGSYSTEM_SENSORS_MODBUSFRAMECAPTURE_H
+
+#include <array>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+
+/// Which way a captured frame went. Wire format of the capture dump.
+enum class ModbusFrameDir : uint8_t {
+    Tx = 0,  ///< master request
+    Rx = 1,  ///< slave response (length 0: none before the timeout)
+};
+
+/// One frame as read back.
+struct ModbusFrame {
+    static constexpr std::size_t kMaxBytes = 40;
+
+    uint32_t sequence = 0;  ///< 1-based since boot
+    uint32_t atUs = 0;      ///< monotonic, low 32 bits (wraps every ~71 min)
+    ModbusFrameDir dir = ModbusFrameDir::Tx;
+    bool crcOk = false;     ///< the last two bytes are the frame's CRC-16
+    uint16_t length = 0;    ///< bytes on the wire
+    std::array<uint8_t, kMaxBytes> bytes{};  ///< the first stored() of them
+
+    /// Bytes kept in @ref bytes: the length, capped at kMaxBytes.
+    std::size_t stored() const { return length < kMaxBytes ? length : kMaxBytes; }
+};
+
+class ModbusFrameCapture {
+public:
+    /// Frames kept: 32 request/response pairs, ~3.3 kB.
+    static constexpr std::size_t kCapacity = 64;
+
+    /// Bytes kept per frame: a request whole, and a response of up to 17
+    /// registers (a soil probe's 7-register read is 19 bytes).
+    static constexpr std::size_t kMaxBytes = ModbusFrame::kMaxBytes;
+
+    ModbusFrameCapture() = default;
+    ModbusFrameCapture(const ModbusFrameCapture&) = delete;
+    ModbusFrameCapture& operator=(const ModbusFrameCapture&) = delete;
+
+    /// Start (true, the default) or freeze (false) the capture.
+    void setEnabled(bool enabled) { enabled_.store(enabled, std::memory_order_relaxed); }
+
+    bool enabled() const { return enabled_.load(std::memory_order_relaxed); }
+
+    /**
+     * @brief Append the @p len bytes at @p data, sent or received as @p dir
+     * at @p atUs; dropped while frozen. The bus task only.
+     */
+    void record(ModbusFrameDir dir, uint32_t atUs, const uint8_t* data, std::size_t len);
+
+    /// Frames recorded since boot (the newest sequence).
+    uint32_t written() const { return written_.load(std::memory_order_acquire); }
+
+    /**
+     * @brief Copy up to @p max frames with a sequence above @p after into
+     * @p out, oldest first; frames being overwritten are skipped.
+     *
+     * Pass the last sequence read as @p after to continue from there.
+     * @return frames copied
+     */
+    std::size_t read(ModbusFrame* out, std::size_t max, uint32_t after = 0) const;
+
+private:
+    static constexpr std::size_t kWords = (kMaxBytes + 3) / 4;
+
+    struct Slot {
+        std::atomic<uint32_t> seq{0};   ///< sequence stored; 0 = being written
+        std::atomic<uint32_t> atUs{0};
+        std::atomic<uint32_t> meta{0};  ///< dir | crcOk << 8 | length << 16
+        std::array<std::atomic<uint32_t>, kWords> words{};  ///< bytes, LE-packed
+    };
+
+    std::array<Slot, kCapacity> slots_{};
+    std::atomic<uint32_t> written_{0};
+    std::atomic<bool> enabled_{true};
+};
+
+#endif /* WATERINGSYSTEM_SENSORS_MODBUSFRAMECAPTURE_H */
@@ -0,0 +1,93 @@
+// SPDX-FileCopyrightText: 2026 Cryptotomte
+// SPDX-License-Identifier: AGPL-3.0-or-later
+/**
+ * @file ModbusLinkStats.h
+ * @brief Per slave-and-function latency histograms and error taxonomy of
+ *        the RS485 bus.
+ *
+ * WHY THIS EXISTS: IModbusClient::getStatistics() says how many transfers
+ * failed, not why. A noisy cable shows up as bad frames (error 2: CRC,
+ * framing, truncated) at normal latency. A slow sensor shows up as latency
+ * creeping into the upper buckets and then as timeouts (error 3). An absent
+ * one shows up as timeouts only. Telling them apart needs the split per
+ * slave and function, kept here.
+ *
+ * Latency is the transfer time (request out to response in or timeout),
+ * in a log-bucketed histogram: 10 ms doubling to 2.56 s, then +Inf.
+ *
+ * Recorded by ModbusBusMaster for every register transfer (every
+ * transaction on the segment passes through it) under its queue mutex.
+ * The table holds kModbusLinks rows; transfers of a slave and function
+ * that find it full are counted as untracked. Pure C++, host-tested.
+ */
+
+#ifndef WATERINGSYSTEM_SENSORS_MODBUSLINKSTATS_H
+#define WATERINGSYSTEM_SENSORS_MODBUSLINKSTATS_H
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+/// Finite latency buckets; bucket i ends at kModbusLatencyBaseUs << i.
+constexpr std::size_t kModbusLatencyBuckets = 9;
+constexpr uint32_t kModbusLatencyBaseUs = 10000;
+
+/// Rows of the table: eight slaves × read and write.
+constexpr std::size_t kModbusLinks = 16;
+
+/// Modbus function codes of the transfers recorded.
+constexpr uint8_t kModbusReadHolding = 0x03;
+constexpr uint8_t kModbusWriteSingle = 0x06;
+constexpr uint8_t kModbusWriteMultiple = 0x10;
+
+/// What one slave and function has seen since boot.
+struct ModbusLinkStats {
+    uint8_t address = 0;
+    uint8_t function = 0;              ///< kModbusReadHolding / ...WriteSingle / ...WriteMultiple
+    uint32_t ok = 0;
+    uint32_t timeouts = 0;             ///< error 3: no answer
+    uint32_t frameErrors = 0;          ///< error 2: CRC, framing, bad response
+    uint32_t exceptions = 0;           ///< 100+n: the slave refused
+    uint32_t otherErrors = 0;          ///< anything else (not initialized, ...)
+    /// Per-bucket (not cumulative) counts; the last entry is +Inf.
+    std::array<uint32_t, kModbusLatencyBuckets + 1> latency{};
+    uint64_t latencySumUs = 0;
+    int64_t lastSuccessUs = -1;        ///< bus-master clock; -1 = never
+
+    uint32_t transfers() const { return ok + timeouts + frameErrors + exceptions + otherErrors; }
+};
+
+/// The histogram bucket @p latencyUs falls in.
+std::size_t modbusLatencyBucket(uint64_t latencyUs);
+
+/**
+ * @brief Upper bound of the bucket holding the @p permille quantile of
+ * @p link's latencies.
+ * @return µs; UINT32_MAX when it is the +Inf bucket; 0 with no transfers
+ */
+uint32_t modbusLatencyQuantileUs(const ModbusLinkStats& link, uint32_t permille);
+
+class ModbusLinkTable {
+public:
+    /**
+     * @brief Count one transfer.
+     * @param error     the client's getLastError() (0 = ok)
+     * @param latencyUs transfer time; negative counts as 0
+     * @param nowUs     when it ended (for lastSuccessUs)
+     */
+    void record(uint8_t address, uint8_t function, int error, int64_t latencyUs,
+                int64_t nowUs);
+
+    /// Rows in first-seen order.
+    std::vector<ModbusLinkStats> snapshot() const;
+
+    uint32_t untracked() const { return untracked_; }
+
+private:
+    std::array<ModbusLinkStats, kModbusLinks> links_{};
+    std::size_t count_ = 0;
+    uint32_t untracked_ = 0;
+};
+
+#endif /* WATERINGSYSTEM_SENSORS_MODBUSLINKSTATS_H */
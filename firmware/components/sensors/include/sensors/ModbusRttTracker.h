@@ -0,0 +1,111 @@
+// SPDX-FileCopyrightText: 2026 Cryptotomte
+// SPDX-License-Identifier: AGPL-3.0-or-later
+/**
+ * @file ModbusRttTracker.h
+ * @brief Per-slave response-time tracking and the adaptive response
+ *        timeout derived from it.
+ *
+ * WHY THIS EXISTS: the parity response timeout is 3000 ms, while a healthy
+ * probe answers a 9-register read in about 50 ms. With the fixed value an
+ * unplugged sensor costs its caller three seconds per read. Here every
+ * answered request is a round-trip sample for its slave. The timeout for
+ * the next request to that slave follows from them:
+ *
+ *   max(SRTT + 4·RTTVAR, 1.5 × p95), clamped to [kFloorMs, kCeilingMs]
+ *
+ * SRTT/RTTVAR is the Jacobson/Karels EWMA pair (gains 1/8 and 1/4), which
+ * follows drift. p95 is the 95th percentile of the last kWindow samples,
+ * which keeps a probe that is occasionally slow from being cut off.
+ *
+ * FALLBACK: a slave only timing out might be slow rather than gone, and
+ * the tight timeout would never let a slow answer in. After kFallbackAfter
+ * consecutive timeouts the next request gets the configured timeout
+ * (setConfigured(), the parity 3000 ms). The same happens whenever the
+ * count doubles again (3, 6, 12, 24, 48), and after that every
+ * kFallbackAfter × kMaxBackoff timeouts. An absent slave therefore pays the
+ * long wait rarely, and a slow one is re-learned from its first answer.
+ * A slave with no samples yet gets the configured timeout for its first
+ * request, then kCeilingMs.
+ *
+ * Any answer counts as a sample, including an exception or a bad CRC: the
+ * slave replied. Only timeouts drive the fallback. The table holds
+ * kMaxSlaves slaves; a new one takes the least recently used slot.
+ *
+ * Unsynchronized, like the client it serves (only ever called with the
+ * bus held). Pure C++, host-tested; EspModbusClient does the timing.
+ */
+
+#ifndef WATERINGSYSTEM_SENSORS_MODBUSRTTTRACKER_H
+#define WATERINGSYSTEM_SENSORS_MODBUSRTTTRACKER_H
+
+#include <cstddef>
+#include <cstdint>
+
+/// What the tracker knows about one slave (ModbusRttTracker::slave()).
+struct ModbusSlaveRtt {
+    uint8_t address = 0;
+    uint32_t samples = 0;              ///< answers seen (saturating)
+    uint32_t srttUs = 0;               ///< smoothed round trip
+    uint32_t rttvarUs = 0;             ///< smoothed mean deviation
+    uint32_t p95Us = 0;                ///< over the last kWindow answers
+    uint32_t consecutiveTimeouts = 0;
+    uint32_t timeoutMs = 0;            ///< timeoutFor() this slave, now
+};
+
+class ModbusRttTracker {
+public:
+    static constexpr std::size_t kMaxSlaves = 8;
+    static constexpr std::size_t kWindow = 16;      ///< samples behind p95
+    static constexpr uint32_t kFloorMs = 150;       ///< never tighter
+    static constexpr uint32_t kCeilingMs = 1000;    ///< adaptive never looser
+    static constexpr uint32_t kFallbackAfter = 3;   ///< timeouts in a row
+    static constexpr uint32_t kMaxBackoff = 16;     ///< cap on the doubling
+
+    /// @p configuredMs is the caller's response timeout (the fallback).
+    explicit ModbusRttTracker(uint32_t configuredMs) : configuredMs_(configuredMs) {}
+
+    void setConfigured(uint32_t configuredMs) { configuredMs_ = configuredMs; }
+    uint32_t configured() const { return configuredMs_; }
+
+    /// Response timeout for the next request to @p address.
+    uint32_t timeoutFor(uint8_t address) const;
+
+    /// @p address answered (any response) after @p rttUs.
+    void recordAnswer(uint8_t address, uint32_t rttUs);
+
+    /// @p address did not answer within the timeout it was given.
+    void recordTimeout(uint8_t address);
+
+    /// Forget every slave (the line rate changed: old round trips are off).
+    void reset() { count_ = 0; }
+
+    /// Slaves tracked right now (at most kMaxSlaves).
+    std::size_t size() const { return count_; }
+
+    /// Snapshot of tracked slave @p index (0..size()-1).
+    ModbusSlaveRtt slave(std::size_t index) const;
+
+private:
+    struct Slot {
+        uint8_t address = 0;
+        uint32_t samples = 0;
+        uint32_t srttUs = 0;
+        uint32_t rttvarUs = 0;
+        uint32_t window[kWindow] = {};
+        std::size_t windowNext = 0;
+        uint32_t consecutiveTimeouts = 0;
+        uint32_t lastUse = 0;
+    };
+
+    const Slot* find(uint8_t address) const;
+    Slot& slotFor(uint8_t address);
+    uint32_t timeoutFor(const Slot& slot) const;
+    static uint32_t p95(const Slot& slot);
+
+    uint32_t configuredMs_;
+    Slot slots_[kMaxSlaves];
+    std::size_t count_ = 0;
+    uint32_t useClock_ = 0;
+};
+
+#endif /* WATERINGSYSTEM_SENSORS_MODBUSRTTTRACKER_H */
@@ -0,0 +1,96 @@
+// SPDX-FileCopyrightText: 2026 Cryptotomte
+// SPDX-License-Identifier: AGPL-3.0-or-later
+/**
+ * @file ModbusRtuFrame.h
+ * @brief Modbus RTU framing for the functions the firmware uses: 0x03 read
+ *        holding registers, 0x06 write single register and 0x10 write
+ *        multiple registers.
+ *
+ * The UartModbusClient builds its requests here and checks its responses
+ * here, so everything but the UART calls is host-tested. CRC-16/MODBUS
+ * (poly 0xA001 reflected, init 0xFFFF, low byte first on the wire) runs
+ * from a 256-entry table built at compile time.
+ *
+ * Response checks return IModbusClient error codes: 0 OK, 2 bad frame
+ * (CRC, length, address, function, byte count, or a write echo that does
+ * not match the request), 100+n for slave exception n. A slave exception
+ * is reported with its code, which the esp-modbus client cannot do (the
+ * parity divergence of research.md R6). The full FC06 echo is compared,
+ * as the legacy client did, and so are FC16's start and count.
+ */
+
+#ifndef WATERINGSYSTEM_SENSORS_MODBUSRTUFRAME_H
+#define WATERINGSYSTEM_SENSORS_MODBUSRTUFRAME_H
+
+#include <cstddef>
+#include <cstdint>
+
+/// Bytes of a 0x03 or 0x06 request (and of a 0x06 response).
+constexpr std::size_t kModbusRequestBytes = 8;
+
+/// Bytes of an exception response: address, function | 0x80, code, CRC.
+constexpr std::size_t kModbusExceptionBytes = 5;
+
+/// Registers one 0x03 read may ask for (Modbus application protocol).
+constexpr uint16_t kModbusMaxReadRegisters = 125;
+
+/// Largest response handled: a 0x03 response with kModbusMaxReadRegisters.
+constexpr std::size_t kModbusMaxResponseBytes = 5 + 2 * kModbusMaxReadRegisters;
+
+/// Registers one 0x10 write may carry (Modbus application protocol).
+constexpr uint16_t kModbusMaxWriteRegisters = 123;
+
+/// Bytes of a 0x10 request with @p count registers.
+constexpr std::size_t modbusWriteMultipleRequestBytes(uint16_t count)
+{
+    return 9 + 2 * static_cast<std::size_t>(count);
+}
+
+/// Largest request built: a 0x10 request with kModbusMaxWriteRegisters.
+constexpr std::size_t kModbusMaxRequestBytes =
+    modbusWriteMultipleRequestBytes(kModbusMaxWriteRegisters);
+
+/// CRC-16/MODBUS of @p len bytes.
+uint16_t modbusCrc16(const uint8_t* data, std::size_t len);
+
+/// 0x03 request into @p out (kModbusRequestBytes).
+void buildReadHoldingRequest(uint8_t address, uint16_t startRegister, uint16_t count,
+                             uint8_t* out);
+
+/// 0x06 request into @p out (kModbusRequestBytes).
+void buildWriteSingleRequest(uint8_t address, uint16_t registerAddress, uint16_t value,
+                             uint8_t* out);
+
+/**
+ * @brief 0x10 request for @p count (1..kModbusMaxWriteRegisters) values
+ * into @p out (modbusWriteMultipleRequestBytes(count)).
+ * @return bytes written
+ */
+std::size_t buildWriteMultipleRequest(uint8_t address, uint16_t startRegister,
+                                      uint16_t count, const uint16_t* values, uint8_t* out);
+
+/**
+ * @brief Length of the response @p function will get, given the
+ * @p receivedLen bytes received so far: the minimum (an exception's)
+ * until the header tells.
+ */
+std::size_t modbusExpectedResponseBytes(uint8_t function, const uint8_t* received,
+                                        std::size_t receivedLen);
+
+/**
+ * @brief Check a 0x03 response and decode its registers into @p out
+ * (written only on success).
+ * @return 0, 2 or 100+n (see the file comment)
+ */
+int parseReadHoldingResponse(const uint8_t* frame, std::size_t len, uint8_t address,
+                             uint16_t count, uint16_t* out);
+
+/// Check a 0x06 response against the request it answers.
+int parseWriteSingleResponse(const uint8_t* frame, std::size_t len, uint8_t address,
+                             uint16_t registerAddress, uint16_t value);
+
+/// Check a 0x10 response against the request it answers.
+int parseWriteMultipleResponse(const uint8_t* frame, std::size_t len, uint8_t address,
+                               uint16_t startRegister, uint16_t count);
+
+#endif /* WATERINGSYSTEM_SENSORS_MODBUSRTUFRAME_H */
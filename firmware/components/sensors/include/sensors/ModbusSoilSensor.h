@@ -34,6 +34,9 @@
  * One read() = one 9-register transaction (0x0000–0x0008), decoded, scaled
  * and range-validated atomically: on any failure the last-good getter
  * values remain untouched and getLastError() carries the cause.
+ * readGroup() narrows that to 2 registers (fast: moisture + temperature,
+ * validated as in read()) or 5 (slow: EC, pH, N, P, K; pH validated); the
+ * other group's values are cached from their last good read.
  */
 class ModbusSoilSensor : public ISoilSensor {
 public:
@@ -59,6 +62,7 @@ public:
     // ISoilSensor
     bool initialize() override;
     bool read() override;
+    bool readGroup(SoilReadGroup group) override;
     SoilSnapshot snapshot() override;
     bool isAvailable() override;
     int getLastError() override;
@@ -96,6 +100,9 @@ private:
 
     /// One transaction covers registers 0x0000–0x0008.
     static constexpr uint16_t kReadRegisterCount = 9;
+    /// Group reads: 0x0000–0x0001 (fast), 0x0002–0x0006 (slow).
+    static constexpr uint16_t kFastRegisterCount = 2;
+    static constexpr uint16_t kSlowRegisterCount = 5;
 
     // Fixed parity validation ranges (the legacy setValidRange defaults;
     // runtime range changes were trimmed — see interfaces/ISoilSensor.h).
@@ -129,6 +136,9 @@ private:
     // so the last-good values are known to be meaningful (available).
     bool lastReadOk_ = false;
     bool hasEverReadOk_ = false;
+    // The same pair for the reads that covered the slow group.
+    bool slowReadOk_ = false;
+    bool slowEverReadOk_ = false;
 
     // Last-good reading (published only by a fully successful read()).
     float moisture_ = 0.0f;
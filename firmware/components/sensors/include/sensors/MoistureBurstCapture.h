@@ -0,0 +1,115 @@
+// SPDX-FileCopyrightText: 2026 Cryptotomte
+// SPDX-License-Identifier: AGPL-3.0-or-later
+/**
+ * @file MoistureBurstCapture.h
+ * @brief High-rate primary-probe moisture during a watering burst, held in
+ *        RAM and written to the history in one batch.
+ *
+ * WHY THIS EXISTS: the sensor-read interval shows one or two moisture
+ * points per burst, not the infiltration curve the burst sizing
+ * (MoistureResponse) learns from. While the plant pump runs, and for a
+ * tail after it stops, the soil task reads the probe's fast group back to
+ * back (main/soil_task.cpp) and hands every published sample here.
+ *
+ * The history resolves whole epoch seconds, so the reads of one second
+ * are averaged into one entry of a fixed ring of kSeconds (the oldest
+ * second is overwritten and counted when a capture outgrows it). When the
+ * tail ends, the ring goes to the storage as ONE storeSensorReadings()
+ * batch under kMetric — one commit, one fsync per chunk file touched —
+ * instead of a flash append per read. A separate metric keeps the
+ * regular soil_moisture history in epoch order (the controller keeps
+ * logging it during the burst). Samples taken before the wall clock is set
+ * are skipped, like the data log's.
+ *
+ * No allocation after construction; soil task only (no locking). Pure
+ * C++, host-tested.
+ */
+
+#ifndef WATERINGSYSTEM_SENSORS_MOISTUREBURSTCAPTURE_H
+#define WATERINGSYSTEM_SENSORS_MOISTUREBURSTCAPTURE_H
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+#include "interfaces/IDataStorage.h"
+#include "interfaces/ISoilFeed.h"
+#include "interfaces/IWallClock.h"
+
+/// Bookkeeping of the captures so far.
+struct BurstCaptureStats {
+    uint32_t captures = 0;     ///< captures flushed since boot
+    uint32_t reads = 0;        ///< good reads in the last capture
+    uint32_t seconds = 0;      ///< seconds the last flush stored
+    uint32_t overwritten = 0;  ///< seconds the last capture's ring dropped
+    uint32_t failed = 0;       ///< flushes that stored fewer than they held
+};
+
+class MoistureBurstCapture {
+public:
+    /// Ring depth in seconds: a 300 s burst (the pump cap) plus a tail of
+    /// a few minutes.
+    static constexpr std::size_t kSeconds = 512;
+
+    /// History metric of the captures (short enough for std::string's
+    /// inline buffer, so the batch never allocates).
+    static constexpr const char* kMetric = "burst_moisture";
+
+    /**
+     * @param storage Where a finished capture is written (the soil task
+     *                calls into it; pass the lock-guarded storage, not a
+     *                writer queue shallower than kSeconds).
+     * @param clock   Epoch of each second.
+     * @param tailMs  How long to keep capturing after the pump stops.
+     */
+    MoistureBurstCapture(IDataStorage& storage, const IWallClock& clock, int64_t tailMs);
+
+    MoistureBurstCapture(const MoistureBurstCapture&) = delete;
+    MoistureBurstCapture& operator=(const MoistureBurstCapture&) = delete;
+
+    /**
+     * @brief Advance with the pump state at @p nowMs.
+     *
+     * A start opens a capture (a start within the tail continues it), a
+     * stop opens the tail, and the end of the tail flushes the ring.
+     * @return true while capturing (the caller reads at the high rate).
+     */
+    bool update(bool pumpRunning, int64_t nowMs);
+
+    /// Fold in a published sample; ignored between captures and for a
+    /// failed or slow-group-only read.
+    void add(const TimedSoilSnapshot& sample);
+
+    bool capturing() const { return state_ != State::Idle; }
+
+    BurstCaptureStats stats() const { return stats_; }
+
+private:
+    enum class State : uint8_t { Idle, Running, Tail };
+
+    struct Second {
+        uint32_t epoch = 0;
+        float mean = 0.0f;
+        uint32_t reads = 0;
+    };
+
+    /// Write the ring out as one batch and empty it.
+    void flush();
+
+    IDataStorage& storage_;
+    const IWallClock& clock_;
+    const int64_t tailMs_;
+
+    State state_ = State::Idle;
+    int64_t tailEndMs_ = 0;
+    std::array<Second, kSeconds> ring_{};
+    std::size_t head_ = 0;  ///< oldest second
+    std::size_t size_ = 0;
+    /// kSeconds readings named kMetric, allocated once; flush() fills in
+    /// epoch and value.
+    std::vector<SensorReading> batch_;
+    BurstCaptureStats stats_;
+};
+
+#endif /* WATERINGSYSTEM_SENSORS_MOISTUREBURSTCAPTURE_H */
@@ -0,0 +1,60 @@
+// SPDX-FileCopyrightText: 2026 Cryptotomte
+// SPDX-License-Identifier: AGPL-3.0-or-later
+/**
+ * @file PcntPulseCounter.h
+ * @brief IPulseCounter on an ESP32 PCNT unit (flow-meter input).
+ *
+ * ESP32-ONLY: excluded from the linux-target build (see this component's
+ * CMakeLists.txt). The pulse counter counts rising edges of one GPIO in
+ * hardware, through its glitch filter; the 16-bit unit is extended by the
+ * driver's accumulator (a watch point at the high limit — one interrupt
+ * per kHighLimit pulses, never one per pulse), so pulses() is a plain
+ * register read plus that offset.
+ *
+ * PRIV rule (this component's convention): driver/pulse_cnt.h appears only
+ * in the .cpp — the unit handle is held as an opaque pointer.
+ */
+
+#ifndef WATERINGSYSTEM_SENSORS_PCNTPULSECOUNTER_H
+#define WATERINGSYSTEM_SENSORS_PCNTPULSECOUNTER_H
+
+#include <cstdint>
+
+#include "interfaces/IPulseCounter.h"
+
+class PcntPulseCounter final : public IPulseCounter {
+public:
+    /// Hardware count between two accumulator interrupts.
+    static constexpr int kHighLimit = 32767;
+
+    /// Pulses shorter than this are filtered out (contact bounce, EMI from
+    /// the pump motor); a flow meter pulses well under 1 kHz.
+    static constexpr uint32_t kGlitchNs = 10'000;
+
+    /// Count on @p pin (from Kconfig). No hardware access — call initialize().
+    explicit PcntPulseCounter(int pin) : pin_(pin) {}
+
+    ~PcntPulseCounter() override;
+
+    PcntPulseCounter(const PcntPulseCounter&) = delete;
+    PcntPulseCounter& operator=(const PcntPulseCounter&) = delete;
+
+    /**
+     * @brief Allocate a unit and a channel on the pin (input, pull-up for
+     * the meter's open-collector output where the pin has one), clear and
+     * start it.
+     *
+     * @return false (logged) leaves pulses() at 0.
+     */
+    bool initialize();
+
+    /// Accumulated count (0 before a successful initialize()).
+    uint32_t pulses() override;
+
+private:
+    int pin_;
+    void* unit_ = nullptr;     ///< opaque pcnt_unit_handle_t
+    void* channel_ = nullptr;  ///< opaque pcnt_channel_handle_t
+};
+
+#endif /* WATERINGSYSTEM_SENSORS_PCNTPULSECOUNTER_H */
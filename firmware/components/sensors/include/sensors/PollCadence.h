@@ -0,0 +1,137 @@
+// SPDX-FileCopyrightText: 2026 Cryptotomte
+// SPDX-License-Identifier: AGPL-3.0-or-later
+/**
+ * @file PollCadence.h
+ * @brief Pure adaptive poll-interval policy of the sensor and soil tasks
+ *        (header-only).
+ *
+ * A fixed cadence reads the sensors as often overnight, with nothing
+ * changing and no watering possible, as during a watering run. The policy
+ * picks each next interval from the last poll:
+ *
+ *   active  (a pump runs)       → activeMs, and the backoff restarts;
+ *   changed (value moved)       → baseMs;
+ *   stable  (kStableBeforeBackoff polls in a row, then every poll)
+ *                               → the interval doubles, up to maxStableMs;
+ *   failed  (second failure in a row on)
+ *                               → the interval doubles, up to maxFailingMs.
+ *
+ * Every result lies in [min(activeMs, baseMs), max(baseMs, maxStableMs,
+ * maxFailingMs)]. Limits with both maxima equal to baseMs reproduce a
+ * fixed cadence. Like SensorTaskLogPolicy it decides, the task sleeps;
+ * it stays free of IDF/FreeRTOS includes so the host tests build it.
+ */
+
+#ifndef WATERINGSYSTEM_SENSORS_POLLCADENCE_H
+#define WATERINGSYSTEM_SENSORS_POLLCADENCE_H
+
+#include <cmath>
+#include <cstdint>
+
+/// Interval bounds, milliseconds.
+struct PollCadenceLimits {
+    uint32_t activeMs;      ///< while a pump runs
+    uint32_t baseMs;        ///< after a change (the configured cadence)
+    uint32_t maxStableMs;   ///< backoff ceiling while values hold still
+    uint32_t maxFailingMs;  ///< backoff ceiling while reads keep failing
+};
+
+class PollCadence {
+public:
+    /// What the last poll saw.
+    enum class Outcome {
+        Changed,  ///< a read moved past its change threshold
+        Stable,   ///< a read within the thresholds of the reference
+        Failed,   ///< the read failed
+    };
+
+    /// Stable polls at baseMs before the interval starts doubling.
+    static constexpr uint32_t kStableBeforeBackoff = 3;
+
+    explicit PollCadence(const PollCadenceLimits& limits) : limits_(limits)
+    {
+        intervalMs_ = limits_.baseMs;
+    }
+
+    /// New bounds (a changed configured interval); the backoff restarts.
+    void setLimits(const PollCadenceLimits& limits)
+    {
+        limits_ = limits;
+        restart(limits_.baseMs);
+    }
+
+    /**
+     * @brief Record one poll and return the interval until the next.
+     *
+     * @param active  Whether a pump is running now.
+     * @param outcome What the poll read.
+     */
+    uint32_t next(bool active, Outcome outcome)
+    {
+        if (active) {
+            restart(limits_.activeMs);
+            return intervalMs_;
+        }
+        switch (outcome) {
+        case Outcome::Changed:
+            restart(limits_.baseMs);
+            break;
+        case Outcome::Stable:
+            if (failures_ > 0 || intervalMs_ < limits_.baseMs) {
+                restart(limits_.baseMs);  // recovered, or the pump stopped
+            }
+            if (++stable_ > kStableBeforeBackoff) {
+                intervalMs_ = doubled(intervalMs_, limits_.maxStableMs);
+            }
+            break;
+        case Outcome::Failed:
+            stable_ = 0;
+            // The first failure retries at the base cadence: most are one
+            // lost frame.
+            intervalMs_ = ++failures_ > 1
+                              ? doubled(intervalMs_, limits_.maxFailingMs)
+                              : limits_.baseMs;
+            break;
+        }
+        return intervalMs_;
+    }
+
+    /// The interval next() last returned (baseMs before the first poll).
+    uint32_t intervalMs() const { return intervalMs_; }
+
+    /// Whether @p value moved more than @p threshold from @p reference;
+    /// a moved value becomes the new reference, so slow drift adds up. A
+    /// NaN reference (nothing read yet) always counts as moved.
+    static bool moved(float value, float& reference, float threshold)
+    {
+        if (!std::isnan(reference) &&
+            !(std::fabs(value - reference) > threshold)) {
+            return false;
+        }
+        reference = value;
+        return true;
+    }
+
+private:
+    void restart(uint32_t intervalMs)
+    {
+        intervalMs_ = intervalMs;
+        stable_ = 0;
+        failures_ = 0;
+    }
+
+    uint32_t doubled(uint32_t intervalMs, uint32_t ceilingMs) const
+    {
+        const uint32_t base = limits_.baseMs;
+        const uint32_t from = intervalMs < base ? base : intervalMs;
+        const uint32_t ceiling = ceilingMs < base ? base : ceilingMs;
+        return from >= ceiling / 2 ? ceiling : from * 2;
+    }
+
+    PollCadenceLimits limits_;
+    uint32_t intervalMs_ = 0;
+    uint32_t stable_ = 0;
+    uint32_t failures_ = 0;
+};
+
+#endif /* WATERINGSYSTEM_SENSORS_POLLCADENCE_H */
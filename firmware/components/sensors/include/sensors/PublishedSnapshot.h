@@ -0,0 +1,48 @@
+// SPDX-FileCopyrightText: 2026 Cryptotomte
+// SPDX-License-Identifier: AGPL-3.0-or-later
+/**
+ * @file PublishedSnapshot.h
+ * @brief The Locked sensor decorators' lock-free reading copy (header-only).
+ *
+ * The decorator republishes its sensor's snapshot after every call that can
+ * change it (still under the sensor mutex, so publishes stay in call order)
+ * and serves getters and snapshot() from here. A SnapshotPublisher holds the
+ * copy; the small publish mutex only serializes stores from callers that do
+ * not already hold one lock (EnergyMeter, PumpCurrentCapture). Readers take
+ * no lock at all, so a reader never waits for a read in progress.
+ */
+
+#ifndef WATERINGSYSTEM_SENSORS_PUBLISHEDSNAPSHOT_H
+#define WATERINGSYSTEM_SENSORS_PUBLISHEDSNAPSHOT_H
+
+#include <cstdint>
+#include <mutex>
+
+#include "interfaces/SnapshotPublisher.h"
+#include "interfaces/StaticMutex.h"
+
+template <typename T>
+class PublishedSnapshot {
+public:
+    explicit PublishedSnapshot(const T& initial) : publisher_(initial) {}
+
+    PublishedSnapshot(const PublishedSnapshot&) = delete;
+    PublishedSnapshot& operator=(const PublishedSnapshot&) = delete;
+
+    void publish(const T& value)
+    {
+        std::lock_guard<StaticMutex> lock(mutex_);
+        publisher_.publish(value);
+    }
+
+    T load() const { return publisher_.load(); }
+
+    /// Changes published so far (SnapshotPublisher::version()).
+    uint32_t version() const { return publisher_.version(); }
+
+private:
+    SnapshotPublisher<T> publisher_;
+    StaticMutex mutex_;  ///< publish only, never across bus I/O
+};
+
+#endif /* WATERINGSYSTEM_SENSORS_PUBLISHEDSNAPSHOT_H */
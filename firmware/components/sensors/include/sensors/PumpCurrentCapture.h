@@ -0,0 +1,130 @@
+// SPDX-FileCopyrightText: 2026 Cryptotomte
+// SPDX-License-Identifier: AGPL-3.0-or-later
+/**
+ * @file PumpCurrentCapture.h
+ * @brief Pump current waveform capture: a lock-free sample ring plus
+ *        per-run peak / mean / RMS.
+ *
+ * WHY THIS EXISTS: the 5 s telemetry poll sees one current value per
+ * watering burst, which shows neither the inrush spike at switch-on nor
+ * the sag of a dry-running pump or the rise of a blocked impeller. While
+ * a pump runs, the capture task (main/power_capture_task.cpp) reads the
+ * INA226 current at its high-rate conversion period (~1 kHz) and hands
+ * every sample here.
+ *
+ * TWO OUTPUTS:
+ *   - the raw samples go into an SpscRing (capture task = producer,
+ *     GET /api/v1/power/capture on the httpd task = consumer), tagged with
+ *     their run number; a sample the reader has not made room for is
+ *     dropped and counted, never blocking the capture;
+ *   - peak, mean and RMS accumulate online over EVERY sample of the run,
+ *     ring or no ring, and endRun() returns them (the task logs them as a
+ *     pump event) and publishes them as lastRun().
+ *
+ * Samples are whole milliamps (the INA226 resolves 0.5 mA), one per
+ * nominal period; a failed read or a missed period keeps its slot as
+ * kMissingSample, so sample n of a run is always at n × periodUs.
+ *
+ * Pure C++, host-tested; the task and the HTTP handler are target code.
+ */
+
+#ifndef WATERINGSYSTEM_SENSORS_PUMPCURRENTCAPTURE_H
+#define WATERINGSYSTEM_SENSORS_PUMPCURRENTCAPTURE_H
+
+#include <atomic>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+
+#include "interfaces/SpscRing.h"
+#include "sensors/PublishedSnapshot.h"
+
+/// One ring entry: the run it belongs to and its current.
+struct CaptureSample {
+    uint16_t run = 0;       ///< low 16 bits of CurrentRunStats::run
+    int16_t milliamps = 0;  ///< PumpCurrentCapture::kMissingSample = no value
+};
+
+/// Summary of one captured pump run.
+struct CurrentRunStats {
+    uint32_t run = 0;         ///< 1, 2, ... since boot; 0 = none captured yet
+    uint32_t periodUs = 0;    ///< nominal time between two samples
+    uint32_t durationMs = 0;  ///< beginRun() to endRun()
+    uint32_t samples = 0;     ///< valid samples in the statistics
+    uint32_t missed = 0;      ///< periods without a value (read failed or late)
+    uint32_t dropped = 0;     ///< samples the ring had no room for
+    float peakA = NAN;        ///< highest current
+    float meanA = NAN;
+    float rmsA = NAN;
+};
+
+class PumpCurrentCapture {
+public:
+    /// Ring depth: ~2.3 s at the 1.12 ms INA226 capture period, so a
+    /// client polling every second keeps up with a run.
+    static constexpr std::size_t kRingSamples = 2048;
+
+    /// CaptureSample::milliamps of a period without a reading.
+    static constexpr int16_t kMissingSample = INT16_MIN;
+
+    PumpCurrentCapture() : last_(CurrentRunStats{}) {}
+
+    PumpCurrentCapture(const PumpCurrentCapture&) = delete;
+    PumpCurrentCapture& operator=(const PumpCurrentCapture&) = delete;
+
+    // -- Producer (the capture task only) ---------------------------------
+
+    /// Start a run sampled every @p periodUs; ends any run still open.
+    void beginRun(uint32_t periodUs, int64_t nowUs);
+
+    /// The next period's current in A (non-finite = a missed period).
+    void addSample(float amps);
+
+    /// @p count periods passed without a reading.
+    void addMissed(uint32_t count = 1);
+
+    /// Close the run, publish and return its summary. No run open: returns
+    /// an empty summary (run 0) and publishes nothing.
+    CurrentRunStats endRun(int64_t nowUs);
+
+    // -- Consumer (one reader task only) ----------------------------------
+
+    /// Move up to @p max of the oldest samples to @p out; returns the count.
+    std::size_t drain(CaptureSample* out, std::size_t max)
+    {
+        return ring_.pop(out, max);
+    }
+
+    // -- Any task -----------------------------------------------------------
+
+    /// The run being captured, 0 between runs.
+    uint32_t activeRun() const { return active_.load(std::memory_order_acquire); }
+
+    /// Sample period of the current (or last) run; 0 before the first.
+    uint32_t periodUs() const { return periodUs_.load(std::memory_order_relaxed); }
+
+    /// Samples dropped on a full ring since boot.
+    uint32_t droppedTotal() const { return droppedTotal_.load(std::memory_order_relaxed); }
+
+    /// Summary of the last finished run (run 0 before the first).
+    CurrentRunStats lastRun() const { return last_.load(); }
+
+private:
+    /// Queue one ring entry; counts a drop when full.
+    void push(int16_t milliamps);
+
+    SpscRing<CaptureSample, kRingSamples> ring_;
+    PublishedSnapshot<CurrentRunStats> last_;
+    std::atomic<uint32_t> active_{0};
+    std::atomic<uint32_t> periodUs_{0};
+    std::atomic<uint32_t> droppedTotal_{0};
+
+    // Producer-only state of the open run.
+    uint32_t nextRun_ = 1;
+    int64_t startUs_ = 0;
+    CurrentRunStats stats_;
+    double sum_ = 0.0;
+    double sumSquares_ = 0.0;
+};
+
+#endif /* WATERINGSYSTEM_SENSORS_PUMPCURRENTCAPTURE_H */
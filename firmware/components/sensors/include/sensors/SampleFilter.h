@@ -0,0 +1,200 @@
+// SPDX-FileCopyrightText: 2026 Cryptotomte
+// SPDX-License-Identifier: AGPL-3.0-or-later
+/**
+ * @file SampleFilter.h
+ * @brief Streaming filters for one sensor metric: rate-of-change outlier
+ *        gate, small median window, EWMA (header-only).
+ *
+ * A raw reading that passed the sensor's range check can still be a
+ * single-sample spike (a loose probe contact, a Modbus frame from a
+ * settling probe) — one of those crossing a moisture threshold starts or
+ * stops a watering burst on its own. SampleFilter chains, per metric:
+ *
+ *   gate   — a sample further from the last accepted one than
+ *            maxRatePerS × elapsed time is rejected; a change that keeps
+ *            failing the gate for more than maxRejects samples in a row is
+ *            a real step and passes;
+ *   median — over the last medianWindow accepted samples (odd, small);
+ *   EWMA   — out = out + ewmaAlpha × (median − out).
+ *
+ * Fixed-size state, no allocation, no locking (owned by one task); each
+ * stage is off at its neutral setting (rate 0, window 1, alpha 1).
+ */
+
+#ifndef WATERINGSYSTEM_SENSORS_SAMPLEFILTER_H
+#define WATERINGSYSTEM_SENSORS_SAMPLEFILTER_H
+
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+
+/// Per-metric settings; the defaults pass every sample through unchanged.
+struct FilterSettings {
+    uint8_t medianWindow = 1;   ///< samples, odd; clamped to the capacity
+    float ewmaAlpha = 1.0f;     ///< new-sample weight in (0, 1]; 1 = off
+    float maxRatePerS = 0.0f;   ///< gate limit, units per second; 0 = off
+    uint8_t maxRejects = 2;     ///< consecutive rejections before a step passes
+};
+
+/// Median of the last (up to) Capacity values.
+template <std::size_t Capacity>
+class MedianWindow {
+public:
+    static_assert(Capacity % 2 == 1, "an odd window has a middle sample");
+
+    explicit MedianWindow(std::size_t window = Capacity)
+        : window_(window == 0 ? 1 : window > Capacity ? Capacity : window)
+    {
+    }
+
+    void reset() { count_ = 0; next_ = 0; }
+
+    /// Add @p value and return the median of the samples held.
+    float push(float value)
+    {
+        values_[next_] = value;
+        next_ = (next_ + 1) % window_;
+        if (count_ < window_) {
+            ++count_;
+        }
+        float sorted[Capacity];
+        for (std::size_t i = 0; i < count_; ++i) {
+            // Insertion sort: a handful of samples.
+            std::size_t j = i;
+            for (; j > 0 && sorted[j - 1] > values_[i]; --j) {
+                sorted[j] = sorted[j - 1];
+            }
+            sorted[j] = values_[i];
+        }
+        // An even fill (window still filling) takes the mean of the middle two.
+        return count_ % 2 == 1
+                   ? sorted[count_ / 2]
+                   : 0.5f * (sorted[count_ / 2 - 1] + sorted[count_ / 2]);
+    }
+
+private:
+    std::size_t window_;
+    std::size_t count_ = 0;
+    std::size_t next_ = 0;
+    float values_[Capacity] = {};
+};
+
+/// Exponentially weighted moving average; the first sample seeds it.
+class Ewma {
+public:
+    explicit Ewma(float alpha = 1.0f)
+        : alpha_(!(alpha > 0.0f) ? 1.0f : alpha > 1.0f ? 1.0f : alpha)
+    {
+    }
+
+    void reset() { seeded_ = false; }
+
+    float push(float value)
+    {
+        value_ = seeded_ ? value_ + alpha_ * (value - value_) : value;
+        seeded_ = true;
+        return value_;
+    }
+
+private:
+    float alpha_;
+    float value_ = 0.0f;
+    bool seeded_ = false;
+};
+
+/// Rate-of-change outlier gate against the last accepted sample.
+class RateGate {
+public:
+    RateGate(float maxRatePerS = 0.0f, uint8_t maxRejects = 2)
+        : maxRatePerS_(maxRatePerS > 0.0f ? maxRatePerS : 0.0f),
+          maxRejects_(maxRejects)
+    {
+    }
+
+    void reset() { seeded_ = false; rejects_ = 0; }
+
+    /// Whether @p value at @p atMs passes (it becomes the reference).
+    bool accept(float value, int64_t atMs)
+    {
+        if (seeded_ && maxRatePerS_ > 0.0f) {
+            const int64_t dtMs = atMs > lastMs_ ? atMs - lastMs_ : 1;
+            const float limit = maxRatePerS_ * static_cast<float>(dtMs) / 1000.0f;
+            if (std::fabs(value - last_) > limit && rejects_ < maxRejects_) {
+                ++rejects_;
+                return false;
+            }
+        }
+        seeded_ = true;
+        rejects_ = 0;
+        last_ = value;
+        lastMs_ = atMs;
+        return true;
+    }
+
+private:
+    float maxRatePerS_;
+    uint8_t maxRejects_;
+    bool seeded_ = false;
+    uint8_t rejects_ = 0;
+    float last_ = 0.0f;
+    int64_t lastMs_ = 0;
+};
+
+/**
+ * @brief Gate → median → EWMA for one metric.
+ *
+ * @tparam MedianCapacity largest median window the settings may ask for.
+ */
+template <std::size_t MedianCapacity = 5>
+class SampleFilter {
+public:
+    explicit SampleFilter(const FilterSettings& settings = FilterSettings{})
+        : gate_(settings.maxRatePerS, settings.maxRejects),
+          median_(settings.medianWindow),
+          ewma_(settings.ewmaAlpha)
+    {
+    }
+
+    /// Forget every sample (the next one seeds all stages).
+    void reset()
+    {
+        gate_.reset();
+        median_.reset();
+        ewma_.reset();
+        primed_ = false;
+    }
+
+    /**
+     * @brief Feed @p value read at @p atMs.
+     *
+     * @param out The filtered value; on a rejection (gate or non-finite
+     *            input) the last filtered value, or @p value itself before
+     *            any sample was accepted.
+     * @return false when the sample was rejected.
+     */
+    bool push(float value, int64_t atMs, float& out)
+    {
+        if (!std::isfinite(value) || !gate_.accept(value, atMs)) {
+            ++rejected_;
+            out = primed_ ? value_ : value;
+            return false;
+        }
+        value_ = ewma_.push(median_.push(value));
+        primed_ = true;
+        out = value_;
+        return true;
+    }
+
+    /// Samples rejected since construction.
+    uint32_t rejected() const { return rejected_; }
+
+private:
+    RateGate gate_;
+    MedianWindow<MedianCapacity> median_;
+    Ewma ewma_;
+    float value_ = 0.0f;
+    bool primed_ = false;
+    uint32_t rejected_ = 0;
+};
+
+#endif /* WATERINGSYSTEM_SENSORS_SAMPLEFILTER_H */
@@ -0,0 +1,84 @@
+// SPDX-FileCopyrightText: 2026 Cryptotomte
+// SPDX-License-Identifier: AGPL-3.0-or-later
+/**
+ * @file SoilAcquirer.h
+ * @brief Reads the primary soil probe and publishes timestamped snapshots.
+ *
+ * The soil task calls acquire() at the sensor-read cadence. Each call does
+ * the blocking read() through the sensor (one bus transaction), takes its
+ * snapshot() and publishes it with the time the read finished and a
+ * sequence number, then tells the listener. The watering task is the
+ * listener: it wakes on the notification and decides on latest() at once,
+ * so a slow bus delays the data, never the decision on data already in.
+ *
+ * With a filter set, each snapshot goes through it before it is published
+ * (the sample time is the filter's clock). With a flatline detector set,
+ * each good moisture reading (raw, before the filter) feeds it and the
+ * published sample is marked suspect while it reports a flatline.
+ *
+ * A read may cover one register group only (ISoilSensor::readGroup()):
+ * the published sample names the group and carries the time of each
+ * group's last good read, so a consumer can tell fresh moisture from a
+ * cached pH.
+ *
+ * latest() only copies under the mutex and never waits for a read in
+ * progress (the read runs outside the lock). Pure C++, host-tested.
+ */
+
+#ifndef WATERINGSYSTEM_SENSORS_SOILACQUIRER_H
+#define WATERINGSYSTEM_SENSORS_SOILACQUIRER_H
+
+#include <cstdint>
+#include <functional>
+#include <mutex>
+#include <utility>
+
+#include "interfaces/ISoilFeed.h"
+#include "interfaces/ISoilSensor.h"
+#include "interfaces/ITimeProvider.h"
+#include "interfaces/StaticMutex.h"
+#include "sensors/FlatlineDetector.h"
+#include "sensors/SoilSnapshotFilter.h"
+
+class SoilAcquirer : public ISoilFeed {
+public:
+    /// @p sensor and @p clock must outlive this object.
+    SoilAcquirer(ISoilSensor& sensor, ITimeProvider& clock)
+        : sensor_(sensor), clock_(clock)
+    {
+    }
+
+    SoilAcquirer(const SoilAcquirer&) = delete;
+    SoilAcquirer& operator=(const SoilAcquirer&) = delete;
+
+    /// Called after every publish, on the acquiring task. Boot wiring only,
+    /// before the first acquire().
+    void setListener(std::function<void()> listener) { listener_ = std::move(listener); }
+
+    /// Filter applied to every snapshot before publishing (nullptr = raw).
+    /// Boot wiring only, before the first acquire(); must outlive this.
+    void setFilter(SoilSnapshotFilter* filter) { filter_ = filter; }
+
+    /// Stuck-probe detector fed the moisture of every good fast-group read
+    /// (nullptr = none). Boot wiring only, before the first acquire(); must
+    /// outlive this.
+    void setFlatline(FlatlineDetector* detector) { flatline_ = detector; }
+
+    /// Read @p group of the sensor and publish the result; returns the
+    /// read result.
+    bool acquire(SoilReadGroup group = SoilReadGroup::All);
+
+    TimedSoilSnapshot latest() const override;
+
+private:
+    ISoilSensor& sensor_;
+    ITimeProvider& clock_;
+    std::function<void()> listener_;
+    SoilSnapshotFilter* filter_ = nullptr;  ///< acquiring task only
+    FlatlineDetector* flatline_ = nullptr;  ///< acquiring task only
+
+    mutable StaticMutex mutex_;  ///< guards latest_
+    TimedSoilSnapshot latest_;
+};
+
+#endif /* WATERINGSYSTEM_SENSORS_SOILACQUIRER_H */
@@ -0,0 +1,147 @@
+// SPDX-FileCopyrightText: 2026 Cryptotomte
+// SPDX-License-Identifier: AGPL-3.0-or-later
+/**
+ * @file SoilPollScheduler.h
+ * @brief Round-robin reads of the soil probes sharing one RS485 segment.
+ *
+ * A bed is watched by several probes on the same bus, each at its own
+ * slave address (CONFIG_WS_SOIL_SENSOR_ADDRESSES). Probe 0 is the PRIMARY:
+ * the SoilAcquirer reads it at the start of every sensor-read period and
+ * the WateringController decides on it, exactly as with a single probe. The scheduler
+ * reads the others, one per slot, with the slots spaced evenly across the
+ * same period — probe k of n is due k/n of the way in — so the segment
+ * never carries a burst of back-to-back reads and a Control-class
+ * transaction queued behind one waits for at most one probe read.
+ *
+ * The soil task drives it: beginPeriod() right after the primary
+ * read, then sleep until msUntilDue() and pollDue(), one probe per call,
+ * so the task's watchdog is fed between probes even when an absent probe
+ * runs into the Modbus timeout. A probe whose slot has not come up when
+ * the next period begins is counted as missed and waits for its slot in
+ * the new period (the period was shortened, or earlier reads overran).
+ *
+ * BUS BUDGET: at 9600 baud one 9-register read is about 40 ms on the wire,
+ * so the airtime of a poll round is worth watching against the interval.
+ * usage() reports the budget (probes × wire time of one read over the
+ * period) next to the measured share: the bus master's busy time over the
+ * last whole period, which covers every transaction on the segment —
+ * retries, timeouts and console probes included.
+ *
+ * A probe that waters its own zone (board.h kBoardZones) is read through
+ * its SoilAcquirer (setFeed()), so the zone's controller gets timestamped
+ * samples and a wake-up exactly as the primary's does.
+ *
+ * Probes are added at boot, before any task runs, and never change; the
+ * usage counters are guarded by a mutex so /api/v1/sensors and the console
+ * can read them while the soil task polls. Pure C++, host-tested.
+ */
+
+#ifndef WATERINGSYSTEM_SENSORS_SOILPOLLSCHEDULER_H
+#define WATERINGSYSTEM_SENSORS_SOILPOLLSCHEDULER_H
+
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <mutex>
+
+#include "interfaces/ISoilSensor.h"
+#include "interfaces/MetricRegistry.h"
+#include "interfaces/StaticMutex.h"
+#include "sensors/SoilAcquirer.h"
+
+/**
+ * @brief Parse a list of Modbus slave addresses ("1, 2, 0x0A").
+ *
+ * Entries are decimal or 0x-prefixed hex, separated by commas and/or
+ * spaces; each must be a unicast address (1–247) and appear once.
+ * @return the number written to @p out, or 0 when the text is empty,
+ *         malformed, or names more than @p max addresses.
+ */
+std::size_t parseSoilAddresses(const char* text, uint8_t* out, std::size_t max);
+
+/// Wire time of one soil read (8-byte request, 23-byte response, 8N1, and
+/// the 3.5-character silence after each frame) at @p baud.
+uint32_t soilReadAirtimeUs(uint32_t baud);
+
+/// What the poll rounds cost the bus (SoilPollScheduler::usage()).
+struct SoilBusUsage {
+    uint32_t probes = 0;            ///< including the primary
+    uint32_t periodMs = 0;          ///< current sensor-read interval
+    uint32_t readAirtimeUs = 0;     ///< soilReadAirtimeUs() at the bus baud
+    uint32_t budgetPermille = 0;    ///< probes × readAirtimeUs over periodMs
+    uint32_t measuredPermille = 0;  ///< bus busy time over the last period
+    uint32_t polls = 0;             ///< probe reads by the scheduler
+    uint32_t failures = 0;          ///< of those, reads that failed
+    uint32_t missed = 0;            ///< slots a new period cut off
+};
+
+class SoilPollScheduler {
+public:
+    /// Probes on one segment; bounded by the per-probe history ids.
+    static constexpr std::size_t kMaxProbes = metric::kSoilProbes;
+
+    /**
+     * @param baud      Line rate, for the airtime budget.
+     * @param busTimeUs Total time the bus has been busy since boot, in µs
+     *                  (ModbusBusMaster::busTimeUs()); without one the
+     *                  measured share reads 0.
+     */
+    explicit SoilPollScheduler(uint32_t baud,
+                               std::function<uint64_t()> busTimeUs = nullptr);
+
+    SoilPollScheduler(const SoilPollScheduler&) = delete;
+    SoilPollScheduler& operator=(const SoilPollScheduler&) = delete;
+
+    /// Add the probe at @p address (the first one added is the primary).
+    /// Boot wiring only; false once kMaxProbes are in.
+    bool add(uint8_t address, ISoilSensor& sensor);
+
+    std::size_t size() const { return count_; }
+    uint8_t address(std::size_t probe) const { return probes_[probe].address; }
+    ISoilSensor& sensor(std::size_t probe) const { return *probes_[probe].sensor; }
+
+    /// Read @p probe (not the primary) through @p feed — an acquirer over
+    /// the same sensor — from now on. Boot wiring only; false for a probe
+    /// index out of range or 0.
+    bool setFeed(std::size_t probe, SoilAcquirer& feed);
+
+    /// The primary was just read at @p nowMs: open a period of @p periodMs
+    /// over which the other probes are spread.
+    void beginPeriod(int64_t nowMs, uint32_t periodMs);
+
+    /// Milliseconds until the next probe is due (0 = now); UINT32_MAX when
+    /// every probe of this period has been read.
+    uint32_t msUntilDue(int64_t nowMs) const;
+
+    /// Read the next probe if its slot has come up; true when one was read
+    /// (whatever the outcome of the read).
+    bool pollDue(int64_t nowMs);
+
+    SoilBusUsage usage() const;
+
+private:
+    struct Probe {
+        uint8_t address = 0;
+        ISoilSensor* sensor = nullptr;
+        SoilAcquirer* feed = nullptr;  ///< publishes the reads (zone probe)
+    };
+
+    int64_t dueMs(std::size_t probe) const;
+
+    Probe probes_[kMaxProbes];
+    std::size_t count_ = 0;
+    const uint32_t readAirtimeUs_;
+    std::function<uint64_t()> busTimeUs_;
+
+    // Watering task only.
+    bool open_ = false;
+    int64_t periodStartMs_ = 0;
+    uint32_t periodMs_ = 0;
+    std::size_t next_ = 0;        ///< next probe due this period
+    uint64_t busAtStartUs_ = 0;
+
+    mutable StaticMutex mutex_;    ///< guards usage_ (read from other tasks)
+    SoilBusUsage usage_;
+};
+
+#endif /* WATERINGSYSTEM_SENSORS_SOILPOLLSCHEDULER_H */
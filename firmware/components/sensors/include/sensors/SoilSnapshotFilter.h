@@ -0,0 +1,97 @@
+// SPDX-FileCopyrightText: 2026 Cryptotomte
+// SPDX-License-Identifier: AGPL-3.0-or-later
+/**
+ * @file SoilSnapshotFilter.h
+ * @brief Per-metric SampleFilter stage over a soil probe's snapshots.
+ *
+ * SoilAcquirer runs every successful read through it before publishing, so
+ * the watering decision and the telemetry log (both take the feed) see the
+ * same filtered values. A failed read passes through untouched and feeds
+ * no filter: its values are not readings. Pure C++, host-tested.
+ */
+
+#ifndef WATERINGSYSTEM_SENSORS_SOILSNAPSHOTFILTER_H
+#define WATERINGSYSTEM_SENSORS_SOILSNAPSHOTFILTER_H
+
+#include <cstdint>
+
+#include "interfaces/ISoilSensor.h"
+#include "sensors/SampleFilter.h"
+
+/// One FilterSettings per SoilSnapshot quantity.
+struct SoilFilterSettings {
+    FilterSettings moisture;
+    FilterSettings temperature;
+    FilterSettings humidity;
+    FilterSettings ph;
+    FilterSettings ec;
+    FilterSettings nitrogen;
+    FilterSettings phosphorus;
+    FilterSettings potassium;
+
+    /**
+     * @brief The wiring default: a 3-sample median and a light EWMA on
+     * everything, and a gate on the quantities with a physical rate limit.
+     *
+     * Rates are per second; at the 5 s read interval moisture may move
+     * 25 %, temperature 2.5 °C and pH 1.0 between two reads, EC
+     * 2500 µS/cm. NPK (derived from EC by the probe) is left ungated.
+     */
+    static constexpr SoilFilterSettings defaults()
+    {
+        SoilFilterSettings s;
+        const FilterSettings smooth{3, 0.5f, 0.0f, 2};
+        s.moisture = smooth;
+        s.moisture.maxRatePerS = 5.0f;
+        s.temperature = smooth;
+        s.temperature.maxRatePerS = 0.5f;
+        s.humidity = s.moisture;
+        s.ph = smooth;
+        s.ph.maxRatePerS = 0.2f;
+        s.ec = smooth;
+        s.ec.maxRatePerS = 500.0f;
+        s.nitrogen = smooth;
+        s.phosphorus = smooth;
+        s.potassium = smooth;
+        return s;
+    }
+};
+
+class SoilSnapshotFilter {
+public:
+    explicit SoilSnapshotFilter(
+        const SoilFilterSettings& settings = SoilFilterSettings::defaults());
+
+    SoilSnapshotFilter(const SoilSnapshotFilter&) = delete;
+    SoilSnapshotFilter& operator=(const SoilSnapshotFilter&) = delete;
+
+    /**
+     * @brief @p raw with the quantities of @p group filtered.
+     *
+     * A group read successfully (readOk for the fast group, slowReadOk for
+     * the slow one) is filtered; a failed one passes as it is and feeds
+     * nothing. A group @p group did not cover keeps its last filtered
+     * values (raw ones before its first good read).
+     */
+    SoilSnapshot apply(const SoilSnapshot& raw, int64_t atMs,
+                       SoilReadGroup group = SoilReadGroup::All);
+
+    /// Quantity samples the gate (or a non-finite value) rejected.
+    uint32_t rejected() const;
+
+private:
+    SampleFilter<> moisture_;
+    SampleFilter<> temperature_;
+    SampleFilter<> humidity_;
+    SampleFilter<> ph_;
+    SampleFilter<> ec_;
+    SampleFilter<> nitrogen_;
+    SampleFilter<> phosphorus_;
+    SampleFilter<> potassium_;
+    SoilSnapshot fast_;  ///< last filtered output of the fast group
+    SoilSnapshot slow_;  ///< last filtered output of the slow group
+    bool fastPrimed_ = false;
+    bool slowPrimed_ = false;
+};
+
+#endif /* WATERINGSYSTEM_SENSORS_SOILSNAPSHOTFILTER_H */
@@ -0,0 +1,281 @@
+// SPDX-FileCopyrightText: 2026 Cryptotomte
+// SPDX-License-Identifier: AGPL-3.0-or-later
+/**
+ * @file SyntheticSensors.h
+ * @brief Signal-generator soil, environmental and power sensors for the
+ *        soak mode (CONFIG_WS_SOAK_MODE; header-only).
+ *
+ * Stand-ins for the RS485/I2C drivers on a bench unit with no plants, so
+ * storage, the API and the controllers run for days at a chosen rate. Each
+ * quantity is a sine over a simulated day plus seeded noise; simulated
+ * time is the monotonic clock times `speedup`, so at 60 a diurnal cycle
+ * takes 24 minutes and soil moisture crosses the default thresholds a few
+ * times an hour. With `failEvery` = n every n-th read fails (soil code 3,
+ * timeout; env/power code 2), keeping the recovery paths busy; the
+ * getters then keep the last good values, as the real drivers do.
+ *
+ * Shaped after the test mocks (all quantities from one read, a coherent
+ * snapshot()), but built for the target: no allocation, no counters.
+ * Unsynchronized like the drivers: app_main wraps them in the Locked*
+ * decorators. Pure C++, host-tested.
+ */
+
+#ifndef WATERINGSYSTEM_SENSORS_SYNTHETICSENSORS_H
+#define WATERINGSYSTEM_SENSORS_SYNTHETICSENSORS_H
+
+#include <cmath>
+#include <cstdint>
+
+#include "interfaces/IEnvironmentalSensor.h"
+#include "interfaces/IPowerSensor.h"
+#include "interfaces/ISoilSensor.h"
+#include "interfaces/ITimeProvider.h"
+#include "interfaces/IWaterPump.h"
+
+/// One quantity: base + amplitude * sin(2 pi t / periodS + phase) + noise.
+struct SignalShape {
+    float base = 0.0f;
+    float amplitude = 0.0f;
+    float periodS = 86400.0f;  ///< simulated seconds per cycle
+    float noise = 0.0f;        ///< uniform in [-noise, +noise]
+};
+
+/// Shared timing and fault settings of one synthetic sensor.
+struct SyntheticSettings {
+    uint32_t speedup = 1;    ///< simulated seconds per real second
+    uint32_t failEvery = 0;  ///< every n-th read fails; 0 = never
+    uint32_t seed = 1;       ///< noise stream and phase; differ per probe
+};
+
+/**
+ * @brief Deterministic sample source behind the synthetic sensors.
+ *
+ * xorshift32 noise, so a seed reproduces a run; the phase offset comes from
+ * the seed, so probes sharing a shape do not move in lockstep.
+ */
+class SignalGenerator {
+public:
+    SignalGenerator(ITimeProvider& clock, const SyntheticSettings& settings)
+        : clock_(clock),
+          settings_(settings),
+          state_(settings.seed != 0 ? settings.seed : 1),
+          phase_(static_cast<float>(settings.seed % 16) * (kTwoPi / 16.0f))
+    {
+    }
+
+    /// Simulated seconds since boot.
+    double nowS() const
+    {
+        return static_cast<double>(clock_.nowMs()) / 1000.0 * settings_.speedup;
+    }
+
+    float sample(const SignalShape& shape, double tS)
+    {
+        const double angle = kTwoPi * tS / shape.periodS + phase_;
+        return shape.base + shape.amplitude * static_cast<float>(std::sin(angle)) +
+               shape.noise * unitNoise();
+    }
+
+    /// Counts a read; true when this one is scripted to fail.
+    bool nextReadFails()
+    {
+        ++reads_;
+        return settings_.failEvery != 0 && reads_ % settings_.failEvery == 0;
+    }
+
+    int64_t nowMs() const { return clock_.nowMs(); }
+
+private:
+    static constexpr float kTwoPi = 6.2831853f;
+
+    float unitNoise()
+    {
+        state_ ^= state_ << 13;
+        state_ ^= state_ >> 17;
+        state_ ^= state_ << 5;
+        return static_cast<float>(state_) / 2147483648.0f - 1.0f;
+    }
+
+    ITimeProvider& clock_;
+    SyntheticSettings settings_;
+    uint32_t state_;
+    float phase_;
+    uint32_t reads_ = 0;
+};
+
+/// Soil probe: moisture across the default thresholds, slow EC/pH/NPK.
+class SyntheticSoilSensor : public ISoilSensor {
+public:
+    static constexpr int kFailError = 3;  ///< IModbusClient: timeout
+
+    SyntheticSoilSensor(ITimeProvider& clock, const SyntheticSettings& settings)
+        : gen_(clock, settings)
+    {
+    }
+
+    bool initialize() override { return true; }
+
+    bool read() override { return readGroup(SoilReadGroup::All); }
+
+    bool readGroup(SoilReadGroup group) override
+    {
+        const bool fast = readsFastGroup(group);
+        const bool slow = readsSlowGroup(group);
+        if (gen_.nextReadFails()) {
+            s_.lastError = kFailError;
+            s_.readOk = fast ? false : s_.readOk;
+            s_.slowReadOk = slow ? false : s_.slowReadOk;
+            return false;
+        }
+        const double t = gen_.nowS();
+        if (fast) {
+            s_.moisture = gen_.sample(kMoisture, t);
+            s_.humidity = s_.moisture;
+            s_.temperature = gen_.sample(kTemperature, t);
+            s_.readOk = true;
+            s_.available = true;
+        }
+        if (slow) {
+            s_.ph = gen_.sample(kPh, t);
+            s_.ec = gen_.sample(kEc, t);
+            s_.nitrogen = gen_.sample(kNitrogen, t);
+            s_.phosphorus = gen_.sample(kPhosphorus, t);
+            s_.potassium = gen_.sample(kPotassium, t);
+            s_.slowReadOk = true;
+            s_.slowAvailable = true;
+        }
+        s_.lastError = 0;
+        return true;
+    }
+
+    SoilSnapshot snapshot() override { return s_; }
+    bool isAvailable() override { return true; }
+    int getLastError() override { return s_.lastError; }
+
+    float getMoisture() override { return s_.moisture; }
+    float getTemperature() override { return s_.temperature; }
+    float getHumidity() override { return s_.humidity; }
+    float getPH() override { return s_.ph; }
+    float getEC() override { return s_.ec; }
+    float getNitrogen() override { return s_.nitrogen; }
+    float getPhosphorus() override { return s_.phosphorus; }
+    float getPotassium() override { return s_.potassium; }
+
+    bool calibrateMoisture(float) override { return true; }
+    bool calibratePH(float) override { return true; }
+    bool calibrateEC(float) override { return true; }
+
+private:
+    // Moisture 25..55 % spans the default 30/50 % thresholds.
+    static constexpr SignalShape kMoisture{40.0f, 15.0f, 86400.0f, 0.5f};
+    static constexpr SignalShape kTemperature{18.0f, 4.0f, 86400.0f, 0.1f};
+    static constexpr SignalShape kPh{6.5f, 0.2f, 7.0f * 86400.0f, 0.02f};
+    static constexpr SignalShape kEc{800.0f, 150.0f, 3.0f * 86400.0f, 10.0f};
+    static constexpr SignalShape kNitrogen{40.0f, 8.0f, 3.0f * 86400.0f, 1.0f};
+    static constexpr SignalShape kPhosphorus{20.0f, 4.0f, 3.0f * 86400.0f, 1.0f};
+    static constexpr SignalShape kPotassium{60.0f, 10.0f, 3.0f * 86400.0f, 1.0f};
+
+    SignalGenerator gen_;
+    SoilSnapshot s_;
+};
+
+/// Air temperature, humidity (in antiphase) and a weather-scale pressure.
+class SyntheticEnvironmentalSensor : public IEnvironmentalSensor {
+public:
+    static constexpr int kFailError = 2;  ///< read failed
+
+    SyntheticEnvironmentalSensor(ITimeProvider& clock, const SyntheticSettings& settings)
+        : gen_(clock, settings)
+    {
+    }
+
+    bool initialize() override { return true; }
+
+    bool read() override
+    {
+        if (gen_.nextReadFails()) {
+            s_.valid = false;
+            s_.lastError = kFailError;
+            return false;
+        }
+        const double t = gen_.nowS();
+        s_.temperature = gen_.sample(kTemperature, t);
+        // Relative humidity falls as the air warms: half a cycle later.
+        s_.humidity = gen_.sample(kHumidity, t + kHumidity.periodS / 2.0);
+        s_.pressure = gen_.sample(kPressure, t);
+        s_.valid = true;
+        s_.lastError = 0;
+        ++s_.sequence;
+        s_.atMs = gen_.nowMs();
+        return true;
+    }
+
+    bool isAvailable() override { return true; }
+    int getLastError() override { return s_.lastError; }
+    float getTemperature() override { return s_.temperature; }
+    float getHumidity() override { return s_.humidity; }
+    float getPressure() override { return s_.pressure; }
+    EnvSnapshot snapshot() override { return s_; }
+
+private:
+    static constexpr SignalShape kTemperature{20.0f, 6.0f, 86400.0f, 0.05f};
+    static constexpr SignalShape kHumidity{55.0f, 15.0f, 86400.0f, 0.3f};
+    static constexpr SignalShape kPressure{1013.0f, 8.0f, 4.0f * 86400.0f, 0.1f};
+
+    SignalGenerator gen_;
+    EnvSnapshot s_;
+};
+
+/// Pump supply: load current while @p pump runs, quiescent otherwise.
+class SyntheticPowerSensor : public IPowerSensor {
+public:
+    static constexpr int kFailError = 2;  ///< read failed
+    static constexpr float kRunningA = 0.8f;
+    static constexpr float kIdleA = 0.004f;
+
+    SyntheticPowerSensor(ITimeProvider& clock, const SyntheticSettings& settings,
+                         const IWaterPump* pump)
+        : gen_(clock, settings), pump_(pump)
+    {
+    }
+
+    bool initialize() override { return true; }
+
+    bool read() override
+    {
+        if (gen_.nextReadFails()) {
+            s_.valid = false;
+            s_.lastError = kFailError;
+            return false;
+        }
+        const double t = gen_.nowS();
+        const bool running = pump_ != nullptr && pump_->isRunning();
+        const float load = running ? kRunningA : kIdleA;
+        s_.current = load + gen_.sample(kRipple, t) * load;
+        // The supply sags a little under load.
+        s_.busVoltage = gen_.sample(kBus, t) - (running ? 0.15f : 0.0f);
+        s_.power = s_.busVoltage * s_.current;
+        s_.valid = true;
+        s_.lastError = 0;
+        ++s_.sequence;
+        s_.atMs = gen_.nowMs();
+        return true;
+    }
+
+    bool isAvailable() override { return true; }
+    int getLastError() override { return s_.lastError; }
+    float getBusVoltage() override { return s_.busVoltage; }
+    float getCurrent() override { return s_.current; }
+    float getPower() override { return s_.power; }
+    PowerSnapshot snapshot() override { return s_; }
+
+private:
+    static constexpr SignalShape kBus{12.0f, 0.05f, 3600.0f, 0.01f};
+    static constexpr SignalShape kRipple{0.0f, 0.0f, 86400.0f, 0.03f};  ///< relative
+
+    SignalGenerator gen_;
+    const IWaterPump* pump_;
+    PowerSnapshot s_;
+};
+
+#endif /* WATERINGSYSTEM_SENSORS_SYNTHETICSENSORS_H */
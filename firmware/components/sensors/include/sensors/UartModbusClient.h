@@ -0,0 +1,124 @@
+// SPDX-FileCopyrightText: 2026 Cryptotomte
+// SPDX-License-Identifier: AGPL-3.0-or-later
+/**
+ * @file UartModbusClient.h
+ * @brief IModbusClient as a small Modbus RTU master straight on the ESP-IDF
+ *        UART driver (CONFIG_WS_MODBUS_CLIENT_UART).
+ *
+ * ESP32-ONLY, like EspModbusClient, and the alternative to it: the board
+ * needs one 0x03 read and the odd 0x06 / 0x10 write, not the esp-modbus
+ * controller with its own task, event groups and parameter tables. Here a
+ * transaction runs on the calling task (the bus task):
+ *
+ *   1. Wait out the remaining 3.5-character silence since the last frame.
+ *   2. Write the request. The UART runs in RS485 half-duplex mode, so rev1
+ *      drives DE from RTS and the rev2 echo never reaches the driver.
+ *   3. Read the response. The UART's hardware RX timeout is set to the
+ *      frame gap (4 character times), so a short frame is handed over as
+ *      soon as the line falls silent, not at the FIFO threshold. The first
+ *      bytes must arrive within the response timeout. Once the header says
+ *      how long the frame is, the read stops at exactly that length.
+ *
+ * Framing and checks live in ModbusRtuFrame.h (host-tested). Slave
+ * exceptions come back as 100+n (no R6 collapse), and a write's echo is
+ * compared in full (FC16: start and count). The response timeout is per request, from the same
+ * ModbusRttTracker as EspModbusClient. Here it costs nothing to change, so
+ * setTimeout() applies right away, and so does setBaudRate()
+ * (uart_set_baudrate(); the character time and the frame gap follow).
+ *
+ * With setCapture(), every request, response, timeout and late answer is
+ * also handed to a ModbusFrameCapture (raw bytes, µs stamps) for the
+ * `rs485test capture` command and GET /api/v1/modbus/capture.
+ *
+ * PRIV rule as for EspModbusClient: UART driver headers only in the .cpp.
+ * Unsynchronized; ModbusBusMaster is the only caller.
+ */
+
+#ifndef WATERINGSYSTEM_SENSORS_UARTMODBUSCLIENT_H
+#define WATERINGSYSTEM_SENSORS_UARTMODBUSCLIENT_H
+
+#include <cstdint>
+
+#include "interfaces/IModbusClient.h"
+#include "sensors/ModbusFrameCapture.h"
+#include "sensors/ModbusRtuFrame.h"
+#include "sensors/ModbusRttTracker.h"
+
+class UartModbusClient : public IModbusClient {
+public:
+    /// Parity response timeout (docs/parity-checklist.md §5).
+    static constexpr uint32_t kDefaultTimeoutMs = 3000;
+
+    /// Boot line rate (8N1, parity: legacy Serial2).
+    static constexpr uint32_t kBaudRate = 9600;
+
+    /// Hardware RX timeout, in character times: 3.5 rounded up.
+    static constexpr uint8_t kFrameGapChars = 4;
+
+    UartModbusClient() { updateTiming(); }
+
+    /// Removes the UART driver.
+    ~UartModbusClient() override;
+
+    UartModbusClient(const UartModbusClient&) = delete;
+    UartModbusClient& operator=(const UartModbusClient&) = delete;
+
+    /**
+     * @brief Install the UART driver: 8N1 at baudRate(), board pins (RTS = DE iff
+     * BOARD_HAS_RS485_DE), RS485 half-duplex, RX timeout, RX pull-up.
+     * Idempotent; a failure removes the driver again.
+     */
+    bool initialize() override;
+
+    bool readHoldingRegisters(uint8_t deviceAddress, uint16_t startRegister,
+                              uint16_t count, uint16_t* buffer) override;
+
+    bool writeSingleRegister(uint8_t deviceAddress, uint16_t registerAddress,
+                             uint16_t value) override;
+
+    bool writeMultipleRegisters(uint8_t deviceAddress, uint16_t startRegister,
+                                uint16_t count, const uint16_t* values) override;
+
+    int getLastError() override { return lastError_; }
+
+    /// The configured response timeout (the adaptive timeout's fallback).
+    void setTimeout(uint32_t timeoutMs) override;
+
+    void getStatistics(uint32_t* successCount, uint32_t* errorCount) override;
+
+    /// Applies at once on a running UART; drops the round-trip history.
+    bool setBaudRate(uint32_t baud) override;
+
+    uint32_t baudRate() override { return baud_; }
+
+    /// Record every frame into @p capture (nullptr: none). Boot wiring
+    /// only, before the bus task runs; @p capture must outlive the client.
+    void setCapture(ModbusFrameCapture* capture) { capture_ = capture; }
+
+private:
+    /// Character time and frame gap at baud_.
+    void updateTiming();
+
+    /// Send the @p requestLen bytes of @p request, receive the @p function
+    /// response into rx_.
+    /// @return bytes received (0 = nothing within the timeout)
+    std::size_t transact(uint8_t deviceAddress, const uint8_t* request,
+                         std::size_t requestLen, uint8_t function);
+
+    /// Book one finished transfer: error code, counters, RTT sample.
+    bool finish(uint8_t deviceAddress, int error, int64_t rttUs);
+
+    bool initialized_ = false;
+    int lastError_ = 0;
+    uint32_t successCount_ = 0;
+    uint32_t errorCount_ = 0;
+    int64_t lastFrameEndUs_ = 0;   ///< end of the last frame on the wire
+    uint32_t baud_ = kBaudRate;
+    int64_t charUs_ = 0;           ///< one 8N1 character on the wire
+    int64_t frameGapUs_ = 0;       ///< the 3.5-character silence
+    ModbusRttTracker rtt_{kDefaultTimeoutMs};
+    ModbusFrameCapture* capture_ = nullptr;
+    uint8_t rx_[kModbusMaxResponseBytes] = {};
+};
+
+#endif /* WATERINGSYSTEM_SENSORS_UARTMODBUSCLIENT_H */
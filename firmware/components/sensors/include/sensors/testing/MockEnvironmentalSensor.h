@@ -22,7 +22,9 @@
 #ifndef WATERINGSYSTEM_SENSORS_TESTING_MOCKENVIRONMENTALSENSOR_H
 #define WATERINGSYSTEM_SENSORS_TESTING_MOCKENVIRONMENTALSENSOR_H
 
+#include <cmath>
 #include <cstddef>
+#include <cstdint>
 #include <limits>
 #include <vector>
 
@@ -93,6 +95,7 @@ public:
         if (script_.empty()) {
             // Unscripted: succeed with the current values (NaN
             // placeholders before the first scripted success).
+            ++sequence_;
             lastError_ = 0;
             return true;
         }
@@ -107,6 +110,7 @@ public:
         temperature_ = step.temperature;
         humidity_ = step.humidity;
         pressure_ = step.pressure;
+        ++sequence_;
         lastError_ = 0;
         return true;
     }
@@ -123,6 +127,18 @@ public:
     float getHumidity() override { return humidity_; }
     float getPressure() override { return pressure_; }
 
+    EnvSnapshot snapshot() override
+    {
+        EnvSnapshot s;
+        s.lastError = lastError_;
+        s.sequence = sequence_;
+        s.temperature = temperature_;
+        s.humidity = humidity_;
+        s.pressure = pressure_;
+        s.valid = lastError_ == 0 && std::isfinite(temperature_);
+        return s;
+    }
+
 private:
     /// One scripted read() outcome; values are only meaningful when ok.
     struct Step {
@@ -136,6 +152,7 @@ private:
     std::vector<Step> script_;
     size_t next_ = 0;
     int lastError_ = 0;
+    uint32_t sequence_ = 0;  ///< successful read() calls
 
     // Last-good values (NaN placeholders before the first scripted
     // success — same self-announcing contract as the real driver).
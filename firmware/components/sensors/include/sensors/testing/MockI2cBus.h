@@ -14,7 +14,8 @@
  * records BIG-ENDIAN into the same per-address byte map (so byte-level
  * assertions stay valid) and into the call log, and shares the write
  * outcome queue with the 8-bit writes (one FIFO covers a mixed-width write
- * sequence).
+ * sequence). setClockSpeed() is recorded, and setMaxClockSpeed() makes a
+ * device NACK above a speed, for I2cBusMaster's fast-mode probe.
  *
  * Two register models coexist (feature 006): the BYTE map models
  * auto-incrementing byte registers (BME280 — an N-byte burst walks N
@@ -77,6 +78,8 @@ public:
 
     // Instrumentation (public, MockModbusClient style).
     std::vector<Call> calls;  ///< every probe/read/write, in call order
+    uint32_t clockSpeedHz = 100000;      ///< set by setClockSpeed()
+    bool clockSpeedSupported = true;     ///< false: setClockSpeed() refuses
 
     // -- Scripting ----------------------------------------------------------
 
@@ -93,6 +96,13 @@ public:
         byteIncoherentWords_.erase(address7);
     }
 
+    /// Make @p address7 NACK everything while the clock is above @p hz
+    /// (a device or wiring that does not manage fast mode).
+    void setMaxClockSpeed(uint8_t address7, uint32_t hz)
+    {
+        maxClockHz_[address7] = hz;
+    }
+
     /// Script one register byte on a device (added implicitly if absent).
     void setRegister(uint8_t address7, uint8_t reg, uint8_t value)
     {
@@ -146,7 +156,7 @@ public:
 
     bool probe(uint8_t address7) override
     {
-        const bool present = devices_.count(address7) != 0;
+        const bool present = devices_.count(address7) != 0 && fastEnough(address7);
         calls.push_back({Call::Type::Probe, address7, 0, 0, 0, present});
         return present;
     }
@@ -156,7 +166,7 @@ public:
     {
         Call call{Call::Type::Read, address7, startReg, len, 0, false};
         const auto device = devices_.find(address7);
-        if (device == devices_.end() || !nextOutcome(readOutcomes_)) {
+        if (device == devices_.end() || !fastEnough(address7) || !nextOutcome(readOutcomes_)) {
             calls.push_back(call);
             return false;
         }
@@ -212,7 +222,7 @@ public:
     {
         Call call{Call::Type::Write, address7, reg, 1, value, false};
         const auto device = devices_.find(address7);
-        if (device == devices_.end() || !nextOutcome(writeOutcomes_)) {
+        if (device == devices_.end() || !fastEnough(address7) || !nextOutcome(writeOutcomes_)) {
             calls.push_back(call);
             return false;
         }
@@ -227,7 +237,7 @@ public:
     {
         Call call{Call::Type::Write16, address7, reg, 2, 0, false, value};
         const auto device = devices_.find(address7);
-        if (device == devices_.end() || !nextOutcome(writeOutcomes_)) {
+        if (device == devices_.end() || !fastEnough(address7) || !nextOutcome(writeOutcomes_)) {
             calls.push_back(call);
             return false;
         }
@@ -249,7 +259,22 @@ public:
         return true;
     }
 
+    bool setClockSpeed(uint32_t hz) override
+    {
+        if (!clockSpeedSupported) {
+            return false;
+        }
+        clockSpeedHz = hz;
+        return true;
+    }
+
 private:
+    bool fastEnough(uint8_t address7) const
+    {
+        const auto max = maxClockHz_.find(address7);
+        return max == maxClockHz_.end() || clockSpeedHz <= max->second;
+    }
+
     /// Consume the front of @p queue; an empty queue means success.
     static bool nextOutcome(std::vector<bool>& queue)
     {
@@ -271,6 +296,7 @@ private:
     std::map<uint8_t, std::set<uint8_t>> byteIncoherentWords_;
     std::vector<bool> readOutcomes_;
     std::vector<bool> writeOutcomes_;
+    std::map<uint8_t, uint32_t> maxClockHz_;  ///< setMaxClockSpeed()
 };
 
 #endif /* WATERINGSYSTEM_SENSORS_TESTING_MOCKI2CBUS_H */
@@ -8,7 +8,7 @@
  * (address, startRegister, count), queue per-call outcomes (success,
  * timeout, bus error, slave exception) for fail-then-recover scenarios,
  * and assert on the recorded call log (no-retry invariant, real-read
- * availability probe, calibration register writes) and on the
+ * availability probe, single and multi-register writes) and on the
  * one-increment-per-call statistics. Never compiled into target builds
  * (only included from test code). No IDF includes.
  */
@@ -42,13 +42,14 @@ public:
 
     /// One recorded bus call (in `calls`, chronological).
     struct Call {
-        enum class Type { Read, Write };
+        enum class Type { Read, Write, WriteMultiple };
         Type type;
         uint8_t deviceAddress;
         uint16_t startRegister;  ///< registerAddress for writes
-        uint16_t count;          ///< register count (reads); 1 for writes
-        uint16_t value;          ///< written value (writes); 0 for reads
+        uint16_t count;          ///< register count; 1 for single writes
+        uint16_t value;          ///< written (first) value; 0 for reads
         bool succeeded;          ///< outcome reported to the caller
+        std::vector<uint16_t> values = {};  ///< WriteMultiple: every value
     };
 
     // Instrumentation (public, MockConfigStore style).
@@ -132,6 +133,21 @@ public:
         return finish(call, nextOutcome());
     }
 
+    bool writeMultipleRegisters(uint8_t deviceAddress, uint16_t startRegister,
+                                uint16_t count, const uint16_t* values) override
+    {
+        Call call{Call::Type::WriteMultiple, deviceAddress, startRegister, count,
+                  count > 0 ? values[0] : uint16_t{0}, false};
+        call.values.assign(values, values + count);
+        if (!initialized_) {
+            return finish(call, kErrNotInitialized);
+        }
+        if (count == 0 || count > 123) {
+            return finish(call, kErrBus);
+        }
+        return finish(call, nextOutcome());
+    }
+
     int getLastError() override { return lastError_; }
 
     void setTimeout(uint32_t timeoutMs) override
@@ -65,6 +65,8 @@ public:
     int initializeCalls = 0;
     int readCalls = 0;
     int isAvailableCalls = 0;
+    int readGroupCalls = 0;  ///< readGroup() calls (each also counts in readCalls)
+    SoilReadGroup lastReadGroup = SoilReadGroup::All;  ///< last readGroup() argument
 
     // Read history consumed by snapshot() (mirrors the real sensor). read()
     // maintains them, but they are public (mock "all state public" style) so a
@@ -148,6 +150,14 @@ public:
         return true;
     }
 
+    /// Records the group; the scripted step refreshes every value.
+    bool readGroup(SoilReadGroup group) override
+    {
+        ++readGroupCalls;
+        lastReadGroup = group;
+        return read();
+    }
+
     SoilSnapshot snapshot() override
     {
         // Coherent, non-blocking: report the read history + the current field
@@ -155,6 +165,8 @@ public:
         SoilSnapshot s;
         s.readOk = lastReadOk;
         s.available = hasEverReadOk;
+        s.slowReadOk = lastReadOk;
+        s.slowAvailable = hasEverReadOk;
         s.lastError = lastError;
         s.moisture = moisture;
         s.temperature = temperature;
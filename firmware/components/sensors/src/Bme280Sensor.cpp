@@ -43,8 +43,15 @@ uint16_t le16(uint8_t lsb, uint8_t msb)
 
 }  // namespace
 
-Bme280Sensor::Bme280Sensor(II2cBus& bus)
-    : bus_(bus)
+// The legacy sampling bytes (src/sensors/BME280Sensor.cpp:41-46,
+// docs/parity-checklist.md §5).
+static_assert(bme280_profiles::kParity.ctrlHum() == 0x01 &&
+                  bme280_profiles::kParity.ctrlMeas() == 0x57 &&
+                  bme280_profiles::kParity.config() == 0x90,
+              "kParity must keep the legacy sampling bytes");
+
+Bme280Sensor::Bme280Sensor(II2cBus& bus, Bme280Compensation compensation)
+    : bus_(bus), compensation_(compensation)
 {
 }
 
@@ -99,8 +106,11 @@ bool Bme280Sensor::initialize()
     // Recovery re-arms the once-per-run not-found WARN (the INFO line
     // below announces the recovery itself).
     initFailureLogged_ = false;
-    ESP_LOGI(TAG, "BME280 initialized at 0x%02x (NORMAL, T x2 / P x16 / "
-             "H x1, IIR x16, standby 500 ms)", address_);
+    ESP_LOGI(TAG, "BME280 initialized at 0x%02x (%s, ctrl_meas 0x%02x, "
+             "config 0x%02x, ctrl_hum 0x%02x)", address_,
+             activeProfile().mode == Bme280Mode::Forced ? "FORCED" : "NORMAL",
+             activeProfile().ctrlMeas(), activeProfile().config(),
+             activeProfile().ctrlHum());
     return true;
 }
 
@@ -175,17 +185,18 @@ bool Bme280Sensor::readCalibration()
         static_cast<int16_t>(static_cast<int8_t>(block2[5])) * 16 |
         static_cast<int16_t>(block2[4] >> 4));
     cal_.digH6 = static_cast<int8_t>(block2[6]);
+    trim_ = deriveDoubleTrim(cal_);
     return true;
 }
 
 bool Bme280Sensor::writeSamplingProfile()
 {
-    // Parity sampling profile (data-model.md; legacy
-    // src/sensors/BME280Sensor.cpp:41-46). Byte encodings verified against
-    // the Bosch BME280 datasheet register tables ("ctrl_hum", "ctrl_meas",
-    // "config"). Order matters: the datasheet requires ctrl_hum to be
-    // written BEFORE ctrl_meas — changes to ctrl_hum take effect only
-    // after a write to ctrl_meas.
+    // Byte encodings per the Bosch BME280 datasheet register tables
+    // ("ctrl_hum", "ctrl_meas", "config"; Bme280Profile.h). Order matters:
+    // the datasheet requires ctrl_hum to be written BEFORE ctrl_meas —
+    // changes to ctrl_hum take effect only after a write to ctrl_meas. With
+    // the parity profile (data-model.md; legacy
+    // src/sensors/BME280Sensor.cpp:41-46):
     //
     //   ctrl_hum  (0xF2) = 0x01: osrs_h[2:0] = 001 (humidity oversampling ×1)
     //   ctrl_meas (0xF4) = 0x57: osrs_t[7:5] = 010 (temperature ×2),
@@ -196,9 +207,75 @@ bool Bme280Sensor::writeSamplingProfile()
     //                            filter[4:2] = 100 (IIR ×16),
     //                            spi3w_en[0] = 0
     //                            → 100'100'00 = 0x90
-    return bus_.writeRegister(address_, kRegCtrlHum, kCtrlHumValue) &&
-           bus_.writeRegister(address_, kRegCtrlMeas, kCtrlMeasValue) &&
-           bus_.writeRegister(address_, kRegConfig, kConfigValue);
+    //
+    // A forced-mode profile's ctrl_meas write starts its first conversion.
+    const Bme280Profile& profile = activeProfile();
+    return bus_.writeRegister(address_, kRegCtrlHum, profile.ctrlHum()) &&
+           bus_.writeRegister(address_, kRegCtrlMeas, profile.ctrlMeas()) &&
+           bus_.writeRegister(address_, kRegConfig, profile.config());
+}
+
+bool Bme280Sensor::reprogramSamplingProfile()
+{
+    if (!initialized_) {
+        return true;  // written by the next initialize()
+    }
+    // config writes in NORMAL mode may be ignored (datasheet "config"), so
+    // a running device is put to sleep first.
+    const Bme280Profile& profile = activeProfile();
+    if (bus_.writeRegister(address_, kRegCtrlMeas,
+                           profile.ctrlMeas(Bme280Mode::Sleep)) &&
+        bus_.writeRegister(address_, kRegCtrlHum, profile.ctrlHum()) &&
+        bus_.writeRegister(address_, kRegConfig, profile.config()) &&
+        bus_.writeRegister(address_, kRegCtrlMeas, profile.ctrlMeas())) {
+        return true;
+    }
+    lastError_ = 2;
+    initialized_ = false;
+    ESP_LOGW(TAG, "sampling profile write failed at 0x%02x — will re-probe",
+             address_);
+    return false;
+}
+
+bool Bme280Sensor::setProfile(const Bme280Profile& profile)
+{
+    profile_ = profile;
+    return burst_ || reprogramSamplingProfile();
+}
+
+bool Bme280Sensor::setBurstProfile(const Bme280Profile& profile)
+{
+    burstProfile_ = profile;
+    return !burst_ || reprogramSamplingProfile();
+}
+
+bool Bme280Sensor::setBurst(bool burst)
+{
+    if (burst == burst_) {
+        return true;
+    }
+    burst_ = burst;
+    return reprogramSamplingProfile();
+}
+
+uint32_t Bme280Sensor::startMeasurement()
+{
+    const Bme280Profile& profile = activeProfile();
+    if (profile.mode != Bme280Mode::Forced) {
+        return 0;  // NORMAL: the chip converts on its own standby cadence
+    }
+    if (!initialized_) {
+        // initialize() writes ctrl_meas, which starts the conversion.
+        return initialize() ? profile.measurementTimeUs() : 0;
+    }
+    if (!bus_.writeRegister(address_, kRegCtrlMeas, profile.ctrlMeas())) {
+        lastError_ = 2;
+        initialized_ = false;
+        ESP_LOGW(TAG, "forced-mode trigger failed at 0x%02x — will re-probe",
+                 address_);
+        return 0;
+    }
+    return profile.measurementTimeUs();
 }
 
 bool Bme280Sensor::read()
@@ -236,19 +313,16 @@ bool Bme280Sensor::read()
                          static_cast<int32_t>(raw[7]);
 
     // Compensate T first — t_fine feeds P and H (data-model.md).
-    int32_t tFine = 0;
-    const int32_t t = compensateTemperature(adcT, cal_, tFine);
-    const uint32_t p = compensatePressure(adcP, cal_, tFine);
-    const uint32_t h = compensateHumidity(adcH, cal_, tFine);
-
-    // Unit conversion (data-model.md): T 0.01 °C → °C; P Q24.8 Pa → Pa →
-    // hPa (parity: legacy converts Pa → hPa); H Q22.10 → %RH.
-    const float temperature = static_cast<float>(t) / 100.0f;
-    const float pressure = static_cast<float>(p) / 256.0f / 100.0f;
-    const float humidity = static_cast<float>(h) / 1024.0f;
+    const Reading reading =
+        compensation_ == Bme280Compensation::Double
+            ? compensateDouble(adcT, adcP, adcH, trim_)
+            : compensateInteger(adcT, adcP, adcH, cal_);
+    const float temperature = reading.temperature;
+    const float pressure = reading.pressure;
+    const float humidity = reading.humidity;
 
     // Parity NaN check (legacy :66-69): a NaN fails the whole read with
-    // error 2. Unreachable with the integer compensation paths above, but
+    // error 2. Unreachable with either compensation path above, but
     // it is the binding legacy contract and stays as a safety net. Not a
     // bus loss — the driver stays initialized.
     if (std::isnan(temperature) || std::isnan(humidity) ||
@@ -264,6 +338,7 @@ bool Bme280Sensor::read()
     humidity_ = humidity;
     pressure_ = pressure;
 
+    ++sequence_;
     lastError_ = 0;
     return true;
 }
@@ -317,6 +392,18 @@ float Bme280Sensor::getPressure()
     return pressure_;
 }
 
+EnvSnapshot Bme280Sensor::snapshot()
+{
+    EnvSnapshot s;
+    s.lastError = lastError_;
+    s.sequence = sequence_;
+    s.temperature = temperature_;
+    s.humidity = humidity_;
+    s.pressure = pressure_;
+    s.valid = lastError_ == 0 && std::isfinite(temperature_);
+    return s;
+}
+
 // ---------------------------------------------------------------------------
 // Bosch BME280 datasheet reference compensation, transcribed exactly from
 // the datasheet's 32/64-bit integer routines (BME280_compensate_T_int32,
@@ -388,3 +475,90 @@ uint32_t Bme280Sensor::compensateHumidity(int32_t adcH,
     // Unsigned Q22.10 %RH: output 47445 = 46.333 %RH.
     return static_cast<uint32_t>(v >> 12);
 }
+
+Bme280Sensor::Reading Bme280Sensor::compensateInteger(int32_t adcT,
+                                                      int32_t adcP,
+                                                      int32_t adcH,
+                                                      const Calibration& cal)
+{
+    int32_t tFine = 0;
+    const int32_t t = compensateTemperature(adcT, cal, tFine);
+    const uint32_t p = compensatePressure(adcP, cal, tFine);
+    const uint32_t h = compensateHumidity(adcH, cal, tFine);
+
+    // Unit conversion (data-model.md): T 0.01 °C → °C; P Q24.8 Pa → hPa
+    // (parity: legacy converts Pa → hPa); H Q22.10 → %RH. Multiplies by the
+    // reciprocal scales; the Q22.10 one is exact.
+    Reading reading;
+    reading.temperature = static_cast<float>(t) * 0.01f;
+    reading.pressure = static_cast<float>(p) * (1.0f / 25600.0f);
+    reading.humidity = static_cast<float>(h) * (1.0f / 1024.0f);
+    return reading;
+}
+
+// ---------------------------------------------------------------------------
+// Bosch BME280 datasheet double-precision compensation
+// (BME280_compensate_T_double, BME280_compensate_P_double,
+// bme280_compensate_H_double), with every trimming-only divisor folded into
+// DoubleTrim. Not bit-exact with the integer routines: the host suite
+// bounds the difference instead.
+// ---------------------------------------------------------------------------
+
+Bme280Sensor::DoubleTrim Bme280Sensor::deriveDoubleTrim(const Calibration& cal)
+{
+    DoubleTrim trim;
+    trim.t1 = cal.digT1 / 8192.0;
+    trim.t2 = cal.digT2 / 16384.0;
+    trim.t12 = cal.digT1 / 1024.0 * cal.digT2;
+    trim.t3 = cal.digT3;
+    trim.p1 = cal.digP1;
+    trim.p1s = cal.digP1 / 32768.0;
+    trim.p2 = cal.digP2 / 524288.0;
+    trim.p3 = cal.digP3 / 274877906944.0;  // 524288²
+    trim.p4 = cal.digP4 * 65536.0;
+    trim.p5 = cal.digP5 / 2.0;             // ·2, then the /4
+    trim.p6 = cal.digP6 / 131072.0;        // /32768, then the /4
+    trim.p7 = cal.digP7 / 16.0;
+    trim.p8 = cal.digP8 / 524288.0;        // /32768, then the /16
+    trim.p9 = cal.digP9 / 34359738368.0;   // /2^31, then the /16
+    trim.h1 = cal.digH1 / 524288.0;
+    trim.h2 = cal.digH2 / 65536.0;
+    trim.h3 = cal.digH3 / 67108864.0;
+    trim.h4 = cal.digH4 * 64.0;
+    trim.h5 = cal.digH5 / 16384.0;
+    trim.h6 = cal.digH6 / 67108864.0;
+    return trim;
+}
+
+Bme280Sensor::Reading Bme280Sensor::compensateDouble(int32_t adcT,
+                                                     int32_t adcP,
+                                                     int32_t adcH,
+                                                     const DoubleTrim& trim)
+{
+    const double t = adcT;
+    const double d = t * (1.0 / 131072.0) - trim.t1;
+    const double tSum = (t * trim.t2 - trim.t12) + d * d * trim.t3;
+    // The datasheet routine hands P and H the truncated integer t_fine.
+    const double tFine = static_cast<double>(static_cast<int32_t>(tSum));
+
+    double var1 = tFine * 0.5 - 64000.0;
+    const double var2 = var1 * var1 * trim.p6 + var1 * trim.p5 + trim.p4;
+    var1 = (var1 * var1 * trim.p3 + var1 * trim.p2) * trim.p1s + trim.p1;
+    double pressure = 0.0;
+    if (var1 != 0.0) {
+        pressure = (1048576.0 - adcP - var2 * (1.0 / 4096.0)) * 6250.0 / var1;
+        pressure += pressure * (pressure * trim.p9 + trim.p8) + trim.p7;
+    }
+
+    double h = tFine - 76800.0;
+    h = (adcH - (trim.h4 + trim.h5 * h)) *
+        (trim.h2 * (1.0 + trim.h6 * h * (1.0 + trim.h3 * h)));
+    h = h * (1.0 - trim.h1 * h);
+    h = (h > 100.0) ? 100.0 : (h < 0.0 ? 0.0 : h);
+
+    Reading reading;
+    reading.temperature = static_cast<float>(tSum * (1.0 / 5120.0));
+    reading.pressure = static_cast<float>(pressure * 0.01);
+    reading.humidity = static_cast<float>(h);
+    return reading;
+}
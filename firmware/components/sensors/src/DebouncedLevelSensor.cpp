@@ -31,8 +31,42 @@ DebouncedLevelSensor::DebouncedLevelSensor(IDigitalInput& input,
 void DebouncedLevelSensor::update()
 {
     const int64_t now = time_.nowMs();
-    const bool raw = input_.read();
+    const bool wasPresent = isWaterPresent();
+
+    // Edges recorded since the last update, each at its own time. The
+    // level held from the previous sample up to the edge, so a window that
+    // ran out before it completes first (the old level sampled at the edge
+    // time), then the flip restarts it. Times are clamped to run forward
+    // within [previous sample, now]; while the settle window is still
+    // unopened the earliest time is now itself — it opens at this update,
+    // never at a queued edge.
+    int64_t earliest =
+        state_ == State::Settling && settleStartMs_ == kNotStarted
+            ? now
+            : lastSampleMs_;
+    DigitalEdge edge;
+    while (input_.nextEdge(edge)) {
+        const int64_t at = edge.atMs < earliest ? earliest
+                           : edge.atMs > now ? now
+                                             : edge.atMs;
+        sample(raw_, at);
+        sample(edge.level, at);
+        earliest = at;
+    }
+
+    // One read per update: all a polled input provides, and the backstop
+    // for an edge a full queue dropped.
+    sample(input_.read(), now);
+
+    if (observer_ != nullptr && isWaterPresent() != wasPresent) {
+        observer_->onWaterPresentChanged(!wasPresent);
+    }
+}
+
+void DebouncedLevelSensor::sample(bool raw, int64_t now)
+{
     raw_ = raw;  // rawState() diagnostics: always the latest sample
+    lastSampleMs_ = now;
 
     switch (state_) {
     case State::Settling:
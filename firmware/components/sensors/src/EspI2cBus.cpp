@@ -69,7 +69,7 @@ bool EspI2cBus::ensureBus()
     busHandle_ = bus;
     ESP_LOGI(TAG, "I2C master bus up (SDA=%d SCL=%d, %lu Hz per device)",
              BOARD_PIN_I2C_SDA, BOARD_PIN_I2C_SCL,
-             static_cast<unsigned long>(kSclSpeedHz));
+             static_cast<unsigned long>(sclSpeedHz_));
     return true;
 }
 
@@ -79,7 +79,7 @@ void* EspI2cBus::deviceHandle(uint8_t address7)
     // first use from multiple tasks (sensor task + console REPL; INA226 in
     // PR-05). Transactions themselves are NOT under this lock — the
     // i2c_master driver's per-transaction bus lock covers those.
-    std::lock_guard<std::mutex> lock(mutex_);
+    std::lock_guard<StaticMutex> lock(mutex_);
 
     if (!ensureBus()) {
         return nullptr;
@@ -97,11 +97,12 @@ void* EspI2cBus::deviceHandle(uint8_t address7)
         return nullptr;
     }
 
-    // Created on first use, 100 kHz standard mode per device (FR-002).
+    // Created on first use at the current clock: 100 kHz standard mode
+    // per device (FR-002) unless setClockSpeed() chose fast mode.
     i2c_device_config_t dev_config = {};
     dev_config.dev_addr_length = I2C_ADDR_BIT_LEN_7;
     dev_config.device_address = address7;
-    dev_config.scl_speed_hz = kSclSpeedHz;
+    dev_config.scl_speed_hz = sclSpeedHz_;
 
     i2c_master_dev_handle_t dev = nullptr;
     const esp_err_t err = i2c_master_bus_add_device(
@@ -123,7 +124,7 @@ bool EspI2cBus::probe(uint8_t address7)
         // ensureBus() mutates busHandle_ — same lock as deviceHandle().
         // Once created the handle never changes, so the transaction below
         // can safely run outside the lock (driver bus lock covers it).
-        std::lock_guard<std::mutex> lock(mutex_);
+        std::lock_guard<StaticMutex> lock(mutex_);
         if (!ensureBus()) {
             return false;
         }
@@ -236,3 +237,27 @@ bool EspI2cBus::writeRegister16(uint8_t address7, uint8_t reg, uint16_t value)
     }
     return true;
 }
+
+bool EspI2cBus::setClockSpeed(uint32_t hz)
+{
+    if (hz < kSclSpeedHz || hz > kMaxSclSpeedHz) {
+        return false;
+    }
+    std::lock_guard<StaticMutex> lock(mutex_);
+    // No transaction is in flight (II2cBus contract), so every handle can
+    // go; deviceHandle() re-creates them at the new clock on next use.
+    bool ok = true;
+    for (size_t i = 0; i < deviceCount_; ++i) {
+        const esp_err_t err = i2c_master_bus_rm_device(
+            static_cast<i2c_master_dev_handle_t>(devices_[i].handle));
+        if (err != ESP_OK) {
+            ESP_LOGE(TAG, "i2c_master_bus_rm_device(0x%02x) failed: %s",
+                     devices_[i].address, esp_err_to_name(err));
+            ok = false;
+        }
+    }
+    deviceCount_ = 0;
+    sclSpeedHz_ = hz;
+    ESP_LOGI(TAG, "I2C clock %lu Hz", static_cast<unsigned long>(hz));
+    return ok;
+}
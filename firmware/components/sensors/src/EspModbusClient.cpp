@@ -7,7 +7,7 @@
  * Target-only translation unit (excluded from the linux host build). The
  * only file in the sensors component that touches esp-modbus, UART and
  * GPIO APIs. Setup sequence and RS485 half-duplex rationale: research.md
- * R1/R2/R3/R4.
+ * R1/R2/R3/R4. Adaptive response timeout: EspModbusClient.h.
  */
 
 #include "sensors/EspModbusClient.h"
@@ -16,6 +16,7 @@
 #include "driver/gpio.h"
 #include "driver/uart.h"
 #include "esp_log.h"
+#include "esp_timer.h"
 
 // esp-modbus umbrella header (managed component, pinned ==2.1.2).
 #include "mbcontroller.h"
@@ -64,6 +65,12 @@ void delete_master_logged(void*& handle)
     handle = nullptr;
 }
 
+uint32_t round_up_to_step(uint32_t timeoutMs)
+{
+    const uint32_t step = EspModbusClient::kTimeoutStepMs;
+    return (timeoutMs + step - 1) / step * step;
+}
+
 }  // namespace
 
 EspModbusClient::~EspModbusClient()
@@ -78,18 +85,33 @@ bool EspModbusClient::initialize()
     if (initialized_) {
         return true;
     }
+    if (!startStack(timeoutMs_)) {
+        return false;
+    }
+    ESP_LOGI(TAG,
+             "Modbus RTU master up: UART%d %lu 8N1, timeout %lu ms, "
+             "RS485 half-duplex",
+             BOARD_RS485_UART_PORT, static_cast<unsigned long>(baud_),
+             static_cast<unsigned long>(timeoutMs_));
+    initialized_ = true;
+    lastError_ = 0;
+    return true;
+}
 
-    // R1: esp-modbus 2.x serial master, Modbus RTU 9600 8N1, parity
-    // response timeout (3000 ms default, member set via setTimeout()).
+bool EspModbusClient::startStack(uint32_t timeoutMs)
+{
+    // R1: esp-modbus 2.x serial master, Modbus RTU 8N1 at baud_ (9600
+    // unless negotiated). The response timeout is fixed per master
+    // instance (R5), hence the parameter.
     mb_communication_info_t comm_info = {};
     comm_info.ser_opts.port = static_cast<uart_port_t>(BOARD_RS485_UART_PORT);
     comm_info.ser_opts.mode = MB_RTU;
-    comm_info.ser_opts.baudrate = 9600;
+    comm_info.ser_opts.baudrate = baud_;
     comm_info.ser_opts.data_bits = UART_DATA_8_BITS;
     comm_info.ser_opts.stop_bits = UART_STOP_BITS_1;
     comm_info.ser_opts.parity = MB_PARITY_NONE;
     comm_info.ser_opts.uid = 0;  // master
-    comm_info.ser_opts.response_tout_ms = timeoutMs_;
+    comm_info.ser_opts.response_tout_ms = timeoutMs;
 
     esp_err_t err = mbc_master_create_serial(&comm_info, &mbHandle_);
     if (err != ESP_OK || mbHandle_ == nullptr) {
@@ -155,13 +177,33 @@ bool EspModbusClient::initialize()
         lastError_ = 1;
         return false;
     }
+    appliedTimeoutMs_ = timeoutMs;
+    return true;
+}
 
-    ESP_LOGI(TAG,
-             "Modbus RTU master up: UART%d 9600 8N1, timeout %lu ms, "
-             "RS485 half-duplex",
-             BOARD_RS485_UART_PORT, static_cast<unsigned long>(timeoutMs_));
-    initialized_ = true;
-    lastError_ = 0;
+bool EspModbusClient::applyTimeout(uint32_t timeoutMs)
+{
+    if (timeoutMs == appliedTimeoutMs_) {
+        return true;
+    }
+    // R5 workaround: no runtime setter, so the master is re-created with
+    // the new response_tout_ms. Between frames nothing is in flight (the
+    // bus master serializes every call), so nothing is lost.
+    delete_master_logged(mbHandle_);
+    if (!startStack(timeoutMs)) {
+        ESP_LOGE(TAG, "re-creating the master for a %lu ms timeout failed",
+                 static_cast<unsigned long>(timeoutMs));
+        // Back to the configured timeout; this request fails either way.
+        // Should that fail too the client is down (error 1) until the next
+        // initialize().
+        if (timeoutMs == timeoutMs_ || !startStack(timeoutMs_)) {
+            initialized_ = false;
+            appliedTimeoutMs_ = 0;
+        }
+        return false;
+    }
+    ESP_LOGD(TAG, "response timeout now %lu ms",
+             static_cast<unsigned long>(timeoutMs));
     return true;
 }
 
@@ -177,24 +219,40 @@ bool EspModbusClient::sendRequest(uint8_t deviceAddress, uint8_t command,
         return false;
     }
 
+    const uint32_t timeoutMs = round_up_to_step(rtt_.timeoutFor(deviceAddress));
+    if (!applyTimeout(timeoutMs)) {
+        lastError_ = 1;
+        ++errorCount_;
+        return false;
+    }
+
     mb_param_request_t request = {};
     request.slave_addr = deviceAddress;
     request.command = command;
     request.reg_start = registerAddress;
     request.reg_size = count;
 
+    const int64_t startUs = esp_timer_get_time();
     const esp_err_t err = mbc_master_send_request(mbHandle_, &request, data);
+    const int64_t rttUs = esp_timer_get_time() - startUs;
     lastError_ = map_esp_err(err);
+    if (err == ESP_OK || err == ESP_ERR_INVALID_RESPONSE) {
+        // The slave answered (an exception or bad CRC still is an answer).
+        rtt_.recordAnswer(deviceAddress,
+                          rttUs > UINT32_MAX ? UINT32_MAX : static_cast<uint32_t>(rttUs));
+    } else if (err == ESP_ERR_TIMEOUT) {
+        rtt_.recordTimeout(deviceAddress);
+    }
     if (err != ESP_OK) {
         ++errorCount_;
         ESP_LOGW(TAG,
                  "request failed: cmd=0x%02x addr=%u reg=0x%04x n=%u: %s "
-                 "(error %d)",
+                 "(error %d, timeout %lu ms)",
                  static_cast<unsigned>(command),
                  static_cast<unsigned>(deviceAddress),
                  static_cast<unsigned>(registerAddress),
                  static_cast<unsigned>(count), esp_err_to_name(err),
-                 lastError_);
+                 lastError_, static_cast<unsigned long>(timeoutMs));
         return false;
     }
     ++successCount_;
@@ -225,6 +283,22 @@ bool EspModbusClient::writeSingleRegister(uint8_t deviceAddress,
     return sendRequest(deviceAddress, 0x06, registerAddress, 1, &writeValue);
 }
 
+bool EspModbusClient::writeMultipleRegisters(uint8_t deviceAddress,
+                                             uint16_t startRegister, uint16_t count,
+                                             const uint16_t* values)
+{
+    if (count == 0 || count > 123 || values == nullptr) {
+        lastError_ = 2;
+        ++errorCount_;
+        return false;
+    }
+    // Modbus function 0x10. Same echo divergence as FC06: esp-modbus checks
+    // the response framing, not the echoed start/count. It only reads the
+    // data of a write, so the const_cast is safe.
+    return sendRequest(deviceAddress, 0x10, startRegister, count,
+                       const_cast<uint16_t*>(values));
+}
+
 int EspModbusClient::getLastError()
 {
     return lastError_;
@@ -232,15 +306,41 @@ int EspModbusClient::getLastError()
 
 void EspModbusClient::setTimeout(uint32_t timeoutMs)
 {
+    // Takes effect with the next request that runs at the configured value
+    // (applyTimeout() re-creates the stack then).
     timeoutMs_ = timeoutMs;
-    if (initialized_) {
-        // R5: no documented runtime timeout setter in esp-modbus 2.1.2 —
-        // the stored value takes effect on a future re-initialization only.
-        ESP_LOGW(TAG,
-                 "setTimeout(%lu) after initialize(): applied at next "
-                 "initialization only",
-                 static_cast<unsigned long>(timeoutMs));
+    rtt_.setConfigured(timeoutMs);
+}
+
+bool EspModbusClient::setBaudRate(uint32_t baud)
+{
+    if (baud == 0) {
+        return false;
+    }
+    if (baud == baud_) {
+        return true;
+    }
+    const uint32_t previous = baud_;
+    baud_ = baud;
+    if (!initialized_) {
+        return true;  // initialize() starts at the new rate
+    }
+    // Same R5 workaround as applyTimeout(): the rate, too, is fixed per
+    // master instance.
+    delete_master_logged(mbHandle_);
+    if (startStack(appliedTimeoutMs_ != 0 ? appliedTimeoutMs_ : timeoutMs_)) {
+        rtt_.reset();
+        ESP_LOGI(TAG, "line rate now %lu baud", static_cast<unsigned long>(baud));
+        return true;
+    }
+    ESP_LOGE(TAG, "re-creating the master at %lu baud failed",
+             static_cast<unsigned long>(baud));
+    baud_ = previous;
+    if (!startStack(timeoutMs_)) {
+        initialized_ = false;  // down (error 1) until the next initialize()
+        appliedTimeoutMs_ = 0;
     }
+    return false;
 }
 
 void EspModbusClient::getStatistics(uint32_t* successCount,
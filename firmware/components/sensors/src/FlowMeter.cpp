@@ -0,0 +1,40 @@
+// SPDX-FileCopyrightText: 2026 Cryptotomte
+// SPDX-License-Identifier: AGPL-3.0-or-later
+/**
+ * @file FlowMeter.cpp
+ * @brief Pulse count to volume and rate (pure; see FlowMeter.h).
+ */
+
+#include "sensors/FlowMeter.h"
+
+FlowMeter::FlowMeter(IPulseCounter& counter, uint32_t pulsesPerLitre)
+    : counter_(counter), pulsesPerLitre_(pulsesPerLitre == 0 ? 1 : pulsesPerLitre)
+{
+}
+
+void FlowMeter::update(int64_t nowMs)
+{
+    const uint32_t pulses = counter_.pulses();
+    if (!started_) {
+        started_ = true;
+        windowStartMs_ = nowMs;
+        windowPulses_ = pulses;
+        return;
+    }
+    const int64_t spanMs = nowMs - windowStartMs_;
+    if (spanMs < kRateWindowMs) {
+        return;
+    }
+    const uint32_t counted = pulses - windowPulses_;
+    const float ml = static_cast<float>(counted) * 1000.0f /
+                     static_cast<float>(pulsesPerLitre_);
+    rate_.store(ml * 60000.0f / static_cast<float>(spanMs), std::memory_order_relaxed);
+    windowStartMs_ = nowMs;
+    windowPulses_ = pulses;
+}
+
+uint32_t FlowMeter::deliveredMl()
+{
+    return static_cast<uint32_t>(static_cast<uint64_t>(counter_.pulses()) * 1000u /
+                                 pulsesPerLitre_);
+}
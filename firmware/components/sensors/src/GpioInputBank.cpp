@@ -0,0 +1,41 @@
+// SPDX-FileCopyrightText: 2026 Cryptotomte
+// SPDX-License-Identifier: AGPL-3.0-or-later
+/**
+ * @file GpioInputBank.cpp
+ * @brief One-register multi-pin GPIO sampling (esp32 targets only).
+ */
+
+#include "sensors/GpioInputBank.h"
+
+#include "soc/gpio_reg.h"
+#include "soc/soc.h"
+#include "soc/soc_caps.h"
+
+GpioInputBank::GpioInputBank(std::initializer_list<int> pins)
+{
+    for (const int pin : pins) {
+        if (count_ == kMaxChannels) {
+            break;
+        }
+        pins_[count_++] = static_cast<uint8_t>(pin);
+        mask_ |= 1ULL << static_cast<unsigned>(pin);
+    }
+}
+
+uint32_t GpioInputBank::readAll()
+{
+    uint64_t levels = 0;
+    if ((mask_ & 0xFFFFFFFFULL) != 0) {
+        levels |= REG_READ(GPIO_IN_REG);
+    }
+#if SOC_GPIO_PIN_COUNT > 32
+    if ((mask_ >> 32) != 0) {
+        levels |= static_cast<uint64_t>(REG_READ(GPIO_IN1_REG)) << 32;
+    }
+#endif
+    uint32_t out = 0;
+    for (std::size_t i = 0; i < count_; ++i) {
+        out |= static_cast<uint32_t>((levels >> pins_[i]) & 1u) << i;
+    }
+    return out;
+}
@@ -16,7 +16,10 @@
 #include "sensors/GpioLevelSensor.h"
 
 #include "driver/gpio.h"
+#include "esp_attr.h"
 #include "esp_log.h"
+#include "esp_timer.h"
+#include "hal/gpio_ll.h"
 
 static const char *TAG = "gpiolevelsensor";
 
@@ -50,3 +53,54 @@ bool GpioLevelSensor::read()
 {
     return gpio_get_level(static_cast<gpio_num_t>(pin_)) != 0;
 }
+
+bool GpioLevelSensor::enableEdgeCapture()
+{
+    const gpio_num_t pin = static_cast<gpio_num_t>(pin_);
+    esp_err_t err = gpio_set_intr_type(pin, GPIO_INTR_ANYEDGE);
+    if (err == ESP_OK) {
+        // IRAM service: the level interrupts keep running while the cache
+        // is off for a flash write (the handlers below are all in IRAM).
+        err = gpio_install_isr_service(ESP_INTR_FLAG_IRAM);
+        if (err == ESP_ERR_INVALID_STATE) {
+            err = ESP_OK;  // already installed by another driver
+        }
+    }
+    if (err == ESP_OK) {
+        err = gpio_isr_handler_add(pin, &GpioLevelSensor::onEdge, this);
+    }
+    if (err != ESP_OK) {
+        ESP_LOGE(TAG, "edge interrupt on GPIO %d failed: %s — polled",
+                 pin_, esp_err_to_name(err));
+        gpio_set_intr_type(pin, GPIO_INTR_DISABLE);
+        return false;
+    }
+    return true;
+}
+
+void IRAM_ATTR GpioLevelSensor::onEdge(void* arg)
+{
+    auto* self = static_cast<GpioLevelSensor*>(arg);
+    const uint32_t head = self->edgeHead_.load(std::memory_order_relaxed);
+    if (head - self->edgeTail_.load(std::memory_order_acquire) >=
+        kEdgeQueueDepth) {
+        self->droppedEdges_.fetch_add(1, std::memory_order_relaxed);
+        return;
+    }
+    DigitalEdge& slot = self->edges_[head & (kEdgeQueueDepth - 1)];
+    slot.atMs = esp_timer_get_time() / 1000;
+    slot.level = gpio_ll_get_level(GPIO_LL_GET_HW(GPIO_PORT_0),
+                                   static_cast<uint32_t>(self->pin_)) != 0;
+    self->edgeHead_.store(head + 1, std::memory_order_release);
+}
+
+bool GpioLevelSensor::nextEdge(DigitalEdge& edge)
+{
+    const uint32_t tail = edgeTail_.load(std::memory_order_relaxed);
+    if (tail == edgeHead_.load(std::memory_order_acquire)) {
+        return false;
+    }
+    edge = edges_[tail & (kEdgeQueueDepth - 1)];
+    edgeTail_.store(tail + 1, std::memory_order_release);
+    return true;
+}
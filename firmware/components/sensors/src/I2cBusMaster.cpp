@@ -0,0 +1,266 @@
+// SPDX-FileCopyrightText: 2026 Cryptotomte
+// SPDX-License-Identifier: AGPL-3.0-or-later
+/**
+ * @file I2cBusMaster.cpp
+ * @brief Implementation of the I2C transaction queue.
+ */
+
+#include "sensors/I2cBusMaster.h"
+
+#include <algorithm>
+#include <chrono>
+#include <utility>
+
+#include "interfaces/TraceBuffer.h"
+
+namespace {
+
+uint32_t clampUs(int64_t us)
+{
+    if (us <= 0) {
+        return 0;
+    }
+    return us > static_cast<int64_t>(UINT32_MAX) ? UINT32_MAX : static_cast<uint32_t>(us);
+}
+
+}  // namespace
+
+I2cBusMaster::I2cBusMaster(II2cBus& bus, std::function<int64_t()> clock)
+    : bus_(bus), clock_(std::move(clock)), port_(*this)
+{
+}
+
+void I2cBusMaster::submit(I2cTransaction& txn)
+{
+    txn.done.store(false);
+    txn.next = nullptr;
+    txn.submittedUs = now();
+    if (!serving_.load()) {
+        // No bus task yet: run here, serialized with any other caller.
+        std::lock_guard<std::mutex> bus(busMutex_);
+        transfer(txn);
+        return;
+    }
+    {
+        std::lock_guard<std::mutex> lock(queueMutex_);
+        if (tail_ == nullptr) {
+            head_ = &txn;
+        } else {
+            tail_->next = &txn;
+        }
+        tail_ = &txn;
+        ++depth_;
+    }
+    queued_.notify_one();
+}
+
+bool I2cBusMaster::execute(I2cTransaction& txn)
+{
+    submit(txn);
+    std::unique_lock<std::mutex> lock(queueMutex_);
+    completed_.wait(lock, [&txn] { return txn.done.load(); });
+    return txn.ok;
+}
+
+std::size_t I2cBusMaster::serve(uint32_t timeoutMs)
+{
+    serving_.store(true);
+    I2cTransaction* batch = nullptr;
+    {
+        std::unique_lock<std::mutex> lock(queueMutex_);
+        queued_.wait_for(lock, std::chrono::milliseconds(timeoutMs),
+                         [this] { return depth_ != 0; });
+        batch = head_;
+        head_ = nullptr;
+        tail_ = nullptr;
+        depth_ = 0;
+        if (batch != nullptr) {
+            ++batches_;
+        }
+    }
+    std::size_t served = 0;
+    std::lock_guard<std::mutex> bus(busMutex_);
+    while (batch != nullptr) {
+        // Read the link first: once done, the owner may reuse the struct.
+        I2cTransaction* next = batch->next;
+        transfer(*batch);
+        batch = next;
+        ++served;
+    }
+    return served;
+}
+
+void I2cBusMaster::transfer(I2cTransaction& txn)
+{
+    PowerLockGuard awake(powerLock_);
+    const int64_t startUs = now();
+    WS_TRACE(Debug, I2cStart, txn.address | (static_cast<uint32_t>(txn.op) << 8),
+             clampUs(startUs - txn.submittedUs));
+    switch (txn.op) {
+        case I2cTransaction::Op::Probe:
+            txn.ok = bus_.probe(txn.address);
+            break;
+        case I2cTransaction::Op::Read:
+            txn.ok = bus_.readRegisters(txn.address, txn.reg, txn.buffer, txn.len);
+            break;
+        case I2cTransaction::Op::Write:
+            txn.ok = bus_.writeRegister(txn.address, txn.reg,
+                                        static_cast<uint8_t>(txn.value));
+            break;
+        case I2cTransaction::Op::Write16:
+            txn.ok = bus_.writeRegister16(txn.address, txn.reg, txn.value);
+            break;
+    }
+    const int64_t endUs = now();
+    txn.queueUs = startUs - txn.submittedUs;
+    txn.busUs = endUs - startUs;
+    WS_TRACE(Debug, I2cDone, txn.ok ? 0 : 1, clampUs(txn.busUs));
+
+    {
+        std::lock_guard<std::mutex> lock(queueMutex_);
+        I2cDeviceStats* s = nullptr;
+        for (std::size_t i = 0; i < deviceCount_ && s == nullptr; ++i) {
+            if (devices_[i].address == txn.address) {
+                s = &devices_[i];
+            }
+        }
+        if (s == nullptr && deviceCount_ < kMaxDevices) {
+            s = &devices_[deviceCount_++];
+            s->address = txn.address;
+        }
+        if (s == nullptr) {
+            ++untracked_;
+        } else {
+            ++s->transactions;
+            if (!txn.ok) {
+                ++s->errors;
+            }
+            s->queueUsTotal += clampUs(txn.queueUs);
+            s->queueUsMax = std::max(s->queueUsMax, clampUs(txn.queueUs));
+            s->busUsTotal += clampUs(txn.busUs);
+            s->busUsMax = std::max(s->busUsMax, clampUs(txn.busUs));
+        }
+    }
+    if (txn.onDone != nullptr) {
+        txn.onDone(txn, txn.context);
+    }
+    {
+        std::lock_guard<std::mutex> lock(queueMutex_);
+        txn.done.store(true);
+    }
+    completed_.notify_all();
+}
+
+std::vector<bool> I2cBusMaster::runChecks(const I2cIdentityCheck* checks,
+                                          std::size_t count)
+{
+    std::vector<bool> passed(count, false);
+    for (std::size_t i = 0; i < count; ++i) {
+        const I2cIdentityCheck& c = checks[i];
+        uint8_t buf[2] = {0, 0};
+        const std::size_t len = c.len >= 2 ? 2 : 1;
+        // Straight to the bus, not transfer(): not device traffic.
+        if (bus_.readRegisters(c.address, c.reg, buf, len)) {
+            const uint16_t got =
+                len == 2 ? static_cast<uint16_t>(buf[0] << 8 | buf[1]) : buf[0];
+            passed[i] = got == c.expected;
+        }
+    }
+    return passed;
+}
+
+uint32_t I2cBusMaster::negotiateFastMode(const I2cIdentityCheck* checks, std::size_t count)
+{
+    std::lock_guard<std::mutex> bus(busMutex_);
+    const std::vector<bool> before = runChecks(checks, count);
+    if (std::find(before.begin(), before.end(), true) == before.end() ||
+        !bus_.setClockSpeed(kFastModeHz)) {
+        return clockHz_.load();
+    }
+    const std::vector<bool> after = runChecks(checks, count);
+    for (std::size_t i = 0; i < count; ++i) {
+        if (before[i] && !after[i]) {
+            bus_.setClockSpeed(kStandardModeHz);
+            clockHz_.store(kStandardModeHz);
+            return kStandardModeHz;
+        }
+    }
+    clockHz_.store(kFastModeHz);
+    return kFastModeHz;
+}
+
+std::size_t I2cBusMaster::depth() const
+{
+    std::lock_guard<std::mutex> lock(queueMutex_);
+    return depth_;
+}
+
+uint32_t I2cBusMaster::batches() const
+{
+    std::lock_guard<std::mutex> lock(queueMutex_);
+    return batches_;
+}
+
+uint64_t I2cBusMaster::busTimeUs() const
+{
+    std::lock_guard<std::mutex> lock(queueMutex_);
+    uint64_t total = 0;
+    for (std::size_t i = 0; i < deviceCount_; ++i) {
+        total += devices_[i].busUsTotal;
+    }
+    return total;
+}
+
+std::vector<I2cDeviceStats> I2cBusMaster::deviceStats() const
+{
+    std::lock_guard<std::mutex> lock(queueMutex_);
+    return std::vector<I2cDeviceStats>(devices_, devices_ + deviceCount_);
+}
+
+uint32_t I2cBusMaster::untrackedTransactions() const
+{
+    std::lock_guard<std::mutex> lock(queueMutex_);
+    return untracked_;
+}
+
+// -- Port ---------------------------------------------------------------------
+
+bool I2cBusMaster::Port::probe(uint8_t address7)
+{
+    I2cTransaction txn;
+    txn.op = I2cTransaction::Op::Probe;
+    txn.address = address7;
+    return bus_.execute(txn);
+}
+
+bool I2cBusMaster::Port::readRegisters(uint8_t address7, uint8_t startReg, uint8_t* buf,
+                                       size_t len)
+{
+    I2cTransaction txn;
+    txn.op = I2cTransaction::Op::Read;
+    txn.address = address7;
+    txn.reg = startReg;
+    txn.buffer = buf;
+    txn.len = len;
+    return bus_.execute(txn);
+}
+
+bool I2cBusMaster::Port::writeRegister(uint8_t address7, uint8_t reg, uint8_t value)
+{
+    I2cTransaction txn;
+    txn.op = I2cTransaction::Op::Write;
+    txn.address = address7;
+    txn.reg = reg;
+    txn.value = value;
+    return bus_.execute(txn);
+}
+
+bool I2cBusMaster::Port::writeRegister16(uint8_t address7, uint8_t reg, uint16_t value)
+{
+    I2cTransaction txn;
+    txn.op = I2cTransaction::Op::Write16;
+    txn.address = address7;
+    txn.reg = reg;
+    txn.value = value;
+    return bus_.execute(txn);
+}
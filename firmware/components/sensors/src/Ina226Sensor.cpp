@@ -25,6 +25,8 @@
 
 #include "sensors/Ina226Sensor.h"
 
+#include <cmath>
+
 #include "esp_log.h"
 
 static const char *TAG = "ina226";
@@ -47,14 +49,25 @@ static const char *TAG = "ina226";
 //
 // One averaged result every 16 × (1.1 + 1.1) ms ≈ 35 ms — smooth pump
 // telemetry with negligible lag for the on-demand console/API reads this
-// PR and PR-09 need (no periodic telemetry task in this PR).
+// PR and PR-09 need. This is ina226_sampling::kDefault; setSampling() may
+// choose other AVG/VBUSCT/VSHCT fields (MODE and bit 14 stay as above).
 // ---------------------------------------------------------------------------
 
+static_assert(ina226_sampling::kDefault.configValue() == 0x4527,
+              "the default sampling must keep the feature 006 config value");
+static_assert(ina226_sampling::kDefault.periodUs() == 35200,
+              "16 x (1100 + 1100) us");
+static_assert(ina226_sampling::kCapture.configValue() == 0x4207,
+              "AVG x4, 140 us conversions");
+static_assert(ina226_sampling::kCapture.periodUs() == 1120,
+              "4 x (140 + 140) us");
+
 Ina226Sensor::Ina226Sensor(II2cBus& bus, uint8_t address,
                            uint32_t shuntMilliOhm)
     : bus_(bus),
       address_(address),
-      calibration_(calibrationFor(shuntMilliOhm))
+      calibration_(calibrationFor(shuntMilliOhm)),
+      shuntMilliOhm_(shuntMilliOhm)
 {
 }
 
@@ -88,12 +101,17 @@ bool Ina226Sensor::initialize()
     // stays uninitialized, so the next attempt re-probes the identity from
     // scratch. Order matters for the host-test byte assertions: config
     // first, then calibration (both 16-bit big-endian, one transaction
-    // each — writeRegister16, the seam extension this feature added).
-    if (!bus_.writeRegister16(address_, kRegConfig, kConfigValue) ||
-        !bus_.writeRegister16(address_, kRegCalibration, calibration_)) {
+    // each — writeRegister16, the seam extension this feature added), then
+    // the alert limit before the Mask/Enable that arms it.
+    if (!bus_.writeRegister16(address_, kRegConfig, sampling_.configValue()) ||
+        !bus_.writeRegister16(address_, kRegCalibration, calibration_) ||
+        (alertLimit_ != 0 &&
+         !bus_.writeRegister16(address_, kRegAlertLimit, alertLimit_)) ||
+        (maskValue() != 0 &&
+         !bus_.writeRegister16(address_, kRegMaskEnable, maskValue()))) {
         lastError_ = 2;
-        ESP_LOGW(TAG, "initialize failed: config/calibration write error "
-                 "at 0x%02x", address_);
+        ESP_LOGW(TAG, "initialize failed: config/calibration/alert write "
+                 "error at 0x%02x", address_);
         return false;
     }
 
@@ -102,9 +120,14 @@ bool Ina226Sensor::initialize()
     // Recovery re-arms the once-per-run not-found WARN (the INFO line
     // below announces the recovery itself).
     initFailureLogged_ = false;
-    ESP_LOGI(TAG, "INA226 initialized at 0x%02x (AVG x16, 1.1 ms "
-             "conversions, continuous shunt+bus, CAL=%u)",
-             address_, static_cast<unsigned>(calibration_));
+    ESP_LOGI(TAG, "INA226 initialized at 0x%02x (config 0x%04x, a result "
+             "every %lu us, CAL=%u%s)",
+             address_, static_cast<unsigned>(sampling_.configValue()),
+             static_cast<unsigned long>(sampling_.periodUs()),
+             static_cast<unsigned>(calibration_),
+             alertLimit_ != 0 ? ", over-current alert"
+             : readyAlert_    ? ", conversion-ready alert"
+                              : "");
     return true;
 }
 
@@ -177,6 +200,7 @@ bool Ina226Sensor::read()
         static_cast<float>(static_cast<int16_t>(rawCurrent)) * kCurrentLsbA;
     power_ = static_cast<float>(rawPower) * kPowerLsbW;
 
+    ++sequence_;
     lastError_ = 0;
     return true;
 }
@@ -230,3 +254,116 @@ float Ina226Sensor::getPower()
 {
     return power_;
 }
+
+PowerSnapshot Ina226Sensor::snapshot()
+{
+    PowerSnapshot s;
+    s.lastError = lastError_;
+    s.sequence = sequence_;
+    s.busVoltage = busVoltage_;
+    s.current = current_;
+    s.power = power_;
+    s.valid = lastError_ == 0 && std::isfinite(busVoltage_);
+    return s;
+}
+
+uint32_t Ina226Sensor::conversionPeriodUs()
+{
+    return sampling_.periodUs();
+}
+
+bool Ina226Sensor::setSampling(const Ina226Sampling& sampling)
+{
+    sampling_ = sampling;
+    if (!initialized_) {
+        return true;
+    }
+    if (!bus_.writeRegister16(address_, kRegConfig, sampling_.configValue())) {
+        lastError_ = 2;
+        initialized_ = false;
+        ESP_LOGW(TAG, "sampling write failed at 0x%02x — will re-probe",
+                 address_);
+        return false;
+    }
+    return true;
+}
+
+bool Ina226Sensor::setHighRateSampling(bool enable)
+{
+    if (enable == highRate_) {
+        return true;
+    }
+    highRate_ = enable;
+    if (enable) {
+        normalSampling_ = sampling_;
+        return setSampling(ina226_sampling::kCapture);
+    }
+    return setSampling(normalSampling_);
+}
+
+bool Ina226Sensor::readCurrent(float& amps)
+{
+    if (!initialized_ && !initialize()) {
+        return false;
+    }
+    uint16_t rawCurrent = 0;
+    if (!bus_.readRegister16(address_, kRegCurrent, rawCurrent)) {
+        lastError_ = 2;
+        initialized_ = false;
+        ESP_LOGW(TAG, "current read failed: bus error at 0x%02x — sensor "
+                 "lost, will re-probe", address_);
+        return false;
+    }
+    amps = static_cast<float>(static_cast<int16_t>(rawCurrent)) * kCurrentLsbA;
+    lastError_ = 0;
+    return true;
+}
+
+bool Ina226Sensor::setConversionReadyAlert(bool enable)
+{
+    readyAlert_ = enable;
+    if (!initialized_) {
+        return true;
+    }
+    if (!bus_.writeRegister16(address_, kRegMaskEnable, maskValue())) {
+        lastError_ = 2;
+        initialized_ = false;
+        ESP_LOGW(TAG, "Mask/Enable write failed at 0x%02x — will re-probe",
+                 address_);
+        return false;
+    }
+    return true;
+}
+
+bool Ina226Sensor::setOverCurrentLimit(float amps)
+{
+    alertLimit_ = alertLimitFor(amps, shuntMilliOhm_);
+    if (!initialized_) {
+        return true;
+    }
+    // Limit first: SOL must never compare against a stale value.
+    if ((alertLimit_ != 0 &&
+         !bus_.writeRegister16(address_, kRegAlertLimit, alertLimit_)) ||
+        !bus_.writeRegister16(address_, kRegMaskEnable, maskValue())) {
+        lastError_ = 2;
+        initialized_ = false;
+        ESP_LOGW(TAG, "alert limit write failed at 0x%02x — will re-probe",
+                 address_);
+        return false;
+    }
+    return true;
+}
+
+bool Ina226Sensor::conversionReady()
+{
+    if (!initialized_) {
+        return true;  // read() re-probes
+    }
+    uint16_t mask = 0;
+    if (!bus_.readRegister16(address_, kRegMaskEnable, mask)) {
+        // read() reports the loss through its own error path.
+        initialized_ = false;
+        return true;
+    }
+    return (mask & kMaskCvrf) != 0;
+}
@@ -0,0 +1,108 @@
+// SPDX-FileCopyrightText: 2026 Cryptotomte
+// SPDX-License-Identifier: AGPL-3.0-or-later
+/**
+ * @file LevelSensorBank.cpp
+ * @brief One-pass sampling and publication of the level marks (pure; see
+ *        LevelSensorBank.h).
+ */
+
+#include "sensors/LevelSensorBank.h"
+
+#include <mutex>
+
+LevelSensorBank::LevelSensorBank(IDigitalInputBank& pins, ITimeProvider& time,
+                                 bool activeLow, int64_t debounceMs, int64_t settleMs)
+    : pins_(pins),
+      time_(time),
+      channels_{{Channel(*this, 0), Channel(*this, 1)}},
+      sensors_{{DebouncedLevelSensor(channels_[0], clock_, activeLow, debounceMs, settleMs),
+                DebouncedLevelSensor(channels_[1], clock_, activeLow, debounceMs, settleMs)}},
+      marks_{{Mark(*this, LevelMarkId::Low), Mark(*this, LevelMarkId::High)}}
+{
+}
+
+void LevelSensorBank::update()
+{
+    LevelBankState before;
+    LevelBankState after;
+    ILevelObserver* observers[kMarks] = {};
+    {
+        std::lock_guard<DecoratorMutex> lock(mutex_);
+        before = state();
+        // Clock first: an edge stamped at the sample time or earlier is
+        // already in the levels read right after it.
+        sampleMs_ = time_.nowMs();
+        sample_ = pins_.readAll();
+        for (DebouncedLevelSensor& sensor : sensors_) {
+            sensor.update();
+        }
+        publishLocked();
+        after = state();
+        for (std::size_t m = 0; m < kMarks; ++m) {
+            observers[m] = observers_[m];
+        }
+    }
+    // Outside the lock: an observer stops a pump, under the pump's own lock.
+    for (std::size_t m = 0; m < kMarks; ++m) {
+        const auto id = static_cast<LevelMarkId>(m);
+        if (observers[m] != nullptr && after.waterPresent(id) != before.waterPresent(id)) {
+            observers[m]->onWaterPresentChanged(after.waterPresent(id));
+        }
+    }
+}
+
+void LevelSensorBank::notifyPowerOn()
+{
+    std::lock_guard<DecoratorMutex> lock(mutex_);
+    for (DebouncedLevelSensor& sensor : sensors_) {
+        sensor.notifyPowerOn();
+    }
+    publishLocked();
+}
+
+void LevelSensorBank::markFaulted(LevelMarkId m)
+{
+    std::lock_guard<DecoratorMutex> lock(mutex_);
+    sensors_[index(m)].markFaulted();
+    publishLocked();
+}
+
+void LevelSensorBank::setEdgeSource(LevelMarkId m, IDigitalInput* edges)
+{
+    std::lock_guard<DecoratorMutex> lock(mutex_);
+    channels_[index(m)].edges = edges;
+}
+
+void LevelSensorBank::setObserver(LevelMarkId m, ILevelObserver* observer)
+{
+    std::lock_guard<DecoratorMutex> lock(mutex_);
+    observers_[index(m)] = observer;
+}
+
+void LevelSensorBank::publishLocked()
+{
+    uint32_t bits = 0;
+    for (std::size_t m = 0; m < kMarks; ++m) {
+        DebouncedLevelSensor& sensor = sensors_[m];
+        bits |= (sensor.isValid() ? 1u : 0u) << m;
+        bits |= (sensor.isWaterPresent() ? 1u : 0u) << (8 + m);
+        bits |= (sensor.rawState() ? 1u : 0u) << (16 + m);
+    }
+    published_.store(bits, std::memory_order_release);
+}
+
+bool LevelSensorBank::Channel::nextEdge(DigitalEdge& edge)
+{
+    if (!holding_) {
+        if (edges == nullptr || !edges->nextEdge(held_)) {
+            return false;
+        }
+        holding_ = true;
+    }
+    if (held_.atMs > bank_.sampleMs_) {
+        return false;  // after the sample: replayed by the next update()
+    }
+    edge = held_;
+    holding_ = false;
+    return true;
+}
@@ -0,0 +1,149 @@
+// SPDX-FileCopyrightText: 2026 Cryptotomte
+// SPDX-License-Identifier: AGPL-3.0-or-later
+/**
+ * @file ModbusBaudNegotiator.cpp
+ * @brief Line-rate change of a soil probe segment (see
+ *        ModbusBaudNegotiator.h).
+ */
+
+#include "sensors/ModbusBaudNegotiator.h"
+
+namespace {
+
+struct BaudCode {
+    uint32_t baud;
+    uint16_t code;
+};
+
+// The probe manual's table; 19200 is the fastest rate it lists.
+constexpr BaudCode kBaudCodes[] = {
+    {2400, 0},
+    {4800, 1},
+    {9600, 2},
+    {19200, 3},
+};
+
+bool readCode(IModbusClient& bus, uint8_t address, uint16_t& code)
+{
+    return bus.readHoldingRegisters(address, kSoilRegBaudRate, 1, &code);
+}
+
+/// Steps 2–4 failed: put every probe and @p bus back at @p fromBaud. The
+/// first @p touched probes may have switched to @p toBaud.
+BaudChange rollBack(IModbusClient& bus, const uint8_t* addresses, std::size_t count,
+                    std::size_t touched, uint32_t fromBaud, uint32_t toBaud,
+                    uint16_t oldCode)
+{
+    if (touched > 0 && bus.setBaudRate(toBaud)) {
+        // Probes that switched answer here; the others time out once.
+        for (std::size_t i = 0; i < touched; ++i) {
+            bus.writeSingleRegister(addresses[i], kSoilRegBaudRate, oldCode);
+        }
+    }
+    if (!bus.setBaudRate(fromBaud)) {
+        return BaudChange::Stranded;
+    }
+    bool back = true;
+    for (std::size_t i = 0; i < count; ++i) {
+        uint16_t code = 0;
+        if (!readCode(bus, addresses[i], code)) {
+            back = false;
+            continue;
+        }
+        // Answers at the old rate but holds the new code: it would switch
+        // at its next power-up.
+        if (code != oldCode &&
+            !bus.writeSingleRegister(addresses[i], kSoilRegBaudRate, oldCode)) {
+            back = false;
+        }
+    }
+    return back ? BaudChange::RolledBack : BaudChange::Stranded;
+}
+
+}  // namespace
+
+bool soilBaudCode(uint32_t baud, uint16_t& code)
+{
+    for (const BaudCode& entry : kBaudCodes) {
+        if (entry.baud == baud) {
+            code = entry.code;
+            return true;
+        }
+    }
+    return false;
+}
+
+const char* baudChangeName(BaudChange result)
+{
+    switch (result) {
+    case BaudChange::Changed:
+        return "changed";
+    case BaudChange::Unchanged:
+        return "unchanged";
+    case BaudChange::Unsupported:
+        return "unsupported";
+    case BaudChange::NoAnswer:
+        return "no-answer";
+    case BaudChange::RolledBack:
+        return "rolled-back";
+    case BaudChange::Stranded:
+        return "stranded";
+    }
+    return "unknown";
+}
+
+BaudChange changeSoilBusBaud(IModbusClient& bus, const uint8_t* addresses,
+                             std::size_t count, uint32_t baud)
+{
+    const uint32_t fromBaud = bus.baudRate();
+    uint16_t oldCode = 0;
+    uint16_t newCode = 0;
+    if (!soilBaudCode(baud, newCode) || !soilBaudCode(fromBaud, oldCode) || count == 0) {
+        return BaudChange::Unsupported;
+    }
+    if (baud == fromBaud) {
+        return BaudChange::Unchanged;
+    }
+
+    // 1. Nothing is touched unless every probe is reachable now.
+    for (std::size_t i = 0; i < count; ++i) {
+        uint16_t code = 0;
+        if (!readCode(bus, addresses[i], code)) {
+            return BaudChange::NoAnswer;
+        }
+    }
+
+    // 2. The probes; 3. the master.
+    for (std::size_t i = 0; i < count; ++i) {
+        if (!bus.writeSingleRegister(addresses[i], kSoilRegBaudRate, newCode)) {
+            // The write may have landed with its answer lost.
+            return rollBack(bus, addresses, count, i + 1, fromBaud, baud, oldCode);
+        }
+    }
+    if (!bus.setBaudRate(baud)) {
+        return rollBack(bus, addresses, count, count, fromBaud, baud, oldCode);
+    }
+
+    // 4. Every probe answers at the new rate and reports it.
+    for (std::size_t i = 0; i < count; ++i) {
+        uint16_t code = 0;
+        if (!readCode(bus, addresses[i], code) || code != newCode) {
+            return rollBack(bus, addresses, count, count, fromBaud, baud, oldCode);
+        }
+    }
+    return BaudChange::Changed;
+}
+
+uint32_t confirmSoilBusBaud(IModbusClient& bus, uint8_t address, uint32_t fallbackBaud)
+{
+    const uint32_t stored = bus.baudRate();
+    uint16_t code = 0;
+    if (stored == fallbackBaud || readCode(bus, address, code)) {
+        return stored;
+    }
+    if (bus.setBaudRate(fallbackBaud) && readCode(bus, address, code)) {
+        return fallbackBaud;
+    }
+    bus.setBaudRate(stored);
+    return bus.baudRate();
+}
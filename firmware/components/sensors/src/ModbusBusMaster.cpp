@@ -0,0 +1,297 @@
+// SPDX-FileCopyrightText: 2026 Cryptotomte
+// SPDX-License-Identifier: AGPL-3.0-or-later
+/**
+ * @file ModbusBusMaster.cpp
+ * @brief Implementation of the prioritized RS485 transaction queue.
+ */
+
+#include "sensors/ModbusBusMaster.h"
+
+#include <algorithm>
+#include <chrono>
+#include <utility>
+
+#include "interfaces/TraceBuffer.h"
+
+namespace {
+
+uint32_t clampUs(int64_t us)
+{
+    if (us <= 0) {
+        return 0;
+    }
+    return us > static_cast<int64_t>(UINT32_MAX) ? UINT32_MAX : static_cast<uint32_t>(us);
+}
+
+/// Modbus function of a register transfer; 0 for the other operations.
+uint8_t functionOf(ModbusTransaction::Op op)
+{
+    switch (op) {
+        case ModbusTransaction::Op::ReadHolding:
+            return kModbusReadHolding;
+        case ModbusTransaction::Op::WriteSingle:
+            return kModbusWriteSingle;
+        case ModbusTransaction::Op::WriteMultiple:
+            return kModbusWriteMultiple;
+        default:
+            return 0;
+    }
+}
+
+}  // namespace
+
+ModbusBusMaster::ModbusBusMaster(IModbusClient& client, std::function<int64_t()> clock)
+    : client_(client), clock_(std::move(clock)), baud_(client.baudRate())
+{
+    for (std::size_t p = 0; p < kModbusPriorities; ++p) {
+        ports_[p].bind(*this, static_cast<ModbusPriority>(p));
+    }
+}
+
+void ModbusBusMaster::submit(ModbusTransaction& txn)
+{
+    txn.done.store(false);
+    txn.next = nullptr;
+    txn.submittedUs = now();
+    if (!serving_.load()) {
+        // No bus task yet: run here, serialized with any other caller.
+        std::lock_guard<std::mutex> bus(busMutex_);
+        transfer(txn);
+        return;
+    }
+    const auto p = static_cast<std::size_t>(txn.priority);
+    {
+        std::lock_guard<std::mutex> lock(queueMutex_);
+        if (tail_[p] == nullptr) {
+            head_[p] = &txn;
+        } else {
+            tail_[p]->next = &txn;
+        }
+        tail_[p] = &txn;
+        ++depth_;
+    }
+    queued_.notify_one();
+}
+
+bool ModbusBusMaster::execute(ModbusTransaction& txn)
+{
+    submit(txn);
+    std::unique_lock<std::mutex> lock(queueMutex_);
+    completed_.wait(lock, [&txn] { return txn.done.load(); });
+    return txn.ok;
+}
+
+bool ModbusBusMaster::serve(uint32_t timeoutMs)
+{
+    serving_.store(true);
+    ModbusTransaction* txn = nullptr;
+    {
+        std::unique_lock<std::mutex> lock(queueMutex_);
+        queued_.wait_for(lock, std::chrono::milliseconds(timeoutMs),
+                         [this] { return depth_ != 0; });
+        for (std::size_t p = 0; p < kModbusPriorities && txn == nullptr; ++p) {
+            txn = head_[p];
+            if (txn != nullptr) {
+                head_[p] = txn->next;
+                if (head_[p] == nullptr) {
+                    tail_[p] = nullptr;
+                }
+                --depth_;
+            }
+        }
+    }
+    if (txn == nullptr) {
+        return false;
+    }
+    std::lock_guard<std::mutex> bus(busMutex_);
+    transfer(*txn);
+    return true;
+}
+
+void ModbusBusMaster::transfer(ModbusTransaction& txn)
+{
+    PowerLockGuard awake(powerLock_);
+    const int64_t startUs = now();
+    WS_TRACE(Info, ModbusStart,
+             txn.deviceAddress | (static_cast<uint32_t>(txn.op) << 8) |
+                 (static_cast<uint32_t>(txn.priority) << 16),
+             clampUs(startUs - txn.submittedUs));
+    switch (txn.op) {
+        case ModbusTransaction::Op::Initialize:
+            txn.ok = client_.initialize();
+            break;
+        case ModbusTransaction::Op::ReadHolding:
+            txn.ok = client_.readHoldingRegisters(txn.deviceAddress, txn.reg, txn.count,
+                                                  txn.buffer);
+            break;
+        case ModbusTransaction::Op::WriteSingle:
+            txn.ok = client_.writeSingleRegister(txn.deviceAddress, txn.reg, txn.value);
+            break;
+        case ModbusTransaction::Op::WriteMultiple:
+            txn.ok = client_.writeMultipleRegisters(txn.deviceAddress, txn.reg, txn.count,
+                                                    txn.values);
+            break;
+        case ModbusTransaction::Op::SetTimeout:
+            client_.setTimeout(txn.timeoutMs);
+            txn.ok = true;
+            break;
+        case ModbusTransaction::Op::SetBaudRate:
+            txn.ok = client_.setBaudRate(txn.baud);
+            baud_.store(client_.baudRate());
+            break;
+    }
+    txn.error = txn.ok ? 0 : client_.getLastError();
+    const int64_t endUs = now();
+    txn.queueUs = startUs - txn.submittedUs;
+    txn.busUs = endUs - startUs;
+    WS_TRACE(Info, ModbusDone, txn.error, clampUs(txn.busUs));
+
+    {
+        std::lock_guard<std::mutex> lock(queueMutex_);
+        ModbusQueueStats& s = stats_[static_cast<std::size_t>(txn.priority)];
+        ++s.transactions;
+        s.queueUsTotal += clampUs(txn.queueUs);
+        s.queueUsMax = std::max(s.queueUsMax, clampUs(txn.queueUs));
+        s.busUsTotal += clampUs(txn.busUs);
+        s.busUsMax = std::max(s.busUsMax, clampUs(txn.busUs));
+        const uint8_t function = functionOf(txn.op);
+        if (function != 0) {
+            ++(txn.ok ? successes_ : errors_);
+            links_.record(txn.deviceAddress, function, txn.error, txn.busUs, endUs);
+        }
+    }
+    if (txn.onDone != nullptr) {
+        txn.onDone(txn, txn.context);
+    }
+    {
+        std::lock_guard<std::mutex> lock(queueMutex_);
+        txn.done.store(true);
+    }
+    completed_.notify_all();
+}
+
+IModbusClient& ModbusBusMaster::port(ModbusPriority priority)
+{
+    return ports_[static_cast<std::size_t>(priority)];
+}
+
+std::size_t ModbusBusMaster::depth() const
+{
+    std::lock_guard<std::mutex> lock(queueMutex_);
+    return depth_;
+}
+
+ModbusQueueStats ModbusBusMaster::stats(ModbusPriority priority) const
+{
+    std::lock_guard<std::mutex> lock(queueMutex_);
+    return stats_[static_cast<std::size_t>(priority)];
+}
+
+uint64_t ModbusBusMaster::busTimeUs() const
+{
+    std::lock_guard<std::mutex> lock(queueMutex_);
+    uint64_t total = 0;
+    for (const ModbusQueueStats& s : stats_) {
+        total += s.busUsTotal;
+    }
+    return total;
+}
+
+std::vector<ModbusLinkStats> ModbusBusMaster::linkStats() const
+{
+    std::lock_guard<std::mutex> lock(queueMutex_);
+    return links_.snapshot();
+}
+
+uint32_t ModbusBusMaster::untrackedTransfers() const
+{
+    std::lock_guard<std::mutex> lock(queueMutex_);
+    return links_.untracked();
+}
+
+// -- Port ---------------------------------------------------------------------
+
+void ModbusBusMaster::Port::bind(ModbusBusMaster& bus, ModbusPriority priority)
+{
+    bus_ = &bus;
+    priority_ = priority;
+}
+
+bool ModbusBusMaster::Port::run(ModbusTransaction& txn)
+{
+    txn.priority = priority_;
+    const bool ok = bus_->execute(txn);
+    lastError_.store(txn.error);
+    return ok;
+}
+
+bool ModbusBusMaster::Port::initialize()
+{
+    ModbusTransaction txn;
+    txn.op = ModbusTransaction::Op::Initialize;
+    return run(txn);
+}
+
+bool ModbusBusMaster::Port::readHoldingRegisters(uint8_t deviceAddress,
+                                                 uint16_t startRegister, uint16_t count,
+                                                 uint16_t* buffer)
+{
+    ModbusTransaction txn;
+    txn.op = ModbusTransaction::Op::ReadHolding;
+    txn.deviceAddress = deviceAddress;
+    txn.reg = startRegister;
+    txn.count = count;
+    txn.buffer = buffer;
+    return run(txn);
+}
+
+bool ModbusBusMaster::Port::writeSingleRegister(uint8_t deviceAddress,
+                                                uint16_t registerAddress, uint16_t value)
+{
+    ModbusTransaction txn;
+    txn.op = ModbusTransaction::Op::WriteSingle;
+    txn.deviceAddress = deviceAddress;
+    txn.reg = registerAddress;
+    txn.value = value;
+    return run(txn);
+}
+
+bool ModbusBusMaster::Port::writeMultipleRegisters(uint8_t deviceAddress,
+                                                   uint16_t startRegister, uint16_t count,
+                                                   const uint16_t* values)
+{
+    ModbusTransaction txn;
+    txn.op = ModbusTransaction::Op::WriteMultiple;
+    txn.deviceAddress = deviceAddress;
+    txn.reg = startRegister;
+    txn.count = count;
+    txn.values = values;
+    return run(txn);
+}
+
+void ModbusBusMaster::Port::setTimeout(uint32_t timeoutMs)
+{
+    ModbusTransaction txn;
+    txn.op = ModbusTransaction::Op::SetTimeout;
+    txn.timeoutMs = timeoutMs;
+    run(txn);
+}
+
+bool ModbusBusMaster::Port::setBaudRate(uint32_t baud)
+{
+    ModbusTransaction txn;
+    txn.op = ModbusTransaction::Op::SetBaudRate;
+    txn.baud = baud;
+    return run(txn);
+}
+
+void ModbusBusMaster::Port::getStatistics(uint32_t* successCount, uint32_t* errorCount)
+{
+    std::lock_guard<std::mutex> lock(bus_->queueMutex_);
+    if (successCount != nullptr) {
+        *successCount = bus_->successes_;
+    }
+    if (errorCount != nullptr) {
+        *errorCount = bus_->errors_;
+    }
+}
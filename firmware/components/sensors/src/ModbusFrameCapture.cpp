@@ -0,0 +1,82 @@
+// SPDX-FileCopyrightText: 2026 Cryptotomte
+// SPDX-License-Identifier: AGPL-3.0-or-later
+/**
+ * @file ModbusFrameCapture.cpp
+ * @brief The RS485 frame ring (pure; see ModbusFrameCapture.h).
+ */
+
+#include "sensors/ModbusFrameCapture.h"
+
+#include "sensors/ModbusRtuFrame.h"
+
+void ModbusFrameCapture::record(ModbusFrameDir dir, uint32_t atUs, const uint8_t* data,
+                                std::size_t len)
+{
+    if (!enabled()) {
+        return;
+    }
+    if (data == nullptr) {
+        len = 0;
+    }
+    const uint16_t length = static_cast<uint16_t>(len > UINT16_MAX ? UINT16_MAX : len);
+    const std::size_t kept = len < kMaxBytes ? len : kMaxBytes;
+    bool crcOk = false;
+    if (len >= 4) {
+        const uint16_t crc = modbusCrc16(data, len - 2);
+        crcOk = data[len - 2] == (crc & 0xFF) && data[len - 1] == (crc >> 8);
+    }
+
+    const uint32_t seq = written_.load(std::memory_order_relaxed) + 1;
+    Slot& slot = slots_[(seq - 1) % kCapacity];
+    slot.seq.store(0, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_release);
+    slot.atUs.store(atUs, std::memory_order_relaxed);
+    slot.meta.store(static_cast<uint32_t>(dir) | (crcOk ? 1u << 8 : 0u) |
+                        (static_cast<uint32_t>(length) << 16),
+                    std::memory_order_relaxed);
+    for (std::size_t w = 0; w * 4 < kept; ++w) {
+        uint32_t word = 0;
+        for (std::size_t b = 0; b < 4 && w * 4 + b < kept; ++b) {
+            word |= static_cast<uint32_t>(data[w * 4 + b]) << (8 * b);
+        }
+        slot.words[w].store(word, std::memory_order_relaxed);
+    }
+    slot.seq.store(seq, std::memory_order_release);
+    written_.store(seq, std::memory_order_release);
+}
+
+std::size_t ModbusFrameCapture::read(ModbusFrame* out, std::size_t max, uint32_t after) const
+{
+    const uint32_t newest = written();
+    uint32_t seq = after + 1;
+    if (newest > kCapacity && seq <= newest - kCapacity) {
+        seq = newest - kCapacity + 1;
+    }
+    std::size_t n = 0;
+    for (; seq <= newest && n < max; ++seq) {
+        const Slot& slot = slots_[(seq - 1) % kCapacity];
+        if (slot.seq.load(std::memory_order_acquire) != seq) {
+            continue;
+        }
+        ModbusFrame frame;
+        frame.sequence = seq;
+        frame.atUs = slot.atUs.load(std::memory_order_relaxed);
+        const uint32_t meta = slot.meta.load(std::memory_order_relaxed);
+        frame.dir = static_cast<ModbusFrameDir>(meta & 0xFFu);
+        frame.crcOk = (meta & (1u << 8)) != 0;
+        frame.length = static_cast<uint16_t>(meta >> 16);
+        const std::size_t kept = frame.stored();
+        for (std::size_t w = 0; w * 4 < kept; ++w) {
+            const uint32_t word = slot.words[w].load(std::memory_order_relaxed);
+            for (std::size_t b = 0; b < 4 && w * 4 + b < kept; ++b) {
+                frame.bytes[w * 4 + b] = static_cast<uint8_t>(word >> (8 * b));
+            }
+        }
+        std::atomic_thread_fence(std::memory_order_acquire);
+        if (slot.seq.load(std::memory_order_relaxed) != seq) {
+            continue;  // overwritten while copied
+        }
+        out[n++] = frame;
+    }
+    return n;
+}
@@ -0,0 +1,80 @@
+// SPDX-FileCopyrightText: 2026 Cryptotomte
+// SPDX-License-Identifier: AGPL-3.0-or-later
+/**
+ * @file ModbusLinkStats.cpp
+ * @brief Implementation of the per-link Modbus histograms and error split.
+ */
+
+#include "sensors/ModbusLinkStats.h"
+
+std::size_t modbusLatencyBucket(uint64_t latencyUs)
+{
+    for (std::size_t i = 0; i < kModbusLatencyBuckets; ++i) {
+        if (latencyUs <= (static_cast<uint64_t>(kModbusLatencyBaseUs) << i)) {
+            return i;
+        }
+    }
+    return kModbusLatencyBuckets;
+}
+
+uint32_t modbusLatencyQuantileUs(const ModbusLinkStats& link, uint32_t permille)
+{
+    uint64_t total = 0;
+    for (uint32_t n : link.latency) {
+        total += n;
+    }
+    if (total == 0) {
+        return 0;
+    }
+    // Nearest rank: the smallest bucket covering permille of the transfers.
+    const uint64_t rank = (total * permille + 999) / 1000;
+    uint64_t cumulative = 0;
+    for (std::size_t b = 0; b < kModbusLatencyBuckets; ++b) {
+        cumulative += link.latency[b];
+        if (cumulative >= rank && cumulative != 0) {
+            return kModbusLatencyBaseUs << b;
+        }
+    }
+    return UINT32_MAX;
+}
+
+void ModbusLinkTable::record(uint8_t address, uint8_t function, int error,
+                             int64_t latencyUs, int64_t nowUs)
+{
+    ModbusLinkStats* link = nullptr;
+    for (std::size_t i = 0; i < count_ && link == nullptr; ++i) {
+        if (links_[i].address == address && links_[i].function == function) {
+            link = &links_[i];
+        }
+    }
+    if (link == nullptr) {
+        if (count_ == kModbusLinks) {
+            ++untracked_;
+            return;
+        }
+        link = &links_[count_++];
+        link->address = address;
+        link->function = function;
+    }
+
+    if (error == 0) {
+        ++link->ok;
+        link->lastSuccessUs = nowUs;
+    } else if (error == 3) {
+        ++link->timeouts;
+    } else if (error == 2) {
+        ++link->frameErrors;
+    } else if (error >= 100) {
+        ++link->exceptions;
+    } else {
+        ++link->otherErrors;
+    }
+    const uint64_t us = latencyUs > 0 ? static_cast<uint64_t>(latencyUs) : 0u;
+    ++link->latency[modbusLatencyBucket(us)];
+    link->latencySumUs += us;
+}
+
+std::vector<ModbusLinkStats> ModbusLinkTable::snapshot() const
+{
+    return std::vector<ModbusLinkStats>(links_.begin(), links_.begin() + count_);
+}
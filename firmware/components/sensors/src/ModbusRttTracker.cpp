@@ -0,0 +1,137 @@
+// SPDX-FileCopyrightText: 2026 Cryptotomte
+// SPDX-License-Identifier: AGPL-3.0-or-later
+/**
+ * @file ModbusRttTracker.cpp
+ * @brief Implementation of the per-slave RTT estimate and adaptive timeout.
+ */
+
+#include "sensors/ModbusRttTracker.h"
+
+#include <algorithm>
+#include <iterator>
+
+namespace {
+
+/// A fallback (configured-timeout) request is due at this many timeouts.
+bool fallbackDue(uint32_t timeouts)
+{
+    if (timeouts < ModbusRttTracker::kFallbackAfter ||
+        timeouts % ModbusRttTracker::kFallbackAfter != 0) {
+        return false;
+    }
+    const uint32_t n = timeouts / ModbusRttTracker::kFallbackAfter;
+    if (n >= ModbusRttTracker::kMaxBackoff) {
+        return n % ModbusRttTracker::kMaxBackoff == 0;
+    }
+    return (n & (n - 1)) == 0;  // 1, 2, 4, 8
+}
+
+uint32_t absDiff(uint32_t a, uint32_t b)
+{
+    return a > b ? a - b : b - a;
+}
+
+}  // namespace
+
+const ModbusRttTracker::Slot* ModbusRttTracker::find(uint8_t address) const
+{
+    for (std::size_t i = 0; i < count_; ++i) {
+        if (slots_[i].address == address) {
+            return &slots_[i];
+        }
+    }
+    return nullptr;
+}
+
+ModbusRttTracker::Slot& ModbusRttTracker::slotFor(uint8_t address)
+{
+    Slot* slot = const_cast<Slot*>(find(address));
+    if (slot == nullptr) {
+        if (count_ < kMaxSlaves) {
+            slot = &slots_[count_++];
+        } else {
+            slot = std::min_element(std::begin(slots_), std::end(slots_),
+                                    [](const Slot& a, const Slot& b) {
+                                        return a.lastUse < b.lastUse;
+                                    });
+        }
+        *slot = Slot{};
+        slot->address = address;
+    }
+    slot->lastUse = ++useClock_;
+    return *slot;
+}
+
+uint32_t ModbusRttTracker::p95(const Slot& slot)
+{
+    const std::size_t n = std::min<std::size_t>(slot.samples, kWindow);
+    uint32_t sorted[kWindow];
+    std::copy(slot.window, slot.window + n, sorted);
+    std::sort(sorted, sorted + n);
+    return sorted[(n * 95 + 99) / 100 - 1];  // nearest rank
+}
+
+uint32_t ModbusRttTracker::timeoutFor(const Slot& slot) const
+{
+    const uint32_t ceiling = std::min(kCeilingMs, configuredMs_);
+    if (fallbackDue(slot.consecutiveTimeouts)) {
+        return configuredMs_;
+    }
+    if (slot.samples == 0) {
+        return ceiling;  // never answered; the first request was the fallback
+    }
+    const uint64_t ewmaUs = static_cast<uint64_t>(slot.srttUs) + 4ull * slot.rttvarUs;
+    const uint64_t pctUs = static_cast<uint64_t>(p95(slot)) * 3 / 2;
+    const uint64_t ms = (std::max(ewmaUs, pctUs) + 999) / 1000;
+    const uint32_t floor = std::min(kFloorMs, ceiling);
+    return static_cast<uint32_t>(std::clamp<uint64_t>(ms, floor, ceiling));
+}
+
+uint32_t ModbusRttTracker::timeoutFor(uint8_t address) const
+{
+    const Slot* slot = find(address);
+    return slot == nullptr ? configuredMs_ : timeoutFor(*slot);
+}
+
+void ModbusRttTracker::recordAnswer(uint8_t address, uint32_t rttUs)
+{
+    Slot& slot = slotFor(address);
+    if (slot.samples == 0) {
+        slot.srttUs = rttUs;
+        slot.rttvarUs = rttUs / 2;
+    } else {
+        slot.rttvarUs = slot.rttvarUs - slot.rttvarUs / 4 + absDiff(slot.srttUs, rttUs) / 4;
+        slot.srttUs = slot.srttUs - slot.srttUs / 8 + rttUs / 8;
+    }
+    slot.window[slot.windowNext] = rttUs;
+    slot.windowNext = (slot.windowNext + 1) % kWindow;
+    if (slot.samples != UINT32_MAX) {
+        ++slot.samples;
+    }
+    slot.consecutiveTimeouts = 0;
+}
+
+void ModbusRttTracker::recordTimeout(uint8_t address)
+{
+    Slot& slot = slotFor(address);
+    if (slot.consecutiveTimeouts != UINT32_MAX) {
+        ++slot.consecutiveTimeouts;
+    }
+}
+
+ModbusSlaveRtt ModbusRttTracker::slave(std::size_t index) const
+{
+    ModbusSlaveRtt out;
+    if (index >= count_) {
+        return out;
+    }
+    const Slot& slot = slots_[index];
+    out.address = slot.address;
+    out.samples = slot.samples;
+    out.srttUs = slot.srttUs;
+    out.rttvarUs = slot.rttvarUs;
+    out.p95Us = slot.samples == 0 ? 0 : p95(slot);
+    out.consecutiveTimeouts = slot.consecutiveTimeouts;
+    out.timeoutMs = timeoutFor(slot);
+    return out;
+}
@@ -0,0 +1,185 @@
+// SPDX-FileCopyrightText: 2026 Cryptotomte
+// SPDX-License-Identifier: AGPL-3.0-or-later
+/**
+ * @file ModbusRtuFrame.cpp
+ * @brief Implementation of the Modbus RTU request/response framing.
+ */
+
+#include "sensors/ModbusRtuFrame.h"
+
+#include <array>
+
+namespace {
+
+constexpr uint8_t kReadHolding = 0x03;
+constexpr uint8_t kWriteSingle = 0x06;
+constexpr uint8_t kWriteMultiple = 0x10;
+constexpr uint8_t kExceptionFlag = 0x80;
+
+constexpr int kOk = 0;
+constexpr int kErrFrame = 2;
+constexpr int kErrExceptionBase = 100;
+
+constexpr std::array<uint16_t, 256> makeCrcTable()
+{
+    std::array<uint16_t, 256> table{};
+    for (unsigned i = 0; i < 256; ++i) {
+        uint16_t crc = static_cast<uint16_t>(i);
+        for (int bit = 0; bit < 8; ++bit) {
+            crc = (crc & 1u) != 0 ? static_cast<uint16_t>((crc >> 1) ^ 0xA001u)
+                                  : static_cast<uint16_t>(crc >> 1);
+        }
+        table[i] = crc;
+    }
+    return table;
+}
+
+constexpr std::array<uint16_t, 256> kCrcTable = makeCrcTable();
+
+void putU16(uint8_t* out, uint16_t v)
+{
+    out[0] = static_cast<uint8_t>(v >> 8);
+    out[1] = static_cast<uint8_t>(v & 0xFF);
+}
+
+uint16_t getU16(const uint8_t* in)
+{
+    return static_cast<uint16_t>((in[0] << 8) | in[1]);
+}
+
+/// Request of 6 header bytes plus the CRC.
+void buildRequest(uint8_t address, uint8_t function, uint16_t a, uint16_t b, uint8_t* out)
+{
+    out[0] = address;
+    out[1] = function;
+    putU16(out + 2, a);
+    putU16(out + 4, b);
+    const uint16_t crc = modbusCrc16(out, 6);
+    out[6] = static_cast<uint8_t>(crc & 0xFF);  // CRC low byte first
+    out[7] = static_cast<uint8_t>(crc >> 8);
+}
+
+bool crcOk(const uint8_t* frame, std::size_t len)
+{
+    if (len < 4) {
+        return false;
+    }
+    const uint16_t crc = modbusCrc16(frame, len - 2);
+    return frame[len - 2] == (crc & 0xFF) && frame[len - 1] == (crc >> 8);
+}
+
+/// The part of the checks both functions share: CRC, address, function,
+/// and the exception form. @return -1 when the frame is a normal response
+/// that still needs its function-specific checks.
+int checkCommon(const uint8_t* frame, std::size_t len, uint8_t address, uint8_t function)
+{
+    if (frame == nullptr || len < kModbusExceptionBytes || !crcOk(frame, len) ||
+        frame[0] != address) {
+        return kErrFrame;
+    }
+    if (frame[1] == (function | kExceptionFlag)) {
+        return len == kModbusExceptionBytes ? kErrExceptionBase + frame[2] : kErrFrame;
+    }
+    return frame[1] == function ? -1 : kErrFrame;
+}
+
+}  // namespace
+
+uint16_t modbusCrc16(const uint8_t* data, std::size_t len)
+{
+    uint16_t crc = 0xFFFF;
+    for (std::size_t i = 0; i < len; ++i) {
+        crc = static_cast<uint16_t>((crc >> 8) ^ kCrcTable[(crc ^ data[i]) & 0xFF]);
+    }
+    return crc;
+}
+
+void buildReadHoldingRequest(uint8_t address, uint16_t startRegister, uint16_t count,
+                             uint8_t* out)
+{
+    buildRequest(address, kReadHolding, startRegister, count, out);
+}
+
+void buildWriteSingleRequest(uint8_t address, uint16_t registerAddress, uint16_t value,
+                             uint8_t* out)
+{
+    buildRequest(address, kWriteSingle, registerAddress, value, out);
+}
+
+std::size_t buildWriteMultipleRequest(uint8_t address, uint16_t startRegister,
+                                      uint16_t count, const uint16_t* values, uint8_t* out)
+{
+    out[0] = address;
+    out[1] = kWriteMultiple;
+    putU16(out + 2, startRegister);
+    putU16(out + 4, count);
+    out[6] = static_cast<uint8_t>(2 * count);
+    for (uint16_t i = 0; i < count; ++i) {
+        putU16(out + 7 + 2 * i, values[i]);
+    }
+    const std::size_t body = 7 + 2 * static_cast<std::size_t>(count);
+    const uint16_t crc = modbusCrc16(out, body);
+    out[body] = static_cast<uint8_t>(crc & 0xFF);
+    out[body + 1] = static_cast<uint8_t>(crc >> 8);
+    return body + 2;
+}
+
+std::size_t modbusExpectedResponseBytes(uint8_t function, const uint8_t* received,
+                                        std::size_t receivedLen)
+{
+    if (receivedLen < 2 || (received[1] & kExceptionFlag) != 0) {
+        return kModbusExceptionBytes;
+    }
+    if (function == kWriteSingle || function == kWriteMultiple) {
+        return kModbusRequestBytes;
+    }
+    if (receivedLen < 3) {
+        return kModbusExceptionBytes;
+    }
+    return 5 + static_cast<std::size_t>(received[2]);
+}
+
+int parseReadHoldingResponse(const uint8_t* frame, std::size_t len, uint8_t address,
+                             uint16_t count, uint16_t* out)
+{
+    const int common = checkCommon(frame, len, address, kReadHolding);
+    if (common != -1) {
+        return common;
+    }
+    const std::size_t bytes = 2u * count;
+    if (frame[2] != bytes || len != 5 + bytes) {
+        return kErrFrame;
+    }
+    for (uint16_t i = 0; i < count; ++i) {
+        out[i] = getU16(frame + 3 + 2 * i);
+    }
+    return kOk;
+}
+
+int parseWriteSingleResponse(const uint8_t* frame, std::size_t len, uint8_t address,
+                             uint16_t registerAddress, uint16_t value)
+{
+    const int common = checkCommon(frame, len, address, kWriteSingle);
+    if (common != -1) {
+        return common;
+    }
+    if (len != kModbusRequestBytes || getU16(frame + 2) != registerAddress ||
+        getU16(frame + 4) != value) {
+        return kErrFrame;
+    }
+    return kOk;
+}
+
+int parseWriteMultipleResponse(const uint8_t* frame, std::size_t len, uint8_t address,
+                               uint16_t startRegister, uint16_t count)
+{
+    const int common = checkCommon(frame, len, address, kWriteMultiple);
+    if (common != -1) {
+        return common;
+    }
+    if (len != kModbusRequestBytes || getU16(frame + 2) != startRegister ||
+        getU16(frame + 4) != count) {
+        return kErrFrame;
+    }
+    return kOk;
+}
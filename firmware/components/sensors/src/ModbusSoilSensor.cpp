@@ -29,6 +29,10 @@
  *  - The availability/initialization probe reads ONE register at 0x0000
  *    (legacy REG_HUMIDITY, :65 and :140) — not 0x0001.
  *
+ * Not legacy: readGroup() reads the fast (0x0000–0x0001) or slow
+ * (0x0002–0x0006) registers alone with the same decode and validation;
+ * read() stays the 9-register parity transaction.
+ *
  * Error codes follow the new normative table (data-model.md) instead of the
  * legacy ad-hoc codes 4/6..14: client failures propagate the client's error
  * (2/3/100+n), range validation failure is 5 (parity), and the legacy
@@ -41,6 +45,8 @@
 
 #include "esp_log.h"
 
+#include "interfaces/TraceBuffer.h"
+
 static const char *TAG = "soilsensor";
 
 ModbusSoilSensor::ModbusSoilSensor(IModbusClient& client, uint8_t deviceAddress)
@@ -82,23 +88,46 @@ bool ModbusSoilSensor::initialize()
 
 bool ModbusSoilSensor::read()
 {
+    return readGroup(SoilReadGroup::All);
+}
+
+bool ModbusSoilSensor::readGroup(SoilReadGroup group)
+{
+    const bool fast = readsFastGroup(group);
+    const bool slow = readsSlowGroup(group);
+    // A failure is the outcome of the groups this read covered only.
+    const auto failed = [&]() {
+        if (fast) {
+            lastReadOk_ = false;
+        }
+        if (slow) {
+            slowReadOk_ = false;
+        }
+        return false;
+    };
+
     // Lazy initialization (legacy :77-81). A failure here is already
     // logged inside initialize() (both exits) and lastError_ is set there.
     if (!initialized_ && !initialize()) {
-        lastReadOk_ = false;  // read outcome for snapshot()
-        return false;
+        return failed();
     }
 
-    // One 9-register transaction, single bus attempt (FR-004/parity).
+    // One transaction, single bus attempt (FR-004/parity): the 9 parity
+    // registers for read(), the group's registers otherwise. The buffer is
+    // indexed by register address either way.
     uint16_t registerValues[kReadRegisterCount] = {};
-    if (!client_.readHoldingRegisters(deviceAddress_, kRegHumidity,
-                                      kReadRegisterCount, registerValues)) {
+    const uint16_t first = fast ? kRegHumidity : kRegEc;
+    const uint16_t count = group == SoilReadGroup::All ? kReadRegisterCount
+                           : fast                      ? kFastRegisterCount
+                                                       : kSlowRegisterCount;
+    if (!client_.readHoldingRegisters(deviceAddress_, first, count,
+                                      registerValues + first)) {
         // Client failure: propagate the client's error code (legacy used
         // the ad-hoc code 4) and leave the last-good values untouched.
+        // The client has logged the request failure: trace, do not repeat.
         lastError_ = client_.getLastError();
-        ESP_LOGW(TAG, "read failed: bus error %d", lastError_);
-        lastReadOk_ = false;
-        return false;
+        WS_TRACE(Error, SoilReadFailed, deviceAddress_, lastError_);
+        return failed();
     }
 
     // Decode + scale into locals first — the members are published only
@@ -106,52 +135,61 @@ bool ModbusSoilSensor::read()
     //
     // 0x0000 humidity/moisture 0.1 % — NO moisture calibration factor in
     // the read path (legacy parity, see file header).
-    const float humidity = static_cast<float>(registerValues[0]) / 10.0f;
+    const float humidity = static_cast<float>(registerValues[kRegHumidity]) / 10.0f;
     const float moisture = humidity;
     // 0x0001 temperature 0.1 °C, SIGNED 16-bit (legacy :98-99).
     const float temperature =
-        static_cast<float>(static_cast<int16_t>(registerValues[1])) / 10.0f;
+        static_cast<float>(static_cast<int16_t>(registerValues[kRegTemperature])) /
+        10.0f;
     // 0x0002 EC 1 µS/cm, calibration factor applied (legacy :102-103).
     const float ec =
-        static_cast<float>(registerValues[2]) * ecCalibrationFactor_;
+        static_cast<float>(registerValues[kRegEc]) * ecCalibrationFactor_;
     // 0x0003 pH 0.1, calibration factor applied (legacy :106-107).
     const float ph =
-        (static_cast<float>(registerValues[3]) / 10.0f) * phCalibrationFactor_;
+        (static_cast<float>(registerValues[kRegPh]) / 10.0f) * phCalibrationFactor_;
     // 0x0004–0x0006 N/P/K 1 mg/kg, unscaled.
-    const float nitrogen = static_cast<float>(registerValues[4]);
-    const float phosphorus = static_cast<float>(registerValues[5]);
-    const float potassium = static_cast<float>(registerValues[6]);
+    const float nitrogen = static_cast<float>(registerValues[kRegNitrogen]);
+    const float phosphorus = static_cast<float>(registerValues[kRegPhosphorus]);
+    const float potassium = static_cast<float>(registerValues[kRegPotassium]);
     // 0x0007 salinity and 0x0008 TDS are read but not exposed (parity).
 
     // Validate AFTER decode/scaling, on the factored values (legacy
-    // :121-128 order). Failure publishes nothing.
-    if (moisture < kMoistureMin || moisture > kMoistureMax ||
-        temperature < kTemperatureMin || temperature > kTemperatureMax ||
-        ph < kPhMin || ph > kPhMax) {
+    // :121-128 order), the quantities this read covered. Failure publishes
+    // nothing.
+    if (fast && (moisture < kMoistureMin || moisture > kMoistureMax ||
+                 temperature < kTemperatureMin || temperature > kTemperatureMax)) {
         lastError_ = 5;  // Range validation failed (parity error 5).
-        ESP_LOGW(TAG,
-                 "read failed: range validation (moisture=%.1f temp=%.1f "
-                 "ph=%.1f)",
-                 static_cast<double>(moisture),
-                 static_cast<double>(temperature), static_cast<double>(ph));
-        lastReadOk_ = false;
-        return false;
+        ESP_LOGW(TAG, "read failed: range validation (moisture=%.1f temp=%.1f)",
+                 static_cast<double>(moisture), static_cast<double>(temperature));
+        return failed();
+    }
+    if (slow && (ph < kPhMin || ph > kPhMax)) {
+        lastError_ = 5;
+        ESP_LOGW(TAG, "read failed: range validation (ph=%.1f)",
+                 static_cast<double>(ph));
+        return failed();
     }
 
     // Publish atomically w.r.t. this object: plain members are fine —
     // cross-task exclusion is LockedSoilSensor's job.
-    humidity_ = humidity;
-    moisture_ = moisture;
-    temperature_ = temperature;
-    ec_ = ec;
-    ph_ = ph;
-    nitrogen_ = nitrogen;
-    phosphorus_ = phosphorus;
-    potassium_ = potassium;
+    if (fast) {
+        humidity_ = humidity;
+        moisture_ = moisture;
+        temperature_ = temperature;
+        lastReadOk_ = true;
+        hasEverReadOk_ = true;
+    }
+    if (slow) {
+        ec_ = ec;
+        ph_ = ph;
+        nitrogen_ = nitrogen;
+        phosphorus_ = phosphorus;
+        potassium_ = potassium;
+        slowReadOk_ = true;
+        slowEverReadOk_ = true;
+    }
 
     lastError_ = 0;
-    lastReadOk_ = true;
-    hasEverReadOk_ = true;
     return true;
 }
 
@@ -162,6 +200,8 @@ SoilSnapshot ModbusSoilSensor::snapshot()
     SoilSnapshot s;
     s.readOk = lastReadOk_;
     s.available = hasEverReadOk_;
+    s.slowReadOk = slowReadOk_;
+    s.slowAvailable = slowEverReadOk_;
     s.lastError = lastError_;
     s.moisture = moisture_;
     s.temperature = temperature_;
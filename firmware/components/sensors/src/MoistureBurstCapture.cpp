@@ -0,0 +1,88 @@
+// SPDX-FileCopyrightText: 2026 Cryptotomte
+// SPDX-License-Identifier: AGPL-3.0-or-later
+/**
+ * @file MoistureBurstCapture.cpp
+ * @brief Capture states, per-second averaging and the batch flush (see
+ *        MoistureBurstCapture.h).
+ */
+
+#include "sensors/MoistureBurstCapture.h"
+
+#include <cmath>
+
+MoistureBurstCapture::MoistureBurstCapture(IDataStorage& storage, const IWallClock& clock,
+                                           int64_t tailMs)
+    : storage_(storage), clock_(clock), tailMs_(tailMs < 0 ? 0 : tailMs),
+      batch_(kSeconds, SensorReading{kMetric, 0, 0.0f})
+{
+}
+
+bool MoistureBurstCapture::update(bool pumpRunning, int64_t nowMs)
+{
+    if (pumpRunning) {
+        if (state_ == State::Idle) {
+            head_ = 0;
+            size_ = 0;
+            stats_.reads = 0;
+            stats_.overwritten = 0;
+        }
+        state_ = State::Running;
+    } else if (state_ == State::Running) {
+        state_ = State::Tail;
+        tailEndMs_ = nowMs + tailMs_;
+    } else if (state_ == State::Tail && nowMs >= tailEndMs_) {
+        flush();
+        state_ = State::Idle;
+    }
+    return capturing();
+}
+
+void MoistureBurstCapture::add(const TimedSoilSnapshot& sample)
+{
+    if (state_ == State::Idle || !sample.soil.readOk || !readsFastGroup(sample.group) ||
+        !std::isfinite(sample.soil.moisture)) {
+        return;
+    }
+    const WallTime now = clock_.now();
+    if (!now.set) {
+        return;
+    }
+    ++stats_.reads;
+    if (size_ != 0) {
+        Second& newest = ring_[(head_ + size_ - 1) % kSeconds];
+        // A clock stepped back joins the newest second: the batch stays in
+        // epoch order.
+        if (now.epoch <= newest.epoch) {
+            ++newest.reads;
+            newest.mean += (sample.soil.moisture - newest.mean) / static_cast<float>(newest.reads);
+            return;
+        }
+    }
+    if (size_ == kSeconds) {
+        head_ = (head_ + 1) % kSeconds;  // drop the oldest second
+        --size_;
+        ++stats_.overwritten;
+    }
+    ring_[(head_ + size_) % kSeconds] = Second{now.epoch, sample.soil.moisture, 1};
+    ++size_;
+}
+
+void MoistureBurstCapture::flush()
+{
+    if (size_ == 0) {
+        return;
+    }
+    for (std::size_t i = 0; i < size_; ++i) {
+        const Second& second = ring_[(head_ + i) % kSeconds];
+        batch_[i].epoch = second.epoch;
+        batch_[i].value = second.mean;
+    }
+    const std::size_t stored = storage_.storeSensorReadings(batch_.data(), size_);
+    ++stats_.captures;
+    stats_.seconds = static_cast<uint32_t>(stored);
+    if (stored != size_) {
+        ++stats_.failed;
+    }
+    head_ = 0;
+    size_ = 0;
+}
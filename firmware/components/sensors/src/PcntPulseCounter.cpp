@@ -0,0 +1,102 @@
+// SPDX-FileCopyrightText: 2026 Cryptotomte
+// SPDX-License-Identifier: AGPL-3.0-or-later
+/**
+ * @file PcntPulseCounter.cpp
+ * @brief PCNT flow-meter counter (esp32 targets only).
+ *
+ * Error handling is explicit (not ESP_ERROR_CHECK), as in GpioLevelSensor:
+ * a missing flow meter is logged and the pump keeps its timed runs —
+ * runForVolume() is only wired when initialize() succeeded.
+ */
+
+#include "sensors/PcntPulseCounter.h"
+
+#include "driver/gpio.h"
+#include "driver/pulse_cnt.h"
+#include "esp_log.h"
+
+static const char *TAG = "pcnt";
+
+PcntPulseCounter::~PcntPulseCounter()
+{
+    auto* unit = static_cast<pcnt_unit_handle_t>(unit_);
+    if (unit == nullptr) {
+        return;
+    }
+    pcnt_unit_stop(unit);
+    pcnt_unit_disable(unit);
+    if (channel_ != nullptr) {
+        pcnt_del_channel(static_cast<pcnt_channel_handle_t>(channel_));
+    }
+    pcnt_del_unit(unit);
+}
+
+bool PcntPulseCounter::initialize()
+{
+    pcnt_unit_config_t unitConfig = {};
+    unitConfig.low_limit = -1;  // never reached: rising edges only count up
+    unitConfig.high_limit = kHighLimit;
+    unitConfig.flags.accum_count = 1;
+    pcnt_unit_handle_t unit = nullptr;
+    esp_err_t err = pcnt_new_unit(&unitConfig, &unit);
+    if (err != ESP_OK) {
+        ESP_LOGE(TAG, "no PCNT unit for GPIO %d: %s", pin_, esp_err_to_name(err));
+        return false;
+    }
+    unit_ = unit;
+
+    pcnt_glitch_filter_config_t filter = {};
+    filter.max_glitch_ns = kGlitchNs;
+    pcnt_chan_config_t chanConfig = {};
+    chanConfig.edge_gpio_num = pin_;
+    chanConfig.level_gpio_num = -1;
+    pcnt_channel_handle_t channel = nullptr;
+    err = pcnt_unit_set_glitch_filter(unit, &filter);
+    if (err == ESP_OK) {
+        err = pcnt_new_channel(unit, &chanConfig, &channel);
+    }
+    if (err == ESP_OK) {
+        channel_ = channel;
+        err = pcnt_channel_set_edge_action(channel, PCNT_CHANNEL_EDGE_ACTION_INCREASE,
+                                           PCNT_CHANNEL_EDGE_ACTION_HOLD);
+    }
+    if (err == ESP_OK && gpio_pullup_en(static_cast<gpio_num_t>(pin_)) != ESP_OK) {
+        // Input-only pins have no pull-up: the board must provide one.
+        ESP_LOGW(TAG, "GPIO %d has no internal pull-up", pin_);
+    }
+    if (err == ESP_OK) {
+        // The accumulator folds the hardware count in at this watch point.
+        err = pcnt_unit_add_watch_point(unit, kHighLimit);
+    }
+    if (err == ESP_OK) {
+        err = pcnt_unit_enable(unit);
+    }
+    if (err == ESP_OK) {
+        err = pcnt_unit_clear_count(unit);
+    }
+    if (err == ESP_OK) {
+        err = pcnt_unit_start(unit);
+    }
+    if (err != ESP_OK) {
+        ESP_LOGE(TAG, "PCNT on GPIO %d failed: %s", pin_, esp_err_to_name(err));
+        pcnt_unit_disable(unit);  // fails harmlessly when never enabled
+        if (channel_ != nullptr) {
+            pcnt_del_channel(channel);
+            channel_ = nullptr;
+        }
+        pcnt_del_unit(unit);
+        unit_ = nullptr;
+        return false;
+    }
+    return true;
+}
+
+uint32_t PcntPulseCounter::pulses()
+{
+    auto* unit = static_cast<pcnt_unit_handle_t>(unit_);
+    int count = 0;
+    if (unit == nullptr || pcnt_unit_get_count(unit, &count) != ESP_OK) {
+        return 0;
+    }
+    return static_cast<uint32_t>(count);
+}
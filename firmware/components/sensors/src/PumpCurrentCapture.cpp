@@ -0,0 +1,89 @@
+// SPDX-FileCopyrightText: 2026 Cryptotomte
+// SPDX-License-Identifier: AGPL-3.0-or-later
+/**
+ * @file PumpCurrentCapture.cpp
+ * @brief Run bookkeeping and online statistics (see PumpCurrentCapture.h).
+ *
+ * Sums run in double: a 300 s run at ~1 kHz is ~270 000 samples, past the
+ * point where a float sum stops moving for a few-amp addend.
+ */
+
+#include "sensors/PumpCurrentCapture.h"
+
+#include <cmath>
+
+void PumpCurrentCapture::beginRun(uint32_t periodUs, int64_t nowUs)
+{
+    if (active_.load(std::memory_order_relaxed) != 0) {
+        endRun(nowUs);
+    }
+    stats_ = CurrentRunStats{};
+    stats_.run = nextRun_++;
+    stats_.periodUs = periodUs;
+    startUs_ = nowUs;
+    sum_ = 0.0;
+    sumSquares_ = 0.0;
+    periodUs_.store(periodUs, std::memory_order_relaxed);
+    active_.store(stats_.run, std::memory_order_release);
+}
+
+void PumpCurrentCapture::addSample(float amps)
+{
+    if (active_.load(std::memory_order_relaxed) == 0) {
+        return;
+    }
+    if (!std::isfinite(amps)) {
+        addMissed();
+        return;
+    }
+    ++stats_.samples;
+    sum_ += amps;
+    sumSquares_ += static_cast<double>(amps) * amps;
+    if (stats_.samples == 1 || amps > stats_.peakA) {
+        stats_.peakA = amps;
+    }
+    const float ma = std::round(amps * 1000.0f);
+    push(static_cast<int16_t>(ma > 32767.0f    ? 32767.0f
+                              : ma < -32767.0f ? -32767.0f
+                                               : ma));
+}
+
+void PumpCurrentCapture::addMissed(uint32_t count)
+{
+    if (active_.load(std::memory_order_relaxed) == 0) {
+        return;
+    }
+    stats_.missed += count;
+    for (uint32_t i = 0; i < count; ++i) {
+        push(kMissingSample);
+    }
+}
+
+CurrentRunStats PumpCurrentCapture::endRun(int64_t nowUs)
+{
+    if (active_.load(std::memory_order_relaxed) == 0) {
+        return CurrentRunStats{};
+    }
+    const int64_t elapsedUs = nowUs - startUs_;
+    stats_.durationMs =
+        elapsedUs > 0 ? static_cast<uint32_t>(elapsedUs / 1000) : 0;
+    if (stats_.samples > 0) {
+        const double n = static_cast<double>(stats_.samples);
+        stats_.meanA = static_cast<float>(sum_ / n);
+        stats_.rmsA = static_cast<float>(std::sqrt(sumSquares_ / n));
+    }
+    active_.store(0, std::memory_order_release);
+    last_.publish(stats_);
+    return stats_;
+}
+
+void PumpCurrentCapture::push(int16_t milliamps)
+{
+    CaptureSample sample;
+    sample.run = static_cast<uint16_t>(stats_.run);
+    sample.milliamps = milliamps;
+    if (!ring_.push(sample)) {
+        ++stats_.dropped;
+        droppedTotal_.fetch_add(1, std::memory_order_relaxed);
+    }
+}
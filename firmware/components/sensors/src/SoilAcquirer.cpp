@@ -0,0 +1,48 @@
+// SPDX-FileCopyrightText: 2026 Cryptotomte
+// SPDX-License-Identifier: AGPL-3.0-or-later
+/**
+ * @file SoilAcquirer.cpp
+ * @brief Implementation of the soil snapshot publisher.
+ */
+
+#include "sensors/SoilAcquirer.h"
+
+bool SoilAcquirer::acquire(SoilReadGroup group)
+{
+    const bool ok = sensor_.readGroup(group);
+    const int64_t atMs = clock_.nowMs();
+    const SoilSnapshot raw = sensor_.snapshot();
+    // The raw value: a filter's EWMA settles on a constant too, but only a
+    // frozen probe repeats its raw reading exactly.
+    if (flatline_ != nullptr && ok && readsFastGroup(group)) {
+        flatline_->sample(raw.moisture, atMs);
+    }
+    const SoilSnapshot soil = filter_ != nullptr ? filter_->apply(raw, atMs, group) : raw;
+    {
+        std::lock_guard<StaticMutex> lock(mutex_);
+        latest_.soil = soil;
+        latest_.suspect = flatline_ != nullptr && flatline_->flat();
+        latest_.atMs = atMs;
+        latest_.group = group;
+        if (ok && readsFastGroup(group)) {
+            latest_.fastAtMs = atMs;
+        }
+        if (ok && readsSlowGroup(group)) {
+            latest_.slowAtMs = atMs;
+        }
+        ++latest_.sequence;
+        if (latest_.sequence == 0) {
+            latest_.sequence = 1;  // 0 stays "nothing published"
+        }
+    }
+    if (listener_) {
+        listener_();
+    }
+    return ok;
+}
+
+TimedSoilSnapshot SoilAcquirer::latest() const
+{
+    std::lock_guard<StaticMutex> lock(mutex_);
+    return latest_;
+}
@@ -0,0 +1,182 @@
+// SPDX-FileCopyrightText: 2026 Cryptotomte
+// SPDX-License-Identifier: AGPL-3.0-or-later
+/**
+ * @file SoilPollScheduler.cpp
+ * @brief Implementation of the soil-probe round-robin and its bus budget.
+ */
+
+#include "sensors/SoilPollScheduler.h"
+
+#include <cctype>
+#include <utility>
+
+namespace {
+
+constexpr uint32_t kRequestBytes = 8;        ///< addr, fn, start, count, CRC
+constexpr uint32_t kResponseBytes = 3 + 2 * 9 + 2;  ///< addr, fn, len, 9 regs, CRC
+constexpr uint32_t kBitsPerChar = 10;        ///< 8N1: start + 8 data + stop
+constexpr uint32_t kSilenceHalfChars = 7;    ///< 3.5 characters
+constexpr uint32_t kFastSilenceUs = 1750;    ///< fixed above 19200 baud (Modbus RTU)
+
+bool isSeparator(char c)
+{
+    return c == ',' || std::isspace(static_cast<unsigned char>(c)) != 0;
+}
+
+}  // namespace
+
+std::size_t parseSoilAddresses(const char* text, uint8_t* out, std::size_t max)
+{
+    if (text == nullptr) {
+        return 0;
+    }
+    std::size_t count = 0;
+    const char* p = text;
+    for (;;) {
+        while (isSeparator(*p)) {
+            ++p;
+        }
+        if (*p == '\0') {
+            break;
+        }
+        unsigned base = 10;
+        if (p[0] == '0' && (p[1] == 'x' || p[1] == 'X')) {
+            base = 16;
+            p += 2;
+        }
+        uint32_t value = 0;
+        std::size_t digits = 0;
+        for (; *p != '\0' && !isSeparator(*p); ++p) {
+            const unsigned char c = static_cast<unsigned char>(*p);
+            unsigned digit = 0;
+            if (std::isdigit(c) != 0) {
+                digit = c - '0';
+            } else if (base == 16 && std::isxdigit(c) != 0) {
+                digit = static_cast<unsigned>(std::tolower(c) - 'a' + 10);
+            } else {
+                return 0;
+            }
+            value = value * base + digit;
+            if (value > 247) {
+                return 0;
+            }
+            ++digits;
+        }
+        if (digits == 0 || value == 0 || count == max) {
+            return 0;
+        }
+        for (std::size_t i = 0; i < count; ++i) {
+            if (out[i] == value) {
+                return 0;
+            }
+        }
+        out[count++] = static_cast<uint8_t>(value);
+    }
+    return count;
+}
+
+uint32_t soilReadAirtimeUs(uint32_t baud)
+{
+    if (baud == 0) {
+        return 0;
+    }
+    uint64_t bits = static_cast<uint64_t>(kRequestBytes + kResponseBytes) * kBitsPerChar;
+    uint64_t fixedUs = 0;
+    if (baud > 19200) {
+        fixedUs = 2 * kFastSilenceUs;
+    } else {
+        bits += static_cast<uint64_t>(kSilenceHalfChars) * kBitsPerChar;
+    }
+    return static_cast<uint32_t>(bits * 1000000u / baud + fixedUs);
+}
+
+SoilPollScheduler::SoilPollScheduler(uint32_t baud, std::function<uint64_t()> busTimeUs)
+    : readAirtimeUs_(soilReadAirtimeUs(baud)), busTimeUs_(std::move(busTimeUs))
+{
+    usage_.readAirtimeUs = readAirtimeUs_;
+}
+
+bool SoilPollScheduler::add(uint8_t address, ISoilSensor& sensor)
+{
+    if (count_ == kMaxProbes) {
+        return false;
+    }
+    probes_[count_] = Probe{address, &sensor};
+    ++count_;
+    std::lock_guard<StaticMutex> lock(mutex_);
+    usage_.probes = static_cast<uint32_t>(count_);
+    return true;
+}
+
+bool SoilPollScheduler::setFeed(std::size_t probe, SoilAcquirer& feed)
+{
+    if (probe == 0 || probe >= count_) {
+        return false;
+    }
+    probes_[probe].feed = &feed;
+    return true;
+}
+
+void SoilPollScheduler::beginPeriod(int64_t nowMs, uint32_t periodMs)
+{
+    const uint64_t busUs = busTimeUs_ ? busTimeUs_() : 0;
+    {
+        std::lock_guard<StaticMutex> lock(mutex_);
+        if (open_) {
+            usage_.missed += static_cast<uint32_t>(count_ - next_);
+            const int64_t elapsedMs = nowMs - periodStartMs_;
+            if (elapsedMs > 0) {
+                // busy µs over elapsed ms is already per mille
+                usage_.measuredPermille = static_cast<uint32_t>(
+                    (busUs - busAtStartUs_) / static_cast<uint64_t>(elapsedMs));
+            }
+        }
+        usage_.periodMs = periodMs;
+        usage_.budgetPermille =
+            periodMs == 0 ? 0
+                          : static_cast<uint32_t>(static_cast<uint64_t>(readAirtimeUs_) *
+                                                  count_ / periodMs);
+    }
+    open_ = true;
+    periodStartMs_ = nowMs;
+    periodMs_ = periodMs;
+    next_ = count_ > 1 ? 1 : count_;
+    busAtStartUs_ = busUs;
+}
+
+int64_t SoilPollScheduler::dueMs(std::size_t probe) const
+{
+    return periodStartMs_ + static_cast<int64_t>(static_cast<uint64_t>(periodMs_) *
+                                                 probe / count_);
+}
+
+uint32_t SoilPollScheduler::msUntilDue(int64_t nowMs) const
+{
+    if (!open_ || next_ >= count_) {
+        return UINT32_MAX;
+    }
+    const int64_t wait = dueMs(next_) - nowMs;
+    return wait <= 0 ? 0 : static_cast<uint32_t>(wait);
+}
+
+bool SoilPollScheduler::pollDue(int64_t nowMs)
+{
+    if (msUntilDue(nowMs) != 0) {
+        return false;
+    }
+    const Probe& probe = probes_[next_];
+    const bool ok = probe.feed != nullptr ? probe.feed->acquire() : probe.sensor->read();
+    ++next_;
+    std::lock_guard<StaticMutex> lock(mutex_);
+    ++usage_.polls;
+    if (!ok) {
+        ++usage_.failures;
+    }
+    return true;
+}
+
+SoilBusUsage SoilPollScheduler::usage() const
+{
+    std::lock_guard<StaticMutex> lock(mutex_);
+    return usage_;
+}
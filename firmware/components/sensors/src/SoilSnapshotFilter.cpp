@@ -0,0 +1,67 @@
+// SPDX-FileCopyrightText: 2026 Cryptotomte
+// SPDX-License-Identifier: AGPL-3.0-or-later
+/**
+ * @file SoilSnapshotFilter.cpp
+ * @brief Implementation of the soil snapshot filter stage.
+ */
+
+#include "sensors/SoilSnapshotFilter.h"
+
+SoilSnapshotFilter::SoilSnapshotFilter(const SoilFilterSettings& settings)
+    : moisture_(settings.moisture),
+      temperature_(settings.temperature),
+      humidity_(settings.humidity),
+      ph_(settings.ph),
+      ec_(settings.ec),
+      nitrogen_(settings.nitrogen),
+      phosphorus_(settings.phosphorus),
+      potassium_(settings.potassium)
+{
+}
+
+SoilSnapshot SoilSnapshotFilter::apply(const SoilSnapshot& raw, int64_t atMs,
+                                       SoilReadGroup group)
+{
+    SoilSnapshot out = raw;
+    if (readsFastGroup(group)) {
+        if (raw.readOk) {
+            moisture_.push(raw.moisture, atMs, out.moisture);
+            temperature_.push(raw.temperature, atMs, out.temperature);
+            humidity_.push(raw.humidity, atMs, out.humidity);
+            fast_ = out;
+            fastPrimed_ = true;
+        }
+    } else if (fastPrimed_) {
+        // Not read this time: the sensor's cached raw value must not
+        // replace the filtered one.
+        out.moisture = fast_.moisture;
+        out.temperature = fast_.temperature;
+        out.humidity = fast_.humidity;
+    }
+    if (readsSlowGroup(group)) {
+        if (raw.slowReadOk) {
+            ph_.push(raw.ph, atMs, out.ph);
+            ec_.push(raw.ec, atMs, out.ec);
+            nitrogen_.push(raw.nitrogen, atMs, out.nitrogen);
+            phosphorus_.push(raw.phosphorus, atMs, out.phosphorus);
+            potassium_.push(raw.potassium, atMs, out.potassium);
+            slow_ = out;
+            slowPrimed_ = true;
+        }
+    } else if (slowPrimed_) {
+        out.ph = slow_.ph;
+        out.ec = slow_.ec;
+        out.nitrogen = slow_.nitrogen;
+        out.phosphorus = slow_.phosphorus;
+        out.potassium = slow_.potassium;
+    }
+    return out;
+}
+
+uint32_t SoilSnapshotFilter::rejected() const
+{
+    return moisture_.rejected() + temperature_.rejected() +
+           humidity_.rejected() + ph_.rejected() + ec_.rejected() +
+           nitrogen_.rejected() + phosphorus_.rejected() +
+           potassium_.rejected();
+}
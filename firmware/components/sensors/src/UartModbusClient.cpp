@@ -0,0 +1,309 @@
+// SPDX-FileCopyrightText: 2026 Cryptotomte
+// SPDX-License-Identifier: AGPL-3.0-or-later
+/**
+ * @file UartModbusClient.cpp
+ * @brief Modbus RTU master on the ESP-IDF UART driver.
+ *
+ * Target-only translation unit, built instead of EspModbusClient.cpp when
+ * CONFIG_WS_MODBUS_CLIENT_UART is set. The UART setup mirrors
+ * EspModbusClient's (research.md R2/R3/R4); the framing is
+ * ModbusRtuFrame's.
+ */
+
+#include "sensors/UartModbusClient.h"
+
+#include "board/board.h"
+#include "driver/gpio.h"
+#include "driver/uart.h"
+#include "esp_log.h"
+#include "esp_rom_sys.h"
+#include "esp_timer.h"
+#include "freertos/FreeRTOS.h"
+
+static const char *TAG = "uart_modbus_client";
+
+namespace {
+
+constexpr uart_port_t kPort = static_cast<uart_port_t>(BOARD_RS485_UART_PORT);
+
+/// Driver RX ring: above the 128-byte hardware FIFO, room for the largest
+/// response.
+constexpr int kRxBufferBytes = 512;
+
+constexpr int kOk = 0;
+constexpr int kErrNotInitialized = 1;
+constexpr int kErrFrame = 2;
+constexpr int kErrTimeout = 3;
+
+TickType_t ticks_for_us(int64_t us)
+{
+    const TickType_t ticks = pdMS_TO_TICKS((us + 999) / 1000);
+    return ticks == 0 ? 1 : ticks;
+}
+
+}  // namespace
+
+UartModbusClient::~UartModbusClient()
+{
+    if (initialized_) {
+        uart_driver_delete(kPort);
+    }
+}
+
+bool UartModbusClient::initialize()
+{
+    if (initialized_) {
+        return true;
+    }
+    esp_err_t err = uart_driver_install(kPort, kRxBufferBytes, 0, 0, nullptr, 0);
+    if (err != ESP_OK) {
+        ESP_LOGE(TAG, "uart_driver_install failed: %s", esp_err_to_name(err));
+        lastError_ = kErrNotInitialized;
+        return false;
+    }
+
+    uart_config_t config = {};
+    config.baud_rate = static_cast<int>(baud_);
+    config.data_bits = UART_DATA_8_BITS;
+    config.parity = UART_PARITY_DISABLE;
+    config.stop_bits = UART_STOP_BITS_1;
+    config.flow_ctrl = UART_HW_FLOWCTRL_DISABLE;
+    config.source_clk = UART_SCLK_DEFAULT;
+    err = uart_param_config(kPort, &config);
+
+    // R2: RTS drives the transceiver DE on rev1 only (the one board #if,
+    // as in EspModbusClient.cpp).
+    if (err == ESP_OK) {
+        err = uart_set_pin(kPort, BOARD_PIN_RS485_TX, BOARD_PIN_RS485_RX,
+#if BOARD_HAS_RS485_DE
+                           BOARD_PIN_RS485_DE,
+#else
+                           UART_PIN_NO_CHANGE,
+#endif
+                           UART_PIN_NO_CHANGE);
+    }
+    // R2/R3: half-duplex on both boards (rev1 DE timing, rev2 echo gating).
+    if (err == ESP_OK) {
+        err = uart_set_mode(kPort, UART_MODE_RS485_HALF_DUPLEX);
+    }
+    // The frame gap as the hardware RX timeout: a frame reaches the driver
+    // when the line goes quiet, not when the FIFO threshold fills.
+    if (err == ESP_OK) {
+        err = uart_set_rx_timeout(kPort, kFrameGapChars);
+    }
+    // R4 (FW-2): RX pull-up against the floating rev2 RO.
+    if (err == ESP_OK) {
+        err = gpio_pullup_en(static_cast<gpio_num_t>(BOARD_PIN_RS485_RX));
+    }
+    if (err != ESP_OK) {
+        ESP_LOGE(TAG, "UART setup failed: %s", esp_err_to_name(err));
+        uart_driver_delete(kPort);
+        lastError_ = kErrNotInitialized;
+        return false;
+    }
+
+    ESP_LOGI(TAG,
+             "Modbus RTU master up: UART%d %lu 8N1, timeout %lu ms, "
+             "RS485 half-duplex, RX timeout %u chars",
+             BOARD_RS485_UART_PORT, static_cast<unsigned long>(baud_),
+             static_cast<unsigned long>(rtt_.configured()),
+             static_cast<unsigned>(kFrameGapChars));
+    initialized_ = true;
+    lastError_ = kOk;
+    return true;
+}
+
+std::size_t UartModbusClient::transact(uint8_t deviceAddress, const uint8_t* request,
+                                       std::size_t requestLen, uint8_t function)
+{
+    // Modbus RTU: at least 3.5 characters of silence before a frame.
+    const int64_t quietUs = esp_timer_get_time() - lastFrameEndUs_;
+    if (quietUs < frameGapUs_) {
+        esp_rom_delay_us(static_cast<uint32_t>(frameGapUs_ - quietUs));
+    }
+    if (capture_ != nullptr && capture_->enabled()) {
+        // Stale bytes of a late answer: captured before they are dropped.
+        std::size_t stale = 0;
+        if (uart_get_buffered_data_len(kPort, &stale) == ESP_OK && stale > 0) {
+            const int n = uart_read_bytes(kPort, rx_, static_cast<uint32_t>(sizeof rx_), 0);
+            if (n > 0) {
+                capture_->record(ModbusFrameDir::Rx,
+                                 static_cast<uint32_t>(esp_timer_get_time()), rx_,
+                                 static_cast<std::size_t>(n));
+            }
+        }
+    }
+    uart_flush_input(kPort);  // stale bytes of a late answer
+    const int64_t txUs = esp_timer_get_time();
+    uart_write_bytes(kPort, request, requestLen);
+    uart_wait_tx_done(kPort,
+                      ticks_for_us(charUs_ * static_cast<int64_t>(requestLen + 2)));
+
+    // First bytes within the response timeout, the rest of the frame at the
+    // line rate; the header fixes the length.
+    TickType_t wait = pdMS_TO_TICKS(rtt_.timeoutFor(deviceAddress));
+    std::size_t received = 0;
+    std::size_t expected = kModbusExceptionBytes;
+    while (received < expected) {
+        const int n = uart_read_bytes(kPort, rx_ + received,
+                                      static_cast<uint32_t>(expected - received), wait);
+        if (n <= 0) {
+            break;
+        }
+        received += static_cast<std::size_t>(n);
+        expected = modbusExpectedResponseBytes(function, rx_, received);
+        if (expected > sizeof rx_) {
+            break;  // a byte count no 0x03 response can carry
+        }
+        wait = ticks_for_us(charUs_ * static_cast<int64_t>(expected - received) + frameGapUs_);
+    }
+    lastFrameEndUs_ = esp_timer_get_time();
+    if (capture_ != nullptr) {
+        capture_->record(ModbusFrameDir::Tx, static_cast<uint32_t>(txUs), request,
+                         requestLen);
+        capture_->record(ModbusFrameDir::Rx, static_cast<uint32_t>(lastFrameEndUs_), rx_,
+                         received);
+    }
+    return received;
+}
+
+bool UartModbusClient::finish(uint8_t deviceAddress, int error, int64_t rttUs)
+{
+    lastError_ = error;
+    if (error == kErrTimeout) {
+        rtt_.recordTimeout(deviceAddress);
+    } else {
+        // Anything that came back, a bad frame included, is an answer.
+        rtt_.recordAnswer(deviceAddress,
+                          rttUs > UINT32_MAX ? UINT32_MAX : static_cast<uint32_t>(rttUs));
+    }
+    if (error != kOk) {
+        ++errorCount_;
+        ESP_LOGW(TAG, "request to addr=%u failed: error %d",
+                 static_cast<unsigned>(deviceAddress), error);
+        return false;
+    }
+    ++successCount_;
+    return true;
+}
+
+bool UartModbusClient::readHoldingRegisters(uint8_t deviceAddress,
+                                            uint16_t startRegister, uint16_t count,
+                                            uint16_t* buffer)
+{
+    // Exactly one bus attempt per call, one counter increment (parity).
+    if (!initialized_) {
+        lastError_ = kErrNotInitialized;
+        ++errorCount_;
+        return false;
+    }
+    if (count == 0 || count > kModbusMaxReadRegisters) {
+        lastError_ = kErrFrame;
+        ++errorCount_;
+        return false;
+    }
+    uint8_t request[kModbusRequestBytes];
+    buildReadHoldingRequest(deviceAddress, startRegister, count, request);
+    const int64_t startUs = esp_timer_get_time();
+    const std::size_t received = transact(deviceAddress, request, sizeof request, 0x03);
+    const int64_t rttUs = esp_timer_get_time() - startUs;
+    if (received == 0) {
+        return finish(deviceAddress, kErrTimeout, rttUs);
+    }
+    return finish(deviceAddress,
+                  parseReadHoldingResponse(rx_, received, deviceAddress, count, buffer),
+                  rttUs);
+}
+
+bool UartModbusClient::writeSingleRegister(uint8_t deviceAddress,
+                                           uint16_t registerAddress, uint16_t value)
+{
+    if (!initialized_) {
+        lastError_ = kErrNotInitialized;
+        ++errorCount_;
+        return false;
+    }
+    uint8_t request[kModbusRequestBytes];
+    buildWriteSingleRequest(deviceAddress, registerAddress, value, request);
+    const int64_t startUs = esp_timer_get_time();
+    const std::size_t received = transact(deviceAddress, request, sizeof request, 0x06);
+    const int64_t rttUs = esp_timer_get_time() - startUs;
+    if (received == 0) {
+        return finish(deviceAddress, kErrTimeout, rttUs);
+    }
+    // The full 8-byte echo is compared (legacy parity, unlike esp-modbus).
+    return finish(deviceAddress,
+                  parseWriteSingleResponse(rx_, received, deviceAddress, registerAddress,
+                                           value),
+                  rttUs);
+}
+
+bool UartModbusClient::writeMultipleRegisters(uint8_t deviceAddress,
+                                              uint16_t startRegister, uint16_t count,
+                                              const uint16_t* values)
+{
+    if (!initialized_) {
+        lastError_ = kErrNotInitialized;
+        ++errorCount_;
+        return false;
+    }
+    if (count == 0 || count > kModbusMaxWriteRegisters || values == nullptr) {
+        lastError_ = kErrFrame;
+        ++errorCount_;
+        return false;
+    }
+    uint8_t request[kModbusMaxRequestBytes];
+    const std::size_t len =
+        buildWriteMultipleRequest(deviceAddress, startRegister, count, values, request);
+    const int64_t startUs = esp_timer_get_time();
+    const std::size_t received = transact(deviceAddress, request, len, 0x10);
+    const int64_t rttUs = esp_timer_get_time() - startUs;
+    if (received == 0) {
+        return finish(deviceAddress, kErrTimeout, rttUs);
+    }
+    return finish(deviceAddress,
+                  parseWriteMultipleResponse(rx_, received, deviceAddress, startRegister,
+                                             count),
+                  rttUs);
+}
+
+void UartModbusClient::setTimeout(uint32_t timeoutMs)
+{
+    rtt_.setConfigured(timeoutMs);
+}
+
+bool UartModbusClient::setBaudRate(uint32_t baud)
+{
+    if (baud == 0) {
+        return false;
+    }
+    if (initialized_ && baud != baud_) {
+        const esp_err_t err = uart_set_baudrate(kPort, baud);
+        if (err != ESP_OK) {
+            ESP_LOGE(TAG, "uart_set_baudrate(%lu) failed: %s",
+                     static_cast<unsigned long>(baud), esp_err_to_name(err));
+            return false;
+        }
+        rtt_.reset();
+        ESP_LOGI(TAG, "line rate now %lu baud", static_cast<unsigned long>(baud));
+    }
+    baud_ = baud;
+    updateTiming();
+    return true;
+}
+
+void UartModbusClient::updateTiming()
+{
+    charUs_ = 10 * 1000000 / static_cast<int64_t>(baud_) + 1;
+    frameGapUs_ = charUs_ * 7 / 2;
+}
+
+void UartModbusClient::getStatistics(uint32_t* successCount, uint32_t* errorCount)
+{
+    if (successCount != nullptr) {
+        *successCount = successCount_;
+    }
+    if (errorCount != nullptr) {
+        *errorCount = errorCount_;
+    }
+}
@@ -0,0 +1,77 @@
+// SPDX-FileCopyrightText: 2026 Cryptotomte
+// SPDX-License-Identifier: AGPL-3.0-or-later
+/**
+ * @file BlockRingFile.h
+ * @brief A file of fixed-size slots written round-robin: the newest N
+ *        blocks, kept across reboots.
+ *
+ * The flash half of the input recording (control/InputRecorder.h): the
+ * recorder task appends each sealed RAM block, the recording endpoint walks
+ * the file oldest first. Each slot is an 8-byte header — the file sequence
+ * (uint32, +1 per append, never reused; 0 = empty slot) and the block
+ * length (uint16, then uint16 zero) — and the block. Append n lands in
+ * slot n % slots; open() finds the newest sequence by reading the slot
+ * headers. littlefs writes copy-on-write, so a slot is either the old
+ * block or the new one after a reset, never a torn mix, and there is no
+ * checksum.
+ *
+ * Cross-task: append() and forEach() serialize on an internal mutex, so a
+ * walk sees no append half done. POSIX stdio only, host-tested.
+ */
+
+#ifndef WATERINGSYSTEM_STORAGE_BLOCKRINGFILE_H
+#define WATERINGSYSTEM_STORAGE_BLOCKRINGFILE_H
+
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <string>
+
+#include "interfaces/StaticMutex.h"
+
+class BlockRingFile {
+public:
+    static constexpr std::size_t kSlotHeaderBytes = 8;
+
+    /// @p slots blocks of up to @p blockBytes at @p path (not opened yet).
+    BlockRingFile(std::string path, std::size_t slots, std::size_t blockBytes);
+
+    BlockRingFile(const BlockRingFile&) = delete;
+    BlockRingFile& operator=(const BlockRingFile&) = delete;
+
+    /**
+     * @brief Create the file or pick up where it ends. A file of a
+     * different size (the slot count or block size changed) is started over.
+     * @return false when it cannot be created
+     */
+    bool open();
+
+    /**
+     * @brief Write @p len bytes (at most blockBytes) over the oldest slot
+     * and fsync. @p mark is the caller's note of what it has now written
+     * (returned by forEach(), not stored).
+     */
+    bool append(const uint8_t* data, std::size_t len, uint32_t mark);
+
+    /**
+     * @brief Call @p fn with each block, oldest first, until it returns false.
+     * @return the mark of the last append() since open(), 0 if none
+     */
+    uint32_t forEach(const std::function<bool(const uint8_t* data, std::size_t len)>& fn) const;
+
+    /// Blocks held.
+    std::size_t count() const;
+
+private:
+    std::size_t slotBytes() const { return kSlotHeaderBytes + blockBytes_; }
+
+    const std::string path_;
+    const std::size_t slots_;
+    const std::size_t blockBytes_;
+    mutable StaticMutex mutex_;
+    bool open_ = false;
+    uint32_t newest_ = 0;  ///< file sequence of the newest block, 0 = empty
+    uint32_t mark_ = 0;
+};
+
+#endif /* WATERINGSYSTEM_STORAGE_BLOCKRINGFILE_H */
@@ -0,0 +1,67 @@
+// SPDX-FileCopyrightText: 2026 Cryptotomte
+// SPDX-License-Identifier: AGPL-3.0-or-later
+/**
+ * @file DeltaChunkCodec.h
+ * @brief Compressed history chunk codec (delta-of-delta epochs, XOR floats).
+ *
+ * The codec behind HistoryCodec::Delta, in the style of Gorilla
+ * time-series compression but byte-aligned, so every append is a whole
+ * number of bytes and needs no in-place rewrite of committed data:
+ *
+ *   chunk  = header {kMagic, kVersion} then frames, oldest first
+ *   frame  = tag byte, epoch field (0/1/2/4 bytes), value field (0..4 B)
+ *   tag    = [7:6] epoch class: 0 delta-of-delta is 0, 1 int8 dod,
+ *                  2 int16 dod, 3 absolute uint32 epoch
+ *            [5:3] n = significant bytes of value XOR previous value
+ *            [2:1] t = zero low-order bytes of that XOR (value field is
+ *                  XOR bytes t..t+n-1, little-endian), n + t <= 4
+ *            [0]   reserved, 0
+ *
+ * Every chunk restarts the state (the first frame is absolute and XORs
+ * against 0), so chunks decode — and are evicted — independently. A frame
+ * declares its own length in its first byte: a torn tail is a frame
+ * that is shorter than declared (or a tag that can never be valid), and
+ * ends the valid prefix like a partial 8-byte record does.
+ *
+ * A steady log interval costs 0 epoch bytes and an unchanged reading 0
+ * value bytes: 1 byte per sample at best, 9 at worst, against the fixed
+ * 8. Pure C++, no IDF includes.
+ */
+
+#ifndef WATERINGSYSTEM_STORAGE_DELTACHUNKCODEC_H
+#define WATERINGSYSTEM_STORAGE_DELTACHUNKCODEC_H
+
+#include <cstddef>
+#include <cstdint>
+
+namespace deltachunk {
+
+constexpr uint8_t kMagic = 0x5A;
+constexpr uint8_t kVersion = 1;
+constexpr std::size_t kHeaderBytes = 2;
+constexpr std::size_t kMaxFrameBytes = 9;  ///< tag + 4 epoch + 4 value
+
+/// Running state of one chunk; both sides keep it identical.
+struct State {
+    uint32_t epoch = 0;      ///< previous sample's epoch
+    int64_t delta = 0;       ///< previous epoch delta
+    uint32_t valueBits = 0;  ///< previous sample's float bits
+    bool started = false;    ///< false before a chunk's first frame
+};
+
+/// Encode one sample into `out`; returns the frame length (1..9).
+std::size_t encode(uint8_t out[kMaxFrameBytes], State& state, uint32_t epoch,
+                   float value);
+
+/// Decode one frame from `in` (`available` bytes). Returns the frame
+/// length, or 0 when the bytes are not a whole valid frame (torn tail);
+/// `state` is only advanced on success.
+std::size_t decode(const uint8_t* in, std::size_t available, State& state,
+                   uint32_t& epoch, float& value);
+
+/// True when `header` is a chunk header this codec version reads.
+bool validHeader(const uint8_t header[kHeaderBytes]);
+
+}  // namespace deltachunk
+
+#endif /* WATERINGSYSTEM_STORAGE_DELTACHUNKCODEC_H */
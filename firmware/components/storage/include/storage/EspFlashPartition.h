@@ -0,0 +1,67 @@
+// SPDX-FileCopyrightText: 2026 Cryptotomte
+// SPDX-License-Identifier: AGPL-3.0-or-later
+/**
+ * @file EspFlashPartition.h
+ * @brief Target-only IFlashPartition over esp_partition (read/write/erase
+ *        plus one esp_partition_mmap view).
+ *
+ * The only esp_partition code behind RingLogDataStorage: open() finds the
+ * `ringlog` data partition (docs/partition-plan.md) and maps it once for
+ * the zero-copy read path. esp_partition_write()/erase_range() invalidate
+ * the cache lines they touch, so the mapped view stays coherent with the
+ * storage's own writes.
+ *
+ * NOT built for the linux preview target — the host tests run the ring
+ * log over RamFlashPartition instead (see the storage component
+ * CMakeLists). Contains no logic beyond the IDF calls.
+ */
+
+#ifndef WATERINGSYSTEM_STORAGE_ESPFLASHPARTITION_H
+#define WATERINGSYSTEM_STORAGE_ESPFLASHPARTITION_H
+
+#include <cstddef>
+#include <cstdint>
+
+#include "esp_err.h"
+#include "esp_partition.h"
+
+#include "interfaces/IFlashPartition.h"
+
+/**
+ * @brief IFlashPartition over one esp_partition_t.
+ */
+class EspFlashPartition : public IFlashPartition {
+public:
+    /// Partition name in firmware/partitions_ringlog.csv.
+    static constexpr const char* kPartitionLabel = "ringlog";
+
+    EspFlashPartition() = default;
+    ~EspFlashPartition() override;
+
+    EspFlashPartition(const EspFlashPartition&) = delete;
+    EspFlashPartition& operator=(const EspFlashPartition&) = delete;
+
+    /**
+     * @brief Find data partition @p label and map it read-only.
+     *
+     * A failed mapping is not fatal: mapped() then returns nullptr and
+     * reads go through esp_partition_read().
+     *
+     * @return ESP_OK, or ESP_ERR_NOT_FOUND when the partition table has no
+     *         such partition (size() stays 0).
+     */
+    esp_err_t open(const char* label = kPartitionLabel);
+
+    std::size_t size() const override;
+    bool read(std::size_t offset, void* dst, std::size_t len) const override;
+    bool write(std::size_t offset, const void* src, std::size_t len) override;
+    bool eraseSector(std::size_t sector) override;
+    const uint8_t* mapped() const override { return map_; }
+
+private:
+    const esp_partition_t* partition_ = nullptr;
+    const uint8_t* map_ = nullptr;
+    esp_partition_mmap_handle_t mapHandle_ = 0;
+};
+
+#endif /* WATERINGSYSTEM_STORAGE_ESPFLASHPARTITION_H */
@@ -0,0 +1,114 @@
+// SPDX-FileCopyrightText: 2026 Cryptotomte
+// SPDX-License-Identifier: AGPL-3.0-or-later
+/**
+ * @file HistoryRollup.h
+ * @brief Rollup tiers for sensor history: tier table, bucketing, codec.
+ *
+ * The pure half of the aggregation subsystem behind
+ * LittleFsDataStorageOptions::rollups: which tiers exist, how readings
+ * fold into buckets, and the 20-byte on-disk record. Persistence (one
+ * bounded chunk ring per tier and metric under /rollup/<tier>/<metric>/)
+ * lives with the raw history in LittleFsDataStorage, which shares its
+ * chunk naming, ring eviction and torn-tail rules.
+ *
+ * A tier only ever holds FINISHED buckets: a bucket is written once the
+ * first reading of a later bucket has been committed, computed from the
+ * raw history (which outlives it in the ring). The newest, still-open
+ * bucket is answered from raw data at query time, so nothing about a
+ * tier is kept in RAM across a restart.
+ *
+ * The hour and day tiers can carry a quantile sketch per bucket
+ * (LittleFsDataStorageOptions::quantileSketches) in sibling rings under
+ * /rollup/<tier>-q/<metric>/: written from the same raw pass as the
+ * bucket, same rules, so window percentiles merge a few dozen sketches
+ * instead of reading every raw reading. No IDF includes.
+ */
+
+#ifndef WATERINGSYSTEM_STORAGE_HISTORYROLLUP_H
+#define WATERINGSYSTEM_STORAGE_HISTORYROLLUP_H
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+#include "interfaces/IDataStorage.h"
+#include "interfaces/QuantileSketch.h"
+
+namespace rollup {
+
+/// One rollup tier: bucket width plus the bounds of its chunk ring.
+struct Tier {
+    uint32_t bucketS;        ///< bucket width, one of kAggregateBucketsS
+    const char* dir;         ///< directory under /rollup/
+    std::size_t chunkBytes;  ///< chunk sealed when the next record won't fit
+    std::size_t maxChunks;   ///< ring bound; the oldest chunk is evicted
+};
+
+/// Record: uint32 LE bucket start, uint32 LE count, LE float min/max/sum.
+constexpr std::size_t kRecordBytes = 20;
+
+constexpr std::size_t kTierCount = 3;
+
+/// Finest first. Per metric at most 26 KiB: >= 102 minutes, >= 612 hours
+/// (25 days) and >= 204 days of finished buckets after an eviction.
+constexpr Tier kTiers[kTierCount] = {
+    {60, "1m", 2048, 2},
+    {3600, "1h", 4096, 4},
+    {86400, "1d", 2048, 3},
+};
+
+static_assert(kTiers[0].bucketS == IDataStorage::kAggregateBucketsS[0] &&
+                  kTiers[1].bucketS == IDataStorage::kAggregateBucketsS[1] &&
+                  kTiers[2].bucketS == IDataStorage::kAggregateBucketsS[2],
+              "one tier per contract bucket width");
+
+/// Index into kTiers of the tier with this bucket width, -1 if none.
+int tierIndex(uint32_t bucketS);
+
+/// Fold one reading into `buckets` (bucket order): extends the last
+/// bucket when the reading falls into it, otherwise starts a new one.
+void fold(std::vector<SensorAggregate>& buckets, uint32_t bucketS,
+          uint32_t epoch, float value);
+
+/// Fold several readings of one bucket, already summed up (`part.epoch`
+/// is the bucket start), into `buckets` the way fold() takes one.
+void merge(std::vector<SensorAggregate>& buckets, const SensorAggregate& part);
+
+void encode(uint8_t out[kRecordBytes], const SensorAggregate& bucket);
+SensorAggregate decode(const uint8_t in[kRecordBytes]);
+
+/// Sketch ring of one tier: which tier it follows plus its own bounds.
+struct SketchTier {
+    std::size_t tier;        ///< index into kTiers
+    const char* dir;         ///< directory under /rollup/
+    std::size_t chunkBytes;
+    std::size_t maxChunks;
+};
+
+/// Sketch record: uint32 LE bucket start, then the encoded sketch.
+constexpr std::size_t kSketchRecordBytes = 4 + QuantileSketch::kEncodedBytes;
+
+constexpr std::size_t kSketchTierCount = 2;
+
+/// Hour and day only (minute buckets hold too few readings to be worth a
+/// sketch). Per metric 26 KiB: >= 112 hours and >= 28 days of finished
+/// buckets after an eviction.
+constexpr SketchTier kSketchTiers[kSketchTierCount] = {
+    {1, "1h-q", 4096, 5},
+    {2, "1d-q", 2048, 3},
+};
+
+/// Index into kSketchTiers of the sketch ring following kTiers[tier], -1
+/// if none.
+int sketchTierFor(std::size_t tier);
+
+void encodeSketch(uint8_t out[kSketchRecordBytes], uint32_t bucketStart,
+                  const QuantileSketch& sketch);
+
+/// False on a malformed sketch (see QuantileSketch::decode).
+bool decodeSketch(const uint8_t in[kSketchRecordBytes], uint32_t& bucketStart,
+                  QuantileSketch& sketch);
+
+}  // namespace rollup
+
+#endif /* WATERINGSYSTEM_STORAGE_HISTORYROLLUP_H */
@@ -0,0 +1,70 @@
+// SPDX-FileCopyrightText: 2026 Cryptotomte
+// SPDX-License-Identifier: AGPL-3.0-or-later
+/**
+ * @file LegacyHistoryImport.h
+ * @brief Migration of the Arduino v2.3 sensor history (the frozen legacy
+ *        LittleFSStorage files) into the per-metric chunk ring.
+ *
+ * The legacy firmware kept each metric as ONE JSON array,
+ * <dir>/<sensor>_<type>.json of {"timestamp":<epoch>,"value":<float>}
+ * objects in append order; the file stem is already the metric name here
+ * (env_temperature, soil_ph, ...). Replaying it through
+ * storeSensorReading() would cost one fsync — and on the fixed codec one
+ * chunk-index lookup — per record, hours for a unit's worth. The import
+ * instead streams each file through a small block buffer (never the whole
+ * array in RAM), collects one chunk's worth of readings and hands them to
+ * LittleFsDataStorage::importHistory(): one whole chunk, one fsync.
+ *
+ * Resumable: importHistory() steps over a chunk an earlier run already
+ * wrote, so an interrupted import is just run again. A finished file is
+ * renamed to <name>.json.imported (kept for reference, never read again),
+ * so later runs cost one directory scan.
+ *
+ * Only known metric names are imported (metric::findKnown): a stray file
+ * must not spend the metric budget. Null values (ArduinoJson's NaN) and
+ * stamps before kMinEpoch (no NTP sync yet) are skipped. Run it before
+ * the storage's first append, on its owning task. Pure C++ / POSIX,
+ * host-tested.
+ */
+
+#ifndef WATERINGSYSTEM_STORAGE_LEGACYHISTORYIMPORT_H
+#define WATERINGSYSTEM_STORAGE_LEGACYHISTORYIMPORT_H
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+#include "storage/LittleFsDataStorage.h"
+
+namespace legacy {
+
+/// Earliest stamp taken as real time (2020-01-01, as TimeService).
+constexpr uint32_t kMinEpoch = 1577836800u;
+
+/// Readings per importHistory() call: one fixed-codec chunk (8 KiB of RAM).
+constexpr std::size_t kBatchPoints =
+    LittleFsDataStorage::kHistoryChunkMaxBytes / LittleFsDataStorage::kHistoryRecordBytes;
+
+/// Suffix appended to a legacy file once it is imported.
+constexpr const char* kDoneSuffix = ".imported";
+
+/// What one importHistory() run did.
+struct ImportStats {
+    std::size_t files = 0;    ///< legacy files imported (and renamed)
+    std::size_t failed = 0;   ///< files left for the next run (I/O failure)
+    std::size_t ignored = 0;  ///< .json files of no known metric
+    std::size_t points = 0;   ///< readings written
+    std::size_t chunks = 0;   ///< chunks written
+    std::size_t resumed = 0;  ///< chunks an earlier run had written
+    std::size_t skipped = 0;  ///< null, too early, out of order or no room
+};
+
+/**
+ * @brief Import every legacy history file in @p legacyDir into
+ * @p storage (see the file comment). A missing directory imports nothing.
+ */
+ImportStats importHistory(const std::string& legacyDir, LittleFsDataStorage& storage);
+
+}  // namespace legacy
+
+#endif /* WATERINGSYSTEM_STORAGE_LEGACYHISTORYIMPORT_H */
@@ -8,27 +8,92 @@
  * the same code runs under the /storage littlefs VFS mount on target and
  * against a temp directory in the linux-target host tests (research.md
  * D4). Storage statistics come from an injected provider
- * (esp_littlefs_info on target — wired in user story 4; a fake on host).
+ * (esp_littlefs_info on target — wired in user story 4; a fake on host),
+ * optionally cached and kept in step with this instance's own writes
+ * (LittleFsDataStorageOptions::statsResyncMs).
  *
  * On-disk formats per specs/003-nvs-littlefs-storage/data-model.md:
  *  - History: /hist/<metric>/<first_epoch>.dat append-only chunks of
  *    8-byte little-endian records {uint32 epoch, float value}; chunks
- *    sealed at 8 KiB, at most 10 chunks per metric (ring eviction), at
- *    most 10 distinct metrics (11th rejected).
- *  - Events: /events/0.log + 1.log, 0xE7-framed records
- *    {marker, uint32 epoch, uint8 category, uint8 detail_len, detail};
- *    16 KiB per file, truncate-and-switch rotation (newest always kept).
+ *    sealed at 8 KiB, at most 10 chunks per metric (ring eviction; a
+ *    retention plan sizes each metric's ring instead), at most
+ *    IDataStorage::kMaxMetrics distinct metrics (the next is rejected).
+ *  - History, delta codec (HistoryCodec::Delta, opt-in): the same tree
+ *    and ring bounds, chunks named <first_epoch>.dz holding a versioned
+ *    header plus variable-length delta-of-delta/XOR frames
+ *    (storage/DeltaChunkCodec.h). Chunks of either codec coexist; the
+ *    active chunk keeps its codec until it is sealed.
+ *  - History, row layout (HistoryFormat::Rows, opt-in): one record per
+ *    log tick under /rows/<first_epoch>.dat, 0xA5-framed {marker,
+ *    uint32 epoch, uint16 presence mask, packed float per set bit}; the
+ *    mask bit -> metric mapping is the append-only name table
+ *    /rows/metrics (one name per line, slot = line). Chunks sealed at
+ *    8 KiB, at most kRowMaxChunks chunks (ring eviction), same metric cap.
+ *  - History, multiplexed layout (HistoryFormat::Multiplexed, opt-in):
+ *    the row layout's ring under /mux/ with a metric-id column instead of
+ *    the mask, 0xA6-framed {marker, uint32 epoch, uint8 count, count x
+ *    {uint8 slot, float}}, names in /mux/metrics. A sealed chunk ends in
+ *    a 0xA7 footer {marker, uint64 presence bitmap, uint32 min/max
+ *    epoch} so a query skips, unread, every chunk that cannot hold its
+ *    metric. Metric cap kMuxMaxMetrics instead of kMaxMetrics.
+ *  - Chunk summaries (LittleFsDataStorageOptions::chunkSummaries, opt-in):
+ *    /sum/<metric>/<first_epoch>.sum per sealed per-metric chunk, one
+ *    0xC5-marked record {count, min/max epoch, min/max/sum/last value,
+ *    chunk length, CRC32 of the chunk} closed by a CRC32 of its own; a
+ *    sidecar, so the chunks keep their format. Removed with its chunk.
+ *  - Recompaction (LittleFsDataStorageOptions::backgroundMaintenance):
+ *    a sealed <first_epoch>.dat is re-encoded to <first_epoch>.dz.tmp,
+ *    synced, renamed to .dz and only then removed. A power cut leaves a
+ *    .tmp (removed on the next step) or both files, of which reads take
+ *    the .dz and the next write or step removes the .dat.
+ *  - Events: a ring of segment files /events/s<slot>.log
+ *    (LittleFsDataStorageOptions::eventSegments of them, sharing
+ *    eventLogBytes). A segment opens with an 8-byte header {"WSES",
+ *    uint32 LE sequence} and the segment with sequence q sits in slot
+ *    q % segments; then 0xE8-framed records {marker, uint32 epoch,
+ *    uint8 category, uint8 detail_len, detail, uint8 frame_len}, whose
+ *    trailing frame length lets getEvents() walk the newest records
+ *    backwards from the end of a segment. The active segment is the one
+ *    with the highest sequence, found from the headers alone. Rotation
+ *    rewrites the next slot with the next sequence, dropping only the
+ *    oldest segment (newest always kept). The two-file log of older
+ *    firmware (/events/0.log + 1.log, 0xE7 records without a trailer in
+ *    the oldest ones) is read as the oldest events until the ring first
+ *    wraps, which removes it.
  *
  * Durability (research.md D5): fflush+fsync per appended record; chunk
- * eviction via remove(); no in-place overwrites of committed data. Torn
- * tails: history = file size % 8 truncated logically on read; events =
- * marker/length framing, invalid tail skipped. The write path repairs a
+ * eviction via remove(); no in-place overwrites of committed data. The
+ * opt-in group-commit mode (LittleFsDataStorageOptions::
+ * groupCommitWindowMs) trades that for one fsync per metric file per
+ * window — see the option for the loss bound; events always keep
+ * per-record durability. The opt-in batch journal (journalBatches) makes
+ * a multi-metric batch one synced journal record instead. Torn tails:
+ * history = file size % 8 truncated logically on read; delta chunks, rows,
+ * multiplexed frames and events = marker/length framing, invalid tail
+ * skipped. The write path repairs a
  * torn tail (truncate to the valid prefix) before appending so committed
  * records always stay parseable.
  *
+ * Range queries lean on append order: under monotonic epochs a metric's
+ * records ascend across its chunks, so getSensorReadings() skips chunks
+ * that end before t0 (by the successor's filename epoch), binary-searches
+ * t0 in the first chunk it reads (delta chunks: decoded from the start)
+ * and stops at the first epoch past t1. An append that goes back in time
+ * first renames its chunk to <first_epoch>.u.dat (.u.dz); while such a
+ * chunk is in the ring, queries of that metric fall back to the full scan.
+ *
  * Stateless with respect to the filesystem: every operation derives its
- * state (active chunk, active event file) from the files themselves, so
- * a restart needs no recovery step. Unsynchronized by design —
+ * state (active chunk, active event segment) from the files themselves, so
+ * a restart needs no recovery step (with journalBatches, the first append
+ * replays what a power cut left of the last batch). The optional
+ * chunk-index cache (LittleFsDataStorageOptions::cacheChunkIndex) only
+ * memoizes that derivation per metric after the first append — it is
+ * rebuilt from the files on first use and dropped on any write failure,
+ * so the files stay the single source of truth. The event-tail cache
+ * (LittleFsDataStorageOptions::cacheEventTail) follows the same rule for
+ * the active event segment, and the recent-readings ring
+ * (LittleFsDataStorageOptions::recentReadings) is seeded from the files
+ * and dropped on any failed commit. Unsynchronized by design —
  * cross-task consumers wrap the storage in the Locked* decorator
  * (research.md D9, PR-02 CP3 precedent).
  */
@@ -36,13 +101,209 @@
 #ifndef WATERINGSYSTEM_STORAGE_LITTLEFSDATASTORAGE_H
 #define WATERINGSYSTEM_STORAGE_LITTLEFSDATASTORAGE_H
 
+#include <array>
 #include <cstddef>
 #include <cstdint>
+#include <cstdio>
 #include <functional>
+#include <list>
 #include <string>
+#include <string_view>
+#include <utility>
 #include <vector>
 
+#include "interfaces/BufferBudget.h"
 #include "interfaces/IDataStorage.h"
+#include "interfaces/ITimeProvider.h"
+#include "interfaces/MetricRegistry.h"
+#include "storage/DeltaChunkCodec.h"
+#include "storage/HistoryRollup.h"
+#include "storage/RetentionPlan.h"
+
+/// On-disk sensor-history layout, fixed at construction. The layouts live
+/// in separate trees and nothing is migrated: history written under the
+/// other layout is simply not read.
+enum class HistoryFormat : uint8_t {
+    PerMetric,  ///< /hist/<metric>/ chunks of 8-byte {epoch, value} records
+    Rows,       ///< /rows/ chunks of one {epoch, mask, values} row per tick
+    Multiplexed,  ///< /mux/ chunks of {epoch, n, n x {slot, value}} frames
+};
+
+/// Codec of NEW per-metric history chunks. Reads handle both, so the
+/// codec can change between boots: existing chunks age out of the ring.
+enum class HistoryCodec : uint8_t {
+    Fixed,  ///< <first_epoch>.dat, 8-byte {epoch, value} records
+    Delta,  ///< <first_epoch>.dz, storage/DeltaChunkCodec.h frames
+};
+
+/**
+ * @brief Construction-time tuning for LittleFsDataStorage.
+ *
+ * Defaults reproduce the fully stateless behaviour; boot wiring opts in
+ * to the caches it wants on target.
+ */
+struct LittleFsDataStorageOptions {
+    /// Keep a per-metric chunk table (chunk names, active chunk size) in
+    /// RAM so a steady-state history append is one open+write+fsync
+    /// instead of a directory scan plus stat. At most kMaxMetrics tables
+    /// of at most one ring's worth of names each.
+    bool cacheChunkIndex = false;
+
+    /// Keep the active event segment and its valid length in RAM after
+    /// the first storeEvent(), so an event append is one stat (to confirm
+    /// the segment still has that length) plus open+write+fsync instead of
+    /// reading the segment headers and parsing the active segment. Any
+    /// mismatch re-derives from the files.
+    bool cacheEventTail = false;
+
+    /// Event log budget on flash, split evenly into eventSegments
+    /// segment files (each at least one header plus the largest frame).
+    /// Rotation drops one segment, so between (segments - 1) / segments
+    /// of the budget and all of it holds history.
+    std::size_t eventLogBytes = 32768;
+
+    /// Segments the event log is split into, 2..kEventMaxSegments. More
+    /// segments keep the retained history steadier at the cost of one
+    /// header read per segment when the active one is derived. A change
+    /// between boots leaves segments out of their slot unread until the
+    /// ring overwrites them.
+    std::size_t eventSegments = 8;
+
+    /// Group commit (write-behind) for sensor history; 0 = off, every
+    /// append is fsync'ed before it returns. When > 0 (and `clock` is
+    /// set) accepted readings are buffered in RAM and committed with one
+    /// fsync per metric file once the oldest buffered reading is this
+    /// old, on flush(), when groupCommitMaxRecords are buffered, or on
+    /// destruction. Loss bound on a power cut: the readings of at most
+    /// one window plus the gap to the next flushIfDue() caller, and
+    /// never more than groupCommitMaxRecords readings.
+    uint32_t groupCommitWindowMs = 0;
+
+    /// Buffer bound for group commit; reaching it commits immediately.
+    std::size_t groupCommitMaxRecords = 64;
+
+    /// Monotonic clock for the group-commit deadline (borrowed; must
+    /// outlive the storage). Group commit stays off without one.
+    ITimeProvider* clock = nullptr;
+
+    /// Write-ahead journal for logging passes (per-metric layout, group
+    /// commit off). A storeSamples() / storeSensorReadings() batch that
+    /// spans two or more metrics is first written as ONE CRC-framed record
+    /// to <base>/journal and synced; the per-metric appends after it skip
+    /// their own fsyncs (littlefs commits a file when it is closed). The
+    /// first append after a restart replays the journal: each metric gets
+    /// the batch's records newer than its own newest, so a power cut
+    /// inside a pass leaves every series with the tick. A torn journal
+    /// means the cut came before any append and is discarded. Costs one
+    /// small file and, per batch, one sync instead of one per metric.
+    /// Only whole batches are journaled, so decorators must forward a pass
+    /// as one (LockedDataStorage replays a deferred one as one batch).
+    bool journalBatches = false;
+
+    /// History layout. Rows stores a whole logging pass (readings sharing
+    /// an epoch, e.g. one storeSensorReadings() batch) as ONE append with
+    /// the epoch written once: 47 bytes for the full 10-metric tick
+    /// instead of 80, one file instead of ten. Multiplexed does the same
+    /// for up to kMuxMaxMetrics metrics (5 bytes per reading plus 6 per
+    /// tick) and lets a query skip the chunks that lack its metric.
+    HistoryFormat historyFormat = HistoryFormat::PerMetric;
+
+    /// Per-metric chunk codec (HistoryFormat::PerMetric only). Delta
+    /// spends 1 byte on a sample at a steady interval with an unchanged
+    /// value and at most 9, so the same 10 x 8 KiB ring holds several
+    /// times the history and each append writes fewer bytes; range reads
+    /// decode the boundary chunk instead of binary-searching it.
+    HistoryCodec historyCodec = HistoryCodec::Fixed;
+
+    /// Maintain the rollup tiers (storage/HistoryRollup.h) so
+    /// getSensorAggregates() at a tier width reads finished buckets
+    /// instead of raw history. Costs up to 26 KiB per metric on flash
+    /// plus one raw range read per tier and bucket boundary; enabling it
+    /// on existing history backfills the tiers on the next append.
+    bool rollups = false;
+
+    /// With rollups: also keep a quantile sketch (interfaces/QuantileSketch.h)
+    /// per finished hour and day bucket, so getSensorQuantiles() merges
+    /// the sketches of whole buckets and folds only the window's edges
+    /// from raw history. Costs up to 26 KiB more per metric; buckets
+    /// finished before it was enabled are read from raw history.
+    bool quantileSketches = false;
+
+    /// Write a summary sidecar (count, epoch span, min/max/sum/last value,
+    /// CRC32) for each per-metric chunk as it is sealed. Window stats, and
+    /// aggregates whose bucket holds a whole chunk, then take a sealed
+    /// chunk inside the window from its 45-byte summary instead of its
+    /// records; scrubHistory() checks sealed chunks against the CRCs.
+    /// Costs one chunk read and a small file per seal. Per-metric layout
+    /// only; chunks sealed before it was enabled are read as before.
+    bool chunkSummaries = false;
+
+    /// Leave history upkeep to maintain() (a low-priority task on target)
+    /// instead of the append path: rollup tiers are only marked due by a
+    /// commit, and sealed fixed-format chunks are recompacted into the
+    /// delta codec (historyCodec Delta, per-metric layout), each one
+    /// written beside the original and synced before the original is
+    /// removed. Off: rollups are updated by the commit and nothing is
+    /// recompacted; maintain() does nothing.
+    bool backgroundMaintenance = false;
+
+    /// Serve getStorageStats() from RAM; 0 = off, every call asks the
+    /// stats provider. When > 0 (and `clock` is set) the first call
+    /// queries the provider, later calls return that figure adjusted by
+    /// the bytes this instance appended, truncated and evicted since, and
+    /// the provider is asked again once the figure is this old or after
+    /// any failed write (whose byte count is unknown). Bytes written
+    /// around the storage (another writer, directory blocks, littlefs
+    /// metadata) only show up at the next resync.
+    uint32_t statsResyncMs = 0;
+
+    /// Read cache of decoded per-metric history chunks, least recently
+    /// read evicted first, bounded to this many bytes of decoded records
+    /// (8 per reading); 0 = off. Sealed chunks never change, so a cached
+    /// one is served without opening its file; the active chunk costs one
+    /// stat and decodes only what was appended since. Per-metric layout
+    /// only (rows and rollups are read as before). The records are
+    /// BufferPool::HistoryChunkCache's; boot wiring passes its grant.
+    std::size_t chunkCacheBytes = 0;
+
+    /// Keep the newest this many readings of each metric in a RAM ring
+    /// (8 bytes each, capped at one chunk's worth, 1024); 0 = off. The
+    /// ring is seeded by the metric's first read (one pass over its
+    /// history) and then fed by every accepted append. A read whose
+    /// window it covers — the ring reaches back past t0, or holds the
+    /// metric's whole history — is served without touching flash, and
+    /// latestReading() is one lookup. An append that goes back in time
+    /// retires the metric's ring until restart; a failed commit drops it
+    /// until the next read reseeds it.
+    std::size_t recentReadings = 0;
+
+    /// Per-metric ring sizes (storage/RetentionPlan.h); empty = every
+    /// metric keeps kHistoryMaxChunksPerMetric chunks. Applied when a
+    /// chunk is sealed: the ring sheds its oldest chunks down to the
+    /// metric's size, so a plan that shrank takes effect on the next seal.
+    /// Per-metric layout only (the shared layouts keep one ring).
+    retention::Plan retention;
+
+    /// Microsecond clock (esp_timer_get_time on target) timing each
+    /// append/flush call into StorageWriteStats::appendUs; empty = not
+    /// timed. The other write counters are always kept.
+    std::function<int64_t()> appendClock;
+};
+
+/// One reading of a LittleFsDataStorage::importHistory() batch.
+struct HistoryPoint {
+    uint32_t epoch = 0;
+    float value = 0.0f;
+};
+
+/// Outcome of one LittleFsDataStorage::importHistory() call.
+struct HistoryImport {
+    std::size_t consumed = 0;  ///< leading points dealt with; pass the rest next
+    std::size_t written = 0;   ///< points in the chunk written
+    std::size_t skipped = 0;   ///< out of order, overlapping, or no room in the ring
+    bool existed = false;      ///< the chunk was already there (a resumed import)
+    bool ok = true;            ///< false: rejected metric or layout, or an I/O failure
+};
 
 /**
  * @brief File-backed data storage (target littlefs VFS + host POSIX).
@@ -58,45 +319,624 @@ public:
     // contract tests; the contract-level bounds live in IDataStorage.
     static constexpr std::size_t kHistoryRecordBytes = 8;
     static constexpr std::size_t kHistoryChunkMaxBytes = 8192;
-    static constexpr std::size_t kHistoryMaxChunksPerMetric = 10;
-    static constexpr std::size_t kEventFileMaxBytes = 16384;
+    static constexpr std::size_t kHistoryMaxChunksPerMetric = 10;  ///< without a plan
+    static constexpr std::size_t kEventSegmentHeaderBytes = 8;  ///< magic, sequence
+    static constexpr uint32_t kEventSegmentMagic = 0x53455357u;  ///< "WSES"
+    static constexpr std::size_t kEventMaxSegments = 64;
     static constexpr std::size_t kEventHeaderBytes = 7;  ///< marker..detail_len
-    static constexpr uint8_t kEventMarker = 0xE7;
+    static constexpr std::size_t kEventTrailerBytes = 1;  ///< frame_len
+    static constexpr uint8_t kEventMarker = 0xE8;
+    static constexpr uint8_t kLegacyEventMarker = 0xE7;  ///< no trailer, read only
+
+    // Row layout (HistoryFormat::Rows). 64 x 8 KiB keeps >= 30 days of
+    // full 10-metric ticks at the default 5-min interval (8640 x 47 B)
+    // inside a smaller budget than the per-metric worst case (800 KiB).
+    static constexpr std::size_t kRowChunkMaxBytes = 8192;
+    static constexpr std::size_t kRowMaxChunks = 64;
+    static constexpr std::size_t kRowHeaderBytes = 7;  ///< marker, epoch, mask
+    static constexpr uint8_t kRowMarker = 0xA5;
+    static_assert(kMaxMetrics <= 16, "row presence mask is 16 bits");
+
+    // Multiplexed layout (HistoryFormat::Multiplexed): the row ring's
+    // chunk size and count, frames addressed by slot id. The footer's
+    // presence bitmap is what bounds the metric budget.
+    static constexpr std::size_t kMuxMaxMetrics = 64;
+    static constexpr std::size_t kMuxFrameHeaderBytes = 6;  ///< marker, epoch, count
+    static constexpr std::size_t kMuxEntryBytes = 5;        ///< slot, value
+    static constexpr std::size_t kMuxFooterBytes = 17;      ///< marker, presence, min, max
+    static constexpr uint8_t kMuxMarker = 0xA6;
+    static constexpr uint8_t kMuxFooterMarker = 0xA7;
+    // Chunk summaries (LittleFsDataStorageOptions::chunkSummaries).
+    static constexpr std::size_t kSummaryBytes = 45;
+    static constexpr uint8_t kSummaryMarker = 0xC5;
+
+    static_assert(kMuxMaxMetrics <= MetricRegistry::kDynamicCapacity,
+                  "every multiplexed slot needs a registry id, known name or not");
 
     /**
      * @param basePath storage root without trailing slash ("/storage" on
      *                 target, a temp directory in host tests)
      * @param statsProvider filesystem statistics source; getStorageStats()
-     *                      reports zeros when absent or failing
+     *                      reports zero sizes when absent or failing (the
+     *                      write counters are filled regardless)
+     * @param options caches to enable (all off by default)
      */
     explicit LittleFsDataStorage(std::string basePath,
-                                 StatsProvider statsProvider = nullptr);
+                                 StatsProvider statsProvider = nullptr,
+                                 LittleFsDataStorageOptions options = {});
+
+    /// Commits any group-commit buffer (host tests; never runs on target,
+    /// where the instance is a function-local static).
+    ~LittleFsDataStorage() override;
 
     // IDataStorage
     bool storeSensorReading(const std::string& metric, uint32_t epoch,
                             float value) override;
+    /// One commit (one fsync per chunk file touched) per distinct metric
+    /// of the batch; under group commit one deadline check per batch.
+    std::size_t storeSensorReadings(const SensorReading* readings,
+                                    std::size_t count) override;
+    /// The append path proper: the name-based stores intern their names
+    /// and land here, and a cached append of a known id builds no string.
+    std::size_t storeSamples(const MetricSample* samples,
+                             std::size_t count) override;
     std::vector<SensorReading> getSensorReadings(const std::string& metric,
                                                  uint32_t t0,
                                                  uint32_t t1) const override;
+    /// Decodes straight from the chunk files (then the group-commit
+    /// buffer): no allocation per reading.
+    std::size_t forEachReading(const std::string& metric, uint32_t t0,
+                               uint32_t t1,
+                               IReadingVisitor& visitor) const override;
+    /// From the rollup tier at a tier width (when enabled): finished
+    /// buckets from the tier, the open bucket and anything older than
+    /// the tier ring from raw history.
+    std::vector<SensorAggregate> getSensorAggregates(
+        const std::string& metric, uint32_t t0, uint32_t t1,
+        uint32_t bucketS) const override;
+    /// With chunk summaries, sealed chunks inside the window are taken
+    /// from their summaries; otherwise the default fold.
+    SensorWindowStats getSensorWindowStats(const std::string& metric, uint32_t t0,
+                                           uint32_t t1) const override;
+    /// With quantile sketches, whole hours and days the sketch rings cover
+    /// are merged from those; otherwise the default fold.
+    QuantileSketch getSensorQuantiles(const std::string& metric, uint32_t t0,
+                                      uint32_t t1) const override;
+    /// From the recent-readings ring when enabled, else the default fold.
+    LatestReading latestReading(const std::string& metric) const override;
+    /// From the recent-readings ring when it holds `n` (or all); else,
+    /// per-metric layout, newest first: the group-commit buffer, then the
+    /// chunks from the active one back, a raw chunk read from its last `n`
+    /// records only — one chunk for n up to a chunk's worth. The shared
+    /// layouts take the default fold.
+    std::vector<SensorReading> getLatestReadings(const std::string& metric,
+                                                 std::size_t n) const override;
     bool storeEvent(uint32_t epoch, uint8_t category,
-                    const std::string& detail) override;
+                    std::string_view detail) override;
     std::vector<EventRecord> getEvents(std::size_t maxCount) const override;
+    EventPage queryEvents(const EventQuery& query) const override;
     StorageStats getStorageStats() const override;
+    bool flush() override;
+    bool flushIfDue() override;
+
+    /**
+     * @brief Check up to `maxChunks` summarized chunks against the CRC32
+     * of their summaries (chunkSummaries), resuming after the chunk the
+     * previous call checked and wrapping around, so a few per call cover
+     * the whole history over time.
+     * @return chunks found damaged (shorter than summarized, or another CRC)
+     */
+    std::size_t scrubHistory(std::size_t maxChunks);
+
+    /// With backgroundMaintenance: one due rollup update, else one sealed
+    /// fixed-format chunk recompacted (sweeping the metrics in name order).
+    bool maintain() override;
+
+    /**
+     * @brief Bulk-import history older than what `metric` was given since
+     * (the legacy migration, storage/LegacyHistoryImport.h) as ONE chunk
+     * in the configured codec: written whole to <first_epoch>.<ext>.tmp,
+     * synced once, then renamed into the ring — one fsync per chunk
+     * instead of one per record.
+     *
+     * `points` should ascend. The chunk takes the leading points that fit
+     * it; the rest are not consumed and go into the next call. A point is
+     * skipped when it does not follow the last record of the chunk before
+     * it or reaches the first epoch of the chunk after it; the whole batch
+     * when the metric's ring is full of newer chunks. When a chunk starts
+     * at the first point already, the points it covers are consumed
+     * unwritten (`existed`): an interrupted import is simply run again.
+     * The ring then sheds its oldest chunks down to the metric's size.
+     * Per-metric layout only.
+     */
+    HistoryImport importHistory(const std::string& metric, const HistoryPoint* points,
+                                std::size_t count);
+
+    /**
+     * @brief Forget everything derived from the files — chunk indexes,
+     * event tail, rollup progress, read caches, recent rings, the stats
+     * figures — so the next call re-derives it. For a caller that replaced
+     * the files underneath (a restore, api/StorageArchive.h); buffered
+     * records should be flushed first, since they are dropped too.
+     */
+    void reloadFromFiles();
 
 private:
+    /// One history record of a known metric (buffered or batched).
+    struct HistoryRecord {
+        uint32_t epoch = 0;
+        float value = 0.0f;
+    };
+
+    /// Append-side view of one metric directory: what storeSensorReading()
+    /// needs to pick (or create) the active chunk and apply ring eviction.
+    struct ChunkIndex {
+        std::vector<std::string> names;  ///< chunk files, oldest first
+        uint32_t newestFirstEpoch = 0;   ///< filename epoch of names.back()
+        long activeSize = 0;             ///< valid bytes in names.back()
+        bool hasLast = false;            ///< a committed record exists
+        uint32_t lastEpoch = 0;          ///< epoch of the newest record
+        deltachunk::State tail;          ///< codec state after names.back()
+                                         ///< (.dz active chunk only)
+        std::string activePath;          ///< <dir>/names.back(), kept in step
+    };
+
+    /// Everything kept per registered metric, indexed by MetricId.
+    struct MetricState {
+        std::string dir;       ///< metricDir(), built once at registration
+        std::size_t maxChunks = kHistoryMaxChunksPerMetric;  ///< ring size (retention)
+        ChunkIndex index;      ///< cacheChunkIndex only
+        bool indexed = false;  ///< `index` is loaded
+        /// Group-commit buffer, append order; capacity reused across commits.
+        std::vector<HistoryRecord> pending;
+        bool buffered = false;  ///< admitted to the buffer (budget checked)
+        /// Rollups: per tier, the start of the first bucket not yet written
+        /// (finishedTo of the last update). Derived from the tier files on
+        /// first use, so losing it only costs one re-read of raw history.
+        std::array<uint32_t, rollup::kTierCount> rollupFinishedTo{};
+        bool rollupLoaded = false;
+        /// backgroundMaintenance: a commit reached rollupDueEpoch and the
+        /// tiers are not yet brought up to it.
+        bool rollupDue = false;
+        uint32_t rollupDueEpoch = 0;
+    };
+
+    /// Id of a valid metric name, registering it on first use;
+    /// metric::kInvalid for an unsafe name or a full registry.
+    MetricId resolveMetric(const std::string& name);
+
+    /// Ring size of `metric` in chunks: its retention plan share (at least
+    /// retention::kMinChunks), else kHistoryMaxChunksPerMetric.
+    std::size_t ringChunks(const std::string& metric) const;
+
+    /// Group-commit buffer of `name`, nullptr when it has none.
+    const std::vector<HistoryRecord>* pendingOf(const std::string& name) const;
+
+    /// Create the metric directory if needed, enforcing the kMaxMetrics
+    /// budget. False on a rejected metric or an I/O failure.
+    bool ensureMetricDir(MetricId metric);
+
+    /// Derive a metric's ChunkIndex from its directory, creating the
+    /// directory (metric budget permitting) and repairing a torn tail of
+    /// the newest chunk. False on a rejected metric or an I/O failure.
+    bool loadChunkIndex(MetricId metric, ChunkIndex& index);
+
+    /// Durably append `count` records of one metric (appendRecords), then
+    /// bring the rollup tiers up to date when enabled.
+    bool commitRecords(MetricId metric, const HistoryRecord* records,
+                       std::size_t count);
+
+    /// Durably append `count` records of one metric, through the cached
+    /// ChunkIndex when enabled and a fresh derivation otherwise.
+    bool appendRecords(MetricId metric, const HistoryRecord* records,
+                       std::size_t count);
+
+    /// Append records through `index` (sealing/evicting as needed), one
+    /// fsync per chunk file touched, keeping `index` in step with the
+    /// files. `committed` = records durably written, also on failure.
+    bool writeRecords(MetricId metric, ChunkIndex& index,
+                      const HistoryRecord* records, std::size_t count,
+                      std::size_t& committed);
+
+    /// Remove chunk `name` of `metric` from its ring, with its summary,
+    /// cache entry and recent-readings ring.
+    bool evictChunk(MetricId metric, const std::string& name);
+
+    bool groupCommitActive() const;
+
+    // --- Batch journal (LittleFsDataStorageOptions::journalBatches) ------
+
+    bool journalActive() const;
+    /// Write the valid samples of a multi-metric batch as the journal
+    /// record and sync it; their count, or 0 when nothing was journaled
+    /// (one metric, too large, or an I/O failure).
+    std::size_t writeJournal(const MetricSample* samples, std::size_t count);
+    /// Append what a crash kept of the journaled batch from its metrics,
+    /// then remove the journal (a torn one is just removed).
+    void replayJournal();
+
+    // --- Shared layouts (HistoryFormat::Rows, ::Multiplexed) -------------
+
+    bool rowFormat() const;
+    bool muxFormat() const;
+    /// Rows or multiplexed: every metric in one chunk ring under
+    /// sharedDir(), named through its slot table.
+    bool sharedLayout() const;
+    std::string rowsDir() const;
+    std::string muxDir() const;
+    std::string sharedDir() const;
+    /// Distinct metrics the layout in use accepts.
+    std::size_t metricBudget() const;
+
+    /// Slot (mask bit / id column value) of `metric`, assigning and
+    /// durably appending a new one to the name table when `assign`; -1
+    /// when unknown/over budget.
+    int rowSlot(const std::string& metric, bool assign);
+
+    /// Commit samples through the shared layout in use.
+    std::size_t commitShared(const MetricSample* samples, std::size_t count);
+
+    /// Derive rowIndex_ from /rows, repairing a torn tail of the newest
+    /// chunk (same contract as loadChunkIndex).
+    bool loadRowIndex();
+
+    /// Durably append `count` samples as rows (samples sharing an epoch
+    /// share a row). Returns the number of samples stored.
+    std::size_t commitRows(const MetricSample* samples, std::size_t count);
+
+    bool visitRows(const std::string& metric, uint32_t t0, uint32_t t1,
+                   IReadingVisitor& visitor) const;
+
+    /// What a multiplexed chunk holds: the metrics present (bit = slot)
+    /// and its epoch span. A sealed chunk stores it in its footer.
+    struct MuxSummary {
+        std::string name;  ///< chunk file (cache key; empty for the active one)
+        uint64_t presence = 0;
+        uint32_t minEpoch = 0;
+        uint32_t maxEpoch = 0;
+    };
+
+    /// Widen `summary` by one frame holding `slots` at `epoch`.
+    static void noteMuxFrame(MuxSummary& summary, uint64_t slots, uint32_t epoch);
+
+    /// Derive rowIndex_ and muxActive_ from /mux, repairing a torn tail
+    /// of the newest chunk (same contract as loadChunkIndex).
+    bool loadMuxIndex();
+
+    /// Durably append `count` samples as multiplexed frames (samples
+    /// sharing an epoch share a frame), sealing full chunks with their
+    /// footer. Returns the number of samples stored.
+    std::size_t commitMux(const MetricSample* samples, std::size_t count);
+
+    /// Footer of sealed chunk `name`, from muxFooters_ or its file; false
+    /// when it has none (a seal cut short: the chunk is scanned instead).
+    bool muxFooter(const std::string& name, MuxSummary& out) const;
+
+    bool visitMux(const std::string& metric, uint32_t t0, uint32_t t1,
+                  IReadingVisitor& visitor) const;
+
+    // --- Decoded-chunk read cache (LittleFsDataStorageOptions::chunkCacheBytes)
+
+    /// Decoded records, in BufferPool::HistoryChunkCache (PSRAM first).
+    using CachedRecords =
+        std::vector<HistoryRecord, BufferAllocator<HistoryRecord, BufferPool::HistoryChunkCache>>;
+
+    struct CachedChunk {
+        std::string path;
+        CachedRecords records;               ///< file order
+        long validBytes = 0;                 ///< decoded prefix of the file
+        deltachunk::State tail;              ///< codec state after it (.dz)
+        bool sealed = false;                 ///< complete when decoded
+    };
+
+    /// Decoded records of chunk `path`, served from the cache or decoded
+    /// into it. An entry decoded once its chunk was sealed is trusted as
+    /// is; otherwise the file is stat'ed and extended (or re-decoded if it
+    /// shrank). nullptr when the cache is off, the chunk is unreadable or
+    /// larger than the budget.
+    /// Valid until the next call.
+    const CachedRecords* cachedChunk(const std::string& path, bool delta,
+                                     bool sealed) const;
+
+    /// Decode the bytes of `entry`'s file past entry.validBytes into it.
+    /// False for a chunk of a foreign codec version.
+    bool extendCachedChunk(CachedChunk& entry, bool delta) const;
+
+    /// Drop the cache entry of a chunk this instance removes or renames.
+    void forgetCachedChunk(const std::string& path);
+
+    // --- Chunk summaries (LittleFsDataStorageOptions::chunkSummaries) ---
+
+    /// What the sidecar of one sealed per-metric chunk records.
+    struct ChunkSummary {
+        uint32_t count = 0;
+        uint32_t minEpoch = 0;
+        uint32_t maxEpoch = 0;
+        float min = 0.0f;
+        float max = 0.0f;
+        double sum = 0.0;
+        float last = 0.0f;   ///< value at maxEpoch (the later one on a tie)
+        uint32_t bytes = 0;  ///< chunk length summarized
+        uint32_t crc = 0;    ///< CRC32 of those bytes
+    };
+
+    /// Offered each sealed chunk inside a scan's window that has a
+    /// summary; takeChunk() returns true when it consumed the chunk whole,
+    /// which then is not read.
+    class SummaryVisitor {
+    public:
+        /// Whether a chunk whose records lie in [from, to] could be taken
+        /// (asked before its summary is read).
+        virtual bool wants(uint32_t from, uint32_t to) const = 0;
+        virtual bool takeChunk(const ChunkSummary& summary) = 0;
+
+    protected:
+        ~SummaryVisitor() = default;
+    };
+
+    std::string summaryDir(const std::string& metric) const;
+
+    /// Summary of chunk file `path` (either codec), from one read of it;
+    /// false when it is unreadable, of a foreign codec version or empty.
+    bool summarizeChunk(const std::string& path, bool delta, ChunkSummary& out) const;
+
+    /// Seal of chunk `name` (first epoch `firstEpoch`) of `metric`: write
+    /// its summary. Best effort — a chunk without one is read as before.
+    void writeChunkSummary(MetricId metric, const std::string& name,
+                           uint32_t firstEpoch);
+
+    /// The valid summary of `metric`'s chunk starting at `firstEpoch`.
+    bool readChunkSummary(const std::string& metric, uint32_t firstEpoch,
+                          ChunkSummary& out) const;
+
+    /// forEachReading() with `summaries` offered the sealed chunks of an
+    /// ordered per-metric history (nullptr: plain forEachReading()).
+    std::size_t visitWindow(const std::string& metric, uint32_t t0, uint32_t t1,
+                            IReadingVisitor& visitor,
+                            SummaryVisitor* summaries) const;
+
+    /// Fold [t0, t1] into `buckets` of `bucketS`, chunks that fall in one
+    /// bucket from their summaries when enabled.
+    void foldAggregates(const std::string& metric, uint32_t t0, uint32_t t1,
+                        uint32_t bucketS,
+                        std::vector<SensorAggregate>& buckets) const;
+
+    /// Stream committed history only (no group-commit buffer), any
+    /// layout, in chronological order. False when the visitor stopped.
+    /// `summaries`: see visitWindow().
+    bool visitCommitted(const std::string& metric, uint32_t t0, uint32_t t1,
+                        IReadingVisitor& visitor,
+                        SummaryVisitor* summaries = nullptr) const;
+
+    // --- Recent readings (LittleFsDataStorageOptions::recentReadings) ----
+
+    /// The newest readings of one metric, oldest at `head`.
+    struct RecentRing {
+        std::vector<HistoryRecord> slots;  ///< recentReadings, once seeded
+        std::size_t head = 0;
+        std::size_t size = 0;
+        bool seeded = false;    ///< holds the metric's newest readings
+        bool complete = false;  ///< ...and all of them (none pushed out)
+        bool retired = false;   ///< an epoch went backwards: never used again
+    };
+
+    /// The ring of `metric`, seeded from its history on first use;
+    /// nullptr when the option is off, the metric unknown or the ring
+    /// retired.
+    const RecentRing* recentOf(const std::string& metric) const;
+
+    /// Whether `ring` holds every reading of its metric from `t0` on.
+    static bool recentCovers(const RecentRing& ring, uint32_t t0);
+
+    /// Append to `ring`, pushing out its oldest when full; retires it on
+    /// an epoch older than its newest.
+    static void pushRecent(RecentRing& ring, const HistoryRecord& record);
+
+    /// An accepted append of `metric`: into its ring once seeded.
+    void noteRecent(MetricId metric, const HistoryRecord& record);
+
+    /// A commit of `metric` failed (metric::kInvalid: of any metric) or
+    /// evicted history the ring may still hold: reseed on the next read.
+    void forgetRecent(MetricId metric);
+
+    // --- Rollup tiers (LittleFsDataStorageOptions::rollups) -------------
+
+    /// Finished buckets of one tier ring plus what the ring covers.
+    struct RollupRange {
+        std::vector<SensorAggregate> buckets;  ///< start in the window
+        uint32_t coveredFrom = 0;  ///< oldest chunk's first bucket start
+        uint32_t finishedTo = 0;   ///< end of the newest finished bucket
+    };
+
+    std::string rollupDir(std::size_t tier, const std::string& metric) const;
+
+    /// Read tier `tier` of `metric`: buckets starting in [t0, t1].
+    RollupRange readRollup(std::size_t tier, const std::string& metric,
+                           uint32_t t0, uint32_t t1) const;
+
+    /// After `metric` committed data up to `newestEpoch`: write every
+    /// bucket that is now finished to its tier, computed from raw history.
+    /// Best effort — a failure is retried at the next boundary.
+    void updateRollups(MetricId metric, uint32_t newestEpoch);
+
+    /// A commit of `metric` reached `newestEpoch`: updateRollups() now, or
+    /// mark it due for maintain() (backgroundMaintenance).
+    void rollupsAfterCommit(MetricId metric, uint32_t newestEpoch);
+
+    /// Durably append finished buckets to one tier ring (sealing and
+    /// evicting like the raw chunks).
+    bool appendRollup(std::size_t tier, const std::string& metric,
+                      const std::vector<SensorAggregate>& buckets);
+
+    /// Append fixed-size records, each led by its uint32 LE bucket start
+    /// (ascending), to the chunk ring in `dir`: a torn tail is cut first,
+    /// a chunk is sealed when the next record won't fit and named by its
+    /// first bucket start, and the oldest beyond `maxChunks` is evicted.
+    bool appendRing(const std::string& dir, std::size_t chunkBytes,
+                    std::size_t maxChunks, std::size_t recordBytes,
+                    const std::vector<uint8_t>& records);
+
+    std::string sketchDir(std::size_t sketchTier, const std::string& metric) const;
+
+    /// Merge the readings of `metric` in [t0, t1] into `out`: whole
+    /// buckets of kSketchTiers[level - 1] its ring covers from the ring,
+    /// the rest at the next finer level (level 0: raw history).
+    void sketchWindow(std::size_t level, const std::string& metric, uint32_t t0,
+                      uint32_t t1, QuantileSketch& out) const;
+
+    /// Group commit: accept one record into the RAM buffer (metric budget
+    /// enforced here). The caller applies the commit triggers.
+    bool bufferRecord(MetricId metric, const HistoryRecord& record);
+
+    /// Group commit: commit when the buffer is full or the deadline passed.
+    bool commitIfTriggered();
+
+    // --- Recompaction (LittleFsDataStorageOptions::backgroundMaintenance)
+
+    /// Recompact the next sealed .dat chunk after the sweep cursor,
+    /// tidying what an interrupted step left in each directory passed.
+    /// False when a whole sweep found nothing to do.
+    bool recompactNext();
+
+    /// Finish what an interrupted recompaction left in `metric`'s
+    /// directory: remove its .tmp files, and each .dat shadowed by a .dz
+    /// of the same first epoch (rewriting that chunk's summary).
+    void tidyRecompaction(MetricId metric);
+
+    /// Re-encode sealed chunk `name` of `metric` into the delta codec
+    /// (write new, sync, rename, then remove the old). False when it was
+    /// left as it is (unreadable, no smaller, or an I/O failure).
+    bool recompactChunk(MetricId metric, const std::string& name,
+                        uint32_t firstEpoch, bool unordered);
+
     std::string histDir() const;
     std::string metricDir(const std::string& metric) const;
     std::string eventsDir() const;
-    std::string eventPath(int index) const;
+    const std::string& eventPath(uint32_t sequence) const
+    {
+        return eventPaths_[sequence % eventPaths_.size()];
+    }
+
+    /// Where the next event append goes: the active segment's sequence
+    /// and the byte length of its valid prefix (header included).
+    struct EventTail {
+        uint32_t sequence = 0;
+        long validBytes = 0;
+    };
+
+    /// The current EventTail: the cached one when enabled and the active
+    /// segment still has the cached length, else derived from the files
+    /// (repairing a torn tail, starting the first segment of an empty
+    /// log). False on an I/O failure.
+    bool resolveEventTail(EventTail& tail);
 
-    /// Which of the two event files appends are directed to, derived
-    /// from the files alone: the file whose last valid record has the
-    /// newest epoch (ties broken toward the smaller file; both empty
-    /// -> 0). Full rationale at the definition.
-    int activeEventIndex() const;
+    /// Start segment `sequence` in its slot: the slot is emptied and gets
+    /// the segment header, synced. False on an I/O failure.
+    bool startEventSegment(uint32_t sequence);
+
+    /// The sequences of the valid segments (header intact, in its slot),
+    /// newest first, into @p out; returns how many. Reads the headers
+    /// only.
+    std::size_t eventSegmentsNewestFirst(
+        std::array<uint32_t, kEventMaxSegments>& out) const;
+
+    /// Remove the two-file log of older firmware and segment files left
+    /// beyond eventSegments by a smaller setting (once the ring wraps).
+    void dropStaleEventFiles();
+
+    /// Stats cache (statsResyncMs): add `bytes` (negative = freed) to the
+    /// cached usage while a synced figure is held.
+    void noteStatsDelta(long bytes);
+
+    /// remove() a history/rollup chunk, crediting its size to the cache
+    /// (and counting it in writes_.filesRemoved).
+    bool removeCounted(const std::string& path);
+
+    // Write accounting (StorageWriteStats), next to the byte tally.
+    void noteAppended(long bytes);
+    void noteRepaired(long freedBytes);
+    bool syncCounted(FILE* file);
+
+    /// Times the outermost append/flush call into writes_.appendUs.
+    class AppendTimer {
+    public:
+        explicit AppendTimer(LittleFsDataStorage& storage);
+        ~AppendTimer();
+        AppendTimer(const AppendTimer&) = delete;
+        AppendTimer& operator=(const AppendTimer&) = delete;
+
+    private:
+        LittleFsDataStorage& storage_;
+        int64_t startUs_ = 0;
+    };
 
     std::string basePath_;
     StatsProvider statsProvider_;
+    LittleFsDataStorageOptions options_;
+    MetricRegistry metrics_;
+    std::vector<MetricState> state_;  ///< one per metrics_ id
+    std::vector<std::string> eventPaths_;  ///< per slot, built once: an append formats no path
+    std::size_t eventSegmentBytes_ = 0;    ///< eventLogBytes / slots, at least one frame
+    std::string journalPath_;              ///< <base>/journal, built once like eventPaths_
+    EventTail eventTail_;             ///< cacheEventTail only
+    bool eventTailCached_ = false;
+
+    std::vector<HistoryRecord> batchScratch_;  ///< storeSamples() reuse
+    std::vector<MetricSample> sampleScratch_;  ///< storeSensorReadings() reuse
+    std::vector<uint8_t> frameScratch_;        ///< writeRecords() reuse
+    std::vector<uint8_t> journalScratch_;      ///< writeJournal() reuse
+    bool journalReplayed_ = false;  ///< the first append replayed the journal
+    bool syncDeferred_ = false;     ///< inside a journaled batch: no fsyncs
+
+    // Shared-layout state. The slot table is append-only and tiny, so it
+    // is always kept once loaded; rowIndex_ follows cacheChunkIndex.
+    std::vector<std::string> rowSlots_;
+    bool rowSlotsLoaded_ = false;
+    ChunkIndex rowIndex_;
+    bool rowIndexLoaded_ = false;
+    std::vector<int> rowSlotScratch_;  ///< commitRows()/commitMux() reuse
+    /// Multiplexed: the active chunk's summary (its footer-to-be), kept in
+    /// step with rowIndex_, and whether that chunk already has a footer.
+    MuxSummary muxActive_;
+    bool muxActiveSealed_ = false;
+    /// Footers read by queries, one per sealed chunk. Sealed chunks never
+    /// change, so entries stay valid until their chunk is evicted.
+    mutable std::vector<MuxSummary> muxFooters_;
+    std::size_t pendingCount_ = 0;
+    int64_t pendingSinceMs_ = 0;  ///< clock time of the oldest buffered record
+
+    // Stats cache (statsResyncMs). Mutable: getStorageStats() is const
+    // and (re)syncs lazily.
+    mutable bool statsCached_ = false;
+    mutable uint32_t statsTotal_ = 0;
+    mutable int64_t statsUsed_ = 0;  ///< signed: the tally may undershoot
+    mutable int64_t statsSyncedMs_ = 0;
+
+    StorageWriteStats writes_;
+    int appendDepth_ = 0;  ///< AppendTimer nesting (flush inside storeSamples)
+
+    // Chunk cache (chunkCacheBytes): most recently read first, so LRU
+    // eviction pops the back; a list keeps served entries in place.
+    mutable std::list<CachedChunk> chunkCache_;
+    mutable std::size_t chunkCacheUsed_ = 0;  ///< bytes of cached records
+
+    /// Block buffer of the raw chunk reads (visitCommitted(), the cache)
+    /// and of the event log's backward walk.
+    mutable std::vector<uint8_t> readScratch_;
+
+    /// scrubHistory() resumes after this chunk of this metric.
+    std::string scrubMetric_;
+    uint32_t scrubEpoch_ = 0;
+
+    /// recompactNext() resumes after this chunk of this metric; chunks
+    /// that did not shrink are remembered so later sweeps skip them.
+    std::string compactMetric_;
+    uint32_t compactEpoch_ = 0;
+    std::vector<std::pair<std::string, uint32_t>> compactSkipped_;
+
+    /// Recent-readings rings, one per metrics_ id (grown on first read).
+    /// Mutable: seeded lazily by the const reads.
+    mutable std::vector<RecentRing> recent_;
 };
 
 #endif /* WATERINGSYSTEM_STORAGE_LITTLEFSDATASTORAGE_H */
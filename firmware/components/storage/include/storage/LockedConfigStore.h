@@ -12,14 +12,23 @@
  * setters could interleave — e.g. setWifiCredentials() writes two NVS
  * entries and a concurrent factoryReset() erasing the partition in between
  * would leave a half-written credential pair. This decorator wraps an
- * IConfigStore and takes a mutex around every interface call, serializing
- * all access (FR-013; research.md D9, PR-02 CP3 precedent —
+ * IConfigStore and takes a mutex around every write, serializing them
+ * (FR-013; research.md D9, PR-02 CP3 precedent —
  * actuators/LockedWaterPump.h).
  *
  * USAGE RULE: once a store is wrapped, the underlying store must ONLY be
  * accessed through the wrapper — every call site (boot wiring, console
  * registration, controllers, ...) goes through the LockedConfigStore,
- * never through the wrapped object directly.
+ * never through the wrapped object directly. The wrapper's reads come from
+ * the copy its own writes publish, so a write that bypasses it is not seen.
+ *
+ * LOCK-FREE READS: the HTTP, console, watering and 10 Hz loop tasks all
+ * read a handful of scalars, and a getter waiting on the mutex behind a
+ * slow NVS commit is a priority inversion between them. So every write
+ * republishes a ConfigSnapshot (plus generation()) through a single-writer
+ * Seqlock, and the scalar getters, getMetricLogPolicy(), snapshot() and
+ * generation() copy from it without the mutex. Writers and the credential
+ * getters (strings, never on a hot path) still take the mutex.
  *
  * SCOPE: this decorator provides PER-CALL atomicity only, not cross-call.
  * A read-modify-write sequence spanning two calls (e.g. get* then set*) is
@@ -27,21 +36,32 @@
  * task may change the value in between. Such sequences need higher-level
  * coordination (a caller-held lock or single-owner task).
  *
- * Pure C++ (<mutex> is available via pthread on ESP-IDF and on the linux
- * preview target), so the decorator is host-testable.
+ * CHANGE NOTIFICATION: subscribe() registers listeners the wrapper calls
+ * after each successful write, so a task can sleep until the config moves
+ * instead of polling it; generation() is the matching pull-side check.
+ *
+ * Pure C++: the lock is a StaticMutex (a static FreeRTOS mutex on target,
+ * std::mutex on the host), so the decorator is host-testable; with
+ * WS_LOCK_STATS it is instrumented for contention (LockStats.h).
  */
 
 #ifndef WATERINGSYSTEM_STORAGE_LOCKEDCONFIGSTORE_H
 #define WATERINGSYSTEM_STORAGE_LOCKEDCONFIGSTORE_H
 
+#include <array>
+#include <cstddef>
 #include <cstdint>
+#include <functional>
 #include <mutex>
 #include <string>
+#include <utility>
 
 #include "interfaces/IConfigStore.h"
+#include "interfaces/Seqlock.h"
+#include "interfaces/LockStats.h"
 
 /**
- * @brief IConfigStore decorator that serializes every call with a mutex.
+ * @brief IConfigStore decorator: mutex-serialized writes, lock-free reads.
  *
  * Composition, not inheritance from a concrete store: the base class stays
  * pure (no locking) and the existing host tests are unchanged. The wrapped
@@ -50,129 +70,245 @@
 class LockedConfigStore : public IConfigStore {
 public:
     /// Wrap @p store; the wrapped store must outlive this object.
-    explicit LockedConfigStore(IConfigStore& store) : store_(store) {}
+    explicit LockedConfigStore(IConfigStore& store)
+        : store_(store), published_(Published{store.snapshot(), store.generation()})
+    {
+    }
 
     LockedConfigStore(const LockedConfigStore&) = delete;
     LockedConfigStore& operator=(const LockedConfigStore&) = delete;
 
     float getMoistureThresholdLow() const override
     {
-        std::lock_guard<std::mutex> lock(mutex_);
-        return store_.getMoistureThresholdLow();
+        return published().config.moistureThresholdLow;
     }
 
     bool setMoistureThresholdLow(float percent) override
     {
-        std::lock_guard<std::mutex> lock(mutex_);
-        return store_.setMoistureThresholdLow(percent);
+        return writeAndNotify([&] { return store_.setMoistureThresholdLow(percent); });
     }
 
     float getMoistureThresholdHigh() const override
     {
-        std::lock_guard<std::mutex> lock(mutex_);
-        return store_.getMoistureThresholdHigh();
+        return published().config.moistureThresholdHigh;
     }
 
     bool setMoistureThresholdHigh(float percent) override
     {
-        std::lock_guard<std::mutex> lock(mutex_);
-        return store_.setMoistureThresholdHigh(percent);
+        return writeAndNotify([&] { return store_.setMoistureThresholdHigh(percent); });
     }
 
     uint32_t getWateringDurationS() const override
     {
-        std::lock_guard<std::mutex> lock(mutex_);
-        return store_.getWateringDurationS();
+        return published().config.wateringDurationS;
     }
 
     bool setWateringDurationS(uint32_t seconds) override
     {
-        std::lock_guard<std::mutex> lock(mutex_);
-        return store_.setWateringDurationS(seconds);
+        return writeAndNotify([&] { return store_.setWateringDurationS(seconds); });
     }
 
     uint32_t getMinWateringIntervalS() const override
     {
-        std::lock_guard<std::mutex> lock(mutex_);
-        return store_.getMinWateringIntervalS();
+        return published().config.minWateringIntervalS;
     }
 
     bool setMinWateringIntervalS(uint32_t seconds) override
     {
-        std::lock_guard<std::mutex> lock(mutex_);
-        return store_.setMinWateringIntervalS(seconds);
+        return writeAndNotify([&] { return store_.setMinWateringIntervalS(seconds); });
     }
 
     bool getWateringEnabled() const override
     {
-        std::lock_guard<std::mutex> lock(mutex_);
-        return store_.getWateringEnabled();
+        return published().config.wateringEnabled;
     }
 
     bool setWateringEnabled(bool enabled) override
     {
-        std::lock_guard<std::mutex> lock(mutex_);
-        return store_.setWateringEnabled(enabled);
+        return writeAndNotify([&] { return store_.setWateringEnabled(enabled); });
     }
 
     uint32_t getSensorReadIntervalMs() const override
     {
-        std::lock_guard<std::mutex> lock(mutex_);
-        return store_.getSensorReadIntervalMs();
+        return published().config.sensorReadIntervalMs;
     }
 
     bool setSensorReadIntervalMs(uint32_t ms) override
     {
-        std::lock_guard<std::mutex> lock(mutex_);
-        return store_.setSensorReadIntervalMs(ms);
+        return writeAndNotify([&] { return store_.setSensorReadIntervalMs(ms); });
     }
 
     uint32_t getDataLogIntervalMs() const override
     {
-        std::lock_guard<std::mutex> lock(mutex_);
-        return store_.getDataLogIntervalMs();
+        return published().config.dataLogIntervalMs;
     }
 
     bool setDataLogIntervalMs(uint32_t ms) override
     {
-        std::lock_guard<std::mutex> lock(mutex_);
-        return store_.setDataLogIntervalMs(ms);
+        return writeAndNotify([&] { return store_.setDataLogIntervalMs(ms); });
+    }
+
+    uint32_t getModbusBaudRate() const override
+    {
+        return published().config.modbusBaudRate;
+    }
+
+    bool setModbusBaudRate(uint32_t baud) override
+    {
+        return writeAndNotify([&] { return store_.setModbusBaudRate(baud); });
+    }
+
+    MetricLogPolicy getMetricLogPolicy(MetricId id) const override
+    {
+        if (id >= metric::kKnownCount) {
+            return MetricLogPolicy{};
+        }
+        return published().config.logPolicies[id];
+    }
+
+    bool setMetricLogPolicy(MetricId id, const MetricLogPolicy& policy) override
+    {
+        return writeAndNotify([&] { return store_.setMetricLogPolicy(id, policy); });
+    }
+
+    /// One lock for the whole patch: no other task sees it half applied,
+    /// and the listeners are called once for it.
+    bool apply(const ConfigPatch& patch) override
+    {
+        return writeAndNotify([&] { return store_.apply(patch); });
     }
 
     std::string getWifiSsid() const override
     {
-        std::lock_guard<std::mutex> lock(mutex_);
+        std::lock_guard<DecoratorMutex> lock(mutex_);
         return store_.getWifiSsid();
     }
 
     std::string getWifiPassword() const override
     {
-        std::lock_guard<std::mutex> lock(mutex_);
+        std::lock_guard<DecoratorMutex> lock(mutex_);
         return store_.getWifiPassword();
     }
 
     bool setWifiCredentials(const std::string& ssid,
                             const std::string& password) override
     {
-        std::lock_guard<std::mutex> lock(mutex_);
-        return store_.setWifiCredentials(ssid, password);
+        return writeAndNotify([&] { return store_.setWifiCredentials(ssid, password); });
     }
 
     bool clearWifiCredentials() override
     {
-        std::lock_guard<std::mutex> lock(mutex_);
-        return store_.clearWifiCredentials();
+        return writeAndNotify([&] { return store_.clearWifiCredentials(); });
+    }
+
+    StaticIpConfig getStaticIp() const override
+    {
+        std::lock_guard<DecoratorMutex> lock(mutex_);
+        return store_.getStaticIp();
+    }
+
+    bool setStaticIp(const StaticIpConfig& ip) override
+    {
+        return writeAndNotify([&] { return store_.setStaticIp(ip); });
+    }
+
+    HttpdSettings getHttpdSettings() const override
+    {
+        std::lock_guard<DecoratorMutex> lock(mutex_);
+        return store_.getHttpdSettings();
+    }
+
+    bool setHttpdSettings(const HttpdSettings& settings) override
+    {
+        return writeAndNotify([&] { return store_.setHttpdSettings(settings); });
     }
 
     bool factoryReset() override
     {
-        std::lock_guard<std::mutex> lock(mutex_);
-        return store_.factoryReset();
+        return writeAndNotify([&] { return store_.factoryReset(); });
+    }
+
+    uint32_t generation() const override { return published().generation; }
+
+    /// Lock-free: the copy published by the last write (see file comment).
+    ConfigSnapshot snapshot() const override { return published().config; }
+
+    /// Called after a successful write; see subscribe().
+    using ChangeListener = std::function<void()>;
+    static constexpr std::size_t kMaxListeners = 4;
+
+    /**
+     * @brief Call @p listener after every successful write through this
+     * wrapper — on the writing task, outside the lock, so it may read the
+     * store. Keep it short (e.g. a task notification).
+     * @return false for an empty @p listener, or when kMaxListeners are
+     * already registered
+     */
+    bool subscribe(ChangeListener listener)
+    {
+        if (!listener) {
+            return false;
+        }
+        std::lock_guard<DecoratorMutex> lock(mutex_);
+        for (ChangeListener& slot : listeners_) {
+            if (!slot) {
+                slot = std::move(listener);
+                return true;
+            }
+        }
+        return false;
     }
 
+    /// The lock, for the LockRegistry (LockStats.h, WS_LOCK_STATS).
+    const DecoratorMutex& mutex() const { return mutex_; }
+
 private:
+    /// What the scalar getters read: the snapshot plus its generation, so
+    /// a consumer never pairs a new value with an old generation.
+    struct Published {
+        ConfigSnapshot config;
+        uint32_t generation = 0;
+    };
+
+    Published published() const
+    {
+        Published p;
+        if (!published_.tryLoad(p)) {
+            // Raced a store too often; no store runs while we hold the lock.
+            std::lock_guard<DecoratorMutex> lock(mutex_);
+            published_.tryLoad(p);
+        }
+        return p;
+    }
+
+    /// Run @p write under the lock and republish (a failed write may still
+    /// have changed the store, e.g. a reload); on success notify the
+    /// listeners after the lock is released.
+    template <typename Write>
+    bool writeAndNotify(Write write)
+    {
+        std::array<ChangeListener, kMaxListeners> listeners;
+        {
+            std::lock_guard<DecoratorMutex> lock(mutex_);
+            const bool ok = write();
+            published_.store(Published{store_.snapshot(), store_.generation()});
+            if (!ok) {
+                return false;
+            }
+            listeners = listeners_;
+        }
+        for (const ChangeListener& listener : listeners) {
+            if (listener) {
+                listener();
+            }
+        }
+        return true;
+    }
+
     IConfigStore& store_;
-    mutable std::mutex mutex_;
+    mutable DecoratorMutex mutex_;         ///< serializes writers and credential reads
+    Seqlock<Published> published_;
+    std::array<ChangeListener, kMaxListeners> listeners_;
 };
 
 #endif /* WATERINGSYSTEM_STORAGE_LOCKEDCONFIGSTORE_H */
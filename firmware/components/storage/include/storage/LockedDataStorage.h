@@ -27,20 +27,56 @@
  * between the two — another task may append in between. Such sequences need
  * higher-level coordination (a caller-held lock or single-owner task).
  *
- * Pure C++ (<mutex> is available via pthread on ESP-IDF and on the linux
- * preview target), so the decorator is host-testable.
+ * WRITE-BEHIND: a long read (an 80 KiB /api/v1/history scan) would hold
+ * the lock for the whole scan and stall the watering task's appends. With
+ * a non-zero `writeBehindDepth`, a write that finds the lock held BY A
+ * READ is queued in RAM and returns at once; the queue is applied, in
+ * order, by whoever takes the lock next (the next write, read, flush or
+ * flushIfDue — the watering tick polls the latter), so every read that
+ * starts after a write returned sees it. A batch queues as one entry and
+ * is replayed as one batch, so a deferred logging pass still costs the
+ * backend one row, one journal record and one sync. The backend itself stays
+ * exclusive: reads still mutate caches and repair torn tails, so a real
+ * reader/writer split would need a thread-safe backend. A queued write
+ * reports success before the backend has seen it; a rejection at drain
+ * time is counted in StorageLockStats::deferredFailures. Writes blocked
+ * by another write (always short) and writes that find the queue full
+ * wait as before. getStorageStats() reports the contention counters.
+ *
+ * OFFLINE (deferred mount): runOffline() holds the lock while the boot
+ * wiring mounts the backend's volume on a helper task. Meanwhile writes
+ * queue in the same RAM queue, up to its own early depth, and return at
+ * once; past that they are refused and counted
+ * (StorageLockStats::offlineDropped), never made to wait for the mount.
+ * flush() and flushIfDue() have nothing to commit and return at once;
+ * getStorageStats() answers with this decorator's counters alone (volume
+ * figures 0); other reads wait, since a backend read before the mount
+ * would see an empty volume and cache it. The early queue lands, in
+ * order, before the lock is released. The backup/restore hold
+ * (main/storage_archive_hold.h) runs an archive transfer the same way.
+ *
+ * Pure C++: the lock is a StaticMutex (a static FreeRTOS mutex on target,
+ * std::mutex on the host), so the decorator is host-testable; with
+ * WS_LOCK_STATS it is instrumented for contention (LockStats.h).
  */
 
 #ifndef WATERINGSYSTEM_STORAGE_LOCKEDDATASTORAGE_H
 #define WATERINGSYSTEM_STORAGE_LOCKEDDATASTORAGE_H
 
+#include <algorithm>
+#include <atomic>
 #include <cstddef>
 #include <cstdint>
+#include <functional>
 #include <mutex>
 #include <string>
+#include <string_view>
+#include <utility>
 #include <vector>
 
 #include "interfaces/IDataStorage.h"
+#include "interfaces/LockStats.h"
+#include "interfaces/StaticMutex.h"
 
 /**
  * @brief IDataStorage decorator that serializes every call with a mutex.
@@ -51,8 +87,20 @@
  */
 class LockedDataStorage : public IDataStorage {
 public:
+    /// Microsecond clock for the wait accounting (esp_timer_get_time).
+    using Clock = std::function<int64_t()>;
+
     /// Wrap @p storage; the wrapped storage must outlive this object.
-    explicit LockedDataStorage(IDataStorage& storage) : storage_(storage) {}
+    /// @param writeBehindDepth  writes that may queue behind a read (0 =
+    ///                          every write waits for the lock)
+    /// @param clock             times writer waits; null counts them only
+    explicit LockedDataStorage(IDataStorage& storage,
+                               std::size_t writeBehindDepth = 0,
+                               Clock clock = nullptr)
+        : storage_(storage), depth_(writeBehindDepth), clock_(std::move(clock))
+    {
+        reserveQueue(depth_);
+    }
 
     LockedDataStorage(const LockedDataStorage&) = delete;
     LockedDataStorage& operator=(const LockedDataStorage&) = delete;
@@ -60,40 +108,377 @@ public:
     bool storeSensorReading(const std::string& metric, uint32_t epoch,
                             float value) override
     {
-        std::lock_guard<std::mutex> lock(mutex_);
+        std::unique_lock<DecoratorMutex> lock(mutex_, std::try_to_lock);
+        if (!lock.owns_lock()) {
+            std::lock_guard<StaticMutex> state(stateMutex_);
+            if (canDefer(1)) {
+                queue(Pending{Pending::kNamed, metric, {0, epoch, value}, 0, 1});
+                return true;
+            }
+            if (refuseOffline(1)) {
+                return false;
+            }
+        }
+        acquireForWrite(lock);
         return storage_.storeSensorReading(metric, epoch, value);
     }
 
+    /// One lock acquisition for the whole batch (not one per reading);
+    /// deferred only whole, when the queue has room for all of it, and
+    /// then replayed as one batch.
+    std::size_t storeSensorReadings(const SensorReading* readings,
+                                    std::size_t count) override
+    {
+        std::unique_lock<DecoratorMutex> lock(mutex_, std::try_to_lock);
+        if (!lock.owns_lock()) {
+            std::lock_guard<StaticMutex> state(stateMutex_);
+            if (canDefer(count)) {
+                pendingReadings_.insert(pendingReadings_.end(), readings, readings + count);
+                queue(Pending{Pending::kReadings, {}, {}, 0, count});
+                return count;
+            }
+            if (refuseOffline(count)) {
+                return 0;
+            }
+        }
+        acquireForWrite(lock);
+        return storage_.storeSensorReadings(readings, count);
+    }
+
+    std::size_t storeSamples(const MetricSample* samples,
+                             std::size_t count) override
+    {
+        std::unique_lock<DecoratorMutex> lock(mutex_, std::try_to_lock);
+        if (!lock.owns_lock()) {
+            std::lock_guard<StaticMutex> state(stateMutex_);
+            if (canDefer(count)) {
+                pendingSamples_.insert(pendingSamples_.end(), samples, samples + count);
+                queue(Pending{Pending::kSamples, {}, {}, 0, count});
+                return count;
+            }
+            if (refuseOffline(count)) {
+                return 0;
+            }
+        }
+        acquireForWrite(lock);
+        return storage_.storeSamples(samples, count);
+    }
+
     std::vector<SensorReading> getSensorReadings(const std::string& metric,
                                                  uint32_t t0,
                                                  uint32_t t1) const override
     {
-        std::lock_guard<std::mutex> lock(mutex_);
+        const ReadScope scope(*this);
         return storage_.getSensorReadings(metric, t0, t1);
     }
 
+    /// The visitor runs under the lock: it must not call back in.
+    std::size_t forEachReading(const std::string& metric, uint32_t t0,
+                               uint32_t t1,
+                               IReadingVisitor& visitor) const override
+    {
+        const ReadScope scope(*this);
+        return storage_.forEachReading(metric, t0, t1, visitor);
+    }
+
+    std::vector<SensorAggregate> getSensorAggregates(
+        const std::string& metric, uint32_t t0, uint32_t t1,
+        uint32_t bucketS) const override
+    {
+        const ReadScope scope(*this);
+        return storage_.getSensorAggregates(metric, t0, t1, bucketS);
+    }
+
+    SensorWindowStats getSensorWindowStats(const std::string& metric,
+                                           uint32_t t0,
+                                           uint32_t t1) const override
+    {
+        const ReadScope scope(*this);
+        return storage_.getSensorWindowStats(metric, t0, t1);
+    }
+
+    QuantileSketch getSensorQuantiles(const std::string& metric, uint32_t t0,
+                                      uint32_t t1) const override
+    {
+        const ReadScope scope(*this);
+        return storage_.getSensorQuantiles(metric, t0, t1);
+    }
+
+    LatestReading latestReading(const std::string& metric) const override
+    {
+        const ReadScope scope(*this);
+        return storage_.latestReading(metric);
+    }
+
+    std::vector<SensorReading> getLatestReadings(const std::string& metric,
+                                                 std::size_t n) const override
+    {
+        const ReadScope scope(*this);
+        return storage_.getLatestReadings(metric, n);
+    }
+
     bool storeEvent(uint32_t epoch, uint8_t category,
-                    const std::string& detail) override
+                    std::string_view detail) override
     {
-        std::lock_guard<std::mutex> lock(mutex_);
+        std::unique_lock<DecoratorMutex> lock(mutex_, std::try_to_lock);
+        if (!lock.owns_lock()) {
+            std::lock_guard<StaticMutex> state(stateMutex_);
+            if (canDefer(1)) {
+                queue(Pending{Pending::kEvent, std::string(detail), {0, epoch, 0.0f}, category, 1});
+                return true;
+            }
+            if (refuseOffline(1)) {
+                return false;
+            }
+        }
+        acquireForWrite(lock);
         return storage_.storeEvent(epoch, category, detail);
     }
 
     std::vector<EventRecord> getEvents(std::size_t maxCount) const override
     {
-        std::lock_guard<std::mutex> lock(mutex_);
+        const ReadScope scope(*this);
         return storage_.getEvents(maxCount);
     }
 
+    EventPage queryEvents(const EventQuery& query) const override
+    {
+        const ReadScope scope(*this);
+        return storage_.queryEvents(query);
+    }
+
+    /// The backend's figures plus this decorator's contention counters
+    /// (the counters alone while offline: stats pollers never wait).
     StorageStats getStorageStats() const override
     {
-        std::lock_guard<std::mutex> lock(mutex_);
-        return storage_.getStorageStats();
+        StorageStats stats;
+        if (!offline_.load()) {
+            const ReadScope scope(*this);
+            stats = storage_.getStorageStats();
+        }
+        std::lock_guard<StaticMutex> state(stateMutex_);
+        stats.locks = locks_;
+        return stats;
+    }
+
+    bool flush() override
+    {
+        if (offline_.load()) {
+            return true;
+        }
+        std::unique_lock<DecoratorMutex> lock(mutex_, std::defer_lock);
+        acquireForWrite(lock);
+        return storage_.flush();
     }
 
+    /// Also applies writes queued behind a read that has since finished.
+    bool flushIfDue() override
+    {
+        if (offline_.load()) {
+            return true;
+        }
+        std::unique_lock<DecoratorMutex> lock(mutex_, std::defer_lock);
+        acquireForWrite(lock);
+        return storage_.flushIfDue();
+    }
+
+    /// Never waits: while anyone holds the lock the step is skipped and
+    /// reported as pending, so upkeep always yields to the real traffic.
+    bool maintain() override
+    {
+        std::unique_lock<DecoratorMutex> lock(mutex_, std::try_to_lock);
+        if (!lock.owns_lock()) {
+            return true;
+        }
+        drainPending();
+        return storage_.maintain();
+    }
+
+    /**
+     * @brief Run @p mount with the backend offline (see OFFLINE above),
+     * then apply the writes that queued meanwhile and release the lock.
+     *
+     * @p mount runs on the calling task with the lock held: the backend is
+     * the caller's. Up to @p earlyDepth writes queue (the buffer is
+     * reserved here, before anything queues). Call it before the storage's
+     * first use, or a read may beat the hold and see the unmounted volume.
+     */
+    template <typename Mount>
+    void runOffline(std::size_t earlyDepth, Mount&& mount)
+    {
+        std::unique_lock<DecoratorMutex> lock(mutex_);
+        {
+            std::lock_guard<StaticMutex> state(stateMutex_);
+            reserveQueue(std::max(depth_, earlyDepth));
+            earlyDepth_ = earlyDepth;
+            offline_.store(true);
+        }
+        mount();
+        offline_.store(false);
+        drainPending();
+    }
+
+    /// True while runOffline() is mounting.
+    bool offline() const { return offline_.load(); }
+
+    /// The lock, for the LockRegistry (LockStats.h, WS_LOCK_STATS).
+    const DecoratorMutex& mutex() const { return mutex_; }
+
 private:
+    /// A write queued behind a read, replayed through the same entry point.
+    /// A batch's readings sit in order in pendingReadings_/pendingSamples_.
+    struct Pending {
+        enum Kind : uint8_t { kNamed, kReadings, kSamples, kEvent };
+        Kind kind;
+        std::string text;     ///< metric name (kNamed) or detail (kEvent)
+        MetricSample sample;  ///< epoch/value (kNamed, kEvent)
+        uint8_t category;     ///< kEvent
+        std::size_t count;    ///< writes in the entry (1 unless a batch)
+    };
+
+    /// Holds the lock for one read and marks it as a read, so writes
+    /// arriving meanwhile may queue instead of waiting.
+    class ReadScope {
+    public:
+        explicit ReadScope(const LockedDataStorage& owner)
+            : owner_(owner), lock_(owner.mutex_, std::try_to_lock)
+        {
+            if (!lock_.owns_lock()) {
+                {
+                    std::lock_guard<StaticMutex> state(owner_.stateMutex_);
+                    ++owner_.locks_.readerWaits;
+                }
+                lock_.lock();
+            }
+            owner_.drainPending();
+            owner_.reading_.store(true);
+        }
+        ~ReadScope() { owner_.reading_.store(false); }
+
+        ReadScope(const ReadScope&) = delete;
+        ReadScope& operator=(const ReadScope&) = delete;
+
+    private:
+        const LockedDataStorage& owner_;
+        std::unique_lock<DecoratorMutex> lock_;
+    };
+
+    /// Room for @p depth queued writes. Named batches are rare on target
+    /// (the writer queue forwards samples), so their buffer grows on use.
+    void reserveQueue(std::size_t depth)
+    {
+        pending_.reserve(depth);
+        draining_.reserve(depth);
+        pendingSamples_.reserve(depth);
+        drainingSamples_.reserve(depth);
+    }
+
+    /// Whether @p count writes may queue now. Caller holds stateMutex_.
+    bool canDefer(std::size_t count) const
+    {
+        if (offline_.load()) {
+            return queued_ + count <= earlyDepth_;
+        }
+        return reading_.load() && queued_ + count <= depth_;
+    }
+
+    /// Append @p write (its batch already buffered). Caller holds stateMutex_.
+    void queue(Pending&& write)
+    {
+        queued_ += write.count;
+        locks_.deferredWrites += static_cast<uint32_t>(write.count);
+        pending_.push_back(std::move(write));
+    }
+
+    /// Refuse @p count writes that found the early queue full, rather than
+    /// wait out the mount. Caller holds stateMutex_.
+    bool refuseOffline(std::size_t count)
+    {
+        if (!offline_.load()) {
+            return false;
+        }
+        locks_.offlineDropped += static_cast<uint32_t>(count);
+        return true;
+    }
+
+    /// Take @p lock (if not yet owned), counting and timing the wait, then
+    /// apply the queued writes so they land ahead of the caller's.
+    void acquireForWrite(std::unique_lock<DecoratorMutex>& lock)
+    {
+        if (!lock.owns_lock() && !lock.try_lock()) {
+            const int64_t start = clock_ ? clock_() : 0;
+            lock.lock();
+            const int64_t waited = clock_ ? clock_() - start : 0;
+            const uint32_t waitedUs =
+                waited > 0 ? static_cast<uint32_t>(std::min<int64_t>(waited, UINT32_MAX)) : 0;
+            std::lock_guard<StaticMutex> state(stateMutex_);
+            ++locks_.writerWaits;
+            locks_.writerWaitUs += waitedUs;
+            locks_.maxWriterWaitUs = std::max(locks_.maxWriterWaitUs, waitedUs);
+        }
+        drainPending();
+    }
+
+    /// Replay the queue in arrival order. Caller holds mutex_.
+    void drainPending() const
+    {
+        {
+            std::lock_guard<StaticMutex> state(stateMutex_);
+            if (pending_.empty()) {
+                return;
+            }
+            draining_.swap(pending_);
+            drainingReadings_.swap(pendingReadings_);
+            drainingSamples_.swap(pendingSamples_);
+            queued_ = 0;
+        }
+        std::size_t failures = 0;
+        const SensorReading* readings = drainingReadings_.data();
+        const MetricSample* samples = drainingSamples_.data();
+        for (const Pending& write : draining_) {
+            std::size_t stored = 0;
+            switch (write.kind) {
+            case Pending::kNamed:
+                stored = storage_.storeSensorReading(write.text, write.sample.epoch,
+                                                     write.sample.value) ? 1 : 0;
+                break;
+            case Pending::kReadings:
+                stored = storage_.storeSensorReadings(readings, write.count);
+                readings += write.count;
+                break;
+            case Pending::kSamples:
+                stored = storage_.storeSamples(samples, write.count);
+                samples += write.count;
+                break;
+            case Pending::kEvent:
+                stored = storage_.storeEvent(write.sample.epoch, write.category, write.text) ? 1 : 0;
+                break;
+            }
+            failures += write.count - std::min(stored, write.count);
+        }
+        draining_.clear();
+        drainingReadings_.clear();
+        drainingSamples_.clear();
+        std::lock_guard<StaticMutex> state(stateMutex_);
+        locks_.deferredFailures += static_cast<uint32_t>(failures);
+    }
+
     IDataStorage& storage_;
-    mutable std::mutex mutex_;
+    const std::size_t depth_;
+    const Clock clock_;
+    mutable DecoratorMutex mutex_;       ///< serializes every backend call
+    mutable StaticMutex stateMutex_;  ///< guards pending_ and locks_ (short)
+    mutable std::atomic<bool> reading_{false};
+    std::atomic<bool> offline_{false};  ///< runOffline() is mounting
+    std::size_t earlyDepth_ = 0;        ///< queue bound while offline (stateMutex_)
+    mutable std::size_t queued_ = 0;    ///< writes in pending_, batches in full
+    mutable std::vector<Pending> pending_;
+    mutable std::vector<SensorReading> pendingReadings_;  ///< kReadings batches
+    mutable std::vector<MetricSample> pendingSamples_;    ///< kSamples batches
+    mutable std::vector<Pending> draining_;  ///< touched under mutex_ only
+    mutable std::vector<SensorReading> drainingReadings_;  ///< under mutex_ only
+    mutable std::vector<MetricSample> drainingSamples_;    ///< under mutex_ only
+    mutable StorageLockStats locks_;
 };
 
 #endif /* WATERINGSYSTEM_STORAGE_LOCKEDDATASTORAGE_H */
@@ -9,6 +9,14 @@
  * Requires nvs_flash to be initialized before use (boot wiring in user
  * story 4; the host test fixture initializes it explicitly).
  *
+ * RAM CACHE: the constructor reads every item once into a cache, already
+ * validated and defaulted, and the getters serve that copy — the watering
+ * tick and every /config or /status request read several items, and an
+ * NVS page lookup each was their main cost. Setters write through: the
+ * cache is updated only after the NVS commit succeeded, so a failed write
+ * leaves both the entry and the cached value as they were. A change made
+ * to `wscfg` behind the store's back is seen by the next instance only.
+ *
  * NVS handles are opened per operation, never held: factoryReset() erases
  * the whole partition, which would invalidate any long-lived handle.
  *
@@ -19,18 +27,21 @@
 #ifndef WATERINGSYSTEM_STORAGE_NVSCONFIGSTORE_H
 #define WATERINGSYSTEM_STORAGE_NVSCONFIGSTORE_H
 
+#include <array>
 #include <cstddef>
 #include <cstdint>
 #include <string>
 
 #include "interfaces/IConfigStore.h"
+#include "interfaces/MetricRegistry.h"
 
 /**
  * @brief NVS-backed configuration store (target + linux-target emulation).
  */
 class NvsConfigStore : public IConfigStore {
 public:
-    NvsConfigStore() = default;
+    /// Loads the cache, so nvs_flash must already be initialized.
+    NvsConfigStore();
 
     // IConfigStore
     float getMoistureThresholdLow() const override;
@@ -47,28 +58,71 @@ public:
     bool setSensorReadIntervalMs(uint32_t ms) override;
     uint32_t getDataLogIntervalMs() const override;
     bool setDataLogIntervalMs(uint32_t ms) override;
+    uint32_t getModbusBaudRate() const override;
+    bool setModbusBaudRate(uint32_t baud) override;
+    MetricLogPolicy getMetricLogPolicy(MetricId id) const override;
+    bool setMetricLogPolicy(MetricId id, const MetricLogPolicy& policy) override;
+    /// Every entry under one handle, one nvs_commit; the cache takes the
+    /// patch only once committed (after a failure it is reloaded).
+    bool apply(const ConfigPatch& patch) override;
     std::string getWifiSsid() const override;
     std::string getWifiPassword() const override;
     bool setWifiCredentials(const std::string& ssid,
                             const std::string& password) override;
     bool clearWifiCredentials() override;
+    StaticIpConfig getStaticIp() const override;
+    /// The four entries under one handle, one nvs_commit.
+    bool setStaticIp(const StaticIpConfig& ip) override;
+    HttpdSettings getHttpdSettings() const override;
+    /// The six entries under one handle, one nvs_commit.
+    bool setHttpdSettings(const HttpdSettings& settings) override;
     bool factoryReset() override;
+    /// Bumped by every successful write, and by a reload after a failed
+    /// apply() (the cache may have changed either way).
+    uint32_t generation() const override;
 
 private:
-    // Typed helpers over per-operation NVS handles. Getters shadow a
-    // missing or out-of-range stored value with the default (FR-002);
-    // setters reject out-of-range input without touching storage (FR-003).
-    float getFloat(const char* key, float defaultValue, float minValue,
-                   float maxValue) const;
+    /// Every item as the getters return it (validated, defaults applied).
+    struct Cache {
+        float moistureThresholdLow = kDefaultMoistureThresholdLow;
+        float moistureThresholdHigh = kDefaultMoistureThresholdHigh;
+        uint32_t wateringDurationS = kDefaultWateringDurationS;
+        uint32_t minWateringIntervalS = kDefaultMinWateringIntervalS;
+        bool wateringEnabled = kDefaultWateringEnabled;
+        uint32_t sensorReadIntervalMs = kDefaultSensorReadIntervalMs;
+        uint32_t dataLogIntervalMs = kDefaultDataLogIntervalMs;
+        uint32_t modbusBaudRate = kDefaultModbusBaudRate;
+        std::string wifiSsid;
+        std::string wifiPassword;
+        StaticIpConfig staticIp;
+        HttpdSettings httpd;
+        std::array<MetricLogPolicy, metric::kKnownCount> logPolicies{};
+    };
+
+    /// Read every item from NVS into cache_.
+    void load();
+
+    // Typed helpers over per-operation NVS handles. The readers (load time
+    // only) shadow a missing or out-of-range stored value with the default
+    // (FR-002); the writers reject out-of-range input without touching
+    // storage (FR-003) and update @p cached once the value is committed.
+    float readFloat(const char* key, float defaultValue, float minValue,
+                    float maxValue) const;
     bool setFloat(const char* key, float value, float minValue,
-                  float maxValue);
-    uint32_t getU32(const char* key, uint32_t defaultValue, uint32_t minValue,
-                    uint32_t maxValue) const;
+                  float maxValue, float& cached);
+    uint32_t readU32(const char* key, uint32_t defaultValue, uint32_t minValue,
+                     uint32_t maxValue) const;
     bool setU32(const char* key, uint32_t value, uint32_t minValue,
-                uint32_t maxValue);
-    bool getBool(const char* key, bool defaultValue) const;
-    bool setBool(const char* key, bool value);
-    std::string getString(const char* key, std::size_t maxLen) const;
+                uint32_t maxValue, uint32_t& cached);
+    bool readBool(const char* key, bool defaultValue) const;
+    bool setBool(const char* key, bool value, bool& cached);
+    std::string readString(const char* key, std::size_t maxLen) const;
+    MetricLogPolicy readLogPolicy(MetricId id) const;
+    StaticIpConfig readStaticIp() const;
+    HttpdSettings readHttpdSettings() const;
+
+    Cache cache_;
+    uint32_t generation_ = 0;
 };
 
 #endif /* WATERINGSYSTEM_STORAGE_NVSCONFIGSTORE_H */
@@ -0,0 +1,174 @@
+// SPDX-FileCopyrightText: 2026 Cryptotomte
+// SPDX-License-Identifier: AGPL-3.0-or-later
+/**
+ * @file QueuedDataStorage.h
+ * @brief IDataStorage decorator that hands writes to a storage writer task.
+ *
+ * WHY THIS EXISTS: WateringController::tick() logs a pass of readings and
+ * EventLogger::emit() stores an event on the calling task, so a slow fsync
+ * on a busy flash (tens of milliseconds per record) lands inside the
+ * decision task's tick. This decorator turns every write into a copy into
+ * a fixed-size queue and returns; a dedicated low-priority writer task
+ * (main/storage_writer_task.cpp) applies the queue to the wrapped storage.
+ * A producer's latency then no longer depends on the flash.
+ *
+ * OVERFLOW: the queue never grows. A write that finds it full is refused
+ * (returns false, so EventLogger counts it in droppedEvents() as for any
+ * failed store) and counted in StorageQueueStats::dropped. A queued write
+ * returns true before the backend has seen it; a rejection when it is
+ * applied is counted in StorageQueueStats::failed.
+ *
+ * COALESCING: an event identical (category and detail) to the newest
+ * queued write is not queued again; that slot counts the repeat and keeps
+ * the newest epoch, and is stored once as "<detail> count=N last=<epoch>"
+ * (a compact detail gets the same as a binary trailer, EventCodec.h) at
+ * the first occurrence's epoch (StorageQueueStats::coalesced). Only
+ * a still-queued event absorbs repeats, so a storm the writer keeps up
+ * with is stored as it came, and one that outruns it costs one record per
+ * run instead of churning the event log's rotation.
+ *
+ * ORDER AND VISIBILITY: writes are applied in arrival order, by one
+ * applier at a time. Every read, flush() and drain() first applies
+ * whatever is queued on the calling task, so a read sees every write that
+ * returned before it. flushIfDue() only wakes the writer task, which then
+ * polls the backend's group-commit deadline itself.
+ *
+ * SHUTDOWN: drain() applies the queue and flushes the backend
+ * synchronously; call it before a reboot or OTA switch (the app registers
+ * it as an esp_restart() shutdown handler).
+ *
+ * Pure C++ (std::mutex/condition_variable, pthread-backed on ESP-IDF), so
+ * the decorator and its queue are host-tested; only the task is target code.
+ * Wrap the cross-task LockedDataStorage: the readers (HTTP, console) and
+ * the writer task reach the backend from different tasks.
+ */
+
+#ifndef WATERINGSYSTEM_STORAGE_QUEUEDDATASTORAGE_H
+#define WATERINGSYSTEM_STORAGE_QUEUEDDATASTORAGE_H
+
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <mutex>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "interfaces/IDataStorage.h"
+#include "interfaces/MetricRegistry.h"
+
+/**
+ * @brief Bounded write queue in front of an IDataStorage.
+ *
+ * Producers (any task) enqueue; waitAndApply() is the writer task's loop
+ * body. Reads pass through after applying the queue.
+ */
+class QueuedDataStorage : public IDataStorage {
+public:
+    /// Wrap @p target (must outlive this object) with a queue of
+    /// @p capacity writes, allocated here once.
+    QueuedDataStorage(IDataStorage& target, std::size_t capacity);
+
+    QueuedDataStorage(const QueuedDataStorage&) = delete;
+    QueuedDataStorage& operator=(const QueuedDataStorage&) = delete;
+
+    /// Queued. A name longer than kEventDetailMaxLen (the slot's text
+    /// buffer; the firmware's names are far shorter) is written through
+    /// on the calling task instead.
+    bool storeSensorReading(const std::string& metric, uint32_t epoch,
+                            float value) override;
+
+    /// Queued only whole: a batch that does not fit is refused entirely.
+    std::size_t storeSensorReadings(const SensorReading* readings,
+                                    std::size_t count) override;
+    std::size_t storeSamples(const MetricSample* samples,
+                             std::size_t count) override;
+
+    /// Queued, or coalesced into the newest queued write when that is the
+    /// same event; the detail is truncated to kEventDetailMaxLen here, as
+    /// the storage contract would on store.
+    bool storeEvent(uint32_t epoch, uint8_t category,
+                    std::string_view detail) override;
+
+    std::vector<SensorReading> getSensorReadings(const std::string& metric,
+                                                 uint32_t t0,
+                                                 uint32_t t1) const override;
+    std::size_t forEachReading(const std::string& metric, uint32_t t0,
+                               uint32_t t1,
+                               IReadingVisitor& visitor) const override;
+    std::vector<SensorAggregate> getSensorAggregates(
+        const std::string& metric, uint32_t t0, uint32_t t1,
+        uint32_t bucketS) const override;
+    SensorWindowStats getSensorWindowStats(const std::string& metric,
+                                           uint32_t t0,
+                                           uint32_t t1) const override;
+    QuantileSketch getSensorQuantiles(const std::string& metric, uint32_t t0,
+                                      uint32_t t1) const override;
+    LatestReading latestReading(const std::string& metric) const override;
+    std::vector<SensorReading> getLatestReadings(const std::string& metric,
+                                                 std::size_t n) const override;
+    std::vector<EventRecord> getEvents(std::size_t maxCount) const override;
+    EventPage queryEvents(const EventQuery& query) const override;
+
+    /// The target's figures plus the queue counters.
+    StorageStats getStorageStats() const override;
+
+    /// Apply the queue, then flush the target.
+    bool flush() override;
+
+    /// Wake the writer task to poll the target's flushIfDue(); never
+    /// blocks. Always true (the poll's result is the writer task's).
+    bool flushIfDue() override;
+
+    /// Straight to the target: upkeep moves data, it adds none, so queued
+    /// writes need not land first.
+    bool maintain() override { return target_.maintain(); }
+
+    /**
+     * @brief Writer task body: wait up to @p timeoutMs for queued writes
+     * or a flushIfDue() request, then apply the queue and poll the
+     * target's flushIfDue() when one was requested.
+     * @return writes applied
+     */
+    std::size_t waitAndApply(uint32_t timeoutMs);
+
+    /// Apply everything queued and flush the target, synchronously
+    /// (before reboot/OTA). False if the flush failed.
+    bool drain() { return flush(); }
+
+private:
+    /// One queued write. Fixed size, so enqueueing never allocates.
+    struct Slot {
+        enum Kind : uint8_t { kSample, kNamed, kEvent };
+        Kind kind = kSample;
+        uint8_t category = 0;    ///< kEvent
+        uint8_t textLen = 0;     ///< kNamed: the name, kEvent: the detail
+        MetricSample sample;     ///< kSample: all; otherwise epoch (+ value)
+        uint32_t repeats = 0;    ///< kEvent: identical events coalesced in
+        uint32_t lastEpoch = 0;  ///< kEvent: epoch of the newest of them
+        char text[kEventDetailMaxLen];
+    };
+    static_assert(kEventDetailMaxLen <= UINT8_MAX, "textLen is one byte");
+
+    /// Reserve @p count slots and fill them via @p fill, or count a drop.
+    template <typename Fill>
+    bool enqueue(std::size_t count, Fill fill);
+
+    /// Apply queued writes in order until the queue is empty. Takes
+    /// applyMutex_, so concurrent appliers cannot reorder them.
+    std::size_t applyQueued() const;
+
+    bool apply(const Slot& slot) const;
+
+    IDataStorage& target_;
+    std::vector<Slot> slots_;
+    mutable std::mutex queueMutex_;  ///< guards the ring and stats_ (short)
+    mutable std::mutex applyMutex_;  ///< held across target writes
+    std::condition_variable wake_;
+    mutable std::size_t head_ = 0;   ///< oldest queued slot
+    mutable std::size_t size_ = 0;
+    bool flushDue_ = false;
+    mutable StorageQueueStats stats_;
+};
+
+#endif /* WATERINGSYSTEM_STORAGE_QUEUEDDATASTORAGE_H */
@@ -0,0 +1,74 @@
+// SPDX-FileCopyrightText: 2026 Cryptotomte
+// SPDX-License-Identifier: AGPL-3.0-or-later
+/**
+ * @file RecordReduce.h
+ * @brief Min/max/sum/last reduction over packed 8-byte history records.
+ *
+ * A chunk summary (and the rollup of a raw chunk) reduces up to 1024
+ * records {uint32 LE epoch, LE float value}. Reduction::add() is the
+ * one-record step the delta codec's frame-at-a-time decode feeds;
+ * reduce() takes a whole plain chunk at once and runs kLanes independent
+ * accumulators over it, so no compare or add waits on the one before it
+ * and the first-record branch is taken once per chunk, not per record.
+ *
+ * Results match reduceScalar() exactly for count, min, max, the epochs
+ * and last (ties on the newest epoch go to the later record, as add()
+ * does). The double sum adds the same values in a different order, so it
+ * may differ from the scalar one in the last bits.
+ *
+ * The kernel is selected at compile time: this tree builds for the plain
+ * ESP32 and the linux host, both on the portable lane loop below. A
+ * target with vector float instructions adds its own reduce() behind a
+ * CONFIG_IDF_TARGET_* guard in RecordReduce.cpp, checked against
+ * reduceScalar() by the host suite and timed by storage.reduce_chunk in
+ * the bench app. Pure C++, no IDF includes.
+ */
+
+#ifndef WATERINGSYSTEM_STORAGE_RECORDREDUCE_H
+#define WATERINGSYSTEM_STORAGE_RECORDREDUCE_H
+
+#include <cstddef>
+#include <cstdint>
+
+namespace recordreduce {
+
+constexpr std::size_t kRecordBytes = 8;
+constexpr std::size_t kLanes = 4;
+
+/// Running reduction of a record stream; empty until the first add().
+struct Reduction {
+    uint32_t count = 0;
+    uint32_t minEpoch = 0;
+    uint32_t maxEpoch = 0;
+    float min = 0.0f;
+    float max = 0.0f;
+    double sum = 0.0;
+    float last = 0.0f;  ///< value at maxEpoch (the later one on a tie)
+
+    void add(uint32_t epoch, float value)
+    {
+        if (count++ == 0) {
+            min = max = value;
+            minEpoch = maxEpoch = epoch;
+        }
+        min = value < min ? value : min;
+        max = value > max ? value : max;
+        sum += value;
+        minEpoch = epoch < minEpoch ? epoch : minEpoch;
+        if (epoch >= maxEpoch) {
+            maxEpoch = epoch;
+            last = value;
+        }
+    }
+};
+
+/// Reference: add() for each of @p count records at @p bytes, in order.
+void reduceScalar(const uint8_t* bytes, std::size_t count, Reduction& out);
+
+/// Fold @p count records at @p bytes into @p out (which may already hold
+/// records that came before them) with the lane kernel.
+void reduce(const uint8_t* bytes, std::size_t count, Reduction& out);
+
+}  // namespace recordreduce
+
+#endif /* WATERINGSYSTEM_STORAGE_RECORDREDUCE_H */
@@ -0,0 +1,116 @@
+// SPDX-FileCopyrightText: 2026 Cryptotomte
+// SPDX-License-Identifier: AGPL-3.0-or-later
+/**
+ * @file RetentionPlan.h
+ * @brief Per-metric history retention: the storage partition's history
+ *        budget split into chunk rings by target days and weight.
+ *
+ * Without a plan every metric keeps the same ring
+ * (LittleFsDataStorage::kHistoryMaxChunksPerMetric chunks), whatever the
+ * partition size or the metric's worth: soil moisture ages out as fast as
+ * pressure, and a partition larger than the rings leaves flash unused. A
+ * plan gives each metric its own ring size, chunks of the history budget
+ * handed out in three passes:
+ *  1. every metric planned for gets kMinChunks;
+ *  2. a metric with a target in days is topped up to cover it (rules in
+ *     configured order, while chunks last);
+ *  3. what is left is shared by weight among the weighted rules and the
+ *     metrics no rule names.
+ * LittleFsDataStorage applies the result at eviction time
+ * (LittleFsDataStorageOptions::retention), so a smaller ring after a
+ * reconfiguration sheds its oldest chunks on the metric's next seal.
+ *
+ * Rules come from a short text spec ("soil_moisture:90d,env_pressure:1");
+ * targets are planned at an assumed log interval and bytes per reading,
+ * so a faster interval or a worse compression ratio covers less. Pure
+ * C++, no IDF includes.
+ */
+
+#ifndef WATERINGSYSTEM_STORAGE_RETENTIONPLAN_H
+#define WATERINGSYSTEM_STORAGE_RETENTIONPLAN_H
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace retention {
+
+/// Fewest chunks a metric is given: an eviction (at the seal of the
+/// active chunk) then still leaves one full chunk of history.
+constexpr std::size_t kMinChunks = 2;
+
+/// One configured metric.
+struct Rule {
+    std::string metric;
+    uint32_t weight = 0;      ///< share of the chunks left after the targets
+    uint32_t targetDays = 0;  ///< keep at least this many days; 0 = none
+};
+
+/**
+ * @brief Parse a comma-separated rule spec: `<metric>:<weight>` or
+ * `<metric>:<days>d` per entry, blanks around entries ignored.
+ *
+ * A metric named twice keeps its last entry.
+ * @return false on a malformed entry (nothing is appended then)
+ */
+bool parseRules(std::string_view spec, std::vector<Rule>& rules);
+
+/// What a plan is made from.
+struct Budget {
+    std::size_t bytes = 0;            ///< flash set aside for raw history
+    std::size_t chunkBytes = 8192;    ///< one history chunk
+    std::size_t bytesPerReading = 8;  ///< stored size of one reading (codec)
+    uint32_t intervalS = 300;         ///< log interval the targets assume
+    /// Metrics to plan for: the rules' plus unnamed ones at defaultWeight.
+    std::size_t metrics = 10;
+    uint32_t defaultWeight = 1;
+};
+
+/// Ring size of each metric under one Budget and rule set.
+class Plan {
+public:
+    /// No plan: chunksFor() is 0 (the storage default) for every metric.
+    Plan() = default;
+
+    /// Ring size of `metric` in chunks; 0 when nothing was planned.
+    std::size_t chunksFor(std::string_view metric) const;
+
+    /// Chunks given to a metric no rule names.
+    std::size_t otherChunks() const { return otherChunks_; }
+
+    /// Chunks handed out over all planned metrics.
+    std::size_t totalChunks() const { return totalChunks_; }
+
+    /// False when the floor or a target did not fit the budget (the plan
+    /// is still usable: targets were cut, or the floor overcommits).
+    bool fits() const { return fits_; }
+
+    bool empty() const { return !planned_; }
+
+    /// Days of history `chunks` hold under `budget` after an eviction
+    /// (every chunk but the active one full).
+    static uint32_t coveredDays(std::size_t chunks, const Budget& budget);
+
+private:
+    friend Plan plan(const Budget& budget, const std::vector<Rule>& rules);
+
+    struct Entry {
+        std::string metric;
+        std::size_t chunks = 0;
+    };
+
+    std::vector<Entry> entries_;
+    std::size_t otherChunks_ = 0;
+    std::size_t totalChunks_ = 0;
+    bool fits_ = true;
+    bool planned_ = false;
+};
+
+/// Split `budget` across `rules` and the unnamed metrics (see file doc).
+Plan plan(const Budget& budget, const std::vector<Rule>& rules);
+
+}  // namespace retention
+
+#endif /* WATERINGSYSTEM_STORAGE_RETENTIONPLAN_H */
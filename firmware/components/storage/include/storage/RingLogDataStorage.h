@@ -0,0 +1,191 @@
+// SPDX-FileCopyrightText: 2026 Cryptotomte
+// SPDX-License-Identifier: AGPL-3.0-or-later
+/**
+ * @file RingLogDataStorage.h
+ * @brief IDataStorage as two sector rings on a raw flash partition.
+ *
+ * The alternative to LittleFsDataStorage for boards that select
+ * CONFIG_WS_DATA_STORAGE_RINGLOG: sensor history and events go straight
+ * into a dedicated `ringlog` data partition (docs/partition-plan.md) as
+ * CRC-framed records, with no filesystem in between — an append programs
+ * the record bytes and nothing else, where littlefs also commits metadata
+ * (and rewrites the tail block) on every fsync.
+ *
+ * Layout (all integers little-endian). The partition is split into an
+ * event ring (the first kEventSectors sectors) and a history ring (the
+ * rest). Every in-use sector starts with a 12-byte header
+ *   {uint32 magic 'WSR1', uint32 seq, uint8 ring, uint8 version, crc16}
+ * followed by back-to-back frames
+ *   {uint8 type, uint8 len, payload[len], crc16 over type..payload}
+ * that never straddle a sector; the first 0xFF type byte is the end.
+ *  - History (type 0x01): {uint32 epoch, uint16 metric mask, one float
+ *    per set bit in ascending MetricId order} — one frame per epoch of a
+ *    logging pass, like HistoryFormat::Rows.
+ *  - Event (type 0x02): {uint32 epoch, uint8 category, detail bytes}.
+ * CRC is CRC-16/CCITT-FALSE. `seq` grows by one each time a ring moves
+ * on to its next sector, which is erased first: that erase is the
+ * eviction of the ring's oldest sector.
+ *
+ * Recovery: the constructor scans every sector header (and, for the
+ * per-sector epoch/metric summaries, every frame — in place through
+ * IFlashPartition::mapped() when available) and orders each ring by seq;
+ * the highest seq is the head. The constructor performs no writes. A
+ * frame that fails its CRC, or bytes after the end marker that are not
+ * erased (a torn write), end the sector's valid prefix; if that is the
+ * head sector it is sealed and the next append starts a new sector, so
+ * nothing is ever programmed over a damaged region.
+ *
+ * Metrics are the known table of MetricRegistry.h, stored by id: there is
+ * no name table on flash to lose to eviction, so any other name is
+ * rejected (false) — a documented divergence from the per-metric store,
+ * which accepts any ten names. Every append is durable on return; there
+ * is no write-behind mode. Unsynchronized by design — wrap it in
+ * LockedDataStorage.
+ *
+ * Write accounting (StorageStats::writes) in ring terms: every flash
+ * program is a sync, a sector started is a file created, erasing a live
+ * sector a file removed, an event-ring sector move a rotation, and a head
+ * sector sealed at recovery a torn repair.
+ */
+
+#ifndef WATERINGSYSTEM_STORAGE_RINGLOGDATASTORAGE_H
+#define WATERINGSYSTEM_STORAGE_RINGLOGDATASTORAGE_H
+
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "interfaces/IDataStorage.h"
+#include "interfaces/IFlashPartition.h"
+#include "interfaces/MetricRegistry.h"
+
+/**
+ * @brief Raw-partition ring-log data storage (target + host RAM flash).
+ */
+class RingLogDataStorage : public IDataStorage {
+public:
+    // On-flash format constants — exposed for the contract tests.
+    static constexpr std::size_t kSectorBytes = IFlashPartition::kSectorBytes;
+    static constexpr std::size_t kSectorHeaderBytes = 12;
+    static constexpr std::size_t kFrameOverheadBytes = 4;  ///< type, len, crc16
+    static constexpr uint32_t kSectorMagic = 0x31525357;   ///< "WSR1"
+    static constexpr uint8_t kFormatVersion = 1;
+    static constexpr uint8_t kHistoryFrame = 0x01;
+    static constexpr uint8_t kEventFrame = 0x02;
+
+    /// Event ring size: 32 KiB, the same budget as the two littlefs event
+    /// files. The history ring needs at least two sectors.
+    static constexpr std::size_t kEventSectors = 8;
+    static constexpr std::size_t kMinSectors = kEventSectors + 2;
+
+    static_assert(metric::kKnownCount <= 16, "history mask is 16 bits");
+
+    /**
+     * @param flash the raw partition (borrowed; must outlive the storage).
+     *              Smaller than kMinSectors sectors leaves the storage
+     *              unusable: appends fail and queries are empty.
+     * @param appendClock microsecond clock timing appends into
+     *              StorageWriteStats::appendUs; empty = not timed.
+     */
+    explicit RingLogDataStorage(IFlashPartition& flash,
+                                std::function<int64_t()> appendClock = nullptr);
+
+    RingLogDataStorage(const RingLogDataStorage&) = delete;
+    RingLogDataStorage& operator=(const RingLogDataStorage&) = delete;
+
+    bool storeSensorReading(const std::string& metric, uint32_t epoch,
+                            float value) override;
+
+    /// Readings sharing an epoch land in one history frame.
+    std::size_t storeSensorReadings(const SensorReading* readings,
+                                    std::size_t count) override;
+
+    std::size_t storeSamples(const MetricSample* samples,
+                             std::size_t count) override;
+
+    std::vector<SensorReading> getSensorReadings(const std::string& metric,
+                                                 uint32_t t0,
+                                                 uint32_t t1) const override;
+
+    /// Visits only sectors whose summary admits the metric and window.
+    std::size_t forEachReading(const std::string& metric, uint32_t t0,
+                               uint32_t t1,
+                               IReadingVisitor& visitor) const override;
+
+    bool storeEvent(uint32_t epoch, uint8_t category,
+                    std::string_view detail) override;
+
+    std::vector<EventRecord> getEvents(std::size_t maxCount) const override;
+
+    /// Newest sector first, each sector's frames newest first.
+    EventPage queryEvents(const EventQuery& query) const override;
+
+    /// Partition size, the bytes held by in-use sectors (headers plus
+    /// valid frames) and the write counters; no flash access.
+    StorageStats getStorageStats() const override;
+
+private:
+    /// RAM summary of one sector, rebuilt at recovery.
+    struct Sector {
+        bool live = false;      ///< holds a valid header
+        bool sealed = false;    ///< no further appends (damaged tail)
+        uint32_t seq = 0;
+        uint16_t valid = 0;     ///< header + valid frames, bytes
+        uint16_t metricMask = 0;  ///< history ring: metrics present
+        uint32_t minEpoch = UINT32_MAX;
+        uint32_t maxEpoch = 0;
+    };
+
+    /// A contiguous run of sectors used as one ring.
+    struct Ring {
+        uint8_t id = 0;
+        std::size_t first = 0;  ///< partition sector index of ring slot 0
+        std::vector<Sector> sectors;
+        std::vector<std::size_t> order;  ///< live slots, oldest seq first
+        uint32_t nextSeq = 1;
+    };
+
+    /// Rebuild `ring`'s summaries from flash.
+    void recoverRing(Ring& ring);
+
+    /// Summarize slot `slot` of `ring` from its bytes.
+    void scanSector(Ring& ring, std::size_t slot);
+
+    /// Bytes of the sector at ring slot `slot`: mapped in place, else
+    /// copied into `sectorScratch_` (up to `len` bytes). nullptr on error.
+    const uint8_t* sectorBytes(const Ring& ring, std::size_t slot,
+                               std::size_t len) const;
+
+    /// Append one frame to `ring`'s head, moving to (erasing) the next
+    /// sector when it does not fit. Updates the RAM summary.
+    bool appendFrame(Ring& ring, uint8_t type, const uint8_t* payload,
+                     std::size_t len, uint32_t epoch, uint16_t metricMask);
+
+    /// Erase the slot after the head and give it a fresh header.
+    bool advance(Ring& ring);
+
+    /// Durably append samples sharing `epoch` (at most one per metric)
+    /// as one history frame.
+    bool appendRow(uint32_t epoch, const MetricSample* samples,
+                   std::size_t count);
+
+    /// Program `len` bytes at `offset`, counted in writes_.
+    bool program(std::size_t offset, const void* src, std::size_t len);
+
+    IFlashPartition& flash_;
+    std::function<int64_t()> appendClock_;
+    StorageWriteStats writes_;
+    bool usable_ = false;
+    Ring events_;
+    Ring history_;
+
+    mutable std::vector<uint8_t> sectorScratch_;     ///< unmapped reads
+    mutable std::vector<uint16_t> offsetScratch_;    ///< queryEvents()
+    std::vector<uint8_t> frameScratch_;              ///< appendFrame()
+    std::vector<MetricSample> sampleScratch_;        ///< storeSensorReadings()
+};
+
+#endif /* WATERINGSYSTEM_STORAGE_RINGLOGDATASTORAGE_H */
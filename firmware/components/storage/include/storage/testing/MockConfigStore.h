@@ -16,6 +16,7 @@
 #ifndef WATERINGSYSTEM_STORAGE_TESTING_MOCKCONFIGSTORE_H
 #define WATERINGSYSTEM_STORAGE_TESTING_MOCKCONFIGSTORE_H
 
+#include <array>
 #include <cmath>
 #include <cstdint>
 #include <optional>
@@ -42,8 +43,12 @@ public:
         std::optional<uint8_t> wateringEnabled;
         std::optional<uint32_t> sensorReadIntervalMs;
         std::optional<uint32_t> dataLogIntervalMs;
+        std::optional<uint32_t> modbusBaudRate;
         std::optional<std::string> wifiSsid;
         std::optional<std::string> wifiPassword;
+        std::optional<StaticIpConfig> staticIp;
+        std::optional<HttpdSettings> httpd;
+        std::array<std::optional<MetricLogPolicy>, metric::kKnownCount> logPolicies;
     };
 
     Stored stored;
@@ -52,6 +57,12 @@ public:
     int acceptedWrites = 0;   ///< setters that persisted a value
     int rejectedWrites = 0;   ///< setters rejected (validation or failWrites)
     int factoryResets = 0;    ///< successful factoryReset() calls
+    int applyCalls = 0;       ///< apply() calls, accepted or not
+    /// Tests edit `stored` directly, which no counter sees, so by default
+    /// every generation() call reports a change (consumers re-read each
+    /// time). Set to report only accepted writes and resets instead, to
+    /// test a consumer's cache.
+    bool stableGeneration = false;
     bool failWrites = false;  ///< true: every write fails, state untouched
 
     // IConfigStore — getters (defaults shadow missing/invalid storage)
@@ -102,6 +113,14 @@ public:
                          kDataLogIntervalFloorMs, kNoUpperBound);
     }
 
+    uint32_t getModbusBaudRate() const override
+    {
+        return stored.modbusBaudRate.has_value() &&
+                       isValidModbusBaudRate(*stored.modbusBaudRate)
+                   ? *stored.modbusBaudRate
+                   : kDefaultModbusBaudRate;
+    }
+
     std::string getWifiSsid() const override
     {
         return shadowString(stored.wifiSsid, kWifiSsidMaxLen);
@@ -158,6 +177,37 @@ public:
                         kNoUpperBound);
     }
 
+    bool setModbusBaudRate(uint32_t baud) override
+    {
+        if (failWrites || !isValidModbusBaudRate(baud)) {
+            ++rejectedWrites;
+            return false;
+        }
+        stored.modbusBaudRate = baud;
+        ++acceptedWrites;
+        return true;
+    }
+
+    MetricLogPolicy getMetricLogPolicy(MetricId id) const override
+    {
+        if (id >= metric::kKnownCount || !stored.logPolicies[id].has_value() ||
+            !isValidLogPolicy(*stored.logPolicies[id])) {
+            return MetricLogPolicy{};
+        }
+        return *stored.logPolicies[id];
+    }
+
+    bool setMetricLogPolicy(MetricId id, const MetricLogPolicy& policy) override
+    {
+        if (failWrites || id >= metric::kKnownCount || !isValidLogPolicy(policy)) {
+            ++rejectedWrites;
+            return false;
+        }
+        stored.logPolicies[id] = policy;
+        ++acceptedWrites;
+        return true;
+    }
+
     bool setWifiCredentials(const std::string& ssid,
                             const std::string& password) override
     {
@@ -184,6 +234,62 @@ public:
         return true;
     }
 
+    StaticIpConfig getStaticIp() const override
+    {
+        return stored.staticIp.has_value() && isValidStaticIp(*stored.staticIp)
+                   ? *stored.staticIp
+                   : StaticIpConfig{};
+    }
+
+    bool setStaticIp(const StaticIpConfig& ip) override
+    {
+        if (failWrites || !isValidStaticIp(ip)) {
+            ++rejectedWrites;
+            return false;
+        }
+        stored.staticIp = ip;
+        ++acceptedWrites;
+        return true;
+    }
+
+    HttpdSettings getHttpdSettings() const override
+    {
+        return stored.httpd.has_value() && isValidHttpdSettings(*stored.httpd)
+                   ? *stored.httpd
+                   : HttpdSettings{};
+    }
+
+    bool setHttpdSettings(const HttpdSettings& settings) override
+    {
+        if (failWrites || !isValidHttpdSettings(settings)) {
+            ++rejectedWrites;
+            return false;
+        }
+        stored.httpd = settings;
+        ++acceptedWrites;
+        return true;
+    }
+
+    uint32_t generation() const override
+    {
+        if (stableGeneration) {
+            return static_cast<uint32_t>(acceptedWrites + factoryResets);
+        }
+        return ++volatileGeneration_;
+    }
+
+    /// The interface's setter-by-setter apply(), counted; an invalid patch
+    /// counts as one rejected write.
+    bool apply(const ConfigPatch& patch) override
+    {
+        ++applyCalls;
+        if (!isValidPatch(patch)) {
+            ++rejectedWrites;
+            return false;
+        }
+        return IConfigStore::apply(patch);
+    }
+
     bool factoryReset() override
     {
         if (failWrites) {
@@ -197,6 +303,8 @@ public:
 private:
     static constexpr uint32_t kNoUpperBound = UINT32_MAX;
 
+    mutable uint32_t volatileGeneration_ = 0;
+
     static float shadowFloat(const std::optional<float>& value,
                              float defaultValue)
     {
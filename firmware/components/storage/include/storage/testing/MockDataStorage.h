@@ -22,6 +22,7 @@
 #include <cstdint>
 #include <map>
 #include <string>
+#include <string_view>
 #include <vector>
 
 #include "interfaces/IDataStorage.h"
@@ -51,6 +52,9 @@ public:
     int acceptedWrites = 0;   ///< appends that were stored
     int rejectedWrites = 0;   ///< appends rejected (cap or failWrites)
     bool failWrites = false;  ///< true: every write fails, state untouched
+    int batchWrites = 0;      ///< storeSensorReadings() invocations
+    int flushCalls = 0;       ///< flush() invocations
+    int flushIfDueCalls = 0;  ///< flushIfDue() invocations
 
     /// Defensive metric-name rule shared with the real store: names become
     /// directory names there, so empty, '/' or ".." are rejected.
@@ -86,6 +90,13 @@ public:
         return true;
     }
 
+    std::size_t storeSensorReadings(const SensorReading* readings,
+                                    std::size_t count) override
+    {
+        ++batchWrites;  // per-reading counters move in storeSensorReading()
+        return IDataStorage::storeSensorReadings(readings, count);
+    }
+
     std::vector<SensorReading> getSensorReadings(const std::string& metric,
                                                  uint32_t t0,
                                                  uint32_t t1) const override
@@ -107,7 +118,7 @@ public:
     }
 
     bool storeEvent(uint32_t epoch, uint8_t category,
-                    const std::string& detail) override
+                    std::string_view detail) override
     {
         if (failWrites) {
             ++rejectedWrites;
@@ -115,7 +126,7 @@ public:
         }
         // Over-long detail is truncated, never rejected (contract).
         events.push_back(
-            EventRecord{epoch, category, detail.substr(0, kEventDetailMaxLen)});
+            EventRecord{epoch, category, std::string(detail.substr(0, kEventDetailMaxLen))});
         if (events.size() > kMaxEvents) {
             events.erase(events.begin());  // newest always retained
         }
@@ -134,6 +145,19 @@ public:
     }
 
     StorageStats getStorageStats() const override { return stats; }
+
+    // Per-record durable: nothing is ever buffered, only count the calls.
+    bool flush() override
+    {
+        ++flushCalls;
+        return true;
+    }
+
+    bool flushIfDue() override
+    {
+        ++flushIfDueCalls;
+        return true;
+    }
 };
 
 #endif /* WATERINGSYSTEM_STORAGE_TESTING_MOCKDATASTORAGE_H */
@@ -0,0 +1,100 @@
+// SPDX-FileCopyrightText: 2026 Cryptotomte
+// SPDX-License-Identifier: AGPL-3.0-or-later
+/**
+ * @file RamFlashPartition.h
+ * @brief In-memory NOR-flash IFlashPartition test double (header-only).
+ *
+ * Enforces the NOR contract instead of assuming it: erase sets a sector to
+ * 0xFF and a write ANDs into the existing bytes, so a storage that
+ * programs a byte twice sees the corruption it would see on the chip.
+ * Counts programmed bytes and erases (write-amplification checks) and
+ * simulates a power cut: `tearAfterBytes` lets that many more bytes land
+ * and then fails every write and erase. `mapping` toggles the mapped()
+ * view so both read paths are exercised. Never compiled into target
+ * builds (only included from test code). No IDF includes.
+ */
+
+#ifndef WATERINGSYSTEM_STORAGE_TESTING_RAMFLASHPARTITION_H
+#define WATERINGSYSTEM_STORAGE_TESTING_RAMFLASHPARTITION_H
+
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <vector>
+
+#include "interfaces/IFlashPartition.h"
+
+/**
+ * @brief IFlashPartition over a byte vector, instrumented for tests.
+ */
+class RamFlashPartition : public IFlashPartition {
+public:
+    /// A partition of @p sectors erased sectors.
+    explicit RamFlashPartition(std::size_t sectors)
+        : bytes(sectors * kSectorBytes, 0xFF)
+    {
+    }
+
+    /// Raw contents; tests may corrupt or inspect them directly.
+    std::vector<uint8_t> bytes;
+
+    /// Expose mapped() (the esp_partition_mmap path) when true.
+    bool mapping = true;
+
+    /// Power cut: once this many more bytes have been programmed, the
+    /// rest of that write and every later write/erase fail. -1 = never.
+    long tearAfterBytes = -1;
+
+    // Instrumentation.
+    std::size_t bytesWritten = 0;
+    std::size_t writeCalls = 0;
+    std::size_t erases = 0;
+
+    std::size_t size() const override { return bytes.size(); }
+
+    bool read(std::size_t offset, void* dst, std::size_t len) const override
+    {
+        if (offset > bytes.size() || len > bytes.size() - offset) {
+            return false;
+        }
+        std::memcpy(dst, bytes.data() + offset, len);
+        return true;
+    }
+
+    bool write(std::size_t offset, const void* src, std::size_t len) override
+    {
+        if (offset > bytes.size() || len > bytes.size() - offset) {
+            return false;
+        }
+        ++writeCalls;
+        const uint8_t* in = static_cast<const uint8_t*>(src);
+        for (std::size_t i = 0; i < len; ++i) {
+            if (tearAfterBytes == 0) {
+                return false;
+            }
+            if (tearAfterBytes > 0) {
+                --tearAfterBytes;
+            }
+            bytes[offset + i] &= in[i];
+            ++bytesWritten;
+        }
+        return true;
+    }
+
+    bool eraseSector(std::size_t sector) override
+    {
+        if (tearAfterBytes == 0 || sector >= bytes.size() / kSectorBytes) {
+            return false;
+        }
+        std::memset(bytes.data() + sector * kSectorBytes, 0xFF, kSectorBytes);
+        ++erases;
+        return true;
+    }
+
+    const uint8_t* mapped() const override
+    {
+        return mapping ? bytes.data() : nullptr;
+    }
+};
+
+#endif /* WATERINGSYSTEM_STORAGE_TESTING_RAMFLASHPARTITION_H */
@@ -0,0 +1,149 @@
+// SPDX-FileCopyrightText: 2026 Cryptotomte
+// SPDX-License-Identifier: AGPL-3.0-or-later
+/**
+ * @file BlockRingFile.cpp
+ * @brief Round-robin block file (see BlockRingFile.h).
+ */
+
+#include "storage/BlockRingFile.h"
+
+#include <unistd.h>
+
+#include <algorithm>
+#include <cstdio>
+#include <mutex>
+#include <utility>
+#include <vector>
+
+namespace {
+
+uint32_t u32At(const uint8_t* p)
+{
+    return static_cast<uint32_t>(p[0]) | static_cast<uint32_t>(p[1]) << 8 |
+           static_cast<uint32_t>(p[2]) << 16 | static_cast<uint32_t>(p[3]) << 24;
+}
+
+}  // namespace
+
+BlockRingFile::BlockRingFile(std::string path, std::size_t slots, std::size_t blockBytes)
+    : path_(std::move(path)), slots_(std::max<std::size_t>(slots, 1)), blockBytes_(blockBytes)
+{
+}
+
+bool BlockRingFile::open()
+{
+    std::lock_guard<StaticMutex> lock(mutex_);
+    open_ = false;
+    newest_ = 0;
+    mark_ = 0;
+    const long fileBytes = static_cast<long>(slots_ * slotBytes());
+
+    FILE* file = std::fopen(path_.c_str(), "rb");
+    bool fresh = file == nullptr;
+    if (file != nullptr) {
+        fresh = std::fseek(file, 0, SEEK_END) != 0 || std::ftell(file) != fileBytes;
+        for (std::size_t i = 0; !fresh && i < slots_; ++i) {
+            uint8_t header[kSlotHeaderBytes];
+            if (std::fseek(file, static_cast<long>(i * slotBytes()), SEEK_SET) != 0 ||
+                std::fread(header, 1, sizeof(header), file) != sizeof(header)) {
+                fresh = true;
+                break;
+            }
+            const uint32_t sequence = u32At(header);
+            // A slot only ever holds a sequence that maps to it.
+            if (sequence != 0 && sequence % slots_ == i) {
+                newest_ = std::max(newest_, sequence);
+            }
+        }
+        std::fclose(file);
+    }
+    if (fresh) {
+        newest_ = 0;
+        file = std::fopen(path_.c_str(), "wb");
+        if (file == nullptr) {
+            return false;
+        }
+        // Zeroed slots: sequence 0 is empty.
+        const std::vector<uint8_t> zeros(slotBytes(), 0);
+        bool ok = true;
+        for (std::size_t i = 0; ok && i < slots_; ++i) {
+            ok = std::fwrite(zeros.data(), 1, zeros.size(), file) == zeros.size();
+        }
+        ok = ok && std::fflush(file) == 0 && ::fsync(fileno(file)) == 0;
+        std::fclose(file);
+        if (!ok) {
+            return false;
+        }
+    }
+    open_ = true;
+    return true;
+}
+
+bool BlockRingFile::append(const uint8_t* data, std::size_t len, uint32_t mark)
+{
+    std::lock_guard<StaticMutex> lock(mutex_);
+    if (!open_ || len > blockBytes_ || len > UINT16_MAX) {
+        return false;
+    }
+    FILE* file = std::fopen(path_.c_str(), "r+b");
+    if (file == nullptr) {
+        return false;
+    }
+    const uint32_t sequence = newest_ + 1;
+    uint8_t header[kSlotHeaderBytes] = {
+        static_cast<uint8_t>(sequence),       static_cast<uint8_t>(sequence >> 8),
+        static_cast<uint8_t>(sequence >> 16), static_cast<uint8_t>(sequence >> 24),
+        static_cast<uint8_t>(len),            static_cast<uint8_t>(len >> 8),
+        0,                                    0,
+    };
+    const bool ok =
+        std::fseek(file, static_cast<long>((sequence % slots_) * slotBytes()), SEEK_SET) == 0 &&
+        std::fwrite(header, 1, sizeof(header), file) == sizeof(header) &&
+        std::fwrite(data, 1, len, file) == len && std::fflush(file) == 0 &&
+        ::fsync(fileno(file)) == 0;
+    std::fclose(file);
+    if (ok) {
+        newest_ = sequence;
+        mark_ = mark;
+    }
+    return ok;
+}
+
+uint32_t BlockRingFile::forEach(
+    const std::function<bool(const uint8_t* data, std::size_t len)>& fn) const
+{
+    std::lock_guard<StaticMutex> lock(mutex_);
+    if (!open_ || newest_ == 0) {
+        return mark_;
+    }
+    FILE* file = std::fopen(path_.c_str(), "rb");
+    if (file == nullptr) {
+        return mark_;
+    }
+    std::vector<uint8_t> slot(slotBytes());
+    const uint32_t first = newest_ >= slots_ ? newest_ - static_cast<uint32_t>(slots_) + 1 : 1;
+    for (uint32_t sequence = first; sequence <= newest_; ++sequence) {
+        if (std::fseek(file, static_cast<long>((sequence % slots_) * slotBytes()), SEEK_SET) !=
+                0 ||
+            std::fread(slot.data(), 1, slot.size(), file) != slot.size()) {
+            break;
+        }
+        const std::size_t len = static_cast<std::size_t>(slot[4]) |
+                                static_cast<std::size_t>(slot[5]) << 8;
+        // A slot not written yet (the file is younger than one lap).
+        if (u32At(slot.data()) != sequence || len > blockBytes_) {
+            continue;
+        }
+        if (!fn(slot.data() + kSlotHeaderBytes, len)) {
+            break;
+        }
+    }
+    std::fclose(file);
+    return mark_;
+}
+
+std::size_t BlockRingFile::count() const
+{
+    std::lock_guard<StaticMutex> lock(mutex_);
+    return std::min<std::size_t>(newest_, slots_);
+}
@@ -0,0 +1,143 @@
+// SPDX-FileCopyrightText: 2026 Cryptotomte
+// SPDX-License-Identifier: AGPL-3.0-or-later
+/**
+ * @file DeltaChunkCodec.cpp
+ * @brief Delta-of-delta / XOR history frame codec (pure C++, host-tested).
+ */
+
+#include "storage/DeltaChunkCodec.h"
+
+#include <cstring>
+
+namespace deltachunk {
+
+namespace {
+
+constexpr uint8_t kClassZero = 0;
+constexpr uint8_t kClassInt8 = 1;
+constexpr uint8_t kClassInt16 = 2;
+constexpr uint8_t kClassAbsolute = 3;
+
+constexpr std::size_t kEpochBytes[4] = {0, 1, 2, 4};
+
+void advance(State& state, uint32_t epoch, uint32_t bits)
+{
+    state.delta = state.started
+                      ? static_cast<int64_t>(epoch) - static_cast<int64_t>(state.epoch)
+                      : 0;
+    state.epoch = epoch;
+    state.valueBits = bits;
+    state.started = true;
+}
+
+}  // namespace
+
+std::size_t encode(uint8_t out[kMaxFrameBytes], State& state, uint32_t epoch,
+                   float value)
+{
+    uint32_t bits = 0;
+    std::memcpy(&bits, &value, sizeof(bits));
+
+    uint8_t epochClass = kClassAbsolute;
+    int64_t dod = 0;
+    if (state.started) {
+        const int64_t delta =
+            static_cast<int64_t>(epoch) - static_cast<int64_t>(state.epoch);
+        dod = delta - state.delta;
+        if (dod == 0) {
+            epochClass = kClassZero;
+        } else if (dod >= INT8_MIN && dod <= INT8_MAX) {
+            epochClass = kClassInt8;
+        } else if (dod >= INT16_MIN && dod <= INT16_MAX) {
+            epochClass = kClassInt16;
+        }
+    }
+
+    // XOR against the previous value (0 before the first frame): keep only
+    // the significant bytes between the zero high and zero low bytes.
+    const uint32_t xorBits = bits ^ (state.started ? state.valueBits : 0u);
+    std::size_t lowZero = 0;
+    std::size_t significant = 0;
+    if (xorBits != 0) {
+        while (((xorBits >> (8 * lowZero)) & 0xFF) == 0) {
+            ++lowZero;
+        }
+        std::size_t highZero = 0;
+        while (((xorBits >> (8 * (3 - highZero))) & 0xFF) == 0) {
+            ++highZero;
+        }
+        significant = 4 - lowZero - highZero;
+    }
+
+    std::size_t length = 0;
+    out[length++] = static_cast<uint8_t>((epochClass << 6) | (significant << 3) |
+                                         (lowZero << 1));
+    const uint32_t epochField = epochClass == kClassAbsolute
+                                    ? epoch
+                                    : static_cast<uint32_t>(dod);
+    for (std::size_t i = 0; i < kEpochBytes[epochClass]; ++i) {
+        out[length++] = static_cast<uint8_t>((epochField >> (8 * i)) & 0xFF);
+    }
+    for (std::size_t i = 0; i < significant; ++i) {
+        out[length++] = static_cast<uint8_t>((xorBits >> (8 * (lowZero + i))) & 0xFF);
+    }
+    advance(state, epoch, bits);
+    return length;
+}
+
+std::size_t decode(const uint8_t* in, std::size_t available, State& state,
+                   uint32_t& epoch, float& value)
+{
+    if (available == 0) {
+        return 0;
+    }
+    const uint8_t tag = in[0];
+    const uint8_t epochClass = static_cast<uint8_t>(tag >> 6);
+    const std::size_t significant = (tag >> 3) & 0x07;
+    const std::size_t lowZero = (tag >> 1) & 0x03;
+    // Reserved bit, an impossible byte split, or a relative epoch in a
+    // chunk's first frame: never written by encode().
+    if ((tag & 0x01) != 0 || significant + lowZero > 4 ||
+        (!state.started && epochClass != kClassAbsolute)) {
+        return 0;
+    }
+    const std::size_t epochBytes = kEpochBytes[epochClass];
+    const std::size_t length = 1 + epochBytes + significant;
+    if (available < length) {
+        return 0;  // torn: the frame is shorter than its tag declares
+    }
+
+    uint32_t epochField = 0;
+    for (std::size_t i = 0; i < epochBytes; ++i) {
+        epochField |= static_cast<uint32_t>(in[1 + i]) << (8 * i);
+    }
+    uint32_t decoded = epochField;
+    if (epochClass != kClassAbsolute) {
+        int64_t dod = 0;
+        if (epochClass == kClassInt8) {
+            dod = static_cast<int8_t>(epochField);
+        } else if (epochClass == kClassInt16) {
+            dod = static_cast<int16_t>(epochField);
+        }
+        decoded = static_cast<uint32_t>(static_cast<int64_t>(state.epoch) +
+                                        state.delta + dod);
+    }
+    uint32_t xorBits = 0;
+    for (std::size_t i = 0; i < significant; ++i) {
+        xorBits |= static_cast<uint32_t>(in[1 + epochBytes + i])
+                   << (8 * (lowZero + i));
+    }
+    const uint32_t bits = xorBits ^ (state.started ? state.valueBits : 0u);
+
+    epoch = decoded;
+    std::memcpy(&value, &bits, sizeof(value));
+    advance(state, decoded, bits);
+    return length;
+}
+
+bool validHeader(const uint8_t header[kHeaderBytes])
+{
+    return header[0] == kMagic && header[1] == kVersion;
+}
+
+}  // namespace deltachunk
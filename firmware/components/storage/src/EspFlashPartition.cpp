@@ -0,0 +1,57 @@
+// SPDX-FileCopyrightText: 2026 Cryptotomte
+// SPDX-License-Identifier: AGPL-3.0-or-later
+/**
+ * @file EspFlashPartition.cpp
+ * @brief Target-only IFlashPartition over esp_partition.
+ *
+ * See EspFlashPartition.h. Excluded from the linux preview target build
+ * (storage component CMakeLists).
+ */
+
+#include "storage/EspFlashPartition.h"
+
+EspFlashPartition::~EspFlashPartition()
+{
+    if (map_ != nullptr) {
+        esp_partition_munmap(mapHandle_);
+    }
+}
+
+esp_err_t EspFlashPartition::open(const char* label)
+{
+    partition_ = esp_partition_find_first(ESP_PARTITION_TYPE_DATA,
+                                          ESP_PARTITION_SUBTYPE_ANY, label);
+    if (partition_ == nullptr) {
+        return ESP_ERR_NOT_FOUND;
+    }
+    const void* map = nullptr;
+    if (esp_partition_mmap(partition_, 0, partition_->size, ESP_PARTITION_MMAP_DATA,
+                           &map, &mapHandle_) == ESP_OK) {
+        map_ = static_cast<const uint8_t*>(map);
+    }
+    return ESP_OK;
+}
+
+std::size_t EspFlashPartition::size() const
+{
+    return partition_ != nullptr ? partition_->size : 0;
+}
+
+bool EspFlashPartition::read(std::size_t offset, void* dst, std::size_t len) const
+{
+    return partition_ != nullptr &&
+           esp_partition_read(partition_, offset, dst, len) == ESP_OK;
+}
+
+bool EspFlashPartition::write(std::size_t offset, const void* src, std::size_t len)
+{
+    return partition_ != nullptr &&
+           esp_partition_write(partition_, offset, src, len) == ESP_OK;
+}
+
+bool EspFlashPartition::eraseSector(std::size_t sector)
+{
+    return partition_ != nullptr &&
+           esp_partition_erase_range(partition_, sector * kSectorBytes,
+                                     kSectorBytes) == ESP_OK;
+}
@@ -0,0 +1,122 @@
+// SPDX-FileCopyrightText: 2026 Cryptotomte
+// SPDX-License-Identifier: AGPL-3.0-or-later
+/**
+ * @file HistoryRollup.cpp
+ * @brief Rollup tier bucketing and record codecs (pure C++, host-tested).
+ */
+
+#include "storage/HistoryRollup.h"
+
+#include <cstring>
+
+namespace rollup {
+
+namespace {
+
+void putU32Le(uint8_t* out, uint32_t value)
+{
+    for (int i = 0; i < 4; ++i) {
+        out[i] = static_cast<uint8_t>((value >> (8 * i)) & 0xFF);
+    }
+}
+
+uint32_t getU32Le(const uint8_t* in)
+{
+    return static_cast<uint32_t>(in[0]) | (static_cast<uint32_t>(in[1]) << 8) |
+           (static_cast<uint32_t>(in[2]) << 16) |
+           (static_cast<uint32_t>(in[3]) << 24);
+}
+
+void putFloatLe(uint8_t* out, float value)
+{
+    uint32_t bits = 0;
+    std::memcpy(&bits, &value, sizeof(bits));
+    putU32Le(out, bits);
+}
+
+float getFloatLe(const uint8_t* in)
+{
+    const uint32_t bits = getU32Le(in);
+    float value = 0.0f;
+    std::memcpy(&value, &bits, sizeof(value));
+    return value;
+}
+
+}  // namespace
+
+int tierIndex(uint32_t bucketS)
+{
+    for (std::size_t i = 0; i < kTierCount; ++i) {
+        if (kTiers[i].bucketS == bucketS) {
+            return static_cast<int>(i);
+        }
+    }
+    return -1;
+}
+
+void fold(std::vector<SensorAggregate>& buckets, uint32_t bucketS,
+          uint32_t epoch, float value)
+{
+    const uint32_t start = epoch - epoch % bucketS;
+    if (buckets.empty() || buckets.back().epoch != start) {
+        buckets.push_back(SensorAggregate{start, 0, value, value, 0.0f});
+    }
+    SensorAggregate& bucket = buckets.back();
+    ++bucket.count;
+    bucket.min = value < bucket.min ? value : bucket.min;
+    bucket.max = value > bucket.max ? value : bucket.max;
+    bucket.sum += value;
+}
+
+void merge(std::vector<SensorAggregate>& buckets, const SensorAggregate& part)
+{
+    if (buckets.empty() || buckets.back().epoch != part.epoch) {
+        buckets.push_back(SensorAggregate{part.epoch, 0, part.min, part.max, 0.0f});
+    }
+    SensorAggregate& bucket = buckets.back();
+    bucket.count += part.count;
+    bucket.min = part.min < bucket.min ? part.min : bucket.min;
+    bucket.max = part.max > bucket.max ? part.max : bucket.max;
+    bucket.sum += part.sum;
+}
+
+void encode(uint8_t out[kRecordBytes], const SensorAggregate& bucket)
+{
+    putU32Le(out, bucket.epoch);
+    putU32Le(out + 4, bucket.count);
+    putFloatLe(out + 8, bucket.min);
+    putFloatLe(out + 12, bucket.max);
+    putFloatLe(out + 16, bucket.sum);
+}
+
+SensorAggregate decode(const uint8_t in[kRecordBytes])
+{
+    return SensorAggregate{getU32Le(in), getU32Le(in + 4), getFloatLe(in + 8),
+                           getFloatLe(in + 12), getFloatLe(in + 16)};
+}
+
+int sketchTierFor(std::size_t tier)
+{
+    for (std::size_t i = 0; i < kSketchTierCount; ++i) {
+        if (kSketchTiers[i].tier == tier) {
+            return static_cast<int>(i);
+        }
+    }
+    return -1;
+}
+
+void encodeSketch(uint8_t out[kSketchRecordBytes], uint32_t bucketStart,
+                  const QuantileSketch& sketch)
+{
+    putU32Le(out, bucketStart);
+    sketch.encode(out + 4);
+}
+
+bool decodeSketch(const uint8_t in[kSketchRecordBytes], uint32_t& bucketStart,
+                  QuantileSketch& sketch)
+{
+    bucketStart = getU32Le(in);
+    return sketch.decode(in + 4);
+}
+
+}  // namespace rollup
@@ -0,0 +1,174 @@
+// SPDX-FileCopyrightText: 2026 Cryptotomte
+// SPDX-License-Identifier: AGPL-3.0-or-later
+/**
+ * @file LegacyHistoryImport.cpp
+ * @brief Streaming import of the legacy JSON history files (pure C++ /
+ *        POSIX, host-tested; see LegacyHistoryImport.h).
+ */
+
+#include "storage/LegacyHistoryImport.h"
+
+#include <dirent.h>
+
+#include <algorithm>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <vector>
+
+#include "interfaces/MetricRegistry.h"
+
+namespace legacy {
+
+namespace {
+
+constexpr std::size_t kReadBlockBytes = 512;
+/// Longest object text kept: {"timestamp":4294967295,"value":-3.40282347e+38}
+/// with room for blanks; a longer one is not a legacy record.
+constexpr std::size_t kObjectMaxBytes = 96;
+
+bool endsWith(const std::string& text, const char* suffix)
+{
+    const std::size_t length = std::strlen(suffix);
+    return text.size() > length && text.compare(text.size() - length, length, suffix) == 0;
+}
+
+/// The number after `key` (quoted) and its colon in an object's text;
+/// false when the key is missing or its value is not a number (null).
+bool findNumber(const char* object, const char* key, double& out)
+{
+    const char* at = std::strstr(object, key);
+    if (at == nullptr) {
+        return false;
+    }
+    at += std::strlen(key);
+    while (*at == ' ' || *at == '\t' || *at == '\r' || *at == '\n' || *at == ':') {
+        ++at;
+    }
+    char* end = nullptr;
+    out = std::strtod(at, &end);
+    return end != at;
+}
+
+/// One legacy record from the text between its braces.
+bool parsePoint(const char* object, HistoryPoint& out)
+{
+    double epoch = 0.0;
+    double value = 0.0;
+    if (!findNumber(object, "\"timestamp\"", epoch) || !findNumber(object, "\"value\"", value) ||
+        epoch < kMinEpoch || epoch > UINT32_MAX) {
+        return false;
+    }
+    out.epoch = static_cast<uint32_t>(epoch);
+    out.value = static_cast<float>(value);
+    return true;
+}
+
+/// Hand the leading chunk of @p batch to the storage — all of it, chunk
+/// by chunk, when @p all (the end of the file) — and drop what it took.
+bool drain(const std::string& metric, std::vector<HistoryPoint>& batch, bool all,
+           LittleFsDataStorage& storage, ImportStats& stats)
+{
+    std::size_t done = 0;
+    while (done < batch.size() && (all || done == 0)) {
+        const HistoryImport result =
+            storage.importHistory(metric, batch.data() + done, batch.size() - done);
+        if (!result.ok || result.consumed == 0) {
+            return false;
+        }
+        stats.points += result.written;
+        stats.skipped += result.skipped;
+        stats.chunks += result.written != 0 ? 1 : 0;
+        stats.resumed += result.existed ? 1 : 0;
+        done += result.consumed;
+    }
+    batch.erase(batch.begin(), batch.begin() + static_cast<std::ptrdiff_t>(done));
+    return true;
+}
+
+/// Stream one legacy array into @p metric's ring.
+bool importFile(const std::string& path, const std::string& metric,
+                LittleFsDataStorage& storage, ImportStats& stats)
+{
+    FILE* file = std::fopen(path.c_str(), "rb");
+    if (file == nullptr) {
+        return false;
+    }
+    std::vector<HistoryPoint> batch;
+    batch.reserve(kBatchPoints);
+    char object[kObjectMaxBytes + 1];
+    std::size_t objectLen = 0;
+    bool inObject = false;
+    bool overlong = false;
+    char block[kReadBlockBytes];
+    bool ok = true;
+    std::size_t got = 0;
+    while (ok && (got = std::fread(block, 1, sizeof(block), file)) > 0) {
+        for (std::size_t i = 0; i < got && ok; ++i) {
+            const char c = block[i];
+            if (!inObject) {
+                inObject = c == '{';
+                objectLen = 0;
+                overlong = false;
+                continue;
+            }
+            if (c != '}') {
+                if (objectLen < kObjectMaxBytes) {
+                    object[objectLen++] = c;
+                } else {
+                    overlong = true;
+                }
+                continue;
+            }
+            inObject = false;
+            object[objectLen] = '\0';
+            HistoryPoint point;
+            if (overlong || !parsePoint(object, point)) {
+                ++stats.skipped;
+                continue;
+            }
+            batch.push_back(point);
+            if (batch.size() == kBatchPoints) {
+                ok = drain(metric, batch, false, storage, stats);
+            }
+        }
+    }
+    ok = ok && std::ferror(file) == 0;
+    std::fclose(file);
+    return ok && drain(metric, batch, true, storage, stats);
+}
+
+}  // namespace
+
+ImportStats importHistory(const std::string& legacyDir, LittleFsDataStorage& storage)
+{
+    ImportStats stats;
+    std::vector<std::string> names;
+    if (DIR* dir = ::opendir(legacyDir.c_str())) {
+        while (const dirent* entry = ::readdir(dir)) {
+            const std::string name = entry->d_name;
+            if (endsWith(name, ".json")) {
+                names.push_back(name);
+            }
+        }
+        ::closedir(dir);
+    }
+    std::sort(names.begin(), names.end());  // same order on every run
+    for (const std::string& name : names) {
+        const std::string metric = name.substr(0, name.size() - 5);
+        if (metric::findKnown(metric) == metric::kInvalid) {
+            ++stats.ignored;
+            continue;
+        }
+        const std::string path = legacyDir + "/" + name;
+        if (importFile(path, metric, storage, stats) &&
+            std::rename(path.c_str(), (path + kDoneSuffix).c_str()) == 0) {
+            ++stats.files;
+        } else {
+            ++stats.failed;
+        }
+    }
+    return stats;
+}
+
+}  // namespace legacy
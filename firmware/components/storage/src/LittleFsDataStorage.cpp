@@ -21,9 +21,14 @@
 
 #include <algorithm>
 #include <cerrno>
+#include <climits>
 #include <cstdio>
 #include <cstdlib>
 #include <cstring>
+#include <string_view>
+#include <utility>
+
+#include "storage/RecordReduce.h"
 
 namespace {
 
@@ -31,6 +36,8 @@ namespace {
 struct ChunkRef {
     uint32_t firstEpoch = 0;
     std::string name;
+    bool unordered = false;  ///< "<epoch>.u.*": holds a backwards epoch
+    bool delta = false;      ///< "<epoch>[.u].dz": DeltaChunkCodec frames
 };
 
 /// Metric names become directory names; empty, '/' or ".." are unsafe
@@ -63,11 +70,26 @@ long fileSize(const std::string& path)
     return static_cast<long>(st.st_size);
 }
 
-/// Parse "<decimal uint32>.dat"; anything else is not a chunk file.
-bool parseChunkName(const char* name, uint32_t& firstEpochOut)
+/// Chunk file name: "<decimal uint32 first epoch>", then ".u" when the
+/// chunk received a record older than its predecessor, then ".dat" (fixed
+/// 8-byte records) or ".dz" (delta codec).
+std::string chunkName(uint32_t firstEpoch, bool delta, bool unordered)
+{
+    return std::to_string(firstEpoch) + (unordered ? ".u" : "") +
+           (delta ? ".dz" : ".dat");
+}
+
+/// Parse a chunk file name (see chunkName); anything else is not a chunk.
+bool parseChunkName(const char* name, ChunkRef& out)
 {
     const char* dot = std::strchr(name, '.');
-    if (dot == nullptr || dot == name || std::strcmp(dot, ".dat") != 0) {
+    if (dot == nullptr || dot == name) {
+        return false;
+    }
+    const bool unordered = std::strncmp(dot, ".u.", 3) == 0;
+    const char* codec = unordered ? dot + 2 : dot;
+    const bool delta = std::strcmp(codec, ".dz") == 0;
+    if (!delta && std::strcmp(codec, ".dat") != 0) {
         return false;
     }
     unsigned long long value = 0;
@@ -80,20 +102,28 @@ bool parseChunkName(const char* name, uint32_t& firstEpochOut)
             return false;
         }
     }
-    firstEpochOut = static_cast<uint32_t>(value);
+    out = ChunkRef{static_cast<uint32_t>(value), name, unordered, delta};
     return true;
 }
 
+bool isDeltaChunk(const std::string& name)
+{
+    return name.size() > 3 && name.compare(name.size() - 3, 3, ".dz") == 0;
+}
+
 /// Chunk files of one metric directory, sorted ascending by filename
-/// epoch (oldest first). Empty when the directory does not exist.
-std::vector<ChunkRef> listChunks(const std::string& dir)
+/// epoch (oldest first). Empty when the directory does not exist. Of a
+/// .dat and a .dz sharing a first epoch — a recompaction cut short after
+/// its rename — only the .dz is listed; the .dat goes to `shadowed`.
+std::vector<ChunkRef> listChunks(const std::string& dir,
+                                 std::vector<ChunkRef>* shadowed = nullptr)
 {
     std::vector<ChunkRef> chunks;
     if (DIR* d = ::opendir(dir.c_str())) {
         while (const dirent* entry = ::readdir(d)) {
-            uint32_t firstEpoch = 0;
-            if (parseChunkName(entry->d_name, firstEpoch)) {
-                chunks.push_back(ChunkRef{firstEpoch, entry->d_name});
+            ChunkRef chunk;
+            if (parseChunkName(entry->d_name, chunk)) {
+                chunks.push_back(std::move(chunk));
             }
         }
         ::closedir(d);
@@ -102,6 +132,23 @@ std::vector<ChunkRef> listChunks(const std::string& dir)
               [](const ChunkRef& a, const ChunkRef& b) {
                   return a.firstEpoch < b.firstEpoch;
               });
+    std::size_t kept = 0;
+    for (std::size_t i = 0; i < chunks.size(); ++i) {
+        if (kept != 0 && chunks[kept - 1].firstEpoch == chunks[i].firstEpoch) {
+            if (chunks[i].delta && !chunks[kept - 1].delta) {
+                std::swap(chunks[kept - 1], chunks[i]);
+            }
+            if (shadowed != nullptr) {
+                shadowed->push_back(std::move(chunks[i]));
+            }
+            continue;
+        }
+        if (kept != i) {
+            chunks[kept] = std::move(chunks[i]);
+        }
+        ++kept;
+    }
+    chunks.resize(kept);
     return chunks;
 }
 
@@ -154,310 +201,3781 @@ float decodeFloatLe(const uint8_t* bytes)
     return value;
 }
 
-// Event-log codec: 0xE7-framed records {marker, uint32 LE epoch,
-// uint8 category, uint8 detail_len, detail bytes} (data-model.md).
+constexpr long kRecordBytes =
+    static_cast<long>(LittleFsDataStorage::kHistoryRecordBytes);
 
-/// Valid framed prefix of one event file: records in append order plus
-/// the byte length of the parseable prefix. A torn tail — bad marker or
-/// a frame shorter than its declared length, i.e. a power loss
-/// mid-append — ends the prefix; everything before it stays usable
-/// (contract invariant 2). An absent file is an empty log.
-struct ParsedEventFile {
-    std::vector<EventRecord> records;
-    long validBytes = 0;
-};
+/// Raw chunks are read in blocks of this many bytes (128 records, an
+/// eighth of a chunk) rather than one 8-byte fread per record: each fread
+/// is a trip through stdio and the VFS into littlefs.
+constexpr std::size_t kReadBlockBytes = 1024;
+static_assert(kReadBlockBytes % LittleFsDataStorage::kHistoryRecordBytes == 0,
+              "a block holds whole records");
+
+/// Visit @p count packed records at @p bytes (`visit(epoch, value)` returns
+/// false to stop); false when the visitor stopped.
+template <typename Visit>
+bool decodeRecords(const uint8_t* bytes, std::size_t count, Visit&& visit)
+{
+    for (std::size_t i = 0; i < count; ++i, bytes += kRecordBytes) {
+#if defined(__BYTE_ORDER__) && __BYTE_ORDER__ == __ORDER_LITTLE_ENDIAN__
+        // The file layout is the in-memory one: two plain loads.
+        uint32_t epoch = 0;
+        float value = 0.0f;
+        std::memcpy(&epoch, bytes, sizeof(epoch));
+        std::memcpy(&value, bytes + 4, sizeof(value));
+#else
+        const uint32_t epoch = decodeU32Le(bytes);
+        const float value = decodeFloatLe(bytes + 4);
+#endif
+        if (!visit(epoch, value)) {
+            return false;
+        }
+    }
+    return true;
+}
+
+/// Visit the whole records of a raw chunk from @p offset (a record
+/// boundary, where @p file is positioned) to its end, reading block-sized
+/// pieces into @p scratch; the first read stops at a block boundary so the
+/// rest are aligned. A torn tail is a short final read and is not visited.
+/// @return bytes of whole records read (those visited, unless the visitor
+///         stopped early)
+template <typename Visit>
+long readRecordBlocks(FILE* file, long offset, std::vector<uint8_t>& scratch,
+                      Visit&& visit)
+{
+    scratch.resize(kReadBlockBytes);
+    std::size_t want = kReadBlockBytes - static_cast<std::size_t>(offset) % kReadBlockBytes;
+    long whole = 0;
+    for (;;) {
+        const std::size_t got = std::fread(scratch.data(), 1, want, file);
+        const std::size_t records = got / kRecordBytes;
+        whole += static_cast<long>(records) * kRecordBytes;
+        if (!decodeRecords(scratch.data(), records, visit) || got < want) {
+            return whole;
+        }
+        want = kReadBlockBytes;
+    }
+}
+
+/// Open a raw chunk for block reads: unbuffered, so a block goes straight
+/// from the VFS into the caller's buffer instead of through stdio's.
+FILE* openRecordFile(const std::string& path)
+{
+    FILE* file = std::fopen(path.c_str(), "rb");
+    if (file != nullptr) {
+        std::setvbuf(file, nullptr, _IONBF, 0);
+    }
+    return file;
+}
 
-ParsedEventFile parseEventFile(const std::string& path)
+/// Returned by scanDeltaChunk() for a chunk this codec version must not
+/// read, extend or repair (another magic or a newer version).
+constexpr long kForeignChunk = -1;
+
+/// Decode the valid prefix of one delta-codec chunk, visiting each sample
+/// (`visit(epoch, value)` returns false to stop early), and return that
+/// prefix's byte length: 0 for an absent file or a torn header,
+/// kForeignChunk for an unreadable header. A frame shorter than its tag
+/// declares is a torn tail and ends the prefix. `state` is left after the
+/// last decoded frame, i.e. what the next append continues from.
+///
+/// `resumeAt` > 0 continues an earlier scan instead: decoding starts at
+/// that byte offset (the prefix length it returned) from the `state` it
+/// left, and the header is not re-read.
+template <typename Visit>
+long scanDeltaChunk(const std::string& path, deltachunk::State& state,
+                    Visit&& visit, long resumeAt = 0)
 {
-    ParsedEventFile parsed;
+    if (resumeAt <= 0) {
+        state = deltachunk::State{};
+    }
     FILE* file = std::fopen(path.c_str(), "rb");
     if (file == nullptr) {
-        return parsed;
+        return 0;
+    }
+    if (resumeAt > 0 && std::fseek(file, resumeAt, SEEK_SET) != 0) {
+        std::fclose(file);
+        return resumeAt;
+    }
+    uint8_t buffer[256];
+    std::size_t have = std::fread(buffer, 1, sizeof(buffer), file);
+    bool eof = have < sizeof(buffer);
+    long validBytes = resumeAt;
+    std::size_t pos = 0;
+    if (resumeAt <= 0) {
+        if (have < deltachunk::kHeaderBytes) {
+            std::fclose(file);
+            return 0;
+        }
+        if (!deltachunk::validHeader(buffer)) {
+            std::fclose(file);
+            return kForeignChunk;
+        }
+        validBytes = static_cast<long>(deltachunk::kHeaderBytes);
+        pos = deltachunk::kHeaderBytes;
     }
-    uint8_t header[LittleFsDataStorage::kEventHeaderBytes];
-    char detail[UINT8_MAX];  // detail_len is one byte
     for (;;) {
-        if (std::fread(header, 1, sizeof(header), file) != sizeof(header) ||
-            header[0] != LittleFsDataStorage::kEventMarker) {
-            break;  // torn/absent frame header: end of the valid prefix
+        // Keep at least one whole frame buffered unless the file ends.
+        if (!eof && have - pos < deltachunk::kMaxFrameBytes) {
+            std::memmove(buffer, buffer + pos, have - pos);
+            have -= pos;
+            pos = 0;
+            const std::size_t want = sizeof(buffer) - have;
+            const std::size_t got = std::fread(buffer + have, 1, want, file);
+            have += got;
+            eof = got < want;
         }
-        const std::size_t detailLen = header[6];
-        if (std::fread(detail, 1, detailLen, file) != detailLen) {
-            break;  // declared length exceeds the file: torn detail
+        uint32_t epoch = 0;
+        float value = 0.0f;
+        const std::size_t used =
+            deltachunk::decode(buffer + pos, have - pos, state, epoch, value);
+        if (used == 0) {
+            break;  // end of file, or a torn/invalid frame
+        }
+        pos += used;
+        validBytes += static_cast<long>(used);
+        if (!visit(epoch, value)) {
+            break;
         }
-        parsed.records.push_back(EventRecord{
-            decodeU32Le(header + 1), header[5], std::string(detail, detailLen)});
-        parsed.validBytes += static_cast<long>(sizeof(header) + detailLen);
     }
     std::fclose(file);
-    return parsed;
+    return validBytes;
 }
 
-/// Create-or-empty a file: rotation truncates the standby event file
-/// before switching appends to it (::truncate cannot create).
-bool truncateToEmpty(const std::string& path)
+/// Index of the first record with epoch >= t0 in an ascending chunk
+/// (binary search over the fixed-size records; a torn tail is ignored).
+/// 0 on a seek/read error, which only costs a longer scan.
+long lowerBoundRecord(FILE* file, uint32_t t0)
 {
-    FILE* file = std::fopen(path.c_str(), "wb");
-    if (file == nullptr) {
-        return false;
+    if (std::fseek(file, 0, SEEK_END) != 0) {
+        return 0;
     }
-    return std::fclose(file) == 0;
+    const long size = std::ftell(file);
+    long lo = 0;
+    long hi = size < 0 ? 0 : size / kRecordBytes;
+    uint8_t bytes[4];
+    while (lo < hi) {
+        const long mid = lo + (hi - lo) / 2;
+        if (std::fseek(file, mid * kRecordBytes, SEEK_SET) != 0 ||
+            std::fread(bytes, 1, sizeof(bytes), file) != sizeof(bytes)) {
+            return 0;
+        }
+        if (decodeU32Le(bytes) < t0) {
+            lo = mid + 1;
+        } else {
+            hi = mid;
+        }
+    }
+    return lo;
 }
 
-}  // namespace
+// History record codecs as compile-time policies. Every loop that touches
+// records (an append's encode, window/newest/cache scans, the torn-tail
+// repair, chunk summaries) is a template over one, entered through
+// withCodec() once per chunk, so the per-record work carries no codec
+// branch and inlines its codec. A chunk's codec is its file's (chunkName:
+// ".dat" or ".dz"); new chunks get LittleFsDataStorageOptions::historyCodec.
+//
+// A policy provides:
+//   kMaxRecordBytes                the largest record, for the seal check
+//   header(out)                    append a new chunk's header to out
+//   encode(out, state, epoch, v)   one record; state is the chain it extends
+//   wholeBytes(size)               bytes a size-only check takes as whole
+//   validPrefix(path, size, tail)  committed bytes (tail: what the next
+//                                  append continues); kForeignChunk
+//   scan(path, tail, scratch, visit, resumeAt)
+//                                  records from byte resumeAt; the bytes
+//                                  whole after it, or kForeignChunk
+//   scanWindow(path, scratch, seek, t0, visit)
+//                                  a query's records (from the first at or
+//                                  after t0 when seek; the visitor filters)
+//   scanNewest(path, scratch, want, visit)
+//                                  at least the last `want` records
+//   reduce(bytes, size, reduction) fold an in-memory chunk; valid bytes
+//   lastEpoch(path, epoch)         the last whole record's epoch
 
-LittleFsDataStorage::LittleFsDataStorage(std::string basePath,
-                                         StatsProvider statsProvider)
-    : basePath_(std::move(basePath)), statsProvider_(std::move(statsProvider))
-{
-}
+/// Fixed 8-byte records (".dat"): seekable, a torn tail is any remainder.
+struct FixedRecordCodec {
+    static constexpr std::size_t kMaxRecordBytes = LittleFsDataStorage::kHistoryRecordBytes;
 
-bool LittleFsDataStorage::storeSensorReading(const std::string& metric,
-                                             uint32_t epoch, float value)
-{
-    if (!isValidMetricName(metric)) {
-        return false;
+    static void header(std::vector<uint8_t>&) {}
+
+    static std::size_t encode(uint8_t* out, deltachunk::State&, uint32_t epoch, float value)
+    {
+        encodeRecord(out, epoch, value);
+        return kMaxRecordBytes;
     }
-    const std::string hist = histDir();
-    const std::string dir = metricDir(metric);
-    if (!isDir(dir)) {
-        if (!ensureDir(basePath_) || !ensureDir(hist)) {
-            return false;
+
+    static long wholeBytes(long size) { return size - size % kRecordBytes; }
+
+    static long validPrefix(const std::string&, long size, deltachunk::State&)
+    {
+        return wholeBytes(size);
+    }
+
+    /// An unreadable file is kForeignChunk: nothing to cache.
+    template <typename Visit>
+    static long scan(const std::string& path, deltachunk::State&, std::vector<uint8_t>& scratch,
+                     Visit&& visit, long resumeAt)
+    {
+        FILE* file = openRecordFile(path);
+        if (file == nullptr) {
+            return kForeignChunk;
         }
-        if (countSubdirs(hist) >= kMaxMetrics) {
-            return false;  // budget guard: 11th distinct metric rejected
+        long valid = kForeignChunk;
+        if (std::fseek(file, resumeAt, SEEK_SET) == 0) {
+            // A torn tail is left for the next scan.
+            valid = resumeAt + readRecordBlocks(file, resumeAt, scratch, visit);
         }
-        if (!ensureDir(dir)) {
-            return false;
+        std::fclose(file);
+        return valid;
+    }
+
+    template <typename Visit>
+    static void scanWindow(const std::string& path, std::vector<uint8_t>& scratch, bool seek,
+                           uint32_t t0, Visit&& visit)
+    {
+        FILE* file = openRecordFile(path);
+        if (file == nullptr) {
+            return;  // unreadable chunk: skip, never fail the query
+        }
+        const long start = seek ? lowerBoundRecord(file, t0) * kRecordBytes : 0;
+        if (std::fseek(file, start, SEEK_SET) == 0) {
+            // A torn tail is logically truncated here.
+            readRecordBlocks(file, start, scratch, visit);
         }
+        std::fclose(file);
     }
 
-    // Derive the active chunk from the files (stateless across restarts).
-    std::vector<ChunkRef> chunks = listChunks(dir);
-    std::string activePath;
-    if (!chunks.empty()) {
-        activePath = dir + "/" + chunks.back().name;
-        long size = fileSize(activePath);
-        if (size < 0) {
+    /// Only the last `want` records are read.
+    template <typename Visit>
+    static void scanNewest(const std::string& path, std::vector<uint8_t>& scratch,
+                           std::size_t want, Visit&& visit)
+    {
+        const long whole = fileSize(path) / kRecordBytes;
+        const long start = whole > static_cast<long>(want) ? whole - static_cast<long>(want) : 0;
+        FILE* file = openRecordFile(path);
+        if (file == nullptr) {
+            return;  // unreadable chunk: skip, as a window read does
+        }
+        if (std::fseek(file, start * kRecordBytes, SEEK_SET) == 0) {
+            readRecordBlocks(file, start * kRecordBytes, scratch, visit);
+        }
+        std::fclose(file);
+    }
+
+    static std::size_t reduce(const uint8_t* bytes, std::size_t size,
+                              recordreduce::Reduction& reduction)
+    {
+        const std::size_t valid = size - size % kRecordBytes;
+        recordreduce::reduce(bytes, valid / kRecordBytes, reduction);
+        return valid;
+    }
+
+    static bool lastEpoch(const std::string& path, uint32_t& epochOut)
+    {
+        const long whole = wholeBytes(fileSize(path));
+        if (whole <= 0) {
             return false;
         }
-        const long torn = size % static_cast<long>(kHistoryRecordBytes);
-        if (torn != 0) {
-            // Repair a torn tail (power loss mid-append) so committed
-            // records stay 8-byte aligned and parseable.
-            if (::truncate(activePath.c_str(), size - torn) != 0) {
-                return false;
-            }
-            size -= torn;
+        FILE* file = std::fopen(path.c_str(), "rb");
+        if (file == nullptr) {
+            return false;
         }
-        if (static_cast<std::size_t>(size) >= kHistoryChunkMaxBytes) {
-            activePath.clear();  // sealed at 8 KiB — start a successor
+        uint8_t bytes[4];
+        const bool ok =
+            std::fseek(file, whole - kRecordBytes, SEEK_SET) == 0 &&
+            std::fread(bytes, 1, sizeof(bytes), file) == sizeof(bytes);
+        std::fclose(file);
+        if (ok) {
+            epochOut = decodeU32Le(bytes);
         }
+        return ok;
     }
-    if (activePath.empty()) {
-        if (chunks.size() >= kHistoryMaxChunksPerMetric) {
-            // Ring bound: creating chunk #11 deletes the oldest.
-            if (std::remove((dir + "/" + chunks.front().name).c_str()) != 0) {
-                return false;
-            }
-            chunks.erase(chunks.begin());
+};
+
+/// DeltaChunkCodec frames (".dz"): variable length, so every read decodes
+/// from the chunk start and only decoding finds a torn tail.
+struct DeltaRecordCodec {
+    static constexpr std::size_t kMaxRecordBytes = deltachunk::kMaxFrameBytes;
+
+    static void header(std::vector<uint8_t>& out)
+    {
+        out.push_back(deltachunk::kMagic);
+        out.push_back(deltachunk::kVersion);
+    }
+
+    static std::size_t encode(uint8_t* out, deltachunk::State& state, uint32_t epoch,
+                              float value)
+    {
+        return deltachunk::encode(out, state, epoch, value);
+    }
+
+    static long wholeBytes(long size) { return size; }
+
+    static long validPrefix(const std::string& path, long, deltachunk::State& tail)
+    {
+        return scanDeltaChunk(path, tail, [](uint32_t, float) { return true; });
+    }
+
+    template <typename Visit>
+    static long scan(const std::string& path, deltachunk::State& tail, std::vector<uint8_t>&,
+                     Visit&& visit, long resumeAt)
+    {
+        return scanDeltaChunk(path, tail, visit, resumeAt);
+    }
+
+    template <typename Visit>
+    static void scanWindow(const std::string& path, std::vector<uint8_t>&, bool, uint32_t,
+                           Visit&& visit)
+    {
+        deltachunk::State state;
+        scanDeltaChunk(path, state, visit);
+    }
+
+    template <typename Visit>
+    static void scanNewest(const std::string& path, std::vector<uint8_t>&, std::size_t,
+                           Visit&& visit)
+    {
+        deltachunk::State state;
+        scanDeltaChunk(path, state, visit);
+    }
+
+    /// 0 for a foreign or torn header.
+    static std::size_t reduce(const uint8_t* bytes, std::size_t size,
+                              recordreduce::Reduction& reduction)
+    {
+        if (size < deltachunk::kHeaderBytes || !deltachunk::validHeader(bytes)) {
+            return 0;
         }
-        // Filename = first record's epoch. A non-monotonic epoch that
-        // does not sort after the sealed chunk is bumped past it: chunk
-        // names must stay strictly increasing for ordering/eviction
-        // (time correctness is the caller's concern, parity 184).
-        uint32_t chunkEpoch = epoch;
-        if (!chunks.empty() && chunkEpoch <= chunks.back().firstEpoch) {
-            chunkEpoch = chunks.back().firstEpoch + 1;
+        deltachunk::State state;
+        std::size_t valid = deltachunk::kHeaderBytes;
+        for (;;) {
+            uint32_t epoch = 0;
+            float value = 0.0f;
+            const std::size_t used =
+                deltachunk::decode(bytes + valid, size - valid, state, epoch, value);
+            if (used == 0) {
+                return valid;
+            }
+            valid += used;
+            reduction.add(epoch, value);
         }
-        activePath = dir + "/" + std::to_string(chunkEpoch) + ".dat";
     }
 
-    FILE* file = std::fopen(activePath.c_str(), "ab");
-    if (file == nullptr) {
-        return false;
+    static bool lastEpoch(const std::string& path, uint32_t& epochOut)
+    {
+        deltachunk::State state;
+        scanDeltaChunk(path, state, [](uint32_t, float) { return true; });
+        epochOut = state.epoch;
+        return state.started;
     }
-    uint8_t record[kHistoryRecordBytes];
-    encodeRecord(record, epoch, value);
-    // Durable once true is returned: flush stdio, then sync to flash.
-    bool ok = std::fwrite(record, 1, sizeof(record), file) == sizeof(record) &&
-              std::fflush(file) == 0 && ::fsync(fileno(file)) == 0;
-    ok = (std::fclose(file) == 0) && ok;
-    return ok;
+};
+
+/// `f(codec)` with the policy of a chunk of the given codec: the one codec
+/// branch of a chunk-wide operation.
+template <typename F>
+auto withCodec(bool delta, F&& f)
+{
+    return delta ? f(DeltaRecordCodec{}) : f(FixedRecordCodec{});
 }
 
-std::vector<SensorReading> LittleFsDataStorage::getSensorReadings(
-    const std::string& metric, uint32_t t0, uint32_t t1) const
+/// Epoch of the last whole record of a history chunk (either codec);
+/// false when the file is absent or holds no whole record.
+bool lastRecordEpoch(const std::string& path, uint32_t& epochOut)
 {
-    std::vector<SensorReading> result;
-    if (t0 > t1 || !isValidMetricName(metric)) {
-        return result;  // contract: empty, never an error
+    return withCodec(isDeltaChunk(path), [&](auto codec) {
+        return decltype(codec)::lastEpoch(path, epochOut);
+    });
+}
+
+/// Encode @p records into @p out, after the chunk header when @p size (the
+/// chunk's committed bytes) is 0, while the chunk stays within
+/// kHistoryChunkMaxBytes; @p tail advances past the last one encoded.
+/// @return records encoded
+template <typename Codec, typename Record>
+std::size_t encodeRecords(Codec, const Record* records, std::size_t count, long size,
+                          std::vector<uint8_t>& out, deltachunk::State& tail)
+{
+    out.clear();
+    if (size == 0) {
+        Codec::header(out);
     }
-    const std::string dir = metricDir(metric);
-    // At most 10 chunks (80 KiB) per metric: scanning every chunk and
-    // filtering per record is cheap and stays correct for any input.
-    for (const ChunkRef& chunk : listChunks(dir)) {
-        FILE* file = std::fopen((dir + "/" + chunk.name).c_str(), "rb");
-        if (file == nullptr) {
-            continue;  // unreadable chunk: skip, never fail the query
+    const std::size_t room = LittleFsDataStorage::kHistoryChunkMaxBytes -
+                             static_cast<std::size_t>(size);
+    std::size_t n = 0;
+    for (; n < count; ++n) {
+        uint8_t bytes[Codec::kMaxRecordBytes];
+        deltachunk::State next = tail;
+        const std::size_t length = Codec::encode(bytes, next, records[n].epoch, records[n].value);
+        if (out.size() + length > room) {
+            break;
         }
-        uint8_t record[kHistoryRecordBytes];
-        // A short final read is a torn tail — logically truncated here.
-        while (std::fread(record, 1, sizeof(record), file) == sizeof(record)) {
-            const uint32_t epoch = decodeU32Le(record);
-            if (epoch >= t0 && epoch <= t1) {
-                result.push_back(
-                    SensorReading{metric, epoch, decodeFloatLe(record + 4)});
-            }
-        }
-        std::fclose(file);
+        out.insert(out.end(), bytes, bytes + length);
+        tail = next;
     }
-    return result;
+    return n;
 }
 
-bool LittleFsDataStorage::storeEvent(uint32_t epoch, uint8_t category,
-                                     const std::string& detail)
+// Event-log codec: 0xE8-framed records {marker, uint32 LE epoch,
+// uint8 category, uint8 detail_len, detail bytes, uint8 frame_len}
+// (data-model.md). frame_len (header + detail + trailer, <= 128) makes the
+// log walkable from its end; 0xE7 records of older firmware have no
+// trailer and only parse forwards. Records of a segment start after its
+// kEventSegmentHeaderBytes header; the legacy two-file log has none.
+
+/// Frame length of a trailer-framed record with `detailLen` detail bytes.
+constexpr std::size_t eventFrameBytes(std::size_t detailLen)
 {
-    if (!ensureDir(basePath_) || !ensureDir(eventsDir())) {
-        return false;
+    return LittleFsDataStorage::kEventHeaderBytes + detailLen +
+           LittleFsDataStorage::kEventTrailerBytes;
+}
+
+/// One event frame in place: `detail` points into the buffer the frame
+/// was read into, so nothing is copied until record() keeps it.
+struct EventFrame {
+    uint32_t epoch = 0;
+    uint8_t category = 0;
+    std::string_view detail;
+
+    EventRecord record() const
+    {
+        return EventRecord{epoch, category, std::string(detail)};
     }
-    // Contract: an over-long detail is silently truncated — the event
-    // itself is always recorded, never rejected for length.
-    const std::size_t detailLen = std::min(detail.size(), kEventDetailMaxLen);
-    const std::size_t recordBytes = kEventHeaderBytes + detailLen;
+};
 
-    int active = activeEventIndex();
-    std::string path = eventPath(active);
-    const ParsedEventFile parsed = parseEventFile(path);
-    const long size = fileSize(path);
-    // An absent file (size < 0, validBytes 0) is a not-yet-created event
-    // log, not an error: the append below creates it. A stat failure on a
-    // file that does hold valid bytes is a real error — append anyway would
-    // corrupt the frame boundary, so refuse it (mirrors the history path).
-    if (size < 0 && parsed.validBytes > 0) {
-        return false;
+/// The frame whose header and detail start at @p frame (both in bounds).
+EventFrame decodeEventFrame(const uint8_t* frame)
+{
+    return EventFrame{
+        decodeU32Le(frame + 1), frame[5],
+        std::string_view(reinterpret_cast<const char*>(frame) +
+                             LittleFsDataStorage::kEventHeaderBytes,
+                         frame[6])};
+}
+
+/// Valid framed prefix of one event file, its records starting at byte
+/// @p start. A torn tail — bad marker, a
+/// frame shorter than its declared length or a trailer that disagrees
+/// with it, i.e. a power loss mid-append — ends the prefix; everything
+/// before it stays usable (contract invariant 2). An absent file is an
+/// empty log.
+///
+/// The file (from @p start up to at most `maxBytes`) comes in with one
+/// read into @p bytes and is parsed there: a segment is one trip into littlefs,
+/// not a header and a detail fread per record. @p bytes is the caller's
+/// and transient — a resident buffer of the log's size would cost the
+/// heap more than the rare full parse (tail-cache miss, legacy or torn
+/// file) saves. `visit(offset)` sees the offset in @p bytes of each frame
+/// in append order (decodeEventFrame() there builds it on demand).
+/// Returns the file offset where the prefix ends (0 if absent).
+template <typename Visit>
+long parseEventFile(const std::string& path, long start, long maxBytes,
+                    std::vector<uint8_t>& bytes, Visit&& visit)
+{
+    bytes.clear();
+    FILE* file = openRecordFile(path);
+    if (file == nullptr) {
+        return 0;
     }
-    if (size > parsed.validBytes) {
-        // Repair a torn tail (power loss mid-append) so the new record
-        // lands on a frame boundary and the whole file stays parseable.
-        if (::truncate(path.c_str(), parsed.validBytes) != 0) {
-            return false;
-        }
+    long size = -1;
+    if (std::fseek(file, 0, SEEK_END) == 0) {
+        size = std::ftell(file);
     }
-    if (parsed.validBytes + static_cast<long>(recordBytes) >
-        static_cast<long>(kEventFileMaxBytes)) {
-        // Rotation (data-model.md): the append would exceed the 16 KiB
-        // cap, so truncate the standby file and switch appends to it —
-        // the oldest half is dropped, the newest records always kept.
-        active = 1 - active;
-        path = eventPath(active);
-        if (!truncateToEmpty(path)) {
-            return false;
-        }
+    if (std::min(size, maxBytes) > start && std::fseek(file, start, SEEK_SET) == 0) {
+        bytes.resize(static_cast<std::size_t>(std::min(size, maxBytes) - start));
+        bytes.resize(std::fread(bytes.data(), 1, bytes.size(), file));
     }
+    std::fclose(file);
 
-    uint8_t header[kEventHeaderBytes];
-    header[0] = kEventMarker;
-    for (int i = 0; i < 4; ++i) {
-        header[1 + i] = static_cast<uint8_t>((epoch >> (8 * i)) & 0xFF);
+    std::size_t pos = 0;
+    while (bytes.size() - pos >= LittleFsDataStorage::kEventHeaderBytes) {
+        const uint8_t* frame = bytes.data() + pos;
+        const bool trailed = frame[0] == LittleFsDataStorage::kEventMarker;
+        if (!trailed && frame[0] != LittleFsDataStorage::kLegacyEventMarker) {
+            break;
+        }
+        const std::size_t frameBytes =
+            trailed ? eventFrameBytes(frame[6])
+                    : LittleFsDataStorage::kEventHeaderBytes + frame[6];
+        if (frameBytes > bytes.size() - pos ||
+            (trailed && frame[frameBytes - 1] != frameBytes)) {
+            break;  // torn detail, or a trailer that disagrees
+        }
+        visit(pos);
+        pos += frameBytes;
     }
-    header[5] = category;
-    header[6] = static_cast<uint8_t>(detailLen);
+    return start + static_cast<long>(pos);
+}
 
-    FILE* file = std::fopen(path.c_str(), "ab");
+/// Visit the frames of one event file newest first (`visit` returns
+/// false to stop), read backwards from its end through the frame_len
+/// trailers, so the cost scales with the records visited, not with the
+/// file. The walk reads block-sized windows into @p scratch ending at the
+/// current frame — one fread per kReadBlockBytes rather than a seek and
+/// two reads per record — and a frame's `detail` is valid only for the
+/// visit. Where the walk cannot continue — a file started by older
+/// firmware (trailer-less 0xE7 records), a torn tail, a damaged frame —
+/// the rest comes from the forward parse of the bytes before that point,
+/// so a torn or legacy file reads exactly as parseEventFile() sees it.
+/// The records start at byte @p start (a segment's header is not walked).
+/// Returns the file's valid length (as parseEventFile(); 0 if absent).
+template <typename Visit>
+long visitEventsNewestFirst(const std::string& path, long start,
+                            std::vector<uint8_t>& scratch, Visit&& visit)
+{
+    FILE* file = openRecordFile(path);
     if (file == nullptr) {
-        return false;
+        return 0;
     }
-    // Durable once true is returned: flush stdio, then sync to flash.
-    bool ok = std::fwrite(header, 1, sizeof(header), file) == sizeof(header) &&
-              std::fwrite(detail.data(), 1, detailLen, file) == detailLen &&
-              std::fflush(file) == 0 && ::fsync(fileno(file)) == 0;
-    ok = (std::fclose(file) == 0) && ok;
-    return ok;
+    scratch.resize(kReadBlockBytes);
+    long end = -1;
+    if (std::fseek(file, 0, SEEK_END) == 0) {
+        end = std::ftell(file);
+    }
+    long pos = -1;  // walk start; -1: parse the whole file forwards
+    if (end >= start && std::fseek(file, start, SEEK_SET) == 0 &&
+        (end == start || (std::fread(scratch.data(), 1, 1, file) == 1 &&
+                          scratch[0] == LittleFsDataStorage::kEventMarker))) {
+        pos = end;
+    }
+    long winStart = pos;  // scratch holds the file's bytes [winStart, pos)
+    while (pos > start) {
+        if (pos - 1 < winStart) {
+            // Refill so the window ends at `pos`: a block always holds
+            // the largest frame whole.
+            winStart = std::max(pos - static_cast<long>(kReadBlockBytes), start);
+            const std::size_t want = static_cast<std::size_t>(pos - winStart);
+            if (std::fseek(file, winStart, SEEK_SET) != 0 ||
+                std::fread(scratch.data(), 1, want, file) != want) {
+                break;
+            }
+        }
+        const uint8_t frameLen = scratch[static_cast<std::size_t>(pos - 1 - winStart)];
+        if (frameLen < eventFrameBytes(0) ||
+            frameLen > eventFrameBytes(IDataStorage::kEventDetailMaxLen) ||
+            frameLen > pos - start) {
+            break;
+        }
+        if (pos - frameLen < winStart) {
+            winStart = pos;  // frame starts before the window: refill
+            continue;
+        }
+        const uint8_t* frame = scratch.data() + (pos - frameLen - winStart);
+        if (frame[0] != LittleFsDataStorage::kEventMarker ||
+            eventFrameBytes(frame[6]) != frameLen) {
+            break;
+        }
+        pos -= frameLen;
+        if (!visit(decodeEventFrame(frame))) {
+            pos = start;  // stopped by the visitor, not by the walk
+            break;
+        }
+    }
+    std::fclose(file);
+    if (pos == start) {
+        return end;
+    }
+
+    std::vector<uint8_t> bytes;
+    std::vector<uint32_t> offsets;
+    const long validBytes = parseEventFile(
+        path, start, pos < 0 ? LONG_MAX : pos, bytes,
+        [&](std::size_t offset) { offsets.push_back(static_cast<uint32_t>(offset)); });
+    for (auto it = offsets.rbegin(); it != offsets.rend(); ++it) {
+        if (!visit(decodeEventFrame(bytes.data() + *it))) {
+            break;
+        }
+    }
+    return pos == end || pos < 0 ? validBytes : end;
 }
 
-std::vector<EventRecord> LittleFsDataStorage::getEvents(
-    std::size_t maxCount) const
+/// The newest records of one legacy event file, newest first, plus the
+/// file's valid length.
+struct NewestEvents {
+    std::vector<EventRecord> records;
+    long validBytes = 0;
+};
+
+NewestEvents readNewestEvents(const std::string& path, std::size_t maxCount,
+                              std::vector<uint8_t>& scratch)
 {
-    // Each file holds records in append order; the active file's records
-    // are all newer than the standby's (rotation empties the file it
-    // switches to). Newest-first therefore = active reversed, then
-    // standby reversed. Files are <= 16 KiB and event rates are low, so
-    // re-parsing per call keeps this stateless across restarts.
-    const int active = activeEventIndex();
-    const ParsedEventFile newer = parseEventFile(eventPath(active));
-    const ParsedEventFile older = parseEventFile(eventPath(1 - active));
+    NewestEvents newest;
+    if (maxCount == 0) {
+        return newest;
+    }
+    newest.validBytes =
+        visitEventsNewestFirst(path, 0, scratch, [&](const EventFrame& frame) {
+            newest.records.push_back(frame.record());
+            return newest.records.size() < maxCount;
+        });
+    return newest;
+}
 
-    std::vector<EventRecord> result;
-    result.reserve(
-        std::min(maxCount, newer.records.size() + older.records.size()));
-    for (const ParsedEventFile* file : {&newer, &older}) {
-        for (auto it = file->records.rbegin();
-             it != file->records.rend() && result.size() < maxCount; ++it) {
-            result.push_back(*it);
-        }
+/// Which file of the legacy two-file log (0.log, 1.log) holds its newer
+/// half, from the newest record and valid length of each: the one whose
+/// last record has the newest epoch — appends extended the newest end —
+/// with ties (several events within one second around a rotation) going
+/// to the smaller file, which the rotation had just emptied.
+int pickActiveEventFile(const NewestEvents (&files)[2])
+{
+    if (files[1].records.empty()) {
+        return 0;  // covers both-empty: a fresh log starts at 0
     }
-    return result;
+    if (files[0].records.empty()) {
+        return 1;
+    }
+    const uint32_t last0 = files[0].records.front().epoch;
+    const uint32_t last1 = files[1].records.front().epoch;
+    if (last0 != last1) {
+        return last0 > last1 ? 0 : 1;
+    }
+    return files[0].validBytes <= files[1].validBytes ? 0 : 1;
 }
 
-StorageStats LittleFsDataStorage::getStorageStats() const
+/// The sequence in the header of event segment @p path; false when the
+/// file is absent, shorter than a header or not a segment.
+bool readSegmentSequence(const std::string& path, uint32_t& sequence)
 {
-    StorageStats stats{};
-    if (statsProvider_) {
-        uint32_t totalBytes = 0;
-        uint32_t usedBytes = 0;
-        if (statsProvider_(totalBytes, usedBytes)) {
-            stats.totalBytes = totalBytes;
-            stats.usedBytes = usedBytes;
-        }
+    FILE* file = openRecordFile(path);
+    if (file == nullptr) {
+        return false;
     }
-    return stats;
+    uint8_t header[LittleFsDataStorage::kEventSegmentHeaderBytes];
+    const bool read = std::fread(header, 1, sizeof(header), file) == sizeof(header);
+    std::fclose(file);
+    if (!read || decodeU32Le(header) != LittleFsDataStorage::kEventSegmentMagic) {
+        return false;
+    }
+    sequence = decodeU32Le(header + 4);
+    return true;
 }
 
-std::string LittleFsDataStorage::histDir() const { return basePath_ + "/hist"; }
+/// File offset of a segment's first record.
+constexpr long kSegmentRecordsStart =
+    static_cast<long>(LittleFsDataStorage::kEventSegmentHeaderBytes);
 
-std::string LittleFsDataStorage::metricDir(const std::string& metric) const
+/// File of the two-file log older firmware wrote (index 0 or 1).
+std::string legacyEventPath(const std::string& eventsDir, int index)
 {
-    return histDir() + "/" + metric;
+    return eventsDir + "/" + std::to_string(index) + ".log";
 }
 
-std::string LittleFsDataStorage::eventsDir() const
+/// Segment file of `slot`.
+std::string eventSegmentPath(const std::string& eventsDir, std::size_t slot)
 {
-    return basePath_ + "/events";
+    return eventsDir + "/s" + std::to_string(slot) + ".log";
 }
 
-std::string LittleFsDataStorage::eventPath(int index) const
+// Row codec (HistoryFormat::Rows): 0xA5-framed {marker, uint32 LE
+// epoch, uint16 LE presence mask, one LE float per set bit in ascending
+// slot order}. Variable length, so framing (not size % N) finds the tail.
+
+int countBits(uint16_t mask)
 {
-    return eventsDir() + "/" + std::to_string(index) + ".log";
+    int bits = 0;
+    for (; mask != 0; mask &= static_cast<uint16_t>(mask - 1)) {
+        ++bits;
+    }
+    return bits;
 }
 
-int LittleFsDataStorage::activeEventIndex() const
+/// One decoded row; values[i] belongs to the i-th set bit of `mask`.
+struct Row {
+    uint32_t epoch = 0;
+    uint16_t mask = 0;
+    float values[IDataStorage::kMaxMetrics] = {};
+};
+
+/// Visit every row of the valid framed prefix of one row chunk (`visit`
+/// returns false to stop early) and return that prefix's byte length (0
+/// for an absent file). A bad marker, a mask naming no or out-of-budget
+/// slots, or a short payload is a torn tail and ends the prefix — same
+/// rule as parseEventFile().
+template <typename Visit>
+long scanRowChunk(const std::string& path, Visit&& visit)
 {
-    // Restart-recovery rule, derived from the files alone (stateless):
-    // the file whose last valid record carries the newest epoch is the
-    // active one — appends always extend the newest end of the log. A
-    // file without valid records cannot hold the newest half; both
-    // empty/absent means a fresh log starting at 0. Equal last epochs
-    // (several events within one second around a rotation) break the
-    // tie toward the smaller file: right after a rotation the active
-    // file is the freshly truncated, smaller one while the sealed
-    // standby sits near the 16 KiB cap. A full file picked as active
-    // self-corrects on the next append (rotation switches away from
-    // it), so a wrong pick cannot wedge the log. Epoch ordering assumes
-    // the caller's clock — time correctness is the caller's concern
-    // (parity checklist 184).
-    const ParsedEventFile file0 = parseEventFile(eventPath(0));
-    const ParsedEventFile file1 = parseEventFile(eventPath(1));
-    if (file1.records.empty()) {
-        return 0;  // covers both-empty: a fresh log starts at 0
+    FILE* file = std::fopen(path.c_str(), "rb");
+    if (file == nullptr) {
+        return 0;
     }
-    if (file0.records.empty()) {
-        return 1;
+    long validBytes = 0;
+    uint8_t header[LittleFsDataStorage::kRowHeaderBytes];
+    uint8_t payload[4 * IDataStorage::kMaxMetrics];
+    Row row;
+    for (;;) {
+        if (std::fread(header, 1, sizeof(header), file) != sizeof(header) ||
+            header[0] != LittleFsDataStorage::kRowMarker) {
+            break;
+        }
+        const uint16_t mask =
+            static_cast<uint16_t>(header[5] | (header[6] << 8));
+        if (mask == 0 || (mask >> IDataStorage::kMaxMetrics) != 0) {
+            break;
+        }
+        const std::size_t payloadBytes = 4u * static_cast<std::size_t>(countBits(mask));
+        if (std::fread(payload, 1, payloadBytes, file) != payloadBytes) {
+            break;
+        }
+        row.epoch = decodeU32Le(header + 1);
+        row.mask = mask;
+        for (std::size_t i = 0; i * 4 < payloadBytes; ++i) {
+            row.values[i] = decodeFloatLe(payload + 4 * i);
+        }
+        validBytes += static_cast<long>(sizeof(header) + payloadBytes);
+        if (!visit(row)) {
+            break;
+        }
     }
-    const uint32_t last0 = file0.records.back().epoch;
-    const uint32_t last1 = file1.records.back().epoch;
-    if (last0 != last1) {
-        return last0 > last1 ? 0 : 1;
+    std::fclose(file);
+    return validBytes;
+}
+
+/// Row-layout metric name table: one name per '\n'-terminated line,
+/// slot = line number. An unterminated last line is a torn append and
+/// not part of the table; `validBytes` is the terminated prefix.
+std::vector<std::string> parseSlotTable(const std::string& path,
+                                        long& validBytes)
+{
+    std::vector<std::string> slots;
+    validBytes = 0;
+    FILE* file = std::fopen(path.c_str(), "rb");
+    if (file == nullptr) {
+        return slots;
+    }
+    std::string line;
+    long offset = 0;
+    for (int c = std::fgetc(file); c != EOF; c = std::fgetc(file)) {
+        ++offset;
+        if (c != '\n') {
+            line.push_back(static_cast<char>(c));
+            continue;
+        }
+        slots.push_back(line);
+        line.clear();
+        validBytes = offset;
     }
-    return file0.validBytes <= file1.validBytes ? 0 : 1;
+    std::fclose(file);
+    return slots;
+}
+
+// Multiplexed codec (HistoryFormat::Multiplexed): 0xA6-framed {marker,
+// uint32 LE epoch, uint8 count, count x {uint8 slot, LE float}}, then on
+// a sealed chunk one 0xA7 footer {marker, uint64 LE presence, uint32 LE
+// min epoch, uint32 LE max epoch} that nothing follows.
+
+using MuxFooterBytes = uint8_t[LittleFsDataStorage::kMuxFooterBytes];
+
+void encodeMuxFooter(MuxFooterBytes& out, uint64_t presence, uint32_t minEpoch,
+                     uint32_t maxEpoch)
+{
+    out[0] = LittleFsDataStorage::kMuxFooterMarker;
+    for (int b = 0; b < 8; ++b) {
+        out[1 + b] = static_cast<uint8_t>((presence >> (8 * b)) & 0xFF);
+    }
+    for (int b = 0; b < 4; ++b) {
+        out[9 + b] = static_cast<uint8_t>((minEpoch >> (8 * b)) & 0xFF);
+        out[13 + b] = static_cast<uint8_t>((maxEpoch >> (8 * b)) & 0xFF);
+    }
+}
+
+/// False unless `in` is a footer of a chunk holding something.
+bool decodeMuxFooter(const MuxFooterBytes& in, uint64_t& presence,
+                     uint32_t& minEpoch, uint32_t& maxEpoch)
+{
+    if (in[0] != LittleFsDataStorage::kMuxFooterMarker) {
+        return false;
+    }
+    presence = 0;
+    for (int b = 0; b < 8; ++b) {
+        presence |= static_cast<uint64_t>(in[1 + b]) << (8 * b);
+    }
+    minEpoch = decodeU32Le(in + 9);
+    maxEpoch = decodeU32Le(in + 13);
+    return presence != 0 && minEpoch <= maxEpoch;
+}
+
+/// Visit every frame of the valid framed prefix of one multiplexed chunk
+/// as visit(epoch, entries, count) — `count` {slot, value} entries of
+/// kMuxEntryBytes each, returning false to stop early — and return that
+/// prefix's byte length (0 for an absent file), footer included.
+/// `sealed` reports a valid footer. A bad marker, an empty or oversized
+/// frame, a slot out of budget or a short read is a torn tail and ends
+/// the prefix — same rule as scanRowChunk().
+template <typename Visit>
+long scanMuxChunk(const std::string& path, bool& sealed, Visit&& visit)
+{
+    sealed = false;
+    FILE* file = std::fopen(path.c_str(), "rb");
+    if (file == nullptr) {
+        return 0;
+    }
+    constexpr std::size_t kHeader = LittleFsDataStorage::kMuxFrameHeaderBytes;
+    constexpr std::size_t kEntry = LittleFsDataStorage::kMuxEntryBytes;
+    constexpr std::size_t kMaxSlots = LittleFsDataStorage::kMuxMaxMetrics;
+    long validBytes = 0;
+    uint8_t entries[kEntry * kMaxSlots];
+    for (;;) {
+        const int marker = std::fgetc(file);
+        if (marker == LittleFsDataStorage::kMuxFooterMarker) {
+            MuxFooterBytes footer;
+            footer[0] = static_cast<uint8_t>(marker);
+            uint64_t presence = 0;
+            uint32_t minEpoch = 0;
+            uint32_t maxEpoch = 0;
+            if (std::fread(footer + 1, 1, sizeof(footer) - 1, file) == sizeof(footer) - 1 &&
+                decodeMuxFooter(footer, presence, minEpoch, maxEpoch)) {
+                validBytes += static_cast<long>(sizeof(footer));
+                sealed = true;
+            }
+            break;
+        }
+        uint8_t header[kHeader - 1];
+        if (marker != LittleFsDataStorage::kMuxMarker ||
+            std::fread(header, 1, sizeof(header), file) != sizeof(header)) {
+            break;
+        }
+        const std::size_t count = header[4];
+        if (count == 0 || count > kMaxSlots ||
+            std::fread(entries, 1, count * kEntry, file) != count * kEntry) {
+            break;
+        }
+        bool slotsValid = true;
+        for (std::size_t i = 0; i < count && slotsValid; ++i) {
+            slotsValid = entries[i * kEntry] < kMaxSlots;
+        }
+        if (!slotsValid) {
+            break;
+        }
+        validBytes += static_cast<long>(kHeader + count * kEntry);
+        if (!visit(decodeU32Le(header), entries, count)) {
+            break;
+        }
+    }
+    std::fclose(file);
+    return validBytes;
+}
+
+// Chunk summary sidecar (chunkSummaries): {0xC5, uint32 count, uint32
+// min epoch, uint32 max epoch, float min, float max, double sum, float
+// last, uint32 chunk bytes, uint32 chunk CRC32}, then a CRC32 of those 41
+// bytes, all little-endian. A torn or foreign file fails its own CRC and
+// is ignored.
+
+constexpr std::size_t kSummaryCrcOffset = LittleFsDataStorage::kSummaryBytes - 4;
+
+/// CRC-32 (IEEE 802.3, reflected), bit by bit: it runs once per sealed
+/// chunk or scrubbed one, so a lookup table would not pay for its 1 KiB.
+uint32_t crc32Update(uint32_t crc, const uint8_t* data, std::size_t len)
+{
+    crc = ~crc;
+    for (std::size_t i = 0; i < len; ++i) {
+        crc ^= data[i];
+        for (int bit = 0; bit < 8; ++bit) {
+            crc = (crc >> 1) ^ (0xEDB88320u & (0u - (crc & 1u)));
+        }
+    }
+    return ~crc;
+}
+
+void putU32Le(uint8_t* out, uint32_t value)
+{
+    for (int i = 0; i < 4; ++i) {
+        out[i] = static_cast<uint8_t>((value >> (8 * i)) & 0xFF);
+    }
+}
+
+void putFloatLe(uint8_t* out, float value)
+{
+    uint32_t bits = 0;
+    std::memcpy(&bits, &value, sizeof(bits));
+    putU32Le(out, bits);
+}
+
+// Batch journal (journalBatches): {0xB7, uint16 entry count, count x
+// {uint8 name length, name, 8-byte history record}}, then a CRC32 of all
+// that, little-endian. One record per file, rewritten by every batch; a
+// torn or foreign file fails the CRC and is discarded.
+
+constexpr uint8_t kJournalMarker = 0xB7;
+constexpr std::size_t kJournalHeaderBytes = 3;
+constexpr std::size_t kJournalCrcBytes = 4;
+/// A full logging pass is ~200 bytes; a larger batch is not journaled.
+constexpr std::size_t kJournalMaxBytes = 1024;
+
+/// Entry names of `dir` (no "."/".."), sorted; empty if absent.
+std::vector<std::string> listNames(const std::string& dir)
+{
+    std::vector<std::string> names;
+    if (DIR* d = ::opendir(dir.c_str())) {
+        while (const dirent* entry = ::readdir(d)) {
+            if (std::strcmp(entry->d_name, ".") != 0 &&
+                std::strcmp(entry->d_name, "..") != 0) {
+                names.emplace_back(entry->d_name);
+            }
+        }
+        ::closedir(d);
+    }
+    std::sort(names.begin(), names.end());
+    return names;
+}
+
+/// First epoch of a summary file name ("<decimal uint32>.sum").
+bool parseSummaryName(const std::string& name, uint32_t& firstEpoch)
+{
+    const std::size_t dot = name.find('.');
+    if (dot == 0 || dot == std::string::npos || name.compare(dot, std::string::npos, ".sum") != 0) {
+        return false;
+    }
+    unsigned long long value = 0;
+    for (std::size_t i = 0; i < dot; ++i) {
+        if (name[i] < '0' || name[i] > '9') {
+            return false;
+        }
+        value = value * 10 + static_cast<unsigned long long>(name[i] - '0');
+        if (value > UINT32_MAX) {
+            return false;
+        }
+    }
+    firstEpoch = static_cast<uint32_t>(value);
+    return true;
+}
+
+/// IReadingVisitor over a callable, so the scans below can take lambdas
+/// without std::function.
+template <typename F>
+class ReadingCallback final : public IReadingVisitor {
+public:
+    explicit ReadingCallback(F f) : f_(std::move(f)) {}
+    bool onReading(uint32_t epoch, float value) override { return f_(epoch, value); }
+
+private:
+    F f_;
+};
+
+}  // namespace
+
+LittleFsDataStorage::LittleFsDataStorage(std::string basePath,
+                                         StatsProvider statsProvider,
+                                         LittleFsDataStorageOptions options)
+    : basePath_(std::move(basePath)),
+      statsProvider_(std::move(statsProvider)),
+      options_(options)
+{
+    state_.reserve(MetricRegistry::kCapacity);
+    for (MetricId id = 0; id < metrics_.size(); ++id) {
+        state_.emplace_back();
+        state_.back().dir = metricDir(metrics_.name(id));
+        state_.back().maxChunks = ringChunks(metrics_.name(id));
+    }
+    const std::size_t segments =
+        std::min(std::max(options_.eventSegments, std::size_t{2}), kEventMaxSegments);
+    for (std::size_t i = 0; i < segments; ++i) {
+        eventPaths_.push_back(eventSegmentPath(eventsDir(), i));
+    }
+    eventSegmentBytes_ =
+        std::max(options_.eventLogBytes / segments,
+                 kEventSegmentHeaderBytes + eventFrameBytes(kEventDetailMaxLen));
+    journalPath_ = basePath_ + "/journal";
+    options_.recentReadings = std::min(options_.recentReadings,
+                                       kHistoryChunkMaxBytes / kHistoryRecordBytes);
+}
+
+LittleFsDataStorage::~LittleFsDataStorage() { flush(); }
+
+std::size_t LittleFsDataStorage::ringChunks(const std::string& metric) const
+{
+    const std::size_t planned = options_.retention.chunksFor(metric);
+    return planned != 0 ? std::max(planned, retention::kMinChunks)
+                        : kHistoryMaxChunksPerMetric;
+}
+
+MetricId LittleFsDataStorage::resolveMetric(const std::string& name)
+{
+    if (!isValidMetricName(name)) {
+        return metric::kInvalid;
+    }
+    const MetricId id = metrics_.intern(name);
+    if (id != metric::kInvalid && id >= state_.size()) {
+        state_.emplace_back();
+        state_.back().dir = metricDir(name);
+        state_.back().maxChunks = ringChunks(name);
+    }
+    return id;
+}
+
+const std::vector<LittleFsDataStorage::HistoryRecord>*
+LittleFsDataStorage::pendingOf(const std::string& name) const
+{
+    const MetricId id = metrics_.find(name);
+    return id == metric::kInvalid ? nullptr : &state_[id].pending;
+}
+
+bool LittleFsDataStorage::storeSensorReading(const std::string& metric,
+                                             uint32_t epoch, float value)
+{
+    const MetricSample sample{resolveMetric(metric), epoch, value};
+    return sample.metric != metric::kInvalid && storeSamples(&sample, 1) == 1;
+}
+
+std::size_t LittleFsDataStorage::storeSensorReadings(
+    const SensorReading* readings, std::size_t count)
+{
+    // Names are resolved once here; a rejected name is simply not passed on.
+    sampleScratch_.clear();
+    for (std::size_t i = 0; i < count; ++i) {
+        const MetricId id = resolveMetric(readings[i].metric);
+        if (id != metric::kInvalid) {
+            sampleScratch_.push_back(
+                MetricSample{id, readings[i].epoch, readings[i].value});
+        }
+    }
+    return storeSamples(sampleScratch_.data(), sampleScratch_.size());
+}
+
+std::size_t LittleFsDataStorage::storeSamples(const MetricSample* samples,
+                                              std::size_t count)
+{
+    const AppendTimer timer(*this);
+    std::size_t stored = 0;
+    if (groupCommitActive()) {
+        for (std::size_t i = 0; i < count; ++i) {
+            const MetricSample& s = samples[i];
+            const HistoryRecord record{s.epoch, s.value};
+            if (metrics_.contains(s.metric) && bufferRecord(s.metric, record)) {
+                noteRecent(s.metric, record);
+                ++stored;
+            }
+        }
+        // One trigger check for the batch; a failed commit drops what it
+        // could not write, so nothing of this batch counts as stored.
+        return commitIfTriggered() ? stored : 0;
+    }
+
+    if (sharedLayout()) {
+        stored = commitShared(samples, count);
+        if (stored != count) {
+            forgetRecent(metric::kInvalid);  // which samples made it is not known
+            return stored;
+        }
+        for (std::size_t i = 0; i < count; ++i) {
+            noteRecent(samples[i].metric, HistoryRecord{samples[i].epoch, samples[i].value});
+        }
+        return stored;
+    }
+
+    if (journalActive() && !journalReplayed_) {
+        journalReplayed_ = true;
+        replayJournal();
+    }
+    // Journaled, the batch is durable once its record is: the appends
+    // below close their files without syncing them.
+    const std::size_t journaled = journalActive() ? writeJournal(samples, count) : 0;
+    syncDeferred_ = journaled != 0;
+
+    // Durable path: gather each distinct metric's samples (array order)
+    // and commit them in one go. Batches are one logging pass (<= the
+    // metric budget), so the quadratic first-occurrence scan is cheaper
+    // than any map.
+    for (std::size_t i = 0; i < count; ++i) {
+        const MetricId id = samples[i].metric;
+        bool seen = false;
+        for (std::size_t j = 0; j < i && !seen; ++j) {
+            seen = samples[j].metric == id;
+        }
+        if (seen || !metrics_.contains(id)) {
+            continue;
+        }
+        batchScratch_.clear();
+        for (std::size_t j = i; j < count; ++j) {
+            if (samples[j].metric == id) {
+                batchScratch_.push_back(
+                    HistoryRecord{samples[j].epoch, samples[j].value});
+            }
+        }
+        if (commitRecords(id, batchScratch_.data(), batchScratch_.size())) {
+            stored += batchScratch_.size();
+            for (const HistoryRecord& record : batchScratch_) {
+                noteRecent(id, record);
+            }
+        } else {
+            forgetRecent(id);
+        }
+    }
+    syncDeferred_ = false;
+    if (journaled != 0 && stored != journaled) {
+        // A replay must not add what this call reports as not stored.
+        std::remove(journalPath_.c_str());
+    }
+    return stored;
+}
+
+bool LittleFsDataStorage::journalActive() const
+{
+    return options_.journalBatches && !groupCommitActive() && !sharedLayout();
+}
+
+std::size_t LittleFsDataStorage::writeJournal(const MetricSample* samples,
+                                              std::size_t count)
+{
+    std::vector<uint8_t>& out = journalScratch_;
+    out.assign(kJournalHeaderBytes, 0);
+    out[0] = kJournalMarker;
+    std::size_t entries = 0;
+    MetricId first = metric::kInvalid;
+    bool spans = false;  // more than one metric
+    for (std::size_t i = 0; i < count; ++i) {
+        const MetricSample& s = samples[i];
+        if (!metrics_.contains(s.metric)) {
+            continue;
+        }
+        const std::string& name = metrics_.name(s.metric);
+        if (name.size() > UINT8_MAX ||
+            out.size() + 1 + name.size() + kHistoryRecordBytes + kJournalCrcBytes >
+                kJournalMaxBytes) {
+            return 0;
+        }
+        first = entries == 0 ? s.metric : first;
+        spans = spans || s.metric != first;
+        out.push_back(static_cast<uint8_t>(name.size()));
+        out.insert(out.end(), name.begin(), name.end());
+        const std::size_t at = out.size();
+        out.resize(at + kHistoryRecordBytes);
+        encodeRecord(out.data() + at, s.epoch, s.value);
+        ++entries;
+    }
+    if (!spans) {
+        return 0;  // one metric: its own append is already one sync
+    }
+    out[1] = static_cast<uint8_t>(entries & 0xFF);
+    out[2] = static_cast<uint8_t>(entries >> 8);
+    const std::size_t at = out.size();
+    out.resize(at + kJournalCrcBytes);
+    putU32Le(out.data() + at, crc32Update(0, out.data(), at));
+
+    if (!ensureDir(basePath_)) {
+        return 0;
+    }
+    FILE* file = std::fopen(journalPath_.c_str(), "wb");
+    if (file == nullptr) {
+        return 0;
+    }
+    bool ok = std::fwrite(out.data(), 1, out.size(), file) == out.size() &&
+              syncCounted(file);
+    ok = (std::fclose(file) == 0) && ok;
+    if (!ok) {
+        std::remove(journalPath_.c_str());
+        return 0;
+    }
+    // Rewritten in place each batch, so it is not part of the usage tally.
+    writes_.bytesAppended += out.size();
+    return entries;
+}
+
+void LittleFsDataStorage::replayJournal()
+{
+    const long size = fileSize(journalPath_);
+    if (size < 0) {
+        return;
+    }
+    std::vector<uint8_t>& bytes = journalScratch_;
+    bool valid = size >= static_cast<long>(kJournalHeaderBytes + kJournalCrcBytes) &&
+                 size <= static_cast<long>(kJournalMaxBytes);
+    if (valid) {
+        bytes.resize(static_cast<std::size_t>(size));
+        FILE* file = std::fopen(journalPath_.c_str(), "rb");
+        valid = file != nullptr &&
+                std::fread(bytes.data(), 1, bytes.size(), file) == bytes.size();
+        if (file != nullptr) {
+            std::fclose(file);
+        }
+    }
+    const std::size_t end = valid ? bytes.size() - kJournalCrcBytes : 0;
+    valid = valid && bytes[0] == kJournalMarker &&
+            decodeU32Le(bytes.data() + end) == crc32Update(0, bytes.data(), end);
+
+    std::vector<MetricSample> samples;
+    if (valid) {
+        const std::size_t entries = static_cast<std::size_t>(bytes[1]) |
+                                    (static_cast<std::size_t>(bytes[2]) << 8);
+        std::size_t at = kJournalHeaderBytes;
+        for (std::size_t e = 0; e < entries && valid; ++e) {
+            const std::size_t len = at < end ? bytes[at] : 0;
+            valid = at < end && at + 1 + len + kHistoryRecordBytes <= end;
+            if (!valid) {
+                break;
+            }
+            const MetricId id = resolveMetric(
+                std::string(reinterpret_cast<const char*>(bytes.data() + at + 1), len));
+            at += 1 + len;
+            if (id != metric::kInvalid) {
+                samples.push_back(MetricSample{id, decodeU32Le(bytes.data() + at),
+                                               decodeFloatLe(bytes.data() + at + 4)});
+            }
+            at += kHistoryRecordBytes;
+        }
+        valid = valid && at == end;
+    }
+
+    // Per metric: the journaled records newer than its newest committed
+    // one. A journal can outlive its pass (a later one-metric append is
+    // not journaled), so anything at or before that epoch is already
+    // history, whether this pass's or an older one's.
+    for (std::size_t i = 0; valid && i < samples.size(); ++i) {
+        const MetricId id = samples[i].metric;
+        bool seen = false;
+        for (std::size_t j = 0; j < i && !seen; ++j) {
+            seen = samples[j].metric == id;
+        }
+        if (seen) {
+            continue;
+        }
+        const LatestReading newest = latestReading(metrics_.name(id));
+        batchScratch_.clear();
+        for (std::size_t j = i; j < samples.size(); ++j) {
+            if (samples[j].metric == id && (!newest.found || samples[j].epoch > newest.epoch)) {
+                batchScratch_.push_back(HistoryRecord{samples[j].epoch, samples[j].value});
+            }
+        }
+        if (!batchScratch_.empty()) {
+            commitRecords(id, batchScratch_.data(), batchScratch_.size());
+            forgetRecent(id);
+        }
+    }
+    std::remove(journalPath_.c_str());
+}
+
+bool LittleFsDataStorage::bufferRecord(MetricId metric,
+                                       const HistoryRecord& record)
+{
+    // The metric budget is enforced at accept time, so an 11th distinct
+    // metric is rejected synchronously exactly like the durable path.
+    MetricState& state = state_[metric];
+    if (!state.buffered) {
+        state.buffered =
+            sharedLayout() ? rowSlot(metrics_.name(metric), /*assign=*/true) >= 0
+                        : (state.indexed || ensureMetricDir(metric));
+        if (!state.buffered) {
+            return false;
+        }
+    }
+    state.pending.push_back(record);
+    if (pendingCount_++ == 0) {
+        pendingSinceMs_ = options_.clock->nowMs();
+    }
+    return true;
+}
+
+bool LittleFsDataStorage::commitIfTriggered()
+{
+    if (pendingCount_ >= options_.groupCommitMaxRecords) {
+        return flush();
+    }
+    return flushIfDue();
+}
+
+bool LittleFsDataStorage::flush()
+{
+    if (pendingCount_ == 0) {
+        return true;
+    }
+    const AppendTimer timer(*this);
+    bool ok = true;
+    if (sharedLayout()) {
+        // Rows / multiplexed: the whole buffer in one commit, samples that
+        // share an epoch (one logging pass) sharing a row (frame).
+        std::vector<MetricSample> samples;
+        samples.reserve(pendingCount_);
+        for (MetricId id = 0; id < state_.size(); ++id) {
+            for (const HistoryRecord& record : state_[id].pending) {
+                samples.push_back(MetricSample{id, record.epoch, record.value});
+            }
+            state_[id].pending.clear();
+        }
+        // Rows are laid down in first-seen order; epoch order keeps each
+        // metric chronological across rows (stable: per-metric order kept).
+        std::stable_sort(samples.begin(), samples.end(),
+                         [](const MetricSample& a, const MetricSample& b) {
+                             return a.epoch < b.epoch;
+                         });
+        ok = commitShared(samples.data(), samples.size()) == samples.size();
+        if (!ok) {
+            forgetRecent(metric::kInvalid);  // the rings had them at accept time
+        }
+        pendingCount_ = 0;
+        return ok;
+    }
+    // One commit (one fsync per chunk file touched) per metric. A failed
+    // metric's records are dropped like a failed synchronous append; the
+    // other metrics still commit.
+    for (MetricId id = 0; id < state_.size(); ++id) {
+        std::vector<HistoryRecord>& records = state_[id].pending;
+        if (!records.empty() &&
+            !commitRecords(id, records.data(), records.size())) {
+            ok = false;
+            forgetRecent(id);
+        }
+        records.clear();
+    }
+    pendingCount_ = 0;
+    return ok;
+}
+
+bool LittleFsDataStorage::flushIfDue()
+{
+    if (pendingCount_ == 0 || !groupCommitActive()) {
+        return true;
+    }
+    if (options_.clock->nowMs() - pendingSinceMs_ <
+        static_cast<int64_t>(options_.groupCommitWindowMs)) {
+        return true;
+    }
+    return flush();
+}
+
+bool LittleFsDataStorage::groupCommitActive() const
+{
+    return options_.groupCommitWindowMs > 0 && options_.clock != nullptr;
+}
+
+bool LittleFsDataStorage::commitRecords(MetricId metric,
+                                        const HistoryRecord* records,
+                                        std::size_t count)
+{
+    if (!appendRecords(metric, records, count)) {
+        return false;
+    }
+    if (options_.rollups && count > 0) {
+        // Append order, so the last record carries the newest epoch.
+        rollupsAfterCommit(metric, records[count - 1].epoch);
+    }
+    return true;
+}
+
+bool LittleFsDataStorage::appendRecords(MetricId metric,
+                                        const HistoryRecord* records,
+                                        std::size_t count)
+{
+    std::size_t committed = 0;
+    if (!options_.cacheChunkIndex) {
+        // Derive the active chunk from the files (stateless across restarts).
+        ChunkIndex index;
+        return loadChunkIndex(metric, index) &&
+               writeRecords(metric, index, records, count, committed);
+    }
+
+    MetricState& state = state_[metric];
+    const bool cached = state.indexed;
+    if (!cached) {
+        if (!loadChunkIndex(metric, state.index)) {
+            return false;
+        }
+        state.indexed = true;
+    }
+    if (writeRecords(metric, state.index, records, count, committed)) {
+        return true;
+    }
+    // The table no longer matches the files (a failed or partial write, or
+    // the directory changed underneath us): drop it. A table that predates
+    // this call and named a file or directory that is gone (ENOENT: nothing
+    // of the failed step was written) gets one retry of the uncommitted
+    // rest against a fresh derivation, so a stale cache never fails an
+    // append the stateless path would have accepted. Any other failure may
+    // have left partial bytes and is reported as is.
+    const bool stale = cached && errno == ENOENT;
+    state.indexed = false;
+    if (!stale) {
+        return false;
+    }
+    std::size_t retried = 0;
+    if (!loadChunkIndex(metric, state.index) ||
+        !writeRecords(metric, state.index, records + committed,
+                      count - committed, retried)) {
+        return false;
+    }
+    state.indexed = true;
+    return true;
+}
+
+bool LittleFsDataStorage::ensureMetricDir(MetricId metric)
+{
+    const std::string& dir = state_[metric].dir;
+    if (isDir(dir)) {
+        return true;
+    }
+    const std::string hist = histDir();
+    if (!ensureDir(basePath_) || !ensureDir(hist)) {
+        return false;
+    }
+    if (countSubdirs(hist) >= kMaxMetrics) {
+        return false;  // budget guard: 11th distinct metric rejected
+    }
+    return ensureDir(dir);
+}
+
+bool LittleFsDataStorage::loadChunkIndex(MetricId metric, ChunkIndex& index)
+{
+    if (!ensureMetricDir(metric)) {
+        return false;
+    }
+    const std::string& dir = state_[metric].dir;
+
+    index = ChunkIndex{};
+    std::vector<ChunkRef> shadowed;
+    const std::vector<ChunkRef> chunks = listChunks(dir, &shadowed);
+    if (!shadowed.empty()) {
+        // Before the ring can evict the .dz and bring its .dat back.
+        tidyRecompaction(metric);
+    }
+    if (chunks.empty()) {
+        return true;
+    }
+    index.activePath = dir + "/" + chunks.back().name;
+    const std::string& activePath = index.activePath;
+    long size = fileSize(activePath);
+    if (size < 0) {
+        return false;
+    }
+    const long validBytes = withCodec(chunks.back().delta, [&](auto codec) {
+        return decltype(codec)::validPrefix(activePath, size, index.tail);
+    });
+    if (validBytes == kForeignChunk) {
+        // Not ours to extend or truncate: treat it as sealed, so the next
+        // append starts a successor and the ring ages it out.
+        size = static_cast<long>(kHistoryChunkMaxBytes);
+    } else {
+        // Repair a torn tail, header or frame (power loss mid-append) so
+        // the next record lands on a record boundary and committed ones
+        // stay parseable.
+        if (size > validBytes) {
+            if (::truncate(activePath.c_str(), validBytes) != 0) {
+                return false;
+            }
+            noteRepaired(size - validBytes);
+        }
+        size = validBytes;
+    }
+    index.names.reserve(chunks.size());
+    for (const ChunkRef& chunk : chunks) {
+        index.names.push_back(chunk.name);
+    }
+    index.newestFirstEpoch = chunks.back().firstEpoch;
+    index.activeSize = size;
+    // Newest committed epoch, so the next append can tell whether it goes
+    // back in time. A just-rolled (still empty) chunk defers to its
+    // predecessor.
+    if (index.tail.started) {
+        index.hasLast = true;  // decoded above
+        index.lastEpoch = index.tail.epoch;
+        return true;
+    }
+    index.hasLast = lastRecordEpoch(activePath, index.lastEpoch) ||
+                    (chunks.size() > 1 &&
+                     lastRecordEpoch(dir + "/" + chunks[chunks.size() - 2].name,
+                                     index.lastEpoch));
+    return true;
+}
+
+bool LittleFsDataStorage::writeRecords(MetricId metric, ChunkIndex& index,
+                                       const HistoryRecord* records,
+                                       std::size_t count,
+                                       std::size_t& committed)
+{
+    const std::string& dir = state_[metric].dir;
+    committed = 0;
+    while (committed < count) {
+        // The active chunk keeps the codec it was created with.
+        bool delta = !index.names.empty() && isDeltaChunk(index.names.back());
+        const std::size_t maxRecordBytes = withCodec(
+            delta, [](auto codec) { return decltype(codec)::kMaxRecordBytes; });
+        if (index.names.empty() ||
+            static_cast<std::size_t>(index.activeSize) + maxRecordBytes >
+                kHistoryChunkMaxBytes) {
+            // No chunk yet, or the active one is sealed at 8 KiB — start a
+            // successor.
+            if (options_.chunkSummaries && !index.names.empty()) {
+                writeChunkSummary(metric, index.names.back(), index.newestFirstEpoch);
+            }
+            // Ring bound: creating chunk #11 (or #maxChunks + 1 under a
+            // retention plan) deletes the oldest — all of the excess when
+            // the plan shrank the ring.
+            while (index.names.size() >= state_[metric].maxChunks) {
+                if (!evictChunk(metric, index.names.front())) {
+                    return false;
+                }
+                index.names.erase(index.names.begin());
+            }
+            // Filename = first record's epoch. A non-monotonic epoch that
+            // does not sort after the sealed chunk is bumped past it: chunk
+            // names must stay strictly increasing for ordering/eviction
+            // (time correctness is the caller's concern, parity 184).
+            uint32_t chunkEpoch = records[committed].epoch;
+            if (!index.names.empty() && chunkEpoch <= index.newestFirstEpoch) {
+                chunkEpoch = index.newestFirstEpoch + 1;
+            }
+            delta = options_.historyCodec == HistoryCodec::Delta;
+            index.names.push_back(chunkName(chunkEpoch, delta, false));
+            ++writes_.filesCreated;
+            index.activePath = dir + "/" + index.names.back();
+            index.newestFirstEpoch = chunkEpoch;
+            index.activeSize = 0;
+            index.tail = deltachunk::State{};
+        }
+
+        // Encode as many records as the active chunk has room for, then
+        // write them with one sync.
+        deltachunk::State tail = index.tail;
+        const std::size_t batch = withCodec(delta, [&](auto codec) {
+            return encodeRecords(codec, records + committed, count - committed,
+                                 index.activeSize, frameScratch_, tail);
+        });
+        // A record older than its predecessor breaks the ascending order
+        // range queries rely on: rename the active chunk to the unordered
+        // suffix BEFORE writing it, so reads fall back to the full scan
+        // until that chunk leaves the ring.
+        bool backwards = false;
+        uint32_t previous = index.lastEpoch;
+        bool hasPrevious = index.hasLast;
+        for (std::size_t i = 0; i < batch; ++i) {
+            const uint32_t epoch = records[committed + i].epoch;
+            backwards = backwards || (hasPrevious && epoch < previous);
+            previous = epoch;
+            hasPrevious = true;
+        }
+        if (backwards) {
+            const std::string unorderedName =
+                chunkName(index.newestFirstEpoch, delta, true);
+            if (index.names.back() != unorderedName) {
+                // A chunk opened by this very loop does not exist yet.
+                const std::string unorderedPath = dir + "/" + unorderedName;
+                forgetCachedChunk(index.activePath);
+                if (std::rename(index.activePath.c_str(),
+                                unorderedPath.c_str()) != 0 &&
+                    !(errno == ENOENT && index.activeSize == 0)) {
+                    return false;
+                }
+                index.names.back() = unorderedName;
+                index.activePath = unorderedPath;
+            }
+        }
+        FILE* file = std::fopen(index.activePath.c_str(), "ab");
+        if (file == nullptr) {
+            return false;
+        }
+        // Durable once true is returned: flush stdio, then sync to flash.
+        bool ok = std::fwrite(frameScratch_.data(), 1, frameScratch_.size(),
+                              file) == frameScratch_.size() &&
+                  syncCounted(file);
+        ok = (std::fclose(file) == 0) && ok;
+        if (!ok) {
+            statsCached_ = false;  // partial bytes: resync on next read
+            return false;
+        }
+        noteAppended(static_cast<long>(frameScratch_.size()));
+        index.activeSize += static_cast<long>(frameScratch_.size());
+        index.tail = tail;
+        index.hasLast = true;
+        index.lastEpoch = previous;
+        committed += batch;
+    }
+    return true;
+}
+
+bool LittleFsDataStorage::evictChunk(MetricId metric, const std::string& name)
+{
+    const std::string path = state_[metric].dir + "/" + name;
+    if (!removeCounted(path)) {
+        return false;
+    }
+    ChunkRef evicted;
+    if (options_.chunkSummaries && parseChunkName(name.c_str(), evicted)) {
+        const std::string summary = summaryDir(metrics_.name(metric)) + "/" +
+                                    std::to_string(evicted.firstEpoch) + ".sum";
+        if (fileSize(summary) >= 0) {
+            removeCounted(summary);  // best effort, like its write
+        }
+    }
+    forgetCachedChunk(path);
+    forgetRecent(metric);
+    return true;
+}
+
+HistoryImport LittleFsDataStorage::importHistory(const std::string& metric,
+                                                 const HistoryPoint* points,
+                                                 std::size_t count)
+{
+    HistoryImport result;
+    if (count == 0) {
+        return result;
+    }
+    const MetricId id = sharedLayout() ? metric::kInvalid : resolveMetric(metric);
+    if (id == metric::kInvalid || !ensureMetricDir(id)) {
+        result.ok = false;
+        return result;
+    }
+    const std::string& dir = state_[id].dir;
+    const std::vector<ChunkRef> chunks = listChunks(dir);
+
+    // The chunks around the batch by filename epoch: the one before it
+    // bounds it by its last record, the one after by its first epoch.
+    const auto after = std::upper_bound(
+        chunks.begin(), chunks.end(), points[0].epoch,
+        [](uint32_t epoch, const ChunkRef& chunk) { return epoch < chunk.firstEpoch; });
+    const std::size_t older = static_cast<std::size_t>(after - chunks.begin());
+    bool hasFloor = false;
+    uint32_t floor = 0;
+    if (older != 0) {
+        hasFloor = lastRecordEpoch(dir + "/" + chunks[older - 1].name, floor);
+    }
+    if (older != 0 && chunks[older - 1].firstEpoch == points[0].epoch) {
+        // Written by an earlier, interrupted run: step over what it holds.
+        result.existed = true;
+        while (result.consumed < count &&
+               (!hasFloor || points[result.consumed].epoch <= floor)) {
+            ++result.consumed;
+        }
+        result.consumed = std::max<std::size_t>(result.consumed, 1);
+        return result;
+    }
+    const bool ceiled = after != chunks.end();
+    const uint32_t ceiling = ceiled ? after->firstEpoch : 0;
+
+    // Ring bound: the new chunk must not be the one its ring sheds.
+    const std::size_t ring = state_[id].maxChunks;
+    const std::size_t excess = chunks.size() + 1 > ring ? chunks.size() + 1 - ring : 0;
+    if (excess > older) {
+        result.consumed = count;
+        result.skipped = count;
+        return result;
+    }
+
+    const bool delta = options_.historyCodec == HistoryCodec::Delta;
+    uint32_t firstEpoch = 0;
+    uint32_t lastEpoch = 0;
+    withCodec(delta, [&](auto codec) {
+        using Codec = decltype(codec);
+        frameScratch_.clear();
+        Codec::header(frameScratch_);
+        deltachunk::State tail;
+        for (; result.consumed < count; ++result.consumed) {
+            const HistoryPoint& p = points[result.consumed];
+            const bool follows = result.written != 0 ? p.epoch > lastEpoch
+                                                     : !hasFloor || p.epoch > floor;
+            if (!follows || (ceiled && p.epoch >= ceiling)) {
+                ++result.skipped;
+                continue;
+            }
+            uint8_t bytes[Codec::kMaxRecordBytes];
+            deltachunk::State next = tail;
+            const std::size_t length = Codec::encode(bytes, next, p.epoch, p.value);
+            if (frameScratch_.size() + length > kHistoryChunkMaxBytes) {
+                break;  // full: the rest starts the next chunk
+            }
+            frameScratch_.insert(frameScratch_.end(), bytes, bytes + length);
+            if (result.written == 0) {
+                firstEpoch = p.epoch;
+            }
+            tail = next;
+            lastEpoch = p.epoch;
+            ++result.written;
+        }
+    });
+    if (result.written == 0) {
+        return result;
+    }
+
+    // Whole chunk to a temporary name, one sync, then into the ring: a
+    // power cut leaves a .tmp (no chunk name; the re-run rewrites it).
+    const std::string name = chunkName(firstEpoch, delta, false);
+    const std::string path = dir + "/" + name;
+    const std::string tmp = path + ".tmp";
+    FILE* file = std::fopen(tmp.c_str(), "wb");
+    bool ok = file != nullptr;
+    if (ok) {
+        ok = std::fwrite(frameScratch_.data(), 1, frameScratch_.size(), file) ==
+                 frameScratch_.size() &&
+             syncCounted(file);
+        ok = (std::fclose(file) == 0) && ok;
+    }
+    ok = ok && std::rename(tmp.c_str(), path.c_str()) == 0;
+    if (!ok) {
+        std::remove(tmp.c_str());
+        statsCached_ = false;  // partial bytes: resync on next read
+        result.written = 0;
+        result.ok = false;
+        return result;
+    }
+    ++writes_.filesCreated;
+    noteAppended(static_cast<long>(frameScratch_.size()));
+    if (options_.chunkSummaries && ceiled) {
+        writeChunkSummary(id, name, firstEpoch);  // sealed: a newer chunk follows
+    }
+    for (std::size_t i = 0; i < excess; ++i) {
+        if (!evictChunk(id, chunks[i].name)) {
+            result.ok = false;
+            break;
+        }
+    }
+    // The files changed under the caches: re-derived on next use.
+    state_[id].indexed = false;
+    forgetRecent(id);
+    return result;
+}
+
+bool LittleFsDataStorage::rowFormat() const
+{
+    return options_.historyFormat == HistoryFormat::Rows;
+}
+
+bool LittleFsDataStorage::muxFormat() const
+{
+    return options_.historyFormat == HistoryFormat::Multiplexed;
+}
+
+bool LittleFsDataStorage::sharedLayout() const { return rowFormat() || muxFormat(); }
+
+std::string LittleFsDataStorage::rowsDir() const { return basePath_ + "/rows"; }
+
+std::string LittleFsDataStorage::muxDir() const { return basePath_ + "/mux"; }
+
+std::string LittleFsDataStorage::sharedDir() const
+{
+    return muxFormat() ? muxDir() : rowsDir();
+}
+
+std::size_t LittleFsDataStorage::metricBudget() const
+{
+    return muxFormat() ? kMuxMaxMetrics : kMaxMetrics;
+}
+
+std::size_t LittleFsDataStorage::commitShared(const MetricSample* samples,
+                                              std::size_t count)
+{
+    return muxFormat() ? commitMux(samples, count) : commitRows(samples, count);
+}
+
+int LittleFsDataStorage::rowSlot(const std::string& metric, bool assign)
+{
+    const std::string tablePath = sharedDir() + "/metrics";
+    if (!rowSlotsLoaded_) {
+        long validBytes = 0;
+        rowSlots_ = parseSlotTable(tablePath, validBytes);
+        const long size = fileSize(tablePath);
+        if (size > validBytes) {
+            if (::truncate(tablePath.c_str(), validBytes) != 0) {
+                return -1;  // torn name append that cannot be repaired
+            }
+            noteRepaired(size - validBytes);
+        }
+        rowSlotsLoaded_ = true;
+    }
+    for (std::size_t i = 0; i < rowSlots_.size(); ++i) {
+        if (rowSlots_[i] == metric) {
+            return static_cast<int>(i);
+        }
+    }
+    // A name holding the table's line separator cannot be stored.
+    if (!assign || metric.find('\n') != std::string::npos ||
+        rowSlots_.size() >= metricBudget()) {
+        return -1;  // budget guard: one distinct metric too many rejected
+    }
+    if (!ensureDir(basePath_) || !ensureDir(sharedDir())) {
+        return -1;
+    }
+    // The name is durable BEFORE any row sets its bit, so every committed
+    // row always decodes against the table.
+    FILE* file = std::fopen(tablePath.c_str(), "ab");
+    if (file == nullptr) {
+        return -1;
+    }
+    const std::string line = metric + "\n";
+    bool ok = std::fwrite(line.data(), 1, line.size(), file) == line.size() &&
+              syncCounted(file);
+    ok = (std::fclose(file) == 0) && ok;
+    if (!ok) {
+        rowSlotsLoaded_ = false;  // re-derive (and repair) on next use
+        statsCached_ = false;
+        return -1;
+    }
+    noteAppended(static_cast<long>(line.size()));
+    rowSlots_.push_back(metric);
+    return static_cast<int>(rowSlots_.size() - 1);
+}
+
+bool LittleFsDataStorage::loadRowIndex()
+{
+    if (!ensureDir(basePath_) || !ensureDir(rowsDir())) {
+        return false;
+    }
+    rowIndex_ = ChunkIndex{};
+    const std::vector<ChunkRef> chunks = listChunks(rowsDir());
+    if (chunks.empty()) {
+        return true;
+    }
+    const std::string activePath = rowsDir() + "/" + chunks.back().name;
+    const long validBytes = scanRowChunk(activePath, [](const Row&) { return true; });
+    const long size = fileSize(activePath);
+    if (size < 0) {
+        return false;
+    }
+    if (size > validBytes) {
+        // Repair a torn tail (power loss mid-append) so the next row lands
+        // on a frame boundary.
+        if (::truncate(activePath.c_str(), validBytes) != 0) {
+            return false;
+        }
+        noteRepaired(size - validBytes);
+    }
+    rowIndex_.names.reserve(chunks.size());
+    for (const ChunkRef& chunk : chunks) {
+        rowIndex_.names.push_back(chunk.name);
+    }
+    rowIndex_.newestFirstEpoch = chunks.back().firstEpoch;
+    rowIndex_.activeSize = validBytes;
+    return true;
+}
+
+bool LittleFsDataStorage::loadMuxIndex()
+{
+    if (!ensureDir(basePath_) || !ensureDir(muxDir())) {
+        return false;
+    }
+    rowIndex_ = ChunkIndex{};
+    muxActive_ = MuxSummary{};
+    muxActiveSealed_ = false;
+    const std::vector<ChunkRef> chunks = listChunks(muxDir());
+    if (chunks.empty()) {
+        return true;
+    }
+    const std::string activePath = muxDir() + "/" + chunks.back().name;
+    const long validBytes = scanMuxChunk(
+        activePath, muxActiveSealed_,
+        [&](uint32_t epoch, const uint8_t* entries, std::size_t count) {
+            uint64_t slots = 0;
+            for (std::size_t i = 0; i < count; ++i) {
+                slots |= uint64_t{1} << entries[i * kMuxEntryBytes];
+            }
+            noteMuxFrame(muxActive_, slots, epoch);
+            return true;
+        });
+    const long size = fileSize(activePath);
+    if (size < 0) {
+        return false;
+    }
+    if (size > validBytes) {
+        // Repair a torn tail (a frame or the footer cut by power loss) so
+        // the next frame lands on a frame boundary.
+        if (::truncate(activePath.c_str(), validBytes) != 0) {
+            return false;
+        }
+        noteRepaired(size - validBytes);
+    }
+    rowIndex_.names.reserve(chunks.size());
+    for (const ChunkRef& chunk : chunks) {
+        rowIndex_.names.push_back(chunk.name);
+    }
+    rowIndex_.newestFirstEpoch = chunks.back().firstEpoch;
+    rowIndex_.activeSize = validBytes;
+    return true;
+}
+
+std::size_t LittleFsDataStorage::commitRows(const MetricSample* samples,
+                                            std::size_t count)
+{
+    // Resolve every sample's slot first; a rejected sample (unregistered
+    // id, over the metric budget) is skipped, the rest still land.
+    constexpr int kSkip = -1;
+    rowSlotScratch_.assign(count, kSkip);
+    for (std::size_t i = 0; i < count; ++i) {
+        if (metrics_.contains(samples[i].metric)) {
+            rowSlotScratch_[i] =
+                rowSlot(metrics_.name(samples[i].metric), /*assign=*/true);
+        }
+    }
+    if (!rowIndexLoaded_ || !options_.cacheChunkIndex) {
+        rowIndexLoaded_ = loadRowIndex();
+        if (!rowIndexLoaded_) {
+            return 0;
+        }
+    }
+
+    std::size_t stored = 0;
+    std::size_t unsynced = 0;
+    FILE* file = nullptr;
+    // Durable once counted: flush stdio, then sync to flash — once per
+    // chunk file touched, not once per row.
+    auto syncAndClose = [&]() -> bool {
+        bool ok = syncCounted(file);
+        ok = (std::fclose(file) == 0) && ok;
+        file = nullptr;
+        if (ok) {
+            stored += unsynced;
+        }
+        unsynced = 0;
+        return ok;
+    };
+    auto fail = [&]() -> std::size_t {
+        if (file != nullptr) {
+            std::fclose(file);
+        }
+        rowIndexLoaded_ = false;  // re-derive from the files next time
+        statsCached_ = false;
+        return stored;
+    };
+
+    uint8_t row[kRowHeaderBytes + 4 * kMaxMetrics];
+    uint16_t touched = 0;  // slots written by this call
+    uint32_t newestBySlot[kMaxMetrics] = {};
+    for (std::size_t i = 0; i < count; ++i) {
+        if (rowSlotScratch_[i] < 0) {
+            continue;  // rejected, or already placed in an earlier row
+        }
+        // One row per distinct epoch: gather the not-yet-placed readings at
+        // this epoch; a metric seen twice at one epoch starts another row.
+        const uint32_t epoch = samples[i].epoch;
+        uint16_t mask = 0;
+        float bySlot[kMaxMetrics] = {};
+        std::size_t members = 0;
+        for (std::size_t j = i; j < count; ++j) {
+            const int slot = rowSlotScratch_[j];
+            if (slot < 0 || samples[j].epoch != epoch ||
+                (mask & (1u << slot)) != 0) {
+                continue;
+            }
+            mask = static_cast<uint16_t>(mask | (1u << slot));
+            bySlot[slot] = samples[j].value;
+            newestBySlot[slot] = std::max(newestBySlot[slot], epoch);
+            rowSlotScratch_[j] = kSkip;
+            ++members;
+        }
+        row[0] = kRowMarker;
+        for (int b = 0; b < 4; ++b) {
+            row[1 + b] = static_cast<uint8_t>((epoch >> (8 * b)) & 0xFF);
+        }
+        row[5] = static_cast<uint8_t>(mask & 0xFF);
+        row[6] = static_cast<uint8_t>(mask >> 8);
+        std::size_t rowBytes = kRowHeaderBytes;
+        for (std::size_t slot = 0; slot < kMaxMetrics; ++slot) {
+            if ((mask & (1u << slot)) != 0) {
+                uint8_t record[kHistoryRecordBytes];
+                encodeRecord(record, 0, bySlot[slot]);
+                std::memcpy(row + rowBytes, record + 4, 4);
+                rowBytes += 4;
+            }
+        }
+
+        ChunkIndex& index = rowIndex_;
+        if (index.names.empty() ||
+            static_cast<std::size_t>(index.activeSize) + rowBytes >
+                kRowChunkMaxBytes) {
+            // Sealed: the row would push the chunk past 8 KiB.
+            if (file != nullptr && !syncAndClose()) {
+                return fail();
+            }
+            if (index.names.size() >= kRowMaxChunks) {
+                const std::string oldest = rowsDir() + "/" + index.names.front();
+                if (!removeCounted(oldest)) {
+                    return fail();
+                }
+                forgetRecent(metric::kInvalid);
+                index.names.erase(index.names.begin());
+            }
+            // Same naming rule as the per-metric chunks (strictly
+            // increasing names, non-monotonic epochs bumped past).
+            uint32_t chunkEpoch = epoch;
+            if (!index.names.empty() && chunkEpoch <= index.newestFirstEpoch) {
+                chunkEpoch = index.newestFirstEpoch + 1;
+            }
+            index.names.push_back(std::to_string(chunkEpoch) + ".dat");
+            ++writes_.filesCreated;
+            index.newestFirstEpoch = chunkEpoch;
+            index.activeSize = 0;
+        }
+        if (file == nullptr) {
+            file = std::fopen((rowsDir() + "/" + index.names.back()).c_str(),
+                              "ab");
+            if (file == nullptr) {
+                return fail();
+            }
+        }
+        if (std::fwrite(row, 1, rowBytes, file) != rowBytes) {
+            return fail();
+        }
+        noteAppended(static_cast<long>(rowBytes));
+        index.activeSize += static_cast<long>(rowBytes);
+        unsynced += members;
+        touched = static_cast<uint16_t>(touched | mask);
+    }
+    if (file != nullptr && !syncAndClose()) {
+        return fail();
+    }
+    for (std::size_t slot = 0; options_.rollups && slot < kMaxMetrics; ++slot) {
+        if ((touched & (1u << slot)) != 0) {
+            rollupsAfterCommit(resolveMetric(rowSlots_[slot]), newestBySlot[slot]);
+        }
+    }
+    return stored;
+}
+
+void LittleFsDataStorage::noteMuxFrame(MuxSummary& summary, uint64_t slots,
+                                       uint32_t epoch)
+{
+    if (summary.presence == 0) {
+        summary.minEpoch = epoch;
+        summary.maxEpoch = epoch;
+    } else {
+        summary.minEpoch = std::min(summary.minEpoch, epoch);
+        summary.maxEpoch = std::max(summary.maxEpoch, epoch);
+    }
+    summary.presence |= slots;
+}
+
+std::size_t LittleFsDataStorage::commitMux(const MetricSample* samples,
+                                           std::size_t count)
+{
+    // commitRows() with an id column: slots first (a rejected sample is
+    // skipped), one frame per distinct epoch, one fsync per chunk touched.
+    constexpr int kSkip = -1;
+    rowSlotScratch_.assign(count, kSkip);
+    for (std::size_t i = 0; i < count; ++i) {
+        if (metrics_.contains(samples[i].metric)) {
+            rowSlotScratch_[i] =
+                rowSlot(metrics_.name(samples[i].metric), /*assign=*/true);
+        }
+    }
+    if (!rowIndexLoaded_ || !options_.cacheChunkIndex) {
+        rowIndexLoaded_ = loadMuxIndex();
+        if (!rowIndexLoaded_) {
+            return 0;
+        }
+    }
+
+    std::size_t stored = 0;
+    std::size_t unsynced = 0;
+    FILE* file = nullptr;
+    auto syncAndClose = [&]() -> bool {
+        bool ok = syncCounted(file);
+        ok = (std::fclose(file) == 0) && ok;
+        file = nullptr;
+        if (ok) {
+            stored += unsynced;
+        }
+        unsynced = 0;
+        return ok;
+    };
+    auto fail = [&]() -> std::size_t {
+        if (file != nullptr) {
+            std::fclose(file);
+        }
+        rowIndexLoaded_ = false;  // re-derive from the files next time
+        statsCached_ = false;
+        return stored;
+    };
+    const std::string dir = muxDir();
+
+    uint8_t frame[kMuxFrameHeaderBytes + kMuxEntryBytes * kMuxMaxMetrics];
+    uint64_t touched = 0;  // slots written by this call
+    uint32_t newestBySlot[kMuxMaxMetrics] = {};
+    for (std::size_t i = 0; i < count; ++i) {
+        if (rowSlotScratch_[i] < 0) {
+            continue;  // rejected, or already placed in an earlier frame
+        }
+        const uint32_t epoch = samples[i].epoch;
+        uint64_t slots = 0;
+        std::size_t members = 0;
+        std::size_t frameBytes = kMuxFrameHeaderBytes;
+        for (std::size_t j = i; j < count; ++j) {
+            const int slot = rowSlotScratch_[j];
+            if (slot < 0 || samples[j].epoch != epoch ||
+                (slots & (uint64_t{1} << slot)) != 0) {
+                continue;
+            }
+            slots |= uint64_t{1} << slot;
+            uint8_t record[kHistoryRecordBytes];
+            encodeRecord(record, 0, samples[j].value);
+            frame[frameBytes] = static_cast<uint8_t>(slot);
+            std::memcpy(frame + frameBytes + 1, record + 4, 4);
+            frameBytes += kMuxEntryBytes;
+            newestBySlot[slot] = std::max(newestBySlot[slot], epoch);
+            rowSlotScratch_[j] = kSkip;
+            ++members;
+        }
+        frame[0] = kMuxMarker;
+        for (int b = 0; b < 4; ++b) {
+            frame[1 + b] = static_cast<uint8_t>((epoch >> (8 * b)) & 0xFF);
+        }
+        frame[5] = static_cast<uint8_t>(members);
+
+        ChunkIndex& index = rowIndex_;
+        if (index.names.empty() || muxActiveSealed_ ||
+            static_cast<std::size_t>(index.activeSize) + frameBytes + kMuxFooterBytes >
+                kRowChunkMaxBytes) {
+            // Sealed: room is always kept for the footer, and the footer is
+            // durable before the successor exists, so only the newest chunk
+            // can lack one.
+            if (!index.names.empty() && !muxActiveSealed_) {
+                if (file == nullptr) {
+                    file = std::fopen((dir + "/" + index.names.back()).c_str(), "ab");
+                    if (file == nullptr) {
+                        return fail();
+                    }
+                }
+                MuxFooterBytes footer;
+                encodeMuxFooter(footer, muxActive_.presence, muxActive_.minEpoch,
+                                muxActive_.maxEpoch);
+                if (std::fwrite(footer, 1, sizeof(footer), file) != sizeof(footer)) {
+                    return fail();
+                }
+                noteAppended(static_cast<long>(sizeof(footer)));
+            }
+            if (file != nullptr && !syncAndClose()) {
+                return fail();
+            }
+            if (index.names.size() >= kRowMaxChunks) {
+                const std::string& oldestName = index.names.front();
+                if (!removeCounted(dir + "/" + oldestName)) {
+                    return fail();
+                }
+                forgetRecent(metric::kInvalid);
+                muxFooters_.erase(std::remove_if(muxFooters_.begin(), muxFooters_.end(),
+                                                 [&](const MuxSummary& cached) {
+                                                     return cached.name == oldestName;
+                                                 }),
+                                  muxFooters_.end());
+                index.names.erase(index.names.begin());
+            }
+            uint32_t chunkEpoch = epoch;
+            if (!index.names.empty() && chunkEpoch <= index.newestFirstEpoch) {
+                chunkEpoch = index.newestFirstEpoch + 1;
+            }
+            index.names.push_back(std::to_string(chunkEpoch) + ".dat");
+            ++writes_.filesCreated;
+            index.newestFirstEpoch = chunkEpoch;
+            index.activeSize = 0;
+            muxActive_ = MuxSummary{};
+            muxActiveSealed_ = false;
+        }
+        if (file == nullptr) {
+            file = std::fopen((dir + "/" + index.names.back()).c_str(), "ab");
+            if (file == nullptr) {
+                return fail();
+            }
+        }
+        if (std::fwrite(frame, 1, frameBytes, file) != frameBytes) {
+            return fail();
+        }
+        noteAppended(static_cast<long>(frameBytes));
+        index.activeSize += static_cast<long>(frameBytes);
+        noteMuxFrame(muxActive_, slots, epoch);
+        unsynced += members;
+        touched |= slots;
+    }
+    if (file != nullptr && !syncAndClose()) {
+        return fail();
+    }
+    for (std::size_t slot = 0; options_.rollups && slot < kMuxMaxMetrics; ++slot) {
+        if ((touched & (uint64_t{1} << slot)) != 0) {
+            rollupsAfterCommit(resolveMetric(rowSlots_[slot]), newestBySlot[slot]);
+        }
+    }
+    return stored;
+}
+
+bool LittleFsDataStorage::visitRows(const std::string& metric, uint32_t t0,
+                                    uint32_t t1, IReadingVisitor& visitor) const
+{
+    long validBytes = 0;
+    const std::vector<std::string> slots =
+        parseSlotTable(rowsDir() + "/metrics", validBytes);
+    const auto found = std::find(slots.begin(), slots.end(), metric);
+    if (found == slots.end()) {
+        return true;  // never stored: empty, not an error
+    }
+    const unsigned slot = static_cast<unsigned>(found - slots.begin());
+    const uint16_t bit = static_cast<uint16_t>(1u << slot);
+    const uint16_t below = static_cast<uint16_t>(bit - 1);
+    bool more = true;
+    for (const ChunkRef& chunk : listChunks(rowsDir())) {
+        scanRowChunk(rowsDir() + "/" + chunk.name, [&](const Row& row) {
+            if ((row.mask & bit) != 0 && row.epoch >= t0 && row.epoch <= t1) {
+                more = visitor.onReading(row.epoch,
+                                         row.values[countBits(row.mask & below)]);
+            }
+            return more;
+        });
+        if (!more) {
+            break;
+        }
+    }
+    return more;
+}
+
+bool LittleFsDataStorage::muxFooter(const std::string& name, MuxSummary& out) const
+{
+    for (const MuxSummary& cached : muxFooters_) {
+        if (cached.name == name) {
+            out = cached;
+            return true;
+        }
+    }
+    FILE* file = std::fopen((muxDir() + "/" + name).c_str(), "rb");
+    if (file == nullptr) {
+        return false;
+    }
+    MuxFooterBytes footer;
+    const bool read =
+        std::fseek(file, -static_cast<long>(sizeof(footer)), SEEK_END) == 0 &&
+        std::fread(footer, 1, sizeof(footer), file) == sizeof(footer);
+    std::fclose(file);
+    MuxSummary summary;
+    summary.name = name;
+    if (!read ||
+        !decodeMuxFooter(footer, summary.presence, summary.minEpoch, summary.maxEpoch)) {
+        return false;
+    }
+    muxFooters_.push_back(summary);
+    out = summary;
+    return true;
+}
+
+bool LittleFsDataStorage::visitMux(const std::string& metric, uint32_t t0,
+                                   uint32_t t1, IReadingVisitor& visitor) const
+{
+    long validBytes = 0;
+    const std::vector<std::string> slots =
+        parseSlotTable(muxDir() + "/metrics", validBytes);
+    const auto found = std::find(slots.begin(), slots.end(), metric);
+    if (found == slots.end()) {
+        return true;  // never stored: empty, not an error
+    }
+    const uint8_t slot = static_cast<uint8_t>(found - slots.begin());
+    const uint64_t bit = uint64_t{1} << slot;
+    const std::vector<ChunkRef> chunks = listChunks(muxDir());
+    bool more = true;
+    for (std::size_t i = 0; i < chunks.size() && more; ++i) {
+        // A sealed chunk whose footer rules the metric or the window out
+        // is skipped unopened (after its footer's first read).
+        MuxSummary footer;
+        if (i + 1 < chunks.size() && muxFooter(chunks[i].name, footer) &&
+            ((footer.presence & bit) == 0 || footer.maxEpoch < t0 ||
+             footer.minEpoch > t1)) {
+            continue;
+        }
+        bool sealed = false;
+        scanMuxChunk(muxDir() + "/" + chunks[i].name, sealed,
+                     [&](uint32_t epoch, const uint8_t* entries, std::size_t count) {
+                         if (epoch < t0 || epoch > t1) {
+                             return true;
+                         }
+                         for (std::size_t k = 0; k < count; ++k) {
+                             if (entries[k * kMuxEntryBytes] == slot) {
+                                 more = visitor.onReading(
+                                     epoch, decodeFloatLe(entries + k * kMuxEntryBytes + 1));
+                                 break;
+                             }
+                         }
+                         return more;
+                     });
+    }
+    return more;
+}
+
+std::vector<SensorReading> LittleFsDataStorage::getSensorReadings(
+    const std::string& metric, uint32_t t0, uint32_t t1) const
+{
+    std::vector<SensorReading> result;
+    ReadingCallback collect([&](uint32_t epoch, float value) {
+        result.push_back(SensorReading{metric, epoch, value});
+        return true;
+    });
+    LittleFsDataStorage::forEachReading(metric, t0, t1, collect);
+    return result;
+}
+
+std::size_t LittleFsDataStorage::forEachReading(const std::string& metric,
+                                                uint32_t t0, uint32_t t1,
+                                                IReadingVisitor& visitor) const
+{
+    return visitWindow(metric, t0, t1, visitor, nullptr);
+}
+
+std::size_t LittleFsDataStorage::visitWindow(const std::string& metric, uint32_t t0,
+                                             uint32_t t1, IReadingVisitor& visitor,
+                                             SummaryVisitor* summaries) const
+{
+    std::size_t visited = 0;
+    ReadingCallback counted([&](uint32_t epoch, float value) {
+        ++visited;
+        return visitor.onReading(epoch, value);
+    });
+    const RecentRing* ring = t0 <= t1 ? recentOf(metric) : nullptr;
+    if (ring != nullptr && recentCovers(*ring, t0)) {
+        // The whole window is in RAM (buffered readings included): no file
+        // is opened. Binary search for t0, as in the first chunk read.
+        const std::size_t cap = ring->slots.size();
+        auto at = [&](std::size_t i) -> const HistoryRecord& {
+            return ring->slots[(ring->head + i) % cap];
+        };
+        std::size_t lo = 0;
+        std::size_t hi = ring->size;
+        while (lo < hi) {
+            const std::size_t mid = lo + (hi - lo) / 2;
+            if (at(mid).epoch < t0) {
+                lo = mid + 1;
+            } else {
+                hi = mid;
+            }
+        }
+        for (std::size_t i = lo; i < ring->size; ++i) {
+            const HistoryRecord& record = at(i);
+            if (record.epoch > t1 || !counted.onReading(record.epoch, record.value)) {
+                break;
+            }
+        }
+        return visited;
+    }
+    if (!visitCommitted(metric, t0, t1, counted, summaries)) {
+        return visited;
+    }
+    if (t0 > t1 || !isValidMetricName(metric)) {
+        return visited;  // contract: empty, never an error
+    }
+    // Group commit: buffered readings are newer than every committed one
+    // (append order) and must be visible before they are durable.
+    if (const std::vector<HistoryRecord>* pending = pendingOf(metric)) {
+        for (const HistoryRecord& record : *pending) {
+            if (record.epoch >= t0 && record.epoch <= t1 &&
+                !counted.onReading(record.epoch, record.value)) {
+                break;
+            }
+        }
+    }
+    return visited;
+}
+
+const LittleFsDataStorage::RecentRing*
+LittleFsDataStorage::recentOf(const std::string& metric) const
+{
+    if (options_.recentReadings == 0) {
+        return nullptr;
+    }
+    const MetricId id = metrics_.find(metric);
+    if (id == metric::kInvalid) {
+        return nullptr;
+    }
+    if (recent_.size() <= id) {
+        recent_.resize(state_.size());
+    }
+    RecentRing& ring = recent_[id];
+    if (!ring.seeded && !ring.retired) {
+        // One pass over the metric's history (then its buffered readings),
+        // keeping the newest: later reads of it stay in RAM.
+        ring.slots.resize(options_.recentReadings);
+        ring.head = 0;
+        ring.size = 0;
+        ring.complete = true;
+        ReadingCallback seed([&](uint32_t epoch, float value) {
+            pushRecent(ring, HistoryRecord{epoch, value});
+            return !ring.retired;
+        });
+        if (visitCommitted(metric, 0, UINT32_MAX, seed)) {
+            for (const HistoryRecord& record : state_[id].pending) {
+                if (!seed.onReading(record.epoch, record.value)) {
+                    break;
+                }
+            }
+        }
+        ring.seeded = !ring.retired;
+    }
+    if (ring.retired) {
+        std::vector<HistoryRecord>().swap(ring.slots);
+        return nullptr;
+    }
+    return &ring;
+}
+
+bool LittleFsDataStorage::recentCovers(const RecentRing& ring, uint32_t t0)
+{
+    // Everything pushed out is no newer than the oldest kept reading.
+    return ring.complete || (ring.size != 0 && ring.slots[ring.head].epoch < t0);
+}
+
+void LittleFsDataStorage::pushRecent(RecentRing& ring, const HistoryRecord& record)
+{
+    const std::size_t cap = ring.slots.size();
+    if (ring.size != 0 &&
+        record.epoch < ring.slots[(ring.head + ring.size - 1) % cap].epoch) {
+        // Out of order, the ring can no longer tell which readings are the
+        // newest nor what it covers.
+        ring.retired = true;
+        ring.seeded = false;
+        return;
+    }
+    if (ring.size < cap) {
+        ring.slots[(ring.head + ring.size) % cap] = record;
+        ++ring.size;
+    } else {
+        ring.slots[ring.head] = record;
+        ring.head = (ring.head + 1) % cap;
+        ring.complete = false;
+    }
+}
+
+void LittleFsDataStorage::noteRecent(MetricId metric, const HistoryRecord& record)
+{
+    if (metric < recent_.size() && recent_[metric].seeded) {
+        pushRecent(recent_[metric], record);
+    }
+}
+
+void LittleFsDataStorage::reloadFromFiles()
+{
+    for (MetricState& state : state_) {
+        state.index = ChunkIndex{};
+        state.indexed = false;
+        state.pending.clear();
+        state.buffered = false;
+        state.rollupLoaded = false;
+        state.rollupDue = false;
+    }
+    pendingCount_ = 0;
+    eventTailCached_ = false;
+    rowSlots_.clear();
+    rowSlotsLoaded_ = false;
+    rowIndexLoaded_ = false;
+    muxActive_ = MuxSummary{};
+    muxActiveSealed_ = false;
+    muxFooters_.clear();
+    chunkCache_.clear();
+    chunkCacheUsed_ = 0;
+    forgetRecent(metric::kInvalid);
+    scrubMetric_.clear();
+    compactMetric_.clear();
+    compactSkipped_.clear();
+    statsCached_ = false;
+}
+
+void LittleFsDataStorage::forgetRecent(MetricId metric)
+{
+    for (MetricId id = 0; id < recent_.size(); ++id) {
+        if (metric == metric::kInvalid || id == metric) {
+            recent_[id].seeded = false;
+        }
+    }
+}
+
+LatestReading LittleFsDataStorage::latestReading(const std::string& metric) const
+{
+    const RecentRing* ring = recentOf(metric);
+    if (ring == nullptr) {
+        return IDataStorage::latestReading(metric);
+    }
+    LatestReading latest;
+    if (ring->size != 0) {
+        const HistoryRecord& newest =
+            ring->slots[(ring->head + ring->size - 1) % ring->slots.size()];
+        latest.found = true;
+        latest.epoch = newest.epoch;
+        latest.value = newest.value;
+    }
+    return latest;
+}
+
+std::vector<SensorReading> LittleFsDataStorage::getLatestReadings(const std::string& metric,
+                                                                  std::size_t n) const
+{
+    std::vector<SensorReading> result;
+    if (n == 0 || !isValidMetricName(metric)) {
+        return result;
+    }
+    if (const RecentRing* ring = recentOf(metric)) {
+        if (ring->complete || ring->size >= n) {
+            const std::size_t take = n < ring->size ? n : ring->size;
+            result.reserve(take);
+            for (std::size_t i = ring->size - take; i < ring->size; ++i) {
+                const HistoryRecord& record =
+                    ring->slots[(ring->head + i) % ring->slots.size()];
+                result.push_back(SensorReading{metric, record.epoch, record.value});
+            }
+            return result;
+        }
+    }
+    if (rowFormat() || muxFormat()) {
+        return IDataStorage::getLatestReadings(metric, n);
+    }
+
+    // Newest first, reversed at the end. A read delivers the committed
+    // chunks in order and then the buffered readings, so its tail is the
+    // buffer's tail, then each chunk's from the newest chunk back.
+    std::vector<HistoryRecord> newest;
+    if (const std::vector<HistoryRecord>* pending = pendingOf(metric)) {
+        for (auto it = pending->rbegin(); it != pending->rend() && newest.size() < n; ++it) {
+            newest.push_back(*it);
+        }
+    }
+    const std::string dir = metricDir(metric);
+    const std::vector<ChunkRef> chunks = listChunks(dir);
+    std::vector<HistoryRecord> decoded;
+    for (std::size_t i = chunks.size(); i-- > 0 && newest.size() < n;) {
+        const std::string path = dir + "/" + chunks[i].name;
+        const std::size_t want = n - newest.size();
+        const CachedRecords* records =
+            cachedChunk(path, chunks[i].delta, i + 1 < chunks.size());
+        if (records != nullptr) {
+            for (auto it = records->rbegin(); it != records->rend() && newest.size() < n; ++it) {
+                newest.push_back(*it);
+            }
+            continue;
+        }
+        decoded.clear();
+        auto collect = [&](uint32_t epoch, float value) {
+            decoded.push_back(HistoryRecord{epoch, value});
+            return true;
+        };
+        withCodec(chunks[i].delta, [&](auto codec) {
+            decltype(codec)::scanNewest(path, readScratch_, want, collect);
+        });
+        for (auto it = decoded.rbegin(); it != decoded.rend() && newest.size() < n; ++it) {
+            newest.push_back(*it);
+        }
+    }
+    result.reserve(newest.size());
+    for (auto it = newest.rbegin(); it != newest.rend(); ++it) {
+        result.push_back(SensorReading{metric, it->epoch, it->value});
+    }
+    return result;
+}
+
+bool LittleFsDataStorage::visitCommitted(const std::string& metric,
+                                         uint32_t t0, uint32_t t1,
+                                         IReadingVisitor& visitor,
+                                         SummaryVisitor* summaries) const
+{
+    if (t0 > t1 || !isValidMetricName(metric)) {
+        return true;
+    }
+    if (rowFormat()) {
+        return visitRows(metric, t0, t1, visitor);
+    }
+    if (muxFormat()) {
+        return visitMux(metric, t0, t1, visitor);
+    }
+    const std::string dir = metricDir(metric);
+    const std::vector<ChunkRef> chunks = listChunks(dir);
+    // Ascending records (no unordered chunk): chunk i holds nothing
+    // newer than chunk i+1's filename epoch, so chunks ending before
+    // t0 are skipped unopened and the scan stops past t1. Otherwise
+    // every chunk is scanned and filtered per record.
+    const bool ordered =
+        std::none_of(chunks.begin(), chunks.end(),
+                     [](const ChunkRef& chunk) { return chunk.unordered; });
+    std::size_t first = 0;
+    while (ordered && first + 1 < chunks.size() &&
+           chunks[first + 1].firstEpoch < t0) {
+        ++first;
+    }
+    bool pastEnd = false;
+    bool more = true;
+    // One reading of the scan: false ends it (past t1, or the visitor).
+    auto deliver = [&](uint32_t epoch, float value) {
+        if (ordered && epoch > t1) {
+            pastEnd = true;
+            return false;
+        }
+        if (epoch >= t0 && epoch <= t1) {
+            more = visitor.onReading(epoch, value);
+        }
+        return more;
+    };
+    for (std::size_t i = first; i < chunks.size() && !pastEnd && more; ++i) {
+        if (ordered && chunks[i].firstEpoch > t1) {
+            break;  // named after its first record: wholly past the window
+        }
+        const bool sealed = i + 1 < chunks.size();
+        // A sealed chunk wholly inside the window may be taken from its
+        // summary. Ordered history only: the chunk's records then sit
+        // between its neighbours', so the fold stays chronological. The
+        // names bound its span well enough to skip hopeless summary reads.
+        ChunkSummary summary;
+        if (summaries != nullptr && ordered && sealed &&
+            chunks[i].firstEpoch >= t0 && chunks[i + 1].firstEpoch <= t1 &&
+            summaries->wants(chunks[i].firstEpoch, chunks[i + 1].firstEpoch) &&
+            readChunkSummary(metric, chunks[i].firstEpoch, summary) &&
+            summary.minEpoch >= t0 && summary.maxEpoch <= t1 &&
+            summaries->takeChunk(summary)) {
+            continue;
+        }
+        if (const CachedRecords* records =
+                cachedChunk(dir + "/" + chunks[i].name, chunks[i].delta, sealed)) {
+            auto record = records->begin();
+            if (ordered && i == first) {
+                record = std::lower_bound(
+                    records->begin(), records->end(), t0,
+                    [](const HistoryRecord& r, uint32_t epoch) { return r.epoch < epoch; });
+            }
+            for (; record != records->end(); ++record) {
+                if (!deliver(record->epoch, record->value)) {
+                    break;
+                }
+            }
+            continue;
+        }
+        withCodec(chunks[i].delta, [&](auto codec) {
+            decltype(codec)::scanWindow(dir + "/" + chunks[i].name, readScratch_,
+                                        ordered && i == first, t0, deliver);
+        });
+    }
+    return more;
+}
+
+const LittleFsDataStorage::CachedRecords*
+LittleFsDataStorage::cachedChunk(const std::string& path, bool delta,
+                                 bool sealed) const
+{
+    if (options_.chunkCacheBytes == 0) {
+        return nullptr;
+    }
+    auto entry = std::find_if(chunkCache_.begin(), chunkCache_.end(),
+                              [&](const CachedChunk& c) { return c.path == path; });
+    if (entry != chunkCache_.end()) {
+        chunkCache_.splice(chunkCache_.begin(), chunkCache_, entry);
+        if (entry->sealed) {
+            return &entry->records;
+        }
+        // Cached while active: it only grows between appends (until it is
+        // sealed, checked once more then); anything else (a torn-tail
+        // repair, an external rewrite) re-decodes it.
+        const long size = fileSize(path);
+        const long whole = withCodec(
+            delta, [&](auto codec) { return decltype(codec)::wholeBytes(size); });
+        if (whole < entry->validBytes) {
+            chunkCacheUsed_ -= entry->records.size() * sizeof(HistoryRecord);
+            entry->records.clear();
+            entry->validBytes = 0;
+            entry->tail = deltachunk::State{};
+        }
+        if (whole == entry->validBytes) {
+            entry->sealed = sealed;
+            return &entry->records;
+        }
+    } else {
+        chunkCache_.push_front(CachedChunk{});
+        entry = chunkCache_.begin();
+        entry->path = path;
+    }
+    entry->sealed = sealed;
+    const std::size_t before = entry->records.size();
+    const bool ok = extendCachedChunk(*entry, delta);
+    chunkCacheUsed_ += (entry->records.size() - before) * sizeof(HistoryRecord);
+    const std::size_t bytes = entry->records.size() * sizeof(HistoryRecord);
+    if (!ok || bytes > options_.chunkCacheBytes) {
+        chunkCacheUsed_ -= bytes;
+        chunkCache_.erase(entry);
+        return nullptr;
+    }
+    // Least recently read first out; `entry` is at the front.
+    while (chunkCacheUsed_ > options_.chunkCacheBytes) {
+        chunkCacheUsed_ -= chunkCache_.back().records.size() * sizeof(HistoryRecord);
+        chunkCache_.pop_back();
+    }
+    return &entry->records;
+}
+
+bool LittleFsDataStorage::extendCachedChunk(CachedChunk& entry, bool delta) const
+{
+    const long valid = withCodec(delta, [&](auto codec) {
+        return decltype(codec)::scan(
+            entry.path, entry.tail, readScratch_,
+            [&](uint32_t epoch, float value) {
+                entry.records.push_back(HistoryRecord{epoch, value});
+                return true;
+            },
+            entry.validBytes);
+    });
+    if (valid == kForeignChunk) {
+        return false;
+    }
+    entry.validBytes = valid;
+    return true;
+}
+
+void LittleFsDataStorage::forgetCachedChunk(const std::string& path)
+{
+    for (auto it = chunkCache_.begin(); it != chunkCache_.end(); ++it) {
+        if (it->path == path) {
+            chunkCacheUsed_ -= it->records.size() * sizeof(HistoryRecord);
+            chunkCache_.erase(it);
+            return;
+        }
+    }
+}
+
+std::string LittleFsDataStorage::rollupDir(std::size_t tier,
+                                           const std::string& metric) const
+{
+    return basePath_ + "/rollup/" + rollup::kTiers[tier].dir + "/" + metric;
+}
+
+LittleFsDataStorage::RollupRange LittleFsDataStorage::readRollup(
+    std::size_t tier, const std::string& metric, uint32_t t0,
+    uint32_t t1) const
+{
+    RollupRange range;
+    const std::string dir = rollupDir(tier, metric);
+    const std::vector<ChunkRef> chunks = listChunks(dir);
+    if (chunks.empty()) {
+        return range;  // nothing finished yet: everything comes from raw
+    }
+    range.coveredFrom = chunks.front().firstEpoch;
+    range.finishedTo = chunks.front().firstEpoch;
+    uint8_t record[rollup::kRecordBytes];
+    for (const ChunkRef& chunk : chunks) {
+        FILE* file = std::fopen((dir + "/" + chunk.name).c_str(), "rb");
+        if (file == nullptr) {
+            continue;
+        }
+        // Bucket starts ascend strictly through the ring; a torn tail is
+        // a short final read, skipped like a raw chunk's.
+        while (std::fread(record, 1, sizeof(record), file) == sizeof(record)) {
+            const SensorAggregate bucket = rollup::decode(record);
+            range.finishedTo = bucket.epoch + rollup::kTiers[tier].bucketS;
+            if (bucket.epoch >= t0 && bucket.epoch <= t1) {
+                range.buckets.push_back(bucket);
+            }
+        }
+        std::fclose(file);
+    }
+    return range;
+}
+
+void LittleFsDataStorage::updateRollups(MetricId id, uint32_t newestEpoch)
+{
+    if (id == metric::kInvalid) {
+        return;
+    }
+    const std::string& metric = metrics_.name(id);
+    MetricState& state = state_[id];
+    if (!state.rollupLoaded) {
+        for (std::size_t t = 0; t < rollup::kTierCount; ++t) {
+            // An empty tier starts at 0: the first update backfills it
+            // from whatever raw history exists.
+            state.rollupFinishedTo[t] =
+                readRollup(t, metric, 1, 0).finishedTo;  // extent only
+        }
+        state.rollupLoaded = true;
+    }
+    for (std::size_t t = 0; t < rollup::kTierCount; ++t) {
+        const uint32_t bucketS = rollup::kTiers[t].bucketS;
+        const uint32_t openStart = newestEpoch - newestEpoch % bucketS;
+        uint32_t& finishedTo = state.rollupFinishedTo[t];
+        if (finishedTo >= openStart) {
+            continue;  // still inside the open bucket (or clock went back)
+        }
+        // Every bucket before the open one is final: the clock has moved
+        // past it. Readings that arrive later with an older epoch are
+        // kept raw but never aggregated.
+        std::vector<SensorAggregate> buckets;
+        // The same pass sketches each bucket of an hour/day tier; only the
+        // newest ring-full is kept, as appendRing() would evict the rest.
+        const int sketchTier = options_.quantileSketches ? rollup::sketchTierFor(t) : -1;
+        uint32_t sketchFrom = 0;
+        if (sketchTier >= 0) {
+            const rollup::SketchTier& spec = rollup::kSketchTiers[sketchTier];
+            const uint64_t span = static_cast<uint64_t>(bucketS) * spec.maxChunks *
+                                  (spec.chunkBytes / rollup::kSketchRecordBytes);
+            sketchFrom = openStart > span ? static_cast<uint32_t>(openStart - span) : 0;
+        }
+        std::vector<uint8_t> sketches;
+        QuantileSketch sketch;
+        uint32_t sketchStart = 0;
+        auto sealSketch = [&] {
+            if (sketch.count() == 0) {
+                return;
+            }
+            sketches.resize(sketches.size() + rollup::kSketchRecordBytes);
+            rollup::encodeSketch(sketches.data() + sketches.size() - rollup::kSketchRecordBytes,
+                                 sketchStart, sketch);
+            sketch = QuantileSketch{};
+        };
+        ReadingCallback fold([&](uint32_t epoch, float value) {
+            rollup::fold(buckets, bucketS, epoch, value);
+            if (sketchTier >= 0 && epoch >= sketchFrom) {
+                const uint32_t start = epoch - epoch % bucketS;
+                if (start != sketchStart) {
+                    sealSketch();
+                    sketchStart = start;
+                }
+                sketch.add(value);
+            }
+            return true;
+        });
+        visitCommitted(metric, finishedTo, openStart - 1, fold);
+        sealSketch();
+        if (appendRollup(t, metric, buckets)) {
+            finishedTo = openStart;
+            // Best effort: a bucket whose sketch failed to land is folded
+            // from raw history by queries instead.
+            if (!sketches.empty()) {
+                const rollup::SketchTier& spec = rollup::kSketchTiers[sketchTier];
+                const std::string dir = sketchDir(static_cast<std::size_t>(sketchTier), metric);
+                if (ensureDir(basePath_ + "/rollup/" + spec.dir) && ensureDir(dir)) {
+                    appendRing(dir, spec.chunkBytes, spec.maxChunks,
+                               rollup::kSketchRecordBytes, sketches);
+                }
+            }
+        }
+    }
+}
+
+void LittleFsDataStorage::rollupsAfterCommit(MetricId metric, uint32_t newestEpoch)
+{
+    if (!options_.backgroundMaintenance) {
+        updateRollups(metric, newestEpoch);
+        return;
+    }
+    if (metric == metric::kInvalid) {
+        return;
+    }
+    MetricState& state = state_[metric];
+    state.rollupDueEpoch =
+        state.rollupDue ? std::max(state.rollupDueEpoch, newestEpoch) : newestEpoch;
+    state.rollupDue = true;
+}
+
+bool LittleFsDataStorage::appendRollup(std::size_t tier,
+                                       const std::string& metric,
+                                       const std::vector<SensorAggregate>& buckets)
+{
+    if (buckets.empty()) {
+        return true;
+    }
+    const rollup::Tier& spec = rollup::kTiers[tier];
+    const std::string tierDir =
+        basePath_ + "/rollup/" + std::string(spec.dir);
+    const std::string dir = rollupDir(tier, metric);
+    if (!ensureDir(basePath_) || !ensureDir(basePath_ + "/rollup") ||
+        !ensureDir(tierDir) || !ensureDir(dir)) {
+        return false;
+    }
+    // A backfill can finish more buckets than the ring holds: only the
+    // newest ring-full would survive eviction, so skip the rest up front.
+    const std::size_t capacity = spec.chunkBytes / rollup::kRecordBytes * spec.maxChunks;
+    const std::size_t next = buckets.size() > capacity ? buckets.size() - capacity : 0;
+    std::vector<uint8_t> records((buckets.size() - next) * rollup::kRecordBytes);
+    for (std::size_t i = next; i < buckets.size(); ++i) {
+        rollup::encode(records.data() + (i - next) * rollup::kRecordBytes, buckets[i]);
+    }
+    return appendRing(dir, spec.chunkBytes, spec.maxChunks, rollup::kRecordBytes, records);
+}
+
+bool LittleFsDataStorage::appendRing(const std::string& dir, std::size_t chunkBytes,
+                                     std::size_t maxChunks, std::size_t recordBytes,
+                                     const std::vector<uint8_t>& records)
+{
+    const std::size_t count = records.size() / recordBytes;
+    const std::size_t capacity = chunkBytes / recordBytes * maxChunks;
+    std::size_t next = count > capacity ? count - capacity : 0;
+
+    std::vector<ChunkRef> chunks = listChunks(dir);
+    long activeSize = 0;
+    if (!chunks.empty()) {
+        const std::string activePath = dir + "/" + chunks.back().name;
+        activeSize = fileSize(activePath);
+        const long torn = activeSize % static_cast<long>(recordBytes);
+        if (activeSize < 0 ||
+            (torn != 0 && ::truncate(activePath.c_str(), activeSize - torn) != 0)) {
+            return false;
+        }
+        noteRepaired(torn);
+        activeSize -= torn;
+    }
+    while (next < count) {
+        if (chunks.empty() ||
+            static_cast<std::size_t>(activeSize) + recordBytes > chunkBytes) {
+            if (chunks.size() >= maxChunks) {
+                if (!removeCounted(dir + "/" + chunks.front().name)) {
+                    return false;
+                }
+                chunks.erase(chunks.begin());
+            }
+            // Named by the first bucket start; starts ascend strictly, so
+            // names do too.
+            const uint32_t first = decodeU32Le(records.data() + next * recordBytes);
+            chunks.push_back(ChunkRef{first, std::to_string(first) + ".dat"});
+            ++writes_.filesCreated;
+            activeSize = 0;
+        }
+        const std::size_t room =
+            (chunkBytes - static_cast<std::size_t>(activeSize)) / recordBytes;
+        const std::size_t batch = std::min(room, count - next);
+        FILE* file = std::fopen((dir + "/" + chunks.back().name).c_str(), "ab");
+        if (file == nullptr) {
+            return false;
+        }
+        const std::size_t bytes = batch * recordBytes;
+        bool ok = std::fwrite(records.data() + next * recordBytes, 1, bytes, file) == bytes;
+        ok = ok && syncCounted(file);
+        ok = (std::fclose(file) == 0) && ok;
+        if (!ok) {
+            statsCached_ = false;
+            return false;
+        }
+        noteAppended(static_cast<long>(bytes));
+        activeSize += static_cast<long>(bytes);
+        next += batch;
+    }
+    return true;
+}
+
+std::string LittleFsDataStorage::sketchDir(std::size_t sketchTier,
+                                           const std::string& metric) const
+{
+    return basePath_ + "/rollup/" + rollup::kSketchTiers[sketchTier].dir + "/" + metric;
+}
+
+QuantileSketch LittleFsDataStorage::getSensorQuantiles(const std::string& metric,
+                                                       uint32_t t0, uint32_t t1) const
+{
+    if (!options_.rollups || !options_.quantileSketches) {
+        return IDataStorage::getSensorQuantiles(metric, t0, t1);
+    }
+    QuantileSketch sketch;
+    if (t0 <= t1 && isValidMetricName(metric)) {
+        sketchWindow(rollup::kSketchTierCount, metric, t0, t1, sketch);
+    }
+    return sketch;
+}
+
+void LittleFsDataStorage::sketchWindow(std::size_t level, const std::string& metric,
+                                       uint32_t t0, uint32_t t1, QuantileSketch& out) const
+{
+    if (level == 0) {
+        out.merge(IDataStorage::getSensorQuantiles(metric, t0, t1));
+        return;
+    }
+    const std::size_t sketchTier = level - 1;
+    const uint32_t bucketS = rollup::kTiers[rollup::kSketchTiers[sketchTier].tier].bucketS;
+    const std::string dir = sketchDir(sketchTier, metric);
+    const std::vector<ChunkRef> chunks = listChunks(dir);
+    // Whole buckets of the window, cut to what the ring covers: from its
+    // oldest chunk's first bucket to the end of its newest record.
+    uint64_t from = (static_cast<uint64_t>(t0) + bucketS - 1) / bucketS * bucketS;
+    uint64_t to = (static_cast<uint64_t>(t1) + 1) / bucketS * bucketS;
+    uint8_t record[rollup::kSketchRecordBytes];
+    uint32_t start = 0;
+    QuantileSketch sketch;
+    bool covered = false;
+    if (!chunks.empty()) {
+        const std::string newest = dir + "/" + chunks.back().name;
+        const long records = fileSize(newest) / static_cast<long>(sizeof(record));
+        FILE* file = records > 0 ? std::fopen(newest.c_str(), "rb") : nullptr;
+        if (file != nullptr) {
+            covered = std::fseek(file, (records - 1) * static_cast<long>(sizeof(record)),
+                                 SEEK_SET) == 0 &&
+                      std::fread(record, 1, sizeof(record), file) == sizeof(record) &&
+                      rollup::decodeSketch(record, start, sketch);
+            std::fclose(file);
+        }
+    }
+    if (covered) {
+        from = std::max<uint64_t>(from, chunks.front().firstEpoch);
+        to = std::min<uint64_t>(to, static_cast<uint64_t>(start) + bucketS);
+    }
+    if (!covered || from >= to) {
+        sketchWindow(level - 1, metric, t0, t1, out);
+        return;
+    }
+    for (std::size_t i = 0; i < chunks.size(); ++i) {
+        if (i + 1 < chunks.size() && chunks[i + 1].firstEpoch <= from) {
+            continue;  // ends before the window
+        }
+        FILE* file = std::fopen((dir + "/" + chunks[i].name).c_str(), "rb");
+        if (file == nullptr) {
+            continue;
+        }
+        while (std::fread(record, 1, sizeof(record), file) == sizeof(record)) {
+            if (rollup::decodeSketch(record, start, sketch) && start >= from && start < to) {
+                out.merge(sketch);
+            }
+        }
+        std::fclose(file);
+    }
+    // The partial buckets at both edges, and whatever the ring does not
+    // cover, one level finer.
+    if (from > t0) {
+        sketchWindow(level - 1, metric, t0, static_cast<uint32_t>(from - 1), out);
+    }
+    if (to <= t1) {
+        sketchWindow(level - 1, metric, static_cast<uint32_t>(to), t1, out);
+    }
+}
+
+std::vector<SensorAggregate> LittleFsDataStorage::getSensorAggregates(
+    const std::string& metric, uint32_t t0, uint32_t t1,
+    uint32_t bucketS) const
+{
+    const int tier = rollup::tierIndex(bucketS);
+    if (!options_.rollups || tier < 0) {
+        if (!options_.chunkSummaries || bucketS == 0 || t0 > t1) {
+            return IDataStorage::getSensorAggregates(metric, t0, t1, bucketS);
+        }
+        std::vector<SensorAggregate> result;
+        foldAggregates(metric, t0 - t0 % bucketS, t1, bucketS, result);
+        return result;
+    }
+    std::vector<SensorAggregate> result;
+    if (t0 > t1 || !isValidMetricName(metric)) {
+        return result;
+    }
+    const uint32_t from = t0 - t0 % bucketS;
+    RollupRange range = readRollup(static_cast<std::size_t>(tier), metric, from, t1);
+    auto foldRaw = [&](uint32_t a, uint32_t b) {
+        foldAggregates(metric, a, b, bucketS, result);
+    };
+    // Older than the ring (evicted, or never rolled up): raw history.
+    if (from < range.coveredFrom) {
+        foldRaw(from, std::min(t1, range.coveredFrom - 1));
+    }
+    // Finished buckets straight from the tier.
+    result.insert(result.end(), range.buckets.begin(), range.buckets.end());
+    // The open bucket (and any not yet written): raw history.
+    if (range.finishedTo <= t1) {
+        foldRaw(std::max(from, range.finishedTo), t1);
+    }
+    return result;
+}
+
+std::string LittleFsDataStorage::summaryDir(const std::string& metric) const
+{
+    return basePath_ + "/sum/" + metric;
+}
+
+bool LittleFsDataStorage::summarizeChunk(const std::string& path, bool delta,
+                                         ChunkSummary& out) const
+{
+    FILE* file = openRecordFile(path);
+    if (file == nullptr) {
+        return false;
+    }
+    readScratch_.resize(kHistoryChunkMaxBytes);
+    const std::size_t size = std::fread(readScratch_.data(), 1, readScratch_.size(), file);
+    std::fclose(file);
+    const uint8_t* bytes = readScratch_.data();
+    recordreduce::Reduction reduction;
+    const std::size_t valid = withCodec(delta, [&](auto codec) {
+        return decltype(codec)::reduce(bytes, size, reduction);
+    });
+    if (valid == 0) {
+        return false;
+    }
+    out = ChunkSummary{};
+    out.count = reduction.count;
+    out.minEpoch = reduction.minEpoch;
+    out.maxEpoch = reduction.maxEpoch;
+    out.min = reduction.min;
+    out.max = reduction.max;
+    out.sum = reduction.sum;
+    out.last = reduction.last;
+    out.bytes = static_cast<uint32_t>(valid);
+    out.crc = crc32Update(0, bytes, valid);
+    return out.count != 0;
+}
+
+void LittleFsDataStorage::writeChunkSummary(MetricId metric, const std::string& name,
+                                            uint32_t firstEpoch)
+{
+    ChunkSummary summary;
+    if (!summarizeChunk(state_[metric].dir + "/" + name, isDeltaChunk(name), summary)) {
+        return;
+    }
+    uint8_t record[kSummaryBytes];
+    uint64_t sumBits = 0;
+    std::memcpy(&sumBits, &summary.sum, sizeof(sumBits));
+    record[0] = kSummaryMarker;
+    putU32Le(record + 1, summary.count);
+    putU32Le(record + 5, summary.minEpoch);
+    putU32Le(record + 9, summary.maxEpoch);
+    putFloatLe(record + 13, summary.min);
+    putFloatLe(record + 17, summary.max);
+    putU32Le(record + 21, static_cast<uint32_t>(sumBits));
+    putU32Le(record + 25, static_cast<uint32_t>(sumBits >> 32));
+    putFloatLe(record + 29, summary.last);
+    putU32Le(record + 33, summary.bytes);
+    putU32Le(record + 37, summary.crc);
+    putU32Le(record + kSummaryCrcOffset, crc32Update(0, record, kSummaryCrcOffset));
+
+    const std::string dir = summaryDir(metrics_.name(metric));
+    if (!ensureDir(basePath_ + "/sum") || !ensureDir(dir)) {
+        return;
+    }
+    FILE* file = std::fopen((dir + "/" + std::to_string(firstEpoch) + ".sum").c_str(), "wb");
+    if (file == nullptr) {
+        return;
+    }
+    bool ok = std::fwrite(record, 1, sizeof(record), file) == sizeof(record) &&
+              syncCounted(file);
+    ok = (std::fclose(file) == 0) && ok;
+    if (!ok) {
+        statsCached_ = false;  // partial bytes: resync on next read
+        return;
+    }
+    noteAppended(static_cast<long>(sizeof(record)));
+    ++writes_.filesCreated;
+}
+
+bool LittleFsDataStorage::readChunkSummary(const std::string& metric, uint32_t firstEpoch,
+                                           ChunkSummary& out) const
+{
+    FILE* file = std::fopen(
+        (summaryDir(metric) + "/" + std::to_string(firstEpoch) + ".sum").c_str(), "rb");
+    if (file == nullptr) {
+        return false;
+    }
+    uint8_t record[kSummaryBytes];
+    const bool read = std::fread(record, 1, sizeof(record), file) == sizeof(record);
+    std::fclose(file);
+    if (!read || record[0] != kSummaryMarker ||
+        decodeU32Le(record + kSummaryCrcOffset) != crc32Update(0, record, kSummaryCrcOffset)) {
+        return false;
+    }
+    const uint64_t sumBits = decodeU32Le(record + 21) |
+                             (static_cast<uint64_t>(decodeU32Le(record + 25)) << 32);
+    out.count = decodeU32Le(record + 1);
+    out.minEpoch = decodeU32Le(record + 5);
+    out.maxEpoch = decodeU32Le(record + 9);
+    out.min = decodeFloatLe(record + 13);
+    out.max = decodeFloatLe(record + 17);
+    std::memcpy(&out.sum, &sumBits, sizeof(out.sum));
+    out.last = decodeFloatLe(record + 29);
+    out.bytes = decodeU32Le(record + 33);
+    out.crc = decodeU32Le(record + 37);
+    return out.count != 0 && out.minEpoch <= out.maxEpoch;
+}
+
+SensorWindowStats LittleFsDataStorage::getSensorWindowStats(const std::string& metric,
+                                                            uint32_t t0, uint32_t t1) const
+{
+    if (!options_.chunkSummaries) {
+        return IDataStorage::getSensorWindowStats(metric, t0, t1);
+    }
+    // The default fold, plus whole chunks from their summaries.
+    struct Folder final : IReadingVisitor, SummaryVisitor {
+        SensorWindowStats stats;
+        double sum = 0.0;
+        void add(uint32_t count, float min, float max, double partSum, uint32_t lastEpoch,
+                 float last)
+        {
+            if (stats.count == 0) {
+                stats.min = min;
+                stats.max = max;
+            }
+            if (stats.count == 0 || lastEpoch >= stats.lastEpoch) {
+                stats.lastEpoch = lastEpoch;
+                stats.last = last;
+            }
+            stats.count += count;
+            stats.min = std::min(stats.min, min);
+            stats.max = std::max(stats.max, max);
+            sum += partSum;
+        }
+        bool onReading(uint32_t epoch, float value) override
+        {
+            add(1, value, value, value, epoch, value);
+            return true;
+        }
+        bool wants(uint32_t, uint32_t) const override { return true; }
+        bool takeChunk(const ChunkSummary& chunk) override
+        {
+            add(chunk.count, chunk.min, chunk.max, chunk.sum, chunk.maxEpoch, chunk.last);
+            return true;
+        }
+    } folder;
+    visitWindow(metric, t0, t1, folder, &folder);
+    if (folder.stats.count != 0) {
+        folder.stats.mean =
+            static_cast<float>(folder.sum / static_cast<double>(folder.stats.count));
+    }
+    return folder.stats;
+}
+
+void LittleFsDataStorage::foldAggregates(const std::string& metric, uint32_t t0,
+                                         uint32_t t1, uint32_t bucketS,
+                                         std::vector<SensorAggregate>& buckets) const
+{
+    struct Folder final : IReadingVisitor, SummaryVisitor {
+        std::vector<SensorAggregate>* buckets = nullptr;
+        uint32_t bucketS = 0;
+        bool onReading(uint32_t epoch, float value) override
+        {
+            rollup::fold(*buckets, bucketS, epoch, value);
+            return true;
+        }
+        bool wants(uint32_t from, uint32_t to) const override
+        {
+            return from / bucketS == to / bucketS;
+        }
+        bool takeChunk(const ChunkSummary& chunk) override
+        {
+            if (chunk.minEpoch / bucketS != chunk.maxEpoch / bucketS) {
+                return false;
+            }
+            rollup::merge(*buckets,
+                          SensorAggregate{chunk.minEpoch - chunk.minEpoch % bucketS,
+                                          chunk.count, chunk.min, chunk.max,
+                                          static_cast<float>(chunk.sum)});
+            return true;
+        }
+    } folder;
+    folder.buckets = &buckets;
+    folder.bucketS = bucketS;
+    visitWindow(metric, t0, t1, folder, options_.chunkSummaries ? &folder : nullptr);
+}
+
+std::size_t LittleFsDataStorage::scrubHistory(std::size_t maxChunks)
+{
+    if (!options_.chunkSummaries) {
+        return 0;
+    }
+    // Every summarized chunk, in (metric, first epoch) order.
+    std::vector<std::pair<std::string, uint32_t>> summarized;
+    for (const std::string& metric : listNames(basePath_ + "/sum")) {
+        for (const std::string& name : listNames(summaryDir(metric))) {
+            uint32_t firstEpoch = 0;
+            if (parseSummaryName(name, firstEpoch)) {
+                summarized.emplace_back(metric, firstEpoch);
+            }
+        }
+    }
+    std::sort(summarized.begin(), summarized.end());
+    auto next = std::upper_bound(summarized.begin(), summarized.end(),
+                                 std::make_pair(scrubMetric_, scrubEpoch_));
+    std::size_t damaged = 0;
+    for (std::size_t n = std::min(maxChunks, summarized.size()); n > 0; --n, ++next) {
+        if (next == summarized.end()) {
+            next = summarized.begin();
+        }
+        scrubMetric_ = next->first;
+        scrubEpoch_ = next->second;
+        ChunkSummary recorded;
+        if (!readChunkSummary(next->first, next->second, recorded)) {
+            continue;  // a torn summary: nothing to check against
+        }
+        const std::string dir = metricDir(next->first);
+        for (const ChunkRef& chunk : listChunks(dir)) {
+            if (chunk.firstEpoch != next->second) {
+                continue;
+            }
+            FILE* file = openRecordFile(dir + "/" + chunk.name);
+            std::size_t size = 0;
+            if (file != nullptr) {
+                readScratch_.resize(kHistoryChunkMaxBytes);
+                size = std::fread(readScratch_.data(), 1, readScratch_.size(), file);
+                std::fclose(file);
+            }
+            if (size < recorded.bytes ||
+                crc32Update(0, readScratch_.data(), recorded.bytes) != recorded.crc) {
+                ++damaged;
+            }
+            break;
+        }
+    }
+    return damaged;
+}
+
+bool LittleFsDataStorage::maintain()
+{
+    if (!options_.backgroundMaintenance) {
+        return false;
+    }
+    // Due rollups first: until they are written, aggregate reads fold the
+    // raw history in their place.
+    for (std::size_t id = 0; id < state_.size(); ++id) {
+        MetricState& state = state_[id];
+        if (state.rollupDue) {
+            state.rollupDue = false;
+            updateRollups(static_cast<MetricId>(id), state.rollupDueEpoch);
+            return true;
+        }
+    }
+    if (options_.historyCodec != HistoryCodec::Delta || sharedLayout()) {
+        return false;
+    }
+    return recompactNext();
+}
+
+bool LittleFsDataStorage::recompactNext()
+{
+    // One metric directory per call: the next sealed .dat after the
+    // cursor, or a step on to the following metric.
+    const std::vector<std::string> names = listNames(histDir());
+    auto at = std::lower_bound(names.begin(), names.end(), compactMetric_);
+    if (at == names.end()) {
+        compactMetric_.clear();
+        compactEpoch_ = 0;
+        return false;
+    }
+    if (*at != compactMetric_) {
+        compactMetric_ = *at;
+        compactEpoch_ = 0;
+    }
+    const MetricId id = resolveMetric(*at);
+    if (id != metric::kInvalid) {
+        if (compactEpoch_ == 0) {
+            tidyRecompaction(id);
+        }
+        const std::vector<ChunkRef> chunks = listChunks(state_[id].dir);
+        // The newest chunk is the active one: never touched.
+        for (std::size_t i = 0; i + 1 < chunks.size(); ++i) {
+            const ChunkRef& chunk = chunks[i];
+            const auto key = std::make_pair(*at, chunk.firstEpoch);
+            if (chunk.delta || chunk.firstEpoch < compactEpoch_ ||
+                std::find(compactSkipped_.begin(), compactSkipped_.end(), key) !=
+                    compactSkipped_.end()) {
+                continue;
+            }
+            compactEpoch_ = chunk.firstEpoch + 1;
+            if (!recompactChunk(id, chunk.name, chunk.firstEpoch, chunk.unordered)) {
+                if (compactSkipped_.size() >= kMaxMetrics) {
+                    compactSkipped_.clear();  // bounded: forgetting costs one retry
+                }
+                compactSkipped_.push_back(key);
+            }
+            if (compactEpoch_ == 0) {
+                break;  // the last possible epoch: this metric is done
+            }
+            return true;
+        }
+    }
+    if (++at == names.end()) {
+        compactMetric_.clear();
+        compactEpoch_ = 0;
+        return false;
+    }
+    compactMetric_ = *at;
+    compactEpoch_ = 0;
+    return true;
+}
+
+void LittleFsDataStorage::tidyRecompaction(MetricId metric)
+{
+    const std::string& dir = state_[metric].dir;
+    for (const std::string& name : listNames(dir)) {
+        if (name.size() > 4 && name.compare(name.size() - 4, 4, ".tmp") == 0) {
+            removeCounted(dir + "/" + name);  // never renamed: the original stands
+        }
+    }
+    std::vector<ChunkRef> shadowed;
+    const std::vector<ChunkRef> chunks = listChunks(dir, &shadowed);
+    for (const ChunkRef& stale : shadowed) {
+        forgetCachedChunk(dir + "/" + stale.name);
+        if (!removeCounted(dir + "/" + stale.name) || !options_.chunkSummaries) {
+            continue;
+        }
+        // The summary may still describe the .dat's bytes.
+        for (const ChunkRef& chunk : chunks) {
+            if (chunk.firstEpoch == stale.firstEpoch) {
+                writeChunkSummary(metric, chunk.name, chunk.firstEpoch);
+            }
+        }
+    }
+}
+
+bool LittleFsDataStorage::recompactChunk(MetricId metric, const std::string& name,
+                                         uint32_t firstEpoch, bool unordered)
+{
+    const std::string& dir = state_[metric].dir;
+    const std::string from = dir + "/" + name;
+    FILE* file = openRecordFile(from);
+    if (file == nullptr) {
+        return false;
+    }
+    readScratch_.resize(kHistoryChunkMaxBytes);
+    const std::size_t size = std::fread(readScratch_.data(), 1, readScratch_.size(), file);
+    std::fclose(file);
+
+    // Re-encode, giving up once the frames are no smaller than the records.
+    frameScratch_.clear();
+    DeltaRecordCodec::header(frameScratch_);
+    deltachunk::State tail;
+    const std::size_t records = size / kHistoryRecordBytes;
+    const bool smaller =
+        records != 0 &&
+        decodeRecords(readScratch_.data(), records, [&](uint32_t epoch, float value) {
+            uint8_t bytes[DeltaRecordCodec::kMaxRecordBytes];
+            const std::size_t length = DeltaRecordCodec::encode(bytes, tail, epoch, value);
+            if (frameScratch_.size() + length >= records * kHistoryRecordBytes) {
+                return false;
+            }
+            frameScratch_.insert(frameScratch_.end(), bytes, bytes + length);
+            return true;
+        });
+    if (!smaller) {
+        return false;
+    }
+
+    // Written and synced under a name no scan takes for a chunk, then
+    // renamed: the .dz is complete whenever it exists.
+    const std::string toName = chunkName(firstEpoch, true, unordered);
+    const std::string to = dir + "/" + toName;
+    const std::string tmp = to + ".tmp";
+    FILE* out = std::fopen(tmp.c_str(), "wb");
+    if (out == nullptr) {
+        return false;
+    }
+    bool ok = std::fwrite(frameScratch_.data(), 1, frameScratch_.size(), out) ==
+                  frameScratch_.size() &&
+              syncCounted(out);
+    ok = (std::fclose(out) == 0) && ok;
+    if (!ok) {
+        statsCached_ = false;  // partial bytes: resync on next read
+        std::remove(tmp.c_str());
+        return false;
+    }
+    noteAppended(static_cast<long>(frameScratch_.size()));
+    ++writes_.filesCreated;
+    if (std::rename(tmp.c_str(), to.c_str()) != 0) {
+        removeCounted(tmp);
+        return false;
+    }
+    // The .dz now shadows the .dat: a cut from here on is finished by
+    // tidyRecompaction(). The summary first, so it never outlives the
+    // bytes it describes.
+    if (options_.chunkSummaries) {
+        writeChunkSummary(metric, toName, firstEpoch);
+    }
+    forgetCachedChunk(from);
+    MetricState& state = state_[metric];
+    if (!removeCounted(from)) {
+        state.indexed = false;  // re-derived (and tidied) by the next append
+        return false;
+    }
+    if (state.indexed) {
+        for (std::string& indexed : state.index.names) {
+            if (indexed == name) {
+                indexed = toName;
+            }
+        }
+    }
+    return true;
+}
+
+bool LittleFsDataStorage::storeEvent(uint32_t epoch, uint8_t category,
+                                     std::string_view detail)
+{
+    // Contract: an over-long detail is silently truncated — the event
+    // itself is always recorded, never rejected for length.
+    const AppendTimer timer(*this);
+    const std::size_t detailLen = std::min(detail.size(), kEventDetailMaxLen);
+    const std::size_t recordBytes = eventFrameBytes(detailLen);
+
+    EventTail tail;
+    if (!resolveEventTail(tail)) {
+        return false;
+    }
+    if (tail.validBytes + static_cast<long>(recordBytes) >
+        static_cast<long>(eventSegmentBytes_)) {
+        // Rotation (data-model.md): the append would overflow the active
+        // segment, so the next slot starts the next segment — only the
+        // oldest segment is dropped, the newest records always kept.
+        tail = EventTail{tail.sequence + 1, kSegmentRecordsStart};
+        if (!startEventSegment(tail.sequence)) {
+            eventTailCached_ = false;
+            return false;
+        }
+        ++writes_.rotations;
+        if (tail.sequence % eventPaths_.size() == 0) {
+            dropStaleEventFiles();
+        }
+    }
+    const std::string& path = eventPath(tail.sequence);
+
+    uint8_t header[kEventHeaderBytes];
+    header[0] = kEventMarker;
+    for (int i = 0; i < 4; ++i) {
+        header[1 + i] = static_cast<uint8_t>((epoch >> (8 * i)) & 0xFF);
+    }
+    header[5] = category;
+    header[6] = static_cast<uint8_t>(detailLen);
+    const uint8_t trailer = static_cast<uint8_t>(recordBytes);
+
+    FILE* file = std::fopen(path.c_str(), "ab");
+    if (file == nullptr) {
+        return false;
+    }
+    // Durable once true is returned: flush stdio, then sync to flash.
+    bool ok = std::fwrite(header, 1, sizeof(header), file) == sizeof(header) &&
+              std::fwrite(detail.data(), 1, detailLen, file) == detailLen &&
+              std::fwrite(&trailer, 1, 1, file) == 1 &&
+              syncCounted(file);
+    ok = (std::fclose(file) == 0) && ok;
+    // A failed append may have left partial bytes: re-derive next time.
+    eventTailCached_ = ok && options_.cacheEventTail;
+    if (ok) {
+        noteAppended(static_cast<long>(recordBytes));
+    } else {
+        statsCached_ = false;
+    }
+    eventTail_ = EventTail{tail.sequence, tail.validBytes + static_cast<long>(recordBytes)};
+    return ok;
+}
+
+bool LittleFsDataStorage::startEventSegment(uint32_t sequence)
+{
+    const std::string& path = eventPath(sequence);
+    const long dropped = statsCached_ ? fileSize(path) : -1;
+    uint8_t header[kEventSegmentHeaderBytes];
+    putU32Le(header, kEventSegmentMagic);
+    putU32Le(header + 4, sequence);
+    // "wb" empties the slot first: a power cut before the sync leaves a
+    // file without a valid header, which derivation skips and the next
+    // rotation into the slot rewrites.
+    FILE* file = std::fopen(path.c_str(), "wb");
+    if (file == nullptr) {
+        statsCached_ = false;
+        return false;
+    }
+    bool ok = std::fwrite(header, 1, sizeof(header), file) == sizeof(header) &&
+              syncCounted(file);
+    ok = (std::fclose(file) == 0) && ok;
+    if (!ok) {
+        statsCached_ = false;
+        return false;
+    }
+    noteStatsDelta(static_cast<long>(sizeof(header)) - std::max(dropped, 0L));
+    return true;
+}
+
+std::size_t LittleFsDataStorage::eventSegmentsNewestFirst(
+    std::array<uint32_t, kEventMaxSegments>& out) const
+{
+    // The newest segment is the highest sequence, whatever its records
+    // say, so the derivation is one short read per slot and no parsing.
+    // A torn header (a power cut while a rotation started the slot) or a
+    // sequence outside its slot (eventSegments changed) leaves the slot
+    // out until a rotation rewrites it.
+    std::size_t count = 0;
+    for (std::size_t slot = 0; slot < eventPaths_.size(); ++slot) {
+        uint32_t sequence = 0;
+        if (readSegmentSequence(eventPaths_[slot], sequence) &&
+            sequence % eventPaths_.size() == slot) {
+            out[count++] = sequence;
+        }
+    }
+    std::sort(out.begin(), out.begin() + count, std::greater<uint32_t>());
+    return count;
+}
+
+void LittleFsDataStorage::dropStaleEventFiles()
+{
+    // Once the ring has wrapped, every event of the older two-file log is
+    // older than the segment just dropped. Best effort: a leftover only
+    // costs flash until the next wrap.
+    for (int index = 0; index < 2; ++index) {
+        const std::string path = legacyEventPath(eventsDir(), index);
+        if (fileSize(path) >= 0) {
+            removeCounted(path);
+        }
+    }
+    for (std::size_t slot = eventPaths_.size(); slot < kEventMaxSegments; ++slot) {
+        const std::string path = eventSegmentPath(eventsDir(), slot);
+        if (fileSize(path) >= 0) {
+            removeCounted(path);
+        }
+    }
+}
+
+bool LittleFsDataStorage::resolveEventTail(EventTail& tail)
+{
+    if (eventTailCached_) {
+        // One stat confirms nothing appended, truncated, rotated or
+        // removed the active segment behind the cache.
+        if (fileSize(eventPath(eventTail_.sequence)) == eventTail_.validBytes) {
+            tail = eventTail_;
+            return true;
+        }
+        eventTailCached_ = false;
+    }
+    if (!ensureDir(basePath_) || !ensureDir(eventsDir())) {
+        return false;
+    }
+    std::array<uint32_t, kEventMaxSegments> sequences;
+    if (eventSegmentsNewestFirst(sequences) == 0) {
+        // A fresh log (the older two-file log, if any, is read as what
+        // came before it): the first segment starts it.
+        tail = EventTail{0, kSegmentRecordsStart};
+        return startEventSegment(0);
+    }
+    tail.sequence = sequences[0];
+    const std::string& path = eventPath(tail.sequence);
+    std::vector<uint8_t> bytes;
+    const long validBytes =
+        parseEventFile(path, kSegmentRecordsStart, LONG_MAX, bytes, [](std::size_t) {});
+    const long size = fileSize(path);
+    // The segment's header was just read, so a failed stat is a real
+    // error — appending anyway could break the frame boundary (mirrors
+    // the history path).
+    if (size < 0) {
+        return false;
+    }
+    if (size > validBytes) {
+        // Repair a torn tail (power loss mid-append) so the new record
+        // lands on a frame boundary and the whole segment stays parseable.
+        if (::truncate(path.c_str(), validBytes) != 0) {
+            return false;
+        }
+        noteRepaired(size - validBytes);
+    }
+    tail.validBytes = validBytes;
+    return true;
+}
+
+std::vector<EventRecord> LittleFsDataStorage::getEvents(
+    std::size_t maxCount) const
+{
+    EventQuery query;
+    query.limit = maxCount;
+    return queryEvents(query).events;
+}
+
+EventPage LittleFsDataStorage::queryEvents(const EventQuery& query) const
+{
+    // Each segment holds records in append order, and a higher sequence
+    // holds newer records. Newest-first therefore = the segments by
+    // descending sequence, each read backwards from its tail, then the
+    // two-file log of older firmware while it is still there. The walk
+    // stops as soon as the page is full (or past `since`), so a page
+    // costs the headers plus the records it skips and returns, not the
+    // whole log, and every call stays stateless across restarts.
+    EventPager pager(query);
+    bool stopped = false;
+    const auto walk = [&](const std::string& path, long start) {
+        visitEventsNewestFirst(path, start, readScratch_, [&](const EventFrame& f) {
+            stopped = !pager.offer(f.epoch, f.category, [&] { return f.record(); });
+            return !stopped;
+        });
+        return !stopped;
+    };
+    std::array<uint32_t, kEventMaxSegments> sequences;
+    const std::size_t segments = eventSegmentsNewestFirst(sequences);
+    for (std::size_t i = 0; i < segments; ++i) {
+        if (!walk(eventPath(sequences[i]), kSegmentRecordsStart)) {
+            return pager.take();
+        }
+    }
+    const std::string legacy[2] = {legacyEventPath(eventsDir(), 0),
+                                   legacyEventPath(eventsDir(), 1)};
+    const NewestEvents files[2] = {readNewestEvents(legacy[0], 1, readScratch_),
+                                   readNewestEvents(legacy[1], 1, readScratch_)};
+    const int newer = pickActiveEventFile(files);
+    if (walk(legacy[newer], 0)) {
+        walk(legacy[1 - newer], 0);
+    }
+    return pager.take();
+}
+
+StorageStats LittleFsDataStorage::getStorageStats() const
+{
+    const bool caching = options_.statsResyncMs > 0 && options_.clock != nullptr;
+    if (caching && statsCached_ &&
+        options_.clock->nowMs() - statsSyncedMs_ <
+            static_cast<int64_t>(options_.statsResyncMs)) {
+        // littlefs allocates whole blocks, so the byte tally drifts from
+        // the provider's figure between resyncs; clamp it to the volume.
+        StorageStats stats{};
+        stats.totalBytes = statsTotal_;
+        stats.usedBytes = static_cast<uint32_t>(
+            std::min<int64_t>(std::max<int64_t>(statsUsed_, 0), statsTotal_));
+        stats.writes = writes_;
+        return stats;
+    }
+    StorageStats stats{};
+    stats.writes = writes_;  // RAM counters: reported even without a provider
+    statsCached_ = false;
+    if (statsProvider_) {
+        uint32_t totalBytes = 0;
+        uint32_t usedBytes = 0;
+        if (statsProvider_(totalBytes, usedBytes)) {
+            stats.totalBytes = totalBytes;
+            stats.usedBytes = usedBytes;
+            if (caching) {
+                statsTotal_ = totalBytes;
+                statsUsed_ = usedBytes;
+                statsSyncedMs_ = options_.clock->nowMs();
+                statsCached_ = true;
+            }
+        }
+    }
+    return stats;
+}
+
+void LittleFsDataStorage::noteStatsDelta(long bytes)
+{
+    if (statsCached_) {
+        statsUsed_ += bytes;
+    }
+}
+
+bool LittleFsDataStorage::removeCounted(const std::string& path)
+{
+    // The stat is only paid while there is a tally to keep in step.
+    const long size = statsCached_ ? fileSize(path) : -1;
+    if (std::remove(path.c_str()) != 0) {
+        statsCached_ = false;
+        return false;
+    }
+    noteStatsDelta(-std::max(size, 0L));
+    ++writes_.filesRemoved;
+    return true;
+}
+
+void LittleFsDataStorage::noteAppended(long bytes)
+{
+    writes_.bytesAppended += static_cast<uint64_t>(bytes);
+    noteStatsDelta(bytes);
+}
+
+void LittleFsDataStorage::noteRepaired(long freedBytes)
+{
+    if (freedBytes > 0) {
+        ++writes_.tornRepairs;
+    }
+    noteStatsDelta(-freedBytes);
+}
+
+bool LittleFsDataStorage::syncCounted(FILE* file)
+{
+    if (syncDeferred_) {
+        return std::fflush(file) == 0;  // the batch journal's sync covers it
+    }
+    ++writes_.syncs;
+    return std::fflush(file) == 0 && ::fsync(fileno(file)) == 0;
+}
+
+LittleFsDataStorage::AppendTimer::AppendTimer(LittleFsDataStorage& storage)
+    : storage_(storage)
+{
+    if (storage_.appendDepth_++ == 0 && storage_.options_.appendClock) {
+        startUs_ = storage_.options_.appendClock();
+    }
+}
+
+LittleFsDataStorage::AppendTimer::~AppendTimer()
+{
+    if (--storage_.appendDepth_ == 0 && storage_.options_.appendClock) {
+        const int64_t elapsed = storage_.options_.appendClock() - startUs_;
+        storage_.writes_.appendUs += static_cast<uint64_t>(std::max<int64_t>(elapsed, 0));
+    }
+}
+
+std::string LittleFsDataStorage::histDir() const { return basePath_ + "/hist"; }
+
+std::string LittleFsDataStorage::metricDir(const std::string& metric) const
+{
+    return histDir() + "/" + metric;
+}
+
+std::string LittleFsDataStorage::eventsDir() const
+{
+    return basePath_ + "/events";
 }
@@ -14,8 +14,12 @@
 
 #include "storage/NvsConfigStore.h"
 
+#include <array>
 #include <cmath>
 #include <cstring>
+#include <optional>
+#include <string>
+#include <utility>
 
 #include "esp_log.h"
 #include "nvs.h"
@@ -34,8 +38,25 @@ constexpr const char* kKeySoakPause = "soak_pause";
 constexpr const char* kKeyWaterEn = "water_en";
 constexpr const char* kKeyReadIv = "read_iv";
 constexpr const char* kKeyLogIv = "log_iv";
+constexpr const char* kKeyModbusBaud = "mb_baud";
 constexpr const char* kKeyWifiSsid = "wifi_ssid";
 constexpr const char* kKeyWifiPass = "wifi_pass";
+// Station static IP: four u32 entries (host order), absent = DHCP.
+constexpr const char* kKeyIpAddr = "ip_addr";
+constexpr const char* kKeyIpMask = "ip_mask";
+constexpr const char* kKeyIpGateway = "ip_gw";
+constexpr const char* kKeyIpDns = "ip_dns";
+// API HTTP server sizing (HttpdSettings), one entry per field.
+constexpr const char* kKeyHttpdSockets = "hd_sockets";
+constexpr const char* kKeyHttpdBacklog = "hd_backlog";
+constexpr const char* kKeyHttpdStack = "hd_stack";
+constexpr const char* kKeyHttpdRecvTimeout = "hd_recv_to";
+constexpr const char* kKeyHttpdSendTimeout = "hd_send_to";
+constexpr const char* kKeyHttpdLru = "hd_lru";
+// Log policies: three u32 entries per known metric id, "lp_abs_<id>" etc.
+constexpr const char* kKeyLogPolicyAbs = "lp_abs_";
+constexpr const char* kKeyLogPolicyRel = "lp_rel_";
+constexpr const char* kKeyLogPolicyHeartbeat = "lp_hb_";
 
 constexpr uint32_t kNoUpperBound = UINT32_MAX;
 
@@ -82,6 +103,12 @@ float bitsToFloat(uint32_t bits)
     return value;
 }
 
+/// Per-metric key: @p prefix + decimal @p id (at most "lp_abs_9").
+std::string policyKey(const char* prefix, MetricId id)
+{
+    return std::string(prefix) + std::to_string(id);
+}
+
 bool commitValue(nvs_handle_t handle, const char* key, esp_err_t setErr)
 {
     esp_err_t err = setErr;
@@ -101,7 +128,7 @@ bool commitValue(nvs_handle_t handle, const char* key, esp_err_t setErr)
 // Typed helpers
 // ---------------------------------------------------------------------------
 
-float NvsConfigStore::getFloat(const char* key, float defaultValue,
+float NvsConfigStore::readFloat(const char* key, float defaultValue,
                                float minValue, float maxValue) const
 {
     NvsHandleGuard handle(kNamespace, NVS_READONLY);
@@ -124,7 +151,7 @@ float NvsConfigStore::getFloat(const char* key, float defaultValue,
 }
 
 bool NvsConfigStore::setFloat(const char* key, float value, float minValue,
-                              float maxValue)
+                              float maxValue, float& cached)
 {
     if (std::isnan(value) || value < minValue || value > maxValue) {
         return false;  // FR-003: rejected, stored value untouched
@@ -135,12 +162,17 @@ bool NvsConfigStore::setFloat(const char* key, float value, float minValue,
                  esp_err_to_name(handle.error()));
         return false;
     }
-    return commitValue(handle.get(), key,
-                       nvs_set_u32(handle.get(), key, floatToBits(value)));
+    if (!commitValue(handle.get(), key,
+                     nvs_set_u32(handle.get(), key, floatToBits(value)))) {
+        return false;
+    }
+    cached = value;
+    ++generation_;
+    return true;
 }
 
-uint32_t NvsConfigStore::getU32(const char* key, uint32_t defaultValue,
-                                uint32_t minValue, uint32_t maxValue) const
+uint32_t NvsConfigStore::readU32(const char* key, uint32_t defaultValue,
+                                 uint32_t minValue, uint32_t maxValue) const
 {
     NvsHandleGuard handle(kNamespace, NVS_READONLY);
     if (!handle.ok()) {
@@ -158,7 +190,8 @@ uint32_t NvsConfigStore::getU32(const char* key, uint32_t defaultValue,
 }
 
 bool NvsConfigStore::setU32(const char* key, uint32_t value,
-                            uint32_t minValue, uint32_t maxValue)
+                            uint32_t minValue, uint32_t maxValue,
+                            uint32_t& cached)
 {
     if (value < minValue || value > maxValue) {
         return false;
@@ -169,11 +202,15 @@ bool NvsConfigStore::setU32(const char* key, uint32_t value,
                  esp_err_to_name(handle.error()));
         return false;
     }
-    return commitValue(handle.get(), key,
-                       nvs_set_u32(handle.get(), key, value));
+    if (!commitValue(handle.get(), key, nvs_set_u32(handle.get(), key, value))) {
+        return false;
+    }
+    cached = value;
+    ++generation_;
+    return true;
 }
 
-bool NvsConfigStore::getBool(const char* key, bool defaultValue) const
+bool NvsConfigStore::readBool(const char* key, bool defaultValue) const
 {
     NvsHandleGuard handle(kNamespace, NVS_READONLY);
     if (!handle.ok()) {
@@ -191,7 +228,7 @@ bool NvsConfigStore::getBool(const char* key, bool defaultValue) const
     return value == 1;
 }
 
-bool NvsConfigStore::setBool(const char* key, bool value)
+bool NvsConfigStore::setBool(const char* key, bool value, bool& cached)
 {
     NvsHandleGuard handle(kNamespace, NVS_READWRITE);
     if (!handle.ok()) {
@@ -199,12 +236,17 @@ bool NvsConfigStore::setBool(const char* key, bool value)
                  esp_err_to_name(handle.error()));
         return false;
     }
-    return commitValue(handle.get(), key,
-                       nvs_set_u8(handle.get(), key, value ? 1 : 0));
+    if (!commitValue(handle.get(), key,
+                     nvs_set_u8(handle.get(), key, value ? 1 : 0))) {
+        return false;
+    }
+    cached = value;
+    ++generation_;
+    return true;
 }
 
-std::string NvsConfigStore::getString(const char* key,
-                                      std::size_t maxLen) const
+std::string NvsConfigStore::readString(const char* key,
+                                       std::size_t maxLen) const
 {
     NvsHandleGuard handle(kNamespace, NVS_READONLY);
     if (!handle.ok()) {
@@ -228,98 +270,304 @@ std::string NvsConfigStore::getString(const char* key,
     return value;
 }
 
+MetricLogPolicy NvsConfigStore::readLogPolicy(MetricId id) const
+{
+    NvsHandleGuard handle(kNamespace, NVS_READONLY);
+    if (!handle.ok()) {
+        return MetricLogPolicy{};
+    }
+    const std::string absKey = policyKey(kKeyLogPolicyAbs, id);
+    uint32_t absBits = 0;
+    uint32_t relBits = 0;
+    uint32_t heartbeat = 0;
+    if (nvs_get_u32(handle.get(), absKey.c_str(), &absBits) != ESP_OK ||
+        nvs_get_u32(handle.get(), policyKey(kKeyLogPolicyRel, id).c_str(), &relBits) != ESP_OK ||
+        nvs_get_u32(handle.get(), policyKey(kKeyLogPolicyHeartbeat, id).c_str(),
+                    &heartbeat) != ESP_OK) {
+        return MetricLogPolicy{};
+    }
+    const MetricLogPolicy policy{bitsToFloat(absBits), bitsToFloat(relBits), heartbeat};
+    if (!isValidLogPolicy(policy)) {
+        ESP_LOGW(TAG, "stored log policy %u out of range, using default",
+                 static_cast<unsigned>(id));
+        return MetricLogPolicy{};
+    }
+    return policy;
+}
+
+StaticIpConfig NvsConfigStore::readStaticIp() const
+{
+    StaticIpConfig ip;
+    ip.address = readU32(kKeyIpAddr, 0, 0, kNoUpperBound);
+    ip.netmask = readU32(kKeyIpMask, 0, 0, kNoUpperBound);
+    ip.gateway = readU32(kKeyIpGateway, 0, 0, kNoUpperBound);
+    ip.dns = readU32(kKeyIpDns, 0, 0, kNoUpperBound);
+    if (!isValidStaticIp(ip)) {
+        ESP_LOGW(TAG, "stored static IP invalid, using DHCP");
+        return StaticIpConfig{};
+    }
+    return ip;
+}
+
+HttpdSettings NvsConfigStore::readHttpdSettings() const
+{
+    HttpdSettings h;
+    h.maxOpenSockets = static_cast<uint16_t>(readU32(kKeyHttpdSockets, 0, 0, UINT16_MAX));
+    h.backlog = static_cast<uint16_t>(readU32(kKeyHttpdBacklog, 0, 0, UINT16_MAX));
+    h.stackBytes = readU32(kKeyHttpdStack, 0, 0, kNoUpperBound);
+    h.recvTimeoutS = static_cast<uint16_t>(readU32(kKeyHttpdRecvTimeout, 0, 0, UINT16_MAX));
+    h.sendTimeoutS = static_cast<uint16_t>(readU32(kKeyHttpdSendTimeout, 0, 0, UINT16_MAX));
+    h.lruPurge = readU32(kKeyHttpdLru, 0, 0, 1) != 0;
+    if (!isValidHttpdSettings(h)) {
+        ESP_LOGW(TAG, "stored httpd settings invalid, using the build defaults");
+        return HttpdSettings{};
+    }
+    return h;
+}
+
+void NvsConfigStore::load()
+{
+    cache_.moistureThresholdLow = readFloat(kKeyMoistLow, kDefaultMoistureThresholdLow,
+                                            kMoistureThresholdMin, kMoistureThresholdMax);
+    cache_.moistureThresholdHigh = readFloat(kKeyMoistHigh, kDefaultMoistureThresholdHigh,
+                                             kMoistureThresholdMin, kMoistureThresholdMax);
+    cache_.wateringDurationS = readU32(kKeyWaterDur, kDefaultWateringDurationS,
+                                       kWateringDurationMinS, kWateringDurationMaxS);
+    cache_.minWateringIntervalS = readU32(kKeySoakPause, kDefaultMinWateringIntervalS,
+                                          kMinWateringIntervalFloorS, kNoUpperBound);
+    cache_.wateringEnabled = readBool(kKeyWaterEn, kDefaultWateringEnabled);
+    cache_.sensorReadIntervalMs = readU32(kKeyReadIv, kDefaultSensorReadIntervalMs,
+                                          kSensorReadIntervalFloorMs, kNoUpperBound);
+    cache_.dataLogIntervalMs = readU32(kKeyLogIv, kDefaultDataLogIntervalMs,
+                                       kDataLogIntervalFloorMs, kNoUpperBound);
+    cache_.modbusBaudRate = readU32(kKeyModbusBaud, kDefaultModbusBaudRate, 0,
+                                    kNoUpperBound);
+    if (!isValidModbusBaudRate(cache_.modbusBaudRate)) {
+        ESP_LOGW(TAG, "stored %s not a probe rate, using default", kKeyModbusBaud);
+        cache_.modbusBaudRate = kDefaultModbusBaudRate;
+    }
+    cache_.wifiSsid = readString(kKeyWifiSsid, kWifiSsidMaxLen);
+    cache_.wifiPassword = readString(kKeyWifiPass, kWifiPasswordMaxLen);
+    cache_.staticIp = readStaticIp();
+    cache_.httpd = readHttpdSettings();
+    for (MetricId id = 0; id < metric::kKnownCount; ++id) {
+        cache_.logPolicies[id] = readLogPolicy(id);
+    }
+}
+
 // ---------------------------------------------------------------------------
 // IConfigStore
 // ---------------------------------------------------------------------------
 
+NvsConfigStore::NvsConfigStore()
+{
+    load();
+}
+
 float NvsConfigStore::getMoistureThresholdLow() const
 {
-    return getFloat(kKeyMoistLow, kDefaultMoistureThresholdLow,
-                    kMoistureThresholdMin, kMoistureThresholdMax);
+    return cache_.moistureThresholdLow;
 }
 
 bool NvsConfigStore::setMoistureThresholdLow(float percent)
 {
     return setFloat(kKeyMoistLow, percent, kMoistureThresholdMin,
-                    kMoistureThresholdMax);
+                    kMoistureThresholdMax, cache_.moistureThresholdLow);
 }
 
 float NvsConfigStore::getMoistureThresholdHigh() const
 {
-    return getFloat(kKeyMoistHigh, kDefaultMoistureThresholdHigh,
-                    kMoistureThresholdMin, kMoistureThresholdMax);
+    return cache_.moistureThresholdHigh;
 }
 
 bool NvsConfigStore::setMoistureThresholdHigh(float percent)
 {
     return setFloat(kKeyMoistHigh, percent, kMoistureThresholdMin,
-                    kMoistureThresholdMax);
+                    kMoistureThresholdMax, cache_.moistureThresholdHigh);
 }
 
 uint32_t NvsConfigStore::getWateringDurationS() const
 {
-    return getU32(kKeyWaterDur, kDefaultWateringDurationS,
-                  kWateringDurationMinS, kWateringDurationMaxS);
+    return cache_.wateringDurationS;
 }
 
 bool NvsConfigStore::setWateringDurationS(uint32_t seconds)
 {
     return setU32(kKeyWaterDur, seconds, kWateringDurationMinS,
-                  kWateringDurationMaxS);
+                  kWateringDurationMaxS, cache_.wateringDurationS);
 }
 
 uint32_t NvsConfigStore::getMinWateringIntervalS() const
 {
-    return getU32(kKeySoakPause, kDefaultMinWateringIntervalS,
-                  kMinWateringIntervalFloorS, kNoUpperBound);
+    return cache_.minWateringIntervalS;
 }
 
 bool NvsConfigStore::setMinWateringIntervalS(uint32_t seconds)
 {
     return setU32(kKeySoakPause, seconds, kMinWateringIntervalFloorS,
-                  kNoUpperBound);
+                  kNoUpperBound, cache_.minWateringIntervalS);
 }
 
 bool NvsConfigStore::getWateringEnabled() const
 {
-    return getBool(kKeyWaterEn, kDefaultWateringEnabled);
+    return cache_.wateringEnabled;
 }
 
 bool NvsConfigStore::setWateringEnabled(bool enabled)
 {
-    return setBool(kKeyWaterEn, enabled);
+    return setBool(kKeyWaterEn, enabled, cache_.wateringEnabled);
 }
 
 uint32_t NvsConfigStore::getSensorReadIntervalMs() const
 {
-    return getU32(kKeyReadIv, kDefaultSensorReadIntervalMs,
-                  kSensorReadIntervalFloorMs, kNoUpperBound);
+    return cache_.sensorReadIntervalMs;
 }
 
 bool NvsConfigStore::setSensorReadIntervalMs(uint32_t ms)
 {
-    return setU32(kKeyReadIv, ms, kSensorReadIntervalFloorMs, kNoUpperBound);
+    return setU32(kKeyReadIv, ms, kSensorReadIntervalFloorMs, kNoUpperBound,
+                  cache_.sensorReadIntervalMs);
 }
 
 uint32_t NvsConfigStore::getDataLogIntervalMs() const
 {
-    return getU32(kKeyLogIv, kDefaultDataLogIntervalMs,
-                  kDataLogIntervalFloorMs, kNoUpperBound);
+    return cache_.dataLogIntervalMs;
 }
 
 bool NvsConfigStore::setDataLogIntervalMs(uint32_t ms)
 {
-    return setU32(kKeyLogIv, ms, kDataLogIntervalFloorMs, kNoUpperBound);
+    return setU32(kKeyLogIv, ms, kDataLogIntervalFloorMs, kNoUpperBound,
+                  cache_.dataLogIntervalMs);
+}
+
+uint32_t NvsConfigStore::getModbusBaudRate() const
+{
+    return cache_.modbusBaudRate;
+}
+
+bool NvsConfigStore::setModbusBaudRate(uint32_t baud)
+{
+    if (!isValidModbusBaudRate(baud)) {
+        return false;  // FR-003: rejected, stored value untouched
+    }
+    return setU32(kKeyModbusBaud, baud, 0, kNoUpperBound, cache_.modbusBaudRate);
+}
+
+uint32_t NvsConfigStore::generation() const
+{
+    return generation_;
+}
+
+MetricLogPolicy NvsConfigStore::getMetricLogPolicy(MetricId id) const
+{
+    return id < metric::kKnownCount ? cache_.logPolicies[id] : MetricLogPolicy{};
+}
+
+bool NvsConfigStore::setMetricLogPolicy(MetricId id, const MetricLogPolicy& policy)
+{
+    if (id >= metric::kKnownCount || !isValidLogPolicy(policy)) {
+        return false;
+    }
+    NvsHandleGuard handle(kNamespace, NVS_READWRITE);
+    if (!handle.ok()) {
+        ESP_LOGE(TAG, "nvs_open for log policy %u failed: %s",
+                 static_cast<unsigned>(id), esp_err_to_name(handle.error()));
+        return false;
+    }
+    // Same pattern as the credential pair: three entries, one commit.
+    const std::string absKey = policyKey(kKeyLogPolicyAbs, id);
+    esp_err_t err = nvs_set_u32(handle.get(), absKey.c_str(), floatToBits(policy.deadbandAbs));
+    if (err == ESP_OK) {
+        err = nvs_set_u32(handle.get(), policyKey(kKeyLogPolicyRel, id).c_str(),
+                          floatToBits(policy.deadbandRel));
+    }
+    if (err == ESP_OK) {
+        err = nvs_set_u32(handle.get(), policyKey(kKeyLogPolicyHeartbeat, id).c_str(),
+                          policy.heartbeatS);
+    }
+    if (!commitValue(handle.get(), absKey.c_str(), err)) {
+        return false;
+    }
+    cache_.logPolicies[id] = policy;
+    ++generation_;
+    return true;
+}
+
+bool NvsConfigStore::apply(const ConfigPatch& patch)
+{
+    if (!isValidPatch(patch)) {
+        return false;
+    }
+    NvsHandleGuard handle(kNamespace, NVS_READWRITE);
+    if (!handle.ok()) {
+        ESP_LOGE(TAG, "nvs_open for config patch failed: %s",
+                 esp_err_to_name(handle.error()));
+        return false;
+    }
+    const nvs_handle_t h = handle.get();
+    esp_err_t err = ESP_OK;
+    auto putU32 = [&](const char* key, const std::optional<uint32_t>& value) {
+        if (err == ESP_OK && value.has_value()) {
+            err = nvs_set_u32(h, key, *value);
+        }
+    };
+    auto putFloat = [&](const char* key, const std::optional<float>& value) {
+        if (err == ESP_OK && value.has_value()) {
+            err = nvs_set_u32(h, key, floatToBits(*value));
+        }
+    };
+    putFloat(kKeyMoistLow, patch.moistureThresholdLow);
+    putFloat(kKeyMoistHigh, patch.moistureThresholdHigh);
+    putU32(kKeyWaterDur, patch.wateringDurationS);
+    putU32(kKeySoakPause, patch.minWateringIntervalS);
+    if (err == ESP_OK && patch.wateringEnabled.has_value()) {
+        err = nvs_set_u8(h, kKeyWaterEn, *patch.wateringEnabled ? 1 : 0);
+    }
+    putU32(kKeyReadIv, patch.sensorReadIntervalMs);
+    putU32(kKeyLogIv, patch.dataLogIntervalMs);
+    for (MetricId id = 0; id < metric::kKnownCount; ++id) {
+        const std::optional<MetricLogPolicy>& policy = patch.logPolicies[id];
+        if (policy.has_value()) {
+            putFloat(policyKey(kKeyLogPolicyAbs, id).c_str(), policy->deadbandAbs);
+            putFloat(policyKey(kKeyLogPolicyRel, id).c_str(), policy->deadbandRel);
+            putU32(policyKey(kKeyLogPolicyHeartbeat, id).c_str(), policy->heartbeatS);
+        }
+    }
+    if (!commitValue(h, "config patch", err)) {
+        // Entries set before the failure may have reached flash anyway;
+        // re-read so the cache matches whatever NVS now holds.
+        load();
+        ++generation_;
+        return false;
+    }
+
+    auto take = [](const auto& value, auto& cached) {
+        if (value.has_value()) {
+            cached = *value;
+        }
+    };
+    take(patch.moistureThresholdLow, cache_.moistureThresholdLow);
+    take(patch.moistureThresholdHigh, cache_.moistureThresholdHigh);
+    take(patch.wateringDurationS, cache_.wateringDurationS);
+    take(patch.minWateringIntervalS, cache_.minWateringIntervalS);
+    take(patch.wateringEnabled, cache_.wateringEnabled);
+    take(patch.sensorReadIntervalMs, cache_.sensorReadIntervalMs);
+    take(patch.dataLogIntervalMs, cache_.dataLogIntervalMs);
+    for (MetricId id = 0; id < metric::kKnownCount; ++id) {
+        take(patch.logPolicies[id], cache_.logPolicies[id]);
+    }
+    ++generation_;
+    return true;
 }
 
 std::string NvsConfigStore::getWifiSsid() const
 {
-    return getString(kKeyWifiSsid, kWifiSsidMaxLen);
+    return cache_.wifiSsid;
 }
 
 std::string NvsConfigStore::getWifiPassword() const
 {
-    return getString(kKeyWifiPass, kWifiPasswordMaxLen);
+    return cache_.wifiPassword;
 }
 
 bool NvsConfigStore::setWifiCredentials(const std::string& ssid,
@@ -348,6 +596,9 @@ bool NvsConfigStore::setWifiCredentials(const std::string& ssid,
                  esp_err_to_name(err));
         return false;
     }
+    cache_.wifiSsid = ssid;
+    cache_.wifiPassword = password;
+    ++generation_;
     return true;
 }
 
@@ -357,6 +608,9 @@ bool NvsConfigStore::clearWifiCredentials()
     if (!handle.ok()) {
         // Namespace never created = already in the factory (empty) state.
         if (handle.error() == ESP_ERR_NVS_NOT_FOUND) {
+            cache_.wifiSsid.clear();
+            cache_.wifiPassword.clear();
+            ++generation_;
             return true;
         }
         ESP_LOGE(TAG, "nvs_open for wifi credentials failed: %s",
@@ -381,6 +635,89 @@ bool NvsConfigStore::clearWifiCredentials()
                  esp_err_to_name(err));
         return false;
     }
+    cache_.wifiSsid.clear();
+    cache_.wifiPassword.clear();
+    ++generation_;
+    return true;
+}
+
+StaticIpConfig NvsConfigStore::getStaticIp() const
+{
+    return cache_.staticIp;
+}
+
+bool NvsConfigStore::setStaticIp(const StaticIpConfig& ip)
+{
+    if (!isValidStaticIp(ip)) {
+        return false;
+    }
+    NvsHandleGuard handle(kNamespace, NVS_READWRITE);
+    if (!handle.ok()) {
+        ESP_LOGE(TAG, "nvs_open for static IP failed: %s",
+                 esp_err_to_name(handle.error()));
+        return false;
+    }
+    esp_err_t err = nvs_set_u32(handle.get(), kKeyIpAddr, ip.address);
+    if (err == ESP_OK) {
+        err = nvs_set_u32(handle.get(), kKeyIpMask, ip.netmask);
+    }
+    if (err == ESP_OK) {
+        err = nvs_set_u32(handle.get(), kKeyIpGateway, ip.gateway);
+    }
+    if (err == ESP_OK) {
+        err = nvs_set_u32(handle.get(), kKeyIpDns, ip.dns);
+    }
+    if (err == ESP_OK) {
+        err = nvs_commit(handle.get());
+    }
+    if (err != ESP_OK) {
+        ESP_LOGE(TAG, "persisting static IP failed: %s", esp_err_to_name(err));
+        return false;
+    }
+    cache_.staticIp = ip;
+    ++generation_;
+    return true;
+}
+
+HttpdSettings NvsConfigStore::getHttpdSettings() const
+{
+    return cache_.httpd;
+}
+
+bool NvsConfigStore::setHttpdSettings(const HttpdSettings& settings)
+{
+    if (!isValidHttpdSettings(settings)) {
+        return false;
+    }
+    NvsHandleGuard handle(kNamespace, NVS_READWRITE);
+    if (!handle.ok()) {
+        ESP_LOGE(TAG, "nvs_open for httpd settings failed: %s",
+                 esp_err_to_name(handle.error()));
+        return false;
+    }
+    const std::array<std::pair<const char*, uint32_t>, 6> entries = {{
+        {kKeyHttpdSockets, settings.maxOpenSockets},
+        {kKeyHttpdBacklog, settings.backlog},
+        {kKeyHttpdStack, settings.stackBytes},
+        {kKeyHttpdRecvTimeout, settings.recvTimeoutS},
+        {kKeyHttpdSendTimeout, settings.sendTimeoutS},
+        {kKeyHttpdLru, settings.lruPurge ? 1u : 0u},
+    }};
+    esp_err_t err = ESP_OK;
+    for (const auto& [key, value] : entries) {
+        if (err == ESP_OK) {
+            err = nvs_set_u32(handle.get(), key, value);
+        }
+    }
+    if (err == ESP_OK) {
+        err = nvs_commit(handle.get());
+    }
+    if (err != ESP_OK) {
+        ESP_LOGE(TAG, "persisting httpd settings failed: %s", esp_err_to_name(err));
+        return false;
+    }
+    cache_.httpd = settings;
+    ++generation_;
     return true;
 }
 
@@ -394,6 +731,8 @@ bool NvsConfigStore::factoryReset()
         ESP_LOGE(TAG, "nvs partition erase failed: %s", esp_err_to_name(err));
         return false;
     }
+    cache_ = Cache{};  // the erase already took every entry
+    ++generation_;
     err = nvs_flash_init();
     if (err != ESP_OK) {
         ESP_LOGE(TAG, "nvs re-init after factory reset failed: %s",
@@ -0,0 +1,309 @@
+// SPDX-FileCopyrightText: 2026 Cryptotomte
+// SPDX-License-Identifier: AGPL-3.0-or-later
+/**
+ * @file QueuedDataStorage.cpp
+ * @brief Bounded write queue in front of an IDataStorage (see the header).
+ */
+
+#include "storage/QueuedDataStorage.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstring>
+
+#include "interfaces/EventCodec.h"
+
+namespace {
+
+/// Consecutive queued samples are applied as one storeSamples() batch of
+/// up to this many (a full logging pass is metric::kKnownCount).
+constexpr std::size_t kApplyBatch = metric::kKnownCount;
+
+}  // namespace
+
+QueuedDataStorage::QueuedDataStorage(IDataStorage& target, std::size_t capacity)
+    : target_(target), slots_(capacity)
+{
+    stats_.capacity = static_cast<uint32_t>(capacity);
+}
+
+template <typename Fill>
+bool QueuedDataStorage::enqueue(std::size_t count, Fill fill)
+{
+    {
+        std::lock_guard<std::mutex> lock(queueMutex_);
+        if (count > slots_.size() - size_) {
+            stats_.dropped += static_cast<uint32_t>(count);
+            return false;
+        }
+        for (std::size_t i = 0; i < count; ++i) {
+            fill(slots_[(head_ + size_) % slots_.size()], i);
+            ++size_;
+        }
+        stats_.highWater = std::max(stats_.highWater, static_cast<uint32_t>(size_));
+    }
+    wake_.notify_one();
+    return true;
+}
+
+bool QueuedDataStorage::storeSensorReading(const std::string& metric,
+                                           uint32_t epoch, float value)
+{
+    const MetricId id = metric::findKnown(metric);
+    if (id != metric::kInvalid) {
+        const MetricSample sample{id, epoch, value};
+        return storeSamples(&sample, 1) == 1;
+    }
+    if (metric.size() > kEventDetailMaxLen) {
+        applyQueued();  // keep arrival order ahead of the write-through
+        return target_.storeSensorReading(metric, epoch, value);
+    }
+    return enqueue(1, [&](Slot& slot, std::size_t) {
+        slot.kind = Slot::kNamed;
+        slot.sample = MetricSample{metric::kInvalid, epoch, value};
+        slot.textLen = static_cast<uint8_t>(metric.size());
+        std::memcpy(slot.text, metric.data(), metric.size());
+    });
+}
+
+std::size_t QueuedDataStorage::storeSensorReadings(const SensorReading* readings,
+                                                   std::size_t count)
+{
+    const bool allFit = std::all_of(readings, readings + count, [](const SensorReading& r) {
+        return r.metric.size() <= kEventDetailMaxLen;
+    });
+    if (!allFit) {
+        return IDataStorage::storeSensorReadings(readings, count);
+    }
+    const bool queued = enqueue(count, [&](Slot& slot, std::size_t i) {
+        const SensorReading& reading = readings[i];
+        const MetricId id = metric::findKnown(reading.metric);
+        slot.kind = id != metric::kInvalid ? Slot::kSample : Slot::kNamed;
+        slot.sample = MetricSample{id, reading.epoch, reading.value};
+        slot.textLen = static_cast<uint8_t>(reading.metric.size());
+        std::memcpy(slot.text, reading.metric.data(), reading.metric.size());
+    });
+    return queued ? count : 0;
+}
+
+std::size_t QueuedDataStorage::storeSamples(const MetricSample* samples,
+                                            std::size_t count)
+{
+    const bool queued = enqueue(count, [&](Slot& slot, std::size_t i) {
+        slot.kind = Slot::kSample;
+        slot.sample = samples[i];
+    });
+    return queued ? count : 0;
+}
+
+bool QueuedDataStorage::storeEvent(uint32_t epoch, uint8_t category,
+                                   std::string_view detail)
+{
+    const std::size_t len = std::min(detail.size(), kEventDetailMaxLen);
+    {
+        std::lock_guard<std::mutex> lock(queueMutex_);
+        if (size_ != 0) {
+            Slot& newest = slots_[(head_ + size_ - 1) % slots_.size()];
+            if (newest.kind == Slot::kEvent && newest.category == category &&
+                newest.textLen == len &&
+                std::memcmp(newest.text, detail.data(), len) == 0) {
+                ++newest.repeats;
+                newest.lastEpoch = epoch;
+                ++stats_.coalesced;
+                return true;
+            }
+        }
+    }
+    return enqueue(1, [&](Slot& slot, std::size_t) {
+        slot.kind = Slot::kEvent;
+        slot.category = category;
+        slot.sample = MetricSample{metric::kInvalid, epoch, 0.0f};
+        slot.textLen = static_cast<uint8_t>(len);
+        slot.repeats = 0;
+        slot.lastEpoch = epoch;
+        std::memcpy(slot.text, detail.data(), len);
+    });
+}
+
+std::vector<SensorReading> QueuedDataStorage::getSensorReadings(
+    const std::string& metric, uint32_t t0, uint32_t t1) const
+{
+    applyQueued();
+    return target_.getSensorReadings(metric, t0, t1);
+}
+
+std::size_t QueuedDataStorage::forEachReading(const std::string& metric,
+                                              uint32_t t0, uint32_t t1,
+                                              IReadingVisitor& visitor) const
+{
+    applyQueued();
+    return target_.forEachReading(metric, t0, t1, visitor);
+}
+
+std::vector<SensorAggregate> QueuedDataStorage::getSensorAggregates(
+    const std::string& metric, uint32_t t0, uint32_t t1, uint32_t bucketS) const
+{
+    applyQueued();
+    return target_.getSensorAggregates(metric, t0, t1, bucketS);
+}
+
+SensorWindowStats QueuedDataStorage::getSensorWindowStats(const std::string& metric,
+                                                          uint32_t t0,
+                                                          uint32_t t1) const
+{
+    applyQueued();
+    return target_.getSensorWindowStats(metric, t0, t1);
+}
+
+QuantileSketch QueuedDataStorage::getSensorQuantiles(const std::string& metric,
+                                                     uint32_t t0, uint32_t t1) const
+{
+    applyQueued();
+    return target_.getSensorQuantiles(metric, t0, t1);
+}
+
+LatestReading QueuedDataStorage::latestReading(const std::string& metric) const
+{
+    applyQueued();
+    return target_.latestReading(metric);
+}
+
+std::vector<SensorReading> QueuedDataStorage::getLatestReadings(const std::string& metric,
+                                                                std::size_t n) const
+{
+    applyQueued();
+    return target_.getLatestReadings(metric, n);
+}
+
+std::vector<EventRecord> QueuedDataStorage::getEvents(std::size_t maxCount) const
+{
+    applyQueued();
+    return target_.getEvents(maxCount);
+}
+
+EventPage QueuedDataStorage::queryEvents(const EventQuery& query) const
+{
+    applyQueued();
+    return target_.queryEvents(query);
+}
+
+StorageStats QueuedDataStorage::getStorageStats() const
+{
+    // Not drained first: the stats should show the queue as it stands.
+    StorageStats stats = target_.getStorageStats();
+    std::lock_guard<std::mutex> lock(queueMutex_);
+    stats.queue = stats_;
+    stats.queue.depth = static_cast<uint32_t>(size_);
+    return stats;
+}
+
+bool QueuedDataStorage::flush()
+{
+    applyQueued();
+    return target_.flush();
+}
+
+bool QueuedDataStorage::flushIfDue()
+{
+    {
+        std::lock_guard<std::mutex> lock(queueMutex_);
+        flushDue_ = true;
+    }
+    wake_.notify_one();
+    return true;
+}
+
+std::size_t QueuedDataStorage::waitAndApply(uint32_t timeoutMs)
+{
+    bool pollFlush = false;
+    {
+        std::unique_lock<std::mutex> lock(queueMutex_);
+        wake_.wait_for(lock, std::chrono::milliseconds(timeoutMs),
+                       [this] { return size_ != 0 || flushDue_; });
+        pollFlush = flushDue_;
+        flushDue_ = false;
+    }
+    const std::size_t applied = applyQueued();
+    if (pollFlush) {
+        target_.flushIfDue();
+    }
+    return applied;
+}
+
+std::size_t QueuedDataStorage::applyQueued() const
+{
+    std::lock_guard<std::mutex> applying(applyMutex_);
+    std::size_t applied = 0;
+    while (true) {
+        // Pop one slot, or the run of consecutive samples at the head as a
+        // batch; the slots are freed before the (slow) target write.
+        Slot slot;
+        MetricSample batch[kApplyBatch];
+        std::size_t batched = 0;
+        {
+            std::lock_guard<std::mutex> lock(queueMutex_);
+            if (size_ == 0) {
+                break;
+            }
+            while (size_ != 0 && batched < kApplyBatch &&
+                   slots_[head_].kind == Slot::kSample) {
+                batch[batched++] = slots_[head_].sample;
+                head_ = (head_ + 1) % slots_.size();
+                --size_;
+            }
+            if (batched == 0) {
+                slot = slots_[head_];
+                head_ = (head_ + 1) % slots_.size();
+                --size_;
+            }
+        }
+        std::size_t failed = 0;
+        if (batched != 0) {
+            failed = batched - target_.storeSamples(batch, batched);
+            applied += batched;
+        } else {
+            failed = apply(slot) ? 0 : 1;
+            ++applied;
+        }
+        std::lock_guard<std::mutex> lock(queueMutex_);
+        stats_.applied += static_cast<uint32_t>(batched != 0 ? batched : 1);
+        stats_.failed += static_cast<uint32_t>(failed);
+    }
+    return applied;
+}
+
+bool QueuedDataStorage::apply(const Slot& slot) const
+{
+    if (slot.kind == Slot::kEvent && slot.repeats == 0) {
+        return target_.storeEvent(slot.sample.epoch, slot.category,
+                                  std::string_view(slot.text, slot.textLen));
+    }
+    if (slot.kind == Slot::kEvent && isCompactEvent(std::string_view(slot.text, slot.textLen))) {
+        // A compact detail carries the repeat as a trailer (EventCodec.h);
+        // the encoder leaves room for it.
+        char detail[kEventDetailMaxLen];
+        std::memcpy(detail, slot.text, slot.textLen);
+        const std::size_t trailer =
+            encodeEventRepeat(detail + slot.textLen, slot.repeats + 1, slot.lastEpoch);
+        return target_.storeEvent(slot.sample.epoch, slot.category,
+                                  std::string_view(detail, slot.textLen + trailer));
+    }
+    if (slot.kind == Slot::kEvent) {
+        // The suffix always fits: the detail gives way to it.
+        char suffix[40];
+        const int n = std::snprintf(suffix, sizeof suffix, " count=%lu last=%lu",
+                                    static_cast<unsigned long>(slot.repeats) + 1,
+                                    static_cast<unsigned long>(slot.lastEpoch));
+        const std::size_t suffixLen = static_cast<std::size_t>(n);
+        const std::size_t keep =
+            std::min<std::size_t>(slot.textLen, kEventDetailMaxLen - suffixLen);
+        char detail[kEventDetailMaxLen];
+        std::memcpy(detail, slot.text, keep);
+        std::memcpy(detail + keep, suffix, suffixLen);
+        return target_.storeEvent(slot.sample.epoch, slot.category,
+                                  std::string_view(detail, keep + suffixLen));
+    }
+    const std::string text(slot.text, slot.textLen);
+    return target_.storeSensorReading(text, slot.sample.epoch, slot.sample.value);
+}
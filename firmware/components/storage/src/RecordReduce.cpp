@@ -0,0 +1,136 @@
+// SPDX-FileCopyrightText: 2026 Cryptotomte
+// SPDX-License-Identifier: AGPL-3.0-or-later
+/**
+ * @file RecordReduce.cpp
+ * @brief The scalar reference and the lane kernel behind RecordReduce.h.
+ */
+
+#include "storage/RecordReduce.h"
+
+#include <cstring>
+
+namespace recordreduce {
+
+namespace {
+
+inline void load(const uint8_t* bytes, uint32_t& epoch, float& value)
+{
+#if defined(__BYTE_ORDER__) && __BYTE_ORDER__ == __ORDER_LITTLE_ENDIAN__
+    std::memcpy(&epoch, bytes, sizeof(epoch));
+    std::memcpy(&value, bytes + 4, sizeof(value));
+#else
+    epoch = static_cast<uint32_t>(bytes[0]) | (static_cast<uint32_t>(bytes[1]) << 8) |
+            (static_cast<uint32_t>(bytes[2]) << 16) | (static_cast<uint32_t>(bytes[3]) << 24);
+    const uint32_t bits =
+        static_cast<uint32_t>(bytes[4]) | (static_cast<uint32_t>(bytes[5]) << 8) |
+        (static_cast<uint32_t>(bytes[6]) << 16) | (static_cast<uint32_t>(bytes[7]) << 24);
+    std::memcpy(&value, &bits, sizeof(value));
+#endif
+}
+
+/// One lane's share: every kLanes-th record. lastIndex breaks a tie on
+/// maxEpoch between lanes in favour of the later record.
+struct Lane {
+    float min;
+    float max;
+    double sum;
+    uint32_t minEpoch;
+    uint32_t maxEpoch;
+    float last;
+    std::size_t lastIndex;
+};
+
+inline void step(Lane& lane, uint32_t epoch, float value, std::size_t index)
+{
+    lane.min = value < lane.min ? value : lane.min;
+    lane.max = value > lane.max ? value : lane.max;
+    lane.sum += value;
+    lane.minEpoch = epoch < lane.minEpoch ? epoch : lane.minEpoch;
+    if (epoch >= lane.maxEpoch) {
+        lane.maxEpoch = epoch;
+        lane.last = value;
+        lane.lastIndex = index;
+    }
+}
+
+}  // namespace
+
+void reduceScalar(const uint8_t* bytes, std::size_t count, Reduction& out)
+{
+    for (std::size_t i = 0; i < count; ++i, bytes += kRecordBytes) {
+        uint32_t epoch = 0;
+        float value = 0.0f;
+        load(bytes, epoch, value);
+        out.add(epoch, value);
+    }
+}
+
+void reduce(const uint8_t* bytes, std::size_t count, Reduction& out)
+{
+    if (count < kLanes) {
+        reduceScalar(bytes, count, out);
+        return;
+    }
+    // Every lane starts from record 0: folding it in again changes no
+    // min, max or epoch, and its sum is only added once (lane 0's turn).
+    uint32_t epoch0 = 0;
+    float value0 = 0.0f;
+    load(bytes, epoch0, value0);
+    Lane lanes[kLanes];
+    for (Lane& lane : lanes) {
+        lane = Lane{value0, value0, 0.0, epoch0, epoch0, value0, 0};
+    }
+
+    const std::size_t whole = count - count % kLanes;
+    const uint8_t* p = bytes;
+    for (std::size_t i = 0; i < whole; i += kLanes, p += kLanes * kRecordBytes) {
+        for (std::size_t l = 0; l < kLanes; ++l) {
+            uint32_t epoch = 0;
+            float value = 0.0f;
+            load(p + l * kRecordBytes, epoch, value);
+            step(lanes[l], epoch, value, i + l);
+        }
+    }
+    for (std::size_t i = whole; i < count; ++i, p += kRecordBytes) {
+        uint32_t epoch = 0;
+        float value = 0.0f;
+        load(p, epoch, value);
+        step(lanes[i % kLanes], epoch, value, i);
+    }
+
+    Lane all = lanes[0];
+    for (std::size_t l = 1; l < kLanes; ++l) {
+        const Lane& lane = lanes[l];
+        all.min = lane.min < all.min ? lane.min : all.min;
+        all.max = lane.max > all.max ? lane.max : all.max;
+        all.sum += lane.sum;
+        all.minEpoch = lane.minEpoch < all.minEpoch ? lane.minEpoch : all.minEpoch;
+        if (lane.maxEpoch > all.maxEpoch ||
+            (lane.maxEpoch == all.maxEpoch && lane.lastIndex > all.lastIndex)) {
+            all.maxEpoch = lane.maxEpoch;
+            all.last = lane.last;
+            all.lastIndex = lane.lastIndex;
+        }
+    }
+
+    // These records come after whatever `out` already holds.
+    if (out.count == 0) {
+        out.min = all.min;
+        out.max = all.max;
+        out.minEpoch = all.minEpoch;
+        out.maxEpoch = all.maxEpoch;
+        out.last = all.last;
+    } else {
+        out.min = all.min < out.min ? all.min : out.min;
+        out.max = all.max > out.max ? all.max : out.max;
+        out.minEpoch = all.minEpoch < out.minEpoch ? all.minEpoch : out.minEpoch;
+        if (all.maxEpoch >= out.maxEpoch) {
+            out.maxEpoch = all.maxEpoch;
+            out.last = all.last;
+        }
+    }
+    out.sum += all.sum;
+    out.count += static_cast<uint32_t>(count);
+}
+
+}  // namespace recordreduce
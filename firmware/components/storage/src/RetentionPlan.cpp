@@ -0,0 +1,195 @@
+// SPDX-FileCopyrightText: 2026 Cryptotomte
+// SPDX-License-Identifier: AGPL-3.0-or-later
+/**
+ * @file RetentionPlan.cpp
+ * @brief Retention rule parsing and the chunk split (pure C++, host-tested).
+ */
+
+#include "storage/RetentionPlan.h"
+
+#include <algorithm>
+#include <utility>
+
+namespace retention {
+
+namespace {
+
+std::string_view trim(std::string_view text)
+{
+    while (!text.empty() && (text.front() == ' ' || text.front() == '\t')) {
+        text.remove_prefix(1);
+    }
+    while (!text.empty() && (text.back() == ' ' || text.back() == '\t')) {
+        text.remove_suffix(1);
+    }
+    return text;
+}
+
+/// Decimal digits only, 1 .. 100000 (nobody keeps 270 years of history).
+bool parseCount(std::string_view text, uint32_t& out)
+{
+    if (text.empty() || text.size() > 6) {
+        return false;
+    }
+    uint32_t value = 0;
+    for (char c : text) {
+        if (c < '0' || c > '9') {
+            return false;
+        }
+        value = value * 10 + static_cast<uint32_t>(c - '0');
+    }
+    if (value == 0 || value > 100000) {
+        return false;
+    }
+    out = value;
+    return true;
+}
+
+/// Same rule as the storage's directory names: no '/', no "..".
+bool isSafeName(std::string_view name)
+{
+    return !name.empty() && name.find('/') == std::string_view::npos &&
+           name.find("..") == std::string_view::npos;
+}
+
+std::size_t ceilDiv(uint64_t a, uint64_t b)
+{
+    return static_cast<std::size_t>((a + b - 1) / b);
+}
+
+}  // namespace
+
+bool parseRules(std::string_view spec, std::vector<Rule>& rules)
+{
+    std::vector<Rule> parsed;
+    while (!spec.empty()) {
+        const std::size_t comma = spec.find(',');
+        const std::string_view entry = trim(spec.substr(0, comma));
+        spec = comma == std::string_view::npos ? std::string_view() : spec.substr(comma + 1);
+        if (entry.empty()) {
+            continue;
+        }
+        const std::size_t colon = entry.find(':');
+        if (colon == std::string_view::npos) {
+            return false;
+        }
+        Rule rule;
+        const std::string_view name = trim(entry.substr(0, colon));
+        std::string_view value = trim(entry.substr(colon + 1));
+        if (!isSafeName(name)) {
+            return false;
+        }
+        rule.metric = std::string(name);
+        if (!value.empty() && value.back() == 'd') {
+            value.remove_suffix(1);
+            if (!parseCount(value, rule.targetDays)) {
+                return false;
+            }
+        } else if (!parseCount(value, rule.weight)) {
+            return false;
+        }
+        parsed.erase(std::remove_if(parsed.begin(), parsed.end(),
+                                    [&](const Rule& r) { return r.metric == rule.metric; }),
+                     parsed.end());
+        parsed.push_back(std::move(rule));
+    }
+    rules.insert(rules.end(), parsed.begin(), parsed.end());
+    return true;
+}
+
+std::size_t Plan::chunksFor(std::string_view metric) const
+{
+    if (!planned_) {
+        return 0;
+    }
+    for (const Entry& entry : entries_) {
+        if (entry.metric == metric) {
+            return entry.chunks;
+        }
+    }
+    return otherChunks_;
+}
+
+uint32_t Plan::coveredDays(std::size_t chunks, const Budget& budget)
+{
+    if (chunks < 2 || budget.bytesPerReading == 0) {
+        return 0;
+    }
+    const uint64_t readings =
+        static_cast<uint64_t>(chunks - 1) * (budget.chunkBytes / budget.bytesPerReading);
+    return static_cast<uint32_t>(readings * budget.intervalS / 86400);
+}
+
+Plan plan(const Budget& budget, const std::vector<Rule>& rules)
+{
+    Plan result;
+    result.planned_ = true;
+    const std::size_t total = budget.chunkBytes == 0 ? 0 : budget.bytes / budget.chunkBytes;
+    const std::size_t others = budget.metrics > rules.size() ? budget.metrics - rules.size() : 0;
+
+    // 1. The floor.
+    const std::size_t floor = kMinChunks * (rules.size() + others);
+    std::size_t free = total > floor ? total - floor : 0;
+    result.fits_ = total >= floor;
+    for (const Rule& rule : rules) {
+        result.entries_.push_back(Plan::Entry{rule.metric, kMinChunks});
+    }
+    result.otherChunks_ = kMinChunks;
+
+    // 2. Targets, in configured order: the sealed chunks that hold the
+    //    days, plus the active one.
+    for (std::size_t i = 0; i < rules.size(); ++i) {
+        if (rules[i].targetDays == 0 || budget.bytesPerReading == 0 ||
+            budget.intervalS == 0) {
+            continue;
+        }
+        const uint64_t readings =
+            ceilDiv(static_cast<uint64_t>(rules[i].targetDays) * 86400, budget.intervalS);
+        const std::size_t need =
+            std::max(kMinChunks,
+                     ceilDiv(readings, budget.chunkBytes / budget.bytesPerReading) + 1);
+        const std::size_t extra = std::min(need - kMinChunks, free);
+        result.entries_[i].chunks += extra;
+        free -= extra;
+        result.fits_ = result.fits_ && extra == need - kMinChunks;
+    }
+
+    // 3. The rest by weight: whole chunks first, then one each in order of
+    //    the largest remainder (rules only: the unnamed metrics all get
+    //    the same).
+    uint64_t weightSum = static_cast<uint64_t>(others) * budget.defaultWeight;
+    for (const Rule& rule : rules) {
+        weightSum += rule.weight;
+    }
+    if (weightSum != 0 && free != 0) {
+        std::size_t given = 0;
+        std::vector<std::pair<uint64_t, std::size_t>> remainders;  // (remainder, rule)
+        for (std::size_t i = 0; i < rules.size(); ++i) {
+            const uint64_t share = static_cast<uint64_t>(free) * rules[i].weight;
+            result.entries_[i].chunks += static_cast<std::size_t>(share / weightSum);
+            given += static_cast<std::size_t>(share / weightSum);
+            if (rules[i].weight != 0) {
+                remainders.emplace_back(share % weightSum, i);
+            }
+        }
+        const std::size_t perOther =
+            others == 0 ? 0
+                        : static_cast<std::size_t>(static_cast<uint64_t>(free) *
+                                                   budget.defaultWeight / weightSum);
+        result.otherChunks_ += perOther;
+        given += perOther * others;
+        std::stable_sort(remainders.begin(), remainders.end(),
+                         [](const auto& a, const auto& b) { return a.first > b.first; });
+        for (std::size_t k = 0; k < remainders.size() && given < free; ++k, ++given) {
+            ++result.entries_[remainders[k].second].chunks;
+        }
+    }
+
+    result.totalChunks_ = result.otherChunks_ * others;
+    for (const Plan::Entry& entry : result.entries_) {
+        result.totalChunks_ += entry.chunks;
+    }
+    return result;
+}
+
+}  // namespace retention
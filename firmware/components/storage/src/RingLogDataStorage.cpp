@@ -0,0 +1,494 @@
+// SPDX-FileCopyrightText: 2026 Cryptotomte
+// SPDX-License-Identifier: AGPL-3.0-or-later
+/**
+ * @file RingLogDataStorage.cpp
+ * @brief IDataStorage as CRC-framed sector rings on a raw partition.
+ *
+ * Pure C++ over IFlashPartition, no IDF includes: the same code runs
+ * against EspFlashPartition on target and RamFlashPartition in the host
+ * tests. Format and recovery rules in RingLogDataStorage.h.
+ */
+
+#include "storage/RingLogDataStorage.h"
+
+#include <algorithm>
+#include <cstring>
+#include <initializer_list>
+#include <utility>
+
+namespace {
+
+constexpr std::size_t kHistoryFixedBytes = 6;  ///< epoch + mask
+constexpr std::size_t kEventFixedBytes = 5;    ///< epoch + category
+constexpr uint8_t kErased = 0xFF;
+
+/// CRC-16/CCITT-FALSE (poly 0x1021, init 0xFFFF).
+uint16_t crc16(const uint8_t* data, std::size_t len)
+{
+    uint16_t crc = 0xFFFF;
+    for (std::size_t i = 0; i < len; ++i) {
+        crc = static_cast<uint16_t>(crc ^ (static_cast<uint16_t>(data[i]) << 8));
+        for (int bit = 0; bit < 8; ++bit) {
+            crc = static_cast<uint16_t>((crc & 0x8000) != 0 ? (crc << 1) ^ 0x1021
+                                                            : crc << 1);
+        }
+    }
+    return crc;
+}
+
+void put16(uint8_t* p, uint16_t v)
+{
+    p[0] = static_cast<uint8_t>(v & 0xFF);
+    p[1] = static_cast<uint8_t>(v >> 8);
+}
+
+void put32(uint8_t* p, uint32_t v)
+{
+    for (int i = 0; i < 4; ++i) {
+        p[i] = static_cast<uint8_t>((v >> (8 * i)) & 0xFF);
+    }
+}
+
+uint16_t get16(const uint8_t* p)
+{
+    return static_cast<uint16_t>(p[0] | (p[1] << 8));
+}
+
+uint32_t get32(const uint8_t* p)
+{
+    return static_cast<uint32_t>(p[0]) | (static_cast<uint32_t>(p[1]) << 8) |
+           (static_cast<uint32_t>(p[2]) << 16) | (static_cast<uint32_t>(p[3]) << 24);
+}
+
+bool allErased(const uint8_t* p, std::size_t len)
+{
+    for (std::size_t i = 0; i < len; ++i) {
+        if (p[i] != kErased) {
+            return false;
+        }
+    }
+    return true;
+}
+
+/// Adds the lifetime of an append call to `totalUs` (no-op without a clock).
+class AppendTimer {
+public:
+    AppendTimer(const std::function<int64_t()>& clock, uint64_t& totalUs)
+        : clock_(clock), totalUs_(totalUs), startUs_(clock ? clock() : 0)
+    {
+    }
+    ~AppendTimer()
+    {
+        if (clock_) {
+            totalUs_ += static_cast<uint64_t>(std::max<int64_t>(clock_() - startUs_, 0));
+        }
+    }
+    AppendTimer(const AppendTimer&) = delete;
+    AppendTimer& operator=(const AppendTimer&) = delete;
+
+private:
+    const std::function<int64_t()>& clock_;
+    uint64_t& totalUs_;
+    int64_t startUs_;
+};
+
+/// Number of set bits below `bit` in `mask`: the value index of that
+/// metric inside a history frame.
+std::size_t valueIndex(uint16_t mask, uint16_t bit)
+{
+    std::size_t index = 0;
+    for (uint16_t below = static_cast<uint16_t>(mask & (bit - 1)); below != 0;
+         below = static_cast<uint16_t>(below & (below - 1))) {
+        ++index;
+    }
+    return index;
+}
+
+}  // namespace
+
+RingLogDataStorage::RingLogDataStorage(IFlashPartition& flash,
+                                       std::function<int64_t()> appendClock)
+    : flash_(flash), appendClock_(std::move(appendClock))
+{
+    const std::size_t sectors = flash_.size() / kSectorBytes;
+    if (sectors < kMinSectors) {
+        return;  // unusable: appends fail, queries are empty
+    }
+    usable_ = true;
+    events_.id = 0;
+    events_.first = 0;
+    events_.sectors.resize(kEventSectors);
+    history_.id = 1;
+    history_.first = kEventSectors;
+    history_.sectors.resize(sectors - kEventSectors);
+    frameScratch_.reserve(kFrameOverheadBytes + 255);
+    recoverRing(events_);
+    recoverRing(history_);
+}
+
+void RingLogDataStorage::recoverRing(Ring& ring)
+{
+    ring.order.clear();
+    for (std::size_t slot = 0; slot < ring.sectors.size(); ++slot) {
+        scanSector(ring, slot);
+        if (ring.sectors[slot].live) {
+            ring.order.push_back(slot);
+        }
+    }
+    std::sort(ring.order.begin(), ring.order.end(),
+              [&ring](std::size_t a, std::size_t b) {
+                  return ring.sectors[a].seq < ring.sectors[b].seq;
+              });
+    ring.nextSeq = ring.order.empty() ? 1 : ring.sectors[ring.order.back()].seq + 1;
+    if (!ring.order.empty() && ring.sectors[ring.order.back()].sealed) {
+        ++writes_.tornRepairs;  // appends resume in a fresh sector
+    }
+}
+
+void RingLogDataStorage::scanSector(Ring& ring, std::size_t slot)
+{
+    Sector& sector = ring.sectors[slot];
+    sector = Sector{};
+    const uint8_t* bytes = sectorBytes(ring, slot, kSectorBytes);
+    if (bytes == nullptr || get32(bytes) != kSectorMagic ||
+        bytes[8] != ring.id || bytes[9] != kFormatVersion ||
+        get16(bytes + 10) != crc16(bytes, 10)) {
+        return;  // erased, torn mid-erase/header, or another layout: free
+    }
+    sector.live = true;
+    sector.seq = get32(bytes + 4);
+    const uint8_t expected = ring.id == history_.id ? kHistoryFrame : kEventFrame;
+    std::size_t offset = kSectorHeaderBytes;
+    while (offset < kSectorBytes) {
+        if (bytes[offset] == kErased) {
+            // The end marker — unless a torn write left programmed bytes
+            // behind it, which must never be programmed over.
+            sector.sealed = !allErased(bytes + offset, kSectorBytes - offset);
+            break;
+        }
+        const std::size_t len = offset + 1 < kSectorBytes ? bytes[offset + 1] : 0;
+        const std::size_t frameBytes = len + kFrameOverheadBytes;
+        if (offset + frameBytes > kSectorBytes ||
+            get16(bytes + offset + 2 + len) != crc16(bytes + offset, len + 2)) {
+            sector.sealed = true;  // torn or damaged frame ends the prefix
+            break;
+        }
+        const uint8_t* payload = bytes + offset + 2;
+        if (bytes[offset] == expected && len >= 4) {
+            const uint32_t epoch = get32(payload);
+            sector.minEpoch = std::min(sector.minEpoch, epoch);
+            sector.maxEpoch = std::max(sector.maxEpoch, epoch);
+            if (expected == kHistoryFrame && len >= kHistoryFixedBytes) {
+                sector.metricMask =
+                    static_cast<uint16_t>(sector.metricMask | get16(payload + 4));
+            }
+        }
+        offset += frameBytes;
+    }
+    sector.valid = static_cast<uint16_t>(std::min(offset, kSectorBytes));
+}
+
+const uint8_t* RingLogDataStorage::sectorBytes(const Ring& ring, std::size_t slot,
+                                               std::size_t len) const
+{
+    const std::size_t offset = (ring.first + slot) * kSectorBytes;
+    const uint8_t* map = flash_.mapped();
+    if (map != nullptr) {
+        return map + offset;
+    }
+    sectorScratch_.resize(kSectorBytes);
+    return flash_.read(offset, sectorScratch_.data(), len) ? sectorScratch_.data()
+                                                           : nullptr;
+}
+
+bool RingLogDataStorage::advance(Ring& ring)
+{
+    const std::size_t slot =
+        ring.order.empty() ? 0 : (ring.order.back() + 1) % ring.sectors.size();
+    // Eviction: whatever the slot held (normally the ring's oldest
+    // sector) is gone from the moment the erase starts.
+    if (ring.id == events_.id && !ring.order.empty()) {
+        ++writes_.rotations;
+    }
+    if (ring.sectors[slot].live) {
+        ++writes_.filesRemoved;
+    }
+    ring.order.erase(std::remove(ring.order.begin(), ring.order.end(), slot),
+                     ring.order.end());
+    ring.sectors[slot] = Sector{};
+    if (!flash_.eraseSector(ring.first + slot)) {
+        return false;
+    }
+    uint8_t header[kSectorHeaderBytes];
+    put32(header, kSectorMagic);
+    put32(header + 4, ring.nextSeq);
+    header[8] = ring.id;
+    header[9] = kFormatVersion;
+    put16(header + 10, crc16(header, 10));
+    if (!program((ring.first + slot) * kSectorBytes, header, sizeof(header))) {
+        return false;  // not live: the next append erases the slot again
+    }
+    ++writes_.filesCreated;
+    Sector& sector = ring.sectors[slot];
+    sector.live = true;
+    sector.seq = ring.nextSeq++;
+    sector.valid = kSectorHeaderBytes;
+    ring.order.push_back(slot);
+    return true;
+}
+
+bool RingLogDataStorage::appendFrame(Ring& ring, uint8_t type, const uint8_t* payload,
+                                     std::size_t len, uint32_t epoch,
+                                     uint16_t metricMask)
+{
+    const std::size_t frameBytes = len + kFrameOverheadBytes;
+    if (ring.order.empty() || ring.sectors[ring.order.back()].sealed ||
+        ring.sectors[ring.order.back()].valid + frameBytes > kSectorBytes) {
+        if (!advance(ring)) {
+            return false;
+        }
+    }
+    const std::size_t slot = ring.order.back();
+    Sector& sector = ring.sectors[slot];
+
+    frameScratch_.resize(frameBytes);
+    frameScratch_[0] = type;
+    frameScratch_[1] = static_cast<uint8_t>(len);
+    std::memcpy(frameScratch_.data() + 2, payload, len);
+    put16(frameScratch_.data() + 2 + len, crc16(frameScratch_.data(), len + 2));
+    // Durable once the program completes: there is no cache to flush.
+    if (!program((ring.first + slot) * kSectorBytes + sector.valid,
+                 frameScratch_.data(), frameBytes)) {
+        sector.sealed = true;  // partial bytes may follow the valid prefix
+        return false;
+    }
+    writes_.bytesAppended += frameBytes;
+    sector.valid = static_cast<uint16_t>(sector.valid + frameBytes);
+    sector.minEpoch = std::min(sector.minEpoch, epoch);
+    sector.maxEpoch = std::max(sector.maxEpoch, epoch);
+    sector.metricMask = static_cast<uint16_t>(sector.metricMask | metricMask);
+    return true;
+}
+
+bool RingLogDataStorage::program(std::size_t offset, const void* src,
+                                 std::size_t len)
+{
+    ++writes_.syncs;
+    return flash_.write(offset, src, len);
+}
+
+bool RingLogDataStorage::appendRow(uint32_t epoch, const MetricSample* samples,
+                                   std::size_t count)
+{
+    float values[metric::kKnownCount] = {};
+    uint16_t mask = 0;
+    for (std::size_t i = 0; i < count; ++i) {
+        values[samples[i].metric] = samples[i].value;
+        mask = static_cast<uint16_t>(mask | (1u << samples[i].metric));
+    }
+    uint8_t payload[kHistoryFixedBytes + 4 * metric::kKnownCount];
+    put32(payload, epoch);
+    put16(payload + 4, mask);
+    std::size_t len = kHistoryFixedBytes;
+    for (std::size_t id = 0; id < metric::kKnownCount; ++id) {
+        if ((mask & (1u << id)) != 0) {
+            std::memcpy(payload + len, &values[id], 4);
+            len += 4;
+        }
+    }
+    return appendFrame(history_, kHistoryFrame, payload, len, epoch, mask);
+}
+
+bool RingLogDataStorage::storeSensorReading(const std::string& metric,
+                                            uint32_t epoch, float value)
+{
+    const MetricSample sample{metric::findKnown(metric), epoch, value};
+    return storeSamples(&sample, 1) == 1;
+}
+
+std::size_t RingLogDataStorage::storeSensorReadings(const SensorReading* readings,
+                                                    std::size_t count)
+{
+    sampleScratch_.clear();
+    for (std::size_t i = 0; i < count; ++i) {
+        sampleScratch_.push_back(MetricSample{metric::findKnown(readings[i].metric),
+                                              readings[i].epoch, readings[i].value});
+    }
+    return storeSamples(sampleScratch_.data(), sampleScratch_.size());
+}
+
+std::size_t RingLogDataStorage::storeSamples(const MetricSample* samples,
+                                             std::size_t count)
+{
+    if (!usable_) {
+        return 0;
+    }
+    const AppendTimer timer(appendClock_, writes_.appendUs);
+    // One frame per run of samples sharing an epoch, one value per metric
+    // in it: a repeated metric or a new epoch starts the next frame, so
+    // each metric's readings stay in array order.
+    MetricSample row[metric::kKnownCount];
+    std::size_t stored = 0;
+    std::size_t i = 0;
+    while (i < count) {
+        const uint32_t epoch = samples[i].epoch;
+        std::size_t members = 0;
+        uint16_t mask = 0;
+        for (; i < count && samples[i].epoch == epoch; ++i) {
+            const MetricId id = samples[i].metric;
+            if (id >= metric::kKnownCount) {
+                continue;  // not a stored metric: rejected on its own
+            }
+            if ((mask & (1u << id)) != 0) {
+                break;
+            }
+            mask = static_cast<uint16_t>(mask | (1u << id));
+            row[members++] = samples[i];
+        }
+        if (members > 0 && appendRow(epoch, row, members)) {
+            stored += members;
+        }
+    }
+    return stored;
+}
+
+std::vector<SensorReading> RingLogDataStorage::getSensorReadings(
+    const std::string& metric, uint32_t t0, uint32_t t1) const
+{
+    struct Collector final : IReadingVisitor {
+        const std::string* metric = nullptr;
+        std::vector<SensorReading> readings;
+        bool onReading(uint32_t epoch, float value) override
+        {
+            readings.push_back(SensorReading{*metric, epoch, value});
+            return true;
+        }
+    } collector;
+    collector.metric = &metric;
+    forEachReading(metric, t0, t1, collector);
+    return std::move(collector.readings);
+}
+
+std::size_t RingLogDataStorage::forEachReading(const std::string& metric,
+                                               uint32_t t0, uint32_t t1,
+                                               IReadingVisitor& visitor) const
+{
+    const MetricId id = metric::findKnown(metric);
+    if (!usable_ || id == metric::kInvalid || t0 > t1) {
+        return 0;
+    }
+    const uint16_t bit = static_cast<uint16_t>(1u << id);
+    std::size_t visited = 0;
+    for (const std::size_t slot : history_.order) {
+        const Sector& sector = history_.sectors[slot];
+        if ((sector.metricMask & bit) == 0 || sector.maxEpoch < t0 ||
+            sector.minEpoch > t1) {
+            continue;
+        }
+        const uint8_t* bytes = sectorBytes(history_, slot, sector.valid);
+        if (bytes == nullptr) {
+            continue;  // read error: that sector contributes nothing
+        }
+        for (std::size_t offset = kSectorHeaderBytes; offset < sector.valid;
+             offset += bytes[offset + 1] + kFrameOverheadBytes) {
+            const std::size_t len = bytes[offset + 1];
+            const uint8_t* payload = bytes + offset + 2;
+            if (bytes[offset] != kHistoryFrame || len < kHistoryFixedBytes) {
+                continue;
+            }
+            const uint32_t epoch = get32(payload);
+            const uint16_t mask = get16(payload + 4);
+            if ((mask & bit) == 0 || epoch < t0 || epoch > t1) {
+                continue;
+            }
+            const std::size_t at = kHistoryFixedBytes + 4 * valueIndex(mask, bit);
+            if (at + 4 > len) {
+                continue;
+            }
+            float value = 0.0f;
+            std::memcpy(&value, payload + at, 4);
+            ++visited;
+            if (!visitor.onReading(epoch, value)) {
+                return visited;
+            }
+        }
+    }
+    return visited;
+}
+
+bool RingLogDataStorage::storeEvent(uint32_t epoch, uint8_t category,
+                                    std::string_view detail)
+{
+    if (!usable_) {
+        return false;
+    }
+    const AppendTimer timer(appendClock_, writes_.appendUs);
+    // Contract: an over-long detail is silently truncated.
+    const std::size_t detailLen = std::min(detail.size(), kEventDetailMaxLen);
+    uint8_t payload[kEventFixedBytes + kEventDetailMaxLen];
+    put32(payload, epoch);
+    payload[4] = category;
+    std::memcpy(payload + kEventFixedBytes, detail.data(), detailLen);
+    return appendFrame(events_, kEventFrame, payload, kEventFixedBytes + detailLen,
+                       epoch, 0);
+}
+
+std::vector<EventRecord> RingLogDataStorage::getEvents(std::size_t maxCount) const
+{
+    EventQuery query;
+    query.limit = maxCount;
+    return queryEvents(query).events;
+}
+
+EventPage RingLogDataStorage::queryEvents(const EventQuery& query) const
+{
+    EventPager pager(query);
+    if (!usable_) {
+        return pager.take();
+    }
+    const uint32_t newest = std::min(query.until, query.cursor.epoch);
+    for (auto it = events_.order.rbegin(); it != events_.order.rend(); ++it) {
+        const Sector& sector = events_.sectors[*it];
+        if (sector.minEpoch > newest) {
+            continue;  // every record is newer than the page may return
+        }
+        const uint8_t* bytes = sectorBytes(events_, *it, sector.valid);
+        if (bytes == nullptr) {
+            continue;
+        }
+        // Frames only chain forwards: collect a sector's offsets, then
+        // offer them newest first.
+        offsetScratch_.clear();
+        for (std::size_t offset = kSectorHeaderBytes; offset < sector.valid;
+             offset += bytes[offset + 1] + kFrameOverheadBytes) {
+            if (bytes[offset] == kEventFrame && bytes[offset + 1] >= kEventFixedBytes) {
+                offsetScratch_.push_back(static_cast<uint16_t>(offset));
+            }
+        }
+        for (auto at = offsetScratch_.rbegin(); at != offsetScratch_.rend(); ++at) {
+            const uint8_t* payload = bytes + *at + 2;
+            EventRecord record;
+            record.epoch = get32(payload);
+            record.category = payload[4];
+            record.detail.assign(reinterpret_cast<const char*>(payload) + kEventFixedBytes,
+                                 bytes[*at + 1] - kEventFixedBytes);
+            if (!pager.offer(record)) {
+                return pager.take();
+            }
+        }
+    }
+    return pager.take();
+}
+
+StorageStats RingLogDataStorage::getStorageStats() const
+{
+    StorageStats stats{};
+    stats.totalBytes = static_cast<uint32_t>(flash_.size());
+    for (const Ring* ring : {&events_, &history_}) {
+        for (const std::size_t slot : ring->order) {
+            stats.usedBytes += ring->sectors[slot].valid;
+        }
+    }
+    stats.writes = writes_;
+    return stats;
+}
@@ -0,0 +1,173 @@
+// SPDX-FileCopyrightText: 2026 Cryptotomte
+// SPDX-License-Identifier: AGPL-3.0-or-later
+/**
+ * @file ClockHoldover.h
+ * @brief Wall-clock holdover across resets: a retained epoch anchor, a
+ *        DS3231 fallback and the estimated error until SNTP confirms.
+ *
+ * After a reset the wall clock used to stay unset until SNTP synced, and
+ * the data log (gated on IWallClock::isTimeSet()) stayed silent meanwhile.
+ * ClockHoldover picks a boot estimate instead, and the owner steps the
+ * system clock to it so logging starts at once:
+ *
+ *  - RETAINED: a ClockAnchorBlock sealed into RTC_NOINIT memory pairs the
+ *    wall clock with the RTC timer, which keeps counting through software,
+ *    panic and watchdog resets. Boot epoch = anchor + RTC time elapsed.
+ *    A power cycle clears the RTC timer; the anchor then reads as stale.
+ *  - DS3231: a battery-backed RTC, when fitted, covers the power cycle at
+ *    1 s resolution and ±2 ppm since SNTP last set it.
+ *
+ * The lower estimated error wins. The clock is then in HOLDOVER: the error
+ * grows with the system clock's drift until SNTP steps the clock and
+ * synced() resets it. Estimates past kMaxBootErrorMs are not used.
+ *
+ * THREADS: fromRetained(), restore(), synced() and seal() are one writer's
+ * (boot wiring, then main/clock_holdover's task); status() is for any task
+ * (Seqlock). Pure C++, host-tested.
+ */
+
+#ifndef WATERINGSYSTEM_TIME_CLOCKHOLDOVER_H
+#define WATERINGSYSTEM_TIME_CLOCKHOLDOVER_H
+
+#include <cstddef>
+#include <cstdint>
+#include <initializer_list>
+#include <type_traits>
+
+#include "interfaces/Seqlock.h"
+
+/// Where the wall clock came from.
+enum class ClockSource : uint8_t {
+    None,      ///< unset
+    Retained,  ///< RTC-memory anchor (holdover)
+    Ds3231,    ///< external RTC (holdover)
+    Sntp,      ///< confirmed
+};
+
+/// Name of @p source in the console and logs.
+const char* clockSourceName(ClockSource source);
+
+/// The persisted anchor. Trivial (no initializers), so it can sit in
+/// RTC_NOINIT memory; value-initialize it ({}) elsewhere.
+struct ClockAnchorBlock {
+    static constexpr uint32_t kMagic = 0x41435357u;  ///< "WSCA"
+    static constexpr uint16_t kVersion = 1;
+
+    uint32_t magic;
+    uint16_t version;
+    uint8_t source;      ///< ClockSource the epoch derives from
+    uint8_t reserved;
+    uint32_t sequence;   ///< bumped by every seal()
+    uint32_t errorMs;    ///< estimated error when sealed
+    uint64_t wallUs;     ///< wall clock, µs since the epoch
+    uint64_t rtcUs;      ///< RTC timer at the same instant
+    uint32_t crc;        ///< CRC-32 of everything above
+    uint32_t pad;
+};
+static_assert(std::is_trivial<ClockAnchorBlock>::value,
+              "RTC_NOINIT memory is never constructed");
+
+/// A candidate boot time.
+struct ClockEstimate {
+    uint64_t wallUs = 0;   ///< µs since the epoch
+    uint32_t errorMs = 0;
+    ClockSource source = ClockSource::None;
+};
+
+/// As status() reports it.
+struct ClockStatus {
+    ClockSource source = ClockSource::None;
+    uint32_t errorMs = 0;  ///< estimated error now
+
+    /// Set from a retained anchor or the DS3231, not yet confirmed.
+    bool holdover() const
+    {
+        return source == ClockSource::Retained || source == ClockSource::Ds3231;
+    }
+};
+
+class ClockHoldover {
+public:
+    /// System clock (crystal) drift while free-running, generous.
+    static constexpr uint32_t kSystemDriftPpm = 50;
+    /// RTC timer (calibrated RC oscillator) drift across a reset.
+    static constexpr uint32_t kRtcTimerDriftPpm = 20000;
+    /// DS3231 drift (datasheet, 0..40 °C) and its one-second resolution.
+    static constexpr uint32_t kDs3231DriftPpm = 2;
+    static constexpr uint32_t kDs3231ResolutionMs = 1000;
+    /// Age assumed for a DS3231 whose last set time is unknown.
+    static constexpr uint32_t kDs3231UnknownAgeS = 365u * 86400u;
+    /// Right after an SNTP step.
+    static constexpr uint32_t kSntpErrorMs = 100;
+    /// Worse boot estimates leave the clock unset.
+    static constexpr uint32_t kMaxBootErrorMs = 120000;
+    /// A retained anchor older than this (RTC time) is not trusted.
+    static constexpr uint64_t kMaxRetainedGapUs = 24ull * 3600ull * 1000000ull;
+
+    ClockHoldover() = default;
+    ClockHoldover(const ClockHoldover&) = delete;
+    ClockHoldover& operator=(const ClockHoldover&) = delete;
+
+    /// True when @p block is intact and of this layout.
+    static bool valid(const ClockAnchorBlock& block);
+
+    /**
+     * @brief Boot estimate from the valid candidate with the highest
+     * sequence (null candidates are skipped), advanced by the RTC time
+     * since it was sealed. Later seal()s continue past every valid
+     * candidate's sequence, used or not.
+     * @param rtcNowUs RTC timer now
+     * @return false when none is valid, the RTC timer went back (power
+     *         cycle) or the gap exceeds kMaxRetainedGapUs
+     */
+    bool fromRetained(std::initializer_list<const ClockAnchorBlock*> candidates,
+                      uint64_t rtcNowUs, ClockEstimate& out);
+
+    /**
+     * @brief Boot estimate from a DS3231 reading @p rtcEpoch that SNTP last
+     * set at @p setEpoch (0 = unknown).
+     * @return false when @p rtcEpoch is not plausible
+     */
+    static bool fromDs3231(uint32_t rtcEpoch, uint32_t setEpoch, ClockEstimate& out);
+
+    /**
+     * @brief Adopt the better of @p candidates (lower error; estimates past
+     * kMaxBootErrorMs and sources of None are skipped) as holdover at
+     * @p monoMs.
+     * @return the one adopted, or nullptr (the status stays None)
+     */
+    const ClockEstimate* restore(std::initializer_list<const ClockEstimate*> candidates,
+                                 uint32_t monoMs);
+
+    /// SNTP stepped the clock at @p monoMs: confirmed, error reset.
+    void synced(uint32_t monoMs);
+
+    /**
+     * @brief Write the anchor: @p wallUs and @p rtcUs read at one instant,
+     * with the error estimate at @p monoMs. A no-op (false) while the
+     * clock is unset.
+     */
+    bool seal(uint64_t wallUs, uint64_t rtcUs, uint32_t monoMs, ClockAnchorBlock& out);
+
+    /// Sequence of the newest seal() (or of the newest valid candidate).
+    uint32_t sequence() const { return sequence_; }
+
+    /// Source and error at @p monoMs; any task. False only while racing
+    /// the writer repeatedly (@p out untouched).
+    bool status(uint32_t monoMs, ClockStatus& out) const;
+
+private:
+    struct State {
+        ClockSource source;
+        uint32_t anchorMs;       ///< monotonic time the error was last known
+        uint32_t anchorErrorMs;  ///< error then
+    };
+
+    static uint32_t crcOf(const ClockAnchorBlock& block);
+    void publish(ClockSource source, uint32_t monoMs, uint32_t errorMs);
+
+    uint32_t sequence_ = 0;
+    Seqlock<State> state_{State{ClockSource::None, 0, 0}};
+};
+
+#endif /* WATERINGSYSTEM_TIME_CLOCKHOLDOVER_H */
@@ -0,0 +1,53 @@
+// SPDX-FileCopyrightText: 2026 Cryptotomte
+// SPDX-License-Identifier: AGPL-3.0-or-later
+/**
+ * @file Ds3231Rtc.h
+ * @brief DS3231 battery-backed RTC over II2cBus: epoch read/write (pure).
+ *
+ * The chip keeps UTC here, 24-hour mode, years 2000..2099 (century bit
+ * ignored). read() refuses a time the chip itself flags as lost (OSF:
+ * the oscillator stopped, e.g. on a flat coin cell since it was last
+ * set); write() sets the seconds register first — which restarts the
+ * chip's one-second countdown, so no rollover lands mid-write — then the
+ * other six, and then clears OSF. The epoch <-> civil conversion is done
+ * here, not with mktime(), so it does not depend on the process timezone.
+ *
+ * No retries (II2cBus contract); no IDF includes. Host-tested against
+ * MockI2cBus.
+ */
+
+#ifndef WATERINGSYSTEM_TIME_DS3231RTC_H
+#define WATERINGSYSTEM_TIME_DS3231RTC_H
+
+#include <cstdint>
+
+#include "interfaces/II2cBus.h"
+
+class Ds3231Rtc {
+public:
+    static constexpr uint8_t kAddress = 0x68;
+
+    /// Holds @p bus, which must outlive the driver.
+    explicit Ds3231Rtc(II2cBus& bus) : bus_(bus) {}
+
+    Ds3231Rtc(const Ds3231Rtc&) = delete;
+    Ds3231Rtc& operator=(const Ds3231Rtc&) = delete;
+
+    /// The chip answers at kAddress.
+    bool present() { return bus_.probe(kAddress); }
+
+    /**
+     * @brief Read the time into @p epoch.
+     * @return false on a bus error, an oscillator-stop flag or registers
+     *         that are not a valid date
+     */
+    bool read(uint32_t& epoch);
+
+    /// Set the time to @p epoch (2000..2099) and clear the stop flag.
+    bool write(uint32_t epoch);
+
+private:
+    II2cBus& bus_;
+};
+
+#endif /* WATERINGSYSTEM_TIME_DS3231RTC_H */
@@ -0,0 +1,56 @@
+// SPDX-FileCopyrightText: 2026 Cryptotomte
+// SPDX-License-Identifier: AGPL-3.0-or-later
+/**
+ * @file MonotonicEpoch.h
+ * @brief Wall clock derived from the monotonic clock through one cached
+ *        offset (pure).
+ *
+ * Between steps the system clock and esp_timer count off the same timer,
+ * so wall = monotonic + offset holds exactly; only a step (SNTP, the boot
+ * holdover) changes the offset. anchor() records the offset at such a
+ * step and read() is then a monotonic read plus an add — no gettimeofday()
+ * per timestamp — returning the epoch and its plausibility as one value.
+ *
+ * THREADS: anchor() callers serialize among themselves (boot wiring, then
+ * the SNTP task); read() is for any task and never blocks (Seqlock).
+ */
+
+#ifndef WATERINGSYSTEM_TIME_MONOTONICEPOCH_H
+#define WATERINGSYSTEM_TIME_MONOTONICEPOCH_H
+
+#include <cstdint>
+
+#include "interfaces/IWallClock.h"
+#include "interfaces/Seqlock.h"
+
+class MonotonicEpoch {
+public:
+    MonotonicEpoch() = default;
+    MonotonicEpoch(const MonotonicEpoch&) = delete;
+    MonotonicEpoch& operator=(const MonotonicEpoch&) = delete;
+
+    /// At monotonic @p monoUs the wall clock read @p wallUs (µs since the
+    /// epoch).
+    void anchor(int64_t monoUs, int64_t wallUs)
+    {
+        offset_.store(Offset{wallUs - monoUs, 1, 0});
+    }
+
+    /**
+     * @brief The wall clock at monotonic @p monoUs.
+     * @return false before the first anchor() or while racing one
+     *         repeatedly (@p out untouched)
+     */
+    bool read(int64_t monoUs, WallTime& out) const;
+
+private:
+    struct Offset {
+        int64_t offsetUs;
+        uint32_t anchored;
+        uint32_t pad;
+    };
+
+    Seqlock<Offset> offset_{Offset{0, 0, 0}};
+};
+
+#endif /* WATERINGSYSTEM_TIME_MONOTONICEPOCH_H */
@@ -9,7 +9,8 @@
  * service against CONFIG_WS_SNTP_SERVER in step-set mode and is idempotent and
  * non-fatal (server unreachable is retried by the SNTP service, never a boot
  * failure). A static sync callback updates the client's SyncStatus on each
- * successful sync. Excluded from the linux host build (esp_* dependencies).
+ * successful sync and re-anchors an attached SystemWallClock. Excluded from
+ * the linux host build (esp_* dependencies).
  */
 
 #ifndef WATERINGSYSTEM_TIME_SNTPCLIENT_H
@@ -18,6 +19,7 @@
 #include <sys/time.h>
 
 #include "time/SyncStatus.h"
+#include "time/SystemWallClock.h"
 
 /**
  * @brief Starts SNTP synchronisation and tracks the resulting SyncStatus.
@@ -55,6 +57,13 @@ public:
      */
     bool start();
 
+    /**
+     * @brief Re-anchor @p clock from the sync callback, right after SNTP
+     * steps the system clock. Before start(); @p clock must outlive the
+     * client.
+     */
+    void attach(SystemWallClock& clock) { clock_ = &clock; }
+
     /// Immutable view of the current synchronisation state.
     const SyncStatus& status() const { return status_; }
 
@@ -63,6 +72,7 @@ private:
     static void onSyncCb(struct timeval* tv);
 
     SyncStatus status_;
+    SystemWallClock* clock_ = nullptr;
     bool started_ = false;
 };
 
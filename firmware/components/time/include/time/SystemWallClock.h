@@ -2,13 +2,17 @@
 // SPDX-License-Identifier: AGPL-3.0-or-later
 /**
  * @file SystemWallClock.h
- * @brief IWallClock over the system clock (time(nullptr)) — target only.
+ * @brief IWallClock over the system clock — target only.
  *
- * The production wall-clock source: reads the C library system clock, which
- * SNTP steps once it syncs (SntpClient, step-set mode). Excluded from the
- * linux host build (host consumers use FakeWallClock); the declaration is
- * trivial so it lives target-side with its .cpp. isTimeSet() reuses the pure
- * TimeService plausibility threshold so it matches FakeWallClock exactly.
+ * The production wall-clock source. Reads do not call time() each: the
+ * clock keeps a MonotonicEpoch offset, taken from gettimeofday() once and
+ * again whenever something steps the system clock (resync(): SntpClient's
+ * sync callback, the boot holdover), so nowEpoch() and now() are an
+ * esp_timer read plus an add, and now() carries the epoch and isTimeSet()
+ * as one reading. A read that races resync() repeatedly falls back to
+ * time(nullptr). Excluded from the linux host build (host consumers use
+ * FakeWallClock). isTimeSet() reuses the pure TimeService plausibility
+ * threshold so it matches FakeWallClock exactly.
  */
 
 #ifndef WATERINGSYSTEM_TIME_SYSTEMWALLCLOCK_H
@@ -17,14 +21,26 @@
 #include <cstdint>
 
 #include "interfaces/IWallClock.h"
+#include "time/MonotonicEpoch.h"
 
 /**
  * @brief IWallClock backed by the system clock (SNTP-stepped on target).
  */
 class SystemWallClock : public IWallClock {
 public:
-    uint32_t nowEpoch() const override;
-    bool isTimeSet() const override;
+    /// Anchors the offset to the system clock as it reads now.
+    SystemWallClock();
+
+    uint32_t nowEpoch() const override { return now().epoch; }
+    bool isTimeSet() const override { return now().set; }
+    WallTime now() const override;
+
+    /// Re-anchor after the system clock was stepped. Callers serialize
+    /// among themselves (MonotonicEpoch::anchor()).
+    void resync();
+
+private:
+    MonotonicEpoch cache_;
 };
 
 #endif /* WATERINGSYSTEM_TIME_SYSTEMWALLCLOCK_H */
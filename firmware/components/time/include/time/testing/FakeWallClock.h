@@ -38,6 +38,14 @@ public:
 
     bool isTimeSet() const override { return epoch_ >= threshold_; }
 
+    WallTime now() const override
+    {
+        WallTime t;
+        t.epoch = epoch_;
+        t.set = epoch_ >= threshold_;
+        return t;
+    }
+
     /// Set the current epoch (e.g. simulate an SNTP sync).
     void setEpoch(uint32_t epoch) { epoch_ = epoch; }
 
@@ -0,0 +1,170 @@
+// SPDX-FileCopyrightText: 2026 Cryptotomte
+// SPDX-License-Identifier: AGPL-3.0-or-later
+/**
+ * @file ClockHoldover.cpp
+ * @brief Boot estimates, anchor sealing and error growth (see ClockHoldover.h).
+ *
+ * Errors are kept in whole milliseconds and rounded up, so an estimate
+ * never claims to be better than it is. Drift over an interval is
+ * interval * ppm / 1e6; the products stay in 64 bits.
+ */
+
+#include "time/ClockHoldover.h"
+
+#include "time/TimeService.h"
+
+namespace {
+
+/// @p us of drift at @p ppm, in ms rounded up.
+uint64_t driftMs(uint64_t us, uint32_t ppm)
+{
+    return (us * ppm + 999999999ull) / 1000000000ull;
+}
+
+uint32_t clampMs(uint64_t ms)
+{
+    return ms > UINT32_MAX ? UINT32_MAX : static_cast<uint32_t>(ms);
+}
+
+}  // namespace
+
+const char* clockSourceName(ClockSource source)
+{
+    switch (source) {
+        case ClockSource::None:     return "none";
+        case ClockSource::Retained: return "rtc-memory";
+        case ClockSource::Ds3231:   return "ds3231";
+        case ClockSource::Sntp:     return "sntp";
+    }
+    return "?";
+}
+
+bool ClockHoldover::valid(const ClockAnchorBlock& block)
+{
+    return block.magic == ClockAnchorBlock::kMagic &&
+           block.version == ClockAnchorBlock::kVersion &&
+           block.source != static_cast<uint8_t>(ClockSource::None) &&
+           block.source <= static_cast<uint8_t>(ClockSource::Sntp) &&
+           block.crc == crcOf(block);
+}
+
+bool ClockHoldover::fromRetained(std::initializer_list<const ClockAnchorBlock*> candidates,
+                                 uint64_t rtcNowUs, ClockEstimate& out)
+{
+    const ClockAnchorBlock* best = nullptr;
+    for (const ClockAnchorBlock* block : candidates) {
+        if (block != nullptr && valid(*block) &&
+            (best == nullptr || block->sequence > best->sequence)) {
+            best = block;
+        }
+    }
+    if (best == nullptr) {
+        return false;
+    }
+    if (best->sequence > sequence_) {
+        sequence_ = best->sequence;
+    }
+    // The RTC timer restarts from zero on a power cycle: an anchor "in the
+    // future" is from before one.
+    if (rtcNowUs < best->rtcUs || rtcNowUs - best->rtcUs > kMaxRetainedGapUs) {
+        return false;
+    }
+    const uint64_t gapUs = rtcNowUs - best->rtcUs;
+    out.wallUs = best->wallUs + gapUs;
+    out.errorMs = clampMs(best->errorMs + driftMs(gapUs, kRtcTimerDriftPpm));
+    out.source = ClockSource::Retained;
+    return TimeService::isPlausibleEpoch(static_cast<uint32_t>(out.wallUs / 1000000ull));
+}
+
+bool ClockHoldover::fromDs3231(uint32_t rtcEpoch, uint32_t setEpoch, ClockEstimate& out)
+{
+    if (!TimeService::isPlausibleEpoch(rtcEpoch)) {
+        return false;
+    }
+    const uint64_t ageS = (setEpoch != 0 && setEpoch <= rtcEpoch)
+                              ? rtcEpoch - setEpoch
+                              : kDs3231UnknownAgeS;
+    out.wallUs = static_cast<uint64_t>(rtcEpoch) * 1000000ull;
+    out.errorMs = clampMs(kDs3231ResolutionMs + driftMs(ageS * 1000000ull, kDs3231DriftPpm));
+    out.source = ClockSource::Ds3231;
+    return true;
+}
+
+const ClockEstimate* ClockHoldover::restore(
+    std::initializer_list<const ClockEstimate*> candidates, uint32_t monoMs)
+{
+    const ClockEstimate* best = nullptr;
+    for (const ClockEstimate* estimate : candidates) {
+        if (estimate != nullptr && estimate->source != ClockSource::None &&
+            estimate->errorMs <= kMaxBootErrorMs &&
+            (best == nullptr || estimate->errorMs < best->errorMs)) {
+            best = estimate;
+        }
+    }
+    if (best != nullptr) {
+        // A retained anchor sealed after an SNTP sync is still holdover
+        // now: nothing confirmed this boot's step.
+        publish(best->source, monoMs, best->errorMs);
+    }
+    return best;
+}
+
+void ClockHoldover::synced(uint32_t monoMs)
+{
+    publish(ClockSource::Sntp, monoMs, kSntpErrorMs);
+}
+
+bool ClockHoldover::seal(uint64_t wallUs, uint64_t rtcUs, uint32_t monoMs,
+                         ClockAnchorBlock& out)
+{
+    ClockStatus now;
+    if (!status(monoMs, now) || now.source == ClockSource::None) {
+        return false;
+    }
+    ClockAnchorBlock block{};
+    block.magic = ClockAnchorBlock::kMagic;
+    block.version = ClockAnchorBlock::kVersion;
+    block.source = static_cast<uint8_t>(now.source);
+    block.sequence = ++sequence_;
+    block.errorMs = now.errorMs;
+    block.wallUs = wallUs;
+    block.rtcUs = rtcUs;
+    block.crc = crcOf(block);
+    out = block;
+    return true;
+}
+
+bool ClockHoldover::status(uint32_t monoMs, ClockStatus& out) const
+{
+    State state;
+    if (!state_.tryLoad(state)) {
+        return false;
+    }
+    out.source = state.source;
+    out.errorMs = 0;
+    if (state.source != ClockSource::None) {
+        const uint64_t elapsedUs = static_cast<uint64_t>(monoMs - state.anchorMs) * 1000ull;
+        out.errorMs = clampMs(state.anchorErrorMs + driftMs(elapsedUs, kSystemDriftPpm));
+    }
+    return true;
+}
+
+uint32_t ClockHoldover::crcOf(const ClockAnchorBlock& block)
+{
+    // CRC-32 (IEEE, reflected) of the block up to its crc field.
+    const auto* bytes = reinterpret_cast<const uint8_t*>(&block);
+    const std::size_t len = offsetof(ClockAnchorBlock, crc);
+    uint32_t crc = 0xFFFFFFFFu;
+    for (std::size_t i = 0; i < len; ++i) {
+        crc ^= bytes[i];
+        for (int bit = 0; bit < 8; ++bit) {
+            crc = (crc >> 1) ^ (0xEDB88320u & (0u - (crc & 1u)));
+        }
+    }
+    return ~crc;
+}
+
+void ClockHoldover::publish(ClockSource source, uint32_t monoMs, uint32_t errorMs)
+{
+    state_.store(State{source, monoMs, errorMs});
+}
@@ -0,0 +1,117 @@
+// SPDX-FileCopyrightText: 2026 Cryptotomte
+// SPDX-License-Identifier: AGPL-3.0-or-later
+/**
+ * @file Ds3231Rtc.cpp
+ * @brief DS3231 register access and the civil-date conversion (see Ds3231Rtc.h).
+ *
+ * Registers 0x00..0x06: seconds, minutes, hours, weekday, date, month,
+ * year, all BCD. The status register 0x0F carries OSF in bit 7. The date
+ * conversion is the days-from-civil algorithm over the proleptic
+ * Gregorian calendar.
+ */
+
+#include "time/Ds3231Rtc.h"
+
+namespace {
+
+constexpr uint8_t kRegTime = 0x00;
+constexpr uint8_t kRegStatus = 0x0F;
+constexpr uint8_t kStatusOsf = 0x80;
+constexpr uint32_t kEpoch2000 = 946684800u;
+constexpr uint32_t kEpoch2100 = 4102444800u;
+
+uint8_t fromBcd(uint8_t v)
+{
+    return static_cast<uint8_t>((v >> 4) * 10 + (v & 0x0F));
+}
+
+uint8_t toBcd(uint32_t v)
+{
+    return static_cast<uint8_t>(((v / 10) << 4) | (v % 10));
+}
+
+/// Days since 1970-01-01 of @p y-@p m-@p d.
+int64_t daysFromCivil(int64_t y, uint32_t m, uint32_t d)
+{
+    y -= m <= 2 ? 1 : 0;
+    const int64_t era = (y >= 0 ? y : y - 399) / 400;
+    const int64_t yoe = y - era * 400;
+    const int64_t doy = (153 * (m > 2 ? m - 3 : m + 9) + 2) / 5 + d - 1;
+    const int64_t doe = yoe * 365 + yoe / 4 - yoe / 100 + doy;
+    return era * 146097 + doe - 719468;
+}
+
+void civilFromDays(int64_t z, int64_t& y, uint32_t& m, uint32_t& d)
+{
+    z += 719468;
+    const int64_t era = (z >= 0 ? z : z - 146096) / 146097;
+    const int64_t doe = z - era * 146097;
+    const int64_t yoe = (doe - doe / 1460 + doe / 36524 - doe / 146096) / 365;
+    const int64_t doy = doe - (365 * yoe + yoe / 4 - yoe / 100);
+    const int64_t mp = (5 * doy + 2) / 153;
+    d = static_cast<uint32_t>(doy - (153 * mp + 2) / 5 + 1);
+    m = static_cast<uint32_t>(mp < 10 ? mp + 3 : mp - 9);
+    y = yoe + era * 400 + (m <= 2 ? 1 : 0);
+}
+
+}  // namespace
+
+bool Ds3231Rtc::read(uint32_t& epoch)
+{
+    uint8_t status = 0;
+    if (!bus_.readRegisters(kAddress, kRegStatus, &status, 1) || (status & kStatusOsf) != 0) {
+        return false;
+    }
+    uint8_t r[7] = {};
+    if (!bus_.readRegisters(kAddress, kRegTime, r, sizeof r)) {
+        return false;
+    }
+    if ((r[2] & 0x40) != 0) {
+        return false;  // 12-hour mode: never written by this driver
+    }
+    const uint32_t sec = fromBcd(r[0] & 0x7F);
+    const uint32_t min = fromBcd(r[1] & 0x7F);
+    const uint32_t hour = fromBcd(r[2] & 0x3F);
+    const uint32_t day = fromBcd(r[4] & 0x3F);
+    const uint32_t month = fromBcd(r[5] & 0x1F);
+    const uint32_t year = 2000u + fromBcd(r[6]);
+    if (sec > 59 || min > 59 || hour > 23 || day < 1 || day > 31 || month < 1 ||
+        month > 12 || year > 2099) {
+        return false;
+    }
+    const int64_t days = daysFromCivil(year, month, day);
+    epoch = static_cast<uint32_t>(days * 86400 + hour * 3600 + min * 60 + sec);
+    return true;
+}
+
+bool Ds3231Rtc::write(uint32_t epoch)
+{
+    if (epoch < kEpoch2000 || epoch >= kEpoch2100) {
+        return false;
+    }
+    const int64_t days = epoch / 86400;
+    const uint32_t secs = epoch % 86400;
+    int64_t year = 0;
+    uint32_t month = 0;
+    uint32_t day = 0;
+    civilFromDays(days, year, month, day);
+    const uint8_t regs[7] = {
+        toBcd(secs % 60),
+        toBcd(secs / 60 % 60),
+        toBcd(secs / 3600),                                     // 24-hour mode
+        static_cast<uint8_t>((days + 4) % 7 + 1),               // 1 = Sunday
+        toBcd(day),
+        toBcd(month),                                           // century bit 0
+        toBcd(static_cast<uint32_t>(year - 2000)),
+    };
+    for (uint8_t i = 0; i < sizeof regs; ++i) {
+        if (!bus_.writeRegister(kAddress, static_cast<uint8_t>(kRegTime + i), regs[i])) {
+            return false;
+        }
+    }
+    uint8_t status = 0;
+    if (!bus_.readRegisters(kAddress, kRegStatus, &status, 1)) {
+        return false;
+    }
+    return bus_.writeRegister(kAddress, kRegStatus, static_cast<uint8_t>(status & ~kStatusOsf));
+}
@@ -0,0 +1,23 @@
+// SPDX-FileCopyrightText: 2026 Cryptotomte
+// SPDX-License-Identifier: AGPL-3.0-or-later
+/**
+ * @file MonotonicEpoch.cpp
+ * @brief The cached-offset read (see MonotonicEpoch.h).
+ */
+
+#include "time/MonotonicEpoch.h"
+
+#include "time/TimeService.h"
+
+bool MonotonicEpoch::read(int64_t monoUs, WallTime& out) const
+{
+    Offset offset;
+    if (!offset_.tryLoad(offset) || offset.anchored == 0) {
+        return false;
+    }
+    const int64_t wallUs = monoUs + offset.offsetUs;
+    // Before 1970 (a step back past the epoch) reads as 0, never wrapped.
+    out.epoch = wallUs > 0 ? static_cast<uint32_t>(wallUs / 1000000) : 0;
+    out.set = TimeService::isPlausibleEpoch(out.epoch);
+    return true;
+}
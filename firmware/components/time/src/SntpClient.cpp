@@ -102,6 +102,10 @@ void SntpClient::onSyncCb(struct timeval* tv)
     // update. This runs on the SNTP task; the console `time` command reads
     // status_ from the REPL task without a lock — a deliberate benign divergence
     // (aligned word-size reads, diagnostic-only), so no Locked* wrapper is used.
+    // The step is already applied (the callback follows settimeofday()).
+    if (s_instance->clock_ != nullptr) {
+        s_instance->clock_->resync();
+    }
     s_instance->status_.lastSyncEpoch = static_cast<uint32_t>(tv->tv_sec);
     ESP_LOGI(TAG, "wall clock synced: epoch=%u",
              static_cast<unsigned>(tv->tv_sec));
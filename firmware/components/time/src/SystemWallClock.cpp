@@ -2,21 +2,42 @@
 // SPDX-License-Identifier: AGPL-3.0-or-later
 /**
  * @file SystemWallClock.cpp
- * @brief IWallClock over time(nullptr) — target-only (excluded on linux).
+ * @brief IWallClock over the system clock — target-only (excluded on linux).
+ *
+ * gettimeofday() and esp_timer run off the same high-resolution timer, so
+ * the offset between them moves only when settimeofday() steps the clock;
+ * SNTP runs in step mode (SntpClient), never slews.
  */
 
 #include "time/SystemWallClock.h"
 
+#include <sys/time.h>
+
 #include <ctime>
 
+#include "esp_timer.h"
+
 #include "time/TimeService.h"
 
-uint32_t SystemWallClock::nowEpoch() const
+SystemWallClock::SystemWallClock()
+{
+    resync();
+}
+
+WallTime SystemWallClock::now() const
 {
-    return static_cast<uint32_t>(time(nullptr));
+    WallTime t;
+    if (!cache_.read(esp_timer_get_time(), t)) {
+        t.epoch = static_cast<uint32_t>(time(nullptr));
+        t.set = TimeService::isPlausibleEpoch(t.epoch);
+    }
+    return t;
 }
 
-bool SystemWallClock::isTimeSet() const
+void SystemWallClock::resync()
 {
-    return TimeService::isPlausibleEpoch(nowEpoch());
+    struct timeval tv = {};
+    const int64_t monoUs = esp_timer_get_time();
+    gettimeofday(&tv, nullptr);
+    cache_.anchor(monoUs, static_cast<int64_t>(tv.tv_sec) * 1000000 + tv.tv_usec);
 }
@@ -0,0 +1,63 @@
+// SPDX-FileCopyrightText: 2026 Cryptotomte
+// SPDX-License-Identifier: AGPL-3.0-or-later
+/**
+ * @file acquisition_plan.h
+ * @brief Cadence and phase of every periodic sensor read, in one table
+ *        (app wiring).
+ *
+ * Each sensor is read by ONE task and every consumer takes that task's
+ * published sample, never a read of its own:
+ *  - RS485 soil probes: soil_task, at the sensor-read interval
+ *    (IConfigStore, 5 s by default), phase 0 — each period opens with the
+ *    primary read, the other probes in SoilPollScheduler's slots. The
+ *    watering task takes SoilAcquirer::latest().
+ *  - I2C BME280: sensor_task, every kEnv.baseMs (kEnv.burstMs while the
+ *    plant pump runs, up to kEnv.maxMs backed off), first read kEnv.phaseMs
+ *    after start — half a default soil period, so at the default interval
+ *    the two acquisitions, and the watering tick each soil sample wakes,
+ *    alternate instead of waking together on the control core. The
+ *    watering controller's data log takes the newest snapshot() when it
+ *    is at most kEnv.maxAgeMs old (WateringController::setEnvAcquired());
+ *    the console and the API read the same snapshot.
+ *  - I2C INA226: power_task, on each conversion (its own averaging sets
+ *    the rate); no phase — the bus master (i2c_task) serializes it with
+ *    the BME280 read.
+ *
+ * Bus load is therefore the sum of the rows: at the defaults, one soil
+ * read per probe and one BME280 read per 5 s, plus the INA226 conversions.
+ */
+
+#ifndef WATERINGSYSTEM_MAIN_ACQUISITION_PLAN_H
+#define WATERINGSYSTEM_MAIN_ACQUISITION_PLAN_H
+
+#include <cstdint>
+
+#include "sdkconfig.h"
+
+/// When one periodic read happens.
+struct AcquisitionPlan {
+    const char* name;
+    uint32_t baseMs;    ///< steady cadence
+    uint32_t burstMs;   ///< cadence while the plant pump runs
+    uint32_t maxMs;     ///< longest backed-off cadence
+    uint32_t phaseMs;   ///< first read after the task starts
+    uint32_t maxAgeMs;  ///< oldest sample a consumer still takes
+};
+
+namespace acquisition_plan {
+
+constexpr uint32_t kEnvBaseMs = 5000;  ///< parity poll cadence (R7)
+#if defined(CONFIG_WS_ADAPTIVE_POLLING)
+constexpr uint32_t kEnvMaxMs = CONFIG_WS_ADAPTIVE_POLL_MAX_S * 1000u;
+#else
+constexpr uint32_t kEnvMaxMs = kEnvBaseMs;  ///< fixed cadence
+#endif
+
+/// The BME280 (sensor_task). A sample up to two backed-off periods old is
+/// still taken: a slow poll of a steady room is not a stale one.
+constexpr AcquisitionPlan kEnv{"bme280", kEnvBaseMs, 1000, kEnvMaxMs, kEnvBaseMs / 2,
+                               2 * kEnvMaxMs};
+
+}  // namespace acquisition_plan
+
+#endif /* WATERINGSYSTEM_MAIN_ACQUISITION_PLAN_H */
@@ -15,12 +15,31 @@
  * ahead of (and thus bypass) this fail-safe. Keep all initialization
  * explicit, inside or after pumps_force_off().
  *
+ * Boot order. app_main itself does only the safety core — pumps off and
+ * armed, the level marks, the task watchdog — then hands everything else to
+ * a one-shot boot task (boot_services()) and enters the 10 Hz loop. The boot
+ * task brings up storage, the event log, Wi-Fi, RS485 and the controllers in
+ * dependency order while helper tasks mount the littlefs volume and probe
+ * the I2C devices beside it (writes queue until the volume is up);
+ * SNTP and the API server only start on the first Wi-Fi connect. The loop
+ * picks up the SystemObserver once the boot task publishes it.
+ *
  * Hardware dependency: the pump MOSFET gate pull-down resistors must hold
  * both pumps off while the GPIOs are hi-Z, i.e. during boot ROM /
  * bootloader execution and after an abort() below. The software fail-safe
  * narrows the hi-Z window; the pull-downs cover it.
  */
 
+#include <array>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <optional>
+#include <string>
+#include <utility>
+#include <vector>
+
 #include "board/board.h"
 #include "esp_app_desc.h"
 #include "esp_event.h"
@@ -28,25 +47,47 @@
 #include "esp_log.h"
 #include "esp_netif.h"
 #include "esp_system.h"
+#include "esp_timer.h"
 #include "driver/gpio.h"
 #include "freertos/FreeRTOS.h"
+#include "freertos/semphr.h"
 #include "freertos/task.h"
 #include "nvs_flash.h"
 
+#include "actuators/EspDeadlineTimer.h"
 #include "actuators/EspTimeProvider.h"
 #include "actuators/GpioWaterPump.h"
 #include "actuators/LockedWaterPump.h"
 #include "events/EventLogger.h"
+#include "interfaces/BufferBudget.h"
+#include "interfaces/LockStats.h"
+#include "interfaces/TraceBuffer.h"
 #include "sensors/Bme280Sensor.h"
 #include "sensors/DebouncedLevelSensor.h"
 #include "sensors/EspI2cBus.h"
+#include "sensors/I2cBusMaster.h"
+#if CONFIG_WS_MODBUS_CLIENT_UART
+#include "sensors/UartModbusClient.h"
+#else
 #include "sensors/EspModbusClient.h"
+#endif
+#include "sensors/GpioInputBank.h"
 #include "sensors/GpioLevelSensor.h"
+#include "sensors/LevelSensorBank.h"
 #include "sensors/LockedEnvironmentalSensor.h"
-#include "sensors/LockedLevelSensor.h"
-#include "sensors/LockedModbusClient.h"
 #include "sensors/LockedSoilSensor.h"
+#include "sensors/ModbusBaudNegotiator.h"
+#include "sensors/ModbusBusMaster.h"
+#include "sensors/ModbusFrameCapture.h"
 #include "sensors/ModbusSoilSensor.h"
+#include "sensors/FlatlineDetector.h"
+#include "sensors/FlowMeter.h"
+#include "sensors/MoistureBurstCapture.h"
+#include "sensors/SoilAcquirer.h"
+#include "sensors/SoilPollScheduler.h"
+#include "sensors/SoilSnapshotFilter.h"
+#include "sensors/PcntPulseCounter.h"
+#include "sensors/SyntheticSensors.h"
 #if BOARD_HAS_INA226
 // INA226 headers only on equipped boards: Ina226Sensor.cpp is not in the
 // rev1 target build at all (sensors/CMakeLists.txt) — FR-011.
@@ -54,28 +95,72 @@
 #include "sensors/LockedPowerSensor.h"
 #endif
 #include "api/ApiServer.h"
+#include "api/AssetStore.h"
+#include "control/DecisionTrace.h"
+#include "control/MoistureResponse.h"
+#include "control/PumpBudget.h"
+#include "control/PumpUsage.h"
 #include "control/WateringController.h"
+#include "control/WateringSchedule.h"
+#include "control/WateringZones.h"
 #if BOARD_HAS_RESERVOIR_PUMP
+#include "control/FillTimeEstimator.h"
 #include "control/ReservoirController.h"
 #endif
 #include "network/EspWifiDriver.h"
 #include "network/ProvisioningPortal.h"
 #include "network/WifiBootMode.h"
 #include "network/WifiManager.h"
+#include "network/WifiScanCache.h"
 #include "network/WifiState.h"
+#include "storage/HistoryRollup.h"
 #include "storage/LittleFsDataStorage.h"
 #include "storage/LockedConfigStore.h"
 #include "storage/LockedDataStorage.h"
 #include "storage/NvsConfigStore.h"
+#include "storage/QueuedDataStorage.h"
+#include "storage/RetentionPlan.h"
+#include "storage/RingLogDataStorage.h"
 #include "storage/StorageMount.h"
+#if defined(CONFIG_WS_DATA_STORAGE_RINGLOG)
+#include "storage/EspFlashPartition.h"
+#endif
 #include "time/SntpClient.h"
 #include "time/SystemWallClock.h"
 
+#include "acquisition_plan.h"
+#include "boot_profile.h"
+#include "buffer_heap.h"
+#include "clock_holdover.h"
 #include "diag_console.h"
+#include "espnow_task.h"
+#include "event_wait_task.h"
+#include "i2c_task.h"
+#include "lifetime_counters.h"
+#include "log_sink.h"
+#include "power_mode.h"
+#include "maintenance_task.h"
+#include "modbus_task.h"
+#include "mqtt_task.h"
+#include "ota_task.h"
+#include "overcurrent_trip.h"
+#include "power_capture_task.h"
+#include "power_task.h"
+#include "read_ahead_task.h"
+#include "recorder_task.h"
 #include "sensor_task.h"
+#include "sleep_node.h"
+#include "soil_task.h"
+#include "storage_archive_hold.h"
+#include "storage_mount_task.h"
+#include "storage_writer_task.h"
 #include "watering_task.h"
+#include "selftest_task.h"
+#include "stream_task.h"
 #include "system_observer.h"
+#include "task_plan.h"
 #include "task_watchdog.h"
+#include "telemetry_task.h"
 #include "wifi_task.h"
 
 static const char *TAG = "app_main";
@@ -89,6 +174,10 @@ static const char *TAG = "app_main";
 static constexpr uint32_t kConfigButtonHoldMs = 5000;   // hold to force prov.
 static constexpr uint32_t kConfigButtonBlinkMs = 100;   // LED toggle interval
 
+// Longest a reader of raw volume files (setup pages, HTTPS key pair) waits
+// for the deferred storage mount before going on without them.
+static constexpr uint32_t kStorageWaitMs = 30 * 1000;
+
 /**
  * @brief Drive every pump GPIO that exists on this board to a safe OFF
  * state (output, level 0).
@@ -97,7 +186,8 @@ static constexpr uint32_t kConfigButtonBlinkMs = 100;   // LED toggle interval
  * the plant and the reservoir pump are forced off; on single-pump boards
  * (BOARD_HAS_RESERVOIR_PUMP == 0, rev2) exactly the plant pump is — the
  * reservoir pin does not exist there and any unguarded reference is a
- * compile error (board.h enforcement pattern).
+ * compile error (board.h enforcement pattern). The gates of the further
+ * watering zones (board.h kBoardZones) are forced off alike.
  *
  * Pumps are switched by N-channel MOSFET gates and are active high,
  * so level 0 means pump off.
@@ -112,6 +202,9 @@ static void pumps_force_off(void)
 #if BOARD_HAS_RESERVOIR_PUMP
     pump_mask |= 1ULL << BOARD_PIN_RESERVOIR_PUMP;
 #endif
+    for (std::size_t i = 1; i < kBoardZoneCount; ++i) {
+        pump_mask |= 1ULL << kBoardZones[i].pumpPin;
+    }
     const gpio_config_t pump_cfg = {
         .pin_bit_mask = pump_mask,
         .mode = GPIO_MODE_OUTPUT,
@@ -134,12 +227,39 @@ static void pumps_force_off(void)
         abort();
     }
 #endif
+    for (std::size_t i = 1; i < kBoardZoneCount; ++i) {
+        err = gpio_set_level(static_cast<gpio_num_t>(kBoardZones[i].pumpPin), 0);
+        if (err != ESP_OK) {
+            ESP_LOGE(TAG, "FATAL: pump fail-safe init failed: %s", esp_err_to_name(err));
+            abort();
+        }
+    }
     err = gpio_config(&pump_cfg);
     if (err != ESP_OK) {
         ESP_LOGE(TAG, "FATAL: pump fail-safe init failed: %s", esp_err_to_name(err));
         abort();
     }
+#if defined(CONFIG_WS_DEEP_SLEEP_NODE)
+    // The battery node holds the gates low through deep sleep
+    // (sleep_node.cpp); release them, now driven low, to the drivers.
+    gpio_deep_sleep_hold_dis();
+    for (uint32_t pin = 0; pin < 64; ++pin) {
+        if ((pump_mask >> pin) & 1ULL) {
+            gpio_hold_dis(static_cast<gpio_num_t>(pin));
+        }
+    }
+#endif
+}
+
+#if defined(CONFIG_WS_PUMP_DEADLINE_TIMER)
+/// EspDeadlineTimer callback (esp_timer task): @p arg is the pump's
+/// LockedWaterPump; update() stops the run that is due. A fire that lost
+/// the race to a stop finds nothing due.
+static void pump_deadline_fired(void* arg)
+{
+    static_cast<LockedWaterPump*>(arg)->update();
 }
+#endif
 
 /**
  * @brief Read the config button at boot and confirm a >= 5 s hold (feature
@@ -163,7 +283,7 @@ static void pumps_force_off(void)
  * start. Not safety-critical: a GPIO-config failure is logged and reported as
  * "released" so a stuck read can never wedge boot into provisioning.
  */
-static bool config_button_held_at_boot(void)
+static bool config_button_sampled(void)
 {
     const gpio_config_t btn_cfg = {
         .pin_bit_mask = 1ULL << BOARD_PIN_BTN_CONFIG,
@@ -223,55 +343,285 @@ static bool config_button_held_at_boot(void)
     return true;
 }
 
-extern "C" void app_main(void)
+/// config_button_sampled(), once per boot.
+static bool config_button_held_at_boot(void)
 {
-    // Fail-safe first: every pump that exists on this board off before
-    // anything else happens.
-    pumps_force_off();
+    // Asked twice on a battery node (sleep_node.h): one hold serves both.
+    static int s_held = -1;
+    if (s_held < 0) {
+        s_held = config_button_sampled() ? 1 : 0;
+    }
+    return s_held != 0;
+}
 
-    const esp_app_desc_t *app_desc = esp_app_get_description();
+/// What the safety phase of app_main hands to boot_task: the pumps and the
+/// level marks the 10 Hz loop already runs, for the services built on them.
+struct SafetyCore {
+    EspTimeProvider& clock;
+    GpioWaterPump& plantPump;  ///< raw driver: the over-current ISR only
+    LockedWaterPump& plant;
+#if BOARD_HAS_RESERVOIR_PUMP
+    LockedWaterPump& reservoir;
+#endif
+    std::array<std::optional<LockedWaterPump>, kBoardZoneCount - 1>& zonePumps;
+    LevelSensorBank::Mark& levelLow;
+    LevelSensorBank::Mark& levelHigh;
+};
 
-    ESP_LOGI(TAG, "==========================================");
-    ESP_LOGI(TAG, "WateringSystem");
-    ESP_LOGI(TAG, "Project:     %s", app_desc->project_name);
-    ESP_LOGI(TAG, "Version:     %s", app_desc->version);
-    ESP_LOGI(TAG, "Board:       %s", BOARD_NAME);
-    ESP_LOGI(TAG, "ESP-IDF:     %s", esp_get_idf_version());
-    ESP_LOGI(TAG, "==========================================");
-    ESP_LOGI(TAG, "Pumps forced OFF (fail-safe boot state)");
+/// What boot_task hands back once every service is up: published by the
+/// release store to s_boot_done, picked up by the 10 Hz loop.
+struct BootResult {
+    IPumpObserver* pumpObserver = nullptr;        ///< set on every pump driver
+    ILevelObserver* levelHighObserver = nullptr;  ///< set on the bank's high mark
+};
+static BootResult s_boot_result;
+static std::atomic<bool> s_boot_done{false};
 
-    // Pump driver instances — one per pump that exists on this board
-    // (BOARD_HAS_RESERVOIR_PUMP, feature 006). Function-local statics (NOT
-    // globals): they are constructed here, strictly after
-    // pumps_force_off(), so no constructor can run ahead of the boot
-    // fail-safe.
-    //
-    // Mutex-serializing wrappers: the pumps are touched by two tasks (this
-    // main loop's update() and the esp_console REPL task's commands), so
-    // EVERY access from here on goes through the wrappers — never through
-    // the GpioWaterPump objects directly.
-    static EspTimeProvider time_provider;
-    static GpioWaterPump plant_pump(
-        static_cast<gpio_num_t>(BOARD_PIN_MAIN_PUMP), "plant",
-        time_provider);
-    static LockedWaterPump plant(plant_pump);
-#if BOARD_HAS_RESERVOIR_PUMP
-    static GpioWaterPump reservoir_pump(
-        static_cast<gpio_num_t>(BOARD_PIN_RESERVOIR_PUMP), "reservoir",
-        time_provider);
-    static LockedWaterPump reservoir(reservoir_pump);
+/// The I2C bring-up run by i2c_probe_task while boot_task goes on.
+struct I2cProbe {
+    I2cBusMaster* master = nullptr;
+    LockedEnvironmentalSensor* env = nullptr;
+#if BOARD_HAS_INA226
+    LockedPowerSensor* power = nullptr;
 #endif
+    SemaphoreHandle_t done = nullptr;  ///< given when the probe is over
+};
 
-    // initialize() re-asserts OFF (glitch-free) before arming the drivers.
-    // Failure here is fatal: a pump whose output state is unknown must not
-    // be left powered (same policy as pumps_force_off above).
-    bool pumps_armed = plant.initialize();
+/**
+ * @brief Fast-mode check and the BME280 / INA226 inits on the bus port,
+ * inline (the bus task is not running yet). Failures are logged; the lazy
+ * re-init of each driver recovers later.
+ */
+static void i2c_probe(const I2cProbe& probe)
+{
+#if defined(CONFIG_WS_I2C_FAST_MODE)
+    {
+        // Identity registers: BME280 chip ID at either address, INA226
+        // manufacturer ID. Absent devices do not count (negotiateFastMode).
+        const I2cIdentityCheck checks[] = {
+            {Bme280Sensor::kPrimaryAddress, 0xD0, 1, Bme280Sensor::kChipId},
+            {Bme280Sensor::kSecondaryAddress, 0xD0, 1, Bme280Sensor::kChipId},
+#if BOARD_HAS_INA226
+            {BOARD_INA226_ADDR, 0xFE, 2, Ina226Sensor::kManufacturerId},
+#endif
+        };
+        const uint32_t hz = probe.master->negotiateFastMode(
+            checks, sizeof(checks) / sizeof(checks[0]));
+        ESP_LOGI(TAG, "I2C bus at %lu Hz%s", static_cast<unsigned long>(hz),
+                 hz == I2cBusMaster::kFastModeHz ? "" : " (fast mode not confirmed)");
+    }
+#endif
+    if (probe.env->initialize()) {
+        ESP_LOGI(TAG, "BME280 environmental sensor up");
+    } else {
+        ESP_LOGW(TAG, "BME280 init failed (error %d) — environmental "
+                 "readings unavailable until recovery",
+                 probe.env->getLastError());
+    }
+    boot_mark(BootPhase::Bme280);
+#if BOARD_HAS_INA226
+    if (probe.power->initialize()) {
+        ESP_LOGI(TAG, "INA226 power monitor up at 0x%02x (shunt %d mOhm)",
+                 BOARD_INA226_ADDR, CONFIG_WS_INA226_SHUNT_MILLIOHM);
+    } else {
+        ESP_LOGW(TAG, "INA226 init failed (error %d) — power readings "
+                 "unavailable until recovery",
+                 probe.power->getLastError());
+    }
+    boot_mark(BootPhase::Ina226);
+#endif
+}
+
+/// One-shot helper task: @p arg is the I2cProbe.
+static void i2c_probe_task(void* arg)
+{
+    const I2cProbe& probe = *static_cast<I2cProbe*>(arg);
+    i2c_probe(probe);
+    xSemaphoreGive(probe.done);
+    vTaskDelete(nullptr);
+}
+
+#if defined(CONFIG_WS_HTTPS)
+/// The whole of @p path on the mounted volume into @p out; false when it
+/// is missing or empty.
+static bool read_volume_file(const char* path, std::string& out)
+{
+    std::FILE* f = std::fopen(path, "rb");
+    if (f == nullptr) {
+        return false;
+    }
+    char buf[256];
+    std::size_t n = 0;
+    out.clear();
+    while ((n = std::fread(buf, 1, sizeof buf, f)) > 0) {
+        out.append(buf, n);
+    }
+    std::fclose(f);
+    return !out.empty();
+}
+#endif
+
+#if defined(CONFIG_WS_HISTORY_RETENTION) && !defined(CONFIG_WS_DATA_STORAGE_RINGLOG)
+/**
+ * @brief Per-metric history rings from the mounted partition: its size
+ * less CONFIG_WS_HISTORY_RETENTION_RESERVE_KB (web assets, the event log,
+ * littlefs metadata), the rollup tiers when @p rollups and their sketch
+ * rings when @p sketches, split by
+ * CONFIG_WS_HISTORY_RETENTION_RULES. No plan (the fixed rings) when the
+ * partition size is unknown or the rules do not parse.
+ */
+static retention::Plan plan_history_retention(bool rollups, bool sketches,
+                                               std::size_t bytes_per_reading)
+{
+    uint32_t total_bytes = 0;
+    uint32_t used_bytes = 0;
+    const LittleFsDataStorage::StatsProvider stats = StorageMount::statsProvider();
+    if (!stats || !stats(total_bytes, used_bytes)) {
+        ESP_LOGW(TAG, "retention: partition size unknown, fixed history rings");
+        return {};
+    }
+    std::vector<retention::Rule> rules;
+    if (!retention::parseRules(CONFIG_WS_HISTORY_RETENTION_RULES, rules)) {
+        ESP_LOGE(TAG, "retention: bad rules "%s", fixed history rings",
+                 CONFIG_WS_HISTORY_RETENTION_RULES);
+        return {};
+    }
+    retention::Budget budget;
+    budget.bytesPerReading = bytes_per_reading;
+    budget.intervalS = CONFIG_WS_HISTORY_RETENTION_INTERVAL_S;
+    budget.metrics = CONFIG_WS_HISTORY_RETENTION_METRICS;
+    std::size_t reserve = static_cast<std::size_t>(CONFIG_WS_HISTORY_RETENTION_RESERVE_KB) * 1024;
+    for (const rollup::Tier& tier : rollup::kTiers) {
+        reserve += rollups ? tier.chunkBytes * tier.maxChunks * budget.metrics : 0;
+    }
+    for (const rollup::SketchTier& tier : rollup::kSketchTiers) {
+        reserve += sketches ? tier.chunkBytes * tier.maxChunks * budget.metrics : 0;
+    }
+    budget.bytes = total_bytes > reserve ? total_bytes - reserve : 0;
+    const retention::Plan plan = retention::plan(budget, rules);
+    for (const retention::Rule& rule : rules) {
+        const std::size_t chunks = plan.chunksFor(rule.metric);
+        ESP_LOGI(TAG, "retention: %s %u chunks (~%u days)", rule.metric.c_str(),
+                 static_cast<unsigned>(chunks),
+                 static_cast<unsigned>(retention::Plan::coveredDays(chunks, budget)));
+    }
+    ESP_LOGI(TAG, "retention: others %u chunks (~%u days), %u of %u KiB",
+             static_cast<unsigned>(plan.otherChunks()),
+             static_cast<unsigned>(retention::Plan::coveredDays(plan.otherChunks(), budget)),
+             static_cast<unsigned>(plan.totalChunks() * budget.chunkBytes / 1024),
+             static_cast<unsigned>(budget.bytes / 1024));
+    if (!plan.fits()) {
+        ESP_LOGW(TAG, "retention: rules exceed the history budget, targets cut");
+    }
+    return plan;
+}
+#endif
+
+/**
+ * @brief Everything that is not the pump/level safety loop: storage, the
+ * event log, Wi-Fi, the RS485 and I2C sensors, the controllers, the console,
+ * the tasks and the API server, in dependency order.
+ *
+ * Runs on boot_task while app_main already runs the 10 Hz loop over the
+ * pumps and level marks in @p core. Everything here reaches them through
+ * their Locked* wrappers, as before. The services that need the network —
+ * SNTP and the API server — are only built here; the SystemObserver starts
+ * them on the first Connected transition.
+ */
+static void boot_services(const SafetyCore& core)
+{
+    EspTimeProvider& time_provider = core.clock;
+    [[maybe_unused]] GpioWaterPump& plant_pump = core.plantPump;
+    LockedWaterPump& plant = core.plant;
 #if BOARD_HAS_RESERVOIR_PUMP
-    pumps_armed = pumps_armed && reservoir.initialize();
+    LockedWaterPump& reservoir = core.reservoir;
 #endif
-    if (!pumps_armed) {
-        ESP_LOGE(TAG, "FATAL: pump driver initialization failed");
-        abort();
+    std::array<std::optional<LockedWaterPump>, kBoardZoneCount - 1>& zone_pump =
+        core.zonePumps;
+    LevelSensorBank::Mark& level_low = core.levelLow;
+    LevelSensorBank::Mark& level_high = core.levelHigh;
+
+    // BME280 environmental sensor on the shared I2C bus (feature 005).
+    // Not safety-critical: a failed init is logged and the system keeps
+    // running — the sensor layer reports invalid data and the lazy re-init
+    // recovers on later polls (US2 semantics). Function-local statics after
+    // pumps_force_off() (boot fail-safe rule). The ONE EspI2cBus instance
+    // is the shared bus owner — PR-05's INA226 driver receives this same
+    // instance (FR-003); no second bus creation on these pins is permitted.
+    // The sensor is wrapped in the mutex-serializing decorator: accessed
+    // from the 5 s sensor task and the console REPL task, so EVERY sensor
+    // access goes through the wrapper. The bus itself belongs to
+    // I2cBusMaster: both I2C drivers run on its port, their transactions
+    // queued for the bus task started once the probe below is done.
+    static EspI2cBus i2c_bus_raw;
+    static I2cBusMaster i2c_bus_master(i2c_bus_raw, &esp_timer_get_time);
+    i2c_bus_master.setPowerLock(power_lock(PowerLockKind::ApbMax));
+    [[maybe_unused]] II2cBus& i2c_bus = i2c_bus_master.port();
+#if defined(CONFIG_WS_SOAK_MODE)
+    // Soak mode: signal generators in place of the drivers, wrapped and
+    // wired exactly like them. Each sensor gets its own noise seed.
+    constexpr SyntheticSettings kSoak{
+        static_cast<uint32_t>(CONFIG_WS_SOAK_SPEEDUP),
+        static_cast<uint32_t>(CONFIG_WS_SOAK_FAIL_EVERY), 1};
+    static SyntheticEnvironmentalSensor env_sensor_raw(time_provider, kSoak);
+    ESP_LOGW(TAG, "SOAK MODE: synthetic sensors at %dx, data log every %d ms",
+             CONFIG_WS_SOAK_SPEEDUP, CONFIG_WS_SOAK_LOG_INTERVAL_MS);
+#else
+#if defined(CONFIG_WS_BME280_COMPENSATION_DOUBLE)
+    constexpr Bme280Compensation kEnvCompensation = Bme280Compensation::Double;
+#else
+    constexpr Bme280Compensation kEnvCompensation = Bme280Compensation::Integer;
+#endif
+    static Bme280Sensor env_sensor_raw(i2c_bus, kEnvCompensation);
+#if defined(CONFIG_WS_BME280_PROFILE_FORCED)
+    env_sensor_raw.setProfile(bme280_profiles::kForcedLowPower);
+#endif
+#endif
+    static LockedEnvironmentalSensor env_sensor(env_sensor_raw, time_provider);
+#if defined(WS_LOCK_STATS)
+    lockRegistry().add("env", env_sensor.mutex());
+#endif
+
+#if BOARD_HAS_INA226
+    // INA226 pump power monitor (feature 006, rev2 only). Rides the SAME
+    // EspI2cBus instance as the BME280 — the bus-sharing contract from
+    // PR-03: one bus owner, every I2C driver receives it, never a second
+    // bus on these pins. Not safety-critical: a failed init is logged and
+    // the system keeps running — lazy re-init recovers on later attempts
+    // (US3 semantics). Function-local statics after pumps_force_off()
+    // (boot fail-safe rule). Wrapped in the mutex-serializing decorator:
+    // reached from the console REPL task only in this PR, but wrapped
+    // already per the established rule (PR-09 web + PR-11 controller add
+    // readers), so EVERY access goes through the wrapper.
+#if defined(CONFIG_WS_SOAK_MODE)
+    static SyntheticPowerSensor power_sensor_raw(
+        time_provider, SyntheticSettings{kSoak.speedup, kSoak.failEvery, 2}, &plant);
+#else
+    static Ina226Sensor power_sensor_raw(i2c_bus, BOARD_INA226_ADDR,
+                                         CONFIG_WS_INA226_SHUNT_MILLIOHM);
+#endif
+    static LockedPowerSensor power_sensor(power_sensor_raw, time_provider);
+#if defined(WS_LOCK_STATS)
+    lockRegistry().add("power", power_sensor.mutex());
+#endif
+#endif
+
+    // The I2C probe (fast-mode check, BME280 and INA226 init) waits out a
+    // timeout per absent address; it runs on its own task while the storage,
+    // Wi-Fi and RS485 bring-up below goes on, and is joined before the I2C
+    // bus task starts. Nothing else touches the bus until then.
+    static StaticSemaphore_t i2c_probe_done_buf;
+    static I2cProbe i2c_probe_ctx;
+    i2c_probe_ctx.master = &i2c_bus_master;
+    i2c_probe_ctx.env = &env_sensor;
+#if BOARD_HAS_INA226
+    i2c_probe_ctx.power = &power_sensor;
+#endif
+    i2c_probe_ctx.done = xSemaphoreCreateBinaryStatic(&i2c_probe_done_buf);
+    if (task_plan_create<task_plan::kI2cProbe>(i2c_probe_task, &i2c_probe_ctx) != pdPASS) {
+        ESP_LOGW(TAG, "failed to create the I2C probe task; probing inline");
+        i2c_probe(i2c_probe_ctx);
+        xSemaphoreGive(i2c_probe_ctx.done);
     }
 
     // Persistent storage. Not safety-critical: any failure below is logged
@@ -296,6 +646,7 @@ extern "C" void app_main(void)
         ESP_LOGE(TAG, "NVS init failed: %s (config falls back to defaults)",
                  esp_err_to_name(nvs_err));
     }
+    boot_mark(BootPhase::Nvs);
 
     // System network init (feature 007). The TCP/IP stack and the default
     // event loop must exist before any WiFi driver is constructed (US1/US2);
@@ -319,34 +670,199 @@ extern "C" void app_main(void)
                  esp_err_to_name(event_err));
     }
 
-    // littlefs mount-or-format of the `storage` partition at /storage
-    // (FR-007; a corrupted filesystem is reformatted, never bricks).
-    const esp_err_t mount_err = StorageMount::mount();
-    if (mount_err != ESP_OK) {
-        ESP_LOGE(TAG, "storage mount failed: %s (data storage unavailable)",
-                 esp_err_to_name(mount_err));
-    }
+    // The littlefs volume at /storage is mounted below, once the storage
+    // decorators exist (storage_mount_start()). The gzipped frontend on the volume, with its ETags and RAM cache:
+    // served by the API server in station mode, the setup pages by the
+    // provisioning portal.
+    static api::AssetStore asset_store(StorageMount::kBasePath);
 
     // Storage instances — function-local statics after pumps_force_off()
     // (boot fail-safe rule), wrapped in the mutex-serializing decorators:
     // accessed from this task and the console REPL task, so EVERY access
     // from here on goes through the wrappers (FR-013).
+    //
+    // The chunk-index and event-tail caches keep steady-state history and
+    // event appends at one open+write+fsync (no directory scan per reading,
+    // no re-parse of the event log per event); both are rebuilt from the
+    // files on first use, so boot needs no recovery step either way.
+    // Group commit (off unless CONFIG_WS_HISTORY_GROUP_COMMIT_MS > 0) is
+    // deadline-polled by the watering task through flushIfDue(). The delta
+    // codec only affects chunks created from now on (reads handle both).
+    // Rollup tiers are opt-in (CONFIG_WS_HISTORY_ROLLUPS) for their flash
+    // cost, the hour and day tiers with a quantile sketch per bucket for
+    // /history/stats percentiles (CONFIG_WS_HISTORY_QUANTILE_SKETCHES);
+    // sealed chunks get summaries (CONFIG_WS_HISTORY_CHUNK_SUMMARIES)
+    // that long window stats read in their place. With
+    // CONFIG_WS_HISTORY_BACKGROUND_MAINTENANCE the tiers are written, and
+    // sealed fixed-format chunks recompacted, by the maintenance task
+    // below instead. Usage stats are tallied from the writes and re-read
+    // from littlefs at most every CONFIG_WS_STORAGE_STATS_RESYNC_MS. Repeated
+    // history reads are served from CONFIG_WS_HISTORY_CHUNK_CACHE_KB of
+    // decoded chunks (_PSRAM_KB of PSRAM on a board with it: the pool's
+    // budget, BufferBudget.h), and short windows and the latest reading
+    // from the last CONFIG_WS_HISTORY_RECENT_READINGS of each metric. With
+    // CONFIG_WS_HISTORY_RETENTION each metric's chunk ring is sized from the
+    // partition by the retention rules instead of the fixed ten;
+    // CONFIG_WS_HISTORY_MULTIPLEXED instead keeps every metric in one shared
+    // ring, for installs logging more than 16 metrics. Either backend times
+    // its appends with esp_timer for the write accounting in
+    // getStorageStats().
     static NvsConfigStore config_store;
-    static LittleFsDataStorage data_storage(StorageMount::kBasePath,
-                                            StorageMount::statsProvider());
+#if defined(CONFIG_WS_DATA_STORAGE_RINGLOG)
+    // Ring-log backend (partitions_ringlog.csv): history and events in the
+    // raw `ringlog` partition; littlefs above only serves the web assets.
+    // The constructor rebuilds the ring heads from the sector headers (reads
+    // only, through the mmap'ed view). A missing partition leaves the storage
+    // unusable — appends fail and are counted like any store failure.
+    static EspFlashPartition ring_partition;
+    const esp_err_t ring_err = ring_partition.open();
+    if (ring_err != ESP_OK) {
+        ESP_LOGE(TAG, "ringlog partition: %s (data storage unavailable)",
+                 esp_err_to_name(ring_err));
+    }
+    static RingLogDataStorage data_storage(ring_partition, &esp_timer_get_time);
+#else
+#if defined(CONFIG_WS_HISTORY_DELTA_CODEC)
+    constexpr HistoryCodec kHistoryCodec = HistoryCodec::Delta;
+#else
+    constexpr HistoryCodec kHistoryCodec = HistoryCodec::Fixed;
+#endif
+#if defined(CONFIG_WS_HISTORY_MULTIPLEXED)
+    constexpr HistoryFormat kHistoryFormat = HistoryFormat::Multiplexed;
+#else
+    constexpr HistoryFormat kHistoryFormat = HistoryFormat::PerMetric;
+#endif
+#if defined(CONFIG_WS_HISTORY_ROLLUPS)
+    constexpr bool kHistoryRollups = true;
+#else
+    constexpr bool kHistoryRollups = false;
+#endif
+#if defined(CONFIG_WS_HISTORY_QUANTILE_SKETCHES)
+    constexpr bool kHistoryQuantileSketches = true;
+#else
+    constexpr bool kHistoryQuantileSketches = false;
+#endif
+#if defined(CONFIG_WS_HISTORY_CHUNK_SUMMARIES)
+    constexpr bool kHistoryChunkSummaries = true;
+#else
+    constexpr bool kHistoryChunkSummaries = false;
+#endif
+#if defined(CONFIG_WS_HISTORY_BATCH_JOURNAL)
+    constexpr bool kHistoryBatchJournal = true;
+#else
+    constexpr bool kHistoryBatchJournal = false;
+#endif
+#if defined(CONFIG_WS_HISTORY_BACKGROUND_MAINTENANCE)
+    constexpr bool kHistoryBackgroundMaintenance = true;
+#else
+    constexpr bool kHistoryBackgroundMaintenance = false;
+#endif
+#if defined(CONFIG_WS_HISTORY_RETENTION)
+    // Planned at the delta codec's changed-value cost (3-4 bytes), so an
+    // unchanged-value stretch only adds to the days kept.
+    const retention::Plan history_retention = plan_history_retention(
+        kHistoryRollups, kHistoryQuantileSketches,
+        kHistoryCodec == HistoryCodec::Delta ? 4 : LittleFsDataStorage::kHistoryRecordBytes);
+#else
+    const retention::Plan history_retention;
+#endif
+    static LittleFsDataStorage data_storage(
+        StorageMount::kBasePath, StorageMount::statsProvider(),
+        LittleFsDataStorageOptions{
+            .cacheChunkIndex = true,
+            .cacheEventTail = true,
+            .eventLogBytes = static_cast<std::size_t>(CONFIG_WS_EVENT_LOG_KB) * 1024,
+            .eventSegments = static_cast<std::size_t>(CONFIG_WS_EVENT_LOG_SEGMENTS),
+            .groupCommitWindowMs =
+                static_cast<uint32_t>(CONFIG_WS_HISTORY_GROUP_COMMIT_MS),
+            .groupCommitMaxRecords = 64,
+            .clock = &time_provider,
+            .journalBatches = kHistoryBatchJournal,
+            .historyFormat = kHistoryFormat,
+            .historyCodec = kHistoryCodec,
+            .rollups = kHistoryRollups,
+            .quantileSketches = kHistoryQuantileSketches,
+            .chunkSummaries = kHistoryChunkSummaries,
+            .backgroundMaintenance = kHistoryBackgroundMaintenance,
+            .statsResyncMs =
+                static_cast<uint32_t>(CONFIG_WS_STORAGE_STATS_RESYNC_MS),
+            .chunkCacheBytes = bufferBudgets().declare(
+                BufferPool::HistoryChunkCache,
+                {static_cast<std::size_t>(CONFIG_WS_HISTORY_CHUNK_CACHE_PSRAM_KB) * 1024,
+                 static_cast<std::size_t>(CONFIG_WS_HISTORY_CHUNK_CACHE_KB) * 1024}),
+            .recentReadings =
+                static_cast<std::size_t>(CONFIG_WS_HISTORY_RECENT_READINGS),
+            .retention = history_retention,
+            .appendClock = &esp_timer_get_time,
+        });
+#endif
     static LockedConfigStore config(config_store);
-    static LockedDataStorage storage(data_storage);
+    // Writes arriving during an API history scan queue instead of waiting
+    // (CONFIG_WS_STORAGE_WRITE_BEHIND_DEPTH); waits are timed by esp_timer.
+    static LockedDataStorage locked_storage(
+        data_storage,
+        static_cast<std::size_t>(CONFIG_WS_STORAGE_WRITE_BEHIND_DEPTH),
+        &esp_timer_get_time);
+#if defined(WS_LOCK_STATS)
+    lockRegistry().add("config", config.mutex());
+    lockRegistry().add("storage", locked_storage.mutex());
+#endif
+    // Storage writer task: every consumer below writes into a bounded queue
+    // that a low-priority task applies, so a slow fsync never lands in the
+    // watering tick or the 10 Hz loop. Reads apply the queue first. An
+    // esp_restart() shutdown handler drains it. With the queue off
+    // (CONFIG_WS_STORAGE_WRITER_QUEUE_DEPTH = 0) or no task, writes go
+    // straight to `locked_storage` as before.
+#if CONFIG_WS_STORAGE_WRITER_QUEUE_DEPTH > 0
+    static QueuedDataStorage queued_storage(
+        locked_storage,
+        static_cast<std::size_t>(CONFIG_WS_STORAGE_WRITER_QUEUE_DEPTH));
+    IDataStorage& storage = storage_writer_task_start(queued_storage)
+                                ? static_cast<IDataStorage&>(queued_storage)
+                                : locked_storage;
+#else
+    IDataStorage& storage = locked_storage;
+#endif
 
     // Persistent event logger (feature 008 US2). Function-local statics after
     // pumps_force_off() (boot fail-safe rule): the SystemWallClock is trivial
-    // (reads time(nullptr); SNTP steps it in US3) and the EventLogger only
-    // stores references. It composes the SAME cross-task LockedDataStorage
-    // (`storage`) so events written from the main loop and later producers
-    // serialize with every other store access. A failed store is counted, never
+    // (a cached esp_timer offset into the system clock; SNTP steps it in
+    // US3) and the EventLogger only
+    // stores references. It composes the SAME cross-task `storage` (the
+    // writer queue over the LockedDataStorage) so events written from the
+    // main loop and later producers serialize with every other store access. A failed store is counted, never
     // thrown — logging never blocks or crashes watering (FR-014).
     static SystemWallClock wall_clock;
     static EventLogger event_logger(storage, wall_clock);
 
+    // Mount the volume beside the boot (CONFIG_WS_STORAGE_ASYNC_MOUNT): the
+    // LockedDataStorage is held offline for it, so the events and readings
+    // logged from here on queue in RAM until it is up and history reads
+    // wait for it; nothing has read the storage before this point. The
+    // event counts (/api/v1/events/summary) are restored after the mount —
+    // the RTC blocks after a warm reset, else recounted from the log, which
+    // by then holds this boot's events too — and the usage line logged.
+    static StorageMountJob storage_mount_job;
+#if !defined(CONFIG_WS_DATA_STORAGE_RINGLOG)
+    storage_mount_job.hold = &locked_storage;
+#endif
+#if defined(CONFIG_WS_STORAGE_ASYNC_MOUNT)
+    storage_mount_job.earlyWrites = static_cast<std::size_t>(CONFIG_WS_STORAGE_EARLY_WRITES);
+#endif
+    storage_mount_job.storage = &storage;
+    storage_mount_job.counts = &event_logger.counts();
+#if defined(CONFIG_WS_LEGACY_HISTORY_IMPORT)
+    storage_mount_job.legacyImport = &data_storage;
+#endif
+    storage_mount_start(storage_mount_job);
+#if defined(CONFIG_WS_HISTORY_BACKGROUND_MAINTENANCE) && !defined(CONFIG_WS_DATA_STORAGE_RINGLOG)
+    // Due rollups and recompaction, a step at a time through the same
+    // wrappers; a step that finds the lock held (the mount too) is skipped.
+    maintenance_task_start(storage);
+#endif
+    // Watchdog near-misses become `wdt-warn` events from here on.
+    watchdog_set_event_logger(event_logger);
+
     // SNTP wall-clock synchroniser (feature 008 US3). Function-local static
     // after pumps_force_off() (boot fail-safe rule): the constructor only zeroes
     // its SyncStatus, no IDF work. Install the Swedish timezone (CET/CEST) now
@@ -357,6 +873,21 @@ extern "C" void app_main(void)
     // the watering path and is non-fatal (FR-014).
     static SntpClient sntp;
     sntp.applyTimezone();
+    // Each sync steps the system clock; re-anchor the wall clock's cached
+    // monotonic offset right behind it.
+    sntp.attach(wall_clock);
+
+#if defined(CONFIG_WS_CLOCK_HOLDOVER)
+    // Wall-clock holdover: step the clock from the RTC-memory anchor or the
+    // DS3231 before anything below stamps an event, so the reset event and
+    // the first data-log pass carry a real epoch instead of waiting for
+    // SNTP. The DS3231 read runs inline on the bus port (its task is not up
+    // yet). The task seals the anchor and marks the clock confirmed once
+    // SNTP syncs.
+    clock_holdover_restore(&i2c_bus);
+    wall_clock.resync();
+    clock_holdover_start(sntp);
+#endif
 
     // Record why this boot happened (watchdog/panic/brownout/power-on).
     // esp_reset_reason() is RTC-latched and not cleared by watchdog_init(), so
@@ -369,20 +900,25 @@ extern "C" void app_main(void)
              resetReasonName(static_cast<int>(reset_reason)));
     event_logger.logReset(static_cast<int>(reset_reason));
 
-    // One-line usage report (parity: storage usage in the serial status
-    // block; FR-008).
-    const StorageStats stats = storage.getStorageStats();
-    ESP_LOGI(TAG, "Storage: %lu/%lu KiB used",
-             static_cast<unsigned long>(stats.usedBytes / 1024),
-             static_cast<unsigned long>(stats.totalBytes / 1024));
-
-    // Task watchdog (feature 008 US3). Reconfigure the boot-time WDT to the
-    // Kconfig timeout with panic (reboot) on a non-serviced subscribed task.
-    // Placed here — after storage/netif init and AFTER the reset-reason event
-    // was logged above (so a prior TASK_WDT reset is recorded), and before the
-    // watering-critical tasks start and subscribe. Non-fatal on failure (logged
-    // inside): the watering path still runs, just unwatched.
-    watchdog_init();
+    // Lifetime counters: totals across resets, sealed once a second into
+    // RTC_NOINIT memory and copied to NVS on a slow cadence and before a
+    // restart. Counts this boot and its reset reason. The zone pump pointer
+    // table is a function-local static (the task keeps reading it).
+    static std::array<const IWaterPump*, kBoardZoneCount - 1> counted_zones{};
+    for (std::size_t i = 0; i < zone_pump.size(); ++i) {
+        counted_zones[i] = &*zone_pump[i];
+    }
+    LifetimeSources lifetime_sources;
+    lifetime_sources.plantPump = &plant;
+#if BOARD_HAS_RESERVOIR_PUMP
+    lifetime_sources.reservoirPump = &reservoir;
+#endif
+    lifetime_sources.zonePumps = counted_zones.data();
+    lifetime_sources.zonePumpCount = counted_zones.size();
+    lifetime_sources.events = &event_logger;
+    lifetime_sources.storage = &storage;
+    lifetime_sources.eventCounts = &event_logger.counts();
+    lifetime_counters_start(lifetime_sources, static_cast<int>(reset_reason));
 
     // WiFi boot-mode decision (feature 007, US1 + US3). A missing stored SSID
     // (the factory/unconfigured state) OR a held config button forces
@@ -462,8 +998,20 @@ extern "C" void app_main(void)
         // Function-local static (boot fail-safe rule: no non-trivial
         // static/global constructors). Constructed only on this branch, kept
         // alive for the program lifetime so it keeps serving.
+        // The portal lists the networks in range from a cache the scan task
+        // refreshes in the background (the AP stays up: APSTA mode).
+        static WifiScanCache scan_cache(
+            wifi_driver, time_provider,
+            static_cast<uint32_t>(CONFIG_WS_PROV_SCAN_REFRESH_S) * 1000U);
         static ProvisioningPortal provisioning_portal(config);
+        provisioning_portal.setScanCache(scan_cache);
+        provisioning_portal.setAssets(asset_store);
+        // The setup pages are files on the volume.
+        storage_wait_ready("provisioning portal", kStorageWaitMs);
         const esp_err_t prov_err = provisioning_portal.start();
+        if (ap_ok) {
+            wifi_scan_task_start(scan_cache);
+        }
         if (prov_err != ESP_OK) {
             ESP_LOGE(TAG, "provisioning portal failed to start: %s",
                      esp_err_to_name(prov_err));
@@ -479,8 +1027,9 @@ extern "C" void app_main(void)
         ESP_LOGI(TAG, "WiFi: station mode (stored credentials present)");
         // Reconnect timing from Kconfig (parity defaults, docs/parity-
         // checklist.md §7): 10 s retry, +60 s pause after 5 consecutive
-        // failures, 5 s health monitor. The pure WifiManager owns all cadence
-        // above the IWifiDriver seam.
+        // failures, 5 s health monitor; plus the directed attempts at the
+        // remembered AP that precede a full scan in each round. The pure
+        // WifiManager owns all cadence above the IWifiDriver seam.
         const ReconnectPolicy wifi_policy = {
             .retryIntervalMs =
                 static_cast<uint32_t>(CONFIG_WS_WIFI_RETRY_INTERVAL_MS),
@@ -489,6 +1038,8 @@ extern "C" void app_main(void)
             .pauseMs = static_cast<uint32_t>(CONFIG_WS_WIFI_PAUSE_MS),
             .monitorIntervalMs =
                 static_cast<uint32_t>(CONFIG_WS_WIFI_MONITOR_INTERVAL_MS),
+            .cachedAttempts =
+                static_cast<uint8_t>(CONFIG_WS_WIFI_CACHED_ATTEMPTS),
         };
         // Function-local static (boot fail-safe rule). Reuses the app_main
         // EspTimeProvider (the same monotonic clock the pump/level layer uses)
@@ -497,6 +1048,28 @@ extern "C" void app_main(void)
         // issues the first STA connect; the wifi task then ticks it.
         static WifiManager wifi_manager_inst(wifi_driver, config, time_provider,
                                              wifi_policy);
+        // A stored static IP goes on the STA netif before the first connect,
+        // so GOT_IP (and with it the API server) follows association with no
+        // DHCP exchange. A failure leaves DHCP in charge.
+        const esp_err_t static_ip_err = wifi_driver.setStaticIp(config.getStaticIp());
+        if (static_ip_err != ESP_OK) {
+            ESP_LOGW(TAG, "static IP not applied: %s (using DHCP)",
+                     esp_err_to_name(static_ip_err));
+        }
+        // Modem sleep while idle from Kconfig; SystemObserver reports pump
+        // runs and stream clients, which hold it off. Never with an ESP-NOW
+        // role: a sleeping radio misses the other node's frames.
+        WifiPowerSavePolicy wifi_power_save;
+#if CONFIG_WS_WIFI_POWER_SAVE_NONE || CONFIG_WS_ESPNOW_LEAF || CONFIG_WS_ESPNOW_GATEWAY
+        wifi_power_save.mode = WifiPowerSave::None;
+#elif CONFIG_WS_WIFI_POWER_SAVE_MAX_MODEM
+        wifi_power_save.mode = WifiPowerSave::MaxModem;
+        wifi_power_save.listenInterval =
+            static_cast<uint8_t>(CONFIG_WS_WIFI_LISTEN_INTERVAL);
+#endif
+        wifi_power_save.busyLingerMs =
+            static_cast<uint32_t>(CONFIG_WS_WIFI_POWER_SAVE_LINGER_MS);
+        wifi_manager_inst.setPowerSavePolicy(wifi_power_save);
         wifi_manager_inst.begin(WifiBootMode::Station);
         wifi_manager = &wifi_manager_inst;
 
@@ -504,132 +1077,164 @@ extern "C" void app_main(void)
         // mutex with watering (FR-014). Drives the status LED too (T021).
         wifi_task_start(wifi_manager_inst);
     }
+    boot_mark(BootPhase::Wifi);
 
     // RS485 Modbus soil sensor (feature 004). Not safety-critical: a failed
     // client init is logged and the system keeps running — the sensor layer
     // reports invalid data and recovers on later attempts (US2 semantics).
     // Function-local statics after pumps_force_off() (boot fail-safe rule),
     // sensor wrapped in the mutex-serializing decorator: accessed from the
-    // console REPL task now and the main-loop controller in PR-11, so EVERY
-    // sensor access goes through the wrapper. No periodic read task in
-    // feature 004 (arrives with PR-11) — reads happen on console command
-    // only.
-    static EspModbusClient modbus_client_raw;
-    static LockedModbusClient modbus_client(modbus_client_raw);
-    static ModbusSoilSensor soil_sensor_raw(modbus_client);
+    // soil task, the console REPL and the API selftest, so EVERY
+    // sensor access goes through the wrapper. The bus itself belongs to
+    // ModbusBusMaster: the soil sensor's transactions queue at Control
+    // priority, the console's raw probes (rs485test) at Diagnostic, and
+    // the bus task started below runs them most urgent first. Init runs
+    // inline, before the task exists. The client behind the bus is the
+    // Kconfig choice (WS_MODBUS_CLIENT): esp-modbus or the UART-driver one.
+#if CONFIG_WS_MODBUS_CLIENT_UART
+    using ModbusClientImpl = UartModbusClient;
+#else
+    using ModbusClientImpl = EspModbusClient;
+#endif
+    static ModbusClientImpl modbus_client_raw;
+#if CONFIG_WS_MODBUS_CLIENT_UART
+    // Every RS485 frame into a RAM ring (ModbusFrameCapture.h), for
+    // `rs485test capture` and GET /api/v1/modbus/capture.
+    static ModbusFrameCapture modbus_capture;
+    modbus_client_raw.setCapture(&modbus_capture);
+#endif
+    static ModbusBusMaster modbus_bus(modbus_client_raw, &esp_timer_get_time);
+    modbus_bus.setPowerLock(power_lock(PowerLockKind::ApbMax));
+    IModbusClient& modbus_control = modbus_bus.port(ModbusPriority::Control);
+    // Line rate negotiated with `rs485test baud` (ModbusBaudNegotiator.h):
+    // the client comes up at the stored rate.
+    const uint32_t modbus_baud = config.getModbusBaudRate();
+    if (modbus_baud != ModbusClientImpl::kBaudRate &&
+        !modbus_control.setBaudRate(modbus_baud)) {
+        ESP_LOGW(TAG, "stored RS485 rate %lu baud not applied",
+                 static_cast<unsigned long>(modbus_baud));
+    }
+
+    // Multi-drop segment (CONFIG_WS_SOIL_SENSOR_ADDRESSES): the first probe
+    // is the primary the watering controller decides on, read by the
+    // SoilAcquirer; the SoilPollScheduler reads the others round-robin
+    // across the sensor-read interval. Both run on the soil task. Every
+    // probe has its own driver and LockedSoilSensor cache, all on the
+    // Control port.
+    uint8_t soil_addresses[SoilPollScheduler::kMaxProbes];
+    std::size_t soil_probe_count =
+        parseSoilAddresses(CONFIG_WS_SOIL_SENSOR_ADDRESSES, soil_addresses,
+                           SoilPollScheduler::kMaxProbes);
+    if (soil_probe_count == 0) {
+        ESP_LOGE(TAG, "invalid soil probe list \"%s\" — using the single "
+                 "probe at 0x%02x", CONFIG_WS_SOIL_SENSOR_ADDRESSES,
+                 ModbusSoilSensor::kDefaultDeviceAddress);
+        soil_addresses[0] = ModbusSoilSensor::kDefaultDeviceAddress;
+        soil_probe_count = 1;
+    }
+#if defined(CONFIG_WS_SOAK_MODE)
+    using SoilSensorImpl = SyntheticSoilSensor;
+    // Seeds 3.. after the environmental and power sensors.
+    auto soil_probe_args = [&](std::size_t i) {
+        return SyntheticSettings{kSoak.speedup, kSoak.failEvery,
+                                 static_cast<uint32_t>(3 + i)};
+    };
+    static SoilSensorImpl soil_sensor_raw(time_provider, soil_probe_args(0));
+#else
+    using SoilSensorImpl = ModbusSoilSensor;
+    static SoilSensorImpl soil_sensor_raw(modbus_control, soil_addresses[0]);
+#endif
     static LockedSoilSensor soil_sensor(soil_sensor_raw);
+#if defined(WS_LOCK_STATS)
+    lockRegistry().add("soil", soil_sensor.mutex());
+#endif
+    static SoilAcquirer soil_acquirer(soil_sensor, time_provider);
+#if defined(CONFIG_WS_SOIL_FILTER)
+    static SoilSnapshotFilter soil_filter;
+    soil_acquirer.setFilter(&soil_filter);
+#endif
+#if CONFIG_WS_SOIL_FLATLINE_MINUTES > 0
+    // Stuck probe: 60+ identical raw moisture readings, or a spread under
+    // 0.02 %, for the configured minutes (the probe reports 0.1 % steps).
+    FlatlineSettings soil_flatline_settings;
+    soil_flatline_settings.minFlatMs = CONFIG_WS_SOIL_FLATLINE_MINUTES * 60 * 1000LL;
+    soil_flatline_settings.minStdDev = 0.02f;
+    static FlatlineDetector soil_flatline(soil_flatline_settings);
+    soil_acquirer.setFlatline(&soil_flatline);
+#endif
+    static SoilPollScheduler soil_poller(modbus_control.baudRate(),
+                                         [] { return modbus_bus.busTimeUs(); });
+    static std::optional<SoilSensorImpl>
+        soil_probe_raw[SoilPollScheduler::kMaxProbes - 1];
+    static std::optional<LockedSoilSensor>
+        soil_probe[SoilPollScheduler::kMaxProbes - 1];
+    soil_poller.add(soil_addresses[0], soil_sensor);
+    for (std::size_t i = 1; i < soil_probe_count; ++i) {
+#if defined(CONFIG_WS_SOAK_MODE)
+        soil_probe_raw[i - 1].emplace(time_provider, soil_probe_args(i));
+#else
+        soil_probe_raw[i - 1].emplace(modbus_control, soil_addresses[i]);
+#endif
+        soil_probe[i - 1].emplace(*soil_probe_raw[i - 1]);
+        soil_poller.add(soil_addresses[i], *soil_probe[i - 1]);
+    }
+    if (soil_probe_count > 1) {
+        const SoilBusUsage plan = soil_poller.usage();
+        ESP_LOGI(TAG, "%u soil probes on RS485, %lu us of airtime each",
+                 static_cast<unsigned>(soil_probe_count),
+                 static_cast<unsigned long>(plan.readAirtimeUs));
+    }
 
-    if (modbus_client.initialize()) {
+    if (modbus_control.initialize()) {
         ESP_LOGI(TAG, "RS485 Modbus client up (UART%d)",
                  BOARD_RS485_UART_PORT);
+        // A probe reset to its factory rate answers there: follow it and
+        // store that, rather than time out on every read.
+        if (modbus_control.baudRate() != ModbusClientImpl::kBaudRate &&
+            confirmSoilBusBaud(modbus_control, soil_addresses[0],
+                               ModbusClientImpl::kBaudRate) !=
+                modbus_baud) {
+            ESP_LOGW(TAG, "soil probe answers at %lu baud, not the stored %lu",
+                     static_cast<unsigned long>(modbus_control.baudRate()),
+                     static_cast<unsigned long>(modbus_baud));
+            config.setModbusBaudRate(modbus_control.baudRate());
+        }
     } else {
         ESP_LOGE(TAG, "RS485 Modbus client init failed (error %d) — "
                  "soil sensor unavailable until recovery",
-                 modbus_client.getLastError());
+                 modbus_control.getLastError());
     }
+    boot_mark(BootPhase::Modbus);
+    modbus_task_start(modbus_bus);
 
-    // BME280 environmental sensor on the shared I2C bus (feature 005).
-    // Not safety-critical: a failed init is logged and the system keeps
-    // running — the sensor layer reports invalid data and the lazy re-init
-    // recovers on later polls (US2 semantics). Function-local statics after
-    // pumps_force_off() (boot fail-safe rule). The ONE EspI2cBus instance
-    // is the shared bus owner — PR-05's INA226 driver receives this same
-    // instance (FR-003); no second bus creation on these pins is permitted.
-    // The sensor is wrapped in the mutex-serializing decorator: accessed
-    // from the 5 s sensor task and the console REPL task, so EVERY sensor
-    // access goes through the wrapper.
-    static EspI2cBus i2c_bus;
-    static Bme280Sensor env_sensor_raw(i2c_bus);
-    static LockedEnvironmentalSensor env_sensor(env_sensor_raw);
-
-    if (env_sensor.initialize()) {
-        ESP_LOGI(TAG, "BME280 environmental sensor up");
-    } else {
-        ESP_LOGW(TAG, "BME280 init failed (error %d) — environmental "
-                 "readings unavailable until recovery",
-                 env_sensor.getLastError());
-    }
-
-#if BOARD_HAS_INA226
-    // INA226 pump power monitor (feature 006, rev2 only). Rides the SAME
-    // EspI2cBus instance as the BME280 — the bus-sharing contract from
-    // PR-03: one bus owner, every I2C driver receives it, never a second
-    // bus on these pins. Not safety-critical: a failed init is logged and
-    // the system keeps running — lazy re-init recovers on later attempts
-    // (US3 semantics). Function-local statics after pumps_force_off()
-    // (boot fail-safe rule). Wrapped in the mutex-serializing decorator:
-    // reached from the console REPL task only in this PR, but wrapped
-    // already per the established rule (PR-09 web + PR-11 controller add
-    // readers), so EVERY access goes through the wrapper.
-    static Ina226Sensor power_sensor_raw(i2c_bus, BOARD_INA226_ADDR,
-                                         CONFIG_WS_INA226_SHUNT_MILLIOHM);
-    static LockedPowerSensor power_sensor(power_sensor_raw);
-
-    if (power_sensor.initialize()) {
-        ESP_LOGI(TAG, "INA226 power monitor up at 0x%02x (shunt %d mOhm)",
-                 BOARD_INA226_ADDR, CONFIG_WS_INA226_SHUNT_MILLIOHM);
-    } else {
-        ESP_LOGW(TAG, "INA226 init failed (error %d) — power readings "
-                 "unavailable until recovery",
-                 power_sensor.getLastError());
-    }
-#endif
-
-    // Reservoir level sensors (feature 006). Not safety-critical at boot:
-    // a failed GPIO init is logged and the system keeps running — the
-    // affected sensor is latched Faulted (markFaulted below), so it
-    // reports not-yet-valid forever instead of debouncing a floating pin
-    // into a "valid" reading, and PR-11's fail-safe treats invalid as
-    // "do not act". Function-local statics
-    // after pumps_force_off() (boot fail-safe rule). Split per research
-    // R1: GpioLevelSensor is the raw pin read (input + pull-up, no logic);
-    // DebouncedLevelSensor holds ALL policy — polarity (FW-5), debounce
-    // and settle gating (FW-3) from the board macros. Wrapped in the
-    // mutex-serializing decorators: updated from this main loop at 10 Hz
-    // and read by the console REPL task (`level`), so EVERY access from
-    // here on goes through the wrappers.
-    static GpioLevelSensor level_low_input(BOARD_PIN_LEVEL_LOW);
-    static GpioLevelSensor level_high_input(BOARD_PIN_LEVEL_HIGH);
-    static DebouncedLevelSensor level_low_raw(
-        level_low_input, time_provider, BOARD_LEVEL_ACTIVE_LOW != 0,
-        BOARD_LEVEL_DEBOUNCE_MS, BOARD_LEVEL_SETTLE_MS);
-    static DebouncedLevelSensor level_high_raw(
-        level_high_input, time_provider, BOARD_LEVEL_ACTIVE_LOW != 0,
-        BOARD_LEVEL_DEBOUNCE_MS, BOARD_LEVEL_SETTLE_MS);
-    static LockedLevelSensor level_low(level_low_raw);
-    static LockedLevelSensor level_high(level_high_raw);
-
-    // Both inits run unconditionally (no short-circuit): a low-input
-    // failure must never skip the high-input init.
-    const bool level_low_ok = level_low_input.initialize();
-    const bool level_high_ok = level_high_input.initialize();
-
-    // FW-3: the sensor rail is on from power-up (rail *control* arrives in
-    // PR-14) — arm the settle gate once at boot. On rev1 the settle window
-    // is 0 ms, so this only re-affirms the construction-time gating.
-    level_low.notifyPowerOn();
-    level_high.notifyPowerOn();
-
-    // A failed GPIO init leaves that pin unconfigured and floating: latch
-    // the sensor Faulted so isValid() stays false — markFaulted() is on
-    // the concrete DebouncedLevelSensor by design (not ILevelSensor), so
-    // it is called here at the wiring site, on the raw objects; safe
-    // because no other task touches the sensors yet (console registration
-    // and the main loop come later). Ordered AFTER the boot
-    // notifyPowerOn() above, which is the deliberate re-arm that clears a
-    // fault (recovery: PR-14 rail control or an operator power cycle).
-    if (!level_low_ok) {
-        level_low_raw.markFaulted();
-        ESP_LOGE(TAG, "level LOW sensor GPIO init failed (pin %d) — sensor "
-                 "faulted, readings invalid until a power-on re-arm",
-                 BOARD_PIN_LEVEL_LOW);
-    }
-    if (!level_high_ok) {
-        level_high_raw.markFaulted();
-        ESP_LOGE(TAG, "level HIGH sensor GPIO init failed (pin %d) — sensor "
-                 "faulted, readings invalid until a power-on re-arm",
-                 BOARD_PIN_LEVEL_HIGH);
-    }
+    // Join the I2C probe: the bus task takes the bus from here.
+    xSemaphoreTake(i2c_probe_ctx.done, portMAX_DELAY);
+    i2c_task_start(i2c_bus_master);
+#if defined(CONFIG_WS_INA226_SAMPLING_TASK)
+    // One read per completed INA226 conversion, through the bus task, each
+    // integrated into Wh per plant run and per day (GET /api/v1/power).
+    static EnergyMeter energy_meter;
+    PowerEnergySinks energy_sinks;
+    energy_sinks.meter = &energy_meter;
+    energy_sinks.pump = &plant;
+    energy_sinks.clock = &wall_clock;
+    energy_sinks.storage = &storage;
+    power_task_start(power_sensor, CONFIG_WS_INA226_ALERT_GPIO, energy_sinks);
+#endif
+#if defined(CONFIG_WS_INA226_CAPTURE)
+    // Plant pump current at ~1 kHz while it runs: run summaries go to the
+    // event log, raw samples to GET /api/v1/power/capture.
+    static PumpCurrentCapture power_capture;
+    power_capture_task_start(power_sensor, plant, power_capture, event_logger);
+#endif
+#if defined(CONFIG_WS_PUMP_OVERCURRENT_TRIP)
+    // INA226 ALERT cuts the plant pump gate from its ISR. The one use of
+    // plant_pump outside its wrapper: forceOffFromIsr() is a lock-free
+    // register write, and the deferred stop() goes through `plant`.
+    overcurrent_trip_start(plant_pump, plant, power_sensor, event_logger,
+                           CONFIG_WS_INA226_ALERT_GPIO,
+                           CONFIG_WS_PUMP_OVERCURRENT_TRIP_MA);
+#endif
 
     // Watering controllers (feature 011). Pure decision logic over the same
     // Locked* wrappers every other task uses; run on their own watchdog-
@@ -638,12 +1243,158 @@ extern "C" void app_main(void)
     static WateringController watering_controller(
         soil_sensor, env_sensor, plant, config, storage, time_provider,
         wall_clock, event_logger);
+    watering_controller.setSoilFeed(soil_acquirer);
+    // The sensor task is the BME280's one reader (acquisition_plan.h); the
+    // data log takes its sample instead of reading the bus a second time.
+    watering_controller.setEnvAcquired(acquisition_plan::kEnv.maxAgeMs);
+#if defined(CONFIG_WS_INPUT_RECORDER)
+    // Each zone's controller takes its samples through a recording feed;
+    // the watering task records the rest of each tick (below).
+    InputRecorder& recorder = input_recorder();
+    WateringRecorderInputs recorder_inputs;
+    recorder_inputs.recorder = &recorder;
+    recorder_inputs.wallClock = &wall_clock;
+    recorder_inputs.pumps[0] = &plant;
+    RecordedSetup recorder_setup;
+    static RecordedSoilFeed plant_recorded_feed(soil_acquirer, recorder, 0);
+    watering_controller.setSoilFeed(plant_recorded_feed);
+#endif
+#if defined(CONFIG_WS_SOAK_MODE)
+    watering_controller.setDataLogInterval(
+        static_cast<uint32_t>(CONFIG_WS_SOAK_LOG_INTERVAL_MS));
+#endif
+#if defined(CONFIG_WS_PREDICTIVE_BURST)
+    // Learns the bed's rise per pump-second and dry-down from the samples
+    // the controller decides on; the configured burst until it has.
+    static MoistureResponse plant_response;
+    watering_controller.setBurstSizer(plant_response);
+#endif
+    for (std::size_t i = 1; i < soil_probe_count; ++i) {
+        watering_controller.addSoilProbe(*soil_probe[i - 1]);
+    }
+
+    // Watering zones (board.h kBoardZones): zone 0 is the controller above;
+    // each further zone decides on its own probe, read by the soil poller
+    // through the zone's acquirer, with its own pump and soak state. All
+    // share BOARD_ZONE_PUMP_BUDGET supply slots and tick on the watering
+    // task. Zone 0 writes the data log for every probe. A zone whose probe
+    // is not on the segment gets no automatic watering (manual runs only).
+    static PumpBudget pump_budget(BOARD_ZONE_PUMP_BUDGET);
+    static WateringZones watering_zones;
+    auto zone_settings = [](const BoardZone& zone) {
+        return ZoneSettings{zone.thresholdLowPct, zone.thresholdHighPct, zone.burstS};
+    };
+    watering_controller.setZone(zone_settings(kBoardZones[0]), &pump_budget, true);
+#if defined(CONFIG_WS_INPUT_RECORDER)
+    recorder_setup.zones[0] = zone_settings(kBoardZones[0]);
+#endif
+#if defined(CONFIG_WS_DECISION_TRACE)
+    // One record per zone tick, tagged with the board.h zone index, all
+    // written from the watering task; the console and
+    // /api/v1/control/trace read it without stopping that task.
+    static DecisionTrace decision_trace;
+    watering_controller.setTrace(decision_trace, 0);
+#endif
+    watering_controller.setTickLatency(watering_task_latency());
+    watering_zones.add(watering_controller);
+    static std::array<std::optional<SoilAcquirer>, kBoardZoneCount - 1> zone_feed;
+    static std::array<std::optional<WateringController>, kBoardZoneCount - 1>
+        zone_controller;
+#if defined(CONFIG_WS_PREDICTIVE_BURST)
+    static std::array<MoistureResponse, kBoardZoneCount - 1> zone_response;
+#endif
+#if CONFIG_WS_SOIL_FLATLINE_MINUTES > 0
+    static std::array<std::optional<FlatlineDetector>, kBoardZoneCount - 1> zone_flatline;
+#endif
+#if defined(CONFIG_WS_INPUT_RECORDER)
+    static std::array<std::optional<RecordedSoilFeed>, kBoardZoneCount - 1> zone_recorded_feed;
+#endif
+    for (std::size_t i = 1; i < kBoardZoneCount; ++i) {
+        const BoardZone& zone = kBoardZones[i];
+        if (zone.soilProbe >= soil_probe_count) {
+            ESP_LOGE(TAG, "zone %s: soil probe %u not on the segment — no "
+                          "automatic watering",
+                     zone.name, static_cast<unsigned>(zone.soilProbe));
+            continue;
+        }
+        LockedSoilSensor& probe = *soil_probe[zone.soilProbe - 1];
+        zone_feed[i - 1].emplace(probe, time_provider);
+#if CONFIG_WS_SOIL_FLATLINE_MINUTES > 0
+        zone_feed[i - 1]->setFlatline(&zone_flatline[i - 1].emplace(soil_flatline_settings));
+#endif
+        soil_poller.setFeed(zone.soilProbe, *zone_feed[i - 1]);
+        zone_controller[i - 1].emplace(probe, env_sensor, *zone_pump[i - 1], config,
+                                       storage, time_provider, wall_clock,
+                                       event_logger);
+        WateringController& controller = *zone_controller[i - 1];
+        controller.setSoilFeed(*zone_feed[i - 1]);
+#if defined(CONFIG_WS_INPUT_RECORDER)
+        // Recorded by position among the zones that run (skipped ones
+        // leave no gap).
+        const uint8_t recorded = static_cast<uint8_t>(watering_zones.size());
+        controller.setSoilFeed(
+            zone_recorded_feed[i - 1].emplace(*zone_feed[i - 1], recorder, recorded));
+        recorder_inputs.pumps[recorded] = &*zone_pump[i - 1];
+        recorder_setup.zones[recorded] = zone_settings(zone);
+#endif
+        controller.setZone(zone_settings(zone), &pump_budget, false);
+#if defined(CONFIG_WS_PREDICTIVE_BURST)
+        controller.setBurstSizer(zone_response[i - 1]);
+#endif
+#if defined(CONFIG_WS_DECISION_TRACE)
+        controller.setTrace(decision_trace, static_cast<uint8_t>(i));
+#endif
+        controller.setTickLatency(watering_task_latency());
+        watering_zones.add(controller);
+    }
+    // Watering windows (CONFIG_WS_WATERING_SCHEDULE), shared by every zone;
+    // none when the text is empty or malformed.
+    static WateringSchedule watering_schedule;
+    if (!parseWateringSchedule(CONFIG_WS_WATERING_SCHEDULE, watering_schedule)) {
+        ESP_LOGE(TAG, "watering schedule \"%s\" malformed — watering at any time",
+                 CONFIG_WS_WATERING_SCHEDULE);
+    } else if (watering_schedule.size() > 0) {
+        for (std::size_t i = 0; i < watering_zones.size(); ++i) {
+            watering_zones.zone(i).setSchedule(watering_schedule);
+        }
+        ESP_LOGI(TAG, "watering schedule: %u rule(s)",
+                 static_cast<unsigned>(watering_schedule.size()));
+    }
+#if defined(CONFIG_WS_INPUT_RECORDER)
+#if defined(CONFIG_WS_PREDICTIVE_BURST)
+    recorder_setup.predictive = true;
+#endif
+    recorder_setup.pumpBudget = BOARD_ZONE_PUMP_BUDGET;
+    recorder_setup.schedule = CONFIG_WS_WATERING_SCHEDULE;
+    recorder_setup.zoneCount = watering_zones.size();
+    recorder.setSetup(recorder_setup);
 #if BOARD_HAS_RESERVOIR_PUMP
-    static ReservoirController reservoir_controller(
+    recorder_inputs.pumps[input_record::kReservoirPump] = &reservoir;
+    recorder_inputs.levelLow = &level_low;
+    recorder_inputs.levelHigh = &level_high;
+#endif
+    watering_task_set_recorder(recorder_inputs);
+    recorder_task_start();
+#endif
+#if BOARD_HAS_RESERVOIR_PUMP
+    static BoardReservoirController reservoir_controller(
         level_low, level_high, reservoir, time_provider, event_logger);
+    // The high mark turning wet stops a fill from the 10 Hz level update
+    // itself, not at the next controller tick. Handed to the loop, which
+    // sets it on the level bank it updates (BootResult).
+    s_boot_result.levelHighObserver = &reservoir_controller;
+#if defined(CONFIG_WS_ADAPTIVE_FILL_TIMEOUT)
+    // Learns the fill time between the marks; a fill that overruns it
+    // fails safe long before the 300 s cap.
+    static FillTimeEstimator fill_estimator;
+    reservoir_controller.setFillEstimator(fill_estimator);
+    reservoir_controller.setFillLog(storage, wall_clock);
+    reservoir_controller.setTickLatency(watering_task_latency());
+#endif
 #endif
 
     // Serial diagnostic REPL (rig testing; contracts/serial-diagnostic.md).
+    // With CONFIG_WS_DIAG_CONSOLE off these calls are inline no-ops.
     // Pump registration is capability-aware: single-pump boards register
     // exactly the plant pump — `pump reservoir` does not exist there
     // (compile-time absence, PR-14 contract).
@@ -653,8 +1404,14 @@ extern "C" void app_main(void)
     diag_console_register_pumps(plant);
 #endif
     diag_console_register_storage(config, storage);
-    diag_console_register_soil(soil_sensor, modbus_client);
+    diag_console_register_soil(soil_sensor,
+                               modbus_bus.port(ModbusPriority::Diagnostic),
+                               &modbus_bus, &soil_poller);
+#if CONFIG_WS_MODBUS_CLIENT_UART
+    diag_console_register_modbus_capture(modbus_capture);
+#endif
     diag_console_register_env(env_sensor);
+    diag_console_register_i2c(i2c_bus_master);
     diag_console_register_level(level_low, level_high);
 #if BOARD_HAS_INA226
     diag_console_register_power(power_sensor);
@@ -667,6 +1424,40 @@ extern "C" void app_main(void)
     // the first Connected transition, so before the first sync `time` reports
     // "time not set".
     diag_console_register_time(&wall_clock, &sntp.status());
+#if defined(CONFIG_WS_CLOCK_HOLDOVER)
+    diag_console_register_clock_holdover(clock_holdover());
+#endif
+#if defined(CONFIG_WS_DECISION_TRACE)
+    diag_console_register_trace(decision_trace);
+#endif
+#if defined(CONFIG_WS_TASK_TELEMETRY)
+    // Per-task CPU share, stack margin and heap per capability, sampled by
+    // a low-priority task for `top` and /api/v1/metrics. Function-local
+    // static (boot fail-safe rule).
+    static TaskTelemetry task_telemetry;
+    telemetry_task_start(task_telemetry);
+    diag_console_register_telemetry(task_telemetry);
+#endif
+#if defined(WS_LOCK_STATS)
+    diag_console_register_locks(lockRegistry());
+#endif
+    diag_console_register_counters(lifetime_counters());
+#if defined(CONFIG_WS_MQTT)
+    // MQTT uplink: built here so the console can report it; it publishes
+    // only once its task runs (station mode, below) and replays from the
+    // same cross-task `storage` the API reads.
+    api::MqttUplink& mqtt_uplink = mqtt_uplink_init(storage, wall_clock);
+    diag_console_register_mqtt(mqtt_uplink);
+#endif
+#if defined(CONFIG_WS_ESPNOW_LEAF)
+    // ESP-NOW role: built here so the console can report it; the radio
+    // side starts with its task (station mode, below).
+    api::NodeLeaf& espnow_leaf = espnow_leaf_init();
+    diag_console_register_espnow_leaf(espnow_leaf);
+#elif defined(CONFIG_WS_ESPNOW_GATEWAY)
+    api::NodeGateway& espnow_gateway = espnow_gateway_init(wall_clock);
+    diag_console_register_espnow_gateway(espnow_gateway);
+#endif
     esp_err_t err = diag_console_start();
     if (err != ESP_OK) {
         // Console is a diagnostic aid, not a safety function: log and keep
@@ -676,24 +1467,59 @@ extern "C" void app_main(void)
     }
 
     // 5 s environmental poll task (feature 005). Started even when the
-    // sensor failed init above — lazy re-init recovers later (parity).
-    sensor_task_start(env_sensor);
-
-    // Decision-layer watering task (feature 011). Runs the pure controllers at
-    // the sensor-read cadence on their own watchdog-registered task: the
-    // WateringController is the periodic soil reader (its blocking Modbus read
-    // refreshes the LockedSoilSensor cache /sensors serves) and the reservoir
-    // fill state machine ticks alongside it (rev1). The 10 Hz loop below is
-    // unchanged and still owns precise pump-timing enforcement. The mode flag
-    // reaches the controllers purely through `config` (read each tick) — no
-    // direct API↔controller call.
+    // sensor failed init above — lazy re-init recovers later (parity). With
+    // burst sampling it polls every second while the plant pump runs.
+#if defined(CONFIG_WS_BME280_BURST_WHILE_WATERING)
+    sensor_task_start(env_sensor, &plant);
+#else
+    sensor_task_start(env_sensor, nullptr);
+#endif
+
+    // Decision-layer watering task (feature 011) and the soil task that feeds
+    // it. The soil task does every blocking soil read at the sensor-read
+    // cadence: the primary through the acquirer (refreshing the
+    // LockedSoilSensor cache /sensors serves and publishing a timestamped
+    // snapshot), then the soil poller's further probes. Each published
+    // sample wakes the watering task, which runs the pure controllers on it
+    // at once; the reservoir fill state machine ticks alongside (rev1). The
+    // 10 Hz loop below is unchanged and still owns precise pump-timing
+    // enforcement. The mode flag reaches the controllers purely through
+    // `config` (read each tick) — no direct API↔controller call. The
+    // watering task goes first: it installs the acquirer's listener.
 #if BOARD_HAS_RESERVOIR_PUMP
-    watering_task_start(watering_controller, reservoir_controller, config,
-                        event_logger);
+    watering_task_start(watering_zones, reservoir_controller, soil_acquirer,
+                        config, event_logger);
 #else
-    watering_task_start(watering_controller, config, event_logger);
+    watering_task_start(watering_zones, soil_acquirer, config, event_logger);
+#endif
+    for (std::optional<SoilAcquirer>& feed : zone_feed) {
+        if (feed.has_value()) {
+            watering_task_add_feed(*feed);
+        }
+    }
+#if defined(CONFIG_WS_SOIL_BURST_CAPTURE)
+    // Written on the soil task in one batch: straight to the lock-guarded
+    // storage, since a capture is deeper than the writer queue.
+    static MoistureBurstCapture burst_capture(
+        locked_storage, wall_clock,
+        static_cast<int64_t>(CONFIG_WS_SOIL_BURST_CAPTURE_TAIL_S) * 1000);
+    soil_task_start(soil_acquirer, soil_poller, config, event_logger, &plant,
+                    &burst_capture);
+#else
+    soil_task_start(soil_acquirer, soil_poller, config, event_logger, &plant);
 #endif
 
+    // Per-pump hourly/daily runtime and starts: the SystemObserver polls
+    // it from the 10 Hz loop; each stop appends one `pump_<name>` record.
+    static PumpUsage pump_usage(storage, wall_clock);
+    pump_usage.addPump("plant", plant);
+#if BOARD_HAS_RESERVOIR_PUMP
+    pump_usage.addPump("reservoir", reservoir);
+#endif
+    for (std::size_t i = 1; i < kBoardZoneCount; ++i) {
+        pump_usage.addPump(kBoardZones[i].name, *zone_pump[i - 1]);
+    }
+
     // /api/v1/ HTTP server (feature 009 US1). Constructed here — after EVERY
     // sensor plus the config/storage/clock it reports exist — and only in
     // station mode (wifi_manager is nullptr in provisioning/headless mode, so no
@@ -704,7 +1530,9 @@ extern "C" void app_main(void)
     // SystemObserver on the first Connected transition (below), mirroring the
     // SNTP lifecycle — it is NOT watchdog-subscribed and shares no mutex with
     // watering beyond the Locked* wrappers (FR-015). pumps_force_off() already
-    // ran first (top of app_main); nothing here touches pump control.
+    // ran first (top of app_main); nothing here touches pump control. Each
+    // client address is held to CONFIG_WS_API_RATE_LIMIT_PER_S requests a
+    // second (bursts of CONFIG_WS_API_RATE_LIMIT_BURST) before start().
     api::ApiServer *api_server = nullptr;
     if (wifi_manager != nullptr) {
         static api::ApiServer api_server_inst(
@@ -720,8 +1548,127 @@ extern "C" void app_main(void)
 #endif
         );
         api_server = &api_server_inst;
+        api_server_inst.setAssets(asset_store);
+#if CONFIG_WS_API_RATE_LIMIT_PER_S > 0
+        api_server_inst.setRateLimit(
+            static_cast<uint32_t>(CONFIG_WS_API_RATE_LIMIT_PER_S),
+            static_cast<uint32_t>(CONFIG_WS_API_RATE_LIMIT_BURST));
+#endif
+#if defined(CONFIG_WS_HTTPS)
+        // HTTPS with the certificate and key from the volume; without them
+        // the dashboard stays reachable over plain HTTP.
+        {
+            storage_wait_ready("HTTPS key pair", kStorageWaitMs);
+            const std::string dir = std::string(StorageMount::kBasePath) + "/tls/";
+            std::string cert;
+            std::string key;
+            if (read_volume_file((dir + "cert.pem").c_str(), cert) &&
+                read_volume_file((dir + "key.pem").c_str(), key)) {
+                api_server_inst.setTls(std::move(cert), std::move(key),
+                                       CONFIG_WS_HTTPS_MAX_SESSIONS);
+            } else {
+                ESP_LOGW(TAG, "no %scert.pem / key.pem: API on plain HTTP", dir.c_str());
+            }
+        }
+#endif
+        api_server_inst.setSoilProbes(soil_poller);
+        for (std::optional<LockedWaterPump>& pump : zone_pump) {
+            api_server_inst.addZonePump(*pump);
+        }
+        api_server_inst.setPumpUsage(pump_usage);
+        api_server_inst.setEventCounts(event_logger.counts());
+#if defined(CONFIG_WS_LOG_SINK)
+        api_server_inst.setLogTail(log_sink_tail());
+#endif
+        api_server_inst.setModbusBus(modbus_bus);
+#if CONFIG_WS_MODBUS_CLIENT_UART
+        api_server_inst.setModbusCapture(modbus_capture);
+#endif
+#if defined(CONFIG_WS_INA226_SAMPLING_TASK)
+        api_server_inst.setEnergyMeter(energy_meter);
+#endif
+#if defined(CONFIG_WS_INA226_CAPTURE)
+        api_server_inst.setPowerCapture(power_capture);
+#endif
+#if defined(CONFIG_WS_DECISION_TRACE)
+        api_server_inst.setDecisionTrace(decision_trace);
+#endif
+#if defined(CONFIG_WS_INPUT_RECORDER)
+        api_server_inst.setInputRecording(input_recorder(), input_recording_file());
+#endif
+#if defined(CONFIG_WS_TASK_TELEMETRY)
+        api_server_inst.setTaskTelemetry(task_telemetry);
+#endif
+#if defined(WS_LOCK_STATS)
+        api_server_inst.setLockRegistry(lockRegistry());
+#endif
+        api_server_inst.setBootProfile(boot_profile());
+        api_server_inst.setWatchdogFeeds(watchdog_feeds());
+        api_server_inst.setTickLatency(watering_task_latency());
+        api_server_inst.setLifetimeCounters(lifetime_counters());
+        if (IPowerLock* lock = power_lock(PowerLockKind::CpuMax)) {
+            api_server_inst.setPowerManagement(*lock, power_residency());
+        }
+        api_server_inst.setHttpdPlacement(task_plan::kHttpd.priority,
+                                          static_cast<int>(task_plan::kHttpd.core));
+        // After the setters: `bench json` may build bodies from here on.
+        diag_console_register_api(api_server_inst);
+
+        // Live push (/api/v1/stream): stored events are mirrored to the
+        // stream clients, and a low-priority task publishes sensor/pump
+        // deltas. Both are idle until a client connects. With the MQTT
+        // uplink the events also go to its next batch, and its task pushes
+        // the same DTOs to the broker.
+#if defined(CONFIG_WS_MQTT)
+        static EventTapPair event_taps(api_server_inst.liveStream(), mqtt_uplink);
+        event_logger.setTap(&event_taps);
+        api_server_inst.setMqttUplink(mqtt_uplink);
+        mqtt_task_start(mqtt_uplink, api_server_inst, *wifi_manager);
+#else
+        event_logger.setTap(&api_server_inst.liveStream());
+#endif
+        stream_task_start(api_server_inst);
+        // ESP-NOW: a leaf reports the same DTOs to its gateway; a gateway
+        // serves its leaves' reports through this server.
+#if defined(CONFIG_WS_ESPNOW_LEAF)
+        espnow_leaf_start(espnow_leaf, api_server_inst);
+#elif defined(CONFIG_WS_ESPNOW_GATEWAY)
+        api_server_inst.setNodeGateway(espnow_gateway);
+        espnow_gateway_start(espnow_gateway);
+#endif
+        // POST /api/v1/selftest runs on its own worker, so its bus reads
+        // never hold the httpd task.
+        selftest_task_start(api_server_inst);
+#if CONFIG_WS_API_EVENT_WAIT_MAX_S > 0
+        // GET /api/v1/events?wait=: the held tail reads are answered by a
+        // worker woken by each stored event.
+        event_wait_task_start(api_server_inst, event_logger.notifier(),
+                              CONFIG_WS_API_EVENT_WAIT_MAX_S);
+#endif
+#if defined(CONFIG_WS_OTA)
+        api_server_inst.setOtaPipeline(ota_pipeline(time_provider));
+#endif
+#if defined(CONFIG_WS_READ_AHEAD)
+        api_server_inst.setReadAhead(read_ahead_pipe());
+        read_ahead_task_start(read_ahead_pipe());
+#endif
+#if !defined(CONFIG_WS_DATA_STORAGE_RINGLOG)
+        // GET /backup and POST /restore: the store's files as one archive,
+        // each run with the storage held offline (writes queue meanwhile).
+        static StorageArchiveHold archive_hold(
+            locked_storage, data_storage,
+            static_cast<std::size_t>(CONFIG_WS_STORAGE_ARCHIVE_QUEUE));
+        api_server_inst.setStorageArchive(archive_hold, StorageMount::kBasePath);
+#endif
     }
 
+#if defined(CONFIG_WS_OTA)
+    // The OTA writer also confirms a freshly updated image after a minute,
+    // so it runs in every mode: an image that cannot reach the network
+    // still must not be rolled back once it has proven it boots.
+    ota_task_start(ota_pipeline(time_provider), event_logger);
+#endif
+
     // System observer (feature 008 US2 + feature 009 US1): edge-detects WiFi
     // state changes and pump start/stop and forwards them to the event log, and
     // starts SNTP + the API server on the first Connected transition.
@@ -729,7 +1676,9 @@ extern "C" void app_main(void)
     // stores only references/pointers and never touches pump control.
     // wifi_manager and api_server are nullptr in provisioning/headless mode (the
     // observer null-guards them); the pump set is capability-aware (rev2
-    // single-pump node passes no reservoir). Polled from the 10 Hz loop below.
+    // single-pump node passes no reservoir). Runs its own task, woken by
+    // WifiManager state changes and by the pump drivers, which the 10 Hz loop
+    // hands it once published below.
 #if BOARD_HAS_RESERVOIR_PUMP
     static SystemObserver observer(event_logger, wifi_manager, &sntp, api_server,
                                    &plant, &reservoir);
@@ -737,29 +1686,369 @@ extern "C" void app_main(void)
     static SystemObserver observer(event_logger, wifi_manager, &sntp, api_server,
                                    &plant);
 #endif
+    for (std::size_t i = 1; i < kBoardZoneCount; ++i) {
+        observer.addZonePump(*zone_pump[i - 1], kBoardZones[i].name);
+    }
+    observer.setPumpUsage(pump_usage);
+    observer.start();
+
+    // Every task is started by now, from static stacks and TCBs: report
+    // what they hold, fixed at link time. Then hand the observer to the
+    // 10 Hz loop (which sets it on the pump drivers) and log the boot phases so far (the first reading and the
+    // API come later and log their own line).
+    ESP_LOGI(TAG, "%lu static tasks: %lu bytes of stacks and TCBs reserved",
+             static_cast<unsigned long>(task_plan::reserved().tasks.load()),
+             static_cast<unsigned long>(task_plan::reserved().bytes.load()));
+    s_boot_result.pumpObserver = &observer;
+    s_boot_done.store(true, std::memory_order_release);
+    boot_mark(BootPhase::BootDone);
+    boot_profile_log();
+}
+
+/// One-shot task for boot_services(): @p arg is the SafetyCore.
+static void boot_task(void* arg)
+{
+    boot_services(*static_cast<const SafetyCore*>(arg));
+    vTaskDelete(nullptr);
+}
+
+extern "C" void app_main(void)
+{
+    // Fail-safe first: every pump that exists on this board off before
+    // anything else happens.
+    pumps_force_off();
+
+    const esp_app_desc_t *app_desc = esp_app_get_description();
+
+    ESP_LOGI(TAG, "==========================================");
+    ESP_LOGI(TAG, "WateringSystem");
+    ESP_LOGI(TAG, "Project:     %s", app_desc->project_name);
+    ESP_LOGI(TAG, "Version:     %s", app_desc->version);
+    ESP_LOGI(TAG, "Board:       %s", BOARD_NAME);
+    ESP_LOGI(TAG, "ESP-IDF:     %s", esp_get_idf_version());
+    ESP_LOGI(TAG, "==========================================");
+    ESP_LOGI(TAG, "Pumps forced OFF (fail-safe boot state)");
+
+#if WS_TRACE_LEVEL > 0
+    // System trace (interfaces/TraceBuffer.h): stamped from esp_timer into
+    // the ring of the calling task's core. Before any other task starts.
+    traceBuffer().install(&esp_timer_get_time,
+                          [] { return static_cast<int>(xPortGetCoreID()); });
+#endif
+#if defined(WS_LOCK_STATS)
+    // Decorator lock statistics (interfaces/LockStats.h): waits and holds
+    // timed by esp_timer. Before the first decorator is built.
+    InstrumentedMutex::installClock(&esp_timer_get_time);
+#endif
+#if defined(CONFIG_WS_DEEP_SLEEP_NODE)
+    // Battery node (sleep_node.h): one decision, then deep sleep again,
+    // unless the config button is held for the full firmware. Ahead of
+    // the log sink, so the last lines reach the UART before the sleep.
+    if (!config_button_held_at_boot()) {
+        sleep_node_run();
+    }
+#endif
+#if defined(CONFIG_WS_LOG_SINK)
+    // From here on ESP_LOG queues its lines and the log_sink task writes
+    // them out: no task below waits for the UART to log.
+    log_sink_start();
+#endif
+    // Frequency scaling and light sleep (power_mode.h): before boot_task
+    // wires the bus masters and the API server to its locks.
+    power_mode_start();
+    // Placement of the budgeted caches and rings (buffer_heap.h): before
+    // the first of them declares its budget.
+    buffer_heap_install();
+
+    // Pump driver instances — one per pump that exists on this board
+    // (BOARD_HAS_RESERVOIR_PUMP, feature 006). Function-local statics (NOT
+    // globals): they are constructed here, strictly after
+    // pumps_force_off(), so no constructor can run ahead of the boot
+    // fail-safe.
+    //
+    // Mutex-serializing wrappers: the pumps are touched by two tasks (this
+    // main loop's update() and the esp_console REPL task's commands), so
+    // EVERY access from here on goes through the wrappers — never through
+    // the GpioWaterPump objects directly.
+    static EspTimeProvider time_provider;
+    static GpioWaterPump plant_pump(
+        static_cast<gpio_num_t>(BOARD_PIN_MAIN_PUMP), "plant",
+        time_provider);
+    static LockedWaterPump plant(plant_pump);
+#if BOARD_HAS_RESERVOIR_PUMP
+    static GpioWaterPump reservoir_pump(
+        static_cast<gpio_num_t>(BOARD_PIN_RESERVOIR_PUMP), "reservoir",
+        time_provider);
+    static LockedWaterPump reservoir(reservoir_pump);
+#endif
+    // Further watering zones (board.h kBoardZones; zone 0 is `plant`):
+    // one gate each, wrapped like the plant pump.
+    static_assert(kBoardZoneCount <= WateringZones::kMaxZones,
+                  "board.h lists more zones than there are soil probe ids");
+    static std::array<std::optional<GpioWaterPump>, kBoardZoneCount - 1> zone_pump_raw;
+    static std::array<std::optional<LockedWaterPump>, kBoardZoneCount - 1> zone_pump;
+    for (std::size_t i = 1; i < kBoardZoneCount; ++i) {
+        zone_pump_raw[i - 1].emplace(static_cast<gpio_num_t>(kBoardZones[i].pumpPin),
+                                     kBoardZones[i].name, time_provider);
+        zone_pump[i - 1].emplace(*zone_pump_raw[i - 1]);
+    }
+#if defined(WS_LOCK_STATS)
+    lockRegistry().add("plant", plant.mutex());
+#if BOARD_HAS_RESERVOIR_PUMP
+    lockRegistry().add("reservoir", reservoir.mutex());
+#endif
+    for (std::size_t i = 1; i < kBoardZoneCount; ++i) {
+        lockRegistry().add(kBoardZones[i].name, zone_pump[i - 1]->mutex());
+    }
+#endif
+
+#if defined(CONFIG_WS_PUMP_DEADLINE_TIMER)
+    // One-shot stop at each run's end; the callback polls the pump through
+    // its wrapper, the 10 Hz update() below stays the backstop. The timers
+    // are attached to the raw drivers before the first run (nothing else
+    // touches them yet). A timer that fails to create leaves polling only.
+    static EspDeadlineTimer plant_deadline("plant_stop", pump_deadline_fired, &plant);
+    if (plant_deadline.initialize()) {
+        plant_pump.setDeadlineTimer(&plant_deadline);
+    }
+#if BOARD_HAS_RESERVOIR_PUMP
+    static EspDeadlineTimer reservoir_deadline("reservoir_stop", pump_deadline_fired,
+                                               &reservoir);
+    if (reservoir_deadline.initialize()) {
+        reservoir_pump.setDeadlineTimer(&reservoir_deadline);
+    }
+#endif
+    static std::array<std::optional<EspDeadlineTimer>, kBoardZoneCount - 1> zone_deadline;
+    for (std::size_t i = 1; i < kBoardZoneCount; ++i) {
+        zone_deadline[i - 1].emplace(kBoardZones[i].name, pump_deadline_fired,
+                                     &*zone_pump[i - 1]);
+        if (zone_deadline[i - 1]->initialize()) {
+            zone_pump_raw[i - 1]->setDeadlineTimer(&*zone_deadline[i - 1]);
+        }
+    }
+#endif
+
+#if defined(CONFIG_WS_FLOW_METER)
+    // Metered plant runs: the PCNT unit counts, the loop below folds the
+    // count into a flow rate. Attached before the first run; a unit that
+    // fails to start leaves the pump on timed runs only.
+    static PcntPulseCounter flow_pulses(CONFIG_WS_FLOW_METER_GPIO);
+    static FlowMeter flow_meter(flow_pulses, CONFIG_WS_FLOW_METER_PULSES_PER_LITRE);
+    const bool flow_metered = flow_pulses.initialize();
+    if (flow_metered) {
+        plant_pump.setFlowMeter(&flow_meter);
+    }
+#endif
+
+    // initialize() re-asserts OFF (glitch-free) before arming the drivers.
+    // Failure here is fatal: a pump whose output state is unknown must not
+    // be left powered (same policy as pumps_force_off above).
+    bool pumps_armed = plant.initialize();
+#if BOARD_HAS_RESERVOIR_PUMP
+    pumps_armed = pumps_armed && reservoir.initialize();
+#endif
+    for (std::optional<LockedWaterPump>& pump : zone_pump) {
+        pumps_armed = pumps_armed && pump->initialize();
+    }
+    if (!pumps_armed) {
+        ESP_LOGE(TAG, "FATAL: pump driver initialization failed");
+        abort();
+    }
+    boot_mark(BootPhase::Pumps);
+
+    // Reservoir level sensors (feature 006). Part of the safety core: set up
+    // here, before boot_task, so the 10 Hz loop debounces them from its
+    // first tick. A failed GPIO init is logged and the system keeps
+    // running — the affected mark is latched Faulted (markFaulted below),
+    // so it reports not-yet-valid forever instead of debouncing a floating
+    // pin into a "valid" reading, and PR-11's fail-safe treats invalid as
+    // "do not act". Function-local statics after pumps_force_off() (boot
+    // fail-safe rule). Split per research R1: GpioLevelSensor configures
+    // each pin (input + pull-up, no logic) and captures its edges;
+    // LevelSensorBank holds ALL policy — one DebouncedLevelSensor per mark,
+    // polarity (FW-5), debounce and settle gating (FW-3) from the board
+    // macros — and samples both pins in one GpioInputBank register read, so
+    // the marks are debounced at one instant under one lock and published
+    // as one word. Updated from this main loop at 10 Hz and read by the
+    // console REPL, the watering task and the API through its per-mark
+    // views, so EVERY access from here on goes through level_low /
+    // level_high or the bank.
+    static GpioLevelSensor level_low_input(BOARD_PIN_LEVEL_LOW);
+    static GpioLevelSensor level_high_input(BOARD_PIN_LEVEL_HIGH);
+    static GpioInputBank level_pins{BOARD_PIN_LEVEL_LOW, BOARD_PIN_LEVEL_HIGH};
+    static LevelSensorBank level_bank(level_pins, time_provider,
+                                      BOARD_LEVEL_ACTIVE_LOW != 0,
+                                      BOARD_LEVEL_DEBOUNCE_MS,
+                                      BOARD_LEVEL_SETTLE_MS);
+    LevelSensorBank::Mark& level_low = level_bank.mark(LevelMarkId::Low);
+    LevelSensorBank::Mark& level_high = level_bank.mark(LevelMarkId::High);
+#if defined(WS_LOCK_STATS)
+    lockRegistry().add("level-bank", level_bank.mutex());
+#endif
+
+    // Both inits run unconditionally (no short-circuit): a low-input
+    // failure must never skip the high-input init.
+    const bool level_low_ok = level_low_input.initialize();
+    const bool level_high_ok = level_high_input.initialize();
+
+    // FW-3: the sensor rail is on from power-up (rail *control* arrives in
+    // PR-14) — arm the settle gate once at boot. On rev1 the settle window
+    // is 0 ms, so this only re-affirms the construction-time gating.
+    level_bank.notifyPowerOn();
+
+    // A failed GPIO init leaves that pin unconfigured and floating: latch
+    // the mark Faulted so isValid() stays false — markFaulted() is on the
+    // bank by design (not ILevelSensor), so it is called here at the
+    // wiring site. Ordered AFTER the boot notifyPowerOn() above, which is
+    // the deliberate re-arm that clears a fault (recovery: PR-14 rail
+    // control or an operator power cycle).
+    if (!level_low_ok) {
+        level_bank.markFaulted(LevelMarkId::Low);
+        ESP_LOGE(TAG, "level LOW sensor GPIO init failed (pin %d) — sensor "
+                 "faulted, readings invalid until a power-on re-arm",
+                 BOARD_PIN_LEVEL_LOW);
+    }
+    if (!level_high_ok) {
+        level_bank.markFaulted(LevelMarkId::High);
+        ESP_LOGE(TAG, "level HIGH sensor GPIO init failed (pin %d) — sensor "
+                 "faulted, readings invalid until a power-on re-arm",
+                 BOARD_PIN_LEVEL_HIGH);
+    }
+#if defined(CONFIG_WS_LEVEL_EDGE_CAPTURE)
+    // Edge timestamps from the pin interrupts; a configured pin whose
+    // interrupt fails stays polled (logged by enableEdgeCapture()).
+    if (level_low_ok && level_low_input.enableEdgeCapture()) {
+        level_bank.setEdgeSource(LevelMarkId::Low, &level_low_input);
+    }
+    if (level_high_ok && level_high_input.enableEdgeCapture()) {
+        level_bank.setEdgeSource(LevelMarkId::High, &level_high_input);
+    }
+#endif
+    boot_mark(BootPhase::Levels);
+
+    // Task watchdog (feature 008 US3). Reconfigure the boot-time WDT to the
+    // Kconfig timeout with panic (reboot) on a non-serviced subscribed task.
+    // Placed here — before boot_task and the watering-critical tasks start
+    // and subscribe. The reset reason is RTC-latched, so boot_task still logs
+    // a prior TASK_WDT reset. Non-fatal on failure (logged inside): the
+    // watering path still runs, just unwatched.
+    watchdog_init();
+
+    // Deferred boot. Everything else — storage, Wi-Fi, the sensors, the
+    // controllers, the console, the API — comes up on boot_task while this
+    // task enters the 10 Hz loop at once, so the pump self-stop and the level
+    // debounce run within milliseconds of reset instead of after the slowest
+    // probe. Pumps cannot start before boot_task has built something that
+    // starts them. Inline (loop after it) if the task cannot be created.
+    static SafetyCore safety_core{time_provider, plant_pump, plant,
+#if BOARD_HAS_RESERVOIR_PUMP
+                                  reservoir,
+#endif
+                                  zone_pump, level_low, level_high};
+    if (task_plan_create<task_plan::kBoot>(boot_task, &safety_core) != pdPASS) {
+        ESP_LOGE(TAG, "failed to create the boot task; booting inline");
+        boot_services(safety_core);
+    }
 
     // Main loop: poll pump enforcement (every pump that exists on this
     // board) and the level sensors at 10 Hz. Pump update() applies the
-    // timed self-stop and the hard 300 s max-runtime cap; level update()
-    // samples the raw pins and advances the settle/debounce state
-    // machines (~3 samples per 300 ms window). observer.poll() then records
-    // any WiFi/pump transition — best-effort logging, never blocking watering.
+    // timed self-stop and the hard 300 s max-runtime cap; the bank's
+    // update() samples both level pins at once and advances the
+    // settle/debounce state machines (~3 samples per 300 ms window). Once boot_task is done, the
+    // loop installs the system observer on the pump drivers: a switch on or
+    // off wakes its task, which logs the transition — best-effort logging on
+    // another task, never blocking watering.
     //
     // This main loop is a watering-critical task: subscribe it to the task WDT
     // (feature 008 US3) once here, then feed it every iteration. A stall in the
     // pump/level enforcement path therefore forces a panic reboot (pumps OFF at
     // the next boot, reset reason logged as TASK_WDT). The 100 ms cadence is far
     // under the 20 s default timeout.
+    //
+    // Any change of a pump's running state or a mark's reading wakes the
+    // watering task (watering_task_notify()), so a self-stop or a level edge
+    // is decided on without waiting for the next soil sample.
+    //
+    // Placement (task_plan.h): the loop runs on the control core at a
+    // priority above every other control task but the over-current trip, so
+    // an HTTP burst or a sensor read never pushes a pump's self-stop back.
+    // The core is the IDF main-task affinity; it is only checked here.
+    vTaskPrioritySet(nullptr, task_plan::kMainLoop.priority);
+    if (task_plan::kMainLoop.core != tskNO_AFFINITY &&
+        xPortGetCoreID() != task_plan::kMainLoop.core) {
+        ESP_LOGW(TAG, "main loop on core %d, planned for core %d "
+                 "(CONFIG_ESP_MAIN_TASK_AFFINITY)", xPortGetCoreID(),
+                 static_cast<int>(task_plan::kMainLoop.core));
+    }
     watchdog_subscribe_current_task();
+    boot_mark(BootPhase::SafetyLoop);
+    bool booted = false;
+    uint32_t last_edges = 0;
+    // Awake while any pump runs (power_mode.h): its run is timed from this
+    // loop. Taken at the first tick that sees it running.
+    IPowerLock* const pump_awake_lock = power_lock(PowerLockKind::NoLightSleep);
+    bool pump_awake = false;
+    TickType_t last_wake = xTaskGetTickCount();
     while (true) {
+#if defined(CONFIG_WS_FLOW_METER)
+        if (flow_metered) {
+            flow_meter.update(time_provider.nowMs());  // before the pump's volume check
+        }
+#endif
         plant.update();
+        bool pumping = plant.isRunning();
 #if BOARD_HAS_RESERVOIR_PUMP
         reservoir.update();
+        pumping = pumping || reservoir.isRunning();
+#endif
+        for (std::optional<LockedWaterPump>& pump : zone_pump) {
+            pump->update();
+            pumping = pumping || pump->isRunning();
+        }
+        if (pump_awake_lock != nullptr && pumping != pump_awake) {
+            if (pumping) {
+                pump_awake_lock->acquire();
+            } else {
+                pump_awake_lock->release();
+            }
+            pump_awake = pumping;
+        }
+        level_bank.update();
+        if (!booted && s_boot_done.load(std::memory_order_acquire)) {
+            // Set here, on the task that updates the bank. The pump
+            // drivers take theirs atomically: other tasks already run them.
+            level_bank.setObserver(LevelMarkId::High,
+                                   s_boot_result.levelHighObserver);
+            plant_pump.setObserver(s_boot_result.pumpObserver);
+#if BOARD_HAS_RESERVOIR_PUMP
+            reservoir_pump.setObserver(s_boot_result.pumpObserver);
 #endif
-        level_low.update();
-        level_high.update();
-        observer.poll();
+            for (std::optional<GpioWaterPump>& pump : zone_pump_raw) {
+                pump->setObserver(s_boot_result.pumpObserver);
+            }
+            booted = true;
+        }
+        if (booted) {
+            const LevelBankState levels = level_bank.state();
+            uint32_t edges = (plant.isRunning() ? 1u : 0u) |
+                            (levels.valid(LevelMarkId::Low) ? 2u : 0u) |
+                            (levels.waterPresent(LevelMarkId::Low) ? 4u : 0u) |
+                            (levels.valid(LevelMarkId::High) ? 8u : 0u) |
+                            (levels.waterPresent(LevelMarkId::High) ? 16u : 0u);
+#if BOARD_HAS_RESERVOIR_PUMP
+            edges |= reservoir.isRunning() ? 32u : 0u;
+#endif
+            for (std::size_t i = 0; i < zone_pump.size(); ++i) {
+                edges |= zone_pump[i]->isRunning() ? 64u << i : 0u;
+            }
+            if (edges != last_edges) {
+                last_edges = edges;
+                watering_task_notify();
+            }
+        }
         watchdog_feed();
-        vTaskDelay(pdMS_TO_TICKS(100));
+        // Fixed 100 ms period (not 100 ms after the work), so the pump
+        // self-stop checks keep their cadence however long an iteration took.
+        vTaskDelayUntil(&last_wake, pdMS_TO_TICKS(100));
     }
 }
@@ -0,0 +1,51 @@
+// SPDX-FileCopyrightText: 2026 Cryptotomte
+// SPDX-License-Identifier: AGPL-3.0-or-later
+/**
+ * @file boot_profile.cpp
+ * @brief Boot-phase marks and their log table (see boot_profile.h).
+ */
+
+#include "boot_profile.h"
+
+#include <cstddef>
+#include <cstdint>
+
+#include "esp_log.h"
+#include "esp_timer.h"
+
+static const char *TAG = "boot";
+
+BootProfile& boot_profile()
+{
+    static BootProfile profile;
+    return profile;
+}
+
+bool boot_mark(BootPhase phase)
+{
+    return boot_profile().mark(phase, esp_timer_get_time());
+}
+
+void boot_profile_log()
+{
+    const BootProfile& profile = boot_profile();
+    ESP_LOGI(TAG, "%-13s %9s %9s", "phase", "at ms", "step ms");
+    uint32_t previousUs = 0;
+    for (std::size_t i = 0; i < kBootPhaseCount; ++i) {
+        const BootPhase phase = static_cast<BootPhase>(i);
+        const uint32_t atUs = profile.atUs(phase);
+        if (atUs == 0) {
+            ESP_LOGI(TAG, "%-13s %9s %9s", bootPhaseName(phase), "-", "-");
+            continue;
+        }
+        // Phases on different tasks can complete out of order: a negative
+        // step shows as 0.
+        const uint32_t stepUs = atUs > previousUs ? atUs - previousUs : 0;
+        ESP_LOGI(TAG, "%-13s %5lu.%03lu %5lu.%03lu", bootPhaseName(phase),
+                 static_cast<unsigned long>(atUs / 1000),
+                 static_cast<unsigned long>(atUs % 1000),
+                 static_cast<unsigned long>(stepUs / 1000),
+                 static_cast<unsigned long>(stepUs % 1000));
+        previousUs = atUs;
+    }
+}
@@ -0,0 +1,33 @@
+// SPDX-FileCopyrightText: 2026 Cryptotomte
+// SPDX-License-Identifier: AGPL-3.0-or-later
+/**
+ * @file boot_profile.h
+ * @brief The firmware's boot-phase marks (app wiring).
+ *
+ * One BootProfile (interfaces/BootProfile.h) for the whole firmware, stamped
+ * with esp_timer_get_time() — microseconds since reset — by app_main, the
+ * boot task, the soil task and the system observer. The boot task logs the
+ * table once every task is up; the two phases that come later (first valid
+ * reading, API up) log their own line. The API server reads the same
+ * instance for GET /api/v1/status.
+ */
+
+#ifndef WATERINGSYSTEM_MAIN_BOOT_PROFILE_H
+#define WATERINGSYSTEM_MAIN_BOOT_PROFILE_H
+
+#include "interfaces/BootProfile.h"
+
+/// The firmware's profile: a function-local static, zero until marked.
+BootProfile& boot_profile();
+
+/**
+ * @brief Mark @p phase as reached now.
+ * @return true for the first mark of @p phase
+ */
+bool boot_mark(BootPhase phase);
+
+/// Log every phase as one table: ms after reset and the step from the
+/// previous phase reached; phases not reached yet show as "-".
+void boot_profile_log();
+
+#endif /* WATERINGSYSTEM_MAIN_BOOT_PROFILE_H */
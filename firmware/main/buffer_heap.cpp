@@ -0,0 +1,52 @@
+// SPDX-FileCopyrightText: 2026 Cryptotomte
+// SPDX-License-Identifier: AGPL-3.0-or-later
+/**
+ * @file buffer_heap.cpp
+ * @brief heap_caps placement for the budgeted buffers.
+ */
+
+#include "buffer_heap.h"
+
+#include "esp_heap_caps.h"
+#include "esp_log.h"
+#include "esp_memory_utils.h"
+
+#include "interfaces/BufferBudget.h"
+
+static const char *TAG = "buffer_heap";
+
+namespace {
+
+class EspBufferHeap final : public IBufferHeap {
+public:
+    EspBufferHeap() : psram_(heap_caps_get_total_size(MALLOC_CAP_SPIRAM) > 0) {}
+
+    bool hasPsram() const override { return psram_; }
+
+    void* allocate(std::size_t bytes, BufferPlacement placement) override
+    {
+        const uint32_t caps = placement == BufferPlacement::Psram
+                                  ? MALLOC_CAP_SPIRAM | MALLOC_CAP_8BIT
+                                  : MALLOC_CAP_INTERNAL | MALLOC_CAP_8BIT;
+        return heap_caps_malloc(bytes, caps);
+    }
+
+    BufferPlacement placementOf(const void* p) const override
+    {
+        return esp_ptr_external_ram(p) ? BufferPlacement::Psram : BufferPlacement::Internal;
+    }
+
+    void release(void* p) override { heap_caps_free(p); }
+
+private:
+    const bool psram_;
+};
+
+}  // namespace
+
+void buffer_heap_install()
+{
+    static EspBufferHeap heap;
+    bufferBudgets().setHeap(&heap);
+    ESP_LOGI(TAG, "large buffers: %s", heap.hasPsram() ? "PSRAM first" : "internal RAM only");
+}
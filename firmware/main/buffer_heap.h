@@ -0,0 +1,28 @@
+// SPDX-FileCopyrightText: 2026 Cryptotomte
+// SPDX-License-Identifier: AGPL-3.0-or-later
+/**
+ * @file buffer_heap.h
+ * @brief The heap_caps-backed IBufferHeap behind bufferBudgets() (app
+ *        wiring).
+ *
+ * buffer_heap_install() hands interfaces/BufferBudget.h a heap that places
+ * the budgeted caches and rings with heap_caps_malloc(): MALLOC_CAP_SPIRAM
+ * when the board has PSRAM mapped into the heap, MALLOC_CAP_INTERNAL
+ * otherwise and as the fallback. The supported boards have none, so today
+ * every pool gets its internal budget; a PSRAM module (CONFIG_SPIRAM with
+ * CONFIG_SPIRAM_USE_CAPS_ALLOC or _USE_MALLOC) turns on the larger ones
+ * with no other change.
+ */
+
+#ifndef WATERINGSYSTEM_MAIN_BUFFER_HEAP_H
+#define WATERINGSYSTEM_MAIN_BUFFER_HEAP_H
+
+/**
+ * @brief Install the heap in bufferBudgets().
+ *
+ * Call once, early in app_main, before anything declares a budget (the
+ * storage decorators, the asset store, the API server, the recorder).
+ */
+void buffer_heap_install();
+
+#endif /* WATERINGSYSTEM_MAIN_BUFFER_HEAP_H */
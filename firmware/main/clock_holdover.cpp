@@ -0,0 +1,239 @@
+// SPDX-FileCopyrightText: 2026 Cryptotomte
+// SPDX-License-Identifier: AGPL-3.0-or-later
+/**
+ * @file clock_holdover.cpp
+ * @brief RTC_NOINIT anchors, DS3231 upkeep and the sealing task of the
+ *        wall-clock holdover (see clock_holdover.h).
+ *
+ * The two anchor blocks are written alternately, as the lifetime counters'
+ * are, so a reset mid-seal leaves the other intact. The wall clock and the
+ * RTC timer are read back to back for each seal; the RTC timer survives
+ * every reset but a power cycle, and fromRetained() refuses an anchor it
+ * cannot advance. When the DS3231 was last set (UTC epoch) lives in NVS
+ * (`ws_time/ds_set`); it is rewritten only when the chip was set or when
+ * a sync found it within a second and the record is a day old, so NVS
+ * sees about one write a day.
+ */
+
+#include "clock_holdover.h"
+
+#include <sys/time.h>
+
+#include <cstdint>
+#include <ctime>
+
+#include "esp_attr.h"
+#include "esp_log.h"
+#include "esp_rtc_time.h"
+#include "esp_system.h"
+#include "esp_timer.h"
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+#include "nvs.h"
+
+#include "time/Ds3231Rtc.h"
+#include "time/TimeService.h"
+
+#include "sdkconfig.h"
+#include "task_plan.h"
+
+#if defined(CONFIG_WS_CLOCK_HOLDOVER)
+
+static const char *TAG = "clock";
+
+namespace {
+
+constexpr uint32_t kTickMs = 1000;
+constexpr uint32_t kSealEveryTicks = 10;
+
+RTC_NOINIT_ATTR ClockAnchorBlock s_rtc[2];
+
+II2cBus* s_i2c = nullptr;
+const SntpClient* s_sntp = nullptr;
+bool s_started = false;
+
+ClockHoldover& holdover()
+{
+    static ClockHoldover instance;
+    return instance;
+}
+
+uint32_t mono_ms()
+{
+    return static_cast<uint32_t>(esp_timer_get_time() / 1000);
+}
+
+uint64_t wall_us()
+{
+    struct timeval tv = {};
+    gettimeofday(&tv, nullptr);
+    return static_cast<uint64_t>(tv.tv_sec) * 1000000ull + static_cast<uint64_t>(tv.tv_usec);
+}
+
+/// Seal into the older RTC block.
+void seal()
+{
+    ClockHoldover& h = holdover();
+    ClockAnchorBlock& block = s_rtc[(h.sequence() + 1) & 1u];
+    (void)h.seal(wall_us(), esp_rtc_get_time_us(), mono_ms(), block);
+}
+
+void flush_on_shutdown()
+{
+    seal();
+}
+
+#if defined(CONFIG_WS_RTC_DS3231)
+
+constexpr uint32_t kDsRecordRefreshS = 86400;
+constexpr const char* kNamespace = "ws_time";
+constexpr const char* kKeyDsSet = "ds_set";
+
+uint32_t read_ds_set()
+{
+    nvs_handle_t handle = 0;
+    uint32_t value = 0;
+    if (nvs_open(kNamespace, NVS_READONLY, &handle) == ESP_OK) {
+        (void)nvs_get_u32(handle, kKeyDsSet, &value);
+        nvs_close(handle);
+    }
+    return value;
+}
+
+void write_ds_set(uint32_t epoch)
+{
+    nvs_handle_t handle = 0;
+    esp_err_t err = nvs_open(kNamespace, NVS_READWRITE, &handle);
+    if (err == ESP_OK) {
+        err = nvs_set_u32(handle, kKeyDsSet, epoch);
+        if (err == ESP_OK) {
+            err = nvs_commit(handle);
+        }
+        nvs_close(handle);
+    }
+    if (err != ESP_OK) {
+        ESP_LOGW(TAG, "DS3231 set time not recorded: %s", esp_err_to_name(err));
+    }
+}
+
+/// After an SNTP sync: set the DS3231 when it is off, refresh the record.
+void update_ds3231()
+{
+    if (s_i2c == nullptr) {
+        return;
+    }
+    Ds3231Rtc rtc(*s_i2c);
+    const uint32_t now = static_cast<uint32_t>(time(nullptr));
+    uint32_t chip = 0;
+    const bool readOk = rtc.read(chip);
+    const uint32_t offBy = chip > now ? chip - now : now - chip;
+    if (readOk && offBy == 0) {
+        if (now - read_ds_set() >= kDsRecordRefreshS) {
+            write_ds_set(now);
+        }
+        return;
+    }
+    if (!rtc.write(now)) {
+        ESP_LOGW(TAG, "DS3231 not set");
+        return;
+    }
+    write_ds_set(now);
+    ESP_LOGI(TAG, "DS3231 set (was %s by %lu s)", readOk ? "off" : "lost",
+             static_cast<unsigned long>(readOk ? offBy : 0));
+}
+
+#endif  // CONFIG_WS_RTC_DS3231
+
+[[noreturn]] void holdover_task(void* arg)
+{
+    (void)arg;
+    TickType_t lastWake = xTaskGetTickCount();
+    uint32_t lastSync = 0;
+    uint32_t ticks = 0;
+    while (true) {
+        vTaskDelayUntil(&lastWake, pdMS_TO_TICKS(kTickMs));
+        const uint32_t sync = s_sntp->status().lastSyncEpoch;
+        if (sync != lastSync) {
+            lastSync = sync;
+            holdover().synced(mono_ms());
+            seal();
+            ticks = 0;
+#if defined(CONFIG_WS_RTC_DS3231)
+            update_ds3231();
+#endif
+            continue;
+        }
+        if (++ticks >= kSealEveryTicks) {
+            ticks = 0;
+            seal();
+        }
+    }
+}
+
+}  // namespace
+
+void clock_holdover_restore(II2cBus* i2c)
+{
+    s_i2c = i2c;
+    ClockHoldover& h = holdover();
+    ClockEstimate retained;
+    const bool haveRetained = h.fromRetained({&s_rtc[0], &s_rtc[1]}, esp_rtc_get_time_us(),
+                                             retained);
+    ClockEstimate external;
+    bool haveExternal = false;
+#if defined(CONFIG_WS_RTC_DS3231)
+    if (i2c != nullptr) {
+        Ds3231Rtc rtc(*i2c);
+        uint32_t epoch = 0;
+        haveExternal = rtc.read(epoch) &&
+                       ClockHoldover::fromDs3231(epoch, read_ds_set(), external);
+    }
+#endif
+    const ClockEstimate* used = h.restore({haveRetained ? &retained : nullptr,
+                                           haveExternal ? &external : nullptr},
+                                          mono_ms());
+    if (used == nullptr) {
+        ESP_LOGI(TAG, "no holdover source; waiting for SNTP");
+        return;
+    }
+    // IDF may have carried the system clock through the reset itself; a
+    // clock already set is not stepped, only marked as unconfirmed.
+    if (!TimeService::isPlausibleEpoch(static_cast<uint32_t>(time(nullptr)))) {
+        struct timeval tv = {};
+        tv.tv_sec = static_cast<time_t>(used->wallUs / 1000000ull);
+        tv.tv_usec = static_cast<suseconds_t>(used->wallUs % 1000000ull);
+        settimeofday(&tv, nullptr);
+    }
+    ESP_LOGI(TAG, "holdover from %s, error ~%lu ms", clockSourceName(used->source),
+             static_cast<unsigned long>(used->errorMs));
+    seal();
+}
+
+void clock_holdover_start(const SntpClient& sntp)
+{
+    if (s_started) {
+        return;
+    }
+    s_started = true;
+    s_sntp = &sntp;
+    if (task_plan_create<task_plan::kClockHoldover>(holdover_task, nullptr) != pdPASS) {
+        ESP_LOGE(TAG, "failed to create clock holdover task");
+        return;
+    }
+    const esp_err_t err = esp_register_shutdown_handler(&flush_on_shutdown);
+    if (err != ESP_OK) {
+        ESP_LOGW(TAG, "shutdown seal not registered: %s", esp_err_to_name(err));
+    }
+}
+
+#endif  // CONFIG_WS_CLOCK_HOLDOVER
+
+const ClockHoldover& clock_holdover()
+{
+#if defined(CONFIG_WS_CLOCK_HOLDOVER)
+    return holdover();
+#else
+    static const ClockHoldover none;
+    return none;
+#endif
+}
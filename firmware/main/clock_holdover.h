@@ -0,0 +1,48 @@
+// SPDX-FileCopyrightText: 2026 Cryptotomte
+// SPDX-License-Identifier: AGPL-3.0-or-later
+/**
+ * @file clock_holdover.h
+ * @brief Wall clock across resets: the RTC_NOINIT anchor, the optional
+ *        DS3231 and the task that keeps both current (app wiring,
+ *        CONFIG_WS_CLOCK_HOLDOVER).
+ *
+ * Owns the two RTC_NOINIT anchor blocks behind the pure ClockHoldover
+ * (time/ClockHoldover.h). At boot the better of the anchor and the DS3231
+ * (CONFIG_WS_RTC_DS3231) steps the system clock, so SystemWallClock reads
+ * as set and the data log starts at once; the clock is then in holdover
+ * until SNTP syncs. A low-priority task seals the anchor every 10 s and
+ * from an esp_restart() shutdown handler, notices SNTP syncs, and after
+ * one rewrites a DS3231 that is off by a second or more.
+ */
+
+#ifndef WATERINGSYSTEM_MAIN_CLOCK_HOLDOVER_H
+#define WATERINGSYSTEM_MAIN_CLOCK_HOLDOVER_H
+
+#include "interfaces/II2cBus.h"
+#include "time/ClockHoldover.h"
+#include "time/SntpClient.h"
+
+/**
+ * @brief Pick the boot estimate and step the system clock to it.
+ *
+ * Boot wiring, once, after nvs_flash_init() and before anything stamps an
+ * event. @p i2c is the sensor bus the DS3231 sits on (used only with
+ * CONFIG_WS_RTC_DS3231; may be null otherwise). A system clock that is
+ * already set (kept by IDF through the reset) is not stepped, only marked
+ * holdover.
+ */
+void clock_holdover_restore(II2cBus* i2c);
+
+/**
+ * @brief Start the sealing task, watching @p sntp for syncs.
+ *
+ * Once; @p sntp (and the bus given to clock_holdover_restore()) must
+ * outlive the task. A task creation failure is logged; the boot estimate
+ * then stays in place but is never sealed or confirmed.
+ */
+void clock_holdover_start(const SntpClient& sntp);
+
+/// The firmware's one ClockHoldover (a function-local static).
+const ClockHoldover& clock_holdover();
+
+#endif /* WATERINGSYSTEM_MAIN_CLOCK_HOLDOVER_H */
@@ -22,15 +22,21 @@
  *
  *   config get                          # all items; credentials shown
  *                                       # only as (un)configured (FR-004)
- *   config set <item> <value>           # item = NVS key (data-model.md)
+ *   config set <item> <value> [...]     # item = NVS key (data-model.md);
+ *                                       # all pairs in one commit
  *   config wifi <ssid> <password>       # values never echoed (FR-004)
  *   config wifi-clear
+ *   config ip <addr> <mask> [gw] [dns]  # station static IP, next Wi-Fi start
+ *   config ip dhcp
+ *   config httpd <single|multi|collector|default>  # sizing, next start
+ *   config httpd <sockets> <backlog> <stack> <recv_s> <send_s> <lru 0|1>
  *   config factory-reset
- *   storage stats
+ *   storage stats                       # usage, write, lock + queue counters
  *   storage log <metric> <value>        # reading at the current epoch
  *   storage query <metric> [t0 t1]      # count + newest records in range
  *   storage event <category> <detail>   # category = u8 (1..255)
  *   storage events [n]                  # newest-first, default 10
+ *   storage flush                       # commit group-commit history now
  *
  * Soil sensor commands (HIL verification path for feature 004; console
  * contract in specs/004-modbus-soil-sensor/contracts/interfaces.md — the
@@ -39,6 +45,12 @@
  *
  *   soil                                # one read(); 7 values or error
  *   rs485test                           # raw 1-register probe + statistics
+ *   rs485test stats                     # bus queue wait vs transfer time,
+ *                                       #   per-slave latency and errors,
+ *                                       #   soil probe airtime budget
+ *   rs485test baud [<rate>]             # line rate in use + stored; with a
+ *                                       #   rate, move every probe and the
+ *                                       #   master there and store it
  *   soil_cal_moisture <reference>       # calibrate against a reference
  *   soil_cal_ph <reference>             #   value; a failed calibration-
  *   soil_cal_ec <reference>             #   register write is NON-FATAL
@@ -63,6 +75,53 @@
  *
  *   power                               # one read(); V/I/P or ERROR <code>
  *
+ * Watering decision trace (CONFIG_WS_DECISION_TRACE; formatted here, never
+ * on the watering task — the ring holds binary records):
+ *
+ *   trace [n]                           # newest n decisions, default 10
+ *
+ * System trace (CONFIG_WS_TRACE_LEVEL > 0; interfaces/TraceBuffer.h, one
+ * binary ring per core, decoded here):
+ *
+ *   trace sys [n]                       # newest n records per core, default 10
+ *
+ * Task telemetry (CONFIG_WS_TASK_TELEMETRY; the sampler's last snapshot):
+ *
+ *   top                                 # per-task CPU %, stack free; heaps
+ *
+ * With CONFIG_WS_LOCK_STATS `top` also lists each Locked* decorator's mutex:
+ * acquisitions, contended ones, mean and longest wait, longest hold.
+ *
+ * Lifetime counters (main/lifetime_counters; totals across resets):
+ *
+ *   counters                            # boots, reset causes, pump run time, drops
+ *
+ * MQTT uplink (CONFIG_WS_MQTT; main/mqtt_task, api/MqttUplink.h):
+ *
+ *   mqtt                                # session, replay, window, watermark, counters
+ *
+ * ESP-NOW multi-node link (CONFIG_WS_ESPNOW_*; main/espnow_task,
+ * api/NodeLeaf.h, api/NodeGateway.h):
+ *
+ *   espnow                              # station MAC, role, link counters, leaves
+ *
+ * On-target benchmarks (esp_timer; min/mean/p99/max µs per case, `runs`
+ * default 50; history fills `chunks` 8 KiB chunks, default 4, at most the
+ * ring's 10). The storage suites run on a scratch store under
+ * /storage/bench, deleted afterwards; json times the registered API
+ * server's body builders (station mode only):
+ *
+ *   bench storage [runs]                # one fsync'd history append per run
+ *   bench history [runs] [chunks]       # full-range query and streamed pass,
+ *                                       # one chunk's reduction (RAM, both kernels)
+ *   bench events [runs]                 # event append, newest-10 read
+ *   bench stop [runs]                   # stop-timer lateness, idle and
+ *                                       # inside fsync'd appends (task, ISR)
+ *   bench modbus [runs]                 # one-register RS485 round trip
+ *   bench sensors [runs]                # BME280 read (+ INA226 read)
+ *   bench json [runs]                   # each endpoint's body, uncached
+ *   bench all [runs] [chunks]
+ *
  * Handler exit codes follow the esp_console convention: 0 on OK, 1 on ERR.
  *
  * State is plain pointers/PODs set from app_main — no non-trivial static
@@ -71,18 +130,29 @@
 
 #include "diag_console.h"
 
+#include <algorithm>
+#include <atomic>
 #include <cmath>
 #include <ctime>
 #include <cstdint>
 #include <cstdio>
 #include <cstdlib>
 #include <cstring>
+#include <memory>
+#include <optional>
 #include <string>
 #include <vector>
 
+#include <dirent.h>
+#include <sys/stat.h>
+
+#include "esp_attr.h"
 #include "esp_console.h"
+#include "esp_mac.h"
+#include "esp_timer.h"
 
 #include "board/board.h"
+#include "interfaces/EventCodec.h"
 #include "interfaces/IConfigStore.h"
 #include "interfaces/IDataStorage.h"
 #include "interfaces/IEnvironmentalSensor.h"
@@ -92,10 +162,27 @@
 #include "interfaces/ISoilSensor.h"
 #include "interfaces/IWallClock.h"
 #include "interfaces/IWaterPump.h"
+#include "interfaces/LifetimeCounters.h"
+#include "interfaces/TraceBuffer.h"
+#include "api/ApiSerialize.h"
+#include "api/ApiStream.h"
+#include "api/HttpdPresets.h"
+#include "control/DecisionTrace.h"
+#include "network/StaticIpSettings.h"
 #include "network/WifiManager.h"
+#include "sensors/ModbusBaudNegotiator.h"
+#include "sensors/ModbusBusMaster.h"
+#include "sensors/ModbusFrameCapture.h"
+#include "sensors/SoilPollScheduler.h"
+#include "storage/LittleFsDataStorage.h"
+#include "storage/RecordReduce.h"
+#include "storage/StorageMount.h"
+#include "time/ClockHoldover.h"
 #include "time/SyncStatus.h"
 #include "time/TimeService.h"
 
+#include "task_plan.h"
+
 namespace {
 
 /// Console-side bookkeeping per pump (interface has no duration getter;
@@ -122,10 +209,10 @@ PumpSlot s_slots[] = {
 /// a rev2 operator is never offered a `reservoir` word that cannot exist).
 #if BOARD_HAS_RESERVOIR_PUMP
 constexpr char kPumpHelp[] =
-    "pump <plant|reservoir> <start <seconds>|stop|status> | pump status";
+    "pump <plant|reservoir> <start <seconds>|dose <ml>|stop|status> | pump status";
 #else
 constexpr char kPumpHelp[] =
-    "pump <plant> <start <seconds>|stop|status> | pump status";
+    "pump <plant> <start <seconds>|dose <ml>|stop|status> | pump status";
 #endif
 
 // Storage instances (set from app_main; expected to be the Locked*
@@ -138,13 +225,20 @@ IDataStorage *s_storage = nullptr;
 // to be the LockedSoilSensor decorator). Same trivial-initialization rule.
 ISoilSensor *s_soil = nullptr;
 IModbusClient *s_modbus = nullptr;
+const ModbusBusMaster *s_modbus_bus = nullptr;
+const SoilPollScheduler *s_soil_poller = nullptr;
+ModbusFrameCapture *s_modbus_capture = nullptr;
 
 // Environmental sensor (set from app_main; expected to be the
 // LockedEnvironmentalSensor decorator). Same trivial-initialization rule.
 IEnvironmentalSensor *s_env = nullptr;
 
-// Level sensors (set from app_main; expected to be the LockedLevelSensor
-// decorators — the handler runs on the REPL task, concurrently with the
+// Shared I2C bus master (set from app_main). Same trivial-initialization
+// rule.
+const I2cBusMaster *s_i2c_bus = nullptr;
+
+// Level sensors (set from app_main; expected to be the LevelSensorBank
+// marks — the handler runs on the REPL task, concurrently with the
 // main-loop update()). Same trivial-initialization rule.
 ILevelSensor *s_level_low = nullptr;
 ILevelSensor *s_level_high = nullptr;
@@ -166,6 +260,31 @@ WifiManager *s_wifi = nullptr;
 // trivial-initialization rule. The status is read-only (owned by SntpClient).
 IWallClock *s_clock = nullptr;
 const SyncStatus *s_sync = nullptr;
+const ClockHoldover *s_holdover = nullptr;
+
+// Watering decision trace (nullptr = not built in). Read-only here: the
+// watering task is its only writer. Same trivial-initialization rule.
+const DecisionTrace *s_trace = nullptr;
+
+// Task telemetry (nullptr = not built in). Read-only here: the telemetry
+// task is its only writer. Same trivial-initialization rule.
+const TaskTelemetry *s_telemetry = nullptr;
+
+// Decorator lock statistics (nullptr = not built in). Same rule.
+const LockRegistry *s_locks = nullptr;
+
+// Lifetime counters (nullptr = not registered). Read-only here: the
+// counters task is its only writer. Same rule.
+const LifetimeCounters *s_counters = nullptr;
+const api::MqttUplink *s_mqtt = nullptr;
+// ESP-NOW role (at most one registered). Same rule.
+const api::NodeLeaf *s_leaf = nullptr;
+const api::NodeGateway *s_gateway = nullptr;
+
+// API server for `bench json` (nullptr = provisioning mode, or not built
+// yet). Atomic: registered after diag_console_start(), read on the REPL
+// task. std::atomic<T*> is constant-initialized, so the rule still holds.
+std::atomic<api::ApiServer *> s_api{nullptr};
 
 const char *stop_reason_str(StopReason reason)
 {
@@ -176,6 +295,8 @@ const char *stop_reason_str(StopReason reason)
         return "duration_elapsed";
     case StopReason::MaxRuntimeForced:
         return "max_runtime_forced";
+    case StopReason::VolumeReached:
+        return "volume_reached";
     case StopReason::None:
     default:
         return "none";
@@ -193,6 +314,11 @@ void print_status(const PumpSlot &slot)
                stop_reason_str(slot.pump->getLastStopReason()),
                static_cast<double>(slot.pump->getAccumulatedRunTimeMs()) /
                    1000.0);
+        const PumpRunVolume volume = slot.pump->getLastRunVolume();
+        if (volume.metered) {
+            printf("%s: last run delivered %lu ml\n", slot.name,
+                   static_cast<unsigned long>(volume.volumeMl));
+        }
     }
 }
 
@@ -227,6 +353,29 @@ int cmd_start(PumpSlot &slot, const char *secondsArg)
     return 0;
 }
 
+/// Metered run: needs a flow meter on the pump (WS_FLOW_METER); the
+/// pump's 300 s hard cap still bounds it.
+int cmd_dose(PumpSlot &slot, const char *mlArg)
+{
+    char *end = nullptr;
+    const long ml = strtol(mlArg, &end, 10);
+    if (end == mlArg || *end != '\0' || ml < 1 || ml > 100000) {
+        printf("ERR volume must be 1..100000 ml\n");
+        return 1;
+    }
+    if (slot.pump->isRunning()) {
+        printf("ERR %s already running\n", slot.name);
+        return 1;
+    }
+    if (!slot.pump->runForVolume(static_cast<int>(ml), 300)) {
+        printf("ERR %s has no flow meter or failed to start\n", slot.name);
+        return 1;
+    }
+    slot.lastStartedDurationS = 300;
+    printf("OK %s running for %ld ml (at most 300 s)\n", slot.name, ml);
+    return 0;
+}
+
 int cmd_stop(PumpSlot &slot)
 {
     if (!slot.pump->isRunning()) {
@@ -269,6 +418,9 @@ int pump_cmd(int argc, char **argv)
     if (strcmp(argv[2], "start") == 0 && argc == 4) {
         return cmd_start(*slot, argv[3]);
     }
+    if (strcmp(argv[2], "dose") == 0 && argc == 4) {
+        return cmd_dose(*slot, argv[3]);
+    }
     if (strcmp(argv[2], "stop") == 0 && argc == 3) {
         return cmd_stop(*slot);
     }
@@ -320,62 +472,141 @@ void print_config(const IConfigStore &config)
     // Credential VALUES never appear in diagnostic output (FR-004).
     printf("wifi=%s\n",
            config.getWifiSsid().empty() ? "unconfigured" : "configured");
+    const StaticIpConfig ip = config.getStaticIp();
+    if (!ip.enabled()) {
+        printf("ip=dhcp\n");
+    } else {
+        printf("ip=%s mask=%s gw=%s dns=%s\n", formatIpv4(ip.address).c_str(),
+               formatIpv4(ip.netmask).c_str(), formatIpv4(ip.gateway).c_str(),
+               formatIpv4(ip.dns).c_str());
+    }
+    const HttpdSettings h = config.getHttpdSettings();
+    if (!h.enabled()) {
+        printf("httpd=default\n");
+    } else {
+        printf("httpd sockets=%u backlog=%u stack=%lu recv=%u s send=%u s lru=%d\n",
+               static_cast<unsigned>(h.maxOpenSockets), static_cast<unsigned>(h.backlog),
+               static_cast<unsigned long>(h.stackBytes),
+               static_cast<unsigned>(h.recvTimeoutS), static_cast<unsigned>(h.sendTimeoutS),
+               h.lruPurge ? 1 : 0);
+    }
 }
 
 int print_config_usage(void)
 {
-    printf("ERR usage: config <get|set <item> <value>|wifi <ssid> <password>"
-           "|wifi-clear|factory-reset>\n");
+    printf("ERR usage: config <get|set <item> <value> [...]|wifi <ssid> <password>"
+           "|wifi-clear|ip <addr> <mask> [gw] [dns]|ip dhcp"
+           "|httpd <single|multi|collector|default>"
+           "|httpd <sockets> <backlog> <stack> <recv_s> <send_s> <lru>|factory-reset>\n");
     return 1;
 }
 
-/// `config set <item> <value>`: items are the NVS keys (data-model.md);
-/// the store validates and persists — rejection means out-of-range input
-/// or a persistence failure.
-int cmd_config_set(IConfigStore &config, const char *item, const char *value)
+/// `config httpd <preset>|default` or the six fields of HttpdSettings;
+/// applied by ApiServer::start(), so at the next restart.
+int cmd_config_httpd(IConfigStore &config, int argc, char **argv)
+{
+    HttpdSettings h;
+    api::HttpdPreset preset = api::HttpdPreset::Single;
+    if (argc == 1 && api::parseHttpdPreset(argv[0], preset)) {
+        h = api::httpdPresetSettings(preset);
+    } else if (argc == 6) {
+        uint32_t v[6] = {};
+        for (int i = 0; i < 6; ++i) {
+            // Every field but the stack is 16-bit; the store checks ranges.
+            if (!parse_u32(argv[i], v[i]) || (i != 2 && v[i] > UINT16_MAX)) {
+                printf("ERR httpd: '%s' is not a number in range\n", argv[i]);
+                return 1;
+            }
+        }
+        h.maxOpenSockets = static_cast<uint16_t>(v[0]);
+        h.backlog = static_cast<uint16_t>(v[1]);
+        h.stackBytes = v[2];
+        h.recvTimeoutS = static_cast<uint16_t>(v[3]);
+        h.sendTimeoutS = static_cast<uint16_t>(v[4]);
+        h.lruPurge = v[5] != 0;
+    } else if (!(argc == 1 && strcmp(argv[0], "default") == 0)) {
+        return print_config_usage();
+    }
+    if (!config.setHttpdSettings(h)) {
+        printf("ERR httpd rejected (sockets 1..%u, backlog 1..%u, stack %u..%u, "
+               "timeouts 1..%u s, or storage failure)\n",
+               static_cast<unsigned>(IConfigStore::kHttpdSocketsMax),
+               static_cast<unsigned>(IConfigStore::kHttpdBacklogMax),
+               static_cast<unsigned>(IConfigStore::kHttpdStackMinBytes),
+               static_cast<unsigned>(IConfigStore::kHttpdStackMaxBytes),
+               static_cast<unsigned>(IConfigStore::kHttpdTimeoutMaxS));
+        return 1;
+    }
+    printf("OK httpd=%s, applied at the next restart\n", argc == 1 ? argv[0] : "custom");
+    return 0;
+}
+
+/// Parse one `<item> <value>` pair of `config set` into @p patch; items
+/// are the NVS keys (data-model.md). Prints the error and returns false on
+/// an unknown item or an unparsable value (ranges are the store's).
+bool parse_config_item(const char *item, const char *value, ConfigPatch &patch)
 {
-    bool ok = false;
     if (strcmp(item, "moist_low") == 0 || strcmp(item, "moist_high") == 0) {
         float parsed = 0.0f;
         if (!parse_float(value, parsed)) {
             printf("ERR %s: not a number\n", item);
-            return 1;
+            return false;
         }
-        ok = (strcmp(item, "moist_low") == 0)
-                 ? config.setMoistureThresholdLow(parsed)
-                 : config.setMoistureThresholdHigh(parsed);
-    } else if (strcmp(item, "water_en") == 0) {
+        (strcmp(item, "moist_low") == 0 ? patch.moistureThresholdLow
+                                       : patch.moistureThresholdHigh) = parsed;
+        return true;
+    }
+    if (strcmp(item, "water_en") == 0) {
         if (strcmp(value, "0") != 0 && strcmp(value, "1") != 0) {
             printf("ERR water_en: value must be 0 or 1\n");
-            return 1;
+            return false;
         }
-        ok = config.setWateringEnabled(strcmp(value, "1") == 0);
+        patch.wateringEnabled = strcmp(value, "1") == 0;
+        return true;
+    }
+    std::optional<uint32_t> *field = nullptr;
+    if (strcmp(item, "water_dur") == 0) {
+        field = &patch.wateringDurationS;
+    } else if (strcmp(item, "soak_pause") == 0) {
+        field = &patch.minWateringIntervalS;
+    } else if (strcmp(item, "read_iv") == 0) {
+        field = &patch.sensorReadIntervalMs;
+    } else if (strcmp(item, "log_iv") == 0) {
+        field = &patch.dataLogIntervalMs;
     } else {
-        uint32_t parsed = 0;
-        if (!parse_u32(value, parsed)) {
-            printf("ERR %s: not an unsigned integer\n", item);
-            return 1;
-        }
-        if (strcmp(item, "water_dur") == 0) {
-            ok = config.setWateringDurationS(parsed);
-        } else if (strcmp(item, "soak_pause") == 0) {
-            ok = config.setMinWateringIntervalS(parsed);
-        } else if (strcmp(item, "read_iv") == 0) {
-            ok = config.setSensorReadIntervalMs(parsed);
-        } else if (strcmp(item, "log_iv") == 0) {
-            ok = config.setDataLogIntervalMs(parsed);
-        } else {
-            printf("ERR unknown item '%s' (moist_low moist_high water_dur "
-                   "soak_pause water_en read_iv log_iv)\n",
-                   item);
+        printf("ERR unknown item '%s' (moist_low moist_high water_dur "
+               "soak_pause water_en read_iv log_iv)\n",
+               item);
+        return false;
+    }
+    uint32_t parsed = 0;
+    if (!parse_u32(value, parsed)) {
+        printf("ERR %s: not an unsigned integer\n", item);
+        return false;
+    }
+    *field = parsed;
+    return true;
+}
+
+/// `config set <item> <value> [<item> <value> ...]`: every pair is applied
+/// as ONE IConfigStore::apply() patch (one NVS commit), all or nothing —
+/// rejection means an out-of-range value or a persistence failure.
+int cmd_config_set(IConfigStore &config, int pairs, char **argv)
+{
+    ConfigPatch patch;
+    for (int i = 0; i < pairs; ++i) {
+        if (!parse_config_item(argv[2 * i], argv[2 * i + 1], patch)) {
             return 1;
         }
     }
-    if (!ok) {
-        printf("ERR %s rejected (out of range or storage failure)\n", item);
+    if (!config.apply(patch)) {
+        printf("ERR rejected, nothing applied (out of range or storage "
+               "failure)\n");
         return 1;
     }
-    printf("OK %s=%s\n", item, value);
+    for (int i = 0; i < pairs; ++i) {
+        printf("OK %s=%s\n", argv[2 * i], argv[2 * i + 1]);
+    }
     return 0;
 }
 
@@ -389,8 +620,8 @@ int config_cmd(int argc, char **argv)
         print_config(*s_config);
         return 0;
     }
-    if (argc == 4 && strcmp(argv[1], "set") == 0) {
-        return cmd_config_set(*s_config, argv[2], argv[3]);
+    if (argc >= 4 && argc % 2 == 0 && strcmp(argv[1], "set") == 0) {
+        return cmd_config_set(*s_config, (argc - 2) / 2, argv + 2);
     }
     if (argc == 4 && strcmp(argv[1], "wifi") == 0) {
         // Never echo the values back (FR-004).
@@ -410,6 +641,27 @@ int config_cmd(int argc, char **argv)
         printf("OK wifi credentials cleared\n");
         return 0;
     }
+    if (argc >= 3 && argc <= 6 && strcmp(argv[1], "ip") == 0) {
+        StaticIpConfig ip;
+        const bool dhcp = argc == 3 && strcmp(argv[2], "dhcp") == 0;
+        if (!dhcp && (argc < 4 || !parseStaticIp(argv[2], argv[3],
+                                                  argc > 4 ? argv[4] : "",
+                                                  argc > 5 ? argv[5] : "", ip))) {
+            printf("ERR invalid static IP (dotted quads, contiguous mask, "
+                   "gateway on the subnet)\n");
+            return 1;
+        }
+        if (!s_config->setStaticIp(ip)) {
+            printf("ERR static IP not stored (storage failure)\n");
+            return 1;
+        }
+        printf("OK ip=%s, applied at the next restart\n",
+               dhcp ? "dhcp" : formatIpv4(ip.address).c_str());
+        return 0;
+    }
+    if (argc >= 3 && strcmp(argv[1], "httpd") == 0) {
+        return cmd_config_httpd(*s_config, argc - 2, argv + 2);
+    }
     if (argc == 2 && strcmp(argv[1], "factory-reset") == 0) {
         if (!s_config->factoryReset()) {
             printf("ERR factory reset failed\n");
@@ -424,7 +676,7 @@ int config_cmd(int argc, char **argv)
 int print_storage_usage(void)
 {
     printf("ERR usage: storage <stats|log <metric> <value>|query <metric> "
-           "[t0 t1]|event <category> <detail>|events [n]>\n");
+           "[t0 t1]|event <category> <detail>|events [n]|flush>\n");
     return 1;
 }
 
@@ -443,6 +695,48 @@ int storage_cmd(int argc, char **argv)
                    stats.totalBytes != 0
                        ? (100ULL * stats.usedBytes) / stats.totalBytes
                        : 0));
+        // Write accounting since boot (flash-wear estimates).
+        const StorageWriteStats &w = stats.writes;
+        printf("appended=%llu B syncs=%lu created=%lu removed=%lu torn=%lu "
+               "rotations=%lu append=%llu us\n",
+               static_cast<unsigned long long>(w.bytesAppended),
+               static_cast<unsigned long>(w.syncs),
+               static_cast<unsigned long>(w.filesCreated),
+               static_cast<unsigned long>(w.filesRemoved),
+               static_cast<unsigned long>(w.tornRepairs),
+               static_cast<unsigned long>(w.rotations),
+               static_cast<unsigned long long>(w.appendUs));
+        // Lock contention: writes queued behind reads vs writes that waited.
+        const StorageLockStats &l = stats.locks;
+        printf("deferred=%lu deferred_failed=%lu writer_waits=%lu "
+               "(total=%llu us max=%lu us) reader_waits=%lu "
+               "mount_dropped=%lu\n",
+               static_cast<unsigned long>(l.deferredWrites),
+               static_cast<unsigned long>(l.deferredFailures),
+               static_cast<unsigned long>(l.writerWaits),
+               static_cast<unsigned long long>(l.writerWaitUs),
+               static_cast<unsigned long>(l.maxWriterWaitUs),
+               static_cast<unsigned long>(l.readerWaits),
+               static_cast<unsigned long>(l.offlineDropped));
+        // Storage writer queue (0 capacity = writes on the caller's task).
+        const StorageQueueStats &q = stats.queue;
+        printf("queue=%lu/%lu high=%lu applied=%lu failed=%lu dropped=%lu "
+               "coalesced=%lu\n",
+               static_cast<unsigned long>(q.depth),
+               static_cast<unsigned long>(q.capacity),
+               static_cast<unsigned long>(q.highWater),
+               static_cast<unsigned long>(q.applied),
+               static_cast<unsigned long>(q.failed),
+               static_cast<unsigned long>(q.dropped),
+               static_cast<unsigned long>(q.coalesced));
+        return 0;
+    }
+    if (argc == 2 && strcmp(argv[1], "flush") == 0) {
+        if (!s_storage->flush()) {
+            printf("ERR flush failed (buffered readings dropped)\n");
+            return 1;
+        }
+        printf("OK flushed\n");
         return 0;
     }
     if (argc == 4 && strcmp(argv[1], "log") == 0) {
@@ -468,16 +762,27 @@ int storage_cmd(int argc, char **argv)
             printf("ERR t0/t1: not unsigned integers\n");
             return 1;
         }
-        const std::vector<SensorReading> readings =
-            s_storage->getSensorReadings(argv[2], t0, t1);
-        printf("OK %u readings\n", static_cast<unsigned>(readings.size()));
-        // Bounded output: the newest 10 are enough for the HIL checks.
-        const std::size_t first =
-            readings.size() > 10 ? readings.size() - 10 : 0;
-        for (std::size_t i = first; i < readings.size(); ++i) {
+        // Bounded output: the newest 10 are enough for the HIL checks, so
+        // stream the window keeping only those (no copy of the whole range).
+        struct NewestTen final : IReadingVisitor {
+            uint32_t epochs[10] = {};
+            float values[10] = {};
+            std::size_t count = 0;
+            bool onReading(uint32_t epoch, float value) override
+            {
+                epochs[count % 10] = epoch;
+                values[count % 10] = value;
+                ++count;
+                return true;
+            }
+        } newest;
+        s_storage->forEachReading(argv[2], t0, t1, newest);
+        printf("OK %u readings\n", static_cast<unsigned>(newest.count));
+        const std::size_t first = newest.count > 10 ? newest.count - 10 : 0;
+        for (std::size_t i = first; i < newest.count; ++i) {
             printf("%lu %.3f\n",
-                   static_cast<unsigned long>(readings[i].epoch),
-                   static_cast<double>(readings[i].value));
+                   static_cast<unsigned long>(newest.epochs[i % 10]),
+                   static_cast<double>(newest.values[i % 10]));
         }
         return 0;
     }
@@ -519,7 +824,7 @@ int storage_cmd(int argc, char **argv)
             printf("%lu cat=%u %s\n",
                    static_cast<unsigned long>(event.epoch),
                    static_cast<unsigned>(event.category),
-                   event.detail.c_str());
+                   renderEventDetail(event.detail).c_str());
         }
         return 0;
     }
@@ -559,38 +864,230 @@ int soil_cmd(int argc, char **argv)
         printf("ERR soil sensor not available\n");
         return 1;
     }
-    if (!s_soil->read()) {
-        const int error = s_soil->getLastError();
-        printf("ERR read failed: error %d (%s)\n", error,
-               soil_error_str(error));
+    const bool ok = s_soil->read();
+    const SoilSnapshot snap = s_soil->snapshot();
+    if (!ok) {
+        printf("ERR read failed: error %d (%s)\n", snap.lastError,
+               soil_error_str(snap.lastError));
         return 1;
     }
     printf("OK moisture=%.1f %% temp=%.1f C ec=%.0f uS/cm ph=%.1f "
            "n=%.0f mg/kg p=%.0f mg/kg k=%.0f mg/kg\n",
-           static_cast<double>(s_soil->getMoisture()),
-           static_cast<double>(s_soil->getTemperature()),
-           static_cast<double>(s_soil->getEC()),
-           static_cast<double>(s_soil->getPH()),
-           static_cast<double>(s_soil->getNitrogen()),
-           static_cast<double>(s_soil->getPhosphorus()),
-           static_cast<double>(s_soil->getPotassium()));
+           static_cast<double>(snap.moisture),
+           static_cast<double>(snap.temperature),
+           static_cast<double>(snap.ec),
+           static_cast<double>(snap.ph),
+           static_cast<double>(snap.nitrogen),
+           static_cast<double>(snap.phosphorus),
+           static_cast<double>(snap.potassium));
+    return 0;
+}
+
+/// Latency quantile as printed: "<=N" ms, or ">max" for the +Inf bucket.
+void print_latency_quantile(const char *name, const ModbusLinkStats &link,
+                            uint32_t permille)
+{
+    const uint32_t us = modbusLatencyQuantileUs(link, permille);
+    if (us == UINT32_MAX) {
+        printf(" %s>%lu", name,
+               static_cast<unsigned long>(
+                   (kModbusLatencyBaseUs << (kModbusLatencyBuckets - 1)) / 1000));
+    } else {
+        printf(" %s<=%lu", name, static_cast<unsigned long>(us / 1000));
+    }
+}
+
+/// `rs485test stats`: per priority, transactions served and the time they
+/// queued for the bus apart from the time they held it; per slave and
+/// function, the outcome split and latency quantiles (a noisy cable shows
+/// frame errors at normal latency, a slow sensor high quantiles and then
+/// timeouts); with several soil probes, the poll rounds' airtime budget
+/// against the measured bus share.
+int rs485test_stats()
+{
+    if (s_modbus_bus == nullptr) {
+        printf("ERR bus statistics not available\n");
+        return 1;
+    }
+    const struct {
+        const char *name;
+        ModbusPriority priority;
+    } classes[] = {
+        {"control", ModbusPriority::Control},
+        {"diagnostic", ModbusPriority::Diagnostic},
+    };
+    printf("OK queued now=%u\n", static_cast<unsigned>(s_modbus_bus->depth()));
+    for (const auto &c : classes) {
+        const ModbusQueueStats s = s_modbus_bus->stats(c.priority);
+        const uint32_t n = s.transactions != 0 ? s.transactions : 1;
+        printf("  %-10s n=%lu wait avg=%lu max=%lu ms, bus avg=%lu max=%lu ms\n",
+               c.name, static_cast<unsigned long>(s.transactions),
+               static_cast<unsigned long>(s.queueUsTotal / n / 1000),
+               static_cast<unsigned long>(s.queueUsMax / 1000),
+               static_cast<unsigned long>(s.busUsTotal / n / 1000),
+               static_cast<unsigned long>(s.busUsMax / 1000));
+    }
+    const int64_t now_us = esp_timer_get_time();
+    printf("  bus busy %.2f%% since boot\n",
+           now_us > 0 ? static_cast<double>(s_modbus_bus->busTimeUs()) * 100.0 /
+                            static_cast<double>(now_us)
+                      : 0.0);
+    for (const ModbusLinkStats &link : s_modbus_bus->linkStats()) {
+        printf("  slave %3u fn 0x%02x n=%lu ok=%lu timeout=%lu frame=%lu exc=%lu "
+               "other=%lu ms:",
+               static_cast<unsigned>(link.address),
+               static_cast<unsigned>(link.function),
+               static_cast<unsigned long>(link.transfers()),
+               static_cast<unsigned long>(link.ok),
+               static_cast<unsigned long>(link.timeouts),
+               static_cast<unsigned long>(link.frameErrors),
+               static_cast<unsigned long>(link.exceptions),
+               static_cast<unsigned long>(link.otherErrors));
+        print_latency_quantile("p50", link, 500);
+        print_latency_quantile("p95", link, 950);
+        if (link.lastSuccessUs < 0) {
+            printf(", never ok\n");
+        } else {
+            printf(", last ok %llds ago\n",
+                   static_cast<long long>((now_us - link.lastSuccessUs) / 1000000));
+        }
+    }
+    if (s_modbus_bus->untrackedTransfers() != 0) {
+        printf("  untracked=%lu (link table full)\n",
+               static_cast<unsigned long>(s_modbus_bus->untrackedTransfers()));
+    }
+    if (s_soil_poller != nullptr && s_soil_poller->size() > 1) {
+        const SoilBusUsage u = s_soil_poller->usage();
+        printf("  soil poll probes=%lu period=%lu ms read=%.1f ms, budget=%.1f%% "
+               "measured=%.1f%%, polls=%lu failed=%lu missed=%lu\n",
+               static_cast<unsigned long>(u.probes),
+               static_cast<unsigned long>(u.periodMs),
+               static_cast<double>(u.readAirtimeUs) / 1000.0,
+               static_cast<double>(u.budgetPermille) / 10.0,
+               static_cast<double>(u.measuredPermille) / 10.0,
+               static_cast<unsigned long>(u.polls),
+               static_cast<unsigned long>(u.failures),
+               static_cast<unsigned long>(u.missed));
+    }
+    return 0;
+}
+
+/// `rs485test baud [<rate>]`: the line rate in use and the stored one.
+/// With a rate, changeSoilBusBaud() moves every configured soil probe and
+/// the master (verified, rolled back on failure), and the rate is stored
+/// for the next boot once it is in effect.
+int rs485test_baud(int argc, char **argv)
+{
+    if (s_modbus == nullptr || s_soil_poller == nullptr) {
+        printf("ERR modbus client not available\n");
+        return 1;
+    }
+    if (argc == 2) {
+        printf("OK baud %lu (stored %lu)\n",
+               static_cast<unsigned long>(s_modbus->baudRate()),
+               static_cast<unsigned long>(
+                   s_config != nullptr ? s_config->getModbusBaudRate() : 0));
+        return 0;
+    }
+    char *end = nullptr;
+    const unsigned long rate = strtoul(argv[2], &end, 10);
+    if (argc != 3 || end == argv[2] || *end != '\0' ||
+        !IConfigStore::isValidModbusBaudRate(static_cast<uint32_t>(rate))) {
+        printf("ERR usage: rs485test baud [2400|4800|9600|19200]\n");
+        return 1;
+    }
+    uint8_t addresses[SoilPollScheduler::kMaxProbes];
+    const std::size_t count = s_soil_poller->size();
+    for (std::size_t i = 0; i < count; ++i) {
+        addresses[i] = s_soil_poller->address(i);
+    }
+    const BaudChange result =
+        changeSoilBusBaud(*s_modbus, addresses, count, static_cast<uint32_t>(rate));
+    if (result != BaudChange::Changed && result != BaudChange::Unchanged) {
+        printf("ERR baud %lu: %s, bus at %lu\n", rate, baudChangeName(result),
+               static_cast<unsigned long>(s_modbus->baudRate()));
+        return 1;
+    }
+    if (s_config == nullptr || !s_config->setModbusBaudRate(static_cast<uint32_t>(rate))) {
+        printf("ERR baud %lu in effect but not stored (boot returns to %lu)\n", rate,
+               static_cast<unsigned long>(
+                   s_config != nullptr ? s_config->getModbusBaudRate() : 9600));
+        return 1;
+    }
+    printf("OK baud %lu (%s, %u probe%s)\n", rate, baudChangeName(result),
+           static_cast<unsigned>(count), count == 1 ? "" : "s");
+    return 0;
+}
+
+/// `rs485test capture [on|off]`: start or freeze the frame capture, then
+/// dump the ring oldest first, one frame a line: the time, the gap since
+/// the previous frame, direction, length, CRC and the bytes kept. A
+/// request's answer shows its latency in the gap; a gap below 3.5
+/// character times between an answer and the next request is a violation.
+int rs485test_capture(int argc, char **argv)
+{
+    if (s_modbus_capture == nullptr) {
+        printf("ERR frame capture not available (esp-modbus client)\n");
+        return 1;
+    }
+    if (argc == 3 && strcmp(argv[2], "on") == 0) {
+        s_modbus_capture->setEnabled(true);
+    } else if (argc == 3 && strcmp(argv[2], "off") == 0) {
+        s_modbus_capture->setEnabled(false);
+    } else if (argc != 2) {
+        printf("ERR usage: rs485test capture [on|off]\n");
+        return 1;
+    }
+    printf("OK capture %s, %lu frames since boot\n",
+           s_modbus_capture->enabled() ? "on" : "off (frozen)",
+           static_cast<unsigned long>(s_modbus_capture->written()));
+    ModbusFrame batch[8];
+    uint32_t after = 0;
+    uint32_t prevUs = 0;
+    bool first = true;
+    std::size_t n = 0;
+    while ((n = s_modbus_capture->read(batch, sizeof(batch) / sizeof(batch[0]),
+                                       after)) > 0) {
+        for (std::size_t i = 0; i < n; ++i) {
+            const ModbusFrame &f = batch[i];
+            printf("  #%lu %10lu us %+9ld %s %3u B %s",
+                   static_cast<unsigned long>(f.sequence),
+                   static_cast<unsigned long>(f.atUs),
+                   first ? 0L : static_cast<long>(f.atUs - prevUs),
+                   f.dir == ModbusFrameDir::Tx ? "tx" : "rx",
+                   static_cast<unsigned>(f.length),
+                   f.length == 0 ? "timeout" : (f.crcOk ? "crc-ok " : "crc-bad"));
+            for (std::size_t b = 0; b < f.stored(); ++b) {
+                printf(" %02x", static_cast<unsigned>(f.bytes[b]));
+            }
+            printf(f.stored() < f.length ? " ...\n" : "\n");
+            prevUs = f.atUs;
+            first = false;
+            after = f.sequence;
+        }
+    }
     return 0;
 }
 
 /// `rs485test`: one raw 1-register probe (slave 0x01, register 0x0000 —
 /// the parity availability probe) + cumulative transaction statistics.
 ///
-/// Cross-task race RESOLVED (PR-11): this drives the injected IModbusClient,
-/// which in app_main is a LockedModbusClient. PR-11's watering task issues
-/// periodic soil reads over the SAME wrapped client, so both this probe and
-/// the soil reader serialize on the one LockedModbusClient mutex — concurrent
-/// bus transactions can no longer overlap. The fix is purely the injected
-/// instance; the code below is unchanged.
+/// The injected client is the ModbusBusMaster's Diagnostic port: the probe
+/// is one queued transaction, run by the bus task after any soil read the
+/// soil task has queued, and never overlapping one on the wire.
 int rs485test_cmd(int argc, char **argv)
 {
-    (void)argv;
+    if (argc == 2 && strcmp(argv[1], "stats") == 0) {
+        return rs485test_stats();
+    }
+    if (argc >= 2 && strcmp(argv[1], "baud") == 0) {
+        return rs485test_baud(argc, argv);
+    }
+    if (argc >= 2 && strcmp(argv[1], "capture") == 0) {
+        return rs485test_capture(argc, argv);
+    }
     if (argc != 1) {
-        printf("ERR usage: rs485test\n");
+        printf("ERR usage: rs485test [stats|baud [<rate>]|capture [on|off]]\n");
         return 1;
     }
     if (s_modbus == nullptr) {
@@ -692,13 +1189,13 @@ int env_cmd(int argc, char **argv)
         printf("ERR environmental sensor not available\n");
         return 1;
     }
-    if (!s_env->read()) {
-        // read() and getLastError() are separate locked calls; a sensor-
-        // task poll interleaving between them can succeed and reset the
-        // error to 0 (benign cross-lock race) — hint accordingly. The
-        // LockedEnvironmentalSensor snapshot() helper now exists; migrating
-        // this console read to it is a future cleanup — TODO(PR-14).
-        const int error = s_env->getLastError();
+    const bool ok = s_env->read();
+    // read() and snapshot() are separate calls; a sensor-task poll
+    // interleaving between them can succeed and reset the error to 0
+    // (benign) — hint accordingly. The snapshot itself is one coherent copy.
+    const EnvSnapshot snap = s_env->snapshot();
+    if (!ok) {
+        const int error = snap.lastError;
         const char *hint = (error == 1)   ? "sensor not found"
                            : (error == 2) ? "read failed"
                            : (error == 0)
@@ -708,9 +1205,53 @@ int env_cmd(int argc, char **argv)
         return 1;
     }
     printf("OK temperature=%.1f C humidity=%.1f %%RH pressure=%.1f hPa\n",
-           static_cast<double>(s_env->getTemperature()),
-           static_cast<double>(s_env->getHumidity()),
-           static_cast<double>(s_env->getPressure()));
+           static_cast<double>(snap.temperature),
+           static_cast<double>(snap.humidity),
+           static_cast<double>(snap.pressure));
+    return 0;
+}
+
+// --- i2c command ----------------------------------------------------------
+
+/// `i2c`: the shared bus's clock and batches, and per device the
+/// transactions, errors, queue wait and bus time since boot — a device
+/// whose wait climbs while another's bus time does is being crowded out.
+int i2c_cmd(int argc, char **argv)
+{
+    (void)argv;
+    if (argc != 1) {
+        printf("ERR usage: i2c\n");
+        return 1;
+    }
+    if (s_i2c_bus == nullptr) {
+        printf("ERR bus statistics not available\n");
+        return 1;
+    }
+    const int64_t now_us = esp_timer_get_time();
+    printf("OK clock=%lu Hz queued now=%u batches=%lu busy %.2f%% since boot\n",
+           static_cast<unsigned long>(s_i2c_bus->clockSpeedHz()),
+           static_cast<unsigned>(s_i2c_bus->depth()),
+           static_cast<unsigned long>(s_i2c_bus->batches()),
+           now_us > 0 ? static_cast<double>(s_i2c_bus->busTimeUs()) * 100.0 /
+                            static_cast<double>(now_us)
+                      : 0.0);
+    for (const I2cDeviceStats &d : s_i2c_bus->deviceStats()) {
+        const uint32_t n = d.transactions != 0 ? d.transactions : 1;
+        printf("  0x%02x n=%lu err=%lu wait avg=%lu max=%lu us, bus avg=%lu "
+               "max=%lu us total=%llu ms\n",
+               static_cast<unsigned>(d.address),
+               static_cast<unsigned long>(d.transactions),
+               static_cast<unsigned long>(d.errors),
+               static_cast<unsigned long>(d.queueUsTotal / n),
+               static_cast<unsigned long>(d.queueUsMax),
+               static_cast<unsigned long>(d.busUsTotal / n),
+               static_cast<unsigned long>(d.busUsMax),
+               static_cast<unsigned long long>(d.busUsTotal / 1000));
+    }
+    if (s_i2c_bus->untrackedTransactions() != 0) {
+        printf("  untracked=%lu (device table full)\n",
+               static_cast<unsigned long>(s_i2c_bus->untrackedTransactions()));
+    }
     return 0;
 }
 
@@ -721,14 +1262,13 @@ int env_cmd(int argc, char **argv)
 /// sensor must not read as an empty or full reservoir).
 const char *level_state_str(ILevelSensor &sensor)
 {
-    // isValid() and isWaterPresent() are separate locked calls; a main-loop
-    // update() interleaving between them can only make a just-valid reading
-    // report not_yet_valid, or a reading that lost validity in the gap
-    // print "dry" — benign either way, because isWaterPresent() returns
-    // false whenever invalid (ILevelSensor contract): never a stale or
-    // phantom "water". One-poll diagnostic glitch only. The
-    // LockedLevelSensor snapshot() helper now exists; migrating this
-    // console read to it is deferred — TODO(PR-14).
+    // isValid() and isWaterPresent() are separate loads of the bank's
+    // published state; a main-loop update() interleaving between them can
+    // only make a just-valid reading report not_yet_valid, or a reading
+    // that lost validity in the gap print "dry" — benign either way,
+    // because isWaterPresent() returns false whenever invalid (ILevelSensor
+    // contract): never a stale or phantom "water". One-poll diagnostic
+    // glitch only.
     if (!sensor.isValid()) {
         return "not_yet_valid";
     }
@@ -774,14 +1314,13 @@ int power_cmd(int argc, char **argv)
         printf("ERR power sensor not available\n");
         return 1;
     }
-    if (!s_power->read()) {
-        // read() and getLastError() are separate locked calls; a
-        // concurrent read from another task could reset the error to 0
-        // between them (benign cross-lock race) — hint accordingly. No
-        // periodic power reader exists yet (the controller never touches
-        // power); a LockedPowerSensor snapshot() helper plus a reader are
-        // future work — TODO(PR-14).
-        const int error = s_power->getLastError();
+    const bool ok = s_power->read();
+    // read() and snapshot() are separate calls; a concurrent read from
+    // another task could reset the error to 0 between them (benign) — hint
+    // accordingly. The snapshot itself is one coherent copy.
+    const PowerSnapshot snap = s_power->snapshot();
+    if (!ok) {
+        const int error = snap.lastError;
         const char *hint = (error == 1)   ? "sensor not found"
                            : (error == 2) ? "read failed"
                            : (error == 0)
@@ -791,9 +1330,9 @@ int power_cmd(int argc, char **argv)
         return 1;
     }
     printf("OK bus=%.3f V current=%.3f A power=%.3f W\n",
-           static_cast<double>(s_power->getBusVoltage()),
-           static_cast<double>(s_power->getCurrent()),
-           static_cast<double>(s_power->getPower()));
+           static_cast<double>(snap.busVoltage),
+           static_cast<double>(snap.current),
+           static_cast<double>(snap.power));
     return 0;
 }
 
@@ -837,11 +1376,12 @@ int wifi_cmd(int argc, char **argv)
         return 1;
     }
     const WifiConnectionSnapshot snap = s_wifi->snapshot();
-    printf("OK state=%s ip=%s rssi=%d dBm failures=%u disconnects=%lu\n",
+    printf("OK state=%s ip=%s rssi=%d dBm failures=%u disconnects=%lu ps=%s\n",
            wifi_state_str(snap.state), snap.ipAcquired ? "yes" : "no",
            static_cast<int>(snap.rssi),
            static_cast<unsigned>(snap.consecutiveFailures),
-           static_cast<unsigned long>(snap.disconnectCount));
+           static_cast<unsigned long>(snap.disconnectCount),
+           wifiPowerSaveName(snap.powerSave));
     return 0;
 }
 
@@ -857,17 +1397,765 @@ int time_cmd(int argc, char **argv)
         printf("ERR usage: time\n");
         return 1;
     }
-    if (s_clock == nullptr || !s_clock->isTimeSet()) {
+    const WallTime wall = s_clock != nullptr ? s_clock->now() : WallTime{};
+    if (!wall.set) {
         printf("time not set\n");
         return 0;
     }
-    const std::string now = TimeService::formatLocal(s_clock->nowEpoch());
+    const std::string now = TimeService::formatLocal(wall.epoch);
+    // A boot estimate not yet confirmed by SNTP says so, with its error.
+    char holdover[64] = "";
+    ClockStatus status;
+    if (s_holdover != nullptr &&
+        s_holdover->status(static_cast<uint32_t>(esp_timer_get_time() / 1000), status) &&
+        status.holdover()) {
+        snprintf(holdover, sizeof holdover, "; holdover from %s, +/-%lu ms",
+                 clockSourceName(status.source), static_cast<unsigned long>(status.errorMs));
+    }
     if (s_sync != nullptr && s_sync->synced()) {
         const std::string last = TimeService::formatLocal(s_sync->lastSyncEpoch);
-        printf("OK %s (last sync %s)\n", now.c_str(), last.c_str());
+        printf("OK %s (last sync %s%s)\n", now.c_str(), last.c_str(), holdover);
+    } else {
+        printf("OK %s (never synced%s)\n", now.c_str(), holdover);
+    }
+    return 0;
+}
+
+/// `trace sys [n]`: @p argv[0] is "sys".
+int sys_trace_cmd(int argc, char **argv)
+{
+    if (argc > 2) {
+        printf("ERR usage: trace sys [n]\n");
+        return 1;
+    }
+#if WS_TRACE_LEVEL > 0
+    uint32_t count = 10;
+    if (argc == 2) {
+        char *end = nullptr;
+        const unsigned long n = strtoul(argv[1], &end, 10);
+        if (end == argv[1] || *end != '\0' || n == 0 || n > TraceRing::kCapacity) {
+            printf("ERR n must be 1..%u\n", static_cast<unsigned>(TraceRing::kCapacity));
+            return 1;
+        }
+        count = static_cast<uint32_t>(n);
+    }
+    const uint32_t nowUs = static_cast<uint32_t>(esp_timer_get_time());
+    printf("OK level %d, now %lu.%06lus\n", WS_TRACE_LEVEL,
+           static_cast<unsigned long>(nowUs / 1000000),
+           static_cast<unsigned long>(nowUs % 1000000));
+    for (std::size_t core = 0; core < TraceBuffer::kCores; ++core) {
+        const TraceRing &ring = traceBuffer().ring(core);
+        const uint32_t written = ring.written();
+        uint32_t after = written > count ? written - count : 0;
+        printf("core %u: %lu records since boot\n", static_cast<unsigned>(core),
+               static_cast<unsigned long>(written));
+        // A few at a time off the ring: the REPL stack holds one batch.
+        TraceRecord batch[8];
+        std::size_t n = 0;
+        while ((n = ring.read(batch, sizeof(batch) / sizeof(batch[0]), after)) > 0) {
+            for (std::size_t i = 0; i < n; ++i) {
+                const TraceRecord &r = batch[i];
+                printf("#%lu %lu.%06lus %-5s %-16s a=%lu (0x%08lx) b=%lu\n",
+                       static_cast<unsigned long>(r.sequence),
+                       static_cast<unsigned long>(r.atUs / 1000000),
+                       static_cast<unsigned long>(r.atUs % 1000000),
+                       traceLevelName(r.level), traceIdName(r.id),
+                       static_cast<unsigned long>(r.a), static_cast<unsigned long>(r.a),
+                       static_cast<unsigned long>(r.b));
+                after = r.sequence;
+            }
+        }
+    }
+    return 0;
+#else
+    (void)argv;
+    printf("ERR system trace not enabled\n");
+    return 1;
+#endif
+}
+
+int trace_cmd(int argc, char **argv)
+{
+    if (argc >= 2 && strcmp(argv[1], "sys") == 0) {
+        return sys_trace_cmd(argc - 1, argv + 1);
+    }
+    if (argc > 2) {
+        printf("ERR usage: trace [n] | trace sys [n]\n");
+        return 1;
+    }
+    if (s_trace == nullptr) {
+        printf("ERR decision trace not enabled\n");
+        return 1;
+    }
+    uint32_t count = 10;
+    if (argc == 2) {
+        char *end = nullptr;
+        const unsigned long n = strtoul(argv[1], &end, 10);
+        if (end == argv[1] || *end != '\0' || n == 0 ||
+            n > DecisionTrace::kCapacity) {
+            printf("ERR n must be 1..%u\n",
+                   static_cast<unsigned>(DecisionTrace::kCapacity));
+            return 1;
+        }
+        count = static_cast<uint32_t>(n);
+    }
+    const uint32_t written = s_trace->written();
+    uint32_t after = written > count ? written - count : 0;
+    printf("OK %lu decisions since boot\n", static_cast<unsigned long>(written));
+    // A few at a time off the ring: the REPL stack holds one batch.
+    DecisionRecord batch[8];
+    std::size_t n = 0;
+    while ((n = s_trace->read(batch, sizeof(batch) / sizeof(batch[0]), after)) > 0) {
+        for (std::size_t i = 0; i < n; ++i) {
+            const DecisionRecord &r = batch[i];
+            printf("#%lu %lld.%03lds z%u moisture=%.1f%s [%.1f..%.1f] soak=%lus "
+                   "gate=%s action=%s",
+                   static_cast<unsigned long>(r.sequence),
+                   static_cast<long long>(r.atMs / 1000),
+                   static_cast<long>(r.atMs % 1000), static_cast<unsigned>(r.zone),
+                   static_cast<double>(r.moisture),
+                   (r.flags & DecisionRecord::kFresh) != 0 ? "" : " (old)",
+                   static_cast<double>(r.low), static_cast<double>(r.high),
+                   static_cast<unsigned long>(r.soakLeftMs / 1000),
+                   decisionGateName(r.gate), decisionActionName(r.action));
+            if (r.burstS != 0) {
+                printf(" burst=%us", static_cast<unsigned>(r.burstS));
+            }
+            printf("%s%s\n", (r.flags & DecisionRecord::kPumpOn) != 0 ? " pump-on" : "",
+                   (r.flags & DecisionRecord::kBurstEnded) != 0 ? " burst-ended" : "");
+            after = r.sequence;
+        }
+    }
+    return 0;
+}
+
+void print_locks(const LockRegistry &locks)
+{
+    printf("%-12s %10s %9s %9s %9s %9s\n", "LOCK", "ACQUIRED", "CONTENDED",
+           "MEAN-WAIT", "MAX-WAIT", "MAX-HOLD");
+    for (std::size_t i = 0; i < locks.size(); ++i) {
+        const LockStats s = locks.stats(i);
+        printf("%-12s %10lu %9lu %7lu us %6lu us %6lu us\n", locks.name(i),
+               static_cast<unsigned long>(s.acquisitions),
+               static_cast<unsigned long>(s.contended),
+               static_cast<unsigned long>(s.meanWaitUs()),
+               static_cast<unsigned long>(s.maxWaitUs),
+               static_cast<unsigned long>(s.maxHoldUs));
+    }
+}
+
+int counters_cmd(int argc, char ** /*argv*/)
+{
+    if (argc != 1) {
+        printf("ERR usage: counters\n");
+        return 1;
+    }
+    if (s_counters == nullptr) {
+        printf("ERR lifetime counters not enabled\n");
+        return 1;
+    }
+    LifetimeCounterValues totals;
+    if (!s_counters->load(totals)) {
+        printf("ERR counters busy, retry\n");
+        return 1;
+    }
+    printf("OK sequence=%lu\n", static_cast<unsigned long>(s_counters->sequence()));
+    for (std::size_t i = 0; i < kLifetimeCounterCount; ++i) {
+        printf("%-24s %llu\n", lifetimeCounterName(static_cast<LifetimeCounter>(i)),
+               static_cast<unsigned long long>(totals.values[i]));
+    }
+    return 0;
+}
+
+int mqtt_cmd(int argc, char ** /*argv*/)
+{
+    if (argc != 1) {
+        printf("ERR usage: mqtt\n");
+        return 1;
+    }
+    if (s_mqtt == nullptr) {
+        printf("ERR mqtt uplink not enabled\n");
+        return 1;
+    }
+    const api::MqttUplinkStats m = s_mqtt->stats();
+    printf("OK connected=%d replaying=%d inflight=%lu watermark=%lu\n",
+           m.connected ? 1 : 0, m.replaying ? 1 : 0,
+           static_cast<unsigned long>(m.inflight),
+           static_cast<unsigned long>(m.watermark));
+    printf("connects=%lu batches=%lu replay_pages=%lu acked=%lu spooled=%lu "
+           "rejected=%lu dropped=%lu\n",
+           static_cast<unsigned long>(m.connects), static_cast<unsigned long>(m.batches),
+           static_cast<unsigned long>(m.replayPages), static_cast<unsigned long>(m.acked),
+           static_cast<unsigned long>(m.spooled), static_cast<unsigned long>(m.rejected),
+           static_cast<unsigned long>(m.droppedMessages));
+    return 0;
+}
+
+int espnow_cmd(int argc, char ** /*argv*/)
+{
+    if (argc != 1) {
+        printf("ERR usage: espnow\n");
+        return 1;
+    }
+    // The station MAC is what a leaf's WS_ESPNOW_GATEWAY_MAC names.
+    uint8_t mac[6] = {};
+    (void)esp_read_mac(mac, ESP_MAC_WIFI_STA);
+    EspNowMac station{};
+    std::memcpy(station.data(), mac, station.size());
+    const std::string self = api::NodeGateway::formatNode(station);
+    if (s_leaf != nullptr) {
+        const api::NodeLeafStats l = s_leaf->stats();
+        printf("OK role=leaf mac=%s\n", self.c_str());
+        printf("reports=%lu acked=%lu retries=%lu lost=%lu rejected=%lu\n",
+               static_cast<unsigned long>(l.reports), static_cast<unsigned long>(l.acked),
+               static_cast<unsigned long>(l.retries), static_cast<unsigned long>(l.lost),
+               static_cast<unsigned long>(l.rejected));
+        return 0;
+    }
+    if (s_gateway != nullptr) {
+        const api::NodeGatewayStats g = s_gateway->stats();
+        printf("OK role=gateway mac=%s nodes=%lu\n", self.c_str(),
+               static_cast<unsigned long>(g.nodes));
+        printf("reports=%lu duplicates=%lu missed=%lu malformed=%lu refused=%lu\n",
+               static_cast<unsigned long>(g.reports), static_cast<unsigned long>(g.duplicates),
+               static_cast<unsigned long>(g.missed), static_cast<unsigned long>(g.malformed),
+               static_cast<unsigned long>(g.refused));
+        const auto nowMs = static_cast<uint32_t>(esp_timer_get_time() / 1000);
+        for (const api::NodeDto& node : s_gateway->nodes(nowMs)) {
+            printf("%s seen=%lus rssi=%d reports=%lu missed=%lu\n", node.node.c_str(),
+                   static_cast<unsigned long>(node.lastSeenS), node.rssi,
+                   static_cast<unsigned long>(node.reports),
+                   static_cast<unsigned long>(node.missed));
+        }
+        return 0;
+    }
+    printf("OK role=off mac=%s\n", self.c_str());
+    return 0;
+}
+
+int top_cmd(int argc, char ** /*argv*/)
+{
+    if (argc != 1) {
+        printf("ERR usage: top\n");
+        return 1;
+    }
+    if (s_telemetry == nullptr) {
+        if (s_locks != nullptr) {
+            printf("OK task telemetry not enabled\n");
+            print_locks(*s_locks);
+            return 0;
+        }
+        printf("ERR task telemetry not enabled\n");
+        return 1;
+    }
+    // ~1 KB: static, not on the REPL stack (the REPL is the only caller).
+    static TelemetrySnapshot snap;
+    s_telemetry->snapshot(snap);
+    if (snap.samples == 0) {
+        printf("ERR no sample yet\n");
+        return 1;
+    }
+    printf("OK %u tasks over %lu ms (sample %lu, %lld s ago)\n",
+           static_cast<unsigned>(snap.taskCount + snap.tasksDropped),
+           static_cast<unsigned long>(snap.windowUs / 1000),
+           static_cast<unsigned long>(snap.samples),
+           static_cast<long long>((esp_timer_get_time() / 1000 - snap.atMs) / 1000));
+    printf("%-16s %4s %3s %6s %10s\n", "TASK", "CORE", "PRI", "CPU%", "STACK-FREE");
+    for (std::size_t i = 0; i < snap.taskCount; ++i) {
+        const TaskLoad &t = snap.tasks[i];
+        char core[4] = "-";
+        if (t.core >= 0) {
+            snprintf(core, sizeof core, "%d", t.core);
+        }
+        printf("%-16s %4s %3u %4u.%u %10lu\n", t.name, core,
+               static_cast<unsigned>(t.priority),
+               static_cast<unsigned>(t.cpuPermille / 10),
+               static_cast<unsigned>(t.cpuPermille % 10),
+               static_cast<unsigned long>(t.stackFreeBytes));
+    }
+    if (snap.tasksDropped != 0) {
+        printf("(%u more tasks not shown)\n", static_cast<unsigned>(snap.tasksDropped));
+    }
+    printf("%-9s %9s %9s %9s %9s\n", "HEAP", "TOTAL", "FREE", "MIN-FREE", "LARGEST");
+    for (std::size_t c = 0; c < kHeapCapsCount; ++c) {
+        const HeapCapsStats &h = snap.heaps[c];
+        const char *name = heapCapsName(static_cast<HeapCaps>(c));
+        if (h.totalBytes == 0) {
+            printf("%-9s %9s\n", name, "none");
+            continue;
+        }
+        printf("%-9s %9lu %9lu %9lu %9lu\n", name,
+               static_cast<unsigned long>(h.totalBytes),
+               static_cast<unsigned long>(h.freeBytes),
+               static_cast<unsigned long>(h.minFreeBytes),
+               static_cast<unsigned long>(h.largestBlockBytes));
+    }
+    if (s_locks != nullptr) {
+        print_locks(*s_locks);
+    }
+    return 0;
+}
+
+// --- bench command --------------------------------------------------------
+// On-target timings the host benchmarks (test_apps/bench) cannot give:
+// littlefs on the real flash, the RS485 and I2C transfers, and the endpoint
+// bodies built from live state. Each suite times n runs with esp_timer and
+// prints one line per case: min/mean/p99/max in µs. The storage suites
+// write to a scratch LittleFsDataStorage under <base>/bench, removed
+// afterwards, so the device's history and event log are never touched.
+
+constexpr int kBenchDefaultRuns = 50;
+constexpr int kBenchMaxRuns = 2000;
+constexpr int kBenchDefaultChunks = 4;
+constexpr int kBenchMaxChunks =
+    static_cast<int>(LittleFsDataStorage::kHistoryMaxChunksPerMetric);  // the ring's size
+constexpr uint32_t kBenchEpoch = 1'777'593'600;  ///< 2026-05-01, scratch data only
+constexpr char kBenchDir[] = "/bench";
+
+/// Samples of one case, in µs.
+class BenchCase {
+public:
+    BenchCase(const char *name, int runs) : name_(name) { samples_.reserve(runs); }
+
+    /// Time one run of @p op; a false return counts as a failure (timed too).
+    template <typename Op>
+    void time(Op &&op)
+    {
+        const int64_t t0 = esp_timer_get_time();
+        const bool ok = op();
+        samples_.push_back(static_cast<uint32_t>(esp_timer_get_time() - t0));
+        failures_ += ok ? 0 : 1;
+    }
+
+    /// Record one sample measured by the caller.
+    void add(uint32_t us, bool ok = true)
+    {
+        samples_.push_back(us);
+        failures_ += ok ? 0 : 1;
+    }
+
+    void print(const char *note = nullptr)
+    {
+        if (samples_.empty()) {
+            printf("%-20s no runs\n", name_);
+            return;
+        }
+        uint64_t sum = 0;
+        for (uint32_t us : samples_) {
+            sum += us;
+        }
+        std::vector<uint32_t> sorted = samples_;
+        std::sort(sorted.begin(), sorted.end());
+        // Nearest rank: the smallest sample >= 99 % of them.
+        const std::size_t p99 = (sorted.size() * 99 + 99) / 100 - 1;
+        printf("%-20s n=%-4u min=%-8lu mean=%-8lu p99=%-8lu max=%-8lu fail=%d%s%s\n",
+               name_, static_cast<unsigned>(sorted.size()),
+               static_cast<unsigned long>(sorted.front()),
+               static_cast<unsigned long>(sum / sorted.size()),
+               static_cast<unsigned long>(sorted[p99]),
+               static_cast<unsigned long>(sorted.back()), failures_,
+               note != nullptr ? " " : "", note != nullptr ? note : "");
+    }
+
+private:
+    const char *name_;
+    std::vector<uint32_t> samples_;
+    int failures_ = 0;
+};
+
+/// Remove @p path and everything below it (the scratch directory).
+void bench_remove_tree(const std::string &path)
+{
+    if (DIR *dir = opendir(path.c_str())) {
+        while (const dirent *entry = readdir(dir)) {
+            if (strcmp(entry->d_name, ".") == 0 || strcmp(entry->d_name, "..") == 0) {
+                continue;
+            }
+            bench_remove_tree(path + "/" + entry->d_name);
+        }
+        closedir(dir);
+    }
+    remove(path.c_str());  // file, or directory now empty
+}
+
+/// A fresh scratch store under <base>/bench; removed with the object.
+class BenchScratch {
+public:
+    BenchScratch() : path_(std::string(StorageMount::kBasePath) + kBenchDir)
+    {
+        bench_remove_tree(path_);  // left over by an interrupted run
+        mkdir(path_.c_str(), 0755);
+        store_ = std::make_unique<LittleFsDataStorage>(path_);
+    }
+    ~BenchScratch()
+    {
+        store_.reset();
+        bench_remove_tree(path_);
+    }
+    BenchScratch(const BenchScratch &) = delete;
+    BenchScratch &operator=(const BenchScratch &) = delete;
+
+    LittleFsDataStorage &store() { return *store_; }
+
+private:
+    std::string path_;
+    std::unique_ptr<LittleFsDataStorage> store_;
+};
+
+void bench_storage(int runs)
+{
+    BenchScratch scratch;
+    BenchCase append("storage.append", runs);
+    uint32_t epoch = kBenchEpoch;
+    for (int i = 0; i < runs; ++i) {
+        append.time([&] {
+            return scratch.store().storeSensorReading("soil_moisture", epoch++, 42.0f);
+        });
+    }
+    append.print("(one fsync each)");
+}
+
+/// Counts what forEachReading hands over.
+struct BenchVisitor : IReadingVisitor {
+    std::size_t seen = 0;
+    bool onReading(uint32_t /*epoch*/, float /*value*/) override
+    {
+        ++seen;
+        return true;
+    }
+};
+
+void bench_history(int runs, int chunks)
+{
+    BenchScratch scratch;
+    // Fill whole chunks a batch at a time: one commit per chunk, not per
+    // reading, so even a full ring takes seconds.
+    constexpr std::size_t kPerChunk =
+        LittleFsDataStorage::kHistoryChunkMaxBytes / LittleFsDataStorage::kHistoryRecordBytes;
+    std::vector<SensorReading> batch(kPerChunk);
+    uint32_t epoch = kBenchEpoch;
+    for (int c = 0; c < chunks; ++c) {
+        for (SensorReading &r : batch) {
+            r.metric = "soil_moisture";
+            r.epoch = epoch++;
+            r.value = 42.0f;
+        }
+        if (scratch.store().storeSensorReadings(batch.data(), batch.size()) != batch.size()) {
+            printf("ERR history fill failed at chunk %d\n", c);
+            return;
+        }
+    }
+    char note[48];
+    snprintf(note, sizeof(note), "(%d chunks, %u readings)", chunks,
+             static_cast<unsigned>(kPerChunk * static_cast<std::size_t>(chunks)));
+    BenchCase collect("history.query", runs);
+    BenchCase stream("history.for_each", runs);
+    for (int i = 0; i < runs; ++i) {
+        collect.time([&] {
+            return !scratch.store().getSensorReadings("soil_moisture", kBenchEpoch, epoch).empty();
+        });
+        stream.time([&] {
+            BenchVisitor visitor;
+            return scratch.store().forEachReading("soil_moisture", kBenchEpoch, epoch, visitor) > 0;
+        });
+    }
+    collect.print(note);
+    stream.print(note);
+
+    // The summary reduction alone, over one chunk's records in RAM: the
+    // one-record reference against the lane kernel summarizeChunk uses.
+    std::vector<uint8_t> records(kPerChunk * recordreduce::kRecordBytes);
+    for (std::size_t i = 0; i < kPerChunk; ++i) {
+        const uint32_t at = kBenchEpoch + static_cast<uint32_t>(i);
+        const float value = 20.0f + static_cast<float>(i % 7);
+        memcpy(&records[i * recordreduce::kRecordBytes], &at, sizeof(at));
+        memcpy(&records[i * recordreduce::kRecordBytes + 4], &value, sizeof(value));
+    }
+    BenchCase reduceRef("history.reduce_ref", runs);
+    BenchCase reduceLanes("history.reduce", runs);
+    for (int i = 0; i < runs; ++i) {
+        reduceRef.time([&] {
+            recordreduce::Reduction r;
+            recordreduce::reduceScalar(records.data(), kPerChunk, r);
+            return r.count == kPerChunk;
+        });
+        reduceLanes.time([&] {
+            recordreduce::Reduction r;
+            recordreduce::reduce(records.data(), kPerChunk, r);
+            return r.count == kPerChunk;
+        });
+    }
+    snprintf(note, sizeof(note), "(%u records)", static_cast<unsigned>(kPerChunk));
+    reduceRef.print(note);
+    reduceLanes.print(note);
+}
+
+void bench_events(int runs)
+{
+    BenchScratch scratch;
+    BenchCase append("events.append", runs);
+    BenchCase read("events.read_10", runs);
+    for (int i = 0; i < runs; ++i) {
+        append.time([&] {
+            return scratch.store().storeEvent(kBenchEpoch + static_cast<uint32_t>(i), 1,
+                                              "bench event");
+        });
+    }
+    for (int i = 0; i < runs; ++i) {
+        read.time([&] { return !scratch.store().getEvents(10).empty(); });
+    }
+    append.print();
+    read.print();
+}
+
+/// One fire of a `bench stop` timer: when it was due and when it ran.
+struct StopProbe {
+    volatile int64_t dueUs = 0;
+    volatile int64_t firedUs = 0;
+};
+
+/// esp_timer callback: stamp the fire. In IRAM: with the ISR dispatch it
+/// runs while a flash write has the cache off.
+void IRAM_ATTR bench_stop_fired(void *arg)
+{
+    static_cast<StopProbe *>(arg)->firedUs = esp_timer_get_time();
+}
+
+/// Time how late @p runs one-shots of @p dispatch fire after their due
+/// time, each due inside the load (an fsync'd append to @p store, or a
+/// plain wait without one). False when the timer cannot be created.
+bool bench_stop_case(const char *name, esp_timer_dispatch_t dispatch,
+                     LittleFsDataStorage *store, int runs)
+{
+    StopProbe probe;
+    const esp_timer_create_args_t args = {
+        .callback = bench_stop_fired,
+        .arg = &probe,
+        .dispatch_method = dispatch,
+        .name = "bench_stop",
+        .skip_unhandled_events = false,
+    };
+    esp_timer_handle_t timer = nullptr;
+    if (esp_timer_create(&args, &timer) != ESP_OK) {
+        printf("%-20s timer not available\n", name);
+        return false;
+    }
+    BenchCase lateness(name, runs);
+    uint32_t epoch = kBenchEpoch;
+    for (int i = 0; i < runs; ++i) {
+        // Due 0.5..4.5 ms in, spread over the append's flash phases.
+        const uint64_t delayUs = 500 + (static_cast<uint64_t>(i) * 1637) % 4000;
+        probe.firedUs = 0;
+        probe.dueUs = esp_timer_get_time() + static_cast<int64_t>(delayUs);
+        if (esp_timer_start_once(timer, delayUs) != ESP_OK) {
+            lateness.add(0, false);
+            continue;
+        }
+        bool ok = true;
+        if (store != nullptr) {
+            ok = store->storeSensorReading("soil_moisture", epoch++, 42.0f);
+        }
+        const int64_t giveUpUs = esp_timer_get_time() + 1'000'000;
+        while (probe.firedUs == 0 && esp_timer_get_time() < giveUpUs) {
+            vTaskDelay(1);
+        }
+        ok = ok && probe.firedUs != 0;
+        lateness.add(ok ? static_cast<uint32_t>(probe.firedUs - probe.dueUs) : 0, ok);
+    }
+    esp_timer_stop(timer);
+    esp_timer_delete(timer);
+    lateness.print("(us late)");
+    return true;
+}
+
+// How late a pump stop can land while littlefs writes: one-shot timers due
+// in the middle of fsync'd appends, timed from due to run. The task
+// dispatch is the pump deadline's path (EspDeadlineTimer, then the gate
+// write under the pump's lock), held up by every flash write like any
+// task; the ISR dispatch stands for the IRAM interrupt paths (the
+// over-current gate cut, the level edges), which the write does not hold.
+// No pump is switched: the gate write after the dispatch is one register.
+void bench_stop(int runs)
+{
+    bench_stop_case("stop.task_idle", ESP_TIMER_TASK, nullptr, runs);
+    BenchScratch scratch;
+    bench_stop_case("stop.task_fsync", ESP_TIMER_TASK, &scratch.store(), runs);
+#if CONFIG_ESP_TIMER_SUPPORTS_ISR_DISPATCH_METHOD
+    bench_stop_case("stop.isr_fsync", ESP_TIMER_ISR, &scratch.store(), runs);
+#else
+    printf("%-20s needs CONFIG_ESP_TIMER_SUPPORTS_ISR_DISPATCH_METHOD\n", "stop.isr_fsync");
+#endif
+}
+
+void bench_modbus(int runs)
+{
+    if (s_modbus == nullptr) {
+        printf("%-20s skipped: modbus client not available\n", "modbus.read_1");
+        return;
+    }
+    BenchCase rtt("modbus.read_1", runs);
+    for (int i = 0; i < runs; ++i) {
+        rtt.time([] {
+            uint16_t value = 0;
+            return s_modbus->readHoldingRegisters(0x01, 0x0000, 1, &value);
+        });
+    }
+    rtt.print("(slave 1, one register, bus queue wait included)");
+}
+
+void bench_sensors(int runs)
+{
+    if (s_env == nullptr) {
+        printf("%-20s skipped: environmental sensor not available\n", "bme280.read");
     } else {
-        printf("OK %s (never synced)\n", now.c_str());
+        BenchCase env("bme280.read", runs);
+        for (int i = 0; i < runs; ++i) {
+            env.time([] { return s_env->read(); });
+        }
+        env.print();
+    }
+#if BOARD_HAS_INA226
+    if (s_power == nullptr) {
+        printf("%-20s skipped: power sensor not available\n", "ina226.read");
+        return;
+    }
+    BenchCase power("ina226.read", runs);
+    for (int i = 0; i < runs; ++i) {
+        power.time([] { return s_power->read(); });
+    }
+    power.print();
+#endif
+}
+
+/// Counts a streamed history body instead of sending it.
+struct BenchSink : api::IChunkSink {
+    std::size_t bytes = 0;
+    bool send(const char * /*data*/, std::size_t len) override
+    {
+        bytes += len;
+        return true;
+    }
+};
+
+/// Time building one endpoint body; the size of the last one is noted.
+template <typename Build>
+void bench_body(const char *name, int runs, Build &&build)
+{
+    BenchCase body(name, runs);
+    std::size_t bytes = 0;
+    for (int i = 0; i < runs; ++i) {
+        body.time([&] {
+            bytes = build();
+            return bytes > 0;
+        });
+    }
+    char note[24];
+    snprintf(note, sizeof(note), "(%u B)", static_cast<unsigned>(bytes));
+    body.print(note);
+}
+
+void bench_json(int runs)
+{
+    api::ApiServer *server = s_api.load(std::memory_order_acquire);
+    if (server == nullptr) {
+        printf("%-20s skipped: API server not running (station mode only)\n", "json.*");
+        return;
+    }
+    // The builders the handlers call, minus the response cache and the
+    // send: what a cache miss costs the httpd task.
+    bench_body("json.status", runs, [server] { return server->buildStatusBody().size(); });
+    bench_body("json.sensors", runs,
+               [server] { return api::serializeSensors(server->readSensors()).size(); });
+    bench_body("json.pumps", runs,
+               [server] { return api::serializePumpList(server->readPumps()).size(); });
+    bench_body("json.config", runs, [server] { return server->buildConfigBody().size(); });
+    bench_body("json.events", runs, [server] {
+        EventQuery query;
+        query.limit = 50;
+        return server->buildEventsBody(query).size();
+    });
+    bench_body("json.snapshot", runs, [server] {
+        return api::serializeSnapshot(server->readSnapshot(api::kSnapshotAll)).size();
+    });
+#if BOARD_HAS_INA226
+    bench_body("json.power", runs, [server] { return server->buildPowerBody().size(); });
+#endif
+    bench_body("json.history_24h", runs, [server] {
+        api::HistoryQuery query;
+        query.metric = "soil_moisture";
+        query.range = "24h";
+        BenchSink sink;
+        const api::ApiResponse r = server->streamHistoryResponse(query, sink);
+        // A 400 (clock not set yet) comes back as a body, not streamed.
+        return r.status == api::ApiStatus::Ok ? sink.bytes : 0;
+    });
+}
+
+int print_bench_usage(void)
+{
+    printf("ERR usage: bench <storage|history|events|stop|modbus|sensors|json|all> [runs] "
+           "[chunks]\n");
+    return 1;
+}
+
+int bench_cmd(int argc, char **argv)
+{
+    if (argc < 2 || argc > 4) {
+        return print_bench_usage();
+    }
+    int runs = kBenchDefaultRuns;
+    int chunks = kBenchDefaultChunks;
+    if (argc >= 3) {
+        char *end = nullptr;
+        runs = static_cast<int>(strtol(argv[2], &end, 10));
+        if (*end != '\0' || runs < 1 || runs > kBenchMaxRuns) {
+            printf("ERR runs must be 1..%d\n", kBenchMaxRuns);
+            return 1;
+        }
     }
+    if (argc == 4) {
+        char *end = nullptr;
+        chunks = static_cast<int>(strtol(argv[3], &end, 10));
+        if (*end != '\0' || chunks < 1 || chunks > kBenchMaxChunks) {
+            printf("ERR chunks must be 1..%d\n", kBenchMaxChunks);
+            return 1;
+        }
+    }
+    const char *suite = argv[1];
+    const bool all = strcmp(suite, "all") == 0;
+    bool known = all;
+    if (all || strcmp(suite, "storage") == 0) {
+        bench_storage(runs);
+        known = true;
+    }
+    if (all || strcmp(suite, "history") == 0) {
+        bench_history(runs, chunks);
+        known = true;
+    }
+    if (all || strcmp(suite, "events") == 0) {
+        bench_events(runs);
+        known = true;
+    }
+    if (all || strcmp(suite, "stop") == 0) {
+        bench_stop(runs);
+        known = true;
+    }
+    if (all || strcmp(suite, "modbus") == 0) {
+        bench_modbus(runs);
+        known = true;
+    }
+    if (all || strcmp(suite, "sensors") == 0) {
+        bench_sensors(runs);
+        known = true;
+    }
+    if (all || strcmp(suite, "json") == 0) {
+        bench_json(runs);
+        known = true;
+    }
+    if (!known) {
+        return print_bench_usage();
+    }
+    printf("OK\n");
     return 0;
 }
 
@@ -892,10 +2180,19 @@ void diag_console_register_storage(IConfigStore& config, IDataStorage& storage)
     s_storage = &storage;
 }
 
-void diag_console_register_soil(ISoilSensor& sensor, IModbusClient& client)
+void diag_console_register_soil(ISoilSensor& sensor, IModbusClient& client,
+                                const ModbusBusMaster* bus,
+                                const SoilPollScheduler* poller)
 {
     s_soil = &sensor;
     s_modbus = &client;
+    s_modbus_bus = bus;
+    s_soil_poller = poller;
+}
+
+void diag_console_register_modbus_capture(ModbusFrameCapture& capture)
+{
+    s_modbus_capture = &capture;
 }
 
 void diag_console_register_env(IEnvironmentalSensor& sensor)
@@ -903,6 +2200,11 @@ void diag_console_register_env(IEnvironmentalSensor& sensor)
     s_env = &sensor;
 }
 
+void diag_console_register_i2c(const I2cBusMaster& bus)
+{
+    s_i2c_bus = &bus;
+}
+
 void diag_console_register_level(ILevelSensor& low, ILevelSensor& high)
 {
     s_level_low = &low;
@@ -930,11 +2232,58 @@ void diag_console_register_time(IWallClock* clock, const SyncStatus* sync)
     s_sync = sync;
 }
 
+void diag_console_register_trace(const DecisionTrace& trace)
+{
+    s_trace = &trace;
+}
+
+void diag_console_register_telemetry(const TaskTelemetry& telemetry)
+{
+    s_telemetry = &telemetry;
+}
+
+void diag_console_register_locks(const LockRegistry& locks)
+{
+    s_locks = &locks;
+}
+
+void diag_console_register_clock_holdover(const ClockHoldover& holdover)
+{
+    s_holdover = &holdover;
+}
+
+void diag_console_register_counters(const LifetimeCounters& counters)
+{
+    s_counters = &counters;
+}
+
+void diag_console_register_mqtt(const api::MqttUplink& uplink)
+{
+    s_mqtt = &uplink;
+}
+
+void diag_console_register_espnow_leaf(const api::NodeLeaf& leaf)
+{
+    s_leaf = &leaf;
+}
+
+void diag_console_register_espnow_gateway(const api::NodeGateway& gateway)
+{
+    s_gateway = &gateway;
+}
+
+void diag_console_register_api(api::ApiServer& server)
+{
+    s_api.store(&server, std::memory_order_release);
+}
+
 esp_err_t diag_console_start(void)
 {
     esp_console_repl_t *repl = nullptr;
     esp_console_repl_config_t repl_config = ESP_CONSOLE_REPL_CONFIG_DEFAULT();
     repl_config.prompt = "ws>";
+    repl_config.task_priority = task_plan::kConsole.priority;
+    repl_config.task_core_id = task_plan::kConsole.core;
 
     esp_console_dev_uart_config_t uart_config =
         ESP_CONSOLE_DEV_UART_CONFIG_DEFAULT();
@@ -961,8 +2310,9 @@ esp_err_t diag_console_start(void)
 
     const esp_console_cmd_t cmd_config = {
         .command = "config",
-        .help = "config <get|set <item> <value>|wifi <ssid> <password>"
-                "|wifi-clear|factory-reset>",
+        .help = "config <get|set <item> <value> [...]|wifi <ssid> <password>"
+                "|wifi-clear|ip <addr> <mask> [gw] [dns]|ip dhcp"
+                "|httpd <preset|default|6 fields>|factory-reset>",
         .hint = nullptr,
         .func = &config_cmd,
         .argtable = nullptr,
@@ -977,7 +2327,7 @@ esp_err_t diag_console_start(void)
     const esp_console_cmd_t cmd_storage = {
         .command = "storage",
         .help = "storage <stats|log <metric> <value>|query <metric> [t0 t1]"
-                "|event <category> <detail>|events [n]>",
+                "|event <category> <detail>|events [n]|flush>",
         .hint = nullptr,
         .func = &storage_cmd,
         .argtable = nullptr,
@@ -1005,7 +2355,10 @@ esp_err_t diag_console_start(void)
 
     const esp_console_cmd_t cmd_rs485test = {
         .command = "rs485test",
-        .help = "rs485test — raw 1-register Modbus probe + statistics",
+        .help = "rs485test [stats|baud [<rate>]|capture [on|off]] — raw "
+                "1-register Modbus probe + statistics, the bus queue/transfer "
+                "timings and per-slave latency/errors, the soil bus line rate "
+                "(negotiate + store), or the captured RS485 frames",
         .hint = nullptr,
         .func = &rs485test_cmd,
         .argtable = nullptr,
@@ -1076,6 +2429,20 @@ esp_err_t diag_console_start(void)
         return err;
     }
 
+    const esp_console_cmd_t cmd_i2c = {
+        .command = "i2c",
+        .help = "i2c — shared I2C bus clock and per-device bus time",
+        .hint = nullptr,
+        .func = &i2c_cmd,
+        .argtable = nullptr,
+        .func_w_context = nullptr,
+        .context = nullptr,
+    };
+    err = esp_console_cmd_register(&cmd_i2c);
+    if (err != ESP_OK) {
+        return err;
+    }
+
     const esp_console_cmd_t cmd_level = {
         .command = "level",
         .help = "level — both level sensors: logical + raw state "
@@ -1137,5 +2504,97 @@ esp_err_t diag_console_start(void)
         return err;
     }
 
+    const esp_console_cmd_t cmd_trace = {
+        .command = "trace",
+        .help = "trace [n] — newest n watering decisions (default 10): "
+                "moisture, thresholds, soak left, gate and action; "
+                "trace sys [n] — newest n system trace records per core",
+        .hint = nullptr,
+        .func = &trace_cmd,
+        .argtable = nullptr,
+        .func_w_context = nullptr,
+        .context = nullptr,
+    };
+    err = esp_console_cmd_register(&cmd_trace);
+    if (err != ESP_OK) {
+        return err;
+    }
+
+    const esp_console_cmd_t cmd_top = {
+        .command = "top",
+        .help = "top — per-task CPU share of one core over the last telemetry "
+                "period, priority, core and unused stack; heap per capability; "
+                "decorator lock contention when built in",
+        .hint = nullptr,
+        .func = &top_cmd,
+        .argtable = nullptr,
+        .func_w_context = nullptr,
+        .context = nullptr,
+    };
+    err = esp_console_cmd_register(&cmd_top);
+    if (err != ESP_OK) {
+        return err;
+    }
+
+    const esp_console_cmd_t cmd_counters = {
+        .command = "counters",
+        .help = "counters — totals kept across resets: boots, watchdog/panic/"
+                "brownout resets, pump run time, dropped events, storage writes",
+        .hint = nullptr,
+        .func = &counters_cmd,
+        .argtable = nullptr,
+        .func_w_context = nullptr,
+        .context = nullptr,
+    };
+    err = esp_console_cmd_register(&cmd_counters);
+    if (err != ESP_OK) {
+        return err;
+    }
+
+    const esp_console_cmd_t cmd_mqtt = {
+        .command = "mqtt",
+        .help = "mqtt — broker session, replay, messages awaiting PUBACK, "
+                "acknowledged-through epoch and publish counters",
+        .hint = nullptr,
+        .func = &mqtt_cmd,
+        .argtable = nullptr,
+        .func_w_context = nullptr,
+        .context = nullptr,
+    };
+    err = esp_console_cmd_register(&cmd_mqtt);
+    if (err != ESP_OK) {
+        return err;
+    }
+
+    const esp_console_cmd_t cmd_espnow = {
+        .command = "espnow",
+        .help = "espnow — station MAC, ESP-NOW role, report/Ack counters and, "
+                "on a gateway, every leaf's last report",
+        .hint = nullptr,
+        .func = &espnow_cmd,
+        .argtable = nullptr,
+        .func_w_context = nullptr,
+        .context = nullptr,
+    };
+    err = esp_console_cmd_register(&cmd_espnow);
+    if (err != ESP_OK) {
+        return err;
+    }
+
+    const esp_console_cmd_t cmd_bench = {
+        .command = "bench",
+        .help = "bench <storage|history|events|stop|modbus|sensors|json|all> [runs] [chunks] — "
+                "min/mean/p99/max µs per case; storage suites use a scratch dir",
+        .hint = nullptr,
+        .func = &bench_cmd,
+        .argtable = nullptr,
+        .func_w_context = nullptr,
+        .context = nullptr,
+    };
+    err = esp_console_cmd_register(&cmd_bench);
+    if (err != ESP_OK) {
+        return err;
+    }
+
     return esp_console_start_repl(repl);
 }
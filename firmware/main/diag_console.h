@@ -6,12 +6,22 @@
  *
  * Temporary scope per specs/002-pump-gpio-board/contracts/
  * serial-diagnostic.md — full FR12 diagnostics arrive in later phases.
+ *
+ * CONFIG_WS_DIAG_CONSOLE off (sdkconfig.production): diag_console.cpp is
+ * not built and every function below is an inline no-op, so app_main
+ * registers unconditionally and the commands, their tables and the REPL
+ * task are left out of the image. Logs still go to the UART.
  */
 
 #ifndef WATERINGSYSTEM_MAIN_DIAG_CONSOLE_H
 #define WATERINGSYSTEM_MAIN_DIAG_CONSOLE_H
 
+#include "api/ApiServer.h"
+#include "api/MqttUplink.h"
+#include "api/NodeGateway.h"
+#include "api/NodeLeaf.h"
 #include "board/board.h"
+#include "control/DecisionTrace.h"
 #include "esp_err.h"
 #include "interfaces/IConfigStore.h"
 #include "interfaces/IDataStorage.h"
@@ -20,11 +30,23 @@
 #include "interfaces/IModbusClient.h"
 #include "interfaces/IPowerSensor.h"
 #include "interfaces/ISoilSensor.h"
+#include "interfaces/LockStats.h"
+#include "interfaces/TaskTelemetry.h"
 #include "interfaces/IWallClock.h"
 #include "interfaces/IWaterPump.h"
+#include "interfaces/LifetimeCounters.h"
 #include "network/WifiManager.h"
+#include "sensors/I2cBusMaster.h"
+#include "sensors/ModbusBusMaster.h"
+#include "sensors/ModbusFrameCapture.h"
+#include "sensors/SoilPollScheduler.h"
+#include "time/ClockHoldover.h"
 #include "time/SyncStatus.h"
 
+#include "sdkconfig.h"
+
+#if defined(CONFIG_WS_DIAG_CONSOLE)
+
 /**
  * @brief Register the pump instances the console commands operate on.
  *
@@ -59,12 +81,24 @@ void diag_console_register_storage(IConfigStore& config,
  *        commands operate on (HIL verification path for feature 004).
  *
  * Pass the LockedSoilSensor decorator, never the raw sensor — the console
- * handlers run on the REPL task, concurrently with the main-loop reader
- * arriving in PR-11. The client may be passed raw: in this PR it is only
- * reached from the REPL task (directly and via the locked sensor). Must be
- * called before diag_console_start(); plain pointer registration.
+ * handlers run on the REPL task, concurrently with the watering task's
+ * reads. Pass the bus master's Diagnostic port as the client, so a probe
+ * queues behind the controller's reads, and the bus master itself for the
+ * `rs485test stats` timings (nullptr: not shown); @p poller adds the soil
+ * probe rounds' bus usage to them when it holds more than one probe. Must
+ * be called before diag_console_start(); plain pointer registration.
+ */
+void diag_console_register_soil(ISoilSensor& sensor, IModbusClient& client,
+                                const ModbusBusMaster* bus,
+                                const SoilPollScheduler* poller);
+
+/**
+ * @brief Register the RS485 frame capture `rs485test capture` shows and
+ * starts or freezes (the UART client's; absent with esp-modbus, and the
+ * subcommand then says so). Must be called before diag_console_start();
+ * plain pointer registration.
  */
-void diag_console_register_soil(ISoilSensor& sensor, IModbusClient& client);
+void diag_console_register_modbus_capture(ModbusFrameCapture& capture);
 
 /**
  * @brief Register the environmental sensor the `env` command operates on
@@ -77,13 +111,20 @@ void diag_console_register_soil(ISoilSensor& sensor, IModbusClient& client);
  */
 void diag_console_register_env(IEnvironmentalSensor& sensor);
 
+/**
+ * @brief Register the shared I2C bus master the `i2c` statistics command
+ *        reads. Must be called before diag_console_start(); plain pointer
+ *        registration.
+ */
+void diag_console_register_i2c(const I2cBusMaster& bus);
+
 /**
  * @brief Register the two level sensors the `level` command operates on
  *        (HIL verification path for feature 006).
  *
- * Pass the LockedLevelSensor decorators, never the raw sensors — the
- * console handler runs on the REPL task, concurrently with the 10 Hz
- * main-loop update(). Must be called before diag_console_start(); plain
+ * Pass the LevelSensorBank marks, never the raw sensors — the console
+ * handler runs on the REPL task, concurrently with the 10 Hz main-loop
+ * update(). Must be called before diag_console_start(); plain
  * pointer registration.
  *
  * @param low  Low-mark sensor (BOARD_PIN_LEVEL_LOW).
@@ -136,6 +177,80 @@ void diag_console_register_wifi(WifiManager* manager);
  */
 void diag_console_register_time(IWallClock* clock, const SyncStatus* sync);
 
+/**
+ * @brief Register the wall-clock holdover, so `time` says when the clock
+ * is a boot estimate (and how far it may be off) rather than SNTP's.
+ *
+ * Optional; must be called before diag_console_start(); plain pointer
+ * registration.
+ */
+void diag_console_register_clock_holdover(const ClockHoldover& holdover);
+
+/**
+ * @brief Register the watering decision trace the `trace` command reads.
+ *
+ * Only reads the ring (lock-free; the watering task writes it); without a
+ * registration the command reports it not enabled. Must be called before
+ * diag_console_start(); plain pointer registration.
+ */
+void diag_console_register_trace(const DecisionTrace& trace);
+
+/**
+ * @brief Register the task telemetry the `top` command reads.
+ *
+ * Only copies the telemetry task's last snapshot; without a registration
+ * the command reports it not enabled. Must be called before
+ * diag_console_start(); plain pointer registration.
+ */
+void diag_console_register_telemetry(const TaskTelemetry& telemetry);
+
+/**
+ * @brief Register the decorator lock statistics `top` lists after the
+ * tasks and heaps.
+ *
+ * Only reads the counters; without a registration `top` leaves them out.
+ * Must be called before diag_console_start(); plain pointer registration.
+ */
+void diag_console_register_locks(const LockRegistry& locks);
+
+/**
+ * @brief Register the lifetime counters the `counters` command lists.
+ *
+ * Only reads the published totals; without a registration the command
+ * reports it not enabled. Must be called before diag_console_start(); plain
+ * pointer registration.
+ */
+void diag_console_register_counters(const LifetimeCounters& counters);
+
+/**
+ * @brief Register the MQTT uplink the `mqtt` command reports.
+ *
+ * Only reads its stats(); without a registration (CONFIG_WS_MQTT off) the
+ * command reports it not enabled. Must be called before
+ * diag_console_start(); plain pointer registration.
+ */
+void diag_console_register_mqtt(const api::MqttUplink& uplink);
+
+/**
+ * @brief Register the ESP-NOW leaf, or gateway, the `espnow` command
+ * reports (one of the two, per CONFIG_WS_ESPNOW_ROLE).
+ *
+ * Only reads stats() (and the gateway's nodes()); without a registration
+ * the command prints the station MAC and role=off. Must be called before
+ * diag_console_start(); plain pointer registration.
+ */
+void diag_console_register_espnow_leaf(const api::NodeLeaf& leaf);
+void diag_console_register_espnow_gateway(const api::NodeGateway& gateway);
+
+/**
+ * @brief Register the API server whose endpoint bodies `bench json` times.
+ *
+ * The one registration made AFTER diag_console_start(): the server exists
+ * only in station mode, and is built after the console. The pointer is
+ * atomic for that reason; without it `bench json` reports it unavailable.
+ */
+void diag_console_register_api(api::ApiServer& server);
+
 /**
  * @brief Start the UART REPL (prompt "ws>") and register the commands.
  *
@@ -143,4 +258,37 @@ void diag_console_register_time(IWallClock* clock, const SyncStatus* sync);
  */
 esp_err_t diag_console_start(void);
 
+#else  // !CONFIG_WS_DIAG_CONSOLE
+
+#if BOARD_HAS_RESERVOIR_PUMP
+inline void diag_console_register_pumps(IWaterPump&, IWaterPump&) {}
+#else
+inline void diag_console_register_pumps(IWaterPump&) {}
+#endif
+inline void diag_console_register_storage(IConfigStore&, IDataStorage&) {}
+inline void diag_console_register_soil(ISoilSensor&, IModbusClient&,
+                                       const ModbusBusMaster*,
+                                       const SoilPollScheduler*) {}
+inline void diag_console_register_modbus_capture(ModbusFrameCapture&) {}
+inline void diag_console_register_env(IEnvironmentalSensor&) {}
+inline void diag_console_register_i2c(const I2cBusMaster&) {}
+inline void diag_console_register_level(ILevelSensor&, ILevelSensor&) {}
+#if BOARD_HAS_INA226
+inline void diag_console_register_power(IPowerSensor&) {}
+#endif
+inline void diag_console_register_wifi(WifiManager*) {}
+inline void diag_console_register_time(IWallClock*, const SyncStatus*) {}
+inline void diag_console_register_clock_holdover(const ClockHoldover&) {}
+inline void diag_console_register_trace(const DecisionTrace&) {}
+inline void diag_console_register_telemetry(const TaskTelemetry&) {}
+inline void diag_console_register_locks(const LockRegistry&) {}
+inline void diag_console_register_counters(const LifetimeCounters&) {}
+inline void diag_console_register_mqtt(const api::MqttUplink&) {}
+inline void diag_console_register_espnow_leaf(const api::NodeLeaf&) {}
+inline void diag_console_register_espnow_gateway(const api::NodeGateway&) {}
+inline void diag_console_register_api(api::ApiServer&) {}
+inline esp_err_t diag_console_start(void) { return ESP_OK; }
+
+#endif  // CONFIG_WS_DIAG_CONSOLE
+
 #endif /* WATERINGSYSTEM_MAIN_DIAG_CONSOLE_H */
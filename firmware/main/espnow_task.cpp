@@ -0,0 +1,188 @@
+// SPDX-FileCopyrightText: 2026 Cryptotomte
+// SPDX-License-Identifier: AGPL-3.0-or-later
+/**
+ * @file espnow_task.cpp
+ * @brief ESP-NOW link start and the leaf / gateway tick (see espnow_task.h).
+ *
+ * 50 ms is a quarter of the default Ack timeout, so a resend goes out
+ * close to when it is due, and it bounds how long a leaf report waits in
+ * the gateway's queue before its Ack. The leaf reads the DTOs only when a
+ * report is due, not on every tick.
+ */
+
+#include "espnow_task.h"
+
+#include <cstdint>
+
+#include "esp_log.h"
+#include "esp_mac.h"
+#include "esp_random.h"
+#include "esp_timer.h"
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+
+#include "network/EspNowLink.h"
+
+#include "sdkconfig.h"
+#include "task_plan.h"
+
+#if defined(CONFIG_WS_ESPNOW_LEAF) || defined(CONFIG_WS_ESPNOW_GATEWAY)
+
+static const char *TAG = "espnow_task";
+
+namespace {
+
+constexpr uint32_t kPeriodMs = 50;
+
+EspNowLink& link()
+{
+    static EspNowLink instance;
+    return instance;
+}
+
+uint32_t now_ms()
+{
+    return static_cast<uint32_t>(esp_timer_get_time() / 1000);
+}
+
+bool start_link()
+{
+    const esp_err_t err = link().start();
+    if (err != ESP_OK) {
+        ESP_LOGE(TAG, "ESP-NOW not started: %s", esp_err_to_name(err));
+        return false;
+    }
+    return true;
+}
+
+}  // namespace
+
+#endif  // CONFIG_WS_ESPNOW_LEAF || CONFIG_WS_ESPNOW_GATEWAY
+
+// The CONFIG_WS_ESPNOW_* leaf options exist only in that role; app_main
+// calls nothing here otherwise.
+#if defined(CONFIG_WS_ESPNOW_LEAF)
+
+namespace {
+
+struct LeafTaskArgs {
+    api::NodeLeaf* leaf = nullptr;
+    api::ApiServer* server = nullptr;
+};
+
+LeafTaskArgs s_leafArgs;
+bool s_leafStarted = false;
+
+[[noreturn]] void leaf_task(void* arg)
+{
+    const LeafTaskArgs& args = *static_cast<const LeafTaskArgs*>(arg);
+    TickType_t lastWake = xTaskGetTickCount();
+    while (true) {
+        vTaskDelayUntil(&lastWake, pdMS_TO_TICKS(kPeriodMs));
+        const uint32_t now = now_ms();
+        args.leaf->poll(now);
+        if (args.leaf->reportDue(now)) {
+            args.leaf->report(now, args.server->readSensors(), args.server->readPumps());
+        }
+    }
+}
+
+EspNowMac gateway_mac(bool& ok)
+{
+    EspNowMac mac{};
+    ok = api::NodeGateway::parseNode(CONFIG_WS_ESPNOW_GATEWAY_MAC, mac);
+    return mac;
+}
+
+}  // namespace
+
+api::NodeLeaf& espnow_leaf_init()
+{
+    bool ok = false;
+    static api::NodeLeaf leaf(link(), gateway_mac(ok));
+    static bool configured = false;
+    if (!configured) {
+        configured = true;
+        uint8_t mac[6] = {};
+        (void)esp_read_mac(mac, ESP_MAC_WIFI_STA);
+        const uint32_t periodMs = static_cast<uint32_t>(CONFIG_WS_ESPNOW_PERIOD_S) * 1000;
+        api::NodeLeafConfig config;
+        config.periodMs = periodMs;
+        config.phaseMs = ((static_cast<uint32_t>(mac[4]) << 8) | mac[5]) % periodMs;
+        config.ackTimeoutMs = static_cast<uint32_t>(CONFIG_WS_ESPNOW_ACK_TIMEOUT_MS);
+        config.maxRetries = static_cast<uint8_t>(CONFIG_WS_ESPNOW_MAX_RETRIES);
+        config.firstSeq = static_cast<uint16_t>(esp_random());
+        leaf.configure(config);
+    }
+    return leaf;
+}
+
+void espnow_leaf_start(api::NodeLeaf& leaf, api::ApiServer& server)
+{
+    if (s_leafStarted) {
+        return;
+    }
+    s_leafStarted = true;
+    bool ok = false;
+    (void)gateway_mac(ok);
+    if (!ok) {
+        ESP_LOGE(TAG, "WS_ESPNOW_GATEWAY_MAC \"%s\" is not 12 hex digits; leaf off",
+                 CONFIG_WS_ESPNOW_GATEWAY_MAC);
+        return;
+    }
+    if (!start_link()) {
+        return;
+    }
+    s_leafArgs = LeafTaskArgs{&leaf, &server};
+    if (task_plan_create<task_plan::kEspNow>(leaf_task, &s_leafArgs) != pdPASS) {
+        ESP_LOGE(TAG, "failed to create espnow task");
+        return;
+    }
+    ESP_LOGI(TAG, "leaf reporting to %s every %d s", CONFIG_WS_ESPNOW_GATEWAY_MAC,
+             CONFIG_WS_ESPNOW_PERIOD_S);
+}
+
+#endif  // CONFIG_WS_ESPNOW_LEAF
+
+#if defined(CONFIG_WS_ESPNOW_GATEWAY)
+
+namespace {
+
+bool s_gatewayStarted = false;
+
+[[noreturn]] void gateway_task(void* arg)
+{
+    api::NodeGateway& gateway = *static_cast<api::NodeGateway*>(arg);
+    TickType_t lastWake = xTaskGetTickCount();
+    while (true) {
+        vTaskDelayUntil(&lastWake, pdMS_TO_TICKS(kPeriodMs));
+        gateway.tick(now_ms());
+    }
+}
+
+}  // namespace
+
+api::NodeGateway& espnow_gateway_init(const IWallClock& clock)
+{
+    static api::NodeGateway gateway(link(), clock);
+    return gateway;
+}
+
+void espnow_gateway_start(api::NodeGateway& gateway)
+{
+    if (s_gatewayStarted) {
+        return;
+    }
+    s_gatewayStarted = true;
+    if (!start_link()) {
+        return;
+    }
+    if (task_plan_create<task_plan::kEspNow>(gateway_task, &gateway) != pdPASS) {
+        ESP_LOGE(TAG, "failed to create espnow task");
+        return;
+    }
+    ESP_LOGI(TAG, "gateway collecting up to %u leaves",
+             static_cast<unsigned>(api::NodeGateway::kMaxNodes));
+}
+
+#endif  // CONFIG_WS_ESPNOW_GATEWAY
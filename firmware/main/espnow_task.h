@@ -0,0 +1,55 @@
+// SPDX-FileCopyrightText: 2026 Cryptotomte
+// SPDX-License-Identifier: AGPL-3.0-or-later
+/**
+ * @file espnow_task.h
+ * @brief ESP-NOW multi-node wiring: the radio link and the leaf or gateway
+ *        task (app wiring, CONFIG_WS_ESPNOW_LEAF / CONFIG_WS_ESPNOW_GATEWAY).
+ *
+ * Owns the EspNowLink and the pure api::NodeLeaf or api::NodeGateway above
+ * it. Every 50 ms the task drains the link: a leaf checks for its Ack,
+ * resends on timeout and, when its period is due, sends the ApiServer's
+ * sensor and pump DTOs (the same reads the stream task makes); a gateway
+ * acknowledges and stores leaf reports, which the ApiServer then serves.
+ */
+
+#ifndef WATERINGSYSTEM_MAIN_ESPNOW_TASK_H
+#define WATERINGSYSTEM_MAIN_ESPNOW_TASK_H
+
+#include "api/ApiServer.h"
+#include "api/NodeGateway.h"
+#include "api/NodeLeaf.h"
+#include "interfaces/IWallClock.h"
+
+/**
+ * @brief The firmware's one NodeLeaf (a function-local static), configured
+ * from Kconfig: the gateway MAC, the period, a per-node phase from the
+ * station MAC and a random first seq.
+ *
+ * Boot wiring, once. Nothing is sent until espnow_leaf_start().
+ */
+api::NodeLeaf& espnow_leaf_init();
+
+/**
+ * @brief Start ESP-NOW and the leaf task over @p leaf, reporting @p server's
+ * readings.
+ *
+ * Station mode only (the radio must be started), once; @p server must
+ * outlive the task. A malformed WS_ESPNOW_GATEWAY_MAC or a failed start is
+ * logged and the leaf stays silent — the node itself is unaffected.
+ */
+void espnow_leaf_start(api::NodeLeaf& leaf, api::ApiServer& server);
+
+/**
+ * @brief The firmware's one NodeGateway (a function-local static), stamping
+ * leaf reports with @p clock when they carry no timestamp.
+ *
+ * Boot wiring, once; @p clock must outlive it. Nothing is received until
+ * espnow_gateway_start().
+ */
+api::NodeGateway& espnow_gateway_init(const IWallClock& clock);
+
+/// Start ESP-NOW and the gateway task over @p gateway. Station mode only,
+/// once; a failure is logged and swallowed like the leaf's.
+void espnow_gateway_start(api::NodeGateway& gateway);
+
+#endif /* WATERINGSYSTEM_MAIN_ESPNOW_TASK_H */
@@ -0,0 +1,43 @@
+// SPDX-FileCopyrightText: 2026 Cryptotomte
+// SPDX-License-Identifier: AGPL-3.0-or-later
+/**
+ * @file event_wait_task.cpp
+ * @brief /api/v1/events?wait= worker (see event_wait_task.h).
+ */
+
+#include "event_wait_task.h"
+
+#include "esp_log.h"
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+
+#include "task_plan.h"
+
+static const char *TAG = "event_wait";
+
+namespace {
+
+constexpr uint32_t kWaitMs = 1000;      ///< queue wait per loop while idle
+
+[[noreturn]] void event_wait_task(void *arg)
+{
+    api::ApiServer &server = *static_cast<api::ApiServer *>(arg);
+    while (true) {
+        (void)server.serveEventWaits(kWaitMs);
+    }
+}
+
+}  // namespace
+
+void event_wait_task_start(api::ApiServer& server, EventNotifier& notifier,
+                           uint32_t maxWaitS)
+{
+    if (task_plan_create<task_plan::kEventWait>(event_wait_task, &server) != pdPASS) {
+        ESP_LOGE(TAG, "failed to create event-wait task; tail reads answer at once");
+        return;
+    }
+    // Only with the worker there: a held read needs it to be answered.
+    server.setEventWait(notifier, maxWaitS);
+    ESP_LOGI(TAG, "event-wait worker started (wait up to %lu s)",
+             static_cast<unsigned long>(maxWaitS));
+}
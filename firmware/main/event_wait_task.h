@@ -0,0 +1,37 @@
+// SPDX-FileCopyrightText: 2026 Cryptotomte
+// SPDX-License-Identifier: AGPL-3.0-or-later
+/**
+ * @file event_wait_task.h
+ * @brief Worker task that answers the held GET /api/v1/events?wait= reads.
+ *
+ * App-level FreeRTOS task: a tail read (api/EventTail.h) that finds nothing
+ * past its cursor is detached from httpd and handed here
+ * (ApiServer::serveEventWaits()). The worker sleeps on the EventLogger's
+ * notifier, so an event stored on any task reaches a waiting client at
+ * once, and answers an empty body when the client's `wait` runs out.
+ */
+
+#ifndef WATERINGSYSTEM_MAIN_EVENT_WAIT_TASK_H
+#define WATERINGSYSTEM_MAIN_EVENT_WAIT_TASK_H
+
+#include <cstdint>
+
+#include "api/ApiServer.h"
+#include "events/EventNotifier.h"
+
+/**
+ * @brief Start the event-wait worker and enable `wait` on @p server.
+ *
+ * Call once, before the server starts (station mode only). Not
+ * watchdog-subscribed (network side, like the selftest worker). When the
+ * task cannot be created (logged) `wait` stays off: tail reads answer at
+ * once.
+ *
+ * @param server    Must outlive the task (a function-local static).
+ * @param notifier  The EventLogger's; must outlive the task.
+ * @param maxWaitS  Longest `wait` honoured, seconds.
+ */
+void event_wait_task_start(api::ApiServer& server, EventNotifier& notifier,
+                           uint32_t maxWaitS);
+
+#endif /* WATERINGSYSTEM_MAIN_EVENT_WAIT_TASK_H */
@@ -0,0 +1,42 @@
+// SPDX-FileCopyrightText: 2026 Cryptotomte
+// SPDX-License-Identifier: AGPL-3.0-or-later
+/**
+ * @file i2c_task.cpp
+ * @brief Serves I2cBusMaster's queue (see i2c_task.h).
+ */
+
+#include "i2c_task.h"
+
+#include "esp_log.h"
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+
+#include "task_plan.h"
+
+static const char *TAG = "i2c_task";
+
+namespace {
+
+constexpr uint32_t kWaitMs = 1000;      ///< queue wait per loop
+
+[[noreturn]] void i2c_task(void *arg)
+{
+    I2cBusMaster &bus = *static_cast<I2cBusMaster *>(arg);
+    while (true) {
+        bus.serve(kWaitMs);
+    }
+}
+
+}  // namespace
+
+void i2c_task_start(I2cBusMaster& bus)
+{
+    const BaseType_t created =
+        task_plan_create<task_plan::kI2c>(i2c_task, &bus);
+    if (created != pdPASS) {
+        ESP_LOGE(TAG, "failed to create i2c task (bus calls run inline)");
+        return;
+    }
+    ESP_LOGI(TAG, "I2C bus task started (%lu Hz)",
+             static_cast<unsigned long>(bus.clockSpeedHz()));
+}
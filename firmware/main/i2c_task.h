@@ -0,0 +1,30 @@
+// SPDX-FileCopyrightText: 2026 Cryptotomte
+// SPDX-License-Identifier: AGPL-3.0-or-later
+/**
+ * @file i2c_task.h
+ * @brief Shared I2C bus-owner task (app wiring).
+ *
+ * App-level FreeRTOS task, not a component: it runs I2cBusMaster's serve()
+ * loop, so every BME280 and INA226 transaction is queued and run here,
+ * whatever is queued at once in one batch.
+ */
+
+#ifndef WATERINGSYSTEM_MAIN_I2C_TASK_H
+#define WATERINGSYSTEM_MAIN_I2C_TASK_H
+
+#include "sensors/I2cBusMaster.h"
+
+/**
+ * @brief Start the bus task.
+ *
+ * Call once, after the I2C sensors are initialized (boot init and the
+ * fast-mode probe run inline). Not watchdog-subscribed: it sleeps on the
+ * queue between batches, and one transaction is bounded by the bus
+ * timeout. A creation failure is logged and swallowed — the bus master
+ * then keeps running every transaction on its caller, mutex-serialized.
+ *
+ * @param bus Must outlive the task (a function-local static).
+ */
+void i2c_task_start(I2cBusMaster& bus);
+
+#endif /* WATERINGSYSTEM_MAIN_I2C_TASK_H */
@@ -0,0 +1,228 @@
+// SPDX-FileCopyrightText: 2026 Cryptotomte
+// SPDX-License-Identifier: AGPL-3.0-or-later
+/**
+ * @file lifetime_counters.cpp
+ * @brief RTC_NOINIT blocks, NVS copy and sampler task of the lifetime
+ *        counters (see lifetime_counters.h).
+ *
+ * The two RTC blocks are written alternately, so the one not being written
+ * is always intact; restore() picks the newer valid one, or the NVS copy
+ * when both are garbage (power-on). The NVS copy lives in its own
+ * namespace, so a config factory reset keeps the totals. The sampler only
+ * reads getters that never touch flash, except getStorageStats(), which
+ * waits for the storage lock at this task's (lowest) priority.
+ */
+
+#include "lifetime_counters.h"
+
+#include <cstdint>
+
+#include "esp_attr.h"
+#include "esp_log.h"
+#include "esp_system.h"
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+#include "nvs.h"
+
+#include "task_plan.h"
+
+static const char *TAG = "counters";
+
+namespace {
+
+constexpr uint32_t kSealMs = 1000;
+constexpr uint32_t kFlushEverySeals =
+    CONFIG_WS_LIFETIME_COUNTERS_NVS_FLUSH_MIN * 60u * 1000u / kSealMs;
+constexpr const char* kNamespace = "ws_counters";
+constexpr const char* kKeyBlock = "block";
+constexpr const char* kKeyEvents = "events";
+
+RTC_NOINIT_ATTR LifetimeCounterBlock s_rtc[2];
+RTC_NOINIT_ATTR EventCountBlock s_rtc_events[2];
+
+LifetimeSources s_sources;
+bool s_started = false;
+
+LifetimeCounters& counters()
+{
+    static LifetimeCounters instance;
+    return instance;
+}
+
+/// The RTC block the next seal() goes to: not the newest one.
+LifetimeCounterBlock& next_rtc_block()
+{
+    return s_rtc[(counters().sequence() + 1) & 1u];
+}
+
+/// The event-count RTC block the next seal() goes to.
+EventCountBlock& next_rtc_events(const EventCounts& counts)
+{
+    return s_rtc_events[(counts.sequence() + 1) & 1u];
+}
+
+template <typename Block>
+bool read_nvs(const char* key, Block& out)
+{
+    nvs_handle_t handle = 0;
+    if (nvs_open(kNamespace, NVS_READONLY, &handle) != ESP_OK) {
+        return false;  // never flushed yet
+    }
+    size_t len = sizeof out;
+    const esp_err_t err = nvs_get_blob(handle, key, &out, &len);
+    nvs_close(handle);
+    return err == ESP_OK && len == sizeof out;
+}
+
+/// One commit for the totals and, when given, the event counts.
+void write_nvs(const LifetimeCounterBlock& block, const EventCountBlock* events)
+{
+    nvs_handle_t handle = 0;
+    esp_err_t err = nvs_open(kNamespace, NVS_READWRITE, &handle);
+    if (err == ESP_OK) {
+        err = nvs_set_blob(handle, kKeyBlock, &block, sizeof block);
+        if (err == ESP_OK && events != nullptr) {
+            err = nvs_set_blob(handle, kKeyEvents, events, sizeof *events);
+        }
+        if (err == ESP_OK) {
+            err = nvs_commit(handle);
+        }
+        nvs_close(handle);
+    }
+    if (err != ESP_OK) {
+        ESP_LOGW(TAG, "NVS flush failed: %s", esp_err_to_name(err));
+    }
+}
+
+/// Seal the event counts into their next RTC block; null without counts.
+const EventCountBlock* seal_events(EventCounts* counts)
+{
+    if (counts == nullptr) {
+        return nullptr;
+    }
+    EventCountBlock& block = next_rtc_events(*counts);
+    counts->seal(block);
+    return &block;
+}
+
+/// Copy every source's since-boot figure into the counters.
+void sample(const LifetimeSources& s)
+{
+    LifetimeCounters& c = counters();
+    if (s.plantPump != nullptr) {
+        c.sample(LifetimeCounter::PlantPumpRunMs,
+                 static_cast<uint64_t>(s.plantPump->getAccumulatedRunTimeMs()));
+    }
+    if (s.reservoirPump != nullptr) {
+        c.sample(LifetimeCounter::ReservoirPumpRunMs,
+                 static_cast<uint64_t>(s.reservoirPump->getAccumulatedRunTimeMs()));
+    }
+    uint64_t zoneMs = 0;
+    for (std::size_t i = 0; i < s.zonePumpCount; ++i) {
+        zoneMs += static_cast<uint64_t>(s.zonePumps[i]->getAccumulatedRunTimeMs());
+    }
+    c.sample(LifetimeCounter::ZonePumpRunMs, zoneMs);
+    if (s.events != nullptr) {
+        c.sample(LifetimeCounter::EventsDropped, s.events->droppedEvents());
+    }
+    if (s.storage != nullptr) {
+        const StorageStats stats = s.storage->getStorageStats();
+        c.sample(LifetimeCounter::StorageQueueDropped, stats.queue.dropped);
+        c.sample(LifetimeCounter::StorageBytesAppended, stats.writes.bytesAppended);
+        c.sample(LifetimeCounter::StorageSyncs, stats.writes.syncs);
+    }
+}
+
+/// esp_restart() shutdown handler: seal and copy to NVS, so a controlled
+/// reboot (OTA, `restart`) loses nothing even if RTC memory does not hold.
+void flush_on_shutdown()
+{
+    LifetimeCounterBlock& block = next_rtc_block();
+    counters().seal(block);
+    write_nvs(block, seal_events(s_sources.eventCounts));
+}
+
+[[noreturn]] void counters_task(void* arg)
+{
+    (void)arg;
+    TickType_t lastWake = xTaskGetTickCount();
+    uint32_t seals = 0;
+    while (true) {
+        vTaskDelayUntil(&lastWake, pdMS_TO_TICKS(kSealMs));
+        sample(s_sources);
+        LifetimeCounterBlock& block = next_rtc_block();
+        counters().seal(block);
+        const EventCountBlock* events = seal_events(s_sources.eventCounts);
+        if (++seals >= kFlushEverySeals) {
+            seals = 0;
+            write_nvs(block, events);
+        }
+    }
+}
+
+}  // namespace
+
+void lifetime_counters_start(const LifetimeSources& sources, int resetReason)
+{
+    if (s_started) {
+        return;
+    }
+    s_started = true;
+    s_sources = sources;
+
+    static LifetimeCounterBlock nvs_copy{};
+    const bool have_nvs = read_nvs(kKeyBlock, nvs_copy);
+    LifetimeCounters& c = counters();
+    const LifetimeCounterBlock* from =
+        c.restore({&s_rtc[0], &s_rtc[1], have_nvs ? &nvs_copy : nullptr});
+    ESP_LOGI(TAG, "restored from %s (sequence %lu)",
+             from == nullptr ? "nothing" : (from == &nvs_copy ? "NVS" : "RTC memory"),
+             static_cast<unsigned long>(c.sequence()));
+
+    c.add(LifetimeCounter::Boots, 1);
+    switch (static_cast<esp_reset_reason_t>(resetReason)) {
+        case ESP_RST_TASK_WDT:
+        case ESP_RST_INT_WDT:
+        case ESP_RST_WDT:
+            c.add(LifetimeCounter::WatchdogResets, 1);
+            break;
+        case ESP_RST_PANIC:
+            c.add(LifetimeCounter::PanicResets, 1);
+            break;
+        case ESP_RST_BROWNOUT:
+            c.add(LifetimeCounter::BrownoutResets, 1);
+            break;
+        default:
+            break;
+    }
+    // Sealed at once: a reset before the first tick still counts this boot.
+    c.seal(next_rtc_block());
+
+    if (task_plan_create<task_plan::kCounters>(counters_task, nullptr) != pdPASS) {
+        ESP_LOGE(TAG, "failed to create counters task");
+        return;
+    }
+    const esp_err_t err = esp_register_shutdown_handler(&flush_on_shutdown);
+    if (err != ESP_OK) {
+        ESP_LOGW(TAG, "shutdown flush not registered: %s", esp_err_to_name(err));
+    }
+}
+
+void event_counts_restore(EventCounts& counts, const IDataStorage& storage)
+{
+    if (counts.restore({&s_rtc_events[0], &s_rtc_events[1]}) != nullptr) {
+        ESP_LOGI(TAG, "event counts restored from RTC memory (sequence %lu)",
+                 static_cast<unsigned long>(counts.sequence()));
+        return;
+    }
+    static EventCountBlock nvs_copy{};
+    const bool have_nvs = read_nvs(kKeyEvents, nvs_copy);
+    const std::size_t read = counts.rebuild(storage, have_nvs ? &nvs_copy : nullptr);
+    ESP_LOGI(TAG, "event counts rebuilt from %u logged events%s",
+             static_cast<unsigned>(read), have_nvs ? " and NVS" : "");
+}
+
+const LifetimeCounters& lifetime_counters()
+{
+    return counters();
+}
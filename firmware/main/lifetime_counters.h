@@ -0,0 +1,68 @@
+// SPDX-FileCopyrightText: 2026 Cryptotomte
+// SPDX-License-Identifier: AGPL-3.0-or-later
+/**
+ * @file lifetime_counters.h
+ * @brief Reset-surviving counters in RTC memory, flushed to NVS on a slow
+ *        cadence (app wiring).
+ *
+ * Owns the RTC_NOINIT blocks and the NVS copy behind the pure
+ * LifetimeCounters (interfaces/LifetimeCounters.h), and a low-priority task
+ * that once a second samples the since-boot sources (pump run time, the
+ * event logger's drops, the storage write counters) and seals the totals
+ * into RTC memory — no flash write per increment. The NVS copy is written
+ * every CONFIG_WS_LIFETIME_COUNTERS_NVS_FLUSH_MIN and from an esp_restart()
+ * shutdown handler, so a power cycle loses at most one interval.
+ *
+ * The event logger's hourly counts (events/EventCounts.h) ride along: sealed
+ * into their own RTC blocks on the same tick and copied to NVS with the
+ * totals.
+ */
+
+#ifndef WATERINGSYSTEM_MAIN_LIFETIME_COUNTERS_H
+#define WATERINGSYSTEM_MAIN_LIFETIME_COUNTERS_H
+
+#include <cstddef>
+
+#include "events/EventCounts.h"
+#include "events/EventLogger.h"
+#include "interfaces/IDataStorage.h"
+#include "interfaces/IWaterPump.h"
+#include "interfaces/LifetimeCounters.h"
+
+/// What the counters task samples; every pointer may be null (not counted).
+/// All must outlive the task (function-local statics from app_main).
+struct LifetimeSources {
+    const IWaterPump* plantPump = nullptr;
+    const IWaterPump* reservoirPump = nullptr;
+    const IWaterPump* const* zonePumps = nullptr;
+    std::size_t zonePumpCount = 0;
+    const EventLogger* events = nullptr;
+    const IDataStorage* storage = nullptr;
+    EventCounts* eventCounts = nullptr;  ///< sealed, not sampled
+};
+
+/**
+ * @brief Restore @p counts: from the RTC blocks after a warm reset (added
+ * to the events counted since boot), else recounted from @p storage's event
+ * log, which already holds this boot's events, and merged with the NVS
+ * checkpoint. Boot wiring, once, after nvs_flash_init() and the storage
+ * mount (storage_mount_task); the cold path reads up to a day of events
+ * from flash.
+ */
+void event_counts_restore(EventCounts& counts, const IDataStorage& storage);
+
+/**
+ * @brief Restore the totals (RTC blocks, else the NVS copy), count this
+ * boot and its @p resetReason (esp_reset_reason_t as int), start the
+ * counters task and register the shutdown flush.
+ *
+ * Boot wiring, once, after nvs_flash_init(). A task creation failure is
+ * logged; the restored totals (boots included) then stay readable but stop
+ * moving.
+ */
+void lifetime_counters_start(const LifetimeSources& sources, int resetReason);
+
+/// The firmware's one LifetimeCounters (a function-local static).
+const LifetimeCounters& lifetime_counters();
+
+#endif /* WATERINGSYSTEM_MAIN_LIFETIME_COUNTERS_H */
@@ -0,0 +1,165 @@
+// SPDX-FileCopyrightText: 2026 Cryptotomte
+// SPDX-License-Identifier: AGPL-3.0-or-later
+/**
+ * @file log_sink.cpp
+ * @brief The vprintf hook and the task that drains it to the UART.
+ *
+ * The hook runs on every logging task: one vsnprintf into a claimed ring
+ * slot, no lock, no UART. The task wakes every kDrainMs, writes each queued
+ * line through the vprintf the hook replaced and appends it to the tail.
+ * Its own drop report goes straight to the UART: through ESP_LOG it would
+ * queue behind the lines it reports on. At a restart the task is asked to
+ * stop between lines rather than suspended: mid-line it may hold the
+ * stdout or tail lock, which the shutdown flush then needs.
+ */
+
+#include "log_sink.h"
+
+#include <atomic>
+#include <cstdarg>
+#include <cstdio>
+
+#include "esp_log.h"
+#include "esp_system.h"
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+#include "sdkconfig.h"
+
+#include "task_plan.h"
+
+#if defined(CONFIG_WS_LOG_SINK)
+
+static const char *TAG = "log_sink";
+
+namespace {
+
+constexpr uint32_t kDrainMs = 10;  ///< longest a line waits in the ring
+constexpr uint32_t kStopWaitMs = 200;  ///< the shutdown flush waits this for the task
+
+constexpr std::size_t kRingLines = CONFIG_WS_LOG_SINK_LINES;
+static_assert((kRingLines & (kRingLines - 1)) == 0,
+              "CONFIG_WS_LOG_SINK_LINES must be a power of two");
+
+using Ring = LogRing<kRingLines>;
+
+Ring& ring()
+{
+    static Ring lines;
+    return lines;
+}
+
+LogTail& tail()
+{
+    static LogTail lines;
+    return lines;
+}
+
+vprintf_like_t s_previous = nullptr;  ///< the UART writer the hook replaced
+TaskHandle_t s_task = nullptr;
+std::atomic<bool> s_stop{false};     ///< shutdown: leave the ring to the handler
+std::atomic<bool> s_stopped{false};  ///< the task saw s_stop, between lines
+
+int write_previous(const char* fmt, ...)
+{
+    va_list args;
+    va_start(args, fmt);
+    const int n = s_previous(fmt, args);
+    va_end(args);
+    return n;
+}
+
+/// esp_log_set_vprintf() hook: format into the ring, never wait.
+int log_sink_vprintf(const char* fmt, va_list args)
+{
+    int wanted = 0;
+    ring().emplace([&](char* buf, std::size_t cap) {
+        va_list copy;
+        va_copy(copy, args);
+        wanted = std::vsnprintf(buf, cap, fmt, copy);
+        va_end(copy);
+        return wanted;
+    });
+    return wanted;
+}
+
+/// Write out and keep every queued line; report new drops. The task's
+/// pass (@p stoppable) ends early, between lines, once s_stop is set.
+void drain(uint32_t& reportedDrops, bool stoppable)
+{
+    LogLine line;
+    while (!(stoppable && s_stop.load()) && ring().pop(line)) {
+        write_previous("%.*s", static_cast<int>(line.length), line.text);
+        tail().append(line);
+    }
+    const uint32_t dropped = ring().dropped();
+    if (dropped != reportedDrops) {
+        write_previous("W %s: %lu log lines dropped (ring full)\n", TAG,
+                       static_cast<unsigned long>(dropped));
+        tail().setDropped(dropped);
+        reportedDrops = dropped;
+    }
+}
+
+/// esp_restart() shutdown handler: stop the task, go synchronous again,
+/// then flush. The task finishes its current line and acknowledges, so
+/// the ring has one reader and no lock is left held. Should it not answer
+/// in kStopWaitMs, the queued lines are given up rather than risk a hang.
+void flush_on_shutdown()
+{
+    s_stop.store(true);
+    const TickType_t start = xTaskGetTickCount();
+    while (!s_stopped.load() && xTaskGetTickCount() - start < pdMS_TO_TICKS(kStopWaitMs)) {
+        vTaskDelay(1);
+    }
+    esp_log_set_vprintf(s_previous);
+    if (!s_stopped.load()) {
+        return;
+    }
+    uint32_t reported = ring().dropped();
+    drain(reported, false);
+}
+
+[[noreturn]] void log_sink_task(void* /*arg*/)
+{
+    uint32_t reportedDrops = 0;
+    while (!s_stop.load()) {
+        drain(reportedDrops, true);
+        vTaskDelay(pdMS_TO_TICKS(kDrainMs));
+    }
+    s_stopped.store(true);
+    while (true) {
+        vTaskSuspend(nullptr);
+    }
+}
+
+}  // namespace
+
+bool log_sink_start()
+{
+    // The ring and the tail are built before the first line can reach
+    // them; the hook is in before the task that calls what it replaced.
+    ring();
+    tail();
+    s_previous = esp_log_set_vprintf(&log_sink_vprintf);
+    const BaseType_t created =
+        task_plan_create<task_plan::kLogSink>(log_sink_task, nullptr, &s_task);
+    if (created != pdPASS) {
+        esp_log_set_vprintf(s_previous);
+        uint32_t reported = ring().dropped();
+        drain(reported, false);
+        ESP_LOGE(TAG, "failed to create log sink task; logging stays synchronous");
+        return false;
+    }
+    const esp_err_t err = esp_register_shutdown_handler(&flush_on_shutdown);
+    if (err != ESP_OK) {
+        ESP_LOGW(TAG, "shutdown flush not registered: %s", esp_err_to_name(err));
+    }
+    return true;
+}
+
+const LogTail& log_sink_tail()
+{
+    return tail();
+}
+
+#endif  // CONFIG_WS_LOG_SINK
@@ -0,0 +1,40 @@
+// SPDX-FileCopyrightText: 2026 Cryptotomte
+// SPDX-License-Identifier: AGPL-3.0-or-later
+/**
+ * @file log_sink.h
+ * @brief Asynchronous ESP_LOG output: formatted on the calling task into a
+ *        lock-free ring, written to the UART by a low-priority task
+ *        (app wiring).
+ *
+ * App-level FreeRTOS task, not a component. log_sink_start() installs an
+ * esp_log_set_vprintf() hook that formats each line into a LogRing
+ * (interfaces/LogRing.h) and returns at once, so a logging sensor or
+ * watering task no longer waits for the UART. The log_sink task drains the
+ * ring every few milliseconds through the previous vprintf (the console
+ * UART) and keeps the newest lines in a LogTail for GET /api/v1/logs. A
+ * line that finds the ring full is dropped and counted; the task prints
+ * the count when it grows. Built with CONFIG_WS_LOG_SINK only.
+ */
+
+#ifndef WATERINGSYSTEM_MAIN_LOG_SINK_H
+#define WATERINGSYSTEM_MAIN_LOG_SINK_H
+
+#include "interfaces/LogRing.h"
+
+/**
+ * @brief Start the drain task, then route ESP_LOG through the ring.
+ *
+ * Call once, early in app_main (before the other tasks). Also registers
+ * an esp_restart() shutdown handler that puts the previous vprintf back
+ * and writes out what is still queued, so the last lines before a reboot
+ * are not lost. Not watchdog-subscribed.
+ *
+ * @return false when the task could not be created — logging then stays
+ *         synchronous, as before.
+ */
+bool log_sink_start();
+
+/// The newest lines written out (empty until log_sink_start()).
+const LogTail& log_sink_tail();
+
+#endif /* WATERINGSYSTEM_MAIN_LOG_SINK_H */
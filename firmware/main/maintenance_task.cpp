@@ -0,0 +1,52 @@
+// SPDX-FileCopyrightText: 2026 Cryptotomte
+// SPDX-License-Identifier: AGPL-3.0-or-later
+/**
+ * @file maintenance_task.cpp
+ * @brief The history upkeep loop (see maintenance_task.h).
+ *
+ * One maintain() step holds the storage lock for at most a chunk read, an
+ * encode and a write+fsync (tens of milliseconds on flash). kStepGapMs
+ * between steps hands the lock and the core back to the storage writer
+ * and the readers; kIdleMs is how long new work (a seal, a finished
+ * bucket) may wait once a sweep found none.
+ */
+
+#include "maintenance_task.h"
+
+#include <cstdint>
+
+#include "esp_log.h"
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+
+#include "sdkconfig.h"
+#include "task_plan.h"
+
+#if defined(CONFIG_WS_HISTORY_BACKGROUND_MAINTENANCE)
+
+static const char *TAG = "maintenance";
+
+namespace {
+
+constexpr uint32_t kStepGapMs = 50;
+constexpr uint32_t kIdleMs = 60 * 1000;
+
+[[noreturn]] void maintenance_task(void *arg)
+{
+    IDataStorage& storage = *static_cast<IDataStorage *>(arg);
+    while (true) {
+        const bool more = storage.maintain();
+        vTaskDelay(pdMS_TO_TICKS(more ? kStepGapMs : kIdleMs));
+    }
+}
+
+}  // namespace
+
+void maintenance_task_start(IDataStorage& storage)
+{
+    if (task_plan_create<task_plan::kMaintenance>(maintenance_task, &storage) != pdPASS) {
+        ESP_LOGE(TAG, "failed to create maintenance task");
+    }
+}
+
+#endif  // CONFIG_WS_HISTORY_BACKGROUND_MAINTENANCE
@@ -0,0 +1,30 @@
+// SPDX-FileCopyrightText: 2026 Cryptotomte
+// SPDX-License-Identifier: AGPL-3.0-or-later
+/**
+ * @file maintenance_task.h
+ * @brief Low-priority history upkeep off the append path (app wiring,
+ *        CONFIG_WS_HISTORY_BACKGROUND_MAINTENANCE).
+ *
+ * App-level FreeRTOS task, not a component: it calls
+ * IDataStorage::maintain() one bounded step at a time — a due rollup
+ * update, or one sealed history chunk recompacted — with a pause after
+ * each, and sleeps long once a step reports nothing pending.
+ */
+
+#ifndef WATERINGSYSTEM_MAIN_MAINTENANCE_TASK_H
+#define WATERINGSYSTEM_MAIN_MAINTENANCE_TASK_H
+
+#include "interfaces/IDataStorage.h"
+
+/**
+ * @brief Start the maintenance task over @p storage.
+ *
+ * Pass the cross-task storage (the writer queue over the
+ * LockedDataStorage); it must outlive the task. A step that finds the
+ * storage lock held is skipped, so the task never delays a write. Not
+ * watchdog-subscribed. A creation failure is logged: rollups then stay
+ * due and are answered from raw history, chunks stay as written.
+ */
+void maintenance_task_start(IDataStorage& storage);
+
+#endif /* WATERINGSYSTEM_MAIN_MAINTENANCE_TASK_H */
@@ -0,0 +1,41 @@
+// SPDX-FileCopyrightText: 2026 Cryptotomte
+// SPDX-License-Identifier: AGPL-3.0-or-later
+/**
+ * @file modbus_task.cpp
+ * @brief Serves ModbusBusMaster's queue (see modbus_task.h).
+ */
+
+#include "modbus_task.h"
+
+#include "esp_log.h"
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+
+#include "task_plan.h"
+
+static const char *TAG = "modbus_task";
+
+namespace {
+
+constexpr uint32_t kWaitMs = 1000;      ///< queue wait per loop
+
+[[noreturn]] void modbus_task(void *arg)
+{
+    ModbusBusMaster &bus = *static_cast<ModbusBusMaster *>(arg);
+    while (true) {
+        bus.serve(kWaitMs);
+    }
+}
+
+}  // namespace
+
+void modbus_task_start(ModbusBusMaster& bus)
+{
+    const BaseType_t created =
+        task_plan_create<task_plan::kModbus>(modbus_task, &bus);
+    if (created != pdPASS) {
+        ESP_LOGE(TAG, "failed to create modbus task (bus calls run inline)");
+        return;
+    }
+    ESP_LOGI(TAG, "RS485 bus task started");
+}
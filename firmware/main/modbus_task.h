@@ -0,0 +1,30 @@
+// SPDX-FileCopyrightText: 2026 Cryptotomte
+// SPDX-License-Identifier: AGPL-3.0-or-later
+/**
+ * @file modbus_task.h
+ * @brief RS485 bus-owner task (app wiring).
+ *
+ * App-level FreeRTOS task, not a component: it runs ModbusBusMaster's
+ * serve() loop, so every soil read and console probe is one queued
+ * transaction run here, most urgent first.
+ */
+
+#ifndef WATERINGSYSTEM_MAIN_MODBUS_TASK_H
+#define WATERINGSYSTEM_MAIN_MODBUS_TASK_H
+
+#include "sensors/ModbusBusMaster.h"
+
+/**
+ * @brief Start the bus task.
+ *
+ * Call once, after the client is initialized (boot init runs inline).
+ * Not watchdog-subscribed: it sleeps on the queue between transactions
+ * and its longest wait is one response timeout. A creation failure is
+ * logged and swallowed — the bus master then keeps running every
+ * transaction on its caller, mutex-serialized.
+ *
+ * @param bus Must outlive the task (a function-local static).
+ */
+void modbus_task_start(ModbusBusMaster& bus);
+
+#endif /* WATERINGSYSTEM_MAIN_MODBUS_TASK_H */
@@ -0,0 +1,198 @@
+// SPDX-FileCopyrightText: 2026 Cryptotomte
+// SPDX-License-Identifier: AGPL-3.0-or-later
+/**
+ * @file mqtt_task.cpp
+ * @brief MQTT session start, watermark NVS copy and tick cadence (see
+ *        mqtt_task.h).
+ *
+ * 1 s is fine enough for a pump start to reach the next batch promptly and
+ * for the replay to refill the in-flight window, and coarse enough that the
+ * DTO reads cost nothing next to the stream task's 250 ms. The watermark is
+ * only written when it moved, at most every kMarkFlushMs: a reset loses at
+ * most a minute of acknowledgements, which are then replayed once more.
+ */
+
+#include "mqtt_task.h"
+
+#include <cstdint>
+#include <cstdio>
+#include <string>
+
+#include "esp_log.h"
+#include "esp_mac.h"
+#include "esp_timer.h"
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+#include "nvs.h"
+
+#include "network/EspMqttClient.h"
+#include "network/WifiState.h"
+
+#include "sdkconfig.h"
+#include "task_plan.h"
+
+// The CONFIG_WS_MQTT_* options exist only with the uplink enabled; app_main
+// calls nothing here otherwise.
+#if defined(CONFIG_WS_MQTT)
+
+static const char *TAG = "mqtt_task";
+
+namespace {
+
+constexpr uint32_t kPeriodMs = 1000;
+constexpr uint32_t kMarkFlushMs = 60 * 1000;
+constexpr const char* kNamespace = "ws_mqtt";
+constexpr const char* kKeyMark = "mark";
+
+struct MqttTaskArgs {
+    api::MqttUplink* uplink = nullptr;
+    api::ApiServer* server = nullptr;
+    WifiManager* wifi = nullptr;
+};
+
+MqttTaskArgs s_args;
+bool s_started = false;
+
+EspMqttClient& client()
+{
+    static EspMqttClient instance;
+    return instance;
+}
+
+uint32_t now_ms()
+{
+    return static_cast<uint32_t>(esp_timer_get_time() / 1000);
+}
+
+uint32_t read_mark()
+{
+    nvs_handle_t handle = 0;
+    if (nvs_open(kNamespace, NVS_READONLY, &handle) != ESP_OK) {
+        return 0;  // never acknowledged anything yet
+    }
+    uint32_t mark = 0;
+    (void)nvs_get_u32(handle, kKeyMark, &mark);
+    nvs_close(handle);
+    return mark;
+}
+
+void write_mark(uint32_t mark)
+{
+    nvs_handle_t handle = 0;
+    esp_err_t err = nvs_open(kNamespace, NVS_READWRITE, &handle);
+    if (err == ESP_OK) {
+        err = nvs_set_u32(handle, kKeyMark, mark);
+        if (err == ESP_OK) {
+            err = nvs_commit(handle);
+        }
+        nvs_close(handle);
+    }
+    if (err != ESP_OK) {
+        ESP_LOGW(TAG, "watermark not saved: %s", esp_err_to_name(err));
+    }
+}
+
+/// "ws-" + the last three bytes of the station MAC: client id and topic.
+void node_name(char (&out)[12])
+{
+    uint8_t mac[6] = {};
+    (void)esp_read_mac(mac, ESP_MAC_WIFI_STA);
+    std::snprintf(out, sizeof out, "ws-%02x%02x%02x", mac[3], mac[4], mac[5]);
+}
+
+/// Open the broker session the first time the station is Connected.
+void start_session(const char* node)
+{
+    EspMqttSettings settings;
+    settings.uri = CONFIG_WS_MQTT_BROKER_URI;
+    settings.clientId = node;
+    settings.username = CONFIG_WS_MQTT_USERNAME;
+    settings.password = CONFIG_WS_MQTT_PASSWORD;
+    settings.statusTopic = std::string(CONFIG_WS_MQTT_TOPIC_PREFIX) + "/" + node + "/status";
+    const esp_err_t err = client().start(settings);
+    if (err != ESP_OK) {
+        ESP_LOGE(TAG, "MQTT session not started: %s", esp_err_to_name(err));
+    }
+}
+
+[[noreturn]] void mqtt_task(void* arg)
+{
+    const MqttTaskArgs& args = *static_cast<const MqttTaskArgs*>(arg);
+    char node[12];
+    node_name(node);
+    bool sessionStarted = false;
+    uint32_t savedMark = args.uplink->watermark();
+    uint32_t lastFlushMs = now_ms();
+    TickType_t lastWake = xTaskGetTickCount();
+    while (true) {
+        vTaskDelayUntil(&lastWake, pdMS_TO_TICKS(kPeriodMs));
+        if (!sessionStarted && args.wifi->snapshot().state == WifiState::Connected) {
+            start_session(node);
+            sessionStarted = true;  // esp-mqtt reconnects by itself from here
+        }
+        const uint32_t now = now_ms();
+        args.uplink->tick(now, args.server->readSensors(), args.server->readPumps());
+        const uint32_t mark = args.uplink->watermark();
+        if (mark != savedMark && now - lastFlushMs >= kMarkFlushMs) {
+            write_mark(mark);
+            savedMark = mark;
+            lastFlushMs = now;
+        }
+    }
+}
+
+}  // namespace
+
+api::MqttUplink& mqtt_uplink_init(const IDataStorage& history, const IWallClock& clock)
+{
+    static api::MqttUplink uplink(client(), history, clock);
+    static bool configured = false;
+    if (!configured) {
+        configured = true;
+        char node[12];
+        node_name(node);
+        api::MqttUplinkConfig config;
+        config.topicBase = std::string(CONFIG_WS_MQTT_TOPIC_PREFIX) + "/" + node;
+        config.batchMs = static_cast<uint32_t>(CONFIG_WS_MQTT_BATCH_MS);
+        config.maxInflight = static_cast<std::size_t>(CONFIG_WS_MQTT_MAX_INFLIGHT);
+        uplink.configure(config);
+        uplink.restoreWatermark(read_mark());
+    }
+    return uplink;
+}
+
+void mqtt_task_start(api::MqttUplink& uplink, api::ApiServer& server, WifiManager& wifi)
+{
+    if (s_started) {
+        return;
+    }
+    s_started = true;
+    s_args = MqttTaskArgs{&uplink, &server, &wifi};
+    if (task_plan_create<task_plan::kMqtt>(mqtt_task, &s_args) != pdPASS) {
+        ESP_LOGE(TAG, "failed to create mqtt task");
+        return;
+    }
+    ESP_LOGI(TAG, "mqtt task started (%lu ms batches, watermark %lu)",
+             static_cast<unsigned long>(CONFIG_WS_MQTT_BATCH_MS),
+             static_cast<unsigned long>(uplink.watermark()));
+}
+
+bool mqtt_uplink_drain_step(api::MqttUplink& uplink, bool connected)
+{
+    static bool sessionStarted = false;
+    if (!sessionStarted && connected) {
+        char node[12];
+        node_name(node);
+        start_session(node);
+        sessionStarted = true;
+    }
+    uplink.tick(now_ms(), api::SensorReadingsDto{}, {});
+    const api::MqttUplinkStats stats = uplink.stats();
+    if (!stats.connected || stats.replaying || stats.inflight > 0) {
+        return false;
+    }
+    write_mark(uplink.watermark());
+    return true;
+}
+
+#endif  // CONFIG_WS_MQTT
@@ -0,0 +1,56 @@
+// SPDX-FileCopyrightText: 2026 Cryptotomte
+// SPDX-License-Identifier: AGPL-3.0-or-later
+/**
+ * @file mqtt_task.h
+ * @brief MQTT uplink wiring: broker session, persisted watermark and the
+ *        publisher task (app wiring, CONFIG_WS_MQTT).
+ *
+ * Owns the EspMqttClient and the pure api::MqttUplink above it. The task
+ * opens the session once the station first reaches Connected (esp-mqtt
+ * keeps it across drops from then on), then every second hands the uplink
+ * the ApiServer's sensor and pump DTOs — the same reads the stream task
+ * makes — and persists the uplink's watermark to NVS (namespace "ws_mqtt",
+ * at most once a minute), so a reboot replays only what the broker never
+ * acknowledged.
+ */
+
+#ifndef WATERINGSYSTEM_MAIN_MQTT_TASK_H
+#define WATERINGSYSTEM_MAIN_MQTT_TASK_H
+
+#include "api/ApiServer.h"
+#include "api/MqttUplink.h"
+#include "interfaces/IDataStorage.h"
+#include "interfaces/IWallClock.h"
+#include "network/WifiManager.h"
+
+/**
+ * @brief The firmware's one MqttUplink (a function-local static), replaying
+ * from @p history, configured from Kconfig, its watermark restored from NVS.
+ *
+ * Boot wiring, once, after nvs_flash_init(); @p history and @p clock must
+ * outlive it. Nothing is published until mqtt_task_start().
+ */
+api::MqttUplink& mqtt_uplink_init(const IDataStorage& history, const IWallClock& clock);
+
+/**
+ * @brief Start the publisher task over @p uplink.
+ *
+ * Station mode only, once; @p server and @p wifi must outlive the task.
+ * Not watchdog-subscribed (network side). A creation failure is logged and
+ * swallowed — the HTTP API is unaffected.
+ */
+void mqtt_task_start(api::MqttUplink& uplink, api::ApiServer& server, WifiManager& wifi);
+
+/**
+ * @brief One step of a bounded replay without the publisher task: the
+ * deep-sleep node's sync wake (sleep_node.h), which has no ApiServer.
+ *
+ * Opens the session on the first call with @p connected, ticks the uplink
+ * with no live readings (one batch with every sensor unavailable marks the
+ * sync) and, once drained, writes the watermark to NVS. Call every 100 ms
+ * or so with the wall clock set, so the replay can start.
+ * @return true once nothing is in flight and nothing is left to replay
+ */
+bool mqtt_uplink_drain_step(api::MqttUplink& uplink, bool connected);
+
+#endif /* WATERINGSYSTEM_MAIN_MQTT_TASK_H */
@@ -0,0 +1,132 @@
+// SPDX-FileCopyrightText: 2026 Cryptotomte
+// SPDX-License-Identifier: AGPL-3.0-or-later
+/**
+ * @file ota_task.cpp
+ * @brief The OTA writer loop, upload events, reboot and rollback
+ *        confirmation (see ota_task.h).
+ *
+ * The writer waits kWaitMs at a time so the same loop also notices the
+ * confirmation deadline. The reboot waits kRebootDelayMs after the report:
+ * the httpd task sends the response right after receive() returns, and
+ * esp_restart() runs the shutdown handlers (storage drain, counter seal)
+ * on the way down.
+ */
+
+#include "ota_task.h"
+
+#include <cstdint>
+#include <cstdio>
+
+#include "esp_log.h"
+#include "esp_ota_ops.h"
+#include "esp_system.h"
+#include "esp_timer.h"
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+
+#include "api/EspFirmwareSlot.h"
+#include "api/EspRunningImage.h"
+
+#include "sdkconfig.h"
+#include "task_plan.h"
+
+#if defined(CONFIG_WS_OTA)
+
+static const char *TAG = "ota_task";
+
+namespace {
+
+constexpr uint32_t kWaitMs = 1000;
+constexpr uint32_t kRebootDelayMs = 1500;
+constexpr int64_t kConfirmAfterMs = 60 * 1000;
+
+struct OtaTaskArgs {
+    api::OtaPipeline* ota = nullptr;
+    EventLogger* events = nullptr;
+};
+
+OtaTaskArgs s_args;
+bool s_started = false;
+
+/// Mark a first-boot image valid, cancelling the bootloader's rollback.
+void confirm_running_image()
+{
+    esp_ota_img_states_t state = ESP_OTA_IMG_UNDEFINED;
+    if (esp_ota_get_state_partition(esp_ota_get_running_partition(), &state) != ESP_OK ||
+        state != ESP_OTA_IMG_PENDING_VERIFY) {
+        return;
+    }
+    const esp_err_t err = esp_ota_mark_app_valid_cancel_rollback();
+    if (err != ESP_OK) {
+        ESP_LOGE(TAG, "image not confirmed: %s", esp_err_to_name(err));
+        return;
+    }
+    ESP_LOGI(TAG, "new image confirmed");
+    s_args.events->logOta("ota=confirmed");
+}
+
+void report(const api::OtaReport& r)
+{
+    char detail[112];
+    snprintf(detail, sizeof detail, "ota=%s%s bytes=%lu sent=%lu ms=%lu sha=%.16s",
+             api::otaOutcomeName(r.outcome), r.delta ? " delta" : "",
+             static_cast<unsigned long>(r.bytes), static_cast<unsigned long>(r.transferBytes),
+             static_cast<unsigned long>(r.elapsedMs),
+             r.outcome == api::OtaOutcome::Ok ? api::Sha256::toHex(r.sha256).c_str() : "-");
+    s_args.events->logOta(detail);
+}
+
+[[noreturn]] void ota_task(void *arg)
+{
+    (void)arg;
+    api::OtaPipeline& ota = *s_args.ota;
+    bool confirmed = false;
+    while (true) {
+        (void)ota.serveWrite(kWaitMs);
+        api::OtaReport r;
+        if (ota.takeReport(r)) {
+            report(r);
+            if (r.outcome == api::OtaOutcome::Ok) {
+                ESP_LOGI(TAG, "restarting into the new image");
+                vTaskDelay(pdMS_TO_TICKS(kRebootDelayMs));
+                esp_restart();
+            }
+        }
+        if (!confirmed && esp_timer_get_time() / 1000 >= kConfirmAfterMs) {
+            confirmed = true;
+            confirm_running_image();
+        }
+    }
+}
+
+}  // namespace
+
+api::OtaPipeline& ota_pipeline(ITimeProvider& clock)
+{
+    static api::EspFirmwareSlot slot;
+    static api::EspRunningImage running;
+    static api::OtaPipeline instance(slot, clock);
+    static bool wired = false;  // boot wiring only: app_main, one task
+    if (!wired) {
+        wired = true;
+        instance.setBaseImage(running);
+    }
+    return instance;
+}
+
+void ota_task_start(api::OtaPipeline& ota, EventLogger& events)
+{
+    if (s_started) {
+        return;
+    }
+    s_started = true;
+    s_args.ota = &ota;
+    s_args.events = &events;
+    if (task_plan_create<task_plan::kOta>(ota_task, nullptr) != pdPASS) {
+        ESP_LOGE(TAG, "failed to create ota task");
+        return;
+    }
+    ota.attachWriter();
+}
+
+#endif  // CONFIG_WS_OTA
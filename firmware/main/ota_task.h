@@ -0,0 +1,45 @@
+// SPDX-FileCopyrightText: 2026 Cryptotomte
+// SPDX-License-Identifier: AGPL-3.0-or-later
+/**
+ * @file ota_task.h
+ * @brief POST /api/v1/ota wiring: the firmware slot, the flash writer task
+ *        and the post-update reboot (app wiring, CONFIG_WS_OTA).
+ *
+ * Owns the EspFirmwareSlot, the EspRunningImage (the base of delta
+ * patches) and the pure api::OtaPipeline above them. The
+ * writer task sleeps on the pipeline between uploads; during one it writes
+ * each chunk the httpd task has received while that task receives the
+ * next. It logs each finished upload as an `ota` event and, after a
+ * committed one, restarts into the new image once the response is out.
+ *
+ * ROLLBACK (CONFIG_BOOTLOADER_APP_ROLLBACK_ENABLE): an image booted for
+ * the first time is marked valid by this task after it has run for
+ * kConfirmAfterMs; one that resets before then is rolled back by the
+ * bootloader.
+ */
+
+#ifndef WATERINGSYSTEM_MAIN_OTA_TASK_H
+#define WATERINGSYSTEM_MAIN_OTA_TASK_H
+
+#include "api/OtaPipeline.h"
+#include "events/EventLogger.h"
+#include "interfaces/ITimeProvider.h"
+
+/**
+ * @brief The firmware's one OtaPipeline (a function-local static) over the
+ * inactive app slot, taking delta patches against the running image.
+ * @p clock must outlive it.
+ */
+api::OtaPipeline& ota_pipeline(ITimeProvider& clock);
+
+/**
+ * @brief Start the writer task over @p ota.
+ *
+ * Once, at boot (station mode too: the rollback confirmation runs here).
+ * @p events must outlive the task. Not watchdog-subscribed (network side).
+ * A creation failure is logged: uploads then write on the httpd task, and
+ * the new image starts on the next reset.
+ */
+void ota_task_start(api::OtaPipeline& ota, EventLogger& events);
+
+#endif /* WATERINGSYSTEM_MAIN_OTA_TASK_H */
@@ -0,0 +1,130 @@
+// SPDX-FileCopyrightText: 2026 Cryptotomte
+// SPDX-License-Identifier: AGPL-3.0-or-later
+/**
+ * @file overcurrent_trip.cpp
+ * @brief Over-current trip ISR and deferred handler (see overcurrent_trip.h).
+ *
+ * Reaction time: the pump gate goes LOW a few microseconds after ALERT
+ * falls. ALERT itself falls at the end of the first conversion whose
+ * average is over the limit, so the detection runs on the INA226's result
+ * period — 35.2 ms at the default sampling, 1.12 ms while the current
+ * capture runs — not on the 100 ms pump loop.
+ *
+ * ALERT is transparent (not latched): it releases at the first result
+ * under the limit, which the stopped pump provides, so nothing has to
+ * acknowledge it over I2C. A pump commanded on again into the same fault
+ * simply trips again.
+ *
+ * Flash writes: the ISR and what it calls (GpioWaterPump::forceOffFromIsr(),
+ * vTaskNotifyGiveFromISR) are in IRAM, on the IRAM GPIO ISR service every
+ * installer here asks for (the first install decides for all), so the gate
+ * is cut while a littlefs fsync has the flash cache off. The task half
+ * waits for the write like every other task; `bench stop` measures both.
+ */
+
+#include "overcurrent_trip.h"
+
+#include <cstdio>
+
+#include "driver/gpio.h"
+#include "esp_attr.h"
+#include "esp_log.h"
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+
+#include "task_plan.h"
+
+static const char *TAG = "overcurrent";
+
+namespace {
+
+struct TripCtx {
+    GpioWaterPump* output;
+    IWaterPump* pump;
+    EventLogger* events;
+    uint32_t limitMa;
+};
+
+TripCtx ctx;
+TaskHandle_t s_task = nullptr;
+
+void IRAM_ATTR alert_isr(void *arg)
+{
+    static_cast<GpioWaterPump *>(arg)->forceOffFromIsr();
+    BaseType_t woken = pdFALSE;
+    vTaskNotifyGiveFromISR(s_task, &woken);
+    portYIELD_FROM_ISR(woken);
+}
+
+[[noreturn]] void overcurrent_task(void *arg)
+{
+    const TripCtx &c = *static_cast<const TripCtx *>(arg);
+    char detail[48];
+    std::snprintf(detail, sizeof(detail), "overcurrent pump=plant limit=%lumA",
+                  static_cast<unsigned long>(c.limitMa));
+    while (true) {
+        ulTaskNotifyTake(pdTRUE, portMAX_DELAY);
+        // The gate is already LOW; stop() records it in the state machine
+        // (and re-asserts OFF). An edge with the pump idle is not logged.
+        if (!c.pump->isRunning()) {
+            continue;
+        }
+        c.pump->stop();
+        c.events->logFailsafe(detail);
+        ESP_LOGE(TAG, "plant pump tripped: current above %lu mA",
+                 static_cast<unsigned long>(c.limitMa));
+    }
+}
+
+}  // namespace
+
+bool overcurrent_trip_start(GpioWaterPump& output, IWaterPump& pump,
+                            IPowerSensor& sensor, EventLogger& events,
+                            int alertGpio, uint32_t limitMa)
+{
+    if (alertGpio < 0) {
+        ESP_LOGW(TAG, "no ALERT GPIO configured — over-current trip not "
+                 "armed");
+        return false;
+    }
+    ctx.output = &output;
+    ctx.pump = &pump;
+    ctx.events = &events;
+    ctx.limitMa = limitMa;
+
+    if (!sensor.setOverCurrentLimit(static_cast<float>(limitMa) / 1000.0f)) {
+        // An unreachable sensor takes the limit at its next init.
+        ESP_LOGW(TAG, "alert limit not written yet (error %d)",
+                 sensor.getLastError());
+    }
+    // The task first: the ISR notifies it.
+    if (task_plan_create<task_plan::kOvercurrent>(overcurrent_task, &ctx, &s_task) != pdPASS) {
+        ESP_LOGE(TAG, "failed to create trip task — trip not armed");
+        return false;
+    }
+
+    gpio_config_t io = {};
+    io.pin_bit_mask = 1ULL << alertGpio;
+    io.mode = GPIO_MODE_INPUT;
+    io.pull_up_en = GPIO_PULLUP_ENABLE;  // ALERT is open drain
+    io.intr_type = GPIO_INTR_NEGEDGE;
+    esp_err_t err = gpio_config(&io);
+    if (err == ESP_OK) {
+        err = gpio_install_isr_service(ESP_INTR_FLAG_IRAM);
+        if (err == ESP_ERR_INVALID_STATE) {
+            err = ESP_OK;  // already installed by another driver
+        }
+    }
+    if (err == ESP_OK) {
+        err = gpio_isr_handler_add(static_cast<gpio_num_t>(alertGpio),
+                                   alert_isr, &output);
+    }
+    if (err != ESP_OK) {
+        ESP_LOGE(TAG, "ALERT interrupt on GPIO %d failed: %s — trip not "
+                 "armed", alertGpio, esp_err_to_name(err));
+        return false;
+    }
+    ESP_LOGI(TAG, "over-current trip armed: %lu mA on ALERT GPIO %d",
+             static_cast<unsigned long>(limitMa), alertGpio);
+    return true;
+}
@@ -0,0 +1,50 @@
+// SPDX-FileCopyrightText: 2026 Cryptotomte
+// SPDX-License-Identifier: AGPL-3.0-or-later
+/**
+ * @file overcurrent_trip.h
+ * @brief Plant pump over-current trip: INA226 ALERT straight to the pump
+ *        output (app wiring).
+ *
+ * App-level, not a component. The INA226 compares every averaged shunt
+ * voltage against its Alert Limit and pulls ALERT low while the current
+ * is above it; the falling edge's ISR drives the pump gate LOW at once,
+ * without waiting for the 10 Hz plant.update() loop or the I2C bus. The
+ * bookkeeping — stop() through the locked pump, the failsafe event — is
+ * deferred to a task.
+ */
+
+#ifndef WATERINGSYSTEM_MAIN_OVERCURRENT_TRIP_H
+#define WATERINGSYSTEM_MAIN_OVERCURRENT_TRIP_H
+
+#include <cstdint>
+
+#include "actuators/GpioWaterPump.h"
+#include "events/EventLogger.h"
+#include "interfaces/IPowerSensor.h"
+#include "interfaces/IWaterPump.h"
+
+/**
+ * @brief Arm the trip.
+ *
+ * Sets the over-current limit on @p sensor (re-written by every sensor
+ * re-initialization), attaches a falling-edge ISR to @p alertGpio and
+ * starts the deferred handler task. On a trip the ISR calls
+ * output.forceOffFromIsr(); the task then stops @p pump and logs a
+ * "overcurrent" failsafe event to @p events. Any setup failure is logged
+ * and leaves the trip unarmed — the software max-runtime cap and the
+ * watering fail-safes still apply.
+ *
+ * @param output    The plant pump's GpioWaterPump (the ISR's only use).
+ * @param pump      The same pump's LockedWaterPump, for the deferred stop.
+ * @param sensor    The LockedPowerSensor decorator.
+ * @param events    Persistent event log.
+ * @param alertGpio GPIO wired to the INA226 ALERT pin; < 0 = not armed.
+ * @param limitMa   Trip threshold in mA (CONFIG_WS_PUMP_OVERCURRENT_TRIP_MA).
+ * All must outlive the task (function-local statics).
+ * @return true when armed.
+ */
+bool overcurrent_trip_start(GpioWaterPump& output, IWaterPump& pump,
+                            IPowerSensor& sensor, EventLogger& events,
+                            int alertGpio, uint32_t limitMa);
+
+#endif /* WATERINGSYSTEM_MAIN_OVERCURRENT_TRIP_H */
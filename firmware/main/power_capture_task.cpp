@@ -0,0 +1,139 @@
+// SPDX-FileCopyrightText: 2026 Cryptotomte
+// SPDX-License-Identifier: AGPL-3.0-or-later
+/**
+ * @file power_capture_task.cpp
+ * @brief Pump current capture pacing (see power_capture_task.h).
+ *
+ * The tick (10 ms at the default CONFIG_FREERTOS_HZ) is far too coarse for
+ * 1.12 ms samples, so a periodic esp_timer at the conversion period
+ * notifies the task instead; the callback does nothing else. The reads run
+ * on this task, through the shared I2C bus master. A wake-up that finds
+ * several notifications pending records the periods it slept through as
+ * missed samples, so the sample timeline stays exact.
+ *
+ * The start of a run is seen within one tick of the pump output switching
+ * on: the first ~10 ms of the inrush may precede the first sample, its
+ * peak (tens of ms for the 12 V pump motor) does not.
+ */
+
+#include "power_capture_task.h"
+
+#include "esp_log.h"
+#include "esp_timer.h"
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+
+#include "task_plan.h"
+
+static const char *TAG = "power_capture";
+
+namespace {
+
+constexpr uint32_t kIdlePollMs = 10;        ///< pump state check while idle
+constexpr uint32_t kFallbackPeriodUs = 1120;  ///< sensor reports no period
+constexpr uint32_t kStallMs = 100;          ///< no timer tick: re-check the pump
+
+struct CaptureTaskCtx {
+    IPowerSensor* sensor;
+    IWaterPump* pump;
+    PumpCurrentCapture* capture;
+    EventLogger* events;
+};
+
+CaptureTaskCtx ctx;
+TaskHandle_t s_task = nullptr;
+esp_timer_handle_t s_timer = nullptr;
+
+void sample_due(void *arg)
+{
+    (void)arg;
+    xTaskNotifyGive(s_task);
+}
+
+/// One run, from the pump's start to its stop.
+void capture_run(CaptureTaskCtx &c)
+{
+    if (!c.sensor->setHighRateSampling(true)) {
+        ESP_LOGW(TAG, "high-rate sampling not set (error %d); capturing at "
+                 "the current rate", c.sensor->getLastError());
+    }
+    const uint32_t periodUs = c.sensor->conversionPeriodUs() != 0
+                                  ? c.sensor->conversionPeriodUs()
+                                  : kFallbackPeriodUs;
+    c.capture->beginRun(periodUs, esp_timer_get_time());
+    ulTaskNotifyTake(pdTRUE, 0);  // a stale tick from the last run
+    esp_timer_start_periodic(s_timer, periodUs);
+
+    while (c.pump->isRunning()) {
+        const uint32_t due = ulTaskNotifyTake(pdTRUE, pdMS_TO_TICKS(kStallMs));
+        if (due == 0) {
+            continue;
+        }
+        if (due > 1) {
+            c.capture->addMissed(due - 1);
+        }
+        float amps = 0.0f;
+        if (c.sensor->readCurrent(amps)) {
+            c.capture->addSample(amps);
+        } else {
+            c.capture->addMissed();
+        }
+    }
+
+    esp_timer_stop(s_timer);
+    c.sensor->setHighRateSampling(false);
+    const CurrentRunStats run = c.capture->endRun(esp_timer_get_time());
+    c.events->logPumpCurrent("plant", run.peakA, run.meanA, run.rmsA,
+                             run.samples, run.missed);
+    ESP_LOGI(TAG, "run %lu: %lu samples in %lu ms, peak %.3f A, mean %.3f A, "
+             "rms %.3f A (missed %lu, dropped %lu)",
+             static_cast<unsigned long>(run.run),
+             static_cast<unsigned long>(run.samples),
+             static_cast<unsigned long>(run.durationMs),
+             static_cast<double>(run.peakA), static_cast<double>(run.meanA),
+             static_cast<double>(run.rmsA),
+             static_cast<unsigned long>(run.missed),
+             static_cast<unsigned long>(run.dropped));
+}
+
+[[noreturn]] void power_capture_task(void *arg)
+{
+    CaptureTaskCtx &c = *static_cast<CaptureTaskCtx *>(arg);
+    while (true) {
+        if (c.pump->isRunning()) {
+            capture_run(c);
+        }
+        vTaskDelay(pdMS_TO_TICKS(kIdlePollMs));
+    }
+}
+
+}  // namespace
+
+void power_capture_task_start(IPowerSensor& sensor, IWaterPump& pump,
+                              PumpCurrentCapture& capture, EventLogger& events)
+{
+    ctx.sensor = &sensor;
+    ctx.pump = &pump;
+    ctx.capture = &capture;
+    ctx.events = &events;
+
+    const esp_timer_create_args_t timer = {
+        .callback = &sample_due,
+        .arg = nullptr,
+        .dispatch_method = ESP_TIMER_TASK,
+        .name = "power_capture",
+        .skip_unhandled_events = true,
+    };
+    if (esp_timer_create(&timer, &s_timer) != ESP_OK) {
+        ESP_LOGE(TAG, "failed to create capture timer (no capture)");
+        return;
+    }
+    const BaseType_t created =
+        task_plan_create<task_plan::kPowerCapture>(power_capture_task, &ctx, &s_task);
+    if (created != pdPASS) {
+        ESP_LOGE(TAG, "failed to create capture task (no capture)");
+        return;
+    }
+    ESP_LOGI(TAG, "pump current capture armed (%u-sample ring)",
+             static_cast<unsigned>(PumpCurrentCapture::kRingSamples));
+}
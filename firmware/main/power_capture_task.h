@@ -0,0 +1,41 @@
+// SPDX-FileCopyrightText: 2026 Cryptotomte
+// SPDX-License-Identifier: AGPL-3.0-or-later
+/**
+ * @file power_capture_task.h
+ * @brief Pump current capture task: ~1 kHz INA226 current samples while
+ *        the plant pump runs (app wiring).
+ *
+ * App-level FreeRTOS task, not a component. The samples and the per-run
+ * statistics live in the pure PumpCurrentCapture
+ * (sensors/PumpCurrentCapture.h); this task only paces the reads.
+ */
+
+#ifndef WATERINGSYSTEM_MAIN_POWER_CAPTURE_TASK_H
+#define WATERINGSYSTEM_MAIN_POWER_CAPTURE_TASK_H
+
+#include "events/EventLogger.h"
+#include "interfaces/IPowerSensor.h"
+#include "interfaces/IWaterPump.h"
+#include "sensors/PumpCurrentCapture.h"
+
+/**
+ * @brief Start the capture task.
+ *
+ * Idle, it checks @p pump every tick. When the pump starts it switches
+ * @p sensor to high-rate sampling, opens a run and reads the current once
+ * per conversion period, paced by a periodic esp_timer; when the pump
+ * stops it restores the normal sampling, closes the run and logs the run
+ * summary to @p events. A task or timer creation failure is logged and
+ * swallowed: the capture is diagnostics only.
+ *
+ * @param sensor  The LockedPowerSensor decorator.
+ * @param pump    The plant pump's LockedWaterPump (the INA226 measures its
+ *                supply).
+ * @param capture Sample ring + statistics; also served by the API.
+ * @param events  Persistent event log for the run summaries.
+ * All must outlive the task (function-local statics).
+ */
+void power_capture_task_start(IPowerSensor& sensor, IWaterPump& pump,
+                              PumpCurrentCapture& capture, EventLogger& events);
+
+#endif /* WATERINGSYSTEM_MAIN_POWER_CAPTURE_TASK_H */
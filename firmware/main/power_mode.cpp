@@ -0,0 +1,132 @@
+// SPDX-FileCopyrightText: 2026 Cryptotomte
+// SPDX-License-Identifier: AGPL-3.0-or-later
+/**
+ * @file power_mode.cpp
+ * @brief esp_pm configuration and the esp_pm-backed IPowerLocks.
+ */
+
+#include "power_mode.h"
+
+#include "esp_log.h"
+#include "esp_timer.h"
+#include "sdkconfig.h"
+
+#if defined(CONFIG_WS_POWER_MANAGEMENT)
+#include "driver/uart.h"
+#include "esp_pm.h"
+#include "esp_sleep.h"
+#endif
+
+static const char *TAG = "power_mode";
+
+namespace {
+
+PowerResidency& residency()
+{
+    static PowerResidency totals;
+    return totals;
+}
+
+#if defined(CONFIG_WS_POWER_MANAGEMENT)
+
+/// One esp_pm lock; esp_pm counts the nesting, the residency the holders.
+class EspPowerLock final : public IPowerLock {
+public:
+    bool create(esp_pm_lock_type_t type, PowerLockKind kind)
+    {
+        kind_ = kind;
+        return esp_pm_lock_create(type, 0, powerLockKindName(kind), &handle_) == ESP_OK;
+    }
+
+    void acquire() override
+    {
+        esp_pm_lock_acquire(handle_);
+        residency().acquired(kind_, esp_timer_get_time());
+    }
+
+    void release() override
+    {
+        residency().released(kind_, esp_timer_get_time());
+        esp_pm_lock_release(handle_);
+    }
+
+private:
+    esp_pm_lock_handle_t handle_ = nullptr;
+    PowerLockKind kind_ = PowerLockKind::CpuMax;
+};
+
+EspPowerLock s_locks[kPowerLockKinds];
+bool s_started = false;
+
+#endif  // CONFIG_WS_POWER_MANAGEMENT
+
+}  // namespace
+
+#if defined(CONFIG_WS_POWER_MANAGEMENT)
+
+bool power_mode_start()
+{
+    constexpr esp_pm_lock_type_t kTypes[kPowerLockKinds] = {
+        ESP_PM_CPU_FREQ_MAX,   // PowerLockKind::CpuMax
+        ESP_PM_APB_FREQ_MAX,   // PowerLockKind::ApbMax
+        ESP_PM_NO_LIGHT_SLEEP, // PowerLockKind::NoLightSleep
+    };
+    for (std::size_t i = 0; i < kPowerLockKinds; ++i) {
+        if (!s_locks[i].create(kTypes[i], static_cast<PowerLockKind>(i))) {
+            ESP_LOGE(TAG, "cannot create the %s lock; power management stays off",
+                     powerLockKindName(static_cast<PowerLockKind>(i)));
+            return false;
+        }
+    }
+
+#if defined(CONFIG_WS_PM_LIGHT_SLEEP)
+    // A sleeping console would miss what is typed; a few edges on its RX
+    // line wake the chip (those characters are lost, the next ones not).
+    uart_set_wakeup_threshold(static_cast<uart_port_t>(CONFIG_ESP_CONSOLE_UART_NUM), 3);
+    esp_sleep_enable_uart_wakeup(CONFIG_ESP_CONSOLE_UART_NUM);
+    constexpr bool kLightSleep = true;
+#else
+    constexpr bool kLightSleep = false;
+#endif
+    const esp_pm_config_t config = {
+        .max_freq_mhz = CONFIG_ESP_DEFAULT_CPU_FREQ_MHZ,
+        .min_freq_mhz = CONFIG_WS_PM_MIN_CPU_MHZ,
+        .light_sleep_enable = kLightSleep,
+    };
+    const esp_err_t err = esp_pm_configure(&config);
+    if (err != ESP_OK) {
+        ESP_LOGE(TAG, "esp_pm_configure failed: %s; CPU stays at %d MHz",
+                 esp_err_to_name(err), CONFIG_ESP_DEFAULT_CPU_FREQ_MHZ);
+        return false;
+    }
+    residency().start(esp_timer_get_time());
+    s_started = true;
+    ESP_LOGI(TAG, "CPU %d..%d MHz, light sleep %s", CONFIG_WS_PM_MIN_CPU_MHZ,
+             CONFIG_ESP_DEFAULT_CPU_FREQ_MHZ, kLightSleep ? "on" : "off");
+    return true;
+}
+
+IPowerLock* power_lock(PowerLockKind kind)
+{
+    return s_started ? &s_locks[static_cast<std::size_t>(kind)] : nullptr;
+}
+
+#else
+
+bool power_mode_start()
+{
+    ESP_LOGI(TAG, "power management off (CONFIG_WS_POWER_MANAGEMENT)");
+    return false;
+}
+
+IPowerLock* power_lock(PowerLockKind /*kind*/)
+{
+    return nullptr;
+}
+
+#endif  // CONFIG_WS_POWER_MANAGEMENT
+
+const PowerResidency& power_residency()
+{
+    return residency();
+}
@@ -0,0 +1,45 @@
+// SPDX-FileCopyrightText: 2026 Cryptotomte
+// SPDX-License-Identifier: AGPL-3.0-or-later
+/**
+ * @file power_mode.h
+ * @brief ESP-IDF power management: dynamic frequency scaling, automatic
+ *        light sleep and the locks that hold them off (app wiring).
+ *
+ * power_mode_start() configures esp_pm (CPU between CONFIG_WS_PM_MIN_CPU_MHZ
+ * and the default frequency, light sleep in tickless idle with
+ * CONFIG_WS_PM_LIGHT_SLEEP) and creates one esp_pm lock per PowerLockKind
+ * (interfaces/PowerLocks.h). Boot wiring hands them out: ApbMax to the
+ * RS485 and I2C bus masters, CpuMax to the ApiServer's handlers, and the
+ * main loop holds NoLightSleep while a pump runs. Every acquire and release
+ * is also told to power_residency(), which GET /api/v1/metrics exports
+ * (`pm_state_seconds_total`).
+ *
+ * Built with CONFIG_WS_POWER_MANAGEMENT only (rev2 turns on CONFIG_PM_ENABLE
+ * and tickless idle in its sdkconfig overlay). Without it power_lock()
+ * returns nullptr and every guard is a no-op.
+ */
+
+#ifndef WATERINGSYSTEM_MAIN_POWER_MODE_H
+#define WATERINGSYSTEM_MAIN_POWER_MODE_H
+
+#include "interfaces/PowerLocks.h"
+
+/**
+ * @brief Configure power management and create the locks.
+ *
+ * Call once, early in app_main, before any bus master or the API server
+ * is wired. With light sleep on, the console UART also wakes the chip
+ * (the first characters typed into a sleeping console are lost).
+ *
+ * @return false when power management is off or esp_pm refused; the chip
+ *         then stays at its fixed frequency, as before.
+ */
+bool power_mode_start();
+
+/// The lock of @p kind; nullptr until power_mode_start() succeeded.
+IPowerLock* power_lock(PowerLockKind kind);
+
+/// Time per power state since power_mode_start() (zero without it).
+const PowerResidency& power_residency();
+
+#endif /* WATERINGSYSTEM_MAIN_POWER_MODE_H */
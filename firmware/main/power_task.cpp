@@ -0,0 +1,219 @@
+// SPDX-FileCopyrightText: 2026 Cryptotomte
+// SPDX-License-Identifier: AGPL-3.0-or-later
+/**
+ * @file power_task.cpp
+ * @brief INA226 conversion-ready sampling (see power_task.h).
+ *
+ * The ISR does nothing but notify the task; the Mask/Enable read that
+ * releases ALERT and the data reads run on the task, through the shared
+ * I2C bus master. A missed edge costs one period: the wait times out after
+ * two and the flag read catches up.
+ *
+ * Energy: each result is integrated with its read time (esp_timer, µs),
+ * and the meter is sealed into the older of two RTC_NOINIT blocks once a
+ * second and at every closed run or day — a copy and a CRC, no flash.
+ */
+
+#include "power_task.h"
+
+#include <string>
+
+#include "driver/gpio.h"
+#include "esp_attr.h"
+#include "esp_log.h"
+#include "esp_timer.h"
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+
+#include "task_plan.h"
+
+static const char *TAG = "power_task";
+
+namespace {
+
+constexpr uint32_t kRetryMs = 1000;       ///< back-off after a failed read
+constexpr uint32_t kFallbackPeriodUs = 35200;  ///< sensor reports no period
+constexpr int64_t kSealUs = 1000000;      ///< energy into RTC memory
+
+struct PowerTaskCtx {
+    IPowerSensor* sensor;
+    int alertGpio;  ///< -1 = poll the flag
+    PowerEnergySinks energy;
+};
+
+PowerTaskCtx ctx;
+TaskHandle_t s_task = nullptr;
+
+RTC_NOINIT_ATTR EnergyBlock s_rtc[2];
+int64_t s_sealedUs = 0;
+/// Named once at start, so a close never builds a string.
+SensorReading s_runReading;
+SensorReading s_dayReading;
+
+/// Seal the meter into the RTC block not holding its newest seal.
+void seal_energy(EnergyMeter& meter)
+{
+    meter.seal(s_rtc[(meter.sealSequence() + 1) & 1u]);
+}
+
+/// Log what addSample() closed to the history.
+void log_closed(const PowerEnergySinks& e, uint32_t closed)
+{
+    const EnergyTotals t = e.meter->load();
+    if ((closed & EnergyMeter::kRunClosed) != 0) {
+        ESP_LOGI(TAG, "%s pump run: %.3f Wh in %lu ms", e.pumpName, t.lastRunWh,
+                 static_cast<unsigned long>(t.lastRunMs));
+        if (e.storage != nullptr && t.lastRunStart != 0) {
+            s_runReading.epoch = t.lastRunStart;
+            s_runReading.value = static_cast<float>(t.lastRunWh);
+            e.storage->storeSensorReadings(&s_runReading, 1);
+        }
+    }
+    if ((closed & EnergyMeter::kDayClosed) != 0) {
+        ESP_LOGI(TAG, "day %lu: %.3f Wh",
+                 static_cast<unsigned long>(t.previousDayStart), t.previousDayWh);
+        if (e.storage != nullptr) {
+            s_dayReading.epoch = t.previousDayStart;
+            s_dayReading.value = static_cast<float>(t.previousDayWh);
+            e.storage->storeSensorReadings(&s_dayReading, 1);
+        }
+    }
+}
+
+/// Integrate one result read at @p atUs.
+void integrate(const PowerEnergySinks& e, float watts, int64_t atUs)
+{
+    const bool running = e.pump != nullptr && e.pump->isRunning();
+    const WallTime now = e.clock != nullptr ? e.clock->now() : WallTime{};
+    const uint32_t closed = e.meter->addSample(watts, atUs, running, now);
+    if (closed != 0 || atUs - s_sealedUs >= kSealUs) {
+        seal_energy(*e.meter);
+        s_sealedUs = atUs;
+    }
+    if (closed != 0) {
+        log_closed(e, closed);
+    }
+}
+
+/// Ticks to sleep so that at least @p us have passed (as in sensor_task).
+TickType_t ticksCovering(uint32_t us)
+{
+    const uint32_t tickUs = portTICK_PERIOD_MS * 1000;
+    return static_cast<TickType_t>((us + tickUs - 1) / tickUs + 1);
+}
+
+void IRAM_ATTR alert_isr(void *arg)
+{
+    (void)arg;
+    BaseType_t woken = pdFALSE;
+    vTaskNotifyGiveFromISR(s_task, &woken);
+    portYIELD_FROM_ISR(woken);
+}
+
+/// Falling-edge interrupt on the ALERT pin; false leaves the task polling.
+bool attach_alert(int gpio)
+{
+    gpio_config_t io = {};
+    io.pin_bit_mask = 1ULL << gpio;
+    io.mode = GPIO_MODE_INPUT;
+    io.pull_up_en = GPIO_PULLUP_ENABLE;  // ALERT is open drain
+    io.intr_type = GPIO_INTR_NEGEDGE;
+    esp_err_t err = gpio_config(&io);
+    if (err == ESP_OK) {
+        // IRAM service, as the level inputs and the over-current trip ask:
+        // the first install decides for every GPIO interrupt, and a
+        // non-IRAM one would hold the trip's gate cut behind each flash
+        // write (alert_isr is in IRAM too).
+        err = gpio_install_isr_service(ESP_INTR_FLAG_IRAM);
+        if (err == ESP_ERR_INVALID_STATE) {
+            err = ESP_OK;  // already installed by another driver
+        }
+    }
+    if (err == ESP_OK) {
+        err = gpio_isr_handler_add(static_cast<gpio_num_t>(gpio), alert_isr,
+                                   nullptr);
+    }
+    if (err != ESP_OK) {
+        ESP_LOGE(TAG, "ALERT interrupt on GPIO %d failed: %s — polling",
+                 gpio, esp_err_to_name(err));
+        return false;
+    }
+    return true;
+}
+
+[[noreturn]] void power_task(void *arg)
+{
+    const PowerTaskCtx *c = static_cast<const PowerTaskCtx *>(arg);
+    IPowerSensor &sensor = *c->sensor;
+    EnergyMeter *meter = c->energy.meter;
+    bool alert = c->alertGpio >= 0 && attach_alert(c->alertGpio);
+    if (alert && !sensor.setConversionReadyAlert(true)) {
+        // Unreachable sensor: the flag is re-armed by its next init.
+        ESP_LOGW(TAG, "conversion-ready alert not armed yet (error %d)",
+                 sensor.getLastError());
+    }
+    ESP_LOGI(TAG, "power sampling %s",
+             alert ? "on the conversion-ready alert" : "by flag polling");
+
+    bool failing = false;
+    while (true) {
+        const uint32_t periodUs = sensor.conversionPeriodUs() != 0
+                                      ? sensor.conversionPeriodUs()
+                                      : kFallbackPeriodUs;
+        if (alert) {
+            ulTaskNotifyTake(pdTRUE, ticksCovering(2 * periodUs));
+        } else {
+            vTaskDelay(ticksCovering(periodUs));
+        }
+        if (!sensor.conversionReady()) {
+            continue;
+        }
+        if (sensor.read()) {
+            if (meter != nullptr) {
+                integrate(c->energy, sensor.snapshot().power, esp_timer_get_time());
+            }
+            if (failing) {
+                failing = false;
+                ESP_LOGI(TAG, "power sensor recovered");
+            }
+            continue;
+        }
+        if (meter != nullptr) {
+            meter->gap();
+        }
+        if (!failing) {
+            failing = true;
+            ESP_LOGW(TAG, "power read failed (error %d), retrying every %lu ms",
+                     sensor.getLastError(),
+                     static_cast<unsigned long>(kRetryMs));
+        }
+        vTaskDelay(pdMS_TO_TICKS(kRetryMs));
+    }
+}
+
+}  // namespace
+
+void power_task_start(IPowerSensor& sensor, int alertGpio,
+                      const PowerEnergySinks& energy)
+{
+    ctx.sensor = &sensor;
+    ctx.alertGpio = alertGpio;
+    ctx.energy = energy;
+    if (energy.meter != nullptr) {
+        s_runReading.metric = std::string("pump_") + energy.pumpName + "_wh";
+        s_dayReading.metric = kPowerDayMetric;
+        const EnergyBlock* from = energy.meter->restore({&s_rtc[0], &s_rtc[1]});
+        const EnergyTotals t = energy.meter->load();
+        ESP_LOGI(TAG, "energy %s: %.3f Wh today, %.3f Wh total",
+                 from == nullptr ? "starts at zero" : "restored from RTC memory",
+                 t.dayWh, t.totalWh);
+        // Sealed at once: the restored block is rewritten with its run
+        // closed, so a second reset does not close it again.
+        seal_energy(*energy.meter);
+    }
+    const BaseType_t created = task_plan_create<task_plan::kPower>(power_task, &ctx, &s_task);
+    if (created != pdPASS) {
+        ESP_LOGE(TAG, "failed to create power task (readings on demand)");
+        return;
+    }
+}
@@ -0,0 +1,63 @@
+// SPDX-FileCopyrightText: 2026 Cryptotomte
+// SPDX-License-Identifier: AGPL-3.0-or-later
+/**
+ * @file power_task.h
+ * @brief INA226 sampling task, one read per completed conversion (app
+ *        wiring).
+ *
+ * App-level FreeRTOS task, not a component. Without it power readings are
+ * on demand (console, API) and as old as the last caller made them; with
+ * it the locked sensor's snapshot() follows every result the chip
+ * averages, at its conversionPeriodUs(). Given an EnergyMeter, every
+ * result is also integrated into energy (sensors/EnergyMeter.h), with the
+ * meter's state in RTC_NOINIT blocks owned here.
+ */
+
+#ifndef WATERINGSYSTEM_MAIN_POWER_TASK_H
+#define WATERINGSYSTEM_MAIN_POWER_TASK_H
+
+#include "interfaces/IDataStorage.h"
+#include "interfaces/IPowerSensor.h"
+#include "interfaces/IWallClock.h"
+#include "interfaces/IWaterPump.h"
+#include "sensors/EnergyMeter.h"
+
+/// What the task integrates energy with; no meter = no integration. All
+/// must outlive the task (function-local statics from app_main).
+struct PowerEnergySinks {
+    EnergyMeter* meter = nullptr;
+    const IWaterPump* pump = nullptr;    ///< the pump the INA226 measures
+    const IWallClock* clock = nullptr;
+    IDataStorage* storage = nullptr;     ///< null: runs and days not logged
+    const char* pumpName = "plant";      ///< run metric "pump_<name>_wh"
+};
+
+/// History metric of each closed day's energy (epoch = the day's start).
+constexpr const char* kPowerDayMetric = "power_day_wh";
+
+/**
+ * @brief Start the sampling task.
+ *
+ * With @p alertGpio >= 0 the sensor's conversion-ready alert is enabled
+ * and a falling edge on that pin (ALERT is open drain, active low) wakes
+ * the task; otherwise the task polls conversionReady() once per
+ * conversion period. Either way one read() follows each flagged result,
+ * and a failed read backs off for a second (the lazy re-init recovers).
+ * A GPIO or task-creation failure is logged and swallowed: the first
+ * falls back to polling, the second leaves readings on demand.
+ *
+ * With @p energy's meter the meter is restored from RTC memory first (a
+ * warm reset keeps the day and the totals), then fed every result. A
+ * closed run is logged as "pump_<name>_wh" (epoch = run start, value =
+ * Wh; untimed runs are not), a closed day as kPowerDayMetric, so the
+ * storage rollups keep them past a power cycle.
+ *
+ * @param sensor    Pass the LockedPowerSensor decorator; must outlive the
+ *                  task (a function-local static).
+ * @param alertGpio GPIO wired to the INA226 ALERT pin, or -1 for none.
+ * @param energy    Energy integration; default none.
+ */
+void power_task_start(IPowerSensor& sensor, int alertGpio,
+                      const PowerEnergySinks& energy = {});
+
+#endif /* WATERINGSYSTEM_MAIN_POWER_TASK_H */
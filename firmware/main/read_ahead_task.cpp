@@ -0,0 +1,60 @@
+// SPDX-FileCopyrightText: 2026 Cryptotomte
+// SPDX-License-Identifier: AGPL-3.0-or-later
+/**
+ * @file read_ahead_task.cpp
+ * @brief The read-ahead reader loop (see read_ahead_task.h).
+ *
+ * The reader waits kWaitMs at a time for a transfer; the wait is only a
+ * bound on how long the loop sleeps, a pump() wakes it at once.
+ */
+
+#include "read_ahead_task.h"
+
+#include <cstdint>
+
+#include "esp_log.h"
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+
+#include "sdkconfig.h"
+#include "task_plan.h"
+
+#if defined(CONFIG_WS_READ_AHEAD)
+
+static const char *TAG = "read_ahead";
+
+namespace {
+
+constexpr uint32_t kWaitMs = 1000;
+
+[[noreturn]] void read_ahead_task(void *arg)
+{
+    api::ReadAheadPipe& pipe = *static_cast<api::ReadAheadPipe *>(arg);
+    while (true) {
+        (void)pipe.serveRead(kWaitMs);
+    }
+}
+
+}  // namespace
+
+api::ReadAheadPipe& read_ahead_pipe()
+{
+    static api::ReadAheadPipe instance;
+    return instance;
+}
+
+void read_ahead_task_start(api::ReadAheadPipe& pipe)
+{
+    static bool started = false;  // boot wiring only: one caller
+    if (started) {
+        return;
+    }
+    started = true;
+    if (task_plan_create<task_plan::kReadAhead>(read_ahead_task, &pipe) != pdPASS) {
+        ESP_LOGE(TAG, "failed to create read-ahead task");
+        return;
+    }
+    pipe.attachReader();
+}
+
+#endif  // CONFIG_WS_READ_AHEAD
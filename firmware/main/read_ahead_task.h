@@ -0,0 +1,30 @@
+// SPDX-FileCopyrightText: 2026 Cryptotomte
+// SPDX-License-Identifier: AGPL-3.0-or-later
+/**
+ * @file read_ahead_task.h
+ * @brief Flash reader for large response bodies (app wiring,
+ *        CONFIG_WS_READ_AHEAD).
+ *
+ * Owns the firmware's one api::ReadAheadPipe. The reader task sleeps on
+ * the pipe between transfers; during one it reads the next chunk of the
+ * body from flash while the httpd task sends the previous one.
+ */
+
+#ifndef WATERINGSYSTEM_MAIN_READ_AHEAD_TASK_H
+#define WATERINGSYSTEM_MAIN_READ_AHEAD_TASK_H
+
+#include "api/ReadAheadPipe.h"
+
+/// The firmware's one ReadAheadPipe (a function-local static).
+api::ReadAheadPipe& read_ahead_pipe();
+
+/**
+ * @brief Start the reader task over @p pipe.
+ *
+ * Once, after the ApiServer exists (station mode only). Not
+ * watchdog-subscribed (network side). A creation failure is logged: the
+ * httpd task then reads each chunk itself before sending it.
+ */
+void read_ahead_task_start(api::ReadAheadPipe& pipe);
+
+#endif /* WATERINGSYSTEM_MAIN_READ_AHEAD_TASK_H */
@@ -0,0 +1,139 @@
+// SPDX-FileCopyrightText: 2026 Cryptotomte
+// SPDX-License-Identifier: AGPL-3.0-or-later
+/**
+ * @file recorder_task.cpp
+ * @brief Flash writer of the watering input recording (see recorder_task.h).
+ *
+ * The task only ever reads the recorder (copyBlock() under its lock, one
+ * 2 KiB copy per block), so the watering task never waits on the flash.
+ * The file's mark is the newest RAM block it took, which is what
+ * streamInputRecording() continues from; a block that rolled out of the
+ * RAM ring before the task got to it (the storage was held, or slow) is
+ * lost, and logged.
+ */
+
+#include "recorder_task.h"
+
+#include <string>
+
+#include "esp_log.h"
+#include "esp_system.h"
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+
+#include "storage/StorageMount.h"
+
+#include "sdkconfig.h"
+#include "storage_mount_task.h"
+#include "task_plan.h"
+
+#if defined(CONFIG_WS_INPUT_RECORDER)
+
+static const char *TAG = "recorder";
+
+namespace {
+
+constexpr uint32_t kFlushPeriodMs = 60 * 1000;
+constexpr uint32_t kStorageWaitMs = 60 * 1000;
+constexpr std::size_t kFileSlots =
+    static_cast<std::size_t>(CONFIG_WS_INPUT_RECORDER_FLASH_KB) * 1024 /
+    (BlockRingFile::kSlotHeaderBytes + input_record::kBlockBytes);
+
+bool s_started = false;
+bool s_fileOpen = false;
+uint32_t s_flushed = 0;  ///< newest RAM block in the file
+uint8_t s_block[input_record::kBlockBytes];
+
+BlockRingFile* file()
+{
+    if (kFileSlots == 0) {
+        return nullptr;
+    }
+    static BlockRingFile instance(std::string(StorageMount::kBasePath) + "/recording.bin",
+                                  kFileSlots, input_record::kBlockBytes);
+    return &instance;
+}
+
+/// Copy the blocks after the last one flushed up to @p last into the file.
+void flush_through(uint32_t last)
+{
+    InputRecorder& recorder = input_recorder();
+    uint32_t sequence = s_flushed + 1;
+    const uint32_t oldest = recorder.oldest();
+    if (oldest > sequence) {
+        ESP_LOGW(TAG, "%lu block(s) rolled out before reaching flash",
+                 static_cast<unsigned long>(oldest - sequence));
+        sequence = oldest;
+    }
+    for (; sequence != 0 && sequence <= last; ++sequence) {
+        const std::size_t n = recorder.copyBlock(sequence, s_block);
+        if (n != 0 && !file()->append(s_block, n, sequence)) {
+            ESP_LOGW(TAG, "block %lu not written", static_cast<unsigned long>(sequence));
+            return;
+        }
+        s_flushed = sequence;
+    }
+}
+
+/// The block being written goes too: a restart ends it.
+void flush_on_shutdown()
+{
+    if (s_fileOpen) {
+        flush_through(input_recorder().newest());
+    }
+}
+
+[[noreturn]] void recorder_task(void* arg)
+{
+    (void)arg;
+    if (!storage_wait_ready("input recorder", kStorageWaitMs) || !file()->open()) {
+        ESP_LOGW(TAG, "recording file not opened; RAM only");
+        vTaskDelete(nullptr);
+    }
+    s_fileOpen = true;
+    const esp_err_t err = esp_register_shutdown_handler(&flush_on_shutdown);
+    if (err != ESP_OK) {
+        ESP_LOGW(TAG, "shutdown flush not registered: %s", esp_err_to_name(err));
+    }
+    ESP_LOGI(TAG, "recording to flash: %u blocks", static_cast<unsigned>(kFileSlots));
+    TickType_t lastWake = xTaskGetTickCount();
+    while (true) {
+        vTaskDelayUntil(&lastWake, pdMS_TO_TICKS(kFlushPeriodMs));
+        const uint32_t newest = input_recorder().newest();
+        if (newest > 1) {
+            flush_through(newest - 1);  // the sealed ones
+        }
+    }
+}
+
+}  // namespace
+
+InputRecorder& input_recorder()
+{
+    // The configured blocks in internal RAM, more of them in PSRAM.
+    static InputRecorder instance(
+        bufferBudgets().declare(
+            BufferPool::InputRecorder,
+            {InputRecorder::kPsramBlocks * input_record::kPayloadBytes,
+             CONFIG_WS_INPUT_RECORDER_RAM_BLOCKS * input_record::kPayloadBytes}) /
+        input_record::kPayloadBytes);
+    return instance;
+}
+
+const BlockRingFile* input_recording_file()
+{
+    return file();
+}
+
+void recorder_task_start(void)
+{
+    if (s_started || file() == nullptr) {
+        return;
+    }
+    s_started = true;
+    if (task_plan_create<task_plan::kRecorder>(recorder_task, nullptr) != pdPASS) {
+        ESP_LOGE(TAG, "failed to create recorder task; RAM only");
+    }
+}
+
+#endif  // CONFIG_WS_INPUT_RECORDER
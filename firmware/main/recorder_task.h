@@ -0,0 +1,37 @@
+// SPDX-FileCopyrightText: 2026 Cryptotomte
+// SPDX-License-Identifier: AGPL-3.0-or-later
+/**
+ * @file recorder_task.h
+ * @brief The watering input recorder and the task that keeps its sealed
+ *        blocks on flash (app wiring, CONFIG_WS_INPUT_RECORDER).
+ *
+ * The watering task writes the recorder (watering_task_set_recorder()); a
+ * block fills in a quarter of an hour or more, so the RAM ring alone would
+ * hold an hour or two. Once a minute a low-priority task copies every
+ * sealed block to /storage/recording.bin (a BlockRingFile of
+ * CONFIG_WS_INPUT_RECORDER_FLASH_KB), and at an esp_restart() the block
+ * being written goes too, so the ticks before a reset survive it.
+ * GET /api/v1/recording serves the file and then the RAM blocks it lacks.
+ */
+
+#ifndef WATERINGSYSTEM_MAIN_RECORDER_TASK_H
+#define WATERINGSYSTEM_MAIN_RECORDER_TASK_H
+
+#include "control/InputRecorder.h"
+#include "storage/BlockRingFile.h"
+
+/// The firmware's one recorder (a function-local static, allocated on the
+/// first call: CONFIG_WS_INPUT_RECORDER_RAM_BLOCKS blocks).
+InputRecorder& input_recorder();
+
+/// The flash file the task fills; null with CONFIG_WS_INPUT_RECORDER_FLASH_KB 0.
+const BlockRingFile* input_recording_file();
+
+/**
+ * @brief Start the flash writer: it waits for the storage mount, opens the
+ * file and then copies sealed blocks. Once; a task creation failure or a
+ * file that cannot be opened is logged, and the recording stays RAM-only.
+ */
+void recorder_task_start(void);
+
+#endif /* WATERINGSYSTEM_MAIN_RECORDER_TASK_H */
@@ -0,0 +1,55 @@
+// SPDX-FileCopyrightText: 2026 Cryptotomte
+// SPDX-License-Identifier: AGPL-3.0-or-later
+/**
+ * @file selftest_task.cpp
+ * @brief /api/v1/selftest worker and check helper (see selftest_task.h).
+ */
+
+#include "selftest_task.h"
+
+#include "esp_log.h"
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+
+#include "task_plan.h"
+
+static const char *TAG = "selftest_task";
+
+namespace {
+
+constexpr uint32_t kWaitMs = 1000;      ///< queue wait per loop
+
+[[noreturn]] void selftest_task(void *arg)
+{
+    api::ApiServer &server = *static_cast<api::ApiServer *>(arg);
+    while (true) {
+        server.serveSelfTest(kWaitMs);
+    }
+}
+
+/// Runs the checks the worker hands over, beside the one it runs itself.
+[[noreturn]] void selftest_helper_task(void *arg)
+{
+    api::SelfTestRunner &runner = *static_cast<api::SelfTestRunner *>(arg);
+    while (true) {
+        (void)runner.serveCheck(kWaitMs);
+    }
+}
+
+}  // namespace
+
+void selftest_task_start(api::ApiServer& server)
+{
+    const BaseType_t created =
+        task_plan_create<task_plan::kSelfTest>(selftest_task, &server);
+    if (created != pdPASS) {
+        ESP_LOGE(TAG, "failed to create selftest task");
+        return;
+    }
+    // Without the helper the worker runs every check itself, in turn.
+    if (task_plan_create<task_plan::kSelfTestHelper>(selftest_helper_task,
+                                                     &server.selfTestRunner()) != pdPASS) {
+        ESP_LOGW(TAG, "failed to create selftest helper; checks run in turn");
+    }
+    ESP_LOGI(TAG, "selftest worker started");
+}
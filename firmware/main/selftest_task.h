@@ -0,0 +1,34 @@
+// SPDX-FileCopyrightText: 2026 Cryptotomte
+// SPDX-License-Identifier: AGPL-3.0-or-later
+/**
+ * @file selftest_task.h
+ * @brief Worker task that answers POST /api/v1/selftest.
+ *
+ * App-level FreeRTOS task: it serves the self-test requests the httpd
+ * handler detached (ApiServer::serveSelfTest()). The self-test does a real
+ * BME280 read and a Modbus round trip, which can take the full bus timeout;
+ * on its own task that wait no longer queues every other API and static
+ * request behind it. A helper task runs the soil check while the worker
+ * runs the environmental one (api/SelfTestRunner.h), so a run waits for
+ * the slower bus rather than both in turn.
+ */
+
+#ifndef WATERINGSYSTEM_MAIN_SELFTEST_TASK_H
+#define WATERINGSYSTEM_MAIN_SELFTEST_TASK_H
+
+#include "api/ApiServer.h"
+
+/**
+ * @brief Start the self-test worker task.
+ *
+ * Call once, after the ApiServer exists (station mode only). Not
+ * watchdog-subscribed (network side, like the stream task); it sleeps on the
+ * server's queue between requests. A creation failure is logged and
+ * swallowed: the handler then runs the self-test inline, as it used to.
+ * Without the helper the worker runs the checks one after the other.
+ *
+ * @param server Must outlive the task (a function-local static).
+ */
+void selftest_task_start(api::ApiServer& server);
+
+#endif /* WATERINGSYSTEM_MAIN_SELFTEST_TASK_H */
@@ -4,115 +4,240 @@
  * @file sensor_task.cpp
  * @brief 5 s environmental sensor poll task (feature 005, research.md R7).
  *
- * Parity parameters from the legacy controller task: 4096 B stack,
- * priority 1, fixed 5000 ms cadence via vTaskDelayUntil (drift-free).
+ * Parity parameters from the legacy controller task: 4096 B stack and a
+ * 5000 ms base cadence via vTaskDelayUntil (drift-free); core and priority
+ * come from task_plan.h, the cadence and the phase of the first read from
+ * acquisition_plan.h. This task is the BME280's only periodic reader: the
+ * watering controller logs the snapshot it leaves.
+ * With CONFIG_WS_ADAPTIVE_POLLING the interval follows the pure PollCadence
+ * policy: it doubles while the readings hold still or the sensor keeps
+ * failing, up to CONFIG_WS_ADAPTIVE_POLL_MAX_S, and drops back to 5 s on
+ * the first reading that moves. Sleeps are cut into kFeedChunkMs slices
+ * (WDT feed, pump check), so a long backoff neither starves the watchdog
+ * nor delays burst sampling by more than a slice.
  * Logging discipline (contracts/interfaces.md): INFO with the three values
  * on success, WARN once on the valid→invalid transition and once on
  * recovery, repeated failures at a bounded cadence — every
  * SensorTaskLogPolicy::kFailureLogInterval-th consecutive failure
- * (12 × 5 s ≈ once a minute) to avoid log flood. The WHAT-to-log decision
+ * (12 × 5 s ≈ once a minute at the base cadence) to avoid log flood. The WHAT-to-log decision
  * lives in the pure SensorTaskLogPolicy (sensors component) so it is
  * host-tested, not review-verified; this task owns only the ESP_LOG calls
  * and the cadence. The task never exits and never reboots on failures;
  * recovery is the sensor driver's lazy re-init, driven by this cadence.
+ *
+ * Forced-mode profiles: each cycle triggers one conversion and sleeps its
+ * exact maximum duration (startMeasurement()) before read(). Burst: while
+ * the given pump runs, the sensor is switched to its burst profile and
+ * polled every kBurstPeriodMs.
  */
 
 #include "sensor_task.h"
 
+#include <cmath>
+
 #include "esp_log.h"
 #include "freertos/FreeRTOS.h"
 #include "freertos/task.h"
 
+#include "acquisition_plan.h"
+#include "interfaces/TraceBuffer.h"
+#include "sensors/PollCadence.h"
 #include "sensors/SensorTaskLogPolicy.h"
+#include "task_plan.h"
 #include "task_watchdog.h"
 
 static const char *TAG = "sensor_task";
 
 namespace {
 
-constexpr uint32_t kPeriodMs = 5000;    ///< parity poll cadence (R7)
-constexpr uint32_t kStackBytes = 4096;  ///< parity stack size (R7)
-constexpr UBaseType_t kPriority = 1;    ///< parity priority (R7)
+constexpr uint32_t kPeriodMs = acquisition_plan::kEnv.baseMs;
+constexpr uint32_t kBurstPeriodMs = acquisition_plan::kEnv.burstMs;
+constexpr uint32_t kMaxPeriodMs = acquisition_plan::kEnv.maxMs;
+constexpr uint32_t kFeedChunkMs = 1000;    ///< max sleep between WDT feeds
+constexpr PollCadenceLimits kCadence = {kBurstPeriodMs, kPeriodMs,
+                                        kMaxPeriodMs, kMaxPeriodMs};
+
+// Change thresholds: a reading within all three of the last one that moved
+// counts as stable (above the BME280's own noise at the default oversampling).
+constexpr float kTemperatureStepC = 0.2f;
+constexpr float kHumidityStepPct = 1.0f;
+constexpr float kPressureStepHpa = 0.5f;
+
+struct SensorTaskCtx {
+    IEnvironmentalSensor* sensor;
+    const IWaterPump* burstPump;
+};
+
+SensorTaskCtx ctx;
+
+/// Ticks to sleep so that at least @p us have passed: rounded up, plus one
+/// because vTaskDelay(n) may return up to a tick early.
+TickType_t ticksCovering(uint32_t us)
+{
+    const uint32_t tickUs = portTICK_PERIOD_MS * 1000;
+    return static_cast<TickType_t>((us + tickUs - 1) / tickUs + 1);
+}
+
+bool burstWanted(const SensorTaskCtx& c)
+{
+    return c.burstPump != nullptr && c.burstPump->isRunning();
+}
+
+/// EnvReading trace arguments (TraceBuffer.h): centi-degC, and
+/// 0.1 %RH | 0.1 hPa << 16.
+uint32_t traceTemperature(const EnvSnapshot& snap)
+{
+    return static_cast<uint32_t>(static_cast<int32_t>(std::lround(snap.temperature * 100.0f)));
+}
+
+uint32_t traceHumidityPressure(const EnvSnapshot& snap)
+{
+    const uint32_t rh = static_cast<uint32_t>(std::lround(snap.humidity * 10.0f));
+    const uint32_t hpa = static_cast<uint32_t>(std::lround(snap.pressure * 10.0f));
+    return (rh & 0xFFFFu) | ((hpa & 0xFFFFu) << 16);
+}
 
 [[noreturn]] void sensor_task(void *arg)
 {
-    IEnvironmentalSensor &sensor =
-        *static_cast<IEnvironmentalSensor *>(arg);
+    const SensorTaskCtx* c = static_cast<const SensorTaskCtx*>(arg);
+    IEnvironmentalSensor &sensor = *c->sensor;
+    bool bursting = false;
 
     // Host-tested log-decision policy: starts "valid" so the FIRST failure
     // (e.g. booting with no sensor attached) WARNs exactly once.
     SensorTaskLogPolicy logPolicy;
+    PollCadence cadence(kCadence);
+    float refTemperature = NAN;
+    float refHumidity = NAN;
+    float refPressure = NAN;
 
     // Watering-critical task: subscribe to the task WDT (feature 008 US3). The
-    // 20 s default timeout has a safe margin over this 5 s cycle. A stalled
-    // read never blocks (the driver is bounded), so the feed each cycle is the
-    // liveness proof the WDT needs.
+    // sleep is fed every kFeedChunkMs, whatever the interval. A stalled read
+    // never blocks (the driver is bounded), so the feeds are the liveness
+    // proof the WDT needs.
     watchdog_subscribe_current_task();
 
     TickType_t lastWake = xTaskGetTickCount();
+    // First poll at the plan's phase, off the soil reads; then one period
+    // apart — the NORMAL-mode first conversion completes well within it
+    // (research.md R9).
+    uint32_t periodMs = acquisition_plan::kEnv.phaseMs;
     while (true) {
-        // First poll one period after start — the NORMAL-mode first
-        // conversion completes well within 5 s (research.md R9).
-        vTaskDelayUntil(&lastWake, pdMS_TO_TICKS(kPeriodMs));
+        // A pump starting or stopping ends the sleep at the next slice.
+        for (uint32_t left = periodMs; left > 0;) {
+            const uint32_t slice = left < kFeedChunkMs ? left : kFeedChunkMs;
+            vTaskDelayUntil(&lastWake, pdMS_TO_TICKS(slice));
+            left -= slice;
+            watchdog_feed();
+            if (burstWanted(*c) != bursting) {
+                break;
+            }
+        }
 
-        // Feed once per 5 s cycle: this task is alive and servicing the WDT.
-        watchdog_feed();
+        // Burst sampling follows the pump: fast humidity changes while it
+        // waters, the configured profile and cadence otherwise.
+        const bool wantBurst = burstWanted(*c);
+        if (wantBurst != bursting) {
+            bursting = wantBurst;
+            if (sensor.setBurst(bursting)) {
+                ESP_LOGI(TAG, "burst sampling %s", bursting ? "on" : "off");
+            } else {
+                ESP_LOGW(TAG, "burst sampling %s: profile switch failed",
+                         bursting ? "on" : "off");
+            }
+        }
+
+        // Forced mode: trigger, then sleep exactly the conversion time.
+        const uint32_t waitUs = sensor.startMeasurement();
+        if (waitUs > 0) {
+            vTaskDelay(ticksCovering(waitUs));
+        }
 
         const bool ok = sensor.read();
+        // One coherent copy for the log line: the console `env` command may
+        // read in between, but never tears the T/RH/P triple.
+        const EnvSnapshot snap = sensor.snapshot();
         switch (logPolicy.onReadResult(ok)) {
         case SensorTaskLogPolicy::Event::Recovery:
             ESP_LOGW(TAG, "environmental sensor recovered");
             [[fallthrough]];  // a recovered sensor also logs its reading
         case SensorTaskLogPolicy::Event::Reading:
-            // Periodic reading, consistent with the legacy 5 s status print.
-            ESP_LOGI(TAG,
-                     "temperature=%.1f C humidity=%.1f %%RH pressure=%.1f hPa",
-                     static_cast<double>(sensor.getTemperature()),
-                     static_cast<double>(sensor.getHumidity()),
-                     static_cast<double>(sensor.getPressure()));
+            // Every reading is traced. The legacy 5 s status print stays at
+            // INFO only while the trace does not carry it; burst readings
+            // go to debug so the 1 s cadence cannot flood.
+            WS_TRACE(Info, EnvReading, traceTemperature(snap),
+                     traceHumidityPressure(snap));
+            if (bursting || WS_TRACE_LEVEL >= 2) {
+                ESP_LOGD(TAG,
+                         "%stemperature=%.1f C humidity=%.1f %%RH "
+                         "pressure=%.1f hPa", bursting ? "burst " : "",
+                         static_cast<double>(snap.temperature),
+                         static_cast<double>(snap.humidity),
+                         static_cast<double>(snap.pressure));
+            } else {
+                ESP_LOGI(TAG,
+                         "temperature=%.1f C humidity=%.1f %%RH pressure=%.1f "
+                         "hPa",
+                         static_cast<double>(snap.temperature),
+                         static_cast<double>(snap.humidity),
+                         static_cast<double>(snap.pressure));
+            }
             break;
         case SensorTaskLogPolicy::Event::FailureTransition:
-            // Valid → invalid transition: WARN exactly once. Note:
-            // read() and getLastError() are separate locked calls, so a
-            // console `env` read interleaving between them can change the
-            // error code — benign here (log-only); the consistent-snapshot
-            // helper is TODO(PR-11) (LockedEnvironmentalSensor.h).
+            // Valid → invalid transition: WARN exactly once.
             ESP_LOGW(TAG,
                      "environmental reading invalid (error %d), "
-                     "retrying every %lu ms",
-                     sensor.getLastError(),
-                     static_cast<unsigned long>(kPeriodMs));
+                     "retrying every %lu-%lu ms",
+                     snap.lastError, static_cast<unsigned long>(kPeriodMs),
+                     static_cast<unsigned long>(kMaxPeriodMs));
             break;
         case SensorTaskLogPolicy::Event::RepeatedFailure:
             // Bounded repeat cadence while the failure persists.
             ESP_LOGW(TAG,
                      "environmental sensor still failing (error %d, "
                      "%lu consecutive failures)",
-                     sensor.getLastError(),
+                     snap.lastError,
                      static_cast<unsigned long>(
                          logPolicy.consecutiveFailures()));
             break;
         case SensorTaskLogPolicy::Event::Silent:
             break;
         }
+
+        PollCadence::Outcome outcome = PollCadence::Outcome::Failed;
+        if (ok) {
+            // All three references move on their own: no short-circuit.
+            const bool t = PollCadence::moved(snap.temperature, refTemperature,
+                                              kTemperatureStepC);
+            const bool h = PollCadence::moved(snap.humidity, refHumidity,
+                                              kHumidityStepPct);
+            const bool p = PollCadence::moved(snap.pressure, refPressure,
+                                              kPressureStepHpa);
+            outcome = (t || h || p) ? PollCadence::Outcome::Changed
+                                    : PollCadence::Outcome::Stable;
+        }
+        periodMs = cadence.next(bursting, outcome);
     }
 }
 
 }  // namespace
 
-void sensor_task_start(IEnvironmentalSensor& sensor)
+void sensor_task_start(IEnvironmentalSensor& sensor,
+                       const IWaterPump* burstPump)
 {
+    ctx.sensor = &sensor;
+    ctx.burstPump = burstPump;
     // Task starts even when the sensor failed init: the driver's lazy
     // re-initialization turns later polls into the recovery path (US2).
     const BaseType_t created =
-        xTaskCreate(sensor_task, "sensor_task", kStackBytes, &sensor,
-                    kPriority, nullptr);
+        task_plan_create<task_plan::kSensor>(sensor_task, &ctx);
     if (created != pdPASS) {
         // Not a safety function: log and continue without periodic
         // readings (the console `env` command still works).
         ESP_LOGE(TAG, "failed to create sensor task");
         return;
     }
-    ESP_LOGI(TAG, "sensor task started (%lu ms cadence)",
-             static_cast<unsigned long>(kPeriodMs));
+    ESP_LOGI(TAG, "sensor task started (%lu-%lu ms cadence)",
+             static_cast<unsigned long>(kPeriodMs),
+             static_cast<unsigned long>(kMaxPeriodMs));
 }
@@ -4,8 +4,10 @@
  * @file sensor_task.h
  * @brief Periodic environmental sensor poller (app wiring, feature 005).
  *
- * App-level FreeRTOS task, not a component: PR-11's watering controller is
- * expected to absorb this cadence (research.md R7). Task/behavior contract:
+ * App-level FreeRTOS task, not a component, and the sensor's only periodic
+ * reader: the watering controller's data log takes its samples
+ * (WateringController::setEnvAcquired()); cadence and phase are the kEnv
+ * row of acquisition_plan.h. Task/behavior contract:
  * specs/005-bme280-i2c/contracts/interfaces.md ("Sensor task").
  */
 
@@ -13,23 +15,34 @@
 #define WATERINGSYSTEM_MAIN_SENSOR_TASK_H
 
 #include "interfaces/IEnvironmentalSensor.h"
+#include "interfaces/IWaterPump.h"
 
 /**
- * @brief Start the 5 s environmental sensor poll task.
+ * @brief Start the environmental sensor poll task (5 s base cadence).
  *
  * Pass the LockedEnvironmentalSensor decorator, never the raw sensor — the
  * task reads concurrently with the console REPL's `env` command (and
  * PR-09/PR-11 consumers later). The task starts even when the sensor
  * failed initialization (lazy re-init recovers later — parity), never
  * exits and never reboots on failures; publishing IS the locked sensor
- * itself (last-good values + getLastError()).
+ * itself (last-good values + getLastError()). The first read comes
+ * kEnv.phaseMs after start, out of step with the soil poll.
  *
  * Call once, after diag console registration in app_main. A task-creation
  * failure is logged and swallowed — the poller is not a safety function.
  *
- * @param sensor Polled every 5 s; must outlive the task (i.e. forever —
- *               pass a function-local static from app_main).
+ * A sensor sampling on demand (forced mode) is triggered each cycle and
+ * read after its measurement time. While @p burstPump runs, the sensor is
+ * put in its burst profile (setBurst()) and polled every second. With
+ * CONFIG_WS_ADAPTIVE_POLLING a steady or failing sensor is polled less
+ * often (PollCadence), down to once per CONFIG_WS_ADAPTIVE_POLL_MAX_S.
+ *
+ * @param sensor    Polled every 5 s or slower; must outlive the task (i.e.
+ *                  forever — pass a function-local static from app_main).
+ * @param burstPump Pump whose runs trigger burst sampling; nullptr = never
+ *                  burst. Same lifetime rule.
  */
-void sensor_task_start(IEnvironmentalSensor& sensor);
+void sensor_task_start(IEnvironmentalSensor& sensor,
+                       const IWaterPump* burstPump);
 
 #endif /* WATERINGSYSTEM_MAIN_SENSOR_TASK_H */
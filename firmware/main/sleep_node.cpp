@@ -0,0 +1,354 @@
+// SPDX-FileCopyrightText: 2026 Cryptotomte
+// SPDX-License-Identifier: AGPL-3.0-or-later
+/**
+ * @file sleep_node.cpp
+ * @brief One wake of the deep-sleep battery node (see sleep_node.h).
+ *
+ * Everything is a function-local static, built after pumps_force_off()
+ * like the full boot, and nothing here starts a task: the decision, the
+ * burst and the sync all run on app_main's task, which the deep sleep
+ * ends. The history store is opened with the fixed ring layout and the
+ * codec, format and tiers of the full firmware (the Kconfig symbol
+ * excludes retention and the ring-log backend), with group commit off so
+ * every write is on flash before the sleep.
+ */
+
+#include "sleep_node.h"
+
+#include "sdkconfig.h"
+
+#if defined(CONFIG_WS_DEEP_SLEEP_NODE)
+
+#include <cstddef>
+#include <cstdint>
+#include <cstdlib>
+
+#include "driver/gpio.h"
+#include "driver/rtc_io.h"
+#include "esp_attr.h"
+#include "esp_event.h"
+#include "esp_log.h"
+#include "esp_netif.h"
+#include "esp_rtc_time.h"
+#include "esp_sleep.h"
+#include "esp_timer.h"
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+#include "nvs_flash.h"
+
+#include "actuators/EspTimeProvider.h"
+#include "actuators/GpioWaterPump.h"
+#include "board/board.h"
+#include "control/DutyCycle.h"
+#include "control/WateringController.h"
+#include "control/WateringSchedule.h"
+#include "events/EventLogger.h"
+#include "network/EspWifiDriver.h"
+#include "network/WifiBootMode.h"
+#include "network/WifiManager.h"
+#include "network/WifiState.h"
+#include "sensors/Bme280Sensor.h"
+#include "sensors/EspI2cBus.h"
+#include "sensors/ModbusSoilSensor.h"
+#include "sensors/SoilPollScheduler.h"
+#if CONFIG_WS_MODBUS_CLIENT_UART
+#include "sensors/UartModbusClient.h"
+#else
+#include "sensors/EspModbusClient.h"
+#endif
+#include "storage/LittleFsDataStorage.h"
+#include "storage/NvsConfigStore.h"
+#include "storage/StorageMount.h"
+#include "time/SntpClient.h"
+#include "time/SystemWallClock.h"
+
+#if defined(CONFIG_WS_MQTT)
+#include "mqtt_task.h"
+#endif
+
+static const char *TAG = "sleep_node";
+
+namespace {
+
+constexpr uint32_t kStepMs = 100;
+
+RTC_NOINIT_ATTR DutyCycleState s_block;
+
+int64_t rtc_ms()
+{
+    return static_cast<int64_t>(esp_rtc_get_time_us() / 1000);
+}
+
+/// Every pump gate on the board, zone 0 first.
+template <typename Fn>
+void for_each_pump_pin(Fn fn)
+{
+    fn(static_cast<gpio_num_t>(BOARD_PIN_MAIN_PUMP));
+#if BOARD_HAS_RESERVOIR_PUMP
+    fn(static_cast<gpio_num_t>(BOARD_PIN_RESERVOIR_PUMP));
+#endif
+    for (std::size_t i = 1; i < kBoardZoneCount; ++i) {
+        fn(static_cast<gpio_num_t>(kBoardZones[i].pumpPin));
+    }
+}
+
+/// NVS with the same recovery as the full boot.
+void nvs_up()
+{
+    esp_err_t err = nvs_flash_init();
+    if (err == ESP_ERR_NVS_NO_FREE_PAGES || err == ESP_ERR_NVS_NEW_VERSION_FOUND) {
+        if (nvs_flash_erase() == ESP_OK) {
+            err = nvs_flash_init();
+        }
+    }
+    if (err != ESP_OK) {
+        ESP_LOGE(TAG, "NVS init failed: %s (config falls back to defaults)",
+                 esp_err_to_name(err));
+    }
+}
+
+/**
+ * @brief Wi-Fi, SNTP and the MQTT replay, within the sync time limit.
+ * @return true when SNTP stepped the clock
+ */
+bool sync(IConfigStore& config, ITimeProvider& clock, SystemWallClock& wallClock,
+          SntpClient& sntp, const IDataStorage& history)
+{
+    if (config.getWifiSsid().empty()) {
+        ESP_LOGW(TAG, "no Wi-Fi credentials: hold the config button at boot to provision");
+        return false;
+    }
+    esp_err_t event_err = esp_event_loop_create_default();
+    if (event_err == ESP_ERR_INVALID_STATE) {
+        event_err = ESP_OK;
+    }
+    static EspWifiDriver wifi_driver;
+    if (esp_netif_init() != ESP_OK || event_err != ESP_OK || wifi_driver.init() != ESP_OK) {
+        ESP_LOGE(TAG, "Wi-Fi unavailable; sync skipped");
+        return false;
+    }
+    // No pause between rounds: the time limit bounds the attempts.
+    ReconnectPolicy policy;
+    policy.retryIntervalMs = static_cast<uint32_t>(CONFIG_WS_WIFI_RETRY_INTERVAL_MS);
+    policy.cachedAttempts = static_cast<uint8_t>(CONFIG_WS_WIFI_CACHED_ATTEMPTS);
+    static WifiManager wifi(wifi_driver, config, clock, policy);
+    (void)wifi_driver.setStaticIp(config.getStaticIp());
+    wifi.begin(WifiBootMode::Station);
+
+    sntp.attach(wallClock);
+#if defined(CONFIG_WS_MQTT)
+    api::MqttUplink& uplink = mqtt_uplink_init(history, wallClock);
+    bool drained = false;
+#else
+    (void)history;
+    const bool drained = true;
+#endif
+    const int64_t deadline =
+        clock.nowMs() + static_cast<int64_t>(CONFIG_WS_SLEEP_NODE_SYNC_TIMEOUT_S) * 1000;
+    bool sntp_started = false;
+    bool synced = false;
+    while (clock.nowMs() < deadline && !(synced && drained)) {
+        wifi.tick();
+        const bool connected = wifi.snapshot().state == WifiState::Connected;
+        if (connected && !sntp_started) {
+            sntp_started = sntp.start();
+        }
+        synced = sntp.status().synced();
+#if defined(CONFIG_WS_MQTT)
+        if (synced && !drained) {
+            drained = mqtt_uplink_drain_step(uplink, connected);
+        }
+#endif
+        vTaskDelay(pdMS_TO_TICKS(kStepMs));
+    }
+    if (!synced) {
+        ESP_LOGW(TAG, "sync timed out (%s)", sntp_started ? "no SNTP answer" : "not connected");
+    } else if (!drained) {
+        ESP_LOGW(TAG, "replay not drained; the rest goes on the next sync");
+    }
+    return synced;
+}
+
+/// Arm the timer and the level GPIO, hold the pump gates low (released
+/// by pumps_force_off() at the next boot), sleep.
+[[noreturn]] void sleep_for(uint32_t sleepMs)
+{
+    esp_sleep_enable_timer_wakeup(static_cast<uint64_t>(sleepMs) * 1000);
+#if CONFIG_WS_SLEEP_NODE_WAKE_GPIO >= 0
+    const auto wake_pin = static_cast<gpio_num_t>(CONFIG_WS_SLEEP_NODE_WAKE_GPIO);
+    if (rtc_gpio_is_valid_gpio(wake_pin)) {
+        gpio_set_direction(wake_pin, GPIO_MODE_INPUT);
+        const int level = gpio_get_level(wake_pin);
+        esp_sleep_enable_ext0_wakeup(wake_pin, level == 0 ? 1 : 0);
+    } else {
+        ESP_LOGE(TAG, "GPIO %d cannot wake from deep sleep (not an RTC GPIO)",
+                 CONFIG_WS_SLEEP_NODE_WAKE_GPIO);
+    }
+#endif
+    // Digital pads float in deep sleep: a gate left to float could switch
+    // a pump on. Held low until the next wake releases them.
+    for_each_pump_pin([](gpio_num_t pin) {
+        gpio_set_level(pin, 0);
+        gpio_hold_en(pin);
+    });
+    gpio_deep_sleep_hold_en();
+    esp_deep_sleep_start();
+}
+
+}  // namespace
+
+void sleep_node_run()
+{
+    const int64_t wake_rtc_ms = rtc_ms();
+    const esp_sleep_wakeup_cause_t cause = esp_sleep_get_wakeup_cause();
+
+    DutyCycleSettings cycle_settings;
+    cycle_settings.periodMs = static_cast<uint32_t>(CONFIG_WS_SLEEP_NODE_PERIOD_S) * 1000U;
+    cycle_settings.syncEvery = static_cast<uint16_t>(CONFIG_WS_SLEEP_NODE_SYNC_EVERY);
+    static DutyCycle cycle(s_block, cycle_settings);
+    const bool warm = cycle.resume(wake_rtc_ms);
+    ESP_LOGI(TAG, "wake %lu (%s, slept %lld s)",
+             static_cast<unsigned long>(cycle.counters().wakes),
+             cause == ESP_SLEEP_WAKEUP_EXT0 ? "level" : warm ? "timer" : "cold",
+             static_cast<long long>(cycle.sleptMs() / 1000));
+
+    nvs_up();
+    const esp_err_t mount_err = StorageMount::mount();
+    if (mount_err != ESP_OK) {
+        ESP_LOGE(TAG, "storage mount failed: %s (nothing logged this wake)",
+                 esp_err_to_name(mount_err));
+    }
+    static EspTimeProvider time_provider;
+    static NvsConfigStore config;
+    static LittleFsDataStorage storage(
+        StorageMount::kBasePath, StorageMount::statsProvider(),
+        LittleFsDataStorageOptions{
+            .eventLogBytes = static_cast<std::size_t>(CONFIG_WS_EVENT_LOG_KB) * 1024,
+            .eventSegments = static_cast<std::size_t>(CONFIG_WS_EVENT_LOG_SEGMENTS),
+            .clock = &time_provider,
+#if defined(CONFIG_WS_HISTORY_MULTIPLEXED)
+            .historyFormat = HistoryFormat::Multiplexed,
+#endif
+#if defined(CONFIG_WS_HISTORY_DELTA_CODEC)
+            .historyCodec = HistoryCodec::Delta,
+#endif
+#if defined(CONFIG_WS_HISTORY_ROLLUPS)
+            .rollups = true,
+#endif
+#if defined(CONFIG_WS_HISTORY_QUANTILE_SKETCHES)
+            .quantileSketches = true,
+#endif
+#if defined(CONFIG_WS_HISTORY_CHUNK_SUMMARIES)
+            .chunkSummaries = true,
+#endif
+        });
+    static SystemWallClock wall_clock;
+    static EventLogger event_logger(storage, wall_clock);
+    static SntpClient sntp;
+    sntp.applyTimezone();
+
+    static GpioWaterPump plant(static_cast<gpio_num_t>(BOARD_PIN_MAIN_PUMP), "plant",
+                               time_provider);
+    if (!plant.initialize()) {
+        ESP_LOGE(TAG, "FATAL: pump driver initialization failed");
+        abort();
+    }
+
+#if CONFIG_WS_MODBUS_CLIENT_UART
+    static UartModbusClient modbus;
+#else
+    static EspModbusClient modbus;
+#endif
+    uint8_t soil_address = ModbusSoilSensor::kDefaultDeviceAddress;
+    (void)parseSoilAddresses(CONFIG_WS_SOIL_SENSOR_ADDRESSES, &soil_address, 1);
+    static ModbusSoilSensor soil(modbus, soil_address);
+    const uint32_t modbus_baud = config.getModbusBaudRate();
+    if (modbus_baud != modbus.baudRate()) {
+        (void)modbus.setBaudRate(modbus_baud);
+    }
+    if (!modbus.initialize()) {
+        ESP_LOGE(TAG, "RS485 client init failed (error %d)", modbus.getLastError());
+    }
+    static EspI2cBus i2c_bus;
+    static Bme280Sensor env(i2c_bus);
+    env.setProfile(bme280_profiles::kForcedLowPower);
+    if (!env.initialize()) {
+        ESP_LOGW(TAG, "BME280 init failed (error %d)", env.getLastError());
+    }
+
+    static WateringController controller(soil, env, plant, config, storage, time_provider,
+                                         wall_clock, event_logger);
+    controller.setZone(ZoneSettings{kBoardZones[0].thresholdLowPct,
+                                    kBoardZones[0].thresholdHighPct, kBoardZones[0].burstS},
+                       nullptr, true);
+    static WateringSchedule schedule;
+    if (parseWateringSchedule(CONFIG_WS_WATERING_SCHEDULE, schedule) && schedule.size() > 0) {
+        controller.setSchedule(schedule);
+    }
+    if (warm) {
+        controller.restoreState(*cycle.controllerState(), cycle.sleptMs());
+    }
+
+    // Without a wall clock nothing is logged and the schedule cannot be
+    // placed: sync first then.
+    bool synced = false;
+    const bool sync_due = cycle.syncDue();
+    bool sync_tried = false;
+    if (sync_due && !wall_clock.isTimeSet()) {
+        synced = sync(config, time_provider, wall_clock, sntp, storage);
+        sync_tried = true;
+    }
+
+    controller.tick();
+    if (plant.isRunning()) {
+        cycle.noteBurst();
+        // The burst to its end: the pump's own stop (duration, 300 s cap)
+        // or the high threshold, read at the sensor-read interval.
+        const int64_t read_ms = config.getSensorReadIntervalMs();
+        int64_t next_tick = time_provider.nowMs() + read_ms;
+        while (plant.isRunning()) {
+            vTaskDelay(pdMS_TO_TICKS(kStepMs));
+            plant.update();
+            if (time_provider.nowMs() >= next_tick) {
+                controller.tick();
+                next_tick += read_ms;
+            }
+        }
+        controller.tick();  // records the burst end: the soak origin
+    }
+
+    if (sync_due && !sync_tried) {
+        synced = sync(config, time_provider, wall_clock, sntp, storage);
+    }
+    if (sync_due) {
+        cycle.noteSync(synced);
+    }
+
+    const int64_t now = time_provider.nowMs();
+    const uint32_t sleep_ms = cycle.planSleepMs(now, controller.soakEndsAtMs(now),
+                                                controller.windowOpensAtMs(now));
+    WateringControllerState state{};
+    controller.saveState(state);
+    const int64_t sleep_rtc_ms = rtc_ms();
+    cycle.seal(state, sleep_rtc_ms, static_cast<uint32_t>(sleep_rtc_ms - wake_rtc_ms));
+    ESP_LOGI(TAG, "awake %lld ms, sleeping %lu s (wakes %lu, bursts %lu, syncs %lu/%lu)",
+             static_cast<long long>(sleep_rtc_ms - wake_rtc_ms),
+             static_cast<unsigned long>(sleep_ms / 1000),
+             static_cast<unsigned long>(cycle.counters().wakes),
+             static_cast<unsigned long>(cycle.counters().bursts),
+             static_cast<unsigned long>(cycle.counters().syncs),
+             static_cast<unsigned long>(cycle.counters().syncs + cycle.counters().syncFailures));
+    sleep_for(sleep_ms);
+}
+
+#else
+
+#include <cstdlib>
+
+void sleep_node_run()
+{
+    // app_main calls this only with CONFIG_WS_DEEP_SLEEP_NODE.
+    abort();
+}
+
+#endif  // CONFIG_WS_DEEP_SLEEP_NODE
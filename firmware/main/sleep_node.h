@@ -0,0 +1,35 @@
+// SPDX-FileCopyrightText: 2026 Cryptotomte
+// SPDX-License-Identifier: AGPL-3.0-or-later
+/**
+ * @file sleep_node.h
+ * @brief Deep-sleep battery node: one watering decision per wake (app
+ *        wiring, CONFIG_WS_DEEP_SLEEP_NODE).
+ *
+ * sleep_node_run() replaces the rest of app_main. It brings up only what a
+ * decision needs — NVS config, the littlefs history, the plant pump, the
+ * primary soil probe (its raw Modbus client, no bus task) and the BME280 in
+ * forced mode — restores the WateringController from the RTC_NOINIT
+ * DutyCycleState (control/DutyCycle.h), ticks it once, and when that starts
+ * a burst keeps ticking at the sensor-read interval until the pump has
+ * stopped. Every WS_SLEEP_NODE_SYNC_EVERY wakes Wi-Fi comes up, bounded by
+ * WS_SLEEP_NODE_SYNC_TIMEOUT_S, for SNTP and (CONFIG_WS_MQTT) the history
+ * replay; a first wake with the wall clock unset syncs before deciding, so
+ * its readings are logged and the schedule applies.
+ *
+ * The pump gates are held low through the sleep (gpio_hold), and the node
+ * sleeps until its timer or a level change on WS_SLEEP_NODE_WAKE_GPIO.
+ * Zone 0 only; the further zones' pumps stay off.
+ */
+
+#ifndef WATERINGSYSTEM_MAIN_SLEEP_NODE_H
+#define WATERINGSYSTEM_MAIN_SLEEP_NODE_H
+
+/**
+ * @brief Run this wake's decision and go back to deep sleep.
+ *
+ * Call from app_main right after pumps_force_off() and the banner, in
+ * place of the normal boot. Does not return.
+ */
+[[noreturn]] void sleep_node_run();
+
+#endif /* WATERINGSYSTEM_MAIN_SLEEP_NODE_H */
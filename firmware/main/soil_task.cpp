@@ -0,0 +1,285 @@
+// SPDX-FileCopyrightText: 2026 Cryptotomte
+// SPDX-License-Identifier: AGPL-3.0-or-later
+/**
+ * @file soil_task.cpp
+ * @brief Soil acquisition at the sensor-read cadence.
+ *
+ * Each period starts with one primary read (SoilAcquirer::acquire(): the
+ * blocking Modbus round-trip, then the publish that wakes the watering
+ * task), and the sleep that follows wakes at each further probe's
+ * SoilPollScheduler slot to read it, one probe per wake with a WDT feed
+ * after each.
+ *
+ * Watchdog: the task subscribes to the task WDT and sleeps in bounded
+ * kFeedChunkMs slices, because the operator-writable interval has no upper
+ * bound and may exceed the WDT timeout (the same reasoning as the watering
+ * task had when it did the reads). One blocking read is well under the
+ * WDT timeout.
+ *
+ * Config changes: a LockedConfigStore write wakes the current slice early
+ * and the cadence is re-read; a period that is now already over ends the
+ * sleep at once.
+ *
+ * Adaptive cadence (CONFIG_WS_ADAPTIVE_POLLING): the configured interval is
+ * the base of a PollCadence. While the primary probe's moisture and
+ * temperature hold still the period doubles, but only up to half the
+ * controller's staleness window, so a steady soil never reads as stale;
+ * while the probe keeps failing it backs off to
+ * CONFIG_WS_ADAPTIVE_POLL_MAX_S (the controller has already failed safe).
+ * The active pump starting cuts a backed-off period back to the base.
+ *
+ * soil_task_request_read() (the watering task at the end of a soak pause)
+ * ends the current period early, so the next primary read runs at once.
+ *
+ * Read groups (CONFIG_WS_SOIL_READ_GROUPS): the primary read is the fast
+ * group (moisture, temperature); the slow group (EC, pH, NPK) follows it
+ * as its own transaction once per data-log interval, after the fast sample
+ * is already published.
+ *
+ * Burst capture (CONFIG_WS_SOIL_BURST_CAPTURE): while the plant pump runs
+ * and for the capture's tail after it stops, the sleep is cut into gaps of
+ * one read's airtime (at least kMinCaptureGapMs) and every gap ends with
+ * an extra fast-group read of the primary probe. Each is published like
+ * any other and folded into the MoistureBurstCapture, which writes the
+ * capture in one batch — on this task — when the tail ends. A further
+ * probe's slot still wins its wake-up.
+ */
+
+#include "soil_task.h"
+
+#include <atomic>
+#include <cmath>
+
+#include "esp_log.h"
+#include "esp_timer.h"
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+
+#include "control/WateringController.h"
+#include "sensors/MoistureBurstCapture.h"
+#include "sensors/PollCadence.h"
+#include "boot_profile.h"
+#include "task_plan.h"
+#include "task_watchdog.h"
+
+static const char *TAG = "soil_task";
+
+namespace {
+
+constexpr uint32_t kFloorMs = 1000;     ///< IConfigStore sensor-interval floor
+constexpr uint32_t kFeedChunkMs = 1000; ///< max sleep between WDT feeds
+#if defined(CONFIG_WS_ADAPTIVE_POLLING)
+constexpr uint32_t kMaxPeriodMs = CONFIG_WS_ADAPTIVE_POLL_MAX_S * 1000u;
+#else
+constexpr uint32_t kMaxPeriodMs = 0;  ///< below any base: fixed cadence
+#endif
+constexpr uint32_t kMaxStablePeriodMs =
+    static_cast<uint32_t>(WateringController::kStalenessMs / 2) < kMaxPeriodMs
+        ? static_cast<uint32_t>(WateringController::kStalenessMs / 2)
+        : kMaxPeriodMs;
+
+/// Floor of the pause between two burst-capture reads. The pause is one
+/// read's airtime, so the capture holds the segment about half the time
+/// and Control-class transactions still get through.
+constexpr uint32_t kMinCaptureGapMs = 20;
+
+// Change thresholds on the (filtered) primary sample.
+constexpr float kMoistureStepPct = 0.5f;
+constexpr float kTemperatureStepC = 0.3f;
+
+struct SoilTaskCtx {
+    SoilAcquirer* acquirer;
+    SoilPollScheduler* soilPoller;
+    IConfigStore* config;
+    const IWaterPump* activePump;
+    MoistureBurstCapture* capture;
+};
+
+SoilTaskCtx ctx;
+TaskHandle_t s_task = nullptr;
+std::atomic<bool> s_readRequested{false};
+
+uint32_t readPeriodMs(const IConfigStore& config)
+{
+    const uint32_t periodMs = config.getSensorReadIntervalMs();
+    return periodMs < kFloorMs ? kFloorMs : periodMs;
+}
+
+int64_t nowMs()
+{
+    return esp_timer_get_time() / 1000;
+}
+
+PollCadenceLimits cadenceFor(uint32_t baseMs)
+{
+    return {baseMs, baseMs, kMaxStablePeriodMs, kMaxPeriodMs};
+}
+
+bool pumpRunning(const SoilTaskCtx& c)
+{
+    return c.activePump != nullptr && c.activePump->isRunning();
+}
+
+/// True while a burst capture wants high-rate reads (advances it).
+bool capturing(const SoilTaskCtx& c)
+{
+    return c.capture != nullptr && c.capture->update(pumpRunning(c), nowMs());
+}
+
+/// Hand the newest primary sample to the burst capture, if any.
+void captureLatest(const SoilTaskCtx& c)
+{
+    if (c.capture != nullptr) {
+        c.capture->add(c.acquirer->latest());
+    }
+}
+
+/// Pause between burst-capture reads: one read's airtime, floored.
+uint32_t captureGapMs(const SoilTaskCtx& c)
+{
+    const uint32_t airtimeMs = c.soilPoller->usage().readAirtimeUs / 1000;
+    return airtimeMs > kMinCaptureGapMs ? airtimeMs : kMinCaptureGapMs;
+}
+
+#if defined(CONFIG_WS_SOIL_READ_GROUPS)
+constexpr SoilReadGroup kPrimaryGroup = SoilReadGroup::Fast;
+
+/// The slow group once per data-log interval, counted from the last try so
+/// a probe that keeps failing it costs one transaction per interval.
+void readSlowGroupIfDue(const SoilTaskCtx& c, int64_t& lastTryMs)
+{
+    const int64_t now = nowMs();
+    if (lastTryMs != 0 &&
+        now - lastTryMs < static_cast<int64_t>(c.config->getDataLogIntervalMs())) {
+        return;
+    }
+    lastTryMs = now;
+    if (!c.acquirer->acquire(SoilReadGroup::Slow)) {
+        ESP_LOGW(TAG, "soil EC/pH/NPK read failed; retry in one log interval");
+    }
+    watchdog_feed();
+}
+#else
+constexpr SoilReadGroup kPrimaryGroup = SoilReadGroup::All;
+#endif
+
+[[noreturn]] void soil_task(void* arg)
+{
+    SoilTaskCtx* c = static_cast<SoilTaskCtx*>(arg);
+    watchdog_subscribe_current_task();
+
+    uint32_t baseMs = readPeriodMs(*c->config);
+    PollCadence cadence(cadenceFor(baseMs));
+    const uint32_t gapMs = captureGapMs(*c);
+    float refMoisture = NAN;
+    float refTemperature = NAN;
+#if defined(CONFIG_WS_SOIL_READ_GROUPS)
+    int64_t lastSlowTryMs = 0;
+#endif
+    while (true) {
+        // The primary probe first: the watering task decides on this sample
+        // as soon as it is published.
+        PollCadence::Outcome outcome = PollCadence::Outcome::Failed;
+        if (c->acquirer->acquire(kPrimaryGroup)) {
+            if (boot_mark(BootPhase::FirstReading)) {
+                ESP_LOGI(TAG, "first valid soil reading %lu ms after reset",
+                         static_cast<unsigned long>(
+                             boot_profile().atUs(BootPhase::FirstReading) / 1000));
+            }
+            const SoilSnapshot soil = c->acquirer->latest().soil;
+            const bool m = PollCadence::moved(soil.moisture, refMoisture,
+                                              kMoistureStepPct);
+            const bool t = PollCadence::moved(soil.temperature, refTemperature,
+                                              kTemperatureStepC);
+            outcome = (m || t) ? PollCadence::Outcome::Changed
+                               : PollCadence::Outcome::Stable;
+        }
+        captureLatest(*c);
+        watchdog_feed();
+#if defined(CONFIG_WS_SOIL_READ_GROUPS)
+        readSlowGroupIfDue(*c, lastSlowTryMs);
+#endif
+        uint32_t periodMs = cadence.next(pumpRunning(*c), outcome);
+        c->soilPoller->beginPeriod(nowMs(), periodMs);
+
+        // Chunked feed-and-sleep; a slice also ends at the next probe's slot.
+        uint32_t slept = 0;
+        while (slept < periodMs) {
+            uint32_t chunk =
+                (periodMs - slept < kFeedChunkMs) ? (periodMs - slept)
+                                                  : kFeedChunkMs;
+            const uint32_t untilProbe = c->soilPoller->msUntilDue(nowMs());
+            if (untilProbe < chunk) {
+                chunk = untilProbe;
+            }
+            const bool capture = capturing(*c);
+            if (capture && gapMs < chunk) {
+                chunk = gapMs;
+            }
+            const TickType_t start = xTaskGetTickCount();
+            const bool changed =
+                chunk != 0 && ulTaskNotifyTake(pdTRUE, pdMS_TO_TICKS(chunk)) != 0;
+            const bool polled = c->soilPoller->pollDue(nowMs());
+            const bool captured = capture && !polled;
+            if (captured) {
+                c->acquirer->acquire(kPrimaryGroup);
+                captureLatest(*c);
+            }
+            watchdog_feed();
+            slept += (changed || polled || captured)
+                         ? pdTICKS_TO_MS(xTaskGetTickCount() - start)
+                         : chunk;
+            if (changed && readPeriodMs(*c->config) != baseMs) {
+                baseMs = readPeriodMs(*c->config);
+                cadence.setLimits(cadenceFor(baseMs));
+                periodMs = baseMs;
+            }
+            if (periodMs > baseMs && pumpRunning(*c)) {
+                periodMs = baseMs;  // watering started: back to the base
+            }
+            if (changed && s_readRequested.exchange(false)) {
+                break;  // a fresh primary sample was asked for
+            }
+        }
+    }
+}
+
+}  // namespace
+
+void soil_task_request_read(void)
+{
+    if (s_task != nullptr) {
+        s_readRequested.store(true);
+        xTaskNotifyGive(s_task);
+    }
+}
+
+void soil_task_start(SoilAcquirer& acquirer, SoilPollScheduler& soilPoller,
+                     LockedConfigStore& config, EventLogger& events,
+                     const IWaterPump* activePump, MoistureBurstCapture* capture)
+{
+    ctx.acquirer = &acquirer;
+    ctx.soilPoller = &soilPoller;
+    ctx.config = &config;
+    ctx.activePump = activePump;
+    ctx.capture = activePump != nullptr ? capture : nullptr;
+
+    const BaseType_t created =
+        task_plan_create<task_plan::kSoil>(soil_task, &ctx, &s_task);
+    if (created != pdPASS) {
+        ESP_LOGE(TAG, "failed to create soil task");
+        events.logFailsafe("soil-task-start-failed");
+        return;
+    }
+    const bool subscribed = config.subscribe([] {
+        if (s_task != nullptr) {
+            xTaskNotifyGive(s_task);
+        }
+    });
+    if (!subscribed) {
+        ESP_LOGW(TAG, "config listener slots full; interval changes apply "
+                      "after the current period");
+    }
+    ESP_LOGI(TAG, "soil task started (%lu ms cadence floor)",
+             static_cast<unsigned long>(kFloorMs));
+}
@@ -0,0 +1,61 @@
+// SPDX-FileCopyrightText: 2026 Cryptotomte
+// SPDX-License-Identifier: AGPL-3.0-or-later
+/**
+ * @file soil_task.h
+ * @brief Soil acquisition task (app wiring).
+ *
+ * App-level FreeRTOS task, not a component: it owns every blocking soil
+ * read. At the sensor-read cadence it reads the primary probe through the
+ * SoilAcquirer, which publishes a timestamped snapshot and wakes the
+ * watering task, then reads any further probes at their SoilPollScheduler
+ * slots. The watering decision never waits on the bus. While the plant
+ * pump runs it can also read the primary probe back to back for a
+ * MoistureBurstCapture.
+ */
+
+#ifndef WATERINGSYSTEM_MAIN_SOIL_TASK_H
+#define WATERINGSYSTEM_MAIN_SOIL_TASK_H
+
+#include "events/EventLogger.h"
+#include "interfaces/IWaterPump.h"
+#include "sensors/MoistureBurstCapture.h"
+#include "sensors/SoilAcquirer.h"
+#include "sensors/SoilPollScheduler.h"
+#include "storage/LockedConfigStore.h"
+
+/**
+ * @brief Start the soil acquisition task.
+ *
+ * Call after watering_task_start(), which installs the acquirer's listener.
+ * The task subscribes to the task WDT and reads every
+ * IConfigStore::getSensorReadIntervalMs(), floored at 1000 ms; it subscribes
+ * to @p config, so a changed interval applies at once. With
+ * CONFIG_WS_ADAPTIVE_POLLING that interval is the base of an adaptive
+ * cadence (PollCadence): longer while the primary sample holds still or
+ * keeps failing, the base again once it moves or @p activePump runs. A
+ * task-creation failure is logged and recorded as a durable failsafe event;
+ * the watering task then sees no samples and fails safe as "soil-stale".
+ *
+ * @param acquirer   Primary probe reader and snapshot publisher.
+ * @param soilPoller Further soil probes, read at their slots between
+ *                   primary reads; a period opens after every primary read.
+ * @param config     Runtime-tunable cadence (subscribed to).
+ * @param events     Persistent event log for a task-creation failure.
+ * @param activePump The plant pump: no backoff while it runs; nullptr =
+ *                   never active.
+ * @param capture    Fed the primary probe at the bus's pace while
+ *                   @p activePump runs and for its tail; nullptr = off.
+ */
+void soil_task_start(SoilAcquirer& acquirer, SoilPollScheduler& soilPoller,
+                     LockedConfigStore& config, EventLogger& events,
+                     const IWaterPump* activePump,
+                     MoistureBurstCapture* capture = nullptr);
+
+/**
+ * @brief Ask for a primary read now instead of at the end of the current
+ *        period (the cadence restarts from it). Any task; a no-op before
+ *        soil_task_start().
+ */
+void soil_task_request_read(void);
+
+#endif /* WATERINGSYSTEM_MAIN_SOIL_TASK_H */
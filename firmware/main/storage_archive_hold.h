@@ -0,0 +1,51 @@
+// SPDX-FileCopyrightText: 2026 Cryptotomte
+// SPDX-License-Identifier: AGPL-3.0-or-later
+/**
+ * @file storage_archive_hold.h
+ * @brief The littlefs store held for GET /api/v1/backup and POST
+ *        /api/v1/restore (app wiring; api/StorageArchive.h).
+ *
+ * App-level glue, not a component: the api component does not depend on
+ * storage, so the hold it asks for is built here from the same offline
+ * mode the deferred mount uses (LockedDataStorage::runOffline()). The
+ * backend's buffered records are committed first, so the archive holds
+ * them; writes arriving meanwhile queue in RAM up to @p queueDepth and
+ * land once the job returns. After a restore the backend drops what it
+ * derived from the old files. The event counts (/events/summary) are not
+ * recounted: they catch up with the restored log at the next boot.
+ */
+
+#ifndef WATERINGSYSTEM_MAIN_STORAGE_ARCHIVE_HOLD_H
+#define WATERINGSYSTEM_MAIN_STORAGE_ARCHIVE_HOLD_H
+
+#include <cstddef>
+
+#include "api/StorageArchive.h"
+#include "storage/LittleFsDataStorage.h"
+#include "storage/LockedDataStorage.h"
+
+class StorageArchiveHold final : public api::IStorageHold {
+public:
+    StorageArchiveHold(LockedDataStorage& locked, LittleFsDataStorage& backend,
+                       std::size_t queueDepth)
+        : locked_(locked), backend_(backend), queueDepth_(queueDepth)
+    {
+    }
+
+    void runHeld(api::IStorageJob& job) override
+    {
+        locked_.runOffline(queueDepth_, [&] {
+            backend_.flush();
+            if (job.run()) {
+                backend_.reloadFromFiles();
+            }
+        });
+    }
+
+private:
+    LockedDataStorage& locked_;
+    LittleFsDataStorage& backend_;
+    std::size_t queueDepth_;
+};
+
+#endif /* WATERINGSYSTEM_MAIN_STORAGE_ARCHIVE_HOLD_H */
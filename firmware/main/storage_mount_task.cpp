@@ -0,0 +1,157 @@
+// SPDX-FileCopyrightText: 2026 Cryptotomte
+// SPDX-License-Identifier: AGPL-3.0-or-later
+/**
+ * @file storage_mount_task.cpp
+ * @brief The deferred littlefs mount (see storage_mount_task.h).
+ *
+ * Two event-group bits: kHeldBit once the storage is held offline (the
+ * boot task waits for it, microseconds, before anything may read), and
+ * kReadyBit once the mount and the steps after it are done (the readers
+ * of raw volume files wait for it).
+ */
+
+#include "storage_mount_task.h"
+
+#include <string>
+
+#include "esp_log.h"
+#include "esp_timer.h"
+#include "freertos/FreeRTOS.h"
+#include "freertos/event_groups.h"
+#include "freertos/task.h"
+
+#include "storage/LegacyHistoryImport.h"
+#include "storage/StorageMount.h"
+
+#include "boot_profile.h"
+#include "lifetime_counters.h"
+#include "sdkconfig.h"
+#include "task_plan.h"
+
+static const char *TAG = "storage_mount";
+
+namespace {
+
+constexpr EventBits_t kHeldBit = BIT0;
+constexpr EventBits_t kReadyBit = BIT1;
+
+/// Created by storage_mount_start() before the task; null until then.
+EventGroupHandle_t s_state = nullptr;
+
+#if defined(CONFIG_WS_LEGACY_HISTORY_IMPORT)
+/// Stream the Arduino v2.3 history into the mounted volume (the backend
+/// is still ours alone: the hold keeps every other caller out).
+void import_legacy_history(LittleFsDataStorage& storage)
+{
+    const int64_t startUs = esp_timer_get_time();
+    const legacy::ImportStats stats = legacy::importHistory(
+        std::string(StorageMount::kBasePath) + "/" + CONFIG_WS_LEGACY_HISTORY_DIR, storage);
+    if (stats.files == 0 && stats.failed == 0) {
+        return;  // nothing (left) to import
+    }
+    ESP_LOGI(TAG,
+             "legacy history: %u files, %u readings in %u chunks (%u resumed, "
+             "%u skipped) in %lld ms",
+             static_cast<unsigned>(stats.files), static_cast<unsigned>(stats.points),
+             static_cast<unsigned>(stats.chunks), static_cast<unsigned>(stats.resumed),
+             static_cast<unsigned>(stats.skipped),
+             static_cast<long long>((esp_timer_get_time() - startUs) / 1000));
+    if (stats.failed != 0) {
+        ESP_LOGW(TAG, "legacy history: %u files not imported; retried next boot",
+                 static_cast<unsigned>(stats.failed));
+    }
+}
+#endif
+
+/// Mount with the storage held offline, then the steps that read it.
+void run_job(StorageMountJob& job)
+{
+    const int64_t startUs = esp_timer_get_time();
+    esp_err_t err = ESP_OK;
+    auto mount = [&] {
+        if (s_state != nullptr) {
+            xEventGroupSetBits(s_state, kHeldBit);
+        }
+        // Mount-or-format of the `storage` partition at /storage (FR-007;
+        // a corrupted filesystem is reformatted, never bricks).
+        err = StorageMount::mount();
+#if defined(CONFIG_WS_LEGACY_HISTORY_IMPORT)
+        if (err == ESP_OK && job.legacyImport != nullptr) {
+            import_legacy_history(*job.legacyImport);
+        }
+#endif
+    };
+    if (job.hold != nullptr) {
+        job.hold->runOffline(job.earlyWrites, mount);
+    } else {
+        mount();
+    }
+    if (err != ESP_OK) {
+        ESP_LOGE(TAG, "storage mount failed: %s (data storage unavailable)",
+                 esp_err_to_name(err));
+    } else {
+        ESP_LOGI(TAG, "storage mounted in %lld ms",
+                 static_cast<long long>((esp_timer_get_time() - startUs) / 1000));
+    }
+    boot_mark(BootPhase::Storage);
+
+    // The log now holds the events queued during the mount too, so a cold
+    // boot's recount includes them.
+    event_counts_restore(*job.counts, *job.storage);
+
+    // One-line usage report (parity: storage usage in the serial status
+    // block; FR-008).
+    const StorageStats stats = job.storage->getStorageStats();
+    ESP_LOGI(TAG, "Storage: %lu/%lu KiB used",
+             static_cast<unsigned long>(stats.usedBytes / 1024),
+             static_cast<unsigned long>(stats.totalBytes / 1024));
+    if (stats.locks.offlineDropped != 0) {
+        ESP_LOGW(TAG, "%lu writes dropped while mounting (early queue full)",
+                 static_cast<unsigned long>(stats.locks.offlineDropped));
+    }
+}
+
+#if defined(CONFIG_WS_STORAGE_ASYNC_MOUNT)
+/// One-shot: @p arg is the StorageMountJob.
+void storage_mount_task(void *arg)
+{
+    run_job(*static_cast<StorageMountJob *>(arg));
+    xEventGroupSetBits(s_state, kReadyBit);
+    vTaskDelete(nullptr);
+}
+#endif
+
+}  // namespace
+
+void storage_mount_start(StorageMountJob& job)
+{
+#if defined(CONFIG_WS_STORAGE_ASYNC_MOUNT)
+    static StaticEventGroup_t state_buf;
+    s_state = xEventGroupCreateStatic(&state_buf);
+    if (task_plan_create<task_plan::kStorageMount>(storage_mount_task, &job) == pdPASS) {
+        xEventGroupWaitBits(s_state, kHeldBit, pdFALSE, pdTRUE, portMAX_DELAY);
+        return;
+    }
+    ESP_LOGE(TAG, "failed to create the storage mount task; mounting inline");
+#endif
+    run_job(job);
+    if (s_state != nullptr) {
+        xEventGroupSetBits(s_state, kReadyBit);
+    }
+}
+
+bool storage_wait_ready(const char* waiter, uint32_t timeoutMs)
+{
+    if (s_state == nullptr || (xEventGroupGetBits(s_state) & kReadyBit) != 0) {
+        return true;
+    }
+    ESP_LOGI(TAG, "%s waits for the storage mount", waiter);
+    const EventBits_t bits = xEventGroupWaitBits(s_state, kReadyBit, pdFALSE, pdTRUE,
+                                                 pdMS_TO_TICKS(timeoutMs));
+    if ((bits & kReadyBit) == 0) {
+        ESP_LOGW(TAG, "%s: storage still mounting after %lu ms; going on", waiter,
+                 static_cast<unsigned long>(timeoutMs));
+        return false;
+    }
+    return true;
+}
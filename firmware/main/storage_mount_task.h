@@ -0,0 +1,61 @@
+// SPDX-FileCopyrightText: 2026 Cryptotomte
+// SPDX-License-Identifier: AGPL-3.0-or-later
+/**
+ * @file storage_mount_task.h
+ * @brief littlefs mount on a one-shot helper task, readiness in an event
+ *        group (app wiring, CONFIG_WS_STORAGE_ASYNC_MOUNT).
+ *
+ * App-level FreeRTOS task, not a component. A mount that has to walk a
+ * large or damaged volume takes seconds; on the boot task it held up
+ * Wi-Fi, RS485 and the controllers behind it. The helper mounts while the
+ * boot task goes on: the LockedDataStorage is held offline for the mount
+ * (LockedDataStorage::runOffline()), so early readings and events queue in
+ * RAM and land once it is up, and then the steps that need the volume's
+ * contents run — the event counts rebuilt from the log, the usage line.
+ * A legacy history import (CONFIG_WS_LEGACY_HISTORY_IMPORT) runs under the
+ * same hold, right after the mount. The safety loop never touches storage; the boot task only waits where it
+ * reads files itself (the HTTPS key pair, the setup portal's assets).
+ */
+
+#ifndef WATERINGSYSTEM_MAIN_STORAGE_MOUNT_TASK_H
+#define WATERINGSYSTEM_MAIN_STORAGE_MOUNT_TASK_H
+
+#include <cstddef>
+#include <cstdint>
+
+#include "events/EventCounts.h"
+#include "interfaces/IDataStorage.h"
+#include "storage/LittleFsDataStorage.h"
+#include "storage/LockedDataStorage.h"
+
+/// What the mount task mounts and, once mounted, restores.
+struct StorageMountJob {
+    LockedDataStorage* hold = nullptr;  ///< held offline for the mount; null: none (ring log)
+    std::size_t earlyWrites = 0;        ///< writes that may queue meanwhile
+    IDataStorage* storage = nullptr;    ///< the cross-task storage, read once mounted
+    EventCounts* counts = nullptr;      ///< rebuilt from the log once mounted
+    /// Legacy history imported into it under the hold; null: none
+    /// (CONFIG_WS_LEGACY_HISTORY_IMPORT).
+    LittleFsDataStorage* legacyImport = nullptr;
+};
+
+/**
+ * @brief Mount the volume for @p job on the helper task; returns once the
+ * storage is held offline, so no caller can read it unmounted.
+ *
+ * With CONFIG_WS_STORAGE_ASYNC_MOUNT off, or when the task cannot be
+ * created (logged), everything runs inline before returning, as before.
+ * @p job must outlive the task (a function-local static).
+ */
+void storage_mount_start(StorageMountJob& job);
+
+/**
+ * @brief Wait up to @p timeoutMs for the mount and its follow-up steps.
+ *
+ * Returns at once once they are done, or when no mount was started. A
+ * wait is logged with @p waiter, a timeout as a warning.
+ * @return true when the volume is ready
+ */
+bool storage_wait_ready(const char* waiter, uint32_t timeoutMs);
+
+#endif /* WATERINGSYSTEM_MAIN_STORAGE_MOUNT_TASK_H */
@@ -0,0 +1,75 @@
+// SPDX-FileCopyrightText: 2026 Cryptotomte
+// SPDX-License-Identifier: AGPL-3.0-or-later
+/**
+ * @file storage_writer_task.cpp
+ * @brief Applies QueuedDataStorage's queue off the decision path.
+ *
+ * The task blocks in waitAndApply() until a producer queues a write or the
+ * watering tick asks for a group-commit poll (flushIfDue()), and wakes at
+ * least every kPollMs so a deadline is never missed by more than that.
+ * Queue overflow is the decorator's business (refused and counted); this
+ * task only reports the counters when they move.
+ */
+
+#include "storage_writer_task.h"
+
+#include "esp_log.h"
+#include "esp_system.h"
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+
+#include "task_plan.h"
+
+static const char *TAG = "storage_writer";
+
+namespace {
+
+constexpr uint32_t kPollMs = 1000;      ///< upper bound between wake-ups
+
+QueuedDataStorage* s_storage = nullptr;
+
+/// esp_restart() shutdown handler: nothing accepted is lost to a reboot.
+void drain_on_shutdown()
+{
+    if (s_storage != nullptr && !s_storage->drain()) {
+        ESP_LOGW(TAG, "drain before restart: flush failed");
+    }
+}
+
+[[noreturn]] void storage_writer_task(void* arg)
+{
+    QueuedDataStorage& storage = *static_cast<QueuedDataStorage*>(arg);
+    uint32_t reportedDrops = 0;
+    uint32_t reportedFailures = 0;
+    while (true) {
+        if (storage.waitAndApply(kPollMs) == 0) {
+            continue;
+        }
+        const StorageQueueStats queue = storage.getStorageStats().queue;
+        if (queue.dropped != reportedDrops || queue.failed != reportedFailures) {
+            ESP_LOGW(TAG, "queue: %lu dropped (full), %lu rejected by storage",
+                     static_cast<unsigned long>(queue.dropped),
+                     static_cast<unsigned long>(queue.failed));
+            reportedDrops = queue.dropped;
+            reportedFailures = queue.failed;
+        }
+    }
+}
+
+}  // namespace
+
+bool storage_writer_task_start(QueuedDataStorage& storage)
+{
+    const BaseType_t created =
+        task_plan_create<task_plan::kStorageWriter>(storage_writer_task, &storage);
+    if (created != pdPASS) {
+        ESP_LOGE(TAG, "failed to create storage writer task");
+        return false;
+    }
+    s_storage = &storage;
+    const esp_err_t err = esp_register_shutdown_handler(&drain_on_shutdown);
+    if (err != ESP_OK) {
+        ESP_LOGW(TAG, "shutdown drain not registered: %s", esp_err_to_name(err));
+    }
+    return true;
+}
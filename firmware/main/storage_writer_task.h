@@ -0,0 +1,34 @@
+// SPDX-FileCopyrightText: 2026 Cryptotomte
+// SPDX-License-Identifier: AGPL-3.0-or-later
+/**
+ * @file storage_writer_task.h
+ * @brief Low-priority task that applies queued storage writes (app wiring).
+ *
+ * App-level FreeRTOS task, not a component: it runs QueuedDataStorage's
+ * waitAndApply() loop so littlefs/flash writes (and their fsyncs) happen
+ * here instead of inside the watering task's tick or the 10 Hz loop.
+ */
+
+#ifndef WATERINGSYSTEM_MAIN_STORAGE_WRITER_TASK_H
+#define WATERINGSYSTEM_MAIN_STORAGE_WRITER_TASK_H
+
+#include "storage/QueuedDataStorage.h"
+
+/**
+ * @brief Start the storage writer task and register the reboot drain.
+ *
+ * Pass the QueuedDataStorage in front of the cross-task LockedDataStorage;
+ * it must outlive the task (a function-local static from app_main). Also
+ * registers an esp_restart() shutdown handler that drain()s the queue, so
+ * writes accepted before a reboot or OTA switch reach the flash.
+ *
+ * Not watchdog-subscribed: a slow flush delays only this task, and the
+ * watering path never waits on it.
+ *
+ * @return false when the task could not be created — the caller then
+ *         keeps writing through the LockedDataStorage directly (nothing
+ *         would apply the queue).
+ */
+bool storage_writer_task_start(QueuedDataStorage& storage);
+
+#endif /* WATERINGSYSTEM_MAIN_STORAGE_WRITER_TASK_H */
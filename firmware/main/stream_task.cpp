@@ -0,0 +1,49 @@
+// SPDX-FileCopyrightText: 2026 Cryptotomte
+// SPDX-License-Identifier: AGPL-3.0-or-later
+/**
+ * @file stream_task.cpp
+ * @brief /api/v1/stream publisher cadence (see stream_task.h).
+ *
+ * 250 ms keeps a level-mark flip or a pump start well under a second from
+ * the dashboard while the sensor sections still only change every 5 s. The
+ * sends happen on the httpd task (ApiServer::drainStream()), so a slow
+ * client costs this task nothing.
+ */
+
+#include "stream_task.h"
+
+#include "esp_log.h"
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+
+#include "task_plan.h"
+
+static const char *TAG = "stream_task";
+
+namespace {
+
+constexpr uint32_t kPeriodMs = 250;     ///< publish cadence
+
+[[noreturn]] void stream_task(void *arg)
+{
+    api::ApiServer &server = *static_cast<api::ApiServer *>(arg);
+    TickType_t lastWake = xTaskGetTickCount();
+    while (true) {
+        vTaskDelayUntil(&lastWake, pdMS_TO_TICKS(kPeriodMs));
+        server.pollStream();
+    }
+}
+
+}  // namespace
+
+void stream_task_start(api::ApiServer& server)
+{
+    const BaseType_t created =
+        task_plan_create<task_plan::kStream>(stream_task, &server);
+    if (created != pdPASS) {
+        ESP_LOGE(TAG, "failed to create stream task");
+        return;
+    }
+    ESP_LOGI(TAG, "stream task started (%lu ms cadence)",
+             static_cast<unsigned long>(kPeriodMs));
+}
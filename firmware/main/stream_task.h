@@ -0,0 +1,31 @@
+// SPDX-FileCopyrightText: 2026 Cryptotomte
+// SPDX-License-Identifier: AGPL-3.0-or-later
+/**
+ * @file stream_task.h
+ * @brief Publisher task for the /api/v1/stream live telemetry push.
+ *
+ * App-level FreeRTOS task: every kPeriodMs it asks the ApiServer to queue
+ * what changed for the connected stream clients (ApiServer::pollStream()).
+ * Its own task, not the 10 Hz main loop, because building the sensor DTO
+ * reads the soil getters, which can wait behind a Modbus round-trip on the
+ * watering task.
+ */
+
+#ifndef WATERINGSYSTEM_MAIN_STREAM_TASK_H
+#define WATERINGSYSTEM_MAIN_STREAM_TASK_H
+
+#include "api/ApiServer.h"
+
+/**
+ * @brief Start the stream publisher task.
+ *
+ * Call once, after the ApiServer exists (station mode only). The task is
+ * not watchdog-subscribed — it is on the network side, like the WiFi task —
+ * and costs one clientCount() check per period while nobody is connected.
+ * A creation failure is logged and swallowed: the REST endpoints still work.
+ *
+ * @param server Must outlive the task (a function-local static).
+ */
+void stream_task_start(api::ApiServer& server);
+
+#endif /* WATERINGSYSTEM_MAIN_STREAM_TASK_H */
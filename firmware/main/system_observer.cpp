@@ -11,16 +11,26 @@
  * external poll cannot reliably attribute the cause (console vs controller),
  * so a deterministic placeholder is used until the controller (PR-11) owns and
  * records the cause at the command site.
+ *
+ * The wake is a task notification: any number of callbacks before the task
+ * runs fold into one pass, so a callback never blocks and never drops.
  */
 
 #include "system_observer.h"
 
 #include "esp_log.h"
 
+#include "boot_profile.h"
+#include "storage_mount_task.h"
+#include "task_plan.h"
+
 namespace {
 
 const char* TAG = "sys_observer";
 
+/// Longest the first API start waits for the deferred storage mount.
+constexpr uint32_t kStorageWaitMs = 30 * 1000;
+
 
 /// Short, stable name for each WifiState (matches the enum labels so the
 /// event detail reads e.g. "wifi=Connected"). Total over the enum.
@@ -38,11 +48,61 @@ const char* wifiStateName(WifiState state)
 
 }  // namespace
 
+bool SystemObserver::start()
+{
+    TaskHandle_t handle = nullptr;
+    if (task_plan_create<task_plan::kObserver>(&SystemObserver::task, this, &handle) != pdPASS) {
+        ESP_LOGE(TAG, "failed to create observer task");
+        return false;
+    }
+    task_.store(handle, std::memory_order_release);
+    if (wifi_ != nullptr) {
+        wifi_->setObserver(this);
+    }
+    return true;
+}
+
+void SystemObserver::onRunningChanged(bool running)
+{
+    (void)running;  // re-read by the pass, with every other pump's
+    wake();
+}
+
+void SystemObserver::onStateChanged(WifiState state)
+{
+    (void)state;  // re-read from snapshot() by the pass
+    wake();
+}
+
+void SystemObserver::wake()
+{
+    TaskHandle_t handle = task_.load(std::memory_order_acquire);
+    if (handle != nullptr) {
+        xTaskNotifyGive(handle);
+    }
+}
+
+void SystemObserver::task(void* arg)
+{
+    auto* self = static_cast<SystemObserver*>(arg);
+    while (true) {
+        self->poll();
+        ulTaskNotifyTake(pdTRUE, pdMS_TO_TICKS(kIdleMs));
+    }
+}
+
 void SystemObserver::poll()
 {
     pollWifi();
     pollPump(plant_, "plant", plantLastRunning_);
     pollPump(reservoir_, "reservoir", reservoirLastRunning_);
+    for (std::size_t i = 0; i < zoneCount_; ++i) {
+        pollPump(zones_[i].pump, zones_[i].name, zones_[i].lastRunning);
+    }
+    if (usage_ != nullptr) {
+        usage_->poll();
+    }
+    reportLinkBusy();
 
     // Give the pure logger's dropped-event counter a target-side voice: it can
     // only count a failed store, so surface any increase here (mirrors the
@@ -75,11 +135,11 @@ void SystemObserver::pollWifi()
         haveWifiState_ = true;
     }
 
-    // pollWifi() runs at 10 Hz. Attempt the once-only SNTP + API-server starts
+    // pollWifi() runs on every pass. Attempt the once-only SNTP + API-server starts
     // ONLY on the edge INTO Connected (an IP is required — before the link is up
     // they are pointless). Gating on the edge keeps a FAILED start to a single
     // attempt per Connected transition — it retries on the NEXT Connected edge
-    // (after a reconnect), never 10x/s. Each latch (sntpStarted_/
+    // (after a reconnect), never on every pass. Each latch (sntpStarted_/
     // apiServerStarted_) makes a success permanent. Both start() calls are
     // idempotent and non-fatal (a failure never affects boot/watering,
     // FR-014/FR-015); the pointers are nullptr in provisioning/headless mode, so
@@ -91,9 +151,36 @@ void SystemObserver::pollWifi()
     if (sntp_ != nullptr && !sntpStarted_ && sntp_->start()) {
         sntpStarted_ = true;
     }
+    // The frontend manifest is read from the volume at start; a connect
+    // that beats the deferred mount waits for it (bounded).
+    if (apiServer_ != nullptr && !apiServerStarted_) {
+        storage_wait_ready("API server", kStorageWaitMs);
+    }
     if (apiServer_ != nullptr && !apiServerStarted_ && apiServer_->start()) {
         apiServerStarted_ = true;
+        if (boot_mark(BootPhase::ApiUp)) {
+            ESP_LOGI(TAG, "API up %lu ms after reset",
+                     static_cast<unsigned long>(
+                         boot_profile().atUs(BootPhase::ApiUp) / 1000));
+        }
+    }
+}
+
+void SystemObserver::reportLinkBusy()
+{
+    if (wifi_ == nullptr) {
+        return;
+    }
+    // Latency matters while water moves or a dashboard streams: WifiManager
+    // then keeps the radio out of power save (WifiPowerSavePolicy).
+    bool busy = plantLastRunning_ || reservoirLastRunning_;
+    for (std::size_t i = 0; i < zoneCount_ && !busy; ++i) {
+        busy = zones_[i].lastRunning;
+    }
+    if (!busy && apiServerStarted_) {
+        busy = apiServer_->liveStream().clientCount() > 0;
     }
+    wifi_->setBusy(busy);
 }
 
 void SystemObserver::pollPump(IWaterPump* pump, const char* name,
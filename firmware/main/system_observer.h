@@ -5,10 +5,18 @@
  * @brief Edge-detecting bridge from live system state to the EventLogger
  *        (feature 008 US2).
  *
- * Target-side glue (NOT a pure component): it observes the WifiManager
- * snapshot and each pump's running state once per main-loop iteration and
- * emits a typed EventLogger event on every transition — WiFi state change,
- * pump off→on (logPumpStart) and pump on→off (logPumpStop). It holds only
+ * Target-side glue (NOT a pure component): it runs its own task, woken by
+ * the WifiManager (IWifiStateObserver) and the pump drivers (IPumpObserver)
+ * the moment their state changes, and emits a typed EventLogger event on
+ * every transition — WiFi state change, pump off→on (logPumpStart) and pump
+ * on→off (logPumpStop). The callbacks only wake the task (a task
+ * notification, no queue to overflow): it then re-reads the snapshot and the
+ * running flags and edge-detects against what it last saw, so a burst of
+ * changes is one pass and nothing is lost. Without a wake it still passes
+ * once every kIdleMs for what has no notification (stream clients, the
+ * event-drop counter, the wall clock PumpUsage waits for). It also reports
+ * the link as busy (a pump runs, a stream client is connected) to the
+ * WifiManager, which then holds Wi-Fi power save off. It holds only
  * borrowed references/pointers (no ownership) and NEVER blocks or crashes
  * watering: the underlying EventLogger drops (counts) a failed store rather
  * than throwing, and poll() never touches pump control.
@@ -24,8 +32,19 @@
 #ifndef WATERINGSYSTEM_MAIN_SYSTEM_OBSERVER_H
 #define WATERINGSYSTEM_MAIN_SYSTEM_OBSERVER_H
 
+#include <array>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+
 #include "api/ApiServer.h"
+#include "control/PumpUsage.h"
+#include "control/WateringZones.h"
 #include "events/EventLogger.h"
+#include "interfaces/IPumpObserver.h"
 #include "interfaces/IWaterPump.h"
 #include "network/WifiManager.h"
 #include "network/WifiState.h"
@@ -35,11 +54,12 @@
  * @brief Detects WiFi/pump state transitions and forwards them to EventLogger.
  *
  * Construct once at the wiring site after the logger, WifiManager and pumps
- * exist, then call poll() once per 10 Hz main-loop iteration. Unsynchronized
- * by design: poll() runs from the single main loop; WifiManager exposes an
- * immutable snapshot() and the pump handles are the LockedWaterPump wrappers.
+ * exist, call start(), then install it as the observer of each pump driver
+ * (WaterPump::setObserver()). Unsynchronized by design: poll() runs on the
+ * observer task only; WifiManager exposes an immutable snapshot() and the
+ * pump handles are the LockedWaterPump wrappers.
  */
-class SystemObserver {
+class SystemObserver final : public IPumpObserver, public IWifiStateObserver {
 public:
     /**
      * @brief Inject the logger, the (nullable) WifiManager, the SNTP client and
@@ -70,6 +90,45 @@ public:
     {
     }
 
+    /**
+     * @brief Also observe zone pump @p pump (zones after the first, board.h
+     *        kBoardZones), logged under @p name (a string literal). Boot
+     *        wiring only; false once kMaxZonePumps are in.
+     */
+    bool addZonePump(IWaterPump& pump, const char* name)
+    {
+        if (zoneCount_ == zones_.size()) {
+            return false;
+        }
+        zones_[zoneCount_++] = ZonePump{&pump, name, false};
+        return true;
+    }
+
+    /// Also poll @p usage (its per-pump run buckets) every poll(). Boot
+    /// wiring only; @p usage must outlive this observer.
+    void setPumpUsage(PumpUsage& usage) { usage_ = &usage; }
+
+    /// Zone pumps beyond the plant pump.
+    static constexpr std::size_t kMaxZonePumps = WateringZones::kMaxZones - 1;
+
+    /// Longest wait for a wake before a pass anyway.
+    static constexpr uint32_t kIdleMs = 1000;
+
+    /**
+     * @brief Start the observer task (task_plan::kObserver) and subscribe to
+     * the WifiManager's state changes. Boot wiring, once, after the pumps
+     * and zone pumps are added; the first pass logs the current WiFi state.
+     * A task creation failure is logged and nothing is observed.
+     */
+    bool start();
+
+    /// IPumpObserver: a pump switched; wake the task (any task, never blocks).
+    void onRunningChanged(bool running) override;
+
+    /// IWifiStateObserver: the WiFi state changed; wake the task.
+    void onStateChanged(WifiState state) override;
+
+private:
     /**
      * @brief Sample WiFi + pump state once and emit an event per transition.
      *
@@ -79,9 +138,15 @@ public:
      */
     void poll();
 
-private:
+    /// Wake the observer task for a pass now.
+    void wake();
+
+    [[noreturn]] static void task(void* arg);
+
     void pollWifi();
     void pollPump(IWaterPump* pump, const char* name, bool& lastRunning);
+    /// Tell the WifiManager whether a pump runs or a stream client listens.
+    void reportLinkBusy();
 
     EventLogger& logger_;
     WifiManager* wifi_;
@@ -89,6 +154,8 @@ private:
     api::ApiServer* apiServer_;
     IWaterPump* plant_;
     IWaterPump* reservoir_;
+    PumpUsage* usage_ = nullptr;
+    std::atomic<TaskHandle_t> task_{nullptr};
 
     // Last-seen WiFi state; haveWifiState_ stays false until the first poll so
     // the initial state is logged exactly once.
@@ -116,6 +183,14 @@ private:
     // the correct initial edge baseline — no spurious start on the first poll.
     bool plantLastRunning_ = false;
     bool reservoirLastRunning_ = false;
+
+    struct ZonePump {
+        IWaterPump* pump = nullptr;
+        const char* name = nullptr;
+        bool lastRunning = false;
+    };
+    std::array<ZonePump, kMaxZonePumps> zones_{};
+    std::size_t zoneCount_ = 0;
 };
 
 #endif /* WATERINGSYSTEM_MAIN_SYSTEM_OBSERVER_H */
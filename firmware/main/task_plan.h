@@ -0,0 +1,177 @@
+// SPDX-FileCopyrightText: 2026 Cryptotomte
+// SPDX-License-Identifier: AGPL-3.0-or-later
+/**
+ * @file task_plan.h
+ * @brief Core, priority and stack of every firmware task, in one table
+ *        (app wiring).
+ *
+ * Two cores, two roles. The CONTROL core (CONFIG_WS_CONTROL_CORE, APP_CPU by
+ * default) runs the 10 Hz main loop, the watering decision task, the bus
+ * masters and the sensor tasks: everything whose timing moves a pump or a
+ * sample. The NETWORK core (CONFIG_WS_NETWORK_CORE, PRO_CPU) runs what
+ * answers the network — the Wi-Fi and lwIP tasks (pinned by
+ * sdkconfig.defaults), httpd, the stream publisher — plus the console and
+ * the background writers. A burst of HTTP requests then competes with
+ * nothing that times a pump.
+ *
+ * Priorities on the control core, highest first (IDLE is 0):
+ *  - 8 overcurrent: stops the pump whose fault it reports; nothing may
+ *    delay it.
+ *  - 7 main loop: pump self-stop, the 300 s cap and the level debounce run
+ *    on its 100 ms cadence.
+ *  - 6 modbus_task, i2c_task, power_capture: the bus masters sit above
+ *    every client so a queued transfer starts at once (they block on the
+ *    driver, not the CPU); a late capture read is a lost sample.
+ *  - 5 watering_task: ticks on each sample, above the acquisition tasks
+ *    that feed it.
+ *  - 4 soil_task, sensor_task, power_task: periodic acquisition.
+ * On the network core httpd keeps its IDF default of 5, below Wi-Fi (23)
+ * and lwIP (18); the one-shot boot task is 4 (its i2c_probe helper runs at
+ * 4 on the control core, its storage_mount helper at 4 beside it); wifi_task's reconnect logic and the system
+ * observer (woken by each WiFi/pump transition) are 3; the stream
+ * publisher, the MQTT uplink, the self-test and event-wait workers and the
+ * console are 2 (esp-mqtt's own socket task is IDF's, 5 by default); the storage writer,
+ * the telemetry sampler, the log sink, the history maintenance task and the
+ * input recorder's flash writer run at idle + 1.
+ *
+ * With CONFIG_WS_PIN_TASKS off (or a single-core build) every task floats
+ * (tskNO_AFFINITY) at the same priorities.
+ *
+ * Every task created here is static: task_plan_create<Plan>() reserves the
+ * stack and TCB of each plan in .bss, so a task never fails to start on a
+ * fragmented heap and what the tasks cost is fixed at link time. The boot
+ * task logs the total (task_plan::reserved()). httpd and the console REPL
+ * are created by IDF from the heap; their plans carry no stack.
+ */
+
+#ifndef WATERINGSYSTEM_MAIN_TASK_PLAN_H
+#define WATERINGSYSTEM_MAIN_TASK_PLAN_H
+
+#include <atomic>
+#include <cstdint>
+
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+#include "sdkconfig.h"
+
+/// Where and how one task runs.
+struct TaskPlan {
+    const char* name;
+    uint32_t stackBytes;
+    UBaseType_t priority;
+    BaseType_t core;  ///< tskNO_AFFINITY = either core
+};
+
+namespace task_plan {
+
+#if defined(CONFIG_WS_PIN_TASKS)
+constexpr BaseType_t kControlCore = CONFIG_WS_CONTROL_CORE;
+constexpr BaseType_t kNetworkCore = CONFIG_WS_NETWORK_CORE;
+#else
+constexpr BaseType_t kControlCore = tskNO_AFFINITY;
+constexpr BaseType_t kNetworkCore = tskNO_AFFINITY;
+#endif
+
+// -- Control core ----------------------------------------------------------
+constexpr TaskPlan kOvercurrent{"overcurrent", 3072, 8, kControlCore};
+/// The app_main task itself: its core is CONFIG_ESP_MAIN_TASK_AFFINITY (set
+/// to the control core by sdkconfig.defaults); app_main raises the priority.
+constexpr TaskPlan kMainLoop{"main", CONFIG_ESP_MAIN_TASK_STACK_SIZE, 7, kControlCore};
+constexpr TaskPlan kModbus{"modbus_task", 4096, 6, kControlCore};     ///< esp-modbus master path
+constexpr TaskPlan kI2c{"i2c_task", 3072, 6, kControlCore};           ///< i2c_master transactions
+constexpr TaskPlan kPowerCapture{"power_capture", 3072, 6, kControlCore};
+constexpr TaskPlan kWatering{"watering_task", 8192, 5, kControlCore}; ///< littlefs data-log on the tick
+constexpr TaskPlan kSoil{"soil_task", 4096, 4, kControlCore};         ///< blocking Modbus reads only
+constexpr TaskPlan kSensor{"sensor_task", 4096, 4, kControlCore};     ///< parity stack size (R7)
+constexpr TaskPlan kPower{"power_task", 3072, 4, kControlCore};
+/// One-shot BME280/INA226 probe at boot, beside the boot task.
+constexpr TaskPlan kI2cProbe{"i2c_probe", 3072, 4, kControlCore};
+
+// -- Network core ----------------------------------------------------------
+/// httpd is started by ApiServer (setHttpdPlacement()); its stack is IDF's.
+constexpr TaskPlan kHttpd{"httpd", 0, 5, kNetworkCore};
+/// Writes OTA chunks while httpd receives the next: httpd's priority, so
+/// neither starves the other at line rate.
+constexpr TaskPlan kOta{"ota_task", 4096, 5, kNetworkCore};           ///< esp_ota_write + SHA-256
+/// Reads the next chunk of a large body while httpd sends the last: the
+/// same pairing as kOta, the other way round.
+constexpr TaskPlan kReadAhead{"read_ahead", 3072, 5, kNetworkCore};   ///< fread into the pipe
+/// One-shot: the deferred boot (app_main's boot_services()), the init the
+/// main task did on its own stack before.
+constexpr TaskPlan kBoot{"boot", 4096, 4, kNetworkCore};
+/// One-shot: the littlefs mount and the event-count rebuild, beside the
+/// boot task (CONFIG_WS_STORAGE_ASYNC_MOUNT).
+constexpr TaskPlan kStorageMount{"storage_mount", 4096, 4, kNetworkCore};
+constexpr TaskPlan kWifi{"wifi_task", 4096, 3, kNetworkCore};
+/// SystemObserver: event log writes, and the first ApiServer::start() (TLS
+/// set-up) on the Connected edge.
+constexpr TaskPlan kObserver{"observer", 6144, 3, kNetworkCore};
+constexpr TaskPlan kStream{"stream_task", 4096, 2, kNetworkCore};     ///< DTO reads + cJSON printing
+constexpr TaskPlan kMqtt{"mqtt_task", 6144, 2, kNetworkCore};         ///< DTO reads, cJSON, history pages
+constexpr TaskPlan kEspNow{"espnow_task", 4096, 3, kNetworkCore};     ///< DTO reads, frame packing; Ack timing
+constexpr TaskPlan kSelfTest{"selftest_task", 4096, 2, kNetworkCore}; ///< sensor reads + cJSON printing
+/// Answers the held /api/v1/events?wait= reads (main/event_wait_task.h).
+constexpr TaskPlan kEventWait{"event_wait", 4096, 2, kNetworkCore};  ///< event-log reads + cJSON printing
+/// Runs the self-test checks beside the worker (api/SelfTestRunner.h).
+constexpr TaskPlan kSelfTestHelper{"selftest_help", 3072, 2, kNetworkCore}; ///< one bounded sensor read
+/// The esp_console REPL (diag_console_start()); its stack is IDF's.
+constexpr TaskPlan kConsole{"console_repl", 0, 2, kNetworkCore};
+constexpr TaskPlan kStorageWriter{"storage_writer", 6144, 1, kNetworkCore}; ///< littlefs append + fsync
+constexpr TaskPlan kTelemetry{"telemetry", 3072, 1, kNetworkCore};    ///< sample copy + ESP_LOG
+constexpr TaskPlan kLogSink{"log_sink", 3072, 1, kNetworkCore};       ///< vprintf to the console UART
+constexpr TaskPlan kCounters{"counters", 3072, 1, kNetworkCore};      ///< RTC seal + NVS blob write
+/// History upkeep (CONFIG_WS_HISTORY_BACKGROUND_MAINTENANCE): one step,
+/// then a pause; it never waits for the storage lock.
+constexpr TaskPlan kMaintenance{"maintenance", 4096, 1, kNetworkCore}; ///< chunk decode/encode + fsync
+constexpr TaskPlan kClockHoldover{"clock_holdover", 3072, 1, kNetworkCore}; ///< RTC seal, DS3231 + NVS after a sync
+/// Copies sealed input-recording blocks to flash (CONFIG_WS_INPUT_RECORDER).
+constexpr TaskPlan kRecorder{"recorder", 4096, 1, kNetworkCore};       ///< littlefs slot write + fsync
+
+}  // namespace task_plan
+
+namespace task_plan {
+
+/// What task_plan_create() has reserved so far. Atomic: app_main, the boot
+/// task and its helper create tasks concurrently.
+struct Reservation {
+    std::atomic<uint32_t> tasks{0};
+    std::atomic<uint32_t> bytes{0};  ///< stacks + TCBs
+};
+
+inline Reservation& reserved()
+{
+    static Reservation total;
+    return total;
+}
+
+}  // namespace task_plan
+
+/**
+ * @brief xTaskCreateStaticPinnedToCore() with @p Plan's name, stack,
+ *        priority and core, over a stack and TCB reserved for @p Plan.
+ *
+ * One instance per plan: create each plan's task once.
+ * @return pdPASS, or the creation error (the caller logs it)
+ */
+template <const TaskPlan& Plan>
+BaseType_t task_plan_create(TaskFunction_t fn, void* arg, TaskHandle_t* handle = nullptr)
+{
+    static_assert(Plan.stackBytes > 0, "an IDF-created task has no static stack");
+    // StackType_t is a byte on ESP-IDF: the depth is in bytes.
+    static StackType_t stack[Plan.stackBytes / sizeof(StackType_t)];
+    static StaticTask_t tcb;
+
+    TaskHandle_t created = xTaskCreateStaticPinnedToCore(
+        fn, Plan.name, Plan.stackBytes, arg, Plan.priority, stack, &tcb, Plan.core);
+    if (created == nullptr) {
+        return errCOULD_NOT_ALLOCATE_REQUIRED_MEMORY;
+    }
+    task_plan::reserved().tasks += 1;
+    task_plan::reserved().bytes += sizeof(stack) + sizeof(tcb);
+    if (handle != nullptr) {
+        *handle = created;
+    }
+    return pdPASS;
+}
+
+#endif /* WATERINGSYSTEM_MAIN_TASK_PLAN_H */
@@ -8,13 +8,35 @@
 
 #include "task_watchdog.h"
 
+#include <atomic>
+#include <cstdint>
+
 #include "esp_log.h"
 #include "esp_task_wdt.h"
+#include "esp_timer.h"
 #include "freertos/FreeRTOS.h"  // portNUM_PROCESSORS
+#include "freertos/task.h"
 #include "sdkconfig.h"
 
 static const char *TAG = "task_wdt";
 
+namespace {
+
+constexpr uint32_t kTimeoutMs = static_cast<uint32_t>(CONFIG_WS_TASK_WDT_TIMEOUT_S) * 1000u;
+
+// Function-local static: built on the first subscription, long after the
+// boot pump fail-safe.
+WatchdogFeeds &feeds()
+{
+    static WatchdogFeeds instance(kTimeoutMs / 100u * CONFIG_WS_TASK_WDT_WARN_PERCENT *
+                                  1000u);
+    return instance;
+}
+
+std::atomic<EventLogger *> s_events{nullptr};
+
+}  // namespace
+
 esp_err_t watchdog_init()
 {
     // The watchdog is ALREADY initialised at boot (CONFIG_ESP_TASK_WDT_INIT=y,
@@ -53,10 +75,38 @@ void watchdog_subscribe_current_task()
     if (err != ESP_OK) {
         // Non-fatal: an unsubscribed task is simply not watched by the WDT.
         ESP_LOGW(TAG, "task WDT subscribe failed: %s", esp_err_to_name(err));
+        return;
+    }
+    if (!feeds().subscribe(xTaskGetCurrentTaskHandle(), pcTaskGetName(nullptr),
+                           esp_timer_get_time())) {
+        ESP_LOGW(TAG, "%s: feed intervals not tracked (table full)", pcTaskGetName(nullptr));
     }
 }
 
 void watchdog_feed()
 {
     esp_task_wdt_reset();
+    uint32_t intervalUs = 0;
+    if (!feeds().feed(xTaskGetCurrentTaskHandle(), esp_timer_get_time(), intervalUs)) {
+        return;
+    }
+    // Once per histogram bucket past the warning fraction, so rare.
+    const char *name = pcTaskGetName(nullptr);
+    ESP_LOGW(TAG, "%s: %lu ms between watchdog feeds (timeout %lu ms)", name,
+             static_cast<unsigned long>(intervalUs / 1000u),
+             static_cast<unsigned long>(kTimeoutMs));
+    EventLogger *events = s_events.load(std::memory_order_acquire);
+    if (events != nullptr) {
+        events->logWatchdogWarning(name, intervalUs / 1000u, kTimeoutMs);
+    }
+}
+
+const WatchdogFeeds &watchdog_feeds()
+{
+    return feeds();
+}
+
+void watchdog_set_event_logger(EventLogger &events)
+{
+    s_events.store(&events, std::memory_order_release);
 }
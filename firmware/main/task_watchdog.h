@@ -18,12 +18,20 @@
  * design). On a non-serviced subscribed task the WDT panics → reboot; at the
  * next boot pumps_force_off() runs first (unchanged) and the reset reason is
  * logged as TASK_WDT.
+ *
+ * Feed intervals (interfaces/WatchdogFeeds.h): every feed of a subscribed
+ * task is timed. /api/v1/metrics exports each task's interval histogram and
+ * maximum, and an interval past CONFIG_WS_TASK_WDT_WARN_PERCENT of the
+ * timeout logs a warning and a `wdt-warn` reset-category event — a slow
+ * Modbus timeout or a flash stall shows up before it becomes a reset.
  */
 
 #ifndef WATERINGSYSTEM_MAIN_TASK_WATCHDOG_H
 #define WATERINGSYSTEM_MAIN_TASK_WATCHDOG_H
 
 #include "esp_err.h"
+#include "events/EventLogger.h"
+#include "interfaces/WatchdogFeeds.h"
 
 /**
  * @brief Ensure the task WDT runs with CONFIG_WS_TASK_WDT_TIMEOUT_S and
@@ -53,4 +61,13 @@ void watchdog_subscribe_current_task();
  */
 void watchdog_feed();
 
+/// The feed intervals of the subscribed tasks, for the readers.
+const WatchdogFeeds& watchdog_feeds();
+
+/**
+ * @brief Record near-miss warnings in @p events from now on (before, they
+ * are only logged). @p events must outlive every subscribed task.
+ */
+void watchdog_set_event_logger(EventLogger& events);
+
 #endif /* WATERINGSYSTEM_MAIN_TASK_WATCHDOG_H */
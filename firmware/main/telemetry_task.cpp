@@ -0,0 +1,103 @@
+// SPDX-FileCopyrightText: 2026 Cryptotomte
+// SPDX-License-Identifier: AGPL-3.0-or-later
+/**
+ * @file telemetry_task.cpp
+ * @brief Samples the FreeRTOS task list and the heaps (see telemetry_task.h).
+ *
+ * uxTaskGetSystemState() briefly suspends the scheduler while it walks the
+ * task lists, which is why this runs every few seconds at the lowest app
+ * priority and not on the 10 Hz loop. The run-time counters come from
+ * esp_timer (microseconds); the total is the time one core has run, so a
+ * task's share is of one core. The sample buffers are static: the sampler
+ * never allocates.
+ */
+
+#include "telemetry_task.h"
+
+#include <array>
+
+#include "esp_heap_caps.h"
+#include "esp_log.h"
+#include "esp_timer.h"
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+
+#include "task_plan.h"
+
+static const char *TAG = "telemetry";
+
+namespace {
+
+constexpr uint32_t kPeriodMs = CONFIG_WS_TASK_TELEMETRY_PERIOD_S * 1000u;
+
+/// uxTaskGetSystemState() fills nothing when the buffer is short, so it
+/// has room past what the snapshot keeps.
+constexpr UBaseType_t kStatusSlots = TelemetrySnapshot::kMaxTasks + 8;
+
+TaskStatus_t s_status[kStatusSlots];
+TaskCounters s_counters[kStatusSlots];
+
+HeapCapsStats heapStats(uint32_t caps)
+{
+    HeapCapsStats stats;
+    stats.totalBytes = heap_caps_get_total_size(caps);
+    stats.freeBytes = heap_caps_get_free_size(caps);
+    stats.minFreeBytes = heap_caps_get_minimum_free_size(caps);
+    stats.largestBlockBytes = heap_caps_get_largest_free_block(caps);
+    return stats;
+}
+
+void sample(TaskTelemetry& telemetry)
+{
+    configRUN_TIME_COUNTER_TYPE total = 0;
+    const UBaseType_t count = uxTaskGetSystemState(s_status, kStatusSlots, &total);
+    if (count == 0) {
+        ESP_LOGW(TAG, "more than %u tasks: sample skipped",
+                 static_cast<unsigned>(kStatusSlots));
+        return;
+    }
+    for (UBaseType_t i = 0; i < count; ++i) {
+        const TaskStatus_t &status = s_status[i];
+        TaskCounters &c = s_counters[i];
+        c.id = status.xTaskNumber;
+        c.name = status.pcTaskName;
+        c.runTime = static_cast<uint32_t>(status.ulRunTimeCounter);
+        // StackType_t is a byte on ESP-IDF: the mark is in bytes.
+        c.stackFreeBytes = status.usStackHighWaterMark;
+        c.priority = static_cast<uint8_t>(status.uxCurrentPriority);
+#if CONFIG_FREERTOS_VTASKLIST_INCLUDE_COREID
+        c.core = status.xCoreID == tskNO_AFFINITY ? -1 : static_cast<int8_t>(status.xCoreID);
+#endif
+    }
+    const std::array<HeapCapsStats, kHeapCapsCount> heaps = {
+        heapStats(MALLOC_CAP_INTERNAL),
+        heapStats(MALLOC_CAP_DMA),
+        heapStats(MALLOC_CAP_SPIRAM),
+    };
+    telemetry.update(s_counters, count, static_cast<uint32_t>(total), heaps,
+                     esp_timer_get_time() / 1000);
+}
+
+[[noreturn]] void telemetry_task(void *arg)
+{
+    TaskTelemetry &telemetry = *static_cast<TaskTelemetry *>(arg);
+    TickType_t lastWake = xTaskGetTickCount();
+    while (true) {
+        sample(telemetry);
+        vTaskDelayUntil(&lastWake, pdMS_TO_TICKS(kPeriodMs));
+    }
+}
+
+}  // namespace
+
+void telemetry_task_start(TaskTelemetry& telemetry)
+{
+    const BaseType_t created =
+        task_plan_create<task_plan::kTelemetry>(telemetry_task, &telemetry);
+    if (created != pdPASS) {
+        ESP_LOGE(TAG, "failed to create telemetry task");
+        return;
+    }
+    ESP_LOGI(TAG, "telemetry task started (%lu ms period)",
+             static_cast<unsigned long>(kPeriodMs));
+}
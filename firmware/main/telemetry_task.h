@@ -0,0 +1,31 @@
+// SPDX-FileCopyrightText: 2026 Cryptotomte
+// SPDX-License-Identifier: AGPL-3.0-or-later
+/**
+ * @file telemetry_task.h
+ * @brief Low-priority sampler of per-task CPU, stack and heap telemetry
+ *        (app wiring).
+ *
+ * App-level FreeRTOS task, not a component: every
+ * CONFIG_WS_TASK_TELEMETRY_PERIOD_S it reads uxTaskGetSystemState() (run-time
+ * counter, stack high-water mark, priority and core of every task) and the
+ * heap of each capability, and publishes them through the pure
+ * TaskTelemetry (interfaces/TaskTelemetry.h) that the `top` console command
+ * and /api/v1/metrics read.
+ */
+
+#ifndef WATERINGSYSTEM_MAIN_TELEMETRY_TASK_H
+#define WATERINGSYSTEM_MAIN_TELEMETRY_TASK_H
+
+#include "interfaces/TaskTelemetry.h"
+
+/**
+ * @brief Start the telemetry sampler.
+ *
+ * @p telemetry must outlive the task (a function-local static from
+ * app_main). Not watchdog-subscribed: telemetry is never safety-relevant.
+ * A creation failure is logged and swallowed — the readers then report no
+ * sample yet.
+ */
+void telemetry_task_start(TaskTelemetry& telemetry);
+
+#endif /* WATERINGSYSTEM_MAIN_TELEMETRY_TASK_H */
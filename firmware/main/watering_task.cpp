@@ -2,29 +2,56 @@
 // SPDX-License-Identifier: AGPL-3.0-or-later
 /**
  * @file watering_task.cpp
- * @brief Decision-layer watering task at the sensor-read cadence (feature 011).
+ * @brief Decision-layer watering task, ticked by soil samples (feature 011).
  *
  * This task runs the DECISION layer, separate from the 10 Hz main loop that
  * still owns precise pump-timing enforcement (pump update() self-stop + 300 s
- * cap, level update(), observer.poll()). Each cycle it calls
- * WateringController::tick() and, on boards with a reservoir pump,
- * ReservoirController::tick(...).
+ * cap, level update(), observer.poll()). Each cycle it ticks every watering
+ * zone (WateringZones::tick(), one WateringController per board.h zone) and,
+ * on boards with a reservoir pump, ReservoirController::tick(...).
  *
- * Controller-as-reader: WateringController::tick() performs the periodic soil
- * read() (the blocking Modbus round-trip) which refreshes the LockedSoilSensor
- * cache that the PR-09 /sensors endpoint serves — so NO separate soil-reader
- * task is needed. That blocking read (plus the periodic littlefs data-log) is
- * isolated on THIS task and never runs on the 10 Hz safety loop.
+ * Event-driven on soil data: the soil task (soil_task.cpp) does the blocking
+ * Modbus read and the SoilAcquirer publishes the sample (each zone's probe
+ * has one, watering_task_add_feed()), which notifies THIS task; the tick then runs at once on the new snapshot (never a bus read of
+ * its own). If no sample arrives for a sensor-read interval plus
+ * kSampleGraceMs (above the 3 s parity Modbus timeout) it ticks without one:
+ * the pump enforcement and the fail-safe keep running, and a stalled bus
+ * fails safe as "soil-stale" once the last sample is too old. The periodic
+ * data-log only queues its writes to the storage writer task
+ * (storage_writer_task.cpp) when that is enabled.
  *
  * Watchdog: this is a watering-critical task, so it subscribes to the task WDT.
  * The sensor-read cadence (IConfigStore::getSensorReadIntervalMs()) is
  * operator-writable with NO upper bound, so it can legally exceed the task WDT
- * timeout. A single vTaskDelay of the whole period would then starve the
- * watchdog between feeds and panic-reboot; because the interval is NVS-persisted
- * that would boot-loop. So the sleep is chunked: the task sleeps in bounded
- * kFeedChunkMs slices, feeding the WDT after each slice, and runs the controller
- * tick exactly once per full period. The blocking Modbus read inside tick() is
- * itself well under the WDT timeout.
+ * timeout, and an NVS-persisted interval that starved the watchdog would
+ * boot-loop. So the wait is chunked: at most kFeedChunkMs per wait, feeding
+ * the WDT after each.
+ *
+ * Config changes: the task subscribes to LockedConfigStore writes; a write
+ * wakes the current wait early and the fallback deadline is re-read. The
+ * controllers keep their own copy of the items they use (refreshed on
+ * IConfigStore::generation()).
+ *
+ * Event-driven mode (CONFIG_WS_EVENT_DRIVEN_WATERING): besides a sample, a
+ * config write and watering_task_notify() (the 10 Hz loop on a pump stop
+ * or a level edge) tick at once, and the wait ends at the controller's own
+ * next deadline (the earliest zone's WateringController::nextDeadlineMs():
+ * staleness, data log, watering window edge) when that comes before the
+ * fallback. At the end of a zone's soak pause, and when the watering
+ * window opens, it asks the soil task for a fresh read
+ * (soil_task_request_read()), so a dry soil starts the next burst then. The WDT feed is the only other wake-up,
+ * every quarter of the WDT timeout.
+ *
+ * Input recording (CONFIG_WS_INPUT_RECORDER): each tick opens with the
+ * wall clock, the decision config and the level marks handed to the
+ * recorder, the zones' samples follow through their RecordedSoilFeed, and
+ * the pump states close it (watering_task_set_recorder()).
+ *
+ * Tick timing: each tick is timed by phase (watering_task_latency(), the
+ * controllers mark the soil read, the data log and the event writes); a
+ * tick over CONFIG_WS_WATERING_TICK_BUDGET_MS is logged and stored as a
+ * `tick-slow` event, once per histogram bucket it reaches. The recorder's
+ * calls are outside the timed span.
  *
  * Isolation: the task shares nothing with the network/HTTP path beyond the same
  * Locked* wrappers every other task uses (FR-017).
@@ -33,69 +60,194 @@
 #include "watering_task.h"
 
 #include "esp_log.h"
+#include "esp_timer.h"
 #include "freertos/FreeRTOS.h"
 #include "freertos/task.h"
 
+#include "soil_task.h"
+#include "task_plan.h"
 #include "task_watchdog.h"
 
 static const char *TAG = "watering_task";
 
 namespace {
 
-constexpr uint32_t kStackBytes = 8192;  ///< blocking Modbus read + littlefs log
-constexpr UBaseType_t kPriority = 1;    ///< same class as sensor_task
 constexpr uint32_t kFloorMs = 1000;     ///< IConfigStore sensor-interval floor
-constexpr uint32_t kFeedChunkMs = 1000; ///< max sleep between WDT feeds
+constexpr uint32_t kSampleGraceMs = 5000; ///< late-sample allowance
+
+/// Notification bits.
+constexpr uint32_t kSoilSampleBit = 1u << 0;
+constexpr uint32_t kConfigBit = 1u << 1;
+constexpr uint32_t kEventBit = 1u << 2;  ///< watering_task_notify()
+
+#if defined(CONFIG_WS_EVENT_DRIVEN_WATERING)
+/// Max wait between WDT feeds: a quarter of the timeout, at least 1 s.
+constexpr uint32_t kFeedChunkMs =
+    CONFIG_WS_TASK_WDT_TIMEOUT_S * 250u > 1000u ? CONFIG_WS_TASK_WDT_TIMEOUT_S * 250u
+                                                 : 1000u;
+/// Notifications that tick at once.
+constexpr uint32_t kTickBits = kSoilSampleBit | kConfigBit | kEventBit;
+#else
+constexpr uint32_t kFeedChunkMs = 1000; ///< max wait between WDT feeds
+constexpr uint32_t kTickBits = kSoilSampleBit;
+#endif
 
 /// Long-lived task context (the task never exits). A single static instance
 /// holds borrowed pointers to the app_main collaborators.
 struct WateringTaskCtx {
-    WateringController* controller;
+    WateringZones* zones;
     IConfigStore* config;
+    EventLogger* events;
 #if BOARD_HAS_RESERVOIR_PUMP
-    ReservoirController* reservoir;
+    BoardReservoirController* reservoir;
 #endif
 };
 
 WateringTaskCtx ctx;
+TaskHandle_t s_task = nullptr;
+WateringRecorderInputs s_recorder;  ///< recorder null: not recording
+
+/// The configured cadence, floored.
+uint32_t readPeriodMs(const IConfigStore& config)
+{
+    const uint32_t periodMs = config.getSensorReadIntervalMs();
+    return periodMs < kFloorMs ? kFloorMs : periodMs;
+}
+
+int64_t nowMs()
+{
+    return esp_timer_get_time() / 1000;
+}
+
+int64_t nowUs()
+{
+    return esp_timer_get_time();
+}
+
+void notify(uint32_t bit)
+{
+    if (s_task != nullptr) {
+        xTaskNotify(s_task, bit, eSetBits);
+    }
+}
+
+/// When the next tick is due without a notification, for a tick at
+/// @p lastTickMs: the fallback, or the zones' earliest deadline before it.
+int64_t nextTickDueMs(const WateringTaskCtx& c, int64_t lastTickMs)
+{
+    const int64_t fallbackMs =
+        lastTickMs + static_cast<int64_t>(readPeriodMs(*c.config)) + kSampleGraceMs;
+#if defined(CONFIG_WS_EVENT_DRIVEN_WATERING)
+    const int64_t deadlineMs = c.zones->nextDeadlineMs(lastTickMs);
+    return deadlineMs < fallbackMs ? deadlineMs : fallbackMs;
+#else
+    return fallbackMs;
+#endif
+}
+
+/// Hand the recorder what this tick at @p atMs decides on.
+void record_inputs(IConfigStore& config, int64_t atMs)
+{
+    const WallTime wall = s_recorder.wallClock->now();
+    RecordedLevels levels;
+    const bool haveLevels = s_recorder.levelLow != nullptr && s_recorder.levelHigh != nullptr;
+    if (haveLevels) {
+        levels.lowValid = s_recorder.levelLow->isValid();
+        levels.lowWet = levels.lowValid && s_recorder.levelLow->isWaterPresent();
+        levels.highValid = s_recorder.levelHigh->isValid();
+        levels.highWet = levels.highValid && s_recorder.levelHigh->isWaterPresent();
+    }
+    s_recorder.recorder->beginTick(atMs, wall.set ? wall.epoch : 0,
+                                   RecordedConfig::from(config),
+                                   haveLevels ? &levels : nullptr);
+}
+
+/// Hand the recorder the pump states this tick left.
+void record_pumps()
+{
+    for (std::size_t id = 0; id < s_recorder.pumps.size(); ++id) {
+        if (s_recorder.pumps[id] != nullptr) {
+            s_recorder.recorder->pump(static_cast<uint8_t>(id),
+                                      s_recorder.pumps[id]->isRunning());
+        }
+    }
+}
+
+/// Close the timed tick; report it when it first reaches a slower bucket
+/// past the budget.
+void end_timed_tick(EventLogger& events)
+{
+    uint32_t tickUs = 0;
+    TickPhase slowest = TickPhase::Decision;
+    if (!watering_task_latency().end(tickUs, slowest)) {
+        return;
+    }
+    ESP_LOGW(TAG, "tick took %lu ms, budget %lu ms (mostly %s)",
+             static_cast<unsigned long>(tickUs / 1000u),
+             static_cast<unsigned long>(CONFIG_WS_WATERING_TICK_BUDGET_MS),
+             tickPhaseName(slowest));
+    events.logTickOverBudget(tickPhaseName(slowest), tickUs / 1000u,
+                             CONFIG_WS_WATERING_TICK_BUDGET_MS);
+}
+
+/// Wakes the task on each soil sample and each config write.
+void subscribe(SoilAcquirer& soilFeed, LockedConfigStore& config)
+{
+    watering_task_add_feed(soilFeed);
+    if (!config.subscribe([] { notify(kConfigBit); })) {
+        ESP_LOGW(TAG, "config listener slots full; interval changes apply "
+                      "after the current period");
+    }
+}
 
 [[noreturn]] void watering_task(void* arg)
 {
     WateringTaskCtx* c = static_cast<WateringTaskCtx*>(arg);
 
     // Watering-critical task: subscribe to the task WDT (feature 008 US3). The
-    // liveness proof is the per-chunk feed below, NOT one feed per cycle: the
-    // period can exceed the WDT timeout, so the feed must be decoupled from the
-    // tick cadence.
+    // liveness proof is the per-wait feed below, NOT one feed per tick: the
+    // fallback deadline can exceed the WDT timeout.
     watchdog_subscribe_current_task();
 
+    int64_t lastTickMs = nowMs();
+    int64_t dueMs = nextTickDueMs(*c, lastTickMs);
+    int64_t readAtMs = 0;  // soak end / window opening to ask a fresh read at
     while (true) {
-        // Re-read the cadence each loop so a config change takes effect without
-        // a restart. vTaskDelay (not vTaskDelayUntil) because the period is
-        // dynamic.
-        uint32_t periodMs = c->config->getSensorReadIntervalMs();
-        if (periodMs < kFloorMs) {
-            periodMs = kFloorMs;
+        int64_t wakeMs = dueMs;
+        if (readAtMs != 0 && readAtMs < wakeMs) {
+            wakeMs = readAtMs;
         }
-
-        // Chunked feed-and-sleep: never sleep the whole (unbounded) period in
-        // one vTaskDelay. Sleep in bounded kFeedChunkMs slices, feeding the WDT
-        // after each, so a large configured period cannot starve the watchdog
-        // and boot-loop the device.
-        uint32_t slept = 0;
-        while (slept < periodMs) {
-            const uint32_t chunk =
-                (periodMs - slept < kFeedChunkMs) ? (periodMs - slept)
-                                                  : kFeedChunkMs;
-            vTaskDelay(pdMS_TO_TICKS(chunk));
-            watchdog_feed();
-            slept += chunk;
+        const int64_t now = nowMs();
+        uint32_t bits = 0;
+        if (now < wakeMs) {
+            const int64_t left = wakeMs - now;
+            const uint32_t wait =
+                left < kFeedChunkMs ? static_cast<uint32_t>(left) : kFeedChunkMs;
+            xTaskNotifyWait(0, UINT32_MAX, &bits, pdMS_TO_TICKS(wait));
+        }
+        watchdog_feed();
+        const int64_t wokeMs = nowMs();
+        if (readAtMs != 0 && wokeMs >= readAtMs) {
+            readAtMs = 0;
+            soil_task_request_read();
+        }
+        if ((bits & kConfigBit) != 0) {
+            // The interval may have moved the fallback.
+            dueMs = nextTickDueMs(*c, lastTickMs);
+        }
+        if ((bits & kTickBits) == 0 && wokeMs < dueMs) {
+            continue;
+        }
+        lastTickMs = wokeMs;
+        if (s_recorder.recorder != nullptr) {
+            record_inputs(*c->config, lastTickMs);
         }
 
-        // Decision layer, once per full period. tick() does the periodic soil
-        // read (refreshing the LockedSoilSensor cache) + the watering decision +
+        // Decision layer, per zone: the newest soil sample (or the stale
+        // check without one) + the watering decision; zone 0 also writes
         // the periodic data-log.
-        c->controller->tick();
+        watering_task_latency().begin();
+        c->zones->tick();
 #if BOARD_HAS_RESERVOIR_PUMP
         // Reservoir flag mapping: `enabled` is always true — on rev1 the
         // reservoir pump always exists and the feature is on, and we never
@@ -105,23 +257,60 @@ WateringTaskCtx ctx;
         // manual API fills still work. There is deliberately NO dedicated
         // auto-level config flag.
         c->reservoir->tick(true, c->config->getWateringEnabled());
+#endif
+        end_timed_tick(*c->events);
+        if (s_recorder.recorder != nullptr) {
+            record_pumps();
+        }
+        dueMs = nextTickDueMs(*c, lastTickMs);
+#if defined(CONFIG_WS_EVENT_DRIVEN_WATERING)
+        readAtMs = c->zones->soakEndsAtMs(lastTickMs);
+        const int64_t opensAtMs = c->zones->windowOpensAtMs(lastTickMs);
+        if (opensAtMs != 0 && (readAtMs == 0 || opensAtMs < readAtMs)) {
+            readAtMs = opensAtMs;
+        }
 #endif
     }
 }
 
 }  // namespace
 
+TickLatency& watering_task_latency(void)
+{
+    static TickLatency latency;
+    return latency;
+}
+
+void watering_task_notify(void)
+{
+    notify(kEventBit);
+}
+
+void watering_task_set_recorder(const WateringRecorderInputs& inputs)
+{
+    s_recorder = inputs;
+}
+
+void watering_task_add_feed(SoilAcquirer& feed)
+{
+    feed.setListener([] { notify(kSoilSampleBit); });
+}
+
 #if BOARD_HAS_RESERVOIR_PUMP
-void watering_task_start(WateringController& controller, ReservoirController& reservoir,
-                         IConfigStore& config, EventLogger& events)
+void watering_task_start(WateringZones& zones, BoardReservoirController& reservoir,
+                         SoilAcquirer& soilFeed, LockedConfigStore& config,
+                         EventLogger& events)
 {
-    ctx.controller = &controller;
+    ctx.zones = &zones;
     ctx.config = &config;
+    ctx.events = &events;
     ctx.reservoir = &reservoir;
 
+    watering_task_latency().install(
+        nowUs, static_cast<uint32_t>(CONFIG_WS_WATERING_TICK_BUDGET_MS) * 1000u);
+
     const BaseType_t created =
-        xTaskCreate(watering_task, "watering_task", kStackBytes, &ctx,
-                    kPriority, nullptr);
+        task_plan_create<task_plan::kWatering>(watering_task, &ctx, &s_task);
     if (created != pdPASS) {
         // Not a safety function: log and continue. The 10 Hz loop still
         // enforces pump timing; only the decision layer is absent. Record a
@@ -131,19 +320,23 @@ void watering_task_start(WateringController& controller, ReservoirController& re
         events.logFailsafe("watering-task-start-failed");
         return;
     }
+    subscribe(soilFeed, config);
     ESP_LOGI(TAG, "watering task started (%lu ms cadence floor)",
              static_cast<unsigned long>(kFloorMs));
 }
 #else
-void watering_task_start(WateringController& controller, IConfigStore& config,
-                         EventLogger& events)
+void watering_task_start(WateringZones& zones, SoilAcquirer& soilFeed,
+                         LockedConfigStore& config, EventLogger& events)
 {
-    ctx.controller = &controller;
+    ctx.zones = &zones;
     ctx.config = &config;
+    ctx.events = &events;
+
+    watering_task_latency().install(
+        nowUs, static_cast<uint32_t>(CONFIG_WS_WATERING_TICK_BUDGET_MS) * 1000u);
 
     const BaseType_t created =
-        xTaskCreate(watering_task, "watering_task", kStackBytes, &ctx,
-                    kPriority, nullptr);
+        task_plan_create<task_plan::kWatering>(watering_task, &ctx, &s_task);
     if (created != pdPASS) {
         // Not a safety function: log and continue. The 10 Hz loop still
         // enforces pump timing; only the decision layer is absent. Record a
@@ -153,6 +346,7 @@ void watering_task_start(WateringController& controller, IConfigStore& config,
         events.logFailsafe("watering-task-start-failed");
         return;
     }
+    subscribe(soilFeed, config);
     ESP_LOGI(TAG, "watering task started (%lu ms cadence floor)",
              static_cast<unsigned long>(kFloorMs));
 }
@@ -5,49 +5,120 @@
  * @brief Decision-layer watering task (app wiring, feature 011).
  *
  * App-level FreeRTOS task, not a component: it runs the pure WateringController
- * (and, on boards with a reservoir pump, the ReservoirController) at the sensor-
- * read cadence. The controller acts as the periodic soil reader — its tick()
- * performs the blocking Modbus read that refreshes the LockedSoilSensor cache
- * (the same cache the /sensors endpoint serves), so no separate soil-reader task
- * is needed. The 10 Hz main loop still owns precise pump-timing enforcement.
+ * of every watering zone (WateringZones, board.h kBoardZones) and, on boards
+ * with a reservoir pump, the ReservoirController on every soil sample the
+ * soil task (soil_task.h) publishes. The reads happen there; the
+ * controller takes the newest timestamped snapshot without blocking, so the
+ * decision follows fresh data within milliseconds and a slow bus delays only
+ * the data. The 10 Hz main loop still owns precise pump-timing enforcement.
  * Task/behaviour contract: specs/011-watering-controller-host-tests/.
  */
 
 #ifndef WATERINGSYSTEM_MAIN_WATERING_TASK_H
 #define WATERINGSYSTEM_MAIN_WATERING_TASK_H
 
+#include <array>
+
 #include "board/board.h"
-#include "control/WateringController.h"
+#include "control/InputRecorder.h"
+#include "control/WateringZones.h"
 #include "events/EventLogger.h"
 #include "interfaces/IConfigStore.h"
+#include "interfaces/ILevelSensor.h"
+#include "interfaces/IWallClock.h"
+#include "interfaces/IWaterPump.h"
+#include "interfaces/TickLatency.h"
+#include "sensors/SoilAcquirer.h"
+#include "storage/LockedConfigStore.h"
 #if BOARD_HAS_RESERVOIR_PUMP
+#include "actuators/LockedWaterPump.h"
 #include "control/ReservoirController.h"
+#include "sensors/LevelSensorBank.h"
+
+/// The reservoir controller app_main wires: over the final level-bank marks
+/// and LockedWaterPump with CONFIG_WS_STATIC_DISPATCH (direct, inlinable
+/// calls), else over the interfaces.
+#if defined(CONFIG_WS_STATIC_DISPATCH)
+using BoardReservoirController =
+    BasicReservoirController<LevelSensorBank::Mark, LockedWaterPump>;
+#else
+using BoardReservoirController = ReservoirController;
+#endif
 #endif
 
 /**
  * @brief Start the decision-layer watering task.
  *
  * Pass the Locked*-backed controllers built in app_main; they must outlive the
- * task (i.e. forever — function-local statics). The task subscribes to the task
- * WDT and ticks every IConfigStore::getSensorReadIntervalMs() (re-read each
- * loop so config changes take effect), floored at 1000 ms. A task-creation
+ * task (i.e. forever — function-local statics). Zone 0's controller must
+ * have @p soilFeed set as its soil feed; register the other zones' feeds
+ * with watering_task_add_feed(). The task subscribes to the task WDT and
+ * ticks on every published sample; without one for the sensor-read interval
+ * (IConfigStore::getSensorReadIntervalMs(), floored at 1000 ms) plus a grace
+ * it ticks anyway, so pump enforcement and the stale fail-safe keep running.
+ * It subscribes to @p config, so a changed interval applies at once. A task-creation
  * failure is logged AND recorded as a durable failsafe event (so the absent
  * decision layer is operator-visible via /api/v1/events across a reboot); the
  * failure is otherwise swallowed — like the sensor task, the decision layer is
  * started best-effort and the 10 Hz safety loop is unaffected.
  *
- * @param controller Automatic + manual plant watering logic (soil reader).
+ * @param zones      One automatic + manual watering controller per zone.
  * @param reservoir  Reservoir auto-fill state machine (rev1 only).
- * @param config     Runtime-tunable cadence and mode flag, re-read each tick.
+ * @param soilFeed   Primary soil samples; its listener is set to wake this
+ *                   task. Start the soil task after this call.
+ * @param config     Runtime-tunable cadence and mode flag (subscribed to).
  * @param events     Persistent event log; a task-creation failure is recorded
  *                   here as a durable, operator-visible failsafe event.
  */
 #if BOARD_HAS_RESERVOIR_PUMP
-void watering_task_start(WateringController& controller, ReservoirController& reservoir,
-                         IConfigStore& config, EventLogger& events);
-#else
-void watering_task_start(WateringController& controller, IConfigStore& config,
+void watering_task_start(WateringZones& zones, BoardReservoirController& reservoir,
+                         SoilAcquirer& soilFeed, LockedConfigStore& config,
                          EventLogger& events);
+#else
+void watering_task_start(WateringZones& zones, SoilAcquirer& soilFeed,
+                         LockedConfigStore& config, EventLogger& events);
 #endif
 
+/**
+ * @brief Tick the watering task on each sample @p feed publishes (a zone
+ *        probe's acquirer; the primary's is set by watering_task_start()).
+ *        Boot wiring, before the soil task starts.
+ */
+void watering_task_add_feed(SoilAcquirer& feed);
+
+/// What the input recorder is given each tick besides the zones' samples
+/// (CONFIG_WS_INPUT_RECORDER).
+struct WateringRecorderInputs {
+    InputRecorder* recorder = nullptr;
+    const IWallClock* wallClock = nullptr;
+    /// Zone i's pump at i, the reservoir pump at input_record::kReservoirPump.
+    std::array<const IWaterPump*, input_record::kPumps> pumps{};
+    ILevelSensor* levelLow = nullptr;   ///< null without a reservoir
+    ILevelSensor* levelHigh = nullptr;
+};
+
+/**
+ * @brief Record each tick's inputs and pump states into @p inputs.recorder
+ *        (control/InputRecorder.h). Boot wiring, before
+ *        watering_task_start(); the zones' soil feeds must already be
+ *        wrapped in RecordedSoilFeed. @p inputs is copied.
+ */
+void watering_task_set_recorder(const WateringRecorderInputs& inputs);
+
+/**
+ * @brief The watering task's tick timing (interfaces/TickLatency.h): hand
+ *        it to every zone controller and the reservoir controller
+ *        (setTickLatency()) at boot wiring, and to the API server. Timed
+ *        from watering_task_start() on.
+ */
+TickLatency& watering_task_latency(void);
+
+/**
+ * @brief Wake the watering task for a tick now: a pump started or stopped,
+ *        or a level mark changed. Acted on with
+ *        CONFIG_WS_EVENT_DRIVEN_WATERING, ignored otherwise. Any task; a
+ *        no-op before watering_task_start().
+ */
+void watering_task_notify(void);
+
 #endif /* WATERINGSYSTEM_MAIN_WATERING_TASK_H */
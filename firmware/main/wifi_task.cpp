@@ -4,7 +4,7 @@
  * @file wifi_task.cpp
  * @brief WiFi station tick task + status LED (feature 007 US2, T019/T021).
  *
- * Mirrors sensor_task.cpp: its own 4096 B stack at priority 1, a [[noreturn]]
+ * Mirrors sensor_task.cpp: its own 4096 B stack (task_plan.h), a [[noreturn]]
  * fixed-cadence loop, the manager injected via the void* task arg, and a
  * non-fatal creation failure. This is a SEPARATE task from the 10 Hz
  * pump/level loop and holds no watering mutex (FR-014); all it does is advance
@@ -25,6 +25,7 @@
 #include "freertos/task.h"
 
 #include "network/WifiState.h"
+#include "task_plan.h"
 
 static const char *TAG = "wifi_task";
 
@@ -32,8 +33,6 @@ namespace {
 
 constexpr uint32_t kTickPeriodMs = 250;       ///< manager tick cadence
 constexpr uint32_t kBlinkHalfPeriodMs = 500;  ///< LED toggle half-period
-constexpr uint32_t kStackBytes = 4096;        ///< match sensor_task (R7)
-constexpr UBaseType_t kPriority = 1;          ///< match sensor_task (R7)
 
 /// Configure the status LED as a driven, initially-off output. Non-fatal: a
 /// failure only costs the visual indicator, never the tick loop.
@@ -105,13 +104,23 @@ void status_led_init()
     }
 }
 
+[[noreturn]] void wifi_scan_task(void *arg)
+{
+    WifiScanCache &cache = *static_cast<WifiScanCache *>(arg);
+    TickType_t last_wake = xTaskGetTickCount();
+    while (true) {
+        vTaskDelayUntil(&last_wake, pdMS_TO_TICKS(kTickPeriodMs));
+        // Non-blocking: starts a scan or collects a finished one.
+        cache.tick();
+    }
+}
+
 }  // namespace
 
 void wifi_task_start(WifiManager &manager)
 {
     const BaseType_t created =
-        xTaskCreate(wifi_task, "wifi_task", kStackBytes, &manager, kPriority,
-                    nullptr);
+        task_plan_create<task_plan::kWifi>(wifi_task, &manager);
     if (created != pdPASS) {
         // Not a safety function: log and continue without the WiFi tick loop
         // (the watering path is unaffected — FR-014).
@@ -121,3 +130,14 @@ void wifi_task_start(WifiManager &manager)
     ESP_LOGI(TAG, "wifi task started (%lu ms tick cadence)",
              static_cast<unsigned long>(kTickPeriodMs));
 }
+
+void wifi_scan_task_start(WifiScanCache &cache)
+{
+    const BaseType_t created =
+        task_plan_create<task_plan::kWifi>(wifi_scan_task, &cache);
+    if (created != pdPASS) {
+        ESP_LOGE(TAG, "failed to create wifi scan task");
+        return;
+    }
+    ESP_LOGI(TAG, "wifi scan task started");
+}
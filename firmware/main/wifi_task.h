@@ -16,6 +16,7 @@
 #define WATERINGSYSTEM_MAIN_WIFI_TASK_H
 
 #include "network/WifiManager.h"
+#include "network/WifiScanCache.h"
 
 /**
  * @brief Start the WiFi station tick task (station mode only).
@@ -36,4 +37,17 @@
  */
 void wifi_task_start(WifiManager& manager);
 
+/**
+ * @brief Start the setup portal's scan task (provisioning mode only).
+ *
+ * Ticks @p cache every ~250 ms, which starts the background scans and
+ * collects their results (network/WifiScanCache.h). Runs under the wifi
+ * task's plan — provisioning starts no wifi_task, so the two never run
+ * together. A creation failure is logged; the portal then lists nothing
+ * and the SSID is typed in.
+ *
+ * @param cache Ticked forever; must outlive the task (an app_main static).
+ */
+void wifi_scan_task_start(WifiScanCache& cache);
+
 #endif /* WATERINGSYSTEM_MAIN_WIFI_TASK_H */
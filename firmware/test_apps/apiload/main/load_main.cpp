@@ -0,0 +1,818 @@
+// SPDX-FileCopyrightText: 2026 Cryptotomte
+// SPDX-License-Identifier: AGPL-3.0-or-later
+/**
+ * @file load_main.cpp
+ * @brief Dashboard load generator for the API's pure layer (linux preview
+ *        target).
+ *
+ * Replays a weighted mix of the requests an open dashboard makes — /status
+ * and /sensors polls, /history windows, /events pages — the way the
+ * handlers serve them: the URI through matchRoute(), the query through
+ * findQueryValue() and the request parsers, the hot bodies through a
+ * ResponseCache, the rest through the serializers or, for history, the
+ * streaming writer into a sink that drops the chunks. ApiServer itself is
+ * target-only (esp_http_server), so each route here composes the same pure
+ * calls its builder makes, in the same order; the data comes from
+ * LittleFsDataStorage over a tmpfs directory holding LOAD_DAYS of readings.
+ *
+ * Three passes:
+ *   - mix: LOAD_REQUESTS requests on a simulated clock (LOAD_RATE per
+ *     second), reporting requests/s of host time and, per route, the peak
+ *     heap one request holds (operator new and cJSON's allocator, live
+ *     bytes above the level before it) and the cache hit rate;
+ *   - arena: the same mix with the cache off and the real arena hooks, one
+ *     RequestArena of LOAD_ARENA_BYTES per route, reporting its high water
+ *     and fallbacks — the figure to size RequestArena::kDefaultBytes by;
+ *   - windows: one raw series per named range, streamed and, for contrast,
+ *     collected then serialized, reporting both peaks — the streamed one
+ *     should not grow with the window.
+ *
+ * With LOAD_OUT set the per-route figures of the mix and the streamed
+ * window peaks are also written there as a result file for
+ * tools/perf_gate.py. Numbers are host numbers: compare runs on one
+ * machine, never against the ESP32. The exit code is 0 unless a tunable is
+ * malformed, the storage cannot be created or LOAD_OUT cannot be written.
+ */
+
+#include <malloc.h>
+#include <unistd.h>
+
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <dirent.h>
+#include <new>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "api/ApiDtos.h"
+#include "api/ApiRequests.h"
+#include "api/ApiRoutes.h"
+#include "api/ApiSerialize.h"
+#include "api/ApiStream.h"
+#include "api/RequestArena.h"
+#include "api/ResponseCache.h"
+#include "cJSON.h"
+#include "interfaces/EventCodec.h"
+#include "storage/LittleFsDataStorage.h"
+
+// -- Heap tracking ------------------------------------------------------------
+// Live bytes (malloc_usable_size, so frees can be subtracted) and their peak,
+// over operator new and cJSON's allocator. One thread allocates; the atomics
+// only keep other threads of the linux target from tearing the counts.
+
+namespace {
+
+std::atomic<uint64_t> g_allocs{0};
+std::atomic<int64_t> g_live{0};
+std::atomic<int64_t> g_peak{0};
+
+void* trackedMalloc(std::size_t size)
+{
+    void* p = std::malloc(size);
+    if (p != nullptr) {
+        g_allocs.fetch_add(1, std::memory_order_relaxed);
+        const int64_t live =
+            g_live.fetch_add(static_cast<int64_t>(malloc_usable_size(p)),
+                             std::memory_order_relaxed) +
+            static_cast<int64_t>(malloc_usable_size(p));
+        if (live > g_peak.load(std::memory_order_relaxed)) {
+            g_peak.store(live, std::memory_order_relaxed);
+        }
+    }
+    return p;
+}
+
+void trackedFree(void* p)
+{
+    if (p != nullptr) {
+        g_live.fetch_sub(static_cast<int64_t>(malloc_usable_size(p)),
+                         std::memory_order_relaxed);
+        std::free(p);
+    }
+}
+
+void* cjsonMalloc(size_t size) { return trackedMalloc(size); }
+void cjsonFree(void* p) { trackedFree(p); }
+
+}  // namespace
+
+void* operator new(std::size_t size)
+{
+    void* p = trackedMalloc(size == 0 ? 1 : size);
+    if (p == nullptr) {
+        throw std::bad_alloc();
+    }
+    return p;
+}
+
+void* operator new[](std::size_t size) { return operator new(size); }
+void operator delete(void* p) noexcept { trackedFree(p); }
+void operator delete[](void* p) noexcept { trackedFree(p); }
+void operator delete(void* p, std::size_t) noexcept { trackedFree(p); }
+void operator delete[](void* p, std::size_t) noexcept { trackedFree(p); }
+
+namespace {
+
+constexpr uint32_t kStartEpoch = 1'777'593'600;  ///< 2026-05-01T00:00:00Z
+
+/// The heap one scope holds at most, above the live bytes when it opened.
+class HeapProbe {
+public:
+    HeapProbe()
+        : base_(g_live.load(std::memory_order_relaxed)),
+          allocs0_(g_allocs.load(std::memory_order_relaxed))
+    {
+        g_peak.store(base_, std::memory_order_relaxed);
+    }
+
+    std::size_t peakBytes() const
+    {
+        const int64_t peak = g_peak.load(std::memory_order_relaxed) - base_;
+        return peak > 0 ? static_cast<std::size_t>(peak) : 0;
+    }
+    uint64_t allocs() const { return g_allocs.load(std::memory_order_relaxed) - allocs0_; }
+
+private:
+    int64_t base_;
+    uint64_t allocs0_;
+};
+
+/// @p name from the environment as a number, else @p fallback.
+double envNumber(const char* name, double fallback, bool& ok)
+{
+    const char* text = std::getenv(name);
+    if (text == nullptr || *text == '\0') {
+        return fallback;
+    }
+    char* end = nullptr;
+    const double value = std::strtod(text, &end);
+    if (*end != '\0' || value <= 0) {
+        std::fprintf(stderr, "%s=\"%s\": not a positive number\n", name, text);
+        ok = false;
+        return fallback;
+    }
+    return value;
+}
+
+const char* envString(const char* name, const char* fallback)
+{
+    const char* text = std::getenv(name);
+    return text != nullptr && *text != '\0' ? text : fallback;
+}
+
+/// A fresh directory on tmpfs (LOAD_DIR), removed at scope exit.
+class TempDir {
+public:
+    explicit TempDir(const char* parent)
+    {
+        std::string templ = std::string(parent) + "/ws_load_XXXXXX";
+        if (::mkdtemp(&templ[0]) != nullptr) {
+            path_ = templ;
+        }
+    }
+    ~TempDir()
+    {
+        if (!path_.empty()) {
+            removeTree(path_);
+        }
+    }
+    TempDir(const TempDir&) = delete;
+    TempDir& operator=(const TempDir&) = delete;
+
+    const std::string& path() const { return path_; }
+
+private:
+    static void removeTree(const std::string& path)
+    {
+        if (DIR* dir = ::opendir(path.c_str())) {
+            while (const dirent* entry = ::readdir(dir)) {
+                if (std::strcmp(entry->d_name, ".") == 0 ||
+                    std::strcmp(entry->d_name, "..") == 0) {
+                    continue;
+                }
+                removeTree(path + "/" + entry->d_name);
+            }
+            ::closedir(dir);
+        }
+        std::remove(path.c_str());  // file, or directory now empty
+    }
+
+    std::string path_;
+};
+
+// -- Mix ----------------------------------------------------------------------
+
+/// The routes the mix draws from, in report order.
+enum Route : std::size_t { kStatus, kSensors, kHistory, kEvents, kRoutes };
+
+constexpr const char* kRouteNames[kRoutes] = {"status", "sensors", "history", "events"};
+
+/// The metrics the history requests and the stored data cycle through.
+constexpr const char* kMetrics[] = {"soil_moisture", "env_temperature", "env_humidity"};
+
+/// Parse LOAD_MIX ("status:40,sensors:40,history:15,events:5") into weights.
+bool parseMix(std::string_view text, std::array<uint32_t, kRoutes>& weights)
+{
+    weights = {};
+    while (!text.empty()) {
+        const std::size_t comma = text.find(',');
+        const std::string_view item = text.substr(0, comma);
+        text = comma == std::string_view::npos ? std::string_view() : text.substr(comma + 1);
+        const std::size_t colon = item.find(':');
+        if (colon == std::string_view::npos) {
+            return false;
+        }
+        const std::string_view name = item.substr(0, colon);
+        const std::string weight(item.substr(colon + 1));
+        char* end = nullptr;
+        const unsigned long w = std::strtoul(weight.c_str(), &end, 10);
+        if (weight.empty() || *end != '\0') {
+            return false;
+        }
+        std::size_t r = 0;
+        while (r < kRoutes && name != kRouteNames[r]) {
+            ++r;
+        }
+        if (r == kRoutes) {
+            return false;
+        }
+        weights[r] = static_cast<uint32_t>(w);
+    }
+    uint32_t total = 0;
+    for (uint32_t w : weights) {
+        total += w;
+    }
+    return total > 0;
+}
+
+/// Deterministic route picker: the same mix draws the same sequence.
+class MixPicker {
+public:
+    explicit MixPicker(const std::array<uint32_t, kRoutes>& weights) : weights_(weights)
+    {
+        for (uint32_t w : weights_) {
+            total_ += w;
+        }
+    }
+
+    Route next()
+    {
+        state_ ^= state_ << 13;
+        state_ ^= state_ >> 17;
+        state_ ^= state_ << 5;
+        uint32_t pick = state_ % total_;
+        std::size_t r = 0;
+        while (pick >= weights_[r]) {
+            pick -= weights_[r];
+            ++r;
+        }
+        return static_cast<Route>(r);
+    }
+
+private:
+    std::array<uint32_t, kRoutes> weights_;
+    uint32_t total_ = 0;
+    uint32_t state_ = 2463534242u;
+};
+
+/// Stands in for httpd_resp_send_chunk: counts and drops the body.
+struct DropSink : api::IChunkSink {
+    std::size_t bytes = 0;
+    bool send(const char*, std::size_t len) override
+    {
+        bytes += len;
+        return true;
+    }
+};
+
+/// What the handlers build /status and /sensors from, as fixed DTOs.
+api::SystemStatusDto sampleStatus(const IDataStorage& storage, uint32_t now, int64_t uptimeMs)
+{
+    api::SystemStatusDto s;
+    s.mode = "automatic";
+    s.wifi.state = "connected";
+    s.wifi.rssi = -61;
+    s.wifi.ssid = "greenhouse";
+    s.wifi.connected = true;
+    s.wifi.ipAcquired = true;
+    s.wifi.ip = "192.168.1.42";
+    s.wifi.powerSave = "min_modem";
+    s.time.synced = true;
+    s.time.epoch = now;
+    s.time.local = "2026-05-31 14:00:00";
+    s.time.lastSync = now - 600;
+    s.uptimeMs = static_cast<uint64_t>(uptimeMs);
+    s.resetReason = "power_on";
+    s.firmware.version = "1.4.0";
+    s.firmware.project = "watering_system";
+    const StorageStats stats = storage.getStorageStats();
+    s.storage.totalBytes = stats.totalBytes;
+    s.storage.usedBytes = stats.usedBytes;
+    s.storage.writes.bytesAppended = stats.writes.bytesAppended;
+    s.storage.writes.syncs = stats.writes.syncs;
+    return s;
+}
+
+api::SensorReadingsDto sampleSensors(uint32_t now)
+{
+    api::SensorReadingsDto s;
+    s.environmental.valid = true;
+    s.environmental.temperature = 21.4f;
+    s.environmental.humidity = 55.2f;
+    s.environmental.pressure = 1012.8f;
+    s.soil.valid = true;
+    s.soil.moisture = 41.7f;
+    s.soil.temperature = 17.9f;
+    s.soil.humidity = 41.7f;
+    s.soil.ph = 6.4f;
+    s.soil.ec = 812.0f;
+    s.hasTimestamp = true;
+    s.timestamp = now;
+    return s;
+}
+
+/// One route's figures over a pass.
+struct RouteStats {
+    uint64_t count = 0;
+    double ns = 0.0;
+    uint64_t allocs = 0;
+    std::size_t peakSum = 0;
+    std::size_t peakMax = 0;
+    std::size_t bodyBytes = 0;
+};
+
+/**
+ * @brief The handler side: URI in, body bytes out.
+ *
+ * Each route makes its ApiServer builder's pure calls in the same order;
+ * @p cache null serves every /status and /sensors from a fresh build.
+ */
+class LoadServer {
+public:
+    LoadServer(const IDataStorage& storage, uint32_t logIntervalS, api::ResponseCache* cache)
+        : storage_(storage), logIntervalS_(logIntervalS), cache_(cache)
+    {
+    }
+
+    /// Serve @p uri at wall-clock @p now / monotonic @p nowMs; body bytes,
+    /// or 0 for a request the handler would have refused.
+    std::size_t serve(const char* uri, uint32_t now, int64_t nowMs)
+    {
+        // httpd hands the handler a fixed URI buffer: split it in place.
+        char path[128];
+        std::string_view query;
+        const char* mark = std::strchr(uri, '?');
+        const std::size_t pathLen = mark != nullptr ? static_cast<std::size_t>(mark - uri)
+                                                    : std::strlen(uri);
+        if (pathLen >= sizeof(path)) {
+            return 0;
+        }
+        std::memcpy(path, uri, pathLen);
+        path[pathLen] = '\0';
+        if (mark != nullptr) {
+            query = mark + 1;
+        }
+
+        switch (api::matchRoute(api::HttpMethod::Get, path)) {
+        case api::HandlerId::Status:
+            return cached(api::ResponseCache::Slot::Status, nowMs, [&] {
+                return api::serializeStatus(sampleStatus(storage_, now, nowMs));
+            });
+        case api::HandlerId::Sensors:
+            return cached(api::ResponseCache::Slot::Sensors, nowMs,
+                          [&] { return api::serializeSensors(sampleSensors(now)); });
+        case api::HandlerId::History:
+            return history(query, now);
+        case api::HandlerId::Events:
+            return events(query);
+        default:
+            return 0;
+        }
+    }
+
+private:
+    template <typename Build>
+    std::size_t cached(api::ResponseCache::Slot slot, int64_t nowMs, Build&& build)
+    {
+        std::string body;
+        std::string etag;
+        if (cache_ != nullptr && cache_->get(slot, 0, nowMs, body, etag)) {
+            return body.size();
+        }
+        body = build();
+        if (cache_ != nullptr) {
+            cache_->put(slot, 0, nowMs, body, etag);
+        }
+        return body.size();
+    }
+
+    /// ApiServer::streamHistoryResponse() for one metric, no paging.
+    std::size_t history(std::string_view query, uint32_t now)
+    {
+        std::string_view value;
+        if (!api::findQueryValue(query, "metric", value) || value.empty()) {
+            return 0;
+        }
+        const std::string metricList(value);
+        std::optional<std::string> range;
+        if (api::findQueryValue(query, "range", value)) {
+            range = std::string(value);
+        }
+        const api::WindowResult window =
+            api::resolveWindow(range, std::nullopt, std::nullopt, now);
+        std::vector<std::string> metrics;
+        if (!window.ok || !api::splitHistoryMetrics(metricList, metrics) ||
+            metrics.size() != 1) {
+            return 0;
+        }
+
+        api::HistorySeries series;
+        series.metric = metrics[0];
+        series.start = window.t0;
+        series.end = window.t1;
+        series.bucketS = api::selectHistoryBucket(window.t0, window.t1, logIntervalS_,
+                                                  api::resolveHistoryMaxPoints(std::nullopt));
+        DropSink sink;
+        if (series.bucketS == 0) {
+            api::streamRawHistory(storage_, series, logIntervalS_, 0, sink);
+            return sink.bytes;
+        }
+        const std::vector<SensorAggregate> buckets =
+            storage_.getSensorAggregates(series.metric, window.t0, window.t1, series.bucketS);
+        series.timestamps.reserve(buckets.size());
+        series.values.reserve(buckets.size());
+        series.mins.reserve(buckets.size());
+        series.maxs.reserve(buckets.size());
+        for (const SensorAggregate& b : buckets) {
+            series.timestamps.push_back(static_cast<int64_t>(b.epoch));
+            series.values.push_back(b.sum / static_cast<float>(b.count));
+            series.mins.push_back(b.min);
+            series.maxs.push_back(b.max);
+        }
+        api::streamHistory(series, sink);
+        return sink.bytes;
+    }
+
+    /// eventsHandler() + ApiServer::buildEventsBody().
+    std::size_t events(std::string_view query)
+    {
+        std::string_view value;
+        std::optional<int> requested;
+        if (api::findQueryValue(query, "count", value)) {
+            requested = std::atoi(std::string(value).c_str());
+        }
+        EventQuery filter;
+        filter.limit = api::resolveEventCount(requested);
+        if (api::findQueryValue(query, "category", value) &&
+            !api::parseEventCategories(value, filter.categoryMask)) {
+            return 0;
+        }
+        const EventPage page = storage_.queryEvents(filter);
+        std::vector<api::EventDto> dtos;
+        dtos.reserve(page.events.size());
+        for (const EventRecord& r : page.events) {
+            api::EventDto dto;
+            dto.epoch = static_cast<int64_t>(r.epoch);
+            dto.category = static_cast<int>(r.category);
+            if (const char* name = api::eventCategoryName(dto.category)) {
+                dto.categoryName = name;
+            }
+            dto.detail = renderEventDetail(r.detail);
+            dtos.push_back(std::move(dto));
+        }
+        std::optional<std::string> next;
+        if (page.more) {
+            next = api::formatEventCursor(page.next);
+        }
+        return api::serializeEvents(dtos, next).size();
+    }
+
+    const IDataStorage& storage_;
+    uint32_t logIntervalS_;
+    api::ResponseCache* cache_;
+};
+
+/// The URI a dashboard sends for @p route; history and events vary per call.
+const char* requestUri(Route route, uint64_t n, const std::string& historyRange)
+{
+    static std::string uri;
+    switch (route) {
+    case kStatus:
+        return "/api/v1/status";
+    case kSensors:
+        return "/api/v1/sensors";
+    case kHistory:
+        uri = "/api/v1/history?metric=";
+        uri += kMetrics[n % (sizeof(kMetrics) / sizeof(kMetrics[0]))];
+        uri += "&range=" + historyRange;
+        return uri.c_str();
+    default:
+        return n % 2 == 0 ? "/api/v1/events?count=50"
+                          : "/api/v1/events?count=20&category=pump,failsafe";
+    }
+}
+
+/// Settings shared by the passes.
+struct LoadSettings {
+    uint64_t requests = 0;
+    double ratePerS = 0.0;
+    std::array<uint32_t, kRoutes> weights{};
+    std::string historyRange;
+    uint32_t cacheMaxAgeMs = 0;
+    std::size_t arenaBytes = 0;
+    uint32_t logIntervalS = 0;
+    uint32_t now = 0;  ///< wall clock at the first request (end of the data)
+};
+
+void printRoutes(const std::array<RouteStats, kRoutes>& stats)
+{
+    std::printf("  %-8s %8s %12s %10s %12s %12s %10s\n", "route", "count", "req/s",
+                "allocs/req", "peak B mean", "peak B max", "body B");
+    for (std::size_t r = 0; r < kRoutes; ++r) {
+        const RouteStats& s = stats[r];
+        if (s.count == 0) {
+            continue;
+        }
+        const double n = static_cast<double>(s.count);
+        std::printf("  %-8s %8llu %12.0f %10.1f %12.0f %12zu %10.0f\n", kRouteNames[r],
+                    static_cast<unsigned long long>(s.count), n * 1e9 / s.ns,
+                    static_cast<double>(s.allocs) / n, static_cast<double>(s.peakSum) / n,
+                    s.peakMax, static_cast<double>(s.bodyBytes) / n);
+    }
+}
+
+/// Pass 1: the mix through the cache, heap peaks per route.
+std::array<RouteStats, kRoutes> runMix(const IDataStorage& storage,
+                                       const LoadSettings& settings)
+{
+    api::ResponseCache cache;
+    cache.setMaxAge(api::ResponseCache::Slot::Status, settings.cacheMaxAgeMs);
+    cache.setMaxAge(api::ResponseCache::Slot::Sensors, settings.cacheMaxAgeMs);
+    LoadServer server(storage, settings.logIntervalS, &cache);
+    MixPicker picker(settings.weights);
+    std::array<RouteStats, kRoutes> stats{};
+
+    const double stepMs = 1000.0 / settings.ratePerS;
+    double simMs = 0.0;
+    double totalNs = 0.0;
+    for (uint64_t i = 0; i < settings.requests; ++i) {
+        const Route route = picker.next();
+        const int64_t nowMs = static_cast<int64_t>(simMs);
+        const uint32_t now = settings.now + static_cast<uint32_t>(nowMs / 1000);
+        const char* uri = requestUri(route, stats[route].count, settings.historyRange);
+        // The URI string is the client's, not the request's.
+        const HeapProbe probe;
+        const auto t0 = std::chrono::steady_clock::now();
+        const std::size_t body = server.serve(uri, now, nowMs);
+        const double ns =
+            std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - t0)
+                .count();
+        RouteStats& s = stats[route];
+        ++s.count;
+        s.ns += ns;
+        s.allocs += probe.allocs();
+        s.peakSum += probe.peakBytes();
+        s.peakMax = probe.peakBytes() > s.peakMax ? probe.peakBytes() : s.peakMax;
+        s.bodyBytes += body;
+        totalNs += ns;
+        simMs += stepMs;
+    }
+
+    std::printf("mix: %llu requests at %.2f/s over %.0f simulated s, %.0f req/s host\n",
+                static_cast<unsigned long long>(settings.requests), settings.ratePerS,
+                simMs / 1000.0, static_cast<double>(settings.requests) * 1e9 / totalNs);
+    printRoutes(stats);
+    const uint32_t lookups = cache.hits() + cache.misses();
+    std::printf("  cache (max age %u ms): %u hits / %u lookups (%.1f%%)\n",
+                settings.cacheMaxAgeMs, cache.hits(), lookups,
+                lookups == 0 ? 0.0 : 100.0 * cache.hits() / lookups);
+    return stats;
+}
+
+/// Pass 2: the mix with no cache, each route in its own arena.
+void runArena(const IDataStorage& storage, const LoadSettings& settings)
+{
+    api::installArenaHooks();
+    LoadServer server(storage, settings.logIntervalS, nullptr);
+    MixPicker picker(settings.weights);
+    std::vector<api::RequestArena*> arenas;
+    for (std::size_t r = 0; r < kRoutes; ++r) {
+        arenas.push_back(new api::RequestArena(settings.arenaBytes));
+    }
+    std::array<uint64_t, kRoutes> counts{};
+    const double stepMs = 1000.0 / settings.ratePerS;
+    double simMs = 0.0;
+    for (uint64_t i = 0; i < settings.requests; ++i) {
+        const Route route = picker.next();
+        const int64_t nowMs = static_cast<int64_t>(simMs);
+        const uint32_t now = settings.now + static_cast<uint32_t>(nowMs / 1000);
+        const char* uri = requestUri(route, counts[route]++, settings.historyRange);
+        const api::ArenaScope scope(arenas[route]);
+        server.serve(uri, now, nowMs);
+        simMs += stepMs;
+    }
+
+    std::printf("arena: %zu B per request, cache off\n", settings.arenaBytes);
+    std::printf("  %-8s %12s %12s\n", "route", "high water B", "fallbacks");
+    for (std::size_t r = 0; r < kRoutes; ++r) {
+        if (counts[r] == 0) {
+            continue;
+        }
+        std::printf("  %-8s %12zu %12u\n", kRouteNames[r], arenas[r]->highWater(),
+                    arenas[r]->fallbacks());
+        delete arenas[r];
+    }
+
+    // Back to the counted allocator for the next pass.
+    cJSON_Hooks hooks = {};
+    hooks.malloc_fn = &cjsonMalloc;
+    hooks.free_fn = &cjsonFree;
+    cJSON_InitHooks(&hooks);
+}
+
+constexpr const char* kWindowRanges[] = {"1h", "6h", "24h", "7d", "30d"};
+constexpr std::size_t kWindows = sizeof(kWindowRanges) / sizeof(kWindowRanges[0]);
+
+/// Pass 3: raw windows of growing length, streamed vs collected; the
+/// streamed peaks per range into @p streamedPeaks.
+void runWindows(const IDataStorage& storage, const LoadSettings& settings,
+                std::array<std::size_t, kWindows>& streamedPeaks)
+{
+    std::printf("windows: raw soil_moisture, streamed vs collected+serialized\n");
+    std::printf("  %-6s %8s %12s %14s %14s\n", "range", "points", "body B", "streamed peak B",
+                "collected peak B");
+    for (std::size_t w = 0; w < kWindows; ++w) {
+        const char* range = kWindowRanges[w];
+        uint32_t t0 = 0;
+        uint32_t t1 = 0;
+        api::namedRangeToWindow(range, settings.now, t0, t1);
+        api::HistorySeries echo;
+        echo.metric = kMetrics[0];
+        echo.start = t0;
+        echo.end = t1;
+
+        // Forced raw whatever the point budget: the writer is under test.
+        DropSink sink;
+        std::size_t streamedPeak = 0;
+        {
+            const HeapProbe probe;
+            api::streamRawHistory(storage, echo, settings.logIntervalS, 0, sink);
+            streamedPeak = probe.peakBytes();
+        }
+        std::size_t collectedPeak = 0;
+        std::size_t points = 0;
+        {
+            const HeapProbe probe;
+            api::HistorySeries series = echo;
+            for (const SensorReading& r : storage.getSensorReadings(echo.metric, t0, t1)) {
+                series.timestamps.push_back(static_cast<int64_t>(r.epoch));
+                series.values.push_back(r.value);
+            }
+            points = series.timestamps.size();
+            const std::string body = api::serializeHistory(series);
+            collectedPeak = probe.peakBytes();
+        }
+        std::printf("  %-6s %8zu %12zu %14zu %14zu\n", range, points, sink.bytes,
+                    streamedPeak, collectedPeak);
+        streamedPeaks[w] = streamedPeak;
+    }
+}
+
+/// The mix's routes and the streamed windows in the bench result schema
+/// (LOAD_OUT).
+bool writeJson(const char* path, const std::array<RouteStats, kRoutes>& routes,
+               const std::array<std::size_t, kWindows>& streamedPeaks)
+{
+    FILE* f = std::fopen(path, "w");
+    if (f == nullptr) {
+        std::fprintf(stderr, "LOAD_OUT=\"%s\": cannot write\n", path);
+        return false;
+    }
+    std::fprintf(f, "{\n  \"version\": 1,\n  \"results\": [");
+    const char* separator = "";
+    for (std::size_t r = 0; r < kRoutes; ++r) {
+        const RouteStats& s = routes[r];
+        if (s.count == 0) {
+            continue;
+        }
+        const double n = static_cast<double>(s.count);
+        std::fprintf(f,
+                     "%s\n    {\"name\": \"apiload.%s\", \"iterations\": %llu, "
+                     "\"nsPerOp\": %.2f, \"allocsPerOp\": %.3f, \"peakBytesMean\": %.1f, "
+                     "\"peakBytesMax\": %zu}",
+                     separator, kRouteNames[r], static_cast<unsigned long long>(s.count),
+                     s.ns / n, static_cast<double>(s.allocs) / n,
+                     static_cast<double>(s.peakSum) / n, s.peakMax);
+        separator = ",";
+    }
+    for (std::size_t w = 0; w < kWindows; ++w) {
+        std::fprintf(f, "%s\n    {\"name\": \"apiload.stream_%s\", \"peakBytesMax\": %zu}",
+                     separator, kWindowRanges[w], streamedPeaks[w]);
+        separator = ",";
+    }
+    std::fprintf(f, "\n  ]\n}\n");
+    return std::fclose(f) == 0;
+}
+
+/// LOAD_DAYS of readings for every metric, plus a few events a day.
+bool fill(LittleFsDataStorage& storage, uint32_t days, uint32_t logIntervalS, uint32_t& end)
+{
+    static constexpr const char* kDetails[] = {"pump plant ran 20 s", "tank low",
+                                               "wifi reconnected", "ota idle",
+                                               "reset: power_on"};
+    std::vector<SensorReading> batch;
+    uint32_t epoch = kStartEpoch;
+    end = kStartEpoch + days * 86'400;
+    uint32_t n = 0;
+    for (; epoch < end; epoch += logIntervalS, ++n) {
+        for (const char* metric : kMetrics) {
+            SensorReading r;
+            r.metric = metric;
+            r.epoch = epoch;
+            r.value = 40.0f + static_cast<float>(n % 17) * 0.3f;
+            batch.push_back(r);
+        }
+        if (batch.size() >= 300) {
+            if (storage.storeSensorReadings(batch.data(), batch.size()) != batch.size()) {
+                return false;
+            }
+            batch.clear();
+        }
+        if ((epoch - kStartEpoch) % 10'800 < logIntervalS) {  // one every 3 h
+            const uint8_t category = static_cast<uint8_t>(1 + (n % 5));
+            storage.storeEvent(epoch, category, kDetails[category - 1]);
+        }
+    }
+    return storage.storeSensorReadings(batch.data(), batch.size()) == batch.size() &&
+           storage.flush();
+}
+
+}  // namespace
+
+extern "C" void app_main(void)
+{
+    bool ok = true;
+    LoadSettings settings;
+    settings.requests = static_cast<uint64_t>(envNumber("LOAD_REQUESTS", 20'000, ok));
+    settings.ratePerS = envNumber("LOAD_RATE", 1.2, ok);
+    settings.historyRange = envString("LOAD_HISTORY_RANGE", "24h");
+    settings.cacheMaxAgeMs = static_cast<uint32_t>(envNumber("LOAD_CACHE_MS", 1000, ok));
+    settings.arenaBytes = static_cast<std::size_t>(
+        envNumber("LOAD_ARENA_BYTES", api::RequestArena::kDefaultBytes, ok));
+    settings.logIntervalS = static_cast<uint32_t>(envNumber("LOAD_LOG_INTERVAL_S", 300, ok));
+    const uint32_t days = static_cast<uint32_t>(envNumber("LOAD_DAYS", 30, ok));
+    const char* mix = envString("LOAD_MIX", "status:40,sensors:40,history:15,events:5");
+    if (!parseMix(mix, settings.weights)) {
+        std::fprintf(stderr, "LOAD_MIX=\"%s\": expected route:weight,... over %s, %s, %s, %s\n",
+                     mix, kRouteNames[0], kRouteNames[1], kRouteNames[2], kRouteNames[3]);
+        ok = false;
+    }
+    uint32_t t0 = 0;
+    uint32_t t1 = 0;
+    if (!api::namedRangeToWindow(settings.historyRange, kStartEpoch, t0, t1)) {
+        std::fprintf(stderr, "LOAD_HISTORY_RANGE=\"%s\": not a named range\n",
+                     settings.historyRange.c_str());
+        ok = false;
+    }
+    const char* parent =
+        envString("LOAD_DIR", access("/dev/shm", W_OK) == 0 ? "/dev/shm" : "/tmp");
+    const char* out = envString("LOAD_OUT", nullptr);
+    if (!ok) {
+        std::exit(2);
+    }
+
+    cJSON_Hooks hooks = {};
+    hooks.malloc_fn = &cjsonMalloc;
+    hooks.free_fn = &cjsonFree;
+    cJSON_InitHooks(&hooks);
+
+    std::array<RouteStats, kRoutes> routes{};
+    std::array<std::size_t, kWindows> streamedPeaks{};
+    {
+        TempDir dir(parent);
+        if (dir.path().empty()) {
+            std::fprintf(stderr, "LOAD_DIR=\"%s\": cannot create a directory there\n", parent);
+            std::exit(1);
+        }
+        LittleFsDataStorage storage(dir.path());
+        if (!fill(storage, days, settings.logIntervalS, settings.now)) {
+            std::fprintf(stderr, "cannot fill the storage under %s\n", dir.path().c_str());
+            std::exit(1);
+        }
+        std::printf("data: %u days of %zu metrics at %u s\n", days,
+                    sizeof(kMetrics) / sizeof(kMetrics[0]), settings.logIntervalS);
+        routes = runMix(storage, settings);
+        runArena(storage, settings);
+        runWindows(storage, settings, streamedPeaks);
+    }
+    if (out != nullptr && !writeJson(out, routes, streamedPeaks)) {
+        std::exit(1);
+    }
+    std::exit(0);
+}
@@ -0,0 +1,481 @@
+// SPDX-FileCopyrightText: 2026 Cryptotomte
+// SPDX-License-Identifier: AGPL-3.0-or-later
+/**
+ * @file bench_main.cpp
+ * @brief Micro-benchmarks of the pure components (linux preview target).
+ *
+ * The baseline every performance change is measured against: the API
+ * serializers, request parsers and route table, LittleFsDataStorage append,
+ * query and per-record chunk scan over a tmpfs directory, the chunk
+ * summary's reduction (reference and lane kernel), the level
+ * debouncer's update() and the watering controller's tick() over the
+ * mocks. Each case runs until it has taken BENCH_MIN_MS of host time (after
+ * one warm-up call) and reports ns/op plus heap allocations and bytes per
+ * op; the counters see operator new and cJSON's allocator, so a
+ * serializer's DOM counts as well as its std::string.
+ *
+ * Results go to stdout as a table and to BENCH_OUT as JSON (schema in
+ * CLAUDE.md "Benchmarks"), for tools/bench_compare.py to diff against a
+ * stored baseline. Numbers are host numbers: compare runs on one machine,
+ * never against the ESP32. Tunables come from the environment (app_main
+ * has no argv on the linux target). The exit code is 0 unless a tunable is
+ * malformed or a result cannot be written.
+ */
+
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <new>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include <dirent.h>
+#include <unistd.h>
+
+#include "actuators/testing/FakeTimeProvider.h"
+#include "actuators/testing/MockWaterPump.h"
+#include "api/ApiDtos.h"
+#include "api/ApiRequests.h"
+#include "api/ApiRoutes.h"
+#include "api/ApiSerialize.h"
+#include "cJSON.h"
+#include "control/WateringController.h"
+#include "events/EventLogger.h"
+#include "interfaces/IDigitalInput.h"
+#include "sensors/DebouncedLevelSensor.h"
+#include "sensors/testing/MockEnvironmentalSensor.h"
+#include "sensors/testing/MockSoilSensor.h"
+#include "storage/LittleFsDataStorage.h"
+#include "storage/RecordReduce.h"
+#include "storage/testing/MockConfigStore.h"
+#include "storage/testing/MockDataStorage.h"
+#include "time/testing/FakeWallClock.h"
+
+// -- Allocation counters ------------------------------------------------------
+// Every operator new and every cJSON allocation passes through here. Relaxed
+// atomics: the cases run on one thread, the atomics only keep the other
+// threads of the linux target (if any allocate) from tearing the counts.
+
+namespace {
+
+std::atomic<uint64_t> g_allocs{0};
+std::atomic<uint64_t> g_allocBytes{0};
+
+void* countedMalloc(std::size_t size)
+{
+    g_allocs.fetch_add(1, std::memory_order_relaxed);
+    g_allocBytes.fetch_add(size, std::memory_order_relaxed);
+    return std::malloc(size);
+}
+
+void* cjsonMalloc(size_t size) { return countedMalloc(size); }
+void cjsonFree(void* p) { std::free(p); }
+
+}  // namespace
+
+void* operator new(std::size_t size)
+{
+    void* p = countedMalloc(size == 0 ? 1 : size);
+    if (p == nullptr) {
+        throw std::bad_alloc();
+    }
+    return p;
+}
+
+void* operator new[](std::size_t size) { return operator new(size); }
+void operator delete(void* p) noexcept { std::free(p); }
+void operator delete[](void* p) noexcept { std::free(p); }
+void operator delete(void* p, std::size_t) noexcept { std::free(p); }
+void operator delete[](void* p, std::size_t) noexcept { std::free(p); }
+
+namespace {
+
+constexpr uint32_t kStartEpoch = 1'777'593'600;  ///< 2026-05-01T00:00:00Z
+
+/// One case's outcome.
+struct Result {
+    std::string name;
+    uint64_t iterations = 0;
+    double nsPerOp = 0.0;
+    double allocsPerOp = 0.0;
+    double bytesPerOp = 0.0;
+};
+
+/// @p name from the environment as a number, else @p fallback.
+double envNumber(const char* name, double fallback, bool& ok)
+{
+    const char* text = std::getenv(name);
+    if (text == nullptr || *text == '\0') {
+        return fallback;
+    }
+    char* end = nullptr;
+    const double value = std::strtod(text, &end);
+    if (*end != '\0' || value <= 0) {
+        std::fprintf(stderr, "%s=\"%s\": not a positive number\n", name, text);
+        ok = false;
+        return fallback;
+    }
+    return value;
+}
+
+const char* envString(const char* name, const char* fallback)
+{
+    const char* text = std::getenv(name);
+    return text != nullptr && *text != '\0' ? text : fallback;
+}
+
+/// Keeps a result alive past the optimizer.
+template <typename T>
+void keep(const T& value)
+{
+    asm volatile("" : : "g"(&value) : "memory");
+}
+
+class Runner {
+public:
+    Runner(double minMs, const char* filter) : minNs_(minMs * 1e6), filter_(filter) {}
+
+    /// Time @p op (one call = @p unitsPerOp ops, e.g. the records of one
+    /// scan) unless the filter skips @p name. Batches double until one
+    /// takes minNs_; that batch is the result.
+    template <typename Op>
+    void run(const char* name, Op&& op, uint64_t unitsPerOp = 1)
+    {
+        if (filter_ != nullptr && std::strstr(name, filter_) == nullptr) {
+            return;
+        }
+        op();  // warm-up: first-use caches and lazy statics are not the op
+        uint64_t batch = 1;
+        for (;;) {
+            const uint64_t allocs0 = g_allocs.load(std::memory_order_relaxed);
+            const uint64_t bytes0 = g_allocBytes.load(std::memory_order_relaxed);
+            const auto t0 = std::chrono::steady_clock::now();
+            for (uint64_t i = 0; i < batch; ++i) {
+                op();
+            }
+            const double ns =
+                std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - t0)
+                    .count();
+            if (ns >= minNs_ || batch >= (uint64_t{1} << 32)) {
+                const double ops = static_cast<double>(batch * unitsPerOp);
+                Result r;
+                r.name = name;
+                r.iterations = batch * unitsPerOp;
+                r.nsPerOp = ns / ops;
+                r.allocsPerOp =
+                    static_cast<double>(g_allocs.load(std::memory_order_relaxed) - allocs0) / ops;
+                r.bytesPerOp =
+                    static_cast<double>(g_allocBytes.load(std::memory_order_relaxed) - bytes0) /
+                    ops;
+                std::printf("%-32s %12.1f ns/op %9.2f allocs/op %11.1f B/op  (%llu ops)\n",
+                            name, r.nsPerOp, r.allocsPerOp, r.bytesPerOp,
+                            static_cast<unsigned long long>(r.iterations));
+                results_.push_back(r);
+                return;
+            }
+            batch *= 2;
+        }
+    }
+
+    const std::vector<Result>& results() const { return results_; }
+
+private:
+    const double minNs_;
+    const char* const filter_;
+    std::vector<Result> results_;
+};
+
+// -- API ----------------------------------------------------------------------
+
+api::SensorReadingsDto sampleSensors()
+{
+    api::SensorReadingsDto s;
+    s.environmental.valid = true;
+    s.environmental.temperature = 21.4f;
+    s.environmental.humidity = 55.2f;
+    s.environmental.pressure = 1012.8f;
+    s.soil.valid = true;
+    s.soil.moisture = 41.7f;
+    s.soil.temperature = 17.9f;
+    s.soil.humidity = 41.7f;
+    s.soil.ph = 6.4f;
+    s.soil.ec = 812.0f;
+    s.hasTimestamp = true;
+    s.timestamp = kStartEpoch;
+    return s;
+}
+
+/// A day of 5 min readings, the dashboard's default chart.
+api::HistorySeries sampleHistory()
+{
+    api::HistorySeries series;
+    series.metric = "soil_moisture";
+    series.start = kStartEpoch;
+    series.end = kStartEpoch + 86'400;
+    for (uint32_t i = 0; i < 288; ++i) {
+        series.timestamps.push_back(kStartEpoch + i * 300);
+        series.values.push_back(40.0f + static_cast<float>(i % 17) * 0.3f);
+    }
+    return series;
+}
+
+void benchApi(Runner& runner)
+{
+    const api::SensorReadingsDto sensors = sampleSensors();
+    runner.run("api.serialize.sensors", [&sensors] {
+        std::string body = api::serializeSensors(sensors);
+        keep(body);
+    });
+    const api::HistorySeries history = sampleHistory();
+    runner.run("api.serialize.history_288", [&history] {
+        std::string body = api::serializeHistory(history);
+        keep(body);
+    });
+
+    const std::string configBody =
+        "{\"moistureThresholdLow\":30,\"moistureThresholdHigh\":60,"
+        "\"wateringDurationS\":20,\"minWateringIntervalS\":600}";
+    runner.run("api.parse.config_set", [&configBody] {
+        api::ConfigSetResult r = api::parseConfigSet(configBody);
+        keep(r);
+    });
+    runner.run("api.parse.query_value", [] {
+        std::string_view value;
+        const bool found =
+            api::findQueryValue("metrics=soil_moisture&range=24h&maxPoints=300", "range", value);
+        keep(found);
+        keep(value);
+    });
+
+    runner.run("api.routes.match", [] {
+        const api::HandlerId id = api::matchRoute(api::HttpMethod::Get, "/api/v1/history");
+        keep(id);
+    });
+    runner.run("api.routes.miss", [] {
+        const api::HandlerId id = api::matchRoute(api::HttpMethod::Get, "/index.html");
+        keep(id);
+    });
+}
+
+// -- Storage ------------------------------------------------------------------
+
+/// A fresh directory on tmpfs (BENCH_DIR's parent), removed at scope exit.
+class TempDir {
+public:
+    explicit TempDir(const char* parent)
+    {
+        std::string templ = std::string(parent) + "/ws_bench_XXXXXX";
+        if (::mkdtemp(&templ[0]) != nullptr) {
+            path_ = templ;
+        }
+    }
+    ~TempDir()
+    {
+        if (!path_.empty()) {
+            removeTree(path_);
+        }
+    }
+    TempDir(const TempDir&) = delete;
+    TempDir& operator=(const TempDir&) = delete;
+
+    const std::string& path() const { return path_; }
+
+private:
+    static void removeTree(const std::string& path)
+    {
+        if (DIR* dir = ::opendir(path.c_str())) {
+            while (const dirent* entry = ::readdir(dir)) {
+                if (std::strcmp(entry->d_name, ".") == 0 ||
+                    std::strcmp(entry->d_name, "..") == 0) {
+                    continue;
+                }
+                removeTree(path + "/" + entry->d_name);
+            }
+            ::closedir(dir);
+        }
+        std::remove(path.c_str());  // file, or directory now empty
+    }
+
+    std::string path_;
+};
+
+bool benchStorage(Runner& runner, const char* parent)
+{
+    TempDir dir(parent);
+    if (dir.path().empty()) {
+        std::fprintf(stderr, "BENCH_DIR=\"%s\": cannot create a directory there\n", parent);
+        return false;
+    }
+    LittleFsDataStorage storage(dir.path());
+    uint32_t epoch = kStartEpoch;
+    runner.run("storage.append", [&storage, &epoch] {
+        const bool ok = storage.storeSensorReading("soil_moisture", epoch, 42.0f);
+        epoch += 300;
+        keep(ok);
+    });
+    // Whatever the append case wrote is the history the query reads; it
+    // is at least a day (the warm-up plus the first batches).
+    const uint32_t t1 = epoch;
+    const uint32_t t0 = t1 > kStartEpoch + 86'400 ? t1 - 86'400 : kStartEpoch;
+    runner.run("storage.query_day", [&storage, t0, t1] {
+        std::vector<SensorReading> readings = storage.getSensorReadings("soil_moisture", t0, t1);
+        keep(readings);
+    });
+
+    // Decode cost per record: one full 8 KiB chunk streamed to a visitor
+    // that keeps nothing, so the file reads and the record codec are all
+    // that is timed.
+    constexpr uint32_t kChunkRecords = static_cast<uint32_t>(
+        LittleFsDataStorage::kHistoryChunkMaxBytes / LittleFsDataStorage::kHistoryRecordBytes);
+    for (uint32_t i = 0; i < kChunkRecords; ++i) {
+        storage.storeSensorReading("env_temperature", kStartEpoch + i * 300, 20.0f + i % 7);
+    }
+    struct SumVisitor final : IReadingVisitor {
+        float sum = 0.0f;
+        bool onReading(uint32_t, float value) override
+        {
+            sum += value;
+            return true;
+        }
+    };
+    runner.run(
+        "storage.scan_record",
+        [&storage] {
+            SumVisitor visitor;
+            storage.forEachReading("env_temperature", 0, UINT32_MAX, visitor);
+            keep(visitor.sum);
+        },
+        kChunkRecords);
+
+    // The chunk summary's reduction alone, over the same chunk in memory:
+    // the one-record reference against the lane kernel, per record.
+    std::vector<uint8_t> records(kChunkRecords * recordreduce::kRecordBytes);
+    for (uint32_t i = 0; i < kChunkRecords; ++i) {
+        const uint32_t at = kStartEpoch + i * 300;
+        const float value = 20.0f + static_cast<float>(i % 7);
+        std::memcpy(&records[i * recordreduce::kRecordBytes], &at, sizeof(at));
+        std::memcpy(&records[i * recordreduce::kRecordBytes + 4], &value, sizeof(value));
+    }
+    runner.run(
+        "storage.reduce_chunk_ref",
+        [&records] {
+            recordreduce::Reduction r;
+            recordreduce::reduceScalar(records.data(), kChunkRecords, r);
+            keep(r.sum);
+        },
+        kChunkRecords);
+    runner.run(
+        "storage.reduce_chunk",
+        [&records] {
+            recordreduce::Reduction r;
+            recordreduce::reduce(records.data(), kChunkRecords, r);
+            keep(r.sum);
+        },
+        kChunkRecords);
+    return true;
+}
+
+// -- Sensors and control ------------------------------------------------------
+
+/// Raw input that toggles every read: the debouncer's worst case.
+struct ChatteringInput : IDigitalInput {
+    bool level = false;
+    bool read() override
+    {
+        level = !level;
+        return level;
+    }
+};
+
+void benchLevelSensor(Runner& runner)
+{
+    ChatteringInput input;
+    FakeTimeProvider clock;
+    DebouncedLevelSensor sensor(input, clock, false, 100, 0);
+    runner.run("sensors.level_update", [&sensor, &clock] {
+        clock.advance(10);
+        sensor.update();
+    });
+}
+
+void benchWateringTick(Runner& runner)
+{
+    FakeTimeProvider clock;
+    FakeWallClock wallClock(kStartEpoch);
+    MockConfigStore config;
+    config.stored.wateringEnabled = 1;
+    MockDataStorage storage;
+    EventLogger events(storage, wallClock);
+    MockEnvironmentalSensor env;
+    MockSoilSensor soil;
+    // Between the thresholds: the steady idle tick, the one that runs
+    // every sensor interval all day.
+    soil.moisture = (config.getMoistureThresholdLow() + config.getMoistureThresholdHigh()) / 2;
+    MockWaterPump pump("plant", clock);
+    pump.initialize();
+    WateringController watering(soil, env, pump, config, storage, clock, wallClock, events);
+    const int64_t stepMs = config.getSensorReadIntervalMs();
+    runner.run("control.watering_tick", [&] {
+        clock.advance(stepMs);
+        wallClock.setEpoch(wallClock.nowEpoch() + static_cast<uint32_t>(stepMs / 1000));
+        watering.tick();
+    });
+}
+
+// -- Output -------------------------------------------------------------------
+
+bool writeJson(const char* path, const std::vector<Result>& results, double minMs)
+{
+    FILE* f = std::fopen(path, "w");
+    if (f == nullptr) {
+        std::fprintf(stderr, "BENCH_OUT=\"%s\": cannot write\n", path);
+        return false;
+    }
+    std::fprintf(f, "{\n  \"version\": 1,\n  \"minMs\": %.0f,\n  \"results\": [", minMs);
+    for (std::size_t i = 0; i < results.size(); ++i) {
+        const Result& r = results[i];
+        std::fprintf(f,
+                     "%s\n    {\"name\": \"%s\", \"iterations\": %llu, \"nsPerOp\": %.2f, "
+                     "\"allocsPerOp\": %.3f, \"bytesPerOp\": %.1f}",
+                     i == 0 ? "" : ",", r.name.c_str(),
+                     static_cast<unsigned long long>(r.iterations), r.nsPerOp, r.allocsPerOp,
+                     r.bytesPerOp);
+    }
+    std::fprintf(f, "\n  ]\n}\n");
+    return std::fclose(f) == 0;
+}
+
+}  // namespace
+
+extern "C" void app_main(void)
+{
+    bool ok = true;
+    const double minMs = envNumber("BENCH_MIN_MS", 200, ok);
+    const char* out = envString("BENCH_OUT", "bench_results.json");
+    const char* filter = std::getenv("BENCH_FILTER");
+    const char* dir = envString("BENCH_DIR", access("/dev/shm", W_OK) == 0 ? "/dev/shm" : "/tmp");
+    if (!ok) {
+        std::exit(2);
+    }
+
+    // cJSON's allocations count too (the serializers build a DOM first).
+    cJSON_Hooks hooks = {};
+    hooks.malloc_fn = &cjsonMalloc;
+    hooks.free_fn = &cjsonFree;
+    cJSON_InitHooks(&hooks);
+
+    Runner runner(minMs, filter);
+    benchApi(runner);
+    ok = benchStorage(runner, dir);
+    benchLevelSensor(runner);
+    benchWateringTick(runner);
+
+    if (!writeJson(out, runner.results(), minMs) || !ok) {
+        std::exit(1);
+    }
+    std::printf("wrote %s (%zu results)\n", out, runner.results().size());
+    std::exit(0);
+}
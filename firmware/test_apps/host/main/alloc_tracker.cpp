@@ -0,0 +1,157 @@
+// SPDX-FileCopyrightText: 2026 Cryptotomte
+// SPDX-License-Identifier: AGPL-3.0-or-later
+/**
+ * @file alloc_tracker.cpp
+ * @brief The counting global operator new and AllocScope (see
+ *        alloc_tracker.h).
+ */
+
+#include "alloc_tracker.h"
+
+#include <cstdio>
+#include <cstdlib>
+#include <new>
+
+#include "unity.h"
+
+#include "cJSON.h"
+
+namespace {
+
+// Per thread, so a worker thread's allocations never land in a scope.
+// Trivially initialized: operator new may run before main().
+thread_local int t_depth = 0;  ///< AllocScopes open on this thread
+thread_local std::size_t t_allocations = 0;
+thread_local std::size_t t_bytes = 0;
+
+void* countedMalloc(std::size_t size)
+{
+    if (t_depth > 0) {
+        ++t_allocations;
+        t_bytes += size;
+    }
+    return std::malloc(size != 0 ? size : 1);
+}
+
+void* cjsonMalloc(size_t size)
+{
+    return countedMalloc(size);
+}
+
+void cjsonFree(void* p)
+{
+    std::free(p);
+}
+
+AllocCounts current()
+{
+    AllocCounts c;
+    c.allocations = t_allocations;
+    c.bytes = t_bytes;
+    return c;
+}
+
+}  // namespace
+
+// Counting replacements. Every form is replaced, not just the two the
+// others forward to by default: a sanitizer runtime intercepts the ones
+// left alone, and their blocks would then reach this free().
+void* operator new(std::size_t size)
+{
+    void* p = countedMalloc(size);
+    if (p == nullptr) {
+        std::abort();
+    }
+    return p;
+}
+
+void* operator new[](std::size_t size)
+{
+    return operator new(size);
+}
+
+void* operator new(std::size_t size, const std::nothrow_t&) noexcept
+{
+    return countedMalloc(size);
+}
+
+void* operator new[](std::size_t size, const std::nothrow_t&) noexcept
+{
+    return countedMalloc(size);
+}
+
+void operator delete(void* p) noexcept
+{
+    std::free(p);
+}
+
+void operator delete[](void* p) noexcept
+{
+    std::free(p);
+}
+
+void operator delete(void* p, std::size_t) noexcept
+{
+    std::free(p);
+}
+
+void operator delete[](void* p, std::size_t) noexcept
+{
+    std::free(p);
+}
+
+void operator delete(void* p, const std::nothrow_t&) noexcept
+{
+    std::free(p);
+}
+
+void operator delete[](void* p, const std::nothrow_t&) noexcept
+{
+    std::free(p);
+}
+
+AllocScope::AllocScope() : start_(current())
+{
+    if (t_depth++ == 0) {
+        cJSON_Hooks hooks = {&cjsonMalloc, &cjsonFree};
+        cJSON_InitHooks(&hooks);
+    }
+}
+
+AllocScope::~AllocScope()
+{
+    stop();
+}
+
+AllocCounts AllocScope::counts() const
+{
+    if (stopped_) {
+        return final_;
+    }
+    const AllocCounts now = current();
+    AllocCounts c;
+    c.allocations = now.allocations - start_.allocations;
+    c.bytes = now.bytes - start_.bytes;
+    return c;
+}
+
+AllocCounts AllocScope::stop()
+{
+    if (!stopped_) {
+        final_ = counts();
+        stopped_ = true;
+        if (--t_depth == 0) {
+            cJSON_InitHooks(nullptr);
+        }
+    }
+    return final_;
+}
+
+void AllocScope::expectAtMost(std::size_t limit, int line)
+{
+    const AllocCounts c = stop();
+    char message[96];
+    std::snprintf(message, sizeof message, "%zu heap allocations (%zu bytes), at most %zu allowed",
+                  c.allocations, c.bytes, limit);
+    UNITY_TEST_ASSERT(c.allocations <= limit, static_cast<UNITY_LINE_TYPE>(line), message);
+}
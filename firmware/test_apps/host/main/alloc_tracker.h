@@ -0,0 +1,75 @@
+// SPDX-FileCopyrightText: 2026 Cryptotomte
+// SPDX-License-Identifier: AGPL-3.0-or-later
+/**
+ * @file alloc_tracker.h
+ * @brief Heap allocation counting for the host suites.
+ *
+ * alloc_tracker.cpp replaces the global operator new/delete of the test
+ * binary. Counting is opt-in per scope: only the allocations a thread
+ * makes while it has an AllocScope open are counted, so the suites that
+ * never ask (or run worker threads next to one that does) see nothing but
+ * a thread-local check. While a scope is open cJSON's allocator (plain
+ * malloc otherwise) goes through the counters too, so a serializer's DOM
+ * counts as well as its std::string; the default hooks are back when the
+ * outermost scope closes.
+ *
+ * The assertion forms wrap a block and fail at its line with the count:
+ *
+ *   EXPECT_NO_ALLOC { controller.tick(); }
+ *   EXPECT_ALLOCS_AT_MOST(2 * points + 64) { body = serializeHistory(series); }
+ *
+ * A failed assertion closes its scope first (Unity leaves the test with a
+ * longjmp, past the destructor).
+ */
+
+#ifndef WATERINGSYSTEM_HOST_ALLOC_TRACKER_H
+#define WATERINGSYSTEM_HOST_ALLOC_TRACKER_H
+
+#include <cstddef>
+
+/// Allocations made and bytes requested.
+struct AllocCounts {
+    std::size_t allocations = 0;
+    std::size_t bytes = 0;
+};
+
+/**
+ * @brief Counts the calling thread's heap allocations until stop() or
+ * destruction. Scopes nest; each reports only its own span.
+ */
+class AllocScope {
+public:
+    AllocScope();
+    ~AllocScope();
+
+    AllocScope(const AllocScope&) = delete;
+    AllocScope& operator=(const AllocScope&) = delete;
+
+    /// Counted so far (the final counts once stopped).
+    AllocCounts counts() const;
+
+    /// Stop counting; idempotent.
+    AllocCounts stop();
+
+    /// The EXPECT_* loop condition: true until the check below has run.
+    bool open() const { return !stopped_; }
+
+    /// Stop, then fail the current test at @p line when more than
+    /// @p limit allocations were made.
+    void expectAtMost(std::size_t limit, int line);
+
+private:
+    AllocCounts start_;
+    AllocCounts final_;
+    bool stopped_ = false;
+};
+
+/// Run the following block once and fail when it allocated more than @p n.
+#define EXPECT_ALLOCS_AT_MOST(n)                                                  \
+    for (AllocScope alloc_scope_; alloc_scope_.open();                            \
+         alloc_scope_.expectAtMost((n), __LINE__))
+
+/// Run the following block once and fail when it allocated at all.
+#define EXPECT_NO_ALLOC EXPECT_ALLOCS_AT_MOST(0)
+
+#endif /* WATERINGSYSTEM_HOST_ALLOC_TRACKER_H */
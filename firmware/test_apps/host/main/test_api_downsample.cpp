@@ -0,0 +1,173 @@
+// SPDX-FileCopyrightText: 2026 Cryptotomte
+// SPDX-License-Identifier: AGPL-3.0-or-later
+/**
+ * @file test_api_downsample.cpp
+ * @brief Host suite for the /history point-budget reducers (ApiDownsample.h).
+ *
+ * A window that fits is left to the raw path; MinMax keeps every bucket's
+ * extremes in time order; LTTB keeps the first and last reading and the
+ * triangle-maximising pick per bucket (a hand-computed case pins the
+ * arithmetic); both stay within the budget and only emit real readings.
+ */
+
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+#include "unity.h"
+
+#include "api/ApiDownsample.h"
+#include "api/ApiDtos.h"
+#include "storage/testing/MockDataStorage.h"
+
+namespace {
+
+api::HistorySeries windowOf(const std::string& metric, int64_t start, int64_t end)
+{
+    api::HistorySeries s;
+    s.metric = metric;
+    s.start = start;
+    s.end = end;
+    return s;
+}
+
+/// 60 s cadence, a gentle sine with one spike up and one dip down.
+void fillWave(MockDataStorage& storage, uint32_t n)
+{
+    for (uint32_t i = 0; i < n; ++i) {
+        float v = 20.0f + std::sin(static_cast<float>(i) / 40.0f);
+        if (i == 333) {
+            v = 90.0f;
+        } else if (i == 777) {
+            v = -40.0f;
+        }
+        storage.storeSensorReading("temp", i * 60, v);
+    }
+}
+
+/// Every point of @p s is a stored reading and time moves forward.
+void assertRealAndOrdered(const MockDataStorage& storage,
+                          const api::HistorySeries& s)
+{
+    const auto& stored = storage.history.at("temp");
+    for (std::size_t i = 0; i < s.timestamps.size(); ++i) {
+        if (i > 0) {
+            TEST_ASSERT_TRUE(s.timestamps[i] > s.timestamps[i - 1]);
+        }
+        const std::size_t at = static_cast<std::size_t>(s.timestamps[i] / 60);
+        TEST_ASSERT_EQUAL_FLOAT(stored[at].value, s.values[i]);
+    }
+}
+
+bool holds(const api::HistorySeries& s, float value)
+{
+    for (float v : s.values) {
+        if (v == value) {
+            return true;
+        }
+    }
+    return false;
+}
+
+void test_window_that_fits_is_left_raw()
+{
+    MockDataStorage storage;
+    fillWave(storage, 50);
+    api::HistorySeries s = windowOf("temp", 0, 49 * 60);
+    TEST_ASSERT_FALSE(
+        api::downsampleHistory(storage, s, api::HistoryAggregate::Lttb, 50));
+    TEST_ASSERT_FALSE(
+        api::downsampleHistory(storage, s, api::HistoryAggregate::MinMax, 50));
+    TEST_ASSERT_FALSE(
+        api::downsampleHistory(storage, s, api::HistoryAggregate::Avg, 10));
+    TEST_ASSERT_FALSE(
+        api::downsampleHistory(storage, s, api::HistoryAggregate::Lttb, 2));
+    TEST_ASSERT_EQUAL_size_t(0, s.timestamps.size());
+}
+
+void test_minmax_keeps_every_excursion()
+{
+    MockDataStorage storage;
+    fillWave(storage, 1000);
+    api::HistorySeries s = windowOf("temp", 0, 999 * 60);
+    s.bucketS = 3600;
+    TEST_ASSERT_TRUE(
+        api::downsampleHistory(storage, s, api::HistoryAggregate::MinMax, 100));
+    TEST_ASSERT_TRUE(s.timestamps.size() <= 100);
+    TEST_ASSERT_TRUE(s.timestamps.size() >= 98);
+    TEST_ASSERT_EQUAL_size_t(s.timestamps.size(), s.values.size());
+    TEST_ASSERT_EQUAL_UINT32(0, s.bucketS);
+    TEST_ASSERT_TRUE(holds(s, 90.0f));
+    TEST_ASSERT_TRUE(holds(s, -40.0f));
+    assertRealAndOrdered(storage, s);
+}
+
+void test_lttb_keeps_ends_and_spikes_within_budget()
+{
+    MockDataStorage storage;
+    fillWave(storage, 1000);
+    api::HistorySeries s = windowOf("temp", 0, 999 * 60);
+    TEST_ASSERT_TRUE(
+        api::downsampleHistory(storage, s, api::HistoryAggregate::Lttb, 40));
+    TEST_ASSERT_EQUAL_size_t(40, s.timestamps.size());
+    TEST_ASSERT_EQUAL_INT64(0, s.timestamps.front());
+    TEST_ASSERT_EQUAL_INT64(999 * 60, s.timestamps.back());
+    TEST_ASSERT_TRUE(holds(s, 90.0f));
+    TEST_ASSERT_TRUE(holds(s, -40.0f));
+    assertRealAndOrdered(storage, s);
+}
+
+void test_lttb_picks_the_largest_triangle()
+{
+    // Two 5 s buckets over [0, 9]; worked by hand: bucket one's best
+    // triangle against (0,0) and bucket two's mean (7,-0.6) is (2,5);
+    // bucket two's against (2,5) and the last reading (9,0) is (7,-3).
+    MockDataStorage storage;
+    const float values[] = {0, 0, 5, 0, 0, 0, 0, -3, 0, 0};
+    for (uint32_t t = 0; t < 10; ++t) {
+        storage.storeSensorReading("temp", t, values[t]);
+    }
+    api::HistorySeries s = windowOf("temp", 0, 9);
+    TEST_ASSERT_TRUE(
+        api::downsampleHistory(storage, s, api::HistoryAggregate::Lttb, 4));
+    const int64_t ts[] = {0, 2, 7, 9};
+    const float vs[] = {0.0f, 5.0f, -3.0f, 0.0f};
+    TEST_ASSERT_EQUAL_size_t(4, s.timestamps.size());
+    for (std::size_t i = 0; i < 4; ++i) {
+        TEST_ASSERT_EQUAL_INT64(ts[i], s.timestamps[i]);
+        TEST_ASSERT_EQUAL_FLOAT(vs[i], s.values[i]);
+    }
+}
+
+void test_gaps_stay_gaps()
+{
+    // Two dense clusters an outage apart: no pick lands in the outage.
+    MockDataStorage storage;
+    for (uint32_t i = 0; i < 200; ++i) {
+        storage.storeSensorReading("temp", i, static_cast<float>(i % 7));
+    }
+    for (uint32_t i = 0; i < 200; ++i) {
+        storage.storeSensorReading("temp", 100000 + i, static_cast<float>(i % 5));
+    }
+    for (api::HistoryAggregate agg :
+         {api::HistoryAggregate::MinMax, api::HistoryAggregate::Lttb}) {
+        api::HistorySeries s = windowOf("temp", 0, 100199);
+        TEST_ASSERT_TRUE(api::downsampleHistory(storage, s, agg, 50));
+        TEST_ASSERT_TRUE(s.timestamps.size() <= 50);
+        for (int64_t t : s.timestamps) {
+            TEST_ASSERT_TRUE(t < 200 || t >= 100000);
+        }
+    }
+}
+
+}  // namespace
+
+void run_api_downsample_tests(void)
+{
+    RUN_TEST(test_window_that_fits_is_left_raw);
+    RUN_TEST(test_minmax_keeps_every_excursion);
+    RUN_TEST(test_lttb_keeps_ends_and_spikes_within_budget);
+    RUN_TEST(test_lttb_picks_the_largest_triangle);
+    RUN_TEST(test_gaps_stay_gaps);
+}
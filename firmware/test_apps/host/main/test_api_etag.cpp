@@ -0,0 +1,176 @@
+// SPDX-FileCopyrightText: 2026 Cryptotomte
+// SPDX-License-Identifier: AGPL-3.0-or-later
+/**
+ * @file test_api_etag.cpp
+ * @brief Host suite for the entity-tag helpers (ApiETag.h).
+ *
+ * The fingerprints move with every serialized field and with nothing else
+ * (the /sensors timestamp, NaN payloads, the sign of zero), the tag format
+ * carries the salt and the weak prefix, and If-None-Match matching handles
+ * lists, `*`, weak comparison and malformed values, while If-Range takes
+ * the strong comparison only.
+ */
+
+#include <cmath>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include "unity.h"
+
+#include "api/ApiDtos.h"
+#include "api/ApiETag.h"
+
+namespace {
+
+api::SensorReadingsDto sampleReadings()
+{
+    api::SensorReadingsDto dto;
+    dto.environmental = {true, 21.5f, 48.0f, 1013.2f};
+    dto.soil.valid = true;
+    dto.soil.moisture = 37.0f;
+    dto.soil.nitrogen = NAN;
+    dto.level.low = {true, true};
+    dto.level.high = {true, false};
+    dto.hasTimestamp = true;
+    dto.timestamp = 1760000000;
+    return dto;
+}
+
+void test_sensors_fingerprint_ignores_the_response_time()
+{
+    const api::SensorReadingsDto base = sampleReadings();
+    api::SensorReadingsDto later = base;
+    later.timestamp += 5;
+    TEST_ASSERT_EQUAL_UINT32(api::sensorsFingerprint(base),
+                             api::sensorsFingerprint(later));
+
+    // The clock coming up changes the body shape (null -> number): a miss.
+    api::SensorReadingsDto unset = base;
+    unset.hasTimestamp = false;
+    TEST_ASSERT_TRUE(api::sensorsFingerprint(base) !=
+                     api::sensorsFingerprint(unset));
+}
+
+void test_sensors_fingerprint_moves_with_readings()
+{
+    const api::SensorReadingsDto base = sampleReadings();
+    const uint32_t fp = api::sensorsFingerprint(base);
+
+    api::SensorReadingsDto changed = base;
+    changed.environmental.temperature = 21.6f;
+    TEST_ASSERT_TRUE(fp != api::sensorsFingerprint(changed));
+
+    changed = base;
+    changed.level.high.waterPresent = true;
+    TEST_ASSERT_TRUE(fp != api::sensorsFingerprint(changed));
+
+    changed = base;
+    changed.soil.valid = false;
+    TEST_ASSERT_TRUE(fp != api::sensorsFingerprint(changed));
+
+    // Power joins the fingerprint only when the block is in the body.
+    changed = base;
+    changed.power.busVoltage = 12.0f;
+    TEST_ASSERT_EQUAL_UINT32(fp, api::sensorsFingerprint(changed));
+    changed.hasPower = true;
+    TEST_ASSERT_TRUE(fp != api::sensorsFingerprint(changed));
+}
+
+void test_floats_hash_by_printed_value()
+{
+    // Both NaNs print as null and both zeros as 0: same body, same hash.
+    const float quietNan = std::nanf("");
+    const float otherNan = std::nanf("0x123");
+    TEST_ASSERT_EQUAL_UINT32(api::ETagHash().add(quietNan).value(),
+                             api::ETagHash().add(otherNan).value());
+    TEST_ASSERT_EQUAL_UINT32(api::ETagHash().add(0.0f).value(),
+                             api::ETagHash().add(-0.0f).value());
+    TEST_ASSERT_TRUE(api::ETagHash().add(0.0f).value() !=
+                     api::ETagHash().add(quietNan).value());
+
+    // Strings are length-prefixed: the split point matters.
+    TEST_ASSERT_TRUE(
+        api::ETagHash().add(std::string("ab")).add(std::string("c")).value() !=
+        api::ETagHash().add(std::string("a")).add(std::string("bc")).value());
+}
+
+void test_pumps_fingerprint_covers_every_field()
+{
+    std::vector<api::PumpDto> pumps(2);
+    pumps[0] = {"plant", false, 0, 120000, "timeout"};
+    pumps[1] = {"reservoir", false, 0, 30000, "manual"};
+    const uint32_t fp = api::pumpsFingerprint(pumps);
+
+    std::vector<api::PumpDto> changed = pumps;
+    changed[0].running = true;
+    TEST_ASSERT_TRUE(fp != api::pumpsFingerprint(changed));
+    changed = pumps;
+    changed[1].currentRunTimeMs = 100;
+    TEST_ASSERT_TRUE(fp != api::pumpsFingerprint(changed));
+    changed = pumps;
+    changed[1].lastStopReason = "level";
+    TEST_ASSERT_TRUE(fp != api::pumpsFingerprint(changed));
+    changed = pumps;
+    changed.pop_back();
+    TEST_ASSERT_TRUE(fp != api::pumpsFingerprint(changed));
+}
+
+void test_format_etag()
+{
+    TEST_ASSERT_EQUAL_STRING("\"deadbeef0000002a\"",
+                             api::formatETag(0xdeadbeefu, 42).c_str());
+    TEST_ASSERT_EQUAL_STRING("W/\"0000000100000002\"",
+                             api::formatETag(1, 2, true).c_str());
+}
+
+void test_if_none_match()
+{
+    const std::string tag = api::formatETag(7, 9);          // "0000000700000009"
+    const std::string weak = api::formatETag(7, 9, true);
+
+    TEST_ASSERT_TRUE(api::ifNoneMatchHits(tag, tag));
+    TEST_ASSERT_TRUE(api::ifNoneMatchHits("*", tag));
+    TEST_ASSERT_TRUE(api::ifNoneMatchHits(
+        "\"0000000000000000\", " + tag + " ,\"ffffffffffffffff\"", tag));
+
+    // Weak comparison: the W/ prefix on either side is ignored.
+    TEST_ASSERT_TRUE(api::ifNoneMatchHits(weak, tag));
+    TEST_ASSERT_TRUE(api::ifNoneMatchHits(tag, weak));
+
+    TEST_ASSERT_FALSE(api::ifNoneMatchHits("", tag));
+    TEST_ASSERT_FALSE(api::ifNoneMatchHits(api::formatETag(8, 9), tag));
+    TEST_ASSERT_FALSE(api::ifNoneMatchHits("\"00000007\"", tag));
+    // Unquoted or unterminated values never match.
+    TEST_ASSERT_FALSE(api::ifNoneMatchHits("0000000700000009", tag));
+    TEST_ASSERT_FALSE(api::ifNoneMatchHits("\"0000000700000009", tag));
+}
+
+void test_if_range_is_strong(void)
+{
+    const std::string tag = api::formatETag(7, 9);
+    const std::string weak = api::formatETag(7, 9, true);
+
+    TEST_ASSERT_TRUE(api::ifRangeHolds(tag, tag));
+    TEST_ASSERT_TRUE(api::ifRangeHolds(" " + tag + " ", tag));
+    // Strong comparison: a weak tag on either side, another tag or a date
+    // all mean "send the whole body".
+    TEST_ASSERT_FALSE(api::ifRangeHolds(weak, tag));
+    TEST_ASSERT_FALSE(api::ifRangeHolds(weak, weak));
+    TEST_ASSERT_FALSE(api::ifRangeHolds(api::formatETag(8, 9), tag));
+    TEST_ASSERT_FALSE(api::ifRangeHolds("Wed, 21 Oct 2026 07:28:00 GMT", tag));
+    TEST_ASSERT_FALSE(api::ifRangeHolds("", ""));
+}
+
+}  // namespace
+
+void run_api_etag_tests(void)
+{
+    RUN_TEST(test_sensors_fingerprint_ignores_the_response_time);
+    RUN_TEST(test_sensors_fingerprint_moves_with_readings);
+    RUN_TEST(test_floats_hash_by_printed_value);
+    RUN_TEST(test_pumps_fingerprint_covers_every_field);
+    RUN_TEST(test_format_etag);
+    RUN_TEST(test_if_none_match);
+    RUN_TEST(test_if_range_is_strong);
+}
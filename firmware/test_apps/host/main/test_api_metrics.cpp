@@ -0,0 +1,449 @@
+// SPDX-FileCopyrightText: 2026 Cryptotomte
+// SPDX-License-Identifier: AGPL-3.0-or-later
+/**
+ * @file test_api_metrics.cpp
+ * @brief Host suite for the HTTP route metrics and the Prometheus body
+ *        (ApiMetrics.h).
+ *
+ * record() counts the request, its status class, bytes and latency bucket
+ * (bounds inclusive, past the last bound +Inf); the body carries cumulative
+ * buckets, exact second sums, the route table's labels, only routes that
+ * were hit, the system gauges, and streams through one bounded buffer.
+ * TlsMetrics counts full and resumed handshakes, a begun one never
+ * completed as failed, and the open sessions. SocketMetrics tracks each
+ * open HTTP session's age, idle time, requests and bytes, and counts the
+ * ones past its table. The buffer pools are exported only when declared.
+ */
+
+#include <string>
+
+#include "unity.h"
+
+#include "api/ApiMetrics.h"
+
+namespace {
+
+using api::HandlerId;
+using api::HttpMetrics;
+using api::metricSlot;
+
+struct StringSink final : api::IChunkSink {
+    std::string body;
+    std::size_t largest = 0;
+    bool fail = false;
+
+    bool send(const char* data, std::size_t len) override
+    {
+        if (fail) {
+            return false;
+        }
+        largest = len > largest ? len : largest;
+        body.append(data, len);
+        return true;
+    }
+};
+
+bool contains(const std::string& haystack, const char* needle)
+{
+    return haystack.find(needle) != std::string::npos;
+}
+
+void test_record_counts_class_bytes_and_bucket()
+{
+    HttpMetrics metrics;
+    const std::size_t slot = metricSlot(HandlerId::History);
+    metrics.record(slot, 200, 100, 1000);    // exactly the 1 ms bound
+    metrics.record(slot, 304, 0, 1001);      // just past it
+    metrics.record(slot, 400, 20, -5);       // clock oddity counts as 0
+    metrics.record(slot, 0, 0, 10000000);    // failed before a status; +Inf
+
+    const api::HttpMetricsSnapshot snap = metrics.snapshot();
+    const api::RouteMetrics& m = snap[slot];
+    TEST_ASSERT_EQUAL_UINT32(4, m.requests);
+    TEST_ASSERT_EQUAL_UINT32(1, m.statusClasses[1]);
+    TEST_ASSERT_EQUAL_UINT32(1, m.statusClasses[2]);
+    TEST_ASSERT_EQUAL_UINT32(1, m.statusClasses[3]);
+    TEST_ASSERT_EQUAL_UINT32(1, m.statusClasses[4]);
+    TEST_ASSERT_EQUAL_UINT64(120, m.bytesSent);
+    TEST_ASSERT_EQUAL_UINT32(2, m.latency[0]);
+    TEST_ASSERT_EQUAL_UINT32(1, m.latency[1]);
+    TEST_ASSERT_EQUAL_UINT32(1, m.latency[api::kLatencyBuckets]);
+    TEST_ASSERT_EQUAL_UINT64(10002001, m.latencySumUs);
+    TEST_ASSERT_EQUAL_UINT32(0, snap[metricSlot(HandlerId::Status)].requests);
+}
+
+void test_out_of_range_slot_is_ignored()
+{
+    HttpMetrics metrics;
+    metrics.record(api::kMetricSlots, 200, 1, 1);
+    const api::HttpMetricsSnapshot snap = metrics.snapshot();
+    for (const api::RouteMetrics& m : snap) {
+        TEST_ASSERT_EQUAL_UINT32(0, m.requests);
+    }
+}
+
+void test_body_has_labels_and_cumulative_buckets()
+{
+    HttpMetrics metrics;
+    const std::size_t slot = metricSlot(HandlerId::History);
+    metrics.record(slot, 200, 512, 1500);
+    metrics.record(slot, 200, 512, 3000000);
+    metrics.record(api::kStaticAssetsSlot, 304, 0, 200);
+
+    StringSink sink;
+    TEST_ASSERT_TRUE(
+        api::streamMetrics(metrics.snapshot(), api::SystemMetricsDto{}, sink));
+    const std::string& b = sink.body;
+    TEST_ASSERT_TRUE(contains(b, "# TYPE wateringsystem_http_request_duration_seconds histogram\n"));
+    TEST_ASSERT_TRUE(contains(b,
+        "wateringsystem_http_requests_total{route=\"/api/v1/history\",method=\"GET\",code=\"2xx\"} 2\n"));
+    TEST_ASSERT_TRUE(contains(b,
+        "wateringsystem_http_requests_total{route=\"/*\",method=\"GET\",code=\"3xx\"} 1\n"));
+    TEST_ASSERT_TRUE(contains(b,
+        "wateringsystem_http_response_bytes_total{route=\"/api/v1/history\",method=\"GET\"} 1024\n"));
+    TEST_ASSERT_TRUE(contains(b,
+        "wateringsystem_http_request_duration_seconds_bucket{route=\"/api/v1/history\",method=\"GET\",le=\"0.001\"} 0\n"));
+    TEST_ASSERT_TRUE(contains(b,
+        "wateringsystem_http_request_duration_seconds_bucket{route=\"/api/v1/history\",method=\"GET\",le=\"0.002\"} 1\n"));
+    TEST_ASSERT_TRUE(contains(b,
+        "wateringsystem_http_request_duration_seconds_bucket{route=\"/api/v1/history\",method=\"GET\",le=\"2.048\"} 1\n"));
+    TEST_ASSERT_TRUE(contains(b,
+        "wateringsystem_http_request_duration_seconds_bucket{route=\"/api/v1/history\",method=\"GET\",le=\"4.096\"} 2\n"));
+    TEST_ASSERT_TRUE(contains(b,
+        "wateringsystem_http_request_duration_seconds_bucket{route=\"/api/v1/history\",method=\"GET\",le=\"+Inf\"} 2\n"));
+    TEST_ASSERT_TRUE(contains(b,
+        "wateringsystem_http_request_duration_seconds_sum{route=\"/api/v1/history\",method=\"GET\"} 3.001500\n"));
+    TEST_ASSERT_TRUE(contains(b,
+        "wateringsystem_http_request_duration_seconds_count{route=\"/api/v1/history\",method=\"GET\"} 2\n"));
+    // Routes never hit are left out.
+    TEST_ASSERT_FALSE(contains(b, "route=\"/api/v1/status\""));
+}
+
+void test_pump_command_and_unmatched_labels()
+{
+    HttpMetrics metrics;
+    metrics.record(metricSlot(HandlerId::PumpCmd), 409, 40, 10);
+    metrics.record(metricSlot(HandlerId::NotFound), 404, 40, 10);
+    StringSink sink;
+    TEST_ASSERT_TRUE(
+        api::streamMetrics(metrics.snapshot(), api::SystemMetricsDto{}, sink));
+    TEST_ASSERT_TRUE(contains(sink.body,
+        "{route=\"/api/v1/pumps/{name}\",method=\"POST\",code=\"4xx\"} 1\n"));
+    TEST_ASSERT_TRUE(contains(sink.body,
+        "{route=\"unmatched\",method=\"ANY\",code=\"4xx\"} 1\n"));
+}
+
+void test_system_gauges_and_bounded_chunks()
+{
+    api::SystemMetricsDto sys;
+    sys.uptimeMs = 61250;
+    sys.heapFreeBytes = 123456;
+    sys.httpdStackFreeBytes = 1800;
+    sys.storage.usedBytes = 4096;
+    sys.storage.writes.appendUs = 2500;
+    sys.streamClients = 2;
+    sys.arenaHighWaterBytes = 5120;
+    sys.arenaFallbacks = 3;
+    sys.throttledRequests = 7;
+
+    HttpMetrics metrics;
+    for (std::size_t s = 0; s < api::kMetricSlots; ++s) {
+        metrics.record(s, 200, 1, 1);
+    }
+    StringSink sink;
+    TEST_ASSERT_TRUE(api::streamMetrics(metrics.snapshot(), sys, sink));
+    TEST_ASSERT_TRUE(contains(sink.body, "wateringsystem_uptime_seconds 61.250000\n"));
+    TEST_ASSERT_TRUE(contains(sink.body, "wateringsystem_heap_free_bytes 123456\n"));
+    TEST_ASSERT_TRUE(contains(sink.body, "wateringsystem_httpd_stack_free_bytes 1800\n"));
+    TEST_ASSERT_TRUE(contains(sink.body, "wateringsystem_storage_used_bytes 4096\n"));
+    TEST_ASSERT_TRUE(contains(sink.body, "wateringsystem_storage_append_seconds_total 0.002500\n"));
+    TEST_ASSERT_TRUE(contains(sink.body, "# TYPE wateringsystem_stream_clients gauge\n"
+                                         "wateringsystem_stream_clients 2\n"));
+    TEST_ASSERT_TRUE(contains(sink.body, "wateringsystem_api_arena_high_water_bytes 5120\n"));
+    TEST_ASSERT_TRUE(contains(sink.body, "# TYPE wateringsystem_api_arena_fallbacks_total counter\n"
+                                         "wateringsystem_api_arena_fallbacks_total 3\n"));
+    TEST_ASSERT_TRUE(contains(sink.body, "wateringsystem_api_throttled_requests_total 7\n"));
+    TEST_ASSERT_TRUE(sink.largest <= api::ChunkWriter::kBufferBytes);
+    TEST_ASSERT_TRUE(sink.body.back() == '\n');
+
+    StringSink broken;
+    broken.fail = true;
+    TEST_ASSERT_FALSE(api::streamMetrics(metrics.snapshot(), sys, broken));
+}
+
+void test_modbus_block_only_when_set()
+{
+    HttpMetrics metrics;
+    StringSink plain;
+    TEST_ASSERT_TRUE(api::streamMetrics(metrics.snapshot(), api::SystemMetricsDto{}, plain));
+    TEST_ASSERT_FALSE(contains(plain.body, "modbus"));
+
+    api::SystemMetricsDto sys;
+    sys.hasModbus = true;
+    sys.modbusLatencyBaseUs = 10000;
+    sys.modbusBusyUs = 1250000;
+    api::ModbusLinkDto link;
+    link.address = 1;
+    link.function = 3;
+    link.ok = 5;
+    link.frameErrors = 2;
+    link.timeouts = 1;
+    link.latency = {0, 2, 5, 0, 1};  // 20 ms, 40 ms, then +Inf
+    link.latencySumUs = 3300000;
+    link.lastSuccessMs = 61250;
+    sys.modbusLinks.push_back(link);
+    api::ModbusLinkDto absent;
+    absent.address = 9;
+    absent.function = 3;
+    absent.timeouts = 4;
+    absent.latency = {0, 0, 0, 0, 4};
+    sys.modbusLinks.push_back(absent);
+
+    StringSink sink;
+    TEST_ASSERT_TRUE(api::streamMetrics(metrics.snapshot(), sys, sink));
+    TEST_ASSERT_TRUE(contains(sink.body,
+        "wateringsystem_modbus_requests_total{slave=\"1\",function=\"3\",result=\"ok\"} 5\n"));
+    TEST_ASSERT_TRUE(contains(sink.body,
+        "wateringsystem_modbus_requests_total{slave=\"1\",function=\"3\",result=\"frame_error\"} 2\n"));
+    TEST_ASSERT_TRUE(contains(sink.body,
+        "wateringsystem_modbus_requests_total{slave=\"9\",function=\"3\",result=\"timeout\"} 4\n"));
+    TEST_ASSERT_TRUE(contains(sink.body,
+        "wateringsystem_modbus_request_duration_seconds_bucket{slave=\"1\",function=\"3\",le=\"0.04\"} 7\n"));
+    TEST_ASSERT_TRUE(contains(sink.body,
+        "wateringsystem_modbus_request_duration_seconds_bucket{slave=\"1\",function=\"3\",le=\"+Inf\"} 8\n"));
+    TEST_ASSERT_TRUE(contains(sink.body,
+        "wateringsystem_modbus_request_duration_seconds_sum{slave=\"1\",function=\"3\"} 3.300000\n"));
+    TEST_ASSERT_TRUE(contains(sink.body,
+        "wateringsystem_modbus_last_success_seconds{slave=\"1\",function=\"3\"} 61.250000\n"));
+    TEST_ASSERT_FALSE(contains(sink.body, "last_success_seconds{slave=\"9\""));
+    TEST_ASSERT_TRUE(contains(sink.body, "wateringsystem_modbus_bus_busy_seconds_total 1.250000\n"));
+}
+
+void test_wifi_power_save_block_only_when_set()
+{
+    HttpMetrics metrics;
+    StringSink plain;
+    TEST_ASSERT_TRUE(api::streamMetrics(metrics.snapshot(), api::SystemMetricsDto{}, plain));
+    TEST_ASSERT_FALSE(contains(plain.body, "wifi_power_save"));
+
+    api::SystemMetricsDto sys;
+    sys.wifiPowerSave = "max_modem";
+    StringSink sink;
+    TEST_ASSERT_TRUE(api::streamMetrics(metrics.snapshot(), sys, sink));
+    TEST_ASSERT_TRUE(contains(sink.body, "# TYPE wateringsystem_wifi_power_save gauge\n"));
+    TEST_ASSERT_TRUE(contains(sink.body, "wateringsystem_wifi_power_save{mode=\"none\"} 0\n"));
+    TEST_ASSERT_TRUE(contains(sink.body, "wateringsystem_wifi_power_save{mode=\"min_modem\"} 0\n"));
+    TEST_ASSERT_TRUE(contains(sink.body, "wateringsystem_wifi_power_save{mode=\"max_modem\"} 1\n"));
+}
+
+void test_power_block_only_when_set()
+{
+    HttpMetrics metrics;
+    StringSink plain;
+    TEST_ASSERT_TRUE(api::streamMetrics(metrics.snapshot(), api::SystemMetricsDto{}, plain));
+    TEST_ASSERT_FALSE(contains(plain.body, "pm_"));
+
+    api::SystemMetricsDto sys;
+    sys.powerStates = {{"cpu_max", 1'500'000}, {"idle", 60'000'000}};
+    sys.powerLocks = {{"apb_max", 42}};
+    StringSink sink;
+    TEST_ASSERT_TRUE(api::streamMetrics(metrics.snapshot(), sys, sink));
+    TEST_ASSERT_TRUE(contains(sink.body, "# TYPE wateringsystem_pm_state_seconds_total counter\n"));
+    TEST_ASSERT_TRUE(contains(sink.body,
+        "wateringsystem_pm_state_seconds_total{state=\"cpu_max\"} 1.500000\n"));
+    TEST_ASSERT_TRUE(contains(sink.body,
+        "wateringsystem_pm_state_seconds_total{state=\"idle\"} 60.000000\n"));
+    TEST_ASSERT_TRUE(contains(sink.body,
+        "wateringsystem_pm_lock_acquisitions_total{lock=\"apb_max\"} 42\n"));
+}
+
+void test_mqtt_block_only_when_set()
+{
+    HttpMetrics metrics;
+    StringSink plain;
+    TEST_ASSERT_TRUE(api::streamMetrics(metrics.snapshot(), api::SystemMetricsDto{}, plain));
+    TEST_ASSERT_FALSE(contains(plain.body, "mqtt_"));
+
+    api::SystemMetricsDto sys;
+    api::MqttUplinkStats mqtt;
+    mqtt.connected = true;
+    mqtt.watermark = 1760000000;
+    mqtt.batches = 12;
+    mqtt.replayPages = 3;
+    mqtt.spooled = 5;
+    sys.mqtt = mqtt;
+    StringSink sink;
+    TEST_ASSERT_TRUE(api::streamMetrics(metrics.snapshot(), sys, sink));
+    TEST_ASSERT_TRUE(contains(sink.body, "wateringsystem_mqtt_connected 1\n"));
+    TEST_ASSERT_TRUE(contains(sink.body, "wateringsystem_mqtt_replaying 0\n"));
+    TEST_ASSERT_TRUE(contains(sink.body,
+        "wateringsystem_mqtt_acked_through_epoch_seconds 1760000000\n"));
+    TEST_ASSERT_TRUE(contains(sink.body, "# TYPE wateringsystem_mqtt_published_total counter\n"));
+    TEST_ASSERT_TRUE(contains(sink.body, "wateringsystem_mqtt_published_total{kind=\"batch\"} 12\n"));
+    TEST_ASSERT_TRUE(contains(sink.body, "wateringsystem_mqtt_published_total{kind=\"replay\"} 3\n"));
+    TEST_ASSERT_TRUE(contains(sink.body, "wateringsystem_mqtt_spooled_batches_total 5\n"));
+}
+
+void test_tls_counts_kinds_failures_and_sessions()
+{
+    api::TlsMetrics tls;
+    tls.began();
+    tls.completed(false, 180000);   // full: 180 ms
+    tls.began();                    // never completes
+    tls.began();
+    tls.completed(true, 900);       // resumed within the first bucket
+    tls.began();
+    tls.completed(true, -1);
+    tls.closed();
+    tls.closed();
+    tls.closed();
+    tls.closed();                   // one close too many stays at zero
+
+    const api::TlsStats t = tls.snapshot();
+    TEST_ASSERT_EQUAL_UINT32(1, t.full.count);
+    TEST_ASSERT_EQUAL_UINT32(2, t.resumed.count);
+    TEST_ASSERT_EQUAL_UINT32(1, t.failed);
+    TEST_ASSERT_EQUAL_UINT32(0, t.sessionsOpen);
+    TEST_ASSERT_EQUAL_UINT64(180000, t.full.sumUs);
+    TEST_ASSERT_EQUAL_UINT32(1, t.full.durations[8]);   // 128..256 ms
+    TEST_ASSERT_EQUAL_UINT64(900, t.resumed.sumUs);
+    TEST_ASSERT_EQUAL_UINT32(2, t.resumed.durations[0]);
+}
+
+void test_tls_block_only_when_set()
+{
+    HttpMetrics metrics;
+    StringSink plain;
+    TEST_ASSERT_TRUE(api::streamMetrics(metrics.snapshot(), api::SystemMetricsDto{}, plain));
+    TEST_ASSERT_FALSE(contains(plain.body, "tls_"));
+
+    api::TlsMetrics tls;
+    tls.began();
+    tls.completed(false, 180000);
+    tls.began();
+    tls.completed(true, 2500);
+    api::SystemMetricsDto sys;
+    sys.tls = tls.snapshot();
+    StringSink sink;
+    TEST_ASSERT_TRUE(api::streamMetrics(metrics.snapshot(), sys, sink));
+    TEST_ASSERT_TRUE(contains(sink.body, "wateringsystem_tls_sessions_open 2\n"));
+    TEST_ASSERT_TRUE(contains(sink.body, "wateringsystem_tls_handshakes_total{kind=\"full\"} 1\n"));
+    TEST_ASSERT_TRUE(contains(sink.body, "wateringsystem_tls_handshakes_total{kind=\"resumed\"} 1\n"));
+    TEST_ASSERT_TRUE(contains(sink.body, "wateringsystem_tls_handshake_failures_total 0\n"));
+    TEST_ASSERT_TRUE(contains(sink.body,
+        "wateringsystem_tls_handshake_duration_seconds_bucket{kind=\"resumed\",le=\"0.002\"} 0\n"));
+    TEST_ASSERT_TRUE(contains(sink.body,
+        "wateringsystem_tls_handshake_duration_seconds_bucket{kind=\"resumed\",le=\"0.004\"} 1\n"));
+    TEST_ASSERT_TRUE(contains(sink.body,
+        "wateringsystem_tls_handshake_duration_seconds_sum{kind=\"full\"} 0.180000\n"));
+    TEST_ASSERT_TRUE(contains(sink.body,
+        "wateringsystem_tls_handshake_duration_seconds_count{kind=\"full\"} 1\n"));
+}
+
+void test_buffers_block_only_when_set()
+{
+    HttpMetrics metrics;
+    StringSink plain;
+    TEST_ASSERT_TRUE(api::streamMetrics(metrics.snapshot(), api::SystemMetricsDto{}, plain));
+    TEST_ASSERT_FALSE(contains(plain.body, "buffer_"));
+
+    api::SystemMetricsDto sys;
+    sys.buffers.push_back(api::BufferPoolDto{"request_arena", 32768, 0, 32768, 32768, 0});
+    sys.buffers.push_back(api::BufferPoolDto{"asset_cache", 49152, 20000, 0, 24000, 2});
+    StringSink sink;
+    TEST_ASSERT_TRUE(api::streamMetrics(metrics.snapshot(), sys, sink));
+    TEST_ASSERT_TRUE(contains(sink.body,
+        "wateringsystem_buffer_budget_bytes{pool=\"request_arena\"} 32768\n"));
+    TEST_ASSERT_TRUE(contains(sink.body,
+        "wateringsystem_buffer_used_bytes{pool=\"request_arena\",placement=\"psram\"} 32768\n"));
+    TEST_ASSERT_TRUE(contains(sink.body,
+        "wateringsystem_buffer_used_bytes{pool=\"asset_cache\",placement=\"internal\"} 20000\n"));
+    TEST_ASSERT_TRUE(contains(sink.body,
+        "wateringsystem_buffer_peak_bytes{pool=\"asset_cache\"} 24000\n"));
+    TEST_ASSERT_TRUE(contains(sink.body,
+        "wateringsystem_buffer_alloc_failures_total{pool=\"asset_cache\"} 2\n"));
+}
+
+void test_sessions_tracked_per_socket()
+{
+    api::SocketMetrics sockets;
+    sockets.setCapacity(4);
+    sockets.opened(54, 1000000);
+    sockets.opened(55, 2000000);
+    sockets.request(54, 300, 2500000);
+    sockets.request(54, 200, 3000000);
+    sockets.request(77, 999, 3000000);  // never opened: ignored
+    sockets.closed(55);
+    sockets.opened(56, 3500000);        // takes the freed slot
+
+    api::HttpSessionStats h = sockets.snapshot(4000000);
+    TEST_ASSERT_EQUAL_UINT32(4, h.maxOpen);
+    TEST_ASSERT_EQUAL_UINT32(2, h.open);
+    TEST_ASSERT_EQUAL_UINT32(2, h.peakOpen);
+    TEST_ASSERT_EQUAL_UINT32(3, h.opened);
+    TEST_ASSERT_EQUAL_UINT32(1, h.closed);
+    TEST_ASSERT_EQUAL_size_t(2, h.sessions.size());
+    TEST_ASSERT_EQUAL_INT(54, h.sessions[0].fd);
+    TEST_ASSERT_EQUAL_UINT32(2, h.sessions[0].requests);
+    TEST_ASSERT_EQUAL_UINT64(500, h.sessions[0].bytesSent);
+    TEST_ASSERT_EQUAL_UINT64(3000000, h.sessions[0].ageUs);
+    TEST_ASSERT_EQUAL_UINT64(1000000, h.sessions[0].idleUs);
+    TEST_ASSERT_EQUAL_INT(56, h.sessions[1].fd);
+    TEST_ASSERT_EQUAL_UINT64(500000, h.sessions[1].idleUs);
+
+    // Past the table: counted, not listed.
+    for (int fd = 100; fd < 100 + static_cast<int>(api::SocketMetrics::kMaxSessions); ++fd) {
+        sockets.opened(fd, 4000000);
+    }
+    h = sockets.snapshot(4000000);
+    TEST_ASSERT_EQUAL_UINT32(2, h.untracked);
+    TEST_ASSERT_EQUAL_size_t(api::SocketMetrics::kMaxSessions, h.sessions.size());
+    TEST_ASSERT_EQUAL_UINT32(2 + api::SocketMetrics::kMaxSessions, h.peakOpen);
+}
+
+void test_sessions_block_only_when_set()
+{
+    HttpMetrics metrics;
+    StringSink plain;
+    TEST_ASSERT_TRUE(api::streamMetrics(metrics.snapshot(), api::SystemMetricsDto{}, plain));
+    TEST_ASSERT_FALSE(contains(plain.body, "http_session"));
+
+    api::SocketMetrics sockets;
+    sockets.setCapacity(7);
+    sockets.opened(54, 0);
+    sockets.request(54, 1200, 1500000);
+    api::SystemMetricsDto sys;
+    sys.sessions = sockets.snapshot(2000000);
+    StringSink sink;
+    TEST_ASSERT_TRUE(api::streamMetrics(metrics.snapshot(), sys, sink));
+    TEST_ASSERT_TRUE(contains(sink.body, "wateringsystem_http_sessions_max 7\n"));
+    TEST_ASSERT_TRUE(contains(sink.body, "wateringsystem_http_sessions_open 1\n"));
+    TEST_ASSERT_TRUE(contains(sink.body, "# TYPE wateringsystem_http_sessions_opened_total counter\n"
+                                         "wateringsystem_http_sessions_opened_total 1\n"));
+    TEST_ASSERT_TRUE(contains(sink.body, "wateringsystem_http_session_requests{fd=\"54\"} 1\n"));
+    TEST_ASSERT_TRUE(contains(sink.body, "wateringsystem_http_session_sent_bytes{fd=\"54\"} 1200\n"));
+    TEST_ASSERT_TRUE(contains(sink.body,
+        "wateringsystem_http_session_age_seconds{fd=\"54\"} 2.000000\n"));
+    TEST_ASSERT_TRUE(contains(sink.body,
+        "wateringsystem_http_session_idle_seconds{fd=\"54\"} 0.500000\n"));
+}
+
+}  // namespace
+
+void run_api_metrics_tests(void)
+{
+    RUN_TEST(test_record_counts_class_bytes_and_bucket);
+    RUN_TEST(test_out_of_range_slot_is_ignored);
+    RUN_TEST(test_body_has_labels_and_cumulative_buckets);
+    RUN_TEST(test_pump_command_and_unmatched_labels);
+    RUN_TEST(test_system_gauges_and_bounded_chunks);
+    RUN_TEST(test_modbus_block_only_when_set);
+    RUN_TEST(test_wifi_power_save_block_only_when_set);
+    RUN_TEST(test_power_block_only_when_set);
+    RUN_TEST(test_mqtt_block_only_when_set);
+    RUN_TEST(test_tls_counts_kinds_failures_and_sessions);
+    RUN_TEST(test_tls_block_only_when_set);
+    RUN_TEST(test_buffers_block_only_when_set);
+    RUN_TEST(test_sessions_tracked_per_socket);
+    RUN_TEST(test_sessions_block_only_when_set);
+}
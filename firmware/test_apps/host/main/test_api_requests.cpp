@@ -11,14 +11,18 @@
  * and reject a bad action, an out-of-range duration and malformed JSON.
  */
 
+#include <cstddef>
 #include <cstdint>
 #include <optional>
 #include <string>
+#include <vector>
 
 #include "unity.h"
 
 #include "api/ApiDtos.h"
 #include "api/ApiRequests.h"
+#include "interfaces/IConfigStore.h"
+#include "interfaces/IDataStorage.h"
 
 namespace {
 
@@ -129,6 +133,61 @@ void test_config_reject_wrong_type(void)
     TEST_ASSERT_TRUE(r.error.find("wateringDurationS") != std::string::npos);
 }
 
+void test_config_log_policies_accept_and_reject(void)
+{
+    api::ConfigSetResult r = api::parseConfigSet(
+        "{\"logPolicies\":{\"soil_ph\":{\"deadbandAbs\":0.05,"
+        "\"deadbandRel\":0,\"heartbeatS\":900}}}");
+    TEST_ASSERT_TRUE(r.ok);
+    TEST_ASSERT_EQUAL_INT(1, static_cast<int>(r.request.logPolicies.size()));
+    TEST_ASSERT_EQUAL_STRING("soil_ph", r.request.logPolicies[0].metric.c_str());
+    TEST_ASSERT_EQUAL_FLOAT(0.05f, r.request.logPolicies[0].deadbandAbs);
+    TEST_ASSERT_EQUAL_UINT32(900, r.request.logPolicies[0].heartbeatS);
+
+    // Each rejection names the metric and applies nothing, including the
+    // valid companion field.
+    const char* bad[] = {
+        "{\"wateringDurationS\":20,\"logPolicies\":[]}",
+        "{\"wateringDurationS\":20,\"logPolicies\":{\"soil_humidity\":"
+        "{\"deadbandAbs\":0,\"deadbandRel\":0,\"heartbeatS\":0}}}",
+        "{\"wateringDurationS\":20,\"logPolicies\":{\"soil_ph\":"
+        "{\"deadbandAbs\":0,\"heartbeatS\":900}}}",
+        "{\"wateringDurationS\":20,\"logPolicies\":{\"soil_ph\":"
+        "{\"deadbandAbs\":0,\"deadbandRel\":1.5,\"heartbeatS\":900}}}",
+        "{\"wateringDurationS\":20,\"logPolicies\":{\"soil_ph\":"
+        "{\"deadbandAbs\":0,\"deadbandRel\":0,\"heartbeatS\":30}}}",
+        "{\"wateringDurationS\":20,\"logPolicies\":{\"soil_ph\":"
+        "{\"deadbandAbs\":0,\"deadbandRel\":0,\"heartbeatS\":900.5}}}",
+        "{\"wateringDurationS\":20,\"logPolicies\":{\"soil_ph\":"
+        "{\"deadbandAbs\":0,\"deadbandRel\":0,\"heartbeatS\":-1}}}",
+    };
+    for (const char* body : bad) {
+        r = api::parseConfigSet(body);
+        TEST_ASSERT_FALSE_MESSAGE(r.ok, body);
+        TEST_ASSERT_FALSE(r.request.wateringDurationS.has_value());
+        TEST_ASSERT_TRUE(r.request.logPolicies.empty());
+        TEST_ASSERT_TRUE(r.error.find("logPolicies") != std::string::npos);
+    }
+}
+
+void test_config_request_to_patch(void)
+{
+    api::ConfigSetResult r = api::parseConfigSet(
+        "{\"wateringEnabled\":false,\"dataLogIntervalMs\":120000,"
+        "\"logPolicies\":{\"env_humidity\":{\"deadbandAbs\":1,"
+        "\"deadbandRel\":0,\"heartbeatS\":600}}}");
+    TEST_ASSERT_TRUE(r.ok);
+    const ConfigPatch patch = api::toConfigPatch(r.request);
+    TEST_ASSERT_TRUE(patch.wateringEnabled.has_value());
+    TEST_ASSERT_FALSE(*patch.wateringEnabled);
+    TEST_ASSERT_EQUAL_UINT32(120000, patch.dataLogIntervalMs.value());
+    TEST_ASSERT_FALSE(patch.moistureThresholdLow.has_value());
+    TEST_ASSERT_TRUE(patch.logPolicies[metric::kEnvHumidity].has_value());
+    TEST_ASSERT_EQUAL_UINT32(600, patch.logPolicies[metric::kEnvHumidity]->heartbeatS);
+    TEST_ASSERT_FALSE(patch.logPolicies[metric::kSoilPh].has_value());
+    TEST_ASSERT_TRUE(IConfigStore::isValidPatch(patch));
+}
+
 // --- parsePumpCommand ----------------------------------------------------
 
 void test_pump_accept_start_min_duration(void)
@@ -342,6 +401,152 @@ void test_resolve_event_count_bounds(void)
         50u, static_cast<uint32_t>(api::resolveEventCount(-5)));
 }
 
+// --- event filters (category / cursor) ---------------------------------
+
+void test_parse_event_categories(void)
+{
+    uint32_t mask = 0;
+    TEST_ASSERT_TRUE(api::parseEventCategories("failsafe", mask));
+    TEST_ASSERT_EQUAL_HEX32(EventQuery::categoryBit(IDataStorage::kCategoryFailsafe),
+                            mask);
+    // Names and raw ids mix; the mask is the union.
+    TEST_ASSERT_TRUE(api::parseEventCategories("pump,4,reset", mask));
+    TEST_ASSERT_EQUAL_HEX32(EventQuery::categoryBit(IDataStorage::kCategoryPump) |
+                                EventQuery::categoryBit(IDataStorage::kCategoryOta) |
+                                EventQuery::categoryBit(IDataStorage::kCategoryReset),
+                            mask);
+    TEST_ASSERT_TRUE(api::parseEventCategories("31", mask));
+    TEST_ASSERT_EQUAL_HEX32(0x80000000u, mask);
+
+    // Rejections leave the mask untouched.
+    mask = 0x1234u;
+    for (const char* bad : {"", "pump,", ",pump", "pumps", "Pump", "32", "-1", "1 "}) {
+        TEST_ASSERT_FALSE_MESSAGE(api::parseEventCategories(bad, mask), bad);
+    }
+    TEST_ASSERT_EQUAL_HEX32(0x1234u, mask);
+}
+
+void test_parse_snapshot_fields(void)
+{
+    uint32_t fields = 0;
+    TEST_ASSERT_TRUE(api::parseSnapshotFields("sensors,pumps", fields));
+    TEST_ASSERT_EQUAL_HEX32(api::kSnapshotSensors | api::kSnapshotPumps, fields);
+    TEST_ASSERT_TRUE(api::parseSnapshotFields("power,status,sensors,pumps,power", fields));
+    TEST_ASSERT_EQUAL_HEX32(api::kSnapshotAll, fields);
+
+    fields = 0x1234u;
+    for (const char* bad : {"", "status,", ",status", "Status", "config", "pump"}) {
+        TEST_ASSERT_FALSE_MESSAGE(api::parseSnapshotFields(bad, fields), bad);
+    }
+    TEST_ASSERT_EQUAL_HEX32(0x1234u, fields);
+}
+
+void test_parse_status_and_sensors_fields(void)
+{
+    api::FieldSelection selection;
+    TEST_ASSERT_TRUE(api::parseStatusFields("wifi.rssi,mode", selection));
+    TEST_ASSERT_EQUAL_HEX32(api::kStatusWifi | api::kStatusMode, selection.members);
+    TEST_ASSERT_EQUAL_size_t(1, selection.keys.size());
+    TEST_ASSERT_EQUAL_STRING("wifi", selection.keys[0].member.c_str());
+    TEST_ASSERT_EQUAL_STRING("rssi", selection.keys[0].key.c_str());
+
+    // Named whole as well: no keys kept for it.
+    TEST_ASSERT_TRUE(api::parseSensorsFields("soil.moisture,soil,level.low", selection));
+    TEST_ASSERT_EQUAL_HEX32(api::kSensorsSoil | api::kSensorsLevel, selection.members);
+    TEST_ASSERT_EQUAL_size_t(1, selection.keys.size());
+    TEST_ASSERT_EQUAL_STRING("level", selection.keys[0].member.c_str());
+    TEST_ASSERT_TRUE(api::parseSensorsFields("soilBus", selection));
+    TEST_ASSERT_EQUAL_HEX32(api::kSensorsSoilProbes, selection.members);
+
+    selection.members = 0x1234u;
+    for (const char* bad : {"", "wifi,", ",wifi", "Wifi", "wifi.", ".rssi", "storage.writes.syncs",
+                            "soil"}) {
+        TEST_ASSERT_FALSE_MESSAGE(api::parseStatusFields(bad, selection), bad);
+    }
+    TEST_ASSERT_FALSE(api::parseSensorsFields("wifi.rssi", selection));
+    TEST_ASSERT_EQUAL_HEX32(0x1234u, selection.members);
+}
+
+void test_event_cursor_round_trip(void)
+{
+    const EventCursor cursor{1751003600u, 3u};
+    const std::string text = api::formatEventCursor(cursor);
+    TEST_ASSERT_EQUAL_STRING("1751003600.3", text.c_str());
+    EventCursor parsed;
+    TEST_ASSERT_TRUE(api::parseEventCursor(text, parsed));
+    TEST_ASSERT_EQUAL_UINT32(cursor.epoch, parsed.epoch);
+    TEST_ASSERT_EQUAL_UINT32(cursor.skip, parsed.skip);
+    TEST_ASSERT_TRUE(api::parseEventCursor("4294967295.0", parsed));
+    TEST_ASSERT_EQUAL_UINT32(UINT32_MAX, parsed.epoch);
+
+    parsed = EventCursor{7u, 7u};
+    for (const char* bad : {"", ".", "12", "12.", ".3", "12.3.4", "a.1",
+                            "4294967296.0", "-1.0", "1.+2"}) {
+        TEST_ASSERT_FALSE_MESSAGE(api::parseEventCursor(bad, parsed), bad);
+    }
+    TEST_ASSERT_EQUAL_UINT32(7u, parsed.epoch);
+}
+
+void test_reading_cursor_round_trip_and_page_limit(void)
+{
+    ReadingCursor parsed;
+    TEST_ASSERT_EQUAL_STRING("1751000060.2",
+                             api::formatReadingCursor(ReadingCursor{1751000060u, 2u})
+                                 .c_str());
+    TEST_ASSERT_TRUE(api::parseReadingCursor("1751000060.2", parsed));
+    TEST_ASSERT_EQUAL_UINT32(1751000060u, parsed.epoch);
+    TEST_ASSERT_EQUAL_UINT32(2u, parsed.skip);
+    TEST_ASSERT_FALSE(api::parseReadingCursor("1751000060", parsed));
+    TEST_ASSERT_FALSE(api::parseReadingCursor("1.2.3", parsed));
+    TEST_ASSERT_EQUAL_UINT32(1751000060u, parsed.epoch);
+
+    TEST_ASSERT_EQUAL_size_t(api::kHistoryMaxPoints,
+                             api::resolveHistoryPageLimit(std::nullopt));
+    TEST_ASSERT_EQUAL_size_t(1, api::resolveHistoryPageLimit(0u));
+    TEST_ASSERT_EQUAL_size_t(250, api::resolveHistoryPageLimit(250u));
+    TEST_ASSERT_EQUAL_size_t(api::kHistoryMaxPoints,
+                             api::resolveHistoryPageLimit(50000u));
+}
+
+void test_sync_token_round_trip_and_limit(void)
+{
+    api::HistorySyncMarks marks{};
+    marks[0] = ReadingCursor{1751000060u, 1u};
+    marks[5] = ReadingCursor{UINT32_MAX, 300u};
+    marks[15] = ReadingCursor{7u, 70000u};  // saturates: a resend, not a gap
+    const std::string token = api::formatSyncToken(marks);
+    TEST_ASSERT_EQUAL_size_t(api::kSyncTokenLen, token.size());
+    TEST_ASSERT_TRUE(token.size() < 160);  // fits one query value
+    TEST_ASSERT_EQUAL_size_t(std::string::npos, token.find_first_of("+/="));
+
+    api::HistorySyncMarks parsed{};
+    TEST_ASSERT_TRUE(api::parseSyncToken(token, parsed));
+    TEST_ASSERT_EQUAL_UINT32(1751000060u, parsed[0].epoch);
+    TEST_ASSERT_EQUAL_UINT32(1u, parsed[0].skip);
+    TEST_ASSERT_EQUAL_UINT32(UINT32_MAX, parsed[5].epoch);
+    TEST_ASSERT_EQUAL_UINT32(300u, parsed[5].skip);
+    TEST_ASSERT_EQUAL_UINT32(0u, parsed[6].epoch);
+    TEST_ASSERT_EQUAL_UINT32(65535u, parsed[15].skip);
+
+    // Wrong length, a character outside base64url, another version byte.
+    api::HistorySyncMarks untouched{};
+    TEST_ASSERT_FALSE(api::parseSyncToken(token.substr(1), untouched));
+    std::string bad = token;
+    bad[10] = '+';
+    TEST_ASSERT_FALSE(api::parseSyncToken(bad, untouched));
+    bad = token;
+    bad[0] = 'B';  // version 5
+    TEST_ASSERT_FALSE(api::parseSyncToken(bad, untouched));
+    TEST_ASSERT_EQUAL_UINT32(0u, untouched[0].epoch);
+
+    TEST_ASSERT_EQUAL_size_t(api::kHistorySyncMaxRecords,
+                             api::resolveHistorySyncLimit(std::nullopt));
+    TEST_ASSERT_EQUAL_size_t(1, api::resolveHistorySyncLimit(0u));
+    TEST_ASSERT_EQUAL_size_t(500, api::resolveHistorySyncLimit(500u));
+    TEST_ASSERT_EQUAL_size_t(api::kHistorySyncMaxRecords,
+                             api::resolveHistorySyncLimit(1000000u));
+}
+
 // --- resolveWindow -------------------------------------------------------
 
 void test_resolve_window_range_precedence(void)
@@ -427,6 +632,141 @@ void test_named_range_to_window_underflow_clamp(void)
     TEST_ASSERT_EQUAL_UINT32(now, t1);
 }
 
+// --- selectHistoryBucket -------------------------------------------------
+
+void test_select_history_bucket_for_named_ranges(void)
+{
+    const uint32_t now = 1700000000u;
+    const uint32_t fiveMin = 300u;
+    auto bucketFor = [&](uint32_t windowS, uint32_t intervalS) {
+        return api::selectHistoryBucket(now - windowS, now, intervalS,
+                                        api::kHistoryMaxPoints);
+    };
+
+    // At the default 5-min log interval: raw up to 24 h, hourly for 7d and
+    // 30d (720 points, well under the budget, never ~8640 raw readings).
+    TEST_ASSERT_EQUAL_UINT32(0u, bucketFor(3600u, fiveMin));
+    TEST_ASSERT_EQUAL_UINT32(0u, bucketFor(86400u, fiveMin));
+    TEST_ASSERT_EQUAL_UINT32(3600u, bucketFor(604800u, fiveMin));
+    TEST_ASSERT_EQUAL_UINT32(3600u, bucketFor(2592000u, fiveMin));
+
+    // At the 60 s floor 24 h is 1441 readings: hourly as well.
+    TEST_ASSERT_EQUAL_UINT32(3600u, bucketFor(86400u, 60u));
+    // Dense logging picks the minute tier; a year only fits as days.
+    TEST_ASSERT_EQUAL_UINT32(60u, bucketFor(21600u, 10u));
+    TEST_ASSERT_EQUAL_UINT32(86400u, bucketFor(31536000u, fiveMin));
+}
+
+void test_select_history_bucket_edges(void)
+{
+    // Exactly the budget of raw points still reads raw; one more does not.
+    TEST_ASSERT_EQUAL_UINT32(0u, api::selectHistoryBucket(0u, 999u, 1u, 1000));
+    TEST_ASSERT_EQUAL_UINT32(60u, api::selectHistoryBucket(0u, 1000u, 1u, 1000));
+    // Unaligned start: the first, partial bucket counts too.
+    TEST_ASSERT_EQUAL_UINT32(
+        3600u, api::selectHistoryBucket(30u, 30u + 4u * 60u, 1u, 4));
+    // Degenerate inputs stay total: zero interval, inverted window, and a
+    // window no width fits falls back to the coarsest.
+    TEST_ASSERT_EQUAL_UINT32(0u, api::selectHistoryBucket(10u, 5u, 0u, 1));
+    TEST_ASSERT_EQUAL_UINT32(
+        86400u, api::selectHistoryBucket(0u, 0xFFFFFFFFu, 60u, 2));
+}
+
+// --- splitHistoryMetrics -------------------------------------------------
+
+void test_split_history_metrics(void)
+{
+    std::vector<std::string> names;
+    TEST_ASSERT_TRUE(api::splitHistoryMetrics("env_temperature", names));
+    TEST_ASSERT_EQUAL_size_t(1, names.size());
+    TEST_ASSERT_EQUAL_STRING("env_temperature", names[0].c_str());
+
+    TEST_ASSERT_TRUE(api::splitHistoryMetrics(
+        "env_temperature,env_humidity,env_pressure", names));
+    TEST_ASSERT_EQUAL_size_t(3, names.size());
+    TEST_ASSERT_EQUAL_STRING("env_pressure", names[2].c_str());
+
+    // Malformed lists leave the previous result alone.
+    TEST_ASSERT_FALSE(api::splitHistoryMetrics("", names));
+    TEST_ASSERT_FALSE(api::splitHistoryMetrics("a,,b", names));
+    TEST_ASSERT_FALSE(api::splitHistoryMetrics("a,", names));
+    TEST_ASSERT_FALSE(api::splitHistoryMetrics("a,b,a", names));
+    TEST_ASSERT_FALSE(api::splitHistoryMetrics("a,b,c,d,e,f,g,h,i", names));
+    TEST_ASSERT_EQUAL_size_t(3, names.size());
+    TEST_ASSERT_TRUE(api::splitHistoryMetrics("a,b,c,d,e,f,g,h", names));
+    TEST_ASSERT_EQUAL_size_t(api::kHistoryMaxMetrics, names.size());
+}
+
+// --- maxPoints / agg -----------------------------------------------------
+
+void test_history_max_points_and_aggregate(void)
+{
+    TEST_ASSERT_EQUAL_size_t(api::kHistoryMaxPoints,
+                             api::resolveHistoryMaxPoints(std::nullopt));
+    TEST_ASSERT_EQUAL_size_t(500, api::resolveHistoryMaxPoints(500u));
+    TEST_ASSERT_EQUAL_size_t(api::kHistoryMinPoints,
+                             api::resolveHistoryMaxPoints(0u));
+    TEST_ASSERT_EQUAL_size_t(api::kHistoryMaxPoints,
+                             api::resolveHistoryMaxPoints(50000u));
+
+    api::HistoryAggregate agg = api::HistoryAggregate::Avg;
+    TEST_ASSERT_TRUE(api::parseHistoryAggregate("lttb", agg));
+    TEST_ASSERT_TRUE(agg == api::HistoryAggregate::Lttb);
+    TEST_ASSERT_TRUE(api::parseHistoryAggregate("minmax", agg));
+    TEST_ASSERT_TRUE(agg == api::HistoryAggregate::MinMax);
+    TEST_ASSERT_TRUE(api::parseHistoryAggregate("avg", agg));
+    TEST_ASSERT_TRUE(agg == api::HistoryAggregate::Avg);
+    TEST_ASSERT_FALSE(api::parseHistoryAggregate("LTTB", agg));
+    TEST_ASSERT_FALSE(api::parseHistoryAggregate("", agg));
+    TEST_ASSERT_TRUE(agg == api::HistoryAggregate::Avg);
+}
+
+// --- stepFillHistory -----------------------------------------------------
+
+void test_step_fill_raw_holds_skipped_readings(void)
+{
+    api::HistorySeries s;
+    // 60 s cadence: 0 and 60 adjacent, 60 -> 600 skipped (within a 900 s
+    // heartbeat), 600 -> 2000 an outage.
+    s.timestamps = {0, 60, 600, 2000};
+    s.values = {1.0f, 2.0f, 3.0f, 4.0f};
+    TEST_ASSERT_EQUAL_UINT32(1u, api::stepFillHistory(s, 60u, 900u));
+    TEST_ASSERT_EQUAL_UINT32(1u, s.filled);
+    const int64_t ts[] = {0, 60, 540, 600, 2000};
+    const float vs[] = {1.0f, 2.0f, 2.0f, 3.0f, 4.0f};
+    TEST_ASSERT_EQUAL_INT(5, static_cast<int>(s.timestamps.size()));
+    for (std::size_t i = 0; i < 5; ++i) {
+        TEST_ASSERT_EQUAL_INT64(ts[i], s.timestamps[i]);
+        TEST_ASSERT_EQUAL_FLOAT(vs[i], s.values[i]);
+    }
+
+    // No heartbeat: nothing to fill.
+    api::HistorySeries off;
+    off.timestamps = {0, 600};
+    off.values = {1.0f, 2.0f};
+    TEST_ASSERT_EQUAL_UINT32(0u, api::stepFillHistory(off, 60u, 0u));
+    TEST_ASSERT_EQUAL_INT(2, static_cast<int>(off.timestamps.size()));
+}
+
+void test_step_fill_bucketed_holds_empty_buckets(void)
+{
+    api::HistorySeries s;
+    s.bucketS = 3600;
+    // An empty bucket at 3600 (held), then a 3-day hole (an outage).
+    s.timestamps = {0, 7200, 7200 + 3 * 86400};
+    s.values = {5.0f, 6.0f, 7.0f};
+    s.mins = {4.0f, 6.0f, 7.0f};
+    s.maxs = {6.0f, 6.0f, 7.0f};
+    TEST_ASSERT_EQUAL_UINT32(1u, api::stepFillHistory(s, 60u, 3600u));
+    TEST_ASSERT_EQUAL_INT(4, static_cast<int>(s.timestamps.size()));
+    TEST_ASSERT_EQUAL_INT64(3600, s.timestamps[1]);
+    TEST_ASSERT_EQUAL_FLOAT(5.0f, s.values[1]);
+    TEST_ASSERT_EQUAL_FLOAT(5.0f, s.mins[1]);
+    TEST_ASSERT_EQUAL_FLOAT(5.0f, s.maxs[1]);
+    TEST_ASSERT_EQUAL_FLOAT(4.0f, s.mins[0]);  // real buckets keep extremes
+    TEST_ASSERT_EQUAL_INT(4, static_cast<int>(s.mins.size()));
+}
+
 }  // namespace
 
 void run_api_requests_tests(void)
@@ -440,6 +780,8 @@ void run_api_requests_tests(void)
     RUN_TEST(test_config_reject_data_log_below_floor);
     RUN_TEST(test_config_reject_malformed_json);
     RUN_TEST(test_config_reject_wrong_type);
+    RUN_TEST(test_config_log_policies_accept_and_reject);
+    RUN_TEST(test_config_request_to_patch);
     RUN_TEST(test_pump_accept_start_min_duration);
     RUN_TEST(test_pump_accept_run_max_duration);
     RUN_TEST(test_pump_accept_stop);
@@ -458,6 +800,12 @@ void run_api_requests_tests(void)
     RUN_TEST(test_config_reject_moisture_low_negative);
     RUN_TEST(test_config_accept_interval_floors);
     RUN_TEST(test_resolve_event_count_bounds);
+    RUN_TEST(test_parse_event_categories);
+    RUN_TEST(test_parse_snapshot_fields);
+    RUN_TEST(test_parse_status_and_sensors_fields);
+    RUN_TEST(test_event_cursor_round_trip);
+    RUN_TEST(test_reading_cursor_round_trip_and_page_limit);
+    RUN_TEST(test_sync_token_round_trip_and_limit);
     RUN_TEST(test_resolve_window_range_precedence);
     RUN_TEST(test_resolve_window_explicit_both);
     RUN_TEST(test_resolve_window_start_only);
@@ -465,4 +813,10 @@ void run_api_requests_tests(void)
     RUN_TEST(test_resolve_window_none_defaults);
     RUN_TEST(test_resolve_window_unknown_range);
     RUN_TEST(test_named_range_to_window_underflow_clamp);
+    RUN_TEST(test_select_history_bucket_for_named_ranges);
+    RUN_TEST(test_select_history_bucket_edges);
+    RUN_TEST(test_split_history_metrics);
+    RUN_TEST(test_history_max_points_and_aggregate);
+    RUN_TEST(test_step_fill_raw_holds_skipped_readings);
+    RUN_TEST(test_step_fill_bucketed_holds_empty_buckets);
 }
@@ -7,11 +7,14 @@
  * Asserts matchRoute() resolves every /api/v1/ route to its HandlerId (the
  * full set, so US2/US3 need not re-touch this file), that POST /pumps/{name}
  * matches by prefix with a non-empty name, and that unknown /api/ paths and a
- * method mismatch resolve to HandlerId::NotFound (the JSON 404 path, FR-004).
+ * method mismatch resolve to HandlerId::NotFound (the JSON 404 path, FR-004),
+ * that routePathKnown() tells the mismatch apart (405), and that a view of
+ * the URI cut at its query matches without a terminator.
  */
 
 #include <cstddef>
 #include <cstring>
+#include <string_view>
 
 #include "unity.h"
 
@@ -28,11 +31,15 @@ using api::matchRoute;
 
 // The expected {path, method} contract set, maintained BY HAND to mirror the
 // docs/api/openapi.yaml paths block under its /api/v1 server base (status GET,
-// sensors GET, history GET, pumps GET, pumps/{name} POST, config GET, config
-// POST, power GET, events GET, selftest POST, ota POST). This array plus the
-// two-direction check below is the route/openapi drift barrier (A2): adding,
-// removing or re-verbing a route without updating both the table and the
-// contract fails the suite.
+// sensors GET, history GET, history/stats GET, history/sync GET, pumps GET,
+// pumps/{name} POST, pumps/{name}/usage GET, config GET, config POST, power
+// GET, power/capture GET, events GET, stream GET, selftest POST, ota POST,
+// metrics GET, snapshot GET, control/trace GET, trace GET, nodes GET, logs
+// GET, events/summary GET, modbus/capture GET, backup GET, restore POST,
+// recording GET, support-bundle GET, export.csv GET).
+// This array plus the two-direction check below is the route/openapi drift
+// barrier (A2): adding, removing or re-verbing a route without updating both
+// the table and the contract fails the suite.
 struct ExpectedRoute {
     const char* path;
     HttpMethod method;
@@ -42,14 +49,32 @@ const ExpectedRoute kExpectedRoutes[] = {
     {"/api/v1/status",       HttpMethod::Get},
     {"/api/v1/sensors",      HttpMethod::Get},
     {"/api/v1/history",      HttpMethod::Get},
+    {"/api/v1/history/stats", HttpMethod::Get},
+    {"/api/v1/history/sync", HttpMethod::Get},
     {"/api/v1/pumps",        HttpMethod::Get},
     {"/api/v1/pumps/{name}", HttpMethod::Post},
+    {"/api/v1/pumps/{name}/usage", HttpMethod::Get},
     {"/api/v1/config",       HttpMethod::Get},
     {"/api/v1/config",       HttpMethod::Post},
     {"/api/v1/power",        HttpMethod::Get},
+    {"/api/v1/power/capture", HttpMethod::Get},
     {"/api/v1/events",       HttpMethod::Get},
+    {"/api/v1/stream",       HttpMethod::Get},
     {"/api/v1/selftest",     HttpMethod::Post},
     {"/api/v1/ota",          HttpMethod::Post},
+    {"/api/v1/metrics",      HttpMethod::Get},
+    {"/api/v1/snapshot",     HttpMethod::Get},
+    {"/api/v1/control/trace", HttpMethod::Get},
+    {"/api/v1/trace",        HttpMethod::Get},
+    {"/api/v1/nodes",        HttpMethod::Get},
+    {"/api/v1/logs",         HttpMethod::Get},
+    {"/api/v1/events/summary", HttpMethod::Get},
+    {"/api/v1/modbus/capture", HttpMethod::Get},
+    {"/api/v1/backup",       HttpMethod::Get},
+    {"/api/v1/restore",      HttpMethod::Post},
+    {"/api/v1/recording",    HttpMethod::Get},
+    {"/api/v1/support-bundle", HttpMethod::Get},
+    {"/api/v1/export.csv",   HttpMethod::Get},
 };
 
 void test_routes_resolve_to_handlers(void)
@@ -60,6 +85,10 @@ void test_routes_resolve_to_handlers(void)
                      HandlerId::Sensors);
     TEST_ASSERT_TRUE(matchRoute(HttpMethod::Get, "/api/v1/power") ==
                      HandlerId::Power);
+    TEST_ASSERT_TRUE(matchRoute(HttpMethod::Get, "/api/v1/power/capture") ==
+                     HandlerId::PowerCapture);
+    TEST_ASSERT_TRUE(matchRoute(HttpMethod::Get, "/api/v1/stream") ==
+                     HandlerId::Stream);
     TEST_ASSERT_TRUE(matchRoute(HttpMethod::Get, "/api/v1/pumps") ==
                      HandlerId::PumpsList);
     TEST_ASSERT_TRUE(matchRoute(HttpMethod::Get, "/api/v1/config") ==
@@ -68,12 +97,36 @@ void test_routes_resolve_to_handlers(void)
                      HandlerId::ConfigSet);
     TEST_ASSERT_TRUE(matchRoute(HttpMethod::Get, "/api/v1/history") ==
                      HandlerId::History);
+    TEST_ASSERT_TRUE(matchRoute(HttpMethod::Get, "/api/v1/history/stats") ==
+                     HandlerId::HistoryStats);
+    TEST_ASSERT_TRUE(matchRoute(HttpMethod::Get, "/api/v1/history/sync") ==
+                     HandlerId::HistorySync);
     TEST_ASSERT_TRUE(matchRoute(HttpMethod::Get, "/api/v1/events") ==
                      HandlerId::Events);
     TEST_ASSERT_TRUE(matchRoute(HttpMethod::Post, "/api/v1/selftest") ==
                      HandlerId::SelfTest);
     TEST_ASSERT_TRUE(matchRoute(HttpMethod::Post, "/api/v1/ota") ==
-                     HandlerId::OtaStub);
+                     HandlerId::Ota);
+    TEST_ASSERT_TRUE(matchRoute(HttpMethod::Get, "/api/v1/metrics") ==
+                     HandlerId::Metrics);
+    TEST_ASSERT_TRUE(matchRoute(HttpMethod::Get, "/api/v1/snapshot") ==
+                     HandlerId::Snapshot);
+    TEST_ASSERT_TRUE(matchRoute(HttpMethod::Get, "/api/v1/control/trace") ==
+                     HandlerId::ControlTrace);
+    TEST_ASSERT_TRUE(matchRoute(HttpMethod::Get, "/api/v1/trace") ==
+                     HandlerId::Trace);
+    TEST_ASSERT_TRUE(matchRoute(HttpMethod::Get, "/api/v1/nodes") ==
+                     HandlerId::Nodes);
+    TEST_ASSERT_TRUE(matchRoute(HttpMethod::Get, "/api/v1/backup") ==
+                     HandlerId::Backup);
+    TEST_ASSERT_TRUE(matchRoute(HttpMethod::Post, "/api/v1/restore") ==
+                     HandlerId::Restore);
+    TEST_ASSERT_TRUE(matchRoute(HttpMethod::Get, "/api/v1/recording") ==
+                     HandlerId::Recording);
+    TEST_ASSERT_TRUE(matchRoute(HttpMethod::Get, "/api/v1/support-bundle") ==
+                     HandlerId::SupportBundle);
+    TEST_ASSERT_TRUE(matchRoute(HttpMethod::Get, "/api/v1/export.csv") ==
+                     HandlerId::ExportCsv);
 }
 
 void test_pump_command_matches_by_prefix(void)
@@ -91,6 +144,23 @@ void test_pump_command_matches_by_prefix(void)
                      HandlerId::PumpsList);
 }
 
+void test_pump_usage_matches_by_prefix_and_suffix(void)
+{
+    TEST_ASSERT_TRUE(matchRoute(HttpMethod::Get, "/api/v1/pumps/plant/usage") ==
+                     HandlerId::PumpUsage);
+    TEST_ASSERT_TRUE(matchRoute(HttpMethod::Get, "/api/v1/pumps/zone1/usage") ==
+                     HandlerId::PumpUsage);
+    // No name, a nested name, or no suffix: not the usage route.
+    TEST_ASSERT_TRUE(matchRoute(HttpMethod::Get, "/api/v1/pumps//usage") ==
+                     HandlerId::NotFound);
+    TEST_ASSERT_TRUE(matchRoute(HttpMethod::Get, "/api/v1/pumps/usage") ==
+                     HandlerId::NotFound);
+    TEST_ASSERT_TRUE(matchRoute(HttpMethod::Get, "/api/v1/pumps/a/b/usage") ==
+                     HandlerId::NotFound);
+    TEST_ASSERT_TRUE(matchRoute(HttpMethod::Get, "/api/v1/pumps/plant") ==
+                     HandlerId::NotFound);
+}
+
 void test_unknown_paths_are_not_found(void)
 {
     TEST_ASSERT_TRUE(matchRoute(HttpMethod::Get, "/api/v1/bogus") ==
@@ -108,6 +178,23 @@ void test_method_mismatch_is_not_found(void)
                      HandlerId::NotFound);
     TEST_ASSERT_TRUE(matchRoute(HttpMethod::Get, "/api/v1/selftest") ==
                      HandlerId::NotFound);
+    // ...which the dispatcher answers 405, not 404.
+    TEST_ASSERT_TRUE(api::routePathKnown("/api/v1/status"));
+    TEST_ASSERT_TRUE(api::routePathKnown("/api/v1/selftest"));
+    TEST_ASSERT_TRUE(api::routePathKnown("/api/v1/pumps/plant"));
+    TEST_ASSERT_FALSE(api::routePathKnown("/api/v1/nope"));
+}
+
+// The dispatcher passes the URI cut at its '?', not NUL-terminated there.
+void test_view_of_uri_matches(void)
+{
+    const std::string_view uri = "/api/v1/history?metric=soil_moisture&range=24h";
+    TEST_ASSERT_TRUE(matchRoute(HttpMethod::Get, uri.substr(0, uri.find('?'))) ==
+                     HandlerId::History);
+    TEST_ASSERT_TRUE(matchRoute(HttpMethod::Get, uri) == HandlerId::NotFound);
+    const std::string_view prefix = uri.substr(0, std::strlen("/api/v1/hist"));
+    TEST_ASSERT_TRUE(matchRoute(HttpMethod::Get, prefix) == HandlerId::NotFound);
+    TEST_ASSERT_TRUE(matchRoute(HttpMethod::Get, std::string_view()) == HandlerId::NotFound);
 }
 
 void test_route_table_matches_openapi_contract(void)
@@ -154,7 +241,9 @@ void run_api_routes_tests(void)
 {
     RUN_TEST(test_routes_resolve_to_handlers);
     RUN_TEST(test_pump_command_matches_by_prefix);
+    RUN_TEST(test_pump_usage_matches_by_prefix_and_suffix);
     RUN_TEST(test_unknown_paths_are_not_found);
     RUN_TEST(test_method_mismatch_is_not_found);
+    RUN_TEST(test_view_of_uri_matches);
     RUN_TEST(test_route_table_matches_openapi_contract);
 }
@@ -10,21 +10,31 @@
  * the wifi password never appears, rev1 power serializes as JSON null, a
  * `valid=false` soil section is still emitted (non-finite values as null), NPK
  * channels appear only when their has-flag is set, and a not-set clock
- * serializes without a bogus epoch.
+ * serializes without a bogus epoch. Readings carry their set decimals
+ * (23.4f as `23.4`). The fixed-buffer template bodies
+ * (JsonTemplate.h) equal the cJSON ones byte for byte. The heap cost of the
+ * list bodies is held to their elements, and the streamed history and
+ * fixed-buffer bodies to none.
  */
 
 #include <cmath>
+#include <cstring>
+#include <limits>
 #include <string>
 #include <vector>
 
 #include "unity.h"
 
+#include "alloc_tracker.h"
+
 #include "cJSON.h"
 
 #include "api/ApiDtos.h"
 #include "api/ApiEnvelope.h"
 #include "api/ApiRequests.h"
 #include "api/ApiSerialize.h"
+#include "api/ApiStream.h"
+#include "api/JsonTemplate.h"
 
 namespace {
 
@@ -41,6 +51,7 @@ api::SystemStatusDto makeStatus()
     s.wifi.connected = true;
     s.wifi.ipAcquired = true;
     s.wifi.ip = "192.168.1.42";
+    s.wifi.powerSave = "min_modem";
     s.time.synced = true;
     s.time.epoch = 1751000000;
     s.time.local = "2026-06-27 08:13:20 +0200";
@@ -52,11 +63,15 @@ api::SystemStatusDto makeStatus()
     s.storage.totalBytes = 960000;
     s.storage.usedBytes = 48000;
     s.storage.percentUsed = 5.0f;
+    s.storage.writes.bytesAppended = 5'000'000'000ULL;  // past 32 bits
+    s.storage.writes.syncs = 4321;
+    s.storage.writes.tornRepairs = 1;
     s.hasPower = true;
     s.power.valid = true;
     s.power.busVoltage = 12.1f;
     s.power.current = 0.35f;
     s.power.power = 4.235f;
+    s.boot = {{"pumps", 41250}, {"wifi", 612400}, {"apiUp", 0}};
     return s;
 }
 
@@ -83,6 +98,8 @@ void test_status_envelope_and_fields(void)
     TEST_ASSERT_TRUE(cJSON_IsTrue(cJSON_GetObjectItem(wifi, "ipAcquired")));
     TEST_ASSERT_EQUAL_STRING(
         "192.168.1.42", cJSON_GetObjectItem(wifi, "ip")->valuestring);
+    TEST_ASSERT_EQUAL_STRING(
+        "min_modem", cJSON_GetObjectItem(wifi, "powerSave")->valuestring);
 
     cJSON* time = cJSON_GetObjectItem(root, "time");
     TEST_ASSERT_TRUE(cJSON_IsTrue(cJSON_GetObjectItem(time, "synced")));
@@ -98,6 +115,20 @@ void test_status_envelope_and_fields(void)
     cJSON* st = cJSON_GetObjectItem(root, "storage");
     TEST_ASSERT_EQUAL_DOUBLE(
         960000.0, cJSON_GetObjectItem(st, "totalBytes")->valuedouble);
+    cJSON* writes = cJSON_GetObjectItem(st, "writes");
+    TEST_ASSERT_NOT_NULL(writes);
+    TEST_ASSERT_EQUAL_DOUBLE(
+        5e9, cJSON_GetObjectItem(writes, "bytesAppended")->valuedouble);
+    TEST_ASSERT_EQUAL_DOUBLE(4321.0, cJSON_GetObjectItem(writes, "syncs")->valuedouble);
+    TEST_ASSERT_EQUAL_DOUBLE(1.0, cJSON_GetObjectItem(writes, "tornRepairs")->valuedouble);
+    TEST_ASSERT_EQUAL_DOUBLE(0.0, cJSON_GetObjectItem(writes, "appendUs")->valuedouble);
+
+    // Boot phases in microseconds; a phase not reached yet is null.
+    cJSON* boot = cJSON_GetObjectItem(root, "bootUs");
+    TEST_ASSERT_NOT_NULL(boot);
+    TEST_ASSERT_EQUAL_DOUBLE(41250.0, cJSON_GetObjectItem(boot, "pumps")->valuedouble);
+    TEST_ASSERT_EQUAL_DOUBLE(612400.0, cJSON_GetObjectItem(boot, "wifi")->valuedouble);
+    TEST_ASSERT_TRUE(cJSON_IsNull(cJSON_GetObjectItem(boot, "apiUp")));
 
     cJSON_Delete(root);
 }
@@ -258,6 +289,60 @@ void test_sensors_npk_present_only_when_flagged(void)
     cJSON_Delete(root);
 }
 
+void test_sensors_soil_probes_only_on_multi_drop(void)
+{
+    api::SensorReadingsDto d;
+    std::string body = api::serializeSensors(d);
+    cJSON* root = cJSON_Parse(body.c_str());
+    TEST_ASSERT_NULL(cJSON_GetObjectItem(root, "soilProbes"));
+    TEST_ASSERT_NULL(cJSON_GetObjectItem(root, "soilBus"));
+    cJSON_Delete(root);
+
+    api::SoilProbeDto primary;
+    primary.address = 1;
+    primary.soil.valid = true;
+    primary.soil.moisture = 33.0f;
+    api::SoilProbeDto second;
+    second.address = 9;
+    second.soil.moisture = std::nan("");
+    second.soil.hasPotassium = true;
+    second.soil.potassium = 7.0f;
+    d.soilProbes = {primary, second};
+    d.soilBus.periodMs = 5000;
+    d.soilBus.readAirtimeUs = 39583;
+    d.soilBus.budgetPermille = 15;
+    d.soilBus.measuredPermille = 21;
+    d.soilBus.polls = 12;
+    d.soilBus.failures = 1;
+    d.soilBus.missed = 2;
+
+    body = api::serializeSensors(d);
+    root = cJSON_Parse(body.c_str());
+    TEST_ASSERT_NOT_NULL(root);
+    cJSON* probes = cJSON_GetObjectItem(root, "soilProbes");
+    TEST_ASSERT_EQUAL_INT(2, cJSON_GetArraySize(probes));
+    cJSON* first = cJSON_GetArrayItem(probes, 0);
+    TEST_ASSERT_EQUAL_STRING("address", first->child->string);  // address first
+    TEST_ASSERT_EQUAL_DOUBLE(1.0, cJSON_GetObjectItem(first, "address")->valuedouble);
+    TEST_ASSERT_TRUE(cJSON_IsTrue(cJSON_GetObjectItem(first, "valid")));
+    TEST_ASSERT_EQUAL_DOUBLE(33.0, cJSON_GetObjectItem(first, "moisture")->valuedouble);
+    cJSON* last = cJSON_GetArrayItem(probes, 1);
+    TEST_ASSERT_EQUAL_DOUBLE(9.0, cJSON_GetObjectItem(last, "address")->valuedouble);
+    TEST_ASSERT_TRUE(cJSON_IsNull(cJSON_GetObjectItem(last, "moisture")));
+    TEST_ASSERT_EQUAL_DOUBLE(7.0, cJSON_GetObjectItem(last, "potassium")->valuedouble);
+    TEST_ASSERT_NULL(cJSON_GetObjectItem(last, "nitrogen"));
+
+    cJSON* bus = cJSON_GetObjectItem(root, "soilBus");
+    TEST_ASSERT_EQUAL_DOUBLE(5000.0, cJSON_GetObjectItem(bus, "periodMs")->valuedouble);
+    TEST_ASSERT_EQUAL_DOUBLE(39.583, cJSON_GetObjectItem(bus, "readAirtimeMs")->valuedouble);
+    TEST_ASSERT_EQUAL_DOUBLE(1.5, cJSON_GetObjectItem(bus, "budgetPercent")->valuedouble);
+    TEST_ASSERT_EQUAL_DOUBLE(2.1, cJSON_GetObjectItem(bus, "measuredPercent")->valuedouble);
+    TEST_ASSERT_EQUAL_DOUBLE(12.0, cJSON_GetObjectItem(bus, "polls")->valuedouble);
+    TEST_ASSERT_EQUAL_DOUBLE(1.0, cJSON_GetObjectItem(bus, "failures")->valuedouble);
+    TEST_ASSERT_EQUAL_DOUBLE(2.0, cJSON_GetObjectItem(bus, "missedSlots")->valuedouble);
+    cJSON_Delete(root);
+}
+
 void test_sensors_rev1_power_null_and_not_set_timestamp(void)
 {
     // rev1 (no power) and clock not yet set: power key is JSON null and the
@@ -328,6 +413,29 @@ void test_power_non_finite_last_good_is_null(void)
     cJSON_Delete(root);
 }
 
+void test_power_energy_only_when_wired(void)
+{
+    api::PowerDto p{true, 12.0f, 0.5f, 6.0f};
+    cJSON* root = cJSON_Parse(api::serializePower(p).c_str());
+    TEST_ASSERT_NULL(cJSON_GetObjectItem(root, "energy"));
+    cJSON_Delete(root);
+
+    p.hasEnergy = true;
+    p.energy.dayWh = 1.23456;
+    p.energy.lastRunStart = 1751700000;
+    root = cJSON_Parse(api::serializePower(p).c_str());
+    const cJSON* energy = cJSON_GetObjectItem(root, "energy");
+    TEST_ASSERT_NOT_NULL(energy);
+    TEST_ASSERT_EQUAL_DOUBLE(1.2346, cJSON_GetObjectItem(energy, "dayWh")->valuedouble);
+    // Clock never set, no day closed: null, no bogus 1970.
+    TEST_ASSERT_TRUE(cJSON_IsNull(cJSON_GetObjectItem(energy, "dayStart")));
+    TEST_ASSERT_TRUE(cJSON_IsNull(cJSON_GetObjectItem(energy, "previousDayStart")));
+    TEST_ASSERT_EQUAL_DOUBLE(1751700000.0,
+                             cJSON_GetObjectItem(energy, "lastRunStart")->valuedouble);
+    TEST_ASSERT_FALSE(cJSON_IsTrue(cJSON_GetObjectItem(energy, "runActive")));
+    cJSON_Delete(root);
+}
+
 void test_power_unavailable_shape(void)
 {
     std::string body = api::serializePowerUnavailable();
@@ -406,6 +514,71 @@ void test_pump_list_serialize_array(void)
     cJSON_Delete(root);
 }
 
+// --- snapshot ------------------------------------------------------------
+
+/// @p body without its `success` key, printed unformatted.
+std::string withoutSuccess(const std::string& body)
+{
+    cJSON* root = cJSON_Parse(body.c_str());
+    cJSON_DeleteItemFromObject(root, "success");
+    char* text = cJSON_PrintUnformatted(root);
+    std::string out(text);
+    cJSON_free(text);
+    cJSON_Delete(root);
+    return out;
+}
+
+std::string printed(const cJSON* item)
+{
+    char* text = cJSON_PrintUnformatted(item);
+    std::string out(text);
+    cJSON_free(text);
+    return out;
+}
+
+void test_snapshot_sections_match_their_endpoints(void)
+{
+    api::SnapshotDto snap;
+    snap.status = makeStatus();
+    snap.sensors.environmental.valid = true;
+    snap.sensors.environmental.temperature = 22.5f;
+    snap.sensors.hasPower = true;
+    snap.sensors.power = snap.status.power;
+    snap.sensors.hasTimestamp = true;
+    snap.sensors.timestamp = 1751000000;
+    api::PumpDto plant;
+    plant.name = "plant";
+    plant.running = true;
+    snap.pumps.push_back(plant);
+    snap.hasPower = true;
+    snap.power = snap.status.power;
+
+    cJSON* root = cJSON_Parse(api::serializeSnapshot(snap).c_str());
+    TEST_ASSERT_NOT_NULL(root);
+    TEST_ASSERT_TRUE(cJSON_IsTrue(cJSON_GetObjectItem(root, "success")));
+    TEST_ASSERT_EQUAL_STRING(withoutSuccess(api::serializeStatus(snap.status)).c_str(),
+                             printed(cJSON_GetObjectItem(root, "status")).c_str());
+    TEST_ASSERT_EQUAL_STRING(withoutSuccess(api::serializeSensors(snap.sensors)).c_str(),
+                             printed(cJSON_GetObjectItem(root, "sensors")).c_str());
+    cJSON* list = cJSON_Parse(api::serializePumpList(snap.pumps).c_str());
+    TEST_ASSERT_EQUAL_STRING(printed(cJSON_GetObjectItem(list, "pumps")).c_str(),
+                             printed(cJSON_GetObjectItem(root, "pumps")).c_str());
+    cJSON_Delete(list);
+    TEST_ASSERT_EQUAL_STRING(withoutSuccess(api::serializePower(snap.power)).c_str(),
+                             printed(cJSON_GetObjectItem(root, "power")).c_str());
+    cJSON_Delete(root);
+
+    // A selection leaves the other sections out; rev1 power is null.
+    snap.fields = api::kSnapshotPumps | api::kSnapshotPower;
+    snap.hasPower = false;
+    root = cJSON_Parse(api::serializeSnapshot(snap).c_str());
+    TEST_ASSERT_NULL(cJSON_GetObjectItem(root, "status"));
+    TEST_ASSERT_NULL(cJSON_GetObjectItem(root, "sensors"));
+    TEST_ASSERT_TRUE(cJSON_IsArray(cJSON_GetObjectItem(root, "pumps")));
+    TEST_ASSERT_TRUE(cJSON_IsNull(cJSON_GetObjectItem(root, "power")));
+    cJSON_Delete(root);
+}
+
 // --- config --------------------------------------------------------------
 
 void test_config_serialize_all_fields_no_password(void)
@@ -418,6 +591,7 @@ void test_config_serialize_all_fields_no_password(void)
     c.wateringEnabled = true;
     c.sensorReadIntervalMs = 5000;
     c.dataLogIntervalMs = 300000;
+    c.logPolicies.push_back(api::LogPolicyDto{"soil_ph", 0.05f, 0.0f, 900});
 
     std::string body = api::serializeConfig(c);
     cJSON* root = cJSON_Parse(body.c_str());
@@ -438,6 +612,10 @@ void test_config_serialize_all_fields_no_password(void)
         5000.0, cJSON_GetObjectItem(root, "sensorReadIntervalMs")->valuedouble);
     TEST_ASSERT_EQUAL_DOUBLE(
         300000.0, cJSON_GetObjectItem(root, "dataLogIntervalMs")->valuedouble);
+    const cJSON* ph = cJSON_GetObjectItem(cJSON_GetObjectItem(root, "logPolicies"), "soil_ph");
+    TEST_ASSERT_NOT_NULL(ph);
+    TEST_ASSERT_EQUAL_DOUBLE(900.0, cJSON_GetObjectItem(ph, "heartbeatS")->valuedouble);
+    TEST_ASSERT_EQUAL_DOUBLE(0.0, cJSON_GetObjectItem(ph, "deadbandRel")->valuedouble);
 
     // The wifi password is never serialized in the config body.
     TEST_ASSERT_NULL(cJSON_GetObjectItem(root, "password"));
@@ -522,6 +700,108 @@ void test_history_empty_series_empty_arrays(void)
     cJSON_Delete(root);
 }
 
+void test_history_bucketed_series_adds_extremes(void)
+{
+    api::HistorySeries series;
+    series.metric = "soil_moisture";
+    series.start = 1751000000;
+    series.end = 1753592000;
+    series.bucketS = 3600;
+    series.timestamps = {1750999200, 1751002800};
+    series.values = {41.5f, 40.0f};
+    series.mins = {40.0f, 39.5f};
+    series.maxs = {43.0f, 40.5f};
+
+    std::string body = api::serializeHistory(series);
+    cJSON* root = cJSON_Parse(body.c_str());
+    TEST_ASSERT_NOT_NULL(root);
+    TEST_ASSERT_EQUAL_DOUBLE(
+        3600.0, cJSON_GetObjectItem(root, "bucket")->valuedouble);
+    cJSON* mins = cJSON_GetObjectItem(root, "min");
+    cJSON* maxs = cJSON_GetObjectItem(root, "max");
+    TEST_ASSERT_TRUE(cJSON_IsArray(mins));
+    TEST_ASSERT_TRUE(cJSON_IsArray(maxs));
+    TEST_ASSERT_EQUAL_INT(2, cJSON_GetArraySize(mins));
+    TEST_ASSERT_EQUAL_DOUBLE(39.5, cJSON_GetArrayItem(mins, 1)->valuedouble);
+    TEST_ASSERT_EQUAL_DOUBLE(43.0, cJSON_GetArrayItem(maxs, 0)->valuedouble);
+    TEST_ASSERT_EQUAL_DOUBLE(
+        2.0, cJSON_GetObjectItem(root, "count")->valuedouble);
+    cJSON_Delete(root);
+
+    // A raw series says so and carries no extremes.
+    series.bucketS = 0;
+    body = api::serializeHistory(series);
+    root = cJSON_Parse(body.c_str());
+    TEST_ASSERT_NOT_NULL(root);
+    TEST_ASSERT_EQUAL_DOUBLE(0.0, cJSON_GetObjectItem(root, "bucket")->valuedouble);
+    TEST_ASSERT_NULL(cJSON_GetObjectItem(root, "min"));
+    TEST_ASSERT_NULL(cJSON_GetObjectItem(root, "max"));
+    cJSON_Delete(root);
+}
+
+void test_history_stats_numbers_and_empty_window(void)
+{
+    api::HistoryStatsDto stats;
+    stats.metric = "soil_moisture";
+    stats.start = 1751644800;
+    stats.end = 1751731200;
+    stats.count = 288;
+    stats.min = 38.5f;
+    stats.max = 42.0f;
+    stats.mean = 40.25f;
+    stats.last = 41.0f;
+    stats.lastTimestamp = 1751731000;
+    stats.percentiles = true;
+    stats.p5 = 38.75f;
+    stats.p50 = 40.0f;
+    stats.p95 = 41.5f;
+
+    std::string body = api::serializeHistoryStats(stats);
+    cJSON* root = cJSON_Parse(body.c_str());
+    TEST_ASSERT_NOT_NULL(root);
+    TEST_ASSERT_TRUE(cJSON_IsTrue(cJSON_GetObjectItem(root, "success")));
+    TEST_ASSERT_EQUAL_DOUBLE(288.0, cJSON_GetObjectItem(root, "count")->valuedouble);
+    TEST_ASSERT_EQUAL_DOUBLE(38.5, cJSON_GetObjectItem(root, "min")->valuedouble);
+    TEST_ASSERT_EQUAL_DOUBLE(42.0, cJSON_GetObjectItem(root, "max")->valuedouble);
+    // Moisture has one decimal: 40.25 rounds half away from zero.
+    TEST_ASSERT_EQUAL_DOUBLE(40.3, cJSON_GetObjectItem(root, "mean")->valuedouble);
+    TEST_ASSERT_EQUAL_DOUBLE(41.0, cJSON_GetObjectItem(root, "last")->valuedouble);
+    TEST_ASSERT_EQUAL_DOUBLE(1751731000.0,
+                             cJSON_GetObjectItem(root, "lastTimestamp")->valuedouble);
+    TEST_ASSERT_EQUAL_DOUBLE(38.8, cJSON_GetObjectItem(root, "p5")->valuedouble);
+    TEST_ASSERT_EQUAL_DOUBLE(40.0, cJSON_GetObjectItem(root, "p50")->valuedouble);
+    TEST_ASSERT_EQUAL_DOUBLE(41.5, cJSON_GetObjectItem(root, "p95")->valuedouble);
+    TEST_ASSERT_EQUAL_STRING("soil_moisture",
+                             cJSON_GetObjectItem(root, "metric")->valuestring);
+    TEST_ASSERT_TRUE(cJSON_IsNull(cJSON_GetObjectItem(root, "reading")));
+    TEST_ASSERT_EQUAL_DOUBLE(1751644800.0, cJSON_GetObjectItem(root, "start")->valuedouble);
+    // No series in the body: that is the point of the endpoint.
+    TEST_ASSERT_NULL(cJSON_GetObjectItem(root, "values"));
+    cJSON_Delete(root);
+
+    // No finite reading to rank: only the percentiles are null.
+    stats.percentiles = false;
+    body = api::serializeHistoryStats(stats);
+    root = cJSON_Parse(body.c_str());
+    TEST_ASSERT_NOT_NULL(root);
+    TEST_ASSERT_TRUE(cJSON_IsNull(cJSON_GetObjectItem(root, "p50")));
+    // Moisture has one decimal: 40.25 rounds half away from zero.
+    TEST_ASSERT_EQUAL_DOUBLE(40.3, cJSON_GetObjectItem(root, "mean")->valuedouble);
+    cJSON_Delete(root);
+
+    // An empty window is a success with null numbers, keys still present.
+    stats.count = 0;
+    body = api::serializeHistoryStats(stats);
+    root = cJSON_Parse(body.c_str());
+    TEST_ASSERT_NOT_NULL(root);
+    TEST_ASSERT_EQUAL_DOUBLE(0.0, cJSON_GetObjectItem(root, "count")->valuedouble);
+    const char* keys[] = {"min", "max", "mean", "last", "lastTimestamp", "p5", "p50", "p95"};
+    for (const char* key : keys) {
+        TEST_ASSERT_TRUE_MESSAGE(cJSON_IsNull(cJSON_GetObjectItem(root, key)), key);
+    }
+    cJSON_Delete(root);
+}
+
 // --- events --------------------------------------------------------------
 
 void test_events_array_fields_and_order(void)
@@ -561,7 +841,169 @@ void test_events_array_fields_and_order(void)
         1751000000.0, cJSON_GetObjectItem(second, "epoch")->valuedouble);
     TEST_ASSERT_EQUAL_STRING(
         "wifi connected", cJSON_GetObjectItem(second, "detail")->valuestring);
+    // No further page: no cursor key.
+    TEST_ASSERT_NULL(cJSON_GetObjectItem(root, "next"));
+
+    cJSON_Delete(root);
+}
+
+void test_events_next_cursor_only_when_paged(void)
+{
+    std::vector<api::EventDto> events(1);
+    events[0].epoch = 1751000000;
+    events[0].category = 2;  // failsafe
+    events[0].detail = "dry-run trip";
+
+    std::string body = api::serializeEvents(events, std::string("1751000000.1"));
+    cJSON* root = cJSON_Parse(body.c_str());
+    TEST_ASSERT_NOT_NULL(root);
+    TEST_ASSERT_EQUAL_INT(1, cJSON_GetArraySize(cJSON_GetObjectItem(root, "events")));
+    TEST_ASSERT_EQUAL_STRING("1751000000.1",
+                             cJSON_GetObjectItem(root, "next")->valuestring);
+    cJSON_Delete(root);
+}
 
+// --- pump usage ----------------------------------------------------------
+
+void test_pump_usage_buckets_in_order(void)
+{
+    api::PumpUsageDto usage;
+    usage.name = "plant";
+    usage.timed = true;
+    usage.untimedRuns = 1;
+    usage.hours.push_back(api::PumpUsageBucketDto{1751000400, 0, 0});
+    usage.hours.push_back(api::PumpUsageBucketDto{1751004000, 30000, 2});
+    usage.days.push_back(api::PumpUsageBucketDto{1750982400, 30000, 2});
+
+    cJSON* root = cJSON_Parse(api::serializePumpUsage(usage).c_str());
+    TEST_ASSERT_NOT_NULL(root);
+    TEST_ASSERT_TRUE(cJSON_IsTrue(cJSON_GetObjectItem(root, "success")));
+    TEST_ASSERT_EQUAL_STRING("plant", cJSON_GetObjectItem(root, "name")->valuestring);
+    TEST_ASSERT_TRUE(cJSON_IsTrue(cJSON_GetObjectItem(root, "timed")));
+    TEST_ASSERT_EQUAL_DOUBLE(1.0, cJSON_GetObjectItem(root, "untimedRuns")->valuedouble);
+    cJSON* hours = cJSON_GetObjectItem(root, "hours");
+    TEST_ASSERT_EQUAL_INT(2, cJSON_GetArraySize(hours));
+    cJSON* last = cJSON_GetArrayItem(hours, 1);
+    TEST_ASSERT_EQUAL_DOUBLE(1751004000.0, cJSON_GetObjectItem(last, "start")->valuedouble);
+    TEST_ASSERT_EQUAL_DOUBLE(30000.0, cJSON_GetObjectItem(last, "runMs")->valuedouble);
+    TEST_ASSERT_EQUAL_DOUBLE(2.0, cJSON_GetObjectItem(last, "starts")->valuedouble);
+    TEST_ASSERT_EQUAL_INT(1, cJSON_GetArraySize(cJSON_GetObjectItem(root, "days")));
+    cJSON_Delete(root);
+
+    // Clock not set: both lists present and empty.
+    root = cJSON_Parse(api::serializePumpUsage(api::PumpUsageDto{"plant", false, 2, {}, {}}).c_str());
+    TEST_ASSERT_FALSE(cJSON_IsTrue(cJSON_GetObjectItem(root, "timed")));
+    TEST_ASSERT_TRUE(cJSON_IsArray(cJSON_GetObjectItem(root, "days")));
+    TEST_ASSERT_EQUAL_INT(0, cJSON_GetArraySize(cJSON_GetObjectItem(root, "days")));
+    cJSON_Delete(root);
+}
+
+// --- nodes ---------------------------------------------------------------
+
+void test_nodes_entry_fields_and_nested_sections(void)
+{
+    std::vector<api::NodeDto> nodes(1);
+    nodes[0].node = "102030405060";
+    nodes[0].lastSeenS = 12;
+    nodes[0].rssi = -63;
+    nodes[0].reports = 40;
+    nodes[0].duplicates = 2;
+    nodes[0].missed = 1;
+    nodes[0].sensors.soil.valid = true;
+    nodes[0].sensors.soil.moisture = 41.5f;
+    nodes[0].pumps.push_back(api::PumpDto{"plant", true, 1500, 90000, ""});
+
+    std::string body = api::serializeNodes(nodes);
+    cJSON* root = cJSON_Parse(body.c_str());
+    TEST_ASSERT_NOT_NULL(root);
+    TEST_ASSERT_TRUE(cJSON_IsTrue(cJSON_GetObjectItem(root, "success")));
+    cJSON* arr = cJSON_GetObjectItem(root, "nodes");
+    TEST_ASSERT_EQUAL_INT(1, cJSON_GetArraySize(arr));
+    cJSON* node = cJSON_GetArrayItem(arr, 0);
+    TEST_ASSERT_EQUAL_STRING("102030405060", cJSON_GetObjectItem(node, "node")->valuestring);
+    TEST_ASSERT_EQUAL_DOUBLE(-63.0, cJSON_GetObjectItem(node, "rssi")->valuedouble);
+    TEST_ASSERT_EQUAL_DOUBLE(2.0, cJSON_GetObjectItem(node, "duplicates")->valuedouble);
+    cJSON* soil = cJSON_GetObjectItem(cJSON_GetObjectItem(node, "sensors"), "soil");
+    TEST_ASSERT_TRUE(cJSON_IsTrue(cJSON_GetObjectItem(soil, "valid")));
+    cJSON* pump = cJSON_GetArrayItem(cJSON_GetObjectItem(node, "pumps"), 0);
+    TEST_ASSERT_EQUAL_STRING("plant", cJSON_GetObjectItem(pump, "name")->valuestring);
+    cJSON_Delete(root);
+
+    // A node that is no gateway answers an empty list, not a missing key.
+    root = cJSON_Parse(api::serializeNodes({}).c_str());
+    TEST_ASSERT_TRUE(cJSON_IsArray(cJSON_GetObjectItem(root, "nodes")));
+    TEST_ASSERT_EQUAL_INT(0, cJSON_GetArraySize(cJSON_GetObjectItem(root, "nodes")));
+    cJSON_Delete(root);
+}
+
+// --- events summary ------------------------------------------------------
+
+void test_event_summary_counts_with_names(void)
+{
+    api::EventSummaryDto summary;
+    summary.hours = 24;
+    summary.since = 1609376400;
+    summary.categories.push_back({1, std::string("pump"), 12});
+    summary.categories.push_back({7, std::nullopt, 2});
+
+    cJSON* root = cJSON_Parse(api::serializeEventSummary(summary).c_str());
+    TEST_ASSERT_NOT_NULL(root);
+    TEST_ASSERT_TRUE(cJSON_IsTrue(cJSON_GetObjectItem(root, "success")));
+    TEST_ASSERT_EQUAL_DOUBLE(24.0, cJSON_GetObjectItem(root, "hours")->valuedouble);
+    TEST_ASSERT_EQUAL_DOUBLE(1609376400.0, cJSON_GetObjectItem(root, "since")->valuedouble);
+    cJSON* cats = cJSON_GetObjectItem(root, "categories");
+    TEST_ASSERT_EQUAL_INT(2, cJSON_GetArraySize(cats));
+    cJSON* pump = cJSON_GetArrayItem(cats, 0);
+    TEST_ASSERT_EQUAL_DOUBLE(1.0, cJSON_GetObjectItem(pump, "category")->valuedouble);
+    TEST_ASSERT_EQUAL_STRING("pump", cJSON_GetObjectItem(pump, "categoryName")->valuestring);
+    TEST_ASSERT_EQUAL_DOUBLE(12.0, cJSON_GetObjectItem(pump, "count")->valuedouble);
+    cJSON* unknown = cJSON_GetArrayItem(cats, 1);
+    TEST_ASSERT_NULL(cJSON_GetObjectItem(unknown, "categoryName"));
+    TEST_ASSERT_EQUAL_DOUBLE(2.0, cJSON_GetObjectItem(unknown, "count")->valuedouble);
+    cJSON_Delete(root);
+}
+
+// --- logs ----------------------------------------------------------------
+
+void test_logs_lines_in_order_with_drops(void)
+{
+    api::LogsDto logs;
+    logs.dropped = 3;
+    logs.lines = {"I (10) boot: one", "W (20) wifi: \"two\""};
+
+    cJSON* root = cJSON_Parse(api::serializeLogs(logs).c_str());
+    TEST_ASSERT_NOT_NULL(root);
+    TEST_ASSERT_TRUE(cJSON_IsTrue(cJSON_GetObjectItem(root, "success")));
+    TEST_ASSERT_EQUAL_DOUBLE(3.0, cJSON_GetObjectItem(root, "dropped")->valuedouble);
+    cJSON* lines = cJSON_GetObjectItem(root, "lines");
+    TEST_ASSERT_EQUAL_INT(2, cJSON_GetArraySize(lines));
+    TEST_ASSERT_EQUAL_STRING("I (10) boot: one", cJSON_GetArrayItem(lines, 0)->valuestring);
+    TEST_ASSERT_EQUAL_STRING("W (20) wifi: \"two\"", cJSON_GetArrayItem(lines, 1)->valuestring);
+    cJSON_Delete(root);
+}
+
+void test_ota_report_fields(void)
+{
+    api::OtaReport report;
+    report.bytes = 1572864;
+    report.transferBytes = 41210;
+    report.delta = true;
+    report.elapsedMs = 1830;
+    report.sha256.fill(0xab);
+
+    cJSON* root = cJSON_Parse(api::serializeOtaReport(report).c_str());
+    TEST_ASSERT_NOT_NULL(root);
+    TEST_ASSERT_TRUE(cJSON_IsTrue(cJSON_GetObjectItem(root, "success")));
+    TEST_ASSERT_EQUAL_DOUBLE(1572864.0, cJSON_GetObjectItem(root, "bytes")->valuedouble);
+    TEST_ASSERT_EQUAL_DOUBLE(41210.0, cJSON_GetObjectItem(root, "transferBytes")->valuedouble);
+    TEST_ASSERT_TRUE(cJSON_IsTrue(cJSON_GetObjectItem(root, "delta")));
+    TEST_ASSERT_EQUAL_DOUBLE(1830.0, cJSON_GetObjectItem(root, "elapsedMs")->valuedouble);
+    std::string hex;
+    for (int i = 0; i < 32; ++i) {
+        hex += "ab";
+    }
+    TEST_ASSERT_EQUAL_STRING(hex.c_str(), cJSON_GetObjectItem(root, "sha256")->valuestring);
+    TEST_ASSERT_TRUE(cJSON_IsTrue(cJSON_GetObjectItem(root, "rebooting")));
     cJSON_Delete(root);
 }
 
@@ -670,12 +1112,21 @@ void test_status_line_mapping(void)
 {
     // The enum -> HTTP status line map is total and cannot drift from the enum.
     TEST_ASSERT_EQUAL_STRING("200 OK", api::statusLine(api::ApiStatus::Ok));
+    TEST_ASSERT_EQUAL_STRING(
+        "206 Partial Content", api::statusLine(api::ApiStatus::PartialContent));
+    TEST_ASSERT_EQUAL_STRING(
+        "304 Not Modified", api::statusLine(api::ApiStatus::NotModified));
     TEST_ASSERT_EQUAL_STRING(
         "400 Bad Request", api::statusLine(api::ApiStatus::BadRequest));
     TEST_ASSERT_EQUAL_STRING(
         "404 Not Found", api::statusLine(api::ApiStatus::NotFound));
     TEST_ASSERT_EQUAL_STRING(
         "409 Conflict", api::statusLine(api::ApiStatus::Conflict));
+    TEST_ASSERT_EQUAL_STRING(
+        "416 Range Not Satisfiable",
+        api::statusLine(api::ApiStatus::RangeNotSatisfiable));
+    TEST_ASSERT_EQUAL_STRING(
+        "429 Too Many Requests", api::statusLine(api::ApiStatus::TooManyRequests));
     TEST_ASSERT_EQUAL_STRING(
         "500 Internal Server Error",
         api::statusLine(api::ApiStatus::InternalError));
@@ -683,6 +1134,316 @@ void test_status_line_mapping(void)
         "501 Not Implemented", api::statusLine(api::ApiStatus::NotImplemented));
 }
 
+// --- fixed-buffer backend (api/JsonTemplate.h) ---------------------------
+
+/// Room for every body below; the overflow test uses less.
+void test_readings_go_out_with_their_decimals(void)
+{
+    api::SensorReadingsDto d;
+    d.environmental.temperature = 23.4f;     // 23.399999618530273 as a double
+    d.environmental.pressure = 1013.256f;
+    d.soil.moisture = 41.26f;
+    d.soil.ph = 6.789f;
+    d.soil.ec = 1234.4f;
+    d.hasPower = true;
+    d.power = {true, 12.3456f, -0.0004f, 4.2f};
+    const std::string body = api::serializeSensors(d);
+    TEST_ASSERT_NOT_EQUAL(std::string::npos, body.find("\"temperature\":23.4,"));
+    TEST_ASSERT_NOT_EQUAL(std::string::npos, body.find("\"pressure\":1013.26}"));
+    TEST_ASSERT_NOT_EQUAL(std::string::npos, body.find("\"moisture\":41.3,"));
+    TEST_ASSERT_NOT_EQUAL(std::string::npos, body.find("\"ph\":6.79,"));
+    TEST_ASSERT_NOT_EQUAL(std::string::npos, body.find("\"ec\":1234"));
+    TEST_ASSERT_NOT_EQUAL(std::string::npos,
+                          body.find("\"busVoltage\":12.346,\"current\":0,\"power\":4.2}"));
+
+    // History: by the metric's decimals; a metric outside the known table
+    // keeps cJSON's full form.
+    api::HistorySeries series;
+    series.metric = "env_temperature";
+    series.timestamps = {1751000000};
+    series.values = {23.4f};
+    TEST_ASSERT_NOT_EQUAL(std::string::npos,
+                          api::serializeHistory(series).find("\"values\":[23.4]"));
+    series.metric = "bench_metric";
+    TEST_ASSERT_NOT_EQUAL(std::string::npos,
+                          api::serializeHistory(series).find("[23.399999618530273]"));
+    TEST_ASSERT_EQUAL_INT(1, api::metricDecimals("soil_moisture_7"));
+    TEST_ASSERT_EQUAL_INT(api::decimals::kShortest, api::metricDecimals("bench_metric"));
+}
+
+void test_fixed_decimals_match_cjson_of_rounded_value(void)
+{
+    // formatJsonFixed() prints without printf what cJSON prints of the
+    // rounded value, including the cases it hands back to cJSON's rules.
+    const double values[] = {23.4f, -0.04, 0.05, 12.0f, 1e-7, -3.5, 999.96,
+                             1234.5678, 5e9, 1e20, -1e-5, 0.0};
+    for (double v : values) {
+        for (int places = -1; places <= api::kMaxJsonDecimals + 1; ++places) {
+            char fast[api::kJsonNumberChars];
+            char reference[api::kJsonNumberChars];
+            const std::size_t n = api::formatJsonFixed(v, places, fast);
+            api::formatJsonNumber(api::roundJsonDecimals(v, places), reference);
+            TEST_ASSERT_EQUAL_STRING(reference, fast);
+            TEST_ASSERT_EQUAL_size_t(std::strlen(fast), n);
+
+            cJSON* number = cJSON_CreateNumber(api::roundJsonDecimals(v, places));
+            char* printed = cJSON_PrintUnformatted(number);
+            TEST_ASSERT_EQUAL_STRING(printed, fast);
+            cJSON_free(printed);
+            cJSON_Delete(number);
+        }
+    }
+    char text[api::kJsonNumberChars];
+    api::formatJsonFixed(std::nan(""), 2, text);
+    TEST_ASSERT_EQUAL_STRING("null", text);
+    api::formatJsonFixed(-0.0004, 3, text);
+    TEST_ASSERT_EQUAL_STRING("0", text);
+    api::formatJsonFixed(0.05, 2, text);
+    TEST_ASSERT_EQUAL_STRING("0.05", text);
+}
+
+constexpr std::size_t kFixedBytes = 2048;
+
+/// The template body of @p dto equals the cJSON one, byte for byte.
+template <typename Dto>
+void assertFixedMatches(const Dto& dto, std::size_t (*into)(const Dto&, char*, std::size_t),
+                        std::string (*reference)(const Dto&))
+{
+    char buf[kFixedBytes];
+    const std::size_t n = into(dto, buf, sizeof(buf));
+    TEST_ASSERT_TRUE(n > 0);
+    TEST_ASSERT_EQUAL_STRING(reference(dto).c_str(), std::string(buf, n).c_str());
+}
+
+void test_fixed_status_matches_cjson(void)
+{
+    api::SystemStatusDto s = makeStatus();
+    assertFixedMatches(s, &api::serializeStatusInto, &api::serializeStatus);
+
+    // rev1, clock not set, no boot profile, a non-finite percentage, and
+    // strings that need every escape cJSON knows.
+    s.hasPower = false;
+    s.time.synced = false;
+    s.time.local.clear();
+    s.boot.clear();
+    s.storage.percentUsed = std::nanf("");
+    s.wifi.ssid = "tab\there \"quoted\" back\\slash\n\x01\x1f";
+    s.uptimeMs = 9'000'000'000ULL;
+    s.wifi.rssi = -100;
+    assertFixedMatches(s, &api::serializeStatusInto, &api::serializeStatus);
+}
+
+void test_fixed_sensors_matches_cjson(void)
+{
+    api::SensorReadingsDto d;
+    assertFixedMatches(d, &api::serializeSensorsInto, &api::serializeSensors);
+
+    d.environmental.valid = true;
+    d.environmental.temperature = 21.3f;
+    d.environmental.humidity = 48.7f;
+    d.environmental.pressure = 1013.25f;
+    d.soil.valid = true;
+    d.soil.moisture = 41.5f;
+    d.soil.temperature = std::numeric_limits<float>::infinity();
+    d.soil.ph = 6.8f;
+    d.soil.ec = 1234.0f;
+    d.soil.hasNitrogen = true;
+    d.soil.nitrogen = 12.0f;
+    d.soil.hasPotassium = true;
+    d.soil.potassium = std::nanf("");
+    api::SoilProbeDto second;
+    second.address = 9;
+    second.soil.hasPhosphorus = true;
+    second.soil.phosphorus = 0.1f;
+    d.soilProbes = {api::SoilProbeDto{1, d.soil}, second};
+    d.soilBus.periodMs = 5000;
+    d.soilBus.readAirtimeUs = 39583;
+    d.soilBus.budgetPermille = 15;
+    d.soilBus.measuredPermille = 21;
+    d.level.low = {true, true};
+    d.level.high = {true, false};
+    d.hasPower = true;
+    d.power = {true, 12.1f, -0.35f, 4.235f};
+    d.hasTimestamp = true;
+    d.timestamp = 1751000000;
+    assertFixedMatches(d, &api::serializeSensorsInto, &api::serializeSensors);
+}
+
+void test_fixed_power_and_pumps_match_cjson(void)
+{
+    api::PowerDto power{true, 12.1f, 0.35f, 4.235f};
+    assertFixedMatches(power, &api::serializePowerInto, &api::serializePower);
+    power = {false, std::nanf(""), -std::numeric_limits<float>::infinity(), 0.0f};
+    assertFixedMatches(power, &api::serializePowerInto, &api::serializePower);
+    power = {true, 12.1f, 0.35f, 4.235f};
+    power.hasEnergy = true;
+    power.energy.totalWh = 1234.56789;
+    power.energy.dayWh = 0.00004;
+    power.energy.dayStart = 1751673600;
+    power.energy.runActive = true;
+    power.energy.runWh = 0.0417;
+    power.energy.runMs = 35200;
+    power.energy.lastRunStart = 1751700000;
+    power.energy.runs = 12;
+    power.energy.uncoveredMs = 5'000'000'000ULL;  // past UINT32_MAX
+    assertFixedMatches(power, &api::serializePowerInto, &api::serializePower);
+
+    api::PumpDto pump;
+    pump.name = "plant";
+    pump.running = true;
+    pump.currentRunTimeMs = 4200;
+    pump.accumulatedRunTimeMs = 3'000'000'000U;  // past INT_MAX
+    pump.lastStopReason = "timeout";
+    assertFixedMatches(pump, &api::serializePumpInto, &api::serializePump);
+
+    std::vector<api::PumpDto> pumps;
+    assertFixedMatches(pumps, &api::serializePumpListInto, &api::serializePumpList);
+    pumps.push_back(pump);
+    pump.name = "reservoir";
+    pump.running = false;
+    pumps.push_back(pump);
+    assertFixedMatches(pumps, &api::serializePumpListInto, &api::serializePumpList);
+}
+
+void test_field_projection_leaves_members_out(void)
+{
+    // Both backends drop the unselected members alike.
+    api::SystemStatusDto s = makeStatus();
+    s.fields = api::kStatusWifi | api::kStatusMode | api::kStatusBoot;
+    assertFixedMatches(s, &api::serializeStatusInto, &api::serializeStatus);
+    s.fields = api::kStatusPower;
+    assertFixedMatches(s, &api::serializeStatusInto, &api::serializeStatus);
+
+    api::SensorReadingsDto d;
+    d.soil.valid = true;
+    d.soil.moisture = 41.5f;
+    d.soilProbes = {api::SoilProbeDto{1, d.soil}, api::SoilProbeDto{9, d.soil}};
+    d.fields = api::kSensorsSoil | api::kSensorsTimestamp;
+    assertFixedMatches(d, &api::serializeSensorsInto, &api::serializeSensors);
+    TEST_ASSERT_EQUAL_STRING(
+        "{\"success\":true,\"soil\":{\"moisture\":41.5},\"timestamp\":null}",
+        api::serializeSensors(d, {{"soil", "moisture"}}).c_str());
+
+    // Keys apply inside every element of an array member; an unknown key
+    // leaves the member empty.
+    d.fields = api::kSensorsSoilProbes;
+    TEST_ASSERT_EQUAL_STRING(
+        "{\"success\":true,\"soilProbes\":[{\"address\":1},{\"address\":9}],"
+        "\"soilBus\":{}}",
+        api::serializeSensors(d, {{"soilProbes", "address"}, {"soilBus", "nope"}}).c_str());
+
+    s.fields = api::kStatusWifi | api::kStatusPower;
+    s.hasPower = false;
+    TEST_ASSERT_EQUAL_STRING("{\"success\":true,\"wifi\":{\"rssi\":-57},\"power\":null}",
+                             api::serializeStatus(s, {{"wifi", "rssi"}, {"power", "valid"}})
+                                 .c_str());
+}
+
+void test_fixed_body_overflow_reports_zero(void)
+{
+    const api::SystemStatusDto s = makeStatus();
+    char buf[kFixedBytes];
+    const std::size_t n = api::serializeStatusInto(s, buf, sizeof(buf));
+    TEST_ASSERT_TRUE(n > 0);
+    TEST_ASSERT_EQUAL_size_t(n, api::serializeStatusInto(s, buf, n));
+    TEST_ASSERT_EQUAL_size_t(0, api::serializeStatusInto(s, buf, n - 1));
+    TEST_ASSERT_EQUAL_size_t(0, api::serializePowerInto(api::PowerDto{}, buf, 8));
+}
+
+// --- Heap allocations (alloc_tracker.h) -----------------------------------
+// The DOM serializers pay a fixed number of cJSON blocks per element; the
+// print buffer doubles, so twice the elements add at most a few growth
+// steps on top. Anything per element beyond that (a temporary string, a
+// copy) fails here before it fragments the heap on target.
+
+api::HistorySeries rawSeries(std::size_t points)
+{
+    api::HistorySeries series;
+    series.metric = "soil_moisture";
+    series.start = 1751000000;
+    series.end = series.start + static_cast<int64_t>(points) * 300;
+    for (std::size_t i = 0; i < points; ++i) {
+        series.timestamps.push_back(series.start + static_cast<int64_t>(i) * 300);
+        series.values.push_back(40.0f + static_cast<float>(i % 7));
+    }
+    return series;
+}
+
+std::vector<api::EventDto> eventList(std::size_t count)
+{
+    std::vector<api::EventDto> events(count);
+    for (std::size_t i = 0; i < count; ++i) {
+        events[i].epoch = 1751000000 - static_cast<int64_t>(i) * 60;
+        events[i].category = 1;
+        events[i].detail = "plant start 20s";
+    }
+    return events;
+}
+
+/// Allocations one call of @p serialize makes (its inputs built before).
+template <typename Serialize>
+std::size_t allocationsOf(Serialize&& serialize)
+{
+    AllocScope scope;
+    serialize();
+    return scope.stop().allocations;
+}
+
+constexpr std::size_t kPrintGrowthSlack = 8;
+
+void test_history_body_allocates_per_point_only(void)
+{
+    // Two numbers per raw point (timestamp, value).
+    const api::HistorySeries day = rawSeries(288);
+    const api::HistorySeries twoDays = rawSeries(576);
+    const std::size_t one = allocationsOf([&] { api::serializeHistory(day); });
+    const std::size_t two = allocationsOf([&] { api::serializeHistory(twoDays); });
+    TEST_ASSERT_TRUE(two > one);
+    TEST_ASSERT_TRUE(two - one <= 2 * 288 + kPrintGrowthSlack);
+
+    // And the envelope around them stays small.
+    EXPECT_ALLOCS_AT_MOST(2 * 288 + 64) { api::serializeHistory(day); }
+}
+
+void test_events_body_allocates_per_event_only(void)
+{
+    // Per event: the object, then two numbers and one string with their keys.
+    const std::vector<api::EventDto> page = eventList(50);
+    const std::vector<api::EventDto> twoPages = eventList(100);
+    const std::size_t one = allocationsOf([&] { api::serializeEvents(page); });
+    const std::size_t two = allocationsOf([&] { api::serializeEvents(twoPages); });
+    TEST_ASSERT_TRUE(two > one);
+    TEST_ASSERT_TRUE(two - one <= 8 * 50 + kPrintGrowthSlack);
+}
+
+void test_streamed_history_body_does_not_allocate(void)
+{
+    // The same body as serializeHistory(), written through a fixed buffer.
+    struct CountingSink final : api::IChunkSink {
+        std::size_t bytes = 0;
+        bool send(const char*, std::size_t len) override
+        {
+            bytes += len;
+            return true;
+        }
+    };
+    const api::HistorySeries day = rawSeries(288);
+    CountingSink sink;
+    bool ok = false;
+    EXPECT_NO_ALLOC { ok = api::streamHistory(day, sink); }
+    TEST_ASSERT_TRUE(ok);
+    TEST_ASSERT_EQUAL_size_t(api::serializeHistory(day).size(), sink.bytes);
+}
+
+void test_fixed_body_does_not_allocate(void)
+{
+    const api::SystemStatusDto status = makeStatus();
+    char buf[kFixedBytes];
+    std::size_t n = 0;
+    EXPECT_NO_ALLOC { n = api::serializeStatusInto(status, buf, sizeof(buf)); }
+    TEST_ASSERT_EQUAL_size_t(api::serializeStatus(status).size(), n);
+}
+
 }  // namespace
 
 void run_api_serialize_tests(void)
@@ -694,19 +1455,41 @@ void run_api_serialize_tests(void)
     RUN_TEST(test_sensors_valid_readings);
     RUN_TEST(test_sensors_invalid_soil_section_still_emitted_with_null);
     RUN_TEST(test_sensors_npk_present_only_when_flagged);
+    RUN_TEST(test_sensors_soil_probes_only_on_multi_drop);
     RUN_TEST(test_sensors_rev1_power_null_and_not_set_timestamp);
     RUN_TEST(test_power_rev2_fields_spread);
     RUN_TEST(test_power_non_finite_last_good_is_null);
+    RUN_TEST(test_power_energy_only_when_wired);
     RUN_TEST(test_power_unavailable_shape);
     RUN_TEST(test_pump_serialize_fields);
     RUN_TEST(test_pump_list_serialize_array);
+    RUN_TEST(test_snapshot_sections_match_their_endpoints);
     RUN_TEST(test_config_serialize_all_fields_no_password);
     RUN_TEST(test_history_aligned_series_and_echo);
     RUN_TEST(test_history_empty_series_empty_arrays);
+    RUN_TEST(test_history_bucketed_series_adds_extremes);
+    RUN_TEST(test_history_stats_numbers_and_empty_window);
     RUN_TEST(test_events_array_fields_and_order);
+    RUN_TEST(test_events_next_cursor_only_when_paged);
+    RUN_TEST(test_pump_usage_buckets_in_order);
+    RUN_TEST(test_nodes_entry_fields_and_nested_sections);
+    RUN_TEST(test_event_summary_counts_with_names);
+    RUN_TEST(test_logs_lines_in_order_with_drops);
+    RUN_TEST(test_ota_report_fields);
     RUN_TEST(test_selftest_overall_and_checks);
     RUN_TEST(test_named_range_to_window);
     RUN_TEST(test_error_body_shape);
     RUN_TEST(test_not_found_body_shape);
     RUN_TEST(test_status_line_mapping);
+    RUN_TEST(test_readings_go_out_with_their_decimals);
+    RUN_TEST(test_fixed_decimals_match_cjson_of_rounded_value);
+    RUN_TEST(test_fixed_status_matches_cjson);
+    RUN_TEST(test_fixed_sensors_matches_cjson);
+    RUN_TEST(test_fixed_power_and_pumps_match_cjson);
+    RUN_TEST(test_field_projection_leaves_members_out);
+    RUN_TEST(test_fixed_body_overflow_reports_zero);
+    RUN_TEST(test_history_body_allocates_per_point_only);
+    RUN_TEST(test_events_body_allocates_per_event_only);
+    RUN_TEST(test_streamed_history_body_does_not_allocate);
+    RUN_TEST(test_fixed_body_does_not_allocate);
 }
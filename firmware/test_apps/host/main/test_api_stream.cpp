@@ -0,0 +1,594 @@
+// SPDX-FileCopyrightText: 2026 Cryptotomte
+// SPDX-License-Identifier: AGPL-3.0-or-later
+/**
+ * @file test_api_stream.cpp
+ * @brief Host suite for the streaming history body writer (ApiStream.h).
+ *
+ * The streamed bytes are compared with serializeHistory() of the same
+ * series — the cJSON path stays the reference for the wire format — for a
+ * collected series and for the two-pass raw stream over MockDataStorage,
+ * step fill on and off. Also: the body leaves in several buffer-sized
+ * chunks, a failed send stops production, and readings evicted between the
+ * two raw passes fail the stream instead of misaligning the arrays. The
+ * binary format is decoded back and checked against the same points, and
+ * a /history/sync body carries only readings past its marks, resuming
+ * from its token after a cut. A Range header resolves to one byte range
+ * or to the whole body, and RangeSink passes exactly that range of a
+ * streamed body.
+ */
+
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "unity.h"
+
+#include "api/ApiDtos.h"
+#include "api/ApiRequests.h"
+#include "api/ApiSerialize.h"
+#include "api/ApiStream.h"
+#include "storage/testing/MockDataStorage.h"
+
+namespace {
+
+/// Collects the chunks; fails every send from @p failFrom on.
+struct StringSink final : api::IChunkSink {
+    std::string body;
+    int sends = 0;
+    int failFrom = -1;
+    std::size_t largest = 0;
+
+    bool send(const char* data, std::size_t len) override
+    {
+        if (failFrom >= 0 && sends >= failFrom) {
+            return false;
+        }
+        ++sends;
+        largest = len > largest ? len : largest;
+        body.append(data, len);
+        return true;
+    }
+};
+
+/// MockDataStorage whose forEachReading() evicts the oldest reading of the
+/// metric before its second call (ring eviction between the two passes).
+struct EvictingStorage : MockDataStorage {
+    mutable int passes = 0;
+
+    std::size_t forEachReading(const std::string& metric, uint32_t t0,
+                               uint32_t t1,
+                               IReadingVisitor& visitor) const override
+    {
+        if (passes++ == 1) {
+            auto& readings = const_cast<EvictingStorage*>(this)->history[metric];
+            readings.erase(readings.begin());
+        }
+        return MockDataStorage::forEachReading(metric, t0, t1, visitor);
+    }
+};
+
+api::HistorySeries echoOf(const char* metric, int64_t start, int64_t end)
+{
+    api::HistorySeries s;
+    s.metric = metric;
+    s.start = start;
+    s.end = end;
+    return s;
+}
+
+/// The collected-then-filled series the raw stream must reproduce.
+api::HistorySeries collect(const MockDataStorage& storage,
+                           const api::HistorySeries& echo,
+                           uint32_t logIntervalS, uint32_t heartbeatS)
+{
+    api::HistorySeries s = echo;
+    for (const SensorReading& r : storage.getSensorReadings(
+             echo.metric, static_cast<uint32_t>(echo.start),
+             static_cast<uint32_t>(echo.end))) {
+        s.timestamps.push_back(r.epoch);
+        s.values.push_back(r.value);
+    }
+    api::stepFillHistory(s, logIntervalS, heartbeatS);
+    return s;
+}
+
+/// Little-endian u32 / f32 at @p offset of a binary body.
+uint32_t u32At(const std::string& body, std::size_t offset)
+{
+    const auto* b = reinterpret_cast<const unsigned char*>(body.data() + offset);
+    return static_cast<uint32_t>(b[0]) | (static_cast<uint32_t>(b[1]) << 8) |
+           (static_cast<uint32_t>(b[2]) << 16) | (static_cast<uint32_t>(b[3]) << 24);
+}
+
+float f32At(const std::string& body, std::size_t offset)
+{
+    const uint32_t bits = u32At(body, offset);
+    float value = 0.0f;
+    std::memcpy(&value, &bits, sizeof(value));
+    return value;
+}
+
+/// A /history/sync body decoded back (format in ApiStream.h).
+struct SyncBody {
+    uint32_t now = 0;
+    std::vector<SensorReading> readings;  ///< body order
+    std::size_t blocks = 0;
+    bool more = false;
+    std::string token;
+};
+
+bool decodeSync(const std::string& body, SyncBody& out)
+{
+    if (body.size() < 8 || body.compare(0, 4, api::kHistorySyncMagic, 4) != 0) {
+        return false;
+    }
+    out.now = u32At(body, 4);
+    std::size_t at = 8;
+    for (;;) {
+        if (at >= body.size()) {
+            return false;
+        }
+        const std::size_t nameLen = static_cast<unsigned char>(body[at++]);
+        if (nameLen == 0) {
+            break;
+        }
+        const std::string name = body.substr(at, nameLen);
+        at += nameLen;
+        const std::size_t count = static_cast<unsigned char>(body[at]) |
+                                  static_cast<unsigned char>(body[at + 1]) << 8;
+        at += 2;
+        for (std::size_t i = 0; i < count; ++i, at += 8) {
+            out.readings.push_back(SensorReading{name, u32At(body, at), f32At(body, at + 4)});
+        }
+        ++out.blocks;
+    }
+    out.more = body[at++] != 0;
+    const std::size_t tokenLen = static_cast<unsigned char>(body[at]) |
+                                 static_cast<unsigned char>(body[at + 1]) << 8;
+    at += 2;
+    out.token = body.substr(at, tokenLen);
+    return at + tokenLen == body.size();
+}
+
+/// MockDataStorage that records the t0 of every forEachReading() call.
+struct SeekRecordingStorage : MockDataStorage {
+    mutable std::vector<std::pair<std::string, uint32_t>> walks;
+
+    std::size_t forEachReading(const std::string& metric, uint32_t t0,
+                               uint32_t t1,
+                               IReadingVisitor& visitor) const override
+    {
+        walks.emplace_back(metric, t0);
+        return MockDataStorage::forEachReading(metric, t0, t1, visitor);
+    }
+};
+
+// --- tests ---------------------------------------------------------------
+
+void test_stream_matches_serialize_for_collected_series(void)
+{
+    api::HistorySeries raw = echoOf("env_temperature", 1751000000, 1751090000);
+    raw.reading = std::string("temp\"\n");  // escapes as cJSON does
+    for (int i = 0; i < 300; ++i) {
+        raw.timestamps.push_back(1751000000 + i * 300);
+        raw.values.push_back(i == 7 ? NAN : 20.1f + static_cast<float>(i) * 0.37f);
+    }
+    StringSink sink;
+    TEST_ASSERT_TRUE(api::streamHistory(raw, sink));
+    TEST_ASSERT_EQUAL_STRING(api::serializeHistory(raw).c_str(), sink.body.c_str());
+    // Fixed buffer: several chunks, none larger than it.
+    TEST_ASSERT_TRUE(sink.sends > 1);
+    TEST_ASSERT_TRUE(sink.largest <= api::JsonStreamWriter::kBufferBytes);
+
+    api::HistorySeries bucketed = echoOf("soil_moisture", 1750000000, 1751000000);
+    bucketed.bucketS = 3600;
+    bucketed.timestamps = {1750000000, 1750003600};
+    bucketed.values = {41.25f, -3.5f};
+    bucketed.mins = {40.0f, -4.0f};
+    bucketed.maxs = {42.5f, 1e-7f};
+    bucketed.filled = 1;
+    StringSink bucketSink;
+    TEST_ASSERT_TRUE(api::streamHistory(bucketed, bucketSink));
+    TEST_ASSERT_EQUAL_STRING(api::serializeHistory(bucketed).c_str(),
+                             bucketSink.body.c_str());
+
+    const api::HistorySeries empty = echoOf("soil_ph", 0, 86400);
+    StringSink emptySink;
+    TEST_ASSERT_TRUE(api::streamHistory(empty, emptySink));
+    TEST_ASSERT_EQUAL_STRING(api::serializeHistory(empty).c_str(),
+                             emptySink.body.c_str());
+}
+
+void test_raw_stream_matches_collected_and_filled_series(void)
+{
+    MockDataStorage storage;
+    // 60 s cadence with a change-only gap (held) and an outage (not held).
+    const uint32_t epochs[] = {1000, 1060, 1120, 1600, 1660, 9000, 9060};
+    for (uint32_t e : epochs) {
+        TEST_ASSERT_TRUE(storage.storeSensorReading("soil_ec", e, e * 0.013f));
+    }
+    TEST_ASSERT_TRUE(storage.storeSensorReading("soil_ph", 1030, 6.5f));
+
+    for (uint32_t heartbeatS : {0u, 900u}) {
+        const api::HistorySeries echo = echoOf("soil_ec", 1000, 9000);
+        StringSink sink;
+        TEST_ASSERT_TRUE(api::streamRawHistory(storage, echo, 60, heartbeatS, sink));
+        const api::HistorySeries expected = collect(storage, echo, 60, heartbeatS);
+        TEST_ASSERT_EQUAL_STRING(api::serializeHistory(expected).c_str(),
+                                 sink.body.c_str());
+        TEST_ASSERT_EQUAL_UINT32(heartbeatS == 0 ? 0 : 1, expected.filled);
+    }
+
+    // No readings in the window: empty arrays, one pass.
+    const api::HistorySeries none = echoOf("soil_ec", 20000, 30000);
+    StringSink sink;
+    TEST_ASSERT_TRUE(api::streamRawHistory(storage, none, 60, 900, sink));
+    TEST_ASSERT_EQUAL_STRING(api::serializeHistory(none).c_str(), sink.body.c_str());
+}
+
+void test_member_bodies_drop_only_the_success_key(void)
+{
+    // A multi-metric body's series[] elements: the single-metric object
+    // without `"success":true,`, for the collected and the raw stream alike.
+    MockDataStorage storage;
+    for (uint32_t e = 1000; e < 1300; e += 60) {
+        TEST_ASSERT_TRUE(storage.storeSensorReading("env_humidity", e, e * 0.01f));
+    }
+    const api::HistorySeries echo = echoOf("env_humidity", 1000, 2000);
+    const std::string whole = api::serializeHistory(collect(storage, echo, 60, 0));
+    const std::string prefix = "{\"success\":true,";
+    TEST_ASSERT_EQUAL_INT(0, static_cast<int>(whole.find(prefix)));
+    const std::string expected = "{" + whole.substr(prefix.size());
+
+    StringSink raw;
+    TEST_ASSERT_TRUE(api::streamRawHistory(storage, echo, 60, 0, raw,
+                                           api::HistoryFormat::Json, true));
+    TEST_ASSERT_EQUAL_STRING(expected.c_str(), raw.body.c_str());
+    StringSink collected;
+    TEST_ASSERT_TRUE(api::streamHistory(collect(storage, echo, 60, 0), collected,
+                                        api::HistoryFormat::Json, true));
+    TEST_ASSERT_EQUAL_STRING(expected.c_str(), collected.body.c_str());
+}
+
+void test_stream_stops_on_failed_send(void)
+{
+    MockDataStorage storage;
+    for (uint32_t i = 0; i < 400; ++i) {
+        TEST_ASSERT_TRUE(storage.storeSensorReading("env_humidity", 5000 + i * 60, 55.5f));
+    }
+    StringSink sink;
+    sink.failFrom = 1;  // the client goes away after the first chunk
+    TEST_ASSERT_FALSE(api::streamRawHistory(
+        storage, echoOf("env_humidity", 0, 100000), 60, 0, sink));
+    TEST_ASSERT_EQUAL(1, sink.sends);
+    TEST_ASSERT_EQUAL_UINT32(api::JsonStreamWriter::kBufferBytes, sink.body.size());
+}
+
+void test_raw_stream_fails_when_readings_change_between_passes(void)
+{
+    EvictingStorage storage;
+    for (uint32_t i = 0; i < 5; ++i) {
+        TEST_ASSERT_TRUE(storage.storeSensorReading("env_pressure", 100 + i * 60, 1013.0f));
+    }
+    StringSink sink;
+    TEST_ASSERT_FALSE(api::streamRawHistory(
+        storage, echoOf("env_pressure", 0, 1000), 60, 0, sink));
+    TEST_ASSERT_EQUAL(2, storage.passes);
+}
+
+void test_binary_body_packs_little_endian_records(void)
+{
+    MockDataStorage storage;
+    const uint32_t epochs[] = {1000, 1060, 1300};  // 1060 -> 1300 is held
+    for (uint32_t e : epochs) {
+        TEST_ASSERT_TRUE(storage.storeSensorReading("soil_moisture", e, e / 40.0f));
+    }
+    const api::HistorySeries echo = echoOf("soil_moisture", 0, 5000);
+    StringSink sink;
+    TEST_ASSERT_TRUE(api::streamRawHistory(storage, echo, 60, 600, sink,
+                                           api::HistoryFormat::Binary));
+    const api::HistorySeries expected = collect(storage, echo, 60, 600);
+    TEST_ASSERT_EQUAL_UINT32(4, expected.timestamps.size());
+    TEST_ASSERT_EQUAL_UINT32(8 + 8 * expected.timestamps.size(), sink.body.size());
+    TEST_ASSERT_EQUAL_MEMORY("WSH1", sink.body.data(), 4);
+    TEST_ASSERT_EQUAL_UINT32(0, u32At(sink.body, 4));
+    for (std::size_t i = 0; i < expected.timestamps.size(); ++i) {
+        TEST_ASSERT_EQUAL_UINT32(expected.timestamps[i], u32At(sink.body, 8 + 8 * i));
+        TEST_ASSERT_EQUAL_FLOAT(expected.values[i], f32At(sink.body, 12 + 8 * i));
+    }
+    TEST_ASSERT_EQUAL_HEX8(0xE8, static_cast<unsigned char>(sink.body[8]));  // 1000 LE
+    TEST_ASSERT_EQUAL_HEX8(0x03, static_cast<unsigned char>(sink.body[9]));
+
+    // Bucketed: 16-byte {epoch, mean, min, max} records.
+    api::HistorySeries bucketed = echoOf("soil_moisture", 0, 90000);
+    bucketed.bucketS = 3600;
+    bucketed.timestamps = {0, 3600};
+    bucketed.values = {40.0f, 41.0f};
+    bucketed.mins = {39.0f, 40.5f};
+    bucketed.maxs = {41.0f, 41.5f};
+    StringSink bucketSink;
+    TEST_ASSERT_TRUE(api::streamHistory(bucketed, bucketSink, api::HistoryFormat::Binary));
+    TEST_ASSERT_EQUAL_UINT32(8 + 16 * 2, bucketSink.body.size());
+    TEST_ASSERT_EQUAL_UINT32(3600, u32At(bucketSink.body, 4));
+    TEST_ASSERT_EQUAL_UINT32(3600, u32At(bucketSink.body, 24));
+    TEST_ASSERT_EQUAL_FLOAT(41.0f, f32At(bucketSink.body, 28));
+    TEST_ASSERT_EQUAL_FLOAT(40.5f, f32At(bucketSink.body, 32));
+    TEST_ASSERT_EQUAL_FLOAT(41.5f, f32At(bucketSink.body, 36));
+}
+
+void test_history_format_selection(void)
+{
+    api::HistoryFormat format = api::HistoryFormat::Binary;
+    TEST_ASSERT_TRUE(api::selectHistoryFormat(std::nullopt, std::nullopt, format));
+    TEST_ASSERT_TRUE(format == api::HistoryFormat::Json);
+    TEST_ASSERT_TRUE(api::selectHistoryFormat(
+        std::nullopt, std::string("application/octet-stream"), format));
+    TEST_ASSERT_TRUE(format == api::HistoryFormat::Binary);
+    TEST_ASSERT_TRUE(api::selectHistoryFormat(
+        std::nullopt, std::string("text/html,application/json;q=0.9,*/*"), format));
+    TEST_ASSERT_TRUE(format == api::HistoryFormat::Json);
+
+    // The query parameter wins over the header.
+    TEST_ASSERT_TRUE(api::selectHistoryFormat(
+        std::string("json"), std::string("application/octet-stream"), format));
+    TEST_ASSERT_TRUE(format == api::HistoryFormat::Json);
+    TEST_ASSERT_TRUE(api::selectHistoryFormat(std::string("bin"), std::nullopt, format));
+    TEST_ASSERT_TRUE(format == api::HistoryFormat::Binary);
+    TEST_ASSERT_FALSE(api::selectHistoryFormat(std::string("cbor"), std::nullopt, format));
+    TEST_ASSERT_FALSE(api::selectHistoryFormat(std::string(""), std::nullopt, format));
+}
+
+}  // namespace
+
+void test_history_pages_concatenate_to_every_stored_reading(void)
+{
+    MockDataStorage storage;
+    // A change-only gap (never filled in a page) and three readings sharing
+    // one epoch, which a page boundary splits.
+    const uint32_t epochs[] = {1000, 1060, 1120, 1120, 1120, 1600, 1660};
+    for (std::size_t i = 0; i < sizeof(epochs) / sizeof(epochs[0]); ++i) {
+        TEST_ASSERT_TRUE(storage.storeSensorReading("soil_ec", epochs[i],
+                                                    static_cast<float>(i)));
+    }
+    const api::HistorySeries echo = echoOf("soil_ec", 1000, 1660);
+
+    std::vector<int64_t> timestamps;
+    std::vector<float> values;
+    ReadingCursor cursor;
+    int pages = 0;
+    for (;;) {
+        StringSink sink;
+        TEST_ASSERT_TRUE(api::streamHistoryPage(storage, echo, cursor, 3, sink));
+        ++pages;
+        // The page is the raw body of its readings plus `next`.
+        api::HistorySeries page = echo;
+        const std::size_t from = timestamps.size();
+        for (std::size_t i = from; i < from + 3 && i < 7; ++i) {
+            page.timestamps.push_back(epochs[i]);
+            page.values.push_back(static_cast<float>(i));
+        }
+        timestamps.insert(timestamps.end(), page.timestamps.begin(),
+                          page.timestamps.end());
+        values.insert(values.end(), page.values.begin(), page.values.end());
+        const std::size_t at = sink.body.find("\"next\":\"");
+        if (at == std::string::npos) {
+            TEST_ASSERT_EQUAL_STRING(api::serializeHistory(page).c_str(),
+                                     sink.body.c_str());
+            break;
+        }
+        const std::size_t begin = at + 8;
+        const std::string next =
+            sink.body.substr(begin, sink.body.find('"', begin) - begin);
+        page.next = next;
+        TEST_ASSERT_EQUAL_STRING(api::serializeHistory(page).c_str(),
+                                 sink.body.c_str());
+        TEST_ASSERT_TRUE(api::parseReadingCursor(next, cursor));
+        TEST_ASSERT_TRUE(pages < 5);
+    }
+    TEST_ASSERT_EQUAL_INT(3, pages);
+    TEST_ASSERT_EQUAL_size_t(7, timestamps.size());
+    // The split epoch resumes past the two readings page one returned.
+    TEST_ASSERT_EQUAL_INT64(1120, timestamps[4]);
+    TEST_ASSERT_EQUAL_FLOAT(4.0f, values[4]);
+    TEST_ASSERT_EQUAL_FLOAT(6.0f, values[6]);
+}
+
+void test_history_sync_sends_only_what_the_marks_miss(void)
+{
+    SeekRecordingStorage storage;
+    for (uint32_t i = 0; i < 3; ++i) {
+        storage.storeSensorReading("env_temperature", 1000 + 60 * i, 20.0f + i);
+    }
+    storage.storeSensorReading("soil_moisture", 1000, 40.0f);
+    storage.storeSensorReading("soil_moisture", 1060, 41.0f);
+
+    StringSink first;
+    TEST_ASSERT_TRUE(api::streamHistorySync(storage, api::HistorySyncMarks{}, 8192,
+                                            1760000000, first));
+    SyncBody body;
+    TEST_ASSERT_TRUE(decodeSync(first.body, body));
+    TEST_ASSERT_EQUAL_UINT32(1760000000, body.now);
+    TEST_ASSERT_EQUAL_size_t(2, body.blocks);
+    TEST_ASSERT_EQUAL_size_t(5, body.readings.size());
+    TEST_ASSERT_EQUAL_STRING("env_temperature", body.readings[0].metric.c_str());
+    TEST_ASSERT_EQUAL_UINT32(1120, body.readings[2].epoch);
+    TEST_ASSERT_EQUAL_FLOAT(22.0f, body.readings[2].value);
+    TEST_ASSERT_EQUAL_STRING("soil_moisture", body.readings[4].metric.c_str());
+    TEST_ASSERT_FALSE(body.more);
+    TEST_ASSERT_EQUAL_size_t(api::kSyncTokenLen, body.token.size());
+
+    // One new reading: the next sync carries it alone, and every metric is
+    // walked from its own mark, not from the start of its history.
+    storage.storeSensorReading("env_temperature", 1180, 23.0f);
+    api::HistorySyncMarks marks{};
+    TEST_ASSERT_TRUE(api::parseSyncToken(body.token, marks));
+    storage.walks.clear();
+    StringSink second;
+    TEST_ASSERT_TRUE(api::streamHistorySync(storage, marks, 8192, 0, second));
+    SyncBody delta;
+    TEST_ASSERT_TRUE(decodeSync(second.body, delta));
+    TEST_ASSERT_EQUAL_size_t(1, delta.readings.size());
+    TEST_ASSERT_EQUAL_UINT32(1180, delta.readings[0].epoch);
+    TEST_ASSERT_EQUAL_size_t(metric::kKnownCount, storage.walks.size());
+    TEST_ASSERT_EQUAL_UINT32(1120, storage.walks[0].second);  // env_temperature
+    TEST_ASSERT_EQUAL_UINT32(1060, storage.walks[3].second);  // soil_moisture
+    TEST_ASSERT_EQUAL_UINT32(0, storage.walks[1].second);     // never synced
+
+    // Nothing new: an empty body that hands back the same marks.
+    TEST_ASSERT_TRUE(api::parseSyncToken(delta.token, marks));
+    StringSink third;
+    TEST_ASSERT_TRUE(api::streamHistorySync(storage, marks, 8192, 0, third));
+    SyncBody idle;
+    TEST_ASSERT_TRUE(decodeSync(third.body, idle));
+    TEST_ASSERT_EQUAL_size_t(0, idle.readings.size());
+    TEST_ASSERT_EQUAL_STRING(delta.token.c_str(), idle.token.c_str());
+}
+
+void test_history_sync_limit_resumes_where_it_stopped(void)
+{
+    MockDataStorage storage;
+    for (uint32_t i = 0; i < 40; ++i) {
+        storage.storeSensorReading("env_humidity", 1000 + 60 * i, 50.0f);
+    }
+    // Three readings sharing one epoch, split by the limit.
+    for (uint32_t i = 0; i < 5; ++i) {
+        storage.storeSensorReading("soil_ec", i < 3 ? 2000 : 2000 + i, static_cast<float>(i));
+    }
+
+    StringSink first;
+    TEST_ASSERT_TRUE(api::streamHistorySync(storage, api::HistorySyncMarks{}, 42, 0, first));
+    SyncBody a;
+    TEST_ASSERT_TRUE(decodeSync(first.body, a));
+    TEST_ASSERT_TRUE(a.more);
+    TEST_ASSERT_EQUAL_size_t(42, a.readings.size());
+    TEST_ASSERT_EQUAL_size_t(3, a.blocks);  // 32 + 8 humidity, 2 ec
+    TEST_ASSERT_EQUAL_FLOAT(1.0f, a.readings[41].value);
+
+    api::HistorySyncMarks marks{};
+    TEST_ASSERT_TRUE(api::parseSyncToken(a.token, marks));
+    StringSink second;
+    TEST_ASSERT_TRUE(api::streamHistorySync(storage, marks, 42, 0, second));
+    SyncBody b;
+    TEST_ASSERT_TRUE(decodeSync(second.body, b));
+    TEST_ASSERT_FALSE(b.more);
+    TEST_ASSERT_EQUAL_size_t(3, b.readings.size());
+    TEST_ASSERT_EQUAL_FLOAT(2.0f, b.readings[0].value);
+    TEST_ASSERT_EQUAL_UINT32(2000, b.readings[0].epoch);
+    TEST_ASSERT_EQUAL_FLOAT(4.0f, b.readings[2].value);
+
+    // A send failure leaves the body without its trailer.
+    StringSink failing;
+    failing.failFrom = 0;
+    TEST_ASSERT_FALSE(api::streamHistorySync(storage, marks, 42, 0, failing));
+}
+
+void test_byte_range_resolution(void)
+{
+    api::ByteRange r;
+    using api::RangeRequest;
+    TEST_ASSERT_TRUE(api::resolveByteRange("bytes=100-199", 1000, r) == RangeRequest::Partial);
+    TEST_ASSERT_EQUAL_UINT64(100, r.first);
+    TEST_ASSERT_EQUAL_UINT64(100, r.length);
+    TEST_ASSERT_EQUAL_STRING("bytes 100-199/1000", api::contentRange(r, 1000).c_str());
+
+    // Open end, a last byte past the end, a suffix longer than the body.
+    TEST_ASSERT_TRUE(api::resolveByteRange("bytes=900-", 1000, r) == RangeRequest::Partial);
+    TEST_ASSERT_EQUAL_UINT64(100, r.length);
+    TEST_ASSERT_TRUE(api::resolveByteRange(" Bytes=990-5000 ", 1000, r) == RangeRequest::Partial);
+    TEST_ASSERT_EQUAL_UINT64(990, r.first);
+    TEST_ASSERT_EQUAL_UINT64(10, r.length);
+    TEST_ASSERT_TRUE(api::resolveByteRange("bytes=-300", 1000, r) == RangeRequest::Partial);
+    TEST_ASSERT_EQUAL_UINT64(700, r.first);
+    TEST_ASSERT_EQUAL_UINT64(300, r.length);
+    TEST_ASSERT_TRUE(api::resolveByteRange("bytes=-5000", 1000, r) == RangeRequest::Partial);
+    TEST_ASSERT_EQUAL_UINT64(0, r.first);
+    TEST_ASSERT_EQUAL_UINT64(1000, r.length);
+
+    // Nothing left to send.
+    TEST_ASSERT_TRUE(api::resolveByteRange("bytes=1000-", 1000, r) == RangeRequest::Unsatisfiable);
+    TEST_ASSERT_TRUE(api::resolveByteRange("bytes=-0", 1000, r) == RangeRequest::Unsatisfiable);
+    TEST_ASSERT_TRUE(api::resolveByteRange("bytes=0-", 0, r) == RangeRequest::Unsatisfiable);
+    TEST_ASSERT_EQUAL_STRING("bytes */1000", api::unsatisfiedRange(1000).c_str());
+
+    // Served whole: several ranges, another unit, malformed, overflowing.
+    const char* whole[] = {"",
+                           "bytes=0-1,5-6",
+                           "items=0-1",
+                           "bytes=",
+                           "bytes=-",
+                           "bytes=5-4",
+                           "bytes=a-",
+                           "bytes=1-2x",
+                           "bytes=99999999999999999999-"};
+    for (const char* header : whole) {
+        TEST_ASSERT_TRUE_MESSAGE(api::resolveByteRange(header, 1000, r) == RangeRequest::Whole,
+                                 header);
+    }
+}
+
+void test_range_sink_sends_only_the_range(void)
+{
+    std::string body;
+    for (int i = 0; i < 3000; ++i) {
+        body.push_back(static_cast<char>('a' + i % 26));
+    }
+    // Through the writer's 512-byte chunks, a range inside one chunk and
+    // one spanning several.
+    for (const api::ByteRange range : {api::ByteRange{600, 10}, api::ByteRange{100, 2000},
+                                       api::ByteRange{2990, 10}}) {
+        StringSink out;
+        api::RangeSink sink(out, range);
+        api::ChunkWriter writer(sink);
+        writer.put(body.data(), body.size());
+        writer.flush();
+        TEST_ASSERT_TRUE(sink.complete());
+        TEST_ASSERT_EQUAL_STRING(body.substr(range.first, range.length).c_str(),
+                                 out.body.c_str());
+    }
+
+    // The producer is stopped once the range is out; a client gone before
+    // that is not complete.
+    StringSink out;
+    api::RangeSink early(out, api::ByteRange{0, 10});
+    TEST_ASSERT_FALSE(early.send(body.data(), 100));
+    TEST_ASSERT_TRUE(early.complete());
+    StringSink gone;
+    gone.failFrom = 0;
+    api::RangeSink broken(gone, api::ByteRange{0, 10});
+    TEST_ASSERT_FALSE(broken.send(body.data(), 100));
+    TEST_ASSERT_FALSE(broken.complete());
+
+    // The counting pass measures what the real one sends.
+    MockDataStorage storage;
+    for (uint32_t i = 0; i < 100; ++i) {
+        storage.storeSensorReading("soil_moisture", 1000 + 60 * i, 30.0f + i);
+    }
+    const api::HistorySeries echo = echoOf("soil_moisture", 0, 10000);
+    api::CountingSink counter;
+    TEST_ASSERT_TRUE(api::streamRawHistory(storage, echo, 60, 600, counter,
+                                           api::HistoryFormat::Binary));
+    StringSink full;
+    TEST_ASSERT_TRUE(api::streamRawHistory(storage, echo, 60, 600, full,
+                                           api::HistoryFormat::Binary));
+    TEST_ASSERT_EQUAL_UINT64(full.body.size(), counter.bytes());
+}
+
+void run_api_stream_tests(void)
+{
+    RUN_TEST(test_stream_matches_serialize_for_collected_series);
+    RUN_TEST(test_raw_stream_matches_collected_and_filled_series);
+    RUN_TEST(test_member_bodies_drop_only_the_success_key);
+    RUN_TEST(test_stream_stops_on_failed_send);
+    RUN_TEST(test_raw_stream_fails_when_readings_change_between_passes);
+    RUN_TEST(test_binary_body_packs_little_endian_records);
+    RUN_TEST(test_history_format_selection);
+    RUN_TEST(test_history_pages_concatenate_to_every_stored_reading);
+    RUN_TEST(test_history_sync_sends_only_what_the_marks_miss);
+    RUN_TEST(test_history_sync_limit_resumes_where_it_stopped);
+    RUN_TEST(test_byte_range_resolution);
+    RUN_TEST(test_range_sink_sends_only_the_range);
+}
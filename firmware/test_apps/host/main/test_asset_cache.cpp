@@ -0,0 +1,156 @@
+// SPDX-FileCopyrightText: 2026 Cryptotomte
+// SPDX-License-Identifier: AGPL-3.0-or-later
+/**
+ * @file test_asset_cache.cpp
+ * @brief Host suite for the static asset validators and RAM cache
+ *        (AssetCache.h).
+ *
+ * The manifest yields one quoted strong ETag per listed path and skips
+ * malformed lines; an unknown path is untagged; bodies are kept while they
+ * fit the per-entry and total budgets, never twice for one path. The
+ * AssetStore over a temporary directory reads the manifest once and hands
+ * out whole, cached bodies with their tags; a missing or oversized file is
+ * not handed out.
+ */
+
+#include <cstdio>
+#include <cstdlib>
+#include <string>
+
+#include "unity.h"
+
+#include "api/AssetCache.h"
+#include "api/AssetStore.h"
+
+namespace {
+
+using api::AssetCache;
+using api::AssetStore;
+
+void writeFile(const std::string& path, const std::string& bytes)
+{
+    FILE* f = std::fopen(path.c_str(), "wb");
+    TEST_ASSERT_NOT_NULL(f);
+    std::fwrite(bytes.data(), 1, bytes.size(), f);
+    std::fclose(f);
+}
+
+void test_manifest_tags_listed_paths()
+{
+    AssetCache cache;
+    TEST_ASSERT_FALSE(cache.manifestLoaded());
+    cache.loadManifest("index.html 1cc2914221876e6a\n"
+                       "vendor/chart.min.js 1e2edabc80f6e1ea\r\n");
+    TEST_ASSERT_TRUE(cache.manifestLoaded());
+    TEST_ASSERT_EQUAL_STRING("\"1cc2914221876e6a\"", cache.etagFor("index.html").c_str());
+    TEST_ASSERT_EQUAL_STRING("\"1e2edabc80f6e1ea\"",
+                             cache.etagFor("vendor/chart.min.js").c_str());
+    TEST_ASSERT_EQUAL_STRING("", cache.etagFor("script.js").c_str());
+}
+
+void test_malformed_manifest_lines_are_skipped()
+{
+    AssetCache cache;
+    cache.loadManifest("\n"
+                       "nohash\n"
+                       " 1cc2914221876e6a\n"
+                       "short.js 1cc29142\n"
+                       "upper.js 1CC2914221876E6A\n"
+                       "long.js 1cc2914221876e6a00\n"
+                       "ok.css 7ad82ae96467da34");
+    TEST_ASSERT_EQUAL_STRING("", cache.etagFor("short.js").c_str());
+    TEST_ASSERT_EQUAL_STRING("", cache.etagFor("upper.js").c_str());
+    TEST_ASSERT_EQUAL_STRING("", cache.etagFor("long.js").c_str());
+    TEST_ASSERT_EQUAL_STRING("\"7ad82ae96467da34\"", cache.etagFor("ok.css").c_str());
+}
+
+void test_missing_manifest_loads_empty()
+{
+    AssetCache cache;
+    cache.loadManifest("index.html 1cc2914221876e6a\n");
+    cache.loadManifest("");
+    TEST_ASSERT_TRUE(cache.manifestLoaded());
+    TEST_ASSERT_EQUAL_STRING("", cache.etagFor("index.html").c_str());
+}
+
+void test_insert_and_find()
+{
+    AssetCache cache;
+    TEST_ASSERT_NULL(cache.find("index.html").get());
+    TEST_ASSERT_TRUE(cache.insert("index.html", std::string("\x1f\x8b\0gz", 5)));
+    const auto body = cache.find("index.html");
+    TEST_ASSERT_NOT_NULL(body.get());
+    TEST_ASSERT_EQUAL_size_t(5, body->size());
+    TEST_ASSERT_EQUAL_size_t(5, cache.bytesUsed());
+    // One entry per path.
+    TEST_ASSERT_FALSE(cache.insert("index.html", "other"));
+    TEST_ASSERT_EQUAL_size_t(5, cache.find("index.html")->size());
+}
+
+void test_budgets_bound_the_cache()
+{
+    AssetCache cache;
+    TEST_ASSERT_FALSE(cache.fits(AssetCache::kMaxEntryBytes + 1));
+    TEST_ASSERT_FALSE(
+        cache.insert("big.js", std::string(AssetCache::kMaxEntryBytes + 1, 'x')));
+    TEST_ASSERT_EQUAL_size_t(0, cache.bytesUsed());
+
+    // Fill the total budget with full-size entries; the next one is refused.
+    std::size_t used = 0;
+    int i = 0;
+    while (used + AssetCache::kMaxEntryBytes <= AssetCache::kBudgetBytes) {
+        TEST_ASSERT_TRUE(cache.insert("a" + std::to_string(i++),
+                                      std::string(AssetCache::kMaxEntryBytes, 'x')));
+        used += AssetCache::kMaxEntryBytes;
+    }
+    TEST_ASSERT_EQUAL_size_t(used, cache.bytesUsed());
+    const std::size_t left = AssetCache::kBudgetBytes - used;
+    TEST_ASSERT_FALSE(cache.fits(left + 1));
+    TEST_ASSERT_FALSE(cache.insert("over", std::string(left + 1, 'x')));
+    TEST_ASSERT_NULL(cache.find("over").get());
+}
+
+void test_store_fetches_and_caches_bodies()
+{
+    char templ[] = "/tmp/ws_assets_XXXXXX";
+    char* dir = ::mkdtemp(templ);
+    TEST_ASSERT_NOT_NULL_MESSAGE(dir, "mkdtemp failed");
+    const std::string base = dir;
+    writeFile(base + "/" + api::kAssetManifestName, "setup.html 1cc2914221876e6a\n");
+    writeFile(base + "/setup.html.gz", std::string("\x1f\x8b\0page", 7));
+    writeFile(base + "/big.js.gz", std::string(AssetCache::kMaxEntryBytes + 1, 'x'));
+
+    AssetStore store(base);
+    StaticAsset page;
+    TEST_ASSERT_TRUE(store.fetch("setup.html", page));
+    TEST_ASSERT_EQUAL_size_t(7, page.gz->size());
+    TEST_ASSERT_EQUAL_STRING("\"1cc2914221876e6a\"", page.etag.c_str());
+    TEST_ASSERT_TRUE(store.cache().manifestLoaded());
+
+    // Served from RAM once read: the file is no longer needed.
+    std::remove((base + "/setup.html.gz").c_str());
+    StaticAsset again;
+    TEST_ASSERT_TRUE(store.fetch("setup.html", again));
+    TEST_ASSERT_EQUAL_PTR(page.gz.get(), again.gz.get());
+
+    StaticAsset none;
+    TEST_ASSERT_FALSE(store.fetch("missing.html", none));
+    TEST_ASSERT_FALSE(store.fetch("big.js", none));
+    TEST_ASSERT_EQUAL_size_t(7, store.cache().bytesUsed());
+
+    std::remove((base + "/big.js.gz").c_str());
+    std::remove((base + "/" + api::kAssetManifestName).c_str());
+    std::remove(base.c_str());
+}
+
+}  // namespace
+
+void run_asset_cache_tests(void)
+{
+    RUN_TEST(test_manifest_tags_listed_paths);
+    RUN_TEST(test_malformed_manifest_lines_are_skipped);
+    RUN_TEST(test_missing_manifest_loads_empty);
+    RUN_TEST(test_insert_and_find);
+    RUN_TEST(test_budgets_bound_the_cache);
+    RUN_TEST(test_store_fetches_and_caches_bodies);
+}
@@ -19,14 +19,17 @@
  * consistency); review-fix hardening adds the mid-initialization error-2
  * paths, the continue-to-next-candidate probe path, extra Bosch vectors
  * (dig_H3, negative H calibration, clamps, dig_P1=0 guard) and the
- * LockedEnvironmentalSensor delegation check.
+ * LockedEnvironmentalSensor delegation and published-snapshot checks.
  */
 
+#include <chrono>
 #include <cmath>
+#include <cstdio>
 #include <vector>
 
 #include "unity.h"
 
+#include "actuators/testing/FakeTimeProvider.h"
 #include "sensors/Bme280Sensor.h"
 #include "sensors/LockedEnvironmentalSensor.h"
 #include "sensors/SensorTaskLogPolicy.h"
@@ -246,6 +249,112 @@ static void test_initialize_writes_parity_config_bytes_in_order(void)
     }
 }
 
+/// The 8-bit register writes in @p calls, in order.
+static std::vector<MockI2cBus::Call> writesOf(
+    const std::vector<MockI2cBus::Call>& calls)
+{
+    std::vector<MockI2cBus::Call> writes;
+    for (const MockI2cBus::Call& call : calls) {
+        if (call.type == MockI2cBus::Call::Type::Write) {
+            writes.push_back(call);
+        }
+    }
+    return writes;
+}
+
+// --------------------------------------------------------------------------
+// Sampling profiles: register bytes per the datasheet tables and the
+// datasheet's maximum measurement time
+// --------------------------------------------------------------------------
+static void test_profile_encodings_and_measurement_time(void)
+{
+    using namespace bme280_profiles;
+    TEST_ASSERT_EQUAL_UINT8(0x01, kParity.ctrlHum());
+    TEST_ASSERT_EQUAL_UINT8(0x57, kParity.ctrlMeas());
+    TEST_ASSERT_EQUAL_UINT8(0x90, kParity.config());
+    // 1.25 + 2.3·2 + (2.3·16 + 0.575) + (2.3·1 + 0.575) ms
+    TEST_ASSERT_EQUAL_UINT32(46100, kParity.measurementTimeUs());
+
+    TEST_ASSERT_EQUAL_UINT8(0x25, kForcedLowPower.ctrlMeas());  // ×1 ×1 FORCED
+    TEST_ASSERT_EQUAL_UINT8(0x00, kForcedLowPower.config());
+    TEST_ASSERT_EQUAL_UINT32(9300, kForcedLowPower.measurementTimeUs());
+
+    TEST_ASSERT_EQUAL_UINT8(0x27, kBurst.ctrlMeas());  // ×1 ×1 NORMAL
+    TEST_ASSERT_EQUAL_UINT8(0x40, kBurst.config());    // 125 ms, filter off
+    TEST_ASSERT_EQUAL_UINT8(0x24, kBurst.ctrlMeas(Bme280Mode::Sleep));
+
+    // A skipped channel costs nothing, not even its 0.575 ms overhead.
+    Bme280Profile noPressure = kForcedLowPower;
+    noPressure.pressure = Bme280Oversampling::Skip;
+    TEST_ASSERT_EQUAL_UINT32(6425, noPressure.measurementTimeUs());
+}
+
+// --------------------------------------------------------------------------
+// Forced mode: initialize() writes the profile, and each startMeasurement()
+// is one ctrl_meas trigger reporting the conversion time; NORMAL mode
+// triggers nothing
+// --------------------------------------------------------------------------
+static void test_forced_profile_triggers_one_conversion_per_call(void)
+{
+    MockI2cBus mock;
+    scriptBme280(mock, kAddrSecondary);
+    Bme280Sensor sensor(mock);
+    TEST_ASSERT_TRUE(sensor.setProfile(bme280_profiles::kForcedLowPower));
+
+    TEST_ASSERT_TRUE(sensor.initialize());
+    std::vector<MockI2cBus::Call> writes = writesOf(mock.calls);
+    TEST_ASSERT_EQUAL(3, writes.size());
+    TEST_ASSERT_EQUAL_UINT8(0x01, writes[0].value);
+    TEST_ASSERT_EQUAL_UINT8(0x25, writes[1].value);
+    TEST_ASSERT_EQUAL_UINT8(0x00, writes[2].value);
+
+    mock.calls.clear();
+    TEST_ASSERT_EQUAL_UINT32(9300, sensor.startMeasurement());
+    writes = writesOf(mock.calls);
+    TEST_ASSERT_EQUAL(1, writes.size());
+    TEST_ASSERT_EQUAL_UINT8(kRegCtrlMeas, writes[0].reg);
+    TEST_ASSERT_EQUAL_UINT8(0x25, writes[0].value);
+    TEST_ASSERT_TRUE(sensor.read());
+    TEST_ASSERT_FLOAT_WITHIN(0.005f, kExpectedTemperature,
+                             sensor.getTemperature());
+
+    Fixture normal;
+    TEST_ASSERT_EQUAL_UINT32(0, normal.sensor.startMeasurement());
+    TEST_ASSERT_EQUAL(0, normal.mock.calls.size());
+}
+
+// --------------------------------------------------------------------------
+// Burst on a running device: sleep first (config writes are ignored in
+// NORMAL mode), then ctrl_hum → config → ctrl_meas; off restores parity
+// --------------------------------------------------------------------------
+static void test_burst_reprograms_through_sleep_and_back(void)
+{
+    Fixture f;
+    TEST_ASSERT_TRUE(f.sensor.setBurst(true));
+    std::vector<MockI2cBus::Call> writes = writesOf(f.mock.calls);
+    TEST_ASSERT_EQUAL(4, writes.size());
+    TEST_ASSERT_EQUAL_UINT8(kRegCtrlMeas, writes[0].reg);
+    TEST_ASSERT_EQUAL_UINT8(0x24, writes[0].value);  // sleep
+    TEST_ASSERT_EQUAL_UINT8(kRegCtrlHum, writes[1].reg);
+    TEST_ASSERT_EQUAL_UINT8(kRegConfig, writes[2].reg);
+    TEST_ASSERT_EQUAL_UINT8(0x40, writes[2].value);
+    TEST_ASSERT_EQUAL_UINT8(kRegCtrlMeas, writes[3].reg);
+    TEST_ASSERT_EQUAL_UINT8(0x27, writes[3].value);
+    TEST_ASSERT_EQUAL_UINT8(0x27, f.sensor.profile().ctrlMeas());
+
+    f.mock.calls.clear();
+    TEST_ASSERT_TRUE(f.sensor.setBurst(true));  // already on: no writes
+    TEST_ASSERT_EQUAL(0, f.mock.calls.size());
+
+    TEST_ASSERT_TRUE(f.sensor.setBurst(false));
+    writes = writesOf(f.mock.calls);
+    TEST_ASSERT_EQUAL(4, writes.size());
+    TEST_ASSERT_EQUAL_UINT8(0x90, writes[2].value);
+    TEST_ASSERT_EQUAL_UINT8(0x57, writes[3].value);
+    TEST_ASSERT_TRUE(f.sensor.read());
+    TEST_ASSERT_EQUAL_INT(0, f.sensor.getLastError());
+}
+
 // --------------------------------------------------------------------------
 // Probing order: 0x76 is tried first (data-model.md); with the device at
 // 0x76 the secondary address is never probed
@@ -914,6 +1023,89 @@ static void test_read_negative_h4_h5_h6_calibration(void)
                              sensor.getPressure());
 }
 
+// --------------------------------------------------------------------------
+// Double-precision compensation through the full read() path: the worked
+// example lands on the datasheet's double results (25.08 °C, 100653.27 Pa)
+// --------------------------------------------------------------------------
+static void test_read_double_compensation_matches_datasheet(void)
+{
+    MockI2cBus mock;
+    scriptBme280(mock, kAddrSecondary);
+    Bme280Sensor sensor(mock, Bme280Compensation::Double);
+
+    TEST_ASSERT_TRUE(sensor.read());
+    TEST_ASSERT_FLOAT_WITHIN(0.005f, 25.08f, sensor.getTemperature());
+    TEST_ASSERT_FLOAT_WITHIN(0.0005f, 1006.5327f, sensor.getPressure());
+    TEST_ASSERT_FLOAT_WITHIN(0.01f, kExpectedHumidity, sensor.getHumidity());
+}
+
+// --------------------------------------------------------------------------
+// Integer vs double compensation over a raw sweep (≈ -15…50 °C, the
+// pressure and humidity spans a greenhouse sees): they agree within the
+// integer outputs' resolution, and the per-conversion cost of each is
+// reported. On host wall-clock time stands in for the target cycle count,
+// so only the accuracy is asserted.
+// --------------------------------------------------------------------------
+static void test_compensation_paths_agree_and_benchmark(void)
+{
+    const Bme280Sensor::DoubleTrim trim =
+        Bme280Sensor::deriveDoubleTrim(kRefCal);
+    float maxT = 0.0f;
+    float maxP = 0.0f;
+    float maxH = 0.0f;
+    int conversions = 0;
+    for (int32_t adcT = 400000; adcT <= 600000; adcT += 5000) {
+        for (int32_t adcP = 250000; adcP <= 550000; adcP += 10000) {
+            for (int32_t adcH = 20000; adcH <= 50000; adcH += 2000) {
+                const Bme280Sensor::Reading i =
+                    Bme280Sensor::compensateInteger(adcT, adcP, adcH, kRefCal);
+                const Bme280Sensor::Reading d =
+                    Bme280Sensor::compensateDouble(adcT, adcP, adcH, trim);
+                maxT = std::fmax(maxT, std::fabs(i.temperature - d.temperature));
+                maxP = std::fmax(maxP, std::fabs(i.pressure - d.pressure));
+                maxH = std::fmax(maxH, std::fabs(i.humidity - d.humidity));
+                ++conversions;
+            }
+        }
+    }
+    TEST_ASSERT_TRUE(maxT <= 0.01f);   // integer T resolution
+    TEST_ASSERT_TRUE(maxP <= 0.01f);   // hPa
+    TEST_ASSERT_TRUE(maxH <= 0.01f);   // %RH
+
+    constexpr int kRounds = 20000;
+    volatile float sink = 0.0f;  // keeps the loops from being elided
+    const auto t0 = std::chrono::steady_clock::now();
+    for (int n = 0; n < kRounds; ++n) {
+        sink = Bme280Sensor::compensateInteger(519888 + (n & 1023), 415148,
+                                               32768, kRefCal)
+                   .pressure;
+    }
+    const auto t1 = std::chrono::steady_clock::now();
+    for (int n = 0; n < kRounds; ++n) {
+        sink = Bme280Sensor::compensateDouble(519888 + (n & 1023), 415148,
+                                              32768, trim)
+                   .pressure;
+    }
+    const auto t2 = std::chrono::steady_clock::now();
+    (void)sink;
+
+    const auto ns = [](std::chrono::steady_clock::duration d) {
+        return static_cast<double>(
+                   std::chrono::duration_cast<std::chrono::nanoseconds>(d)
+                       .count()) /
+               kRounds;
+    };
+    char line[160];
+    std::snprintf(line, sizeof(line),
+                  "bme280 compensation over %d raws: max |int-double| "
+                  "T=%.4f C P=%.4f hPa H=%.4f %%RH; integer %.1f ns, "
+                  "double %.1f ns per conversion",
+                  conversions, static_cast<double>(maxT),
+                  static_cast<double>(maxP), static_cast<double>(maxH),
+                  ns(t1 - t0), ns(t2 - t1));
+    std::printf("%s\n", line);
+}
+
 // ==========================================================================
 // Sensor-task log policy (T015, analyze finding U1): the WARN/INFO/silence
 // decisions of main/sensor_task.cpp, host-tested deterministically
@@ -1129,7 +1321,8 @@ static void test_mock_env_initialize_reports_error_available_is_neutral(void)
 static void test_locked_env_wrapper_delegates_all_methods(void)
 {
     MockEnvironmentalSensor inner;
-    LockedEnvironmentalSensor sensor(inner);
+    FakeTimeProvider clock;
+    LockedEnvironmentalSensor sensor(inner, clock);
     inner.scriptSuccessfulRead(21.5f, 40.0f, 1013.2f);
     inner.scriptFailedRead(2);
 
@@ -1152,10 +1345,59 @@ static void test_locked_env_wrapper_delegates_all_methods(void)
     TEST_ASSERT_EQUAL(2, inner.readCalls);
 }
 
+// LockedEnvironmentalSensor serves readers from the copy its last call
+// published: coherent, and never reaching the wrapped sensor.
+static void test_locked_env_wrapper_snapshot_is_last_published(void)
+{
+    MockEnvironmentalSensor inner;
+    FakeTimeProvider clock(0);
+    LockedEnvironmentalSensor sensor(inner, clock);
+    inner.scriptSuccessfulRead(21.5f, 40.0f, 1013.2f);
+    inner.scriptSuccessfulRead(22.0f, 41.0f, 1012.0f);
+    inner.scriptFailedRead(2);
+
+    EnvSnapshot snap = sensor.snapshot();  // nothing read yet
+    TEST_ASSERT_FALSE(snap.valid);
+    TEST_ASSERT_EQUAL_UINT32(0, snap.sequence);
+    TEST_ASSERT_TRUE(std::isnan(snap.temperature));
+
+    clock.advance(1000);
+    TEST_ASSERT_TRUE(sensor.read());
+    snap = sensor.snapshot();
+    TEST_ASSERT_TRUE(snap.valid);
+    TEST_ASSERT_EQUAL_INT(0, snap.lastError);
+    TEST_ASSERT_EQUAL_UINT32(1, snap.sequence);
+    TEST_ASSERT_EQUAL_INT64(1000, snap.atMs);
+    TEST_ASSERT_EQUAL_FLOAT(21.5f, snap.temperature);
+    TEST_ASSERT_EQUAL_FLOAT(40.0f, snap.humidity);
+    TEST_ASSERT_EQUAL_FLOAT(1013.2f, snap.pressure);
+
+    // A read behind the wrapper's back is not published.
+    TEST_ASSERT_TRUE(inner.read());
+    TEST_ASSERT_EQUAL_FLOAT(21.5f, sensor.snapshot().temperature);
+    TEST_ASSERT_EQUAL_FLOAT(21.5f, sensor.getTemperature());
+
+    // A failed read keeps the last sample's sequence; the sample read
+    // behind the wrapper is stamped when it is first published.
+    clock.advance(1000);
+    TEST_ASSERT_FALSE(sensor.read());
+    snap = sensor.snapshot();
+    TEST_ASSERT_FALSE(snap.valid);
+    TEST_ASSERT_EQUAL_INT(2, snap.lastError);
+    TEST_ASSERT_EQUAL_UINT32(2, snap.sequence);
+    TEST_ASSERT_EQUAL_INT64(2000, snap.atMs);  // read 2 first seen here
+    TEST_ASSERT_EQUAL_FLOAT(22.0f, snap.temperature);  // last-good
+    TEST_ASSERT_EQUAL_FLOAT(1012.0f, snap.pressure);
+    TEST_ASSERT_EQUAL(3, inner.readCalls);
+}
+
 void run_bme280_tests(void)
 {
     // US1 (T006)
     RUN_TEST(test_initialize_writes_parity_config_bytes_in_order);
+    RUN_TEST(test_profile_encodings_and_measurement_time);
+    RUN_TEST(test_forced_profile_triggers_one_conversion_per_call);
+    RUN_TEST(test_burst_reprograms_through_sleep_and_back);
     RUN_TEST(test_initialize_probes_primary_address_first);
     RUN_TEST(test_initialize_is_idempotent);
     RUN_TEST(test_read_produces_reference_values);
@@ -1190,6 +1432,8 @@ void run_bme280_tests(void)
     RUN_TEST(test_compensation_humidity_lower_clamp_at_zero_adch);
     RUN_TEST(test_read_negative_temperature_block);
     RUN_TEST(test_read_negative_h4_h5_h6_calibration);
+    RUN_TEST(test_read_double_compensation_matches_datasheet);
+    RUN_TEST(test_compensation_paths_agree_and_benchmark);
     // Sensor-task log policy (T015)
     RUN_TEST(test_log_policy_warns_once_then_bounded_repeats);
     RUN_TEST(test_log_policy_warns_on_recovery_then_reads);
@@ -1200,4 +1444,5 @@ void run_bme280_tests(void)
     RUN_TEST(test_mock_env_helpers_keep_state_coherent);
     RUN_TEST(test_mock_env_initialize_reports_error_available_is_neutral);
     RUN_TEST(test_locked_env_wrapper_delegates_all_methods);
+    RUN_TEST(test_locked_env_wrapper_snapshot_is_last_published);
 }
@@ -53,3 +53,11 @@ static_assert(BOARD_LEVEL_SETTLE_MS == 0,
               "rev1 board contract: no settle gating (rail always on)");
 static_assert(BOARD_LEVEL_DEBOUNCE_MS == 300,
               "rev1 board contract: 300 ms debounce window");
+
+// One watering zone: the plant pump on the primary probe, with the
+// configured thresholds and burst, and a supply for one pump.
+static_assert(kBoardZoneCount == 1 && kBoardZones[0].pumpPin == BOARD_PIN_MAIN_PUMP &&
+                  kBoardZones[0].soilProbe == 0 && kBoardZones[0].burstS == 0,
+              "rev1 board contract: single plant zone on the primary probe");
+static_assert(BOARD_ZONE_PUMP_BUDGET == 1,
+              "rev1 board contract: the supply feeds one zone pump");
@@ -52,3 +52,11 @@ static_assert(BOARD_HAS_RS485_DE == 0,
 #ifdef BOARD_PIN_RS485_DE
 #error "rev2 board contract: BOARD_PIN_RS485_DE must NOT be defined"
 #endif
+
+// One watering zone: the plant pump on the primary probe, with the
+// configured thresholds and burst, and a supply for one pump.
+static_assert(kBoardZoneCount == 1 && kBoardZones[0].pumpPin == BOARD_PIN_MAIN_PUMP &&
+                  kBoardZones[0].soilProbe == 0 && kBoardZones[0].burstS == 0,
+              "rev2 board contract: single plant zone on the primary probe");
+static_assert(BOARD_ZONE_PUMP_BUDGET == 1,
+              "rev2 board contract: the supply feeds one zone pump");
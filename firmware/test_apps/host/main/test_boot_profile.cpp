@@ -0,0 +1,74 @@
+// SPDX-FileCopyrightText: 2026 Cryptotomte
+// SPDX-License-Identifier: AGPL-3.0-or-later
+/**
+ * @file test_boot_profile.cpp
+ * @brief Host suite for the boot-phase marks (interfaces/BootProfile.h).
+ *
+ * Registered by test_main.cpp via run_boot_profile_tests(). A phase keeps
+ * its first mark; 0 reads as not reached, so a mark at reset reads as 1 us
+ * and a time past 32 bits saturates; every phase has a distinct name.
+ */
+
+#include <cstring>
+
+#include "unity.h"
+
+#include "interfaces/BootProfile.h"
+
+namespace {
+
+void test_unmarked_phases_read_zero(void)
+{
+    BootProfile profile;
+    for (std::size_t i = 0; i < kBootPhaseCount; ++i) {
+        const BootPhase phase = static_cast<BootPhase>(i);
+        TEST_ASSERT_EQUAL_UINT32(0, profile.atUs(phase));
+        TEST_ASSERT_FALSE(profile.reached(phase));
+    }
+}
+
+void test_first_mark_wins(void)
+{
+    BootProfile profile;
+    TEST_ASSERT_TRUE(profile.mark(BootPhase::Wifi, 412000));
+    TEST_ASSERT_FALSE(profile.mark(BootPhase::Wifi, 950000));
+    TEST_ASSERT_EQUAL_UINT32(412000, profile.atUs(BootPhase::Wifi));
+    TEST_ASSERT_TRUE(profile.reached(BootPhase::Wifi));
+    // Other phases are untouched.
+    TEST_ASSERT_FALSE(profile.reached(BootPhase::Modbus));
+}
+
+void test_times_are_clamped(void)
+{
+    BootProfile profile;
+    TEST_ASSERT_TRUE(profile.mark(BootPhase::Pumps, 0));
+    TEST_ASSERT_EQUAL_UINT32(1, profile.atUs(BootPhase::Pumps));
+    TEST_ASSERT_TRUE(profile.mark(BootPhase::Levels, -5));
+    TEST_ASSERT_EQUAL_UINT32(1, profile.atUs(BootPhase::Levels));
+    TEST_ASSERT_TRUE(profile.mark(BootPhase::ApiUp, int64_t{1} << 40));
+    TEST_ASSERT_EQUAL_UINT32(UINT32_MAX, profile.atUs(BootPhase::ApiUp));
+}
+
+void test_phase_names_are_distinct(void)
+{
+    for (std::size_t i = 0; i < kBootPhaseCount; ++i) {
+        const char* name = bootPhaseName(static_cast<BootPhase>(i));
+        TEST_ASSERT_NOT_EQUAL(0, std::strcmp(name, "?"));
+        for (std::size_t j = 0; j < i; ++j) {
+            TEST_ASSERT_NOT_EQUAL(
+                0, std::strcmp(name, bootPhaseName(static_cast<BootPhase>(j))));
+        }
+    }
+    TEST_ASSERT_EQUAL_STRING("pumps", bootPhaseName(BootPhase::Pumps));
+    TEST_ASSERT_EQUAL_STRING("apiUp", bootPhaseName(BootPhase::ApiUp));
+}
+
+}  // namespace
+
+void run_boot_profile_tests(void)
+{
+    RUN_TEST(test_unmarked_phases_read_zero);
+    RUN_TEST(test_first_mark_wins);
+    RUN_TEST(test_times_are_clamped);
+    RUN_TEST(test_phase_names_are_distinct);
+}
@@ -0,0 +1,148 @@
+// SPDX-FileCopyrightText: 2026 Cryptotomte
+// SPDX-License-Identifier: AGPL-3.0-or-later
+/**
+ * @file test_buffer_budget.cpp
+ * @brief Host suite for the buffer placement policy
+ *        (interfaces/BufferBudget.h).
+ *
+ * Registered by test_main.cpp via run_buffer_budget_tests(). A board with
+ * PSRAM is granted the larger budget and served from PSRAM until it runs
+ * out, then from internal RAM; one without gets the internal budget and
+ * internal RAM. Releases come off the placement they were taken from, and
+ * a pool's container allocator and account() count like allocate().
+ */
+
+#include <cstdlib>
+#include <vector>
+
+#include "unity.h"
+
+#include "api/AssetCache.h"
+#include "interfaces/BufferBudget.h"
+
+namespace {
+
+/// malloc behind both placements, PSRAM limited to @p psramLeft bytes.
+struct FakeHeap final : IBufferHeap {
+    bool psram = true;
+    std::size_t psramLeft = 0;
+    std::vector<void*> inPsram;
+
+    bool hasPsram() const override { return psram; }
+
+    void* allocate(std::size_t bytes, BufferPlacement placement) override
+    {
+        if (placement == BufferPlacement::Psram) {
+            if (bytes > psramLeft) {
+                return nullptr;
+            }
+            psramLeft -= bytes;
+            inPsram.push_back(std::malloc(bytes));
+            return inPsram.back();
+        }
+        return bytes > (1u << 20) ? nullptr : std::malloc(bytes);
+    }
+
+    BufferPlacement placementOf(const void* p) const override
+    {
+        for (const void* q : inPsram) {
+            if (q == p) {
+                return BufferPlacement::Psram;
+            }
+        }
+        return BufferPlacement::Internal;
+    }
+
+    void release(void* p) override { std::free(p); }
+};
+
+constexpr std::size_t kInternal = static_cast<std::size_t>(BufferPlacement::Internal);
+constexpr std::size_t kPsram = static_cast<std::size_t>(BufferPlacement::Psram);
+
+void test_psram_first_then_internal(void)
+{
+    FakeHeap heap;
+    heap.psramLeft = 1000;
+    BufferBudgets budgets;
+    budgets.setHeap(&heap);
+    TEST_ASSERT_EQUAL_size_t(4096, budgets.declare(BufferPool::RequestArena, {4096, 512}));
+    TEST_ASSERT_EQUAL_size_t(4096, budgets.granted(BufferPool::RequestArena));
+
+    void* a = budgets.allocate(BufferPool::RequestArena, 800);
+    void* b = budgets.allocate(BufferPool::RequestArena, 800);  // PSRAM is full
+    TEST_ASSERT_NOT_NULL(a);
+    TEST_ASSERT_NOT_NULL(b);
+    BufferPoolStats s = budgets.snapshot()[static_cast<std::size_t>(BufferPool::RequestArena)];
+    TEST_ASSERT_TRUE(s.declared);
+    TEST_ASSERT_EQUAL_size_t(800, s.usedBytes[kPsram]);
+    TEST_ASSERT_EQUAL_size_t(800, s.usedBytes[kInternal]);
+    TEST_ASSERT_EQUAL_size_t(1600, s.peakBytes);
+
+    TEST_ASSERT_NULL(budgets.allocate(BufferPool::RequestArena, 2u << 20));
+    budgets.release(BufferPool::RequestArena, a, 800);
+    s = budgets.snapshot()[static_cast<std::size_t>(BufferPool::RequestArena)];
+    TEST_ASSERT_EQUAL_size_t(0, s.usedBytes[kPsram]);
+    TEST_ASSERT_EQUAL_size_t(800, s.usedBytes[kInternal]);
+    TEST_ASSERT_EQUAL_UINT32(1, s.failures);
+    budgets.release(BufferPool::RequestArena, b, 800);
+    TEST_ASSERT_FALSE(
+        budgets.snapshot()[static_cast<std::size_t>(BufferPool::AssetCache)].declared);
+}
+
+void test_no_psram_gets_internal_budget(void)
+{
+    FakeHeap heap;
+    heap.psram = false;
+    heap.psramLeft = 1u << 20;  // never asked
+    BufferBudgets budgets;
+    budgets.setHeap(&heap);
+    TEST_ASSERT_EQUAL_size_t(512, budgets.declare(BufferPool::InputRecorder, {4096, 512}));
+    void* p = budgets.allocate(BufferPool::InputRecorder, 512);
+    TEST_ASSERT_TRUE(heap.inPsram.empty());
+    TEST_ASSERT_EQUAL_size_t(
+        512, budgets.snapshot()[static_cast<std::size_t>(BufferPool::InputRecorder)]
+                 .usedBytes[kInternal]);
+    budgets.release(BufferPool::InputRecorder, p, 512);
+
+    // No heap installed (the host): malloc, internal, the internal budget.
+    BufferBudgets plain;
+    TEST_ASSERT_FALSE(plain.psram());
+    TEST_ASSERT_EQUAL_size_t(512, plain.declare(BufferPool::InputRecorder, {4096, 512}));
+}
+
+void test_allocator_and_account_count(void)
+{
+    const std::size_t slot = static_cast<std::size_t>(BufferPool::HistoryChunkCache);
+    const std::size_t before = bufferBudgets().snapshot()[slot].usedBytes[kInternal];
+    {
+        std::vector<uint32_t, BufferAllocator<uint32_t, BufferPool::HistoryChunkCache>> v;
+        v.reserve(100);
+        v.push_back(7);
+        TEST_ASSERT_EQUAL_size_t(before + 400,
+                                 bufferBudgets().snapshot()[slot].usedBytes[kInternal]);
+    }
+    TEST_ASSERT_EQUAL_size_t(before, bufferBudgets().snapshot()[slot].usedBytes[kInternal]);
+
+    // The asset bodies are counted through account(), and given back with
+    // their cache; a PSRAM-sized cache takes a larger body.
+    const std::size_t assets = static_cast<std::size_t>(BufferPool::AssetCache);
+    const std::size_t held = bufferBudgets().snapshot()[assets].usedBytes[kInternal];
+    {
+        api::AssetCache cache(api::AssetCache::kBudget.psramBytes);
+        TEST_ASSERT_TRUE(cache.insert("chart.min.js", std::string(70 * 1024, 'x')));
+        TEST_ASSERT_EQUAL_size_t(held + 70 * 1024,
+                                 bufferBudgets().snapshot()[assets].usedBytes[kInternal]);
+        api::AssetCache small;
+        TEST_ASSERT_FALSE(small.fits(70 * 1024));
+    }
+    TEST_ASSERT_EQUAL_size_t(held, bufferBudgets().snapshot()[assets].usedBytes[kInternal]);
+}
+
+}  // namespace
+
+void run_buffer_budget_tests(void)
+{
+    RUN_TEST(test_psram_first_then_internal);
+    RUN_TEST(test_no_psram_gets_internal_budget);
+    RUN_TEST(test_allocator_and_account_count);
+}
@@ -0,0 +1,206 @@
+// SPDX-FileCopyrightText: 2026 Cryptotomte
+// SPDX-License-Identifier: AGPL-3.0-or-later
+/**
+ * @file test_clock_holdover.cpp
+ * @brief Host suite for the wall-clock holdover (time/ClockHoldover.h) and
+ *        the DS3231 driver (time/Ds3231Rtc.h) over MockI2cBus.
+ *
+ * Registered by test_main.cpp via run_clock_holdover_tests(). A sealed
+ * anchor advanced by the RTC time across a reset gives the boot epoch; a
+ * power cycle (RTC timer back at zero) or a torn block gives none. The
+ * lower error of the anchor and the DS3231 wins, the error grows with time
+ * until SNTP confirms, and the DS3231 round-trips an epoch through its BCD
+ * registers and refuses a time it flags as lost.
+ */
+
+#include <cstddef>
+#include <cstdint>
+
+#include "unity.h"
+
+#include "sensors/testing/MockI2cBus.h"
+#include "time/ClockHoldover.h"
+#include "time/Ds3231Rtc.h"
+
+namespace {
+
+constexpr uint64_t kWallUs = 1760000000ull * 1000000ull;
+
+/// A holdover sealed at @p rtcUs with @p source, from a fresh instance.
+ClockAnchorBlock sealedAnchor(uint64_t rtcUs, uint32_t errorMs = 100,
+                              ClockSource source = ClockSource::Sntp)
+{
+    ClockHoldover clock;
+    ClockEstimate estimate;
+    estimate.wallUs = kWallUs;
+    estimate.errorMs = errorMs;
+    estimate.source = source;
+    clock.restore({&estimate}, 0);
+    ClockAnchorBlock block{};
+    TEST_ASSERT_TRUE(clock.seal(kWallUs, rtcUs, 0, block));
+    return block;
+}
+
+void test_retained_anchor_advances_across_the_gap(void)
+{
+    const ClockAnchorBlock block = sealedAnchor(5000000);
+    ClockHoldover clock;
+    ClockEstimate out;
+    // 2 s of reset: 2 s later, plus 2 % of the gap on top of the sealed error.
+    TEST_ASSERT_TRUE(clock.fromRetained({&block, nullptr}, 7000000, out));
+    TEST_ASSERT_TRUE(out.source == ClockSource::Retained);
+    TEST_ASSERT_EQUAL_UINT64(kWallUs + 2000000, out.wallUs);
+    TEST_ASSERT_EQUAL_UINT32(100 + 40, out.errorMs);
+    TEST_ASSERT_EQUAL_UINT32(1, clock.sequence());
+}
+
+void test_retained_anchor_rejected_after_power_cycle(void)
+{
+    const ClockAnchorBlock block = sealedAnchor(5000000);
+    ClockHoldover clock;
+    ClockEstimate out;
+    TEST_ASSERT_FALSE(clock.fromRetained({&block}, 1000, out));
+    // Still valid memory: later seals must outnumber it.
+    TEST_ASSERT_EQUAL_UINT32(1, clock.sequence());
+    TEST_ASSERT_FALSE(clock.fromRetained(
+        {&block}, 5000000 + ClockHoldover::kMaxRetainedGapUs + 1, out));
+
+    ClockAnchorBlock torn = block;
+    torn.wallUs += 1;
+    ClockHoldover fresh;
+    TEST_ASSERT_FALSE(fresh.fromRetained({&torn}, 6000000, out));
+    TEST_ASSERT_EQUAL_UINT32(0, fresh.sequence());
+}
+
+void test_retained_picks_the_newest_block(void)
+{
+    ClockHoldover writer;
+    ClockEstimate estimate{kWallUs, 100, ClockSource::Sntp};
+    writer.restore({&estimate}, 0);
+    ClockAnchorBlock blocks[2] = {};
+    TEST_ASSERT_TRUE(writer.seal(kWallUs, 1000000, 0, blocks[1]));
+    TEST_ASSERT_TRUE(writer.seal(kWallUs + 1000000, 2000000, 1000, blocks[0]));
+
+    ClockHoldover clock;
+    ClockEstimate out;
+    TEST_ASSERT_TRUE(clock.fromRetained({&blocks[0], &blocks[1]}, 2000000, out));
+    TEST_ASSERT_EQUAL_UINT64(kWallUs + 1000000, out.wallUs);
+    TEST_ASSERT_EQUAL_UINT32(2, clock.sequence());
+}
+
+void test_ds3231_error_follows_its_age(void)
+{
+    ClockEstimate out;
+    const uint32_t now = 1760000000;
+    // A week since SNTP set it: 1 s resolution + 2 ppm of 604800 s.
+    TEST_ASSERT_TRUE(ClockHoldover::fromDs3231(now, now - 604800, out));
+    TEST_ASSERT_TRUE(out.source == ClockSource::Ds3231);
+    TEST_ASSERT_EQUAL_UINT64(static_cast<uint64_t>(now) * 1000000ull, out.wallUs);
+    TEST_ASSERT_EQUAL_UINT32(1000 + 1210, out.errorMs);
+    // Unknown age: a year's worth of drift.
+    TEST_ASSERT_TRUE(ClockHoldover::fromDs3231(now, 0, out));
+    TEST_ASSERT_EQUAL_UINT32(1000 + 63072, out.errorMs);
+    TEST_ASSERT_FALSE(ClockHoldover::fromDs3231(86400, 0, out));
+}
+
+void test_restore_takes_the_lower_error(void)
+{
+    ClockHoldover clock;
+    ClockEstimate retained{kWallUs, 140, ClockSource::Retained};
+    ClockEstimate rtc{kWallUs, 2210, ClockSource::Ds3231};
+    TEST_ASSERT_EQUAL_PTR(&retained, clock.restore({&rtc, &retained}, 1000));
+
+    ClockStatus status;
+    TEST_ASSERT_TRUE(clock.status(1000, status));
+    TEST_ASSERT_TRUE(status.holdover());
+    TEST_ASSERT_TRUE(status.source == ClockSource::Retained);
+    TEST_ASSERT_EQUAL_UINT32(140, status.errorMs);
+    // 50 ppm of an hour = 180 ms more.
+    TEST_ASSERT_TRUE(clock.status(1000 + 3600000, status));
+    TEST_ASSERT_EQUAL_UINT32(140 + 180, status.errorMs);
+
+    // SNTP confirms: not holdover, the error starts over.
+    clock.synced(4000000);
+    TEST_ASSERT_TRUE(clock.status(4000000, status));
+    TEST_ASSERT_FALSE(status.holdover());
+    TEST_ASSERT_TRUE(status.source == ClockSource::Sntp);
+    TEST_ASSERT_EQUAL_UINT32(ClockHoldover::kSntpErrorMs, status.errorMs);
+}
+
+void test_restore_refuses_poor_estimates(void)
+{
+    ClockHoldover clock;
+    ClockEstimate poor{kWallUs, ClockHoldover::kMaxBootErrorMs + 1, ClockSource::Ds3231};
+    ClockEstimate none;
+    TEST_ASSERT_NULL(clock.restore({&poor, &none, nullptr}, 0));
+    ClockStatus status;
+    TEST_ASSERT_TRUE(clock.status(0, status));
+    TEST_ASSERT_TRUE(status.source == ClockSource::None);
+    ClockAnchorBlock block{};
+    TEST_ASSERT_FALSE(clock.seal(kWallUs, 0, 0, block));
+    TEST_ASSERT_FALSE(ClockHoldover::valid(block));
+}
+
+void test_ds3231_round_trips_an_epoch(void)
+{
+    MockI2cBus bus;
+    bus.addDevice(Ds3231Rtc::kAddress);
+    bus.setRegister(Ds3231Rtc::kAddress, 0x0F, 0x88);  // OSF + EN32kHz
+    Ds3231Rtc rtc(bus);
+    TEST_ASSERT_TRUE(rtc.present());
+    uint32_t epoch = 0;
+    TEST_ASSERT_FALSE(rtc.read(epoch));  // oscillator stopped: lost
+
+    // 2024-02-29 23:59:58 UTC, a Thursday.
+    const std::size_t firstWrite = bus.calls.size();
+    TEST_ASSERT_TRUE(rtc.write(1709251198));
+    // Seconds first: the chip restarts its one-second countdown there.
+    TEST_ASSERT_TRUE(bus.calls[firstWrite].type == MockI2cBus::Call::Type::Write);
+    TEST_ASSERT_EQUAL_UINT8(0x00, bus.calls[firstWrite].reg);
+    TEST_ASSERT_TRUE(rtc.read(epoch));
+    TEST_ASSERT_EQUAL_UINT32(1709251198, epoch);
+
+    uint8_t regs[7] = {};
+    TEST_ASSERT_TRUE(bus.readRegisters(Ds3231Rtc::kAddress, 0x00, regs, sizeof regs));
+    TEST_ASSERT_EQUAL_HEX8(0x58, regs[0]);
+    TEST_ASSERT_EQUAL_HEX8(0x59, regs[1]);
+    TEST_ASSERT_EQUAL_HEX8(0x23, regs[2]);
+    TEST_ASSERT_EQUAL_HEX8(5, regs[3]);
+    TEST_ASSERT_EQUAL_HEX8(0x29, regs[4]);
+    TEST_ASSERT_EQUAL_HEX8(0x02, regs[5]);
+    TEST_ASSERT_EQUAL_HEX8(0x24, regs[6]);
+    uint8_t status = 0;
+    TEST_ASSERT_TRUE(bus.readRegisters(Ds3231Rtc::kAddress, 0x0F, &status, 1));
+    TEST_ASSERT_EQUAL_HEX8(0x08, status);  // OSF cleared, the rest kept
+}
+
+void test_ds3231_rejects_garbage(void)
+{
+    MockI2cBus bus;
+    Ds3231Rtc rtc(bus);
+    uint32_t epoch = 0;
+    TEST_ASSERT_FALSE(rtc.present());
+    TEST_ASSERT_FALSE(rtc.read(epoch));
+
+    // Month 13 is no date.
+    bus.setRegisters(Ds3231Rtc::kAddress, 0x00, {0x00, 0x00, 0x12, 1, 0x01, 0x13, 0x25});
+    TEST_ASSERT_FALSE(rtc.read(epoch));
+    // Nor is 12-hour mode, which this driver never writes.
+    bus.setRegisters(Ds3231Rtc::kAddress, 0x00, {0x00, 0x00, 0x52, 1, 0x01, 0x01, 0x25});
+    TEST_ASSERT_FALSE(rtc.read(epoch));
+    TEST_ASSERT_FALSE(rtc.write(900000000));  // before 2000
+}
+
+}  // namespace
+
+void run_clock_holdover_tests(void)
+{
+    RUN_TEST(test_retained_anchor_advances_across_the_gap);
+    RUN_TEST(test_retained_anchor_rejected_after_power_cycle);
+    RUN_TEST(test_retained_picks_the_newest_block);
+    RUN_TEST(test_ds3231_error_follows_its_age);
+    RUN_TEST(test_restore_takes_the_lower_error);
+    RUN_TEST(test_restore_refuses_poor_estimates);
+    RUN_TEST(test_ds3231_round_trips_an_epoch);
+    RUN_TEST(test_ds3231_rejects_garbage);
+}
@@ -17,19 +17,23 @@
 #include <fcntl.h>
 #include <unistd.h>
 
+#include <atomic>
 #include <cmath>
 #include <cstdint>
 #include <cstdio>
 #include <cstdlib>
 #include <cstring>
 #include <string>
+#include <thread>
 
 #include "unity.h"
 
 #include "nvs.h"
 #include "nvs_flash.h"
 
+#include "api/HttpdPresets.h"
 #include "interfaces/IConfigStore.h"
+#include "interfaces/Seqlock.h"
 #include "storage/LockedConfigStore.h"
 #include "storage/NvsConfigStore.h"
 #include "storage/testing/MockConfigStore.h"
@@ -304,10 +308,11 @@ static void test_out_of_range_stored_values_shadowed(void)
                              store.getDataLogIntervalMs());
     TEST_ASSERT_EQUAL_STRING("", store.getWifiSsid().c_str());
 
-    // A NaN bit pattern is also shadowed, never returned.
+    // A NaN bit pattern is also shadowed, never returned (a fresh instance:
+    // the store reads NVS once, on construction).
     rawSetU32("moist_low", floatBits(NAN));
     TEST_ASSERT_EQUAL_FLOAT(IConfigStore::kDefaultMoistureThresholdLow,
-                            store.getMoistureThresholdLow());
+                            NvsConfigStore().getMoistureThresholdLow());
 
     // The invalid entry stays in place until the next VALID write replaces
     // it (data-model rule).
@@ -315,6 +320,37 @@ static void test_out_of_range_stored_values_shadowed(void)
     TEST_ASSERT_EQUAL_FLOAT(42.0f, store.getMoistureThresholdLow());
 }
 
+// ---------------------------------------------------------------------------
+// The getters serve the RAM cache loaded on construction: an entry written
+// behind the store's back shows up in the next instance only, while the
+// store's own writes update NVS and the cache together.
+// ---------------------------------------------------------------------------
+static void test_getters_serve_the_load_time_cache(void)
+{
+    resetNvs();
+    rawSetU32("water_dur", 120);
+    NvsConfigStore store;
+    TEST_ASSERT_EQUAL_UINT32(120, store.getWateringDurationS());
+
+    rawSetU32("water_dur", 200);
+    rawSetStr("wifi_ssid", "behind-the-back");
+    TEST_ASSERT_EQUAL_UINT32(120, store.getWateringDurationS());
+    TEST_ASSERT_EQUAL_STRING("", store.getWifiSsid().c_str());
+    TEST_ASSERT_EQUAL_UINT32(200, NvsConfigStore().getWateringDurationS());
+
+    TEST_ASSERT_TRUE(store.setWateringDurationS(90));
+    TEST_ASSERT_TRUE(store.setWifiCredentials("net", "pw"));
+    TEST_ASSERT_EQUAL_UINT32(90, store.getWateringDurationS());
+    TEST_ASSERT_EQUAL_STRING("net", store.getWifiSsid().c_str());
+    NvsConfigStore reloaded;
+    TEST_ASSERT_EQUAL_UINT32(90, reloaded.getWateringDurationS());
+    TEST_ASSERT_EQUAL_STRING("pw", reloaded.getWifiPassword().c_str());
+
+    TEST_ASSERT_TRUE(store.clearWifiCredentials());
+    TEST_ASSERT_EQUAL_STRING("", store.getWifiSsid().c_str());
+    TEST_ASSERT_EQUAL_STRING("", NvsConfigStore().getWifiSsid().c_str());
+}
+
 // ---------------------------------------------------------------------------
 // T012 — factory reset restores every default and removes credentials
 // (FR-005, SC-003)
@@ -491,6 +527,397 @@ static void test_mock_shadowing_factory_reset_and_fail_writes(void)
     TEST_ASSERT_EQUAL_UINT32(45, store.getWateringDurationS());
 }
 
+// ---------------------------------------------------------------------------
+// Per-metric log policies: off by default, stored as a whole (three entries,
+// one commit), survive a restart, rejected out of range, cleared by reset.
+// ---------------------------------------------------------------------------
+static void test_log_policy_round_trip_and_rejects(void)
+{
+    resetNvs();
+    {
+        NvsConfigStore store;
+        for (MetricId id = 0; id < metric::kKnownCount; ++id) {
+            TEST_ASSERT_EQUAL_UINT32(0, store.getMetricLogPolicy(id).heartbeatS);
+        }
+        const MetricLogPolicy policy{0.5f, 0.02f, 900};
+        TEST_ASSERT_TRUE(store.setMetricLogPolicy(metric::kSoilPh, policy));
+    }
+    TEST_ASSERT_EQUAL(ESP_OK, nvs_flash_deinit());
+    TEST_ASSERT_EQUAL(ESP_OK, nvs_flash_init());
+
+    NvsConfigStore store;
+    MetricLogPolicy read = store.getMetricLogPolicy(metric::kSoilPh);
+    TEST_ASSERT_EQUAL_FLOAT(0.5f, read.deadbandAbs);
+    TEST_ASSERT_EQUAL_FLOAT(0.02f, read.deadbandRel);
+    TEST_ASSERT_EQUAL_UINT32(900, read.heartbeatS);
+    TEST_ASSERT_EQUAL_UINT32(0, store.getMetricLogPolicy(metric::kSoilEc).heartbeatS);
+
+    // Every bound, an unknown id and a NaN band are refused; the stored
+    // policy is untouched.
+    TEST_ASSERT_FALSE(store.setMetricLogPolicy(metric::kSoilPh, {-0.1f, 0.0f, 900}));
+    TEST_ASSERT_FALSE(store.setMetricLogPolicy(metric::kSoilPh, {2e6f, 0.0f, 900}));
+    TEST_ASSERT_FALSE(store.setMetricLogPolicy(metric::kSoilPh, {0.0f, 1.5f, 900}));
+    TEST_ASSERT_FALSE(store.setMetricLogPolicy(metric::kSoilPh, {NAN, 0.0f, 900}));
+    TEST_ASSERT_FALSE(store.setMetricLogPolicy(metric::kSoilPh, {0.0f, 0.0f, 59}));
+    TEST_ASSERT_FALSE(store.setMetricLogPolicy(metric::kSoilPh, {0.0f, 0.0f, 86401}));
+    TEST_ASSERT_FALSE(store.setMetricLogPolicy(metric::kKnownCount, {0.0f, 0.0f, 900}));
+    TEST_ASSERT_EQUAL_UINT32(900, store.getMetricLogPolicy(metric::kSoilPh).heartbeatS);
+    TEST_ASSERT_TRUE(store.setMetricLogPolicy(metric::kSoilPh, {0.0f, 0.0f, 0}));
+    TEST_ASSERT_EQUAL_UINT32(0, store.getMetricLogPolicy(metric::kSoilPh).heartbeatS);
+
+    TEST_ASSERT_TRUE(store.setMetricLogPolicy(metric::kEnvHumidity, {1.0f, 0.0f, 60}));
+    TEST_ASSERT_TRUE(store.factoryReset());
+    TEST_ASSERT_EQUAL_UINT32(0, store.getMetricLogPolicy(metric::kEnvHumidity).heartbeatS);
+
+    // The mock and the locked wrapper keep the same contract.
+    MockConfigStore inner;
+    LockedConfigStore locked(inner);
+    TEST_ASSERT_TRUE(locked.setMetricLogPolicy(metric::kEnvHumidity, {1.0f, 0.0f, 60}));
+    TEST_ASSERT_FALSE(locked.setMetricLogPolicy(metric::kEnvHumidity, {1.0f, 0.0f, 30}));
+    TEST_ASSERT_EQUAL(1, inner.acceptedWrites);
+    TEST_ASSERT_EQUAL(1, inner.rejectedWrites);
+    TEST_ASSERT_EQUAL_FLOAT(1.0f, locked.getMetricLogPolicy(metric::kEnvHumidity).deadbandAbs);
+}
+
+// ---------------------------------------------------------------------------
+// Soil bus line rate: only the probe's listed rates are accepted, persisted
+// across a restart, cleared by a factory reset.
+// ---------------------------------------------------------------------------
+static void test_modbus_baud_round_trip_and_rejects(void)
+{
+    resetNvs();
+    {
+        NvsConfigStore store;
+        TEST_ASSERT_EQUAL_UINT32(IConfigStore::kDefaultModbusBaudRate,
+                                 store.getModbusBaudRate());
+        TEST_ASSERT_TRUE(store.setModbusBaudRate(19200));
+        TEST_ASSERT_FALSE(store.setModbusBaudRate(115200));
+        TEST_ASSERT_FALSE(store.setModbusBaudRate(0));
+    }
+    TEST_ASSERT_EQUAL(ESP_OK, nvs_flash_deinit());
+    TEST_ASSERT_EQUAL(ESP_OK, nvs_flash_init());
+
+    NvsConfigStore store;
+    TEST_ASSERT_EQUAL_UINT32(19200, store.getModbusBaudRate());
+    TEST_ASSERT_EQUAL_UINT32(19200, store.snapshot().modbusBaudRate);
+    TEST_ASSERT_TRUE(store.factoryReset());
+    TEST_ASSERT_EQUAL_UINT32(9600, store.getModbusBaudRate());
+
+    MockConfigStore inner;
+    LockedConfigStore locked(inner);
+    TEST_ASSERT_TRUE(locked.setModbusBaudRate(2400));
+    TEST_ASSERT_FALSE(locked.setModbusBaudRate(38400));
+    TEST_ASSERT_EQUAL(1, inner.acceptedWrites);
+    TEST_ASSERT_EQUAL(1, inner.rejectedWrites);
+    TEST_ASSERT_EQUAL_UINT32(2400, locked.getModbusBaudRate());
+}
+
+// ---------------------------------------------------------------------------
+// Station static IP: stored as one set, persisted across a restart, all zero
+// returns to DHCP; an invalid set is rejected and a corrupt stored one reads
+// as DHCP.
+// ---------------------------------------------------------------------------
+static void test_static_ip_round_trip_and_rejects(void)
+{
+    const StaticIpConfig ip{0xC0A80114u, 0xFFFFFF00u, 0xC0A80101u, 0x01010101u};
+    resetNvs();
+    {
+        NvsConfigStore store;
+        TEST_ASSERT_FALSE(store.getStaticIp().enabled());
+        TEST_ASSERT_TRUE(store.setStaticIp(ip));
+        // Network address, non-contiguous mask, off-link gateway.
+        TEST_ASSERT_FALSE(store.setStaticIp({0xC0A80100u, 0xFFFFFF00u, 0, 0}));
+        TEST_ASSERT_FALSE(store.setStaticIp({0xC0A80114u, 0xFF00FF00u, 0, 0}));
+        TEST_ASSERT_FALSE(store.setStaticIp({0xC0A80114u, 0xFFFFFF00u, 0x0A000001u, 0}));
+    }
+    TEST_ASSERT_EQUAL(ESP_OK, nvs_flash_deinit());
+    TEST_ASSERT_EQUAL(ESP_OK, nvs_flash_init());
+    {
+        NvsConfigStore store;
+        const StaticIpConfig got = store.getStaticIp();
+        TEST_ASSERT_EQUAL_HEX32(ip.address, got.address);
+        TEST_ASSERT_EQUAL_HEX32(ip.netmask, got.netmask);
+        TEST_ASSERT_EQUAL_HEX32(ip.gateway, got.gateway);
+        TEST_ASSERT_EQUAL_HEX32(ip.dns, got.dns);
+        TEST_ASSERT_TRUE(store.setStaticIp(StaticIpConfig{}));
+        TEST_ASSERT_FALSE(store.getStaticIp().enabled());
+    }
+
+    MockConfigStore inner;
+    LockedConfigStore locked(inner);
+    TEST_ASSERT_TRUE(locked.setStaticIp(ip));
+    TEST_ASSERT_FALSE(locked.setStaticIp({0xC0A801FFu, 0xFFFFFF00u, 0, 0}));
+    TEST_ASSERT_EQUAL(1, inner.acceptedWrites);
+    TEST_ASSERT_EQUAL(1, inner.rejectedWrites);
+    TEST_ASSERT_EQUAL_HEX32(ip.address, locked.getStaticIp().address);
+    inner.stored.staticIp = StaticIpConfig{0xC0A80114u, 0, 0, 0};  // no mask
+    TEST_ASSERT_FALSE(locked.getStaticIp().enabled());
+}
+
+// ---------------------------------------------------------------------------
+// API server sizing: stored as one set, persisted across a restart, all zero
+// returns to the build defaults; every preset is valid and an out-of-range
+// set is rejected.
+// ---------------------------------------------------------------------------
+static void test_httpd_settings_round_trip_and_presets(void)
+{
+    for (api::HttpdPreset p :
+         {api::HttpdPreset::Single, api::HttpdPreset::Multi, api::HttpdPreset::Collector}) {
+        TEST_ASSERT_TRUE(IConfigStore::isValidHttpdSettings(api::httpdPresetSettings(p)));
+        api::HttpdPreset parsed = api::HttpdPreset::Single;
+        TEST_ASSERT_TRUE(api::parseHttpdPreset(api::httpdPresetName(p), parsed));
+        TEST_ASSERT_TRUE(parsed == p);
+    }
+    api::HttpdPreset unused = api::HttpdPreset::Single;
+    TEST_ASSERT_FALSE(api::parseHttpdPreset("default", unused));
+
+    const HttpdSettings multi = api::httpdPresetSettings(api::HttpdPreset::Multi);
+    HttpdSettings tooMany = multi;
+    tooMany.maxOpenSockets = IConfigStore::kHttpdSocketsMax + 1;
+    HttpdSettings noStack = multi;
+    noStack.stackBytes = 1024;
+    resetNvs();
+    {
+        NvsConfigStore store;
+        TEST_ASSERT_FALSE(store.getHttpdSettings().enabled());
+        TEST_ASSERT_TRUE(store.setHttpdSettings(multi));
+        TEST_ASSERT_FALSE(store.setHttpdSettings(tooMany));
+        TEST_ASSERT_FALSE(store.setHttpdSettings(noStack));
+    }
+    TEST_ASSERT_EQUAL(ESP_OK, nvs_flash_deinit());
+    TEST_ASSERT_EQUAL(ESP_OK, nvs_flash_init());
+    {
+        NvsConfigStore store;
+        const HttpdSettings got = store.getHttpdSettings();
+        TEST_ASSERT_EQUAL_UINT16(multi.maxOpenSockets, got.maxOpenSockets);
+        TEST_ASSERT_EQUAL_UINT16(multi.backlog, got.backlog);
+        TEST_ASSERT_EQUAL_UINT32(multi.stackBytes, got.stackBytes);
+        TEST_ASSERT_EQUAL_UINT16(multi.recvTimeoutS, got.recvTimeoutS);
+        TEST_ASSERT_EQUAL_UINT16(multi.sendTimeoutS, got.sendTimeoutS);
+        TEST_ASSERT_TRUE(got.lruPurge);
+        TEST_ASSERT_TRUE(store.setHttpdSettings(HttpdSettings{}));
+        TEST_ASSERT_FALSE(store.getHttpdSettings().enabled());
+    }
+
+    MockConfigStore inner;
+    LockedConfigStore locked(inner);
+    TEST_ASSERT_TRUE(locked.setHttpdSettings(multi));
+    TEST_ASSERT_FALSE(locked.setHttpdSettings(tooMany));
+    TEST_ASSERT_EQUAL(1, inner.acceptedWrites);
+    TEST_ASSERT_EQUAL(1, inner.rejectedWrites);
+    TEST_ASSERT_EQUAL_UINT16(multi.maxOpenSockets, locked.getHttpdSettings().maxOpenSockets);
+}
+
+// ---------------------------------------------------------------------------
+// apply(): every set field of a patch is persisted together (and survives a
+// restart); one invalid field rejects the whole patch with nothing written.
+// ---------------------------------------------------------------------------
+static void test_apply_patch_all_or_nothing(void)
+{
+    resetNvs();
+    {
+        NvsConfigStore store;
+        ConfigPatch patch;
+        patch.moistureThresholdLow = 25.0f;
+        patch.wateringDurationS = 90;
+        patch.wateringEnabled = false;
+        patch.dataLogIntervalMs = 600000;
+        patch.logPolicies[metric::kSoilEc] = MetricLogPolicy{0.1f, 0.0f, 3600};
+        TEST_ASSERT_TRUE(store.apply(patch));
+        TEST_ASSERT_EQUAL_FLOAT(25.0f, store.getMoistureThresholdLow());
+        TEST_ASSERT_EQUAL_UINT32(90, store.getWateringDurationS());
+
+        // One out-of-range field: nothing of the patch is written.
+        ConfigPatch bad;
+        bad.wateringDurationS = 30;
+        bad.minWateringIntervalS = 0;
+        TEST_ASSERT_FALSE(store.apply(bad));
+        bad.minWateringIntervalS.reset();
+        bad.moistureThresholdHigh = NAN;
+        TEST_ASSERT_FALSE(store.apply(bad));
+        bad.moistureThresholdHigh.reset();
+        bad.logPolicies[metric::kSoilPh] = MetricLogPolicy{0.0f, 0.0f, 1};
+        TEST_ASSERT_FALSE(store.apply(bad));
+        TEST_ASSERT_EQUAL_UINT32(90, store.getWateringDurationS());
+
+        // An empty patch is a successful no-op.
+        TEST_ASSERT_TRUE(store.apply(ConfigPatch{}));
+    }
+    TEST_ASSERT_EQUAL(ESP_OK, nvs_flash_deinit());
+    TEST_ASSERT_EQUAL(ESP_OK, nvs_flash_init());
+
+    NvsConfigStore store;
+    TEST_ASSERT_EQUAL_FLOAT(25.0f, store.getMoistureThresholdLow());
+    TEST_ASSERT_EQUAL_FLOAT(IConfigStore::kDefaultMoistureThresholdHigh,
+                            store.getMoistureThresholdHigh());
+    TEST_ASSERT_EQUAL_UINT32(90, store.getWateringDurationS());
+    TEST_ASSERT_FALSE(store.getWateringEnabled());
+    TEST_ASSERT_EQUAL_UINT32(600000, store.getDataLogIntervalMs());
+    TEST_ASSERT_EQUAL_UINT32(3600, store.getMetricLogPolicy(metric::kSoilEc).heartbeatS);
+    TEST_ASSERT_EQUAL_UINT32(0, store.getMetricLogPolicy(metric::kSoilPh).heartbeatS);
+
+    // The mock's setter-by-setter default and the wrapper agree.
+    MockConfigStore inner;
+    LockedConfigStore locked(inner);
+    ConfigPatch patch;
+    patch.wateringDurationS = 45;
+    patch.sensorReadIntervalMs = 2000;
+    TEST_ASSERT_TRUE(locked.apply(patch));
+    TEST_ASSERT_EQUAL(2, inner.acceptedWrites);
+    patch.sensorReadIntervalMs = 999;
+    TEST_ASSERT_FALSE(locked.apply(patch));
+    TEST_ASSERT_EQUAL(2, inner.applyCalls);
+    TEST_ASSERT_EQUAL(1, inner.rejectedWrites);
+    TEST_ASSERT_EQUAL_UINT32(2000, locked.getSensorReadIntervalMs());
+}
+
+// ---------------------------------------------------------------------------
+// Config change notification: generation() moves on every successful write
+// and only then; LockedConfigStore listeners fire on the same condition.
+// ---------------------------------------------------------------------------
+static void test_generation_moves_on_successful_writes_only(void)
+{
+    resetNvs();
+    NvsConfigStore store;
+    const uint32_t g0 = store.generation();
+    TEST_ASSERT_EQUAL_UINT32(g0, store.generation());
+
+    TEST_ASSERT_TRUE(store.setSensorReadIntervalMs(2000));
+    const uint32_t g1 = store.generation();
+    TEST_ASSERT_TRUE(g0 != g1);
+
+    TEST_ASSERT_FALSE(store.setSensorReadIntervalMs(999));  // rejected
+    TEST_ASSERT_EQUAL_UINT32(g1, store.generation());
+
+    ConfigPatch patch;
+    patch.wateringEnabled = false;
+    TEST_ASSERT_TRUE(store.apply(patch));
+    const uint32_t g2 = store.generation();
+    TEST_ASSERT_TRUE(g1 != g2);
+
+    TEST_ASSERT_TRUE(store.factoryReset());
+    TEST_ASSERT_TRUE(g2 != store.generation());
+
+    MockConfigStore mock;
+    mock.stableGeneration = true;
+    const uint32_t m0 = mock.generation();
+    mock.stored.wateringDurationS = 60;  // behind the store's back: unseen
+    TEST_ASSERT_EQUAL_UINT32(m0, mock.generation());
+    TEST_ASSERT_FALSE(mock.setWateringDurationS(0));
+    TEST_ASSERT_EQUAL_UINT32(m0, mock.generation());
+    TEST_ASSERT_TRUE(mock.setWateringDurationS(45));
+    TEST_ASSERT_TRUE(m0 != mock.generation());
+}
+
+static void test_locked_config_store_notifies_listeners(void)
+{
+    MockConfigStore inner;
+    LockedConfigStore store(inner);
+    int first = 0;
+    int second = 0;
+    TEST_ASSERT_TRUE(store.subscribe([&first] { ++first; }));
+    TEST_ASSERT_TRUE(store.subscribe([&second] { ++second; }));
+
+    TEST_ASSERT_TRUE(store.setSensorReadIntervalMs(1500));
+    TEST_ASSERT_EQUAL(1, first);
+    TEST_ASSERT_EQUAL(1, second);
+
+    // Rejections and persistence failures change nothing: no notification.
+    TEST_ASSERT_FALSE(store.setSensorReadIntervalMs(10));
+    inner.failWrites = true;
+    TEST_ASSERT_FALSE(store.setWateringEnabled(false));
+    TEST_ASSERT_FALSE(store.factoryReset());
+    inner.failWrites = false;
+    TEST_ASSERT_EQUAL(1, first);
+
+    // One patch is one notification, however many items it carries.
+    ConfigPatch patch;
+    patch.wateringDurationS = 45;
+    patch.minWateringIntervalS = 600;
+    TEST_ASSERT_TRUE(store.apply(patch));
+    TEST_ASSERT_TRUE(store.factoryReset());
+    TEST_ASSERT_EQUAL(3, first);
+    TEST_ASSERT_EQUAL(3, second);
+
+    // A listener may read the store: it runs outside the lock.
+    uint32_t seenInterval = 0;
+    TEST_ASSERT_TRUE(store.subscribe(
+        [&store, &seenInterval] { seenInterval = store.getSensorReadIntervalMs(); }));
+    TEST_ASSERT_TRUE(store.setSensorReadIntervalMs(2500));
+    TEST_ASSERT_EQUAL_UINT32(2500, seenInterval);
+
+    // The table is fixed-size.
+    TEST_ASSERT_TRUE(store.subscribe([] {}));
+    TEST_ASSERT_FALSE(store.subscribe([] {}));
+    TEST_ASSERT_FALSE(store.subscribe(nullptr));
+}
+
+// ---------------------------------------------------------------------------
+// Lock-free reads: the wrapper's getters serve the snapshot its last write
+// published, and a reader racing a writer never sees a torn one.
+// ---------------------------------------------------------------------------
+static void test_locked_config_store_serves_published_snapshot(void)
+{
+    MockConfigStore inner;
+    inner.stored.wateringDurationS = 40;  // before wrapping: published
+    LockedConfigStore store(inner);
+    TEST_ASSERT_EQUAL_UINT32(40, store.getWateringDurationS());
+    TEST_ASSERT_EQUAL_UINT32(40, store.snapshot().wateringDurationS);
+
+    inner.stored.wateringDurationS = 50;  // behind the wrapper: not seen
+    TEST_ASSERT_EQUAL_UINT32(40, store.getWateringDurationS());
+
+    // Any write republishes, a rejected one included.
+    TEST_ASSERT_FALSE(store.setSensorReadIntervalMs(10));
+    TEST_ASSERT_EQUAL_UINT32(50, store.getWateringDurationS());
+    TEST_ASSERT_TRUE(store.setMetricLogPolicy(metric::kSoilEc, {0.5f, 0.0f, 600}));
+    const ConfigSnapshot snap = store.snapshot();
+    TEST_ASSERT_EQUAL_UINT32(600, snap.logPolicies[metric::kSoilEc].heartbeatS);
+    TEST_ASSERT_EQUAL_UINT32(600, store.getMetricLogPolicy(metric::kSoilEc).heartbeatS);
+    TEST_ASSERT_EQUAL_UINT32(0, store.getMetricLogPolicy(metric::kKnownCount).heartbeatS);
+    TEST_ASSERT_EQUAL_FLOAT(inner.getMoistureThresholdLow(), snap.moistureThresholdLow);
+    TEST_ASSERT_EQUAL(inner.getWateringEnabled(), snap.wateringEnabled);
+}
+
+static void test_seqlock_reader_never_sees_a_torn_value(void)
+{
+    // Every store writes one counter to all words; a mixed copy is torn.
+    struct Pair {
+        uint32_t a;
+        uint32_t b[15];
+    };
+    Seqlock<Pair> lock(Pair{0, {}});
+    std::atomic<bool> done{false};
+    std::thread writer([&] {
+        Pair p{};
+        for (uint32_t i = 1; i <= 20000; ++i) {
+            p.a = i;
+            for (uint32_t& word : p.b) {
+                word = i;
+            }
+            lock.store(p);
+        }
+        done = true;
+    });
+
+    uint32_t torn = 0;
+    while (!done) {
+        Pair p{};
+        if (lock.tryLoad(p)) {
+            for (uint32_t word : p.b) {
+                torn += word != p.a ? 1 : 0;
+            }
+        }
+    }
+    writer.join();
+
+    TEST_ASSERT_EQUAL_UINT32(0, torn);
+    Pair last{};
+    TEST_ASSERT_TRUE(lock.tryLoad(last));
+    TEST_ASSERT_EQUAL_UINT32(20000, last.a);
+    TEST_ASSERT_EQUAL_UINT32(20000, last.b[14]);
+}
+
 // ---------------------------------------------------------------------------
 // T028 — LockedConfigStore decorator delegates the full contract path
 // unchanged (the wrapper adds task-level mutex serialization; see
@@ -561,11 +988,24 @@ void run_config_store_tests(void)
     RUN_TEST(test_boundary_values_accepted);
     RUN_TEST(test_rejected_write_leaves_stored_value);
     RUN_TEST(test_out_of_range_stored_values_shadowed);
+    RUN_TEST(test_getters_serve_the_load_time_cache);
     RUN_TEST(test_factory_reset_restores_defaults);
     RUN_TEST(test_credential_set_and_clear);
     RUN_TEST(test_credentials_never_logged);
     RUN_TEST(test_mock_defaults_roundtrip_rejection);
     RUN_TEST(test_mock_shadowing_factory_reset_and_fail_writes);
+    // Per-metric change-only log policies.
+    RUN_TEST(test_log_policy_round_trip_and_rejects);
+    RUN_TEST(test_modbus_baud_round_trip_and_rejects);
+    RUN_TEST(test_static_ip_round_trip_and_rejects);
+    RUN_TEST(test_httpd_settings_round_trip_and_presets);
+    RUN_TEST(test_apply_patch_all_or_nothing);
+    // Config change notification (generation + listeners).
+    RUN_TEST(test_generation_moves_on_successful_writes_only);
+    RUN_TEST(test_locked_config_store_notifies_listeners);
+    // Lock-free snapshot reads (seqlock).
+    RUN_TEST(test_locked_config_store_serves_published_snapshot);
+    RUN_TEST(test_seqlock_reader_never_sees_a_torn_value);
     // T028 — Locked* decorator (FR-013).
     RUN_TEST(test_locked_config_store_delegates_full_contract);
     RUN_TEST(test_locked_config_store_over_real_store);
@@ -0,0 +1,143 @@
+// SPDX-FileCopyrightText: 2026 Cryptotomte
+// SPDX-License-Identifier: AGPL-3.0-or-later
+/**
+ * @file test_csv_export.cpp
+ * @brief Host suite for the GET /api/v1/export.csv merge (api/CsvExport.h).
+ *
+ * Registered by test_main.cpp via run_csv_export_tests(). Rows merge the
+ * metrics by epoch with empty cells for the missing ones; the window
+ * bounds the rows; a long series is read a batch per storage pass, and
+ * the body does not depend on how large the reads of it are.
+ */
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include "unity.h"
+
+#include "api/CsvExport.h"
+#include "storage/testing/MockDataStorage.h"
+
+namespace {
+
+using api::CsvExportSource;
+
+/// Counts the storage passes the export makes.
+class CountingStorage final : public MockDataStorage {
+public:
+    std::size_t forEachReading(const std::string& metric, uint32_t t0, uint32_t t1,
+                               IReadingVisitor& visitor) const override
+    {
+        ++passes;
+        return MockDataStorage::forEachReading(metric, t0, t1, visitor);
+    }
+    mutable std::size_t passes = 0;
+};
+
+/// The whole body, read @p step bytes at a time.
+std::string drain(CsvExportSource& source, std::size_t step)
+{
+    std::string body;
+    std::vector<uint8_t> buf(step);
+    for (;;) {
+        const int n = source.receive(buf.data(), buf.size());
+        TEST_ASSERT_TRUE(n >= 0);
+        if (n == 0) {
+            return body;
+        }
+        body.append(reinterpret_cast<const char*>(buf.data()), static_cast<std::size_t>(n));
+    }
+}
+
+std::size_t countLines(const std::string& body)
+{
+    std::size_t lines = 0;
+    for (std::size_t at = body.find("\r\n"); at != std::string::npos;
+         at = body.find("\r\n", at + 2)) {
+        ++lines;
+    }
+    return lines;
+}
+
+void test_rows_merge_metrics_by_epoch(void)
+{
+    MockDataStorage storage;
+    storage.storeSensorReading("soil_moisture", 60, 41.5f);
+    storage.storeSensorReading("soil_moisture", 120, 41.25f);
+    storage.storeSensorReading("soil_moisture", 180, 40.0f);
+    storage.storeSensorReading("env_temperature", 120, 21.3f);
+    storage.storeSensorReading("env_temperature", 86400 + 240, -2.0f);
+
+    CsvExportSource source(storage, {"soil_moisture", "env_temperature", "env_pressure"}, 0,
+                           UINT32_MAX);
+    TEST_ASSERT_EQUAL_STRING("epoch,time,soil_moisture,env_temperature,env_pressure\r\n"
+                             "60,1970-01-01T00:01:00Z,41.5,,\r\n"
+                             "120,1970-01-01T00:02:00Z,41.25,21.3,\r\n"
+                             "180,1970-01-01T00:03:00Z,40,,\r\n"
+                             "86640,1970-01-02T00:04:00Z,,-2,\r\n",
+                             drain(source, 1024).c_str());
+    TEST_ASSERT_EQUAL_UINT32(4, source.rows());
+}
+
+void test_window_bounds_rows_and_repeats_take_a_row_each(void)
+{
+    MockDataStorage storage;
+    for (uint32_t i = 0; i < 10; ++i) {
+        storage.storeSensorReading("soil_moisture", 1000 + i * 60, static_cast<float>(i));
+    }
+    storage.storeSensorReading("soil_moisture", 1000 + 9 * 60, 99.0f);  // same epoch again
+
+    CsvExportSource window(storage, {"soil_moisture"}, 1000 + 2 * 60, 1000 + 4 * 60);
+    const std::string body = drain(window, 1024);
+    TEST_ASSERT_EQUAL_size_t(4, countLines(body));
+    TEST_ASSERT_TRUE(body.find("\r\n1120,") != std::string::npos);
+    TEST_ASSERT_TRUE(body.find("1300,") == std::string::npos);
+
+    CsvExportSource tail(storage, {"soil_moisture"}, 1000 + 9 * 60, UINT32_MAX);
+    TEST_ASSERT_EQUAL_STRING("epoch,time,soil_moisture\r\n"
+                             "1540,1970-01-01T00:25:40Z,9\r\n"
+                             "1540,1970-01-01T00:25:40Z,99\r\n",
+                             drain(tail, 1024).c_str());
+
+    CsvExportSource empty(storage, {"env_humidity"}, 0, UINT32_MAX);
+    TEST_ASSERT_EQUAL_STRING("epoch,time,env_humidity\r\n", drain(empty, 1024).c_str());
+    TEST_ASSERT_EQUAL_UINT32(0, empty.rows());
+}
+
+void test_long_series_reads_a_batch_per_pass(void)
+{
+    CountingStorage storage;
+    constexpr uint32_t kReadings = 1000;
+    for (uint32_t i = 0; i < kReadings; ++i) {
+        storage.storeSensorReading("soil_moisture", 1000 + i * 60, static_cast<float>(i % 50));
+        if (i % 2 == 0) {
+            storage.storeSensorReading("env_temperature", 1000 + i * 60 + 30, 20.0f);
+        }
+    }
+
+    CsvExportSource whole(storage, {"soil_moisture", "env_temperature"}, 0, UINT32_MAX);
+    const std::string body = drain(whole, 4096);
+    TEST_ASSERT_EQUAL_UINT32(kReadings + kReadings / 2, whole.rows());
+    TEST_ASSERT_EQUAL_size_t(1 + kReadings + kReadings / 2, countLines(body));
+    // A pass per batch per metric (and one finding a stream's end), not
+    // one per reading.
+    const std::size_t batches = (kReadings + CsvExportSource::kBatchReadings - 1) /
+                                    CsvExportSource::kBatchReadings +
+                                (kReadings / 2 + CsvExportSource::kBatchReadings - 1) /
+                                    CsvExportSource::kBatchReadings;
+    TEST_ASSERT_TRUE(storage.passes <= batches + 2);
+
+    // Byte-sized reads give the same body.
+    CsvExportSource bytewise(storage, {"soil_moisture", "env_temperature"}, 0, UINT32_MAX);
+    TEST_ASSERT_TRUE(body == drain(bytewise, 1));
+}
+
+}  // namespace
+
+void run_csv_export_tests(void)
+{
+    RUN_TEST(test_rows_merge_metrics_by_epoch);
+    RUN_TEST(test_window_bounds_rows_and_repeats_take_a_row_each);
+    RUN_TEST(test_long_series_reads_a_batch_per_pass);
+}
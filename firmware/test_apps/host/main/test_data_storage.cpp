@@ -17,17 +17,35 @@
 #include <sys/stat.h>
 #include <unistd.h>
 
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cmath>
 #include <cstdint>
 #include <cstdio>
 #include <cstring>
+#include <functional>
 #include <string>
+#include <thread>
+#include <utility>
 #include <vector>
 
 #include "unity.h"
 
+#include "alloc_tracker.h"
+
+#include "actuators/testing/FakeTimeProvider.h"
+#include "interfaces/EventCodec.h"
 #include "interfaces/IDataStorage.h"
+#include "interfaces/MetricRegistry.h"
+#include "interfaces/QuantileSketch.h"
+#include "storage/DeltaChunkCodec.h"
+#include "storage/HistoryRollup.h"
+#include "storage/LegacyHistoryImport.h"
 #include "storage/LittleFsDataStorage.h"
 #include "storage/LockedDataStorage.h"
+#include "storage/QueuedDataStorage.h"
+#include "storage/RetentionPlan.h"
 #include "storage/testing/MockDataStorage.h"
 
 namespace {
@@ -116,73 +134,105 @@ void appendGarbage(const std::string& path, std::size_t bytes)
     TEST_ASSERT_EQUAL_INT(0, std::fclose(file));
 }
 
-// --- T018: range-query semantics (FR-009) -------------------------------
-
-void test_query_is_chronological_and_inclusive(void)
+/// Overwrite one byte of an existing file in place.
+void overwriteByte(const std::string& path, long offset, uint8_t byte)
 {
-    TempDir dir;
-    LittleFsDataStorage storage(dir.path());
-
-    TEST_ASSERT_TRUE(storage.storeSensorReading("soil_moisture", 100, 1.0f));
-    TEST_ASSERT_TRUE(storage.storeSensorReading("soil_moisture", 200, 2.0f));
-    TEST_ASSERT_TRUE(storage.storeSensorReading("soil_moisture", 300, 3.0f));
-    TEST_ASSERT_TRUE(storage.storeSensorReading("soil_moisture", 400, 4.0f));
+    FILE* file = std::fopen(path.c_str(), "r+b");
+    TEST_ASSERT_NOT_NULL(file);
+    TEST_ASSERT_EQUAL_INT(0, std::fseek(file, offset, SEEK_SET));
+    TEST_ASSERT_EQUAL_size_t(1, std::fwrite(&byte, 1, 1, file));
+    TEST_ASSERT_EQUAL_INT(0, std::fclose(file));
+}
 
-    // Both bounds inclusive, results in chronological order.
-    const auto mid = storage.getSensorReadings("soil_moisture", 200, 300);
-    TEST_ASSERT_EQUAL_size_t(2, mid.size());
-    TEST_ASSERT_EQUAL_UINT32(200, mid[0].epoch);
-    TEST_ASSERT_EQUAL_FLOAT(2.0f, mid[0].value);
-    TEST_ASSERT_EQUAL_STRING("soil_moisture", mid[0].metric.c_str());
-    TEST_ASSERT_EQUAL_UINT32(300, mid[1].epoch);
-    TEST_ASSERT_EQUAL_FLOAT(3.0f, mid[1].value);
+/// Every history layout and codec the options select, stateless and with
+/// the chunk index cached: the IDataStorage contract holds for each.
+std::vector<LittleFsDataStorageOptions> everyHistoryLayout()
+{
+    std::vector<LittleFsDataStorageOptions> layouts(6);
+    layouts[1].cacheChunkIndex = true;
+    layouts[2].historyCodec = HistoryCodec::Delta;
+    layouts[3].historyCodec = HistoryCodec::Delta;
+    layouts[3].cacheChunkIndex = true;
+    layouts[4].historyFormat = HistoryFormat::Rows;
+    layouts[4].cacheChunkIndex = true;
+    layouts[5].historyFormat = HistoryFormat::Multiplexed;
+    layouts[5].cacheChunkIndex = true;
+    return layouts;
+}
 
-    // Degenerate single-point range still matches inclusively.
-    const auto point = storage.getSensorReadings("soil_moisture", 400, 400);
-    TEST_ASSERT_EQUAL_size_t(1, point.size());
-    TEST_ASSERT_EQUAL_UINT32(400, point[0].epoch);
+// --- T018: range-query semantics (FR-009) -------------------------------
 
-    const auto all = storage.getSensorReadings("soil_moisture", 0, UINT32_MAX);
-    TEST_ASSERT_EQUAL_size_t(4, all.size());
-    for (std::size_t i = 1; i < all.size(); ++i) {
-        TEST_ASSERT_TRUE(all[i - 1].epoch < all[i].epoch);
+void test_query_is_chronological_and_inclusive(void)
+{
+    for (const LittleFsDataStorageOptions& options : everyHistoryLayout()) {
+        TempDir dir;
+        LittleFsDataStorage storage(dir.path(), nullptr, options);
+
+        TEST_ASSERT_TRUE(storage.storeSensorReading("soil_moisture", 100, 1.0f));
+        TEST_ASSERT_TRUE(storage.storeSensorReading("soil_moisture", 200, 2.0f));
+        TEST_ASSERT_TRUE(storage.storeSensorReading("soil_moisture", 300, 3.0f));
+        TEST_ASSERT_TRUE(storage.storeSensorReading("soil_moisture", 400, 4.0f));
+
+        // Both bounds inclusive, results in chronological order.
+        const auto mid = storage.getSensorReadings("soil_moisture", 200, 300);
+        TEST_ASSERT_EQUAL_size_t(2, mid.size());
+        TEST_ASSERT_EQUAL_UINT32(200, mid[0].epoch);
+        TEST_ASSERT_EQUAL_FLOAT(2.0f, mid[0].value);
+        TEST_ASSERT_EQUAL_STRING("soil_moisture", mid[0].metric.c_str());
+        TEST_ASSERT_EQUAL_UINT32(300, mid[1].epoch);
+        TEST_ASSERT_EQUAL_FLOAT(3.0f, mid[1].value);
+
+        // Degenerate single-point range still matches inclusively.
+        const auto point = storage.getSensorReadings("soil_moisture", 400, 400);
+        TEST_ASSERT_EQUAL_size_t(1, point.size());
+        TEST_ASSERT_EQUAL_UINT32(400, point[0].epoch);
+
+        const auto all = storage.getSensorReadings("soil_moisture", 0, UINT32_MAX);
+        TEST_ASSERT_EQUAL_size_t(4, all.size());
+        for (std::size_t i = 1; i < all.size(); ++i) {
+            TEST_ASSERT_TRUE(all[i - 1].epoch < all[i].epoch);
+        }
     }
 }
 
 void test_query_empty_never_an_error(void)
 {
-    TempDir dir;
-    LittleFsDataStorage storage(dir.path());
+    for (const LittleFsDataStorageOptions& options : everyHistoryLayout()) {
+        TempDir dir;
+        LittleFsDataStorage storage(dir.path(), nullptr, options);
 
-    // No data at all (not even the /hist directory).
-    TEST_ASSERT_TRUE(storage.getSensorReadings("soil_moisture", 0, 100).empty());
+        // No data at all (not even the /hist directory).
+        TEST_ASSERT_TRUE(storage.getSensorReadings("soil_moisture", 0, 100).empty());
 
-    TEST_ASSERT_TRUE(storage.storeSensorReading("soil_moisture", 100, 1.0f));
+        TEST_ASSERT_TRUE(storage.storeSensorReading("soil_moisture", 100, 1.0f));
 
-    // Unknown metric.
-    TEST_ASSERT_TRUE(
-        storage.getSensorReadings("env_temperature", 0, 1000).empty());
-    // t0 > t1.
-    TEST_ASSERT_TRUE(storage.getSensorReadings("soil_moisture", 200, 100).empty());
-    // Valid range containing no records.
-    TEST_ASSERT_TRUE(storage.getSensorReadings("soil_moisture", 101, 999).empty());
+        // Unknown metric.
+        TEST_ASSERT_TRUE(
+            storage.getSensorReadings("env_temperature", 0, 1000).empty());
+        // t0 > t1.
+        TEST_ASSERT_TRUE(storage.getSensorReadings("soil_moisture", 200, 100).empty());
+        // Valid range containing no records.
+        TEST_ASSERT_TRUE(storage.getSensorReadings("soil_moisture", 101, 999).empty());
+    }
 }
 
 void test_unsafe_metric_names_rejected(void)
 {
-    TempDir dir;
-    LittleFsDataStorage storage(dir.path());
-
-    // Metric names become directory names: empty, '/' and ".." are unsafe.
-    const char* bad[] = {"", "a/b", "..", "a..b", "/abs"};
-    for (const char* name : bad) {
-        TEST_ASSERT_FALSE_MESSAGE(storage.storeSensorReading(name, 100, 1.0f),
-                                  name);
-        TEST_ASSERT_TRUE_MESSAGE(
-            storage.getSensorReadings(name, 0, UINT32_MAX).empty(), name);
+    for (const LittleFsDataStorageOptions& options : everyHistoryLayout()) {
+        TempDir dir;
+        LittleFsDataStorage storage(dir.path(), nullptr, options);
+
+        // Metric names become directory names: empty, '/' and ".." are unsafe.
+        const char* bad[] = {"", "a/b", "..", "a..b", "/abs"};
+        for (const char* name : bad) {
+            TEST_ASSERT_FALSE_MESSAGE(storage.storeSensorReading(name, 100, 1.0f),
+                                      name);
+            TEST_ASSERT_TRUE_MESSAGE(
+                storage.getSensorReadings(name, 0, UINT32_MAX).empty(), name);
+        }
+        // A rejected name must not consume a metric-directory slot.
+        TEST_ASSERT_TRUE(listDir(dir.path() + "/hist").empty());
     }
-    // A rejected name must not consume a metric-directory slot.
-    TEST_ASSERT_TRUE(listDir(dir.path() + "/hist").empty());
 }
 
 // --- T018: MockDataStorage contract conformance (FR-012) ----------------
@@ -317,7 +367,7 @@ void test_non_monotonic_epoch_bumps_chunk_name(void)
 
     // The successor chunk's name = its first record's epoch. Feed an epoch
     // EARLIER than the sealed chunk's first epoch: the chunk name must be
-    // bumped past the sealed one (LittleFsDataStorage.cpp:268-272) so names
+    // bumped past the sealed one (LittleFsDataStorage::writeRecords) so names
     // stay strictly increasing — no collision with the existing chunk.
     const uint32_t earlier = base - 500;
     TEST_ASSERT_TRUE(storage.storeSensorReading(metric, earlier, 7.0f));
@@ -490,7 +540,15 @@ void test_torn_tail_repaired_before_append(void)
 
 // --- T023: event log (FR-011, storeEvent/getEvents contract) -------------
 
-std::string eventFileOf(const TempDir& dir, int index)
+/// Event segment file of `slot` (the segment with sequence q is in slot
+/// q % segments).
+std::string eventFileOf(const TempDir& dir, int slot)
+{
+    return dir.path() + "/events/s" + std::to_string(slot) + ".log";
+}
+
+/// File of the two-file event log older firmware wrote.
+std::string legacyEventFileOf(const TempDir& dir, int index)
 {
     return dir.path() + "/events/" + std::to_string(index) + ".log";
 }
@@ -518,22 +576,30 @@ void appendBytes(const std::string& path, const uint8_t* bytes,
     TEST_ASSERT_EQUAL_INT(0, std::fclose(file));
 }
 
-/// 9-byte detail encoding `index`: every framed record is then exactly
-/// 16 bytes, so one event file holds exactly 1024 records and the
-/// rotation boundary lands on a precise event index.
-constexpr std::size_t kFixedDetailBytes = 9;
+/// The default event ring (LittleFsDataStorageOptions): 8 segments of
+/// 4 KiB.
+constexpr std::size_t kEventSegments = 8;
+constexpr std::size_t kEventSegmentBytes = 32768 / kEventSegments;
+constexpr std::size_t kSegmentHeaderBytes =
+    LittleFsDataStorage::kEventSegmentHeaderBytes;
+
+/// 8-byte detail encoding `index`: every framed record is then exactly
+/// 16 bytes, so one segment holds exactly 255 records and the rotation
+/// boundary lands on a precise event index.
+constexpr std::size_t kFixedDetailBytes = 8;
 constexpr std::size_t kFixedRecordBytes =
-    LittleFsDataStorage::kEventHeaderBytes + kFixedDetailBytes;  // 16
-constexpr std::size_t kEventsPerFile =
-    LittleFsDataStorage::kEventFileMaxBytes / kFixedRecordBytes;  // 1024
-static_assert(kEventsPerFile * kFixedRecordBytes ==
-                  LittleFsDataStorage::kEventFileMaxBytes,
-              "fixed-size events must fill an event file exactly");
+    LittleFsDataStorage::kEventHeaderBytes + kFixedDetailBytes +
+    LittleFsDataStorage::kEventTrailerBytes;  // 16
+constexpr std::size_t kEventsPerSegment =
+    (kEventSegmentBytes - kSegmentHeaderBytes) / kFixedRecordBytes;  // 255
+constexpr long kFullSegmentBytes =
+    static_cast<long>(kSegmentHeaderBytes + kEventsPerSegment * kFixedRecordBytes);
+constexpr std::size_t kRingEvents = kEventSegments * kEventsPerSegment;
 
 std::string fixedDetail(std::size_t index)
 {
     char buf[16];
-    std::snprintf(buf, sizeof(buf), "%09lu",
+    std::snprintf(buf, sizeof(buf), "%08lu",
                   static_cast<unsigned long>(index));
     return std::string(buf, kFixedDetailBytes);
 }
@@ -563,11 +629,14 @@ void test_event_framing_round_trip(void)
     TEST_ASSERT_TRUE(storage.storeEvent(
         0x11223344u, IDataStorage::kCategoryConnectivity, "abc"));
 
-    // On-disk frame (data-model.md): marker 0xE7, uint32 LE epoch,
-    // uint8 category, uint8 detail_len, detail bytes. Fresh log -> 0.log.
+    // On-disk layout (data-model.md): the segment header ("WSES", uint32
+    // LE sequence), then the frame: marker 0xE8, uint32 LE epoch, uint8
+    // category, uint8 detail_len, detail bytes, uint8 frame_len. Fresh
+    // log -> segment 0 in slot 0.
     const auto raw = readAll(eventFileOf(dir, 0));
-    const uint8_t expected[] = {0xE7, 0x44, 0x33, 0x22, 0x11,
-                                0x03, 0x03, 'a',  'b',  'c'};
+    const uint8_t expected[] = {'W',  'S',  'E',  'S',  0x00, 0x00, 0x00,
+                                0x00, 0xE8, 0x44, 0x33, 0x22, 0x11, 0x03,
+                                0x03, 'a',  'b',  'c',  0x0B};
     TEST_ASSERT_EQUAL_size_t(sizeof(expected), raw.size());
     TEST_ASSERT_EQUAL_UINT8_ARRAY(expected, raw.data(), sizeof(expected));
 
@@ -625,10 +694,13 @@ void test_event_detail_truncated_not_rejected(void)
 
     // The on-disk detail_len byte is the truncated length.
     const auto raw = readAll(eventFileOf(dir, 0));
-    TEST_ASSERT_EQUAL_size_t(LittleFsDataStorage::kEventHeaderBytes +
-                                 IDataStorage::kEventDetailMaxLen,
+    TEST_ASSERT_EQUAL_size_t(kSegmentHeaderBytes +
+                                 LittleFsDataStorage::kEventHeaderBytes +
+                                 IDataStorage::kEventDetailMaxLen +
+                                 LittleFsDataStorage::kEventTrailerBytes,
                              raw.size());
-    TEST_ASSERT_EQUAL_UINT8(IDataStorage::kEventDetailMaxLen, raw[6]);
+    TEST_ASSERT_EQUAL_UINT8(IDataStorage::kEventDetailMaxLen,
+                            raw[kSegmentHeaderBytes + 6]);
 
     // An exactly-120-byte detail is kept whole.
     const std::string maxDetail(IDataStorage::kEventDetailMaxLen, 'y');
@@ -666,40 +738,42 @@ void test_event_rotation_drops_oldest_never_newest(void)
     TempDir dir;
     LittleFsDataStorage storage(dir.path());
     const uint32_t base = 1000000;
+    TEST_ASSERT_EQUAL_size_t(kEventSegments, LittleFsDataStorageOptions{}.eventSegments);
 
-    // Fill 0.log exactly (1024 records x 16 bytes); 1.log not yet created.
-    appendEvents(storage, base, 0, kEventsPerFile);
-    TEST_ASSERT_EQUAL_INT(
-        static_cast<int>(LittleFsDataStorage::kEventFileMaxBytes),
-        static_cast<int>(sizeOf(eventFileOf(dir, 0))));
+    // Fill segment 0 exactly (header + 255 records x 16 bytes); no other
+    // segment yet.
+    appendEvents(storage, base, 0, kEventsPerSegment);
+    TEST_ASSERT_EQUAL_INT(kFullSegmentBytes, sizeOf(eventFileOf(dir, 0)));
     TEST_ASSERT_EQUAL_size_t(1, listDir(dir.path() + "/events").size());
 
-    // The next append would exceed the cap -> switches to 1.log; the full
-    // file is left intact (nothing dropped yet).
-    appendEvents(storage, base, kEventsPerFile, 1);
-    TEST_ASSERT_EQUAL_INT(static_cast<int>(kFixedRecordBytes),
+    // The next append would overflow it -> segment 1 starts in slot 1;
+    // the full segment is left intact (nothing dropped yet).
+    appendEvents(storage, base, kEventsPerSegment, 1);
+    TEST_ASSERT_EQUAL_INT(static_cast<int>(kSegmentHeaderBytes + kFixedRecordBytes),
                           static_cast<int>(sizeOf(eventFileOf(dir, 1))));
-    TEST_ASSERT_EQUAL_INT(
-        static_cast<int>(LittleFsDataStorage::kEventFileMaxBytes),
-        static_cast<int>(sizeOf(eventFileOf(dir, 0))));
-
-    // Fill 1.log; the following append truncates 0.log (the oldest half)
-    // and starts over there.
-    appendEvents(storage, base, kEventsPerFile + 1, kEventsPerFile - 1);
-    TEST_ASSERT_EQUAL_INT(
-        static_cast<int>(LittleFsDataStorage::kEventFileMaxBytes),
-        static_cast<int>(sizeOf(eventFileOf(dir, 1))));
-    appendEvents(storage, base, 2 * kEventsPerFile, 1);
-    TEST_ASSERT_EQUAL_INT(static_cast<int>(kFixedRecordBytes),
-                          static_cast<int>(sizeOf(eventFileOf(dir, 0))));
+    TEST_ASSERT_EQUAL_INT(kFullSegmentBytes, sizeOf(eventFileOf(dir, 0)));
+
+    // Fill every slot; the following append wraps: segment 8 replaces
+    // segment 0, the oldest, and only that one.
+    appendEvents(storage, base, kEventsPerSegment + 1,
+                 kRingEvents - kEventsPerSegment - 1);
+    TEST_ASSERT_EQUAL_size_t(kEventSegments, listDir(dir.path() + "/events").size());
+    appendEvents(storage, base, kRingEvents, 1);
+    const auto wrapped = readAll(eventFileOf(dir, 0));
+    TEST_ASSERT_EQUAL_size_t(kSegmentHeaderBytes + kFixedRecordBytes, wrapped.size());
+    TEST_ASSERT_EQUAL_UINT8(kEventSegments, wrapped[4]);  // sequence 8, LE
+    for (std::size_t slot = 1; slot < kEventSegments; ++slot) {
+        TEST_ASSERT_EQUAL_INT(kFullSegmentBytes,
+                              sizeOf(eventFileOf(dir, static_cast<int>(slot))));
+    }
 
-    // The oldest half (indices 0..1023) is gone; everything newer is
+    // The oldest segment (indices 0..254) is gone; everything newer is
     // intact and newest-first, the newest record always retained.
-    const auto events = storage.getEvents(4 * kEventsPerFile);
-    TEST_ASSERT_EQUAL_size_t(kEventsPerFile + 1, events.size());
-    TEST_ASSERT_EQUAL_UINT32(base + 2 * static_cast<uint32_t>(kEventsPerFile),
+    const auto events = storage.getEvents(SIZE_MAX);
+    TEST_ASSERT_EQUAL_size_t(kRingEvents - kEventsPerSegment + 1, events.size());
+    TEST_ASSERT_EQUAL_UINT32(base + static_cast<uint32_t>(kRingEvents),
                              events.front().epoch);
-    TEST_ASSERT_EQUAL_UINT32(base + static_cast<uint32_t>(kEventsPerFile),
+    TEST_ASSERT_EQUAL_UINT32(base + static_cast<uint32_t>(kEventsPerSegment),
                              events.back().epoch);
     for (std::size_t i = 1; i < events.size(); ++i) {
         TEST_ASSERT_TRUE(events[i - 1].epoch > events[i].epoch);
@@ -712,9 +786,9 @@ void test_event_burst_stays_within_budget(void)
     LittleFsDataStorage storage(dir.path());
     const uint32_t base = 2000;
 
-    // Burst of 3000 events with every detail length 0..120: several
-    // rotations; no append may fail (contract: never rejected at the
-    // bound) and the two files stay within the 32 KiB total budget.
+    // Burst of 3000 events with every detail length 0..120: the ring
+    // wraps several times; no append may fail (contract: never rejected
+    // at the bound) and the segments stay within the 32 KiB budget.
     constexpr std::size_t kBurst = 3000;
     std::size_t failures = 0;
     for (std::size_t i = 0; i < kBurst; ++i) {
@@ -727,15 +801,21 @@ void test_event_burst_stays_within_budget(void)
     }
     TEST_ASSERT_EQUAL_size_t(0, failures);
 
-    const long size0 = sizeOf(eventFileOf(dir, 0));
-    const long size1 = sizeOf(eventFileOf(dir, 1));
-    TEST_ASSERT_TRUE(
-        size0 <= static_cast<long>(LittleFsDataStorage::kEventFileMaxBytes));
-    TEST_ASSERT_TRUE(
-        size1 <= static_cast<long>(LittleFsDataStorage::kEventFileMaxBytes));
-    TEST_ASSERT_TRUE(
-        size0 + size1 <=
-        2 * static_cast<long>(LittleFsDataStorage::kEventFileMaxBytes));
+    TEST_ASSERT_EQUAL_size_t(kEventSegments, listDir(dir.path() + "/events").size());
+    long total = 0;
+    for (std::size_t slot = 0; slot < kEventSegments; ++slot) {
+        const long size = sizeOf(eventFileOf(dir, static_cast<int>(slot)));
+        TEST_ASSERT_TRUE(size <= static_cast<long>(kEventSegmentBytes));
+        total += size;
+    }
+    TEST_ASSERT_TRUE(total <= static_cast<long>(kEventSegments * kEventSegmentBytes));
+    // A rotation drops one segment, never half the log: the sealed
+    // segments each lack less than one largest frame.
+    const long largestFrame = static_cast<long>(
+        LittleFsDataStorage::kEventHeaderBytes + IDataStorage::kEventDetailMaxLen +
+        LittleFsDataStorage::kEventTrailerBytes);
+    TEST_ASSERT_TRUE(total > static_cast<long>(kEventSegments - 1) *
+                                 (static_cast<long>(kEventSegmentBytes) - largestFrame));
 
     // The newest record survived every rotation.
     const auto newest = storage.getEvents(1);
@@ -744,6 +824,35 @@ void test_event_burst_stays_within_budget(void)
                              newest[0].epoch);
 }
 
+void test_event_segments_follow_the_budget(void)
+{
+    // 1 KiB in 4 segments of 256 bytes; a single segment is raised to two.
+    for (const std::size_t segments : {std::size_t{4}, std::size_t{1}}) {
+        TempDir dir;
+        LittleFsDataStorageOptions options;
+        options.eventLogBytes = 1024;
+        options.eventSegments = segments;
+        LittleFsDataStorage storage(dir.path(), nullptr, options);
+        appendEvents(storage, 7000, 0, 200);
+
+        const std::size_t slots = segments < 2 ? 2 : segments;
+        const long segmentBytes = static_cast<long>(1024 / slots);
+        TEST_ASSERT_EQUAL_size_t(slots, listDir(dir.path() + "/events").size());
+        for (std::size_t slot = 0; slot < slots; ++slot) {
+            TEST_ASSERT_TRUE(sizeOf(eventFileOf(dir, static_cast<int>(slot))) <=
+                             segmentBytes);
+        }
+        const auto events = storage.getEvents(SIZE_MAX);
+        TEST_ASSERT_EQUAL_UINT32(7000 + 199, events.front().epoch);
+        // The sealed segments are full, the active one holds the rest.
+        const std::size_t perSegment =
+            (static_cast<std::size_t>(segmentBytes) - kSegmentHeaderBytes) /
+            kFixedRecordBytes;
+        TEST_ASSERT_EQUAL_size_t((slots - 1) * perSegment + 200 % perSegment,
+                                 events.size());
+    }
+}
+
 void test_event_torn_tail_skipped_and_repaired(void)
 {
     TempDir dir;
@@ -770,7 +879,8 @@ void test_event_torn_tail_skipped_and_repaired(void)
     TEST_ASSERT_TRUE(storage.storeEvent(300, IDataStorage::kCategoryOta,
                                         "three"));
     TEST_ASSERT_EQUAL_INT(
-        static_cast<int>(valid + LittleFsDataStorage::kEventHeaderBytes + 5),
+        static_cast<int>(valid + LittleFsDataStorage::kEventHeaderBytes + 5 +
+                         LittleFsDataStorage::kEventTrailerBytes),
         static_cast<int>(sizeOf(active)));
     events = storage.getEvents(10);
     TEST_ASSERT_EQUAL_size_t(3, events.size());
@@ -807,28 +917,39 @@ void test_event_active_file_detected_after_restart(void)
     const uint32_t base = 5000000;
 
     {
-        // First life: rotate into 1.log and leave 5 records there.
+        // First life: rotate into segment 1 and leave 5 records there.
         LittleFsDataStorage first(dir.path());
-        appendEvents(first, base, 0, kEventsPerFile + 5);
+        appendEvents(first, base, 0, kEventsPerSegment + 5);
     }
 
-    // Restart: a new instance must derive the active file (1.log) from
-    // the files alone and append there — no spurious rotation that would
-    // truncate the full 0.log.
-    LittleFsDataStorage second(dir.path());
-    appendEvents(second, base, kEventsPerFile + 5, 1);
-    TEST_ASSERT_EQUAL_INT(
-        static_cast<int>(LittleFsDataStorage::kEventFileMaxBytes),
-        static_cast<int>(sizeOf(eventFileOf(dir, 0))));
-    TEST_ASSERT_EQUAL_INT(static_cast<int>(6 * kFixedRecordBytes),
-                          static_cast<int>(sizeOf(eventFileOf(dir, 1))));
+    // Restart: a new instance must derive the active segment (1) from the
+    // headers alone and append there — no spurious rotation.
+    {
+        LittleFsDataStorage second(dir.path());
+        appendEvents(second, base, kEventsPerSegment + 5, 1);
+        TEST_ASSERT_EQUAL_INT(kFullSegmentBytes, sizeOf(eventFileOf(dir, 0)));
+        TEST_ASSERT_EQUAL_INT(
+            static_cast<int>(kSegmentHeaderBytes + 6 * kFixedRecordBytes),
+            static_cast<int>(sizeOf(eventFileOf(dir, 1))));
+
+        const auto events = second.getEvents(2);
+        TEST_ASSERT_EQUAL_size_t(2, events.size());
+        TEST_ASSERT_EQUAL_UINT32(
+            base + static_cast<uint32_t>(kEventsPerSegment) + 5, events[0].epoch);
+        TEST_ASSERT_EQUAL_UINT32(
+            base + static_cast<uint32_t>(kEventsPerSegment) + 4, events[1].epoch);
+    }
 
-    const auto events = second.getEvents(2);
-    TEST_ASSERT_EQUAL_size_t(2, events.size());
-    TEST_ASSERT_EQUAL_UINT32(
-        base + static_cast<uint32_t>(kEventsPerFile) + 5, events[0].epoch);
-    TEST_ASSERT_EQUAL_UINT32(
-        base + static_cast<uint32_t>(kEventsPerFile) + 4, events[1].epoch);
+    // A torn header (power cut while a rotation started segment 1): the
+    // segment is not read, and the next append starts it again.
+    overwriteByte(eventFileOf(dir, 1), 0, 0x00);
+    LittleFsDataStorage third(dir.path());
+    TEST_ASSERT_EQUAL_size_t(kEventsPerSegment, third.getEvents(SIZE_MAX).size());
+    appendEvents(third, base, kEventsPerSegment + 6, 1);
+    TEST_ASSERT_EQUAL_INT(static_cast<int>(kSegmentHeaderBytes + kFixedRecordBytes),
+                          static_cast<int>(sizeOf(eventFileOf(dir, 1))));
+    TEST_ASSERT_EQUAL_INT(kFullSegmentBytes, sizeOf(eventFileOf(dir, 0)));
+    TEST_ASSERT_EQUAL_size_t(kEventsPerSegment + 1, third.getEvents(SIZE_MAX).size());
 }
 
 void test_mock_event_bound_and_category_passthrough(void)
@@ -851,81 +972,3657 @@ void test_mock_event_bound_and_category_passthrough(void)
                              newest[0].epoch);
 }
 
-// --- T028: LockedDataStorage decorator (FR-013) --------------------------
-// Delegates the full contract path unchanged (the wrapper adds task-level
-// mutex serialization; see LockedDataStorage.h — same mechanism PR-02's
-// LockedWaterPump test established). The instrumented mock proves every
-// call reached the wrapped storage.
+// --- Chunk-index cache (LittleFsDataStorageOptions::cacheChunkIndex) -----
 
-void test_locked_data_storage_delegates_full_contract(void)
+LittleFsDataStorageOptions cachedIndex()
 {
-    MockDataStorage inner;
-    inner.stats = StorageStats{983040, 12288};
-    LockedDataStorage storage(inner);
+    LittleFsDataStorageOptions options;
+    options.cacheChunkIndex = true;
+    return options;
+}
 
-    // storeSensorReading: accepted appends and the rejection paths pass
-    // through unchanged.
-    TEST_ASSERT_TRUE(storage.storeSensorReading("soil_moisture", 100, 1.0f));
-    TEST_ASSERT_TRUE(storage.storeSensorReading("soil_moisture", 200, 2.0f));
-    TEST_ASSERT_TRUE(storage.storeSensorReading("soil_moisture", 300, 3.0f));
-    TEST_ASSERT_FALSE(storage.storeSensorReading("bad/metric", 400, 4.0f));
-    TEST_ASSERT_EQUAL(3, inner.acceptedWrites);
-    TEST_ASSERT_EQUAL(1, inner.rejectedWrites);
+/// Sorted directory listing: readdir order is unspecified.
+std::vector<std::string> sortedListDir(const std::string& dir)
+{
+    std::vector<std::string> names = listDir(dir);
+    std::sort(names.begin(), names.end());
+    return names;
+}
 
-    // getSensorReadings: inclusive chronological range, empty on t0 > t1.
-    const auto mid = storage.getSensorReadings("soil_moisture", 200, 300);
-    TEST_ASSERT_EQUAL_size_t(2, mid.size());
-    TEST_ASSERT_EQUAL_UINT32(200, mid[0].epoch);
-    TEST_ASSERT_EQUAL_UINT32(300, mid[1].epoch);
-    TEST_ASSERT_TRUE(storage.getSensorReadings("soil_moisture", 300, 200).empty());
+void test_chunk_cache_matches_stateless_layout(void)
+{
+    TempDir plainDir;
+    TempDir cachedDir;
+    LittleFsDataStorage plain(plainDir.path());
+    LittleFsDataStorage cached(cachedDir.path(), nullptr, cachedIndex());
+    const std::string metric = "soil_moisture";
 
-    // storeEvent: detail truncation happens behind the wrapper.
-    const std::string longDetail(IDataStorage::kEventDetailMaxLen + 30, 'd');
-    TEST_ASSERT_TRUE(storage.storeEvent(500, IDataStorage::kCategoryPump,
-                                        "pump started"));
-    TEST_ASSERT_TRUE(storage.storeEvent(600, IDataStorage::kCategoryFailsafe,
-                                        longDetail));
+    // Seal, evict and bump a chunk name through both modes: the cache must
+    // be a pure memoization — byte-identical files, identical queries.
+    const std::size_t appends = kMetricCapacity + kRecordsPerChunk + 3;
+    appendSeries(plain, metric, 5000, appends, 1);
+    appendSeries(cached, metric, 5000, appends, 1);
+    TEST_ASSERT_TRUE(plain.storeSensorReading(metric, 10, 1.0f));
+    TEST_ASSERT_TRUE(cached.storeSensorReading(metric, 10, 1.0f));
 
-    // getEvents: newest-first with maxCount.
-    const auto events = storage.getEvents(2);
-    TEST_ASSERT_EQUAL_size_t(2, events.size());
-    TEST_ASSERT_EQUAL_UINT32(600, events[0].epoch);
-    TEST_ASSERT_EQUAL_size_t(IDataStorage::kEventDetailMaxLen,
-                             events[0].detail.size());
-    TEST_ASSERT_EQUAL_UINT32(500, events[1].epoch);
-    TEST_ASSERT_EQUAL_STRING("pump started", events[1].detail.c_str());
+    const auto plainChunks = sortedListDir(metricDirOf(plainDir, metric));
+    const auto cachedChunks = sortedListDir(metricDirOf(cachedDir, metric));
+    TEST_ASSERT_EQUAL_size_t(LittleFsDataStorage::kHistoryMaxChunksPerMetric,
+                             cachedChunks.size());
+    TEST_ASSERT_TRUE(plainChunks == cachedChunks);
+    for (const std::string& name : cachedChunks) {
+        TEST_ASSERT_TRUE(readAll(metricDirOf(plainDir, metric) + "/" + name) ==
+                         readAll(metricDirOf(cachedDir, metric) + "/" + name));
+    }
+}
 
-    // getStorageStats: injected stats come back verbatim.
-    const StorageStats stats = storage.getStorageStats();
-    TEST_ASSERT_EQUAL_UINT32(983040, stats.totalBytes);
-    TEST_ASSERT_EQUAL_UINT32(12288, stats.usedBytes);
+void test_chunk_cache_rebuilt_after_restart(void)
+{
+    TempDir dir;
+    const std::string metric = "env_temperature";
+    {
+        LittleFsDataStorage storage(dir.path(), nullptr, cachedIndex());
+        TEST_ASSERT_TRUE(storage.storeSensorReading(metric, 100, 1.0f));
+        TEST_ASSERT_TRUE(storage.storeSensorReading(metric, 200, 2.0f));
+    }
 
-    // A persistence failure surfaces through the wrapper unchanged.
-    inner.failWrites = true;
-    TEST_ASSERT_FALSE(storage.storeSensorReading("soil_moisture", 700, 7.0f));
-    TEST_ASSERT_FALSE(storage.storeEvent(700, IDataStorage::kCategoryPump, "x"));
+    // Power loss mid-append between "boots": the new instance derives its
+    // table from the files, repairing the torn tail before appending into
+    // the same active chunk.
+    const std::string chunk = singleChunkPath(dir, metric);
+    appendGarbage(chunk, 5);
+    LittleFsDataStorage storage(dir.path(), nullptr, cachedIndex());
+    TEST_ASSERT_TRUE(storage.storeSensorReading(metric, 300, 3.0f));
+    TEST_ASSERT_EQUAL_INT(
+        3 * static_cast<int>(LittleFsDataStorage::kHistoryRecordBytes),
+        static_cast<int>(sizeOf(chunk)));
+
+    const auto all = storage.getSensorReadings(metric, 0, UINT32_MAX);
+    TEST_ASSERT_EQUAL_size_t(3, all.size());
+    TEST_ASSERT_EQUAL_UINT32(300, all[2].epoch);
 }
 
-// The wrapped LittleFsDataStorage keeps its contract behind the wrapper
-// (real-store spot check: on-disk round-trip through the mutex).
-void test_locked_data_storage_over_real_storage(void)
+void test_chunk_cache_recovers_from_external_change(void)
 {
     TempDir dir;
-    LittleFsDataStorage inner(dir.path());
-    LockedDataStorage storage(inner);
+    LittleFsDataStorage storage(dir.path(), nullptr, cachedIndex());
+    const std::string metric = "soil_moisture";
+    TEST_ASSERT_TRUE(storage.storeSensorReading(metric, 100, 1.0f));
 
-    TEST_ASSERT_TRUE(storage.storeSensorReading("env_temperature", 100, 21.5f));
-    TEST_ASSERT_TRUE(storage.storeEvent(200, IDataStorage::kCategoryReset,
-                                        "boot"));
+    // The metric directory vanishes behind the cache's back: the stale
+    // table is dropped and the append re-derives it instead of failing.
+    const std::string chunk = singleChunkPath(dir, metric);
+    TEST_ASSERT_EQUAL_INT(0, std::remove(chunk.c_str()));
+    TEST_ASSERT_EQUAL_INT(0, ::rmdir(metricDirOf(dir, metric).c_str()));
+    TEST_ASSERT_TRUE(storage.storeSensorReading(metric, 200, 2.0f));
 
-    const auto readings =
-        storage.getSensorReadings("env_temperature", 0, UINT32_MAX);
-    TEST_ASSERT_EQUAL_size_t(1, readings.size());
-    TEST_ASSERT_EQUAL_FLOAT(21.5f, readings[0].value);
+    const auto all = storage.getSensorReadings(metric, 0, UINT32_MAX);
+    TEST_ASSERT_EQUAL_size_t(1, all.size());
+    TEST_ASSERT_EQUAL_UINT32(200, all[0].epoch);
+}
 
-    const auto events = storage.getEvents(10);
-    TEST_ASSERT_EQUAL_size_t(1, events.size());
-    TEST_ASSERT_EQUAL_STRING("boot", events[0].detail.c_str());
+void test_chunk_cache_keeps_metric_cap(void)
+{
+    TempDir dir;
+    LittleFsDataStorage storage(dir.path(), nullptr, cachedIndex());
+
+    for (std::size_t i = 0; i < IDataStorage::kMaxMetrics; ++i) {
+        TEST_ASSERT_TRUE(
+            storage.storeSensorReading("metric_" + std::to_string(i), 100, 1.0f));
+    }
+    TEST_ASSERT_FALSE(storage.storeSensorReading("metric_extra", 100, 1.0f));
+    TEST_ASSERT_FALSE(storage.storeSensorReading("metric_extra", 200, 1.0f));
+    TEST_ASSERT_FALSE(storage.storeSensorReading("bad/metric", 100, 1.0f));
+    TEST_ASSERT_TRUE(storage.storeSensorReading("metric_0", 200, 2.0f));
+    TEST_ASSERT_EQUAL_size_t(IDataStorage::kMaxMetrics,
+                             listDir(dir.path() + "/hist").size());
+}
+
+// --- Group commit (LittleFsDataStorageOptions::groupCommitWindowMs) ------
+
+constexpr uint32_t kCommitWindowMs = 60'000;
+
+LittleFsDataStorageOptions groupCommit(FakeTimeProvider& clock,
+                                       std::size_t maxRecords = 64)
+{
+    LittleFsDataStorageOptions options;
+    options.groupCommitWindowMs = kCommitWindowMs;
+    options.groupCommitMaxRecords = maxRecords;
+    options.clock = &clock;
+    return options;
+}
+
+/// Committed size of `metric`'s single chunk, 0 while no chunk exists.
+long committedBytes(const TempDir& dir, const std::string& metric)
+{
+    const auto chunks = listDir(metricDirOf(dir, metric));
+    return chunks.empty() ? 0 : sizeOf(metricDirOf(dir, metric) + "/" + chunks[0]);
+}
+
+void test_group_commit_buffers_until_deadline(void)
+{
+    TempDir dir;
+    FakeTimeProvider clock;
+    LittleFsDataStorage storage(dir.path(), nullptr, groupCommit(clock));
+    const std::string metric = "soil_moisture";
+
+    TEST_ASSERT_TRUE(storage.storeSensorReading(metric, 100, 1.0f));
+    clock.advance(10'000);
+    TEST_ASSERT_TRUE(storage.storeSensorReading(metric, 200, 2.0f));
+
+    // Buffered, not yet on flash — but already visible to queries.
+    TEST_ASSERT_EQUAL_INT(0, static_cast<int>(committedBytes(dir, metric)));
+    const auto early = storage.getSensorReadings(metric, 0, UINT32_MAX);
+    TEST_ASSERT_EQUAL_size_t(2, early.size());
+    TEST_ASSERT_EQUAL_UINT32(200, early[1].epoch);
+
+    // Inside the window measured from the OLDEST buffered record: no commit.
+    clock.advance(kCommitWindowMs - 10'001);
+    TEST_ASSERT_TRUE(storage.flushIfDue());
+    TEST_ASSERT_EQUAL_INT(0, static_cast<int>(committedBytes(dir, metric)));
+
+    // Deadline reached: both records land in one commit, nothing duplicated.
+    clock.advance(1);
+    TEST_ASSERT_TRUE(storage.flushIfDue());
+    TEST_ASSERT_EQUAL_INT(
+        2 * static_cast<int>(LittleFsDataStorage::kHistoryRecordBytes),
+        static_cast<int>(committedBytes(dir, metric)));
+    TEST_ASSERT_EQUAL_size_t(2,
+                             storage.getSensorReadings(metric, 0, UINT32_MAX).size());
+}
+
+void test_group_commit_bounded_by_record_count(void)
+{
+    TempDir dir;
+    FakeTimeProvider clock;
+    LittleFsDataStorage storage(dir.path(), nullptr, groupCommit(clock, 4));
+
+    // The 4th buffered record (across metrics) commits the whole buffer
+    // immediately, whatever the clock says.
+    TEST_ASSERT_TRUE(storage.storeSensorReading("env_temperature", 100, 1.0f));
+    TEST_ASSERT_TRUE(storage.storeSensorReading("env_humidity", 100, 2.0f));
+    TEST_ASSERT_TRUE(storage.storeSensorReading("env_temperature", 200, 3.0f));
+    TEST_ASSERT_EQUAL_INT(0, static_cast<int>(committedBytes(dir, "env_humidity")));
+    TEST_ASSERT_TRUE(storage.storeSensorReading("env_humidity", 200, 4.0f));
+    TEST_ASSERT_EQUAL_INT(
+        2 * static_cast<int>(LittleFsDataStorage::kHistoryRecordBytes),
+        static_cast<int>(committedBytes(dir, "env_temperature")));
+    TEST_ASSERT_EQUAL_INT(
+        2 * static_cast<int>(LittleFsDataStorage::kHistoryRecordBytes),
+        static_cast<int>(committedBytes(dir, "env_humidity")));
+}
+
+void test_group_commit_flush_and_restart(void)
+{
+    TempDir dir;
+    FakeTimeProvider clock;
+    const std::string metric = "env_pressure";
+    {
+        LittleFsDataStorage storage(dir.path(), nullptr, groupCommit(clock));
+        TEST_ASSERT_TRUE(storage.storeSensorReading(metric, 100, 1.0f));
+        TEST_ASSERT_TRUE(storage.flush());  // explicit commit
+        TEST_ASSERT_EQUAL_INT(
+            static_cast<int>(LittleFsDataStorage::kHistoryRecordBytes),
+            static_cast<int>(committedBytes(dir, metric)));
+        TEST_ASSERT_TRUE(storage.storeSensorReading(metric, 200, 2.0f));
+    }  // destruction commits the rest
+
+    LittleFsDataStorage storage(dir.path());
+    const auto all = storage.getSensorReadings(metric, 0, UINT32_MAX);
+    TEST_ASSERT_EQUAL_size_t(2, all.size());
+    TEST_ASSERT_EQUAL_UINT32(100, all[0].epoch);
+    TEST_ASSERT_EQUAL_UINT32(200, all[1].epoch);
+}
+
+void test_group_commit_seals_chunks_like_durable_path(void)
+{
+    TempDir plainDir;
+    TempDir groupDir;
+    FakeTimeProvider clock;
+    LittleFsDataStorage plain(plainDir.path());
+    LittleFsDataStorage grouped(groupDir.path(), nullptr,
+                                groupCommit(clock, kRecordsPerChunk + 7));
+    const std::string metric = "soil_moisture";
+
+    // One buffered batch that straddles the 8 KiB seal must split across
+    // chunk files exactly as record-by-record appends do.
+    appendSeries(plain, metric, 1000, kRecordsPerChunk + 7, 1);
+    appendSeries(grouped, metric, 1000, kRecordsPerChunk + 7, 1);
+    const auto plainChunks = sortedListDir(metricDirOf(plainDir, metric));
+    TEST_ASSERT_EQUAL_size_t(2, plainChunks.size());
+    TEST_ASSERT_TRUE(plainChunks == sortedListDir(metricDirOf(groupDir, metric)));
+    for (const std::string& name : plainChunks) {
+        TEST_ASSERT_TRUE(readAll(metricDirOf(plainDir, metric) + "/" + name) ==
+                         readAll(metricDirOf(groupDir, metric) + "/" + name));
+    }
+}
+
+void test_group_commit_keeps_metric_cap_and_event_durability(void)
+{
+    TempDir dir;
+    FakeTimeProvider clock;
+    LittleFsDataStorage storage(dir.path(), nullptr, groupCommit(clock));
+
+    // The budget guard is enforced when a reading is accepted, not later at
+    // commit time.
+    for (std::size_t i = 0; i < IDataStorage::kMaxMetrics; ++i) {
+        TEST_ASSERT_TRUE(
+            storage.storeSensorReading("metric_" + std::to_string(i), 100, 1.0f));
+    }
+    TEST_ASSERT_FALSE(storage.storeSensorReading("metric_extra", 100, 1.0f));
+    TEST_ASSERT_FALSE(storage.storeSensorReading("bad/metric", 100, 1.0f));
+
+    // Events bypass the buffer: on flash as soon as storeEvent returns.
+    TEST_ASSERT_TRUE(storage.storeEvent(100, IDataStorage::kCategoryPump, "on"));
+    TEST_ASSERT_EQUAL_INT(
+        static_cast<int>(kSegmentHeaderBytes + LittleFsDataStorage::kEventHeaderBytes +
+                         2 + LittleFsDataStorage::kEventTrailerBytes),
+        static_cast<int>(sizeOf(eventFileOf(dir, 0))));
+}
+
+// --- Batch append (IDataStorage::storeSensorReadings) -------------------
+
+void test_batch_append_matches_single_appends(void)
+{
+    TempDir singleDir;
+    TempDir batchDir;
+    LittleFsDataStorage single(singleDir.path());
+    LittleFsDataStorage batched(batchDir.path());
+
+    // Interleaved metrics, one repeated: per-metric array order is kept.
+    const SensorReading batch[] = {
+        {"env_temperature", 100, 21.0f}, {"soil_moisture", 100, 40.0f},
+        {"env_temperature", 160, 21.5f}, {"soil_ec", 100, 1.2f},
+    };
+    constexpr std::size_t kCount = sizeof(batch) / sizeof(batch[0]);
+    for (const SensorReading& r : batch) {
+        TEST_ASSERT_TRUE(single.storeSensorReading(r.metric, r.epoch, r.value));
+    }
+    TEST_ASSERT_EQUAL_size_t(kCount, batched.storeSensorReadings(batch, kCount));
+
+    for (const char* metric : {"env_temperature", "soil_moisture", "soil_ec"}) {
+        const std::string name = singleChunkPath(singleDir, metric);
+        const std::string chunk =
+            metricDirOf(batchDir, metric) + name.substr(name.rfind('/'));
+        TEST_ASSERT_TRUE(readAll(name) == readAll(chunk));
+    }
+    const auto temps =
+        batched.getSensorReadings("env_temperature", 0, UINT32_MAX);
+    TEST_ASSERT_EQUAL_size_t(2, temps.size());
+    TEST_ASSERT_EQUAL_UINT32(160, temps[1].epoch);
+}
+
+void test_batch_append_rejects_per_reading(void)
+{
+    TempDir dir;
+    LittleFsDataStorage storage(dir.path(), nullptr, cachedIndex());
+    for (std::size_t i = 0; i + 1 < IDataStorage::kMaxMetrics; ++i) {
+        TEST_ASSERT_TRUE(
+            storage.storeSensorReading("metric_" + std::to_string(i), 100, 1.0f));
+    }
+
+    // One slot left: the first new metric takes it, the second is over the
+    // cap, the unsafe name is rejected — the rest of the batch still lands.
+    const SensorReading batch[] = {
+        {"metric_new", 200, 1.0f},
+        {"metric_over", 200, 2.0f},
+        {"bad/metric", 200, 3.0f},
+        {"metric_0", 200, 4.0f},
+    };
+    TEST_ASSERT_EQUAL_size_t(2, storage.storeSensorReadings(batch, 4));
+    TEST_ASSERT_EQUAL_size_t(
+        1, storage.getSensorReadings("metric_new", 0, UINT32_MAX).size());
+    TEST_ASSERT_TRUE(
+        storage.getSensorReadings("metric_over", 0, UINT32_MAX).empty());
+    TEST_ASSERT_EQUAL_size_t(
+        2, storage.getSensorReadings("metric_0", 0, UINT32_MAX).size());
+    TEST_ASSERT_EQUAL_size_t(0, storage.storeSensorReadings(batch, 0));
+}
+
+void test_batch_append_under_group_commit(void)
+{
+    TempDir dir;
+    FakeTimeProvider clock;
+    LittleFsDataStorage storage(dir.path(), nullptr, groupCommit(clock));
+    const SensorReading batch[] = {
+        {"env_temperature", 100, 21.0f},
+        {"env_humidity", 100, 55.0f},
+    };
+
+    // Buffered as a batch; committed together once the window has passed.
+    TEST_ASSERT_EQUAL_size_t(2, storage.storeSensorReadings(batch, 2));
+    TEST_ASSERT_EQUAL_INT(0, static_cast<int>(committedBytes(dir, "env_humidity")));
+    clock.advance(kCommitWindowMs);
+    TEST_ASSERT_TRUE(storage.flushIfDue());
+    TEST_ASSERT_EQUAL_INT(
+        static_cast<int>(LittleFsDataStorage::kHistoryRecordBytes),
+        static_cast<int>(committedBytes(dir, "env_humidity")));
+}
+
+// --- Row layout (LittleFsDataStorageOptions::historyFormat) ------------
+
+LittleFsDataStorageOptions rowLayout()
+{
+    LittleFsDataStorageOptions options;
+    options.historyFormat = HistoryFormat::Rows;
+    options.cacheChunkIndex = true;
+    return options;
+}
+
+std::string rowsDirOf(const TempDir& dir) { return dir.path() + "/rows"; }
+
+/// Sorted row chunk names (the slot table excluded).
+std::vector<std::string> rowChunks(const TempDir& dir)
+{
+    std::vector<std::string> chunks = sortedListDir(rowsDirOf(dir));
+    chunks.erase(std::remove(chunks.begin(), chunks.end(), "metrics"),
+                 chunks.end());
+    return chunks;
+}
+
+constexpr long rowBytes(int values)
+{
+    return static_cast<long>(LittleFsDataStorage::kRowHeaderBytes) + 4L * values;
+}
+
+void test_row_layout_round_trip(void)
+{
+    TempDir dir;
+    LittleFsDataStorage storage(dir.path(), nullptr, rowLayout());
+
+    // A full logging pass is ONE row: epoch once, mask, one float per metric.
+    SensorReading pass[IDataStorage::kMaxMetrics];
+    for (std::size_t i = 0; i < IDataStorage::kMaxMetrics; ++i) {
+        pass[i] = SensorReading{"metric_" + std::to_string(i), 100,
+                                static_cast<float>(i)};
+    }
+    TEST_ASSERT_EQUAL_size_t(IDataStorage::kMaxMetrics,
+                             storage.storeSensorReadings(pass, IDataStorage::kMaxMetrics));
+    const auto chunks = rowChunks(dir);
+    TEST_ASSERT_EQUAL_size_t(1, chunks.size());
+    TEST_ASSERT_EQUAL_STRING("100.dat", chunks[0].c_str());
+    const std::string chunk = rowsDirOf(dir) + "/" + chunks[0];
+    TEST_ASSERT_EQUAL_INT(rowBytes(IDataStorage::kMaxMetrics), sizeOf(chunk));
+    TEST_ASSERT_TRUE(listDir(dir.path() + "/hist").empty());
+
+    // A partial pass (NPK channel skipped) only pays for present values.
+    const SensorReading partial[] = {
+        {"metric_9", 160, 9.5f}, {"metric_2", 160, 2.5f}, {"metric_5", 160, 5.5f},
+    };
+    TEST_ASSERT_EQUAL_size_t(3, storage.storeSensorReadings(partial, 3));
+    TEST_ASSERT_EQUAL_INT(rowBytes(IDataStorage::kMaxMetrics) + rowBytes(3), sizeOf(chunk));
+
+    const auto nine = storage.getSensorReadings("metric_9", 0, UINT32_MAX);
+    TEST_ASSERT_EQUAL_size_t(2, nine.size());
+    TEST_ASSERT_EQUAL_FLOAT(9.0f, nine[0].value);
+    TEST_ASSERT_EQUAL_UINT32(160, nine[1].epoch);
+    TEST_ASSERT_EQUAL_FLOAT(9.5f, nine[1].value);
+    const auto five = storage.getSensorReadings("metric_5", 150, 200);
+    TEST_ASSERT_EQUAL_size_t(1, five.size());
+    TEST_ASSERT_EQUAL_FLOAT(5.5f, five[0].value);
+    TEST_ASSERT_EQUAL_size_t(
+        1, storage.getSensorReadings("metric_0", 0, UINT32_MAX).size());
+    TEST_ASSERT_TRUE(storage.getSensorReadings("unknown", 0, UINT32_MAX).empty());
+
+    // Single appends are one-value rows; a restarted instance reads it all.
+    TEST_ASSERT_TRUE(storage.storeSensorReading("metric_0", 220, 0.5f));
+    TEST_ASSERT_EQUAL_INT(rowBytes(IDataStorage::kMaxMetrics) + rowBytes(3) + rowBytes(1), sizeOf(chunk));
+    LittleFsDataStorage restarted(dir.path(), nullptr, rowLayout());
+    const auto zero = restarted.getSensorReadings("metric_0", 0, UINT32_MAX);
+    TEST_ASSERT_EQUAL_size_t(2, zero.size());
+    TEST_ASSERT_EQUAL_FLOAT(0.5f, zero[1].value);
+}
+
+void test_row_layout_seals_and_evicts(void)
+{
+    TempDir dir;
+    LittleFsDataStorage storage(dir.path(), nullptr, rowLayout());
+    constexpr std::size_t kRowsPerChunk =
+        LittleFsDataStorage::kRowChunkMaxBytes / static_cast<std::size_t>(rowBytes(1));
+
+    // One chunk's worth of one-value rows per batch; one batch past the
+    // ring bound evicts the oldest chunk.
+    std::vector<SensorReading> batch(kRowsPerChunk);
+    uint32_t epoch = 1000;
+    for (std::size_t c = 0; c <= LittleFsDataStorage::kRowMaxChunks; ++c) {
+        for (SensorReading& reading : batch) {
+            reading = SensorReading{"soil_moisture", epoch++, 40.0f};
+        }
+        TEST_ASSERT_EQUAL_size_t(batch.size(),
+                                 storage.storeSensorReadings(batch.data(), batch.size()));
+    }
+    const auto chunks = rowChunks(dir);
+    TEST_ASSERT_EQUAL_size_t(LittleFsDataStorage::kRowMaxChunks, chunks.size());
+    for (const std::string& chunk : chunks) {
+        TEST_ASSERT_TRUE(sizeOf(rowsDirOf(dir) + "/" + chunk) <=
+                         static_cast<long>(LittleFsDataStorage::kRowChunkMaxBytes));
+    }
+    const auto kept = storage.getSensorReadings("soil_moisture", 0, UINT32_MAX);
+    TEST_ASSERT_EQUAL_size_t(LittleFsDataStorage::kRowMaxChunks * kRowsPerChunk,
+                             kept.size());
+    TEST_ASSERT_EQUAL_UINT32(1000 + kRowsPerChunk, kept.front().epoch);
+    TEST_ASSERT_EQUAL_UINT32(epoch - 1, kept.back().epoch);
+}
+
+void test_row_layout_torn_tails_repaired(void)
+{
+    TempDir dir;
+    {
+        LittleFsDataStorage storage(dir.path(), nullptr, rowLayout());
+        const SensorReading pass[] = {
+            {"env_temperature", 100, 21.0f}, {"env_humidity", 100, 55.0f},
+        };
+        TEST_ASSERT_EQUAL_size_t(2, storage.storeSensorReadings(pass, 2));
+    }
+    // Power loss mid-row and mid-name: a partial frame and an
+    // unterminated table line.
+    const std::string chunk = rowsDirOf(dir) + "/100.dat";
+    appendGarbage(chunk, 5);
+    appendGarbage(rowsDirOf(dir) + "/metrics", 3);
+
+    LittleFsDataStorage storage(dir.path(), nullptr, rowLayout());
+    TEST_ASSERT_EQUAL_size_t(
+        1, storage.getSensorReadings("env_humidity", 0, UINT32_MAX).size());
+    TEST_ASSERT_TRUE(storage.storeSensorReading("soil_ec", 160, 1.2f));
+    TEST_ASSERT_EQUAL_INT(rowBytes(2) + rowBytes(1), sizeOf(chunk));
+    const auto ec = storage.getSensorReadings("soil_ec", 0, UINT32_MAX);
+    TEST_ASSERT_EQUAL_size_t(1, ec.size());
+    TEST_ASSERT_EQUAL_FLOAT(1.2f, ec[0].value);
+    const std::vector<uint8_t> table = readAll(rowsDirOf(dir) + "/metrics");
+    const std::string expected = "env_temperature\nenv_humidity\nsoil_ec\n";
+    TEST_ASSERT_TRUE(std::string(table.begin(), table.end()) == expected);
+}
+
+void test_row_layout_keeps_metric_cap(void)
+{
+    TempDir dir;
+    LittleFsDataStorage storage(dir.path(), nullptr, rowLayout());
+    for (std::size_t i = 0; i < IDataStorage::kMaxMetrics; ++i) {
+        TEST_ASSERT_TRUE(
+            storage.storeSensorReading("metric_" + std::to_string(i), 100, 1.0f));
+    }
+    TEST_ASSERT_FALSE(storage.storeSensorReading("metric_over", 100, 1.0f));
+    TEST_ASSERT_FALSE(storage.storeSensorReading("bad/metric", 100, 1.0f));
+    TEST_ASSERT_TRUE(storage.storeSensorReading("metric_3", 160, 2.0f));
+
+    TempDir other;
+    LittleFsDataStorage fresh(other.path(), nullptr, rowLayout());
+    // The slot table is line-framed, so a name holding '\n' is unsafe.
+    TEST_ASSERT_FALSE(fresh.storeSensorReading("bad\nname", 100, 1.0f));
+    TEST_ASSERT_TRUE(fresh.storeSensorReading("good", 100, 1.0f));
+    const std::vector<uint8_t> table = readAll(rowsDirOf(other) + "/metrics");
+    TEST_ASSERT_TRUE(std::string(table.begin(), table.end()) == "good\n");
+}
+
+void test_row_layout_under_group_commit(void)
+{
+    TempDir dir;
+    FakeTimeProvider clock;
+    LittleFsDataStorageOptions options = groupCommit(clock);
+    options.historyFormat = HistoryFormat::Rows;
+    LittleFsDataStorage storage(dir.path(), nullptr, options);
+
+    // Two logging passes buffered reading by reading commit as two rows.
+    TEST_ASSERT_TRUE(storage.storeSensorReading("soil_moisture", 100, 40.0f));
+    TEST_ASSERT_TRUE(storage.storeSensorReading("env_temperature", 100, 21.0f));
+    TEST_ASSERT_TRUE(storage.storeSensorReading("soil_ec", 100, 1.2f));
+    TEST_ASSERT_TRUE(storage.storeSensorReading("env_temperature", 160, 21.5f));
+    TEST_ASSERT_TRUE(storage.storeSensorReading("soil_ec", 160, 1.3f));
+    TEST_ASSERT_TRUE(rowChunks(dir).empty());
+    TEST_ASSERT_EQUAL_size_t(
+        2, storage.getSensorReadings("env_temperature", 0, UINT32_MAX).size());
+
+    TEST_ASSERT_TRUE(storage.flush());
+    TEST_ASSERT_EQUAL_INT(rowBytes(3) + rowBytes(2),
+                          sizeOf(rowsDirOf(dir) + "/100.dat"));
+    const auto ec = storage.getSensorReadings("soil_ec", 0, UINT32_MAX);
+    TEST_ASSERT_EQUAL_size_t(2, ec.size());
+    TEST_ASSERT_EQUAL_UINT32(100, ec[0].epoch);
+    TEST_ASSERT_EQUAL_FLOAT(1.3f, ec[1].value);
+}
+
+// --- Multiplexed layout (HistoryFormat::Multiplexed) -------------------
+
+LittleFsDataStorageOptions muxLayout()
+{
+    LittleFsDataStorageOptions options;
+    options.historyFormat = HistoryFormat::Multiplexed;
+    options.cacheChunkIndex = true;
+    return options;
+}
+
+std::string muxDirOf(const TempDir& dir) { return dir.path() + "/mux"; }
+
+/// Sorted multiplexed chunk names (the slot table excluded).
+std::vector<std::string> muxChunks(const TempDir& dir)
+{
+    std::vector<std::string> chunks = sortedListDir(muxDirOf(dir));
+    chunks.erase(std::remove(chunks.begin(), chunks.end(), "metrics"),
+                 chunks.end());
+    return chunks;
+}
+
+constexpr long muxFrameBytes(int values)
+{
+    return static_cast<long>(LittleFsDataStorage::kMuxFrameHeaderBytes +
+                             LittleFsDataStorage::kMuxEntryBytes * values);
+}
+
+void test_mux_layout_round_trip_past_the_row_cap(void)
+{
+    TempDir dir;
+    LittleFsDataStorage storage(dir.path(), nullptr, muxLayout());
+
+    // A 40-metric pass (zones and power channels) is ONE frame: epoch and
+    // count once, then {slot, value} per metric.
+    constexpr std::size_t kPass = 40;
+    std::vector<SensorReading> pass(kPass);
+    for (std::size_t i = 0; i < kPass; ++i) {
+        pass[i] = SensorReading{"zone_" + std::to_string(i), 100, static_cast<float>(i)};
+    }
+    TEST_ASSERT_EQUAL_size_t(kPass, storage.storeSensorReadings(pass.data(), kPass));
+    const auto chunks = muxChunks(dir);
+    TEST_ASSERT_EQUAL_size_t(1, chunks.size());
+    const std::string chunk = muxDirOf(dir) + "/" + chunks[0];
+    TEST_ASSERT_EQUAL_INT(muxFrameBytes(kPass), sizeOf(chunk));
+    TEST_ASSERT_TRUE(listDir(dir.path() + "/hist").empty());
+    TEST_ASSERT_TRUE(listDir(dir.path() + "/rows").empty());
+
+    const SensorReading partial[] = {
+        {"zone_39", 160, 39.5f}, {"zone_2", 160, 2.5f}, {"zone_5", 160, 5.5f},
+    };
+    TEST_ASSERT_EQUAL_size_t(3, storage.storeSensorReadings(partial, 3));
+    TEST_ASSERT_EQUAL_INT(muxFrameBytes(kPass) + muxFrameBytes(3), sizeOf(chunk));
+    const auto last = storage.getSensorReadings("zone_39", 0, UINT32_MAX);
+    TEST_ASSERT_EQUAL_size_t(2, last.size());
+    TEST_ASSERT_EQUAL_FLOAT(39.0f, last[0].value);
+    TEST_ASSERT_EQUAL_FLOAT(39.5f, last[1].value);
+    TEST_ASSERT_EQUAL_size_t(1, storage.getSensorReadings("zone_5", 150, 200).size());
+    TEST_ASSERT_TRUE(storage.getSensorReadings("unknown", 0, UINT32_MAX).empty());
+
+    // Up to kMuxMaxMetrics distinct metrics, one more rejected.
+    for (std::size_t i = kPass; i < LittleFsDataStorage::kMuxMaxMetrics; ++i) {
+        TEST_ASSERT_TRUE(storage.storeSensorReading("zone_" + std::to_string(i), 220, 1.0f));
+    }
+    TEST_ASSERT_FALSE(storage.storeSensorReading("zone_over", 220, 1.0f));
+
+    LittleFsDataStorage restarted(dir.path(), nullptr, muxLayout());
+    const auto two = restarted.getSensorReadings("zone_2", 0, UINT32_MAX);
+    TEST_ASSERT_EQUAL_size_t(2, two.size());
+    TEST_ASSERT_EQUAL_FLOAT(2.5f, two[1].value);
+    TEST_ASSERT_EQUAL_size_t(1, restarted.getSensorReadings("zone_63", 0, UINT32_MAX).size());
+    TEST_ASSERT_TRUE(restarted.storeSensorReading("zone_63", 280, 2.0f));
+}
+
+void test_mux_layout_skips_chunks_without_the_metric(void)
+{
+    TempDir dir;
+    LittleFsDataStorage storage(dir.path(), nullptr, muxLayout());
+    constexpr std::size_t kFramesPerChunk =
+        (LittleFsDataStorage::kRowChunkMaxBytes - LittleFsDataStorage::kMuxFooterBytes) /
+        static_cast<std::size_t>(muxFrameBytes(1));
+
+    // One chunk's worth of soil moisture (slot 0); the first pressure
+    // reading (slot 1) seals it with its footer.
+    for (uint32_t i = 0; i < kFramesPerChunk; ++i) {
+        TEST_ASSERT_TRUE(storage.storeSensorReading("soil_moisture", 1000 + i, 40.0f));
+    }
+    TEST_ASSERT_TRUE(storage.storeSensorReading("env_pressure", 5000, 1013.0f));
+    const auto chunks = muxChunks(dir);
+    TEST_ASSERT_EQUAL_size_t(2, chunks.size());
+    const std::string sealed = muxDirOf(dir) + "/" + chunks[0];
+    const long body = muxFrameBytes(1) * static_cast<long>(kFramesPerChunk);
+    TEST_ASSERT_EQUAL_INT(body + static_cast<long>(LittleFsDataStorage::kMuxFooterBytes),
+                          sizeOf(sealed));
+    TEST_ASSERT_EQUAL_UINT8(LittleFsDataStorage::kMuxFooterMarker, readAll(sealed)[body]);
+
+    // Plant a pressure entry in the sealed chunk: its footer says it holds
+    // no pressure, so a pressure query never opens it.
+    overwriteByte(sealed, static_cast<long>(LittleFsDataStorage::kMuxFrameHeaderBytes), 1);
+    for (int round = 0; round < 2; ++round) {  // footer read, then cached
+        const auto pressure = storage.getSensorReadings("env_pressure", 0, UINT32_MAX);
+        TEST_ASSERT_EQUAL_size_t(1, pressure.size());
+        TEST_ASSERT_EQUAL_UINT32(5000, pressure[0].epoch);
+    }
+    LittleFsDataStorage restarted(dir.path(), nullptr, muxLayout());
+    TEST_ASSERT_EQUAL_size_t(
+        1, restarted.getSensorReadings("env_pressure", 0, UINT32_MAX).size());
+
+    // Soil moisture is in the chunk, so it is scanned (the planted frame
+    // no longer carries slot 0); a window past its epoch span skips it.
+    TEST_ASSERT_EQUAL_size_t(kFramesPerChunk - 1,
+                             restarted.getSensorReadings("soil_moisture", 0, 4999).size());
+    TEST_ASSERT_TRUE(restarted.getSensorReadings("soil_moisture", 4000, UINT32_MAX).empty());
+}
+
+void test_mux_layout_torn_tails_repaired(void)
+{
+    TempDir dir;
+    {
+        LittleFsDataStorage storage(dir.path(), nullptr, muxLayout());
+        const SensorReading pass[] = {
+            {"env_temperature", 100, 21.0f}, {"env_humidity", 100, 55.0f},
+        };
+        TEST_ASSERT_EQUAL_size_t(2, storage.storeSensorReadings(pass, 2));
+    }
+    // Power loss mid-frame.
+    const std::string chunk = muxDirOf(dir) + "/100.dat";
+    appendGarbage(chunk, 5);
+    {
+        LittleFsDataStorage storage(dir.path(), nullptr, muxLayout());
+        TEST_ASSERT_TRUE(storage.storeSensorReading("soil_ec", 160, 1.2f));
+        TEST_ASSERT_EQUAL_INT(muxFrameBytes(2) + muxFrameBytes(1), sizeOf(chunk));
+    }
+    // Power loss mid-footer: the seal is cut short, the chunk stays active.
+    const long before = sizeOf(chunk);
+    appendGarbage(chunk, 4);
+    overwriteByte(chunk, before, LittleFsDataStorage::kMuxFooterMarker);
+    {
+        LittleFsDataStorage storage(dir.path(), nullptr, muxLayout());
+        TEST_ASSERT_TRUE(storage.storeSensorReading("soil_ec", 220, 1.3f));
+        TEST_ASSERT_EQUAL_INT(before + muxFrameBytes(1), sizeOf(chunk));
+        TEST_ASSERT_EQUAL_size_t(1, muxChunks(dir).size());
+    }
+    // Power loss after a whole footer, before the next chunk: it stays
+    // sealed and the next append starts that chunk.
+    const long body = sizeOf(chunk);
+    const uint8_t footer[LittleFsDataStorage::kMuxFooterBytes] = {
+        LittleFsDataStorage::kMuxFooterMarker, 0x07, 0, 0, 0, 0, 0, 0, 0,
+        100, 0, 0, 0, 220, 0, 0, 0};
+    FILE* file = std::fopen(chunk.c_str(), "ab");
+    TEST_ASSERT_NOT_NULL(file);
+    TEST_ASSERT_EQUAL_size_t(sizeof(footer), std::fwrite(footer, 1, sizeof(footer), file));
+    TEST_ASSERT_EQUAL_INT(0, std::fclose(file));
+    LittleFsDataStorage storage(dir.path(), nullptr, muxLayout());
+    TEST_ASSERT_TRUE(storage.storeSensorReading("env_humidity", 280, 56.0f));
+    TEST_ASSERT_EQUAL_INT(body + static_cast<long>(sizeof(footer)), sizeOf(chunk));
+    TEST_ASSERT_EQUAL_size_t(2, muxChunks(dir).size());
+    const auto humidity = storage.getSensorReadings("env_humidity", 0, UINT32_MAX);
+    TEST_ASSERT_EQUAL_size_t(2, humidity.size());
+    TEST_ASSERT_EQUAL_FLOAT(56.0f, humidity[1].value);
+    TEST_ASSERT_EQUAL_size_t(2, storage.getSensorReadings("soil_ec", 0, UINT32_MAX).size());
+}
+
+void test_mux_layout_under_group_commit(void)
+{
+    TempDir dir;
+    FakeTimeProvider clock;
+    LittleFsDataStorageOptions options = groupCommit(clock);
+    options.historyFormat = HistoryFormat::Multiplexed;
+    LittleFsDataStorage storage(dir.path(), nullptr, options);
+
+    TEST_ASSERT_TRUE(storage.storeSensorReading("soil_moisture", 100, 40.0f));
+    TEST_ASSERT_TRUE(storage.storeSensorReading("soil_ec", 100, 1.2f));
+    TEST_ASSERT_TRUE(storage.storeSensorReading("soil_ec", 160, 1.3f));
+    TEST_ASSERT_TRUE(muxChunks(dir).empty());
+    TEST_ASSERT_TRUE(storage.flush());
+    TEST_ASSERT_EQUAL_INT(muxFrameBytes(2) + muxFrameBytes(1),
+                          sizeOf(muxDirOf(dir) + "/100.dat"));
+    const auto ec = storage.getSensorReadings("soil_ec", 0, UINT32_MAX);
+    TEST_ASSERT_EQUAL_size_t(2, ec.size());
+    TEST_ASSERT_EQUAL_FLOAT(1.3f, ec[1].value);
+}
+
+// --- Chunk summaries (LittleFsDataStorageOptions::chunkSummaries) -------
+
+LittleFsDataStorageOptions summarized(HistoryCodec codec = HistoryCodec::Fixed)
+{
+    LittleFsDataStorageOptions options = cachedIndex();
+    options.historyCodec = codec;
+    options.chunkSummaries = true;
+    return options;
+}
+
+std::string summaryDirOf(const TempDir& dir, const std::string& metric)
+{
+    return dir.path() + "/sum/" + metric;
+}
+
+void assertSameStats(const SensorWindowStats& expected, const SensorWindowStats& actual)
+{
+    TEST_ASSERT_EQUAL_UINT32(expected.count, actual.count);
+    TEST_ASSERT_EQUAL_FLOAT(expected.min, actual.min);
+    TEST_ASSERT_EQUAL_FLOAT(expected.max, actual.max);
+    TEST_ASSERT_FLOAT_WITHIN(1e-3f * std::fabs(expected.mean) + 1e-3f, expected.mean,
+                             actual.mean);
+    TEST_ASSERT_EQUAL_UINT32(expected.lastEpoch, actual.lastEpoch);
+    TEST_ASSERT_EQUAL_FLOAT(expected.last, actual.last);
+}
+
+void test_chunk_summaries_match_the_records(void)
+{
+    for (HistoryCodec codec : {HistoryCodec::Fixed, HistoryCodec::Delta}) {
+        TempDir dir;
+        LittleFsDataStorage storage(dir.path(), nullptr, summarized(codec));
+        const std::string metric = "soil_moisture";
+        const uint32_t base = 100000;
+        // Delta frames of this series are ~2 bytes: more records to seal.
+        const std::size_t count = (codec == HistoryCodec::Delta ? 8 : 3) * kRecordsPerChunk + 100;
+        appendSeries(storage, metric, base, count, 60);
+
+        // One 45-byte summary per sealed chunk, none for the active one.
+        const auto chunks = sortedListDir(metricDirOf(dir, metric));
+        const auto sums = sortedListDir(summaryDirOf(dir, metric));
+        TEST_ASSERT_TRUE(chunks.size() >= 2);
+        TEST_ASSERT_EQUAL_size_t(chunks.size() - 1, sums.size());
+        for (const std::string& sum : sums) {
+            TEST_ASSERT_EQUAL_INT(static_cast<long>(LittleFsDataStorage::kSummaryBytes),
+                                  sizeOf(summaryDirOf(dir, metric) + "/" + sum));
+        }
+
+        // Same answers as the plain fold over the same files.
+        LittleFsDataStorage plain(dir.path());
+        const uint32_t windows[][2] = {
+            {0, UINT32_MAX}, {base + 500 * 60, base + 3000 * 60}, {base + 2000 * 60, base}};
+        for (const auto& w : windows) {
+            assertSameStats(plain.getSensorWindowStats(metric, w[0], w[1]),
+                            storage.getSensorWindowStats(metric, w[0], w[1]));
+        }
+        for (uint32_t bucketS : {86400u * 7, 3600u * 5}) {
+            const auto expected = plain.getSensorAggregates(metric, 0, UINT32_MAX, bucketS);
+            const auto actual = storage.getSensorAggregates(metric, 0, UINT32_MAX, bucketS);
+            TEST_ASSERT_EQUAL_size_t(expected.size(), actual.size());
+            for (std::size_t i = 0; i < expected.size(); ++i) {
+                TEST_ASSERT_EQUAL_UINT32(expected[i].epoch, actual[i].epoch);
+                TEST_ASSERT_EQUAL_UINT32(expected[i].count, actual[i].count);
+                TEST_ASSERT_EQUAL_FLOAT(expected[i].min, actual[i].min);
+                TEST_ASSERT_EQUAL_FLOAT(expected[i].max, actual[i].max);
+                TEST_ASSERT_FLOAT_WITHIN(1e-4f * expected[i].sum + 1.0f, expected[i].sum,
+                                         actual[i].sum);
+            }
+        }
+    }
+}
+
+void test_chunk_summaries_stand_in_for_sealed_chunks(void)
+{
+    TempDir dir;
+    LittleFsDataStorage storage(dir.path(), nullptr, summarized());
+    const std::string metric = "soil_moisture";
+    appendSeries(storage, metric, 100000, 2 * kRecordsPerChunk + 10, 60);
+    const auto chunks = sortedListDir(metricDirOf(dir, metric));
+    TEST_ASSERT_EQUAL_size_t(3, chunks.size());
+    const SensorWindowStats before = storage.getSensorWindowStats(metric, 0, UINT32_MAX);
+
+    // Damage the oldest chunk's first value (0.0f -> ~1.7e38): the window
+    // stats still come from its summary, a plain read sees the damage.
+    const std::string oldest = metricDirOf(dir, metric) + "/" + chunks[0];
+    overwriteByte(oldest, 7, 0x7F);
+    assertSameStats(before, storage.getSensorWindowStats(metric, 0, UINT32_MAX));
+    LittleFsDataStorage plain(dir.path());
+    TEST_ASSERT_TRUE(plain.getSensorWindowStats(metric, 0, UINT32_MAX).max > 1e37f);
+
+    // The scrub finds it: both summarized chunks in one call, then one per
+    // call, resuming where the last one stopped.
+    TEST_ASSERT_EQUAL_size_t(1, storage.scrubHistory(8));
+    TEST_ASSERT_EQUAL_size_t(1, storage.scrubHistory(1));
+    TEST_ASSERT_EQUAL_size_t(0, storage.scrubHistory(1));
+    TEST_ASSERT_EQUAL_size_t(0, plain.scrubHistory(8));  // summaries off
+
+    // A torn summary is ignored: the chunk is read again.
+    const std::string sum = summaryDirOf(dir, metric) + "/" + sortedListDir(summaryDirOf(dir, metric))[0];
+    TEST_ASSERT_EQUAL_INT(0, ::truncate(sum.c_str(), 20));
+    TEST_ASSERT_TRUE(storage.getSensorWindowStats(metric, 0, UINT32_MAX).max > 1e37f);
+}
+
+void test_chunk_summaries_leave_with_their_chunks(void)
+{
+    TempDir dir;
+    LittleFsDataStorage storage(dir.path(), nullptr, summarized());
+    const std::string metric = "env_pressure";
+    appendSeries(storage, metric, 100000, kMetricCapacity + kRecordsPerChunk, 60);
+    const auto chunks = sortedListDir(metricDirOf(dir, metric));
+    const auto sums = sortedListDir(summaryDirOf(dir, metric));
+    TEST_ASSERT_EQUAL_size_t(LittleFsDataStorage::kHistoryMaxChunksPerMetric, chunks.size());
+    TEST_ASSERT_EQUAL_size_t(chunks.size() - 1, sums.size());
+    for (std::size_t i = 0; i < sums.size(); ++i) {
+        // "<first_epoch>.dat" next to "<first_epoch>.sum".
+        TEST_ASSERT_EQUAL_STRING(chunks[i].substr(0, chunks[i].find('.')).c_str(),
+                                 sums[i].substr(0, sums[i].find('.')).c_str());
+    }
+}
+
+// --- Sparse range queries (ascending chunks, binary search) ------------
+
+void test_range_query_skips_chunks_outside_window(void)
+{
+    TempDir dir;
+    LittleFsDataStorage storage(dir.path(), nullptr, cachedIndex());
+    const std::string metric = "soil_moisture";
+    const uint32_t base = 100000;
+    const uint32_t step = 60;
+
+    // Three full chunks and a partial one, one record per minute.
+    const std::size_t total = 3 * kRecordsPerChunk + 100;
+    appendSeries(storage, metric, base, total, step);
+    const auto chunks = sortedListDir(metricDirOf(dir, metric));
+    TEST_ASSERT_EQUAL_size_t(4, chunks.size());
+
+    // Plant an in-window record in the oldest chunk: a query that skips
+    // chunks by filename epoch never opens it, so it must not show up.
+    const uint32_t lastEpoch = base + static_cast<uint32_t>(total - 1) * step;
+    const uint8_t planted[LittleFsDataStorage::kHistoryRecordBytes] = {
+        static_cast<uint8_t>(lastEpoch & 0xFF),
+        static_cast<uint8_t>((lastEpoch >> 8) & 0xFF),
+        static_cast<uint8_t>((lastEpoch >> 16) & 0xFF),
+        static_cast<uint8_t>(lastEpoch >> 24), 0, 0, 0, 0};
+    appendBytes(metricDirOf(dir, metric) + "/" + std::to_string(base) + ".dat",
+                planted, sizeof(planted));
+
+    // The last hour: 60 records, all from the newest chunk.
+    const auto hour = storage.getSensorReadings(metric, lastEpoch - 3599, lastEpoch);
+    TEST_ASSERT_EQUAL_size_t(60, hour.size());
+    TEST_ASSERT_EQUAL_UINT32(lastEpoch - 59 * step, hour.front().epoch);
+    TEST_ASSERT_EQUAL_FLOAT(static_cast<float>(total - 60), hour.front().value);
+    TEST_ASSERT_EQUAL_UINT32(lastEpoch, hour.back().epoch);
+
+    // Window edges on and between records, across a chunk boundary (clear
+    // of the planted chunk).
+    const uint32_t boundary = base + static_cast<uint32_t>(2 * kRecordsPerChunk) * step;
+    const auto across = storage.getSensorReadings(metric, boundary - step, boundary);
+    TEST_ASSERT_EQUAL_size_t(2, across.size());
+    TEST_ASSERT_EQUAL_UINT32(boundary - step, across[0].epoch);
+    TEST_ASSERT_EQUAL_UINT32(boundary, across[1].epoch);
+    const auto between = storage.getSensorReadings(metric, boundary + 1, boundary + step - 1);
+    TEST_ASSERT_TRUE(between.empty());
+    const auto first = storage.getSensorReadings(metric, 0, base);
+    TEST_ASSERT_EQUAL_size_t(1, first.size());
+    TEST_ASSERT_TRUE(storage.getSensorReadings(metric, lastEpoch + 1, UINT32_MAX).empty());
+}
+
+void test_backwards_epoch_falls_back_to_full_scan(void)
+{
+    TempDir dir;
+    LittleFsDataStorage storage(dir.path());
+    const std::string metric = "env_temperature";
+
+    // A clock step back inside one chunk: the chunk is renamed before the
+    // record lands, and every query scans it in full.
+    TEST_ASSERT_TRUE(storage.storeSensorReading(metric, 100, 1.0f));
+    TEST_ASSERT_TRUE(storage.storeSensorReading(metric, 200, 2.0f));
+    TEST_ASSERT_TRUE(storage.storeSensorReading(metric, 150, 3.0f));
+    TEST_ASSERT_TRUE(storage.storeSensorReading(metric, 300, 4.0f));
+    const auto chunks = listDir(metricDirOf(dir, metric));
+    TEST_ASSERT_EQUAL_size_t(1, chunks.size());
+    TEST_ASSERT_EQUAL_STRING("100.u.dat", chunks[0].c_str());
+
+    const auto window = storage.getSensorReadings(metric, 140, 160);
+    TEST_ASSERT_EQUAL_size_t(1, window.size());
+    TEST_ASSERT_EQUAL_FLOAT(3.0f, window[0].value);
+    TEST_ASSERT_EQUAL_size_t(4, storage.getSensorReadings(metric, 0, UINT32_MAX).size());
+
+    // Once the ring has turned over, the fast path is back.
+    appendSeries(storage, metric, 1000, kMetricCapacity, 1);
+    for (const std::string& name : listDir(metricDirOf(dir, metric))) {
+        TEST_ASSERT_TRUE(name.find(".u.") == std::string::npos);
+    }
+    TEST_ASSERT_EQUAL_size_t(
+        2, storage.getSensorReadings(metric, 5000, 5001).size());
+}
+
+// --- Rollup tiers (LittleFsDataStorageOptions::rollups) ----------------
+
+LittleFsDataStorageOptions withRollups()
+{
+    LittleFsDataStorageOptions options = cachedIndex();
+    options.rollups = true;
+    return options;
+}
+
+std::string rollupDirOf(const TempDir& dir, const char* tier,
+                        const std::string& metric)
+{
+    return dir.path() + "/rollup/" + tier + "/" + metric;
+}
+
+/// Bytes of finished buckets in one tier ring.
+long rollupBytes(const TempDir& dir, const char* tier, const std::string& metric)
+{
+    long total = 0;
+    for (const std::string& name : listDir(rollupDirOf(dir, tier, metric))) {
+        total += sizeOf(rollupDirOf(dir, tier, metric) + "/" + name);
+    }
+    return total;
+}
+
+/// Same buckets as bucketing the raw readings (the interface default).
+void assertAggregatesMatchRaw(const LittleFsDataStorage& storage,
+                              const std::string& metric, uint32_t t0,
+                              uint32_t t1, uint32_t bucketS)
+{
+    const auto rolled = storage.getSensorAggregates(metric, t0, t1, bucketS);
+    const auto raw = storage.IDataStorage::getSensorAggregates(metric, t0, t1, bucketS);
+    TEST_ASSERT_EQUAL_size_t(raw.size(), rolled.size());
+    for (std::size_t i = 0; i < raw.size(); ++i) {
+        TEST_ASSERT_EQUAL_UINT32(raw[i].epoch, rolled[i].epoch);
+        TEST_ASSERT_EQUAL_UINT32(raw[i].count, rolled[i].count);
+        TEST_ASSERT_EQUAL_FLOAT(raw[i].min, rolled[i].min);
+        TEST_ASSERT_EQUAL_FLOAT(raw[i].max, rolled[i].max);
+        TEST_ASSERT_EQUAL_FLOAT(raw[i].sum, rolled[i].sum);
+    }
+}
+
+void test_aggregate_default_buckets_raw_readings(void)
+{
+    MockDataStorage mock;
+    for (uint32_t epoch : {3500u, 3600u, 3700u, 7300u}) {
+        TEST_ASSERT_TRUE(
+            mock.storeSensorReading("soil_ec", epoch, static_cast<float>(epoch) / 100));
+    }
+    // t0 inside bucket 3600: the whole bucket is reported, the one before
+    // is not; the last bucket is cut at t1.
+    const auto buckets = mock.getSensorAggregates("soil_ec", 3650, 7300, 3600);
+    TEST_ASSERT_EQUAL_size_t(2, buckets.size());
+    TEST_ASSERT_EQUAL_UINT32(3600, buckets[0].epoch);
+    TEST_ASSERT_EQUAL_UINT32(2, buckets[0].count);
+    TEST_ASSERT_EQUAL_FLOAT(36.0f, buckets[0].min);
+    TEST_ASSERT_EQUAL_FLOAT(37.0f, buckets[0].max);
+    TEST_ASSERT_EQUAL_FLOAT(73.0f, buckets[0].sum);
+    TEST_ASSERT_EQUAL_UINT32(7200, buckets[1].epoch);
+    TEST_ASSERT_EQUAL_UINT32(1, buckets[1].count);
+    TEST_ASSERT_TRUE(mock.getSensorAggregates("soil_ec", 0, 7300, 0).empty());
+    TEST_ASSERT_TRUE(mock.getSensorAggregates("soil_ec", 10, 5, 60).empty());
+}
+
+void test_rollup_tiers_hold_finished_buckets(void)
+{
+    TempDir dir;
+    LittleFsDataStorage storage(dir.path(), nullptr, withRollups());
+    const std::string metric = "env_temperature";
+    const uint32_t day = 1750982400;  // UTC midnight
+
+    // Three hours at the 5-min default, values sawtoothing per hour.
+    for (uint32_t i = 0; i < 36; ++i) {
+        TEST_ASSERT_TRUE(storage.storeSensorReading(
+            metric, day + i * 300, 20.0f + static_cast<float>(i % 12)));
+    }
+    // Hours 0 and 1 are finished; hour 2 is still open. Every minute bucket
+    // but the newest is finished, nothing of the day is.
+    TEST_ASSERT_EQUAL_INT(2 * static_cast<long>(rollup::kRecordBytes),
+                          rollupBytes(dir, "1h", metric));
+    TEST_ASSERT_EQUAL_INT(35 * static_cast<long>(rollup::kRecordBytes),
+                          rollupBytes(dir, "1m", metric));
+    TEST_ASSERT_EQUAL_INT(0, rollupBytes(dir, "1d", metric));
+
+    const auto hours = storage.getSensorAggregates(metric, day, day + 3 * 3600, 3600);
+    TEST_ASSERT_EQUAL_size_t(3, hours.size());
+    TEST_ASSERT_EQUAL_UINT32(day + 3600, hours[1].epoch);
+    TEST_ASSERT_EQUAL_UINT32(12, hours[1].count);
+    TEST_ASSERT_EQUAL_FLOAT(20.0f, hours[1].min);
+    TEST_ASSERT_EQUAL_FLOAT(31.0f, hours[1].max);
+    for (uint32_t bucketS : IDataStorage::kAggregateBucketsS) {
+        assertAggregatesMatchRaw(storage, metric, day, day + 3 * 3600, bucketS);
+        assertAggregatesMatchRaw(storage, metric, day + 1000, day + 8000, bucketS);
+    }
+    // A width without a tier is answered from raw history.
+    assertAggregatesMatchRaw(storage, metric, day, day + 3 * 3600, 900);
+}
+
+void test_rollup_backfills_and_survives_restart(void)
+{
+    TempDir dir;
+    const std::string metric = "soil_moisture";
+    const uint32_t base = 1750982400;
+    {
+        // Two days of history written without rollups.
+        LittleFsDataStorage plain(dir.path(), nullptr, cachedIndex());
+        appendSeries(plain, metric, base, 576, 300);
+    }
+    TEST_ASSERT_TRUE(listDir(dir.path() + "/rollup").empty());
+
+    {
+        // The first append with rollups on backfills every tier.
+        LittleFsDataStorage storage(dir.path(), nullptr, withRollups());
+        TEST_ASSERT_TRUE(storage.storeSensorReading(metric, base + 576 * 300, 1.0f));
+        TEST_ASSERT_EQUAL_INT(2 * static_cast<long>(rollup::kRecordBytes),
+                              rollupBytes(dir, "1d", metric));
+        TEST_ASSERT_EQUAL_INT(48 * static_cast<long>(rollup::kRecordBytes),
+                              rollupBytes(dir, "1h", metric));
+        assertAggregatesMatchRaw(storage, metric, 0, UINT32_MAX, 86400);
+    }
+
+    // Restarted mid-bucket: the open bucket comes from raw history, and the
+    // next boundary finishes it from raw history too — nothing lost.
+    LittleFsDataStorage restarted(dir.path(), nullptr, withRollups());
+    appendSeries(restarted, metric, base + 577 * 300, 30, 300);
+    TEST_ASSERT_EQUAL_INT(50 * static_cast<long>(rollup::kRecordBytes),
+                          rollupBytes(dir, "1h", metric));
+    for (uint32_t bucketS : IDataStorage::kAggregateBucketsS) {
+        assertAggregatesMatchRaw(restarted, metric, 0, UINT32_MAX, bucketS);
+    }
+}
+
+void test_rollup_rings_stay_bounded(void)
+{
+    TempDir dir;
+    LittleFsDataStorage storage(dir.path(), nullptr, withRollups());
+    const std::string metric = "soil_ph";
+
+    // One reading per minute for five hours: 300 minute buckets, more than
+    // the minute ring's two chunks hold.
+    appendSeries(storage, metric, 1750982400, 300, 60);
+    const rollup::Tier& minute = rollup::kTiers[0];
+    const auto chunks = listDir(rollupDirOf(dir, minute.dir, metric));
+    TEST_ASSERT_EQUAL_size_t(minute.maxChunks, chunks.size());
+    for (const std::string& chunk : chunks) {
+        TEST_ASSERT_TRUE(sizeOf(rollupDirOf(dir, minute.dir, metric) + "/" + chunk) <=
+                         static_cast<long>(minute.chunkBytes));
+    }
+    // Evicted minute buckets are still answered, from raw history.
+    assertAggregatesMatchRaw(storage, metric, 0, UINT32_MAX, 60);
+    TEST_ASSERT_EQUAL_size_t(300, storage.getSensorAggregates(metric, 0, UINT32_MAX, 60).size());
+}
+
+// --- Quantile sketches (LittleFsDataStorageOptions::quantileSketches) --
+
+LittleFsDataStorageOptions withSketches()
+{
+    LittleFsDataStorageOptions options = withRollups();
+    options.quantileSketches = true;
+    return options;
+}
+
+/// Exact value at rank q of sorted `values` (nearest rank below).
+float exactQuantile(const std::vector<float>& sorted, double q)
+{
+    return sorted[static_cast<std::size_t>(q * static_cast<double>(sorted.size() - 1))];
+}
+
+/// Same count as the raw fold, percentiles within `tolerance` of it.
+void assertQuantilesMatchRaw(const LittleFsDataStorage& storage, const std::string& metric,
+                             uint32_t t0, uint32_t t1, float tolerance)
+{
+    const QuantileSketch merged = storage.getSensorQuantiles(metric, t0, t1);
+    const QuantileSketch raw = storage.IDataStorage::getSensorQuantiles(metric, t0, t1);
+    TEST_ASSERT_EQUAL_UINT32(raw.count(), merged.count());
+    TEST_ASSERT_EQUAL_FLOAT(raw.min(), merged.min());
+    TEST_ASSERT_EQUAL_FLOAT(raw.max(), merged.max());
+    for (double q : {0.05, 0.5, 0.95}) {
+        TEST_ASSERT_FLOAT_WITHIN(tolerance, raw.quantile(q), merged.quantile(q));
+    }
+}
+
+/// 0 .. 100, spread evenly but out of order.
+float scattered(std::size_t i)
+{
+    return static_cast<float>((i * 37) % 101);
+}
+
+void test_quantile_sketch_estimates_and_merges(void)
+{
+    QuantileSketch empty;
+    TEST_ASSERT_EQUAL_UINT32(0, empty.count());
+    TEST_ASSERT_EQUAL_FLOAT(0.0f, empty.quantile(0.5));
+
+    // A skewed stream: u * u * 100 for u uniform in [0, 1).
+    QuantileSketch whole;
+    QuantileSketch odd;
+    QuantileSketch even;
+    std::vector<float> values;
+    uint32_t x = 12345;
+    for (std::size_t i = 0; i < 20000; ++i) {
+        x = x * 1664525u + 1013904223u;
+        const float u = static_cast<float>(x >> 8) / 16777216.0f;
+        values.push_back(u * u * 100.0f);
+        whole.add(values.back());
+        (i % 2 != 0 ? odd : even).add(values.back());
+    }
+    whole.add(NAN);  // no rank: skipped
+    TEST_ASSERT_EQUAL_UINT32(20000, whole.count());
+    std::sort(values.begin(), values.end());
+    TEST_ASSERT_EQUAL_FLOAT(values.front(), whole.quantile(0.0));
+    TEST_ASSERT_EQUAL_FLOAT(values.back(), whole.quantile(1.0));
+    odd.merge(even);
+    TEST_ASSERT_EQUAL_UINT32(20000, odd.count());
+    for (double q : {0.05, 0.5, 0.95}) {
+        TEST_ASSERT_FLOAT_WITHIN(2.0f, exactQuantile(values, q), whole.quantile(q));
+        TEST_ASSERT_FLOAT_WITHIN(2.0f, exactQuantile(values, q), odd.quantile(q));
+    }
+
+    // The encoding holds the whole sketch.
+    uint8_t bytes[QuantileSketch::kEncodedBytes];
+    whole.encode(bytes);
+    QuantileSketch decoded;
+    TEST_ASSERT_TRUE(decoded.decode(bytes));
+    TEST_ASSERT_EQUAL_UINT32(whole.count(), decoded.count());
+    for (double q : {0.0, 0.05, 0.5, 0.95, 1.0}) {
+        TEST_ASSERT_EQUAL_FLOAT(whole.quantile(q), decoded.quantile(q));
+    }
+    bytes[8] = QuantileSketch::kCentroids + 1;
+    TEST_ASSERT_FALSE(decoded.decode(bytes));
+    TEST_ASSERT_EQUAL_UINT32(0, decoded.count());
+}
+
+void test_quantile_sketches_follow_hour_and_day_buckets(void)
+{
+    TempDir dir;
+    LittleFsDataStorage storage(dir.path(), nullptr, withSketches());
+    const std::string metric = "soil_moisture";
+    const uint32_t day = 1750982400;  // UTC midnight
+
+    // Three days at the 5-min default.
+    for (std::size_t i = 0; i < 864; ++i) {
+        TEST_ASSERT_TRUE(storage.storeSensorReading(
+            metric, day + static_cast<uint32_t>(i) * 300, scattered(i)));
+    }
+    // Hour 71 and day 2 are still open.
+    TEST_ASSERT_EQUAL_INT(71 * static_cast<long>(rollup::kSketchRecordBytes),
+                          rollupBytes(dir, "1h-q", metric));
+    TEST_ASSERT_EQUAL_INT(2 * static_cast<long>(rollup::kSketchRecordBytes),
+                          rollupBytes(dir, "1d-q", metric));
+
+    // Whole days, whole hours at the edges, raw readings at the edges of
+    // those: the count is exact, the percentiles close.
+    assertQuantilesMatchRaw(storage, metric, 0, UINT32_MAX, 3.0f);
+    assertQuantilesMatchRaw(storage, metric, day + 1000, day + 2 * 86400 + 5000, 3.0f);
+    assertQuantilesMatchRaw(storage, metric, day + 3600, day + 7199, 3.0f);
+    assertQuantilesMatchRaw(storage, metric, day + 100, day + 200, 0.0f);
+    TEST_ASSERT_EQUAL_UINT32(0, storage.getSensorQuantiles(metric, day - 100, day - 1).count());
+    TEST_ASSERT_EQUAL_UINT32(0, storage.getSensorQuantiles(metric, 10, 5).count());
+}
+
+void test_quantile_sketches_start_at_the_next_boundary(void)
+{
+    TempDir dir;
+    const std::string metric = "env_humidity";
+    const uint32_t day = 1750982400;
+    {
+        // Rollups without sketches for a day and a half.
+        LittleFsDataStorage storage(dir.path(), nullptr, withRollups());
+        for (std::size_t i = 0; i < 432; ++i) {
+            TEST_ASSERT_TRUE(storage.storeSensorReading(
+                metric, day + static_cast<uint32_t>(i) * 300, scattered(i)));
+        }
+    }
+    TEST_ASSERT_EQUAL_INT(0, rollupBytes(dir, "1h-q", metric));
+
+    // Turned on: buckets the tiers already finished stay raw-only, the
+    // next ones are sketched; queries cover both.
+    LittleFsDataStorage storage(dir.path(), nullptr, withSketches());
+    for (std::size_t i = 432; i < 600; ++i) {
+        TEST_ASSERT_TRUE(storage.storeSensorReading(
+            metric, day + static_cast<uint32_t>(i) * 300, scattered(i)));
+    }
+    TEST_ASSERT_EQUAL_INT(14 * static_cast<long>(rollup::kSketchRecordBytes),
+                          rollupBytes(dir, "1h-q", metric));
+    TEST_ASSERT_EQUAL_INT(static_cast<long>(rollup::kSketchRecordBytes),
+                          rollupBytes(dir, "1d-q", metric));
+    assertQuantilesMatchRaw(storage, metric, 0, UINT32_MAX, 3.0f);
+    assertQuantilesMatchRaw(storage, metric, day + 40000, day + 50000, 3.0f);
+}
+
+// --- Delta codec (LittleFsDataStorageOptions::historyCodec) -----------
+
+LittleFsDataStorageOptions deltaCodec(bool cache = true)
+{
+    LittleFsDataStorageOptions options;
+    options.cacheChunkIndex = cache;
+    options.historyCodec = HistoryCodec::Delta;
+    return options;
+}
+
+/// Total bytes of a metric's chunk files.
+long historyBytes(const TempDir& dir, const std::string& metric)
+{
+    long total = 0;
+    for (const std::string& name : listDir(metricDirOf(dir, metric))) {
+        total += sizeOf(metricDirOf(dir, metric) + "/" + name);
+    }
+    return total;
+}
+
+void test_delta_codec_frames_round_trip(void)
+{
+    const uint32_t epochs[] = {1750982400, 1750982700, 1750983000, 1750983001,
+                               1750983301, 1750960000, 1750990000, 0, UINT32_MAX};
+    const float values[] = {21.5f, 21.5f, 21.5f, -3.25f, 0.0f, 1e30f, 21.5f, 7.0f, 7.0f};
+    uint8_t chunk[sizeof(epochs) / sizeof(epochs[0]) * deltachunk::kMaxFrameBytes];
+    std::size_t used = 0;
+    std::size_t lengths[sizeof(epochs) / sizeof(epochs[0])];
+    deltachunk::State writer;
+    for (std::size_t i = 0; i < sizeof(epochs) / sizeof(epochs[0]); ++i) {
+        lengths[i] = deltachunk::encode(chunk + used, writer, epochs[i], values[i]);
+        TEST_ASSERT_TRUE(lengths[i] >= 1 && lengths[i] <= deltachunk::kMaxFrameBytes);
+        used += lengths[i];
+    }
+    // The first frame is absolute; once the interval is established, a
+    // repeated value at the same interval is the tag byte alone.
+    TEST_ASSERT_EQUAL_size_t(1 + 4 + 2, lengths[0]);  // 21.5f = 0x41AC0000
+    TEST_ASSERT_EQUAL_size_t(1 + 2, lengths[1]);      // dod 300, value same
+    TEST_ASSERT_EQUAL_size_t(1, lengths[2]);
+
+    deltachunk::State reader;
+    std::size_t pos = 0;
+    for (std::size_t i = 0; i < sizeof(epochs) / sizeof(epochs[0]); ++i) {
+        uint32_t epoch = 0;
+        float value = 0.0f;
+        TEST_ASSERT_EQUAL_size_t(
+            lengths[i], deltachunk::decode(chunk + pos, used - pos, reader, epoch, value));
+        TEST_ASSERT_EQUAL_UINT32(epochs[i], epoch);
+        TEST_ASSERT_EQUAL_FLOAT(values[i], value);
+        pos += lengths[i];
+    }
+
+    // A frame shorter than its tag declares, a reserved bit, or a relative
+    // frame opening a chunk is never a whole frame.
+    uint32_t epoch = 0;
+    float value = 0.0f;
+    deltachunk::State fresh;
+    TEST_ASSERT_EQUAL_size_t(0, deltachunk::decode(chunk, lengths[0] - 1, fresh, epoch, value));
+    TEST_ASSERT_FALSE(fresh.started);
+    const uint8_t reserved[] = {0x01};
+    TEST_ASSERT_EQUAL_size_t(0, deltachunk::decode(reserved, 1, reader, epoch, value));
+    const uint8_t relative[] = {0x00};
+    TEST_ASSERT_EQUAL_size_t(0, deltachunk::decode(relative, 1, fresh, epoch, value));
+}
+
+void test_delta_chunks_hold_several_times_the_history(void)
+{
+    TempDir dir;
+    LittleFsDataStorage storage(dir.path(), nullptr, deltaCodec());
+    const std::string metric = "soil_moisture";
+    const uint32_t base = 1750982400;
+
+    // 30 days at the 5-min default; a 0.1-resolution reading that moves
+    // every fourth pass, as slow soil moisture does.
+    const std::size_t total = 8640;
+    for (std::size_t i = 0; i < total; ++i) {
+        TEST_ASSERT_TRUE(storage.storeSensorReading(
+            metric, base + static_cast<uint32_t>(i) * kLogIntervalS,
+            40.0f + static_cast<float>(i / 4 % 50) / 10.0f));
+    }
+    for (const std::string& name : listDir(metricDirOf(dir, metric))) {
+        TEST_ASSERT_TRUE(name.size() > 3 && name.compare(name.size() - 3, 3, ".dz") == 0);
+    }
+    // At least 4x denser than 8-byte records.
+    TEST_ASSERT_TRUE(historyBytes(dir, metric) * 4 <=
+                     static_cast<long>(total * LittleFsDataStorage::kHistoryRecordBytes));
+
+    const auto all = storage.getSensorReadings(metric, 0, UINT32_MAX);
+    TEST_ASSERT_EQUAL_size_t(total, all.size());
+    for (std::size_t i = 0; i < total; i += 97) {
+        TEST_ASSERT_EQUAL_UINT32(base + static_cast<uint32_t>(i) * kLogIntervalS,
+                                 all[i].epoch);
+        TEST_ASSERT_EQUAL_FLOAT(40.0f + static_cast<float>(i / 4 % 50) / 10.0f,
+                                all[i].value);
+    }
+    // Range edges on and between records, restart included.
+    LittleFsDataStorage restarted(dir.path(), nullptr, deltaCodec());
+    const uint32_t mid = base + 5000 * kLogIntervalS;
+    TEST_ASSERT_EQUAL_size_t(2, restarted.getSensorReadings(metric, mid - kLogIntervalS, mid).size());
+    TEST_ASSERT_TRUE(restarted.getSensorReadings(metric, mid + 1, mid + kLogIntervalS - 1).empty());
+}
+
+void test_delta_chunks_seal_evict_and_match_stateless(void)
+{
+    TempDir cachedDir;
+    TempDir statelessDir;
+    LittleFsDataStorage cached(cachedDir.path(), nullptr, deltaCodec(true));
+    LittleFsDataStorage stateless(statelessDir.path(), nullptr, deltaCodec(false));
+    const std::string metric = "env_humidity";
+
+    // Distinct values every record (worst-ish case) until the ring turns.
+    const std::size_t total = 4 * kMetricCapacity;
+    appendSeries(cached, metric, 1000, total, 60);
+    appendSeries(stateless, metric, 1000, total, 60);
+
+    const auto chunks = sortedListDir(metricDirOf(cachedDir, metric));
+    TEST_ASSERT_EQUAL_size_t(LittleFsDataStorage::kHistoryMaxChunksPerMetric, chunks.size());
+    TEST_ASSERT_TRUE(chunks == sortedListDir(metricDirOf(statelessDir, metric)));
+    for (const std::string& name : chunks) {
+        const long size = sizeOf(metricDirOf(cachedDir, metric) + "/" + name);
+        TEST_ASSERT_TRUE(size <= static_cast<long>(LittleFsDataStorage::kHistoryChunkMaxBytes));
+        TEST_ASSERT_EQUAL_INT(size, sizeOf(metricDirOf(statelessDir, metric) + "/" + name));
+    }
+    // The newest record survives; ranges stay chronological.
+    const uint32_t last = 1000 + static_cast<uint32_t>(total - 1) * 60;
+    const auto tail = cached.getSensorReadings(metric, last - 599, last);
+    TEST_ASSERT_EQUAL_size_t(10, tail.size());
+    TEST_ASSERT_EQUAL_FLOAT(static_cast<float>(total - 1), tail.back().value);
+}
+
+void test_delta_chunk_torn_frame_repaired(void)
+{
+    TempDir dir;
+    const std::string metric = "soil_ph";
+    {
+        LittleFsDataStorage storage(dir.path(), nullptr, deltaCodec());
+        appendSeries(storage, metric, 500, 20, 300);
+    }
+    const std::string path = singleChunkPath(dir, metric);
+    const long committed = sizeOf(path);
+
+    // Power loss mid-frame: a tag declaring four value bytes, one written.
+    const uint8_t torn[] = {0x20, 0x42};
+    appendBytes(path, torn, sizeof(torn));
+    LittleFsDataStorage storage(dir.path(), nullptr, deltaCodec());
+    TEST_ASSERT_EQUAL_size_t(20, storage.getSensorReadings(metric, 0, UINT32_MAX).size());
+
+    // The next append truncates to the valid prefix and continues the
+    // chunk's codec state.
+    TEST_ASSERT_TRUE(storage.storeSensorReading(metric, 500 + 20 * 300, 20.0f));
+    TEST_ASSERT_TRUE(sizeOf(path) > committed && sizeOf(path) < committed + 3);
+    const auto all = storage.getSensorReadings(metric, 0, UINT32_MAX);
+    TEST_ASSERT_EQUAL_size_t(21, all.size());
+    TEST_ASSERT_EQUAL_UINT32(500 + 20 * 300, all.back().epoch);
+    TEST_ASSERT_EQUAL_FLOAT(20.0f, all.back().value);
+}
+
+void test_codec_switch_keeps_existing_chunks(void)
+{
+    TempDir dir;
+    const std::string metric = "env_temperature";
+    {
+        LittleFsDataStorage fixed(dir.path(), nullptr, cachedIndex());
+        appendSeries(fixed, metric, 1000, kRecordsPerChunk - 1, 1);
+    }
+    // Delta from now on: the active fixed chunk is finished first.
+    LittleFsDataStorage storage(dir.path(), nullptr, deltaCodec());
+    appendSeries(storage, metric, 1000 + kRecordsPerChunk - 1, 3, 1);
+    auto chunks = sortedListDir(metricDirOf(dir, metric));
+    TEST_ASSERT_EQUAL_size_t(2, chunks.size());
+    TEST_ASSERT_EQUAL_STRING("1000.dat", chunks[0].c_str());
+    TEST_ASSERT_EQUAL_STRING("2024.dz", chunks[1].c_str());
+    TEST_ASSERT_EQUAL_size_t(4, storage.getSensorReadings(metric, 2022, 2030).size());
+
+    // A backwards epoch marks the delta chunk unordered like a fixed one.
+    TEST_ASSERT_TRUE(storage.storeSensorReading(metric, 1500, -1.0f));
+    chunks = sortedListDir(metricDirOf(dir, metric));
+    TEST_ASSERT_EQUAL_STRING("2024.u.dz", chunks[1].c_str());
+    const auto window = storage.getSensorReadings(metric, 1500, 1500);
+    TEST_ASSERT_EQUAL_size_t(2, window.size());
+    TEST_ASSERT_EQUAL_FLOAT(-1.0f, window[1].value);
+    TEST_ASSERT_EQUAL_size_t(kRecordsPerChunk + 3,
+                             storage.getSensorReadings(metric, 0, UINT32_MAX).size());
+}
+
+// --- Background maintenance (LittleFsDataStorageOptions::backgroundMaintenance)
+
+LittleFsDataStorageOptions maintained()
+{
+    LittleFsDataStorageOptions options = summarized(HistoryCodec::Delta);
+    options.backgroundMaintenance = true;
+    return options;
+}
+
+/// maintain() until nothing is pending; the steps that reported more.
+std::size_t maintainAll(IDataStorage& storage)
+{
+    std::size_t steps = 0;
+    while (storage.maintain()) {
+        TEST_ASSERT_TRUE(++steps < 1000);
+    }
+    return steps;
+}
+
+void test_maintenance_recompacts_sealed_fixed_chunks(void)
+{
+    TempDir dir;
+    const std::string metric = "soil_moisture";
+    const uint32_t base = 100000;
+    const std::size_t total = 3 * kRecordsPerChunk + 100;
+    {
+        LittleFsDataStorage fixed(dir.path(), nullptr, summarized());
+        appendSeries(fixed, metric, base, total, 60);
+    }
+    const auto before = LittleFsDataStorage(dir.path()).getSensorReadings(metric, 0, UINT32_MAX);
+    const long bytesBefore = historyBytes(dir, metric);
+
+    // Off: nothing to do.
+    LittleFsDataStorage off(dir.path(), nullptr, summarized(HistoryCodec::Delta));
+    TEST_ASSERT_FALSE(off.maintain());
+
+    // The three sealed chunks become .dz, the active one is left alone.
+    LittleFsDataStorage storage(dir.path(), nullptr, maintained());
+    TEST_ASSERT_TRUE(storage.storeSensorReading(metric, base + total * 60, 1.0f));
+    TEST_ASSERT_EQUAL_size_t(3, maintainAll(storage));
+    const auto chunks = sortedListDir(metricDirOf(dir, metric));
+    TEST_ASSERT_EQUAL_size_t(4, chunks.size());
+    for (std::size_t i = 0; i < 3; ++i) {
+        TEST_ASSERT_TRUE(chunks[i].find(".dz") != std::string::npos);
+    }
+    TEST_ASSERT_EQUAL_STRING((std::to_string(base + 3 * kRecordsPerChunk * 60) + ".dat").c_str(),
+                             chunks[3].c_str());
+    TEST_ASSERT_TRUE(historyBytes(dir, metric) < bytesBefore / 2);
+    TEST_ASSERT_EQUAL_size_t(0, maintainAll(storage));
+
+    // Same readings, summaries rewritten for the new bytes.
+    const auto after = storage.getSensorReadings(metric, 0, UINT32_MAX);
+    TEST_ASSERT_EQUAL_size_t(before.size() + 1, after.size());
+    for (std::size_t i = 0; i < before.size(); ++i) {
+        TEST_ASSERT_EQUAL_UINT32(before[i].epoch, after[i].epoch);
+        TEST_ASSERT_EQUAL_FLOAT(before[i].value, after[i].value);
+    }
+    TEST_ASSERT_EQUAL_size_t(0, storage.scrubHistory(8));
+    assertSameStats(LittleFsDataStorage(dir.path()).getSensorWindowStats(metric, 0, UINT32_MAX),
+                    storage.getSensorWindowStats(metric, 0, UINT32_MAX));
+
+    // The cached index follows the renames: the ring still seals and
+    // evicts the recompacted chunks.
+    appendSeries(storage, metric, base + (total + 1) * 60, 3 * kMetricCapacity, 60);
+    maintainAll(storage);
+    for (const std::string& name : listDir(metricDirOf(dir, metric))) {
+        TEST_ASSERT_TRUE(name != chunks[0]);
+        TEST_ASSERT_TRUE(name.find(".dat") == std::string::npos);
+    }
+}
+
+void test_maintenance_finishes_an_interrupted_recompaction(void)
+{
+    TempDir dir;
+    const std::string metric = "env_humidity";
+    const std::size_t total = 2 * kRecordsPerChunk + 10;
+    {
+        LittleFsDataStorage fixed(dir.path(), nullptr, summarized());
+        appendSeries(fixed, metric, 5000, total, 60);
+    }
+    const std::string oldest = metricDirOf(dir, metric) + "/5000.dat";
+    const std::string oldestSum = summaryDirOf(dir, metric) + "/5000.sum";
+    const std::vector<uint8_t> raw = readAll(oldest);
+    const std::vector<uint8_t> rawSum = readAll(oldestSum);
+    {
+        LittleFsDataStorage storage(dir.path(), nullptr, maintained());
+        TEST_ASSERT_EQUAL_size_t(2, maintainAll(storage));
+    }
+    const auto done = sortedListDir(metricDirOf(dir, metric));
+
+    // Cut after the rename: the .dat (and its summary) back beside the
+    // .dz, plus the .tmp of a step that never got to its rename.
+    auto interrupt = [&] {
+        TEST_ASSERT_EQUAL_INT(0, std::remove(oldestSum.c_str()));
+        appendBytes(oldest, raw.data(), raw.size());
+        appendBytes(oldestSum, rawSum.data(), rawSum.size());
+        appendBytes(metricDirOf(dir, metric) + "/5000.dz.tmp", raw.data(), 100);
+    };
+    interrupt();
+    {
+        // Reads take the .dz alone; the next step removes the leftovers.
+        LittleFsDataStorage storage(dir.path(), nullptr, maintained());
+        TEST_ASSERT_EQUAL_size_t(total, storage.getSensorReadings(metric, 0, UINT32_MAX).size());
+        maintainAll(storage);
+        TEST_ASSERT_TRUE(sortedListDir(metricDirOf(dir, metric)) == done);
+        TEST_ASSERT_EQUAL_size_t(0, storage.scrubHistory(8));
+    }
+
+    // An append gets there first: the .dat must not outlive its .dz.
+    interrupt();
+    LittleFsDataStorage writer(dir.path(), nullptr, summarized(HistoryCodec::Delta));
+    TEST_ASSERT_TRUE(writer.storeSensorReading(metric, 5000 + total * 60, 1.0f));
+    TEST_ASSERT_EQUAL_INT(-1, ::access(oldest.c_str(), F_OK));
+    TEST_ASSERT_EQUAL_size_t(0, writer.scrubHistory(8));
+    appendSeries(writer, metric, 5000 + (total + 1) * 60, kMetricCapacity, 60);
+    TEST_ASSERT_EQUAL_INT(-1, ::access(oldest.c_str(), F_OK));
+}
+
+void test_maintenance_takes_over_rollup_updates(void)
+{
+    TempDir dir;
+    LittleFsDataStorageOptions options = withRollups();
+    options.backgroundMaintenance = true;
+    LittleFsDataStorage storage(dir.path(), nullptr, options);
+    const std::string metric = "env_temperature";
+    const uint32_t day = 1750982400;  // UTC midnight
+    for (uint32_t i = 0; i < 36; ++i) {
+        TEST_ASSERT_TRUE(storage.storeSensorReading(
+            metric, day + i * 300, 20.0f + static_cast<float>(i % 12)));
+    }
+    // The appends only marked the tiers due; reads fold raw history meanwhile.
+    TEST_ASSERT_TRUE(listDir(dir.path() + "/rollup").empty());
+    for (uint32_t bucketS : IDataStorage::kAggregateBucketsS) {
+        assertAggregatesMatchRaw(storage, metric, day, day + 3 * 3600, bucketS);
+    }
+    // One step writes what the commits would have written.
+    TEST_ASSERT_EQUAL_size_t(1, maintainAll(storage));
+    TEST_ASSERT_EQUAL_INT(2 * static_cast<long>(rollup::kRecordBytes),
+                          rollupBytes(dir, "1h", metric));
+    TEST_ASSERT_EQUAL_INT(35 * static_cast<long>(rollup::kRecordBytes),
+                          rollupBytes(dir, "1m", metric));
+    for (uint32_t bucketS : IDataStorage::kAggregateBucketsS) {
+        assertAggregatesMatchRaw(storage, metric, day, day + 3 * 3600, bucketS);
+    }
+}
+
+// --- Streaming reads (IDataStorage::forEachReading) --------------------
+
+/// Records what a forEachReading() pass delivered; stops after `limit`.
+struct CollectingVisitor final : IReadingVisitor {
+    std::vector<uint32_t> epochs;
+    std::vector<float> values;
+    std::size_t limit = SIZE_MAX;
+    bool onReading(uint32_t epoch, float value) override
+    {
+        epochs.push_back(epoch);
+        values.push_back(value);
+        return epochs.size() < limit;
+    }
+};
+
+/// forEachReading() delivers exactly what getSensorReadings() returns.
+void assertStreamMatchesReadings(const IDataStorage& storage,
+                                 const std::string& metric, uint32_t t0,
+                                 uint32_t t1)
+{
+    const auto readings = storage.getSensorReadings(metric, t0, t1);
+    CollectingVisitor visitor;
+    TEST_ASSERT_EQUAL_size_t(readings.size(),
+                             storage.forEachReading(metric, t0, t1, visitor));
+    TEST_ASSERT_EQUAL_size_t(readings.size(), visitor.epochs.size());
+    for (std::size_t i = 0; i < readings.size(); ++i) {
+        TEST_ASSERT_EQUAL_UINT32(readings[i].epoch, visitor.epochs[i]);
+        TEST_ASSERT_EQUAL_FLOAT(readings[i].value, visitor.values[i]);
+    }
+}
+
+void test_for_each_reading_streams_every_layout(void)
+{
+    const std::string metric = "soil_moisture";
+    for (const LittleFsDataStorageOptions& options : everyHistoryLayout()) {
+        TempDir dir;
+        LittleFsDataStorage storage(dir.path(), nullptr, options);
+        appendSeries(storage, metric, 1000, 2 * kRecordsPerChunk + 10, 60);
+        const uint32_t last = 1000 + static_cast<uint32_t>(2 * kRecordsPerChunk + 9) * 60;
+        assertStreamMatchesReadings(storage, metric, 0, UINT32_MAX);
+        assertStreamMatchesReadings(storage, metric, 1000 + 1023 * 60, 1000 + 1025 * 60);
+        assertStreamMatchesReadings(storage, metric, last, last);
+        assertStreamMatchesReadings(storage, metric, 500, 999);
+        assertStreamMatchesReadings(storage, metric, 10, 5);
+        assertStreamMatchesReadings(storage, "never_stored", 0, UINT32_MAX);
+
+        // The visitor ends the stream early: nothing after its `false`.
+        CollectingVisitor firstThree;
+        firstThree.limit = 3;
+        TEST_ASSERT_EQUAL_size_t(3, storage.forEachReading(metric, 1060, UINT32_MAX,
+                                                           firstThree));
+        TEST_ASSERT_EQUAL_UINT32(1060, firstThree.epochs.front());
+        TEST_ASSERT_EQUAL_UINT32(1180, firstThree.epochs.back());
+    }
+}
+
+void test_for_each_reading_includes_buffered_and_mock(void)
+{
+    TempDir dir;
+    FakeTimeProvider clock;
+    LittleFsDataStorage storage(dir.path(), nullptr, groupCommit(clock));
+    appendSeries(storage, "env_humidity", 100, 5, 10);
+    TEST_ASSERT_TRUE(storage.flush());
+    appendSeries(storage, "env_humidity", 200, 3, 10);  // still buffered
+    assertStreamMatchesReadings(storage, "env_humidity", 0, UINT32_MAX);
+    assertStreamMatchesReadings(storage, "env_humidity", 140, 210);
+    CollectingVisitor committedOnly;
+    committedOnly.limit = 5;
+    TEST_ASSERT_EQUAL_size_t(
+        5, storage.forEachReading("env_humidity", 0, UINT32_MAX, committedOnly));
+
+    // Implementations without an override stream their vector read.
+    MockDataStorage mock;
+    for (uint32_t epoch : {10u, 20u, 30u}) {
+        TEST_ASSERT_TRUE(mock.storeSensorReading("soil_ph", epoch, 6.5f));
+    }
+    assertStreamMatchesReadings(mock, "soil_ph", 15, 30);
+}
+
+// --- Event-tail cache (LittleFsDataStorageOptions::cacheEventTail) ------
+
+LittleFsDataStorageOptions cachedEventTail()
+{
+    LittleFsDataStorageOptions options;
+    options.cacheEventTail = true;
+    return options;
+}
+
+void test_event_tail_cache_matches_stateless(void)
+{
+    TempDir cachedDir;
+    TempDir statelessDir;
+    LittleFsDataStorage cached(cachedDir.path(), nullptr, cachedEventTail());
+    LittleFsDataStorage stateless(statelessDir.path());
+
+    // Every detail length, several rotations: the cache must only skip the
+    // derivation — byte-identical files, identical reads.
+    std::size_t failures = 0;
+    for (std::size_t i = 0; i < 1500; ++i) {
+        const std::string detail(i % (IDataStorage::kEventDetailMaxLen + 1), 'c');
+        const uint32_t epoch = 9000 + static_cast<uint32_t>(i / 3);
+        if (!cached.storeEvent(epoch, IDataStorage::kCategoryPump, detail) ||
+            !stateless.storeEvent(epoch, IDataStorage::kCategoryPump, detail)) {
+            ++failures;
+        }
+    }
+    TEST_ASSERT_EQUAL_size_t(0, failures);
+    for (std::size_t slot = 0; slot < kEventSegments; ++slot) {
+        TEST_ASSERT_TRUE(readAll(eventFileOf(cachedDir, static_cast<int>(slot))) ==
+                         readAll(eventFileOf(statelessDir, static_cast<int>(slot))));
+    }
+    TEST_ASSERT_EQUAL_size_t(stateless.getEvents(SIZE_MAX).size(),
+                             cached.getEvents(SIZE_MAX).size());
+}
+
+void test_event_tail_cache_revalidated_against_files(void)
+{
+    TempDir dir;
+    LittleFsDataStorage storage(dir.path(), nullptr, cachedEventTail());
+    TEST_ASSERT_TRUE(storage.storeEvent(100, IDataStorage::kCategoryPump, "one"));
+
+    // Power loss between "boots" of another writer: a torn tail behind the
+    // cache is repaired before the next append.
+    appendGarbage(eventFileOf(dir, 0), 3);
+    TEST_ASSERT_TRUE(storage.storeEvent(200, IDataStorage::kCategoryPump, "two"));
+    const std::size_t framing = LittleFsDataStorage::kEventHeaderBytes +
+                                LittleFsDataStorage::kEventTrailerBytes;
+    TEST_ASSERT_EQUAL_INT(static_cast<int>(kSegmentHeaderBytes + 2 * framing + 6),
+                          static_cast<int>(sizeOf(eventFileOf(dir, 0))));
+
+    // Another instance appends: the cached length no longer matches, so the
+    // next append lands after it instead of on top of it.
+    LittleFsDataStorage other(dir.path());
+    TEST_ASSERT_TRUE(other.storeEvent(300, IDataStorage::kCategoryReset, "three"));
+    TEST_ASSERT_TRUE(storage.storeEvent(400, IDataStorage::kCategoryPump, "four"));
+    const auto events = storage.getEvents(10);
+    TEST_ASSERT_EQUAL_size_t(4, events.size());
+    TEST_ASSERT_EQUAL_STRING("four", events[0].detail.c_str());
+    TEST_ASSERT_EQUAL_STRING("three", events[1].detail.c_str());
+
+    // The whole log vanishes: re-derived as a fresh log, not a failure.
+    std::remove(eventFileOf(dir, 0).c_str());
+    std::remove((dir.path() + "/events").c_str());
+    TEST_ASSERT_TRUE(storage.storeEvent(500, IDataStorage::kCategoryPump, "five"));
+    TEST_ASSERT_EQUAL_size_t(1, storage.getEvents(10).size());
+}
+
+// --- Tail-first event reads (getEvents) ---------------------------------
+
+/// A trailer-less record as written by firmware before the frame_len
+/// trailer: {0xE7, uint32 LE epoch, category, detail_len, detail}.
+void appendLegacyEvent(const std::string& path, uint32_t epoch,
+                       const std::string& detail)
+{
+    std::vector<uint8_t> frame = {LittleFsDataStorage::kLegacyEventMarker,
+                                  static_cast<uint8_t>(epoch & 0xFF),
+                                  static_cast<uint8_t>((epoch >> 8) & 0xFF),
+                                  static_cast<uint8_t>((epoch >> 16) & 0xFF),
+                                  static_cast<uint8_t>((epoch >> 24) & 0xFF),
+                                  IDataStorage::kCategoryPump,
+                                  static_cast<uint8_t>(detail.size())};
+    frame.insert(frame.end(), detail.begin(), detail.end());
+    appendBytes(path, frame.data(), frame.size());
+}
+
+void test_get_events_reads_only_the_tail(void)
+{
+    TempDir dir;
+    LittleFsDataStorage storage(dir.path());
+    appendEvents(storage, 1000, 0, 900);
+
+    // Break the marker of an early record. The forward parse ends its
+    // valid prefix there; the tail walk never gets that far back.
+    overwriteByte(eventFileOf(dir, 0), kSegmentHeaderBytes + 100 * kFixedRecordBytes,
+                  0x00);
+    const auto events = storage.getEvents(3);
+    TEST_ASSERT_EQUAL_size_t(3, events.size());
+    for (std::size_t i = 0; i < events.size(); ++i) {
+        TEST_ASSERT_EQUAL_UINT32(1000 + 899 - i, events[i].epoch);
+        TEST_ASSERT_EQUAL_STRING(fixedDetail(899 - i).c_str(),
+                                 events[i].detail.c_str());
+    }
+}
+
+/// A trailer-framed record as any firmware since has written it.
+void appendFramedEvent(const std::string& path, uint32_t epoch,
+                       const std::string& detail)
+{
+    appendLegacyEvent(path, epoch, detail);
+    const std::size_t frameBytes = LittleFsDataStorage::kEventHeaderBytes +
+                                   detail.size() +
+                                   LittleFsDataStorage::kEventTrailerBytes;
+    const uint8_t marker = LittleFsDataStorage::kEventMarker;
+    const uint8_t trailer = static_cast<uint8_t>(frameBytes);
+    overwriteByte(path, sizeOf(path) - static_cast<long>(frameBytes) + 1, marker);
+    appendBytes(path, &trailer, 1);
+}
+
+void test_get_events_reads_legacy_and_mixed_files(void)
+{
+    TempDir dir;
+    LittleFsDataStorage storage(dir.path());
+    TEST_ASSERT_TRUE(storage.storeEvent(50, IDataStorage::kCategoryPump, "seed"));
+    TEST_ASSERT_EQUAL_INT(0, std::remove(eventFileOf(dir, 0).c_str()));
+
+    // A two-file log written by older firmware: 1.log the older half
+    // (trailer-less records only), 0.log the newer (both framings).
+    appendLegacyEvent(legacyEventFileOf(dir, 1), 100, "old-a");
+    appendLegacyEvent(legacyEventFileOf(dir, 1), 150, "old-b");
+    appendLegacyEvent(legacyEventFileOf(dir, 0), 200, "old-c");
+    appendFramedEvent(legacyEventFileOf(dir, 0), 250, "old-d");
+    auto events = storage.getEvents(10);
+    TEST_ASSERT_EQUAL_size_t(4, events.size());
+    TEST_ASSERT_EQUAL_STRING("old-d", events[0].detail.c_str());
+    TEST_ASSERT_EQUAL_STRING("old-a", events[3].detail.c_str());
+
+    // New appends start the segment ring; the old log reads after it,
+    // newest first, whatever maxCount asks for.
+    TEST_ASSERT_TRUE(storage.storeEvent(300, IDataStorage::kCategoryOta, "new-e"));
+    TEST_ASSERT_TRUE(storage.storeEvent(400, IDataStorage::kCategoryOta, "new-f"));
+    events = storage.getEvents(10);
+    TEST_ASSERT_EQUAL_size_t(6, events.size());
+    const char* expected[] = {"new-f", "new-e", "old-d", "old-c", "old-b", "old-a"};
+    for (std::size_t i = 0; i < 6; ++i) {
+        TEST_ASSERT_EQUAL_STRING(expected[i], events[i].detail.c_str());
+    }
+    events = storage.getEvents(1);
+    TEST_ASSERT_EQUAL_size_t(1, events.size());
+    TEST_ASSERT_EQUAL_STRING("new-f", events[0].detail.c_str());
+    TEST_ASSERT_EQUAL_size_t(0, storage.getEvents(0).size());
+}
+
+void test_legacy_event_files_removed_when_ring_wraps(void)
+{
+    TempDir dir;
+    {
+        LittleFsDataStorageOptions options;
+        options.eventSegments = 10;  // a larger setting before this boot
+        LittleFsDataStorage before(dir.path(), nullptr, options);
+        TEST_ASSERT_TRUE(before.storeEvent(10, IDataStorage::kCategoryPump, "x"));
+    }
+    TEST_ASSERT_EQUAL_INT(0, std::rename(eventFileOf(dir, 0).c_str(),
+                                         eventFileOf(dir, 9).c_str()));
+    appendLegacyEvent(legacyEventFileOf(dir, 0), 100, "old");
+    LittleFsDataStorage storage(dir.path());
+
+    // Until the ring wraps the old log is still the oldest history.
+    appendEvents(storage, 1000, 0, kRingEvents);
+    TEST_ASSERT_EQUAL_size_t(kRingEvents + 1, storage.getEvents(SIZE_MAX).size());
+    TEST_ASSERT_TRUE(sizeOf(legacyEventFileOf(dir, 0)) > 0);
+
+    // The wrap drops the oldest segment — and with it the old log and the
+    // segment left out of the ring.
+    appendEvents(storage, 1000, kRingEvents, 1);
+    const auto files = listDir(dir.path() + "/events");
+    TEST_ASSERT_EQUAL_size_t(kEventSegments, files.size());
+    for (const char* gone : {"0.log", "s9.log"}) {
+        TEST_ASSERT_TRUE(std::find(files.begin(), files.end(), gone) == files.end());
+    }
+    const auto events = storage.getEvents(SIZE_MAX);
+    TEST_ASSERT_EQUAL_size_t(kRingEvents - kEventsPerSegment + 1, events.size());
+    TEST_ASSERT_EQUAL_UINT32(1000 + kEventsPerSegment, events.back().epoch);
+}
+
+void test_events_read_across_block_boundaries(void)
+{
+    TempDir dir;
+    LittleFsDataStorage storage(dir.path());
+    // Records of every detail length, several KiB of them, so frames
+    // straddle the backward walk's read blocks.
+    std::vector<std::string> details;
+    for (int pass = 0; pass < 3; ++pass) {
+        for (std::size_t len = pass; len <= IDataStorage::kEventDetailMaxLen; len += 3) {
+            details.push_back(std::string(len, static_cast<char>('a' + len % 26)));
+            TEST_ASSERT_TRUE(storage.storeEvent(100 + static_cast<uint32_t>(details.size()),
+                                                IDataStorage::kCategoryOta, details.back()));
+        }
+    }
+    const auto expectAll = [&] {
+        const auto events = storage.getEvents(SIZE_MAX);
+        TEST_ASSERT_EQUAL_size_t(details.size(), events.size());
+        for (std::size_t i = 0; i < events.size(); ++i) {
+            const std::size_t n = details.size() - i;
+            TEST_ASSERT_EQUAL_UINT32(100 + n, events[i].epoch);
+            TEST_ASSERT_EQUAL_STRING(details[n - 1].c_str(), events[i].detail.c_str());
+        }
+    };
+    expectAll();
+    // A torn final append sends the read to the whole-file parse, which
+    // must agree with the walk.
+    const uint8_t torn[] = {LittleFsDataStorage::kEventMarker, 0x01, 0x02};
+    appendBytes(eventFileOf(dir, 0), torn, sizeof(torn));
+    expectAll();
+}
+
+// --- Event queries (IDataStorage::queryEvents) ---------------------------
+
+/// Reference answer: the whole log through getEvents(), filtered by hand.
+std::vector<EventRecord> filterEvents(const IDataStorage& storage,
+                                      uint32_t mask, uint32_t since,
+                                      uint32_t until)
+{
+    std::vector<EventRecord> matches;
+    for (const EventRecord& r : storage.getEvents(SIZE_MAX)) {
+        if (r.epoch >= since && r.epoch <= until &&
+            (mask & EventQuery::categoryBit(r.category)) != 0) {
+            matches.push_back(r);
+        }
+    }
+    return matches;
+}
+
+void assertSameEvents(const std::vector<EventRecord>& expected,
+                      const std::vector<EventRecord>& actual)
+{
+    TEST_ASSERT_EQUAL_size_t(expected.size(), actual.size());
+    for (std::size_t i = 0; i < expected.size(); ++i) {
+        TEST_ASSERT_EQUAL_UINT32(expected[i].epoch, actual[i].epoch);
+        TEST_ASSERT_EQUAL_UINT8(expected[i].category, actual[i].category);
+        TEST_ASSERT_EQUAL_STRING(expected[i].detail.c_str(),
+                                 actual[i].detail.c_str());
+    }
+}
+
+/// Every page of `query` followed through its cursors.
+std::vector<EventRecord> drainPages(const IDataStorage& storage,
+                                    EventQuery query, std::size_t& pages)
+{
+    std::vector<EventRecord> all;
+    pages = 0;
+    for (;;) {
+        const EventPage page = storage.queryEvents(query);
+        ++pages;
+        TEST_ASSERT_TRUE(page.events.size() <= query.limit);
+        all.insert(all.end(), page.events.begin(), page.events.end());
+        if (!page.more) {
+            return all;
+        }
+        query.cursor = page.next;
+    }
+}
+
+/// Three events per second (shared epochs) with rotating categories;
+/// kTriagedEvents of them fill several segments.
+constexpr std::size_t kTriagedEvents = 4 * kEventsPerSegment + 304;
+template <typename Storage>
+void storeTriagedEvents(Storage& storage, std::size_t count)
+{
+    const uint8_t categories[] = {IDataStorage::kCategoryPump,
+                                  IDataStorage::kCategoryFailsafe,
+                                  IDataStorage::kCategoryConnectivity,
+                                  IDataStorage::kCategoryPump};
+    std::size_t failures = 0;
+    for (std::size_t i = 0; i < count; ++i) {
+        if (!storage.storeEvent(1000 + static_cast<uint32_t>(i / 3),
+                                categories[i % 4], fixedDetail(i))) {
+            ++failures;
+        }
+    }
+    TEST_ASSERT_EQUAL_size_t(0, failures);
+}
+
+void test_query_events_filters_category_and_window(void)
+{
+    TempDir dir;
+    LittleFsDataStorage storage(dir.path());
+    storeTriagedEvents(storage, kTriagedEvents);
+
+    const uint32_t failsafe = EventQuery::categoryBit(IDataStorage::kCategoryFailsafe);
+    const uint32_t pumpOrFailsafe =
+        failsafe | EventQuery::categoryBit(IDataStorage::kCategoryPump);
+    const struct {
+        uint32_t mask, since, until;
+    } cases[] = {
+        {EventQuery::kAllCategories, 0, UINT32_MAX},
+        {failsafe, 0, UINT32_MAX},
+        {failsafe, 1300, UINT32_MAX},        // "since X", back into older segments
+        {pumpOrFailsafe, 1100, 1200},        // a window inside older segments
+        {pumpOrFailsafe, 1200, 1100},        // inverted window
+        {1u << 7, 0, UINT32_MAX},            // no such category
+    };
+    for (const auto& c : cases) {
+        EventQuery query;
+        query.categoryMask = c.mask;
+        query.since = c.since;
+        query.until = c.until;
+        const EventPage page = storage.queryEvents(query);
+        assertSameEvents(filterEvents(storage, c.mask, c.since, c.until), page.events);
+        TEST_ASSERT_FALSE(page.more);
+    }
+
+    // An unknown category (>= 32) is only selected by the all-categories mask.
+    TEST_ASSERT_TRUE(storage.storeEvent(5000, 200, "future"));
+    EventQuery query;
+    query.limit = 1;
+    TEST_ASSERT_EQUAL_UINT8(200, storage.queryEvents(query).events[0].category);
+    query.categoryMask = ~EventQuery::categoryBit(IDataStorage::kCategoryPump);
+    TEST_ASSERT_EQUAL_UINT32(1000 + (kTriagedEvents - 2) / 3,  // last non-pump
+                             storage.queryEvents(query).events[0].epoch);
+}
+
+void test_query_events_pages_through_cursors(void)
+{
+    TempDir dir;
+    LittleFsDataStorage storage(dir.path());
+    storeTriagedEvents(storage, kTriagedEvents);
+    const uint32_t pump = EventQuery::categoryBit(IDataStorage::kCategoryPump);
+
+    // Page sizes that split same-second groups at every offset; the pages
+    // add up to the one-shot answer with nothing repeated or skipped.
+    for (const std::size_t limit : {std::size_t{1}, std::size_t{2}, std::size_t{7}}) {
+        EventQuery query;
+        query.categoryMask = pump;
+        query.since = 1100;
+        query.limit = limit;
+        std::size_t pages = 0;
+        const auto all = drainPages(storage, query, pages);
+        const auto expected = filterEvents(storage, pump, 1100, UINT32_MAX);
+        assertSameEvents(expected, all);
+        TEST_ASSERT_EQUAL_size_t((expected.size() + limit - 1) / limit, pages);
+    }
+
+    // Events appended between pages are newer than the cursor: the next
+    // page continues where the previous one ended.
+    EventQuery query;
+    query.limit = 4;
+    const EventPage first = storage.queryEvents(query);
+    TEST_ASSERT_TRUE(first.more);
+    TEST_ASSERT_TRUE(storage.storeEvent(9000, IDataStorage::kCategoryPump, "late"));
+    query.cursor = first.next;
+    const EventPage second = storage.queryEvents(query);
+    const auto everything = storage.getEvents(9);
+    assertSameEvents(std::vector<EventRecord>(everything.begin() + 5, everything.end()),
+                     second.events);
+}
+
+void test_query_events_default_matches_file_backed(void)
+{
+    TempDir dir;
+    LittleFsDataStorage storage(dir.path());
+    MockDataStorage mock;
+    storeTriagedEvents(storage, 200);
+    storeTriagedEvents(mock, 200);
+
+    // The interface default (a filter over getEvents) and the single-pass
+    // file walk answer every page identically.
+    EventQuery query;
+    query.categoryMask = EventQuery::categoryBit(IDataStorage::kCategoryConnectivity) |
+                         EventQuery::categoryBit(IDataStorage::kCategoryFailsafe);
+    query.until = 1050;
+    query.limit = 5;
+    for (int page = 0; page < 6; ++page) {
+        const EventPage fromFiles = storage.queryEvents(query);
+        const EventPage fromMock = mock.queryEvents(query);
+        assertSameEvents(fromMock.events, fromFiles.events);
+        TEST_ASSERT_EQUAL(fromMock.more, fromFiles.more);
+        TEST_ASSERT_EQUAL_UINT32(fromMock.next.epoch, fromFiles.next.epoch);
+        TEST_ASSERT_EQUAL_UINT32(fromMock.next.skip, fromFiles.next.skip);
+        query.cursor = fromFiles.next;
+    }
+}
+
+// --- Metric ids (MetricRegistry.h, IDataStorage::storeSamples) ---------
+
+void test_metric_registry_known_table_and_bound(void)
+{
+    // Known ids are compile-time constants shared with every storage.
+    static_assert(metric::findKnown("soil_ph") == metric::kSoilPh, "known id");
+    static_assert(metric::findKnown("soil_humidity") == metric::kInvalid,
+                  "not a logged metric");
+    TEST_ASSERT_EQUAL_STRING("env_pressure", metric::knownName(metric::kEnvPressure));
+    TEST_ASSERT_NULL(metric::knownName(metric::kKnownCount));
+
+    MetricRegistry registry;
+    TEST_ASSERT_EQUAL_size_t(metric::kKnownCount, registry.size());
+    TEST_ASSERT_EQUAL_UINT8(metric::kSoilEc, registry.intern("soil_ec"));
+    TEST_ASSERT_EQUAL_UINT8(metric::kInvalid, registry.find("dyn_a"));
+
+    // Dynamic names get the ids after the table, once each, up to the bound.
+    const MetricId first = registry.intern("dyn_a");
+    TEST_ASSERT_EQUAL_UINT8(metric::kKnownCount, first);
+    TEST_ASSERT_EQUAL_UINT8(first, registry.intern("dyn_a"));
+    TEST_ASSERT_EQUAL_STRING("dyn_a", registry.name(first).c_str());
+    for (std::size_t i = 1; i < MetricRegistry::kDynamicCapacity; ++i) {
+        TEST_ASSERT_TRUE(registry.intern("dyn_" + std::to_string(i)) != metric::kInvalid);
+    }
+    TEST_ASSERT_EQUAL_size_t(MetricRegistry::kCapacity, registry.size());
+    TEST_ASSERT_EQUAL_UINT8(metric::kInvalid, registry.intern("one_too_many"));
+    TEST_ASSERT_EQUAL_UINT8(first, registry.find("dyn_a"));
+}
+
+/// Byte-identical directory trees (names and file contents, recursively).
+void assertSameTree(const std::string& a, const std::string& b)
+{
+    const auto names = sortedListDir(a);
+    const auto other = sortedListDir(b);
+    TEST_ASSERT_EQUAL_size_t(names.size(), other.size());
+    for (std::size_t i = 0; i < names.size(); ++i) {
+        TEST_ASSERT_EQUAL_STRING(names[i].c_str(), other[i].c_str());
+        const std::string pathA = a + "/" + names[i];
+        const std::string pathB = b + "/" + names[i];
+        struct stat st {};
+        TEST_ASSERT_EQUAL_INT(0, ::stat(pathA.c_str(), &st));
+        if (S_ISDIR(st.st_mode)) {
+            assertSameTree(pathA, pathB);
+        } else {
+            TEST_ASSERT_TRUE_MESSAGE(readAll(pathA) == readAll(pathB), pathA.c_str());
+        }
+    }
+}
+
+void test_store_samples_writes_what_named_stores_write(void)
+{
+    FakeTimeProvider clock;
+    const LittleFsDataStorageOptions layouts[] = {
+        LittleFsDataStorageOptions{}, cachedIndex(), groupCommit(clock, 8),
+        rowLayout(), withRollups(), deltaCodec()};
+    for (const LittleFsDataStorageOptions& options : layouts) {
+        TempDir byName;
+        TempDir byId;
+        {
+            LittleFsDataStorage named(byName.path(), nullptr, options);
+            LittleFsDataStorage ids(byId.path(), nullptr, options);
+            for (uint32_t tick = 0; tick < 40; ++tick) {
+                const uint32_t epoch = 3500 + 300 * tick;
+                const float v = 20.0f + 0.25f * static_cast<float>(tick % 7);
+                const SensorReading readings[] = {{"env_temperature", epoch, v},
+                                                  {"soil_moisture", epoch, 2 * v},
+                                                  {"soil_potassium", epoch, 3 * v}};
+                const MetricSample samples[] = {{metric::kEnvTemperature, epoch, v},
+                                                {metric::kSoilMoisture, epoch, 2 * v},
+                                                {metric::kSoilPotassium, epoch, 3 * v}};
+                TEST_ASSERT_EQUAL_size_t(3, named.storeSensorReadings(readings, 3));
+                TEST_ASSERT_EQUAL_size_t(3, ids.storeSamples(samples, 3));
+            }
+            // Readable by name either way, including what is still buffered.
+            TEST_ASSERT_EQUAL_size_t(40, ids.getSensorReadings("soil_moisture", 0,
+                                                               UINT32_MAX).size());
+        }
+        assertSameTree(byName.path(), byId.path());
+    }
+}
+
+void test_store_samples_rejects_unknown_ids_individually(void)
+{
+    TempDir dir;
+    LittleFsDataStorage storage(dir.path(), nullptr, cachedIndex());
+
+    // A dynamic name keeps working through the name API and coexists
+    // with known ids; an id nobody registered is dropped on its own.
+    TEST_ASSERT_TRUE(storage.storeSensorReading("bench_probe", 100, 1.0f));
+    const MetricSample samples[] = {{metric::kSoilPh, 100, 6.5f},
+                                    {metric::kInvalid, 100, 9.0f},
+                                    {static_cast<MetricId>(metric::kKnownCount + 5), 100, 9.0f},
+                                    {metric::kSoilPh, 200, 6.6f}};
+    TEST_ASSERT_EQUAL_size_t(2, storage.storeSamples(samples, 4));
+    TEST_ASSERT_EQUAL_size_t(2, storage.getSensorReadings("soil_ph", 0, 300).size());
+    TEST_ASSERT_EQUAL_size_t(1, storage.getSensorReadings("bench_probe", 0, 300).size());
+    TEST_ASSERT_EQUAL_size_t(2, listDir(dir.path() + "/hist").size());
+
+    // The interface default (mock, Locked* wrapper) resolves known ids to
+    // names and forwards one batch.
+    MockDataStorage mock;
+    LockedDataStorage locked(mock);
+    TEST_ASSERT_EQUAL_size_t(2, locked.storeSamples(samples, 4));
+    TEST_ASSERT_EQUAL(1, mock.batchWrites);
+    TEST_ASSERT_EQUAL_size_t(2, mock.getSensorReadings("soil_ph", 0, 300).size());
+}
+
+// --- Stats cache (LittleFsDataStorageOptions::statsResyncMs) -------------
+
+constexpr uint32_t kStatsResyncMs = 60'000;
+
+/// Bytes of every file under `dir`, recursively: what the cached tally
+/// must track (the host filesystem has no littlefs block rounding).
+uint32_t treeBytes(const std::string& dir)
+{
+    uint32_t total = 0;
+    for (const std::string& name : listDir(dir)) {
+        const std::string path = dir + "/" + name;
+        struct stat st {};
+        if (::stat(path.c_str(), &st) != 0) {
+            continue;
+        }
+        total += S_ISDIR(st.st_mode) ? treeBytes(path)
+                                     : static_cast<uint32_t>(st.st_size);
+    }
+    return total;
+}
+
+/// Provider over the real tree that counts how often it is walked.
+struct CountingStatsProvider {
+    std::string root;
+    int calls = 0;
+    bool fail = false;
+
+    LittleFsDataStorage::StatsProvider bind()
+    {
+        return [this](uint32_t& total, uint32_t& used) {
+            ++calls;
+            total = 983040;
+            used = treeBytes(root);
+            return !fail;
+        };
+    }
+};
+
+LittleFsDataStorageOptions cachedStats(FakeTimeProvider& clock)
+{
+    LittleFsDataStorageOptions options = cachedIndex();
+    options.cacheEventTail = true;
+    options.rollups = true;
+    options.clock = &clock;
+    options.statsResyncMs = kStatsResyncMs;
+    return options;
+}
+
+void test_storage_stats_cached_and_tallied(void)
+{
+    TempDir dir;
+    FakeTimeProvider clock;
+    CountingStatsProvider provider{dir.path()};
+    LittleFsDataStorage storage(dir.path(), provider.bind(), cachedStats(clock));
+
+    TEST_ASSERT_EQUAL_UINT32(0, storage.getStorageStats().usedBytes);
+    TEST_ASSERT_EQUAL_INT(1, provider.calls);
+
+    // Appends, chunk evictions (11 chunks' worth), rollup tiers and one
+    // event-segment rotation: the tally follows the tree without a walk.
+    appendSeries(storage, "soil_moisture", 0,
+                 (LittleFsDataStorage::kHistoryMaxChunksPerMetric + 1) * 1024, 60);
+    appendEvents(storage, 1000, 0, kEventsPerSegment + 10);
+    const StorageStats stats = storage.getStorageStats();
+    TEST_ASSERT_EQUAL_INT(1, provider.calls);
+    TEST_ASSERT_EQUAL_UINT32(983040, stats.totalBytes);
+    TEST_ASSERT_EQUAL_UINT32(treeBytes(dir.path()), stats.usedBytes);
+
+    // Resynced once the figure is statsResyncMs old, then cached again.
+    clock.advance(kStatsResyncMs - 1);
+    storage.getStorageStats();
+    TEST_ASSERT_EQUAL_INT(1, provider.calls);
+    clock.advance(1);
+    storage.getStorageStats();
+    storage.getStorageStats();
+    TEST_ASSERT_EQUAL_INT(2, provider.calls);
+}
+
+void test_storage_stats_cache_off_and_failing_provider(void)
+{
+    TempDir dir;
+    FakeTimeProvider clock;
+    CountingStatsProvider provider{dir.path()};
+
+    // Default options: every call asks the provider (pre-cache behaviour).
+    {
+        LittleFsDataStorage uncached(dir.path(), provider.bind(), cachedIndex());
+        uncached.getStorageStats();
+        uncached.getStorageStats();
+        TEST_ASSERT_EQUAL_INT(2, provider.calls);
+    }
+
+    // A failing provider yields zeros and is not cached: the next call
+    // retries and the tally starts from the first good figure.
+    provider.calls = 0;
+    provider.fail = true;
+    LittleFsDataStorage storage(dir.path(), provider.bind(), cachedStats(clock));
+    TEST_ASSERT_TRUE(storage.storeEvent(100, IDataStorage::kCategoryPump, "x"));
+    const StorageStats none = storage.getStorageStats();
+    TEST_ASSERT_EQUAL_UINT32(0, none.totalBytes);
+    TEST_ASSERT_EQUAL_UINT32(0, none.usedBytes);
+    provider.fail = false;
+    storage.getStorageStats();
+    TEST_ASSERT_EQUAL_INT(2, provider.calls);
+    TEST_ASSERT_TRUE(storage.storeSensorReading("env_temperature", 100, 21.0f));
+    TEST_ASSERT_EQUAL_UINT32(treeBytes(dir.path()), storage.getStorageStats().usedBytes);
+    TEST_ASSERT_EQUAL_INT(2, provider.calls);
+}
+
+// --- Decoded-chunk cache (LittleFsDataStorageOptions::chunkCacheBytes) --
+
+constexpr std::size_t kChunkDecodedBytes = kRecordsPerChunk * 8;
+
+LittleFsDataStorageOptions chunkCache(LittleFsDataStorageOptions options,
+                                      std::size_t bytes)
+{
+    options.chunkCacheBytes = bytes;
+    return options;
+}
+
+/// Overwrite every value of a plain .dat chunk in place (same size), as a
+/// stand-in for bytes the cache must not re-read.
+void overwriteValues(const std::string& path, float value)
+{
+    FILE* file = std::fopen(path.c_str(), "r+b");
+    TEST_ASSERT_NOT_NULL(file);
+    const long records = sizeOf(path) / 8;
+    uint32_t bits = 0;
+    std::memcpy(&bits, &value, sizeof(bits));
+    const uint8_t le[4] = {static_cast<uint8_t>(bits), static_cast<uint8_t>(bits >> 8),
+                           static_cast<uint8_t>(bits >> 16), static_cast<uint8_t>(bits >> 24)};
+    for (long i = 0; i < records; ++i) {
+        TEST_ASSERT_EQUAL_INT(0, std::fseek(file, i * 8 + 4, SEEK_SET));
+        TEST_ASSERT_EQUAL_size_t(4, std::fwrite(le, 1, 4, file));
+    }
+    std::fclose(file);
+}
+
+/// A metric's chunk names, oldest first (names are decimal epochs).
+std::vector<std::string> chunksOldestFirst(const TempDir& dir, const std::string& metric)
+{
+    std::vector<std::string> names = listDir(metricDirOf(dir, metric));
+    std::sort(names.begin(), names.end(), [](const std::string& a, const std::string& b) {
+        return std::stoul(a) < std::stoul(b);
+    });
+    return names;
+}
+
+void assertSameReadings(const std::vector<SensorReading>& expected,
+                        const std::vector<SensorReading>& actual)
+{
+    TEST_ASSERT_EQUAL_size_t(expected.size(), actual.size());
+    for (std::size_t i = 0; i < expected.size(); ++i) {
+        TEST_ASSERT_EQUAL_UINT32(expected[i].epoch, actual[i].epoch);
+        TEST_ASSERT_EQUAL_FLOAT(expected[i].value, actual[i].value);
+    }
+}
+
+void test_chunk_cache_reads_match_uncached(void)
+{
+    const LittleFsDataStorageOptions layouts[] = {cachedIndex(), deltaCodec()};
+    for (const LittleFsDataStorageOptions& options : layouts) {
+        TempDir plainDir;
+        TempDir cachedDir;
+        LittleFsDataStorage plain(plainDir.path(), nullptr, options);
+        LittleFsDataStorage cached(cachedDir.path(), nullptr,
+                                   chunkCache(options, 256 * 1024));
+        const std::string metric = "env_temperature";
+        const uint32_t windows[][2] = {{0, UINT32_MAX},
+                                       {1000 + 1500 * 60, 1000 + 1600 * 60},
+                                       {1000 + 1023 * 60, 1000 + 2049 * 60 + 30},
+                                       {5, 999}};
+
+        // Sealed chunks plus a growing active one, then past the ring's end
+        // so the oldest cached chunks are evicted under the cache.
+        const std::size_t steps[] = {3 * kRecordsPerChunk + 100, 7, kRecordsPerChunk,
+                                     kMetricCapacity};
+        std::size_t stored = 0;
+        for (std::size_t step : steps) {
+            for (std::size_t i = stored; i < stored + step; ++i) {
+                const uint32_t epoch = 1000 + static_cast<uint32_t>(i) * 60;
+                const float value = static_cast<float>(i % 97) / 4.0f;
+                TEST_ASSERT_TRUE(plain.storeSensorReading(metric, epoch, value));
+                TEST_ASSERT_TRUE(cached.storeSensorReading(metric, epoch, value));
+            }
+            stored += step;
+            for (const auto& window : windows) {
+                const auto expected = plain.getSensorReadings(metric, window[0], window[1]);
+                assertSameReadings(expected, cached.getSensorReadings(metric, window[0], window[1]));
+                assertSameReadings(expected, cached.getSensorReadings(metric, window[0], window[1]));
+            }
+        }
+    }
+}
+
+void test_chunk_cache_skips_sealed_io_and_follows_the_active_chunk(void)
+{
+    TempDir dir;
+    LittleFsDataStorage storage(dir.path(), nullptr, chunkCache(cachedIndex(), 64 * 1024));
+    const std::string metric = "soil_moisture";
+    appendSeries(storage, metric, 0, 2 * kRecordsPerChunk + 10, 60);
+    const auto before = storage.getSensorReadings(metric, 0, UINT32_MAX);
+    TEST_ASSERT_EQUAL_size_t(2 * kRecordsPerChunk + 10, before.size());
+
+    // A sealed chunk changed behind the storage's back: still served from
+    // the cache, which a fresh instance over the same tree shows.
+    const auto chunks = chunksOldestFirst(dir, metric);
+    TEST_ASSERT_EQUAL_size_t(3, chunks.size());
+    overwriteValues(metricDirOf(dir, metric) + "/" + chunks.front(), -1.0f);
+    assertSameReadings(before, storage.getSensorReadings(metric, 0, UINT32_MAX));
+    LittleFsDataStorage fresh(dir.path(), nullptr, cachedIndex());
+    TEST_ASSERT_EQUAL_FLOAT(-1.0f, fresh.getSensorReadings(metric, 0, 60).front().value);
+
+    // The active chunk is re-checked: appends show up, and an active chunk
+    // that shrank is decoded again from scratch.
+    TEST_ASSERT_TRUE(storage.storeSensorReading(metric, 4'000'000, 5.0f));
+    const auto grown = storage.getSensorReadings(metric, 3'000'000, UINT32_MAX);
+    TEST_ASSERT_EQUAL_size_t(1, grown.size());
+    TEST_ASSERT_EQUAL_FLOAT(5.0f, grown.front().value);
+    const std::string active = metricDirOf(dir, metric) + "/" + chunks.back();
+    TEST_ASSERT_EQUAL_INT(0, ::truncate(active.c_str(), 3 * 8));
+    const auto shrunk = storage.getSensorReadings(metric, 2 * kRecordsPerChunk * 60, UINT32_MAX);
+    TEST_ASSERT_EQUAL_size_t(3, shrunk.size());
+    TEST_ASSERT_EQUAL_FLOAT(static_cast<float>(2 * kRecordsPerChunk + 2), shrunk.back().value);
+}
+
+void test_block_reads_cover_every_record_offset(void)
+{
+    // One chunk across three 1 KiB read blocks plus a torn tail; windows
+    // that start on, before and after block edges, read directly and
+    // through the cache's extension, see exactly their records.
+    const LittleFsDataStorageOptions layouts[] = {cachedIndex(),
+                                                  chunkCache(cachedIndex(), 64 * 1024)};
+    for (const LittleFsDataStorageOptions& options : layouts) {
+        TempDir dir;
+        LittleFsDataStorage storage(dir.path(), nullptr, options);
+        const std::string metric = "soil_moisture";
+        appendSeries(storage, metric, 1000, 300, 60);
+        appendGarbage(singleChunkPath(dir, metric), 5);
+
+        const std::size_t starts[] = {0, 1, 127, 128, 129, 255, 256, 299};
+        for (std::size_t start : starts) {
+            const auto got =
+                storage.getSensorReadings(metric, 1000 + static_cast<uint32_t>(start) * 60,
+                                          UINT32_MAX);
+            TEST_ASSERT_EQUAL_size_t(300 - start, got.size());
+            TEST_ASSERT_EQUAL_UINT32(1000 + start * 60, got.front().epoch);
+            TEST_ASSERT_EQUAL_FLOAT(static_cast<float>(start), got.front().value);
+            TEST_ASSERT_EQUAL_FLOAT(299.0f, got.back().value);
+        }
+
+        // A visitor that stops mid-block ends the scan there.
+        CollectingVisitor firstTen;
+        firstTen.limit = 10;
+        TEST_ASSERT_EQUAL_size_t(10, storage.forEachReading(metric, 1000 + 120 * 60,
+                                                            UINT32_MAX, firstTen));
+        TEST_ASSERT_EQUAL_UINT32(1000 + 129 * 60, firstTen.epochs.back());
+    }
+}
+
+void test_chunk_cache_stays_within_its_budget(void)
+{
+    TempDir dir;
+    LittleFsDataStorage storage(dir.path(), nullptr,
+                                chunkCache(cachedIndex(), kChunkDecodedBytes));
+    const std::string metric = "env_humidity";
+    appendSeries(storage, metric, 0, 2 * kRecordsPerChunk + 100, 60);
+    const auto chunks = chunksOldestFirst(dir, metric);
+    const uint32_t secondChunk = kRecordsPerChunk * 60 + 60;  // its 2nd record
+
+    // Room for one full chunk: the whole-range read leaves only the active
+    // chunk; reading the second chunk alone then evicts that.
+    TEST_ASSERT_EQUAL_size_t(2 * kRecordsPerChunk + 100,
+                             storage.getSensorReadings(metric, 0, UINT32_MAX).size());
+    TEST_ASSERT_EQUAL_size_t(kRecordsPerChunk - 1,
+                             storage.getSensorReadings(metric, secondChunk,
+                                                       2 * kRecordsPerChunk * 60 - 1).size());
+    overwriteValues(metricDirOf(dir, metric) + "/" + chunks[0], -1.0f);
+    overwriteValues(metricDirOf(dir, metric) + "/" + chunks[1], -1.0f);
+    TEST_ASSERT_EQUAL_FLOAT(static_cast<float>(kRecordsPerChunk + 1),
+                            storage.getSensorReadings(metric, secondChunk, secondChunk).front().value);
+    TEST_ASSERT_EQUAL_FLOAT(-1.0f, storage.getSensorReadings(metric, 0, 0).front().value);
+
+    // A budget below one chunk caches nothing sealed and still reads right.
+    LittleFsDataStorage tiny(dir.path(), nullptr,
+                             chunkCache(cachedIndex(), kChunkDecodedBytes / 2));
+    TEST_ASSERT_EQUAL_size_t(2 * kRecordsPerChunk + 100,
+                             tiny.getSensorReadings(metric, 0, UINT32_MAX).size());
+    overwriteValues(metricDirOf(dir, metric) + "/" + chunks[1], -2.0f);
+    TEST_ASSERT_EQUAL_FLOAT(-2.0f, tiny.getSensorReadings(metric, secondChunk, secondChunk).front().value);
+}
+
+// --- Window stats (IDataStorage::getSensorWindowStats) ------------------
+
+void test_window_stats_fold_the_range_in_one_pass(void)
+{
+    TempDir dir;
+    LittleFsDataStorage storage(dir.path(), nullptr, cachedIndex());
+    MockDataStorage mock;
+    const std::string metric = "soil_moisture";
+    const float values[] = {40.0f, 38.5f, 41.0f, 39.5f, 42.0f, 37.0f};
+    for (std::size_t i = 0; i < sizeof(values) / sizeof(values[0]); ++i) {
+        const uint32_t epoch = 1000 + static_cast<uint32_t>(i) * 300;
+        TEST_ASSERT_TRUE(storage.storeSensorReading(metric, epoch, values[i]));
+        TEST_ASSERT_TRUE(mock.storeSensorReading(metric, epoch, values[i]));
+    }
+    const IDataStorage* storages[] = {&storage, &mock};
+    for (const IDataStorage* s : storages) {
+        // Inner four readings: 38.5, 41.0, 39.5, 42.0.
+        const SensorWindowStats stats = s->getSensorWindowStats(metric, 1300, 2200);
+        TEST_ASSERT_EQUAL_UINT32(4, stats.count);
+        TEST_ASSERT_EQUAL_FLOAT(38.5f, stats.min);
+        TEST_ASSERT_EQUAL_FLOAT(42.0f, stats.max);
+        TEST_ASSERT_EQUAL_FLOAT(40.25f, stats.mean);
+        TEST_ASSERT_EQUAL_UINT32(2200, stats.lastEpoch);
+        TEST_ASSERT_EQUAL_FLOAT(42.0f, stats.last);
+
+        TEST_ASSERT_EQUAL_UINT32(0, s->getSensorWindowStats(metric, 5000, 6000).count);
+        TEST_ASSERT_EQUAL_UINT32(0, s->getSensorWindowStats(metric, 2200, 1300).count);
+        TEST_ASSERT_EQUAL_UINT32(0, s->getSensorWindowStats("env_humidity", 0, UINT32_MAX).count);
+    }
+
+    // A backwards epoch (unordered chunk): `last` is still the newest one.
+    TEST_ASSERT_TRUE(storage.storeSensorReading(metric, 500, 99.0f));
+    const SensorWindowStats all = storage.getSensorWindowStats(metric, 0, UINT32_MAX);
+    TEST_ASSERT_EQUAL_UINT32(7, all.count);
+    TEST_ASSERT_EQUAL_UINT32(2500, all.lastEpoch);
+    TEST_ASSERT_EQUAL_FLOAT(37.0f, all.last);
+    TEST_ASSERT_EQUAL_FLOAT(99.0f, all.max);
+}
+
+void test_window_stats_mean_holds_over_a_month(void)
+{
+    TempDir dir;
+    LittleFsDataStorage storage(dir.path(), nullptr, deltaCodec());
+    const std::string metric = "env_temperature";
+    // 30 days at 5 min of a value whose float running sum would drift.
+    const std::size_t total = 8640;
+    for (std::size_t i = 0; i < total; ++i) {
+        TEST_ASSERT_TRUE(storage.storeSensorReading(
+            metric, static_cast<uint32_t>(i) * kLogIntervalS, i % 2 == 0 ? 21.1f : 21.3f));
+    }
+    const SensorWindowStats stats = storage.getSensorWindowStats(metric, 0, UINT32_MAX);
+    TEST_ASSERT_EQUAL_UINT32(total, stats.count);
+    TEST_ASSERT_FLOAT_WITHIN(1e-4f, 21.2f, stats.mean);
+    TEST_ASSERT_EQUAL_FLOAT(21.1f, stats.min);
+    TEST_ASSERT_EQUAL_FLOAT(21.3f, stats.max);
+    TEST_ASSERT_EQUAL_FLOAT(21.3f, stats.last);
+}
+
+// --- Recent readings (LittleFsDataStorageOptions::recentReadings) ---------
+
+LittleFsDataStorageOptions recentRing(LittleFsDataStorageOptions options,
+                                      std::size_t readings)
+{
+    options.recentReadings = readings;
+    return options;
+}
+
+void test_recent_ring_reads_match_flash(void)
+{
+    FakeTimeProvider clock;
+    const LittleFsDataStorageOptions layouts[] = {cachedIndex(), deltaCodec(), rowLayout(),
+                                                  groupCommit(clock)};
+    for (const LittleFsDataStorageOptions& options : layouts) {
+        TempDir plainDir;
+        TempDir ringDir;
+        LittleFsDataStorage plain(plainDir.path(), nullptr, options);
+        LittleFsDataStorage ring(ringDir.path(), nullptr, recentRing(options, 100));
+        const std::string metric = "env_temperature";
+
+        // Fewer readings than the ring holds, then past it, then a chunk
+        // seal: windows inside the ring, reaching past it, and empty.
+        const std::size_t steps[] = {30, 1, 200, kRecordsPerChunk};
+        std::size_t stored = 0;
+        for (std::size_t step : steps) {
+            for (std::size_t i = stored; i < stored + step; ++i) {
+                const uint32_t epoch = 1000 + static_cast<uint32_t>(i) * 60;
+                const float value = static_cast<float>(i % 89) / 2.0f;
+                TEST_ASSERT_TRUE(plain.storeSensorReading(metric, epoch, value));
+                TEST_ASSERT_TRUE(ring.storeSensorReading(metric, epoch, value));
+            }
+            stored += step;
+            const uint32_t last = 1000 + static_cast<uint32_t>(stored - 1) * 60;
+            const uint32_t windows[][2] = {{0, UINT32_MAX},
+                                           {last - 49 * 60, last},
+                                           {last - 20 * 60 - 30, last - 10 * 60},
+                                           {last - 149 * 60, last - 10 * 60},
+                                           {last + 1, UINT32_MAX},
+                                           {last, last - 60}};
+            for (const auto& window : windows) {
+                assertSameReadings(plain.getSensorReadings(metric, window[0], window[1]),
+                                   ring.getSensorReadings(metric, window[0], window[1]));
+            }
+            const LatestReading expected = plain.latestReading(metric);
+            const LatestReading latest = ring.latestReading(metric);
+            TEST_ASSERT_TRUE(latest.found);
+            TEST_ASSERT_EQUAL_UINT32(expected.epoch, latest.epoch);
+            TEST_ASSERT_EQUAL_FLOAT(expected.value, latest.value);
+        }
+    }
+}
+
+void test_recent_ring_serves_covered_windows_from_ram(void)
+{
+    TempDir dir;
+    LittleFsDataStorage storage(dir.path(), nullptr, recentRing(cachedIndex(), 100));
+    const std::string metric = "soil_moisture";
+    appendSeries(storage, metric, 1000, 300, 60);
+    const uint32_t oldestKept = 1000 + 200 * 60;  // the ring holds 200..299
+
+    LatestReading latest = storage.latestReading(metric);
+    TEST_ASSERT_TRUE(latest.found);
+    TEST_ASSERT_EQUAL_UINT32(1000 + 299 * 60, latest.epoch);
+    TEST_ASSERT_EQUAL_FLOAT(299.0f, latest.value);
+
+    // The chunk rewritten behind the storage: a window the ring covers
+    // still reads the RAM copy, one reaching its oldest reading or past it
+    // reads the file.
+    overwriteValues(singleChunkPath(dir, metric), -1.0f);
+    const auto covered = storage.getSensorReadings(metric, oldestKept + 1, UINT32_MAX);
+    TEST_ASSERT_EQUAL_size_t(99, covered.size());
+    TEST_ASSERT_EQUAL_FLOAT(201.0f, covered.front().value);
+    TEST_ASSERT_EQUAL_FLOAT(-1.0f,
+                            storage.getSensorReadings(metric, oldestKept, UINT32_MAX).front().value);
+    TEST_ASSERT_EQUAL_FLOAT(-1.0f, storage.getSensorReadings(metric, 0, UINT32_MAX).back().value);
+    TEST_ASSERT_EQUAL_UINT32(11, storage.getSensorWindowStats(metric, 1000 + 289 * 60,
+                                                              UINT32_MAX).count);
+
+    // Appends feed the ring.
+    TEST_ASSERT_TRUE(storage.storeSensorReading(metric, 1000 + 300 * 60, 7.0f));
+    latest = storage.latestReading(metric);
+    TEST_ASSERT_EQUAL_UINT32(1000 + 300 * 60, latest.epoch);
+    TEST_ASSERT_EQUAL_FLOAT(7.0f, latest.value);
+    TEST_ASSERT_EQUAL_FLOAT(202.0f,
+                            storage.getSensorReadings(metric, oldestKept + 61, UINT32_MAX).front().value);
+
+    // A metric with fewer readings than the ring is covered from its start.
+    appendSeries(storage, "env_humidity", 1000, 10, 60);
+    TEST_ASSERT_EQUAL_size_t(10, storage.getSensorReadings("env_humidity", 0, UINT32_MAX).size());
+    overwriteValues(singleChunkPath(dir, "env_humidity"), -1.0f);
+    TEST_ASSERT_EQUAL_FLOAT(0.0f, storage.getSensorReadings("env_humidity", 0, UINT32_MAX).front().value);
+
+    TEST_ASSERT_FALSE(storage.latestReading("env_pressure").found);
+    TEST_ASSERT_FALSE(storage.latestReading("../escape").found);
+}
+
+void test_recent_ring_retires_on_a_backwards_epoch(void)
+{
+    TempDir dir;
+    const std::string metric = "env_temperature";
+    {
+        LittleFsDataStorage storage(dir.path(), nullptr, recentRing(cachedIndex(), 100));
+        appendSeries(storage, metric, 1000, 50, 60);
+        TEST_ASSERT_EQUAL_size_t(50, storage.getSensorReadings(metric, 0, UINT32_MAX).size());
+        TEST_ASSERT_TRUE(storage.storeSensorReading(metric, 500, 99.0f));
+
+        // Reads go to the files from here on, in file order as before.
+        const auto all = storage.getSensorReadings(metric, 0, UINT32_MAX);
+        TEST_ASSERT_EQUAL_size_t(51, all.size());
+        TEST_ASSERT_EQUAL_UINT32(500, all.back().epoch);
+        overwriteValues(singleChunkPath(dir, metric), -1.0f);
+        TEST_ASSERT_EQUAL_FLOAT(-1.0f, storage.getSensorReadings(metric, 1000, 1000).front().value);
+        const LatestReading latest = storage.latestReading(metric);
+        TEST_ASSERT_EQUAL_UINT32(1000 + 49 * 60, latest.epoch);
+    }
+
+    // Seeding from files that went back in time retires the ring as well.
+    LittleFsDataStorage plain(dir.path(), nullptr, cachedIndex());
+    LittleFsDataStorage restarted(dir.path(), nullptr, recentRing(cachedIndex(), 100));
+    assertSameReadings(plain.getSensorReadings(metric, 2000, UINT32_MAX),
+                       restarted.getSensorReadings(metric, 2000, UINT32_MAX));
+    TEST_ASSERT_EQUAL_UINT32(1000 + 49 * 60, restarted.latestReading(metric).epoch);
+}
+
+// --- Newest-N readings (IDataStorage::getLatestReadings) -----------------
+
+void test_latest_readings_are_the_window_tail(void)
+{
+    FakeTimeProvider clock;
+    const LittleFsDataStorageOptions layouts[] = {
+        cachedIndex(), deltaCodec(), rowLayout(), groupCommit(clock),
+        chunkCache(cachedIndex(), 64 * 1024), recentRing(cachedIndex(), 100)};
+    for (const LittleFsDataStorageOptions& options : layouts) {
+        TempDir dir;
+        LittleFsDataStorage storage(dir.path(), nullptr, options);
+        const std::string metric = "soil_moisture";
+        TEST_ASSERT_TRUE(storage.getLatestReadings(metric, 10).empty());
+        appendSeries(storage, metric, 1000, 2 * kRecordsPerChunk + 37, 60);
+
+        const auto all = storage.getSensorReadings(metric, 0, UINT32_MAX);
+        const std::size_t counts[] = {1, 37, 50, 100, kRecordsPerChunk + 10, 4 * kRecordsPerChunk};
+        for (std::size_t n : counts) {
+            const std::size_t take = n < all.size() ? n : all.size();
+            const std::vector<SensorReading> tail(all.end() - static_cast<std::ptrdiff_t>(take),
+                                                  all.end());
+            const auto latest = storage.getLatestReadings(metric, n);
+            assertSameReadings(tail, latest);
+            TEST_ASSERT_EQUAL_STRING(metric.c_str(), latest.back().metric.c_str());
+        }
+        TEST_ASSERT_TRUE(storage.getLatestReadings(metric, 0).empty());
+        TEST_ASSERT_TRUE(storage.getLatestReadings("env_pressure", 10).empty());
+        TEST_ASSERT_TRUE(storage.getLatestReadings("../escape", 10).empty());
+    }
+}
+
+void test_latest_readings_stop_at_the_newest_chunk(void)
+{
+    TempDir dir;
+    LittleFsDataStorage storage(dir.path(), nullptr, cachedIndex());
+    const std::string metric = "env_temperature";
+    appendSeries(storage, metric, 1000, 3 * kRecordsPerChunk + 20, 60);
+
+    // Every chunk but the two newest rewritten behind the storage: the
+    // newest readings never reach them.
+    const std::vector<std::string> chunks = chunksOldestFirst(dir, metric);
+    TEST_ASSERT_EQUAL_size_t(4, chunks.size());
+    for (std::size_t i = 0; i + 2 < chunks.size(); ++i) {
+        overwriteValues(metricDirOf(dir, metric) + "/" + chunks[i], -1.0f);
+    }
+    const auto active = storage.getLatestReadings(metric, 20);
+    TEST_ASSERT_EQUAL_size_t(20, active.size());
+    TEST_ASSERT_EQUAL_FLOAT(3.0f * kRecordsPerChunk, active.front().value);
+    const auto spanning = storage.getLatestReadings(metric, 50);
+    TEST_ASSERT_EQUAL_size_t(50, spanning.size());
+    for (std::size_t i = 0; i < spanning.size(); ++i) {
+        TEST_ASSERT_EQUAL_FLOAT(static_cast<float>(3 * kRecordsPerChunk - 30 + i),
+                                spanning[i].value);
+    }
+    TEST_ASSERT_EQUAL_UINT32(1000 + (3 * kRecordsPerChunk + 19) * 60, spanning.back().epoch);
+    // Reaching further back does read the rewritten chunks.
+    TEST_ASSERT_EQUAL_FLOAT(-1.0f, storage.getLatestReadings(metric, kRecordsPerChunk + 21)
+                                       .front().value);
+}
+
+// --- Retention plan (storage/RetentionPlan.h) ----------------------------
+
+void test_retention_rules_parse(void)
+{
+    std::vector<retention::Rule> rules;
+    TEST_ASSERT_TRUE(retention::parseRules(" soil_moisture:90d, env_pressure:1 ,", rules));
+    TEST_ASSERT_EQUAL_size_t(2, rules.size());
+    TEST_ASSERT_EQUAL_STRING("soil_moisture", rules[0].metric.c_str());
+    TEST_ASSERT_EQUAL_UINT32(90, rules[0].targetDays);
+    TEST_ASSERT_EQUAL_UINT32(0, rules[0].weight);
+    TEST_ASSERT_EQUAL_UINT32(1, rules[1].weight);
+
+    // The last entry of a metric wins; an empty spec is no rules.
+    rules.clear();
+    TEST_ASSERT_TRUE(retention::parseRules("soil_ph:2,soil_ph:7d", rules));
+    TEST_ASSERT_EQUAL_size_t(1, rules.size());
+    TEST_ASSERT_EQUAL_UINT32(7, rules[0].targetDays);
+    TEST_ASSERT_EQUAL_UINT32(0, rules[0].weight);
+    TEST_ASSERT_TRUE(retention::parseRules("", rules));
+    TEST_ASSERT_EQUAL_size_t(1, rules.size());
+
+    const char* malformed[] = {"soil_ph", "soil_ph:", "soil_ph:0", "soil_ph:x",
+                               "soil_ph:5d5", ":3", "../escape:1", "soil_ph:9999999"};
+    for (const char* spec : malformed) {
+        std::vector<retention::Rule> none;
+        TEST_ASSERT_FALSE_MESSAGE(retention::parseRules(spec, none), spec);
+        TEST_ASSERT_TRUE(none.empty());
+    }
+}
+
+void test_retention_plan_splits_the_budget(void)
+{
+    // The littlefs partition less its reserves: 80 chunks for ten metrics,
+    // planned at the delta codec's conservative 4 bytes per reading.
+    retention::Budget budget;
+    budget.bytes = 80 * 8192;
+    budget.bytesPerReading = 4;
+    std::vector<retention::Rule> rules;
+    TEST_ASSERT_TRUE(retention::parseRules("soil_moisture:90d", rules));
+    retention::Plan plan = retention::plan(budget, rules);
+    TEST_ASSERT_TRUE(plan.fits());
+    // 90 days at 5 min = 25920 readings = 13 sealed chunks + the active one.
+    TEST_ASSERT_EQUAL_size_t(14, plan.chunksFor("soil_moisture"));
+    TEST_ASSERT_TRUE(retention::Plan::coveredDays(14, budget) >= 90);
+    // The other nine share what is left evenly, whole chunks only.
+    TEST_ASSERT_EQUAL_size_t(7, plan.chunksFor("env_pressure"));
+    TEST_ASSERT_EQUAL_size_t(7, plan.otherChunks());
+    TEST_ASSERT_EQUAL_size_t(77, plan.totalChunks());
+
+    // Weights: 3:1 against six unnamed metrics (64 free chunks: 19.2, 6.4
+    // and 6.4 each), remainders to the rules.
+    rules.clear();
+    TEST_ASSERT_TRUE(retention::parseRules("soil_moisture:3,env_pressure:1", rules));
+    budget.metrics = 8;
+    plan = retention::plan(budget, rules);
+    TEST_ASSERT_TRUE(plan.fits());
+    TEST_ASSERT_EQUAL_size_t(2 + 20, plan.chunksFor("soil_moisture"));
+    TEST_ASSERT_EQUAL_size_t(2 + 7, plan.chunksFor("env_pressure"));
+    TEST_ASSERT_EQUAL_size_t(2 + 6, plan.otherChunks());
+    TEST_ASSERT_EQUAL_size_t(79, plan.totalChunks());
+
+    // A target larger than the budget takes what there is; a floor larger
+    // than the budget still gives every metric its minimum.
+    rules.clear();
+    TEST_ASSERT_TRUE(retention::parseRules("soil_moisture:365d", rules));
+    budget.bytes = 12 * 8192;
+    budget.metrics = 2;
+    plan = retention::plan(budget, rules);
+    TEST_ASSERT_FALSE(plan.fits());
+    TEST_ASSERT_EQUAL_size_t(10, plan.chunksFor("soil_moisture"));
+    TEST_ASSERT_EQUAL_size_t(retention::kMinChunks, plan.otherChunks());
+    budget.metrics = 10;
+    budget.bytes = 4 * 8192;
+    plan = retention::plan(budget, {});
+    TEST_ASSERT_FALSE(plan.fits());
+    TEST_ASSERT_EQUAL_size_t(retention::kMinChunks, plan.chunksFor("env_humidity"));
+
+    // No plan: the storage default applies.
+    TEST_ASSERT_TRUE(retention::Plan().empty());
+    TEST_ASSERT_EQUAL_size_t(0, retention::Plan().chunksFor("soil_moisture"));
+}
+
+LittleFsDataStorageOptions retained(const char* spec, std::size_t chunks, std::size_t metrics)
+{
+    LittleFsDataStorageOptions options = cachedIndex();
+    std::vector<retention::Rule> rules;
+    TEST_ASSERT_TRUE(retention::parseRules(spec, rules));
+    retention::Budget budget;
+    budget.bytes = chunks * LittleFsDataStorage::kHistoryChunkMaxBytes;
+    budget.metrics = metrics;
+    options.retention = retention::plan(budget, rules);
+    return options;
+}
+
+void test_retention_plan_sizes_each_metric_ring(void)
+{
+    TempDir dir;
+    {
+        // 10 chunks, 3:1: soil 2 + 5 (4.5 rounded up), pressure 2 + 1;
+        // an unnamed metric gets the floor.
+        LittleFsDataStorage storage(dir.path(), nullptr,
+                                    retained("soil_moisture:3,env_pressure:1", 10, 2));
+        appendSeries(storage, "soil_moisture", 0, 8 * kRecordsPerChunk + 10, 60);
+        appendSeries(storage, "env_pressure", 0, 4 * kRecordsPerChunk + 10, 60);
+        appendSeries(storage, "env_humidity", 0, 3 * kRecordsPerChunk + 10, 60);
+        TEST_ASSERT_EQUAL_size_t(7, listDir(metricDirOf(dir, "soil_moisture")).size());
+        TEST_ASSERT_EQUAL_size_t(3, listDir(metricDirOf(dir, "env_pressure")).size());
+        TEST_ASSERT_EQUAL_size_t(2, listDir(metricDirOf(dir, "env_humidity")).size());
+        const auto soil = storage.getSensorReadings("soil_moisture", 0, UINT32_MAX);
+        TEST_ASSERT_EQUAL_size_t(6 * kRecordsPerChunk + 10, soil.size());
+        TEST_ASSERT_EQUAL_UINT32(2 * kRecordsPerChunk * 60, soil.front().epoch);
+    }
+
+    // A smaller ring after a restart: the excess goes at the next seal.
+    LittleFsDataStorage shrunk(dir.path(), nullptr, retained("soil_moisture:1", 4, 1));
+    appendSeries(shrunk, "soil_moisture", (8 * kRecordsPerChunk + 10) * 60, kRecordsPerChunk - 10,
+                 60);
+    TEST_ASSERT_EQUAL_size_t(7, listDir(metricDirOf(dir, "soil_moisture")).size());
+    TEST_ASSERT_TRUE(shrunk.storeSensorReading("soil_moisture", 9 * kRecordsPerChunk * 60, 1.0f));
+    const auto chunks = chunksOldestFirst(dir, "soil_moisture");
+    TEST_ASSERT_EQUAL_size_t(4, chunks.size());
+    TEST_ASSERT_EQUAL_UINT32(std::stoul(chunks.front()),
+                             shrunk.getSensorReadings("soil_moisture", 0, UINT32_MAX).front().epoch);
+}
+
+// --- Write accounting (StorageStats::writes) -----------------------------
+
+/// Microsecond clock for appendClock that advances `stepUs` per read, so
+/// each timed append costs exactly one step.
+std::function<int64_t()> steppingMicros(int64_t& nowUs, int64_t stepUs)
+{
+    return [&nowUs, stepUs] { return nowUs += stepUs; };
+}
+
+void test_write_stats_count_appends_syncs_and_files(void)
+{
+    TempDir dir;
+    int64_t nowUs = 0;
+    LittleFsDataStorageOptions options;
+    options.appendClock = steppingMicros(nowUs, 50);
+    LittleFsDataStorage storage(dir.path(), nullptr, options);
+    const std::string metric = "soil_moisture";
+
+    // One chunk past the ring bound: every record synced, one chunk evicted.
+    const std::size_t total = kMetricCapacity + kRecordsPerChunk;
+    appendSeries(storage, metric, 1000, total, 1);
+    StorageWriteStats writes = storage.getStorageStats().writes;
+    TEST_ASSERT_EQUAL_UINT64(total * LittleFsDataStorage::kHistoryRecordBytes,
+                             writes.bytesAppended);
+    TEST_ASSERT_EQUAL_UINT32(total, writes.syncs);
+    TEST_ASSERT_EQUAL_UINT32(LittleFsDataStorage::kHistoryMaxChunksPerMetric + 1,
+                             writes.filesCreated);
+    TEST_ASSERT_EQUAL_UINT32(1, writes.filesRemoved);
+    TEST_ASSERT_EQUAL_UINT32(0, writes.tornRepairs);
+    TEST_ASSERT_EQUAL_UINT32(0, writes.rotations);
+    // The clock is read twice per append (start and end): one step each.
+    TEST_ASSERT_EQUAL_UINT64(total * 50, writes.appendUs);
+
+    // Filling the first event segment and writing one more rotates once;
+    // each segment started syncs its header.
+    appendEvents(storage, 1000, 0, kEventsPerSegment + 1);
+    writes = storage.getStorageStats().writes;
+    TEST_ASSERT_EQUAL_UINT32(1, writes.rotations);
+    TEST_ASSERT_EQUAL_UINT32(total + kEventsPerSegment + 1 + 2, writes.syncs);
+    TEST_ASSERT_EQUAL_UINT64((total + kEventsPerSegment + 1) * 50, writes.appendUs);
+}
+
+void test_write_stats_count_torn_repairs_and_group_commits(void)
+{
+    TempDir dir;
+    const std::string metric = "soil_moisture";
+    {
+        LittleFsDataStorage first(dir.path());
+        TEST_ASSERT_TRUE(first.storeSensorReading(metric, 100, 1.0f));
+    }
+    appendGarbage(singleChunkPath(dir, metric), 3);
+
+    // The next writer cuts the torn tail once before appending.
+    FakeTimeProvider clock;
+    LittleFsDataStorage storage(dir.path(), nullptr, groupCommit(clock, 8));
+    for (uint32_t i = 0; i < 16; ++i) {
+        TEST_ASSERT_TRUE(storage.storeSensorReading(metric, 200 + i, 2.0f));
+    }
+    const StorageWriteStats writes = storage.getStorageStats().writes;
+    TEST_ASSERT_EQUAL_UINT32(1, writes.tornRepairs);
+    // Sixteen buffered records at an eight-record trigger: two syncs.
+    TEST_ASSERT_EQUAL_UINT32(2, writes.syncs);
+    TEST_ASSERT_EQUAL_UINT64(16 * LittleFsDataStorage::kHistoryRecordBytes,
+                             writes.bytesAppended);
+    TEST_ASSERT_EQUAL_UINT32(0, writes.filesCreated);
+    // No appendClock: latency stays unmeasured rather than guessed.
+    TEST_ASSERT_EQUAL_UINT64(0, writes.appendUs);
+}
+
+// --- Batch journal (journalBatches) --------------------------------------
+
+LittleFsDataStorageOptions journaled()
+{
+    LittleFsDataStorageOptions options;
+    options.journalBatches = true;
+    return options;
+}
+
+/// One logging pass over `metrics` at `epoch`, every metric stored.
+void storePass(LittleFsDataStorage& storage, const std::vector<std::string>& metrics,
+               uint32_t epoch)
+{
+    std::vector<SensorReading> pass;
+    for (std::size_t i = 0; i < metrics.size(); ++i) {
+        pass.push_back(SensorReading{metrics[i], epoch, static_cast<float>(epoch + i)});
+    }
+    TEST_ASSERT_EQUAL_size_t(pass.size(), storage.storeSensorReadings(pass.data(), pass.size()));
+}
+
+std::vector<uint32_t> epochsOf(const LittleFsDataStorage& storage, const std::string& metric)
+{
+    std::vector<uint32_t> epochs;
+    for (const SensorReading& r : storage.getSensorReadings(metric, 0, UINT32_MAX)) {
+        epochs.push_back(r.epoch);
+    }
+    return epochs;
+}
+
+/// Cut the newest record of `metric` (fixed codec), as if the power went
+/// before its append.
+void dropNewestRecord(const TempDir& dir, const std::string& metric)
+{
+    const std::string path = singleChunkPath(dir, metric);
+    const long size = sizeOf(path);
+    TEST_ASSERT_EQUAL_INT(
+        0, ::truncate(path.c_str(), size - static_cast<long>(LittleFsDataStorage::kHistoryRecordBytes)));
+}
+
+void test_journaled_batch_syncs_once(void)
+{
+    TempDir dir;
+    std::vector<std::string> metrics;
+    for (int i = 0; i < 10; ++i) {
+        metrics.push_back("metric_" + std::to_string(i));
+    }
+    LittleFsDataStorage storage(dir.path(), nullptr, journaled());
+    storePass(storage, metrics, 100);
+    storePass(storage, metrics, 200);
+    // One sync per pass (the journal record), not one per metric.
+    TEST_ASSERT_EQUAL_UINT32(2, storage.getStorageStats().writes.syncs);
+    for (const std::string& metric : metrics) {
+        TEST_ASSERT_EQUAL_size_t(2, epochsOf(storage, metric).size());
+    }
+    TEST_ASSERT_TRUE(sizeOf(dir.path() + "/journal") > 0);
+
+    // A one-metric batch is its own single append: no journal record.
+    storePass(storage, {metrics[0]}, 300);
+    TEST_ASSERT_EQUAL_UINT32(3, storage.getStorageStats().writes.syncs);
+
+    TempDir plainDir;
+    LittleFsDataStorage plain(plainDir.path());
+    storePass(plain, metrics, 100);
+    TEST_ASSERT_EQUAL_UINT32(10, plain.getStorageStats().writes.syncs);
+}
+
+void test_journal_replays_a_pass_cut_short(void)
+{
+    TempDir dir;
+    const std::vector<std::string> metrics = {"env_temperature", "env_humidity",
+                                              "soil_moisture"};
+    {
+        LittleFsDataStorage first(dir.path(), nullptr, journaled());
+        storePass(first, metrics, 100);
+        storePass(first, metrics, 200);
+    }
+    // The power went after the first metric of the 200 pass.
+    dropNewestRecord(dir, metrics[1]);
+    dropNewestRecord(dir, metrics[2]);
+
+    LittleFsDataStorage storage(dir.path(), nullptr, journaled());
+    storePass(storage, metrics, 300);
+    const std::vector<uint32_t> expected = {100, 200, 300};
+    for (const std::string& metric : metrics) {
+        TEST_ASSERT_TRUE(expected == epochsOf(storage, metric));
+    }
+    const auto humidity = storage.getSensorReadings(metrics[1], 200, 200);
+    TEST_ASSERT_EQUAL_FLOAT(201.0f, humidity[0].value);
+
+    // A journal whose pass completed adds nothing on the next restart.
+    LittleFsDataStorage again(dir.path(), nullptr, journaled());
+    storePass(again, metrics, 400);
+    for (const std::string& metric : metrics) {
+        TEST_ASSERT_EQUAL_size_t(4, epochsOf(again, metric).size());
+    }
+}
+
+void test_journal_outlived_by_later_appends_adds_nothing(void)
+{
+    TempDir dir;
+    const std::vector<std::string> metrics = {"env_temperature", "env_humidity"};
+    {
+        LittleFsDataStorage first(dir.path(), nullptr, journaled());
+        storePass(first, metrics, 100);
+        // One metric: not journaled, so the pass's record stays behind.
+        TEST_ASSERT_TRUE(first.storeSensorReading(metrics[0], 200, 1.0f));
+    }
+
+    LittleFsDataStorage storage(dir.path(), nullptr, journaled());
+    TEST_ASSERT_TRUE(storage.storeSensorReading(metrics[1], 300, 2.0f));
+    const std::vector<uint32_t> temperature = {100, 200};
+    TEST_ASSERT_TRUE(temperature == epochsOf(storage, metrics[0]));
+    const std::vector<uint32_t> humidity = {100, 300};
+    TEST_ASSERT_TRUE(humidity == epochsOf(storage, metrics[1]));
+}
+
+void test_journal_torn_record_is_discarded(void)
+{
+    TempDir dir;
+    const std::vector<std::string> metrics = {"env_temperature", "env_humidity"};
+    {
+        LittleFsDataStorage first(dir.path(), nullptr, journaled());
+        storePass(first, metrics, 100);
+    }
+    // A torn record: the power went while the journal was written, so
+    // nothing of that pass reached the metrics.
+    const std::string journal = dir.path() + "/journal";
+    TEST_ASSERT_EQUAL_INT(0, ::truncate(journal.c_str(), sizeOf(journal) - 1));
+    dropNewestRecord(dir, metrics[1]);
+
+    LittleFsDataStorage storage(dir.path(), nullptr, journaled());
+    storePass(storage, metrics, 200);
+    TEST_ASSERT_EQUAL_size_t(2, epochsOf(storage, metrics[0]).size());
+    const std::vector<uint32_t> humidity = epochsOf(storage, metrics[1]);
+    TEST_ASSERT_EQUAL_size_t(1, humidity.size());
+    TEST_ASSERT_EQUAL_UINT32(200, humidity[0]);
+}
+
+// --- QueuedDataStorage (storage writer task queue) ------------------------
+
+void test_queued_writes_return_before_the_backend_sees_them(void)
+{
+    TempDir dir;
+    LittleFsDataStorage inner(dir.path());
+    QueuedDataStorage storage(inner, 4);
+    const std::string metric = "soil_moisture";
+
+    const MetricSample pass[2] = {{metric::kSoilMoisture, 100, 1.0f},
+                                  {metric::kEnvTemperature, 100, 20.0f}};
+    TEST_ASSERT_EQUAL_size_t(2, storage.storeSamples(pass, 2));
+    TEST_ASSERT_TRUE(storage.storeEvent(100, IDataStorage::kCategoryPump, "on"));
+    TEST_ASSERT_TRUE(storage.storeSensorReading("../escape", 100, 1.0f));
+    TEST_ASSERT_TRUE(inner.getSensorReadings(metric, 0, UINT32_MAX).empty());
+    TEST_ASSERT_TRUE(inner.getEvents(10).empty());
+
+    // Full: refused and counted, never grown; a batch is refused whole.
+    TEST_ASSERT_FALSE(storage.storeSensorReading(metric, 200, 2.0f));
+    TEST_ASSERT_EQUAL_size_t(0, storage.storeSamples(pass, 2));
+    StorageQueueStats queue = storage.getStorageStats().queue;
+    TEST_ASSERT_EQUAL_UINT32(4, queue.capacity);
+    TEST_ASSERT_EQUAL_UINT32(4, queue.depth);
+    TEST_ASSERT_EQUAL_UINT32(4, queue.highWater);
+    TEST_ASSERT_EQUAL_UINT32(3, queue.dropped);
+
+    // One writer pass applies everything in order; the unsafe name fails
+    // at the backend and is counted there.
+    TEST_ASSERT_EQUAL_size_t(4, storage.waitAndApply(0));
+    TEST_ASSERT_EQUAL_size_t(1, inner.getSensorReadings(metric, 0, UINT32_MAX).size());
+    TEST_ASSERT_EQUAL_size_t(1, inner.getSensorReadings("env_temperature", 0, UINT32_MAX).size());
+    TEST_ASSERT_EQUAL_size_t(1, inner.getEvents(10).size());
+    queue = storage.getStorageStats().queue;
+    TEST_ASSERT_EQUAL_UINT32(0, queue.depth);
+    TEST_ASSERT_EQUAL_UINT32(4, queue.applied);
+    TEST_ASSERT_EQUAL_UINT32(1, queue.failed);
+
+    // The ring wraps: the slots are reused in arrival order.
+    for (uint32_t i = 0; i < 3; ++i) {
+        TEST_ASSERT_TRUE(storage.storeSensorReading(metric, 300 + i, 3.0f));
+    }
+    TEST_ASSERT_EQUAL_size_t(3, storage.waitAndApply(0));
+    const auto readings = inner.getSensorReadings(metric, 0, UINT32_MAX);
+    TEST_ASSERT_EQUAL_size_t(4, readings.size());
+    TEST_ASSERT_EQUAL_UINT32(302, readings[3].epoch);
+}
+
+void test_queued_reads_and_drain_apply_the_queue_first(void)
+{
+    TempDir dir;
+    FakeTimeProvider clock;
+    LittleFsDataStorage inner(dir.path(), nullptr, groupCommit(clock));
+    QueuedDataStorage storage(inner, 8);
+    const std::string metric = "soil_moisture";
+
+    // No writer pass yet: a read still sees what was accepted before it.
+    TEST_ASSERT_TRUE(storage.storeSensorReading(metric, 100, 1.0f));
+    TEST_ASSERT_EQUAL_size_t(1, storage.getSensorReadings(metric, 0, UINT32_MAX).size());
+    const std::string longDetail(IDataStorage::kEventDetailMaxLen + 30, 'd');
+    TEST_ASSERT_TRUE(storage.storeEvent(100, IDataStorage::kCategoryOta, longDetail));
+    const auto events = storage.getEvents(1);
+    TEST_ASSERT_EQUAL_size_t(1, events.size());
+    TEST_ASSERT_EQUAL_size_t(IDataStorage::kEventDetailMaxLen, events[0].detail.size());
+
+    // drain() (before reboot/OTA) also commits the backend's write-behind.
+    TEST_ASSERT_TRUE(storage.storeSensorReading(metric, 200, 2.0f));
+    TEST_ASSERT_EQUAL_INT(0, static_cast<int>(committedBytes(dir, metric)));
+    TEST_ASSERT_TRUE(storage.drain());
+    TEST_ASSERT_EQUAL_INT(
+        2 * static_cast<int>(LittleFsDataStorage::kHistoryRecordBytes),
+        static_cast<int>(committedBytes(dir, metric)));
+}
+
+void test_queued_flush_if_due_is_polled_by_the_writer(void)
+{
+    TempDir dir;
+    FakeTimeProvider clock;
+    LittleFsDataStorage inner(dir.path(), nullptr, groupCommit(clock));
+    QueuedDataStorage storage(inner, 8);
+    const std::string metric = "soil_moisture";
+
+    TEST_ASSERT_TRUE(storage.storeSensorReading(metric, 100, 1.0f));
+    TEST_ASSERT_EQUAL_size_t(1, storage.waitAndApply(0));
+    clock.advance(kCommitWindowMs);
+
+    // The producer's flushIfDue() only signals; the writer pass polls the
+    // deadline (and does not sit out its timeout to do so).
+    TEST_ASSERT_TRUE(storage.flushIfDue());
+    TEST_ASSERT_EQUAL_INT(0, static_cast<int>(committedBytes(dir, metric)));
+    TEST_ASSERT_EQUAL_size_t(0, storage.waitAndApply(60'000));
+    TEST_ASSERT_EQUAL_INT(static_cast<int>(LittleFsDataStorage::kHistoryRecordBytes),
+                          static_cast<int>(committedBytes(dir, metric)));
+}
+
+void test_queued_identical_events_coalesce(void)
+{
+    TempDir dir;
+    LittleFsDataStorage inner(dir.path());
+    QueuedDataStorage storage(inner, 8);
+
+    // A run of identical events while queued becomes one slot; a different
+    // category or detail, or a write in between, starts a new one.
+    TEST_ASSERT_TRUE(storage.storeEvent(100, IDataStorage::kCategoryConnectivity, "wifi=Disconnected"));
+    TEST_ASSERT_TRUE(storage.storeEvent(101, IDataStorage::kCategoryConnectivity, "wifi=Disconnected"));
+    TEST_ASSERT_TRUE(storage.storeEvent(105, IDataStorage::kCategoryConnectivity, "wifi=Disconnected"));
+    TEST_ASSERT_TRUE(storage.storeEvent(106, IDataStorage::kCategoryReset, "wifi=Disconnected"));
+    TEST_ASSERT_TRUE(storage.storeEvent(107, IDataStorage::kCategoryReset, "wifi=Connected"));
+    TEST_ASSERT_TRUE(storage.storeSensorReading("soil_moisture", 108, 1.0f));
+    TEST_ASSERT_TRUE(storage.storeEvent(109, IDataStorage::kCategoryReset, "wifi=Connected"));
+    StorageQueueStats queue = storage.getStorageStats().queue;
+    TEST_ASSERT_EQUAL_UINT32(5, queue.depth);
+    TEST_ASSERT_EQUAL_UINT32(2, queue.coalesced);
+
+    TEST_ASSERT_EQUAL_size_t(5, storage.waitAndApply(0));
+    const auto events = inner.getEvents(10);  // newest first
+    TEST_ASSERT_EQUAL_size_t(4, events.size());
+    TEST_ASSERT_EQUAL_UINT32(100, events[3].epoch);
+    TEST_ASSERT_EQUAL_STRING("wifi=Disconnected count=3 last=105", events[3].detail.c_str());
+    TEST_ASSERT_EQUAL_STRING("wifi=Disconnected", events[2].detail.c_str());
+    TEST_ASSERT_EQUAL_STRING("wifi=Connected", events[0].detail.c_str());
+
+    // Once applied, a repeat is queued again; a full-length detail gives
+    // way to the suffix.
+    const std::string longDetail(IDataStorage::kEventDetailMaxLen, 'd');
+    TEST_ASSERT_TRUE(storage.storeEvent(200, IDataStorage::kCategoryReset, "wifi=Connected"));
+    TEST_ASSERT_TRUE(storage.storeEvent(201, IDataStorage::kCategoryOta, longDetail));
+    TEST_ASSERT_TRUE(storage.storeEvent(202, IDataStorage::kCategoryOta, longDetail + "x"));
+    TEST_ASSERT_EQUAL_size_t(2, storage.waitAndApply(0));
+    const auto more = inner.getEvents(2);
+    TEST_ASSERT_EQUAL_STRING("wifi=Connected", more[1].detail.c_str());
+    TEST_ASSERT_EQUAL_size_t(IDataStorage::kEventDetailMaxLen, more[0].detail.size());
+    const std::string suffix = " count=2 last=202";
+    TEST_ASSERT_EQUAL_STRING(suffix.c_str(),
+        more[0].detail.substr(more[0].detail.size() - suffix.size()).c_str());
+    TEST_ASSERT_EQUAL_UINT32(3, storage.getStorageStats().queue.coalesced);
+
+    // A compact detail (EventCodec.h) takes the repeat as a trailer and
+    // survives the log byte for byte.
+    const EventEncoder flap = EventEncoder(EventCode::Wifi).str("Disconnected");
+    TEST_ASSERT_TRUE(storage.storeEvent(300, IDataStorage::kCategoryConnectivity, flap.view()));
+    TEST_ASSERT_TRUE(storage.storeEvent(301, IDataStorage::kCategoryConnectivity, flap.view()));
+    TEST_ASSERT_EQUAL_size_t(1, storage.waitAndApply(0));
+    const auto compact = inner.getEvents(1);
+    TEST_ASSERT_TRUE(isCompactEvent(compact[0].detail));
+    TEST_ASSERT_EQUAL_STRING("wifi=Disconnected count=2 last=301",
+                             renderEventDetail(compact[0].detail).c_str());
+}
+
+// --- T028: LockedDataStorage decorator (FR-013) --------------------------
+// Delegates the full contract path unchanged (the wrapper adds task-level
+// mutex serialization; see LockedDataStorage.h — same mechanism PR-02's
+// LockedWaterPump test established). The instrumented mock proves every
+// call reached the wrapped storage.
+
+void test_locked_data_storage_delegates_full_contract(void)
+{
+    MockDataStorage inner;
+    inner.stats = StorageStats{983040, 12288};
+    LockedDataStorage storage(inner);
+
+    // storeSensorReading: accepted appends and the rejection paths pass
+    // through unchanged.
+    TEST_ASSERT_TRUE(storage.storeSensorReading("soil_moisture", 100, 1.0f));
+    TEST_ASSERT_TRUE(storage.storeSensorReading("soil_moisture", 200, 2.0f));
+    TEST_ASSERT_TRUE(storage.storeSensorReading("soil_moisture", 300, 3.0f));
+    TEST_ASSERT_FALSE(storage.storeSensorReading("bad/metric", 400, 4.0f));
+    TEST_ASSERT_EQUAL(3, inner.acceptedWrites);
+    TEST_ASSERT_EQUAL(1, inner.rejectedWrites);
+
+    // getSensorReadings: inclusive chronological range, empty on t0 > t1.
+    const auto mid = storage.getSensorReadings("soil_moisture", 200, 300);
+    TEST_ASSERT_EQUAL_size_t(2, mid.size());
+    TEST_ASSERT_EQUAL_UINT32(200, mid[0].epoch);
+    TEST_ASSERT_EQUAL_UINT32(300, mid[1].epoch);
+    TEST_ASSERT_TRUE(storage.getSensorReadings("soil_moisture", 300, 200).empty());
+
+    // forEachReading: the same range, streamed through the wrapper.
+    CollectingVisitor streamed;
+    TEST_ASSERT_EQUAL_size_t(2, storage.forEachReading("soil_moisture", 200, 300, streamed));
+    TEST_ASSERT_EQUAL_UINT32(300, streamed.epochs[1]);
+
+    // getSensorWindowStats: one locked call over the same range.
+    const SensorWindowStats window = storage.getSensorWindowStats("soil_moisture", 200, 300);
+    TEST_ASSERT_EQUAL_UINT32(2, window.count);
+    TEST_ASSERT_EQUAL_FLOAT(2.5f, window.mean);
+
+    // storeEvent: detail truncation happens behind the wrapper.
+    const std::string longDetail(IDataStorage::kEventDetailMaxLen + 30, 'd');
+    TEST_ASSERT_TRUE(storage.storeEvent(500, IDataStorage::kCategoryPump,
+                                        "pump started"));
+    TEST_ASSERT_TRUE(storage.storeEvent(600, IDataStorage::kCategoryFailsafe,
+                                        longDetail));
+
+    // getEvents: newest-first with maxCount.
+    const auto events = storage.getEvents(2);
+    TEST_ASSERT_EQUAL_size_t(2, events.size());
+    TEST_ASSERT_EQUAL_UINT32(600, events[0].epoch);
+    TEST_ASSERT_EQUAL_size_t(IDataStorage::kEventDetailMaxLen,
+                             events[0].detail.size());
+    TEST_ASSERT_EQUAL_UINT32(500, events[1].epoch);
+    TEST_ASSERT_EQUAL_STRING("pump started", events[1].detail.c_str());
+
+    // queryEvents: the category filter reaches the wrapped storage.
+    EventQuery pumpOnly;
+    pumpOnly.categoryMask = EventQuery::categoryBit(IDataStorage::kCategoryPump);
+    const EventPage page = storage.queryEvents(pumpOnly);
+    TEST_ASSERT_EQUAL_size_t(1, page.events.size());
+    TEST_ASSERT_EQUAL_UINT32(500, page.events[0].epoch);
+
+    // getStorageStats: injected stats come back verbatim.
+    const StorageStats stats = storage.getStorageStats();
+    TEST_ASSERT_EQUAL_UINT32(983040, stats.totalBytes);
+    TEST_ASSERT_EQUAL_UINT32(12288, stats.usedBytes);
+
+    // storeSensorReadings: the batch reaches the wrapped storage in one call.
+    const SensorReading batch[] = {{"soil_moisture", 400, 4.0f},
+                                   {"env_humidity", 400, 50.0f}};
+    TEST_ASSERT_EQUAL_size_t(2, storage.storeSensorReadings(batch, 2));
+    TEST_ASSERT_EQUAL(1, inner.batchWrites);
+    TEST_ASSERT_EQUAL(7, inner.acceptedWrites);  // 3 readings + 2 events + 2
+
+    // flush()/flushIfDue() reach the wrapped storage.
+    TEST_ASSERT_TRUE(storage.flush());
+    TEST_ASSERT_TRUE(storage.flushIfDue());
+    TEST_ASSERT_EQUAL(1, inner.flushCalls);
+    TEST_ASSERT_EQUAL(1, inner.flushIfDueCalls);
+
+    // A persistence failure surfaces through the wrapper unchanged.
+    inner.failWrites = true;
+    TEST_ASSERT_FALSE(storage.storeSensorReading("soil_moisture", 700, 7.0f));
+    TEST_ASSERT_FALSE(storage.storeEvent(700, IDataStorage::kCategoryPump, "x"));
+}
+
+// The wrapped LittleFsDataStorage keeps its contract behind the wrapper
+// (real-store spot check: on-disk round-trip through the mutex).
+void test_locked_data_storage_over_real_storage(void)
+{
+    TempDir dir;
+    LittleFsDataStorage inner(dir.path());
+    LockedDataStorage storage(inner);
+
+    TEST_ASSERT_TRUE(storage.storeSensorReading("env_temperature", 100, 21.5f));
+    TEST_ASSERT_TRUE(storage.storeEvent(200, IDataStorage::kCategoryReset,
+                                        "boot"));
+
+    const auto readings =
+        storage.getSensorReadings("env_temperature", 0, UINT32_MAX);
+    TEST_ASSERT_EQUAL_size_t(1, readings.size());
+    TEST_ASSERT_EQUAL_FLOAT(21.5f, readings[0].value);
+
+    const auto events = storage.getEvents(10);
+    TEST_ASSERT_EQUAL_size_t(1, events.size());
+    TEST_ASSERT_EQUAL_STRING("boot", events[0].detail.c_str());
+}
+
+// --- Write-behind behind reads (LockedDataStorage writeBehindDepth) ------
+
+/// Visitor that, at its first reading, runs `write` on another task while
+/// the read still holds the lock.
+class ConcurrentWriteVisitor : public IReadingVisitor {
+public:
+    explicit ConcurrentWriteVisitor(std::function<void()> write)
+        : write_(std::move(write)) {}
+
+    bool onReading(uint32_t, float) override
+    {
+        if (!started_) {
+            started_ = true;
+            writer_ = std::thread(write_);
+            onWriterStarted();
+        }
+        return true;
+    }
+
+    void join() { writer_.join(); }
+
+protected:
+    /// Default: the writes must not block, so they finish mid-read.
+    virtual void onWriterStarted() { writer_.join(); }
+
+    std::thread writer_;
+
+private:
+    std::function<void()> write_;
+    bool started_ = false;
+};
+
+void test_locked_writes_queue_behind_a_read(void)
+{
+    TempDir dir;
+    LittleFsDataStorage inner(dir.path());
+    LockedDataStorage storage(inner, 8);
+    const std::string metric = "soil_moisture";
+    TEST_ASSERT_TRUE(storage.storeSensorReading(metric, 100, 1.0f));
+
+    bool reading = false;
+    bool event = false;
+    std::size_t samples = 0;
+    bool rejected = false;
+    ConcurrentWriteVisitor visitor([&] {
+        reading = storage.storeSensorReading(metric, 200, 2.0f);
+        event = storage.storeEvent(200, IDataStorage::kCategoryPump, "on");
+        const MetricSample sample{metric::kSoilMoisture, 300, 3.0f};
+        samples = storage.storeSamples(&sample, 1);
+        rejected = storage.storeSensorReading("../escape", 300, 1.0f);
+    });
+    TEST_ASSERT_EQUAL_size_t(1, storage.forEachReading(metric, 0, UINT32_MAX, visitor));
+
+    // Every write returned during the read; none has reached the backend.
+    TEST_ASSERT_TRUE(reading);
+    TEST_ASSERT_TRUE(event);
+    TEST_ASSERT_EQUAL_size_t(1, samples);
+    TEST_ASSERT_TRUE(rejected);  // accepted into the queue, rejected later
+    TEST_ASSERT_EQUAL_size_t(1, inner.getSensorReadings(metric, 0, UINT32_MAX).size());
+    TEST_ASSERT_TRUE(inner.getEvents(10).empty());
+
+    // The watering tick's flushIfDue() applies the queue in order.
+    TEST_ASSERT_TRUE(storage.flushIfDue());
+    const auto readings = storage.getSensorReadings(metric, 0, UINT32_MAX);
+    TEST_ASSERT_EQUAL_size_t(3, readings.size());
+    TEST_ASSERT_EQUAL_UINT32(200, readings[1].epoch);
+    TEST_ASSERT_EQUAL_UINT32(300, readings[2].epoch);
+    TEST_ASSERT_EQUAL_size_t(1, storage.getEvents(10).size());
+
+    const StorageLockStats locks = storage.getStorageStats().locks;
+    TEST_ASSERT_EQUAL_UINT32(4, locks.deferredWrites);
+    TEST_ASSERT_EQUAL_UINT32(1, locks.deferredFailures);
+    TEST_ASSERT_EQUAL_UINT32(0, locks.writerWaits);
+}
+
+/// Keeps the read going briefly after starting the writer, so its write
+/// past the queue bound has to wait for the lock.
+class SlowReadVisitor : public ConcurrentWriteVisitor {
+public:
+    using ConcurrentWriteVisitor::ConcurrentWriteVisitor;
+
+    std::atomic<bool> queued{false};
+
+protected:
+    void onWriterStarted() override
+    {
+        while (!queued.load()) {
+            std::this_thread::yield();
+        }
+        std::this_thread::sleep_for(std::chrono::milliseconds(20));
+    }
+};
+
+void test_locked_write_past_the_queue_waits_in_order(void)
+{
+    TempDir dir;
+    LittleFsDataStorage inner(dir.path());
+    LockedDataStorage storage(inner, 1);
+    const std::string metric = "soil_moisture";
+    TEST_ASSERT_TRUE(storage.storeSensorReading(metric, 100, 1.0f));
+
+    // Unity asserts stay on the test task; the writer only records.
+    bool first = false;
+    bool second = false;
+    SlowReadVisitor* slow = nullptr;
+    SlowReadVisitor visitor([&] {
+        first = storage.storeSensorReading(metric, 200, 2.0f);
+        slow->queued.store(true);
+        second = storage.storeSensorReading(metric, 300, 3.0f);
+    });
+    slow = &visitor;
+    storage.forEachReading(metric, 0, UINT32_MAX, visitor);
+    visitor.join();
+    TEST_ASSERT_TRUE(first);
+    TEST_ASSERT_TRUE(second);
+
+    // The waiting write drained the queued one first: arrival order holds.
+    const auto readings = inner.getSensorReadings(metric, 0, UINT32_MAX);
+    TEST_ASSERT_EQUAL_size_t(3, readings.size());
+    TEST_ASSERT_EQUAL_UINT32(200, readings[1].epoch);
+    TEST_ASSERT_EQUAL_UINT32(300, readings[2].epoch);
+    const StorageLockStats locks = storage.getStorageStats().locks;
+    TEST_ASSERT_EQUAL_UINT32(1, locks.deferredWrites);
+    TEST_ASSERT_TRUE(locks.writerWaits <= 1);
+}
+
+/// A logging pass deferred behind a read is replayed as one batch: under
+/// the row layout it lands as one row, not one row per metric.
+void test_locked_deferred_pass_commits_one_row(void)
+{
+    TempDir dir;
+    LittleFsDataStorage inner(dir.path(), nullptr, rowLayout());
+    LockedDataStorage storage(inner, 16);
+    TEST_ASSERT_TRUE(storage.storeSensorReading("soil_moisture", 100, 1.0f));
+
+    MetricSample pass[10];
+    for (MetricId id = 0; id < 10; ++id) {
+        pass[id] = MetricSample{id, 200, static_cast<float>(id)};
+    }
+    std::size_t stored = 0;
+    ConcurrentWriteVisitor visitor([&] { stored = storage.storeSamples(pass, 10); });
+    storage.forEachReading("soil_moisture", 0, UINT32_MAX, visitor);
+    TEST_ASSERT_EQUAL_size_t(10, stored);
+    TEST_ASSERT_EQUAL_UINT32(10, storage.getStorageStats().locks.deferredWrites);
+
+    TEST_ASSERT_TRUE(storage.flushIfDue());
+    const auto chunks = rowChunks(dir);
+    TEST_ASSERT_EQUAL_size_t(1, chunks.size());
+    TEST_ASSERT_EQUAL_INT(rowBytes(1) + rowBytes(10),
+                          sizeOf(rowsDirOf(dir) + "/" + chunks[0]));
+    for (MetricId id = 0; id < 10; ++id) {
+        const LatestReading latest = storage.latestReading(metric::knownName(id));
+        TEST_ASSERT_TRUE(latest.found);
+        TEST_ASSERT_EQUAL_UINT32(200, latest.epoch);
+    }
+    TEST_ASSERT_EQUAL_UINT32(0, storage.getStorageStats().locks.deferredFailures);
+}
+
+/// A pass deferred behind a read still reaches the backend as one batch,
+/// so with journalBatches it is journaled: one sync, a journal record.
+void test_locked_deferred_pass_is_journaled(void)
+{
+    TempDir dir;
+    LittleFsDataStorage inner(dir.path(), nullptr, journaled());
+    LockedDataStorage storage(inner, 16);
+    TEST_ASSERT_TRUE(storage.storeSensorReading("soil_moisture", 100, 1.0f));
+    TEST_ASSERT_EQUAL_INT(-1, ::access((dir.path() + "/journal").c_str(), F_OK));
+    const uint32_t syncsBefore = storage.getStorageStats().writes.syncs;
+
+    MetricSample pass[10];
+    for (MetricId id = 0; id < 10; ++id) {
+        pass[id] = MetricSample{id, 200, static_cast<float>(id)};
+    }
+    ConcurrentWriteVisitor visitor([&] { storage.storeSamples(pass, 10); });
+    storage.forEachReading("soil_moisture", 0, UINT32_MAX, visitor);
+    TEST_ASSERT_EQUAL_UINT32(10, storage.getStorageStats().locks.deferredWrites);
+
+    TEST_ASSERT_TRUE(storage.flushIfDue());
+    TEST_ASSERT_TRUE(sizeOf(dir.path() + "/journal") > 0);
+    TEST_ASSERT_EQUAL_UINT32(syncsBefore + 1, storage.getStorageStats().writes.syncs);
+    for (MetricId id = 0; id < 10; ++id) {
+        TEST_ASSERT_EQUAL_UINT32(200, storage.latestReading(metric::knownName(id)).epoch);
+    }
+}
+
+/// Without a queue (the default) nothing is deferred: a write issued
+/// during a read lands only after it, as before.
+void test_locked_without_write_behind_never_defers(void)
+{
+    TempDir dir;
+    LittleFsDataStorage inner(dir.path());
+    LockedDataStorage storage(inner);
+    const std::string metric = "soil_moisture";
+    TEST_ASSERT_TRUE(storage.storeSensorReading(metric, 100, 1.0f));
+
+    bool stored = false;
+    SlowReadVisitor* slow = nullptr;
+    SlowReadVisitor visitor([&] {
+        slow->queued.store(true);
+        stored = storage.storeSensorReading(metric, 200, 2.0f);
+    });
+    slow = &visitor;
+    storage.forEachReading(metric, 0, UINT32_MAX, visitor);
+    visitor.join();
+    TEST_ASSERT_TRUE(stored);
+
+    TEST_ASSERT_EQUAL_size_t(2, inner.getSensorReadings(metric, 0, UINT32_MAX).size());
+    const StorageLockStats locks = storage.getStorageStats().locks;
+    TEST_ASSERT_EQUAL_UINT32(0, locks.deferredWrites);
+    TEST_ASSERT_TRUE(locks.writerWaits <= 1);
+}
+
+// --- Offline hold for the deferred mount (LockedDataStorage::runOffline) --
+
+/// Writes issued while the volume mounts queue up to the early depth and
+/// land, in order, once it is up; the rest are refused, never waited on.
+void test_locked_offline_queues_early_writes(void)
+{
+    TempDir dir;
+    LittleFsDataStorage inner(dir.path());
+    LockedDataStorage storage(inner);
+    const std::string metric = "soil_moisture";
+
+    // Unity asserts stay on the test task; the writer only records.
+    bool reading = false;
+    bool event = false;
+    bool refused = true;
+    bool flushed = false;
+    uint32_t droppedMidMount = 0;
+    bool sawOffline = false;
+    storage.runOffline(2, [&] {
+        sawOffline = storage.offline();
+        std::thread writer([&] {
+            reading = storage.storeSensorReading(metric, 100, 1.0f);
+            event = storage.storeEvent(100, IDataStorage::kCategoryPump, "on");
+            refused = storage.storeSensorReading(metric, 200, 2.0f);  // queue full
+            flushed = storage.flushIfDue() && storage.flush();
+            droppedMidMount = storage.getStorageStats().locks.offlineDropped;
+        });
+        writer.join();
+        // Nothing has reached the backend while it mounts.
+        TEST_ASSERT_TRUE(inner.getSensorReadings(metric, 0, UINT32_MAX).empty());
+    });
+    TEST_ASSERT_TRUE(sawOffline);
+    TEST_ASSERT_FALSE(storage.offline());
+    TEST_ASSERT_TRUE(reading);
+    TEST_ASSERT_TRUE(event);
+    TEST_ASSERT_FALSE(refused);
+    TEST_ASSERT_TRUE(flushed);
+    TEST_ASSERT_EQUAL_UINT32(1, droppedMidMount);
+
+    // The queue landed before runOffline() returned.
+    const auto readings = inner.getSensorReadings(metric, 0, UINT32_MAX);
+    TEST_ASSERT_EQUAL_size_t(1, readings.size());
+    TEST_ASSERT_EQUAL_UINT32(100, readings[0].epoch);
+    TEST_ASSERT_EQUAL_size_t(1, inner.getEvents(10).size());
+    const StorageLockStats locks = storage.getStorageStats().locks;
+    TEST_ASSERT_EQUAL_UINT32(2, locks.deferredWrites);
+    TEST_ASSERT_EQUAL_UINT32(1, locks.offlineDropped);
+
+    // Back online, a write goes straight through again.
+    TEST_ASSERT_TRUE(storage.storeSensorReading(metric, 300, 3.0f));
+    TEST_ASSERT_EQUAL_size_t(2, inner.getSensorReadings(metric, 0, UINT32_MAX).size());
+}
+
+// --- Legacy history import (storage/LegacyHistoryImport.h) ---------------
+
+constexpr uint32_t kLegacyStart = 1700000000u;
+
+/// A legacy LittleFSStorage array of `count` readings, 5 min apart from
+/// kLegacyStart (value = index), written as ArduinoJson serialized it.
+void writeLegacyFile(const std::string& path, std::size_t count, const char* extra = "")
+{
+    FILE* file = std::fopen(path.c_str(), "w");
+    TEST_ASSERT_NOT_NULL(file);
+    std::fputs("[", file);
+    for (std::size_t i = 0; i < count; ++i) {
+        std::fprintf(file, "%s{\"timestamp\":%u,\"value\":%u.5}", i == 0 ? "" : ",",
+                     static_cast<unsigned>(kLegacyStart + 300 * i), static_cast<unsigned>(i));
+    }
+    std::fputs(extra, file);
+    std::fputs("]", file);
+    std::fclose(file);
+}
+
+/// A unit's worth of history lands as whole chunks, one sync each; the
+/// file is renamed once done and a later run finds nothing to import.
+void test_legacy_import_writes_whole_chunks(void)
+{
+    TempDir dir;
+    const std::string legacyDir = dir.path() + "/data";
+    TEST_ASSERT_EQUAL_INT(0, ::mkdir(legacyDir.c_str(), 0775));
+    writeLegacyFile(legacyDir + "/soil_moisture.json", 2500,
+                    ",{\"timestamp\":1712000000,\"value\":null},{\"timestamp\":4000,\"value\":1}");
+    writeLegacyFile(legacyDir + "/config_backup.json", 3);  // no known metric
+
+    LittleFsDataStorage storage(dir.path());
+    const legacy::ImportStats stats = legacy::importHistory(legacyDir, storage);
+    TEST_ASSERT_EQUAL_size_t(1, stats.files);
+    TEST_ASSERT_EQUAL_size_t(0, stats.failed);
+    TEST_ASSERT_EQUAL_size_t(1, stats.ignored);
+    TEST_ASSERT_EQUAL_size_t(2500, stats.points);
+    TEST_ASSERT_EQUAL_size_t(3, stats.chunks);   // 1024 + 1024 + 452
+    TEST_ASSERT_EQUAL_size_t(2, stats.skipped);  // null value, pre-NTP stamp
+    TEST_ASSERT_EQUAL_UINT32(3, storage.getStorageStats().writes.syncs);
+
+    const auto readings = storage.getSensorReadings("soil_moisture", 0, UINT32_MAX);
+    TEST_ASSERT_EQUAL_size_t(2500, readings.size());
+    TEST_ASSERT_EQUAL_UINT32(kLegacyStart, readings.front().epoch);
+    TEST_ASSERT_EQUAL_UINT32(kLegacyStart + 300 * 2499, readings.back().epoch);
+    TEST_ASSERT_EQUAL_FLOAT(2499.5f, readings.back().value);
+    TEST_ASSERT_EQUAL_size_t(3, listDir(metricDirOf(dir, "soil_moisture")).size());
+    TEST_ASSERT_TRUE(::access((legacyDir + "/soil_moisture.json").c_str(), F_OK) != 0);
+    TEST_ASSERT_TRUE(sizeOf(legacyDir + "/soil_moisture.json.imported") > 0);
+
+    // New readings append after the imported history as usual.
+    TEST_ASSERT_TRUE(storage.storeSensorReading("soil_moisture", kLegacyStart + 300 * 2500, 1.0f));
+    TEST_ASSERT_EQUAL_size_t(2501,
+                             storage.getSensorReadings("soil_moisture", 0, UINT32_MAX).size());
+    TEST_ASSERT_EQUAL_size_t(0, legacy::importHistory(legacyDir, storage).files);
+}
+
+/// An interrupted run is re-run: chunks already written are stepped over,
+/// and legacy readings never overlap history the unit recorded since.
+void test_legacy_import_resumes_below_native_history(void)
+{
+    TempDir dir;
+    const std::string legacyDir = dir.path() + "/data";
+    TEST_ASSERT_EQUAL_INT(0, ::mkdir(legacyDir.c_str(), 0775));
+    writeLegacyFile(legacyDir + "/env_pressure.json", 2500);
+
+    LittleFsDataStorage storage(dir.path());
+    // Recorded by the new firmware from reading 2000 on, past the legacy end.
+    const uint32_t nativeStart = kLegacyStart + 300 * 2000;
+    TEST_ASSERT_TRUE(storage.storeSensorReading("env_pressure", nativeStart, -1.0f));
+    TEST_ASSERT_TRUE(storage.storeSensorReading("env_pressure", nativeStart + 300 * 1000, -2.0f));
+    // The first chunk of an earlier run, cut short after it.
+    std::vector<HistoryPoint> first(legacy::kBatchPoints);
+    for (std::size_t i = 0; i < first.size(); ++i) {
+        first[i] = HistoryPoint{static_cast<uint32_t>(kLegacyStart + 300 * i),
+                                static_cast<float>(i) + 0.5f};
+    }
+    const HistoryImport cut = storage.importHistory("env_pressure", first.data(), first.size());
+    TEST_ASSERT_TRUE(cut.ok);
+    TEST_ASSERT_EQUAL_size_t(first.size(), cut.written);
+
+    const legacy::ImportStats stats = legacy::importHistory(legacyDir, storage);
+    TEST_ASSERT_EQUAL_size_t(1, stats.files);
+    TEST_ASSERT_EQUAL_size_t(1, stats.resumed);
+    TEST_ASSERT_EQUAL_size_t(1, stats.chunks);
+    TEST_ASSERT_EQUAL_size_t(2000 - first.size(), stats.points);
+    TEST_ASSERT_EQUAL_size_t(500, stats.skipped);  // at or past the native start
+
+    const auto readings = storage.getSensorReadings("env_pressure", 0, UINT32_MAX);
+    TEST_ASSERT_EQUAL_size_t(2002, readings.size());
+    for (std::size_t i = 1; i < readings.size(); ++i) {
+        TEST_ASSERT_TRUE(readings[i - 1].epoch < readings[i].epoch);
+    }
+    TEST_ASSERT_EQUAL_FLOAT(1999.5f, readings[1999].value);
+    TEST_ASSERT_EQUAL_FLOAT(-1.0f, readings[2000].value);
+}
+
+// --- Heap allocations on the steady-state paths (alloc_tracker.h) -------
+// The storage task runs for months: once its tables exist, an append must
+// not touch the heap, and a streamed read's allocations must follow the
+// chunks it opens, never the readings it visits.
+
+/// Counts readings; holds nothing.
+struct CountingVisitor final : IReadingVisitor {
+    std::size_t seen = 0;
+    bool onReading(uint32_t, float) override
+    {
+        ++seen;
+        return true;
+    }
+};
+
+void test_cached_appends_do_not_allocate(void)
+{
+    TempDir dir;
+    LittleFsDataStorageOptions options = cachedIndex();
+    options.cacheEventTail = true;
+    LittleFsDataStorage storage(dir.path(), nullptr, options);
+    const std::string metric = "soil_moisture";
+    // The first append of each kind builds the directories and caches.
+    TEST_ASSERT_TRUE(storage.storeSensorReading(metric, 1000, 1.0f));
+    TEST_ASSERT_TRUE(storage.storeEvent(1000, 1, "boot"));
+
+    std::size_t failures = 0;
+    EXPECT_NO_ALLOC {
+        for (uint32_t i = 1; i <= 100; ++i) {
+            failures += storage.storeSensorReading(metric, 1000 + i, 1.0f) ? 0 : 1;
+            failures += storage.storeEvent(1000 + i, 1, "pump started") ? 0 : 1;
+        }
+    }
+    TEST_ASSERT_EQUAL_size_t(0, failures);
+    TEST_ASSERT_EQUAL_size_t(101, storage.getSensorReadings(metric, 0, UINT32_MAX).size());
+}
+
+void test_group_commit_buffering_does_not_allocate(void)
+{
+    TempDir dir;
+    FakeTimeProvider clock;
+    constexpr std::size_t kMaxRecords = 16;
+    LittleFsDataStorageOptions options = groupCommit(clock, kMaxRecords);
+    options.cacheChunkIndex = true;
+    LittleFsDataStorage storage(dir.path(), nullptr, options);
+    const std::string metric = "soil_moisture";
+    // One full buffer commits and leaves the buffer at its capacity.
+    appendSeries(storage, metric, 1000, kMaxRecords, 1);
+
+    std::size_t failures = 0;
+    EXPECT_NO_ALLOC {
+        for (uint32_t i = 0; i < kMaxRecords - 1; ++i) {
+            failures += storage.storeSensorReading(metric, 2000 + i, 1.0f) ? 0 : 1;
+        }
+    }
+    TEST_ASSERT_EQUAL_size_t(0, failures);
+    TEST_ASSERT_EQUAL_size_t(kMaxRecords, static_cast<std::size_t>(
+                                              committedBytes(dir, metric) /
+                                              LittleFsDataStorage::kHistoryRecordBytes));
+}
+
+void test_streamed_read_allocations_follow_chunks_not_readings(void)
+{
+    TempDir dir;
+    LittleFsDataStorage storage(dir.path(), nullptr, cachedIndex());
+    const std::string metric = "soil_moisture";
+    appendSeries(storage, metric, 1000, kMetricCapacity, 1);
+
+    // Budget: a fixed setup (the chunk list) plus a few names and a file
+    // per chunk opened; one per reading would be thousands.
+    constexpr std::size_t kSetup = 12;
+    constexpr std::size_t kPerChunk = 6;
+
+    // A full ring: every chunk opened, 10240 readings visited.
+    CountingVisitor all;
+    EXPECT_ALLOCS_AT_MOST(kSetup + kPerChunk * LittleFsDataStorage::kHistoryMaxChunksPerMetric)
+    {
+        storage.forEachReading(metric, 0, UINT32_MAX, all);
+    }
+    TEST_ASSERT_EQUAL_size_t(kMetricCapacity, all.seen);
+
+    // The newest 300 readings: one chunk.
+    CountingVisitor tail;
+    EXPECT_ALLOCS_AT_MOST(kSetup + kPerChunk)
+    {
+        storage.forEachReading(metric, 1000 + kMetricCapacity - 300, UINT32_MAX, tail);
+    }
+    TEST_ASSERT_EQUAL_size_t(300, tail.seen);
 }
 
 }  // namespace
@@ -956,11 +4653,128 @@ void run_data_storage_tests(void)
     RUN_TEST(test_unknown_event_category_passthrough);
     RUN_TEST(test_event_rotation_drops_oldest_never_newest);
     RUN_TEST(test_event_burst_stays_within_budget);
+    RUN_TEST(test_event_segments_follow_the_budget);
     RUN_TEST(test_event_torn_tail_skipped_and_repaired);
     RUN_TEST(test_event_torn_detail_length_mismatch_skipped);
     RUN_TEST(test_event_active_file_detected_after_restart);
     RUN_TEST(test_mock_event_bound_and_category_passthrough);
+    // Chunk-index cache — memoized append path stays file-equivalent.
+    RUN_TEST(test_chunk_cache_matches_stateless_layout);
+    RUN_TEST(test_chunk_cache_rebuilt_after_restart);
+    RUN_TEST(test_chunk_cache_recovers_from_external_change);
+    RUN_TEST(test_chunk_cache_keeps_metric_cap);
+    // Group commit — bounded write-behind for sensor history.
+    RUN_TEST(test_group_commit_buffers_until_deadline);
+    RUN_TEST(test_group_commit_bounded_by_record_count);
+    RUN_TEST(test_group_commit_flush_and_restart);
+    RUN_TEST(test_group_commit_seals_chunks_like_durable_path);
+    RUN_TEST(test_group_commit_keeps_metric_cap_and_event_durability);
+    // Batch append — one call per logging pass.
+    RUN_TEST(test_batch_append_matches_single_appends);
+    RUN_TEST(test_batch_append_rejects_per_reading);
+    RUN_TEST(test_batch_append_under_group_commit);
+    // Row layout — one multi-metric record per logging pass.
+    RUN_TEST(test_row_layout_round_trip);
+    RUN_TEST(test_row_layout_seals_and_evicts);
+    RUN_TEST(test_row_layout_torn_tails_repaired);
+    RUN_TEST(test_row_layout_keeps_metric_cap);
+    RUN_TEST(test_row_layout_under_group_commit);
+    RUN_TEST(test_mux_layout_round_trip_past_the_row_cap);
+    RUN_TEST(test_mux_layout_skips_chunks_without_the_metric);
+    RUN_TEST(test_mux_layout_torn_tails_repaired);
+    RUN_TEST(test_mux_layout_under_group_commit);
+    RUN_TEST(test_chunk_summaries_match_the_records);
+    RUN_TEST(test_chunk_summaries_stand_in_for_sealed_chunks);
+    RUN_TEST(test_chunk_summaries_leave_with_their_chunks);
+    // Sparse range queries — skip chunks outside [t0, t1].
+    RUN_TEST(test_range_query_skips_chunks_outside_window);
+    RUN_TEST(test_backwards_epoch_falls_back_to_full_scan);
+    // Rollup tiers — bucketed history from finished-bucket rings.
+    RUN_TEST(test_aggregate_default_buckets_raw_readings);
+    RUN_TEST(test_rollup_tiers_hold_finished_buckets);
+    RUN_TEST(test_rollup_backfills_and_survives_restart);
+    RUN_TEST(test_rollup_rings_stay_bounded);
+    // Quantile sketches — mergeable percentiles with the hour/day tiers.
+    RUN_TEST(test_quantile_sketch_estimates_and_merges);
+    RUN_TEST(test_quantile_sketches_follow_hour_and_day_buckets);
+    RUN_TEST(test_quantile_sketches_start_at_the_next_boundary);
+    // Delta codec — compressed per-metric chunks.
+    RUN_TEST(test_delta_codec_frames_round_trip);
+    RUN_TEST(test_delta_chunks_hold_several_times_the_history);
+    RUN_TEST(test_delta_chunks_seal_evict_and_match_stateless);
+    RUN_TEST(test_delta_chunk_torn_frame_repaired);
+    RUN_TEST(test_codec_switch_keeps_existing_chunks);
+    // Background maintenance — recompaction and rollups off the append path.
+    RUN_TEST(test_maintenance_recompacts_sealed_fixed_chunks);
+    RUN_TEST(test_maintenance_finishes_an_interrupted_recompaction);
+    RUN_TEST(test_maintenance_takes_over_rollup_updates);
+    // Streaming reads — history visited without a vector per call.
+    RUN_TEST(test_for_each_reading_streams_every_layout);
+    RUN_TEST(test_for_each_reading_includes_buffered_and_mock);
+    // Event-tail cache — event appends without re-parsing the log.
+    RUN_TEST(test_event_tail_cache_matches_stateless);
+    RUN_TEST(test_event_tail_cache_revalidated_against_files);
+    // Tail-first event reads — getEvents(n) cost follows n, not the log.
+    RUN_TEST(test_get_events_reads_only_the_tail);
+    RUN_TEST(test_get_events_reads_legacy_and_mixed_files);
+    RUN_TEST(test_legacy_event_files_removed_when_ring_wraps);
+    RUN_TEST(test_events_read_across_block_boundaries);
+    // Event queries — category/window filters and cursor paging.
+    RUN_TEST(test_query_events_filters_category_and_window);
+    RUN_TEST(test_query_events_pages_through_cursors);
+    RUN_TEST(test_query_events_default_matches_file_backed);
+    // Metric ids — appends keyed by MetricId instead of name.
+    RUN_TEST(test_metric_registry_known_table_and_bound);
+    RUN_TEST(test_store_samples_writes_what_named_stores_write);
+    RUN_TEST(test_store_samples_rejects_unknown_ids_individually);
+    // Stats cache — usage tallied from writes, provider resynced on a timer.
+    RUN_TEST(test_storage_stats_cached_and_tallied);
+    RUN_TEST(test_storage_stats_cache_off_and_failing_provider);
+    // Decoded-chunk cache — sealed chunks from RAM, active chunk extended.
+    RUN_TEST(test_chunk_cache_reads_match_uncached);
+    RUN_TEST(test_chunk_cache_skips_sealed_io_and_follows_the_active_chunk);
+    RUN_TEST(test_chunk_cache_stays_within_its_budget);
+    RUN_TEST(test_block_reads_cover_every_record_offset);
+    // Window stats — count/min/max/mean/last in one streaming pass.
+    RUN_TEST(test_window_stats_fold_the_range_in_one_pass);
+    RUN_TEST(test_window_stats_mean_holds_over_a_month);
+    RUN_TEST(test_recent_ring_reads_match_flash);
+    RUN_TEST(test_recent_ring_serves_covered_windows_from_ram);
+    RUN_TEST(test_recent_ring_retires_on_a_backwards_epoch);
+    RUN_TEST(test_latest_readings_are_the_window_tail);
+    RUN_TEST(test_latest_readings_stop_at_the_newest_chunk);
+    RUN_TEST(test_retention_rules_parse);
+    RUN_TEST(test_retention_plan_splits_the_budget);
+    RUN_TEST(test_retention_plan_sizes_each_metric_ring);
+    // Write accounting — appends, syncs, files, repairs and latency.
+    RUN_TEST(test_write_stats_count_appends_syncs_and_files);
+    RUN_TEST(test_write_stats_count_torn_repairs_and_group_commits);
+    // Batch journal — one sync per pass, a cut pass replayed.
+    RUN_TEST(test_journaled_batch_syncs_once);
+    RUN_TEST(test_journal_replays_a_pass_cut_short);
+    RUN_TEST(test_journal_outlived_by_later_appends_adds_nothing);
+    RUN_TEST(test_journal_torn_record_is_discarded);
+    // Writer queue — writes copied into a bounded queue, applied later.
+    RUN_TEST(test_queued_writes_return_before_the_backend_sees_them);
+    RUN_TEST(test_queued_reads_and_drain_apply_the_queue_first);
+    RUN_TEST(test_queued_flush_if_due_is_polled_by_the_writer);
+    RUN_TEST(test_queued_identical_events_coalesce);
     // T028 — Locked* decorator (FR-013).
     RUN_TEST(test_locked_data_storage_delegates_full_contract);
     RUN_TEST(test_locked_data_storage_over_real_storage);
+    // Write-behind — writes queue behind a read instead of waiting.
+    RUN_TEST(test_locked_writes_queue_behind_a_read);
+    RUN_TEST(test_locked_write_past_the_queue_waits_in_order);
+    RUN_TEST(test_locked_deferred_pass_commits_one_row);
+    RUN_TEST(test_locked_deferred_pass_is_journaled);
+    RUN_TEST(test_locked_without_write_behind_never_defers);
+    // Offline hold — writes queue while the volume mounts.
+    RUN_TEST(test_locked_offline_queues_early_writes);
+    // Legacy import — whole chunks, resumable, below native history.
+    RUN_TEST(test_legacy_import_writes_whole_chunks);
+    RUN_TEST(test_legacy_import_resumes_below_native_history);
+    // Heap allocations — none on a warm append, per chunk on a read.
+    RUN_TEST(test_cached_appends_do_not_allocate);
+    RUN_TEST(test_group_commit_buffering_does_not_allocate);
+    RUN_TEST(test_streamed_read_allocations_follow_chunks_not_readings);
 }
@@ -0,0 +1,224 @@
+// SPDX-FileCopyrightText: 2026 Cryptotomte
+// SPDX-License-Identifier: AGPL-3.0-or-later
+/**
+ * @file test_decision_trace.cpp
+ * @brief Host suite for the controller decision trace (DecisionTrace), its
+ *        use by WateringController and the /control/trace body.
+ *
+ * Registered by test_main.cpp via run_decision_trace_tests(). The ring
+ * numbers records from 1, reads them oldest first past a cursor and skips
+ * what it has overwritten; a traced controller leaves one record per tick
+ * naming the gate that decided it (dry, running, high, soak, stale, ...)
+ * and the action, with the thresholds and the soak pause left; the
+ * streamed body carries the records by name with a resume cursor.
+ */
+
+#include <cstdint>
+#include <string>
+
+#include "unity.h"
+
+#include "actuators/testing/FakeTimeProvider.h"
+#include "actuators/testing/MockWaterPump.h"
+#include "api/ApiStream.h"
+#include "control/DecisionTrace.h"
+#include "control/WateringController.h"
+#include "events/EventLogger.h"
+#include "sensors/testing/MockEnvironmentalSensor.h"
+#include "sensors/testing/MockSoilSensor.h"
+#include "storage/testing/MockConfigStore.h"
+#include "storage/testing/MockDataStorage.h"
+#include "time/testing/FakeWallClock.h"
+
+namespace {
+
+DecisionRecord recordAt(int64_t atMs)
+{
+    DecisionRecord rec;
+    rec.atMs = atMs;
+    return rec;
+}
+
+void test_ring_reads_oldest_first_past_a_cursor(void)
+{
+    DecisionTrace trace;
+    DecisionRecord out[DecisionTrace::kCapacity];
+    TEST_ASSERT_EQUAL_size_t(0, trace.read(out, DecisionTrace::kCapacity));
+
+    for (int i = 1; i <= 5; ++i) {
+        trace.record(recordAt(i * 1000));
+    }
+    TEST_ASSERT_EQUAL_UINT32(5, trace.written());
+    TEST_ASSERT_EQUAL_size_t(5, trace.read(out, DecisionTrace::kCapacity));
+    TEST_ASSERT_EQUAL_UINT32(1, out[0].sequence);
+    TEST_ASSERT_TRUE(out[4].atMs == 5000);
+
+    // Past a cursor, and bounded by max.
+    TEST_ASSERT_EQUAL_size_t(2, trace.read(out, 2, 2));
+    TEST_ASSERT_EQUAL_UINT32(3, out[0].sequence);
+    TEST_ASSERT_EQUAL_UINT32(4, out[1].sequence);
+    TEST_ASSERT_EQUAL_size_t(0, trace.read(out, DecisionTrace::kCapacity, 5));
+}
+
+void test_ring_skips_overwritten_records(void)
+{
+    DecisionTrace trace;
+    const uint32_t total = DecisionTrace::kCapacity + 10;
+    for (uint32_t i = 1; i <= total; ++i) {
+        trace.record(recordAt(i));
+    }
+    DecisionRecord out[DecisionTrace::kCapacity];
+    // A stale cursor resumes at the oldest record still held.
+    TEST_ASSERT_EQUAL_size_t(DecisionTrace::kCapacity,
+                             trace.read(out, DecisionTrace::kCapacity, 3));
+    TEST_ASSERT_EQUAL_UINT32(11, out[0].sequence);
+    TEST_ASSERT_EQUAL_UINT32(total, out[DecisionTrace::kCapacity - 1].sequence);
+}
+
+/// One traced zone (low 30 %, high 55 %, burst 60 s, soak 300 s).
+struct Fixture {
+    FakeTimeProvider clock;
+    MockEnvironmentalSensor env;
+    MockConfigStore config;
+    MockDataStorage storage;
+    FakeWallClock wallClock;
+    EventLogger events{storage, wallClock};
+    MockSoilSensor soil;
+    MockWaterPump pump{"plant", clock};
+    WateringController controller{soil, env, pump, config, storage,
+                                  clock, wallClock, events};
+    DecisionTrace trace;
+
+    Fixture()
+    {
+        config.stored.moistureThresholdLow = 30.0f;
+        config.stored.moistureThresholdHigh = 55.0f;
+        config.stored.wateringDurationS = 60;
+        config.stored.minWateringIntervalS = 300;
+        config.stored.wateringEnabled = 1;
+        TEST_ASSERT_TRUE(pump.initialize());
+        soil.readResult = true;
+        soil.isAvailableResult = true;
+        soil.moisture = 20.0f;
+        controller.setTrace(trace, 2);
+    }
+
+    /// The newest record.
+    DecisionRecord last()
+    {
+        DecisionRecord rec;
+        TEST_ASSERT_EQUAL_size_t(1, trace.read(&rec, 1, trace.written() - 1));
+        return rec;
+    }
+};
+
+void test_controller_records_gate_and_action(void)
+{
+    Fixture f;
+    f.controller.tick();
+    DecisionRecord rec = f.last();
+    TEST_ASSERT_EQUAL_UINT32(1, rec.sequence);
+    TEST_ASSERT_TRUE(rec.gate == DecisionGate::Dry);
+    TEST_ASSERT_TRUE(rec.action == DecisionAction::StartBurst);
+    TEST_ASSERT_EQUAL_UINT16(60, rec.burstS);
+    TEST_ASSERT_EQUAL_UINT8(2, rec.zone);
+    TEST_ASSERT_EQUAL_FLOAT(20.0f, rec.moisture);
+    TEST_ASSERT_EQUAL_FLOAT(30.0f, rec.low);
+    TEST_ASSERT_EQUAL_FLOAT(55.0f, rec.high);
+    TEST_ASSERT_EQUAL_UINT8(DecisionRecord::kFresh | DecisionRecord::kPumpOn, rec.flags);
+
+    f.clock.advance(5000);
+    f.controller.tick();
+    TEST_ASSERT_TRUE(f.last().gate == DecisionGate::Running);
+    TEST_ASSERT_TRUE(f.last().action == DecisionAction::None);
+
+    f.soil.moisture = 56.0f;
+    f.clock.advance(5000);
+    f.controller.tick();
+    rec = f.last();
+    TEST_ASSERT_TRUE(rec.gate == DecisionGate::High);
+    TEST_ASSERT_TRUE(rec.action == DecisionAction::StopHigh);
+    TEST_ASSERT_EQUAL_UINT32(300'000, rec.soakLeftMs);
+    TEST_ASSERT_EQUAL_UINT8(DecisionRecord::kFresh, rec.flags);
+
+    // Dry again inside the soak pause: the soak gate holds it back.
+    f.soil.moisture = 25.0f;
+    f.clock.advance(10'000);
+    f.controller.tick();
+    rec = f.last();
+    TEST_ASSERT_TRUE(rec.gate == DecisionGate::Soak);
+    TEST_ASSERT_TRUE(rec.action == DecisionAction::None);
+    TEST_ASSERT_EQUAL_UINT32(290'000, rec.soakLeftMs);
+}
+
+void test_controller_records_failsafe_stop(void)
+{
+    Fixture f;
+    f.controller.tick();
+    TEST_ASSERT_TRUE(f.pump.isRunning());
+
+    f.soil.readResult = false;
+    f.clock.advance(WateringController::kStalenessMs + 1000);
+    f.controller.tick();
+    const DecisionRecord rec = f.last();
+    TEST_ASSERT_TRUE(rec.gate == DecisionGate::Stale);
+    TEST_ASSERT_TRUE(rec.action == DecisionAction::StopFailsafe);
+    TEST_ASSERT_EQUAL_UINT8(0, rec.flags);
+    TEST_ASSERT_EQUAL_UINT32(2, f.trace.written());
+}
+
+struct StringSink final : api::IChunkSink {
+    std::string body;
+
+    bool send(const char* data, std::size_t len) override
+    {
+        body.append(data, len);
+        return true;
+    }
+};
+
+void test_stream_body_names_the_records(void)
+{
+    DecisionTrace trace;
+    DecisionRecord rec;
+    rec.atMs = 5000;
+    rec.epoch = 1'780'290'000;
+    rec.moisture = 27.5f;
+    rec.low = 30.0f;
+    rec.high = 55.0f;
+    rec.burstS = 30;
+    rec.gate = DecisionGate::Dry;
+    rec.action = DecisionAction::StartBurst;
+    rec.flags = DecisionRecord::kFresh | DecisionRecord::kPumpOn;
+    trace.record(rec);
+    rec.gate = DecisionGate::Soak;
+    rec.action = DecisionAction::None;
+    trace.record(rec);
+
+    StringSink sink;
+    TEST_ASSERT_TRUE(api::streamDecisionTrace(trace, 1, sink));
+    TEST_ASSERT_EQUAL_STRING(
+        "{\"success\":true,\"written\":2,\"records\":[{\"seq\":2,\"atMs\":5000,"
+        "\"epoch\":1780290000,\"zone\":0,\"moisture\":27.5,\"low\":30,\"high\":55,"
+        "\"soakLeftMs\":0,\"burstS\":30,\"gate\":\"soak\",\"action\":\"none\","
+        "\"fresh\":true,\"pumpOn\":true,\"burstEnded\":false}],\"next\":2}",
+        sink.body.c_str());
+
+    // Nothing newer: an empty page that keeps the cursor.
+    StringSink empty;
+    TEST_ASSERT_TRUE(api::streamDecisionTrace(trace, 2, empty));
+    TEST_ASSERT_EQUAL_STRING(
+        "{\"success\":true,\"written\":2,\"records\":[],\"next\":2}",
+        empty.body.c_str());
+}
+
+}  // namespace
+
+void run_decision_trace_tests(void)
+{
+    RUN_TEST(test_ring_reads_oldest_first_past_a_cursor);
+    RUN_TEST(test_ring_skips_overwritten_records);
+    RUN_TEST(test_controller_records_gate_and_action);
+    RUN_TEST(test_controller_records_failsafe_stop);
+    RUN_TEST(test_stream_body_names_the_records);
+}
@@ -0,0 +1,295 @@
+// SPDX-FileCopyrightText: 2026 Cryptotomte
+// SPDX-License-Identifier: AGPL-3.0-or-later
+/**
+ * @file test_deflate.cpp
+ * @brief Host suite for the streaming response compressor (Deflate.h).
+ *
+ * The checksums match their reference values; a gzip and a zlib stream
+ * round-trip through a small fixed-Huffman inflater written here (the same
+ * bytes whether the input came in one piece or byte by byte, with matches
+ * reaching across a window slide), with correct headers and trailers, and
+ * a repetitive JSON body shrinks; Accept-Encoding negotiation honours
+ * names, q-values and `*`.
+ */
+
+#include <cstdint>
+#include <string>
+
+#include "unity.h"
+
+#include "api/Deflate.h"
+
+namespace {
+
+using api::ContentEncoding;
+
+class StringSink final : public api::IChunkSink {
+public:
+    bool send(const char* data, std::size_t len) override
+    {
+        body.append(data, len);
+        return true;
+    }
+    std::string body;
+};
+
+/// LSB-first bit reader over a deflate stream.
+class BitReader {
+public:
+    BitReader(const std::string& data, std::size_t pos) : data_(data), pos_(pos) {}
+
+    uint32_t bits(unsigned count)
+    {
+        uint32_t v = 0;
+        for (unsigned i = 0; i < count; ++i) {
+            v |= static_cast<uint32_t>(bit()) << i;
+        }
+        return v;
+    }
+
+    /// A Huffman code, MSB first, @p count bits.
+    uint32_t code(unsigned count)
+    {
+        uint32_t v = 0;
+        for (unsigned i = 0; i < count; ++i) {
+            v = (v << 1) | bit();
+        }
+        return v;
+    }
+
+    bool overrun() const { return overrun_; }
+    /// Byte offset after the (padded) current byte.
+    std::size_t byteEnd() const { return pos_ + (bit_ != 0 ? 1 : 0); }
+
+private:
+    unsigned bit()
+    {
+        if (pos_ >= data_.size()) {
+            overrun_ = true;
+            return 0;
+        }
+        const unsigned b = (static_cast<uint8_t>(data_[pos_]) >> bit_) & 1u;
+        if (++bit_ == 8) {
+            bit_ = 0;
+            ++pos_;
+        }
+        return b;
+    }
+
+    const std::string& data_;
+    std::size_t pos_;
+    unsigned bit_ = 0;
+    bool overrun_ = false;
+};
+
+/// Inflate a fixed-Huffman-only deflate stream at @p pos; false on any
+/// other block type or a bad code. @p end receives the byte after it.
+bool inflateFixed(const std::string& data, std::size_t pos, std::string& out,
+                  std::size_t& end)
+{
+    static const uint16_t kLenBase[29] = {3,  4,  5,  6,  7,  8,  9,  10,  11,  13,
+                                          15, 17, 19, 23, 27, 31, 35, 43,  51,  59,
+                                          67, 83, 99, 115, 131, 163, 195, 227, 258};
+    static const uint8_t kLenExtra[29] = {0, 0, 0, 0, 0, 0, 0, 0, 1, 1, 1, 1, 2, 2, 2,
+                                          2, 3, 3, 3, 3, 4, 4, 4, 4, 5, 5, 5, 5, 0};
+    static const uint16_t kDistBase[30] = {1,    2,    3,    4,    5,    7,     9,     13,
+                                           17,   25,   33,   49,   65,   97,    129,   193,
+                                           257,  385,  513,  769,  1025, 1537,  2049,  3073,
+                                           4097, 6145, 8193, 12289, 16385, 24577};
+    static const uint8_t kDistExtra[30] = {0, 0, 0, 0, 1, 1, 2, 2,  3,  3,  4,  4,  5,  5,  6,
+                                           6, 7, 7, 8, 8, 9, 9, 10, 10, 11, 11, 12, 12, 13, 13};
+    BitReader in(data, pos);
+    bool last = false;
+    while (!last) {
+        last = in.bits(1) == 1;
+        if (in.bits(2) != 1) {
+            return false;
+        }
+        for (;;) {
+            uint32_t code = in.code(7);
+            uint32_t symbol;
+            if (code <= 0x17) {
+                symbol = 256 + code;
+            } else {
+                code = (code << 1) | in.code(1);
+                if (code >= 0x30 && code <= 0xBF) {
+                    symbol = code - 0x30;
+                } else if (code >= 0xC0 && code <= 0xC7) {
+                    symbol = 280 + (code - 0xC0);
+                } else {
+                    code = (code << 1) | in.code(1);
+                    if (code < 0x190 || code > 0x1FF) {
+                        return false;
+                    }
+                    symbol = 144 + (code - 0x190);
+                }
+            }
+            if (in.overrun()) {
+                return false;
+            }
+            if (symbol < 256) {
+                out += static_cast<char>(symbol);
+                continue;
+            }
+            if (symbol == 256) {
+                break;
+            }
+            if (symbol > 285) {
+                return false;
+            }
+            const std::size_t li = symbol - 257;
+            const std::size_t length = kLenBase[li] + in.bits(kLenExtra[li]);
+            const uint32_t dcode = in.code(5);
+            if (dcode >= 30) {
+                return false;
+            }
+            const std::size_t distance = kDistBase[dcode] + in.bits(kDistExtra[dcode]);
+            if (distance > out.size()) {
+                return false;
+            }
+            for (std::size_t i = 0; i < length; ++i) {
+                out += out[out.size() - distance];
+            }
+        }
+    }
+    end = in.byteEnd();
+    return !in.overrun();
+}
+
+uint32_t le32(const std::string& s, std::size_t at)
+{
+    return static_cast<uint32_t>(static_cast<uint8_t>(s[at])) |
+           static_cast<uint32_t>(static_cast<uint8_t>(s[at + 1])) << 8 |
+           static_cast<uint32_t>(static_cast<uint8_t>(s[at + 2])) << 16 |
+           static_cast<uint32_t>(static_cast<uint8_t>(s[at + 3])) << 24;
+}
+
+uint32_t be32(const std::string& s, std::size_t at)
+{
+    return static_cast<uint32_t>(static_cast<uint8_t>(s[at])) << 24 |
+           static_cast<uint32_t>(static_cast<uint8_t>(s[at + 1])) << 16 |
+           static_cast<uint32_t>(static_cast<uint8_t>(s[at + 2])) << 8 |
+           static_cast<uint32_t>(static_cast<uint8_t>(s[at + 3]));
+}
+
+/// A /history-like body: long, repetitive, with some variation.
+std::string sampleBody()
+{
+    std::string body = "{\"success\":true,\"data\":{\"metric\":\"soil_humidity\",\"points\":[";
+    for (int i = 0; i < 600; ++i) {
+        body += (i == 0 ? "" : ",");
+        body += "{\"t\":" + std::to_string(1760000000 + i * 60) +
+                ",\"v\":" + std::to_string(40 + (i * 7) % 13) + "." +
+                std::to_string(i % 10) + "}";
+    }
+    body += "]}}";
+    return body;
+}
+
+std::string compress(const std::string& input, ContentEncoding encoding, bool byteByByte)
+{
+    StringSink sink;
+    api::DeflateSink deflate(sink, encoding);
+    if (byteByByte) {
+        for (char c : input) {
+            TEST_ASSERT_TRUE(deflate.send(&c, 1));
+        }
+    } else {
+        TEST_ASSERT_TRUE(deflate.send(input.data(), input.size()));
+    }
+    TEST_ASSERT_TRUE(deflate.finish());
+    TEST_ASSERT_EQUAL_UINT32(input.size(), deflate.inputBytes());
+    return sink.body;
+}
+
+void test_checksum_reference_values()
+{
+    TEST_ASSERT_EQUAL_HEX32(0xCBF43926u, api::crc32Update(0, "123456789", 9));
+    TEST_ASSERT_EQUAL_HEX32(0xCBF43926u,
+                            api::crc32Update(api::crc32Update(0, "1234", 4), "56789", 5));
+    TEST_ASSERT_EQUAL_HEX32(0x11E60398u, api::adler32Update(1, "Wikipedia", 9));
+    TEST_ASSERT_EQUAL_HEX32(0u, api::crc32Update(0, "", 0));
+}
+
+void test_gzip_round_trip()
+{
+    const std::string body = sampleBody();
+    const std::string gz = compress(body, ContentEncoding::Gzip, false);
+
+    TEST_ASSERT_TRUE(gz.size() > 18);
+    TEST_ASSERT_EQUAL_HEX8(0x1F, static_cast<uint8_t>(gz[0]));
+    TEST_ASSERT_EQUAL_HEX8(0x8B, static_cast<uint8_t>(gz[1]));
+    TEST_ASSERT_EQUAL_HEX8(8, static_cast<uint8_t>(gz[2]));
+
+    std::string out;
+    std::size_t end = 0;
+    TEST_ASSERT_TRUE(inflateFixed(gz, 10, out, end));
+    TEST_ASSERT_TRUE(out == body);
+    TEST_ASSERT_EQUAL_UINT32(gz.size(), end + 8);
+    TEST_ASSERT_EQUAL_HEX32(api::crc32Update(0, body.data(), body.size()), le32(gz, end));
+    TEST_ASSERT_EQUAL_UINT32(body.size(), le32(gz, end + 4));
+
+    // Much larger than the window: matches keep working across slides.
+    TEST_ASSERT_TRUE(body.size() > 8 * api::DeflateSink::kWindowBytes);
+    TEST_ASSERT_TRUE(gz.size() * 3 < body.size());
+
+    // Fed a byte at a time, the stream is identical.
+    TEST_ASSERT_TRUE(compress(body, ContentEncoding::Gzip, true) == gz);
+}
+
+void test_zlib_round_trip_and_edge_inputs()
+{
+    const std::string body = sampleBody();
+    const std::string z = compress(body, ContentEncoding::Deflate, false);
+    TEST_ASSERT_EQUAL_HEX8(0x28, static_cast<uint8_t>(z[0]));
+    TEST_ASSERT_EQUAL_UINT32(0, ((static_cast<uint8_t>(z[0]) << 8) | static_cast<uint8_t>(z[1])) % 31);
+    std::string out;
+    std::size_t end = 0;
+    TEST_ASSERT_TRUE(inflateFixed(z, 2, out, end));
+    TEST_ASSERT_TRUE(out == body);
+    TEST_ASSERT_EQUAL_UINT32(z.size(), end + 4);
+    TEST_ASSERT_EQUAL_HEX32(api::adler32Update(1, body.data(), body.size()), be32(z, end));
+
+    // Empty, tiny, every byte value, and one long run (maximum matches).
+    std::string bytes;
+    for (int i = 0; i < 256; ++i) {
+        bytes += static_cast<char>(i);
+    }
+    const std::string inputs[] = {"", "a", "ab", bytes + bytes, std::string(5000, 'x')};
+    for (const std::string& input : inputs) {
+        const std::string gz = compress(input, ContentEncoding::Gzip, false);
+        out.clear();
+        TEST_ASSERT_TRUE(inflateFixed(gz, 10, out, end));
+        TEST_ASSERT_TRUE(out == input);
+        TEST_ASSERT_EQUAL_UINT32(gz.size(), end + 8);
+    }
+}
+
+void test_accept_encoding_negotiation()
+{
+    TEST_ASSERT_TRUE(api::selectContentEncoding("") == ContentEncoding::Identity);
+    TEST_ASSERT_TRUE(api::selectContentEncoding("identity") == ContentEncoding::Identity);
+    TEST_ASSERT_TRUE(api::selectContentEncoding("br") == ContentEncoding::Identity);
+    TEST_ASSERT_TRUE(api::selectContentEncoding("gzip, deflate, br") == ContentEncoding::Gzip);
+    TEST_ASSERT_TRUE(api::selectContentEncoding("deflate") == ContentEncoding::Deflate);
+    TEST_ASSERT_TRUE(api::selectContentEncoding(" GZIP ;q=0.8") == ContentEncoding::Gzip);
+    TEST_ASSERT_TRUE(api::selectContentEncoding("gzip;q=0, deflate") == ContentEncoding::Deflate);
+    TEST_ASSERT_TRUE(api::selectContentEncoding("gzip;q=0.000") == ContentEncoding::Identity);
+    TEST_ASSERT_TRUE(api::selectContentEncoding("gzip;q=0.5, deflate;q=0.9") ==
+                     ContentEncoding::Deflate);
+    TEST_ASSERT_TRUE(api::selectContentEncoding("*") == ContentEncoding::Gzip);
+    TEST_ASSERT_TRUE(api::selectContentEncoding("*;q=0") == ContentEncoding::Identity);
+    TEST_ASSERT_TRUE(api::selectContentEncoding("gzip;q=0, *") == ContentEncoding::Deflate);
+    TEST_ASSERT_EQUAL_STRING("gzip", api::contentEncodingName(ContentEncoding::Gzip));
+    TEST_ASSERT_NULL(api::contentEncodingName(ContentEncoding::Identity));
+}
+
+}  // namespace
+
+void run_deflate_tests(void)
+{
+    RUN_TEST(test_checksum_reference_values);
+    RUN_TEST(test_gzip_round_trip);
+    RUN_TEST(test_zlib_round_trip_and_edge_inputs);
+    RUN_TEST(test_accept_encoding_negotiation);
+}
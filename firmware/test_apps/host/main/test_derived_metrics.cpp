@@ -0,0 +1,164 @@
+// SPDX-FileCopyrightText: 2026 Cryptotomte
+// SPDX-License-Identifier: AGPL-3.0-or-later
+/**
+ * @file test_derived_metrics.cpp
+ * @brief Host suite for the virtual /history metrics (api/DerivedMetrics.h).
+ *
+ * Registered by test_main.cpp via run_derived_metrics_tests(). The
+ * formulas hit reference values; the join yields one reading per input
+ * epoch, holds an input for holdS and no longer, takes a partner from
+ * before the window, and crosses batch boundaries without losing or
+ * doubling a reading; the folded reads answer from the join and logged
+ * metrics pass straight through.
+ */
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include "unity.h"
+
+#include "api/DerivedMetrics.h"
+#include "storage/testing/MockDataStorage.h"
+
+namespace {
+
+using api::DerivedMetricStorage;
+
+void store(MockDataStorage& storage, const char* metric, uint32_t epoch, float value)
+{
+    TEST_ASSERT_TRUE(storage.storeSensorReading(metric, epoch, value));
+}
+
+void test_formulas_match_reference_values(void)
+{
+    TEST_ASSERT_FLOAT_WITHIN(0.005f, 1.581f, api::vaporPressureDeficitKpa(25.0f, 50.0f));
+    TEST_ASSERT_FLOAT_WITHIN(0.005f, 0.0f, api::vaporPressureDeficitKpa(25.0f, 100.0f));
+    TEST_ASSERT_FLOAT_WITHIN(0.005f, 0.0f, api::vaporPressureDeficitKpa(25.0f, 104.0f));
+    TEST_ASSERT_FLOAT_WITHIN(0.005f, 0.611f, api::vaporPressureDeficitKpa(0.0f, 0.0f));
+
+    float dew = 0.0f;
+    TEST_ASSERT_TRUE(api::dewPointC(25.0f, 50.0f, dew));
+    TEST_ASSERT_FLOAT_WITHIN(0.05f, 13.85f, dew);
+    TEST_ASSERT_TRUE(api::dewPointC(18.0f, 100.0f, dew));
+    TEST_ASSERT_FLOAT_WITHIN(0.01f, 18.0f, dew);
+    TEST_ASSERT_FALSE(api::dewPointC(18.0f, 0.0f, dew));
+
+    TEST_ASSERT_NOT_NULL(api::findDerivedMetric("env_vpd"));
+    TEST_ASSERT_NOT_NULL(api::findDerivedMetric("env_dew_point"));
+    TEST_ASSERT_NULL(api::findDerivedMetric("env_temperature"));
+}
+
+void test_join_takes_one_reading_per_epoch_and_holds_inputs(void)
+{
+    MockDataStorage storage;
+    // One logging pass writes both at one epoch; then humidity is
+    // change-only for a while, then the device is off for an hour.
+    store(storage, "env_temperature", 1000, 25.0f);
+    store(storage, "env_humidity", 1000, 50.0f);
+    store(storage, "env_temperature", 1300, 26.0f);
+    store(storage, "env_temperature", 1600, 27.0f);
+    store(storage, "env_humidity", 1750, 100.0f);
+    store(storage, "env_temperature", 5200, 20.0f);
+    store(storage, "env_humidity", 5200, 100.0f);
+
+    DerivedMetricStorage view(storage, 600);
+    const std::vector<SensorReading> vpd = view.getSensorReadings("env_vpd", 0, UINT32_MAX);
+    TEST_ASSERT_EQUAL_size_t(5, vpd.size());
+    const uint32_t epochs[] = {1000, 1300, 1600, 1750, 5200};
+    for (std::size_t i = 0; i < vpd.size(); ++i) {
+        TEST_ASSERT_EQUAL_UINT32(epochs[i], vpd[i].epoch);
+        TEST_ASSERT_EQUAL_STRING("env_vpd", vpd[i].metric.c_str());
+    }
+    TEST_ASSERT_FLOAT_WITHIN(0.001f, api::vaporPressureDeficitKpa(26.0f, 50.0f), vpd[1].value);
+    TEST_ASSERT_FLOAT_WITHIN(0.001f, 0.0f, vpd[3].value);
+
+    // A shorter hold drops the pairs the change-only humidity carried.
+    DerivedMetricStorage strict(storage, 299);
+    TEST_ASSERT_EQUAL_size_t(3, strict.getSensorReadings("env_vpd", 0, UINT32_MAX).size());
+
+    // The window's first reading pairs with the humidity logged before it.
+    const std::vector<SensorReading> window = view.getSensorReadings("env_vpd", 1200, 1700);
+    TEST_ASSERT_EQUAL_size_t(2, window.size());
+    TEST_ASSERT_EQUAL_UINT32(1300, window[0].epoch);
+    TEST_ASSERT_TRUE(view.getSensorReadings("env_vpd", 1700, 1200).empty());
+    TEST_ASSERT_TRUE(view.getSensorReadings("env_vpd", 2000, 5000).empty());
+
+    // Out of the formula's range: no reading.
+    store(storage, "env_temperature", 5500, 20.0f);
+    store(storage, "env_humidity", 5500, 0.0f);
+    const std::vector<SensorReading> dew = view.getSensorReadings("env_dew_point", 5000, 6000);
+    TEST_ASSERT_EQUAL_size_t(1, dew.size());
+    TEST_ASSERT_EQUAL_UINT32(5200, dew[0].epoch);
+}
+
+void test_join_crosses_batches(void)
+{
+    MockDataStorage storage;
+    // Temperature every minute, humidity every other, with a repeated
+    // epoch straddling the first temperature batch's end.
+    const uint32_t count = 3 * DerivedMetricStorage::kBatchReadings;
+    for (uint32_t i = 0; i < count; ++i) {
+        store(storage, "env_temperature", 60 * i, 20.0f + static_cast<float>(i % 7));
+        if (i == DerivedMetricStorage::kBatchReadings - 1) {
+            store(storage, "env_temperature", 60 * i, 30.0f);
+        }
+        if (i % 2 == 0) {
+            store(storage, "env_humidity", 60 * i, 40.0f + static_cast<float>(i % 11));
+        }
+    }
+    DerivedMetricStorage view(storage, 60);
+    const std::vector<SensorReading> dew = view.getSensorReadings("env_dew_point", 0, UINT32_MAX);
+    TEST_ASSERT_EQUAL_size_t(count, dew.size());
+    for (uint32_t i = 0; i < count; ++i) {
+        TEST_ASSERT_EQUAL_UINT32(60 * i, dew[i].epoch);
+    }
+    // The repeat counts as the later reading.
+    const std::size_t repeat = DerivedMetricStorage::kBatchReadings - 1;
+    float expected = 0.0f;
+    TEST_ASSERT_TRUE(api::dewPointC(30.0f, 40.0f + static_cast<float>((repeat - 1) % 11),
+                                    expected));
+    TEST_ASSERT_FLOAT_WITHIN(0.001f, expected, dew[repeat].value);
+}
+
+void test_folded_reads_and_passthrough(void)
+{
+    MockDataStorage storage;
+    for (uint32_t i = 0; i < 10; ++i) {
+        store(storage, "env_temperature", 100 * i, 25.0f);
+        store(storage, "env_humidity", 100 * i, i < 5 ? 50.0f : 100.0f);
+    }
+    DerivedMetricStorage view(storage, 300);
+
+    const SensorWindowStats stats = view.getSensorWindowStats("env_vpd", 0, UINT32_MAX);
+    TEST_ASSERT_EQUAL_UINT32(10, stats.count);
+    TEST_ASSERT_FLOAT_WITHIN(0.001f, 0.0f, stats.min);
+    TEST_ASSERT_FLOAT_WITHIN(0.005f, 1.581f, stats.max);
+    TEST_ASSERT_EQUAL_UINT32(900, stats.lastEpoch);
+
+    const std::vector<SensorAggregate> buckets = view.getSensorAggregates("env_vpd", 0, 999, 500);
+    TEST_ASSERT_EQUAL_size_t(2, buckets.size());
+    TEST_ASSERT_EQUAL_UINT32(5, buckets[0].count);
+    TEST_ASSERT_FLOAT_WITHIN(0.001f, 0.0f, buckets[1].max);
+
+    const std::vector<SensorReading> latest = view.getLatestReadings("env_vpd", 3);
+    TEST_ASSERT_EQUAL_size_t(3, latest.size());
+    TEST_ASSERT_EQUAL_UINT32(700, latest[0].epoch);
+    TEST_ASSERT_TRUE(view.latestReading("env_vpd").found);
+
+    // Logged metrics and writes are the wrapped storage's.
+    TEST_ASSERT_EQUAL_size_t(10, view.getSensorReadings("env_humidity", 0, UINT32_MAX).size());
+    TEST_ASSERT_TRUE(view.storeSensorReading("soil_ph", 1000, 6.5f));
+    TEST_ASSERT_EQUAL_size_t(1, storage.getSensorReadings("soil_ph", 0, UINT32_MAX).size());
+    TEST_ASSERT_TRUE(view.getSensorReadings("env_vpd_x", 0, UINT32_MAX).empty());
+}
+
+}  // namespace
+
+void run_derived_metrics_tests(void)
+{
+    RUN_TEST(test_formulas_match_reference_values);
+    RUN_TEST(test_join_takes_one_reading_per_epoch_and_holds_inputs);
+    RUN_TEST(test_join_crosses_batches);
+    RUN_TEST(test_folded_reads_and_passthrough);
+}
@@ -0,0 +1,217 @@
+// SPDX-FileCopyrightText: 2026 Cryptotomte
+// SPDX-License-Identifier: AGPL-3.0-or-later
+/**
+ * @file test_duty_cycle.cpp
+ * @brief Host suite for the deep-sleep node's retained state
+ *        (control/DutyCycle.h) and the controller state it carries.
+ *
+ * Registered by test_main.cpp via run_duty_cycle_tests(). A blank or
+ * corrupted block is a cold start that syncs; sealed blocks resume with the
+ * time slept; a sync falls due every syncEvery wakes and a failed one is
+ * retried on the next; the sleep is cut short by a soak end or a window
+ * opening but never below the floor; and a controller restored on a fresh
+ * clock keeps the soak pause a burst before the sleep started.
+ */
+
+#include <cstdint>
+
+#include "unity.h"
+
+#include "actuators/testing/FakeTimeProvider.h"
+#include "actuators/testing/MockWaterPump.h"
+#include "control/DutyCycle.h"
+#include "control/WateringController.h"
+#include "events/EventLogger.h"
+#include "sensors/testing/MockEnvironmentalSensor.h"
+#include "sensors/testing/MockSoilSensor.h"
+#include "storage/testing/MockConfigStore.h"
+#include "storage/testing/MockDataStorage.h"
+#include "time/testing/FakeWallClock.h"
+
+namespace {
+
+DutyCycleSettings settings(uint16_t syncEvery)
+{
+    DutyCycleSettings s;
+    s.periodMs = 600'000;
+    s.minSleepMs = 30'000;
+    s.syncEvery = syncEvery;
+    return s;
+}
+
+/// One wake over @p block: resume at @p rtcMs, optionally sync, seal.
+void wake(DutyCycleState& block, uint16_t syncEvery, int64_t rtcMs, bool syncOk)
+{
+    DutyCycle cycle(block, settings(syncEvery));
+    cycle.resume(rtcMs);
+    if (cycle.syncDue()) {
+        cycle.noteSync(syncOk);
+    }
+    cycle.seal(WateringControllerState{}, rtcMs + 100, 100);
+}
+
+/// A wake's collaborators on a clock that restarted at boot.
+struct Node {
+    FakeTimeProvider clock{2'000};
+    MockSoilSensor soil;
+    MockEnvironmentalSensor env;
+    MockWaterPump pump{"plant", clock};
+    MockConfigStore config;
+    MockDataStorage storage;
+    FakeWallClock wallClock;
+    EventLogger events{storage, wallClock};
+    WateringController controller{soil,    env,   pump,      config,
+                                  storage, clock, wallClock, events};
+
+    Node()
+    {
+        TEST_ASSERT_TRUE(pump.initialize());
+        config.stored.moistureThresholdLow = 30.0f;
+        config.stored.moistureThresholdHigh = 55.0f;
+        config.stored.wateringDurationS = 20;
+        config.stored.minWateringIntervalS = 300;
+        config.stored.wateringEnabled = 1;
+        soil.readResult = true;
+        soil.isAvailableResult = true;
+        soil.moisture = 20.0f;  // dry: a burst whenever the soak allows
+    }
+};
+
+void test_blank_block_is_a_cold_start_that_syncs(void)
+{
+    DutyCycleState block{};
+    DutyCycle cycle(block, settings(6));
+    TEST_ASSERT_FALSE(cycle.resume(5'000));
+    TEST_ASSERT_NULL(cycle.controllerState());
+    TEST_ASSERT_TRUE(cycle.syncDue());
+    TEST_ASSERT_EQUAL_INT64(0, cycle.sleptMs());
+    TEST_ASSERT_EQUAL_UINT32(1, cycle.counters().wakes);
+
+    cycle.seal(WateringControllerState{}, 6'000, 1'000);
+    TEST_ASSERT_TRUE(DutyCycle::valid(block));
+    block.counters.wakes = 99;  // a bit flip in RTC memory
+    TEST_ASSERT_FALSE(DutyCycle::valid(block));
+    DutyCycle again(block, settings(6));
+    TEST_ASSERT_FALSE(again.resume(7'000));
+    TEST_ASSERT_EQUAL_UINT32(1, again.counters().wakes);
+}
+
+void test_sealed_block_resumes_with_the_time_slept(void)
+{
+    DutyCycleState block{};
+    WateringControllerState saved{};
+    saved.burstEndAgeMs = 1'234;
+    {
+        DutyCycle cycle(block, settings(6));
+        cycle.resume(1'000);
+        cycle.noteBurst();
+        cycle.seal(saved, 2'000, 1'000);
+    }
+    DutyCycle cycle(block, settings(6));
+    TEST_ASSERT_TRUE(cycle.resume(602'000));
+    TEST_ASSERT_EQUAL_INT64(600'000, cycle.sleptMs());
+    TEST_ASSERT_NOT_NULL(cycle.controllerState());
+    TEST_ASSERT_EQUAL_INT64(1'234, cycle.controllerState()->burstEndAgeMs);
+    TEST_ASSERT_EQUAL_UINT32(2, cycle.counters().wakes);
+    TEST_ASSERT_EQUAL_UINT32(1, cycle.counters().bursts);
+    TEST_ASSERT_EQUAL_UINT64(1'000, cycle.counters().awakeMs);
+}
+
+void test_sync_every_nth_wake_and_retry_after_failure(void)
+{
+    DutyCycleState block{};
+    wake(block, 3, 0, true);  // cold: synced
+    int64_t rtc = 0;
+    bool due[5] = {};
+    for (bool& d : due) {
+        rtc += 1'000'000;
+        DutyCycle cycle(block, settings(3));
+        cycle.resume(rtc);
+        d = cycle.syncDue();
+        if (d) {
+            cycle.noteSync(true);
+        }
+        cycle.seal(WateringControllerState{}, rtc + 100, 100);
+    }
+    TEST_ASSERT_FALSE(due[0]);
+    TEST_ASSERT_FALSE(due[1]);
+    TEST_ASSERT_TRUE(due[2]);
+    TEST_ASSERT_FALSE(due[3]);
+    TEST_ASSERT_FALSE(due[4]);
+
+    // Due on the next wake; it fails, so the one after retries.
+    wake(block, 3, rtc += 1'000'000, false);
+    DutyCycle cycle(block, settings(3));
+    cycle.resume(rtc + 1'000'000);
+    TEST_ASSERT_TRUE(cycle.syncDue());
+    TEST_ASSERT_EQUAL_UINT32(1, cycle.counters().syncFailures);
+    TEST_ASSERT_EQUAL_UINT32(2, cycle.counters().syncs);
+}
+
+void test_sleep_is_cut_short_but_floored(void)
+{
+    DutyCycleState block{};
+    DutyCycle cycle(block, settings(1));
+    cycle.resume(0);
+    TEST_ASSERT_EQUAL_UINT32(600'000, cycle.planSleepMs(10'000, 0, 0));
+    TEST_ASSERT_EQUAL_UINT32(200'000, cycle.planSleepMs(10'000, 210'000, 0));
+    TEST_ASSERT_EQUAL_UINT32(90'000, cycle.planSleepMs(10'000, 210'000, 100'000));
+    TEST_ASSERT_EQUAL_UINT32(30'000, cycle.planSleepMs(10'000, 15'000, 0));
+    TEST_ASSERT_EQUAL_UINT32(600'000, cycle.planSleepMs(10'000, 5'000, 0));  // past
+}
+
+void test_restored_controller_keeps_the_soak_pause(void)
+{
+    WateringControllerState saved{};
+    {
+        Node before;
+        before.controller.tick();  // dry: burst starts
+        TEST_ASSERT_TRUE(before.pump.isRunning());
+        before.clock.advance(20'000);
+        before.pump.update();      // self-stop at the burst duration
+        before.controller.tick();  // burst end recorded
+        TEST_ASSERT_FALSE(before.pump.isRunning());
+        before.clock.advance(1'000);
+        before.controller.saveState(saved);
+    }
+    TEST_ASSERT_EQUAL_INT64(1'000, saved.burstEndAgeMs);
+
+    // Asleep 200 s: 201 s of the 300 s soak gone, on a clock that restarted.
+    Node after;
+    after.controller.restoreState(saved, 200'000);
+    after.controller.tick();
+    TEST_ASSERT_FALSE(after.pump.isRunning());
+    TEST_ASSERT_EQUAL_INT64(after.clock.nowMs() + 99'000,
+                            after.controller.soakEndsAtMs(after.clock.nowMs()));
+
+    after.clock.advance(99'000);
+    after.controller.tick();
+    TEST_ASSERT_TRUE(after.pump.isRunning());
+}
+
+void test_fresh_controller_state_has_no_origins(void)
+{
+    Node node;
+    WateringControllerState saved{};
+    node.controller.saveState(saved);
+    TEST_ASSERT_EQUAL_INT64(-1, saved.burstEndAgeMs);
+    TEST_ASSERT_EQUAL_INT64(-1, saved.dataLogAgeMs);
+
+    Node after;
+    after.controller.restoreState(saved, 600'000);
+    TEST_ASSERT_EQUAL_INT64(0, after.controller.soakEndsAtMs(after.clock.nowMs()));
+    after.controller.tick();
+    TEST_ASSERT_TRUE(after.pump.isRunning());
+}
+
+}  // namespace
+
+void run_duty_cycle_tests(void)
+{
+    RUN_TEST(test_blank_block_is_a_cold_start_that_syncs);
+    RUN_TEST(test_sealed_block_resumes_with_the_time_slept);
+    RUN_TEST(test_sync_every_nth_wake_and_retry_after_failure);
+    RUN_TEST(test_sleep_is_cut_short_but_floored);
+    RUN_TEST(test_restored_controller_keeps_the_soak_pause);
+    RUN_TEST(test_fresh_controller_state_has_no_origins);
+}
@@ -0,0 +1,186 @@
+// SPDX-FileCopyrightText: 2026 Cryptotomte
+// SPDX-License-Identifier: AGPL-3.0-or-later
+/**
+ * @file test_energy_meter.cpp
+ * @brief Host suite for the on-device energy integration
+ *        (sensors/EnergyMeter.h).
+ *
+ * Registered by test_main.cpp via run_energy_meter_tests(). The trapezoid
+ * is exact for a ramp and sums an hour of default-rate results to the
+ * watt-hour; a run takes its switch-on and run-down edges and nothing of
+ * the idle time around it; gaps are counted, not bridged; days roll over
+ * on the wall clock; and a sealed block restores the totals, closing a run
+ * the reset cut.
+ */
+
+#include <cmath>
+#include <cstdint>
+
+#include "unity.h"
+
+#include "sensors/EnergyMeter.h"
+
+namespace {
+
+constexpr int64_t kPeriodUs = 35200;  ///< ina226_sampling::kDefault
+constexpr uint32_t kDay = 1751673600;  ///< a UTC midnight
+
+WallTime at(uint32_t epoch)
+{
+    WallTime t;
+    t.epoch = epoch;
+    t.set = true;
+    return t;
+}
+
+void test_trapezoid_exact_for_ramp_and_sums_an_hour(void)
+{
+    EnergyMeter meter;
+    meter.restore({});
+    // 0 → 36 W over 100 s in 1 s steps: 0.5 Wh, exactly, for a trapezoid.
+    for (int i = 0; i <= 100; ++i) {
+        meter.addSample(0.36f * static_cast<float>(i), i * 1000000LL, false, at(kDay));
+    }
+    TEST_ASSERT_DOUBLE_WITHIN(1e-6, 0.5, meter.load().totalWh);
+
+    EnergyMeter hour;
+    hour.restore({});
+    const int64_t results = 3600LL * 1000000 / kPeriodUs;
+    for (int64_t i = 0; i <= results; ++i) {
+        hour.addSample(12.0f, i * kPeriodUs, false, at(kDay));
+    }
+    const double expected = 12.0 * static_cast<double>(results * kPeriodUs) / 3600.0e6;
+    TEST_ASSERT_DOUBLE_WITHIN(1e-9, expected, hour.load().totalWh);
+    TEST_ASSERT_DOUBLE_WITHIN(1e-9, expected, hour.load().dayWh);
+    TEST_ASSERT_EQUAL_UINT32(results + 1, hour.load().samples);
+}
+
+void test_run_takes_its_edges_and_no_idle(void)
+{
+    EnergyMeter meter;
+    meter.restore({});
+    int64_t t = 0;
+    for (int i = 0; i < 10; ++i, t += 1000000) {
+        meter.addSample(1.0f, t, false, at(kDay + 100));  // idle draw
+    }
+    TEST_ASSERT_FALSE(meter.load().runActive);
+    // Pump on for 5 s at 13 W (the idle watt included).
+    for (int i = 0; i <= 5; ++i, t += 1000000) {
+        TEST_ASSERT_EQUAL_UINT32(0, meter.addSample(13.0f, t, true, at(kDay + 110)));
+    }
+    TEST_ASSERT_TRUE(meter.load().runActive);
+    TEST_ASSERT_EQUAL_UINT32(kDay + 110, meter.load().runStart);
+    const uint32_t closed = meter.addSample(1.0f, t, false, at(kDay + 116));
+    TEST_ASSERT_EQUAL_UINT32(EnergyMeter::kRunClosed, closed);
+
+    const EnergyTotals e = meter.load();
+    // Switch-on edge (1 → 13 W) + 5 s at 13 W + run-down (13 → 1 W).
+    const double runWh = (7.0 + 5 * 13.0 + 7.0) / 3600.0;
+    TEST_ASSERT_FALSE(e.runActive);
+    TEST_ASSERT_DOUBLE_WITHIN(1e-9, runWh, e.lastRunWh);
+    TEST_ASSERT_EQUAL_UINT32(6000, e.lastRunMs);
+    TEST_ASSERT_EQUAL_UINT32(kDay + 110, e.lastRunStart);
+    TEST_ASSERT_EQUAL_UINT32(1, e.runs);
+    TEST_ASSERT_DOUBLE_WITHIN(1e-9, runWh + 9.0 / 3600.0, e.totalWh);
+
+    // A later idle sample closes nothing.
+    TEST_ASSERT_EQUAL_UINT32(0, meter.addSample(1.0f, t + 1000000, false, at(kDay + 117)));
+}
+
+void test_gaps_are_counted_not_bridged(void)
+{
+    EnergyMeter meter;
+    meter.restore({});
+    meter.addSample(10.0f, 0, false, WallTime{});
+    meter.addSample(10.0f, 1000000, false, WallTime{});
+    // Past kMaxGapUs: no straight line across the outage.
+    meter.addSample(10.0f, 1000000 + EnergyMeter::kMaxGapUs + 1000, false, WallTime{});
+    TEST_ASSERT_DOUBLE_WITHIN(1e-9, 10.0 / 3600.0, meter.load().totalWh);
+    TEST_ASSERT_EQUAL_UINT64(2001, meter.load().uncoveredMs);
+
+    // A failed read breaks the series even inside kMaxGapUs.
+    const double before = meter.load().totalWh;
+    meter.gap();
+    meter.addSample(10.0f, 4000000, false, WallTime{});
+    TEST_ASSERT_DOUBLE_WITHIN(1e-12, before, meter.load().totalWh);
+    meter.addSample(NAN, 4100000, false, WallTime{});
+    meter.addSample(10.0f, 4200000, false, WallTime{});
+    TEST_ASSERT_DOUBLE_WITHIN(1e-12, before, meter.load().totalWh);
+    meter.addSample(10.0f, 5200000, false, WallTime{});
+    TEST_ASSERT_DOUBLE_WITHIN(1e-9, before + 10.0 / 3600.0, meter.load().totalWh);
+}
+
+void test_days_roll_over_on_the_wall_clock(void)
+{
+    EnergyMeter meter;
+    meter.restore({});
+    // 3600 W for a second is 1 Wh. Before the clock is set: no day yet,
+    // the energy kept for the first one.
+    meter.addSample(3600.0f, 0, false, WallTime{});
+    meter.addSample(3600.0f, 1000000, false, WallTime{});
+    TEST_ASSERT_EQUAL_UINT32(0, meter.load().dayStart);
+    TEST_ASSERT_EQUAL_UINT32(0, meter.addSample(3600.0f, 2000000, false,
+                                                at(kDay + 86398)));
+    TEST_ASSERT_EQUAL_UINT32(kDay, meter.load().dayStart);
+    TEST_ASSERT_DOUBLE_WITHIN(1e-9, 2.0, meter.load().dayWh);
+
+    const uint32_t closed = meter.addSample(3600.0f, 3000000, false, at(kDay + 86400));
+    TEST_ASSERT_EQUAL_UINT32(EnergyMeter::kDayClosed, closed);
+    const EnergyTotals e = meter.load();
+    TEST_ASSERT_EQUAL_UINT32(kDay, e.previousDayStart);
+    TEST_ASSERT_DOUBLE_WITHIN(1e-9, 2.0, e.previousDayWh);
+    TEST_ASSERT_EQUAL_UINT32(kDay + 86400, e.dayStart);
+    TEST_ASSERT_DOUBLE_WITHIN(1e-9, 1.0, e.dayWh);  // the straddling interval
+    TEST_ASSERT_DOUBLE_WITHIN(1e-9, 3.0, e.totalWh);
+}
+
+void test_seal_restore_closes_the_cut_run(void)
+{
+    EnergyMeter meter;
+    meter.restore({});
+    meter.addSample(0.0f, 0, false, at(kDay + 10));
+    meter.addSample(3600.0f, 1000000, true, at(kDay + 11));
+    meter.addSample(3600.0f, 2000000, true, at(kDay + 12));
+    EnergyBlock older{};
+    EnergyBlock newer{};
+    meter.seal(older);
+    meter.seal(newer);
+    TEST_ASSERT_EQUAL_UINT32(2, meter.sealSequence());
+    TEST_ASSERT_TRUE(EnergyMeter::valid(newer));
+
+    EnergyBlock garbage = newer;
+    garbage.sequence = 99;  // CRC no longer matches
+    TEST_ASSERT_FALSE(EnergyMeter::valid(garbage));
+
+    EnergyMeter after;
+    TEST_ASSERT_TRUE(after.restore({&older, &garbage, &newer}) == &newer);
+    const EnergyTotals e = after.load();
+    // The reset stopped the pump: the run is closed as far as it got.
+    TEST_ASSERT_FALSE(e.runActive);
+    TEST_ASSERT_EQUAL_UINT32(1, e.runs);
+    TEST_ASSERT_EQUAL_UINT32(1000, e.lastRunMs);
+    TEST_ASSERT_EQUAL_UINT32(kDay + 11, e.lastRunStart);
+    TEST_ASSERT_DOUBLE_WITHIN(1e-9, 1.5, e.lastRunWh);
+    TEST_ASSERT_DOUBLE_WITHIN(1e-9, 1.5, e.dayWh);
+    TEST_ASSERT_EQUAL_UINT32(kDay, e.dayStart);
+
+    // Reported once, with the first sample of the new boot.
+    TEST_ASSERT_EQUAL_UINT32(EnergyMeter::kRunClosed,
+                             after.addSample(0.0f, 0, false, at(kDay + 200)));
+    TEST_ASSERT_EQUAL_UINT32(0, after.addSample(0.0f, kPeriodUs, false, at(kDay + 200)));
+
+    EnergyMeter cold;
+    TEST_ASSERT_NULL(cold.restore({&garbage, nullptr}));
+    TEST_ASSERT_EQUAL_DOUBLE(0.0, cold.load().totalWh);
+}
+
+}  // namespace
+
+void run_energy_meter_tests(void)
+{
+    RUN_TEST(test_trapezoid_exact_for_ramp_and_sums_an_hour);
+    RUN_TEST(test_run_takes_its_edges_and_no_idle);
+    RUN_TEST(test_gaps_are_counted_not_bridged);
+    RUN_TEST(test_days_roll_over_on_the_wall_clock);
+    RUN_TEST(test_seal_restore_closes_the_cut_run);
+}
@@ -7,19 +7,33 @@
  * Registered by test_main.cpp via run_event_logger_tests(). Drives the pure
  * EventLogger over MockDataStorage + FakeWallClock (no IDF, no real clock).
  * Each producer must write exactly ONE event carrying the expected category,
- * the exact deterministic detail string (contracts/event-logger.md) and the
- * FakeWallClock epoch; a failing store increments droppedEvents() without
- * crashing; resetReasonName() maps the ESP_RST_* integer values.
+ * a detail that renders (renderEventDetail()) to the exact deterministic
+ * string (contracts/event-logger.md) and the FakeWallClock epoch; a failing
+ * store increments droppedEvents() without crashing; resetReasonName() maps
+ * the ESP_RST_* integer values. The typed producers store compact details;
+ * text details render verbatim and a malformed compact one as its code.
+ * The hourly EventCounts behind /api/v1/events/summary: stored events only,
+ * the sliding window, sealed blocks restored after a warm reset and the
+ * cold-boot recount from the log merged with a checkpoint. The notifier
+ * behind /api/v1/events?wait=: bumped by stored events only, and a waiter
+ * on another thread woken by the next one.
  *
  * Coverage maps to specs/008-sntp-watchdog-logging/contracts/event-logger.md.
  */
 
+#include <chrono>
+#include <cmath>
 #include <cstdint>
+#include <string>
+#include <thread>
 #include <vector>
 
 #include "unity.h"
 
+#include "events/EventCounts.h"
 #include "events/EventLogger.h"
+#include "events/EventNotifier.h"
+#include "interfaces/EventCodec.h"
 #include "interfaces/IDataStorage.h"
 #include "storage/testing/MockDataStorage.h"
 #include "time/testing/FakeWallClock.h"
@@ -42,7 +56,9 @@ void test_log_reset_writes_one_reset_event(void)
     TEST_ASSERT_EQUAL_UINT32(kFixedEpoch, store.events[0].epoch);
     TEST_ASSERT_EQUAL_UINT8(IDataStorage::kCategoryReset,
                             store.events[0].category);
-    TEST_ASSERT_EQUAL_STRING("reset=TASK_WDT", store.events[0].detail.c_str());
+    TEST_ASSERT_EQUAL_STRING("reset=TASK_WDT", renderEventDetail(store.events[0].detail).c_str());
+    TEST_ASSERT_TRUE(isCompactEvent(store.events[0].detail));
+    TEST_ASSERT_EQUAL_size_t(3u, store.events[0].detail.size());
     TEST_ASSERT_EQUAL_UINT32(0u, logger.droppedEvents());
 }
 
@@ -58,7 +74,7 @@ void test_log_wifi_writes_one_connectivity_event(void)
     TEST_ASSERT_EQUAL_UINT32(kFixedEpoch, store.events[0].epoch);
     TEST_ASSERT_EQUAL_UINT8(IDataStorage::kCategoryConnectivity,
                             store.events[0].category);
-    TEST_ASSERT_EQUAL_STRING("wifi=Connected", store.events[0].detail.c_str());
+    TEST_ASSERT_EQUAL_STRING("wifi=Connected", renderEventDetail(store.events[0].detail).c_str());
 }
 
 void test_log_pump_start_writes_one_pump_event(void)
@@ -74,7 +90,7 @@ void test_log_pump_start_writes_one_pump_event(void)
     TEST_ASSERT_EQUAL_UINT8(IDataStorage::kCategoryPump,
                             store.events[0].category);
     TEST_ASSERT_EQUAL_STRING("pump=plant start cause=unknown",
-                             store.events[0].detail.c_str());
+                             renderEventDetail(store.events[0].detail).c_str());
 }
 
 void test_log_pump_stop_writes_one_pump_event(void)
@@ -90,7 +106,53 @@ void test_log_pump_stop_writes_one_pump_event(void)
     TEST_ASSERT_EQUAL_UINT8(IDataStorage::kCategoryPump,
                             store.events[0].category);
     TEST_ASSERT_EQUAL_STRING("pump=reservoir stop cause=unknown",
-                             store.events[0].detail.c_str());
+                             renderEventDetail(store.events[0].detail).c_str());
+}
+
+void test_log_pump_current_writes_one_pump_event(void)
+{
+    MockDataStorage store;
+    FakeWallClock clock(kFixedEpoch);
+    EventLogger logger(store, clock);
+
+    logger.logPumpCurrent("plant", 4.2106f, 2.05f, 2.1f, 12000, 3);
+
+    TEST_ASSERT_EQUAL_size_t(1u, store.events.size());
+    TEST_ASSERT_EQUAL_UINT8(IDataStorage::kCategoryPump,
+                            store.events[0].category);
+    TEST_ASSERT_EQUAL_STRING(
+        "pump=plant current peak=4.211 mean=2.050 rms=2.100 n=12000 missed=3",
+        renderEventDetail(store.events[0].detail).c_str());
+}
+
+void test_log_watchdog_warning_writes_one_reset_event(void)
+{
+    MockDataStorage store;
+    FakeWallClock clock(kFixedEpoch);
+    EventLogger logger(store, clock);
+
+    logger.logWatchdogWarning("soil_task", 10240, 20000);
+
+    TEST_ASSERT_EQUAL_size_t(1u, store.events.size());
+    TEST_ASSERT_EQUAL_UINT8(IDataStorage::kCategoryReset,
+                            store.events[0].category);
+    TEST_ASSERT_EQUAL_STRING("wdt-warn task=soil_task interval=10240ms timeout=20000ms",
+                             renderEventDetail(store.events[0].detail).c_str());
+}
+
+void test_log_tick_over_budget_writes_one_reset_event(void)
+{
+    MockDataStorage store;
+    FakeWallClock clock(kFixedEpoch);
+    EventLogger logger(store, clock);
+
+    logger.logTickOverBudget("logging", 412, 200);
+
+    TEST_ASSERT_EQUAL_size_t(1u, store.events.size());
+    TEST_ASSERT_EQUAL_UINT8(IDataStorage::kCategoryReset,
+                            store.events[0].category);
+    TEST_ASSERT_EQUAL_STRING("tick-slow phase=logging tick=412ms budget=200ms",
+                             renderEventDetail(store.events[0].detail).c_str());
 }
 
 void test_log_failsafe_writes_one_failsafe_event(void)
@@ -128,6 +190,48 @@ void test_log_ota_writes_one_ota_event(void)
     TEST_ASSERT_EQUAL_UINT32(0u, logger.droppedEvents());
 }
 
+void test_compact_details_render_and_text_passes_through(void)
+{
+    // Records written as text (before the compact encoding, or by the
+    // verbatim producers) read back unchanged.
+    TEST_ASSERT_EQUAL_STRING("failsafe=soil-invalid pump=plant",
+                             renderEventDetail("failsafe=soil-invalid pump=plant").c_str());
+    TEST_ASSERT_EQUAL_STRING("", renderEventDetail("").c_str());
+
+    // A pump start is about half its text.
+    const EventEncoder start = EventEncoder(EventCode::PumpStart).str("plant").str("schedule");
+    TEST_ASSERT_EQUAL_size_t(17u, start.view().size());
+    TEST_ASSERT_EQUAL_STRING("pump=plant start cause=schedule",
+                             renderEventDetail(start.view()).c_str());
+
+    // NaN and negative amps, clipped strings, full-width varints.
+    const std::string longName(40, 'p');
+    const EventEncoder current = EventEncoder(EventCode::PumpCurrent)
+                                     .str(longName.c_str())
+                                     .milliamps(NAN)
+                                     .milliamps(-0.25f)
+                                     .milliamps(12.3456f)
+                                     .u32(UINT32_MAX)
+                                     .u32(0);
+    TEST_ASSERT_EQUAL_STRING(("pump=" + std::string(EventEncoder::kMaxStringArg, 'p') +
+                              " current peak=nan mean=-0.250 rms=12.346 n=4294967295 missed=0")
+                                 .c_str(),
+                             renderEventDetail(current.view()).c_str());
+
+    // The repeat trailer QueuedDataStorage appends when it coalesces.
+    std::string repeated(EventEncoder(EventCode::Wifi).str("Disconnected").view());
+    char trailer[kEventRepeatMaxBytes];
+    repeated.append(trailer, encodeEventRepeat(trailer, 3, 1609459300u));
+    TEST_ASSERT_EQUAL_STRING("wifi=Disconnected count=3 last=1609459300",
+                             renderEventDetail(repeated).c_str());
+
+    // Unknown codes and truncated arguments render as the bare code.
+    TEST_ASSERT_EQUAL_STRING("event code=99",
+                             renderEventDetail(std::string("\x01\x63", 2)).c_str());
+    const std::string_view cut = start.view().substr(0, 10);
+    TEST_ASSERT_EQUAL_STRING("event code=3", renderEventDetail(cut).c_str());
+}
+
 void test_write_failure_increments_dropped_and_never_crashes(void)
 {
     MockDataStorage store;
@@ -170,9 +274,9 @@ void test_multi_event_stamps_at_call_time(void)
     std::vector<EventRecord> recent = store.getEvents(10);
     TEST_ASSERT_EQUAL_size_t(2u, recent.size());
     TEST_ASSERT_EQUAL_UINT32(kE + 3600u, recent[0].epoch);
-    TEST_ASSERT_EQUAL_STRING("wifi=Connected", recent[0].detail.c_str());
+    TEST_ASSERT_EQUAL_STRING("wifi=Connected", renderEventDetail(recent[0].detail).c_str());
     TEST_ASSERT_EQUAL_UINT32(kE, recent[1].epoch);
-    TEST_ASSERT_EQUAL_STRING("wifi=Connecting", recent[1].detail.c_str());
+    TEST_ASSERT_EQUAL_STRING("wifi=Connecting", renderEventDetail(recent[1].detail).c_str());
 }
 
 void test_reset_reason_name_mapping(void)
@@ -198,6 +302,183 @@ void test_reset_reason_name_mapping(void)
     TEST_ASSERT_EQUAL_STRING("UNKNOWN", resetReasonName(999));   // out of range
 }
 
+constexpr uint32_t kHour = EventCounts::kSecondsPerHour;
+
+void test_counts_follow_stored_events_only(void)
+{
+    MockDataStorage store;
+    FakeWallClock clock(kFixedEpoch);
+    EventLogger logger(store, clock);
+
+    logger.logPumpStart("plant", "moisture");
+    logger.logPumpStop("plant", "done");
+    logger.logFailsafe("overrun");
+    store.failWrites = true;
+    logger.logFailsafe("lost");  // dropped: not in the log, not counted
+    store.failWrites = false;
+
+    const EventCountSummary s = logger.counts().summary(clock.nowEpoch());
+    TEST_ASSERT_EQUAL_UINT32(24u, s.hours);
+    TEST_ASSERT_EQUAL_UINT32(2u, s.counts[IDataStorage::kCategoryPump]);
+    TEST_ASSERT_EQUAL_UINT32(1u, s.counts[IDataStorage::kCategoryFailsafe]);
+    TEST_ASSERT_EQUAL_UINT32(0u, s.counts[IDataStorage::kCategoryReset]);
+    TEST_ASSERT_EQUAL_UINT32(1u, logger.droppedEvents());
+}
+
+void test_counts_slide_with_the_hour(void)
+{
+    EventCounts counts;
+    const uint8_t reset = IDataStorage::kCategoryReset;
+    counts.record(kFixedEpoch, reset);                  // hour 0
+    counts.record(kFixedEpoch + 5 * kHour + 59, reset); // hour 5
+    counts.record(kFixedEpoch + 23 * kHour, reset);     // hour 23
+    counts.record(kFixedEpoch, 200);                    // not counted
+
+    TEST_ASSERT_EQUAL_UINT32(3u, counts.summary(kFixedEpoch + 23 * kHour).counts[reset]);
+    // The last 18 hours leave hour 5 out; hour 0 went with the window.
+    EventCountSummary s = counts.summary(kFixedEpoch + 23 * kHour, 18);
+    TEST_ASSERT_EQUAL_UINT32(18u, s.hours);
+    TEST_ASSERT_EQUAL_UINT32(kFixedEpoch + 6 * kHour, s.since);
+    TEST_ASSERT_EQUAL_UINT32(1u, s.counts[reset]);
+    // Hours after "now" are not counted.
+    TEST_ASSERT_EQUAL_UINT32(2u, counts.summary(kFixedEpoch + 5 * kHour).counts[reset]);
+
+    // Hour 24 reuses hour 0's slot; hour 0 is gone.
+    counts.record(kFixedEpoch + 24 * kHour, reset);
+    counts.record(kFixedEpoch + 24 * kHour + 1, reset);
+    TEST_ASSERT_EQUAL_UINT32(4u, counts.summary(kFixedEpoch + 24 * kHour).counts[reset]);
+    // A late event for the overwritten hour is not counted.
+    counts.record(kFixedEpoch + 10, reset);
+    TEST_ASSERT_EQUAL_UINT32(4u, counts.summary(kFixedEpoch + 24 * kHour).counts[reset]);
+    // Out-of-range windows mean the whole day.
+    TEST_ASSERT_EQUAL_UINT32(24u, counts.summary(kFixedEpoch, 0).hours);
+    TEST_ASSERT_EQUAL_UINT32(24u, counts.summary(kFixedEpoch, 99).hours);
+}
+
+void test_counts_seal_and_restore_onto_this_boot(void)
+{
+    const uint8_t pump = IDataStorage::kCategoryPump;
+    EventCountBlock rtc[2] = {};
+    {
+        EventCounts before;
+        before.record(kFixedEpoch, pump);
+        before.record(kFixedEpoch + kHour, pump);
+        before.seal(rtc[0]);
+        before.record(kFixedEpoch + kHour, pump);
+        before.seal(rtc[1]);
+        TEST_ASSERT_EQUAL_UINT32(2u, before.sequence());
+    }
+    TEST_ASSERT_TRUE(EventCounts::valid(rtc[0]));
+    TEST_ASSERT_TRUE(EventCounts::valid(rtc[1]));
+
+    // This boot's reset event was counted before the restore.
+    EventCounts after;
+    after.record(kFixedEpoch + kHour + 60, IDataStorage::kCategoryReset);
+    TEST_ASSERT_EQUAL_PTR(&rtc[1], after.restore({&rtc[0], &rtc[1], nullptr}));
+    TEST_ASSERT_EQUAL_UINT32(2u, after.sequence());
+    const EventCountSummary s = after.summary(kFixedEpoch + kHour);
+    TEST_ASSERT_EQUAL_UINT32(3u, s.counts[pump]);
+    TEST_ASSERT_EQUAL_UINT32(1u, s.counts[IDataStorage::kCategoryReset]);
+
+    // A torn block is refused; with none valid nothing changes.
+    rtc[0].counts[0][pump] ^= 1;
+    rtc[1].magic = 0;
+    TEST_ASSERT_FALSE(EventCounts::valid(rtc[0]));
+    EventCounts cold;
+    TEST_ASSERT_NULL(cold.restore({&rtc[0], &rtc[1]}));
+    TEST_ASSERT_EQUAL_UINT32(0u, cold.summary(kFixedEpoch + kHour).counts[pump]);
+}
+
+void test_counts_rebuild_from_log_and_checkpoint(void)
+{
+    const uint8_t pump = IDataStorage::kCategoryPump;
+    const uint8_t ota = IDataStorage::kCategoryOta;
+    MockDataStorage store;
+    FakeWallClock clock(kFixedEpoch);
+    EventLogger logger(store, clock);
+    // Older than the day before the newest event: not recounted.
+    logger.logOta("old");
+    for (int i = 0; i < 70; ++i) {  // more than one rebuild page
+        clock.setEpoch(kFixedEpoch + 2 * kHour + static_cast<uint32_t>(i));
+        logger.logPumpStart("plant", "moisture");
+    }
+    clock.setEpoch(kFixedEpoch + 25 * kHour);
+    logger.logOta("new");
+
+    // The checkpoint saw more pump events in hour 2 than the log still has
+    // and an hour-1 OTA event the log lost; its hour 0 is outside the day.
+    EventCountBlock checkpoint{};
+    {
+        EventCounts earlier;
+        for (int i = 0; i < 75; ++i) {
+            earlier.record(kFixedEpoch + 2 * kHour, pump);
+        }
+        earlier.record(kFixedEpoch + kHour, ota);
+        earlier.record(kFixedEpoch + 5, ota);
+        earlier.seal(checkpoint);
+    }
+
+    EventCounts counts;
+    counts.record(kFixedEpoch + 25 * kHour, ota);  // replaced by the recount
+    TEST_ASSERT_EQUAL_size_t(71u, counts.rebuild(store, nullptr));
+    EventCountSummary s = counts.summary(kFixedEpoch + 25 * kHour);
+    TEST_ASSERT_EQUAL_UINT32(70u, s.counts[pump]);
+    TEST_ASSERT_EQUAL_UINT32(1u, s.counts[ota]);
+
+    TEST_ASSERT_EQUAL_size_t(71u, counts.rebuild(store, &checkpoint));
+    TEST_ASSERT_EQUAL_UINT32(1u, counts.sequence());
+    s = counts.summary(kFixedEpoch + 25 * kHour);
+    TEST_ASSERT_EQUAL_UINT32(75u, s.counts[pump]);
+    TEST_ASSERT_EQUAL_UINT32(1u, s.counts[ota]);  // hour 1 aged out, hour 25 kept
+
+    // An empty log keeps the checkpoint as it was.
+    MockDataStorage empty;
+    EventCounts fresh;
+    TEST_ASSERT_EQUAL_size_t(0u, fresh.rebuild(empty, &checkpoint));
+    TEST_ASSERT_EQUAL_UINT32(75u, fresh.summary(kFixedEpoch + 2 * kHour).counts[pump]);
+}
+
+void test_notifier_follows_stored_events_only(void)
+{
+    MockDataStorage store;
+    FakeWallClock clock(kFixedEpoch);
+    EventLogger logger(store, clock);
+    EventNotifier& notifier = logger.notifier();
+
+    const uint32_t before = notifier.generation();
+    logger.logPumpStart("plant", "moisture");
+    logger.logPumpStop("plant", "done");
+    TEST_ASSERT_EQUAL_UINT32(before + 2, notifier.generation());
+    store.failWrites = true;
+    logger.logFailsafe("lost");  // dropped: nothing to read, nobody woken
+    TEST_ASSERT_EQUAL_UINT32(before + 2, notifier.generation());
+
+    // Past already: no wait. Not past: the timeout, generation unchanged.
+    TEST_ASSERT_EQUAL_UINT32(before + 2, notifier.waitPast(before, 5000));
+    TEST_ASSERT_EQUAL_UINT32(before + 2, notifier.waitPast(before + 2, 10));
+}
+
+void test_notifier_wakes_a_waiter(void)
+{
+    MockDataStorage store;
+    FakeWallClock clock(kFixedEpoch);
+    EventLogger logger(store, clock);
+    const uint32_t seen = logger.notifier().generation();
+
+    std::thread producer([&] {
+        std::this_thread::sleep_for(std::chrono::milliseconds(20));
+        logger.logOta("ota=begin");
+    });
+    const auto start = std::chrono::steady_clock::now();
+    const uint32_t woken = logger.notifier().waitPast(seen, 10000);
+    const auto waited = std::chrono::steady_clock::now() - start;
+    producer.join();
+
+    TEST_ASSERT_EQUAL_UINT32(seen + 1, woken);
+    TEST_ASSERT_TRUE(waited < std::chrono::seconds(5));  // woken, not timed out
+    TEST_ASSERT_EQUAL_size_t(1u, store.events.size());
+}
+
 }  // namespace
 
 void run_event_logger_tests(void)
@@ -206,9 +487,19 @@ void run_event_logger_tests(void)
     RUN_TEST(test_log_wifi_writes_one_connectivity_event);
     RUN_TEST(test_log_pump_start_writes_one_pump_event);
     RUN_TEST(test_log_pump_stop_writes_one_pump_event);
+    RUN_TEST(test_log_pump_current_writes_one_pump_event);
+    RUN_TEST(test_log_watchdog_warning_writes_one_reset_event);
+    RUN_TEST(test_log_tick_over_budget_writes_one_reset_event);
     RUN_TEST(test_log_failsafe_writes_one_failsafe_event);
     RUN_TEST(test_log_ota_writes_one_ota_event);
+    RUN_TEST(test_compact_details_render_and_text_passes_through);
     RUN_TEST(test_write_failure_increments_dropped_and_never_crashes);
     RUN_TEST(test_multi_event_stamps_at_call_time);
     RUN_TEST(test_reset_reason_name_mapping);
+    RUN_TEST(test_counts_follow_stored_events_only);
+    RUN_TEST(test_counts_slide_with_the_hour);
+    RUN_TEST(test_counts_seal_and_restore_onto_this_boot);
+    RUN_TEST(test_counts_rebuild_from_log_and_checkpoint);
+    RUN_TEST(test_notifier_follows_stored_events_only);
+    RUN_TEST(test_notifier_wakes_a_waiter);
 }
@@ -0,0 +1,166 @@
+// SPDX-FileCopyrightText: 2026 Cryptotomte
+// SPDX-License-Identifier: AGPL-3.0-or-later
+/**
+ * @file test_event_tail.cpp
+ * @brief Host suite for the /api/v1/events?after= tail reads
+ *        (api/EventTail.h).
+ *
+ * Registered by test_main.cpp via run_event_tail_tests(). Driven over
+ * MockDataStorage's queryEvents() (the shared EventPager semantics): a
+ * client following the tail cursor gets every event exactly once, events
+ * stamped in the same second as its cursor included; more than `count` new
+ * events are reported as truncated; the category filter is applied to the
+ * events and to the cursor's skip alike; the body carries `tail` and
+ * `truncated`.
+ */
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include "cJSON.h"
+#include "unity.h"
+
+#include "api/ApiDtos.h"
+#include "api/ApiSerialize.h"
+#include "api/EventTail.h"
+#include "interfaces/IDataStorage.h"
+#include "storage/testing/MockDataStorage.h"
+
+using api::EventTail;
+
+namespace {
+
+constexpr uint32_t kT0 = 1751000000u;
+
+EventTail tailOf(const MockDataStorage& store, const EventCursor& after, std::size_t count,
+                 uint32_t mask = EventQuery::kAllCategories)
+{
+    return api::resolveEventTail(
+        store.queryEvents(api::eventTailQuery(after, mask, count)), after, count);
+}
+
+void store(MockDataStorage& s, uint32_t epoch, const char* detail,
+           uint8_t category = IDataStorage::kCategoryPump)
+{
+    TEST_ASSERT_TRUE(s.storeEvent(epoch, category, detail));
+}
+
+void test_tail_follows_the_log_once(void)
+{
+    MockDataStorage log;
+    store(log, kT0, "a");
+    store(log, kT0 + 5, "b");
+    store(log, kT0 + 5, "c");
+
+    // From nothing: everything, newest first; the tail counts both at +5.
+    EventTail t = tailOf(log, EventCursor{0, 0}, 50);
+    TEST_ASSERT_EQUAL_size_t(3u, t.events.size());
+    TEST_ASSERT_EQUAL_STRING("c", t.events[0].detail.c_str());
+    TEST_ASSERT_EQUAL_STRING("a", t.events[2].detail.c_str());
+    TEST_ASSERT_EQUAL_UINT32(kT0 + 5, t.tail.epoch);
+    TEST_ASSERT_EQUAL_UINT32(2u, t.tail.skip);
+    TEST_ASSERT_FALSE(t.truncated);
+
+    // Nothing new: empty, the cursor unchanged.
+    const EventCursor tail = t.tail;
+    t = tailOf(log, tail, 50);
+    TEST_ASSERT_EQUAL_size_t(0u, t.events.size());
+    TEST_ASSERT_EQUAL_UINT32(tail.epoch, t.tail.epoch);
+    TEST_ASSERT_EQUAL_UINT32(tail.skip, t.tail.skip);
+
+    // One more in the cursor's own second, one later: exactly those two.
+    store(log, kT0 + 5, "d");
+    store(log, kT0 + 9, "e");
+    t = tailOf(log, tail, 50);
+    TEST_ASSERT_EQUAL_size_t(2u, t.events.size());
+    TEST_ASSERT_EQUAL_STRING("e", t.events[0].detail.c_str());
+    TEST_ASSERT_EQUAL_STRING("d", t.events[1].detail.c_str());
+    TEST_ASSERT_EQUAL_UINT32(kT0 + 9, t.tail.epoch);
+    TEST_ASSERT_EQUAL_UINT32(1u, t.tail.skip);
+
+    // Same second again: the skip keeps growing.
+    store(log, kT0 + 9, "f");
+    t = tailOf(log, t.tail, 50);
+    TEST_ASSERT_EQUAL_size_t(1u, t.events.size());
+    TEST_ASSERT_EQUAL_STRING("f", t.events[0].detail.c_str());
+    TEST_ASSERT_EQUAL_UINT32(2u, t.tail.skip);
+}
+
+void test_tail_truncates_past_count(void)
+{
+    MockDataStorage log;
+    store(log, kT0, "seen");
+    const EventCursor after{kT0, 1};
+    for (uint32_t i = 0; i < 5; ++i) {
+        store(log, kT0 + 1 + i, std::to_string(i).c_str());
+    }
+
+    EventTail t = tailOf(log, after, 3);
+    TEST_ASSERT_TRUE(t.truncated);
+    TEST_ASSERT_EQUAL_size_t(3u, t.events.size());
+    TEST_ASSERT_EQUAL_STRING("4", t.events[0].detail.c_str());
+    TEST_ASSERT_EQUAL_STRING("2", t.events[2].detail.c_str());
+    TEST_ASSERT_EQUAL_UINT32(kT0 + 5, t.tail.epoch);
+    TEST_ASSERT_EQUAL_UINT32(1u, t.tail.skip);
+
+    // Exactly count new ones fit: not truncated, the seen one left out.
+    t = tailOf(log, EventCursor{kT0 + 2, 1}, 3);
+    TEST_ASSERT_FALSE(t.truncated);
+    TEST_ASSERT_EQUAL_size_t(3u, t.events.size());
+    TEST_ASSERT_EQUAL_STRING("2", t.events[2].detail.c_str());
+}
+
+void test_tail_keeps_the_category_filter(void)
+{
+    MockDataStorage log;
+    const uint32_t failsafe = EventQuery::categoryBit(IDataStorage::kCategoryFailsafe);
+    store(log, kT0, "trip 1", IDataStorage::kCategoryFailsafe);
+    store(log, kT0, "pump", IDataStorage::kCategoryPump);
+
+    EventTail t = tailOf(log, EventCursor{0, 0}, 50, failsafe);
+    TEST_ASSERT_EQUAL_size_t(1u, t.events.size());
+    TEST_ASSERT_EQUAL_UINT32(1u, t.tail.skip);  // the selected events at kT0
+
+    // A pump event in the same second is not one of "the first skip".
+    store(log, kT0, "trip 2", IDataStorage::kCategoryFailsafe);
+    store(log, kT0, "pump again", IDataStorage::kCategoryPump);
+    t = tailOf(log, t.tail, 50, failsafe);
+    TEST_ASSERT_EQUAL_size_t(1u, t.events.size());
+    TEST_ASSERT_EQUAL_STRING("trip 2", t.events[0].detail.c_str());
+    TEST_ASSERT_EQUAL_UINT32(2u, t.tail.skip);
+}
+
+void test_tail_body_carries_cursor(void)
+{
+    std::vector<api::EventDto> events(1);
+    events[0].epoch = kT0;
+    events[0].category = 1;
+    events[0].detail = "plant start 30s";
+
+    cJSON* root = cJSON_Parse(api::serializeEventTail(events, "1751000000.2", true).c_str());
+    TEST_ASSERT_NOT_NULL(root);
+    TEST_ASSERT_TRUE(cJSON_IsTrue(cJSON_GetObjectItem(root, "success")));
+    TEST_ASSERT_EQUAL_INT(1, cJSON_GetArraySize(cJSON_GetObjectItem(root, "events")));
+    TEST_ASSERT_EQUAL_STRING("1751000000.2", cJSON_GetObjectItem(root, "tail")->valuestring);
+    TEST_ASSERT_TRUE(cJSON_IsTrue(cJSON_GetObjectItem(root, "truncated")));
+    TEST_ASSERT_NULL(cJSON_GetObjectItem(root, "next"));
+    cJSON_Delete(root);
+
+    root = cJSON_Parse(api::serializeEventTail({}, "0.0", false).c_str());
+    TEST_ASSERT_NOT_NULL(root);
+    TEST_ASSERT_EQUAL_INT(0, cJSON_GetArraySize(cJSON_GetObjectItem(root, "events")));
+    TEST_ASSERT_TRUE(cJSON_IsFalse(cJSON_GetObjectItem(root, "truncated")));
+    cJSON_Delete(root);
+}
+
+}  // namespace
+
+void run_event_tail_tests(void)
+{
+    RUN_TEST(test_tail_follows_the_log_once);
+    RUN_TEST(test_tail_truncates_past_count);
+    RUN_TEST(test_tail_keeps_the_category_filter);
+    RUN_TEST(test_tail_body_carries_cursor);
+}
@@ -0,0 +1,79 @@
+// SPDX-FileCopyrightText: 2026 Cryptotomte
+// SPDX-License-Identifier: AGPL-3.0-or-later
+/**
+ * @file test_flow_meter.cpp
+ * @brief Host suite for the pulse flow meter (sensors/FlowMeter.h).
+ *
+ * Registered by test_main.cpp via run_flow_meter_tests(). The volume is the
+ * live count over the K factor; the rate is published once per closed
+ * window, scaled to the window's real length, and holds between windows.
+ */
+
+#include <cstdint>
+
+#include "unity.h"
+
+#include "interfaces/IPulseCounter.h"
+#include "sensors/FlowMeter.h"
+
+namespace {
+
+struct ScriptedCounter : IPulseCounter {
+    uint32_t count = 0;
+
+    uint32_t pulses() override { return count; }
+};
+
+void test_volume_from_live_count(void)
+{
+    ScriptedCounter counter;
+    FlowMeter meter(counter, 450);
+    TEST_ASSERT_EQUAL_UINT32(0, meter.deliveredMl());
+
+    counter.count = 450;
+    TEST_ASSERT_EQUAL_UINT32(1000, meter.deliveredMl());  // no update() needed
+    counter.count = 449;
+    TEST_ASSERT_EQUAL_UINT32(997, meter.deliveredMl());   // truncated
+    counter.count = 4'000'000'000u;                       // no 32-bit overflow
+    TEST_ASSERT_EQUAL_UINT32(static_cast<uint32_t>(4'000'000'000ull * 1000 / 450),
+                             meter.deliveredMl());
+
+    ScriptedCounter raw;
+    FlowMeter unscaled(raw, 0);  // K of 0 is taken as 1
+    raw.count = 3;
+    TEST_ASSERT_EQUAL_UINT32(1, unscaled.pulsesPerLitre());
+    TEST_ASSERT_EQUAL_UINT32(3000, unscaled.deliveredMl());
+}
+
+void test_rate_per_window(void)
+{
+    ScriptedCounter counter;
+    FlowMeter meter(counter, 1000);  // 1 pulse = 1 ml
+    counter.count = 500;
+    meter.update(10'000);            // opens the first window
+    TEST_ASSERT_EQUAL_FLOAT(0.0f, meter.flowMlPerMin());
+
+    counter.count = 510;
+    meter.update(10'500);            // window still open
+    TEST_ASSERT_EQUAL_FLOAT(0.0f, meter.flowMlPerMin());
+    counter.count = 520;
+    meter.update(11'000);            // 20 ml in 1 s
+    TEST_ASSERT_EQUAL_FLOAT(1200.0f, meter.flowMlPerMin());
+
+    // A late update scales by the real span, and the rate holds meanwhile.
+    counter.count = 550;
+    meter.update(11'900);
+    TEST_ASSERT_EQUAL_FLOAT(1200.0f, meter.flowMlPerMin());
+    meter.update(12'500);            // 30 ml in 1.5 s
+    TEST_ASSERT_EQUAL_FLOAT(1200.0f, meter.flowMlPerMin());
+    meter.update(13'500);            // nothing flowed
+    TEST_ASSERT_EQUAL_FLOAT(0.0f, meter.flowMlPerMin());
+}
+
+}  // namespace
+
+void run_flow_meter_tests(void)
+{
+    RUN_TEST(test_volume_from_live_count);
+    RUN_TEST(test_rate_per_window);
+}
@@ -0,0 +1,277 @@
+// SPDX-FileCopyrightText: 2026 Cryptotomte
+// SPDX-License-Identifier: AGPL-3.0-or-later
+/**
+ * @file test_i2c_bus_master.cpp
+ * @brief Host suite for the shared I2C bus's transaction queue
+ *        (I2cBusMaster.h).
+ *
+ * Before a bus task serves, transactions run on the caller; once it does,
+ * they queue in arrival order and one serve() runs everything queued as a
+ * batch, with onDone on the serving thread. Queue wait and bus time are
+ * summed per device. The fast-mode probe keeps 400 kHz only when every
+ * device that identified at 100 kHz still does, and a BME280 driven
+ * through the port reads as it does on the bare bus.
+ */
+
+#include <atomic>
+#include <cstdint>
+#include <thread>
+#include <vector>
+
+#include "unity.h"
+
+#include "sensors/Bme280Sensor.h"
+#include "sensors/I2cBusMaster.h"
+#include "sensors/testing/MockI2cBus.h"
+
+namespace {
+
+int64_t gNowUs = 0;
+
+int64_t fakeClock()
+{
+    return gNowUs;
+}
+
+/// A mock whose register reads take @c readUs of the fake clock.
+class SlowI2cBus : public MockI2cBus {
+public:
+    int64_t readUs = 0;
+
+    bool readRegisters(uint8_t address7, uint8_t startReg, uint8_t* buf,
+                       size_t len) override
+    {
+        gNowUs += readUs;
+        return MockI2cBus::readRegisters(address7, startReg, buf, len);
+    }
+};
+
+void recordDone(I2cTransaction& txn, void* context)
+{
+    auto& order = *static_cast<std::vector<uint8_t>*>(context);
+    order.push_back(txn.address);
+}
+
+void readTxn(I2cTransaction& txn, uint8_t address, uint8_t reg, uint8_t* buf,
+             std::size_t len, std::vector<uint8_t>& order)
+{
+    txn.op = I2cTransaction::Op::Read;
+    txn.address = address;
+    txn.reg = reg;
+    txn.buffer = buf;
+    txn.len = len;
+    txn.onDone = &recordDone;
+    txn.context = &order;
+}
+
+void test_runs_inline_until_served()
+{
+    MockI2cBus mock;
+    mock.setRegister(0x76, 0xD0, 0x60);
+    I2cBusMaster bus(mock);
+    II2cBus& port = bus.port();
+
+    TEST_ASSERT_TRUE(port.probe(0x76));
+    TEST_ASSERT_FALSE(port.probe(0x77));
+    uint8_t id = 0;
+    TEST_ASSERT_TRUE(port.readRegisters(0x76, 0xD0, &id, 1));
+    TEST_ASSERT_EQUAL_UINT8(0x60, id);
+    TEST_ASSERT_TRUE(port.writeRegister(0x76, 0xF4, 0x57));
+    TEST_ASSERT_TRUE(port.writeRegister16(0x76, 0x10, 0xABCD));
+    TEST_ASSERT_EQUAL_UINT32(5, mock.calls.size());
+    TEST_ASSERT_EQUAL_UINT8(0x57, mock.calls[3].value);
+    TEST_ASSERT_EQUAL_UINT16(0xABCD, mock.calls[4].value16);
+    TEST_ASSERT_EQUAL_UINT32(0, bus.depth());
+    TEST_ASSERT_EQUAL_UINT32(0, bus.batches());  // none served by a task
+}
+
+void test_one_serve_runs_the_whole_queue_in_order()
+{
+    MockI2cBus mock;
+    mock.setRegisters(0x76, 0xF7, {1, 2, 3, 4, 5, 6, 7, 8});
+    mock.setRegister16(0x40, 0x02, 0x1234);
+    I2cBusMaster bus(mock);
+    TEST_ASSERT_EQUAL_size_t(0, bus.serve(0));  // the bus task is up
+
+    std::vector<uint8_t> order;
+    uint8_t env[8] = {};
+    uint8_t power[2] = {};
+    uint8_t env2[8] = {};
+    I2cTransaction a, b, c;
+    readTxn(a, 0x76, 0xF7, env, sizeof(env), order);
+    readTxn(b, 0x40, 0x02, power, sizeof(power), order);
+    readTxn(c, 0x76, 0xF7, env2, sizeof(env2), order);
+    bus.submit(a);
+    bus.submit(b);
+    bus.submit(c);
+    TEST_ASSERT_EQUAL_UINT32(3, bus.depth());
+    TEST_ASSERT_TRUE(mock.calls.empty());  // queued, not run
+    TEST_ASSERT_FALSE(a.done.load());
+
+    TEST_ASSERT_EQUAL_size_t(3, bus.serve(0));
+    const std::vector<uint8_t> expected = {0x76, 0x40, 0x76};
+    TEST_ASSERT_TRUE(order == expected);
+    TEST_ASSERT_TRUE(a.done.load() && b.done.load() && c.done.load());
+    TEST_ASSERT_TRUE(a.ok && b.ok && c.ok);
+    TEST_ASSERT_EQUAL_UINT8(8, env[7]);
+    TEST_ASSERT_EQUAL_UINT8(0x12, power[0]);
+    TEST_ASSERT_EQUAL_UINT8(0x34, power[1]);
+    TEST_ASSERT_EQUAL_UINT32(0, bus.depth());
+    TEST_ASSERT_EQUAL_UINT32(1, bus.batches());
+    TEST_ASSERT_EQUAL_size_t(0, bus.serve(0));
+    TEST_ASSERT_EQUAL_UINT32(1, bus.batches());
+}
+
+void test_bus_time_and_queue_wait_are_summed_per_device()
+{
+    SlowI2cBus mock;
+    mock.readUs = 200;
+    mock.addDevice(0x76);
+    mock.addDevice(0x40);
+    gNowUs = 1000;
+    I2cBusMaster bus(mock, &fakeClock);
+    bus.serve(0);
+
+    std::vector<uint8_t> order;
+    uint8_t buf[3][2] = {};
+    I2cTransaction power1, env, power2;
+    readTxn(power1, 0x40, 0x04, buf[0], 2, order);
+    readTxn(env, 0x76, 0xF7, buf[1], 2, order);
+    readTxn(power2, 0x40, 0x04, buf[2], 2, order);
+    bus.submit(power1);
+    bus.submit(env);
+    bus.submit(power2);
+    gNowUs += 50;  // the bus task wakes 50 us later
+    bus.serve(0);
+    TEST_ASSERT_EQUAL_INT64(50, power1.queueUs);
+    TEST_ASSERT_EQUAL_INT64(200, power1.busUs);
+    TEST_ASSERT_EQUAL_INT64(250, env.queueUs);  // waited out one INA226 read
+    TEST_ASSERT_EQUAL_INT64(450, power2.queueUs);
+
+    mock.queueReadOutcome(false);
+    uint8_t id = 0;
+    std::thread busTask([&] { bus.serve(1000); });
+    TEST_ASSERT_FALSE(bus.port().readRegisters(0x76, 0xD0, &id, 1));
+    busTask.join();
+
+    const std::vector<I2cDeviceStats> devices = bus.deviceStats();
+    TEST_ASSERT_EQUAL_size_t(2, devices.size());
+    TEST_ASSERT_EQUAL_UINT8(0x40, devices[0].address);  // first use first
+    TEST_ASSERT_EQUAL_UINT32(2, devices[0].transactions);
+    TEST_ASSERT_EQUAL_UINT64(400, devices[0].busUsTotal);
+    TEST_ASSERT_EQUAL_UINT64(500, devices[0].queueUsTotal);
+    TEST_ASSERT_EQUAL_UINT32(450, devices[0].queueUsMax);
+    TEST_ASSERT_EQUAL_UINT8(0x76, devices[1].address);
+    TEST_ASSERT_EQUAL_UINT32(2, devices[1].transactions);
+    TEST_ASSERT_EQUAL_UINT32(1, devices[1].errors);
+    TEST_ASSERT_EQUAL_UINT32(250, devices[1].queueUsMax);
+    TEST_ASSERT_EQUAL_UINT64(800, bus.busTimeUs());
+    TEST_ASSERT_EQUAL_UINT32(0, bus.untrackedTransactions());
+}
+
+void test_device_table_is_bounded()
+{
+    MockI2cBus mock;
+    I2cBusMaster bus(mock);
+    for (uint8_t a = 0; a <= I2cBusMaster::kMaxDevices; ++a) {
+        bus.port().probe(static_cast<uint8_t>(0x10 + a));
+    }
+    TEST_ASSERT_EQUAL_size_t(I2cBusMaster::kMaxDevices, bus.deviceStats().size());
+    TEST_ASSERT_EQUAL_UINT32(1, bus.untrackedTransactions());
+    TEST_ASSERT_EQUAL_UINT32(1, bus.deviceStats()[0].errors);  // NACK
+}
+
+const I2cIdentityCheck kChecks[] = {
+    {0x76, 0xD0, 1, 0x60},
+    {0x77, 0xD0, 1, 0x60},
+    {0x40, 0xFE, 2, 0x5449},
+};
+constexpr std::size_t kCheckCount = sizeof(kChecks) / sizeof(kChecks[0]);
+
+void test_fast_mode_is_kept_when_every_device_identifies()
+{
+    MockI2cBus mock;
+    mock.setRegister(0x77, 0xD0, 0x60);  // the BME280 on its second address
+    mock.setRegister16(0x40, 0xFE, 0x5449);
+    I2cBusMaster bus(mock);
+    TEST_ASSERT_EQUAL_UINT32(I2cBusMaster::kStandardModeHz, bus.clockSpeedHz());
+
+    TEST_ASSERT_EQUAL_UINT32(I2cBusMaster::kFastModeHz,
+                             bus.negotiateFastMode(kChecks, kCheckCount));
+    TEST_ASSERT_EQUAL_UINT32(I2cBusMaster::kFastModeHz, mock.clockSpeedHz);
+    TEST_ASSERT_EQUAL_UINT32(I2cBusMaster::kFastModeHz, bus.clockSpeedHz());
+    TEST_ASSERT_TRUE(bus.deviceStats().empty());  // checks are not traffic
+}
+
+void test_fast_mode_falls_back_when_a_device_drops_out()
+{
+    MockI2cBus mock;
+    mock.setRegister(0x76, 0xD0, 0x60);
+    mock.setRegister16(0x40, 0xFE, 0x5449);
+    mock.setMaxClockSpeed(0x40, I2cBusMaster::kStandardModeHz);
+    I2cBusMaster bus(mock);
+
+    TEST_ASSERT_EQUAL_UINT32(I2cBusMaster::kStandardModeHz,
+                             bus.negotiateFastMode(kChecks, kCheckCount));
+    TEST_ASSERT_EQUAL_UINT32(I2cBusMaster::kStandardModeHz, mock.clockSpeedHz);
+    TEST_ASSERT_TRUE(bus.port().probe(0x40));  // reachable again
+}
+
+void test_fast_mode_is_not_tried_without_evidence()
+{
+    MockI2cBus mock;  // nothing answers
+    I2cBusMaster bus(mock);
+    TEST_ASSERT_EQUAL_UINT32(I2cBusMaster::kStandardModeHz,
+                             bus.negotiateFastMode(kChecks, kCheckCount));
+    TEST_ASSERT_EQUAL_UINT32(I2cBusMaster::kStandardModeHz, mock.clockSpeedHz);
+
+    MockI2cBus fixed;  // a bus that cannot change speed
+    fixed.setRegister(0x76, 0xD0, 0x60);
+    fixed.clockSpeedSupported = false;
+    I2cBusMaster fixedBus(fixed);
+    TEST_ASSERT_EQUAL_UINT32(I2cBusMaster::kStandardModeHz,
+                             fixedBus.negotiateFastMode(kChecks, kCheckCount));
+}
+
+void test_bme280_reads_through_the_bus_task()
+{
+    // Datasheet-shaped calibration is not needed here: an all-zero trim
+    // compensates to a finite reading, which is all the port must carry.
+    MockI2cBus mock;
+    mock.setRegister(0x76, 0xD0, 0x60);
+    I2cBusMaster bus(mock);
+    Bme280Sensor sensor(bus.port());
+    TEST_ASSERT_TRUE(sensor.initialize());  // inline, before the task
+    bus.serve(0);
+
+    std::atomic<bool> stop{false};
+    std::thread busTask([&] {
+        while (!stop) {
+            bus.serve(5);
+        }
+    });
+    bool ok = true;
+    for (int i = 0; i < 4; ++i) {
+        ok = sensor.read() && ok;
+    }
+    stop = true;
+    busTask.join();
+    TEST_ASSERT_TRUE(ok);
+    TEST_ASSERT_EQUAL_UINT32(4, sensor.snapshot().sequence);
+    TEST_ASSERT_TRUE(bus.batches() >= 1);
+    TEST_ASSERT_EQUAL_UINT8(0x76, bus.deviceStats()[0].address);
+}
+
+}  // namespace
+
+void run_i2c_bus_master_tests(void)
+{
+    RUN_TEST(test_runs_inline_until_served);
+    RUN_TEST(test_one_serve_runs_the_whole_queue_in_order);
+    RUN_TEST(test_bus_time_and_queue_wait_are_summed_per_device);
+    RUN_TEST(test_device_table_is_bounded);
+    RUN_TEST(test_fast_mode_is_kept_when_every_device_identifies);
+    RUN_TEST(test_fast_mode_falls_back_when_a_device_drops_out);
+    RUN_TEST(test_fast_mode_is_not_tried_without_evidence);
+    RUN_TEST(test_bme280_reads_through_the_bus_task);
+}
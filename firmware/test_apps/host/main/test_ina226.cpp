@@ -24,6 +24,9 @@
  * recovery, mid-triple publish-last atomicity, mid-init write failure
  * (config leg and calibration leg) → error 2 + full-sequence re-run, live
  * isAvailable() probe, and the LockedPowerSensor delegation check.
+ * Sampling settings (config encoding, result period, live rewrite), the
+ * Mask/Enable conversion-ready alert and flag, and the over-current (SOL)
+ * alert limit.
  */
 
 #include <cmath>
@@ -31,6 +34,7 @@
 
 #include "unity.h"
 
+#include "actuators/testing/FakeTimeProvider.h"
 #include "sensors/Ina226Sensor.h"
 #include "sensors/LockedPowerSensor.h"
 #include "sensors/testing/MockI2cBus.h"
@@ -43,6 +47,8 @@ constexpr uint8_t kRegBusVoltage = 0x02;
 constexpr uint8_t kRegPower = 0x03;
 constexpr uint8_t kRegCurrent = 0x04;
 constexpr uint8_t kRegCalibration = 0x05;
+constexpr uint8_t kRegMaskEnable = 0x06;
+constexpr uint8_t kRegAlertLimit = 0x07;
 constexpr uint8_t kRegManufacturerId = 0xFE;
 constexpr uint8_t kRegDieId = 0xFF;
 
@@ -602,6 +608,179 @@ void test_ina226_is_available_live_probe(void)
     TEST_ASSERT_TRUE(sensor.read());
 }
 
+// --- sampling settings + conversion ready ----------------------------------
+
+void test_ina226_sampling_encodings_and_period(void)
+{
+    // AVG ×1024 (111), VBUSCT 140 µs (000), VSHCT 8.244 ms (111):
+    // 0x4000 | 0x0E00 | 0x0000 | 0x0038 | 0x0007 = 0x4E3F.
+    const Ina226Sampling slow{Ina226Averaging::X1024,
+                              Ina226ConversionTime::Us140,
+                              Ina226ConversionTime::Us8244};
+    TEST_ASSERT_EQUAL_HEX16(0x4E3F, slow.configValue());
+    TEST_ASSERT_EQUAL_UINT32(1024u * (140 + 8244), slow.periodUs());
+    TEST_ASSERT_EQUAL_HEX16(0x4527, ina226_sampling::kDefault.configValue());
+    TEST_ASSERT_EQUAL_UINT32(35200, ina226_sampling::kDefault.periodUs());
+}
+
+void test_ina226_set_sampling_rewrites_config(void)
+{
+    MockI2cBus bus;
+    script_identity(bus);
+    Ina226Sensor sensor(bus, kAddr, kShuntMilliOhm);
+    const Ina226Sampling fast{Ina226Averaging::X4, Ina226ConversionTime::Us588,
+                              Ina226ConversionTime::Us588};
+
+    // Before init: stored, written by initialize().
+    TEST_ASSERT_TRUE(sensor.setSampling(fast));
+    TEST_ASSERT_EQUAL_size_t(0, bus.calls.size());
+    TEST_ASSERT_EQUAL_UINT32(4u * 1176, sensor.conversionPeriodUs());
+    TEST_ASSERT_TRUE(sensor.initialize());
+    uint16_t config = 0;
+    TEST_ASSERT_TRUE(bus.readRegister16(kAddr, kRegConfig, config));
+    TEST_ASSERT_EQUAL_HEX16(fast.configValue(), config);
+
+    // Initialized: written at once; a failed write drops to uninitialized.
+    TEST_ASSERT_TRUE(sensor.setSampling(ina226_sampling::kDefault));
+    TEST_ASSERT_TRUE(bus.readRegister16(kAddr, kRegConfig, config));
+    TEST_ASSERT_EQUAL_HEX16(0x4527, config);
+    bus.queueWriteOutcome(false);
+    TEST_ASSERT_FALSE(sensor.setSampling(fast));
+    TEST_ASSERT_EQUAL_INT(2, sensor.getLastError());
+    const size_t probes = count_calls(bus, MockI2cBus::Call::Type::Probe);
+    script_readings(bus, 0x2580, 0x0F00, 0x1F40);
+    TEST_ASSERT_TRUE(sensor.read());  // re-probed and re-initialized
+    TEST_ASSERT_EQUAL_size_t(probes + 1,
+                             count_calls(bus, MockI2cBus::Call::Type::Probe));
+    TEST_ASSERT_TRUE(bus.readRegister16(kAddr, kRegConfig, config));
+    TEST_ASSERT_EQUAL_HEX16(fast.configValue(), config);
+}
+
+void test_ina226_conversion_ready_alert_and_flag(void)
+{
+    MockI2cBus bus;
+    script_identity(bus);
+    script_readings(bus, 0x2580, 0x0F00, 0x1F40);
+    Ina226Sensor sensor(bus, kAddr, kShuntMilliOhm);
+
+    // Uninitialized: due, so read() gets to re-probe.
+    TEST_ASSERT_TRUE(sensor.conversionReady());
+    TEST_ASSERT_TRUE(sensor.setConversionReadyAlert(true));
+    TEST_ASSERT_TRUE(sensor.initialize());
+    uint16_t mask = 0;
+    TEST_ASSERT_TRUE(bus.readRegister16(kAddr, kRegMaskEnable, mask));
+    TEST_ASSERT_EQUAL_HEX16(0x0400, mask);  // CNVR, written by init
+
+    // CVRF (bit 3) decides; the chip clears it on this read.
+    bus.setRegister16(kAddr, kRegMaskEnable, 0x0400);
+    TEST_ASSERT_FALSE(sensor.conversionReady());
+    bus.setRegister16(kAddr, kRegMaskEnable, 0x0408);
+    TEST_ASSERT_TRUE(sensor.conversionReady());
+    TEST_ASSERT_TRUE(sensor.read());
+
+    // Live disable; a failed flag read is due too (read() recovers).
+    TEST_ASSERT_TRUE(sensor.setConversionReadyAlert(false));
+    TEST_ASSERT_TRUE(bus.readRegister16(kAddr, kRegMaskEnable, mask));
+    TEST_ASSERT_EQUAL_HEX16(0x0000, mask);
+    bus.queueReadOutcome(false);
+    TEST_ASSERT_TRUE(sensor.conversionReady());
+    TEST_ASSERT_EQUAL_INT(0, sensor.getLastError());  // read() reports
+    const size_t probes = count_calls(bus, MockI2cBus::Call::Type::Probe);
+    TEST_ASSERT_TRUE(sensor.read());
+    TEST_ASSERT_EQUAL_size_t(probes + 1,
+                             count_calls(bus, MockI2cBus::Call::Type::Probe));
+}
+
+void test_ina226_over_current_limit(void)
+{
+    // LIMIT = A x mOhm x 400 (2.5 uV shunt LSB), rounded and clamped.
+    TEST_ASSERT_EQUAL_HEX16(16000, Ina226Sensor::alertLimitFor(8.0f, 5));
+    TEST_ASSERT_EQUAL_HEX16(1, Ina226Sensor::alertLimitFor(0.0001f, 5));
+    TEST_ASSERT_EQUAL_HEX16(0x7FFF, Ina226Sensor::alertLimitFor(20.0f, 5));
+    TEST_ASSERT_EQUAL_HEX16(0, Ina226Sensor::alertLimitFor(0.0f, 5));
+    TEST_ASSERT_EQUAL_HEX16(0, Ina226Sensor::alertLimitFor(NAN, 5));
+
+    MockI2cBus bus;
+    script_identity(bus);
+    script_readings(bus, 0x2580, 0x0F00, 0x1F40);
+    Ina226Sensor sensor(bus, kAddr, kShuntMilliOhm);
+
+    // Set before init: written by it, and SOL wins over CNVR.
+    TEST_ASSERT_TRUE(sensor.setConversionReadyAlert(true));
+    TEST_ASSERT_TRUE(sensor.setOverCurrentLimit(8.0f));
+    TEST_ASSERT_TRUE(sensor.initialize());
+    uint16_t limit = 0;
+    uint16_t mask = 0;
+    TEST_ASSERT_TRUE(bus.readRegister16(kAddr, kRegAlertLimit, limit));
+    TEST_ASSERT_EQUAL_UINT16(16000, limit);
+    TEST_ASSERT_TRUE(bus.readRegister16(kAddr, kRegMaskEnable, mask));
+    TEST_ASSERT_EQUAL_HEX16(0x8000, mask);  // SOL, transparent (LEN = 0)
+
+    // Live change; cleared, the conversion-ready alert is back.
+    TEST_ASSERT_TRUE(sensor.setOverCurrentLimit(4.0f));
+    TEST_ASSERT_TRUE(bus.readRegister16(kAddr, kRegAlertLimit, limit));
+    TEST_ASSERT_EQUAL_UINT16(8000, limit);
+    TEST_ASSERT_TRUE(sensor.setOverCurrentLimit(0.0f));
+    TEST_ASSERT_EQUAL_UINT16(0, sensor.overCurrentLimitRaw());
+    TEST_ASSERT_TRUE(bus.readRegister16(kAddr, kRegMaskEnable, mask));
+    TEST_ASSERT_EQUAL_HEX16(0x0400, mask);
+
+    // A failed write: error 2, and the next init re-arms the limit.
+    TEST_ASSERT_TRUE(sensor.setConversionReadyAlert(false));
+    bus.queueWriteOutcome(false);
+    TEST_ASSERT_FALSE(sensor.setOverCurrentLimit(6.0f));
+    TEST_ASSERT_EQUAL_INT(2, sensor.getLastError());
+    TEST_ASSERT_TRUE(sensor.read());
+    TEST_ASSERT_TRUE(bus.readRegister16(kAddr, kRegAlertLimit, limit));
+    TEST_ASSERT_EQUAL_UINT16(12000, limit);
+    TEST_ASSERT_TRUE(bus.readRegister16(kAddr, kRegMaskEnable, mask));
+    TEST_ASSERT_EQUAL_HEX16(0x8000, mask);
+}
+
+void test_ina226_high_rate_sampling_and_current_read(void)
+{
+    MockI2cBus bus;
+    script_identity(bus);
+    script_readings(bus, 0x2580, 0x0F00, 0x1F40);  // 12 V / 48 W / 4 A
+    Ina226Sensor sensor(bus, kAddr, kShuntMilliOhm);
+    const Ina226Sampling slow{Ina226Averaging::X64, Ina226ConversionTime::Us1100,
+                              Ina226ConversionTime::Us1100};
+    TEST_ASSERT_TRUE(sensor.setSampling(slow));
+    TEST_ASSERT_TRUE(sensor.read());
+
+    // Capture profile on, then back to the setting it replaced.
+    TEST_ASSERT_EQUAL_HEX16(0x4207, ina226_sampling::kCapture.configValue());
+    TEST_ASSERT_TRUE(sensor.setHighRateSampling(true));
+    TEST_ASSERT_EQUAL_UINT32(1120, sensor.conversionPeriodUs());
+    uint16_t config = 0;
+    TEST_ASSERT_TRUE(bus.readRegister16(kAddr, kRegConfig, config));
+    TEST_ASSERT_EQUAL_HEX16(0x4207, config);
+
+    // One Current-register read; the snapshot keeps the last full read.
+    bus.setRegister16(kAddr, kRegCurrent, 0xFC18);  // -1000 LSB = -0.5 A
+    const size_t readsBefore = count_calls(bus, MockI2cBus::Call::Type::Read);
+    float amps = 0.0f;
+    TEST_ASSERT_TRUE(sensor.readCurrent(amps));
+    TEST_ASSERT_FLOAT_WITHIN(0.0001f, -0.5f, amps);
+    TEST_ASSERT_EQUAL_size_t(readsBefore + 1,
+                             count_calls(bus, MockI2cBus::Call::Type::Read));
+    TEST_ASSERT_FLOAT_WITHIN(0.001f, 4.0f, sensor.getCurrent());
+    TEST_ASSERT_EQUAL_UINT32(1, sensor.snapshot().sequence);
+
+    TEST_ASSERT_TRUE(sensor.setHighRateSampling(false));
+    TEST_ASSERT_TRUE(bus.readRegister16(kAddr, kRegConfig, config));
+    TEST_ASSERT_EQUAL_HEX16(slow.configValue(), config);
+
+    // A failed current read is a read() failure: error 2, re-probe next.
+    bus.queueReadOutcome(false);
+    TEST_ASSERT_FALSE(sensor.readCurrent(amps));
+    TEST_ASSERT_EQUAL_INT(2, sensor.getLastError());
+    const size_t probes = count_calls(bus, MockI2cBus::Call::Type::Probe);
+    TEST_ASSERT_TRUE(sensor.readCurrent(amps));
+    TEST_ASSERT_EQUAL_size_t(probes + 1,
+                             count_calls(bus, MockI2cBus::Call::Type::Probe));
+}
+
 // --- LockedPowerSensor: pure delegation ------------------------------------
 
 void test_locked_power_sensor_delegates(void)
@@ -610,7 +789,8 @@ void test_locked_power_sensor_delegates(void)
     script_identity(bus);
     script_readings(bus, 0x2580, 0x0F00, 0x1F40);
     Ina226Sensor raw(bus, kAddr, kShuntMilliOhm);
-    LockedPowerSensor sensor(raw);
+    FakeTimeProvider clock;
+    LockedPowerSensor sensor(raw, clock);
 
     TEST_ASSERT_TRUE(sensor.initialize());
     TEST_ASSERT_TRUE(sensor.isAvailable());
@@ -619,6 +799,28 @@ void test_locked_power_sensor_delegates(void)
     TEST_ASSERT_FLOAT_WITHIN(0.001f, 12.0f, sensor.getBusVoltage());
     TEST_ASSERT_FLOAT_WITHIN(0.001f, 4.0f, sensor.getCurrent());
     TEST_ASSERT_FLOAT_WITHIN(0.001f, 48.0f, sensor.getPower());
+
+    const PowerSnapshot snap = sensor.snapshot();
+    TEST_ASSERT_TRUE(snap.valid);
+    TEST_ASSERT_EQUAL_UINT32(1, snap.sequence);
+    TEST_ASSERT_EQUAL_INT64(clock.nowMs(), snap.atMs);
+    TEST_ASSERT_FLOAT_WITHIN(0.001f, 12.0f, snap.busVoltage);
+    TEST_ASSERT_FLOAT_WITHIN(0.001f, 4.0f, snap.current);
+    TEST_ASSERT_FLOAT_WITHIN(0.001f, 48.0f, snap.power);
+
+    TEST_ASSERT_EQUAL_UINT32(35200, sensor.conversionPeriodUs());
+    TEST_ASSERT_TRUE(sensor.setConversionReadyAlert(true));
+    bus.setRegister16(kAddr, kRegMaskEnable, 0x0408);
+    TEST_ASSERT_TRUE(sensor.conversionReady());
+    TEST_ASSERT_TRUE(sensor.setOverCurrentLimit(8.0f));
+    TEST_ASSERT_EQUAL_UINT16(16000, raw.overCurrentLimitRaw());
+
+    TEST_ASSERT_TRUE(sensor.setHighRateSampling(true));
+    TEST_ASSERT_EQUAL_UINT32(1120, sensor.conversionPeriodUs());
+    float amps = 0.0f;
+    TEST_ASSERT_TRUE(sensor.readCurrent(amps));
+    TEST_ASSERT_FLOAT_WITHIN(0.001f, 4.0f, amps);
+    TEST_ASSERT_EQUAL_UINT32(1, sensor.snapshot().sequence);
 }
 
 }  // namespace
@@ -648,5 +850,10 @@ void run_ina226_tests(void)
     RUN_TEST(test_ina226_mid_read_bus_error_lastgood_and_recovery);
     RUN_TEST(test_ina226_mid_triple_read_failure_keeps_full_lastgood_triple);
     RUN_TEST(test_ina226_is_available_live_probe);
+    RUN_TEST(test_ina226_sampling_encodings_and_period);
+    RUN_TEST(test_ina226_set_sampling_rewrites_config);
+    RUN_TEST(test_ina226_conversion_ready_alert_and_flag);
+    RUN_TEST(test_ina226_over_current_limit);
+    RUN_TEST(test_ina226_high_rate_sampling_and_current_read);
     RUN_TEST(test_locked_power_sensor_delegates);
 }
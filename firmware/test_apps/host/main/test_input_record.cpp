@@ -0,0 +1,348 @@
+// SPDX-FileCopyrightText: 2026 Cryptotomte
+// SPDX-License-Identifier: AGPL-3.0-or-later
+/**
+ * @file test_input_record.cpp
+ * @brief Host suite for the watering input recording: InputRecorder, its
+ *        reader, the BlockRingFile it is flushed to, and the
+ *        /api/v1/recording body.
+ *
+ * Registered by test_main.cpp via run_input_record_tests(). What the
+ * recorder was given reads back tick by tick (clock steps, config and
+ * level changes, new samples only, pump changes); a reader that starts
+ * past a lost block resyncs from the keyframe with the full state; the
+ * file keeps the newest blocks across a reopen; and the body is the file
+ * then the RAM blocks it lacks, each block once.
+ */
+
+#include <unistd.h>
+
+#include <cstdint>
+#include <cstdio>
+#include <string>
+#include <vector>
+
+#include "unity.h"
+
+#include "api/ApiStream.h"
+#include "control/InputRecord.h"
+#include "control/InputRecorder.h"
+#include "storage/BlockRingFile.h"
+
+namespace {
+
+using input_record::ConfigItem;
+
+RecordedConfig configWith(float high)
+{
+    RecordedConfig config;
+    config.set(ConfigItem::ThresholdLow, 30.0f);
+    config.set(ConfigItem::ThresholdHigh, high);
+    config.set(ConfigItem::WateringDurationS, 30.0f);
+    config.set(ConfigItem::MinWateringIntervalS, 300.0f);
+    config.set(ConfigItem::WateringEnabled, 1.0f);
+    config.set(ConfigItem::SensorReadIntervalMs, 5000.0f);
+    return config;
+}
+
+TimedSoilSnapshot sampleAt(int64_t atMs, uint32_t sequence, float moisture)
+{
+    TimedSoilSnapshot s;
+    s.soil.readOk = true;
+    s.soil.available = true;
+    s.soil.moisture = moisture;
+    s.atMs = atMs;
+    s.sequence = sequence;
+    return s;
+}
+
+RecordedSetup twoZones()
+{
+    RecordedSetup setup;
+    setup.predictive = true;
+    setup.pumpBudget = 1;
+    setup.schedule = "06:00-08:00";
+    setup.zoneCount = 2;
+    setup.zones[1] = ZoneSettings{35.0f, 55.0f, 20};
+    return setup;
+}
+
+/// Every held block, oldest first, as the recorder task would flush them.
+std::vector<uint8_t> heldBlocks(const InputRecorder& recorder)
+{
+    std::vector<uint8_t> bytes;
+    uint8_t block[input_record::kBlockBytes];
+    for (uint32_t s = recorder.oldest(); s != 0 && s <= recorder.newest(); ++s) {
+        const std::size_t n = recorder.copyBlock(s, block);
+        bytes.insert(bytes.end(), block, block + n);
+    }
+    return bytes;
+}
+
+/// A fresh path under /tmp, removed with the object.
+class TempPath {
+public:
+    TempPath()
+    {
+        char templ[] = "/tmp/ws_recording_XXXXXX";
+        const int fd = ::mkstemp(templ);
+        TEST_ASSERT_TRUE_MESSAGE(fd >= 0, "mkstemp failed");
+        ::close(fd);
+        std::remove(templ);
+        path_ = templ;
+    }
+    ~TempPath() { std::remove(path_.c_str()); }
+    TempPath(const TempPath&) = delete;
+    TempPath& operator=(const TempPath&) = delete;
+
+    const std::string& path() const { return path_; }
+
+private:
+    std::string path_;
+};
+
+void test_ticks_read_back_as_recorded(void)
+{
+    InputRecorder recorder(4);
+    recorder.setSetup(twoZones());
+    RecordedLevels levels;
+    levels.lowValid = true;
+    levels.lowWet = true;
+    levels.highValid = true;
+
+    // Tick 1: both zones read, clock unset.
+    recorder.beginTick(10'000, 0, configWith(55.0f), &levels);
+    recorder.soil(0, sampleAt(9'960, 1, 28.5f));
+    recorder.soil(1, sampleAt(9'900, 1, 40.0f));
+    recorder.pump(0, true);
+    recorder.pump(1, false);
+    // Tick 2: the clock is set, zone 0 restated (not new), zone 1 reads.
+    recorder.beginTick(15'000, 1'780'290'000, configWith(55.0f), &levels);
+    recorder.soil(0, sampleAt(9'960, 1, 28.5f));
+    recorder.soil(1, sampleAt(14'950, 2, 40.5f));
+    recorder.pump(0, true);
+    recorder.pump(1, false);
+    // Tick 3, 5.5 s on: the clock follows; config and level change.
+    levels.highWet = true;
+    recorder.beginTick(20'500, 1'780'290'005, configWith(60.0f), &levels);
+    recorder.pump(0, false);
+    // Tick 4 opens the next; tick 3 is finished.
+    recorder.beginTick(25'000, 1'780'290'010, configWith(60.0f), &levels);
+
+    const std::vector<uint8_t> bytes = heldBlocks(recorder);
+    InputRecordReader in(bytes.data(), bytes.size());
+    RecordedTick tick;
+
+    TEST_ASSERT_TRUE(in.next(tick));
+    TEST_ASSERT_TRUE(tick.boot);
+    TEST_ASSERT_FALSE(tick.resync);
+    TEST_ASSERT_TRUE(tick.atMs == 10'000);
+    TEST_ASSERT_EQUAL_UINT32(0, tick.epoch);
+    TEST_ASSERT_EQUAL_size_t(2, in.setup().zoneCount);
+    TEST_ASSERT_EQUAL_STRING("06:00-08:00", in.setup().schedule.c_str());
+    TEST_ASSERT_EQUAL_UINT8(1, in.setup().pumpBudget);
+    TEST_ASSERT_TRUE(in.setup().predictive);
+    TEST_ASSERT_EQUAL_FLOAT(35.0f, in.setup().zones[1].moistureThresholdLow);
+    TEST_ASSERT_EQUAL_UINT32(20, in.setup().zones[1].wateringDurationS);
+    TEST_ASSERT_TRUE(in.hasReservoir());
+    TEST_ASSERT_TRUE(in.levels().lowWet);
+    TEST_ASSERT_TRUE(in.levels().highValid);
+    TEST_ASSERT_FALSE(in.levels().highWet);
+    TEST_ASSERT_EQUAL_FLOAT(28.5f, in.soil(0).soil.moisture);
+    TEST_ASSERT_TRUE(in.soil(0).atMs == 9'960);
+    TEST_ASSERT_TRUE(in.soil(0).soil.readOk);
+    TEST_ASSERT_EQUAL_FLOAT(55.0f, in.config().get(ConfigItem::ThresholdHigh));
+    TEST_ASSERT_TRUE(in.pumpRunning(0));
+    TEST_ASSERT_FALSE(in.pumpRunning(1));
+    const uint32_t zone0 = in.soil(0).sequence;
+    const uint32_t zone1 = in.soil(1).sequence;
+
+    TEST_ASSERT_TRUE(in.next(tick));
+    TEST_ASSERT_FALSE(tick.boot);
+    TEST_ASSERT_EQUAL_UINT32(1'780'290'000, tick.epoch);
+    // Only a new sample moves a zone's sequence.
+    TEST_ASSERT_EQUAL_UINT32(zone0, in.soil(0).sequence);
+    TEST_ASSERT_EQUAL_UINT32(zone1 + 1, in.soil(1).sequence);
+    TEST_ASSERT_EQUAL_FLOAT(40.5f, in.soil(1).soil.moisture);
+    TEST_ASSERT_TRUE(in.soil(1).atMs == 14'950);
+
+    TEST_ASSERT_TRUE(in.next(tick));
+    TEST_ASSERT_TRUE(tick.atMs == 20'500);
+    TEST_ASSERT_EQUAL_UINT32(1'780'290'005, tick.epoch);
+    TEST_ASSERT_EQUAL_FLOAT(60.0f, in.config().get(ConfigItem::ThresholdHigh));
+    TEST_ASSERT_TRUE(in.levels().highWet);
+    TEST_ASSERT_FALSE(in.pumpRunning(0));
+
+    // The open tick is not in the recording yet.
+    TEST_ASSERT_FALSE(in.next(tick));
+    TEST_ASSERT_NULL(in.error());
+}
+
+void test_reader_resyncs_past_a_lost_block(void)
+{
+    InputRecorder recorder(2);
+    recorder.setSetup(twoZones());
+    RecordedLevels levels;
+    levels.lowValid = true;
+    levels.lowWet = true;
+    int64_t at = 5'000;
+    uint32_t sequence = 0;
+    float moisture = 40.0f;
+    // Enough ticks to roll blocks out of a two-block ring.
+    while (recorder.newest() < 5) {
+        recorder.beginTick(at, 0, configWith(at < 20'000 ? 50.0f : 58.0f), &levels);
+        moisture += 0.125f;
+        recorder.soil(0, sampleAt(at - 40, ++sequence, moisture));
+        recorder.pump(7, sequence % 2 == 0);
+        at += 5'000;
+    }
+    recorder.beginTick(at, 0, configWith(58.0f), &levels);
+    TEST_ASSERT_EQUAL_UINT32(4, recorder.oldest());
+
+    const std::vector<uint8_t> bytes = heldBlocks(recorder);
+    InputRecordReader in(bytes.data(), bytes.size());
+    RecordedTick tick;
+    TEST_ASSERT_TRUE(in.next(tick));
+    TEST_ASSERT_FALSE(tick.boot);
+    TEST_ASSERT_TRUE(tick.resync);
+    TEST_ASSERT_EQUAL_UINT32(4, tick.block);
+    // The keyframe restates everything the tick builds on.
+    TEST_ASSERT_EQUAL_size_t(2, in.setup().zoneCount);
+    TEST_ASSERT_EQUAL_FLOAT(58.0f, in.config().get(ConfigItem::ThresholdHigh));
+    TEST_ASSERT_TRUE(in.hasReservoir());
+    TEST_ASSERT_TRUE(in.levels().lowWet);
+    TEST_ASSERT_NOT_EQUAL(0, in.soil(0).sequence);
+
+    std::size_t ticks = 1;
+    int64_t last = tick.atMs;
+    while (in.next(tick)) {
+        TEST_ASSERT_FALSE(tick.resync);
+        TEST_ASSERT_TRUE(tick.atMs == last + 5'000);
+        last = tick.atMs;
+        ++ticks;
+    }
+    TEST_ASSERT_NULL(in.error());
+    TEST_ASSERT_TRUE(last == at - 5'000);
+    TEST_ASSERT_EQUAL_FLOAT(moisture, in.soil(0).soil.moisture);
+    TEST_ASSERT_TRUE(ticks > 1);
+
+    // A corrupted header stops the reader with an error.
+    std::vector<uint8_t> bad = bytes;
+    bad[0] = 'X';
+    InputRecordReader broken(bad.data(), bad.size());
+    TEST_ASSERT_FALSE(broken.next(tick));
+    TEST_ASSERT_NOT_NULL(broken.error());
+}
+
+void test_block_file_keeps_the_newest_blocks(void)
+{
+    TempPath path;
+    {
+        BlockRingFile file(path.path(), 3, 16);
+        TEST_ASSERT_TRUE(file.open());
+        TEST_ASSERT_EQUAL_size_t(0, file.count());
+        for (uint8_t i = 1; i <= 5; ++i) {
+            const uint8_t block[2] = {i, i};
+            TEST_ASSERT_TRUE(file.append(block, i == 5 ? 1 : 2, 100 + i));
+        }
+        const uint8_t tooBig[17] = {};
+        TEST_ASSERT_FALSE(file.append(tooBig, sizeof(tooBig), 0));
+    }
+
+    // Reopened: the newest three, oldest first; no mark this boot.
+    BlockRingFile file(path.path(), 3, 16);
+    TEST_ASSERT_TRUE(file.open());
+    TEST_ASSERT_EQUAL_size_t(3, file.count());
+    std::string seen;
+    const uint32_t mark = file.forEach([&seen](const uint8_t* data, std::size_t len) {
+        seen += std::to_string(data[0]) + ":" + std::to_string(len) + " ";
+        return true;
+    });
+    TEST_ASSERT_EQUAL_STRING("3:2 4:2 5:1 ", seen.c_str());
+    TEST_ASSERT_EQUAL_UINT32(0, mark);
+
+    const uint8_t block[1] = {6};
+    TEST_ASSERT_TRUE(file.append(block, 1, 7));
+    seen.clear();
+    TEST_ASSERT_EQUAL_UINT32(7, file.forEach([&seen](const uint8_t* data, std::size_t) {
+        seen += std::to_string(data[0]) + " ";
+        return true;
+    }));
+    TEST_ASSERT_EQUAL_STRING("4 5 6 ", seen.c_str());
+
+    // Another geometry starts the file over.
+    BlockRingFile resized(path.path(), 4, 16);
+    TEST_ASSERT_TRUE(resized.open());
+    TEST_ASSERT_EQUAL_size_t(0, resized.count());
+}
+
+struct StringSink final : api::IChunkSink {
+    std::string body;
+
+    bool send(const char* data, std::size_t len) override
+    {
+        body.append(data, len);
+        return true;
+    }
+};
+
+void test_stream_sends_each_block_once(void)
+{
+    InputRecorder recorder(3);
+    recorder.setSetup(twoZones());
+    uint32_t sequence = 0;
+    int64_t at = 5'000;
+    auto tickUntil = [&](uint32_t block) {
+        while (recorder.newest() < block) {
+            recorder.beginTick(at, 0, configWith(55.0f), nullptr);
+            ++sequence;
+            recorder.soil(0, sampleAt(at - 40, sequence, 30.0f + sequence * 0.25f));
+            at += 5'000;
+        }
+    };
+
+    // The file took blocks 1 and 2; the RAM ring now holds 2..4.
+    TempPath path;
+    BlockRingFile file(path.path(), 8, input_record::kBlockBytes);
+    TEST_ASSERT_TRUE(file.open());
+    tickUntil(3);
+    uint8_t block[input_record::kBlockBytes];
+    for (uint32_t s = 1; s <= 2; ++s) {
+        const std::size_t n = recorder.copyBlock(s, block);
+        TEST_ASSERT_TRUE(file.append(block, n, s));
+    }
+    tickUntil(4);
+    TEST_ASSERT_EQUAL_UINT32(2, recorder.oldest());
+
+    StringSink sink;
+    TEST_ASSERT_TRUE(api::streamInputRecording(recorder, &file, sink));
+    const auto* data = reinterpret_cast<const uint8_t*>(sink.body.data());
+    InputRecordReader in(data, sink.body.size());
+    RecordedTick tick;
+    uint32_t ticks = 0;
+    int64_t last = 0;
+    while (in.next(tick)) {
+        TEST_ASSERT_FALSE(tick.resync);
+        TEST_ASSERT_TRUE(tick.atMs > last);
+        last = tick.atMs;
+        ++ticks;
+    }
+    TEST_ASSERT_NULL(in.error());
+    TEST_ASSERT_EQUAL_size_t(4, in.blocks());
+    // Every finished tick: all but the open one.
+    TEST_ASSERT_EQUAL_UINT32(sequence - 1, ticks);
+
+    // RAM only: the blocks still held.
+    StringSink ram;
+    TEST_ASSERT_TRUE(api::streamInputRecording(recorder, nullptr, ram));
+    TEST_ASSERT_EQUAL_size_t(heldBlocks(recorder).size(), ram.body.size());
+}
+
+}  // namespace
+
+void run_input_record_tests(void)
+{
+    RUN_TEST(test_ticks_read_back_as_recorded);
+    RUN_TEST(test_reader_resyncs_past_a_lost_block);
+    RUN_TEST(test_block_file_keeps_the_newest_blocks);
+    RUN_TEST(test_stream_sends_each_block_once);
+}
@@ -0,0 +1,168 @@
+// SPDX-FileCopyrightText: 2026 Cryptotomte
+// SPDX-License-Identifier: AGPL-3.0-or-later
+/**
+ * @file test_json_scanner.cpp
+ * @brief Host suite for the request-body JSON scanner (JsonScanner.h) and
+ *        the raw query splitter (findQueryValue).
+ *
+ * Members are found by decoded key with first-match semantics and walked in
+ * order across nested values; numbers, literals and escaped strings read
+ * back; malformed text, trailing bytes, unescaped control characters and
+ * bad numbers are rejected; the token and depth limits fail as full(). The
+ * query splitter views values in place and matches whole keys only.
+ */
+
+#include <string>
+#include <string_view>
+
+#include "unity.h"
+
+#include "api/ApiRequests.h"
+#include "api/JsonScanner.h"
+
+namespace {
+
+using api::JsonScanner;
+
+void test_members_by_key_and_in_order()
+{
+    JsonScanner json;
+    TEST_ASSERT_TRUE(json.parse(
+        " {\"a\":{\"x\":[1,{\"y\":2}]},\"b\":true,\"c\":\"s\",\"b\":false}\n"));
+    TEST_ASSERT_TRUE(json.type(JsonScanner::root()) == JsonScanner::Type::Object);
+
+    const std::size_t b = json.member(JsonScanner::root(), "b");
+    TEST_ASSERT_TRUE(b != JsonScanner::kNone);
+    TEST_ASSERT_TRUE(json.type(b) == JsonScanner::Type::True);  // first "b" wins
+    TEST_ASSERT_TRUE(json.member(JsonScanner::root(), "x") == JsonScanner::kNone);
+    TEST_ASSERT_TRUE(json.member(json.member(JsonScanner::root(), "c"), "s") ==
+                     JsonScanner::kNone);  // not an object
+
+    // Keys in document order, the nested subtree skipped.
+    const char* expected[] = {"a", "b", "c", "b"};
+    std::size_t seen = 0;
+    for (std::size_t k = json.firstMember(JsonScanner::root()); k != JsonScanner::kNone;
+         k = json.nextMember(JsonScanner::root(), k)) {
+        TEST_ASSERT_TRUE(seen < 4);
+        TEST_ASSERT_TRUE(json.equals(k, expected[seen]));
+        ++seen;
+    }
+    TEST_ASSERT_EQUAL_UINT32(4, seen);
+
+    JsonScanner empty;
+    TEST_ASSERT_TRUE(empty.parse("{}"));
+    TEST_ASSERT_TRUE(empty.firstMember(JsonScanner::root()) == JsonScanner::kNone);
+}
+
+void test_values_read_back()
+{
+    JsonScanner json;
+    TEST_ASSERT_TRUE(json.parse(
+        "{\"n\":-12.5e1,\"z\":0,\"t\":null,\"k\\u0065y\":\"a\\\"b\\n\\u00e5\\ud83d\\ude00\"}"));
+    double v = 0.0;
+    TEST_ASSERT_TRUE(json.number(json.member(JsonScanner::root(), "n"), v));
+    TEST_ASSERT_EQUAL_FLOAT(-125.0f, static_cast<float>(v));
+    TEST_ASSERT_TRUE(json.number(json.member(JsonScanner::root(), "z"), v));
+    TEST_ASSERT_EQUAL_FLOAT(0.0f, static_cast<float>(v));
+    const std::size_t t = json.member(JsonScanner::root(), "t");
+    TEST_ASSERT_TRUE(json.type(t) == JsonScanner::Type::Null);
+    TEST_ASSERT_FALSE(json.number(t, v));
+    TEST_ASSERT_FALSE(json.isBool(t));
+
+    // The escaped key matches its decoded form; the value decodes to UTF-8.
+    const std::size_t s = json.member(JsonScanner::root(), "key");
+    TEST_ASSERT_TRUE(s != JsonScanner::kNone);
+    const char decoded[] = "a\"b\n\xC3\xA5\xF0\x9F\x98\x80";
+    TEST_ASSERT_TRUE(json.equals(s, decoded));
+    TEST_ASSERT_FALSE(json.equals(s, "a\"b"));
+    char buf[16];
+    std::size_t len = 0;
+    TEST_ASSERT_TRUE(json.copyString(s, buf, sizeof buf, len));
+    TEST_ASSERT_EQUAL_STRING(decoded, buf);
+    TEST_ASSERT_EQUAL_UINT32(sizeof decoded - 1, len);
+    TEST_ASSERT_FALSE(json.copyString(s, buf, 4, len));  // does not fit
+}
+
+void test_malformed_text_is_rejected()
+{
+    const char* bad[] = {
+        "",
+        "   ",
+        "{",
+        "{\"a\":1,}",
+        "{\"a\" 1}",
+        "{a:1}",
+        "[1 2]",
+        "{\"a\":1} x",
+        "{\"a\":01}",
+        "{\"a\":1.}",
+        "{\"a\":-}",
+        "{\"a\":1e}",
+        "{\"a\":tru}",
+        "{\"a\":\"\\x\"}",
+        "{\"a\":\"\\u12G4\"}",
+        "{\"a\":\"unterminated}",
+        "{\"a\":\"tab\there\"}",
+    };
+    for (const char* text : bad) {
+        JsonScanner json;
+        TEST_ASSERT_FALSE_MESSAGE(json.parse(text), text);
+        TEST_ASSERT_FALSE_MESSAGE(json.full(), text);
+    }
+    // An embedded NUL is a raw control character, not the end of the text.
+    JsonScanner json;
+    TEST_ASSERT_FALSE(json.parse(std::string_view("{\"a\":1}\0", 8)));
+}
+
+void test_limits_fail_as_full()
+{
+    std::string wide = "[";
+    for (std::size_t i = 0; i < JsonScanner::kMaxTokens; ++i) {
+        wide += i == 0 ? "1" : ",1";
+    }
+    wide += "]";
+    JsonScanner json;
+    TEST_ASSERT_FALSE(json.parse(wide));  // the array itself is one more token
+    TEST_ASSERT_TRUE(json.full());
+
+    std::string deep(JsonScanner::kMaxDepth + 1, '[');
+    deep += std::string(JsonScanner::kMaxDepth + 1, ']');
+    TEST_ASSERT_FALSE(json.parse(deep));
+    TEST_ASSERT_TRUE(json.full());
+
+    std::string fits(JsonScanner::kMaxDepth, '[');
+    fits += std::string(JsonScanner::kMaxDepth, ']');
+    TEST_ASSERT_TRUE(json.parse(fits));
+    TEST_ASSERT_FALSE(json.full());
+}
+
+void test_find_query_value()
+{
+    const std::string_view query = "metric=soil_ph&range=24h&flag&range=7d&x=";
+    std::string_view value = "untouched";
+    TEST_ASSERT_TRUE(api::findQueryValue(query, "metric", value));
+    TEST_ASSERT_TRUE(value == "soil_ph");
+    TEST_ASSERT_TRUE(value.data() == query.data() + 7);  // a view, not a copy
+    TEST_ASSERT_TRUE(api::findQueryValue(query, "range", value));
+    TEST_ASSERT_TRUE(value == "24h");  // the first pair wins
+    TEST_ASSERT_TRUE(api::findQueryValue(query, "x", value));
+    TEST_ASSERT_TRUE(value.empty());
+
+    value = "untouched";
+    TEST_ASSERT_FALSE(api::findQueryValue(query, "flag", value));  // no '='
+    TEST_ASSERT_FALSE(api::findQueryValue(query, "rang", value));
+    TEST_ASSERT_FALSE(api::findQueryValue(query, "tric", value));
+    TEST_ASSERT_FALSE(api::findQueryValue("", "metric", value));
+    TEST_ASSERT_TRUE(value == "untouched");
+}
+
+}  // namespace
+
+void run_json_scanner_tests(void)
+{
+    RUN_TEST(test_members_by_key_and_in_order);
+    RUN_TEST(test_values_read_back);
+    RUN_TEST(test_malformed_text_is_rejected);
+    RUN_TEST(test_limits_fail_as_full);
+    RUN_TEST(test_find_query_value);
+}
@@ -24,7 +24,10 @@
  * truth-table states across two instances, with coherent validity), and
  * T022 the per-board fail-direction truths (docs/parity-checklist.md §3,
  * "Pull-up + active-HIGH consequence" item, pinned as host-tested
- * constants).
+ * constants). Edge capture: windows open at the recorded edge times, a
+ * hold seen only by the edges still completes, a lost edge is caught by
+ * the read() backstop, and queued edges never shorten the settle gate.
+ * The ILevelObserver hook sees each reported change once.
  *
  * Timing convention (DebouncedLevelSensor contract): a window of N ms is
  * complete on the first update() where at least N ms have elapsed since
@@ -32,11 +35,13 @@
  */
 
 #include <cstdint>
+#include <deque>
 
 #include "unity.h"
 
 #include "actuators/testing/FakeTimeProvider.h"
 #include "interfaces/IDigitalInput.h"
+#include "interfaces/ILevelObserver.h"
 #include "sensors/DebouncedLevelSensor.h"
 #include "sensors/LockedLevelSensor.h"
 #include "sensors/testing/MockLevelSensor.h"
@@ -54,6 +59,31 @@ struct ScriptedInput : IDigitalInput {
     bool read() override { return level; }
 };
 
+/// Edge-capturing input: each edge() is queued at its time and moves the
+/// live level, as GpioLevelSensor's interrupt mode does.
+struct EdgeInput : ScriptedInput {
+    std::deque<DigitalEdge> edges;
+
+    void edge(int64_t atMs, bool to)
+    {
+        DigitalEdge e;
+        e.atMs = atMs;
+        e.level = to;
+        edges.push_back(e);
+        level = to;
+    }
+
+    bool nextEdge(DigitalEdge& edge) override
+    {
+        if (edges.empty()) {
+            return false;
+        }
+        edge = edges.front();
+        edges.pop_front();
+        return true;
+    }
+};
+
 /// Advance the fake clock by @p ms, then poll once (the owner's cadence).
 void step(DebouncedLevelSensor& sensor, FakeTimeProvider& time, int64_t ms)
 {
@@ -545,6 +575,138 @@ void test_raw_state_is_undebounced(void)
     TEST_ASSERT_FALSE(sensor.isWaterPresent());
 }
 
+// ---------------------------------------------------------------------------
+// Edge capture: the debounce runs on the recorded edge times
+// ---------------------------------------------------------------------------
+
+void test_edge_times_open_the_window(void)
+{
+    EdgeInput input;
+    FakeTimeProvider time;
+    DebouncedLevelSensor sensor(input, time, /*activeLow=*/false,
+                                kDebounceMs, /*settleMs=*/0);
+    reach_tracking(sensor, input, time, /*raw=*/false);
+
+    // Water at +10 ms, the next update 90 ms later: the window opened at
+    // the edge, so 300 ms after it — not after the poll — it completes.
+    const int64_t t0 = time.nowMs();
+    input.edge(t0 + 10, true);
+    step(sensor, time, 100);
+    TEST_ASSERT_FALSE(sensor.isWaterPresent());
+    step(sensor, time, 209);  // 299 ms after the edge
+    TEST_ASSERT_FALSE(sensor.isWaterPresent());
+    step(sensor, time, 1);
+    TEST_ASSERT_TRUE(sensor.isWaterPresent());
+
+    // Bounce: every edge restarts the window at its own time.
+    const int64_t t1 = time.nowMs();
+    input.edge(t1 + 5, false);
+    input.edge(t1 + 8, true);
+    input.edge(t1 + 20, false);
+    step(sensor, time, 100);
+    step(sensor, time, 219);  // 299 ms after the last edge
+    TEST_ASSERT_TRUE(sensor.isWaterPresent());
+    step(sensor, time, 1);
+    TEST_ASSERT_FALSE(sensor.isWaterPresent());
+}
+
+void test_edge_hold_between_updates_is_observed(void)
+{
+    EdgeInput input;
+    FakeTimeProvider time;
+    DebouncedLevelSensor sensor(input, time, /*activeLow=*/false,
+                                kDebounceMs, /*settleMs=*/0);
+    reach_tracking(sensor, input, time, /*raw=*/false);
+
+    // High for 340 ms, low again before the next update: no poll ever saw
+    // it, the edges did — the change completed at +310 and its reversal
+    // opened a fresh window at +350.
+    const int64_t t0 = time.nowMs();
+    input.edge(t0 + 10, true);
+    input.edge(t0 + 350, false);
+    step(sensor, time, 400);
+    TEST_ASSERT_TRUE(sensor.isWaterPresent());
+    TEST_ASSERT_FALSE(sensor.rawState());
+    step(sensor, time, 249);  // 299 ms after the falling edge
+    TEST_ASSERT_TRUE(sensor.isWaterPresent());
+    step(sensor, time, 1);
+    TEST_ASSERT_FALSE(sensor.isWaterPresent());
+
+    // A dropped edge: the per-update read() still sees the level.
+    input.level = true;
+    step(sensor, time, 100);
+    step(sensor, time, kDebounceMs);
+    TEST_ASSERT_TRUE(sensor.isWaterPresent());
+}
+
+void test_edges_before_rearm_do_not_shorten_settle(void)
+{
+    EdgeInput input;
+    FakeTimeProvider time;
+    DebouncedLevelSensor sensor(input, time, /*activeLow=*/false,
+                                kDebounceMs, kSettleMs);
+
+    // An edge queued long before the first update: the settle window
+    // still opens at that update.
+    input.edge(time.nowMs(), true);
+    time.advance(1000);
+    sensor.update();
+    step(sensor, time, kDebounceMs);
+    TEST_ASSERT_FALSE(sensor.isValid());  // still settling
+    step(sensor, time, kSettleMs - kDebounceMs);  // settle over: warm-up
+    step(sensor, time, kDebounceMs - 1);
+    TEST_ASSERT_FALSE(sensor.isValid());
+    step(sensor, time, 1);
+    TEST_ASSERT_TRUE(sensor.isValid());
+    TEST_ASSERT_TRUE(sensor.isWaterPresent());
+}
+
+void test_observer_sees_each_reported_change(void)
+{
+    struct Recorder : ILevelObserver {
+        int calls = 0;
+        bool last = false;
+        void onWaterPresentChanged(bool waterPresent) override
+        {
+            ++calls;
+            last = waterPresent;
+        }
+    };
+    ScriptedInput input;
+    FakeTimeProvider time;
+    Recorder recorder;
+    DebouncedLevelSensor sensor(input, time, /*activeLow=*/true,
+                                kDebounceMs, /*settleMs=*/0);
+    sensor.setObserver(&recorder);
+
+    // Becoming valid wet (active low: LOW = water) is a change; chatter
+    // inside a window is not.
+    reach_tracking(sensor, input, time, /*raw=*/false);
+    TEST_ASSERT_EQUAL_INT(1, recorder.calls);
+    TEST_ASSERT_TRUE(recorder.last);
+    input.level = true;
+    step(sensor, time, 100);
+    input.level = false;
+    step(sensor, time, 100);
+    step(sensor, time, kDebounceMs);
+    TEST_ASSERT_EQUAL_INT(1, recorder.calls);
+
+    input.level = true;
+    step(sensor, time, 0);
+    step(sensor, time, kDebounceMs);
+    TEST_ASSERT_EQUAL_INT(2, recorder.calls);
+    TEST_ASSERT_FALSE(recorder.last);
+
+    // A re-arm invalidates without a callback.
+    input.level = false;
+    step(sensor, time, 0);
+    step(sensor, time, kDebounceMs);
+    TEST_ASSERT_EQUAL_INT(3, recorder.calls);
+    sensor.notifyPowerOn();
+    TEST_ASSERT_FALSE(sensor.isWaterPresent());
+    TEST_ASSERT_EQUAL_INT(3, recorder.calls);
+}
+
 // ---------------------------------------------------------------------------
 // LockedLevelSensor: pure delegation (decorator adds a mutex, nothing else)
 // ---------------------------------------------------------------------------
@@ -706,6 +868,10 @@ void run_level_sensor_tests(void)
     RUN_TEST(test_polarity_equivalence);
     RUN_TEST(test_chatter_single_transition);
     RUN_TEST(test_raw_state_is_undebounced);
+    RUN_TEST(test_edge_times_open_the_window);
+    RUN_TEST(test_edge_hold_between_updates_is_observed);
+    RUN_TEST(test_edges_before_rearm_do_not_shorten_settle);
+    RUN_TEST(test_observer_sees_each_reported_change);
     RUN_TEST(test_locked_level_sensor_delegates);
     RUN_TEST(test_fail_direction_rev1_disconnected_reads_water_present);
     RUN_TEST(test_fail_direction_rev2_disconnected_reads_water_absent);
@@ -0,0 +1,198 @@
+// SPDX-FileCopyrightText: 2026 Cryptotomte
+// SPDX-License-Identifier: AGPL-3.0-or-later
+/**
+ * @file test_level_sensor_bank.cpp
+ * @brief Host suite for the one-sample level bank (sensors/LevelSensorBank.h).
+ *
+ * Registered by test_main.cpp via run_level_sensor_bank_tests(). One
+ * update() is one readAll(); both marks debounce on that sample and change
+ * in the same update, so a drain past both never shows high wet over low
+ * dry; a fault stays on its mark until a power-on re-arm of the bank; an
+ * edge newer than the sample waits for the next update(); an observer sees
+ * the new state already published. The per-mark policy itself is
+ * DebouncedLevelSensor's (test_level_sensor.cpp).
+ */
+
+#include <cstdint>
+#include <deque>
+
+#include "unity.h"
+
+#include "actuators/testing/FakeTimeProvider.h"
+#include "interfaces/IDigitalInput.h"
+#include "interfaces/IDigitalInputBank.h"
+#include "interfaces/ILevelObserver.h"
+#include "sensors/LevelSensorBank.h"
+
+namespace {
+
+constexpr int64_t kDebounceMs = 300;
+
+constexpr uint32_t kLowPin = 1u << 0;
+constexpr uint32_t kHighPin = 1u << 1;
+
+/// Scripted pins: the test sets `levels`, every readAll() is counted.
+struct ScriptedBank : IDigitalInputBank {
+    uint32_t levels = 0;
+    int reads = 0;
+
+    uint32_t readAll() override
+    {
+        ++reads;
+        return levels;
+    }
+};
+
+/// Queued edges only (the bank's sample is the level).
+struct EdgeQueue : IDigitalInput {
+    std::deque<DigitalEdge> edges;
+
+    bool read() override { return false; }
+
+    bool nextEdge(DigitalEdge& edge) override
+    {
+        if (edges.empty()) {
+            return false;
+        }
+        edge = edges.front();
+        edges.pop_front();
+        return true;
+    }
+};
+
+bool impossible(const LevelBankState& s)
+{
+    return s.valid(LevelMarkId::Low) && s.valid(LevelMarkId::High) &&
+           s.waterPresent(LevelMarkId::High) && !s.waterPresent(LevelMarkId::Low);
+}
+
+void step(LevelSensorBank& bank, FakeTimeProvider& time, int64_t ms)
+{
+    time.advance(ms);
+    bank.update();
+}
+
+void test_one_read_per_update_and_marks_move_together(void)
+{
+    ScriptedBank pins;
+    FakeTimeProvider time;
+    LevelSensorBank bank(pins, time, /*activeLow=*/false, kDebounceMs, /*settleMs=*/0);
+    TEST_ASSERT_FALSE(bank.state().valid(LevelMarkId::Low));
+
+    pins.levels = kLowPin | kHighPin;  // full
+    bank.update();
+    step(bank, time, kDebounceMs);
+    TEST_ASSERT_EQUAL_INT(2, pins.reads);
+    const LevelBankState full = bank.state();
+    TEST_ASSERT_TRUE(full.valid(LevelMarkId::Low) && full.valid(LevelMarkId::High));
+    TEST_ASSERT_TRUE(full.waterPresent(LevelMarkId::Low));
+    TEST_ASSERT_TRUE(full.waterPresent(LevelMarkId::High));
+    TEST_ASSERT_TRUE(full.raw(LevelMarkId::High));
+
+    // Drained past both marks between two polls: both go dry in one update.
+    pins.levels = 0;
+    for (int i = 0; i < 5; ++i) {
+        step(bank, time, 100);
+        TEST_ASSERT_FALSE(impossible(bank.state()));
+        TEST_ASSERT_TRUE(bank.state().waterPresent(LevelMarkId::Low) ==
+                         bank.state().waterPresent(LevelMarkId::High));
+    }
+    TEST_ASSERT_FALSE(bank.state().waterPresent(LevelMarkId::Low));
+    TEST_ASSERT_EQUAL_INT(7, pins.reads);
+
+    // The views read the published word; their update() samples nothing.
+    LevelSensorBank::Mark& low = bank.mark(LevelMarkId::Low);
+    low.update();
+    TEST_ASSERT_EQUAL_INT(7, pins.reads);
+    TEST_ASSERT_TRUE(low.isValid());
+    TEST_ASSERT_FALSE(low.isWaterPresent());
+    TEST_ASSERT_FALSE(low.rawState());
+}
+
+void test_fault_is_per_mark_and_power_on_rearms_the_bank(void)
+{
+    ScriptedBank pins;
+    FakeTimeProvider time;
+    LevelSensorBank bank(pins, time, /*activeLow=*/true, kDebounceMs, /*settleMs=*/0);
+    bank.markFaulted(LevelMarkId::High);
+
+    pins.levels = 0;  // active low: both wet
+    bank.update();
+    step(bank, time, kDebounceMs);
+    TEST_ASSERT_TRUE(bank.mark(LevelMarkId::Low).isWaterPresent());
+    TEST_ASSERT_FALSE(bank.mark(LevelMarkId::High).isValid());
+    TEST_ASSERT_FALSE(bank.mark(LevelMarkId::High).rawState());
+
+    // A re-arm through either view clears the fault and invalidates both.
+    bank.mark(LevelMarkId::High).notifyPowerOn();
+    TEST_ASSERT_FALSE(bank.state().valid(LevelMarkId::Low));
+    bank.update();
+    step(bank, time, kDebounceMs);
+    TEST_ASSERT_TRUE(bank.state().valid(LevelMarkId::High));
+    TEST_ASSERT_TRUE(bank.state().waterPresent(LevelMarkId::High));
+}
+
+void test_edge_newer_than_the_sample_waits(void)
+{
+    ScriptedBank pins;
+    FakeTimeProvider time;
+    EdgeQueue edges;
+    LevelSensorBank bank(pins, time, /*activeLow=*/false, kDebounceMs, /*settleMs=*/0);
+    bank.setEdgeSource(LevelMarkId::Low, &edges);
+    bank.update();
+    step(bank, time, kDebounceMs);  // both valid dry
+    TEST_ASSERT_TRUE(bank.state().valid(LevelMarkId::Low));
+
+    // The pin rises 50 ms after this update's register read.
+    const int64_t riseMs = time.nowMs() + 50;
+    edges.edges.push_back(DigitalEdge{riseMs, true});
+    step(bank, time, 0);
+    TEST_ASSERT_TRUE(edges.edges.empty());  // popped, held back
+    TEST_ASSERT_FALSE(bank.state().waterPresent(LevelMarkId::Low));
+
+    // The next sample sees it; the window runs from the edge, not the poll.
+    pins.levels = kLowPin;
+    step(bank, time, 100);
+    TEST_ASSERT_FALSE(bank.state().waterPresent(LevelMarkId::Low));
+    step(bank, time, kDebounceMs - 50);  // riseMs + debounce
+    TEST_ASSERT_TRUE(bank.state().waterPresent(LevelMarkId::Low));
+}
+
+void test_observer_sees_published_state(void)
+{
+    struct Recorder : ILevelObserver {
+        LevelSensorBank* bank = nullptr;
+        int calls = 0;
+        bool seenPublished = false;
+        void onWaterPresentChanged(bool waterPresent) override
+        {
+            ++calls;
+            seenPublished = bank->state().waterPresent(LevelMarkId::High) == waterPresent;
+        }
+    };
+    ScriptedBank pins;
+    FakeTimeProvider time;
+    LevelSensorBank bank(pins, time, /*activeLow=*/false, kDebounceMs, /*settleMs=*/0);
+    Recorder recorder;
+    recorder.bank = &bank;
+    bank.setObserver(LevelMarkId::High, &recorder);
+
+    bank.update();
+    step(bank, time, kDebounceMs);  // valid dry: no change
+    TEST_ASSERT_EQUAL_INT(0, recorder.calls);
+    pins.levels = kLowPin | kHighPin;
+    step(bank, time, 0);
+    step(bank, time, kDebounceMs);
+    TEST_ASSERT_EQUAL_INT(1, recorder.calls);
+    TEST_ASSERT_TRUE(recorder.seenPublished);
+}
+
+}  // namespace
+
+void run_level_sensor_bank_tests(void)
+{
+    RUN_TEST(test_one_read_per_update_and_marks_move_together);
+    RUN_TEST(test_fault_is_per_mark_and_power_on_rearms_the_bank);
+    RUN_TEST(test_edge_newer_than_the_sample_waits);
+    RUN_TEST(test_observer_sees_published_state);
+}
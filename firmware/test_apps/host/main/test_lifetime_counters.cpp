@@ -0,0 +1,153 @@
+// SPDX-FileCopyrightText: 2026 Cryptotomte
+// SPDX-License-Identifier: AGPL-3.0-or-later
+/**
+ * @file test_lifetime_counters.cpp
+ * @brief Host suite for the reset-surviving counters
+ *        (interfaces/LifetimeCounters.h) and their /metrics block.
+ *
+ * Registered by test_main.cpp via run_lifetime_counters_tests(). A sealed
+ * block restores the totals as bases for the next boot; restore() takes the
+ * valid block with the highest sequence and rejects a torn or foreign one;
+ * a sample is added on top of the base, not accumulated.
+ */
+
+#include <cstdint>
+#include <string>
+
+#include "unity.h"
+
+#include "api/ApiMetrics.h"
+#include "interfaces/LifetimeCounters.h"
+
+namespace {
+
+uint64_t total(const LifetimeCounters& counters, LifetimeCounter c)
+{
+    LifetimeCounterValues values;
+    TEST_ASSERT_TRUE(counters.load(values));
+    return values[c];
+}
+
+void test_first_boot_starts_from_zero(void)
+{
+    LifetimeCounterBlock garbage{};
+    garbage.magic = 0xDEADBEEFu;
+    LifetimeCounters counters;
+    TEST_ASSERT_NULL(counters.restore({&garbage, nullptr}));
+    TEST_ASSERT_EQUAL_UINT32(0, counters.sequence());
+    TEST_ASSERT_EQUAL_UINT64(0, total(counters, LifetimeCounter::Boots));
+}
+
+void test_sample_rebases_on_the_previous_boots(void)
+{
+    LifetimeCounters first;
+    first.restore({});
+    first.add(LifetimeCounter::Boots, 1);
+    first.sample(LifetimeCounter::PlantPumpRunMs, 4'000);
+    first.sample(LifetimeCounter::PlantPumpRunMs, 9'000);  // replaces, not adds
+    LifetimeCounterBlock rtc{};
+    first.seal(rtc);
+    TEST_ASSERT_TRUE(LifetimeCounters::valid(rtc));
+    TEST_ASSERT_EQUAL_UINT64(9'000, total(first, LifetimeCounter::PlantPumpRunMs));
+
+    LifetimeCounters second;
+    TEST_ASSERT_EQUAL_PTR(&rtc, second.restore({&rtc}));
+    second.add(LifetimeCounter::Boots, 1);
+    second.add(LifetimeCounter::WatchdogResets, 1);
+    second.sample(LifetimeCounter::PlantPumpRunMs, 500);
+    LifetimeCounterBlock next{};
+    second.seal(next);
+    TEST_ASSERT_EQUAL_UINT32(rtc.sequence + 1, next.sequence);
+    TEST_ASSERT_EQUAL_UINT64(2, total(second, LifetimeCounter::Boots));
+    TEST_ASSERT_EQUAL_UINT64(1, total(second, LifetimeCounter::WatchdogResets));
+    TEST_ASSERT_EQUAL_UINT64(9'500, total(second, LifetimeCounter::PlantPumpRunMs));
+    TEST_ASSERT_EQUAL_UINT64(9'500, next.values[static_cast<std::size_t>(
+                                        LifetimeCounter::PlantPumpRunMs)]);
+}
+
+void test_restore_takes_the_newest_valid_block(void)
+{
+    LifetimeCounters writer;
+    writer.restore({});
+    LifetimeCounterBlock nvs{};
+    LifetimeCounterBlock rtc[2] = {};
+    writer.add(LifetimeCounter::Boots, 1);
+    writer.seal(nvs);     // sequence 1, flushed
+    writer.seal(rtc[0]);  // sequence 2
+    writer.add(LifetimeCounter::Boots, 1);
+    writer.seal(rtc[1]);  // sequence 3
+
+    LifetimeCounters reader;
+    TEST_ASSERT_EQUAL_PTR(&rtc[1], reader.restore({&rtc[0], &rtc[1], &nvs}));
+    TEST_ASSERT_EQUAL_UINT64(2, total(reader, LifetimeCounter::Boots));
+
+    // A reset mid-write tears the newest block: the other one holds.
+    rtc[1].values[0] += 1;
+    TEST_ASSERT_FALSE(LifetimeCounters::valid(rtc[1]));
+    TEST_ASSERT_EQUAL_PTR(&rtc[0], reader.restore({&rtc[0], &rtc[1], &nvs}));
+    TEST_ASSERT_EQUAL_UINT64(1, total(reader, LifetimeCounter::Boots));
+
+    // Power cycle: RTC memory is noise, the NVS copy is taken.
+    rtc[0].version = LifetimeCounterBlock::kVersion + 1;
+    TEST_ASSERT_EQUAL_PTR(&nvs, reader.restore({&rtc[0], &rtc[1], &nvs}));
+    TEST_ASSERT_EQUAL_UINT32(1, reader.sequence());
+}
+
+void test_samples_publish_at_the_next_seal(void)
+{
+    LifetimeCounters counters;
+    counters.restore({});
+    counters.add(LifetimeCounter::Boots, 1);  // boot-time: visible at once
+    TEST_ASSERT_EQUAL_UINT64(1, total(counters, LifetimeCounter::Boots));
+    counters.sample(LifetimeCounter::StorageSyncs, 7);
+    TEST_ASSERT_EQUAL_UINT64(0, total(counters, LifetimeCounter::StorageSyncs));
+    LifetimeCounterBlock block{};
+    counters.seal(block);
+    TEST_ASSERT_EQUAL_UINT64(7, total(counters, LifetimeCounter::StorageSyncs));
+    TEST_ASSERT_EQUAL_UINT16(kLifetimeCounterCount, block.count);
+}
+
+struct StringSink final : api::IChunkSink {
+    std::string body;
+
+    bool send(const char* data, std::size_t len) override
+    {
+        body.append(data, len);
+        return true;
+    }
+};
+
+bool contains(const std::string& body, const char* text)
+{
+    return body.find(text) != std::string::npos;
+}
+
+void test_metrics_block_only_when_set(void)
+{
+    api::HttpMetrics metrics;
+    StringSink plain;
+    TEST_ASSERT_TRUE(api::streamMetrics(metrics.snapshot(), api::SystemMetricsDto{}, plain));
+    TEST_ASSERT_FALSE(contains(plain.body, "lifetime_total"));
+
+    api::SystemMetricsDto sys;
+    sys.lifetime.push_back(api::LifetimeCounterDto{"boots", 12});
+    sys.lifetime.push_back(api::LifetimeCounterDto{"plant_pump_run_ms", 5'000'000'000ull});
+    StringSink sink;
+    TEST_ASSERT_TRUE(api::streamMetrics(metrics.snapshot(), sys, sink));
+    TEST_ASSERT_TRUE(contains(sink.body, "# TYPE wateringsystem_lifetime_total counter\n"));
+    TEST_ASSERT_TRUE(contains(sink.body,
+        "wateringsystem_lifetime_total{counter=\"boots\"} 12\n"));
+    TEST_ASSERT_TRUE(contains(sink.body,
+        "wateringsystem_lifetime_total{counter=\"plant_pump_run_ms\"} 5000000000\n"));
+}
+
+}  // namespace
+
+void run_lifetime_counters_tests(void)
+{
+    RUN_TEST(test_first_boot_starts_from_zero);
+    RUN_TEST(test_sample_rebases_on_the_previous_boots);
+    RUN_TEST(test_restore_takes_the_newest_valid_block);
+    RUN_TEST(test_samples_publish_at_the_next_seal);
+    RUN_TEST(test_metrics_block_only_when_set);
+}
@@ -0,0 +1,253 @@
+// SPDX-FileCopyrightText: 2026 Cryptotomte
+// SPDX-License-Identifier: AGPL-3.0-or-later
+/**
+ * @file test_live_stream.cpp
+ * @brief Host suite for the /api/v1/stream hub and delta publisher
+ *        (LiveStream.h) and its message serializers.
+ *
+ * A first publish — and any publish after a join — is a full snapshot;
+ * later ones carry only the changed sections and pump state flips; a full
+ * queue drops its oldest message and forces a snapshot; events reach every
+ * client through the EventLogger tap; nothing is built without clients.
+ */
+
+#include <cmath>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include "unity.h"
+
+#include "api/ApiDtos.h"
+#include "api/ApiSerialize.h"
+#include "api/LiveStream.h"
+#include "events/EventLogger.h"
+#include "interfaces/IDataStorage.h"
+#include "storage/testing/MockDataStorage.h"
+#include "time/testing/FakeWallClock.h"
+
+namespace {
+
+api::SensorReadingsDto readings()
+{
+    api::SensorReadingsDto dto;
+    dto.environmental = {true, 21.5f, 48.0f, 1013.0f};
+    dto.soil.valid = false;
+    dto.soil.moisture = NAN;
+    dto.level.low = {true, true};
+    dto.level.high = {true, false};
+    dto.hasTimestamp = true;
+    dto.timestamp = 1760000000;
+    return dto;
+}
+
+std::vector<api::PumpDto> pumps()
+{
+    return {api::PumpDto{"plant", false, 0, 1000, "commanded"}};
+}
+
+/// Every message queued for @p id, in order.
+std::vector<std::string> drain(api::LiveStream& stream, int id)
+{
+    std::vector<std::string> out;
+    std::string message;
+    while (stream.pop(id, message)) {
+        out.push_back(message);
+    }
+    return out;
+}
+
+void test_join_gets_a_full_snapshot_then_deltas()
+{
+    api::LiveStream stream;
+    TEST_ASSERT_TRUE(stream.addClient(7));
+
+    api::SensorReadingsDto dto = readings();
+    TEST_ASSERT_TRUE(stream.publish(dto, pumps()));
+    std::vector<std::string> got = drain(stream, 7);
+    TEST_ASSERT_EQUAL_size_t(2, got.size());
+    TEST_ASSERT_EQUAL_STRING(
+        "{\"type\":\"sensors\",\"full\":true,"
+        "\"environmental\":{\"valid\":true,\"temperature\":21.5,\"humidity\":48,"
+        "\"pressure\":1013},"
+        "\"soil\":{\"valid\":false,\"moisture\":null,\"temperature\":0,"
+        "\"humidity\":0,\"ph\":0,\"ec\":0},"
+        "\"level\":{\"low\":{\"valid\":true,\"waterPresent\":true},"
+        "\"high\":{\"valid\":true,\"waterPresent\":false}},"
+        "\"timestamp\":1760000000}",
+        got[0].c_str());
+    TEST_ASSERT_EQUAL_STRING(
+        "{\"type\":\"pump\",\"name\":\"plant\",\"running\":false,"
+        "\"currentRunTimeMs\":0,\"accumulatedRunTimeMs\":1000,"
+        "\"lastStopReason\":\"commanded\"}",
+        got[1].c_str());
+
+    // Unchanged (only the response time moved): nothing to send.
+    dto.timestamp += 5;
+    TEST_ASSERT_FALSE(stream.publish(dto, pumps()));
+    TEST_ASSERT_FALSE(stream.pending());
+
+    // A level mark flips: one small frame with the level section only.
+    dto.level.high.waterPresent = true;
+    TEST_ASSERT_TRUE(stream.publish(dto, pumps()));
+    got = drain(stream, 7);
+    TEST_ASSERT_EQUAL_size_t(1, got.size());
+    TEST_ASSERT_EQUAL_STRING(
+        "{\"type\":\"sensors\",\"level\":{\"low\":{\"valid\":true,"
+        "\"waterPresent\":true},\"high\":{\"valid\":true,\"waterPresent\":true}},"
+        "\"timestamp\":1760000005}",
+        got[0].c_str());
+}
+
+void test_pump_pushed_on_start_and_stop_not_on_ticks()
+{
+    api::LiveStream stream;
+    stream.addClient(1);
+    const api::SensorReadingsDto dto = readings();
+    std::vector<api::PumpDto> list = pumps();
+    stream.publish(dto, list);
+    drain(stream, 1);
+
+    list[0].running = true;
+    TEST_ASSERT_TRUE(stream.publish(dto, list));
+    TEST_ASSERT_EQUAL_size_t(1, drain(stream, 1).size());
+
+    list[0].currentRunTimeMs = 4000;  // the run clock ticks: no frame
+    TEST_ASSERT_FALSE(stream.publish(dto, list));
+
+    list[0].running = false;
+    list[0].lastStopReason = "duration_elapsed";
+    TEST_ASSERT_TRUE(stream.publish(dto, list));
+    const std::vector<std::string> got = drain(stream, 1);
+    TEST_ASSERT_EQUAL_size_t(1, got.size());
+    TEST_ASSERT_TRUE(got[0].find("\"lastStopReason\":\"duration_elapsed\"") !=
+                     std::string::npos);
+}
+
+void test_full_queue_drops_oldest_and_resyncs()
+{
+    api::LiveStream stream;
+    stream.addClient(3);
+    api::SensorReadingsDto dto = readings();
+    stream.publish(dto, pumps());
+    drain(stream, 3);
+
+    // kQueueDepth + 1 deltas nobody reads: the oldest goes, and the client
+    // is marked for a snapshot.
+    for (std::size_t i = 0; i < api::LiveStream::kQueueDepth + 1; ++i) {
+        dto.environmental.temperature += 0.5f;
+        stream.publish(dto, pumps());
+    }
+    TEST_ASSERT_EQUAL_UINT32(1, stream.droppedMessages());
+
+    // The next publish restates everything. It displaces two more stale
+    // deltas but, being a snapshot, does not mark the client again.
+    stream.publish(dto, pumps());
+    TEST_ASSERT_EQUAL_UINT32(3, stream.droppedMessages());
+    std::vector<std::string> got = drain(stream, 3);
+    TEST_ASSERT_EQUAL_size_t(api::LiveStream::kQueueDepth, got.size());
+    const std::string& snapshot = got[got.size() - 2];
+    TEST_ASSERT_TRUE(snapshot.find("\"full\":true") != std::string::npos);
+    TEST_ASSERT_TRUE(snapshot.find("\"temperature\":26") != std::string::npos);
+    TEST_ASSERT_TRUE(got.back().find("\"type\":\"pump\"") != std::string::npos);
+    TEST_ASSERT_FALSE(stream.publish(dto, pumps()));
+}
+
+void test_snapshot_goes_to_the_newcomer_only()
+{
+    api::LiveStream stream;
+    stream.addClient(1);
+    api::SensorReadingsDto dto = readings();
+    stream.publish(dto, pumps());
+    drain(stream, 1);
+
+    stream.addClient(2);
+    dto.soil.valid = true;
+    stream.publish(dto, pumps());
+    const std::vector<std::string> old = drain(stream, 1);
+    TEST_ASSERT_EQUAL_size_t(1, old.size());
+    TEST_ASSERT_TRUE(old[0].find("\"full\"") == std::string::npos);
+    TEST_ASSERT_TRUE(old[0].find("\"environmental\"") == std::string::npos);
+    const std::vector<std::string> joined = drain(stream, 2);
+    TEST_ASSERT_EQUAL_size_t(2, joined.size());
+    TEST_ASSERT_TRUE(joined[0].find("\"full\":true") != std::string::npos);
+}
+
+void test_client_slots_and_queues_are_per_client()
+{
+    api::LiveStream stream;
+    for (std::size_t i = 0; i < api::LiveStream::kMaxClients; ++i) {
+        TEST_ASSERT_TRUE(stream.addClient(static_cast<int>(10 + i)));
+    }
+    TEST_ASSERT_FALSE(stream.addClient(99));   // full
+    TEST_ASSERT_FALSE(stream.addClient(10));   // already there
+    TEST_ASSERT_EQUAL_size_t(api::LiveStream::kMaxClients, stream.clientCount());
+
+    stream.publish(readings(), pumps());
+    TEST_ASSERT_EQUAL_size_t(2, drain(stream, 10).size());
+    TEST_ASSERT_TRUE(stream.pending());  // the others still hold theirs
+
+    stream.removeClient(11);
+    std::string message;
+    TEST_ASSERT_FALSE(stream.pop(11, message));
+    TEST_ASSERT_TRUE(stream.addClient(99));
+    TEST_ASSERT_EQUAL_size_t(api::LiveStream::kMaxClients, stream.clients().size());
+}
+
+void test_no_clients_builds_nothing()
+{
+    api::LiveStream stream;
+    TEST_ASSERT_FALSE(stream.publish(readings(), pumps()));
+    stream.onEvent(1, IDataStorage::kCategoryPump, "pump=plant start");
+    TEST_ASSERT_FALSE(stream.pending());
+
+    // A later client still starts from a full snapshot.
+    stream.addClient(5);
+    TEST_ASSERT_FALSE(stream.pending());
+    stream.publish(readings(), pumps());
+    const std::vector<std::string> got = drain(stream, 5);
+    TEST_ASSERT_EQUAL_size_t(2, got.size());
+    TEST_ASSERT_TRUE(got[0].find("\"full\":true") != std::string::npos);
+}
+
+void test_logged_events_reach_the_stream()
+{
+    MockDataStorage store;
+    FakeWallClock clock(1760000000u);
+    EventLogger logger(store, clock);
+    api::LiveStream stream;
+    logger.setTap(&stream);
+    stream.addClient(4);
+
+    logger.logPumpStart("plant", "unknown");
+    std::vector<std::string> got = drain(stream, 4);
+    TEST_ASSERT_EQUAL_size_t(1, got.size());
+    TEST_ASSERT_EQUAL_STRING(
+        "{\"type\":\"event\",\"epoch\":1760000000,\"category\":1,"
+        "\"categoryName\":\"pump\",\"detail\":\"pump=plant start cause=unknown\"}",
+        got[0].c_str());
+
+    // A dropped (unstored) event is not pushed: the stream mirrors the log.
+    store.failWrites = true;
+    logger.logWifi("Connected");
+    TEST_ASSERT_FALSE(stream.pending());
+
+    store.failWrites = false;
+    logger.setTap(nullptr);
+    logger.logWifi("Connected");
+    TEST_ASSERT_FALSE(stream.pending());
+    TEST_ASSERT_EQUAL_size_t(2, store.events.size());
+}
+
+}  // namespace
+
+void run_live_stream_tests(void)
+{
+    RUN_TEST(test_join_gets_a_full_snapshot_then_deltas);
+    RUN_TEST(test_pump_pushed_on_start_and_stop_not_on_ticks);
+    RUN_TEST(test_full_queue_drops_oldest_and_resyncs);
+    RUN_TEST(test_snapshot_goes_to_the_newcomer_only);
+    RUN_TEST(test_client_slots_and_queues_are_per_client);
+    RUN_TEST(test_no_clients_builds_nothing);
+    RUN_TEST(test_logged_events_reach_the_stream);
+}
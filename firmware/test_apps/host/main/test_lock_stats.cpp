@@ -0,0 +1,175 @@
+// SPDX-FileCopyrightText: 2026 Cryptotomte
+// SPDX-License-Identifier: AGPL-3.0-or-later
+/**
+ * @file test_lock_stats.cpp
+ * @brief Host suite for the decorator lock statistics
+ *        (interfaces/LockStats.h) and their /metrics block.
+ *
+ * Registered by test_main.cpp via run_lock_stats_tests(). InstrumentedMutex
+ * counts every acquisition, times holds with the installed clock, counts a
+ * lock() that found the mutex held as contended (a failed try_lock() is not
+ * an acquisition); LockRegistry keeps names in order up to its capacity.
+ * The host build does not define WS_LOCK_STATS, so the decorators keep a
+ * plain mutex here; the mutex is tested on its own.
+ */
+
+#include <chrono>
+#include <cstdint>
+#include <string>
+#include <thread>
+
+#include "unity.h"
+
+#include "api/ApiMetrics.h"
+#include "interfaces/LockStats.h"
+
+namespace {
+
+int64_t g_nowUs = 0;
+
+int64_t fakeClock()
+{
+    return g_nowUs;
+}
+
+int64_t steadyClock()
+{
+    return std::chrono::duration_cast<std::chrono::microseconds>(
+               std::chrono::steady_clock::now().time_since_epoch())
+        .count();
+}
+
+void test_uncontended_locks_count_and_time_the_hold(void)
+{
+    InstrumentedMutex::installClock(&fakeClock);
+    InstrumentedMutex mutex;
+    g_nowUs = 100;
+    mutex.lock();
+    g_nowUs = 350;
+    mutex.unlock();
+    g_nowUs = 400;
+    TEST_ASSERT_TRUE(mutex.try_lock());
+    g_nowUs = 420;
+    mutex.unlock();
+
+    const LockStats s = mutex.stats();
+    TEST_ASSERT_EQUAL_UINT32(2, s.acquisitions);
+    TEST_ASSERT_EQUAL_UINT32(0, s.contended);
+    TEST_ASSERT_EQUAL_UINT32(0, s.waitUs);
+    TEST_ASSERT_EQUAL_UINT32(0, s.meanWaitUs());
+    TEST_ASSERT_EQUAL_UINT32(250, s.maxHoldUs);
+    InstrumentedMutex::installClock(nullptr);
+}
+
+void test_failed_try_lock_is_not_an_acquisition(void)
+{
+    InstrumentedMutex mutex;
+    mutex.lock();
+    bool got = true;
+    std::thread other([&] { got = mutex.try_lock(); });
+    other.join();
+    mutex.unlock();
+    TEST_ASSERT_FALSE(got);
+    TEST_ASSERT_EQUAL_UINT32(1, mutex.stats().acquisitions);
+}
+
+void test_waiting_lock_is_contended(void)
+{
+    InstrumentedMutex::installClock(&steadyClock);
+    InstrumentedMutex mutex;
+    mutex.lock();
+    std::thread waiter([&] {
+        mutex.lock();
+        mutex.unlock();
+    });
+    std::this_thread::sleep_for(std::chrono::milliseconds(20));
+    mutex.unlock();
+    waiter.join();
+
+    const LockStats s = mutex.stats();
+    TEST_ASSERT_EQUAL_UINT32(2, s.acquisitions);
+    // The waiter normally reaches lock() within the 20 ms; a starved one
+    // finds the mutex free instead.
+    TEST_ASSERT_TRUE(s.contended <= 1);
+    TEST_ASSERT_EQUAL_UINT32(s.maxWaitUs, s.waitUs);
+    TEST_ASSERT_EQUAL_UINT32(s.waitUs, s.meanWaitUs());
+    if (s.contended == 1) {
+        TEST_ASSERT_TRUE(s.maxWaitUs > 0);
+        TEST_ASSERT_TRUE(s.maxHoldUs > 0);
+    }
+    InstrumentedMutex::installClock(nullptr);
+}
+
+void test_registry_keeps_names_in_order_until_full(void)
+{
+    LockRegistry registry;
+    InstrumentedMutex a;
+    InstrumentedMutex b;
+    TEST_ASSERT_EQUAL_size_t(0, registry.size());
+    TEST_ASSERT_TRUE(registry.add("plant", a));
+    TEST_ASSERT_TRUE(registry.add("soil", b));
+    b.lock();
+    b.unlock();
+    TEST_ASSERT_EQUAL_size_t(2, registry.size());
+    TEST_ASSERT_EQUAL_STRING("plant", registry.name(0));
+    TEST_ASSERT_EQUAL_UINT32(0, registry.stats(0).acquisitions);
+    TEST_ASSERT_EQUAL_STRING("soil", registry.name(1));
+    TEST_ASSERT_EQUAL_UINT32(1, registry.stats(1).acquisitions);
+
+    for (std::size_t i = 2; i < LockRegistry::kCapacity; ++i) {
+        TEST_ASSERT_TRUE(registry.add("zone", a));
+    }
+    TEST_ASSERT_FALSE(registry.add("one-too-many", a));
+    TEST_ASSERT_EQUAL_size_t(LockRegistry::kCapacity, registry.size());
+}
+
+struct StringSink final : api::IChunkSink {
+    std::string body;
+
+    bool send(const char* data, std::size_t len) override
+    {
+        body.append(data, len);
+        return true;
+    }
+};
+
+bool contains(const std::string& body, const char* text)
+{
+    return body.find(text) != std::string::npos;
+}
+
+void test_metrics_block_only_when_set(void)
+{
+    api::HttpMetrics metrics;
+    StringSink plain;
+    TEST_ASSERT_TRUE(api::streamMetrics(metrics.snapshot(), api::SystemMetricsDto{}, plain));
+    TEST_ASSERT_FALSE(contains(plain.body, "wateringsystem_lock_"));
+
+    api::SystemMetricsDto sys;
+    sys.locks.push_back(api::LockMetricsDto{"storage", 1200, 7, 35'000, 12'500, 180'000});
+    StringSink sink;
+    TEST_ASSERT_TRUE(api::streamMetrics(metrics.snapshot(), sys, sink));
+    TEST_ASSERT_TRUE(contains(sink.body,
+        "# TYPE wateringsystem_lock_contended_total counter\n"));
+    TEST_ASSERT_TRUE(contains(sink.body,
+        "wateringsystem_lock_acquisitions_total{lock=\"storage\"} 1200\n"));
+    TEST_ASSERT_TRUE(contains(sink.body,
+        "wateringsystem_lock_contended_total{lock=\"storage\"} 7\n"));
+    TEST_ASSERT_TRUE(contains(sink.body,
+        "wateringsystem_lock_wait_seconds_total{lock=\"storage\"} 0.035000\n"));
+    TEST_ASSERT_TRUE(contains(sink.body,
+        "wateringsystem_lock_wait_max_seconds{lock=\"storage\"} 0.012500\n"));
+    TEST_ASSERT_TRUE(contains(sink.body,
+        "wateringsystem_lock_hold_max_seconds{lock=\"storage\"} 0.180000\n"));
+}
+
+}  // namespace
+
+void run_lock_stats_tests(void)
+{
+    RUN_TEST(test_uncontended_locks_count_and_time_the_hold);
+    RUN_TEST(test_failed_try_lock_is_not_an_acquisition);
+    RUN_TEST(test_waiting_lock_is_contended);
+    RUN_TEST(test_registry_keeps_names_in_order_until_full);
+    RUN_TEST(test_metrics_block_only_when_set);
+}
@@ -0,0 +1,162 @@
+// SPDX-FileCopyrightText: 2026 Cryptotomte
+// SPDX-License-Identifier: AGPL-3.0-or-later
+/**
+ * @file test_log_ring.cpp
+ * @brief Host suite for the asynchronous log lines (interfaces/LogRing.h).
+ *
+ * Registered by test_main.cpp via run_log_ring_tests(). Lines come out in
+ * the order they were pushed; a full ring refuses and counts the line; an
+ * over-long line is cut and keeps its newline; lines from several writer
+ * threads all arrive, each whole; the tail keeps the newest lines, oldest
+ * first, without their line breaks.
+ */
+
+#include <atomic>
+#include <cstdio>
+#include <cstring>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "unity.h"
+
+#include "interfaces/LogRing.h"
+
+namespace {
+
+void test_lines_pop_in_push_order(void)
+{
+    LogRing<4> ring;
+    LogLine line;
+    TEST_ASSERT_FALSE(ring.pop(line));
+    TEST_ASSERT_TRUE(ring.push("I (1) a: one\n", 13));
+    TEST_ASSERT_TRUE(ring.push("I (2) a: two\n", 13));
+    TEST_ASSERT_TRUE(ring.pop(line));
+    TEST_ASSERT_EQUAL_STRING("I (1) a: one\n", line.text);
+    TEST_ASSERT_EQUAL_UINT32(13, line.length);
+    TEST_ASSERT_TRUE(ring.pop(line));
+    TEST_ASSERT_EQUAL_STRING("I (2) a: two\n", line.text);
+    TEST_ASSERT_FALSE(ring.pop(line));
+
+    // The slots are reused lap after lap.
+    for (int i = 0; i < 10; ++i) {
+        char text[16];
+        const int n = std::snprintf(text, sizeof text, "line %d\n", i);
+        TEST_ASSERT_TRUE(ring.push(text, static_cast<std::size_t>(n)));
+        TEST_ASSERT_TRUE(ring.pop(line));
+        TEST_ASSERT_EQUAL_STRING(text, line.text);
+    }
+    TEST_ASSERT_EQUAL_UINT32(0, ring.dropped());
+}
+
+void test_full_ring_drops_and_counts(void)
+{
+    LogRing<2> ring;
+    TEST_ASSERT_TRUE(ring.push("a\n", 2));
+    TEST_ASSERT_TRUE(ring.push("b\n", 2));
+    TEST_ASSERT_FALSE(ring.push("c\n", 2));
+    TEST_ASSERT_FALSE(ring.push("d\n", 2));
+    TEST_ASSERT_EQUAL_UINT32(2, ring.dropped());
+
+    // The queued lines are untouched; room again after a pop.
+    LogLine line;
+    TEST_ASSERT_TRUE(ring.pop(line));
+    TEST_ASSERT_EQUAL_STRING("a\n", line.text);
+    TEST_ASSERT_TRUE(ring.push("e\n", 2));
+    TEST_ASSERT_TRUE(ring.pop(line));
+    TEST_ASSERT_EQUAL_STRING("b\n", line.text);
+    TEST_ASSERT_TRUE(ring.pop(line));
+    TEST_ASSERT_EQUAL_STRING("e\n", line.text);
+}
+
+void test_long_line_is_cut_with_newline(void)
+{
+    LogRing<2> ring;
+    std::string text(300, 'x');
+    text.back() = '\n';
+    TEST_ASSERT_TRUE(ring.emplace([&](char* buf, std::size_t cap) {
+        return std::snprintf(buf, cap, "%s", text.c_str());
+    }));
+    LogLine line;
+    TEST_ASSERT_TRUE(ring.pop(line));
+    TEST_ASSERT_EQUAL_UINT32(kLogLineBytes - 1, line.length);
+    TEST_ASSERT_EQUAL_UINT32(kLogLineBytes - 1, std::strlen(line.text));
+    TEST_ASSERT_TRUE(line.text[kLogLineBytes - 2] == '\n');
+    TEST_ASSERT_TRUE(line.text[kLogLineBytes - 3] == 'x');
+}
+
+void test_concurrent_lines_arrive_whole_or_count(void)
+{
+    constexpr int kWriters = 4;
+    constexpr int kPerWriter = 500;
+    LogRing<64> ring;
+    std::atomic<int> done{0};
+    std::vector<std::thread> writers;
+    for (int w = 0; w < kWriters; ++w) {
+        writers.emplace_back([&ring, &done, w] {
+            for (int i = 0; i < kPerWriter; ++i) {
+                ring.emplace([w, i](char* buf, std::size_t cap) {
+                    return std::snprintf(buf, cap, "w%d %d\n", w, i);
+                });
+            }
+            done.fetch_add(1);
+        });
+    }
+
+    // Drain while they write: each writer's lines arrive whole and in order.
+    int next[kWriters] = {};
+    int received = 0;
+    LogLine line;
+    const auto drain = [&] {
+        while (ring.pop(line)) {
+            int w = -1;
+            int i = -1;
+            TEST_ASSERT_EQUAL_INT(2, std::sscanf(line.text, "w%d %d", &w, &i));
+            TEST_ASSERT_TRUE(w >= 0 && w < kWriters);
+            TEST_ASSERT_TRUE(i >= next[w]);
+            next[w] = i + 1;
+            ++received;
+        }
+    };
+    while (done.load() < kWriters) {
+        drain();
+    }
+    for (std::thread& t : writers) {
+        t.join();
+    }
+    drain();
+    TEST_ASSERT_EQUAL_INT(kWriters * kPerWriter,
+                         received + static_cast<int>(ring.dropped()));
+}
+
+void test_tail_keeps_newest_lines_oldest_first(void)
+{
+    LogTail tail;
+    std::vector<std::string> lines;
+    tail.copy(lines);
+    TEST_ASSERT_EQUAL_size_t(0, lines.size());
+
+    for (std::size_t i = 0; i < LogTail::kLines + 3; ++i) {
+        LogLine line;
+        line.length = static_cast<uint16_t>(
+            std::snprintf(line.text, sizeof line.text, "line %u\r\n", static_cast<unsigned>(i)));
+        tail.append(line);
+    }
+    tail.setDropped(7);
+    tail.copy(lines);
+    TEST_ASSERT_EQUAL_size_t(LogTail::kLines, lines.size());
+    TEST_ASSERT_EQUAL_STRING("line 3", lines.front().c_str());
+    TEST_ASSERT_EQUAL_STRING("line 34", lines.back().c_str());
+    TEST_ASSERT_EQUAL_UINT32(7, tail.dropped());
+}
+
+}  // namespace
+
+void run_log_ring_tests(void)
+{
+    RUN_TEST(test_lines_pop_in_push_order);
+    RUN_TEST(test_full_ring_drops_and_counts);
+    RUN_TEST(test_long_line_is_cut_with_newline);
+    RUN_TEST(test_concurrent_lines_arrive_whole_or_count);
+    RUN_TEST(test_tail_keeps_newest_lines_oldest_first);
+}
@@ -16,19 +16,78 @@
 void run_water_pump_tests(void);
 void run_config_store_tests(void);
 void run_data_storage_tests(void);
+void run_ring_log_storage_tests(void);
+void run_record_reduce_tests(void);
 void run_soil_sensor_tests(void);
 void run_bme280_tests(void);
 void run_level_sensor_tests(void);
+void run_level_sensor_bank_tests(void);
+void run_flow_meter_tests(void);
 void run_ina226_tests(void);
 void run_wifi_tests(void);
+void run_wifi_scan_cache_tests(void);
 void run_time_tests(void);
 void run_event_logger_tests(void);
 void run_api_serialize_tests(void);
 void run_api_requests_tests(void);
 void run_api_routes_tests(void);
 void run_api_static_tests(void);
+void run_api_stream_tests(void);
+void run_api_downsample_tests(void);
+void run_api_etag_tests(void);
+void run_live_stream_tests(void);
+void run_response_cache_tests(void);
+void run_asset_cache_tests(void);
+void run_api_metrics_tests(void);
+void run_request_arena_tests(void);
+void run_json_scanner_tests(void);
+void run_deflate_tests(void);
+void run_rate_limiter_tests(void);
+void run_modbus_bus_master_tests(void);
+void run_modbus_frame_capture_tests(void);
+void run_i2c_bus_master_tests(void);
+void run_power_capture_tests(void);
+void run_soil_poll_scheduler_tests(void);
+void run_soil_acquirer_tests(void);
+void run_sample_filter_tests(void);
+void run_moisture_burst_capture_tests(void);
+void run_poll_cadence_tests(void);
+void run_synthetic_sensors_tests(void);
+void run_modbus_baud_negotiator_tests(void);
+void run_modbus_rtt_tracker_tests(void);
+void run_modbus_rtu_frame_tests(void);
 void run_watering_controller_tests(void);
+void run_moisture_response_tests(void);
+void run_watering_zones_tests(void);
+void run_watering_schedule_tests(void);
 void run_reservoir_tests(void);
+void run_pump_usage_tests(void);
+void run_decision_trace_tests(void);
+void run_input_record_tests(void);
+void run_task_telemetry_tests(void);
+void run_boot_profile_tests(void);
+void run_trace_buffer_tests(void);
+void run_log_ring_tests(void);
+void run_lock_stats_tests(void);
+void run_power_locks_tests(void);
+void run_watchdog_feeds_tests(void);
+void run_lifetime_counters_tests(void);
+void run_mqtt_uplink_tests(void);
+void run_node_link_tests(void);
+void run_clock_holdover_tests(void);
+void run_duty_cycle_tests(void);
+void run_ota_pipeline_tests(void);
+void run_read_ahead_tests(void);
+void run_storage_archive_tests(void);
+void run_selftest_runner_tests(void);
+void run_event_tail_tests(void);
+void run_support_bundle_tests(void);
+void run_energy_meter_tests(void);
+void run_snapshot_publisher_tests(void);
+void run_buffer_budget_tests(void);
+void run_csv_export_tests(void);
+void run_tick_latency_tests(void);
+void run_derived_metrics_tests(void);
 
 // Unity requires setUp/tearDown definitions (shared by all suites).
 extern "C" void setUp(void) {}
@@ -40,18 +99,77 @@ extern "C" void app_main(void)
     run_water_pump_tests();
     run_config_store_tests();
     run_data_storage_tests();
+    run_ring_log_storage_tests();
+    run_record_reduce_tests();
     run_soil_sensor_tests();
     run_bme280_tests();
     run_level_sensor_tests();
+    run_level_sensor_bank_tests();
+    run_flow_meter_tests();
     run_ina226_tests();
     run_wifi_tests();
+    run_wifi_scan_cache_tests();
     run_time_tests();
     run_event_logger_tests();
     run_api_serialize_tests();
     run_api_requests_tests();
     run_api_routes_tests();
     run_api_static_tests();
+    run_api_stream_tests();
+    run_api_downsample_tests();
+    run_api_etag_tests();
+    run_live_stream_tests();
+    run_response_cache_tests();
+    run_asset_cache_tests();
+    run_api_metrics_tests();
+    run_request_arena_tests();
+    run_json_scanner_tests();
+    run_deflate_tests();
+    run_rate_limiter_tests();
+    run_modbus_bus_master_tests();
+    run_modbus_frame_capture_tests();
+    run_i2c_bus_master_tests();
+    run_power_capture_tests();
+    run_soil_poll_scheduler_tests();
+    run_soil_acquirer_tests();
+    run_sample_filter_tests();
+    run_moisture_burst_capture_tests();
+    run_poll_cadence_tests();
+    run_synthetic_sensors_tests();
+    run_modbus_baud_negotiator_tests();
+    run_modbus_rtt_tracker_tests();
+    run_modbus_rtu_frame_tests();
     run_watering_controller_tests();
+    run_moisture_response_tests();
+    run_watering_zones_tests();
+    run_watering_schedule_tests();
     run_reservoir_tests();
+    run_pump_usage_tests();
+    run_decision_trace_tests();
+    run_input_record_tests();
+    run_task_telemetry_tests();
+    run_boot_profile_tests();
+    run_trace_buffer_tests();
+    run_log_ring_tests();
+    run_lock_stats_tests();
+    run_power_locks_tests();
+    run_watchdog_feeds_tests();
+    run_lifetime_counters_tests();
+    run_mqtt_uplink_tests();
+    run_node_link_tests();
+    run_clock_holdover_tests();
+    run_duty_cycle_tests();
+    run_ota_pipeline_tests();
+    run_read_ahead_tests();
+    run_storage_archive_tests();
+    run_selftest_runner_tests();
+    run_event_tail_tests();
+    run_support_bundle_tests();
+    run_energy_meter_tests();
+    run_snapshot_publisher_tests();
+    run_buffer_budget_tests();
+    run_csv_export_tests();
+    run_tick_latency_tests();
+    run_derived_metrics_tests();
     std::exit(UNITY_END());
 }
@@ -0,0 +1,238 @@
+// SPDX-FileCopyrightText: 2026 Cryptotomte
+// SPDX-License-Identifier: AGPL-3.0-or-later
+/**
+ * @file test_modbus_baud_negotiator.cpp
+ * @brief Host suite for the soil bus line-rate change (ModbusBaudNegotiator.h).
+ *
+ * Registered by test_main.cpp via run_modbus_baud_negotiator_tests(). A
+ * simulated segment answers only when master and probe agree on the rate;
+ * a probe acknowledges the rate write at the old rate and switches right
+ * after (or, the "power-up" variant, keeps the old rate). Covers the
+ * happy path, an unreachable probe left untouched, a verify failure rolled
+ * back, the boot check falling back to a reset probe, and the code table.
+ */
+
+#include <cstddef>
+#include <cstdint>
+
+#include "unity.h"
+
+#include "interfaces/IModbusClient.h"
+#include "sensors/ModbusBaudNegotiator.h"
+
+namespace {
+
+struct SimProbe {
+    uint8_t address = 0;
+    uint32_t baud = 9600;
+    uint16_t code = 2;              ///< kSoilRegBaudRate contents
+    bool present = true;
+    bool switchesOnWrite = true;    ///< false: the code applies at power-up
+    bool acksWrites = true;
+};
+
+/// A shared segment: a transfer succeeds when the addressed probe is
+/// present and runs at the master's rate.
+class SimBus : public IModbusClient {
+public:
+    static constexpr std::size_t kMaxProbes = 4;
+
+    SimProbe probes[kMaxProbes];
+    std::size_t probeCount = 0;
+    uint32_t baud = 9600;
+    bool switchFails = false;
+    int writes = 0;
+
+    SimProbe& add(uint8_t address)
+    {
+        SimProbe& probe = probes[probeCount++];
+        probe.address = address;
+        return probe;
+    }
+
+    bool initialize() override { return true; }
+
+    bool readHoldingRegisters(uint8_t deviceAddress, uint16_t startRegister,
+                              uint16_t count, uint16_t* buffer) override
+    {
+        SimProbe* probe = reachable(deviceAddress);
+        if (probe == nullptr || startRegister != kSoilRegBaudRate || count != 1) {
+            return false;
+        }
+        buffer[0] = probe->code;
+        return true;
+    }
+
+    bool writeSingleRegister(uint8_t deviceAddress, uint16_t registerAddress,
+                             uint16_t value) override
+    {
+        ++writes;
+        SimProbe* probe = reachable(deviceAddress);
+        if (probe == nullptr || registerAddress != kSoilRegBaudRate) {
+            return false;
+        }
+        probe->code = value;
+        if (probe->switchesOnWrite) {
+            probe->baud = rateOf(value);
+        }
+        return probe->acksWrites;
+    }
+
+    bool writeMultipleRegisters(uint8_t deviceAddress, uint16_t startRegister,
+                                uint16_t count, const uint16_t* values) override
+    {
+        return count == 1 && writeSingleRegister(deviceAddress, startRegister, values[0]);
+    }
+
+    int getLastError() override { return 0; }
+    void setTimeout(uint32_t) override {}
+    void getStatistics(uint32_t* successCount, uint32_t* errorCount) override
+    {
+        *successCount = 0;
+        *errorCount = 0;
+    }
+
+    bool setBaudRate(uint32_t rate) override
+    {
+        if (switchFails) {
+            return false;
+        }
+        baud = rate;
+        return true;
+    }
+
+    uint32_t baudRate() override { return baud; }
+
+private:
+    SimProbe* reachable(uint8_t address)
+    {
+        for (std::size_t i = 0; i < probeCount; ++i) {
+            if (probes[i].address == address) {
+                return probes[i].present && probes[i].baud == baud ? &probes[i]
+                                                                   : nullptr;
+            }
+        }
+        return nullptr;
+    }
+
+    static uint32_t rateOf(uint16_t code)
+    {
+        static const uint32_t kRates[] = {2400, 4800, 9600, 19200};
+        return code < 4 ? kRates[code] : 0;
+    }
+};
+
+const uint8_t kAddresses[] = {1, 2};
+
+void test_change_moves_every_probe_and_the_master(void)
+{
+    SimBus bus;
+    bus.add(1);
+    bus.add(2);
+
+    TEST_ASSERT_EQUAL(static_cast<int>(BaudChange::Changed),
+                      static_cast<int>(changeSoilBusBaud(bus, kAddresses, 2, 19200)));
+    TEST_ASSERT_EQUAL_UINT32(19200, bus.baud);
+    TEST_ASSERT_EQUAL_UINT32(19200, bus.probes[0].baud);
+    TEST_ASSERT_EQUAL_UINT32(19200, bus.probes[1].baud);
+    TEST_ASSERT_EQUAL_UINT16(3, bus.probes[1].code);
+
+    TEST_ASSERT_EQUAL(static_cast<int>(BaudChange::Unchanged),
+                      static_cast<int>(changeSoilBusBaud(bus, kAddresses, 2, 19200)));
+    TEST_ASSERT_EQUAL(static_cast<int>(BaudChange::Unsupported),
+                      static_cast<int>(changeSoilBusBaud(bus, kAddresses, 2, 115200)));
+    TEST_ASSERT_EQUAL(static_cast<int>(BaudChange::Unsupported),
+                      static_cast<int>(changeSoilBusBaud(bus, kAddresses, 0, 9600)));
+}
+
+void test_unreachable_probe_leaves_the_segment_untouched(void)
+{
+    SimBus bus;
+    bus.add(1);
+    bus.add(2).present = false;
+
+    TEST_ASSERT_EQUAL(static_cast<int>(BaudChange::NoAnswer),
+                      static_cast<int>(changeSoilBusBaud(bus, kAddresses, 2, 19200)));
+    TEST_ASSERT_EQUAL(0, bus.writes);
+    TEST_ASSERT_EQUAL_UINT32(9600, bus.baud);
+    TEST_ASSERT_EQUAL_UINT32(9600, bus.probes[0].baud);
+}
+
+void test_verify_failure_rolls_every_probe_back(void)
+{
+    // Probe 2 takes the code but keeps 9600 until a power-up: it does not
+    // answer at 19200, so the change rolls back — probe 1 is re-coded at
+    // 19200 and probe 2's pending code is undone at 9600.
+    SimBus bus;
+    bus.add(1);
+    bus.add(2).switchesOnWrite = false;
+
+    TEST_ASSERT_EQUAL(static_cast<int>(BaudChange::RolledBack),
+                      static_cast<int>(changeSoilBusBaud(bus, kAddresses, 2, 19200)));
+    TEST_ASSERT_EQUAL_UINT32(9600, bus.baud);
+    for (std::size_t i = 0; i < 2; ++i) {
+        TEST_ASSERT_EQUAL_UINT32(9600, bus.probes[i].baud);
+        TEST_ASSERT_EQUAL_UINT16(2, bus.probes[i].code);
+    }
+
+    // A lost acknowledgement is treated as a landed write.
+    SimBus lost;
+    lost.add(1).acksWrites = false;
+    TEST_ASSERT_EQUAL(static_cast<int>(BaudChange::RolledBack),
+                      static_cast<int>(changeSoilBusBaud(lost, kAddresses, 1, 4800)));
+    TEST_ASSERT_EQUAL_UINT32(9600, lost.probes[0].baud);
+}
+
+void test_master_that_cannot_switch_is_stranded(void)
+{
+    // The probes moved but the master never follows: it cannot reach them
+    // to undo the write, so the outcome is honest about it.
+    SimBus bus;
+    bus.add(1);
+    bus.switchFails = true;
+    TEST_ASSERT_EQUAL(static_cast<int>(BaudChange::Stranded),
+                      static_cast<int>(changeSoilBusBaud(bus, kAddresses, 1, 19200)));
+    TEST_ASSERT_EQUAL_UINT32(19200, bus.probes[0].baud);
+}
+
+void test_boot_check_follows_a_factory_reset_probe(void)
+{
+    SimBus bus;
+    bus.add(1);
+    bus.baud = 19200;  // stored rate, probe back at its factory 9600
+    TEST_ASSERT_EQUAL_UINT32(9600, confirmSoilBusBaud(bus, 1, 9600));
+    TEST_ASSERT_EQUAL_UINT32(9600, bus.baud);
+
+    bus.probes[0].baud = 19200;
+    bus.baud = 19200;
+    TEST_ASSERT_EQUAL_UINT32(19200, confirmSoilBusBaud(bus, 1, 9600));
+
+    // Absent probe: the stored rate stays.
+    bus.probes[0].present = false;
+    TEST_ASSERT_EQUAL_UINT32(19200, confirmSoilBusBaud(bus, 1, 9600));
+    TEST_ASSERT_EQUAL_UINT32(19200, bus.baud);
+}
+
+void test_code_table_and_names(void)
+{
+    uint16_t code = 99;
+    TEST_ASSERT_TRUE(soilBaudCode(2400, code));
+    TEST_ASSERT_EQUAL_UINT16(0, code);
+    TEST_ASSERT_TRUE(soilBaudCode(19200, code));
+    TEST_ASSERT_EQUAL_UINT16(3, code);
+    TEST_ASSERT_FALSE(soilBaudCode(38400, code));
+    TEST_ASSERT_EQUAL_STRING("rolled-back", baudChangeName(BaudChange::RolledBack));
+    TEST_ASSERT_EQUAL_STRING("no-answer", baudChangeName(BaudChange::NoAnswer));
+}
+
+}  // namespace
+
+void run_modbus_baud_negotiator_tests(void)
+{
+    RUN_TEST(test_change_moves_every_probe_and_the_master);
+    RUN_TEST(test_unreachable_probe_leaves_the_segment_untouched);
+    RUN_TEST(test_verify_failure_rolls_every_probe_back);
+    RUN_TEST(test_master_that_cannot_switch_is_stranded);
+    RUN_TEST(test_boot_check_follows_a_factory_reset_probe);
+    RUN_TEST(test_code_table_and_names);
+}
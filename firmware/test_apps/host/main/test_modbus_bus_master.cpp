@@ -0,0 +1,321 @@
+// SPDX-FileCopyrightText: 2026 Cryptotomte
+// SPDX-License-Identifier: AGPL-3.0-or-later
+/**
+ * @file test_modbus_bus_master.cpp
+ * @brief Host suite for the RS485 bus owner's priority queue
+ *        (ModbusBusMaster.h).
+ *
+ * Before a bus task serves, transactions run on the caller; once it does,
+ * they queue and are served Control first, in arrival order within a
+ * class, with onDone called on the serving thread. Queue wait and bus time
+ * are recorded apart. Ports keep their own last error and share the
+ * transfer counters; execute() waits for a serving thread. Register
+ * transfers are split per slave and function by outcome, with their
+ * latency bucketed; a multi-register write is one of them.
+ */
+
+#include <atomic>
+#include <cstdint>
+#include <thread>
+#include <vector>
+
+#include "unity.h"
+
+#include "sensors/ModbusBusMaster.h"
+#include "sensors/testing/MockModbusClient.h"
+
+namespace {
+
+int64_t gNowUs = 0;
+
+int64_t fakeClock()
+{
+    return gNowUs;
+}
+
+/// A mock whose transfers take @c transferUs of the fake clock.
+class SlowModbusClient : public MockModbusClient {
+public:
+    int64_t transferUs = 0;
+
+    bool readHoldingRegisters(uint8_t deviceAddress, uint16_t startRegister,
+                              uint16_t count, uint16_t* buffer) override
+    {
+        gNowUs += transferUs;
+        return MockModbusClient::readHoldingRegisters(deviceAddress, startRegister,
+                                                      count, buffer);
+    }
+};
+
+void countDone(ModbusTransaction& txn, void* context)
+{
+    auto& order = *static_cast<std::vector<uint16_t>*>(context);
+    order.push_back(txn.reg);
+}
+
+void readTxn(ModbusTransaction& txn, ModbusPriority priority, uint16_t reg,
+             uint16_t* buffer, std::vector<uint16_t>& order)
+{
+    txn.op = ModbusTransaction::Op::ReadHolding;
+    txn.priority = priority;
+    txn.deviceAddress = 0x01;
+    txn.reg = reg;
+    txn.count = 1;
+    txn.buffer = buffer;
+    txn.onDone = &countDone;
+    txn.context = &order;
+}
+
+void test_runs_inline_until_served()
+{
+    MockModbusClient mock;
+    mock.setRegisters(0x01, 0x0000, {42});
+    ModbusBusMaster bus(mock);
+    IModbusClient& port = bus.port(ModbusPriority::Control);
+
+    TEST_ASSERT_TRUE(port.initialize());
+    TEST_ASSERT_EQUAL_INT(1, mock.initializeCalls);
+    uint16_t value = 0;
+    TEST_ASSERT_TRUE(port.readHoldingRegisters(0x01, 0x0000, 1, &value));
+    TEST_ASSERT_EQUAL_UINT16(42, value);
+    TEST_ASSERT_EQUAL_UINT32(0, bus.depth());
+    TEST_ASSERT_EQUAL_UINT32(2, bus.stats(ModbusPriority::Control).transactions);
+
+    port.setTimeout(1500);
+    TEST_ASSERT_EQUAL_UINT32(1, mock.timeoutCalls.size());
+    TEST_ASSERT_EQUAL_UINT32(1500, mock.timeoutCalls[0]);
+}
+
+void test_control_is_served_before_diagnostic()
+{
+    MockModbusClient mock;
+    mock.initialize();
+    ModbusBusMaster bus(mock);
+    TEST_ASSERT_FALSE(bus.serve(0));  // the bus task is up; nothing queued
+
+    std::vector<uint16_t> order;
+    uint16_t buf[4] = {};
+    ModbusTransaction diagA, diagB, control1, control2;
+    readTxn(diagA, ModbusPriority::Diagnostic, 0xA, &buf[0], order);
+    readTxn(diagB, ModbusPriority::Diagnostic, 0xB, &buf[1], order);
+    readTxn(control1, ModbusPriority::Control, 0x1, &buf[2], order);
+    readTxn(control2, ModbusPriority::Control, 0x2, &buf[3], order);
+    bus.submit(diagA);
+    bus.submit(diagB);
+    bus.submit(control1);
+    bus.submit(control2);
+    TEST_ASSERT_EQUAL_UINT32(4, bus.depth());
+    TEST_ASSERT_TRUE(mock.calls.empty());  // queued, not run
+    TEST_ASSERT_FALSE(diagA.done.load());
+
+    while (bus.serve(0)) {
+    }
+    const std::vector<uint16_t> expected = {0x1, 0x2, 0xA, 0xB};
+    TEST_ASSERT_TRUE(order == expected);
+    TEST_ASSERT_EQUAL_UINT32(4, mock.calls.size());
+    TEST_ASSERT_EQUAL_UINT16(0x1, mock.calls[0].startRegister);
+    TEST_ASSERT_EQUAL_UINT16(0xB, mock.calls[3].startRegister);
+    TEST_ASSERT_TRUE(diagB.done.load());
+    TEST_ASSERT_EQUAL_UINT32(0, bus.depth());
+    TEST_ASSERT_EQUAL_UINT32(2, bus.stats(ModbusPriority::Control).transactions);
+    TEST_ASSERT_EQUAL_UINT32(2, bus.stats(ModbusPriority::Diagnostic).transactions);
+}
+
+void test_queue_wait_and_bus_time_are_apart()
+{
+    SlowModbusClient mock;
+    mock.transferUs = 3000;
+    mock.initialize();
+    gNowUs = 1000;
+    ModbusBusMaster bus(mock, &fakeClock);
+    bus.serve(0);
+
+    std::vector<uint16_t> order;
+    uint16_t buf[2] = {};
+    ModbusTransaction first, second;
+    readTxn(first, ModbusPriority::Diagnostic, 0x1, &buf[0], order);
+    readTxn(second, ModbusPriority::Diagnostic, 0x2, &buf[1], order);
+    bus.submit(first);
+    bus.submit(second);
+    gNowUs += 500;  // the bus task wakes half a millisecond later
+    while (bus.serve(0)) {
+    }
+    TEST_ASSERT_EQUAL_INT64(500, first.queueUs);
+    TEST_ASSERT_EQUAL_INT64(3000, first.busUs);
+    TEST_ASSERT_EQUAL_INT64(3500, second.queueUs);  // waited out the first
+    TEST_ASSERT_EQUAL_INT64(3000, second.busUs);
+
+    const ModbusQueueStats s = bus.stats(ModbusPriority::Diagnostic);
+    TEST_ASSERT_EQUAL_UINT32(2, s.transactions);
+    TEST_ASSERT_EQUAL_UINT64(4000, s.queueUsTotal);
+    TEST_ASSERT_EQUAL_UINT32(3500, s.queueUsMax);
+    TEST_ASSERT_EQUAL_UINT64(6000, s.busUsTotal);
+    TEST_ASSERT_EQUAL_UINT32(3000, s.busUsMax);
+    TEST_ASSERT_EQUAL_UINT32(0, bus.stats(ModbusPriority::Control).transactions);
+}
+
+void test_ports_keep_their_own_error()
+{
+    MockModbusClient mock;
+    mock.initialize();
+    ModbusBusMaster bus(mock);
+    IModbusClient& control = bus.port(ModbusPriority::Control);
+    IModbusClient& diagnostic = bus.port(ModbusPriority::Diagnostic);
+
+    mock.queueOutcome(MockModbusClient::kErrTimeout);
+    uint16_t value = 0;
+    TEST_ASSERT_FALSE(diagnostic.readHoldingRegisters(0x01, 0x0000, 1, &value));
+    TEST_ASSERT_TRUE(control.writeSingleRegister(0x01, 0x0022, 7));
+    TEST_ASSERT_EQUAL_INT(MockModbusClient::kErrTimeout, diagnostic.getLastError());
+    TEST_ASSERT_EQUAL_INT(0, control.getLastError());
+
+    uint32_t successes = 0;
+    uint32_t errors = 0;
+    diagnostic.getStatistics(&successes, &errors);
+    TEST_ASSERT_EQUAL_UINT32(1, successes);  // counted across ports
+    TEST_ASSERT_EQUAL_UINT32(1, errors);
+}
+
+void test_execute_waits_for_the_bus_task()
+{
+    MockModbusClient mock;
+    mock.setRegisters(0x01, 0x0003, {7});
+    mock.initialize();
+    ModbusBusMaster bus(mock);
+    bus.serve(0);
+
+    std::atomic<bool> stop{false};
+    std::thread busTask([&] {
+        while (!stop) {
+            bus.serve(5);
+        }
+    });
+    uint16_t values[8] = {};
+    std::thread diagnostic([&] {
+        for (int i = 0; i < 4; ++i) {
+            bus.port(ModbusPriority::Diagnostic).readHoldingRegisters(0x01, 0x0003, 1,
+                                                                      &values[i]);
+        }
+    });
+    for (int i = 4; i < 8; ++i) {
+        TEST_ASSERT_TRUE(bus.port(ModbusPriority::Control)
+                             .readHoldingRegisters(0x01, 0x0003, 1, &values[i]));
+    }
+    diagnostic.join();
+    stop = true;
+    busTask.join();
+
+    for (uint16_t v : values) {
+        TEST_ASSERT_EQUAL_UINT16(7, v);
+    }
+    TEST_ASSERT_EQUAL_UINT32(8, mock.calls.size());
+}
+
+void test_link_stats_split_outcomes_per_slave_and_function()
+{
+    SlowModbusClient mock;
+    mock.transferUs = 45000;  // a 45 ms read: the 80 ms bucket
+    mock.setRegisters(0x01, 0x0000, {1});
+    mock.initialize();
+    gNowUs = 1000000;
+    ModbusBusMaster bus(mock, &fakeClock);
+    IModbusClient& port = bus.port(ModbusPriority::Control);
+
+    uint16_t value = 0;
+    TEST_ASSERT_TRUE(port.readHoldingRegisters(0x01, 0x0000, 1, &value));
+    mock.queueOutcome(MockModbusClient::kErrBus);
+    TEST_ASSERT_FALSE(port.readHoldingRegisters(0x01, 0x0000, 1, &value));
+    mock.queueOutcome(MockModbusClient::kErrTimeout);
+    TEST_ASSERT_FALSE(port.readHoldingRegisters(0x02, 0x0000, 1, &value));
+    mock.queueOutcome(MockModbusClient::kErrExceptionBase + 2);
+    TEST_ASSERT_FALSE(port.writeSingleRegister(0x01, 0x0022, 7));
+    port.setTimeout(500);  // not a register transfer
+
+    const std::vector<ModbusLinkStats> links = bus.linkStats();
+    TEST_ASSERT_EQUAL_size_t(3, links.size());
+    TEST_ASSERT_EQUAL_UINT8(0x01, links[0].address);
+    TEST_ASSERT_EQUAL_UINT8(kModbusReadHolding, links[0].function);
+    TEST_ASSERT_EQUAL_UINT32(1, links[0].ok);
+    TEST_ASSERT_EQUAL_UINT32(1, links[0].frameErrors);
+    TEST_ASSERT_EQUAL_UINT32(2, links[0].latency[3]);
+    TEST_ASSERT_EQUAL_UINT64(90000, links[0].latencySumUs);
+    TEST_ASSERT_EQUAL_INT64(1045000, links[0].lastSuccessUs);
+    TEST_ASSERT_EQUAL_UINT32(80000, modbusLatencyQuantileUs(links[0], 950));
+
+    TEST_ASSERT_EQUAL_UINT8(0x02, links[1].address);
+    TEST_ASSERT_EQUAL_UINT32(1, links[1].timeouts);
+    TEST_ASSERT_EQUAL_INT64(-1, links[1].lastSuccessUs);
+    TEST_ASSERT_EQUAL_UINT8(kModbusWriteSingle, links[2].function);
+    TEST_ASSERT_EQUAL_UINT32(1, links[2].exceptions);
+    TEST_ASSERT_EQUAL_UINT32(1, links[2].transfers());
+    TEST_ASSERT_EQUAL_UINT32(0, bus.untrackedTransfers());
+}
+
+void test_write_multiple_is_one_transaction()
+{
+    MockModbusClient mock;
+    mock.initialize();
+    ModbusBusMaster bus(mock);
+    IModbusClient& port = bus.port(ModbusPriority::Diagnostic);
+
+    const uint16_t values[] = {100, 200, 300};
+    TEST_ASSERT_TRUE(port.writeMultipleRegisters(0x01, 0x0100, 3, values));
+    TEST_ASSERT_EQUAL_size_t(1, mock.calls.size());
+    TEST_ASSERT_TRUE(mock.calls[0].type == MockModbusClient::Call::Type::WriteMultiple);
+    TEST_ASSERT_EQUAL_UINT16(0x0100, mock.calls[0].startRegister);
+    TEST_ASSERT_EQUAL_UINT16(3, mock.calls[0].count);
+    TEST_ASSERT_EQUAL_size_t(3, mock.calls[0].values.size());
+    TEST_ASSERT_EQUAL_UINT16(300, mock.calls[0].values[2]);
+
+    mock.queueOutcome(MockModbusClient::kErrTimeout);
+    TEST_ASSERT_FALSE(port.writeMultipleRegisters(0x01, 0x0100, 3, values));
+    TEST_ASSERT_EQUAL_INT(MockModbusClient::kErrTimeout, port.getLastError());
+
+    const std::vector<ModbusLinkStats> links = bus.linkStats();
+    TEST_ASSERT_EQUAL_size_t(1, links.size());
+    TEST_ASSERT_EQUAL_UINT8(kModbusWriteMultiple, links[0].function);
+    TEST_ASSERT_EQUAL_UINT32(1, links[0].ok);
+    TEST_ASSERT_EQUAL_UINT32(1, links[0].timeouts);
+    uint32_t ok = 0;
+    uint32_t failed = 0;
+    port.getStatistics(&ok, &failed);
+    TEST_ASSERT_EQUAL_UINT32(1, ok);
+    TEST_ASSERT_EQUAL_UINT32(1, failed);
+}
+
+void test_link_table_bounds_and_quantiles()
+{
+    ModbusLinkTable table;
+    for (std::size_t i = 0; i < kModbusLinks; ++i) {
+        table.record(static_cast<uint8_t>(i + 1), kModbusReadHolding, 0, 1000, 0);
+    }
+    table.record(99, kModbusReadHolding, 1, 0, 0);
+    TEST_ASSERT_EQUAL_size_t(kModbusLinks, table.snapshot().size());
+    TEST_ASSERT_EQUAL_UINT32(1, table.untracked());
+    TEST_ASSERT_EQUAL_UINT32(1, table.snapshot()[0].ok);
+
+    ModbusLinkStats link;
+    TEST_ASSERT_EQUAL_UINT32(0, modbusLatencyQuantileUs(link, 500));
+    link.latency[0] = 90;                       // <= 10 ms
+    link.latency[kModbusLatencyBuckets] = 10;   // timeouts past 2.56 s
+    TEST_ASSERT_EQUAL_UINT32(10000, modbusLatencyQuantileUs(link, 500));
+    TEST_ASSERT_EQUAL_UINT32(10000, modbusLatencyQuantileUs(link, 900));
+    TEST_ASSERT_EQUAL_UINT32(UINT32_MAX, modbusLatencyQuantileUs(link, 950));
+    TEST_ASSERT_EQUAL_size_t(0, modbusLatencyBucket(10000));
+    TEST_ASSERT_EQUAL_size_t(1, modbusLatencyBucket(10001));
+    TEST_ASSERT_EQUAL_size_t(kModbusLatencyBuckets, modbusLatencyBucket(3000000));
+}
+
+}  // namespace
+
+void run_modbus_bus_master_tests(void)
+{
+    RUN_TEST(test_runs_inline_until_served);
+    RUN_TEST(test_control_is_served_before_diagnostic);
+    RUN_TEST(test_queue_wait_and_bus_time_are_apart);
+    RUN_TEST(test_ports_keep_their_own_error);
+    RUN_TEST(test_execute_waits_for_the_bus_task);
+    RUN_TEST(test_link_stats_split_outcomes_per_slave_and_function);
+    RUN_TEST(test_write_multiple_is_one_transaction);
+    RUN_TEST(test_link_table_bounds_and_quantiles);
+}
@@ -0,0 +1,172 @@
+// SPDX-FileCopyrightText: 2026 Cryptotomte
+// SPDX-License-Identifier: AGPL-3.0-or-later
+/**
+ * @file test_modbus_frame_capture.cpp
+ * @brief Host suite for the RS485 frame ring (sensors/ModbusFrameCapture.h)
+ *        and the /modbus/capture dump.
+ *
+ * Registered by test_main.cpp via run_modbus_frame_capture_tests(). Frames
+ * are numbered from 1 and read oldest first past a cursor; the CRC verdict
+ * is the frame's own; long frames keep their length but only kMaxBytes
+ * bytes; wrap-around loses the oldest; a frozen capture records nothing.
+ * The dump is the little-endian layout ApiStream.h documents.
+ */
+
+#include <cstdint>
+#include <string>
+
+#include "unity.h"
+
+#include "api/ApiStream.h"
+#include "sensors/ModbusFrameCapture.h"
+#include "sensors/ModbusRtuFrame.h"
+
+namespace {
+
+void test_frames_read_oldest_first_with_crc_verdict(void)
+{
+    ModbusFrameCapture capture;
+    ModbusFrame out[4];
+    TEST_ASSERT_EQUAL_UINT32(0, capture.written());
+    TEST_ASSERT_EQUAL_size_t(0, capture.read(out, 4));
+
+    uint8_t request[kModbusRequestBytes];
+    buildReadHoldingRequest(0x01, 0x0000, 1, request);
+    capture.record(ModbusFrameDir::Tx, 1000, request, sizeof(request));
+    uint8_t corrupt[kModbusRequestBytes];
+    for (std::size_t i = 0; i < sizeof(corrupt); ++i) {
+        corrupt[i] = request[i];
+    }
+    corrupt[3] ^= 0x01;
+    capture.record(ModbusFrameDir::Rx, 1500, corrupt, sizeof(corrupt));
+    capture.record(ModbusFrameDir::Rx, 4000, nullptr, 0);  // timeout
+    TEST_ASSERT_EQUAL_UINT32(3, capture.written());
+
+    TEST_ASSERT_EQUAL_size_t(3, capture.read(out, 4));
+    TEST_ASSERT_EQUAL_UINT32(1, out[0].sequence);
+    TEST_ASSERT_EQUAL_UINT32(1000, out[0].atUs);
+    TEST_ASSERT_TRUE(out[0].dir == ModbusFrameDir::Tx);
+    TEST_ASSERT_TRUE(out[0].crcOk);
+    TEST_ASSERT_EQUAL_UINT16(kModbusRequestBytes, out[0].length);
+    TEST_ASSERT_EQUAL_UINT8_ARRAY(request, out[0].bytes.data(), sizeof(request));
+
+    TEST_ASSERT_TRUE(out[1].dir == ModbusFrameDir::Rx);
+    TEST_ASSERT_FALSE(out[1].crcOk);
+    TEST_ASSERT_EQUAL_UINT8(corrupt[3], out[1].bytes[3]);
+
+    TEST_ASSERT_EQUAL_UINT16(0, out[2].length);
+    TEST_ASSERT_FALSE(out[2].crcOk);
+    TEST_ASSERT_EQUAL_size_t(0, out[2].stored());
+
+    // Past a cursor.
+    TEST_ASSERT_EQUAL_size_t(1, capture.read(out, 4, 2));
+    TEST_ASSERT_EQUAL_UINT32(3, out[0].sequence);
+}
+
+void test_long_frame_keeps_length_and_first_bytes(void)
+{
+    ModbusFrameCapture capture;
+    uint8_t frame[kModbusMaxResponseBytes];
+    for (std::size_t i = 0; i < sizeof(frame); ++i) {
+        frame[i] = static_cast<uint8_t>(i);
+    }
+    const uint16_t crc = modbusCrc16(frame, sizeof(frame) - 2);
+    frame[sizeof(frame) - 2] = static_cast<uint8_t>(crc & 0xFF);
+    frame[sizeof(frame) - 1] = static_cast<uint8_t>(crc >> 8);
+    capture.record(ModbusFrameDir::Rx, 7, frame, sizeof(frame));
+
+    ModbusFrame out[1];
+    TEST_ASSERT_EQUAL_size_t(1, capture.read(out, 1));
+    TEST_ASSERT_EQUAL_UINT16(sizeof(frame), out[0].length);
+    TEST_ASSERT_TRUE(out[0].crcOk);  // checked over the whole frame
+    TEST_ASSERT_EQUAL_size_t(ModbusFrameCapture::kMaxBytes, out[0].stored());
+    TEST_ASSERT_EQUAL_UINT8_ARRAY(frame, out[0].bytes.data(), ModbusFrameCapture::kMaxBytes);
+}
+
+void test_wrap_keeps_the_newest_and_freeze_stops(void)
+{
+    ModbusFrameCapture capture;
+    const uint8_t byte = 0x5A;
+    for (uint32_t i = 1; i <= ModbusFrameCapture::kCapacity + 5; ++i) {
+        capture.record(ModbusFrameDir::Tx, i, &byte, 1);
+    }
+    ModbusFrame out[ModbusFrameCapture::kCapacity + 5];
+    TEST_ASSERT_EQUAL_size_t(ModbusFrameCapture::kCapacity,
+                             capture.read(out, ModbusFrameCapture::kCapacity + 5));
+    TEST_ASSERT_EQUAL_UINT32(6, out[0].sequence);
+    TEST_ASSERT_EQUAL_UINT32(ModbusFrameCapture::kCapacity + 5,
+                             out[ModbusFrameCapture::kCapacity - 1].sequence);
+
+    capture.setEnabled(false);
+    TEST_ASSERT_FALSE(capture.enabled());
+    capture.record(ModbusFrameDir::Tx, 999, &byte, 1);
+    TEST_ASSERT_EQUAL_UINT32(ModbusFrameCapture::kCapacity + 5, capture.written());
+    capture.setEnabled(true);
+    capture.record(ModbusFrameDir::Tx, 1000, &byte, 1);
+    TEST_ASSERT_EQUAL_UINT32(ModbusFrameCapture::kCapacity + 6, capture.written());
+}
+
+struct StringSink final : api::IChunkSink {
+    std::string body;
+
+    bool send(const char* data, std::size_t len) override
+    {
+        body.append(data, len);
+        return true;
+    }
+};
+
+uint32_t u32At(const std::string& body, std::size_t at)
+{
+    uint32_t v = 0;
+    for (std::size_t i = 0; i < 4; ++i) {
+        v |= static_cast<uint32_t>(static_cast<unsigned char>(body[at + i])) << (8 * i);
+    }
+    return v;
+}
+
+void test_dump_layout(void)
+{
+    ModbusFrameCapture capture;
+    uint8_t request[kModbusRequestBytes];
+    buildReadHoldingRequest(0x02, 0x0010, 2, request);
+    capture.record(ModbusFrameDir::Tx, 0x01020304, request, sizeof(request));
+    capture.record(ModbusFrameDir::Rx, 0x01020400, nullptr, 0);
+    capture.setEnabled(false);
+
+    StringSink sink;
+    TEST_ASSERT_TRUE(api::streamModbusCapture(capture, 0x0A0B0C0D, 0, sink));
+    TEST_ASSERT_EQUAL_size_t(16 + 12 + kModbusRequestBytes + 12, sink.body.size());
+    TEST_ASSERT_EQUAL_STRING("WSF1", sink.body.substr(0, 4).c_str());
+    TEST_ASSERT_EQUAL_UINT32(0x0A0B0C0D, u32At(sink.body, 4));
+    TEST_ASSERT_EQUAL_UINT32(2, u32At(sink.body, 8));   // written
+    TEST_ASSERT_EQUAL_UINT32(0, u32At(sink.body, 12));  // frozen
+
+    std::size_t r = 16;
+    TEST_ASSERT_EQUAL_UINT32(1, u32At(sink.body, r));
+    TEST_ASSERT_EQUAL_UINT32(0x01020304, u32At(sink.body, r + 4));
+    TEST_ASSERT_EQUAL_INT(0, static_cast<unsigned char>(sink.body[r + 8]));   // tx
+    TEST_ASSERT_EQUAL_INT(1, static_cast<unsigned char>(sink.body[r + 9]));   // crc ok
+    TEST_ASSERT_EQUAL_INT(kModbusRequestBytes, static_cast<unsigned char>(sink.body[r + 10]));
+    TEST_ASSERT_EQUAL_INT(0, static_cast<unsigned char>(sink.body[r + 11]));
+    TEST_ASSERT_EQUAL_INT(0x02, static_cast<unsigned char>(sink.body[r + 12]));
+    r += 12 + kModbusRequestBytes;
+    TEST_ASSERT_EQUAL_UINT32(2, u32At(sink.body, r));
+    TEST_ASSERT_EQUAL_INT(1, static_cast<unsigned char>(sink.body[r + 8]));   // rx
+    TEST_ASSERT_EQUAL_INT(0, static_cast<unsigned char>(sink.body[r + 10]));  // timeout
+
+    // Past a cursor: the header only plus the newer frame.
+    StringSink tail;
+    TEST_ASSERT_TRUE(api::streamModbusCapture(capture, 0, 1, tail));
+    TEST_ASSERT_EQUAL_size_t(16 + 12, tail.body.size());
+}
+
+}  // namespace
+
+void run_modbus_frame_capture_tests(void)
+{
+    RUN_TEST(test_frames_read_oldest_first_with_crc_verdict);
+    RUN_TEST(test_long_frame_keeps_length_and_first_bytes);
+    RUN_TEST(test_wrap_keeps_the_newest_and_freeze_stops);
+    RUN_TEST(test_dump_layout);
+}
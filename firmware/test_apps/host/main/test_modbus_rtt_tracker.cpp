@@ -0,0 +1,136 @@
+// SPDX-FileCopyrightText: 2026 Cryptotomte
+// SPDX-License-Identifier: AGPL-3.0-or-later
+/**
+ * @file test_modbus_rtt_tracker.cpp
+ * @brief Host suite for the adaptive Modbus response timeout
+ *        (ModbusRttTracker.h).
+ *
+ * An unknown slave gets the configured timeout; a healthy one is held to
+ * the floor; a slow or jittery one gets room above its p95 and never more
+ * than the ceiling. Consecutive timeouts bring the configured value back
+ * at doubling counts; an answer resets them. The least recently used slave
+ * makes way for a new one.
+ */
+
+#include <cstdint>
+
+#include "unity.h"
+
+#include "sensors/ModbusRttTracker.h"
+
+namespace {
+
+constexpr uint32_t kConfiguredMs = 3000;
+
+void answer(ModbusRttTracker& rtt, uint8_t address, uint32_t rttUs, int times)
+{
+    for (int i = 0; i < times; ++i) {
+        rtt.recordAnswer(address, rttUs);
+    }
+}
+
+void test_unknown_slave_gets_configured()
+{
+    ModbusRttTracker rtt(kConfiguredMs);
+    TEST_ASSERT_EQUAL_UINT32(kConfiguredMs, rtt.timeoutFor(1));
+    TEST_ASSERT_EQUAL_size_t(0, rtt.size());
+
+    // Never answered: the first request was the long one, then the ceiling.
+    rtt.recordTimeout(1);
+    TEST_ASSERT_EQUAL_UINT32(ModbusRttTracker::kCeilingMs, rtt.timeoutFor(1));
+    TEST_ASSERT_EQUAL_size_t(1, rtt.size());
+}
+
+void test_healthy_slave_is_held_to_the_floor()
+{
+    ModbusRttTracker rtt(kConfiguredMs);
+    answer(rtt, 1, 50000, 20);  // 50 ms, steady
+    const ModbusSlaveRtt s = rtt.slave(0);
+    TEST_ASSERT_EQUAL_UINT8(1, s.address);
+    TEST_ASSERT_EQUAL_UINT32(20, s.samples);
+    TEST_ASSERT_EQUAL_UINT32(50000, s.srttUs);
+    TEST_ASSERT_EQUAL_UINT32(50000, s.p95Us);
+    TEST_ASSERT_TRUE(s.rttvarUs < 1000);
+    TEST_ASSERT_EQUAL_UINT32(ModbusRttTracker::kFloorMs, rtt.timeoutFor(1));
+    TEST_ASSERT_EQUAL_UINT32(ModbusRttTracker::kFloorMs, s.timeoutMs);
+}
+
+void test_outliers_widen_the_timeout()
+{
+    ModbusRttTracker rtt(kConfiguredMs);
+    answer(rtt, 1, 50000, 7);
+    answer(rtt, 1, 300000, 2);  // two 300 ms answers in the window of 16
+    answer(rtt, 1, 50000, 7);   // long enough ago for the EWMA to settle
+    const ModbusSlaveRtt s = rtt.slave(0);
+    TEST_ASSERT_EQUAL_UINT32(300000, s.p95Us);
+    TEST_ASSERT_EQUAL_UINT32(450, rtt.timeoutFor(1));  // 1.5 × p95 wins
+
+    // A very slow slave is capped at the ceiling, not the configured value.
+    answer(rtt, 2, 900000, 4);
+    TEST_ASSERT_EQUAL_UINT32(ModbusRttTracker::kCeilingMs, rtt.timeoutFor(2));
+
+    // The configured value bounds the ceiling too.
+    rtt.setConfigured(400);
+    TEST_ASSERT_EQUAL_UINT32(400, rtt.timeoutFor(1));
+    TEST_ASSERT_EQUAL_UINT32(400, rtt.timeoutFor(3));
+}
+
+void test_timeouts_fall_back_at_doubling_counts()
+{
+    ModbusRttTracker rtt(kConfiguredMs);
+    answer(rtt, 7, 50000, 8);
+    uint32_t fallbacks[100] = {};
+    for (uint32_t n = 1; n < 100; ++n) {
+        rtt.recordTimeout(7);
+        fallbacks[n] = rtt.timeoutFor(7);
+    }
+    for (uint32_t n = 1; n < 100; ++n) {
+        const bool expected = n == 3 || n == 6 || n == 12 || n == 24 || n == 48 || n == 96;
+        TEST_ASSERT_EQUAL_UINT32(expected ? kConfiguredMs : ModbusRttTracker::kFloorMs,
+                                 fallbacks[n]);
+    }
+    TEST_ASSERT_EQUAL_UINT32(99, rtt.slave(0).consecutiveTimeouts);
+
+    // One answer resets the count and keeps the old estimate.
+    rtt.recordAnswer(7, 50000);
+    TEST_ASSERT_EQUAL_UINT32(0, rtt.slave(0).consecutiveTimeouts);
+    TEST_ASSERT_EQUAL_UINT32(ModbusRttTracker::kFloorMs, rtt.timeoutFor(7));
+}
+
+void test_ewma_follows_drift()
+{
+    ModbusRttTracker rtt(kConfiguredMs);
+    answer(rtt, 1, 40000, 16);
+    answer(rtt, 1, 200000, 32);  // the probe got slow and stayed slow
+    const ModbusSlaveRtt s = rtt.slave(0);
+    TEST_ASSERT_TRUE(s.srttUs > 190000 && s.srttUs <= 200000);
+    TEST_ASSERT_EQUAL_UINT32(200000, s.p95Us);
+    TEST_ASSERT_EQUAL_UINT32(300, rtt.timeoutFor(1));
+}
+
+void test_least_recently_used_slave_is_evicted()
+{
+    ModbusRttTracker rtt(kConfiguredMs);
+    for (uint8_t a = 1; a <= ModbusRttTracker::kMaxSlaves; ++a) {
+        rtt.recordAnswer(a, 50000);
+    }
+    rtt.recordAnswer(1, 50000);  // 2 is now the oldest
+    rtt.recordAnswer(100, 50000);
+    TEST_ASSERT_EQUAL_size_t(ModbusRttTracker::kMaxSlaves, rtt.size());
+    TEST_ASSERT_EQUAL_UINT32(kConfiguredMs, rtt.timeoutFor(2));
+    TEST_ASSERT_EQUAL_UINT32(ModbusRttTracker::kFloorMs, rtt.timeoutFor(1));
+    TEST_ASSERT_EQUAL_UINT32(ModbusRttTracker::kFloorMs, rtt.timeoutFor(100));
+    TEST_ASSERT_EQUAL_UINT8(0, rtt.slave(ModbusRttTracker::kMaxSlaves).address);
+}
+
+}  // namespace
+
+void run_modbus_rtt_tracker_tests(void)
+{
+    RUN_TEST(test_unknown_slave_gets_configured);
+    RUN_TEST(test_healthy_slave_is_held_to_the_floor);
+    RUN_TEST(test_outliers_widen_the_timeout);
+    RUN_TEST(test_timeouts_fall_back_at_doubling_counts);
+    RUN_TEST(test_ewma_follows_drift);
+    RUN_TEST(test_least_recently_used_slave_is_evicted);
+}
@@ -0,0 +1,137 @@
+// SPDX-FileCopyrightText: 2026 Cryptotomte
+// SPDX-License-Identifier: AGPL-3.0-or-later
+/**
+ * @file test_modbus_rtu_frame.cpp
+ * @brief Host suite for the Modbus RTU framing behind UartModbusClient
+ *        (ModbusRtuFrame.h).
+ *
+ * Requests carry the CRC low byte first; responses are checked for CRC,
+ * address, function, byte count and (for 0x06) the full echo, (for 0x10)
+ * the echoed start and count; a slave
+ * exception comes back as 100+n. The expected length follows the header
+ * as it arrives.
+ */
+
+#include <cstdint>
+
+#include "unity.h"
+
+#include "sensors/ModbusRtuFrame.h"
+
+namespace {
+
+void test_request_carries_crc_low_byte_first()
+{
+    uint8_t frame[kModbusRequestBytes] = {};
+    buildReadHoldingRequest(1, 0x0000, 1, frame);
+    const uint8_t expected[] = {0x01, 0x03, 0x00, 0x00, 0x00, 0x01, 0x84, 0x0A};
+    TEST_ASSERT_EQUAL_UINT8_ARRAY(expected, frame, kModbusRequestBytes);
+    TEST_ASSERT_EQUAL_HEX16(0x0A84, modbusCrc16(frame, 6));
+    // The CRC over a frame including its own CRC is zero.
+    TEST_ASSERT_EQUAL_HEX16(0x0000, modbusCrc16(frame, kModbusRequestBytes));
+
+    buildWriteSingleRequest(2, 0x0020, 0x1234, frame);
+    const uint8_t write[] = {0x02, 0x06, 0x00, 0x20, 0x12, 0x34, 0x85, 0x44};
+    TEST_ASSERT_EQUAL_UINT8_ARRAY(write, frame, kModbusRequestBytes);
+}
+
+void test_read_response_decodes_registers()
+{
+    const uint8_t frame[] = {0x01, 0x03, 0x04, 0x01, 0x2C, 0x00, 0xFA, 0xBA, 0x45};
+    uint16_t regs[2] = {0, 0};
+    TEST_ASSERT_EQUAL_INT(0, parseReadHoldingResponse(frame, sizeof frame, 1, 2, regs));
+    TEST_ASSERT_EQUAL_UINT16(300, regs[0]);
+    TEST_ASSERT_EQUAL_UINT16(250, regs[1]);
+}
+
+void test_read_response_rejects_bad_frames()
+{
+    uint8_t frame[] = {0x01, 0x03, 0x04, 0x01, 0x2C, 0x00, 0xFA, 0xBA, 0x45};
+    uint16_t regs[2] = {7, 7};
+    // Another slave, another count, a truncated frame.
+    TEST_ASSERT_EQUAL_INT(2, parseReadHoldingResponse(frame, sizeof frame, 2, 2, regs));
+    TEST_ASSERT_EQUAL_INT(2, parseReadHoldingResponse(frame, sizeof frame, 1, 1, regs));
+    TEST_ASSERT_EQUAL_INT(2, parseReadHoldingResponse(frame, sizeof frame - 1, 1, 2, regs));
+    // One flipped bit fails the CRC; the buffer is left alone.
+    frame[4] ^= 0x01;
+    TEST_ASSERT_EQUAL_INT(2, parseReadHoldingResponse(frame, sizeof frame, 1, 2, regs));
+    TEST_ASSERT_EQUAL_UINT16(7, regs[0]);
+    TEST_ASSERT_EQUAL_INT(2, parseReadHoldingResponse(nullptr, 0, 1, 2, regs));
+}
+
+void test_exception_keeps_its_code()
+{
+    const uint8_t frame[] = {0x01, 0x83, 0x02, 0xC0, 0xF1};
+    uint16_t reg = 0;
+    TEST_ASSERT_EQUAL_INT(102, parseReadHoldingResponse(frame, sizeof frame, 1, 1, &reg));
+    // The same exception to a 0x06 request is a function mismatch.
+    TEST_ASSERT_EQUAL_INT(2, parseWriteSingleResponse(frame, sizeof frame, 1, 0, 0));
+}
+
+void test_write_echo_is_compared_in_full()
+{
+    uint8_t echo[kModbusRequestBytes] = {};
+    buildWriteSingleRequest(2, 0x0020, 0x1234, echo);
+    TEST_ASSERT_EQUAL_INT(0, parseWriteSingleResponse(echo, sizeof echo, 2, 0x0020, 0x1234));
+    TEST_ASSERT_EQUAL_INT(2, parseWriteSingleResponse(echo, sizeof echo, 2, 0x0021, 0x1234));
+    TEST_ASSERT_EQUAL_INT(2, parseWriteSingleResponse(echo, sizeof echo, 2, 0x0020, 0x1235));
+}
+
+void test_write_multiple_request_and_echo()
+{
+    const uint16_t values[] = {0x0064, 0x00C8, 0x012C};
+    uint8_t frame[kModbusMaxRequestBytes] = {};
+    const std::size_t len = buildWriteMultipleRequest(1, 0x0100, 3, values, frame);
+    TEST_ASSERT_EQUAL_size_t(modbusWriteMultipleRequestBytes(3), len);
+    const uint8_t header[] = {0x01, 0x10, 0x01, 0x00, 0x00, 0x03, 0x06,
+                              0x00, 0x64, 0x00, 0xC8, 0x01, 0x2C};
+    TEST_ASSERT_EQUAL_UINT8_ARRAY(header, frame, sizeof header);
+    TEST_ASSERT_EQUAL_HEX16(0x0000, modbusCrc16(frame, len));
+    TEST_ASSERT_EQUAL_size_t(255, kModbusMaxRequestBytes);
+
+    // The response echoes start and count.
+    uint8_t echo[kModbusRequestBytes] = {0x01, 0x10, 0x01, 0x00, 0x00, 0x03};
+    const uint16_t crc = modbusCrc16(echo, 6);
+    echo[6] = static_cast<uint8_t>(crc & 0xFF);
+    echo[7] = static_cast<uint8_t>(crc >> 8);
+    TEST_ASSERT_EQUAL_INT(0, parseWriteMultipleResponse(echo, sizeof echo, 1, 0x0100, 3));
+    TEST_ASSERT_EQUAL_INT(2, parseWriteMultipleResponse(echo, sizeof echo, 1, 0x0100, 2));
+    TEST_ASSERT_EQUAL_INT(2, parseWriteMultipleResponse(echo, sizeof echo, 1, 0x0101, 3));
+    TEST_ASSERT_EQUAL_INT(2, parseWriteSingleResponse(echo, sizeof echo, 1, 0x0100, 3));
+
+    const uint8_t exception[] = {0x01, 0x90, 0x02, 0xCD, 0xC1};
+    TEST_ASSERT_EQUAL_INT(102,
+                          parseWriteMultipleResponse(exception, sizeof exception, 1, 0x0100, 3));
+}
+
+void test_expected_length_follows_the_header()
+{
+    const uint8_t read[] = {0x01, 0x03, 0x04};
+    TEST_ASSERT_EQUAL_size_t(kModbusExceptionBytes, modbusExpectedResponseBytes(0x03, read, 0));
+    TEST_ASSERT_EQUAL_size_t(kModbusExceptionBytes, modbusExpectedResponseBytes(0x03, read, 2));
+    TEST_ASSERT_EQUAL_size_t(9, modbusExpectedResponseBytes(0x03, read, 3));
+
+    const uint8_t exception[] = {0x01, 0x83};
+    TEST_ASSERT_EQUAL_size_t(kModbusExceptionBytes,
+                             modbusExpectedResponseBytes(0x03, exception, 2));
+
+    const uint8_t write[] = {0x02, 0x06};
+    TEST_ASSERT_EQUAL_size_t(kModbusRequestBytes, modbusExpectedResponseBytes(0x06, write, 2));
+
+    const uint8_t writeMultiple[] = {0x02, 0x10};
+    TEST_ASSERT_EQUAL_size_t(kModbusRequestBytes,
+                             modbusExpectedResponseBytes(0x10, writeMultiple, 2));
+}
+
+}  // namespace
+
+void run_modbus_rtu_frame_tests(void)
+{
+    RUN_TEST(test_request_carries_crc_low_byte_first);
+    RUN_TEST(test_read_response_decodes_registers);
+    RUN_TEST(test_read_response_rejects_bad_frames);
+    RUN_TEST(test_exception_keeps_its_code);
+    RUN_TEST(test_write_echo_is_compared_in_full);
+    RUN_TEST(test_write_multiple_request_and_echo);
+    RUN_TEST(test_expected_length_follows_the_header);
+}
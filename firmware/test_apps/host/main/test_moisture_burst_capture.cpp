@@ -0,0 +1,166 @@
+// SPDX-FileCopyrightText: 2026 Cryptotomte
+// SPDX-License-Identifier: AGPL-3.0-or-later
+/**
+ * @file test_moisture_burst_capture.cpp
+ * @brief Host suite for the watering-burst moisture capture
+ *        (MoistureBurstCapture.h).
+ *
+ * Registered by test_main.cpp via run_moisture_burst_capture_tests(). A
+ * capture opens on a pump start, keeps going through the tail and writes
+ * one averaged reading per second in a single batch when the tail ends; a
+ * restart within the tail continues it; failed, slow-group and unset-clock
+ * samples are skipped; a full ring drops its oldest seconds.
+ */
+
+#include <cstdint>
+#include <string>
+
+#include "unity.h"
+
+#include "sensors/MoistureBurstCapture.h"
+#include "storage/testing/MockDataStorage.h"
+#include "time/testing/FakeWallClock.h"
+
+namespace {
+
+constexpr uint32_t kEpoch = 1'700'000'000;
+
+TimedSoilSnapshot reading(float moisture, bool ok = true,
+                          SoilReadGroup group = SoilReadGroup::Fast)
+{
+    TimedSoilSnapshot sample;
+    sample.soil.readOk = ok;
+    sample.soil.available = true;
+    sample.soil.moisture = moisture;
+    sample.group = group;
+    return sample;
+}
+
+std::size_t stored(const MockDataStorage& storage)
+{
+    return storage.getSensorReadings(MoistureBurstCapture::kMetric, 0, UINT32_MAX).size();
+}
+
+void test_capture_averages_seconds_and_flushes_once(void)
+{
+    MockDataStorage storage;
+    FakeWallClock clock;
+    clock.setEpoch(kEpoch);
+    MoistureBurstCapture capture(storage, clock, /*tailMs=*/10'000);
+
+    // Idle: nothing is kept.
+    TEST_ASSERT_FALSE(capture.update(false, 0));
+    capture.add(reading(20.0f));
+
+    TEST_ASSERT_TRUE(capture.update(true, 1000));
+    capture.add(reading(20.0f));
+    capture.add(reading(22.0f));  // same second: averaged
+    clock.setEpoch(kEpoch + 1);
+    capture.add(reading(24.0f));
+
+    TEST_ASSERT_TRUE(capture.update(false, 2000));  // the tail runs
+    clock.setEpoch(kEpoch + 5);
+    capture.add(reading(30.0f));
+    TEST_ASSERT_TRUE(capture.update(false, 11'999));
+    TEST_ASSERT_EQUAL_size_t(0, stored(storage));
+
+    TEST_ASSERT_FALSE(capture.update(false, 12'000));
+    TEST_ASSERT_EQUAL_INT(1, storage.batchWrites);
+    const auto rows =
+        storage.getSensorReadings(MoistureBurstCapture::kMetric, 0, UINT32_MAX);
+    TEST_ASSERT_EQUAL_size_t(3, rows.size());
+    TEST_ASSERT_EQUAL_UINT32(kEpoch, rows[0].epoch);
+    TEST_ASSERT_EQUAL_FLOAT(21.0f, rows[0].value);
+    TEST_ASSERT_EQUAL_FLOAT(24.0f, rows[1].value);
+    TEST_ASSERT_EQUAL_UINT32(kEpoch + 5, rows[2].epoch);
+
+    const BurstCaptureStats stats = capture.stats();
+    TEST_ASSERT_EQUAL_UINT32(1, stats.captures);
+    TEST_ASSERT_EQUAL_UINT32(4, stats.reads);
+    TEST_ASSERT_EQUAL_UINT32(3, stats.seconds);
+    TEST_ASSERT_EQUAL_UINT32(0, stats.failed);
+}
+
+void test_restart_within_tail_continues_capture(void)
+{
+    MockDataStorage storage;
+    FakeWallClock clock;
+    clock.setEpoch(kEpoch);
+    MoistureBurstCapture capture(storage, clock, 10'000);
+
+    capture.update(true, 0);
+    capture.add(reading(20.0f));
+    capture.update(false, 1000);
+    clock.setEpoch(kEpoch + 2);
+    TEST_ASSERT_TRUE(capture.update(true, 5000));  // next burst of the cycle
+    capture.add(reading(25.0f));
+    capture.update(false, 6000);
+    TEST_ASSERT_TRUE(capture.update(false, 15'000));  // tail from the 2nd stop
+    TEST_ASSERT_FALSE(capture.update(false, 16'000));
+    TEST_ASSERT_EQUAL_INT(1, storage.batchWrites);
+    TEST_ASSERT_EQUAL_size_t(2, stored(storage));
+}
+
+void test_capture_skips_unusable_samples(void)
+{
+    MockDataStorage storage;
+    FakeWallClock clock;
+    clock.setEpoch(1000);  // not set yet
+    MoistureBurstCapture capture(storage, clock, 0);
+
+    capture.update(true, 0);
+    capture.add(reading(20.0f));
+    clock.setEpoch(kEpoch);
+    capture.add(reading(20.0f, /*ok=*/false));
+    capture.add(reading(20.0f, true, SoilReadGroup::Slow));
+    clock.setEpoch(kEpoch + 1);
+    capture.add(reading(21.0f));
+    clock.setEpoch(kEpoch);  // stepped back: joins the newest second
+    capture.add(reading(23.0f));
+
+    capture.update(false, 1000);
+    TEST_ASSERT_FALSE(capture.update(false, 1000));  // tail 0
+    const auto rows =
+        storage.getSensorReadings(MoistureBurstCapture::kMetric, 0, UINT32_MAX);
+    TEST_ASSERT_EQUAL_size_t(1, rows.size());
+    TEST_ASSERT_EQUAL_UINT32(kEpoch + 1, rows[0].epoch);
+    TEST_ASSERT_EQUAL_FLOAT(22.0f, rows[0].value);
+
+    // A capture without one usable sample writes nothing.
+    capture.update(true, 2000);
+    capture.update(false, 3000);
+    capture.update(false, 3000);
+    TEST_ASSERT_EQUAL_INT(1, storage.batchWrites);
+}
+
+void test_full_ring_drops_oldest_seconds(void)
+{
+    MockDataStorage storage;
+    FakeWallClock clock;
+    MoistureBurstCapture capture(storage, clock, 0);
+
+    capture.update(true, 0);
+    const uint32_t extra = 10;
+    for (uint32_t i = 0; i < MoistureBurstCapture::kSeconds + extra; ++i) {
+        clock.setEpoch(kEpoch + i);
+        capture.add(reading(static_cast<float>(i % 100)));
+    }
+    capture.update(false, 1000);
+    capture.update(false, 1000);
+
+    const auto rows =
+        storage.getSensorReadings(MoistureBurstCapture::kMetric, 0, UINT32_MAX);
+    TEST_ASSERT_EQUAL_size_t(MoistureBurstCapture::kSeconds, rows.size());
+    TEST_ASSERT_EQUAL_UINT32(kEpoch + extra, rows.front().epoch);
+    TEST_ASSERT_EQUAL_UINT32(extra, capture.stats().overwritten);
+}
+
+}  // namespace
+
+void run_moisture_burst_capture_tests(void)
+{
+    RUN_TEST(test_capture_averages_seconds_and_flushes_once);
+    RUN_TEST(test_restart_within_tail_continues_capture);
+    RUN_TEST(test_capture_skips_unusable_samples);
+    RUN_TEST(test_full_ring_drops_oldest_seconds);
+}
@@ -0,0 +1,120 @@
+// SPDX-FileCopyrightText: 2026 Cryptotomte
+// SPDX-License-Identifier: AGPL-3.0-or-later
+/**
+ * @file test_moisture_response.cpp
+ * @brief Host suite for the burst-sizing moisture estimator
+ *        (MoistureResponse.h).
+ *
+ * Registered by test_main.cpp via run_moisture_response_tests(). The gain is
+ * read after each burst's soak; the dry-down is fitted over idle windows
+ * only; the configured burst holds until two bursts are on record; a sized
+ * burst covers the dry-down over its soak and stays within [1, max] s; a
+ * manual run's water is never learnt.
+ */
+
+#include <cstdint>
+
+#include "unity.h"
+
+#include "control/MoistureResponse.h"
+
+namespace {
+
+constexpr int64_t kSettleMs = 300'000;
+
+/// One burst of @p pumpS from @p from % at @p atMs, read back @p to % once
+/// the soak has passed.
+void burst(MoistureResponse& r, int64_t atMs, int pumpS, float from, float to)
+{
+    r.burstStarted(atMs, from);
+    const int64_t endMs = atMs + pumpS * 1000;
+    r.sample(endMs - 1000, from + 1.0f, /*pumpRunning=*/true);
+    r.burstEnded(endMs, kSettleMs);
+    r.sample(endMs + 1000, to, false);  // still soaking: no observation
+    r.sample(endMs + kSettleMs, to, false);
+}
+
+void test_gain_learnt_after_two_bursts(void)
+{
+    MoistureResponse r;
+    TEST_ASSERT_FALSE(r.learnt());
+    TEST_ASSERT_EQUAL_INT(20, r.burstSeconds(20.0f, 55.0f, 20, 300, kSettleMs));
+
+    burst(r, 0, 20, 20.0f, 30.0f);  // 0.5 %/s
+    TEST_ASSERT_FLOAT_WITHIN(1e-4f, 0.5f, r.gainPctPerS());
+    TEST_ASSERT_FALSE(r.learnt());
+    TEST_ASSERT_EQUAL_INT(20, r.burstSeconds(20.0f, 55.0f, 20, 300, kSettleMs));
+
+    burst(r, 400'000, 10, 25.0f, 30.0f);  // 0.5 %/s again
+    TEST_ASSERT_TRUE(r.learnt());
+    TEST_ASSERT_FLOAT_WITHIN(1e-4f, 0.5f, r.gainPctPerS());
+    TEST_ASSERT_FLOAT_WITHIN(1e-6f, 0.0f, r.dryRatePctPerS());
+    TEST_ASSERT_EQUAL_INT(70, r.burstSeconds(20.0f, 55.0f, 20, 300, kSettleMs));
+}
+
+void test_dry_down_fitted_over_idle_windows(void)
+{
+    MoistureResponse r;
+    r.sample(0, 40.0f, false);
+    r.sample(300'000, 37.0f, false);  // window too short: nothing fitted
+    TEST_ASSERT_FLOAT_WITHIN(1e-6f, 0.0f, r.dryRatePctPerS());
+    r.sample(600'000, 34.0f, false);  // 6 % over 600 s
+    TEST_ASSERT_FLOAT_WITHIN(1e-5f, 0.01f, r.dryRatePctPerS());
+
+    // A rise moves the window on without an observation; a running pump
+    // restarts the window.
+    r.sample(1'200'000, 36.0f, false);
+    r.sample(1'500'000, 30.0f, true);
+    r.sample(1'600'000, 30.0f, false);
+    r.sample(2'200'000, 24.0f, false);
+    TEST_ASSERT_FLOAT_WITHIN(1e-5f, 0.01f, r.dryRatePctPerS());
+}
+
+void test_sized_burst_covers_soak_dry_down_and_clamps(void)
+{
+    MoistureResponse r;
+    r.sample(0, 50.0f, false);
+    r.sample(600'000, 44.0f, false);  // dry-down 0.01 %/s
+    // Each rise includes the 0.01 %/s lost over the 320 s to the read-back.
+    burst(r, 700'000, 20, 40.0f, 46.8f);
+    burst(r, 1'100'000, 20, 40.0f, 46.8f);
+    TEST_ASSERT_TRUE(r.learnt());
+    TEST_ASSERT_FLOAT_WITHIN(1e-3f, 0.5f, r.gainPctPerS());
+
+    // (55 - 20 + 0.01 * 300) / (0.5 - 0.01) = 77.55 -> 78 s.
+    TEST_ASSERT_EQUAL_INT(78, r.burstSeconds(20.0f, 55.0f, 20, 300, kSettleMs));
+    TEST_ASSERT_EQUAL_INT(40, r.burstSeconds(0.0f, 55.0f, 20, 40, kSettleMs));
+    TEST_ASSERT_EQUAL_INT(1, r.burstSeconds(70.0f, 55.0f, 20, 300, kSettleMs));
+}
+
+void test_manual_water_is_not_learnt(void)
+{
+    MoistureResponse r;
+    burst(r, 0, 20, 20.0f, 30.0f);
+
+    // The second burst's read-back falls inside a manual run's hold-off.
+    r.burstStarted(400'000, 25.0f);
+    r.burstEnded(420'000, kSettleMs);
+    r.disturbed(420'000 + 60'000 + kSettleMs);
+    r.sample(720'000, 60.0f, false);
+    r.sample(780'000, 60.0f, false);
+    TEST_ASSERT_FALSE(r.learnt());
+    TEST_ASSERT_FLOAT_WITHIN(1e-4f, 0.5f, r.gainPctPerS());
+
+    // A gain too small to matter keeps the configured burst.
+    MoistureResponse flat;
+    burst(flat, 0, 20, 20.0f, 20.0f);
+    burst(flat, 400'000, 20, 20.0f, 20.0f);
+    TEST_ASSERT_FALSE(flat.learnt());
+    TEST_ASSERT_EQUAL_INT(300, flat.burstSeconds(20.0f, 55.0f, 500, 300, kSettleMs));
+}
+
+}  // namespace
+
+void run_moisture_response_tests(void)
+{
+    RUN_TEST(test_gain_learnt_after_two_bursts);
+    RUN_TEST(test_dry_down_fitted_over_idle_windows);
+    RUN_TEST(test_sized_burst_covers_soak_dry_down_and_clamps);
+    RUN_TEST(test_manual_water_is_not_learnt);
+}
@@ -0,0 +1,291 @@
+// SPDX-FileCopyrightText: 2026 Cryptotomte
+// SPDX-License-Identifier: AGPL-3.0-or-later
+/**
+ * @file test_mqtt_uplink.cpp
+ * @brief Host suite for the batched MQTT publisher and its history replay
+ *        (MqttUplink.h) over MockMqttClient.
+ *
+ * A live batch goes out every batchMs with a full sensors snapshot behind
+ * the pump and event messages seen since the last one; a full in-flight
+ * window publishes nothing; batches due offline are spooled to the history
+ * store; the next session replays (watermark, reconnect] page by page and
+ * moves the watermark only once every replay page is acknowledged; a drop
+ * mid-replay leaves the mark where it was.
+ */
+
+#include <cmath>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include "unity.h"
+
+#include "api/ApiDtos.h"
+#include "api/MqttUplink.h"
+#include "interfaces/IDataStorage.h"
+#include "network/testing/MockMqttClient.h"
+#include "storage/testing/MockDataStorage.h"
+#include "time/testing/FakeWallClock.h"
+
+namespace {
+
+constexpr uint32_t kNow = 1760000000;
+constexpr uint32_t kMark = kNow - 3600;
+
+api::SensorReadingsDto readings()
+{
+    api::SensorReadingsDto dto;
+    dto.environmental = {true, 21.5f, 48.0f, 1013.0f};
+    dto.soil.valid = false;
+    dto.soil.moisture = NAN;
+    dto.hasTimestamp = true;
+    dto.timestamp = kNow;
+    return dto;
+}
+
+std::vector<api::PumpDto> pumps(bool running = false)
+{
+    return {api::PumpDto{"plant", running, 0, 1000, "commanded"}};
+}
+
+bool contains(const std::string& haystack, const char* needle)
+{
+    return haystack.find(needle) != std::string::npos;
+}
+
+struct Fixture {
+    MockMqttClient client;
+    MockDataStorage store;
+    FakeWallClock clock{kNow};
+    api::MqttUplink uplink{client, store, clock};
+
+    Fixture()
+    {
+        api::MqttUplinkConfig config;
+        config.topicBase = "ws/node";
+        config.batchMs = 10000;
+        config.maxInflight = 4;
+        uplink.configure(config);
+    }
+
+    void tick(uint32_t nowMs, bool running = false)
+    {
+        uplink.tick(nowMs, readings(), pumps(running));
+    }
+};
+
+void test_live_batches_on_cadence()
+{
+    Fixture f;
+    f.client.queueEvent(MqttEventType::Connected);
+    f.tick(0);
+    TEST_ASSERT_EQUAL_size_t(1, f.client.published.size());
+    const MockMqttClient::Message& first = f.client.published[0];
+    TEST_ASSERT_EQUAL_STRING("ws/node/telemetry", first.topic.c_str());
+    TEST_ASSERT_EQUAL_INT(1, first.msgId);
+    // The first batch of a session restates every pump before the snapshot.
+    TEST_ASSERT_TRUE(contains(first.payload,
+        "{\"type\":\"batch\",\"epoch\":1760000000,\"messages\":["
+        "{\"type\":\"pump\",\"name\":\"plant\",\"running\":false"));
+    TEST_ASSERT_TRUE(contains(first.payload, "{\"type\":\"sensors\",\"full\":true,"));
+
+    f.tick(5000, true);  // pump start queued, batch not due yet
+    TEST_ASSERT_EQUAL_size_t(1, f.client.published.size());
+    f.uplink.onEvent(kNow, IDataStorage::kCategoryPump, "pump=plant start");
+    f.tick(10000, true);
+    TEST_ASSERT_EQUAL_size_t(2, f.client.published.size());
+    const std::string& second = f.client.published[1].payload;
+    TEST_ASSERT_TRUE(contains(second, "\"running\":true"));
+    TEST_ASSERT_TRUE(contains(second, "\"detail\":\"pump=plant start\""));
+    TEST_ASSERT_TRUE(second.find("\"type\":\"pump\"") < second.find("\"type\":\"event\""));
+
+    // An acked live batch moves the watermark to its epoch.
+    TEST_ASSERT_EQUAL_UINT32(0, f.uplink.watermark());
+    f.client.ack(1);
+    f.tick(11000, true);
+    TEST_ASSERT_EQUAL_UINT32(kNow, f.uplink.watermark());
+    const api::MqttUplinkStats stats = f.uplink.stats();
+    TEST_ASSERT_TRUE(stats.connected);
+    TEST_ASSERT_EQUAL_UINT32(2, stats.batches);
+    TEST_ASSERT_EQUAL_UINT32(1, stats.acked);
+    TEST_ASSERT_EQUAL_UINT32(1, stats.inflight);
+}
+
+void test_full_window_publishes_nothing()
+{
+    Fixture f;
+    api::MqttUplinkConfig config;
+    config.topicBase = "ws/node";
+    config.maxInflight = 2;
+    f.uplink.configure(config);
+    f.client.queueEvent(MqttEventType::Connected);
+    f.tick(0);
+    f.tick(10000);
+    TEST_ASSERT_EQUAL_size_t(2, f.client.published.size());
+    f.tick(20000);
+    f.tick(30000);
+    TEST_ASSERT_EQUAL_size_t(2, f.client.published.size());
+    TEST_ASSERT_EQUAL_UINT32(2, f.uplink.stats().inflight);
+
+    f.client.ack(0);
+    f.tick(31000);
+    TEST_ASSERT_EQUAL_size_t(3, f.client.published.size());
+
+    // A refused publish keeps the queued messages for the next attempt.
+    f.client.ackFrom(1);
+    f.client.publishResult = false;
+    f.uplink.onEvent(kNow, IDataStorage::kCategoryConnectivity, "Connected");
+    f.tick(41000);
+    TEST_ASSERT_EQUAL_INT(1, f.client.rejectedPublishes);
+    f.client.publishResult = true;
+    f.tick(42000);
+    TEST_ASSERT_EQUAL_size_t(4, f.client.published.size());
+    TEST_ASSERT_TRUE(contains(f.client.published[3].payload, "\"detail\":\"Connected\""));
+    TEST_ASSERT_EQUAL_UINT32(1, f.uplink.stats().rejected);
+}
+
+void test_offline_batches_are_spooled()
+{
+    Fixture f;
+    f.uplink.restoreWatermark(kMark);
+    f.uplink.onEvent(kNow, IDataStorage::kCategoryConnectivity, "Disconnected");
+    f.tick(0);
+    f.tick(10000, true);
+    f.tick(20000);
+    TEST_ASSERT_EQUAL_size_t(0, f.client.published.size());
+    const api::MqttUplinkStats stats = f.uplink.stats();
+    TEST_ASSERT_FALSE(stats.connected);
+    TEST_ASSERT_EQUAL_UINT32(3, stats.spooled);
+    TEST_ASSERT_EQUAL_UINT32(0, stats.droppedMessages);
+    TEST_ASSERT_EQUAL_UINT32(kMark, f.uplink.watermark());
+}
+
+void test_replay_covers_the_gap_then_moves_the_mark()
+{
+    Fixture f;
+    f.uplink.restoreWatermark(kMark);
+    f.store.storeSensorReading("env_temperature", kMark - 60, 20.0f);  // acked
+    f.store.storeSensorReading("env_temperature", kMark + 60, 21.5f);
+    f.store.storeSensorReading("env_temperature", kMark + 120, 22.0f);
+    f.store.storeSensorReading("soil_moisture", kMark + 60, 40.0f);
+    f.store.storeEvent(kMark + 90, IDataStorage::kCategoryConnectivity, "Disconnected");
+
+    f.client.queueEvent(MqttEventType::Connected);
+    f.tick(0);
+    // Live batch first, then one readings page per metric and one event page.
+    TEST_ASSERT_EQUAL_size_t(4, f.client.published.size());
+    TEST_ASSERT_EQUAL_STRING("ws/node/telemetry", f.client.published[0].topic.c_str());
+    TEST_ASSERT_EQUAL_STRING("ws/node/replay", f.client.published[1].topic.c_str());
+    TEST_ASSERT_TRUE(contains(f.client.published[1].payload,
+        "{\"type\":\"readings\",\"metric\":\"env_temperature\",\"readings\":"
+        "[[1759996460,21.5],[1759996520,22]]}"));
+    TEST_ASSERT_TRUE(contains(f.client.published[2].payload,
+        "{\"type\":\"readings\",\"metric\":\"soil_moisture\",\"readings\":[[1759996460,40]]}"));
+    TEST_ASSERT_TRUE(contains(f.client.published[3].payload,
+        "\"epoch\":1759996490,\"category\":3"));
+    TEST_ASSERT_TRUE(f.uplink.stats().replaying);
+
+    // The live batch alone does not move the mark past the undelivered gap.
+    f.client.ack(0);
+    f.tick(1000);
+    TEST_ASSERT_EQUAL_UINT32(kMark, f.uplink.watermark());
+    f.client.ack(1);
+    f.client.ack(2);
+    f.tick(2000);
+    TEST_ASSERT_EQUAL_UINT32(kMark, f.uplink.watermark());
+    f.client.ack(3);
+    f.tick(3000);
+    TEST_ASSERT_EQUAL_UINT32(kNow, f.uplink.watermark());
+    const api::MqttUplinkStats stats = f.uplink.stats();
+    TEST_ASSERT_FALSE(stats.replaying);
+    TEST_ASSERT_EQUAL_UINT32(3, stats.replayPages);
+    TEST_ASSERT_EQUAL_UINT32(4, stats.acked);
+}
+
+void test_replay_pages_wait_for_window_room()
+{
+    Fixture f;
+    api::MqttUplinkConfig config;
+    config.topicBase = "ws/node";
+    config.maxInflight = 2;
+    config.replayReadings = 2;
+    f.uplink.configure(config);
+    f.uplink.restoreWatermark(kMark);
+    for (uint32_t i = 1; i <= 5; ++i) {
+        f.store.storeSensorReading("env_humidity", kMark + i * 60, 50.0f);
+    }
+    f.client.queueEvent(MqttEventType::Connected);
+    f.tick(0);
+    TEST_ASSERT_EQUAL_size_t(2, f.client.published.size());  // batch + page 1
+    f.client.ackFrom(0);
+    f.tick(1000);
+    TEST_ASSERT_EQUAL_size_t(4, f.client.published.size());  // pages 2 and 3
+    TEST_ASSERT_TRUE(contains(f.client.published[3].payload, "\"readings\":[[1759996700,50]]"));
+    f.client.ackFrom(2);
+    f.tick(2000);
+    TEST_ASSERT_EQUAL_size_t(4, f.client.published.size());
+    TEST_ASSERT_EQUAL_UINT32(kNow, f.uplink.watermark());
+}
+
+void test_drop_mid_replay_keeps_the_mark()
+{
+    Fixture f;
+    f.uplink.restoreWatermark(kMark);
+    f.store.storeSensorReading("env_temperature", kMark + 60, 21.5f);
+    f.client.queueEvent(MqttEventType::Connected);
+    f.tick(0);
+    TEST_ASSERT_EQUAL_size_t(2, f.client.published.size());
+    f.client.ack(0);
+    f.client.queueEvent(MqttEventType::Disconnected);
+    f.client.ack(1);  // a PUBACK from the lost session is ignored
+    f.tick(1000);
+    TEST_ASSERT_EQUAL_UINT32(kMark, f.uplink.watermark());
+    TEST_ASSERT_FALSE(f.uplink.stats().replaying);
+
+    // The next session replays the same gap again, up to its own start.
+    f.clock.setEpoch(kNow + 600);
+    f.client.queueEvent(MqttEventType::Connected);
+    f.tick(2000);
+    TEST_ASSERT_EQUAL_size_t(4, f.client.published.size());
+    TEST_ASSERT_EQUAL_STRING(f.client.published[1].payload.substr(
+                                 f.client.published[1].payload.find("\"messages\"")).c_str(),
+                             f.client.published[3].payload.substr(
+                                 f.client.published[3].payload.find("\"messages\"")).c_str());
+    f.client.ackFrom(2);
+    f.tick(3000);
+    TEST_ASSERT_EQUAL_UINT32(kNow + 600, f.uplink.watermark());
+    TEST_ASSERT_EQUAL_UINT32(2, f.uplink.stats().connects);
+}
+
+void test_no_replay_without_a_mark_or_a_clock()
+{
+    Fixture f;
+    f.clock.setEpoch(0);
+    f.store.storeSensorReading("env_temperature", 100, 21.5f);
+    f.client.queueEvent(MqttEventType::Connected);
+    f.tick(0);
+    TEST_ASSERT_EQUAL_size_t(1, f.client.published.size());
+    TEST_ASSERT_TRUE(contains(f.client.published[0].payload, "\"epoch\":0,"));
+    f.client.ack(0);
+    f.tick(1000);
+    TEST_ASSERT_EQUAL_UINT32(0, f.uplink.watermark());  // unset clock: no mark
+
+    // First session ever (mark 0): nothing was promised, nothing replayed.
+    f.clock.setEpoch(kNow);
+    f.tick(2000);
+    TEST_ASSERT_EQUAL_size_t(1, f.client.published.size());
+    TEST_ASSERT_FALSE(f.uplink.stats().replaying);
+}
+
+}  // namespace
+
+void run_mqtt_uplink_tests(void)
+{
+    RUN_TEST(test_live_batches_on_cadence);
+    RUN_TEST(test_full_window_publishes_nothing);
+    RUN_TEST(test_offline_batches_are_spooled);
+    RUN_TEST(test_replay_covers_the_gap_then_moves_the_mark);
+    RUN_TEST(test_replay_pages_wait_for_window_room);
+    RUN_TEST(test_drop_mid_replay_keeps_the_mark);
+    RUN_TEST(test_no_replay_without_a_mark_or_a_clock);
+}
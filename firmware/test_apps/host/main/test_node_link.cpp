@@ -0,0 +1,405 @@
+// SPDX-FileCopyrightText: 2026 Cryptotomte
+// SPDX-License-Identifier: AGPL-3.0-or-later
+/**
+ * @file test_node_link.cpp
+ * @brief Host suite for the ESP-NOW multi-node link: the frame codec
+ *        (NodeFrame.h), the leaf sender (NodeLeaf.h) and the gateway
+ *        (NodeGateway.h) over MockEspNowLink.
+ *
+ * A report round-trips the sensor/pump DTOs it carries and fits one
+ * ESP-NOW datagram even at its largest; a truncated or foreign frame is
+ * rejected. The leaf reports on its phase and period, resends on an Ack
+ * timeout with a doubling wait and counts a report lost after the last
+ * retry. The gateway acknowledges every report, stores a resend once,
+ * counts sequence gaps, refuses a leaf past a full table and serves a
+ * leaf's series by window.
+ */
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include "unity.h"
+
+#include "api/ApiDtos.h"
+#include "api/NodeFrame.h"
+#include "api/NodeGateway.h"
+#include "api/NodeLeaf.h"
+#include "interfaces/IEspNowLink.h"
+#include "interfaces/MetricRegistry.h"
+#include "network/testing/MockEspNowLink.h"
+#include "time/testing/FakeWallClock.h"
+
+namespace {
+
+constexpr uint32_t kNow = 1760000000;
+const EspNowMac kGateway = {0xa0, 0xb1, 0xc2, 0xd3, 0xe4, 0xf5};
+const EspNowMac kLeaf = {0x10, 0x20, 0x30, 0x40, 0x50, 0x60};
+
+api::SensorReadingsDto readings(float moisture = 41.5f, int64_t timestamp = kNow)
+{
+    api::SensorReadingsDto dto;
+    dto.environmental = {true, 21.5f, 48.0f, 1013.0f};
+    dto.soil.valid = true;
+    dto.soil.moisture = moisture;
+    dto.soil.temperature = 18.0f;
+    dto.soil.humidity = 60.0f;
+    dto.soil.ph = 6.5f;
+    dto.soil.ec = 900.0f;
+    dto.soil.hasPotassium = true;
+    dto.soil.potassium = 120.0f;
+    dto.level.low = {true, true};
+    dto.level.high = {true, false};
+    dto.hasTimestamp = timestamp != 0;
+    dto.timestamp = timestamp;
+    return dto;
+}
+
+std::vector<api::PumpDto> pumps()
+{
+    return {api::PumpDto{"plant", true, 1500, 90000, "commanded"},
+            api::PumpDto{"reservoir", false, 0, 4000, "level_high"}};
+}
+
+std::vector<uint8_t> report(uint16_t seq, float moisture = 41.5f,
+                            int64_t timestamp = kNow)
+{
+    std::vector<uint8_t> frame(api::kNodeMaxFrame);
+    frame.resize(api::encodeNodeReport(seq, readings(moisture, timestamp), pumps(),
+                                       frame.data()));
+    return frame;
+}
+
+std::vector<uint8_t> ack(uint16_t seq)
+{
+    std::vector<uint8_t> frame(api::kNodeFrameHeader);
+    frame.resize(api::encodeNodeAck(seq, frame.data()));
+    return frame;
+}
+
+/// The seq of an Ack the mock link sent, or -1 when it is not an Ack.
+int ackedSeq(const MockEspNowLink::Frame& frame)
+{
+    api::NodeFrame decoded;
+    if (!api::decodeNodeFrame(frame.data.data(), frame.data.size(), decoded) ||
+        decoded.type != api::NodeFrameType::Ack) {
+        return -1;
+    }
+    return decoded.seq;
+}
+
+void test_report_round_trips_the_dtos()
+{
+    const std::vector<uint8_t> frame = report(0x1234);
+    api::NodeFrame out;
+    TEST_ASSERT_TRUE(api::decodeNodeFrame(frame.data(), frame.size(), out));
+    TEST_ASSERT_TRUE(out.type == api::NodeFrameType::Report);
+    TEST_ASSERT_EQUAL_UINT16(0x1234, out.seq);
+    TEST_ASSERT_TRUE(out.sensors.hasTimestamp);
+    TEST_ASSERT_EQUAL_INT64(kNow, out.sensors.timestamp);
+    TEST_ASSERT_TRUE(out.sensors.environmental.valid);
+    TEST_ASSERT_EQUAL_FLOAT(1013.0f, out.sensors.environmental.pressure);
+    TEST_ASSERT_TRUE(out.sensors.soil.valid);
+    TEST_ASSERT_EQUAL_FLOAT(41.5f, out.sensors.soil.moisture);
+    TEST_ASSERT_EQUAL_FLOAT(900.0f, out.sensors.soil.ec);
+    TEST_ASSERT_FALSE(out.sensors.soil.hasNitrogen);
+    TEST_ASSERT_TRUE(out.sensors.soil.hasPotassium);
+    TEST_ASSERT_EQUAL_FLOAT(120.0f, out.sensors.soil.potassium);
+    TEST_ASSERT_TRUE(out.sensors.level.low.waterPresent);
+    TEST_ASSERT_FALSE(out.sensors.level.high.waterPresent);
+    TEST_ASSERT_TRUE(out.sensors.level.high.valid);
+    TEST_ASSERT_FALSE(out.sensors.hasPower);
+    TEST_ASSERT_EQUAL_size_t(2, out.pumps.size());
+    TEST_ASSERT_EQUAL_STRING("reservoir", out.pumps[1].name.c_str());
+    TEST_ASSERT_TRUE(out.pumps[0].running);
+    TEST_ASSERT_EQUAL_UINT32(1500, out.pumps[0].currentRunTimeMs);
+    TEST_ASSERT_EQUAL_UINT32(4000, out.pumps[1].accumulatedRunTimeMs);
+    // The stop reason stays on the leaf.
+    TEST_ASSERT_TRUE(out.pumps[0].lastStopReason.empty());
+
+    // An unset clock travels as 0 and comes back as "no timestamp".
+    const std::vector<uint8_t> unset = report(1, 40.0f, 0);
+    TEST_ASSERT_TRUE(api::decodeNodeFrame(unset.data(), unset.size(), out));
+    TEST_ASSERT_FALSE(out.sensors.hasTimestamp);
+}
+
+void test_largest_report_fits_a_datagram()
+{
+    api::SensorReadingsDto dto = readings();
+    dto.soil.hasNitrogen = true;
+    dto.soil.hasPhosphorus = true;
+    dto.hasPower = true;
+    dto.power = {true, 12.1f, 3.9f, 47.2f};
+    std::vector<api::PumpDto> many;
+    for (int i = 0; i < 10; ++i) {
+        many.push_back(api::PumpDto{"a-very-long-zone-name", false, 0, 0, ""});
+    }
+    uint8_t frame[api::kNodeMaxFrame];
+    const std::size_t len = api::encodeNodeReport(7, dto, many, frame);
+    TEST_ASSERT_EQUAL_size_t(api::kNodeMaxFrame, len);
+    TEST_ASSERT_TRUE(len <= kEspNowMaxPayload);
+
+    api::NodeFrame out;
+    TEST_ASSERT_TRUE(api::decodeNodeFrame(frame, len, out));
+    TEST_ASSERT_EQUAL_size_t(api::kNodeMaxPumps, out.pumps.size());
+    TEST_ASSERT_EQUAL_size_t(api::kNodeNameMax, out.pumps[0].name.size());
+    TEST_ASSERT_TRUE(out.sensors.hasPower);
+    TEST_ASSERT_EQUAL_FLOAT(47.2f, out.sensors.power.power);
+}
+
+void test_decode_rejects_damaged_frames()
+{
+    std::vector<uint8_t> frame = report(3);
+    api::NodeFrame out;
+    TEST_ASSERT_FALSE(api::decodeNodeFrame(frame.data(), frame.size() - 1, out));
+    TEST_ASSERT_FALSE(api::decodeNodeFrame(frame.data(), 3, out));
+
+    std::vector<uint8_t> longer = frame;
+    longer.push_back(0);
+    TEST_ASSERT_FALSE(api::decodeNodeFrame(longer.data(), longer.size(), out));
+
+    std::vector<uint8_t> foreign = frame;
+    foreign[0] = 'X';
+    TEST_ASSERT_FALSE(api::decodeNodeFrame(foreign.data(), foreign.size(), out));
+
+    std::vector<uint8_t> newer = frame;
+    newer[2] = api::kNodeFrameVersion + 1;
+    TEST_ASSERT_FALSE(api::decodeNodeFrame(newer.data(), newer.size(), out));
+
+    std::vector<uint8_t> unknown = ack(3);
+    unknown[3] = 9;
+    TEST_ASSERT_FALSE(api::decodeNodeFrame(unknown.data(), unknown.size(), out));
+}
+
+struct LeafFixture {
+    MockEspNowLink link;
+    api::NodeLeaf leaf{link, kGateway};
+
+    LeafFixture()
+    {
+        api::NodeLeafConfig config;
+        config.periodMs = 60000;
+        config.phaseMs = 1000;
+        config.ackTimeoutMs = 200;
+        config.maxRetries = 2;
+        config.firstSeq = 500;
+        leaf.configure(config);
+    }
+
+    /// One task tick: drain, then report when due.
+    void tick(uint32_t nowMs)
+    {
+        leaf.poll(nowMs);
+        if (leaf.reportDue(nowMs)) {
+            leaf.report(nowMs, readings(), pumps());
+        }
+    }
+};
+
+void test_leaf_reports_on_phase_then_period()
+{
+    LeafFixture f;
+    f.tick(500);
+    TEST_ASSERT_EQUAL_size_t(0, f.link.sent.size());
+    f.tick(1000);
+    TEST_ASSERT_EQUAL_size_t(1, f.link.sent.size());
+    TEST_ASSERT_TRUE(f.link.sent[0].to == kGateway);
+    api::NodeFrame out;
+    TEST_ASSERT_TRUE(api::decodeNodeFrame(f.link.sent[0].data.data(),
+                                          f.link.sent[0].data.size(), out));
+    TEST_ASSERT_EQUAL_UINT16(500, out.seq);
+    TEST_ASSERT_TRUE(f.leaf.awaitingAck());
+
+    // Acks from anyone else, or of another seq, are ignored.
+    const std::vector<uint8_t> right = ack(500);
+    f.link.deliver(kLeaf, right);
+    f.link.deliver(kGateway, ack(499));
+    f.tick(1100);
+    TEST_ASSERT_TRUE(f.leaf.awaitingAck());
+    f.link.deliver(kGateway, right);
+    f.tick(1150);
+    TEST_ASSERT_FALSE(f.leaf.awaitingAck());
+    TEST_ASSERT_EQUAL_UINT32(1, f.leaf.stats().acked);
+
+    // The next report follows one period after the first attempt.
+    f.tick(60999);
+    TEST_ASSERT_EQUAL_size_t(1, f.link.sent.size());
+    f.tick(61000);
+    TEST_ASSERT_EQUAL_size_t(2, f.link.sent.size());
+    TEST_ASSERT_TRUE(api::decodeNodeFrame(f.link.sent[1].data.data(),
+                                          f.link.sent[1].data.size(), out));
+    TEST_ASSERT_EQUAL_UINT16(501, out.seq);
+}
+
+void test_leaf_resends_with_backoff_then_gives_up()
+{
+    LeafFixture f;
+    f.tick(1000);
+    f.tick(1199);
+    TEST_ASSERT_EQUAL_size_t(1, f.link.sent.size());
+    f.tick(1200);  // first timeout: 200 ms
+    TEST_ASSERT_EQUAL_size_t(2, f.link.sent.size());
+    TEST_ASSERT_TRUE(f.link.sent[1].data == f.link.sent[0].data);
+    f.tick(1599);
+    TEST_ASSERT_EQUAL_size_t(2, f.link.sent.size());
+    f.tick(1600);  // doubled: 400 ms
+    TEST_ASSERT_EQUAL_size_t(3, f.link.sent.size());
+    f.tick(2400);  // 800 ms with no retry left: lost
+    TEST_ASSERT_EQUAL_size_t(3, f.link.sent.size());
+    TEST_ASSERT_FALSE(f.leaf.awaitingAck());
+
+    const api::NodeLeafStats stats = f.leaf.stats();
+    TEST_ASSERT_EQUAL_UINT32(1, stats.reports);
+    TEST_ASSERT_EQUAL_UINT32(2, stats.retries);
+    TEST_ASSERT_EQUAL_UINT32(1, stats.lost);
+    TEST_ASSERT_EQUAL_UINT32(0, stats.acked);
+
+    // A refused send is retried like a frame lost on the air.
+    f.link.sendResult = false;
+    f.tick(61000);
+    TEST_ASSERT_EQUAL_UINT32(1, f.leaf.stats().rejected);
+    f.link.sendResult = true;
+    f.tick(61200);
+    TEST_ASSERT_EQUAL_size_t(4, f.link.sent.size());
+}
+
+struct GatewayFixture {
+    MockEspNowLink link;
+    FakeWallClock clock{kNow};
+    api::NodeGateway gateway{link, clock};
+};
+
+void test_gateway_acks_and_dedups()
+{
+    GatewayFixture f;
+    f.link.deliver(kLeaf, report(10, 40.0f), -61);
+    f.link.deliver(kLeaf, report(10, 40.0f), -62);  // Ack lost: resent
+    f.link.deliver(kLeaf, report(13, 42.0f), -63);  // 11 and 12 never came
+    f.gateway.tick(5000);
+
+    TEST_ASSERT_EQUAL_size_t(3, f.link.sent.size());
+    TEST_ASSERT_TRUE(f.link.sent[0].to == kLeaf);
+    TEST_ASSERT_EQUAL_INT(10, ackedSeq(f.link.sent[0]));
+    TEST_ASSERT_EQUAL_INT(10, ackedSeq(f.link.sent[1]));
+    TEST_ASSERT_EQUAL_INT(13, ackedSeq(f.link.sent[2]));
+
+    const api::NodeGatewayStats stats = f.gateway.stats();
+    TEST_ASSERT_EQUAL_UINT32(1, stats.nodes);
+    TEST_ASSERT_EQUAL_UINT32(2, stats.reports);
+    TEST_ASSERT_EQUAL_UINT32(1, stats.duplicates);
+    TEST_ASSERT_EQUAL_UINT32(2, stats.missed);
+
+    const std::vector<api::NodeDto> nodes = f.gateway.nodes(8000);
+    TEST_ASSERT_EQUAL_size_t(1, nodes.size());
+    TEST_ASSERT_EQUAL_STRING("102030405060", nodes[0].node.c_str());
+    TEST_ASSERT_EQUAL_UINT32(3, nodes[0].lastSeenS);
+    TEST_ASSERT_EQUAL_INT(-63, nodes[0].rssi);
+    TEST_ASSERT_EQUAL_FLOAT(42.0f, nodes[0].sensors.soil.moisture);
+    TEST_ASSERT_EQUAL_size_t(2, nodes[0].pumps.size());
+
+    // A leaf that rebooted (seq went back) starts over without a gap.
+    f.link.deliver(kLeaf, report(3));
+    f.gateway.tick(9000);
+    TEST_ASSERT_EQUAL_UINT32(2, f.gateway.stats().missed);
+    TEST_ASSERT_EQUAL_UINT32(3, f.gateway.stats().reports);
+
+    // Garbage is counted, never acknowledged.
+    const uint8_t junk[] = {'W', 'N', 1};
+    f.link.deliver(kLeaf, junk, sizeof junk);
+    f.link.deliver(kLeaf, ack(3));
+    f.gateway.tick(9050);
+    TEST_ASSERT_EQUAL_UINT32(2, f.gateway.stats().malformed);
+    TEST_ASSERT_EQUAL_size_t(4, f.link.sent.size());
+}
+
+void test_gateway_table_refuses_then_reclaims()
+{
+    GatewayFixture f;
+    for (uint8_t i = 0; i < api::NodeGateway::kMaxNodes; ++i) {
+        const EspNowMac mac = {2, 0, 0, 0, 0, i};
+        f.link.deliver(mac, report(1));
+    }
+    f.gateway.tick(1000);
+    TEST_ASSERT_EQUAL_UINT32(api::NodeGateway::kMaxNodes, f.gateway.stats().nodes);
+
+    const EspNowMac late = {3, 0, 0, 0, 0, 0};
+    f.link.deliver(late, report(1));
+    f.gateway.tick(2000);
+    TEST_ASSERT_EQUAL_UINT32(1, f.gateway.stats().refused);
+    TEST_ASSERT_EQUAL_size_t(api::NodeGateway::kMaxNodes, f.link.sent.size());
+
+    // Every other leaf keeps reporting; the first goes quiet past kStaleMs.
+    const uint32_t later = 1000 + api::NodeGateway::kStaleMs + 1;
+    for (uint8_t i = 1; i < api::NodeGateway::kMaxNodes; ++i) {
+        const EspNowMac mac = {2, 0, 0, 0, 0, i};
+        f.link.deliver(mac, report(2));
+    }
+    f.gateway.tick(later - 10);
+    f.link.deliver(late, report(2));
+    f.gateway.tick(later);
+    TEST_ASSERT_EQUAL_INT(2, ackedSeq(f.link.sent.back()));
+    TEST_ASSERT_TRUE(f.link.sent.back().to == late);
+
+    api::HistorySeries series;
+    TEST_ASSERT_FALSE(f.gateway.history("020000000000", metric::kSoilMoisture, 0,
+                                        UINT32_MAX, series));
+    TEST_ASSERT_TRUE(f.gateway.history("030000000000", metric::kSoilMoisture, 0,
+                                       UINT32_MAX, series));
+}
+
+void test_gateway_history_by_window()
+{
+    GatewayFixture f;
+    f.link.deliver(kLeaf, report(1, 30.0f, kNow - 120));
+    f.link.deliver(kLeaf, report(2, 31.0f, kNow - 60));
+    f.link.deliver(kLeaf, report(3, 32.0f, 0));  // stamped by the gateway
+    f.gateway.tick(1000);
+
+    api::HistorySeries series;
+    TEST_ASSERT_TRUE(f.gateway.history("102030405060", metric::kSoilMoisture,
+                                       kNow - 90, kNow, series));
+    TEST_ASSERT_EQUAL_size_t(2, series.values.size());
+    TEST_ASSERT_EQUAL_INT64(kNow - 60, series.timestamps[0]);
+    TEST_ASSERT_EQUAL_FLOAT(31.0f, series.values[0]);
+    TEST_ASSERT_EQUAL_INT64(kNow, series.timestamps[1]);
+    TEST_ASSERT_EQUAL_FLOAT(32.0f, series.values[1]);
+
+    // Absent channels and metrics leaves do not carry are empty series.
+    api::HistorySeries nitrogen;
+    TEST_ASSERT_TRUE(f.gateway.history("102030405060", metric::kSoilNitrogen, 0,
+                                       UINT32_MAX, nitrogen));
+    TEST_ASSERT_EQUAL_size_t(0, nitrogen.values.size());
+    api::HistorySeries probe2;
+    TEST_ASSERT_TRUE(f.gateway.history("102030405060", metric::soilMoisture(1), 0,
+                                       UINT32_MAX, probe2));
+    TEST_ASSERT_EQUAL_size_t(0, probe2.values.size());
+    TEST_ASSERT_FALSE(f.gateway.history("10203040506", metric::kSoilMoisture, 0,
+                                        UINT32_MAX, probe2));
+
+    // The ring keeps the newest kHistoryDepth reports, oldest first.
+    for (uint16_t seq = 4; seq < 4 + api::NodeGateway::kHistoryDepth; ++seq) {
+        f.link.deliver(kLeaf, report(seq, static_cast<float>(seq), kNow + seq));
+        f.gateway.tick(1000 + seq);
+    }
+    api::HistorySeries all;
+    TEST_ASSERT_TRUE(f.gateway.history("102030405060", metric::kSoilMoisture, 0,
+                                       UINT32_MAX, all));
+    TEST_ASSERT_EQUAL_size_t(api::NodeGateway::kHistoryDepth, all.values.size());
+    TEST_ASSERT_EQUAL_FLOAT(4.0f, all.values.front());
+    TEST_ASSERT_EQUAL_INT64(kNow + 3 + api::NodeGateway::kHistoryDepth,
+                            all.timestamps.back());
+}
+
+}  // namespace
+
+void run_node_link_tests(void)
+{
+    RUN_TEST(test_report_round_trips_the_dtos);
+    RUN_TEST(test_largest_report_fits_a_datagram);
+    RUN_TEST(test_decode_rejects_damaged_frames);
+    RUN_TEST(test_leaf_reports_on_phase_then_period);
+    RUN_TEST(test_leaf_resends_with_backoff_then_gives_up);
+    RUN_TEST(test_gateway_acks_and_dedups);
+    RUN_TEST(test_gateway_table_refuses_then_reclaims);
+    RUN_TEST(test_gateway_history_by_window);
+}
@@ -0,0 +1,524 @@
+// SPDX-FileCopyrightText: 2026 Cryptotomte
+// SPDX-License-Identifier: AGPL-3.0-or-later
+/**
+ * @file test_ota_pipeline.cpp
+ * @brief Host suite for the streaming OTA upload (api/OtaPipeline.h) and
+ *        its incremental SHA-256 (api/Sha256.h) over MockFirmwareSlot.
+ *
+ * Registered by test_main.cpp via run_ota_pipeline_tests(). SHA-256 meets
+ * the FIPS 180-4 vectors however the input is split. An image streamed
+ * through the two buffers — by a writer thread, as on target, or inline —
+ * lands in the slot byte for byte in sector-sized writes and is committed;
+ * a digest mismatch, a short body, a failed write or an invalid image
+ * aborts the slot instead, and a second upload during one is refused.
+ * A delta patch (api/DeltaPatch.h) against the running image rebuilds the
+ * new image in the slot; one made against another image, or one that
+ * does not decode, never opens or never commits it.
+ */
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "unity.h"
+
+#include "actuators/testing/FakeTimeProvider.h"
+#include "api/DeltaPatch.h"
+#include "api/OtaPipeline.h"
+#include "api/Sha256.h"
+#include "api/testing/MockFirmwareSlot.h"
+#include "api/testing/MockRunningImage.h"
+
+using api::IChunkSource;
+using api::OtaOutcome;
+using api::OtaPipeline;
+using api::OtaReport;
+using api::Sha256;
+
+namespace {
+
+constexpr std::size_t kSlotBytes = 64 * 1024;
+
+/// A body delivered in pieces of at most @p piece bytes; ends early after
+/// @p cutAfter bytes when set.
+class BodySource : public IChunkSource {
+public:
+    BodySource(const std::vector<uint8_t>& body, std::size_t piece,
+               std::size_t cutAfter = SIZE_MAX)
+        : body_(body), piece_(piece), cutAfter_(cutAfter)
+    {
+    }
+
+    int receive(uint8_t* dst, std::size_t len) override
+    {
+        const std::size_t end = cutAfter_ < body_.size() ? cutAfter_ : body_.size();
+        std::size_t n = end - pos_;
+        n = n < len ? n : len;
+        n = n < piece_ ? n : piece_;
+        for (std::size_t i = 0; i < n; ++i) {
+            dst[i] = body_[pos_ + i];
+        }
+        pos_ += n;
+        ++calls;
+        return static_cast<int>(n);
+    }
+
+    std::size_t calls = 0;
+
+private:
+    const std::vector<uint8_t>& body_;
+    std::size_t piece_;
+    std::size_t cutAfter_;
+    std::size_t pos_ = 0;
+};
+
+std::vector<uint8_t> makeImage(std::size_t len)
+{
+    std::vector<uint8_t> image(len);
+    uint32_t x = 0x12345678;
+    for (uint8_t& b : image) {
+        x = x * 1664525u + 1013904223u;
+        b = static_cast<uint8_t>(x >> 24);
+    }
+    return image;
+}
+
+Sha256::Digest digestOf(const std::vector<uint8_t>& data)
+{
+    Sha256 hash;
+    hash.update(data.data(), data.size());
+    return hash.finish();
+}
+
+std::string hexOf(const std::string& text)
+{
+    Sha256 hash;
+    hash.update(reinterpret_cast<const uint8_t*>(text.data()), text.size());
+    return Sha256::toHex(hash.finish());
+}
+
+// --- delta patches (the tools/make_delta.py encoding, by hand) ----------
+
+void putVarint(std::vector<uint8_t>& out, uint32_t v)
+{
+    while (v >= 0x80) {
+        out.push_back(static_cast<uint8_t>(v | 0x80));
+        v >>= 7;
+    }
+    out.push_back(static_cast<uint8_t>(v));
+}
+
+void putLe32(std::vector<uint8_t>& out, uint32_t v)
+{
+    for (int i = 0; i < 4; ++i) {
+        out.push_back(static_cast<uint8_t>(v >> (8 * i)));
+    }
+}
+
+std::vector<uint8_t> patchHeader(const std::vector<uint8_t>& base,
+                                 const std::vector<uint8_t>& target)
+{
+    std::vector<uint8_t> out = {'W', 'S', 'D', 'P', 1, 0, 0, 0};
+    putLe32(out, static_cast<uint32_t>(target.size()));
+    putLe32(out, static_cast<uint32_t>(base.size()));
+    const Sha256::Digest baseSha = digestOf(base);
+    const Sha256::Digest targetSha = digestOf(target);
+    out.insert(out.end(), baseSha.begin(), baseSha.end());
+    out.insert(out.end(), targetSha.begin(), targetSha.end());
+    return out;
+}
+
+void putData(std::vector<uint8_t>& out, const std::vector<uint8_t>& bytes)
+{
+    out.push_back(0x00);
+    putVarint(out, static_cast<uint32_t>(bytes.size()));
+    out.insert(out.end(), bytes.begin(), bytes.end());
+}
+
+/// DIFF of @p n bytes at base position + @p seek, all zero runs (a copy).
+void putCopy(std::vector<uint8_t>& out, int32_t seek, uint32_t n)
+{
+    out.push_back(0x01);
+    putVarint(out, seek >= 0 ? static_cast<uint32_t>(seek) << 1
+                             : (static_cast<uint32_t>(-seek) << 1) - 1);
+    putVarint(out, n);
+    putVarint(out, n);  // zeros
+    putVarint(out, 0);  // lits
+}
+
+/// A base, a target made from it (moved, inserted and patched bytes) and
+/// the patch between them.
+struct DeltaCase {
+    std::vector<uint8_t> base = makeImage(9000);
+    std::vector<uint8_t> target;
+    std::vector<uint8_t> patch;
+
+    DeltaCase()
+    {
+        const std::vector<uint8_t> inserted = makeImage(50);
+        target.assign(base.begin(), base.begin() + 1000);
+        target.insert(target.end(), inserted.begin(), inserted.end());
+        target.insert(target.end(), base.begin() + 1000, base.begin() + 3000);
+        target[1050 + 10] += 1;  // a shifted address: two bytes differ
+        target[1050 + 11] += 2;
+        target.insert(target.end(), base.begin() + 5000, base.end());
+        target.insert(target.end(), base.begin(), base.begin() + 100);
+
+        patch = patchHeader(base, target);
+        putCopy(patch, 0, 1000);
+        putData(patch, inserted);
+        patch.push_back(0x01);  // DIFF 2000 bytes: 10 zeros, +1 +2, 1988 zeros
+        putVarint(patch, 0);
+        putVarint(patch, 2000);
+        putVarint(patch, 10);
+        putVarint(patch, 2);
+        patch.push_back(1);
+        patch.push_back(2);
+        putVarint(patch, 1988);
+        putVarint(patch, 0);
+        putCopy(patch, 2000, 4000);  // skip base 3000..5000
+        putCopy(patch, -9000, 100);  // back to the start
+    }
+};
+
+/// The writer task of the target, as a thread running serveWrite().
+class WriterThread {
+public:
+    explicit WriterThread(OtaPipeline& ota) : ota_(ota)
+    {
+        ota_.attachWriter();
+        thread_ = std::thread([this] {
+            while (!stop_) {
+                ota_.serveWrite(5);
+            }
+        });
+    }
+    ~WriterThread()
+    {
+        stop_ = true;
+        thread_.join();
+    }
+
+private:
+    OtaPipeline& ota_;
+    std::atomic<bool> stop_{false};
+    std::thread thread_;
+};
+
+void test_sha256_fips_vectors(void)
+{
+    TEST_ASSERT_EQUAL_STRING(
+        "e3b0c44298fc1c149afbf4c8996fb92427ae41e4649b934ca495991b7852b855", hexOf("").c_str());
+    TEST_ASSERT_EQUAL_STRING(
+        "ba7816bf8f01cfea414140de5dae2223b00361a396177a9cb410ff61f20015ad", hexOf("abc").c_str());
+    TEST_ASSERT_EQUAL_STRING(
+        "248d6a61d20638b8e5c026930c3e6039a33ce45964ff2167f6ecedd419db06c1",
+        hexOf("abcdbcdecdefdefgefghfghighijhijkijkljklmklmnlmnomnopnopq").c_str());
+}
+
+void test_sha256_split_input_matches_whole(void)
+{
+    const std::vector<uint8_t> data = makeImage(1000);
+    const Sha256::Digest whole = digestOf(data);
+    for (std::size_t step : {1u, 7u, 63u, 64u, 65u, 300u}) {
+        Sha256 hash;
+        for (std::size_t at = 0; at < data.size(); at += step) {
+            const std::size_t n = data.size() - at < step ? data.size() - at : step;
+            hash.update(data.data() + at, n);
+        }
+        TEST_ASSERT_TRUE(hash.finish() == whole);
+    }
+    Sha256::Digest parsed{};
+    TEST_ASSERT_TRUE(Sha256::fromHex(Sha256::toHex(whole), parsed));
+    TEST_ASSERT_TRUE(parsed == whole);
+    TEST_ASSERT_FALSE(Sha256::fromHex("abc", parsed));
+    TEST_ASSERT_FALSE(Sha256::fromHex(std::string(64, 'g'), parsed));
+}
+
+void test_threaded_upload_streams_in_sector_writes(void)
+{
+    MockFirmwareSlot slot(kSlotBytes);
+    FakeTimeProvider clock;
+    OtaPipeline ota(slot, clock);
+    const std::vector<uint8_t> image = makeImage(10 * OtaPipeline::kChunkBytes + 123);
+    const Sha256::Digest expected = digestOf(image);
+    OtaReport report;
+    {
+        WriterThread writer(ota);
+        BodySource body(image, 1460);  // one TCP segment at a time
+        report = ota.receive(image.size(), &expected, body);
+    }
+    TEST_ASSERT_TRUE(report.outcome == OtaOutcome::Ok);
+    TEST_ASSERT_EQUAL_UINT32(image.size(), report.bytes);
+    TEST_ASSERT_TRUE(report.sha256 == expected);
+    TEST_ASSERT_TRUE(slot.image == image);
+    TEST_ASSERT_EQUAL(1, slot.commits);
+    TEST_ASSERT_EQUAL(11, slot.writeCalls);
+    TEST_ASSERT_EQUAL(OtaPipeline::kChunkBytes, slot.largestWrite);
+    TEST_ASSERT_EQUAL_UINT32(1, ota.stats().uploads);
+
+    OtaReport taken;
+    TEST_ASSERT_TRUE(ota.takeReport(taken));
+    TEST_ASSERT_TRUE(taken.outcome == OtaOutcome::Ok);
+    TEST_ASSERT_FALSE(ota.takeReport(taken));
+    TEST_ASSERT_FALSE(ota.busy());
+}
+
+void test_inline_upload_without_writer(void)
+{
+    MockFirmwareSlot slot(kSlotBytes);
+    FakeTimeProvider clock;
+    OtaPipeline ota(slot, clock);
+    const std::vector<uint8_t> image = makeImage(3 * OtaPipeline::kChunkBytes);
+    BodySource body(image, 5000);
+    const OtaReport report = ota.receive(image.size(), nullptr, body);
+    TEST_ASSERT_TRUE(report.outcome == OtaOutcome::Ok);
+    TEST_ASSERT_TRUE(slot.image == image);
+    TEST_ASSERT_TRUE(report.sha256 == digestOf(image));
+    TEST_ASSERT_EQUAL(3, slot.writeCalls);
+}
+
+void test_hash_mismatch_aborts_the_slot(void)
+{
+    MockFirmwareSlot slot(kSlotBytes);
+    FakeTimeProvider clock;
+    OtaPipeline ota(slot, clock);
+    const std::vector<uint8_t> image = makeImage(2 * OtaPipeline::kChunkBytes + 1);
+    Sha256::Digest wrong = digestOf(image);
+    wrong[0] ^= 1;
+    WriterThread writer(ota);
+    BodySource body(image, 4096);
+    const OtaReport report = ota.receive(image.size(), &wrong, body);
+    TEST_ASSERT_TRUE(report.outcome == OtaOutcome::HashMismatch);
+    TEST_ASSERT_EQUAL(0, slot.commits);
+    TEST_ASSERT_EQUAL(1, slot.aborts);
+    TEST_ASSERT_EQUAL_UINT32(1, ota.stats().failures);
+}
+
+void test_short_body_and_bad_lengths_are_refused(void)
+{
+    MockFirmwareSlot slot(kSlotBytes);
+    FakeTimeProvider clock;
+    OtaPipeline ota(slot, clock);
+    const std::vector<uint8_t> image = makeImage(5 * OtaPipeline::kChunkBytes);
+    {
+        WriterThread writer(ota);
+        BodySource cut(image, 1000, 3 * OtaPipeline::kChunkBytes + 10);
+        const OtaReport report = ota.receive(image.size(), nullptr, cut);
+        TEST_ASSERT_TRUE(report.outcome == OtaOutcome::ReceiveFailed);
+        TEST_ASSERT_EQUAL_UINT32(3 * OtaPipeline::kChunkBytes, report.bytes);
+        TEST_ASSERT_EQUAL(1, slot.aborts);
+        TEST_ASSERT_FALSE(slot.open);
+    }
+
+    BodySource body(image, 1000);
+    TEST_ASSERT_TRUE(ota.receive(0, nullptr, body).outcome == OtaOutcome::NoLength);
+    TEST_ASSERT_TRUE(ota.receive(kSlotBytes + 1, nullptr, body).outcome ==
+                     OtaOutcome::TooLarge);
+    TEST_ASSERT_EQUAL(1, slot.begins);  // neither opened the slot
+    TEST_ASSERT_EQUAL_UINT32(3, ota.stats().failures);
+}
+
+void test_write_failure_stops_the_upload(void)
+{
+    MockFirmwareSlot slot(kSlotBytes);
+    slot.failWriteAt = 2 * OtaPipeline::kChunkBytes + 1;
+    FakeTimeProvider clock;
+    OtaPipeline ota(slot, clock);
+    const std::vector<uint8_t> image = makeImage(8 * OtaPipeline::kChunkBytes);
+    WriterThread writer(ota);
+    BodySource body(image, 4096);
+    const OtaReport report = ota.receive(image.size(), nullptr, body);
+    TEST_ASSERT_TRUE(report.outcome == OtaOutcome::WriteFailed);
+    TEST_ASSERT_EQUAL(1, slot.aborts);
+    // At most the two buffers beyond the failed chunk were still received.
+    TEST_ASSERT_TRUE(report.bytes <= 5 * OtaPipeline::kChunkBytes);
+    TEST_ASSERT_EQUAL(3, slot.writeCalls);  // nothing written after the failure
+}
+
+void test_invalid_image_is_not_selected(void)
+{
+    MockFirmwareSlot slot(kSlotBytes);
+    slot.failCommit = true;
+    FakeTimeProvider clock;
+    OtaPipeline ota(slot, clock);
+    const std::vector<uint8_t> image = makeImage(OtaPipeline::kChunkBytes);
+    BodySource body(image, 4096);
+    const OtaReport report = ota.receive(image.size(), nullptr, body);
+    TEST_ASSERT_TRUE(report.outcome == OtaOutcome::Rejected);
+    TEST_ASSERT_EQUAL(0, slot.commits);
+    TEST_ASSERT_EQUAL_STRING("rejected", api::otaOutcomeName(report.outcome));
+}
+
+/// Blocks in receive() until released, holding the upload open.
+class GatedSource : public IChunkSource {
+public:
+    int receive(uint8_t* dst, std::size_t len) override
+    {
+        entered = true;
+        while (!release) {
+            std::this_thread::yield();
+        }
+        for (std::size_t i = 0; i < len; ++i) {
+            dst[i] = 0xA5;
+        }
+        return static_cast<int>(len);
+    }
+    std::atomic<bool> entered{false};
+    std::atomic<bool> release{false};
+};
+
+void test_second_upload_is_busy(void)
+{
+    MockFirmwareSlot slot(kSlotBytes);
+    FakeTimeProvider clock;
+    OtaPipeline ota(slot, clock);
+    WriterThread writer(ota);
+    GatedSource gated;
+    OtaReport first;
+    std::thread uploader([&] { first = ota.receive(100, nullptr, gated); });
+    while (!gated.entered) {
+        std::this_thread::yield();
+    }
+    TEST_ASSERT_TRUE(ota.busy());
+    const std::vector<uint8_t> image = makeImage(100);
+    BodySource body(image, 100);
+    TEST_ASSERT_TRUE(ota.receive(image.size(), nullptr, body).outcome == OtaOutcome::Busy);
+    gated.release = true;
+    uploader.join();
+    TEST_ASSERT_TRUE(first.outcome == OtaOutcome::Ok);
+    TEST_ASSERT_EQUAL(100, slot.image.size());
+}
+
+void test_delta_patch_rebuilds_the_image(void)
+{
+    DeltaCase c;
+    MockFirmwareSlot slot(kSlotBytes);
+    MockRunningImage running(c.base);
+    FakeTimeProvider clock;
+    OtaPipeline ota(slot, clock);
+    ota.setBaseImage(running);
+    WriterThread writer(ota);
+    BodySource body(c.patch, 700);
+    OtaReport report = ota.receive(c.patch.size(), nullptr, body);
+    TEST_ASSERT_TRUE(report.outcome == OtaOutcome::Ok);
+    TEST_ASSERT_TRUE(report.delta);
+    TEST_ASSERT_TRUE(slot.image == c.target);
+    TEST_ASSERT_EQUAL_UINT32(c.target.size(), report.bytes);
+    TEST_ASSERT_EQUAL_UINT32(c.patch.size(), report.transferBytes);
+    TEST_ASSERT_TRUE(c.patch.size() < c.target.size() / 20);
+    TEST_ASSERT_TRUE(report.sha256 == digestOf(c.target));
+    TEST_ASSERT_EQUAL(1, slot.commits);
+    TEST_ASSERT_EQUAL(1000 + 2000 + 4000 + 100, running.bytesRead);  // the DIFF ops only
+
+    // A full image still goes through with a base set.
+    const std::vector<uint8_t> image = makeImage(5000);
+    BodySource full(image, 1460);
+    report = ota.receive(image.size(), nullptr, full);
+    TEST_ASSERT_TRUE(report.outcome == OtaOutcome::Ok);
+    TEST_ASSERT_FALSE(report.delta);
+    TEST_ASSERT_TRUE(slot.image == image);
+}
+
+void test_delta_against_another_base_is_refused(void)
+{
+    DeltaCase c;
+    MockFirmwareSlot slot(kSlotBytes);
+    FakeTimeProvider clock;
+    OtaPipeline ota(slot, clock);
+    {
+        BodySource body(c.patch, 4096);  // no base set
+        const OtaReport report = ota.receive(c.patch.size(), nullptr, body);
+        TEST_ASSERT_TRUE(report.outcome == OtaOutcome::BaseMismatch);
+        TEST_ASSERT_TRUE(report.delta);
+    }
+    std::vector<uint8_t> other = c.base;
+    other[4321] ^= 0x40;
+    MockRunningImage running(other);
+    ota.setBaseImage(running);
+    BodySource body(c.patch, 4096);
+    const OtaReport report = ota.receive(c.patch.size(), nullptr, body);
+    TEST_ASSERT_TRUE(report.outcome == OtaOutcome::BaseMismatch);
+    TEST_ASSERT_EQUAL_STRING("base-mismatch", api::otaOutcomeName(report.outcome));
+    TEST_ASSERT_EQUAL(0, slot.begins);
+    TEST_ASSERT_EQUAL(0, running.reads);
+
+    // The caller's digest must agree with the patch's target.
+    running.image = c.base;
+    Sha256::Digest wrong = digestOf(c.target);
+    wrong[3] ^= 1;
+    BodySource again(c.patch, 4096);
+    TEST_ASSERT_TRUE(ota.receive(c.patch.size(), &wrong, again).outcome ==
+                     OtaOutcome::HashMismatch);
+    TEST_ASSERT_EQUAL(0, slot.begins);
+}
+
+void test_malformed_patch_is_aborted(void)
+{
+    DeltaCase c;
+    MockFirmwareSlot slot(kSlotBytes);
+    MockRunningImage running(c.base);
+    FakeTimeProvider clock;
+    OtaPipeline ota(slot, clock);
+    ota.setBaseImage(running);
+    WriterThread writer(ota);
+
+    // Ops that end before the target does.
+    std::vector<uint8_t> cut(c.patch.begin(), c.patch.end() - 6);
+    BodySource shortBody(cut, 4096);
+    OtaReport report = ota.receive(cut.size(), nullptr, shortBody);
+    TEST_ASSERT_TRUE(report.outcome == OtaOutcome::BadPatch);
+    TEST_ASSERT_EQUAL(1, slot.aborts);
+    TEST_ASSERT_EQUAL(0, slot.commits);
+
+    // A copy reaching past the end of the base.
+    std::vector<uint8_t> past = patchHeader(c.base, c.target);
+    putCopy(past, 8000, 2000);
+    BodySource pastBody(past, 4096);
+    report = ota.receive(past.size(), nullptr, pastBody);
+    TEST_ASSERT_TRUE(report.outcome == OtaOutcome::BadPatch);
+
+    // A run longer than its op, and an unknown op.
+    std::vector<uint8_t> run = patchHeader(c.base, c.target);
+    run.push_back(0x01);
+    putVarint(run, 0);
+    putVarint(run, 10);
+    putVarint(run, 11);
+    putVarint(run, 0);
+    BodySource runBody(run, 4096);
+    TEST_ASSERT_TRUE(ota.receive(run.size(), nullptr, runBody).outcome == OtaOutcome::BadPatch);
+    std::vector<uint8_t> op = patchHeader(c.base, c.target);
+    op.push_back(0x07);
+    BodySource opBody(op, 4096);
+    TEST_ASSERT_TRUE(ota.receive(op.size(), nullptr, opBody).outcome == OtaOutcome::BadPatch);
+
+    // An unknown format version.
+    std::vector<uint8_t> version = c.patch;
+    version[4] = 2;
+    BodySource versionBody(version, 4096);
+    TEST_ASSERT_TRUE(ota.receive(version.size(), nullptr, versionBody).outcome ==
+                     OtaOutcome::BadPatch);
+    TEST_ASSERT_EQUAL(0, slot.commits);
+    TEST_ASSERT_FALSE(slot.open);
+}
+
+}  // namespace
+
+void run_ota_pipeline_tests(void)
+{
+    RUN_TEST(test_sha256_fips_vectors);
+    RUN_TEST(test_sha256_split_input_matches_whole);
+    RUN_TEST(test_threaded_upload_streams_in_sector_writes);
+    RUN_TEST(test_inline_upload_without_writer);
+    RUN_TEST(test_hash_mismatch_aborts_the_slot);
+    RUN_TEST(test_short_body_and_bad_lengths_are_refused);
+    RUN_TEST(test_write_failure_stops_the_upload);
+    RUN_TEST(test_invalid_image_is_not_selected);
+    RUN_TEST(test_second_upload_is_busy);
+    RUN_TEST(test_delta_patch_rebuilds_the_image);
+    RUN_TEST(test_delta_against_another_base_is_refused);
+    RUN_TEST(test_malformed_patch_is_aborted);
+}
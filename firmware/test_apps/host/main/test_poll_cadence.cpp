@@ -0,0 +1,105 @@
+// SPDX-FileCopyrightText: 2026 Cryptotomte
+// SPDX-License-Identifier: AGPL-3.0-or-later
+/**
+ * @file test_poll_cadence.cpp
+ * @brief Host suite for the adaptive poll-interval policy (PollCadence.h).
+ *
+ * Registered by test_main.cpp via run_poll_cadence_tests(). Stable readings
+ * back off by doubling to their ceiling and a change returns to the base;
+ * failures retry once at the base, then back off to their own ceiling; an
+ * active pump wins over both; limits at the base keep a fixed cadence; the
+ * change detector accumulates slow drift.
+ */
+
+#include <cmath>
+#include <cstdint>
+
+#include "unity.h"
+
+#include "sensors/PollCadence.h"
+
+namespace {
+
+using Outcome = PollCadence::Outcome;
+
+constexpr PollCadenceLimits kLimits = {1000, 5000, 40000, 60000};
+
+void test_stable_backs_off_and_change_returns_to_base(void)
+{
+    PollCadence cadence(kLimits);
+    TEST_ASSERT_EQUAL_UINT32(5000, cadence.intervalMs());
+    for (uint32_t i = 0; i < PollCadence::kStableBeforeBackoff; ++i) {
+        TEST_ASSERT_EQUAL_UINT32(5000, cadence.next(false, Outcome::Stable));
+    }
+    TEST_ASSERT_EQUAL_UINT32(10000, cadence.next(false, Outcome::Stable));
+    TEST_ASSERT_EQUAL_UINT32(20000, cadence.next(false, Outcome::Stable));
+    TEST_ASSERT_EQUAL_UINT32(40000, cadence.next(false, Outcome::Stable));
+    TEST_ASSERT_EQUAL_UINT32(40000, cadence.next(false, Outcome::Stable));
+
+    TEST_ASSERT_EQUAL_UINT32(5000, cadence.next(false, Outcome::Changed));
+    TEST_ASSERT_EQUAL_UINT32(5000, cadence.next(false, Outcome::Stable));
+}
+
+void test_failures_back_off_and_recovery_restarts(void)
+{
+    PollCadence cadence(kLimits);
+    TEST_ASSERT_EQUAL_UINT32(5000, cadence.next(false, Outcome::Failed));
+    TEST_ASSERT_EQUAL_UINT32(10000, cadence.next(false, Outcome::Failed));
+    TEST_ASSERT_EQUAL_UINT32(20000, cadence.next(false, Outcome::Failed));
+    TEST_ASSERT_EQUAL_UINT32(40000, cadence.next(false, Outcome::Failed));
+    TEST_ASSERT_EQUAL_UINT32(60000, cadence.next(false, Outcome::Failed));  // not 80 s
+    TEST_ASSERT_EQUAL_UINT32(60000, cadence.next(false, Outcome::Failed));
+
+    // A good read again, even an unchanged one, drops back to the base.
+    TEST_ASSERT_EQUAL_UINT32(5000, cadence.next(false, Outcome::Stable));
+}
+
+void test_active_pump_wins_and_stop_returns_to_base(void)
+{
+    PollCadence cadence(kLimits);
+    for (int i = 0; i < 8; ++i) {
+        cadence.next(false, Outcome::Stable);
+    }
+    TEST_ASSERT_EQUAL_UINT32(40000, cadence.intervalMs());
+    TEST_ASSERT_EQUAL_UINT32(1000, cadence.next(true, Outcome::Stable));
+    TEST_ASSERT_EQUAL_UINT32(1000, cadence.next(true, Outcome::Failed));
+    TEST_ASSERT_EQUAL_UINT32(5000, cadence.next(false, Outcome::Stable));
+}
+
+void test_limits_at_base_keep_a_fixed_cadence(void)
+{
+    PollCadence cadence({5000, 5000, 0, 0});
+    for (int i = 0; i < 10; ++i) {
+        TEST_ASSERT_EQUAL_UINT32(5000, cadence.next(false, Outcome::Stable));
+    }
+    for (int i = 0; i < 10; ++i) {
+        TEST_ASSERT_EQUAL_UINT32(5000, cadence.next(false, Outcome::Failed));
+    }
+
+    // A new base (the operator's interval changed) restarts from it.
+    cadence.setLimits({2000, 2000, 8000, 8000});
+    TEST_ASSERT_EQUAL_UINT32(2000, cadence.intervalMs());
+}
+
+void test_moved_accumulates_drift(void)
+{
+    float reference = NAN;
+    TEST_ASSERT_TRUE(PollCadence::moved(40.0f, reference, 0.5f));  // seeds
+    TEST_ASSERT_EQUAL_FLOAT(40.0f, reference);
+    TEST_ASSERT_FALSE(PollCadence::moved(40.3f, reference, 0.5f));
+    TEST_ASSERT_FALSE(PollCadence::moved(40.5f, reference, 0.5f));
+    TEST_ASSERT_TRUE(PollCadence::moved(40.6f, reference, 0.5f));
+    TEST_ASSERT_EQUAL_FLOAT(40.6f, reference);
+    TEST_ASSERT_TRUE(PollCadence::moved(39.9f, reference, 0.5f));
+}
+
+}  // namespace
+
+void run_poll_cadence_tests(void)
+{
+    RUN_TEST(test_stable_backs_off_and_change_returns_to_base);
+    RUN_TEST(test_failures_back_off_and_recovery_restarts);
+    RUN_TEST(test_active_pump_wins_and_stop_returns_to_base);
+    RUN_TEST(test_limits_at_base_keep_a_fixed_cadence);
+    RUN_TEST(test_moved_accumulates_drift);
+}
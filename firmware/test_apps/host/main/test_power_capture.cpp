@@ -0,0 +1,218 @@
+// SPDX-FileCopyrightText: 2026 Cryptotomte
+// SPDX-License-Identifier: AGPL-3.0-or-later
+/**
+ * @file test_power_capture.cpp
+ * @brief Host suite for the pump current capture (SpscRing.h,
+ *        PumpCurrentCapture.h) and its binary API body.
+ *
+ * Registered by test_main.cpp via run_power_capture_tests(). The ring keeps
+ * order, refuses a push when full and survives index wrap; a producer and a
+ * consumer thread move a long sequence through it without loss or reorder.
+ * The capture's peak/mean/RMS cover every sample of a run even when the
+ * ring is full, missed periods keep their slot, and streamPowerCapture()
+ * drains the ring into the documented little-endian layout.
+ */
+
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <string>
+#include <thread>
+
+#include "unity.h"
+
+#include "api/ApiStream.h"
+#include "interfaces/SpscRing.h"
+#include "sensors/PumpCurrentCapture.h"
+
+namespace {
+
+struct StringSink final : api::IChunkSink {
+    std::string body;
+
+    bool send(const char* data, std::size_t len) override
+    {
+        body.append(data, len);
+        return true;
+    }
+};
+
+uint32_t u32At(const std::string& body, std::size_t offset)
+{
+    uint32_t v = 0;
+    for (int i = 3; i >= 0; --i) {
+        v = (v << 8) | static_cast<uint8_t>(body[offset + i]);
+    }
+    return v;
+}
+
+uint16_t u16At(const std::string& body, std::size_t offset)
+{
+    return static_cast<uint16_t>(static_cast<uint8_t>(body[offset]) |
+                                 static_cast<uint8_t>(body[offset + 1]) << 8);
+}
+
+void test_ring_fifo_full_and_wrap(void)
+{
+    SpscRing<uint32_t, 4> ring;
+    uint32_t out[4] = {};
+    TEST_ASSERT_EQUAL_size_t(0, ring.pop(out, 4));
+
+    // Many times round the four slots: order kept, a full ring refuses.
+    uint32_t next = 0;
+    uint32_t expected = 0;
+    for (int round = 0; round < 100; ++round) {
+        while (ring.push(next)) {
+            ++next;
+        }
+        TEST_ASSERT_EQUAL_size_t(4, ring.size());
+        const std::size_t n = ring.pop(out, 3);
+        TEST_ASSERT_EQUAL_size_t(3, n);
+        for (std::size_t i = 0; i < n; ++i) {
+            TEST_ASSERT_EQUAL_UINT32(expected++, out[i]);
+        }
+    }
+    TEST_ASSERT_EQUAL_size_t(1, ring.pop(out, 4));
+    TEST_ASSERT_EQUAL_UINT32(expected, out[0]);
+}
+
+void test_ring_two_threads_lose_nothing(void)
+{
+    constexpr uint32_t kCount = 200000;
+    SpscRing<uint32_t, 64> ring;
+    std::thread producer([&ring] {
+        for (uint32_t i = 0; i < kCount;) {
+            if (ring.push(i)) {
+                ++i;
+            } else {
+                std::this_thread::yield();
+            }
+        }
+    });
+    uint32_t expected = 0;
+    bool ordered = true;
+    uint32_t batch[16];
+    while (expected < kCount) {
+        const std::size_t n = ring.pop(batch, 16);
+        for (std::size_t i = 0; i < n; ++i) {
+            ordered = ordered && batch[i] == expected;
+            ++expected;
+        }
+        if (n == 0) {
+            std::this_thread::yield();
+        }
+    }
+    producer.join();
+    TEST_ASSERT_TRUE(ordered);
+    TEST_ASSERT_EQUAL_UINT32(kCount, expected);
+}
+
+void test_capture_run_statistics(void)
+{
+    PumpCurrentCapture capture;
+    TEST_ASSERT_EQUAL_UINT32(0, capture.lastRun().run);
+    TEST_ASSERT_EQUAL_UINT32(0, capture.endRun(0).run);  // none open
+
+    // An inrush spike, then a steady 2 A; one failed read.
+    capture.beginRun(1120, 1000000);
+    TEST_ASSERT_EQUAL_UINT32(1, capture.activeRun());
+    TEST_ASSERT_EQUAL_UINT32(1120, capture.periodUs());
+    capture.addSample(6.0f);
+    capture.addSample(2.0f);
+    capture.addMissed();
+    capture.addSample(2.0f);
+    capture.addSample(NAN);  // a non-finite value is a missed period
+    capture.addSample(2.0f);
+    const CurrentRunStats run = capture.endRun(1250000);
+    TEST_ASSERT_EQUAL_UINT32(0, capture.activeRun());
+
+    TEST_ASSERT_EQUAL_UINT32(1, run.run);
+    TEST_ASSERT_EQUAL_UINT32(250, run.durationMs);
+    TEST_ASSERT_EQUAL_UINT32(4, run.samples);
+    TEST_ASSERT_EQUAL_UINT32(2, run.missed);
+    TEST_ASSERT_EQUAL_UINT32(0, run.dropped);
+    TEST_ASSERT_FLOAT_WITHIN(1e-6f, 6.0f, run.peakA);
+    TEST_ASSERT_FLOAT_WITHIN(1e-6f, 3.0f, run.meanA);
+    TEST_ASSERT_FLOAT_WITHIN(1e-5f, std::sqrt(12.0f), run.rmsA);  // (36+3*4)/4
+
+    const CurrentRunStats published = capture.lastRun();
+    TEST_ASSERT_EQUAL_UINT32(1, published.run);
+    TEST_ASSERT_FLOAT_WITHIN(1e-6f, 3.0f, published.meanA);
+
+    // Samples outside a run are ignored; the next run counts on.
+    capture.addSample(9.0f);
+    capture.beginRun(1120, 0);
+    TEST_ASSERT_EQUAL_UINT32(2, capture.activeRun());
+    const CurrentRunStats empty = capture.endRun(0);
+    TEST_ASSERT_EQUAL_UINT32(0, empty.samples);
+    TEST_ASSERT_TRUE(std::isnan(empty.meanA));
+
+    // Six ring entries from run 1 (four samples, two gaps), none from 9 A.
+    CaptureSample out[16];
+    TEST_ASSERT_EQUAL_size_t(6, capture.drain(out, 16));
+    TEST_ASSERT_EQUAL_INT16(6000, out[0].milliamps);
+    TEST_ASSERT_EQUAL_INT16(PumpCurrentCapture::kMissingSample, out[2].milliamps);
+    TEST_ASSERT_EQUAL_INT16(PumpCurrentCapture::kMissingSample, out[4].milliamps);
+    TEST_ASSERT_EQUAL_UINT16(1, out[5].run);
+}
+
+void test_capture_full_ring_drops_but_statistics_cover_all(void)
+{
+    PumpCurrentCapture capture;
+    const std::size_t total = PumpCurrentCapture::kRingSamples + 100;
+    capture.beginRun(1000, 0);
+    for (std::size_t i = 0; i < total; ++i) {
+        capture.addSample(1.0f);
+    }
+    capture.addSample(40.0f);  // clamps to the int16 mA range in the ring
+    const CurrentRunStats run = capture.endRun(0);
+
+    TEST_ASSERT_EQUAL_UINT32(total + 1, run.samples);
+    TEST_ASSERT_EQUAL_UINT32(101, run.dropped);
+    TEST_ASSERT_EQUAL_UINT32(101, capture.droppedTotal());
+    TEST_ASSERT_FLOAT_WITHIN(1e-6f, 40.0f, run.peakA);
+
+    CaptureSample out[4];
+    TEST_ASSERT_EQUAL_size_t(4, capture.drain(out, 4));
+    TEST_ASSERT_EQUAL_INT16(1000, out[0].milliamps);
+}
+
+void test_capture_body_layout_and_drain(void)
+{
+    PumpCurrentCapture capture;
+    capture.beginRun(1120, 0);
+    capture.addSample(1.5f);
+    capture.addSample(-0.25f);
+    capture.addMissed();
+
+    StringSink sink;
+    TEST_ASSERT_TRUE(api::streamPowerCapture(capture, sink));
+    TEST_ASSERT_EQUAL_size_t(16 + 3 * 4, sink.body.size());
+    TEST_ASSERT_EQUAL_MEMORY(api::kPowerCaptureMagic, sink.body.data(), 4);
+    TEST_ASSERT_EQUAL_UINT32(1120, u32At(sink.body, 4));
+    TEST_ASSERT_EQUAL_UINT32(1, u32At(sink.body, 8));  // run in progress
+    TEST_ASSERT_EQUAL_UINT32(0, u32At(sink.body, 12));
+    TEST_ASSERT_EQUAL_UINT16(1, u16At(sink.body, 16));
+    TEST_ASSERT_EQUAL_INT16(1500, static_cast<int16_t>(u16At(sink.body, 18)));
+    TEST_ASSERT_EQUAL_INT16(-250, static_cast<int16_t>(u16At(sink.body, 22)));
+    TEST_ASSERT_EQUAL_INT16(INT16_MIN, static_cast<int16_t>(u16At(sink.body, 26)));
+
+    // Drained: the next body is the header alone; idle reports run 0.
+    capture.endRun(0);
+    StringSink again;
+    TEST_ASSERT_TRUE(api::streamPowerCapture(capture, again));
+    TEST_ASSERT_EQUAL_size_t(16, again.body.size());
+    TEST_ASSERT_EQUAL_UINT32(0, u32At(again.body, 8));
+}
+
+}  // namespace
+
+void run_power_capture_tests(void)
+{
+    RUN_TEST(test_ring_fifo_full_and_wrap);
+    RUN_TEST(test_ring_two_threads_lose_nothing);
+    RUN_TEST(test_capture_run_statistics);
+    RUN_TEST(test_capture_full_ring_drops_but_statistics_cover_all);
+    RUN_TEST(test_capture_body_layout_and_drain);
+}
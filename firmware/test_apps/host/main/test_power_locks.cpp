@@ -0,0 +1,142 @@
+// SPDX-FileCopyrightText: 2026 Cryptotomte
+// SPDX-License-Identifier: AGPL-3.0-or-later
+/**
+ * @file test_power_locks.cpp
+ * @brief Host suite for the power-management locks and their residency
+ *        (interfaces/PowerLocks.h).
+ *
+ * Registered by test_main.cpp via run_power_locks_tests(). Time goes to the
+ * state the held kinds demand, the highest winning; nested holders keep a
+ * state until the last release; nothing is charged before start(); the
+ * guard acquires and releases once and is a no-op on a null lock; the bus
+ * masters hold their lock exactly across a transfer.
+ */
+
+#include <cstdint>
+
+#include "unity.h"
+
+#include "interfaces/PowerLocks.h"
+#include "sensors/I2cBusMaster.h"
+#include "sensors/testing/MockI2cBus.h"
+
+namespace {
+
+uint64_t inState(const PowerResidencyStats& s, PowerState state)
+{
+    return s.us[static_cast<std::size_t>(state)];
+}
+
+struct CountingLock final : IPowerLock {
+    int held = 0;
+    int acquires = 0;
+    void acquire() override
+    {
+        ++held;
+        ++acquires;
+    }
+    void release() override { --held; }
+};
+
+/// An I2C bus that records whether the lock was held while it ran.
+struct WatchedBus final : MockI2cBus {
+    const CountingLock* lock = nullptr;
+    bool heldDuringTransfer = false;
+    bool probe(uint8_t address7) override
+    {
+        heldDuringTransfer = lock->held > 0;
+        return MockI2cBus::probe(address7);
+    }
+};
+
+void test_time_goes_to_the_highest_demand(void)
+{
+    PowerResidency r;
+    r.start(1000);
+    TEST_ASSERT_TRUE(r.state() == PowerState::Idle);
+    r.acquired(PowerLockKind::NoLightSleep, 2000);    // idle 1000
+    r.acquired(PowerLockKind::ApbMax, 2500);          // awake 500
+    r.acquired(PowerLockKind::CpuMax, 2600);          // apb 100
+    TEST_ASSERT_TRUE(r.state() == PowerState::CpuMax);
+    r.released(PowerLockKind::CpuMax, 2800);          // cpu 200
+    r.released(PowerLockKind::ApbMax, 3000);          // apb 200
+    r.released(PowerLockKind::NoLightSleep, 4000);    // awake 1000
+
+    const PowerResidencyStats s = r.snapshot(10000);  // idle 6000
+    TEST_ASSERT_EQUAL_UINT64(7000, inState(s, PowerState::Idle));
+    TEST_ASSERT_EQUAL_UINT64(1500, inState(s, PowerState::Awake));
+    TEST_ASSERT_EQUAL_UINT64(300, inState(s, PowerState::ApbMax));
+    TEST_ASSERT_EQUAL_UINT64(200, inState(s, PowerState::CpuMax));
+    TEST_ASSERT_EQUAL_UINT32(1, s.acquisitions[static_cast<std::size_t>(PowerLockKind::CpuMax)]);
+}
+
+void test_nested_holders_keep_the_state(void)
+{
+    PowerResidency r;
+    r.start(0);
+    r.acquired(PowerLockKind::ApbMax, 100);
+    r.acquired(PowerLockKind::ApbMax, 200);
+    r.released(PowerLockKind::ApbMax, 300);
+    TEST_ASSERT_TRUE(r.state() == PowerState::ApbMax);
+    r.released(PowerLockKind::ApbMax, 400);
+    r.released(PowerLockKind::ApbMax, 450);           // unmatched: ignored
+    TEST_ASSERT_TRUE(r.state() == PowerState::Idle);
+
+    const PowerResidencyStats s = r.snapshot(500);
+    TEST_ASSERT_EQUAL_UINT64(300, inState(s, PowerState::ApbMax));
+    TEST_ASSERT_EQUAL_UINT64(200, inState(s, PowerState::Idle));
+    TEST_ASSERT_EQUAL_UINT32(2, s.acquisitions[static_cast<std::size_t>(PowerLockKind::ApbMax)]);
+}
+
+void test_nothing_is_charged_before_start(void)
+{
+    PowerResidency r;
+    r.acquired(PowerLockKind::CpuMax, 100);
+    r.released(PowerLockKind::CpuMax, 900);
+    PowerResidencyStats s = r.snapshot(1000);
+    for (uint64_t us : s.us) {
+        TEST_ASSERT_EQUAL_UINT64(0, us);
+    }
+    r.start(1000);
+    s = r.snapshot(1250);
+    TEST_ASSERT_EQUAL_UINT64(250, inState(s, PowerState::Idle));
+}
+
+void test_guard_pairs_and_null_is_a_no_op(void)
+{
+    CountingLock lock;
+    {
+        PowerLockGuard guard(&lock);
+        TEST_ASSERT_EQUAL_INT(1, lock.held);
+    }
+    TEST_ASSERT_EQUAL_INT(0, lock.held);
+    TEST_ASSERT_EQUAL_INT(1, lock.acquires);
+    PowerLockGuard none(nullptr);
+}
+
+void test_bus_master_holds_the_lock_across_a_transfer(void)
+{
+    CountingLock lock;
+    WatchedBus raw;
+    raw.lock = &lock;
+    I2cBusMaster bus(raw);
+    bus.port().probe(0x40);
+    TEST_ASSERT_FALSE(raw.heldDuringTransfer);  // no lock set: not taken
+
+    bus.setPowerLock(&lock);
+    bus.port().probe(0x40);
+    TEST_ASSERT_TRUE(raw.heldDuringTransfer);
+    TEST_ASSERT_EQUAL_INT(0, lock.held);
+    TEST_ASSERT_EQUAL_INT(1, lock.acquires);
+}
+
+}  // namespace
+
+void run_power_locks_tests(void)
+{
+    RUN_TEST(test_time_goes_to_the_highest_demand);
+    RUN_TEST(test_nested_holders_keep_the_state);
+    RUN_TEST(test_nothing_is_charged_before_start);
+    RUN_TEST(test_guard_pairs_and_null_is_a_no_op);
+    RUN_TEST(test_bus_master_holds_the_lock_across_a_transfer);
+}
@@ -0,0 +1,197 @@
+// SPDX-FileCopyrightText: 2026 Cryptotomte
+// SPDX-License-Identifier: AGPL-3.0-or-later
+/**
+ * @file test_pump_usage.cpp
+ * @brief Host suite for the per-pump hourly/daily usage rollups
+ *        (PumpUsage.h).
+ *
+ * Registered by test_main.cpp via run_pump_usage_tests(). A stop adds the
+ * run to the hour and day it started in and stores one history record; a
+ * run started before the wall clock was set is only counted; the first
+ * report folds the runs of earlier boots back in; an unknown pump is
+ * refused; a metered pump's stop also stores its volume and mean flow.
+ */
+
+#include <cstdint>
+
+#include "unity.h"
+
+#include "actuators/testing/FakeTimeProvider.h"
+#include "actuators/testing/MockWaterPump.h"
+#include "control/PumpUsage.h"
+#include "interfaces/IFlowMeter.h"
+#include "storage/testing/MockDataStorage.h"
+#include "time/testing/FakeWallClock.h"
+
+namespace {
+
+constexpr uint32_t kDay = 1'700'006'400;  // a UTC midnight
+constexpr uint32_t kHour = 3600;
+
+struct Fixture {
+    FakeTimeProvider time;
+    MockWaterPump pump{"plant", time};
+    MockDataStorage storage;
+    FakeWallClock wall;
+    PumpUsage usage{storage, wall};
+
+    Fixture()
+    {
+        TEST_ASSERT_TRUE(pump.initialize());
+        wall.setEpoch(kDay + 10 * kHour);
+        TEST_ASSERT_TRUE(usage.addPump("plant", pump));
+    }
+
+    /// One run of @p seconds, polled at start and stop.
+    void run(int seconds)
+    {
+        TEST_ASSERT_TRUE(pump.runFor(seconds));
+        usage.poll();
+        time.advance(static_cast<int64_t>(seconds) * 1000);
+        wall.setEpoch(wall.nowEpoch() + static_cast<uint32_t>(seconds));
+        pump.update();
+        usage.poll();
+    }
+};
+
+void test_stop_adds_run_to_its_hour_and_day(void)
+{
+    Fixture f;
+    f.usage.poll();
+    f.run(20);
+    f.run(10);
+    f.wall.setEpoch(kDay + 13 * kHour + 5);
+    f.run(30);
+
+    PumpUsage::Report report;
+    TEST_ASSERT_TRUE(f.usage.report("plant", report));
+    TEST_ASSERT_TRUE(report.timed);
+    const PumpUsageBucket& now = report.hours[PumpUsage::kHours - 1];
+    TEST_ASSERT_EQUAL_UINT32(kDay + 13 * kHour, now.start);
+    TEST_ASSERT_EQUAL_UINT32(30'000, now.runMs);
+    TEST_ASSERT_EQUAL_UINT32(1, now.starts);
+    const PumpUsageBucket& earlier = report.hours[PumpUsage::kHours - 4];
+    TEST_ASSERT_EQUAL_UINT32(kDay + 10 * kHour, earlier.start);
+    TEST_ASSERT_EQUAL_UINT32(30'000, earlier.runMs);
+    TEST_ASSERT_EQUAL_UINT32(2, earlier.starts);
+    TEST_ASSERT_EQUAL_UINT32(0, report.hours[PumpUsage::kHours - 2].starts);
+
+    const PumpUsageBucket& today = report.days[PumpUsage::kDays - 1];
+    TEST_ASSERT_EQUAL_UINT32(kDay, today.start);
+    TEST_ASSERT_EQUAL_UINT32(60'000, today.runMs);
+    TEST_ASSERT_EQUAL_UINT32(3, today.starts);
+
+    // One record per run, stamped with its start.
+    const auto rows = f.storage.getSensorReadings("pump_plant", 0, UINT32_MAX);
+    TEST_ASSERT_EQUAL_size_t(3, rows.size());
+    TEST_ASSERT_EQUAL_UINT32(kDay + 10 * kHour, rows[0].epoch);
+    TEST_ASSERT_EQUAL_FLOAT(20.0f, rows[0].value);
+
+    // Two days later the hour ring has moved on; the day ring still holds it.
+    f.wall.setEpoch(kDay + 2 * 86400 + 20 * kHour);
+    TEST_ASSERT_TRUE(f.usage.report("plant", report));
+    for (const PumpUsageBucket& hour : report.hours) {
+        TEST_ASSERT_EQUAL_UINT32(0, hour.starts);
+    }
+    TEST_ASSERT_EQUAL_UINT32(kDay, report.days[PumpUsage::kDays - 3].start);
+    TEST_ASSERT_EQUAL_UINT32(3, report.days[PumpUsage::kDays - 3].starts);
+    TEST_ASSERT_EQUAL_UINT32(0, report.days[PumpUsage::kDays - 1].starts);
+}
+
+void test_run_before_clock_set_is_untimed(void)
+{
+    Fixture f;
+    f.wall.setEpoch(1000);  // not set yet
+    f.run(15);
+
+    PumpUsage::Report report;
+    TEST_ASSERT_TRUE(f.usage.report("plant", report));
+    TEST_ASSERT_FALSE(report.timed);
+    TEST_ASSERT_EQUAL_UINT32(1, report.untimedRuns);
+    TEST_ASSERT_EQUAL_UINT32(0, report.days[PumpUsage::kDays - 1].starts);
+    TEST_ASSERT_EQUAL_size_t(0, f.storage.getSensorReadings("pump_plant", 0, UINT32_MAX).size());
+}
+
+void test_first_report_restores_earlier_boots(void)
+{
+    Fixture f;
+    // Runs of an earlier boot: yesterday, two hours ago, and far too old.
+    f.storage.storeSensorReading("pump_plant", kDay - 86400 + 5, 40.0f);
+    f.storage.storeSensorReading("pump_plant", kDay + 8 * kHour, 12.5f);
+    f.storage.storeSensorReading("pump_plant", kDay - 30 * 86400, 99.0f);
+
+    f.usage.poll();  // clock set: runs from here on are this boot's
+    f.run(20);
+
+    PumpUsage::Report report;
+    TEST_ASSERT_TRUE(f.usage.report("plant", report));
+    TEST_ASSERT_EQUAL_UINT32(1, report.days[PumpUsage::kDays - 2].starts);
+    TEST_ASSERT_EQUAL_UINT32(40'000, report.days[PumpUsage::kDays - 2].runMs);
+    TEST_ASSERT_EQUAL_UINT32(2, report.days[PumpUsage::kDays - 1].starts);
+    TEST_ASSERT_EQUAL_UINT32(32'500, report.days[PumpUsage::kDays - 1].runMs);
+    TEST_ASSERT_EQUAL_UINT32(12'500, report.hours[PumpUsage::kHours - 3].runMs);
+    uint32_t starts = 0;
+    for (const PumpUsageBucket& day : report.days) {
+        starts += day.starts;
+    }
+    TEST_ASSERT_EQUAL_UINT32(3, starts);
+
+    // Restored once: a second report does not count them again.
+    TEST_ASSERT_TRUE(f.usage.report("plant", report));
+    TEST_ASSERT_EQUAL_UINT32(2, report.days[PumpUsage::kDays - 1].starts);
+}
+
+struct ScriptedFlowMeter : IFlowMeter {
+    uint32_t ml = 0;
+
+    uint32_t deliveredMl() override { return ml; }
+    float flowMlPerMin() override { return 0.0f; }
+};
+
+void test_metered_stop_stores_volume_and_flow(void)
+{
+    Fixture f;
+    ScriptedFlowMeter meter;
+    f.pump.setFlowMeter(&meter);
+    f.usage.poll();
+
+    TEST_ASSERT_TRUE(f.pump.runForVolume(400, 60));
+    f.usage.poll();
+    f.time.advance(30'000);
+    meter.ml = 400;
+    f.pump.update();
+    f.usage.poll();
+
+    const auto runtime = f.storage.getSensorReadings("pump_plant", 0, UINT32_MAX);
+    const auto volume = f.storage.getSensorReadings("pump_plant_ml", 0, UINT32_MAX);
+    const auto flow = f.storage.getSensorReadings("pump_plant_ml_min", 0, UINT32_MAX);
+    TEST_ASSERT_EQUAL_size_t(1, runtime.size());
+    TEST_ASSERT_EQUAL_size_t(1, volume.size());
+    TEST_ASSERT_EQUAL_size_t(1, flow.size());
+    TEST_ASSERT_EQUAL_FLOAT(30.0f, runtime[0].value);
+    TEST_ASSERT_EQUAL_FLOAT(400.0f, volume[0].value);
+    TEST_ASSERT_EQUAL_FLOAT(800.0f, flow[0].value);
+    TEST_ASSERT_EQUAL_UINT32(kDay + 10 * kHour, volume[0].epoch);
+
+    // An unmetered pump stores the runtime only (the other fixtures).
+    TEST_ASSERT_EQUAL_size_t(3, f.storage.history.size());
+}
+
+void test_unknown_pump_is_refused(void)
+{
+    Fixture f;
+    PumpUsage::Report report;
+    TEST_ASSERT_FALSE(f.usage.report("reservoir", report));
+    TEST_ASSERT_EQUAL_STRING("pump_zone1", PumpUsage::metricFor("zone1").c_str());
+}
+
+}  // namespace
+
+void run_pump_usage_tests(void)
+{
+    RUN_TEST(test_stop_adds_run_to_its_hour_and_day);
+    RUN_TEST(test_run_before_clock_set_is_untimed);
+    RUN_TEST(test_first_report_restores_earlier_boots);
+    RUN_TEST(test_metered_stop_stores_volume_and_flow);
+    RUN_TEST(test_unknown_pump_is_refused);
+}
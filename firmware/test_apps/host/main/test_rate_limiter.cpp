@@ -0,0 +1,137 @@
+// SPDX-FileCopyrightText: 2026 Cryptotomte
+// SPDX-License-Identifier: AGPL-3.0-or-later
+/**
+ * @file test_rate_limiter.cpp
+ * @brief Host suite for the per-client token-bucket limiter (RateLimiter.h).
+ *
+ * A fresh client gets its burst, then the refill rate, with no drift at
+ * sub-token steps and across a clock wrap; clients do not share buckets;
+ * the least recently seen client is the one forgotten; an unconfigured or
+ * zero-rate limiter admits everything and counts nothing.
+ */
+
+#include <cstdint>
+
+#include "unity.h"
+
+#include "api/RateLimiter.h"
+
+namespace {
+
+using api::ClientAddress;
+using api::RateLimiter;
+
+/// 192.168.1.<last>, in network order on the little-endian host.
+ClientAddress client(uint8_t last)
+{
+    return ClientAddress::fromIpv4(0x0001A8C0u | (static_cast<uint32_t>(last) << 24));
+}
+
+void test_burst_then_refill_rate()
+{
+    RateLimiter limiter;
+    limiter.configure(2, 3);
+    for (int i = 0; i < 3; ++i) {
+        TEST_ASSERT_TRUE(limiter.admit(client(1), 1000));
+    }
+    TEST_ASSERT_FALSE(limiter.admit(client(1), 1000));
+    TEST_ASSERT_EQUAL_UINT32(1, limiter.throttled());
+
+    // Two a second: half a token after 250 ms, a whole one at 500 ms.
+    TEST_ASSERT_FALSE(limiter.admit(client(1), 1250));
+    TEST_ASSERT_TRUE(limiter.admit(client(1), 1500));
+    TEST_ASSERT_FALSE(limiter.admit(client(1), 1500));
+    // 1 ms steps add up to a token with nothing lost.
+    bool admitted = false;
+    uint32_t at = 1500;
+    while (!admitted) {
+        ++at;
+        admitted = limiter.admit(client(1), at);
+    }
+    TEST_ASSERT_EQUAL_UINT32(2000, at);
+
+    // A long idle refills to the burst, no further.
+    for (int i = 0; i < 3; ++i) {
+        TEST_ASSERT_TRUE(limiter.admit(client(1), 60000));
+    }
+    TEST_ASSERT_FALSE(limiter.admit(client(1), 60000));
+    TEST_ASSERT_EQUAL_UINT32(3 + 499 + 1, limiter.throttled());  // every refusal counts
+}
+
+void test_clock_wrap()
+{
+    RateLimiter limiter;
+    limiter.configure(1, 1);
+    TEST_ASSERT_TRUE(limiter.admit(client(1), UINT32_MAX - 499));
+    TEST_ASSERT_FALSE(limiter.admit(client(1), UINT32_MAX));
+    TEST_ASSERT_TRUE(limiter.admit(client(1), 500));  // 1000 ms later
+}
+
+void test_clients_have_their_own_buckets()
+{
+    RateLimiter limiter;
+    limiter.configure(1, 2);
+    TEST_ASSERT_TRUE(limiter.admit(client(1), 0));
+    TEST_ASSERT_TRUE(limiter.admit(client(1), 0));
+    TEST_ASSERT_FALSE(limiter.admit(client(1), 0));
+    TEST_ASSERT_TRUE(limiter.admit(client(2), 0));  // the flood does not spill
+
+    // The same address, seen as IPv4 or as its mapped IPv6 form.
+    ClientAddress mapped;
+    mapped.bytes[10] = 0xFF;
+    mapped.bytes[11] = 0xFF;
+    mapped.bytes[12] = 192;
+    mapped.bytes[13] = 168;
+    mapped.bytes[14] = 1;
+    mapped.bytes[15] = 1;
+    TEST_ASSERT_TRUE(mapped == client(1));
+    TEST_ASSERT_FALSE(limiter.admit(mapped, 0));
+}
+
+void test_least_recent_client_is_forgotten()
+{
+    RateLimiter limiter;
+    limiter.configure(1, 1);
+    // Fill the table; client 1 stays the most recent by polling last.
+    for (uint8_t c = 2; c < 2 + RateLimiter::kClients - 1; ++c) {
+        TEST_ASSERT_TRUE(limiter.admit(client(c), c));
+    }
+    TEST_ASSERT_TRUE(limiter.admit(client(1), 100));
+    TEST_ASSERT_FALSE(limiter.admit(client(1), 100));
+
+    // A newcomer evicts client 2, the longest unseen, and gets a full bucket.
+    TEST_ASSERT_TRUE(limiter.admit(client(200), 101));
+    TEST_ASSERT_FALSE(limiter.admit(client(1), 101));   // still tracked, still empty
+    TEST_ASSERT_TRUE(limiter.admit(client(2), 102));    // forgotten: full again
+    TEST_ASSERT_FALSE(limiter.admit(client(200), 102)); // kept
+}
+
+void test_off_admits_everything()
+{
+    RateLimiter off;
+    TEST_ASSERT_FALSE(off.enabled());
+    for (int i = 0; i < 100; ++i) {
+        TEST_ASSERT_TRUE(off.admit(client(1), 0));
+    }
+    TEST_ASSERT_EQUAL_UINT32(0, off.throttled());
+
+    RateLimiter limiter;
+    limiter.configure(5, 0);  // burst 0 means 1
+    TEST_ASSERT_TRUE(limiter.enabled());
+    TEST_ASSERT_TRUE(limiter.admit(client(1), 0));
+    TEST_ASSERT_FALSE(limiter.admit(client(1), 0));
+    limiter.configure(0, 10);
+    TEST_ASSERT_FALSE(limiter.enabled());
+    TEST_ASSERT_TRUE(limiter.admit(client(1), 0));
+}
+
+}  // namespace
+
+void run_rate_limiter_tests(void)
+{
+    RUN_TEST(test_burst_then_refill_rate);
+    RUN_TEST(test_clock_wrap);
+    RUN_TEST(test_clients_have_their_own_buckets);
+    RUN_TEST(test_least_recent_client_is_forgotten);
+    RUN_TEST(test_off_admits_everything);
+}
@@ -0,0 +1,295 @@
+// SPDX-FileCopyrightText: 2026 Cryptotomte
+// SPDX-License-Identifier: AGPL-3.0-or-later
+/**
+ * @file test_read_ahead.cpp
+ * @brief Host suite for the overlapped read/send of large bodies
+ *        (api/ReadAheadPipe.h).
+ *
+ * Registered by test_main.cpp via run_read_ahead_tests(). A body pumped
+ * through the two buffers — by a reader thread, as on target, or inline —
+ * reaches the sink byte for byte in chunk-sized sends; the reader fills
+ * the next buffer while a send is still in progress; a read error ends
+ * the body after what came before it, and a failed send stops the reader.
+ * A file source limited to a byte range sends exactly that range.
+ */
+
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <thread>
+#include <vector>
+
+#include "unity.h"
+
+#include "api/ReadAheadPipe.h"
+
+using api::FileChunkSource;
+using api::IChunkSink;
+using api::IChunkSource;
+using api::PumpOutcome;
+using api::ReadAheadPipe;
+
+namespace {
+
+std::vector<uint8_t> makeBody(std::size_t len)
+{
+    std::vector<uint8_t> body(len);
+    uint32_t x = 0x9E3779B9u;
+    for (uint8_t& b : body) {
+        x = x * 1664525u + 1013904223u;
+        b = static_cast<uint8_t>(x >> 24);
+    }
+    return body;
+}
+
+/// @p body in pieces of at most @p piece bytes; fails (-1) once
+/// @p failAt bytes are out, when set.
+class BodySource : public IChunkSource {
+public:
+    BodySource(const std::vector<uint8_t>& body, std::size_t piece,
+               std::size_t failAt = SIZE_MAX)
+        : body_(body), piece_(piece), failAt_(failAt)
+    {
+    }
+
+    int receive(uint8_t* dst, std::size_t len) override
+    {
+        if (pos >= failAt_) {
+            return -1;
+        }
+        std::size_t n = body_.size() - pos;
+        n = n < len ? n : len;
+        n = n < piece_ ? n : piece_;
+        n = n < failAt_ - pos ? n : failAt_ - pos;
+        for (std::size_t i = 0; i < n; ++i) {
+            dst[i] = body_[pos + i];
+        }
+        pos += n;
+        return static_cast<int>(n);
+    }
+
+    std::atomic<std::size_t> pos{0};
+
+private:
+    const std::vector<uint8_t>& body_;
+    std::size_t piece_;
+    std::size_t failAt_;
+};
+
+/// Collects what is sent; refuses the send after @p acceptSends.
+class CollectSink : public IChunkSink {
+public:
+    explicit CollectSink(std::size_t acceptSends = SIZE_MAX) : acceptSends_(acceptSends) {}
+
+    bool send(const char* data, std::size_t len) override
+    {
+        if (sends == acceptSends_) {
+            return false;
+        }
+        ++sends;
+        largest = len > largest ? len : largest;
+        body.insert(body.end(), data, data + len);
+        return true;
+    }
+
+    std::vector<uint8_t> body;
+    std::size_t sends = 0;
+    std::size_t largest = 0;
+
+private:
+    std::size_t acceptSends_;
+};
+
+/// The reader task of the target, as a thread running serveRead().
+class ReaderThread {
+public:
+    explicit ReaderThread(ReadAheadPipe& pipe) : pipe_(pipe)
+    {
+        pipe_.attachReader();
+        thread_ = std::thread([this] {
+            while (!stop_) {
+                pipe_.serveRead(5);
+            }
+        });
+    }
+    ~ReaderThread()
+    {
+        stop_ = true;
+        thread_.join();
+    }
+
+private:
+    ReadAheadPipe& pipe_;
+    std::atomic<bool> stop_{false};
+    std::thread thread_;
+};
+
+void test_threaded_pump_sends_the_body_in_chunks(void)
+{
+    ReadAheadPipe pipe;
+    const std::vector<uint8_t> body = makeBody(10 * ReadAheadPipe::kChunkBytes + 77);
+    ReaderThread reader(pipe);
+    for (int round = 0; round < 2; ++round) {  // the pipe is reusable
+        BodySource source(body, 700);
+        CollectSink sink;
+        uint8_t spare[64];
+        TEST_ASSERT_TRUE(pipe.pump(source, sink, spare, sizeof(spare)) == PumpOutcome::Ok);
+        TEST_ASSERT_TRUE(sink.body == body);
+        TEST_ASSERT_EQUAL(11, sink.sends);
+        TEST_ASSERT_EQUAL(ReadAheadPipe::kChunkBytes, sink.largest);
+    }
+    TEST_ASSERT_EQUAL_UINT32(2, pipe.stats().pumps);
+    TEST_ASSERT_EQUAL_UINT32(0, pipe.stats().inlined);
+}
+
+void test_pump_without_a_reader_copies_inline(void)
+{
+    ReadAheadPipe pipe;
+    const std::vector<uint8_t> body = makeBody(5000);
+    BodySource source(body, 300);
+    CollectSink sink;
+    uint8_t spare[1024];
+    TEST_ASSERT_TRUE(pipe.pump(source, sink, spare, sizeof(spare)) == PumpOutcome::Ok);
+    TEST_ASSERT_TRUE(sink.body == body);
+    TEST_ASSERT_EQUAL(sizeof(spare), sink.largest);
+    TEST_ASSERT_EQUAL_UINT32(1, pipe.stats().inlined);
+
+    // An empty body sends nothing.
+    const std::vector<uint8_t> none;
+    BodySource empty(none, 300);
+    CollectSink nothing;
+    TEST_ASSERT_TRUE(pipe.pump(empty, nothing, spare, sizeof(spare)) == PumpOutcome::Ok);
+    TEST_ASSERT_EQUAL(0, nothing.sends);
+}
+
+/// Holds its first send until the source has been read past one chunk:
+/// only a reader working alongside the send gets it there.
+class OverlapSink : public IChunkSink {
+public:
+    explicit OverlapSink(const BodySource& source) : source_(source) {}
+
+    bool send(const char*, std::size_t len) override
+    {
+        if (sends++ == 0) {
+            const auto deadline = std::chrono::steady_clock::now() + std::chrono::seconds(2);
+            while (source_.pos <= ReadAheadPipe::kChunkBytes &&
+                   std::chrono::steady_clock::now() < deadline) {
+                std::this_thread::yield();
+            }
+            overlapped = source_.pos > ReadAheadPipe::kChunkBytes;
+        }
+        bytes += len;
+        return true;
+    }
+
+    std::size_t sends = 0;
+    std::size_t bytes = 0;
+    bool overlapped = false;
+
+private:
+    const BodySource& source_;
+};
+
+void test_reader_fills_the_next_buffer_during_a_send(void)
+{
+    ReadAheadPipe pipe;
+    const std::vector<uint8_t> body = makeBody(4 * ReadAheadPipe::kChunkBytes);
+    ReaderThread reader(pipe);
+    BodySource source(body, 1460);
+    OverlapSink sink(source);
+    uint8_t spare[64];
+    TEST_ASSERT_TRUE(pipe.pump(source, sink, spare, sizeof(spare)) == PumpOutcome::Ok);
+    TEST_ASSERT_TRUE(sink.overlapped);
+    TEST_ASSERT_EQUAL(body.size(), sink.bytes);
+}
+
+void test_read_error_ends_the_body_after_its_prefix(void)
+{
+    ReadAheadPipe pipe;
+    const std::vector<uint8_t> body = makeBody(6 * ReadAheadPipe::kChunkBytes);
+    const std::size_t failAt = 3 * ReadAheadPipe::kChunkBytes + 500;
+    const std::vector<uint8_t> prefix(body.begin(), body.begin() + failAt);
+    uint8_t spare[1024];
+    {
+        ReaderThread reader(pipe);
+        BodySource source(body, 1460, failAt);
+        CollectSink sink;
+        TEST_ASSERT_TRUE(pipe.pump(source, sink, spare, sizeof(spare)) ==
+                         PumpOutcome::ReadFailed);
+        TEST_ASSERT_TRUE(sink.body == prefix);
+    }
+    ReadAheadPipe inlinePipe;
+    BodySource source(body, 1460, failAt);
+    CollectSink sink;
+    TEST_ASSERT_TRUE(inlinePipe.pump(source, sink, spare, sizeof(spare)) ==
+                     PumpOutcome::ReadFailed);
+    TEST_ASSERT_TRUE(sink.body == prefix);
+}
+
+void test_failed_send_stops_the_reader(void)
+{
+    ReadAheadPipe pipe;
+    const std::vector<uint8_t> body = makeBody(20 * ReadAheadPipe::kChunkBytes);
+    ReaderThread reader(pipe);
+    BodySource source(body, 1460);
+    CollectSink sink(2);
+    uint8_t spare[64];
+    TEST_ASSERT_TRUE(pipe.pump(source, sink, spare, sizeof(spare)) == PumpOutcome::SendFailed);
+    TEST_ASSERT_EQUAL(2, sink.sends);
+    // The refused chunk plus at most one read ahead of it; nothing after
+    // pump() returned.
+    const std::size_t readBytes = source.pos;
+    TEST_ASSERT_TRUE(readBytes <= 4 * ReadAheadPipe::kChunkBytes);
+    std::this_thread::sleep_for(std::chrono::milliseconds(20));
+    TEST_ASSERT_EQUAL(readBytes, source.pos);
+}
+
+void test_file_source_streams_a_file(void)
+{
+    ReadAheadPipe pipe;
+    const std::vector<uint8_t> body = makeBody(3 * ReadAheadPipe::kChunkBytes + 5);
+    FILE* file = std::tmpfile();
+    TEST_ASSERT_NOT_NULL(file);
+    TEST_ASSERT_EQUAL(body.size(), std::fwrite(body.data(), 1, body.size(), file));
+    std::rewind(file);
+    ReaderThread reader(pipe);
+    FileChunkSource source(file);
+    CollectSink sink;
+    uint8_t spare[64];
+    TEST_ASSERT_TRUE(pipe.pump(source, sink, spare, sizeof(spare)) == PumpOutcome::Ok);
+    TEST_ASSERT_TRUE(sink.body == body);
+    std::fclose(file);
+}
+
+void test_file_source_sends_a_byte_range(void)
+{
+    const std::vector<uint8_t> body = makeBody(3 * ReadAheadPipe::kChunkBytes + 5);
+    FILE* file = std::tmpfile();
+    TEST_ASSERT_NOT_NULL(file);
+    TEST_ASSERT_EQUAL(body.size(), std::fwrite(body.data(), 1, body.size(), file));
+    const std::size_t first = ReadAheadPipe::kChunkBytes + 7;
+    const std::size_t length = ReadAheadPipe::kChunkBytes + 100;
+    TEST_ASSERT_EQUAL(0, std::fseek(file, static_cast<long>(first), SEEK_SET));
+    FileChunkSource source(file, length);
+    CollectSink sink;
+    uint8_t buf[1000];
+    TEST_ASSERT_TRUE(api::copyChunks(source, sink, buf, sizeof(buf)) == PumpOutcome::Ok);
+    TEST_ASSERT_TRUE(sink.body == std::vector<uint8_t>(body.begin() + first,
+                                                      body.begin() + first + length));
+    std::fclose(file);
+}
+
+}  // namespace
+
+void run_read_ahead_tests(void)
+{
+    RUN_TEST(test_threaded_pump_sends_the_body_in_chunks);
+    RUN_TEST(test_pump_without_a_reader_copies_inline);
+    RUN_TEST(test_reader_fills_the_next_buffer_during_a_send);
+    RUN_TEST(test_read_error_ends_the_body_after_its_prefix);
+    RUN_TEST(test_failed_send_stops_the_reader);
+    RUN_TEST(test_file_source_streams_a_file);
+    RUN_TEST(test_file_source_sends_a_byte_range);
+}
@@ -0,0 +1,126 @@
+// SPDX-FileCopyrightText: 2026 Cryptotomte
+// SPDX-License-Identifier: AGPL-3.0-or-later
+/**
+ * @file test_record_reduce.cpp
+ * @brief Host suite for the chunk reduction kernel (storage/RecordReduce.h).
+ *
+ * Registered by test_main.cpp via run_record_reduce_tests(). The lane
+ * kernel agrees with the one-record reference on every count (short
+ * chunks, ragged tails), on out-of-order epochs and on ties for the
+ * newest epoch, and continues a reduction already holding records.
+ */
+
+#include <cmath>
+#include <cstdint>
+#include <cstring>
+#include <vector>
+
+#include "unity.h"
+
+#include "storage/RecordReduce.h"
+
+namespace {
+
+using recordreduce::Reduction;
+
+void putRecord(std::vector<uint8_t>& bytes, uint32_t epoch, float value)
+{
+    uint32_t bits = 0;
+    std::memcpy(&bits, &value, sizeof(bits));
+    for (int shift = 0; shift < 32; shift += 8) {
+        bytes.push_back(static_cast<uint8_t>(epoch >> shift));
+    }
+    for (int shift = 0; shift < 32; shift += 8) {
+        bytes.push_back(static_cast<uint8_t>(bits >> shift));
+    }
+}
+
+void assertSame(const Reduction& want, const Reduction& got)
+{
+    TEST_ASSERT_EQUAL_UINT32(want.count, got.count);
+    TEST_ASSERT_EQUAL_UINT32(want.minEpoch, got.minEpoch);
+    TEST_ASSERT_EQUAL_UINT32(want.maxEpoch, got.maxEpoch);
+    TEST_ASSERT_EQUAL_FLOAT(want.min, got.min);
+    TEST_ASSERT_EQUAL_FLOAT(want.max, got.max);
+    TEST_ASSERT_EQUAL_FLOAT(want.last, got.last);
+    TEST_ASSERT_TRUE(std::fabs(want.sum - got.sum) <= 1e-9 * (1.0 + std::fabs(want.sum)));
+}
+
+void test_kernel_matches_scalar_for_every_count(void)
+{
+    std::vector<uint8_t> bytes;
+    uint32_t seed = 12345;
+    for (uint32_t i = 0; i < 1024; ++i) {
+        seed = seed * 1103515245u + 12345u;
+        putRecord(bytes, 1'700'000'000u + i * 300, static_cast<float>(seed % 10007) / 97.0f - 40.0f);
+    }
+    const std::size_t counts[] = {0, 1, 3, 4, 5, 7, 64, 1021, 1024};
+    for (std::size_t count : counts) {
+        Reduction want;
+        Reduction got;
+        recordreduce::reduceScalar(bytes.data(), count, want);
+        recordreduce::reduce(bytes.data(), count, got);
+        assertSame(want, got);
+    }
+}
+
+void test_kernel_keeps_out_of_order_epochs_and_later_tie(void)
+{
+    // The newest epoch (900) appears three times; the last of them, in a
+    // different lane from the first, gives `last`. The oldest is not first.
+    std::vector<uint8_t> bytes;
+    putRecord(bytes, 500, 1.0f);
+    putRecord(bytes, 900, 2.0f);
+    putRecord(bytes, 100, 3.0f);
+    putRecord(bytes, 700, -4.0f);
+    putRecord(bytes, 900, 5.0f);
+    putRecord(bytes, 300, 6.0f);
+    putRecord(bytes, 900, 7.0f);
+    putRecord(bytes, 200, 8.0f);
+    putRecord(bytes, 600, 0.5f);
+
+    Reduction want;
+    Reduction got;
+    recordreduce::reduceScalar(bytes.data(), 9, want);
+    recordreduce::reduce(bytes.data(), 9, got);
+    assertSame(want, got);
+    TEST_ASSERT_EQUAL_UINT32(100, got.minEpoch);
+    TEST_ASSERT_EQUAL_UINT32(900, got.maxEpoch);
+    TEST_ASSERT_EQUAL_FLOAT(7.0f, got.last);
+    TEST_ASSERT_EQUAL_FLOAT(-4.0f, got.min);
+    TEST_ASSERT_EQUAL_FLOAT(8.0f, got.max);
+    TEST_ASSERT_TRUE(got.sum == 28.5);
+}
+
+void test_kernel_continues_a_running_reduction(void)
+{
+    std::vector<uint8_t> bytes;
+    for (uint32_t i = 0; i < 10; ++i) {
+        putRecord(bytes, 1000 + i, static_cast<float>(i));
+    }
+    Reduction want;
+    recordreduce::reduceScalar(bytes.data(), 10, want);
+
+    // Two records first, one at a time; a tie on the newest epoch in the
+    // later block wins over the earlier record.
+    Reduction got;
+    got.add(1009, 99.0f);
+    got.add(2, -1.0f);
+    recordreduce::reduce(bytes.data(), 10, got);
+    TEST_ASSERT_EQUAL_UINT32(12, got.count);
+    TEST_ASSERT_EQUAL_UINT32(2, got.minEpoch);
+    TEST_ASSERT_EQUAL_UINT32(1009, got.maxEpoch);
+    TEST_ASSERT_EQUAL_FLOAT(9.0f, got.last);
+    TEST_ASSERT_EQUAL_FLOAT(-1.0f, got.min);
+    TEST_ASSERT_EQUAL_FLOAT(99.0f, got.max);
+    TEST_ASSERT_TRUE(got.sum == want.sum + 98.0);
+}
+
+}  // namespace
+
+void run_record_reduce_tests(void)
+{
+    RUN_TEST(test_kernel_matches_scalar_for_every_count);
+    RUN_TEST(test_kernel_keeps_out_of_order_epochs_and_later_tie);
+    RUN_TEST(test_kernel_continues_a_running_reduction);
+}
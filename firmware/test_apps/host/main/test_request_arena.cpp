@@ -0,0 +1,143 @@
+// SPDX-FileCopyrightText: 2026 Cryptotomte
+// SPDX-License-Identifier: AGPL-3.0-or-later
+/**
+ * @file test_request_arena.cpp
+ * @brief Host suite for the per-request cJSON arena (RequestArena.h).
+ *
+ * Allocations are aligned bumps that reset() reclaims while the high-water
+ * mark stays; a request that does not fit falls back (nullptr from the
+ * arena, a counted heap block through the hooks); under an ArenaScope a
+ * cJSON parse/print lands in the arena and the scope's close empties it;
+ * outside any scope the hooks are plain heap.
+ */
+
+#include <cstddef>
+#include <cstdint>
+#include <cstdlib>
+
+#include "unity.h"
+
+#include "cJSON.h"
+
+#include "api/RequestArena.h"
+
+namespace {
+
+void test_bump_alignment_reset_and_high_water()
+{
+    api::RequestArena arena(256);
+    TEST_ASSERT_EQUAL_UINT32(256, arena.capacity());
+
+    void* a = arena.allocate(3);
+    void* b = arena.allocate(10);
+    TEST_ASSERT_NOT_NULL(a);
+    TEST_ASSERT_NOT_NULL(b);
+    TEST_ASSERT_TRUE(arena.owns(a));
+    TEST_ASSERT_TRUE(arena.owns(b));
+    TEST_ASSERT_EQUAL_UINT32(0, reinterpret_cast<std::uintptr_t>(b) % alignof(std::max_align_t));
+    TEST_ASSERT_TRUE(static_cast<unsigned char*>(b) - static_cast<unsigned char*>(a) >= 3);
+
+    const std::size_t used = arena.used();
+    arena.reset();
+    TEST_ASSERT_EQUAL_UINT32(0, arena.used());
+    TEST_ASSERT_EQUAL_UINT32(used, arena.highWater());
+    TEST_ASSERT_TRUE(arena.allocate(1) == a);
+
+    int onStack = 0;
+    TEST_ASSERT_FALSE(arena.owns(&onStack));
+}
+
+void test_oversized_request_does_not_fit()
+{
+    api::RequestArena arena(64);
+    TEST_ASSERT_NULL(arena.allocate(65));
+    TEST_ASSERT_NOT_NULL(arena.allocate(48));
+    TEST_ASSERT_NULL(arena.allocate(32));
+    TEST_ASSERT_NULL(arena.allocate(SIZE_MAX));
+    TEST_ASSERT_EQUAL_UINT32(0, arena.fallbacks());  // counted by the hooks only
+}
+
+void test_cjson_lives_in_the_scope()
+{
+    api::installArenaHooks();
+    api::RequestArena arena(4096);
+    {
+        api::ArenaScope scope(&arena);
+        cJSON* root = cJSON_Parse("{\"pump\":1,\"state\":\"idle\",\"flow\":[1,2,3]}");
+        TEST_ASSERT_NOT_NULL(root);
+        TEST_ASSERT_TRUE(arena.owns(root));
+        char* text = cJSON_PrintUnformatted(root);
+        TEST_ASSERT_NOT_NULL(text);
+        TEST_ASSERT_TRUE(arena.owns(text));
+        TEST_ASSERT_EQUAL_STRING("{\"pump\":1,\"state\":\"idle\",\"flow\":[1,2,3]}", text);
+        cJSON_free(text);
+        cJSON_Delete(root);
+        TEST_ASSERT_TRUE(arena.used() > 0);  // frees are deferred to the close
+    }
+    TEST_ASSERT_EQUAL_UINT32(0, arena.used());
+    TEST_ASSERT_TRUE(arena.highWater() > 0);
+    TEST_ASSERT_EQUAL_UINT32(0, arena.fallbacks());
+    cJSON_InitHooks(nullptr);
+}
+
+void test_full_arena_falls_back_to_the_heap()
+{
+    api::installArenaHooks();
+    api::RequestArena arena(16);
+    {
+        api::ArenaScope scope(&arena);
+        cJSON* root = cJSON_CreateObject();
+        cJSON_AddStringToObject(root, "message", "longer than the sixteen byte arena");
+        char* text = cJSON_PrintUnformatted(root);
+        TEST_ASSERT_NOT_NULL(text);
+        TEST_ASSERT_FALSE(arena.owns(text));
+        cJSON_free(text);
+        cJSON_Delete(root);
+    }
+    TEST_ASSERT_TRUE(arena.fallbacks() > 0);
+    cJSON_InitHooks(nullptr);
+}
+
+void test_scopes_nest_and_null_keeps_the_heap()
+{
+    api::installArenaHooks();
+    api::RequestArena outer(1024);
+    api::RequestArena inner(1024);
+    {
+        api::ArenaScope a(&outer);
+        cJSON* first = cJSON_CreateNull();
+        TEST_ASSERT_TRUE(outer.owns(first));
+        {
+            api::ArenaScope b(&inner);
+            cJSON* second = cJSON_CreateNull();
+            TEST_ASSERT_TRUE(inner.owns(second));
+            cJSON_Delete(second);
+        }
+        TEST_ASSERT_EQUAL_UINT32(0, inner.used());
+        TEST_ASSERT_TRUE(outer.used() > 0);
+        {
+            api::ArenaScope none(nullptr);
+            cJSON* third = cJSON_CreateNull();
+            TEST_ASSERT_TRUE(outer.owns(third));  // still the enclosing arena
+            cJSON_Delete(third);
+        }
+        cJSON_Delete(first);
+    }
+    TEST_ASSERT_EQUAL_UINT32(0, outer.used());
+
+    cJSON* heap = cJSON_CreateNull();
+    TEST_ASSERT_FALSE(outer.owns(heap));
+    cJSON_Delete(heap);
+    cJSON_InitHooks(nullptr);
+}
+
+}  // namespace
+
+void run_request_arena_tests(void)
+{
+    RUN_TEST(test_bump_alignment_reset_and_high_water);
+    RUN_TEST(test_oversized_request_does_not_fit);
+    RUN_TEST(test_cjson_lives_in_the_scope);
+    RUN_TEST(test_full_arena_falls_back_to_the_heap);
+    RUN_TEST(test_scopes_nest_and_null_keeps_the_heap);
+}
@@ -13,11 +13,15 @@
  * Coverage maps to tasks.md T009 (SC-004): all five level truth-table rows
  * (either/both invalid -> no action; wet/wet full ensure-stopped; wet/dry
  * sufficient -> no action; dry/dry -> start fill; dry/wet implausible -> no
- * action), stop-on-high-wet while running, the max-fill abort at the 300 s cap
+ * action), stop-on-high-wet while running (also from the high mark's own
+ * update() through the observer hook; also over the concrete types of the
+ * static-dispatch wiring), the max-fill abort at the 300 s cap
  * (StopReason::MaxRuntimeForced), the post-abort cooldown (blocks then allows a
  * new auto fill; a normal high-wet stop does not arm it; a manual fill bypasses
- * it), the manual-fill refusal when already full, and the feature gate
- * (disabled -> pump forced off + all logic skipped).
+ * it), the manual-fill refusal when already full, the feature gate
+ * (disabled -> pump forced off + all logic skipped), and the adaptive fill
+ * timeout (legs learnt and logged; a stalled leg fails safe and arms the
+ * cooldown; nothing early before the estimator has learnt).
  */
 
 #include <cstdint>
@@ -26,8 +30,11 @@
 
 #include "actuators/testing/FakeTimeProvider.h"
 #include "actuators/testing/MockWaterPump.h"
+#include "control/FillTimeEstimator.h"
 #include "control/ReservoirController.h"
 #include "events/EventLogger.h"
+#include "interfaces/IDigitalInput.h"
+#include "sensors/DebouncedLevelSensor.h"
 #include "sensors/testing/MockLevelSensor.h"
 #include "storage/testing/MockDataStorage.h"
 #include "time/testing/FakeWallClock.h"
@@ -176,6 +183,83 @@ void test_stop_on_high_wet_while_running(void)
                           static_cast<int>(f.pump.getLastStopReason()));
 }
 
+// The static-dispatch instantiation (over concrete types, as app_main wires
+// it with WS_STATIC_DISPATCH) runs the same state machine.
+void test_concrete_instantiation_fills_and_stops(void)
+{
+    FakeTimeProvider clock;
+    MockLevelSensor low;
+    MockLevelSensor high;
+    MockWaterPump pump{"reservoir", clock};
+    MockDataStorage storage;
+    FakeWallClock wallClock;
+    EventLogger events{storage, wallClock};
+    TEST_ASSERT_TRUE(pump.initialize());
+    BasicReservoirController<MockLevelSensor, MockWaterPump> controller{
+        low, high, pump, clock, events};
+
+    low.scriptValidState(false);
+    high.scriptValidState(false);
+    controller.tick(true, true);
+    TEST_ASSERT_TRUE(pump.isRunning());
+
+    clock.advance(5000);
+    high.scriptValidState(true);
+    controller.tick(true, true);
+    TEST_ASSERT_FALSE(pump.isRunning());
+    TEST_ASSERT_EQUAL_INT(static_cast<int>(StopReason::Commanded),
+                          static_cast<int>(pump.getLastStopReason()));
+}
+
+// The high mark's own update() stops the fill through the observer hook,
+// with no controller tick in between.
+void test_high_mark_update_stops_fill_without_tick(void)
+{
+    struct PinInput : IDigitalInput {
+        bool level = false;
+        bool read() override { return level; }
+    };
+    FakeTimeProvider clock;
+    PinInput pin;
+    DebouncedLevelSensor high(pin, clock, /*activeLow=*/false,
+                              /*debounceMs=*/300, /*settleMs=*/0);
+    MockLevelSensor low;
+    MockWaterPump pump{"reservoir", clock};
+    TEST_ASSERT_TRUE(pump.initialize());
+    MockDataStorage storage;
+    FakeWallClock wallClock;
+    EventLogger events{storage, wallClock};
+    ReservoirController controller{low, high, pump, clock, events};
+    high.setObserver(&controller);
+
+    high.update();
+    clock.advance(300);
+    high.update();  // valid, dry
+    low.scriptValidState(false);
+    controller.tick(true, true);  // dry/dry -> start fill
+    TEST_ASSERT_TRUE(pump.isRunning());
+
+    // Wet: the pump runs through the debounce window, stops in the update
+    // that completes it.
+    pin.level = true;
+    high.update();
+    clock.advance(299);
+    high.update();
+    TEST_ASSERT_TRUE(pump.isRunning());
+    clock.advance(1);
+    high.update();
+    TEST_ASSERT_FALSE(pump.isRunning());
+    TEST_ASSERT_EQUAL_INT(static_cast<int>(StopReason::Commanded),
+                          static_cast<int>(pump.getLastStopReason()));
+
+    // Turning dry again starts nothing by itself; tick() owns that.
+    pin.level = false;
+    high.update();
+    clock.advance(300);
+    high.update();
+    TEST_ASSERT_FALSE(pump.isRunning());
+}
+
 // The fill aborts at the hard 300 s max-fill cap when the high mark never trips
 // (the pump self-stops in update() with StopReason::MaxRuntimeForced).
 void test_max_fill_abort_at_cap(void)
@@ -338,6 +422,114 @@ void test_feature_disabled_forces_off_and_skips_logic(void)
     TEST_ASSERT_EQUAL_INT(1, onTransitions(f.pump));
 }
 
+// ===========================================================================
+// Adaptive fill timeout (FillTimeEstimator)
+// ===========================================================================
+
+/// One automatic fill from dry/dry: the low mark turns wet after @p toLowMs,
+/// the high mark @p betweenMs later (a tick at each).
+void completeFill(Fixture& f, int64_t toLowMs, int64_t betweenMs)
+{
+    f.low.scriptValidState(false);
+    f.high.scriptValidState(false);
+    f.controller.tick(true, true);
+    TEST_ASSERT_TRUE(f.pump.isRunning());
+    f.clock.advance(toLowMs);
+    f.low.scriptValidState(true);
+    f.controller.tick(true, true);
+    f.clock.advance(betweenMs);
+    f.high.scriptValidState(true);
+    f.controller.tick(true, true);
+    TEST_ASSERT_FALSE(f.pump.isRunning());
+}
+
+/// Count of the events of @p category.
+int eventCount(const MockDataStorage& storage, uint8_t category)
+{
+    int count = 0;
+    for (const auto& event : storage.events) {
+        count += event.category == category ? 1 : 0;
+    }
+    return count;
+}
+
+// Two fills teach the legs (logged between the marks); a third whose inflow
+// collapses between the marks stops at 1.5x the learnt leg, logs the
+// fail-safe and arms the refill cooldown.
+void test_fill_learnt_then_stalled_fill_aborted(void)
+{
+    Fixture f;
+    f.wallClock.setEpoch(1'700'000'000);
+    FillTimeEstimator estimator;
+    f.controller.setFillEstimator(estimator);
+    f.controller.setFillLog(f.storage, f.wallClock);
+
+    completeFill(f, 10'000, 60'000);
+    TEST_ASSERT_FALSE(estimator.learnt());
+    completeFill(f, 10'000, 60'000);
+    TEST_ASSERT_TRUE(estimator.learnt());
+    TEST_ASSERT_EQUAL_INT(60'000, static_cast<int>(estimator.expectedBetweenMarksMs()));
+    const auto logged = f.storage.getSensorReadings(
+        ReservoirController::kFillTimeMetric, 0, UINT32_MAX);
+    TEST_ASSERT_EQUAL_INT(2, static_cast<int>(logged.size()));
+    TEST_ASSERT_FLOAT_WITHIN(1e-3f, 60.0f, logged[1].value);
+
+    f.low.scriptValidState(false);
+    f.high.scriptValidState(false);
+    f.controller.tick(true, true);
+    f.clock.advance(10'000);
+    f.low.scriptValidState(true);
+    f.controller.tick(true, true);
+    f.clock.advance(90'000);
+    f.controller.tick(true, true);  // at the budget: still running
+    TEST_ASSERT_TRUE(f.pump.isRunning());
+    f.clock.advance(5'000);
+    f.controller.tick(true, true);
+    TEST_ASSERT_FALSE(f.pump.isRunning());
+    TEST_ASSERT_EQUAL_INT(1, eventCount(f.storage, IDataStorage::kCategoryFailsafe));
+
+    // The cooldown holds a dry/dry refill back like after a cap abort.
+    f.low.scriptValidState(false);
+    f.clock.advance(1'000);
+    f.controller.tick(true, true);
+    TEST_ASSERT_FALSE(f.pump.isRunning());
+    f.clock.advance(ReservoirController::kReservoirRefillCooldownMs);
+    f.controller.tick(true, true);
+    TEST_ASSERT_TRUE(f.pump.isRunning());
+}
+
+// The leg to the low mark has its own budget (floored at 20 s); before the
+// estimator has learnt, only the 300 s cap applies.
+void test_fill_stalled_before_low_mark(void)
+{
+    Fixture f;
+    FillTimeEstimator estimator;
+    f.controller.setFillEstimator(estimator);
+
+    f.low.scriptValidState(false);
+    f.high.scriptValidState(false);
+    f.controller.tick(true, true);
+    f.clock.advance(120'000);
+    f.controller.tick(true, true);  // unlearnt: no early stop
+    TEST_ASSERT_TRUE(f.pump.isRunning());
+    f.controller.stop();  // an operator stop is not learnt
+    f.controller.tick(true, true);
+    TEST_ASSERT_EQUAL_UINT32(0, estimator.fills());
+
+    completeFill(f, 5'000, 30'000);
+    completeFill(f, 5'000, 30'000);
+    TEST_ASSERT_TRUE(estimator.learnt());
+    TEST_ASSERT_EQUAL_INT(FillTimeEstimator::kMinBudgetMs,
+                          static_cast<int>(estimator.budgetToLowMs()));
+
+    f.low.scriptValidState(false);
+    f.high.scriptValidState(false);
+    f.controller.tick(true, true);
+    f.clock.advance(FillTimeEstimator::kMinBudgetMs + 1);
+    f.controller.tick(true, true);
+    TEST_ASSERT_FALSE(f.pump.isRunning());
+}
+
 }  // namespace
 
 void run_reservoir_tests(void)
@@ -353,6 +545,8 @@ void run_reservoir_tests(void)
 
     // Running safety
     RUN_TEST(test_stop_on_high_wet_while_running);
+    RUN_TEST(test_concrete_instantiation_fills_and_stops);
+    RUN_TEST(test_high_mark_update_stops_fill_without_tick);
     RUN_TEST(test_max_fill_abort_at_cap);
 
     // Post-abort cooldown (FR-012a)
@@ -364,4 +558,8 @@ void run_reservoir_tests(void)
     RUN_TEST(test_manual_fill_refused_when_full);
     RUN_TEST(test_auto_level_off_suppresses_fill_but_manual_works);
     RUN_TEST(test_feature_disabled_forces_off_and_skips_logic);
+
+    // Adaptive fill timeout
+    RUN_TEST(test_fill_learnt_then_stalled_fill_aborted);
+    RUN_TEST(test_fill_stalled_before_low_mark);
 }
@@ -0,0 +1,97 @@
+// SPDX-FileCopyrightText: 2026 Cryptotomte
+// SPDX-License-Identifier: AGPL-3.0-or-later
+/**
+ * @file test_response_cache.cpp
+ * @brief Host suite for the hot-endpoint body cache (ResponseCache.h).
+ *
+ * A stored body is served back byte for byte with its ETag while its
+ * generation holds and its max age has not passed; a moved generation, an
+ * expired age, a clock step backwards or an invalidate() is a miss; slots
+ * are independent; an empty body is never cached.
+ */
+
+#include <string>
+
+#include "unity.h"
+
+#include "api/ResponseCache.h"
+
+namespace {
+
+using Slot = api::ResponseCache::Slot;
+
+void test_hit_returns_the_stored_bytes()
+{
+    api::ResponseCache cache;
+    std::string body = "untouched";
+    std::string etag = "untouched";
+    TEST_ASSERT_FALSE(cache.get(Slot::Sensors, 0, 100, body, etag));
+    TEST_ASSERT_EQUAL_STRING("untouched", body.c_str());
+
+    cache.put(Slot::Sensors, 0, 100, "{\"success\":true}", "W/\"00000001\"");
+    TEST_ASSERT_TRUE(cache.get(Slot::Sensors, 0, 100000, body, etag));
+    TEST_ASSERT_EQUAL_STRING("{\"success\":true}", body.c_str());
+    TEST_ASSERT_EQUAL_STRING("W/\"00000001\"", etag.c_str());
+    TEST_ASSERT_EQUAL_UINT32(1, cache.hits());
+    TEST_ASSERT_EQUAL_UINT32(1, cache.misses());
+}
+
+void test_generation_change_misses()
+{
+    api::ResponseCache cache;
+    cache.put(Slot::Config, 7, 0, "gen7", "");
+    std::string body;
+    std::string etag;
+    TEST_ASSERT_TRUE(cache.get(Slot::Config, 7, 0, body, etag));
+    TEST_ASSERT_FALSE(cache.get(Slot::Config, 8, 0, body, etag));
+    TEST_ASSERT_EQUAL_STRING("gen7", body.c_str());
+
+    cache.put(Slot::Config, 8, 0, "gen8", "");
+    TEST_ASSERT_TRUE(cache.get(Slot::Config, 8, 0, body, etag));
+    TEST_ASSERT_EQUAL_STRING("gen8", body.c_str());
+}
+
+void test_max_age_expires_entries()
+{
+    api::ResponseCache cache;
+    cache.setMaxAge(Slot::Status, 1000);
+    cache.put(Slot::Status, 3, 5000, "status", "");
+    std::string body;
+    std::string etag;
+    TEST_ASSERT_TRUE(cache.get(Slot::Status, 3, 6000, body, etag));   // at the limit
+    TEST_ASSERT_FALSE(cache.get(Slot::Status, 3, 6001, body, etag));  // past it
+    TEST_ASSERT_FALSE(cache.get(Slot::Status, 3, 4999, body, etag));  // clock went back
+}
+
+void test_slots_are_independent_and_invalidate()
+{
+    api::ResponseCache cache;
+    cache.put(Slot::Status, 0, 0, "status", "");
+    cache.put(Slot::Config, 0, 0, "config", "");
+    cache.invalidate(Slot::Status);
+    std::string body;
+    std::string etag;
+    TEST_ASSERT_FALSE(cache.get(Slot::Status, 0, 0, body, etag));
+    TEST_ASSERT_TRUE(cache.get(Slot::Config, 0, 0, body, etag));
+    TEST_ASSERT_EQUAL_STRING("config", body.c_str());
+}
+
+void test_empty_body_is_not_cached()
+{
+    api::ResponseCache cache;
+    cache.put(Slot::Sensors, 0, 0, "", "W/\"x\"");
+    std::string body;
+    std::string etag;
+    TEST_ASSERT_FALSE(cache.get(Slot::Sensors, 0, 0, body, etag));
+}
+
+}  // namespace
+
+void run_response_cache_tests(void)
+{
+    RUN_TEST(test_hit_returns_the_stored_bytes);
+    RUN_TEST(test_generation_change_misses);
+    RUN_TEST(test_max_age_expires_entries);
+    RUN_TEST(test_slots_are_independent_and_invalidate);
+    RUN_TEST(test_empty_body_is_not_cached);
+}
@@ -0,0 +1,346 @@
+// SPDX-FileCopyrightText: 2026 Cryptotomte
+// SPDX-License-Identifier: AGPL-3.0-or-later
+/**
+ * @file test_ring_log_storage.cpp
+ * @brief Host tests for RingLogDataStorage (linux preview target).
+ *
+ * The ring log runs over RamFlashPartition, which enforces NOR semantics
+ * (erase to 0xFF, writes only clear bits) and can cut power mid-write, so
+ * the recovery rules are exercised against the byte patterns the chip
+ * would leave. Coverage: the IDataStorage contract the ring log keeps,
+ * boot recovery, eviction and retention bounds, torn writes, both read
+ * paths (mapped and copied), the bytes programmed per append and the
+ * write counters reported through getStorageStats().
+ */
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include "unity.h"
+
+#include "interfaces/IDataStorage.h"
+#include "interfaces/MetricRegistry.h"
+#include "storage/RingLogDataStorage.h"
+#include "storage/testing/RamFlashPartition.h"
+
+namespace {
+
+/// Default data-log interval in seconds (data-model.md: 300000 ms).
+constexpr uint32_t kLogIntervalS = 300;
+
+/// The `ringlog` partition of partitions_ringlog.csv (0x80000).
+constexpr std::size_t kPartitionSectors = 128;
+
+/// A small partition: the event ring plus four history sectors.
+constexpr std::size_t kSmallSectors = RingLogDataStorage::kEventSectors + 4;
+
+/// Metrics of a one-probe logging pass (no per-probe moisture ids).
+constexpr std::size_t kTickMetrics = metric::kSoilMoisture2;
+
+/// One full logging pass: every one-probe metric at `epoch`, value = tick.
+std::size_t logTick(RingLogDataStorage& storage, uint32_t epoch, float tick)
+{
+    MetricSample batch[kTickMetrics];
+    for (std::size_t id = 0; id < kTickMetrics; ++id) {
+        batch[id] = MetricSample{static_cast<MetricId>(id), epoch,
+                                 tick + static_cast<float>(id)};
+    }
+    return storage.storeSamples(batch, kTickMetrics);
+}
+
+/// Append `count` ticks from `firstEpoch`; asserts once on the total.
+void logTicks(RingLogDataStorage& storage, uint32_t firstEpoch, std::size_t count)
+{
+    std::size_t stored = 0;
+    for (std::size_t i = 0; i < count; ++i) {
+        stored += logTick(storage, firstEpoch + static_cast<uint32_t>(i) * kLogIntervalS,
+                          static_cast<float>(i));
+    }
+    TEST_ASSERT_EQUAL_size_t(count * kTickMetrics, stored);
+}
+
+void assertSameEvents(const std::vector<EventRecord>& expected,
+                      const std::vector<EventRecord>& actual)
+{
+    TEST_ASSERT_EQUAL_size_t(expected.size(), actual.size());
+    for (std::size_t i = 0; i < expected.size(); ++i) {
+        TEST_ASSERT_EQUAL_UINT32(expected[i].epoch, actual[i].epoch);
+        TEST_ASSERT_EQUAL_UINT8(expected[i].category, actual[i].category);
+        TEST_ASSERT_EQUAL_STRING(expected[i].detail.c_str(), actual[i].detail.c_str());
+    }
+}
+
+void test_ring_log_round_trip(void)
+{
+    RamFlashPartition flash(kSmallSectors);
+    RingLogDataStorage storage(flash);
+
+    TEST_ASSERT_TRUE(storage.storeSensorReading("soil_moisture", 100, 41.5f));
+    TEST_ASSERT_TRUE(storage.storeSensorReading("soil_moisture", 200, 42.5f));
+    TEST_ASSERT_TRUE(storage.storeSensorReading("env_humidity", 200, 55.0f));
+    const SensorReading batch[] = {{"soil_moisture", 300, 43.5f},
+                                   {"soil_ph", 300, 6.4f},
+                                   {"bench_probe", 300, 1.0f}};
+    // The ring log stores the known metric table only (no name table on
+    // flash): a name outside it is rejected on its own.
+    TEST_ASSERT_EQUAL_size_t(2, storage.storeSensorReadings(batch, 3));
+    TEST_ASSERT_FALSE(storage.storeSensorReading("bench_probe", 400, 1.0f));
+
+    const std::vector<SensorReading> moisture =
+        storage.getSensorReadings("soil_moisture", 150, 300);
+    TEST_ASSERT_EQUAL_size_t(2, moisture.size());
+    TEST_ASSERT_EQUAL_UINT32(200, moisture[0].epoch);
+    TEST_ASSERT_EQUAL_FLOAT(42.5f, moisture[0].value);
+    TEST_ASSERT_EQUAL_STRING("soil_moisture", moisture[1].metric.c_str());
+    TEST_ASSERT_EQUAL_FLOAT(43.5f, moisture[1].value);
+    TEST_ASSERT_EQUAL_size_t(1, storage.getSensorReadings("soil_ph", 0, 1000).size());
+    TEST_ASSERT_TRUE(storage.getSensorReadings("soil_moisture", 300, 200).empty());
+    TEST_ASSERT_TRUE(storage.getSensorReadings("bench_probe", 0, 1000).empty());
+
+    // Events: newest first, over-long detail truncated, never rejected.
+    TEST_ASSERT_TRUE(storage.storeEvent(10, IDataStorage::kCategoryPump, "start"));
+    TEST_ASSERT_TRUE(storage.storeEvent(11, IDataStorage::kCategoryReset,
+                                        std::string(200, 'x')));
+    const std::vector<EventRecord> events = storage.getEvents(10);
+    TEST_ASSERT_EQUAL_size_t(2, events.size());
+    TEST_ASSERT_EQUAL_UINT32(11, events[0].epoch);
+    TEST_ASSERT_EQUAL_size_t(IDataStorage::kEventDetailMaxLen, events[0].detail.size());
+    TEST_ASSERT_EQUAL_STRING("start", events[1].detail.c_str());
+    TEST_ASSERT_EQUAL_size_t(1, storage.getEvents(1).size());
+
+    const StorageStats stats = storage.getStorageStats();
+    TEST_ASSERT_EQUAL_UINT32(kSmallSectors * IFlashPartition::kSectorBytes,
+                             stats.totalBytes);
+    TEST_ASSERT_TRUE(stats.usedBytes > 0 && stats.usedBytes < 512);
+}
+
+void test_ring_log_recovers_state_at_boot(void)
+{
+    RamFlashPartition flash(kSmallSectors);
+    {
+        RingLogDataStorage storage(flash);
+        logTicks(storage, 1000, 300);  // spans several history sectors
+        for (uint32_t i = 0; i < 600; ++i) {
+            TEST_ASSERT_TRUE(storage.storeEvent(1000 + i, IDataStorage::kCategoryPump,
+                                                "event " + std::to_string(i)));
+        }
+    }
+    RingLogDataStorage before(flash);
+    const std::vector<SensorReading> history = before.getSensorReadings("soil_ec", 0, UINT32_MAX);
+    const std::vector<EventRecord> events = before.getEvents(SIZE_MAX);
+    TEST_ASSERT_TRUE(history.size() > 0);
+    TEST_ASSERT_TRUE(events.size() > 0);
+    TEST_ASSERT_EQUAL_STRING("event 599", events.front().detail.c_str());
+
+    // A reboot (a fresh instance on the same flash, this time through
+    // read() copies) answers identically and appends after the old head.
+    flash.mapping = false;
+    {
+        RingLogDataStorage rebooted(flash);
+        TEST_ASSERT_EQUAL_size_t(history.size(),
+                                 rebooted.getSensorReadings("soil_ec", 0, UINT32_MAX).size());
+        assertSameEvents(events, rebooted.getEvents(SIZE_MAX));
+        TEST_ASSERT_TRUE(rebooted.storeEvent(5000, IDataStorage::kCategoryOta, "after"));
+        logTick(rebooted, 1000 + 300 * kLogIntervalS, 300.0f);
+    }
+    RingLogDataStorage again(flash);
+    TEST_ASSERT_EQUAL_STRING("after", again.getEvents(1).front().detail.c_str());
+    const std::vector<SensorReading> latest =
+        again.getSensorReadings("soil_ec", 1000 + 300 * kLogIntervalS, UINT32_MAX);
+    TEST_ASSERT_EQUAL_size_t(1, latest.size());
+    TEST_ASSERT_EQUAL_FLOAT(300.0f + metric::kSoilEc, latest[0].value);
+}
+
+void test_ring_log_evicts_oldest_and_keeps_30_days(void)
+{
+    RamFlashPartition flash(kPartitionSectors);
+    RingLogDataStorage storage(flash);
+
+    // 40 days of full ticks into the production-size partition.
+    constexpr std::size_t kTicksPerDay = 86400 / kLogIntervalS;
+    constexpr std::size_t kTicks = 40 * kTicksPerDay;
+    logTicks(storage, 0, kTicks);
+
+    const std::vector<SensorReading> kept =
+        storage.getSensorReadings("soil_potassium", 0, UINT32_MAX);
+    TEST_ASSERT_TRUE(kept.size() >= 30 * kTicksPerDay);
+    TEST_ASSERT_TRUE(kept.size() < kTicks);
+    // Oldest-first eviction: what is left is the newest, contiguous run.
+    TEST_ASSERT_EQUAL_UINT32((kTicks - 1) * kLogIntervalS, kept.back().epoch);
+    for (std::size_t i = 1; i < kept.size(); ++i) {
+        TEST_ASSERT_EQUAL_UINT32(kept[i - 1].epoch + kLogIntervalS, kept[i].epoch);
+    }
+    const StorageStats stats = storage.getStorageStats();
+    TEST_ASSERT_TRUE(stats.usedBytes <= stats.totalBytes);
+
+    // The event ring is bounded separately: a history flood never evicts
+    // events, and an event flood keeps the newest.
+    RamFlashPartition small(kSmallSectors);
+    RingLogDataStorage events(small);
+    for (uint32_t i = 0; i < 5000; ++i) {
+        TEST_ASSERT_TRUE(events.storeEvent(i, IDataStorage::kCategoryPump,
+                                           "pump run " + std::to_string(i)));
+    }
+    logTicks(events, 0, 2000);
+    const std::vector<EventRecord> newest = events.getEvents(SIZE_MAX);
+    TEST_ASSERT_TRUE(newest.size() > 1000 && newest.size() < 5000);
+    TEST_ASSERT_EQUAL_UINT32(4999, newest.front().epoch);
+    TEST_ASSERT_EQUAL_UINT32(5000 - newest.size(), newest.back().epoch);
+}
+
+void test_ring_log_survives_torn_writes(void)
+{
+    RamFlashPartition flash(kSmallSectors);
+    {
+        RingLogDataStorage storage(flash);
+        logTicks(storage, 0, 20);
+        TEST_ASSERT_TRUE(storage.storeEvent(1, IDataStorage::kCategoryPump, "kept"));
+        // Power cut three bytes into the next frame of each ring.
+        flash.tearAfterBytes = 3;
+        TEST_ASSERT_EQUAL_size_t(0, logTick(storage, 20 * kLogIntervalS, 20.0f));
+        flash.tearAfterBytes = 3;
+        TEST_ASSERT_FALSE(storage.storeEvent(2, IDataStorage::kCategoryPump, "torn"));
+        flash.tearAfterBytes = -1;
+    }
+
+    // The torn frames fail their CRC: the valid prefix survives and the
+    // damaged head sectors are sealed, so appends resume in fresh sectors.
+    RingLogDataStorage rebooted(flash);
+    TEST_ASSERT_EQUAL_size_t(20, rebooted.getSensorReadings("env_temperature", 0,
+                                                            UINT32_MAX).size());
+    std::vector<EventRecord> events = rebooted.getEvents(SIZE_MAX);
+    TEST_ASSERT_EQUAL_size_t(1, events.size());
+    TEST_ASSERT_EQUAL_STRING("kept", events[0].detail.c_str());
+
+    const std::size_t erases = flash.erases;
+    TEST_ASSERT_EQUAL_size_t(kTickMetrics,
+                             logTick(rebooted, 21 * kLogIntervalS, 21.0f));
+    TEST_ASSERT_TRUE(rebooted.storeEvent(3, IDataStorage::kCategoryPump, "resumed"));
+    TEST_ASSERT_EQUAL_size_t(erases + 2, flash.erases);
+    TEST_ASSERT_EQUAL_size_t(21, rebooted.getSensorReadings("env_temperature", 0,
+                                                            UINT32_MAX).size());
+    events = rebooted.getEvents(SIZE_MAX);
+    TEST_ASSERT_EQUAL_size_t(2, events.size());
+    TEST_ASSERT_EQUAL_STRING("resumed", events[0].detail.c_str());
+
+    // A flipped payload bit in a middle frame ends that sector's prefix
+    // at the next boot rather than returning a wrong value.
+    flash.bytes[RingLogDataStorage::kEventSectors * IFlashPartition::kSectorBytes +
+                RingLogDataStorage::kSectorHeaderBytes + 2 + 7] ^= 0x01;
+    RingLogDataStorage damaged(flash);
+    TEST_ASSERT_EQUAL_size_t(1, damaged.getSensorReadings("env_temperature", 0,
+                                                          UINT32_MAX).size());
+}
+
+void test_ring_log_query_events_pages(void)
+{
+    RamFlashPartition flash(kSmallSectors);
+    RingLogDataStorage storage(flash);
+    for (uint32_t i = 0; i < 900; ++i) {
+        // Three events per second, alternating categories.
+        const uint8_t category = (i % 2 == 0) ? IDataStorage::kCategoryPump
+                                              : IDataStorage::kCategoryFailsafe;
+        TEST_ASSERT_TRUE(storage.storeEvent(1000 + i / 3, category, std::to_string(i)));
+    }
+
+    EventQuery query;
+    query.categoryMask = EventQuery::categoryBit(IDataStorage::kCategoryPump);
+    query.since = 1050;
+    query.until = 1250;
+
+    std::vector<EventRecord> expected;
+    for (const EventRecord& r : storage.getEvents(SIZE_MAX)) {
+        if (r.category == IDataStorage::kCategoryPump && r.epoch >= 1050 &&
+            r.epoch <= 1250) {
+            expected.push_back(r);
+        }
+    }
+    TEST_ASSERT_TRUE(expected.size() > 250);
+
+    // Pages of 7 across sector boundaries and same-second runs join up
+    // to exactly the filtered log.
+    std::vector<EventRecord> paged;
+    query.limit = 7;
+    for (;;) {
+        const EventPage page = storage.queryEvents(query);
+        paged.insert(paged.end(), page.events.begin(), page.events.end());
+        if (!page.more) {
+            break;
+        }
+        query.cursor = page.next;
+    }
+    assertSameEvents(expected, paged);
+}
+
+void test_ring_log_append_cost(void)
+{
+    RamFlashPartition flash(kPartitionSectors);
+    RingLogDataStorage storage(flash);
+    logTick(storage, 0, 0.0f);  // first sector: erase + header
+
+    // A full 10-metric tick programs one 50-byte frame and nothing else;
+    // one erase (plus a 12-byte header) every ~80 ticks.
+    const std::size_t bytes = flash.bytesWritten;
+    const std::size_t writes = flash.writeCalls;
+    const std::size_t erases = flash.erases;
+    logTicks(storage, kLogIntervalS, 800);
+    const std::size_t frameBytes = RingLogDataStorage::kFrameOverheadBytes + 6 +
+                                   4 * kTickMetrics;
+    TEST_ASSERT_EQUAL_size_t(50, frameBytes);
+    TEST_ASSERT_TRUE(flash.bytesWritten - bytes <=
+                     800 * frameBytes + 11 * RingLogDataStorage::kSectorHeaderBytes);
+    TEST_ASSERT_TRUE(flash.writeCalls - writes <= 800 + 11);
+    TEST_ASSERT_TRUE(flash.erases - erases <= 11);
+
+    // A single reading costs its 14-byte frame.
+    const std::size_t before = flash.bytesWritten;
+    TEST_ASSERT_TRUE(storage.storeSensorReading("soil_ph", 900 * kLogIntervalS, 6.5f));
+    TEST_ASSERT_EQUAL_size_t(14, flash.bytesWritten - before);
+}
+
+void test_ring_log_counts_its_writes(void)
+{
+    RamFlashPartition flash(kSmallSectors);
+    int64_t nowUs = 0;
+    RingLogDataStorage storage(flash, [&nowUs] { return nowUs += 40; });
+
+    // Enough ticks to wrap the four history sectors at least once.
+    const std::size_t ticks = 400;
+    logTicks(storage, 0, ticks);
+    const StorageWriteStats writes = storage.getStorageStats().writes;
+    // Every program is a sync; the history bytes are the 50-byte frames.
+    TEST_ASSERT_EQUAL_UINT32(flash.writeCalls, writes.syncs);
+    TEST_ASSERT_EQUAL_UINT64(ticks * 50, writes.bytesAppended);
+    // Opened sectors are "files"; reclaiming a live one removes one.
+    TEST_ASSERT_TRUE(writes.filesCreated > 4);
+    TEST_ASSERT_EQUAL_UINT32(writes.filesCreated - 4, writes.filesRemoved);
+    TEST_ASSERT_EQUAL_UINT32(0, writes.rotations);
+    TEST_ASSERT_EQUAL_UINT64(ticks * 40, writes.appendUs);
+}
+
+void test_ring_log_rejects_a_too_small_partition(void)
+{
+    RamFlashPartition flash(RingLogDataStorage::kMinSectors - 1);
+    RingLogDataStorage storage(flash);
+    TEST_ASSERT_FALSE(storage.storeSensorReading("soil_moisture", 1, 1.0f));
+    TEST_ASSERT_FALSE(storage.storeEvent(1, IDataStorage::kCategoryPump, "x"));
+    TEST_ASSERT_TRUE(storage.getSensorReadings("soil_moisture", 0, 10).empty());
+    TEST_ASSERT_TRUE(storage.getEvents(10).empty());
+    TEST_ASSERT_EQUAL_size_t(0, flash.writeCalls);
+}
+
+}  // namespace
+
+void run_ring_log_storage_tests(void)
+{
+    RUN_TEST(test_ring_log_round_trip);
+    RUN_TEST(test_ring_log_recovers_state_at_boot);
+    RUN_TEST(test_ring_log_evicts_oldest_and_keeps_30_days);
+    RUN_TEST(test_ring_log_survives_torn_writes);
+    RUN_TEST(test_ring_log_query_events_pages);
+    RUN_TEST(test_ring_log_append_cost);
+    RUN_TEST(test_ring_log_counts_its_writes);
+    RUN_TEST(test_ring_log_rejects_a_too_small_partition);
+}
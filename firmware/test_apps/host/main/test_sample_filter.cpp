@@ -0,0 +1,243 @@
+// SPDX-FileCopyrightText: 2026 Cryptotomte
+// SPDX-License-Identifier: AGPL-3.0-or-later
+/**
+ * @file test_sample_filter.cpp
+ * @brief Host suite for the streaming metric filters (SampleFilter.h,
+ *        SoilSnapshotFilter.h) and the flatline detector (FlatlineDetector.h).
+ *
+ * Registered by test_main.cpp via run_sample_filter_tests(). The median
+ * window removes a lone spike and follows a sustained change; the EWMA
+ * seeds on its first sample; the rate gate rejects a jump faster than its
+ * limit but passes a step that persists past maxRejects; neutral settings
+ * pass samples through; the soil stage filters only successful reads.
+ * The flatline detector flags a run of identical readings or a quiet
+ * variance once it has held for minFlatMs, and clears on the next move.
+ */
+
+#include <cmath>
+#include <cstdint>
+#include <initializer_list>
+
+#include "unity.h"
+
+#include "sensors/FlatlineDetector.h"
+#include "sensors/SampleFilter.h"
+#include "sensors/SoilSnapshotFilter.h"
+
+namespace {
+
+void test_median_removes_spike_and_follows_step(void)
+{
+    MedianWindow<5> median(3);
+    TEST_ASSERT_EQUAL_FLOAT(40.0f, median.push(40.0f));
+    TEST_ASSERT_EQUAL_FLOAT(41.0f, median.push(42.0f));  // mean of two
+    TEST_ASSERT_EQUAL_FLOAT(42.0f, median.push(95.0f));  // the spike is out
+    TEST_ASSERT_EQUAL_FLOAT(42.0f, median.push(41.0f));
+    TEST_ASSERT_EQUAL_FLOAT(41.0f, median.push(20.0f));
+    TEST_ASSERT_EQUAL_FLOAT(20.0f, median.push(20.0f));  // step: two of three
+
+    MedianWindow<5> oversized(9);  // clamped to the capacity
+    for (float v : {1.0f, 2.0f, 3.0f, 4.0f, 5.0f, 100.0f, 100.0f}) {
+        oversized.push(v);
+    }
+    TEST_ASSERT_EQUAL_FLOAT(6.0f, oversized.push(6.0f));  // {100,100,6,4,5}
+}
+
+void test_ewma_seeds_then_smooths(void)
+{
+    Ewma ewma(0.25f);
+    TEST_ASSERT_EQUAL_FLOAT(40.0f, ewma.push(40.0f));
+    TEST_ASSERT_EQUAL_FLOAT(45.0f, ewma.push(60.0f));
+    ewma.reset();
+    TEST_ASSERT_EQUAL_FLOAT(10.0f, ewma.push(10.0f));
+
+    Ewma passthrough(0.0f);  // out of range: clamped to off
+    passthrough.push(1.0f);
+    TEST_ASSERT_EQUAL_FLOAT(7.0f, passthrough.push(7.0f));
+}
+
+void test_rate_gate_rejects_jump_passes_persistent_step(void)
+{
+    RateGate gate(/*maxRatePerS=*/1.0f, /*maxRejects=*/2);
+    TEST_ASSERT_TRUE(gate.accept(40.0f, 0));
+    TEST_ASSERT_TRUE(gate.accept(44.0f, 5000));    // 4 in 5 s: within 5
+    TEST_ASSERT_FALSE(gate.accept(90.0f, 10000));  // spike
+    TEST_ASSERT_TRUE(gate.accept(45.0f, 15000));   // back: 1 in 10 s
+
+    // A real step keeps failing, and passes on the third sample.
+    TEST_ASSERT_FALSE(gate.accept(70.0f, 20000));
+    TEST_ASSERT_FALSE(gate.accept(70.0f, 25000));
+    TEST_ASSERT_TRUE(gate.accept(70.0f, 30000));
+    TEST_ASSERT_TRUE(gate.accept(71.0f, 35000));  // the new reference
+}
+
+void test_sample_filter_chain(void)
+{
+    FilterSettings settings;
+    float out = 0.0f;
+    SampleFilter<> neutral(settings);
+    TEST_ASSERT_TRUE(neutral.push(12.5f, 0, out));
+    TEST_ASSERT_EQUAL_FLOAT(12.5f, out);
+    TEST_ASSERT_TRUE(neutral.push(99.0f, 1, out));
+    TEST_ASSERT_EQUAL_FLOAT(99.0f, out);
+
+    settings.medianWindow = 3;
+    settings.ewmaAlpha = 0.5f;
+    settings.maxRatePerS = 2.0f;
+    SampleFilter<> filter(settings);
+    TEST_ASSERT_TRUE(filter.push(40.0f, 0, out));
+    TEST_ASSERT_EQUAL_FLOAT(40.0f, out);
+    TEST_ASSERT_TRUE(filter.push(42.0f, 5000, out));  // median 41
+    TEST_ASSERT_EQUAL_FLOAT(40.5f, out);
+
+    // Spike and NaN: rejected, the output holds.
+    TEST_ASSERT_FALSE(filter.push(100.0f, 10000, out));
+    TEST_ASSERT_EQUAL_FLOAT(40.5f, out);
+    TEST_ASSERT_FALSE(filter.push(NAN, 15000, out));
+    TEST_ASSERT_EQUAL_FLOAT(40.5f, out);
+    TEST_ASSERT_EQUAL_UINT32(2, filter.rejected());
+
+    filter.reset();
+    TEST_ASSERT_TRUE(filter.push(10.0f, 20000, out));
+    TEST_ASSERT_EQUAL_FLOAT(10.0f, out);
+}
+
+void test_soil_filter_skips_failed_reads(void)
+{
+    SoilSnapshotFilter filter;
+    SoilSnapshot raw;
+    raw.readOk = true;
+    raw.available = true;
+    raw.moisture = 40.0f;
+    raw.ph = 6.5f;
+    SoilSnapshot out = filter.apply(raw, 0);
+    TEST_ASSERT_EQUAL_FLOAT(40.0f, out.moisture);
+
+    // A one-read moisture spike past the default 5 %/s gate.
+    raw.moisture = 90.0f;
+    out = filter.apply(raw, 5000);
+    TEST_ASSERT_EQUAL_FLOAT(40.0f, out.moisture);
+    TEST_ASSERT_EQUAL_UINT32(1, filter.rejected());
+    TEST_ASSERT_EQUAL_FLOAT(6.5f, out.ph);
+
+    // A failed read is passed on as it is and feeds nothing.
+    SoilSnapshot failed = raw;
+    failed.readOk = false;
+    failed.moisture = 0.0f;
+    out = filter.apply(failed, 10000);
+    TEST_ASSERT_FALSE(out.readOk);
+    TEST_ASSERT_EQUAL_FLOAT(0.0f, out.moisture);
+    TEST_ASSERT_EQUAL_UINT32(1, filter.rejected());
+}
+
+void test_soil_filter_keeps_the_group_not_read(void)
+{
+    SoilSnapshotFilter filter;
+    SoilSnapshot raw;
+    raw.readOk = true;
+    raw.slowReadOk = true;
+    raw.moisture = 40.0f;
+    raw.ph = 6.0f;
+    filter.apply(raw, 0);
+    raw.moisture = 44.0f;
+    raw.ph = 7.0f;
+    SoilSnapshot out = filter.apply(raw, 5000);
+    const float filteredPh = out.ph;
+    TEST_ASSERT_TRUE(filteredPh > 6.0f && filteredPh < 7.0f);
+
+    // A fast read: the sensor's cached raw pH does not replace the
+    // filtered one, and the moisture filter moves on.
+    raw.moisture = 46.0f;
+    out = filter.apply(raw, 10000, SoilReadGroup::Fast);
+    TEST_ASSERT_EQUAL_FLOAT(filteredPh, out.ph);
+    TEST_ASSERT_TRUE(out.moisture > 42.0f);
+}
+
+void test_flatline_run_flags_after_min_time(void)
+{
+    FlatlineSettings settings;
+    settings.minFlatMs = 60'000;
+    settings.minRunSamples = 5;
+    FlatlineDetector detector(settings);
+    int64_t at = 0;
+    for (int i = 0; i < 12; ++i, at += 5000) {
+        TEST_ASSERT_FALSE(detector.sample(41.5f, at));  // 55 s of run
+    }
+    TEST_ASSERT_EQUAL_UINT32(12, detector.run());
+    TEST_ASSERT_TRUE(detector.sample(41.5f, at));  // 60 s
+    TEST_ASSERT_TRUE(detector.flat());
+
+    // One reading that moves clears it and starts a new run.
+    TEST_ASSERT_FALSE(detector.sample(41.6f, at + 5000));
+    TEST_ASSERT_EQUAL_UINT32(1, detector.run());
+
+    // A long gap is not enough without minRunSamples readings.
+    FlatlineDetector sparse(settings);
+    sparse.sample(30.0f, 0);
+    TEST_ASSERT_FALSE(sparse.sample(30.0f, 3'600'000));
+}
+
+void test_flatline_variance_catches_dither(void)
+{
+    FlatlineSettings settings;
+    settings.minFlatMs = 60'000;
+    settings.minRunSamples = 10;
+    settings.minStdDev = 0.05f;
+    FlatlineDetector detector(settings);
+    // A probe that toggles its last digit: no run, but no signal either.
+    int64_t at = 0;
+    bool flat = false;
+    for (int i = 0; i < 40 && !flat; ++i, at += 5000) {
+        flat = detector.sample(i % 2 == 0 ? 40.0f : 40.01f, at);
+    }
+    TEST_ASSERT_TRUE(flat);
+    TEST_ASSERT_TRUE(detector.run() < 2);
+    TEST_ASSERT_TRUE(detector.stdDev() < 0.05f);
+
+    // Real movement clears it.
+    TEST_ASSERT_FALSE(detector.sample(44.0f, at));
+
+    // The same dither on a probe that also moves is never flagged.
+    FlatlineDetector live(settings);
+    at = 0;
+    for (int i = 0; i < 60; ++i, at += 5000) {
+        TEST_ASSERT_FALSE(live.sample(40.0f + static_cast<float>(i % 7), at));
+    }
+}
+
+void test_flatline_off_and_reset(void)
+{
+    FlatlineSettings off;
+    off.minFlatMs = 0;
+    off.minRunSamples = 1;
+    FlatlineDetector disabled(off);
+    for (int i = 0; i < 100; ++i) {
+        TEST_ASSERT_FALSE(disabled.sample(12.0f, i * 60'000LL));
+    }
+
+    FlatlineSettings settings;
+    settings.minFlatMs = 10'000;
+    settings.minRunSamples = 2;
+    FlatlineDetector detector(settings);
+    detector.sample(12.0f, 0);
+    TEST_ASSERT_TRUE(detector.sample(12.0f, 10'000));
+    TEST_ASSERT_TRUE(detector.sample(NAN, 15'000));  // ignored: still flat
+    detector.reset();
+    TEST_ASSERT_FALSE(detector.flat());
+    TEST_ASSERT_FALSE(detector.sample(12.0f, 20'000));
+}
+
+}  // namespace
+
+void run_sample_filter_tests(void)
+{
+    RUN_TEST(test_median_removes_spike_and_follows_step);
+    RUN_TEST(test_ewma_seeds_then_smooths);
+    RUN_TEST(test_rate_gate_rejects_jump_passes_persistent_step);
+    RUN_TEST(test_sample_filter_chain);
+    RUN_TEST(test_soil_filter_skips_failed_reads);
+    RUN_TEST(test_soil_filter_keeps_the_group_not_read);
+    RUN_TEST(test_flatline_run_flags_after_min_time);
+    RUN_TEST(test_flatline_variance_catches_dither);
+    RUN_TEST(test_flatline_off_and_reset);
+}
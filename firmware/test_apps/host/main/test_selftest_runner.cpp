@@ -0,0 +1,253 @@
+// SPDX-FileCopyrightText: 2026 Cryptotomte
+// SPDX-License-Identifier: AGPL-3.0-or-later
+/**
+ * @file test_selftest_runner.cpp
+ * @brief Host suite for the concurrent self-test checks
+ *        (api/SelfTestRunner.h).
+ *
+ * Registered by test_main.cpp via run_selftest_runner_tests(). With a
+ * helper thread, as on target, two checks run at the same time and the
+ * results come back in order; without one the caller runs them all; a
+ * check past the deadline is reported timed out and, while it is still
+ * running, not started again; a sensor read failure carries its error.
+ */
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <mutex>
+#include <string>
+#include <thread>
+
+#include "unity.h"
+
+#include "api/SelfTestRunner.h"
+
+using api::ISelfTestCheck;
+using api::SelfTestResultDto;
+using api::SelfTestRunner;
+
+namespace {
+
+/// Set by one check, awaited by another: proves they overlap.
+struct Rendezvous {
+    std::mutex mutex;
+    std::condition_variable cv;
+    bool arrived = false;
+
+    void arrive()
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        arrived = true;
+        cv.notify_all();
+    }
+
+    bool await(int ms)
+    {
+        std::unique_lock<std::mutex> lock(mutex);
+        return cv.wait_for(lock, std::chrono::milliseconds(ms), [this] { return arrived; });
+    }
+};
+
+/// Waits for @p other to start (when given), then passes with @p result.
+class MeetingCheck : public ISelfTestCheck {
+public:
+    MeetingCheck(const char* name, Rendezvous* mine, Rendezvous* other, bool result = true)
+        : name_(name), mine_(mine), other_(other), result_(result)
+    {
+    }
+
+    const char* name() const override { return name_; }
+
+    bool run(std::string& detail) override
+    {
+        ++runs;
+        if (mine_ != nullptr) {
+            mine_->arrive();
+        }
+        if (other_ != nullptr && !other_->await(2000)) {
+            detail = "ran alone";
+            return false;
+        }
+        detail = result_ ? "ok" : "bad";
+        return result_;
+    }
+
+    std::atomic<int> runs{0};
+
+private:
+    const char* name_;
+    Rendezvous* mine_;
+    Rendezvous* other_;
+    bool result_;
+};
+
+/// Blocks until released: a bus that does not answer.
+class StuckCheck : public ISelfTestCheck {
+public:
+    explicit StuckCheck(Rendezvous* started) : started_(started) {}
+
+    const char* name() const override { return "soil"; }
+
+    bool run(std::string& detail) override
+    {
+        ++runs;
+        started_->arrive();
+        std::unique_lock<std::mutex> lock(mutex_);
+        cv_.wait(lock, [this] { return released_; });
+        released_ = false;
+        ++returns;
+        detail = "ok";
+        return true;
+    }
+
+    void release()
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        released_ = true;
+        cv_.notify_all();
+    }
+
+    std::atomic<int> runs{0};
+    std::atomic<int> returns{0};
+
+private:
+    Rendezvous* started_;
+    std::mutex mutex_;
+    std::condition_variable cv_;
+    bool released_ = false;
+};
+
+/// serveCheck() in a loop until destroyed, as main/selftest_task.cpp does.
+class HelperThread {
+public:
+    explicit HelperThread(SelfTestRunner& runner)
+        : thread_([this, &runner] {
+              while (!stop_.load()) {
+                  runner.serveCheck(10);
+              }
+          })
+    {
+    }
+
+    ~HelperThread()
+    {
+        stop_.store(true);
+        thread_.join();
+    }
+
+private:
+    std::atomic<bool> stop_{false};
+    std::thread thread_;
+};
+
+struct FakeSensor {
+    bool ok = false;
+    int error = 3;
+    bool read() { return ok; }
+    int getLastError() { return error; }
+};
+
+void test_checks_overlap_on_a_helper(void)
+{
+    SelfTestRunner runner;
+    HelperThread helper(runner);
+    Rendezvous envStarted;
+    Rendezvous soilStarted;
+    MeetingCheck env("environmental", &envStarted, &soilStarted);
+    MeetingCheck soil("soil", &soilStarted, &envStarted, false);
+    ISelfTestCheck* checks[] = {&env, &soil};
+
+    const SelfTestResultDto result = runner.run(checks, 2, 3000);
+    TEST_ASSERT_EQUAL_size_t(2, result.checks.size());
+    TEST_ASSERT_EQUAL_STRING("environmental", result.checks[0].name.c_str());
+    TEST_ASSERT_TRUE(result.checks[0].ok);
+    TEST_ASSERT_EQUAL_STRING("ok", result.checks[0].detail.c_str());
+    TEST_ASSERT_EQUAL_STRING("soil", result.checks[1].name.c_str());
+    TEST_ASSERT_FALSE(result.checks[1].ok);
+    TEST_ASSERT_EQUAL_STRING("bad", result.checks[1].detail.c_str());
+    TEST_ASSERT_FALSE(result.overall);
+}
+
+void test_caller_runs_every_check_without_a_helper(void)
+{
+    SelfTestRunner runner;
+    MeetingCheck env("environmental", nullptr, nullptr);
+    MeetingCheck soil("soil", nullptr, nullptr);
+    ISelfTestCheck* checks[] = {&env, &soil};
+
+    const SelfTestResultDto result = runner.run(checks, 2, 100);
+    TEST_ASSERT_TRUE(result.overall);
+    TEST_ASSERT_EQUAL_INT(1, env.runs.load());
+    TEST_ASSERT_EQUAL_INT(1, soil.runs.load());
+
+    // And again: the slots are free after a completed run.
+    TEST_ASSERT_TRUE(runner.run(checks, 2, 100).overall);
+    TEST_ASSERT_EQUAL_INT(2, soil.runs.load());
+}
+
+void test_deadline_abandons_a_stuck_check(void)
+{
+    SelfTestRunner runner;
+    HelperThread helper(runner);
+    // The environmental check waits for the helper to take the stuck one,
+    // which the caller could not abandon.
+    Rendezvous soilStarted;
+    MeetingCheck env("environmental", nullptr, &soilStarted);
+    StuckCheck soil(&soilStarted);
+    ISelfTestCheck* checks[] = {&env, &soil};
+
+    const auto before = std::chrono::steady_clock::now();
+    SelfTestResultDto result = runner.run(checks, 2, 50);
+    const auto tookMs = std::chrono::duration_cast<std::chrono::milliseconds>(
+                            std::chrono::steady_clock::now() - before)
+                            .count();
+    TEST_ASSERT_TRUE(tookMs < 1000);
+    TEST_ASSERT_TRUE(result.checks[0].ok);
+    TEST_ASSERT_FALSE(result.checks[1].ok);
+    TEST_ASSERT_EQUAL_STRING("timed out after 50 ms", result.checks[1].detail.c_str());
+    TEST_ASSERT_FALSE(result.overall);
+
+    // Still stuck: not started a second time.
+    result = runner.run(checks, 2, 50);
+    TEST_ASSERT_EQUAL_STRING("previous check still running", result.checks[1].detail.c_str());
+    TEST_ASSERT_EQUAL_INT(1, soil.runs.load());
+
+    // Once it returns, the next run starts it again.
+    soil.release();
+    for (int i = 0; i < 200 && soil.returns.load() == 0; ++i) {
+        std::this_thread::sleep_for(std::chrono::milliseconds(5));
+    }
+    TEST_ASSERT_EQUAL_INT(1, soil.returns.load());
+    std::this_thread::sleep_for(std::chrono::milliseconds(20));  // slot back to idle
+    std::thread releaser([&soil] {
+        std::this_thread::sleep_for(std::chrono::milliseconds(20));
+        soil.release();
+    });
+    result = runner.run(checks, 2, 2000);
+    releaser.join();
+    TEST_ASSERT_TRUE(result.overall);
+    TEST_ASSERT_EQUAL_INT(2, soil.runs.load());
+}
+
+void test_sensor_read_check_reports_the_error(void)
+{
+    FakeSensor sensor;
+    api::SensorReadCheck<FakeSensor> check("environmental", sensor);
+    std::string detail;
+    TEST_ASSERT_FALSE(check.run(detail));
+    TEST_ASSERT_EQUAL_STRING("read failed, error 3", detail.c_str());
+    sensor.ok = true;
+    TEST_ASSERT_TRUE(check.run(detail));
+    TEST_ASSERT_EQUAL_STRING("ok", detail.c_str());
+}
+
+}  // namespace
+
+void run_selftest_runner_tests(void)
+{
+    RUN_TEST(test_checks_overlap_on_a_helper);
+    RUN_TEST(test_caller_runs_every_check_without_a_helper);
+    RUN_TEST(test_deadline_abandons_a_stuck_check);
+    RUN_TEST(test_sensor_read_check_reports_the_error);
+}
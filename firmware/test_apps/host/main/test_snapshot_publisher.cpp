@@ -0,0 +1,123 @@
+// SPDX-FileCopyrightText: 2026 Cryptotomte
+// SPDX-License-Identifier: AGPL-3.0-or-later
+/**
+ * @file test_snapshot_publisher.cpp
+ * @brief Host suite for the single-writer state publisher
+ *        (interfaces/SnapshotPublisher.h).
+ *
+ * Registered by test_main.cpp via run_snapshot_publisher_tests(). A publish
+ * that changes nothing is free (no version, no listener); the listener
+ * hears every change with its version; and a reader racing a writer on
+ * another thread never sees a torn value or a version going back.
+ */
+
+#include <atomic>
+#include <cstdint>
+#include <thread>
+#include <vector>
+
+#include "unity.h"
+
+#include "interfaces/SnapshotPublisher.h"
+
+namespace {
+
+struct Wide {
+    uint32_t a;
+    uint32_t b[7];
+};
+
+Wide wide(uint32_t v)
+{
+    Wide w{};
+    w.a = v;
+    for (uint32_t& word : w.b) {
+        word = v;
+    }
+    return w;
+}
+
+struct Recorder final : ISnapshotListener<Wide> {
+    void onSnapshotChanged(const Wide& value, uint32_t version) override
+    {
+        values.push_back(value.a);
+        versions.push_back(version);
+    }
+    std::vector<uint32_t> values;
+    std::vector<uint32_t> versions;
+};
+
+void test_unchanged_publish_is_free(void)
+{
+    SnapshotPublisher<Wide> published(wide(7));
+    TEST_ASSERT_EQUAL_UINT32(7, published.load().b[6]);
+    TEST_ASSERT_EQUAL_UINT32(0, published.version());
+
+    TEST_ASSERT_TRUE(published.publish(wide(8)));
+    TEST_ASSERT_FALSE(published.publish(wide(8)));
+    TEST_ASSERT_EQUAL_UINT32(1, published.version());
+    TEST_ASSERT_TRUE(published.publish(wide(9)));
+    TEST_ASSERT_TRUE(published.publish(wide(8)));  // back again: a change
+    TEST_ASSERT_EQUAL_UINT32(3, published.version());
+    TEST_ASSERT_EQUAL_UINT32(8, published.load().a);
+    TEST_ASSERT_EQUAL_UINT32(8, published.load().b[0]);
+}
+
+void test_listener_hears_every_change(void)
+{
+    SnapshotPublisher<Wide> published;
+    Recorder recorder;
+    published.publish(wide(1));  // before the listener
+    published.setListener(&recorder);
+    published.publish(wide(2));
+    published.publish(wide(2));
+    published.publish(wide(3));
+    published.setListener(nullptr);
+    published.publish(wide(4));
+
+    TEST_ASSERT_EQUAL_size_t(2, recorder.values.size());
+    TEST_ASSERT_EQUAL_UINT32(2, recorder.values[0]);
+    TEST_ASSERT_EQUAL_UINT32(2, recorder.versions[0]);
+    TEST_ASSERT_EQUAL_UINT32(3, recorder.values[1]);
+    TEST_ASSERT_EQUAL_UINT32(3, recorder.versions[1]);
+    TEST_ASSERT_EQUAL_UINT32(4, published.version());
+}
+
+void test_racing_reader_never_torn(void)
+{
+    SnapshotPublisher<Wide> published(wide(0));
+    std::atomic<bool> done{false};
+    std::thread writer([&] {
+        for (uint32_t i = 1; i <= 50000; ++i) {
+            published.publish(wide(i));
+        }
+        done = true;
+    });
+
+    uint32_t torn = 0;
+    uint32_t backwards = 0;
+    uint32_t lastSeen = 0;
+    while (!done) {
+        const Wide w = published.load();
+        for (uint32_t word : w.b) {
+            torn += word != w.a ? 1 : 0;
+        }
+        backwards += w.a < lastSeen ? 1 : 0;
+        lastSeen = w.a;
+    }
+    writer.join();
+
+    TEST_ASSERT_EQUAL_UINT32(0, torn);
+    TEST_ASSERT_EQUAL_UINT32(0, backwards);
+    TEST_ASSERT_EQUAL_UINT32(50000, published.load().a);
+    TEST_ASSERT_EQUAL_UINT32(50000, published.version());
+}
+
+}  // namespace
+
+void run_snapshot_publisher_tests(void)
+{
+    RUN_TEST(test_unchanged_publish_is_free);
+    RUN_TEST(test_listener_hears_every_change);
+    RUN_TEST(test_racing_reader_never_torn);
+}
@@ -0,0 +1,169 @@
+// SPDX-FileCopyrightText: 2026 Cryptotomte
+// SPDX-License-Identifier: AGPL-3.0-or-later
+/**
+ * @file test_soil_acquirer.cpp
+ * @brief Host suite for the soil snapshot publisher (SoilAcquirer.h).
+ *
+ * Each acquire() reads once and publishes the snapshot with the time the
+ * read finished and the next sequence number, then calls the listener;
+ * latest() copies without reading, and before the first publish reports
+ * sequence 0. A filter, when set, shapes what is published. A group read
+ * stamps the freshness of its own group only. A flatline detector, when
+ * set, sees the raw moisture of good fast reads and marks samples suspect.
+ */
+
+#include <cstdint>
+
+#include "unity.h"
+
+#include "actuators/testing/FakeTimeProvider.h"
+#include "sensors/SoilAcquirer.h"
+#include "sensors/testing/MockSoilSensor.h"
+
+namespace {
+
+void test_publishes_each_read_with_time_and_sequence()
+{
+    FakeTimeProvider clock;
+    MockSoilSensor soil;
+    SoilAcquirer acquirer(soil, clock);
+    int notified = 0;
+    acquirer.setListener([&] { ++notified; });
+
+    TEST_ASSERT_EQUAL_UINT32(0, acquirer.latest().sequence);
+    TEST_ASSERT_FALSE(acquirer.latest().soil.available);
+
+    soil.scriptSuccessfulRead(42.0f, 18.0f, 42.0f, 6.5f, 1.2f, 3.0f, 5.0f, 8.0f);
+    TEST_ASSERT_TRUE(acquirer.acquire());
+    TimedSoilSnapshot sample = acquirer.latest();
+    TEST_ASSERT_EQUAL_UINT32(1, sample.sequence);
+    TEST_ASSERT_EQUAL_INT64(clock.nowMs(), sample.atMs);
+    TEST_ASSERT_TRUE(sample.soil.readOk);
+    TEST_ASSERT_EQUAL_FLOAT(42.0f, sample.soil.moisture);
+    TEST_ASSERT_EQUAL_INT(1, notified);
+
+    // latest() never reads.
+    acquirer.latest();
+    TEST_ASSERT_EQUAL_INT(1, soil.readCalls);
+}
+
+void test_failed_read_is_published_too()
+{
+    FakeTimeProvider clock;
+    MockSoilSensor soil;
+    SoilAcquirer acquirer(soil, clock);
+
+    soil.scriptSuccessfulRead(42.0f, 18.0f, 42.0f, 6.5f, 1.2f, 3.0f, 5.0f, 8.0f);
+    soil.scriptFailedRead(3);
+    acquirer.acquire();
+    clock.advance(5000);
+    TEST_ASSERT_FALSE(acquirer.acquire());
+
+    // A new sample (the consumer sees the failure), last-good values kept.
+    const TimedSoilSnapshot sample = acquirer.latest();
+    TEST_ASSERT_EQUAL_UINT32(2, sample.sequence);
+    TEST_ASSERT_EQUAL_INT64(clock.nowMs(), sample.atMs);
+    TEST_ASSERT_FALSE(sample.soil.readOk);
+    TEST_ASSERT_TRUE(sample.soil.available);
+    TEST_ASSERT_EQUAL_INT(3, sample.soil.lastError);
+    TEST_ASSERT_EQUAL_FLOAT(42.0f, sample.soil.moisture);
+}
+
+void test_filter_applies_before_publish()
+{
+    FakeTimeProvider clock;
+    MockSoilSensor soil;
+    SoilAcquirer acquirer(soil, clock);
+    SoilSnapshotFilter filter;
+    acquirer.setFilter(&filter);
+
+    soil.scriptSuccessfulRead(40.0f, 18.0f, 40.0f, 6.5f, 1.2f, 3.0f, 5.0f, 8.0f);
+    acquirer.acquire();
+    clock.advance(5000);
+    soil.scriptSuccessfulRead(95.0f, 18.0f, 40.0f, 6.5f, 1.2f, 3.0f, 5.0f, 8.0f);
+    TEST_ASSERT_TRUE(acquirer.acquire());  // the read itself succeeded
+
+    const TimedSoilSnapshot sample = acquirer.latest();
+    TEST_ASSERT_EQUAL_UINT32(2, sample.sequence);
+    TEST_ASSERT_EQUAL_FLOAT(40.0f, sample.soil.moisture);  // spike gated
+}
+
+void test_flatline_marks_samples_suspect()
+{
+    FakeTimeProvider clock;
+    MockSoilSensor soil;
+    SoilAcquirer acquirer(soil, clock);
+    FlatlineSettings settings;
+    settings.minFlatMs = 10'000;
+    settings.minRunSamples = 3;
+    FlatlineDetector flatline(settings);
+    acquirer.setFlatline(&flatline);
+
+    for (int i = 0; i < 3; ++i) {
+        soil.scriptSuccessfulRead(37.0f, 18.0f, 40.0f, 6.5f, 1.2f, 3.0f, 5.0f, 8.0f);
+    }
+    soil.scriptFailedRead(3);
+    soil.scriptSuccessfulRead(38.0f, 18.0f, 40.0f, 6.5f, 1.2f, 3.0f, 5.0f, 8.0f);
+
+    for (int i = 0; i < 3; ++i) {
+        acquirer.acquire();
+        TEST_ASSERT_EQUAL(i == 2, acquirer.latest().suspect);  // 10 s, 3 reads
+        clock.advance(5000);
+    }
+
+    // A failed read feeds nothing: still suspect.
+    acquirer.acquire();
+    TEST_ASSERT_TRUE(acquirer.latest().suspect);
+
+    // The value moves: cleared.
+    clock.advance(5000);
+    acquirer.acquire();
+    TEST_ASSERT_FALSE(acquirer.latest().suspect);
+}
+
+void test_group_reads_stamp_their_own_freshness()
+{
+    FakeTimeProvider clock;
+    MockSoilSensor soil;
+    SoilAcquirer acquirer(soil, clock);
+
+    soil.scriptSuccessfulRead(42.0f, 18.0f, 42.0f, 6.5f, 1.2f, 3.0f, 5.0f, 8.0f);
+    soil.scriptSuccessfulRead(42.0f, 18.0f, 42.0f, 6.6f, 1.2f, 3.0f, 5.0f, 8.0f);
+    soil.scriptFailedRead(3);
+    soil.scriptSuccessfulRead(43.0f, 18.0f, 43.0f, 6.6f, 1.2f, 3.0f, 5.0f, 8.0f);
+    TEST_ASSERT_TRUE(acquirer.acquire(SoilReadGroup::Fast));
+    TEST_ASSERT_EQUAL(static_cast<int>(SoilReadGroup::Fast),
+                      static_cast<int>(soil.lastReadGroup));
+    TimedSoilSnapshot sample = acquirer.latest();
+    TEST_ASSERT_EQUAL(static_cast<int>(SoilReadGroup::Fast),
+                      static_cast<int>(sample.group));
+    TEST_ASSERT_EQUAL_INT64(1000000, sample.fastAtMs);
+    TEST_ASSERT_EQUAL_INT64(0, sample.slowAtMs);
+
+    clock.advance(500);
+    TEST_ASSERT_TRUE(acquirer.acquire(SoilReadGroup::Slow));
+    sample = acquirer.latest();
+    TEST_ASSERT_EQUAL_INT64(1000000, sample.fastAtMs);
+    TEST_ASSERT_EQUAL_INT64(1000500, sample.slowAtMs);
+
+    // A failed read moves no freshness stamp; a full read moves both.
+    clock.advance(500);
+    TEST_ASSERT_FALSE(acquirer.acquire(SoilReadGroup::Fast));
+    TEST_ASSERT_EQUAL_INT64(1000000, acquirer.latest().fastAtMs);
+    clock.advance(500);
+    TEST_ASSERT_TRUE(acquirer.acquire());
+    sample = acquirer.latest();
+    TEST_ASSERT_EQUAL_INT64(1001500, sample.fastAtMs);
+    TEST_ASSERT_EQUAL_INT64(1001500, sample.slowAtMs);
+}
+
+}  // namespace
+
+void run_soil_acquirer_tests(void)
+{
+    RUN_TEST(test_publishes_each_read_with_time_and_sequence);
+    RUN_TEST(test_failed_read_is_published_too);
+    RUN_TEST(test_filter_applies_before_publish);
+    RUN_TEST(test_flatline_marks_samples_suspect);
+    RUN_TEST(test_group_reads_stamp_their_own_freshness);
+}
@@ -0,0 +1,193 @@
+// SPDX-FileCopyrightText: 2026 Cryptotomte
+// SPDX-License-Identifier: AGPL-3.0-or-later
+/**
+ * @file test_soil_poll_scheduler.cpp
+ * @brief Host suite for the multi-drop soil probe round-robin
+ *        (SoilPollScheduler.h).
+ *
+ * The address list parses decimal and hex and rejects anything it cannot
+ * trust whole; the primary is never polled; the others come due evenly
+ * across the period, one per poll; a probe cut off by the next period is
+ * missed, not read late; the budget is the airtime of every probe over
+ * the period and the measured share the bus time over the last period; a
+ * zone probe with a feed is read through it and published.
+ */
+
+#include <cstdint>
+
+#include "unity.h"
+
+#include "actuators/testing/FakeTimeProvider.h"
+#include "interfaces/MetricRegistry.h"
+#include "sensors/SoilPollScheduler.h"
+#include "sensors/testing/MockSoilSensor.h"
+
+namespace {
+
+uint64_t gBusUs = 0;
+
+uint64_t fakeBusTime()
+{
+    return gBusUs;
+}
+
+void test_parse_addresses()
+{
+    uint8_t out[SoilPollScheduler::kMaxProbes] = {};
+    TEST_ASSERT_EQUAL_size_t(1, parseSoilAddresses("1", out, 7));
+    TEST_ASSERT_EQUAL_UINT8(1, out[0]);
+    TEST_ASSERT_EQUAL_size_t(4, parseSoilAddresses(" 1, 2 0x0A,247 ", out, 7));
+    TEST_ASSERT_EQUAL_UINT8(2, out[1]);
+    TEST_ASSERT_EQUAL_UINT8(10, out[2]);
+    TEST_ASSERT_EQUAL_UINT8(247, out[3]);
+
+    TEST_ASSERT_EQUAL_size_t(0, parseSoilAddresses("", out, 7));
+    TEST_ASSERT_EQUAL_size_t(0, parseSoilAddresses(nullptr, out, 7));
+    TEST_ASSERT_EQUAL_size_t(0, parseSoilAddresses("0", out, 7));      // broadcast
+    TEST_ASSERT_EQUAL_size_t(0, parseSoilAddresses("248", out, 7));    // reserved
+    TEST_ASSERT_EQUAL_size_t(0, parseSoilAddresses("1,1", out, 7));    // duplicate
+    TEST_ASSERT_EQUAL_size_t(0, parseSoilAddresses("1;2", out, 7));
+    TEST_ASSERT_EQUAL_size_t(0, parseSoilAddresses("0x", out, 7));
+    TEST_ASSERT_EQUAL_size_t(0, parseSoilAddresses("1,2,3", out, 2));  // too many
+}
+
+void test_airtime()
+{
+    // 31 bytes plus two 3.5-character silences, 10 bits each, at 9600.
+    TEST_ASSERT_EQUAL_UINT32(39583, soilReadAirtimeUs(9600));
+    // Above 19200 the silences are a fixed 1.75 ms each.
+    TEST_ASSERT_EQUAL_UINT32(310u * 1000000u / 115200u + 3500u, soilReadAirtimeUs(115200));
+    TEST_ASSERT_EQUAL_UINT32(0, soilReadAirtimeUs(0));
+}
+
+void test_probes_are_spread_across_the_period()
+{
+    MockSoilSensor primary, second, third, fourth;
+    SoilPollScheduler poller(9600);
+    TEST_ASSERT_TRUE(poller.add(1, primary));
+    TEST_ASSERT_TRUE(poller.add(2, second));
+    TEST_ASSERT_TRUE(poller.add(3, third));
+    TEST_ASSERT_TRUE(poller.add(4, fourth));
+    TEST_ASSERT_EQUAL_UINT32(UINT32_MAX, poller.msUntilDue(0));  // no period yet
+
+    poller.beginPeriod(1000, 8000);
+    TEST_ASSERT_EQUAL_UINT32(2000, poller.msUntilDue(1000));
+    TEST_ASSERT_FALSE(poller.pollDue(2999));
+    TEST_ASSERT_TRUE(poller.pollDue(3000));
+    TEST_ASSERT_EQUAL_INT(1, second.readCalls);
+    TEST_ASSERT_FALSE(poller.pollDue(3000));  // one probe per slot
+    TEST_ASSERT_EQUAL_UINT32(2000, poller.msUntilDue(3000));
+
+    // Late wakes catch up one probe per call.
+    TEST_ASSERT_TRUE(poller.pollDue(9000));
+    TEST_ASSERT_EQUAL_UINT32(0, poller.msUntilDue(9000));
+    TEST_ASSERT_TRUE(poller.pollDue(9000));
+    TEST_ASSERT_EQUAL_UINT32(UINT32_MAX, poller.msUntilDue(9000));
+    TEST_ASSERT_EQUAL_INT(0, primary.readCalls);  // the controller's
+    TEST_ASSERT_EQUAL_INT(1, third.readCalls);
+    TEST_ASSERT_EQUAL_INT(1, fourth.readCalls);
+}
+
+void test_cut_off_probe_is_missed()
+{
+    MockSoilSensor primary, second, third;
+    third.readResult = false;
+    SoilPollScheduler poller(9600);
+    poller.add(1, primary);
+    poller.add(2, second);
+    poller.add(3, third);
+
+    poller.beginPeriod(0, 3000);
+    TEST_ASSERT_TRUE(poller.pollDue(1000));
+    poller.beginPeriod(1500, 3000);  // the interval was shortened
+    TEST_ASSERT_EQUAL_UINT32(1, poller.usage().missed);
+    TEST_ASSERT_EQUAL_UINT32(1000, poller.msUntilDue(1500));  // second first again
+    TEST_ASSERT_TRUE(poller.pollDue(2500));
+    TEST_ASSERT_TRUE(poller.pollDue(3500));
+
+    const SoilBusUsage u = poller.usage();
+    TEST_ASSERT_EQUAL_UINT32(3, u.polls);
+    TEST_ASSERT_EQUAL_UINT32(1, u.failures);
+    TEST_ASSERT_EQUAL_INT(2, second.readCalls);
+    TEST_ASSERT_EQUAL_INT(1, third.readCalls);
+}
+
+void test_single_probe_is_never_polled()
+{
+    MockSoilSensor primary;
+    SoilPollScheduler poller(9600);
+    poller.add(1, primary);
+    poller.beginPeriod(0, 1000);
+    TEST_ASSERT_EQUAL_UINT32(UINT32_MAX, poller.msUntilDue(0));
+    TEST_ASSERT_FALSE(poller.pollDue(5000));
+    TEST_ASSERT_EQUAL_INT(0, primary.readCalls);
+    poller.beginPeriod(1000, 1000);
+    TEST_ASSERT_EQUAL_UINT32(0, poller.usage().missed);
+}
+
+void test_zone_probe_read_through_its_feed()
+{
+    FakeTimeProvider clock;
+    MockSoilSensor primary, second;
+    second.moisture = 42.0f;
+    SoilAcquirer secondFeed(second, clock);
+    int published = 0;
+    secondFeed.setListener([&published] { ++published; });
+    SoilPollScheduler poller(9600);
+    poller.add(1, primary);
+    poller.add(2, second);
+    TEST_ASSERT_FALSE(poller.setFeed(0, secondFeed));  // the primary has its own
+    TEST_ASSERT_FALSE(poller.setFeed(2, secondFeed));
+    TEST_ASSERT_TRUE(poller.setFeed(1, secondFeed));
+
+    clock.advance(1500);
+    poller.beginPeriod(clock.nowMs(), 2000);
+    clock.advance(1000);
+    TEST_ASSERT_TRUE(poller.pollDue(clock.nowMs()));
+    TEST_ASSERT_EQUAL_INT(1, second.readCalls);
+    TEST_ASSERT_EQUAL_INT(1, published);
+    const TimedSoilSnapshot sample = secondFeed.latest();
+    TEST_ASSERT_EQUAL_UINT32(1, sample.sequence);
+    TEST_ASSERT_TRUE(sample.atMs == clock.nowMs());
+    TEST_ASSERT_EQUAL_FLOAT(42.0f, sample.soil.moisture);
+}
+
+void test_budget_and_measured_share()
+{
+    MockSoilSensor probes[SoilPollScheduler::kMaxProbes + 1];
+    gBusUs = 0;
+    SoilPollScheduler poller(9600, &fakeBusTime);
+    for (std::size_t i = 0; i < SoilPollScheduler::kMaxProbes; ++i) {
+        TEST_ASSERT_TRUE(poller.add(static_cast<uint8_t>(i + 1), probes[i]));
+    }
+    TEST_ASSERT_FALSE(poller.add(99, probes[SoilPollScheduler::kMaxProbes]));
+    TEST_ASSERT_EQUAL_size_t(metric::kSoilProbes, poller.size());
+    TEST_ASSERT_EQUAL_UINT8(3, poller.address(2));
+
+    gBusUs = 5000000;  // boot-time traffic is not counted
+    poller.beginPeriod(10000, 10000);
+    SoilBusUsage u = poller.usage();
+    TEST_ASSERT_EQUAL_UINT32(7, u.probes);
+    TEST_ASSERT_EQUAL_UINT32(39583, u.readAirtimeUs);
+    TEST_ASSERT_EQUAL_UINT32(7 * 39583 / 10000, u.budgetPermille);  // 2.7 %
+    TEST_ASSERT_EQUAL_UINT32(0, u.measuredPermille);
+
+    gBusUs += 300000;  // 0.3 s of the next 10 s on the wire
+    poller.beginPeriod(20000, 10000);
+    u = poller.usage();
+    TEST_ASSERT_EQUAL_UINT32(30, u.measuredPermille);
+    TEST_ASSERT_EQUAL_UINT32(6, u.missed);  // nobody polled in between
+}
+
+}  // namespace
+
+void run_soil_poll_scheduler_tests(void)
+{
+    RUN_TEST(test_parse_addresses);
+    RUN_TEST(test_airtime);
+    RUN_TEST(test_probes_are_spread_across_the_period);
+    RUN_TEST(test_cut_off_probe_is_missed);
+    RUN_TEST(test_single_probe_is_never_polled);
+    RUN_TEST(test_zone_probe_read_through_its_feed);
+    RUN_TEST(test_budget_and_measured_share);
+}
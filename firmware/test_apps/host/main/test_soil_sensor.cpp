@@ -144,6 +144,56 @@ static void test_read_is_one_nine_register_transaction(void)
     TEST_ASSERT_TRUE(call.succeeded);
 }
 
+// --------------------------------------------------------------------------
+// Group reads: the fast group is readHoldingRegisters(0x01, 0x0000, 2), the
+// slow group (0x01, 0x0002, 5); each refreshes only its own quantities and
+// read-history flags, and a bad pH fails the slow group alone
+// --------------------------------------------------------------------------
+static void test_group_reads_split_the_transaction(void)
+{
+    Fixture f(goodPayload());
+    f.mock.setRegisters(kAddr, kStartReg, {600, 240});
+    f.mock.setRegisters(kAddr, kRegEc, {900, 95, 50, 31, 121});
+
+    TEST_ASSERT_TRUE(f.sensor.readGroup(SoilReadGroup::Fast));
+    TEST_ASSERT_EQUAL(1, f.mock.calls.size());
+    TEST_ASSERT_EQUAL_UINT16(kStartReg, f.mock.calls[0].startRegister);
+    TEST_ASSERT_EQUAL_UINT16(2, f.mock.calls[0].count);
+    SoilSnapshot s = f.sensor.snapshot();
+    TEST_ASSERT_TRUE(s.readOk);
+    TEST_ASSERT_FALSE(s.slowAvailable);
+    TEST_ASSERT_EQUAL_FLOAT(60.0f, s.moisture);
+    TEST_ASSERT_EQUAL_FLOAT(24.0f, s.temperature);
+    TEST_ASSERT_EQUAL_FLOAT(0.0f, s.ph);
+
+    // pH 9.5 is out of range: the slow group fails, the moisture stands.
+    TEST_ASSERT_FALSE(f.sensor.readGroup(SoilReadGroup::Slow));
+    TEST_ASSERT_EQUAL_UINT16(kRegEc, f.mock.calls[1].startRegister);
+    TEST_ASSERT_EQUAL_UINT16(5, f.mock.calls[1].count);
+    TEST_ASSERT_EQUAL_INT(5, f.sensor.getLastError());
+    s = f.sensor.snapshot();
+    TEST_ASSERT_TRUE(s.readOk);
+    TEST_ASSERT_FALSE(s.slowReadOk);
+    TEST_ASSERT_EQUAL_FLOAT(0.0f, s.ec);
+
+    f.mock.setRegisters(kAddr, kRegEc, {900, 65, 50, 31, 121});
+    TEST_ASSERT_TRUE(f.sensor.readGroup(SoilReadGroup::Slow));
+    s = f.sensor.snapshot();
+    TEST_ASSERT_TRUE(s.slowReadOk);
+    TEST_ASSERT_TRUE(s.slowAvailable);
+    TEST_ASSERT_EQUAL_FLOAT(900.0f, s.ec);
+    TEST_ASSERT_EQUAL_FLOAT(6.5f, s.ph);
+    TEST_ASSERT_EQUAL_FLOAT(121.0f, s.potassium);
+    TEST_ASSERT_EQUAL_FLOAT(60.0f, s.moisture);  // cached from the fast read
+
+    // A failed fast read leaves the slow flags alone.
+    f.mock.queueOutcome(MockModbusClient::kErrTimeout);
+    TEST_ASSERT_FALSE(f.sensor.readGroup(SoilReadGroup::Fast));
+    s = f.sensor.snapshot();
+    TEST_ASSERT_FALSE(s.readOk);
+    TEST_ASSERT_TRUE(s.slowReadOk);
+}
+
 // ==========================================================================
 // Fault paths (T014, US2): timeout / validation / exception / no-retry /
 // recovery / statistics / availability probe / setTimeout contract
@@ -761,6 +811,7 @@ void run_soil_sensor_tests(void)
     RUN_TEST(test_decode_positive_temperature);
     RUN_TEST(test_humidity_equals_moisture);
     RUN_TEST(test_read_is_one_nine_register_transaction);
+    RUN_TEST(test_group_reads_split_the_transaction);
     RUN_TEST(test_timeout_fails_read_and_keeps_last_good_values);
     RUN_TEST(test_out_of_range_moisture_rejected_error5);
     RUN_TEST(test_out_of_range_temperature_rejected_error5);
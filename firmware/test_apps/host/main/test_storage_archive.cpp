@@ -0,0 +1,273 @@
+// SPDX-FileCopyrightText: 2026 Cryptotomte
+// SPDX-License-Identifier: AGPL-3.0-or-later
+/**
+ * @file test_storage_archive.cpp
+ * @brief Host suite for the whole-store archive (api/StorageArchive.h).
+ *
+ * Registered by test_main.cpp via run_storage_archive_tests(). A store
+ * streamed out and restored elsewhere comes back file for file, config
+ * included, and replaces the trees it carries; files outside the data
+ * trees never travel. A corrupted or cut-off archive leaves the target
+ * store untouched, and an entry path outside the data trees is refused.
+ */
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <string>
+#include <vector>
+
+#include <dirent.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include "unity.h"
+
+#include "api/ReadAheadPipe.h"
+#include "api/StorageArchive.h"
+
+using api::ArchiveRestore;
+using api::ArchiveSource;
+using api::IChunkSink;
+using api::IChunkSource;
+using api::RestoreOutcome;
+using api::RestoreReport;
+
+namespace {
+
+class TempDir {
+public:
+    TempDir()
+    {
+        char templ[] = "/tmp/ws_archive_XXXXXX";
+        char* dir = ::mkdtemp(templ);
+        TEST_ASSERT_NOT_NULL_MESSAGE(dir, "mkdtemp failed");
+        path_ = dir;
+    }
+    ~TempDir() { removeTree(path_); }
+    TempDir(const TempDir&) = delete;
+    TempDir& operator=(const TempDir&) = delete;
+
+    const std::string& path() const { return path_; }
+
+private:
+    static void removeTree(const std::string& path)
+    {
+        if (DIR* dir = ::opendir(path.c_str())) {
+            while (const dirent* entry = ::readdir(dir)) {
+                if (std::strcmp(entry->d_name, ".") != 0 &&
+                    std::strcmp(entry->d_name, "..") != 0) {
+                    removeTree(path + "/" + entry->d_name);
+                }
+            }
+            ::closedir(dir);
+            ::rmdir(path.c_str());
+            return;
+        }
+        std::remove(path.c_str());
+    }
+
+    std::string path_;
+};
+
+/// Write @p body to @p base/@p rel, creating the directories on the way.
+void putFile(const std::string& base, const std::string& rel, const std::string& body)
+{
+    const std::string path = base + "/" + rel;
+    for (std::size_t slash = path.find('/', base.size() + 1); slash != std::string::npos;
+         slash = path.find('/', slash + 1)) {
+        ::mkdir(path.substr(0, slash).c_str(), 0775);
+    }
+    FILE* f = std::fopen(path.c_str(), "wb");
+    TEST_ASSERT_NOT_NULL(f);
+    std::fwrite(body.data(), 1, body.size(), f);
+    std::fclose(f);
+}
+
+/// The contents of @p path, or "<missing>".
+std::string getFile(const std::string& path)
+{
+    FILE* f = std::fopen(path.c_str(), "rb");
+    if (f == nullptr) {
+        return "<missing>";
+    }
+    std::string body;
+    char buf[512];
+    std::size_t n;
+    while ((n = std::fread(buf, 1, sizeof(buf), f)) > 0) {
+        body.append(buf, n);
+    }
+    std::fclose(f);
+    return body;
+}
+
+bool exists(const std::string& path)
+{
+    struct stat st;
+    return ::stat(path.c_str(), &st) == 0;
+}
+
+std::string pattern(std::size_t len, uint32_t seed)
+{
+    std::string body(len, '\0');
+    for (char& c : body) {
+        seed = seed * 1664525u + 1013904223u;
+        c = static_cast<char>(seed >> 24);
+    }
+    return body;
+}
+
+struct BytesSink : IChunkSink {
+    std::vector<uint8_t> bytes;
+
+    bool send(const char* data, std::size_t len) override
+    {
+        bytes.insert(bytes.end(), data, data + len);
+        return true;
+    }
+};
+
+/// @p bytes in pieces of at most @p piece, like a socket.
+class BytesSource : public IChunkSource {
+public:
+    BytesSource(const std::vector<uint8_t>& bytes, std::size_t piece)
+        : bytes_(bytes), piece_(piece)
+    {
+    }
+
+    int receive(uint8_t* dst, std::size_t len) override
+    {
+        const std::size_t n = std::min({len, piece_, bytes_.size() - pos_});
+        std::memcpy(dst, bytes_.data() + pos_, n);
+        pos_ += n;
+        return static_cast<int>(n);
+    }
+
+private:
+    const std::vector<uint8_t>& bytes_;
+    std::size_t piece_;
+    std::size_t pos_ = 0;
+};
+
+const char kConfig[] = "{\"success\":true,\"wateringDurationS\":30}";
+
+/// A small store: two metrics, both event files, a web asset and a .tmp.
+void fillStore(const std::string& base)
+{
+    putFile(base, "hist/moisture/1700000000.dat", pattern(5000, 1));
+    putFile(base, "hist/moisture/1700040000.dz", pattern(777, 2));
+    putFile(base, "hist/temperature/1700000000.dat", pattern(1600, 3));
+    putFile(base, "hist/temperature/1700090000.dat.tmp", pattern(16, 4));
+    putFile(base, "events/0.log", pattern(3000, 5));
+    putFile(base, "events/1.log", "");
+    putFile(base, "www/index.html", "<html>");
+}
+
+std::vector<uint8_t> archiveOf(const std::string& base, std::size_t bufBytes)
+{
+    ArchiveSource source(base, kConfig);
+    TEST_ASSERT_EQUAL_UINT32(5, source.files());
+    TEST_ASSERT_EQUAL_UINT32(5000 + 777 + 1600 + 3000, static_cast<uint32_t>(source.fileBytes()));
+    BytesSink sink;
+    std::vector<uint8_t> buf(bufBytes);
+    TEST_ASSERT_TRUE(api::copyChunks(source, sink, buf.data(), buf.size()) ==
+                     api::PumpOutcome::Ok);
+    return sink.bytes;
+}
+
+void test_archive_round_trip(void)
+{
+    TempDir from;
+    fillStore(from.path());
+    // An odd buffer size: framing and data straddle every boundary.
+    const std::vector<uint8_t> archive = archiveOf(from.path(), 333);
+    TEST_ASSERT_EQUAL_MEMORY("WSA1", archive.data(), 4);
+    TEST_ASSERT_TRUE(archive == archiveOf(from.path(), 2048));
+
+    TempDir to;
+    putFile(to.path(), "hist/old/1600000000.dat", "stale");
+    putFile(to.path(), "rows/metrics", "stale");
+    putFile(to.path(), "www/app.js", "kept");
+    BytesSource source(archive, 1000);
+    const RestoreReport report = ArchiveRestore(to.path()).run(source);
+    TEST_ASSERT_TRUE(report.outcome == RestoreOutcome::Ok);
+    TEST_ASSERT_EQUAL_UINT32(5, report.files);
+    TEST_ASSERT_EQUAL_STRING(kConfig, report.config.c_str());
+
+    for (const char* rel : {"hist/moisture/1700000000.dat", "hist/moisture/1700040000.dz",
+                            "hist/temperature/1700000000.dat", "events/0.log",
+                            "events/1.log"}) {
+        TEST_ASSERT_TRUE_MESSAGE(getFile(from.path() + "/" + rel) ==
+                                     getFile(to.path() + "/" + rel),
+                                 rel);
+    }
+    // The store is the archive's; the rest of the volume is left alone.
+    TEST_ASSERT_FALSE(exists(to.path() + "/hist/old"));
+    TEST_ASSERT_FALSE(exists(to.path() + "/rows"));
+    TEST_ASSERT_FALSE(exists(to.path() + "/hist/temperature/1700090000.dat.tmp"));
+    TEST_ASSERT_FALSE(exists(to.path() + "/www/index.html"));
+    TEST_ASSERT_EQUAL_STRING("kept", getFile(to.path() + "/www/app.js").c_str());
+    TEST_ASSERT_FALSE(exists(to.path() + "/" + api::kArchiveStagingDir));
+}
+
+void test_bad_archive_leaves_store(void)
+{
+    TempDir from;
+    fillStore(from.path());
+    const std::vector<uint8_t> archive = archiveOf(from.path(), 1024);
+
+    TempDir to;
+    putFile(to.path(), "hist/old/1600000000.dat", "live");
+
+    std::vector<uint8_t> corrupt = archive;
+    corrupt[corrupt.size() / 2] ^= 0x01;  // inside a file's data: its CRC fails
+    BytesSource bad(corrupt, 512);
+    TEST_ASSERT_TRUE(ArchiveRestore(to.path()).run(bad).outcome == RestoreOutcome::BadArchive);
+
+    const std::vector<uint8_t> cut(archive.begin(), archive.end() - 3);
+    BytesSource torn(cut, 512);
+    const RestoreReport report = ArchiveRestore(to.path()).run(torn);
+    TEST_ASSERT_TRUE(report.outcome == RestoreOutcome::ReceiveFailed);
+    TEST_ASSERT_TRUE(report.config.empty());
+
+    TEST_ASSERT_EQUAL_STRING("live", getFile(to.path() + "/hist/old/1600000000.dat").c_str());
+    TEST_ASSERT_FALSE(exists(to.path() + "/events"));
+    TEST_ASSERT_FALSE(exists(to.path() + "/" + api::kArchiveStagingDir));
+}
+
+void test_entry_paths_stay_in_the_trees(void)
+{
+    TEST_ASSERT_TRUE(api::archivePathValid("hist/moisture/1700000000.dat"));
+    TEST_ASSERT_TRUE(api::archivePathValid("events/0.log"));
+    TEST_ASSERT_FALSE(api::archivePathValid("www/index.html"));
+    TEST_ASSERT_FALSE(api::archivePathValid("tls/key.pem"));
+    TEST_ASSERT_FALSE(api::archivePathValid("hist"));
+    TEST_ASSERT_FALSE(api::archivePathValid("/hist/a"));
+    TEST_ASSERT_FALSE(api::archivePathValid("hist//a"));
+    TEST_ASSERT_FALSE(api::archivePathValid("hist/../tls/key.pem"));
+    TEST_ASSERT_FALSE(api::archivePathValid("hist/a/"));
+    TEST_ASSERT_FALSE(api::archivePathValid("hist/" + std::string(api::kArchiveMaxPath, 'a')));
+
+    // An archive naming a path outside them is refused whole.
+    std::vector<uint8_t> archive = {'W', 'S', 'A', '1', 'F', 6, 0};
+    for (char c : std::string("www/x1")) {
+        archive.push_back(static_cast<uint8_t>(c));
+    }
+    archive.insert(archive.end(), {0, 0, 0, 0, 0, 0, 0, 0, 'Z', 1, 0, 0, 0});
+    TempDir to;
+    BytesSource source(archive, 64);
+    TEST_ASSERT_TRUE(ArchiveRestore(to.path()).run(source).outcome ==
+                     RestoreOutcome::BadArchive);
+    TEST_ASSERT_FALSE(exists(to.path() + "/www"));
+}
+
+}  // namespace
+
+void run_storage_archive_tests(void)
+{
+    RUN_TEST(test_archive_round_trip);
+    RUN_TEST(test_bad_archive_leaves_store);
+    RUN_TEST(test_entry_paths_stay_in_the_trees);
+}
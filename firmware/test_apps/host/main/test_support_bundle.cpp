@@ -0,0 +1,149 @@
+// SPDX-FileCopyrightText: 2026 Cryptotomte
+// SPDX-License-Identifier: AGPL-3.0-or-later
+/**
+ * @file test_support_bundle.cpp
+ * @brief Host suite for the GET /api/v1/support-bundle framing
+ *        (api/SupportBundle.h).
+ *
+ * Registered by test_main.cpp via run_support_bundle_tests(). Sections
+ * frame as documented (a missing final newline supplied, absent sections
+ * named, the end line counting them); a large streamed section goes
+ * through the gzip encoder in encoder-sized chunks without an allocation;
+ * and a client that goes away stops the bundle.
+ */
+
+#include <cstdint>
+#include <string>
+
+#include "unity.h"
+
+#include "alloc_tracker.h"
+#include "api/Deflate.h"
+#include "api/SupportBundle.h"
+
+namespace {
+
+using api::SupportBundleWriter;
+
+class StringSink final : public api::IChunkSink {
+public:
+    bool send(const char* data, std::size_t len) override
+    {
+        if (failAfter != 0 && body.size() + len > failAfter) {
+            return false;
+        }
+        body.append(data, len);
+        largest = len > largest ? len : largest;
+        return true;
+    }
+    std::string body;
+    std::size_t largest = 0;
+    std::size_t failAfter = 0;  ///< fail the send that would pass this; 0 = never
+};
+
+uint32_t le32(const std::string& s, std::size_t at)
+{
+    return static_cast<uint32_t>(static_cast<uint8_t>(s[at])) |
+           static_cast<uint32_t>(static_cast<uint8_t>(s[at + 1])) << 8 |
+           static_cast<uint32_t>(static_cast<uint8_t>(s[at + 2])) << 16 |
+           static_cast<uint32_t>(static_cast<uint8_t>(s[at + 3])) << 24;
+}
+
+/// One Prometheus-like line per call, as streamMetrics() sends them.
+std::string metricLine(int i)
+{
+    return "ws_task_stack_free_bytes{task=\"task" + std::to_string(i % 24) + "\"} " +
+           std::to_string(1000 + i % 977) + "\n";
+}
+
+void test_sections_frame_as_documented(void)
+{
+    StringSink sink;
+    SupportBundleWriter bundle(sink);
+    TEST_ASSERT_TRUE(bundle.section("status", "application/json", "{\"success\":true}"));
+    TEST_ASSERT_TRUE(bundle.section("metrics", "text/plain"));
+    TEST_ASSERT_TRUE(bundle.send("# HELP a\n", 9));
+    TEST_ASSERT_TRUE(bundle.send("a 1\n", 4));
+    TEST_ASSERT_TRUE(bundle.absent("logs", "not enabled"));
+    TEST_ASSERT_TRUE(bundle.section("config", "application/json", ""));
+    TEST_ASSERT_TRUE(bundle.finish());
+
+    const std::string expected = std::string(api::kSupportBundleMagic) +
+                                 "=== status application/json\n"
+                                 "{\"success\":true}\n"
+                                 "=== metrics text/plain\n"
+                                 "# HELP a\n"
+                                 "a 1\n"
+                                 "=== logs absent: not enabled\n"
+                                 "=== config application/json\n"
+                                 "=== end 4\n";
+    TEST_ASSERT_EQUAL_STRING(expected.c_str(), sink.body.c_str());
+    TEST_ASSERT_EQUAL_UINT32(4, bundle.sections());
+    TEST_ASSERT_TRUE(bundle.bytes() == sink.body.size());
+}
+
+void test_streamed_section_gzips_in_bounded_chunks(void)
+{
+    StringSink plain;
+    StringSink gz;
+    api::DeflateSink gzip(gz, api::ContentEncoding::Gzip);
+    std::string lines;
+    for (int i = 0; i < 8000; ++i) {
+        lines += metricLine(i);
+    }
+    // What the handler streams: the writer over the encoder, a line per
+    // send. A plain copy checks the trailer below.
+    SupportBundleWriter reference(plain);
+    reference.section("metrics", "text/plain", lines);
+    reference.absent("control-trace", "not enabled");
+    reference.finish();
+    gz.body.reserve(plain.body.size());  // the test sink's growth is not the bundle's
+    SupportBundleWriter bundle(gzip);
+    EXPECT_NO_ALLOC
+    {
+        bundle.section("metrics", "text/plain");
+        for (std::size_t at = 0; at < lines.size();) {
+            const std::size_t end = lines.find('\n', at) + 1;
+            bundle.send(lines.data() + at, end - at);
+            at = end;
+        }
+        bundle.absent("control-trace", "not enabled");
+        TEST_ASSERT_TRUE(bundle.finish());
+    }
+    TEST_ASSERT_TRUE(gzip.finish());
+    TEST_ASSERT_TRUE(plain.body.size() > 200000);
+
+    TEST_ASSERT_EQUAL_HEX8(0x1f, static_cast<uint8_t>(gz.body[0]));
+    TEST_ASSERT_EQUAL_HEX8(0x8b, static_cast<uint8_t>(gz.body[1]));
+    const std::size_t n = gz.body.size();
+    TEST_ASSERT_EQUAL_HEX32(api::crc32Update(0, plain.body.data(), plain.body.size()),
+                            le32(gz.body, n - 8));
+    TEST_ASSERT_EQUAL_UINT32(plain.body.size(), le32(gz.body, n - 4));
+    TEST_ASSERT_TRUE(n * 4 < plain.body.size());
+    // The encoder forwards its ChunkWriter's buffer, never the body.
+    TEST_ASSERT_TRUE(gz.largest <= api::ChunkWriter::kBufferBytes);
+}
+
+void test_client_gone_stops_the_bundle(void)
+{
+    StringSink sink;
+    sink.failAfter = 64;
+    SupportBundleWriter bundle(sink);
+    TEST_ASSERT_TRUE(bundle.section("status", "application/json", "{}"));
+    TEST_ASSERT_FALSE(bundle.section("events", "application/json", std::string(100, 'x')));
+    TEST_ASSERT_FALSE(bundle.ok());
+    const std::size_t sent = sink.body.size();
+    TEST_ASSERT_FALSE(bundle.absent("logs", "not enabled"));
+    TEST_ASSERT_FALSE(bundle.finish());
+    TEST_ASSERT_EQUAL_size_t(sent, sink.body.size());
+    TEST_ASSERT_TRUE(bundle.bytes() == sent);
+}
+
+}  // namespace
+
+void run_support_bundle_tests(void)
+{
+    RUN_TEST(test_sections_frame_as_documented);
+    RUN_TEST(test_streamed_section_gzips_in_bounded_chunks);
+    RUN_TEST(test_client_gone_stops_the_bundle);
+}
@@ -0,0 +1,140 @@
+// SPDX-FileCopyrightText: 2026 Cryptotomte
+// SPDX-License-Identifier: AGPL-3.0-or-later
+/**
+ * @file test_synthetic_sensors.cpp
+ * @brief Host suite for the soak-mode signal generators
+ *        (SyntheticSensors.h).
+ *
+ * Registered by test_main.cpp via run_synthetic_sensors_tests(). Soil
+ * moisture sweeps across the default thresholds within one accelerated
+ * day; scripted failures keep the last good values with the drivers'
+ * error codes; group reads refresh only their group; a seed reproduces
+ * its stream; the pump current follows the pump.
+ */
+
+#include <cstdint>
+
+#include "unity.h"
+
+#include "actuators/testing/FakeTimeProvider.h"
+#include "actuators/testing/MockWaterPump.h"
+#include "sensors/SyntheticSensors.h"
+
+namespace {
+
+void test_soil_moisture_crosses_the_default_thresholds(void)
+{
+    FakeTimeProvider clock(0);
+    SyntheticSoilSensor soil(clock, SyntheticSettings{60, 0, 1});
+    float low = 100.0f;
+    float high = 0.0f;
+    // One simulated day = 24 min at 60x, read every 5 s.
+    for (int i = 0; i < 24 * 60 / 5; ++i) {
+        clock.advance(5000);
+        TEST_ASSERT_TRUE(soil.read());
+        const SoilSnapshot s = soil.snapshot();
+        TEST_ASSERT_TRUE(s.readOk && s.slowReadOk);
+        low = s.moisture < low ? s.moisture : low;
+        high = s.moisture > high ? s.moisture : high;
+        TEST_ASSERT_FLOAT_WITHIN(16.0f, 40.0f, s.moisture);
+        TEST_ASSERT_EQUAL_FLOAT(s.moisture, s.humidity);
+    }
+    TEST_ASSERT_TRUE(low < 30.0f);
+    TEST_ASSERT_TRUE(high > 50.0f);
+}
+
+void test_scripted_failure_keeps_last_good_values(void)
+{
+    FakeTimeProvider clock(0);
+    SyntheticSoilSensor soil(clock, SyntheticSettings{60, 3, 1});
+    SyntheticEnvironmentalSensor env(clock, SyntheticSettings{60, 3, 2});
+    for (int i = 0; i < 2; ++i) {
+        clock.advance(1000);
+        TEST_ASSERT_TRUE(soil.read());
+        TEST_ASSERT_TRUE(env.read());
+    }
+    const float moisture = soil.getMoisture();
+    const float temperature = env.getTemperature();
+    clock.advance(1000);
+    TEST_ASSERT_FALSE(soil.read());
+    TEST_ASSERT_FALSE(env.read());
+    TEST_ASSERT_EQUAL_INT(SyntheticSoilSensor::kFailError, soil.getLastError());
+    TEST_ASSERT_EQUAL_INT(SyntheticEnvironmentalSensor::kFailError, env.getLastError());
+    TEST_ASSERT_EQUAL_FLOAT(moisture, soil.getMoisture());
+    TEST_ASSERT_EQUAL_FLOAT(temperature, env.getTemperature());
+    const SoilSnapshot s = soil.snapshot();
+    TEST_ASSERT_FALSE(s.readOk);
+    TEST_ASSERT_TRUE(s.available);
+    TEST_ASSERT_FALSE(env.snapshot().valid);
+    TEST_ASSERT_EQUAL_UINT32(2, env.snapshot().sequence);
+
+    clock.advance(1000);
+    TEST_ASSERT_TRUE(soil.read());
+    TEST_ASSERT_EQUAL_INT(0, soil.getLastError());
+}
+
+void test_group_reads_refresh_their_group_only(void)
+{
+    FakeTimeProvider clock(0);
+    SyntheticSoilSensor soil(clock, SyntheticSettings{60, 0, 1});
+    clock.advance(1000);
+    TEST_ASSERT_TRUE(soil.readGroup(SoilReadGroup::Fast));
+    SoilSnapshot s = soil.snapshot();
+    TEST_ASSERT_TRUE(s.available);
+    TEST_ASSERT_FALSE(s.slowAvailable);
+
+    const float moisture = s.moisture;
+    clock.advance(60'000);
+    TEST_ASSERT_TRUE(soil.readGroup(SoilReadGroup::Slow));
+    s = soil.snapshot();
+    TEST_ASSERT_TRUE(s.slowAvailable);
+    TEST_ASSERT_EQUAL_FLOAT(moisture, s.moisture);
+    TEST_ASSERT_FLOAT_WITHIN(0.3f, 6.5f, s.ph);
+}
+
+void test_seed_reproduces_its_stream(void)
+{
+    FakeTimeProvider clock(0);
+    SyntheticEnvironmentalSensor a(clock, SyntheticSettings{60, 0, 7});
+    SyntheticEnvironmentalSensor b(clock, SyntheticSettings{60, 0, 7});
+    SyntheticEnvironmentalSensor c(clock, SyntheticSettings{60, 0, 8});
+    bool differs = false;
+    for (int i = 0; i < 10; ++i) {
+        clock.advance(5000);
+        TEST_ASSERT_TRUE(a.read() && b.read() && c.read());
+        TEST_ASSERT_EQUAL_FLOAT(a.getPressure(), b.getPressure());
+        differs = differs || a.getPressure() != c.getPressure();
+    }
+    TEST_ASSERT_TRUE(differs);
+}
+
+void test_power_follows_the_pump(void)
+{
+    FakeTimeProvider clock(0);
+    MockWaterPump pump("plant", clock);
+    TEST_ASSERT_TRUE(pump.initialize());
+    SyntheticPowerSensor power(clock, SyntheticSettings{60, 0, 1}, &pump);
+
+    clock.advance(1000);
+    TEST_ASSERT_TRUE(power.read());
+    TEST_ASSERT_TRUE(power.getCurrent() < 0.01f);
+    TEST_ASSERT_TRUE(pump.runFor(10));
+    clock.advance(1000);
+    TEST_ASSERT_TRUE(power.read());
+    const PowerSnapshot s = power.snapshot();
+    TEST_ASSERT_TRUE(s.valid);
+    TEST_ASSERT_FLOAT_WITHIN(0.05f, SyntheticPowerSensor::kRunningA, s.current);
+    TEST_ASSERT_FLOAT_WITHIN(0.01f, s.busVoltage * s.current, s.power);
+    TEST_ASSERT_EQUAL_INT64(clock.nowMs(), s.atMs);
+}
+
+}  // namespace
+
+void run_synthetic_sensors_tests(void)
+{
+    RUN_TEST(test_soil_moisture_crosses_the_default_thresholds);
+    RUN_TEST(test_scripted_failure_keeps_last_good_values);
+    RUN_TEST(test_group_reads_refresh_their_group_only);
+    RUN_TEST(test_seed_reproduces_its_stream);
+    RUN_TEST(test_power_follows_the_pump);
+}
@@ -0,0 +1,178 @@
+// SPDX-FileCopyrightText: 2026 Cryptotomte
+// SPDX-License-Identifier: AGPL-3.0-or-later
+/**
+ * @file test_task_telemetry.cpp
+ * @brief Host suite for the per-task CPU/stack and heap telemetry
+ *        (interfaces/TaskTelemetry.h) and its /metrics block.
+ *
+ * Registered by test_main.cpp via run_task_telemetry_tests(). A task's CPU
+ * share is its run-time counter delta over the window's, per mille of one
+ * core; the first sample and a task new since the last one count from zero;
+ * the counters may wrap; tasks come out busiest first with sanitized names
+ * and tasks past kMaxTasks are counted, not kept. The metrics body carries a
+ * ratio and a stack gauge per task and the heaps a board has.
+ */
+
+#include <string>
+
+#include "unity.h"
+
+#include "api/ApiMetrics.h"
+#include "interfaces/TaskTelemetry.h"
+
+namespace {
+
+using Heaps = std::array<HeapCapsStats, kHeapCapsCount>;
+
+TaskCounters task(uint32_t id, const char* name, uint32_t runTime,
+                  uint32_t stackFree = 1000)
+{
+    TaskCounters t;
+    t.id = id;
+    t.name = name;
+    t.runTime = runTime;
+    t.stackFreeBytes = stackFree;
+    return t;
+}
+
+const TaskLoad* find(const TelemetrySnapshot& snap, const char* name)
+{
+    for (std::size_t i = 0; i < snap.taskCount; ++i) {
+        if (std::string(snap.tasks[i].name) == name) {
+            return &snap.tasks[i];
+        }
+    }
+    return nullptr;
+}
+
+void test_unsampled_snapshot_is_empty(void)
+{
+    TaskTelemetry telemetry;
+    TelemetrySnapshot snap;
+    telemetry.snapshot(snap);
+    TEST_ASSERT_EQUAL_UINT32(0, snap.samples);
+    TEST_ASSERT_EQUAL_UINT8(0, snap.taskCount);
+}
+
+void test_shares_are_deltas_over_the_window(void)
+{
+    TaskTelemetry telemetry;
+    Heaps heaps{};
+    heaps[0].totalBytes = 300'000;
+    heaps[0].freeBytes = 120'000;
+
+    // First sample: the average since boot.
+    TaskCounters first[] = {task(1, "IDLE0", 900'000), task(2, "watering", 100'000, 812)};
+    telemetry.update(first, 2, 1'000'000, heaps, 5000);
+    TelemetrySnapshot snap;
+    telemetry.snapshot(snap);
+    TEST_ASSERT_EQUAL_UINT32(1, snap.samples);
+    TEST_ASSERT_EQUAL_UINT32(1'000'000, snap.windowUs);
+    TEST_ASSERT_EQUAL_UINT8(2, snap.taskCount);
+    TEST_ASSERT_EQUAL_STRING("IDLE0", snap.tasks[0].name);
+    TEST_ASSERT_EQUAL_UINT16(900, snap.tasks[0].cpuPermille);
+    TEST_ASSERT_EQUAL_UINT16(100, snap.tasks[1].cpuPermille);
+    TEST_ASSERT_EQUAL_UINT32(812, snap.tasks[1].stackFreeBytes);
+    TEST_ASSERT_EQUAL_UINT32(120'000, snap.heaps[0].freeBytes);
+
+    // Next window: the watering task got busy, a new task appeared.
+    TaskCounters second[] = {task(1, "IDLE0", 1'100'000), task(2, "watering", 800'000),
+                             task(7, "httpd", 100'000)};
+    telemetry.update(second, 3, 2'000'000, heaps, 10'000);
+    telemetry.snapshot(snap);
+    TEST_ASSERT_EQUAL_UINT32(2, snap.samples);
+    TEST_ASSERT_EQUAL_STRING("watering", snap.tasks[0].name);
+    TEST_ASSERT_EQUAL_UINT16(700, snap.tasks[0].cpuPermille);
+    TEST_ASSERT_EQUAL_UINT16(200, find(snap, "IDLE0")->cpuPermille);
+    TEST_ASSERT_EQUAL_UINT16(100, find(snap, "httpd")->cpuPermille);
+}
+
+void test_wrapped_counters_and_clamped_share(void)
+{
+    TaskTelemetry telemetry;
+    const Heaps heaps{};
+    TaskCounters before[] = {task(3, "sensor", 0xFFFF'0000u)};
+    telemetry.update(before, 1, 0xFFFF'0000u, heaps, 0);
+
+    // Both counters wrapped: 0x20000 of 0x20000 run, and a counter running
+    // ahead of the total (two cores' worth) is clamped to one core.
+    TaskCounters after[] = {task(3, "sensor", 0x0001'0000u), task(4, "spin", 0x0004'0000u)};
+    telemetry.update(after, 2, 0x0001'0000u, heaps, 1000);
+    TelemetrySnapshot snap;
+    telemetry.snapshot(snap);
+    TEST_ASSERT_EQUAL_UINT32(0x20000u, snap.windowUs);
+    TEST_ASSERT_EQUAL_UINT16(1000, find(snap, "sensor")->cpuPermille);
+    TEST_ASSERT_EQUAL_UINT16(1000, find(snap, "spin")->cpuPermille);
+}
+
+void test_names_are_sanitized_and_overflow_counted(void)
+{
+    TaskTelemetry telemetry;
+    TaskCounters tasks[TelemetrySnapshot::kMaxTasks + 3];
+    for (std::size_t i = 0; i < TelemetrySnapshot::kMaxTasks + 3; ++i) {
+        tasks[i] = task(static_cast<uint32_t>(i + 1), "t", 0);
+    }
+    tasks[0].name = "a\"b\\c-too-long-for-it";
+    telemetry.update(tasks, TelemetrySnapshot::kMaxTasks + 3, 1000, Heaps{}, 0);
+    TelemetrySnapshot snap;
+    telemetry.snapshot(snap);
+    TEST_ASSERT_EQUAL_UINT8(TelemetrySnapshot::kMaxTasks, snap.taskCount);
+    TEST_ASSERT_EQUAL_UINT8(3, snap.tasksDropped);
+    TEST_ASSERT_EQUAL_STRING("a_b_c-too-long-", snap.tasks[0].name);
+}
+
+struct StringSink final : api::IChunkSink {
+    std::string body;
+
+    bool send(const char* data, std::size_t len) override
+    {
+        body.append(data, len);
+        return true;
+    }
+};
+
+bool contains(const std::string& body, const char* text)
+{
+    return body.find(text) != std::string::npos;
+}
+
+void test_metrics_block_only_when_set(void)
+{
+    api::HttpMetrics metrics;
+    StringSink plain;
+    TEST_ASSERT_TRUE(api::streamMetrics(metrics.snapshot(), api::SystemMetricsDto{}, plain));
+    TEST_ASSERT_FALSE(contains(plain.body, "task_cpu_ratio"));
+
+    api::SystemMetricsDto sys;
+    sys.hasTasks = true;
+    sys.taskWindowUs = 5'000'000;
+    sys.tasks.push_back(api::TaskMetricsDto{"watering_task", 42, 1320, 5, 1});
+    sys.tasks.push_back(api::TaskMetricsDto{"httpd", 1000, 900, 5, -1});
+    sys.heaps.push_back(api::HeapCapsDto{"internal", 300'000, 120'000, 98'000, 65'536});
+    StringSink sink;
+    TEST_ASSERT_TRUE(api::streamMetrics(metrics.snapshot(), sys, sink));
+    TEST_ASSERT_TRUE(contains(sink.body,
+        "wateringsystem_task_cpu_ratio{task=\"watering_task\",core=\"1\"} 0.042\n"));
+    TEST_ASSERT_TRUE(contains(sink.body,
+        "wateringsystem_task_cpu_ratio{task=\"httpd\",core=\"any\"} 1.000\n"));
+    TEST_ASSERT_TRUE(contains(sink.body,
+        "wateringsystem_task_stack_free_bytes{task=\"watering_task\"} 1320\n"));
+    TEST_ASSERT_TRUE(contains(sink.body,
+        "wateringsystem_task_telemetry_window_seconds 5.000000\n"));
+    TEST_ASSERT_TRUE(contains(sink.body,
+        "wateringsystem_heap_caps_min_free_bytes{caps=\"internal\"} 98000\n"));
+    TEST_ASSERT_TRUE(contains(sink.body,
+        "wateringsystem_heap_caps_largest_free_block_bytes{caps=\"internal\"} 65536\n"));
+    TEST_ASSERT_FALSE(contains(sink.body, "caps=\"psram\""));
+}
+
+}  // namespace
+
+void run_task_telemetry_tests(void)
+{
+    RUN_TEST(test_unsampled_snapshot_is_empty);
+    RUN_TEST(test_shares_are_deltas_over_the_window);
+    RUN_TEST(test_wrapped_counters_and_clamped_share);
+    RUN_TEST(test_names_are_sanitized_and_overflow_counted);
+    RUN_TEST(test_metrics_block_only_when_set);
+}
@@ -0,0 +1,201 @@
+// SPDX-FileCopyrightText: 2026 Cryptotomte
+// SPDX-License-Identifier: AGPL-3.0-or-later
+/**
+ * @file test_tick_latency.cpp
+ * @brief Host suite for the watering-tick phase timing
+ *        (interfaces/TickLatency.h) and its /metrics block.
+ *
+ * Registered by test_main.cpp via run_tick_latency_tests(). A tick's time
+ * is charged to the phase in effect, a TickPhaseScope returning to the one
+ * it interrupted; end() reports a tick over the budget once per bucket it
+ * reaches; nothing is recorded without a clock.
+ */
+
+#include <cstdint>
+#include <string>
+
+#include "unity.h"
+
+#include "api/ApiMetrics.h"
+#include "interfaces/TickLatency.h"
+
+namespace {
+
+int64_t g_nowUs = 0;
+
+int64_t fakeNowUs()
+{
+    return g_nowUs;
+}
+
+void test_buckets_double_from_250_us(void)
+{
+    TEST_ASSERT_EQUAL_size_t(0, TickLatency::bucketOf(0));
+    TEST_ASSERT_EQUAL_size_t(0, TickLatency::bucketOf(249));
+    TEST_ASSERT_EQUAL_size_t(1, TickLatency::bucketOf(250));
+    TEST_ASSERT_EQUAL_size_t(3, TickLatency::bucketOf(1'500));    // 1..2 ms
+    TEST_ASSERT_EQUAL_size_t(11, TickLatency::bucketOf(256'000));
+    TEST_ASSERT_EQUAL_size_t(11, TickLatency::bucketOf(UINT32_MAX));
+}
+
+void test_scopes_charge_their_phase(void)
+{
+    TickLatency latency;
+    latency.install(fakeNowUs, 0);
+    g_nowUs = 1'000'000;
+    latency.begin();
+    g_nowUs += 100;  // decision
+    {
+        TickPhaseScope read(&latency, TickPhase::SensorRead);
+        g_nowUs += 3'000;
+    }
+    g_nowUs += 200;  // decision again
+    {
+        TickPhaseScope log(&latency, TickPhase::Logging);
+        g_nowUs += 1'000;
+        {
+            TickPhaseScope event(&latency, TickPhase::Events);
+            g_nowUs += 500;
+        }
+        g_nowUs += 1'000;  // back in logging
+    }
+    uint32_t tickUs = 0;
+    TickPhase slowest = TickPhase::Decision;
+    TEST_ASSERT_FALSE(latency.end(tickUs, slowest));  // no budget
+    TEST_ASSERT_EQUAL_UINT32(5'800, tickUs);
+    TEST_ASSERT_EQUAL_UINT8(static_cast<uint8_t>(TickPhase::SensorRead),
+                            static_cast<uint8_t>(slowest));
+
+    const TickLatencyStats s = latency.snapshot();
+    TEST_ASSERT_EQUAL_UINT32(1, s.ticks);
+    TEST_ASSERT_EQUAL_UINT32(5'800, s.tick.sumUs);
+    TEST_ASSERT_EQUAL_UINT32(5'800, s.tick.maxUs);
+    TEST_ASSERT_EQUAL_UINT32(3'000, s.phases[0].sumUs);  // sensor_read
+    TEST_ASSERT_EQUAL_UINT32(300, s.phases[1].sumUs);    // decision
+    TEST_ASSERT_EQUAL_UINT32(2'000, s.phases[2].sumUs);  // logging
+    TEST_ASSERT_EQUAL_UINT32(500, s.phases[3].sumUs);    // events
+    TEST_ASSERT_EQUAL_UINT32(1, s.phases[1].buckets[TickLatency::bucketOf(300)]);
+    TEST_ASSERT_EQUAL_UINT32(1, s.tick.buckets[TickLatency::bucketOf(5'800)]);
+
+    // A phase a tick never entered still counts that tick, at 0.
+    latency.begin();
+    g_nowUs += 50;
+    TEST_ASSERT_FALSE(latency.end(tickUs, slowest));
+    const TickLatencyStats again = latency.snapshot();
+    TEST_ASSERT_EQUAL_UINT32(2, again.ticks);
+    TEST_ASSERT_EQUAL_UINT32(1, again.phases[0].buckets[0]);
+    TEST_ASSERT_EQUAL_UINT32(5'800, again.tick.maxUs);
+}
+
+void test_warns_once_per_bucket_over_the_budget(void)
+{
+    TickLatency latency;
+    latency.install(fakeNowUs, 20'000);  // 20 ms
+    uint32_t tickUs = 0;
+    TickPhase slowest = TickPhase::Decision;
+    const auto tick = [&](int64_t us) {
+        latency.begin();
+        TickPhaseScope log(&latency, TickPhase::Logging);
+        g_nowUs += us;
+        return latency.end(tickUs, slowest);
+    };
+
+    TEST_ASSERT_FALSE(tick(15'000));  // within budget
+    TEST_ASSERT_TRUE(tick(40'000));   // 32..64 ms: first report
+    TEST_ASSERT_EQUAL_UINT32(40'000, tickUs);
+    TEST_ASSERT_EQUAL_UINT8(static_cast<uint8_t>(TickPhase::Logging),
+                            static_cast<uint8_t>(slowest));
+    TEST_ASSERT_FALSE(tick(50'000));  // same bucket: counted, not reported
+    TEST_ASSERT_FALSE(tick(25'000));  // lower bucket
+    TEST_ASSERT_TRUE(tick(100'000));  // 64..128 ms
+    const TickLatencyStats s = latency.snapshot();
+    TEST_ASSERT_EQUAL_UINT32(5, s.ticks);
+    TEST_ASSERT_EQUAL_UINT32(4, s.overBudget);
+    TEST_ASSERT_EQUAL_UINT32(20'000, s.budgetUs);
+}
+
+void test_nothing_is_recorded_without_a_clock(void)
+{
+    TickLatency latency;
+    latency.begin();
+    TickPhaseScope read(&latency, TickPhase::SensorRead);
+    TickPhaseScope unmonitored(nullptr, TickPhase::Events);
+    uint32_t tickUs = 1;
+    TickPhase slowest = TickPhase::Events;
+    TEST_ASSERT_FALSE(latency.end(tickUs, slowest));
+    TEST_ASSERT_EQUAL_UINT32(0, tickUs);
+    TEST_ASSERT_EQUAL_UINT32(0, latency.snapshot().ticks);
+}
+
+struct StringSink final : api::IChunkSink {
+    std::string body;
+
+    bool send(const char* data, std::size_t len) override
+    {
+        body.append(data, len);
+        return true;
+    }
+};
+
+bool contains(const std::string& body, const char* text)
+{
+    return body.find(text) != std::string::npos;
+}
+
+void test_metrics_block_only_when_set(void)
+{
+    api::HttpMetrics metrics;
+    StringSink plain;
+    TEST_ASSERT_TRUE(api::streamMetrics(metrics.snapshot(), api::SystemMetricsDto{}, plain));
+    TEST_ASSERT_FALSE(contains(plain.body, "watering_tick"));
+
+    api::SystemMetricsDto sys;
+    sys.hasTicks = true;
+    sys.tickBucketBaseUs = TickDurationStats::kBucketBaseUs;
+    sys.tickBudgetUs = 200'000;
+    sys.ticksOverBudget = 3;
+    sys.tick.durations.assign(TickDurationStats::kBuckets, 0);
+    sys.tick.durations[4] = 10;  // 2..4 ms
+    sys.tick.durations[11] = 3;
+    sys.tick.sumUs = 1'030'000;
+    sys.tick.maxUs = 310'000;
+    api::TickDurationDto read;
+    read.phase = "sensor_read";
+    read.durations.assign(TickDurationStats::kBuckets, 0);
+    read.durations[1] = 13;
+    read.sumUs = 5'200;
+    read.maxUs = 480;
+    sys.tickPhases.push_back(read);
+    StringSink sink;
+    TEST_ASSERT_TRUE(api::streamMetrics(metrics.snapshot(), sys, sink));
+    TEST_ASSERT_TRUE(contains(sink.body,
+        "# TYPE wateringsystem_watering_tick_duration_seconds histogram\n"));
+    TEST_ASSERT_TRUE(contains(sink.body,
+        "wateringsystem_watering_tick_duration_seconds_bucket{le=\"0.004\"} 10\n"));
+    TEST_ASSERT_TRUE(contains(sink.body,
+        "wateringsystem_watering_tick_duration_seconds_bucket{le=\"+Inf\"} 13\n"));
+    TEST_ASSERT_TRUE(contains(sink.body,
+        "wateringsystem_watering_tick_duration_seconds_sum 1.030000\n"));
+    TEST_ASSERT_TRUE(contains(sink.body,
+        "wateringsystem_watering_tick_duration_seconds_count 13\n"));
+    TEST_ASSERT_TRUE(contains(sink.body,
+        "wateringsystem_watering_tick_phase_duration_seconds_bucket{phase=\"sensor_read\",le=\"0.0005\"} 13\n"));
+    TEST_ASSERT_TRUE(contains(sink.body,
+        "wateringsystem_watering_tick_phase_duration_seconds_count{phase=\"sensor_read\"} 13\n"));
+    TEST_ASSERT_TRUE(contains(sink.body, "wateringsystem_watering_tick_max_seconds 0.310000\n"));
+    TEST_ASSERT_TRUE(contains(sink.body,
+        "wateringsystem_watering_tick_phase_max_seconds{phase=\"sensor_read\"} 0.000480\n"));
+    TEST_ASSERT_TRUE(contains(sink.body, "wateringsystem_watering_tick_budget_seconds 0.200000\n"));
+    TEST_ASSERT_TRUE(contains(sink.body, "wateringsystem_watering_tick_over_budget_total 3\n"));
+}
+
+}  // namespace
+
+void run_tick_latency_tests(void)
+{
+    RUN_TEST(test_buckets_double_from_250_us);
+    RUN_TEST(test_scopes_charge_their_phase);
+    RUN_TEST(test_warns_once_per_bucket_over_the_budget);
+    RUN_TEST(test_nothing_is_recorded_without_a_clock);
+    RUN_TEST(test_metrics_block_only_when_set);
+}
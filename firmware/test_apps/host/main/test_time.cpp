@@ -9,7 +9,8 @@
  * formatter, including the DST spring-forward boundary. The process timezone
  * is set to the Swedish rule once at suite start (mirrors
  * SntpClient::applyTimezone() on target) so the +ZZZZ offset in the formatted
- * string is deterministic.
+ * string is deterministic. Also covers the cached monotonic-offset wall
+ * clock (MonotonicEpoch) behind SystemWallClock.
  */
 
 #include <cstdlib>
@@ -18,7 +19,9 @@
 
 #include "unity.h"
 
+#include "time/MonotonicEpoch.h"
 #include "time/TimeService.h"
+#include "time/testing/FakeWallClock.h"
 
 namespace {
 
@@ -68,6 +71,60 @@ void test_format_dst_autumn_boundary(void)
     TEST_ASSERT_TRUE(ends_with(TimeService::formatLocal(1729990800u), "+0100"));
 }
 
+void test_monotonic_epoch_adds_the_anchored_offset(void)
+{
+    MonotonicEpoch clock;
+    WallTime t;
+    TEST_ASSERT_FALSE(clock.read(5000000, t));  // never anchored
+
+    // Anchored 10 s after boot at 1760000000.25 s.
+    clock.anchor(10000000, 1760000000250000);
+    TEST_ASSERT_TRUE(clock.read(10000000, t));
+    TEST_ASSERT_EQUAL_UINT32(1760000000, t.epoch);
+    TEST_ASSERT_TRUE(t.set);
+    TEST_ASSERT_TRUE(clock.read(10750000, t));
+    TEST_ASSERT_EQUAL_UINT32(1760000001, t.epoch);
+    TEST_ASSERT_TRUE(clock.read(70000000, t));
+    TEST_ASSERT_EQUAL_UINT32(1760000060, t.epoch);
+}
+
+void test_monotonic_epoch_follows_steps(void)
+{
+    MonotonicEpoch clock;
+    WallTime t;
+    // Unsynced boot: the clock counts up from 1970, not set.
+    clock.anchor(1000000, 1000000);
+    TEST_ASSERT_TRUE(clock.read(3000000, t));
+    TEST_ASSERT_EQUAL_UINT32(3, t.epoch);
+    TEST_ASSERT_FALSE(t.set);
+
+    // SNTP steps forward, then a correction steps back a little.
+    clock.anchor(4000000, 1760000000000000);
+    TEST_ASSERT_TRUE(clock.read(4000000, t));
+    TEST_ASSERT_TRUE(t.set);
+    clock.anchor(5000000, 1759999990000000);
+    TEST_ASSERT_TRUE(clock.read(5000000, t));
+    TEST_ASSERT_EQUAL_UINT32(1759999990, t.epoch);
+
+    // A step to before 1970 reads as 0, never as a wrapped epoch.
+    clock.anchor(6000000, -1000000);
+    TEST_ASSERT_TRUE(clock.read(6000000, t));
+    TEST_ASSERT_EQUAL_UINT32(0, t.epoch);
+    TEST_ASSERT_FALSE(t.set);
+}
+
+void test_fake_wall_clock_reading_is_consistent(void)
+{
+    FakeWallClock clock;
+    WallTime t = clock.now();
+    TEST_ASSERT_FALSE(t.set);
+    clock.setEpoch(TimeService::kMinPlausibleEpoch);
+    t = clock.now();
+    TEST_ASSERT_TRUE(t.set);
+    TEST_ASSERT_EQUAL_UINT32(TimeService::kMinPlausibleEpoch, t.epoch);
+    TEST_ASSERT_EQUAL(clock.isTimeSet(), t.set);
+}
+
 }  // namespace
 
 void run_time_tests(void)
@@ -81,4 +138,7 @@ void run_time_tests(void)
     RUN_TEST(test_format_winter_and_summer_offsets);
     RUN_TEST(test_format_dst_spring_boundary);
     RUN_TEST(test_format_dst_autumn_boundary);
+    RUN_TEST(test_monotonic_epoch_adds_the_anchored_offset);
+    RUN_TEST(test_monotonic_epoch_follows_steps);
+    RUN_TEST(test_fake_wall_clock_reading_is_consistent);
 }
@@ -0,0 +1,187 @@
+// SPDX-FileCopyrightText: 2026 Cryptotomte
+// SPDX-License-Identifier: AGPL-3.0-or-later
+/**
+ * @file test_trace_buffer.cpp
+ * @brief Host suite for the system trace rings (interfaces/TraceBuffer.h)
+ *        and the /trace dump.
+ *
+ * Registered by test_main.cpp via run_trace_buffer_tests(). A ring numbers
+ * records from 1, reads them oldest first past a cursor and skips what it
+ * has overwritten; the buffer drops records until a clock is installed
+ * and files each one under the calling core; WS_TRACE() above the level
+ * compiles out. This file sets the level to Info itself (the host build
+ * has none). The dump is the little-endian layout ApiStream.h documents.
+ */
+
+#define WS_TRACE_LEVEL 2
+
+#include <cstdint>
+#include <string>
+
+#include "unity.h"
+
+#include "api/ApiStream.h"
+#include "interfaces/TraceBuffer.h"
+
+namespace {
+
+int64_t g_nowUs = 0;
+int g_core = 0;
+
+int64_t fakeClock()
+{
+    return g_nowUs;
+}
+
+int fakeCore()
+{
+    return g_core;
+}
+
+void test_ring_reads_oldest_first_past_a_cursor(void)
+{
+    TraceRing ring;
+    TraceRecord out[4];
+    TEST_ASSERT_EQUAL_UINT32(0, ring.written());
+    TEST_ASSERT_EQUAL_size_t(0, ring.read(out, 4));
+
+    ring.emit(100, TraceLevel::Info, TraceId::HttpBegin, 3, 0);
+    ring.emit(250, TraceLevel::Info, TraceId::HttpEnd, 3 | (200u << 16), 150);
+    ring.emit(300, TraceLevel::Error, TraceId::SoilReadFailed, 1, 7);
+    TEST_ASSERT_EQUAL_UINT32(3, ring.written());
+
+    TEST_ASSERT_EQUAL_size_t(2, ring.read(out, 4, 1));
+    TEST_ASSERT_EQUAL_UINT32(2, out[0].sequence);
+    TEST_ASSERT_EQUAL_UINT32(250, out[0].atUs);
+    TEST_ASSERT_TRUE(out[0].id == TraceId::HttpEnd);
+    TEST_ASSERT_TRUE(out[0].level == TraceLevel::Info);
+    TEST_ASSERT_EQUAL_UINT32(3 | (200u << 16), out[0].a);
+    TEST_ASSERT_EQUAL_UINT32(150, out[0].b);
+    TEST_ASSERT_EQUAL_UINT32(3, out[1].sequence);
+    TEST_ASSERT_TRUE(out[1].id == TraceId::SoilReadFailed);
+    TEST_ASSERT_TRUE(out[1].level == TraceLevel::Error);
+
+    // A short buffer takes the oldest first.
+    TEST_ASSERT_EQUAL_size_t(1, ring.read(out, 1));
+    TEST_ASSERT_EQUAL_UINT32(1, out[0].sequence);
+}
+
+void test_ring_skips_overwritten_records(void)
+{
+    TraceRing ring;
+    const uint32_t total = TraceRing::kCapacity + 5;
+    for (uint32_t i = 1; i <= total; ++i) {
+        ring.emit(i * 10, TraceLevel::Debug, TraceId::I2cDone, 0, i);
+    }
+    TEST_ASSERT_EQUAL_UINT32(total, ring.written());
+
+    // From the start: the first five are gone, the oldest kept is the 6th.
+    TraceRecord out[2];
+    TEST_ASSERT_EQUAL_size_t(2, ring.read(out, 2));
+    TEST_ASSERT_EQUAL_UINT32(6, out[0].sequence);
+    TEST_ASSERT_EQUAL_UINT32(6, out[0].b);
+    TEST_ASSERT_EQUAL_UINT32(7, out[1].sequence);
+
+    // The newest is still where the cursor says.
+    TEST_ASSERT_EQUAL_size_t(1, ring.read(out, 2, total - 1));
+    TEST_ASSERT_EQUAL_UINT32(total, out[0].sequence);
+}
+
+void test_buffer_files_records_by_core(void)
+{
+    TraceBuffer trace;
+    trace.emit(TraceLevel::Info, TraceId::ModbusStart, 1, 2);  // no clock yet
+    TEST_ASSERT_EQUAL_UINT32(0, trace.ring(0).written());
+
+    trace.install(&fakeClock, &fakeCore);
+    g_nowUs = 5000;
+    g_core = 1;
+    trace.emit(TraceLevel::Info, TraceId::ModbusStart, 0x0103, 40);
+    g_core = 7;  // out of range: filed under core 0
+    trace.emit(TraceLevel::Info, TraceId::ModbusDone, 0, 9000);
+    TEST_ASSERT_EQUAL_UINT32(1, trace.ring(0).written());
+    TEST_ASSERT_EQUAL_UINT32(1, trace.ring(1).written());
+
+    TraceRecord out[1];
+    TEST_ASSERT_EQUAL_size_t(1, trace.ring(1).read(out, 1));
+    TEST_ASSERT_TRUE(out[0].id == TraceId::ModbusStart);
+    TEST_ASSERT_EQUAL_UINT32(5000, out[0].atUs);
+    TEST_ASSERT_EQUAL_UINT32(0x0103, out[0].a);
+}
+
+void test_macro_compiles_out_above_the_level(void)
+{
+    traceBuffer().install(&fakeClock, &fakeCore);
+    g_core = 0;
+    g_nowUs = 1234;
+    const uint32_t before = traceBuffer().ring(0).written();
+    int evaluated = 0;
+    WS_TRACE(Info, EnvReading, 2150, ++evaluated);
+    WS_TRACE(Debug, I2cStart, 0x76, ++evaluated);  // above level 2: dropped
+    TEST_ASSERT_EQUAL_UINT32(before + 1, traceBuffer().ring(0).written());
+    TEST_ASSERT_EQUAL_INT(1, evaluated);
+
+    TraceRecord out[1];
+    TEST_ASSERT_EQUAL_size_t(1, traceBuffer().ring(0).read(out, 1, before));
+    TEST_ASSERT_TRUE(out[0].id == TraceId::EnvReading);
+    TEST_ASSERT_EQUAL_UINT32(2150, out[0].a);
+}
+
+struct StringSink final : api::IChunkSink {
+    std::string body;
+
+    bool send(const char* data, std::size_t len) override
+    {
+        body.append(data, len);
+        return true;
+    }
+};
+
+uint32_t u32At(const std::string& body, std::size_t at)
+{
+    uint32_t v = 0;
+    for (std::size_t i = 0; i < 4; ++i) {
+        v |= static_cast<uint32_t>(static_cast<unsigned char>(body[at + i])) << (8 * i);
+    }
+    return v;
+}
+
+void test_dump_layout(void)
+{
+    TraceBuffer trace;
+    trace.install(&fakeClock, &fakeCore);
+    g_core = 1;
+    g_nowUs = 0x01020304;
+    trace.emit(TraceLevel::Error, TraceId::SoilReadFailed, 0x01, 0xFFFFFFFFu);
+
+    StringSink sink;
+    TEST_ASSERT_TRUE(api::streamTraceBuffer(trace, 0x0A0B0C0D, sink));
+    const std::size_t header = 12 + 4 * TraceBuffer::kCores;
+    TEST_ASSERT_EQUAL_size_t(header + api::kTraceRecordBytes, sink.body.size());
+    TEST_ASSERT_EQUAL_STRING("WST1", sink.body.substr(0, 4).c_str());
+    TEST_ASSERT_EQUAL_UINT32(0x0A0B0C0D, u32At(sink.body, 4));
+    TEST_ASSERT_EQUAL_UINT32(TraceBuffer::kCores, u32At(sink.body, 8));
+    TEST_ASSERT_EQUAL_UINT32(0, u32At(sink.body, 12));  // core 0 written
+    TEST_ASSERT_EQUAL_UINT32(1, u32At(sink.body, 16));  // core 1 written
+
+    const std::size_t r = header;
+    TEST_ASSERT_EQUAL_UINT32(1, u32At(sink.body, r));            // sequence
+    TEST_ASSERT_EQUAL_UINT32(0x01020304, u32At(sink.body, r + 4));
+    TEST_ASSERT_EQUAL_INT(31, static_cast<unsigned char>(sink.body[r + 8]));
+    TEST_ASSERT_EQUAL_INT(0, static_cast<unsigned char>(sink.body[r + 9]));
+    TEST_ASSERT_EQUAL_INT(1, static_cast<unsigned char>(sink.body[r + 10]));  // core
+    TEST_ASSERT_EQUAL_INT(1, static_cast<unsigned char>(sink.body[r + 11]));  // error
+    TEST_ASSERT_EQUAL_UINT32(0x01, u32At(sink.body, r + 12));
+    TEST_ASSERT_EQUAL_UINT32(0xFFFFFFFFu, u32At(sink.body, r + 16));
+}
+
+}  // namespace
+
+void run_trace_buffer_tests(void)
+{
+    RUN_TEST(test_ring_reads_oldest_first_past_a_cursor);
+    RUN_TEST(test_ring_skips_overwritten_records);
+    RUN_TEST(test_buffer_files_records_by_core);
+    RUN_TEST(test_macro_compiles_out_above_the_level);
+    RUN_TEST(test_dump_layout);
+}
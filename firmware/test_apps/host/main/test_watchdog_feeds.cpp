@@ -0,0 +1,162 @@
+// SPDX-FileCopyrightText: 2026 Cryptotomte
+// SPDX-License-Identifier: AGPL-3.0-or-later
+/**
+ * @file test_watchdog_feeds.cpp
+ * @brief Host suite for the watchdog feed-interval histograms
+ *        (interfaces/WatchdogFeeds.h) and their /metrics block.
+ *
+ * Registered by test_main.cpp via run_watchdog_feeds_tests(). Intervals land
+ * in doubling buckets from 10 ms; feed() reports an interval past the
+ * warning threshold once per bucket it reaches; an owner that never
+ * subscribed is ignored and a full table refuses the next task.
+ */
+
+#include <cstdint>
+#include <string>
+
+#include "unity.h"
+
+#include "api/ApiMetrics.h"
+#include "interfaces/WatchdogFeeds.h"
+
+namespace {
+
+int g_main;
+int g_soil;
+
+void test_buckets_double_from_10_ms(void)
+{
+    TEST_ASSERT_EQUAL_size_t(0, WatchdogFeeds::bucketOf(0));
+    TEST_ASSERT_EQUAL_size_t(0, WatchdogFeeds::bucketOf(9'999));
+    TEST_ASSERT_EQUAL_size_t(1, WatchdogFeeds::bucketOf(10'000));
+    TEST_ASSERT_EQUAL_size_t(4, WatchdogFeeds::bucketOf(100'000));    // 80..160 ms
+    TEST_ASSERT_EQUAL_size_t(9, WatchdogFeeds::bucketOf(5'000'000));  // 2.56..5.12 s
+    TEST_ASSERT_EQUAL_size_t(12, WatchdogFeeds::bucketOf(20'480'000));
+    TEST_ASSERT_EQUAL_size_t(12, WatchdogFeeds::bucketOf(UINT32_MAX));
+}
+
+void test_feeds_fill_the_histogram_per_task(void)
+{
+    WatchdogFeeds feeds;
+    TEST_ASSERT_TRUE(feeds.subscribe(&g_main, "main", 1'000'000));
+    TEST_ASSERT_TRUE(feeds.subscribe(&g_soil, "soil_task", 1'000'000));
+    uint32_t interval = 0;
+    TEST_ASSERT_FALSE(feeds.feed(&g_main, 1'100'000, interval));
+    TEST_ASSERT_EQUAL_UINT32(100'000, interval);
+    feeds.feed(&g_main, 1'200'000, interval);
+    feeds.feed(&g_soil, 6'000'000, interval);
+    feeds.feed(&g_main, 1'750'000, interval);
+
+    WatchdogFeedStats out[WatchdogFeeds::kMaxTasks];
+    TEST_ASSERT_EQUAL_size_t(2, feeds.copy(out, WatchdogFeeds::kMaxTasks));
+    TEST_ASSERT_EQUAL_STRING("main", out[0].name);
+    TEST_ASSERT_EQUAL_UINT32(3, out[0].intervals);
+    TEST_ASSERT_EQUAL_UINT32(750, out[0].sumMs);
+    TEST_ASSERT_EQUAL_UINT32(550'000, out[0].maxIntervalUs);
+    TEST_ASSERT_EQUAL_UINT32(2, out[0].buckets[4]);
+    TEST_ASSERT_EQUAL_UINT32(1, out[0].buckets[6]);  // 320..640 ms
+    TEST_ASSERT_EQUAL_STRING("soil_task", out[1].name);
+    TEST_ASSERT_EQUAL_UINT32(1, out[1].intervals);
+    TEST_ASSERT_EQUAL_UINT32(5'000'000, out[1].maxIntervalUs);
+
+    // A repeat subscription restarts the interval, keeps the slot.
+    TEST_ASSERT_TRUE(feeds.subscribe(&g_main, "main", 9'000'000));
+    feeds.feed(&g_main, 9'050'000, interval);
+    TEST_ASSERT_EQUAL_UINT32(50'000, interval);
+    TEST_ASSERT_EQUAL_size_t(2, feeds.copy(out, WatchdogFeeds::kMaxTasks));
+}
+
+void test_warns_once_per_bucket_past_the_threshold(void)
+{
+    WatchdogFeeds feeds(10'000'000);  // half of a 20 s timeout
+    feeds.subscribe(&g_soil, "soil_task", 0);
+    uint32_t interval = 0;
+    int64_t now = 0;
+    TEST_ASSERT_FALSE(feeds.feed(&g_soil, now += 9'000'000, interval));
+    TEST_ASSERT_TRUE(feeds.feed(&g_soil, now += 10'500'000, interval));
+    TEST_ASSERT_EQUAL_UINT32(10'500'000, interval);
+    TEST_ASSERT_FALSE(feeds.feed(&g_soil, now += 11'000'000, interval));  // same bucket
+    TEST_ASSERT_FALSE(feeds.feed(&g_soil, now += 5'000'000, interval));
+    TEST_ASSERT_TRUE(feeds.feed(&g_soil, now += 21'000'000, interval));   // open bucket
+    TEST_ASSERT_FALSE(feeds.feed(&g_soil, now += 30'000'000, interval));
+
+    WatchdogFeeds quiet;  // no threshold: never warns
+    quiet.subscribe(&g_soil, "soil_task", 0);
+    TEST_ASSERT_FALSE(quiet.feed(&g_soil, 19'000'000, interval));
+}
+
+void test_untracked_owners_are_ignored(void)
+{
+    WatchdogFeeds feeds(1);
+    uint32_t interval = 7;
+    TEST_ASSERT_FALSE(feeds.feed(&g_main, 5'000'000, interval));
+    TEST_ASSERT_EQUAL_UINT32(0, interval);
+
+    int owners[WatchdogFeeds::kMaxTasks + 1];
+    for (std::size_t i = 0; i < WatchdogFeeds::kMaxTasks; ++i) {
+        TEST_ASSERT_TRUE(feeds.subscribe(&owners[i], "task", 0));
+    }
+    TEST_ASSERT_FALSE(feeds.subscribe(&owners[WatchdogFeeds::kMaxTasks], "late", 0));
+    TEST_ASSERT_FALSE(feeds.feed(&owners[WatchdogFeeds::kMaxTasks], 5'000'000, interval));
+}
+
+struct StringSink final : api::IChunkSink {
+    std::string body;
+
+    bool send(const char* data, std::size_t len) override
+    {
+        body.append(data, len);
+        return true;
+    }
+};
+
+bool contains(const std::string& body, const char* text)
+{
+    return body.find(text) != std::string::npos;
+}
+
+void test_metrics_block_only_when_set(void)
+{
+    api::HttpMetrics metrics;
+    StringSink plain;
+    TEST_ASSERT_TRUE(api::streamMetrics(metrics.snapshot(), api::SystemMetricsDto{}, plain));
+    TEST_ASSERT_FALSE(contains(plain.body, "watchdog_feed"));
+
+    api::SystemMetricsDto sys;
+    sys.watchdogBucketBaseUs = WatchdogFeedStats::kBucketBaseUs;
+    api::WatchdogFeedDto feed;
+    feed.task = "main";
+    feed.intervals.assign(WatchdogFeedStats::kBuckets, 0);
+    feed.intervals[4] = 40;
+    feed.intervals[5] = 2;
+    feed.sumUs = 4'250'000;
+    feed.maxIntervalUs = 230'000;
+    sys.watchdogFeeds.push_back(feed);
+    StringSink sink;
+    TEST_ASSERT_TRUE(api::streamMetrics(metrics.snapshot(), sys, sink));
+    TEST_ASSERT_TRUE(contains(sink.body,
+        "# TYPE wateringsystem_watchdog_feed_interval_seconds histogram\n"));
+    TEST_ASSERT_TRUE(contains(sink.body,
+        "wateringsystem_watchdog_feed_interval_seconds_bucket{task=\"main\",le=\"0.08\"} 0\n"));
+    TEST_ASSERT_TRUE(contains(sink.body,
+        "wateringsystem_watchdog_feed_interval_seconds_bucket{task=\"main\",le=\"0.16\"} 40\n"));
+    TEST_ASSERT_TRUE(contains(sink.body,
+        "wateringsystem_watchdog_feed_interval_seconds_bucket{task=\"main\",le=\"+Inf\"} 42\n"));
+    TEST_ASSERT_TRUE(contains(sink.body,
+        "wateringsystem_watchdog_feed_interval_seconds_sum{task=\"main\"} 4.250000\n"));
+    TEST_ASSERT_TRUE(contains(sink.body,
+        "wateringsystem_watchdog_feed_interval_seconds_count{task=\"main\"} 42\n"));
+    TEST_ASSERT_TRUE(contains(sink.body,
+        "wateringsystem_watchdog_feed_interval_max_seconds{task=\"main\"} 0.230000\n"));
+}
+
+}  // namespace
+
+void run_watchdog_feeds_tests(void)
+{
+    RUN_TEST(test_buckets_double_from_10_ms);
+    RUN_TEST(test_feeds_fill_the_histogram_per_task);
+    RUN_TEST(test_warns_once_per_bucket_past_the_threshold);
+    RUN_TEST(test_untracked_owners_are_ignored);
+    RUN_TEST(test_metrics_block_only_when_set);
+}
@@ -10,6 +10,8 @@
  * Unity runner (test_main.cpp); the process exit code equals the failure
  * count and is the CI gate.
  *
+ * The IPumpObserver hook is checked against the same transitions.
+ *
  * Coverage maps to the invariants in
  * specs/002-pump-gpio-board/contracts/iwaterpump.md.
  */
@@ -19,11 +21,38 @@
 #include "unity.h"
 
 #include "actuators/LockedWaterPump.h"
+#include "actuators/testing/FakeDeadlineTimer.h"
 #include "actuators/testing/FakeTimeProvider.h"
 #include "actuators/testing/MockWaterPump.h"
+#include "interfaces/IFlowMeter.h"
+#include "interfaces/IPumpObserver.h"
 
 namespace {
 
+/// Records every running-state notification, reading the pump back as the
+/// notification arrives.
+struct RecordingObserver : IPumpObserver {
+    explicit RecordingObserver(const WaterPump& p) : pump(p) {}
+
+    void onRunningChanged(bool running) override
+    {
+        changes.push_back(running);
+        consistent = consistent && pump.isRunning() == running;
+    }
+
+    const WaterPump& pump;
+    std::vector<bool> changes;
+    bool consistent = true;
+};
+
+/// A flow meter whose running total the test sets.
+struct ScriptedFlowMeter : IFlowMeter {
+    uint32_t ml = 0;
+
+    uint32_t deliveredMl() override { return ml; }
+    float flowMlPerMin() override { return 0.0f; }
+};
+
 constexpr int64_t kMaxRunTimeMs = WaterPump::kDefaultMaxRunTimeMs;  // 300 000
 
 /// Fresh pump + clock per test; initialize() is part of the fixture.
@@ -240,11 +269,188 @@ static void test_locked_wrapper_delegates_full_cycle(void)
                       static_cast<int>(pump.getLastStopReason()));
     TEST_ASSERT_EQUAL_INT64(4000, pump.getAccumulatedRunTimeMs());
 
+    // The getters are served from status(), republished by every call.
+    const PumpStatus status = pump.status();
+    TEST_ASSERT_TRUE(status.available);
+    TEST_ASSERT_FALSE(status.running);
+    TEST_ASSERT_EQUAL(static_cast<int>(StopReason::Commanded),
+                      static_cast<int>(status.lastStopReason));
+    TEST_ASSERT_EQUAL_INT64(4000, status.accumulatedRunTimeMs);
+    const uint32_t version = pump.statusVersion();
+    pump.update();  // stopped: nothing changes
+    TEST_ASSERT_EQUAL_UINT32(version, pump.statusVersion());
+
     // Output transitions reached the wrapped pump exactly paired.
     const std::vector<bool> expected = {false, true, false};
     TEST_ASSERT_TRUE(inner.outputCalls == expected);
 }
 
+// --------------------------------------------------------------------------
+// Deadline timer: armed at the run's end, cancelled on every stop; a stale
+// firing (update() after a stop and a fresh start) finds nothing due
+// --------------------------------------------------------------------------
+static void test_deadline_timer_armed_and_cancelled(void)
+{
+    Fixture f;
+    FakeDeadlineTimer timer;
+    f.pump.setDeadlineTimer(&timer);
+
+    TEST_ASSERT_FALSE(f.pump.runFor(0));  // rejected: nothing armed
+    TEST_ASSERT_EQUAL(0, timer.armCalls);
+
+    TEST_ASSERT_TRUE(f.pump.runFor(10));
+    TEST_ASSERT_TRUE(timer.armed);
+    TEST_ASSERT_EQUAL_INT64(10'000, timer.delayMs);
+
+    // The timer fires at the deadline: the callback's update() stops.
+    f.clock.advance(10'000);
+    f.pump.update();
+    TEST_ASSERT_FALSE(f.pump.isRunning());
+    TEST_ASSERT_EQUAL(static_cast<int>(StopReason::DurationElapsed),
+                      static_cast<int>(f.pump.getLastStopReason()));
+    TEST_ASSERT_FALSE(timer.armed);
+
+    // A commanded stop cancels; the old deadline firing into the next run
+    // does not cut it short.
+    TEST_ASSERT_TRUE(f.pump.runFor(20));
+    f.clock.advance(5000);
+    TEST_ASSERT_TRUE(f.pump.stop());
+    TEST_ASSERT_FALSE(timer.armed);
+    TEST_ASSERT_TRUE(f.pump.runFor(20));
+    f.clock.advance(15'000);
+    f.pump.update();
+    TEST_ASSERT_TRUE(f.pump.isRunning());
+
+    // A timer that cannot arm leaves the polled stop in charge.
+    TEST_ASSERT_TRUE(f.pump.stop());
+    timer.armResult = false;
+    TEST_ASSERT_TRUE(f.pump.runFor(1));
+    f.clock.advance(1000);
+    f.pump.update();
+    TEST_ASSERT_FALSE(f.pump.isRunning());
+}
+
+// --------------------------------------------------------------------------
+// Observer: told of every switch on and off as it happens, with isRunning()
+// already updated; rejected commands and no-op stops notify nothing
+// --------------------------------------------------------------------------
+static void test_observer_told_of_every_switch(void)
+{
+    Fixture f;
+    RecordingObserver observer(f.pump);
+    f.pump.setObserver(&observer);
+
+    TEST_ASSERT_FALSE(f.pump.runFor(0));
+    TEST_ASSERT_TRUE(f.pump.stop());          // already stopped
+    TEST_ASSERT_TRUE(observer.changes.empty());
+
+    TEST_ASSERT_TRUE(f.pump.runFor(10));
+    TEST_ASSERT_FALSE(f.pump.runFor(10));     // rejected while running
+    f.clock.advance(10'000);
+    f.pump.update();                          // duration elapsed
+    TEST_ASSERT_TRUE(f.pump.runFor(5));
+    TEST_ASSERT_TRUE(f.pump.stop());          // commanded
+    TEST_ASSERT_TRUE(f.pump.runFor(5));
+    TEST_ASSERT_TRUE(f.pump.initialize());    // re-arm forces OFF
+
+    const std::vector<bool> expected = {true, false, true, false, true, false};
+    TEST_ASSERT_TRUE(observer.changes == expected);
+    TEST_ASSERT_TRUE(observer.consistent);
+
+    f.pump.setObserver(nullptr);
+    TEST_ASSERT_TRUE(f.pump.runFor(1));
+    TEST_ASSERT_EQUAL(6, static_cast<int>(observer.changes.size()));
+}
+
+// --------------------------------------------------------------------------
+// Volume runs: stop once the meter has counted the volume since the start,
+// the duration cap still applies, and every stop records the volume
+// --------------------------------------------------------------------------
+static void test_volume_run_stops_at_volume(void)
+{
+    Fixture f;
+    ScriptedFlowMeter meter;
+    meter.ml = 1000;  // the meter's total predates the run
+    f.pump.setFlowMeter(&meter);
+
+    TEST_ASSERT_TRUE(f.pump.runForVolume(250, 60));
+    f.clock.advance(5000);
+    meter.ml = 1249;
+    f.pump.update();
+    TEST_ASSERT_TRUE(f.pump.isRunning());
+
+    f.clock.advance(100);
+    meter.ml = 1252;
+    f.pump.update();
+    TEST_ASSERT_FALSE(f.pump.isRunning());
+    TEST_ASSERT_EQUAL(static_cast<int>(StopReason::VolumeReached),
+                      static_cast<int>(f.pump.getLastStopReason()));
+    const PumpRunVolume volume = f.pump.getLastRunVolume();
+    TEST_ASSERT_TRUE(volume.metered);
+    TEST_ASSERT_EQUAL_UINT32(252, volume.volumeMl);
+    TEST_ASSERT_EQUAL_INT64(5100, volume.runMs);
+
+    // A timed run on a metered pump is measured too, never cut by volume.
+    TEST_ASSERT_TRUE(f.pump.runFor(2));
+    meter.ml = 5000;
+    f.pump.update();
+    TEST_ASSERT_TRUE(f.pump.isRunning());
+    f.clock.advance(2000);
+    f.pump.update();
+    TEST_ASSERT_EQUAL(static_cast<int>(StopReason::DurationElapsed),
+                      static_cast<int>(f.pump.getLastStopReason()));
+    TEST_ASSERT_EQUAL_UINT32(5000 - 1252, f.pump.getLastRunVolume().volumeMl);
+}
+
+static void test_volume_run_capped_by_duration(void)
+{
+    Fixture f;
+    ScriptedFlowMeter meter;
+    f.pump.setFlowMeter(&meter);
+
+    TEST_ASSERT_TRUE(f.pump.runForVolume(500, 10));
+    meter.ml = 120;  // a dry reservoir: the volume never comes
+    f.clock.advance(10'000);
+    f.pump.update();
+    TEST_ASSERT_FALSE(f.pump.isRunning());
+    TEST_ASSERT_EQUAL(static_cast<int>(StopReason::DurationElapsed),
+                      static_cast<int>(f.pump.getLastStopReason()));
+    TEST_ASSERT_EQUAL_UINT32(120, f.pump.getLastRunVolume().volumeMl);
+
+    // Commanded stop mid-run: volume so far.
+    TEST_ASSERT_TRUE(f.pump.runForVolume(500, 10));
+    meter.ml = 200;
+    TEST_ASSERT_TRUE(f.pump.stop());
+    TEST_ASSERT_EQUAL_UINT32(80, f.pump.getLastRunVolume().volumeMl);
+}
+
+static void test_volume_run_rejections(void)
+{
+    Fixture f;
+    TEST_ASSERT_FALSE(f.pump.runForVolume(100, 60));  // no meter
+    TEST_ASSERT_FALSE(f.pump.getLastRunVolume().metered);
+    TEST_ASSERT_EQUAL(1, static_cast<int>(f.pump.outputCalls.size()));  // init only
+
+    ScriptedFlowMeter meter;
+    f.pump.setFlowMeter(&meter);
+    TEST_ASSERT_FALSE(f.pump.runForVolume(0, 60));
+    TEST_ASSERT_FALSE(f.pump.runForVolume(-5, 60));
+    TEST_ASSERT_FALSE(f.pump.runForVolume(100, 0));    // runFor's own checks
+    TEST_ASSERT_FALSE(f.pump.runForVolume(100, 301));
+    TEST_ASSERT_FALSE(f.pump.isRunning());
+    TEST_ASSERT_EQUAL(1, static_cast<int>(f.pump.outputCalls.size()));  // init only
+
+    // Through the locked wrapper.
+    LockedWaterPump locked(f.pump);
+    TEST_ASSERT_TRUE(locked.runForVolume(50, 60));
+    meter.ml = 50;
+    locked.update();
+    TEST_ASSERT_FALSE(locked.isRunning());
+    TEST_ASSERT_EQUAL(static_cast<int>(StopReason::VolumeReached),
+                      static_cast<int>(locked.getLastStopReason()));
+    TEST_ASSERT_EQUAL_UINT32(50, locked.getLastRunVolume().volumeMl);
+}
+
 void run_water_pump_tests(void)
 {
     RUN_TEST(test_duration_self_stop_at_exact_boundary);
@@ -257,4 +463,9 @@ void run_water_pump_tests(void)
     RUN_TEST(test_accumulated_runtime_across_runs);
     RUN_TEST(test_enforcement_within_one_poll);
     RUN_TEST(test_locked_wrapper_delegates_full_cycle);
+    RUN_TEST(test_deadline_timer_armed_and_cancelled);
+    RUN_TEST(test_observer_told_of_every_switch);
+    RUN_TEST(test_volume_run_stops_at_volume);
+    RUN_TEST(test_volume_run_capped_by_duration);
+    RUN_TEST(test_volume_run_rejections);
 }
@@ -14,13 +14,17 @@
  * Coverage maps to tasks.md T006 (automatic + soak gate), T007 (fail-safe) and
  * T011 (manual override + periodic data-logging): start-at-low,
  * no-start/allow-restart across the soak pause, stop-at-high, runtime config
- * change, disabled -> no action, gate-on-read (placeholder + transient failed
+ * change (and the generation-keyed settings cache), disabled -> no action, gate-on-read (placeholder + transient failed
  * read), fail-safe unavailable/stale/invalid stops, fail-safe never delayed by
  * the soak gate, graceful degradation (sensor always failing -> never waters,
  * no crash), manual override (bypasses fail-safe, 300 s cap, lower clamp,
  * auto-runs stay automatic, stop() clears the override) and data-logging
  * (cadence, epoch timestamp, NPK >= 0 filter, time-not-set gate, independence
- * from the fail-safe path).
+ * from the fail-safe path), plus the soil feed (decide without reading,
+ * staleness from the sample time, one log per sample, a flatline fail-safe
+ * logged once), and a steady-state tick — data log, bursts, fail-safe
+ * event, decision trace — making no heap allocation (EXPECT_NO_ALLOC,
+ * alloc_tracker.h).
  */
 
 #include <cstdint>
@@ -28,14 +32,22 @@
 
 #include "unity.h"
 
+#include "alloc_tracker.h"
+
 #include "actuators/testing/FakeTimeProvider.h"
 #include "actuators/testing/MockWaterPump.h"
+#include "actuators/WaterPump.h"
+#include "control/DecisionTrace.h"
+#include "control/MoistureResponse.h"
 #include "control/WateringController.h"
 #include "events/EventLogger.h"
 #include "interfaces/IDataStorage.h"
+#include "interfaces/IFlowMeter.h"
+#include "sensors/SoilAcquirer.h"
 #include "sensors/testing/MockEnvironmentalSensor.h"
 #include "sensors/testing/MockSoilSensor.h"
 #include "storage/testing/MockConfigStore.h"
+#include "storage/QueuedDataStorage.h"
 #include "storage/testing/MockDataStorage.h"
 #include "time/testing/FakeWallClock.h"
 
@@ -216,6 +228,38 @@ void test_soak_pause_blocks_then_allows_restart(void)
     TEST_ASSERT_EQUAL_INT(2, onTransitions(f.pump));
 }
 
+// status() is what other tasks read: each tick's gate and action, the
+// burst and its soak end, the manual flag — and its version moves with it.
+void test_status_published_for_other_tasks(void)
+{
+    Fixture f;  // burst 20 s, soak 300 s
+    TEST_ASSERT_EQUAL_UINT32(0, f.controller.statusVersion());
+    setSensor(f, true, true, 20.0f);
+    f.controller.tick();
+    WateringControllerStatus s = f.controller.status();
+    TEST_ASSERT_TRUE(s.burstActive);
+    TEST_ASSERT_EQUAL(static_cast<int>(DecisionGate::Dry), static_cast<int>(s.gate));
+    TEST_ASSERT_EQUAL(static_cast<int>(DecisionAction::StartBurst),
+                      static_cast<int>(s.action));
+    TEST_ASSERT_EQUAL_INT64(f.clock.nowMs(), s.lastValidSoilMs);
+    TEST_ASSERT_EQUAL_INT64(0, s.soakEndsAtMs);
+
+    f.clock.advance(20'000);  // the burst self-stops
+    setSensor(f, true, true, 20.0f);
+    f.controller.tick();
+    s = f.controller.status();
+    TEST_ASSERT_FALSE(s.burstActive);
+    TEST_ASSERT_EQUAL_INT64(f.clock.nowMs() + 300'000, s.soakEndsAtMs);
+    TEST_ASSERT_EQUAL(static_cast<int>(DecisionGate::Soak), static_cast<int>(s.gate));
+
+    const uint32_t version = f.controller.statusVersion();
+    TEST_ASSERT_TRUE(f.controller.startManual(60));
+    TEST_ASSERT_TRUE(f.controller.status().manualRunActive);
+    f.controller.stop();
+    TEST_ASSERT_FALSE(f.controller.status().manualRunActive);
+    TEST_ASSERT_EQUAL_UINT32(version + 2, f.controller.statusVersion());
+}
+
 // A runtime config change (lower threshold) is picked up on the next tick.
 void test_config_change_picked_up_next_tick(void)
 {
@@ -231,6 +275,30 @@ void test_config_change_picked_up_next_tick(void)
     TEST_ASSERT_TRUE(f.pump.isRunning());
 }
 
+// The controller keeps its own copy of the config items and re-reads it only
+// when IConfigStore::generation() moves: a change no write reported is not
+// seen, the next accepted setter makes it (and itself) visible.
+void test_settings_cached_until_generation_moves(void)
+{
+    Fixture f;  // low 30
+    f.config.stableGeneration = true;
+    setSensor(f, true, true, 40.0f);
+    f.controller.tick();
+    TEST_ASSERT_FALSE(f.pump.isRunning());
+
+    f.config.stored.moistureThresholdLow = 50.0f;  // no write: generation static
+    f.clock.advance(1000);
+    setSensor(f, true, true, 40.0f);
+    f.controller.tick();
+    TEST_ASSERT_FALSE(f.pump.isRunning());
+
+    TEST_ASSERT_TRUE(f.config.setMoistureThresholdHigh(60.0f));
+    f.clock.advance(1000);
+    setSensor(f, true, true, 40.0f);
+    f.controller.tick();
+    TEST_ASSERT_TRUE(f.pump.isRunning());
+}
+
 // Scenario 7 (FR-004): before the first successful read the controller does not
 // act on the sensor's placeholder value (here 0 %, which is <= low).
 void test_no_action_before_first_successful_read(void)
@@ -509,6 +577,35 @@ void test_manual_run_lower_clamp(void)
                           static_cast<int>(f.pump.getLastStopReason()));
 }
 
+// A manual volume run needs a flow meter; with one it is a manual run like
+// any other (fail-safe exempt) and stops at the volume.
+void test_manual_volume_run(void)
+{
+    struct Meter : IFlowMeter {
+        uint32_t ml = 0;
+        uint32_t deliveredMl() override { return ml; }
+        float flowMlPerMin() override { return 0.0f; }
+    } meter;
+    Fixture f;
+    setSensor(f, false, false, 20.0f);
+    TEST_ASSERT_FALSE(f.controller.startManualVolume(200));  // no meter
+    TEST_ASSERT_FALSE(f.pump.isRunning());
+
+    f.pump.setFlowMeter(&meter);
+    TEST_ASSERT_TRUE(f.controller.startManualVolume(200));
+    f.clock.advance(1000);
+    f.controller.tick();
+    TEST_ASSERT_TRUE(f.pump.isRunning());
+    TEST_ASSERT_EQUAL_INT(0, failsafeEventCount(f.storage));
+
+    meter.ml = 200;
+    f.clock.advance(100);
+    f.controller.tick();
+    TEST_ASSERT_FALSE(f.pump.isRunning());
+    TEST_ASSERT_EQUAL_INT(static_cast<int>(StopReason::VolumeReached),
+                          static_cast<int>(f.pump.getLastStopReason()));
+}
+
 // FR-007: an automatically-started burst is NOT flagged manual — the fail-safe
 // still applies to it (the mirror of the manual-bypass case).
 void test_auto_run_is_not_flagged_manual(void)
@@ -556,9 +653,9 @@ void test_stop_clears_manual_override(void)
 // interval logs the next batch.
 //
 // All three NPK channels are scripted >= 0, so the batch spans the full,
-// maximal metric set: 3 env + 4 soil-base (moisture, temperature, ph, ec) +
-// 3 NPK = exactly 10 distinct metrics, which fits the store's kMaxMetrics=10
-// cap with no silent drop (soil_humidity is not logged — it duplicates
+// single-probe metric set: 3 env + 4 soil-base (moisture, temperature, ph,
+// ec) + 3 NPK = 10 distinct metrics, which fits the store's kMaxMetrics cap
+// with no silent drop (soil_humidity is not logged — it duplicates
 // soil_moisture).
 void test_data_log_cadence(void)
 {
@@ -574,9 +671,11 @@ void test_data_log_cadence(void)
     f.clock.advance(1000);
     f.controller.tick();
     TEST_ASSERT_EQUAL_INT(10, sensorReadingCount(f.storage));
-    // The full batch is exactly the kMaxMetrics=10 distinct-metric budget:
-    // nothing hit the cap, so the store rejected no write (drop-sensitive).
+    // The full batch fits the distinct-metric budget: nothing hit the cap,
+    // so the store rejected no write (drop-sensitive).
     TEST_ASSERT_EQUAL_INT(0, f.storage.rejectedWrites);
+    // ... and it reaches storage as ONE batch call, not ten appends.
+    TEST_ASSERT_EQUAL_INT(1, f.storage.batchWrites);
 
     // Inside the interval: nothing new.
     f.clock.advance(59'999);
@@ -587,6 +686,151 @@ void test_data_log_cadence(void)
     f.clock.advance(1);
     f.controller.tick();
     TEST_ASSERT_EQUAL_INT(20, sensorReadingCount(f.storage));
+    TEST_ASSERT_EQUAL_INT(2, f.storage.batchWrites);
+}
+
+// setDataLogInterval() (soak mode) replaces the configured interval, below
+// the store's 60 s floor; 0 returns to the configured one.
+void test_data_log_interval_override(void)
+{
+    Fixture f;
+    f.config.stored.dataLogIntervalMs = 60'000;
+    f.controller.setDataLogInterval(1000);
+    f.wallClock.setEpoch(1'700'000'000);
+    f.env.scriptSuccessfulRead(21.5f, 55.0f, 1013.0f);
+    f.soil.scriptSuccessfulRead(40.0f, 18.0f, 40.0f, 6.5f, 1.2f, 3.0f, 5.0f,
+                                8.0f);
+
+    f.clock.advance(1000);
+    f.controller.tick();
+    TEST_ASSERT_EQUAL_INT(1, f.storage.batchWrites);
+    f.clock.advance(999);
+    f.controller.tick();
+    TEST_ASSERT_EQUAL_INT(1, f.storage.batchWrites);
+    f.clock.advance(1);
+    f.controller.tick();
+    TEST_ASSERT_EQUAL_INT(2, f.storage.batchWrites);
+
+    f.controller.setDataLogInterval(0);
+    f.clock.advance(1000);
+    f.controller.tick();
+    TEST_ASSERT_EQUAL_INT(2, f.storage.batchWrites);
+}
+
+// Further soil probes: each one's moisture joins the same batch under its
+// per-probe id while its last read was ok and in range; the controller
+// never reads them itself.
+void test_data_log_further_probes(void)
+{
+    Fixture f;
+    f.config.stored.dataLogIntervalMs = 60'000;
+    f.wallClock.setEpoch(1'700'000'000);
+    f.env.scriptSuccessfulRead(21.5f, 55.0f, 1013.0f);
+    f.soil.scriptSuccessfulRead(40.0f, 18.0f, 40.0f, 6.5f, 1.2f, 3.0f, 5.0f,
+                                8.0f);
+    MockSoilSensor probes[metric::kSoilProbes];
+    for (std::size_t i = 0; i + 1 < metric::kSoilProbes; ++i) {
+        TEST_ASSERT_TRUE(f.controller.addSoilProbe(probes[i]));
+        probes[i].lastReadOk = true;
+        probes[i].moisture = 30.0f + static_cast<float>(i);
+    }
+    TEST_ASSERT_FALSE(f.controller.addSoilProbe(probes[metric::kSoilProbes - 1]));
+    probes[1].lastReadOk = false;     // its last read failed
+    probes[2].moisture = 150.0f;      // out of range
+
+    f.clock.advance(1000);
+    f.controller.tick();
+    // 10 from the primary + probes 2, 5, 6, 7.
+    TEST_ASSERT_EQUAL_INT(14, sensorReadingCount(f.storage));
+    TEST_ASSERT_EQUAL_INT(1, f.storage.batchWrites);
+    TEST_ASSERT_EQUAL_INT(0, f.storage.rejectedWrites);
+    const auto second = f.storage.getSensorReadings("soil_moisture_2", 0, UINT32_MAX);
+    TEST_ASSERT_EQUAL_INT(1, static_cast<int>(second.size()));
+    TEST_ASSERT_EQUAL_FLOAT(30.0f, second[0].value);
+    TEST_ASSERT_TRUE(
+        f.storage.getSensorReadings("soil_moisture_3", 0, UINT32_MAX).empty());
+    TEST_ASSERT_TRUE(
+        f.storage.getSensorReadings("soil_moisture_4", 0, UINT32_MAX).empty());
+    const auto last = f.storage.getSensorReadings("soil_moisture_7", 0, UINT32_MAX);
+    TEST_ASSERT_EQUAL_INT(1, static_cast<int>(last.size()));
+    TEST_ASSERT_EQUAL_FLOAT(35.0f, last[0].value);
+    for (const MockSoilSensor& probe : probes) {
+        TEST_ASSERT_EQUAL_INT(0, probe.readCalls);
+    }
+}
+
+// A metric with a log policy is logged only on a change beyond its
+// deadband or once its heartbeat has elapsed; metrics without one keep
+// logging every pass.
+void test_data_log_policy_skips_steady_values(void)
+{
+    Fixture f;
+    f.config.stored.dataLogIntervalMs = 60'000;
+    // pH: change-only (band 0) with a 180 s heartbeat; moisture: 5 % of
+    // the last logged value.
+    f.config.stored.logPolicies[metric::kSoilPh] = MetricLogPolicy{0.0f, 0.0f, 180};
+    f.config.stored.logPolicies[metric::kSoilMoisture] = MetricLogPolicy{0.0f, 0.05f, 600};
+    f.env.scriptSuccessfulRead(21.5f, 55.0f, 1013.0f);
+    // One scripted soil read per pass (moisture, pH), consumed in order.
+    const float passes[][2] = {
+        {40.0f, 6.5f},  // 1: first pass, everything logged
+        {41.0f, 6.5f},  // 2: within 5 % of 40, pH unchanged: both skipped
+        {43.0f, 6.5f},  // 3: 3 > 2, moisture logged
+        {43.0f, 6.5f},  // 4: 180 s since the last pH point, heartbeat logs it
+        {43.0f, 6.6f},  // 5: any change logs a change-only metric
+    };
+    for (const auto& p : passes) {
+        f.soil.scriptSuccessfulRead(p[0], 18.0f, p[0], p[1], 1.2f, 3.0f, 5.0f, 8.0f);
+    }
+    uint32_t epoch = 1'700'000'000;
+    auto pass = [&]() {
+        f.wallClock.setEpoch(epoch);
+        f.clock.advance(60'000);
+        f.controller.tick();
+        epoch += 60;
+    };
+    auto logged = [&](const char* name) {
+        return static_cast<int>(f.storage.getSensorReadings(name, 0, UINT32_MAX).size());
+    };
+
+    pass();
+    pass();
+    pass();
+    TEST_ASSERT_EQUAL_INT(2, logged("soil_moisture"));
+    TEST_ASSERT_EQUAL_INT(1, logged("soil_ph"));
+    pass();
+    TEST_ASSERT_EQUAL_INT(2, logged("soil_ph"));
+    pass();
+    TEST_ASSERT_EQUAL_INT(3, logged("soil_ph"));
+
+    TEST_ASSERT_EQUAL_INT(5, logged("soil_temperature"));  // no policy
+    // Skipped: moisture on passes 2, 4 and 5, pH on passes 2 and 3.
+    TEST_ASSERT_EQUAL_INT(2, logged("soil_moisture"));
+    TEST_ASSERT_EQUAL_UINT32(5, f.controller.skippedSamples());
+}
+
+// Write-behind storage is polled for its commit deadline on EVERY tick —
+// inside the log interval and before time is set too — so buffered history
+// never waits for the next due log batch.
+void test_data_log_polls_storage_flush_every_tick(void)
+{
+    Fixture f;
+    f.config.stored.dataLogIntervalMs = 60'000;
+    f.env.scriptSuccessfulRead(21.5f, 55.0f, 1013.0f);
+    f.soil.scriptSuccessfulRead(40.0f, 18.0f, 40.0f, 6.5f, 1.2f, 3.0f, 5.0f,
+                                8.0f);
+
+    f.clock.advance(1000);
+    f.controller.tick();  // time not set: nothing logged, still polled
+    TEST_ASSERT_EQUAL_INT(1, f.storage.flushIfDueCalls);
+
+    f.wallClock.setEpoch(1'700'000'000);
+    f.clock.advance(1000);
+    f.controller.tick();  // logs a batch
+    f.clock.advance(1000);
+    f.controller.tick();  // inside the interval
+    TEST_ASSERT_EQUAL_INT(3, f.storage.flushIfDueCalls);
+    TEST_ASSERT_EQUAL_INT(0, f.storage.flushCalls);  // never a forced commit
 }
 
 // FR-014: stored readings carry nowEpoch() as their timestamp, and an NPK
@@ -685,9 +929,10 @@ void test_data_log_runs_on_failsafe_path(void)
 }
 
 // FR-014: env read fails while soil is valid and time is set -> no env metrics
-// are logged (the env branch is gated on read() && isAvailable()), while the
-// soil metrics are still logged this tick. Mirror of the fail-safe-path test,
-// exercising the OTHER data-log branch (env failure instead of soil failure).
+// are logged (the env branch is gated on read() and snapshot().valid), while
+// the soil metrics are still logged this tick. Mirror of the fail-safe-path
+// test, exercising the OTHER data-log branch (env failure instead of soil
+// failure).
 void test_data_log_env_read_failure(void)
 {
     Fixture f;
@@ -724,6 +969,45 @@ void test_data_log_env_read_failure(void)
                    .size()));
 }
 
+// With setEnvAcquired() the data log never reads the env sensor: it takes
+// the sensor task's sample, once per sequence number.
+void test_data_log_takes_acquired_env_sample_once(void)
+{
+    Fixture f;
+    f.config.stored.dataLogIntervalMs = 60'000;
+    f.wallClock.setEpoch(1'700'000'000);
+    f.controller.setEnvAcquired(10'000);
+    f.env.scriptSuccessfulRead(21.5f, 55.0f, 1013.0f);
+    TEST_ASSERT_TRUE(f.env.read());  // the sensor task's read
+    f.env.readCalls = 0;
+
+    f.clock.advance(1000);
+    f.controller.tick();
+    TEST_ASSERT_EQUAL_INT(0, f.env.readCalls);
+    TEST_ASSERT_EQUAL_INT(
+        1, static_cast<int>(
+               f.storage.getSensorReadings("env_temperature", 0, UINT32_MAX)
+                   .size()));
+
+    // Next log, no new sample: not logged again.
+    f.clock.advance(60'000);
+    f.controller.tick();
+    TEST_ASSERT_EQUAL_INT(0, f.env.readCalls);
+    TEST_ASSERT_EQUAL_INT(
+        1, static_cast<int>(
+               f.storage.getSensorReadings("env_temperature", 0, UINT32_MAX)
+                   .size()));
+
+    // A new sample is.
+    TEST_ASSERT_TRUE(f.env.read());
+    f.clock.advance(60'000);
+    f.controller.tick();
+    TEST_ASSERT_EQUAL_INT(
+        2, static_cast<int>(
+               f.storage.getSensorReadings("env_temperature", 0, UINT32_MAX)
+                   .size()));
+}
+
 // FR-014: NPK filter is per-channel — phosphorus < 0 AND potassium < 0 are both
 // skipped while nitrogen (>= 0) and the soil-base metrics are logged.
 void test_data_log_npk_phosphorus_potassium_negative(void)
@@ -796,6 +1080,281 @@ void test_soak_origin_armed_on_high_threshold_stop(void)
     TEST_ASSERT_TRUE(f.pump.isRunning());
 }
 
+// ---------------------------------------------------------------------------
+// Soil feed (on-target wiring): the soil task reads and publishes; tick()
+// decides on the newest sample without touching the bus.
+// ---------------------------------------------------------------------------
+
+void test_soil_feed_decides_without_reading(void)
+{
+    Fixture f;
+    SoilAcquirer feed(f.soil, f.clock);
+    f.controller.setSoilFeed(feed);
+    setSensor(f, true, true, 20.0f);
+
+    // Nothing published yet: unavailable, no action, no read.
+    f.controller.tick();
+    TEST_ASSERT_FALSE(f.pump.isRunning());
+    TEST_ASSERT_EQUAL_INT(0, f.soil.readCalls);
+
+    // The soil task's read lands; the next tick acts on it.
+    feed.acquire();
+    f.controller.tick();
+    TEST_ASSERT_TRUE(f.pump.isRunning());
+    TEST_ASSERT_EQUAL_INT(1, f.soil.readCalls);
+}
+
+// Staleness runs from the sample's own timestamp: ticks without new data keep
+// the last sample's age growing and fail safe once it passes 30 s.
+void test_soil_feed_stale_from_sample_time(void)
+{
+    Fixture f;
+    f.config.stored.wateringDurationS = 300;
+    SoilAcquirer feed(f.soil, f.clock);
+    f.controller.setSoilFeed(feed);
+    setSensor(f, true, true, 20.0f);
+    feed.acquire();
+    f.clock.advance(5000);  // decided on well after the read finished
+    f.controller.tick();
+    TEST_ASSERT_TRUE(f.pump.isRunning());
+
+    f.clock.advance(25'000);  // sample 30 s old: still inside the window
+    f.controller.tick();
+    TEST_ASSERT_TRUE(f.pump.isRunning());
+
+    f.clock.advance(1);
+    f.controller.tick();
+    TEST_ASSERT_FALSE(f.pump.isRunning());
+    TEST_ASSERT_EQUAL_STRING("soil-stale", lastFailsafeReason(f.storage).c_str());
+    TEST_ASSERT_EQUAL_INT(1, f.soil.readCalls);
+}
+
+// One sample is logged once, however many ticks see it.
+void test_soil_feed_sample_logged_once(void)
+{
+    Fixture f;
+    f.config.stored.dataLogIntervalMs = 60'000;
+    f.wallClock.setEpoch(1'700'000'000);
+    SoilAcquirer feed(f.soil, f.clock);
+    f.controller.setSoilFeed(feed);
+    setSensor(f, true, true, 40.0f);
+    auto soilLogged = [&] {
+        return static_cast<int>(
+            f.storage.getSensorReadings("soil_moisture", 0, UINT32_MAX).size());
+    };
+
+    feed.acquire();
+    f.controller.tick();
+    TEST_ASSERT_EQUAL_INT(1, soilLogged());
+
+    f.clock.advance(60'000);  // log due, but no new sample
+    f.controller.tick();
+    TEST_ASSERT_EQUAL_INT(1, soilLogged());
+
+    f.clock.advance(60'000);
+    feed.acquire();
+    f.controller.tick();
+    TEST_ASSERT_EQUAL_INT(2, soilLogged());
+}
+
+// A slow-group sample (EC/pH/NPK only) is no fresh moisture: it neither
+// refreshes the staleness clock nor starts a decision.
+void test_soil_feed_slow_group_sample_is_not_fresh_moisture(void)
+{
+    Fixture f;
+    f.config.stored.wateringDurationS = 300;
+    SoilAcquirer feed(f.soil, f.clock);
+    f.controller.setSoilFeed(feed);
+    setSensor(f, true, true, 20.0f);
+    feed.acquire(SoilReadGroup::Fast);
+    f.controller.tick();
+    TEST_ASSERT_TRUE(f.pump.isRunning());
+
+    f.clock.advance(30'001);
+    feed.acquire(SoilReadGroup::Slow);
+    f.controller.tick();
+    TEST_ASSERT_FALSE(f.pump.isRunning());
+    TEST_ASSERT_EQUAL_STRING("soil-stale", lastFailsafeReason(f.storage).c_str());
+}
+
+// A sample the feed marks suspect (flatline) fails safe: the burst stops and
+// one "soil-flatline" event is logged, however long the flag stays up.
+void test_soil_feed_flatline_fails_safe_once(void)
+{
+    Fixture f;
+    f.config.stored.wateringDurationS = 300;
+    SoilAcquirer feed(f.soil, f.clock);
+    FlatlineSettings settings;
+    settings.minFlatMs = 10'000;
+    settings.minRunSamples = 3;
+    FlatlineDetector flatline(settings);
+    feed.setFlatline(&flatline);
+    f.controller.setSoilFeed(feed);
+    setSensor(f, true, true, 20.0f);
+    feed.acquire();
+    f.controller.tick();
+    TEST_ASSERT_TRUE(f.pump.isRunning());
+
+    f.clock.advance(5000);
+    feed.acquire();
+    f.controller.tick();
+    TEST_ASSERT_TRUE(f.pump.isRunning());
+
+    f.clock.advance(5000);  // third identical read, 10 s in: flat
+    feed.acquire();
+    f.controller.tick();
+    TEST_ASSERT_FALSE(f.pump.isRunning());
+    TEST_ASSERT_EQUAL_INT(1, failsafeEventCount(f.storage));
+    TEST_ASSERT_EQUAL_STRING("soil-flatline", lastFailsafeReason(f.storage).c_str());
+
+    for (int i = 0; i < 3; ++i) {
+        f.clock.advance(5000);
+        feed.acquire();
+        f.controller.tick();
+        TEST_ASSERT_FALSE(f.pump.isRunning());
+    }
+    TEST_ASSERT_EQUAL_INT(1, failsafeEventCount(f.storage));
+}
+
+// The event-driven watering task sleeps until nextDeadlineMs(): the earlier
+// of the staleness expiry and the next data-log slot, nothing before the
+// first sample. soakEndsAtMs() is the soak end while one is pending.
+void test_deadlines_for_the_event_driven_task(void)
+{
+    Fixture f;
+    f.config.stored.dataLogIntervalMs = 60'000;
+    f.wallClock.setEpoch(1'700'000'000);
+    const int64_t t0 = f.clock.nowMs();
+    TEST_ASSERT_TRUE(f.controller.nextDeadlineMs(t0) == INT64_MAX);
+    TEST_ASSERT_TRUE(f.controller.soakEndsAtMs(t0) == 0);
+
+    setSensor(f, true, true, 20.0f);
+    f.controller.tick();
+    TEST_ASSERT_TRUE(f.pump.isRunning());
+    TEST_ASSERT_TRUE(f.controller.nextDeadlineMs(t0) ==
+                     t0 + WateringController::kStalenessMs + 1);
+    // Past the staleness expiry only the data-log slot is left.
+    TEST_ASSERT_TRUE(f.controller.nextDeadlineMs(t0 + 40'000) == t0 + 60'000);
+
+    f.clock.advance(1000);
+    setSensor(f, true, true, 60.0f);
+    f.controller.tick();
+    TEST_ASSERT_FALSE(f.pump.isRunning());
+    const int64_t t1 = f.clock.nowMs();
+    TEST_ASSERT_TRUE(f.controller.soakEndsAtMs(t1) == t1 + 300'000);
+    TEST_ASSERT_TRUE(f.controller.soakEndsAtMs(t1 + 300'000) == 0);
+}
+
+// With a burst sizer the first two bursts run the configured 20 s; their
+// rise after the soak (10 % per 20 s) sizes the third to reach the high
+// threshold: (55 - 25) / 0.5 = 60 s.
+void test_burst_sized_from_learnt_response(void)
+{
+    Fixture f;
+    MoistureResponse response;
+    f.controller.setBurstSizer(response);
+
+    for (int i = 0; i < 2; ++i) {
+        setSensor(f, true, true, 22.0f);
+        f.controller.tick();
+        TEST_ASSERT_TRUE(f.pump.isRunning());
+        f.clock.advance(20'000);
+        f.controller.tick();  // self-stop at 20 s: the soak starts
+        TEST_ASSERT_FALSE(f.pump.isRunning());
+        f.clock.advance(300'000);
+        setSensor(f, true, true, 32.0f);
+        f.controller.tick();  // the rise is read once the soak is over
+        TEST_ASSERT_FALSE(f.pump.isRunning());
+        f.clock.advance(100'000);
+    }
+    TEST_ASSERT_TRUE(response.learnt());
+
+    setSensor(f, true, true, 25.0f);
+    f.controller.tick();
+    TEST_ASSERT_TRUE(f.pump.isRunning());
+    f.clock.advance(59'000);
+    f.pump.update();
+    TEST_ASSERT_TRUE(f.pump.isRunning());
+    f.clock.advance(1000);
+    f.pump.update();
+    TEST_ASSERT_FALSE(f.pump.isRunning());
+    TEST_ASSERT_EQUAL_INT(static_cast<int>(StopReason::DurationElapsed),
+                          static_cast<int>(f.pump.getLastStopReason()));
+}
+
+/// WaterPump with no output: MockWaterPump records its calls in a vector.
+class SilentPump : public WaterPump {
+public:
+    using WaterPump::WaterPump;
+
+protected:
+    bool applyOutput(bool) override { return true; }
+};
+
+void test_steady_state_tick_does_not_allocate(void)
+{
+    // The on-target shape: writes go into the storage queue's fixed slots,
+    // the burst sizer and the decision trace are on.
+    FakeTimeProvider clock;
+    MockSoilSensor soil;
+    MockEnvironmentalSensor env;
+    SilentPump pump{"plant", clock};
+    MockConfigStore config;
+    MockDataStorage backend;
+    QueuedDataStorage storage{backend, 64};
+    FakeWallClock wallClock{1'780'000'000};
+    EventLogger events{storage, wallClock};
+    WateringController controller{soil,    env,   pump,      config,
+                                  storage, clock, wallClock, events};
+    MoistureResponse response;
+    DecisionTrace trace;
+    TEST_ASSERT_TRUE(pump.initialize());
+    config.stored.moistureThresholdLow = 30.0f;
+    config.stored.moistureThresholdHigh = 55.0f;
+    config.stored.wateringDurationS = 20;
+    config.stored.minWateringIntervalS = 60;
+    config.stored.wateringEnabled = 1;
+    controller.setBurstSizer(response);
+    controller.setTrace(trace, 0);
+    soil.readResult = true;
+    soil.moisture = 40.0f;
+    controller.tick();  // first tick: loads the settings
+    storage.drain();
+
+    // An hour of 5 s ticks: the bed dries, bursts wet it, data logs run
+    // every minute, and the third burst fails safe on an out-of-range read.
+    uint32_t bursts = 0;
+    float moisture = soil.moisture;
+    for (int i = 0; i < 720; ++i) {
+        clock.advance(5000);
+        wallClock.setEpoch(wallClock.nowEpoch() + 5);
+        moisture += pump.isRunning() ? 4.0f : -0.4f;
+        soil.moisture = (bursts == 3 && pump.isRunning()) ? 150.0f : moisture;
+        const bool wasRunning = pump.isRunning();
+        EXPECT_NO_ALLOC { controller.tick(); }
+        bursts += (!wasRunning && pump.isRunning()) ? 1 : 0;
+        storage.drain();  // the writer task's work, outside the tick
+    }
+    TEST_ASSERT_TRUE(bursts >= 5);
+    TEST_ASSERT_TRUE(failsafeEventCount(backend) >= 1);
+    TEST_ASSERT_TRUE(sensorReadingCount(backend) > 0);
+
+    // The console and API paths: a manual run and its stop, events and all.
+    if (pump.isRunning()) {
+        controller.stop();
+        storage.drain();
+    }
+    bool started = false;
+    EXPECT_NO_ALLOC { started = controller.startManual(30); }
+    TEST_ASSERT_TRUE(started);
+    clock.advance(5000);
+    EXPECT_NO_ALLOC {
+        controller.tick();
+        controller.stop();
+    }
+    TEST_ASSERT_FALSE(pump.isRunning());
+}
+
 }  // namespace
 
 void run_watering_controller_tests(void)
@@ -805,8 +1364,10 @@ void run_watering_controller_tests(void)
     RUN_TEST(test_no_start_when_disabled);
     RUN_TEST(test_stops_at_high_threshold);
     RUN_TEST(test_soak_pause_blocks_then_allows_restart);
+    RUN_TEST(test_status_published_for_other_tasks);
     RUN_TEST(test_soak_origin_armed_on_high_threshold_stop);
     RUN_TEST(test_config_change_picked_up_next_tick);
+    RUN_TEST(test_settings_cached_until_generation_moves);
     RUN_TEST(test_no_action_before_first_successful_read);
     RUN_TEST(test_gate_on_transient_failed_read);
     RUN_TEST(test_boundaries_low_and_high_inclusive);
@@ -823,12 +1384,26 @@ void run_watering_controller_tests(void)
     RUN_TEST(test_manual_run_bypasses_sensor_failure);
     RUN_TEST(test_manual_run_capped_at_300s);
     RUN_TEST(test_manual_run_lower_clamp);
+    RUN_TEST(test_manual_volume_run);
     RUN_TEST(test_auto_run_is_not_flagged_manual);
     RUN_TEST(test_stop_clears_manual_override);
     RUN_TEST(test_data_log_cadence);
+    RUN_TEST(test_data_log_interval_override);
+    RUN_TEST(test_data_log_polls_storage_flush_every_tick);
+    RUN_TEST(test_data_log_policy_skips_steady_values);
     RUN_TEST(test_data_log_epoch_and_npk_filter);
+    RUN_TEST(test_data_log_further_probes);
     RUN_TEST(test_data_log_gated_on_time_set);
     RUN_TEST(test_data_log_runs_on_failsafe_path);
     RUN_TEST(test_data_log_env_read_failure);
+    RUN_TEST(test_data_log_takes_acquired_env_sample_once);
     RUN_TEST(test_data_log_npk_phosphorus_potassium_negative);
+    RUN_TEST(test_soil_feed_decides_without_reading);
+    RUN_TEST(test_soil_feed_stale_from_sample_time);
+    RUN_TEST(test_soil_feed_sample_logged_once);
+    RUN_TEST(test_soil_feed_slow_group_sample_is_not_fresh_moisture);
+    RUN_TEST(test_soil_feed_flatline_fails_safe_once);
+    RUN_TEST(test_deadlines_for_the_event_driven_task);
+    RUN_TEST(test_burst_sized_from_learnt_response);
+    RUN_TEST(test_steady_state_tick_does_not_allocate);
 }
@@ -0,0 +1,219 @@
+// SPDX-FileCopyrightText: 2026 Cryptotomte
+// SPDX-License-Identifier: AGPL-3.0-or-later
+/**
+ * @file test_watering_schedule.cpp
+ * @brief Host suite for the watering windows (WateringSchedule) and their
+ *        use by WateringController.
+ *
+ * Registered by test_main.cpp via run_watering_schedule_tests(), which sets
+ * the Swedish TZ rule like run_time_tests(). The rule text parses into
+ * weekday/minute rules and rejects malformed entries; windows and blackouts
+ * combine, a window runs past midnight, and the edges follow DST; a dry
+ * soil waits for the window while the controller names the opening, a
+ * burst stops when its window closes and arms the soak pause, manual runs
+ * are exempt, and an unset wall clock does not hold watering back.
+ */
+
+#include <cstdint>
+#include <cstdlib>
+#include <ctime>
+
+#include "unity.h"
+
+#include "actuators/testing/FakeTimeProvider.h"
+#include "actuators/testing/MockWaterPump.h"
+#include "control/WateringController.h"
+#include "control/WateringSchedule.h"
+#include "events/EventLogger.h"
+#include "sensors/testing/MockEnvironmentalSensor.h"
+#include "sensors/testing/MockSoilSensor.h"
+#include "storage/testing/MockConfigStore.h"
+#include "storage/testing/MockDataStorage.h"
+#include "time/testing/FakeWallClock.h"
+
+namespace {
+
+/// Epoch of a local (TZ) date and time.
+uint32_t local(int year, int month, int day, int hour, int minute)
+{
+    std::tm t{};
+    t.tm_year = year - 1900;
+    t.tm_mon = month - 1;
+    t.tm_mday = day;
+    t.tm_hour = hour;
+    t.tm_min = minute;
+    t.tm_isdst = -1;
+    return static_cast<uint32_t>(std::mktime(&t));
+}
+
+constexpr const char* kRules = "* 05:00-08:00; * 19:00-22:00; !Sa-Su 06:00-07:00";
+
+void test_parse_rules(void)
+{
+    WateringSchedule s;
+    TEST_ASSERT_TRUE(parseWateringSchedule(kRules, s));
+    TEST_ASSERT_EQUAL_size_t(3, s.size());
+    TEST_ASSERT_EQUAL_UINT8(0x7F, s.rule(0).days);
+    TEST_ASSERT_EQUAL_UINT16(300, s.rule(0).startMin);
+    TEST_ASSERT_EQUAL_UINT16(480, s.rule(0).endMin);
+    TEST_ASSERT_TRUE(s.rule(2).blackout);
+    TEST_ASSERT_EQUAL_UINT8(0x41, s.rule(2).days);  // Sa + Su wraps
+
+    WateringSchedule empty;
+    TEST_ASSERT_TRUE(parseWateringSchedule("  ", empty));
+    TEST_ASSERT_EQUAL_size_t(0, empty.size());
+
+    const char* bad[] = {"Xx 05:00-06:00", "* 05:60-06:00", "* 05:00-05:00",
+                         "* 24:00-01:00", "* 05:00 06:00", "Mo 05:00-06:00 Tu"};
+    for (const char* text : bad) {
+        WateringSchedule s2;
+        TEST_ASSERT_FALSE(parseWateringSchedule(text, s2));
+    }
+}
+
+void test_windows_and_blackouts(void)
+{
+    WateringSchedule s;
+    TEST_ASSERT_TRUE(parseWateringSchedule(kRules, s));
+
+    // Monday 2026-06-01: closed before dawn, opens at 05:00 until 08:00.
+    const uint32_t early = local(2026, 6, 1, 4, 59);
+    TEST_ASSERT_FALSE(s.allows(early));
+    TEST_ASSERT_EQUAL_UINT32(local(2026, 6, 1, 5, 0), s.nextEdge(early));
+    TEST_ASSERT_EQUAL_UINT32(local(2026, 6, 1, 5, 0), s.nextOpening(early));
+    TEST_ASSERT_TRUE(s.allows(local(2026, 6, 1, 5, 0)));
+    TEST_ASSERT_EQUAL_UINT32(0, s.nextOpening(local(2026, 6, 1, 6, 30)));
+    TEST_ASSERT_EQUAL_UINT32(local(2026, 6, 1, 8, 0),
+                             s.nextEdge(local(2026, 6, 1, 6, 30)));
+    TEST_ASSERT_EQUAL_UINT32(local(2026, 6, 1, 19, 0),
+                             s.nextOpening(local(2026, 6, 1, 12, 0)));
+
+    // Saturday: the blackout splits the morning window.
+    TEST_ASSERT_TRUE(s.allows(local(2026, 6, 6, 5, 30)));
+    TEST_ASSERT_FALSE(s.allows(local(2026, 6, 6, 6, 30)));
+    TEST_ASSERT_EQUAL_UINT32(local(2026, 6, 6, 7, 0),
+                             s.nextOpening(local(2026, 6, 6, 6, 30)));
+
+    // No rules: always allowed, no edges.
+    WateringSchedule none;
+    TEST_ASSERT_TRUE(none.allows(early));
+    TEST_ASSERT_EQUAL_UINT32(0, none.nextEdge(early));
+}
+
+void test_past_midnight_and_dst(void)
+{
+    WateringSchedule s;
+    TEST_ASSERT_TRUE(parseWateringSchedule("Fr 22:00-02:00", s));
+    TEST_ASSERT_TRUE(s.allows(local(2026, 6, 5, 23, 30)));  // Friday
+    TEST_ASSERT_TRUE(s.allows(local(2026, 6, 6, 1, 0)));    // started Friday
+    TEST_ASSERT_FALSE(s.allows(local(2026, 6, 6, 23, 0)));  // Saturday
+    TEST_ASSERT_EQUAL_UINT32(local(2026, 6, 12, 22, 0),
+                             s.nextOpening(local(2026, 6, 6, 2, 0)));
+
+    // Spring forward (Sunday 2026-03-29): 06:00 CET Saturday to 05:00 CEST
+    // Sunday is 22 h, not 23.
+    WateringSchedule dawn;
+    TEST_ASSERT_TRUE(parseWateringSchedule("* 05:00-06:00", dawn));
+    const uint32_t sat = local(2026, 3, 28, 6, 0);
+    TEST_ASSERT_EQUAL_UINT32(sat + 22u * 3600u, dawn.nextEdge(sat));
+}
+
+/// One zone (low 30 %, high 55 %, burst 300 s, soak 300 s) under kRules.
+struct Fixture {
+    FakeTimeProvider clock;
+    MockEnvironmentalSensor env;
+    MockConfigStore config;
+    MockDataStorage storage;
+    FakeWallClock wallClock;
+    EventLogger events{storage, wallClock};
+    MockSoilSensor soil;
+    MockWaterPump pump{"plant", clock};
+    WateringController controller{soil, env, pump, config, storage,
+                                  clock, wallClock, events};
+    WateringSchedule schedule;
+
+    Fixture()
+    {
+        config.stored.moistureThresholdLow = 30.0f;
+        config.stored.moistureThresholdHigh = 55.0f;
+        config.stored.wateringDurationS = 300;
+        config.stored.minWateringIntervalS = 300;
+        config.stored.wateringEnabled = 1;
+        TEST_ASSERT_TRUE(pump.initialize());
+        soil.readResult = true;
+        soil.isAvailableResult = true;
+        soil.moisture = 20.0f;
+        TEST_ASSERT_TRUE(parseWateringSchedule(kRules, schedule));
+        controller.setSchedule(schedule);
+    }
+
+    /// Advance both clocks by @p ms.
+    void advance(int64_t ms)
+    {
+        clock.advance(ms);
+        wallClock.setEpoch(wallClock.nowEpoch() + static_cast<uint32_t>(ms / 1000));
+    }
+};
+
+void test_dry_soil_waits_for_the_window(void)
+{
+    Fixture f;
+    f.wallClock.setEpoch(local(2026, 6, 1, 4, 50));
+    f.controller.tick();
+    TEST_ASSERT_FALSE(f.pump.isRunning());
+    const int64_t opensAt = f.clock.nowMs() + 600'000;
+    TEST_ASSERT_TRUE(f.controller.windowOpensAtMs(f.clock.nowMs()) == opensAt);
+    TEST_ASSERT_TRUE(f.controller.nextDeadlineMs(f.clock.nowMs()) <= opensAt);
+
+    f.advance(600'000);
+    f.controller.tick();
+    TEST_ASSERT_TRUE(f.pump.isRunning());
+    TEST_ASSERT_TRUE(f.controller.windowOpensAtMs(f.clock.nowMs()) == 0);
+}
+
+void test_window_close_ends_the_burst_and_arms_the_soak(void)
+{
+    Fixture f;
+    f.wallClock.setEpoch(local(2026, 6, 1, 7, 59));
+    f.controller.tick();
+    TEST_ASSERT_TRUE(f.pump.isRunning());
+    TEST_ASSERT_TRUE(f.controller.nextDeadlineMs(f.clock.nowMs()) <=
+                     f.clock.nowMs() + 60'000);
+
+    f.advance(60'000);  // 08:00: the window closes mid-burst
+    f.controller.tick();
+    TEST_ASSERT_FALSE(f.pump.isRunning());
+    TEST_ASSERT_TRUE(f.controller.soakEndsAtMs(f.clock.nowMs()) ==
+                     f.clock.nowMs() + 300'000);
+
+    // A manual run is an override: it starts and keeps running outside.
+    TEST_ASSERT_TRUE(f.controller.startManual(30));
+    f.advance(1000);
+    f.controller.tick();
+    TEST_ASSERT_TRUE(f.pump.isRunning());
+}
+
+void test_unset_wall_clock_does_not_hold_back(void)
+{
+    Fixture f;
+    f.controller.tick();
+    TEST_ASSERT_TRUE(f.pump.isRunning());
+    TEST_ASSERT_TRUE(f.controller.windowOpensAtMs(f.clock.nowMs()) == 0);
+}
+
+}  // namespace
+
+void run_watering_schedule_tests(void)
+{
+    // Swedish timezone rule (mirrors SntpClient::applyTimezone()), so the
+    // local windows and the DST edge land as on target.
+    setenv("TZ", "CET-1CEST,M3.5.0,M10.5.0/3", 1);
+    tzset();
+
+    RUN_TEST(test_parse_rules);
+    RUN_TEST(test_windows_and_blackouts);
+    RUN_TEST(test_past_midnight_and_dst);
+    RUN_TEST(test_dry_soil_waits_for_the_window);
+    RUN_TEST(test_window_close_ends_the_burst_and_arms_the_soak);
+    RUN_TEST(test_unset_wall_clock_does_not_hold_back);
+}
@@ -0,0 +1,192 @@
+// SPDX-FileCopyrightText: 2026 Cryptotomte
+// SPDX-License-Identifier: AGPL-3.0-or-later
+/**
+ * @file test_watering_zones.cpp
+ * @brief Host suite for multi-zone watering (WateringZones.h, PumpBudget.h
+ *        and the zone wiring of WateringController).
+ *
+ * Registered by test_main.cpp via run_watering_zones_tests(). Zones share a
+ * pump budget: a dry zone waits while the supply is busy and starts once a
+ * burst ends, and the zone ticked first rotates; a fail-safe stop frees
+ * the slot; manual runs take none; zone overrides replace the configured
+ * thresholds and burst; only the logging zone writes the data log; the
+ * set's deadlines are the earliest of its zones.
+ */
+
+#include <cstdint>
+
+#include "unity.h"
+
+#include "actuators/testing/FakeTimeProvider.h"
+#include "actuators/testing/MockWaterPump.h"
+#include "control/PumpBudget.h"
+#include "control/WateringController.h"
+#include "control/WateringZones.h"
+#include "events/EventLogger.h"
+#include "sensors/testing/MockEnvironmentalSensor.h"
+#include "sensors/testing/MockSoilSensor.h"
+#include "storage/testing/MockConfigStore.h"
+#include "storage/testing/MockDataStorage.h"
+#include "time/testing/FakeWallClock.h"
+
+namespace {
+
+/// Three zones over one clock, config and store (low 30 %, high 55 %,
+/// burst 20 s, soak 300 s), sharing a budget of @p capacity pumps.
+struct Fixture {
+    FakeTimeProvider clock;
+    MockEnvironmentalSensor env;
+    MockConfigStore config;
+    MockDataStorage storage;
+    FakeWallClock wallClock;
+    EventLogger events{storage, wallClock};
+    MockSoilSensor soil[3];
+    MockWaterPump pump[3] = {{"plant", clock}, {"bed2", clock}, {"bed3", clock}};
+    WateringController zone[3] = {
+        {soil[0], env, pump[0], config, storage, clock, wallClock, events},
+        {soil[1], env, pump[1], config, storage, clock, wallClock, events},
+        {soil[2], env, pump[2], config, storage, clock, wallClock, events},
+    };
+    PumpBudget budget;
+    WateringZones zones;
+
+    explicit Fixture(uint32_t capacity) : budget(capacity)
+    {
+        config.stored.moistureThresholdLow = 30.0f;
+        config.stored.moistureThresholdHigh = 55.0f;
+        config.stored.wateringDurationS = 20;
+        config.stored.minWateringIntervalS = 300;
+        config.stored.wateringEnabled = 1;
+        for (int i = 0; i < 3; ++i) {
+            TEST_ASSERT_TRUE(pump[i].initialize());
+            soil[i].readResult = true;
+            soil[i].isAvailableResult = true;
+            soil[i].moisture = 50.0f;
+            zone[i].setZone(ZoneSettings{}, &budget, i == 0);
+            TEST_ASSERT_TRUE(zones.add(zone[i]));
+        }
+    }
+
+    int running() const
+    {
+        int n = 0;
+        for (const MockWaterPump& p : pump) {
+            n += p.isRunning() ? 1 : 0;
+        }
+        return n;
+    }
+};
+
+void test_budget_caps_concurrent_bursts(void)
+{
+    Fixture f(2);
+    for (MockSoilSensor& s : f.soil) {
+        s.moisture = 20.0f;
+    }
+    f.zones.tick();
+    TEST_ASSERT_EQUAL_INT(2, f.running());
+    TEST_ASSERT_EQUAL_UINT32(2, f.budget.inUse());
+    TEST_ASSERT_FALSE(f.pump[2].isRunning());  // zone 0 went first
+
+    // The bursts self-stop at 20 s; the waiting zone takes a slot at once.
+    f.clock.advance(20'000);
+    f.zones.tick();
+    TEST_ASSERT_TRUE(f.pump[2].isRunning());
+    TEST_ASSERT_EQUAL_INT(1, f.running());
+    TEST_ASSERT_EQUAL_UINT32(1, f.budget.inUse());
+}
+
+void test_first_zone_rotates(void)
+{
+    Fixture f(1);
+    f.zones.tick();  // nothing dry: zone 0 was first
+    for (MockSoilSensor& s : f.soil) {
+        s.moisture = 20.0f;
+    }
+    f.zones.tick();  // zone 1 goes first now
+    TEST_ASSERT_TRUE(f.pump[1].isRunning());
+    TEST_ASSERT_EQUAL_INT(1, f.running());
+}
+
+void test_failsafe_and_manual_runs_and_the_budget(void)
+{
+    Fixture f(1);
+    f.soil[0].moisture = 20.0f;
+    f.zones.tick();
+    TEST_ASSERT_TRUE(f.pump[0].isRunning());
+
+    // Zone 0's probe goes out of range: the fail-safe stop frees the slot.
+    f.clock.advance(1000);
+    f.soil[0].moisture = 120.0f;
+    f.soil[1].moisture = 20.0f;
+    f.zones.tick();  // zone 1 ticked first and found no slot
+    TEST_ASSERT_FALSE(f.pump[0].isRunning());
+    TEST_ASSERT_FALSE(f.pump[1].isRunning());
+    TEST_ASSERT_EQUAL_UINT32(0, f.budget.inUse());
+    f.zones.tick();
+    TEST_ASSERT_TRUE(f.pump[1].isRunning());
+    TEST_ASSERT_EQUAL_UINT32(1, f.budget.inUse());
+
+    // A manual run is an override: it takes no slot and is not refused.
+    TEST_ASSERT_TRUE(f.zone[2].startManual(30));
+    TEST_ASSERT_EQUAL_UINT32(1, f.budget.inUse());
+    TEST_ASSERT_EQUAL_INT(2, f.running());
+}
+
+void test_zone_overrides_and_data_log(void)
+{
+    Fixture f(3);
+    f.wallClock.setEpoch(1'700'000'000);
+    ZoneSettings wetBed;
+    wetBed.moistureThresholdLow = 40.0f;
+    wetBed.wateringDurationS = 45;
+    f.zone[1].setZone(wetBed, &f.budget, false);
+
+    for (MockSoilSensor& s : f.soil) {
+        s.moisture = 35.0f;  // dry only by zone 1's own threshold
+    }
+    f.zones.tick();
+    TEST_ASSERT_TRUE(f.pump[1].isRunning());
+    TEST_ASSERT_EQUAL_INT(1, f.running());
+    f.clock.advance(44'000);
+    f.pump[1].update();
+    TEST_ASSERT_TRUE(f.pump[1].isRunning());
+    f.clock.advance(1000);
+    f.pump[1].update();
+    TEST_ASSERT_FALSE(f.pump[1].isRunning());
+
+    // Only zone 0 logged: one batch with its soil moisture.
+    TEST_ASSERT_EQUAL_INT(
+        1, static_cast<int>(
+               f.storage.getSensorReadings("soil_moisture", 0, UINT32_MAX).size()));
+}
+
+void test_deadlines_are_the_earliest_zone(void)
+{
+    Fixture f(3);
+    const int64_t t0 = f.clock.nowMs();
+    TEST_ASSERT_TRUE(f.zones.nextDeadlineMs(t0) == INT64_MAX);
+    TEST_ASSERT_TRUE(f.zones.soakEndsAtMs(t0) == 0);
+
+    f.soil[2].moisture = 20.0f;
+    f.zones.tick();
+    TEST_ASSERT_TRUE(f.zones.nextDeadlineMs(t0) ==
+                     t0 + WateringController::kStalenessMs + 1);
+
+    f.clock.advance(20'000);
+    f.soil[2].moisture = 50.0f;
+    f.zones.tick();  // zone 2's burst self-stopped: its soak runs
+    const int64_t t1 = f.clock.nowMs();
+    TEST_ASSERT_TRUE(f.zones.soakEndsAtMs(t1) == t1 + 300'000);
+}
+
+}  // namespace
+
+void run_watering_zones_tests(void)
+{
+    RUN_TEST(test_budget_caps_concurrent_bursts);
+    RUN_TEST(test_first_zone_rotates);
+    RUN_TEST(test_failsafe_and_manual_runs_and_the_budget);
+    RUN_TEST(test_zone_overrides_and_data_log);
+    RUN_TEST(test_deadlines_are_the_earliest_zone);
+}
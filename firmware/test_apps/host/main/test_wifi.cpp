@@ -18,10 +18,12 @@
  */
 
 #include <string>
+#include <vector>
 
 #include "unity.h"
 
 #include "actuators/testing/FakeTimeProvider.h"
+#include "network/StaticIpSettings.h"
 #include "network/WifiBootMode.h"
 #include "network/WifiCredentialValidation.h"
 #include "network/WifiManager.h"
@@ -40,6 +42,12 @@ int modeInt(WifiBootMode m) { return static_cast<int>(m); }
 /// static_cast<int> a WifiState for Unity's integer comparison.
 int stateInt(WifiState s) { return static_cast<int>(s); }
 
+/// Records every state the manager reports.
+struct StateRecorder : IWifiStateObserver {
+    void onStateChanged(WifiState state) override { states.push_back(state); }
+    std::vector<WifiState> states;
+};
+
 }  // namespace
 
 // ---------------------------------------------------------------------------
@@ -318,6 +326,42 @@ static void test_wifi_monitor_disconnect(void)
     TEST_ASSERT_FALSE(snap.ipAcquired);
 }
 
+// ---------------------------------------------------------------------------
+// State-change observer: one call per tick() that changed the state, with
+// the new state; ticks that change nothing report nothing.
+// ---------------------------------------------------------------------------
+static void test_wifi_observer_told_of_state_changes(void)
+{
+    MockWifiDriver driver;
+    MockConfigStore config;
+    FakeTimeProvider clock;
+    seedCredentials(config);
+
+    WifiManager manager(driver, config, clock, ReconnectPolicy{});
+    StateRecorder recorder;
+    manager.setObserver(&recorder);
+    manager.begin(WifiBootMode::Station);  // Connecting, from begin(): no call
+
+    driver.scriptConnectSuccess();
+    manager.tick();                        // Connected
+    clock.advance(6000);
+    manager.tick();                        // monitor refresh only
+    driver.queueEvent(WifiEvent::Disconnected);
+    manager.tick();                        // Reconnecting
+    clock.advance(10'000);
+    manager.tick();                        // retry: Connecting
+
+    TEST_ASSERT_EQUAL(3, static_cast<int>(recorder.states.size()));
+    TEST_ASSERT_EQUAL(stateInt(WifiState::Connected), stateInt(recorder.states[0]));
+    TEST_ASSERT_EQUAL(stateInt(WifiState::Reconnecting), stateInt(recorder.states[1]));
+    TEST_ASSERT_EQUAL(stateInt(WifiState::Connecting), stateInt(recorder.states[2]));
+
+    manager.setObserver(nullptr);
+    driver.scriptConnectSuccess();
+    manager.tick();
+    TEST_ASSERT_EQUAL(3, static_cast<int>(recorder.states.size()));
+}
+
 // ---------------------------------------------------------------------------
 // T015 #5 — AP/provisioning mode suspends all STA monitoring and reconnect,
 // regardless of elapsed time, and never leaves Provisioning. (contract §6)
@@ -584,6 +628,177 @@ static void test_wifi_emergency_reset_clear_intent(void)
     TEST_ASSERT_FALSE(shouldClearCredentialsOnBoot(false, false)); // first boot
 }
 
+// ---------------------------------------------------------------------------
+// Fast reconnect — with a cached AP the first attempt is directed, and a
+// failed one falls back to a full scan at once without counting toward the
+// pause; the full scan then keeps the 10 s cadence.
+// ---------------------------------------------------------------------------
+static void test_wifi_cached_ap_tier_falls_back_to_scan(void)
+{
+    MockWifiDriver driver;
+    MockConfigStore config;
+    FakeTimeProvider clock;
+    seedCredentials(config);
+    driver.cachedAp = true;
+
+    WifiManager manager(driver, config, clock, ReconnectPolicy{});
+    manager.begin(WifiBootMode::Station);
+    TEST_ASSERT_EQUAL(1, driver.staConnectCalls);
+    TEST_ASSERT_EQUAL(1, driver.cachedStaConnects);
+
+    // The directed attempt fails: a full scan is issued in the same tick.
+    driver.scriptConnectFailure();
+    manager.tick();
+    TEST_ASSERT_EQUAL(2, driver.staConnectCalls);
+    TEST_ASSERT_EQUAL(static_cast<int>(WifiConnectTier::FullScan),
+                      static_cast<int>(driver.lastStaTier));
+    TEST_ASSERT_EQUAL(stateInt(WifiState::Connecting),
+                      stateInt(manager.snapshot().state));
+    TEST_ASSERT_EQUAL_UINT8(0, manager.snapshot().consecutiveFailures);
+
+    // The scan fails too: the usual cadence, and no second directed attempt
+    // this round.
+    driver.scriptConnectFailure();
+    manager.tick();
+    TEST_ASSERT_EQUAL_UINT8(1, manager.snapshot().consecutiveFailures);
+    TEST_ASSERT_EQUAL(2, driver.staConnectCalls);
+    clock.advance(10000);
+    manager.tick();
+    TEST_ASSERT_EQUAL(3, driver.staConnectCalls);
+    TEST_ASSERT_EQUAL(1, driver.cachedStaConnects);
+
+    // Policy 0 directed attempts: always scan.
+    MockWifiDriver scanner;
+    scanner.cachedAp = true;
+    ReconnectPolicy policy;
+    policy.cachedAttempts = 0;
+    WifiManager scanOnly(scanner, config, clock, policy);
+    scanOnly.begin(WifiBootMode::Station);
+    TEST_ASSERT_EQUAL(0, scanner.cachedStaConnects);
+}
+
+// ---------------------------------------------------------------------------
+// Fast reconnect — a drop from Connected with a cached AP is retried at once
+// (directed), not after the 10 s retry interval; each GotIp re-arms it.
+// ---------------------------------------------------------------------------
+static void test_wifi_drop_reconnects_at_once_to_cached_ap(void)
+{
+    MockWifiDriver driver;
+    MockConfigStore config;
+    FakeTimeProvider clock;
+    seedCredentials(config);
+
+    WifiManager manager(driver, config, clock, ReconnectPolicy{});
+    manager.begin(WifiBootMode::Station);  // nothing cached yet: full scan
+    TEST_ASSERT_EQUAL(0, driver.cachedStaConnects);
+    driver.scriptConnectSuccess();
+    manager.tick();
+    driver.cachedAp = true;  // the driver remembered the AP on GotIp
+
+    for (int drop = 1; drop <= 2; ++drop) {
+        driver.queueEvent(WifiEvent::Disconnected);
+        manager.tick();
+        WifiConnectionSnapshot snap = manager.snapshot();
+        TEST_ASSERT_EQUAL(stateInt(WifiState::Connecting), stateInt(snap.state));
+        TEST_ASSERT_EQUAL_UINT32(static_cast<uint32_t>(drop), snap.disconnectCount);
+        TEST_ASSERT_EQUAL_UINT8(0, snap.consecutiveFailures);
+        TEST_ASSERT_EQUAL(drop, driver.cachedStaConnects);
+        TEST_ASSERT_EQUAL(static_cast<int>(WifiConnectTier::Cached),
+                          static_cast<int>(driver.lastStaTier));
+        driver.scriptConnectSuccess();
+        manager.tick();
+        TEST_ASSERT_EQUAL(stateInt(WifiState::Connected),
+                          stateInt(manager.snapshot().state));
+    }
+}
+
+// ---------------------------------------------------------------------------
+// Power save: the configured mode while idle, off at once while busy, back
+// only after busyLingerMs idle; a refused mode is retried; provisioning
+// makes no driver call.
+// ---------------------------------------------------------------------------
+static void test_wifi_power_save_off_while_busy(void)
+{
+    MockWifiDriver driver;
+    MockConfigStore config;
+    FakeTimeProvider clock;
+    seedCredentials(config);
+
+    WifiManager manager(driver, config, clock, ReconnectPolicy{});
+    manager.setPowerSavePolicy({WifiPowerSave::MaxModem, 10, 5000});
+    manager.begin(WifiBootMode::Station);
+    manager.tick();
+    TEST_ASSERT_EQUAL(1, driver.powerSaveCalls);
+    TEST_ASSERT_EQUAL(static_cast<int>(WifiPowerSave::MaxModem),
+                      static_cast<int>(driver.lastPowerSave));
+    TEST_ASSERT_EQUAL_UINT8(10, driver.lastListenInterval);
+    manager.tick();
+    TEST_ASSERT_EQUAL(1, driver.powerSaveCalls);  // unchanged: no call
+
+    manager.setBusy(true);
+    manager.tick();
+    TEST_ASSERT_EQUAL(static_cast<int>(WifiPowerSave::None),
+                      static_cast<int>(manager.snapshot().powerSave));
+    manager.setBusy(false);
+    clock.advance(4999);
+    manager.tick();
+    TEST_ASSERT_EQUAL(static_cast<int>(WifiPowerSave::None),
+                      static_cast<int>(driver.lastPowerSave));
+    driver.powerSaveResult = false;
+    clock.advance(1);
+    manager.tick();  // refused: still None, tried again next tick
+    TEST_ASSERT_EQUAL(static_cast<int>(WifiPowerSave::None),
+                      static_cast<int>(manager.snapshot().powerSave));
+    driver.powerSaveResult = true;
+    manager.tick();
+    TEST_ASSERT_EQUAL(static_cast<int>(WifiPowerSave::MaxModem),
+                      static_cast<int>(manager.snapshot().powerSave));
+    TEST_ASSERT_EQUAL(4, driver.powerSaveCalls);
+
+    MockWifiDriver apDriver;
+    WifiManager provisioning(apDriver, config, clock, ReconnectPolicy{});
+    provisioning.begin(WifiBootMode::Provisioning);
+    provisioning.setBusy(true);
+    provisioning.tick();
+    TEST_ASSERT_EQUAL(0, apDriver.powerSaveCalls);
+}
+
+// ---------------------------------------------------------------------------
+// Static IP text fields (portal form, `config ip`): strict dotted quads, an
+// empty address is DHCP, the set must pass isValidStaticIp().
+// ---------------------------------------------------------------------------
+static void test_static_ip_fields_parse_strictly(void)
+{
+    uint32_t addr = 0;
+    TEST_ASSERT_TRUE(parseIpv4("192.168.1.20", addr));
+    TEST_ASSERT_EQUAL_HEX32(0xC0A80114u, addr);
+    TEST_ASSERT_EQUAL_STRING("192.168.1.20", formatIpv4(addr).c_str());
+    TEST_ASSERT_TRUE(parseIpv4("0.0.0.0", addr));
+    TEST_ASSERT_EQUAL_HEX32(0u, addr);
+    for (const char* bad : {"", "192.168.1", "192.168.1.256", "1.2.3.4.5", "1..2.3",
+                            "1.2.3.4 ", "0001.2.3.4", "a.b.c.d", "-1.2.3.4"}) {
+        addr = 7;
+        TEST_ASSERT_FALSE(parseIpv4(bad, addr));
+        TEST_ASSERT_EQUAL_HEX32(7u, addr);
+    }
+
+    StaticIpConfig ip{1, 2, 3, 4};
+    TEST_ASSERT_TRUE(parseStaticIp("", "garbage", "", "", ip));  // DHCP
+    TEST_ASSERT_FALSE(ip.enabled());
+    TEST_ASSERT_TRUE(parseStaticIp("10.0.0.9", "255.255.255.0", "10.0.0.1", "", ip));
+    TEST_ASSERT_EQUAL_HEX32(0x0A000009u, ip.address);
+    TEST_ASSERT_EQUAL_HEX32(0x0A000001u, ip.gateway);
+    TEST_ASSERT_EQUAL_HEX32(0u, ip.dns);
+    // Missing mask, broadcast address, off-link gateway: rejected, untouched.
+    TEST_ASSERT_FALSE(parseStaticIp("10.0.0.5", "", "", "", ip));
+    TEST_ASSERT_FALSE(parseStaticIp("10.0.0.255", "255.255.255.0", "", "", ip));
+    TEST_ASSERT_FALSE(parseStaticIp("10.0.0.5", "255.255.255.0", "10.0.1.1", "", ip));
+    TEST_ASSERT_EQUAL_HEX32(0x0A000009u, ip.address);
+    // A /32 mask leaves no host part.
+    TEST_ASSERT_FALSE(IConfigStore::isValidStaticIp({0x0A000001u, 0xFFFFFFFFu, 0, 0}));
+    TEST_ASSERT_TRUE(IConfigStore::isValidStaticIp({0x0A000001u, 0xFF000000u, 0, 0}));
+}
+
 void run_wifi_tests(void)
 {
     // T008 — credential validation.
@@ -597,6 +812,7 @@ void run_wifi_tests(void)
     RUN_TEST(test_wifi_retry_only_at_10s);
     RUN_TEST(test_wifi_pause_after_5_failures);
     RUN_TEST(test_wifi_monitor_disconnect);
+    RUN_TEST(test_wifi_observer_told_of_state_changes);
     RUN_TEST(test_wifi_ap_mode_suspends);
     // T016 — FR-014 isolation / non-blocking tick.
     RUN_TEST(test_wifi_isolation_no_block_no_watering_dep);
@@ -608,4 +824,11 @@ void run_wifi_tests(void)
     RUN_TEST(test_wifi_no_boot_loop_under_permanent_failure);
     // T023 — emergency-reset boot decision + clear-credentials intent.
     RUN_TEST(test_wifi_emergency_reset_clear_intent);
+    // Fast reconnect — cached AP tier, then full scan.
+    RUN_TEST(test_wifi_cached_ap_tier_falls_back_to_scan);
+    RUN_TEST(test_wifi_drop_reconnects_at_once_to_cached_ap);
+    // Power save policy.
+    RUN_TEST(test_wifi_power_save_off_while_busy);
+    // Static IP form fields.
+    RUN_TEST(test_static_ip_fields_parse_strictly);
 }
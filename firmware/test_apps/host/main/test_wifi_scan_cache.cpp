@@ -0,0 +1,175 @@
+// SPDX-FileCopyrightText: 2026 Cryptotomte
+// SPDX-License-Identifier: AGPL-3.0-or-later
+/**
+ * @file test_wifi_scan_cache.cpp
+ * @brief Host suite for the setup portal's background scan cache
+ *        (network/WifiScanCache.h).
+ *
+ * The first tick starts a scan and the snapshot says "scanning" until it
+ * reports; results are deduplicated, sorted and capped; rescans follow the
+ * refresh interval or a request, never closer than kMinRescanMs; a scan
+ * that never reports is written off with the old list kept; the JSON body
+ * escapes SSIDs.
+ */
+
+#include <string>
+#include <vector>
+
+#include "unity.h"
+
+#include "actuators/testing/FakeTimeProvider.h"
+#include "network/WifiScanCache.h"
+#include "network/testing/MockWifiDriver.h"
+
+namespace {
+
+constexpr uint32_t kRefreshMs = 30000;
+
+WifiNetwork net(const char* ssid, int8_t rssi, uint8_t channel = 1, bool open = false)
+{
+    WifiNetwork n;
+    n.ssid = ssid;
+    n.rssi = rssi;
+    n.channel = channel;
+    n.open = open;
+    return n;
+}
+
+void test_first_tick_starts_a_scan_and_serves_while_scanning()
+{
+    MockWifiDriver driver;
+    FakeTimeProvider clock;
+    WifiScanCache cache(driver, clock, kRefreshMs);
+
+    WifiScanCache::Snapshot snap = cache.snapshot();
+    TEST_ASSERT_TRUE(snap.scanning);
+    TEST_ASSERT_FALSE(snap.valid);
+
+    cache.tick();
+    TEST_ASSERT_EQUAL(1, driver.startScanCalls);
+    cache.tick();  // not done yet: no second start
+    TEST_ASSERT_EQUAL(1, driver.startScanCalls);
+    TEST_ASSERT_TRUE(cache.snapshot().scanning);
+
+    driver.finishScan({net("home", -60), net("shed", -80)});
+    clock.advance(2000);
+    cache.tick();
+    snap = cache.snapshot();
+    TEST_ASSERT_FALSE(snap.scanning);
+    TEST_ASSERT_TRUE(snap.valid);
+    TEST_ASSERT_EQUAL_size_t(2, snap.networks.size());
+    TEST_ASSERT_EQUAL_STRING("home", snap.networks[0].ssid.c_str());
+
+    clock.advance(3000);
+    TEST_ASSERT_EQUAL_UINT32(3000, cache.snapshot().ageMs);
+}
+
+void test_normalize_dedupes_sorts_and_caps()
+{
+    std::vector<WifiNetwork> raw = {net("b", -70), net("a", -50), net("", -30),
+                                    net("b", -40, 11), net("c", -90, 6, true)};
+    const std::vector<WifiNetwork> out = WifiScanCache::normalize(raw);
+    TEST_ASSERT_EQUAL_size_t(3, out.size());
+    TEST_ASSERT_EQUAL_STRING("b", out[0].ssid.c_str());
+    TEST_ASSERT_EQUAL(-40, out[0].rssi);  // the strongest of the two kept
+    TEST_ASSERT_EQUAL(11, out[0].channel);
+    TEST_ASSERT_EQUAL_STRING("a", out[1].ssid.c_str());
+    TEST_ASSERT_EQUAL_STRING("c", out[2].ssid.c_str());
+
+    std::vector<WifiNetwork> many;
+    for (int i = 0; i < 40; ++i) {
+        many.push_back(net(("n" + std::to_string(i)).c_str(), static_cast<int8_t>(-100 + i)));
+    }
+    const std::vector<WifiNetwork> capped = WifiScanCache::normalize(many);
+    TEST_ASSERT_EQUAL_size_t(WifiScanCache::kMaxNetworks, capped.size());
+    TEST_ASSERT_EQUAL_STRING("n39", capped[0].ssid.c_str());
+}
+
+void test_rescans_follow_interval_and_requests()
+{
+    MockWifiDriver driver;
+    FakeTimeProvider clock;
+    WifiScanCache cache(driver, clock, kRefreshMs);
+    cache.tick();
+    driver.finishScan({net("home", -60)});
+    cache.tick();
+
+    // A request inside kMinRescanMs waits for it.
+    cache.requestRefresh();
+    TEST_ASSERT_TRUE(cache.snapshot().scanning);
+    clock.advance(WifiScanCache::kMinRescanMs - 1);
+    cache.tick();
+    TEST_ASSERT_EQUAL(1, driver.startScanCalls);
+    clock.advance(1);
+    cache.tick();
+    TEST_ASSERT_EQUAL(2, driver.startScanCalls);
+    driver.finishScan({net("home", -61)});
+    cache.tick();
+    TEST_ASSERT_FALSE(cache.snapshot().scanning);
+
+    // Unasked, the next one comes after the refresh interval.
+    clock.advance(kRefreshMs - 1);
+    cache.tick();
+    TEST_ASSERT_EQUAL(2, driver.startScanCalls);
+    clock.advance(1);
+    cache.tick();
+    TEST_ASSERT_EQUAL(3, driver.startScanCalls);
+}
+
+void test_lost_scan_is_written_off_and_list_kept()
+{
+    MockWifiDriver driver;
+    FakeTimeProvider clock;
+    WifiScanCache cache(driver, clock, kRefreshMs);
+    cache.tick();
+    driver.finishScan({net("home", -60)});
+    cache.tick();
+
+    clock.advance(kRefreshMs);
+    cache.tick();
+    TEST_ASSERT_EQUAL(2, driver.startScanCalls);
+    clock.advance(WifiScanCache::kScanTimeoutMs);
+    cache.tick();
+    const WifiScanCache::Snapshot snap = cache.snapshot();
+    TEST_ASSERT_FALSE(snap.scanning);
+    TEST_ASSERT_EQUAL_size_t(1, snap.networks.size());
+
+    // A refused start is retried, kMinRescanMs later.
+    driver.scanRunning = false;
+    driver.startScanResult = false;
+    cache.requestRefresh();
+    cache.tick();
+    TEST_ASSERT_EQUAL(3, driver.startScanCalls);
+    cache.tick();
+    TEST_ASSERT_EQUAL(3, driver.startScanCalls);
+    driver.startScanResult = true;
+    clock.advance(WifiScanCache::kMinRescanMs);
+    cache.tick();
+    TEST_ASSERT_EQUAL(4, driver.startScanCalls);
+}
+
+void test_json_body()
+{
+    WifiScanCache::Snapshot snap;
+    TEST_ASSERT_EQUAL_STRING("{\"scanning\":false,\"ageS\":-1,\"networks\":[]}",
+                             WifiScanCache::toJson(snap).c_str());
+    snap.valid = true;
+    snap.scanning = true;
+    snap.ageMs = 12500;
+    snap.networks = {net("a\"b\\c\x01", -42, 6, true)};
+    TEST_ASSERT_EQUAL_STRING("{\"scanning\":true,\"ageS\":12,\"networks\":["
+                             "{\"ssid\":\"a\\\"b\\\\c\\u0001\",\"rssi\":-42,"
+                             "\"channel\":6,\"open\":true}]}",
+                             WifiScanCache::toJson(snap).c_str());
+}
+
+}  // namespace
+
+void run_wifi_scan_cache_tests(void)
+{
+    RUN_TEST(test_first_tick_starts_a_scan_and_serves_while_scanning);
+    RUN_TEST(test_normalize_dedupes_sorts_and_caps);
+    RUN_TEST(test_rescans_follow_interval_and_requests);
+    RUN_TEST(test_lost_scan_is_written_off_and_list_kept);
+    RUN_TEST(test_json_body);
+}
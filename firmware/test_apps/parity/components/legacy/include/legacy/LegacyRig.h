@@ -0,0 +1,68 @@
+// SPDX-FileCopyrightText: 2026 Cryptotomte
+// SPDX-License-Identifier: AGPL-3.0-or-later
+/**
+ * @file LegacyRig.h
+ * @brief The Arduino v2.3 WateringController and its plant WaterPump,
+ *        compiled unchanged from the repo root's src/, behind a facade the
+ *        parity harness drives.
+ *
+ * No legacy type crosses this header (the legacy classes share their names
+ * with the firmware's; they live in namespace legacy inside LegacyRig.cpp).
+ * The rig owns a soil and an environmental sensor stub, a storage stub with
+ * no saved config (the legacy defaults apply until setConfig()), the pump
+ * and the controller, initialized. One rig at a time: millis() and the
+ * sensor task are process-wide shims.
+ *
+ * The legacy main loop is update(): the pump's timed stop, then the
+ * decision on a sample the sensor task published, then the stale-data
+ * check. The sensor task's one pass per read interval is read(), which
+ * leaves the sample for the next update().
+ */
+
+#ifndef WATERINGSYSTEM_PARITY_LEGACYRIG_H
+#define WATERINGSYSTEM_PARITY_LEGACYRIG_H
+
+#include <memory>
+
+class LegacyRig {
+public:
+    /// What the legacy sensor read sees.
+    struct Sample {
+        bool bus = true;        ///< the probe answers (read() and isAvailable())
+        float moisture = 0.0f;  ///< taken whenever the probe answers
+    };
+
+    /// The controller's config setters (each persists, as on the device).
+    struct Config {
+        float low = 30.0f;
+        float high = 55.0f;
+        unsigned int durationS = 20;
+        bool enabled = true;
+    };
+
+    /// Build and initialize at millis() == @p nowMs (non-zero: the legacy
+    /// code uses 0 as "never").
+    explicit LegacyRig(unsigned long nowMs);
+    ~LegacyRig();
+
+    LegacyRig(const LegacyRig&) = delete;
+    LegacyRig& operator=(const LegacyRig&) = delete;
+
+    void setNowMs(unsigned long nowMs);
+    /// Apply @p config through the setters that changed.
+    void setConfig(const Config& config);
+    /// One sensor-task pass.
+    void read(const Sample& sample);
+    /// One loop() pass.
+    void update();
+
+    bool pumpRunning();
+    /// The pump's manual-mode flag (legacy: every timed run sets it).
+    bool pumpManual() const;
+
+private:
+    struct Impl;
+    std::unique_ptr<Impl> impl_;
+};
+
+#endif /* WATERINGSYSTEM_PARITY_LEGACYRIG_H */
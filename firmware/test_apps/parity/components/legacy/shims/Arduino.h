@@ -0,0 +1,67 @@
+// SPDX-FileCopyrightText: 2026 Cryptotomte
+// SPDX-License-Identifier: AGPL-3.0-or-later
+/**
+ * @file Arduino.h
+ * @brief The part of the Arduino core the legacy controller and pump use,
+ *        on the host (parity harness only).
+ *
+ * millis() is the harness's clock (legacy_shim::nowMs), the GPIO calls do
+ * nothing, and Serial swallows its output unformatted: the legacy code logs
+ * on nearly every pass and formatting it would cost more than deciding.
+ */
+
+#ifndef WATERINGSYSTEM_PARITY_SHIM_ARDUINO_H
+#define WATERINGSYSTEM_PARITY_SHIM_ARDUINO_H
+
+#include <stdint.h>
+#include <time.h>
+
+#include <string>
+
+#define LOW 0
+#define HIGH 1
+#define OUTPUT 1
+
+namespace legacy_shim {
+/// What millis() returns; set by LegacyRig.
+extern unsigned long nowMs;
+}  // namespace legacy_shim
+
+inline unsigned long millis() { return legacy_shim::nowMs; }
+inline void delay(unsigned long) {}
+inline void pinMode(int, int) {}
+inline void digitalWrite(int, int) {}
+
+/// Arduino's String, as far as the legacy interfaces use it.
+class String {
+public:
+    String(const char* text = "") : s_(text != nullptr ? text : "") {}
+    String(const std::string& text) : s_(text) {}
+
+    unsigned int length() const { return static_cast<unsigned int>(s_.size()); }
+    const char* c_str() const { return s_.c_str(); }
+    const std::string& str() const { return s_; }
+    String& operator+=(const String& o)
+    {
+        s_ += o.s_;
+        return *this;
+    }
+    bool operator==(const String& o) const { return s_ == o.s_; }
+
+private:
+    std::string s_;
+};
+
+struct SerialShim {
+    void println(const char*) {}
+    void println(const String&) {}
+    void print(const char*) {}
+    template <typename... Args>
+    void printf(const char*, Args...)
+    {
+    }
+};
+
+inline SerialShim Serial;
+
+#endif /* WATERINGSYSTEM_PARITY_SHIM_ARDUINO_H */
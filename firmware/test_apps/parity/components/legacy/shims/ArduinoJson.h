@@ -0,0 +1,131 @@
+// SPDX-FileCopyrightText: 2026 Cryptotomte
+// SPDX-License-Identifier: AGPL-3.0-or-later
+/**
+ * @file ArduinoJson.h
+ * @brief The slice of ArduinoJson 6 the legacy controller's config load and
+ *        save use, on the host (parity harness only).
+ *
+ * A flat object of numbers and booleans — all "watering_config" ever holds
+ * — kept as key -> double, serialized as {"key":value,...} and parsed back
+ * from the same shape. Anything else fails to parse, as a corrupt config
+ * would on the device.
+ */
+
+#ifndef WATERINGSYSTEM_PARITY_SHIM_ARDUINOJSON_H
+#define WATERINGSYSTEM_PARITY_SHIM_ARDUINOJSON_H
+
+#include <cstddef>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <map>
+#include <string>
+
+#include "Arduino.h"
+
+/// One member: assign a number or bool, read it back as any arithmetic type.
+class JsonVariant {
+public:
+    explicit JsonVariant(double& value) : value_(value) {}
+
+    template <typename T>
+    JsonVariant& operator=(T value)
+    {
+        value_ = static_cast<double>(value);
+        return *this;
+    }
+
+    template <typename T>
+    operator T() const
+    {
+        return static_cast<T>(value_);
+    }
+
+private:
+    double& value_;
+};
+
+class DynamicJsonDocument {
+public:
+    explicit DynamicJsonDocument(std::size_t) {}
+
+    JsonVariant operator[](const char* key) { return JsonVariant(members_[key]); }
+    bool containsKey(const char* key) const { return members_.count(key) != 0; }
+
+    std::map<std::string, double>& members() { return members_; }
+    const std::map<std::string, double>& members() const { return members_; }
+
+private:
+    std::map<std::string, double> members_;
+};
+
+struct DeserializationError {
+    bool failed = false;
+    explicit operator bool() const { return failed; }
+};
+
+inline DeserializationError deserializeJson(DynamicJsonDocument& doc, const String& text)
+{
+    DeserializationError error;
+    const char* p = text.c_str();
+    auto skip = [&p] {
+        while (*p == ' ') {
+            ++p;
+        }
+    };
+    skip();
+    if (*p++ != '{') {
+        error.failed = true;
+        return error;
+    }
+    skip();
+    while (*p != '}') {
+        const char* keyEnd = *p == '"' ? std::strchr(p + 1, '"') : nullptr;
+        if (keyEnd == nullptr || keyEnd[1] != ':') {
+            error.failed = true;
+            return error;
+        }
+        const std::string key(p + 1, keyEnd);
+        p = keyEnd + 2;
+        double value = 0;
+        if (std::strncmp(p, "true", 4) == 0) {
+            value = 1;
+            p += 4;
+        } else if (std::strncmp(p, "false", 5) == 0) {
+            p += 5;
+        } else {
+            char* end = nullptr;
+            value = std::strtod(p, &end);
+            if (end == p) {
+                error.failed = true;
+                return error;
+            }
+            p = end;
+        }
+        doc.members()[key] = value;
+        skip();
+        if (*p == ',') {
+            ++p;
+            skip();
+        } else if (*p != '}') {
+            error.failed = true;
+            return error;
+        }
+    }
+    return error;
+}
+
+inline std::size_t serializeJson(const DynamicJsonDocument& doc, String& out)
+{
+    std::string text = "{";
+    for (const auto& member : doc.members()) {
+        char value[32];
+        std::snprintf(value, sizeof(value), "%.9g", member.second);
+        text += (text.size() > 1 ? ",\"" : "\"") + member.first + "\":" + value;
+    }
+    text += "}";
+    out = String(text);
+    return text.size();
+}
+
+#endif /* WATERINGSYSTEM_PARITY_SHIM_ARDUINOJSON_H */
@@ -0,0 +1,52 @@
+// SPDX-FileCopyrightText: 2026 Cryptotomte
+// SPDX-License-Identifier: AGPL-3.0-or-later
+/**
+ * @file FreeRTOS.h
+ * @brief The FreeRTOS calls the legacy controller makes, on the host and
+ *        single-threaded (parity harness only).
+ *
+ * Mutexes always succeed. xTaskCreate() does not start a thread: it keeps
+ * the task for legacy_shim::runTaskOnce(), which runs the task function
+ * up to its vTaskDelayUntil() and returns there (a longjmp), so the legacy
+ * sensor task's one read per interval happens exactly when the harness
+ * says. Defined in LegacyRig.cpp.
+ */
+
+#ifndef WATERINGSYSTEM_PARITY_SHIM_FREERTOS_H
+#define WATERINGSYSTEM_PARITY_SHIM_FREERTOS_H
+
+#include <stdint.h>
+
+typedef void* TaskHandle_t;
+typedef void* SemaphoreHandle_t;
+typedef uint32_t TickType_t;
+typedef int BaseType_t;
+typedef unsigned int UBaseType_t;
+typedef void (*TaskFunction_t)(void*);
+
+#define pdPASS 1
+#define pdFAIL 0
+#define pdTRUE 1
+#define pdFALSE 0
+#define pdMS_TO_TICKS(ms) (static_cast<TickType_t>(ms))
+
+SemaphoreHandle_t xSemaphoreCreateMutex();
+void vSemaphoreDelete(SemaphoreHandle_t mutex);
+BaseType_t xSemaphoreTake(SemaphoreHandle_t mutex, TickType_t wait);
+BaseType_t xSemaphoreGive(SemaphoreHandle_t mutex);
+
+BaseType_t xTaskCreate(TaskFunction_t fn, const char* name, uint32_t stack, void* arg,
+                       UBaseType_t priority, TaskHandle_t* handle);
+void vTaskDelete(TaskHandle_t task);
+void vTaskDelay(TickType_t ticks);
+void vTaskDelayUntil(TickType_t* lastWake, TickType_t period);
+TickType_t xTaskGetTickCount();
+
+namespace legacy_shim {
+/// Run the task xTaskCreate() kept until it next waits; false if none.
+bool runTaskOnce();
+/// Forget the kept task (its controller is gone).
+void dropTask();
+}  // namespace legacy_shim
+
+#endif /* WATERINGSYSTEM_PARITY_SHIM_FREERTOS_H */
@@ -0,0 +1,13 @@
+// SPDX-FileCopyrightText: 2026 Cryptotomte
+// SPDX-License-Identifier: AGPL-3.0-or-later
+/**
+ * @file semphr.h
+ * @brief Host shim (parity harness only): everything is in FreeRTOS.h.
+ */
+
+#ifndef WATERINGSYSTEM_PARITY_SHIM_SEMPHR_H
+#define WATERINGSYSTEM_PARITY_SHIM_SEMPHR_H
+
+#include "freertos/FreeRTOS.h"
+
+#endif /* WATERINGSYSTEM_PARITY_SHIM_SEMPHR_H */
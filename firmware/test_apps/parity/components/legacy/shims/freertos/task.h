@@ -0,0 +1,13 @@
+// SPDX-FileCopyrightText: 2026 Cryptotomte
+// SPDX-License-Identifier: AGPL-3.0-or-later
+/**
+ * @file task.h
+ * @brief Host shim (parity harness only): everything is in FreeRTOS.h.
+ */
+
+#ifndef WATERINGSYSTEM_PARITY_SHIM_TASK_H
+#define WATERINGSYSTEM_PARITY_SHIM_TASK_H
+
+#include "freertos/FreeRTOS.h"
+
+#endif /* WATERINGSYSTEM_PARITY_SHIM_TASK_H */
@@ -0,0 +1,235 @@
+// SPDX-FileCopyrightText: 2026 Cryptotomte
+// SPDX-License-Identifier: AGPL-3.0-or-later
+/**
+ * @file LegacyRig.cpp
+ * @brief The legacy controller and pump sources inside namespace legacy,
+ *        the shims' definitions and the rig (see LegacyRig.h).
+ *
+ * Every system and shim header the legacy files include is included here
+ * first, at global scope, so that their own #includes inside the namespace
+ * are no-ops behind the include guards and only the legacy declarations
+ * land in it.
+ */
+
+#include "legacy/LegacyRig.h"
+
+#include <setjmp.h>
+#include <stdint.h>
+#include <time.h>
+
+#include "Arduino.h"
+#include "ArduinoJson.h"
+#include "freertos/FreeRTOS.h"
+#include "freertos/semphr.h"
+#include "freertos/task.h"
+
+namespace legacy_shim {
+
+unsigned long nowMs = 1;
+
+namespace {
+
+TaskFunction_t s_task = nullptr;
+void* s_taskArg = nullptr;
+bool s_inTask = false;
+jmp_buf s_yield;
+int s_mutex = 0;
+
+}  // namespace
+
+bool runTaskOnce()
+{
+    if (s_task == nullptr) {
+        return false;
+    }
+    // The legacy sensor task's locals are all trivially destructible, so
+    // jumping out of it at its wait is well-defined ([csetjmp.syn]).
+    s_inTask = true;
+    if (setjmp(s_yield) == 0) {
+        s_task(s_taskArg);
+    }
+    s_inTask = false;
+    return true;
+}
+
+void dropTask()
+{
+    s_task = nullptr;
+    s_taskArg = nullptr;
+}
+
+}  // namespace legacy_shim
+
+SemaphoreHandle_t xSemaphoreCreateMutex() { return &legacy_shim::s_mutex; }
+void vSemaphoreDelete(SemaphoreHandle_t) {}
+BaseType_t xSemaphoreTake(SemaphoreHandle_t, TickType_t) { return pdTRUE; }
+BaseType_t xSemaphoreGive(SemaphoreHandle_t) { return pdTRUE; }
+
+BaseType_t xTaskCreate(TaskFunction_t fn, const char*, uint32_t, void* arg, UBaseType_t,
+                       TaskHandle_t* handle)
+{
+    legacy_shim::s_task = fn;
+    legacy_shim::s_taskArg = arg;
+    if (handle != nullptr) {
+        *handle = arg;
+    }
+    return pdPASS;
+}
+
+void vTaskDelete(TaskHandle_t) {}
+void vTaskDelay(TickType_t) {}
+
+void vTaskDelayUntil(TickType_t*, TickType_t)
+{
+    if (legacy_shim::s_inTask) {
+        longjmp(legacy_shim::s_yield, 1);
+    }
+}
+
+TickType_t xTaskGetTickCount() { return static_cast<TickType_t>(legacy_shim::nowMs); }
+
+namespace legacy {
+
+#include "WateringController.cpp"
+#include "actuators/WaterPump.cpp"
+
+namespace {
+
+class StubSoil : public ISoilSensor {
+public:
+    LegacyRig::Sample sample;
+
+    bool initialize() override { return true; }
+    bool read() override
+    {
+        if (!sample.bus) {
+            return false;
+        }
+        // ModbusSoilSensor::read() stores the value, then range-checks it.
+        moisture_ = sample.moisture;
+        return moisture_ >= 0.0f && moisture_ <= 100.0f;
+    }
+    bool isAvailable() override { return sample.bus; }
+    int getLastError() override { return sample.bus ? 0 : 4; }
+    const char* getName() const override { return "soil"; }
+    float getMoisture() override { return moisture_; }
+    float getTemperature() override { return 18.0f; }
+    float getHumidity() override { return moisture_; }
+    float getPH() override { return 6.5f; }
+    float getEC() override { return 900.0f; }
+    float getNitrogen() override { return -1.0f; }
+    float getPhosphorus() override { return -1.0f; }
+    float getPotassium() override { return -1.0f; }
+    bool calibrateMoisture(float) override { return true; }
+    bool calibratePH(float) override { return true; }
+    bool calibrateEC(float) override { return true; }
+    bool setValidRange(const char*, float, float) override { return true; }
+    bool isWithinValidRange(const char*, float) override { return true; }
+
+private:
+    float moisture_ = 0.0f;
+};
+
+class StubEnv : public IEnvironmentalSensor {
+public:
+    bool initialize() override { return true; }
+    bool read() override { return true; }
+    bool isAvailable() override { return true; }
+    int getLastError() override { return 0; }
+    const char* getName() const override { return "env"; }
+    float getTemperature() override { return 20.0f; }
+    float getHumidity() override { return 50.0f; }
+    float getPressure() override { return 1013.0f; }
+};
+
+/// No files: the config saves and readings logged are dropped.
+class StubStorage : public IDataStorage {
+public:
+    bool initialize() override { return true; }
+    bool storeConfig(const String&, const String&) override { return true; }
+    String getConfig(const String&, const String& defaultValue) override
+    {
+        return defaultValue;
+    }
+    bool storeSensorReading(const String&, const String&, float, time_t) override
+    {
+        return true;
+    }
+    String getSensorReadings(const String&, const String&, time_t, time_t) override
+    {
+        return "";
+    }
+    float getLastSensorReading(const String&, const String&) override { return 0.0f; }
+    int pruneOldReadings(time_t) override { return 0; }
+    bool getStorageStats(uint32_t*, uint32_t*) override { return true; }
+};
+
+}  // namespace
+
+}  // namespace legacy
+
+struct LegacyRig::Impl {
+    legacy::StubSoil soil;
+    legacy::StubEnv env;
+    legacy::StubStorage storage;
+    legacy::WaterPump pump{26, "plant"};
+    legacy::WateringController controller{&env, &soil, &pump, &storage};
+    Config config;
+};
+
+LegacyRig::LegacyRig(unsigned long nowMs)
+{
+    legacy_shim::nowMs = nowMs;
+    impl_ = std::make_unique<Impl>();
+    impl_->controller.initialize();
+}
+
+LegacyRig::~LegacyRig()
+{
+    impl_.reset();
+    legacy_shim::dropTask();
+}
+
+void LegacyRig::setNowMs(unsigned long nowMs)
+{
+    legacy_shim::nowMs = nowMs;
+}
+
+void LegacyRig::setConfig(const Config& config)
+{
+    legacy::WateringController& c = impl_->controller;
+    if (config.low != impl_->config.low) {
+        c.setMoistureThresholdLow(config.low);
+    }
+    if (config.high != impl_->config.high) {
+        c.setMoistureThresholdHigh(config.high);
+    }
+    if (config.durationS != impl_->config.durationS) {
+        c.setWateringDuration(config.durationS);
+    }
+    if (config.enabled != impl_->config.enabled) {
+        c.enableWatering(config.enabled);
+    }
+    impl_->config = config;
+}
+
+void LegacyRig::read(const Sample& sample)
+{
+    impl_->soil.sample = sample;
+    legacy_shim::runTaskOnce();
+}
+
+void LegacyRig::update()
+{
+    impl_->controller.update();
+}
+
+bool LegacyRig::pumpRunning()
+{
+    return impl_->pump.isRunning();
+}
+
+bool LegacyRig::pumpManual() const
+{
+    return impl_->pump.isManualMode();
+}
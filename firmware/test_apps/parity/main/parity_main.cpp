@@ -0,0 +1,494 @@
+// SPDX-FileCopyrightText: 2026 Cryptotomte
+// SPDX-License-Identifier: AGPL-3.0-or-later
+/**
+ * @file parity_main.cpp
+ * @brief Legacy-vs-new watering controller parity at scale (linux preview
+ *        target).
+ *
+ * Feeds one input trace — soil reads, probe failures, out-of-range values,
+ * config changes — to the Arduino v2.3 controller (LegacyRig, the repo
+ * root's src/ compiled unchanged) and to the control component's
+ * WateringController, on the same clock: the legacy sensor-task pass and
+ * decision at each read, and the 100 ms loop passes of both (pump timed
+ * stops, the legacy stale check) while either pump runs. After every pass
+ * the two pump states are compared.
+ *
+ * A pass where they start to differ opens a divergence. It is explained
+ * when the new controller's decision of that tick names a gate the parity
+ * checklist changed on purpose (kKnownDeltas: the soak pause, no decision
+ * without a fresh read, the fail-safe on automatic runs, ...), or when it
+ * opens between reads while bursts such a delta shifted are still running
+ * (their timed stops fall out of step). Anything else is unexplained and
+ * printed. The divergence closes when the pumps agree again.
+ *
+ * Traces are synthetic (PARITY_SEEDS traces of PARITY_DAYS, the soil
+ * rising with the legacy pump's bursts) or, with PARITY_FILE, a recording
+ * from GET /api/v1/recording (zone 0's reads and config). Tunables come
+ * from the environment (app_main has no argv on the linux target); see
+ * CLAUDE.md "Parity". The exit code is 0 when every divergence is
+ * explained, 1 otherwise, 2 when a tunable or the file is bad.
+ */
+
+#include <algorithm>
+#include <chrono>
+#include <cinttypes>
+#include <cstdio>
+#include <cstdlib>
+#include <fstream>
+#include <iterator>
+#include <memory>
+#include <random>
+#include <vector>
+
+#include "actuators/WaterPump.h"
+#include "actuators/testing/FakeTimeProvider.h"
+#include "control/DecisionTrace.h"
+#include "control/InputRecord.h"
+#include "control/WateringController.h"
+#include "events/EventLogger.h"
+#include "legacy/LegacyRig.h"
+#include "sensors/testing/MockEnvironmentalSensor.h"
+#include "sensors/testing/MockSoilSensor.h"
+#include "storage/testing/MockConfigStore.h"
+#include "storage/testing/MockDataStorage.h"
+#include "time/testing/FakeWallClock.h"
+
+namespace {
+
+/// Both firmwares' main-loop cadence while a pump runs.
+constexpr int64_t kLoopMs = 100;
+constexpr int64_t kStartMs = 1'000'000;
+constexpr int64_t kReadMs = 5'000;
+constexpr int64_t kDayMs = 86'400'000;
+
+/// A divergence the parity checklist asks for: the new controller's gate
+/// on the tick it began.
+struct KnownDelta {
+    DecisionGate gate;
+    const char* why;
+};
+
+constexpr KnownDelta kKnownDeltas[] = {
+    {DecisionGate::Soak, "soak pause between bursts (checklist 1: minimum interval enforced)"},
+    {DecisionGate::NoFreshRead, "no decision on a failed read (FR-004)"},
+    {DecisionGate::Invalid, "out-of-range reading: no burst, and a running one stops"},
+    {DecisionGate::Unavailable, "fail-safe covers automatic runs (QUIRK 1)"},
+    {DecisionGate::Stale, "fail-safe covers automatic runs (QUIRK 1)"},
+};
+constexpr std::size_t kKnownCount = sizeof(kKnownDeltas) / sizeof(kKnownDeltas[0]);
+
+/// WaterPump with no output to drive.
+class SimPump : public WaterPump {
+public:
+    using WaterPump::WaterPump;
+
+protected:
+    bool applyOutput(bool) override { return true; }
+};
+
+/// The sample the new controller takes, set before each tick.
+class ParityFeed : public ISoilFeed {
+public:
+    void set(const TimedSoilSnapshot& sample) { sample_ = sample; }
+    TimedSoilSnapshot latest() const override { return sample_; }
+
+private:
+    TimedSoilSnapshot sample_;
+};
+
+/// One decision tick's input.
+struct ParityInput {
+    int64_t atMs = 0;
+    TimedSoilSnapshot sample;  ///< the new controller's feed
+    bool fresh = false;        ///< a read happened (a legacy sensor-task pass)
+    LegacyRig::Config config;
+};
+
+/// What a run found.
+struct ParityReport {
+    uint64_t ticks = 0;
+    uint64_t passes = 0;  ///< loop passes between reads
+    uint32_t legacyStarts = 0;
+    uint32_t newStarts = 0;
+    uint32_t explained[kKnownCount] = {};
+    uint32_t unexplained = 0;
+    int64_t divergentMs = 0;
+    int64_t spanMs = 0;
+};
+
+/// The two controllers on one clock.
+class ParityPair {
+public:
+    ParityPair(int64_t startMs, uint32_t soakS, bool verbose, ParityReport& report)
+        : legacy_(static_cast<unsigned long>(startMs)),
+          clock_(startMs),
+          events_(storage_, wall_),
+          pump_("plant", clock_),
+          controller_(soil_, env_, pump_, config_, storage_, clock_, wall_, events_),
+          now_(startMs),
+          verbose_(verbose),
+          report_(report)
+    {
+        pump_.initialize();
+        controller_.setSoilFeed(feed_);
+        controller_.setTrace(trace_, 0);
+        config_.stored.minWateringIntervalS = soakS;
+        config_.stored.sensorReadIntervalMs = static_cast<uint32_t>(kReadMs);
+    }
+
+    ParityPair(const ParityPair&) = delete;
+    ParityPair& operator=(const ParityPair&) = delete;
+
+    bool legacyRunning() { return legacy_.pumpRunning(); }
+
+    /// Loop passes up to @p in, then both decide on it.
+    void decide(const ParityInput& in)
+    {
+        advanceTo(in.atMs);
+        legacy_.setConfig(in.config);
+        config_.stored.moistureThresholdLow = in.config.low;
+        config_.stored.moistureThresholdHigh = in.config.high;
+        config_.stored.wateringDurationS = in.config.durationS;
+        config_.stored.wateringEnabled = in.config.enabled ? 1 : 0;
+        feed_.set(in.sample);
+        if (in.fresh) {
+            LegacyRig::Sample sample;
+            sample.bus = in.sample.soil.readOk;
+            sample.moisture = in.sample.soil.moisture;
+            legacy_.read(sample);
+        }
+        legacy_.update();
+        controller_.tick();
+        ++report_.ticks;
+        DecisionRecord rec;
+        trace_.read(&rec, 1, trace_.written() - 1);
+        compare(&rec);
+    }
+
+    /// Close an open divergence at the end of the trace.
+    void finish()
+    {
+        if (diverged_) {
+            report_.divergentMs += now_ - divergedAtMs_;
+        }
+    }
+
+private:
+    void advanceTo(int64_t atMs)
+    {
+        while (now_ < atMs) {
+            if (!legacy_.pumpRunning() && !pump_.isRunning()) {
+                now_ = atMs;
+                break;
+            }
+            now_ = std::min(now_ + kLoopMs, atMs);
+            syncClocks();
+            legacy_.update();
+            pump_.update();
+            ++report_.passes;
+            compare(nullptr);
+        }
+        syncClocks();
+    }
+
+    void syncClocks()
+    {
+        legacy_.setNowMs(static_cast<unsigned long>(now_));
+        clock_.advance(now_ - clock_.nowMs());
+    }
+
+    void compare(const DecisionRecord* rec)
+    {
+        const bool legacyOn = legacy_.pumpRunning();
+        const bool newOn = pump_.isRunning();
+        report_.legacyStarts += legacyOn && !legacyWasOn_ ? 1 : 0;
+        report_.newStarts += newOn && !newWasOn_ ? 1 : 0;
+        legacyWasOn_ = legacyOn;
+        newWasOn_ = newOn;
+        if (legacyOn == newOn) {
+            if (diverged_) {
+                report_.divergentMs += now_ - divergedAtMs_;
+                diverged_ = false;
+            }
+            if (!legacyOn) {
+                carried_ = kKnownCount;
+            }
+            return;
+        }
+        if (diverged_) {
+            return;
+        }
+        diverged_ = true;
+        divergedAtMs_ = now_;
+        // A burst a known delta shifted also ends out of step (a timed stop
+        // between reads): that is the same delta until both pumps are off.
+        std::size_t known = carried_;
+        for (std::size_t i = 0; rec != nullptr && i < kKnownCount; ++i) {
+            if (kKnownDeltas[i].gate == rec->gate) {
+                known = i;
+            }
+        }
+        if (known < kKnownCount) {
+            carried_ = known;
+            ++report_.explained[known];
+            if (verbose_) {
+                print("explained", legacyOn, rec);
+            }
+            return;
+        }
+        ++report_.unexplained;
+        print("UNEXPLAINED", legacyOn, rec);
+    }
+
+    void print(const char* what, bool legacyOn, const DecisionRecord* rec) const
+    {
+        std::printf("t+%.1fs %s: legacy %s, new %s", (now_ - kStartMs) / 1000.0, what,
+                    legacyOn ? "on" : "off", legacyOn ? "off" : "on");
+        if (rec != nullptr) {
+            std::printf(" (%s, %s, moisture %.1f%%, thresholds %.0f/%.0f)",
+                        decisionGateName(rec->gate), decisionActionName(rec->action),
+                        static_cast<double>(rec->moisture), static_cast<double>(rec->low),
+                        static_cast<double>(rec->high));
+        } else {
+            std::printf(" (between reads)");
+        }
+        std::printf("\n");
+    }
+
+    LegacyRig legacy_;
+
+    FakeTimeProvider clock_;
+    FakeWallClock wall_;  ///< unset: the new controller logs no data
+    MockConfigStore config_;
+    MockDataStorage storage_;
+    EventLogger events_;
+    MockEnvironmentalSensor env_;
+    MockSoilSensor soil_;
+    SimPump pump_;
+    ParityFeed feed_;
+    DecisionTrace trace_;
+    WateringController controller_;
+
+    int64_t now_;
+    bool verbose_;
+    ParityReport& report_;
+    bool legacyWasOn_ = false;
+    bool newWasOn_ = false;
+    bool diverged_ = false;
+    int64_t divergedAtMs_ = 0;
+    std::size_t carried_ = kKnownCount;  ///< the delta behind the current bursts
+};
+
+/**
+ * A bed as the legacy node sees it: drying at a rate that changes now and
+ * then, wetted by rain and by the legacy pump's bursts, read every 5 s
+ * with noise, failed reads in runs of up to a minute, the odd
+ * out-of-range value, and a config change every few days.
+ */
+class SyntheticTrace {
+public:
+    explicit SyntheticTrace(uint32_t seed) : rng_(seed) {}
+
+    ParityInput next(bool legacyPumpOn)
+    {
+        ParityInput in;
+        atMs_ += kReadMs;
+        in.atMs = atMs_;
+
+        if (chance(1.0 / (2 * kDayMs / kReadMs))) {
+            dryPctPerH_ = uniform(0.3, 3.0);
+        }
+        moisture_ -= dryPctPerH_ * kReadMs / 3.6e6;
+        moisture_ += legacyPumpOn ? kRisePctPerRead : 0.0;
+        if (rainLeft_ == 0 && chance(1.0 / (kDayMs / kReadMs))) {
+            rainLeft_ = static_cast<int>(uniform(12, 240));
+            rainPerRead_ = uniform(10, 35) / rainLeft_;
+        }
+        if (rainLeft_ > 0) {
+            --rainLeft_;
+            moisture_ += rainPerRead_;
+        }
+        moisture_ = std::clamp(moisture_, 5.0, 95.0);
+
+        if (failLeft_ == 0 && chance(1.0 / 2000)) {
+            failLeft_ = static_cast<int>(uniform(1, 13));
+        }
+        if (chance(1.0 / (3 * kDayMs / kReadMs))) {
+            config_.low = static_cast<float>(uniform(20, 40));
+            config_.high = config_.low + static_cast<float>(uniform(10, 30));
+            config_.durationS = static_cast<unsigned int>(uniform(5, 61));
+            config_.enabled = !chance(0.2);
+        }
+
+        in.fresh = true;
+        in.config = config_;
+        TimedSoilSnapshot& s = in.sample;
+        s.atMs = atMs_ - 40;
+        s.sequence = ++sequence_;
+        s.soil.readOk = failLeft_ == 0;
+        failLeft_ -= failLeft_ > 0 ? 1 : 0;
+        if (s.soil.readOk) {
+            lastRead_ = static_cast<float>(moisture_ + noise_(rng_));
+            if (chance(1.0 / 5000)) {
+                lastRead_ = chance(0.5) ? -1.0f : 101.5f;
+            }
+            readOnce_ = true;
+        }
+        s.soil.available = readOnce_;
+        s.soil.moisture = lastRead_;
+        return in;
+    }
+
+    int64_t atMs() const { return atMs_; }
+
+private:
+    /// What a running legacy burst adds per read interval.
+    static constexpr double kRisePctPerRead = 0.6;
+
+    bool chance(double p) { return std::uniform_real_distribution<double>(0, 1)(rng_) < p; }
+    double uniform(double lo, double hi)
+    {
+        return std::uniform_real_distribution<double>(lo, hi)(rng_);
+    }
+
+    std::mt19937 rng_;
+    std::normal_distribution<double> noise_{0.0, 0.3};
+    int64_t atMs_ = kStartMs;
+    double moisture_ = 45.0;
+    double dryPctPerH_ = 1.0;
+    int rainLeft_ = 0;
+    double rainPerRead_ = 0.0;
+    int failLeft_ = 0;
+    uint32_t sequence_ = 0;
+    float lastRead_ = 0.0f;
+    bool readOnce_ = false;
+    LegacyRig::Config config_;
+};
+
+/// @p name from the environment as a number, else @p fallback.
+double envNumber(const char* name, double fallback, bool& ok)
+{
+    const char* text = std::getenv(name);
+    if (text == nullptr || *text == '\0') {
+        return fallback;
+    }
+    char* end = nullptr;
+    const double value = std::strtod(text, &end);
+    if (*end != '\0') {
+        std::fprintf(stderr, "%s=\"%s\": not a number\n", name, text);
+        ok = false;
+        return fallback;
+    }
+    return value;
+}
+
+/// Zone 0 of a recording, pair rebuilt at each boot or resync with the
+/// recorded soak interval.
+bool runRecording(const char* path, bool verbose, ParityReport& report)
+{
+    std::ifstream file(path, std::ios::binary);
+    if (!file) {
+        std::fprintf(stderr, "PARITY_FILE=\"%s\": cannot be read\n", path);
+        return false;
+    }
+    const std::vector<uint8_t> bytes((std::istreambuf_iterator<char>(file)),
+                                     std::istreambuf_iterator<char>());
+    InputRecordReader in(bytes.data(), bytes.size());
+    std::unique_ptr<ParityPair> pair;
+    RecordedTick tick;
+    uint32_t sequence = 0;
+    int64_t firstMs = 0;
+    int64_t lastMs = 0;
+    using input_record::ConfigItem;
+    while (in.next(tick)) {
+        if (!pair || tick.boot || tick.resync) {
+            if (pair) {
+                pair->finish();
+                report.spanMs += lastMs - firstMs;
+            }
+            const auto soakS =
+                static_cast<uint32_t>(in.config().get(ConfigItem::MinWateringIntervalS));
+            pair = std::make_unique<ParityPair>(tick.atMs, soakS, verbose, report);
+            firstMs = tick.atMs;
+            sequence = 0;
+        }
+        ParityInput input;
+        input.atMs = tick.atMs;
+        input.sample = in.soil(0);
+        input.fresh = input.sample.sequence != sequence && input.sample.sequence != 0;
+        sequence = input.sample.sequence;
+        input.config.low = in.config().get(ConfigItem::ThresholdLow);
+        input.config.high = in.config().get(ConfigItem::ThresholdHigh);
+        input.config.durationS =
+            static_cast<unsigned int>(in.config().get(ConfigItem::WateringDurationS));
+        input.config.enabled = in.config().get(ConfigItem::WateringEnabled) != 0.0f;
+        pair->decide(input);
+        lastMs = tick.atMs;
+    }
+    if (pair) {
+        pair->finish();
+        report.spanMs += lastMs - firstMs;
+    }
+    if (in.error() != nullptr) {
+        std::fprintf(stderr, "PARITY_FILE=\"%s\": %s\n", path, in.error());
+        return false;
+    }
+    return true;
+}
+
+}  // namespace
+
+extern "C" void app_main(void)
+{
+    bool ok = true;
+    auto number = [&ok](const char* name, double fallback) {
+        return envNumber(name, fallback, ok);
+    };
+    const int days = static_cast<int>(number("PARITY_DAYS", 30));
+    const auto seeds = static_cast<uint32_t>(number("PARITY_SEEDS", 8));
+    const auto firstSeed = static_cast<uint32_t>(number("PARITY_SEED", 1));
+    const auto soakS = static_cast<uint32_t>(
+        number("PARITY_SOAK_S", IConfigStore::kDefaultMinWateringIntervalS));
+    const bool verbose = number("PARITY_VERBOSE", 0) != 0;
+    if (!ok) {
+        std::exit(2);
+    }
+
+    ParityReport report;
+    const auto started = std::chrono::steady_clock::now();
+    const char* path = std::getenv("PARITY_FILE");
+    if (path != nullptr && *path != '\0') {
+        if (!runRecording(path, verbose, report)) {
+            std::exit(2);
+        }
+        std::printf("recording %s:", path);
+    } else {
+        for (uint32_t seed = firstSeed; seed < firstSeed + seeds; ++seed) {
+            SyntheticTrace trace(seed);
+            ParityPair pair(kStartMs, soakS, verbose, report);
+            while (trace.atMs() < kStartMs + days * kDayMs) {
+                pair.decide(trace.next(pair.legacyRunning()));
+            }
+            pair.finish();
+            report.spanMs += trace.atMs() - kStartMs;
+        }
+        std::printf("%" PRIu32 " synthetic traces of %d days (seeds %" PRIu32 "..%" PRIu32 "):",
+                    seeds, days, firstSeed, firstSeed + seeds - 1);
+    }
+    const double hostS =
+        std::chrono::duration<double>(std::chrono::steady_clock::now() - started).count();
+
+    std::printf(" %" PRIu64 " ticks and %" PRIu64 " loop passes in %.2f s, %.2f M ticks/s\n",
+                report.ticks, report.passes, hostS,
+                hostS > 0 ? report.ticks / hostS / 1e6 : 0.0);
+    std::printf("bursts:      legacy %" PRIu32 ", new %" PRIu32 "\n", report.legacyStarts,
+                report.newStarts);
+    std::printf("divergent:   %.2f %% of the time\n",
+                report.spanMs > 0 ? 100.0 * report.divergentMs / report.spanMs : 0.0);
+    for (std::size_t i = 0; i < kKnownCount; ++i) {
+        std::printf("  %-12s %8" PRIu32 "  %s\n", decisionGateName(kKnownDeltas[i].gate),
+                    report.explained[i], kKnownDeltas[i].why);
+    }
+    std::printf("  %-12s %8" PRIu32 "\n", "unexplained", report.unexplained);
+    std::exit(report.unexplained == 0 ? 0 : 1);
+}
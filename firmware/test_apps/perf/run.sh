@@ -0,0 +1,55 @@
+#!/usr/bin/env bash
+# SPDX-FileCopyrightText: 2026 Cryptotomte
+# SPDX-License-Identifier: AGPL-3.0-or-later
+#
+# Release-over-release performance gate (IDF linux preview target): builds
+# test_apps/bench, sim, wear and apiload, runs each with pinned tunables
+# into PERF_OUT (default ./out) and gates the merged results against
+# baseline.json, the previous release's run, by tolerances.json
+# (tools/perf_gate.py). Exits 1 on a regression.
+#
+# Run inside the IDF environment (idf.py on PATH), from anywhere:
+#   test_apps/perf/run.sh
+# PERF_BASELINE names another baseline (e.g. a local run of the release tag,
+# for ns/op on this machine). PERF_RECORD=1 writes the run over the
+# baseline, tagged with version.txt, without the machine-dependent fields
+# (ns/op); PERF_RECORD=local keeps them, for a PERF_BASELINE that stays on
+# this machine (CLAUDE.md "Performance gate").
+set -euo pipefail
+
+here="$(cd "$(dirname "$0")" && pwd)"
+apps="$(dirname "$here")"
+firmware="$(dirname "$apps")"
+out="${PERF_OUT:-$here/out}"
+baseline="${PERF_BASELINE:-$here/baseline.json}"
+mkdir -p "$out"
+
+build() {
+    (
+        cd "$apps/$1"
+        [ -f build/CMakeCache.txt ] || idf.py --preview set-target linux >/dev/null
+        idf.py build >/dev/null
+    )
+}
+for app in bench sim wear apiload; do
+    echo "building $app"
+    build "$app"
+done
+
+BENCH_MIN_MS=200 BENCH_FILTER= BENCH_OUT="$out/bench.json" \
+    "$apps/bench/build/host_bench.elf" >"$out/bench.txt"
+SIM_DAYS=90 SIM_SEED=1 SIM_OUT="$out/sim.json" \
+    "$apps/sim/build/watering_sim.elf" >"$out/sim.txt"
+WEAR_DAYS=90 WEAR_SEED=1 WEAR_BACKEND=littlefs WEAR_OUT="$out/wear.json" \
+    "$apps/wear/build/flash_wear.elf" >"$out/wear.txt"
+LOAD_REQUESTS=20000 LOAD_DAYS=30 LOAD_OUT="$out/apiload.json" \
+    "$apps/apiload/build/api_load.elf" >"$out/apiload.txt"
+
+record=()
+case "${PERF_RECORD:-0}" in
+    1) record=(--write "$baseline" --release "$(cat "$firmware/version.txt")") ;;
+    local) record=(--write "$baseline" --release "$(cat "$firmware/version.txt")" --local) ;;
+esac
+python3 "$firmware/tools/perf_gate.py" --baseline "$baseline" \
+    --tolerances "$here/tolerances.json" ${record[@]+"${record[@]}"} \
+    "$out/bench.json" "$out/sim.json" "$out/wear.json" "$out/apiload.json"
@@ -0,0 +1,376 @@
+// SPDX-FileCopyrightText: 2026 Cryptotomte
+// SPDX-License-Identifier: AGPL-3.0-or-later
+/**
+ * @file InputReplay.h
+ * @brief The node's watering controllers on fake clocks, and a replayer
+ *        that drives them from a recording (linux preview target).
+ *
+ * ReplayRig wires the REAL WateringController (one per recorded zone,
+ * through WateringZones, with the pump budget, schedule and burst sizer
+ * the node had), ReservoirController and WaterPump code as app_main does,
+ * over FakeTimeProvider/FakeWallClock and the mocks. The pumps are
+ * updated every kLoopMs while one runs, as the node's 10 Hz loop does, so
+ * a burst self-stops at the same tick.
+ *
+ * InputReplay walks a recording (control/InputRecord.h) tick by tick:
+ * advance the clocks to the tick, hand the rig the recorded config, level
+ * marks and each zone's latest sample, tick, and compare every pump with
+ * its recorded state. A difference is a divergence: printed with the
+ * replayed decision of that tick, then the replayed pump is set to the
+ * recorded state (a run the controller did not start — a manual one on
+ * the node — reads to it as a manual run, as it did there). A boot in the
+ * recording builds a fresh rig; a missing block (resync) builds one from
+ * the keyframe, and its first tick only adopts the recorded pump states:
+ * what the controllers learnt before it (soak timers, the burst sizer,
+ * the zones' tick order) is not in the recording.
+ */
+
+#ifndef WATERINGSYSTEM_REPLAY_INPUTREPLAY_H
+#define WATERINGSYSTEM_REPLAY_INPUTREPLAY_H
+
+#include <algorithm>
+#include <array>
+#include <chrono>
+#include <cinttypes>
+#include <cstdio>
+#include <ctime>
+#include <memory>
+#include <optional>
+#include <string>
+
+#include "actuators/WaterPump.h"
+#include "actuators/testing/FakeTimeProvider.h"
+#include "control/DecisionTrace.h"
+#include "control/InputRecord.h"
+#include "control/InputRecorder.h"
+#include "control/MoistureResponse.h"
+#include "control/PumpBudget.h"
+#include "control/ReservoirController.h"
+#include "control/WateringController.h"
+#include "control/WateringSchedule.h"
+#include "control/WateringZones.h"
+#include "events/EventLogger.h"
+#include "sensors/testing/MockEnvironmentalSensor.h"
+#include "sensors/testing/MockLevelSensor.h"
+#include "sensors/testing/MockSoilSensor.h"
+#include "storage/testing/MockConfigStore.h"
+#include "storage/testing/MockDataStorage.h"
+#include "time/testing/FakeWallClock.h"
+
+namespace replay {
+
+/// The node's pump update cadence (the 10 Hz main loop).
+constexpr int64_t kLoopMs = 100;
+
+/// WaterPump with no output to drive.
+class SimPump : public WaterPump {
+public:
+    using WaterPump::WaterPump;
+
+protected:
+    bool applyOutput(bool) override { return true; }
+};
+
+/// The sample a zone's controller takes, set before each tick.
+class ReplayFeed : public ISoilFeed {
+public:
+    void set(const TimedSoilSnapshot& sample) { sample_ = sample; }
+    TimedSoilSnapshot latest() const override { return sample_; }
+
+private:
+    TimedSoilSnapshot sample_;
+};
+
+/// A node's controllers, wired as app_main wires them.
+struct ReplayRig {
+    /**
+     * @param setup      zones, budget, schedule and sizer, as recorded
+     * @param startMs    the controllers' clock when they are built
+     * @param reservoir  build the reservoir controller and its fill pump
+     * @param recorder   non-null: the zones take their samples through a
+     *                   RecordedSoilFeed into it (a recording node)
+     */
+    ReplayRig(const RecordedSetup& setup, int64_t startMs, bool reservoir,
+              InputRecorder* recorder = nullptr)
+        : clock(startMs), events(storage, wall), budget(setup.pumpBudget)
+    {
+        const bool scheduled =
+            parseWateringSchedule(setup.schedule.c_str(), schedule) && schedule.size() > 0;
+        for (std::size_t z = 0; z < setup.zoneCount; ++z) {
+            pumps[z].emplace(z == 0 ? std::string("plant") : "zone" + std::to_string(z), clock);
+            pumps[z]->initialize();
+            WateringController& c = controllers[z].emplace(soil, env, *pumps[z], config, storage,
+                                                           clock, wall, events);
+            if (recorder != nullptr) {
+                c.setSoilFeed(
+                    recordedFeeds[z].emplace(feeds[z], *recorder, static_cast<uint8_t>(z)));
+            } else {
+                c.setSoilFeed(feeds[z]);
+            }
+            if (setup.predictive) {
+                c.setBurstSizer(responses[z]);
+            }
+            c.setZone(setup.zones[z], &budget, z == 0);
+            c.setTrace(trace, static_cast<uint8_t>(z));
+            if (scheduled) {
+                c.setSchedule(schedule);
+            }
+            zones.add(c);
+        }
+        if (reservoir) {
+            fill.emplace("reservoir", clock);
+            fill->initialize();
+            reservoirController.emplace(levelLow, levelHigh, *fill, clock, events);
+        }
+    }
+
+    ReplayRig(const ReplayRig&) = delete;
+    ReplayRig& operator=(const ReplayRig&) = delete;
+
+    /// Pump @p id (input_record numbering), or null when there is none.
+    WaterPump* pump(std::size_t id)
+    {
+        if (id < pumps.size()) {
+            return pumps[id] ? &*pumps[id] : nullptr;
+        }
+        return id == input_record::kReservoirPump && fill ? &*fill : nullptr;
+    }
+
+    /// Move the clock to @p atMs, updating the pumps every kLoopMs while
+    /// one runs.
+    void advanceTo(int64_t atMs)
+    {
+        while (clock.nowMs() < atMs) {
+            bool running = false;
+            for (std::size_t id = 0; id < input_record::kPumps; ++id) {
+                running = running || (pump(id) != nullptr && pump(id)->isRunning());
+            }
+            if (!running) {
+                clock.advance(atMs - clock.nowMs());
+                break;
+            }
+            clock.advance(std::min(kLoopMs, atMs - clock.nowMs()));
+            for (std::size_t id = 0; id < input_record::kPumps; ++id) {
+                if (pump(id) != nullptr) {
+                    pump(id)->update();
+                }
+            }
+        }
+    }
+
+    /// The recorded decision config.
+    void apply(const RecordedConfig& c)
+    {
+        using input_record::ConfigItem;
+        config.stored.moistureThresholdLow = c.get(ConfigItem::ThresholdLow);
+        config.stored.moistureThresholdHigh = c.get(ConfigItem::ThresholdHigh);
+        config.stored.wateringDurationS =
+            static_cast<uint32_t>(c.get(ConfigItem::WateringDurationS));
+        config.stored.minWateringIntervalS =
+            static_cast<uint32_t>(c.get(ConfigItem::MinWateringIntervalS));
+        config.stored.wateringEnabled = c.get(ConfigItem::WateringEnabled) != 0.0f ? 1 : 0;
+        config.stored.sensorReadIntervalMs =
+            static_cast<uint32_t>(c.get(ConfigItem::SensorReadIntervalMs));
+    }
+
+    void setLevels(const RecordedLevels& levels)
+    {
+        auto set = [](MockLevelSensor& mark, bool valid, bool wet) {
+            if (valid) {
+                mark.scriptValidState(wet);
+            } else {
+                mark.scriptInvalid();
+            }
+        };
+        set(levelLow, levels.lowValid, levels.lowWet);
+        set(levelHigh, levels.highValid, levels.highWet);
+    }
+
+    /// One watering-task tick.
+    void tick()
+    {
+        zones.tick();
+        if (reservoirController) {
+            reservoirController->tick(true, config.getWateringEnabled());
+        }
+    }
+
+    FakeTimeProvider clock;
+    FakeWallClock wall;
+    MockConfigStore config;
+    MockDataStorage storage;
+    EventLogger events;
+    MockEnvironmentalSensor env;
+    MockSoilSensor soil;  ///< unused: every zone decides on its feed
+    MockLevelSensor levelLow;
+    MockLevelSensor levelHigh;
+    PumpBudget budget;
+    WateringSchedule schedule;
+    DecisionTrace trace;
+    std::array<ReplayFeed, input_record::kMaxZones> feeds;
+    std::array<std::optional<RecordedSoilFeed>, input_record::kMaxZones> recordedFeeds;
+    std::array<MoistureResponse, input_record::kMaxZones> responses;
+    std::array<std::optional<SimPump>, input_record::kMaxZones> pumps;
+    std::array<std::optional<WateringController>, input_record::kMaxZones> controllers;
+    WateringZones zones;
+    std::optional<SimPump> fill;
+    std::optional<ReservoirController> reservoirController;
+};
+
+/// What a replay found.
+struct ReplayReport {
+    uint64_t ticks = 0;
+    uint32_t blocks = 0;
+    uint32_t boots = 0;
+    uint32_t resyncs = 0;
+    uint32_t recordedStarts = 0;  ///< pump off -> on in the recording
+    uint32_t replayedStarts = 0;  ///< bursts and fills the replay started
+    uint32_t divergences = 0;
+    int64_t spanMs = 0;           ///< node time covered
+    double hostS = 0;
+    const char* error = nullptr;  ///< the recording is malformed here
+};
+
+/// Runs a recording through ReplayRig.
+class InputReplay {
+public:
+    /// @p verbose: print every start and stop the replay decides on.
+    explicit InputReplay(bool verbose) : verbose_(verbose) {}
+
+    ReplayReport run(const uint8_t* data, std::size_t len)
+    {
+        ReplayReport report;
+        InputRecordReader in(data, len);
+        std::unique_ptr<ReplayRig> rig;
+        std::array<bool, input_record::kPumps> recordedWas{};
+        uint32_t seen = 0;  // trace records read
+        int64_t lastMs = 0;
+        RecordedTick tick;
+        const auto started = std::chrono::steady_clock::now();
+        while (in.next(tick)) {
+            const bool rebuild = !rig || tick.boot || tick.resync;
+            if (rebuild) {
+                rig = std::make_unique<ReplayRig>(in.setup(), tick.atMs, in.hasReservoir());
+                seen = 0;
+                recordedWas = {};
+                report.boots += tick.boot ? 1 : 0;
+                report.resyncs += tick.boot ? 0 : 1;
+            } else {
+                report.spanMs += tick.atMs - lastMs;
+            }
+            lastMs = tick.atMs;
+            rig->advanceTo(tick.atMs);
+            rig->apply(in.config());
+            rig->wall.setEpoch(tick.epoch);
+            for (std::size_t z = 0; z < input_record::kMaxZones; ++z) {
+                rig->feeds[z].set(in.soil(z));
+            }
+            rig->setLevels(in.levels());
+            std::array<bool, input_record::kPumps> replayedWas{};
+            for (std::size_t id = 0; id < input_record::kPumps; ++id) {
+                replayedWas[id] = rig->pump(id) != nullptr && rig->pump(id)->isRunning();
+            }
+            rig->tick();
+            ++report.ticks;
+
+            // The decisions of this tick, zone by zone.
+            std::array<const DecisionRecord*, input_record::kMaxZones> decided{};
+            DecisionRecord records[input_record::kMaxZones];
+            const std::size_t n = rig->trace.read(records, input_record::kMaxZones, seen);
+            for (std::size_t i = 0; i < n; ++i) {
+                seen = records[i].sequence;
+                if (records[i].zone < decided.size()) {
+                    decided[records[i].zone] = &records[i];
+                }
+                if (verbose_ && records[i].action != DecisionAction::None) {
+                    std::printf("%s zone %u: %s (%s, moisture %.1f%%)\n",
+                                stamp(tick).c_str(), static_cast<unsigned>(records[i].zone),
+                                decisionActionName(records[i].action),
+                                decisionGateName(records[i].gate),
+                                static_cast<double>(records[i].moisture));
+                }
+            }
+
+            for (std::size_t id = 0; id < input_record::kPumps; ++id) {
+                WaterPump* p = rig->pump(id);
+                if (p == nullptr) {
+                    continue;
+                }
+                const bool recorded = in.pumpRunning(id);
+                const bool replayed = p->isRunning();
+                report.recordedStarts += recorded && !recordedWas[id] ? 1 : 0;
+                report.replayedStarts += replayed && !replayedWas[id] ? 1 : 0;
+                recordedWas[id] = recorded;
+                if (replayed == recorded) {
+                    continue;
+                }
+                if (!(rebuild && !tick.boot)) {
+                    ++report.divergences;
+                    const DecisionRecord* d = id < decided.size() ? decided[id] : nullptr;
+                    std::printf("%s %s: recorded %s, replayed %s", stamp(tick).c_str(),
+                                pumpName(id).c_str(), recorded ? "on" : "off",
+                                replayed ? "on" : "off");
+                    if (d != nullptr) {
+                        std::printf(" (%s, %s, moisture %.1f%%)", decisionGateName(d->gate),
+                                    decisionActionName(d->action),
+                                    static_cast<double>(d->moisture));
+                    }
+                    std::printf("\n");
+                }
+                // Follow the node from here on.
+                if (recorded) {
+                    p->runFor(static_cast<int>(WaterPump::kDefaultMaxRunTimeMs / 1000));
+                } else {
+                    p->stop();
+                }
+            }
+        }
+        report.blocks = static_cast<uint32_t>(in.blocks());
+        report.error = in.error();
+        report.hostS =
+            std::chrono::duration<double>(std::chrono::steady_clock::now() - started).count();
+        return report;
+    }
+
+    /// The report's summary lines.
+    static void print(const ReplayReport& r)
+    {
+        std::printf("replayed %" PRIu64 " ticks in %" PRIu32 " blocks (%" PRIu32 " boots, "
+                    "%" PRIu32 " resyncs): %.1f h of node time in %.2f s, %.0fx real time\n",
+                    r.ticks, r.blocks, r.boots, r.resyncs, r.spanMs / 3.6e6, r.hostS,
+                    r.hostS > 0 ? r.spanMs / 1000.0 / r.hostS : 0.0);
+        std::printf("pump starts: %" PRIu32 " recorded, %" PRIu32 " replayed; "
+                    "%" PRIu32 " divergences\n",
+                    r.recordedStarts, r.replayedStarts, r.divergences);
+        if (r.error != nullptr) {
+            std::printf("recording malformed: %s\n", r.error);
+        }
+    }
+
+private:
+    static std::string pumpName(std::size_t id)
+    {
+        return id == input_record::kReservoirPump ? std::string("reservoir")
+                                                  : "zone " + std::to_string(id);
+    }
+
+    static std::string stamp(const RecordedTick& tick)
+    {
+        char text[32];
+        if (tick.epoch == 0) {
+            std::snprintf(text, sizeof(text), "t+%.1fs", tick.atMs / 1000.0);
+            return text;
+        }
+        const std::time_t t = static_cast<std::time_t>(tick.epoch);
+        std::tm utc{};
+        gmtime_r(&t, &utc);
+        std::strftime(text, sizeof(text), "%Y-%m-%d %H:%M:%SZ", &utc);
+        return text;
+    }
+
+    bool verbose_;
+};
+
+}  // namespace replay
+
+#endif /* WATERINGSYSTEM_REPLAY_INPUTREPLAY_H */
@@ -0,0 +1,224 @@
+// SPDX-FileCopyrightText: 2026 Cryptotomte
+// SPDX-License-Identifier: AGPL-3.0-or-later
+/**
+ * @file replay_main.cpp
+ * @brief Replay of a recorded watering input stream (linux preview target).
+ *
+ * With REPLAY_FILE set (a GET /api/v1/recording body) it runs the recording
+ * through InputReplay and prints each divergence and the report; with
+ * REPLAY_VERBOSE=1 also every start and stop the replay decided on. Without
+ * REPLAY_FILE it is its own check: a two-zone reservoir node (ReplayRig
+ * with a recorder) waters a synthetic week — the clock unset for the first
+ * hour, a threshold change on day 2, a clock step on day 3, watering off
+ * for six hours on day 4 — its sealed blocks are collected as the recorder
+ * task would flush them, and the result is replayed, which must reproduce
+ * every pump start and stop. Tunables come from the environment (app_main
+ * has no argv on the linux target); see CLAUDE.md "Replay". The exit code
+ * is 0 for a replay without divergences, 1 otherwise, 2 when the file
+ * cannot be read.
+ */
+
+#include <algorithm>
+#include <cinttypes>
+#include <cstdio>
+#include <cstdlib>
+#include <ctime>
+#include <fstream>
+#include <iterator>
+#include <vector>
+
+#include "InputReplay.h"
+
+namespace {
+
+constexpr uint32_t kStartEpoch = 1'777'593'600;  ///< 2026-05-01T00:00:00Z
+constexpr int64_t kStartMs = 4'000;              ///< the first tick after boot
+constexpr int64_t kTickMs = 5'000;               ///< the default read interval
+constexpr int64_t kDayMs = 86'400'000;
+
+/// The recorder task's flushes, into a byte vector.
+struct Flusher {
+    const InputRecorder& recorder;
+    std::vector<uint8_t> bytes;
+    uint32_t flushed = 0;
+    uint32_t lost = 0;
+
+    void through(uint32_t last)
+    {
+        uint8_t block[input_record::kBlockBytes];
+        uint32_t sequence = flushed + 1;
+        if (recorder.oldest() > sequence) {
+            lost += recorder.oldest() - sequence;
+            sequence = recorder.oldest();
+        }
+        for (; sequence != 0 && sequence <= last; ++sequence) {
+            const std::size_t n = recorder.copyBlock(sequence, block);
+            bytes.insert(bytes.end(), block, block + n);
+            flushed = sequence;
+        }
+    }
+};
+
+/// A node watering a synthetic week into a recording.
+std::vector<uint8_t> recordWeek(uint32_t& ticks, uint32_t& starts)
+{
+    RecordedSetup setup;
+    setup.predictive = true;
+    setup.pumpBudget = 1;
+    setup.zoneCount = 2;
+    setup.zones[1] = ZoneSettings{35.0f, 55.0f, 20};
+
+    InputRecorder recorder(8);
+    recorder.setSetup(setup);
+    replay::ReplayRig node(setup, kStartMs, true, &recorder);
+    Flusher flusher{recorder, {}, 0, 0};
+
+    node.config.stored.moistureThresholdLow = 40.0f;
+    node.config.stored.moistureThresholdHigh = 60.0f;
+    node.config.stored.wateringDurationS = 30;
+    node.config.stored.minWateringIntervalS = 300;
+    node.config.stored.wateringEnabled = 1;
+    node.config.stored.sensorReadIntervalMs = kTickMs;
+
+    // Toy bed: each zone dries at its own rate and rises with run time;
+    // the reservoir drains with the zones and the fill pump refills it.
+    const float dryPctPerH[2] = {0.8f, 1.3f};
+    constexpr float kRisePctPerS = 0.4f;
+    constexpr float kDrainLps = 0.05f;
+    constexpr float kFillLps = 0.1f;
+    float moisture[2] = {45.0f, 42.0f};
+    float reservoirL = 6.0f;
+    int64_t ranMs[input_record::kPumps] = {};
+    uint32_t seed = 1;
+    uint32_t sequence[2] = {};
+    bool wasOn[input_record::kPumps] = {};
+    int64_t clockSetMs = 0;
+    uint32_t clockSetEpoch = 0;
+
+    ticks = 0;
+    starts = 0;
+    for (int64_t at = kStartMs; at < kStartMs + 7 * kDayMs; at += kTickMs) {
+        node.advanceTo(at);
+        for (std::size_t id = 0; id < input_record::kPumps; ++id) {
+            WaterPump* p = node.pump(id);
+            if (p == nullptr) {
+                continue;
+            }
+            const int64_t ran = p->getAccumulatedRunTimeMs() - ranMs[id];
+            ranMs[id] += ran;
+            if (id < 2) {
+                moisture[id] += ran / 1000.0f * kRisePctPerS;
+                reservoirL -= ran / 1000.0f * kDrainLps;
+            } else {
+                reservoirL = std::min(10.0f, reservoirL + ran / 1000.0f * kFillLps);
+            }
+        }
+        for (std::size_t z = 0; z < 2; ++z) {
+            moisture[z] -= dryPctPerH[z] * kTickMs / 3.6e6f;
+        }
+
+        // Wall clock: unset for an hour, then set; stepped an hour on day 3.
+        const int64_t elapsed = at - kStartMs;
+        if (clockSetEpoch == 0 && elapsed >= 3'600'000) {
+            clockSetMs = at;
+            clockSetEpoch = kStartEpoch + static_cast<uint32_t>(elapsed / 1000);
+        }
+        if (elapsed == 3 * kDayMs) {
+            clockSetEpoch += 3600;
+        }
+        const uint32_t epoch =
+            clockSetEpoch == 0 ? 0
+                               : clockSetEpoch + static_cast<uint32_t>((at - clockSetMs) / 1000);
+        node.wall.setEpoch(epoch);
+
+        if (elapsed == 2 * kDayMs) {
+            node.config.stored.moistureThresholdHigh = 65.0f;
+        }
+        if (elapsed == 4 * kDayMs || elapsed == 4 * kDayMs + 6 * 3'600'000) {
+            node.config.stored.wateringEnabled = elapsed == 4 * kDayMs ? 0 : 1;
+        }
+
+        // A read per tick, bar a missed one now and then; seeded noise.
+        for (std::size_t z = 0; z < 2; ++z) {
+            seed = seed * 1'103'515'245u + 12'345u;
+            if ((seed >> 16) % 23 == 0) {
+                continue;
+            }
+            TimedSoilSnapshot sample;
+            sample.soil.readOk = true;
+            sample.soil.available = true;
+            sample.soil.moisture =
+                moisture[z] + static_cast<float>((seed >> 16) % 41) / 100.0f - 0.2f;
+            sample.atMs = at - 40;
+            sample.sequence = ++sequence[z];
+            node.feeds[z].set(sample);
+        }
+        RecordedLevels levels;
+        levels.lowValid = true;
+        levels.lowWet = reservoirL > 2.0f;
+        levels.highValid = true;
+        levels.highWet = reservoirL > 8.0f;
+        node.setLevels(levels);
+
+        recorder.beginTick(at, epoch, RecordedConfig::from(node.config), &levels);
+        node.tick();
+        ++ticks;
+        for (std::size_t id = 0; id < input_record::kPumps; ++id) {
+            WaterPump* p = node.pump(id);
+            if (p != nullptr) {
+                recorder.pump(static_cast<uint8_t>(id), p->isRunning());
+                starts += p->isRunning() && !wasOn[id] ? 1 : 0;
+                wasOn[id] = p->isRunning();
+            }
+        }
+        if (recorder.newest() > 1) {
+            flusher.through(recorder.newest() - 1);
+        }
+    }
+    flusher.through(recorder.newest());
+    if (flusher.lost != 0) {
+        std::printf("self-test: %" PRIu32 " blocks lost before the flush\n", flusher.lost);
+    }
+    return flusher.bytes;
+}
+
+}  // namespace
+
+extern "C" void app_main(void)
+{
+    // The firmware's timezone (SntpClient::applyTimezone()), for the windows.
+    setenv("TZ", "CET-1CEST,M3.5.0,M10.5.0/3", 1);
+    tzset();
+    const char* verboseText = std::getenv("REPLAY_VERBOSE");
+    replay::InputReplay replay(verboseText != nullptr && std::atoi(verboseText) != 0);
+
+    const char* path = std::getenv("REPLAY_FILE");
+    if (path != nullptr && *path != '\0') {
+        std::ifstream in(path, std::ios::binary);
+        if (!in) {
+            std::fprintf(stderr, "REPLAY_FILE=\"%s\": cannot be read\n", path);
+            std::exit(2);
+        }
+        const std::vector<uint8_t> bytes((std::istreambuf_iterator<char>(in)),
+                                         std::istreambuf_iterator<char>());
+        const replay::ReplayReport report = replay.run(bytes.data(), bytes.size());
+        replay::InputReplay::print(report);
+        std::exit(report.divergences == 0 && report.error == nullptr ? 0 : 1);
+    }
+
+    uint32_t ticks = 0;
+    uint32_t starts = 0;
+    const std::vector<uint8_t> bytes = recordWeek(ticks, starts);
+    std::printf("self-test: recorded %" PRIu32 " ticks, %" PRIu32 " pump starts, "
+                "%zu bytes (%.1f per tick)\n",
+                ticks, starts, bytes.size(),
+                ticks > 0 ? static_cast<double>(bytes.size()) / ticks : 0.0);
+    const replay::ReplayReport report = replay.run(bytes.data(), bytes.size());
+    replay::InputReplay::print(report);
+    // The last tick is never finished (the next one would have done it),
+    // so it is not in the recording.
+    const bool ok = report.error == nullptr && report.divergences == 0 &&
+                    report.ticks + 1 == ticks && report.replayedStarts == starts;
+    std::printf("self-test: %s\n", ok ? "replay matches" : "FAILED");
+    std::exit(ok ? 0 : 1);
+}
@@ -0,0 +1,107 @@
+// SPDX-FileCopyrightText: 2026 Cryptotomte
+// SPDX-License-Identifier: AGPL-3.0-or-later
+/**
+ * @file PlantModel.h
+ * @brief Lumped physical model of one bed and its reservoir for the
+ *        watering simulator (header-only).
+ *
+ * Soil moisture (percent) dries by evapotranspiration that swings over the
+ * day and slows as the soil dries, and drains above field capacity. Pumped
+ * water lands on the surface and soaks into the root zone with a
+ * first-order lag, so a probe reads the rise after the burst, as on a real
+ * bed. The plant pump draws from the reservoir (a pump on an empty
+ * reservoir delivers nothing) and the fill pump tops it up; water above
+ * the capacity overflows. Deterministic: no randomness lives here.
+ */
+
+#ifndef WATERINGSYSTEM_SIM_PLANTMODEL_H
+#define WATERINGSYSTEM_SIM_PLANTMODEL_H
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+
+/// Model constants; the defaults are a 20 L reservoir feeding a potted bed.
+struct PlantParams {
+    float dryPctPerH = 0.5f;          ///< mean evapotranspiration at field capacity
+    float diurnalSwing = 0.8f;        ///< day/night share of it, [0, 1]
+    float risePctPerL = 8.0f;         ///< root-zone moisture per litre soaked in
+    float infiltrationTauS = 180.0f;  ///< surface water soaking in, time constant
+    float fieldCapacityPct = 65.0f;   ///< above it the excess drains
+    float drainPctPerH = 6.0f;
+    float plantFlowLps = 0.03f;       ///< plant pump delivery
+    float fillFlowLps = 0.08f;        ///< fill pump inflow
+    float reservoirCapacityL = 20.0f;
+    float lowMarkL = 4.0f;            ///< level sensor heights, as volumes
+    float highMarkL = 16.0f;
+};
+
+class PlantModel {
+public:
+    PlantModel(const PlantParams& params, float moisturePct, float reservoirL)
+        : p_(params), moisture_(moisturePct), reservoirL_(reservoirL)
+    {
+    }
+
+    /// Advance @p dtS seconds ending at wall-clock @p epoch (UTC; the
+    /// evapotranspiration peaks mid-afternoon) with the pumps as given.
+    void step(float dtS, bool plantPump, bool fillPump, uint32_t epoch)
+    {
+        if (plantPump) {
+            const float want = p_.plantFlowLps * dtS;
+            const float got = std::min(want, reservoirL_);
+            reservoirL_ -= got;
+            surfaceL_ += got;
+            plantL_ += got;
+            if (got < want) {
+                dryRunS_ += dtS;
+            }
+        }
+        if (fillPump) {
+            reservoirL_ += p_.fillFlowLps * dtS;
+            fillL_ += p_.fillFlowLps * dtS;
+            if (reservoirL_ > p_.reservoirCapacityL) {
+                overflowL_ += reservoirL_ - p_.reservoirCapacityL;
+                reservoirL_ = p_.reservoirCapacityL;
+            }
+        }
+
+        const float soaked = surfaceL_ * (1.0f - std::exp(-dtS / p_.infiltrationTauS));
+        surfaceL_ -= soaked;
+        moisture_ += soaked * p_.risePctPerL;
+
+        constexpr float kPi = 3.14159265f;
+        const float hour = static_cast<float>(epoch % 86400u) / 3600.0f;
+        const float diurnal =
+            1.0f + p_.diurnalSwing * std::sin(2.0f * kPi * (hour - 9.0f) / 24.0f);
+        const float wetness = std::min(1.0f, moisture_ / p_.fieldCapacityPct);
+        moisture_ -= p_.dryPctPerH * diurnal * wetness * dtS / 3600.0f;
+        if (moisture_ > p_.fieldCapacityPct) {
+            moisture_ -= std::min(moisture_ - p_.fieldCapacityPct,
+                                  p_.drainPctPerH * dtS / 3600.0f);
+        }
+        moisture_ = std::clamp(moisture_, 0.0f, 100.0f);
+    }
+
+    float moisturePct() const { return moisture_; }
+    float reservoirL() const { return reservoirL_; }
+    bool lowMarkWet() const { return reservoirL_ >= p_.lowMarkL; }
+    bool highMarkWet() const { return reservoirL_ >= p_.highMarkL; }
+
+    float plantLitres() const { return plantL_; }    ///< delivered to the bed
+    float fillLitres() const { return fillL_; }      ///< pumped into the reservoir
+    float overflowLitres() const { return overflowL_; }
+    float dryRunSeconds() const { return dryRunS_; } ///< plant pump on empty
+
+private:
+    PlantParams p_;
+    float moisture_;
+    float reservoirL_;
+    float surfaceL_ = 0.0f;
+    float plantL_ = 0.0f;
+    float fillL_ = 0.0f;
+    float overflowL_ = 0.0f;
+    float dryRunS_ = 0.0f;
+};
+
+#endif /* WATERINGSYSTEM_SIM_PLANTMODEL_H */
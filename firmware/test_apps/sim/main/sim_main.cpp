@@ -0,0 +1,261 @@
+// SPDX-FileCopyrightText: 2026 Cryptotomte
+// SPDX-License-Identifier: AGPL-3.0-or-later
+/**
+ * @file sim_main.cpp
+ * @brief Accelerated closed-loop simulation of the watering control loop
+ *        (linux preview target).
+ *
+ * Runs the REAL WateringController, ReservoirController and WaterPump code
+ * over FakeTimeProvider/FakeWallClock and the sensor mocks against
+ * PlantModel, stepping simulated time as fast as the host allows. Each
+ * 1 s step advances both clocks, updates the pumps (their timed self-stop
+ * and the 300 s cap) and the model; every sensor-read interval the soil
+ * mock takes the model's moisture plus seeded noise, the level mocks take
+ * the reservoir marks, and both controllers tick, as on the watering task.
+ *
+ * The report gives the water used, bursts and fills, threshold violations
+ * (time spent more than kViolationMarginPct outside [low, high]) and the
+ * controller cost as ticks per second of host time, so a controller change
+ * that regresses the real-time budget shows up next to its effect on the
+ * bed. With SIM_OUT set the controller cost is also written there as a
+ * result file for tools/perf_gate.py. Tunables come from the environment
+ * (app_main has no argv on the linux target); see CLAUDE.md "Simulation".
+ * The exit code is 0 unless a tunable is malformed or SIM_OUT cannot be
+ * written.
+ */
+
+#include <chrono>
+#include <cinttypes>
+#include <cstdio>
+#include <cstdlib>
+#include <ctime>
+#include <random>
+
+#include "PlantModel.h"
+#include "actuators/WaterPump.h"
+#include "actuators/testing/FakeTimeProvider.h"
+#include "control/MoistureResponse.h"
+#include "control/ReservoirController.h"
+#include "control/WateringController.h"
+#include "control/WateringSchedule.h"
+#include "events/EventLogger.h"
+#include "sensors/testing/MockEnvironmentalSensor.h"
+#include "sensors/testing/MockLevelSensor.h"
+#include "sensors/testing/MockSoilSensor.h"
+#include "storage/testing/MockConfigStore.h"
+#include "storage/testing/MockDataStorage.h"
+#include "time/testing/FakeWallClock.h"
+
+namespace {
+
+constexpr int64_t kStepMs = 1000;
+constexpr uint32_t kStartEpoch = 1'777'593'600;  ///< 2026-05-01T00:00:00Z
+constexpr float kViolationMarginPct = 5.0f;
+
+/// WaterPump with no output to drive: the model reads isRunning().
+class SimPump : public WaterPump {
+public:
+    using WaterPump::WaterPump;
+
+protected:
+    bool applyOutput(bool) override { return true; }
+};
+
+/// @p name from the environment as a number, else @p fallback.
+double envNumber(const char* name, double fallback, bool& ok)
+{
+    const char* text = std::getenv(name);
+    if (text == nullptr || *text == '\0') {
+        return fallback;
+    }
+    char* end = nullptr;
+    const double value = std::strtod(text, &end);
+    if (*end != '\0') {
+        std::fprintf(stderr, "%s=\"%s\": not a number\n", name, text);
+        ok = false;
+        return fallback;
+    }
+    return value;
+}
+
+/// Time and episodes spent on one side of a threshold band.
+struct Violation {
+    int64_t seconds = 0;
+    uint32_t episodes = 0;
+    bool inside = false;
+
+    void sample(bool violated, int64_t dtS)
+    {
+        if (violated) {
+            seconds += dtS;
+            episodes += inside ? 0 : 1;
+        }
+        inside = violated;
+    }
+};
+
+/// The controller cost in the bench result schema (SIM_OUT).
+bool writeJson(const char* path, uint64_t ticks, double meanNs, double worstNs)
+{
+    FILE* f = std::fopen(path, "w");
+    if (f == nullptr) {
+        std::fprintf(stderr, "SIM_OUT=\"%s\": cannot write\n", path);
+        return false;
+    }
+    std::fprintf(f,
+                 "{\n  \"version\": 1,\n  \"results\": [\n"
+                 "    {\"name\": \"sim.watering_tick\", \"iterations\": %llu, "
+                 "\"nsPerOp\": %.2f, \"worstNs\": %.0f}\n  ]\n}\n",
+                 static_cast<unsigned long long>(ticks), meanNs, worstNs);
+    return std::fclose(f) == 0;
+}
+
+}  // namespace
+
+extern "C" void app_main(void)
+{
+    bool ok = true;
+    auto number = [&ok](const char* name, double fallback) {
+        return envNumber(name, fallback, ok);
+    };
+    const int days = static_cast<int>(number("SIM_DAYS", 90));
+    const auto seed = static_cast<uint32_t>(number("SIM_SEED", 1));
+    const auto noisePct = static_cast<float>(number("SIM_NOISE_PCT", 0.3));
+    const bool predictive = number("SIM_PREDICTIVE", 1) != 0;
+    PlantParams params;
+    params.dryPctPerH = static_cast<float>(number("SIM_DRY_PCT_PER_H", params.dryPctPerH));
+    params.risePctPerL = static_cast<float>(number("SIM_RISE_PCT_PER_L", params.risePctPerL));
+    params.plantFlowLps = static_cast<float>(number("SIM_PLANT_LPS", params.plantFlowLps));
+    params.fillFlowLps = static_cast<float>(number("SIM_FILL_LPS", params.fillFlowLps));
+
+    FakeTimeProvider clock;
+    FakeWallClock wallClock(kStartEpoch);
+    MockConfigStore config;
+    config.stored.moistureThresholdLow = static_cast<float>(
+        number("SIM_LOW", IConfigStore::kDefaultMoistureThresholdLow));
+    config.stored.moistureThresholdHigh = static_cast<float>(
+        number("SIM_HIGH", IConfigStore::kDefaultMoistureThresholdHigh));
+    config.stored.wateringDurationS = static_cast<uint32_t>(
+        number("SIM_BURST_S", IConfigStore::kDefaultWateringDurationS));
+    config.stored.minWateringIntervalS = static_cast<uint32_t>(
+        number("SIM_SOAK_S", IConfigStore::kDefaultMinWateringIntervalS));
+    config.stored.wateringEnabled = 1;
+
+    // The firmware's timezone (SntpClient::applyTimezone()), for the windows.
+    setenv("TZ", "CET-1CEST,M3.5.0,M10.5.0/3", 1);
+    tzset();
+    WateringSchedule schedule;
+    const char* rules = std::getenv("SIM_SCHEDULE");
+    if (!parseWateringSchedule(rules, schedule)) {
+        std::fprintf(stderr, "SIM_SCHEDULE=\"%s\": malformed\n", rules);
+        ok = false;
+    }
+    if (!ok) {
+        std::exit(2);
+    }
+
+    MockDataStorage storage;
+    EventLogger events(storage, wallClock);
+    MockEnvironmentalSensor env;
+    MockSoilSensor soil;
+    MockLevelSensor levelLow;
+    MockLevelSensor levelHigh;
+    SimPump plantPump("plant", clock);
+    SimPump fillPump("reservoir", clock);
+    plantPump.initialize();
+    fillPump.initialize();
+
+    WateringController watering(soil, env, plantPump, config, storage, clock,
+                                wallClock, events);
+    MoistureResponse response;
+    if (predictive) {
+        watering.setBurstSizer(response);
+    }
+    if (schedule.size() > 0) {
+        watering.setSchedule(schedule);
+    }
+    ReservoirController reservoir(levelLow, levelHigh, fillPump, clock, events);
+
+    PlantModel plant(params, config.getMoistureThresholdHigh(), params.highMarkL);
+    std::mt19937 rng(seed);
+    std::normal_distribution<float> noise(0.0f, noisePct);
+
+    const float low = config.getMoistureThresholdLow();
+    const float high = config.getMoistureThresholdHigh();
+    const int64_t tickEveryMs = config.getSensorReadIntervalMs();
+    const int64_t totalMs = static_cast<int64_t>(days) * 86'400'000;
+
+    Violation under;
+    Violation over;
+    uint32_t bursts = 0;
+    uint32_t fills = 0;
+    bool plantWasOn = false;
+    bool fillWasOn = false;
+    uint64_t ticks = 0;
+    std::chrono::nanoseconds tickTime{0};
+    std::chrono::nanoseconds worstTick{0};
+    const auto started = std::chrono::steady_clock::now();
+
+    for (int64_t simMs = 0; simMs < totalMs; simMs += kStepMs) {
+        clock.advance(kStepMs);
+        wallClock.setEpoch(wallClock.nowEpoch() + static_cast<uint32_t>(kStepMs / 1000));
+        plantPump.update();
+        fillPump.update();
+        plant.step(kStepMs / 1000.0f, plantPump.isRunning(), fillPump.isRunning(),
+                   wallClock.nowEpoch());
+
+        if (simMs % tickEveryMs == 0) {
+            soil.moisture = plant.moisturePct() + noise(rng);
+            levelLow.scriptValidState(plant.lowMarkWet());
+            levelHigh.scriptValidState(plant.highMarkWet());
+            const auto t0 = std::chrono::steady_clock::now();
+            watering.tick();
+            reservoir.tick(true, true);
+            const auto spent = std::chrono::steady_clock::now() - t0;
+            tickTime += spent;
+            if (spent > worstTick) {
+                worstTick = std::chrono::duration_cast<std::chrono::nanoseconds>(spent);
+            }
+            ++ticks;
+        }
+
+        bursts += (plantPump.isRunning() && !plantWasOn) ? 1 : 0;
+        fills += (fillPump.isRunning() && !fillWasOn) ? 1 : 0;
+        plantWasOn = plantPump.isRunning();
+        fillWasOn = fillPump.isRunning();
+        under.sample(plant.moisturePct() < low - kViolationMarginPct, kStepMs / 1000);
+        over.sample(plant.moisturePct() > high + kViolationMarginPct, kStepMs / 1000);
+    }
+
+    const double wallS =
+        std::chrono::duration<double>(std::chrono::steady_clock::now() - started).count();
+    const double tickS = std::chrono::duration<double>(tickTime).count();
+    std::printf("simulated %d days (seed %" PRIu32 ", %s bursts, schedule: %u rules) "
+                "in %.2f s: %.0fx real time\n",
+                days, seed, predictive ? "sized" : "fixed",
+                static_cast<unsigned>(schedule.size()), wallS,
+                static_cast<double>(totalMs) / 1000.0 / wallS);
+    std::printf("water:       plant %.1f L, reservoir fill %.1f L, overflow %.2f L\n",
+                plant.plantLitres(), plant.fillLitres(), plant.overflowLitres());
+    std::printf("pumps:       %" PRIu32 " bursts (%.1f/day, %.1f s run total), "
+                "%" PRIu32 " fills, %.0f s dry run\n",
+                bursts, static_cast<double>(bursts) / days,
+                plantPump.getAccumulatedRunTimeMs() / 1000.0, fills,
+                plant.dryRunSeconds());
+    std::printf("violations:  below %.0f%% for %" PRId64 " s in %" PRIu32 " episodes, "
+                "above %.0f%% for %" PRId64 " s in %" PRIu32 " episodes\n",
+                low - kViolationMarginPct, under.seconds, under.episodes,
+                high + kViolationMarginPct, over.seconds, over.episodes);
+    std::printf("controller:  %" PRIu64 " ticks, %.0f ticks/s, mean %.2f us, worst %.2f us\n",
+                ticks, tickS > 0 ? ticks / tickS : 0.0,
+                ticks > 0 ? tickS * 1e6 / ticks : 0.0, worstTick.count() / 1000.0);
+    std::printf("final:       moisture %.1f%%, reservoir %.1f L\n", plant.moisturePct(),
+                plant.reservoirL());
+    const char* out = std::getenv("SIM_OUT");
+    if (out != nullptr && *out != '\0' &&
+        !writeJson(out, ticks, ticks > 0 ? tickS * 1e9 / ticks : 0.0,
+                   static_cast<double>(worstTick.count()))) {
+        std::exit(1);
+    }
+    std::exit(0);
+}
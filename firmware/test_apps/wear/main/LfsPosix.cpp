@@ -0,0 +1,393 @@
+// SPDX-FileCopyrightText: 2026 Cryptotomte
+// SPDX-License-Identifier: AGPL-3.0-or-later
+/**
+ * @file LfsPosix.cpp
+ * @brief The `--wrap` targets that put littlefs under the mount prefix
+ *        (see LfsPosix.h).
+ *
+ * Paths outside the prefix go to the `__real_` libc symbol. littlefs error
+ * codes are negated errno values, so a failure sets errno = -err.
+ */
+
+#include "LfsPosix.h"
+
+#include <dirent.h>
+#include <sys/stat.h>
+#include <sys/types.h>
+
+#include <cerrno>
+#include <cstdio>
+#include <cstring>
+#include <map>
+#include <string>
+
+#include "lfs.h"
+
+extern "C" {
+FILE* __real_fopen(const char* path, const char* mode);
+int __real_fileno(FILE* file);
+int __real_fsync(int fd);
+int __real_stat(const char* path, struct stat* st);
+int __real_mkdir(const char* path, mode_t mode);
+DIR* __real_opendir(const char* path);
+struct dirent* __real_readdir(DIR* dir);
+int __real_closedir(DIR* dir);
+int __real_remove(const char* path);
+int __real_rename(const char* from, const char* to);
+int __real_truncate(const char* path, off_t length);
+}
+
+namespace {
+
+// esp_littlefs defaults (CONFIG_LITTLEFS_READ_SIZE/WRITE_SIZE/
+// LOOKAHEAD_SIZE/CACHE_SIZE/BLOCK_CYCLES), so the program/erase pattern
+// matches the device's.
+constexpr lfs_size_t kReadSize = 128;
+constexpr lfs_size_t kProgSize = 128;
+constexpr lfs_size_t kCacheSize = 512;
+constexpr lfs_size_t kLookaheadSize = 128;
+constexpr int32_t kBlockCycles = 512;
+
+constexpr int kFdBase = 1000;  ///< fileno() of a littlefs stream
+
+struct OpenFile {
+    lfs_file_t file{};
+    FILE* stream = nullptr;
+    int fd = -1;
+};
+
+struct LfsDir {
+    lfs_dir_t dir{};
+    struct dirent entry{};
+};
+
+lfs_t s_lfs{};
+lfs_config s_cfg{};
+bool s_mounted = false;
+std::string s_prefix;
+int s_nextFd = kFdBase;
+std::map<FILE*, OpenFile*> s_files;
+std::map<int, OpenFile*> s_fds;
+std::map<DIR*, LfsDir*> s_dirs;
+
+int blockRead(const lfs_config* c, lfs_block_t block, lfs_off_t off, void* buffer,
+              lfs_size_t size)
+{
+    const auto* flash = static_cast<const WearFlash*>(c->context);
+    return flash->read(block * c->block_size + off, buffer, size) ? 0 : LFS_ERR_IO;
+}
+
+int blockProg(const lfs_config* c, lfs_block_t block, lfs_off_t off, const void* buffer,
+              lfs_size_t size)
+{
+    auto* flash = static_cast<WearFlash*>(c->context);
+    return flash->write(block * c->block_size + off, buffer, size) ? 0 : LFS_ERR_IO;
+}
+
+int blockErase(const lfs_config* c, lfs_block_t block)
+{
+    auto* flash = static_cast<WearFlash*>(c->context);
+    return flash->eraseSector(block) ? 0 : LFS_ERR_IO;
+}
+
+int blockSync(const lfs_config*)
+{
+    return 0;
+}
+
+/// The littlefs path for @p path, or nullptr when it is not under the
+/// mount prefix.
+const char* lfsPath(const char* path)
+{
+    if (s_prefix.empty() || path == nullptr ||
+        std::strncmp(path, s_prefix.c_str(), s_prefix.size()) != 0) {
+        return nullptr;
+    }
+    const char* rest = path + s_prefix.size();
+    if (*rest == '\0') {
+        return "/";
+    }
+    return *rest == '/' ? rest : nullptr;
+}
+
+/// errno from a littlefs result; -1 for the POSIX return.
+int fail(int err)
+{
+    errno = err < 0 ? -err : EIO;
+    return -1;
+}
+
+int lfsFlags(const char* mode)
+{
+    const bool plus = std::strchr(mode, '+') != nullptr;
+    switch (mode[0]) {
+        case 'r':
+            return plus ? LFS_O_RDWR : LFS_O_RDONLY;
+        case 'w':
+            return (plus ? LFS_O_RDWR : LFS_O_WRONLY) | LFS_O_CREAT | LFS_O_TRUNC;
+        case 'a':
+            return (plus ? LFS_O_RDWR : LFS_O_WRONLY) | LFS_O_CREAT | LFS_O_APPEND;
+        default:
+            return -1;
+    }
+}
+
+// --- fopencookie callbacks ------------------------------------------------
+
+ssize_t cookieRead(void* cookie, char* buf, size_t size)
+{
+    auto* open = static_cast<OpenFile*>(cookie);
+    const lfs_ssize_t n = lfs_file_read(&s_lfs, &open->file, buf, static_cast<lfs_size_t>(size));
+    return n < 0 ? fail(n) : n;
+}
+
+ssize_t cookieWrite(void* cookie, const char* buf, size_t size)
+{
+    auto* open = static_cast<OpenFile*>(cookie);
+    const lfs_ssize_t n = lfs_file_write(&s_lfs, &open->file, buf, static_cast<lfs_size_t>(size));
+    return n < 0 ? fail(n) : n;
+}
+
+int cookieSeek(void* cookie, off64_t* offset, int whence)
+{
+    auto* open = static_cast<OpenFile*>(cookie);
+    const int lfsWhence = whence == SEEK_SET   ? LFS_SEEK_SET
+                          : whence == SEEK_CUR ? LFS_SEEK_CUR
+                                               : LFS_SEEK_END;
+    const lfs_soff_t pos = lfs_file_seek(&s_lfs, &open->file,
+                                         static_cast<lfs_soff_t>(*offset), lfsWhence);
+    if (pos < 0) {
+        return fail(pos);
+    }
+    *offset = pos;
+    return 0;
+}
+
+int cookieClose(void* cookie)
+{
+    auto* open = static_cast<OpenFile*>(cookie);
+    const int err = lfs_file_close(&s_lfs, &open->file);
+    s_files.erase(open->stream);
+    s_fds.erase(open->fd);
+    delete open;
+    return err < 0 ? fail(err) : 0;
+}
+
+}  // namespace
+
+bool lfsPosixMount(WearFlash& flash, const char* prefix)
+{
+    s_cfg = lfs_config{};
+    s_cfg.context = &flash;
+    s_cfg.read = &blockRead;
+    s_cfg.prog = &blockProg;
+    s_cfg.erase = &blockErase;
+    s_cfg.sync = &blockSync;
+    s_cfg.read_size = kReadSize;
+    s_cfg.prog_size = kProgSize;
+    s_cfg.block_size = static_cast<lfs_size_t>(IFlashPartition::kSectorBytes);
+    s_cfg.block_count = static_cast<lfs_size_t>(flash.sectors());
+    s_cfg.block_cycles = kBlockCycles;
+    s_cfg.cache_size = kCacheSize;
+    s_cfg.lookahead_size = kLookaheadSize;
+    if (lfs_format(&s_lfs, &s_cfg) != 0 || lfs_mount(&s_lfs, &s_cfg) != 0) {
+        return false;
+    }
+    s_mounted = true;
+    s_prefix = prefix;
+    return true;
+}
+
+void lfsPosixUnmount()
+{
+    if (s_mounted) {
+        lfs_unmount(&s_lfs);
+        s_mounted = false;
+    }
+    s_prefix.clear();
+}
+
+extern "C" {
+
+FILE* __wrap_fopen(const char* path, const char* mode)
+{
+    const char* p = lfsPath(path);
+    if (p == nullptr) {
+        return __real_fopen(path, mode);
+    }
+    const int flags = lfsFlags(mode);
+    if (flags < 0) {
+        errno = EINVAL;
+        return nullptr;
+    }
+    auto* open = new OpenFile;
+    const int err = lfs_file_open(&s_lfs, &open->file, p, flags);
+    if (err < 0) {
+        delete open;
+        fail(err);
+        return nullptr;
+    }
+    const cookie_io_functions_t io = {&cookieRead, &cookieWrite, &cookieSeek, &cookieClose};
+    FILE* file = fopencookie(open, mode, io);
+    if (file == nullptr) {
+        lfs_file_close(&s_lfs, &open->file);
+        delete open;
+        return nullptr;
+    }
+    open->stream = file;
+    open->fd = s_nextFd++;
+    s_files[file] = open;
+    s_fds[open->fd] = open;
+    return file;
+}
+
+int __wrap_fileno(FILE* file)
+{
+    const auto it = s_files.find(file);
+    if (it != s_files.end()) {
+        return it->second->fd;
+    }
+    return __real_fileno(file);
+}
+
+int __wrap_fsync(int fd)
+{
+    const auto it = s_fds.find(fd);
+    if (it == s_fds.end()) {
+        return __real_fsync(fd);
+    }
+    const int err = lfs_file_sync(&s_lfs, &it->second->file);
+    return err < 0 ? fail(err) : 0;
+}
+
+int __wrap_stat(const char* path, struct stat* st)
+{
+    const char* p = lfsPath(path);
+    if (p == nullptr) {
+        return __real_stat(path, st);
+    }
+    lfs_info info{};
+    const int err = lfs_stat(&s_lfs, p, &info);
+    if (err < 0) {
+        return fail(err);
+    }
+    std::memset(st, 0, sizeof *st);
+    st->st_mode = info.type == LFS_TYPE_DIR ? (S_IFDIR | 0775) : (S_IFREG | 0664);
+    st->st_size = static_cast<off_t>(info.size);
+    st->st_blksize = static_cast<blksize_t>(s_cfg.block_size);
+    return 0;
+}
+
+int __wrap_mkdir(const char* path, mode_t mode)
+{
+    const char* p = lfsPath(path);
+    if (p == nullptr) {
+        return __real_mkdir(path, mode);
+    }
+    const int err = lfs_mkdir(&s_lfs, p);
+    return err < 0 ? fail(err) : 0;
+}
+
+DIR* __wrap_opendir(const char* path)
+{
+    const char* p = lfsPath(path);
+    if (p == nullptr) {
+        return __real_opendir(path);
+    }
+    auto* d = new LfsDir;
+    const int err = lfs_dir_open(&s_lfs, &d->dir, p);
+    if (err < 0) {
+        delete d;
+        fail(err);
+        return nullptr;
+    }
+    // Never dereferenced as a libc DIR: only the wrappers below see it.
+    DIR* handle = reinterpret_cast<DIR*>(d);
+    s_dirs[handle] = d;
+    return handle;
+}
+
+struct dirent* __wrap_readdir(DIR* dir)
+{
+    const auto it = s_dirs.find(dir);
+    if (it == s_dirs.end()) {
+        return __real_readdir(dir);
+    }
+    LfsDir* d = it->second;
+    lfs_info info{};
+    for (;;) {
+        const int n = lfs_dir_read(&s_lfs, &d->dir, &info);
+        if (n <= 0) {
+            if (n < 0) {
+                fail(n);
+            }
+            return nullptr;
+        }
+        // The esp_littlefs VFS hides the dot entries; so does this.
+        if (std::strcmp(info.name, ".") != 0 && std::strcmp(info.name, "..") != 0) {
+            break;
+        }
+    }
+    std::snprintf(d->entry.d_name, sizeof d->entry.d_name, "%s", info.name);
+    d->entry.d_type = info.type == LFS_TYPE_DIR ? DT_DIR : DT_REG;
+    return &d->entry;
+}
+
+int __wrap_closedir(DIR* dir)
+{
+    const auto it = s_dirs.find(dir);
+    if (it == s_dirs.end()) {
+        return __real_closedir(dir);
+    }
+    LfsDir* d = it->second;
+    s_dirs.erase(it);
+    const int err = lfs_dir_close(&s_lfs, &d->dir);
+    delete d;
+    return err < 0 ? fail(err) : 0;
+}
+
+int __wrap_remove(const char* path)
+{
+    const char* p = lfsPath(path);
+    if (p == nullptr) {
+        return __real_remove(path);
+    }
+    const int err = lfs_remove(&s_lfs, p);
+    return err < 0 ? fail(err) : 0;
+}
+
+int __wrap_rename(const char* from, const char* to)
+{
+    const char* p = lfsPath(from);
+    const char* q = lfsPath(to);
+    if (p == nullptr && q == nullptr) {
+        return __real_rename(from, to);
+    }
+    if (p == nullptr || q == nullptr) {
+        errno = EXDEV;
+        return -1;
+    }
+    const int err = lfs_rename(&s_lfs, p, q);
+    return err < 0 ? fail(err) : 0;
+}
+
+int __wrap_truncate(const char* path, off_t length)
+{
+    const char* p = lfsPath(path);
+    if (p == nullptr) {
+        return __real_truncate(path, length);
+    }
+    lfs_file_t file{};
+    int err = lfs_file_open(&s_lfs, &file, p, LFS_O_RDWR);
+    if (err < 0) {
+        return fail(err);
+    }
+    err = lfs_file_truncate(&s_lfs, &file, static_cast<lfs_off_t>(length));
+    const int closed = lfs_file_close(&s_lfs, &file);
+    if (err < 0) {
+        return fail(err);
+    }
+    return closed < 0 ? fail(closed) : 0;
+}
+
+}  // extern "C"
@@ -0,0 +1,34 @@
+// SPDX-FileCopyrightText: 2026 Cryptotomte
+// SPDX-License-Identifier: AGPL-3.0-or-later
+/**
+ * @file LfsPosix.h
+ * @brief littlefs on a WearFlash, behind the stdio/POSIX calls that
+ *        LittleFsDataStorage makes (linux preview target only).
+ *
+ * On the device LittleFsDataStorage reaches littlefs through the IDF VFS;
+ * the host has no VFS, so the wear simulator links with `-Wl,--wrap` for
+ * each call the storage makes (fopen, fileno, fsync, stat, mkdir,
+ * opendir/readdir/closedir, remove, rename, truncate; see the component
+ * CMakeLists) and LfsPosix.cpp routes the paths under the mount prefix to
+ * littlefs, passing every other path to libc. fopen returns a real FILE
+ * (glibc fopencookie), so fread/fwrite/fseek/ftell/fgetc/fflush/fclose
+ * need no wrapping. The littlefs geometry is the esp_littlefs default
+ * (128-byte read/program, 512-byte cache, 512 block cycles), so the block
+ * traffic is what the partition sees on target.
+ *
+ * Single-threaded; one mount at a time.
+ */
+
+#ifndef WATERINGSYSTEM_WEAR_LFSPOSIX_H
+#define WATERINGSYSTEM_WEAR_LFSPOSIX_H
+
+#include "WearFlash.h"
+
+/// Format @p flash, mount it and serve the paths under @p prefix (no
+/// trailing slash) from it. False when littlefs refuses either step.
+bool lfsPosixMount(WearFlash& flash, const char* prefix);
+
+/// Unmount; later calls under the prefix fail with ENOENT.
+void lfsPosixUnmount();
+
+#endif /* WATERINGSYSTEM_WEAR_LFSPOSIX_H */
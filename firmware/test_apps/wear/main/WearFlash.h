@@ -0,0 +1,79 @@
+// SPDX-FileCopyrightText: 2026 Cryptotomte
+// SPDX-License-Identifier: AGPL-3.0-or-later
+/**
+ * @file WearFlash.h
+ * @brief RAM NOR flash that counts wear per sector (header-only).
+ *
+ * The block device under both wear-simulator backends: RingLogDataStorage
+ * uses it as its IFlashPartition, littlefs through the lfs_config
+ * callbacks in LfsPosix.cpp. NOR semantics as RamFlashPartition (erase to
+ * 0xFF, a program ANDs into the existing bytes); on top of it every
+ * sector keeps its erase count, and the programmed bytes are totalled for
+ * the write amplification.
+ */
+
+#ifndef WATERINGSYSTEM_WEAR_WEARFLASH_H
+#define WATERINGSYSTEM_WEAR_WEARFLASH_H
+
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <vector>
+
+#include "interfaces/IFlashPartition.h"
+
+class WearFlash : public IFlashPartition {
+public:
+    /// @p bytes rounded down to whole sectors, all erased.
+    explicit WearFlash(std::size_t bytes)
+        : erases(bytes / kSectorBytes, 0), bytes_(erases.size() * kSectorBytes, 0xFF)
+    {
+    }
+
+    /// Erases per sector since construction.
+    std::vector<uint32_t> erases;
+    uint64_t programmedBytes = 0;
+
+    std::size_t sectors() const { return erases.size(); }
+
+    std::size_t size() const override { return bytes_.size(); }
+
+    bool read(std::size_t offset, void* dst, std::size_t len) const override
+    {
+        if (offset > bytes_.size() || len > bytes_.size() - offset) {
+            return false;
+        }
+        std::memcpy(dst, bytes_.data() + offset, len);
+        return true;
+    }
+
+    bool write(std::size_t offset, const void* src, std::size_t len) override
+    {
+        if (offset > bytes_.size() || len > bytes_.size() - offset) {
+            return false;
+        }
+        const auto* in = static_cast<const uint8_t*>(src);
+        for (std::size_t i = 0; i < len; ++i) {
+            bytes_[offset + i] &= in[i];
+        }
+        programmedBytes += len;
+        return true;
+    }
+
+    bool eraseSector(std::size_t sector) override
+    {
+        if (sector >= erases.size()) {
+            return false;
+        }
+        std::memset(bytes_.data() + sector * kSectorBytes, 0xFF, kSectorBytes);
+        ++erases[sector];
+        return true;
+    }
+
+    const uint8_t* mapped() const override { return bytes_.data(); }
+
+private:
+    std::vector<uint8_t> bytes_;
+};
+
+#endif /* WATERINGSYSTEM_WEAR_WEARFLASH_H */
@@ -0,0 +1,319 @@
+// SPDX-FileCopyrightText: 2026 Cryptotomte
+// SPDX-License-Identifier: AGPL-3.0-or-later
+/**
+ * @file wear_main.cpp
+ * @brief Flash wear and retention simulation of the data storage (linux
+ *        preview target).
+ *
+ * Drives a REAL IDataStorage backend with the data-log workload over a
+ * simulated duration, as fast as the host allows: every log interval one
+ * storeSensorReadings() batch (one reading per metric, each a seeded
+ * random walk at 0.1 resolution), events at a steady daily rate, and the
+ * group-commit deadline checked as the watering task does. The storage
+ * sits on a WearFlash the size of its partition, which counts the erases
+ * of every sector:
+ *  - littlefs (default): LittleFsDataStorage with the target's caches on,
+ *    over littlefs itself (LfsPosix.h), so the counts include littlefs
+ *    metadata commits, compaction and its own wear levelling;
+ *  - ringlog: RingLogDataStorage straight on the flash.
+ *
+ * The report gives the retention reached (history per metric, events),
+ * the write amplification (flash bytes programmed per byte the storage
+ * appended, and per reading), the erase rate with its spread across the
+ * sectors, and the projected lifetime at the flash's rated endurance for
+ * even wear and for the most-erased sector. Rates are taken over the
+ * second half of the run, once the rings are full and eviction runs, so a
+ * run must be long enough to fill them (the report flags one that is
+ * not). With WEAR_OUT set the steady-state rates are also written there
+ * as a result file for tools/perf_gate.py. Tunables come from the
+ * environment; see CLAUDE.md "Flash wear". The exit code is 0 unless a
+ * tunable is malformed, the mount fails or WEAR_OUT cannot be written.
+ */
+
+#include <algorithm>
+#include <chrono>
+#include <cinttypes>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <limits>
+#include <memory>
+#include <random>
+#include <string>
+#include <vector>
+
+#include "LfsPosix.h"
+#include "WearFlash.h"
+#include "actuators/testing/FakeTimeProvider.h"
+#include "interfaces/IConfigStore.h"
+#include "interfaces/IDataStorage.h"
+#include "interfaces/MetricRegistry.h"
+#include "storage/LittleFsDataStorage.h"
+#include "storage/RingLogDataStorage.h"
+
+namespace {
+
+constexpr uint32_t kStartEpoch = 1'777'593'600;  ///< 2026-05-01T00:00:00Z
+constexpr uint32_t kDayS = 86400;
+constexpr const char* kMountPrefix = "/wear";
+constexpr std::size_t kLittleFsPartitionBytes = 0xF0000;  ///< partitions.csv
+constexpr std::size_t kRingLogPartitionBytes = 0x70000;   ///< partitions_ringlog.csv
+constexpr double kReadingPayloadBytes = 8.0;              ///< {uint32 epoch, float}
+
+double envNumber(const char* name, double fallback, bool& ok)
+{
+    const char* text = std::getenv(name);
+    if (text == nullptr || *text == '\0') {
+        return fallback;
+    }
+    char* end = nullptr;
+    const double value = std::strtod(text, &end);
+    if (*end != '\0') {
+        std::fprintf(stderr, "%s=\"%s\": not a number\n", name, text);
+        ok = false;
+        return fallback;
+    }
+    return value;
+}
+
+/// Counters sampled at the midpoint and at the end.
+struct WearSnapshot {
+    std::vector<uint32_t> erases;
+    uint64_t programmedBytes = 0;
+    uint64_t appendedBytes = 0;
+    uint64_t readings = 0;
+
+    static WearSnapshot take(const WearFlash& flash, const IDataStorage& storage,
+                             uint64_t readings)
+    {
+        WearSnapshot s;
+        s.erases = flash.erases;
+        s.programmedBytes = flash.programmedBytes;
+        s.appendedBytes = storage.getStorageStats().writes.bytesAppended;
+        s.readings = readings;
+        return s;
+    }
+};
+
+/// Stops at the first (oldest) reading.
+class OldestVisitor : public IReadingVisitor {
+public:
+    bool onReading(uint32_t epoch, float) override
+    {
+        oldest = epoch;
+        found = true;
+        return false;
+    }
+
+    uint32_t oldest = 0;
+    bool found = false;
+};
+
+/// The steady-state rates in the bench result schema (WEAR_OUT).
+bool writeJson(const char* path, const std::string& backend, double flashBytesPerDay,
+               double appendedBytesPerDay, double erasesPerDay)
+{
+    FILE* f = std::fopen(path, "w");
+    if (f == nullptr) {
+        std::fprintf(stderr, "WEAR_OUT=\"%s\": cannot write\n", path);
+        return false;
+    }
+    std::fprintf(f,
+                 "{\n  \"version\": 1,\n  \"results\": [\n"
+                 "    {\"name\": \"wear.%s\", \"flashBytesPerDay\": %.0f, "
+                 "\"appendedBytesPerDay\": %.0f, \"erasesPerDay\": %.2f}\n  ]\n}\n",
+                 backend.c_str(), flashBytesPerDay, appendedBytesPerDay, erasesPerDay);
+    return std::fclose(f) == 0;
+}
+
+}  // namespace
+
+extern "C" void app_main(void)
+{
+    bool ok = true;
+    auto number = [&ok](const char* name, double fallback) {
+        return envNumber(name, fallback, ok);
+    };
+    const char* backendText = std::getenv("WEAR_BACKEND");
+    const std::string backend =
+        backendText != nullptr && *backendText != '\0' ? backendText : "littlefs";
+    const bool ringLog = backend == "ringlog";
+    if (!ringLog && backend != "littlefs") {
+        std::fprintf(stderr, "WEAR_BACKEND=\"%s\": not littlefs or ringlog\n", backend.c_str());
+        ok = false;
+    }
+    const int days = static_cast<int>(number("WEAR_DAYS", 90));
+    const auto seed = static_cast<uint32_t>(number("WEAR_SEED", 1));
+    const auto intervalS = static_cast<uint32_t>(
+        number("WEAR_LOG_INTERVAL_S", IConfigStore::kDefaultDataLogIntervalMs / 1000));
+    const auto metrics = static_cast<std::size_t>(number("WEAR_METRICS", 10));
+    const double eventsPerDay = number("WEAR_EVENTS_PER_DAY", 24);
+    const auto partitionBytes = static_cast<std::size_t>(number(
+        "WEAR_PARTITION_BYTES", ringLog ? kRingLogPartitionBytes : kLittleFsPartitionBytes));
+    const double endurance = number("WEAR_ENDURANCE", 100000);
+    const auto groupCommitMs = static_cast<uint32_t>(number("WEAR_GROUP_COMMIT_MS", 0));
+    const bool delta = number("WEAR_DELTA", 1) != 0;
+    const bool rollups = number("WEAR_ROLLUPS", 0) != 0;
+    if (days < 2 || intervalS == 0 || metrics == 0 || metrics > metric::kKnownCount ||
+        partitionBytes < 4 * IFlashPartition::kSectorBytes) {
+        std::fprintf(stderr, "need WEAR_DAYS >= 2, WEAR_LOG_INTERVAL_S > 0, "
+                             "WEAR_METRICS in 1..%zu, WEAR_PARTITION_BYTES >= 4 sectors\n",
+                     metric::kKnownCount);
+        ok = false;
+    }
+    if (!ok) {
+        std::exit(2);
+    }
+
+    WearFlash flash(partitionBytes);
+    FakeTimeProvider clock;
+    std::unique_ptr<IDataStorage> storage;
+    if (ringLog) {
+        storage = std::make_unique<RingLogDataStorage>(flash);
+    } else {
+        if (!lfsPosixMount(flash, kMountPrefix)) {
+            std::fprintf(stderr, "littlefs: format/mount of %zu bytes failed\n", partitionBytes);
+            std::exit(1);
+        }
+        // The target's boot wiring (app_main.cpp), minus the read cache and
+        // the stats resync, which never touch the flash.
+        LittleFsDataStorageOptions options;
+        options.cacheChunkIndex = true;
+        options.cacheEventTail = true;
+        options.groupCommitWindowMs = groupCommitMs;
+        options.clock = &clock;
+        options.historyCodec = delta ? HistoryCodec::Delta : HistoryCodec::Fixed;
+        options.rollups = rollups;
+        storage = std::make_unique<LittleFsDataStorage>(kMountPrefix, nullptr, options);
+    }
+
+    std::mt19937 rng(seed);
+    std::normal_distribution<float> step(0.0f, 0.2f);
+    std::vector<float> values(metrics);
+    for (std::size_t m = 0; m < metrics; ++m) {
+        values[m] = 20.0f + static_cast<float>(m);
+    }
+    std::vector<SensorReading> batch(metrics);
+    for (std::size_t m = 0; m < metrics; ++m) {
+        batch[m].metric = metric::kKnownNames[m];
+    }
+
+    const uint64_t ticks = static_cast<uint64_t>(days) * kDayS / intervalS;
+    const double eventsPerTick = eventsPerDay * intervalS / kDayS;
+    double eventDebt = 0.0;
+    uint64_t readings = 0;
+    uint64_t rejectedReadings = 0;
+    uint32_t events = 0;
+    uint32_t rejectedEvents = 0;
+    uint32_t epoch = kStartEpoch;
+    WearSnapshot mid;
+    const auto wallStart = std::chrono::steady_clock::now();
+    for (uint64_t tick = 0; tick < ticks; ++tick) {
+        if (tick == ticks / 2) {
+            mid = WearSnapshot::take(flash, *storage, readings);
+        }
+        epoch += intervalS;
+        clock.advance(static_cast<int64_t>(intervalS) * 1000);
+        for (std::size_t m = 0; m < metrics; ++m) {
+            values[m] = std::round((values[m] + step(rng)) * 10.0f) / 10.0f;
+            batch[m].epoch = epoch;
+            batch[m].value = values[m];
+        }
+        const std::size_t stored = storage->storeSensorReadings(batch.data(), batch.size());
+        readings += stored;
+        rejectedReadings += batch.size() - stored;
+        for (eventDebt += eventsPerTick; eventDebt >= 1.0; eventDebt -= 1.0) {
+            char detail[32];
+            std::snprintf(detail, sizeof detail, "pump ran %" PRIu32 " s", 20 + events % 40);
+            if (storage->storeEvent(epoch, IDataStorage::kCategoryPump, detail)) {
+                ++events;
+            } else {
+                ++rejectedEvents;
+            }
+        }
+        storage->flushIfDue();
+    }
+    storage->flush();
+    const WearSnapshot end = WearSnapshot::take(flash, *storage, readings);
+    const double wallS =
+        std::chrono::duration<double>(std::chrono::steady_clock::now() - wallStart).count();
+
+    // Retention: the oldest reading still held, per metric.
+    double minHistoryDays = std::numeric_limits<double>::max();
+    double maxHistoryDays = 0.0;
+    for (std::size_t m = 0; m < metrics; ++m) {
+        OldestVisitor oldest;
+        storage->forEachReading(metric::kKnownNames[m], 0, epoch, oldest);
+        const double heldDays =
+            oldest.found ? static_cast<double>(epoch - oldest.oldest) / kDayS : 0.0;
+        minHistoryDays = std::min(minHistoryDays, heldDays);
+        maxHistoryDays = std::max(maxHistoryDays, heldDays);
+    }
+    const std::vector<EventRecord> held =
+        storage->getEvents(std::numeric_limits<std::size_t>::max());
+    uint32_t oldestEvent = epoch;
+    for (const EventRecord& e : held) {
+        oldestEvent = std::min(oldestEvent, e.epoch);
+    }
+    const double eventDays = held.empty() ? 0.0 : static_cast<double>(epoch - oldestEvent) / kDayS;
+    const double runDays = static_cast<double>(epoch - kStartEpoch) / kDayS;
+    // The history ring has wrapped when the oldest reading is younger than
+    // the run; until then the second half still fills fresh sectors.
+    const bool steady = minHistoryDays < runDays / 2;
+
+    // Steady-state rates over the second half.
+    const double halfDays = static_cast<double>(ticks - ticks / 2) * intervalS / kDayS;
+    const uint64_t programmed = end.programmedBytes - mid.programmedBytes;
+    const uint64_t appended = end.appendedBytes - mid.appendedBytes;
+    const uint64_t halfReadings = end.readings - mid.readings;
+    uint64_t halfErases = 0;
+    uint32_t maxSectorErases = 0;
+    uint32_t maxTotalErases = 0;
+    for (std::size_t s = 0; s < flash.sectors(); ++s) {
+        const uint32_t e = end.erases[s] - mid.erases[s];
+        halfErases += e;
+        maxSectorErases = std::max(maxSectorErases, e);
+        maxTotalErases = std::max(maxTotalErases, end.erases[s]);
+    }
+    const double erasesPerDay = halfErases / halfDays;
+    const double meanSectorPerDay = erasesPerDay / static_cast<double>(flash.sectors());
+    const double maxSectorPerDay = maxSectorErases / halfDays;
+    auto years = [endurance](double perDay) {
+        return perDay > 0.0 ? endurance / perDay / 365.0 : std::numeric_limits<double>::infinity();
+    };
+
+    std::printf("simulated %d days of %s (seed %" PRIu32 ") on %zu KiB = %zu sectors in %.2f s\n",
+                days, ringLog ? "ringlog" : "littlefs", seed, partitionBytes / 1024,
+                flash.sectors(), wallS);
+    std::printf("workload:    %zu metrics every %" PRIu32 " s, %.1f events/day\n", metrics,
+                intervalS, eventsPerDay);
+    if (!ringLog) {
+        std::printf("options:     %s chunks, group commit %" PRIu32 " ms, rollups %s\n",
+                    delta ? "delta" : "fixed", groupCommitMs, rollups ? "on" : "off");
+    }
+    std::printf("stored:      %" PRIu64 " readings (%" PRIu64 " rejected), "
+                "%" PRIu32 " events (%" PRIu32 " rejected)\n",
+                readings, rejectedReadings, events, rejectedEvents);
+    std::printf("retention:   history %.1f-%.1f days per metric, events %zu over %.1f days%s\n",
+                minHistoryDays, maxHistoryDays, held.size(), eventDays,
+                steady ? "" : " (ring not full yet: run longer for steady-state rates)");
+    std::printf("write amp:   %.2fx the appended bytes, %.1f flash bytes per %.0f-byte reading\n",
+                appended > 0 ? static_cast<double>(programmed) / appended : 0.0,
+                halfReadings > 0 ? static_cast<double>(programmed) / halfReadings : 0.0,
+                kReadingPayloadBytes);
+    std::printf("erases:      %.1f/day, per sector mean %.3f/day max %.3f/day "
+                "(most-erased sector %" PRIu32 " in total)\n",
+                erasesPerDay, meanSectorPerDay, maxSectorPerDay, maxTotalErases);
+    std::printf("lifetime:    %.0f years even wear, %.0f years worst sector "
+                "(%.0f erase cycles)\n",
+                years(meanSectorPerDay), years(maxSectorPerDay), endurance);
+    storage.reset();
+    lfsPosixUnmount();
+    const char* out = std::getenv("WEAR_OUT");
+    if (out != nullptr && *out != '\0' &&
+        !writeJson(out, backend, programmed / halfDays, appended / halfDays, erasesPerDay)) {
+        std::exit(1);
+    }
+    std::exit(0);
+}
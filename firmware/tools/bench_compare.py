@@ -0,0 +1,68 @@
+#!/usr/bin/env python3
+# SPDX-FileCopyrightText: 2026 Cryptotomte
+# SPDX-License-Identifier: AGPL-3.0-or-later
+"""Compare two host benchmark result files (test_apps/bench, BENCH_OUT).
+
+`bench_compare.py BASELINE CURRENT` prints, per case, ns/op, allocs/op and
+bytes/op of both runs and the change. With --max-regress PCT it exits 1
+when any case got slower by more than PCT percent, or allocates more per
+op at all (allocation counts are exact, timings are not). Cases present in
+only one file are listed, not compared. Stdlib only; no third-party deps.
+"""
+
+import argparse
+import json
+import sys
+
+
+def load(path: str) -> dict:
+    with open(path, encoding="utf-8") as f:
+        doc = json.load(f)
+    if doc.get("version") != 1:
+        raise ValueError(f"{path}: unsupported result version {doc.get('version')}")
+    return {r["name"]: r for r in doc["results"]}
+
+
+def change(old: float, new: float) -> str:
+    if old == 0:
+        return "   new" if new else "     ="
+    return f"{100.0 * (new - old) / old:+6.1f}%"
+
+
+def main() -> int:
+    ap = argparse.ArgumentParser(description=__doc__,
+                                 formatter_class=argparse.RawDescriptionHelpFormatter)
+    ap.add_argument("baseline", help="results of the reference run")
+    ap.add_argument("current", help="results of the run under review")
+    ap.add_argument("--max-regress", type=float, metavar="PCT",
+                    help="fail on a slowdown above PCT percent or any added allocation")
+    args = ap.parse_args()
+
+    base = load(args.baseline)
+    cur = load(args.current)
+    failed = []
+    print(f"{'case':32} {'ns/op':>12} {'':>8} {'allocs/op':>10} {'B/op':>10}")
+    for name in sorted(base.keys() & cur.keys()):
+        b, c = base[name], cur[name]
+        print(f"{name:32} {c['nsPerOp']:12.1f} {change(b['nsPerOp'], c['nsPerOp']):>8} "
+              f"{c['allocsPerOp']:10.2f} {c['bytesPerOp']:10.1f}"
+              f"  (was {b['nsPerOp']:.1f} ns, {b['allocsPerOp']:.2f} allocs, "
+              f"{b['bytesPerOp']:.1f} B)")
+        if args.max_regress is None:
+            continue
+        if b["nsPerOp"] and c["nsPerOp"] > b["nsPerOp"] * (1 + args.max_regress / 100.0):
+            failed.append(f"{name}: {change(b['nsPerOp'], c['nsPerOp'])} ns/op")
+        # Fractions come from amortized growth; a whole extra allocation is real.
+        if c["allocsPerOp"] >= b["allocsPerOp"] + 0.5:
+            failed.append(f"{name}: {c['allocsPerOp'] - b['allocsPerOp']:+.2f} allocs/op")
+    for name in sorted(base.keys() - cur.keys()):
+        print(f"{name:32} (baseline only)")
+    for name in sorted(cur.keys() - base.keys()):
+        print(f"{name:32} (new)")
+    for line in failed:
+        print(f"REGRESSION {line}", file=sys.stderr)
+    return 1 if failed else 0
+
+
+if __name__ == "__main__":
+    sys.exit(main())
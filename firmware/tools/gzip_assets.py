@@ -8,10 +8,16 @@ frontend assets (firmware/web/) into <dst>/<relpath>.gz before they are packed
 into the littlefs `storage` partition image. Deterministic (mtime=0, fixed
 compression level) so the build is reproducible (Constitution III) — no build
 timestamp leaks into the artifact. Stdlib only; no third-party deps.
+
+Also writes <dst>/assets.etag: one "<relpath> <hash>" line per asset, the
+first 16 hex digits of the SHA-256 of its .gz bytes, sorted by path. The
+firmware sends these as strong ETags (api/AssetCache.h), so the validators
+change exactly when an asset's served bytes do.
 """
 
 import argparse
 import gzip
+import hashlib
 import os
 import sys
 
@@ -20,9 +26,13 @@ COMPRESS_LEVEL = 9
 # Documentation / non-served files that must not end up on the device volume.
 SKIP_SUFFIXES = (".md",)
 
+# Validator manifest read by the firmware (api::kAssetManifestName).
+MANIFEST_NAME = "assets.etag"
+HASH_LEN = 16
+
 
 def gzip_tree(src: str, dst: str) -> int:
-    count = 0
+    tags = []
     for root, _dirs, files in os.walk(src):
         for name in files:
             if name.lower().endswith(SKIP_SUFFIXES):
@@ -40,9 +50,16 @@ def gzip_tree(src: str, dst: str) -> int:
                 fileobj=open(out_path, "wb"), mtime=0,
             ) as gz:
                 gz.write(data)
+            with open(out_path, "rb") as f:
+                digest = hashlib.sha256(f.read()).hexdigest()[:HASH_LEN]
+            # URL form of the path, whatever the host's separator.
+            tags.append((rel.replace(os.sep, "/"), digest))
             print(f"gzip: {rel} -> {rel}.gz ({os.path.getsize(out_path)} bytes)")
-            count += 1
-    return count
+    tags.sort()
+    with open(os.path.join(dst, MANIFEST_NAME), "w", newline="\n") as f:
+        for rel, digest in tags:
+            f.write(f"{rel} {digest}\n")
+    return len(tags)
 
 
 def main() -> int:
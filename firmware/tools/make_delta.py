@@ -0,0 +1,265 @@
+#!/usr/bin/env python3
+# SPDX-FileCopyrightText: 2026 Cryptotomte
+# SPDX-License-Identifier: AGPL-3.0-or-later
+"""Make (and upload) delta OTA patches between two app images.
+
+`diff BASE TARGET -o PATCH` writes a patch that rebuilds TARGET from BASE,
+the image the device is running, in the format of
+components/api/include/api/DeltaPatch.h. The patch is applied back to BASE
+here before it is written, so a patch that does not reproduce TARGET byte
+for byte is never produced.
+
+`upload --host HOST --image TARGET [--patch PATCH]` posts the patch to
+/api/v1/ota and falls back to the full image when the device answers
+"OTA base-mismatch" (it runs another build than BASE) or "OTA bad-patch".
+Without --patch it sends the full image.
+
+The matcher is bsdiff's idea without the suffix array: exact seeds from a
+hash of BASE every STRIDE bytes, grown backwards over pending literals and
+forwards while at least half the bytes still agree, and coded as the
+byte-wise difference to BASE. Code that only moved differs from its old
+self in its addresses, so those regions cost a few bytes per changed
+pointer. Stdlib only; no third-party deps.
+"""
+
+import argparse
+import hashlib
+import struct
+import sys
+import urllib.error
+import urllib.request
+
+MAGIC = b"WSDP"
+VERSION = 1
+HEADER = struct.Struct("<4sB3xII32s32s")  # 80 bytes, kDeltaHeaderBytes
+OP_DATA = 0x00
+OP_DIFF = 0x01
+
+SEED = 16      # exact bytes a match must start with
+STRIDE = 4     # BASE is indexed every STRIDE bytes
+GIVE_UP = 64   # stop growing a match this far past its best score
+FAST = 64      # identical stretches are skipped this many bytes at a time
+ZERO_BREAK = 3  # a zero run this long ends a literal run (its header is cheaper)
+
+OTA_PATH = "/api/v1/ota"
+FALLBACK_ERRORS = ("OTA base-mismatch", "OTA bad-patch")
+
+
+def varint(value: int) -> bytes:
+    out = bytearray()
+    while True:
+        b = value & 0x7F
+        value >>= 7
+        if value:
+            out.append(b | 0x80)
+        else:
+            out.append(b)
+            return bytes(out)
+
+
+def zigzag(value: int) -> int:
+    return (value << 1) if value >= 0 else ((-value << 1) - 1)
+
+
+def diff_runs(delta: bytes) -> bytes:
+    """Code a byte-wise difference as (zeros, lits, lits bytes) runs."""
+    out = bytearray()
+    i, n = 0, len(delta)
+    while i < n:
+        z = i
+        while z < n and delta[z] == 0:
+            z += 1
+        lit_end = z
+        while lit_end < n:
+            if delta[lit_end:lit_end + ZERO_BREAK] == bytes(ZERO_BREAK):
+                break
+            lit_end += 1
+        out += varint(z - i) + varint(lit_end - z) + delta[z:lit_end]
+        i = lit_end
+    return bytes(out)
+
+
+def grow(base: bytes, target: bytes, i: int, j: int) -> int:
+    """Length of the match at target[i]/base[j], bsdiff-scored."""
+    limit = min(len(target) - i, len(base) - j)
+    k = same = best = best_len = 0
+    while k < limit:
+        if k + FAST <= limit and target[i + k:i + k + FAST] == base[j + k:j + k + FAST]:
+            k += FAST
+            same += FAST
+        else:
+            if target[i + k] == base[j + k]:
+                same += 1
+            k += 1
+        if same * 2 - k > best * 2 - best_len:
+            best, best_len = same, k
+        elif k - best_len > GIVE_UP:
+            break
+    return best_len
+
+
+def make_patch(base: bytes, target: bytes) -> bytes:
+    index = {}
+    for j in range(0, len(base) - SEED + 1, STRIDE):
+        index.setdefault(base[j:j + SEED], j)
+
+    ops = bytearray()
+    literal = bytearray()
+    base_pos = 0
+    align = None
+    i = 0
+
+    def flush_literal():
+        if literal:
+            ops.extend(bytes([OP_DATA]) + varint(len(literal)) + literal)
+            literal.clear()
+
+    while i < len(target):
+        key = target[i:i + SEED]
+        j = None
+        if len(key) == SEED:
+            if align is not None and 0 <= i + align and base[i + align:i + align + SEED] == key:
+                j = i + align
+            else:
+                j = index.get(key)
+        if j is None:
+            literal.append(target[i])
+            i += 1
+            continue
+        back = 0
+        while back < len(literal) and j - back > 0 and target[i - back - 1] == base[j - back - 1]:
+            back += 1
+        if back:
+            del literal[-back:]
+            i -= back
+            j -= back
+        n = grow(base, target, i, j)
+        delta = bytes((t - b) & 0xFF for t, b in zip(target[i:i + n], base[j:j + n]))
+        flush_literal()
+        ops.extend(bytes([OP_DIFF]) + varint(zigzag(j - base_pos)) + varint(n) + diff_runs(delta))
+        base_pos = j + n
+        align = j - i
+        i += n
+    flush_literal()
+
+    header = HEADER.pack(MAGIC, VERSION, len(target), len(base),
+                         hashlib.sha256(base).digest(), hashlib.sha256(target).digest())
+    return header + bytes(ops)
+
+
+def apply_patch(base: bytes, patch: bytes) -> bytes:
+    """Reference applier, the same decode as api::DeltaSource."""
+    magic, version, target_len, base_len, base_sha, target_sha = HEADER.unpack_from(patch)
+    if magic != MAGIC or version != VERSION:
+        raise ValueError("not a delta patch")
+    if base_len != len(base) or hashlib.sha256(base).digest() != base_sha:
+        raise ValueError("patch made against another base")
+    pos = HEADER.size
+    base_pos = 0
+    out = bytearray()
+
+    def read_varint():
+        nonlocal pos
+        value = shift = 0
+        while True:
+            b = patch[pos]
+            pos += 1
+            value |= (b & 0x7F) << shift
+            shift += 7
+            if not b & 0x80:
+                return value
+
+    while len(out) < target_len:
+        op = patch[pos]
+        pos += 1
+        if op == OP_DATA:
+            n = read_varint()
+            out += patch[pos:pos + n]
+            pos += n
+            continue
+        if op != OP_DIFF:
+            raise ValueError(f"bad op {op:#x}")
+        z = read_varint()
+        base_pos += (z >> 1) ^ -(z & 1)
+        n = read_varint()
+        chunk = bytearray(base[base_pos:base_pos + n])
+        k = 0
+        while k < n:
+            k += read_varint()
+            lits = read_varint()
+            for _ in range(lits):
+                chunk[k] = (chunk[k] + patch[pos]) & 0xFF
+                pos += 1
+                k += 1
+        out += chunk
+        base_pos += n
+    if hashlib.sha256(out).digest() != target_sha:
+        raise ValueError("patch does not reproduce the target")
+    return bytes(out)
+
+
+def cmd_diff(args) -> int:
+    with open(args.base, "rb") as f:
+        base = f.read()
+    with open(args.target, "rb") as f:
+        target = f.read()
+    patch = make_patch(base, target)
+    if apply_patch(base, patch) != target:
+        print("error: patch does not round-trip", file=sys.stderr)
+        return 1
+    with open(args.output, "wb") as f:
+        f.write(patch)
+    print(f"make_delta: {len(target)} -> {len(patch)} bytes "
+          f"({100.0 * len(patch) / len(target):.1f}% of the image)")
+    return 0
+
+
+def post(host: str, body: bytes, sha256: str):
+    req = urllib.request.Request(
+        f"http://{host}{OTA_PATH}", data=body, method="POST",
+        headers={"Content-Type": "application/octet-stream", "X-Image-SHA256": sha256})
+    try:
+        with urllib.request.urlopen(req, timeout=300) as resp:
+            return resp.status, resp.read().decode("utf-8", "replace")
+    except urllib.error.HTTPError as e:
+        return e.code, e.read().decode("utf-8", "replace")
+
+
+def cmd_upload(args) -> int:
+    with open(args.image, "rb") as f:
+        image = f.read()
+    sha256 = hashlib.sha256(image).hexdigest()
+    if args.patch:
+        with open(args.patch, "rb") as f:
+            status, body = post(args.host, f.read(), sha256)
+        print(f"delta: {status} {body}")
+        if status == 200:
+            return 0
+        if not any(e in body for e in FALLBACK_ERRORS):
+            return 1
+        print("falling back to the full image")
+    status, body = post(args.host, image, sha256)
+    print(f"full: {status} {body}")
+    return 0 if status == 200 else 1
+
+
+def main() -> int:
+    ap = argparse.ArgumentParser(description=__doc__,
+                                 formatter_class=argparse.RawDescriptionHelpFormatter)
+    sub = ap.add_subparsers(dest="cmd", required=True)
+    d = sub.add_parser("diff", help="write a patch from BASE to TARGET")
+    d.add_argument("base", help="the image the devices run")
+    d.add_argument("target", help="the new image")
+    d.add_argument("-o", "--output", required=True, help="patch file to write")
+    d.set_defaults(func=cmd_diff)
+    u = sub.add_parser("upload", help="post a patch, falling back to the image")
+    u.add_argument("--host", required=True, help="device address (host[:port])")
+    u.add_argument("--image", required=True, help="the new image")
+    u.add_argument("--patch", help="delta patch for the image")
+    u.set_defaults(func=cmd_upload)
+    args = ap.parse_args()
+    return args.func(args)
+
+
+if __name__ == "__main__":
+    sys.exit(main())
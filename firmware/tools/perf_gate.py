@@ -0,0 +1,134 @@
+#!/usr/bin/env python3
+# SPDX-FileCopyrightText: 2026 Cryptotomte
+# SPDX-License-Identifier: AGPL-3.0-or-later
+"""Gate a performance run against the previous release's results.
+
+`perf_gate.py --baseline BASE --tolerances TOL RESULTS...` merges the result
+files of one run (test_apps/bench's BENCH_OUT, sim's SIM_OUT, wear's
+WEAR_OUT, apiload's LOAD_OUT; all `{"version":1,"results":[{"name",...}]}`)
+and compares every case present in BASE field by field. A field is gated
+when TOL names it:
+
+    {"version": 1,
+     "fields": {"nsPerOp": {"pct": 15}, "allocsPerOp": {"abs": 0.5}, ...},
+     "cases": {"storage.append": {"nsPerOp": {"pct": 40}}},
+     "machine": ["iterations", "nsPerOp", "worstNs"]}
+
+A value regresses when it exceeds the baseline by more than both its `pct`
+percent and its `abs` amount (either may be left out). Every gated field is
+lower-is-better. `cases` overrides the field rules per case name. The exit
+code is 1 on any regression. Cases in only one run are listed and never
+fail, so a missing or empty baseline passes with every case shown as new.
+
+`--write OUT [--release VERSION]` also stores the merged run: at a release,
+written over the baseline file, it becomes what the next release is gated
+against. The `machine` fields only hold on the host that measured them, so
+they are left out of it; `--local` keeps them, for a baseline that stays on
+that host. Stdlib only; no third-party deps.
+"""
+
+import argparse
+import json
+import os
+import sys
+
+
+def load_results(path: str) -> dict:
+    with open(path, encoding="utf-8") as f:
+        doc = json.load(f)
+    if doc.get("version") != 1:
+        raise ValueError(f"{path}: unsupported result version {doc.get('version')}")
+    return {r["name"]: r for r in doc["results"]}
+
+
+def merge(paths: list) -> dict:
+    cases = {}
+    for path in paths:
+        for name, result in load_results(path).items():
+            if name in cases:
+                raise ValueError(f"{path}: case {name} is already in another result file")
+            cases[name] = result
+    return cases
+
+
+def rule_for(tolerances: dict, case: str, field: str):
+    override = tolerances.get("cases", {}).get(case, {})
+    return override.get(field, tolerances.get("fields", {}).get(field))
+
+
+def regressed(rule: dict, old: float, new: float) -> bool:
+    allowed = old
+    if "pct" in rule:
+        allowed = max(allowed, old * (1 + rule["pct"] / 100.0))
+    if "abs" in rule:
+        allowed = max(allowed, old + rule["abs"])
+    return new > allowed
+
+
+def change(old: float, new: float) -> str:
+    if old == 0:
+        return "   new" if new else "     ="
+    return f"{100.0 * (new - old) / old:+6.1f}%"
+
+
+def main() -> int:
+    ap = argparse.ArgumentParser(description=__doc__,
+                                 formatter_class=argparse.RawDescriptionHelpFormatter)
+    ap.add_argument("results", nargs="+", help="result files of the run under review")
+    ap.add_argument("--baseline", help="merged results of the previous release")
+    ap.add_argument("--tolerances", help="gated fields and their allowed growth")
+    ap.add_argument("--write", metavar="OUT", help="store the merged run here")
+    ap.add_argument("--release", help="version recorded with --write")
+    ap.add_argument("--local", action="store_true",
+                    help="--write keeps the machine-dependent fields too")
+    args = ap.parse_args()
+
+    current = merge(args.results)
+    baseline = {}
+    release = None
+    if args.baseline and os.path.exists(args.baseline):
+        with open(args.baseline, encoding="utf-8") as f:
+            release = json.load(f).get("release")
+        baseline = load_results(args.baseline)
+    tolerances = {}
+    if args.tolerances:
+        with open(args.tolerances, encoding="utf-8") as f:
+            tolerances = json.load(f)
+
+    failed = []
+    print(f"against {release or 'no baseline'}")
+    print(f"{'case':32} {'field':20} {'value':>12} {'':>8} {'baseline':>12}")
+    for name in sorted(baseline.keys() & current.keys()):
+        b, c = baseline[name], current[name]
+        for field in sorted(b.keys() & c.keys()):
+            rule = rule_for(tolerances, name, field)
+            if rule is None:
+                continue
+            old, new = float(b[field]), float(c[field])
+            bad = regressed(rule, old, new)
+            print(f"{name:32} {field:20} {new:12.2f} {change(old, new):>8} {old:12.2f}"
+                  f"{'  REGRESSION' if bad else ''}")
+            if bad:
+                failed.append(f"{name} {field}: {old:.2f} -> {new:.2f} ({change(old, new).strip()})")
+    for name in sorted(baseline.keys() - current.keys()):
+        print(f"{name:32} (baseline only)")
+    for name in sorted(current.keys() - baseline.keys()):
+        print(f"{name:32} (new)")
+
+    if args.write:
+        dropped = set() if args.local else set(tolerances.get("machine", []))
+        doc = {"version": 1, "release": args.release,
+               "results": [{k: v for k, v in current[name].items() if k not in dropped}
+                           for name in sorted(current)]}
+        with open(args.write, "w", encoding="utf-8") as f:
+            json.dump(doc, f, indent=2)
+            f.write("\n")
+        print(f"wrote {args.write} ({len(current)} cases)")
+
+    for line in failed:
+        print(f"REGRESSION {line}", file=sys.stderr)
+    return 1 if failed else 0
+
+
+if __name__ == "__main__":
+    sys.exit(main())
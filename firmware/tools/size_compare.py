@@ -0,0 +1,94 @@
+#!/usr/bin/env python3
+# SPDX-FileCopyrightText: 2026 Cryptotomte
+# SPDX-License-Identifier: AGPL-3.0-or-later
+"""Compare the per-component RAM and flash use of two firmware builds.
+
+`size_compare.py BASELINE CURRENT` reads two `idf.py size-components
+--format json2` outputs (the legacy `--format json` reads too) and prints,
+per component archive, the static RAM and the flash image bytes of the
+current build and the change, largest change first, then the totals. Use
+it to see what a profile such as sdkconfig.production frees:
+
+    idf.py -B build.dev build size-components --format json2 --output-file dev.json
+    idf.py -B build.prod -DSDKCONFIG=build.prod/sdkconfig \\
+        -DSDKCONFIG_DEFAULTS="sdkconfig.defaults;sdkconfig.board.rev2;sdkconfig.production" \\
+        build size-components --format json2 --output-file prod.json
+    tools/size_compare.py dev.json prod.json
+
+Static RAM is the .data, .bss and IRAM sections; flash is every section
+the image carries (.bss and .noinit take none). Components present in only
+one build are compared against zero. Stdlib only; no third-party deps.
+"""
+
+import argparse
+import json
+import sys
+
+
+def sections(node: dict):
+    """Yield (section name, bytes) for every section under one archive."""
+    for key, value in node.items():
+        if key.startswith("."):
+            if isinstance(value, dict):
+                yield key, int(value.get("size", 0))
+            elif isinstance(value, int):
+                yield key, value
+        elif isinstance(value, dict):
+            # json2 nests the sections under memory types.
+            yield from sections(value)
+
+
+def is_ram(name: str) -> bool:
+    return not name.startswith(".flash") and any(
+        part in name for part in ("dram", "iram", "data", "bss", "noinit"))
+
+
+def is_flash(name: str) -> bool:
+    return "bss" not in name and "noinit" not in name
+
+
+def load(path: str) -> dict:
+    with open(path, encoding="utf-8") as f:
+        doc = json.load(f)
+    out = {}
+    for archive, node in doc.items():
+        if not isinstance(node, dict):
+            continue
+        ram = flash = 0
+        for name, size in sections(node):
+            ram += size if is_ram(name) else 0
+            flash += size if is_flash(name) else 0
+        name = archive[3:] if archive.startswith("lib") else archive
+        out[name.removesuffix(".a")] = (ram, flash)
+    return out
+
+
+def main() -> int:
+    ap = argparse.ArgumentParser(description=__doc__,
+                                 formatter_class=argparse.RawDescriptionHelpFormatter)
+    ap.add_argument("baseline", help="size-components JSON of the reference build")
+    ap.add_argument("current", help="size-components JSON of the build under review")
+    ap.add_argument("--all", action="store_true", help="list unchanged components too")
+    args = ap.parse_args()
+
+    base = load(args.baseline)
+    cur = load(args.current)
+    rows = []
+    for name in base.keys() | cur.keys():
+        b_ram, b_flash = base.get(name, (0, 0))
+        c_ram, c_flash = cur.get(name, (0, 0))
+        if args.all or c_ram != b_ram or c_flash != b_flash:
+            rows.append((name, c_ram, c_ram - b_ram, c_flash, c_flash - b_flash))
+    rows.sort(key=lambda r: (-(abs(r[2]) + abs(r[4])), r[0]))
+    print(f"{'component':28} {'RAM':>9} {'change':>9} {'flash':>10} {'change':>9}")
+    for name, ram, d_ram, flash, d_flash in rows:
+        print(f"{name:28} {ram:9} {d_ram:+9} {flash:10} {d_flash:+9}")
+    t_ram = sum(r for r, _ in cur.values())
+    t_flash = sum(f for _, f in cur.values())
+    print(f"{'total':28} {t_ram:9} {t_ram - sum(r for r, _ in base.values()):+9} "
+          f"{t_flash:10} {t_flash - sum(f for _, f in base.values()):+9}")
+    return 0
+
+
+if __name__ == "__main__":
+    sys.exit(main())
@@ -21,6 +21,7 @@ const appState = {
     statusRefreshTimer: null,
     chartRefreshTimer: null,
     chart: null,
+    history: null, // { key, series } of the chart, for incremental refreshes
     settings: {
         moistureThresholdLow: 20,
         moistureThresholdHigh: 60,
@@ -168,8 +169,7 @@ function initApp() {
 
     // Fetch initial data
     console.log('Starting initial data fetch...');
-    fetchSensorData();
-    fetchSystemStatus();
+    fetchSnapshot();
     // v1: config lives at its own endpoint (was inside /status)
     fetchConfig();
     // Note: fetchHistoricalData() is called by updateChartOptions() above
@@ -278,10 +278,7 @@ function setupEventListeners() {
     }
 
     // Refresh button
-    elements.refreshDataBtn.addEventListener('click', () => {
-        fetchSensorData();
-        fetchSystemStatus();
-    });
+    elements.refreshDataBtn.addEventListener('click', fetchSnapshot);
 
     // Watering controls
     elements.startWateringBtn.addEventListener('click', () => {
@@ -381,7 +378,7 @@ function startAutoRefresh() {
     }, API_CONFIG.STATUS_REFRESH_INTERVAL);
 
     appState.chartRefreshTimer = setInterval(() => {
-        fetchHistoricalData();
+        fetchHistoricalData(true);
     }, API_CONFIG.CHART_REFRESH_INTERVAL);
 }
 
@@ -532,6 +529,35 @@ function updateWaterLevelDisplay(level) {
     elements.waterLevelText.textContent = levelText;
 }
 
+/**
+ * Fetch sensors, status and pumps in one request (GET /api/v1/snapshot), for
+ * the initial load and the manual refresh. Each section is the body of its
+ * own endpoint without `success`, so the usual display updaters take it as is.
+ */
+async function fetchSnapshot() {
+    showSensorsLoading();
+    try {
+        const response = await fetch(`${API_CONFIG.ENDPOINT}/snapshot?fields=status,sensors,pumps`);
+        if (!response.ok) {
+            throw new Error(`HTTP error ${response.status}`);
+        }
+        const data = await response.json();
+        updateSensorDisplay(data.sensors);
+        updateSystemStatus(data.status);
+        updateConnectionStatus(data.status.wifi && data.status.wifi.connected);
+        updatePumpStatus(data);
+        appState.lastUpdate = new Date();
+        if (elements.lastUpdateTime) {
+            elements.lastUpdateTime.textContent = appState.lastUpdate.toLocaleTimeString();
+        }
+    } catch (error) {
+        console.error('Error fetching snapshot:', error);
+        updateConnectionStatus(false);
+    } finally {
+        hideSensorsLoading();
+    }
+}
+
 /**
  * Fetch system status from the API
  */
@@ -1080,10 +1106,77 @@ function addOption(selectElement, value, text) {
     selectElement.appendChild(option);
 }
 
+// Seconds per chart range; the server resolves the same names.
+const HISTORY_RANGE_S = {
+    '1h': 3600,
+    '6h': 6 * 3600,
+    '24h': 86400,
+    '7d': 7 * 86400,
+    '30d': 30 * 86400,
+};
+
+/**
+ * Decode a `format=bin` /history body (docs/api/openapi.yaml): "WSH1",
+ * uint32 bucket width (0 = raw), then {uint32 epoch, float32 value} or
+ * {uint32 epoch, float32 mean, float32 min, float32 max} records, all
+ * little-endian. The chart draws the mean, so min/max are skipped.
+ * @param {ArrayBuffer} buffer - Response body
+ * @returns {{width: number, timestamps: Uint32Array, values: Float32Array}}
+ */
+function decodeHistory(buffer) {
+    const view = new DataView(buffer);
+    if (view.byteLength < 8 || view.getUint32(0, false) !== 0x57534831) { // "WSH1"
+        throw new Error('Invalid history body');
+    }
+    const width = view.getUint32(4, true);
+    const stride = width === 0 ? 8 : 16;
+    const count = Math.floor((view.byteLength - 8) / stride);
+    const timestamps = new Uint32Array(count);
+    const values = new Float32Array(count);
+    for (let i = 0, off = 8; i < count; i++, off += stride) {
+        timestamps[i] = view.getUint32(off, true);
+        values[i] = view.getFloat32(off + 4, true);
+    }
+    return { width, timestamps, values };
+}
+
+/**
+ * Append @p next to the cached series: cached points at or after its first
+ * epoch are replaced (a re-read partial bucket), and points older than the
+ * range before the newest one are dropped.
+ */
+function mergeHistory(cached, next, rangeS) {
+    if (next.timestamps.length === 0) {
+        return cached;
+    }
+    const cut = next.timestamps[0];
+    const newest = next.timestamps[next.timestamps.length - 1];
+    const oldest = newest > rangeS ? newest - rangeS : 0;
+    let from = 0;
+    while (from < cached.timestamps.length && cached.timestamps[from] < oldest) {
+        from++;
+    }
+    let to = from;
+    while (to < cached.timestamps.length && cached.timestamps[to] < cut) {
+        to++;
+    }
+    const kept = to - from;
+    const timestamps = new Uint32Array(kept + next.timestamps.length);
+    const values = new Float32Array(kept + next.values.length);
+    timestamps.set(cached.timestamps.subarray(from, to));
+    timestamps.set(next.timestamps, kept);
+    values.set(cached.values.subarray(from, to));
+    values.set(next.values, kept);
+    return { width: cached.width, timestamps, values };
+}
+
 /**
  * Fetch historical data for the chart
+ * @param {Event|boolean} [refresh] - true from the refresh timer: fetch only
+ *   what is newer than the cached series (a selection change passes its
+ *   Event and reloads the whole window)
  */
-async function fetchHistoricalData() {
+async function fetchHistoricalData(refresh) {
     const sensor = elements.chartSensor.value;
     const reading = elements.chartReading.value;
     const timeRange = elements.chartTimeRange.value;
@@ -1097,29 +1190,69 @@ async function fetchHistoricalData() {
     // dropdown values already map directly: `${sensor}_${reading}`.
     const metric = `${sensor}_${reading}`;
 
-    showChartLoading();
+    // One point per pixel of the plot area: the server reduces the window to
+    // that budget (clamped to 3..1000); the binary body is 8 bytes a reading.
+    const chartArea = appState.chart && appState.chart.chartArea;
+    const maxPoints = Math.max(3, Math.round(chartArea ? chartArea.width : elements.dataChart.clientWidth) || 1000);
+    const key = `${metric}|${timeRange}|${maxPoints}`;
+    const rangeS = HISTORY_RANGE_S[timeRange] || 86400;
+    const cached = appState.history;
+    const incremental = refresh === true && cached && cached.key === key && cached.series.timestamps.length > 0;
+
+    let query = `metric=${encodeURIComponent(metric)}&format=bin`;
+    if (incremental) {
+        // Only what is newer than the last point (window end = device now).
+        // A bucketed series re-reads its last, still-filling bucket, with a
+        // budget one bucket-width step cannot fit so the server keeps the
+        // same width; a raw one starts after its last reading.
+        const { width, timestamps } = cached.series;
+        const last = timestamps[timestamps.length - 1];
+        if (width === 0) {
+            query += `&start=${last + 1}&maxPoints=${maxPoints}`;
+        } else {
+            const span = Math.max(0, Date.now() / 1000 - last);
+            query += `&start=${last}&maxPoints=${Math.max(3, Math.ceil(span / width) + 2)}`;
+        }
+    } else {
+        query += `&range=${encodeURIComponent(timeRange)}&maxPoints=${maxPoints}`;
+        showChartLoading();
+    }
+
     try {
-        const response = await fetch(`${API_CONFIG.ENDPOINT}/history?metric=${encodeURIComponent(metric)}&range=${encodeURIComponent(timeRange)}`);
+        const response = await fetch(`${API_CONFIG.ENDPOINT}/history?${query}`);
         if (!response.ok) {
             throw new Error(await readApiError(response));
         }
 
-        // Response shape { success, timestamps, values, metric, ... }; empty
-        // arrays (no data / soil not-yet-valid) render as an empty chart, not
-        // an error (handled in updateChart).
-        const data = await response.json();
-        updateChart(data, `${sensor === 'env' ? 'Environmental' : 'Soil'} ${elements.chartReading.options[elements.chartReading.selectedIndex].text}`);
+        // Empty arrays (no data / soil not-yet-valid) render as an empty
+        // chart, not an error (handled in updateChart).
+        const series = decodeHistory(await response.arrayBuffer());
+        if (incremental && series.timestamps.length > 0 && series.width !== cached.series.width) {
+            // The increment came back at another resolution: reload the window.
+            appState.history = null;
+            return fetchHistoricalData();
+        }
+        appState.history = {
+            key,
+            series: incremental ? mergeHistory(cached.series, series, rangeS) : series,
+        };
+        if (incremental && series.timestamps.length === 0) {
+            return;
+        }
+        updateChart(appState.history.series, `${sensor === 'env' ? 'Environmental' : 'Soil'} ${elements.chartReading.options[elements.chartReading.selectedIndex].text}`);
     } catch (error) {
         console.error('Error fetching historical data:', error);
         showNotification('Chart Error', `Failed to load historical data: ${error.message}`, 'error');
     } finally {
-        hideChartLoading();
+        if (!incremental) {
+            hideChartLoading();
+        }
     }
 }
 
 /**
  * Update chart with new data
- * @param {Object} data - Historical data from API
+ * @param {Object} data - Decoded series ({timestamps, values} typed arrays)
  * @param {string} label - Chart label
  */
 function updateChart(data, label) {
@@ -1188,8 +1321,9 @@ function updateChart(data, label) {
     // Update chart data
     // /api/v1/history sends epoch SECONDS (see docs/api/openapi.yaml); the Date
     // constructor expects milliseconds, so convert here or points land near 1970.
-    appState.chart.data.labels = data.timestamps.map(t => new Date(t * 1000));
-    appState.chart.data.datasets[0].data = data.values;
+    // Array.from, not .map: a typed array's map would coerce the Dates back.
+    appState.chart.data.labels = Array.from(data.timestamps, t => new Date(t * 1000));
+    appState.chart.data.datasets[0].data = Array.from(data.values);
     appState.chart.data.datasets[0].label = `${label} (${unit})`;
 
     // Update scale options